@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ELL_csharp_pre.i (interfaces)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Zero-copy .NET entry points for computing compiled maps and reading dataset vectors. The pointer arguments of
+// CompiledMap.ComputeDoubleInto / ComputeFloatInto and AutoDataVector.CopyTo (as CopyToDoubleBuffer / CopyToFloatBuffer) marshal as IntPtr, for callers that
+// pin their own buffers, and the proxy classes add overloads taking arrays, spans and Memory<T> that pin the
+// caller's memory for the duration of the call instead of copying it into a DoubleVector or FloatVector. The
+// overloads use fixed statements, so the generated proxies must be compiled with /unsafe.
+
+%define TYPEMAP_CSHARP_POINTER(POINTER_TYPE)
+%typemap(ctype) POINTER_TYPE "void*"
+%typemap(imtype) POINTER_TYPE "global::System.IntPtr"
+%typemap(cstype) POINTER_TYPE "global::System.IntPtr"
+%typemap(csin) POINTER_TYPE "$csinput"
+%typemap(in) POINTER_TYPE %{ $1 = ($1_ltype)$input; %}
+%enddef
+
+TYPEMAP_CSHARP_POINTER(const double* input)
+TYPEMAP_CSHARP_POINTER(double* output)
+TYPEMAP_CSHARP_POINTER(const float* input)
+TYPEMAP_CSHARP_POINTER(float* output)
+TYPEMAP_CSHARP_POINTER(double* buffer)
+TYPEMAP_CSHARP_POINTER(float* buffer)
+
+// The pointer overloads of AutoDataVector.CopyTo would both be CopyTo(IntPtr, uint)
+%rename(CopyToDoubleBuffer) ELL_API::AutoDataVector::CopyTo(double* buffer, size_t bufferSize);
+%rename(CopyToFloatBuffer) ELL_API::AutoDataVector::CopyTo(float* buffer, size_t bufferSize);
+
+// Arrays convert to both spans and Memory<T>, so each group of overloads has an array overload to disambiguate them
+%typemap(cscode) ELL_API::CompiledMap
+%{
+  public unsafe void ComputeDouble(global::System.ReadOnlySpan<double> input, global::System.Span<double> output)
+  {
+    fixed (double* inputData = input)
+    fixed (double* outputData = output)
+    {
+      ComputeDoubleInto((global::System.IntPtr)inputData, (uint)input.Length, (global::System.IntPtr)outputData, (uint)output.Length);
+    }
+  }
+
+  public void ComputeDouble(global::System.ReadOnlyMemory<double> input, global::System.Memory<double> output)
+  {
+    ComputeDouble(input.Span, output.Span);
+  }
+
+  public void ComputeDouble(double[] input, double[] output)
+  {
+    ComputeDouble(new global::System.ReadOnlySpan<double>(input), new global::System.Span<double>(output));
+  }
+
+  public unsafe void ComputeFloat(global::System.ReadOnlySpan<float> input, global::System.Span<float> output)
+  {
+    fixed (float* inputData = input)
+    fixed (float* outputData = output)
+    {
+      ComputeFloatInto((global::System.IntPtr)inputData, (uint)input.Length, (global::System.IntPtr)outputData, (uint)output.Length);
+    }
+  }
+
+  public void ComputeFloat(global::System.ReadOnlyMemory<float> input, global::System.Memory<float> output)
+  {
+    ComputeFloat(input.Span, output.Span);
+  }
+
+  public void ComputeFloat(float[] input, float[] output)
+  {
+    ComputeFloat(new global::System.ReadOnlySpan<float>(input), new global::System.Span<float>(output));
+  }
+%}
+
+%typemap(cscode) ELL_API::AutoDataVector
+%{
+  public unsafe void CopyTo(global::System.Span<double> buffer)
+  {
+    fixed (double* data = buffer)
+    {
+      CopyToDoubleBuffer((global::System.IntPtr)data, (uint)buffer.Length);
+    }
+  }
+
+  public void CopyTo(global::System.Memory<double> buffer)
+  {
+    CopyTo(buffer.Span);
+  }
+
+  public void CopyTo(double[] buffer)
+  {
+    CopyTo(new global::System.Span<double>(buffer));
+  }
+
+  public unsafe void CopyTo(global::System.Span<float> buffer)
+  {
+    fixed (float* data = buffer)
+    {
+      CopyToFloatBuffer((global::System.IntPtr)data, (uint)buffer.Length);
+    }
+  }
+
+  public void CopyTo(global::System.Memory<float> buffer)
+  {
+    CopyTo(buffer.Span);
+  }
+
+  public void CopyTo(float[] buffer)
+  {
+    CopyTo(new global::System.Span<float>(buffer));
+  }
+%}
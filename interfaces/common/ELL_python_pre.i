@@ -1 +1,26 @@
-// this file intentionally empty
+// Python threading: by default wrapped calls keep the GIL, since most of them are short or touch Python
+// objects. The calls below run models, load data, train or wait for an AsyncLoader entirely in C++ on arguments that were already
+// converted (or, for the NumPy buffers, pinned), so they release the GIL and other Python threads run
+// concurrently. Callbacks from a model into Python go through the CallbackBase director, which reacquires the
+// GIL only for the duration of the Python call.
+%feature("nothreadallow");
+
+%feature("nothreadallow", "0") ELL_API::Map::ComputeDouble;
+%feature("nothreadallow", "0") ELL_API::Map::ComputeFloat;
+%feature("nothreadallow", "0") ELL_API::Map::Step;
+%feature("nothreadallow", "0") ELL_API::Map::CompileDouble;
+%feature("nothreadallow", "0") ELL_API::Map::CompileFloat;
+
+%feature("nothreadallow", "0") ELL_API::CompiledMap::ComputeDouble;
+%feature("nothreadallow", "0") ELL_API::CompiledMap::ComputeFloat;
+%feature("nothreadallow", "0") ELL_API::CompiledMap::ComputeDoubleInto;
+%feature("nothreadallow", "0") ELL_API::CompiledMap::ComputeFloatInto;
+%feature("nothreadallow", "0") ELL_API::CompiledMap::Step;
+
+%feature("nothreadallow", "0") ELL_API::AutoSupervisedDataset::Load;
+%feature("nothreadallow", "0") ELL_API::ProtoNNTrainer::Update;
+
+%feature("nothreadallow", "0") ELL_API::AsyncLoader::Wait;
+%feature("nothreadallow", "0") ELL_API::MapLoader::GetMap;
+%feature("nothreadallow", "0") ELL_API::MapLoader::GetCompiledMap;
+%feature("nothreadallow", "0") ELL_API::AutoSupervisedDatasetLoader::GetDataset;
@@ -0,0 +1,14 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     asyncLoader.i (interfaces)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+%{
+#include "AsyncLoaderInterface.h"
+%}
+
+// Base class of MapLoader and AutoSupervisedDatasetLoader
+%include "AsyncLoaderInterface.h"
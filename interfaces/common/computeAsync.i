@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     computeAsync.i (interfaces)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Promise-returning computes that run on the libuv worker pool instead of the event loop's thread.
+// The input and output are typed arrays that the compute reads and writes in place, so don't change
+// them until the promise settles.
+
+%{
+#include <functional>
+#include <stdexcept>
+#include <string>
+%}
+
+%{
+    namespace ELL_API
+    {
+    // Runs a compute on a worker thread, then settles a promise with the output array. The worker keeps
+    // the input and output arrays alive until then.
+    class ComputeWorker : public Nan::AsyncWorker
+    {
+    public:
+        ComputeWorker(v8::Local<v8::Promise::Resolver> resolver, v8::Local<v8::Object> input, v8::Local<v8::Object> output, std::function<void()> compute) :
+            Nan::AsyncWorker(nullptr),
+            _compute(std::move(compute))
+        {
+            _resolver.Reset(resolver);
+            SaveToPersistent("input", input);
+            SaveToPersistent("output", output);
+        }
+
+        ~ComputeWorker() override
+        {
+            _resolver.Reset();
+        }
+
+        void Execute() override
+        {
+            try
+            {
+                _compute();
+            }
+            catch (const ell::utilities::Exception& e)
+            {
+                SetErrorMessage(e.GetMessage().c_str());
+            }
+            catch (const std::exception& e)
+            {
+                SetErrorMessage(e.what());
+            }
+        }
+
+        void HandleOKCallback() override
+        {
+            Nan::HandleScope scope;
+            Nan::New(_resolver)->Resolve(Nan::GetCurrentContext(), GetFromPersistent("output")).FromJust();
+        }
+
+        void HandleErrorCallback() override
+        {
+            Nan::HandleScope scope;
+            Nan::New(_resolver)->Reject(Nan::GetCurrentContext(), Nan::Error(ErrorMessage())).FromJust();
+        }
+
+    private:
+        Nan::Persistent<v8::Promise::Resolver> _resolver;
+        std::function<void()> _compute;
+    };
+
+    template <typename ElementType>
+    struct TypedArrayTraits;
+
+    template <>
+    struct TypedArrayTraits<float>
+    {
+        using ArrayType = v8::Float32Array;
+        static bool IsArray(v8::Local<v8::Value> value) { return value->IsFloat32Array(); }
+        static const char* GetName() { return "Float32Array"; }
+    };
+
+    template <>
+    struct TypedArrayTraits<double>
+    {
+        using ArrayType = v8::Float64Array;
+        static bool IsArray(v8::Local<v8::Value> value) { return value->IsFloat64Array(); }
+        static const char* GetName() { return "Float64Array"; }
+    };
+
+    // Source and sink nodes call back into JavaScript, which only the event loop's thread can do
+    void CheckNoCallbackNodes(const ell::model::Model& model)
+    {
+        if (!model.GetNodesByType<ell::model::SourceNodeBase>().empty() || !model.GetNodesByType<ell::model::SinkNodeBase>().empty())
+        {
+            throw std::invalid_argument("A map with source or sink nodes can't be computed asynchronously");
+        }
+    }
+
+    // Starts computing the output array from the input array on a worker thread, and returns a promise of the output.
+    // If output isn't given, it's a new array of outputSize values.
+    template <typename ElementType>
+    v8::Local<v8::Value> StartComputeAsync(v8::Local<v8::Value> input, v8::Local<v8::Value> output, size_t outputSize, std::function<void(const ElementType*, size_t, ElementType*, size_t)> compute)
+    {
+        using Traits = TypedArrayTraits<ElementType>;
+        if (!Traits::IsArray(input))
+        {
+            throw std::invalid_argument(std::string("input must be a ") + Traits::GetName());
+        }
+        if (output.IsEmpty() || output->IsUndefined() || output->IsNull())
+        {
+            auto buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), outputSize * sizeof(ElementType));
+            output = Traits::ArrayType::New(buffer, 0, outputSize);
+        }
+        else if (!Traits::IsArray(output))
+        {
+            throw std::invalid_argument(std::string("output must be a ") + Traits::GetName());
+        }
+
+        Nan::TypedArrayContents<ElementType> inputContents(input);
+        Nan::TypedArrayContents<ElementType> outputContents(output);
+        const ElementType* inputData = *inputContents;
+        size_t inputSize = inputContents.length();
+        ElementType* outputData = *outputContents;
+        size_t outputLength = outputContents.length();
+
+        auto resolver = v8::Promise::Resolver::New(Nan::GetCurrentContext()).ToLocalChecked();
+        Nan::AsyncQueueWorker(new ComputeWorker(resolver, input.As<v8::Object>(), output.As<v8::Object>(), [=]() {
+            compute(inputData, inputSize, outputData, outputLength);
+        }));
+        return resolver->GetPromise();
+    }
+    }
+%}
+
+%typemap(out) v8::Local<v8::Value>
+{
+    $result = $1;
+}
+
+%extend ELL_API::Map
+{
+    // The computes of a map run one at a time
+    v8::Local<v8::Value> ComputeDoubleAsync(v8::Local<v8::Value> input, v8::Local<v8::Value> output = v8::Local<v8::Value>())
+    {
+        ELL_API::CheckNoCallbackNodes($self->GetInnerMap()->GetModel());
+        ELL_API::Map map = *$self;
+        return ELL_API::StartComputeAsync<double>(input, output, $self->GetOutputShape().Size(), [map](const double* inputData, size_t inputSize, double* outputData, size_t outputSize) mutable {
+            map.ComputeInto(inputData, inputSize, outputData, outputSize);
+        });
+    }
+
+    v8::Local<v8::Value> ComputeFloatAsync(v8::Local<v8::Value> input, v8::Local<v8::Value> output = v8::Local<v8::Value>())
+    {
+        ELL_API::CheckNoCallbackNodes($self->GetInnerMap()->GetModel());
+        ELL_API::Map map = *$self;
+        return ELL_API::StartComputeAsync<float>(input, output, $self->GetOutputShape().Size(), [map](const float* inputData, size_t inputSize, float* outputData, size_t outputSize) mutable {
+            map.ComputeInto(inputData, inputSize, outputData, outputSize);
+        });
+    }
+}
+
+%extend ELL_API::CompiledMap
+{
+    // The computes of a map compiled with the reentrant option run at the same time, each on a clone of the map
+    v8::Local<v8::Value> ComputeDoubleAsync(v8::Local<v8::Value> input, v8::Local<v8::Value> output = v8::Local<v8::Value>())
+    {
+        auto instances = $self->GetInstances();
+        return ELL_API::StartComputeAsync<double>(input, output, instances->GetOutputSize(), [instances](const double* inputData, size_t inputSize, double* outputData, size_t outputSize) {
+            instances->ComputeInto(inputData, inputSize, outputData, outputSize);
+        });
+    }
+
+    v8::Local<v8::Value> ComputeFloatAsync(v8::Local<v8::Value> input, v8::Local<v8::Value> output = v8::Local<v8::Value>())
+    {
+        auto instances = $self->GetInstances();
+        return ELL_API::StartComputeAsync<float>(input, output, instances->GetOutputSize(), [instances](const float* inputData, size_t inputSize, float* outputData, size_t outputSize) {
+            instances->ComputeInto(inputData, inputSize, outputData, outputSize);
+        });
+    }
+}
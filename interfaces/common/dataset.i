@@ -11,4 +11,10 @@
 #include "DatasetInterface.h"
 %}
 
+#if defined(SWIGPYTHON)
+// AutoDataVector.CopyTo writes into a NumPy array in place
+TYPEMAP_BUFFER_TO_POINTER(double, double* buffer, bufferSize, PyBUF_WRITABLE)
+TYPEMAP_BUFFER_TO_POINTER(float, float* buffer, bufferSize, PyBUF_WRITABLE)
+#endif
+
 %include "DatasetInterface.h"
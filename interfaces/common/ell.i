@@ -12,6 +12,8 @@
     %include "ELL_python_pre.i"
 #elif SWIGJAVASCRIPT
     %include "ELL_javascript_pre.i"
+#elif SWIGCSHARP
+    %include "ELL_csharp_pre.i"
 #endif // SWIGPYTHON
 
 %module(directors="1") "ell"
@@ -76,6 +78,7 @@
 %include "functions.i"
 %include "math.i"
 %include "callback.i"
+%include "asyncLoader.i"
 %include "model.i"
 %include "trainers.i"
 %include "dataset.i"
@@ -9,6 +9,8 @@
 // we want a different "ell_py" module name for python so we can wrap it in a more python friendly 
 // package named "ell"
 
-%module "ell_py"
+// threads="1" lets the long-running calls selected in ELL_python_pre.i release the GIL, and makes director
+// callbacks reacquire it around each call into Python
+%module(directors="1", threads="1") "ell_py"
 
 %include "ell.i"
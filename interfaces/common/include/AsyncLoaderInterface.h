@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     AsyncLoaderInterface.h (interfaces)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#ifndef SWIG
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#endif
+
+namespace ELL_API
+{
+
+/// <summary> Base class of the loaders that read a map or a dataset (and compile the map) on a background thread,
+/// so that the caller, e.g. a GUI, stays responsive. The file is read a block ahead of the parser on another thread,
+/// and separate loaders run concurrently, so several models and datasets can be loaded and compiled at once.
+/// The loader reports the stage it is in and how far along it is, and can be cancelled. </summary>
+class AsyncLoader
+{
+public:
+    AsyncLoader(const AsyncLoader&) = delete;
+    AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+    /// <summary> Cancels the load if it is still running, and waits for the background thread to stop. </summary>
+    virtual ~AsyncLoader();
+
+    /// <summary> Returns the fraction of the load that is done, between 0 and 1. </summary>
+    double GetProgress() const;
+
+    /// <summary> Returns the stage the load is in: "reading" or "compiling" while it runs, then "done", "failed"
+    /// or "cancelled". </summary>
+    std::string GetStage() const;
+
+    /// <summary> Returns true once the load has stopped, whether it succeeded, failed or was cancelled. </summary>
+    bool IsDone() const;
+
+    /// <summary> Waits for the load to stop. </summary>
+    /// <param name="timeoutSeconds"> The longest time to wait, or a negative number to wait until the load stops. </param>
+    /// <returns> True if the load has stopped. </returns>
+    bool Wait(double timeoutSeconds = -1.0);
+
+    /// <summary> Asks the load to stop. Reading stops at the next block of the file; compilation can't be interrupted,
+    /// so a cancelled load stops once the compiler returns. Getting the result of a cancelled load throws. </summary>
+    void Cancel();
+
+#ifndef SWIG
+    /// <summary> The state a load running on the background thread shares with its loader </summary>
+    class LoadState
+    {
+    public:
+        /// <summary> Starts a stage of the load, which brings the progress from its current value to `progressEnd` </summary>
+        void BeginStage(const std::string& name, double progressEnd);
+
+        /// <summary> Sets the fraction of the current stage that is done </summary>
+        void SetStageProgress(double fraction);
+
+        /// <summary> Throws if the load was cancelled. The loader catches the exception and stops. </summary>
+        void ThrowIfCancelled() const;
+
+    private:
+        friend class AsyncLoader;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _stopped;
+        std::string _stage = "reading";
+        bool _done = false;
+        std::exception_ptr _error;
+        std::atomic<bool> _cancelled = false;
+        std::atomic<double> _progress = 0;
+        double _stageBegin = 0;
+        double _stageEnd = 1;
+    };
+#endif
+
+protected:
+    AsyncLoader();
+
+#ifndef SWIG
+    /// <summary> Runs the load on the background thread. Derived classes call this at the end of their constructor,
+    /// and keep the result in an object the function co-owns, since the thread can outlive the derived part of the
+    /// loader while the destructor waits for it. </summary>
+    void Start(std::function<void(LoadState&)> load);
+
+    /// <summary> Waits for the load to stop, and rethrows its error if it failed or was cancelled </summary>
+    void WaitForResult();
+
+    /// <summary> Opens a file whose next block is read on another thread while the current one is parsed. Reading
+    /// it sets the progress of the current stage and stops if the load is cancelled. </summary>
+    static std::unique_ptr<std::istream> OpenReadAheadStream(const std::string& filename, LoadState& state);
+#endif
+
+private:
+#ifndef SWIG
+    std::shared_ptr<LoadState> _state;
+    std::thread _thread;
+#endif
+};
+
+} // namespace ELL_API
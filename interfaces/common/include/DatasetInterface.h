@@ -7,6 +7,8 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include "AsyncLoaderInterface.h"
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -37,6 +39,18 @@ public:
     /// <param name="buffer"> The buffer to copy the data into. </param>
     void CopyTo(std::vector<float>& buffer);
 
+    /// <summary> Copy the data in this vector to the start of a caller-owned buffer and zero the rest of it, for
+    /// languages that pass pinned arrays (such as .NET spans). Throws if the data doesn't fit in the buffer. </summary>
+    /// <param name="buffer"> The buffer to copy the data into. </param>
+    /// <param name="bufferSize"> The number of elements in the buffer. </param>
+    void CopyTo(double* buffer, size_t bufferSize);
+
+    /// <summary> Copy the data in this vector to the start of a caller-owned float buffer and zero the rest of it.
+    /// Throws if the data doesn't fit in the buffer. </summary>
+    /// <param name="buffer"> The buffer to copy the data into. </param>
+    /// <param name="bufferSize"> The number of elements in the buffer. </param>
+    void CopyTo(float* buffer, size_t bufferSize);
+
 private:
     class AutoDataVectorImpl;
     friend class AutoSupervisedExample;
@@ -96,9 +110,31 @@ public:
     void Save(std::string filename);
 
 private:
+#ifndef SWIG
+    void Load(std::istream& stream);
+#endif
+
     class AutoSupervisedDatasetImpl;
+    friend class AutoSupervisedDatasetLoader;
     friend class ProtoNNTrainer;
     std::shared_ptr<AutoSupervisedDatasetImpl> _impl;
 };
 
+/// <summary> AutoSupervisedDatasetLoader loads an AutoSupervisedDataset from a file on a background thread. </summary>
+class AutoSupervisedDatasetLoader : public AsyncLoader
+{
+public:
+    /// <summary> Starts loading the dataset. </summary>
+    /// <param name="filename"> The dataset file, in any format AutoSupervisedDataset::Load reads. </param>
+    AutoSupervisedDatasetLoader(const std::string& filename);
+
+    /// <summary> Waits for the load to finish and returns the dataset. Throws if the load failed or was cancelled. </summary>
+    AutoSupervisedDataset GetDataset();
+
+private:
+#ifndef SWIG
+    std::shared_ptr<AutoSupervisedDataset> _dataset;
+#endif
+};
+
 } // namespace ELL_API
@@ -15,6 +15,7 @@
 
 #include <array>
 #include <stddef.h>
+#include <stdexcept>
 #include <vector>
 
 #endif
@@ -98,6 +99,16 @@ namespace api
             {
             }
 
+            Tensor(const ElementType* values, size_t valuesSize, int rows, int columns, int channels) :
+                shape{ rows, columns, channels },
+                data(values, values + valuesSize)
+            {
+                if (valuesSize != static_cast<size_t>(shape.Size()))
+                {
+                    throw std::invalid_argument("Tensor data size doesn't match its shape");
+                }
+            }
+
             const ell::api::math::TensorShape shape;
             std::vector<ElementType> data;
         };
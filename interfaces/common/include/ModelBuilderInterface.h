@@ -81,11 +81,16 @@ public:
     Node AddBinaryOperationNode(Model model, PortElements input1, PortElements input2, BinaryOperationType operation);
     Node AddBufferNode(Model model, PortElements input, int windowSize);
     Node AddTypeCastNode(Model model, PortElements input, PortType outputType);
-    Node AddClockNode(Model model, PortElements input, double interval, double lagThreshold, const std::string& lagNotificationName);
+    Node AddClockNode(Model model, PortElements input, double interval, double lagThreshold, const std::string& lagNotificationName, bool dropStaleTicks = false);
     Node AddConcatenationNode(Model model, const PortMemoryLayout& outputMemoryLayout, const std::vector<PortElements*>& inputs);
     Node AddSpliceNode(Model model, const std::vector<PortElements*>& inputs);
     Node AddConstantNode(Model model, std::vector<double> values, PortType type);
     Node AddConstantNode(Model model, std::vector<double> values, const PortMemoryLayout& outputMemoryLayout, PortType type);
+    // Overloads that read the values from a buffer (in Python, any contiguous NumPy array of the same element type)
+    Node AddConstantNode(Model model, const double* values, size_t valuesSize, PortType type);
+    Node AddConstantNode(Model model, const double* values, size_t valuesSize, const PortMemoryLayout& outputMemoryLayout, PortType type);
+    Node AddConstantNode(Model model, const float* values, size_t valuesSize, PortType type);
+    Node AddConstantNode(Model model, const float* values, size_t valuesSize, const PortMemoryLayout& outputMemoryLayout, PortType type);
     Node AddDCTNode(Model model, PortElements input, int numFilters);
     Node AddMatrixMultiplyNode(Model model, PortElements input1, PortElements input2);
     Node AddDotProductNode(Model model, PortElements input1, PortElements input2);
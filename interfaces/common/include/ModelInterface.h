@@ -9,6 +9,7 @@
 
 #ifndef SWIG
 
+#include "AsyncLoaderInterface.h"
 #include "CallbackInterface.h"
 #include "MathInterface.h"
 
@@ -27,7 +28,9 @@
 #include <model/include/PortElements.h>
 #include <model/include/PortMemoryLayout.h>
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -399,6 +402,11 @@ public:
     {
         return _map;
     }
+
+    // Computes the output from the input like ComputeFloat and ComputeDouble, from any thread: the computes of a
+    // map and its copies run one at a time.
+    template <typename ElementType>
+    void ComputeInto(const ElementType* input, size_t inputSize, ElementType* output, size_t outputSize);
 #endif
 
 private:
@@ -407,6 +415,9 @@ private:
 #endif
 
     std::shared_ptr<ell::model::Map> _map;
+#ifndef SWIG
+    std::shared_ptr<std::mutex> _computeMutex = std::make_shared<std::mutex>();
+#endif
     enum class TriState
     {
         Uninitialized,
@@ -416,6 +427,50 @@ private:
     TriState _sourceNodeState = TriState::Uninitialized;
 };
 
+#ifndef SWIG
+//
+// CompiledMapInstances
+//
+
+/// <summary> Computes a compiled map on other threads than the one that uses the CompiledMap (such as a worker
+/// pool), reading the input and writing the output where the caller keeps them. The computes of a reentrant map run
+/// at the same time, each on a clone of the map with state of its own; the computes of other maps run one at a time,
+/// on the map itself. The map can't have source or sink nodes, whose callbacks would run on those threads. </summary>
+class CompiledMapInstances
+{
+public:
+    /// <summary> Constructor. </summary>
+    /// <param name="map"> The compiled map. </param>
+    /// <param name="inputSize"> The size of the map's input. </param>
+    /// <param name="outputSize"> The size of the map's output. </param>
+    CompiledMapInstances(std::shared_ptr<ell::model::IRCompiledMap> map, size_t inputSize, size_t outputSize);
+
+    /// <summary> Computes the output from the input on an instance of the map, waiting for one if they're all busy. </summary>
+    template <typename ElementType>
+    void ComputeInto(const ElementType* input, size_t inputSize, ElementType* output, size_t outputSize);
+
+    /// <summary> Resets the state of the instances that aren't computing. </summary>
+    void Reset();
+
+    /// <summary> Gets the size of the map's output. </summary>
+    size_t GetOutputSize() const { return _outputSize; }
+
+private:
+    std::shared_ptr<ell::model::IRCompiledMap> AcquireInstance();
+    void ReleaseInstance(std::shared_ptr<ell::model::IRCompiledMap> instance);
+
+    std::shared_ptr<ell::model::IRCompiledMap> _map;
+    size_t _inputSize;
+    size_t _outputSize;
+    bool _hasCallbacks;
+
+    std::mutex _mutex;
+    std::condition_variable _instanceReleased;
+    std::vector<std::shared_ptr<ell::model::IRCompiledMap>> _idleInstances; // clones of a reentrant map
+    bool _isMapBusy = false;
+};
+#endif
+
 //
 // CompiledMap
 //
@@ -451,26 +506,44 @@ public:
 
     template <typename ElementType>
     void InvokeSinkCallback(ElementType* output);
+
+    // The instances that compute this map on other threads, such as the asynchronous computes of the JavaScript
+    // binding. Call it from the thread that uses this object.
+    std::shared_ptr<CompiledMapInstances> GetInstances();
 #endif
 
     // Return true if the model contains a SourceNode.  In this case you need
     // to register the callbacks via SetSourceCallback and SetSinkCallback.
     bool HasSourceNodes();
 
+    // Reset the state of the compiled model (e.g., the hidden state of recurrent nodes).
+    void Reset();
+
     // Older non callback based API, only makes sense when model has single input/output nodes and no source/sink nodes.
     std::vector<double> ComputeDouble(const std::vector<double>& inputData);
     std::vector<float> ComputeFloat(const std::vector<float>& inputData);
 
+    // Zero-copy version of the above: the compiled predict function reads the input from and writes the output to
+    // caller-owned buffers (in Python, C-contiguous arrays such as NumPy arrays).
+    void ComputeDoubleInto(const double* input, size_t inputSize, double* output, size_t outputSize);
+    void ComputeFloatInto(const float* input, size_t inputSize, float* output, size_t outputSize);
+
 private:
     template <typename ElementType>
     ell::api::CallbackForwarder<ElementType, ElementType>& GetCallbackForwarder();
 
+    template <typename ElementType>
+    void ComputeInto(const ElementType* input, size_t inputSize, ElementType* output, size_t outputSize);
+
     std::shared_ptr<ell::model::IRMapCompiler> _compiler;
     std::shared_ptr<ell::model::IRCompiledMap> _map;
     ell::api::math::TensorShape _inputShape;
     ell::api::math::TensorShape _outputShape;
     ell::api::CallbackForwarder<double, double> forwarderDouble;
     ell::api::CallbackForwarder<float, float> forwarderFloat;
+#ifndef SWIG
+    std::shared_ptr<CompiledMapInstances> _instances;
+#endif
 
     enum class TriState
     {
@@ -488,6 +561,15 @@ struct MapCompilerOptions
 {
     bool useBlas = true;
     bool profile = false;
+    std::string jitCacheDirectory = ""; // reuse machine code from earlier runs stored in this directory
+    bool planMemory = false; // share memory between intermediate buffers that are never live at the same time
+    bool scheduleForMemory = false; // with planMemory, order the nodes to keep few intermediate buffers live at once
+    bool aliasPorts = true; // compute slices, reinterpretations, and spliced values in place instead of copying them
+    bool cacheRefinement = false; // reuse what unchanged nodes refined into the last time a model was compiled in this process
+    bool reentrant = false; // keep the model state in a caller-allocated struct passed to predict
+    bool dynamicInputExtent = false; // also emit predict_dynamic, which takes the extent of the input's outermost dimension
+    std::string weightStorageType = "float32"; // "float32", "float16" or "bfloat16"
+    std::string fastMathAccuracy = "high"; // "exact" (call the C library), "high" or "low" for exp, log, tanh and sigmoid
 };
 
 //
@@ -498,6 +580,62 @@ struct ModelOptimizerOptions
     bool fuseLinearFunctionNodes = true;
 };
 
+//
+// MapLoader
+//
+
+/// <summary> Loads a map from a file, and optionally compiles it, on a background thread. </summary>
+class MapLoader : public AsyncLoader
+{
+public:
+    /// <summary> Starts loading a map. </summary>
+    /// <param name="filename"> The map file, a JSON or a binary archive. </param>
+    MapLoader(const std::string& filename);
+
+    /// <summary> Starts loading a map and compiling it once it is loaded. </summary>
+    /// <param name="filename"> The map file, a JSON or a binary archive. </param>
+    /// <param name="elementType"> The element type of the compiled map, PortType::real or PortType::smallReal. </param>
+    /// <param name="targetDevice"> The target device, as in Map::CompileDouble. </param>
+    /// <param name="moduleName"> The name of the compiled module. </param>
+    /// <param name="functionName"> The name of the compiled predict function. </param>
+    /// <param name="compilerSettings"> The compiler options. </param>
+    /// <param name="optimizerSettings"> The model optimizer options. </param>
+    MapLoader(const std::string& filename, PortType elementType, const std::string& targetDevice, const std::string& moduleName, const std::string& functionName, const MapCompilerOptions& compilerSettings, const ModelOptimizerOptions& optimizerSettings);
+
+    /// <summary> Waits for the load to finish and returns the map. Throws if the load failed or was cancelled. </summary>
+    Map GetMap();
+
+    /// <summary> Waits for the load to finish and returns the compiled map. Throws if the load failed or was
+    /// cancelled, or if the loader wasn't asked to compile the map. </summary>
+    CompiledMap GetCompiledMap();
+
+private:
+#ifndef SWIG
+    static std::shared_ptr<ell::model::Map> LoadMap(const std::string& filename, LoadState& state);
+
+    struct Result
+    {
+        Map map;
+        std::shared_ptr<CompiledMap> compiledMap;
+    };
+
+    std::shared_ptr<Result> _result;
+#endif
+};
+
+//
+// Phase timing
+//
+
+/// <summary> Turns on or off the timing of the phases of loading, refining, optimizing and compiling a map. It's off by default. </summary>
+void EnablePhaseTiming(bool enable);
+
+/// <summary> Discards the phases timed so far. </summary>
+void ResetPhaseTimings();
+
+/// <summary> Returns the phases timed so far as JSON: an array of phases, each with its name, total milliseconds, count, and the phases timed inside it. </summary>
+std::string GetPhaseTimings();
+
 } // namespace ELL_API
 
 #pragma region implementation
@@ -509,6 +647,8 @@ struct ModelOptimizerOptions
 #include <nodes/include/SinkNode.h>
 #include <nodes/include/SourceNode.h>
 
+#include <algorithm>
+
 namespace ELL_API
 {
 
@@ -555,6 +695,46 @@ void Map::Step(ell::api::TimeTickType timestamp)
     _map->Compute<ElementType>(input);
 }
 
+template <typename ElementType>
+void Map::ComputeInto(const ElementType* input, size_t inputSize, ElementType* output, size_t outputSize)
+{
+    std::lock_guard<std::mutex> lock(*_computeMutex);
+    auto result = _map->Compute<ElementType>(std::vector<ElementType>(input, input + inputSize));
+    if (result.size() != outputSize)
+    {
+        throw std::invalid_argument("Output buffer doesn't match the size of the model's output");
+    }
+    std::copy(result.begin(), result.end(), output);
+}
+
+//
+// CompiledMapInstances
+//
+template <typename ElementType>
+void CompiledMapInstances::ComputeInto(const ElementType* input, size_t inputSize, ElementType* output, size_t outputSize)
+{
+    if (_hasCallbacks)
+    {
+        throw std::invalid_argument("A map with source or sink nodes can only be computed on the thread that uses it");
+    }
+    if (inputSize != _inputSize || outputSize != _outputSize)
+    {
+        throw std::invalid_argument("Input or output buffer doesn't match the size of the model's input or output");
+    }
+
+    auto instance = AcquireInstance();
+    try
+    {
+        instance->Predict(input, output);
+    }
+    catch (...)
+    {
+        ReleaseInstance(instance);
+        throw;
+    }
+    ReleaseInstance(instance);
+}
+
 //
 // CompiledMap
 //
@@ -582,6 +762,21 @@ void CompiledMap::UnregisterCallbacks()
     GetCallbackForwarder<ElementType>().Clear();
 }
 
+template <typename ElementType>
+void CompiledMap::ComputeInto(const ElementType* input, size_t inputSize, ElementType* output, size_t outputSize)
+{
+    if (_map == nullptr)
+    {
+        throw std::invalid_argument("CompiledMap is not valid");
+    }
+    if (inputSize != static_cast<size_t>(_inputShape.Size()) || outputSize != static_cast<size_t>(_outputShape.Size()))
+    {
+        throw std::invalid_argument("Input or output buffer doesn't match the size of the model's input or output");
+    }
+    _map->SetContext(this);
+    _map->Predict(input, output);
+}
+
 template <typename ElementType>
 bool CompiledMap::InvokeSourceCallback(ElementType* input)
 {
@@ -70,6 +70,12 @@ struct ProtoNNTrainerParameters
 
     ///<summary>Whether to output diagnostic messages during the training process</summary>
     bool verbose = false;
+
+    ///<summary>The number of examples in each stochastic gradient step (0 means 256)</summary>
+    size_t batchSize = 0;
+
+    ///<summary>The number of threads to train on (0 means one per core)</summary>
+    size_t numThreads = 0;
 };
 
 class ProtoNNPredictor
@@ -170,6 +170,53 @@ void copy_from_buffer(
 
 %}
 
+// Passes any C-contiguous buffer (e.g., a NumPy array of any shape) as a pointer and element count, without copying
+%define TYPEMAP_BUFFER_TO_POINTER(ELEMENT_TYPE, POINTER_TYPE, SIZE_NAME, FLAGS)
+%typemap(in) (POINTER_TYPE, size_t SIZE_NAME)
+             (Py_buffer view_ = {})
+{
+    static const char* data_type = "ELEMENT_TYPE";
+    int res = PyObject_GetBuffer($input, &view_, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | FLAGS);
+    if (res < 0)
+    {
+        PyErr_Clear();
+        SWIG_exception_fail(SWIG_TypeError, "Expected a contiguous array");
+    }
+    if (view_.format == nullptr || view_.format[0] != data_type[0] || view_.itemsize != sizeof(ELEMENT_TYPE))
+    {
+        PyBuffer_Release(&view_);
+        SWIG_exception_fail(SWIG_TypeError, "Expected an array of ELEMENT_TYPE");
+    }
+    $1 = ($1_ltype) view_.buf;
+    $2 = ($2_ltype) (view_.len / view_.itemsize);
+}
+%typemap(freearg) (POINTER_TYPE, size_t SIZE_NAME)
+{
+    PyBuffer_Release(&view_$argnum);
+}
+// Lets overloads taking a buffer coexist with overloads taking a std::vector: only arrays of ELEMENT_TYPE dispatch here
+%typecheck(SWIG_TYPECHECK_POINTER) (POINTER_TYPE, size_t SIZE_NAME)
+{
+    static const char* data_type = "ELEMENT_TYPE";
+    Py_buffer view_ = {};
+    $1 = 0;
+    if (PyObject_GetBuffer($input, &view_, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | FLAGS) == 0)
+    {
+        $1 = view_.format != nullptr && view_.format[0] == data_type[0] && view_.itemsize == sizeof(ELEMENT_TYPE);
+        PyBuffer_Release(&view_);
+    }
+    else
+    {
+        PyErr_Clear();
+    }
+}
+%enddef
+
+%define TYPEMAP_NUMPY_COMPUTE_BUFFERS(ELEMENT_TYPE)
+TYPEMAP_BUFFER_TO_POINTER(ELEMENT_TYPE, const ELEMENT_TYPE* input, inputSize, 0)
+TYPEMAP_BUFFER_TO_POINTER(ELEMENT_TYPE, ELEMENT_TYPE* output, outputSize, PyBUF_WRITABLE)
+%enddef
+
 %define TYPEMAP_VECTOR_TO_ARRAY(ELEMENT_TYPE)
 
 TYPEMAP_COPY_TO_VECTOR(ELEMENT_TYPE)
@@ -228,20 +275,21 @@ def copy_from(self, a):
 
 %enddef
 
-%define CONSTRUCT_TENSOR_WITH_NUMPY(TypeName)
+%define CONSTRUCT_TENSOR_WITH_NUMPY(TypeName, nptype)
 %pythoncode %{
     class TypeName(TypeName):
         def __init__(self, numpyArray = None):
             # str(type) avoids requiring import numpy (more robust check?)
             if ('numpy.ndarray' in str(type(numpyArray))):
+                # the values are copied straight from the array's buffer, instead of one element at a time
+                numpyArray = np.ascontiguousarray(numpyArray, dtype=nptype)
                 if (len(numpyArray.shape) == 1):
-                    super(TypeName, self).__init__(numpyArray)
+                    super(TypeName, self).__init__(numpyArray, 1, 1, numpyArray.shape[0])
                 elif (len(numpyArray.shape) == 3):
-                    super(TypeName, self).__init__(numpyArray.ravel(), numpyArray.shape[0], numpyArray.shape[1], numpyArray.shape[2])
+                    super(TypeName, self).__init__(numpyArray, numpyArray.shape[0], numpyArray.shape[1], numpyArray.shape[2])
                 elif (len(numpyArray.shape) == 4):
                     # Create a stacked 3 dimensional tensor
-                    numpyArrayStacked = numpyArray.reshape(numpyArray.shape[0] * numpyArray.shape[1], numpyArray.shape[2], numpyArray.shape[3])
-                    super(TypeName, self).__init__(numpyArrayStacked.ravel(), numpyArrayStacked.shape[0], numpyArrayStacked.shape[1], numpyArrayStacked.shape[2])
+                    super(TypeName, self).__init__(numpyArray, numpyArray.shape[0] * numpyArray.shape[1], numpyArray.shape[2], numpyArray.shape[3])
                 else:
                     raise ValueError('Invalid number of dimensions!')
             elif numpyArray:
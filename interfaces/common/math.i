@@ -22,6 +22,12 @@
 %naturalvar ell::api::math::Tensor::data;
 %naturalvar ell::api::math::Tensor::shape;
 
+#ifdef SWIGPYTHON
+// Tensors (and, in model.i, ModelBuilder.AddConstantNode) read NumPy arrays through the buffer protocol
+TYPEMAP_BUFFER_TO_POINTER(double, const double* values, valuesSize, 0)
+TYPEMAP_BUFFER_TO_POINTER(float, const float* values, valuesSize, 0)
+#endif
+
 // Include the C++ code to be wrapped
 %include "MathInterface.h"
 
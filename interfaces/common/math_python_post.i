@@ -1,2 +1,2 @@
-CONSTRUCT_TENSOR_WITH_NUMPY(FloatTensor)
-CONSTRUCT_TENSOR_WITH_NUMPY(DoubleTensor)
+CONSTRUCT_TENSOR_WITH_NUMPY(FloatTensor, np.float32)
+CONSTRUCT_TENSOR_WITH_NUMPY(DoubleTensor, np.float64)
@@ -30,6 +30,12 @@ WRAP_CALLABLES_AS_COMPILED_MAP_CALLBACKS(FloatCallbackBase, FloatCallbackBase, f
 %naturalvar ELL_API::PortMemoryLayout::offset;
 %naturalvar ELL_API::PortMemoryLayout::order;
 
+#if defined(SWIGPYTHON)
+// Zero-copy NumPy buffers for CompiledMap.ComputeDoubleInto / ComputeFloatInto
+TYPEMAP_NUMPY_COMPUTE_BUFFERS(double)
+TYPEMAP_NUMPY_COMPUTE_BUFFERS(float)
+#endif
+
 // Include the C++ code to be wrapped
 %include "ModelInterface.h"
 %include "ModelBuilderInterface.h"
@@ -6,3 +6,5 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Promise-returning computes on the libuv worker pool
+%include "computeAsync.i"
@@ -138,6 +138,32 @@ def CompiledMap_Compute(self, inputData: 'Vector', dtype: 'numpy.dtype') -> "std
 
 CompiledMap.Compute = CompiledMap_Compute
 
+# CompiledMap.ComputeInto, for models without source nodes
+def CompiledMap_ComputeInto(self, inputData: 'numpy.ndarray', outputData: 'numpy.ndarray') -> None:
+    """
+    ComputeInto(CompiledMap self, numpy.ndarray inputData, numpy.ndarray outputData)
+
+    Runs the compiled model directly on the memory of the given arrays, without copying them. Both must be
+    C-contiguous arrays of the same dtype (numpy.float or numpy.float32), with as many elements as the model's
+    input and output. The result is written into outputData.
+
+    Parameters
+    ----------
+    inputData: numpy.ndarray
+    outputData: numpy.ndarray
+    """
+    if self.HasSourceNodes():
+        raise TypeError("ComputeInto is only available for models without source nodes, use Compute instead")
+
+    if inputData.dtype == np.float64 and outputData.dtype == np.float64:
+        self.ComputeDoubleInto(inputData, outputData)
+    elif inputData.dtype == np.float32 and outputData.dtype == np.float32:
+        self.ComputeFloatInto(inputData, outputData)
+    else:
+        raise TypeError("Invalid type, expected numpy.float or numpy.float32 arrays of the same type")
+
+CompiledMap.ComputeInto = CompiledMap_ComputeInto
+
 # Map.Compute, parameterized on numpy.dtype
 def Map_Compute(self, inputData: 'Vector<ElementType>', dtype: 'numpy.dtype') -> "std::vector< ElementType,std::allocator< ElementType > >":
     """
@@ -224,6 +250,7 @@ def Map_Compile(self, targetDevice: 'std::string const &', moduleName: 'std::str
 Map.Compile = Map_Compile
 
 del CompiledMap_Compute
+del CompiledMap_ComputeInto
 del Map_Compile
 del Map_Compute
 
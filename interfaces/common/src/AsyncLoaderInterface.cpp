@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     AsyncLoaderInterface.cpp (interfaces)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AsyncLoaderInterface.h"
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <vector>
+
+namespace ELL_API
+{
+namespace
+{
+    // Thrown on the background thread to unwind a cancelled load
+    struct LoadCancelled
+    {
+    };
+
+    // A stream buffer that reads the next block of a file on another thread while the caller parses the current one
+    class ReadAheadStreamBuffer : public std::streambuf
+    {
+    public:
+        ReadAheadStreamBuffer(const std::string& filename, AsyncLoader::LoadState& state) :
+            _file(ell::utilities::OpenBinaryIfstream(filename)),
+            _state(state),
+            _current(blockSize),
+            _next(blockSize)
+        {
+            _file.seekg(0, std::ios::end);
+            _fileSize = static_cast<size_t>(_file.tellg());
+            _file.seekg(0, std::ios::beg);
+            ReadNextBlock();
+        }
+
+        ~ReadAheadStreamBuffer()
+        {
+            if (_nextBlock.valid())
+            {
+                _nextBlock.wait();
+            }
+        }
+
+    protected:
+        int_type underflow() override
+        {
+            if (gptr() < egptr())
+            {
+                return traits_type::to_int_type(*gptr());
+            }
+
+            _state.ThrowIfCancelled();
+            if (!_nextBlock.valid())
+            {
+                return traits_type::eof();
+            }
+
+            auto size = _nextBlock.get();
+            if (size == 0)
+            {
+                return traits_type::eof();
+            }
+
+            std::swap(_current, _next);
+            setg(_current.data(), _current.data(), _current.data() + size);
+            _bytesRead += size;
+            _state.SetStageProgress(static_cast<double>(_bytesRead) / std::max<size_t>(_fileSize, 1));
+            ReadNextBlock();
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        static constexpr size_t blockSize = 1 << 20;
+
+        void ReadNextBlock()
+        {
+            _nextBlock = std::async(std::launch::async, [this] {
+                _file.read(_next.data(), static_cast<std::streamsize>(_next.size()));
+                return static_cast<size_t>(_file.gcount());
+            });
+        }
+
+        std::ifstream _file;
+        AsyncLoader::LoadState& _state;
+        std::vector<char> _current;
+        std::vector<char> _next;
+        std::future<size_t> _nextBlock;
+        size_t _fileSize = 0;
+        size_t _bytesRead = 0;
+    };
+
+    class ReadAheadStream : public std::istream
+    {
+    public:
+        ReadAheadStream(const std::string& filename, AsyncLoader::LoadState& state) :
+            std::istream(nullptr),
+            _buffer(filename, state)
+        {
+            rdbuf(&_buffer);
+            // Let the cancellation unwind through the parser instead of being turned into badbit
+            exceptions(std::ios::badbit);
+        }
+
+    private:
+        ReadAheadStreamBuffer _buffer;
+    };
+} // namespace
+
+//
+// LoadState
+//
+void AsyncLoader::LoadState::BeginStage(const std::string& name, double progressEnd)
+{
+    ThrowIfCancelled();
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stage = name;
+    _stageBegin = _progress;
+    _stageEnd = progressEnd;
+}
+
+void AsyncLoader::LoadState::SetStageProgress(double fraction)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _progress = _stageBegin + (_stageEnd - _stageBegin) * std::min(std::max(fraction, 0.0), 1.0);
+}
+
+void AsyncLoader::LoadState::ThrowIfCancelled() const
+{
+    if (_cancelled)
+    {
+        throw LoadCancelled{};
+    }
+}
+
+//
+// AsyncLoader
+//
+AsyncLoader::AsyncLoader() :
+    _state(std::make_shared<LoadState>())
+{
+}
+
+AsyncLoader::~AsyncLoader()
+{
+    Cancel();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+double AsyncLoader::GetProgress() const
+{
+    return _state->_progress;
+}
+
+std::string AsyncLoader::GetStage() const
+{
+    std::lock_guard<std::mutex> lock(_state->_mutex);
+    return _state->_stage;
+}
+
+bool AsyncLoader::IsDone() const
+{
+    std::lock_guard<std::mutex> lock(_state->_mutex);
+    return _state->_done;
+}
+
+bool AsyncLoader::Wait(double timeoutSeconds)
+{
+    std::unique_lock<std::mutex> lock(_state->_mutex);
+    auto isDone = [this] { return _state->_done; };
+    if (timeoutSeconds < 0)
+    {
+        _state->_stopped.wait(lock, isDone);
+        return true;
+    }
+    return _state->_stopped.wait_for(lock, std::chrono::duration<double>(timeoutSeconds), isDone);
+}
+
+void AsyncLoader::Cancel()
+{
+    _state->_cancelled = true;
+}
+
+void AsyncLoader::Start(std::function<void(LoadState&)> load)
+{
+    _thread = std::thread([state = _state, load = std::move(load)] {
+        std::string stage = "done";
+        std::exception_ptr error;
+        try
+        {
+            load(*state);
+            state->_progress = 1.0;
+        }
+        catch (const LoadCancelled&)
+        {
+            stage = "cancelled";
+        }
+        catch (...)
+        {
+            // A cancellation that surfaces through a stream is reported as a cancellation, not an error
+            if (state->_cancelled)
+            {
+                stage = "cancelled";
+            }
+            else
+            {
+                stage = "failed";
+                error = std::current_exception();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(state->_mutex);
+        state->_stage = stage;
+        state->_error = error;
+        state->_done = true;
+        state->_stopped.notify_all();
+    });
+}
+
+void AsyncLoader::WaitForResult()
+{
+    Wait();
+    if (_state->_error)
+    {
+        std::rethrow_exception(_state->_error);
+    }
+    if (GetStage() == "cancelled")
+    {
+        throw ell::utilities::LogicException(ell::utilities::LogicExceptionErrors::illegalState, "The load was cancelled");
+    }
+}
+
+std::unique_ptr<std::istream> AsyncLoader::OpenReadAheadStream(const std::string& filename, LoadState& state)
+{
+    return std::make_unique<ReadAheadStream>(filename, state);
+}
+
+} // namespace ELL_API
@@ -14,6 +14,8 @@
 #include <utilities/include/Exception.h>
 #include <utilities/include/Files.h>
 
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
 
 using namespace ell;
@@ -65,6 +67,27 @@ void AutoDataVector::CopyTo(std::vector<float>& buffer)
     InternalCopyTo<float>(source, buffer);
 }
 
+void AutoDataVector::CopyTo(double* buffer, size_t bufferSize)
+{
+    if (_impl->_vector->PrefixLength() > bufferSize)
+    {
+        throw std::invalid_argument("buffer is smaller than the vector");
+    }
+    // Adding the non-zeros to a zeroed buffer copies them without an intermediate array
+    std::fill_n(buffer, bufferSize, 0.0);
+    _impl->_vector->AddTo(math::RowVectorReference<double>(buffer, bufferSize));
+}
+
+void AutoDataVector::CopyTo(float* buffer, size_t bufferSize)
+{
+    auto source = _impl->_vector->ToArray();
+    if (source.size() > bufferSize)
+    {
+        throw std::invalid_argument("buffer is smaller than the vector");
+    }
+    std::fill(std::copy(source.begin(), source.end(), buffer), buffer + bufferSize, 0.0f);
+}
+
 class AutoSupervisedExample::AutoSupervisedExampleImpl
 {
 public:
@@ -121,6 +144,11 @@ AutoSupervisedExample AutoSupervisedDataset::GetExample(size_t index)
 void AutoSupervisedDataset::Load(std::string filename)
 {
     auto stream = utilities::OpenIfstream(filename);
+    Load(stream);
+}
+
+void AutoSupervisedDataset::Load(std::istream& stream)
+{
     data::AutoSupervisedExampleIterator exampleIterator = ell::common::GetAutoSupervisedExampleIterator(stream);
 
     // load the dataset
@@ -145,4 +173,19 @@ void AutoSupervisedDataset::Save(std::string filename)
     _impl->_dataset.Print(stream);
 }
 
+AutoSupervisedDatasetLoader::AutoSupervisedDatasetLoader(const std::string& filename) :
+    _dataset(std::make_shared<AutoSupervisedDataset>())
+{
+    Start([filename, dataset = _dataset](LoadState& state) {
+        auto stream = OpenReadAheadStream(filename, state);
+        dataset->Load(*stream);
+    });
+}
+
+AutoSupervisedDataset AutoSupervisedDatasetLoader::GetDataset()
+{
+    WaitForResult();
+    return *_dataset;
+}
+
 } // namespace ELL_API
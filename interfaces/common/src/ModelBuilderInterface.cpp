@@ -89,6 +89,35 @@ namespace
         }
         return result;
     }
+
+    template <typename OutputType, typename InputType>
+    std::vector<OutputType> CastValues(const InputType* values, size_t size)
+    {
+        std::vector<OutputType> result(size);
+        std::transform(values, values + size, result.begin(), [](InputType x) { return static_cast<OutputType>(x); });
+        return result;
+    }
+
+    // Adds a ConstantNode whose values are converted to the port type straight from the buffer
+    template <typename ValueType, typename... LayoutType>
+    ell::model::Node* AddConstantNodeFromBuffer(ell::model::Model& model, const ValueType* values, size_t size, PortType type, const LayoutType&... outputLayout)
+    {
+        switch (type)
+        {
+        case PortType::boolean:
+            return model.AddNode<ell::nodes::ConstantNode<bool>>(CastValues<bool>(values, size), outputLayout...);
+        case PortType::integer:
+            return model.AddNode<ell::nodes::ConstantNode<int>>(CastValues<int>(values, size), outputLayout...);
+        case PortType::real:
+            return model.AddNode<ell::nodes::ConstantNode<double>>(CastValues<double>(values, size), outputLayout...);
+        case PortType::smallReal:
+            return model.AddNode<ell::nodes::ConstantNode<float>>(CastValues<float>(values, size), outputLayout...);
+        case PortType::bigInt:
+            return model.AddNode<ell::nodes::ConstantNode<int64_t>>(CastValues<int64_t>(values, size), outputLayout...);
+        default:
+            throw std::invalid_argument("Error: could not create ConstantNode of the requested type");
+        }
+    }
 } // namespace
 
 //
@@ -178,14 +207,16 @@ OutputNode ModelBuilder::AddOutputNode(Model model, const PortMemoryLayout& memo
     return OutputNode(newNode);
 }
 
-Node ModelBuilder::AddClockNode(Model model, PortElements input, double interval, double lagThreshold, const std::string& lagNotificationName)
+Node ModelBuilder::AddClockNode(Model model, PortElements input, double interval, double lagThreshold, const std::string& lagNotificationName, bool dropStaleTicks)
 {
     auto elements = input.GetPortElements();
     auto newNode = model.GetModel().AddNode<ell::nodes::ClockNode>(
         ell::model::PortElements<ell::nodes::TimeTickType>(elements),
         ell::nodes::TimeTickType(interval),
         ell::nodes::TimeTickType(lagThreshold),
-        lagNotificationName);
+        lagNotificationName,
+        nullptr,
+        dropStaleTicks);
     return Node(newNode);
 }
 
@@ -574,6 +605,26 @@ Node ModelBuilder::AddConstantNode(Model model, std::vector<double> values, cons
     return Node(newNode);
 }
 
+Node ModelBuilder::AddConstantNode(Model model, const double* values, size_t valuesSize, PortType type)
+{
+    return Node(AddConstantNodeFromBuffer(model.GetModel(), values, valuesSize, type));
+}
+
+Node ModelBuilder::AddConstantNode(Model model, const double* values, size_t valuesSize, const PortMemoryLayout& outputMemoryLayout, PortType type)
+{
+    return Node(AddConstantNodeFromBuffer(model.GetModel(), values, valuesSize, type, outputMemoryLayout.Get()));
+}
+
+Node ModelBuilder::AddConstantNode(Model model, const float* values, size_t valuesSize, PortType type)
+{
+    return Node(AddConstantNodeFromBuffer(model.GetModel(), values, valuesSize, type));
+}
+
+Node ModelBuilder::AddConstantNode(Model model, const float* values, size_t valuesSize, const PortMemoryLayout& outputMemoryLayout, PortType type)
+{
+    return Node(AddConstantNodeFromBuffer(model.GetModel(), values, valuesSize, type, outputMemoryLayout.Get()));
+}
+
 Node ModelBuilder::AddUnaryOperationNode(Model model, PortElements input, UnaryOperationType op)
 {
     auto operation = static_cast<ell::nodes::UnaryOperationType>(op);
@@ -24,7 +24,10 @@
 #include <model/include/Map.h>
 #include <model/include/OutputNode.h>
 
+#include <utilities/include/BinaryArchiver.h>
+#include <utilities/include/Files.h>
 #include <utilities/include/JsonArchiver.h>
+#include <utilities/include/PhaseTimer.h>
 #include <utilities/include/StringUtil.h>
 
 #include <algorithm>
@@ -864,6 +867,15 @@ CompiledMap Map::Compile(const std::string& targetDevice,
     settings.sinkFunctionName = sinkFunctionName;
     settings.compilerSettings.targetDevice.deviceName = targetDevice;
     settings.compilerSettings.useBlas = compilerSettings.useBlas;
+    settings.jitCacheDirectory = compilerSettings.jitCacheDirectory;
+    settings.planMemory = compilerSettings.planMemory;
+    settings.scheduleForMemory = compilerSettings.scheduleForMemory;
+    settings.aliasPorts = compilerSettings.aliasPorts;
+    settings.cacheRefinement = compilerSettings.cacheRefinement;
+    settings.reentrant = compilerSettings.reentrant;
+    settings.dynamicInputExtent = compilerSettings.dynamicInputExtent;
+    settings.compilerSettings.weightStorageType = ell::utilities::FromString<ell::emitters::WeightStorageType>(compilerSettings.weightStorageType);
+    settings.compilerSettings.fastMathAccuracy = ell::utilities::FromString<ell::emitters::FastMathAccuracy>(compilerSettings.fastMathAccuracy);
 
     ell::model::ModelOptimizerOptions optimizerOptions;
     optimizerOptions["fuseLinearFunctionNodes"] = optimizerSettings.fuseLinearFunctionNodes;
@@ -920,6 +932,31 @@ bool CompiledMap::HasSourceNodes()
     return _sourceNodeState == TriState::Yes;
 }
 
+void CompiledMap::Reset()
+{
+    if (_map != nullptr)
+    {
+        _map->Reset();
+    }
+    if (_instances != nullptr)
+    {
+        _instances->Reset();
+    }
+}
+
+std::shared_ptr<CompiledMapInstances> CompiledMap::GetInstances()
+{
+    if (_map == nullptr)
+    {
+        throw std::invalid_argument("CompiledMap is not valid");
+    }
+    if (_instances == nullptr)
+    {
+        _instances = std::make_shared<CompiledMapInstances>(_map, _inputShape.Size(), _outputShape.Size());
+    }
+    return _instances;
+}
+
 std::vector<double> CompiledMap::ComputeDouble(const std::vector<double>& inputData)
 {
     if (_map != nullptr)
@@ -938,6 +975,16 @@ std::vector<float> CompiledMap::ComputeFloat(const std::vector<float>& inputData
     return {};
 }
 
+void CompiledMap::ComputeDoubleInto(const double* input, size_t inputSize, double* output, size_t outputSize)
+{
+    ComputeInto(input, inputSize, output, outputSize);
+}
+
+void CompiledMap::ComputeFloatInto(const float* input, size_t inputSize, float* output, size_t outputSize)
+{
+    ComputeInto(input, inputSize, output, outputSize);
+}
+
 void CompiledMap::WriteIR(const std::string& filePath)
 {
     if (_map != nullptr)
@@ -975,4 +1022,155 @@ ell::api::CallbackForwarder<float, float>& CompiledMap::GetCallbackForwarder()
 {
     return forwarderFloat;
 }
+
+//
+// CompiledMapInstances
+//
+CompiledMapInstances::CompiledMapInstances(std::shared_ptr<ell::model::IRCompiledMap> map, size_t inputSize, size_t outputSize) :
+    _map(std::move(map)),
+    _inputSize(inputSize),
+    _outputSize(outputSize)
+{
+    const auto& model = _map->GetModel();
+    _hasCallbacks = !model.GetNodesByType<ell::model::SourceNodeBase>().empty() || !model.GetNodesByType<ell::model::SinkNodeBase>().empty();
+    if (_map->IsReentrant() && !_hasCallbacks)
+    {
+        // Cloning the map the first time finishes jitting it, which mustn't happen while another thread uses it
+        _idleInstances.push_back(std::make_shared<ell::model::IRCompiledMap>(_map->Clone()));
+    }
+}
+
+std::shared_ptr<ell::model::IRCompiledMap> CompiledMapInstances::AcquireInstance()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_map->IsReentrant())
+    {
+        _instanceReleased.wait(lock, [this] { return !_isMapBusy; });
+        _isMapBusy = true;
+        return _map;
+    }
+
+    if (_idleInstances.empty())
+    {
+        return std::make_shared<ell::model::IRCompiledMap>(_map->Clone());
+    }
+    auto instance = std::move(_idleInstances.back());
+    _idleInstances.pop_back();
+    return instance;
+}
+
+void CompiledMapInstances::ReleaseInstance(std::shared_ptr<ell::model::IRCompiledMap> instance)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (instance == _map)
+        {
+            _isMapBusy = false;
+        }
+        else
+        {
+            _idleInstances.push_back(std::move(instance));
+        }
+    }
+    _instanceReleased.notify_one();
+}
+
+void CompiledMapInstances::Reset()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& instance : _idleInstances)
+    {
+        instance->Reset();
+    }
+}
+
+//
+// MapLoader
+//
+namespace
+{
+    bool IsBinaryArchiveFile(const std::string& filename)
+    {
+        auto file = ell::utilities::OpenBinaryIfstream(filename);
+        char header[64] = {};
+        file.read(header, sizeof(header));
+        return ell::utilities::BinaryUnarchiver::IsBinaryArchive(header, static_cast<size_t>(file.gcount()));
+    }
+} // namespace
+
+MapLoader::MapLoader(const std::string& filename) :
+    _result(std::make_shared<Result>())
+{
+    Start([filename, result = _result](LoadState& state) {
+        auto map = LoadMap(filename, state);
+        result->map = Map(map);
+    });
+}
+
+MapLoader::MapLoader(const std::string& filename, PortType elementType, const std::string& targetDevice, const std::string& moduleName, const std::string& functionName, const MapCompilerOptions& compilerSettings, const ModelOptimizerOptions& optimizerSettings) :
+    _result(std::make_shared<Result>())
+{
+    if (elementType != PortType::real && elementType != PortType::smallReal)
+    {
+        throw ell::utilities::InputException(ell::utilities::InputExceptionErrors::invalidArgument, "Only maps of doubles (PortType.real) or floats (PortType.smallReal) can be compiled");
+    }
+
+    Start([filename, elementType, targetDevice, moduleName, functionName, compilerSettings, optimizerSettings, result = _result](LoadState& state) {
+        // Reading is usually much faster than compiling
+        state.BeginStage("reading", 0.2);
+        auto map = LoadMap(filename, state);
+        result->map = Map(map);
+
+        state.BeginStage("compiling", 1.0);
+        auto compiledMap = elementType == PortType::real ? result->map.CompileDouble(targetDevice, moduleName, functionName, compilerSettings, optimizerSettings) : result->map.CompileFloat(targetDevice, moduleName, functionName, compilerSettings, optimizerSettings);
+        result->compiledMap = std::make_shared<CompiledMap>(compiledMap);
+        state.ThrowIfCancelled();
+    });
+}
+
+std::shared_ptr<ell::model::Map> MapLoader::LoadMap(const std::string& filename, LoadState& state)
+{
+    auto stream = OpenReadAheadStream(filename, state);
+    if (IsBinaryArchiveFile(filename))
+    {
+        return std::make_shared<ell::model::Map>(ell::common::LoadArchivedMap<ell::utilities::BinaryUnarchiver>(*stream));
+    }
+    return std::make_shared<ell::model::Map>(ell::common::LoadArchivedMap<ell::utilities::JsonUnarchiver>(*stream));
+}
+
+Map MapLoader::GetMap()
+{
+    WaitForResult();
+    return _result->map;
+}
+
+CompiledMap MapLoader::GetCompiledMap()
+{
+    WaitForResult();
+    if (_result->compiledMap == nullptr)
+    {
+        throw ell::utilities::LogicException(ell::utilities::LogicExceptionErrors::illegalState, "The MapLoader wasn't asked to compile the map");
+    }
+    return *_result->compiledMap;
+}
+
+//
+// Phase timing
+//
+void EnablePhaseTiming(bool enable)
+{
+    ell::utilities::EnablePhaseTiming(enable);
+}
+
+void ResetPhaseTimings()
+{
+    ell::utilities::ResetPhaseTimings();
+}
+
+std::string GetPhaseTimings()
+{
+    std::stringstream stream;
+    ell::utilities::WritePhaseTimingsJson(stream);
+    return stream.str();
+}
 } // namespace ELL_API
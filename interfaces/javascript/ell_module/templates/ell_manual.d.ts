@@ -34,3 +34,19 @@ export class PrototypeList {
 export function GenerateDTWClassifier(prototype: DoubleVectorVector): CompiledMap;
 export function GenerateMulticlassDTWClassifier(prototype: PrototypeList): CompiledMap;
 export function GetDTWClassifierCode(prototype: DoubleVectorVector): string;
+
+//
+// asynchronous compute: the promises settle with the output array, which is a new one if it isn't given
+//
+
+declare module 'ell' {
+    interface Map {
+        ComputeDoubleAsync(input: Float64Array, output?: Float64Array): Promise<Float64Array>;
+        ComputeFloatAsync(input: Float32Array, output?: Float32Array): Promise<Float32Array>;
+    }
+
+    interface CompiledMap {
+        ComputeDoubleAsync(input: Float64Array, output?: Float64Array): Promise<Float64Array>;
+        ComputeFloatAsync(input: Float32Array, output?: Float32Array): Promise<Float32Array>;
+    }
+}
@@ -0,0 +1,62 @@
+"use strict";
+
+let path = require('path');
+console.log(path.relative('.', __dirname));
+
+global.app_require = function(name) {
+    return require(__dirname + '/' + name);
+}
+
+var tap = require('tap');
+
+console.log("#" + path.relative('.', __dirname));
+
+const ell = require("ell");
+
+console.log("Loaded ELL");
+
+// A map whose output is its input
+function CreateIdentityMap(size)
+{
+    let shape = new ell.IntVector();
+    shape.add(size);
+    let layout = new ell.PortMemoryLayout(shape);
+
+    let builder = new ell.ModelBuilder();
+    let model = new ell.Model();
+    let inputNode = builder.AddInputNode(model, layout, ell.PortType_real);
+    let outputNode = builder.AddOutputNode(model, layout, new ell.PortElements(inputNode.GetOutputPort("output")));
+    return new ell.Map(model, inputNode, new ell.PortElements(outputNode.GetOutputPort("output")));
+}
+
+function ArraysEqual(a, b)
+{
+    return a.length == b.length && a.every((value, index) => value == b[index]);
+}
+
+const size = 16;
+let map = CreateIdentityMap(size);
+let inputs = [];
+for (let i = 0; i < 8; i++)
+{
+    inputs.push(Float64Array.from({ length: size }, (_, j) => i * size + j));
+}
+
+map.ComputeDoubleAsync(inputs[0]).then(output => {
+    tap.ok(ArraysEqual(output, inputs[0]), 'Test Map.ComputeDoubleAsync');
+});
+
+let compilerSettings = new ell.MapCompilerOptions();
+compilerSettings.useBlas = false;
+compilerSettings.reentrant = true;
+let optimizerSettings = new ell.ModelOptimizerOptions();
+let compiledMap = map.CompileDouble("host", "computeAsyncTest", "predict", compilerSettings, optimizerSettings);
+
+// Requests on a reentrant map run at the same time, on clones of it
+let outputs = inputs.map(() => new Float64Array(size));
+Promise.all(inputs.map((input, i) => compiledMap.ComputeDoubleAsync(input, outputs[i]))).then(results => {
+    tap.ok(results.every((result, i) => result === outputs[i] && ArraysEqual(result, inputs[i])), 'Test CompiledMap.ComputeDoubleAsync');
+});
+
+// The arrays' element type must match the map's
+tap.throws(() => compiledMap.ComputeDoubleAsync(new Float32Array(size)), 'Test CompiledMap.ComputeDoubleAsync with a Float32Array');
@@ -8,5 +8,6 @@ ELL data classes
 
 from ..ell_py import AutoDataVector, \
 AutoSupervisedDataset, \
+AutoSupervisedDatasetLoader, \
 AutoSupervisedExample, \
 StringVector
\ No newline at end of file
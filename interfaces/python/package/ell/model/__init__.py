@@ -10,6 +10,7 @@ from ..ell_py import \
     CompiledMap,\
     Map,\
     MapCompilerOptions,\
+    MapLoader,\
     Model,\
     ModelBuilder,\
     ModelOptimizerOptions,\
@@ -1,3 +1,4 @@
+import concurrent.futures
 import functools
 import ell_helper
 import ell
@@ -11,11 +12,42 @@ def test():
     compiledMap = map.Compile("host", "protonn", "predict", dtype=np.float)
     compiledMap.WriteBitcode("protonnTestData.bc");
 
-    if os.path.isfile("protonnTestData.bc"):
-        return 0
+    if not os.path.isfile("protonnTestData.bc"):
+        print("### compiled_model_test failed to generate bitcode: protonnTestData.bc")
+        return 1
 
-    print("### compiled_model_test failed to generate bitcode: protonnTestData.bc")
-    return 1
+    # The zero-copy compute path writes the same result into a caller-supplied array
+    inputData = np.arange(map.GetInputShape().Size(), dtype=np.float) / 10
+    expected = np.asarray(compiledMap.Compute(inputData, dtype=np.float))
+    outputData = np.zeros(map.GetOutputShape().Size(), dtype=np.float)
+    compiledMap.ComputeInto(inputData, outputData)
+    if not np.allclose(expected, outputData):
+        print("### compiled_model_test ComputeInto result doesn't match Compute")
+        return 1
+
+    # Compute releases the GIL, so a reentrant map can serve requests from several threads at once
+    options = ell.model.MapCompilerOptions()
+    options.reentrant = True
+    reentrantMap = map.Compile("host", "protonn_reentrant", "predict", dtype=np.float, compilerOptions=options)
+    with concurrent.futures.ThreadPoolExecutor(max_workers=4) as executor:
+        results = list(executor.map(lambda _: np.asarray(reentrantMap.Compute(inputData, dtype=np.float)), range(16)))
+    if not all(np.allclose(expected, result) for result in results):
+        print("### compiled_model_test concurrent Compute results don't match Compute")
+        return 1
+
+    # Loading and compiling in the background gives the same compiled map
+    loader = ell.model.MapLoader("protonnTestData.ell", ell.nodes.PortType.real, "host", "protonn_async", "predict",
+                                 ell.model.MapCompilerOptions(), ell.model.ModelOptimizerOptions())
+    loader.Wait()
+    if loader.GetStage() != "done" or loader.GetProgress() != 1.0:
+        print("### compiled_model_test MapLoader ended in stage {}".format(loader.GetStage()))
+        return 1
+    result = np.asarray(loader.GetCompiledMap().Compute(inputData, dtype=np.float))
+    if not np.allclose(expected, result):
+        print("### compiled_model_test MapLoader result doesn't match Compute")
+        return 1
+
+    return 0
 
 
 if __name__ == '__main__':
@@ -18,6 +18,12 @@ def exampleTest(example):
     y = np.asarray(v)
     np.testing.assert_equal(x, y)
 
+    # test we can copy AutoDataVector into a NumPy array in place, zeroing the rest of it
+    z = np.full(len(x) + 2, -1.0)
+    av.CopyTo(z)
+    np.testing.assert_equal(z[:len(x)], x)
+    np.testing.assert_equal(z[len(x):], 0)
+
 def test():
     testing = Testing()
     dataset = ell.data.AutoSupervisedDataset()
@@ -35,6 +41,12 @@ def test():
 
     testing.ProcessTest("Dataset eumeration test", True)
 
+    # Loading in the background gives the same dataset
+    loader = ell.data.AutoSupervisedDatasetLoader(os.path.join(find_ell.get_ell_root(), "examples/data/testData.txt"))
+    loaded = loader.GetDataset()
+    testing.ProcessTest("Dataset async load test", testing.IsEqual(int(loaded.NumExamples()), 200))
+    testing.ProcessTest("Dataset async load progress test", loader.IsDone() and loader.GetStage() == "done" and loader.GetProgress() == 1.0)
+
     return 0
 
 if __name__ == "__main__":
@@ -1,3 +1,5 @@
+import numpy as np
+
 import ell_helper
 import ell
 from testing import Testing
@@ -17,9 +19,26 @@ def testModelBuilder(testing):
     mb.AddNode(model, "OutputNode<double>", outArgs)
     testing.ProcessTest("Testing ModelBuilder", testing.IsEqual(model.Size(), 2))
 
+def testNumpyWeights(testing):
+    # NumPy arrays are read through the buffer protocol, and need not be float64
+    model = ell.model.Model()
+    mb = ell.model.ModelBuilder()
+    values = np.arange(6, dtype=np.float32)
+    node = mb.AddConstantNode(model, values, ell.nodes.PortType.smallReal)
+    port = node.GetOutputPort("output")
+    testing.ProcessTest("Testing AddConstantNode from a NumPy array",
+                        testing.IsEqual(port.Size(), 6) and port.GetOutputType() == ell.nodes.PortType.smallReal)
+
+    tensor = ell.math.DoubleTensor(np.arange(24, dtype=np.int32).reshape(2, 3, 4))
+    shape = tensor.shape
+    testing.ProcessTest("Testing DoubleTensor from a NumPy array",
+                        testing.IsEqual([shape.rows, shape.columns, shape.channels], [2, 3, 4]) and
+                        testing.IsEqual(list(tensor.data), [float(i) for i in range(24)]))
+
 def test():
     testing = Testing()
     testModelBuilder(testing)
+    testNumpyWeights(testing)
     if testing.DidTestFail():
         return 1
     else:
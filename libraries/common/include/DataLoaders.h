@@ -12,6 +12,7 @@
 
 #include <data/include/Dataset.h>
 #include <data/include/ExampleIterator.h>
+#include <data/include/StreamingDataset.h>
 
 #include <model/include/Map.h>
 
@@ -19,6 +20,7 @@
 
 #include <istream>
 #include <string>
+#include <vector>
 
 namespace ell
 {
@@ -35,6 +37,22 @@ namespace common
     template <typename TextLineIteratorType, typename MetadataParserType, typename DataVectorParserType>
     auto GetExampleIterator(std::istream& stream);
 
+    /// <summary>
+    /// Gets an ExampleIterator from an input stream that reads and parses the examples ahead of time on a
+    /// background thread. The stream must not be used elsewhere while the iterator is alive.
+    /// </summary>
+    ///
+    /// <typeparam name="TextLineIteratorType"> Line iterator type. </typeparam>
+    /// <typeparam name="MetadataParserType"> Metadata parser type. </typeparam>
+    /// <typeparam name="DataVectorParserType"> DataVector parser type. </typeparam>
+    /// <param name="stream"> Input stream to load data from. </param>
+    /// <param name="blockSize"> The number of examples the background thread parses at a time. </param>
+    /// <param name="maxQueuedBlocks"> The maximal number of blocks parsed ahead of the current one. </param>
+    ///
+    /// <returns> The data iterator. </returns>
+    template <typename TextLineIteratorType, typename MetadataParserType, typename DataVectorParserType>
+    auto GetPrefetchingExampleIterator(std::istream& stream, size_t blockSize = 256, size_t maxQueuedBlocks = 4);
+
     /// <summary> Gets an AutoSupervisedExampleIterator iterator from an input stream. </summary>
     ///
     /// <param name="stream"> Input stream to load data from. </param>
@@ -42,6 +60,16 @@ namespace common
     /// <returns> The data iterator. </returns>
     data::AutoSupervisedExampleIterator GetAutoSupervisedExampleIterator(std::istream& stream);
 
+    /// <summary>
+    /// Gets an AutoSupervisedExampleIterator iterator from an input stream, which reads and parses the examples
+    /// ahead of time on a background thread.
+    /// </summary>
+    ///
+    /// <param name="stream"> Input stream to load data from. </param>
+    ///
+    /// <returns> The data iterator. </returns>
+    data::AutoSupervisedExampleIterator GetPrefetchingAutoSupervisedExampleIterator(std::istream& stream);
+
     /// <summary> Gets an AutoSupervisedMultiClassExampleIterator iterator from an input stream. </summary>
     ///
     /// <param name="stream"> Input stream to load data from. </param>
@@ -64,21 +92,73 @@ namespace common
     data::AutoSupervisedMultiClassDataset GetMultiClassDataset(std::istream& stream);
 
     /// <summary>
-    /// Gets a new dataset by running an existing dataset through a map.
+    /// Gets an AutoSupervisedDataset dataset from a file, by mapping the file into memory and parsing it
+    /// on several threads.
+    /// </summary>
+    ///
+    /// <param name="filename"> The file to load data from. </param>
+    /// <param name="numThreads"> The number of threads to use, zero to use one per core. </param>
+    ///
+    /// <returns> The dataset. </returns>
+    data::AutoSupervisedDataset GetDatasetInParallel(const std::string& filename, size_t numThreads = 0);
+
+    /// <summary>
+    /// Gets an AutoSupervisedDataset dataset from a file in either the binary dataset format (see
+    /// data::WriteBinaryDataset) or the text format, which is parsed on several threads.
+    /// </summary>
+    ///
+    /// <param name="filename"> The file to load data from. </param>
+    ///
+    /// <returns> The dataset. </returns>
+    data::AutoSupervisedDataset LoadDataset(const std::string& filename);
+
+    /// <summary>
+    /// Gets an AutoSupervisedMultiClassDataset dataset from a file in either the binary dataset format, where each
+    /// example's label is its class index, or the text format, which is parsed on several threads.
+    /// </summary>
+    ///
+    /// <param name="filename"> The file to load data from. </param>
+    ///
+    /// <returns> The dataset. </returns>
+    data::AutoSupervisedMultiClassDataset LoadMultiClassDataset(const std::string& filename);
+
+    /// <summary> Saves a dataset to a file in the binary dataset format. </summary>
+    ///
+    /// <param name="dataset"> The dataset. </param>
+    /// <param name="filename"> The file to write. </param>
+    /// <param name="numThreads"> The number of threads that encode the examples, zero to use one per core. </param>
+    void SaveBinaryDataset(const data::AutoSupervisedDataset& dataset, const std::string& filename, size_t numThreads = 0);
+
+    /// <summary>
+    /// Gets a dataset that reads its examples from a set of files as it is iterated over, instead of loading
+    /// them into memory.
+    /// </summary>
+    ///
+    /// <param name="filenames"> The files (shards) that hold the examples. </param>
+    /// <param name="maxExamplesInMemory"> The number of examples read into memory at a time. </param>
+    ///
+    /// <returns> The streaming dataset. </returns>
+    data::AutoSupervisedStreamingDataset GetStreamingDataset(const std::vector<std::string>& filenames, size_t maxExamplesInMemory);
+
+    /// <summary>
+    /// Gets a new dataset by running an existing dataset through a map, on several threads that each run
+    /// a copy of the map.
     /// </summary>
     ///
     /// <typeparam name="ExampleType"> Example type. </typeparam>
     /// <typeparam name="MapType"> Map type. </typeparam>
     /// <param name="input"> Input dataset. </param>
     /// <param name="map"> Map to run input dataset on. </param>
+    /// <param name="numThreads"> The number of threads to use, zero to use one per core. </param>
     ///
     /// <returns> The transformed dataset. </returns>
     template <typename ExampleType, typename MapType>
-    auto TransformDataset(data::Dataset<ExampleType>& input, const MapType& map);
+    auto TransformDataset(data::Dataset<ExampleType>& input, const MapType& map, size_t numThreads = 0);
 
     /// <summary>
     /// The map is first compiled, then a new dataset is returned
-    /// by running an existing dataset through the compiled map.
+    /// by running an existing dataset through the compiled map. Maps without source nodes run on
+    /// several threads, each with its own clone of the compiled map.
     /// </summary>
     ///
     /// <typeparam name="ExampleType"> Example type. </typeparam>
@@ -86,15 +166,17 @@ namespace common
     /// <param name="input"> Input dataset. </param>
     /// <param name="map"> Map to run input dataset on. </param>
     /// <param name="useBlas"> Use BLAS in the emitted code to speed up linear algerbra operations. </param>
+    /// <param name="numThreads"> The number of threads to use, zero to use one per core. </param>
     ///
     /// <returns> The transformed dataset. </returns>
     template <typename ExampleType, typename MapType>
-    auto TransformDatasetWithCompiledMap(data::Dataset<ExampleType>& input, const MapType& map, bool useBlas = true);
+    auto TransformDatasetWithCompiledMap(data::Dataset<ExampleType>& input, const MapType& map, bool useBlas = true, size_t numThreads = 0);
 } // namespace common
 } // namespace ell
 
 #pragma region implementation
 
+#include <data/include/PrefetchingExampleIterator.h>
 #include <data/include/SingleLineParsingExampleIterator.h>
 
 #include <model/include/IRCompiledMap.h>
@@ -102,6 +184,9 @@ namespace common
 
 #include <nodes/include/ClockNode.h> // for nodes::TimeTickType
 
+#include <functional>
+#include <memory>
+
 namespace ell
 {
 namespace common
@@ -118,13 +203,26 @@ namespace common
         return data::MakeSingleLineParsingExampleIterator(std::move(textLineIterator), std::move(metadataParser), std::move(dataVectorParser));
     }
 
+    template <typename TextLineIteratorType, typename MetadataParserType, typename DataVectorParserType>
+    auto GetPrefetchingExampleIterator(std::istream& stream, size_t blockSize, size_t maxQueuedBlocks)
+    {
+        auto iterator = GetExampleIterator<TextLineIteratorType, MetadataParserType, DataVectorParserType>(stream);
+        return data::MakePrefetchingExampleIterator(std::move(iterator), blockSize, maxQueuedBlocks);
+    }
+
     template <typename ExampleType, typename MapType>
-    auto TransformDataset(data::Dataset<ExampleType>& input, MapType& map)
+    auto TransformDataset(data::Dataset<ExampleType>& input, const MapType& map, size_t numThreads)
     {
-        return input.template Transform<ExampleType>([&map](const ExampleType& example) {
-            auto transformedDataVector = map.template Compute<data::DoubleDataVector>(example.GetDataVector());
-            return ExampleType(std::move(transformedDataVector), example.GetMetadata());
-        });
+        using TransformationFunction = std::function<ExampleType(const ExampleType&)>;
+        return input.template TransformInParallel<ExampleType>([&map]() -> TransformationFunction {
+            // computing with a map changes its state, so each thread gets a copy
+            auto threadMap = std::make_shared<MapType>(map);
+            return [threadMap](const ExampleType& example) {
+                auto transformedDataVector = threadMap->template Compute<data::DoubleDataVector>(example.GetDataVector());
+                return ExampleType(std::move(transformedDataVector), example.GetMetadata());
+            };
+        },
+                                                               numThreads);
     }
 
     namespace detail
@@ -186,7 +284,7 @@ namespace common
     } // namespace detail
 
     template <typename ExampleType, typename MapType>
-    auto TransformDatasetWithCompiledMap(data::Dataset<ExampleType>& input, const MapType& map, bool useBlas)
+    auto TransformDatasetWithCompiledMap(data::Dataset<ExampleType>& input, const MapType& map, bool useBlas, size_t numThreads)
     {
         ell::model::MapCompilerOptions settings;
         settings.compilerSettings.useBlas = useBlas;
@@ -214,31 +312,34 @@ namespace common
         else
         {
             auto type = map.GetInputType();
-            switch (type)
+            if (type != model::Port::PortType::smallReal && type != model::Port::PortType::real)
             {
-            case model::Port::PortType::smallReal:
-            {
-                return input.template Transform<ExampleType>([&compiledMap](const ExampleType& example) {
-                    auto data = example.GetDataVector().ToArray();
-                    std::vector<float> smallData(data.size());
-                    std::transform(data.begin(), data.end(), smallData.begin(), [](double val) { return static_cast<float>(val); });
-                    compiledMap.SetInputValue(0, smallData);
-                    auto transformedDataVector = compiledMap.template ComputeOutput<typename ExampleType::DataVectorType>(0);
-                    return ExampleType(std::move(transformedDataVector), example.GetMetadata());
-                });
-            }
-            case model::Port::PortType::real:
-            {
-                return input.template Transform<ExampleType>([&compiledMap](const ExampleType& example) {
-                    compiledMap.SetInputValue(0, example.GetDataVector().ToArray());
-                    auto transformedDataVector = compiledMap.template ComputeOutput<typename ExampleType::DataVectorType>(0);
-                    return ExampleType(std::move(transformedDataVector), example.GetMetadata());
-                });
-            }
-            default:
                 throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch,
                     utilities::FormatString("Unexpected input type %d, expecting float or double", type));
             }
+
+            // a compiled map holds its input and output buffers, so each thread gets a clone of it
+            using TransformationFunction = std::function<ExampleType(const ExampleType&)>;
+            return input.template TransformInParallel<ExampleType>([&compiledMap, type]() -> TransformationFunction {
+                auto threadMap = std::make_shared<model::IRCompiledMap>(compiledMap.Clone());
+                if (type == model::Port::PortType::smallReal)
+                {
+                    return [threadMap](const ExampleType& example) {
+                        auto data = example.GetDataVector().ToArray();
+                        std::vector<float> smallData(data.size());
+                        std::transform(data.begin(), data.end(), smallData.begin(), [](double val) { return static_cast<float>(val); });
+                        threadMap->SetInputValue(0, smallData);
+                        auto transformedDataVector = threadMap->template ComputeOutput<typename ExampleType::DataVectorType>(0);
+                        return ExampleType(std::move(transformedDataVector), example.GetMetadata());
+                    };
+                }
+                return [threadMap](const ExampleType& example) {
+                    threadMap->SetInputValue(0, example.GetDataVector().ToArray());
+                    auto transformedDataVector = threadMap->template ComputeOutput<typename ExampleType::DataVectorType>(0);
+                    return ExampleType(std::move(transformedDataVector), example.GetMetadata());
+                };
+            },
+                                                                   numThreads);
         }
     }
 } // namespace common
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DistributedTrainingArguments.h (common)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <utilities/include/CommandLineParser.h>
+
+#include <trainers/include/AllReduce.h>
+
+#include <memory>
+#include <string>
+
+namespace ell
+{
+namespace common
+{
+    /// <summary> A struct that holds command line arguments for training on several processes, each with its own shard of the data. </summary>
+    struct DistributedTrainingArguments
+    {
+        /// <summary> The number of processes that train together. </summary>
+        size_t numProcesses;
+
+        /// <summary> The index of this process, between 0 and numProcesses - 1. </summary>
+        size_t rank;
+
+        /// <summary> The host name or address of the process with rank 0, which it listens on. </summary>
+        std::string rootAddress;
+
+        /// <summary> The port the process with rank 0 listens on. </summary>
+        int port;
+
+        /// <summary> A string that all the processes that train together share, and no others. </summary>
+        std::string jobToken;
+
+        /// <summary> The number of epochs between averages of the trainers. </summary>
+        size_t synchronizationInterval;
+
+        /// <summary> Indicates if this process trains together with others. </summary>
+        bool IsDistributed() const { return numProcesses > 1; }
+
+        /// <summary> Indicates if this process should report results and save the model. </summary>
+        bool IsRoot() const { return rank == 0; }
+    };
+
+    /// <summary> A version of DistributedTrainingArguments that adds its members to the command line parser. </summary>
+    struct ParsedDistributedTrainingArguments : public DistributedTrainingArguments
+        , public utilities::ParsedArgSet
+    {
+        /// <summary> Adds the arguments to the command line parser. </summary>
+        ///
+        /// <param name="parser"> [in,out] The parser. </param>
+        void AddArgs(utilities::CommandLineParser& parser) override;
+
+        /// <summary> Checks the parsed arguments. </summary>
+        ///
+        /// <param name="parser"> The parser. </param>
+        ///
+        /// <returns> An utilities::CommandLineParseResult. </returns>
+        utilities::CommandLineParseResult PostProcess(const utilities::CommandLineParser& parser) override;
+    };
+
+    /// <summary> Connects this process to the others it trains with. </summary>
+    ///
+    /// <param name="arguments"> The distributed training arguments. </param>
+    ///
+    /// <returns> This process's part of the group. </returns>
+    std::unique_ptr<trainers::IAllReduce> MakeAllReduce(const DistributedTrainingArguments& arguments);
+} // namespace common
+} // namespace ell
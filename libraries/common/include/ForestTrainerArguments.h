@@ -10,6 +10,7 @@
 
 #include <utilities/include/CommandLineParser.h>
 
+#include <trainers/include/BinnedForestTrainer.h>
 #include <trainers/include/HistogramForestTrainer.h>
 #include <trainers/include/SortingForestTrainer.h>
 
@@ -19,8 +20,10 @@ namespace common
 {
     struct ForestTrainerArguments : public trainers::SortingForestTrainerParameters
         , public trainers::HistogramForestTrainerParameters
+        , public trainers::BinnedForestTrainerParameters
     {
         bool sortingTrainer;
+        bool binnedTrainer;
     };
 
     /// <summary> Parsed version of sorting tree trainer parameters. </summary>
@@ -19,13 +19,15 @@ namespace ell
 {
 namespace common
 {
-    /// <summary> Loads a model from a file, or creates a new one if given an empty filename. </summary>
+    /// <summary> Loads a model from a file, or creates a new one if given an empty filename. The file can be a JSON
+    /// or a binary archive. </summary>
     ///
     /// <param name="filename"> The filename. </param>
     /// <returns> The loaded model. </returns>
     model::Model LoadModel(const std::string& filename);
 
-    /// <summary> Saves a model to a file. </summary>
+    /// <summary> Saves a model to a file. Files with the extension ".ellb" are written in the binary archive format,
+    /// others as JSON. </summary>
     ///
     /// <param name="model"> The model. </param>
     /// <param name="filename"> The filename. </param>
@@ -47,7 +49,8 @@ namespace common
     /// <param name="context"> The `SerializationContext` </param>
     void RegisterMapTypes(utilities::SerializationContext& context);
 
-    /// <summary> Loads a map from a file, or creates a new one if given an empty filename. </summary>
+    /// <summary> Loads a map from a file, or creates a new one if given an empty filename. The file can be a JSON
+    /// or a binary archive. </summary>
     ///
     /// <param name="filename"> The filename. </param>
     /// <returns> The loaded map. </returns>
@@ -59,7 +62,8 @@ namespace common
     /// <returns> The loaded map. </returns>
     model::Map LoadMap(const MapLoadArguments& mapLoadArguments);
 
-    /// <summary> Saves a map to a file. </summary>
+    /// <summary> Saves a map to a file. Files with the extension ".ellb" are written in the binary archive format,
+    /// others as JSON. </summary>
     ///
     /// <param name="map"> The map. </param>
     /// <param name="filename"> The filename. </param>
@@ -91,20 +95,22 @@ namespace common
 #include <utilities/include/Exception.h>
 #include <utilities/include/Files.h>
 #include <utilities/include/JsonArchiver.h>
+#include <utilities/include/PhaseTimer.h>
 
 namespace ell
 {
 namespace common
 {
     // STYLE internal use only from implementation, so not declared in main part of header file
-    template <typename UnarchiverType>
-    model::Map LoadArchivedMap(std::istream& stream)
+    template <typename UnarchiverType, typename SourceType>
+    model::Map LoadArchivedMap(SourceType& source)
     {
         utilities::SerializationContext context;
         RegisterNodeTypes(context);
         RegisterMapTypes(context);
         AddCustomTypes(context);
-        UnarchiverType unarchiver(stream, context);
+        utilities::PhaseTimer timer("Unarchive");
+        UnarchiverType unarchiver(source, context);
         model::Map map;
         unarchiver.Unarchive(map);
         return map;
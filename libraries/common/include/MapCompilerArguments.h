@@ -36,22 +36,87 @@ namespace common
 
         // ELL codegen options
         bool profile = false;
+        bool profileHardwareCounters = false;
+        bool profileLatencyHistograms = false;
+        int profileSamplingInterval = 1;
+        bool traceExecution = false;
         bool optimize = true;
+        int optimizationThreads = 1;
+        int optimizationLevel = 3;
+        emitters::SizeOptimization sizeOptimization = emitters::SizeOptimization::speed; // -Os / -Oz, e.g. for flash-limited microcontrollers
+        bool allowInlining = true;
+        double maxOptimizationSeconds = 0;
         bool useBlas = false;
+        emitters::BlasType blasType = emitters::BlasType::unknown;
+        int blasThreads = 0;
+        int blasMinOperationsPerThread = 1 << 15;
+        bool useBlockedGemm = true;
+        int smallGemmThreshold = 0;
+        bool useGpu = false; // run large matrix products on the GPU through the ELL runtime library
+        int gpuMinOperations = 1 << 22;
+        bool useCmsis = false; // call CMSIS-DSP for int8 dot products and FFTs on Cortex-M targets
+        emitters::WeightStorageType weightStorageType = emitters::WeightStorageType::float32;
+        int prefetchDistance = -1; // bytes ahead to prefetch in weight-streaming loops; -1 uses the target device's default
+        emitters::FastMathAccuracy fastMathAccuracy = emitters::FastMathAccuracy::high;
         bool debug = false;
+        bool emitBatchPredictFunction = false;
+        bool planMemory = false;
+        bool scheduleForMemory = false;
+        bool aliasPorts = true;
+        bool reentrant = false;
+        bool externalWeights = false;
+        bool dynamicInputExtent = false;
         utilities::Optional<bool> positionIndependentCode = false; // for generating -fPIC object code
 
         // potentially per-node options:
         bool enableVectorization = true;
         int vectorWidth = 4;
+        std::string cpuDispatchLevels = ""; // x86 instruction set levels to compile node functions for, e.g. "sse4.2,avx2"
         bool parallelize = true;
         bool useThreadPool = true;
+        bool useWorkStealing = false;
+        int threadPoolSpinCount = 0;
+        bool hotThreadPool = false;
+        emitters::ParallelLoopSchedule parallelLoopSchedule = emitters::ParallelLoopSchedule::staticBlocks;
+        int parallelLoopChunkSize = 0;
+        bool useSharedRuntime = false; // use the process-wide thread pool of the ELL runtime library
         int maxThreads = 4;
+        std::string threadAffinity = ""; // list of cores to pin thread pool workers to, e.g. "0,2,4-7"
+        bool useHugePages = false; // back large buffers with 2 MB huge pages
+        bool firstTouchBuffers = false; // have each worker thread touch its part of the large buffers first
+        // Run source and sink callbacks on their own threads. The source callback is called on another thread
+        // while the model runs, to fetch the sample for the next call, so the model returns the output for a sample
+        // one call old (the first call fetches its own). The sink callback gets a copy of its input on another thread.
+        // The callbacks must be safe to call from a thread other than the caller's, and the model's reset function
+        // waits for them to finish.
+        bool asyncCallbacks = false;
+        bool parallelizeBranches = false; // run independent branches of the model on their own threads
 
         // optimization options (configurable per-node)
         bool fuseLinearOperations = true;
+        bool fuseElementwiseOperations = false;
+        bool fuseConvolutionEpilogues = true;
+        bool fuseInputPreprocessing = true;
+        bool fuseAudioFrontEnd = true;
+        bool fusePoolingActivations = true;
+        bool fuseSoftmaxTopK = true;
+        bool prepackWeights = true;
+        bool quantizeLayers = false;
+        std::string fixedPointDSP; // the fixed-point format for the DSP nodes, like "q15" (empty to keep them floating-point)
+        bool flattenForests = false;
+        bool searchNodeOptions = false;
         bool optimizeReorderDataNodes = true;
-        PreferredConvolutionMethod convolutionMethod = PreferredConvolutionMethod::automatic; // known methods: auto, unrolled, simple, diagonal, winograd
+        bool foldConstants = true;
+        bool eliminateCommonSubexpressions = true;
+        double factorizeFullyConnectedTolerance = 0; // the relative error allowed when factoring fully-connected layers (0 disables it)
+        double sparseWeightsDensity = 0.3; // the fraction of nonzero weights below which a layer uses sparse kernels (0 disables them)
+        int palettizeWeightsBits = 0; // the bits of the codebook indices that replace the weights of layers, 4 or 8 (0 keeps the weights)
+        bool propagateLayouts = false;
+        bool implicitPadding = false;
+        PreferredConvolutionMethod convolutionMethod = PreferredConvolutionMethod::automatic; // known methods: auto, unrolled, simple, diagonal, winograd, autotune
+        std::string convolutionMethodCache; // file to load and store autotuned convolution methods in
+        int winogradTileSize = 2; // output tile size of Winograd convolutions: 2, 4 or 6
+        int implicitGemmPanelSize = 0; // size in bytes of the input panels of unrolled convolutions (0 to build the whole receptive field matrix)
 
         // raw options to store in metadata
         std::vector<std::string> modelOptions; // in format "<option-name>,<option-value-string>"
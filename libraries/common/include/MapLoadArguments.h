@@ -39,6 +39,9 @@ namespace common
         /// <summary> The default size for the input of a newly-generated map (e.g., if no model/map file is specified) </summary>
         size_t defaultInputSize;
 
+        /// <summary> The file to write a report of the time spent loading, refining, optimizing and compiling the map to ("<cout>" for stdout, empty for no report). </summary>
+        std::string timingReportFilename = "";
+
         /// <summary> Query if the arguments specify a map file. </summary>
         ///
         /// <returns> true if the arguments specify a map file. </returns>
@@ -70,6 +73,14 @@ namespace common
         /// <param name="model"> The model as specified by the input model filename </param>
         /// <returns> The specified output to use for the map. </returns>
         const model::OutputPortBase* GetOutput(model::Model& model) const;
+
+        /// <summary> Query if the arguments ask for a timing report. </summary>
+        ///
+        /// <returns> true if the arguments specify a timing report file. </returns>
+        bool HasTimingReport() const { return timingReportFilename != ""; }
+
+        /// <summary> Writes the phases timed so far as JSON to the timing report file, if there is one. </summary>
+        void WriteTimingReport() const;
     };
 
     /// <summary> A version of MapLoadArguments that adds its members to the command line parser. </summary>
@@ -10,6 +10,7 @@
 #include "DataLoaders.h"
 
 #include <utilities/include/CStringParser.h>
+#include <utilities/include/DecompressingStream.h>
 #include <utilities/include/Files.h>
 
 #include <algorithm>
@@ -98,8 +99,8 @@ namespace common
                 return parseErrorMessages;
             }
 
-            auto stream = utilities::OpenIfstream(GetDataFilePath());
-            auto exampleIterator = GetAutoSupervisedExampleIterator(stream);
+            auto stream = utilities::OpenDecompressingIfstream(GetDataFilePath());
+            auto exampleIterator = GetAutoSupervisedExampleIterator(*stream);
             while (exampleIterator.IsValid())
             {
                 auto size = exampleIterator.Get().GetDataVector().PrefixLength();
@@ -8,29 +8,80 @@
 
 #include "DataLoaders.h"
 
+#include <utilities/include/DecompressingStream.h>
+#include <utilities/include/Exception.h>
 #include <utilities/include/Files.h>
+#include <utilities/include/MemoryMappedFile.h>
 
 #include <data/include/Dataset.h>
 #include <data/include/SequentialLineIterator.h>
 
 #include <data/include/AutoDataVector.h>
+#include <data/include/BinaryDataset.h>
 #include <data/include/GeneralizedSparseParsingIterator.h>
+#include <data/include/ParallelParsing.h>
 #include <data/include/SingleLineParsingExampleIterator.h>
+#include <data/include/WeightClassIndex.h>
 #include <data/include/WeightLabel.h>
 
 #include <memory>
 #include <stdexcept>
+#include <utility>
 
 namespace ell
 {
 namespace common
 {
+    namespace
+    {
+        // Calls a function with the contents of a file, mapped into memory, or decompressed into memory if the
+        // file is gzip or zstd compressed
+        template <typename FunctionType>
+        auto WithFileContents(const std::string& filename, FunctionType&& function)
+        {
+            if (utilities::GetFileCompressionFormat(filename) != utilities::CompressionFormat::none)
+            {
+                auto contents = utilities::ReadDecompressedFile(filename);
+                return function(contents.data(), contents.data() + contents.size());
+            }
+            utilities::MemoryMappedFile file(filename);
+            return function(file.begin(), file.end());
+        }
+
+        // parses a stream like SingleLineParsingExampleIterator does, but into the dataset's arena
+        template <typename MetadataParserType>
+        auto ParseDataset(std::istream& stream)
+        {
+            using DataVectorParserType = data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>;
+            data::Dataset<data::Example<DataVectorParserType::type, typename MetadataParserType::type>> dataset;
+            data::SequentialLineIterator lineIterator(stream);
+            for (; lineIterator.IsValid(); lineIterator.Next())
+            {
+                auto line = lineIterator.GetTextLine();
+                line.TrimLeadingWhitespace();
+                if (line.IsEndOfContent())
+                {
+                    continue;
+                }
+
+                auto metadata = MetadataParserType::Parse(line);
+                auto dataVector = DataVectorParserType::Parse(line);
+                dataset.AddExample(std::move(dataVector), std::move(metadata));
+            }
+            return dataset;
+        }
+    } // namespace
 
     data::AutoSupervisedExampleIterator GetAutoSupervisedExampleIterator(std::istream& stream)
     {
         return GetExampleIterator<data::SequentialLineIterator, data::LabelParser, data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>>(stream);
     }
 
+    data::AutoSupervisedExampleIterator GetPrefetchingAutoSupervisedExampleIterator(std::istream& stream)
+    {
+        return GetPrefetchingExampleIterator<data::SequentialLineIterator, data::LabelParser, data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>>(stream);
+    }
+
     data::AutoSupervisedMultiClassExampleIterator GetAutoSupervisedMultiClassExampleIterator(std::istream& stream)
     {
         return GetExampleIterator<data::SequentialLineIterator, data::ClassIndexParser, data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>>(stream);
@@ -38,12 +89,60 @@ namespace common
 
     data::AutoSupervisedDataset GetDataset(std::istream& stream)
     {
-        return data::MakeDataset(GetExampleIterator<data::SequentialLineIterator, data::LabelParser, data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>>(stream));
+        return ParseDataset<data::LabelParser>(stream);
     }
 
     data::AutoSupervisedMultiClassDataset GetMultiClassDataset(std::istream& stream)
     {
-        return data::MakeDataset(GetExampleIterator<data::SequentialLineIterator, data::ClassIndexParser, data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>>(stream));
+        return ParseDataset<data::ClassIndexParser>(stream);
+    }
+
+    data::AutoSupervisedDataset GetDatasetInParallel(const std::string& filename, size_t numThreads)
+    {
+        return WithFileContents(filename, [numThreads](const char* begin, const char* end) -> data::AutoSupervisedDataset {
+            return data::ParseDatasetInParallel(begin, end, data::LabelParser(), data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>(), numThreads);
+        });
+    }
+
+    data::AutoSupervisedDataset LoadDataset(const std::string& filename)
+    {
+        return WithFileContents(filename, [](const char* begin, const char* end) -> data::AutoSupervisedDataset {
+            if (data::IsBinaryDataset(begin, end))
+            {
+                return data::ReadBinaryDataset(begin, end);
+            }
+            return data::ParseDatasetInParallel(begin, end, data::LabelParser(), data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>());
+        });
+    }
+
+    data::AutoSupervisedMultiClassDataset LoadMultiClassDataset(const std::string& filename)
+    {
+        return WithFileContents(filename, [](const char* begin, const char* end) -> data::AutoSupervisedMultiClassDataset {
+            if (data::IsBinaryDataset(begin, end))
+            {
+                auto dataset = data::ReadBinaryDataset(begin, end);
+                return dataset.Transform<data::AutoSupervisedMultiClassExample>([](const auto& example) {
+                    const auto& metadata = example.GetMetadata();
+                    if (metadata.label < 0)
+                    {
+                        throw utilities::InputException(utilities::InputExceptionErrors::badData, "class index can't be negative");
+                    }
+                    return data::AutoSupervisedMultiClassExample(example.GetSharedDataVector(), data::WeightClassIndex{ metadata.weight, static_cast<size_t>(metadata.label) });
+                });
+            }
+            return data::ParseDatasetInParallel(begin, end, data::ClassIndexParser(), data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>());
+        });
+    }
+
+    void SaveBinaryDataset(const data::AutoSupervisedDataset& dataset, const std::string& filename, size_t numThreads)
+    {
+        auto stream = utilities::OpenBinaryOfstream(filename);
+        data::WriteBinaryDataset(dataset, stream, numThreads);
+    }
+
+    data::AutoSupervisedStreamingDataset GetStreamingDataset(const std::vector<std::string>& filenames, size_t maxExamplesInMemory)
+    {
+        return data::AutoSupervisedStreamingDataset(filenames, GetAutoSupervisedExampleIterator, maxExamplesInMemory);
     }
 } // namespace common
 } // namespace ell
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DistributedTrainingArguments.cpp (common)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "DistributedTrainingArguments.h"
+
+namespace ell
+{
+namespace common
+{
+    void ParsedDistributedTrainingArguments::AddArgs(utilities::CommandLineParser& parser)
+    {
+        parser.AddOption(
+            numProcesses,
+            "numProcesses",
+            "np",
+            "The number of processes that train together, each on its own shard of the data (given by --inputDataFilename)",
+            1);
+
+        parser.AddOption(
+            rank,
+            "rank",
+            "",
+            "The index of this process, between 0 and numProcesses - 1. Process 0 reports the results and saves the model",
+            0);
+
+        parser.AddOption(
+            rootAddress,
+            "rootAddress",
+            "",
+            "The host name or address of process 0, which it listens on (0.0.0.0 for all interfaces)",
+            "localhost");
+
+        parser.AddOption(
+            port,
+            "port",
+            "",
+            "The port process 0 listens on",
+            8377);
+
+        parser.AddOption(
+            jobToken,
+            "jobToken",
+            "",
+            "A string shared by all the processes that train together; process 0 drops connections that don't present it",
+            "");
+
+        parser.AddOption(
+            synchronizationInterval,
+            "syncInterval",
+            "",
+            "The number of epochs between averages of the processes' trainers",
+            1);
+    }
+
+    utilities::CommandLineParseResult ParsedDistributedTrainingArguments::PostProcess(const utilities::CommandLineParser& parser)
+    {
+        std::vector<std::string> parseErrorMessages;
+        if (numProcesses == 0)
+        {
+            parseErrorMessages.push_back("The number of processes must be at least 1.");
+        }
+        else if (rank >= numProcesses)
+        {
+            parseErrorMessages.push_back("The rank must be less than the number of processes.");
+        }
+        if (synchronizationInterval == 0)
+        {
+            parseErrorMessages.push_back("The synchronization interval must be at least 1.");
+        }
+        return parseErrorMessages;
+    }
+
+    std::unique_ptr<trainers::IAllReduce> MakeAllReduce(const DistributedTrainingArguments& arguments)
+    {
+        return std::make_unique<trainers::TCPAllReduce>(arguments.rank, arguments.numProcesses, arguments.rootAddress, arguments.port, arguments.jobToken);
+    }
+} // namespace common
+} // namespace ell
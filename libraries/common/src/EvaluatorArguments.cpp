@@ -27,6 +27,13 @@ namespace common
             "aze",
             "Add an evaluation using the constant zero predictor",
             true);
+
+        parser.AddOption(
+            numThreads,
+            "evaluationThreads",
+            "",
+            "Number of threads that evaluate parts of the evaluation dataset (0 = one per core)",
+            1);
     }
 } // namespace common
 } // namespace ell
@@ -50,11 +50,29 @@ namespace common
                          "The number of split candidates to create per input element",
                          8);
 
+        parser.AddOption(numThreads,
+                         "numThreads",
+                         "nt",
+                         "The number of threads to use to search for splits (0 to use one per core)",
+                         0);
+
         parser.AddOption(sortingTrainer,
                          "sortingTrainer",
                          "st",
                          "Use the sorting trainer instead of the histogram trainer",
                          false);
+
+        parser.AddOption(binnedTrainer,
+                         "binnedTrainer",
+                         "bt",
+                         "Use the binned trainer, which quantizes each input element into bins before training, instead of the histogram trainer",
+                         false);
+
+        parser.AddOption(maxBinsPerFeature,
+                         "maxBinsPerFeature",
+                         "mbpf",
+                         "The maximum number of bins per input element in the binned trainer (at most 256)",
+                         256);
     }
 } // namespace common
 } // namespace ell
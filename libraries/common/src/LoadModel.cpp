@@ -17,8 +17,10 @@
 
 #include <nodes/include/AccumulatorNode.h>
 #include <nodes/include/ActivationFunctions.h>
+#include <nodes/include/AudioFrontEndNode.h>
 #include <nodes/include/BinaryOperationNode.h>
 #include <nodes/include/BinaryPredicateNode.h>
+#include <nodes/include/BiquadCascadeNode.h>
 #include <nodes/include/BroadcastFunctionNode.h>
 #include <nodes/include/BroadcastOperationNodes.h>
 #include <nodes/include/BufferNode.h>
@@ -27,15 +29,21 @@
 #include <nodes/include/DCTNode.h>
 #include <nodes/include/DTWDistanceNode.h>
 #include <nodes/include/DelayNode.h>
+#include <nodes/include/DepthwiseConvolutionNode.h>
 #include <nodes/include/DiagonalConvolutionNode.h>
 #include <nodes/include/DotProductNode.h>
+#include <nodes/include/EarlyExitNode.h>
 #include <nodes/include/ExtremalValueNode.h>
 #include <nodes/include/FFTNode.h>
+#include <nodes/include/FusedElementwiseNode.h>
 #include <nodes/include/FilterBankNode.h>
+#include <nodes/include/FixedPointDSPNodes.h>
+#include <nodes/include/FlatForestPredictorNode.h>
 #include <nodes/include/ForestPredictorNode.h>
 #include <nodes/include/GRUNode.h>
 #include <nodes/include/HammingWindowNode.h>
 #include <nodes/include/IIRFilterNode.h>
+#include <nodes/include/InputPreprocessingNode.h>
 #include <nodes/include/L2NormSquaredNode.h>
 #include <nodes/include/LSTMNode.h>
 #include <nodes/include/LinearPredictorNode.h>
@@ -46,14 +54,21 @@
 #include <nodes/include/MovingVarianceNode.h>
 #include <nodes/include/MultiplexerNode.h>
 #include <nodes/include/NeuralNetworkPredictorNode.h>
+#include <nodes/include/PalettizedMatrixMultiplyNode.h>
+#include <nodes/include/PointwiseConvolutionNode.h>
 #include <nodes/include/ProtoNNPredictorNode.h>
+#include <nodes/include/QuantizedLayerNodes.h>
 #include <nodes/include/RNNNode.h>
 #include <nodes/include/ReceptiveFieldMatrixNode.h>
+#include <nodes/include/RegionDetectionPostProcessingNode.h>
 #include <nodes/include/ReinterpretLayoutNode.h>
 #include <nodes/include/ReorderDataNode.h>
 #include <nodes/include/SimpleConvolutionNode.h>
 #include <nodes/include/SinkNode.h>
 #include <nodes/include/SourceNode.h>
+#include <nodes/include/SparseLinearPredictorNode.h>
+#include <nodes/include/SparseMatrixMultiplyNode.h>
+#include <nodes/include/TopKNode.h>
 #include <nodes/include/UnaryOperationNode.h>
 #include <nodes/include/UnrolledConvolutionNode.h>
 #include <nodes/include/VoiceActivityDetectorNode.h>
@@ -72,8 +87,11 @@
 #include <predictors/neural/include/TanhActivation.h>
 
 #include <utilities/include/Archiver.h>
+#include <utilities/include/BinaryArchiver.h>
 #include <utilities/include/Files.h>
 #include <utilities/include/JsonArchiver.h>
+#include <utilities/include/MemoryMappedFile.h>
+#include <utilities/include/PhaseTimer.h>
 
 #include <cstdint>
 
@@ -96,7 +114,9 @@ namespace common
         context.GetTypeFactory().AddType<model::Node, nodes::AccumulatorNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::ArgMaxNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::ArgMinNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::AudioFrontEndNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::BinaryOperationNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::BiquadCascadeNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::BroadcastUnaryFunctionNode<ElementType, nodes::HardSigmoidActivationFunction<ElementType>>>();
         context.GetTypeFactory().AddType<model::Node, nodes::BroadcastUnaryFunctionNode<ElementType, nodes::LeakyReLUActivationFunction<ElementType>>>();
         context.GetTypeFactory().AddType<model::Node, nodes::BroadcastUnaryFunctionNode<ElementType, nodes::ReLUActivationFunction<ElementType>>>();
@@ -109,15 +129,25 @@ namespace common
         context.GetTypeFactory().AddType<model::Node, nodes::ConcatenationNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::ConstantNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::DelayNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::DepthwiseConvolutionNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::DiagonalConvolutionNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::DiagonalConvolutionComputeNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::DotProductNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::DTWDistanceNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::EarlyExitNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::FFTNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::FixedPointDCTNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::FixedPointFFTNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::FixedPointFilterBankNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::FixedPointIIRFilterNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::FixedPointWindowNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::FusedElementwiseNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::GRUNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::HammingWindowNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::L2NormSquaredNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::IIRFilterNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::InputPreprocessingNode<int, ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::InputPreprocessingNode<ElementType, ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::LinearPredictorNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::LinearFilterBankNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::LSTMNode<ElementType>>();
@@ -129,6 +159,8 @@ namespace common
         context.GetTypeFactory().AddType<model::Node, nodes::MovingAverageNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::MovingVarianceNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::NeuralNetworkPredictorNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::PalettizedMatrixMultiplyNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::PointwiseConvolutionNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::ReceptiveFieldMatrixNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::ReorderDataNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::ReinterpretLayoutNode<ElementType>>();
@@ -137,7 +169,10 @@ namespace common
         context.GetTypeFactory().AddType<model::Node, nodes::SimpleConvolutionNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::SinkNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::SourceNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::SparseLinearPredictorNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::SparseMatrixMultiplyNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::SumNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::TopKNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::TypeCastNode<bool, ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::TypeCastNode<int, ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::TypeCastNode<int64_t, ElementType>>();
@@ -158,7 +193,11 @@ namespace common
         context.GetTypeFactory().AddType<model::Node, nodes::ParametricReLUActivationLayerNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::PoolingLayerNode<ElementType, MeanPoolingFunction>>();
         context.GetTypeFactory().AddType<model::Node, nodes::PoolingLayerNode<ElementType, MaxPoolingFunction>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::QuantizedConvolutionalLayerNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::QuantizedFullyConnectedLayerNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::QuantizedRecurrentLayerNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::RegionDetectionLayerNode<ElementType>>();
+        context.GetTypeFactory().AddType<model::Node, nodes::RegionDetectionPostProcessingNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::ScalingLayerNode<ElementType>>();
         context.GetTypeFactory().AddType<model::Node, nodes::SoftmaxLayerNode<ElementType>>();
 
@@ -242,6 +281,8 @@ namespace common
 
         context.GetTypeFactory().AddType<model::Node, nodes::DemultiplexerNode<bool, bool>>();
 
+        context.GetTypeFactory().AddType<model::Node, nodes::FlatForestPredictorNode>();
+
         context.GetTypeFactory().AddType<model::Node, nodes::MultiplexerNode<bool, bool>>();
         context.GetTypeFactory().AddType<model::Node, nodes::MultiplexerNode<int, bool>>();
         context.GetTypeFactory().AddType<model::Node, nodes::MultiplexerNode<int64_t, bool>>();
@@ -295,17 +336,23 @@ namespace common
         context.GetTypeFactory().AddType<model::Map, model::Map>();
     }
 
-    template <typename UnarchiverType>
-    model::Model LoadArchivedModel(std::istream& stream)
+    template <typename UnarchiverType, typename SourceType>
+    model::Model LoadArchivedModel(SourceType& source)
     {
         SerializationContext context;
         RegisterNodeTypes(context);
-        UnarchiverType unarchiver(stream, context);
+        PhaseTimer timer("Unarchive");
+        UnarchiverType unarchiver(source, context);
         model::Model model;
         unarchiver.Unarchive(model);
         return model;
     }
 
+    bool IsBinaryArchiveFilename(const std::string& filename)
+    {
+        return GetFileExtension(filename, true) == "ellb";
+    }
+
     template <typename ArchiverType, typename ObjectType>
     void SaveArchivedObject(const ObjectType& obj, std::ostream& stream)
     {
@@ -315,11 +362,19 @@ namespace common
 
     model::Model LoadModel(const std::string& filename)
     {
+        PhaseTimer timer("Load model");
         if (!IsFileReadable(filename))
         {
             throw SystemException(SystemExceptionErrors::fileNotFound);
         }
 
+        // Binary archives are read in place from the mapped file, rather than parsed from a stream
+        MemoryMappedFile file(filename);
+        if (BinaryUnarchiver::IsBinaryArchive(file.begin(), file.Size()))
+        {
+            return LoadArchivedModel<BinaryUnarchiver>(file);
+        }
+
         auto filestream = OpenIfstream(filename);
         return LoadArchivedModel<JsonUnarchiver>(filestream);
     }
@@ -330,6 +385,14 @@ namespace common
         {
             throw SystemException(SystemExceptionErrors::fileNotWritable);
         }
+
+        if (IsBinaryArchiveFilename(filename))
+        {
+            auto filestream = OpenBinaryOfstream(filename);
+            SaveArchivedObject<BinaryArchiver>(model, filestream);
+            return;
+        }
+
         auto filestream = OpenOfstream(filename);
         SaveModel(model, filestream);
     }
@@ -410,15 +473,21 @@ namespace common
             return model::Map{};
         }
 
+        PhaseTimer timer("Load map");
         if (!IsFileReadable(filename))
         {
             throw SystemException(SystemExceptionErrors::fileNotFound);
         }
 
-        auto filestream = OpenIfstream(filename);
-
         try
         {
+            MemoryMappedFile file(filename);
+            if (BinaryUnarchiver::IsBinaryArchive(file.begin(), file.Size()))
+            {
+                return LoadArchivedMap<BinaryUnarchiver>(file);
+            }
+
+            auto filestream = OpenIfstream(filename);
             return LoadArchivedMap<JsonUnarchiver>(filestream);
         }
         catch (const std::exception& ex)
@@ -433,6 +502,14 @@ namespace common
         {
             throw SystemException(SystemExceptionErrors::fileNotWritable);
         }
+
+        if (IsBinaryArchiveFilename(filename))
+        {
+            auto filestream = OpenBinaryOfstream(filename);
+            SaveArchivedObject<BinaryArchiver>(map, filestream);
+            return;
+        }
+
         auto filestream = OpenOfstream(filename);
         SaveMap(map, filestream);
     }
@@ -16,6 +16,7 @@
 
 #include <utilities/include/CommandLineParser.h>
 
+#include <trainers/include/BinnedForestTrainer.h>
 #include <trainers/include/HistogramForestTrainer.h>
 #include <trainers/include/LogitBooster.h>
 #include <trainers/include/ProtoNNTrainer.h>
@@ -127,6 +128,10 @@ namespace common
             {
                 return trainers::MakeSortingForestTrainer(functions::SquaredLoss(), trainers::LogitBooster(), trainerArguments);
             }
+            else if (trainerArguments.binnedTrainer)
+            {
+                return trainers::MakeBinnedForestTrainer(functions::SquaredLoss(), trainers::LogitBooster(), trainerArguments);
+            }
             else
             {
                 return trainers::MakeHistogramForestTrainer(functions::SquaredLoss(), trainers::LogitBooster(), trainers::ExhaustiveThresholdFinder(), trainerArguments);
@@ -41,6 +41,34 @@ namespace common
             "Emit profiling code",
             false);
 
+        parser.AddOption(
+            profileHardwareCounters,
+            "profileHardwareCounters",
+            "",
+            "Sample hardware performance counters (cycles, instructions, cache and branch misses) in profiling code",
+            false);
+
+        parser.AddOption(
+            profileLatencyHistograms,
+            "profileLatencyHistograms",
+            "",
+            "Keep latency histograms of the model and each node in profiling code, to report latency percentiles",
+            false);
+
+        parser.AddOption(
+            profileSamplingInterval,
+            "profileSamplingInterval",
+            "",
+            "Only update the profiling counters on every Nth call to the model (1 profiles every call)",
+            1);
+
+        parser.AddOption(
+            traceExecution,
+            "traceExecution",
+            "",
+            "Record a timeline of nodes, profile regions and parallel tasks in profiling code",
+            false);
+
         parser.AddOption(
             optimize,
             "optimize",
@@ -48,6 +76,44 @@ namespace common
             "Optimize output code",
             true);
 
+        parser.AddOption(
+            optimizationThreads,
+            "optimizationThreads",
+            "",
+            "Number of threads to optimize the output code on (functions are split into partitions that aren't inlined into each other)",
+            1);
+
+        parser.AddOption(
+            optimizationLevel,
+            "optimizationLevel",
+            "O",
+            "Optimization level of the output code, from 0 to 3",
+            3);
+
+        parser.AddOption(
+            sizeOptimization,
+            "sizeOptimization",
+            "",
+            "Optimize the output code for speed, for size (like -Os), or for minimum size (like -Oz)",
+            { { "speed", emitters::SizeOptimization::speed },
+              { "size", emitters::SizeOptimization::size },
+              { "minSize", emitters::SizeOptimization::minSize } },
+            "speed");
+
+        parser.AddOption(
+            allowInlining,
+            "allowInlining",
+            "",
+            "Let the optimizer inline functions into their callers",
+            true);
+
+        parser.AddOption(
+            maxOptimizationSeconds,
+            "maxOptimizationSeconds",
+            "",
+            "Seconds the optimizer can spend on the output code; functions it hasn't optimized by then are left unoptimized (0 means no limit)",
+            0.0);
+
         parser.AddOption(
             useBlas,
             "blas",
@@ -55,6 +121,92 @@ namespace common
             "Emit code that calls BLAS",
             true);
 
+        parser.AddOption(
+            blasType,
+            "blasType",
+            "",
+            "The BLAS library the code will be linked to (OpenBLAS calls get a number of threads that depends on their size)",
+            { { "unknown", emitters::BlasType::unknown },
+              { "openBLAS", emitters::BlasType::openBLAS },
+              { "atlas", emitters::BlasType::atlas } },
+            "unknown");
+
+        parser.AddOption(
+            blasThreads,
+            "blasThreads",
+            "",
+            "Maximum number of threads of an OpenBLAS call (0 means the number of threads if not parallelizing, and 1 otherwise)",
+            0);
+
+        parser.AddOption(
+            blasMinOperationsPerThread,
+            "blasMinOperationsPerThread",
+            "",
+            "Number of multiply-adds that make it worth giving an OpenBLAS call another thread",
+            1 << 15);
+
+        parser.AddOption(
+            useBlockedGemm,
+            "blockedGemm",
+            "",
+            "Emit a cache-blocked matrix multiply when not calling BLAS",
+            true);
+
+        parser.AddOption(
+            smallGemmThreshold,
+            "smallGemmThreshold",
+            "",
+            "Number of multiply-adds up to which matrix products are emitted as fully unrolled code instead of BLAS calls or loops (0 means never)",
+            0);
+
+        parser.AddOption(
+            useGpu,
+            "gpu",
+            "",
+            "Run large matrix products on the GPU, through the ELL runtime library (which must be linked with the model)",
+            false);
+
+        parser.AddOption(
+            gpuMinOperations,
+            "gpuMinOperations",
+            "",
+            "Number of multiply-adds that make it worth running a matrix product on the GPU",
+            1 << 22);
+
+        parser.AddOption(
+            useCmsis,
+            "cmsis",
+            "",
+            "Call the CMSIS-DSP library (which must be linked with the model) for quantized dot products and FFTs on Cortex-M targets",
+            false);
+
+        parser.AddOption(
+            weightStorageType,
+            "weightStorage",
+            "",
+            "Format to store constant weights in; reduced-precision weights are converted back to float as they are loaded. NaN weights are stored as 0, and float16 weights beyond +/-65504 saturate",
+            { { "float32", emitters::WeightStorageType::float32 },
+              { "float16", emitters::WeightStorageType::float16 },
+              { "bfloat16", emitters::WeightStorageType::bfloat16 } },
+            "float32");
+
+        parser.AddOption(
+            prefetchDistance,
+            "prefetchDistance",
+            "",
+            "How many bytes ahead to prefetch in loops that stream weights (0 disables prefetching, -1 uses the target device's default)",
+            -1);
+
+        parser.AddOption(
+            fastMathAccuracy,
+            "fastMathAccuracy",
+            "",
+            "Accuracy of exp, log, tanh and sigmoid: exact calls the C library, high and low emit inline approximations that can be vectorized",
+            { { "exact", emitters::FastMathAccuracy::exact },
+              { "high", emitters::FastMathAccuracy::high },
+              { "low", emitters::FastMathAccuracy::low } },
+            "high");
+
         parser.AddOption(
             fuseLinearOperations,
             "fuseLinearOps",
@@ -62,6 +214,83 @@ namespace common
             "Fuse sequences of linear operations with constant coefficients into a single operation",
             true);
 
+        parser.AddOption(
+            fuseElementwiseOperations,
+            "fuseElementwiseOps",
+            "",
+            "Fuse chains of elementwise operations (activations, linear functions, arithmetic) into a single loop",
+            false);
+
+        parser.AddOption(
+            fuseConvolutionEpilogues,
+            "fuseConvolutionEpilogues",
+            "",
+            "Apply the bias and activation function following a convolution or matrix multiplication as its output is computed",
+            true);
+
+        parser.AddOption(
+            fuseInputPreprocessing,
+            "fuseInputPreprocessing",
+            "",
+            "Cast, normalize and reorder raw input in a single pass",
+            true);
+
+        parser.AddOption(
+            fuseAudioFrontEnd,
+            "fuseAudioFrontEnd",
+            "",
+            "Compute the window, FFT, power spectrum, filter bank, log and DCT nodes of an audio featurizer in a single kernel",
+            true);
+
+        parser.AddOption(
+            fusePoolingActivations,
+            "fusePoolingActivations",
+            "",
+            "Apply a ReLU activation preceding a max or mean pooling layer as the pooling layer reads its input",
+            true);
+
+        parser.AddOption(
+            fuseSoftmaxTopK,
+            "fuseSoftmaxTopK",
+            "",
+            "Select the top k entries of a softmax from its logits, and only normalize the probabilities of those entries",
+            true);
+
+        parser.AddOption(
+            prepackWeights,
+            "prepackWeights",
+            "",
+            "Pack constant GEMM weights into the blocked GEMM kernel's panel layout at compile time, instead of on every call",
+            true);
+
+        parser.AddOption(
+            quantizeLayers,
+            "quantizeLayers",
+            "",
+            "Compute calibrated convolutional and fully-connected layers with 8-bit integer arithmetic",
+            false);
+
+        parser.AddOption(
+            fixedPointDSP,
+            "fixedPointDSP",
+            "",
+            "Compute the window, FFT, filter bank, IIR filter and DCT nodes in this fixed-point format (q15, q31 or qI.F), for devices without a floating-point unit",
+            "");
+
+        parser.AddOption(
+            flattenForests,
+            "flattenForests",
+            "",
+            "Compile decision forests as arrays of flattened trees, evaluated without branches",
+            false);
+
+        parser.AddOption(
+            searchNodeOptions,
+            "searchNodeOptions",
+            "",
+            "Choose the vectorization, parallelization and convolution options of each node by profiling the model with the JIT",
+            false);
+
         parser.AddOption(
             optimizeReorderDataNodes,
             "optimizeReorderDataNodes",
@@ -69,6 +298,55 @@ namespace common
             "Optimize sequences of reordering nodes",
             true);
 
+        parser.AddOption(
+            foldConstants,
+            "foldConstants",
+            "",
+            "Evaluate the parts of the model that only depend on constants at compile time",
+            true);
+
+        parser.AddOption(
+            eliminateCommonSubexpressions,
+            "eliminateCommonSubexpressions",
+            "",
+            "Merge nodes that compute the same thing from the same inputs, like duplicate constants and reorders",
+            true);
+
+        parser.AddOption(
+            factorizeFullyConnectedTolerance,
+            "factorizeFullyConnectedTolerance",
+            "",
+            "Replace large fully-connected layers by two low-rank ones whose weights are within this relative error of the original (0 to disable)",
+            0.0);
+
+        parser.AddOption(
+            sparseWeightsDensity,
+            "sparseWeightsDensity",
+            "",
+            "Multiply by the weights of pruned layers with sparse kernels if less than this fraction of them are nonzero (0 to disable)",
+            0.3);
+
+        parser.AddOption(
+            palettizeWeightsBits,
+            "palettizeWeightsBits",
+            "",
+            "Cluster the weights of each fully-connected and convolutional layer into 16 or 256 values, stored as 4- or 8-bit indices (4, 8, or 0 to disable)",
+            0);
+
+        parser.AddOption(
+            propagateLayouts,
+            "propagateLayouts",
+            "",
+            "Choose the memory layout of elementwise operations so as to remove unneeded reordering nodes",
+            false);
+
+        parser.AddOption(
+            implicitPadding,
+            "implicitPadding",
+            "",
+            "Let convolutions that reorder their input handle the image boundary instead of copying it into a padded buffer",
+            false);
+
         parser.AddOption(
             convolutionMethod,
             "convolutionMethod",
@@ -78,9 +356,31 @@ namespace common
               { "simple", PreferredConvolutionMethod::simple },
               { "diagonal", PreferredConvolutionMethod::diagonal },
               { "winograd", PreferredConvolutionMethod::winograd },
+              { "autotune", PreferredConvolutionMethod::autotune },
               { "auto", PreferredConvolutionMethod::automatic } },
             "auto");
 
+        parser.AddOption(
+            convolutionMethodCache,
+            "convolutionMethodCache",
+            "",
+            "File used to remember the convolution methods chosen by '--convolutionMethod autotune'",
+            "");
+
+        parser.AddOption(
+            winogradTileSize,
+            "winogradTileSize",
+            "",
+            "Output tile size of Winograd convolutions (2, 4 or 6). Larger tiles need fewer multiplies but are less precise",
+            2);
+
+        parser.AddOption(
+            implicitGemmPanelSize,
+            "implicitGemmPanelSize",
+            "",
+            "Size in bytes of the input panels unrolled convolutions multiply at a time instead of building the whole receptive field matrix (0 to build it)",
+            0);
+
         parser.AddOption(
             modelOptions,
             "modelOption",
@@ -109,6 +409,13 @@ namespace common
             "Size of vector units",
             4);
 
+        parser.AddOption(
+            cpuDispatchLevels,
+            "cpuDispatch",
+            "",
+            "x86 instruction set levels to also compile node functions for, e.g. \"sse4.2,avx2,avx512\"; the best one the CPU supports is chosen when the model runs (x86-64 only)",
+            "");
+
         parser.AddOption(
             parallelize,
             "parallelize",
@@ -123,6 +430,51 @@ namespace common
             "Use thread pool for parallelization (if parallelization enabled)",
             true);
 
+        parser.AddOption(
+            useWorkStealing,
+            "workStealing",
+            "ws",
+            "Give each thread pool worker its own task queue and let idle workers steal tasks (if thread pool enabled)",
+            false);
+
+        parser.AddOption(
+            threadPoolSpinCount,
+            "threadPoolSpinCount",
+            "",
+            "Number of times an idle thread pool worker polls for new tasks before it blocks (if thread pool enabled)",
+            0);
+
+        parser.AddOption(
+            hotThreadPool,
+            "hotThreadPool",
+            "",
+            "Keep the thread pool workers polling for new tasks, instead of blocking, during each predict call (if thread pool enabled)",
+            false);
+
+        parser.AddOption(
+            parallelLoopSchedule,
+            "parallelLoopSchedule",
+            "",
+            "How parallel loops divide their iterations between tasks: static gives each task one equal block, dynamic and guided let tasks take chunks of iterations until none are left",
+            { { "static", emitters::ParallelLoopSchedule::staticBlocks },
+              { "dynamic", emitters::ParallelLoopSchedule::dynamic },
+              { "guided", emitters::ParallelLoopSchedule::guided } },
+            "static");
+
+        parser.AddOption(
+            parallelLoopChunkSize,
+            "parallelLoopChunkSize",
+            "",
+            "Number of iterations a task takes at a time in dynamic parallel loops, and at least in guided ones (0 for automatic)",
+            0);
+
+        parser.AddOption(
+            useSharedRuntime,
+            "sharedRuntime",
+            "",
+            "Run parallel tasks on the thread pool of the ELL runtime library, shared by all models in the process, instead of the model's own (the model must be linked with the runtime library)",
+            false);
+
         parser.AddOption(
             maxThreads,
             "threads",
@@ -130,6 +482,90 @@ namespace common
             "Maximum num of parallel threads",
             4);
 
+        parser.AddOption(
+            threadAffinity,
+            "threadAffinity",
+            "",
+            "Cores to pin thread pool workers to, e.g. \"0,2,4-7\" (Linux only; empty means no pinning)",
+            "");
+
+        parser.AddOption(
+            useHugePages,
+            "hugePages",
+            "",
+            "Align the model's buffers of at least 2 MB to 2 MB and back them with transparent huge pages (Linux only)",
+            false);
+
+        parser.AddOption(
+            firstTouchBuffers,
+            "firstTouchBuffers",
+            "",
+            "When the model is loaded, have each thread pool worker write its part of the large intermediate buffers first, so their pages are on the worker's NUMA node (if parallelization enabled)",
+            false);
+
+        parser.AddOption(
+            asyncCallbacks,
+            "asyncCallbacks",
+            "",
+            "Fetch the next input from source callbacks and call sink callbacks on their own threads, while the model runs (needs parallelize). The callbacks then run on another thread, and each call returns the output for the sample fetched during the previous call",
+            false);
+
+        parser.AddOption(
+            parallelizeBranches,
+            "parallelizeBranches",
+            "",
+            "Run independent branches of the model, such as the towers of an Inception module or the heads of a multi-head model, at the same time on their own threads (needs parallelize)",
+            false);
+
+        parser.AddOption(
+            emitBatchPredictFunction,
+            "batchPredict",
+            "",
+            "Also emit a <predict>_batch function that runs the model on a batch of contiguous samples, one sample at a time on the calling thread",
+            false);
+
+        parser.AddOption(
+            planMemory,
+            "planMemory",
+            "",
+            "Share memory between intermediate buffers whose lifetimes don't overlap",
+            false);
+
+        parser.AddOption(
+            scheduleForMemory,
+            "scheduleForMemory",
+            "",
+            "With planMemory, run the nodes in an order that keeps few intermediate buffers live at once, to lower the peak memory",
+            false);
+
+        parser.AddOption(
+            aliasPorts,
+            "aliasPorts",
+            "",
+            "Let slice, reinterpret, and concatenation outputs share their input's memory, and compute spliced values directly in the splice output",
+            true);
+
+        parser.AddOption(
+            reentrant,
+            "reentrant",
+            "",
+            "Keep the model's state in a caller-allocated struct passed to the predict function, so one compiled model can run several streams at once",
+            false);
+
+        parser.AddOption(
+            externalWeights,
+            "externalWeights",
+            "",
+            "Write the model's weights to a separate <outputFilenameBase>.weights file, which the compiled model maps into memory at run time, instead of into the object file",
+            false);
+
+        parser.AddOption(
+            dynamicInputExtent,
+            "dynamicInputExtent",
+            "",
+            "Treat the outermost dimension of the input as a maximum, and also emit a <predict>_dynamic function that takes the actual extent",
+            false);
+
         parser.AddOption(
             debug,
             "debug",
@@ -144,7 +580,7 @@ namespace common
             "target",
             "t",
             "Target name",
-            { { "host" }, { "pi0" }, { "pi3" }, { "orangepi0" }, { "pi3_64" }, { "mac" }, { "linux" }, { "windows" }, { "ios" }, { "aarch64" }, { "custom" } },
+            { { "host" }, { "pi0" }, { "pi3" }, { "orangepi0" }, { "pi3_64" }, { "mac" }, { "linux" }, { "windows" }, { "ios" }, { "aarch64" }, { "wasm32" }, { "custom" } },
             "host");
 
         parser.AddOption(
@@ -224,12 +660,52 @@ namespace common
         settings.moduleName = namespacePrefix;
         settings.mapFunctionName = functionName;
         settings.compilerSettings.optimize = optimize;
+        settings.compilerSettings.optimizationThreads = optimizationThreads;
+        settings.compilerSettings.optimizationLevel = optimizationLevel;
+        settings.compilerSettings.sizeOptimization = sizeOptimization;
+        settings.compilerSettings.allowInlining = allowInlining;
+        settings.compilerSettings.maxOptimizationSeconds = maxOptimizationSeconds;
         settings.compilerSettings.useBlas = useBlas;
+        settings.compilerSettings.blasType = blasType;
+        settings.compilerSettings.blasThreads = blasThreads;
+        settings.compilerSettings.blasMinOperationsPerThread = blasMinOperationsPerThread;
+        settings.compilerSettings.useBlockedGemm = useBlockedGemm;
+        settings.compilerSettings.smallGemmThreshold = smallGemmThreshold;
+        settings.compilerSettings.useGpu = useGpu;
+        settings.compilerSettings.gpuMinOperations = gpuMinOperations;
+        settings.compilerSettings.useCmsis = useCmsis;
+        settings.compilerSettings.weightStorageType = weightStorageType;
+        settings.compilerSettings.prefetchDistance = prefetchDistance;
+        settings.compilerSettings.fastMathAccuracy = fastMathAccuracy;
         settings.compilerSettings.allowVectorInstructions = enableVectorization;
         settings.compilerSettings.parallelize = parallelize;
+        settings.compilerSettings.useThreadPool = useThreadPool;
+        settings.compilerSettings.useWorkStealing = useWorkStealing;
+        settings.compilerSettings.threadPoolSpinCount = threadPoolSpinCount;
+        settings.compilerSettings.hotThreadPool = hotThreadPool;
+        settings.compilerSettings.parallelLoopSchedule = parallelLoopSchedule;
+        settings.compilerSettings.parallelLoopChunkSize = parallelLoopChunkSize;
+        settings.compilerSettings.useSharedRuntime = useSharedRuntime;
+        settings.compilerSettings.maxThreads = maxThreads;
+        settings.compilerSettings.threadAffinity = emitters::ParseCoreList(threadAffinity);
+        settings.compilerSettings.useHugePages = useHugePages;
+        settings.compilerSettings.firstTouchBuffers = firstTouchBuffers;
         settings.compilerSettings.vectorWidth = vectorWidth;
+        settings.compilerSettings.cpuDispatchLevels = emitters::ParseCpuDispatchLevels(cpuDispatchLevels);
         settings.profile = profile;
+        settings.emitBatchPredictFunction = emitBatchPredictFunction;
+        settings.planMemory = planMemory;
+        settings.scheduleForMemory = scheduleForMemory;
+        settings.parallelizeBranches = parallelizeBranches;
+        settings.aliasPorts = aliasPorts;
+        settings.reentrant = reentrant;
+        settings.externalWeights = externalWeights;
+        settings.dynamicInputExtent = dynamicInputExtent;
         settings.compilerSettings.profile = profile;
+        settings.compilerSettings.profileHardwareCounters = profileHardwareCounters;
+        settings.compilerSettings.profileLatencyHistograms = profileLatencyHistograms;
+        settings.compilerSettings.profileSamplingInterval = profileSamplingInterval;
+        settings.compilerSettings.traceExecution = traceExecution;
         settings.compilerSettings.positionIndependentCode = positionIndependentCode;
 
         if (target != "")
@@ -276,8 +752,30 @@ namespace common
     {
         model::ModelOptimizerOptions options;
         options["fuseLinearFunctionNodes"] = fuseLinearOperations;
+        options["fuseElementwiseNodes"] = fuseElementwiseOperations;
+        options["fuseConvolutionEpilogues"] = fuseConvolutionEpilogues;
+        options["fuseInputPreprocessing"] = fuseInputPreprocessing;
+        options["fuseAudioFrontEnd"] = fuseAudioFrontEnd;
+        options["fusePoolingActivations"] = fusePoolingActivations;
+        options["fuseSoftmaxTopK"] = fuseSoftmaxTopK;
+        options["prepackWeights"] = prepackWeights;
+        options["quantizeLayers"] = quantizeLayers;
+        options["fixedPointDSP"] = fixedPointDSP;
+        options["flattenForests"] = flattenForests;
+        options["searchNodeOptions"] = searchNodeOptions;
         options["optimizeReorderDataNodes"] = optimizeReorderDataNodes;
+        options["foldConstants"] = foldConstants;
+        options["eliminateCommonSubexpressions"] = eliminateCommonSubexpressions;
+        options["factorizeFullyConnectedTolerance"] = factorizeFullyConnectedTolerance;
+        options["sparseWeightsDensity"] = sparseWeightsDensity;
+        options["palettizeWeightsBits"] = palettizeWeightsBits;
+        options["propagateLayouts"] = propagateLayouts;
+        options["implicitPadding"] = implicitPadding;
         options["preferredConvolutionMethod"] = convolutionMethod;
+        options["convolutionMethodCache"] = convolutionMethodCache;
+        options["winogradTileSize"] = winogradTileSize;
+        options["implicitGemmPanelSize"] = implicitGemmPanelSize;
+        options["asyncCallbacks"] = asyncCallbacks;
 
         auto metadata = GetOptionsMetadata();
         if (metadata.HasEntry("model"))
@@ -13,6 +13,8 @@
 #include <model/include/PortElements.h>
 
 #include <utilities/include/Files.h>
+#include <utilities/include/OutputStreamImpostor.h>
+#include <utilities/include/PhaseTimer.h>
 
 #include <sstream>
 
@@ -59,6 +61,14 @@ namespace common
             "d",
             "Default size of input node",
             1);
+
+        parser.AddOption(
+            timingReportFilename,
+            "timing",
+            "",
+            "File for a JSON report of the time spent loading, refining, optimizing and compiling the map (stdout if no file is given)",
+            "",
+            "<cout>");
     }
 
     std::string MapLoadArguments::GetInputFilename() const
@@ -91,6 +101,17 @@ namespace common
         return &model.SimplifyOutputs(portElements);
     }
 
+    void MapLoadArguments::WriteTimingReport() const
+    {
+        if (!HasTimingReport())
+        {
+            return;
+        }
+
+        auto stream = timingReportFilename == "<cout>" ? utilities::OutputStreamImpostor(utilities::OutputStreamImpostor::StreamType::cout) : utilities::OutputStreamImpostor(timingReportFilename);
+        utilities::WritePhaseTimingsJson(stream);
+    }
+
     //
     // ParsedMapLoadArguments
     //
@@ -117,6 +138,9 @@ namespace common
             }
         }
 
+        // Timing has to be on before the map is loaded
+        utilities::EnablePhaseTiming(HasTimingReport());
+
         return parseErrorMessages;
     }
 } // namespace common
@@ -74,6 +74,18 @@ namespace common
                          "nInnerIter",
                          "Number of inner iterations",
                          1);
+
+        parser.AddOption(batchSize,
+                         "batchSize",
+                         "bs",
+                         "Number of examples in each stochastic gradient step (0 for 256, or all the examples if there are fewer)",
+                         0);
+
+        parser.AddOption(numThreads,
+                         "numThreads",
+                         "nt",
+                         "Number of threads to compute projections and gradients on (0 for one per core)",
+                         0);
     }
 } // namespace common
 } // namespace ell
@@ -12,6 +12,7 @@
 #include <model/include/ModelBuilder.h>
 #include <model/include/OutputNode.h>
 
+#include <nodes/include/AccumulatorNode.h>
 #include <nodes/include/BinaryOperationNode.h>
 #include <nodes/include/BinaryPredicateNode.h>
 #include <nodes/include/BufferNode.h>
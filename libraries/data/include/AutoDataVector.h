@@ -44,6 +44,11 @@ namespace data
         /// <param name="vector"> The input vector. </param>
         AutoDataVectorBase(DefaultDataVectorType&& vector);
 
+        /// <summary> Constructs an auto data vector that keeps the given representation, rather than choosing one. </summary>
+        ///
+        /// <param name="vector"> The internal data vector, which cannot itself be an auto data vector. </param>
+        AutoDataVectorBase(std::unique_ptr<IDataVector> vector);
+
         /// <summary> Constructs an auto data vector from an index value iterator. </summary>
         ///
         /// <typeparam name="IndexValueIteratorType"> Type of index value iterator. </typeparam>
@@ -168,6 +173,11 @@ namespace data
         /// <param name="os"> [in,out] Stream to write to. </param>
         void Print(std::ostream& os) const override;
 
+        /// <summary> Human readable printout to an output buffer. </summary>
+        ///
+        /// <param name="buffer"> [in,out] Buffer to write to. </param>
+        void Print(utilities::OutputBuffer& buffer) const override;
+
     private:
         // helper function used by ctors to choose the type of data vector to use
         void FindBestRepresentation(DefaultDataVectorType defaultDataVector);
@@ -220,6 +230,16 @@ namespace data
         FindBestRepresentation(std::move(vector));
     }
 
+    template <typename DefaultDataVectorType>
+    AutoDataVectorBase<DefaultDataVectorType>::AutoDataVectorBase(std::unique_ptr<IDataVector> vector) :
+        _pInternal(std::move(vector))
+    {
+        if (_pInternal == nullptr || _pInternal->GetType() == IDataVector::Type::AutoDataVector)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "internal data vector must be a concrete data vector");
+        }
+    }
+
     template <typename DefaultDataVectorType>
     template <typename IndexValueIteratorType, IsIndexValueIterator<IndexValueIteratorType> Concept>
     AutoDataVectorBase<DefaultDataVectorType>::AutoDataVectorBase(IndexValueIteratorType indexValueIterator)
@@ -292,6 +312,12 @@ namespace data
         _pInternal->Print(os);
     }
 
+    template <typename DefaultDataVectorType>
+    void AutoDataVectorBase<DefaultDataVectorType>::Print(utilities::OutputBuffer& buffer) const
+    {
+        _pInternal->Print(buffer);
+    }
+
     template <typename DefaultDataVectorType>
     template <IterationPolicy policy, typename TransformationType>
     void AutoDataVectorBase<DefaultDataVectorType>::AddTransformedTo(math::RowVectorReference<double> vector, TransformationType transformation) const
@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BinaryDataset.h (data)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Dataset.h"
+
+#include <cstddef>
+#include <ostream>
+
+namespace ell
+{
+namespace data
+{
+    /// <summary>
+    /// Writes a dataset in ELL's binary dataset format. Each data vector is stored in its internal
+    /// representation (dense arrays, or CompressedIntegerList indices plus values for the sparse types), so
+    /// reading it back involves no parsing. Numbers are stored in the byte order of the machine that
+    /// writes the file, and every array starts at a multiple of 8 bytes from the beginning of the file.
+    /// </summary>
+    ///
+    /// <param name="dataset"> The dataset. </param>
+    /// <param name="stream"> The stream to write to, which should be opened in binary mode. </param>
+    /// <param name="numThreads"> The number of threads that encode blocks of examples, zero to use one per core. </param>
+    void WriteBinaryDataset(const AutoSupervisedDataset& dataset, std::ostream& stream, size_t numThreads = 0);
+
+    /// <summary> Reads a dataset in ELL's binary dataset format from memory, typically a memory-mapped file. </summary>
+    ///
+    /// <param name="begin"> Pointer to the beginning of the data, which must be 8-byte aligned. </param>
+    /// <param name="end"> Pointer just past the end of the data. </param>
+    ///
+    /// <returns> The dataset. </returns>
+    AutoSupervisedDataset ReadBinaryDataset(const char* begin, const char* end);
+
+    /// <summary> Checks if a block of memory starts like a dataset in ELL's binary dataset format. </summary>
+    ///
+    /// <param name="begin"> Pointer to the beginning of the data. </param>
+    /// <param name="end"> Pointer just past the end of the data. </param>
+    ///
+    /// <returns> True if the data has the binary dataset header. </returns>
+    bool IsBinaryDataset(const char* begin, const char* end);
+} // namespace data
+} // namespace ell
@@ -12,6 +12,8 @@
 
 #include <math/include/Vector.h>
 
+#include <utilities/include/OutputBuffer.h>
+
 #include <cstddef>
 #include <functional>
 #include <initializer_list>
@@ -41,6 +43,11 @@ namespace data
             SparseShortDataVector,
             SparseByteDataVector,
             SparseBinaryDataVector,
+            BlockSparseDoubleDataVector,
+            BlockSparseFloatDataVector,
+            BlockSparseShortDataVector,
+            BlockSparseByteDataVector,
+            BlockSparseBinaryDataVector,
             AutoDataVector
         };
 
@@ -150,6 +157,11 @@ namespace data
         /// <param name="os"> [in,out] Stream to write to. </param>
         virtual void Print(std::ostream& os) const = 0;
 
+        /// <summary> Human readable printout to an output buffer, which is much faster than printing to a stream. </summary>
+        ///
+        /// <param name="buffer"> [in,out] Buffer to write to. </param>
+        virtual void Print(utilities::OutputBuffer& buffer) const = 0;
+
     private:
         // calls a generic (polymorphic) lambda of the form `[](const auto* pThis){ return ReturnType();}`, where pThis is a pointer to the concrete
         // DataVector implementation (e.g., DenseDataVector, SparseDataVector,...)
@@ -297,6 +309,11 @@ namespace data
         ///
         /// <param name="os"> [in,out] Stream to write to. </param>
         void Print(std::ostream& os) const override;
+
+        /// <summary> Human readable printout to an output buffer. </summary>
+        ///
+        /// <param name="buffer"> [in,out] Buffer to write to. </param>
+        void Print(utilities::OutputBuffer& buffer) const override;
     };
 
     /// <summary> Wrapper for AddTransformedTo that hides the template specifier. </summary>
@@ -477,6 +494,21 @@ namespace data
         case Type::SparseBinaryDataVector:
             return lambda(static_cast<const SparseBinaryDataVector*>(this));
 
+        case Type::BlockSparseDoubleDataVector:
+            return lambda(static_cast<const BlockSparseDoubleDataVector*>(this));
+
+        case Type::BlockSparseFloatDataVector:
+            return lambda(static_cast<const BlockSparseFloatDataVector*>(this));
+
+        case Type::BlockSparseShortDataVector:
+            return lambda(static_cast<const BlockSparseShortDataVector*>(this));
+
+        case Type::BlockSparseByteDataVector:
+            return lambda(static_cast<const BlockSparseByteDataVector*>(this));
+
+        case Type::BlockSparseBinaryDataVector:
+            return lambda(static_cast<const BlockSparseBinaryDataVector*>(this));
+
         default:
             throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "attempted to cast unsupported data vector type");
         }
@@ -711,18 +743,37 @@ namespace data
     template <class DerivedType>
     void DataVectorBase<DerivedType>::Print(std::ostream& os) const
     {
-        auto indexValueIterator = GetIterator<DerivedType, IterationPolicy::skipZeros>(*static_cast<const DerivedType*>(this));
-        if (indexValueIterator.IsValid())
-        {
-            auto indexValue = indexValueIterator.Get();
-            os << indexValue.index << ":" << indexValue.value;
-            indexValueIterator.Next();
-        }
+        utilities::OutputBuffer buffer;
+        Print(buffer);
+        buffer.WriteTo(os);
+    }
 
+    template <class DerivedType>
+    void DataVectorBase<DerivedType>::Print(utilities::OutputBuffer& buffer) const
+    {
+        // values stored as floats are printed as floats, so 0.1f prints as 0.1 rather than 0.10000000149011612
+        auto type = static_cast<const DerivedType*>(this)->GetType();
+        bool isFloat = type == Type::FloatDataVector || type == Type::SparseFloatDataVector || type == Type::BlockSparseFloatDataVector;
+
+        auto indexValueIterator = GetIterator<DerivedType, IterationPolicy::skipZeros>(*static_cast<const DerivedType*>(this));
+        bool isFirst = true;
         while (indexValueIterator.IsValid())
         {
             auto indexValue = indexValueIterator.Get();
-            os << '\t' << indexValue.index << ":" << indexValue.value;
+            if (!isFirst)
+            {
+                buffer << '\t';
+            }
+            buffer << indexValue.index << ':';
+            if (isFloat)
+            {
+                buffer << static_cast<float>(indexValue.value);
+            }
+            else
+            {
+                buffer << indexValue.value;
+            }
+            isFirst = false;
             indexValueIterator.Next();
         }
     }
@@ -14,6 +14,7 @@
 #include "ExampleIterator.h"
 
 #include <utilities/include/AbstractInvoker.h>
+#include <utilities/include/Arena.h>
 #include <utilities/include/TypeTraits.h>
 
 #include <functional>
@@ -29,6 +30,10 @@ namespace data
     template <typename ExampleType>
     class Dataset;
 
+    // forward declaration of StreamingDataset, which AnyDataset can also refer to
+    template <typename ExampleType>
+    class StreamingDataset;
+
     /// <summary> Polymorphic interface for datasets, enables dynamic_cast operations. </summary>
     struct DatasetBase
     {
@@ -54,6 +59,28 @@ namespace data
         template <typename ExampleType>
         ExampleIterator<ExampleType> GetExampleIterator() const;
 
+        /// <summary>
+        /// Gets the StreamingDataset this AnyDataset refers to, so that trainers can iterate over it
+        /// without loading it into memory.
+        /// </summary>
+        ///
+        /// <typeparam name="ExampleType"> Example type of the streaming dataset. </typeparam>
+        ///
+        /// <returns> The streaming dataset, or nullptr if this AnyDataset refers to an in-memory dataset or to part of a streaming dataset. </returns>
+        template <typename ExampleType>
+        const StreamingDataset<ExampleType>* GetStreamingDataset() const;
+
+        /// <summary>
+        /// Gets the in-memory Dataset this AnyDataset refers to, so that trainers can read it in place instead of
+        /// copying it.
+        /// </summary>
+        ///
+        /// <typeparam name="ExampleType"> Example type of the dataset. </typeparam>
+        ///
+        /// <returns> The dataset, or nullptr if this AnyDataset refers to a dataset of another type or to part of a dataset. </returns>
+        template <typename ExampleType>
+        const Dataset<ExampleType>* GetDataset() const;
+
         /// <summary> Returns the number of examples in the dataset. </summary>
         ///
         /// <returns> Number of examples. </returns>
@@ -182,6 +209,14 @@ namespace data
         /// <returns> The example reference iterator. </returns>
         ExampleReferenceIterator<DatasetExampleType> GetExampleReferenceIterator(size_t fromIndex = 0, size_t size = 0) const;
 
+        /// <summary> Gets an example reference iterator that visits the examples in the order of a permutation. </summary>
+        ///
+        /// <param name="permutation"> The indices of the examples to visit, in the order to visit them. The
+        /// iterator refers to the permutation, which must outlive it. </param>
+        ///
+        /// <returns> The example reference iterator. </returns>
+        PermutedExampleReferenceIterator<DatasetExampleType> GetPermutedExampleReferenceIterator(const std::vector<size_t>& permutation) const;
+
         /// <summary> Returns an AnyDataset that represents an interval of examples from this dataset. </summary>
         ///
         /// <param name="firstExample"> Zero-based index of the first example in the AnyDataset. </param>
@@ -200,11 +235,49 @@ namespace data
         template <typename otherExampleType>
         Dataset<otherExampleType> Transform(std::function<otherExampleType(const DatasetExampleType&)> transformationFunction);
 
+        /// <summary>
+        /// Returns a dataset whose data vectors have been converted from this dataset, and whose metadata is
+        /// copied from this dataset. The new data vectors are allocated from the new dataset's arena.
+        /// </summary>
+        ///
+        /// <typeparam name="otherExampleType"> Example type of the returned dataset (metadata ctor must take old
+        /// MetadataType). </typeparam>
+        /// <param name="transformationFunction"> The function that is called on each example, returning the transformed data vector. </param>
+        ///
+        /// <returns> The dataset. </returns>
+        template <typename otherExampleType>
+        Dataset<otherExampleType> Transform(std::function<typename otherExampleType::DataVectorType(const DatasetExampleType&)> transformationFunction);
+
+        /// <summary>
+        /// Returns a dataset whose examples have been converted from this dataset on several threads, each of
+        /// which converts a contiguous range of examples. The examples keep their order.
+        /// </summary>
+        ///
+        /// <typeparam name="otherExampleType"> Example type returned by the transformation function. </typeparam>
+        /// <param name="getTransformationFunction"> A function that returns a transformation function for one
+        /// thread. It is called on the calling thread, once per thread, so that transformations that aren't
+        /// re-entrant, such as maps, can give each thread its own copy. </param>
+        /// <param name="numThreads"> The number of threads to use, zero to use one per core. </param>
+        ///
+        /// <returns> The dataset. </returns>
+        template <typename otherExampleType>
+        Dataset<otherExampleType> TransformInParallel(std::function<std::function<otherExampleType(const DatasetExampleType&)>()> getTransformationFunction, size_t numThreads = 0) const;
+
         /// <summary> Adds an example at the bottom of the matrix. </summary>
         ///
         /// <param name="example"> The example. </param>
         void AddExample(DatasetExampleType example);
 
+        /// <summary>
+        /// Adds an example at the bottom of the matrix, whose data vector is allocated from the dataset's arena.
+        /// The data vectors of the dataset then take one heap allocation per arena chunk, instead of one each,
+        /// and are freed all at once, when the dataset and every example that shares a data vector with it are gone.
+        /// </summary>
+        ///
+        /// <param name="dataVector"> The data vector of the example. </param>
+        /// <param name="metadata"> The metadata of the example. </param>
+        void AddExample(typename DatasetExampleType::DataVectorType dataVector, typename DatasetExampleType::MetadataType metadata);
+
         /// <summary> Erases all of the examples in the Dataset. </summary>
         void Reset();
 
@@ -222,6 +295,17 @@ namespace data
         /// <param name="prefixSize"> Size of the prefix that should be uniformly distributed, zero to permute the entire range. </param>
         void RandomPermute(std::default_random_engine& rng, size_t rangeFirstIndex, size_t rangeSize, size_t prefixSize = 0);
 
+        /// <summary>
+        /// Permutes a list of example indices, rather than the examples themselves, so that a shuffled epoch can
+        /// iterate with GetPermutedExampleReferenceIterator without moving examples around. It draws the same
+        /// random numbers as RandomPermute, so the examples are visited in the same order. A permutation whose
+        /// size isn't NumExamples() is first reset to the identity.
+        /// </summary>
+        ///
+        /// <param name="rng"> [in,out] The random number generator. </param>
+        /// <param name="permutation"> [in,out] The permutation. </param>
+        void RandomPermute(std::default_random_engine& rng, std::vector<size_t>& permutation) const;
+
         /// <summary> Choses an example uniformly from a given range and swaps it with a given example (which can either be inside or outside of the range).
         ///
         /// <param name="rng"> [in,out] The random number generator. </param>
@@ -263,6 +347,7 @@ namespace data
 
         std::vector<DatasetExampleType> _examples;
         size_t _numFeatures = 0;
+        std::shared_ptr<utilities::Arena> _arena;
     };
 
     // friendly names
@@ -279,6 +364,17 @@ namespace data
     template <typename ExampleType>
     std::ostream& operator<<(std::ostream& os, const Dataset<ExampleType>& dataset);
 
+    /// <summary>
+    /// Writes a data set in the text format, like `Dataset::Print`, formatting blocks of examples on several threads
+    /// and writing each block with one call.
+    /// </summary>
+    ///
+    /// <param name="dataset"> The dataset. </param>
+    /// <param name="os"> [in,out] The ostream to write data to. </param>
+    /// <param name="numThreads"> The number of threads, zero to use one per core. </param>
+    template <typename ExampleType>
+    void WriteTextDataset(const Dataset<ExampleType>& dataset, std::ostream& os, size_t numThreads = 0);
+
     /// <summary> Helper function that creates a dataset from an example iterator. </summary>
     ///
     /// <typeparam name="ExampleType"> The example type. </typeparam>
@@ -292,10 +388,14 @@ namespace data
 
 #pragma region implementation
 
+#include "StreamingDataset.h"
+
 #include <utilities/include/Exception.h>
 #include <utilities/include/Logger.h>
+#include <utilities/include/ParallelFor.h>
 
 #include <algorithm>
+#include <numeric>
 #include <random>
 #include <stdexcept>
 
@@ -315,11 +415,35 @@ namespace data
         // all Dataset types for which GetAnyDataset() is called must be listed below, in the variadic template argument.
         using Invoker = utilities::AbstractInvoker<DatasetBase,
                                                    Dataset<data::AutoSupervisedExample>,
-                                                   Dataset<data::DenseSupervisedExample>>;
+                                                   Dataset<data::DenseSupervisedExample>,
+                                                   StreamingDataset<data::AutoSupervisedExample>>;
 
         return Invoker::Invoke<ExampleIterator<ExampleType>>(getExampleIterator, _pDataset);
     }
 
+    template <typename ExampleType>
+    const StreamingDataset<ExampleType>* AnyDataset::GetStreamingDataset() const
+    {
+        auto pDataset = dynamic_cast<const StreamingDataset<ExampleType>*>(_pDataset);
+        if (pDataset == nullptr || _fromIndex != 0 || _size != pDataset->NumExamples())
+        {
+            return nullptr;
+        }
+        return pDataset;
+    }
+
+    template <typename ExampleType>
+    const Dataset<ExampleType>* AnyDataset::GetDataset() const
+    {
+        // a size of zero, or one past the end, selects the rest of the dataset
+        auto pDataset = dynamic_cast<const Dataset<ExampleType>*>(_pDataset);
+        if (pDataset == nullptr || _fromIndex != 0 || (_size != 0 && _size < pDataset->NumExamples()))
+        {
+            return nullptr;
+        }
+        return pDataset;
+    }
+
     template <typename DatasetExampleType>
     template <typename IteratorExampleType>
     Dataset<DatasetExampleType>::DatasetExampleIterator<IteratorExampleType>::DatasetExampleIterator(InternalIteratorType begin, InternalIteratorType end) :
@@ -349,6 +473,7 @@ namespace data
     {
         std::swap(_examples, other._examples);
         std::swap(_numFeatures, other._numFeatures);
+        std::swap(_arena, other._arena);
     }
 
     template <typename DatasetExampleType>
@@ -390,6 +515,12 @@ namespace data
         return ExampleReferenceIterator<DatasetExampleType>(_examples.cbegin() + fromIndex, _examples.cbegin() + fromIndex + size);
     }
 
+    template <typename DatasetExampleType>
+    auto Dataset<DatasetExampleType>::GetPermutedExampleReferenceIterator(const std::vector<size_t>& permutation) const -> PermutedExampleReferenceIterator<DatasetExampleType>
+    {
+        return PermutedExampleReferenceIterator<DatasetExampleType>(_examples, permutation);
+    }
+
     template <typename DatasetExampleType>
     void Dataset<DatasetExampleType>::AddExample(DatasetExampleType example)
     {
@@ -402,6 +533,16 @@ namespace data
         }
     }
 
+    template <typename DatasetExampleType>
+    void Dataset<DatasetExampleType>::AddExample(typename DatasetExampleType::DataVectorType dataVector, typename DatasetExampleType::MetadataType metadata)
+    {
+        if (_arena == nullptr)
+        {
+            _arena = std::make_shared<utilities::Arena>();
+        }
+        AddExample(DatasetExampleType(std::move(dataVector), std::move(metadata), utilities::ArenaAllocator<char>(_arena)));
+    }
+
     template <typename DatasetExampleType>
     template <typename otherExampleType>
     Dataset<otherExampleType> Dataset<DatasetExampleType>::Transform(std::function<otherExampleType(const DatasetExampleType&)> transformationFunction)
@@ -414,11 +555,60 @@ namespace data
         return dataset;
     }
 
+    template <typename DatasetExampleType>
+    template <typename otherExampleType>
+    Dataset<otherExampleType> Dataset<DatasetExampleType>::Transform(std::function<typename otherExampleType::DataVectorType(const DatasetExampleType&)> transformationFunction)
+    {
+        using OtherMetadataType = typename otherExampleType::MetadataType;
+        Dataset<otherExampleType> dataset;
+        for (auto& example : _examples)
+        {
+            dataset.AddExample(transformationFunction(example), OtherMetadataType(example.GetMetadata()));
+        }
+        return dataset;
+    }
+
+    template <typename DatasetExampleType>
+    template <typename otherExampleType>
+    Dataset<otherExampleType> Dataset<DatasetExampleType>::TransformInParallel(std::function<std::function<otherExampleType(const DatasetExampleType&)>()> getTransformationFunction, size_t numThreads) const
+    {
+        numThreads = std::max(std::min(utilities::GetNumThreads(numThreads), _examples.size()), size_t{ 1 });
+
+        // each thread transforms a contiguous range of examples with its own transformation function
+        std::vector<std::function<otherExampleType(const DatasetExampleType&)>> transformationFunctions;
+        for (size_t threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+        {
+            transformationFunctions.push_back(getTransformationFunction());
+        }
+
+        std::vector<std::vector<otherExampleType>> ranges(numThreads);
+        utilities::ParallelForBlocks(numThreads, [this, numThreads, &transformationFunctions, &ranges](size_t threadIndex) {
+            auto fromIndex = _examples.size() * threadIndex / numThreads;
+            auto toIndex = _examples.size() * (threadIndex + 1) / numThreads;
+            ranges[threadIndex].reserve(toIndex - fromIndex);
+            for (auto index = fromIndex; index < toIndex; ++index)
+            {
+                ranges[threadIndex].push_back(transformationFunctions[threadIndex](_examples[index]));
+            }
+        });
+
+        Dataset<otherExampleType> dataset;
+        for (auto& range : ranges)
+        {
+            for (auto& example : range)
+            {
+                dataset.AddExample(std::move(example));
+            }
+        }
+        return dataset;
+    }
+
     template <typename DatasetExampleType>
     void Dataset<DatasetExampleType>::Reset()
     {
         _examples.clear();
         _numFeatures = 0;
+        _arena = nullptr;
     }
 
     template <typename DatasetExampleType>
@@ -448,6 +638,23 @@ namespace data
         }
     }
 
+    template <typename DatasetExampleType>
+    void Dataset<DatasetExampleType>::RandomPermute(std::default_random_engine& rng, std::vector<size_t>& permutation) const
+    {
+        if (permutation.size() != _examples.size())
+        {
+            permutation.resize(_examples.size());
+            std::iota(permutation.begin(), permutation.end(), 0);
+        }
+
+        using std::swap;
+        for (size_t i = 0; i < permutation.size(); ++i)
+        {
+            std::uniform_int_distribution<size_t> dist(i, permutation.size() - 1);
+            swap(permutation[i], permutation[dist(rng)]);
+        }
+    }
+
     template <typename DatasetExampleType>
     void Dataset<DatasetExampleType>::RandomSwap(std::default_random_engine& rng, size_t targetExampleIndex, size_t rangeFirstIndex, size_t rangeSize)
     {
@@ -489,12 +696,20 @@ namespace data
     {
         size = CorrectRangeSize(fromIndex, size);
 
+        const size_t maxBufferSize = size_t{ 1 } << 20;
+        const std::string indent(tabs * 4, ' ');
+        utilities::OutputBuffer buffer;
         for (size_t index = fromIndex; index < fromIndex + size; ++index)
         {
-            os << std::string(tabs * 4, ' ');
-            _examples[index].Print(os);
-            os << EOL;
+            buffer << indent;
+            _examples[index].Print(buffer);
+            buffer << '\n';
+            if (buffer.Size() > maxBufferSize)
+            {
+                buffer.WriteTo(os);
+            }
         }
+        buffer.WriteTo(os);
     }
 
     template <typename DatasetExampleType>
@@ -504,6 +719,15 @@ namespace data
         return os;
     }
 
+    template <typename ExampleType>
+    void WriteTextDataset(const Dataset<ExampleType>& dataset, std::ostream& os, size_t numThreads)
+    {
+        utilities::WriteInParallel(dataset.NumExamples(), os, numThreads, [&dataset](size_t index, utilities::OutputBuffer& buffer) {
+            dataset[index].Print(buffer);
+            buffer << '\n';
+        });
+    }
+
     template <typename DatasetExampleType>
     size_t Dataset<DatasetExampleType>::CorrectRangeSize(size_t fromIndex, size_t size) const
     {
@@ -25,11 +25,14 @@ namespace ell
 {
 namespace data
 {
-    /// <summary> DenseDataVector Base class. </summary>
+    /// <summary>
+    /// DenseDataVector Base class. The class is final, so calls through a DenseDataVector (rather than through
+    /// an IDataVector) are resolved at compile time.
+    /// </summary>
     ///
     /// <typeparam name="ElementType"> Type of the value type. </typeparam>
     template <typename ElementType>
-    class DenseDataVector : public DataVectorBase<DenseDataVector<ElementType>>
+    class DenseDataVector final : public DataVectorBase<DenseDataVector<ElementType>>
     {
     public:
         /// <summary> Constructor. </summary>
@@ -71,6 +74,12 @@ namespace data
         /// <param name="list"> The vector of values. </param>
         DenseDataVector(std::vector<float> vec);
 
+        /// <summary> Constructs a data vector by copying an array of elements. </summary>
+        ///
+        /// <param name="begin"> Pointer to the first element. </param>
+        /// <param name="end"> Pointer just past the last element. </param>
+        DenseDataVector(const ElementType* begin, const ElementType* end);
+
         /// <summary> Array indexer operator. </summary>
         ///
         /// <param name="index"> Zero-based index of the desired element. </param>
@@ -116,6 +125,30 @@ namespace data
         /// <returns> The first index of the suffix of zeros at the end of this vector. </returns>
         size_t PrefixLength() const override { return _data.size(); }
 
+        /// <summary> Computes the squared 2-norm of the vector. </summary>
+        ///
+        /// <returns> The squared 2-norm of the vector. </returns>
+        double Norm2Squared() const override;
+
+        /// <summary> Computes the dot product with another vector. </summary>
+        ///
+        /// <param name="vector"> The other vector. </param>
+        ///
+        /// <returns> A dot product. </returns>
+        double Dot(math::UnorientedConstVectorBase<double> vector) const override;
+
+        /// <summary> Computes the dot product with another vector. </summary>
+        ///
+        /// <param name="vector"> The other vector. </param>
+        ///
+        /// <returns> A dot product. </returns>
+        float Dot(math::UnorientedConstVectorBase<float> vector) const override;
+
+        /// <summary> Adds this data vector to a math::RowVector </summary>
+        ///
+        /// <param name="vector"> [in,out] The vector to which this data vector is added. </param>
+        void AddTo(math::RowVectorReference<double> vector) const override;
+
         /// <summary> Gets the data vector type (implemented by template specialization). </summary>
         ///
         /// <returns> The data vector type. </returns>
@@ -152,6 +185,7 @@ namespace data
 #include <utilities/include/StringUtil.h>
 #include <utilities/include/TypeName.h>
 
+#include <algorithm>
 #include <cassert>
 
 namespace ell
@@ -202,6 +236,13 @@ namespace data
         AppendElements(std::move(list));
     }
 
+    template <typename ElementType>
+    DenseDataVector<ElementType>::DenseDataVector(const ElementType* begin, const ElementType* end) :
+        _numNonzeros(static_cast<size_t>(std::count_if(begin, end, [](ElementType value) { return value != 0; }))),
+        _data(begin, end)
+    {
+    }
+
     template <typename ElementType>
     double DenseDataVector<ElementType>::operator[](size_t index) const
     {
@@ -226,6 +267,61 @@ namespace data
         return GetIterator<policy>(PrefixLength());
     }
 
+    // The dense overrides loop over the stored elements directly, instead of going through an index-value
+    // iterator that tests each element for zero, so that the compiler can vectorize them
+    template <typename ElementType>
+    double DenseDataVector<ElementType>::Norm2Squared() const
+    {
+        double result = 0.0;
+        for (auto value : _data)
+        {
+            result += static_cast<double>(value) * static_cast<double>(value);
+        }
+        return result;
+    }
+
+    template <typename ElementType>
+    double DenseDataVector<ElementType>::Dot(math::UnorientedConstVectorBase<double> vector) const
+    {
+        auto size = std::min(_data.size(), vector.Size());
+        auto pVector = vector.GetConstDataPointer();
+        auto increment = vector.GetIncrement();
+
+        double result = 0.0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            result += static_cast<double>(_data[i]) * pVector[i * increment];
+        }
+        return result;
+    }
+
+    template <typename ElementType>
+    float DenseDataVector<ElementType>::Dot(math::UnorientedConstVectorBase<float> vector) const
+    {
+        auto size = std::min(_data.size(), vector.Size());
+        auto pVector = vector.GetConstDataPointer();
+        auto increment = vector.GetIncrement();
+
+        float result = 0.0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            result += static_cast<float>(_data[i]) * pVector[i * increment];
+        }
+        return result;
+    }
+
+    template <typename ElementType>
+    void DenseDataVector<ElementType>::AddTo(math::RowVectorReference<double> vector) const
+    {
+        auto size = std::min(_data.size(), vector.Size());
+        auto pVector = vector.GetDataPointer();
+        auto increment = vector.GetIncrement();
+        for (size_t i = 0; i < size; ++i)
+        {
+            pVector[i * increment] += static_cast<double>(_data[i]);
+        }
+    }
+
     template <typename ElementType>
     void DenseDataVector<ElementType>::AppendElement(size_t index, double value)
     {
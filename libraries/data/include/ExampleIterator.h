@@ -11,6 +11,9 @@
 #include <utilities/include/IIterator.h>
 #include <utilities/include/StlContainerIterator.h>
 
+#include <cstddef>
+#include <vector>
+
 namespace ell
 {
 namespace data
@@ -19,6 +22,43 @@ namespace data
     template <typename ExampleType>
     using ExampleReferenceIterator = utilities::VectorReferenceIterator<ExampleType>;
 
+    /// <summary>
+    /// An iterator over examples whose Get() function returns a const reference to an example, which visits
+    /// the examples in the order given by a list of indices rather than in the order they are stored.
+    /// </summary>
+    ///
+    /// <typeparam name="ExampleType"> Example type. </typeparam>
+    template <typename ExampleType>
+    class PermutedExampleReferenceIterator
+    {
+    public:
+        /// <summary> Constructs an instance of PermutedExampleReferenceIterator. </summary>
+        ///
+        /// <param name="examples"> The examples. </param>
+        /// <param name="permutation"> The indices of the examples to visit, in the order to visit them. </param>
+        PermutedExampleReferenceIterator(const std::vector<ExampleType>& examples, const std::vector<size_t>& permutation) :
+            _examples(examples),
+            _permutation(permutation) {}
+
+        /// <summary> Returns true if the iterator is currently pointing to a valid iterate. </summary>
+        ///
+        /// <returns> true if the iterator is currently pointing to a valid iterate. </returns>
+        bool IsValid() const { return _position < _permutation.size(); }
+
+        /// <summary> Proceeds to the Next iterate. </summary>
+        void Next() { ++_position; }
+
+        /// <summary> Returns the current example. </summary>
+        ///
+        /// <returns> A const reference to the example. </returns>
+        const ExampleType& Get() const { return _examples[_permutation[_position]]; }
+
+    private:
+        const std::vector<ExampleType>& _examples;
+        const std::vector<size_t>& _permutation;
+        size_t _position = 0;
+    };
+
     /// <summary> Interface for example iterators whose Get() function returns an example (rather than a const reference). </summary>
     ///
     /// <typeparam name="ExampleType"> Example type. </typeparam>
@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ParallelParsing.h (data)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Dataset.h"
+#include "Example.h"
+
+#include <cstddef>
+
+namespace ell
+{
+namespace data
+{
+    /// <summary>
+    /// Parses a block of text, with one example per line, into a dataset. The text is split at line
+    /// boundaries into pieces that are parsed concurrently, and the examples are then joined in the
+    /// order in which they appear in the text. Each line is parsed like SingleLineParsingExampleIterator
+    /// does: lines that have only whitespace or a comment are skipped, the metadata parser is applied
+    /// first, and the data vector parser second.
+    /// </summary>
+    ///
+    /// <typeparam name="MetadataParserType"> Metadata parser type. </typeparam>
+    /// <typeparam name="DataVectorParserType"> DataVector parser type. </typeparam>
+    /// <param name="begin"> Pointer to the first character of the text. </param>
+    /// <param name="end"> Pointer just past the last character of the text. </param>
+    /// <param name="metadataParser"> The metadata parser, which is copied for each thread. </param>
+    /// <param name="dataVectorParser"> The data vector parser, which is copied for each thread. </param>
+    /// <param name="numThreads"> The number of threads to use, zero to use one per core. Inside a parallel region
+    /// (see `utilities::IsInParallelRegion`) the calling thread parses everything. </param>
+    ///
+    /// <returns> The dataset. </returns>
+    template <typename MetadataParserType, typename DataVectorParserType>
+    Dataset<ParserExample<DataVectorParserType, MetadataParserType>> ParseDatasetInParallel(const char* begin, const char* end, const MetadataParserType& metadataParser, const DataVectorParserType& dataVectorParser, size_t numThreads = 0);
+} // namespace data
+} // namespace ell
+
+#pragma region implementation
+
+#include "TextLine.h"
+
+#include <utilities/include/ParallelFor.h>
+
+#include <algorithm>
+#include <future>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ell
+{
+namespace data
+{
+    namespace detail
+    {
+        // the data vector and metadata of an example, which the dataset turns into an example that lives in its arena
+        template <typename MetadataParserType, typename DataVectorParserType>
+        using ParsedLine = std::pair<typename DataVectorParserType::type, typename MetadataParserType::type>;
+
+        template <typename MetadataParserType, typename DataVectorParserType>
+        std::vector<ParsedLine<MetadataParserType, DataVectorParserType>> ParseLines(const char* begin, const char* end, MetadataParserType metadataParser, DataVectorParserType dataVectorParser)
+        {
+            std::vector<ParsedLine<MetadataParserType, DataVectorParserType>> examples;
+            while (begin < end)
+            {
+                auto lineEnd = std::find(begin, end, '\n');
+
+                // the parsers need a null-terminated string
+                TextLine line(std::string(begin, lineEnd));
+                begin = lineEnd == end ? end : lineEnd + 1;
+
+                line.TrimLeadingWhitespace();
+                if (line.IsEndOfContent())
+                {
+                    continue;
+                }
+
+                auto metadata = metadataParser.Parse(line);
+                auto dataVector = dataVectorParser.Parse(line);
+                examples.emplace_back(std::move(dataVector), std::move(metadata));
+            }
+            return examples;
+        }
+    } // namespace detail
+
+    template <typename MetadataParserType, typename DataVectorParserType>
+    Dataset<ParserExample<DataVectorParserType, MetadataParserType>> ParseDatasetInParallel(const char* begin, const char* end, const MetadataParserType& metadataParser, const DataVectorParserType& dataVectorParser, size_t numThreads)
+    {
+        using ExampleType = ParserExample<DataVectorParserType, MetadataParserType>;
+
+        // Like the utilities ParallelFor functions, parse on the calling thread when called from parallel code
+        numThreads = utilities::IsInParallelRegion() ? 1 : utilities::GetNumThreads(numThreads);
+        auto launchPolicy = numThreads > 1 ? std::launch::async : std::launch::deferred;
+        auto parsePiece = [&metadataParser, &dataVectorParser](const char* pieceBegin, const char* pieceEnd) {
+            utilities::ParallelRegion region;
+            return detail::ParseLines(pieceBegin, pieceEnd, metadataParser, dataVectorParser);
+        };
+
+        // Split into more pieces than threads, so that pieces with long lines don't hold up the others.
+        // Each piece but the first starts right after a newline.
+        const size_t piecesPerThread = 4;
+        auto numPieces = numThreads * piecesPerThread;
+        auto pieceSize = std::max(static_cast<size_t>(end - begin) / numPieces, size_t{ 1 });
+        std::vector<const char*> pieceBegins = { begin };
+        while (pieceBegins.back() < end)
+        {
+            auto pieceEnd = pieceBegins.back() + std::min(pieceSize, static_cast<size_t>(end - pieceBegins.back()));
+            pieceEnd = std::find(pieceEnd, end, '\n');
+            pieceBegins.push_back(pieceEnd == end ? end : pieceEnd + 1);
+        }
+
+        // Parse the pieces, with at most numThreads of them in flight
+        std::vector<std::future<std::vector<detail::ParsedLine<MetadataParserType, DataVectorParserType>>>> pieces;
+        Dataset<ExampleType> dataset;
+        size_t nextToJoin = 0;
+        for (size_t pieceIndex = 0; pieceIndex + 1 < pieceBegins.size(); ++pieceIndex)
+        {
+            if (pieces.size() - nextToJoin == numThreads)
+            {
+                for (auto& example : pieces[nextToJoin++].get())
+                {
+                    dataset.AddExample(std::move(example.first), std::move(example.second));
+                }
+            }
+            pieces.push_back(std::async(launchPolicy, parsePiece, pieceBegins[pieceIndex], pieceBegins[pieceIndex + 1]));
+        }
+
+        for (; nextToJoin < pieces.size(); ++nextToJoin)
+        {
+            for (auto& example : pieces[nextToJoin].get())
+            {
+                dataset.AddExample(std::move(example.first), std::move(example.second));
+            }
+        }
+        return dataset;
+    }
+} // namespace data
+} // namespace ell
+
+#pragma endregion implementation
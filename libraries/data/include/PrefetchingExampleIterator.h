@@ -0,0 +1,243 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PrefetchingExampleIterator.h (data)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Example.h"
+#include "ExampleIterator.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ell
+{
+namespace data
+{
+    /// <summary>
+    /// An example iterator that reads the examples of another iterator ahead of time, on a background thread. The
+    /// background thread reads blocks of examples into a bounded queue, so reading and parsing the examples overlaps
+    /// with the work done on them, and the iterator only waits when the queue is empty. The source iterator is only
+    /// used by the background thread after construction, so it must not share state with the caller.
+    /// </summary>
+    ///
+    /// <typeparam name="ExampleType"> Example type. </typeparam>
+    template <typename ExampleType>
+    class PrefetchingExampleIterator : public IExampleIterator<ExampleType>
+    {
+    public:
+        /// <summary> Constructs a PrefetchingExampleIterator. </summary>
+        ///
+        /// <param name="source"> The iterator to read the examples from. </param>
+        /// <param name="blockSize"> The number of examples the background thread reads at a time. </param>
+        /// <param name="maxQueuedBlocks"> The maximal number of blocks read ahead of the current one. </param>
+        PrefetchingExampleIterator(ExampleIterator<ExampleType> source, size_t blockSize, size_t maxQueuedBlocks);
+
+        PrefetchingExampleIterator(const PrefetchingExampleIterator&) = delete;
+        PrefetchingExampleIterator& operator=(const PrefetchingExampleIterator&) = delete;
+
+        /// <summary> Stops the background thread and waits for it to finish. </summary>
+        ~PrefetchingExampleIterator() override;
+
+        /// <summary> Returns true if the iterator is currently pointing to a valid iterate. </summary>
+        ///
+        /// <returns> true if the iterator is valid, false otherwise. </returns>
+        bool IsValid() const override { return _position < _block.size(); }
+
+        /// <summary> Proceeds to the next example. Rethrows an exception thrown by the source iterator once the
+        /// examples read before it are used up. </summary>
+        void Next() override;
+
+        /// <summary> Gets the current example. </summary>
+        ///
+        /// <returns> The current example. </returns>
+        ExampleType Get() const override { return _block[_position]; }
+
+    private:
+        void ReadBlocks();
+        void TakeNextBlock();
+
+        ExampleIterator<ExampleType> _source;
+        size_t _blockSize;
+        size_t _maxQueuedBlocks;
+
+        // the block the iterator is in, which only the caller's thread uses
+        std::vector<ExampleType> _block;
+        size_t _position = 0;
+
+        // the blocks read ahead, shared with the background thread
+        std::mutex _mutex;
+        std::condition_variable _blockAdded;
+        std::condition_variable _blockRemoved;
+        std::deque<std::vector<ExampleType>> _queue;
+        bool _isSourceDone = false;
+        bool _isStopping = false;
+        std::exception_ptr _exception;
+
+        std::thread _thread;
+    };
+
+    /// <summary> Helper function that wraps an example iterator in a PrefetchingExampleIterator. </summary>
+    ///
+    /// <typeparam name="ExampleType"> Example type. </typeparam>
+    /// <param name="source"> The iterator to read the examples from. </param>
+    /// <param name="blockSize"> The number of examples the background thread reads at a time. </param>
+    /// <param name="maxQueuedBlocks"> The maximal number of blocks read ahead of the current one. </param>
+    ///
+    /// <returns> The prefetching example iterator. </returns>
+    template <typename ExampleType>
+    ExampleIterator<ExampleType> MakePrefetchingExampleIterator(ExampleIterator<ExampleType> source, size_t blockSize = 256, size_t maxQueuedBlocks = 4);
+} // namespace data
+} // namespace ell
+
+#pragma region implementation
+
+#include <utilities/include/Exception.h>
+
+#include <utility>
+
+namespace ell
+{
+namespace data
+{
+    template <typename ExampleType>
+    PrefetchingExampleIterator<ExampleType>::PrefetchingExampleIterator(ExampleIterator<ExampleType> source, size_t blockSize, size_t maxQueuedBlocks) :
+        _source(std::move(source)),
+        _blockSize(blockSize),
+        _maxQueuedBlocks(maxQueuedBlocks)
+    {
+        if (_blockSize == 0 || _maxQueuedBlocks == 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "blockSize and maxQueuedBlocks must be positive");
+        }
+
+        _thread = std::thread([this]() { ReadBlocks(); });
+        try
+        {
+            TakeNextBlock();
+        }
+        catch (...)
+        {
+            // the background thread has stopped after the exception it caught
+            _thread.join();
+            throw;
+        }
+    }
+
+    template <typename ExampleType>
+    PrefetchingExampleIterator<ExampleType>::~PrefetchingExampleIterator()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _isStopping = true;
+        }
+        _blockRemoved.notify_one();
+        _thread.join();
+    }
+
+    template <typename ExampleType>
+    void PrefetchingExampleIterator<ExampleType>::Next()
+    {
+        if (!IsValid())
+        {
+            return;
+        }
+
+        ++_position;
+        if (_position >= _block.size())
+        {
+            TakeNextBlock();
+        }
+    }
+
+    template <typename ExampleType>
+    void PrefetchingExampleIterator<ExampleType>::ReadBlocks()
+    {
+        std::vector<ExampleType> block;
+        try
+        {
+            while (true)
+            {
+                block.clear();
+                block.reserve(_blockSize);
+                for (; block.size() < _blockSize && _source.IsValid(); _source.Next())
+                {
+                    block.push_back(_source.Get());
+                }
+
+                std::unique_lock<std::mutex> lock(_mutex);
+                _blockRemoved.wait(lock, [this]() { return _isStopping || _queue.size() < _maxQueuedBlocks; });
+                if (_isStopping)
+                {
+                    return;
+                }
+
+                if (!block.empty())
+                {
+                    _queue.push_back(std::move(block));
+                    block.clear();
+                }
+                _isSourceDone = !_source.IsValid();
+                _blockAdded.notify_one();
+                if (_isSourceDone)
+                {
+                    return;
+                }
+            }
+        }
+        catch (...)
+        {
+            // the examples read before the exception come first
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!block.empty())
+            {
+                _queue.push_back(std::move(block));
+            }
+            _exception = std::current_exception();
+            _isSourceDone = true;
+            _blockAdded.notify_one();
+        }
+    }
+
+    template <typename ExampleType>
+    void PrefetchingExampleIterator<ExampleType>::TakeNextBlock()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _blockAdded.wait(lock, [this]() { return !_queue.empty() || _isSourceDone; });
+
+        _position = 0;
+        if (_queue.empty())
+        {
+            _block.clear();
+            if (_exception)
+            {
+                std::rethrow_exception(std::exchange(_exception, nullptr));
+            }
+            return;
+        }
+
+        _block = std::move(_queue.front());
+        _queue.pop_front();
+        _blockRemoved.notify_one();
+    }
+
+    template <typename ExampleType>
+    ExampleIterator<ExampleType> MakePrefetchingExampleIterator(ExampleIterator<ExampleType> source, size_t blockSize, size_t maxQueuedBlocks)
+    {
+        auto iterator = std::make_unique<PrefetchingExampleIterator<ExampleType>>(std::move(source), blockSize, maxQueuedBlocks);
+        return ExampleIterator<ExampleType>(std::move(iterator));
+    }
+} // namespace data
+} // namespace ell
+
+#pragma endregion implementation
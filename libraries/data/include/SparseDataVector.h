@@ -12,8 +12,10 @@
 #ifndef SPARSEDATAVECTOR_H
 #define SPARSEDATAVECTOR_H
 
+#include <utilities/include/BlockCompressedIntegerList.h>
 #include <utilities/include/CompressedIntegerList.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <initializer_list>
 #include <type_traits>
@@ -110,7 +112,7 @@ namespace data
     /// <typeparam name="ElementType"> Type of the vector elements. </typeparam>
     /// <typeparam name="tegerListType"> Type of the integer list used to store indices. </typeparam>
     template <typename ElementType, typename IndexListType>
-    class SparseDataVector : public DataVectorBase<SparseDataVector<ElementType, IndexListType>>
+    class SparseDataVector final : public DataVectorBase<SparseDataVector<ElementType, IndexListType>>
     {
     public:
         SparseDataVector() = default;
@@ -146,6 +148,12 @@ namespace data
         /// <param name="list"> The initializer list of values. </param>
         SparseDataVector(std::vector<double> vec);
 
+        /// <summary> Constructs a data vector from its index list and the corresponding values. </summary>
+        ///
+        /// <param name="indexList"> The indices of the non-zero elements. </param>
+        /// <param name="values"> The non-zero values, one per index. </param>
+        SparseDataVector(IndexListType indexList, std::vector<ElementType> values);
+
         template <IterationPolicy policy>
         using Iterator = SparseDataVectorIterator<policy, ElementType, IndexListType>;
 
@@ -190,6 +198,30 @@ namespace data
         /// <returns> The first index of the suffix of zeros at the end of this vector. </returns>
         size_t PrefixLength() const override;
 
+        /// <summary> Computes the squared 2-norm of the vector. </summary>
+        ///
+        /// <returns> The squared 2-norm of the vector. </returns>
+        double Norm2Squared() const override;
+
+        /// <summary> Computes the dot product with another vector. </summary>
+        ///
+        /// <param name="vector"> The other vector. </param>
+        ///
+        /// <returns> A dot product. </returns>
+        double Dot(math::UnorientedConstVectorBase<double> vector) const override;
+
+        /// <summary> Computes the dot product with another vector. </summary>
+        ///
+        /// <param name="vector"> The other vector. </param>
+        ///
+        /// <returns> A dot product. </returns>
+        float Dot(math::UnorientedConstVectorBase<float> vector) const override;
+
+        /// <summary> Adds this data vector to a math::RowVector </summary>
+        ///
+        /// <param name="vector"> [in,out] The vector to which this data vector is added. </param>
+        void AddTo(math::RowVectorReference<double> vector) const override;
+
         /// <summary> Gets the data vector type (implemented by template specialization). </summary>
         ///
         /// <returns> The data vector type. </returns>
@@ -202,6 +234,11 @@ namespace data
 
     private:
         using DataVectorBase<SparseDataVector<ElementType, IndexListType>>::AppendElements;
+
+        // calls `function(indices, values, count)` on consecutive chunks of the non-zero elements, until it returns false
+        template <typename FunctionType>
+        void ForEachChunk(FunctionType function) const;
+
         IndexListType _indexList;
         std::vector<ElementType> _values;
     };
@@ -217,6 +254,18 @@ namespace data
 
     /// <summary> A sparse data vector with byte elements. </summary>
     using SparseByteDataVector = SparseDataVector<char, utilities::CompressedIntegerList>;
+
+    /// <summary> A sparse data vector with double elements, whose indices are faster to read. </summary>
+    using BlockSparseDoubleDataVector = SparseDataVector<double, utilities::BlockCompressedIntegerList>;
+
+    /// <summary> A sparse data vector with float elements, whose indices are faster to read. </summary>
+    using BlockSparseFloatDataVector = SparseDataVector<float, utilities::BlockCompressedIntegerList>;
+
+    /// <summary> A sparse data vector with short elements, whose indices are faster to read. </summary>
+    using BlockSparseShortDataVector = SparseDataVector<short, utilities::BlockCompressedIntegerList>;
+
+    /// <summary> A sparse data vector with byte elements, whose indices are faster to read. </summary>
+    using BlockSparseByteDataVector = SparseDataVector<char, utilities::BlockCompressedIntegerList>;
 } // namespace data
 } // namespace ell
 
@@ -334,6 +383,17 @@ namespace data
         AppendElements(std::move(vec));
     }
 
+    template <typename ElementType, typename IndexListType>
+    SparseDataVector<ElementType, IndexListType>::SparseDataVector(IndexListType indexList, std::vector<ElementType> values) :
+        _indexList(std::move(indexList)),
+        _values(std::move(values))
+    {
+        if (_indexList.Size() != _values.size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "index list and values must have the same size");
+        }
+    }
+
     template <typename ElementType, typename IndexListType>
     void SparseDataVector<ElementType, IndexListType>::AppendElement(size_t index, double value)
     {
@@ -369,6 +429,94 @@ namespace data
             return _indexList.Max() + 1;
         }
     }
+
+    // The overrides below read the indices a chunk at a time, which is much faster than one at a time for block
+    // encoded lists, and then loop over the chunk with a gather from the dense vector
+    template <typename ElementType, typename IndexListType>
+    template <typename FunctionType>
+    void SparseDataVector<ElementType, IndexListType>::ForEachChunk(FunctionType function) const
+    {
+        constexpr size_t chunkSize = 64;
+        size_t indices[chunkSize];
+        auto indexIterator = _indexList.GetIterator();
+        const ElementType* values = _values.data();
+        size_t count;
+        while ((count = indexIterator.Read(indices, chunkSize)) > 0)
+        {
+            if (!function(indices, values, count))
+            {
+                return;
+            }
+            values += count;
+        }
+    }
+
+    template <typename ElementType, typename IndexListType>
+    double SparseDataVector<ElementType, IndexListType>::Norm2Squared() const
+    {
+        double result = 0.0;
+        for (auto value : _values)
+        {
+            result += static_cast<double>(value) * static_cast<double>(value);
+        }
+        return result;
+    }
+
+    template <typename ElementType, typename IndexListType>
+    double SparseDataVector<ElementType, IndexListType>::Dot(math::UnorientedConstVectorBase<double> vector) const
+    {
+        auto size = vector.Size();
+        auto pVector = vector.GetConstDataPointer();
+        auto increment = vector.GetIncrement();
+
+        double result = 0.0;
+        ForEachChunk([&](const size_t* indices, const ElementType* values, size_t count) {
+            // the indices increase, so only the end of a chunk can be past the end of the vector
+            auto end = static_cast<size_t>(std::lower_bound(indices, indices + count, size) - indices);
+            for (size_t i = 0; i < end; ++i)
+            {
+                result += static_cast<double>(values[i]) * pVector[indices[i] * increment];
+            }
+            return end == count;
+        });
+        return result;
+    }
+
+    template <typename ElementType, typename IndexListType>
+    float SparseDataVector<ElementType, IndexListType>::Dot(math::UnorientedConstVectorBase<float> vector) const
+    {
+        auto size = vector.Size();
+        auto pVector = vector.GetConstDataPointer();
+        auto increment = vector.GetIncrement();
+
+        float result = 0.0;
+        ForEachChunk([&](const size_t* indices, const ElementType* values, size_t count) {
+            auto end = static_cast<size_t>(std::lower_bound(indices, indices + count, size) - indices);
+            for (size_t i = 0; i < end; ++i)
+            {
+                result += static_cast<float>(values[i]) * pVector[indices[i] * increment];
+            }
+            return end == count;
+        });
+        return result;
+    }
+
+    template <typename ElementType, typename IndexListType>
+    void SparseDataVector<ElementType, IndexListType>::AddTo(math::RowVectorReference<double> vector) const
+    {
+        auto size = vector.Size();
+        auto pVector = vector.GetDataPointer();
+        auto increment = vector.GetIncrement();
+
+        ForEachChunk([&](const size_t* indices, const ElementType* values, size_t count) {
+            auto end = static_cast<size_t>(std::lower_bound(indices, indices + count, size) - indices);
+            for (size_t i = 0; i < end; ++i)
+            {
+                pVector[indices[i] * increment] += static_cast<double>(values[i]);
+            }
+            return end == count;
+        });
+    }
 } // namespace data
 } // namespace ell
 
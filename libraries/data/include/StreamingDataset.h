@@ -0,0 +1,401 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     StreamingDataset.h (data)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Dataset.h"
+#include "Example.h"
+#include "ExampleIterator.h"
+#include "PrefetchingExampleIterator.h"
+
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace data
+{
+    /// <summary>
+    /// A dataset that stays on disk, in one or more text files (shards), and is parsed a chunk at a time
+    /// whenever it is iterated over. At most one chunk of examples is held in memory by each iterator, so
+    /// the dataset can be much larger than the available memory. Constructing the dataset makes one pass
+    /// over the shards that reads the lines, but doesn't parse them, to find where each chunk starts.
+    /// Shards can be gzip or zstd compressed, and are decompressed as they're read (so loading a chunk other
+    /// than the first of a compressed shard decompresses the shard up to it).
+    /// </summary>
+    ///
+    /// <typeparam name="DatasetExampleT"> Example type produced by the parser. </typeparam>
+    template <typename DatasetExampleT>
+    class StreamingDataset : public DatasetBase
+    {
+    public:
+        using DatasetExampleType = DatasetExampleT;
+
+        /// <summary> A function that returns an iterator that parses the examples in a stream. </summary>
+        using ParserFunction = std::function<ExampleIterator<DatasetExampleType>(std::istream&)>;
+
+        /// <summary> Constructs an instance of StreamingDataset. </summary>
+        ///
+        /// <param name="shardFilenames"> The files that contain the examples, one example per line. </param>
+        /// <param name="parser"> A function that returns an example iterator that parses a stream. </param>
+        /// <param name="maxExamplesInMemory"> The number of examples in a chunk, which bounds
+        /// the number of parsed examples that an iterator keeps in memory. </param>
+        StreamingDataset(std::vector<std::string> shardFilenames, ParserFunction parser, size_t maxExamplesInMemory);
+
+        StreamingDataset(StreamingDataset&&) = default;
+
+        StreamingDataset(const StreamingDataset&) = delete;
+
+        /// <summary> Returns the number of examples in the data set. </summary>
+        ///
+        /// <returns> The number of examples. </returns>
+        size_t NumExamples() const { return _numExamples; }
+
+        /// <summary> Returns the number of chunks the examples are divided into. </summary>
+        ///
+        /// <returns> The number of chunks. </returns>
+        size_t NumChunks() const { return _chunks.size(); }
+
+        /// <summary> Returns the maximal number of examples in a chunk. </summary>
+        ///
+        /// <returns> The maximal number of examples in a chunk. </returns>
+        size_t GetMaxExamplesInMemory() const { return _maxExamplesInMemory; }
+
+        /// <summary> Returns the index of the first example in a chunk. </summary>
+        ///
+        /// <param name="chunkIndex"> Zero-based index of the chunk. </param>
+        ///
+        /// <returns> The index of the first example in the chunk, in the order the examples appear in the shards. </returns>
+        size_t GetChunkFirstExampleIndex(size_t chunkIndex) const { return _chunks[chunkIndex].firstExampleIndex; }
+
+        /// <summary> Reads and parses the examples of one chunk. </summary>
+        ///
+        /// <typeparam name="ChunkExampleType"> Example type of the returned dataset. </typeparam>
+        /// <param name="chunkIndex"> Zero-based index of the chunk. </param>
+        ///
+        /// <returns> An in-memory dataset that holds the chunk's examples. </returns>
+        template <typename ChunkExampleType = DatasetExampleType>
+        Dataset<ChunkExampleType> LoadChunk(size_t chunkIndex) const;
+
+        /// <summary> Returns an iterator that reads the examples in the order they appear in the shards. The examples
+        /// are read and parsed ahead of time on a background thread. </summary>
+        ///
+        /// <param name="fromIndex"> Zero-based index of the first example to iterate over. </param>
+        /// <param name="size"> The number of examples to iterate over, a value of zero means all
+        /// the way to the end. </param>
+        ///
+        /// <returns> The iterator. </returns>
+        template <typename IteratorExampleType = DatasetExampleType>
+        ExampleIterator<IteratorExampleType> GetExampleIterator(size_t fromIndex = 0, size_t size = 0) const;
+
+        /// <summary>
+        /// Returns an iterator that visits the chunks in a random order and the examples of each chunk in a
+        /// random order. Consecutive examples from the iterator therefore form shuffled mini-batches.
+        /// </summary>
+        ///
+        /// <param name="rng"> [in,out] The random number generator. </param>
+        ///
+        /// <returns> The iterator. </returns>
+        template <typename IteratorExampleType = DatasetExampleType>
+        ExampleIterator<IteratorExampleType> GetShuffledExampleIterator(std::default_random_engine& rng) const;
+
+        /// <summary> Returns an AnyDataset that represents an interval of examples from this dataset. </summary>
+        ///
+        /// <param name="fromIndex"> Zero-based index of the first example in the AnyDataset. </param>
+        /// <param name="size"> The number of examples to include, a value of zero means all
+        /// the way to the end. </param>
+        ///
+        /// <returns> The dataset. </returns>
+        AnyDataset GetAnyDataset(size_t fromIndex = 0, size_t size = 0) const { return AnyDataset(this, fromIndex, size == 0 ? _numExamples - fromIndex : size); }
+
+    private:
+        struct Chunk
+        {
+            size_t shardIndex;
+            std::streamoff offset;
+            size_t firstExampleIndex;
+            size_t numExamples;
+        };
+
+        template <typename IteratorExampleType>
+        class ChunkExampleIterator : public IExampleIterator<IteratorExampleType>
+        {
+        public:
+            ChunkExampleIterator(const StreamingDataset<DatasetExampleType>& dataset, std::vector<size_t> chunkOrder, std::default_random_engine* rng);
+
+            bool IsValid() const override { return _current < _examples.size(); }
+
+            void Next() override;
+
+            IteratorExampleType Get() const override { return _chunk[_examples[_current]].template CopyAs<IteratorExampleType>(); }
+
+        private:
+            void LoadNextChunk();
+
+            const StreamingDataset<DatasetExampleType>& _dataset;
+            std::vector<size_t> _chunkOrder;
+            std::default_random_engine* _rng;
+            size_t _nextChunk = 0;
+            Dataset<DatasetExampleType> _chunk;
+            std::vector<size_t> _examples;
+            size_t _current = 0;
+        };
+
+        template <typename IteratorExampleType>
+        class SequentialExampleIterator : public IExampleIterator<IteratorExampleType>
+        {
+        public:
+            SequentialExampleIterator(const StreamingDataset<DatasetExampleType>& dataset, size_t fromIndex, size_t size);
+
+            bool IsValid() const override { return _remaining > 0 && _iterator != nullptr && _iterator->IsValid(); }
+
+            void Next() override;
+
+            IteratorExampleType Get() const override { return _iterator->Get().template CopyAs<IteratorExampleType>(); }
+
+        private:
+            void OpenShard(size_t shardIndex, std::streamoff offset);
+
+            const StreamingDataset<DatasetExampleType>& _dataset;
+            size_t _shardIndex = 0;
+            size_t _remaining;
+            std::unique_ptr<std::istream> _stream;
+            std::unique_ptr<ExampleIterator<DatasetExampleType>> _iterator;
+        };
+
+        void FindChunks();
+        size_t CorrectRangeSize(size_t fromIndex, size_t size) const;
+
+        std::vector<std::string> _shardFilenames;
+        ParserFunction _parser;
+        size_t _maxExamplesInMemory;
+        std::vector<Chunk> _chunks;
+        size_t _numExamples = 0;
+    };
+
+    // friendly names
+    typedef StreamingDataset<AutoSupervisedExample> AutoSupervisedStreamingDataset;
+    typedef StreamingDataset<AutoSupervisedMultiClassExample> AutoSupervisedMultiClassStreamingDataset;
+} // namespace data
+} // namespace ell
+
+#pragma region implementation
+
+#include "TextLine.h"
+
+#include <utilities/include/DecompressingStream.h>
+#include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace ell
+{
+namespace data
+{
+    template <typename DatasetExampleType>
+    StreamingDataset<DatasetExampleType>::StreamingDataset(std::vector<std::string> shardFilenames, ParserFunction parser, size_t maxExamplesInMemory) :
+        _shardFilenames(std::move(shardFilenames)),
+        _parser(std::move(parser)),
+        _maxExamplesInMemory(maxExamplesInMemory)
+    {
+        if (_maxExamplesInMemory == 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "maxExamplesInMemory must be positive");
+        }
+        FindChunks();
+    }
+
+    template <typename DatasetExampleType>
+    void StreamingDataset<DatasetExampleType>::FindChunks()
+    {
+        for (size_t shardIndex = 0; shardIndex < _shardFilenames.size(); ++shardIndex)
+        {
+            auto stream = utilities::OpenDecompressingIfstream(_shardFilenames[shardIndex]);
+            size_t numShardExamples = 0;
+            std::string lineString;
+            while (true)
+            {
+                auto offset = static_cast<std::streamoff>(stream->tellg());
+                if (!std::getline(*stream, lineString))
+                {
+                    break;
+                }
+
+                // count the lines the parsing iterator doesn't skip
+                TextLine line(std::move(lineString));
+                line.TrimLeadingWhitespace();
+                if (line.IsEndOfContent())
+                {
+                    continue;
+                }
+
+                if (numShardExamples % _maxExamplesInMemory == 0)
+                {
+                    _chunks.push_back({ shardIndex, offset, _numExamples, 0 });
+                }
+                ++_chunks.back().numExamples;
+                ++numShardExamples;
+                ++_numExamples;
+            }
+        }
+    }
+
+    template <typename DatasetExampleType>
+    template <typename ChunkExampleType>
+    Dataset<ChunkExampleType> StreamingDataset<DatasetExampleType>::LoadChunk(size_t chunkIndex) const
+    {
+        const auto& chunk = _chunks[chunkIndex];
+        auto stream = utilities::OpenDecompressingIfstream(_shardFilenames[chunk.shardIndex]);
+        stream->seekg(chunk.offset);
+
+        Dataset<ChunkExampleType> result;
+        auto iterator = _parser(*stream);
+        for (size_t i = 0; i < chunk.numExamples && iterator.IsValid(); ++i)
+        {
+            result.AddExample(iterator.Get().template CopyAs<ChunkExampleType>());
+            iterator.Next();
+        }
+        return result;
+    }
+
+    template <typename DatasetExampleType>
+    template <typename IteratorExampleType>
+    ExampleIterator<IteratorExampleType> StreamingDataset<DatasetExampleType>::GetExampleIterator(size_t fromIndex, size_t size) const
+    {
+        size = CorrectRangeSize(fromIndex, size);
+        ExampleIterator<IteratorExampleType> iterator(std::make_unique<SequentialExampleIterator<IteratorExampleType>>(*this, fromIndex, size));
+        return MakePrefetchingExampleIterator(std::move(iterator));
+    }
+
+    template <typename DatasetExampleType>
+    template <typename IteratorExampleType>
+    ExampleIterator<IteratorExampleType> StreamingDataset<DatasetExampleType>::GetShuffledExampleIterator(std::default_random_engine& rng) const
+    {
+        std::vector<size_t> chunkOrder(_chunks.size());
+        std::iota(chunkOrder.begin(), chunkOrder.end(), 0);
+        std::shuffle(chunkOrder.begin(), chunkOrder.end(), rng);
+        return ExampleIterator<IteratorExampleType>(std::make_unique<ChunkExampleIterator<IteratorExampleType>>(*this, std::move(chunkOrder), &rng));
+    }
+
+    template <typename DatasetExampleType>
+    size_t StreamingDataset<DatasetExampleType>::CorrectRangeSize(size_t fromIndex, size_t size) const
+    {
+        if (fromIndex > _numExamples)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange);
+        }
+
+        if (size == 0 || fromIndex + size > _numExamples)
+        {
+            return _numExamples - fromIndex;
+        }
+        return size;
+    }
+
+    //
+    // ChunkExampleIterator
+    //
+    template <typename DatasetExampleType>
+    template <typename IteratorExampleType>
+    StreamingDataset<DatasetExampleType>::ChunkExampleIterator<IteratorExampleType>::ChunkExampleIterator(const StreamingDataset<DatasetExampleType>& dataset, std::vector<size_t> chunkOrder, std::default_random_engine* rng) :
+        _dataset(dataset),
+        _chunkOrder(std::move(chunkOrder)),
+        _rng(rng)
+    {
+        LoadNextChunk();
+    }
+
+    template <typename DatasetExampleType>
+    template <typename IteratorExampleType>
+    void StreamingDataset<DatasetExampleType>::ChunkExampleIterator<IteratorExampleType>::Next()
+    {
+        ++_current;
+        if (_current >= _examples.size())
+        {
+            LoadNextChunk();
+        }
+    }
+
+    template <typename DatasetExampleType>
+    template <typename IteratorExampleType>
+    void StreamingDataset<DatasetExampleType>::ChunkExampleIterator<IteratorExampleType>::LoadNextChunk()
+    {
+        _chunk.Reset();
+        _examples.clear();
+        _current = 0;
+
+        // skip over chunks that turn out to be empty, e.g. because a shard changed since the dataset was constructed
+        while (_examples.empty() && _nextChunk < _chunkOrder.size())
+        {
+            _chunk = _dataset.template LoadChunk<DatasetExampleType>(_chunkOrder[_nextChunk++]);
+            _examples.resize(_chunk.NumExamples());
+            std::iota(_examples.begin(), _examples.end(), 0);
+            if (_rng != nullptr)
+            {
+                std::shuffle(_examples.begin(), _examples.end(), *_rng);
+            }
+        }
+    }
+
+    //
+    // SequentialExampleIterator
+    //
+    template <typename DatasetExampleType>
+    template <typename IteratorExampleType>
+    StreamingDataset<DatasetExampleType>::SequentialExampleIterator<IteratorExampleType>::SequentialExampleIterator(const StreamingDataset<DatasetExampleType>& dataset, size_t fromIndex, size_t size) :
+        _dataset(dataset),
+        _remaining(size)
+    {
+        if (_remaining == 0)
+        {
+            return;
+        }
+
+        // start at the beginning of the chunk that contains the first example, and parse our way to it
+        auto chunk = std::upper_bound(_dataset._chunks.begin(), _dataset._chunks.end(), fromIndex, [](size_t index, const Chunk& c) { return index < c.firstExampleIndex; }) - 1;
+        OpenShard(chunk->shardIndex, chunk->offset);
+        for (auto index = chunk->firstExampleIndex; index < fromIndex && _iterator->IsValid(); ++index)
+        {
+            _iterator->Next();
+        }
+    }
+
+    template <typename DatasetExampleType>
+    template <typename IteratorExampleType>
+    void StreamingDataset<DatasetExampleType>::SequentialExampleIterator<IteratorExampleType>::Next()
+    {
+        --_remaining;
+        _iterator->Next();
+        while (_remaining > 0 && !_iterator->IsValid() && _shardIndex + 1 < _dataset._shardFilenames.size())
+        {
+            OpenShard(_shardIndex + 1, 0);
+        }
+    }
+
+    template <typename DatasetExampleType>
+    template <typename IteratorExampleType>
+    void StreamingDataset<DatasetExampleType>::SequentialExampleIterator<IteratorExampleType>::OpenShard(size_t shardIndex, std::streamoff offset)
+    {
+        // the parsing iterator holds a reference to the stream, so it has to go first
+        _iterator.reset();
+        _shardIndex = shardIndex;
+        _stream = utilities::OpenDecompressingIfstream(_dataset._shardFilenames[shardIndex]);
+        _stream->seekg(offset);
+        _iterator = std::make_unique<ExampleIterator<DatasetExampleType>>(_dataset._parser(*_stream));
+    }
+} // namespace data
+} // namespace ell
+
+#pragma endregion implementation
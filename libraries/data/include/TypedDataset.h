@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     TypedDataset.h (data)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AutoDataVector.h"
+#include "DataVector.h"
+#include "Dataset.h"
+#include "DenseDataVector.h"
+#include "Example.h"
+#include "SparseBinaryDataVector.h"
+#include "SparseDataVector.h"
+#include "WeightLabel.h"
+
+#include <variant>
+
+namespace ell
+{
+namespace data
+{
+    /// <summary>
+    /// A dataset whose examples all hold the same concrete data vector type. Code that is templated on the
+    /// dataset type calls the data vector operations without virtual dispatch, and can inline them.
+    /// </summary>
+    ///
+    /// <typeparam name="DataVectorType"> The data vector type. </typeparam>
+    /// <typeparam name="MetadataType"> The metadata type. </typeparam>
+    template <typename DataVectorType, typename MetadataType = WeightLabel>
+    using TypedDataset = Dataset<Example<DataVectorType, MetadataType>>;
+
+    /// <summary>
+    /// A typed dataset of any of the data vector types an AutoDataVector can hold, except that the sparse types
+    /// use the block index encoding, which is faster to read. The AutoDataVector alternative holds the datasets
+    /// that mix dense and sparse examples. Use std::visit with a generic lambda to get at the dataset.
+    /// </summary>
+    ///
+    /// <typeparam name="MetadataType"> The metadata type. </typeparam>
+    template <typename MetadataType = WeightLabel>
+    using AnyTypedDataset = std::variant<TypedDataset<AutoDataVector, MetadataType>,
+                                         TypedDataset<DoubleDataVector, MetadataType>,
+                                         TypedDataset<FloatDataVector, MetadataType>,
+                                         TypedDataset<ShortDataVector, MetadataType>,
+                                         TypedDataset<ByteDataVector, MetadataType>,
+                                         TypedDataset<BlockSparseDoubleDataVector, MetadataType>,
+                                         TypedDataset<BlockSparseFloatDataVector, MetadataType>,
+                                         TypedDataset<BlockSparseShortDataVector, MetadataType>,
+                                         TypedDataset<BlockSparseByteDataVector, MetadataType>,
+                                         TypedDataset<BlockSparseBinaryDataVector, MetadataType>>;
+
+    /// <summary>
+    /// Gets a data vector type that can hold all of the examples in a dataset: the widest of the types an
+    /// AutoDataVector chooses for the examples.
+    /// </summary>
+    ///
+    /// <param name="anyDataset"> The dataset. </param>
+    ///
+    /// <returns> The data vector type, or IDataVector::Type::AutoDataVector if the examples mix dense and
+    /// sparse types or the dataset is empty. </returns>
+    IDataVector::Type GetCommonDataVectorType(const AnyDataset& anyDataset);
+
+    /// <summary>
+    /// Copies a dataset into a typed dataset. The data vector type is the one GetCommonDataVectorType returns (with
+    /// block encoded indices for the sparse types), so the storage is as compact as the widest example of an
+    /// AutoSupervisedDataset.
+    /// </summary>
+    ///
+    /// <typeparam name="MetadataType"> The metadata type, which must be constructible from a WeightLabel. </typeparam>
+    /// <param name="anyDataset"> The dataset. </param>
+    ///
+    /// <returns> The typed dataset. </returns>
+    template <typename MetadataType = WeightLabel>
+    AnyTypedDataset<MetadataType> MakeTypedDataset(const AnyDataset& anyDataset);
+} // namespace data
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace data
+{
+    template <typename MetadataType>
+    AnyTypedDataset<MetadataType> MakeTypedDataset(const AnyDataset& anyDataset)
+    {
+        switch (GetCommonDataVectorType(anyDataset))
+        {
+        case IDataVector::Type::DoubleDataVector:
+            return TypedDataset<DoubleDataVector, MetadataType>(anyDataset);
+        case IDataVector::Type::FloatDataVector:
+            return TypedDataset<FloatDataVector, MetadataType>(anyDataset);
+        case IDataVector::Type::ShortDataVector:
+            return TypedDataset<ShortDataVector, MetadataType>(anyDataset);
+        case IDataVector::Type::ByteDataVector:
+            return TypedDataset<ByteDataVector, MetadataType>(anyDataset);
+        case IDataVector::Type::SparseDoubleDataVector:
+        case IDataVector::Type::BlockSparseDoubleDataVector:
+            return TypedDataset<BlockSparseDoubleDataVector, MetadataType>(anyDataset);
+        case IDataVector::Type::SparseFloatDataVector:
+        case IDataVector::Type::BlockSparseFloatDataVector:
+            return TypedDataset<BlockSparseFloatDataVector, MetadataType>(anyDataset);
+        case IDataVector::Type::SparseShortDataVector:
+        case IDataVector::Type::BlockSparseShortDataVector:
+            return TypedDataset<BlockSparseShortDataVector, MetadataType>(anyDataset);
+        case IDataVector::Type::SparseByteDataVector:
+        case IDataVector::Type::BlockSparseByteDataVector:
+            return TypedDataset<BlockSparseByteDataVector, MetadataType>(anyDataset);
+        case IDataVector::Type::SparseBinaryDataVector:
+        case IDataVector::Type::BlockSparseBinaryDataVector:
+            return TypedDataset<BlockSparseBinaryDataVector, MetadataType>(anyDataset);
+        default:
+            return TypedDataset<AutoDataVector, MetadataType>(anyDataset);
+        }
+    }
+} // namespace data
+} // namespace ell
+
+#pragma endregion implementation
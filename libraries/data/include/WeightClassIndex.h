@@ -10,6 +10,7 @@
 #include "TextLine.h"
 
 #include <utilities/include/CStringParser.h>
+#include <utilities/include/OutputBuffer.h>
 
 namespace ell
 {
@@ -30,6 +31,9 @@ namespace data
     /// <returns> The output stream. </returns>
     std::ostream& operator<<(std::ostream& os, const WeightClassIndex& weightClassIndex);
 
+    /// <summary> Adds the weight class index pair to an output buffer, in the same format. </summary>
+    utilities::OutputBuffer& operator<<(utilities::OutputBuffer& buffer, const WeightClassIndex& weightClassIndex);
+
     /// <summary> Class that parses a text line into a label </summary>
     struct ClassIndexParser
     {
@@ -12,6 +12,7 @@
 #include <ostream>
 
 #include <utilities/include/CStringParser.h>
+#include <utilities/include/OutputBuffer.h>
 
 namespace ell
 {
@@ -32,6 +33,9 @@ namespace data
     /// <returns> The output stream. </returns>
     std::ostream& operator<<(std::ostream& os, const WeightLabel& weightLabel);
 
+    /// <summary> Adds the weight label pair to an output buffer, in the same format. </summary>
+    utilities::OutputBuffer& operator<<(utilities::OutputBuffer& buffer, const WeightLabel& weightLabel);
+
     /// <summary> Class that parses a text line into a label </summary>
     struct LabelParser
     {
@@ -0,0 +1,268 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BinaryDataset.cpp (data)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "BinaryDataset.h"
+#include "AutoDataVector.h"
+#include "DenseDataVector.h"
+#include "SparseBinaryDataVector.h"
+#include "SparseDataVector.h"
+
+#include <utilities/include/CompressedIntegerList.h>
+#include <utilities/include/Exception.h>
+#include <utilities/include/OutputBuffer.h>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace ell
+{
+namespace data
+{
+    namespace
+    {
+        // File layout:
+        //   header:  magic (8 bytes), number of examples (uint64)
+        //   example: weight (double), label (double), IDataVector::Type (uint64), number of stored elements (uint64),
+        //            then, for sparse types, the largest index (uint64), the size of the encoded index list in bytes (uint64)
+        //            and the encoded index list, and, for all but SparseBinaryDataVector, the array of stored values.
+        // Arrays are padded to a multiple of 8 bytes.
+        const char c_magic[8] = { 'E', 'L', 'L', 'D', 'A', 'T', 'A', '1' };
+        const size_t c_alignment = 8;
+
+        // Every example is a multiple of 8 bytes long, so padding an example's buffer pads the file
+        template <typename ValueType>
+        void WriteValue(utilities::OutputBuffer& buffer, ValueType value)
+        {
+            buffer.Write(&value, sizeof(value));
+        }
+
+        template <typename ElementType>
+        void WriteArray(utilities::OutputBuffer& buffer, const ElementType* data, size_t size)
+        {
+            buffer.Write(data, size * sizeof(ElementType));
+            buffer.Pad(c_alignment);
+        }
+
+        template <typename ElementType>
+        void WriteDense(utilities::OutputBuffer& buffer, const AutoDataVector& vector)
+        {
+            auto values = vector.ToArray();
+            std::vector<ElementType> storedValues(values.begin(), values.end());
+            WriteValue<uint64_t>(buffer, storedValues.size());
+            WriteArray(buffer, storedValues.data(), storedValues.size());
+        }
+
+        void WriteIndexList(utilities::OutputBuffer& buffer, const utilities::CompressedIntegerList& indices)
+        {
+            WriteValue<uint64_t>(buffer, indices.Size());
+            WriteValue<uint64_t>(buffer, indices.Size() > 0 ? indices.Max() : 0);
+            const auto& encoded = indices.GetEncodedData();
+            WriteValue<uint64_t>(buffer, encoded.size());
+            WriteArray(buffer, encoded.data(), encoded.size());
+        }
+
+        template <typename ElementType>
+        void WriteSparse(utilities::OutputBuffer& buffer, const AutoDataVector& vector, bool writeValues)
+        {
+            utilities::CompressedIntegerList indices;
+            std::vector<ElementType> values;
+            auto sparseVector = vector.CopyAs<SparseDoubleDataVector>();
+            auto iterator = sparseVector.GetIterator<IterationPolicy::skipZeros>();
+            while (iterator.IsValid())
+            {
+                auto indexValue = iterator.Get();
+                indices.Append(indexValue.index);
+                values.push_back(static_cast<ElementType>(indexValue.value));
+                iterator.Next();
+            }
+
+            WriteIndexList(buffer, indices);
+            if (writeValues)
+            {
+                WriteArray(buffer, values.data(), values.size());
+            }
+        }
+
+        // Reads from a block of memory, checking that it doesn't go past the end
+        class Reader
+        {
+        public:
+            Reader(const char* begin, const char* end) :
+                _current(begin),
+                _end(end) {}
+
+            template <typename ValueType>
+            ValueType ReadValue()
+            {
+                ValueType value;
+                std::memcpy(&value, Advance(sizeof(ValueType)), sizeof(ValueType));
+                return value;
+            }
+
+            template <typename ElementType>
+            const ElementType* ReadArray(uint64_t size)
+            {
+                // Checked before multiplying, so that a corrupt count can't wrap around to a small number of bytes
+                if (size > std::numeric_limits<size_t>::max() / sizeof(ElementType))
+                {
+                    throw utilities::InputException(utilities::InputExceptionErrors::badData, "binary dataset has an invalid array size");
+                }
+                auto result = reinterpret_cast<const ElementType*>(Advance(size * sizeof(ElementType)));
+                Advance((c_alignment - (size * sizeof(ElementType)) % c_alignment) % c_alignment);
+                return result;
+            }
+
+        private:
+            const char* Advance(size_t size)
+            {
+                if (static_cast<size_t>(_end - _current) < size)
+                {
+                    throw utilities::InputException(utilities::InputExceptionErrors::badData, "binary dataset is truncated");
+                }
+                auto result = _current;
+                _current += size;
+                return result;
+            }
+
+            const char* _current;
+            const char* _end;
+        };
+
+        template <typename ElementType>
+        std::unique_ptr<IDataVector> ReadDense(Reader& reader)
+        {
+            auto size = reader.ReadValue<uint64_t>();
+            auto values = reader.ReadArray<ElementType>(size);
+            return std::make_unique<DenseDataVector<ElementType>>(values, values + size);
+        }
+
+        utilities::CompressedIntegerList ReadIndexList(Reader& reader)
+        {
+            auto size = reader.ReadValue<uint64_t>();
+            auto max = reader.ReadValue<uint64_t>();
+            auto numBytes = reader.ReadValue<uint64_t>();
+            auto encoded = reader.ReadArray<uint8_t>(numBytes);
+            return utilities::CompressedIntegerList(encoded, encoded + numBytes, size, max);
+        }
+
+        template <typename ElementType>
+        std::unique_ptr<IDataVector> ReadSparse(Reader& reader)
+        {
+            auto indices = ReadIndexList(reader);
+            auto size = indices.Size();
+            auto values = reader.ReadArray<ElementType>(size);
+            return std::make_unique<SparseDataVector<ElementType, utilities::CompressedIntegerList>>(std::move(indices), std::vector<ElementType>(values, values + size));
+        }
+
+        std::unique_ptr<IDataVector> ReadDataVector(Reader& reader, IDataVector::Type type)
+        {
+            switch (type)
+            {
+            case IDataVector::Type::DoubleDataVector:
+                return ReadDense<double>(reader);
+            case IDataVector::Type::FloatDataVector:
+                return ReadDense<float>(reader);
+            case IDataVector::Type::ShortDataVector:
+                return ReadDense<short>(reader);
+            case IDataVector::Type::ByteDataVector:
+                return ReadDense<char>(reader);
+            case IDataVector::Type::SparseDoubleDataVector:
+                return ReadSparse<double>(reader);
+            case IDataVector::Type::SparseFloatDataVector:
+                return ReadSparse<float>(reader);
+            case IDataVector::Type::SparseShortDataVector:
+                return ReadSparse<short>(reader);
+            case IDataVector::Type::SparseByteDataVector:
+                return ReadSparse<char>(reader);
+            case IDataVector::Type::SparseBinaryDataVector:
+                return std::make_unique<SparseBinaryDataVector>(ReadIndexList(reader));
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::badData, "unknown data vector type in binary dataset");
+            }
+        }
+    } // namespace
+
+    void WriteBinaryDataset(const AutoSupervisedDataset& dataset, std::ostream& stream, size_t numThreads)
+    {
+        utilities::OutputBuffer header;
+        header.Write(c_magic, sizeof(c_magic));
+        WriteValue<uint64_t>(header, dataset.NumExamples());
+        header.WriteTo(stream);
+
+        utilities::WriteInParallel(dataset.NumExamples(), stream, numThreads, [&dataset](size_t i, utilities::OutputBuffer& buffer) {
+            const auto& example = dataset[i];
+            const auto& vector = example.GetDataVector();
+            auto type = vector.GetInternalType();
+
+            WriteValue<double>(buffer, example.GetMetadata().weight);
+            WriteValue<double>(buffer, example.GetMetadata().label);
+            WriteValue<uint64_t>(buffer, static_cast<uint64_t>(type));
+            switch (type)
+            {
+            case IDataVector::Type::DoubleDataVector:
+                WriteDense<double>(buffer, vector);
+                break;
+            case IDataVector::Type::FloatDataVector:
+                WriteDense<float>(buffer, vector);
+                break;
+            case IDataVector::Type::ShortDataVector:
+                WriteDense<short>(buffer, vector);
+                break;
+            case IDataVector::Type::ByteDataVector:
+                WriteDense<char>(buffer, vector);
+                break;
+            case IDataVector::Type::SparseDoubleDataVector:
+                WriteSparse<double>(buffer, vector, true);
+                break;
+            case IDataVector::Type::SparseFloatDataVector:
+                WriteSparse<float>(buffer, vector, true);
+                break;
+            case IDataVector::Type::SparseShortDataVector:
+                WriteSparse<short>(buffer, vector, true);
+                break;
+            case IDataVector::Type::SparseByteDataVector:
+                WriteSparse<char>(buffer, vector, true);
+                break;
+            case IDataVector::Type::SparseBinaryDataVector:
+                WriteSparse<char>(buffer, vector, false);
+                break;
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "unexpected data vector type");
+            }
+        });
+    }
+
+    AutoSupervisedDataset ReadBinaryDataset(const char* begin, const char* end)
+    {
+        if (!IsBinaryDataset(begin, end))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::badData, "not a binary dataset");
+        }
+
+        Reader reader(begin + sizeof(c_magic), end);
+        auto numExamples = reader.ReadValue<uint64_t>();
+        AutoSupervisedDataset dataset;
+        for (uint64_t i = 0; i < numExamples; ++i)
+        {
+            auto weight = reader.ReadValue<double>();
+            auto label = reader.ReadValue<double>();
+            auto type = static_cast<IDataVector::Type>(reader.ReadValue<uint64_t>());
+            dataset.AddExample(AutoDataVector(ReadDataVector(reader, type)), WeightLabel{ weight, label });
+        }
+        return dataset;
+    }
+
+    bool IsBinaryDataset(const char* begin, const char* end)
+    {
+        return static_cast<size_t>(end - begin) >= sizeof(c_magic) && std::memcmp(begin, c_magic, sizeof(c_magic)) == 0;
+    }
+} // namespace data
+} // namespace ell
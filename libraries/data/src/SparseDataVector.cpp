@@ -39,5 +39,33 @@ namespace data
     {
         return IDataVector::Type::SparseByteDataVector;
     }
+
+    // block float specialization
+    template <>
+    IDataVector::Type SparseDataVector<float, ell::utilities::BlockCompressedIntegerList>::GetStaticType()
+    {
+        return IDataVector::Type::BlockSparseFloatDataVector;
+    }
+
+    // block double specialization
+    template <>
+    IDataVector::Type SparseDataVector<double, ell::utilities::BlockCompressedIntegerList>::GetStaticType()
+    {
+        return IDataVector::Type::BlockSparseDoubleDataVector;
+    }
+
+    // block short specialization
+    template <>
+    IDataVector::Type SparseDataVector<short, ell::utilities::BlockCompressedIntegerList>::GetStaticType()
+    {
+        return IDataVector::Type::BlockSparseShortDataVector;
+    }
+
+    // block byte specialization
+    template <>
+    IDataVector::Type SparseDataVector<char, ell::utilities::BlockCompressedIntegerList>::GetStaticType()
+    {
+        return IDataVector::Type::BlockSparseByteDataVector;
+    }
 } // namespace data
-} // namespace ell
\ No newline at end of file
+} // namespace ell
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     TypedDataset.cpp (data)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "TypedDataset.h"
+
+namespace ell
+{
+namespace data
+{
+    namespace
+    {
+        bool IsDense(IDataVector::Type type)
+        {
+            return type == IDataVector::Type::DoubleDataVector || type == IDataVector::Type::FloatDataVector || type == IDataVector::Type::ShortDataVector || type == IDataVector::Type::ByteDataVector;
+        }
+
+        // orders the types of a family (dense or sparse) so that each one can hold the values of the ones before it
+        int GetWidth(IDataVector::Type type)
+        {
+            switch (type)
+            {
+            case IDataVector::Type::ByteDataVector:
+            case IDataVector::Type::SparseBinaryDataVector:
+            case IDataVector::Type::BlockSparseBinaryDataVector:
+                return 0;
+            case IDataVector::Type::ShortDataVector:
+            case IDataVector::Type::SparseByteDataVector:
+            case IDataVector::Type::BlockSparseByteDataVector:
+                return 1;
+            case IDataVector::Type::FloatDataVector:
+            case IDataVector::Type::SparseShortDataVector:
+            case IDataVector::Type::BlockSparseShortDataVector:
+                return 2;
+            case IDataVector::Type::DoubleDataVector:
+            case IDataVector::Type::SparseFloatDataVector:
+            case IDataVector::Type::BlockSparseFloatDataVector:
+                return 3;
+            default:
+                return 4;
+            }
+        }
+
+        IDataVector::Type GetCommonType(IDataVector::Type type1, IDataVector::Type type2)
+        {
+            if (type1 == IDataVector::Type::AutoDataVector || type2 == IDataVector::Type::AutoDataVector || IsDense(type1) != IsDense(type2))
+            {
+                return IDataVector::Type::AutoDataVector;
+            }
+            return GetWidth(type1) >= GetWidth(type2) ? type1 : type2;
+        }
+    } // namespace
+
+    IDataVector::Type GetCommonDataVectorType(const AnyDataset& anyDataset)
+    {
+        // examples of an AutoSupervisedDataset are shallow copies, and other datasets are converted
+        // with the same type selection they'd get when loaded
+        auto exampleIterator = anyDataset.GetExampleIterator<AutoSupervisedExample>();
+        if (!exampleIterator.IsValid())
+        {
+            return IDataVector::Type::AutoDataVector;
+        }
+
+        // AutoDataVector chooses the type of each example on its own, so the examples are widened to a common type
+        auto type = exampleIterator.Get().GetDataVector().GetInternalType();
+        exampleIterator.Next();
+        while (exampleIterator.IsValid() && type != IDataVector::Type::AutoDataVector)
+        {
+            type = GetCommonType(type, exampleIterator.Get().GetDataVector().GetInternalType());
+            exampleIterator.Next();
+        }
+        return type;
+    }
+} // namespace data
+} // namespace ell
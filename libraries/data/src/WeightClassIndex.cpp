@@ -22,6 +22,11 @@ namespace data
         return os;
     }
 
+    utilities::OutputBuffer& operator<<(utilities::OutputBuffer& buffer, const WeightClassIndex& weightClassIndex)
+    {
+        return buffer << '(' << weightClassIndex.weight << ", " << weightClassIndex.classIndex << ')';
+    }
+
     WeightClassIndex ClassIndexParser::Parse(TextLine& textLine)
     {
         size_t classIndex = 0;
@@ -22,6 +22,11 @@ namespace data
         return os;
     }
 
+    utilities::OutputBuffer& operator<<(utilities::OutputBuffer& buffer, const WeightLabel& weightLabel)
+    {
+        return buffer << '(' << weightLabel.weight << ", " << weightLabel.label << ')';
+    }
+
     WeightLabel LabelParser::Parse(TextLine& textLine)
     {
         double label = 0.0;
@@ -12,4 +12,12 @@ namespace ell
 {
 void DatasetCastingTests();
 void DatasetSerializationTests();
+void StreamingDatasetTests();
+void PrefetchingExampleIteratorTests();
+void BinaryDatasetTest();
+void TextDatasetWriterTest();
+void TypedDatasetTests();
+void DatasetArenaTests();
+void DatasetIndexPermutationTests();
+void DatasetParallelTransformTests();
 } // namespace ell
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include <algorithm> // for std::transform
 #include <cmath>
 #include <iostream>
+#include <random>
 #include <sstream>
 #include <string>
 
@@ -91,6 +92,10 @@ void IDataVectorTests()
     IDataVectorTest<data::SparseFloatDataVector>();
     IDataVectorTest<data::SparseShortDataVector>();
     IDataVectorTest<data::SparseByteDataVector>();
+    IDataVectorTest<data::BlockSparseDoubleDataVector>();
+    IDataVectorTest<data::BlockSparseFloatDataVector>();
+    IDataVectorTest<data::BlockSparseShortDataVector>();
+    IDataVectorTest<data::BlockSparseByteDataVector>();
     IDataVectorTest<data::AutoDataVector>();
 
     IDataVectorBinaryTest<data::DoubleDataVector>();
@@ -101,8 +106,13 @@ void IDataVectorTests()
     IDataVectorBinaryTest<data::SparseFloatDataVector>();
     IDataVectorBinaryTest<data::SparseShortDataVector>();
     IDataVectorBinaryTest<data::SparseByteDataVector>();
+    IDataVectorBinaryTest<data::BlockSparseDoubleDataVector>();
+    IDataVectorBinaryTest<data::BlockSparseFloatDataVector>();
+    IDataVectorBinaryTest<data::BlockSparseShortDataVector>();
+    IDataVectorBinaryTest<data::BlockSparseByteDataVector>();
     IDataVectorBinaryTest<data::AutoDataVector>();
     IDataVectorBinaryTest<data::SparseBinaryDataVector>();
+    IDataVectorBinaryTest<data::BlockSparseBinaryDataVector>();
 }
 
 template <typename DataVectorType1, typename DataVectorType2>
@@ -158,6 +168,9 @@ void DataVectorCopyAsTestDispatch(InitType maxType)
     DataVectorCopyAsTest<DataVectorType, data::SparseShortDataVector>(integeralInit);
     DataVectorCopyAsTest<DataVectorType, data::SparseByteDataVector>(integeralInit);
     DataVectorCopyAsTest<DataVectorType, data::SparseBinaryDataVector>(binaryInit, false);
+    DataVectorCopyAsTest<DataVectorType, data::BlockSparseDoubleDataVector>(fractionalInit);
+    DataVectorCopyAsTest<DataVectorType, data::BlockSparseByteDataVector>(integeralInit);
+    DataVectorCopyAsTest<DataVectorType, data::BlockSparseBinaryDataVector>(binaryInit, false);
 }
 
 void DataVectorCopyAsTests()
@@ -172,6 +185,11 @@ void DataVectorCopyAsTests()
     DataVectorCopyAsTestDispatch<data::SparseShortDataVector>(InitType::integral);
     DataVectorCopyAsTestDispatch<data::SparseByteDataVector>(InitType::integral);
     DataVectorCopyAsTestDispatch<data::SparseBinaryDataVector>(InitType::binary);
+    DataVectorCopyAsTestDispatch<data::BlockSparseDoubleDataVector>(InitType::fractional);
+    DataVectorCopyAsTestDispatch<data::BlockSparseFloatDataVector>(InitType::fractional);
+    DataVectorCopyAsTestDispatch<data::BlockSparseShortDataVector>(InitType::integral);
+    DataVectorCopyAsTestDispatch<data::BlockSparseByteDataVector>(InitType::integral);
+    DataVectorCopyAsTestDispatch<data::BlockSparseBinaryDataVector>(InitType::binary);
 }
 
 void AutoDataVectorTest()
@@ -265,5 +283,102 @@ void IteratorTests()
     IteratorTest<data::SparseShortDataVector>();
     IteratorTest<data::SparseByteDataVector>();
     IteratorTest<data::SparseBinaryDataVector>();
+    IteratorTest<data::BlockSparseDoubleDataVector>();
+    IteratorTest<data::BlockSparseBinaryDataVector>();
+}
+
+void BlockSparseDataVectorTest()
+{
+    // gaps between the indices take 1, 2 or 3 bytes to encode, so that groups take from 4 to 12 bytes
+    std::default_random_engine engine(123);
+    std::uniform_int_distribution<int> lengthDistribution(0, 99);
+    std::normal_distribution<double> valueDistribution;
+    auto getGap = [&](bool allowHuge) -> size_t {
+        auto length = lengthDistribution(engine);
+        if (length < 80)
+        {
+            return std::uniform_int_distribution<size_t>(1, 255)(engine);
+        }
+        if (length < 95)
+        {
+            return std::uniform_int_distribution<size_t>(256, 5000)(engine);
+        }
+        if (length < 98 || !allowHuge)
+        {
+            return std::uniform_int_distribution<size_t>(65536, 70000)(engine);
+        }
+        return std::uniform_int_distribution<size_t>(size_t(1) << 24, (size_t(1) << 24) + 1000)(engine);
+    };
+
+    std::vector<data::IndexValue> elements;
+    size_t index = 0;
+    for (size_t i = 0; i < 1001; ++i)
+    {
+        index += getGap(false);
+        elements.push_back({ index, valueDistribution(engine) });
+    }
+
+    data::SparseDoubleDataVector sparseVector(elements);
+    data::BlockSparseDoubleDataVector blockVector(elements);
+    auto sparseBinaryVector = sparseVector.TransformAs<data::IterationPolicy::skipZeros, data::SparseBinaryDataVector>([](data::IndexValue) { return 1.0; });
+    auto blockBinaryVector = sparseVector.TransformAs<data::IterationPolicy::skipZeros, data::BlockSparseBinaryDataVector>([](data::IndexValue) { return 1.0; });
+
+    // the vectors are shorter than the data vectors, to test the end of the dot product
+    math::RowVector<double> w(index - 10);
+    math::RowVector<float> wFloat(w.Size());
+    for (size_t i = 0; i < w.Size(); ++i)
+    {
+        w[i] = std::sin(static_cast<double>(i));
+        wFloat[i] = static_cast<float>(w[i]);
+    }
+
+    double expectedDot = 0;
+    float expectedFloatDot = 0;
+    double expectedBinaryDot = 0;
+    for (const auto& element : elements)
+    {
+        if (element.index < w.Size())
+        {
+            expectedDot += element.value * w[element.index];
+            expectedFloatDot += static_cast<float>(element.value) * wFloat[element.index];
+            expectedBinaryDot += w[element.index];
+        }
+    }
+
+    bool dotOk = testing::IsEqual(sparseVector.Dot(w), expectedDot) && testing::IsEqual(blockVector.Dot(w), expectedDot) && testing::IsEqual(blockVector.Dot(wFloat), expectedFloatDot);
+    bool binaryDotOk = testing::IsEqual(sparseBinaryVector.Dot(w), expectedBinaryDot) && testing::IsEqual(blockBinaryVector.Dot(w), expectedBinaryDot);
+
+    math::RowVector<double> sum1(w.Size());
+    math::RowVector<double> sum2(w.Size());
+    sparseVector.AddTo(sum1);
+    blockVector.AddTo(sum2);
+    sparseBinaryVector.AddTo(sum1);
+    blockBinaryVector.AddTo(sum2);
+
+    // an index list with gaps of every encoded length, read in chunks of different sizes mixed with single steps
+    std::vector<size_t> expectedIndices;
+    utilities::BlockCompressedIntegerList indexList;
+    index = 0;
+    for (size_t i = 0; i < 1001; ++i)
+    {
+        index += getGap(true);
+        expectedIndices.push_back(index);
+        indexList.Append(index);
+    }
+
+    std::vector<size_t> indices;
+    auto indexIterator = indexList.GetIterator();
+    size_t chunk[11];
+    while (indexIterator.IsValid())
+    {
+        indices.push_back(indexIterator.Get());
+        indexIterator.Next();
+        auto count = indexIterator.Read(chunk, indices.size() % 11 + 1);
+        indices.insert(indices.end(), chunk, chunk + count);
+    }
+
+    testing::ProcessTest("BlockSparseDataVector::Dot", dotOk && binaryDotOk);
+    testing::ProcessTest("BlockSparseDataVector::AddTo", sum1 == sum2);
+    testing::ProcessTest("BlockCompressedIntegerList::Iterator::Read", indices == expectedIndices);
 }
 } // namespace ell
\ No newline at end of file
@@ -10,14 +10,27 @@
 
 #include <common/include/DataLoaders.h>
 
+#include <data/include/BinaryDataset.h>
 #include <data/include/Dataset.h>
+#include <data/include/GeneralizedSparseParsingIterator.h>
+#include <data/include/PrefetchingExampleIterator.h>
+#include <data/include/SequentialLineIterator.h>
+#include <data/include/StreamingDataset.h>
+#include <data/include/TypedDataset.h>
 
 #include <utilities/include/Files.h>
+#include <utilities/include/MemoryMappedFile.h>
 #include <utilities/include/StringUtil.h>
 
 #include <testing/include/testing.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <random>
 #include <sstream>
+#include <vector>
 
 namespace ell
 {
@@ -119,4 +132,386 @@ void DatasetSerializationTests()
     }
     testing::ProcessTest(utilities::FormatString("DatasetSerializationTest data %d errors", errors), errors == 0);
 }
+
+template <typename IteratorType>
+std::vector<double> GetLabels(IteratorType exampleIterator)
+{
+    std::vector<double> labels;
+    while (exampleIterator.IsValid())
+    {
+        labels.push_back(exampleIterator.Get().GetMetadata().label);
+        exampleIterator.Next();
+    }
+    return labels;
+}
+
+void StreamingDatasetTests()
+{
+    // each example's label is its position in the shards
+    const std::vector<std::string> filenames = { "streamingShard1.txt", "streamingShard2.txt" };
+    {
+        auto stream = utilities::OpenOfstream(filenames[0]);
+        stream << "0\t1 2\n// comment\n1\t3 4\n\n2\t5 6\n3\t7 8\n";
+    }
+    {
+        auto stream = utilities::OpenOfstream(filenames[1]);
+        stream << "4\t1\n5\t2\n   \n6\t3\n";
+    }
+
+    auto dataset = common::GetStreamingDataset(filenames, 3);
+    testing::ProcessTest("StreamingDataset::NumExamples", dataset.NumExamples() == 7);
+    testing::ProcessTest("StreamingDataset::NumChunks", dataset.NumChunks() == 3);
+
+    auto labels = GetLabels(dataset.GetExampleIterator());
+    testing::ProcessTest("StreamingDataset::GetExampleIterator", testing::IsEqual(labels, std::vector<double>{ 0, 1, 2, 3, 4, 5, 6 }));
+
+    labels = GetLabels(dataset.GetExampleIterator(2, 3));
+    testing::ProcessTest("StreamingDataset::GetExampleIterator range", testing::IsEqual(labels, std::vector<double>{ 2, 3, 4 }));
+
+    auto chunk = dataset.LoadChunk(1);
+    testing::ProcessTest("StreamingDataset::LoadChunk", chunk.NumExamples() == 1 && chunk[0].GetMetadata().label == 3 && dataset.GetChunkFirstExampleIndex(1) == 3);
+
+    // a shuffled epoch visits every example once, and keeps the examples of each chunk together
+    std::default_random_engine rng(1234);
+    labels = GetLabels(dataset.GetShuffledExampleIterator(rng));
+    auto sortedLabels = labels;
+    std::sort(sortedLabels.begin(), sortedLabels.end());
+    bool chunksAreContiguous = labels.size() == 7;
+    for (size_t i = 1; chunksAreContiguous && i < labels.size(); ++i)
+    {
+        // once a chunk ({0, 1, 2}, {3} or {4, 5, 6}) is left, none of its examples come up again
+        auto chunkOf = [](double label) { return label < 3 ? 0 : (label < 4 ? 1 : 2); };
+        if (chunkOf(labels[i]) != chunkOf(labels[i - 1]))
+        {
+            chunksAreContiguous = std::none_of(labels.begin() + i, labels.end(), [&](double label) { return chunkOf(label) == chunkOf(labels[i - 1]); });
+        }
+    }
+    testing::ProcessTest("StreamingDataset::GetShuffledExampleIterator", testing::IsEqual(sortedLabels, std::vector<double>{ 0, 1, 2, 3, 4, 5, 6 }) && chunksAreContiguous);
+
+    // AnyDataset refers to the whole streaming dataset, and can still be loaded into memory
+    auto anyDataset = dataset.GetAnyDataset();
+    data::AutoSupervisedDataset inMemory(anyDataset);
+    testing::ProcessTest("StreamingDataset::GetAnyDataset", anyDataset.GetStreamingDataset<data::AutoSupervisedExample>() == &dataset && inMemory.NumExamples() == 7);
+    testing::ProcessTest("StreamingDataset::GetAnyDataset range", dataset.GetAnyDataset(1, 2).GetStreamingDataset<data::AutoSupervisedExample>() == nullptr);
+}
+
+namespace
+{
+    // an iterator over examples labeled 0, 1, ..., that throws when it reaches a given example
+    class ThrowingExampleIterator : public data::IExampleIterator<data::AutoSupervisedExample>
+    {
+    public:
+        ThrowingExampleIterator(size_t throwAt) :
+            _throwAt(throwAt) {}
+
+        bool IsValid() const override { return true; }
+
+        void Next() override
+        {
+            if (++_current == _throwAt)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::badData, "bad example");
+            }
+        }
+
+        data::AutoSupervisedExample Get() const override
+        {
+            return data::AutoSupervisedExample(std::make_shared<data::AutoDataVector>(data::DoubleDataVector{ 1.0 }), data::WeightLabel{ 1, static_cast<double>(_current) });
+        }
+
+    private:
+        size_t _current = 0;
+        size_t _throwAt;
+    };
+} // namespace
+
+void PrefetchingExampleIteratorTests()
+{
+    std::stringstream stream;
+    for (int i = 0; i < 100; ++i)
+    {
+        stream << i << "\t" << i << ":1\n";
+        if (i % 10 == 0)
+        {
+            stream << "// comment\n";
+        }
+    }
+
+    std::vector<double> expectedLabels(100);
+    std::iota(expectedLabels.begin(), expectedLabels.end(), 0.0);
+    auto labels = GetLabels(common::GetPrefetchingExampleIterator<data::SequentialLineIterator, data::LabelParser, data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>>(stream, 7, 2));
+    testing::ProcessTest("PrefetchingExampleIterator", testing::IsEqual(labels, expectedLabels));
+
+    // the examples read before an exception are returned before it is rethrown
+    std::vector<double> labelsBeforeException;
+    bool threw = false;
+    try
+    {
+        auto iterator = data::MakePrefetchingExampleIterator(data::AutoSupervisedExampleIterator(std::make_unique<ThrowingExampleIterator>(10)), 4, 1);
+        while (iterator.IsValid())
+        {
+            labelsBeforeException.push_back(iterator.Get().GetMetadata().label);
+            iterator.Next();
+        }
+    }
+    catch (const utilities::InputException&)
+    {
+        threw = true;
+    }
+    testing::ProcessTest("PrefetchingExampleIterator exception", threw && testing::IsEqual(labelsBeforeException, std::vector<double>(expectedLabels.begin(), expectedLabels.begin() + 10)));
+
+    // an iterator destroyed before it is used up stops its background thread
+    {
+        auto iterator = data::MakePrefetchingExampleIterator(data::AutoSupervisedExampleIterator(std::make_unique<ThrowingExampleIterator>(1000000)), 4, 1);
+        iterator.Next();
+    }
+    testing::ProcessTest("PrefetchingExampleIterator early destruction", true);
+}
+
+void BinaryDatasetTest()
+{
+    // one example of each data vector representation
+    data::AutoSupervisedDataset dataset1;
+    dataset1.AddExample(data::AutoSupervisedExample(data::AutoDataVector{ 0.5, 3.25, 0, 1.5 }, data::WeightLabel{ 1, 1 }));
+    dataset1.AddExample(data::AutoSupervisedExample(data::AutoDataVector{ 1.5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2 }, data::WeightLabel{ 2, -1 }));
+    dataset1.AddExample(data::AutoSupervisedExample(data::AutoDataVector{ 1, 2, 3 }, data::WeightLabel{ 1, 1 }));
+    dataset1.AddExample(data::AutoSupervisedExample(data::AutoDataVector{ 300, -200 }, data::WeightLabel{ 1, -1 }));
+    dataset1.AddExample(data::AutoSupervisedExample(data::AutoDataVector(std::make_unique<data::SparseBinaryDataVector>(std::vector<double>{ 0, 1, 0, 0, 1, 1 })), data::WeightLabel{ 0.5, 1 }));
+    dataset1.AddExample(data::AutoSupervisedExample(data::AutoDataVector(std::make_unique<data::SparseFloatDataVector>(std::vector<double>{ 0, 0, 0.25, 0, 0, 0, 0, 0, 0, 0, 3 })), data::WeightLabel{ 1, 1 }));
+    dataset1.AddExample(data::AutoSupervisedExample(data::AutoDataVector(std::vector<double>{}), data::WeightLabel{ 1, -1 }));
+
+    const std::string filename("dataset1.elldata");
+    common::SaveBinaryDataset(dataset1, filename);
+    auto dataset2 = common::LoadDataset(filename);
+
+    bool isSame = dataset1.NumExamples() == dataset2.NumExamples() && dataset1.NumFeatures() == dataset2.NumFeatures();
+    for (size_t i = 0; isSame && i < dataset1.NumExamples(); ++i)
+    {
+        const auto& e1 = dataset1[i];
+        const auto& e2 = dataset2[i];
+        isSame = e1.GetDataVector().GetInternalType() == e2.GetDataVector().GetInternalType() &&
+                 testing::IsEqual(e1.GetDataVector().ToArray(), e2.GetDataVector().ToArray()) &&
+                 e1.GetMetadata().label == e2.GetMetadata().label && e1.GetMetadata().weight == e2.GetMetadata().weight;
+    }
+    testing::ProcessTest("BinaryDatasetTest round trip", isSame);
+
+    utilities::MemoryMappedFile file(filename);
+    bool threwOnTruncated = false;
+    try
+    {
+        data::ReadBinaryDataset(file.begin(), file.end() - 3);
+    }
+    catch (const utilities::InputException&)
+    {
+        threwOnTruncated = true;
+    }
+    testing::ProcessTest("BinaryDatasetTest truncated file", threwOnTruncated);
+
+    // An element count whose size in bytes wraps around to a few bytes must be rejected, not read
+    std::stringstream malformedStream;
+    data::WriteBinaryDataset(dataset1, malformedStream, 1);
+    auto malformed = malformedStream.str();
+    const size_t countOffset = 8 + 8 + 3 * 8; // header, then the first example's weight, label and type
+    const uint64_t badCount = (uint64_t{ 1 } << 62) + 1;
+    std::memcpy(&malformed[countOffset], &badCount, sizeof(badCount));
+    bool threwOnMalformed = false;
+    try
+    {
+        data::ReadBinaryDataset(malformed.data(), malformed.data() + malformed.size());
+    }
+    catch (const utilities::InputException&)
+    {
+        threwOnMalformed = true;
+    }
+    testing::ProcessTest("BinaryDatasetTest malformed array size", threwOnMalformed);
+
+    std::stringstream oneThread, fourThreads;
+    data::WriteBinaryDataset(dataset1, oneThread, 1);
+    data::WriteBinaryDataset(dataset1, fourThreads, 4);
+    testing::ProcessTest("BinaryDatasetTest same file on 1 and 4 threads", oneThread.str() == fourThreads.str());
+}
+
+void TextDatasetWriterTest()
+{
+    // enough examples for several blocks, with values that print differently with 6 significant digits
+    std::default_random_engine random(19);
+    std::uniform_real_distribution<double> distribution(-1000, 1000);
+    data::AutoSupervisedDataset dataset1;
+    for (size_t i = 0; i < 5000; ++i)
+    {
+        std::vector<double> values(20, 0.0);
+        for (size_t j = i % 3; j < values.size(); j += 3)
+        {
+            // the float vectors only accept values that are exactly floats
+            values[j] = (i % 2 == 0) ? static_cast<float>(distribution(random)) : distribution(random);
+        }
+        auto dataVector = (i % 2 == 0) ? data::AutoDataVector(std::make_unique<data::FloatDataVector>(values)) : data::AutoDataVector(std::make_unique<data::SparseDoubleDataVector>(values));
+        dataset1.AddExample(data::AutoSupervisedExample(std::move(dataVector), data::WeightLabel{ 1, distribution(random) }));
+    }
+
+    std::stringstream printed, written;
+    dataset1.Print(printed);
+    data::WriteTextDataset(dataset1, written, 4);
+    testing::ProcessTest("TextDatasetWriterTest, same text as Print", printed.str() == written.str());
+
+    std::stringstream floatStream;
+    data::AutoDataVector(std::make_unique<data::FloatDataVector>(std::vector<double>{ 0.1f, 0, 2.5f })).Print(floatStream);
+    testing::ProcessTest("TextDatasetWriterTest, floats print in their shortest form", floatStream.str() == "0:0.1\t2:2.5");
+
+    auto dataset2 = common::GetDataset(written);
+    // the float vectors read back as the same floats, and the double vectors as the same doubles
+    bool isSame = dataset1.NumExamples() == dataset2.NumExamples();
+    for (size_t i = 0; isSame && i < dataset1.NumExamples(); ++i)
+    {
+        auto values1 = dataset1[i].GetDataVector().ToArray();
+        auto values2 = dataset2[i].GetDataVector().ToArray(values1.size());
+        for (size_t j = 0; j < values1.size(); ++j)
+        {
+            isSame &= (i % 2 == 0) ? static_cast<float>(values1[j]) == static_cast<float>(values2[j]) : values1[j] == values2[j];
+        }
+        isSame &= dataset1[i].GetMetadata().label == dataset2[i].GetMetadata().label;
+    }
+    testing::ProcessTest("TextDatasetWriterTest, round trip is exact", isSame);
+}
+
+void TypedDatasetTests()
+{
+    auto makeExample = [](std::initializer_list<double> values) {
+        return data::AutoSupervisedExample(std::make_shared<data::AutoDataVector>(values), data::WeightLabel{ 1, 1 });
+    };
+
+    // a byte vector and a float vector are widened to float
+    data::AutoSupervisedDataset denseDataset;
+    denseDataset.AddExample(makeExample({ 1, 0, 2, 3 }));
+    denseDataset.AddExample(makeExample({ 0.5, 1, 2 }));
+    auto denseType = data::GetCommonDataVectorType(denseDataset.GetAnyDataset());
+    auto typedDenseDataset = data::MakeTypedDataset(denseDataset.GetAnyDataset());
+    auto pFloatDataset = std::get_if<data::TypedDataset<data::FloatDataVector>>(&typedDenseDataset);
+
+    std::stringstream ss1, ss2;
+    denseDataset.Print(ss1);
+    if (pFloatDataset != nullptr)
+    {
+        pFloatDataset->Print(ss2);
+    }
+    testing::ProcessTest("TypedDataset with dense examples", denseType == data::IDataVector::Type::FloatDataVector && pFloatDataset != nullptr && ss1.str() == ss2.str());
+
+    // dense and sparse examples can't share a type
+    data::AutoSupervisedDataset mixedDataset;
+    mixedDataset.AddExample(makeExample({ 1, 0, 2, 3 }));
+    mixedDataset.AddExample(makeExample({ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 }));
+    auto typedMixedDataset = data::MakeTypedDataset(mixedDataset.GetAnyDataset());
+    testing::ProcessTest("TypedDataset with dense and sparse examples", std::holds_alternative<data::TypedDataset<data::AutoDataVector>>(typedMixedDataset) && std::visit([](const auto& dataset) { return dataset.NumExamples(); }, typedMixedDataset) == 2);
+}
+
+void DatasetArenaTests()
+{
+    // examples added with a data vector and metadata live in the dataset's arena
+    data::AutoSupervisedDataset dataset;
+    for (size_t i = 0; i < 100; ++i)
+    {
+        auto value = static_cast<double>(i);
+        dataset.AddExample(data::AutoDataVector{ value, 0, value + 1 }, data::WeightLabel{ 1, value });
+    }
+    bool examplesOk = dataset.NumExamples() == 100 && dataset.NumFeatures() == 3;
+    for (size_t i = 0; i < dataset.NumExamples(); ++i)
+    {
+        auto value = static_cast<double>(i);
+        examplesOk = examplesOk && testing::IsEqual(dataset[i].GetDataVector().ToArray(), { value, 0, value + 1 }) && dataset[i].GetMetadata().label == value;
+    }
+    testing::ProcessTest("Dataset::AddExample in arena", examplesOk);
+
+    // data vectors shared with another example outlive the dataset
+    auto sharedExample = dataset[10];
+    dataset.Reset();
+    testing::ProcessTest("Dataset::Reset with shared arena example", testing::IsEqual(sharedExample.GetDataVector().ToArray(), { 10, 0, 11 }));
+
+    dataset.AddExample(data::AutoDataVector{ 1, 2, 3 }, data::WeightLabel{ 1, 1 });
+    dataset.AddExample(data::AutoDataVector{ 0, 0, 0, 0, 5 }, data::WeightLabel{ 1, -1 });
+    auto transformedDataset = dataset.Transform<data::DenseSupervisedExample>([](const data::AutoSupervisedExample& example) {
+        return example.GetDataVector().CopyAs<data::FloatDataVector>();
+    });
+    bool transformOk = transformedDataset.NumExamples() == 2 && transformedDataset.NumFeatures() == 5 && testing::IsEqual(transformedDataset[1].GetDataVector().ToArray(), { 0, 0, 0, 0, 5 }) && transformedDataset[1].GetMetadata().label == -1;
+    testing::ProcessTest("Dataset::Transform of data vectors", transformOk);
+
+    // an arena gives every allocation its own aligned memory, and big allocations their own chunk
+    utilities::Arena arena(64);
+    auto p1 = static_cast<char*>(arena.Allocate(3, 1));
+    auto p2 = static_cast<char*>(arena.Allocate(8, 8));
+    auto p3 = static_cast<char*>(arena.Allocate(100, 16));
+    auto p4 = static_cast<char*>(arena.Allocate(4, 4));
+    bool arenaOk = p2 >= p1 + 3 && reinterpret_cast<uintptr_t>(p2) % 8 == 0 && reinterpret_cast<uintptr_t>(p3) % 16 == 0 && reinterpret_cast<uintptr_t>(p4) % 4 == 0 && arena.NumChunks() == 2 && arena.GetAllocatedSize() == 115;
+    testing::ProcessTest("Arena::Allocate", arenaOk);
+}
+
+void DatasetIndexPermutationTests()
+{
+    data::AutoSupervisedDataset dataset1;
+    data::AutoSupervisedDataset dataset2;
+    for (size_t i = 0; i < 50; ++i)
+    {
+        auto value = static_cast<double>(i);
+        dataset1.AddExample(data::AutoDataVector{ value }, data::WeightLabel{ 1, value });
+        dataset2.AddExample(data::AutoDataVector{ value }, data::WeightLabel{ 1, value });
+    }
+
+    // over several epochs, permuting an index visits the examples in the same order as permuting the examples
+    std::default_random_engine rng1(1234);
+    std::default_random_engine rng2(1234);
+    std::vector<size_t> permutation;
+    bool isSameOrder = true;
+    for (size_t epoch = 0; epoch < 3; ++epoch)
+    {
+        dataset1.RandomPermute(rng1);
+        dataset2.RandomPermute(rng2, permutation);
+
+        auto iterator1 = dataset1.GetExampleReferenceIterator();
+        auto iterator2 = dataset2.GetPermutedExampleReferenceIterator(permutation);
+        while (iterator1.IsValid() && iterator2.IsValid())
+        {
+            isSameOrder = isSameOrder && iterator1.Get().GetMetadata().label == iterator2.Get().GetMetadata().label;
+            iterator1.Next();
+            iterator2.Next();
+        }
+        isSameOrder = isSameOrder && !iterator1.IsValid() && !iterator2.IsValid();
+    }
+    bool isUnmoved = dataset2[7].GetMetadata().label == 7;
+    testing::ProcessTest("Dataset::RandomPermute of an index", isSameOrder && isUnmoved);
+}
+
+void DatasetParallelTransformTests()
+{
+    data::AutoSupervisedDataset dataset;
+    for (size_t i = 0; i < 101; ++i)
+    {
+        auto value = static_cast<double>(i);
+        dataset.AddExample(data::AutoDataVector{ value, 1 }, data::WeightLabel{ 1, value });
+    }
+
+    // every thread gets its own function, which counts the examples it transforms
+    std::vector<std::shared_ptr<size_t>> counts;
+    using TransformationFunction = std::function<data::DenseSupervisedExample(const data::AutoSupervisedExample&)>;
+    auto transformedDataset = dataset.TransformInParallel<data::DenseSupervisedExample>([&counts]() -> TransformationFunction {
+        auto count = std::make_shared<size_t>(0);
+        counts.push_back(count);
+        return [count](const data::AutoSupervisedExample& example) {
+            ++*count;
+            auto dataVector = example.GetDataVector().CopyAs<data::FloatDataVector>();
+            return data::DenseSupervisedExample(std::move(dataVector), example.GetMetadata());
+        };
+    },
+                                                                                     4);
+
+    bool isOk = transformedDataset.NumExamples() == 101 && counts.size() == 4;
+    for (size_t i = 0; i < transformedDataset.NumExamples(); ++i)
+    {
+        auto value = static_cast<double>(i);
+        isOk = isOk && testing::IsEqual(transformedDataset[i].GetDataVector().ToArray(), { value, 1 }) && transformedDataset[i].GetMetadata().label == value;
+    }
+    for (const auto& count : counts)
+    {
+        isOk = isOk && *count > 0;
+    }
+    testing::ProcessTest("Dataset::TransformInParallel", isOk);
+}
 } // namespace ell
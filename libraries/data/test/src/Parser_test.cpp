@@ -11,11 +11,17 @@
 #include <data/include/AutoDataVector.h>
 #include <data/include/Dataset.h>
 #include <data/include/GeneralizedSparseParsingIterator.h>
+#include <data/include/ParallelParsing.h>
 #include <data/include/SequentialLineIterator.h>
 #include <data/include/SingleLineParsingExampleIterator.h>
 #include <data/include/TextLine.h>
 #include <data/include/WeightLabel.h>
 
+#include <common/include/DataLoaders.h>
+
+#include <utilities/include/Files.h>
+#include <utilities/include/ParallelFor.h>
+
 #include <testing/include/testing.h>
 
 #include <memory>
@@ -142,4 +148,56 @@ void SingleFileParseTest()
     testing::ProcessTest("SingleFileParse test2", dataset[1].GetMetadata().label == -1 && testing::IsEqual(dataset[1].GetDataVector().ToArray(), { 0, 0, 0, 3, 0, 0, 0, 0, 0, 0, 3 }));
     testing::ProcessTest("SingleFileParse test3", dataset[2].GetMetadata().label == 1 && testing::IsEqual(dataset[2].GetDataVector().ToArray(), { 2.7, 0, 0, 0, -0.3, 0, 0, 0, 0, 0, 3.14 }));
 }
-} // namespace ell
\ No newline at end of file
+
+void ParallelParseTest()
+{
+    std::stringstream text;
+    for (int i = 0; i < 1000; ++i)
+    {
+        text << (i % 2 ? "1.0" : "-1.0") << "\t" << i << ":" << (i % 13) + 1 << " " << i + 3 << ":0.5";
+        text << (i % 7 == 0 ? "  // comment\n\n   \n" : "\n");
+    }
+    auto string = text.str();
+
+    std::stringstream stream(string);
+    auto exampleIterator = data::MakeSingleLineParsingExampleIterator(data::SequentialLineIterator(stream), data::LabelParser(), data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>());
+    auto expected = data::MakeDataset(std::move(exampleIterator));
+
+    auto isSameDataset = [&expected](const data::AutoSupervisedDataset& dataset) {
+        if (dataset.NumExamples() != expected.NumExamples() || dataset.NumFeatures() != expected.NumFeatures())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < dataset.NumExamples(); ++i)
+        {
+            if (dataset[i].GetMetadata().label != expected[i].GetMetadata().label || !testing::IsEqual(dataset[i].GetDataVector().ToArray(), expected[i].GetDataVector().ToArray()))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto dataset = data::ParseDatasetInParallel(string.data(), string.data() + string.size(), data::LabelParser(), data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>(), 3);
+    testing::ProcessTest("ParallelParse test", isSameDataset(dataset));
+
+    // without a newline at the end
+    string.pop_back();
+    dataset = data::ParseDatasetInParallel(string.data(), string.data() + string.size(), data::LabelParser(), data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>(), 5);
+    testing::ProcessTest("ParallelParse test without final newline", isSameDataset(dataset));
+
+    // nested calls parse on the calling thread
+    {
+        utilities::ParallelRegion region;
+        dataset = data::ParseDatasetInParallel(string.data(), string.data() + string.size(), data::LabelParser(), data::AutoDataVectorParser<data::GeneralizedSparseParsingIterator>(), 4);
+    }
+    testing::ProcessTest("ParallelParse inside a parallel region", isSameDataset(dataset));
+
+    const std::string filename = "parallelParse.txt";
+    {
+        auto fileStream = utilities::OpenOfstream(filename);
+        fileStream << string;
+    }
+    testing::ProcessTest("ParallelParse from file", isSameDataset(common::GetDatasetInParallel(filename)));
+}
+} // namespace ell
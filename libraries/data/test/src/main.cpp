@@ -24,12 +24,22 @@ int main()
     AutoDataVectorTest();
     TransformedDataVectorTest();
     IteratorTests();
+    BlockSparseDataVectorTest();
     ExampleCopyAsTests();
     DatasetCastingTests();
     DatasetSerializationTests();
+    StreamingDatasetTests();
+    PrefetchingExampleIteratorTests();
+    BinaryDatasetTest();
+    TextDatasetWriterTest();
+    TypedDatasetTests();
+    DatasetArenaTests();
+    DatasetIndexPermutationTests();
+    DatasetParallelTransformTests();
     DataVectorParseTest();
     AutoDataVectorParseTest();
     SingleFileParseTest();
+    ParallelParseTest();
 
     if (testing::DidTestFail())
     {
@@ -0,0 +1,215 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BiquadCascade.h (dsp)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <utilities/include/Archiver.h>
+#include <utilities/include/IArchivable.h>
+#include <utilities/include/TypeName.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace dsp
+{
+    /// <summary> The coefficients of a second-order section (biquad), with a0 normalized to 1:
+    ///
+    ///     y[t] = b0*x[t] + b1*x[t-1] + b2*x[t-2] - a1*y[t-1] - a2*y[t-2]
+    /// </summary>
+    template <typename ValueType>
+    struct BiquadSection
+    {
+        ValueType b0;
+        ValueType b1;
+        ValueType b2;
+        ValueType a1;
+        ValueType a2;
+    };
+
+    /// <summary>
+    /// An IIR filter made of a cascade of second-order sections, applied to several channels at once.
+    ///
+    /// Each section is computed in transposed direct form II, which keeps two state values per section and channel and
+    /// is less sensitive to rounding than one high-order direct-form filter. The samples are interleaved, a frame of one
+    /// sample per channel at a time, so the channels go through the cascade in lock step and the inner loop over the
+    /// channels has no dependencies between iterations, which the compiler can turn into vector instructions.
+    /// </summary>
+    template <typename ValueType>
+    class BiquadCascade : public utilities::IArchivable
+    {
+    public:
+        BiquadCascade() = default;
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="sections"> The sections, in the order the signal goes through them. </param>
+        /// <param name="numChannels"> The number of channels. </param>
+        BiquadCascade(const std::vector<BiquadSection<ValueType>>& sections, size_t numChannels = 1);
+
+        /// <summary> Filter one frame, one sample per channel. </summary>
+        ///
+        /// <param name="input"> The input frame. </param>
+        /// <param name="output"> The buffer to receive the output frame. May be the same as `input`. </param>
+        void FilterFrame(const ValueType* input, ValueType* output);
+
+        /// <summary> Filter a sequence of interleaved frames. </summary>
+        ///
+        /// <param name="input"> The input frames. </param>
+        /// <param name="numFrames"> The number of frames. </param>
+        /// <param name="output"> The buffer to receive the output frames. May be the same as `input`. </param>
+        void FilterFrames(const ValueType* input, size_t numFrames, ValueType* output);
+
+        /// <summary> Filter a sequence of interleaved frames. </summary>
+        ///
+        /// <param name="input"> The input frames. Its size must be a multiple of the number of channels. </param>
+        ///
+        /// <returns> The output frames. </returns>
+        std::vector<ValueType> FilterFrames(const std::vector<ValueType>& input);
+
+        /// <summary> Reset the internal state of the filter to zero. </summary>
+        void Reset();
+
+        /// <summary> Gets the sections. </summary>
+        const std::vector<BiquadSection<ValueType>>& GetSections() const { return _sections; }
+
+        /// <summary> Gets the number of channels. </summary>
+        size_t GetNumChannels() const { return _numChannels; }
+
+        /// <summary> Gets the name of this type. </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("BiquadCascade"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+
+    private:
+        std::vector<BiquadSection<ValueType>> _sections;
+        size_t _numChannels = 1;
+
+        // The state of section s for channel c is at s * _numChannels + c
+        std::vector<ValueType> _state1;
+        std::vector<ValueType> _state2;
+    };
+} // namespace dsp
+} // namespace ell
+
+#pragma region implementation
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace dsp
+{
+    template <typename ValueType>
+    BiquadCascade<ValueType>::BiquadCascade(const std::vector<BiquadSection<ValueType>>& sections, size_t numChannels) :
+        _sections(sections),
+        _numChannels(numChannels)
+    {
+        if (numChannels == 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "BiquadCascade needs at least one channel");
+        }
+        Reset();
+    }
+
+    template <typename ValueType>
+    void BiquadCascade<ValueType>::FilterFrame(const ValueType* input, ValueType* output)
+    {
+        const auto numChannels = _numChannels;
+        const ValueType* sectionInput = input;
+        for (size_t s = 0; s < _sections.size(); ++s)
+        {
+            const auto [b0, b1, b2, a1, a2] = _sections[s];
+            ValueType* state1 = _state1.data() + s * numChannels;
+            ValueType* state2 = _state2.data() + s * numChannels;
+            for (size_t c = 0; c < numChannels; ++c)
+            {
+                const ValueType x = sectionInput[c];
+                const ValueType y = b0 * x + state1[c];
+                state1[c] = b1 * x - a1 * y + state2[c];
+                state2[c] = b2 * x - a2 * y;
+                output[c] = y;
+            }
+            sectionInput = output;
+        }
+
+        if (_sections.empty() && output != input)
+        {
+            std::copy(input, input + numChannels, output);
+        }
+    }
+
+    template <typename ValueType>
+    void BiquadCascade<ValueType>::FilterFrames(const ValueType* input, size_t numFrames, ValueType* output)
+    {
+        for (size_t frame = 0; frame < numFrames; ++frame)
+        {
+            FilterFrame(input + frame * _numChannels, output + frame * _numChannels);
+        }
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> BiquadCascade<ValueType>::FilterFrames(const std::vector<ValueType>& input)
+    {
+        if (input.size() % _numChannels != 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "BiquadCascade input size must be a multiple of the number of channels");
+        }
+        std::vector<ValueType> result(input.size());
+        FilterFrames(input.data(), input.size() / _numChannels, result.data());
+        return result;
+    }
+
+    template <typename ValueType>
+    void BiquadCascade<ValueType>::Reset()
+    {
+        _state1.assign(_sections.size() * _numChannels, 0);
+        _state2.assign(_sections.size() * _numChannels, 0);
+    }
+
+    template <typename ValueType>
+    void BiquadCascade<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        std::vector<ValueType> coefficients;
+        for (const auto& section : _sections)
+        {
+            coefficients.insert(coefficients.end(), { section.b0, section.b1, section.b2, section.a1, section.a2 });
+        }
+        archiver["coefficients"] << coefficients;
+        archiver["numChannels"] << _numChannels;
+    }
+
+    template <typename ValueType>
+    void BiquadCascade<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        std::vector<ValueType> coefficients;
+        archiver["coefficients"] >> coefficients;
+        archiver["numChannels"] >> _numChannels;
+        _sections.clear();
+        for (size_t index = 0; index + 5 <= coefficients.size(); index += 5)
+        {
+            _sections.push_back({ coefficients[index], coefficients[index + 1], coefficients[index + 2], coefficients[index + 3], coefficients[index + 4] });
+        }
+        Reset();
+    }
+} // namespace dsp
+} // namespace ell
+
+#pragma endregion implementation
@@ -6,6 +6,10 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#pragma once
+
+#include "FFT.h"
+
 #include <math/include/MathConstants.h>
 #include <math/include/Matrix.h>
 #include <math/include/MatrixOperations.h>
@@ -14,6 +18,7 @@
 #include <utilities/include/Exception.h>
 
 #include <cmath>
+#include <complex>
 #include <vector>
 
 namespace ell
@@ -22,13 +27,13 @@ namespace dsp
 {
     /// <summary> Compute the discrete cosine transform (DCT-II) coefficient matrix for a given size DCT. </summary>
     ///
-    /// <param name="numFilters"> The number of DCT filters to generate --- the output dimension of a signal processed by this filter matrix. </param>
     /// <param name="windowSize"> The size of the signal to be processed. </param>
+    /// <param name="numFilters"> The number of DCT filters to generate --- the output dimension of a signal processed by this filter matrix. </param>
     /// <param name="normalize"> A flag indicating if the resulting DCT matrix should be orthonormal. </param>
     ///
     /// <returns> The coefficient matrix to multiply by the signal vector. </returns>
     template <typename ValueType>
-    math::RowMatrix<ValueType> GetDCTMatrix(size_t numFilters, size_t windowSize, bool normalize = false);
+    math::RowMatrix<ValueType> GetDCTMatrix(size_t windowSize, size_t numFilters, bool normalize = false);
 
     /// <summary> Compute the discrete cosine transform (DCT-II) of a vector of values, with an existing coefficient matrix. </summary>
     ///
@@ -43,11 +48,84 @@ namespace dsp
     /// <summary> Compute the discrete cosine transform (DCT-II) of a vector of values. </summary>
     ///
     /// <param name="signal"> The vector to compute the DCT of. </param>
-    /// <param name="normalize"> A flag indicating if the resulting DCT matrix should be orthonormal. </param>
+    /// <param name="numFilters"> The number of DCT coefficients to compute. </param>
+    /// <param name="normalize"> A flag indicating if the resulting DCT should be orthonormal. </param>
     ///
     /// <returns> The DCT of the input signal. </returns>
     template <typename ValueType>
-    math::ColumnVector<ValueType> DCT(math::ConstColumnVectorReference<ValueType> signal, bool normalize = false);
+    math::ColumnVector<ValueType> DCT(math::ConstColumnVectorReference<ValueType> signal, size_t numFilters, bool normalize = false);
+
+    /// <summary>
+    /// The precomputed tables for discrete cosine transforms (DCT-II) of one size, truncated to the first few
+    /// coefficients. If the window size is a power of 2 and enough coefficients are needed for it to pay off,
+    /// the plan computes the DCT in O(N log N) with a real-valued FFT of a permutation of the signal (Makhoul's
+    /// algorithm), followed by a multiplication of each coefficient by a "post-twiddle" factor. Otherwise, it
+    /// uses the rows of the DCT matrix for the coefficients needed. Build a plan once and reuse it for all the
+    /// transforms of that size.
+    /// </summary>
+    template <typename ValueType>
+    class DCTPlan
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="windowSize"> The size of the signal to be processed. </param>
+        /// <param name="numFilters"> The number of DCT coefficients to compute, at most the window size. </param>
+        /// <param name="normalize"> A flag indicating if the resulting DCT should be orthonormal. </param>
+        DCTPlan(size_t windowSize, size_t numFilters, bool normalize = false);
+
+        /// <summary> Returns the size of the signal to be processed. </summary>
+        size_t GetWindowSize() const { return _windowSize; }
+
+        /// <summary> Returns the number of DCT coefficients computed. </summary>
+        size_t GetNumFilters() const { return _numFilters; }
+
+        /// <summary> Returns true if the DCT is computed with an FFT, and false if with the DCT matrix. </summary>
+        bool UsesFFT() const { return _useFFT; }
+
+        /// <summary> Returns the FFT plan. Only valid if `UsesFFT()` is true. </summary>
+        const FFTPlan<ValueType>& GetFFTPlan() const { return _fftPlan; }
+
+        /// <summary>
+        /// Returns the index into the signal of each entry of the permuted signal that gets transformed:
+        /// the even samples in order, followed by the odd samples in reverse order. Only valid if `UsesFFT()` is true.
+        /// </summary>
+        const std::vector<size_t>& GetPermutation() const { return _permutation; }
+
+        /// <summary>
+        /// Returns the post-twiddle factors: coefficient k is the real part of the product of entry k of the FFT
+        /// of the permuted signal and factor k. Only valid if `UsesFFT()` is true.
+        /// </summary>
+        const std::vector<std::complex<ValueType>>& GetPostTwiddleFactors() const { return _postTwiddles; }
+
+        /// <summary> Returns the truncated DCT matrix, with one row per coefficient. Only valid if `UsesFFT()` is false. </summary>
+        math::ConstRowMatrixReference<ValueType> GetDCTMatrix() const { return _dctMatrix; }
+
+        /// <summary> Compute the DCT of a signal. </summary>
+        ///
+        /// <param name="signal"> The window size values of the signal to process. </param>
+        /// <param name="output"> The number of filters values of the result. </param>
+        /// <param name="scratch"> A buffer for intermediate results, resized as needed. </param>
+        void Transform(const ValueType* signal, ValueType* output, std::vector<std::complex<ValueType>>& scratch) const;
+
+    private:
+        size_t _windowSize;
+        size_t _numFilters;
+        bool _useFFT;
+        FFTPlan<ValueType> _fftPlan;
+        std::vector<size_t> _permutation;
+        std::vector<std::complex<ValueType>> _postTwiddles;
+        math::RowMatrix<ValueType> _dctMatrix;
+    };
+
+    /// <summary> Compute the discrete cosine transform (DCT-II) of a vector of values, with a precomputed plan. </summary>
+    ///
+    /// <param name="plan"> The DCT plan, whose window size must be the size of the signal. </param>
+    /// <param name="signal"> The vector to compute the DCT of. </param>
+    ///
+    /// <returns> The DCT of the input signal. </returns>
+    template <typename ValueType>
+    math::ColumnVector<ValueType> DCT(const DCTPlan<ValueType>& plan, math::ConstColumnVectorReference<ValueType> signal);
 } // namespace dsp
 } // namespace ell
 
@@ -95,7 +173,7 @@ namespace dsp
     template <typename ValueType>
     math::ColumnVector<ValueType> DCT(math::ConstRowMatrixReference<ValueType> dctMatrix, math::ConstColumnVectorReference<ValueType> signal, bool normalize)
     {
-        math::ColumnVector<ValueType> result(signal.Size());
+        math::ColumnVector<ValueType> result(dctMatrix.NumRows());
         if (normalize)
         {
             throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
@@ -110,17 +188,113 @@ namespace dsp
     template <typename ValueType>
     math::ColumnVector<ValueType> DCT(math::ConstColumnVectorReference<ValueType> signal, size_t numFilters, bool normalize)
     {
-        auto windowSize = signal.Size();
-        auto dctMatrix = GetDCTMatrix<ValueType>(windowSize, numFilters);
-        math::ColumnVector<ValueType> result(numFilters);
-        if (normalize)
+        return DCT(DCTPlan<ValueType>(signal.Size(), numFilters, normalize), signal);
+    }
+
+    namespace detail
+    {
+        // The DCT matrix takes N*K multiply-adds for K coefficients, which the matrix-vector product vectorizes well,
+        // and the real FFT with its permutation and post-twiddles about as long as 4*N*log2(N) of them, so the FFT
+        // only pays off when more than a few times log2(N) coefficients are needed
+        inline bool ShouldUseFFTForDCT(size_t windowSize, size_t numFilters)
         {
-            throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
+            if (windowSize < 8 || (windowSize & (windowSize - 1)) != 0)
+            {
+                return false;
+            }
+            size_t log2Size = 0;
+            while ((size_t{ 1 } << log2Size) < windowSize)
+            {
+                ++log2Size;
+            }
+            return numFilters > 4 * log2Size;
         }
-        else
+    } // namespace detail
+
+    // Makhoul's algorithm: with v the permuted signal (v[n] = x[2n] and v[N-1-n] = x[2n+1] for n < N/2) and V its FFT,
+    // X[k] = Re(V[k] * exp(-i*pi*k/(2N))). FFTPlan uses exp(+2*pi*i*n*k/N) as its kernel, which conjugates V for a
+    // real signal, so the post-twiddle factors are conjugated too. They also fold in the normalization.
+    template <typename ValueType>
+    DCTPlan<ValueType>::DCTPlan(size_t windowSize, size_t numFilters, bool normalize) :
+        _windowSize(windowSize),
+        _numFilters(numFilters),
+        _useFFT(detail::ShouldUseFFTForDCT(windowSize, numFilters)),
+        _fftPlan(_useFFT ? windowSize : 1),
+        _dctMatrix(0, 0)
+    {
+        if (numFilters > windowSize)
         {
-            math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), dctMatrix, signal, static_cast<ValueType>(0.0), result);
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Number of DCT filters must be at most the window size");
         }
+
+        if (!_useFFT)
+        {
+            _dctMatrix = dsp::GetDCTMatrix<ValueType>(windowSize, numFilters, normalize);
+            return;
+        }
+
+        const auto halfSize = windowSize / 2;
+        _permutation.resize(windowSize);
+        for (size_t n = 0; n < halfSize; ++n)
+        {
+            _permutation[n] = 2 * n;
+            _permutation[windowSize - 1 - n] = 2 * n + 1;
+        }
+
+        const double pi = math::Constants<double>::pi;
+        const auto scale0 = normalize ? std::sqrt(1.0 / windowSize) : 1.0;
+        const auto scale = normalize ? std::sqrt(2.0 / windowSize) : 1.0;
+        _postTwiddles.resize(numFilters);
+        for (size_t k = 0; k < numFilters; ++k)
+        {
+            const auto angle = pi * k / (2.0 * windowSize);
+            const auto s = k == 0 ? scale0 : scale;
+            _postTwiddles[k] = { static_cast<ValueType>(s * std::cos(angle)), static_cast<ValueType>(s * std::sin(angle)) };
+        }
+    }
+
+    template <typename ValueType>
+    void DCTPlan<ValueType>::Transform(const ValueType* signal, ValueType* output, std::vector<std::complex<ValueType>>& scratch) const
+    {
+        if (!_useFFT)
+        {
+            math::ConstColumnVectorReference<ValueType> input(signal, _windowSize);
+            math::ColumnVectorReference<ValueType> result(output, _numFilters);
+            math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), _dctMatrix, input, static_cast<ValueType>(0.0), result);
+            return;
+        }
+
+        // The permuted signal is written into the scratch buffer as interleaved real values, which is how
+        // FFTPlan::TransformReal packs its input into a complex signal of half the size anyway, so the
+        // transform can read it from, and write its result to, the same buffer
+        scratch.resize(_windowSize);
+        auto permuted = reinterpret_cast<ValueType*>(scratch.data());
+        for (size_t index = 0; index < _windowSize; ++index)
+        {
+            permuted[index] = signal[_permutation[index]];
+        }
+        _fftPlan.TransformReal(permuted, scratch.data());
+
+        for (size_t k = 0; k < _numFilters; ++k)
+        {
+            const auto v = scratch[k];
+            const auto w = _postTwiddles[k];
+            output[k] = v.real() * w.real() - v.imag() * w.imag();
+        }
+    }
+
+    template <typename ValueType>
+    math::ColumnVector<ValueType> DCT(const DCTPlan<ValueType>& plan, math::ConstColumnVectorReference<ValueType> signal)
+    {
+        if (signal.Size() != plan.GetWindowSize())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "Signal size must match the DCT plan's window size");
+        }
+
+        math::ColumnVector<ValueType> input(signal);
+        math::ColumnVector<ValueType> result(plan.GetNumFilters());
+        std::vector<std::complex<ValueType>> scratch;
+        plan.Transform(input.GetConstDataPointer(), result.GetDataPointer(), scratch);
         return result;
     }
 
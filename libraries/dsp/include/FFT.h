@@ -6,10 +6,12 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#pragma once
+
 #include <math/include/MathConstants.h>
 #include <math/include/Vector.h>
 
-#include <utilities/include/Unused.h>
+#include <utilities/include/Exception.h>
 
 #include <complex>
 #include <vector>
@@ -18,6 +20,67 @@ namespace ell
 {
 namespace dsp
 {
+    /// <summary>
+    /// The precomputed tables for discrete ("fast") fourier transforms (FFTs) of one size: the twiddle
+    /// factors of every butterfly stage and the bit-reversal permutation. A plan of size N computes
+    /// complex-valued FFTs of size N, and real-valued FFTs of size N via a complex-valued FFT of size N/2.
+    /// Build a plan once and reuse it for all the transforms of that size.
+    /// </summary>
+    template <typename ValueType>
+    class FFTPlan
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="size"> The FFT size. Must be a power of 2. </param>
+        FFTPlan(size_t size);
+
+        /// <summary> Returns the FFT size. </summary>
+        ///
+        /// <returns> The FFT size. </returns>
+        size_t Size() const { return _size; }
+
+        /// <summary>
+        /// Returns the twiddle factors of the butterfly stage that combines two transforms of size length/2
+        /// into one of size length: the length/2 values exp(2*pi*i*k/length), for k from 0 to length/2 - 1.
+        /// </summary>
+        ///
+        /// <param name="length"> The transform size after the stage. A power of 2, from 2 to the FFT size. </param>
+        ///
+        /// <returns> A pointer to the length/2 twiddle factors. </returns>
+        const std::complex<ValueType>* GetTwiddleFactors(size_t length) const;
+
+        /// <summary> Returns the bit-reversal permutation of the indices 0 to N-1. </summary>
+        ///
+        /// <returns> The permutation. </returns>
+        const std::vector<size_t>& GetBitReversalPermutation() const { return _bitReversal; }
+
+        /// <summary> Perform an in-place complex-valued FFT. </summary>
+        ///
+        /// <param name="signal"> The N values of the signal to process. </param>
+        /// <param name="inverse"> A flag indicating if the inverse FFT should be computed instead. </param>
+        void Transform(std::complex<ValueType>* signal, bool inverse = false) const;
+
+        /// <summary> Perform a real-valued FFT. </summary>
+        ///
+        /// <param name="signal"> The N values of the signal to process. </param>
+        /// <param name="output"> The N complex values of the result. </param>
+        void TransformReal(const ValueType* signal, std::complex<ValueType>* output) const;
+
+        /// <summary> Perform an inverse FFT of the transform of a real-valued signal. </summary>
+        ///
+        /// <param name="spectrum"> The transform, of which only the first N/2 + 1 values are used. Used as scratch space, so its contents are lost. </param>
+        /// <param name="output"> The N values of the real-valued signal. </param>
+        void InverseTransformReal(std::complex<ValueType>* spectrum, ValueType* output) const;
+
+    private:
+        void Transform(std::complex<ValueType>* signal, size_t size) const;
+
+        size_t _size;
+        std::vector<std::complex<ValueType>> _twiddles; // the tables of all butterfly stages, one after the other
+        std::vector<size_t> _bitReversal;
+    };
+
     /// <summary> Perform an in-place discrete ("fast") fourier transform (FFT) of a complex-valued input signal. </summary>
     ///
     /// <param name="signal"> The signal vector to process. Must be a power of 2 in length. </param>
@@ -48,6 +111,17 @@ namespace dsp
     /// <remarks> The output of a real-valued FFT is symmetric, so only the first (N/2)+1 entries of the signal input are necessary </remarks>
     template <typename ValueType>
     void FFT(std::vector<ValueType>& signal, bool inverse = false);
+
+    /// <summary>
+    /// Perform an in-place discrete ("fast") fourier transform (FFT) of a real-valued input signal with a
+    /// precomputed plan, returning the magnitudes of the frequency bands.
+    /// </summary>
+    ///
+    /// <param name="plan"> The plan, whose size must be the length of the signal. </param>
+    /// <param name="signal"> The signal vector to process. </param>
+    /// <param name="scratch"> A buffer for the complex-valued result, resized as needed. </param>
+    template <typename ValueType>
+    void FFT(const FFTPlan<ValueType>& plan, std::vector<ValueType>& signal, std::vector<std::complex<ValueType>>& scratch);
 } // namespace dsp
 } // namespace ell
 
@@ -57,143 +131,280 @@ namespace ell
 {
 namespace dsp
 {
-    namespace detail
+    template <typename ValueType>
+    FFTPlan<ValueType>::FFTPlan(size_t size) :
+        _size(size)
     {
-        template <typename Iterator>
-        void Deinterleave(Iterator begin, Iterator end, Iterator scratch)
+        if ((size & (size - 1)) != 0)
         {
-            const auto size = end - begin;
-            const auto halfN = size / 2;
-            for (int index = 0; index < halfN; ++index)
-            {
-                scratch[index] = begin[2 * index + 1];
-                begin[index] = begin[2 * index];
-            }
-            for (int index = 0; index < halfN; ++index)
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FFT size must be a power of 2");
+        }
+
+        // The stage producing transforms of size 2h uses h twiddle factors, stored at offset h-1
+        const ValueType pi = math::Constants<ValueType>::pi;
+        _twiddles.resize(size > 0 ? size - 1 : 0);
+        for (size_t halfLength = 1; halfLength < size; halfLength *= 2)
+        {
+            auto stageTwiddles = _twiddles.data() + halfLength - 1;
+            for (size_t k = 0; k < halfLength; ++k)
             {
-                begin[index + halfN] = scratch[index];
+                stageTwiddles[k] = std::exp(std::complex<ValueType>(0, pi * k / halfLength));
             }
         }
 
-        template <typename Iterator>
-        void FFT(Iterator begin, Iterator end, Iterator scratch, bool inverse)
+        _bitReversal.resize(size);
+        size_t numBits = 0;
+        while ((size_t{ 1 } << numBits) < size)
         {
-            if (inverse)
+            ++numBits;
+        }
+        for (size_t index = 0; index < size; ++index)
+        {
+            size_t reversed = 0;
+            for (size_t bit = 0; bit < numBits; ++bit)
             {
-                throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
+                reversed |= ((index >> bit) & 1) << (numBits - 1 - bit);
             }
-            using ValueType = typename Iterator::value_type::value_type;
-            const ValueType pi = math::Constants<ValueType>::pi;
+            _bitReversal[index] = reversed;
+        }
+    }
 
-            auto halfN = (end - begin) / 2;
-            if (halfN < 1)
+    template <typename ValueType>
+    const std::complex<ValueType>* FFTPlan<ValueType>::GetTwiddleFactors(size_t length) const
+    {
+        if (length < 2 || length > _size)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange);
+        }
+        return _twiddles.data() + length / 2 - 1;
+    }
+
+    template <typename ValueType>
+    void FFTPlan<ValueType>::Transform(std::complex<ValueType>* signal, bool inverse) const
+    {
+        // The inverse transform is the conjugate of the forward transform of the conjugate, scaled by 1/N
+        if (inverse)
+        {
+            for (size_t index = 0; index < _size; ++index)
             {
-                return; // done
+                signal[index] = std::conj(signal[index]);
             }
+        }
 
-            Deinterleave(begin, end, scratch);
-            auto evens = begin;
-            auto odds = begin + halfN;
+        Transform(signal, _size);
 
-            if (halfN > 1)
+        if (inverse)
+        {
+            const auto scale = static_cast<ValueType>(1) / static_cast<ValueType>(_size);
+            for (size_t index = 0; index < _size; ++index)
             {
-                FFT(evens, evens + halfN, scratch, inverse);
-                FFT(odds, odds + halfN, scratch, inverse);
+                signal[index] = std::conj(signal[index]) * scale;
             }
+        }
+    }
 
-            for (int k = 0; k < halfN; k++)
+    template <typename ValueType>
+    void FFTPlan<ValueType>::Transform(std::complex<ValueType>* signal, size_t size) const
+    {
+        if (size < 2)
+        {
+            return;
+        }
+
+        // For a transform of size _size / 2^s, the permutation is the full one shifted right by s bits
+        size_t shift = 0;
+        while ((size << shift) < _size)
+        {
+            ++shift;
+        }
+        for (size_t index = 0; index < size; ++index)
+        {
+            auto reversed = _bitReversal[index] >> shift;
+            if (index < reversed)
             {
-                // w = e^(2*pi*k/N)
-                std::complex<ValueType> w = std::exp(std::complex<ValueType>(0, pi * k / halfN));
-                auto e = evens[k];
-                auto o = odds[k];
-                auto wo = w * o;
-                evens[k] = e + wo; // even
-                odds[k] = e - wo; // odd
+                std::swap(signal[index], signal[reversed]);
             }
         }
 
-        template <typename Iterator, typename ComplexIterator>
-        void FFTReal(Iterator begin, Iterator end, Iterator scratch, ComplexIterator outputBegin, ComplexIterator outputEnd, bool inverse)
+        // The butterflies work on the real and imaginary parts directly: std::complex multiplication
+        // checks for infinities and NaNs, which keeps the compiler from vectorizing the loops
+        auto data = reinterpret_cast<ValueType*>(signal);
+        for (size_t index = 0; index < size; index += 2)
         {
-            UNUSED(outputEnd);
-            if (inverse)
+            auto a = data + 2 * index;
+            auto re = a[2];
+            auto im = a[3];
+            a[2] = a[0] - re;
+            a[3] = a[1] - im;
+            a[0] += re;
+            a[1] += im;
+        }
+
+        for (size_t halfLength = 2; halfLength < size; halfLength *= 2)
+        {
+            auto twiddles = reinterpret_cast<const ValueType*>(_twiddles.data() + halfLength - 1);
+            for (size_t start = 0; start < size; start += 2 * halfLength)
             {
-                throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "inverse must be false");
+                auto a = data + 2 * start;
+                auto b = a + 2 * halfLength;
+                for (size_t k = 0; k < halfLength; ++k)
+                {
+                    auto wRe = twiddles[2 * k];
+                    auto wIm = twiddles[2 * k + 1];
+                    auto bRe = b[2 * k];
+                    auto bIm = b[2 * k + 1];
+                    auto re = wRe * bRe - wIm * bIm;
+                    auto im = wRe * bIm + wIm * bRe;
+                    b[2 * k] = a[2 * k] - re;
+                    b[2 * k + 1] = a[2 * k + 1] - im;
+                    a[2 * k] += re;
+                    a[2 * k + 1] += im;
+                }
             }
+        }
+    }
 
-            using ValueType = typename Iterator::value_type;
-            const ValueType pi = math::Constants<ValueType>::pi;
-
-            auto halfN = (end - begin) / 2;
-            if (halfN < 1)
+    template <typename ValueType>
+    void FFTPlan<ValueType>::TransformReal(const ValueType* signal, std::complex<ValueType>* output) const
+    {
+        if (_size < 2)
+        {
+            if (_size == 1)
             {
-                return; // done
+                output[0] = signal[0];
             }
+            return;
+        }
 
-            Deinterleave(begin, end, scratch);
+        // Pack the even and odd samples into the real and imaginary parts of a signal of half the size,
+        // transform that, and then separate the transforms of the even and odd samples (E and O) with
+        // E[k] = (Z[k] + conj(Z[M-k])) / 2 and O[k] = -i (Z[k] - conj(Z[M-k])) / 2
+        const auto halfSize = _size / 2;
+        for (size_t index = 0; index < halfSize; ++index)
+        {
+            output[index] = { signal[2 * index], signal[2 * index + 1] };
+        }
+        Transform(output, halfSize);
 
-            auto evens = begin;
-            auto odds = begin + halfN;
-            auto complexEvens = outputBegin;
-            auto complexOdds = outputBegin + halfN;
+        const auto half = static_cast<ValueType>(0.5);
+        const auto twiddles = _twiddles.data() + halfSize - 1;
+        const auto z0 = output[0];
+        for (size_t k = 1; 2 * k <= halfSize; ++k)
+        {
+            const auto m = halfSize - k;
+            const auto zk = output[k];
+            const auto zm = std::conj(output[m]);
+            const auto e = (zk + zm) * half;
+            const auto o = std::complex<ValueType>(zk.imag() - zm.imag(), zm.real() - zk.real()) * half;
+            const auto w = twiddles[k];
+            const auto wo = std::complex<ValueType>(w.real() * o.real() - w.imag() * o.imag(), w.real() * o.imag() + w.imag() * o.real());
+            output[k] = e + wo;
+            output[m] = std::conj(e - wo);
+        }
+        output[0] = z0.real() + z0.imag();
+        output[halfSize] = z0.real() - z0.imag();
 
-            if (halfN > 1)
-            {
-                FFTReal(evens, evens + halfN, scratch, complexEvens, complexEvens + halfN, inverse);
-                FFTReal(odds, odds + halfN, scratch, complexOdds, complexOdds + halfN, inverse);
-            }
-            else
-            {
-                // Base case: copy from real to complex
-                for (int index = 0; index < halfN; ++index)
-                {
-                    complexEvens[index] = evens[index];
-                    complexOdds[index] = odds[index];
-                }
-            }
+        // The transform of a real signal is conjugate-symmetric
+        for (size_t k = 1; k < halfSize; ++k)
+        {
+            output[_size - k] = std::conj(output[k]);
+        }
+    }
 
-            for (int k = 0; k < halfN; k++)
+    template <typename ValueType>
+    void FFTPlan<ValueType>::InverseTransformReal(std::complex<ValueType>* spectrum, ValueType* output) const
+    {
+        if (_size < 2)
+        {
+            if (_size == 1)
             {
-                // w = e^(2*pi*k/N)
-                std::complex<ValueType> w = std::exp(std::complex<ValueType>(0, pi * k / halfN));
-                auto e = complexEvens[k];
-                auto o = complexOdds[k];
-                auto wo = w * o;
-                complexEvens[k] = e + wo; // even
-                complexOdds[k] = e - wo; // odd
+                output[0] = spectrum[0].real();
             }
+            return;
+        }
+
+        // Undo the post-processing of TransformReal: recombine the spectra of the even and odd samples into
+        // the transform of the packed signal, Z[k] = E[k] + i O[k], and transform that back at half the size.
+        // The spectrum is conjugated along the way, so the forward transform computes the inverse.
+        const auto halfSize = _size / 2;
+        const auto half = static_cast<ValueType>(0.5);
+        const auto twiddles = _twiddles.data() + halfSize - 1;
+        const auto e0 = (spectrum[0] + std::conj(spectrum[halfSize])) * half;
+        const auto o0 = (spectrum[0] - std::conj(spectrum[halfSize])) * half;
+        spectrum[0] = std::conj(e0 + std::complex<ValueType>(-o0.imag(), o0.real()));
+        for (size_t k = 1; 2 * k <= halfSize; ++k)
+        {
+            const auto m = halfSize - k;
+            const auto xk = spectrum[k];
+            const auto xmc = std::conj(spectrum[m]);
+            const auto e = (xk + xmc) * half;
+            const auto d = (xk - xmc) * half;
+            const auto w = twiddles[k];
+            const auto o = std::complex<ValueType>(d.real() * w.real() + d.imag() * w.imag(), d.imag() * w.real() - d.real() * w.imag());
+            const auto io = std::complex<ValueType>(-o.imag(), o.real());
+            const auto ioc = std::complex<ValueType>(o.imag(), o.real()); // i * conj(o)
+            spectrum[k] = std::conj(e + io);
+            spectrum[m] = std::conj(std::conj(e) + ioc);
         }
-    } // namespace detail
+
+        Transform(spectrum, halfSize);
+
+        const auto scale = static_cast<ValueType>(1) / static_cast<ValueType>(halfSize);
+        for (size_t index = 0; index < halfSize; ++index)
+        {
+            output[2 * index] = spectrum[index].real() * scale;
+            output[2 * index + 1] = -spectrum[index].imag() * scale;
+        }
+    }
 
     template <typename ValueType>
     void FFT(std::vector<std::complex<ValueType>>& input, bool inverse)
     {
-        std::vector<std::complex<ValueType>> scratch(input.size() / 2);
-        detail::FFT(std::begin(input), std::end(input), std::begin(scratch), inverse);
+        FFTPlan<ValueType> plan(input.size());
+        plan.Transform(input.data(), inverse);
     }
 
     template <typename ValueType>
-    void FFT(std::vector<ValueType>& input, bool inverse)
+    void FFT(const FFTPlan<ValueType>& plan, std::vector<ValueType>& input, std::vector<std::complex<ValueType>>& scratch)
     {
         auto size = input.size();
-        std::vector<ValueType> scratch(size / 2);
-        std::vector<std::complex<ValueType>> output(size);
-        detail::FFTReal(std::begin(input), std::end(input), std::begin(scratch), std::begin(output), std::end(output), inverse);
+        if (size != plan.Size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "FFT plan size must match signal size");
+        }
+
+        scratch.resize(size);
+        plan.TransformReal(input.data(), scratch.data());
         for (size_t index = 0; index < size; ++index)
         {
-            input[index] = std::abs(output[index]);
+            input[index] = std::abs(scratch[index]);
         }
     }
 
+    template <typename ValueType>
+    void FFT(std::vector<ValueType>& input, bool inverse)
+    {
+        if (inverse)
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "inverse must be false");
+        }
+
+        std::vector<std::complex<ValueType>> output;
+        FFT(FFTPlan<ValueType>(input.size()), input, output);
+    }
+
     template <typename ValueType>
     void FFT(math::RowVector<ValueType>& input, bool inverse)
     {
-        using std::begin;
+        if (inverse)
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "inverse must be false");
+        }
+
         auto size = input.Size();
-        math::RowVector<ValueType> scratch(size / 2);
+        FFTPlan<ValueType> plan(size);
         std::vector<std::complex<ValueType>> output(size);
-        detail::FFTReal(begin(input), end(input), begin(scratch), begin(output), end(output), inverse);
+        plan.TransformReal(input.GetDataPointer(), output.data());
         for (size_t index = 0; index < size; ++index)
         {
             input[index] = std::abs(output[index]);
@@ -0,0 +1,270 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FIRFilter.h (dsp)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "FFT.h"
+
+#include <utilities/include/Archiver.h>
+#include <utilities/include/IArchivable.h>
+#include <utilities/include/TypeName.h>
+
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+namespace ell
+{
+namespace dsp
+{
+    /// <summary> A class representing a finite impulse response (FIR) filter that processes a stream of samples. </summary>
+    /// The output is computed according to the equation:
+    ///
+    ///     y[t] = b0*x[t] + b1*x[t-1] + b2*x[t-2] + ...
+    ///
+    /// The filter remembers the last input samples, so a long signal can be filtered in chunks of any size,
+    /// giving the same result as filtering it all at once. Long filters are applied with FFT-based
+    /// overlap-save convolution, short ones directly.
+    template <typename ValueType>
+    class FIRFilter : public utilities::IArchivable
+    {
+    public:
+        /// <summary> Construct a filter given its coefficients. </summary>
+        ///
+        /// <param name="b"> The filter coefficients (the impulse response). </param>
+        /// <param name="blockSize"> The number of samples per overlap-save block. If 0, short filters are applied directly,
+        /// and long ones use a block size chosen from the filter size. </param>
+        FIRFilter(std::vector<ValueType> b, size_t blockSize = 0);
+
+        /// <summary> Filter a sequence of input samples. <summary>
+        ///
+        /// <param name="x"> The new input samples to process. <param>
+        ///
+        /// <returns> The next output samples from the filter </returns>
+        std::vector<ValueType> FilterSamples(const std::vector<ValueType>& x);
+
+        /// <summary> Filter a sequence of input samples. <summary>
+        ///
+        /// <param name="input"> The new input samples to process. <param>
+        /// <param name="count"> The number of samples to process. <param>
+        /// <param name="output"> The buffer to receive the next `count` output samples from the filter. May be the same as `input`. <param>
+        void FilterSamples(const ValueType* input, size_t count, ValueType* output);
+
+        /// <summary> Reset the internal state of the filter to zero. </summary>
+        void Reset();
+
+        /// <summary> Accessor for the filter coefficients. </summary>
+        ///
+        /// <returns> The filter coefficients. </returns>
+        std::vector<ValueType> GetCoefficients() const { return _b; }
+
+        /// <summary> Indicates if the filter is applied with FFT-based convolution. </summary>
+        ///
+        /// <returns> true if the filter uses overlap-save convolution, false if it filters directly. </returns>
+        bool UsesFFT() const { return _plan.Size() > 0; }
+
+        /// <summary> Gets the name of this type. </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("FIRFilter"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+
+    private:
+        void Initialize();
+        void FilterDirect(const ValueType* input, size_t count, ValueType* output);
+        void FilterBlock(const ValueType* input, size_t count, ValueType* output);
+
+        // Filters of up to this many coefficients are applied directly
+        static constexpr size_t _maxDirectFilterSize = 64;
+
+        // Pieces of a stream shorter than this are filtered directly even by an overlap-save filter
+        static constexpr size_t _minFFTBlockSize = 32;
+
+        std::vector<ValueType> _b; // _b = {b0, b1, b2, ... }, so _b[0] = b0 = the scaling on the current input
+        size_t _blockSize;
+
+        std::vector<ValueType> _reversedB;
+        std::vector<ValueType> _buffer; // the last (filter size - 1) input samples, followed by the samples being processed
+
+        // Overlap-save state
+        FFTPlan<ValueType> _plan; // of size 0 if the filter is applied directly
+        std::vector<std::complex<ValueType>> _filterSpectrum;
+        std::vector<std::complex<ValueType>> _spectrum;
+        std::vector<ValueType> _result;
+    };
+} // namespace dsp
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace dsp
+{
+    template <typename ValueType>
+    FIRFilter<ValueType>::FIRFilter(std::vector<ValueType> b, size_t blockSize) :
+        _b(std::move(b)),
+        _blockSize(blockSize),
+        _plan(0)
+    {
+        Initialize();
+    }
+
+    template <typename ValueType>
+    void FIRFilter<ValueType>::Initialize()
+    {
+        const auto filterSize = _b.size();
+        _reversedB.assign(_b.rbegin(), _b.rend());
+        _plan = FFTPlan<ValueType>(0);
+        _filterSpectrum.clear();
+        _spectrum.clear();
+        _result.clear();
+
+        if (filterSize > _maxDirectFilterSize || (_blockSize > 0 && filterSize > 1))
+        {
+            // Each block of L new samples is transformed along with the previous M-1 samples, so the FFT size
+            // must be at least L+M-1. Without a requested block size, use an FFT of about 4 times the filter size.
+            auto minFFTSize = _blockSize > 0 ? _blockSize + filterSize - 1 : 4 * filterSize;
+            size_t fftSize = 2;
+            while (fftSize < minFFTSize)
+            {
+                fftSize *= 2;
+            }
+            _blockSize = fftSize - filterSize + 1;
+            _plan = FFTPlan<ValueType>(fftSize);
+
+            std::vector<ValueType> paddedFilter(fftSize, 0);
+            std::copy(_b.begin(), _b.end(), paddedFilter.begin());
+            _filterSpectrum.resize(fftSize);
+            _plan.TransformReal(paddedFilter.data(), _filterSpectrum.data());
+            _spectrum.resize(fftSize);
+            _result.resize(fftSize);
+        }
+        _buffer.assign(std::max(filterSize, _plan.Size()), static_cast<ValueType>(0));
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> FIRFilter<ValueType>::FilterSamples(const std::vector<ValueType>& x)
+    {
+        std::vector<ValueType> result(x.size());
+        FilterSamples(x.data(), x.size(), result.data());
+        return result;
+    }
+
+    template <typename ValueType>
+    void FIRFilter<ValueType>::FilterSamples(const ValueType* input, size_t count, ValueType* output)
+    {
+        if (_b.empty())
+        {
+            std::fill(output, output + count, static_cast<ValueType>(0));
+            return;
+        }
+
+        if (!UsesFFT())
+        {
+            FilterDirect(input, count, output);
+            return;
+        }
+
+        for (size_t start = 0; start < count; start += _blockSize)
+        {
+            // A transform costs the same however few new samples it processes, so short pieces are filtered directly
+            auto blockCount = std::min(_blockSize, count - start);
+            if (blockCount < _minFFTBlockSize)
+            {
+                FilterDirect(input + start, blockCount, output + start);
+            }
+            else
+            {
+                FilterBlock(input + start, blockCount, output + start);
+            }
+        }
+    }
+
+    template <typename ValueType>
+    void FIRFilter<ValueType>::FilterDirect(const ValueType* input, size_t count, ValueType* output)
+    {
+        const auto historySize = _b.size() - 1;
+        if (_buffer.size() < historySize + count)
+        {
+            _buffer.resize(historySize + count);
+        }
+        std::copy(input, input + count, _buffer.begin() + historySize);
+
+        // With the coefficients reversed, each output is a dot product with a contiguous window of the buffer
+        const auto coeffs = _reversedB.data();
+        for (size_t index = 0; index < count; ++index)
+        {
+            const auto window = _buffer.data() + index;
+            ValueType accum = 0;
+            for (size_t k = 0; k <= historySize; ++k)
+            {
+                accum += coeffs[k] * window[k];
+            }
+            output[index] = accum;
+        }
+
+        std::copy(_buffer.begin() + count, _buffer.begin() + count + historySize, _buffer.begin());
+    }
+
+    template <typename ValueType>
+    void FIRFilter<ValueType>::FilterBlock(const ValueType* input, size_t count, ValueType* output)
+    {
+        // The buffer holds the previous M-1 samples, then the new samples, then zero padding. After the
+        // circular convolution, the outputs from index M-1 on are free of wrap-around and are kept.
+        const auto historySize = _b.size() - 1;
+        const auto fftSize = _plan.Size();
+        std::copy(input, input + count, _buffer.begin() + historySize);
+        std::fill(_buffer.begin() + historySize + count, _buffer.end(), static_cast<ValueType>(0));
+
+        _plan.TransformReal(_buffer.data(), _spectrum.data());
+        for (size_t index = 0; index <= fftSize / 2; ++index)
+        {
+            const auto x = _spectrum[index];
+            const auto h = _filterSpectrum[index];
+            _spectrum[index] = { x.real() * h.real() - x.imag() * h.imag(), x.real() * h.imag() + x.imag() * h.real() };
+        }
+
+        // Keep the last M-1 input samples for the next block, then reuse the rest of the buffer for the result
+        std::copy(_buffer.begin() + count, _buffer.begin() + count + historySize, _buffer.begin());
+        _plan.InverseTransformReal(_spectrum.data(), _result.data());
+        std::copy(_result.begin() + historySize, _result.begin() + historySize + count, output);
+    }
+
+    template <typename ValueType>
+    void FIRFilter<ValueType>::Reset()
+    {
+        std::fill(_buffer.begin(), _buffer.end(), static_cast<ValueType>(0));
+    }
+
+    template <typename ValueType>
+    void FIRFilter<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        archiver["b"] << _b;
+        archiver["blockSize"] << _blockSize;
+    }
+
+    template <typename ValueType>
+    void FIRFilter<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        archiver["b"] >> _b;
+        archiver["blockSize"] >> _blockSize;
+        Initialize();
+    }
+} // namespace dsp
+} // namespace ell
+
+#pragma endregion implementation
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <math/include/Matrix.h>
+
 #include <utilities/include/Archiver.h>
 #include <utilities/include/IArchivable.h>
 
@@ -67,6 +69,11 @@ namespace dsp
         /// <returns> A dense array of filter coefficients. </returns>
         std::vector<double> ToArray() const;
 
+        /// <summary> Return the filter coefficients over the filter's nonzero support, from `GetStart()` up to `GetEnd()`. </summary>
+        ///
+        /// <returns> The filter coefficients from the start point to the endpoint of the filter. </returns>
+        std::vector<double> GetCoefficients() const;
+
     private:
         size_t _lowBin;
         size_t _centerBin;
@@ -87,6 +94,14 @@ namespace dsp
         template <typename ValueType>
         std::vector<ValueType> FilterFrequencyMagnitudes(const std::vector<ValueType>& frequencyMagnitudes) const;
 
+        /// <summary> Apply the filter bank to the real-valued magnitudes of the FFTs of many frames at once. </summary>
+        ///
+        /// <param name="frequencyMagnitudes"> The frequency magnitudes of each frame, one frame per row. </param>
+        ///
+        /// <returns> The filtered frequency magnitudes of each frame, one frame per row. </returns>
+        template <typename ValueType>
+        math::RowMatrix<ValueType> FilterFrequencyMagnitudes(math::ConstRowMatrixReference<ValueType> frequencyMagnitudes) const;
+
         /// <summary> Apply the filter bank to the output of an FFT, returning the filtered magnitudes of the frequencies. </summary>
         ///
         /// <param name="fourierCoefficients"> The array of fourier coefficients to apply the filters to. </param>
@@ -116,6 +131,10 @@ namespace dsp
         /// <summary> Return a `TriangleFilter` object representing one of the filters in the filter bank. </summary>
         TriangleFilter GetFilter(size_t filterIndex) const;
 
+        /// <summary> Return the coefficients of one of the filters in the filter bank over its nonzero support, which
+        /// begins at the filter's start point. </summary>
+        const std::vector<double>& GetFilterCoefficients(size_t filterIndex) const { return _coefficients[filterIndex]; }
+
         /// <summary> Get the length of the signal to filter. </summary>
         size_t GetWindowSize() const { return _windowSize; }
 
@@ -170,6 +189,7 @@ namespace dsp
         size_t _beginFilter = 0; // index of first filter to use
         size_t _endFilter = 0; // index of last filter to use
         std::vector<size_t> _bins;
+        std::vector<std::vector<double>> _coefficients; // the nonzero coefficients of each filter
         double _offset;
     };
 
@@ -0,0 +1,546 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FixedPoint.h (dsp)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace dsp
+{
+    /// <summary>
+    /// A signed fixed-point format: values are stored in `wordBits`-bit integers (16 or 32) with `fractionalBits`
+    /// bits after the binary point, so Q15 is { 16, 15 } and Q31 is { 32, 31 }. Values saturate symmetrically,
+    /// to +/- (2^(wordBits-1) - 1).
+    /// </summary>
+    struct FixedPointFormat
+    {
+        int wordBits = 16;
+        int fractionalBits = 15;
+
+        /// <summary> Returns the Q15 format. </summary>
+        static FixedPointFormat Q15() { return { 16, 15 }; }
+
+        /// <summary> Returns the Q31 format. </summary>
+        static FixedPointFormat Q31() { return { 32, 31 }; }
+
+        /// <summary> Parses a format name: "q15", "q31", or "qI.F" with I integer and F fractional bits, I + F + 1 being 16 or 32. </summary>
+        ///
+        /// <param name="name"> The format name, case-insensitive. </param>
+        ///
+        /// <returns> The format. </returns>
+        static FixedPointFormat Parse(const std::string& name);
+
+        /// <summary> Returns the name of the format, in the form "qI.F", or "q15" and "q31" for those formats. </summary>
+        std::string ToString() const;
+
+        /// <summary> Returns the largest stored value, 2^(wordBits-1) - 1. </summary>
+        int64_t MaxValue() const { return (int64_t{ 1 } << (wordBits - 1)) - 1; }
+
+        /// <summary>
+        /// Returns the number of bits of the coefficients (filter taps, window values, DCT matrix entries) used with
+        /// data in this format. Q31 data uses 24-bit coefficients, leaving headroom in the 64-bit accumulators.
+        /// </summary>
+        int CoefficientBits() const { return wordBits < 24 ? wordBits : 24; }
+    };
+
+    bool operator==(const FixedPointFormat& a, const FixedPointFormat& b);
+    bool operator!=(const FixedPointFormat& a, const FixedPointFormat& b);
+
+    /// <summary> Fixed-point coefficients with the number of fractional bits they share. </summary>
+    struct FixedPointCoefficients
+    {
+        std::vector<int32_t> values;
+        int fractionalBits = 0;
+    };
+
+    /// <summary> Saturates a value to the range of a `wordBits`-bit fixed-point format. </summary>
+    int32_t SaturateFixedPoint(int64_t value, int wordBits);
+
+    /// <summary> Shifts a value right by `shift` bits, rounding half up. A negative shift shifts left. </summary>
+    int64_t RoundingShiftRight(int64_t value, int shift);
+
+    /// <summary> Converts a value to fixed point, rounding half away from zero and saturating. </summary>
+    ///
+    /// <param name="value"> The value to convert. </param>
+    /// <param name="wordBits"> The number of bits of the result. </param>
+    /// <param name="fractionalBits"> The number of fractional bits of the result. </param>
+    ///
+    /// <returns> The fixed-point value. </returns>
+    template <typename ValueType>
+    int32_t ToFixedPoint(ValueType value, int wordBits, int fractionalBits);
+
+    /// <summary> Converts a value to fixed point, rounding half away from zero and saturating. </summary>
+    template <typename ValueType>
+    int32_t ToFixedPoint(ValueType value, const FixedPointFormat& format);
+
+    /// <summary> Converts a vector of values to fixed point. </summary>
+    template <typename ValueType>
+    std::vector<int32_t> ToFixedPoint(const std::vector<ValueType>& values, const FixedPointFormat& format);
+
+    /// <summary> Converts a fixed-point value, or a 64-bit accumulator of products, back to floating point. </summary>
+    ///
+    /// <param name="value"> The fixed-point value. </param>
+    /// <param name="fractionalBits"> The number of fractional bits of the value. May be negative. </param>
+    ///
+    /// <returns> The value, computed as `double(value) * 2^-fractionalBits` and then converted to `ValueType`. </returns>
+    template <typename ValueType>
+    ValueType FromFixedPoint(int64_t value, int fractionalBits);
+
+    /// <summary>
+    /// Quantizes coefficients to `wordBits`-bit integers, choosing the number of fractional bits so that the
+    /// coefficient of largest magnitude uses the whole range.
+    /// </summary>
+    template <typename ValueType>
+    FixedPointCoefficients QuantizeCoefficients(const std::vector<ValueType>& coefficients, int wordBits);
+
+    /// <summary> Returns the sum of the products of two fixed-point vectors, as a 64-bit accumulator. </summary>
+    int64_t FixedPointDotProduct(const int32_t* a, const int32_t* b, size_t size);
+
+    /// <summary> Returns floor(sqrt(value)) of a nonnegative value, computed bit by bit. </summary>
+    int64_t IntegerSquareRoot(int64_t value);
+
+    /// <summary>
+    /// A radix-2 FFT on fixed-point data, with block floating-point scaling: before each butterfly stage the whole
+    /// block is shifted right by 0, 1 or 2 bits, so that it stays below 2^(wordBits-3) and the stage can't
+    /// overflow, and the shifts are accumulated in a block exponent. The twiddle factors are in Q(wordBits-1).
+    /// </summary>
+    class FixedPointFFTPlan
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="size"> The FFT size. Must be a power of 2. </param>
+        /// <param name="wordBits"> The number of bits of the data, 16 or 32. </param>
+        FixedPointFFTPlan(size_t size, int wordBits);
+
+        /// <summary> Returns the FFT size. </summary>
+        size_t Size() const { return _size; }
+
+        /// <summary> Returns the number of bits of the data. </summary>
+        int WordBits() const { return _wordBits; }
+
+        /// <summary> Returns the real parts of the twiddle factors. The stage producing transforms of size 2h uses the h values at offset h-1. </summary>
+        const std::vector<int32_t>& GetRealTwiddleFactors() const { return _twiddleReal; }
+
+        /// <summary> Returns the imaginary parts of the twiddle factors, stored like the real parts. </summary>
+        const std::vector<int32_t>& GetImaginaryTwiddleFactors() const { return _twiddleImag; }
+
+        /// <summary> Returns the bit-reversal permutation of the indices 0 to N-1. </summary>
+        const std::vector<int>& GetBitReversalPermutation() const { return _bitReversal; }
+
+        /// <summary> Returns the block exponent increment, 0, 1 or 2, for a block whose largest magnitude is `maxMagnitude`. </summary>
+        int GetBlockShift(int64_t maxMagnitude) const;
+
+        /// <summary> Performs an in-place complex-valued FFT. </summary>
+        ///
+        /// <param name="real"> The N real parts of the signal. </param>
+        /// <param name="imag"> The N imaginary parts of the signal. </param>
+        ///
+        /// <returns> The block exponent: the result is the transform divided by 2^exponent. </returns>
+        int Transform(int32_t* real, int32_t* imag) const;
+
+        /// <summary> Computes the magnitudes of the first N/2 bins of the FFT of a real-valued signal. </summary>
+        ///
+        /// <param name="signal"> The signal, zero-padded or truncated to the FFT size. </param>
+        /// <param name="fractionalBits"> The number of fractional bits of the signal. </param>
+        ///
+        /// <returns> The N/2 magnitudes, converted to floating point. </returns>
+        template <typename ValueType>
+        std::vector<ValueType> TransformMagnitudes(const std::vector<int32_t>& signal, int fractionalBits) const;
+
+    private:
+        size_t _size;
+        int _wordBits;
+        std::vector<int32_t> _twiddleReal;
+        std::vector<int32_t> _twiddleImag;
+        std::vector<int> _bitReversal;
+    };
+
+    /// <summary>
+    /// An IIR filter on fixed-point data (see `IIRFilter` for the coefficients). The products are accumulated in
+    /// 64 bits and each output is rounded and saturated to the data format, and fed back.
+    /// </summary>
+    class FixedPointIIRFilter
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="b"> The feedforward coefficients. </param>
+        /// <param name="a"> The feedback coefficients, not including a0. </param>
+        /// <param name="format"> The format of the data. </param>
+        template <typename ValueType>
+        FixedPointIIRFilter(const std::vector<ValueType>& b, const std::vector<ValueType>& a, const FixedPointFormat& format);
+
+        /// <summary> Filters a new input sample. </summary>
+        int32_t FilterSample(int32_t x);
+
+        /// <summary> Resets the state of the filter to zero. </summary>
+        void Reset();
+
+        /// <summary> Returns the quantized feedforward coefficients. </summary>
+        const std::vector<int32_t>& GetFeedforwardCoefficients() const { return _b; }
+
+        /// <summary> Returns the quantized feedback coefficients. </summary>
+        const std::vector<int32_t>& GetRecursiveCoefficients() const { return _a; }
+
+        /// <summary> Returns the number of fractional bits of the coefficients. </summary>
+        int GetCoefficientFractionalBits() const { return _coefficientFractionalBits; }
+
+    private:
+        FixedPointFormat _format;
+        std::vector<int32_t> _b;
+        std::vector<int32_t> _a;
+        int _coefficientFractionalBits;
+        std::vector<int32_t> _previousInput; // most recent first
+        std::vector<int32_t> _previousOutput; // most recent first
+    };
+} // namespace dsp
+} // namespace ell
+
+#pragma region implementation
+
+#include "FFT.h"
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <complex>
+
+namespace ell
+{
+namespace dsp
+{
+    inline FixedPointFormat FixedPointFormat::Parse(const std::string& name)
+    {
+        std::string lower;
+        for (auto c : name)
+        {
+            lower.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        }
+
+        FixedPointFormat format{ 0, 0 };
+        try
+        {
+            if (lower.size() < 2 || lower[0] != 'q')
+            {
+                throw std::invalid_argument(name);
+            }
+            auto dot = lower.find('.');
+            if (dot == std::string::npos)
+            {
+                format.fractionalBits = std::stoi(lower.substr(1));
+                format.wordBits = format.fractionalBits + 1;
+            }
+            else
+            {
+                auto integerBits = std::stoi(lower.substr(1, dot - 1));
+                format.fractionalBits = std::stoi(lower.substr(dot + 1));
+                format.wordBits = integerBits + format.fractionalBits + 1;
+                if (integerBits < 0)
+                {
+                    throw std::invalid_argument(name);
+                }
+            }
+        }
+        catch (const std::exception&)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::badStringFormat, "Invalid fixed-point format '" + name + "', expected q15, q31 or qI.F");
+        }
+
+        if ((format.wordBits != 16 && format.wordBits != 32) || format.fractionalBits < 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Fixed-point format '" + name + "' must have 16 or 32 bits");
+        }
+        return format;
+    }
+
+    inline std::string FixedPointFormat::ToString() const
+    {
+        if (fractionalBits == wordBits - 1)
+        {
+            return "q" + std::to_string(fractionalBits);
+        }
+        return "q" + std::to_string(wordBits - 1 - fractionalBits) + "." + std::to_string(fractionalBits);
+    }
+
+    inline bool operator==(const FixedPointFormat& a, const FixedPointFormat& b)
+    {
+        return a.wordBits == b.wordBits && a.fractionalBits == b.fractionalBits;
+    }
+
+    inline bool operator!=(const FixedPointFormat& a, const FixedPointFormat& b)
+    {
+        return !(a == b);
+    }
+
+    inline int32_t SaturateFixedPoint(int64_t value, int wordBits)
+    {
+        const auto maxValue = (int64_t{ 1 } << (wordBits - 1)) - 1;
+        return static_cast<int32_t>(std::min(std::max(value, -maxValue), maxValue));
+    }
+
+    inline int64_t RoundingShiftRight(int64_t value, int shift)
+    {
+        if (shift <= 0)
+        {
+            return value * (int64_t{ 1 } << -shift);
+        }
+        return (value + (int64_t{ 1 } << (shift - 1))) >> shift;
+    }
+
+    template <typename ValueType>
+    int32_t ToFixedPoint(ValueType value, int wordBits, int fractionalBits)
+    {
+        // The compiled nodes do the same operations on doubles, so the results match exactly
+        const auto maxValue = static_cast<double>((int64_t{ 1 } << (wordBits - 1)) - 1);
+        auto scaled = static_cast<double>(value) * std::ldexp(1.0, fractionalBits);
+        scaled += scaled < 0 ? -0.5 : 0.5;
+        scaled = std::min(std::max(scaled, -maxValue), maxValue);
+        return static_cast<int32_t>(static_cast<int64_t>(scaled));
+    }
+
+    template <typename ValueType>
+    int32_t ToFixedPoint(ValueType value, const FixedPointFormat& format)
+    {
+        return ToFixedPoint(value, format.wordBits, format.fractionalBits);
+    }
+
+    template <typename ValueType>
+    std::vector<int32_t> ToFixedPoint(const std::vector<ValueType>& values, const FixedPointFormat& format)
+    {
+        std::vector<int32_t> result(values.size());
+        std::transform(values.begin(), values.end(), result.begin(), [&format](ValueType value) { return ToFixedPoint(value, format); });
+        return result;
+    }
+
+    template <typename ValueType>
+    ValueType FromFixedPoint(int64_t value, int fractionalBits)
+    {
+        return static_cast<ValueType>(static_cast<double>(value) * std::ldexp(1.0, -fractionalBits));
+    }
+
+    template <typename ValueType>
+    FixedPointCoefficients QuantizeCoefficients(const std::vector<ValueType>& coefficients, int wordBits)
+    {
+        double maxMagnitude = 0;
+        for (auto c : coefficients)
+        {
+            maxMagnitude = std::max(maxMagnitude, std::abs(static_cast<double>(c)));
+        }
+
+        // The number of integer bits: the smallest with maxMagnitude < 2^integerBits
+        int integerBits = 0;
+        if (maxMagnitude > 0)
+        {
+            while (maxMagnitude >= std::ldexp(1.0, integerBits))
+            {
+                ++integerBits;
+            }
+            while (integerBits > 1 - wordBits && maxMagnitude < std::ldexp(1.0, integerBits - 1))
+            {
+                --integerBits;
+            }
+        }
+
+        FixedPointCoefficients result;
+        result.fractionalBits = wordBits - 1 - integerBits;
+        result.values.reserve(coefficients.size());
+        for (auto c : coefficients)
+        {
+            result.values.push_back(ToFixedPoint(c, wordBits, result.fractionalBits));
+        }
+        return result;
+    }
+
+    inline int64_t FixedPointDotProduct(const int32_t* a, const int32_t* b, size_t size)
+    {
+        int64_t sum = 0;
+        for (size_t index = 0; index < size; ++index)
+        {
+            sum += static_cast<int64_t>(a[index]) * b[index];
+        }
+        return sum;
+    }
+
+    inline int64_t IntegerSquareRoot(int64_t value)
+    {
+        int64_t result = 0;
+        for (int index = 0; index < 32; ++index)
+        {
+            const auto bit = int64_t{ 1 } << (62 - 2 * index);
+            const auto trial = result + bit;
+            if (value >= trial)
+            {
+                value -= trial;
+                result = (result >> 1) + bit;
+            }
+            else
+            {
+                result >>= 1;
+            }
+        }
+        return result;
+    }
+
+    //
+    // FixedPointFFTPlan
+    //
+    inline FixedPointFFTPlan::FixedPointFFTPlan(size_t size, int wordBits) :
+        _size(size),
+        _wordBits(wordBits)
+    {
+        if (wordBits != 16 && wordBits != 32)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Fixed-point FFT data must have 16 or 32 bits");
+        }
+
+        FFTPlan<double> plan(size);
+        _twiddleReal.resize(size > 0 ? size - 1 : 0);
+        _twiddleImag.resize(_twiddleReal.size());
+        for (size_t halfLength = 1; halfLength < size; halfLength *= 2)
+        {
+            auto twiddles = plan.GetTwiddleFactors(2 * halfLength);
+            for (size_t k = 0; k < halfLength; ++k)
+            {
+                _twiddleReal[halfLength - 1 + k] = ToFixedPoint(twiddles[k].real(), wordBits, wordBits - 1);
+                _twiddleImag[halfLength - 1 + k] = ToFixedPoint(twiddles[k].imag(), wordBits, wordBits - 1);
+            }
+        }
+
+        const auto& bitReversal = plan.GetBitReversalPermutation();
+        _bitReversal.assign(bitReversal.begin(), bitReversal.end());
+    }
+
+    inline int FixedPointFFTPlan::GetBlockShift(int64_t maxMagnitude) const
+    {
+        return (maxMagnitude >= (int64_t{ 1 } << (_wordBits - 3)) ? 1 : 0) + (maxMagnitude >= (int64_t{ 1 } << (_wordBits - 2)) ? 1 : 0);
+    }
+
+    inline int FixedPointFFTPlan::Transform(int32_t* real, int32_t* imag) const
+    {
+        for (size_t index = 0; index < _size; ++index)
+        {
+            auto reversed = static_cast<size_t>(_bitReversal[index]);
+            if (reversed > index)
+            {
+                std::swap(real[index], real[reversed]);
+                std::swap(imag[index], imag[reversed]);
+            }
+        }
+
+        int exponent = 0;
+        for (size_t halfLength = 1; halfLength < _size; halfLength *= 2)
+        {
+            int64_t maxMagnitude = 0;
+            for (size_t index = 0; index < _size; ++index)
+            {
+                maxMagnitude = std::max(maxMagnitude, std::abs(static_cast<int64_t>(real[index])));
+                maxMagnitude = std::max(maxMagnitude, std::abs(static_cast<int64_t>(imag[index])));
+            }
+            auto shift = GetBlockShift(maxMagnitude);
+            for (size_t index = 0; index < _size; ++index)
+            {
+                real[index] >>= shift;
+                imag[index] >>= shift;
+            }
+            exponent += shift;
+
+            // With the block below 2^(wordBits-3), neither the products nor the sums can overflow
+            const auto twiddleReal = _twiddleReal.data() + halfLength - 1;
+            const auto twiddleImag = _twiddleImag.data() + halfLength - 1;
+            for (size_t start = 0; start < _size; start += 2 * halfLength)
+            {
+                for (size_t k = 0; k < halfLength; ++k)
+                {
+                    auto top = start + k;
+                    auto bottom = top + halfLength;
+                    auto tReal = static_cast<int32_t>(RoundingShiftRight(static_cast<int64_t>(twiddleReal[k]) * real[bottom] - static_cast<int64_t>(twiddleImag[k]) * imag[bottom], _wordBits - 1));
+                    auto tImag = static_cast<int32_t>(RoundingShiftRight(static_cast<int64_t>(twiddleReal[k]) * imag[bottom] + static_cast<int64_t>(twiddleImag[k]) * real[bottom], _wordBits - 1));
+                    real[bottom] = real[top] - tReal;
+                    imag[bottom] = imag[top] - tImag;
+                    real[top] += tReal;
+                    imag[top] += tImag;
+                }
+            }
+        }
+        return exponent;
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> FixedPointFFTPlan::TransformMagnitudes(const std::vector<int32_t>& signal, int fractionalBits) const
+    {
+        std::vector<int32_t> real(signal.begin(), signal.begin() + std::min(signal.size(), _size));
+        real.resize(_size);
+        std::vector<int32_t> imag(_size);
+        auto exponent = Transform(real.data(), imag.data());
+
+        std::vector<ValueType> result(_size / 2);
+        const auto blockScale = static_cast<double>(int64_t{ 1 } << exponent);
+        const auto scale = std::ldexp(1.0, -fractionalBits);
+        for (size_t index = 0; index < result.size(); ++index)
+        {
+            auto magnitude = IntegerSquareRoot(static_cast<int64_t>(real[index]) * real[index] + static_cast<int64_t>(imag[index]) * imag[index]);
+            result[index] = static_cast<ValueType>(static_cast<double>(magnitude) * blockScale * scale);
+        }
+        return result;
+    }
+
+    //
+    // FixedPointIIRFilter
+    //
+    template <typename ValueType>
+    FixedPointIIRFilter::FixedPointIIRFilter(const std::vector<ValueType>& b, const std::vector<ValueType>& a, const FixedPointFormat& format) :
+        _format(format),
+        _previousInput(b.size()),
+        _previousOutput(a.size())
+    {
+        // The feedforward and feedback coefficients share their fractional bits, so their products can be summed
+        std::vector<ValueType> coefficients(b);
+        coefficients.insert(coefficients.end(), a.begin(), a.end());
+        auto quantized = QuantizeCoefficients(coefficients, format.CoefficientBits());
+        _b.assign(quantized.values.begin(), quantized.values.begin() + b.size());
+        _a.assign(quantized.values.begin() + b.size(), quantized.values.end());
+        _coefficientFractionalBits = quantized.fractionalBits;
+    }
+
+    inline int32_t FixedPointIIRFilter::FilterSample(int32_t x)
+    {
+        if (_previousInput.empty())
+        {
+            return 0;
+        }
+
+        std::rotate(_previousInput.rbegin(), _previousInput.rbegin() + 1, _previousInput.rend());
+        _previousInput[0] = x;
+        int64_t sum = FixedPointDotProduct(_b.data(), _previousInput.data(), _b.size());
+        sum -= FixedPointDotProduct(_a.data(), _previousOutput.data(), _a.size());
+        auto y = SaturateFixedPoint(RoundingShiftRight(sum, _coefficientFractionalBits), _format.wordBits);
+        if (!_previousOutput.empty())
+        {
+            std::rotate(_previousOutput.rbegin(), _previousOutput.rbegin() + 1, _previousOutput.rend());
+            _previousOutput[0] = y;
+        }
+        return y;
+    }
+
+    inline void FixedPointIIRFilter::Reset()
+    {
+        std::fill(_previousInput.begin(), _previousInput.end(), 0);
+        std::fill(_previousOutput.begin(), _previousOutput.end(), 0);
+    }
+} // namespace dsp
+} // namespace ell
+
+#pragma endregion implementation
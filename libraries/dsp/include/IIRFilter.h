@@ -55,6 +55,13 @@ namespace dsp
         /// <returns> The next output samples from the filter </returns>
         std::vector<ValueType> FilterSamples(const std::vector<ValueType>& x);
 
+        /// <summary> Filter a sequence of input samples. <summary>
+        ///
+        /// <param name="input"> The new input samples to process. <param>
+        /// <param name="count"> The number of samples to process. <param>
+        /// <param name="output"> The buffer to receive the next `count` output samples from the filter. May be the same as `input`. <param>
+        void FilterSamples(const ValueType* input, size_t count, ValueType* output);
+
         /// <summary> Reset the internal state of the filter to zero. </summary>
         void Reset();
 
@@ -134,12 +141,19 @@ namespace dsp
     std::vector<ValueType> IIRFilter<ValueType>::FilterSamples(const std::vector<ValueType>& x)
     {
         std::vector<ValueType> result(x.size());
-        std::transform(x.begin(), x.end(), result.begin(), [this](ValueType elem) {
-            return FilterSample(elem);
-        });
+        FilterSamples(x.data(), x.size(), result.data());
         return result;
     }
 
+    template <typename ValueType>
+    void IIRFilter<ValueType>::FilterSamples(const ValueType* input, size_t count, ValueType* output)
+    {
+        for (size_t index = 0; index < count; ++index)
+        {
+            output[index] = FilterSample(input[index]);
+        }
+    }
+
     template <typename ValueType>
     void IIRFilter<ValueType>::Reset()
     {
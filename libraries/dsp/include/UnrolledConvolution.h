@@ -47,7 +47,15 @@ namespace dsp
     template <typename ValueType>
     math::ChannelColumnRowTensor<ValueType> Convolve2DUnrolled(const math::ConstChannelColumnRowTensorReference<ValueType>& input, const math::ConstChannelColumnRowTensorReference<ValueType>& filters, int numFilters, int stride);
 
+    /// <summary> Reshapes the receptive fields of a 3D image into the columns of a matrix, so that convolving with
+    /// a stack of filters becomes a matrix product. </summary>
+    ///
+    /// <param name="input"> The input image: a (r x c x d) tensor. </param>
+    /// <param name="filterSize"> The width and height of the filters. </param>
+    /// <param name="stride"> The number of elements to move/jump when sliding over the input. </param>
+    /// <param name="shapedInput"> The matrix to fill in, of size (filterSize*filterSize*d) x (outputRows*outputColumns). It may be
+    /// a block of the columns of a larger matrix, which lets several images share one matrix product. </param>
     template <typename ValueType>
-    void ReceptiveFieldToColumns(math::ConstChannelColumnRowTensorReference<ValueType> input, int filterSize, int stride, math::RowMatrix<ValueType>& shapedInput);
+    void ReceptiveFieldToColumns(math::ConstChannelColumnRowTensorReference<ValueType> input, int filterSize, int stride, math::RowMatrixReference<ValueType> shapedInput);
 } // namespace dsp
 } // namespace ell
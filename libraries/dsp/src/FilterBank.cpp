@@ -82,6 +82,21 @@ namespace dsp
         return result;
     }
 
+    std::vector<double> TriangleFilter::GetCoefficients() const
+    {
+        std::vector<double> result;
+        result.reserve(_highBin - _lowBin);
+        for (size_t freqIndex = _lowBin; freqIndex < _centerBin; ++freqIndex) // between lo and center
+        {
+            result.push_back((freqIndex - _lowBin + _offset) / (_centerBin - _lowBin));
+        }
+        for (size_t freqIndex = _centerBin; freqIndex < _highBin; ++freqIndex) // between center and hi
+        {
+            result.push_back((_highBin - freqIndex - _offset) / (_highBin - _centerBin));
+        }
+        return result;
+    }
+
     //
     // TriangleFilterBank
     //
@@ -155,20 +170,56 @@ namespace dsp
         //        N/2
         // Y[i] = sum((|X[k]| sqrt(H_i[k]) ^ 2)
         //        k = 0
+        // Each filter is only nonzero between its start and end, so only those coefficients are stored and multiplied
         auto numOutputs = _endFilter - _beginFilter;
         std::vector<ValueType> result(numOutputs);
         for (size_t filterIndex = _beginFilter; filterIndex < _endFilter; ++filterIndex)
         {
-            auto filter = GetFilter(filterIndex);
-            const size_t begin = filter.GetStart();
-            const size_t end = filter.GetEnd();
+            const auto& coefficients = _coefficients[filterIndex];
+            const auto* magnitudes = frequencyMagnitudes.data() + _bins[filterIndex];
             ValueType sum = 0;
-            for (size_t k = begin; k < end; ++k)
+            for (size_t k = 0; k < coefficients.size(); ++k)
             {
-                sum += static_cast<ValueType>(frequencyMagnitudes[k] * filter[k]);
+                sum += static_cast<ValueType>(magnitudes[k] * coefficients[k]);
             }
 
-            result[filterIndex] = sum;
+            result[filterIndex - _beginFilter] = sum;
+        }
+        return result;
+    }
+
+    template <typename ValueType>
+    math::RowMatrix<ValueType> TriangleFilterBank::FilterFrequencyMagnitudes(math::ConstRowMatrixReference<ValueType> frequencyMagnitudes) const
+    {
+        // Convert the coefficients once for all the frames, and lay them out end to end
+        std::vector<ValueType> coefficients;
+        std::vector<size_t> coefficientOffsets;
+        for (size_t filterIndex = _beginFilter; filterIndex < _endFilter; ++filterIndex)
+        {
+            coefficientOffsets.push_back(coefficients.size());
+            coefficients.insert(coefficients.end(), _coefficients[filterIndex].begin(), _coefficients[filterIndex].end());
+        }
+        coefficientOffsets.push_back(coefficients.size());
+
+        const auto numFrames = frequencyMagnitudes.NumRows();
+        const auto numOutputs = _endFilter - _beginFilter;
+        math::RowMatrix<ValueType> result(numFrames, numOutputs);
+        for (size_t frame = 0; frame < numFrames; ++frame)
+        {
+            const auto* frameMagnitudes = frequencyMagnitudes.GetRow(frame).GetConstDataPointer();
+            auto* frameResult = result.GetRow(frame).GetDataPointer();
+            for (size_t output = 0; output < numOutputs; ++output)
+            {
+                const auto* magnitudes = frameMagnitudes + _bins[_beginFilter + output];
+                const auto* filterCoefficients = coefficients.data() + coefficientOffsets[output];
+                const auto length = coefficientOffsets[output + 1] - coefficientOffsets[output];
+                ValueType sum = 0;
+                for (size_t k = 0; k < length; ++k)
+                {
+                    sum += magnitudes[k] * filterCoefficients[k];
+                }
+                frameResult[output] = sum;
+            }
         }
         return result;
     }
@@ -207,6 +258,12 @@ namespace dsp
                     utilities::FormatString("TriangleFilterBank::SetBins received a value %d that is outside the _windowSize %d", (int)v, (int)_windowSize));
             }
         }
+
+        _coefficients.clear();
+        for (size_t filterIndex = 0; filterIndex < _numFilters; ++filterIndex)
+        {
+            _coefficients.push_back(GetFilter(filterIndex).GetCoefficients());
+        }
     }
 
     //
@@ -322,6 +379,8 @@ namespace dsp
     //
     template std::vector<float> TriangleFilterBank::FilterFrequencyMagnitudes<float>(const std::vector<float>&) const;
     template std::vector<double> TriangleFilterBank::FilterFrequencyMagnitudes<double>(const std::vector<double>&) const;
+    template math::RowMatrix<float> TriangleFilterBank::FilterFrequencyMagnitudes<float>(math::ConstRowMatrixReference<float>) const;
+    template math::RowMatrix<double> TriangleFilterBank::FilterFrequencyMagnitudes<double>(math::ConstRowMatrixReference<double>) const;
     template std::vector<float> TriangleFilterBank::FilterFourierCoefficients(const std::vector<std::complex<float>>& fourierCoefficients) const;
     template std::vector<double> TriangleFilterBank::FilterFourierCoefficients(const std::vector<std::complex<double>>& fourierCoefficients) const;
     template std::vector<float> TriangleFilterBank::FilterFourierCoefficientsFast(const std::vector<std::complex<float>>& fourierCoefficients) const;
@@ -97,7 +97,7 @@ namespace dsp
     }
 
     template <typename ValueType>
-    void ReceptiveFieldToColumns(math::ConstChannelColumnRowTensorReference<ValueType> input, int filterSize, int stride, math::RowMatrix<ValueType>& shapedInput)
+    void ReceptiveFieldToColumns(math::ConstChannelColumnRowTensorReference<ValueType> input, int filterSize, int stride, math::RowMatrixReference<ValueType> shapedInput)
     {
         const auto numChannels = static_cast<int>(input.NumChannels());
         const auto fieldVolumeSize = filterSize * filterSize * numChannels;
@@ -108,25 +108,24 @@ namespace dsp
             throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "shapedInput matrix must be of dimension (filterSize*filterSize*numChannels) x (outputRows*outputColumns)");
         }
 
+        // Walk the input through its data pointer: channels are contiguous, and columns and rows are a fixed increment apart
+        const auto pInput = input.GetConstDataPointer();
+        const auto columnIncrement = static_cast<int>(input.GetIncrement1());
+        const auto rowIncrement = static_cast<int>(input.GetIncrement2());
         for (int f = 0; f < fieldVolumeSize; f++)
         {
             const auto fieldDepth = f % numChannels;
             const auto fieldColumn = (f / numChannels) % filterSize;
             const auto fieldRow = (f / numChannels) / filterSize;
 
-            int rowOffset = 0;
+            auto pShapedInputRow = shapedInput.GetDataPointer() + f * shapedInput.GetIncrement();
             for (int h = 0; h < numOutputRows; h++)
             {
-                int colOffset = 0;
+                const auto pInputRow = pInput + (h * stride + fieldRow) * rowIncrement + fieldColumn * columnIncrement + fieldDepth;
                 for (int w = 0; w < numOutputColumns; w++)
                 {
-                    auto input_row = rowOffset + fieldRow;
-                    auto input_col = colOffset + fieldColumn;
-
-                    shapedInput(f, h * numOutputColumns + w) = input(input_row, input_col, fieldDepth);
-                    colOffset += stride;
+                    pShapedInputRow[h * numOutputColumns + w] = pInputRow[w * stride * columnIncrement];
                 }
-                rowOffset += stride;
             }
         }
     }
@@ -141,7 +140,7 @@ namespace dsp
     template math::ChannelColumnRowTensor<float> Convolve2DUnrolled(const math::ConstChannelColumnRowTensorReference<float>& input, const math::ConstChannelColumnRowTensorReference<float>& filters, int numFilters, int stride);
     template math::ChannelColumnRowTensor<double> Convolve2DUnrolled(const math::ConstChannelColumnRowTensorReference<double>& input, const math::ConstChannelColumnRowTensorReference<double>& filters, int numFilters, int stride);
 
-    template void ReceptiveFieldToColumns(math::ConstChannelColumnRowTensorReference<float> input, int filterSize, int stride, math::RowMatrix<float>& shapedInput);
-    template void ReceptiveFieldToColumns(math::ConstChannelColumnRowTensorReference<double> input, int filterSize, int stride, math::RowMatrix<double>& shapedInput);
+    template void ReceptiveFieldToColumns(math::ConstChannelColumnRowTensorReference<float> input, int filterSize, int stride, math::RowMatrixReference<float> shapedInput);
+    template void ReceptiveFieldToColumns(math::ConstChannelColumnRowTensorReference<double> input, int filterSize, int stride, math::RowMatrixReference<double> shapedInput);
 } // namespace dsp
 } // namespace ell
@@ -406,6 +406,36 @@ namespace dsp
     //       0   1   1   4   4   0
     //       0   1  -1   8  -8   1
     //
+    //
+    // For F(6,3)
+    //
+    //      1     0  -21/4      0   21/4      0    -1   0
+    //      0     1      1  -17/4  -17/4      1     1   0
+    //      0    -1      1   17/4  -17/4     -1     1   0
+    // B' = 0   1/2    1/4   -5/2   -5/4      2     1   0
+    //      0  -1/2    1/4    5/2   -5/4     -2     1   0
+    //      0     2      4   -5/2     -5    1/2     1   0
+    //      0    -2      4    5/2     -5   -1/2     1   0
+    //      0    -1      0   21/4      0  -21/4     0   1
+    //
+    //
+    //          1       0      0
+    //       -2/9    -2/9   -2/9
+    //       -2/9     2/9   -2/9
+    // G =   1/90    1/45   2/45
+    //       1/90   -1/45   2/45
+    //      32/45   16/45   8/45
+    //      32/45  -16/45   8/45
+    //          0       0      1
+    //
+    //
+    //       1   1   1    1    1     1      1   0
+    //       0   1  -1    2   -2   1/2   -1/2   0
+    // A' =  0   1   1    4    4   1/4    1/4   0
+    //       0   1  -1    8   -8   1/8   -1/8   0
+    //       0   1   1   16   16  1/16   1/16   0
+    //       0   1  -1   32  -32  1/32  -1/32   1
+    //
 
     /// <summary> Gets the data-transforming matrix for Winograd convolution (commonly notated as B') </summary>
     template <typename ValueType>
@@ -431,6 +461,19 @@ namespace dsp
                                            { 0,  4,  0, -5,  0,  1 } });
             // clang-format on
         }
+        if (tileSize == 6 && filterSize == 3)
+        {
+            // clang-format off
+            return MakeMatrix<ValueType>({ { 1.0,      0.0, -21.0 / 4,       0.0,  21.0 / 4,       0.0, -1.0, 0.0 },
+                                           { 0.0,      1.0,       1.0, -17.0 / 4, -17.0 / 4,       1.0,  1.0, 0.0 },
+                                           { 0.0,     -1.0,       1.0,  17.0 / 4, -17.0 / 4,      -1.0,  1.0, 0.0 },
+                                           { 0.0,  1.0 / 2,   1.0 / 4,  -5.0 / 2,  -5.0 / 4,       2.0,  1.0, 0.0 },
+                                           { 0.0, -1.0 / 2,   1.0 / 4,   5.0 / 2,  -5.0 / 4,      -2.0,  1.0, 0.0 },
+                                           { 0.0,      2.0,       4.0,  -5.0 / 2,      -5.0,   1.0 / 2,  1.0, 0.0 },
+                                           { 0.0,     -2.0,       4.0,   5.0 / 2,      -5.0,  -1.0 / 2,  1.0, 0.0 },
+                                           { 0.0,     -1.0,       0.0,  21.0 / 4,       0.0, -21.0 / 4,  0.0, 1.0 } });
+            // clang-format on
+        }
         throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
     }
 
@@ -464,6 +507,19 @@ namespace dsp
                                            {       0.0,       0.0,      1.0 } });
             // clang-format on
         }
+        if (tileSize == 6 && filterSize == 3)
+        {
+            // clang-format off
+            return MakeMatrix<ValueType>({ {       1.0,        0.0,      0.0 },
+                                           {  -2.0 / 9,   -2.0 / 9, -2.0 / 9 },
+                                           {  -2.0 / 9,    2.0 / 9, -2.0 / 9 },
+                                           {  1.0 / 90,   1.0 / 45, 2.0 / 45 },
+                                           {  1.0 / 90,  -1.0 / 45, 2.0 / 45 },
+                                           { 32.0 / 45,  16.0 / 45, 8.0 / 45 },
+                                           { 32.0 / 45, -16.0 / 45, 8.0 / 45 },
+                                           {       0.0,        0.0,      1.0 } });
+            // clang-format on
+        }
         throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
     }
 
@@ -493,6 +549,17 @@ namespace dsp
                                            { 0,  1, -1,  8, -8,  1 } });
             // clang-format on
         }
+        if (tileSize == 6 && filterSize == 3)
+        {
+            // clang-format off
+            return MakeMatrix<ValueType>({ { 1.0, 1.0,  1.0,  1.0,   1.0,      1.0,       1.0, 0.0 },
+                                           { 0.0, 1.0, -1.0,  2.0,  -2.0,  1.0 / 2,  -1.0 / 2, 0.0 },
+                                           { 0.0, 1.0,  1.0,  4.0,   4.0,  1.0 / 4,   1.0 / 4, 0.0 },
+                                           { 0.0, 1.0, -1.0,  8.0,  -8.0,  1.0 / 8,  -1.0 / 8, 0.0 },
+                                           { 0.0, 1.0,  1.0, 16.0,  16.0, 1.0 / 16,  1.0 / 16, 0.0 },
+                                           { 0.0, 1.0, -1.0, 32.0, -32.0, 1.0 / 32, -1.0 / 32, 1.0 } });
+            // clang-format on
+        }
         throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
     }
 
@@ -959,6 +1026,168 @@ namespace dsp
         }
     };
 
+    // F(6,3)
+    //
+    // The expanded transforms for this size are too long to write out, so they multiply by the transform
+    // matrices instead. The loops have constant trip counts, so the compiler unrolls them and drops the zero terms.
+    template <typename ValueType>
+    struct FixedWinogradTransform2D<ValueType, 6, 3>
+    {
+        static constexpr int tileSize = 6;
+        static constexpr int filterSize = 3;
+        static constexpr auto windowSize = filterSize + tileSize - 1;
+
+        // clang-format off
+        static constexpr double Bt[windowSize][windowSize] = { { 1.0,   0.0, -5.25,   0.0,  5.25,   0.0, -1.0, 0.0 },
+                                                               { 0.0,   1.0,   1.0, -4.25, -4.25,   1.0,  1.0, 0.0 },
+                                                               { 0.0,  -1.0,   1.0,  4.25, -4.25,  -1.0,  1.0, 0.0 },
+                                                               { 0.0,   0.5,  0.25,  -2.5, -1.25,   2.0,  1.0, 0.0 },
+                                                               { 0.0,  -0.5,  0.25,   2.5, -1.25,  -2.0,  1.0, 0.0 },
+                                                               { 0.0,   2.0,   4.0,  -2.5,  -5.0,   0.5,  1.0, 0.0 },
+                                                               { 0.0,  -2.0,   4.0,   2.5,  -5.0,  -0.5,  1.0, 0.0 },
+                                                               { 0.0,  -1.0,   0.0,  5.25,   0.0, -5.25,  0.0, 1.0 } };
+
+        static constexpr double At[tileSize][windowSize] = { { 1.0, 1.0,  1.0,  1.0,   1.0,     1.0,      1.0, 0.0 },
+                                                             { 0.0, 1.0, -1.0,  2.0,  -2.0,     0.5,     -0.5, 0.0 },
+                                                             { 0.0, 1.0,  1.0,  4.0,   4.0,    0.25,     0.25, 0.0 },
+                                                             { 0.0, 1.0, -1.0,  8.0,  -8.0,   0.125,   -0.125, 0.0 },
+                                                             { 0.0, 1.0,  1.0, 16.0,  16.0,  0.0625,   0.0625, 0.0 },
+                                                             { 0.0, 1.0, -1.0, 32.0, -32.0, 0.03125, -0.03125, 1.0 } };
+        // clang-format on
+
+        template <typename MatrixType1, typename MatrixType2>
+        static void TransformInputWindow(const MatrixType1& d, MatrixType2& X)
+        {
+            // Compute B'dB
+            ValueType Btd[windowSize][windowSize];
+            for (int i = 0; i < windowSize; ++i)
+            {
+                for (int j = 0; j < windowSize; ++j)
+                {
+                    ValueType sum = 0;
+                    for (int k = 0; k < windowSize; ++k)
+                    {
+                        sum += static_cast<ValueType>(Bt[i][k]) * d(k, j);
+                    }
+                    Btd[i][j] = sum;
+                }
+            }
+
+            for (int i = 0; i < windowSize; ++i)
+            {
+                for (int j = 0; j < windowSize; ++j)
+                {
+                    ValueType sum = 0;
+                    for (int k = 0; k < windowSize; ++k)
+                    {
+                        sum += Btd[i][k] * static_cast<ValueType>(Bt[j][k]);
+                    }
+                    X(i, j) = sum;
+                }
+            }
+        }
+
+        template <typename BlockType1, typename BlockType2>
+        static void TransformInputBlock(const BlockType1& d, int blockSize, BlockType2& X)
+        {
+            for (int index = 0; index < blockSize; ++index)
+            {
+                ValueType Btd[windowSize][windowSize];
+                for (int i = 0; i < windowSize; ++i)
+                {
+                    for (int j = 0; j < windowSize; ++j)
+                    {
+                        ValueType sum = 0;
+                        for (int k = 0; k < windowSize; ++k)
+                        {
+                            sum += static_cast<ValueType>(Bt[i][k]) * d(k, j, index);
+                        }
+                        Btd[i][j] = sum;
+                    }
+                }
+
+                for (int i = 0; i < windowSize; ++i)
+                {
+                    for (int j = 0; j < windowSize; ++j)
+                    {
+                        ValueType sum = 0;
+                        for (int k = 0; k < windowSize; ++k)
+                        {
+                            sum += Btd[i][k] * static_cast<ValueType>(Bt[j][k]);
+                        }
+                        X(i, j, index) = sum;
+                    }
+                }
+            }
+        }
+
+        template <typename MatrixType1, typename MatrixType2>
+        static void TransformOutputTile(const MatrixType1& X, MatrixType2& result)
+        {
+            // Compute A'XA
+            ValueType AtX[tileSize][windowSize];
+            for (int i = 0; i < tileSize; ++i)
+            {
+                for (int j = 0; j < windowSize; ++j)
+                {
+                    ValueType sum = 0;
+                    for (int k = 0; k < windowSize; ++k)
+                    {
+                        sum += static_cast<ValueType>(At[i][k]) * X(k, j);
+                    }
+                    AtX[i][j] = sum;
+                }
+            }
+
+            for (int i = 0; i < tileSize; ++i)
+            {
+                for (int j = 0; j < tileSize; ++j)
+                {
+                    ValueType sum = 0;
+                    for (int k = 0; k < windowSize; ++k)
+                    {
+                        sum += AtX[i][k] * static_cast<ValueType>(At[j][k]);
+                    }
+                    result(i, j) = sum;
+                }
+            }
+        }
+
+        template <typename BlockType1, typename BlockType2>
+        static void TransformOutputBlock(const BlockType1& X, int blockSize, BlockType2& result)
+        {
+            for (int index = 0; index < blockSize; ++index)
+            {
+                ValueType AtX[tileSize][windowSize];
+                for (int i = 0; i < tileSize; ++i)
+                {
+                    for (int j = 0; j < windowSize; ++j)
+                    {
+                        ValueType sum = 0;
+                        for (int k = 0; k < windowSize; ++k)
+                        {
+                            sum += static_cast<ValueType>(At[i][k]) * X(k, j, index);
+                        }
+                        AtX[i][j] = sum;
+                    }
+                }
+
+                for (int i = 0; i < tileSize; ++i)
+                {
+                    for (int j = 0; j < tileSize; ++j)
+                    {
+                        ValueType sum = 0;
+                        for (int k = 0; k < windowSize; ++k)
+                        {
+                            sum += AtX[i][k] * static_cast<ValueType>(At[j][k]);
+                        }
+                        result(i, j, index) = sum;
+                    }
+                }
+            }
+        }
+    };
+
     //
     // Helper class to implement Winograd convolution steps
     //
@@ -1431,7 +1660,7 @@ namespace dsp
                             ElementwiseMultiply(filterPtr, X.GetDataPointer(), windowSize * windowSize, X.GetDataPointer());
 
                             // Now compute output tile Y = At * X * A
-                            FixedWinogradTransform2D<ValueType, 2, 3>::TransformOutputTile(X, outputTile);
+                            FixedWinogradTransform2D<ValueType, tileSize, filterSize>::TransformOutputTile(X, outputTile);
 
                             // copy the tile into the output
                             const int outputTileRows = std::min(static_cast<int>(tileSize), numOutputRows - rowIndex);
@@ -1524,6 +1753,10 @@ namespace dsp
         {
             FixedWinograd2D<ValueType, 4, 3, blockSize>::Convolve2DWinogradFiltersFirst(input, transformedFilters, numFilters, output);
         }
+        else if (tileSize == 6 && filterSize == 3)
+        {
+            FixedWinograd2D<ValueType, 6, 3, blockSize>::Convolve2DWinogradFiltersFirst(input, transformedFilters, numFilters, output);
+        }
         else
         {
             throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
@@ -1554,6 +1787,10 @@ namespace dsp
         {
             FixedWinograd2D<ValueType, 4, 3, blockSize>::Convolve2DWinogradTilesFirst(input, transformedFilters, numFilters, transformedInputScratch, transformedOutputScratch, output);
         }
+        else if (tileSize == 6 && filterSize == 3)
+        {
+            FixedWinograd2D<ValueType, 6, 3, blockSize>::Convolve2DWinogradTilesFirst(input, transformedFilters, numFilters, transformedInputScratch, transformedOutputScratch, output);
+        }
         else
         {
             throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented);
@@ -1678,6 +1915,10 @@ namespace dsp
         {
             FixedWinograd2D<ValueType, 4, 3, blockSize>::Convolve2DWinogradFiltersFirst(input, transformedFilters, numFilters, output);
         }
+        else if (tileSize == 6 && filterSize == 3)
+        {
+            FixedWinograd2D<ValueType, 6, 3, blockSize>::Convolve2DWinogradFiltersFirst(input, transformedFilters, numFilters, output);
+        }
         else
         {
             assert(false && "Tile and filter size not implemented");
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <dsp/include/Convolution.h>
+#include <dsp/include/WinogradConvolution.h>
 
 struct Extent2D
 {
@@ -38,6 +39,10 @@ void TestConv2D(ell::dsp::ConvolutionMethodOption algorithm);
 template <typename ValueType>
 void TestConv2DVsSimple(int numRows, int numColumns, int numChannels, int filterSize, int numFilters, int stride, ell::dsp::ConvolutionMethodOption algorithm);
 
+// 2D Winograd convolution with a specific tile size, with a 3x3 filter
+template <typename ValueType>
+void TestConv2DWinogradVsSimple(int numRows, int numColumns, int numChannels, int numFilters, int tileSize, ell::dsp::WinogradFilterOrder order);
+
 // Depthwise-separable 2D (multiple "flat" 2D in parallel)
 template <typename ValueType>
 void TestConv2DSeparable(ell::dsp::ConvolutionMethodOption algorithm);
@@ -10,10 +10,16 @@
 
 #include <dsp/include/Convolution.h>
 
+#include <testing/include/Benchmark.h>
+
 // 1D convolution over a vector
 template <typename ValueType>
-void TimeConv1D(size_t signalSize, size_t filterSize, size_t numIterations, ell::dsp::ConvolutionMethodOption algorithm);
+void TimeConv1D(ell::testing::BenchmarkSuite& suite, size_t signalSize, size_t filterSize, ell::dsp::ConvolutionMethodOption algorithm);
 
 // 2D convolution over a tensor
 template <typename ValueType>
-void TimeConv2D(size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, size_t numFilters, size_t numIterations, ell::dsp::ConvolutionMethodOption algorithm);
+void TimeConv2D(ell::testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, size_t numFilters, ell::dsp::ConvolutionMethodOption algorithm);
+
+// 2D depthwise-separable convolution over a tensor
+template <typename ValueType>
+void TimeConv2DDepthwiseSeparable(ell::testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, ell::dsp::ConvolutionMethodOption algorithm);
@@ -9,3 +9,4 @@
 #pragma once
 
 void TestDCT();
+void TestFastDCT();
@@ -15,3 +15,6 @@ void TestFFT(size_t N);
 
 template <typename ValueType>
 void VerifyFFT();
+
+template <typename ValueType>
+void TestFFTPlan(size_t N);
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <cstring>
+
 template <typename ValueType>
 void TestIIRFilter();
 
@@ -16,3 +18,9 @@ void TestIIRFilterMultiSample();
 
 template <typename ValueType>
 void TestIIRFilterImpulse();
+
+template <typename ValueType>
+void TestFIRFilterStreaming(size_t filterSize, size_t blockSize);
+
+template <typename ValueType>
+void TestBiquadCascade(size_t numChannels);
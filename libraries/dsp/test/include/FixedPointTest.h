@@ -0,0 +1,23 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FixedPointTest.h (dsp)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <dsp/include/FixedPoint.h>
+
+#include <cstring>
+
+void TestFixedPointFormat();
+
+// The tests compare the fixed-point kernels with the floating-point ones, and require a signal-to-noise ratio of
+// at least `minSNR` dB
+void TestFixedPointFFT(size_t N, ell::dsp::FixedPointFormat format, double minSNR);
+void TestFixedPointIIRFilter(ell::dsp::FixedPointFormat format, double minSNR);
+void TestFixedPointWindow(ell::dsp::FixedPointFormat format, double minSNR);
+void TestFixedPointFilterBank(ell::dsp::FixedPointFormat format, double minSNR);
+void TestFixedPointDCT(ell::dsp::FixedPointFormat format, double minSNR);
@@ -10,3 +10,4 @@
 
 void TestMelFilterBank();
 void TestMelFilterBank2();
+void TestFilterBankSparseFiltering();
@@ -0,0 +1,27 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     TransformTiming.h (dsp)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <testing/include/Benchmark.h>
+
+// Complex-valued FFT, and the magnitudes of the real-valued FFT, with a precomputed plan
+template <typename ValueType>
+void TimeFFT(ell::testing::BenchmarkSuite& suite, size_t size);
+
+// DCT of a signal with a precomputed DCT matrix
+template <typename ValueType>
+void TimeDCT(ell::testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters);
+
+// Mel filter bank applied to FFT magnitudes
+template <typename ValueType>
+void TimeMelFilterBank(ell::testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters);
+
+// Mel filter bank applied to the FFT magnitudes of a batch of frames
+template <typename ValueType>
+void TimeMelFilterBankFrames(ell::testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters, size_t numFrames);
@@ -252,6 +252,26 @@ void TestConv2DVsSimple(int numRows, int numColumns, int numChannels, int filter
     }
 }
 
+template <typename ValueType>
+void TestConv2DWinogradVsSimple(int numRows, int numColumns, int numChannels, int numFilters, int tileSize, dsp::WinogradFilterOrder order)
+{
+    using Tensor = math::ChannelColumnRowTensor<ValueType>;
+
+    const int filterSize = 3;
+    Tensor signal(numRows, numColumns, numChannels);
+    Tensor filters(numFilters * filterSize, filterSize, numChannels);
+
+    FillInputTensor(signal);
+    FillFiltersTensor(filters, numFilters);
+
+    auto reference = Convolve2D(signal, filters, numFilters, 1, dsp::ConvolutionMethodOption::simple);
+    auto result = dsp::Convolve2DWinograd(signal, filters, numFilters, tileSize, order);
+
+    std::string orderName = order == dsp::WinogradFilterOrder::tilesFirst ? "tiles first" : "filters first";
+    testing::ProcessTest("Testing F(" + std::to_string(tileSize) + ",3) Winograd convolution (" + orderName + ") on input of size " + std::to_string(numRows) + " x " + std::to_string(numColumns) + " x " + std::to_string(numChannels),
+                         reference.IsEqual(result, static_cast<ValueType>(epsilon)));
+}
+
 // Depthwise-separable
 template <typename ValueType>
 void TestConv2DSeparableVsSimple(int numRows, int numColumns, int numChannels, int filterSize, int stride, dsp::ConvolutionMethodOption algorithm)
@@ -329,6 +349,8 @@ template void TestConv2D<float>(dsp::ConvolutionMethodOption);
 template void TestConv2D<double>(dsp::ConvolutionMethodOption);
 template void TestConv2DVsSimple<float>(int numRows, int numColumns, int numChannels, int filterSize, int numFilters, int stride, dsp::ConvolutionMethodOption algorithm);
 template void TestConv2DVsSimple<double>(int numRows, int numColumns, int numChannels, int filterSize, int numFilters, int stride, dsp::ConvolutionMethodOption algorithm);
+template void TestConv2DWinogradVsSimple<float>(int numRows, int numColumns, int numChannels, int numFilters, int tileSize, dsp::WinogradFilterOrder order);
+template void TestConv2DWinogradVsSimple<double>(int numRows, int numColumns, int numChannels, int numFilters, int tileSize, dsp::WinogradFilterOrder order);
 
 // Depthwise-separable (i.e., multiple 2D in parallel)
 template void TestConv2DSeparable<float>(dsp::ConvolutionMethodOption);
@@ -21,8 +21,6 @@
 
 #include <testing/include/testing.h>
 
-#include <utilities/include/MillisecondTimer.h>
-
 #include <cmath>
 #include <iostream>
 #include <string>
@@ -34,54 +32,63 @@ using namespace ell;
 // Timing
 //
 template <typename ValueType>
-void TimeConv1D(size_t signalSize, size_t filterSize, size_t numIterations, dsp::ConvolutionMethodOption algorithm)
+void TimeConv1D(testing::BenchmarkSuite& suite, size_t signalSize, size_t filterSize, dsp::ConvolutionMethodOption algorithm)
 {
     math::RowVector<ValueType> signal(signalSize);
     math::RowVector<ValueType> filter(filterSize);
+    FillInputVector<ValueType>(signal);
+    FillFilterVector<ValueType>(filter);
 
-    // Perform the convolution
-    utilities::MillisecondTimer timer;
-    for (size_t iter = 0; iter < numIterations; ++iter)
-    {
+    auto name = "Conv1D " + GetConvAlgName(algorithm) + " [" + std::to_string(signalSize) + "] * [" + std::to_string(filterSize) + "]";
+    auto flops = 2.0 * (signalSize - filterSize + 1) * filterSize;
+    suite.Run(name, flops, [&]() {
         volatile auto result = Convolve1D(signal, filter, algorithm);
-    }
-    auto duration = timer.Elapsed();
-
-    std::cout << "Time to perform 1D "
-              << " " << GetConvAlgName(algorithm) << " convolution on size-" << signalSize << " input and size-" << filterSize << " filter: " << duration << " ms" << std::endl;
+    });
 }
 
 template <typename ValueType>
-void TimeConv2D(size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, size_t numFilters, size_t numIterations, dsp::ConvolutionMethodOption algorithm)
+void TimeConv2D(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, size_t numFilters, dsp::ConvolutionMethodOption algorithm)
 {
     const auto filterRows = filterSize;
     const auto filterColumns = filterSize;
     math::ChannelColumnRowTensor<ValueType> signal(numRows, numColumns, numChannels);
     math::ChannelColumnRowTensor<ValueType> filters{ numFilters * filterRows, filterColumns, numChannels };
+    FillInputTensor<ValueType>(signal);
+    FillFiltersTensor<ValueType>(filters, numFilters);
 
-    // Perform the convolution
-    utilities::MillisecondTimer timer;
+    // the number of operations of a direct convolution, whatever the algorithm, so that GFLOP/s are comparable
+    auto name = "Conv2D " + GetConvAlgName(algorithm) + " " + GetSizeString<ValueType>(signal) + " * " + GetFilterSizeString<ValueType>(filters);
+    auto flops = 2.0 * (numRows - filterSize + 1) * (numColumns - filterSize + 1) * numFilters * filterSize * filterSize * numChannels;
     if (algorithm == dsp::ConvolutionMethodOption::winograd)
     {
         const auto order = dsp::WinogradFilterOrder::tilesFirst;
         const int tileSize = 2;
         auto transformedFilters = dsp::GetTransformedFilters(filters, static_cast<int>(numFilters), tileSize, order);
-        timer.Reset();
-        for (size_t iter = 0; iter < numIterations; ++iter)
-        {
+        suite.Run(name, flops, [&]() {
             volatile auto result = Convolve2DWinogradPretransformed(signal, transformedFilters, static_cast<int>(numFilters), tileSize, static_cast<int>(filterSize), order);
-        }
+        });
     }
     else
     {
-        for (size_t iter = 0; iter < numIterations; ++iter)
-        {
+        suite.Run(name, flops, [&]() {
             volatile auto result = Convolve2D(signal, filters, static_cast<int>(numFilters), algorithm);
-        }
+        });
     }
-    auto duration = timer.Elapsed();
+}
 
-    std::cout << "Time to perform 2D " << GetConvAlgName(algorithm) << " tensor convolution on " << GetSizeString(signal) << " input with " << GetFilterSizeString(filters) << " filters: " << duration << " ms" << std::endl;
+template <typename ValueType>
+void TimeConv2DDepthwiseSeparable(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, dsp::ConvolutionMethodOption algorithm)
+{
+    math::ChannelColumnRowTensor<ValueType> signal(numRows, numColumns, numChannels);
+    math::ChannelColumnRowTensor<ValueType> filters{ numChannels * filterSize, filterSize, 1 };
+    FillInputTensor<ValueType>(signal);
+    FillFiltersTensor<ValueType>(filters, numChannels);
+
+    auto name = "Conv2DDepthwise " + GetConvAlgName(algorithm) + " " + GetSizeString<ValueType>(signal) + " * " + GetFilterSizeString<ValueType>(filters);
+    auto flops = 2.0 * (numRows - filterSize + 1) * (numColumns - filterSize + 1) * numChannels * filterSize * filterSize;
+    suite.Run(name, flops, [&]() {
+        volatile auto result = Convolve2DDepthwiseSeparable(signal, filters, static_cast<int>(numChannels), algorithm);
+    });
 }
 
 //
@@ -89,9 +96,13 @@ void TimeConv2D(size_t numRows, size_t numColumns, size_t numChannels, size_t fi
 //
 
 // 1D
-template void TimeConv1D<float>(size_t signalSize, size_t filterSize, size_t numIterations, dsp::ConvolutionMethodOption);
-template void TimeConv1D<double>(size_t signalSize, size_t filterSize, size_t numIterations, dsp::ConvolutionMethodOption);
+template void TimeConv1D<float>(testing::BenchmarkSuite& suite, size_t signalSize, size_t filterSize, dsp::ConvolutionMethodOption);
+template void TimeConv1D<double>(testing::BenchmarkSuite& suite, size_t signalSize, size_t filterSize, dsp::ConvolutionMethodOption);
 
 // 2D (Tensor)
-template void TimeConv2D<float>(size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, size_t numFilters, size_t numIterations, dsp::ConvolutionMethodOption algorithm);
-template void TimeConv2D<double>(size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, size_t numFilters, size_t numIterations, dsp::ConvolutionMethodOption algorithm);
+template void TimeConv2D<float>(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, size_t numFilters, dsp::ConvolutionMethodOption algorithm);
+template void TimeConv2D<double>(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, size_t numFilters, dsp::ConvolutionMethodOption algorithm);
+
+// 2D depthwise-separable (Tensor)
+template void TimeConv2DDepthwiseSeparable<float>(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, dsp::ConvolutionMethodOption algorithm);
+template void TimeConv2DDepthwiseSeparable<double>(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, dsp::ConvolutionMethodOption algorithm);
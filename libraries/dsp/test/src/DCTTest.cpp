@@ -15,7 +15,9 @@
 
 #include <testing/include/testing.h>
 
+#include <cmath>
 #include <iostream>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -104,3 +106,52 @@ void TestDCT()
     // TestDCTMatrix(GetDCTReference_III_128_13());
     // TestDCTMatrix(GetDCTReference_III_128_40());
 }
+
+template <typename ValueType>
+void TestDCTPlan(size_t windowSize, size_t numFilters, bool normalize)
+{
+    const double epsilon = std::is_same<ValueType, float>::value ? 1e-4 : 1e-10;
+    DCTPlan<ValueType> plan(windowSize, numFilters, normalize);
+    auto dctMatrix = GetDCTMatrix<ValueType>(windowSize, numFilters, normalize);
+
+    ColumnVector<ValueType> signal(windowSize);
+    for (size_t index = 0; index < windowSize; ++index)
+    {
+        signal[index] = static_cast<ValueType>(std::sin(0.37 * index) + 0.01 * index);
+    }
+    ColumnVector<ValueType> expected(numFilters);
+    MultiplyScaleAddUpdate(static_cast<ValueType>(1), dctMatrix, signal, static_cast<ValueType>(0), expected);
+
+    // Compare relative to the size of the coefficients, which grows with the window size unless normalized
+    auto scale = static_cast<ValueType>(normalize ? 1.0 : 1.0 / windowSize);
+    auto result = DCT(plan, signal);
+    result *= scale;
+    expected *= scale;
+
+    auto name = std::string("Testing DCT plan ") + (plan.UsesFFT() ? "(FFT) " : "(matrix) ") + std::to_string(windowSize) + " -> " + std::to_string(numFilters) + (normalize ? " normalized" : "");
+    testing::ProcessTest(name, result.IsEqual(expected, static_cast<ValueType>(epsilon)));
+}
+
+void TestFastDCT()
+{
+    for (bool normalize : { false, true })
+    {
+        TestDCTPlan<float>(8, 8, normalize);
+        TestDCTPlan<float>(40, 13, normalize);
+        TestDCTPlan<float>(64, 4, normalize);
+        TestDCTPlan<float>(64, 13, normalize);
+        TestDCTPlan<float>(32, 32, normalize);
+        TestDCTPlan<float>(64, 40, normalize);
+        TestDCTPlan<float>(128, 13, normalize);
+        TestDCTPlan<float>(128, 128, normalize);
+        TestDCTPlan<double>(256, 40, normalize);
+        TestDCTPlan<double>(512, 512, normalize);
+    }
+
+    // DCT without a plan
+    ColumnVector<double> signal({ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 });
+    auto dctMatrix = GetDCTMatrix<double>(16, 16, true);
+    ColumnVector<double> expected(16);
+    MultiplyScaleAddUpdate(1.0, dctMatrix, signal, 0.0, expected);
+    testing::ProcessTest("Testing DCT", DCT(signal, 16, true).IsEqual(expected, 1e-10));
+}
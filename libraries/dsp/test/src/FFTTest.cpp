@@ -11,6 +11,7 @@
 
 #include <dsp/include/FFT.h>
 
+#include <math/include/MathConstants.h>
 #include <math/include/Vector.h>
 #include <math/include/VectorOperations.h>
 
@@ -20,6 +21,7 @@
 
 #include <complex>
 #include <random>
+#include <string>
 #include <vector>
 
 using namespace ell;
@@ -104,6 +106,61 @@ void VerifyFFT()
     VerifyFFT(GetFFTTestData_1024(), GetRealFFT_1024());
 }
 
+template <typename ValueType>
+void TestFFTPlan(size_t N)
+{
+    const ValueType epsilon = static_cast<ValueType>(1e-4);
+    const ValueType pi = math::Constants<ValueType>::pi;
+    auto randomEngine = utilities::GetRandomEngine();
+    std::uniform_real_distribution<ValueType> uniform(-1, 1);
+    std::vector<ValueType> realSignal(N);
+    std::vector<std::complex<ValueType>> signal(N);
+    for (size_t index = 0; index < N; ++index)
+    {
+        realSignal[index] = uniform(randomEngine);
+        signal[index] = { uniform(randomEngine), uniform(randomEngine) };
+    }
+
+    // Direct evaluation of the transform, with the same sign convention as FFT
+    auto dft = [N, pi](const std::vector<std::complex<ValueType>>& x) {
+        std::vector<std::complex<ValueType>> result(N);
+        for (size_t k = 0; k < N; ++k)
+        {
+            for (size_t n = 0; n < N; ++n)
+            {
+                result[k] += x[n] * std::exp(std::complex<ValueType>(0, 2 * pi * static_cast<ValueType>((k * n) % N) / N));
+            }
+        }
+        return result;
+    };
+    auto isEqual = [epsilon](const std::vector<std::complex<ValueType>>& a, const std::vector<std::complex<ValueType>>& b) {
+        for (size_t index = 0; index < a.size(); ++index)
+        {
+            if (std::abs(a[index] - b[index]) > epsilon)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    FFTPlan<ValueType> plan(N);
+    auto transformed = signal;
+    plan.Transform(transformed.data());
+    testing::ProcessTest("Testing FFTPlan complex-valued transform, size " + std::to_string(N), isEqual(transformed, dft(signal)));
+
+    plan.Transform(transformed.data(), true);
+    testing::ProcessTest("Testing FFTPlan inverse transform, size " + std::to_string(N), isEqual(transformed, signal));
+
+    std::vector<std::complex<ValueType>> realTransformed(N);
+    plan.TransformReal(realSignal.data(), realTransformed.data());
+    testing::ProcessTest("Testing FFTPlan real-valued transform, size " + std::to_string(N), isEqual(realTransformed, dft({ realSignal.begin(), realSignal.end() })));
+
+    std::vector<ValueType> realInverse(N);
+    plan.InverseTransformReal(realTransformed.data(), realInverse.data());
+    testing::ProcessTest("Testing FFTPlan real-valued inverse transform, size " + std::to_string(N), testing::IsEqual(realInverse, realSignal, epsilon));
+}
+
 //
 // Explicit instantiation definitions
 //
@@ -112,3 +169,6 @@ template void TestFFT<double>(size_t);
 
 template void VerifyFFT<float>();
 template void VerifyFFT<double>();
+
+template void TestFFTPlan<float>(size_t);
+template void TestFFTPlan<double>(size_t);
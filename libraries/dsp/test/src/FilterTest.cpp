@@ -6,11 +6,18 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <dsp/include/BiquadCascade.h>
+#include <dsp/include/FIRFilter.h>
 #include <dsp/include/IIRFilter.h>
 
 #include <testing/include/testing.h>
 
+#include <utilities/include/RandomEngines.h>
+
+#include <algorithm>
 #include <iostream>
+#include <random>
+#include <string>
 #include <vector>
 
 using namespace ell;
@@ -57,6 +64,110 @@ void TestIIRFilterImpulse()
     testing::ProcessTest("Testing FIR filtering of impulse signal", testing::IsEqual(y, bCoeffs, epsilon));
 }
 
+template <typename ValueType>
+void TestFIRFilterStreaming(size_t filterSize, size_t blockSize)
+{
+    const ValueType epsilon = static_cast<ValueType>(1e-4);
+    auto randomEngine = utilities::GetRandomEngine();
+    std::uniform_real_distribution<ValueType> uniform(-1, 1);
+    auto rand = [&]() { return uniform(randomEngine); };
+
+    std::vector<ValueType> b(filterSize);
+    std::generate(b.begin(), b.end(), rand);
+    std::vector<ValueType> signal(1000);
+    std::generate(signal.begin(), signal.end(), rand);
+
+    std::vector<ValueType> expected(signal.size(), 0);
+    for (size_t t = 0; t < signal.size(); ++t)
+    {
+        for (size_t k = 0; k < filterSize && k <= t; ++k)
+        {
+            expected[t] += b[k] * signal[t - k];
+        }
+    }
+
+    // Filter the signal in chunks of varying size, some smaller and some larger than a block
+    FIRFilter<ValueType> filter(b, blockSize);
+    std::vector<ValueType> output(signal.size());
+    size_t chunkSize = 1;
+    for (size_t start = 0; start < signal.size(); start += chunkSize, chunkSize = 2 * chunkSize + 5)
+    {
+        auto count = std::min(chunkSize, signal.size() - start);
+        filter.FilterSamples(signal.data() + start, count, output.data() + start);
+    }
+
+    auto name = "Testing streaming FIR filter of size " + std::to_string(filterSize) + (filter.UsesFFT() ? " with overlap-save" : "");
+    testing::ProcessTest(name, testing::IsEqual(output, expected, epsilon));
+
+    filter.Reset();
+    testing::ProcessTest(name + " after reset", testing::IsEqual(filter.FilterSamples(signal), expected, epsilon));
+
+    // IIR filters keep their state across calls too
+    IIRFilter<ValueType> iirFilter(b, {});
+    std::vector<ValueType> firstHalf(signal.begin(), signal.begin() + 500);
+    std::vector<ValueType> secondHalf(signal.begin() + 500, signal.end());
+    auto iirOutput = iirFilter.FilterSamples(firstHalf);
+    auto iirOutput2 = iirFilter.FilterSamples(secondHalf);
+    iirOutput.insert(iirOutput.end(), iirOutput2.begin(), iirOutput2.end());
+    testing::ProcessTest("Testing IIR filter on a signal in two chunks", testing::IsEqual(iirOutput, expected, epsilon));
+}
+
+template <typename ValueType>
+void TestBiquadCascade(size_t numChannels)
+{
+    const ValueType epsilon = static_cast<ValueType>(1e-4);
+    auto randomEngine = utilities::GetRandomEngine();
+    std::uniform_real_distribution<ValueType> uniform(-1, 1);
+
+    // Two stable sections, and the direct-form filter with the product of their transfer functions
+    std::vector<BiquadSection<ValueType>> sections = {
+        { static_cast<ValueType>(0.2), static_cast<ValueType>(0.4), static_cast<ValueType>(0.2), static_cast<ValueType>(-0.6), static_cast<ValueType>(0.25) },
+        { static_cast<ValueType>(1.0), static_cast<ValueType>(-1.5), static_cast<ValueType>(0.8), static_cast<ValueType>(-1.2), static_cast<ValueType>(0.5) }
+    };
+    auto multiply = [](const std::vector<ValueType>& p, const std::vector<ValueType>& q) {
+        std::vector<ValueType> result(p.size() + q.size() - 1, 0);
+        for (size_t i = 0; i < p.size(); ++i)
+        {
+            for (size_t j = 0; j < q.size(); ++j)
+            {
+                result[i + j] += p[i] * q[j];
+            }
+        }
+        return result;
+    };
+    auto b = multiply({ sections[0].b0, sections[0].b1, sections[0].b2 }, { sections[1].b0, sections[1].b1, sections[1].b2 });
+    auto a = multiply({ 1, sections[0].a1, sections[0].a2 }, { 1, sections[1].a1, sections[1].a2 });
+    a.erase(a.begin());
+
+    // Each channel gets its own signal
+    const size_t numFrames = 200;
+    std::vector<ValueType> signal(numFrames * numChannels);
+    std::generate(signal.begin(), signal.end(), [&]() { return uniform(randomEngine); });
+    std::vector<ValueType> expected(signal.size());
+    for (size_t c = 0; c < numChannels; ++c)
+    {
+        IIRFilter<ValueType> filter(b, a);
+        for (size_t frame = 0; frame < numFrames; ++frame)
+        {
+            expected[frame * numChannels + c] = filter.FilterSample(signal[frame * numChannels + c]);
+        }
+    }
+
+    // Filter the frames in two chunks, the second one in place
+    BiquadCascade<ValueType> cascade(sections, numChannels);
+    std::vector<ValueType> firstHalf(signal.begin(), signal.begin() + (numFrames / 2) * numChannels);
+    auto output = cascade.FilterFrames(firstHalf);
+    std::vector<ValueType> secondHalf(signal.begin() + (numFrames / 2) * numChannels, signal.end());
+    cascade.FilterFrames(secondHalf.data(), numFrames - numFrames / 2, secondHalf.data());
+    output.insert(output.end(), secondHalf.begin(), secondHalf.end());
+
+    auto name = "Testing biquad cascade with " + std::to_string(numChannels) + " channels";
+    testing::ProcessTest(name, testing::IsEqual(output, expected, epsilon));
+
+    cascade.Reset();
+    testing::ProcessTest(name + " after reset", testing::IsEqual(cascade.FilterFrames(signal), expected, epsilon));
+}
+
 //
 // Explicit instantiations
 //
@@ -68,3 +179,9 @@ template void TestIIRFilterMultiSample<double>();
 
 template void TestIIRFilterImpulse<float>();
 template void TestIIRFilterImpulse<double>();
+
+template void TestFIRFilterStreaming<float>(size_t filterSize, size_t blockSize);
+template void TestFIRFilterStreaming<double>(size_t filterSize, size_t blockSize);
+
+template void TestBiquadCascade<float>(size_t numChannels);
+template void TestBiquadCascade<double>(size_t numChannels);
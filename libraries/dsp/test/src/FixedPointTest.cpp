@@ -0,0 +1,210 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FixedPointTest.cpp (dsp)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FixedPointTest.h"
+
+#include <dsp/include/DCT.h>
+#include <dsp/include/FFT.h>
+#include <dsp/include/FilterBank.h>
+#include <dsp/include/FixedPoint.h>
+#include <dsp/include/IIRFilter.h>
+#include <dsp/include/WindowFunctions.h>
+
+#include <testing/include/testing.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/RandomEngines.h>
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace ell;
+using namespace dsp;
+
+namespace
+{
+// A sum of sinusoids plus some noise, with peak amplitude below `amplitude`
+std::vector<double> GetTestSignal(size_t size, double amplitude)
+{
+    auto randomEngine = utilities::GetRandomEngine();
+    std::uniform_real_distribution<double> uniform(-1, 1);
+    std::vector<double> signal(size);
+    for (size_t index = 0; index < size; ++index)
+    {
+        signal[index] = amplitude * (0.5 * std::sin(0.31 * index) + 0.3 * std::sin(1.7 * index + 0.5) + 0.1 * uniform(randomEngine));
+    }
+    return signal;
+}
+
+double GetSNR(const std::vector<double>& reference, const std::vector<double>& values)
+{
+    double signalEnergy = 0;
+    double noiseEnergy = 0;
+    for (size_t index = 0; index < reference.size(); ++index)
+    {
+        signalEnergy += reference[index] * reference[index];
+        noiseEnergy += (reference[index] - values[index]) * (reference[index] - values[index]);
+    }
+    return noiseEnergy == 0 ? 1000.0 : 10 * std::log10(signalEnergy / noiseEnergy);
+}
+
+void VerifySNR(const std::string& name, const FixedPointFormat& format, const std::vector<double>& reference, const std::vector<double>& values, double minSNR)
+{
+    auto snr = GetSNR(reference, values);
+    testing::ProcessTest("Testing fixed-point " + name + " in " + format.ToString() + ", SNR " + std::to_string(snr) + " dB", snr >= minSNR);
+}
+} // namespace
+
+void TestFixedPointFormat()
+{
+    testing::ProcessTest("Testing fixed-point format parsing", FixedPointFormat::Parse("q15") == FixedPointFormat::Q15() && FixedPointFormat::Parse("Q31") == FixedPointFormat::Q31() && FixedPointFormat::Parse("q3.12") == FixedPointFormat{ 16, 12 });
+    testing::ProcessTest("Testing fixed-point format names", FixedPointFormat::Q15().ToString() == "q15" && FixedPointFormat{ 32, 24 }.ToString() == "q7.24");
+
+    bool threw = false;
+    try
+    {
+        FixedPointFormat::Parse("q7.7");
+    }
+    catch (const utilities::InputException&)
+    {
+        threw = true;
+    }
+    testing::ProcessTest("Testing fixed-point format with a bad word size", threw);
+
+    // Rounding and saturation
+    auto q15 = FixedPointFormat::Q15();
+    testing::ProcessTest("Testing fixed-point conversion", ToFixedPoint(0.5, q15) == 16384 && ToFixedPoint(-0.5, q15) == -16384 && ToFixedPoint(1.5 / 32768, q15) == 2 && ToFixedPoint(-1.5 / 32768, q15) == -2);
+    testing::ProcessTest("Testing fixed-point saturation", ToFixedPoint(1.0, q15) == 32767 && ToFixedPoint(-4.0, q15) == -32767 && SaturateFixedPoint(int64_t{ 1 } << 40, 32) == 2147483647);
+    testing::ProcessTest("Testing fixed-point rounding shift", RoundingShiftRight(5, 1) == 3 && RoundingShiftRight(-5, 1) == -2 && RoundingShiftRight(3, -2) == 12);
+    testing::ProcessTest("Testing integer square root", IntegerSquareRoot(0) == 0 && IntegerSquareRoot(15) == 3 && IntegerSquareRoot(16) == 4 && IntegerSquareRoot(int64_t{ 1 } << 62) == (int64_t{ 1 } << 31));
+
+    auto coefficients = QuantizeCoefficients(std::vector<double>{ 1.9, -0.5 }, 16);
+    testing::ProcessTest("Testing coefficient quantization", coefficients.fractionalBits == 14 && coefficients.values[0] == 31130 && coefficients.values[1] == -8192);
+}
+
+void TestFixedPointFFT(size_t N, FixedPointFormat format, double minSNR)
+{
+    auto signal = GetTestSignal(N, 0.9);
+    FFTPlan<double> plan(N);
+    std::vector<std::complex<double>> spectrum(N);
+    plan.TransformReal(signal.data(), spectrum.data());
+    std::vector<double> reference(N / 2);
+    for (size_t index = 0; index < N / 2; ++index)
+    {
+        reference[index] = std::abs(spectrum[index]);
+    }
+
+    FixedPointFFTPlan fixedPlan(N, format.wordBits);
+    auto magnitudes = fixedPlan.TransformMagnitudes<double>(ToFixedPoint(signal, format), format.fractionalBits);
+    VerifySNR("FFT of size " + std::to_string(N), format, reference, magnitudes, minSNR);
+}
+
+void TestFixedPointIIRFilter(FixedPointFormat format, double minSNR)
+{
+    // A second-order lowpass filter and a preemphasis filter
+    std::vector<std::pair<std::vector<double>, std::vector<double>>> filters = {
+        { { 0.0675, 0.1349, 0.0675 }, { -1.1430, 0.4128 } },
+        { { 1.0, -0.97 }, {} }
+    };
+    auto signal = GetTestSignal(1000, 0.5);
+    for (const auto& coefficients : filters)
+    {
+        IIRFilter<double> filter(coefficients.first, coefficients.second);
+        auto reference = filter.FilterSamples(signal);
+
+        FixedPointIIRFilter fixedFilter(coefficients.first, coefficients.second, format);
+        std::vector<double> filtered;
+        for (auto x : signal)
+        {
+            filtered.push_back(FromFixedPoint<double>(fixedFilter.FilterSample(ToFixedPoint(x, format)), format.fractionalBits));
+        }
+        VerifySNR("IIR filter of order " + std::to_string(coefficients.first.size() - 1), format, reference, filtered, minSNR);
+    }
+}
+
+void TestFixedPointWindow(FixedPointFormat format, double minSNR)
+{
+    const size_t size = 400;
+    auto signal = GetTestSignal(size, 0.9);
+    auto window = HammingWindow<double>(size);
+    auto coefficients = QuantizeCoefficients(window, format.CoefficientBits());
+    auto fixedSignal = ToFixedPoint(signal, format);
+    std::vector<double> reference(size);
+    std::vector<double> windowed(size);
+    for (size_t index = 0; index < size; ++index)
+    {
+        reference[index] = signal[index] * window[index];
+        windowed[index] = FromFixedPoint<double>(static_cast<int64_t>(fixedSignal[index]) * coefficients.values[index], format.fractionalBits + coefficients.fractionalBits);
+    }
+    VerifySNR("Hamming window", format, reference, windowed, minSNR);
+}
+
+void TestFixedPointFilterBank(FixedPointFormat format, double minSNR)
+{
+    const size_t fftSize = 512;
+    MelFilterBank filters(fftSize, 16000, fftSize, 40);
+    auto magnitudes = GetTestSignal(fftSize / 2, 0.9);
+    for (auto& magnitude : magnitudes)
+    {
+        magnitude = std::abs(magnitude);
+    }
+    auto reference = filters.FilterFrequencyMagnitudes(magnitudes);
+
+    std::vector<double> allCoefficients;
+    for (size_t filterIndex = filters.GetBeginFilter(); filterIndex < filters.GetEndFilter(); ++filterIndex)
+    {
+        const auto& filterCoefficients = filters.GetFilterCoefficients(filterIndex);
+        allCoefficients.insert(allCoefficients.end(), filterCoefficients.begin(), filterCoefficients.end());
+    }
+    auto coefficients = QuantizeCoefficients(allCoefficients, format.CoefficientBits());
+    auto fixedMagnitudes = ToFixedPoint(magnitudes, format);
+    std::vector<double> filtered;
+    size_t offset = 0;
+    for (size_t filterIndex = filters.GetBeginFilter(); filterIndex < filters.GetEndFilter(); ++filterIndex)
+    {
+        auto size = filters.GetFilterCoefficients(filterIndex).size();
+        auto sum = FixedPointDotProduct(fixedMagnitudes.data() + filters.GetFilter(filterIndex).GetStart(), coefficients.values.data() + offset, size);
+        filtered.push_back(FromFixedPoint<double>(sum, format.fractionalBits + coefficients.fractionalBits));
+        offset += size;
+    }
+    VerifySNR("mel filter bank", format, reference, filtered, minSNR);
+}
+
+void TestFixedPointDCT(FixedPointFormat format, double minSNR)
+{
+    const size_t windowSize = 40;
+    const size_t numFilters = 13;
+    auto signal = GetTestSignal(windowSize, 0.9);
+    auto dct = GetDCTMatrix<double>(windowSize, numFilters);
+    std::vector<double> matrix;
+    for (size_t row = 0; row < numFilters; ++row)
+    {
+        for (size_t column = 0; column < windowSize; ++column)
+        {
+            matrix.push_back(dct(row, column));
+        }
+    }
+
+    auto coefficients = QuantizeCoefficients(matrix, format.CoefficientBits());
+    auto fixedSignal = ToFixedPoint(signal, format);
+    std::vector<double> reference(numFilters);
+    std::vector<double> transformed(numFilters);
+    for (size_t row = 0; row < numFilters; ++row)
+    {
+        for (size_t column = 0; column < windowSize; ++column)
+        {
+            reference[row] += matrix[row * windowSize + column] * signal[column];
+        }
+        auto sum = FixedPointDotProduct(coefficients.values.data() + row * windowSize, fixedSignal.data(), windowSize);
+        transformed[row] = FromFixedPoint<double>(sum, format.fractionalBits + coefficients.fractionalBits);
+    }
+    VerifySNR("DCT", format, reference, transformed, minSNR);
+}
@@ -14,7 +14,9 @@
 
 #include <testing/include/testing.h>
 
+#include <cmath>
 #include <iostream>
+#include <string>
 #include <vector>
 
 using namespace ell;
@@ -65,3 +67,60 @@ void TestMelFilterBank2()
     VerifyMelFilterBank(8000, 512, 512, 40, GetMelReference_8000_512_40());
     VerifyMelFilterBank(8000, 512, 512, 13, GetMelReference_8000_512_13());
 }
+
+namespace
+{
+// Filters the magnitudes with every coefficient of each dense filter, zeros included
+std::vector<double> FilterDense(const TriangleFilterBank& filters, const std::vector<double>& magnitudes)
+{
+    std::vector<double> result;
+    for (size_t filterIndex = filters.GetBeginFilter(); filterIndex < filters.GetEndFilter(); ++filterIndex)
+    {
+        auto filter = filters.GetFilter(filterIndex);
+        double sum = 0;
+        for (size_t k = 0; k < magnitudes.size(); ++k)
+        {
+            sum += magnitudes[k] * filter[k];
+        }
+        result.push_back(sum);
+    }
+    return result;
+}
+
+void VerifySparseFiltering(const std::string& name, const TriangleFilterBank& filters)
+{
+    using namespace std::string_literals;
+    const double epsilon = 1e-9;
+    const size_t numFrames = 3;
+    const size_t numMagnitudes = filters.GetWindowSize() + 1;
+
+    math::RowMatrix<double> frames(numFrames, numMagnitudes);
+    for (size_t frame = 0; frame < numFrames; ++frame)
+    {
+        for (size_t k = 0; k < numMagnitudes; ++k)
+        {
+            frames(frame, k) = 1.0 + std::sin(0.1 * k + frame);
+        }
+    }
+
+    bool ok = true;
+    auto batch = filters.FilterFrequencyMagnitudes(frames);
+    ok &= batch.NumRows() == numFrames && batch.NumColumns() == filters.NumActiveFilters();
+    for (size_t frame = 0; ok && frame < numFrames; ++frame)
+    {
+        auto magnitudes = frames.GetRow(frame).ToArray();
+        auto expected = FilterDense(filters, magnitudes);
+        ok &= testing::IsEqual(filters.FilterFrequencyMagnitudes(magnitudes), expected, epsilon);
+        ok &= testing::IsEqual(batch.GetRow(frame).ToArray(), expected, epsilon);
+    }
+    testing::ProcessTest("Testing sparse filtering with "s + name, ok);
+}
+} // namespace
+
+void TestFilterBankSparseFiltering()
+{
+    VerifySparseFiltering("MelFilterBank", MelFilterBank(512, 16000, 512, 40));
+    VerifySparseFiltering("MelFilterBank with offset", MelFilterBank(512, 16000, 512, 40, 0.5));
+    VerifySparseFiltering("MelFilterBank with active filters", MelFilterBank(512, 16000, 512, 40, 5, 30, 0.0));
+    VerifySparseFiltering("LinearFilterBank", LinearFilterBank(256, 8000, 20, 2, 18, 0.5));
+}
@@ -0,0 +1,136 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     TransformTiming.cpp (dsp)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "TransformTiming.h"
+
+#include <dsp/include/DCT.h>
+#include <dsp/include/FFT.h>
+#include <dsp/include/FilterBank.h>
+
+#include <cmath>
+#include <complex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace ell;
+
+namespace
+{
+template <typename ValueType>
+std::string GetTypeString()
+{
+    return std::is_same_v<ValueType, float> ? "<float>" : "<double>";
+}
+
+template <typename ValueType>
+std::vector<ValueType> GetSignal(size_t size)
+{
+    std::vector<ValueType> signal(size);
+    for (size_t index = 0; index < size; ++index)
+    {
+        signal[index] = static_cast<ValueType>(std::sin(0.01 * index) + 0.5 * std::cos(0.3 * index));
+    }
+    return signal;
+}
+} // namespace
+
+template <typename ValueType>
+void TimeFFT(testing::BenchmarkSuite& suite, size_t size)
+{
+    dsp::FFTPlan<ValueType> plan(size);
+    auto realSignal = GetSignal<ValueType>(size);
+    std::vector<std::complex<ValueType>> complexSignal(realSignal.begin(), realSignal.end());
+    std::vector<std::complex<ValueType>> output(size);
+
+    // the conventional operation counts, 5 N log2(N) for complex and half of that for real transforms
+    auto flops = 5.0 * size * std::log2(static_cast<double>(size));
+    suite.Run("FFT" + GetTypeString<ValueType>() + " complex [" + std::to_string(size) + "]", flops, [&]() {
+        plan.Transform(complexSignal.data());
+    });
+    suite.Run("FFT" + GetTypeString<ValueType>() + " real [" + std::to_string(size) + "]", flops / 2, [&]() {
+        plan.TransformReal(realSignal.data(), output.data());
+    });
+}
+
+template <typename ValueType>
+void TimeDCT(testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters)
+{
+    auto dctMatrix = dsp::GetDCTMatrix<ValueType>(windowSize, numFilters);
+    auto signalValues = GetSignal<ValueType>(windowSize);
+    math::ColumnVector<ValueType> signal(signalValues);
+
+    // The flop count is that of the matrix version for both, so their rates can be compared directly
+    auto name = "DCT" + GetTypeString<ValueType>() + " [" + std::to_string(windowSize) + "] -> [" + std::to_string(numFilters) + "]";
+    suite.Run(name, 2.0 * windowSize * numFilters, [&]() {
+        volatile auto result = dsp::DCT<ValueType>(dctMatrix, signal);
+    });
+
+    dsp::DCTPlan<ValueType> plan(windowSize, numFilters);
+    std::vector<ValueType> result(numFilters);
+    std::vector<std::complex<ValueType>> scratch;
+    suite.Run("DCTPlan" + GetTypeString<ValueType>() + " [" + std::to_string(windowSize) + "] -> [" + std::to_string(numFilters) + "]" + (plan.UsesFFT() ? " (FFT)" : ""), 2.0 * windowSize * numFilters, [&]() {
+        plan.Transform(signalValues.data(), result.data(), scratch);
+    });
+}
+
+template <typename ValueType>
+void TimeMelFilterBank(testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters)
+{
+    const double sampleRate = 16000;
+    dsp::MelFilterBank filterBank(windowSize, sampleRate, windowSize, numFilters);
+    auto magnitudes = GetSignal<ValueType>(windowSize);
+
+    double flops = 0;
+    for (size_t index = 0; index < filterBank.NumFilters(); ++index)
+    {
+        auto filter = filterBank.GetFilter(index);
+        flops += 2.0 * (filter.GetEnd() - filter.GetStart());
+    }
+
+    auto name = "MelFilterBank" + GetTypeString<ValueType>() + " [" + std::to_string(windowSize) + "] -> [" + std::to_string(numFilters) + "]";
+    suite.Run(name, flops, [&]() {
+        volatile auto result = filterBank.FilterFrequencyMagnitudes(magnitudes);
+    });
+}
+
+template <typename ValueType>
+void TimeMelFilterBankFrames(testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters, size_t numFrames)
+{
+    const double sampleRate = 16000;
+    dsp::MelFilterBank filterBank(windowSize, sampleRate, windowSize, numFilters);
+    auto signal = GetSignal<ValueType>(windowSize * numFrames);
+    math::ConstRowMatrixReference<ValueType> frames(signal.data(), numFrames, windowSize);
+
+    double flops = 0;
+    for (size_t index = 0; index < filterBank.NumFilters(); ++index)
+    {
+        auto filter = filterBank.GetFilter(index);
+        flops += 2.0 * numFrames * (filter.GetEnd() - filter.GetStart());
+    }
+
+    auto name = "MelFilterBank" + GetTypeString<ValueType>() + " " + std::to_string(numFrames) + " x [" + std::to_string(windowSize) + "] -> [" + std::to_string(numFilters) + "]";
+    suite.Run(name, flops, [&]() {
+        volatile auto result = filterBank.FilterFrequencyMagnitudes(frames);
+    });
+}
+
+//
+// Explicit instantiations
+//
+template void TimeFFT<float>(testing::BenchmarkSuite& suite, size_t size);
+template void TimeFFT<double>(testing::BenchmarkSuite& suite, size_t size);
+
+template void TimeDCT<float>(testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters);
+template void TimeDCT<double>(testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters);
+
+template void TimeMelFilterBank<float>(testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters);
+template void TimeMelFilterBank<double>(testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters);
+
+template void TimeMelFilterBankFrames<float>(testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters, size_t numFrames);
+template void TimeMelFilterBankFrames<double>(testing::BenchmarkSuite& suite, size_t windowSize, size_t numFilters, size_t numFrames);
@@ -11,6 +11,7 @@
 #include "DSPTestData.h"
 #include "FFTTest.h"
 #include "FilterTest.h"
+#include "FixedPointTest.h"
 #include "MelTest.h"
 #include "WindowTest.h"
 
@@ -81,6 +82,14 @@ void DspTest(const std::string& path)
     TestConv2DVsSimple<float>(121, 81, 8, 3, 16, 1, ConvolutionMethodOption::winograd);
     TestConv2DVsSimple<float>(60, 40, 64, 3, 128, 1, ConvolutionMethodOption::winograd);
     TestConv2DVsSimple<float>(129, 129, 128, 3, 128, 1, ConvolutionMethodOption::winograd);
+    for (int tileSize : { 2, 4, 6 })
+    {
+        for (auto order : { WinogradFilterOrder::tilesFirst, WinogradFilterOrder::filtersFirst })
+        {
+            TestConv2DWinogradVsSimple<double>(14, 14, 8, 16, tileSize, order);
+            TestConv2DWinogradVsSimple<double>(17, 15, 3, 5, tileSize, order);
+        }
+    }
 
     // Depthwise-separable 2D convolution
     // Winograd
@@ -100,11 +109,28 @@ void DspTest(const std::string& path)
     TestFFT<double>(16);
     VerifyFFT<float>();
     VerifyFFT<double>();
+    for (size_t size : { 1, 2, 4, 8, 32, 256 })
+    {
+        TestFFTPlan<float>(size);
+        TestFFTPlan<double>(size);
+    }
 
     // Filters
     TestIIRFilter<float>();
     TestIIRFilterMultiSample<float>();
     TestIIRFilterImpulse<float>();
+    for (size_t filterSize : { 1, 5, 64, 65, 300 })
+    {
+        TestFIRFilterStreaming<float>(filterSize, 0);
+        TestFIRFilterStreaming<double>(filterSize, 0);
+    }
+    TestFIRFilterStreaming<float>(5, 16);
+    TestFIRFilterStreaming<double>(300, 100);
+    for (size_t numChannels : { 1, 3, 8, 16 })
+    {
+        TestBiquadCascade<float>(numChannels);
+        TestBiquadCascade<double>(numChannels);
+    }
 
     // Window functions
     TestHammingWindow<float>();
@@ -116,10 +142,28 @@ void DspTest(const std::string& path)
 
     // Mel filterbank
     TestMelFilterBank();
+    TestFilterBankSparseFiltering();
     // TestMelFilterBank2(); // Commented out because our implementation rounds filter centers to integer locations, and the reference (librosa) doesn't
 
     // DCT
     TestDCT();
+    TestFastDCT();
+
+    // Fixed point, with the minimum signal-to-noise ratios in dB
+    TestFixedPointFormat();
+    for (size_t size : { 64, 512 })
+    {
+        TestFixedPointFFT(size, FixedPointFormat::Q15(), 50);
+        TestFixedPointFFT(size, FixedPointFormat::Q31(), 140);
+    }
+    TestFixedPointIIRFilter(FixedPointFormat::Q15(), 65);
+    TestFixedPointIIRFilter(FixedPointFormat::Q31(), 110);
+    TestFixedPointWindow(FixedPointFormat::Q15(), 80);
+    TestFixedPointWindow(FixedPointFormat::Q31(), 130);
+    TestFixedPointFilterBank(FixedPointFormat::Q15(), 80);
+    TestFixedPointFilterBank(FixedPointFormat::Q31(), 130);
+    TestFixedPointDCT(FixedPointFormat::Q15(), 80);
+    TestFixedPointDCT(FixedPointFormat::Q31(), 130);
 }
 
 int main(int argc, char* argv[])
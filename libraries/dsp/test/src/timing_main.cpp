@@ -7,137 +7,84 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "ConvolutionTiming.h"
+#include "TransformTiming.h"
 
 #include <dsp/include/Convolution.h>
 
-#include <testing/include/testing.h>
-
-#include <utilities/include/Unused.h>
-
-#include <iostream>
+#include <testing/include/Benchmark.h>
 
 using namespace ell;
 using namespace dsp;
 
-struct ImageExtent
+namespace
 {
-    int rows;
-    int columns;
-};
+const ConvolutionMethodOption allMethods[] = { ConvolutionMethodOption::simple, ConvolutionMethodOption::unrolled, ConvolutionMethodOption::winograd };
 
-struct FiltersExtent
+void TimeConvolutions(testing::BenchmarkSuite& suite)
 {
-    int numFilters;
-    int rows;
-    int columns;
-    int numChannels;
-};
+    // there is no unrolled 1D convolution
+    for (auto method : { ConvolutionMethodOption::simple, ConvolutionMethodOption::winograd })
+    {
+        TimeConv1D<float>(suite, 5000, 3, method);
+    }
+
+    // numRows, numColumns, numChannels, filterSize, numFilters
+    const size_t shapes[][5] = {
+        { 200, 200, 1, 3, 1 },
+        { 120, 80, 8, 3, 16 },
+        { 120, 80, 64, 3, 128 },
+        { 60, 40, 256, 3, 512 },
+        { 18, 18, 32, 3, 32 },
+        { 18, 18, 128, 3, 128 },
+        { 33, 33, 64, 3, 64 },
+        { 66, 66, 16, 3, 16 },
+        { 66, 66, 64, 3, 64 },
+        { 129, 129, 8, 3, 8 },
+        { 129, 129, 32, 3, 32 },
+    };
+    for (const auto& shape : shapes)
+    {
+        for (auto method : allMethods)
+        {
+            TimeConv2D<float>(suite, shape[0], shape[1], shape[2], shape[3], shape[4], method);
+        }
+    }
+
+    // unrolled isn't implemented for depthwise-separable convolutions
+    for (size_t numChannels : { 32, 128 })
+    {
+        TimeConv2DDepthwiseSeparable<float>(suite, 66, 66, numChannels, 3, ConvolutionMethodOption::simple);
+        TimeConv2DDepthwiseSeparable<float>(suite, 66, 66, numChannels, 3, ConvolutionMethodOption::winograd);
+    }
+}
 
-void TimeConvolutionImplementations(ImageExtent outputSize, FiltersExtent filterParams, ImageExtent stride, ImageExtent totalOutputPadding, int numIterations)
+void TimeTransforms(testing::BenchmarkSuite& suite)
 {
-    UNUSED(stride, totalOutputPadding);
-
-    const size_t filterSize = static_cast<size_t>(filterParams.rows);
-    const size_t numChannels = static_cast<size_t>(filterParams.numChannels);
-    const size_t numFilters = static_cast<size_t>(filterParams.numFilters);
-    const size_t totalInputPadding = ((filterSize - 1) / 2) * 2;
-    const size_t inputRows = static_cast<size_t>(outputSize.rows) + totalInputPadding;
-    const size_t inputColumns = static_cast<size_t>(outputSize.columns) + totalInputPadding;
-    TimeConv2D<float>(inputRows, inputColumns, numChannels, filterSize, numFilters, numIterations, ell::dsp::ConvolutionMethodOption::simple);
-    TimeConv2D<float>(inputRows, inputColumns, numChannels, filterSize, numFilters, numIterations, ell::dsp::ConvolutionMethodOption::unrolled);
-    TimeConv2D<float>(inputRows, inputColumns, numChannels, filterSize, numFilters, numIterations, ell::dsp::ConvolutionMethodOption::winograd);
+    for (size_t size : { 64, 256, 512, 1024, 4096 })
+    {
+        TimeFFT<float>(suite, size);
+        TimeFFT<double>(suite, size);
+    }
+
+    for (size_t windowSize : { 40, 80, 128 })
+    {
+        TimeDCT<float>(suite, windowSize, 13);
+        TimeDCT<float>(suite, windowSize, windowSize);
+    }
+
+    for (size_t windowSize : { 256, 512 })
+    {
+        TimeMelFilterBank<float>(suite, windowSize, 40);
+        TimeMelFilterBank<float>(suite, windowSize, 80);
+        TimeMelFilterBankFrames<float>(suite, windowSize, 40, 100);
+    }
 }
+} // namespace
 
-int main()
+int main(int argc, char** argv)
 {
-    //
-    // Timing
-    //
-
-    // 1D Convolution timing
-    // void TimeConv1D(size_t signalSize, size_t filterSize, size_t numIterations, ell::dsp::ConvolutionMethodOption algorithm);
-    TimeConv1D<float>(5000, 3, 1000, ell::dsp::ConvolutionMethodOption::simple);
-    TimeConv1D<float>(5000, 3, 1000, ell::dsp::ConvolutionMethodOption::winograd);
-    std::cout << "\n";
-
-    // 2D Convolution timing
-
-    // void TimeConv2D(size_t numRows, size_t numColumns, size_t numChannels, size_t filterSize, size_t numFilters, size_t numIterations, ell::dsp::ConvolutionMethodOption algorithm);
-    TimeConv2D<float>(200, 200, 1, 3, 1, 100, ell::dsp::ConvolutionMethodOption::simple);
-    TimeConv2D<float>(200, 200, 1, 3, 1, 100, ell::dsp::ConvolutionMethodOption::unrolled);
-    TimeConv2D<float>(200, 200, 1, 3, 1, 1, ell::dsp::ConvolutionMethodOption::winograd);
-    std::cout << "\n";
-
-    TimeConv2D<float>(120, 80, 8, 3, 16, 1, ell::dsp::ConvolutionMethodOption::simple);
-    TimeConv2D<float>(120, 80, 8, 3, 16, 1, ell::dsp::ConvolutionMethodOption::unrolled);
-    TimeConv2D<float>(120, 80, 8, 3, 16, 1, ell::dsp::ConvolutionMethodOption::winograd);
-    std::cout << "\n";
-
-    TimeConv2D<float>(120, 80, 64, 3, 128, 1, ell::dsp::ConvolutionMethodOption::simple);
-    TimeConv2D<float>(120, 80, 64, 3, 128, 1, ell::dsp::ConvolutionMethodOption::unrolled);
-    TimeConv2D<float>(120, 80, 64, 3, 128, 1, ell::dsp::ConvolutionMethodOption::winograd);
-    std::cout << "\n";
-
-    TimeConv2D<float>(60, 40, 256, 3, 512, 1, ell::dsp::ConvolutionMethodOption::simple);
-    TimeConv2D<float>(60, 40, 256, 3, 512, 1, ell::dsp::ConvolutionMethodOption::unrolled);
-    TimeConv2D<float>(60, 40, 256, 3, 512, 1, ell::dsp::ConvolutionMethodOption::winograd);
-    std::cout << "\n";
-
-    int numIterations = 100;
-    TimeConvolutionImplementations({ 16, 16 }, { 8, 3, 3, 8 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 16, 16 }, { 16, 3, 3, 16 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 16, 16 }, { 32, 3, 3, 32 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 16, 16 }, { 64, 3, 3, 64 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 16, 16 }, { 128, 3, 3, 128 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 16, 16 }, { 256, 3, 3, 256 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n\n";
-
-    numIterations = 100;
-    TimeConvolutionImplementations({ 31, 31 }, { 8, 3, 3, 8 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 31, 31 }, { 16, 3, 3, 16 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 31, 31 }, { 32, 3, 3, 32 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 31, 31 }, { 64, 3, 3, 64 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 31, 31 }, { 128, 3, 3, 128 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 31, 31 }, { 256, 3, 3, 256 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n\n";
-
-    numIterations = 10;
-    TimeConvolutionImplementations({ 64, 64 }, { 8, 3, 3, 8 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 64, 64 }, { 16, 3, 3, 16 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 64, 64 }, { 32, 3, 3, 32 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 64, 64 }, { 64, 3, 3, 64 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 64, 64 }, { 128, 3, 3, 128 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 64, 64 }, { 256, 3, 3, 256 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n\n";
-
-    numIterations = 1;
-    TimeConvolutionImplementations({ 127, 127 }, { 8, 3, 3, 8 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 127, 127 }, { 16, 3, 3, 16 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 127, 127 }, { 32, 3, 3, 32 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 127, 127 }, { 64, 3, 3, 64 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 127, 127 }, { 128, 3, 3, 128 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n";
-    TimeConvolutionImplementations({ 127, 127 }, { 256, 3, 3, 256 }, { 1, 1 }, { 2, 2 }, numIterations);
-    std::cout << "\n\n";
-
-    return testing::DidTestFail() ? 1 : 0;
+    return testing::RunBenchmarkProgram(argc, argv, "dsp", [](testing::BenchmarkSuite& suite) {
+        TimeConvolutions(suite);
+        TimeTransforms(suite);
+    });
 }
@@ -19,5 +19,20 @@ namespace emittable_functions
 
     void SimpleDepthwiseSeparableConvolve2D(value::Tensor signal, value::Tensor filter, value::Scalar rowStride,
                                             value::Scalar columnStride, value::Tensor output);
+
+    /// <summary> Depthwise separable convolution with the same semantics as SimpleDepthwiseSeparableConvolve2D, emitted
+    /// as a loop nest whose innermost loop runs over `vectorSize` consecutive elements of the signal. When the channels
+    /// are the innermost dimension of the signal's layout, the channels are processed in blocks of `vectorSize`;
+    /// otherwise each channel is processed separately, `vectorSize` output columns at a time. The filter loops are
+    /// unrolled, so the filter size should be small. </summary>
+    ///
+    /// <param name="signal"> The input, explicitly padded. </param>
+    /// <param name="filter"> The filter, one filter row and column per channel. </param>
+    /// <param name="rowStride"> The stride between input rows. </param>
+    /// <param name="columnStride"> The stride between input columns. </param>
+    /// <param name="output"> The output, with as many channels as the signal. </param>
+    /// <param name="vectorSize"> The number of elements processed together, usually the target's vector width. </param>
+    void BlockedDepthwiseSeparableConvolve2D(value::Tensor signal, value::Tensor filter, value::Scalar rowStride,
+                                             value::Scalar columnStride, value::Tensor output, int vectorSize = 8);
 } // namespace emittable_functions
 } // namespace ell
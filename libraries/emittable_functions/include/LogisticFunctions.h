@@ -20,6 +20,15 @@ namespace emittable_functions
     /// <param name="output"> The output vector to write result to. </param>
     void Softmax(value::Vector input, value::Vector output);
 
+    /// <summary> Apply the softmax function to the given input, `vectorSize` elements at a time. The max and the sum
+    /// of the exponents are each reduced into `vectorSize` partial results, and the exponents are stored while they are
+    /// summed, so the input is only read twice. </summary>
+    ///
+    /// <param name="input"> The input vector remains unchanged. </param>
+    /// <param name="output"> The output vector to write result to. </param>
+    /// <param name="vectorSize"> The number of elements processed together, usually the target's vector width. </param>
+    void VectorizedSoftmax(value::Vector input, value::Vector output, int vectorSize = 8);
+
     value::Scalar Sigmoid(value::Scalar s);
 
     value::Scalar HardSigmoid(value::Scalar s);
@@ -13,6 +13,7 @@
 #include <utilities/include/IArchivable.h>
 #include <utilities/include/TypeName.h>
 
+#include <value/include/Matrix.h>
 #include <value/include/Vector.h>
 
 #include <cmath>
@@ -66,6 +67,13 @@ namespace emittable_functions
         /// <returns> returns 1 when it detects activity in the stream and 0 otherwise  </returns>
         ell::value::Scalar Process(ell::value::Vector data);
 
+        /// <summary> process many consecutive frames of an audio stream at once, as if each were given to `Process` in turn.
+        /// The power of every frame is computed by one matrix-vector product before the frames are classified.
+        ///
+        /// <param name="frames"> The input signal, one frame per row. </param>
+        /// <param name="signals"> The output, with one element per frame: 1 when activity is detected in the frame and 0 otherwise. </param>
+        void ProcessFrames(ell::value::Matrix frames, ell::value::Vector signals);
+
         /// <summary> return true if the two detectors have the same sample rate and window size </summary>
         bool Equals(const VoiceActivityDetector& other) const;
 
@@ -10,8 +10,11 @@
 
 #include <value/include/ComputeContext.h>
 #include <value/include/EmitterContext.h>
+#include <value/include/LoopNest.h>
 #include <value/include/Tensor.h>
 
+#include <utilities/include/Exception.h>
+
 #include <iostream>
 
 namespace ell
@@ -20,6 +23,59 @@ namespace emittable_functions
 {
     using namespace value;
 
+    namespace
+    {
+        // Accumulates the depthwise convolution into the channels [firstChannel, firstChannel + numChannels) and the
+        // output columns [firstColumn, firstColumn + numColumns) of `output`. The innermost loop runs over `vectorSize`
+        // channels or columns, which must divide `numChannels` or `numColumns`, so that it needs no bounds check.
+        void AccumulateDepthwiseSeparableConvolve2DBlock(Tensor signal,
+                                                         Tensor filter,
+                                                         Scalar rowStride,
+                                                         Scalar columnStride,
+                                                         Tensor output,
+                                                         int firstChannel,
+                                                         int numChannels,
+                                                         int firstColumn,
+                                                         int numColumns,
+                                                         bool vectorizeChannels,
+                                                         int vectorSize)
+        {
+            if (numChannels == 0 || numColumns == 0)
+            {
+                return;
+            }
+
+            const int filterRows = static_cast<int>(filter.Rows());
+            const int filterColumns = static_cast<int>(filter.Columns());
+            LoopNest nest({ numChannels, static_cast<int>(output.Rows()), numColumns, filterRows, filterColumns });
+            auto channel = nest.GetIndex(0);
+            auto row = nest.GetIndex(1);
+            auto column = nest.GetIndex(2);
+            auto filterRow = nest.GetIndex(3);
+            auto filterColumn = nest.GetIndex(4);
+            if (vectorizeChannels)
+            {
+                auto [channelBlock, channelLane] = nest.Split(channel, vectorSize);
+                nest.Reorder({ channelBlock, row, column, filterRow, filterColumn, channelLane });
+                nest.Unroll(filterRow).Unroll(filterColumn).Vectorize(channelLane);
+            }
+            else
+            {
+                auto [columnBlock, columnLane] = nest.Split(column, vectorSize);
+                nest.Reorder({ channel, row, columnBlock, filterRow, filterColumn, columnLane });
+                nest.Unroll(filterRow).Unroll(filterColumn).Vectorize(columnLane);
+            }
+
+            nest.Run([&](std::vector<Scalar> index) {
+                Scalar outChannel = index[0] + firstChannel;
+                Scalar outColumn = index[2] + firstColumn;
+                Scalar inputRow = index[1] * rowStride + index[3];
+                Scalar inputColumn = outColumn * columnStride + index[4];
+                output(index[1], outColumn, outChannel) += signal(inputRow, inputColumn, outChannel) * filter(index[3], index[4], outChannel);
+            });
+        }
+    } // namespace
+
     void SimpleConvolve1D(Vector signal, Vector filter, Vector output)
     {
         For(output, [&](Scalar index) {
@@ -61,5 +117,40 @@ namespace emittable_functions
             });
         });
     }
+
+    void BlockedDepthwiseSeparableConvolve2D(Tensor signal,
+                                             Tensor filter,
+                                             Scalar rowStride,
+                                             Scalar columnStride,
+                                             Tensor output,
+                                             int vectorSize)
+    {
+        if (vectorSize <= 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "vectorSize must be positive");
+        }
+
+        For(output, [&](Scalar row, Scalar column, Scalar channel) {
+            output(row, column, channel) = Cast(0, output.Type());
+        });
+
+        // Vectorize along whichever of the channels and the columns is contiguous in memory. The elements left over
+        // after the last whole vector are done by a nest of their own, whose vector is as long as the remainder.
+        const int numChannels = static_cast<int>(output.Channels());
+        const int numColumns = static_cast<int>(output.Columns());
+        const auto& layout = signal.GetValue().GetLayout();
+        if (layout.GetPhysicalDimension(2) == 2)
+        {
+            const int mainChannels = numChannels - numChannels % vectorSize;
+            AccumulateDepthwiseSeparableConvolve2DBlock(signal, filter, rowStride, columnStride, output, 0, mainChannels, 0, numColumns, true, vectorSize);
+            AccumulateDepthwiseSeparableConvolve2DBlock(signal, filter, rowStride, columnStride, output, mainChannels, numChannels - mainChannels, 0, numColumns, true, numChannels - mainChannels);
+        }
+        else
+        {
+            const int mainColumns = numColumns - numColumns % vectorSize;
+            AccumulateDepthwiseSeparableConvolve2DBlock(signal, filter, rowStride, columnStride, output, 0, numChannels, 0, mainColumns, false, vectorSize);
+            AccumulateDepthwiseSeparableConvolve2DBlock(signal, filter, rowStride, columnStride, output, 0, numChannels, mainColumns, numColumns - mainColumns, false, numColumns - mainColumns);
+        }
+    }
 } // namespace emittable_functions
 } // namespace ell
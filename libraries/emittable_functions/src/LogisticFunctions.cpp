@@ -10,10 +10,15 @@
 
 #include <value/include/ComputeContext.h>
 #include <value/include/EmitterContext.h>
+#include <value/include/LoopNest.h>
 #include <value/include/Vector.h>
 #include <value/include/Scalar.h>
 #include <value/include/ScalarOperations.h>
 
+#include <utilities/include/Exception.h>
+
+#include <functional>
+
 namespace ell
 {
 namespace emittable_functions
@@ -39,6 +44,76 @@ namespace emittable_functions
         output /= sum;
     }
 
+    void VectorizedSoftmax(value::Vector input, value::Vector output, int vectorSize)
+    {
+        if (vectorSize <= 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "vectorSize must be positive");
+        }
+
+        const auto type = input.GetType();
+        const int size = static_cast<int>(input.Size());
+        const int numBlocks = size / vectorSize;
+        const int mainSize = numBlocks * vectorSize;
+        const Scalar zero = Cast(0, type);
+
+        // Calls `kernel` with the index of each element in whole blocks, and its lane within the block. The lanes are
+        // unrolled, so the operations on consecutive lanes can be turned into vector instructions.
+        auto forEachBlockElement = [&](std::function<void(Scalar, Scalar)> kernel) {
+            if (numBlocks == 0)
+            {
+                return;
+            }
+            LoopNest nest({ numBlocks, vectorSize });
+            nest.Vectorize(nest.GetIndex(1));
+            nest.Run([&](std::vector<Scalar> index) {
+                kernel(index[0] * vectorSize + index[1], index[1]);
+            });
+        };
+
+        // Calls `kernel` with the index of each element after the last whole block
+        auto forEachTailElement = [&](std::function<void(Scalar)> kernel) {
+            if (mainSize < size)
+            {
+                ForRange(mainSize, size, kernel);
+            }
+        };
+
+        // One partial max or sum per lane
+        Vector lanes = Allocate(type, utilities::MemoryLayout({ vectorSize }));
+
+        Scalar max = Allocate(type, utilities::ScalarLayout);
+        max = input(0);
+        if (numBlocks > 0)
+        {
+            ForRange(vectorSize, [&](Scalar lane) { lanes(lane) = input(lane); });
+            forEachBlockElement([&](Scalar index, Scalar lane) { lanes(lane) = Max(lanes(lane), input(index)); });
+            ForRange(vectorSize, [&](Scalar lane) { max = Max(max, lanes(lane)); });
+        }
+        forEachTailElement([&](Scalar index) { max = Max(max, input(index)); });
+
+        // Store the exponents while summing them
+        Scalar sum = Allocate(type, utilities::ScalarLayout);
+        sum = zero;
+        ForRange(vectorSize, [&](Scalar lane) { lanes(lane) = zero; });
+        forEachBlockElement([&](Scalar index, Scalar lane) {
+            Scalar e = Exp(input(index) - max);
+            output(index) = e;
+            lanes(lane) += e;
+        });
+        ForRange(vectorSize, [&](Scalar lane) { sum += lanes(lane); });
+        forEachTailElement([&](Scalar index) {
+            Scalar e = Exp(input(index) - max);
+            output(index) = e;
+            sum += e;
+        });
+
+        Scalar scale = Allocate(type, utilities::ScalarLayout);
+        scale = Cast(1, type) / sum;
+        forEachBlockElement([&](Scalar index, Scalar) { output(index) *= scale; });
+        forEachTailElement([&](Scalar index) { output(index) *= scale; });
+    }
+
     value::Scalar Sigmoid(value::Scalar x)
     {
         Scalar zero = Cast(0, x.GetType());
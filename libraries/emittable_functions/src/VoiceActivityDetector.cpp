@@ -9,6 +9,7 @@
 #include "VoiceActivityDetector.h"
 
 #include <value/include/EmitterContext.h>
+#include <value/include/MatrixOperations.h>
 
 #include <algorithm>
 #include <cassert>
@@ -322,6 +323,40 @@ namespace emittable_functions
         return signal;
     }
 
+    void VoiceActivityDetector::ProcessFrames(Matrix frames, Vector signals)
+    {
+        if (frames.Columns() != static_cast<size_t>(_impl->_windowSize))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument,
+                                            "frame length should match windowSize");
+        }
+        if (signals.Size() != frames.Rows())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument,
+                                            "signals should have one element per frame");
+        }
+
+        _impl->_time = StaticAllocate("time", int64_t{ 0 });
+
+        auto dataType = frames.Type();
+        Vector weights = GetWeights();
+        Scalar windowSize = Cast(_impl->_windowSize, dataType);
+        Scalar frameDuration = Cast(_impl->_frameDuration, dataType);
+
+        // The levels don't depend on the tracker's state, so only the classification runs frame by frame
+        Vector levels = GEMV(frames, Cast(weights, dataType));
+
+        ForRange(static_cast<int>(frames.Rows()), [&](Scalar frame) {
+            Scalar level = levels(frame) / windowSize;
+
+            Scalar castedTime = Cast(_impl->_time, dataType);
+            Scalar t = castedTime * frameDuration;
+            ++_impl->_time;
+
+            signals(frame) = _impl->_tracker.Classify(t, level);
+        });
+    }
+
     const std::vector<double>& VoiceActivityDetector::GetWeights() const { return _impl->_cmw.GetWeights(); }
 
     bool VoiceActivityDetector::Equals(const VoiceActivityDetector& other) const
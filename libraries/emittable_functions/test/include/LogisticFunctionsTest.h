@@ -17,6 +17,7 @@ namespace ell
 {
 
 void TestSoftmax();
+void TestVectorizedSoftmax();
 void TestSigmoid();
 void TestHardSigmoid();
 
@@ -28,8 +28,10 @@
 #include <value/include/Value.h>
 #include <value/include/Vector.h>
 
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -41,42 +43,90 @@ using namespace ell::emittable_functions;
 namespace ell
 {
 
-void test_simpleDepthwiseSeparableConvolve2D()
+namespace
 {
-    auto input = std::vector<double>{ 1, 2, 3, 4, 5, 6, 1, 1, 1, 2, 3, 4, 9, 8, 7, 1, 2, 3 };
-    auto filter = std::vector<double>{ 1, 2, 2, 1, 1, 1, -1, 0 };
-    auto expected = std::vector<double>{ 18, 24, 17, 20, -4, -1, 16, 13 };
-
-    Tensor inputTensor({ input, MemoryLayout({ 2, 3, 3 }, DimensionOrder(ChannelMajorTensorOrder)) });
-    Tensor filterTensor({ filter, MemoryLayout({ 2, 2, 2 }, DimensionOrder(ChannelMajorTensorOrder)) });
-    Tensor outputTensor(GlobalAllocate("result_test_SimpleDepthwiseSeparableConvolve2D",
-                                       ValueType::Double,
-                                       MemoryLayout({ 2, 2, 2 }, DimensionOrder(ChannelMajorTensorOrder))));
-
-    math::ColumnRowChannelTensor<double> expectedTensor(2, 2, 2, expected);
-
-    auto convolve2D = DeclareFunction("testSimpleDepthwiseSeparableConvolve2D")
-                          .Parameters(inputTensor.GetValue(),
-                                      filterTensor.GetValue(),
-                                      Value(ValueType::Int32, ScalarLayout),
-                                      Value(ValueType::Int32, ScalarLayout),
-                                      outputTensor.GetValue())
-                          .Define(SimpleDepthwiseSeparableConvolve2D);
-
-    InvokeForContext<ComputeContext>([&](auto&) {
-        bool ok = true;
-        convolve2D(inputTensor, filterTensor, 1, 1, outputTensor);
-        For(outputTensor, [&](Scalar row, Scalar col, Scalar channel) {
-            int rowInt = row.Get<int>(), colInt = col.Get<int>(), channelInt = channel.Get<int>();
-            double expected = expectedTensor(rowInt, colInt, channelInt);
-            double actual = outputTensor(row, col, channel).Get<double>();
-
-            ok &= testing::IsEqual(expected, actual);
+    using DepthwiseSeparableConvolve2DFunction = std::function<void(Tensor, Tensor, Scalar, Scalar, Tensor)>;
+
+    std::vector<double> ToRowMajorOrder(const std::vector<double>& channelMajorData, int rows, int columns, int channels)
+    {
+        std::vector<double> result(channelMajorData.size());
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            for (int row = 0; row < rows; ++row)
+            {
+                for (int column = 0; column < columns; ++column)
+                {
+                    result[(row * columns + column) * channels + channel] = channelMajorData[(channel * rows + row) * columns + column];
+                }
+            }
+        }
+        return result;
+    }
+
+    void TestDepthwiseSeparableConvolve2D(const std::string& name, DepthwiseSeparableConvolve2DFunction convolve, DimensionOrder order)
+    {
+        auto input = std::vector<double>{ 1, 2, 3, 4, 5, 6, 1, 1, 1, 2, 3, 4, 9, 8, 7, 1, 2, 3 };
+        auto filter = std::vector<double>{ 1, 2, 2, 1, 1, 1, -1, 0 };
+        auto expected = std::vector<double>{ 18, 24, 17, 20, -4, -1, 16, 13 };
+
+        // The data is given in channel-major order
+        auto inputLayout = MemoryLayout({ 2, 3, 3 }, DimensionOrder(ChannelMajorTensorOrder));
+        auto filterLayout = MemoryLayout({ 2, 2, 2 }, DimensionOrder(ChannelMajorTensorOrder));
+        if (order != DimensionOrder(ChannelMajorTensorOrder))
+        {
+            input = ToRowMajorOrder(input, 3, 3, 2);
+            filter = ToRowMajorOrder(filter, 2, 2, 2);
+            inputLayout = MemoryLayout({ 3, 3, 2 }, order);
+            filterLayout = MemoryLayout({ 2, 2, 2 }, order);
+        }
+        Tensor inputTensor({ input, inputLayout });
+        Tensor filterTensor({ filter, filterLayout });
+        Tensor outputTensor(GlobalAllocate("result_test_" + name, ValueType::Double, MemoryLayout({ 2, 2, 2 }, order)));
+
+        math::ColumnRowChannelTensor<double> expectedTensor(2, 2, 2, expected);
+
+        auto convolve2D = DeclareFunction("test" + name)
+                              .Parameters(inputTensor.GetValue(),
+                                          filterTensor.GetValue(),
+                                          Value(ValueType::Int32, ScalarLayout),
+                                          Value(ValueType::Int32, ScalarLayout),
+                                          outputTensor.GetValue())
+                              .Define(convolve);
+
+        InvokeForContext<ComputeContext>([&](auto&) {
+            bool ok = true;
+            convolve2D(inputTensor, filterTensor, 1, 1, outputTensor);
+            For(outputTensor, [&](Scalar row, Scalar col, Scalar channel) {
+                int rowInt = row.Get<int>(), colInt = col.Get<int>(), channelInt = channel.Get<int>();
+                double expected = expectedTensor(rowInt, colInt, channelInt);
+                double actual = outputTensor(row, col, channel).Get<double>();
+
+                ok &= testing::IsEqual(expected, actual);
+            });
+            testing::ProcessTest("Testing " + name, ok);
         });
-        testing::ProcessTest("Testing DepthwiseSeparableConvolve2D", ok);
-    });
 
-    InvokeForContext<TestLLVMContext>(PrintIR);
+        InvokeForContext<TestLLVMContext>(PrintIR);
+    }
+} // namespace
+
+void test_simpleDepthwiseSeparableConvolve2D()
+{
+    TestDepthwiseSeparableConvolve2D("SimpleDepthwiseSeparableConvolve2D", SimpleDepthwiseSeparableConvolve2D, DimensionOrder(ChannelMajorTensorOrder));
+}
+
+void test_blockedDepthwiseSeparableConvolve2D()
+{
+    // Vectors that divide the channels or columns, and ones that leave a remainder
+    for (int vectorSize : { 1, 2, 4 })
+    {
+        DepthwiseSeparableConvolve2DFunction convolve = [vectorSize](Tensor signal, Tensor filter, Scalar rowStride, Scalar columnStride, Tensor output) {
+            BlockedDepthwiseSeparableConvolve2D(signal, filter, rowStride, columnStride, output, vectorSize);
+        };
+        auto suffix = std::to_string(vectorSize);
+        TestDepthwiseSeparableConvolve2D("BlockedDepthwiseSeparableConvolve2D_channelMajor_" + suffix, convolve, DimensionOrder(ChannelMajorTensorOrder));
+        TestDepthwiseSeparableConvolve2D("BlockedDepthwiseSeparableConvolve2D_rowMajor_" + suffix, convolve, DimensionOrder(RowMajorTensorOrder));
+    }
 }
 
 } // namespace ell
@@ -25,6 +25,7 @@
 
 #include <emittable_functions/include/LogisticFunctions.h>
 
+#include <string>
 #include <type_traits>
 #include <vector>
 
@@ -54,6 +55,27 @@ void TestSoftmax()
     InvokeForContext<TestLLVMContext>(PrintIR);
 }
 
+void TestVectorizedSoftmax()
+{
+    auto input = std::vector<double>{ 1, 2, 3, 4, 5 };
+    auto expected = std::vector<double>{ 0.01165623, 0.03168492, 0.08612854, 0.23412166, 0.63640865 };
+
+    // Vectors that divide the input, ones that leave a remainder, and one longer than the input
+    for (int vectorSize : { 1, 2, 4, 5, 8 })
+    {
+        InvokeForContext<ComputeContext>([&](auto&) {
+            Vector inputVector(input);
+            Vector output = MakeVector<double>(inputVector.Size());
+            VectorizedSoftmax(input, output, vectorSize);
+            double* buffer = output.GetValue().Get<double*>();
+            std::vector<double> actual(buffer, buffer + output.Size());
+            bool ok = testing::IsEqual(expected, actual);
+            testing::ProcessTest("Testing VectorizedSoftmax with vector size " + std::to_string(vectorSize), ok);
+        });
+    }
+
+    InvokeForContext<TestLLVMContext>(PrintIR);
+}
 
 void TestSigmoid()
 {
@@ -22,6 +22,8 @@
 
 #include <value/include/ComputeContext.h>
 #include <value/include/EmitterContext.h>
+#include <value/include/Matrix.h>
+#include <value/include/Vector.h>
 
 #include <algorithm>
 #include <iostream>
@@ -83,6 +85,44 @@ void TestVoiceActivityDetectorInternal(const std::string& filename, VoiceActivit
     });
 }
 
+template <typename ValueType>
+void TestVoiceActivityDetectorFramesInternal(const std::string& filename, VoiceActivityDetector& vad, int frameSize)
+{
+    // load the whole dataset as one batch of frames
+    std::vector<std::vector<ValueType>> frames;
+    std::vector<int> expected;
+    auto stream = utilities::OpenIfstream(filename);
+    data::AutoSupervisedExampleIterator exampleIterator = ell::common::GetAutoSupervisedExampleIterator(stream);
+    while (exampleIterator.IsValid())
+    {
+        auto example = exampleIterator.Get();
+        std::vector<double> data = example.GetDataVector().ToArray();
+        std::vector<ValueType> buffer;
+        std::transform(data.begin(), data.end(), std::back_inserter(buffer), [](double x) {
+            return static_cast<ValueType>(x);
+        });
+        buffer.resize(frameSize); // fix AutoDataVector possible compression
+        frames.push_back(buffer);
+        expected.push_back(static_cast<int>(example.GetMetadata().label));
+        exampleIterator.Next();
+    }
+
+    auto numFrames = static_cast<int>(frames.size());
+    auto vadfn = DeclareFunction("ProcessFramesTest")
+                     .Parameters(Value{ GetValueType<ValueType>(), MemoryLayout({ numFrames, frameSize }) },
+                                 Value{ GetValueType<int>(), MemoryLayout({ numFrames }) })
+                     .Define([&vad](Matrix frames, Vector signals) { vad.ProcessFrames(frames, signals); });
+
+    InvokeForContext<ComputeContext>([&](auto&) {
+        Vector signals = MakeVector<int>(numFrames);
+        vadfn(Matrix(frames), signals);
+
+        int* buffer = signals.GetValue().Get<int*>();
+        std::vector<int> actual(buffer, buffer + numFrames);
+        testing::ProcessTest(FormatString("Testing %s on a batch of frames", typeid(VoiceActivityDetector).name()), actual == expected);
+    });
+}
+
 template <typename ValueType>
 void TestVoiceActivityDetector(const std::string& path)
 {
@@ -105,6 +145,7 @@ void TestVoiceActivityDetector(const std::string& path)
     }
 
     TestVoiceActivityDetectorInternal<ValueType>(filename, vad, FrameSize);
+    TestVoiceActivityDetectorFramesInternal<ValueType>(filename, vad, FrameSize);
 
     // test serialization
 
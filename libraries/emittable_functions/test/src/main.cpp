@@ -39,6 +39,7 @@ int main(int argc, char* argv[])
             value::ContextGuard<> guard(*context);
 
             TestSoftmax();
+            TestVectorizedSoftmax();
             TestSigmoid();
             TestHardSigmoid();
 
@@ -48,6 +49,7 @@ int main(int argc, char* argv[])
             TestIIRFilter();
 
             test_simpleDepthwiseSeparableConvolve2D();
+            test_blockedDepthwiseSeparableConvolve2D();
         }
     }
     catch (const Exception& exception)
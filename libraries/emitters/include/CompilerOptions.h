@@ -14,6 +14,9 @@
 #include <utilities/include/PropertyBag.h>
 #include <utilities/include/StringUtil.h>
 
+#include <string>
+#include <vector>
+
 namespace ell
 {
 namespace emitters
@@ -28,6 +31,61 @@ namespace emitters
 
     std::string ToString(BlasType t);
 
+    /// <summary> Formats that constant data, such as model weights, can be stored in by the emitted module. </summary>
+    enum class WeightStorageType
+    {
+        float32 = 0,
+        float16, // IEEE half precision
+        bfloat16 // the upper 16 bits of an IEEE single-precision value
+    };
+
+    std::string ToString(WeightStorageType t);
+
+    /// <summary> How accurately math functions such as exp, log and tanh are computed when `useFastMath` is on. </summary>
+    enum class FastMathAccuracy
+    {
+        exact = 0, // call the standard library
+        high, // inline approximations within a few ulp of the standard library
+        low // cheaper inline approximations, with a relative error around 1e-4 for exp
+    };
+
+    std::string ToString(FastMathAccuracy t);
+
+    /// <summary> How a parallel loop divides its iterations between its tasks. </summary>
+    enum class ParallelLoopSchedule
+    {
+        staticBlocks = 0, // each task runs one contiguous block of iterations, of the same size
+        dynamic, // each task repeatedly takes the next chunk of iterations, until none are left
+        guided // like dynamic, but a task takes a share of the remaining iterations, so the chunks shrink as the loop nears its end
+    };
+
+    std::string ToString(ParallelLoopSchedule t);
+
+    /// <summary> What the LLVM optimizer favors when speed and code size pull in different directions. </summary>
+    enum class SizeOptimization
+    {
+        speed = 0, // like -O3
+        size, // like -Os: optimize for speed, but not at the cost of much more code
+        minSize // like -Oz: make the code as small as possible, without vectorizing or unrolling loops
+    };
+
+    std::string ToString(SizeOptimization t);
+
+    /// <summary> Parses a list of CPU core indices, such as "0,2,4-7". Duplicates are kept, since they put several workers
+    /// on the same core. Throws an `InputException` for anything but non-negative numbers and increasing ranges. </summary>
+    ///
+    /// <param name="coreList"> The comma-separated list of core indices and inclusive ranges of core indices. </param>
+    ///
+    /// <returns> The core indices, in the order given. </returns>
+    std::vector<int> ParseCoreList(const std::string& coreList);
+
+    /// <summary> Parses a list of x86 instruction set levels to dispatch between, such as "sse4.2,avx2". </summary>
+    ///
+    /// <param name="levelList"> The comma-separated list of levels. </param>
+    ///
+    /// <returns> The levels, in the order given. </returns>
+    std::vector<std::string> ParseCpuDispatchLevels(const std::string& levelList);
+
     /// <summary> Standard compiler switches. </summary>
     struct CompilerOptions
     {
@@ -43,6 +101,21 @@ namespace emitters
         /// <summary> Optimize output code using LLVM. </summary>
         bool optimize = true;
 
+        /// <summary> Number of threads to run the LLVM optimizer on. With more than one, the module's functions are divided into partitions that are optimized concurrently, and functions aren't inlined across partitions. </summary>
+        int optimizationThreads = 1;
+
+        /// <summary> Optimization level of the LLVM pass pipeline, from 0 to 3. For a node, 0 leaves the node's function unoptimized, and the other levels use the module's pipeline. </summary>
+        int optimizationLevel = 3;
+
+        /// <summary> Optimize for code size instead of speed. For a node, this applies to the node's function, so hot nodes can be optimized for speed and the rest for size. </summary>
+        SizeOptimization sizeOptimization = SizeOptimization::speed;
+
+        /// <summary> Let the LLVM optimizer inline functions into their callers. For a node, whether the node's function can be inlined. </summary>
+        bool allowInlining = true;
+
+        /// <summary> Seconds the LLVM optimizer can spend on the module (0 means no limit). Functions it hasn't optimized by then are compiled unoptimized. </summary>
+        double maxOptimizationSeconds = 0;
+
         /// <summary> The specific BLAS implementation to link to ('unknown' will choose whatever is available). </summary>
         BlasType blasType = BlasType::unknown;
 
@@ -52,18 +125,65 @@ namespace emitters
         /// <summary> Emit profiling code, </summary>
         bool profile = false;
 
+        /// <summary> Also sample the CPU's hardware performance counters (cycles, instructions, cache and branch misses) in profiled code (if profiling enabled). </summary>
+        bool profileHardwareCounters = false;
+
+        /// <summary> Also keep a histogram of the latency of the model and of each node in profiled code (if profiling enabled). </summary>
+        bool profileLatencyHistograms = false;
+
+        /// <summary> Only update the profiling counters on every Nth call to the model function (if profiling enabled). </summary>
+        int profileSamplingInterval = 1;
+
+        /// <summary> Also record a timeline of node evaluations, profile regions and parallel tasks that can be written as a Chrome trace (if profiling enabled). </summary>
+        bool traceExecution = false;
+
         /// <summary> Enable ELL's parallelization. </summary>
         bool parallelize = false;
 
         /// <summary> Use thread pool for parallelization (if parallelization enabled). </summary>
         bool useThreadPool = true;
 
+        /// <summary> Give each thread pool worker its own task deque and let idle workers steal tasks (if thread pool enabled). </summary>
+        bool useWorkStealing = false;
+
+        /// <summary> Number of times an idle thread pool worker, or a thread waiting for its tasks, polls for work before it blocks
+        /// on a condition variable (if thread pool enabled). Polling avoids the latency of waking a blocked thread when tasks arrive soon. </summary>
+        int threadPoolSpinCount = 0;
+
+        /// <summary> Keep the thread pool workers polling for work, instead of blocking, for the duration of each predict call (if thread pool enabled). </summary>
+        bool hotThreadPool = false;
+
+        /// <summary> Align the module's global buffers of at least 2 MB (weights, node outputs and the memory arena) to 2 MB, and
+        /// advise the kernel to back them with transparent huge pages when the module is loaded, to reduce TLB misses (Linux targets only). </summary>
+        bool useHugePages = false;
+
+        /// <summary> When the module is loaded, have the thread pool workers write the large zero-initialized buffers first, each worker
+        /// the block a static parallel loop over the buffer gives it, so on NUMA machines their pages are allocated on the nodes of the
+        /// threads that use them (if parallelization enabled). </summary>
+        bool firstTouchBuffers = false;
+
+        /// <summary> Run parallel tasks on the thread pool of the ELL runtime library, which all the models in a process share, and
+        /// let the runtime set BLAS thread counts and collect the profilers, instead of emitting the module's own thread pool. </summary>
+        bool useSharedRuntime = false;
+
+        /// <summary> How parallel loops divide their iterations between their tasks, unless a loop asks for a schedule of its own. </summary>
+        ParallelLoopSchedule parallelLoopSchedule = ParallelLoopSchedule::staticBlocks;
+
+        /// <summary> Number of iterations a task takes at a time in a dynamic parallel loop, or at least in a guided one. 0 means a size picked from the number of iterations. </summary>
+        int parallelLoopChunkSize = 0;
+
         /// <summary> Maximum num of parallel threads. </summary>
         int maxThreads = 4;
 
+        /// <summary> CPU cores to pin thread pool workers to; worker i runs on core `threadAffinity[i % size]`. Empty means no pinning. </summary>
+        std::vector<int> threadAffinity;
+
         /// <summary> Allow emitting more efficient code that isn't necessarily IEEE-754 compatible. </summary>
         bool useFastMath = true;
 
+        /// <summary> With `useFastMath`, emit inline polynomial approximations of exp, log, tanh and sigmoid that can be vectorized, instead of calls to the standard library (unless `exact`). </summary>
+        FastMathAccuracy fastMathAccuracy = FastMathAccuracy::high;
+
         /// <summary> Allow printing of diagnostic messages from the compiled model. </summary>
         bool includeDiagnosticInfo = false;
 
@@ -74,6 +194,41 @@ namespace emitters
         /// <summary> Emit code that calls an external BLAS library. </summary>
         bool useBlas = true;
 
+        /// <summary> Maximum number of threads of an emitted OpenBLAS call. 0 means `maxThreads` if ELL's parallelization is off, and 1 if it's on, so OpenBLAS's threads don't compete with ELL's for cores. </summary>
+        int blasThreads = 0;
+
+        /// <summary> Number of multiply-adds that make it worth giving an emitted OpenBLAS call another thread. Smaller calls run single-threaded. </summary>
+        int blasMinOperationsPerThread = 1 << 15;
+
+        /// <summary> Emit a cache-blocked, packed, parallel matrix multiply for GEMM (and a row-parallel GEMV) when BLAS isn't used (otherwise a simple loop nest is emitted). </summary>
+        bool useBlockedGemm = true;
+
+        /// <summary> GEMM and GEMV calls of at most this many multiply-adds are emitted as fully unrolled code, one register
+        /// tile of the output at a time, instead of BLAS calls or loops (0, the default, means never). </summary>
+        int smallGemmThreshold = 0;
+
+        /// <summary> Run GEMM calls of at least `gpuMinOperations` multiply-adds on the GPU, through the ELL runtime library
+        /// (which falls back to the CPU if it was built without CUDA or there's no device). Smaller products stay on the CPU. </summary>
+        bool useGpu = false;
+
+        /// <summary> The number of multiply-adds that make it worth moving a GEMM call to the GPU. </summary>
+        int gpuMinOperations = 1 << 22;
+
+        /// <summary> Emit calls to the CMSIS-DSP library (which must be linked with the model) for the int8 dot products of
+        /// the quantized layers and for real FFTs, on Cortex-M targets. </summary>
+        bool useCmsis = false;
+
+        /// <summary> The format to store floating-point weights in. Nodes that read their weights through
+        /// `IRFunctionEmitter::WeightValueAt`, `WeightsDotProduct` or `CallGEMM` convert reduced-precision weights back to
+        /// full precision as they load them. Weights are rounded to nearest even, and NaN weights are stored as 0. In float16,
+        /// weights beyond the largest finite value (65504), including infinities, saturate to it; in bfloat16, weights that
+        /// round past the largest finite value become infinities. </summary>
+        WeightStorageType weightStorageType = WeightStorageType::float32;
+
+        /// <summary> How far ahead, in bytes, loops that stream through weights and inputs (matrix-vector products, DTW prototypes and
+        /// forest node arrays) prefetch them. Negative uses the target device's distance, and 0 turns prefetching off. </summary>
+        int prefetchDistance = -1;
+
         /// <summary> Explicitly unroll loops in certain cases. </summary>
         bool unrollLoops = false;
 
@@ -86,6 +241,9 @@ namespace emitters
         /// <summary> Size of vector units. </summary>
         int vectorWidth = 4;
 
+        /// <summary> x86 instruction set levels ("sse4.2", "avx2" or "avx512") to also compile the node functions for. Each node function calls the best version the CPU supports, found with `cpuid` on the first call (x86-64 targets only). </summary>
+        std::vector<std::string> cpuDispatchLevels;
+
         /// <summary> Emit debug code. </summary>
         bool debug = false;
 
@@ -102,5 +260,17 @@ namespace utilities
 {
     template <>
     emitters::BlasType FromString<emitters::BlasType>(const std::string& s);
+
+    template <>
+    emitters::WeightStorageType FromString<emitters::WeightStorageType>(const std::string& s);
+
+    template <>
+    emitters::FastMathAccuracy FromString<emitters::FastMathAccuracy>(const std::string& s);
+
+    template <>
+    emitters::ParallelLoopSchedule FromString<emitters::ParallelLoopSchedule>(const std::string& s);
+
+    template <>
+    emitters::SizeOptimization FromString<emitters::SizeOptimization>(const std::string& s);
 }
 } // namespace ell
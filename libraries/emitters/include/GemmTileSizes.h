@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     GemmTileSizes.h (emitters)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CompilerOptions.h"
+
+#include <vector>
+
+namespace ell
+{
+namespace emitters
+{
+    /// <summary>
+    /// The block sizes used by the blocked GEMM kernels. The product is computed one `mr` x `nr` register tile of the
+    /// output at a time, from a `kc`-deep slice of a packed `mc` x `kc` block of A and a packed `kc` x `nc` block of B.
+    /// `mc` is a multiple of `mr`, and `nc` a multiple of `nr`.
+    /// </summary>
+    struct GemmTileSizes
+    {
+        int mr;
+        int nr;
+        int kc;
+        int mc;
+        int nc;
+    };
+
+    /// <summary>
+    /// Gets the block sizes for a GEMM, from the cache sizes of the target device (or typical sizes, if the device
+    /// doesn't give them) and its vector width. The blocks are no larger than the problem needs.
+    /// </summary>
+    ///
+    /// <param name="options"> The compiler options. </param>
+    /// <param name="elementSize"> The size of a matrix element, in bytes. </param>
+    /// <param name="m"> The number of rows of A and C. </param>
+    /// <param name="n"> The number of columns of B and C. </param>
+    /// <param name="k"> The number of columns of A and rows of B. </param>
+    ///
+    /// <returns> The block sizes. </returns>
+    GemmTileSizes GetGemmTileSizes(const CompilerOptions& options, int elementSize, int m, int n, int k);
+
+    /// <summary> Indicates if a GEMM is small enough to be emitted as straight-line code. </summary>
+    bool IsSmallGemm(const CompilerOptions& options, int m, int n, int k);
+
+    /// <summary> Indicates if a GEMM is large enough to be computed on the GPU. </summary>
+    bool IsGpuGemm(const CompilerOptions& options, int m, int n, int k);
+
+    /// <summary> Indicates if a GEMM is computed by the emitted blocked GEMM kernel, rather than by a library call. </summary>
+    bool UsesBlockedGemm(const CompilerOptions& options, int m, int n, int k);
+
+    /// <summary>
+    /// Packs a row-major matrix A into the layout the blocked GEMM kernel reads it in, as the kernel would pack it at
+    /// run time: for each `mc`-row block of A and each `kc`-deep slice, `mc` / `mr` row panels of `kc` columns of `mr`
+    /// values each. Entries outside the matrix are zero.
+    /// </summary>
+    ///
+    /// <param name="tiles"> The block sizes of the kernel. </param>
+    /// <param name="transposeA"> If `true`, A is stored transposed. </param>
+    /// <param name="m"> The number of rows of op(A). </param>
+    /// <param name="k"> The number of columns of op(A). </param>
+    /// <param name="A"> The values of A. </param>
+    /// <param name="lda"> The stride of A, the number of elements between rows. </param>
+    ///
+    /// <returns> The packed values. </returns>
+    template <typename ValueType>
+    std::vector<ValueType> PackGemmLeftOperand(const GemmTileSizes& tiles, bool transposeA, int m, int k, const ValueType* A, int lda);
+
+    /// <summary>
+    /// Packs a row-major matrix B into the layout the blocked GEMM kernel reads it in, as the kernel would pack it at
+    /// run time: for each `nc`-column block of B and each `kc`-deep slice, `nc` / `nr` column panels of `kc` rows of
+    /// `nr` values each. Entries outside the matrix are zero.
+    /// </summary>
+    ///
+    /// <param name="tiles"> The block sizes of the kernel. </param>
+    /// <param name="transposeB"> If `true`, B is stored transposed. </param>
+    /// <param name="k"> The number of rows of op(B). </param>
+    /// <param name="n"> The number of columns of op(B). </param>
+    /// <param name="B"> The values of B. </param>
+    /// <param name="ldb"> The stride of B, the number of elements between rows. </param>
+    ///
+    /// <returns> The packed values. </returns>
+    template <typename ValueType>
+    std::vector<ValueType> PackGemmRightOperand(const GemmTileSizes& tiles, bool transposeB, int k, int n, const ValueType* B, int ldb);
+} // namespace emitters
+} // namespace ell
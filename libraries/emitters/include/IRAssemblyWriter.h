@@ -14,6 +14,9 @@
 #include <llvm/Target/TargetMachine.h> // for CodeGenFileType
 #include <llvm/Target/TargetOptions.h> // for FloatABI::ABIType and FPOpFusion::FpOpFusionMode
 
+#include <map>
+#include <string>
+
 namespace ell
 {
 namespace emitters
@@ -57,5 +60,13 @@ namespace emitters
 
     /// <summary> Compile the given module to the given stream </summary>
     void GenerateMachineCode(llvm::raw_ostream& os, IRModuleEmitter& module, ModuleOutputFormat format, const MachineCodeOutputOptions& options);
+
+    /// <summary> Compile the given LLVM module to the given stream </summary>
+    void GenerateMachineCode(llvm::raw_ostream& os, llvm::Module& module, ModuleOutputFormat format, const MachineCodeOutputOptions& options);
+
+    /// <summary> Compile a copy of the given module to object code, and get the size of the machine code of each function in it </summary>
+    ///
+    /// <returns> The size in bytes of each function in the object code, by name. </returns>
+    std::map<std::string, size_t> GetFunctionCodeSizes(IRModuleEmitter& module, const MachineCodeOutputOptions& options);
 } // namespace emitters
 } // namespace ell
@@ -10,6 +10,7 @@
 
 #include "LLVMUtilities.h"
 
+#include <string>
 #include <vector>
 
 namespace ell
@@ -84,5 +85,53 @@ namespace emitters
 
     /// <summary> Waits for all given tasks to finish </summary>
     void SyncAllTasks(IRFunctionEmitter& function, std::vector<IRAsyncTask>& tasks);
+
+    /// <summary>
+    /// Class that emits a task that keeps running after the function that started it returns. The thread handle and
+    /// the task's arguments are kept in globals, so a task started by one call of a function can be waited for by the
+    /// next one. Only one instance of the task runs at a time: starting it again waits for the previous one first.
+    /// When pthreads aren't available (or parallelization is turned off), or a thread can't be created, the task runs
+    /// synchronously when started. The module's reset function waits for the task to finish. The task function must
+    /// return void.
+    /// </summary>
+    class IRBackgroundTask
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="module"> The module to add the task's globals to. </param>
+        /// <param name="name"> The prefix of the names of the task's globals. </param>
+        /// <param name="taskFunction"> The function to run. </param>
+        IRBackgroundTask(IRModuleEmitter& module, const std::string& name, LLVMFunction taskFunction);
+
+        /// <summary> Start the task, after waiting for the previous instance of it to finish. If its thread can't be
+        /// created, the task runs synchronously. </summary>
+        ///
+        /// <param name="function"> The function currently being emitted into. </param>
+        /// <param name="arguments"> The arguments to pass to the task function. </param>
+        void Start(IRFunctionEmitter& function, const std::vector<LLVMValue>& arguments);
+
+        /// <summary> Wait for the task to finish, if it has been started. </summary>
+        ///
+        /// <param name="function"> The function currently being emitted into. </param>
+        void Wait(IRFunctionEmitter& function);
+
+        /// <summary> Returns an `int` that is nonzero if the task has been started and not waited for. </summary>
+        ///
+        /// <param name="function"> The function currently being emitted into. </param>
+        LLVMValue IsRunning(IRFunctionEmitter& function);
+
+        /// <summary> Indicates if the task runs on its own thread (as opposed to synchronously when started). </summary>
+        bool IsAsync() const { return UsePthreads(); }
+
+    private:
+        bool UsePthreads() const { return _usePthreads; }
+
+        LLVMFunction _taskFunction = nullptr;
+        bool _usePthreads = false;
+        LLVMValue _pthread = nullptr;
+        LLVMValue _taskArg = nullptr;
+        LLVMValue _isRunning = nullptr;
+    };
 } // namespace emitters
 } // namespace ell
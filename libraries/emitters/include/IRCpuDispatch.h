@@ -0,0 +1,38 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRCpuDispatch.h (emitters)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace emitters
+{
+    class IRModuleEmitter;
+
+    /// <summary> Indicates whether a target can dispatch between x86 instruction set levels at runtime. </summary>
+    ///
+    /// <param name="triple"> The target triple. </param>
+    ///
+    /// <returns> True if the target is x86-64. </returns>
+    bool SupportsCpuDispatch(const std::string& triple);
+
+    /// <summary>
+    /// Compiles each function with the given tag for several x86 instruction set levels, and replaces the function
+    /// with a dispatcher that calls the best version the CPU supports. The CPU is checked with `cpuid` on the first
+    /// call of any dispatcher in the module, and the result is kept for later calls. The original function is kept
+    /// as the version for CPUs that support none of the levels.
+    /// </summary>
+    ///
+    /// <param name="module"> The module, which must target x86-64. </param>
+    /// <param name="tag"> The function-level metadata tag of the functions to compile for several levels. </param>
+    /// <param name="levels"> The instruction set levels: "sse4.2", "avx2" or "avx512". </param>
+    void EmitCpuDispatch(IRModuleEmitter& module, const std::string& tag, const std::vector<std::string>& levels);
+} // namespace emitters
+} // namespace ell
@@ -15,6 +15,7 @@
 #include <llvm/IR/Module.h>
 
 #include <functional>
+#include <memory>
 #include <type_traits>
 
 namespace ell
@@ -38,7 +39,11 @@ namespace emitters
         /// <param name="verify"> Indicates if the execution engine should run a verification pass before running the code. </param>
         IRExecutionEngine(IRModuleEmitter&& module, bool verify = false);
 
-        /// <summary> Inject the primary "owner" module into the execution engine. </summary>
+        /// <summary>
+        /// Inject the primary "owner" module into the execution engine. The functions in it tagged with
+        /// `c_lazyFunctionTagName` are moved into modules of their own, and each is replaced by a stub that
+        /// JIT-compiles the function the first time it's called.
+        /// </summary>
         ///
         /// <param name="pModule"> The module. </param>
         /// <param name="verify"> Indicates if the execution engine should run a verification pass before running the code. </param>
@@ -47,11 +52,21 @@ namespace emitters
         /// <summary> Destructor </summary>
         ~IRExecutionEngine();
 
+        /// <summary> Set how much the JIT optimizes the machine code it generates. Must be called before any code is generated. </summary>
+        ///
+        /// <param name="level"> The code generation optimization level. </param>
+        void SetCodeGenerationLevel(llvm::CodeGenOpt::Level level);
+
         /// <summary> Add an additional module to the execution engine. </summary>
         ///
         /// <param name="pModule"> The module to add. </param>
         void AddModule(std::unique_ptr<llvm::Module> pModule);
 
+        /// <summary> Add previously compiled native object code to the execution engine. </summary>
+        ///
+        /// <param name="objectCode"> The contents of an object file compiled for the host. </param>
+        void AddObjectFile(const std::string& objectCode);
+
         /// <summary>
         /// Return the address of a named function, JITTing code as needed. Returns 0 if not found.
         /// </summary>
@@ -117,7 +132,21 @@ namespace emitters
         /// <summary> Resolve and run the default Main function, if any. </summary>
         void RunMain();
 
+        /// <summary> Gets the number of functions that are compiled the first time they're called. </summary>
+        ///
+        /// <returns> The number of lazily-compiled functions. </returns>
+        size_t NumLazyFunctions() const;
+
+        /// <summary> Gets the number of lazily-compiled functions that have been called, and so compiled, so far. </summary>
+        ///
+        /// <returns> The number of lazily-compiled functions that have been compiled. </returns>
+        size_t NumCompiledLazyFunctions() const;
+
     private:
+        struct LazyFunctions;
+
+        static void* ResolveLazyFunction(void* lazyFunctions, const char* name);
+        void DeferLazyFunctions(llvm::Module& module);
         void EnsureEngine();
         void EnsureClockGetTime();
         void PerformInitialization();
@@ -125,6 +154,7 @@ namespace emitters
 
         std::unique_ptr<llvm::EngineBuilder> _pBuilder;
         std::unique_ptr<llvm::ExecutionEngine> _pEngine;
+        std::unique_ptr<LazyFunctions> _lazyFunctions;
     };
 } // namespace emitters
 } // namespace ell
@@ -898,6 +898,27 @@ namespace emitters
         /// <returns> The value of the entry at the given offset in the array. </returns>
         LLVMValue ValueAt(llvm::GlobalVariable* pGlobal);
 
+        /// <summary> Get the value at an offset in an array of weights, converting it to the given type if the
+        /// weights are stored in reduced precision (see `IRModuleEmitter::WeightsArray`). </summary>
+        ///
+        /// <param name="pWeights"> Pointer to the weights. </param>
+        /// <param name="pOffset"> The offset. </param>
+        /// <param name="valueType"> The type to return the weight as. </param>
+        ///
+        /// <returns> The weight at the given offset, as a `valueType` value. </returns>
+        LLVMValue WeightValueAt(LLVMValue pWeights, LLVMValue pOffset, LLVMType valueType);
+
+        /// <summary> Get the value at an offset in an array of weights, converting it to `ValueType` if the
+        /// weights are stored in reduced precision (see `IRModuleEmitter::WeightsArray`). </summary>
+        ///
+        /// <typeparam name="ValueType"> The type to return the weight as. </typeparam>
+        /// <param name="pWeights"> Pointer to the weights. </param>
+        /// <param name="pOffset"> The offset. </param>
+        ///
+        /// <returns> The weight at the given offset. </returns>
+        template <typename ValueType>
+        LLVMValue WeightValueAt(LLVMValue pWeights, LLVMValue pOffset);
+
         /// <summary> Set an element in an array. </summary>
         ///
         /// <param name="pPointer"> Pointer to the array. </param>
@@ -1069,6 +1090,29 @@ namespace emitters
         /// <param name="body"> A function that emits the body of the loop. </param>
         void For(LLVMValue beginValue, LLVMValue endValue, LLVMValue increment, ForLoopBodyFunction body);
 
+        /// <summary>
+        /// Emits a for loop counting from a begin value up to (but not including) an end value, tagged so that the
+        /// optimizer turns it into vector instructions of the given width plus a scalar loop for the remainder.
+        /// </summary>
+        ///
+        /// <param name="beginValue"> The starting value of the loop iterator. </param>
+        /// <param name="endValue"> The ending value of the loop iterator. </param>
+        /// <param name="vectorWidth"> The number of iterations to process per vector instruction. </param>
+        /// <param name="body"> A function that emits the body of the loop. </param>
+        void VectorizedFor(LLVMValue beginValue, LLVMValue endValue, int vectorWidth, ForLoopBodyFunction body);
+
+        /// <summary>
+        /// Emits a for loop like `VectorizedFor`, and also promises the optimizer that no iteration reads or writes
+        /// memory that another iteration writes, so it vectorizes the loop even when it can't prove the buffers don't overlap.
+        /// </summary>
+        ///
+        /// <param name="beginValue"> The starting value of the loop iterator. </param>
+        /// <param name="endValue"> The ending value of the loop iterator. </param>
+        /// <param name="vectorWidth"> The number of iterations to process per vector instruction. </param>
+        /// <param name="independentIterations"> If true, the body's memory accesses are tagged as independent across iterations. </param>
+        /// <param name="body"> A function that emits the body of the loop. </param>
+        void VectorizedFor(LLVMValue beginValue, LLVMValue endValue, int vectorWidth, bool independentIterations, ForLoopBodyFunction body);
+
         //
         // Extended for loops
         //
@@ -1409,6 +1453,25 @@ namespace emitters
         template <typename ValueType>
         void MemorySet(LLVMValue pDestinationPointer, LLVMValue pDestinationOffset, LLVMValue value, LLVMValue count);
 
+        /// <summary> Emits a hint to the processor to load the cache line of an address, for reading, ahead of its use. </summary>
+        ///
+        /// <param name="pAddress"> The address, which needn't be valid. </param>
+        void Prefetch(LLVMValue pAddress);
+
+        /// <summary>
+        /// Emits a prefetch of the memory `GetPrefetchDistance()` bytes past an entry of an array that a loop reads in
+        /// order, like the weights of a matrix-vector product. Call it in the body of the loop, so the memory it will read
+        /// later is on its way while it works on the current entry. Emits nothing if the prefetch distance is zero.
+        /// </summary>
+        ///
+        /// <param name="pArray"> Pointer to the array. </param>
+        /// <param name="index"> The index of the entry the loop is reading. </param>
+        void PrefetchAhead(LLVMValue pArray, LLVMValue index);
+
+        /// <summary> Gets how far ahead, in bytes, loops that stream through arrays prefetch them: the compiler options'
+        /// `prefetchDistance`, or the target device's if it isn't set. </summary>
+        int GetPrefetchDistance();
+
         /// <summary> Inserts arbitrary function-level metadata into generated IR code. </summary>
         ///
         /// <param name="tag"> The tag of the metadata to set. </param>
@@ -1476,6 +1539,16 @@ namespace emitters
         /// <param name="pDestination"> Pointer to the address where to write the result. </param>
         void DotProduct(LLVMValue pSize, LLVMValue pLeftValue, LLVMValue pRightValue, LLVMValue pDestination);
 
+        /// <summary> Emit IR to compute the dot product of an array with an array of weights, which may be stored in
+        /// reduced precision (see `IRModuleEmitter::WeightsArray`). </summary>
+        ///
+        /// <param name="size"> Array size. </param>
+        /// <param name="pValues"> Pointer to the address of the first entry in the array. </param>
+        /// <param name="pWeights"> Pointer to the address of the first entry in the weights. </param>
+        ///
+        /// <returns> The dot product, with the type of the entries of `pValues`. </returns>
+        LLVMValue WeightsDotProduct(int size, LLVMValue pValues, LLVMValue pWeights);
+
         /// <summary> Emits a shift register. </summary>
         ///
         /// <typeparam name="ValueType"> Type of entry in the shift register. </typeparam>
@@ -1532,7 +1605,9 @@ namespace emitters
         template <typename ValueType>
         void CallGEMM(int m, int n, int k, LLVMValue A, int lda, LLVMValue B, int ldb, LLVMValue C, int ldc);
 
-        /// <summary> Call the matrix-matrix multiply routine that computes the matrix product C = A*B, but with potentially-transposed matrices </summary>
+        /// <summary> Call the matrix-matrix multiply routine that computes the matrix product C = A*B, but with potentially-transposed matrices.
+        /// A or B may hold reduced-precision weights (see `IRModuleEmitter::WeightsArray`), in which case the blocked GEMM
+        /// is emitted, and widens them as it packs them. </summary>
         ///
         /// <typeparam name="ValueType"> The datatype to use (must be `float` or `double`) </typeparam>
         /// <param name="transposeA"> If `true`, use A' instead of A in the above equation </param>
@@ -1549,6 +1624,31 @@ namespace emitters
         template <typename ValueType>
         void CallGEMM(bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, LLVMValue B, int ldb, LLVMValue C, int ldc);
 
+        /// <summary>
+        /// Call the matrix-matrix multiply routine that computes the matrix product C = A*B, with potentially-transposed
+        /// matrices, where the values of A or B (or both) are known at compile time. If the product is computed by the
+        /// blocked GEMM kernel, the known matrices are packed into the kernel's panel layout now and stored in the module,
+        /// so that they aren't packed again on every call.
+        /// </summary>
+        ///
+        /// <typeparam name="ValueType"> The datatype to use (must be `float` or `double`) </typeparam>
+        /// <param name="transposeA"> If `true`, use A' instead of A in the above equation </param>
+        /// <param name="transposeB"> If `true`, use B' instead of B in the above equation </param>
+        /// <param name="m"> The number of rows in the matrix A and the output matrix  C </param>
+        /// <param name="n"> The number of columns in the matrix B and the output matrix C </param>
+        /// <param name="k"> The number of rows in the matrix A and columns in matrix B </param>
+        /// <param name="A"> The matrix to multiply on the left </param>
+        /// <param name="lda"> The stride of the matrix A -- the number of elements between rows </param>
+        /// <param name="constantA"> The values of A, or `nullptr` if they're only known at run time </param>
+        /// <param name="B"> The matrix to multiply on the right </param>
+        /// <param name="ldb"> The stride of the matrix B -- the number of elements between rows </param>
+        /// <param name="constantB"> The values of B, or `nullptr` if they're only known at run time </param>
+        /// <param name="C"> The result matrix </param>
+        /// <param name="ldc"> The stride of the matrix C -- the number of elements between rows </param>
+        /// <param name="packedName"> The prefix of the names of the globals holding the packed matrices </param>
+        template <typename ValueType>
+        void CallGEMM(bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, const std::vector<ValueType>* constantA, LLVMValue B, int ldb, const std::vector<ValueType>* constantB, LLVMValue C, int ldc, const std::string& packedName);
+
         /// <summary> Utility function for getting number of threads used by OpenBLAS (if present) </summary>
         LLVMValue GetNumOpenBLASThreads();
 
@@ -1585,6 +1685,9 @@ namespace emitters
         /// <summary> Emits a call to the POSIX `pthread_self` function. </summary>
         LLVMValue PthreadSelf();
 
+        /// <summary> Emits a call to the `pthread_setaffinity_np` function (Linux only). `cpuSetPtr` points to a full `cpu_set_t` bitmask. </summary>
+        LLVMValue PthreadSetAffinity(LLVMValue thread, LLVMValue cpuSetPtr);
+
         /// <summary> Emits a call to the POSIX `pthread_mutex_init` function. </summary>
         LLVMValue PthreadMutexInit(LLVMValue mutexPtr, LLVMValue attrPtr);
 
@@ -1731,6 +1834,7 @@ namespace emitters
         void CompleteFunction();
 
         bool CanUseBlas() const;
+        void SetNumBlasThreadsForCall(size_t numOperations);
         void EnsurePrintf();
 
         LLVMFunction ResolveFunction(const std::string& name);
@@ -1820,6 +1924,12 @@ namespace emitters
         return GetEmitter().Literal(value);
     }
 
+    template <typename ValueType>
+    LLVMValue IRFunctionEmitter::WeightValueAt(LLVMValue pWeights, LLVMValue pOffset)
+    {
+        return WeightValueAt(pWeights, pOffset, GetEmitter().Type(GetVariableType<ValueType>()));
+    }
+
     template <typename ValueType>
     LLVMValue IRFunctionEmitter::Pointer(ValueType* value)
     {
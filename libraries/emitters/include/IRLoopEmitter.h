@@ -83,12 +83,24 @@ namespace emitters
         /// <summary> Emits the end of this for loop. </summary>
         void End();
 
+        /// <summary>
+        /// Tags the loop so LLVM's loop vectorizer emits it with vector instructions (and a scalar remainder loop for
+        /// the leftover iterations). Must be called after `Begin`.
+        /// </summary>
+        ///
+        /// <param name="vectorWidth"> The number of elements to process per vector iteration. </param>
+        /// <param name="independentIterations"> If true, also tells LLVM that no iteration reads or writes memory another
+        /// iteration writes, so the vectorizer doesn't give up on the loop when it can't prove the buffers don't overlap.
+        /// Every load and store in the loop body is tagged when `End` is called. </param>
+        void SetVectorizationHint(int vectorWidth, bool independentIterations = false);
+
     private:
         void CreateBlocks();
         void EmitIterationVariable(LLVMValue pStartValue);
         void EmitCondition(TypedComparison type, LLVMValue pTestValue);
         void EmitIncrement(LLVMValue pIncrementValue);
         llvm::BasicBlock* PrepareBody();
+        void MarkParallelMemoryAccesses();
 
         IRFunctionEmitter& _functionEmitter; // Loop written into this function
         llvm::BasicBlock* _pInitializationBlock = nullptr; // The for loop is set up in this block - such as initializing iteration variables
@@ -97,6 +109,7 @@ namespace emitters
         llvm::BasicBlock* _pIncrementBlock = nullptr; // Here we increment the iteration variable
         llvm::BasicBlock* _pAfterBlock = nullptr; // When the loop is done, we branch to this block
         LLVMValue _pIterationVariable = nullptr;
+        llvm::MDNode* _pParallelLoopID = nullptr; // Set if the body's memory accesses are to be tagged as independent across iterations
     };
 
     /// <summary> Class that simplifies while loop creation. Used internally by IRFunctionEmitter. </summary>
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "CompilerOptions.h"
 #include "IREmitter.h"
 #include "IRFunctionEmitter.h"
 #include "IRLocalValue.h"
@@ -20,16 +21,26 @@ namespace ell
 namespace emitters
 {
     // Common math functions
+    // Exp, Log, Tanh and Sigmoid emit the inline approximations below when the function's `useFastMath` option is on,
+    // at the accuracy of its `fastMathAccuracy` option, and call the standard library otherwise.
     IRLocalScalar Abs(IRLocalScalar a);
     IRLocalScalar Sqrt(IRLocalScalar a);
     IRLocalScalar Exp(IRLocalScalar a);
     IRLocalScalar Log(IRLocalScalar a);
     IRLocalScalar Sin(IRLocalScalar a);
     IRLocalScalar Cos(IRLocalScalar a);
+    IRLocalScalar Sigmoid(IRLocalScalar a);
 
     template <typename ValueType>
     IRLocalScalar Tanh(IRLocalScalar a);
 
+    // Inline approximations of math functions, made of arithmetic, compares and selects, so that loops that use them can
+    // be vectorized. They work on float and double values, and on vectors of them. Denormal inputs to FastLog are treated as 0.
+    IRLocalScalar FastExp(IRLocalScalar a, FastMathAccuracy accuracy);
+    IRLocalScalar FastLog(IRLocalScalar a, FastMathAccuracy accuracy);
+    IRLocalScalar FastTanh(IRLocalScalar a, FastMathAccuracy accuracy);
+    IRLocalScalar FastSigmoid(IRLocalScalar a, FastMathAccuracy accuracy);
+
     IRLocalScalar Min(IRLocalScalar a, IRLocalScalar b);
     template <typename ValueType, utilities::IsFundamental<ValueType> = true>
     IRLocalScalar Min(ValueType a, IRLocalScalar b);
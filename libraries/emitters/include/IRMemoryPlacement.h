@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRMemoryPlacement.h (emitters)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+
+namespace ell
+{
+namespace emitters
+{
+    class IRModuleEmitter;
+    struct TargetDevice;
+
+    /// <summary> The size, in bytes, of the huge pages large global buffers are aligned to. </summary>
+    constexpr size_t c_hugePageSize = size_t(2) << 20;
+
+    /// <summary> Indicates whether a target can back global buffers with transparent huge pages. </summary>
+    ///
+    /// <param name="targetDevice"> The target device. </param>
+    ///
+    /// <returns> True if the target runs Linux. </returns>
+    bool SupportsHugePages(const TargetDevice& targetDevice);
+
+    /// <summary>
+    /// Emits a module initialization function that places the large global buffers of a module in memory, as the
+    /// module's compiler options ask:
+    ///
+    /// * With `useHugePages`, the buffers of at least `c_hugePageSize` bytes are aligned to huge pages, and the kernel is
+    ///   advised to back them with transparent huge pages (only where `SupportsHugePages`). Pages the loader already
+    ///   wrote, like the ones of initialized data, are collapsed into huge pages later by the kernel, if at all.
+    /// * With `firstTouchBuffers` and `parallelize`, the zero-initialized mutable buffers of at least 64 pages are written
+    ///   by a static parallel loop, so each thread pool worker is the first to touch the block of each buffer that the
+    ///   parallel loops over it give that worker, and the kernel allocates those pages on the worker's NUMA node.
+    ///
+    /// Buffers are found after the predict functions are emitted, so call this once they are. It does nothing if no
+    /// buffer is large enough.
+    /// </summary>
+    ///
+    /// <param name="module"> The module. </param>
+    void EmitLargeBufferPlacement(IRModuleEmitter& module);
+} // namespace emitters
+} // namespace ell
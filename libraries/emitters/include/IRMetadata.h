@@ -38,6 +38,15 @@ namespace emitters
     /// </remarks>
     static const std::string c_declareTypeInHeaderTagName = "ell.header.declareType";
 
+    /// <summary> Indicates a function that computes a node, which can be compiled for several instruction set levels. </summary>
+    static const std::string c_nodeFunctionTagName = "ell.fn.node";
+
+    /// <summary> Indicates a function that the JIT compiles the first time it's called, rather than along with the rest of the module. </summary>
+    static const std::string c_lazyFunctionTagName = "ell.fn.lazy";
+
+    /// <summary> Indicates a mutable global that all callers of a reentrant model share, rather than part of each caller's state. </summary>
+    static const std::string c_sharedGlobalTagName = "ell.global.shared";
+
     /// <summary> Indicates the Predict function that should be wrapped by SWIG. </summary>
     static const std::string c_predictFunctionTagName = "ell.fn.predict";
 
@@ -34,9 +34,11 @@
 
 #include <initializer_list>
 #include <iosfwd>
+#include <map>
 #include <memory>
 #include <stack>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -202,6 +204,44 @@ namespace emitters
         /// <summary> Ensure that the given variable is loaded into a register. </summary>
         LLVMValue LoadVariable(Variable& var);
 
+        /// <summary>
+        /// Emit a global vector variable as a view of part of a larger global buffer, rather than as an array of its own.
+        /// The pointer to the variable's data is computed in the entry block of the current function.
+        /// </summary>
+        ///
+        /// <param name="var"> The variable to emit. It must be a global vector variable that hasn't been emitted yet. </param>
+        /// <param name="buffer"> The global buffer that holds the variable's data. </param>
+        /// <param name="byteOffset"> The offset, in bytes, of the variable's data within the buffer. </param>
+        ///
+        /// <returns> A pointer to the first element of the variable, like the pointer passed for a function argument. </returns>
+        LLVMValue EmitGlobalVectorInBuffer(Variable& var, llvm::GlobalVariable* buffer, size_t byteOffset);
+
+        /// <summary>
+        /// Emit a global vector variable as a view of another vector's data, starting at an element offset, rather than as an
+        /// array of its own. The pointer to the variable's data is computed in the entry block of the current function, so
+        /// `pData` must be available there (a global, an argument, or a value computed in the entry block).
+        /// </summary>
+        ///
+        /// <param name="var"> The variable to emit. It must be a global vector variable that hasn't been emitted yet. </param>
+        /// <param name="pData"> A pointer to the vector that holds the variable's data. </param>
+        /// <param name="elementOffset"> The offset, in elements, of the variable's data within the vector. </param>
+        ///
+        /// <returns> A pointer to the first element of the variable. </returns>
+        LLVMValue EmitGlobalVectorAsView(Variable& var, LLVMValue pData, int elementOffset);
+
+        /// <summary>
+        /// Emit a global vector variable as a view of part of a buffer that a global pointer points to, rather than as an
+        /// array of its own. The pointer is loaded in the entry block of the current function, so the variable can only be
+        /// used in that function.
+        /// </summary>
+        ///
+        /// <param name="var"> The variable to emit. It must be a global vector variable that hasn't been emitted yet. </param>
+        /// <param name="pointer"> The global pointer to the buffer that holds the variable's data. </param>
+        /// <param name="byteOffset"> The offset, in bytes, of the variable's data within the buffer. </param>
+        ///
+        /// <returns> A pointer to the first element of the variable. </returns>
+        LLVMValue EmitGlobalVectorAtPointer(Variable& var, llvm::GlobalVariable* pointer, size_t byteOffset);
+
         //
         // Variable and Constant creation
         //
@@ -234,6 +274,20 @@ namespace emitters
         template <typename ValueType>
         llvm::GlobalVariable* ConstantArray(const std::string& name, const std::vector<ValueType>& value);
 
+        /// <summary> Emit a named, module scoped array constant holding weights in the given storage format.
+        /// Read the entries with `IRFunctionEmitter::WeightValueAt`, which converts them back to full precision. The
+        /// conversion to reduced precision stores NaNs as 0 and saturates float16 weights, as described for
+        /// `CompilerOptions::weightStorageType`, and logs how many weights it changed that way. </summary>
+        ///
+        /// <typeparam name="ValueType"> Type of the weights. </typeparam>
+        /// <param name="name"> The array constant name. </param>
+        /// <param name="values"> The weights. </param>
+        /// <param name="storageType"> The format to store the weights in. Only floating-point weights are stored in reduced precision. </param>
+        ///
+        /// <returns> Pointer to the llvm::GlobalVariable that represents the constant. </returns>
+        template <typename ValueType>
+        llvm::GlobalVariable* WeightsArray(const std::string& name, const std::vector<ValueType>& values, WeightStorageType storageType);
+
         /// <summary> Emit a named global variable of the given type. </summary>
         ///
         /// <param name="type"> The variable type. </param>
@@ -514,6 +568,11 @@ namespace emitters
         /// <param name="options"> Options to control how machine code is generated during output. </params>
         void WriteToStream(std::ostream& stream, ModuleOutputFormat format, const MachineCodeOutputOptions& options);
 
+        /// <summary> Gets the size of the machine code of each function in the object code `WriteToFile` would write. The module itself is unchanged. </summary>
+        ///
+        /// <returns> The size in bytes of each function, by name. </returns>
+        std::map<std::string, size_t> GetFunctionCodeSizes();
+
         /// <summary> Load LLVM IR text into this module. </summary>
         ///
         /// <param name="text"> The IR text. </param>
@@ -724,12 +783,14 @@ namespace emitters
         // Actual code output implementations
         void WriteHeader(std::ostream& stream);
         void WriteToLLVMStream(llvm::raw_ostream& stream, ModuleOutputFormat format, MachineCodeOutputOptions options);
+        MachineCodeOutputOptions GetFileOutputOptions();
 
         //
         // Lower-level internal functions
         //
         void SetCompilerOptions(const CompilerOptions& parameters) override;
         llvm::GlobalVariable* AddGlobal(const std::string& name, LLVMType pType, llvm::Constant* pInitial, bool isConst);
+        llvm::GlobalVariable* ReducedPrecisionArray(const std::string& name, const std::vector<float>& values, WeightStorageType storageType);
         IRFunctionEmitter Function(const std::string& name, VariableType returnType, const VariableTypeList* pArguments, bool isPublic);
         llvm::Function::LinkageTypes Linkage(bool isPublic);
         llvm::ConstantAggregateZero* ZeroInitializer(LLVMType pType);
@@ -799,6 +860,19 @@ namespace emitters
         return AddGlobal(name, _emitter.ArrayType(GetVariableType<ValueType>(), value.size()), _emitter.Literal(value), true);
     }
 
+    template <typename ValueType>
+    llvm::GlobalVariable* IRModuleEmitter::WeightsArray(const std::string& name, const std::vector<ValueType>& values, WeightStorageType storageType)
+    {
+        if constexpr (std::is_floating_point_v<ValueType>)
+        {
+            if (storageType != WeightStorageType::float32)
+            {
+                return ReducedPrecisionArray(name, { values.begin(), values.end() }, storageType);
+            }
+        }
+        return ConstantArray(name, values);
+    }
+
     template <typename ValueType>
     llvm::GlobalVariable* IRModuleEmitter::GlobalArray(const std::string& name, size_t size)
     {
@@ -7,9 +7,13 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 
+#include "CompilerOptions.h"
 #include "LLVMUtilities.h"
 
 #include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <chrono>
 
 namespace ell
 {
@@ -21,17 +25,27 @@ namespace emitters
     class IROptimizer
     {
     public:
-        /// <summary> Function optimizer for functions in this module. </summary>
+        /// <summary> Function optimizer for functions in this module, with the module's compiler options. </summary>
         ///
         /// <param name="module"> The module. </param>
         IROptimizer(IRModuleEmitter& module);
 
+        /// <summary> Function optimizer for functions in an LLVM module that isn't owned by an `IRModuleEmitter`. </summary>
+        ///
+        /// <param name="module"> The module. </param>
+        /// <param name="targetMachine"> The target machine to tune the passes for, or null. </param>
+        /// <param name="options"> The options that choose the optimization level, size optimization, inlining and time budget. </param>
+        IROptimizer(llvm::Module& module, llvm::TargetMachine* targetMachine, const CompilerOptions& options = {});
+
         ~IROptimizer();
 
         /// <summary> Add common optimizations to the optimizer pipeline. </summary>
         void AddStandardPasses();
 
-        /// <summary> Optimize the given function. </summary>
+        /// <summary>
+        /// Optimize the given function. A function without optimization attributes of its own (see
+        /// `SetOptimizationAttributes`) gets the module's first.
+        /// </summary>
         ///
         /// <param name="pFunction"> pointer to the function to optimize. </param>
         void OptimizeFunction(LLVMFunction pFunction);
@@ -39,10 +53,37 @@ namespace emitters
         /// <summary> Optimize the module. </summary>
         void OptimizeModule(llvm::Module* pModule);
 
+        /// <summary> Gets the number of functions left unoptimized because the optimizer ran out of time. </summary>
+        size_t GetNumUnoptimizedFunctions() const { return _numUnoptimizedFunctions; }
+
     private:
-        IRModuleEmitter& _module;
+        llvm::TargetMachine* _targetMachine;
+        CompilerOptions _options;
+        std::chrono::steady_clock::time_point _deadline;
+        size_t _numUnoptimizedFunctions = 0;
         llvm::legacy::PassManager _modulePasses;
         llvm::legacy::FunctionPassManager _functionPasses;
     };
+
+    /// <summary>
+    /// Sets the attributes that make the LLVM optimizer treat a function the way the options ask: `optnone` for
+    /// optimization level 0, `optsize` and `minsize` for size optimization, and `noinline` if it can't be inlined.
+    /// The pass pipeline is the module's, so this is how one function is compiled differently from the rest.
+    /// </summary>
+    ///
+    /// <param name="function"> The function. </param>
+    /// <param name="options"> The options for the function. </param>
+    void SetOptimizationAttributes(llvm::Function& function, const CompilerOptions& options);
+
+    /// <summary>
+    /// Optimizes a module with the standard passes on several threads. The functions with bodies are divided into
+    /// partitions of similar size, and each partition is copied into its own LLVM context and optimized on its own
+    /// thread. The optimized functions are then linked back into the module. Calls between functions in different
+    /// partitions aren't inlined. Modules with debug information are optimized on the calling thread.
+    /// </summary>
+    ///
+    /// <param name="module"> The module to optimize. </param>
+    /// <param name="numThreads"> The maximum number of partitions to optimize concurrently. </param>
+    void OptimizeModuleInParallel(IRModuleEmitter& module, int numThreads);
 } // namespace emitters
 } // namespace ell
@@ -8,9 +8,12 @@
 
 #pragma once
 
+#include "CompilerOptions.h"
 #include "IRLocalScalar.h"
 #include "LLVMUtilities.h"
 
+#include <utilities/include/Optional.h>
+
 #include <functional>
 #include <vector>
 
@@ -27,11 +30,20 @@ namespace emitters
             numTasks(0) {}
         ParallelLoopOptions(int numTasks) :
             numTasks(numTasks) {}
+        ParallelLoopOptions(int numTasks, ParallelLoopSchedule schedule, int chunkSize = 0) :
+            numTasks(numTasks),
+            schedule(schedule),
+            chunkSize(chunkSize) {}
 
         int numTasks = 0; // The number of tasks to break the loop into. '0' is the special 'auto' flag
+        utilities::Optional<ParallelLoopSchedule> schedule; // How the iterations are divided between the tasks. If empty, the compiler options' `parallelLoopSchedule`
+        int chunkSize = 0; // The (smallest) number of iterations a task takes at a time, with a dynamic or guided schedule. '0' means the compiler options' `parallelLoopChunkSize`
     };
 
-    /// <summary> Class that simplifies parallel for loop creation. </summary>
+    /// <summary>
+    /// Class that simplifies parallel for loop creation. A parallel loop emitted into the body of another one, which
+    /// already runs on all the threads, is emitted as a serial loop.
+    /// </summary>
     class IRParallelForLoopEmitter
     {
     public:
@@ -53,7 +65,12 @@ namespace emitters
         void EmitLoop(int begin, int end, int increment, const ParallelLoopOptions& options, const std::vector<LLVMValue>& capturedValues, BodyFunction body);
         void EmitLoop(IRLocalScalar begin, IRLocalScalar end, IRLocalScalar increment, const ParallelLoopOptions& options, const std::vector<LLVMValue>& capturedValues, BodyFunction body);
 
+        void EmitStaticLoop(IRLocalScalar begin, IRLocalScalar end, IRLocalScalar increment, int numTasks, const std::vector<LLVMValue>& capturedValues, BodyFunction body);
+        void EmitScheduledLoop(IRLocalScalar begin, IRLocalScalar end, IRLocalScalar increment, int numTasks, ParallelLoopSchedule schedule, int chunkSize, const std::vector<LLVMValue>& capturedValues, BodyFunction body);
+        bool IsInParallelLoopBody() const;
+
         IRFunctionEmitter GetTaskFunction(const std::vector<LLVMValue>& capturedValues, BodyFunction body);
+        IRFunctionEmitter GetScheduledTaskFunction(ParallelLoopSchedule schedule, int numTasks, const std::vector<LLVMValue>& capturedValues, BodyFunction body);
 
         LLVMValue GetIterationVariable();
         LLVMValue LoadIterationVariable();
@@ -37,6 +37,54 @@ namespace emitters
         /// <summary> Gets the LLVM type for a pointer to the `timespec` structure on the current target. </summary>
         LLVMType GetTimespecPointerType();
 
+        //
+        // system calls and file I/O
+        //
+
+        /// <summary> Gets an LLVMFunction representing the (variadic) syscall function. </summary>
+        /// long syscall(long number, ...);
+        LLVMFunction GetSyscallFunction();
+
+        /// <summary> Gets an LLVMFunction representing the read function. </summary>
+        /// ssize_t read(int fd, void* buf, size_t count);
+        LLVMFunction GetReadFunction();
+
+        /// <summary> Gets an LLVMFunction representing the fopen function. The `FILE*` type is treated as an opaque `void*`. </summary>
+        /// FILE* fopen(const char* filename, const char* mode);
+        LLVMFunction GetFopenFunction();
+
+        /// <summary> Gets an LLVMFunction representing the (variadic) fprintf function. </summary>
+        /// int fprintf(FILE* stream, const char* format, ...);
+        LLVMFunction GetFprintfFunction();
+
+        /// <summary> Gets an LLVMFunction representing the fclose function. </summary>
+        /// int fclose(FILE* stream);
+        LLVMFunction GetFcloseFunction();
+
+        /// <summary> Gets an LLVMFunction representing the (variadic) open function. </summary>
+        /// int open(const char* path, int flags, ...);
+        LLVMFunction GetOpenFunction();
+
+        /// <summary> Gets an LLVMFunction representing the close function. </summary>
+        /// int close(int fd);
+        LLVMFunction GetCloseFunction();
+
+        /// <summary> Gets an LLVMFunction representing the lseek function. </summary>
+        /// off_t lseek(int fd, off_t offset, int whence);
+        LLVMFunction GetLseekFunction();
+
+        /// <summary> Gets an LLVMFunction representing the mmap function. </summary>
+        /// void* mmap(void* address, size_t length, int protection, int flags, int fd, off_t offset);
+        LLVMFunction GetMmapFunction();
+
+        /// <summary> Gets an LLVMFunction representing the munmap function. </summary>
+        /// int munmap(void* address, size_t length);
+        LLVMFunction GetMunmapFunction();
+
+        /// <summary> Gets an LLVMFunction representing the madvise function. </summary>
+        /// int madvise(void* address, size_t length, int advice);
+        LLVMFunction GetMadviseFunction();
+
         //
         // pthreads
         //
@@ -76,6 +124,10 @@ namespace emitters
         /// pthread_t pthread_self(void);
         LLVMFunction GetPthreadSelfFunction();
 
+        /// <summary> Gets an LLVMFunction representing the pthread_setaffinity_np function (Linux only). </summary>
+        /// int pthread_setaffinity_np(pthread_t thread, size_t cpusetsize, const cpu_set_t* cpuset);
+        LLVMFunction GetPthreadSetAffinityFunction();
+
         // pthreads -- synchronization functions
 
         /// <summary> Gets an LLVMFunction representing the pthread_mutex_init function. </summary>
@@ -158,6 +210,12 @@ namespace emitters
         /// <summary> Gets the LLVM type for a pthread thread function ( `void* threadFn(void*)` )on the current target. </summary>
         llvm::FunctionType* GetPthreadStartRoutineType();
 
+        /// <summary> Gets the LLVM type for one word of the `cpu_set_t` bitmask on the current target. </summary>
+        LLVMType GetCpuSetWordType();
+
+        /// <summary> Gets the number of words in the `cpu_set_t` bitmask on the current target. </summary>
+        int GetCpuSetNumWords();
+
         // GetPthreadAttrType
         // GetPthreadOnceType
 
@@ -18,12 +18,20 @@
 // External API for profiling functions
 extern "C" {
 
-/// <summary> A struct that holds information about a profile region. </summary>
+/// <summary>
+/// A struct that holds information about a profile region. The hardware counter totals are only collected
+/// when the model is compiled with the `profileHardwareCounters` option, and are zero otherwise.
+/// </summary>
 struct ProfileRegionInfo
 {
     int64_t count;
     double totalTime;
     const char* name;
+    int64_t cycles;
+    int64_t instructions;
+    int64_t l1DataCacheMisses;
+    int64_t lastLevelCacheMisses;
+    int64_t branchMisses;
 };
 }
 
@@ -48,10 +56,10 @@ namespace emitters
         /// <summary> Constructor. </summary>
         IRProfileRegion(IRFunctionEmitter& function, const std::string& name);
 
-        /// <summary> Enter the profiling region: increment the visit count and begin timing. </summary>
+        /// <summary> Enter the profiling region: increment the visit count and begin timing (and counting hardware events, if enabled). </summary>
         void Enter();
 
-        /// <summary> Exit the profiling region: accumulate the time spent since calling `Enter()`. </summary>
+        /// <summary> Exit the profiling region: accumulate the time spent (and hardware events counted) since calling `Enter()`. </summary>
         void Exit();
 
         /// <summary> Check internal time is valid. For testing. </summary>
@@ -63,13 +71,19 @@ namespace emitters
 
         IRFunctionEmitter& GetFunction() { return _function; }
         IRLocalScalar GetIndex() const { return _index; }
+        const std::string& GetName() const { return _name; }
+        void SetName(const std::string& name) { _name = name; }
         IRLocalScalar GetStartTime() const { return _startTime; }
         void SetStartTime(const IRLocalScalar& time) { _startTime = time; }
+        LLVMValue GetStartCounters() const { return _startCounters; }
+        void SetStartCounters(LLVMValue counters) { _startCounters = counters; }
 
         IRFunctionEmitter& _function;
         IRProfiler& _profiler;
         IRLocalScalar _index;
         IRLocalScalar _startTime;
+        LLVMValue _startCounters = nullptr;
+        std::string _name;
     };
 
     /// <summary>
@@ -126,12 +140,46 @@ namespace emitters
         /// <returns> The name of the emitted "ResetRegionProfilingInfo" function. </returns>
         std::string GetResetRegionProfilingInfoFunctionName() const;
 
+        /// <summary> Indicates if the profiler records a timeline of trace events (the `traceExecution` compiler option). </summary>
+        ///
+        /// <returns> true if tracing is enabled, false if disabled. </returns>
+        bool IsTracingEnabled() const { return _tracingEnabled; }
+
+        /// <summary> Emit code to start timing a trace event. </summary>
+        ///
+        /// <param name="function"> The function being emitted. </param>
+        ///
+        /// <returns> The start time to pass to `EndTraceEvent`. Null if tracing is disabled. </returns>
+        LLVMValue BeginTraceEvent(IRFunctionEmitter& function);
+
+        /// <summary> Emit code to record a trace event that started at `startTime` and ends now, in the calling thread's trace buffer. </summary>
+        ///
+        /// <param name="function"> The function being emitted. </param>
+        /// <param name="name"> The name to show for the event. </param>
+        /// <param name="startTime"> The value returned by `BeginTraceEvent`. </param>
+        void EndTraceEvent(IRFunctionEmitter& function, const std::string& name, LLVMValue startTime);
+
+        /// <summary>
+        /// Get the name of the emitted "WriteProfileTrace" function, `int WriteProfileTrace(const char* filename)`. It writes
+        /// the recorded events in the Chrome trace event format (viewable with chrome://tracing or Perfetto), and returns 0
+        /// on success or -1 if the file couldn't be opened.
+        /// </summary>
+        ///
+        /// <returns> The name of the emitted "WriteProfileTrace" function. </returns>
+        std::string GetWriteProfileTraceFunctionName() const;
+
+        /// <summary> Get the name of the emitted "ResetProfileTrace" function, which discards the recorded events. </summary>
+        ///
+        /// <returns> The name of the emitted "ResetProfileTrace" function. </returns>
+        std::string GetResetProfileTraceFunctionName() const;
+
     private:
         friend IRProfileRegion;
 
         std::string GetNamespacePrefix() const;
         llvm::StructType* GetRegionType() const;
         IRLocalScalar GetCurrentTime(IRFunctionEmitter& function);
+        bool IsHardwareCountingEnabled() const;
 
         // Actual implementations of the functions in IRProfileRegion
         void InitRegion(IRProfileRegion& region, const std::string& desiredName);
@@ -146,6 +194,14 @@ namespace emitters
         void EmitGetNumRegionsFunction();
         void EmitGetRegionProfilingInfoFunction();
         void EmitResetRegionProfilingInfoFunction();
+        void EmitSharedRuntimeRegistration();
+
+        // Trace support
+        void CreateTraceData();
+        LLVMValue EmitGetTraceSlot(IRFunctionEmitter& function);
+        void EmitRecordTraceEventFunction();
+        void EmitWriteProfileTraceFunction();
+        void EmitResetProfileTraceFunction();
 
         // Lower-level codegen
         // CreateRegion returns the index of the new region
@@ -172,6 +228,15 @@ namespace emitters
         llvm::StructType* _profileRegionType = nullptr;
         llvm::GlobalVariable* _profileRegionsArray = nullptr;
         int _regionCount = 0;
+
+        // Trace buffers: each thread that records events claims a slot, and owns that slot's ring buffer of events
+        bool _tracingEnabled = false;
+        int _numTraceSlots = 0;
+        llvm::StructType* _traceEventType = nullptr;
+        llvm::GlobalVariable* _traceThreadIds = nullptr; // the thread that owns each slot (0 if unclaimed)
+        llvm::GlobalVariable* _traceEventCounts = nullptr; // the number of events each slot has recorded (which may exceed the buffer size)
+        llvm::GlobalVariable* _traceEvents = nullptr; // the ring buffers, one after the other
+        LLVMFunction _recordTraceEventFunction = nullptr;
     };
 } // namespace emitters
 } // namespace ell
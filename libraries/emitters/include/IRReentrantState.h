@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRReentrantState.h (emitters)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace llvm
+{
+class Constant;
+class StructType;
+} // namespace llvm
+
+namespace ell
+{
+namespace emitters
+{
+    class IRModuleEmitter;
+
+    /// <summary> Describes the state struct created by `MoveGlobalStateToArgument`. </summary>
+    struct ReentrantStateInfo
+    {
+        /// <summary> The type of the state struct, or `nullptr` if the functions have no mutable state. </summary>
+        llvm::StructType* type = nullptr;
+
+        /// <summary> The size of the state struct, in bytes. </summary>
+        size_t size = 0;
+
+        /// <summary> The alignment the state struct needs, in bytes. </summary>
+        size_t alignment = 1;
+
+        /// <summary> The initial contents of the state struct (the initializers of the globals it replaces). </summary>
+        llvm::Constant* initialValue = nullptr;
+
+        /// <summary> The names of the globals that were moved into the state struct, in field order. </summary>
+        std::vector<std::string> globalNames;
+    };
+
+    /// <summary>
+    /// Moves the mutable globals used by a set of entry functions into a state struct that the caller passes in, so that
+    /// independent calls with different state can run concurrently. Each entry function must have a pointer argument
+    /// with the given name, which receives the address of the state struct. Functions the entry functions call (directly
+    /// or indirectly) that use the state are rewritten to take the state pointer as a new first argument. Globals tagged
+    /// with `c_sharedGlobalTagName` stay where they are.
+    ///
+    /// Throws an `EmitterException` with `notSupported` if a global that needs to move is used outside of these functions,
+    /// or one of the rewritten functions is called indirectly.
+    /// </summary>
+    ///
+    /// <param name="module"> The module to transform. </param>
+    /// <param name="entryFunctionNames"> The names of the entry functions. </param>
+    /// <param name="stateArgumentName"> The name of the entry functions' state argument. </param>
+    /// <param name="maxAlignment"> The largest alignment any field of the state struct may have. Callers must align the state to this. </param>
+    ///
+    /// <returns> A description of the state struct. </returns>
+    ReentrantStateInfo MoveGlobalStateToArgument(IRModuleEmitter& module, const std::vector<std::string>& entryFunctionNames, const std::string& stateArgumentName, size_t maxAlignment);
+} // namespace emitters
+} // namespace ell
@@ -21,6 +21,19 @@ namespace emitters
     class IRModuleEmitter;
     class IRFunctionEmitter;
 
+    /// <summary> The hardware performance counters that can be sampled by the emitted code, in the order they're stored. </summary>
+    enum class HardwareCounter
+    {
+        cycles = 0,
+        instructions,
+        l1DataCacheMisses,
+        lastLevelCacheMisses,
+        branchMisses
+    };
+
+    /// <summary> The number of entries in `HardwareCounter`. </summary>
+    constexpr int NumHardwareCounters = 5;
+
     /// <summary> Manages external as well as compiler auto-generated functions </summary>
     class IRRuntime
     {
@@ -30,6 +43,18 @@ namespace emitters
         //
         LLVMValue GetCurrentTime(IRFunctionEmitter& function);
 
+        /// <summary>
+        /// Emits a call that reads the hardware performance counters of the current thread into an array of
+        /// `NumHardwareCounters` 64-bit integers, in `HardwareCounter` order. The values only have meaning as
+        /// differences between two reads. On Linux the counters come from `perf_event_open`; on other ARM targets
+        /// they're read directly from the PMU, which requires the OS to have enabled user-mode access to it.
+        /// Counters that aren't available on the target read as zero.
+        /// </summary>
+        ///
+        /// <param name="function"> The function to emit the call into. </param>
+        /// <param name="counters"> Pointer to the array that receives the counter values. </param>
+        void ReadHardwareCounters(IRFunctionEmitter& function, LLVMValue counters);
+
         //
         // Standard math functions
         //
@@ -160,6 +185,51 @@ namespace emitters
         /// <summary> Get the OpenBLAS function for setting the number of threads </summary>
         LLVMFunction GetOpenBLASSetNumThreadsFunction();
 
+        // Functions of the ELL runtime library that models compiled with `useSharedRuntime` call (see runtime/include/SharedRuntime.h)
+
+        /// <summary> Get `void* ell_runtime_StartTasks(void* (*)(void*), void* args, int32_t argsSize, int32_t numTasks, void** returnValues)` </summary>
+        LLVMFunction GetSharedRuntimeStartTasksFunction();
+
+        /// <summary> Get `void ell_runtime_WaitTasks(void* taskGroup)` </summary>
+        LLVMFunction GetSharedRuntimeWaitTasksFunction();
+
+        /// <summary> Get `void ell_runtime_SetBlasThreadsForCall(int64_t numOperations)` </summary>
+        LLVMFunction GetSharedRuntimeSetBlasThreadsForCallFunction();
+
+        /// <summary> Get `void ell_runtime_RegisterProfiler(const char* moduleName, getNumRegions, getRegionProfilingInfo, resetRegionProfilingInfo)`, with the function pointers passed as `i8*` </summary>
+        LLVMFunction GetSharedRuntimeRegisterProfilerFunction();
+
+        /// <summary> Get `void ell_runtime_UnregisterProfiler(const char* moduleName)` </summary>
+        LLVMFunction GetSharedRuntimeUnregisterProfilerFunction();
+
+        /// <summary> Get `ell_runtime_GpuSgemm` or `ell_runtime_GpuDgemm` (see runtime/include/GpuRuntime.h), depending on the value type </summary>
+        template <typename ValueType>
+        LLVMFunction GetGpuGEMMFunction();
+
+        /// <summary> Get `int64_t ell_runtime_GpuBeginModule()` </summary>
+        LLVMFunction GetGpuBeginModuleFunction();
+
+        /// <summary> Get `void ell_runtime_GpuEndModule(int64_t moduleId)` </summary>
+        LLVMFunction GetGpuEndModuleFunction();
+
+        /// <summary> Loads the module's id for the GPU runtime. The first call adds functions that get the id when the module is loaded and free its device memory when it's unloaded. </summary>
+        ///
+        /// <param name="function"> The function emitter to load the id in. </param>
+        ///
+        /// <returns> The id, as an Int64 value. </returns>
+        LLVMValue GetGpuModuleId(IRFunctionEmitter& function);
+
+        // Functions of the CMSIS-DSP library that models compiled with `useCmsis` call
+
+        /// <summary> Get `void arm_dot_prod_q7(const q7_t* a, const q7_t* b, uint32_t size, q31_t* result)`, whose result is the sum of the products </summary>
+        LLVMFunction GetCmsisDotProductQ7Function();
+
+        /// <summary> Get `arm_status arm_rfft_fast_init_f32(arm_rfft_fast_instance_f32* instance, uint16_t fftSize)`, with the instance passed as `i8*` </summary>
+        LLVMFunction GetCmsisRealFFTInitFunction();
+
+        /// <summary> Get `void arm_rfft_fast_f32(const arm_rfft_fast_instance_f32* instance, float* input, float* output, uint8_t inverse)`, with the instance passed as `i8*` </summary>
+        LLVMFunction GetCmsisRealFFTFunction();
+
         /// <summary> Get the string compare function </summary>
         LLVMFunction GetStringCompareFunction();
 
@@ -184,6 +254,9 @@ namespace emitters
         LLVMFunction GetCurrentTimeFunction(); // returns a double containing the current time (in _milliseconds_ from some arbitrary start time)
         LLVMFunction ResolveCurrentTimeFunction(llvm::StructType* timespecType);
 
+        // hardware performance counters
+        LLVMFunction GetReadHardwareCountersFunction(); // void ReadHardwareCounters(int64_t* counters)
+
         // math
         LLVMFunction GetDotProductIntFunction();
         LLVMFunction GetDotProductFloatFunction();
@@ -202,6 +275,7 @@ namespace emitters
         LLVMFunction _dotProductFunctionFloat = nullptr;
         LLVMFunction _dotProductFunction = nullptr;
         LLVMFunction _getCurrentTimeFunction = nullptr;
+        LLVMFunction _readHardwareCountersFunction = nullptr;
         LLVMFunction _stringCompareFunction = nullptr;
     };
 } // namespace emitters
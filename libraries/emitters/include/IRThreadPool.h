@@ -13,6 +13,7 @@
 
 #include <llvm/IR/GlobalVariable.h>
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -29,6 +30,20 @@ namespace emitters
     //
     // IRThreadPool: Simple thread pool class that schedules tasks in blocks, and associated classes:
     //
+    // By default, all workers pull tasks from a single queue guarded by one mutex. If the `useWorkStealing` compiler
+    // option is set, each worker instead owns a deque holding a contiguous range of task indices: it pops tasks from
+    // the front of its own deque, and when that runs dry it steals from the back of the other workers' deques. The
+    // shared queue mutex is then only taken when a worker runs out of work.
+    //
+    // An idle worker first polls the queue `threadPoolSpinCount` times, and only then blocks on the queue's condition
+    // variable, so that tasks started soon after it ran out of work don't have to wait for it to be woken up. A thread
+    // waiting for its tasks to finish polls the same way. If the `hotThreadPool` compiler option is set, the workers
+    // keep polling, without blocking, for as long as a predict call is running.
+    //
+    // If the `useSharedRuntime` compiler option is set, the module has no threads or queue of its own: the task
+    // array is handed to `ell_runtime_StartTasks`, which runs it on the thread pool of the ELL runtime library
+    // that all the models in the process share.
+    //
     // IRThreadPoolTask
     // IRThreadPoolTaskArray
     // IRThreadPoolTaskQueue
@@ -140,6 +155,15 @@ namespace emitters
         /// <returns> A task array object representing the running tasks. </param>
         IRThreadPoolTaskArray& StartTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments);
 
+        /// <summary> Starts an array of tasks on the shared runtime's thread pool (shared runtime mode only). </summary>
+        ///
+        /// <param name="function"> The function currently being emitted into. </param>
+        /// <param name="taskFunction"> The function to run asynchronously with many different arguments. </param>
+        /// <param name="arguments"> For each task, a vector of arguments for that task. </param>
+        ///
+        /// <returns> A task array object representing the running tasks. </param>
+        IRThreadPoolTaskArray& StartSharedRuntimeTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments);
+
         /// <summary> Pop a task off the task queue, waiting for one to become available if necessary. </summary>
         ///
         /// <param name="function"> The function currently being emitted into. </param>
@@ -157,10 +181,27 @@ namespace emitters
         /// <returns> A task array object representing the tasks. </param>
         IRThreadPoolTaskArray& GetTaskArray() { return _tasks; }
 
+        /// <summary> Pop a task off a worker's own deque, or steal one from another worker's deque if it is empty (work-stealing mode only). </summary>
+        ///
+        /// <param name="function"> The function currently being emitted into. </param>
+        /// <param name="workerIndex"> The index of the worker asking for a task. </param>
+        ///
+        /// <returns> The index of the task to run, or -1 if no tasks were available. </param>
+        LLVMValue PopOrStealTaskIndex(IRFunctionEmitter& function, LLVMValue workerIndex);
+
+        /// <summary> Report tasks finished by a worker and wait for new tasks to be scheduled (work-stealing mode only). </summary>
+        ///
+        /// <param name="function"> The function currently being emitted into. </param>
+        /// <param name="numFinishedTasksVar"> Pointer to the worker's count of tasks finished since it last reported. Reset to zero. </param>
+        /// <param name="lastGenerationVar"> Pointer to the generation of tasks the worker last saw. Updated to the current generation. </param>
+        void WaitForNewTasks(IRFunctionEmitter& function, LLVMValue numFinishedTasksVar, LLVMValue lastGenerationVar);
+
     private:
         friend class IRThreadPool;
         IRThreadPoolTaskQueue(); // create an empty queue
-        void Initialize(IRFunctionEmitter& function); // initializes the task array
+        void Initialize(IRFunctionEmitter& function, int numWorkers, bool useWorkStealing); // initializes the task array
+        void InitializeSharedRuntime(IRFunctionEmitter& function); // initializes the task array, without a queue of our own
+        bool UsesSharedRuntime() const { return _sharedTaskGroup != nullptr; }
         LLVMValue GetDataStruct() { return _queueData; }
         LLVMValue DecrementCountField(IRFunctionEmitter& function, LLVMValue fieldPtr);
         llvm::StructType* GetTaskQueueDataType(IRModuleEmitter& module) const;
@@ -184,6 +225,18 @@ namespace emitters
         void LockQueueMutex(IRFunctionEmitter& function);
         void UnlockQueueMutex(IRFunctionEmitter& function);
         void ShutDown(IRFunctionEmitter& function);
+        LLVMValue GetGenerationPointer(IRFunctionEmitter& function);
+        LLVMValue LoadVolatileField(IRFunctionEmitter& function, int field) const;
+        void SpinWhile(IRFunctionEmitter& function, std::function<LLVMValue(IRFunctionEmitter&)> isWaiting);
+
+        // Work-stealing support
+        bool IsWorkStealing() const { return _workerQueues != nullptr; }
+        llvm::StructType* GetWorkerQueueDataType(IRModuleEmitter& module) const;
+        LLVMValue GetWorkerQueuePointer(IRFunctionEmitter& function, LLVMValue workerIndex);
+        LLVMValue GetWorkerIndex(IRFunctionEmitter& function, LLVMValue workerQueuePtr);
+        void DistributeTasks(IRFunctionEmitter& function, int numTasks);
+        LLVMValue PopFrontTaskIndex(IRFunctionEmitter& function, LLVMValue workerQueuePtr);
+        LLVMValue PopBackTaskIndex(IRFunctionEmitter& function, LLVMValue workerQueuePtr);
 
         enum class Fields
         {
@@ -192,9 +245,23 @@ namespace emitters
             workFinishedCondVar,
             unscheduledCount,
             unfinishedCount,
-            shutdownFlag
+            shutdownFlag,
+            generation
+        };
+
+        enum class WorkerQueueFields
+        {
+            mutex = 0,
+            head,
+            tail,
+            workerIndex
         };
         LLVMValue _queueData = nullptr; // a struct with the above fields
+        llvm::GlobalVariable* _workerQueues = nullptr; // global array of per-worker structs with the `WorkerQueueFields` fields (work-stealing mode only)
+        llvm::GlobalVariable* _sharedTaskGroup = nullptr; // handle of the tasks started by `ell_runtime_StartTasks` (shared runtime mode only)
+        llvm::GlobalVariable* _hotCount = nullptr; // number of running predict calls that keep the workers polling (hot pool only)
+        int _numWorkers = 0;
+        int _spinCount = 0; // number of times to poll for work before blocking
         IRThreadPoolTaskArray _tasks;
     };
 
@@ -223,16 +290,40 @@ namespace emitters
         /// <summary> Tell the thread pool to finish and kill the treads. </summary>
         void ShutDown(IRFunctionEmitter& function);
 
+        /// <summary> Gets the name of the exported `int <module>_SetThreadPoolAffinity(int* cores, int numCores)` function. </summary>
+        /// This function pins pool worker i to core `cores[i % numCores]`, and returns 0 on success or a nonzero error code
+        /// (-1 on targets without thread affinity support). It is emitted only if the module uses its own thread pool.
+        std::string GetSetAffinityFunctionName() const;
+
+        /// <summary> Marks the start of a predict call: until the matching `EndHotRegion`, idle workers keep polling
+        /// for tasks instead of blocking. Does nothing unless the `hotThreadPool` compiler option is set. </summary>
+        ///
+        /// <param name="function"> The predict function being emitted into. </param>
+        void BeginHotRegion(IRFunctionEmitter& function);
+
+        /// <summary> Marks the end of a predict call started with `BeginHotRegion`. </summary>
+        ///
+        /// <param name="function"> The predict function being emitted into. </param>
+        void EndHotRegion(IRFunctionEmitter& function);
+
     private:
         void Initialize(); // Allocates threads and adds global initializer and finalizer functions
         bool IsInitialized() const;
         void AddGlobalInitializer();
         void AddGlobalFinalizer();
+        LLVMFunction AddSetAffinityFunction();
         LLVMFunction GetWorkerThreadFunction();
+        LLVMFunction GetWorkStealingWorkerThreadFunction();
+        bool IsHot() const;
+        llvm::GlobalVariable* GetHotCount();
 
         IRModuleEmitter& _module;
         size_t _maxThreads = 0;
+        bool _useWorkStealing = false;
         llvm::GlobalVariable* _threads = nullptr; // global array of pthread_t
+        llvm::GlobalVariable* _isInitialized = nullptr; // set once the worker threads have been created
+        llvm::GlobalVariable* _hotCount = nullptr; // number of running predict calls (hot pool only)
+        LLVMFunction _setAffinityFunction = nullptr;
 
         // task queue
         IRThreadPoolTaskQueue _taskQueue;
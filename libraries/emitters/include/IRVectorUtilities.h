@@ -10,10 +10,19 @@
 #include "EmitterException.h"
 #include "EmitterTypes.h"
 #include "IRFunctionEmitter.h"
+#include "IRModuleEmitter.h"
 #include "LLVMUtilities.h"
 
 #include <utilities/include/TypeTraits.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace ell
 {
 namespace emitters
@@ -52,6 +61,147 @@ namespace emitters
     /// <returns> The sum of the elements in the given vector </returns>
     template <typename ValueType>
     LLVMValue HorizontalVectorSum(IRFunctionEmitter& function, LLVMValue vectorValue);
+
+    /// <summary> Load consecutive entries of an array into a vector, without assuming the address is aligned to the size of the vector </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="pArray"> Pointer to the array </param>
+    /// <param name="index"> The index of the first entry to load </param>
+    /// <param name="vectorSize"> The number of entries to load </param>
+    ///
+    /// <returns> A vector with the `vectorSize` entries starting at `index` </returns>
+    template <typename ValueType>
+    LLVMValue LoadUnalignedVector(IRFunctionEmitter& function, LLVMValue pArray, LLVMValue index, int vectorSize);
+
+    /// <summary> Store a vector into consecutive entries of an array, without assuming the address is aligned to the size of the vector </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="pArray"> Pointer to the array </param>
+    /// <param name="index"> The index of the first entry to store </param>
+    /// <param name="vectorValue"> The vector to store </param>
+    template <typename ValueType>
+    void StoreUnalignedVector(IRFunctionEmitter& function, LLVMValue pArray, LLVMValue index, LLVMValue vectorValue);
+
+    /// <summary> Create a vector filled with copies of a (non-constant) scalar value </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="scalarValue"> The value to place in the vector elements </param>
+    /// <param name="vectorSize"> The number of elements </param>
+    ///
+    /// <returns> A vector with `vectorSize` copies of the value </returns>
+    LLVMValue BroadcastVector(IRFunctionEmitter& function, LLVMValue scalarValue, int vectorSize);
+
+    /// <summary> Compute `a * b + c` elementwise. For floating-point values this is a single fused instruction on
+    /// targets that have one (FMA3 on x86, `fmla` on ARM), and a multiply and an add elsewhere. </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="a"> The first factor, a scalar or a vector </param>
+    /// <param name="b"> The second factor, of the same type as `a` </param>
+    /// <param name="c"> The addend, of the same type as `a` </param>
+    ///
+    /// <returns> The value of `a * b + c` </returns>
+    template <typename ValueType>
+    LLVMValue VectorMultiplyAdd(IRFunctionEmitter& function, LLVMValue a, LLVMValue b, LLVMValue c);
+
+    /// <summary> Select elements from the concatenation of two vectors of the same type </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="a"> The first vector, whose elements have indices [0, n) </param>
+    /// <param name="b"> The second vector, whose elements have indices [n, 2n) </param>
+    /// <param name="elementIndices"> The index of each element of the result </param>
+    ///
+    /// <returns> A vector with `elementIndices.size()` elements </returns>
+    LLVMValue ShuffleVectors(IRFunctionEmitter& function, LLVMValue a, LLVMValue b, const std::vector<uint32_t>& elementIndices);
+
+    /// <summary> Interleave the elements of half of each of two vectors: <a0, b0, a1, b1, ...> for the lower halves or
+    /// <a(n/2), b(n/2), ...> for the upper halves. These are the `zip1`/`zip2` instructions on ARM and `unpcklps`/`unpckhps` on x86. </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="a"> The vector whose elements go in the even lanes </param>
+    /// <param name="b"> The vector whose elements go in the odd lanes </param>
+    /// <param name="upperHalves"> If `true`, interleave the upper halves, else the lower halves </param>
+    ///
+    /// <returns> A vector of the same type as `a` and `b` </returns>
+    LLVMValue InterleaveVectors(IRFunctionEmitter& function, LLVMValue a, LLVMValue b, bool upperHalves);
+
+    /// <summary> Gets the number of lanes to use for the accumulators of a vectorized reduction: the vector width if vector instructions are allowed and it's a power of 2, otherwise 1 </summary>
+    ///
+    /// <param name="options"> The compiler options of the function being emitted </param>
+    ///
+    /// <returns> The number of lanes </returns>
+    inline int GetReductionVectorSize(const CompilerOptions& options)
+    {
+        const int width = options.vectorWidth;
+        const bool isPowerOfTwo = width > 0 && (width & (width - 1)) == 0;
+        return options.allowVectorInstructions && isPowerOfTwo ? width : 1;
+    }
+
+    /// <summary> Signature of a function that emits the terms of a sum, as used by `EmitVectorizedSum` </summary>
+    ///
+    /// Emits the terms `index`, ..., `index + width - 1`, as a vector of `width` entries (or a scalar, if `width` is 1).
+    using SumTermFunction = std::function<LLVMValue(IRFunctionEmitter& function, LLVMValue index, int width)>;
+
+    /// <summary>
+    /// Emit the sum of `size` terms using several independent accumulators of `vectorSize` lanes each, so no addition
+    /// waits on the one before it. The accumulators are added together pairwise at the end, and then horizontally.
+    /// This reassociates the sum, so it should only be used for floating-point values if fast math is allowed.
+    /// </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="size"> The number of terms </param>
+    /// <param name="vectorSize"> The number of lanes of each accumulator. Must be a power of 2. </param>
+    /// <param name="numAccumulators"> The number of accumulators </param>
+    /// <param name="getTerms"> Emits the terms of the sum </param>
+    ///
+    /// <returns> The sum </returns>
+    template <typename ValueType>
+    LLVMValue EmitVectorizedSum(IRFunctionEmitter& function, int size, int vectorSize, int numAccumulators, SumTermFunction getTerms);
+
+    /// <summary>
+    /// Emit the dot product of two arrays with explicit vector instructions, using several independent accumulators as in
+    /// `EmitVectorizedSum`. This reassociates the sum, so it should only be used for floating-point values if fast math is allowed.
+    /// </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="size"> The number of entries of each array </param>
+    /// <param name="pA"> Pointer to the first array </param>
+    /// <param name="pB"> Pointer to the second array </param>
+    /// <param name="vectorSize"> The number of lanes of each accumulator. Must be a power of 2. </param>
+    /// <param name="numAccumulators"> The number of accumulators </param>
+    ///
+    /// <returns> The dot product </returns>
+    template <typename ValueType>
+    LLVMValue EmitVectorizedDotProduct(IRFunctionEmitter& function, int size, LLVMValue pA, LLVMValue pB, int vectorSize, int numAccumulators);
+
+    /// <summary>
+    /// Emit the search for the largest (or smallest) entry of an array, comparing `vectorSize` entries at a time. Each
+    /// lane keeps its own best value and index, and the lanes are combined at the end. Ties go to the lowest index, as
+    /// in a serial search, so the result doesn't depend on the vector size.
+    /// </summary>
+    ///
+    /// <param name="function"> The function being emitted </param>
+    /// <param name="pValues"> Pointer to the array </param>
+    /// <param name="size"> The number of entries. Must be at least `vectorSize`. </param>
+    /// <param name="vectorSize"> The number of entries to compare at a time </param>
+    /// <param name="findMax"> If `true`, find the largest entry, else the smallest </param>
+    ///
+    /// <returns> The extremal value, and its index as an int32 value </returns>
+    template <typename ValueType>
+    LLVMValue EmitVectorizedDotProduct(IRFunctionEmitter& function, int size, LLVMValue pA, LLVMValue pB, int vectorSize, int numAccumulators)
+    {
+        return EmitVectorizedSum<ValueType>(function, size, vectorSize, numAccumulators, [pA, pB](IRFunctionEmitter& function, LLVMValue index, int width) -> LLVMValue {
+            if (width == 1)
+            {
+                return function.Operator(GetMultiplyForValueType<ValueType>(), function.ValueAt(pA, index), function.ValueAt(pB, index));
+            }
+            auto a = LoadUnalignedVector<ValueType>(function, pA, index, width);
+            auto b = LoadUnalignedVector<ValueType>(function, pB, index, width);
+            return function.Operator(GetMultiplyForValueType<ValueType>(), a, b);
+        });
+    }
+
+    template <typename ValueType>
+    std::pair<LLVMValue, LLVMValue> EmitVectorizedArgExtremum(IRFunctionEmitter& function, LLVMValue pValues, int size, int vectorSize, bool findMax);
 } // namespace emitters
 } // namespace ell
 
@@ -137,6 +287,201 @@ namespace emitters
         auto half2 = emitter.GetIRBuilder().CreateExtractElement(vectorValue, static_cast<uint64_t>(1));
         return function.Operator(emitters::GetAddForValueType<ValueType>(), half1, half2);
     }
+
+    template <typename ValueType>
+    LLVMValue LoadUnalignedVector(IRFunctionEmitter& function, LLVMValue pArray, LLVMValue index, int vectorSize)
+    {
+        auto vectorType = function.GetEmitter().VectorType(GetVariableType<ValueType>(), vectorSize);
+        auto pVector = function.CastPointer(function.PointerOffset(pArray, index), vectorType->getPointerTo());
+        auto load = function.GetEmitter().GetIRBuilder().CreateLoad(vectorType, pVector);
+        load->setAlignment(sizeof(ValueType));
+        return load;
+    }
+
+    template <typename ValueType>
+    void StoreUnalignedVector(IRFunctionEmitter& function, LLVMValue pArray, LLVMValue index, LLVMValue vectorValue)
+    {
+        auto pVector = function.CastPointer(function.PointerOffset(pArray, index), vectorValue->getType()->getPointerTo());
+        auto store = function.GetEmitter().GetIRBuilder().CreateStore(vectorValue, pVector);
+        store->setAlignment(sizeof(ValueType));
+    }
+
+    inline LLVMValue BroadcastVector(IRFunctionEmitter& function, LLVMValue scalarValue, int vectorSize)
+    {
+        return function.GetEmitter().GetIRBuilder().CreateVectorSplat(vectorSize, scalarValue);
+    }
+
+    template <typename ValueType>
+    LLVMValue VectorMultiplyAdd(IRFunctionEmitter& function, LLVMValue a, LLVMValue b, LLVMValue c)
+    {
+        if constexpr (std::is_floating_point_v<ValueType>)
+        {
+            // `fmuladd` leaves it to the code generator to fuse the operations where that's fast
+            auto fmuladd = function.GetModule().GetIntrinsic(llvm::Intrinsic::fmuladd, { a->getType() });
+            return function.Call(fmuladd, { a, b, c });
+        }
+        else
+        {
+            auto product = function.Operator(GetMultiplyForValueType<ValueType>(), a, b);
+            return function.Operator(GetAddForValueType<ValueType>(), product, c);
+        }
+    }
+
+    inline LLVMValue ShuffleVectors(IRFunctionEmitter& function, LLVMValue a, LLVMValue b, const std::vector<uint32_t>& elementIndices)
+    {
+        return function.GetEmitter().GetIRBuilder().CreateShuffleVector(a, b, elementIndices);
+    }
+
+    inline LLVMValue InterleaveVectors(IRFunctionEmitter& function, LLVMValue a, LLVMValue b, bool upperHalves)
+    {
+        auto vectorType = llvm::dyn_cast<llvm::VectorType>(a->getType());
+        if (vectorType == nullptr || vectorType->getNumElements() % 2 != 0)
+        {
+            throw EmitterException(EmitterError::valueTypeNotSupported, "InterleaveVectors needs vectors with an even number of elements");
+        }
+
+        const uint32_t vectorSize = vectorType->getNumElements();
+        const uint32_t start = upperHalves ? vectorSize / 2 : 0;
+        std::vector<uint32_t> elementIndices;
+        for (uint32_t index = 0; index < vectorSize / 2; ++index)
+        {
+            elementIndices.push_back(start + index);
+            elementIndices.push_back(vectorSize + start + index);
+        }
+        return ShuffleVectors(function, a, b, elementIndices);
+    }
+
+    template <typename ValueType>
+    LLVMValue EmitVectorizedSum(IRFunctionEmitter& function, int size, int vectorSize, int numAccumulators, SumTermFunction getTerms)
+    {
+        const auto add = GetAddForValueType<ValueType>();
+        vectorSize = std::max(vectorSize, 1);
+        numAccumulators = std::max(numAccumulators, 1);
+
+        LLVMType accumulatorType = function.GetEmitter().Type(GetVariableType<ValueType>());
+        LLVMValue zero = function.Literal<ValueType>(0);
+        if (vectorSize > 1)
+        {
+            auto vectorType = function.GetEmitter().VectorType(GetVariableType<ValueType>(), vectorSize);
+            accumulatorType = vectorType;
+            zero = FillVector<ValueType>(function, vectorType, 0);
+        }
+
+        std::vector<LLVMValue> accumulators;
+        for (int accumulatorIndex = 0; accumulatorIndex < numAccumulators; ++accumulatorIndex)
+        {
+            accumulators.push_back(function.Variable(accumulatorType, "accum"));
+            function.Store(accumulators.back(), zero);
+        }
+
+        // Each iteration adds one vector of terms to each accumulator
+        const int blockSize = vectorSize * numAccumulators;
+        const int numBlocks = size / blockSize;
+        if (numBlocks > 0)
+        {
+            function.For(numBlocks, [accumulators, getTerms, add, blockSize, vectorSize](IRFunctionEmitter& function, IRLocalScalar blockIndex) {
+                auto blockStart = blockIndex * blockSize;
+                for (size_t accumulatorIndex = 0; accumulatorIndex < accumulators.size(); ++accumulatorIndex)
+                {
+                    auto terms = getTerms(function, blockStart + static_cast<int>(accumulatorIndex) * vectorSize, vectorSize);
+                    function.OperationAndUpdate(accumulators[accumulatorIndex], add, terms);
+                }
+            });
+        }
+
+        // The whole vectors left over go in the first accumulators
+        int index = numBlocks * blockSize;
+        for (int accumulatorIndex = 0; index + vectorSize <= size; ++accumulatorIndex, index += vectorSize)
+        {
+            function.OperationAndUpdate(accumulators[accumulatorIndex], add, getTerms(function, function.Literal<int>(index), vectorSize));
+        }
+
+        // Combine the accumulators as a tree, so the additions are independent
+        std::vector<LLVMValue> partialSums;
+        for (auto accumulator : accumulators)
+        {
+            partialSums.push_back(function.Load(accumulator));
+        }
+        while (partialSums.size() > 1)
+        {
+            std::vector<LLVMValue> combined;
+            for (size_t partialIndex = 0; partialIndex + 1 < partialSums.size(); partialIndex += 2)
+            {
+                combined.push_back(function.Operator(add, partialSums[partialIndex], partialSums[partialIndex + 1]));
+            }
+            if (partialSums.size() % 2 != 0)
+            {
+                combined.push_back(partialSums.back());
+            }
+            partialSums = std::move(combined);
+        }
+
+        auto sum = HorizontalVectorSum<ValueType>(function, partialSums[0]);
+        for (; index < size; ++index)
+        {
+            sum = function.Operator(add, sum, getTerms(function, function.Literal<int>(index), 1));
+        }
+        return sum;
+    }
+
+    template <typename ValueType>
+    std::pair<LLVMValue, LLVMValue> EmitVectorizedArgExtremum(IRFunctionEmitter& function, LLVMValue pValues, int size, int vectorSize, bool findMax)
+    {
+        if (vectorSize < 2 || size < vectorSize)
+        {
+            throw EmitterException(EmitterError::badFunctionArguments, "EmitVectorizedArgExtremum needs at least one vector of values");
+        }
+
+        auto& emitter = function.GetEmitter();
+        auto& builder = emitter.GetIRBuilder();
+        const auto isBetter = GetComparison<ValueType>(findMax ? BinaryPredicateType::greater : BinaryPredicateType::less);
+        const auto isEqual = GetComparison<ValueType>(BinaryPredicateType::equal);
+
+        std::vector<uint32_t> lanes(vectorSize);
+        std::iota(lanes.begin(), lanes.end(), 0);
+        LLVMValue laneIndices = llvm::ConstantDataVector::get(function.GetLLVMContext(), lanes);
+
+        // Each lane keeps the best value it has seen, and where. A strict comparison keeps the first of equal values.
+        LLVMValue bestValues = function.Variable(emitter.VectorType(GetVariableType<ValueType>(), vectorSize), "bestValues");
+        LLVMValue bestIndices = function.Variable(emitter.VectorType(VariableType::Int32, vectorSize), "bestIndices");
+        function.Store(bestValues, LoadUnalignedVector<ValueType>(function, pValues, function.Literal<int>(0), vectorSize));
+        function.Store(bestIndices, laneIndices);
+
+        const int numVectors = size / vectorSize;
+        function.For(1, numVectors, [pValues, bestValues, bestIndices, laneIndices, isBetter, vectorSize](IRFunctionEmitter& function, IRLocalScalar vectorIndex) {
+            auto start = vectorIndex * vectorSize;
+            auto values = LoadUnalignedVector<ValueType>(function, pValues, start, vectorSize);
+            auto indices = function.Operator(TypedOperator::add, function.GetEmitter().GetIRBuilder().CreateVectorSplat(vectorSize, start), laneIndices);
+            auto better = function.Comparison(isBetter, values, function.Load(bestValues));
+            function.Store(bestValues, function.Select(better, values, function.Load(bestValues)));
+            function.Store(bestIndices, function.Select(better, indices, function.Load(bestIndices)));
+        });
+
+        // Combine the lanes, preferring the lower index when values are equal
+        auto laneValues = function.Load(bestValues);
+        auto laneBestIndices = function.Load(bestIndices);
+        LLVMValue bestValue = builder.CreateExtractElement(laneValues, static_cast<uint64_t>(0));
+        LLVMValue bestIndex = builder.CreateExtractElement(laneBestIndices, static_cast<uint64_t>(0));
+        for (int lane = 1; lane < vectorSize; ++lane)
+        {
+            auto value = builder.CreateExtractElement(laneValues, static_cast<uint64_t>(lane));
+            auto valueIndex = builder.CreateExtractElement(laneBestIndices, static_cast<uint64_t>(lane));
+            auto isTieWithLowerIndex = builder.CreateAnd(function.Comparison(isEqual, value, bestValue), function.Comparison(TypedComparison::lessThan, valueIndex, bestIndex));
+            auto take = builder.CreateOr(function.Comparison(isBetter, value, bestValue), isTieWithLowerIndex);
+            bestValue = function.Select(take, value, bestValue);
+            bestIndex = function.Select(take, valueIndex, bestIndex);
+        }
+
+        // The entries after the last whole vector come after all the others, so only a strictly better value wins
+        for (int index = numVectors * vectorSize; index < size; ++index)
+        {
+            auto value = function.ValueAt(pValues, function.Literal<int>(index));
+            auto take = function.Comparison(isBetter, value, bestValue);
+            bestValue = function.Select(take, value, bestValue);
+            bestIndex = function.Select(take, function.Literal<int>(index), bestIndex);
+        }
+        return { bestValue, bestIndex };
+    }
 } // namespace emitters
 } // namespace ell
 
@@ -25,6 +25,15 @@ namespace emitters
         std::string features = "";
         size_t numBits = 0;
 
+        /// <summary> Size of the per-core L1 data cache, in bytes, or 0 if unknown. </summary>
+        size_t l1CacheSize = 0;
+
+        /// <summary> Size of the L2 cache, in bytes, or 0 if unknown. </summary>
+        size_t l2CacheSize = 0;
+
+        /// <summary> How far ahead, in bytes, streaming loops prefetch memory, or 0 if the hardware prefetcher keeps up on its own. </summary>
+        size_t prefetchDistance = 0;
+
         /// <summary> Indicates if the target device is a Windows system </summary>
         bool IsWindows() const;
 
@@ -33,6 +42,13 @@ namespace emitters
 
         /// <summary> Indicates if the target device is a macOS system </summary>
         bool IsMacOS() const;
+
+        /// <summary> Indicates if the target device is an ARM core with the DSP extension (e.g., Cortex-M4 and M7), whose SIMD
+        /// instructions like SMLAD multiply and add pairs of 16-bit values </summary>
+        bool HasDspExtension() const;
+
+        /// <summary> Indicates if the target device is WebAssembly, which has no threads or system libraries </summary>
+        bool IsWebAssembly() const;
     };
 
     /// <summary> Create a TargetDevice from a device name. </summary>
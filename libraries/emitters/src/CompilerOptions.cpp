@@ -10,7 +10,9 @@
 
 #include <utilities/include/Exception.h>
 
+#include <algorithm>
 #include <map>
+#include <stdexcept>
 
 #define ADD_TO_STRING_ENTRY(NAMESPACE, ENTRY) \
     case NAMESPACE::ENTRY:                    \
@@ -37,6 +39,128 @@ namespace emitters
         }
     }
 
+    std::string ToString(WeightStorageType t)
+    {
+        switch (t)
+        {
+        case WeightStorageType::float32:
+            return "float32";
+        case WeightStorageType::float16:
+            return "float16";
+        case WeightStorageType::bfloat16:
+            return "bfloat16";
+        default:
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument);
+        }
+    }
+
+    std::string ToString(FastMathAccuracy t)
+    {
+        switch (t)
+        {
+        case FastMathAccuracy::exact:
+            return "exact";
+        case FastMathAccuracy::high:
+            return "high";
+        case FastMathAccuracy::low:
+            return "low";
+        default:
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument);
+        }
+    }
+
+    std::string ToString(ParallelLoopSchedule t)
+    {
+        switch (t)
+        {
+        case ParallelLoopSchedule::staticBlocks:
+            return "static";
+        case ParallelLoopSchedule::dynamic:
+            return "dynamic";
+        case ParallelLoopSchedule::guided:
+            return "guided";
+        default:
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument);
+        }
+    }
+
+    std::string ToString(SizeOptimization t)
+    {
+        switch (t)
+        {
+        case SizeOptimization::speed:
+            return "speed";
+        case SizeOptimization::size:
+            return "size";
+        case SizeOptimization::minSize:
+            return "minSize";
+        default:
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument);
+        }
+    }
+
+    std::vector<int> ParseCoreList(const std::string& coreList)
+    {
+        // Core indices are plain decimal numbers (std::stoi alone would accept "3abc" or " 3")
+        auto parseCore = [](const std::string& text) {
+            if (text.empty() || !std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; }))
+            {
+                throw std::invalid_argument(text);
+            }
+            return std::stoi(text);
+        };
+
+        std::vector<int> result;
+        for (const auto& entry : utilities::Split(coreList, ','))
+        {
+            if (entry.empty())
+            {
+                continue;
+            }
+
+            auto range = utilities::Split(entry, '-');
+            try
+            {
+                if (range.size() == 1)
+                {
+                    result.push_back(parseCore(range[0]));
+                    continue;
+                }
+                if (range.size() == 2)
+                {
+                    auto first = parseCore(range[0]);
+                    auto last = parseCore(range[1]);
+                    if (first <= last)
+                    {
+                        for (int core = first; core <= last; ++core)
+                        {
+                            result.push_back(core);
+                        }
+                        continue;
+                    }
+                }
+            }
+            catch (const std::logic_error&)
+            {
+            }
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Invalid core list entry: " + entry);
+        }
+        return result;
+    }
+
+    std::vector<std::string> ParseCpuDispatchLevels(const std::string& levelList)
+    {
+        std::vector<std::string> result;
+        for (const auto& level : utilities::Split(levelList, ','))
+        {
+            if (!level.empty())
+            {
+                result.push_back(level);
+            }
+        }
+        return result;
+    }
+
     /// <summary> Constructor from a property bag </summary>
     CompilerOptions::CompilerOptions(const utilities::PropertyBag& properties)
     {
@@ -60,17 +184,53 @@ namespace emitters
         }
 
         optimize = properties.GetOrParseEntry("optimize", optimize);
+        optimizationThreads = properties.GetOrParseEntry<int>("optimizationThreads", optimizationThreads);
+        optimizationLevel = properties.GetOrParseEntry<int>("optimizationLevel", optimizationLevel);
+        sizeOptimization = properties.GetOrParseEntry<SizeOptimization>("sizeOptimization", sizeOptimization);
+        allowInlining = properties.GetOrParseEntry<bool>("allowInlining", allowInlining);
+        maxOptimizationSeconds = properties.GetOrParseEntry<double>("maxOptimizationSeconds", maxOptimizationSeconds);
         unrollLoops = properties.GetOrParseEntry("unrollLoops", unrollLoops);
         inlineOperators = properties.GetOrParseEntry<bool>("inlineOperators", inlineOperators);
         allowVectorInstructions = properties.GetOrParseEntry<bool>("allowVectorInstructions", allowVectorInstructions);
         vectorWidth = properties.GetOrParseEntry<int>("vectorWidth", vectorWidth);
+        if (properties.HasEntry("cpuDispatchLevels"))
+        {
+            cpuDispatchLevels = ParseCpuDispatchLevels(properties.GetEntry<std::string>("cpuDispatchLevels"));
+        }
         useBlas = properties.GetOrParseEntry<bool>("useBlas", useBlas);
+        blasType = properties.GetOrParseEntry<BlasType>("blasType", blasType);
+        blasThreads = properties.GetOrParseEntry<int>("blasThreads", blasThreads);
+        blasMinOperationsPerThread = properties.GetOrParseEntry<int>("blasMinOperationsPerThread", blasMinOperationsPerThread);
+        useBlockedGemm = properties.GetOrParseEntry<bool>("useBlockedGemm", useBlockedGemm);
+        smallGemmThreshold = properties.GetOrParseEntry<int>("smallGemmThreshold", smallGemmThreshold);
+        useGpu = properties.GetOrParseEntry<bool>("useGpu", useGpu);
+        gpuMinOperations = properties.GetOrParseEntry<int>("gpuMinOperations", gpuMinOperations);
+        useCmsis = properties.GetOrParseEntry<bool>("useCmsis", useCmsis);
+        weightStorageType = properties.GetOrParseEntry<WeightStorageType>("weightStorageType", weightStorageType);
+        prefetchDistance = properties.GetOrParseEntry<int>("prefetchDistance", prefetchDistance);
         profile = properties.GetOrParseEntry<bool>("profile", profile);
+        profileHardwareCounters = properties.GetOrParseEntry<bool>("profileHardwareCounters", profileHardwareCounters);
+        profileLatencyHistograms = properties.GetOrParseEntry<bool>("profileLatencyHistograms", profileLatencyHistograms);
+        profileSamplingInterval = properties.GetOrParseEntry<int>("profileSamplingInterval", profileSamplingInterval);
+        traceExecution = properties.GetOrParseEntry<bool>("traceExecution", traceExecution);
         includeDiagnosticInfo = properties.GetOrParseEntry<bool>("includeDiagnosticInfo", includeDiagnosticInfo);
         parallelize = properties.GetOrParseEntry<bool>("parallelize", parallelize);
         useThreadPool = properties.GetOrParseEntry<bool>("useThreadPool", useThreadPool);
+        useWorkStealing = properties.GetOrParseEntry<bool>("useWorkStealing", useWorkStealing);
+        threadPoolSpinCount = properties.GetOrParseEntry<int>("threadPoolSpinCount", threadPoolSpinCount);
+        hotThreadPool = properties.GetOrParseEntry<bool>("hotThreadPool", hotThreadPool);
+        useSharedRuntime = properties.GetOrParseEntry<bool>("useSharedRuntime", useSharedRuntime);
+        useHugePages = properties.GetOrParseEntry<bool>("useHugePages", useHugePages);
+        firstTouchBuffers = properties.GetOrParseEntry<bool>("firstTouchBuffers", firstTouchBuffers);
+        parallelLoopSchedule = properties.GetOrParseEntry<ParallelLoopSchedule>("parallelLoopSchedule", parallelLoopSchedule);
+        parallelLoopChunkSize = properties.GetOrParseEntry<int>("parallelLoopChunkSize", parallelLoopChunkSize);
         maxThreads = properties.GetOrParseEntry<int>("maxThreads", maxThreads);
+        if (properties.HasEntry("threadAffinity"))
+        {
+            threadAffinity = ParseCoreList(properties.GetEntry<std::string>("threadAffinity"));
+        }
         useFastMath = properties.GetOrParseEntry<bool>("useFastMath", useFastMath);
+        fastMathAccuracy = properties.GetOrParseEntry<FastMathAccuracy>("fastMathAccuracy", fastMathAccuracy);
         debug = properties.GetOrParseEntry<bool>("debug", debug);
 
         if (properties.HasEntry("deviceName"))
@@ -97,5 +257,65 @@ namespace utilities
         
         return it->second;
     }
+
+    template <>
+    emitters::WeightStorageType FromString<emitters::WeightStorageType>(const std::string& s)
+    {
+        static std::map<std::string, emitters::WeightStorageType> nameMap = { { "float32", emitters::WeightStorageType::float32 },
+                                                                              { "float16", emitters::WeightStorageType::float16 },
+                                                                              { "bfloat16", emitters::WeightStorageType::bfloat16 } };
+        auto it = nameMap.find(s);
+        if (it == nameMap.end())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "Unknown WeightStorageType");
+        }
+
+        return it->second;
+    }
+
+    template <>
+    emitters::FastMathAccuracy FromString<emitters::FastMathAccuracy>(const std::string& s)
+    {
+        static std::map<std::string, emitters::FastMathAccuracy> nameMap = { { "exact", emitters::FastMathAccuracy::exact },
+                                                                             { "high", emitters::FastMathAccuracy::high },
+                                                                             { "low", emitters::FastMathAccuracy::low } };
+        auto it = nameMap.find(s);
+        if (it == nameMap.end())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "Unknown FastMathAccuracy");
+        }
+
+        return it->second;
+    }
+
+    template <>
+    emitters::ParallelLoopSchedule FromString<emitters::ParallelLoopSchedule>(const std::string& s)
+    {
+        static std::map<std::string, emitters::ParallelLoopSchedule> nameMap = { { "static", emitters::ParallelLoopSchedule::staticBlocks },
+                                                                                 { "dynamic", emitters::ParallelLoopSchedule::dynamic },
+                                                                                 { "guided", emitters::ParallelLoopSchedule::guided } };
+        auto it = nameMap.find(s);
+        if (it == nameMap.end())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "Unknown ParallelLoopSchedule");
+        }
+
+        return it->second;
+    }
+
+    template <>
+    emitters::SizeOptimization FromString<emitters::SizeOptimization>(const std::string& s)
+    {
+        static std::map<std::string, emitters::SizeOptimization> nameMap = { { "speed", emitters::SizeOptimization::speed },
+                                                                             { "size", emitters::SizeOptimization::size },
+                                                                             { "minSize", emitters::SizeOptimization::minSize } };
+        auto it = nameMap.find(s);
+        if (it == nameMap.end())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "Unknown SizeOptimization");
+        }
+
+        return it->second;
+    }
 } // namespace utilities
 } // namespace ell
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     GemmTileSizes.cpp (emitters)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "GemmTileSizes.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace ell
+{
+namespace emitters
+{
+    namespace
+    {
+        // Used when the target device doesn't tell us its cache sizes
+        constexpr size_t c_defaultL1CacheSize = 32 * 1024;
+        constexpr size_t c_defaultL2CacheSize = 256 * 1024;
+
+        int RoundUp(int value, int multiple)
+        {
+            return ((value + multiple - 1) / multiple) * multiple;
+        }
+    } // namespace
+
+    GemmTileSizes GetGemmTileSizes(const CompilerOptions& options, int elementSize, int m, int n, int k)
+    {
+        const auto& device = options.targetDevice;
+        auto l1CacheSize = static_cast<int>(device.l1CacheSize != 0 ? device.l1CacheSize : c_defaultL1CacheSize);
+        auto l2CacheSize = static_cast<int>(device.l2CacheSize != 0 ? device.l2CacheSize : c_defaultL2CacheSize);
+
+        GemmTileSizes tiles;
+        tiles.mr = 4;
+        tiles.nr = options.allowVectorInstructions ? std::clamp(options.vectorWidth, 1, 16) : 4;
+
+        // One micro-panel each of A and B should stay in (half of) L1 while a register tile is computed
+        tiles.kc = std::max(16, l1CacheSize / (2 * (tiles.mr + tiles.nr) * elementSize));
+
+        // The packed blocks of A and B share L2
+        tiles.mc = std::max(tiles.mr, (l2CacheSize / (2 * tiles.kc * elementSize)) / tiles.mr * tiles.mr);
+        tiles.nc = std::max(tiles.nr, (l2CacheSize / (2 * tiles.kc * elementSize)) / tiles.nr * tiles.nr);
+
+        // Don't allocate more scratch space than the problem needs
+        tiles.kc = std::min(tiles.kc, k);
+        tiles.mc = std::min(tiles.mc, RoundUp(m, tiles.mr));
+        tiles.nc = std::min(tiles.nc, RoundUp(n, tiles.nr));
+        return tiles;
+    }
+
+    bool IsSmallGemm(const CompilerOptions& options, int m, int n, int k)
+    {
+        const auto numOperations = static_cast<int64_t>(m) * n * k;
+        return numOperations > 0 && numOperations <= options.smallGemmThreshold;
+    }
+
+    bool IsGpuGemm(const CompilerOptions& options, int m, int n, int k)
+    {
+        return options.useGpu && static_cast<int64_t>(m) * n * k >= options.gpuMinOperations;
+    }
+
+    bool UsesBlockedGemm(const CompilerOptions& options, int m, int n, int k)
+    {
+        return !IsSmallGemm(options, m, n, k) && !IsGpuGemm(options, m, n, k) && !options.useBlas && options.useBlockedGemm;
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> PackGemmLeftOperand(const GemmTileSizes& tiles, bool transposeA, int m, int k, const ValueType* A, int lda)
+    {
+        const int numRowBlocks = (m + tiles.mc - 1) / tiles.mc;
+        const int numSlices = (k + tiles.kc - 1) / tiles.kc;
+        std::vector<ValueType> packed(static_cast<size_t>(numRowBlocks) * numSlices * tiles.mc * tiles.kc);
+        auto out = packed.begin();
+        for (int firstRow = 0; firstRow < m; firstRow += tiles.mc)
+        {
+            for (int pc = 0; pc < k; pc += tiles.kc)
+            {
+                for (int panel = 0; panel < tiles.mc / tiles.mr; ++panel)
+                {
+                    for (int p = 0; p < tiles.kc; ++p)
+                    {
+                        for (int i = 0; i < tiles.mr; ++i, ++out)
+                        {
+                            auto row = firstRow + panel * tiles.mr + i;
+                            auto column = pc + p;
+                            if (row < m && column < k)
+                            {
+                                *out = transposeA ? A[column * lda + row] : A[row * lda + column];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return packed;
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> PackGemmRightOperand(const GemmTileSizes& tiles, bool transposeB, int k, int n, const ValueType* B, int ldb)
+    {
+        const int numColumnBlocks = (n + tiles.nc - 1) / tiles.nc;
+        const int numSlices = (k + tiles.kc - 1) / tiles.kc;
+        std::vector<ValueType> packed(static_cast<size_t>(numColumnBlocks) * numSlices * tiles.kc * tiles.nc);
+        auto out = packed.begin();
+        for (int firstColumn = 0; firstColumn < n; firstColumn += tiles.nc)
+        {
+            for (int pc = 0; pc < k; pc += tiles.kc)
+            {
+                for (int panel = 0; panel < tiles.nc / tiles.nr; ++panel)
+                {
+                    for (int p = 0; p < tiles.kc; ++p)
+                    {
+                        for (int j = 0; j < tiles.nr; ++j, ++out)
+                        {
+                            auto row = pc + p;
+                            auto column = firstColumn + panel * tiles.nr + j;
+                            if (row < k && column < n)
+                            {
+                                *out = transposeB ? B[column * ldb + row] : B[row * ldb + column];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return packed;
+    }
+
+    template std::vector<float> PackGemmLeftOperand(const GemmTileSizes& tiles, bool transposeA, int m, int k, const float* A, int lda);
+    template std::vector<double> PackGemmLeftOperand(const GemmTileSizes& tiles, bool transposeA, int m, int k, const double* A, int lda);
+    template std::vector<float> PackGemmRightOperand(const GemmTileSizes& tiles, bool transposeB, int k, int n, const float* B, int ldb);
+    template std::vector<double> PackGemmRightOperand(const GemmTileSizes& tiles, bool transposeB, int k, int n, const double* B, int ldb);
+} // namespace emitters
+} // namespace ell
@@ -35,6 +35,9 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Verifier.h>
 
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Object/SymbolSize.h>
+
 #include <llvm/Pass.h>
 
 #include <llvm/Support/Host.h>
@@ -44,7 +47,10 @@
 
 #include <llvm/Target/TargetMachine.h>
 
+#include <llvm/Transforms/Utils/Cloning.h>
+
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -101,8 +107,15 @@ namespace emitters
     // GenerateMachineCode may modify the Module object passed in. Should we clone it first?
     void GenerateMachineCode(llvm::raw_ostream& os, IRModuleEmitter& moduleEmitter, ModuleOutputFormat outputFormat, const MachineCodeOutputOptions& ellOptions)
     {
-        llvm::Module& module = *(moduleEmitter.GetLLVMModule());
+        GenerateMachineCode(os, *moduleEmitter.GetLLVMModule(), outputFormat, ellOptions);
+        if (moduleEmitter.GetDiagnosticHandler().HadError())
+        {
+            throw EmitterException(EmitterError::unexpected, "Error compiling module");
+        }
+    }
 
+    void GenerateMachineCode(llvm::raw_ostream& os, llvm::Module& module, ModuleOutputFormat outputFormat, const MachineCodeOutputOptions& ellOptions)
+    {
         llvm::LLVMContext context;
         context.setDiscardValueNames(false); // Don't throw away names of non-global values
 
@@ -210,11 +223,52 @@ namespace emitters
             // Write memory buffer to our output stream
             os << buffer;
         }
+    }
 
+    std::map<std::string, size_t> GetFunctionCodeSizes(IRModuleEmitter& moduleEmitter, const MachineCodeOutputOptions& options)
+    {
+        // Code generation changes the IR, so compile a copy of the module
+        auto module = llvm::CloneModule(*moduleEmitter.GetLLVMModule());
+        llvm::SmallVector<char, 0> buffer;
+        llvm::raw_svector_ostream stream(buffer);
+        GenerateMachineCode(stream, *module, ModuleOutputFormat::objectCode, options);
         if (moduleEmitter.GetDiagnosticHandler().HadError())
         {
             throw EmitterException(EmitterError::unexpected, "Error compiling module");
         }
+
+        auto objectFile = llvm::object::ObjectFile::createObjectFile(llvm::MemoryBufferRef(llvm::StringRef(buffer.data(), buffer.size()), module->getModuleIdentifier()));
+        if (!objectFile)
+        {
+            llvm::consumeError(objectFile.takeError());
+            throw EmitterException(EmitterError::unexpected, "Unable to read the generated object code");
+        }
+
+        std::map<std::string, size_t> sizes;
+        for (const auto& [symbol, size] : llvm::object::computeSymbolSizes(*objectFile.get()))
+        {
+            auto type = symbol.getType();
+            auto name = symbol.getName();
+            if (!type || !name)
+            {
+                llvm::consumeError(type.takeError());
+                llvm::consumeError(name.takeError());
+                continue;
+            }
+            if (type.get() != llvm::object::SymbolRef::ST_Function)
+            {
+                continue;
+            }
+
+            // Some object formats prefix symbol names with an underscore
+            std::string functionName = name.get().str();
+            if (module->getFunction(functionName) == nullptr && functionName.size() > 1 && functionName[0] == '_')
+            {
+                functionName = functionName.substr(1);
+            }
+            sizes[functionName] += size;
+        }
+        return sizes;
     }
 } // namespace emitters
 } // namespace ell
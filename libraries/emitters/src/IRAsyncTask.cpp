@@ -8,6 +8,7 @@
 
 #include "IRAsyncTask.h"
 #include "IRFunctionEmitter.h"
+#include "IRModuleEmitter.h"
 #include "IRThreadUtilities.h"
 
 #include <utilities/include/Exception.h>
@@ -108,5 +109,71 @@ namespace emitters
             task.Wait(function);
         }
     }
+
+    //
+    // IRBackgroundTask
+    //
+    IRBackgroundTask::IRBackgroundTask(IRModuleEmitter& module, const std::string& name, LLVMFunction taskFunction) :
+        _taskFunction(taskFunction)
+    {
+        const auto& compilerParameters = module.GetCompilerOptions();
+        _usePthreads = compilerParameters.parallelize && !compilerParameters.targetDevice.IsWindows();
+        _isRunning = module.Global<int>(name + "_isRunning", 0);
+        if (_usePthreads)
+        {
+            _pthread = module.Global(module.GetRuntime().GetPosixEmitter().GetPthreadType(), name + "_thread");
+            _taskArg = module.Global(GetTaskArgStructType(module, taskFunction), name + "_taskArg");
+
+            // Resetting the model waits for the running instance of the task, so no thread outlives the model's use
+            auto& resetFunction = module.BeginResetFunction(name + "_Reset");
+            Wait(resetFunction);
+            module.EndResetFunction();
+        }
+    }
+
+    void IRBackgroundTask::Start(IRFunctionEmitter& function, const std::vector<LLVMValue>& arguments)
+    {
+        if (!UsePthreads())
+        {
+            function.Call(_taskFunction, arguments);
+            return;
+        }
+
+        Wait(function);
+
+        // The argument struct is a global, because the task reads it after this function may have returned
+        auto int8PtrType = llvm::Type::getInt8PtrTy(function.GetLLVMContext());
+        function.FillStruct(_taskArg, arguments);
+        auto pthreadWrapperFunction = GetTaskWrapperFunction(function.GetModule(), _taskFunction);
+        auto errCode = function.PthreadCreate(_pthread, function.NullPointer(int8PtrType), pthreadWrapperFunction, function.CastPointer(_taskArg, int8PtrType));
+
+        // If no thread could be started, run the task synchronously instead, and don't join a thread that doesn't exist
+        function.If(function.Comparison(TypedComparison::equals, errCode, function.Literal<int>(0)), [this](IRFunctionEmitter& function) {
+            function.Store(_isRunning, function.Literal<int>(1));
+        }).Else([this, &arguments](IRFunctionEmitter& function) {
+            function.Call(_taskFunction, arguments);
+        });
+    }
+
+    void IRBackgroundTask::Wait(IRFunctionEmitter& function)
+    {
+        if (!UsePthreads())
+        {
+            return;
+        }
+
+        function.If(TypedComparison::notEquals, function.Load(_isRunning), function.Literal<int>(0), [this](IRFunctionEmitter& function) {
+            auto int8PtrType = llvm::Type::getInt8PtrTy(function.GetLLVMContext());
+            auto returnValuePtr = function.Variable(int8PtrType, "returnValue");
+            auto errCode = function.PthreadJoin(function.Load(_pthread), returnValuePtr);
+            UNUSED(errCode);
+            function.Store(_isRunning, function.Literal<int>(0));
+        });
+    }
+
+    LLVMValue IRBackgroundTask::IsRunning(IRFunctionEmitter& function)
+    {
+        return function.Load(_isRunning);
+    }
 } // namespace emitters
 } // namespace ell
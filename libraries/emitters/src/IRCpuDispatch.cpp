@@ -0,0 +1,243 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRCpuDispatch.cpp (emitters)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IRCpuDispatch.h"
+#include "EmitterException.h"
+#include "IRMetadata.h"
+#include "IRModuleEmitter.h"
+#include "LLVMInclude.h"
+
+#include <llvm/ADT/Triple.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/InlineAsm.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ValueMapper.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace emitters
+{
+    namespace
+    {
+        struct CpuLevel
+        {
+            std::string name;
+            std::string features;
+        };
+
+        // The known levels, from lowest to highest
+        const std::vector<CpuLevel>& GetKnownLevels()
+        {
+            static const std::vector<CpuLevel> levels = {
+                { "sse4.2", "+sse4.2,+popcnt" },
+                { "avx2", "+avx2,+fma" },
+                { "avx512", "+avx2,+fma,+avx512f,+avx512dq,+avx512bw,+avx512vl" }
+            };
+            return levels;
+        }
+
+        std::vector<size_t> GetLevelIndices(const std::vector<std::string>& levels)
+        {
+            const auto& knownLevels = GetKnownLevels();
+            std::vector<size_t> indices;
+            for (const auto& level : levels)
+            {
+                auto it = std::find_if(knownLevels.begin(), knownLevels.end(), [&level](const CpuLevel& knownLevel) { return knownLevel.name == level; });
+                if (it == knownLevels.end())
+                {
+                    throw EmitterException(EmitterError::notSupported, "Unknown CPU dispatch level '" + level + "' (expected sse4.2, avx2 or avx512)");
+                }
+                indices.push_back(static_cast<size_t>(it - knownLevels.begin()));
+            }
+            std::sort(indices.begin(), indices.end());
+            indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+            return indices;
+        }
+
+        std::string GetFunctionSuffix(const std::string& levelName)
+        {
+            auto suffix = levelName;
+            std::replace(suffix.begin(), suffix.end(), '.', '_');
+            return suffix;
+        }
+
+        llvm::Value* EmitCpuid(llvm::IRBuilder<>& builder, int leaf, int subleaf)
+        {
+            auto int32Type = builder.getInt32Ty();
+            auto resultType = llvm::StructType::get(builder.getContext(), { int32Type, int32Type, int32Type, int32Type });
+            auto asmType = llvm::FunctionType::get(resultType, { int32Type, int32Type }, false);
+            auto cpuid = llvm::InlineAsm::get(asmType, "cpuid", "={ax},={bx},={cx},={dx},{ax},{cx},~{dirflag},~{fpsr},~{flags}", false);
+            return builder.CreateCall(cpuid, { builder.getInt32(leaf), builder.getInt32(subleaf) });
+        }
+
+        // Reads the low word of XCR0, which tells which register states the OS saves. `xgetbv` is written as bytes,
+        // because the assembler only accepts the mnemonic for targets with the xsave feature.
+        llvm::Value* EmitReadXcr0(llvm::IRBuilder<>& builder)
+        {
+            auto int32Type = builder.getInt32Ty();
+            auto resultType = llvm::StructType::get(builder.getContext(), { int32Type, int32Type });
+            auto asmType = llvm::FunctionType::get(resultType, { int32Type }, false);
+            auto xgetbv = llvm::InlineAsm::get(asmType, ".byte 0x0f, 0x01, 0xd0", "={ax},={dx},{cx},~{dirflag},~{fpsr},~{flags}", true);
+            return builder.CreateExtractValue(builder.CreateCall(xgetbv, { builder.getInt32(0) }), 0);
+        }
+
+        llvm::Value* HasBits(llvm::IRBuilder<>& builder, llvm::Value* value, uint32_t bits)
+        {
+            return builder.CreateICmpEQ(builder.CreateAnd(value, builder.getInt32(bits)), builder.getInt32(bits));
+        }
+
+        // Emits a function that returns the position + 1 of the highest of the given levels the CPU supports, or 0
+        // if it supports none of them. The CPU is only checked the first time.
+        llvm::Function* EmitGetCpuLevelFunction(llvm::Module& module, const std::vector<size_t>& levelIndices)
+        {
+            auto& context = module.getContext();
+            auto int32Type = llvm::Type::getInt32Ty(context);
+            auto cachedLevel = new llvm::GlobalVariable(module, int32Type, false, llvm::GlobalValue::InternalLinkage, llvm::ConstantInt::get(int32Type, -1), "cpuDispatchLevel");
+            auto function = llvm::Function::Create(llvm::FunctionType::get(int32Type, false), llvm::GlobalValue::InternalLinkage, "GetCpuDispatchLevel", &module);
+
+            auto entryBlock = llvm::BasicBlock::Create(context, "entry", function);
+            auto cachedBlock = llvm::BasicBlock::Create(context, "cached", function);
+            auto detectBlock = llvm::BasicBlock::Create(context, "detect", function);
+            auto readXcr0Block = llvm::BasicBlock::Create(context, "readXcr0", function);
+            auto selectBlock = llvm::BasicBlock::Create(context, "select", function);
+            llvm::IRBuilder<> builder(entryBlock);
+
+            // Several threads may check the CPU at once, but they all store the same result
+            auto cached = builder.CreateAlignedLoad(cachedLevel, 4);
+            cached->setAtomic(llvm::AtomicOrdering::Monotonic);
+            builder.CreateCondBr(builder.CreateICmpSGE(cached, builder.getInt32(0)), cachedBlock, detectBlock);
+
+            builder.SetInsertPoint(cachedBlock);
+            builder.CreateRet(cached);
+
+            builder.SetInsertPoint(detectBlock);
+            auto maxLeaf = builder.CreateExtractValue(EmitCpuid(builder, 0, 0), 0);
+            auto ecx1 = builder.CreateExtractValue(EmitCpuid(builder, 1, 0), 2);
+            auto ebx7 = builder.CreateSelect(builder.CreateICmpUGE(maxLeaf, builder.getInt32(7)), builder.CreateExtractValue(EmitCpuid(builder, 7, 0), 1), builder.getInt32(0));
+            // `xgetbv` faults unless the OS has enabled it (OSXSAVE)
+            builder.CreateCondBr(HasBits(builder, ecx1, 1u << 27), readXcr0Block, selectBlock);
+
+            builder.SetInsertPoint(readXcr0Block);
+            auto xcr0Value = EmitReadXcr0(builder);
+            builder.CreateBr(selectBlock);
+
+            builder.SetInsertPoint(selectBlock);
+            auto xcr0 = builder.CreatePHI(int32Type, 2);
+            xcr0->addIncoming(builder.getInt32(0), detectBlock);
+            xcr0->addIncoming(xcr0Value, readXcr0Block);
+
+            // SSE4.2 and POPCNT; AVX2 and FMA with the SSE and AVX state enabled; AVX-512 F, DQ, BW and VL with the opmask and ZMM state enabled
+            auto hasSse42 = HasBits(builder, ecx1, (1u << 20) | (1u << 23));
+            auto hasAvx2 = builder.CreateAnd(builder.CreateAnd(HasBits(builder, ecx1, (1u << 12) | (1u << 28)), HasBits(builder, xcr0, 0x6)), HasBits(builder, ebx7, 1u << 5));
+            auto hasAvx512 = builder.CreateAnd(builder.CreateAnd(hasAvx2, HasBits(builder, xcr0, 0xe6)), HasBits(builder, ebx7, (1u << 16) | (1u << 17) | (1u << 30) | (1u << 31)));
+            const std::vector<llvm::Value*> supported = { hasSse42, hasAvx2, hasAvx512 };
+
+            llvm::Value* level = builder.getInt32(0);
+            for (size_t position = 0; position < levelIndices.size(); ++position)
+            {
+                level = builder.CreateSelect(supported[levelIndices[position]], builder.getInt32(static_cast<uint32_t>(position + 1)), level);
+            }
+            auto store = builder.CreateAlignedStore(level, cachedLevel, 4);
+            store->setAtomic(llvm::AtomicOrdering::Monotonic);
+            builder.CreateRet(level);
+            return function;
+        }
+    } // namespace
+
+    bool SupportsCpuDispatch(const std::string& triple)
+    {
+        return llvm::Triple(triple).getArch() == llvm::Triple::x86_64;
+    }
+
+    void EmitCpuDispatch(IRModuleEmitter& module, const std::string& tag, const std::vector<std::string>& levels)
+    {
+        const auto levelIndices = GetLevelIndices(levels);
+        auto functions = GetFunctionsWithTag(module, tag);
+        if (levelIndices.empty() || functions.empty())
+        {
+            return;
+        }
+
+        auto& context = module.GetLLVMContext();
+        auto llvmModule = module.GetLLVMModule();
+        const auto baseFeatures = module.GetCompilerOptions().targetDevice.features;
+        const auto& knownLevels = GetKnownLevels();
+        auto getLevel = EmitGetCpuLevelFunction(*llvmModule, levelIndices);
+
+        for (auto& functionInfo : functions)
+        {
+            auto function = functionInfo.function;
+            function->setMetadata(tag, nullptr);
+            if (function->isDeclaration() || function->isVarArg())
+            {
+                continue;
+            }
+
+            // The versions for the levels are copies of the function that the backend may compile with more
+            // instructions. Later features override earlier ones, so the target's own features can be kept.
+            const auto name = function->getName().str();
+            std::vector<llvm::Function*> versions = { function };
+            for (auto index : levelIndices)
+            {
+                llvm::ValueToValueMapTy valueMap;
+                auto version = llvm::CloneFunction(function, valueMap);
+                version->setName(name + "_" + GetFunctionSuffix(knownLevels[index].name));
+                version->setLinkage(llvm::GlobalValue::InternalLinkage);
+                const auto& features = knownLevels[index].features;
+                version->addFnAttr("target-features", baseFeatures.empty() ? features : baseFeatures + "," + features);
+                versions.push_back(version);
+            }
+
+            // The dispatcher takes over the function's name and callers, and the function becomes the baseline version
+            auto dispatcher = llvm::Function::Create(function->getFunctionType(), function->getLinkage(), "", llvmModule);
+            dispatcher->copyAttributesFrom(function);
+            function->replaceAllUsesWith(dispatcher);
+            function->setName(name + "_baseline");
+            function->setLinkage(llvm::GlobalValue::InternalLinkage);
+            dispatcher->setName(name);
+
+            std::vector<llvm::Value*> arguments;
+            for (auto& argument : dispatcher->args())
+            {
+                arguments.push_back(&argument);
+            }
+
+            llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", dispatcher));
+            auto level = builder.CreateCall(getLevel);
+            std::vector<llvm::BasicBlock*> blocks;
+            for (size_t position = 0; position < versions.size(); ++position)
+            {
+                auto block = llvm::BasicBlock::Create(context, "level" + std::to_string(position), dispatcher);
+                llvm::IRBuilder<> blockBuilder(block);
+                auto call = blockBuilder.CreateCall(versions[position], arguments);
+                call->setCallingConv(versions[position]->getCallingConv());
+                if (call->getType()->isVoidTy())
+                {
+                    blockBuilder.CreateRetVoid();
+                }
+                else
+                {
+                    blockBuilder.CreateRet(call);
+                }
+                blocks.push_back(block);
+            }
+
+            auto levelSwitch = builder.CreateSwitch(level, blocks[0], static_cast<unsigned>(versions.size() - 1));
+            for (size_t position = 1; position < versions.size(); ++position)
+            {
+                levelSwitch->addCase(builder.getInt32(static_cast<uint32_t>(position)), blocks[position]);
+            }
+        }
+    }
+} // namespace emitters
+} // namespace ell
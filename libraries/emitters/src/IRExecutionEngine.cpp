@@ -7,12 +7,26 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "IRExecutionEngine.h"
+#include "IRMetadata.h"
 #include "IRModuleEmitter.h"
 
+#include <runtime/include/GpuRuntime.h>
+#include <runtime/include/SharedRuntime.h>
+
+#include <utilities/include/PhaseTimer.h>
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/TargetSelect.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace ell
 {
@@ -24,6 +38,117 @@ namespace emitters
         throw emitters::EmitterException(emitters::EmitterError::unexpected, msg);
     }
 
+    // The modules holding lazily-compiled functions, keyed by function name. A module is handed to the engine
+    // the first time its function is called.
+    struct IRExecutionEngine::LazyFunctions
+    {
+        std::mutex mutex;
+        llvm::ExecutionEngine* engine = nullptr;
+        std::unordered_map<std::string, std::unique_ptr<llvm::Module>> modules;
+        size_t numFunctions = 0;
+        size_t numCompiled = 0;
+    };
+
+    namespace
+    {
+        const char* c_resolveLazyFunctionName = "ell_ResolveLazyFunction";
+        const char* c_lazyImplementationSuffix = "_lazy";
+
+        // The functions of the ELL runtime library that models compiled with `useSharedRuntime` or `useGpu` call. Jitted
+        // models are bound to the copy linked into this process, so they share its thread pool and device state.
+        void AddSharedRuntimeMappings(llvm::ExecutionEngine& engine)
+        {
+            engine.addGlobalMapping("ell_runtime_StartTasks", reinterpret_cast<uint64_t>(&ell_runtime_StartTasks));
+            engine.addGlobalMapping("ell_runtime_WaitTasks", reinterpret_cast<uint64_t>(&ell_runtime_WaitTasks));
+            engine.addGlobalMapping("ell_runtime_SetBlasThreadsForCall", reinterpret_cast<uint64_t>(&ell_runtime_SetBlasThreadsForCall));
+            engine.addGlobalMapping("ell_runtime_RegisterProfiler", reinterpret_cast<uint64_t>(&ell_runtime_RegisterProfiler));
+            engine.addGlobalMapping("ell_runtime_UnregisterProfiler", reinterpret_cast<uint64_t>(&ell_runtime_UnregisterProfiler));
+            engine.addGlobalMapping("ell_runtime_GpuBeginModule", reinterpret_cast<uint64_t>(&ell_runtime_GpuBeginModule));
+            engine.addGlobalMapping("ell_runtime_GpuEndModule", reinterpret_cast<uint64_t>(&ell_runtime_GpuEndModule));
+            engine.addGlobalMapping("ell_runtime_GpuSgemm", reinterpret_cast<uint64_t>(&ell_runtime_GpuSgemm));
+            engine.addGlobalMapping("ell_runtime_GpuDgemm", reinterpret_cast<uint64_t>(&ell_runtime_GpuDgemm));
+        }
+
+        // Returns true if the value is only used (directly, or through constant expressions) by the given function
+        bool IsUsedOnlyBy(const llvm::Value& value, const llvm::Function* function)
+        {
+            for (auto user : value.users())
+            {
+                if (auto instruction = llvm::dyn_cast<llvm::Instruction>(user))
+                {
+                    if (instruction->getFunction() != function)
+                    {
+                        return false;
+                    }
+                }
+                else if (!llvm::isa<llvm::ConstantExpr>(user) || !IsUsedOnlyBy(*user, function))
+                {
+                    return false;
+                }
+            }
+            return !value.use_empty();
+        }
+
+        // Makes a stub with the function's name and callers, which calls through a pointer that the resolver fills in the first time
+        void ReplaceWithStub(llvm::Function* function, llvm::Constant* lazyFunctionsPtr)
+        {
+            auto& context = function->getContext();
+            auto module = function->getParent();
+            const auto name = function->getName().str();
+            auto functionPtrType = function->getFunctionType()->getPointerTo();
+            auto bytePtrType = llvm::Type::getInt8PtrTy(context);
+            auto resolverType = llvm::FunctionType::get(bytePtrType, { bytePtrType, bytePtrType }, false);
+            auto resolver = module->getOrInsertFunction(c_resolveLazyFunctionName, resolverType);
+
+            auto address = new llvm::GlobalVariable(*module, functionPtrType, false, llvm::GlobalValue::InternalLinkage, llvm::ConstantPointerNull::get(functionPtrType), name + "_lazyAddress");
+            auto alignment = module->getDataLayout().getPointerABIAlignment(0);
+
+            auto stub = llvm::Function::Create(function->getFunctionType(), function->getLinkage(), "", module);
+            stub->copyAttributesFrom(function);
+            stub->removeFnAttr(llvm::Attribute::NoInline);
+            function->replaceAllUsesWith(stub);
+            stub->takeName(function);
+
+            auto entryBlock = llvm::BasicBlock::Create(context, "entry", stub);
+            auto resolveBlock = llvm::BasicBlock::Create(context, "resolve", stub);
+            auto callBlock = llvm::BasicBlock::Create(context, "call", stub);
+
+            llvm::IRBuilder<> builder(entryBlock);
+            auto currentAddress = builder.CreateLoad(functionPtrType, address);
+            currentAddress->setAtomic(llvm::AtomicOrdering::Acquire);
+            currentAddress->setAlignment(alignment);
+            builder.CreateCondBr(builder.CreateIsNull(currentAddress), resolveBlock, callBlock);
+
+            builder.SetInsertPoint(resolveBlock);
+            auto nameString = builder.CreateGlobalStringPtr(name);
+            auto resolvedAddress = builder.CreatePointerCast(builder.CreateCall(resolver, { lazyFunctionsPtr, nameString }), functionPtrType);
+            auto store = builder.CreateStore(resolvedAddress, address);
+            store->setAtomic(llvm::AtomicOrdering::Release);
+            store->setAlignment(alignment);
+            builder.CreateBr(callBlock);
+
+            builder.SetInsertPoint(callBlock);
+            auto target = builder.CreatePHI(functionPtrType, 2);
+            target->addIncoming(currentAddress, entryBlock);
+            target->addIncoming(resolvedAddress, resolveBlock);
+            std::vector<llvm::Value*> arguments;
+            for (auto& argument : stub->args())
+            {
+                arguments.push_back(&argument);
+            }
+            auto call = builder.CreateCall(function->getFunctionType(), target, arguments);
+            call->setCallingConv(function->getCallingConv());
+            if (call->getType()->isVoidTy())
+            {
+                builder.CreateRetVoid();
+            }
+            else
+            {
+                builder.CreateRet(call);
+            }
+        }
+    } // namespace
+
     IRExecutionEngine::IRExecutionEngine(IRModuleEmitter&& module, bool verify) :
         IRExecutionEngine(module.TransferOwnership(), verify)
     {
@@ -34,6 +159,7 @@ namespace emitters
         llvm::InitializeNativeTarget();
         llvm::InitializeNativeTargetAsmPrinter();
 
+        DeferLazyFunctions(*pModule);
         _pBuilder = std::make_unique<llvm::EngineBuilder>(std::move(pModule));
         _pBuilder->setEngineKind(llvm::EngineKind::JIT).setVerifyModules(verify).setUseOrcMCJITReplacement(false);
 
@@ -54,6 +180,15 @@ namespace emitters
         }
     }
 
+    void IRExecutionEngine::SetCodeGenerationLevel(llvm::CodeGenOpt::Level level)
+    {
+        if (_pEngine)
+        {
+            throw EmitterException(EmitterError::unexpected, "Can't change the code generation level after code has been generated");
+        }
+        _pBuilder->setOptLevel(level);
+    }
+
     void IRExecutionEngine::AddModule(std::unique_ptr<llvm::Module> pModule)
     {
         assert(pModule != nullptr);
@@ -61,6 +196,19 @@ namespace emitters
         _pEngine->addModule(std::move(pModule));
     }
 
+    void IRExecutionEngine::AddObjectFile(const std::string& objectCode)
+    {
+        EnsureEngine();
+        auto buffer = llvm::MemoryBuffer::getMemBufferCopy(objectCode);
+        auto objectFile = llvm::object::ObjectFile::createObjectFile(buffer->getMemBufferRef());
+        if (!objectFile)
+        {
+            llvm::consumeError(objectFile.takeError());
+            throw EmitterException(EmitterError::unexpected, "Unable to load object code");
+        }
+        _pEngine->addObjectFile(llvm::object::OwningBinary<llvm::object::ObjectFile>(std::move(objectFile.get()), std::move(buffer)));
+    }
+
     void IRExecutionEngine::PerformInitialization()
     {
         _pEngine->runStaticConstructorsDestructors(false);
@@ -74,6 +222,7 @@ namespace emitters
     uint64_t IRExecutionEngine::GetFunctionAddress(const std::string& name)
     {
         EnsureEngine();
+        utilities::PhaseTimer timer("JIT finalize"); // the engine generates code for a module the first time it's asked for an address in it
         return _pEngine->getFunctionAddress(name);
     }
 
@@ -121,12 +270,146 @@ namespace emitters
         mainFunction();
     }
 
+    size_t IRExecutionEngine::NumLazyFunctions() const
+    {
+        if (!_lazyFunctions)
+        {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(_lazyFunctions->mutex);
+        return _lazyFunctions->numFunctions;
+    }
+
+    size_t IRExecutionEngine::NumCompiledLazyFunctions() const
+    {
+        if (!_lazyFunctions)
+        {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(_lazyFunctions->mutex);
+        return _lazyFunctions->numCompiled;
+    }
+
+    void* IRExecutionEngine::ResolveLazyFunction(void* lazyFunctionsPtr, const char* name)
+    {
+        // Called by the stub of a lazily-compiled function, to compile it and get its address
+        auto lazyFunctions = static_cast<LazyFunctions*>(lazyFunctionsPtr);
+        std::lock_guard<std::mutex> lock(lazyFunctions->mutex);
+        auto& module = lazyFunctions->modules[name];
+        if (module)
+        {
+            lazyFunctions->engine->addModule(std::move(module));
+            ++lazyFunctions->numCompiled;
+        }
+        return reinterpret_cast<void*>(lazyFunctions->engine->getFunctionAddress(std::string(name) + c_lazyImplementationSuffix));
+    }
+
+    void IRExecutionEngine::DeferLazyFunctions(llvm::Module& module)
+    {
+        std::vector<llvm::Function*> functions;
+        for (auto& function : module)
+        {
+            if (!function.isDeclaration() && !function.isVarArg() && function.getMetadata(c_lazyFunctionTagName) != nullptr)
+            {
+                functions.push_back(&function);
+            }
+        }
+        if (functions.empty())
+        {
+            return;
+        }
+
+        // Symbols local to the module are made visible to the modules compiled later
+        for (auto& value : module.global_values())
+        {
+            if (value.hasLocalLinkage())
+            {
+                if (!value.hasName())
+                {
+                    value.setName("ell_lazy_local");
+                }
+                value.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            }
+        }
+
+        _lazyFunctions = std::make_unique<LazyFunctions>();
+        auto& context = module.getContext();
+        auto lazyFunctionsPtr = llvm::ConstantExpr::getIntToPtr(llvm::ConstantInt::get(llvm::Type::getInt64Ty(context), reinterpret_cast<uint64_t>(_lazyFunctions.get())), llvm::Type::getInt8PtrTy(context));
+        for (auto function : functions)
+        {
+            // The function's own module gets its body, and the global variables nothing else uses
+            const auto name = function->getName().str();
+            std::vector<llvm::GlobalVariable*> movedVariables;
+            std::unordered_set<const llvm::GlobalValue*> movedValues = { function };
+            for (auto& variable : module.globals())
+            {
+                if (variable.hasInitializer() && IsUsedOnlyBy(variable, function))
+                {
+                    movedVariables.push_back(&variable);
+                    movedValues.insert(&variable);
+                }
+            }
+
+            llvm::ValueToValueMapTy valueMap;
+            auto lazyModule = llvm::CloneModule(module, valueMap, [&](const llvm::GlobalValue* value) {
+                return movedValues.count(value) != 0;
+            });
+
+            // The main module keeps its named metadata and appending globals (like llvm.global_ctors), which would otherwise run twice
+            std::vector<llvm::NamedMDNode*> namedMetadata;
+            for (auto& node : lazyModule->named_metadata())
+            {
+                if (node.getName() != "llvm.module.flags")
+                {
+                    namedMetadata.push_back(&node);
+                }
+            }
+            for (auto node : namedMetadata)
+            {
+                node->eraseFromParent();
+            }
+            std::vector<llvm::GlobalVariable*> appendingGlobals;
+            for (auto& global : lazyModule->globals())
+            {
+                if (global.hasAppendingLinkage())
+                {
+                    appendingGlobals.push_back(&global);
+                }
+            }
+            for (auto global : appendingGlobals)
+            {
+                global->eraseFromParent();
+            }
+
+            auto implementation = lazyModule->getFunction(name);
+            implementation->setName(name + c_lazyImplementationSuffix);
+            implementation->setMetadata(c_lazyFunctionTagName, nullptr);
+            _lazyFunctions->modules[name] = std::move(lazyModule);
+
+            ReplaceWithStub(function, lazyFunctionsPtr);
+            function->eraseFromParent();
+            for (auto variable : movedVariables)
+            {
+                variable->removeDeadConstantUsers();
+                variable->eraseFromParent();
+            }
+        }
+        _lazyFunctions->numFunctions = functions.size();
+    }
+
     void IRExecutionEngine::EnsureEngine()
     {
         if (!_pEngine)
         {
+            utilities::PhaseTimer timer("JIT create engine");
             auto pEngine = _pBuilder->create();
             _pEngine.reset(pEngine);
+            AddSharedRuntimeMappings(*_pEngine);
+            if (_lazyFunctions)
+            {
+                _lazyFunctions->engine = _pEngine.get();
+                _pEngine->addGlobalMapping(c_resolveLazyFunctionName, reinterpret_cast<uint64_t>(&ResolveLazyFunction));
+            }
             PerformInitialization();
         }
     }
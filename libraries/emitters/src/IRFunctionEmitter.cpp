@@ -8,20 +8,28 @@
 
 #include "IRFunctionEmitter.h"
 #include "EmitterException.h"
+#include "GemmTileSizes.h"
 #include "IRAsyncTask.h"
 #include "IRBlockRegion.h"
 #include "IREmitter.h"
+#include "IRMath.h"
 #include "IRMetadata.h"
 #include "IRModuleEmitter.h"
 #include "IRParallelLoopEmitter.h"
 #include "IRThreadPool.h"
+#include "IRVectorUtilities.h"
 #include "LLVMUtilities.h"
 
+#include <math/include/BlasWrapper.h>
+
+#include <runtime/include/GpuRuntime.h>
+
 #include <utilities/include/Logger.h>
 
 #include <llvm/IR/Verifier.h>
 #include <llvm/Support/raw_os_ostream.h>
 
+#include <algorithm>
 #include <sstream>
 
 namespace ell
@@ -38,6 +46,88 @@ namespace emitters
     // Internal codes
     namespace
     {
+        template <typename ValueType>
+        LLVMValue EmitMultiAccumulatorDotProduct(IRFunctionEmitter& function, int size, LLVMValue pLeftValue, LLVMValue pRightValue)
+        {
+            const int vectorSize = GetReductionVectorSize(function.GetCompilerOptions());
+            constexpr int numAccumulators = 4;
+            return EmitVectorizedSum<ValueType>(function, size, vectorSize, numAccumulators, [pLeftValue, pRightValue](IRFunctionEmitter& function, LLVMValue index, int width) {
+                // Long dot products, like the rows of a matrix-vector product, stream both operands from memory
+                function.PrefetchAhead(pLeftValue, index);
+                function.PrefetchAhead(pRightValue, index);
+                auto left = width == 1 ? function.ValueAt(pLeftValue, index) : LoadUnalignedVector<ValueType>(function, pLeftValue, index, width);
+                auto right = width == 1 ? function.ValueAt(pRightValue, index) : LoadUnalignedVector<ValueType>(function, pRightValue, index, width);
+                return function.Operator(GetMultiplyForValueType<ValueType>(), left, right);
+            });
+        }
+
+        // Returns the type of the entries of an array, given a pointer to its first entry or to the whole array
+        LLVMType GetArrayEntryType(LLVMValue pArray)
+        {
+            auto type = pArray->getType()->getPointerElementType();
+            return type->isArrayTy() ? type->getArrayElementType() : type;
+        }
+
+        // Widens reduced-precision weights, given as a 16-bit integer or a vector of them, to single precision. It's done
+        // with integer operations, so targets without half-precision conversion instructions don't need a runtime library call.
+        LLVMValue DecodeWeightBits(IRFunctionEmitter& function, LLVMValue weightBits, bool isHalf)
+        {
+            auto& emitter = function.GetEmitter();
+            auto& builder = emitter.GetIRBuilder();
+            auto vectorType = llvm::dyn_cast<llvm::VectorType>(weightBits->getType());
+            LLVMType int32Type = vectorType == nullptr ? emitter.Type(VariableType::Int32) : emitter.VectorType(VariableType::Int32, vectorType->getNumElements());
+            LLVMType floatType = vectorType == nullptr ? emitter.Type(VariableType::Float) : emitter.VectorType(VariableType::Float, vectorType->getNumElements());
+            auto constant = [int32Type](uint32_t value) { return llvm::ConstantInt::get(int32Type, value); };
+
+            auto bits = builder.CreateZExt(weightBits, int32Type);
+            if (!isHalf)
+            {
+                // bfloat16 is the upper half of a single-precision value
+                return builder.CreateBitCast(builder.CreateShl(bits, constant(16)), floatType);
+            }
+
+            // Moving the exponent and mantissa into place and rescaling by 2^(127 - 15) handles subnormal values too
+            auto sign = builder.CreateShl(builder.CreateAnd(bits, constant(0x8000)), constant(16));
+            auto magnitudeBits = builder.CreateShl(builder.CreateAnd(bits, constant(0x7fff)), constant(13));
+            auto magnitude = builder.CreateFMul(builder.CreateBitCast(magnitudeBits, floatType), llvm::ConstantFP::get(floatType, 0x1p112));
+            return builder.CreateBitCast(builder.CreateOr(builder.CreateBitCast(magnitude, int32Type), sign), floatType);
+        }
+
+        // Checks that weights stored as `storedType` can be read as `valueType`, and returns whether they're half precision (as opposed to bfloat16)
+        bool IsHalfPrecisionWeightType(LLVMType storedType, LLVMType valueType)
+        {
+            const bool isHalf = storedType->isHalfTy();
+            const bool isBFloat16 = storedType->isIntegerTy(16) && valueType->isFloatingPointTy();
+            if (!isHalf && !isBFloat16)
+            {
+                throw EmitterException(EmitterError::castNotSupported, "Unsupported weight storage type");
+            }
+            return isHalf;
+        }
+
+        // The dot product of an array with reduced-precision weights. The weights are widened a vector at a time, and
+        // summed like DotProduct sums: with several vector accumulators if fast math allows reassociating, otherwise in order.
+        template <typename ValueType>
+        LLVMValue EmitWeightsDotProduct(IRFunctionEmitter& function, int size, LLVMValue pValues, LLVMValue pWeights, bool isHalf)
+        {
+            const bool reassociate = function.GetCompilerOptions().useFastMath;
+            const int vectorSize = reassociate ? GetReductionVectorSize(function.GetCompilerOptions()) : 1;
+            const int numAccumulators = reassociate ? 4 : 1;
+            auto pWeightBits = function.CastPointer(pWeights, VariableType::Int16Pointer);
+            return EmitVectorizedSum<ValueType>(function, size, vectorSize, numAccumulators, [pValues, pWeightBits, isHalf](IRFunctionEmitter& function, LLVMValue index, int width) {
+                function.PrefetchAhead(pValues, index);
+                function.PrefetchAhead(pWeightBits, index);
+                auto values = width == 1 ? function.ValueAt(pValues, index) : LoadUnalignedVector<ValueType>(function, pValues, index, width);
+                auto weightBits = width == 1 ? function.ValueAt(pWeightBits, index) : LoadUnalignedVector<short>(function, pWeightBits, index, width);
+                LLVMValue weights = DecodeWeightBits(function, weightBits, isHalf);
+                if constexpr (std::is_same_v<ValueType, double>)
+                {
+                    weights = function.GetEmitter().GetIRBuilder().CreateFPExt(weights, values->getType());
+                }
+                return function.Operator(TypedOperator::multiplyFloat, values, weights);
+            });
+        }
+
         // Helper function for recursive function
         void MultiDimFor(IRFunctionEmitter& function, std::vector<IRFunctionEmitter::ConstLoopRange> ranges, std::vector<IRLocalScalar> prevIndices, IRFunctionEmitter::MultiDimForLoopBodyFunction body)
         {
@@ -114,6 +204,253 @@ namespace emitters
             }
         }
 
+        // Emits C = A * B for row-major matrices, without calling BLAS. The output is computed one (mc x nc) block at a
+        // time, in parallel. Each block packs kc-deep slices of A and B into contiguous, zero-padded buffers and multiplies
+        // them one (mr x nr) register tile at a time, with the tile's partial sums held in scalar variables so that
+        // they're promoted to registers. An operand packed at compile time (by PackGemmLeftOperand or
+        // PackGemmRightOperand) is passed as prepackedA or prepackedB, and is read in place instead.
+        template <typename ValueType>
+        void EmitBlockedGEMM(IRFunctionEmitter& function, bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, LLVMValue B, int ldb, LLVMValue C, int ldc, LLVMValue prepackedA = nullptr, LLVMValue prepackedB = nullptr)
+        {
+            const auto tiles = GetGemmTileSizes(function.GetCompilerOptions(), static_cast<int>(sizeof(ValueType)), m, n, k);
+            const int mr = tiles.mr;
+            const int nr = tiles.nr;
+            const int kc = tiles.kc;
+            const int mc = tiles.mc;
+            const int nc = tiles.nc;
+            const int numRowBlocks = (m + mc - 1) / mc;
+            const int numColumnBlocks = (n + nc - 1) / nc;
+            const int numSlices = (k + kc - 1) / kc;
+            const auto valueType = GetVariableType<ValueType>();
+
+            // Globals lose their array type when they're passed to a task function, so capture plain pointers
+            std::vector<LLVMValue> matrices = { function.PointerOffset(A, 0), function.PointerOffset(B, 0), function.PointerOffset(C, 0) };
+            const auto prepackedAIndex = static_cast<int>(matrices.size());
+            if (prepackedA != nullptr)
+            {
+                matrices.push_back(function.PointerOffset(prepackedA, 0));
+            }
+            const auto prepackedBIndex = static_cast<int>(matrices.size());
+            if (prepackedB != nullptr)
+            {
+                matrices.push_back(function.PointerOffset(prepackedB, 0));
+            }
+            const bool isAPrepacked = prepackedA != nullptr;
+            const bool isBPrepacked = prepackedB != nullptr;
+            function.ParallelFor(numRowBlocks * numColumnBlocks, matrices, [=](IRFunctionEmitter& function, IRLocalScalar block, const std::vector<LLVMValue>& capturedValues) {
+                auto c = function.LocalArray(capturedValues[2]);
+                auto zero = function.LocalScalar<ValueType>(0);
+                auto rowBlock = block / numColumnBlocks;
+                auto columnBlock = block % numColumnBlocks;
+                auto firstRow = rowBlock * mc;
+                auto firstColumn = columnBlock * nc;
+                auto numRows = Min(function.LocalScalar(m) - firstRow, mc);
+                auto numColumns = Min(function.LocalScalar(n) - firstColumn, nc);
+
+                // packedA holds mc / mr row panels of A, each stored as kc columns of mr elements
+                // packedB holds nc / nr column panels of B, each stored as kc rows of nr elements
+                LLVMValue packBufferA = isAPrepacked ? nullptr : function.Variable(valueType, mc * kc);
+                LLVMValue packBufferB = isBPrepacked ? nullptr : function.Variable(valueType, kc * nc);
+                std::vector<LLVMValue> accumulators;
+                for (int index = 0; index < mr * nr; ++index)
+                {
+                    accumulators.push_back(function.Variable(valueType));
+                }
+
+                // Reads an entry of A or B, or zero if it's outside the matrix. Reduced-precision weights are widened here,
+                // so the packed blocks and the kernel are always full precision.
+                auto getEntry = [=](IRFunctionEmitter& function, LLVMValue matrix, bool transpose, int ld, IRLocalScalar row, IRLocalScalar column, IRLocalScalar isValid) {
+                    auto offset = transpose ? column * ld + row : row * ld + column;
+                    auto safeOffset = function.LocalScalar(function.Select(isValid, offset, function.Literal<int>(0)));
+                    return function.LocalScalar(function.Select(isValid, function.WeightValueAt<ValueType>(matrix, safeOffset), zero));
+                };
+
+                function.For(numRows, [=](IRFunctionEmitter& function, IRLocalScalar i) {
+                    function.For(numColumns, [=](IRFunctionEmitter& function, IRLocalScalar j) {
+                        c[(firstRow + i) * ldc + firstColumn + j] = zero;
+                    });
+                });
+
+                function.For(0, k, kc, [=](IRFunctionEmitter& function, IRLocalScalar pc) {
+                    // The prepacked operands hold the packed slices of every block one after the other
+                    auto slice = pc / kc;
+                    auto packedA = function.LocalArray(isAPrepacked ? function.PointerOffset(capturedValues[prepackedAIndex], (rowBlock * numSlices + slice) * (mc * kc)) : packBufferA);
+                    auto packedB = function.LocalArray(isBPrepacked ? function.PointerOffset(capturedValues[prepackedBIndex], (columnBlock * numSlices + slice) * (kc * nc)) : packBufferB);
+
+                    if (!isBPrepacked)
+                    {
+                        function.For(nc / nr, [=](IRFunctionEmitter& function, IRLocalScalar panel) {
+                            function.For(kc, [=](IRFunctionEmitter& function, IRLocalScalar p) {
+                                for (int j = 0; j < nr; ++j)
+                                {
+                                    auto row = pc + p;
+                                    auto column = firstColumn + panel * nr + j;
+                                    packedB[(panel * kc + p) * nr + j] = getEntry(function, capturedValues[1], transposeB, ldb, row, column, row < k && column < n);
+                                }
+                            });
+                        });
+                    }
+
+                    if (!isAPrepacked)
+                    {
+                        function.For(mc / mr, [=](IRFunctionEmitter& function, IRLocalScalar panel) {
+                            function.For(kc, [=](IRFunctionEmitter& function, IRLocalScalar p) {
+                                for (int i = 0; i < mr; ++i)
+                                {
+                                    auto row = firstRow + panel * mr + i;
+                                    auto column = pc + p;
+                                    packedA[(panel * kc + p) * mr + i] = getEntry(function, capturedValues[0], transposeA, lda, row, column, row < m && column < k);
+                                }
+                            });
+                        });
+                    }
+
+                    function.For((numColumns + (nr - 1)) / nr, [=](IRFunctionEmitter& function, IRLocalScalar jr) {
+                        function.For((numRows + (mr - 1)) / mr, [=](IRFunctionEmitter& function, IRLocalScalar ir) {
+                            for (auto accumulator : accumulators)
+                            {
+                                function.StoreZero(accumulator);
+                            }
+
+                            function.For(kc, [=](IRFunctionEmitter& function, IRLocalScalar p) {
+                                auto aOffset = (ir * kc + p) * mr;
+                                auto bOffset = (jr * kc + p) * nr;
+                                std::vector<IRLocalScalar> aValues;
+                                std::vector<IRLocalScalar> bValues;
+                                for (int i = 0; i < mr; ++i)
+                                {
+                                    aValues.push_back(packedA[aOffset + i]);
+                                }
+                                for (int j = 0; j < nr; ++j)
+                                {
+                                    bValues.push_back(packedB[bOffset + j]);
+                                }
+                                for (int i = 0; i < mr; ++i)
+                                {
+                                    for (int j = 0; j < nr; ++j)
+                                    {
+                                        auto accumulator = accumulators[i * nr + j];
+                                        function.Store(accumulator, function.LocalScalar(function.Load(accumulator)) + aValues[i] * bValues[j]);
+                                    }
+                                }
+                            });
+
+                            // Add the valid part of the register tile to C
+                            for (int i = 0; i < mr; ++i)
+                            {
+                                for (int j = 0; j < nr; ++j)
+                                {
+                                    auto tileRow = ir * mr + i;
+                                    auto tileColumn = jr * nr + j;
+                                    function.If(tileRow < numRows && tileColumn < numColumns, [=](IRFunctionEmitter& function) {
+                                        auto offset = (firstRow + tileRow) * ldc + firstColumn + tileColumn;
+                                        c[offset] = static_cast<IRLocalScalar>(c[offset]) + function.LocalScalar(function.Load(accumulators[i * nr + j]));
+                                    });
+                                }
+                            }
+                        });
+                    });
+                });
+            });
+        }
+
+        // Emits y = alpha * A * x + beta * y for a row-major A and contiguous x, without calling BLAS. Rows are computed
+        // in parallel, each with a dot product.
+        template <typename ValueType>
+        void EmitRowParallelGEMV(IRFunctionEmitter& function, int m, int n, ValueType alpha, LLVMValue A, int lda, LLVMValue x, ValueType beta, LLVMValue y, int incy)
+        {
+            std::vector<LLVMValue> arrays = { function.PointerOffset(A, 0), function.PointerOffset(x, 0), function.PointerOffset(y, 0) };
+            function.ParallelFor(m, arrays, [=](IRFunctionEmitter& function, IRLocalScalar row, const std::vector<LLVMValue>& capturedValues) {
+                auto y = function.LocalArray(capturedValues[2]);
+                auto result = function.LocalScalar(function.DotProduct(n, function.PointerOffset(capturedValues[0], row * lda), capturedValues[1]));
+                if (alpha != 1)
+                {
+                    result = result * function.LocalScalar(alpha);
+                }
+                if (beta != 0)
+                {
+                    result = result + function.LocalScalar(beta) * static_cast<IRLocalScalar>(y[row * incy]);
+                }
+                y[row * incy] = result;
+            });
+        }
+
+        // Constant globals (the weights) never change, so the runtime keeps their device copies
+        bool IsConstantGlobal(LLVMValue value)
+        {
+            auto global = llvm::dyn_cast<llvm::GlobalVariable>(value->stripInBoundsOffsets());
+            return global != nullptr && global->isConstant();
+        }
+
+        // Emits C = alpha * op(A) * op(B) + beta * C as straight-line code. C is computed one `mr` x `nr` register tile
+        // at a time, as in the blocked kernel: for each p, the tile's column of A and row of B are loaded and
+        // accumulated into the tile, so only the tile and one slice of each operand are live at once. Each entry of C
+        // is summed in order over k, and with constant weights the optimizer can fold the loads.
+        template <typename ValueType>
+        void EmitUnrolledGEMM(IRFunctionEmitter& function, bool transposeA, bool transposeB, int m, int n, int k, ValueType alpha, LLVMValue A, int lda, LLVMValue B, int ldb, ValueType beta, LLVMValue C, int ldc)
+        {
+            const auto tiles = GetGemmTileSizes(function.GetCompilerOptions(), static_cast<int>(sizeof(ValueType)), m, n, k);
+            auto a = function.LocalArray(A);
+            auto b = function.LocalArray(B);
+            auto c = function.LocalArray(C);
+
+            for (int firstRow = 0; firstRow < m; firstRow += tiles.mr)
+            {
+                const int numRows = std::min(tiles.mr, m - firstRow);
+                for (int firstColumn = 0; firstColumn < n; firstColumn += tiles.nr)
+                {
+                    const int numColumns = std::min(tiles.nr, n - firstColumn);
+                    std::vector<IRLocalScalar> results;
+                    for (int p = 0; p < k; ++p)
+                    {
+                        std::vector<IRLocalScalar> aValues;
+                        for (int i = firstRow; i < firstRow + numRows; ++i)
+                        {
+                            aValues.push_back(a[transposeA ? p * lda + i : i * lda + p]);
+                        }
+                        std::vector<IRLocalScalar> bValues;
+                        for (int j = firstColumn; j < firstColumn + numColumns; ++j)
+                        {
+                            bValues.push_back(b[transposeB ? j * ldb + p : p * ldb + j]);
+                        }
+
+                        for (int i = 0; i < numRows; ++i)
+                        {
+                            for (int j = 0; j < numColumns; ++j)
+                            {
+                                if (p == 0)
+                                {
+                                    results.push_back(aValues[i] * bValues[j]);
+                                }
+                                else
+                                {
+                                    results[i * numColumns + j] = results[i * numColumns + j] + aValues[i] * bValues[j];
+                                }
+                            }
+                        }
+                    }
+
+                    for (int i = 0; i < numRows; ++i)
+                    {
+                        for (int j = 0; j < numColumns; ++j)
+                        {
+                            auto result = results[i * numColumns + j];
+                            auto cIndex = (firstRow + i) * ldc + firstColumn + j;
+                            if (alpha != 1)
+                            {
+                                result = result * function.LocalScalar(alpha);
+                            }
+                            if (beta != 0)
+                            {
+                                result = result + function.LocalScalar(beta) * static_cast<IRLocalScalar>(c[cIndex]);
+                            }
+                            c[cIndex] = result;
+                        }
+                    }
+                }
+            }
+        }
+
         constexpr llvm::Attribute::AttrKind ToLLVMAttr(IRFunctionEmitter::Attributes attr)
         {
             switch (attr)
@@ -999,6 +1336,19 @@ namespace emitters
         return Load(GetEmitter().DereferenceGlobalPointer(pGlobal));
     }
 
+    LLVMValue IRFunctionEmitter::WeightValueAt(LLVMValue pWeights, LLVMValue pOffset, LLVMType valueType)
+    {
+        auto storedType = GetArrayEntryType(pWeights);
+        if (storedType == valueType)
+        {
+            return ValueAt(pWeights, pOffset);
+        }
+
+        const bool isHalf = IsHalfPrecisionWeightType(storedType, valueType);
+        auto value = DecodeWeightBits(*this, ValueAt(CastPointer(pWeights, VariableType::Int16Pointer), pOffset), isHalf);
+        return value->getType() == valueType ? value : CastValue(value, valueType);
+    }
+
     LLVMValue IRFunctionEmitter::PointerOffset(LLVMValue pPointer, LLVMValue pOffset)
     {
         llvm::GlobalVariable* pGlobal = llvm::dyn_cast<llvm::GlobalVariable>(pPointer);
@@ -1121,6 +1471,20 @@ namespace emitters
         loop.End();
     }
 
+    void IRFunctionEmitter::VectorizedFor(LLVMValue beginValue, LLVMValue endValue, int vectorWidth, std::function<void(IRFunctionEmitter&, IRLocalScalar)> body)
+    {
+        VectorizedFor(beginValue, endValue, vectorWidth, false, body);
+    }
+
+    void IRFunctionEmitter::VectorizedFor(LLVMValue beginValue, LLVMValue endValue, int vectorWidth, bool independentIterations, std::function<void(IRFunctionEmitter&, IRLocalScalar)> body)
+    {
+        auto loop = IRForLoopEmitter(*this);
+        loop.Begin(beginValue, endValue, Literal<int>(1));
+        loop.SetVectorizationHint(vectorWidth, independentIterations);
+        body(*this, LocalScalar(loop.LoadIterationVariable()));
+        loop.End();
+    }
+
     //
     // Extended for loops
     //
@@ -1315,7 +1679,8 @@ namespace emitters
     IRTaskArray IRFunctionEmitter::StartTasks(LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments)
     {
         auto compilerSettings = GetCompilerOptions();
-        if (compilerSettings.parallelize && compilerSettings.useThreadPool && !compilerSettings.targetDevice.IsWindows())
+        // The shared runtime's pool doesn't need pthreads, so it's also used on Windows
+        if (compilerSettings.parallelize && (compilerSettings.useSharedRuntime || (compilerSettings.useThreadPool && !compilerSettings.targetDevice.IsWindows())))
         {
             auto& threadPool = GetModule().GetThreadPool();
             return threadPool.AddTasks(*this, taskFunction, arguments);
@@ -1435,6 +1800,32 @@ namespace emitters
             throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch, "Arguments to DotProduct must be pointers to the same type");
         }
 
+        // With several accumulators, the additions don't wait on each other. This changes the order of the additions,
+        // so floating-point dot products only use them with fast math.
+        const bool reassociate = elementType->isIntegerTy() || GetCompilerOptions().useFastMath;
+        if (reassociate && (elementType->isFloatTy() || elementType->isDoubleTy() || elementType->isIntegerTy(32) || elementType->isIntegerTy(64)))
+        {
+            LLVMValue sum = nullptr;
+            if (elementType->isFloatTy())
+            {
+                sum = EmitMultiAccumulatorDotProduct<float>(*this, size, pLeftValue, pRightValue);
+            }
+            else if (elementType->isDoubleTy())
+            {
+                sum = EmitMultiAccumulatorDotProduct<double>(*this, size, pLeftValue, pRightValue);
+            }
+            else if (elementType->isIntegerTy(32))
+            {
+                sum = EmitMultiAccumulatorDotProduct<int>(*this, size, pLeftValue, pRightValue);
+            }
+            else
+            {
+                sum = EmitMultiAccumulatorDotProduct<int64_t>(*this, size, pLeftValue, pRightValue);
+            }
+            Store(pDestination, sum);
+            return;
+        }
+
         StoreZero(pDestination);
         if (elementType->isFPOrFPVectorTy())
         {
@@ -1486,6 +1877,26 @@ namespace emitters
         }
     }
 
+    LLVMValue IRFunctionEmitter::WeightsDotProduct(int size, LLVMValue pValues, LLVMValue pWeights)
+    {
+        auto valueType = GetArrayEntryType(pValues);
+        if (GetArrayEntryType(pWeights) == valueType)
+        {
+            return DotProduct(size, pValues, pWeights);
+        }
+
+        const bool isHalf = IsHalfPrecisionWeightType(GetArrayEntryType(pWeights), valueType);
+        if (valueType->isFloatTy())
+        {
+            return EmitWeightsDotProduct<float>(*this, size, pValues, pWeights, isHalf);
+        }
+        if (valueType->isDoubleTy())
+        {
+            return EmitWeightsDotProduct<double>(*this, size, pValues, pWeights, isHalf);
+        }
+        throw EmitterException(EmitterError::valueTypeNotSupported, "WeightsDotProduct needs floating-point values");
+    }
+
     LLVMValue IRFunctionEmitter::DotProduct(int size, LLVMValue pLeftValue, LLVMValue pRightValue)
     {
         if (!pLeftValue->getType()->isPointerTy() || !pRightValue->getType()->isPointerTy())
@@ -1500,6 +1911,38 @@ namespace emitters
         return Load(pTotal);
     }
 
+    //
+    // Prefetching
+    //
+    void IRFunctionEmitter::Prefetch(LLVMValue pAddress)
+    {
+        // llvm.prefetch(address, read (0) or write (1), locality from none (0) to keep in all caches (3), data (1) or instruction (0) cache)
+        auto prefetch = GetModule().GetIntrinsic(llvm::Intrinsic::prefetch, std::initializer_list<LLVMType>{});
+        auto int8PtrType = llvm::Type::getInt8PtrTy(GetLLVMContext());
+        Call(prefetch, { CastPointer(pAddress, int8PtrType), Literal<int>(0), Literal<int>(3), Literal<int>(1) });
+    }
+
+    void IRFunctionEmitter::PrefetchAhead(LLVMValue pArray, LLVMValue index)
+    {
+        const auto distance = GetPrefetchDistance();
+        if (distance <= 0)
+        {
+            return;
+        }
+
+        // The address ahead can be past the end of the array, which is fine for a prefetch, but not for a getelementptr,
+        // so it's computed as an integer
+        auto address = CastPointerToInt(PointerOffset(pArray, index), VariableType::Int64);
+        auto addressAhead = Operator(TypedOperator::add, address, Literal<int64_t>(distance));
+        Prefetch(CastIntToPointer(addressAhead, llvm::Type::getInt8PtrTy(GetLLVMContext())));
+    }
+
+    int IRFunctionEmitter::GetPrefetchDistance()
+    {
+        const auto& options = GetCompilerOptions();
+        return options.prefetchDistance >= 0 ? options.prefetchDistance : static_cast<int>(options.targetDevice.prefetchDistance);
+    }
+
     //
     // BLAS functions
     //
@@ -1512,13 +1955,28 @@ namespace emitters
     template <typename ValueType>
     void IRFunctionEmitter::CallGEMV(int m, int n, ValueType alpha, LLVMValue A, int lda, LLVMValue x, int incx, ValueType beta, LLVMValue y, int incy)
     {
+        if (IsSmallGemm(GetCompilerOptions(), m, 1, n))
+        {
+            // x is an n x 1 matrix with a row stride of incx, and y an m x 1 matrix with a row stride of incy
+            EmitUnrolledGEMM<ValueType>(*this, false, false, m, 1, n, alpha, A, lda, x, incx, beta, y, incy);
+            return;
+        }
+
         auto useBlas = CanUseBlas();
+        if (!useBlas && GetCompilerOptions().useBlockedGemm && incx == 1)
+        {
+            EmitRowParallelGEMV<ValueType>(*this, m, n, alpha, A, lda, x, beta, y, incy);
+            return;
+        }
+
         LLVMFunction gemv = GetModule().GetRuntime().GetGEMVFunction<ValueType>(useBlas);
         if (gemv == nullptr)
         {
             throw EmitterException(EmitterError::functionNotFound, "Couldn't find GEMV function");
         }
 
+        SetNumBlasThreadsForCall(static_cast<size_t>(m) * n);
+
         const auto CblasRowMajor = 101;
         const auto CblasNoTrans = 111;
         emitters::IRValueList args{ Literal(CblasRowMajor),
@@ -1542,16 +2000,80 @@ namespace emitters
         CallGEMM<ValueType>(false, false, m, n, k, A, lda, B, ldb, C, ldc);
     }
 
+    template <typename ValueType>
+    void IRFunctionEmitter::CallGEMM(bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, const std::vector<ValueType>* constantA, LLVMValue B, int ldb, const std::vector<ValueType>* constantB, LLVMValue C, int ldc, const std::string& packedName)
+    {
+        if ((constantA == nullptr && constantB == nullptr) || !UsesBlockedGemm(GetCompilerOptions(), m, n, k))
+        {
+            CallGEMM<ValueType>(transposeA, transposeB, m, n, k, A, lda, B, ldb, C, ldc);
+            return;
+        }
+
+        // The packed layout depends on the block sizes, so they're part of the name
+        const auto tiles = GetGemmTileSizes(GetCompilerOptions(), static_cast<int>(sizeof(ValueType)), m, n, k);
+        const auto tilesSuffix = "_" + std::to_string(tiles.mr) + "x" + std::to_string(tiles.nr) + "x" + std::to_string(tiles.kc) + "x" + std::to_string(tiles.mc) + "x" + std::to_string(tiles.nc);
+        auto getPackedOperand = [this](const std::string& name, auto pack) -> LLVMValue {
+            if (auto global = GetModule().GetLLVMModule()->getNamedGlobal(name))
+            {
+                return global;
+            }
+            return GetModule().ConstantArray(name, pack());
+        };
+
+        LLVMValue packedA = nullptr;
+        if (constantA != nullptr)
+        {
+            packedA = getPackedOperand(packedName + "_packedA" + tilesSuffix, [&] { return PackGemmLeftOperand(tiles, transposeA, m, k, constantA->data(), lda); });
+        }
+        LLVMValue packedB = nullptr;
+        if (constantB != nullptr)
+        {
+            packedB = getPackedOperand(packedName + "_packedB" + tilesSuffix, [&] { return PackGemmRightOperand(tiles, transposeB, k, n, constantB->data(), ldb); });
+        }
+        EmitBlockedGEMM<ValueType>(*this, transposeA, transposeB, m, n, k, A, lda, B, ldb, C, ldc, packedA, packedB);
+    }
+
     template <typename ValueType>
     void IRFunctionEmitter::CallGEMM(bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, LLVMValue B, int ldb, LLVMValue C, int ldc)
     {
+        // BLAS, the GPU runtime and the unrolled GEMM only take full-precision matrices, so reduced-precision weights
+        // go to the blocked GEMM, which widens them as it packs them
+        auto valueType = GetEmitter().Type(GetVariableType<ValueType>());
+        if (GetArrayEntryType(A) != valueType || GetArrayEntryType(B) != valueType)
+        {
+            EmitBlockedGEMM<ValueType>(*this, transposeA, transposeB, m, n, k, A, lda, B, ldb, C, ldc);
+            return;
+        }
+
+        if (IsSmallGemm(GetCompilerOptions(), m, n, k))
+        {
+            EmitUnrolledGEMM<ValueType>(*this, transposeA, transposeB, m, n, k, static_cast<ValueType>(1), A, lda, B, ldb, static_cast<ValueType>(0), C, ldc);
+            return;
+        }
+
+        if (IsGpuGemm(GetCompilerOptions(), m, n, k))
+        {
+            auto& runtime = GetModule().GetRuntime();
+            const int constantOperands = (IsConstantGlobal(A) ? ell_runtime_ConstantA : 0) | (IsConstantGlobal(B) ? ell_runtime_ConstantB : 0);
+            Call(runtime.GetGpuGEMMFunction<ValueType>(), { Literal<int>(transposeA), Literal<int>(transposeB), Literal(m), Literal(n), Literal(k), A, Literal(lda), B, Literal(ldb), C, Literal(ldc), Literal(constantOperands), runtime.GetGpuModuleId(*this) });
+            return;
+        }
+
         auto useBlas = CanUseBlas();
+        if (!useBlas && GetCompilerOptions().useBlockedGemm)
+        {
+            EmitBlockedGEMM<ValueType>(*this, transposeA, transposeB, m, n, k, A, lda, B, ldb, C, ldc);
+            return;
+        }
+
         LLVMFunction gemm = GetModule().GetRuntime().GetGEMMFunction<ValueType>(useBlas);
         if (gemm == nullptr)
         {
             throw EmitterException(EmitterError::functionNotFound, "Couldn't find GEMM function");
         }
 
+        SetNumBlasThreadsForCall(static_cast<size_t>(m) * n * k);
+
         const auto CblasRowMajor = 101;
         const auto CblasNoTrans = 111;
         const auto CblasTrans = 112;
@@ -1638,6 +2160,15 @@ namespace emitters
         return Call(selfFunction, {});
     }
 
+    LLVMValue IRFunctionEmitter::PthreadSetAffinity(LLVMValue thread, LLVMValue cpuSetPtr)
+    {
+        auto& posixEmitter = GetModule().GetRuntime().GetPosixEmitter();
+        auto setAffinityFunction = posixEmitter.GetPthreadSetAffinityFunction();
+        auto wordType = posixEmitter.GetCpuSetWordType();
+        auto cpuSetSize = llvm::ConstantInt::get(wordType, posixEmitter.GetCpuSetNumWords() * (wordType->getPrimitiveSizeInBits() / 8));
+        return Call(setAffinityFunction, { thread, cpuSetSize, cpuSetPtr });
+    }
+
     LLVMValue IRFunctionEmitter::PthreadMutexInit(LLVMValue mutexPtr, LLVMValue attrPtr)
     {
         auto initFunction = GetModule().GetRuntime().GetPosixEmitter().GetPthreadMutexInitFunction();
@@ -1810,6 +2341,34 @@ namespace emitters
         return GetCompilerOptions().useBlas;
     }
 
+    void IRFunctionEmitter::SetNumBlasThreadsForCall(size_t numOperations)
+    {
+        const auto& options = GetCompilerOptions();
+        if (!CanUseBlas())
+        {
+            return;
+        }
+
+        // The shared runtime applies the process-wide policy (if its BLAS library is OpenBLAS), so all models agree on the number of threads
+        if (options.useSharedRuntime)
+        {
+            Call(GetModule().GetRuntime().GetSharedRuntimeSetBlasThreadsForCallFunction(), { Literal<int64_t>(static_cast<int64_t>(numOperations)) });
+            return;
+        }
+
+        // Only OpenBLAS can change its number of threads
+        if (options.blasType != BlasType::openBLAS)
+        {
+            return;
+        }
+
+        // Unless told otherwise, leave the cores to ELL's own threads when it parallelizes
+        math::Blas::ThreadingPolicy policy;
+        policy.maxThreads = options.blasThreads > 0 ? options.blasThreads : (options.parallelize ? 1 : options.maxThreads);
+        policy.minOperationsPerThread = static_cast<size_t>(std::max(options.blasMinOperationsPerThread, 0));
+        SetNumOpenBLASThreads(Literal(math::Blas::GetNumThreads(policy, numOperations)));
+    }
+
     void IRFunctionEmitter::RegisterFunctionArgs(const NamedVariableTypeList& args)
     {
         auto argumentsIterator = Arguments().begin();
@@ -1895,5 +2454,9 @@ namespace emitters
     template void IRFunctionEmitter::CallGEMM<double>(int m, int n, int k, LLVMValue A, int lda, LLVMValue B, int ldb, LLVMValue C, int ldc);
 
     template void IRFunctionEmitter::CallGEMM<double>(bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, LLVMValue B, int ldb, LLVMValue C, int ldc);
+
+    template void IRFunctionEmitter::CallGEMM<float>(bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, const std::vector<float>* constantA, LLVMValue B, int ldb, const std::vector<float>* constantB, LLVMValue C, int ldc, const std::string& packedName);
+
+    template void IRFunctionEmitter::CallGEMM<double>(bool transposeA, bool transposeB, int m, int n, int k, LLVMValue A, int lda, const std::vector<double>* constantA, LLVMValue B, int ldb, const std::vector<double>* constantB, LLVMValue C, int ldc, const std::string& packedName);
 } // namespace emitters
 } // namespace ell
@@ -21,6 +21,7 @@
 #include <utilities/include/StringUtil.h>
 #include <utilities/include/UniqueNameList.h>
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -315,6 +316,15 @@ namespace emitters
         return s;
     }
 
+    // An input or output of the predict function that holds data
+    struct CppWrapperDataArgument
+    {
+        std::string name;
+        std::string type;
+        bool isOutput;
+        int index; // the index of the input or output, for GetInputSize or GetOutputSize
+    };
+
     struct CppWrapperInfo
     {
         std::string moduleName;
@@ -325,6 +335,9 @@ namespace emitters
         std::string predictReturnMember;
         std::vector<std::string> predictMethodArgs;
         std::vector<std::string> predictCallArgs;
+        std::vector<std::string> leadingCallArgs; // the predict function's context and state arguments
+        std::vector<CppWrapperDataArgument> dataArgs;
+        bool hasState = false;
         std::stringstream constructorInit;
         std::stringstream predictPreBody;
         std::stringstream predictPostBody;
@@ -349,9 +362,13 @@ namespace emitters
             // a virtual method that can be implemented in another language (via SWIG)
             info.helperMethods << "    void Internal_" << callbackMethod << "(" << inputType << "* buffer)\n";
             info.helperMethods << "    {\n";
+            info.helperMethods << "        " << callbackMethod << "Buffer(CallbackBuffer<" << inputType << ">{ buffer, GetInputSize(" << sourceIndex << ") });\n";
+            info.helperMethods << "    }\n\n";
+            info.helperMethods << "    virtual void " << callbackMethod << "Buffer(CallbackBuffer<" << inputType << "> " << argName << ")\n";
+            info.helperMethods << "    {\n";
+            info.helperMethods << "        // override this method instead to fill the input where the model reads it, without copying\n";
             info.helperMethods << "        " << callbackMethod << "(_" << argName << ");\n"; // fill the input buffer
-            info.helperMethods << "        int32_t size = GetInputSize(" << sourceIndex << ");\n";
-            info.helperMethods << "        ::memcpy(buffer, _" << argName << ".data(), size * sizeof(" << inputType << "));\n";
+            info.helperMethods << "        ::memcpy(" << argName << ".data, _" << argName << ".data(), " << argName << ".size * sizeof(" << inputType << "));\n";
             info.helperMethods << "    }\n\n";
             info.helperMethods << "    virtual void " << callbackMethod << "(std::vector<" << inputType << ">& " << argName << ")\n";
             info.helperMethods << "    {\n";
@@ -445,8 +462,13 @@ namespace emitters
                 // a virtual method that can be implemented in another language (via SWIG)
                 info.helperMethods << "    void Internal_" << callbackMethod << "(" << outputType << "* buffer)\n";
                 info.helperMethods << "    {\n";
-                info.helperMethods << "        int32_t size = GetSinkOutputSize(" << sinkIndex << ");\n";
-                info.helperMethods << "        " << memberName << ".assign(buffer, buffer + size);\n";
+                info.helperMethods << "        " << callbackMethod << "Buffer(CallbackBuffer<" << outputType << ">{ buffer, GetSinkOutputSize(" << sinkIndex << ") });\n";
+                info.helperMethods << "    }\n\n";
+                info.helperMethods << "    virtual void " << callbackMethod << "Buffer(CallbackBuffer<" << outputType << "> " << argName << ")\n";
+                info.helperMethods << "    {\n";
+                info.helperMethods << "        // override this method instead to read the output where the model wrote it, without copying\n";
+                info.helperMethods << "        // (Predict then doesn't return it)\n";
+                info.helperMethods << "        " << memberName << ".assign(" << argName << ".data, " << argName << ".data + " << argName << ".size);\n";
                 info.helperMethods << "        " << callbackMethod << "(" << memberName << ");\n"; // pass it to virtual method
                 info.helperMethods << "    }\n\n";
                 info.helperMethods << "    virtual void " << callbackMethod << "(std::vector<" << outputType << ">& " << argName << ")\n";
@@ -499,14 +521,23 @@ namespace emitters
                 // we really want void* on these puppies, but LLVM won't let us...(which is why the argType is int8_t*,
                 // and for our wrapper class, the context will be 'this' so the "C" callbacks can find this object.
                 info.predictCallArgs.push_back("this");
+                info.leadingCallArgs.push_back("this");
+            }
+            else if (argName == "state")
+            {
+                info.predictCallArgs.push_back("_state.data()");
+                info.leadingCallArgs.push_back("_state.data()");
             }
             else
             {
                 std::stringstream ss;
                 WriteLLVMType(ss, arg->getType()->getPointerElementType());
                 std::string argType = ss.str();
+                bool isOutput = (flags & ArgumentFlags::Output) != 0;
+                int dataIndex = static_cast<int>(std::count_if(info.dataArgs.begin(), info.dataArgs.end(), [isOutput](const auto& dataArg) { return dataArg.isOutput == isOutput; }));
+                info.dataArgs.push_back({ argName, argType, isOutput, dataIndex });
                 bool passArgument = false;
-                if ((flags & ArgumentFlags::Output) && outputCount == 0)
+                if (isOutput && outputCount == 0)
                 {
                     // first argument is special, it becomes a class member and the return value for this function.
                     std::string memberName = "_" + funDecl.GetFunctionName() + "_" + argName;
@@ -533,6 +564,77 @@ namespace emitters
         }
     }
 
+    // Writes the predict methods that don't copy or allocate: one on the caller's pointers, a batch version, and
+    // ones on aligned buffers the wrapper owns. They're hidden from SWIG, which can't wrap pointers and futures.
+    void WriteBufferPredictMethods(CppWrapperInfo& info, LLVMFunction batchPredictFunction)
+    {
+        std::vector<std::string> pointerArgs;
+        std::vector<std::string> pointerCallArgs = info.leadingCallArgs;
+        std::vector<std::string> sampleArgs;
+        std::vector<std::string> bufferArgs;
+        std::stringstream bufferAccessors;
+        info.memberDecls << "#if !defined(SWIG)\n";
+        info.constructorInit << "#if !defined(SWIG)\n";
+        for (const auto& arg : info.dataArgs)
+        {
+            auto sizeFunction = std::string(arg.isOutput ? "GetOutputSize(" : "GetInputSize(") + std::to_string(arg.index) + ")";
+            auto bufferName = "_" + arg.name + "Buffer";
+            auto accessorName = "Get" + arg.name + "Buffer";
+            accessorName[3] = ::toupper(accessorName[3]); // pascal case
+
+            pointerArgs.push_back((arg.isOutput ? "" : "const ") + arg.type + "* " + arg.name);
+            pointerCallArgs.push_back(arg.isOutput ? arg.name : "const_cast<" + arg.type + "*>(" + arg.name + ")");
+            sampleArgs.push_back(arg.name + " + sample * " + sizeFunction);
+            bufferArgs.push_back(bufferName + ".Data()");
+            bufferAccessors << "    " << (arg.isOutput ? "const " : "") << arg.type << "* " << accessorName << "()" << (arg.isOutput ? " const" : "") << " { return " << bufferName << ".Data(); }\n";
+            info.memberDecls << "    AlignedBuffer<" << arg.type << "> " << bufferName << ";\n";
+            info.constructorInit << "        " << bufferName << ".Resize(" << sizeFunction << ");\n";
+        }
+        info.memberDecls << "#endif // !defined(SWIG)\n";
+        info.constructorInit << "#endif // !defined(SWIG)\n";
+
+        auto& os = info.helperMethods;
+        const auto& name = info.predictMethodName;
+        os << "#if !defined(SWIG)\n";
+        os << "    // Computes the outputs from the inputs where they are, without copying or allocating\n";
+        os << "    void " << name << "Into(" << utilities::Join(pointerArgs, ", ") << ")\n";
+        os << "    {\n";
+        os << "        " << info.predictFunctionName << "(" << utilities::Join(pointerCallArgs, ", ") << ");\n";
+        os << "    }\n\n";
+
+        os << "    // Computes the outputs of batchSize samples, stored one after another in each argument\n";
+        os << "    void " << name << "Batch(" << utilities::Join(pointerArgs, ", ") << ", int batchSize)\n";
+        os << "    {\n";
+        if (batchPredictFunction != nullptr)
+        {
+            os << "        " << std::string(batchPredictFunction->getName()) << "(" << utilities::Join(pointerCallArgs, ", ") << ", batchSize);\n";
+        }
+        else
+        {
+            os << "        for (int sample = 0; sample < batchSize; ++sample)\n";
+            os << "        {\n";
+            os << "            " << name << "Into(" << utilities::Join(sampleArgs, ", ") << ");\n";
+            os << "        }\n";
+        }
+        os << "    }\n\n";
+
+        os << "    // The input and output buffers this object owns, aligned to AlignedBuffer's alignment\n";
+        os << bufferAccessors.str() << "\n";
+
+        os << "    // Computes the outputs in this object's buffers from the inputs in its buffers\n";
+        os << "    void " << name << "Buffers()\n";
+        os << "    {\n";
+        os << "        " << name << "Into(" << utilities::Join(bufferArgs, ", ") << ");\n";
+        os << "    }\n\n";
+
+        os << "    // Starts " << name << "Buffers on another thread. Leave the buffers alone until the future is ready.\n";
+        os << "    std::future<void> " << name << "Async()\n";
+        os << "    {\n";
+        os << "        return std::async(std::launch::async, [this] { " << name << "Buffers(); });\n";
+        os << "    }\n";
+        os << "#endif // !defined(SWIG)\n\n";
+    }
+
     void WritePredictMethod(ModuleCallbackDefinitions& moduleCallbacks, CppWrapperInfo& info)
     {
         bool hasSourceNodes = !moduleCallbacks.sources.empty();
@@ -545,7 +647,7 @@ namespace emitters
             info.helperMethods << "    {\n";
             info.helperMethods << info.predictPreBody.str();
             info.helperMethods << "        double time = _timer.GetMilliseconds();\n";
-            info.helperMethods << "        " << info.predictFunctionName << "(this, &time, nullptr);\n";
+            info.helperMethods << "        " << info.predictFunctionName << (info.hasState ? "(this, _state.data(), &time, nullptr);\n" : "(this, &time, nullptr);\n");
             info.helperMethods << info.predictPostBody.str();
             if (info.predictReturnType != "void")
             {
@@ -604,6 +706,19 @@ namespace emitters
 
         bool hasSourceNodes = !moduleCallbacks.sources.empty();
 
+        // A reentrant model keeps its state in a struct the caller allocates, so each wrapper object owns one
+        info.hasState = std::any_of(predictFunction->arg_begin(), predictFunction->arg_end(), [](const llvm::Argument& arg) { return arg.getName() == "state"; });
+        if (info.hasState)
+        {
+            info.memberDecls << "    struct alignas(16) StateBlock\n";
+            info.memberDecls << "    {\n";
+            info.memberDecls << "        char bytes[16];\n";
+            info.memberDecls << "    };\n";
+            info.memberDecls << "    std::vector<StateBlock> _state;\n";
+            info.constructorInit << "        _state.resize((" << moduleName << "_GetStateSize() + sizeof(StateBlock) - 1) / sizeof(StateBlock));\n";
+            info.constructorInit << "        " << moduleName << "_InitState(_state.data());\n";
+        }
+
         if (!hasSourceNodes)
         {
             WriteSimplePredictMethod(predictFunction, info, moduleEmitter);
@@ -617,6 +732,10 @@ namespace emitters
         WriteSinkNotificationCallbacks(moduleCallbacks, info);
 
         WritePredictMethod(moduleCallbacks, info);
+        if (!hasSourceNodes)
+        {
+            WriteBufferPredictMethods(info, moduleEmitter.GetLLVMModule()->getFunction(info.predictFunctionName + "_batch"));
+        }
 
         // now write out the final completed code.
 
@@ -638,6 +757,7 @@ namespace emitters
         ReplaceDelimiter(predictWrapperCode, "CDECLS_IMPL", info.cdecls.str());
         ReplaceDelimiter(predictWrapperCode, "STEPPABLE", hasSourceNodes ? "true" : "false");
         ReplaceDelimiter(predictWrapperCode, "RESET_BODY", info.resetMethodBody.str());
+        ReplaceDelimiter(predictWrapperCode, "RESET_ARGS", info.hasState ? "_state.data()" : "");
 
         os << predictWrapperCode;
     }
@@ -9,6 +9,14 @@
 #include "IRLoopEmitter.h"
 #include "IRFunctionEmitter.h"
 
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Metadata.h>
+
+#include <set>
+#include <vector>
+
 namespace ell
 {
 namespace emitters
@@ -118,9 +126,74 @@ namespace emitters
 
         // Caller is done generating the body. Add a branch from the Body block to the increment block
         _functionEmitter.Branch(_pIncrementBlock);
+        if (_pParallelLoopID != nullptr)
+        {
+            MarkParallelMemoryAccesses();
+        }
         _functionEmitter.SetCurrentBlock(_pAfterBlock);
     }
 
+    void IRForLoopEmitter::SetVectorizationHint(int vectorWidth, bool independentIterations)
+    {
+        if (_pIncrementBlock == nullptr || _pIncrementBlock->getTerminator() == nullptr)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "SetVectorizationHint() must be called after Begin()");
+        }
+
+        // The loop ID is a distinct node whose first operand refers to itself, followed by the loop properties
+        auto& context = _functionEmitter.GetLLVMContext();
+        auto enable = llvm::MDNode::get(context, { llvm::MDString::get(context, "llvm.loop.vectorize.enable"), llvm::ConstantAsMetadata::get(llvm::ConstantInt::getTrue(context)) });
+        auto width = llvm::MDNode::get(context, { llvm::MDString::get(context, "llvm.loop.vectorize.width"), llvm::ConstantAsMetadata::get(llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), vectorWidth)) });
+        auto loopID = llvm::MDNode::getDistinct(context, { nullptr, enable, width });
+        loopID->replaceOperandWith(0, loopID);
+
+        // Loop metadata goes on the branch back to the loop header
+        _pIncrementBlock->getTerminator()->setMetadata(llvm::LLVMContext::MD_loop, loopID);
+        if (independentIterations)
+        {
+            _pParallelLoopID = loopID;
+        }
+    }
+
+    void IRForLoopEmitter::MarkParallelMemoryAccesses()
+    {
+        // The body is every block reachable from the body block without going through the increment block
+        std::vector<llvm::BasicBlock*> blocks = { _pBodyBlock };
+        std::set<llvm::BasicBlock*> visited = { _pBodyBlock, _pIncrementBlock, _pAfterBlock };
+        for (size_t blockIndex = 0; blockIndex < blocks.size(); ++blockIndex)
+        {
+            for (auto successor : llvm::successors(blocks[blockIndex]))
+            {
+                if (visited.insert(successor).second)
+                {
+                    blocks.push_back(successor);
+                }
+            }
+        }
+
+        // An access in a nested loop lists the IDs of all the parallel loops it's in
+        auto& context = _functionEmitter.GetLLVMContext();
+        auto kind = context.getMDKindID("llvm.mem.parallel_loop_access");
+        for (auto block : blocks)
+        {
+            for (auto& instruction : *block)
+            {
+                if (!instruction.mayReadOrWriteMemory() || llvm::isa<llvm::CallInst>(instruction))
+                {
+                    continue;
+                }
+
+                std::vector<llvm::Metadata*> loopIDs;
+                if (auto existing = instruction.getMetadata(kind))
+                {
+                    loopIDs.assign(existing->op_begin(), existing->op_end());
+                }
+                loopIDs.push_back(_pParallelLoopID);
+                instruction.setMetadata(kind, llvm::MDNode::get(context, loopIDs));
+            }
+        }
+    }
+
     // Blocks used in a while loop:
     //
     // _pInitializationBlock -- setup
@@ -12,20 +12,169 @@
 
 #include <utilities/include/Exception.h>
 
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Value.h>
 
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <vector>
 
 namespace ell
 {
 namespace emitters
 {
+    namespace
+    {
+        // Constants of the float and double formats and of the approximations
+        struct FastMathConstants
+        {
+            int mantissaBits;
+            int exponentBias;
+            double minNormal;
+            double minExpArg; // log of the smallest normal number
+            double maxExpArg; // the largest argument whose exponent rounds to the largest normal exponent
+            double ln2High; // ln(2) split in two, so that n * ln2High is exact for the exponents n of the format
+            double ln2Low;
+        };
+
+        const FastMathConstants& GetFastMathConstants(LLVMType type)
+        {
+            static const FastMathConstants floatConstants = { 23, 127, 1.17549435e-38, -87.3365478515625, 88.3762626647949, 0.693359375, -2.12194440e-4 };
+            static const FastMathConstants doubleConstants = { 52, 1023, 2.2250738585072014e-308, -708.39641853226408, 709.43613930310391, 6.93145751953125e-1, 1.42860682030941723212e-6 };
+            return type->getScalarType()->isDoubleTy() ? doubleConstants : floatConstants;
+        }
+
+        bool IsFloatOrDouble(LLVMType type)
+        {
+            auto scalarType = type->getScalarType();
+            return scalarType->isFloatTy() || scalarType->isDoubleTy();
+        }
+
+        bool UseFastMath(const IRLocalScalar& a)
+        {
+            const auto& options = a.function.GetCompilerOptions();
+            return options.useFastMath && options.fastMathAccuracy != FastMathAccuracy::exact && IsFloatOrDouble(a.value->getType());
+        }
+
+        void VerifyFastMathArgument(const IRLocalScalar& a)
+        {
+            if (!IsFloatOrDouble(a.value->getType()))
+            {
+                throw EmitterException(EmitterError::valueTypeNotSupported, "Fast math functions take float or double values");
+            }
+        }
+
+        // A floating-point constant of the same type as `like`, which is splatted if `like` is a vector
+        IRLocalScalar Constant(const IRLocalScalar& like, double value)
+        {
+            return { like.function, llvm::ConstantFP::get(like.value->getType(), value) };
+        }
+
+        // The integer type (or vector type) with the same size as a floating-point type (or vector type)
+        LLVMType GetBitsType(LLVMType type)
+        {
+            auto bitsType = llvm::Type::getIntNTy(type->getContext(), type->getScalarSizeInBits());
+            return type->isVectorTy() ? llvm::VectorType::get(bitsType, type->getVectorNumElements()) : bitsType;
+        }
+
+        IRLocalScalar IntegerConstant(IRFunctionEmitter& function, LLVMType bitsType, int64_t value)
+        {
+            return { function, llvm::ConstantInt::get(bitsType, static_cast<uint64_t>(value), true) };
+        }
+
+        IRLocalScalar Select(IRLocalScalar condition, IRLocalScalar a, IRLocalScalar b)
+        {
+            return { a.function, a.function.Select(condition, a, b) };
+        }
+
+        // Evaluates a polynomial with Horner's rule. The coefficients are in order of decreasing powers.
+        IRLocalScalar Polynomial(IRLocalScalar x, const std::vector<double>& coefficients)
+        {
+            auto result = Constant(x, coefficients[0]);
+            for (size_t i = 1; i < coefficients.size(); ++i)
+            {
+                result = result * x + Constant(x, coefficients[i]);
+            }
+            return result;
+        }
+
+        // e^r for |r| <= ln(2) / 2
+        std::vector<double> GetExpCoefficients(LLVMType type, FastMathAccuracy accuracy)
+        {
+            if (accuracy == FastMathAccuracy::low)
+            {
+                return { 1.0 / 24, 1.0 / 6, 1.0 / 2, 1.0, 1.0 };
+            }
+            if (type->getScalarType()->isDoubleTy())
+            {
+                // Taylor series to r^12
+                std::vector<double> coefficients(13);
+                double factorial = 1;
+                for (int k = 0; k <= 12; ++k)
+                {
+                    factorial *= std::max(k, 1);
+                    coefficients[12 - k] = 1.0 / factorial;
+                }
+                return coefficients;
+            }
+            // minimax polynomial from Cephes' expf
+            return { 1.9875691500e-4, 1.3981999507e-3, 8.3334519073e-3, 4.1665795894e-2, 1.6666665459e-1, 5.0000001201e-1, 1.0, 1.0 };
+        }
+
+        // log(m) / s as a polynomial in s^2, where s = (m - 1) / (m + 1): the series of 2 atanh(s) = 2 (s + s^3 / 3 + s^5 / 5 + ...)
+        std::vector<double> GetLogCoefficients(LLVMType type, FastMathAccuracy accuracy)
+        {
+            int numTerms = accuracy == FastMathAccuracy::low ? 3 : (type->getScalarType()->isDoubleTy() ? 10 : 5);
+            std::vector<double> coefficients;
+            for (int k = numTerms - 1; k >= 0; --k)
+            {
+                coefficients.push_back(2.0 / (2 * k + 1));
+            }
+            return coefficients;
+        }
+
+        IRLocalScalar CallExp(IRLocalScalar a)
+        {
+            auto f = a.function.GetModule().GetRuntime().GetExpFunction((a.value)->getType());
+            return { a.function, a.function.Call(f, { a }) };
+        }
+
+        IRLocalScalar CallLog(IRLocalScalar a)
+        {
+            auto f = a.function.GetModule().GetRuntime().GetLogFunction((a.value)->getType());
+            return { a.function, a.function.Call(f, { a }) };
+        }
+
+        IRLocalScalar CallTanh(IRLocalScalar a)
+        {
+            auto f = a.function.GetModule().GetRuntime().GetTanhFunction((a.value)->getType());
+            return { a.function, a.function.Call(f, { a }) };
+        }
+
+        // 1 / (1 + e^-x) for x >= 0 and e^x / (e^x + 1) otherwise, so that neither overflows
+        IRLocalScalar StableSigmoid(IRLocalScalar x)
+        {
+            const auto zero = Constant(x, 0.0);
+            const auto one = Constant(x, 1.0);
+            auto a = one / (CallExp(-x) + one);
+            auto b = CallExp(x);
+            auto c = b / (b + one);
+            return Select(x >= zero, a, c);
+        }
+    } // namespace
+
     //
     // Math functions
     //
     template <typename ValueType>
     IRLocalScalar Tanh(IRLocalScalar a)
     {
+        if (UseFastMath(a))
+        {
+            return FastTanh(a, a.function.GetCompilerOptions().fastMathAccuracy);
+        }
         auto f = a.function.GetModule().GetRuntime().GetTanhFunction<ValueType>();
         return { a.function, a.function.Call(f, { a }) };
     }
@@ -44,14 +193,20 @@ namespace emitters
 
     IRLocalScalar Exp(IRLocalScalar a)
     {
-        auto f = a.function.GetModule().GetRuntime().GetExpFunction((a.value)->getType());
-        return { a.function, a.function.Call(f, { a }) };
+        if (UseFastMath(a))
+        {
+            return FastExp(a, a.function.GetCompilerOptions().fastMathAccuracy);
+        }
+        return CallExp(a);
     }
 
     IRLocalScalar Log(IRLocalScalar a)
     {
-        auto f = a.function.GetModule().GetRuntime().GetLogFunction((a.value)->getType());
-        return { a.function, a.function.Call(f, { a }) };
+        if (UseFastMath(a))
+        {
+            return FastLog(a, a.function.GetCompilerOptions().fastMathAccuracy);
+        }
+        return CallLog(a);
     }
 
     IRLocalScalar Sin(IRLocalScalar a)
@@ -66,6 +221,133 @@ namespace emitters
         return { a.function, a.function.Call(f, { a }) };
     }
 
+    IRLocalScalar Sigmoid(IRLocalScalar a)
+    {
+        if (UseFastMath(a))
+        {
+            return FastSigmoid(a, a.function.GetCompilerOptions().fastMathAccuracy);
+        }
+        return StableSigmoid(a);
+    }
+
+    //
+    // Fast approximations
+    //
+    IRLocalScalar FastExp(IRLocalScalar a, FastMathAccuracy accuracy)
+    {
+        if (accuracy == FastMathAccuracy::exact)
+        {
+            return CallExp(a);
+        }
+        VerifyFastMathArgument(a);
+
+        auto& function = a.function;
+        auto& emitter = function.GetEmitter();
+        auto type = a.value->getType();
+        auto bitsType = GetBitsType(type);
+        const auto& constants = GetFastMathConstants(type);
+        const auto minArg = Constant(a, constants.minExpArg);
+        const auto maxArg = Constant(a, constants.maxExpArg);
+        const auto half = Constant(a, 0.5);
+
+        // e^x = 2^n e^r, where n = round(x / ln(2)) and |r| <= ln(2) / 2
+        auto x = Min(Max(a, minArg), maxArg);
+        auto y = x * Constant(a, 1.4426950408889634);
+        IRLocalScalar n{ function, emitter.CastFloatToInt(y + Select(y >= Constant(a, 0.0), half, -half), bitsType, true) };
+        IRLocalScalar nFloat{ function, emitter.CastIntToFloat(n, type, true) };
+        auto r = x - nFloat * Constant(a, constants.ln2High) - nFloat * Constant(a, constants.ln2Low);
+        auto expR = Polynomial(r, GetExpCoefficients(type, accuracy));
+
+        // 2^n, by putting the biased exponent in the exponent bits
+        auto scaleBits = (n + IntegerConstant(function, bitsType, constants.exponentBias)) << IntegerConstant(function, bitsType, constants.mantissaBits);
+        IRLocalScalar scale{ function, function.BitCast(scaleBits, type) };
+        auto result = expR * scale;
+
+        // arguments out of range underflow to 0 and overflow to infinity
+        result = Select(a < minArg, Constant(a, 0.0), result);
+        return Select(a > maxArg, Constant(a, std::numeric_limits<double>::infinity()), result);
+    }
+
+    IRLocalScalar FastLog(IRLocalScalar a, FastMathAccuracy accuracy)
+    {
+        if (accuracy == FastMathAccuracy::exact)
+        {
+            return CallLog(a);
+        }
+        VerifyFastMathArgument(a);
+
+        auto& function = a.function;
+        auto& emitter = function.GetEmitter();
+        auto type = a.value->getType();
+        auto bitsType = GetBitsType(type);
+        const auto& constants = GetFastMathConstants(type);
+        const auto one = Constant(a, 1.0);
+
+        // x = 2^e m, where m is in [1, 2)
+        IRLocalScalar bits{ function, function.BitCast(a, bitsType) };
+        auto mantissaBits = IntegerConstant(function, bitsType, constants.mantissaBits);
+        auto exponent = IRLocalScalar{ function, function.Operator(TypedOperator::logicalShiftRight, bits, mantissaBits) } - IntegerConstant(function, bitsType, constants.exponentBias);
+        auto mantissaMask = IntegerConstant(function, bitsType, (int64_t{ 1 } << constants.mantissaBits) - 1);
+        auto oneBits = IntegerConstant(function, bitsType, int64_t{ constants.exponentBias } << constants.mantissaBits);
+        IRLocalScalar m{ function, function.BitCast((bits & mantissaMask) | oneBits, type) };
+
+        // move m to [sqrt(1/2), sqrt(2)), where the series converges quickly
+        auto isLarge = m > Constant(a, 1.4142135623730951);
+        m = Select(isLarge, m * Constant(a, 0.5), m);
+        exponent = exponent + Select(isLarge, IntegerConstant(function, bitsType, 1), IntegerConstant(function, bitsType, 0));
+        IRLocalScalar e{ function, emitter.CastIntToFloat(exponent, type, true) };
+
+        // log(x) = e ln(2) + 2 atanh((m - 1) / (m + 1))
+        auto s = (m - one) / (m + one);
+        auto result = e * Constant(a, constants.ln2High) + (s * Polynomial(s * s, GetLogCoefficients(type, accuracy)) + e * Constant(a, constants.ln2Low));
+
+        // log(0) = -infinity, log(x < 0) = NaN, and log(infinity) = infinity
+        const auto infinity = Constant(a, std::numeric_limits<double>::infinity());
+        auto special = Select(a < Constant(a, 0.0), Constant(a, std::numeric_limits<double>::quiet_NaN()), -infinity);
+        result = Select(a < Constant(a, constants.minNormal), special, result);
+        return Select(a == infinity, infinity, result);
+    }
+
+    IRLocalScalar FastTanh(IRLocalScalar a, FastMathAccuracy accuracy)
+    {
+        if (accuracy == FastMathAccuracy::exact)
+        {
+            return CallTanh(a);
+        }
+        VerifyFastMathArgument(a);
+
+        const auto zero = Constant(a, 0.0);
+        const auto one = Constant(a, 1.0);
+
+        // near 0, tanh(x) = x + x^3 P(x^2): Cephes' tanhf polynomial for |x| < 0.625, or the Taylor series for doubles
+        // (below 0.15, where 1 - 2 / (e^2x + 1) loses more than a few bits to cancellation)
+        auto useTaylorSeries = accuracy == FastMathAccuracy::high && a.value->getType()->getScalarType()->isDoubleTy();
+        auto threshold = useTaylorSeries ? 0.15 : 0.625;
+        auto coefficients = useTaylorSeries ? std::vector<double>{ -929569.0 / 638512875, 21844.0 / 6081075, -1382.0 / 155925, 62.0 / 2835, -17.0 / 315, 2.0 / 15, -1.0 / 3 }
+                                            : std::vector<double>{ -5.70498872745e-3, 2.06390887954e-2, -5.37397155531e-2, 1.33314422036e-1, -3.33332819422e-1 };
+        auto x2 = a * a;
+        auto small = a + a * x2 * Polynomial(x2, coefficients);
+
+        // tanh(|x|) = 1 - 2 / (e^2|x| + 1), which is 1 when e^2|x| overflows
+        auto absA = Select(a < zero, -a, a);
+        auto large = one - Constant(a, 2.0) / (FastExp(absA + absA, accuracy) + one);
+        large = Select(a < zero, -large, large);
+        return Select(absA < Constant(a, threshold), small, large);
+    }
+
+    IRLocalScalar FastSigmoid(IRLocalScalar a, FastMathAccuracy accuracy)
+    {
+        if (accuracy == FastMathAccuracy::exact)
+        {
+            return StableSigmoid(a);
+        }
+        VerifyFastMathArgument(a);
+
+        // e^-x overflows to infinity for very negative x, making the result 0
+        const auto one = Constant(a, 1.0);
+        return one / (one + FastExp(-a, accuracy));
+    }
+
     IRLocalScalar Min(IRLocalScalar a, IRLocalScalar b)
     {
         detail::VerifyArgTypesCompatible(a, b);
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRMemoryPlacement.cpp (emitters)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IRMemoryPlacement.h"
+#include "IRModuleEmitter.h"
+#include "IRParallelLoopEmitter.h"
+#include "IRPosixRuntime.h"
+#include "IRRuntime.h"
+#include "LLVMInclude.h"
+#include "TargetDevice.h"
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Module.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace emitters
+{
+    namespace
+    {
+        // Pages are assumed to be 4 KB, the smallest size on the targets with huge pages
+        const size_t c_pageSize = 4096;
+
+        // Buffers smaller than this are left where the first thread that writes them puts them
+        const size_t c_firstTouchMinimumSize = 64 * c_pageSize;
+
+        // Linux's MADV_HUGEPAGE
+        const int c_adviceHugePage = 14;
+
+        struct LargeBuffer
+        {
+            llvm::GlobalVariable* global;
+            size_t size;
+        };
+
+        std::vector<LargeBuffer> GetLargeBuffers(IRModuleEmitter& module, size_t minimumSize)
+        {
+            std::vector<LargeBuffer> buffers;
+            for (auto& global : module.GetLLVMModule()->globals())
+            {
+                if (global.isDeclaration() || global.getName().startswith("llvm."))
+                {
+                    continue;
+                }
+
+                auto size = static_cast<size_t>(module.GetIREmitter().SizeOf(global.getValueType()));
+                if (size >= minimumSize)
+                {
+                    buffers.push_back({ &global, size });
+                }
+            }
+            return buffers;
+        }
+
+        // Writes a zero to each page of a zero-initialized buffer, from the thread the static parallel loops give the page to
+        void EmitFirstTouch(IRFunctionEmitter& function, const LargeBuffer& buffer)
+        {
+            auto& context = function.GetLLVMContext();
+            auto pageType = llvm::ArrayType::get(llvm::Type::getInt8Ty(context), c_pageSize);
+            auto numPages = static_cast<int>((buffer.size + c_pageSize - 1) / c_pageSize);
+            auto global = buffer.global;
+            function.ParallelFor(numPages, ParallelLoopOptions(0, ParallelLoopSchedule::staticBlocks), {}, [global, pageType](IRFunctionEmitter& function, IRLocalScalar page, std::vector<LLVMValue>) {
+                auto pages = function.CastPointer(global, pageType->getPointerTo());
+                auto pagePointer = function.CastPointer(function.PointerOffset(pages, page), llvm::Type::getInt8PtrTy(function.GetLLVMContext()));
+
+                // A volatile store, so the optimizer doesn't drop it as a store of the value that's already there
+                function.GetEmitter().GetIRBuilder().CreateStore(llvm::ConstantInt::get(llvm::Type::getInt8Ty(function.GetLLVMContext()), 0), pagePointer, true);
+            });
+        }
+    } // namespace
+
+    bool SupportsHugePages(const TargetDevice& targetDevice)
+    {
+        return targetDevice.IsLinux();
+    }
+
+    void EmitLargeBufferPlacement(IRModuleEmitter& module)
+    {
+        const auto& options = module.GetCompilerOptions();
+        const bool useHugePages = options.useHugePages && SupportsHugePages(options.targetDevice);
+        const bool firstTouch = options.firstTouchBuffers && options.parallelize;
+
+        auto hugePageBuffers = useHugePages ? GetLargeBuffers(module, c_hugePageSize) : std::vector<LargeBuffer>{};
+        std::vector<LargeBuffer> firstTouchBuffers;
+        if (firstTouch)
+        {
+            for (const auto& buffer : GetLargeBuffers(module, c_firstTouchMinimumSize))
+            {
+                if (!buffer.global->isConstant() && buffer.global->getInitializer()->isNullValue())
+                {
+                    firstTouchBuffers.push_back(buffer);
+                }
+            }
+        }
+        if (hugePageBuffers.empty() && firstTouchBuffers.empty())
+        {
+            return;
+        }
+
+        // The huge pages are asked for before the buffers are first touched, so the kernel can allocate them right away
+        auto& function = module.BeginFunction(module.GetModuleName() + "_PlaceLargeBuffers", VariableType::Void);
+        for (const auto& buffer : hugePageBuffers)
+        {
+            buffer.global->setAlignment(c_hugePageSize);
+            auto& posixRuntime = module.GetRuntime().GetPosixEmitter();
+            auto madviseFunction = posixRuntime.GetMadviseFunction();
+            auto sizeType = madviseFunction->getFunctionType()->getParamType(1);
+            function.Call(madviseFunction, { function.CastPointer(buffer.global, llvm::Type::getInt8PtrTy(module.GetLLVMContext())), llvm::ConstantInt::get(sizeType, buffer.size), function.Literal(c_adviceHugePage) });
+        }
+        for (const auto& buffer : firstTouchBuffers)
+        {
+            EmitFirstTouch(function, buffer);
+        }
+        function.Return();
+        module.EndFunction();
+
+        // The thread pool, if the first-touch loops use one, is initialized by an earlier initialization function
+        module.AddInitializationFunction(function);
+    }
+} // namespace emitters
+} // namespace ell
@@ -23,6 +23,7 @@
 #include <llvm/ADT/Triple.h>
 #include <llvm/AsmParser/Parser.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Constants.h>
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/Support/FileSystem.h>
@@ -34,6 +35,10 @@
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/Utils/ModuleUtils.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 namespace ell
 {
 namespace emitters
@@ -41,6 +46,76 @@ namespace emitters
     using namespace utilities::logging;
     using utilities::logging::Log;
 
+    namespace
+    {
+        uint32_t GetFloatBits(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        // Rounds to nearest even. Values too large for half precision saturate to the largest finite value,
+        // and NaNs become 0, because `IRFunctionEmitter::WeightValueAt` only decodes finite values.
+        const float c_halfRoundingLimit = 65520.0f; // the smallest magnitude that rounds past 65504, the largest half-precision value
+        uint16_t FloatToHalfBits(float value)
+        {
+            const auto bits = GetFloatBits(value);
+            const uint16_t sign = (bits >> 16) & 0x8000;
+            const int floatExponent = (bits >> 23) & 0xff;
+            uint32_t mantissa = bits & 0x7fffff;
+            if (floatExponent == 0xff && mantissa != 0)
+            {
+                return 0;
+            }
+
+            const int exponent = floatExponent - 127 + 15;
+            if (exponent >= 31)
+            {
+                return sign | 0x7bff;
+            }
+
+            if (exponent <= 0)
+            {
+                // subnormal half-precision value, or zero
+                if (exponent < -10)
+                {
+                    return sign;
+                }
+                mantissa |= 0x800000;
+                const int shift = 14 - exponent;
+                uint32_t result = mantissa >> shift;
+                const uint32_t remainder = mantissa & ((1u << shift) - 1);
+                const uint32_t halfway = 1u << (shift - 1);
+                if (remainder > halfway || (remainder == halfway && (result & 1)))
+                {
+                    ++result;
+                }
+                return static_cast<uint16_t>(sign | result);
+            }
+
+            uint32_t result = (exponent << 10) | (mantissa >> 13);
+            const uint32_t remainder = mantissa & 0x1fff;
+            if (remainder > 0x1000 || (remainder == 0x1000 && (result & 1)))
+            {
+                ++result; // may carry into the exponent, which is still the correctly-rounded value
+            }
+            return static_cast<uint16_t>(sign | std::min<uint32_t>(result, 0x7bff));
+        }
+
+        // Rounds to nearest even
+        uint16_t FloatToBFloat16Bits(float value)
+        {
+            const auto bits = GetFloatBits(value);
+            if ((bits & 0x7fffffff) > 0x7f800000)
+            {
+                return 0; // NaN
+            }
+            const uint32_t rounding = 0x7fff + ((bits >> 16) & 1);
+            return static_cast<uint16_t>((bits + rounding) >> 16);
+        }
+    } // namespace
+
     //
     // Constructors
     //
@@ -87,6 +162,17 @@ namespace emitters
     void IRModuleEmitter::CompleteCompilerOptions(CompilerOptions& parameters)
     {
         CompleteTargetDevice(parameters.targetDevice);
+
+        if (parameters.targetDevice.IsWebAssembly())
+        {
+            // A WebAssembly module can't start threads or call BLAS, and its SIMD registers hold 4 floats
+            parameters.parallelize = false;
+            parameters.useSharedRuntime = false;
+            parameters.useBlas = false;
+            parameters.useGpu = false;
+            parameters.allowVectorInstructions = true;
+            parameters.vectorWidth = 4;
+        }
     }
 
     //
@@ -102,14 +188,20 @@ namespace emitters
         auto context = function.GetFunctionArgument("context");
         auto globalContext = GlobalPointer(GetModuleName() + "_context", emitters::VariableType::Byte);
         function.Store(globalContext, context);
+
+        _threadPool.BeginHotRegion(function);
     }
 
     void IRModuleEmitter::EndMapPredictFunction()
     {
+        // The predict function of a reentrant model takes a pointer to the model state, and so does the reset function
+        auto predictFunction = GetCurrentFunction().GetFunction();
+        bool hasState = std::any_of(predictFunction->arg_begin(), predictFunction->arg_end(), [](const llvm::Argument& arg) { return arg.getName() == "state"; });
+        _threadPool.EndHotRegion(GetCurrentFunction());
         EndFunction();
 
         // now generate the public reset function that combines all the node level reset functions.
-        IRFunctionEmitter& resetFunction = BeginFunction(GetModuleName() + "_Reset", VariableType::Void);
+        IRFunctionEmitter& resetFunction = hasState ? BeginFunction(GetModuleName() + "_Reset", VariableType::Void, NamedVariableTypeList{ { "state", VariableType::VoidPointer } }) : BeginFunction(GetModuleName() + "_Reset", VariableType::Void);
         resetFunction.IncludeInHeader();
         for (auto name : _resetFunctions)
         {
@@ -413,6 +505,63 @@ namespace emitters
         return pVal;
     }
 
+    LLVMValue IRModuleEmitter::EmitGlobalVectorInBuffer(Variable& var, llvm::GlobalVariable* buffer, size_t byteOffset)
+    {
+        if (var.Scope() != VariableScope::global || !var.IsVector())
+        {
+            throw EmitterException(EmitterError::variableScopeNotSupported, "Only global vector variables can be placed in a buffer");
+        }
+
+        AllocateVariable(var);
+        auto& currentFunction = GetCurrentFunction();
+        LLVMValue pVal = nullptr;
+        {
+            IRFunctionEmitter::EntryBlockScope scope(currentFunction);
+            auto pData = _emitter.PointerOffset(buffer, _emitter.Literal(static_cast<int>(byteOffset)));
+            pVal = _emitter.CastPointer(pData, _emitter.PointerType(var.Type()));
+        }
+        _globals.Add(var.EmittedName(), pVal);
+        return pVal;
+    }
+
+    LLVMValue IRModuleEmitter::EmitGlobalVectorAsView(Variable& var, LLVMValue pData, int elementOffset)
+    {
+        if (var.Scope() != VariableScope::global || !var.IsVector())
+        {
+            throw EmitterException(EmitterError::variableScopeNotSupported, "Only global vector variables can be views of other vectors");
+        }
+
+        AllocateVariable(var);
+        auto& currentFunction = GetCurrentFunction();
+        LLVMValue pVal = nullptr;
+        {
+            IRFunctionEmitter::EntryBlockScope scope(currentFunction);
+            pVal = _emitter.CastPointer(currentFunction.PointerOffset(pData, elementOffset), _emitter.PointerType(var.Type()));
+        }
+        _globals.Add(var.EmittedName(), pVal);
+        return pVal;
+    }
+
+    LLVMValue IRModuleEmitter::EmitGlobalVectorAtPointer(Variable& var, llvm::GlobalVariable* pointer, size_t byteOffset)
+    {
+        if (var.Scope() != VariableScope::global || !var.IsVector())
+        {
+            throw EmitterException(EmitterError::variableScopeNotSupported, "Only global vector variables can be placed in a buffer");
+        }
+
+        AllocateVariable(var);
+        auto& currentFunction = GetCurrentFunction();
+        LLVMValue pVal = nullptr;
+        {
+            IRFunctionEmitter::EntryBlockScope scope(currentFunction);
+            auto pBuffer = _emitter.Load(pointer);
+            auto pData = _emitter.PointerOffset(pBuffer, _emitter.Literal(static_cast<int>(byteOffset)));
+            pVal = _emitter.CastPointer(pData, _emitter.PointerType(var.Type()));
+        }
+        _globals.Add(var.EmittedName(), pVal);
+        return pVal;
+    }
+
     //
     // Variable and Constant creation
     //
@@ -466,6 +615,28 @@ namespace emitters
         return llvm::cast<llvm::GlobalVariable>(global);
     }
 
+    llvm::GlobalVariable* IRModuleEmitter::ReducedPrecisionArray(const std::string& name, const std::vector<float>& values, WeightStorageType storageType)
+    {
+        std::vector<uint16_t> bits(values.size());
+        std::transform(values.begin(), values.end(), bits.begin(), storageType == WeightStorageType::float16 ? FloatToHalfBits : FloatToBFloat16Bits);
+
+        auto numNaNs = std::count_if(values.begin(), values.end(), [](float value) { return std::isnan(value); });
+        auto numSaturated = storageType != WeightStorageType::float16 ? 0 : std::count_if(values.begin(), values.end(), [](float value) { return std::abs(value) >= c_halfRoundingLimit; });
+        if (numNaNs > 0 || numSaturated > 0)
+        {
+            Log() << "Storing " << name << " as " << ToString(storageType) << " changed " << numNaNs << " NaN weights to 0 and saturated " << numSaturated << " weights to +/-65504" << EOL;
+        }
+
+        // Half-precision weights are typed as such in the IR; bfloat16 weights are stored as raw 16-bit integers
+        if (storageType == WeightStorageType::float16)
+        {
+            auto type = llvm::ArrayType::get(llvm::Type::getHalfTy(*_llvmContext), bits.size());
+            return AddGlobal(name, type, llvm::ConstantDataArray::getFP(*_llvmContext, bits), true);
+        }
+        auto type = _emitter.ArrayType(VariableType::Int16, bits.size());
+        return AddGlobal(name, type, llvm::ConstantDataArray::get(*_llvmContext, bits), true);
+    }
+
     //
     // Functions
     //
@@ -664,7 +835,7 @@ namespace emitters
     // Code output / input
     //
 
-    void IRModuleEmitter::WriteToFile(const std::string& filePath, ModuleOutputFormat format)
+    MachineCodeOutputOptions IRModuleEmitter::GetFileOutputOptions()
     {
         MachineCodeOutputOptions options;
         auto compilerOptions = GetCompilerOptions();
@@ -683,12 +854,17 @@ namespace emitters
         else
         {
             // 'auto'
-            options.relocModel = compilerOptions.targetDevice.IsWindows() ? OutputRelocationModel::Static : OutputRelocationModel::PIC_;
+            options.relocModel = (compilerOptions.targetDevice.IsWindows() || compilerOptions.targetDevice.IsWebAssembly()) ? OutputRelocationModel::Static : OutputRelocationModel::PIC_;
         }
 
         // Other params to possibly set:
         //   FloatABIType floatABI = FloatABIType::Default;
+        return options;
+    }
 
+    void IRModuleEmitter::WriteToFile(const std::string& filePath, ModuleOutputFormat format)
+    {
+        auto options = GetFileOutputOptions();
         switch (format)
         {
         case ModuleOutputFormat::assembly:
@@ -794,6 +970,11 @@ namespace emitters
         GenerateMachineCode(os, *this, format, options);
     }
 
+    std::map<std::string, size_t> IRModuleEmitter::GetFunctionCodeSizes()
+    {
+        return emitters::GetFunctionCodeSizes(*this, GetFileOutputOptions());
+    }
+
     void IRModuleEmitter::LoadIR(const std::string& text)
     {
         llvm::MemoryBufferRef buffer(text, "<string>"); // See Parser.cpp in LLVM code base for why...
@@ -905,7 +1086,7 @@ namespace emitters
             return nullptr;
         }
 
-        auto relocModel = parameters.targetDevice.IsWindows() ? OutputRelocationModel::Static : OutputRelocationModel::PIC_;
+        auto relocModel = (parameters.targetDevice.IsWindows() || parameters.targetDevice.IsWebAssembly()) ? OutputRelocationModel::Static : OutputRelocationModel::PIC_;
         const llvm::TargetOptions options;
         const llvm::CodeModel::Model codeModel = llvm::CodeModel::Small;
         return target->createTargetMachine(parameters.targetDevice.triple,
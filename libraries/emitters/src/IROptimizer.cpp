@@ -7,29 +7,146 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "IROptimizer.h"
+#include "EmitterException.h"
 #include "IRModuleEmitter.h"
 #include "LLVMInclude.h"
 
+#include <utilities/include/Logger.h>
+#include <utilities/include/PhaseTimer.h>
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/Module.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
 #include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #include <llvm/Transforms/Scalar.h>
 #include <llvm/Transforms/Scalar/GVN.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
+#include <algorithm>
+#include <future>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace ell
 {
 namespace emitters
 {
     using namespace llvm;
+    using namespace utilities::logging;
+    using utilities::logging::Log;
+
+    namespace
+    {
+        // The string attribute that records that a function's optimization attributes were chosen for it
+        const char* c_optimizationAttributeName = "ell-optimization";
+
+        void RemoveSizeAttributes(llvm::Function& function)
+        {
+            function.removeFnAttr(llvm::Attribute::OptimizeForSize);
+            function.removeFnAttr(llvm::Attribute::MinSize);
+        }
+
+        void MarkNoInline(llvm::Function& function)
+        {
+            function.removeFnAttr(llvm::Attribute::AlwaysInline);
+            function.addFnAttr(llvm::Attribute::NoInline);
+        }
+
+        // optnone can't be combined with alwaysinline, optsize or minsize
+        void MarkUnoptimized(llvm::Function& function)
+        {
+            RemoveSizeAttributes(function);
+            MarkNoInline(function);
+            function.addFnAttr(llvm::Attribute::OptimizeNone);
+        }
+
+        // Marks the functions it reaches after a deadline `optnone`, so the rest of the passes skip them
+        class OptimizationDeadlinePass : public llvm::FunctionPass
+        {
+        public:
+            static char ID;
+
+            OptimizationDeadlinePass(const std::chrono::steady_clock::time_point& deadline, size_t& numUnoptimizedFunctions) :
+                llvm::FunctionPass(ID),
+                _deadline(deadline),
+                _numUnoptimizedFunctions(numUnoptimizedFunctions)
+            {
+            }
+
+            bool runOnFunction(llvm::Function& function) override
+            {
+                if (function.hasFnAttribute(llvm::Attribute::OptimizeNone) || std::chrono::steady_clock::now() < _deadline)
+                {
+                    return false;
+                }
+                MarkUnoptimized(function);
+                ++_numUnoptimizedFunctions;
+                return true;
+            }
+
+            void getAnalysisUsage(llvm::AnalysisUsage& usage) const override { usage.setPreservesAll(); }
+
+            llvm::StringRef getPassName() const override { return "ELL optimization deadline"; }
+
+        private:
+            const std::chrono::steady_clock::time_point& _deadline;
+            size_t& _numUnoptimizedFunctions;
+        };
+
+        char OptimizationDeadlinePass::ID = 0;
+    } // namespace
+
+    void SetOptimizationAttributes(llvm::Function& function, const CompilerOptions& options)
+    {
+        function.removeFnAttr(llvm::Attribute::OptimizeNone);
+        RemoveSizeAttributes(function);
+        if (options.optimizationLevel <= 0)
+        {
+            MarkUnoptimized(function);
+        }
+        else
+        {
+            if (options.sizeOptimization != SizeOptimization::speed)
+            {
+                function.addFnAttr(llvm::Attribute::OptimizeForSize);
+            }
+            if (options.sizeOptimization == SizeOptimization::minSize)
+            {
+                function.addFnAttr(llvm::Attribute::MinSize);
+            }
+            if (!options.allowInlining)
+            {
+                MarkNoInline(function);
+            }
+        }
+        function.addFnAttr(c_optimizationAttributeName, ToString(options.sizeOptimization));
+    }
 
     IROptimizer::IROptimizer(IRModuleEmitter& module) :
-        _module(module),
-        _functionPasses(module.GetLLVMModule())
+        IROptimizer(*module.GetLLVMModule(), module.GetTargetMachine(), module.GetCompilerOptions())
     {
     }
 
+    IROptimizer::IROptimizer(llvm::Module& module, llvm::TargetMachine* targetMachine, const CompilerOptions& options) :
+        _targetMachine(targetMachine),
+        _options(options),
+        _deadline(std::chrono::steady_clock::time_point::max()),
+        _functionPasses(&module)
+    {
+        if (options.maxOptimizationSeconds > 0)
+        {
+            _deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.maxOptimizationSeconds));
+        }
+    }
+
     IROptimizer::~IROptimizer()
     {
         (void)_functionPasses.doFinalization();
@@ -39,33 +156,268 @@ namespace emitters
     {
         _functionPasses.add(llvm::createVerifierPass());
 
-        auto targetMachine = _module.GetTargetMachine();
+        // The levels are the ones clang uses for -O0 to -O3, -Os and -Oz
         llvm::PassManagerBuilder builder;
-        builder.OptLevel = 3;
-        builder.SizeLevel = 0;
-        builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, builder.SizeLevel, false);
-        builder.LoopVectorize = true;
-        builder.SLPVectorize = true;
-        builder.populateFunctionPassManager(_functionPasses);
-        builder.populateModulePassManager(_modulePasses);
+        builder.OptLevel = static_cast<unsigned>(std::clamp(_options.optimizationLevel, 0, 3));
+        builder.SizeLevel = static_cast<unsigned>(_options.sizeOptimization);
+        if (_options.allowInlining && builder.OptLevel > 0)
+        {
+            builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, builder.SizeLevel, false);
+        }
+        else
+        {
+            builder.Inliner = llvm::createAlwaysInlinerLegacyPass();
+        }
+        builder.LoopVectorize = builder.OptLevel > 1 && _options.sizeOptimization != SizeOptimization::minSize;
+        builder.SLPVectorize = builder.LoopVectorize;
 
-        (void)_functionPasses.doInitialization();
+        if (_options.maxOptimizationSeconds > 0)
+        {
+            // Check the time early in the simplification of each function, and again before vectorization
+            auto addDeadlinePass = [this](const llvm::PassManagerBuilder&, llvm::legacy::PassManagerBase& passes) {
+                passes.add(new OptimizationDeadlinePass(_deadline, _numUnoptimizedFunctions));
+            };
+            builder.addExtension(llvm::PassManagerBuilder::EP_Peephole, addDeadlinePass);
+            builder.addExtension(llvm::PassManagerBuilder::EP_VectorizerStart, addDeadlinePass);
+        }
 
-        if (targetMachine)
+        if (_targetMachine)
         {
-            targetMachine->adjustPassManager(builder);
+            _targetMachine->adjustPassManager(builder);
         }
+
+        builder.populateFunctionPassManager(_functionPasses);
+        builder.populateModulePassManager(_modulePasses);
+
+        (void)_functionPasses.doInitialization();
     }
 
     void IROptimizer::OptimizeFunction(LLVMFunction pFunction)
     {
         assert(pFunction != nullptr);
+        if (pFunction->isDeclaration())
+        {
+            return;
+        }
+
+        if (!pFunction->hasFnAttribute(c_optimizationAttributeName))
+        {
+            SetOptimizationAttributes(*pFunction, _options);
+        }
+        if (std::chrono::steady_clock::now() >= _deadline && !pFunction->hasFnAttribute(llvm::Attribute::OptimizeNone))
+        {
+            MarkUnoptimized(*pFunction);
+            ++_numUnoptimizedFunctions;
+            return;
+        }
+
+        utilities::PhaseTimer timer("Function passes");
         _functionPasses.run(*pFunction);
     }
 
     void IROptimizer::OptimizeModule(llvm::Module* pModule)
     {
+        utilities::PhaseTimer timer("Module passes");
         _modulePasses.run(*pModule);
+        if (_numUnoptimizedFunctions > 0)
+        {
+            Log() << "Optimization time ran out, " << _numUnoptimizedFunctions << " functions were left unoptimized" << EOL;
+        }
+    }
+
+    namespace
+    {
+        // Constant global variables up to this size are copied into every partition, so their values can be folded
+        const uint64_t c_maxCopiedConstantSize = 1024;
+
+        using Bitcode = llvm::SmallVector<char, 0>;
+
+        Bitcode WriteBitcode(const llvm::Module& module)
+        {
+            Bitcode result;
+            llvm::raw_svector_ostream stream(result);
+            llvm::WriteBitcodeToFile(module, stream);
+            return result;
+        }
+
+        std::unique_ptr<llvm::Module> ReadBitcode(const Bitcode& bitcode, llvm::LLVMContext& context)
+        {
+            auto buffer = llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), "partition");
+            auto module = llvm::parseBitcodeFile(buffer, context);
+            if (!module)
+            {
+                throw EmitterException(EmitterError::unexpected, "Failed to read partition of module: " + llvm::toString(module.takeError()));
+            }
+            return std::move(module.get());
+        }
+
+        // Assigns each function with a body to a partition, largest functions first, each going to the partition
+        // with the fewest instructions so far
+        std::unordered_map<const llvm::GlobalValue*, int> AssignPartitions(llvm::Module& module, int numPartitions)
+        {
+            std::vector<std::pair<unsigned, const llvm::Function*>> functions;
+            for (const auto& function : module)
+            {
+                if (!function.isDeclaration())
+                {
+                    functions.emplace_back(function.getInstructionCount(), &function);
+                }
+            }
+            std::stable_sort(functions.begin(), functions.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+            std::unordered_map<const llvm::GlobalValue*, int> result;
+            std::vector<uint64_t> partitionSizes(numPartitions, 0);
+            for (const auto& [size, function] : functions)
+            {
+                auto partition = std::min_element(partitionSizes.begin(), partitionSizes.end()) - partitionSizes.begin();
+                partitionSizes[partition] += size;
+                result[function] = static_cast<int>(partition);
+            }
+            return result;
+        }
+
+        Bitcode ExtractPartition(llvm::Module& module, const std::unordered_map<const llvm::GlobalValue*, int>& partitions, int partition)
+        {
+            const auto& dataLayout = module.getDataLayout();
+            llvm::ValueToValueMapTy valueMap;
+            auto partitionModule = llvm::CloneModule(module, valueMap, [&](const llvm::GlobalValue* value) {
+                if (auto function = llvm::dyn_cast<llvm::Function>(value))
+                {
+                    return partitions.at(function) == partition;
+                }
+                if (auto variable = llvm::dyn_cast<llvm::GlobalVariable>(value))
+                {
+                    return variable->isConstant() && dataLayout.getTypeAllocSize(variable->getValueType()) <= c_maxCopiedConstantSize;
+                }
+                return false;
+            });
+
+            // The module being optimized keeps its own named metadata and appending globals (like llvm.global_ctors),
+            // which linking would otherwise duplicate
+            std::vector<llvm::NamedMDNode*> namedMetadata;
+            for (auto& node : partitionModule->named_metadata())
+            {
+                if (node.getName() != "llvm.module.flags")
+                {
+                    namedMetadata.push_back(&node);
+                }
+            }
+            for (auto node : namedMetadata)
+            {
+                node->eraseFromParent();
+            }
+
+            std::vector<llvm::GlobalVariable*> appendingGlobals;
+            for (auto& global : partitionModule->globals())
+            {
+                if (global.hasAppendingLinkage())
+                {
+                    appendingGlobals.push_back(&global);
+                }
+            }
+            for (auto global : appendingGlobals)
+            {
+                global->eraseFromParent();
+            }
+
+            return WriteBitcode(*partitionModule);
+        }
+
+        Bitcode OptimizePartition(const Bitcode& bitcode, const CompilerOptions& options)
+        {
+            llvm::LLVMContext context;
+            auto module = ReadBitcode(bitcode, context);
+
+            IROptimizer optimizer(*module, nullptr, options);
+            optimizer.AddStandardPasses();
+            for (auto& function : *module)
+            {
+                if (!function.isDeclaration())
+                {
+                    optimizer.OptimizeFunction(&function);
+                }
+            }
+            optimizer.OptimizeModule(module.get());
+            return WriteBitcode(*module);
+        }
+
+        void LinkPartition(llvm::Module& module, const Bitcode& bitcode)
+        {
+            auto partitionModule = ReadBitcode(bitcode, module.getContext());
+
+            // Global variables already in the module stay as they are; the partition's copies become references to them
+            for (auto& global : partitionModule->globals())
+            {
+                if (global.hasInitializer() && module.getNamedValue(global.getName()) != nullptr)
+                {
+                    global.setInitializer(nullptr);
+                    global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+                    global.setComdat(nullptr);
+                }
+            }
+
+            if (llvm::Linker::linkModules(module, std::move(partitionModule), llvm::Linker::Flags::OverrideFromSrc))
+            {
+                throw EmitterException(EmitterError::unexpected, "Failed to link optimized partition of module");
+            }
+        }
+    } // namespace
+
+    void OptimizeModuleInParallel(IRModuleEmitter& moduleEmitter, int numThreads)
+    {
+        auto& module = *moduleEmitter.GetLLVMModule();
+
+        auto numFunctions = std::count_if(module.begin(), module.end(), [](const llvm::Function& function) { return !function.isDeclaration(); });
+        auto numPartitions = static_cast<int>(std::min<int64_t>(numThreads, numFunctions));
+        if (numPartitions <= 1 || module.getNamedMetadata("llvm.dbg.cu") != nullptr)
+        {
+            IROptimizer optimizer(moduleEmitter);
+            optimizer.AddStandardPasses();
+            moduleEmitter.Optimize(optimizer);
+            return;
+        }
+
+        // Symbols local to the module are made visible to the other partitions while they're apart
+        std::vector<std::pair<std::string, llvm::GlobalValue::LinkageTypes>> localSymbols;
+        for (auto& value : module.global_values())
+        {
+            if (value.hasLocalLinkage())
+            {
+                if (!value.hasName())
+                {
+                    value.setName("ell_partition_local");
+                }
+                localSymbols.emplace_back(value.getName().str(), value.getLinkage());
+                value.setLinkage(llvm::GlobalValue::ExternalLinkage);
+                value.setVisibility(llvm::GlobalValue::HiddenVisibility);
+            }
+        }
+
+        auto partitions = AssignPartitions(module, numPartitions);
+        std::vector<std::future<Bitcode>> optimizedPartitions;
+        for (int partition = 0; partition < numPartitions; ++partition)
+        {
+            optimizedPartitions.push_back(std::async(std::launch::async, OptimizePartition, ExtractPartition(module, partitions, partition), moduleEmitter.GetCompilerOptions()));
+        }
+
+        for (auto& optimizedPartition : optimizedPartitions)
+        {
+            LinkPartition(module, optimizedPartition.get());
+        }
+
+        for (const auto& [name, linkage] : localSymbols)
+        {
+            if (auto value = module.getNamedValue(name))
+            {
+                value->setVisibility(llvm::GlobalValue::DefaultVisibility);
+                value->setLinkage(linkage);
+            }
+        }
+
+        // Remove the local functions that were inlined into everything that called them
+        llvm::legacy::PassManager cleanupPasses;
+        cleanupPasses.add(llvm::createGlobalDCEPass());
+        cleanupPasses.run(module);
     }
 } // namespace emitters
 } // namespace ell
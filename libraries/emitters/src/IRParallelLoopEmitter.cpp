@@ -12,12 +12,19 @@
 #include "IRMath.h"
 #include "IRModuleEmitter.h"
 
+#include <algorithm>
 #include <vector>
 
 namespace ell
 {
 namespace emitters
 {
+    namespace
+    {
+        // Marks the functions that run the body of a parallel loop
+        const char* c_parallelTaskAttribute = "ell-parallel-task";
+    } // namespace
+
     IRParallelForLoopEmitter::IRParallelForLoopEmitter(IRFunctionEmitter& functionEmitter) :
         _functionEmitter(functionEmitter) {}
 
@@ -40,34 +47,82 @@ namespace emitters
     {
         auto compilerSettings = _functionEmitter.GetCompilerOptions();
         const int numTasks = options.numTasks == 0 ? compilerSettings.maxThreads : options.numTasks;
-        auto span = end - begin;
-        auto numIterations = (span - 1) / increment + 1;
         // TODO: explicitly check for empty loop?
 
-        auto taskSize = (numIterations - 1) / numTasks + 1;
-        if (compilerSettings.parallelize && numTasks > 1)
+        if (!compilerSettings.parallelize || numTasks <= 1 || IsInParallelLoopBody())
         {
-            auto taskFunction = GetTaskFunction(capturedValues, body);
+            // Emit a normal for loop if we were only going to use 1 parallel task, or if the threads are already busy
+            // with the enclosing parallel loop
+            _functionEmitter.For(begin, end, increment, [capturedValues, body](IRFunctionEmitter& function, LLVMValue i) {
+                body(function, function.LocalScalar(i), capturedValues);
+            });
+            return;
+        }
 
-            std::vector<std::vector<LLVMValue>> taskArgs;
-            for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
-            {
-                auto blockStart = begin + taskIndex * taskSize * increment;
-                auto blockEnd = Min(blockStart + taskSize * increment, end);
-                std::vector<LLVMValue> args{ blockStart, blockEnd, increment };
-                std::copy(capturedValues.begin(), capturedValues.end(), std::back_inserter(args));
-                taskArgs.push_back(args);
-            }
-            auto tasks = _functionEmitter.StartTasks(taskFunction, taskArgs);
-            tasks.WaitAll(_functionEmitter);
+        auto schedule = options.schedule.GetValue(compilerSettings.parallelLoopSchedule);
+        if (schedule == ParallelLoopSchedule::staticBlocks)
+        {
+            EmitStaticLoop(begin, end, increment, numTasks, capturedValues, body);
         }
         else
         {
-            // Emit a normal for loop if we were only going to use 1 parallel task
-            _functionEmitter.For(begin, end, increment, [capturedValues, body](IRFunctionEmitter& function, LLVMValue i) {
-                body(function, function.LocalScalar(i), capturedValues);
-            });
+            auto chunkSize = options.chunkSize > 0 ? options.chunkSize : compilerSettings.parallelLoopChunkSize;
+            EmitScheduledLoop(begin, end, increment, numTasks, schedule, chunkSize, capturedValues, body);
+        }
+    }
+
+    void IRParallelForLoopEmitter::EmitStaticLoop(IRLocalScalar begin, IRLocalScalar end, IRLocalScalar increment, int numTasks, const std::vector<LLVMValue>& capturedValues, BodyFunction body)
+    {
+        auto span = end - begin;
+        auto numIterations = (span - 1) / increment + 1;
+        auto taskSize = (numIterations - 1) / numTasks + 1;
+        auto taskFunction = GetTaskFunction(capturedValues, body);
+
+        std::vector<std::vector<LLVMValue>> taskArgs;
+        for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+        {
+            auto blockStart = begin + taskIndex * taskSize * increment;
+            auto blockEnd = Min(blockStart + taskSize * increment, end);
+            std::vector<LLVMValue> args{ blockStart, blockEnd, increment };
+            std::copy(capturedValues.begin(), capturedValues.end(), std::back_inserter(args));
+            taskArgs.push_back(args);
+        }
+        auto tasks = _functionEmitter.StartTasks(taskFunction, taskArgs);
+        tasks.WaitAll(_functionEmitter);
+    }
+
+    void IRParallelForLoopEmitter::EmitScheduledLoop(IRLocalScalar begin, IRLocalScalar end, IRLocalScalar increment, int numTasks, ParallelLoopSchedule schedule, int chunkSize, const std::vector<LLVMValue>& capturedValues, BodyFunction body)
+    {
+        // The tasks take chunks of iterations from a shared count of the iterations taken so far. We wait for the
+        // tasks to finish before returning, so the count can live on our stack.
+        auto span = end - begin;
+        auto numIterations = (span - 1) / increment + 1;
+        auto nextIteration = _functionEmitter.Variable(VariableType::Int32, "nextIteration");
+        _functionEmitter.Store(nextIteration, _functionEmitter.Literal<int>(0));
+
+        // Without a chunk size, dynamic loops take about 4 chunks per task, which evens out the load without taking
+        // the count too often
+        auto minChunkSize = _functionEmitter.LocalScalar<int32_t>(std::max(chunkSize, 1));
+        if (chunkSize <= 0 && schedule == ParallelLoopSchedule::dynamic)
+        {
+            minChunkSize = Max(numIterations / (4 * numTasks), 1);
+        }
+
+        auto taskFunction = GetScheduledTaskFunction(schedule, numTasks, capturedValues, body);
+        std::vector<std::vector<LLVMValue>> taskArgs;
+        for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+        {
+            std::vector<LLVMValue> args{ begin, end, increment, nextIteration, minChunkSize };
+            std::copy(capturedValues.begin(), capturedValues.end(), std::back_inserter(args));
+            taskArgs.push_back(args);
         }
+        auto tasks = _functionEmitter.StartTasks(taskFunction, taskArgs);
+        tasks.WaitAll(_functionEmitter);
+    }
+
+    bool IRParallelForLoopEmitter::IsInParallelLoopBody() const
+    {
+        return _functionEmitter.GetFunction()->hasFnAttribute(c_parallelTaskAttribute);
     }
 
     IRFunctionEmitter IRParallelForLoopEmitter::GetTaskFunction(const std::vector<LLVMValue>& capturedValues, BodyFunction body)
@@ -80,6 +135,7 @@ namespace emitters
         auto capturedTypes = GetLLVMTypes(capturedValues);
         std::copy(capturedTypes.begin(), capturedTypes.end(), std::back_inserter(argTypes));
         auto taskFunction = _functionEmitter.GetModule().BeginFunction(name, returnType, argTypes);
+        taskFunction.GetFunction()->addFnAttr(c_parallelTaskAttribute);
 
         {
             auto arguments = taskFunction.Arguments().begin();
@@ -102,5 +158,80 @@ namespace emitters
         _functionEmitter.GetModule().EndFunction();
         return taskFunction;
     }
+
+    IRFunctionEmitter IRParallelForLoopEmitter::GetScheduledTaskFunction(ParallelLoopSchedule schedule, int numTasks, const std::vector<LLVMValue>& capturedValues, BodyFunction body)
+    {
+        std::string name = schedule == ParallelLoopSchedule::dynamic ? "parForDynamicTask" : "parForGuidedTask";
+
+        // args = begin, end, increment, pointer to the count of iterations taken, (smallest) chunk size, captured args
+        auto& irEmitter = _functionEmitter.GetModule().GetIREmitter();
+        auto returnType = irEmitter.Type(VariableType::Void);
+        auto argTypes = irEmitter.GetLLVMTypes({ VariableType::Int32, VariableType::Int32, VariableType::Int32, VariableType::Int32Pointer, VariableType::Int32 });
+        auto capturedTypes = GetLLVMTypes(capturedValues);
+        std::copy(capturedTypes.begin(), capturedTypes.end(), std::back_inserter(argTypes));
+        auto taskFunction = _functionEmitter.GetModule().BeginFunction(name, returnType, argTypes);
+        taskFunction.GetFunction()->addFnAttr(c_parallelTaskAttribute);
+
+        {
+            auto arguments = taskFunction.Arguments().begin();
+            auto begin = taskFunction.LocalScalar(&(*arguments++));
+            auto end = taskFunction.LocalScalar(&(*arguments++));
+            auto increment = taskFunction.LocalScalar(&(*arguments++));
+            LLVMValue nextIteration = &(*arguments++);
+            auto minChunkSize = taskFunction.LocalScalar(&(*arguments++));
+            std::vector<LLVMValue> innerCapturedValues;
+            int numCapturedValues = static_cast<int>(capturedValues.size());
+            for (int index = 0; index < numCapturedValues; ++index)
+            {
+                auto capturedValue = &(*arguments++);
+                capturedValue->setName("captured_" + std::to_string(index));
+                innerCapturedValues.push_back(capturedValue);
+            }
+
+            auto boolType = llvm::Type::getInt1Ty(taskFunction.GetLLVMContext());
+            auto numIterations = (end - begin - 1) / increment + 1;
+            auto chunkBeginVar = taskFunction.Variable(VariableType::Int32, "chunkBegin");
+            auto chunkSizeVar = taskFunction.Variable(VariableType::Int32, "chunkSize");
+            auto isRetryingVar = taskFunction.Variable(boolType, "isRetrying");
+            auto isWorkingVar = taskFunction.Variable(boolType, "isWorking");
+            taskFunction.Store(isWorkingVar, taskFunction.TrueBit());
+            taskFunction.While(isWorkingVar, [=](IRFunctionEmitter& taskFunction) {
+                if (schedule == ParallelLoopSchedule::dynamic)
+                {
+                    auto& irBuilder = taskFunction.GetEmitter().GetIRBuilder();
+                    taskFunction.Store(chunkBeginVar, irBuilder.CreateAtomicRMW(llvm::AtomicRMWInst::Add, nextIteration, minChunkSize, llvm::AtomicOrdering::Monotonic));
+                    taskFunction.Store(chunkSizeVar, minChunkSize);
+                }
+                else
+                {
+                    // Take a share of the remaining iterations, and try again if another task took some in the meantime
+                    taskFunction.Store(isRetryingVar, taskFunction.TrueBit());
+                    taskFunction.While(isRetryingVar, [=](IRFunctionEmitter& taskFunction) {
+                        auto& irBuilder = taskFunction.GetEmitter().GetIRBuilder();
+                        auto taken = taskFunction.LocalScalar(irBuilder.CreateLoad(nextIteration, true));
+                        auto chunkSize = Max((numIterations - taken) / (2 * numTasks), minChunkSize);
+                        auto result = irBuilder.CreateAtomicCmpXchg(nextIteration, taken, taken + chunkSize, llvm::AtomicOrdering::Monotonic, llvm::AtomicOrdering::Monotonic);
+                        auto wasTaken = irBuilder.CreateExtractValue(result, 1);
+                        taskFunction.Store(chunkBeginVar, taken);
+                        taskFunction.Store(chunkSizeVar, chunkSize);
+                        taskFunction.Store(isRetryingVar, taskFunction.Operator(TypedOperator::logicalAnd, taskFunction.LogicalNot(wasTaken), taken < numIterations));
+                    });
+                }
+
+                auto chunkBegin = taskFunction.LocalScalar(taskFunction.Load(chunkBeginVar));
+                taskFunction.If(chunkBegin >= numIterations, [isWorkingVar](IRFunctionEmitter& taskFunction) {
+                                taskFunction.Store(isWorkingVar, taskFunction.FalseBit());
+                            })
+                    .Else([=](IRFunctionEmitter& taskFunction) {
+                        auto chunkEnd = Min(chunkBegin + taskFunction.LocalScalar(taskFunction.Load(chunkSizeVar)), numIterations);
+                        taskFunction.For(begin + chunkBegin * increment, begin + chunkEnd * increment, increment, [innerCapturedValues, body](IRFunctionEmitter& taskFunction, LLVMValue i) {
+                            body(taskFunction, taskFunction.LocalScalar(i), innerCapturedValues);
+                        });
+                    });
+            });
+        }
+        _functionEmitter.GetModule().EndFunction();
+        return taskFunction;
+    }
 } // namespace emitters
 } // namespace ell
@@ -80,6 +80,88 @@ namespace emitters
         return GetTimespecType()->getPointerTo();
     }
 
+    //
+    // system calls and file I/O
+    //
+    LLVMFunction IRPosixRuntime::GetSyscallFunction()
+    {
+        auto longType = GetPointerSizedIntType();
+        auto functionType = llvm::FunctionType::get(longType, { longType }, true);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("syscall", functionType));
+    }
+
+    LLVMFunction IRPosixRuntime::GetReadFunction()
+    {
+        auto& context = _module.GetLLVMContext();
+        auto sizeType = GetPointerSizedIntType();
+        auto functionType = llvm::FunctionType::get(sizeType, { GetIntType(), llvm::Type::getInt8PtrTy(context), sizeType }, false);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("read", functionType));
+    }
+
+    LLVMFunction IRPosixRuntime::GetFopenFunction()
+    {
+        auto int8PtrType = llvm::Type::getInt8PtrTy(_module.GetLLVMContext());
+        auto functionType = llvm::FunctionType::get(int8PtrType, { int8PtrType, int8PtrType }, false);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("fopen", functionType));
+    }
+
+    LLVMFunction IRPosixRuntime::GetFprintfFunction()
+    {
+        auto int8PtrType = llvm::Type::getInt8PtrTy(_module.GetLLVMContext());
+        auto functionType = llvm::FunctionType::get(GetIntType(), { int8PtrType, int8PtrType }, true);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("fprintf", functionType));
+    }
+
+    LLVMFunction IRPosixRuntime::GetFcloseFunction()
+    {
+        auto int8PtrType = llvm::Type::getInt8PtrTy(_module.GetLLVMContext());
+        auto functionType = llvm::FunctionType::get(GetIntType(), { int8PtrType }, false);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("fclose", functionType));
+    }
+
+    LLVMFunction IRPosixRuntime::GetOpenFunction()
+    {
+        auto int8PtrType = llvm::Type::getInt8PtrTy(_module.GetLLVMContext());
+        auto functionType = llvm::FunctionType::get(GetIntType(), { int8PtrType, GetIntType() }, true);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("open", functionType));
+    }
+
+    LLVMFunction IRPosixRuntime::GetCloseFunction()
+    {
+        auto functionType = llvm::FunctionType::get(GetIntType(), { GetIntType() }, false);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("close", functionType));
+    }
+
+    LLVMFunction IRPosixRuntime::GetLseekFunction()
+    {
+        // off_t is a long on the targets we support (without large-file support on 32-bit ones)
+        auto offsetType = GetPointerSizedIntType();
+        auto functionType = llvm::FunctionType::get(offsetType, { GetIntType(), offsetType, GetIntType() }, false);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("lseek", functionType));
+    }
+
+    LLVMFunction IRPosixRuntime::GetMmapFunction()
+    {
+        auto int8PtrType = llvm::Type::getInt8PtrTy(_module.GetLLVMContext());
+        auto sizeType = GetPointerSizedIntType();
+        auto functionType = llvm::FunctionType::get(int8PtrType, { int8PtrType, sizeType, GetIntType(), GetIntType(), GetIntType(), sizeType }, false);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("mmap", functionType));
+    }
+
+    LLVMFunction IRPosixRuntime::GetMunmapFunction()
+    {
+        auto int8PtrType = llvm::Type::getInt8PtrTy(_module.GetLLVMContext());
+        auto functionType = llvm::FunctionType::get(GetIntType(), { int8PtrType, GetPointerSizedIntType() }, false);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("munmap", functionType));
+    }
+
+    LLVMFunction IRPosixRuntime::GetMadviseFunction()
+    {
+        auto int8PtrType = llvm::Type::getInt8PtrTy(_module.GetLLVMContext());
+        auto functionType = llvm::FunctionType::get(GetIntType(), { int8PtrType, GetPointerSizedIntType(), GetIntType() }, false);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("madvise", functionType));
+    }
+
     //
     // pthreads -- types
     //
@@ -498,6 +580,31 @@ namespace emitters
         return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("pthread_spin_destroy", functionType));
     }
 
+    LLVMFunction IRPosixRuntime::GetPthreadSetAffinityFunction()
+    {
+        assert(_module.GetCompilerOptions().targetDevice.IsLinux() && "pthread_setaffinity_np only available on Linux");
+
+        // Signature: int pthread_setaffinity_np(pthread_t thread, size_t cpusetsize, const cpu_set_t* cpuset);
+        auto intType = GetIntType();
+        auto sizeType = GetPointerSizedIntType();
+        auto cpuSetPtrType = GetCpuSetWordType()->getPointerTo();
+        auto functionType = llvm::FunctionType::get(intType, { GetPthreadType(), sizeType, cpuSetPtrType }, false);
+        return static_cast<LLVMFunction>(_module.GetLLVMModule()->getOrInsertFunction("pthread_setaffinity_np", functionType));
+    }
+
+    LLVMType IRPosixRuntime::GetCpuSetWordType()
+    {
+        // glibc defines cpu_set_t as an array of `unsigned long`
+        return GetPointerSizedIntType();
+    }
+
+    int IRPosixRuntime::GetCpuSetNumWords()
+    {
+        // glibc's cpu_set_t holds a 1024-bit mask (__CPU_SETSIZE)
+        const int cpuSetSize = 1024;
+        return cpuSetSize / static_cast<int>(GetCpuSetWordType()->getPrimitiveSizeInBits());
+    }
+
     // Signature: int pthread_once(pthread_once_t * once_init, void (*init_routine)(void)));
 } // namespace emitters
 } // namespace ell
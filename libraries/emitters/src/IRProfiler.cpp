@@ -9,6 +9,7 @@
 #include "IRProfiler.h"
 #include "EmitterException.h"
 #include "IRFunctionEmitter.h"
+#include "IRMath.h"
 #include "IRMetadata.h"
 #include "IRModuleEmitter.h"
 #include "LLVMUtilities.h"
@@ -31,9 +32,25 @@ namespace emitters
         {
             count = 0,
             totalTime = 1,
-            name = 2
+            name = 2,
+            firstHardwareCounter = 3 // followed by the rest of the counters, in HardwareCounter order
+        };
+
+        size_t GetHardwareCounterField(int counterIndex)
+        {
+            return static_cast<size_t>(RegionInfoFields::firstHardwareCounter) + counterIndex;
+        }
+
+        enum class TraceEventFields
+        {
+            name = 0,
+            startTime = 1,
+            endTime = 2
         };
-    }
+
+        // The number of events each thread's trace buffer holds. Once it's full, new events overwrite the oldest ones.
+        const int c_traceEventsPerThread = 2048;
+    } // namespace
 
     //
     // IRProfileRegionBlock
@@ -106,6 +123,15 @@ namespace emitters
         CreateStructTypes();
         CreateRegionData();
         EmitProfilerFunctions();
+
+        _tracingEnabled = _module->GetCompilerOptions().traceExecution;
+        if (_tracingEnabled)
+        {
+            CreateTraceData();
+            EmitRecordTraceEventFunction();
+            EmitWriteProfileTraceFunction();
+            EmitResetProfileTraceFunction();
+        }
     }
 
     std::string IRProfiler::GetGetNumRegionsFunctionName() const
@@ -123,6 +149,16 @@ namespace emitters
         return GetNamespacePrefix() + "_ResetRegionProfilingInfo";
     }
 
+    std::string IRProfiler::GetWriteProfileTraceFunctionName() const
+    {
+        return GetNamespacePrefix() + "_WriteProfileTrace";
+    }
+
+    std::string IRProfiler::GetResetProfileTraceFunctionName() const
+    {
+        return GetNamespacePrefix() + "_ResetProfileTrace";
+    }
+
     std::string IRProfiler::GetNamespacePrefix() const
     {
         return _module->GetModuleName();
@@ -139,6 +175,11 @@ namespace emitters
         return function.LocalScalar(time);
     }
 
+    bool IRProfiler::IsHardwareCountingEnabled() const
+    {
+        return _module->GetCompilerOptions().profileHardwareCounters;
+    }
+
     void IRProfiler::InitRegion(IRProfileRegion& region, const std::string& desiredName)
     {
         if (!_profilingEnabled)
@@ -146,6 +187,7 @@ namespace emitters
 
         auto regionName = GetUniqueRegionName(desiredName);
         _regionNames.insert(regionName);
+        region.SetName(regionName);
 
         auto& function = region.GetFunction();
         auto regionPtr = GetRegionPointer(function, region.GetIndex());
@@ -166,6 +208,13 @@ namespace emitters
         auto startTime = GetCurrentTime(function);
         region.SetStartTime(startTime);
 
+        if (IsHardwareCountingEnabled())
+        {
+            auto startCounters = function.Variable(VariableType::Int64, NumHardwareCounters);
+            function.GetModule().GetRuntime().ReadHardwareCounters(function, startCounters);
+            region.SetStartCounters(startCounters);
+        }
+
         // Increment visit count
         auto regionPtr = GetRegionPointer(function, region.GetIndex());
         auto countPtr = function.GetStructFieldPointer(regionPtr, static_cast<size_t>(RegionInfoFields::count));
@@ -187,6 +236,21 @@ namespace emitters
         auto storedTime = function.LocalArray(timePtr);
         storedTime[0] = storedTime[0] + newTime;
 
+        if (IsHardwareCountingEnabled())
+        {
+            auto startCounters = function.LocalArray(region.GetStartCounters());
+            auto endCounters = function.LocalArray(function.Variable(VariableType::Int64, NumHardwareCounters));
+            function.GetModule().GetRuntime().ReadHardwareCounters(function, endCounters);
+            for (int counterIndex = 0; counterIndex < NumHardwareCounters; ++counterIndex)
+            {
+                auto storedCount = function.LocalArray(function.GetStructFieldPointer(regionPtr, GetHardwareCounterField(counterIndex)));
+                storedCount[0] = storedCount[0] + (endCounters[counterIndex] - startCounters[counterIndex]);
+            }
+            region.SetStartCounters(nullptr);
+        }
+
+        EndTraceEvent(function, region.GetName(), startTime);
+
         // reset start time to "unassigned"
         region.SetStartTime(function.LocalScalar());
     }
@@ -202,6 +266,10 @@ namespace emitters
         auto timePtr = function.GetStructFieldPointer(regionPtr, static_cast<size_t>(RegionInfoFields::totalTime));
         function.StoreZero(countPtr);
         function.StoreZero(timePtr);
+        for (int counterIndex = 0; counterIndex < NumHardwareCounters; ++counterIndex)
+        {
+            function.StoreZero(function.GetStructFieldPointer(regionPtr, GetHardwareCounterField(counterIndex)));
+        }
     }
 
     std::string IRProfiler::GetUniqueRegionName(const std::string& desiredName) const
@@ -239,7 +307,14 @@ namespace emitters
         auto int8PtrType = llvm::Type::getInt8PtrTy(context);
 
         // ProfileRegionInfo struct fields
-        emitters::NamedLLVMTypeList infoFields = { { "count", int64Type }, { "totalTime", doubleType }, { "name", int8PtrType } };
+        emitters::NamedLLVMTypeList infoFields = { { "count", int64Type },
+                                                   { "totalTime", doubleType },
+                                                   { "name", int8PtrType },
+                                                   { "cycles", int64Type },
+                                                   { "instructions", int64Type },
+                                                   { "l1DataCacheMisses", int64Type },
+                                                   { "lastLevelCacheMisses", int64Type },
+                                                   { "branchMisses", int64Type } };
         _profileRegionType = _module->GetOrCreateStruct(GetNamespacePrefix() + "_ProfileRegionInfo", infoFields);
         _module->IncludeTypeInHeader(_profileRegionType->getName());
     }
@@ -255,6 +330,10 @@ namespace emitters
         EmitGetNumRegionsFunction();
         EmitGetRegionProfilingInfoFunction();
         EmitResetRegionProfilingInfoFunction();
+        if (_module->GetCompilerOptions().useSharedRuntime)
+        {
+            EmitSharedRuntimeRegistration();
+        }
     }
 
     void IRProfiler::CreateRegionData()
@@ -377,6 +456,193 @@ namespace emitters
         _module->EndFunction();
     }
 
+    void IRProfiler::EmitSharedRuntimeRegistration()
+    {
+        // Add the profiler to the shared runtime's registry when the module is loaded, and remove it when it's unloaded
+        auto int8PtrType = llvm::Type::getInt8PtrTy(_module->GetLLVMContext());
+        auto getRegionProfilingInfoFunction = _module->GetFunction(GetGetRegionProfilingInfoFunctionName());
+        auto resetRegionProfilingInfoFunction = _module->GetFunction(GetResetRegionProfilingInfoFunctionName());
+
+        auto registerFunction = _module->BeginFunction(GetNamespacePrefix() + "_RegisterProfiler", VariableType::Void);
+        {
+            auto moduleName = registerFunction.Literal(GetNamespacePrefix());
+            registerFunction.Call(_module->GetRuntime().GetSharedRuntimeRegisterProfilerFunction(),
+                                  { moduleName,
+                                    registerFunction.BitCast(_getNumRegionsFunction, int8PtrType),
+                                    registerFunction.BitCast(getRegionProfilingInfoFunction, int8PtrType),
+                                    registerFunction.BitCast(resetRegionProfilingInfoFunction, int8PtrType) });
+        }
+        _module->EndFunction();
+        _module->AddInitializationFunction(registerFunction);
+
+        auto unregisterFunction = _module->BeginFunction(GetNamespacePrefix() + "_UnregisterProfiler", VariableType::Void);
+        {
+            unregisterFunction.Call(_module->GetRuntime().GetSharedRuntimeUnregisterProfilerFunction(), { unregisterFunction.Literal(GetNamespacePrefix()) });
+        }
+        _module->EndFunction();
+        _module->AddFinalizationFunction(unregisterFunction);
+    }
+
+    //
+    // Trace support
+    //
+    LLVMValue IRProfiler::BeginTraceEvent(IRFunctionEmitter& function)
+    {
+        if (!_tracingEnabled)
+            return nullptr;
+
+        return function.GetModule().GetRuntime().GetCurrentTime(function);
+    }
+
+    void IRProfiler::EndTraceEvent(IRFunctionEmitter& function, const std::string& name, LLVMValue startTime)
+    {
+        if (!_tracingEnabled || startTime == nullptr)
+            return;
+
+        auto endTime = function.GetModule().GetRuntime().GetCurrentTime(function);
+        function.Call(_recordTraceEventFunction, { function.Literal(name), startTime, endTime });
+    }
+
+    void IRProfiler::CreateTraceData()
+    {
+        auto& context = _module->GetLLVMContext();
+        const auto& options = _module->GetCompilerOptions();
+
+        // One slot for each thread pool worker, plus one for the thread calling into the module
+        _numTraceSlots = (options.parallelize && !options.targetDevice.IsWindows()) ? options.maxThreads + 1 : 1;
+
+        auto doubleType = llvm::Type::getDoubleTy(context);
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+        emitters::NamedLLVMTypeList eventFields = { { "name", int8PtrType }, { "startTime", doubleType }, { "endTime", doubleType } };
+        _traceEventType = _module->GetOrCreateStruct(GetNamespacePrefix() + "_TraceEvent", eventFields);
+
+        _traceThreadIds = _module->GlobalArray<int64_t>(GetNamespacePrefix() + "_traceThreadIds", _numTraceSlots);
+        _traceEventCounts = _module->GlobalArray<int64_t>(GetNamespacePrefix() + "_traceEventCounts", _numTraceSlots);
+        _traceEvents = _module->GlobalArray(GetNamespacePrefix() + "_traceEvents", _traceEventType, _numTraceSlots * c_traceEventsPerThread);
+    }
+
+    LLVMValue IRProfiler::EmitGetTraceSlot(IRFunctionEmitter& function)
+    {
+        if (_numTraceSlots == 1)
+        {
+            return function.Literal<int>(0);
+        }
+
+        // Find the slot this thread claimed, or claim the first free one. Slots are never released, so once a thread
+        // sees its own ID in a slot, that slot is its own. If all the slots are taken (e.g., by short-lived threads
+        // started by asynchronous tasks), the thread shares the last one, which is still safe because each event's
+        // position in a buffer is reserved atomically.
+        auto& irBuilder = function.GetEmitter().GetIRBuilder();
+        auto int64Type = llvm::Type::getInt64Ty(function.GetLLVMContext());
+        auto threadId = irBuilder.CreateZExtOrTrunc(function.PthreadSelf(), int64Type);
+        auto zero = function.Literal<int64_t>(0);
+
+        auto slotVar = function.Variable(VariableType::Int32, "traceSlot");
+        function.Store(slotVar, function.Literal<int>(-1));
+        function.For(_numTraceSlots, [this, &irBuilder, threadId, zero, slotVar](IRFunctionEmitter& function, IRLocalScalar slot) {
+            function.If(TypedComparison::lessThan, function.Load(slotVar), function.Literal<int>(0), [this, &irBuilder, threadId, zero, slotVar, slot](IRFunctionEmitter& function) {
+                auto ownerPtr = function.PointerOffset(_traceThreadIds, slot);
+                auto owner = irBuilder.CreateAtomicCmpXchg(ownerPtr, zero, threadId, llvm::AtomicOrdering::Monotonic, llvm::AtomicOrdering::Monotonic);
+                auto previousOwner = irBuilder.CreateExtractValue(owner, 0);
+                auto isFree = function.Comparison(TypedComparison::equals, previousOwner, zero);
+                auto isOurs = function.Comparison(TypedComparison::equals, previousOwner, threadId);
+                function.If(function.Operator(TypedOperator::logicalOr, isFree, isOurs), [slotVar, slot](IRFunctionEmitter& function) {
+                    function.Store(slotVar, slot);
+                });
+            });
+        });
+
+        auto slot = function.Load(slotVar);
+        return function.Select(function.Comparison(TypedComparison::lessThan, slot, function.Literal<int>(0)), function.Literal<int>(_numTraceSlots - 1), slot);
+    }
+
+    void IRProfiler::EmitRecordTraceEventFunction()
+    {
+        auto& context = _module->GetLLVMContext();
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+        auto doubleType = llvm::Type::getDoubleTy(context);
+
+        const emitters::NamedLLVMTypeList parameters = { { "name", int8PtrType }, { "startTime", doubleType }, { "endTime", doubleType } };
+        auto function = _module->BeginFunction(GetNamespacePrefix() + "_RecordTraceEvent", llvm::Type::getVoidTy(context), parameters);
+        {
+            auto& irBuilder = function.GetEmitter().GetIRBuilder();
+            auto slot = EmitGetTraceSlot(function);
+
+            // Reserve the next position in this slot's ring buffer
+            auto eventCountPtr = function.PointerOffset(_traceEventCounts, slot);
+            auto eventNumber = function.LocalScalar(irBuilder.CreateAtomicRMW(llvm::AtomicRMWInst::Add, eventCountPtr, function.Literal<int64_t>(1), llvm::AtomicOrdering::Monotonic));
+            auto slotStart = function.LocalScalar(function.CastValue<int64_t>(slot)) * static_cast<int64_t>(c_traceEventsPerThread);
+            auto eventIndex = slotStart + (eventNumber % static_cast<int64_t>(c_traceEventsPerThread));
+
+            auto eventPtr = function.PointerOffset(_traceEvents, eventIndex);
+            function.Store(function.GetStructFieldPointer(eventPtr, static_cast<size_t>(TraceEventFields::name)), function.GetFunctionArgument("name"));
+            function.Store(function.GetStructFieldPointer(eventPtr, static_cast<size_t>(TraceEventFields::startTime)), function.GetFunctionArgument("startTime"));
+            function.Store(function.GetStructFieldPointer(eventPtr, static_cast<size_t>(TraceEventFields::endTime)), function.GetFunctionArgument("endTime"));
+        }
+        _module->EndFunction();
+        _recordTraceEventFunction = function.GetFunction();
+    }
+
+    void IRProfiler::EmitWriteProfileTraceFunction()
+    {
+        auto& context = _module->GetLLVMContext();
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+        auto& posixRuntime = _module->GetRuntime().GetPosixEmitter();
+        auto fprintfFunction = posixRuntime.GetFprintfFunction();
+
+        const emitters::NamedVariableTypeList parameters = { { "filename", emitters::VariableType::Char8Pointer } };
+        auto function = _module->BeginFunction(GetWriteProfileTraceFunctionName(), VariableType::Int32, parameters);
+        function.IncludeInHeader();
+        function.IncludeInSwigInterface();
+
+        auto resultVar = function.Variable(VariableType::Int32, "result");
+        function.Store(resultVar, function.Literal<int>(-1));
+        auto file = function.Call(posixRuntime.GetFopenFunction(), { function.GetFunctionArgument("filename"), function.Literal("w") });
+        function.If(TypedComparison::notEquals, file, function.NullPointer(int8PtrType), [this, int8PtrType, file, fprintfFunction, resultVar, &posixRuntime](IRFunctionEmitter& function) {
+            auto separatorVar = function.Variable(int8PtrType, "separator");
+            function.Store(separatorVar, function.Literal(""));
+            function.Call(fprintfFunction, { file, function.Literal("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [") });
+
+            // Write each slot's events oldest first, as "complete" events with times in microseconds
+            function.For(_numTraceSlots, [this, file, fprintfFunction, separatorVar](IRFunctionEmitter& function, IRLocalScalar slot) {
+                auto eventCount = function.LocalScalar(function.ValueAt(_traceEventCounts, slot));
+                auto numEvents = Min(eventCount, static_cast<int64_t>(c_traceEventsPerThread));
+                auto firstEvent = eventCount - numEvents;
+                auto slotStart = function.LocalScalar(function.CastValue<int64_t>(slot)) * static_cast<int64_t>(c_traceEventsPerThread);
+                function.For(numEvents, [this, file, fprintfFunction, separatorVar, slot, firstEvent, slotStart](IRFunctionEmitter& function, IRLocalScalar i) {
+                    auto eventIndex = slotStart + ((firstEvent + i) % static_cast<int64_t>(c_traceEventsPerThread));
+                    auto eventPtr = function.PointerOffset(_traceEvents, eventIndex);
+                    auto name = function.Load(function.GetStructFieldPointer(eventPtr, static_cast<size_t>(TraceEventFields::name)));
+                    auto startTime = function.LocalScalar(function.Load(function.GetStructFieldPointer(eventPtr, static_cast<size_t>(TraceEventFields::startTime))));
+                    auto endTime = function.LocalScalar(function.Load(function.GetStructFieldPointer(eventPtr, static_cast<size_t>(TraceEventFields::endTime))));
+                    auto timestamp = startTime * 1000.0;
+                    auto duration = (endTime - startTime) * 1000.0;
+                    function.Call(fprintfFunction, { file, function.Literal("%s\n  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}"), function.Load(separatorVar), name, static_cast<LLVMValue>(slot), static_cast<LLVMValue>(timestamp), static_cast<LLVMValue>(duration) });
+                    function.Store(separatorVar, function.Literal(","));
+                });
+            });
+
+            function.Call(fprintfFunction, { file, function.Literal("\n]}\n") });
+            function.Call(posixRuntime.GetFcloseFunction(), { file });
+            function.Store(resultVar, function.Literal<int>(0));
+        });
+        function.Return(function.Load(resultVar));
+        _module->EndFunction();
+    }
+
+    void IRProfiler::EmitResetProfileTraceFunction()
+    {
+        auto function = _module->BeginFunction(GetResetProfileTraceFunctionName(), VariableType::Void);
+        function.IncludeInHeader();
+        function.IncludeInSwigInterface();
+
+        // The threads keep the slots they've claimed
+        function.For(_numTraceSlots, [this](IRFunctionEmitter& function, IRLocalScalar slot) {
+            function.SetValueAt(_traceEventCounts, slot, function.Literal<int64_t>(0));
+        });
+        _module->EndFunction();
+    }
+
     LLVMValue IRProfiler::GetRegionBuffer(IRFunctionEmitter& function)
     {
         assert(_getRegionBufferFunction != nullptr);
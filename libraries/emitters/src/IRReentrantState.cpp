@@ -0,0 +1,441 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRReentrantState.cpp (emitters)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IRReentrantState.h"
+#include "EmitterException.h"
+#include "IRMetadata.h"
+#include "IRModuleEmitter.h"
+
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ell
+{
+namespace emitters
+{
+    namespace
+    {
+        bool IsStateGlobal(const llvm::GlobalVariable* global)
+        {
+            return !global->isConstant() && global->hasInitializer() && !global->isThreadLocal() && !global->getName().startswith("llvm.") && global->getMetadata(c_sharedGlobalTagName) == nullptr;
+        }
+
+        // Adds the mutable globals a constant refers to (either directly, or as part of a constant expression) to `globals`
+        void FindStateGlobals(llvm::Constant* constant, std::vector<llvm::GlobalVariable*>& globals, std::unordered_set<llvm::GlobalVariable*>& found)
+        {
+            if (auto global = llvm::dyn_cast<llvm::GlobalVariable>(constant))
+            {
+                if (IsStateGlobal(global) && found.insert(global).second)
+                {
+                    globals.push_back(global);
+                }
+            }
+            else if (!llvm::isa<llvm::GlobalValue>(constant))
+            {
+                for (auto& operand : constant->operands())
+                {
+                    FindStateGlobals(llvm::cast<llvm::Constant>(operand.get()), globals, found);
+                }
+            }
+        }
+
+        // Throws if anything but an instruction in one of `functions` uses a value (other than through constant expressions)
+        void CheckStateGlobalUses(llvm::Value* value, const std::string& globalName, const std::unordered_set<llvm::Function*>& functions)
+        {
+            for (auto user : value->users())
+            {
+                if (auto instruction = llvm::dyn_cast<llvm::Instruction>(user))
+                {
+                    auto function = instruction->getFunction();
+                    if (functions.find(function) == functions.end())
+                    {
+                        throw EmitterException(EmitterError::notSupported, "Global " + globalName + " is part of the model state, but is also used by " + function->getName().str());
+                    }
+                }
+                else if (llvm::isa<llvm::ConstantExpr>(user))
+                {
+                    CheckStateGlobalUses(user, globalName, functions);
+                }
+                else
+                {
+                    throw EmitterException(EmitterError::notSupported, "Global " + globalName + " is part of the model state, but is used in the initializer of another global");
+                }
+            }
+        }
+
+        // Returns a copy of an attribute list for a function or call, with an empty entry for a new first parameter
+        llvm::AttributeList PrependParameterAttributes(const llvm::AttributeList& attributes, unsigned numParameters, llvm::LLVMContext& context)
+        {
+            std::vector<llvm::AttributeSet> parameterAttributes = { llvm::AttributeSet() };
+            for (unsigned index = 0; index < numParameters; ++index)
+            {
+                parameterAttributes.push_back(attributes.getParamAttributes(index));
+            }
+            return llvm::AttributeList::get(context, attributes.getFnAttributes(), attributes.getRetAttributes(), parameterAttributes);
+        }
+
+        // Replaces the references to state globals in the instructions of one function with pointers into the state struct
+        class FunctionStateRewriter
+        {
+        public:
+            FunctionStateRewriter(llvm::Function& function, llvm::Value* stateArgument, llvm::StructType* stateType, const std::unordered_map<llvm::GlobalVariable*, unsigned>& fieldIndices) :
+                _builder(&function.getEntryBlock(), function.getEntryBlock().getFirstInsertionPt()),
+                _function(function),
+                _stateArgument(stateArgument),
+                _stateType(stateType),
+                _fieldIndices(fieldIndices)
+            {
+            }
+
+            void Rewrite()
+            {
+                std::vector<llvm::Instruction*> instructions;
+                for (auto& block : _function)
+                {
+                    for (auto& instruction : block)
+                    {
+                        instructions.push_back(&instruction);
+                    }
+                }
+
+                _state = _builder.CreateBitCast(_stateArgument, _stateType->getPointerTo(), "state");
+                for (auto instruction : instructions)
+                {
+                    for (unsigned index = 0, count = instruction->getNumOperands(); index < count; ++index)
+                    {
+                        auto operand = llvm::dyn_cast<llvm::Constant>(instruction->getOperand(index));
+                        if (operand == nullptr || !ReferencesState(operand))
+                        {
+                            continue;
+                        }
+
+                        // Values flowing into a phi node have to be computed in the incoming block
+                        auto insertBefore = instruction;
+                        if (auto phi = llvm::dyn_cast<llvm::PHINode>(instruction))
+                        {
+                            insertBefore = phi->getIncomingBlock(index)->getTerminator();
+                        }
+                        instruction->setOperand(index, Materialize(operand, insertBefore));
+                    }
+                }
+            }
+
+        private:
+            bool ReferencesState(llvm::Constant* constant) const
+            {
+                if (auto global = llvm::dyn_cast<llvm::GlobalVariable>(constant))
+                {
+                    return _fieldIndices.find(global) != _fieldIndices.end();
+                }
+
+                if (llvm::isa<llvm::GlobalValue>(constant))
+                {
+                    return false;
+                }
+
+                return std::any_of(constant->op_begin(), constant->op_end(), [this](const llvm::Use& operand) {
+                    return ReferencesState(llvm::cast<llvm::Constant>(operand.get()));
+                });
+            }
+
+            // Returns the address of a state global's field in the state struct, emitted in the function's entry block
+            llvm::Value* GetFieldPointer(llvm::GlobalVariable* global)
+            {
+                auto& fieldPointer = _fieldPointers[global];
+                if (fieldPointer == nullptr)
+                {
+                    fieldPointer = _builder.CreateStructGEP(_stateType, _state, _fieldIndices.at(global), global->getName());
+                }
+                return fieldPointer;
+            }
+
+            // Turns a constant that refers to state globals into instructions that compute the same value from the state struct
+            llvm::Value* Materialize(llvm::Constant* constant, llvm::Instruction* insertBefore)
+            {
+                if (auto global = llvm::dyn_cast<llvm::GlobalVariable>(constant))
+                {
+                    return GetFieldPointer(global);
+                }
+
+                auto expression = llvm::dyn_cast<llvm::ConstantExpr>(constant);
+                if (expression == nullptr)
+                {
+                    throw EmitterException(EmitterError::notSupported, "A constant aggregate refers to a global that is part of the model state");
+                }
+
+                auto instruction = expression->getAsInstruction();
+                instruction->insertBefore(insertBefore);
+                for (unsigned index = 0, count = instruction->getNumOperands(); index < count; ++index)
+                {
+                    auto operand = llvm::cast<llvm::Constant>(instruction->getOperand(index));
+                    if (ReferencesState(operand))
+                    {
+                        instruction->setOperand(index, Materialize(operand, instruction));
+                    }
+                }
+                return instruction;
+            }
+
+            llvm::IRBuilder<> _builder;
+            llvm::Function& _function;
+            llvm::Value* _stateArgument;
+            llvm::StructType* _stateType;
+            const std::unordered_map<llvm::GlobalVariable*, unsigned>& _fieldIndices;
+            llvm::Value* _state = nullptr;
+            std::unordered_map<llvm::GlobalVariable*, llvm::Value*> _fieldPointers;
+        };
+    } // namespace
+
+    ReentrantStateInfo MoveGlobalStateToArgument(IRModuleEmitter& module, const std::vector<std::string>& entryFunctionNames, const std::string& stateArgumentName, size_t maxAlignment)
+    {
+        auto& context = module.GetLLVMContext();
+        auto llvmModule = module.GetLLVMModule();
+
+        // Find the entry functions' state arguments
+        std::vector<std::pair<llvm::Function*, llvm::Value*>> stateArguments;
+        for (const auto& name : entryFunctionNames)
+        {
+            auto function = module.GetFunction(name);
+            if (function == nullptr)
+            {
+                throw EmitterException(EmitterError::functionNotFound, name);
+            }
+
+            auto argument = std::find_if(function->arg_begin(), function->arg_end(), [&](const llvm::Argument& argument) { return argument.getName() == stateArgumentName; });
+            if (argument == function->arg_end() || !argument->getType()->isPointerTy())
+            {
+                throw EmitterException(EmitterError::badFunctionArguments, "Function " + name + " has no '" + stateArgumentName + "' pointer argument");
+            }
+            stateArguments.push_back({ function, &*argument });
+        }
+
+        // Find the functions the entry functions call, and the mutable globals they use
+        std::vector<llvm::Function*> functions;
+        std::unordered_set<llvm::Function*> reachable;
+        std::unordered_map<llvm::Function*, std::vector<llvm::Function*>> callers;
+        for (auto& entry : stateArguments)
+        {
+            if (reachable.insert(entry.first).second)
+            {
+                functions.push_back(entry.first);
+            }
+        }
+
+        std::vector<llvm::GlobalVariable*> globals;
+        std::unordered_set<llvm::GlobalVariable*> foundGlobals;
+        for (size_t functionIndex = 0; functionIndex < functions.size(); ++functionIndex)
+        {
+            auto function = functions[functionIndex];
+            for (auto& block : *function)
+            {
+                for (auto& instruction : block)
+                {
+                    if (auto call = llvm::dyn_cast<llvm::CallInst>(&instruction))
+                    {
+                        auto callee = call->getCalledFunction();
+                        if (callee != nullptr && !callee->isDeclaration())
+                        {
+                            callers[callee].push_back(function);
+                            if (reachable.insert(callee).second)
+                            {
+                                functions.push_back(callee);
+                            }
+                        }
+                    }
+
+                    for (auto& operand : instruction.operands())
+                    {
+                        if (auto constant = llvm::dyn_cast<llvm::Constant>(operand.get()))
+                        {
+                            FindStateGlobals(constant, globals, foundGlobals);
+                        }
+                    }
+                }
+            }
+        }
+
+        ReentrantStateInfo result;
+        if (globals.empty())
+        {
+            return result;
+        }
+
+        std::unordered_set<llvm::Function*> usesState;
+        for (auto global : globals)
+        {
+            global->removeDeadConstantUsers();
+            CheckStateGlobalUses(global, global->getName().str(), reachable);
+            for (auto user : global->users())
+            {
+                if (auto instruction = llvm::dyn_cast<llvm::Instruction>(user))
+                {
+                    usesState.insert(instruction->getFunction());
+                }
+            }
+        }
+
+        // Every caller of a function that uses the state needs the state too
+        std::vector<llvm::Function*> worklist(usesState.begin(), usesState.end());
+        while (!worklist.empty())
+        {
+            auto function = worklist.back();
+            worklist.pop_back();
+            for (auto caller : callers[function])
+            {
+                if (usesState.insert(caller).second)
+                {
+                    worklist.push_back(caller);
+                }
+            }
+        }
+
+        // Lay out the state struct. The layout is packed, with explicit padding, so that fields can keep alignments
+        // bigger than their type's
+        const auto& dataLayout = module.GetTargetDataLayout();
+        auto int8Type = llvm::Type::getInt8Ty(context);
+        std::vector<llvm::Type*> fieldTypes;
+        std::vector<llvm::Constant*> fieldValues;
+        std::unordered_map<llvm::GlobalVariable*, unsigned> fieldIndices;
+        size_t offset = 0;
+        for (auto global : globals)
+        {
+            auto type = global->getValueType();
+            size_t fieldAlignment = std::min<size_t>(std::max<size_t>(global->getAlignment(), dataLayout.getABITypeAlignment(type)), maxAlignment);
+            auto fieldOffset = (offset + fieldAlignment - 1) / fieldAlignment * fieldAlignment;
+            if (fieldOffset > offset)
+            {
+                auto paddingType = llvm::ArrayType::get(int8Type, fieldOffset - offset);
+                fieldTypes.push_back(paddingType);
+                fieldValues.push_back(llvm::ConstantAggregateZero::get(paddingType));
+            }
+
+            fieldIndices[global] = static_cast<unsigned>(fieldTypes.size());
+            fieldTypes.push_back(type);
+            fieldValues.push_back(global->getInitializer());
+            offset = fieldOffset + dataLayout.getTypeAllocSize(type);
+            result.alignment = std::max(result.alignment, fieldAlignment);
+            result.globalNames.push_back(global->getName().str());
+        }
+
+        result.type = llvm::StructType::create(context, fieldTypes, module.GetModuleName() + "_State", true);
+        result.size = (offset + result.alignment - 1) / result.alignment * result.alignment;
+        result.initialValue = llvm::ConstantStruct::get(result.type, fieldValues);
+
+        // Give the other functions that need the state a state argument. Their bodies move to new functions with the extra
+        // argument, and their calls pass on the caller's state.
+        std::unordered_set<llvm::Function*> entryFunctions;
+        for (auto& entry : stateArguments)
+        {
+            entryFunctions.insert(entry.first);
+        }
+
+        std::vector<std::pair<llvm::Function*, llvm::Function*>> replacedFunctions;
+        auto statePointerType = llvm::Type::getInt8PtrTy(context);
+        for (auto function : functions)
+        {
+            if (usesState.count(function) == 0 || entryFunctions.count(function) != 0)
+            {
+                continue;
+            }
+
+            for (auto user : function->users())
+            {
+                auto call = llvm::dyn_cast<llvm::CallInst>(user);
+                if (call == nullptr || call->getCalledFunction() != function)
+                {
+                    throw EmitterException(EmitterError::notSupported, "Function " + function->getName().str() + " uses the model state, but is called indirectly");
+                }
+            }
+
+            auto oldType = function->getFunctionType();
+            std::vector<llvm::Type*> parameterTypes = { statePointerType };
+            parameterTypes.insert(parameterTypes.end(), oldType->param_begin(), oldType->param_end());
+            auto newType = llvm::FunctionType::get(oldType->getReturnType(), parameterTypes, oldType->isVarArg());
+
+            auto newFunction = llvm::Function::Create(newType, function->getLinkage(), "", llvmModule);
+            newFunction->takeName(function);
+            newFunction->setCallingConv(function->getCallingConv());
+            newFunction->setAttributes(PrependParameterAttributes(function->getAttributes(), oldType->getNumParams(), context));
+            llvm::SmallVector<std::pair<unsigned, llvm::MDNode*>, 4> metadata;
+            function->getAllMetadata(metadata);
+            for (auto& entry : metadata)
+            {
+                newFunction->setMetadata(entry.first, entry.second);
+            }
+
+            newFunction->getBasicBlockList().splice(newFunction->begin(), function->getBasicBlockList());
+            auto newArgument = newFunction->arg_begin();
+            newArgument->setName(stateArgumentName);
+            for (auto& argument : function->args())
+            {
+                ++newArgument;
+                argument.replaceAllUsesWith(&*newArgument);
+                newArgument->takeName(&argument);
+            }
+
+            stateArguments.push_back({ newFunction, &*newFunction->arg_begin() });
+            replacedFunctions.push_back({ function, newFunction });
+        }
+
+        std::unordered_map<llvm::Function*, llvm::Value*> stateArgumentForFunction(stateArguments.begin(), stateArguments.end());
+        for (auto& replacement : replacedFunctions)
+        {
+            auto function = replacement.first;
+            auto newFunction = replacement.second;
+            std::vector<llvm::CallInst*> calls;
+            for (auto user : function->users())
+            {
+                calls.push_back(llvm::cast<llvm::CallInst>(user));
+            }
+
+            for (auto call : calls)
+            {
+                std::vector<llvm::Value*> arguments = { stateArgumentForFunction.at(call->getFunction()) };
+                arguments.insert(arguments.end(), call->arg_begin(), call->arg_end());
+                auto newCall = llvm::CallInst::Create(newFunction, arguments, "", call);
+                newCall->setCallingConv(call->getCallingConv());
+                newCall->setAttributes(PrependParameterAttributes(call->getAttributes(), call->getNumArgOperands(), context));
+                newCall->setTailCallKind(call->getTailCallKind());
+                newCall->setDebugLoc(call->getDebugLoc());
+                newCall->takeName(call);
+                call->replaceAllUsesWith(newCall);
+                call->eraseFromParent();
+            }
+            function->eraseFromParent();
+        }
+
+        // Point the functions at the state struct instead of the globals
+        for (auto& entry : stateArguments)
+        {
+            FunctionStateRewriter rewriter(*entry.first, entry.second, result.type, fieldIndices);
+            rewriter.Rewrite();
+        }
+
+        for (auto global : globals)
+        {
+            global->removeDeadConstantUsers();
+            if (!global->use_empty())
+            {
+                throw EmitterException(EmitterError::unexpected, "Global " + global->getName().str() + " is still in use after moving it to the model state");
+            }
+            global->eraseFromParent();
+        }
+
+        return result;
+    }
+} // namespace emitters
+} // namespace ell
@@ -13,6 +13,15 @@
 
 #include <utilities/include/Unused.h>
 
+#include <llvm/ADT/Triple.h>
+#include <llvm/IR/InlineAsm.h>
+#include <llvm/Support/Host.h>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 namespace ell
 {
 namespace emitters
@@ -50,6 +59,7 @@ namespace emitters
                 function.For(n, [rowIndex, A, x, incx, lda, accum](IRFunctionEmitter& function, auto columnIndex) {
                     auto aIndex = (rowIndex * lda) + columnIndex;
                     auto xIndex = columnIndex * incx;
+                    function.PrefetchAhead(A, aIndex);
                     auto aVal = A[aIndex];
                     auto xVal = x[xIndex];
                     auto aTimesX = aVal * xVal;
@@ -123,6 +133,224 @@ namespace emitters
             return function.GetFunction();
         }
 
+        //
+        // Hardware performance counters
+        //
+
+        // The perf_event_open event selectors (from linux/perf_event.h), in HardwareCounter order
+        struct PerfEventSelector
+        {
+            uint32_t type;
+            uint64_t config;
+        };
+
+        const PerfEventSelector c_perfEvents[NumHardwareCounters] = {
+            { 0, 0 }, // PERF_TYPE_HARDWARE: PERF_COUNT_HW_CPU_CYCLES
+            { 0, 1 }, // PERF_TYPE_HARDWARE: PERF_COUNT_HW_INSTRUCTIONS
+            { 3, 0x10000 }, // PERF_TYPE_HW_CACHE: L1D | (OP_READ << 8) | (RESULT_MISS << 16)
+            { 3, 0x10002 }, // PERF_TYPE_HW_CACHE: LL | (OP_READ << 8) | (RESULT_MISS << 16)
+            { 0, 5 } // PERF_TYPE_HARDWARE: PERF_COUNT_HW_BRANCH_MISSES
+        };
+
+        // The exclude_kernel and exclude_hv bits of perf_event_attr's flags. Counting user mode only lets unprivileged processes open the events.
+        const uint64_t c_perfEventUserModeOnlyFlags = (1 << 5) | (1 << 6);
+
+        // The first version of perf_event_attr, which holds all the fields we set
+        const int c_perfEventAttrSize = 64;
+
+        // A file descriptor value meaning the event hasn't been opened yet
+        const int c_unopenedPerfEvent = -2;
+
+        // The ARM PMU common events counted by event counters 0-3, for the counters after `cycles` in HardwareCounter order
+        const int c_armPmuEvents[NumHardwareCounters - 1] = {
+            0x08, // INST_RETIRED
+            0x03, // L1D_CACHE_REFILL
+            0x17, // L2D_CACHE_REFILL, the last-level cache on most application cores
+            0x10 // BR_MIS_PRED
+        };
+
+        // Cortex-M data watchpoint and trace unit registers
+        const uint32_t c_dwtControlAddress = 0xE0001000;
+        const uint32_t c_dwtCycleCountAddress = 0xE0001004;
+        const uint32_t c_debugExceptionMonitorControlAddress = 0xE000EDFC;
+
+        llvm::Triple GetTargetTriple(const TargetDevice& targetDevice)
+        {
+            return llvm::Triple(llvm::Triple::normalize(targetDevice.triple.empty() ? llvm::sys::getDefaultTargetTriple() : targetDevice.triple));
+        }
+
+        // Returns the number of the perf_event_open system call on the target's architecture, or -1 if it isn't known
+        int GetPerfEventOpenSyscallNumber(const llvm::Triple& triple)
+        {
+            switch (triple.getArch())
+            {
+            case llvm::Triple::x86_64:
+                return 298;
+            case llvm::Triple::x86:
+                return 336;
+            case llvm::Triple::aarch64:
+                return 241;
+            case llvm::Triple::arm:
+            case llvm::Triple::thumb:
+                return 364;
+            default:
+                return -1;
+            }
+        }
+
+        bool IsArmMProfile(const llvm::Triple& triple)
+        {
+            switch (triple.getSubArch())
+            {
+            case llvm::Triple::ARMSubArch_v6m:
+            case llvm::Triple::ARMSubArch_v7m:
+            case llvm::Triple::ARMSubArch_v7em:
+            case llvm::Triple::ARMSubArch_v8m_baseline:
+            case llvm::Triple::ARMSubArch_v8m_mainline:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        LLVMValue EmitReadRegister(llvm::IRBuilder<>& irBuilder, LLVMType registerType, const std::string& instruction)
+        {
+            auto asmType = llvm::FunctionType::get(registerType, false);
+            return irBuilder.CreateCall(llvm::InlineAsm::get(asmType, instruction, "=r", true));
+        }
+
+        void EmitWriteRegister(llvm::IRBuilder<>& irBuilder, LLVMValue value, const std::string& instruction)
+        {
+            auto asmType = llvm::FunctionType::get(irBuilder.getVoidTy(), { value->getType() }, false);
+            irBuilder.CreateCall(llvm::InlineAsm::get(asmType, instruction, "r", true), { value });
+        }
+
+        LLVMValue EmitMemoryMappedRegisterPointer(IRFunctionEmitter& function, llvm::IRBuilder<>& irBuilder, uint32_t address)
+        {
+            return irBuilder.CreateIntToPtr(function.Literal(static_cast<int>(address)), irBuilder.getInt32Ty()->getPointerTo());
+        }
+
+        // Opens each event with perf_event_open the first time it's read, and reads the current counts with `read`.
+        // Counters that fail to open (e.g., because the kernel doesn't allow it) read as zero.
+        void EmitReadPerfEventCounters(IRModuleEmitter& module, IRFunctionEmitter& function, LLVMValue counters, int syscallNumber)
+        {
+            auto& context = module.GetLLVMContext();
+            auto& irBuilder = module.GetIREmitter().GetIRBuilder();
+            auto& posixRuntime = module.GetRuntime().GetPosixEmitter();
+            auto int32Type = llvm::Type::getInt32Ty(context);
+            auto int64Type = llvm::Type::getInt64Ty(context);
+            auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+
+            // struct perf_event_attr { u32 type; u32 size; u64 config; u64 sample_period; u64 sample_type; u64 read_format; u64 flags; u32 wakeup_events; u32 bp_type; u64 config1; }
+            auto attrType = llvm::StructType::create(context, { int32Type, int32Type, int64Type, int64Type, int64Type, int64Type, int64Type, int32Type, int32Type, int64Type }, "perf_event_attr");
+            auto attr = function.Variable(attrType, "attr");
+            auto value = function.Variable(VariableType::Int64, "value");
+
+            auto syscallFunction = posixRuntime.GetSyscallFunction();
+            auto readFunction = posixRuntime.GetReadFunction();
+            auto longType = syscallFunction->getReturnType();
+
+            auto fileDescriptors = module.GlobalArray<int>(module.GetModuleName() + "_perfEventFileDescriptors", std::vector<int>(NumHardwareCounters, c_unopenedPerfEvent));
+            for (int index = 0; index < NumHardwareCounters; ++index)
+            {
+                function.If(TypedComparison::equals, function.ValueAt(fileDescriptors, index), function.Literal(c_unopenedPerfEvent), [&](IRFunctionEmitter& function) {
+                    irBuilder.CreateStore(llvm::Constant::getNullValue(attrType), attr);
+                    function.Store(function.GetStructFieldPointer(attr, 0), function.Literal(static_cast<int>(c_perfEvents[index].type)));
+                    function.Store(function.GetStructFieldPointer(attr, 1), function.Literal(c_perfEventAttrSize));
+                    function.Store(function.GetStructFieldPointer(attr, 2), function.Literal(static_cast<int64_t>(c_perfEvents[index].config)));
+                    function.Store(function.GetStructFieldPointer(attr, 6), function.Literal(static_cast<int64_t>(c_perfEventUserModeOnlyFlags)));
+
+                    // perf_event_open(&attr, pid = 0 (this thread), cpu = -1 (any), group_fd = -1, flags = 0)
+                    auto fd = function.Call(syscallFunction, { llvm::ConstantInt::get(longType, syscallNumber), function.CastPointer(attr, int8PtrType), function.Literal(0), function.Literal(-1), function.Literal(-1), llvm::ConstantInt::get(longType, 0) });
+                    function.SetValueAt(fileDescriptors, function.Literal(index), function.CastValue<int>(fd));
+                });
+
+                function.StoreZero(value);
+                auto fd = function.ValueAt(fileDescriptors, index);
+                function.If(TypedComparison::greaterThanOrEquals, fd, function.Literal(0), [&](IRFunctionEmitter& function) {
+                    function.Call(readFunction, { fd, function.CastPointer(value, int8PtrType), llvm::ConstantInt::get(longType, sizeof(int64_t)) });
+                });
+                function.SetValueAt(counters, index, function.Load(value));
+            }
+        }
+
+        // Reads the counters from the PMU registers. The first call programs the event counters and enables counting.
+        // The event counters are 32 bits wide, so the values are extended to 64 bits in software: this is exact as long as a
+        // counter advances by less than 2^32 between two reads.
+        void EmitReadArmPmuCounters(IRModuleEmitter& module, IRFunctionEmitter& function, LLVMValue counters, const llvm::Triple& triple)
+        {
+            auto& context = module.GetLLVMContext();
+            auto& irBuilder = module.GetIREmitter().GetIRBuilder();
+            const auto prefix = module.GetModuleName();
+            const bool isAArch64 = triple.getArch() == llvm::Triple::aarch64;
+            const bool isMProfile = IsArmMProfile(triple);
+            auto registerType = isAArch64 ? llvm::Type::getInt64Ty(context) : llvm::Type::getInt32Ty(context);
+            auto registerLiteral = [registerType](uint64_t value) { return llvm::ConstantInt::get(registerType, value); };
+
+            auto selectCounter = [&](int counterIndex) {
+                EmitWriteRegister(irBuilder, registerLiteral(counterIndex), isAArch64 ? "msr pmselr_el0, $0\n\tisb" : "mcr p15, 0, $0, c9, c12, 5\n\tisb");
+            };
+
+            auto initialized = module.Global<int>(prefix + "_pmuInitialized", 0);
+            function.If(TypedComparison::equals, function.Load(initialized), function.Literal(0), [&](IRFunctionEmitter& function) {
+                if (isMProfile)
+                {
+                    // Only the DWT cycle counter is available: enable trace (DEMCR.TRCENA), then the counter (DWT_CTRL.CYCCNTENA)
+                    auto demcr = EmitMemoryMappedRegisterPointer(function, irBuilder, c_debugExceptionMonitorControlAddress);
+                    auto dwtControl = EmitMemoryMappedRegisterPointer(function, irBuilder, c_dwtControlAddress);
+                    irBuilder.CreateStore(irBuilder.CreateOr(irBuilder.CreateLoad(demcr, true), 1 << 24), demcr, true);
+                    irBuilder.CreateStore(function.Literal(0), EmitMemoryMappedRegisterPointer(function, irBuilder, c_dwtCycleCountAddress), true);
+                    irBuilder.CreateStore(irBuilder.CreateOr(irBuilder.CreateLoad(dwtControl, true), 1), dwtControl, true);
+                }
+                else
+                {
+                    for (int counterIndex = 0; counterIndex < NumHardwareCounters - 1; ++counterIndex)
+                    {
+                        selectCounter(counterIndex);
+                        EmitWriteRegister(irBuilder, registerLiteral(c_armPmuEvents[counterIndex]), isAArch64 ? "msr pmxevtyper_el0, $0" : "mcr p15, 0, $0, c9, c13, 1");
+                    }
+
+                    // Enable the cycle counter (bit 31) and event counters 0-3, then reset and start all of them (PMCR.E | PMCR.P | PMCR.C)
+                    EmitWriteRegister(irBuilder, registerLiteral(0x8000000f), isAArch64 ? "msr pmcntenset_el0, $0" : "mcr p15, 0, $0, c9, c12, 1");
+                    EmitWriteRegister(irBuilder, registerLiteral(0x7), isAArch64 ? "msr pmcr_el0, $0\n\tisb" : "mcr p15, 0, $0, c9, c12, 0\n\tisb");
+                }
+                function.Store(initialized, function.Literal(1));
+            });
+
+            std::vector<LLVMValue> rawValues;
+            auto int64Type = llvm::Type::getInt64Ty(context);
+            if (isMProfile)
+            {
+                rawValues.push_back(irBuilder.CreateLoad(EmitMemoryMappedRegisterPointer(function, irBuilder, c_dwtCycleCountAddress), true));
+            }
+            else
+            {
+                rawValues.push_back(EmitReadRegister(irBuilder, registerType, isAArch64 ? "mrs $0, pmccntr_el0" : "mrc p15, 0, $0, c9, c13, 0"));
+                for (int counterIndex = 0; counterIndex < NumHardwareCounters - 1; ++counterIndex)
+                {
+                    selectCounter(counterIndex);
+                    rawValues.push_back(EmitReadRegister(irBuilder, registerType, isAArch64 ? "mrs $0, pmxevcntr_el0" : "mrc p15, 0, $0, c9, c13, 2"));
+                }
+            }
+
+            auto lastValues = module.GlobalArray<int64_t>(prefix + "_pmuLastValues", NumHardwareCounters);
+            auto totals = module.GlobalArray<int64_t>(prefix + "_pmuTotals", NumHardwareCounters);
+            for (int index = 0; index < NumHardwareCounters; ++index)
+            {
+                if (index >= static_cast<int>(rawValues.size()))
+                {
+                    function.SetValueAt(counters, index, function.Literal<int64_t>(0));
+                    continue;
+                }
+
+                auto rawValue = irBuilder.CreateZExt(rawValues[index], int64Type);
+                auto delta = irBuilder.CreateAnd(irBuilder.CreateSub(rawValue, function.ValueAt(lastValues, index)), function.Literal<int64_t>(0xffffffff));
+                auto total = irBuilder.CreateAdd(function.ValueAt(totals, index), delta);
+                function.SetValueAt(lastValues, function.Literal(index), rawValue);
+                function.SetValueAt(totals, function.Literal(index), total);
+                function.SetValueAt(counters, index, total);
+            }
+        }
     } // end anonymous namespace
 
     static const std::string& countName = "count";
@@ -321,6 +549,43 @@ namespace emitters
         return time;
     }
 
+    void IRRuntime::ReadHardwareCounters(IRFunctionEmitter& function, LLVMValue counters)
+    {
+        function.Call(GetReadHardwareCountersFunction(), { counters });
+    }
+
+    LLVMFunction IRRuntime::GetReadHardwareCountersFunction()
+    {
+        if (_readHardwareCountersFunction == nullptr)
+        {
+            const auto& targetDevice = _module.GetCompilerOptions().targetDevice;
+            auto triple = GetTargetTriple(targetDevice);
+            auto syscallNumber = GetPerfEventOpenSyscallNumber(triple);
+            bool isArm = triple.getArch() == llvm::Triple::arm || triple.getArch() == llvm::Triple::thumb || triple.getArch() == llvm::Triple::aarch64;
+
+            auto& function = _module.BeginFunction(GetNamespacePrefix() + "_ReadHardwareCounters", VariableType::Void, NamedVariableTypeList{ { "counters", VariableType::Int64Pointer } });
+            auto counters = function.GetFunctionArgument("counters");
+            if (targetDevice.IsLinux() && syscallNumber >= 0)
+            {
+                EmitReadPerfEventCounters(_module, function, counters, syscallNumber);
+            }
+            else if (isArm && !targetDevice.IsWindows() && !targetDevice.IsMacOS())
+            {
+                EmitReadArmPmuCounters(_module, function, counters, triple);
+            }
+            else
+            {
+                for (int index = 0; index < NumHardwareCounters; ++index)
+                {
+                    function.SetValueAt(counters, index, function.Literal<int64_t>(0));
+                }
+            }
+            _module.EndFunction();
+            _readHardwareCountersFunction = function.GetFunction();
+        }
+        return _readHardwareCountersFunction;
+    }
+
     LLVMFunction IRRuntime::GetCurrentTimeFunction()
     {
         if (_getCurrentTimeFunction == nullptr)
@@ -772,5 +1037,157 @@ namespace emitters
         llvm::FunctionType* functionType = llvm::FunctionType::get(voidType, { GetIntType() }, false);
         return static_cast<LLVMFunction>(pModule->getOrInsertFunction("openblas_set_num_threads", functionType));
     }
+
+    LLVMFunction IRRuntime::GetSharedRuntimeStartTasksFunction()
+    {
+        auto pModule = _module.GetLLVMModule();
+        auto& context = _module.GetLLVMContext();
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+        auto int32Type = llvm::Type::getInt32Ty(context);
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(int8PtrType, { int8PtrType, int8PtrType, int32Type, int32Type, int8PtrType->getPointerTo() }, false);
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction("ell_runtime_StartTasks", functionType));
+    }
+
+    LLVMFunction IRRuntime::GetSharedRuntimeWaitTasksFunction()
+    {
+        auto pModule = _module.GetLLVMModule();
+        auto& context = _module.GetLLVMContext();
+        auto voidType = llvm::Type::getVoidTy(context);
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(voidType, { int8PtrType }, false);
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction("ell_runtime_WaitTasks", functionType));
+    }
+
+    LLVMFunction IRRuntime::GetSharedRuntimeSetBlasThreadsForCallFunction()
+    {
+        auto pModule = _module.GetLLVMModule();
+        auto& context = _module.GetLLVMContext();
+        auto voidType = llvm::Type::getVoidTy(context);
+        auto int64Type = llvm::Type::getInt64Ty(context);
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(voidType, { int64Type }, false);
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction("ell_runtime_SetBlasThreadsForCall", functionType));
+    }
+
+    LLVMFunction IRRuntime::GetSharedRuntimeRegisterProfilerFunction()
+    {
+        auto pModule = _module.GetLLVMModule();
+        auto& context = _module.GetLLVMContext();
+        auto voidType = llvm::Type::getVoidTy(context);
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(voidType, { int8PtrType, int8PtrType, int8PtrType, int8PtrType }, false);
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction("ell_runtime_RegisterProfiler", functionType));
+    }
+
+    template <typename ValueType>
+    LLVMFunction IRRuntime::GetGpuGEMMFunction()
+    {
+        // void ell_runtime_GpuSgemm(int32_t transposeA, int32_t transposeB, int32_t m, int32_t n, int32_t k, const float* A, int32_t lda, const float* B, int32_t ldb, float* C, int32_t ldc, int32_t constantOperands, int64_t moduleId);
+        auto pModule = _module.GetLLVMModule();
+        auto& context = _module.GetLLVMContext();
+        auto voidType = llvm::Type::getVoidTy(context);
+        auto int32Type = llvm::Type::getInt32Ty(context);
+        auto int64Type = llvm::Type::getInt64Ty(context);
+        auto valuePtrType = _module.GetIREmitter().PointerType(GetVariableType<ValueType>());
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(voidType, { int32Type, int32Type, int32Type, int32Type, int32Type, valuePtrType, int32Type, valuePtrType, int32Type, valuePtrType, int32Type, int32Type, int64Type }, false);
+        auto name = std::is_same<ValueType, float>::value ? "ell_runtime_GpuSgemm" : "ell_runtime_GpuDgemm";
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction(name, functionType));
+    }
+
+    template LLVMFunction IRRuntime::GetGpuGEMMFunction<float>();
+    template LLVMFunction IRRuntime::GetGpuGEMMFunction<double>();
+
+    LLVMFunction IRRuntime::GetGpuBeginModuleFunction()
+    {
+        auto pModule = _module.GetLLVMModule();
+        auto int64Type = llvm::Type::getInt64Ty(_module.GetLLVMContext());
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(int64Type, {}, false);
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction("ell_runtime_GpuBeginModule", functionType));
+    }
+
+    LLVMFunction IRRuntime::GetGpuEndModuleFunction()
+    {
+        auto pModule = _module.GetLLVMModule();
+        auto& context = _module.GetLLVMContext();
+        auto voidType = llvm::Type::getVoidTy(context);
+        auto int64Type = llvm::Type::getInt64Ty(context);
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(voidType, { int64Type }, false);
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction("ell_runtime_GpuEndModule", functionType));
+    }
+
+    LLVMValue IRRuntime::GetGpuModuleId(IRFunctionEmitter& function)
+    {
+        const auto globalName = _module.GetModuleName() + "_gpuModuleId";
+        auto moduleId = _module.GetLLVMModule()->getNamedGlobal(globalName);
+        if (moduleId == nullptr)
+        {
+            moduleId = _module.Global(VariableType::Int64, globalName);
+
+            auto& beginModule = _module.BeginFunction(_module.GetModuleName() + "_GpuBeginModule", VariableType::Void);
+            beginModule.Store(moduleId, beginModule.Call(GetGpuBeginModuleFunction(), {}));
+            _module.EndFunction();
+            _module.AddInitializationFunction(beginModule);
+
+            auto& endModule = _module.BeginFunction(_module.GetModuleName() + "_GpuEndModule", VariableType::Void);
+            endModule.Call(GetGpuEndModuleFunction(), { endModule.Load(moduleId) });
+            _module.EndFunction();
+            _module.AddFinalizationFunction(endModule);
+        }
+        return function.Load(moduleId);
+    }
+
+    LLVMFunction IRRuntime::GetCmsisDotProductQ7Function()
+    {
+        auto pModule = _module.GetLLVMModule();
+        auto& context = _module.GetLLVMContext();
+        auto voidType = llvm::Type::getVoidTy(context);
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+        auto int32Type = llvm::Type::getInt32Ty(context);
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(voidType, { int8PtrType, int8PtrType, int32Type, int32Type->getPointerTo() }, false);
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction("arm_dot_prod_q7", functionType));
+    }
+
+    LLVMFunction IRRuntime::GetCmsisRealFFTInitFunction()
+    {
+        // The narrow integer arguments are passed as 32-bit values, since the ARM calling convention extends them to 32 bits anyway
+        auto pModule = _module.GetLLVMModule();
+        auto& context = _module.GetLLVMContext();
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+        auto int32Type = llvm::Type::getInt32Ty(context);
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(int32Type, { int8PtrType, int32Type }, false);
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction("arm_rfft_fast_init_f32", functionType));
+    }
+
+    LLVMFunction IRRuntime::GetCmsisRealFFTFunction()
+    {
+        auto pModule = _module.GetLLVMModule();
+        auto& context = _module.GetLLVMContext();
+        auto voidType = llvm::Type::getVoidTy(context);
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+        auto floatPtrType = llvm::Type::getFloatPtrTy(context);
+        auto int32Type = llvm::Type::getInt32Ty(context);
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(voidType, { int8PtrType, floatPtrType, floatPtrType, int32Type }, false);
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction("arm_rfft_fast_f32", functionType));
+    }
+
+    LLVMFunction IRRuntime::GetSharedRuntimeUnregisterProfilerFunction()
+    {
+        auto pModule = _module.GetLLVMModule();
+        auto& context = _module.GetLLVMContext();
+        auto voidType = llvm::Type::getVoidTy(context);
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+
+        llvm::FunctionType* functionType = llvm::FunctionType::get(voidType, { int8PtrType }, false);
+        return static_cast<LLVMFunction>(pModule->getOrInsertFunction("ell_runtime_UnregisterProfiler", functionType));
+    }
 } // namespace emitters
 } // namespace ell
@@ -13,9 +13,11 @@
 
 #include <utilities/include/StringUtil.h>
 
+#include <algorithm>
 #include <regex>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace ell
 {
@@ -29,6 +31,36 @@ namespace emitters
             return type == "float" ? "FloatVector" : "DoubleVector";
         }
 
+        // The NumPy type with the same layout as the given type, or an empty string if the buffer typemaps don't support it
+        std::string AsNumPyType(const std::string& type)
+        {
+            if (type == "float")
+            {
+                return "np.float32";
+            }
+            if (type == "double")
+            {
+                return "np.float64";
+            }
+            return "";
+        }
+
+        std::string GetWrapperClassName(const std::string& moduleName)
+        {
+            std::string className = moduleName + "Wrapper";
+            className[0] = ::toupper(className[0]); // pascal case
+            return className;
+        }
+
+        // An input or output buffer of the predict function
+        struct PredictDataArgument
+        {
+            std::string name;
+            std::string type;
+            bool isOutput;
+            int index; // among the inputs or the outputs
+        };
+
         // Writes SWIG C++ interfaces for predict that take std::vectors for input and output (with optional SinkNode callbacks)
         class PredictFunctionWriter
         {
@@ -44,25 +76,39 @@ namespace emitters
             {
                 DeclareIfDefGuard guard(os, "SWIGPYTHON", DeclareIfDefGuard::Type::Positive);
 
+                std::string className = GetWrapperClassName(_moduleName);
+                std::string predictMethodName = TrimPrefix(_functionName, _moduleName + "_");
+                predictMethodName[0] = ::toupper(predictMethodName[0]); // pascal case
+
+                // Other Python threads can run while the model computes
+                os << "%threadallow " << className << "::" << predictMethodName << ";\n";
+                bool hasBufferPredict = HasBufferPredict();
+                if (hasBufferPredict)
+                {
+                    WriteBufferPredictMethod(os, className, predictMethodName);
+                }
+
                 // clang-format off
                 std::string predictPythonCode(
                     #include "SwigPredictPython.in"
                 );
                 // clang-format on
 
-                auto resetFunctionName = _moduleName + "_Reset";
-                std::string predictMethodName = TrimPrefix(_functionName, _moduleName + "_");
-                predictMethodName[0] = ::toupper(predictMethodName[0]); // pascal case
-
-                std::string className = _moduleName + "Wrapper";
-                className[0] = ::toupper(className[0]); // pascal case
+                // The state of a reentrant model belongs to the wrapper object
+                auto resetCall = _hasState ? "if _model_wrapper is not None:\n        _model_wrapper.Reset()" : _moduleName + "_Reset()";
 
                 std::string inputVectorType = AsVectorType(_inputType);
 
+                // The predict() convenience function uses the buffer predict method for a model with one input and one output
+                bool predictIntoBuffers = hasBufferPredict && _dataArgs.size() == 2 && !_dataArgs[0].isOutput && _dataArgs[1].isOutput;
+
                 ReplaceDelimiter(predictPythonCode, "WRAPPER_CLASS", className);
                 ReplaceDelimiter(predictPythonCode, "PREDICT_METHOD", predictMethodName);
                 ReplaceDelimiter(predictPythonCode, "INPUT_VECTOR_TYPE", inputVectorType);
-                ReplaceDelimiter(predictPythonCode, "RESET_FUNCTION", resetFunctionName);
+                ReplaceDelimiter(predictPythonCode, "PREDICT_INTO_BUFFERS", predictIntoBuffers ? "True" : "False");
+                ReplaceDelimiter(predictPythonCode, "INPUT_NUMPY_TYPE", predictIntoBuffers ? AsNumPyType(_dataArgs[0].type) : "None");
+                ReplaceDelimiter(predictPythonCode, "OUTPUT_NUMPY_TYPE", predictIntoBuffers ? AsNumPyType(_dataArgs[1].type) : "None");
+                ReplaceDelimiter(predictPythonCode, "RESET_CALL", resetCall);
 
                 os << "%pythoncode %{\n"
                    << predictPythonCode
@@ -70,6 +116,56 @@ namespace emitters
             }
 
         private:
+            bool HasBufferPredict() const
+            {
+                return !_hasSourceNodes && !_inputIsScalar && !_dataArgs.empty() && std::all_of(_dataArgs.begin(), _dataArgs.end(), [](const PredictDataArgument& arg) { return !AsNumPyType(arg.type).empty(); });
+            }
+
+            // Writes a predict method that reads and writes NumPy arrays (or any other contiguous buffers) in
+            // place, by calling the wrapper class's PredictInto method, which SWIG can't wrap by itself
+            void WriteBufferPredictMethod(std::ostream& os, const std::string& className, const std::string& predictMethodName) const
+            {
+                std::string methodName = predictMethodName + "Into";
+                std::vector<std::string> bufferArgs;
+                std::vector<std::string> callArgs;
+                std::vector<std::string> sizeChecks;
+                for (const auto& arg : _dataArgs)
+                {
+                    auto pointerType = (arg.isOutput ? "" : "const ") + arg.type + "* " + arg.name;
+                    auto sizeName = arg.name + "Size";
+                    auto sizeFunction = std::string(arg.isOutput ? "GetOutputSize(" : "GetInputSize(") + std::to_string(arg.index) + ")";
+                    os << "TYPEMAP_BUFFER_TO_POINTER(" << arg.type << ", " << pointerType << ", " << sizeName << ", " << (arg.isOutput ? "PyBUF_WRITABLE" : "0") << ")\n";
+                    bufferArgs.push_back(pointerType + ", size_t " + sizeName);
+                    callArgs.push_back(arg.name);
+                    sizeChecks.push_back(sizeName + " != static_cast<size_t>($self->" + sizeFunction + ")");
+                }
+
+                os << "%threadallow " << className << "::" << methodName << ";\n";
+                os << "%exception " << className << "::" << methodName << "\n";
+                os << "{\n";
+                os << "    try\n";
+                os << "    {\n";
+                os << "        $action\n";
+                os << "    }\n";
+                os << "    catch (const std::exception& e)\n";
+                os << "    {\n";
+                os << "        SWIG_exception_fail(SWIG_ValueError, e.what());\n";
+                os << "    }\n";
+                os << "}\n";
+                os << "%extend " << className << "\n";
+                os << "{\n";
+                os << "    // Computes the outputs from the inputs where they are, without copying them\n";
+                os << "    void " << methodName << "(" << utilities::Join(bufferArgs, ", ") << ")\n";
+                os << "    {\n";
+                os << "        if (" << utilities::Join(sizeChecks, " || ") << ")\n";
+                os << "        {\n";
+                os << "            throw std::invalid_argument(\"" << methodName << ": the array sizes don't match the model's inputs and outputs\");\n";
+                os << "        }\n";
+                os << "        $self->" << methodName << "(" << utilities::Join(callArgs, ", ") << ");\n";
+                os << "    }\n";
+                os << "}\n";
+            }
+
             void InitPredictFunctionInfo(IRModuleEmitter& moduleEmitter)
             {
                 auto callbacks = GetFunctionsWithTag(moduleEmitter, c_callbackFunctionTagName);
@@ -77,12 +173,18 @@ namespace emitters
                 ModuleCallbackDefinitions moduleCallbacks(callbacks);
 
                 _functionName = _function->getName();
+                _hasState = std::any_of(_function->arg_begin(), _function->arg_end(), [](const llvm::Argument& arg) { return arg.getName() == "state"; });
 
-                if (moduleCallbacks.sources.empty())
+                _hasSourceNodes = !moduleCallbacks.sources.empty();
+                if (!_hasSourceNodes)
                 {
                     // Three arguments context, input, output (input may be a scalar or pointer)
                     auto it = _function->args().begin();
                     ++it; // skip context argument
+                    if (_hasState)
+                    {
+                        ++it; // skip state argument
+                    }
 
                     {
                         std::ostringstream os;
@@ -101,6 +203,7 @@ namespace emitters
                         }
                         _inputType = os.str();
                     }
+                    InitDataArguments(moduleEmitter);
                 }
                 else
                 {
@@ -111,13 +214,88 @@ namespace emitters
                 }
             }
 
+            // Gets the inputs and outputs in the order the wrapper class's PredictInto method takes them
+            void InitDataArguments(IRModuleEmitter& moduleEmitter)
+            {
+                auto argDecls = moduleEmitter.GetFunctionDeclaration(_functionName).GetArguments();
+                size_t index = 0;
+                int numInputs = 0;
+                int numOutputs = 0;
+                for (auto& argument : _function->args())
+                {
+                    ArgumentFlags flags = index < argDecls.size() ? argDecls[index].GetFlags() : ArgumentFlags::InOut;
+                    ++index;
+                    std::string name = argument.getName();
+                    if (name == "context" || name == "state")
+                    {
+                        continue;
+                    }
+                    if (!argument.getType()->isPointerTy())
+                    {
+                        _dataArgs.clear();
+                        return;
+                    }
+
+                    std::ostringstream os;
+                    WriteLLVMType(os, argument.getType()->getPointerElementType());
+                    bool isOutput = (flags & ArgumentFlags::Output) != 0;
+                    _dataArgs.push_back({ name, os.str(), isOutput, isOutput ? numOutputs++ : numInputs++ });
+                }
+            }
+
             std::string _moduleName;
             std::string _functionName;
             std::string _inputType;
-            bool _inputIsScalar;
+            std::vector<PredictDataArgument> _dataArgs;
+            bool _inputIsScalar = false;
+            bool _hasSourceNodes = false;
+            bool _hasState = false;
             LLVMFunction _function;
         };
 
+        // Wraps the CallbackBuffer of each callback type, so Python callbacks can fill and read the values where the
+        // model keeps them: np.asarray(buffer) is a view of them, which is only valid until the callback returns.
+        void WriteCallbackBufferWrappers(std::ostream& os, IRModuleEmitter& moduleEmitter)
+        {
+            ModuleCallbackDefinitions moduleCallbacks(GetFunctionsWithTag(moduleEmitter, c_callbackFunctionTagName));
+            std::vector<std::string> types;
+            for (const auto& callbacks : { moduleCallbacks.sources, moduleCallbacks.sinks })
+            {
+                for (const auto& callback : callbacks)
+                {
+                    if (!AsNumPyType(callback.inputType).empty() && std::find(types.begin(), types.end(), callback.inputType) == types.end())
+                    {
+                        types.push_back(callback.inputType);
+                    }
+                }
+            }
+            if (types.empty())
+            {
+                return;
+            }
+
+            DeclareIfDefGuard guard(os, "SWIGPYTHON", DeclareIfDefGuard::Type::Positive);
+            for (const auto& type : types)
+            {
+                std::string templateName = type + "CallbackBuffer";
+                templateName[0] = ::toupper(templateName[0]); // pascal case
+
+                os << "%template(" << templateName << ") CallbackBuffer<" << type << ">;\n";
+                os << "%extend CallbackBuffer<" << type << ">\n";
+                os << "{\n";
+                os << "    PyObject* AsMemoryView()\n";
+                os << "    {\n";
+                os << "        return PyMemoryView_FromMemory(reinterpret_cast<char*>($self->data), $self->size * sizeof(" << type << "), PyBUF_WRITE);\n";
+                os << "    }\n";
+                os << "}\n";
+                os << "%pythoncode %{\n";
+                os << "def _" << templateName << "_array(self, dtype=None):\n";
+                os << "    return np.frombuffer(self.AsMemoryView(), dtype=" << AsNumPyType(type) << ")\n";
+                os << templateName << ".__array__ = _" << templateName << "_array\n";
+                os << "%}\n";
+            }
+        }
+
         void WriteShapeWrappers(std::ostream& os, IRModuleEmitter& moduleEmitter)
         {
             auto pModule = moduleEmitter.GetLLVMModule();
@@ -150,8 +328,7 @@ namespace emitters
         {
             auto pModule = moduleEmitter.GetLLVMModule();
             std::string moduleName = pModule->getName();
-            std::string className = moduleName + "Wrapper";
-            className[0] = ::toupper(className[0]); // pascal case
+            std::string className = GetWrapperClassName(moduleName);
 
             //
             // Module
@@ -178,6 +355,11 @@ namespace emitters
 
             os << "%include \"" << headerName << "\"\n";
 
+            //
+            // Zero-copy callback buffers
+            //
+            WriteCallbackBufferWrappers(os, moduleEmitter);
+
             //
             // Shape wrappers
             //
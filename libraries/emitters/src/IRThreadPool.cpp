@@ -17,12 +17,44 @@
 #include <utilities/include/Exception.h>
 #include <utilities/include/Unused.h>
 
+#include <llvm/ADT/Triple.h>
+#include <llvm/IR/InlineAsm.h>
+
+#include <algorithm>
 #include <vector>
 
 namespace ell
 {
 namespace emitters
 {
+    namespace
+    {
+        // Tells the CPU that we're in a polling loop, so it can save power and give the core to a hyperthread sibling.
+        // The memory clobber also keeps the compiler from moving loads out of the loop.
+        void EmitSpinWaitHint(IRFunctionEmitter& function)
+        {
+            std::string instruction;
+            switch (llvm::Triple(function.GetModule().GetCompilerOptions().targetDevice.triple).getArch())
+            {
+            case llvm::Triple::x86:
+            case llvm::Triple::x86_64:
+                instruction = "pause";
+                break;
+            case llvm::Triple::arm:
+            case llvm::Triple::thumb:
+            case llvm::Triple::aarch64:
+                instruction = "yield";
+                break;
+            default:
+                break;
+            }
+
+            auto& irBuilder = function.GetEmitter().GetIRBuilder();
+            auto asmType = llvm::FunctionType::get(irBuilder.getVoidTy(), false);
+            irBuilder.CreateCall(llvm::InlineAsm::get(asmType, instruction, "~{memory}", true));
+        }
+    } // namespace
+
     //
     // IRThreadPool
     //
@@ -35,11 +67,15 @@ namespace emitters
     void IRThreadPool::Initialize()
     {
         _maxThreads = _module.GetCompilerOptions().maxThreads;
+        _useWorkStealing = _module.GetCompilerOptions().useWorkStealing;
+        _taskQueue._spinCount = std::max(0, _module.GetCompilerOptions().threadPoolSpinCount);
+        _taskQueue._hotCount = IsHot() ? GetHotCount() : nullptr;
         auto pthreadType = _module.GetRuntime().GetPosixEmitter().GetPthreadType();
 
         // Create global array to hold pthread objects
         _threads = _module.GlobalArray("taskThreads", pthreadType, _maxThreads);
 
+        _setAffinityFunction = AddSetAffinityFunction();
         AddGlobalInitializer();
         AddGlobalFinalizer();
     }
@@ -50,34 +86,146 @@ namespace emitters
         auto& context = _module.GetLLVMContext();
         auto boolType = llvm::Type::getInt1Ty(context);
         auto int8PtrType = llvm::Type::getInt8PtrTy(context);
-        auto isInitedVar = _module.Global(boolType, "isInitialized"); // initialized to false
+        _isInitialized = _module.Global(boolType, "isInitialized"); // initialized to false
 
         auto initThreadPoolFunction = _module.BeginFunction("initThreadPool", VariableType::Void);
         {
             // Check if task not initialized
-            auto notInited = initThreadPoolFunction.LogicalNot(initThreadPoolFunction.Load(isInitedVar));
-            initThreadPoolFunction.If(notInited, [this, int8PtrType, &isInitedVar](auto& initThreadPoolFunction) {
-                initThreadPoolFunction.Store(isInitedVar, initThreadPoolFunction.TrueBit());
-                _taskQueue.Initialize(initThreadPoolFunction);
+            auto notInited = initThreadPoolFunction.LogicalNot(initThreadPoolFunction.Load(_isInitialized));
+            initThreadPoolFunction.If(notInited, [this, int8PtrType](auto& initThreadPoolFunction) {
+                initThreadPoolFunction.Store(_isInitialized, initThreadPoolFunction.TrueBit());
+                _taskQueue.Initialize(initThreadPoolFunction, static_cast<int>(_maxThreads), _useWorkStealing);
 
-                auto workerThreadFunction = this->GetWorkerThreadFunction(); // STYLE gcc bug requires `this->` inside generic lambda (https://gcc.gnu.org/bugzilla/show_bug.cgi?id=67274)
+                auto workerThreadFunction = _useWorkStealing ? this->GetWorkStealingWorkerThreadFunction() : this->GetWorkerThreadFunction(); // STYLE gcc bug requires `this->` inside generic lambda (https://gcc.gnu.org/bugzilla/show_bug.cgi?id=67274)
                 llvm::ConstantPointerNull* nullAttr = initThreadPoolFunction.NullPointer(int8PtrType);
                 initThreadPoolFunction.For(_maxThreads, [this, int8PtrType, nullAttr, workerThreadFunction](auto& initThreadPoolFunction, LLVMValue index) {
                     auto threadPtr = initThreadPoolFunction.PointerOffset(_threads, index);
-                    initThreadPoolFunction.PthreadCreate(threadPtr, nullAttr, workerThreadFunction, initThreadPoolFunction.CastPointer(_taskQueue.GetDataStruct(), int8PtrType));
+
+                    // In work-stealing mode, each worker gets a pointer to its own deque
+                    auto threadArg = _useWorkStealing ? _taskQueue.GetWorkerQueuePointer(initThreadPoolFunction, index) : _taskQueue.GetDataStruct();
+                    initThreadPoolFunction.PthreadCreate(threadPtr, nullAttr, workerThreadFunction, initThreadPoolFunction.CastPointer(threadArg, int8PtrType));
                 });
+
+                // Pin the workers to the cores requested at compile time (callers can re-pin them at runtime)
+                const auto& threadAffinity = _module.GetCompilerOptions().threadAffinity;
+                if (!threadAffinity.empty())
+                {
+                    auto cores = _module.GlobalArray(_module.GetModuleName() + "_threadAffinityCores", threadAffinity);
+                    initThreadPoolFunction.Call(_setAffinityFunction, { initThreadPoolFunction.PointerOffset(cores, 0), initThreadPoolFunction.Literal(static_cast<int>(threadAffinity.size())) });
+                }
             });
         }
         _module.EndFunction();
         _module.AddInitializationFunction(initThreadPoolFunction);
     }
 
+    std::string IRThreadPool::GetSetAffinityFunctionName() const
+    {
+        return _module.GetModuleName() + "_SetThreadPoolAffinity";
+    }
+
+    LLVMFunction IRThreadPool::AddSetAffinityFunction()
+    {
+        const NamedVariableTypeList parameters = { { "cores", VariableType::Int32Pointer }, { "numCores", VariableType::Int32 } };
+        auto function = _module.BeginFunction(GetSetAffinityFunctionName(), VariableType::Int32, parameters);
+        function.IncludeInHeader();
+        if (!_module.GetCompilerOptions().targetDevice.IsLinux())
+        {
+            // Thread affinity is only supported via pthread_setaffinity_np for now
+            function.Return(function.Literal<int>(-1));
+        }
+        else
+        {
+            auto& posixEmitter = _module.GetRuntime().GetPosixEmitter();
+            auto wordType = posixEmitter.GetCpuSetWordType();
+            auto numWords = posixEmitter.GetCpuSetNumWords();
+            auto wordBits = static_cast<int>(wordType->getPrimitiveSizeInBits());
+
+            auto cores = function.GetFunctionArgument("cores");
+            auto numCores = function.GetFunctionArgument("numCores");
+            auto resultVar = function.Variable(VariableType::Int32, "result");
+            auto cpuSet = function.Variable(wordType, numWords);
+            function.Store(resultVar, function.Literal<int>(0));
+
+            auto hasNoCores = function.Comparison(TypedComparison::lessThanOrEquals, numCores, function.Literal<int>(0));
+            function.If(hasNoCores, [resultVar](IRFunctionEmitter& function) {
+                        function.Store(resultVar, function.Literal<int>(-1));
+                    })
+                .Else([this, cores, numCores, resultVar, cpuSet, wordType, numWords, wordBits](IRFunctionEmitter& function) {
+                    function.For(_maxThreads, [this, cores, numCores, resultVar, cpuSet, wordType, numWords, wordBits](IRFunctionEmitter& function, LLVMValue threadIndex) {
+                        auto core = function.ValueAt(cores, function.Operator(TypedOperator::moduloSigned, threadIndex, numCores));
+                        auto isNotNegative = function.Comparison(TypedComparison::greaterThanOrEquals, core, function.Literal<int>(0));
+                        auto isInRange = function.Comparison(TypedComparison::lessThan, core, function.Literal<int>(numWords * wordBits));
+                        function.If(function.Operator(TypedOperator::logicalAnd, isNotNegative, isInRange), [this, core, resultVar, cpuSet, wordType, numWords, wordBits, threadIndex](IRFunctionEmitter& function) {
+                                    // Build a cpu_set_t with just this core's bit set
+                                    function.StoreZero(cpuSet, numWords);
+                                    auto wordPtr = function.PointerOffset(cpuSet, function.Operator(TypedOperator::divideSigned, core, function.Literal<int>(wordBits)));
+                                    auto bitIndex = function.CastValue(function.Operator(TypedOperator::moduloSigned, core, function.Literal<int>(wordBits)), wordType);
+                                    auto bit = function.Operator(TypedOperator::shiftLeft, llvm::ConstantInt::get(wordType, 1), bitIndex);
+                                    function.Store(wordPtr, function.Operator(TypedOperator::logicalOr, function.Load(wordPtr), bit));
+
+                                    auto thread = function.Load(function.PointerOffset(_threads, threadIndex));
+                                    auto errCode = function.PthreadSetAffinity(thread, cpuSet);
+                                    function.If(function.Comparison(TypedComparison::notEquals, errCode, function.Literal<int>(0)), [resultVar, errCode](IRFunctionEmitter& function) {
+                                        function.Store(resultVar, errCode);
+                                    });
+                                })
+                            .Else([resultVar](IRFunctionEmitter& function) {
+                                function.Store(resultVar, function.Literal<int>(-1));
+                            });
+                    });
+                });
+            function.Return(function.Load(resultVar));
+        }
+        _module.EndFunction();
+        return function.GetFunction();
+    }
+
+    bool IRThreadPool::IsHot() const
+    {
+        const auto& options = _module.GetCompilerOptions();
+        return options.hotThreadPool && options.parallelize && options.useThreadPool && !options.useSharedRuntime;
+    }
+
+    llvm::GlobalVariable* IRThreadPool::GetHotCount()
+    {
+        if (_hotCount == nullptr)
+        {
+            _hotCount = _module.Global<int>("threadPoolHotCount", 0);
+        }
+        return _hotCount;
+    }
+
+    void IRThreadPool::BeginHotRegion(IRFunctionEmitter& function)
+    {
+        if (IsHot())
+        {
+            // Predict calls may run concurrently on several threads
+            auto& irBuilder = function.GetEmitter().GetIRBuilder();
+            irBuilder.CreateAtomicRMW(llvm::AtomicRMWInst::Add, GetHotCount(), function.Literal<int>(1), llvm::AtomicOrdering::Monotonic);
+        }
+    }
+
+    void IRThreadPool::EndHotRegion(IRFunctionEmitter& function)
+    {
+        if (IsHot())
+        {
+            auto& irBuilder = function.GetEmitter().GetIRBuilder();
+            irBuilder.CreateAtomicRMW(llvm::AtomicRMWInst::Sub, GetHotCount(), function.Literal<int>(1), llvm::AtomicOrdering::Monotonic);
+        }
+    }
+
     void IRThreadPool::AddGlobalFinalizer()
     {
-        // Create individual threads (in a global_ctors function)
+        // Join the threads (in a global_dtors function)
         auto shutDownThreadPoolFunction = _module.BeginFunction("shutDownThreadPool", VariableType::Void);
         {
-            ShutDown(shutDownThreadPoolFunction);
+            // The JIT may run the finalizers without having run the initializers (e.g., if code generation failed),
+            // or run them more than once, so only join threads that were actually started
+            shutDownThreadPoolFunction.If(shutDownThreadPoolFunction.Load(_isInitialized), [this](IRFunctionEmitter& shutDownThreadPoolFunction) {
+                ShutDown(shutDownThreadPoolFunction);
+                shutDownThreadPoolFunction.Store(_isInitialized, shutDownThreadPoolFunction.FalseBit());
+            });
         }
         _module.EndFunction();
         _module.AddFinalizationFunction(shutDownThreadPoolFunction);
@@ -85,6 +233,11 @@ namespace emitters
 
     IRThreadPoolTaskArray& IRThreadPool::AddTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments)
     {
+        if (_module.GetCompilerOptions().useSharedRuntime)
+        {
+            return _taskQueue.StartSharedRuntimeTasks(function, taskFunction, arguments);
+        }
+
         // Call Initialize() the first time we're called --- this adds global init code to the module
         if (!IsInitialized())
         {
@@ -149,6 +302,51 @@ namespace emitters
         return workerThreadFunction.GetFunction();
     }
 
+    LLVMFunction IRThreadPool::GetWorkStealingWorkerThreadFunction()
+    {
+        assert(IsInitialized());
+
+        auto& context = _module.GetLLVMContext();
+        auto boolType = llvm::Type::getInt1Ty(context);
+        auto int32Type = llvm::Type::getInt32Ty(context);
+        auto int8PtrType = llvm::Type::getInt8PtrTy(context);
+
+        auto workerThreadFunction = _module.BeginFunction("WorkStealingWorkerThreadFunction", int8PtrType, { int8PtrType });
+        {
+            auto workerQueueArg = &(*workerThreadFunction.Arguments().begin());
+            auto workerIndex = _taskQueue.GetWorkerIndex(workerThreadFunction, workerQueueArg);
+
+            auto notDoneVar = workerThreadFunction.Variable(boolType, "notDone");
+            auto numFinishedTasksVar = workerThreadFunction.Variable(int32Type, "numFinishedTasks");
+            auto lastGenerationVar = workerThreadFunction.Variable(int32Type, "lastGeneration");
+            workerThreadFunction.Store(notDoneVar, workerThreadFunction.TrueBit());
+            workerThreadFunction.Store(numFinishedTasksVar, workerThreadFunction.Literal<int>(0));
+            workerThreadFunction.Store(lastGenerationVar, workerThreadFunction.Literal<int>(0));
+            workerThreadFunction.While(notDoneVar, [this, notDoneVar, numFinishedTasksVar, lastGenerationVar, workerIndex](IRFunctionEmitter& workerThreadFunction) {
+                auto taskIndex = _taskQueue.PopOrStealTaskIndex(workerThreadFunction, workerIndex);
+                workerThreadFunction.If(workerThreadFunction.Comparison(TypedComparison::greaterThanOrEquals, taskIndex, workerThreadFunction.Literal<int>(0)), [this, taskIndex, numFinishedTasksVar](IRFunctionEmitter& workerThreadFunction) {
+                                        auto task = _taskQueue.GetTaskArray().GetTask(workerThreadFunction, taskIndex);
+                                        task.Run(workerThreadFunction);
+
+                                        // Finished tasks are only reported to the shared queue when this worker runs out of work
+                                        auto numFinished = workerThreadFunction.Load(numFinishedTasksVar);
+                                        workerThreadFunction.Store(numFinishedTasksVar, workerThreadFunction.Operator(TypedOperator::add, numFinished, workerThreadFunction.Literal<int>(1)));
+                                    })
+                    .Else([this, notDoneVar, numFinishedTasksVar, lastGenerationVar](auto& workerThreadFunction) {
+                        // No work left anywhere: report our finished tasks and sleep until the next batch arrives
+                        _taskQueue.WaitForNewTasks(workerThreadFunction, numFinishedTasksVar, lastGenerationVar);
+                        workerThreadFunction.If(_taskQueue.GetShutdownFlag(workerThreadFunction), [notDoneVar](auto& workerThreadFunction) {
+                            workerThreadFunction.Store(notDoneVar, workerThreadFunction.FalseBit());
+                        });
+                    });
+            });
+
+            workerThreadFunction.Return(workerThreadFunction.NullPointer(int8PtrType));
+        }
+        _module.EndFunction();
+        return workerThreadFunction.GetFunction();
+    }
+
     bool IRThreadPool::IsInitialized() const
     {
         return _threads != nullptr;
@@ -164,7 +362,7 @@ namespace emitters
         // Note: we can't initialize ourselves here, for ordering reasons.
     }
 
-    void IRThreadPoolTaskQueue::Initialize(IRFunctionEmitter& function)
+    void IRThreadPoolTaskQueue::Initialize(IRFunctionEmitter& function, int numWorkers, bool useWorkStealing)
     {
         if (_queueData != nullptr)
         {
@@ -187,6 +385,7 @@ namespace emitters
         auto count = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unscheduledCount));
         auto unfinishedCount = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unfinishedCount));
         auto shutdownFlag = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::shutdownFlag));
+        auto generation = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::generation));
 
         // Initialize the fields
         llvm::ConstantPointerNull* nullAttr = function.NullPointer(int8PtrType);
@@ -197,10 +396,56 @@ namespace emitters
         function.Store(count, function.Literal<int>(0));
         function.Store(unfinishedCount, function.Literal<int>(0));
         function.Store(shutdownFlag, function.FalseBit());
+        function.Store(generation, function.Literal<int>(0));
+
+        _numWorkers = numWorkers;
+        if (useWorkStealing)
+        {
+            // Allocate and initialize one (empty) deque per worker
+            _workerQueues = module.GlobalArray("taskWorkerQueues", GetWorkerQueueDataType(module), numWorkers);
+            function.For(numWorkers, [this, nullAttr](IRFunctionEmitter& function, LLVMValue index) {
+                auto workerQueue = GetWorkerQueuePointer(function, index);
+                function.PthreadMutexInit(function.GetStructFieldPointer(workerQueue, static_cast<int>(WorkerQueueFields::mutex)), nullAttr);
+                function.Store(function.GetStructFieldPointer(workerQueue, static_cast<int>(WorkerQueueFields::head)), function.Literal<int>(0));
+                function.Store(function.GetStructFieldPointer(workerQueue, static_cast<int>(WorkerQueueFields::tail)), function.Literal<int>(0));
+                function.Store(function.GetStructFieldPointer(workerQueue, static_cast<int>(WorkerQueueFields::workerIndex)), index);
+            });
+        }
+
+        _tasks.Initialize(function);
+    }
 
+    void IRThreadPoolTaskQueue::InitializeSharedRuntime(IRFunctionEmitter& function)
+    {
+        auto& module = function.GetModule();
+        auto int8PtrType = llvm::Type::getInt8PtrTy(module.GetLLVMContext());
+        _sharedTaskGroup = module.Global(int8PtrType, "sharedRuntimeTaskGroup");
         _tasks.Initialize(function);
     }
 
+    IRThreadPoolTaskArray& IRThreadPoolTaskQueue::StartSharedRuntimeTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments)
+    {
+        if (!UsesSharedRuntime())
+        {
+            InitializeSharedRuntime(function);
+        }
+
+        _tasks.SetTasks(function, taskFunction, arguments);
+        if (!taskFunction)
+        {
+            return GetTaskArray();
+        }
+
+        // The runtime runs the wrapped task function on each argument struct of the array, and fills in the return values
+        auto taskFunctionPtr = function.Load(_tasks.GetTaskFunctionPointer(function));
+        auto taskArgs = function.Load(_tasks.GetTaskArgsStoragePointer(function));
+        auto returnValues = function.Load(_tasks.GetReturnValuesStoragePointer(function));
+        auto startTasksFunction = function.GetModule().GetRuntime().GetSharedRuntimeStartTasksFunction();
+        auto taskGroup = function.Call(startTasksFunction, { taskFunctionPtr, taskArgs, _tasks.GetTaskArgsStructSize(function), function.Literal<int>(static_cast<int>(arguments.size())), returnValues });
+        function.Store(_sharedTaskGroup, taskGroup);
+        return GetTaskArray();
+    }
+
     IRThreadPoolTaskArray& IRThreadPoolTaskQueue::StartTasks(IRFunctionEmitter& function, LLVMFunction taskFunction, const std::vector<std::vector<LLVMValue>>& arguments)
     {
         assert(IsInitialized());
@@ -212,6 +457,14 @@ namespace emitters
         LockQueueMutex(function);
         _tasks.SetTasks(function, taskFunction, arguments);
         SetInitialCount(function, function.Literal<int>(numTasks));
+        if (IsWorkStealing())
+        {
+            DistributeTasks(function, static_cast<int>(numTasks));
+        }
+
+        // Bump the generation count so idle workers know new tasks have arrived
+        auto generationPtr = GetGenerationPointer(function);
+        function.Store(generationPtr, function.Operator(TypedOperator::add, function.Load(generationPtr), function.Literal<int>(1)));
         function.PthreadCondBroadcast(GetWorkAvailableConditionVariablePointer(function));
         UnlockQueueMutex(function);
         return GetTaskArray();
@@ -234,6 +487,11 @@ namespace emitters
         auto queueMutex = GetQueueMutexPointer(function);
         auto workAvailableCondVar = GetWorkAvailableConditionVariablePointer(function);
 
+        SpinWhile(function, [this](IRFunctionEmitter& function) {
+            auto isEmpty = function.Comparison(TypedComparison::equals, LoadVolatileField(function, static_cast<int>(Fields::unscheduledCount)), function.Literal<int>(0));
+            return function.Operator(TypedOperator::logicalAnd, isEmpty, function.Operator(UnaryOperatorType::logicalNot, LoadVolatileField(function, static_cast<int>(Fields::shutdownFlag))));
+        });
+
         LockQueueMutex(function);
         function.Store(isEmptyVar, function.Operator(TypedOperator::logicalAnd, IsEmpty(function), function.Operator(UnaryOperatorType::logicalNot, GetShutdownFlag(function))));
         function.While(isEmptyVar, [=](auto& function) {
@@ -271,15 +529,158 @@ namespace emitters
 
     void IRThreadPoolTaskQueue::ShutDown(IRFunctionEmitter& function)
     {
+        LockQueueMutex(function);
         SetShutdownFlag(function);
 
         // Now wake up the threads so they see it is time to shutdown.
         function.PthreadCondBroadcast(GetWorkAvailableConditionVariablePointer(function));
+        UnlockQueueMutex(function);
         // Now PopNextTask will emit null tasks
     }
 
+    LLVMValue IRThreadPoolTaskQueue::PopOrStealTaskIndex(IRFunctionEmitter& function, LLVMValue workerIndex)
+    {
+        assert(IsWorkStealing());
+
+        auto& context = function.GetLLVMContext();
+        auto int32Type = llvm::Type::getInt32Ty(context);
+
+        auto taskIndexVar = function.Variable(int32Type, "taskIndex");
+        function.Store(taskIndexVar, PopFrontTaskIndex(function, GetWorkerQueuePointer(function, workerIndex)));
+
+        // If our own deque is empty, try the other workers' deques in turn, starting with the next one
+        function.For(1, _numWorkers, [this, taskIndexVar, workerIndex](IRFunctionEmitter& function, LLVMValue offset) {
+            auto isEmpty = function.Comparison(TypedComparison::lessThan, function.Load(taskIndexVar), function.Literal<int>(0));
+            function.If(isEmpty, [this, taskIndexVar, workerIndex, offset](IRFunctionEmitter& function) {
+                auto victimIndex = function.Operator(TypedOperator::moduloSigned, function.Operator(TypedOperator::add, workerIndex, offset), function.Literal<int>(_numWorkers));
+                function.Store(taskIndexVar, PopBackTaskIndex(function, GetWorkerQueuePointer(function, victimIndex)));
+            });
+        });
+
+        return function.Load(taskIndexVar);
+    }
+
+    void IRThreadPoolTaskQueue::WaitForNewTasks(IRFunctionEmitter& function, LLVMValue numFinishedTasksVar, LLVMValue lastGenerationVar)
+    {
+        assert(IsWorkStealing());
+
+        auto& context = function.GetLLVMContext();
+        auto boolType = llvm::Type::getInt1Ty(context);
+
+        auto isWaitingVar = function.Variable(boolType, "isWaiting");
+        auto queueMutex = GetQueueMutexPointer(function);
+        auto workAvailableCondVar = GetWorkAvailableConditionVariablePointer(function);
+
+        LockQueueMutex(function);
+
+        // Report the tasks we finished, and signal the client if they were the last ones
+        auto numFinished = function.Load(numFinishedTasksVar);
+        function.If(function.Comparison(TypedComparison::greaterThan, numFinished, function.Literal<int>(0)), [this, numFinished, numFinishedTasksVar](IRFunctionEmitter& function) {
+            auto unfinishedCountPtr = function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::unfinishedCount));
+            auto newCount = function.Operator(TypedOperator::subtract, function.Load(unfinishedCountPtr), numFinished);
+            function.Store(unfinishedCountPtr, newCount);
+            function.Store(numFinishedTasksVar, function.Literal<int>(0));
+            function.If(function.Comparison(TypedComparison::equals, newCount, function.Literal<int>(0)), [this](IRFunctionEmitter& function) {
+                NotifyWaitingClients(function);
+            });
+        });
+
+        UnlockQueueMutex(function);
+
+        // Poll for a new batch of tasks for a while, then sleep until one is started (or we are shut down)
+        SpinWhile(function, [this, lastGenerationVar](IRFunctionEmitter& function) {
+            auto isOldGeneration = function.Comparison(TypedComparison::equals, LoadVolatileField(function, static_cast<int>(Fields::generation)), function.Load(lastGenerationVar));
+            return function.Operator(TypedOperator::logicalAnd, isOldGeneration, function.Operator(UnaryOperatorType::logicalNot, LoadVolatileField(function, static_cast<int>(Fields::shutdownFlag))));
+        });
+
+        LockQueueMutex(function);
+        auto isSameGeneration = [this, lastGenerationVar](IRFunctionEmitter& function) {
+            auto isOldGeneration = function.Comparison(TypedComparison::equals, function.Load(this->GetGenerationPointer(function)), function.Load(lastGenerationVar));
+            return function.Operator(TypedOperator::logicalAnd, isOldGeneration, function.Operator(UnaryOperatorType::logicalNot, this->GetShutdownFlag(function)));
+        };
+        function.Store(isWaitingVar, isSameGeneration(function));
+        function.While(isWaitingVar, [=](auto& function) {
+            function.PthreadCondWait(workAvailableCondVar, queueMutex);
+            function.Store(isWaitingVar, isSameGeneration(function));
+        });
+        function.Store(lastGenerationVar, function.Load(GetGenerationPointer(function)));
+
+        UnlockQueueMutex(function);
+    }
+
+    void IRThreadPoolTaskQueue::DistributeTasks(IRFunctionEmitter& function, int numTasks)
+    {
+        // Give each worker an even share of the task indices, as a contiguous [head, tail) range
+        for (int workerIndex = 0; workerIndex < _numWorkers; ++workerIndex)
+        {
+            auto begin = (numTasks * workerIndex) / _numWorkers;
+            auto end = (numTasks * (workerIndex + 1)) / _numWorkers;
+            auto workerQueue = GetWorkerQueuePointer(function, function.Literal<int>(workerIndex));
+            auto mutex = function.GetStructFieldPointer(workerQueue, static_cast<int>(WorkerQueueFields::mutex));
+            function.PthreadMutexLock(mutex);
+            function.Store(function.GetStructFieldPointer(workerQueue, static_cast<int>(WorkerQueueFields::head)), function.Literal<int>(begin));
+            function.Store(function.GetStructFieldPointer(workerQueue, static_cast<int>(WorkerQueueFields::tail)), function.Literal<int>(end));
+            function.PthreadMutexUnlock(mutex);
+        }
+    }
+
+    LLVMValue IRThreadPoolTaskQueue::PopFrontTaskIndex(IRFunctionEmitter& function, LLVMValue workerQueuePtr)
+    {
+        auto& context = function.GetLLVMContext();
+        auto int32Type = llvm::Type::getInt32Ty(context);
+
+        auto taskIndexVar = function.Variable(int32Type, "frontTaskIndex");
+        auto mutex = function.GetStructFieldPointer(workerQueuePtr, static_cast<int>(WorkerQueueFields::mutex));
+        auto headPtr = function.GetStructFieldPointer(workerQueuePtr, static_cast<int>(WorkerQueueFields::head));
+        auto tailPtr = function.GetStructFieldPointer(workerQueuePtr, static_cast<int>(WorkerQueueFields::tail));
+
+        function.Store(taskIndexVar, function.Literal<int>(-1));
+        function.PthreadMutexLock(mutex);
+        auto head = function.Load(headPtr);
+        function.If(function.Comparison(TypedComparison::lessThan, head, function.Load(tailPtr)), [=](IRFunctionEmitter& function) {
+            function.Store(taskIndexVar, head);
+            function.Store(headPtr, function.Operator(TypedOperator::add, head, function.Literal<int>(1)));
+        });
+        function.PthreadMutexUnlock(mutex);
+        return function.Load(taskIndexVar);
+    }
+
+    LLVMValue IRThreadPoolTaskQueue::PopBackTaskIndex(IRFunctionEmitter& function, LLVMValue workerQueuePtr)
+    {
+        auto& context = function.GetLLVMContext();
+        auto int32Type = llvm::Type::getInt32Ty(context);
+
+        auto taskIndexVar = function.Variable(int32Type, "backTaskIndex");
+        auto mutex = function.GetStructFieldPointer(workerQueuePtr, static_cast<int>(WorkerQueueFields::mutex));
+        auto headPtr = function.GetStructFieldPointer(workerQueuePtr, static_cast<int>(WorkerQueueFields::head));
+        auto tailPtr = function.GetStructFieldPointer(workerQueuePtr, static_cast<int>(WorkerQueueFields::tail));
+
+        function.Store(taskIndexVar, function.Literal<int>(-1));
+        function.PthreadMutexLock(mutex);
+        auto tail = function.Load(tailPtr);
+        function.If(function.Comparison(TypedComparison::lessThan, function.Load(headPtr), tail), [=](IRFunctionEmitter& function) {
+            auto newTail = function.Operator(TypedOperator::subtract, tail, function.Literal<int>(1));
+            function.Store(taskIndexVar, newTail);
+            function.Store(tailPtr, newTail);
+        });
+        function.PthreadMutexUnlock(mutex);
+        return function.Load(taskIndexVar);
+    }
+
     void IRThreadPoolTaskQueue::WaitAll(IRFunctionEmitter& function)
     {
+        if (UsesSharedRuntime())
+        {
+            // Waiting frees the handle, so it's cleared to make waiting again (e.g., once per task) a no-op
+            auto taskGroup = function.Load(_sharedTaskGroup);
+            auto isRunning = function.Comparison(TypedComparison::notEquals, taskGroup, function.NullPointer(llvm::Type::getInt8PtrTy(function.GetLLVMContext())));
+            function.If(isRunning, [this, taskGroup](IRFunctionEmitter& function) {
+                function.Call(function.GetModule().GetRuntime().GetSharedRuntimeWaitTasksFunction(), { taskGroup });
+                function.Store(_sharedTaskGroup, function.NullPointer(llvm::Type::getInt8PtrTy(function.GetLLVMContext())));
+            });
+            return;
+        }
+
         auto& module = function.GetModule();
         auto& context = module.GetLLVMContext();
         auto boolType = llvm::Type::getInt1Ty(context);
@@ -288,6 +689,10 @@ namespace emitters
         auto mutex = GetQueueMutexPointer(function);
         auto workFinishedCondVar = GetWorkFinishedConditionVariablePointer(function);
 
+        SpinWhile(function, [this](IRFunctionEmitter& function) {
+            return function.Comparison(TypedComparison::notEquals, LoadVolatileField(function, static_cast<int>(Fields::unfinishedCount)), function.Literal<int>(0));
+        });
+
         LockQueueMutex(function);
         function.Store(isNotDoneVar, function.Operator(UnaryOperatorType::logicalNot, IsFinished(function)));
         function.While(isNotDoneVar, [=](auto& function) {
@@ -305,10 +710,80 @@ namespace emitters
         auto boolType = llvm::Type::getInt1Ty(context);
         auto int32Type = llvm::Type::getInt32Ty(context);
 
-        std::vector<LLVMType> fieldTypes = { mutexType, conditionVarType, conditionVarType, int32Type, int32Type, boolType };
+        std::vector<LLVMType> fieldTypes = { mutexType, conditionVarType, conditionVarType, int32Type, int32Type, boolType, int32Type };
         return module.GetAnonymousStructType(fieldTypes);
     }
 
+    llvm::StructType* IRThreadPoolTaskQueue::GetWorkerQueueDataType(IRModuleEmitter& module) const
+    {
+        auto& context = module.GetLLVMContext();
+        auto mutexType = module.GetRuntime().GetPosixEmitter().GetPthreadMutexType();
+        auto int32Type = llvm::Type::getInt32Ty(context);
+
+        std::vector<LLVMType> fieldTypes = { mutexType, int32Type, int32Type, int32Type };
+        return module.GetAnonymousStructType(fieldTypes);
+    }
+
+    LLVMValue IRThreadPoolTaskQueue::GetWorkerQueuePointer(IRFunctionEmitter& function, LLVMValue workerIndex)
+    {
+        assert(IsWorkStealing());
+        return function.PointerOffset(_workerQueues, workerIndex);
+    }
+
+    LLVMValue IRThreadPoolTaskQueue::GetWorkerIndex(IRFunctionEmitter& function, LLVMValue workerQueuePtr)
+    {
+        assert(IsWorkStealing());
+        auto workerQueueType = GetWorkerQueueDataType(function.GetModule());
+        auto typedWorkerQueuePtr = function.CastPointer(workerQueuePtr, workerQueueType->getPointerTo());
+        return function.Load(function.GetStructFieldPointer(typedWorkerQueuePtr, static_cast<int>(WorkerQueueFields::workerIndex)));
+    }
+
+    LLVMValue IRThreadPoolTaskQueue::GetGenerationPointer(IRFunctionEmitter& function)
+    {
+        assert(IsInitialized());
+        return function.GetStructFieldPointer(_queueData, static_cast<int>(Fields::generation));
+    }
+
+    LLVMValue IRThreadPoolTaskQueue::LoadVolatileField(IRFunctionEmitter& function, int field) const
+    {
+        // Read without holding the queue mutex, so the load has to be done on every iteration of a polling loop
+        assert(IsInitialized());
+        return function.GetEmitter().GetIRBuilder().CreateLoad(function.GetStructFieldPointer(_queueData, field), true);
+    }
+
+    void IRThreadPoolTaskQueue::SpinWhile(IRFunctionEmitter& function, std::function<LLVMValue(IRFunctionEmitter&)> isWaiting)
+    {
+        if (_spinCount == 0 && _hotCount == nullptr)
+        {
+            return;
+        }
+
+        // The caller checks the condition again while holding the mutex, so polling is only a shortcut
+        auto& context = function.GetLLVMContext();
+        auto spinsLeftVar = function.Variable(llvm::Type::getInt32Ty(context), "spinsLeft");
+        auto isSpinningVar = function.Variable(llvm::Type::getInt1Ty(context), "isSpinning");
+        auto keepSpinning = [this, isWaiting, spinsLeftVar](IRFunctionEmitter& function) {
+            auto hasSpinsLeft = function.Comparison(TypedComparison::greaterThan, function.Load(spinsLeftVar), function.Literal<int>(0));
+            if (_hotCount != nullptr)
+            {
+                auto isHot = function.Comparison(TypedComparison::greaterThan, function.GetEmitter().GetIRBuilder().CreateLoad(_hotCount, true), function.Literal<int>(0));
+                hasSpinsLeft = function.Operator(TypedOperator::logicalOr, hasSpinsLeft, isHot);
+            }
+            return function.Operator(TypedOperator::logicalAnd, hasSpinsLeft, isWaiting(function));
+        };
+
+        function.Store(spinsLeftVar, function.Literal<int>(_spinCount));
+        function.Store(isSpinningVar, keepSpinning(function));
+        function.While(isSpinningVar, [=](IRFunctionEmitter& function) {
+            EmitSpinWaitHint(function);
+            auto spinsLeft = function.Load(spinsLeftVar);
+            function.If(function.Comparison(TypedComparison::greaterThan, spinsLeft, function.Literal<int>(0)), [spinsLeftVar, spinsLeft](IRFunctionEmitter& function) {
+                function.Store(spinsLeftVar, function.Operator(TypedOperator::subtract, spinsLeft, function.Literal<int>(1)));
+            });
+            function.Store(isSpinningVar, keepSpinning(function));
+        });
+    }
+
     LLVMValue IRThreadPoolTaskQueue::GetQueueMutexPointer(IRFunctionEmitter& function)
     {
         assert(IsInitialized());
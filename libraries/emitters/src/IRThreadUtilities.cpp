@@ -55,7 +55,11 @@ namespace emitters
                 taskFunctionArgs.push_back(taskWrapperFunction.Load(fieldPtr));
             }
 
+            // Tasks run on worker threads, so each one shows up on its worker's trace timeline
+            auto& profiler = module.GetProfiler();
+            auto traceStartTime = profiler.BeginTraceEvent(taskWrapperFunction);
             auto functionResult = taskWrapperFunction.Call(taskFunction, taskFunctionArgs);
+            profiler.EndTraceEvent(taskWrapperFunction, taskFunctionName, traceStartTime);
             if (functionResult->getType()->isSized())
             {
                 auto resultCast = taskWrapperFunction.BitCast(functionResult, int8PtrType);
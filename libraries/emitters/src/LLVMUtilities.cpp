@@ -33,6 +33,7 @@ namespace emitters
 
     emitters::TypedOperator GetOperator(LLVMType type, BinaryOperatorType operation)
     {
+        type = type->getScalarType(); // vectors use the operator of their elements
         if (type->isIntegerTy() && type->getIntegerBitWidth() == 1)
         {
             return GetBooleanOperator(operation);
@@ -51,6 +52,7 @@ namespace emitters
 
     emitters::TypedComparison GetComparison(LLVMType type, BinaryPredicateType comparison)
     {
+        type = type->getScalarType();
         if (type->isIntegerTy())
         {
             return GetIntegerComparison(comparison);
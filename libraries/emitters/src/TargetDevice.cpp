@@ -34,6 +34,7 @@ namespace emitters
         std::string c_armv7Triple = "armv7--linux-gnueabihf"; // raspberry pi 3 and orangepi0
         std::string c_arm64Triple = "aarch64-unknown-linux-gnu"; // DragonBoard
         std::string c_iosTriple = "aarch64-apple-ios"; // alternates: "arm64-apple-ios7.0.0", "thumbv7-apple-ios7.0"
+        std::string c_wasm32Triple = "wasm32-unknown-unknown"; // browsers and node.js, with no WASI or emscripten runtime
 
         // CPUs
         std::string c_pi0Cpu = "arm1136jf-s";
@@ -49,6 +50,7 @@ namespace emitters
         std::string c_armDataLayout = "e-m:e-p:32:32-i64:64-v128:64:128-a:0:32-n32-S64";
         std::string c_arm64DataLayout = "e-m:e-i64:64-i128:128-n32:64-S128"; // DragonBoard
         std::string c_iosDataLayout = "e-m:o-i64:64-i128:128-n32:64-S128";
+        std::string c_wasm32DataLayout = "e-m:e-p:32:32-i64:64-n32:64-S128";
 
         const std::map<std::string, std::function<void(TargetDevice&)>> KnownTargetDeviceNameMap = {
             { "mac", [](TargetDevice& targetDevice) {
@@ -68,18 +70,27 @@ namespace emitters
                  targetDevice.dataLayout = c_armDataLayout;
                  targetDevice.numBits = 32;
                  targetDevice.cpu = c_pi0Cpu; // maybe not necessary
+                 targetDevice.l1CacheSize = 16 * 1024;
+                 targetDevice.l2CacheSize = 128 * 1024;
+                 targetDevice.prefetchDistance = 128; // 4 of its 32-byte cache lines, since it has no hardware prefetcher
              } },
             { "pi3", [](TargetDevice& targetDevice) {
                  targetDevice.triple = c_armv7Triple;
                  targetDevice.dataLayout = c_armDataLayout;
                  targetDevice.numBits = 32;
                  targetDevice.cpu = c_pi3Cpu; // maybe not necessary
+                 targetDevice.l1CacheSize = 32 * 1024;
+                 targetDevice.l2CacheSize = 512 * 1024;
+                 targetDevice.prefetchDistance = 256; // in-order cores stall on each miss the prefetcher doesn't see coming
              } },
             { "orangepi0" /* orangepi (Raspbian) */, [](TargetDevice& targetDevice) {
                  targetDevice.triple = c_armv7Triple;
                  targetDevice.dataLayout = c_armDataLayout;
                  targetDevice.numBits = 32;
                  targetDevice.cpu = c_orangePi0Cpu; // maybe not necessary
+                 targetDevice.l1CacheSize = 32 * 1024;
+                 targetDevice.l2CacheSize = 256 * 1024;
+                 targetDevice.prefetchDistance = 256;
              } },
             { "pi3_64" /* pi3 (openSUSE) */, [](TargetDevice& targetDevice) {
                  // need to set arch to aarch64?
@@ -87,6 +98,9 @@ namespace emitters
                  targetDevice.dataLayout = c_arm64DataLayout;
                  targetDevice.numBits = 64;
                  targetDevice.cpu = c_pi3Cpu;
+                 targetDevice.l1CacheSize = 32 * 1024;
+                 targetDevice.l2CacheSize = 512 * 1024;
+                 targetDevice.prefetchDistance = 256;
              } },
             { "aarch64" /* arm64 linux (DragonBoard) */, [](TargetDevice& targetDevice) {
                  // need to set arch to aarch64?
@@ -97,6 +111,13 @@ namespace emitters
             { "ios", [](TargetDevice& targetDevice) {
                  targetDevice.triple = c_iosTriple;
                  targetDevice.dataLayout = c_iosDataLayout;
+             } },
+            { "wasm32", [](TargetDevice& targetDevice) {
+                 targetDevice.triple = c_wasm32Triple;
+                 targetDevice.dataLayout = c_wasm32DataLayout;
+                 targetDevice.architecture = "wasm32";
+                 targetDevice.numBits = 32;
+                 targetDevice.features = "+simd128"; // 128-bit SIMD, supported by current browsers and node.js
              } }
         };
 
@@ -110,9 +131,17 @@ namespace emitters
                  targetDevice.triple = "arm-none-eabi";
                  if (targetDevice.features.empty())
                  {
-                     targetDevice.features = "+armv7e-m,+v7,soft-float";
+                     targetDevice.features = "+armv7e-m,+v7,+dsp,soft-float";
                  }
                  targetDevice.architecture = "arm";
+             } },
+            { "cortex-m7", [](TargetDevice& targetDevice) {
+                 targetDevice.triple = "thumbv7em-none-eabi";
+                 if (targetDevice.features.empty())
+                 {
+                     targetDevice.features = "+armv7e-m,+v7,+dsp,soft-float";
+                 }
+                 targetDevice.architecture = "thumb";
              } }
         };
 
@@ -149,6 +178,21 @@ namespace emitters
         return tripleObj.getOS() == llvm::Triple::MacOSX || tripleObj.getOS() == llvm::Triple::Darwin;
     }
 
+    bool TargetDevice::HasDspExtension() const
+    {
+        if (features.find("-dsp") != std::string::npos)
+        {
+            return false;
+        }
+        return features.find("+dsp") != std::string::npos || cpu == "cortex-m4" || cpu == "cortex-m7";
+    }
+
+    bool TargetDevice::IsWebAssembly() const
+    {
+        auto tripleObj = GetNormalizedTriple(triple);
+        return tripleObj.getArch() == llvm::Triple::wasm32 || tripleObj.getArch() == llvm::Triple::wasm64;
+    }
+
     TargetDevice GetTargetDevice(std::string deviceName)
     {
         TargetDevice target;
@@ -9,6 +9,14 @@
 
 void TestIRAsyncTask(bool parallel);
 
-void TestParallelTasks(bool parallel, bool useThreadPool);
+void TestParallelTasks(bool parallel, bool useThreadPool, bool useWorkStealing = false, bool useSharedRuntime = false, int threadPoolSpinCount = 0);
 
-void TestParallelFor(int start, int end, int increment, bool parallel);
+void TestHotThreadPool();
+
+void TestParseCoreList();
+
+#include <emitters/include/CompilerOptions.h>
+
+void TestParallelFor(int start, int end, int increment, bool parallel, ell::emitters::ParallelLoopSchedule schedule = ell::emitters::ParallelLoopSchedule::staticBlocks, int chunkSize = 0);
+
+void TestNestedParallelFor(int rows, int columns);
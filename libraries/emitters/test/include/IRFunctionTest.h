@@ -10,3 +10,6 @@
 void TestIRAddFunction();
 void TestCompilableFunction();
 void TestStringCompareFunction();
+void TestFastMathFunctions();
+void TestVectorPrimitives();
+void TestOptimizationSettings();
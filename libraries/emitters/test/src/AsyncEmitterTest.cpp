@@ -37,6 +37,7 @@ using namespace ell::emitters;
 using VoidFunction = void (*)();
 using IntFunction = int (*)();
 using UnaryScalarFloatFunction = float (*)(float);
+using IntPredictFunction = void (*)(void*, int*);
 
 //
 // Tests
@@ -113,14 +114,17 @@ void TestIRAsyncTask(bool parallel)
 //
 // TestParallelTasks
 //
-void TestParallelTasks(bool parallel, bool useThreadPool)
+void TestParallelTasks(bool parallel, bool useThreadPool, bool useWorkStealing, bool useSharedRuntime, int threadPoolSpinCount)
 {
-    std::cout << "Testing parallel tasks in " << (parallel ? (useThreadPool ? "threadpool" : "async") : "deferred") << " mode" << std::endl;
+    std::cout << "Testing parallel tasks in " << (parallel ? (useSharedRuntime ? "shared runtime" : (useThreadPool ? (useWorkStealing ? "work-stealing threadpool" : "threadpool") : "async")) : "deferred") << " mode" << std::endl;
     CompilerOptions options;
     options.optimize = false;
     options.targetDevice.deviceName = "host";
     options.parallelize = parallel;
     options.useThreadPool = useThreadPool;
+    options.useWorkStealing = useWorkStealing;
+    options.useSharedRuntime = useSharedRuntime;
+    options.threadPoolSpinCount = threadPoolSpinCount;
     IRModuleEmitter module("ThreadPoolTest", options);
 
     // Types
@@ -209,10 +213,102 @@ void TestParallelTasks(bool parallel, bool useThreadPool)
     }
 }
 
+//
+// TestHotThreadPool
+//
+void TestHotThreadPool()
+{
+    CompilerOptions options;
+    options.optimize = false;
+    options.targetDevice.deviceName = "host";
+    options.parallelize = true;
+    options.useThreadPool = true;
+    options.hotThreadPool = true;
+    IRModuleEmitter module("HotThreadPoolTest", options);
+
+    auto taskFunction = module.BeginFunction("TestTaskFunction", VariableType::Int32, NamedVariableTypeList{ { "value", VariableType::Int32 } });
+    {
+        auto value = taskFunction.GetFunctionArgument("value");
+        taskFunction.Return(taskFunction.Operator(TypedOperator::multiply, value, value));
+    }
+    module.EndFunction();
+
+    // The predict function marks the hot region, so the workers keep polling while it runs
+    const int numTasks = 8;
+    int desiredResult = 0;
+    std::string predictFunctionName = "HotThreadPoolTest_Predict";
+    FunctionArgumentList predictArguments = { { "context", VariableType::VoidPointer, ArgumentFlags::Input }, { "output", VariableType::Int32Pointer, ArgumentFlags::Output } };
+    module.BeginMapPredictFunction(predictFunctionName, predictArguments);
+    {
+        auto& function = module.GetCurrentFunction();
+        std::vector<std::vector<LLVMValue>> taskArrayArgs;
+        for (int index = 0; index < numTasks; ++index)
+        {
+            desiredResult += index * index;
+            taskArrayArgs.push_back({ function.Literal<int>(index) });
+        }
+
+        // Start two batches, to check the workers pick up new tasks while they're polling
+        auto output = function.GetFunctionArgument("output");
+        function.Store(output, function.Literal<int>(0));
+        for (int batch = 0; batch < 2; ++batch)
+        {
+            auto tasks = function.StartTasks(taskFunction, taskArrayArgs);
+            tasks.WaitAll(function);
+            for (int index = 0; index < numTasks; ++index)
+            {
+                auto returnValue = tasks.GetTask(function, index).GetReturnValue(function);
+                function.Store(output, function.Operator(TypedOperator::add, function.Load(output), returnValue));
+            }
+        }
+    }
+    module.EndMapPredictFunction();
+
+    IRExecutionEngine executionEngine(std::move(module));
+    auto predictFunction = (IntPredictFunction)executionEngine.ResolveFunctionAddress(predictFunctionName);
+
+    // The workers go back to sleep between calls, so the second call has to wake them up again
+    int result1 = 0;
+    int result2 = 0;
+    predictFunction(nullptr, &result1);
+    predictFunction(nullptr, &result2);
+    testing::ProcessTest("Testing hot thread pool", testing::IsEqual(result1, 2 * desiredResult) && testing::IsEqual(result2, 2 * desiredResult));
+
+    auto hotCount = reinterpret_cast<int*>(executionEngine.GetGlobalValueAddress("threadPoolHotCount"));
+    testing::ProcessTest("Testing hot thread pool region count is balanced", hotCount != nullptr && *hotCount == 0);
+}
+
+//
+// TestParseCoreList
+//
+void TestParseCoreList()
+{
+    testing::ProcessTest("Testing ParseCoreList with single cores", testing::IsEqual(ParseCoreList("0,2,5"), std::vector<int>{ 0, 2, 5 }));
+    testing::ProcessTest("Testing ParseCoreList with ranges", testing::IsEqual(ParseCoreList("0-2,8,4-5"), std::vector<int>{ 0, 1, 2, 8, 4, 5 }));
+    testing::ProcessTest("Testing ParseCoreList with a one-core range", testing::IsEqual(ParseCoreList("3-3"), std::vector<int>{ 3 }));
+    testing::ProcessTest("Testing ParseCoreList keeps duplicates", testing::IsEqual(ParseCoreList("1,1,0-1"), std::vector<int>{ 1, 1, 0, 1 }));
+    testing::ProcessTest("Testing ParseCoreList with empty entries", testing::IsEqual(ParseCoreList(",1,,2,"), std::vector<int>{ 1, 2 }));
+    testing::ProcessTest("Testing ParseCoreList with an empty list", ParseCoreList("").empty());
+
+    for (std::string badList : { "a", "1,b", "3abc", " 3", "-1", "1-", "-", "5-3", "1-2-3", "0x1", "99999999999" })
+    {
+        bool threw = false;
+        try
+        {
+            ParseCoreList(badList);
+        }
+        catch (utilities::InputException&)
+        {
+            threw = true;
+        }
+        testing::ProcessTest("Testing ParseCoreList rejects \"" + badList + "\"", threw);
+    }
+}
+
 //
 // TestParallelFor
 //
-void TestParallelFor(int begin, int end, int increment, bool parallel)
+void TestParallelFor(int begin, int end, int increment, bool parallel, ParallelLoopSchedule schedule, int chunkSize)
 {
     CompilerOptions options;
     options.optimize = false;
@@ -233,7 +329,7 @@ void TestParallelFor(int begin, int end, int increment, bool parallel)
             function.SetValueAt(data, i, function.Literal<int>(-1));
         });
 
-        testParallelForFunction.ParallelFor(begin, end, increment, {}, { data }, [](IRFunctionEmitter& function, LLVMValue i, std::vector<LLVMValue> capturedValues) {
+        testParallelForFunction.ParallelFor(begin, end, increment, { 0, schedule, chunkSize }, { data }, [](IRFunctionEmitter& function, LLVMValue i, std::vector<LLVMValue> capturedValues) {
             auto data = capturedValues[0];
             function.SetValueAt(data, i, i);
         });
@@ -258,7 +354,7 @@ void TestParallelFor(int begin, int end, int increment, bool parallel)
         // Call the function
         auto functionPtr = (IntFunction)executionEngine.ResolveFunctionAddress(functionName);
         auto result = functionPtr();
-        testing::ProcessTest("Testing compilable parallel for loop", testing::IsEqual(result, 0));
+        testing::ProcessTest("Testing compilable parallel for loop with " + ToString(schedule) + " schedule", testing::IsEqual(result, 0));
     }
     catch (utilities::Exception& exception)
     {
@@ -267,3 +363,41 @@ void TestParallelFor(int begin, int end, int increment, bool parallel)
         throw;
     }
 }
+
+void TestNestedParallelFor(int rows, int columns)
+{
+    CompilerOptions options;
+    options.optimize = false;
+    options.targetDevice.deviceName = "host";
+    options.parallelize = true;
+    options.useThreadPool = true;
+    IRModuleEmitter module("NestedParallelForTest", options);
+
+    // The inner loop runs inside the outer loop's tasks, so it should be emitted as a serial loop
+    std::string functionName = "TestNestedParallelFor";
+    auto testFunction = module.BeginFunction(functionName, VariableType::Int32);
+    {
+        auto data = testFunction.GetModule().GlobalArray(VariableType::Int32, "data", rows * columns);
+        testFunction.ParallelFor(rows, { 0, ParallelLoopSchedule::dynamic, 1 }, { data }, [columns](IRFunctionEmitter& function, IRLocalScalar row, std::vector<LLVMValue> capturedValues) {
+            function.ParallelFor(columns, { capturedValues[0], row }, [columns](IRFunctionEmitter& function, IRLocalScalar column, std::vector<LLVMValue> capturedValues) {
+                auto index = function.LocalScalar(capturedValues[1]) * columns + column;
+                function.SetValueAt(capturedValues[0], index, index);
+            });
+        });
+
+        auto result = testFunction.Variable(VariableType::Int32, "result");
+        testFunction.Store(result, testFunction.Literal<int>(0));
+        testFunction.For(rows * columns, [data, result](IRFunctionEmitter& function, LLVMValue i) {
+            function.If(function.LocalScalar(function.ValueAt(data, i)) != function.LocalScalar(i), [result](IRFunctionEmitter& function) {
+                function.Store(result, function.Literal(1));
+            });
+        });
+        testFunction.Return(testFunction.Load(result));
+    }
+    module.EndFunction();
+
+    IRExecutionEngine executionEngine(std::move(module));
+    auto functionPtr = (IntFunction)executionEngine.ResolveFunctionAddress(functionName);
+    auto result = functionPtr();
+    testing::ProcessTest("Testing nested parallel for loops", testing::IsEqual(result, 0));
+}
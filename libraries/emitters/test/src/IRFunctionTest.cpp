@@ -17,15 +17,24 @@
 #include <emitters/include/IRExecutionEngine.h>
 #include <emitters/include/IRFunctionEmitter.h>
 #include <emitters/include/IRLocalScalar.h>
+#include <emitters/include/IRMath.h>
 #include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/IROptimizer.h>
+#include <emitters/include/IRVectorUtilities.h>
 #include <emitters/include/Variable.h>
 
 #include <testing/include/testing.h>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <memory>
 #include <ostream>
 #include <string>
+#include <type_traits>
 
 using namespace ell;
 using namespace ell::emitters;
@@ -52,6 +61,64 @@ public:
 using UnaryScalarDoubleFunction = double (*)(double);
 using BinaryScalarDoubleFunction = double (*)(double, double);
 
+template <typename ValueType>
+void TestFastMathFunctions(FastMathAccuracy accuracy, double tolerance)
+{
+    struct FastMathTestCase
+    {
+        std::string name;
+        IRLocalScalar (*fastFunction)(IRLocalScalar, FastMathAccuracy);
+        std::function<ValueType(ValueType)> referenceFunction;
+        double minArg;
+        double maxArg;
+    };
+    std::vector<FastMathTestCase> testCases = {
+        { "exp", &FastExp, [](ValueType x) { return std::exp(x); }, -80, 80 },
+        { "log", &FastLog, [](ValueType x) { return std::log(x); }, 1e-6, 1e6 },
+        { "tanh", &FastTanh, [](ValueType x) { return std::tanh(x); }, -10, 10 },
+        { "sigmoid", &FastSigmoid, [](ValueType x) { return 1 / (1 + std::exp(-x)); }, -30, 30 },
+    };
+
+    CompilerOptions options;
+    IRModuleEmitter module("FastMathFunctions", options);
+    auto valueType = GetVariableType<ValueType>();
+    for (const auto& testCase : testCases)
+    {
+        auto function = module.BeginFunction(testCase.name, valueType, NamedVariableTypeList{ { "x", valueType } });
+        auto x = function.LocalScalar(function.GetFunctionArgument("x"));
+        function.Return(testCase.fastFunction(x, accuracy));
+        module.EndFunction();
+    }
+
+    IRExecutionEngine executionEngine(std::move(module));
+    std::map<std::string, ValueType (*)(ValueType)> compiledFunctions;
+    for (const auto& testCase : testCases)
+    {
+        auto compiledFunction = (ValueType(*)(ValueType))executionEngine.ResolveFunctionAddress(testCase.name);
+        compiledFunctions[testCase.name] = compiledFunction;
+
+        const int numSamples = 1000;
+        bool ok = true;
+        for (int i = 0; i <= numSamples; ++i)
+        {
+            auto x = static_cast<ValueType>(testCase.minArg + (testCase.maxArg - testCase.minArg) * i / numSamples);
+            double expected = testCase.referenceFunction(x);
+            double actual = compiledFunction(x);
+            ok = ok && std::abs(actual - expected) <= tolerance * std::max(1.0, std::abs(expected));
+        }
+        testing::ProcessTest("Testing fast " + testCase.name + "<" + std::string(std::is_same_v<ValueType, float> ? "float" : "double") + "> with " + ToString(accuracy) + " accuracy", ok);
+    }
+
+    const auto infinity = std::numeric_limits<ValueType>::infinity();
+    auto exp = compiledFunctions["exp"];
+    auto log = compiledFunctions["log"];
+    auto tanh = compiledFunctions["tanh"];
+    auto sigmoid = compiledFunctions["sigmoid"];
+    testing::ProcessTest("Testing fast math special values with " + ToString(accuracy) + " accuracy",
+                         exp(-1000) == 0 && exp(1000) == infinity && log(0) == -infinity && std::isnan(log(-1)) && log(infinity) == infinity &&
+                             tanh(50) == 1 && tanh(-50) == -1 && sigmoid(-1000) == 0 && sigmoid(1000) == 1);
+}
+
 //
 // Tests
 //
@@ -142,4 +209,133 @@ void TestStringCompareFunction()
     testing::ProcessTest("Testing string comparison function",
                          testing::IsEqual(u, 0) && testing::IsEqual(v, 0) && testing::IsEqual(x, 0) && testing::IsEqual(y, 0) &&
                              testing::IsEqual(z, 1));
-}
\ No newline at end of file
+}
+
+void TestFastMathFunctions()
+{
+    TestFastMathFunctions<float>(FastMathAccuracy::high, 1e-6);
+    TestFastMathFunctions<float>(FastMathAccuracy::low, 2e-4);
+    TestFastMathFunctions<double>(FastMathAccuracy::high, 1e-13);
+    TestFastMathFunctions<double>(FastMathAccuracy::low, 2e-4);
+}
+
+void TestVectorPrimitives()
+{
+    const int size = 10;
+    const int vectorSize = 4;
+    CompilerOptions options;
+    IRModuleEmitter module("VectorPrimitives", options);
+
+    NamedVariableTypeList args = { { "a", VariableType::FloatPointer }, { "b", VariableType::FloatPointer }, { "out", VariableType::FloatPointer } };
+    auto function = module.BeginFunction("VectorPrimitives", VariableType::Void, args);
+    auto a = function.GetFunctionArgument("a");
+    auto b = function.GetFunctionArgument("b");
+    auto out = function.GetFunctionArgument("out");
+    auto zero = function.Literal<int>(0);
+
+    // out[0] = a . b
+    function.SetValueAt(out, zero, EmitVectorizedDotProduct<float>(function, size, a, b, vectorSize, 2));
+
+    // out[1..5) = a[0..4) * b[0..4) + a[4..8)
+    auto aVector = LoadUnalignedVector<float>(function, a, zero, vectorSize);
+    auto bVector = LoadUnalignedVector<float>(function, b, zero, vectorSize);
+    auto fma = VectorMultiplyAdd<float>(function, aVector, bVector, LoadUnalignedVector<float>(function, a, function.Literal<int>(4), vectorSize));
+    StoreUnalignedVector<float>(function, out, function.Literal<int>(1), fma);
+
+    // out[5..9) = <a0, b0, a1, b1>, out[9..13) = <a2, b2, a3, b3>
+    StoreUnalignedVector<float>(function, out, function.Literal<int>(5), InterleaveVectors(function, aVector, bVector, false));
+    StoreUnalignedVector<float>(function, out, function.Literal<int>(9), InterleaveVectors(function, aVector, bVector, true));
+
+    // out[13..17) = a[1] + b[0..4)
+    auto sum = function.Operator(TypedOperator::addFloat, BroadcastVector(function, function.ValueAt(a, function.Literal<int>(1)), vectorSize), bVector);
+    StoreUnalignedVector<float>(function, out, function.Literal<int>(13), sum);
+
+    // out[17..27) = a - b, in a loop tagged as having independent iterations
+    function.VectorizedFor(zero, function.Literal<int>(size), vectorSize, true, [a, b, out](IRFunctionEmitter& function, IRLocalScalar i) {
+        auto difference = function.LocalScalar(function.ValueAt(a, i)) - function.LocalScalar(function.ValueAt(b, i));
+        function.SetValueAt(out, i + 17, difference);
+    });
+    function.Return();
+    module.EndFunction();
+
+    IRExecutionEngine executionEngine(std::move(module));
+    auto compiledFunction = executionEngine.GetFunction<void(float*, float*, float*)>("VectorPrimitives");
+
+    std::vector<float> aData = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    std::vector<float> bData = { 2, -1, 3, 0, 1, 4, -2, 5, 1, 2 };
+    std::vector<float> expected = { 0, 7, 4, 16, 8, 1, 2, 2, -1, 3, 3, 4, 0, 4, 1, 5, 2 };
+    for (int i = 0; i < size; ++i)
+    {
+        expected[0] += aData[i] * bData[i];
+        expected.push_back(aData[i] - bData[i]);
+    }
+
+    std::vector<float> result(expected.size());
+    compiledFunction(aData.data(), bData.data(), result.data());
+    testing::ProcessTest("Testing vector primitives", testing::IsEqual(result, expected));
+}
+
+void TestOptimizationSettings()
+{
+    auto emitSumFunction = [](IRModuleEmitter& module, const std::string& name) {
+        NamedVariableTypeList args = { { "a", VariableType::FloatPointer }, { "size", VariableType::Int32 } };
+        auto function = module.BeginFunction(name, VariableType::Float, args);
+        auto a = function.GetFunctionArgument("a");
+        auto sum = function.Variable(VariableType::Float, "sum");
+        function.Store(sum, function.Literal<float>(0));
+        function.For(function.GetFunctionArgument("size"), [a, sum](IRFunctionEmitter& function, IRLocalScalar i) {
+            function.Store(sum, function.LocalScalar(function.Load(sum)) + function.LocalScalar(function.ValueAt(a, i)));
+        });
+        function.Return(function.Load(sum));
+        module.EndFunction();
+        return module.GetFunction(name);
+    };
+
+    // The module is optimized for minimum size, except for one function optimized for speed and one left unoptimized
+    CompilerOptions options;
+    options.sizeOptimization = SizeOptimization::minSize;
+    IRModuleEmitter module("OptimizationSettings", options);
+    auto defaultFunction = emitSumFunction(module, "SumDefault");
+    auto hotFunction = emitSumFunction(module, "SumHot");
+    auto coldFunction = emitSumFunction(module, "SumCold");
+    auto hotOptions = options;
+    hotOptions.sizeOptimization = SizeOptimization::speed;
+    SetOptimizationAttributes(*hotFunction, hotOptions);
+    auto coldOptions = options;
+    coldOptions.optimizationLevel = 0;
+    SetOptimizationAttributes(*coldFunction, coldOptions);
+
+    IROptimizer optimizer(module);
+    optimizer.AddStandardPasses();
+    module.Optimize(optimizer);
+
+    testing::ProcessTest("Testing module size optimization", defaultFunction->hasFnAttribute(llvm::Attribute::MinSize) && !defaultFunction->hasFnAttribute(llvm::Attribute::OptimizeNone));
+    testing::ProcessTest("Testing function speed optimization", !hotFunction->hasFnAttribute(llvm::Attribute::MinSize) && !hotFunction->hasFnAttribute(llvm::Attribute::OptimizeForSize));
+    testing::ProcessTest("Testing unoptimized function", coldFunction->hasFnAttribute(llvm::Attribute::OptimizeNone) && coldFunction->hasFnAttribute(llvm::Attribute::NoInline) && !coldFunction->hasFnAttribute(llvm::Attribute::MinSize));
+    testing::ProcessTest("Testing functions left unoptimized with time to spare", optimizer.GetNumUnoptimizedFunctions() == 0);
+
+    std::vector<float> data = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    IRExecutionEngine executionEngine(std::move(module));
+    bool isCorrect = true;
+    for (const auto& name : { "SumDefault", "SumHot", "SumCold" })
+    {
+        auto compiledFunction = executionEngine.GetFunction<float(float*, int)>(name);
+        isCorrect &= compiledFunction(data.data(), static_cast<int>(data.size())) == 55.0f;
+    }
+    testing::ProcessTest("Testing functions with different optimization settings", isCorrect);
+
+    // With no time to optimize, every function is compiled unoptimized
+    CompilerOptions budgetOptions;
+    budgetOptions.maxOptimizationSeconds = 1e-9;
+    IRModuleEmitter budgetModule("OptimizationBudget", budgetOptions);
+    auto function1 = emitSumFunction(budgetModule, "Sum1");
+    auto function2 = emitSumFunction(budgetModule, "Sum2");
+    IROptimizer budgetOptimizer(budgetModule);
+    budgetOptimizer.AddStandardPasses();
+    budgetModule.Optimize(budgetOptimizer);
+    testing::ProcessTest("Testing optimization time budget", budgetOptimizer.GetNumUnoptimizedFunctions() >= 2 && function1->hasFnAttribute(llvm::Attribute::OptimizeNone) && function2->hasFnAttribute(llvm::Attribute::OptimizeNone));
+
+    IRExecutionEngine budgetExecutionEngine(std::move(budgetModule));
+    auto sum = budgetExecutionEngine.GetFunction<float(float*, int)>("Sum1");
+    testing::ProcessTest("Testing unoptimized function after time budget", sum(data.data(), static_cast<int>(data.size())) == 55.0f);
+}
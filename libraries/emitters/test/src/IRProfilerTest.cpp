@@ -20,8 +20,10 @@
 
 #include <testing/include/testing.h>
 
+#include <utilities/include/Files.h>
 #include <utilities/include/Unused.h>
 
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -151,3 +153,102 @@ void TestProfileRegion()
     testing::ProcessTest("Testing profile regions", testing::IsEqual(r1->count, 0));
     testing::ProcessTest("Testing profile regions", testing::IsEqual(r1->totalTime, 0.0));
 }
+
+void TestProfileRegionHardwareCounters()
+{
+    CompilerOptions options;
+    options.optimize = false;
+    options.profile = true;
+    options.profileHardwareCounters = true;
+    std::string moduleName = "HardwareCountersFunction";
+    IRModuleEmitter module(moduleName, options);
+    module.DeclarePrintf();
+
+    std::string functionName = "TestProfileRegionHardwareCounters";
+    auto function = module.BeginFunction(functionName, VariableType::Void);
+    {
+        IRProfileRegionBlock region(function, "TestRegion");
+        int vecSize = 10000;
+        int numIter = 10;
+        auto vec = function.Variable(VariableType::Double, vecSize);
+        function.For(numIter, [vec, vecSize](IRFunctionEmitter& function, auto) {
+            auto dotSum = function.DotProduct(vecSize, vec, vec);
+            UNUSED(dotSum);
+        });
+    }
+    module.EndFunction();
+
+    auto getRegionInfoFunctionName = module.GetProfiler().GetGetRegionProfilingInfoFunctionName();
+    auto resetRegionsFunctionName = module.GetProfiler().GetResetRegionProfilingInfoFunctionName();
+
+    IRExecutionEngine executionEngine(std::move(module));
+
+    using VoidFunctionType = void (*)();
+    using GetRegionFunctionType = ProfileRegionInfo* (*)(int32_t);
+    auto compiledFunction = (VoidFunctionType)executionEngine.ResolveFunctionAddress(functionName);
+    auto getRegionInfoFunction = (GetRegionFunctionType)executionEngine.ResolveFunctionAddress(getRegionInfoFunctionName);
+    compiledFunction();
+    compiledFunction();
+
+    // The counters may not be readable on the test machine, in which case they read as zero, but they never go backwards
+    auto r0 = getRegionInfoFunction(0);
+    testing::ProcessTest("Testing profile region hardware counters", testing::IsEqual(r0->count, 2));
+    testing::ProcessTest("Testing profile region hardware counters", r0->cycles >= 0 && r0->instructions >= 0 && r0->l1DataCacheMisses >= 0 && r0->lastLevelCacheMisses >= 0 && r0->branchMisses >= 0);
+
+    auto resetProfileResultsFunction = (VoidFunctionType)executionEngine.ResolveFunctionAddress(resetRegionsFunctionName);
+    resetProfileResultsFunction();
+    r0 = getRegionInfoFunction(0);
+    testing::ProcessTest("Testing profile region hardware counters reset", testing::IsEqual(r0->cycles, static_cast<int64_t>(0)) && testing::IsEqual(r0->instructions, static_cast<int64_t>(0)) && testing::IsEqual(r0->branchMisses, static_cast<int64_t>(0)));
+}
+
+void TestProfileTrace()
+{
+    CompilerOptions options;
+    options.optimize = false;
+    options.profile = true;
+    options.traceExecution = true;
+    std::string moduleName = "TraceFunction";
+    IRModuleEmitter module(moduleName, options);
+    module.DeclarePrintf();
+
+    std::string functionName = "TestProfileTrace";
+    auto function = module.BeginFunction(functionName, VariableType::Void);
+    {
+        IRProfileRegionBlock region(function, "TracedRegion");
+        auto vec = function.Variable(VariableType::Double, 1000);
+        auto dotSum = function.DotProduct(1000, vec, vec);
+        UNUSED(dotSum);
+    }
+    module.EndFunction();
+
+    auto writeTraceFunctionName = module.GetProfiler().GetWriteProfileTraceFunctionName();
+    auto resetTraceFunctionName = module.GetProfiler().GetResetProfileTraceFunctionName();
+
+    IRExecutionEngine executionEngine(std::move(module));
+
+    using VoidFunctionType = void (*)();
+    using WriteTraceFunctionType = int32_t (*)(const char*);
+    auto compiledFunction = (VoidFunctionType)executionEngine.ResolveFunctionAddress(functionName);
+    auto writeTraceFunction = (WriteTraceFunctionType)executionEngine.ResolveFunctionAddress(writeTraceFunctionName);
+    auto resetTraceFunction = (VoidFunctionType)executionEngine.ResolveFunctionAddress(resetTraceFunctionName);
+
+    auto readFile = [](const std::string& filename) {
+        auto stream = utilities::OpenIfstream(filename);
+        return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    };
+
+    compiledFunction();
+    compiledFunction();
+    const std::string traceFilename = "TestProfileTrace.json";
+    testing::ProcessTest("Testing profile trace write", testing::IsEqual(writeTraceFunction(traceFilename.c_str()), 0));
+    auto trace = readFile(traceFilename);
+    testing::ProcessTest("Testing profile trace format", trace.find("\"traceEvents\"") != std::string::npos && trace.find("\"ph\": \"X\"") != std::string::npos);
+
+    // Both calls to the function appear as events
+    auto firstEvent = trace.find("\"TracedRegion\"");
+    testing::ProcessTest("Testing profile trace events", firstEvent != std::string::npos && trace.find("\"TracedRegion\"", firstEvent + 1) != std::string::npos);
+
+    resetTraceFunction();
+    testing::ProcessTest("Testing profile trace reset", testing::IsEqual(writeTraceFunction(traceFilename.c_str()), 0));
+    testing::ProcessTest("Testing profile trace reset", readFile(traceFilename).find("\"TracedRegion\"") == std::string::npos);
+}
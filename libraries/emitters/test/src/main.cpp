@@ -59,6 +59,9 @@ void TestIRFunction()
 {
     TestIRAddFunction();
     TestCompilableFunction();
+    TestFastMathFunctions();
+    TestVectorPrimitives();
+    TestOptimizationSettings();
 }
 
 void TestAsyncEmitter()
@@ -69,6 +72,11 @@ void TestAsyncEmitter()
     TestParallelTasks(false, false); // deferred mode (no threads)
     TestParallelTasks(true, false); // async mode (always spin up a new thread)
     // TestParallelTasks(true, true);   // threadpool mode -- threadpool sometimes crashes or hangs when run in the JIT
+    TestParallelTasks(true, true, true); // work-stealing threadpool mode
+    TestParallelTasks(true, true, false, false, 1000); // threadpool mode with workers polling before they block
+    TestHotThreadPool(); // threadpool mode with workers polling for the whole predict call
+    TestParseCoreList();
+    TestParallelTasks(true, true, false, true); // shared runtime mode -- the tasks run on the runtime library's pool
 
     //
     TestParallelFor(0, 100, 1, false);
@@ -83,6 +91,11 @@ void TestAsyncEmitter()
     TestParallelFor(10, 90, 2, true);
     TestParallelFor(10, 90, 3, true);
     TestParallelFor(30, 40, 11, true);
+    TestParallelFor(0, 100, 1, true, emitters::ParallelLoopSchedule::dynamic, 0);
+    TestParallelFor(10, 90, 3, true, emitters::ParallelLoopSchedule::dynamic, 4);
+    TestParallelFor(0, 100, 1, true, emitters::ParallelLoopSchedule::guided, 0);
+    TestParallelFor(30, 40, 11, true, emitters::ParallelLoopSchedule::guided, 2);
+    TestNestedParallelFor(7, 13);
 }
 
 void TestPosixEmitter()
@@ -94,6 +107,8 @@ void TestPosixEmitter()
 void TestProfiler()
 {
     TestProfileRegion();
+    TestProfileRegionHardwareCounters();
+    TestProfileTrace();
 }
 
 void TestStdlibEmitter()
@@ -15,10 +15,22 @@ namespace ell
 {
 namespace evaluators
 {
-    /// <summary> An evaluation aggregator that computes AUC. </summary>
+    /// <summary>
+    /// An evaluation aggregator that computes AUC. By default, it approximates the AUC from a histogram of the
+    /// predictions, which takes constant memory and no sorting, and counts the pairs of examples in the same bin as half
+    /// ordered. With no bins, it keeps every prediction and computes the exact (pessimistic) AUC by sorting them.
+    /// </summary>
     class AUCAggregator
     {
     public:
+        /// <summary> The default number of histogram bins. </summary>
+        static constexpr size_t defaultNumBins = 4096;
+
+        /// <summary> Constructs an instance of AUCAggregator. </summary>
+        ///
+        /// <param name="numBins"> The number of histogram bins, or 0 to compute the exact AUC. </param>
+        AUCAggregator(size_t numBins = defaultNumBins);
+
         /// <summary> Updates this aggregator. </summary>
         ///
         /// <param name="prediction"> The real valued prediction. </param>
@@ -31,6 +43,11 @@ namespace evaluators
         /// <returns> The current value. </returns>
         std::vector<double> GetResult() const;
 
+        /// <summary> Adds the examples seen by another aggregator to this one. </summary>
+        ///
+        /// <param name="other"> The other aggregator. </param>
+        void Merge(const AUCAggregator& other);
+
         /// <summary> Resets the aggregator to its initial state. </summary>
         void Reset();
 
@@ -49,6 +66,13 @@ namespace evaluators
             bool operator<(const Aggregate& other) const;
         };
 
+        size_t GetBin(double prediction) const;
+        std::vector<double> GetHistogramResult() const;
+        std::vector<double> GetExactResult() const;
+
+        size_t _numBins;
+        std::vector<double> _positiveWeights; // per bin
+        std::vector<double> _negativeWeights; // per bin
         mutable std::vector<Aggregate> _aggregates; // mutable because Get() const has to sort this vector
     };
 } // namespace evaluators
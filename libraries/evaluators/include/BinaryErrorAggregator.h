@@ -31,6 +31,11 @@ namespace evaluators
         /// <returns> The current value. </returns>
         std::vector<double> GetResult() const;
 
+        /// <summary> Adds the examples seen by another aggregator to this one. </summary>
+        ///
+        /// <param name="other"> The other aggregator. </param>
+        void Merge(const BinaryErrorAggregator& other);
+
         /// <summary> Resets the aggregator to its initial state. </summary>
         void Reset();
 
@@ -14,7 +14,9 @@
 #include <data/include/Example.h>
 
 #include <utilities/include/FunctionUtils.h>
+#include <utilities/include/ParallelFor.h>
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <tuple>
@@ -54,6 +56,12 @@ namespace evaluators
     {
         size_t evaluationFrequency;
         bool addZeroEvaluation;
+
+        /// <summary>
+        /// The number of threads that evaluate parts of the dataset, each with its own copies of the aggregators,
+        /// which are merged at the end (0 = one per core).
+        /// </summary>
+        size_t numThreads = 1;
     };
 
     /// <summary> Implements an evaluator that holds a data set and a set of evaluation aggregators. </summary>
@@ -105,24 +113,10 @@ namespace evaluators
         template <size_t Index>
         using AggregatorType = typename std::tuple_element<Index, std::tuple<AggregatorTypes...>>::type;
 
-        struct ElementUpdaterParameters
-        {
-            double prediction;
-            double label;
-            double weight;
-        };
-
-        template <typename AggregatorT>
-        class ElementUpdater
-        {
-        public:
-            ElementUpdater(AggregatorT& aggregator, const ElementUpdaterParameters& params);
-            void operator()();
+        using AggregatorTupleType = std::tuple<AggregatorTypes...>;
 
-        private:
-            ElementUpdaterParameters _params;
-            AggregatorT& _aggregator;
-        };
+        // The smallest part of the dataset worth giving to a thread of its own
+        static constexpr size_t minExamplesPerThread = 1024;
 
         template <typename AggregatorT>
         class ElementResetter
@@ -136,15 +130,23 @@ namespace evaluators
             AggregatorT& _aggregator;
         };
 
-        template <std::size_t Index>
-        auto GetElementUpdateFunction(const ElementUpdaterParameters& params) -> ElementUpdater<AggregatorType<Index>>;
-
         template <std::size_t Index>
         auto GetElementResetFunction() -> ElementResetter<AggregatorType<Index>>;
 
         template <std::size_t... Sequence>
         void DispatchUpdate(double prediction, double label, double weight, std::index_sequence<Sequence...>);
 
+        template <std::size_t... Sequence>
+        static void DispatchUpdate(AggregatorTupleType& aggregators, double prediction, double label, double weight, std::index_sequence<Sequence...>);
+
+        template <std::size_t... Sequence>
+        void MergeAggregators(const AggregatorTupleType& aggregators, std::index_sequence<Sequence...>);
+
+        // Calls function(aggregators, fromIndex, size) on consecutive ranges of the dataset, on as many threads as the
+        // parameters allow, and merges the aggregators of the other threads into _aggregatorTuple
+        template <typename FunctionType>
+        void ForEachExampleRange(FunctionType function);
+
         template <std::size_t... Sequence>
         void Aggregate(std::index_sequence<Sequence...>);
 
@@ -158,7 +160,7 @@ namespace evaluators
         data::Dataset<ExampleType> _dataset;
         EvaluatorParameters _evaluatorParameters;
         size_t _evaluateCounter = 0;
-        typename std::tuple<AggregatorTypes...> _aggregatorTuple;
+        AggregatorTupleType _aggregatorTuple;
         std::vector<std::vector<std::vector<double>>> _values;
     };
 
@@ -204,19 +206,20 @@ namespace evaluators
             return;
         }
 
-        auto iterator = _dataset.GetExampleReferenceIterator();
-
-        while (iterator.IsValid())
-        {
-            const auto& example = iterator.Get();
+        ForEachExampleRange([this, &predictor](AggregatorTupleType& aggregators, size_t fromIndex, size_t size) {
+            auto iterator = _dataset.GetExampleReferenceIterator(fromIndex, size);
+            while (iterator.IsValid())
+            {
+                const auto& example = iterator.Get();
 
-            double weight = example.GetMetadata().weight;
-            double label = example.GetMetadata().label;
-            double prediction = predictor.Predict(example.GetDataVector());
+                double weight = example.GetMetadata().weight;
+                double label = example.GetMetadata().label;
+                double prediction = predictor.Predict(example.GetDataVector());
 
-            DispatchUpdate(prediction, label, weight, std::make_index_sequence<sizeof...(AggregatorTypes)>());
-            iterator.Next();
-        }
+                DispatchUpdate(aggregators, prediction, label, weight, std::make_index_sequence<sizeof...(AggregatorTypes)>());
+                iterator.Next();
+            }
+        });
         Aggregate(std::make_index_sequence<sizeof...(AggregatorTypes)>());
     }
 
@@ -294,55 +297,73 @@ namespace evaluators
 
     template <typename PredictorType, typename... AggregatorTypes>
     template <typename AggregatorT>
-    Evaluator<PredictorType, AggregatorTypes...>::ElementUpdater<AggregatorT>::ElementUpdater(AggregatorT& aggregator, const ElementUpdaterParameters& params) :
-        _params(params),
+    Evaluator<PredictorType, AggregatorTypes...>::ElementResetter<AggregatorT>::ElementResetter(AggregatorT& aggregator) :
         _aggregator(aggregator)
     {
     }
 
     template <typename PredictorType, typename... AggregatorTypes>
     template <typename AggregatorT>
-    void Evaluator<PredictorType, AggregatorTypes...>::ElementUpdater<AggregatorT>::operator()()
+    void Evaluator<PredictorType, AggregatorTypes...>::ElementResetter<AggregatorT>::operator()()
     {
-        _aggregator.Update(_params.prediction, _params.label, _params.weight);
+        _aggregator.Reset();
     }
 
     template <typename PredictorType, typename... AggregatorTypes>
-    template <typename AggregatorT>
-    Evaluator<PredictorType, AggregatorTypes...>::ElementResetter<AggregatorT>::ElementResetter(AggregatorT& aggregator) :
-        _aggregator(aggregator)
+    template <std::size_t Index>
+    auto Evaluator<PredictorType, AggregatorTypes...>::GetElementResetFunction() -> ElementResetter<AggregatorType<Index>>
     {
+        return { std::get<Index>(_aggregatorTuple) };
     }
 
     template <typename PredictorType, typename... AggregatorTypes>
-    template <typename AggregatorT>
-    void Evaluator<PredictorType, AggregatorTypes...>::ElementResetter<AggregatorT>::operator()()
+    template <std::size_t... Sequence>
+    void Evaluator<PredictorType, AggregatorTypes...>::DispatchUpdate(double prediction, double label, double weight, std::index_sequence<Sequence...> sequence)
     {
-        _aggregator.Reset();
+        DispatchUpdate(_aggregatorTuple, prediction, label, weight, sequence);
     }
 
     template <typename PredictorType, typename... AggregatorTypes>
-    template <std::size_t Index>
-    auto Evaluator<PredictorType, AggregatorTypes...>::GetElementUpdateFunction(const ElementUpdaterParameters& params) -> ElementUpdater<AggregatorType<Index>>
+    template <std::size_t... Sequence>
+    void Evaluator<PredictorType, AggregatorTypes...>::DispatchUpdate(AggregatorTupleType& aggregators, double prediction, double label, double weight, std::index_sequence<Sequence...>)
     {
-        return { std::get<Index>(_aggregatorTuple), params };
+        // Call X.Update() for each X in aggregators
+        (std::get<Sequence>(aggregators).Update(prediction, label, weight), ...);
     }
 
     template <typename PredictorType, typename... AggregatorTypes>
-    template <std::size_t Index>
-    auto Evaluator<PredictorType, AggregatorTypes...>::GetElementResetFunction() -> ElementResetter<AggregatorType<Index>>
+    template <std::size_t... Sequence>
+    void Evaluator<PredictorType, AggregatorTypes...>::MergeAggregators(const AggregatorTupleType& aggregators, std::index_sequence<Sequence...>)
     {
-        return { std::get<Index>(_aggregatorTuple) };
+        // Call X.Merge(Y) for each X in _aggregatorTuple and the corresponding Y in aggregators
+        (std::get<Sequence>(_aggregatorTuple).Merge(std::get<Sequence>(aggregators)), ...);
     }
 
     template <typename PredictorType, typename... AggregatorTypes>
-    template <std::size_t... Sequence>
-    void Evaluator<PredictorType, AggregatorTypes...>::DispatchUpdate(double prediction, double label, double weight, std::index_sequence<Sequence...>)
+    template <typename FunctionType>
+    void Evaluator<PredictorType, AggregatorTypes...>::ForEachExampleRange(FunctionType function)
     {
-        // Call (X.Update(), 0) for each X in _aggregatorTuple
-        ElementUpdaterParameters params{ prediction, label, weight };
-        utilities::InOrderFunctionEvaluator(GetElementUpdateFunction<Sequence>(params)...);
-        // [this, prediction, label, weight]() { std::get<Sequence>(_aggregatorTuple).Update(prediction, label, weight); }...); // GCC bug prevents compilation
+        const auto numExamples = _dataset.NumExamples();
+        auto numThreads = std::max(std::min(utilities::GetNumThreads(_evaluatorParameters.numThreads), numExamples / minExamplesPerThread), size_t{ 1 });
+        if (numThreads == 1)
+        {
+            function(_aggregatorTuple, 0, numExamples);
+            return;
+        }
+
+        // The aggregators are reset after each evaluation, so their copies start out empty
+        std::vector<AggregatorTupleType> threadAggregators(numThreads - 1, _aggregatorTuple);
+        utilities::ParallelForBlocks(numThreads, [this, &function, &threadAggregators, numExamples, numThreads](size_t threadIndex) {
+            auto fromIndex = numExamples * threadIndex / numThreads;
+            auto size = numExamples * (threadIndex + 1) / numThreads - fromIndex;
+            function(threadIndex == 0 ? _aggregatorTuple : threadAggregators[threadIndex - 1], fromIndex, size);
+        });
+
+        // Merge in order, so the results don't depend on which thread finished first
+        for (const auto& aggregators : threadAggregators)
+        {
+            MergeAggregators(aggregators, std::make_index_sequence<sizeof...(AggregatorTypes)>());
+        }
     }
 
     template <typename PredictorType, typename... AggregatorTypes>
@@ -117,25 +117,28 @@ namespace evaluators
         ++BaseClassType::_evaluateCounter;
         bool evaluate = BaseClassType::_evaluateCounter % BaseClassType::_evaluatorParameters.evaluationFrequency == 0 ? true : false;
 
-        auto iterator = BaseClassType::_dataset.GetExampleIterator();
-        size_t index = 0;
+        // Each thread updates the cached predictions of its own range of examples
+        BaseClassType::ForEachExampleRange([&](typename BaseClassType::AggregatorTupleType& aggregators, size_t fromIndex, size_t size) {
+            auto iterator = BaseClassType::_dataset.GetExampleReferenceIterator(fromIndex, size);
+            size_t index = fromIndex;
 
-        while (iterator.IsValid())
-        {
-            const auto& example = iterator.Get();
+            while (iterator.IsValid())
+            {
+                const auto& example = iterator.Get();
 
-            double exampleWeight = example.GetMetadata().weight;
-            double label = example.GetMetadata().label;
-            _predictions[index] += basePredictorWeight * basePredictor.Predict(example.GetDataVector());
+                double exampleWeight = example.GetMetadata().weight;
+                double label = example.GetMetadata().label;
+                _predictions[index] += basePredictorWeight * basePredictor.Predict(example.GetDataVector());
 
-            if (evaluate)
-            {
-                BaseClassType::DispatchUpdate(_predictions[index] * evaluationRescale, label, exampleWeight, std::make_index_sequence<sizeof...(AggregatorTypes)>());
-            }
+                if (evaluate)
+                {
+                    BaseClassType::DispatchUpdate(aggregators, _predictions[index] * evaluationRescale, label, exampleWeight, std::make_index_sequence<sizeof...(AggregatorTypes)>());
+                }
 
-            iterator.Next();
-            ++index;
-        }
+                iterator.Next();
+                ++index;
+            }
+        });
         if (evaluate)
         {
             BaseClassType::Aggregate(std::make_index_sequence<sizeof...(AggregatorTypes)>());
@@ -8,18 +8,78 @@
 
 #include "AUCAggregator.h"
 
+#include <utilities/include/Exception.h>
+
 #include <algorithm>
+#include <cmath>
 
 namespace ell
 {
 namespace evaluators
 {
+    AUCAggregator::AUCAggregator(size_t numBins) :
+        _numBins(numBins),
+        _positiveWeights(numBins, 0.0),
+        _negativeWeights(numBins, 0.0)
+    {
+    }
+
     void AUCAggregator::Update(double prediction, double label, double weight)
     {
-        _aggregates.push_back(Aggregate{ prediction, label, weight });
+        if (_numBins == 0)
+        {
+            _aggregates.push_back(Aggregate{ prediction, label, weight });
+        }
+        else if (label <= 0)
+        {
+            _negativeWeights[GetBin(prediction)] += weight;
+        }
+        else
+        {
+            _positiveWeights[GetBin(prediction)] += weight;
+        }
     }
 
     std::vector<double> AUCAggregator::GetResult() const
+    {
+        return _numBins == 0 ? GetExactResult() : GetHistogramResult();
+    }
+
+    size_t AUCAggregator::GetBin(double prediction) const
+    {
+        // Predictions are unbounded, so the bins are equally wide in x / (1 + |x|), which keeps the order and makes
+        // them narrowest where predictions are most common
+        auto squashed = prediction / (1.0 + std::abs(prediction));
+        if (!(squashed > -1.0)) // also catches NaN
+        {
+            return 0;
+        }
+        return std::min(static_cast<size_t>((squashed + 1.0) / 2.0 * _numBins), _numBins - 1);
+    }
+
+    std::vector<double> AUCAggregator::GetHistogramResult() const
+    {
+        double sumPositiveWeights = 0.0;
+        double sumNegativeWeights = 0.0;
+        double sumOrderedWeights = 0.0;
+
+        for (size_t bin = 0; bin < _numBins; ++bin)
+        {
+            sumOrderedWeights += _positiveWeights[bin] * (sumNegativeWeights + 0.5 * _negativeWeights[bin]);
+            sumPositiveWeights += _positiveWeights[bin];
+            sumNegativeWeights += _negativeWeights[bin];
+        }
+
+        double auc = 0.0;
+        if (sumPositiveWeights > 0 && sumNegativeWeights > 0)
+        {
+            auc = sumOrderedWeights / sumPositiveWeights / sumNegativeWeights;
+        }
+
+        return { auc };
+    }
+
+    std::vector<double> AUCAggregator::GetExactResult() const
     {
         // sort aggregates by prediction
         std::sort(_aggregates.begin(), _aggregates.end());
@@ -54,9 +114,26 @@ namespace evaluators
         return { auc };
     }
 
+    void AUCAggregator::Merge(const AUCAggregator& other)
+    {
+        if (other._numBins != _numBins)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Can't merge AUC aggregators with different numbers of bins");
+        }
+
+        _aggregates.insert(_aggregates.end(), other._aggregates.begin(), other._aggregates.end());
+        for (size_t bin = 0; bin < _numBins; ++bin)
+        {
+            _positiveWeights[bin] += other._positiveWeights[bin];
+            _negativeWeights[bin] += other._negativeWeights[bin];
+        }
+    }
+
     void AUCAggregator::Reset()
     {
         _aggregates.resize(0);
+        std::fill(_positiveWeights.begin(), _positiveWeights.end(), 0.0);
+        std::fill(_negativeWeights.begin(), _negativeWeights.end(), 0.0);
     }
 
     bool AUCAggregator::Aggregate::operator<(const Aggregate& other) const
@@ -10,4 +10,6 @@
 namespace ell
 {
 void TestEvaluators();
+void TestParallelEvaluator();
+void TestHistogramAUC();
 }
\ No newline at end of file
@@ -21,9 +21,30 @@
 #include <testing/include/testing.h>
 
 #include <iostream>
+#include <random>
 
 namespace ell
 {
+namespace
+{
+    data::DenseSupervisedDataset GetRandomDataset(size_t numExamples)
+    {
+        using ExampleType = data::DenseSupervisedDataset::DatasetExampleType;
+        std::default_random_engine engine(123);
+        std::normal_distribution<double> normal(0, 1);
+
+        data::DenseSupervisedDataset dataset;
+        for (size_t i = 0; i < numExamples; ++i)
+        {
+            double x = normal(engine);
+            double y = normal(engine);
+            double label = (x + 0.5 * y + normal(engine) > 0) ? 1.0 : -1.0;
+            dataset.AddExample(ExampleType{ { x, y }, data::WeightLabel{ 1.0, label } });
+        }
+        return dataset;
+    }
+} // namespace
+
 void TestEvaluators()
 {
     // Create a dataset
@@ -45,4 +66,61 @@ void TestEvaluators()
     std::cout << "Goodness: " << evaluator->GetGoodness() << std::endl;
     testing::ProcessTest("Evaluator sanity check", !testing::IsEqual(evaluator->GetGoodness(), 0.0, 1e-8));
 }
+
+void TestParallelEvaluator()
+{
+    using PredictorType = predictors::LinearPredictor<double>;
+    using EvaluatorType = evaluators::Evaluator<PredictorType, evaluators::BinaryErrorAggregator, evaluators::AUCAggregator, evaluators::LossAggregator<functions::SquaredLoss>>;
+    auto dataset = GetRandomDataset(10000);
+    PredictorType predictor({ 1.0, 0.5 }, 0.1);
+
+    evaluators::EvaluatorParameters serialParameters{ 1, false, 1 };
+    evaluators::EvaluatorParameters parallelParameters{ 1, false, 4 };
+    EvaluatorType serialEvaluator(dataset.GetAnyDataset(), serialParameters, evaluators::BinaryErrorAggregator(), evaluators::AUCAggregator(), evaluators::MakeLossAggregator(functions::SquaredLoss()));
+    EvaluatorType parallelEvaluator(dataset.GetAnyDataset(), parallelParameters, evaluators::BinaryErrorAggregator(), evaluators::AUCAggregator(), evaluators::MakeLossAggregator(functions::SquaredLoss()));
+    serialEvaluator.Evaluate(predictor);
+    parallelEvaluator.Evaluate(predictor);
+    parallelEvaluator.Evaluate(predictor);
+
+    bool ok = parallelEvaluator.GetValues().size() == 2;
+    for (const auto& values : parallelEvaluator.GetValues())
+    {
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            ok = ok && testing::IsEqual(values[i], serialEvaluator.GetValues()[0][i], 1e-9);
+        }
+    }
+    testing::ProcessTest("Evaluating on several threads matches evaluating on one thread", ok);
+}
+
+void TestHistogramAUC()
+{
+    auto dataset = GetRandomDataset(10000);
+    predictors::LinearPredictor<double> predictor({ 1.0, 0.5 }, 0.1);
+
+    evaluators::AUCAggregator histogramAggregator;
+    evaluators::AUCAggregator exactAggregator(0);
+    evaluators::AUCAggregator firstHalf;
+    evaluators::AUCAggregator secondHalf;
+    for (size_t i = 0; i < dataset.NumExamples(); ++i)
+    {
+        const auto& example = dataset.GetExample(i);
+        auto prediction = predictor.Predict(predictors::LinearPredictor<double>::DataVectorType(example.GetDataVector().ToArray()));
+        auto label = example.GetMetadata().label;
+        histogramAggregator.Update(prediction, label, 1.0);
+        exactAggregator.Update(prediction, label, 1.0);
+        (i % 2 == 0 ? firstHalf : secondHalf).Update(prediction, label, 1.0);
+    }
+    firstHalf.Merge(secondHalf);
+
+    auto histogramAUC = histogramAggregator.GetResult()[0];
+    auto exactAUC = exactAggregator.GetResult()[0];
+    testing::ProcessTest("Histogram AUC approximates the exact AUC", testing::IsEqual(histogramAUC, exactAUC, 1e-3));
+    testing::ProcessTest("Merged histogram AUC", testing::IsEqual(firstHalf.GetResult()[0], histogramAUC, 1e-12));
+
+    histogramAggregator.Reset();
+    histogramAggregator.Update(1.0, 1.0, 1.0);
+    histogramAggregator.Update(-1.0, -1.0, 1.0);
+    testing::ProcessTest("Histogram AUC after reset", testing::IsEqual(histogramAggregator.GetResult()[0], 1.0));
+}
 } // namespace ell
@@ -24,6 +24,8 @@ int main()
     try
     {
         TestEvaluators();
+        TestParallelEvaluator();
+        TestHistogramAUC();
     }
     catch (const utilities::Exception& exception)
     {
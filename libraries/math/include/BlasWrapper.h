@@ -29,9 +29,47 @@ namespace math
         /// <param name="order">The ELL definition of MatrixTranspose to be mapped. </param>
         int GetCBlasMatrixTranspose(MatrixTranspose transpose);
 
-        /// <summary> Sets the number of threads. </summary>
+        /// <summary>
+        /// How many threads GEMM and GEMV calls may use. A call gets one thread for every `minOperationsPerThread`
+        /// multiply-adds it does, up to `maxThreads`, so small calls run single-threaded and don't pay for waking
+        /// up the BLAS library's threads. Only OpenBLAS lets the thread count be changed; other BLAS libraries
+        /// ignore the policy.
+        /// </summary>
+        struct ThreadingPolicy
+        {
+            /// <summary> The maximum number of threads of a call, or 0 for the number of hardware threads. </summary>
+            int maxThreads = 0;
+
+            /// <summary> The number of multiply-adds that make it worth using another thread. </summary>
+            size_t minOperationsPerThread = 1 << 15;
+        };
+
+        /// <summary> Sets the threading policy of GEMM and GEMV calls. Not to be called while BLAS calls are running. </summary>
+        ///
+        /// <param name="policy"> The policy. </param>
+        void SetThreadingPolicy(const ThreadingPolicy& policy);
+
+        /// <summary> Gets the threading policy of GEMM and GEMV calls. </summary>
+        ///
+        /// <returns> The policy. </returns>
+        ThreadingPolicy GetThreadingPolicy();
+
+        /// <summary> Gets the number of threads that a threading policy gives a call of a given size. </summary>
+        ///
+        /// <param name="policy"> The policy. </param>
+        /// <param name="numOperations"> The number of multiply-adds of the call. </param>
+        ///
+        /// <returns> The number of threads, which is at least 1. </returns>
+        int GetNumThreads(const ThreadingPolicy& policy, size_t numOperations);
+
+        /// <summary> Sets the number of threads the BLAS library uses for a GEMM or GEMV call of a given size, as the threading policy says. </summary>
+        ///
+        /// <param name="numOperations"> The number of multiply-adds of the call. </param>
+        void SetNumThreadsForCall(size_t numOperations);
+
+        /// <summary> Sets the maximum number of threads of the threading policy, and of the BLAS library. </summary>
         ///
-        /// <param name="numThreads"> The number of threads. </param>
+        /// <param name="numThreads"> The number of threads, or 0 for the number of hardware threads. </param>
         void SetNumThreads(int numThreads);
 
         /// @{
@@ -0,0 +1,733 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     Expressions.h (math)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Matrix.h"
+#include "Tensor.h"
+#include "Vector.h"
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/TypeTraits.h>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace ell
+{
+namespace math
+{
+    // Lazy elementwise expressions over vectors, matrices and tensors.
+    //
+    // Arithmetic on expressions builds a tree of small expression objects instead of computing anything. `EvaluateSet`
+    // and `Sum` then evaluate the whole tree in a single loop over the elements, without allocating temporaries for
+    // the intermediate results. When the output and all the operands have the same memory layout, that loop runs over
+    // a flat index, and the compiler can vectorize it. For example:
+    //
+    //     EvaluateSet((1 - alpha) * AsExpression(a) + alpha * AsExpression(b), c);
+    //
+    // Scalars combine with expressions and apply to every element. Every vector, matrix or tensor in an expression
+    // must have the same shape (vectors count as matrices with a single column), except that `RepeatRows` and
+    // `RepeatColumns` broadcast a vector across the rows or columns of a matrix. The output of `EvaluateSet` may be
+    // one of the operands if they have the same layout, since each element is read before it is written.
+    //
+    // Expressions hold references to their operands' data, so they must not outlive them.
+
+    /// <summary> The offsets in memory between consecutive rows, columns and channels of the elements of an expression. </summary>
+    struct ExpressionIncrements
+    {
+        size_t row;
+        size_t column;
+        size_t channel;
+    };
+
+    /// <summary> An expression that refers to the elements of a vector, matrix or tensor. </summary>
+    ///
+    /// <typeparam name="ElementType"> The element type. </typeparam>
+    template <typename ElementType>
+    class ReferenceExpression
+    {
+    public:
+        using ValueType = ElementType;
+        static constexpr bool isScalar = false;
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="pData"> Pointer to the element at (0, 0, 0). </param>
+        /// <param name="shape"> The number of rows, columns and channels. </param>
+        /// <param name="increments"> The offsets between consecutive rows, columns and channels. An offset of 0 repeats the same elements. </param>
+        ReferenceExpression(const ElementType* pData, TensorShape shape, ExpressionIncrements increments);
+
+        /// <summary> Gets the shape of the expression. </summary>
+        TensorShape GetShape() const { return _shape; }
+
+        /// <summary> Gets the offsets between consecutive elements, of the first operand for compound expressions. </summary>
+        ExpressionIncrements GetIncrements() const { return _increments; }
+
+        /// <summary> Checks if every operand of the expression has the given offsets between consecutive elements. </summary>
+        bool HasIncrements(ExpressionIncrements increments) const;
+
+        /// <summary> Gets the element at an offset in memory. Only valid if the expression's operands all have the same, contiguous, layout. </summary>
+        ElementType operator[](size_t offset) const { return _pData[offset]; }
+
+        /// <summary> Gets the element at a coordinate. </summary>
+        ElementType operator()(size_t row, size_t column, size_t channel) const { return _pData[row * _increments.row + column * _increments.column + channel * _increments.channel]; }
+
+    private:
+        const ElementType* _pData;
+        TensorShape _shape;
+        ExpressionIncrements _increments;
+    };
+
+    /// <summary> An expression with the same value for every element. </summary>
+    ///
+    /// <typeparam name="ElementType"> The element type. </typeparam>
+    template <typename ElementType>
+    class ScalarExpression
+    {
+    public:
+        using ValueType = ElementType;
+        static constexpr bool isScalar = true;
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="value"> The value. </param>
+        ScalarExpression(ElementType value) :
+            _value(value) {}
+
+        /// <summary> Gets the shape of the expression, which is empty, since a scalar matches any shape. </summary>
+        TensorShape GetShape() const { return { 0, 0, 0 }; }
+
+        /// <summary> Gets the offsets between consecutive elements, which are all 0. </summary>
+        ExpressionIncrements GetIncrements() const { return { 0, 0, 0 }; }
+
+        /// <summary> Checks if every operand of the expression has the given offsets between consecutive elements, which is always true. </summary>
+        bool HasIncrements(ExpressionIncrements) const { return true; }
+
+        /// <summary> Gets the element at an offset in memory. </summary>
+        ElementType operator[](size_t) const { return _value; }
+
+        /// <summary> Gets the element at a coordinate. </summary>
+        ElementType operator()(size_t, size_t, size_t) const { return _value; }
+
+    private:
+        ElementType _value;
+    };
+
+    /// <summary> An expression that applies a function to each element of another expression. </summary>
+    ///
+    /// <typeparam name="OperandType"> The operand's expression type. </typeparam>
+    /// <typeparam name="FunctionType"> The function type, which maps an element to an element. </typeparam>
+    template <typename OperandType, typename FunctionType>
+    class UnaryExpression
+    {
+    public:
+        using ValueType = typename OperandType::ValueType;
+        static constexpr bool isScalar = OperandType::isScalar;
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="operand"> The operand. </param>
+        /// <param name="function"> The function to apply. </param>
+        UnaryExpression(OperandType operand, FunctionType function) :
+            _operand(operand),
+            _function(function) {}
+
+        /// <summary> Gets the shape of the expression. </summary>
+        TensorShape GetShape() const { return _operand.GetShape(); }
+
+        /// <summary> Gets the offsets between consecutive elements, of the first operand for compound expressions. </summary>
+        ExpressionIncrements GetIncrements() const { return _operand.GetIncrements(); }
+
+        /// <summary> Checks if every operand of the expression has the given offsets between consecutive elements. </summary>
+        bool HasIncrements(ExpressionIncrements increments) const { return _operand.HasIncrements(increments); }
+
+        /// <summary> Gets the element at an offset in memory. Only valid if the expression's operands all have the same, contiguous, layout. </summary>
+        ValueType operator[](size_t offset) const { return _function(_operand[offset]); }
+
+        /// <summary> Gets the element at a coordinate. </summary>
+        ValueType operator()(size_t row, size_t column, size_t channel) const { return _function(_operand(row, column, channel)); }
+
+    private:
+        OperandType _operand;
+        FunctionType _function;
+    };
+
+    /// <summary> An expression that combines the corresponding elements of two other expressions. </summary>
+    ///
+    /// <typeparam name="LeftType"> The left operand's expression type. </typeparam>
+    /// <typeparam name="RightType"> The right operand's expression type. </typeparam>
+    /// <typeparam name="OperationType"> The operation type, which maps two elements to an element. </typeparam>
+    template <typename LeftType, typename RightType, typename OperationType>
+    class BinaryExpression
+    {
+    public:
+        using ValueType = typename LeftType::ValueType;
+        static constexpr bool isScalar = LeftType::isScalar && RightType::isScalar;
+        static_assert(std::is_same<ValueType, typename RightType::ValueType>::value, "Expression operands must have the same element type");
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="left"> The left operand. </param>
+        /// <param name="right"> The right operand. </param>
+        BinaryExpression(LeftType left, RightType right);
+
+        /// <summary> Gets the shape of the expression. </summary>
+        TensorShape GetShape() const { return LeftType::isScalar ? _right.GetShape() : _left.GetShape(); }
+
+        /// <summary> Gets the offsets between consecutive elements, of the first operand for compound expressions. </summary>
+        ExpressionIncrements GetIncrements() const { return LeftType::isScalar ? _right.GetIncrements() : _left.GetIncrements(); }
+
+        /// <summary> Checks if every operand of the expression has the given offsets between consecutive elements. </summary>
+        bool HasIncrements(ExpressionIncrements increments) const { return _left.HasIncrements(increments) && _right.HasIncrements(increments); }
+
+        /// <summary> Gets the element at an offset in memory. Only valid if the expression's operands all have the same, contiguous, layout. </summary>
+        ValueType operator[](size_t offset) const { return OperationType()(_left[offset], _right[offset]); }
+
+        /// <summary> Gets the element at a coordinate. </summary>
+        ValueType operator()(size_t row, size_t column, size_t channel) const { return OperationType()(_left(row, column, channel), _right(row, column, channel)); }
+
+    private:
+        LeftType _left;
+        RightType _right;
+    };
+
+    /// <summary> Type trait that is true for the expression types. </summary>
+    template <typename T>
+    struct IsExpressionType : std::false_type
+    {};
+
+    template <typename ElementType>
+    struct IsExpressionType<ReferenceExpression<ElementType>> : std::true_type
+    {};
+
+    template <typename ElementType>
+    struct IsExpressionType<ScalarExpression<ElementType>> : std::true_type
+    {};
+
+    template <typename OperandType, typename FunctionType>
+    struct IsExpressionType<UnaryExpression<OperandType, FunctionType>> : std::true_type
+    {};
+
+    template <typename LeftType, typename RightType, typename OperationType>
+    struct IsExpressionType<BinaryExpression<LeftType, RightType, OperationType>> : std::true_type
+    {};
+
+    /// <summary> Enabled if T is an expression type. </summary>
+    template <typename T>
+    using IsExpression = std::enable_if_t<IsExpressionType<T>::value, bool>;
+
+    /// <summary> Enabled if both types are expressions or fundamental types, and at least one of them is an expression. </summary>
+    template <typename LeftType, typename RightType>
+    using IsExpressionOperands = std::enable_if_t<(IsExpressionType<LeftType>::value || IsExpressionType<RightType>::value) &&
+                                                      (IsExpressionType<LeftType>::value || std::is_fundamental<LeftType>::value) &&
+                                                      (IsExpressionType<RightType>::value || std::is_fundamental<RightType>::value),
+                                                  bool>;
+
+    /// <summary> Makes an expression that refers to the elements of a vector. </summary>
+    ///
+    /// <param name="vector"> The vector. </param>
+    ///
+    /// <returns> The expression. </returns>
+    template <typename ElementType, VectorOrientation orientation>
+    ReferenceExpression<ElementType> AsExpression(ConstVectorReference<ElementType, orientation> vector);
+
+    /// <summary> Makes an expression that refers to the elements of a matrix. </summary>
+    ///
+    /// <param name="matrix"> The matrix. </param>
+    ///
+    /// <returns> The expression. </returns>
+    template <typename ElementType, MatrixLayout layout>
+    ReferenceExpression<ElementType> AsExpression(ConstMatrixReference<ElementType, layout> matrix);
+
+    /// <summary> Makes an expression that refers to the elements of a tensor. </summary>
+    ///
+    /// <param name="tensor"> The tensor. </param>
+    ///
+    /// <returns> The expression. </returns>
+    template <typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2>
+    ReferenceExpression<ElementType> AsExpression(ConstTensorReference<ElementType, dimension0, dimension1, dimension2> tensor);
+
+    /// <summary> Makes a matrix expression whose rows are all the same row vector. </summary>
+    ///
+    /// <param name="row"> The row. </param>
+    /// <param name="numRows"> The number of rows. </param>
+    ///
+    /// <returns> The expression. </returns>
+    template <typename ElementType>
+    ReferenceExpression<ElementType> RepeatRows(ConstRowVectorReference<ElementType> row, size_t numRows);
+
+    /// <summary> Makes a matrix expression whose columns are all the same column vector. </summary>
+    ///
+    /// <param name="column"> The column. </param>
+    /// <param name="numColumns"> The number of columns. </param>
+    ///
+    /// <returns> The expression. </returns>
+    template <typename ElementType>
+    ReferenceExpression<ElementType> RepeatColumns(ConstColumnVectorReference<ElementType> column, size_t numColumns);
+
+    /// <summary> Elementwise sum of two expressions, or of an expression and a scalar. </summary>
+    template <typename LeftType, typename RightType, IsExpressionOperands<LeftType, RightType> = true>
+    auto operator+(LeftType left, RightType right);
+
+    /// <summary> Elementwise difference of two expressions, or of an expression and a scalar. </summary>
+    template <typename LeftType, typename RightType, IsExpressionOperands<LeftType, RightType> = true>
+    auto operator-(LeftType left, RightType right);
+
+    /// <summary> Elementwise product of two expressions, or of an expression and a scalar. </summary>
+    template <typename LeftType, typename RightType, IsExpressionOperands<LeftType, RightType> = true>
+    auto operator*(LeftType left, RightType right);
+
+    /// <summary> Elementwise quotient of two expressions, or of an expression and a scalar. </summary>
+    template <typename LeftType, typename RightType, IsExpressionOperands<LeftType, RightType> = true>
+    auto operator/(LeftType left, RightType right);
+
+    /// <summary> Elementwise negation of an expression. </summary>
+    template <typename ExpressionType, IsExpression<ExpressionType> = true>
+    auto operator-(ExpressionType expression);
+
+    /// <summary> Applies a function to each element of an expression. </summary>
+    ///
+    /// <param name="expression"> The expression. </param>
+    /// <param name="function"> The function, which maps an element to an element. </param>
+    ///
+    /// <returns> The expression. </returns>
+    template <typename ExpressionType, typename FunctionType, IsExpression<ExpressionType> = true>
+    UnaryExpression<ExpressionType, FunctionType> Map(ExpressionType expression, FunctionType function);
+
+    /// <summary> Elementwise square of an expression. </summary>
+    template <typename ExpressionType, IsExpression<ExpressionType> = true>
+    auto Square(ExpressionType expression);
+
+    /// <summary> Elementwise square root of an expression. </summary>
+    template <typename ExpressionType, IsExpression<ExpressionType> = true>
+    auto Sqrt(ExpressionType expression);
+
+    /// <summary> Elementwise absolute value of an expression. </summary>
+    template <typename ExpressionType, IsExpression<ExpressionType> = true>
+    auto Abs(ExpressionType expression);
+
+    /// <summary> Elementwise exponential of an expression. </summary>
+    template <typename ExpressionType, IsExpression<ExpressionType> = true>
+    auto Exp(ExpressionType expression);
+
+    /// <summary> Evaluates an expression into a vector: output = expression. </summary>
+    ///
+    /// <param name="expression"> The expression, which must have the shape of the output. </param>
+    /// <param name="output"> The output vector. </param>
+    template <typename ExpressionType, typename ElementType, VectorOrientation orientation, IsExpression<ExpressionType> = true>
+    void EvaluateSet(const ExpressionType& expression, VectorReference<ElementType, orientation> output);
+
+    /// <summary> Evaluates an expression into a matrix: output = expression. </summary>
+    ///
+    /// <param name="expression"> The expression, which must have the shape of the output. </param>
+    /// <param name="output"> The output matrix. </param>
+    template <typename ExpressionType, typename ElementType, MatrixLayout layout, IsExpression<ExpressionType> = true>
+    void EvaluateSet(const ExpressionType& expression, MatrixReference<ElementType, layout> output);
+
+    /// <summary> Evaluates an expression into a tensor: output = expression. </summary>
+    ///
+    /// <param name="expression"> The expression, which must have the shape of the output. </param>
+    /// <param name="output"> The output tensor. </param>
+    template <typename ExpressionType, typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2, IsExpression<ExpressionType> = true>
+    void EvaluateSet(const ExpressionType& expression, TensorReference<ElementType, dimension0, dimension1, dimension2> output);
+
+    /// <summary> Computes the sum of the elements of an expression. </summary>
+    ///
+    /// <param name="expression"> The expression, which can't be a scalar. </param>
+    ///
+    /// <returns> The sum. </returns>
+    template <typename ExpressionType, IsExpression<ExpressionType> = true>
+    typename ExpressionType::ValueType Sum(const ExpressionType& expression);
+} // namespace math
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace math
+{
+    namespace detail
+    {
+        struct AddOperation
+        {
+            template <typename ValueType>
+            ValueType operator()(ValueType a, ValueType b) const { return a + b; }
+        };
+
+        struct SubtractOperation
+        {
+            template <typename ValueType>
+            ValueType operator()(ValueType a, ValueType b) const { return a - b; }
+        };
+
+        struct MultiplyOperation
+        {
+            template <typename ValueType>
+            ValueType operator()(ValueType a, ValueType b) const { return a * b; }
+        };
+
+        struct DivideOperation
+        {
+            template <typename ValueType>
+            ValueType operator()(ValueType a, ValueType b) const { return a / b; }
+        };
+
+        struct NegateFunction
+        {
+            template <typename ValueType>
+            ValueType operator()(ValueType a) const { return -a; }
+        };
+
+        struct SquareFunction
+        {
+            template <typename ValueType>
+            ValueType operator()(ValueType a) const { return a * a; }
+        };
+
+        struct SqrtFunction
+        {
+            template <typename ValueType>
+            ValueType operator()(ValueType a) const { return std::sqrt(a); }
+        };
+
+        struct AbsFunction
+        {
+            template <typename ValueType>
+            ValueType operator()(ValueType a) const { return std::abs(a); }
+        };
+
+        struct ExpFunction
+        {
+            template <typename ValueType>
+            ValueType operator()(ValueType a) const { return std::exp(a); }
+        };
+
+        // The element type of a binary expression, taken from whichever operand is an expression
+        template <typename LeftType, typename RightType, typename = void>
+        struct ExpressionValueType
+        {
+            using type = typename LeftType::ValueType;
+        };
+
+        template <typename LeftType, typename RightType>
+        struct ExpressionValueType<LeftType, RightType, std::enable_if_t<!IsExpressionType<LeftType>::value>>
+        {
+            using type = typename RightType::ValueType;
+        };
+
+        template <typename ValueType, typename ExpressionType, IsExpression<ExpressionType> = true>
+        ExpressionType ToExpression(ExpressionType expression)
+        {
+            return expression;
+        }
+
+        template <typename ValueType, typename ScalarType, utilities::IsFundamental<ScalarType> = true>
+        ScalarExpression<ValueType> ToExpression(ScalarType value)
+        {
+            return { static_cast<ValueType>(value) };
+        }
+
+        template <typename OperationType, typename LeftType, typename RightType>
+        auto MakeBinaryExpression(LeftType left, RightType right)
+        {
+            using ValueType = typename ExpressionValueType<LeftType, RightType>::type;
+            auto leftExpression = ToExpression<ValueType>(left);
+            auto rightExpression = ToExpression<ValueType>(right);
+            return BinaryExpression<decltype(leftExpression), decltype(rightExpression), OperationType>(leftExpression, rightExpression);
+        }
+
+        // The increment of a dimension of size 1 is never used, so it is set to 0 to let layouts that only differ there compare equal
+        inline ExpressionIncrements NormalizeIncrements(TensorShape shape, ExpressionIncrements increments)
+        {
+            return { shape.NumRows() == 1 ? 0 : increments.row,
+                     shape.NumColumns() == 1 ? 0 : increments.column,
+                     shape.NumChannels() == 1 ? 0 : increments.channel };
+        }
+
+        inline bool operator==(ExpressionIncrements a, ExpressionIncrements b)
+        {
+            return a.row == b.row && a.column == b.column && a.channel == b.channel;
+        }
+
+        // Checks if the elements of a layout fill a contiguous block of memory, so that they can be visited with a flat index
+        inline bool IsContiguous(TensorShape shape, ExpressionIncrements increments)
+        {
+            size_t sizes[] = { shape.NumRows(), shape.NumColumns(), shape.NumChannels() };
+            size_t strides[] = { increments.row, increments.column, increments.channel };
+            int order[] = { 0, 1, 2 };
+            std::sort(order, order + 3, [&strides](int a, int b) { return strides[a] < strides[b]; });
+
+            size_t expectedStride = 1;
+            for (auto dimension : order)
+            {
+                if (sizes[dimension] == 1)
+                {
+                    continue;
+                }
+                if (strides[dimension] != expectedStride)
+                {
+                    return false;
+                }
+                expectedStride *= sizes[dimension];
+            }
+            return true;
+        }
+
+        // Calls function(offset, row, column, channel) for each element of a layout, visiting the dimensions from the
+        // one with the largest increment to the one with the smallest, so that memory is read in order
+        template <typename FunctionType>
+        void ForEachElement(TensorShape shape, ExpressionIncrements increments, FunctionType&& function)
+        {
+            size_t sizes[] = { shape.NumRows(), shape.NumColumns(), shape.NumChannels() };
+            size_t strides[] = { increments.row, increments.column, increments.channel };
+            int order[] = { 0, 1, 2 };
+            std::stable_sort(order, order + 3, [&strides](int a, int b) { return strides[a] > strides[b]; });
+
+            const auto outer = order[0];
+            const auto middle = order[1];
+            const auto inner = order[2];
+            const auto innerSize = sizes[inner];
+            const auto innerStride = strides[inner];
+            size_t coordinate[3] = { 0, 0, 0 };
+            for (size_t i = 0; i < sizes[outer]; ++i)
+            {
+                coordinate[outer] = i;
+                for (size_t j = 0; j < sizes[middle]; ++j)
+                {
+                    coordinate[middle] = j;
+                    const auto lineOffset = i * strides[outer] + j * strides[middle];
+
+                    // Separate inner loops for each innermost dimension keep the other coordinates loop-invariant
+                    switch (inner)
+                    {
+                    case 0:
+                        for (size_t k = 0; k < innerSize; ++k)
+                        {
+                            function(lineOffset + k * innerStride, k, coordinate[1], coordinate[2]);
+                        }
+                        break;
+                    case 1:
+                        for (size_t k = 0; k < innerSize; ++k)
+                        {
+                            function(lineOffset + k * innerStride, coordinate[0], k, coordinate[2]);
+                        }
+                        break;
+                    default:
+                        for (size_t k = 0; k < innerSize; ++k)
+                        {
+                            function(lineOffset + k * innerStride, coordinate[0], coordinate[1], k);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        template <typename ExpressionType, typename ElementType>
+        void EvaluateSet(const ExpressionType& expression, ElementType* pOutput, TensorShape shape, ExpressionIncrements increments)
+        {
+            static_assert(std::is_same<typename ExpressionType::ValueType, ElementType>::value, "Expression and output must have the same element type");
+            if (!ExpressionType::isScalar && expression.GetShape() != shape)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "Expression and output must have the same shape");
+            }
+
+            increments = NormalizeIncrements(shape, increments);
+            if (IsContiguous(shape, increments) && expression.HasIncrements(increments))
+            {
+                const auto size = shape.Size();
+                for (size_t index = 0; index < size; ++index)
+                {
+                    pOutput[index] = expression[index];
+                }
+                return;
+            }
+
+            ForEachElement(shape, increments, [&expression, pOutput](size_t offset, size_t row, size_t column, size_t channel) {
+                pOutput[offset] = expression(row, column, channel);
+            });
+        }
+
+        template <Dimension dimension, Dimension dimension0, Dimension dimension1, Dimension dimension2, typename ElementType>
+        size_t GetTensorIncrement(ConstTensorReference<ElementType, dimension0, dimension1, dimension2> tensor)
+        {
+            return dimension == dimension0 ? 1 : (dimension == dimension1 ? tensor.GetIncrement1() : tensor.GetIncrement2());
+        }
+    } // namespace detail
+
+    template <typename ElementType>
+    ReferenceExpression<ElementType>::ReferenceExpression(const ElementType* pData, TensorShape shape, ExpressionIncrements increments) :
+        _pData(pData),
+        _shape(shape),
+        _increments(detail::NormalizeIncrements(shape, increments))
+    {
+    }
+
+    template <typename ElementType>
+    bool ReferenceExpression<ElementType>::HasIncrements(ExpressionIncrements increments) const
+    {
+        return detail::operator==(_increments, increments);
+    }
+
+    template <typename LeftType, typename RightType, typename OperationType>
+    BinaryExpression<LeftType, RightType, OperationType>::BinaryExpression(LeftType left, RightType right) :
+        _left(left),
+        _right(right)
+    {
+        if (!LeftType::isScalar && !RightType::isScalar && _left.GetShape() != _right.GetShape())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "Expression operands must have the same shape");
+        }
+    }
+
+    template <typename ElementType, VectorOrientation orientation>
+    ReferenceExpression<ElementType> AsExpression(ConstVectorReference<ElementType, orientation> vector)
+    {
+        return { vector.GetConstDataPointer(), { vector.Size(), 1, 1 }, { vector.GetIncrement(), 0, 0 } };
+    }
+
+    template <typename ElementType, MatrixLayout layout>
+    ReferenceExpression<ElementType> AsExpression(ConstMatrixReference<ElementType, layout> matrix)
+    {
+        return { matrix.GetConstDataPointer(), { matrix.NumRows(), matrix.NumColumns(), 1 }, { matrix.GetRowIncrement(), matrix.GetColumnIncrement(), 0 } };
+    }
+
+    template <typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2>
+    ReferenceExpression<ElementType> AsExpression(ConstTensorReference<ElementType, dimension0, dimension1, dimension2> tensor)
+    {
+        ExpressionIncrements increments = { detail::GetTensorIncrement<Dimension::row>(tensor),
+                                            detail::GetTensorIncrement<Dimension::column>(tensor),
+                                            detail::GetTensorIncrement<Dimension::channel>(tensor) };
+        return { tensor.GetConstDataPointer(), tensor.GetShape(), increments };
+    }
+
+    template <typename ElementType>
+    ReferenceExpression<ElementType> RepeatRows(ConstRowVectorReference<ElementType> row, size_t numRows)
+    {
+        return { row.GetConstDataPointer(), { numRows, row.Size(), 1 }, { 0, row.GetIncrement(), 0 } };
+    }
+
+    template <typename ElementType>
+    ReferenceExpression<ElementType> RepeatColumns(ConstColumnVectorReference<ElementType> column, size_t numColumns)
+    {
+        return { column.GetConstDataPointer(), { column.Size(), numColumns, 1 }, { column.GetIncrement(), 0, 0 } };
+    }
+
+    template <typename LeftType, typename RightType, IsExpressionOperands<LeftType, RightType> /* = true */>
+    auto operator+(LeftType left, RightType right)
+    {
+        return detail::MakeBinaryExpression<detail::AddOperation>(left, right);
+    }
+
+    template <typename LeftType, typename RightType, IsExpressionOperands<LeftType, RightType> /* = true */>
+    auto operator-(LeftType left, RightType right)
+    {
+        return detail::MakeBinaryExpression<detail::SubtractOperation>(left, right);
+    }
+
+    template <typename LeftType, typename RightType, IsExpressionOperands<LeftType, RightType> /* = true */>
+    auto operator*(LeftType left, RightType right)
+    {
+        return detail::MakeBinaryExpression<detail::MultiplyOperation>(left, right);
+    }
+
+    template <typename LeftType, typename RightType, IsExpressionOperands<LeftType, RightType> /* = true */>
+    auto operator/(LeftType left, RightType right)
+    {
+        return detail::MakeBinaryExpression<detail::DivideOperation>(left, right);
+    }
+
+    template <typename ExpressionType, IsExpression<ExpressionType> /* = true */>
+    auto operator-(ExpressionType expression)
+    {
+        return Map(expression, detail::NegateFunction());
+    }
+
+    template <typename ExpressionType, typename FunctionType, IsExpression<ExpressionType> /* = true */>
+    UnaryExpression<ExpressionType, FunctionType> Map(ExpressionType expression, FunctionType function)
+    {
+        return { expression, function };
+    }
+
+    template <typename ExpressionType, IsExpression<ExpressionType> /* = true */>
+    auto Square(ExpressionType expression)
+    {
+        return Map(expression, detail::SquareFunction());
+    }
+
+    template <typename ExpressionType, IsExpression<ExpressionType> /* = true */>
+    auto Sqrt(ExpressionType expression)
+    {
+        return Map(expression, detail::SqrtFunction());
+    }
+
+    template <typename ExpressionType, IsExpression<ExpressionType> /* = true */>
+    auto Abs(ExpressionType expression)
+    {
+        return Map(expression, detail::AbsFunction());
+    }
+
+    template <typename ExpressionType, IsExpression<ExpressionType> /* = true */>
+    auto Exp(ExpressionType expression)
+    {
+        return Map(expression, detail::ExpFunction());
+    }
+
+    template <typename ExpressionType, typename ElementType, VectorOrientation orientation, IsExpression<ExpressionType> /* = true */>
+    void EvaluateSet(const ExpressionType& expression, VectorReference<ElementType, orientation> output)
+    {
+        detail::EvaluateSet(expression, output.GetDataPointer(), { output.Size(), 1, 1 }, { output.GetIncrement(), 0, 0 });
+    }
+
+    template <typename ExpressionType, typename ElementType, MatrixLayout layout, IsExpression<ExpressionType> /* = true */>
+    void EvaluateSet(const ExpressionType& expression, MatrixReference<ElementType, layout> output)
+    {
+        detail::EvaluateSet(expression, output.GetDataPointer(), { output.NumRows(), output.NumColumns(), 1 }, { output.GetRowIncrement(), output.GetColumnIncrement(), 0 });
+    }
+
+    template <typename ExpressionType, typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2, IsExpression<ExpressionType> /* = true */>
+    void EvaluateSet(const ExpressionType& expression, TensorReference<ElementType, dimension0, dimension1, dimension2> output)
+    {
+        ExpressionIncrements increments = { detail::GetTensorIncrement<Dimension::row>(output),
+                                            detail::GetTensorIncrement<Dimension::column>(output),
+                                            detail::GetTensorIncrement<Dimension::channel>(output) };
+        detail::EvaluateSet(expression, output.GetDataPointer(), output.GetShape(), increments);
+    }
+
+    template <typename ExpressionType, IsExpression<ExpressionType> /* = true */>
+    typename ExpressionType::ValueType Sum(const ExpressionType& expression)
+    {
+        static_assert(!ExpressionType::isScalar, "Can't sum a scalar expression");
+
+        // Visit the elements in the memory order of the first operand
+        using ValueType = typename ExpressionType::ValueType;
+        const auto shape = expression.GetShape();
+        const auto increments = expression.GetIncrements();
+        ValueType result = 0;
+        if (detail::IsContiguous(shape, increments) && expression.HasIncrements(increments))
+        {
+            const auto size = shape.Size();
+            for (size_t index = 0; index < size; ++index)
+            {
+                result += expression[index];
+            }
+            return result;
+        }
+
+        detail::ForEachElement(shape, increments, [&expression, &result](size_t, size_t row, size_t column, size_t channel) {
+            result += expression(row, column, channel);
+        });
+        return result;
+    }
+} // namespace math
+} // namespace ell
+
+#pragma endregion implementation
@@ -592,7 +592,7 @@ namespace math
         /// <summary> Returns a copy of the contents of the Matrix. </summary>
         ///
         /// <returns> A std::vector with a copy of the contents of the Matrix. </returns>
-        std::vector<ElementType> ToArray() const { return _data; }
+        std::vector<ElementType> ToArray() const { return { _data.begin(), _data.end() }; }
 
         /// <summary> Swaps the contents of this matrix with the contents of another matrix. </summary>
         ///
@@ -602,7 +602,7 @@ namespace math
         /// @}
 
     private:
-        std::vector<ElementType> _data;
+        Storage<ElementType> _data;
     };
 
     /// <summary> A class that implements helper functions for archiving/unarchiving Matrix instances. </summary>
@@ -1085,7 +1085,7 @@ namespace math
     template <typename ElementType, MatrixLayout layout>
     Matrix<ElementType, layout>::Matrix(size_t numRows, size_t numColumns, const std::vector<ElementType>& data) :
         MatrixReference<ElementType, layout>(nullptr, numRows, numColumns),
-        _data(data)
+        _data(data.begin(), data.end())
     {
         this->_pData = _data.data();
     }
@@ -1093,7 +1093,7 @@ namespace math
     template <typename ElementType, MatrixLayout layout>
     Matrix<ElementType, layout>::Matrix(size_t numRows, size_t numColumns, std::vector<ElementType>&& data) :
         MatrixReference<ElementType, layout>(nullptr, numRows, numColumns),
-        _data(std::move(data))
+        _data(ToStorage(std::move(data)))
     {
         this->_pData = _data.data();
     }
@@ -15,8 +15,10 @@
 #include "BlasWrapper.h"
 #endif
 
+#include <algorithm>
 #include <ostream>
 #include <string>
+#include <vector>
 
 namespace ell
 {
@@ -1062,6 +1064,168 @@ namespace math
 
     namespace Internal
     {
+        //
+        // Building blocks of the native GEMV and GEMM, which work on contiguous arrays in loops that the
+        // compiler can vectorize
+        //
+
+        // The GEMV of a column-major matrix accumulates this many rows of the output at a time
+        constexpr size_t nativeGemvRowBlockSize = 1024;
+
+        // The GEMM multiplies blocks of this many rows and columns of C, with this many columns of A (rows of B)
+        // at a time. The packed block of A stays in L1 cache, and the packed panel of B in L2 cache.
+        constexpr size_t nativeGemmRowBlockSize = 64;
+        constexpr size_t nativeGemmColumnBlockSize = 256;
+        constexpr size_t nativeGemmInnerBlockSize = 128;
+
+        // Dot product of a contiguous array with a strided one, with four partial sums so that the loop can be vectorized
+        template <typename ElementType>
+        ElementType NativeDot(size_t size, const ElementType* pContiguous, const ElementType* pStrided, size_t increment)
+        {
+            ElementType sum0 = 0;
+            ElementType sum1 = 0;
+            ElementType sum2 = 0;
+            ElementType sum3 = 0;
+            size_t index = 0;
+            if (increment == 1)
+            {
+                for (; index + 4 <= size; index += 4)
+                {
+                    sum0 += pContiguous[index] * pStrided[index];
+                    sum1 += pContiguous[index + 1] * pStrided[index + 1];
+                    sum2 += pContiguous[index + 2] * pStrided[index + 2];
+                    sum3 += pContiguous[index + 3] * pStrided[index + 3];
+                }
+            }
+            for (; index < size; ++index)
+            {
+                sum0 += pContiguous[index] * pStrided[index * increment];
+            }
+            return (sum0 + sum1) + (sum2 + sum3);
+        }
+
+        // Multiplies a matrix by a scalar, setting it to zero if the scalar is zero (even if it holds NaNs, like BLAS does)
+        template <typename ElementType, MatrixLayout layout>
+        void ScaleMatrix(ElementType scalar, MatrixReference<ElementType, layout> matrix)
+        {
+            if (scalar == 1)
+            {
+                return;
+            }
+            for (size_t i = 0; i < matrix.GetMinorSize(); ++i)
+            {
+                ElementType* pVector = matrix.GetDataPointer() + i * matrix.GetIncrement();
+                for (size_t j = 0; j < matrix.GetMajorSize(); ++j)
+                {
+                    pVector[j] = scalar == 0 ? 0 : scalar * pVector[j];
+                }
+            }
+        }
+
+        // Copies a scaled matrix block into a contiguous row-major array
+        template <typename ElementType, MatrixLayout layout>
+        void PackMatrixBlock(ElementType scalar, ConstMatrixReference<ElementType, layout> block, ElementType* pPacked)
+        {
+            const auto numRows = block.NumRows();
+            const auto numColumns = block.NumColumns();
+            const ElementType* pBlock = block.GetConstDataPointer();
+            const auto increment = block.GetIncrement();
+            if constexpr (layout == MatrixLayout::rowMajor)
+            {
+                for (size_t i = 0; i < numRows; ++i)
+                {
+                    for (size_t j = 0; j < numColumns; ++j)
+                    {
+                        pPacked[i * numColumns + j] = scalar * pBlock[i * increment + j];
+                    }
+                }
+            }
+            else
+            {
+                for (size_t j = 0; j < numColumns; ++j)
+                {
+                    for (size_t i = 0; i < numRows; ++i)
+                    {
+                        pPacked[i * numColumns + j] = scalar * pBlock[j * increment + i];
+                    }
+                }
+            }
+        }
+
+        // Adds a contiguous row-major array to a matrix block
+        template <typename ElementType, MatrixLayout layout>
+        void AddPackedBlock(const ElementType* pPacked, MatrixReference<ElementType, layout> block)
+        {
+            const auto numRows = block.NumRows();
+            const auto numColumns = block.NumColumns();
+            ElementType* pBlock = block.GetDataPointer();
+            const auto increment = block.GetIncrement();
+            if constexpr (layout == MatrixLayout::rowMajor)
+            {
+                for (size_t i = 0; i < numRows; ++i)
+                {
+                    for (size_t j = 0; j < numColumns; ++j)
+                    {
+                        pBlock[i * increment + j] += pPacked[i * numColumns + j];
+                    }
+                }
+            }
+            else
+            {
+                for (size_t j = 0; j < numColumns; ++j)
+                {
+                    for (size_t i = 0; i < numRows; ++i)
+                    {
+                        pBlock[j * increment + i] += pPacked[i * numColumns + j];
+                    }
+                }
+            }
+        }
+
+        // C += A * B, where A is m x k, B is k x n and C is m x n, all contiguous and row-major. Four rows of C are
+        // updated at once, so each row of B that is loaded is used four times.
+        template <typename ElementType>
+        void MultiplyPackedBlocks(size_t m, size_t n, size_t k, const ElementType* pA, const ElementType* pB, ElementType* pC)
+        {
+            size_t i = 0;
+            for (; i + 4 <= m; i += 4)
+            {
+                ElementType* pC0 = pC + i * n;
+                ElementType* pC1 = pC0 + n;
+                ElementType* pC2 = pC1 + n;
+                ElementType* pC3 = pC2 + n;
+                for (size_t p = 0; p < k; ++p)
+                {
+                    const auto a0 = pA[i * k + p];
+                    const auto a1 = pA[(i + 1) * k + p];
+                    const auto a2 = pA[(i + 2) * k + p];
+                    const auto a3 = pA[(i + 3) * k + p];
+                    const ElementType* pBRow = pB + p * n;
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        const auto b = pBRow[j];
+                        pC0[j] += a0 * b;
+                        pC1[j] += a1 * b;
+                        pC2[j] += a2 * b;
+                        pC3[j] += a3 * b;
+                    }
+                }
+            }
+            for (; i < m; ++i)
+            {
+                ElementType* pCRow = pC + i * n;
+                for (size_t p = 0; p < k; ++p)
+                {
+                    const auto a = pA[i * k + p];
+                    const ElementType* pBRow = pB + p * n;
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        pCRow[j] += a * pBRow[j];
+                    }
+                }
+            }
+        }
+
         template <typename ElementType, MatrixLayout layout>
         void MatrixOperations<ImplementationType::native>::RankOneUpdate(ElementType scalar, ConstColumnVectorReference<ElementType> vectorA, ConstRowVectorReference<ElementType> vectorB, MatrixReference<ElementType, layout> matrix)
         {
@@ -1077,10 +1241,51 @@ namespace math
         template <typename ElementType, MatrixLayout layout>
         void MatrixOperations<ImplementationType::native>::MultiplyScaleAddUpdate(ElementType scalarA, ConstMatrixReference<ElementType, layout> matrix, ConstColumnVectorReference<ElementType> vectorA, ElementType scalarB, ColumnVectorReference<ElementType> vectorB)
         {
-            for (size_t i = 0; i < matrix.NumRows(); ++i)
+            const auto numRows = matrix.NumRows();
+            const auto numColumns = matrix.NumColumns();
+            const ElementType* pMatrix = matrix.GetConstDataPointer();
+            const ElementType* pVectorA = vectorA.GetConstDataPointer();
+            const auto incrementA = vectorA.GetIncrement();
+            ElementType* pVectorB = vectorB.GetDataPointer();
+            const auto incrementB = vectorB.GetIncrement();
+
+            if constexpr (layout == MatrixLayout::rowMajor)
             {
-                auto row = matrix.GetRow(i);
-                vectorB[i] = scalarA * Dot(row, vectorA) + scalarB * vectorB[i];
+                for (size_t i = 0; i < numRows; ++i)
+                {
+                    auto dot = NativeDot(numColumns, pMatrix + i * matrix.GetIncrement(), pVectorA, incrementA);
+                    auto& output = pVectorB[i * incrementB];
+                    output = scalarA * dot + (scalarB == 0 ? 0 : scalarB * output);
+                }
+            }
+            else
+            {
+                // add scaled columns to the output, a block of rows at a time, so the block stays in cache
+                for (size_t i = 0; i < numRows; ++i)
+                {
+                    auto& output = pVectorB[i * incrementB];
+                    output = scalarB == 0 ? 0 : scalarB * output;
+                }
+
+                std::vector<ElementType> block(std::min(numRows, nativeGemvRowBlockSize));
+                for (size_t firstRow = 0; firstRow < numRows; firstRow += nativeGemvRowBlockSize)
+                {
+                    const auto blockSize = std::min(nativeGemvRowBlockSize, numRows - firstRow);
+                    std::fill_n(block.data(), blockSize, static_cast<ElementType>(0));
+                    for (size_t j = 0; j < numColumns; ++j)
+                    {
+                        const auto scale = scalarA * pVectorA[j * incrementA];
+                        const ElementType* pColumn = pMatrix + j * matrix.GetIncrement() + firstRow;
+                        for (size_t i = 0; i < blockSize; ++i)
+                        {
+                            block[i] += scale * pColumn[i];
+                        }
+                    }
+                    for (size_t i = 0; i < blockSize; ++i)
+                    {
+                        pVectorB[(firstRow + i) * incrementB] += block[i];
+                    }
+                }
             }
         }
 
@@ -1093,13 +1298,41 @@ namespace math
         template <typename ElementType, MatrixLayout layoutA, MatrixLayout layoutB, MatrixLayout layoutC>
         void MatrixOperations<ImplementationType::native>::MultiplyScaleAddUpdate(ElementType scalarA, ConstMatrixReference<ElementType, layoutA> matrixA, ConstMatrixReference<ElementType, layoutB> matrixB, ElementType scalarB, MatrixReference<ElementType, layoutC> matrixC)
         {
-            for (size_t i = 0; i < matrixA.NumRows(); ++i)
+            const auto m = matrixA.NumRows();
+            const auto n = matrixB.NumColumns();
+            const auto k = matrixA.NumColumns();
+
+            ScaleMatrix(scalarB, matrixC);
+            if (m == 0 || n == 0 || k == 0)
+            {
+                return;
+            }
+
+            // Multiply a block of A by a panel of B at a time, after copying them into contiguous row-major
+            // buffers that fit in cache, and accumulate each block of C in another such buffer
+            const auto maxBlockRows = std::min(m, nativeGemmRowBlockSize);
+            const auto maxBlockColumns = std::min(n, nativeGemmColumnBlockSize);
+            const auto maxBlockInnerSize = std::min(k, nativeGemmInnerBlockSize);
+            std::vector<ElementType> packedA(maxBlockRows * maxBlockInnerSize);
+            std::vector<ElementType> packedB(maxBlockInnerSize * maxBlockColumns);
+            std::vector<ElementType> blockC(maxBlockRows * maxBlockColumns);
+
+            for (size_t firstColumn = 0; firstColumn < n; firstColumn += nativeGemmColumnBlockSize)
             {
-                for (size_t j = 0; j < matrixB.NumColumns(); ++j)
+                const auto numBlockColumns = std::min(nativeGemmColumnBlockSize, n - firstColumn);
+                for (size_t firstInner = 0; firstInner < k; firstInner += nativeGemmInnerBlockSize)
                 {
-                    auto row = matrixA.GetRow(i);
-                    auto column = matrixB.GetColumn(j);
-                    matrixC(i, j) = scalarA * Dot(row, column) + scalarB * matrixC(i, j);
+                    const auto blockInnerSize = std::min(nativeGemmInnerBlockSize, k - firstInner);
+                    PackMatrixBlock(static_cast<ElementType>(1), matrixB.GetSubMatrix(firstInner, firstColumn, blockInnerSize, numBlockColumns), packedB.data());
+
+                    for (size_t firstRow = 0; firstRow < m; firstRow += nativeGemmRowBlockSize)
+                    {
+                        const auto numBlockRows = std::min(nativeGemmRowBlockSize, m - firstRow);
+                        PackMatrixBlock(scalarA, matrixA.GetSubMatrix(firstRow, firstInner, numBlockRows, blockInnerSize), packedA.data());
+                        std::fill_n(blockC.data(), numBlockRows * numBlockColumns, static_cast<ElementType>(0));
+                        MultiplyPackedBlocks(numBlockRows, numBlockColumns, blockInnerSize, packedA.data(), packedB.data(), blockC.data());
+                        AddPackedBlock(blockC.data(), matrixC.GetSubMatrix(firstRow, firstColumn, numBlockRows, numBlockColumns));
+                    }
                 }
             }
         }
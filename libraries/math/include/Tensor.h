@@ -871,7 +871,7 @@ namespace math
         /// <summary> Returns a copy of the contents of the Tensor. </summary>
         ///
         /// <returns> A std::vector with a copy of the contents of the Tensor. </returns>
-        std::vector<ElementType> ToArray() const { return _data; }
+        std::vector<ElementType> ToArray() const { return { _data.begin(), _data.end() }; }
 
         /// <summary> Swaps the contents of this tensor with the contents of another tensor. </summary>
         ///
@@ -882,7 +882,7 @@ namespace math
 
     private:
         using ConstTensorRef = ConstTensorReference<ElementType, dimension0, dimension1, dimension2>;
-        std::vector<ElementType> _data;
+        Storage<ElementType> _data;
     };
 
     /// <summary> A class that implements helper functions for archiving/unarchiving Tensor instances. </summary>
@@ -1667,7 +1667,7 @@ namespace math
     template <typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2>
     Tensor<ElementType, dimension0, dimension1, dimension2>::Tensor(size_t numRows, size_t numColumns, size_t numChannels, const std::vector<ElementType>& data) :
         TensorRef(TensorShape{ numRows, numColumns, numChannels }),
-        _data(data)
+        _data(data.begin(), data.end())
     {
         this->_pData = _data.data();
     }
@@ -1675,7 +1675,7 @@ namespace math
     template <typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2>
     Tensor<ElementType, dimension0, dimension1, dimension2>::Tensor(size_t numRows, size_t numColumns, size_t numChannels, std::vector<ElementType>&& data) :
         TensorRef(TensorShape{ numRows, numColumns, numChannels }),
-        _data(std::move(data))
+        _data(ToStorage(std::move(data)))
     {
         this->_pData = _data.data();
     }
@@ -17,6 +17,7 @@
 
 #include <ostream>
 #include <string>
+#include <vector>
 
 namespace ell
 {
@@ -286,6 +287,140 @@ namespace math
         return stream;
     }
 
+    namespace Internal
+    {
+        // Whatever the dimension order, a tensor's first dimension is the one that is contiguous in memory.
+        // Calls function(pointer, size) for each run of contiguous elements: once for a tensor without padding,
+        // once per primary slice when only the outer dimension is padded, and otherwise once for each
+        // (dimension1, dimension2) position.
+        template <typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2, typename FunctionType>
+        void ForEachContiguousRun(TensorReference<ElementType, dimension0, dimension1, dimension2> tensor, FunctionType function)
+        {
+            if (tensor.IsContiguous())
+            {
+                function(tensor.GetDataPointer(), tensor.Size());
+                return;
+            }
+
+            auto pData = tensor.GetDataPointer();
+            auto sliceIsContiguous = tensor.GetSize0() == tensor.GetIncrement1();
+            auto runSize = sliceIsContiguous ? tensor.GetSize0() * tensor.GetSize1() : tensor.GetSize0();
+            auto numRuns = sliceIsContiguous ? 1 : tensor.GetSize1();
+            for (size_t i = 0; i < tensor.GetSize2(); ++i)
+            {
+                for (size_t j = 0; j < numRuns; ++j)
+                {
+                    function(pData + i * tensor.GetIncrement2() + j * tensor.GetIncrement1(), runSize);
+                }
+            }
+        }
+
+        // A pointer to the elements of a vector, copied into local storage when the vector is strided
+        template <typename ElementType>
+        class ContiguousVectorData
+        {
+        public:
+            ContiguousVectorData(UnorientedConstVectorBase<ElementType> vector) :
+                _pData(vector.GetConstDataPointer())
+            {
+                if (vector.GetIncrement() != 1)
+                {
+                    _copy.resize(vector.Size());
+                    for (size_t i = 0; i < vector.Size(); ++i)
+                    {
+                        _copy[i] = vector[i];
+                    }
+                    _pData = _copy.data();
+                }
+            }
+
+            const ElementType* Get() const { return _pData; }
+
+        private:
+            const ElementType* _pData;
+            std::vector<ElementType> _copy;
+        };
+
+        // Applies element = function(element, vectorIndex) to every element of a tensor, where vectorIndex is the
+        // element's coordinate along the broadcast dimension. The specializations are selected by the position
+        // of that dimension in the tensor's dimension order, and each one runs a contiguous inner loop.
+        template <size_t broadcastPosition>
+        struct TensorBroadcast;
+
+        // Broadcast along the contiguous dimension: the vector index varies within each run
+        template <>
+        struct TensorBroadcast<0>
+        {
+            template <typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2, typename FunctionType>
+            static void Transform(TensorReference<ElementType, dimension0, dimension1, dimension2> tensor, FunctionType function)
+            {
+                auto pData = tensor.GetDataPointer();
+                auto size0 = tensor.GetSize0();
+                for (size_t i = 0; i < tensor.GetSize2(); ++i)
+                {
+                    for (size_t j = 0; j < tensor.GetSize1(); ++j)
+                    {
+                        auto pRun = pData + i * tensor.GetIncrement2() + j * tensor.GetIncrement1();
+                        for (size_t k = 0; k < size0; ++k)
+                        {
+                            pRun[k] = function(pRun[k], k);
+                        }
+                    }
+                }
+            }
+        };
+
+        // Broadcast along the middle dimension: the vector index is fixed within each run
+        template <>
+        struct TensorBroadcast<1>
+        {
+            template <typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2, typename FunctionType>
+            static void Transform(TensorReference<ElementType, dimension0, dimension1, dimension2> tensor, FunctionType function)
+            {
+                auto pData = tensor.GetDataPointer();
+                auto size0 = tensor.GetSize0();
+                for (size_t i = 0; i < tensor.GetSize2(); ++i)
+                {
+                    for (size_t j = 0; j < tensor.GetSize1(); ++j)
+                    {
+                        auto pRun = pData + i * tensor.GetIncrement2() + j * tensor.GetIncrement1();
+                        for (size_t k = 0; k < size0; ++k)
+                        {
+                            pRun[k] = function(pRun[k], j);
+                        }
+                    }
+                }
+            }
+        };
+
+        // Broadcast along the outer dimension: the vector index is fixed within each primary slice, which is a
+        // single run unless the tensor is padded
+        template <>
+        struct TensorBroadcast<2>
+        {
+            template <typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2, typename FunctionType>
+            static void Transform(TensorReference<ElementType, dimension0, dimension1, dimension2> tensor, FunctionType function)
+            {
+                auto pData = tensor.GetDataPointer();
+                auto size0 = tensor.GetSize0();
+                auto sliceIsContiguous = size0 == tensor.GetIncrement1();
+                auto runSize = sliceIsContiguous ? size0 * tensor.GetSize1() : size0;
+                auto numRuns = sliceIsContiguous ? 1 : tensor.GetSize1();
+                for (size_t i = 0; i < tensor.GetSize2(); ++i)
+                {
+                    for (size_t j = 0; j < numRuns; ++j)
+                    {
+                        auto pRun = pData + i * tensor.GetIncrement2() + j * tensor.GetIncrement1();
+                        for (size_t k = 0; k < runSize; ++k)
+                        {
+                            pRun[k] = function(pRun[k], i);
+                        }
+                    }
+                }
+            }
+        };
+    } // namespace Internal
+
     template <typename TensorElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2, typename ScalarType, utilities::IsFundamental<ScalarType>>
     void operator+=(TensorReference<TensorElementType, dimension0, dimension1, dimension2> tensor, ScalarType scalar)
     {
@@ -315,51 +450,48 @@ namespace math
     template <ImplementationType implementation, typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2>
     void ScaleUpdate(ElementType scalar, TensorReference<ElementType, dimension0, dimension1, dimension2> tensor)
     {
-        for (size_t i = 0; i < tensor.NumPrimarySlices(); ++i)
-        {
-            ScaleUpdate<implementation>(scalar, tensor.GetPrimarySlice(i));
-        }
+        Internal::ForEachContiguousRun(tensor, [scalar](ElementType* pRun, size_t size) {
+            ScaleUpdate<implementation>(scalar, RowVectorReference<ElementType>(pRun, size));
+        });
     }
 
     template <Dimension vectorOrientation, ImplementationType implementation, typename ElementType, Dimension dimension0, Dimension dimension1>
     void ScaleUpdate(UnorientedConstVectorBase<ElementType> vector, TensorReference<ElementType, dimension0, dimension1, vectorOrientation> tensor)
     {
-        for (size_t i = 0; i < vector.Size(); ++i)
-        {
-            math::ScaleUpdate<implementation>(vector[i], tensor.template GetSlice<dimension0, dimension1>(i));
-        }
+        DEBUG_CHECK_SIZES(vector.Size() != tensor.GetSize2(), "vector and tensor dimensions must be the same");
+
+        Internal::ContiguousVectorData<ElementType> scale(vector);
+        Internal::TensorBroadcast<2>::Transform(tensor, [pScale = scale.Get()](ElementType x, size_t i) { return pScale[i] * x; });
     }
 
     template <Dimension vectorOrientation, ImplementationType implementation, typename ElementType, Dimension dimension0, Dimension dimension2>
     void ScaleUpdate(UnorientedConstVectorBase<ElementType> vector, TensorReference<ElementType, dimension0, vectorOrientation, dimension2> tensor)
     {
-        for (size_t i = 0; i < vector.Size(); ++i)
-        {
-            math::ScaleUpdate<implementation>(vector[i], tensor.template GetSlice<dimension0, dimension2>(i));
-        }
+        DEBUG_CHECK_SIZES(vector.Size() != tensor.GetSize1(), "vector and tensor dimensions must be the same");
+
+        Internal::ContiguousVectorData<ElementType> scale(vector);
+        Internal::TensorBroadcast<1>::Transform(tensor, [pScale = scale.Get()](ElementType x, size_t i) { return pScale[i] * x; });
     }
 
     template <Dimension vectorOrientation, ImplementationType implementation, typename ElementType, Dimension dimension1, Dimension dimension2>
     void ScaleUpdate(UnorientedConstVectorBase<ElementType> vector, TensorReference<ElementType, vectorOrientation, dimension1, dimension2> tensor)
     {
-        for (size_t i = 0; i < tensor.GetSize2(); ++i)
-        {
-            auto M = tensor.GetPrimarySlice(i);
-            for (size_t j = 0; j < tensor.GetSize0(); ++j)
-            {
-                auto u = M.GetRow(j);
-                math::ScaleUpdate<implementation>(vector[j], u);
-            }
-        }
+        DEBUG_CHECK_SIZES(vector.Size() != tensor.GetSize0(), "vector and tensor dimensions must be the same");
+
+        Internal::ContiguousVectorData<ElementType> scale(vector);
+        Internal::TensorBroadcast<0>::Transform(tensor, [pScale = scale.Get()](ElementType x, size_t i) { return pScale[i] * x; });
     }
 
     template <ImplementationType implementation, typename ElementType, Dimension dimension0, Dimension dimension1, Dimension dimension2>
     void AddUpdate(ElementType scalar, TensorReference<ElementType, dimension0, dimension1, dimension2> tensor)
     {
-        for (size_t i = 0; i < tensor.NumPrimarySlices(); ++i)
+        if (scalar == 0)
         {
-            AddUpdate<implementation>(scalar, tensor.GetPrimarySlice(i));
+            return;
         }
+        Internal::ForEachContiguousRun(tensor, [scalar](ElementType* pRun, size_t size) {
+            AddUpdate<implementation>(scalar, RowVectorReference<ElementType>(pRun, size));
+        });
     }
 
     template <Dimension vectorOrientation, ImplementationType implementation, typename ElementType, Dimension dimension0, Dimension dimension1>
@@ -367,20 +499,17 @@ namespace math
     {
         DEBUG_CHECK_SIZES(vector.Size() != tensor.GetSize2(), "vector and tensor dimensions must be the same");
 
-        for (size_t i = 0; i < vector.Size(); ++i)
-        {
-            AddUpdate<implementation>(vector[i], tensor.template GetSlice<dimension0, dimension1>(i));
-        }
+        Internal::ContiguousVectorData<ElementType> bias(vector);
+        Internal::TensorBroadcast<2>::Transform(tensor, [pBias = bias.Get()](ElementType x, size_t i) { return x + pBias[i]; });
     }
 
     template <Dimension vectorOrientation, ImplementationType implementation, typename ElementType, Dimension dimension0, Dimension dimension2>
     void AddUpdate(UnorientedConstVectorBase<ElementType> vector, TensorReference<ElementType, dimension0, vectorOrientation, dimension2> tensor)
     {
         DEBUG_CHECK_SIZES(vector.Size() != tensor.GetSize1(), "vector and tensor dimensions must be the same");
-        for (size_t i = 0; i < vector.Size(); ++i)
-        {
-            AddUpdate<implementation>(vector[i], tensor.template GetSlice<dimension0, dimension2>(i));
-        }
+
+        Internal::ContiguousVectorData<ElementType> bias(vector);
+        Internal::TensorBroadcast<1>::Transform(tensor, [pBias = bias.Get()](ElementType x, size_t i) { return x + pBias[i]; });
     }
 
     template <Dimension vectorOrientation, ImplementationType implementation, typename ElementType, Dimension dimension1, Dimension dimension2>
@@ -394,35 +523,28 @@ namespace math
     {
         DEBUG_CHECK_SIZES(vector.Size() != tensor.GetSize0(), "vector and tensor dimensions must be the same");
 
-        for (size_t i = 0; i < tensor.GetSize2(); ++i)
-        {
-            auto M = tensor.GetPrimarySlice(i);
-            for (size_t j = 0; j < tensor.GetSize1(); ++j)
-            {
-                auto u = M.GetColumn(j);
-                AddUpdate<implementation>(vector, u);
-            }
-        }
+        Internal::ContiguousVectorData<ElementType> bias(vector);
+        Internal::TensorBroadcast<0>::Transform(tensor, [pBias = bias.Get()](ElementType x, size_t i) { return x + pBias[i]; });
     }
 
     template <Dimension vectorOrientation, ImplementationType implementation, typename ElementType, Dimension dimension0, Dimension dimension1>
     void ScaleAddUpdate(UnorientedConstVectorBase<ElementType> scale, UnorientedConstVectorBase<ElementType> bias, TensorReference<ElementType, dimension0, dimension1, vectorOrientation> tensor)
     {
         DEBUG_CHECK_SIZES(scale.Size() != tensor.GetSize2(), "vector and tensor dimensions must be the same");
-        for (size_t i = 0; i < scale.Size(); ++i)
-        {
-            ScaleAddUpdate<implementation>(scale[i], OnesMatrix(), bias[i], tensor.template GetSlice<dimension0, dimension1>(i));
-        }
+
+        Internal::ContiguousVectorData<ElementType> scaleData(scale);
+        Internal::ContiguousVectorData<ElementType> biasData(bias);
+        Internal::TensorBroadcast<2>::Transform(tensor, [pScale = scaleData.Get(), pBias = biasData.Get()](ElementType x, size_t i) { return pScale[i] * x + pBias[i]; });
     }
 
     template <Dimension vectorOrientation, ImplementationType implementation, typename ElementType, Dimension dimension0, Dimension dimension2>
     void ScaleAddUpdate(UnorientedConstVectorBase<ElementType> scale, UnorientedConstVectorBase<ElementType> bias, TensorReference<ElementType, dimension0, vectorOrientation, dimension2> tensor)
     {
         DEBUG_CHECK_SIZES(scale.Size() != tensor.GetSize1(), "vector and tensor dimensions must be the same");
-        for (size_t i = 0; i < scale.Size(); ++i)
-        {
-            ScaleAddUpdate<implementation>(scale[i], OnesMatrix(), bias[i], tensor.template GetSlice<dimension0, dimension2>(i));
-        }
+
+        Internal::ContiguousVectorData<ElementType> scaleData(scale);
+        Internal::ContiguousVectorData<ElementType> biasData(bias);
+        Internal::TensorBroadcast<1>::Transform(tensor, [pScale = scaleData.Get(), pBias = biasData.Get()](ElementType x, size_t i) { return pScale[i] * x + pBias[i]; });
     }
 
     template <Dimension vectorOrientation, ImplementationType implementation, typename ElementType, Dimension dimension1, Dimension dimension2>
@@ -430,18 +552,9 @@ namespace math
     {
         DEBUG_CHECK_SIZES(scale.Size() != tensor.GetSize0() || bias.Size() != tensor.GetSize0(), "vectors and tensor dimensions must be the same");
 
-        for (size_t i = 0; i < tensor.GetSize2(); ++i)
-        {
-            auto M = tensor.GetPrimarySlice(i);
-            for (size_t j = 0; j < tensor.GetSize1(); ++j)
-            {
-                auto u = M.GetColumn(j);
-                for (size_t k = 0; k < tensor.GetSize0(); ++k)
-                {
-                    u[k] = scale[k] * u[k] + bias[k];
-                }
-            }
-        }
+        Internal::ContiguousVectorData<ElementType> scaleData(scale);
+        Internal::ContiguousVectorData<ElementType> biasData(bias);
+        Internal::TensorBroadcast<0>::Transform(tensor, [pScale = scaleData.Get(), pBias = biasData.Get()](ElementType x, size_t i) { return pScale[i] * x + pBias[i]; });
     }
 } // namespace math
 } // namespace ell
@@ -9,16 +9,53 @@
 #pragma once
 
 #include <utilities/include/IArchivable.h>
+#include <utilities/include/PoolAllocator.h>
 #include <utilities/include/StlStridedIterator.h>
 
 #include <cmath>
 #include <limits>
+#include <type_traits>
 #include <vector>
 
 namespace ell
 {
 namespace math
 {
+    /// <summary>
+    /// The storage that Vector, Matrix and Tensor own their elements in. In builds with `ELL_USE_POOL_ALLOCATOR`
+    /// defined (the `USE_POOL_ALLOCATOR` CMake option), its memory is aligned for SIMD loads and comes from a
+    /// per-thread pool, so that temporaries created in loops don't go to the heap each time. Otherwise it's a
+    /// plain std::vector.
+    /// </summary>
+    ///
+    /// <typeparam name="ElementType"> The element type. </typeparam>
+#ifdef ELL_USE_POOL_ALLOCATOR
+    template <typename ElementType>
+    using Storage = std::vector<ElementType, utilities::PoolAllocator<ElementType>>;
+#else
+    template <typename ElementType>
+    using Storage = std::vector<ElementType>;
+#endif
+
+    /// <summary> Turns a std::vector into Storage, adopting its buffer if Storage uses the default allocator, and
+    /// copying it otherwise. </summary>
+    ///
+    /// <param name="data"> The std::vector. </param>
+    ///
+    /// <returns> The storage. </returns>
+    template <typename ElementType>
+    Storage<ElementType> ToStorage(std::vector<ElementType>&& data)
+    {
+        if constexpr (std::is_same_v<Storage<ElementType>, std::vector<ElementType>>)
+        {
+            return std::move(data);
+        }
+        else
+        {
+            return { data.begin(), data.end() };
+        }
+    }
+
     /// <summary> Enum of possible vector orientations. </summary>
     enum class VectorOrientation
     {
@@ -411,19 +448,19 @@ namespace math
         using ConstVectorReference<ElementType, orientation>::_increment;
 
         template <typename T, VectorOrientation o>
-        friend auto begin(Vector<T, o>& vector) -> utilities::StlStridedIterator<typename std::vector<T>::iterator>;
+        friend auto begin(Vector<T, o>& vector) -> utilities::StlStridedIterator<typename Storage<T>::iterator>;
 
         template <typename T, VectorOrientation o>
-        friend auto end(Vector<T, o>& vector) -> utilities::StlStridedIterator<typename std::vector<T>::iterator>;
+        friend auto end(Vector<T, o>& vector) -> utilities::StlStridedIterator<typename Storage<T>::iterator>;
 
         template <typename T, VectorOrientation o>
-        friend auto begin(const Vector<T, o>& vector) -> utilities::StlStridedIterator<typename std::vector<T>::const_iterator>;
+        friend auto begin(const Vector<T, o>& vector) -> utilities::StlStridedIterator<typename Storage<T>::const_iterator>;
 
         template <typename T, VectorOrientation o>
-        friend auto end(const Vector<T, o>& vector) -> utilities::StlStridedIterator<typename std::vector<T>::const_iterator>;
+        friend auto end(const Vector<T, o>& vector) -> utilities::StlStridedIterator<typename Storage<T>::const_iterator>;
 
         // member variables
-        std::vector<ElementType> _data;
+        Storage<ElementType> _data;
     };
 
     /// <summary> Get iterator to the beginning of a Vector </summary>
@@ -432,7 +469,7 @@ namespace math
     ///
     /// <returns> A stl iterator to the beginning of the vector. </returns>
     template <typename ElementType, VectorOrientation orientation>
-    auto begin(Vector<ElementType, orientation>& vector) -> utilities::StlStridedIterator<typename std::vector<ElementType>::iterator>;
+    auto begin(Vector<ElementType, orientation>& vector) -> utilities::StlStridedIterator<typename Storage<ElementType>::iterator>;
 
     /// <summary> Get a const stl iterator to the beginning of a Vector </summary>
     ///
@@ -440,7 +477,7 @@ namespace math
     ///
     /// <returns> A stl iterator to the beginning of the vector. </returns>
     template <typename ElementType, VectorOrientation orientation>
-    auto begin(const Vector<ElementType, orientation>& vector) -> utilities::StlStridedIterator<typename std::vector<ElementType>::const_iterator>;
+    auto begin(const Vector<ElementType, orientation>& vector) -> utilities::StlStridedIterator<typename Storage<ElementType>::const_iterator>;
 
     /// <summary> Get iterator to the end of a Vector </summary>
     ///
@@ -448,7 +485,7 @@ namespace math
     ///
     /// <returns> A stl iterator to the end of the vector. </returns>
     template <typename ElementType, VectorOrientation orientation>
-    auto end(Vector<ElementType, orientation>& vector) -> utilities::StlStridedIterator<typename std::vector<ElementType>::iterator>;
+    auto end(Vector<ElementType, orientation>& vector) -> utilities::StlStridedIterator<typename Storage<ElementType>::iterator>;
 
     /// <summary> Get a const stl iterator to the end of a Vector </summary>
     ///
@@ -456,7 +493,7 @@ namespace math
     ///
     /// <returns> A stl iterator to the end of the vector. </returns>
     template <typename ElementType, VectorOrientation orientation>
-    auto end(const Vector<ElementType, orientation>& vector) -> utilities::StlStridedIterator<typename std::vector<ElementType>::const_iterator>;
+    auto end(const Vector<ElementType, orientation>& vector) -> utilities::StlStridedIterator<typename Storage<ElementType>::const_iterator>;
 
     /// <summary> A class that implements helper functions for archiving/unarchiving Vector instances. </summary>
     class VectorArchiver
@@ -840,7 +877,7 @@ namespace math
     template <typename ElementType, VectorOrientation orientation>
     Vector<ElementType, orientation>::Vector(std::vector<ElementType> data) :
         VectorReference<ElementType, orientation>(nullptr, data.size(), 1),
-        _data(std::move(data))
+        _data(ToStorage(std::move(data)))
     {
         this->_pData = _data.data();
     }
@@ -911,25 +948,25 @@ namespace math
     }
 
     template <typename ElementType, VectorOrientation orientation>
-    utilities::StlStridedIterator<typename std::vector<ElementType>::iterator> begin(Vector<ElementType, orientation>& vector)
+    utilities::StlStridedIterator<typename Storage<ElementType>::iterator> begin(Vector<ElementType, orientation>& vector)
     {
         return { vector._data.begin(), static_cast<ptrdiff_t>(vector.GetIncrement()) };
     }
 
     template <typename ElementType, VectorOrientation orientation>
-    utilities::StlStridedIterator<typename std::vector<ElementType>::const_iterator> begin(const Vector<ElementType, orientation>& vector)
+    utilities::StlStridedIterator<typename Storage<ElementType>::const_iterator> begin(const Vector<ElementType, orientation>& vector)
     {
         return { vector._data.cbegin(), static_cast<ptrdiff_t>(vector.GetIncrement()) };
     }
 
     template <typename ElementType, VectorOrientation orientation>
-    utilities::StlStridedIterator<typename std::vector<ElementType>::iterator> end(Vector<ElementType, orientation>& vector)
+    utilities::StlStridedIterator<typename Storage<ElementType>::iterator> end(Vector<ElementType, orientation>& vector)
     {
         return { vector._data.end(), static_cast<ptrdiff_t>(vector.GetIncrement()) };
     }
 
     template <typename ElementType, VectorOrientation orientation>
-    utilities::StlStridedIterator<typename std::vector<ElementType>::const_iterator> end(const Vector<ElementType, orientation>& vector)
+    utilities::StlStridedIterator<typename Storage<ElementType>::const_iterator> end(const Vector<ElementType, orientation>& vector)
     {
         return { vector._data.cend(), static_cast<ptrdiff_t>(vector.GetIncrement()) };
     }
@@ -9,10 +9,13 @@
 #include "BlasWrapper.h"
 #include "Matrix.h"
 
+#include <utilities/include/Unused.h>
+
 #if USE_BLAS
 #include <cblas.h>
 #endif
 
+#include <algorithm>
 #include <thread> // for hardware_concurrency()
 
 namespace ell
@@ -63,14 +66,60 @@ namespace math
             return static_cast<int>(transpose);
         }
 
-        void SetNumThreads(int numThreads)
+        namespace
         {
-            if (numThreads == 0)
+            ThreadingPolicy& GetThreadingPolicyReference()
             {
-                numThreads = std::thread::hardware_concurrency();
+                static ThreadingPolicy policy;
+                return policy;
             }
+
+            int GetMaxThreads(int maxThreads)
+            {
+                return maxThreads > 0 ? maxThreads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            }
+        } // namespace
+
+        void SetThreadingPolicy(const ThreadingPolicy& policy)
+        {
+            GetThreadingPolicyReference() = policy;
+        }
+
+        ThreadingPolicy GetThreadingPolicy()
+        {
+            return GetThreadingPolicyReference();
+        }
+
+        int GetNumThreads(const ThreadingPolicy& policy, size_t numOperations)
+        {
+            auto maxThreads = GetMaxThreads(policy.maxThreads);
+            if (policy.minOperationsPerThread == 0)
+            {
+                return maxThreads;
+            }
+            auto numThreads = numOperations / policy.minOperationsPerThread;
+            return static_cast<int>(std::max<size_t>(1, std::min<size_t>(numThreads, maxThreads)));
+        }
+
+        void SetNumThreadsForCall(size_t numOperations)
+        {
+#ifdef OPENBLAS_CONST
+            // only change the number of threads if it isn't already right
+            auto numThreads = GetNumThreads(GetThreadingPolicyReference(), numOperations);
+            if (numThreads != openblas_get_num_threads())
+            {
+                openblas_set_num_threads(numThreads);
+            }
+#else
+            UNUSED(numOperations);
+#endif
+        }
+
+        void SetNumThreads(int numThreads)
+        {
+            GetThreadingPolicyReference().maxThreads = numThreads;
 #ifdef OPENBLAS_CONST
-            openblas_set_num_threads(numThreads);
+            openblas_set_num_threads(GetMaxThreads(numThreads));
 #endif
         }
 
@@ -147,21 +196,25 @@ namespace math
 
         void Gemv(MatrixLayout order, MatrixTranspose transpose, int m, int n, float alpha, const float* M, int lda, const float* x, int incx, float beta, float* y, int incy)
         {
+            SetNumThreadsForCall(static_cast<size_t>(m) * n);
             cblas_sgemv(static_cast<CBLAS_ORDER>(GetCBlasMatrixOrder(order)), static_cast<CBLAS_TRANSPOSE>(GetCBlasMatrixTranspose(transpose)), m, n, alpha, M, lda, x, incx, beta, y, incy);
         }
 
         void Gemv(MatrixLayout order, MatrixTranspose transpose, int m, int n, double alpha, const double* M, int lda, const double* x, int incx, double beta, double* y, int incy)
         {
+            SetNumThreadsForCall(static_cast<size_t>(m) * n);
             cblas_dgemv(static_cast<CBLAS_ORDER>(GetCBlasMatrixOrder(order)), static_cast<CBLAS_TRANSPOSE>(GetCBlasMatrixTranspose(transpose)), m, n, alpha, M, lda, x, incx, beta, y, incy);
         }
 
         void Gemm(MatrixLayout order, MatrixTranspose transposeA, MatrixTranspose transposeB, int m, int n, int k, float alpha, const float* A, int lda, const float* B, int ldb, float beta, float* C, int ldc)
         {
+            SetNumThreadsForCall(static_cast<size_t>(m) * n * k);
             cblas_sgemm(static_cast<CBLAS_ORDER>(GetCBlasMatrixOrder(order)), static_cast<CBLAS_TRANSPOSE>(GetCBlasMatrixTranspose(transposeA)), static_cast<CBLAS_TRANSPOSE>(GetCBlasMatrixTranspose(transposeB)), m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
         }
 
         void Gemm(MatrixLayout order, MatrixTranspose transposeA, MatrixTranspose transposeB, int m, int n, int k, double alpha, const double* A, int lda, const double* B, int ldb, double beta, double* C, int ldc)
         {
+            SetNumThreadsForCall(static_cast<size_t>(m) * n * k);
             cblas_dgemm(static_cast<CBLAS_ORDER>(GetCBlasMatrixOrder(order)), static_cast<CBLAS_TRANSPOSE>(GetCBlasMatrixTranspose(transposeA)), static_cast<CBLAS_TRANSPOSE>(GetCBlasMatrixTranspose(transposeB)), m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
         }
 #endif
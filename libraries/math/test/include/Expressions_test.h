@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     Expressions_test.h (math_test)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <testing/include/testing.h>
+
+#include <math/include/Expressions.h>
+#include <math/include/Matrix.h>
+#include <math/include/Tensor.h>
+#include <math/include/Vector.h>
+
+#include <utilities/include/Exception.h>
+
+#include <cmath>
+
+using namespace ell;
+
+template <typename ElementType, math::VectorOrientation orientation>
+void TestVectorExpression();
+
+template <typename ElementType, math::MatrixLayout layout1, math::MatrixLayout layout2>
+void TestMatrixExpression();
+
+template <typename ElementType>
+void TestMatrixBroadcastExpression();
+
+template <typename ElementType>
+void TestTensorExpression();
+
+template <typename ElementType>
+void TestExpressionSum();
+
+template <typename ElementType>
+void TestExpressionShapeMismatch();
+
+#pragma region implementation
+
+template <typename ElementType, math::VectorOrientation orientation>
+void TestVectorExpression()
+{
+    math::Vector<ElementType, orientation> u{ 1, 2, 3, 4, 5 };
+    math::Vector<ElementType, orientation> v{ 2, 0, -1, 0, 1 };
+    math::Vector<ElementType, orientation> w{ -1, 2, 1, 1, 4 };
+
+    // output = 0.5 * u + 2 * v .* w - 1
+    math::Vector<ElementType, orientation> output(5);
+    math::EvaluateSet(0.5 * math::AsExpression(u) + 2 * math::AsExpression(v) * math::AsExpression(w) - 1, output);
+    math::Vector<ElementType, orientation> r1{ -4.5, 0, -1.5, 1, 9.5 };
+
+    // output = sqrt(|u - w|) / 2, reading the even entries of a vector and writing the odd ones
+    math::Vector<ElementType, orientation> strided{ 1, 0, 2, 0, 3, 0, 4, 0, 5, 0 };
+    math::ConstVectorReference<ElementType, orientation> evenEntries(strided.GetConstDataPointer(), 5, 2);
+    math::VectorReference<ElementType, orientation> oddEntries(strided.GetDataPointer() + 1, 5, 2);
+    math::EvaluateSet(math::Sqrt(math::Abs(math::AsExpression(evenEntries) - math::AsExpression(w))) / 2, oddEntries);
+    auto half = [](double x) { return static_cast<ElementType>(std::sqrt(x) / 2); };
+    math::Vector<ElementType, orientation> r2{ 1, half(2), 2, 0, 3, half(2), 4, half(3), 5, half(1) };
+
+    // output = output - u, in place
+    math::Vector<ElementType, orientation> inPlace{ 5, 5, 5, 5, 5 };
+    math::EvaluateSet(math::AsExpression(inPlace) - math::AsExpression(u), inPlace);
+    math::Vector<ElementType, orientation> r3{ 4, 3, 2, 1, 0 };
+
+    testing::ProcessTest("Vector expression", output == r1 && strided.IsEqual(r2, static_cast<ElementType>(1.0e-6)) && inPlace == r3);
+}
+
+template <typename ElementType, math::MatrixLayout layout1, math::MatrixLayout layout2>
+void TestMatrixExpression()
+{
+    math::Matrix<ElementType, layout1> A{
+        { 1, 2, 3 },
+        { 4, 5, 6 }
+    };
+    math::Matrix<ElementType, layout2> B{
+        { 1, 0, -1 },
+        { 2, 1, 0 }
+    };
+    math::Matrix<ElementType, layout1> C{
+        { 1, 4 },
+        { 2, 5 },
+        { 3, 6 }
+    };
+
+    // output = A .* B - 3 * exp(0 * A) + C', where the transpose has a different layout from the output
+    math::Matrix<ElementType, layout2> output(2, 3);
+    math::EvaluateSet(math::AsExpression(A) * math::AsExpression(B) - 3 * math::Exp(0 * math::AsExpression(A)) + math::AsExpression(C.Transpose()), output);
+    math::Matrix<ElementType, layout2> R{
+        { -1, -1, -3 },
+        { 9, 7, 3 }
+    };
+
+    testing::ProcessTest("Matrix expression", output == R);
+}
+
+template <typename ElementType>
+void TestMatrixBroadcastExpression()
+{
+    math::RowMatrix<ElementType> A{
+        { 1, 2, 3 },
+        { 4, 5, 6 }
+    };
+    math::RowVector<ElementType> rowValues{ 10, 20, 30 };
+    math::ColumnVector<ElementType> columnValues{ 100, 200 };
+
+    // output(i, j) = A(i, j) + rowValues(j) - columnValues(i)
+    math::ColumnMatrix<ElementType> output(2, 3);
+    math::EvaluateSet(math::AsExpression(A) + math::RepeatRows(rowValues, 2) - math::RepeatColumns(columnValues, 3), output);
+    math::ColumnMatrix<ElementType> R{
+        { -89, -78, -67 },
+        { -186, -175, -164 }
+    };
+
+    testing::ProcessTest("Matrix broadcast expression", output == R);
+}
+
+template <typename ElementType>
+void TestTensorExpression()
+{
+    math::ChannelColumnRowTensor<ElementType> T1{
+        { { 1, 2 }, { 3, 4 } },
+        { { 5, 6 }, { 7, 8 } }
+    };
+    math::ColumnRowChannelTensor<ElementType> T2{
+        { { 1, 1 }, { 2, 2 } },
+        { { 3, 3 }, { 4, 4 } }
+    };
+
+    // output = 2 * T1 - T2, with the output in the layout of T1 and then of T2
+    math::ChannelColumnRowTensor<ElementType> output1(2, 2, 2);
+    math::EvaluateSet(2 * math::AsExpression(T1) - math::AsExpression(T2), output1);
+    math::ColumnRowChannelTensor<ElementType> output2(2, 2, 2);
+    math::EvaluateSet(2 * math::AsExpression(T1) - math::AsExpression(T2), output2);
+    math::ChannelColumnRowTensor<ElementType> R{
+        { { 1, 3 }, { 4, 6 } },
+        { { 7, 9 }, { 10, 12 } }
+    };
+
+    testing::ProcessTest("Tensor expression", output1 == R && output2 == R);
+}
+
+template <typename ElementType>
+void TestExpressionSum()
+{
+    math::ColumnMatrix<ElementType> A{
+        { 1, 2, 3 },
+        { 4, 5, 6 }
+    };
+    math::ColumnMatrix<ElementType> B{
+        { 1, 1, 1 },
+        { 2, 2, 2 }
+    };
+    math::RowMatrix<ElementType> C{
+        { 0, 0, 0 },
+        { 1, 1, 1 }
+    };
+
+    // sum((A - B) .^ 2), contiguous and with a different layout
+    auto sum1 = math::Sum(math::Square(math::AsExpression(A) - math::AsExpression(B)));
+    auto sum2 = math::Sum(math::Square(math::AsExpression(A) - math::AsExpression(C)));
+    auto sum3 = math::Sum(math::RepeatRows(math::RowVector<ElementType>{ 1, 2, 3 }, 4));
+
+    testing::ProcessTest("Expression sum", sum1 == 1 + 4 + 4 + 9 + 16 && sum2 == 1 + 4 + 9 + 9 + 16 + 25 && sum3 == 24);
+}
+
+template <typename ElementType>
+void TestExpressionShapeMismatch()
+{
+    math::ColumnVector<ElementType> u{ 1, 2, 3 };
+    math::ColumnVector<ElementType> v{ 1, 2 };
+    math::ColumnVector<ElementType> output(3);
+
+    bool operandsThrew = false;
+    try
+    {
+        math::EvaluateSet(math::AsExpression(u) + math::AsExpression(v), output);
+    }
+    catch (utilities::InputException&)
+    {
+        operandsThrew = true;
+    }
+
+    bool outputThrew = false;
+    try
+    {
+        math::EvaluateSet(2 * math::AsExpression(v), output);
+    }
+    catch (utilities::InputException&)
+    {
+        outputThrew = true;
+    }
+
+    testing::ProcessTest("Expression shape mismatch", operandsThrew && outputThrew);
+}
+
+#pragma endregion implementation
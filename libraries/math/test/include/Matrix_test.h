@@ -9,6 +9,7 @@
 
 #include <testing/include/testing.h>
 
+#include <math/include/BlasWrapper.h>
 #include <math/include/Matrix.h>
 #include <math/include/MatrixOperations.h>
 #include <math/include/Vector.h>
@@ -19,6 +20,8 @@
 
 using namespace ell;
 
+void TestBlasThreadingPolicy();
+
 template <typename ElementType, math::MatrixLayout layout>
 void TestMatrixNumRows();
 
@@ -190,6 +193,9 @@ void TestVectorMatrixMultiplyScaleAddUpdate();
 template <typename ElementType, math::MatrixLayout layout1, math::MatrixLayout layout2, math::MatrixLayout layout3, math::ImplementationType implementation>
 void TestMatrixMatrixMultiplyScaleAddUpdate();
 
+template <typename ElementType, math::MatrixLayout layout1, math::MatrixLayout layout2, math::MatrixLayout layout3, math::ImplementationType implementation>
+void TestLargeMatrixMatrixMultiplyScaleAddUpdate();
+
 template <typename ElementType, math::MatrixLayout layout>
 void TestMatrixElementwiseMultiplySet();
 
@@ -1521,6 +1527,78 @@ void TestMatrixMatrixMultiplyScaleAddUpdate()
     testing::ProcessTest(implementationName + "::MultiplyScaleAddUpdate(scalar, Matrix, Matrix, scalar, Matrix)", C == R && CCC == R);
 }
 
+template <typename ElementType, math::MatrixLayout layout1, math::MatrixLayout layout2, math::MatrixLayout layout3, math::ImplementationType implementation>
+void TestLargeMatrixMatrixMultiplyScaleAddUpdate()
+{
+    auto implementationName = math::Internal::MatrixOperations<implementation>::GetImplementationName();
+
+    // sizes that aren't multiples of the native implementation's block sizes, and matrices that are padded
+    const size_t m = 70;
+    const size_t n = 300;
+    const size_t k = 1100;
+    auto value = [](size_t i, size_t j) { return static_cast<ElementType>(static_cast<int>((3 * i + 5 * j) % 7) - 3); };
+
+    math::Matrix<ElementType, layout1> AA(m + 2, k + 1);
+    math::Matrix<ElementType, layout2> BB(k + 1, n + 2);
+    math::Matrix<ElementType, layout3> CC(m + 1, n + 1);
+    for (size_t i = 0; i < AA.NumRows(); ++i)
+    {
+        for (size_t j = 0; j < AA.NumColumns(); ++j)
+        {
+            AA(i, j) = value(i, j);
+        }
+    }
+    for (size_t i = 0; i < BB.NumRows(); ++i)
+    {
+        for (size_t j = 0; j < BB.NumColumns(); ++j)
+        {
+            BB(i, j) = value(j, i);
+        }
+    }
+    CC.Fill(1);
+    auto A = AA.GetSubMatrix(1, 1, m, k);
+    auto B = BB.GetSubMatrix(1, 1, k, n);
+    auto C = CC.GetSubMatrix(1, 0, m, n);
+    math::MultiplyScaleAddUpdate<implementation>(static_cast<ElementType>(2), A, B, static_cast<ElementType>(-1), C);
+
+    bool ok = true;
+    for (size_t i = 0; i < m; ++i)
+    {
+        for (size_t j = 0; j < n; ++j)
+        {
+            ElementType expected = -1;
+            for (size_t p = 0; p < k; ++p)
+            {
+                expected += 2 * A(i, p) * B(p, j);
+            }
+            ok = ok && C(i, j) == expected;
+        }
+    }
+    ok = ok && CC(0, 0) == 1 && CC(m, n) == 1;
+
+    // matrix-vector, with more rows than a block of the column-major implementation
+    auto AT = AA.Transpose().GetSubMatrix(0, 0, k + 1, m);
+    math::ColumnVector<ElementType> x(m);
+    for (size_t i = 0; i < m; ++i)
+    {
+        x[i] = value(i, 1);
+    }
+    math::ColumnVector<ElementType> y(k + 1);
+    y.Fill(std::numeric_limits<ElementType>::quiet_NaN());
+    math::MultiplyScaleAddUpdate<implementation>(static_cast<ElementType>(1), AT, x, static_cast<ElementType>(0), y);
+    for (size_t i = 0; i < k + 1; ++i)
+    {
+        ElementType expected = 0;
+        for (size_t j = 0; j < m; ++j)
+        {
+            expected += AT(i, j) * x[j];
+        }
+        ok = ok && y[i] == expected;
+    }
+
+    testing::ProcessTest(implementationName + "::MultiplyScaleAddUpdate(scalar, Matrix, Matrix, scalar, Matrix) with large matrices", ok);
+}
+
 template <typename ElementType, math::MatrixLayout layout>
 void TestMatrixElementwiseMultiplySet()
 {
@@ -1639,4 +1717,26 @@ void TestMatrixArchiver()
     testing::ProcessTest("MatrixArchiver", Ma == M);
 }
 
+inline void TestBlasThreadingPolicy()
+{
+    math::Blas::ThreadingPolicy policy;
+    policy.maxThreads = 4;
+    policy.minOperationsPerThread = 1000;
+
+    bool ok = math::Blas::GetNumThreads(policy, 10) == 1;
+    ok = ok && math::Blas::GetNumThreads(policy, 1999) == 1;
+    ok = ok && math::Blas::GetNumThreads(policy, 2000) == 2;
+    ok = ok && math::Blas::GetNumThreads(policy, 1000000) == 4;
+
+    policy.maxThreads = 0;
+    ok = ok && math::Blas::GetNumThreads(policy, 1000000) >= 1;
+
+    auto oldPolicy = math::Blas::GetThreadingPolicy();
+    math::Blas::SetThreadingPolicy(policy);
+    ok = ok && math::Blas::GetThreadingPolicy().minOperationsPerThread == 1000;
+    math::Blas::SetThreadingPolicy(oldPolicy);
+
+    testing::ProcessTest("BlasThreadingPolicy", ok);
+}
+
 #pragma endregion implementation
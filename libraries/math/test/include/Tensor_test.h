@@ -884,6 +884,12 @@ void TestTensorVectorScaleAddUpdate()
     TR.Fill(1);
     math::ScaleAddUpdate<math::Dimension::channel, implementation>(s3, b3, TR);
     testing::ProcessTest("void TestTensorVectoScaleAddUpdate() with subtensor", TR == R3);
+
+    // strided vectors
+    auto M = math::RowMatrix<ElementType>{ { 1, 1 }, { 2, 1 }, { 3, 2 }, { 4, 2 } };
+    TR.Fill(1);
+    math::ScaleAddUpdate<math::Dimension::channel, implementation>(M.GetColumn(0), M.GetColumn(1), TR);
+    testing::ProcessTest("void TestTensorVectorScaleAddUpdate() with strided vectors", TR == R3);
 }
 
 template <typename ElementType, math::Dimension dimension0, math::Dimension dimension1, math::Dimension dimension2>
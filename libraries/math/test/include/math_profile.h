@@ -7,85 +7,70 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 #pragma once
 
-#include <testing/include/testing.h>
+#include <testing/include/Benchmark.h>
 
 #include <math/include/Matrix.h>
+#include <math/include/Tensor.h>
 
 using namespace ell;
 
 #include <string>
 
 template <typename ElementType>
-void ProfileVectorScaleAdd(size_t size, size_t repetitions, std::string seed = "123ABC");
+void ProfileVectorScaleAdd(testing::BenchmarkSuite& suite, size_t size, std::string seed = "123ABC");
 
 template <typename ElementType>
-void ProfileVectorInner(size_t size, size_t repetitions, std::string seed = "123ABC");
+void ProfileVectorInner(testing::BenchmarkSuite& suite, size_t size, std::string seed = "123ABC");
 
 template <typename ElementType, math::MatrixLayout layout>
-void ProfileVectorOuter(size_t size, size_t repetitions, std::string seed = "123ABC");
+void ProfileVectorOuter(testing::BenchmarkSuite& suite, size_t size, std::string seed = "123ABC");
 
 template <typename ElementType, math::MatrixLayout layout>
-void ProfileMatrixVectorMultiplyScaleAddUpdate(size_t numRows, size_t numColumns, size_t repetitions, std::string seed = "123ABC");
+void ProfileMatrixVectorMultiplyScaleAddUpdate(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, std::string seed = "123ABC");
 
 template <typename ElementType, math::MatrixLayout layout1, math::MatrixLayout layout2>
-void ProfileMatrixMatrixMultiplyScaleAddUpdate(size_t numRows, size_t numColumns, size_t numColumns2, size_t repetitions, std::string seed = "123ABC");
+void ProfileMatrixMatrixMultiplyScaleAddUpdate(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numColumns2, std::string seed = "123ABC");
+
+template <typename ElementType>
+void ProfileTensorScaleAddUpdate(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numChannels, std::string seed = "123ABC");
 
 #pragma region implementation
 
+#include <math/include/BlasWrapper.h>
 #include <math/include/MatrixOperations.h>
+#include <math/include/TensorOperations.h>
 #include <math/include/Vector.h>
 #include <math/include/VectorOperations.h>
 
 #include <utilities/include/RandomEngines.h>
 
-#include <chrono>
-#include <iostream>
 #include <random>
+#include <type_traits>
 
 using namespace ell;
 
-template <typename Function>
-double GetTime(Function function, size_t repetitions)
-{
-    // warm up
-    function();
-    function();
-    function();
-
-    // timed reps
-    auto start = std::chrono::high_resolution_clock::now();
-    for (size_t t = 0; t < repetitions; ++t)
-    {
-        function();
-    }
-    auto finish = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count();
-    return static_cast<double>(duration);
-}
-
-void PrintLine(std::string functionName, double native, double singleBlas, double multiBlas)
+template <typename ElementType>
+std::string GetProfileTypeName()
 {
-    std::cout << functionName
-              << "\tnative:1.0\tsingleBlas:" << singleBlas / native
-              << "\tmultiBlas:" << multiBlas / native
-              << std::endl;
+    return std::is_same_v<ElementType, float> ? "float" : "double";
 }
 
-template <typename ElementType, typename VectorAType, math::VectorOrientation orientation>
-void ProfileVectorScaleAddWorker(ElementType scalarA, VectorAType vectorA, ElementType scalarB, math::VectorReference<ElementType, orientation> vectorB, std::string description, size_t repetitions)
+// Runs a benchmark with the native implementation and, if ELL is built with BLAS, with single- and multi-threaded BLAS.
+// The function is called with an std::integral_constant of the implementation type.
+template <typename Function>
+void RunImplementations(testing::BenchmarkSuite& suite, const std::string& name, double flops, Function function)
 {
-    double native = GetTime([&]() { math::ScaleAddUpdate<math::ImplementationType::native>(scalarA, vectorA, scalarB, vectorB); }, repetitions);
-    math::Blas::SetNumThreads(0);
-    double multiBlas = GetTime([&]() { math::ScaleAddUpdate<math::ImplementationType::openBlas>(scalarA, vectorA, scalarB, vectorB); }, repetitions);
+    suite.Run(name + " native", flops, [&]() { function(std::integral_constant<math::ImplementationType, math::ImplementationType::native>{}); });
+#ifdef USE_BLAS
     math::Blas::SetNumThreads(1);
-    double singleBlas = GetTime([&]() { math::ScaleAddUpdate<math::ImplementationType::openBlas>(scalarA, vectorA, scalarB, vectorB); }, repetitions);
-
-    std::string type = std::string("<") + typeid(ElementType).name() + ">";
-    PrintLine("ScaleAddUpdate" + type + "(" + description + ", vector)", native, singleBlas, multiBlas);
+    suite.Run(name + " blas1", flops, [&]() { function(std::integral_constant<math::ImplementationType, math::ImplementationType::openBlas>{}); });
+    math::Blas::SetNumThreads(0);
+    suite.Run(name + " blasN", flops, [&]() { function(std::integral_constant<math::ImplementationType, math::ImplementationType::openBlas>{}); });
+#endif
 }
 
 template <typename ElementType>
-void ProfileVectorScaleAdd(size_t size, size_t repetitions, std::string seed)
+void ProfileVectorScaleAdd(testing::BenchmarkSuite& suite, size_t size, std::string seed)
 {
     auto engine = utilities::GetRandomEngine(seed);
     std::uniform_real_distribution<ElementType> uniform(-1, 1);
@@ -100,16 +85,14 @@ void ProfileVectorScaleAdd(size_t size, size_t repetitions, std::string seed)
     ElementType scalar = static_cast<ElementType>(-7.3);
     ElementType one = 1.0;
 
-    ProfileVectorScaleAddWorker(scalar, math::OnesVector(), one, u, "scalar, ones, one", repetitions);
-    ProfileVectorScaleAddWorker(one, v, one, u, "one, vector, one", repetitions);
-    ProfileVectorScaleAddWorker(scalar, v, one, u, "scalar, vector, one", repetitions);
-    ProfileVectorScaleAddWorker(scalar, math::OnesVector(), scalar, u, "scalar, ones, scalar", repetitions);
-    ProfileVectorScaleAddWorker(one, v, scalar, u, "one, vector, scalar", repetitions);
-    ProfileVectorScaleAddWorker(scalar, v, scalar, u, "scalar, vector, scalar", repetitions);
+    auto name = "ScaleAddUpdate<" + GetProfileTypeName<ElementType>() + ">[" + std::to_string(size) + "]";
+    RunImplementations(suite, name + "(scalar, ones, one)", static_cast<double>(size), [&](auto implementation) { math::ScaleAddUpdate<decltype(implementation)::value>(scalar, math::OnesVector(), one, u); });
+    RunImplementations(suite, name + "(one, vector, scalar)", 2.0 * size, [&](auto implementation) { math::ScaleAddUpdate<decltype(implementation)::value>(one, v, scalar, u); });
+    RunImplementations(suite, name + "(scalar, vector, scalar)", 3.0 * size, [&](auto implementation) { math::ScaleAddUpdate<decltype(implementation)::value>(scalar, v, scalar, u); });
 }
 
 template <typename ElementType>
-void ProfileVectorInner(size_t size, size_t repetitions, std::string seed)
+void ProfileVectorInner(testing::BenchmarkSuite& suite, size_t size, std::string seed)
 {
     auto engine = utilities::GetRandomEngine(seed);
     std::uniform_real_distribution<ElementType> uniform(-1, 1);
@@ -122,19 +105,12 @@ void ProfileVectorInner(size_t size, size_t repetitions, std::string seed)
     v.Generate(generator);
 
     ElementType result;
-    double native = GetTime([&]() { math::Internal::VectorOperations<math::ImplementationType::native>::InnerProduct(u, v, result); }, repetitions);
-    math::Blas::SetNumThreads(1);
-    double singleBlas = GetTime([&]() { math::Internal::VectorOperations<math::ImplementationType::openBlas>::InnerProduct(u, v, result); }, repetitions);
-    math::Blas::SetNumThreads(0);
-    double multiBlas = GetTime([&]() { math::Internal::VectorOperations<math::ImplementationType::openBlas>::InnerProduct(u, v, result); }, repetitions);
-
-    std::string type = std::string("<") + typeid(ElementType).name() + ">";
-    std::string vector = "Vector" + type + "[" + std::to_string(size) + "]";
-    PrintLine("Dot(" + vector + ", " + vector + ")", native, singleBlas, multiBlas);
+    auto name = "Dot<" + GetProfileTypeName<ElementType>() + ">[" + std::to_string(size) + "]";
+    RunImplementations(suite, name, 2.0 * size, [&](auto implementation) { math::Internal::VectorOperations<decltype(implementation)::value>::InnerProduct(u, v, result); });
 }
 
 template <typename ElementType, math::MatrixLayout layout>
-void ProfileVectorOuter(size_t size, size_t repetitions, std::string seed)
+void ProfileVectorOuter(testing::BenchmarkSuite& suite, size_t size, std::string seed)
 {
     auto engine = utilities::GetRandomEngine(seed);
     std::uniform_real_distribution<ElementType> uniform(-1, 1);
@@ -148,20 +124,12 @@ void ProfileVectorOuter(size_t size, size_t repetitions, std::string seed)
 
     math::Matrix<ElementType, layout> S(size, size);
 
-    double native = GetTime([&]() { math::Internal::VectorOperations<math::ImplementationType::native>::OuterProduct(u, v, S); }, repetitions);
-    math::Blas::SetNumThreads(1);
-    double singleBlas = GetTime([&]() { math::Internal::VectorOperations<math::ImplementationType::openBlas>::OuterProduct(u, v, S); }, repetitions);
-    math::Blas::SetNumThreads(0);
-    double multiBlas = GetTime([&]() { math::Internal::VectorOperations<math::ImplementationType::openBlas>::OuterProduct(u, v, S); }, repetitions);
-
-    std::string type = std::string("<") + typeid(ElementType).name() + ">";
-    std::string vector = "Vector" + type + "[" + std::to_string(size) + "]";
-    std::string functionName = "OuterProduct(" + vector + ", " + vector + ")";
-    PrintLine(functionName, native, singleBlas, multiBlas);
+    auto name = "OuterProduct<" + GetProfileTypeName<ElementType>() + ">[" + std::to_string(size) + "] " + (layout == math::MatrixLayout::rowMajor ? "row" : "column");
+    RunImplementations(suite, name, static_cast<double>(size) * size, [&](auto implementation) { math::Internal::VectorOperations<decltype(implementation)::value>::OuterProduct(u, v, S); });
 }
 
 template <typename ElementType, math::MatrixLayout layout>
-void ProfileMatrixVectorMultiplyScaleAddUpdate(size_t numRows, size_t numColumns, size_t repetitions, std::string seed)
+void ProfileMatrixVectorMultiplyScaleAddUpdate(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, std::string seed)
 {
     auto engine = utilities::GetRandomEngine(seed);
     std::uniform_real_distribution<ElementType> uniform(-1, 1);
@@ -179,22 +147,12 @@ void ProfileMatrixVectorMultiplyScaleAddUpdate(size_t numRows, size_t numColumns
     auto s = generator();
     auto t = generator();
 
-    double native = GetTime([&]() { math::Internal::MatrixOperations<math::ImplementationType::native>::MultiplyScaleAddUpdate(s, M, v, t, u); }, repetitions);
-    math::Blas::SetNumThreads(1);
-    double singleBlas = GetTime([&]() { math::Internal::MatrixOperations<math::ImplementationType::openBlas>::MultiplyScaleAddUpdate(s, M, v, t, u); }, repetitions);
-    math::Blas::SetNumThreads(0);
-    double multiBlas = GetTime([&]() { math::Internal::MatrixOperations<math::ImplementationType::openBlas>::MultiplyScaleAddUpdate(s, M, v, t, u); }, repetitions);
-
-    std::string type = std::string("<") + typeid(ElementType).name() + ">";
-    std::string vector1 = "Vector" + type + "[" + std::to_string(numColumns) + "]";
-    std::string vector2 = "Vector" + type + "[" + std::to_string(numRows) + "]";
-    std::string matrix = "Matrix" + type + "[" + std::to_string(numRows) + ", " + std::to_string(numColumns) + "]";
-    std::string functionName = "MultiplyScaleAddUpdate(scalar, " + matrix + ", " + vector1 + ", scalar, " + vector2 + ")";
-    PrintLine(functionName, native, singleBlas, multiBlas);
+    auto name = "Gemv<" + GetProfileTypeName<ElementType>() + ">[" + std::to_string(numRows) + "x" + std::to_string(numColumns) + "] " + (layout == math::MatrixLayout::rowMajor ? "row" : "column");
+    RunImplementations(suite, name, 2.0 * numRows * numColumns, [&](auto implementation) { math::Internal::MatrixOperations<decltype(implementation)::value>::MultiplyScaleAddUpdate(s, M, v, t, u); });
 }
 
 template <typename ElementType, math::MatrixLayout layout1, math::MatrixLayout layout2>
-void ProfileMatrixMatrixMultiplyScaleAddUpdate(size_t numRows, size_t numColumns, size_t numColumns2, size_t repetitions, std::string seed)
+void ProfileMatrixMatrixMultiplyScaleAddUpdate(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numColumns2, std::string seed)
 {
     auto engine = utilities::GetRandomEngine(seed);
     std::uniform_real_distribution<ElementType> uniform(-1, 1);
@@ -212,18 +170,29 @@ void ProfileMatrixMatrixMultiplyScaleAddUpdate(size_t numRows, size_t numColumns
     auto a = generator();
     auto b = generator();
 
-    double native = GetTime([&]() { math::Internal::MatrixOperations<math::ImplementationType::native>::MultiplyScaleAddUpdate(a, M, N, b, T); }, repetitions);
-    math::Blas::SetNumThreads(1);
-    double singleBlas = GetTime([&]() { math::Internal::MatrixOperations<math::ImplementationType::openBlas>::MultiplyScaleAddUpdate(a, M, N, b, T); }, repetitions);
-    math::Blas::SetNumThreads(0);
-    double multiBlas = GetTime([&]() { math::Internal::MatrixOperations<math::ImplementationType::openBlas>::MultiplyScaleAddUpdate(a, M, N, b, T); }, repetitions);
-
-    std::string type = std::string("<") + typeid(ElementType).name() + ">";
-    std::string matrix1 = "Matrix" + type + "[" + std::to_string(numRows) + ", " + std::to_string(numColumns) + "]";
-    std::string matrix2 = "Matrix" + type + "[" + std::to_string(numColumns) + ", " + std::to_string(numColumns2) + "]";
-    std::string matrix3 = "Matrix" + type + "[" + std::to_string(numRows) + ", " + std::to_string(numColumns2) + "]";
-    std::string functionName = "MultiplyScaleAddUpdate(scalar, " + matrix1 + ", " + matrix2 + ", scalar, " + matrix3 + ")";
-    PrintLine(functionName, native, singleBlas, multiBlas);
+    auto layoutName = [](math::MatrixLayout layout) { return layout == math::MatrixLayout::rowMajor ? "row" : "column"; };
+    auto name = "Gemm<" + GetProfileTypeName<ElementType>() + ">[" + std::to_string(numRows) + "x" + std::to_string(numColumns) + "x" + std::to_string(numColumns2) + "] " + layoutName(layout1) + "*" + layoutName(layout2);
+    RunImplementations(suite, name, 2.0 * numRows * numColumns * numColumns2, [&](auto implementation) { math::Internal::MatrixOperations<decltype(implementation)::value>::MultiplyScaleAddUpdate(a, M, N, b, T); });
+}
+
+template <typename ElementType>
+void ProfileTensorScaleAddUpdate(testing::BenchmarkSuite& suite, size_t numRows, size_t numColumns, size_t numChannels, std::string seed)
+{
+    auto engine = utilities::GetRandomEngine(seed);
+    std::uniform_real_distribution<ElementType> uniform(-1, 1);
+    auto generator = [&]() { return uniform(engine); };
+
+    math::ChannelColumnRowTensor<ElementType> T(numRows, numColumns, numChannels);
+    T.Generate(generator);
+
+    math::RowVector<ElementType> scale(numChannels);
+    scale.Generate(generator);
+
+    math::RowVector<ElementType> bias(numChannels);
+    bias.Generate(generator);
+
+    auto name = "TensorScaleAddUpdate<" + GetProfileTypeName<ElementType>() + ">[" + std::to_string(numRows) + "x" + std::to_string(numColumns) + "x" + std::to_string(numChannels) + "] channel";
+    RunImplementations(suite, name, 2.0 * numRows * numColumns * numChannels, [&](auto implementation) { math::ScaleAddUpdate<math::Dimension::channel, decltype(implementation)::value>(scale, bias, T); });
 }
 
 #pragma endregion implementation
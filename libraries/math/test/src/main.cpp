@@ -6,6 +6,7 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "Expressions_test.h"
 #include "Matrix_test.h"
 #include "Tensor_test.h"
 #include "Vector_test.h"
@@ -86,6 +87,7 @@ void RunOrientedVectorTests()
     TestVectorArchiver<ElementType, orientation>();
     TestVectorCumulativeSumUpdate<ElementType, orientation>();
     TestVectorConsecutiveDifferenceUpdate<ElementType, orientation>();
+    TestVectorExpression<ElementType, orientation>();
 
     RunOrientedVectorImplementationTests<ElementType, orientation, math::ImplementationType::native>();
     RunOrientedVectorImplementationTests<ElementType, orientation, math::ImplementationType::openBlas>();
@@ -119,6 +121,7 @@ void RunTripleLayoutMatrixImplementationTests()
     TestMatrixScaleAddSetOneMatrixScalar<ElementType, layout1, layout2, layout3, implementation>();
     TestMatrixScaleAddSetScalarMatrixScalar<ElementType, layout1, layout2, layout3, implementation>();
     TestMatrixMatrixMultiplyScaleAddUpdate<ElementType, layout1, layout2, layout3, implementation>();
+    TestLargeMatrixMatrixMultiplyScaleAddUpdate<ElementType, layout1, layout2, layout3, implementation>();
 }
 
 template <typename ElementType, math::MatrixLayout layout1, math::MatrixLayout layout2, math::ImplementationType implementation>
@@ -158,6 +161,7 @@ template <typename ElementType, math::MatrixLayout layout1, math::MatrixLayout l
 void RunDoubleLayoutMatrixTests()
 {
     TestMatrixCopyCtor<ElementType, layout1, layout2>();
+    TestMatrixExpression<ElementType, layout1, layout2>();
 }
 
 template <typename ElementType, math::MatrixLayout layout>
@@ -216,6 +220,9 @@ void RunMatrixTests()
     TestMatrixGetColumnIncrement<ElementType>();
     TestMatrixToArray<ElementType>();
     TestMatrixGetMajorVector<ElementType>();
+    TestMatrixBroadcastExpression<ElementType>();
+    TestExpressionSum<ElementType>();
+    TestExpressionShapeMismatch<ElementType>();
 
     RunLayoutMatrixTests<ElementType, math::MatrixLayout::columnMajor>();
     RunLayoutMatrixTests<ElementType, math::MatrixLayout::rowMajor>();
@@ -268,6 +275,7 @@ void RunTensorTests()
     TestTensorReferenceAsMatrixCopy<ElementType>();
     TestTensorNumSlices<ElementType>();
     TestTensorNumPrimarySlices<ElementType>();
+    TestTensorExpression<ElementType>();
 
     RunLayoutTensorTests<ElementType, math::Dimension::column, math::Dimension::row, math::Dimension::channel>();
     RunLayoutTensorTests<ElementType, math::Dimension::channel, math::Dimension::column, math::Dimension::row>();
@@ -280,6 +288,7 @@ int main()
 
     RunMatrixTests<float>();
     RunMatrixTests<double>();
+    TestBlasThreadingPolicy();
 
     RunTensorTests<float>();
     RunTensorTests<double>();
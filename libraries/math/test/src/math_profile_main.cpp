@@ -6,54 +6,55 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-#include "Matrix_test.h"
-#include "Tensor_test.h"
-#include "Vector_test.h"
 #include "math_profile.h"
 
+#include <testing/include/Benchmark.h>
+
 using namespace ell;
 
 template <typename ElementType>
-void RunProfile()
+void RunProfile(testing::BenchmarkSuite& suite)
 {
-    const size_t repetitions = 10;
-
-    ProfileVectorScaleAdd<ElementType>(100, 100 * repetitions);
-    ProfileVectorScaleAdd<ElementType>(10000, 100 * repetitions);
-    ProfileVectorScaleAdd<ElementType>(1000000, 100 * repetitions);
-
-    ProfileVectorInner<ElementType>(100, 100 * repetitions);
-    ProfileVectorInner<ElementType>(10000, 10 * repetitions);
-    ProfileVectorInner<ElementType>(1000000, repetitions);
+    for (size_t size : { 100, 10000, 1000000 })
+    {
+        ProfileVectorScaleAdd<ElementType>(suite, size);
+        ProfileVectorInner<ElementType>(suite, size);
+    }
 
     constexpr auto column = math::MatrixLayout::columnMajor;
     constexpr auto row = math::MatrixLayout::rowMajor;
 
-    ProfileVectorOuter<ElementType, row>(10, 100 * repetitions);
-    ProfileVectorOuter<ElementType, row>(100, 10 * repetitions);
-    ProfileVectorOuter<ElementType, row>(1000, repetitions);
-
-    ProfileVectorOuter<ElementType, column>(10, 100 * repetitions);
-    ProfileVectorOuter<ElementType, column>(100, 10 * repetitions);
-    ProfileVectorOuter<ElementType, column>(1000, repetitions);
-
-    ProfileMatrixVectorMultiplyScaleAddUpdate<ElementType, row>(10, 10, 100 * repetitions);
-    ProfileMatrixVectorMultiplyScaleAddUpdate<ElementType, row>(100, 100, 10 * repetitions);
-    ProfileMatrixVectorMultiplyScaleAddUpdate<ElementType, row>(1000, 1000, repetitions);
-
-    ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, row, row>(10, 10, 10, 100 * repetitions);
-    ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, row, row>(100, 100, 100, 10 * repetitions);
-    ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, row, row>(1000, 1000, 1000, repetitions);
-
-    ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, row, column>(10, 10, 10, 100 * repetitions);
-    ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, row, column>(100, 100, 100, 10 * repetitions);
-    ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, row, column>(1000, 1000, 1000, repetitions);
+    for (size_t size : { 10, 100, 1000 })
+    {
+        ProfileVectorOuter<ElementType, row>(suite, size);
+        ProfileVectorOuter<ElementType, column>(suite, size);
+    }
+
+    for (size_t size : { 16, 64, 256, 1024 })
+    {
+        ProfileMatrixVectorMultiplyScaleAddUpdate<ElementType, row>(suite, size, size);
+        ProfileMatrixVectorMultiplyScaleAddUpdate<ElementType, column>(suite, size, size);
+    }
+
+    for (size_t size : { 16, 64, 256, 512 })
+    {
+        ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, row, row>(suite, size, size, size);
+        ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, row, column>(suite, size, size, size);
+        ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, column, row>(suite, size, size, size);
+    }
+
+    // the shapes of the matrix multiplies of unrolled convolutions: (filters) x (filter size * channels) x (pixels)
+    ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, row, row>(suite, 32, 288, 1024);
+    ProfileMatrixMatrixMultiplyScaleAddUpdate<ElementType, row, row>(suite, 128, 1152, 196);
+
+    ProfileTensorScaleAddUpdate<ElementType>(suite, 32, 32, 16);
+    ProfileTensorScaleAddUpdate<ElementType>(suite, 128, 128, 32);
 }
 
-int main()
+int main(int argc, char** argv)
 {
-    RunProfile<float>();
-    RunProfile<double>();
-
-    return 0;
+    return testing::RunBenchmarkProgram(argc, argv, "math", [](testing::BenchmarkSuite& suite) {
+        RunProfile<float>(suite);
+        RunProfile<double>(suite);
+    });
 }
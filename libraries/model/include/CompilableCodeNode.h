@@ -54,6 +54,9 @@ namespace model
 
         void Compute() const final;
 
+        // Compute runs the function through the global value context
+        bool CanComputeConcurrently() const final { return false; }
+
         void SetFunctionParameters() const;
 
         std::string _name;
@@ -38,6 +38,27 @@ namespace model
         /// <summary> Indicates if this node is able to compile itself to code. </summary>
         bool IsCompilable(const MapCompiler* compiler) const override { return true; }
 
+        /// <summary>
+        /// Indicates if this node can compute only the first entries along the outermost dimension of its ports, when the
+        /// map is compiled with `dynamicInputExtent`. Nodes that return true get the number of entries to compute from
+        /// `IRMapCompiler::GetDynamicExtent`. Returns false by default.
+        /// </summary>
+        virtual bool SupportsDynamicExtent() const { return false; }
+
+        /// <summary>
+        /// Gets the entry of the node's output that an input's values are copied to, unchanged and contiguously, so the
+        /// compiler can have the node computing the input write them there directly (see `IRMapCompiler::IsPortAliasOf`).
+        /// Returns -1 by default, for inputs that aren't copied into the output.
+        /// </summary>
+        virtual int GetInPlaceInputOffset(const InputPortBase& input) const { return -1; }
+
+        /// <summary>
+        /// Gets the inputs the node only reads some of the time. The nodes that only such an input depends on are compiled
+        /// into a function of their own, which the node calls with `IRMapCompiler::CallConditionalBranch` in the code
+        /// path that reads the input, so the other paths skip them. Returns an empty list by default.
+        /// </summary>
+        virtual std::vector<const InputPortBase*> GetConditionalInputs() const { return {}; }
+
     protected:
         CompilableNode(const std::vector<InputPortBase*>& inputs, const std::vector<OutputPortBase*>& outputs) :
             Node(inputs, outputs) {}
@@ -79,6 +100,21 @@ namespace model
         // Subclasses can override this if there is some state that gets compiled into the node but is shared among different node instances.
         virtual std::string GetInternalStateIdentifier() const;
 
+        // Returns true if nodes of this type with the same content can share a node function when the map is compiled with
+        // `shareNodeFunctions`. Returns false by default. Subclasses can return true if everything their code reads that differs
+        // between instances comes in through the function's parameters, and the only globals they emit are constants named with
+        // `GetInternalStateIdentifier`.
+        virtual bool CanShareNodeFunction() const;
+
+        // Returns a key for the code of the node's function, used in place of the node's ID in `GetInternalStateIdentifier`
+        // when the node shares its function. Nodes that get the same key must emit the same function. The default implementation
+        // uses the node's content key (see `GetNodeContentKey`). Subclasses that pass some of their state to the function as
+        // parameters can override this to leave that state out of the key.
+        virtual std::string GetNodeFunctionKey(IRMapCompiler& compiler) const;
+
+        // Returns true while the node is compiled into a function it shares with other nodes with the same key.
+        bool IsSharingNodeFunction() const { return !_nodeFunctionKey.empty(); }
+
         // Returns a list of additional "state" parameters (beyond the input and output ports) that should be passed to the node's compute function.
         // The default implementation returns an empty list, as by default, node's don't have any extra state parameters.
         // Subclasses must override this if they want to pass external state into the function.
@@ -108,6 +144,7 @@ namespace model
     private:
         const std::string _nodeFunctionPrefix = "_Node__";
         const char _badIdentifierChars[3] = { '<', '>', ',' };
+        std::string _nodeFunctionKey;
     };
 } // namespace model
 } // namespace ell
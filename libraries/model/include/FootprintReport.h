@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FootprintReport.h (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace model
+{
+    /// <summary> The memory a node of a compiled model takes up. </summary>
+    struct NodeFootprint
+    {
+        std::string nodeId;
+        std::string nodeType;
+        std::string functionName; // the function the node is compiled into
+        std::vector<std::string> ownFunctions; // the functions emitted for the node, like its node function
+
+        size_t irInstructions = 0; // the IR instructions emitted for the node, before optimization
+        size_t codeBytes = 0; // the node's share of the machine code of the functions it's in
+        bool isCodeSizeExact = false; // the node's code is in functions of its own, so `codeBytes` isn't an estimate
+        size_t weightBytes = 0; // constant data, in the module or in the external weights
+        size_t bufferBytes = 0; // mutable data: output buffers and state, before memory planning
+        size_t plannedBufferBytes = 0; // the part of `bufferBytes` placed in the memory arena
+        size_t stackBytes = 0; // local variables of the node's code, before optimization
+    };
+
+    /// <summary>
+    /// A breakdown of the memory a compiled model needs, by node: code (flash), weights (flash, or wherever the
+    /// external weights are loaded), and buffers and stack (RAM). The IR compiler collects it when the `footprintReport`
+    /// option is set.
+    ///
+    /// Code sizes come from the symbols of the object code the module compiles to. Optimization inlines most node
+    /// functions into the predict function, so a function's code is shared by the nodes in it in proportion to the
+    /// IR instructions they emitted, and only the nodes with functions of their own get an exact size. The stack sizes
+    /// are the local variables each node allocates, which is an upper bound, since optimization promotes most of them
+    /// to registers and lets others share a stack slot.
+    /// </summary>
+    class FootprintReport
+    {
+    public:
+        /// <summary> Adds a node to the report. </summary>
+        void AddNode(NodeFootprint node) { _nodes.push_back(std::move(node)); }
+
+        /// <summary> Records a memory arena the planned buffers of a function are placed in. </summary>
+        ///
+        /// <param name="size"> The size of the arena, in bytes. </param>
+        void AddMemoryArena(size_t size) { _arenaBytes += size; }
+
+        /// <summary> Records the size of the external weights. </summary>
+        void SetExternalWeightBytes(size_t size) { _externalWeightBytes = size; }
+
+        /// <summary> Shares the machine code of each function among the nodes in it. </summary>
+        ///
+        /// <param name="functionCodeBytes"> The size of the machine code of each function of the module, by name. </param>
+        void SetCodeSizes(const std::map<std::string, size_t>& functionCodeBytes);
+
+        /// <summary> Gets the nodes, in the order they were compiled. </summary>
+        const std::vector<NodeFootprint>& GetNodes() const { return _nodes; }
+
+        /// <summary> Gets the size of the machine code of the whole module, including functions that aren't part of a node. </summary>
+        size_t GetCodeBytes() const { return _codeBytes; }
+
+        /// <summary> Gets the size of the weights of all the nodes. </summary>
+        size_t GetWeightBytes() const;
+
+        /// <summary> Gets the size of the weights that are in the external weights instead of the module. </summary>
+        size_t GetExternalWeightBytes() const { return _externalWeightBytes; }
+
+        /// <summary> Gets the size of the buffers of all the nodes, if each one had memory of its own. </summary>
+        size_t GetBufferBytes() const;
+
+        /// <summary> Gets the size of the buffers of all the nodes after memory planning: the arenas, and the buffers not placed in one. </summary>
+        size_t GetPlannedBufferBytes() const;
+
+        /// <summary> Gets the size of the local variables of all the nodes. </summary>
+        size_t GetStackBytes() const;
+
+        /// <summary> Writes the report as JSON. </summary>
+        void WriteJson(std::ostream& stream) const;
+
+        /// <summary> Gets a summary of the report, as lines of text: the totals, then one line per node. </summary>
+        std::vector<std::string> GetSummaryLines() const;
+
+    private:
+        std::vector<NodeFootprint> _nodes;
+        size_t _codeBytes = 0;
+        size_t _arenaBytes = 0;
+        size_t _externalWeightBytes = 0;
+    };
+} // namespace model
+} // namespace ell
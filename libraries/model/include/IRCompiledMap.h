@@ -9,9 +9,12 @@
 #pragma once
 
 #include "CompiledMap.h"
+#include "FootprintReport.h"
+#include "IRCompiledMapCache.h"
 #include "IRModelProfiler.h"
 #include "InputNode.h"
 #include "Map.h"
+#include "ModelOptimizerOptions.h"
 #include "Node.h"
 #include "OutputPort.h"
 #include "PortElements.h"
@@ -23,7 +26,9 @@
 #include <utilities/include/Boolean.h>
 #include <utilities/include/TypeName.h>
 
+#include <atomic>
 #include <functional>
+#include <future>
 #include <memory>
 #include <ostream>
 #include <string>
@@ -34,6 +39,13 @@ namespace ell
 {
 namespace model
 {
+    /// <summary> The values of the constants a model compiled with the `externalWeights` option reads at run time. </summary>
+    struct ExternalWeights
+    {
+        std::vector<uint8_t> data;
+        std::vector<std::pair<size_t, size_t>> blocks; // the offset and size in bytes of each constant's values, in `data`
+    };
+
     /// <summary> A map that can be compiled </summary>
     class IRCompiledMap : public CompiledMap
     {
@@ -44,9 +56,48 @@ namespace model
         IRCompiledMap(IRCompiledMap&& other);
         IRCompiledMap& operator=(const IRCompiledMap&) = delete;
 
-        /// <summary> Clone the compiled model </summary>
+        /// <summary> Clone the compiled model. The clone of a reentrant model shares its jitted code and gets its own
+        /// state, so clones can run on several threads at once without compiling the model again. </summary>
         IRCompiledMap Clone();
 
+        /// <summary> Indicates if the model was compiled with the `reentrant` option, so that its clones can run on several threads at once. </summary>
+        bool IsReentrant() const { return GetMapCompilerOptions().reentrant; }
+
+        /// <summary> Indicates if the model was compiled with the `externalWeights` option, so its weights are in a file of their own (see `WriteExternalWeights`). </summary>
+        bool HasExternalWeights() const { return GetMapCompilerOptions().externalWeights; }
+
+        /// <summary> Writes the weights of a model compiled with the `externalWeights` option, for the compiled code to load with `<moduleName>_LoadWeights` (or `<moduleName>_SetWeights`). </summary>
+        ///
+        /// <param name="filePath"> The file to write to. </param>
+        void WriteExternalWeights(const std::string& filePath) const;
+
+        /// <summary>
+        /// Replaces the weights of a model compiled with the `externalWeights` option with the ones of another map
+        /// with the same structure, e.g. the result of retraining this one, without compiling any code. The map is
+        /// refined and emitted the same way to find its weights, and they're copied over the current ones, so the
+        /// jitted code and all the clones of this map read them from the next call on. Don't call this while the
+        /// model (or a clone) is computing.
+        /// </summary>
+        ///
+        /// <param name="map"> The map with the new weights. Its refined form must have the same constants, of the same sizes, as this model. </param>
+        void UpdateWeights(const Map& map);
+
+        /// <summary> Replaces the weights of a model compiled with the `externalWeights` option with the contents of a weights file (see `WriteExternalWeights`), in place. </summary>
+        ///
+        /// <param name="filePath"> The weights file, written for a model with the same structure. </param>
+        void UpdateWeights(const std::string& filePath);
+
+        /// <summary> Indicates if the model was compiled with the `footprintReport` option, so it has a report of the memory each node takes up. </summary>
+        bool HasFootprintReport() const { return _footprintReport != nullptr; }
+
+        /// <summary> Gets the report of the memory each node takes up, for a model compiled with the `footprintReport` option. </summary>
+        const FootprintReport& GetFootprintReport() const;
+
+        /// <summary> Writes the report of the memory each node takes up as JSON, for a model compiled with the `footprintReport` option. </summary>
+        ///
+        /// <param name="filePath"> The file to write to. </param>
+        void WriteFootprintReport(const std::string& filePath) const;
+
         /// <summary> Output the compiled model to the given file </summary>
         ///
         /// <param name="filePath"> The file to write to </param>
@@ -151,6 +202,25 @@ namespace model
         /// <param name="nodeIndex"> the index of the node type. </param>
         PerformanceCounters* GetNodeTypePerformanceCounters(int nodeIndex);
 
+        /// <summary> Get the latency percentiles of the model, computed from its latency histogram. All zero unless the map was compiled with the `profileLatencyHistograms` option. </summary>
+        LatencyStatistics* GetModelLatencyStatistics();
+
+        /// <summary> Get the latency percentiles of a node, computed from its latency histogram. </summary>
+        ///
+        /// <param name="nodeIndex"> the index of the node. </param>
+        LatencyStatistics* GetNodeLatencyStatistics(int nodeIndex);
+
+        /// <summary> Get the latency percentiles of a node type, computed from its latency histogram. </summary>
+        ///
+        /// <param name="nodeIndex"> the index of the node type. </param>
+        LatencyStatistics* GetNodeTypeLatencyStatistics(int nodeIndex);
+
+        /// <summary> Print the latency percentiles of the model. </summary>
+        void PrintModelLatencyInfo();
+
+        /// <summary> Print the latency percentiles of the nodes. </summary>
+        void PrintNodeLatencyInfo();
+
         /// <summary> Get a pointer to the named global array. </summary>
         ///
         /// <param name="name"> name of the global. </param>
@@ -178,6 +248,19 @@ namespace model
         /// <summary> Reset the performance summary for the model to zero. </summary>
         void ResetRegionProfilingInfo();
 
+        //
+        // Timeline tracing support (only available if the map was compiled with the `traceExecution` option)
+        //
+
+        /// <summary> Write the recorded timeline of node, region and task events to a file, in the Chrome trace event format. </summary>
+        ///
+        /// <param name="filename"> The file to write. </param>
+        /// <returns> true if the file was written, false if it couldn't be opened. </returns>
+        bool WriteProfileTrace(const std::string& filename);
+
+        /// <summary> Discard the recorded timeline events. </summary>
+        void ResetProfileTrace();
+
         //
         // Just-in-time compilation functions
         //
@@ -185,12 +268,78 @@ namespace model
         /// <summary> Force jitting to finish so you can time execution without jit cost. </summary>
         void FinishJitting();
 
+        /// <summary> Is the map running optimized code? With tiered compilation, this is false until the optimized
+        /// code compiled in the background is ready. </summary>
+        bool IsRunningOptimizedCode() const;
+
+        /// <summary> Waits for the optimized code of a map compiled with tiered compilation, so you can time execution
+        /// without the unoptimized tier. Rethrows any error from the background compile. </summary>
+        void WaitForOptimizedCode();
+
+        /// <summary> Runs the compiled predict function directly on caller-owned memory, without copying the input or output </summary>
+        ///
+        /// <param name="input"> The input, which must hold as many elements as the map's input. </param>
+        /// <param name="output"> The output, which must have room for as many elements as the map's output. </param>
+        template <typename InputType, typename OutputType>
+        void Predict(const InputType* input, OutputType* output);
+
+        /// <summary> Runs the compiled model on a batch of contiguous samples. Calls the batch predict function if the
+        /// map was compiled with `emitBatchPredictFunction`, or else the predict function once per sample. Either way
+        /// the samples run one after another on the calling thread. </summary>
+        ///
+        /// <param name="input"> The inputs, which must hold `batchSize` times as many elements as the map's input. </param>
+        /// <param name="output"> The outputs, which must have room for `batchSize` times as many elements as the map's output. </param>
+        /// <param name="batchSize"> The number of samples. </param>
+        template <typename InputType, typename OutputType>
+        void PredictBatch(const InputType* input, OutputType* output, int batchSize);
+
+        /// <summary> Runs the compiled model on an input whose outermost dimension holds only `extent` entries, by calling
+        /// the dynamic predict function of a map compiled with `dynamicInputExtent`. Only the first `extent` entries along
+        /// the outermost dimension of the output are written. </summary>
+        ///
+        /// <param name="input"> The input, which must hold at least the first `extent` entries of the map's input. </param>
+        /// <param name="output"> The output, which must have room for as many elements as the map's output. </param>
+        /// <param name="extent"> The number of entries along the input's outermost dimension, up to its size in the map. </param>
+        template <typename InputType, typename OutputType>
+        void PredictDynamic(const InputType* input, OutputType* output, int extent);
+
         /// <summary> Set a context object to use in the predict call </summary>
         void SetContext(void* context) { _context = context; }
 
         /// <summary> Get the context object to use in the predict call </summary>
         void* GetContext() const { return _context; }
 
+        /// <summary> Pins the workers of this compiled map's thread pool to the given cores, worker i to core
+        /// `cores[i % cores.size()]`. Each compiled map has its own thread pool, so maps sharing a host can be given
+        /// different cores. </summary>
+        ///
+        /// <param name="cores"> The cores to run the workers on. </param>
+        ///
+        /// <returns> 0 on success, or a nonzero error code (-1 if the map doesn't use a thread pool, or the target doesn't
+        /// support thread affinity). </returns>
+        int SetThreadPoolAffinity(const std::vector<int>& cores);
+
+        /// <summary> Gets the cores this compiled map's thread pool workers were last pinned to (initially the
+        /// `threadAffinity` compiler option). </summary>
+        const std::vector<int>& GetThreadPoolAffinity() const { return _threadAffinity; }
+
+        //
+        // Model state
+        //
+
+        /// <summary> Resets the state of the compiled model (e.g., the hidden state of recurrent nodes) by calling its reset function </summary>
+        void Reset() override;
+
+        /// <summary> Returns a copy of the state of a reentrant model, to restore later with SetState </summary>
+        ///
+        /// <returns> The bytes of the state passed to the predict function. </returns>
+        std::vector<uint8_t> GetState();
+
+        /// <summary> Restores the state of a reentrant model to one returned by GetState </summary>
+        ///
+        /// <param name="state"> The state to restore. </param>
+        void SetState(const std::vector<uint8_t>& state);
+
     protected:
         void WriteCode(const std::string& filePath, emitters::ModuleOutputFormat format, emitters::MachineCodeOutputOptions options) const;
         void WriteCode(std::ostream& stream, emitters::ModuleOutputFormat format, emitters::MachineCodeOutputOptions options) const;
@@ -210,27 +359,78 @@ namespace model
     private:
         friend class IRMapCompiler;
 
-        IRCompiledMap(Map map, const std::string& functionName, const MapCompilerOptions& options, emitters::IRModuleEmitter& module, bool verifyJittedModule);
+        IRCompiledMap(Map map, const std::string& functionName, const MapCompilerOptions& options, emitters::IRModuleEmitter& module, bool verifyJittedModule, bool tieredCompilation = false);
+        IRCompiledMap(Map map, const std::string& functionName, const MapCompilerOptions& options, emitters::IRModuleEmitter& module, std::shared_ptr<const CachedMachineCode> cachedCode, bool verifyJittedModule);
 
         void EnsureExecutionEngine();
+        void StartOptimizedCompile();
+        uint64_t GetPredictFunctionAddress() const;
+        uint64_t GetBatchPredictFunctionAddress() const;
+        uint64_t GetDynamicPredictFunctionAddress() const;
+        void EnsureModuleAvailable() const;
         void SetComputeFunction();
         template <typename InputType>
         void SetComputeFunctionForInputType();
+        template <typename InputType, typename OutputType>
+        void SetComputeFunctionForTypes(uint64_t functionPointer);
+        void InitializeState();
+        void SetExternalWeights(const ExternalWeights& weights, const ModelOptimizerOptions& optimizerOptions);
+        void CopyExternalWeights(const std::vector<uint8_t>& weights);
+        void SetFootprintReport(FootprintReport report) { _footprintReport = std::make_shared<const FootprintReport>(std::move(report)); }
 
         template <typename InputType>
         using ComputeFunction = std::function<void(void*, const InputType*)>;
 
         emitters::IRModuleEmitter& _module;
         std::string _moduleName;
+        std::shared_ptr<const CachedMachineCode> _cachedCode; // if set, the JIT runs this code instead of compiling `_module`
 
-        std::unique_ptr<emitters::IRExecutionEngine> _executionEngine;
+        std::shared_ptr<emitters::IRExecutionEngine> _executionEngine; // shared by the clones of a reentrant model
         bool _verifyJittedModule = true;
+
+        // Tiered compilation: `_executionEngine` runs unoptimized code until the background compile publishes the
+        // address of the optimized predict function
+        struct OptimizedCode
+        {
+            std::unique_ptr<llvm::LLVMContext> context;
+            std::unique_ptr<emitters::IRExecutionEngine> executionEngine;
+            uint64_t batchPredictFunction = 0; // published along with `predictFunction`
+            uint64_t dynamicPredictFunction = 0; // published along with `predictFunction`
+            std::atomic<uint64_t> predictFunction = 0;
+        };
+        bool _tieredCompilation = false;
+        std::shared_ptr<OptimizedCode> _optimizedCode;
+        std::future<void> _optimizedCompile;
+
         void* _context = nullptr;
+        std::vector<int> _threadAffinity; // the cores this map's thread pool workers are pinned to
+
+        // The weights the jitted code reads, for a model compiled with the `externalWeights` option (shared by clones,
+        // and updated in place), where each constant's values are, and the options to refine a map with new weights
+        struct alignas(64) WeightsBlock
+        {
+            uint8_t bytes[64];
+        };
+        std::shared_ptr<std::vector<WeightsBlock>> _externalWeights;
+        std::shared_ptr<const std::vector<std::pair<size_t, size_t>>> _externalWeightsLayout;
+        ModelOptimizerOptions _optimizerOptions;
+
+        // The state passed to the predict function of a reentrant model
+        struct alignas(16) StateBlock
+        {
+            uint8_t bytes[16];
+        };
+        std::vector<StateBlock> _state;
+
+        std::shared_ptr<const FootprintReport> _footprintReport;
 
         template <typename T>
         using Vector = std::vector<std::conditional_t<std::is_same_v<bool, T>, Boolean, T>>;
 
         bool _computeFunctionDefined = false;
+        uint64_t _predictFunction = 0;
+        uint64_t _batchPredictFunction = 0;
+        uint64_t _dynamicPredictFunction = 0;
         std::variant<ComputeFunction<bool>, ComputeFunction<int>, ComputeFunction<int64_t>, ComputeFunction<float>, ComputeFunction<double>> _computeInputFunction;
         std::variant<Vector<bool>, Vector<int>, Vector<int64_t>, Vector<float>, Vector<double>> _cachedOutput;
     };
@@ -249,66 +449,134 @@ namespace model
         if (!_computeFunctionDefined)
         {
             _computeFunctionDefined = true;
-            auto outputSize = GetOutput(0).Size();
             auto functionPointer = _executionEngine->ResolveFunctionAddress(_functionName);
-            ComputeFunction<InputType> computeFunction;
             switch (GetOutput(0).GetType()) // Switch on output type
             {
             case model::Port::PortType::boolean:
-            {
-                _cachedOutput = Vector<bool>(outputSize);
-                auto fn = reinterpret_cast<void (*)(void*, const InputType*, bool*)>(functionPointer);
-                computeFunction = [this, fn](void* context, const InputType* input) {
-                    fn(context, input, (bool*)std::get<Vector<bool>>(_cachedOutput).data());
-                };
-            }
-            break;
-
+                SetComputeFunctionForTypes<InputType, bool>(functionPointer);
+                break;
             case model::Port::PortType::integer:
-            {
-                _cachedOutput = Vector<int>(outputSize);
-                auto fn = reinterpret_cast<void (*)(void*, const InputType*, int*)>(functionPointer);
-                computeFunction = [this, fn](void* context, const InputType* input) {
-                    fn(context, input, std::get<Vector<int>>(_cachedOutput).data());
-                };
-            }
-            break;
-
+                SetComputeFunctionForTypes<InputType, int>(functionPointer);
+                break;
             case model::Port::PortType::bigInt:
-            {
-                _cachedOutput = Vector<int64_t>(outputSize);
-                auto fn = reinterpret_cast<void (*)(void*, const InputType*, int64_t*)>(functionPointer);
-                computeFunction = [this, fn](void* context, const InputType* input) {
-                    fn(context, input, std::get<Vector<int64_t>>(_cachedOutput).data());
-                };
+                SetComputeFunctionForTypes<InputType, int64_t>(functionPointer);
+                break;
+            case model::Port::PortType::smallReal:
+                SetComputeFunctionForTypes<InputType, float>(functionPointer);
+                break;
+            case model::Port::PortType::real:
+                SetComputeFunctionForTypes<InputType, double>(functionPointer);
+                break;
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
             }
-            break;
+        }
+    }
 
-            case model::Port::PortType::smallReal:
+    template <typename InputType, typename OutputType>
+    void IRCompiledMap::SetComputeFunctionForTypes(uint64_t functionPointer)
+    {
+        _predictFunction = functionPointer;
+        if (GetMapCompilerOptions().emitBatchPredictFunction)
+        {
+            _batchPredictFunction = _executionEngine->ResolveFunctionAddress(GetFunctionName() + "_batch");
+        }
+        if (GetMapCompilerOptions().dynamicInputExtent)
+        {
+            _dynamicPredictFunction = _executionEngine->ResolveFunctionAddress(GetFunctionName() + "_dynamic");
+        }
+        _cachedOutput = Vector<OutputType>(GetOutput(0).Size());
+        if (GetMapCompilerOptions().reentrant)
+        {
+            // A map that was moved from keeps the state it had, though its compute function is set again
+            if (_state.empty())
             {
-                _cachedOutput = Vector<float>(outputSize);
-                auto fn = reinterpret_cast<void (*)(void*, const InputType*, float*)>(functionPointer);
-                computeFunction = [this, fn](void* context, const InputType* input) {
-                    fn(context, input, std::get<Vector<float>>(_cachedOutput).data());
-                };
+                InitializeState();
             }
-            break;
+            _computeInputFunction = ComputeFunction<InputType>([this](void* context, const InputType* input) {
+                auto predict = reinterpret_cast<void (*)(void*, void*, const InputType*, OutputType*)>(GetPredictFunctionAddress());
+                predict(context, _state.data(), input, (OutputType*)std::get<Vector<OutputType>>(_cachedOutput).data());
+            });
+        }
+        else
+        {
+            auto fn = reinterpret_cast<void (*)(void*, const InputType*, OutputType*)>(functionPointer);
+            _computeInputFunction = ComputeFunction<InputType>([this, fn](void* context, const InputType* input) {
+                fn(context, input, (OutputType*)std::get<Vector<OutputType>>(_cachedOutput).data());
+            });
+        }
+    }
 
-            case model::Port::PortType::real:
+    template <typename InputType, typename OutputType>
+    void IRCompiledMap::Predict(const InputType* input, OutputType* output)
+    {
+        FinishJitting();
+        if (GetInput(0)->GetOutputPort().GetType() != Port::GetPortType<InputType>() || GetOutput(0).GetType() != Port::GetPortType<OutputType>())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
+        }
+
+        if (GetMapCompilerOptions().reentrant)
+        {
+            reinterpret_cast<void (*)(void*, void*, const InputType*, OutputType*)>(GetPredictFunctionAddress())(GetContext(), _state.data(), input, output);
+        }
+        else
+        {
+            reinterpret_cast<void (*)(void*, const InputType*, OutputType*)>(GetPredictFunctionAddress())(GetContext(), input, output);
+        }
+    }
+
+    template <typename InputType, typename OutputType>
+    void IRCompiledMap::PredictBatch(const InputType* input, OutputType* output, int batchSize)
+    {
+        FinishJitting();
+        if (GetInput(0)->GetOutputPort().GetType() != Port::GetPortType<InputType>() || GetOutput(0).GetType() != Port::GetPortType<OutputType>())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
+        }
+
+        auto batchPredict = GetBatchPredictFunctionAddress();
+        if (batchPredict == 0)
+        {
+            const auto inputSize = GetInputSize();
+            const auto outputSize = GetOutputSize();
+            for (int index = 0; index < batchSize; ++index)
             {
-                _cachedOutput = Vector<double>(outputSize);
-                auto fn = reinterpret_cast<void (*)(void*, const InputType*, double*)>(functionPointer);
-                computeFunction = [this, fn](void* context, const InputType* input) {
-                    fn(context, input, std::get<Vector<double>>(_cachedOutput).data());
-                };
+                Predict(input + index * inputSize, output + index * outputSize);
             }
-            break;
+        }
+        else if (GetMapCompilerOptions().reentrant)
+        {
+            reinterpret_cast<void (*)(void*, void*, const InputType*, OutputType*, int)>(batchPredict)(GetContext(), _state.data(), input, output, batchSize);
+        }
+        else
+        {
+            reinterpret_cast<void (*)(void*, const InputType*, OutputType*, int)>(batchPredict)(GetContext(), input, output, batchSize);
+        }
+    }
 
-            default:
-                throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
-            }
+    template <typename InputType, typename OutputType>
+    void IRCompiledMap::PredictDynamic(const InputType* input, OutputType* output, int extent)
+    {
+        FinishJitting();
+        if (GetInput(0)->GetOutputPort().GetType() != Port::GetPortType<InputType>() || GetOutput(0).GetType() != Port::GetPortType<OutputType>())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
+        }
+
+        auto dynamicPredict = GetDynamicPredictFunctionAddress();
+        if (dynamicPredict == 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "PredictDynamic needs a map compiled with dynamicInputExtent");
+        }
 
-            _computeInputFunction = computeFunction;
+        if (GetMapCompilerOptions().reentrant)
+        {
+            reinterpret_cast<void (*)(void*, void*, const InputType*, OutputType*, int)>(dynamicPredict)(GetContext(), _state.data(), input, output, extent);
+        }
+        else
+        {
+            reinterpret_cast<void (*)(void*, const InputType*, OutputType*, int)>(dynamicPredict)(GetContext(), input, output, extent);
         }
     }
 
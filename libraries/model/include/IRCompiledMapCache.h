@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRCompiledMapCache.h (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MapCompilerOptions.h"
+#include "ModelOptimizerOptions.h"
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace emitters
+{
+    class IRModuleEmitter;
+} // namespace emitters
+
+namespace model
+{
+    class Map;
+
+    /// <summary> Native code for a compiled map, as stored in the on-disk JIT cache. </summary>
+    struct CachedMachineCode
+    {
+        /// <summary> The contents of an object file compiled for the host. </summary>
+        std::string objectCode;
+
+        /// <summary> The functions to call (in order) after loading the object code, in place of the module's static constructors. </summary>
+        std::vector<std::string> initializationFunctions;
+    };
+
+    /// <summary>
+    /// Returns the key of the cache entry for a map compiled with the given options: the serialized map, the compiler and
+    /// optimizer options, and the target device. Every compiler option is part of the key, except the ones that can't change
+    /// the code, such as the cache directory.
+    /// </summary>
+    ///
+    /// <param name="map"> The map, before refinement. </param>
+    /// <param name="options"> The compiler options. </param>
+    /// <param name="optimizerOptions"> The model optimizer options. </param>
+    ///
+    /// <returns> The key, which is stored in the cache entry and compared when it's read. </returns>
+    std::string GetCompiledMapCacheKey(const Map& map, const MapCompilerOptions& options, const ModelOptimizerOptions& optimizerOptions);
+
+    /// <summary> Returns the name of the cache entry for a key. The name is a hash of the key, so different keys may share a name. </summary>
+    ///
+    /// <param name="key"> The key, from `GetCompiledMapCacheKey`. </param>
+    ///
+    /// <returns> A file name (without directory) for the cache entry. </returns>
+    std::string GetCompiledMapCacheEntryName(const std::string& key);
+
+    /// <summary> Returns the name of the cache entry for a map compiled with the given options. </summary>
+    ///
+    /// <param name="map"> The map, before refinement. </param>
+    /// <param name="options"> The compiler options. </param>
+    /// <param name="optimizerOptions"> The model optimizer options. </param>
+    ///
+    /// <returns> A file name (without directory) for the cache entry. </returns>
+    std::string GetCompiledMapCacheEntryName(const Map& map, const MapCompilerOptions& options, const ModelOptimizerOptions& optimizerOptions);
+
+    /// <summary> Returns a string that identifies the compiler options and target device, as used in the names of cache entries. </summary>
+    ///
+    /// <param name="options"> The compiler options. </param>
+    ///
+    /// <returns> A string that is the same for options that generate the same code. </returns>
+    std::string GetMapCompilerOptionsKey(const MapCompilerOptions& options);
+
+    /// <summary> Generates the machine code to store in the cache for a module that has been fully emitted and optimized. </summary>
+    ///
+    /// <param name="module"> The module to compile. The linkage of its static constructors is made external, so they can be found after loading. </param>
+    ///
+    /// <returns> The object code and the names of the module's initialization functions. </returns>
+    CachedMachineCode GenerateCachedMachineCode(emitters::IRModuleEmitter& module);
+
+    /// <summary> Reads a cache entry. </summary>
+    ///
+    /// <param name="filename"> The path of the cache entry. </param>
+    /// <param name="key"> The key the entry must have been written with. </param>
+    /// <param name="code"> Receives the contents of the cache entry. </param>
+    ///
+    /// <returns> `true` if the entry exists, is valid, and was written with the same key. </returns>
+    bool TryReadCachedMachineCode(const std::string& filename, const std::string& key, CachedMachineCode& code);
+
+    /// <summary> Writes a cache entry. The entry is written to a temporary file first and then renamed, so concurrent readers never see a partial entry. </summary>
+    ///
+    /// <param name="filename"> The path of the cache entry. </param>
+    /// <param name="key"> The key of the entry, from `GetCompiledMapCacheKey`. </param>
+    /// <param name="code"> The contents of the cache entry. </param>
+    void WriteCachedMachineCode(const std::string& filename, const std::string& key, const CachedMachineCode& code);
+} // namespace model
+} // namespace ell
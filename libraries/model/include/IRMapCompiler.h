@@ -8,9 +8,11 @@
 
 #pragma once
 
+#include "FootprintReport.h"
 #include "IRCompiledMap.h"
 #include "InputPort.h"
 #include "MapCompiler.h"
+#include "MemoryPlanner.h"
 #include "Node.h"
 #include "NodeMap.h"
 #include "OutputPort.h"
@@ -20,7 +22,12 @@
 
 #include <utilities/include/Logger.h>
 
+#include <memory>
+#include <type_traits>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace ell
@@ -53,6 +60,39 @@ namespace model
         /// <param name="functionName"> The name of the function to evaluate the map </param>
         IRCompiledMap Compile(Map map);
 
+        /// <summary>
+        /// Compile several maps into one CompiledMap, with `MergeMaps`. Inputs with the same name are shared, and the
+        /// preprocessing the maps have in common is computed once. Besides the predict function, which computes all the
+        /// outputs, the module has a `<predict>_<mapName>` function for each map, with just that map's outputs.
+        /// </summary>
+        ///
+        /// <param name="maps"> The maps to compile </param>
+        /// <param name="mapNames"> The names of the maps, used in the output and function names </param>
+        IRCompiledMap Compile(const std::vector<Map>& maps, const std::vector<std::string>& mapNames);
+
+        /// <summary>
+        /// Computes the external weights of a map, the way Compile places them with the `externalWeights` option,
+        /// without optimizing or compiling the module. `IRCompiledMap::UpdateWeights` uses this to swap new weights
+        /// into a model compiled from a map with the same structure. The compiler can't be used for anything else afterwards.
+        /// </summary>
+        ///
+        /// <param name="map"> The map to get the weights of </param>
+        ExternalWeights CompileWeights(Map map);
+
+        /// <summary> Refines and optimizes a map the way Compile does before emitting it </summary>
+        ///
+        /// <param name="map"> The map to refine and optimize </param>
+        void RefineAndOptimize(Map& map);
+
+        /// <summary>
+        /// Compile a map that RefineAndOptimize has already prepared, skipping the model-level passes. This lets
+        /// several compilers emit code for the same map, e.g. for different targets that refine it the same way,
+        /// without refining it again.
+        /// </summary>
+        ///
+        /// <param name="map"> The refined map to compile </param>
+        IRCompiledMap CompileRefined(Map map);
+
         /// <summary> Gets the compiler parameters being used by the IR emitter. </summary>
         ///
         /// <returns> The CompilerOptions struct used by the IR emitter to control code generation. </returns>
@@ -147,15 +187,80 @@ namespace model
         /// <returns> The generated name. </returns>
         std::string GetGlobalName(const Node& node, const std::string& baseName) const;
 
+        /// <summary>
+        /// Gets the number of entries along the outermost dimension of a port to compute, for a map compiled with
+        /// `dynamicInputExtent`. This is the extent passed to the dynamic predict function (or the full size, when
+        /// called through the regular predict function), for ports whose outermost dimension comes from the input's.
+        /// Nodes that override `CompilableNode::SupportsDynamicExtent` use it as their outer loop bound.
+        /// </summary>
+        ///
+        /// <param name="port"> The port being computed. </param>
+        /// <param name="function"> The function being emitted. </param>
+        /// <returns> The number of entries as an int32 value, or `nullptr` if the port has a fixed size. </returns>
+        emitters::LLVMValue GetDynamicExtent(const OutputPortBase& port, emitters::IRFunctionEmitter& function);
+
+        /// <summary> Indicates if any output of a node has a dynamic extent (see `GetDynamicExtent`). </summary>
+        ///
+        /// <param name="node"> The node. </param>
+        /// <returns> `true` if the node computes a runtime number of entries of its outputs. </returns>
+        bool HasDynamicExtent(const Node& node) const;
+
+        /// <summary>
+        /// Makes an output port a view of part of another port's buffer, instead of giving it a buffer of its own. Nodes
+        /// whose output is a contiguous part of their input (slices, reinterpretations) call this from `Compile` before
+        /// emitting their output, and copy the values themselves if it returns false. Ports can only be aliased in the
+        /// map's predict function, when the `aliasPorts` option is set and the port doesn't have a buffer already.
+        /// </summary>
+        ///
+        /// <param name="port"> The output port to alias. </param>
+        /// <param name="source"> The port whose buffer holds the values. It must have the same type. </param>
+        /// <param name="offset"> The entry of `source` that is the first entry of `port`. </param>
+        /// <returns> `true` if `port` is now a view of `source`. </returns>
+        bool TryAliasPort(const OutputPortBase& port, const OutputPortBase& source, int offset);
+
+        /// <summary> Indicates if an output port's buffer is a view of another port's buffer, starting at the given entry. </summary>
+        ///
+        /// <param name="port"> The output port. </param>
+        /// <param name="source"> The port that may hold the values. </param>
+        /// <param name="offset"> The entry of `source` that would be the first entry of `port`. </param>
+        /// <returns> `true` if the values of `port` are already in `source`, at `offset`. </returns>
+        bool IsPortAliasOf(const OutputPortBase& port, const OutputPortBase& source, int offset);
+
+        /// <summary>
+        /// Places the values of a constant output port in the map's external weights, instead of in a global of the
+        /// module, when the `externalWeights` option is set. Nodes that hold constant data call this from `Compile`, and
+        /// emit the values themselves if it returns false. Small constants stay in the module, and constants are only
+        /// placed externally in the map's predict function, when its branches aren't compiled into functions of their own.
+        /// </summary>
+        ///
+        /// <param name="port"> The output port that holds the values. </param>
+        /// <param name="values"> The values. </param>
+        /// <returns> `true` if the port is now a view of the external weights. </returns>
+        template <typename ValueType>
+        bool TryPlaceInExternalWeights(const OutputPort<ValueType>& port, const std::vector<ValueType>& values);
+
+        /// <summary>
+        /// Emits a call to the function computing the nodes that only a conditional input of a node depends on (see
+        /// `CompilableNode::GetConditionalInputs`). The node calls this from `Compile`, in the code path that reads the
+        /// input, before it reads it. Emits nothing if every node the input depends on is needed elsewhere.
+        /// </summary>
+        ///
+        /// <param name="input"> The conditional input. </param>
+        /// <param name="function"> The function being emitted, which is the function the node is inlined into. </param>
+        void CallConditionalBranch(const InputPortBase& input, emitters::IRFunctionEmitter& function);
+
     protected:
         void OnBeginCompileModel(const Model& model) override;
         void OnEndCompileModel(const Model& model) override;
         void OnBeginCompileNode(const Node& node) override;
         void OnEndCompileNode(const Node& node) override;
+        void CompileNodes(Model& model) override;
         void PushScope() override;
         void PopScope() override;
         emitters::ModuleEmitter* GetModuleEmitter() override { return &_moduleEmitter; }
         virtual std::string GetPredictFunctionName() const;
+        virtual std::string GetBatchPredictFunctionName() const;
+        virtual std::string GetDynamicPredictFunctionName() const;
         virtual void EmitModelAPIFunctions(const Map& map);
 
         emitters::IRModuleEmitter _moduleEmitter;
@@ -164,7 +269,7 @@ namespace model
     private:
         NodeMap<emitters::IRBlockRegion*>& GetCurrentNodeBlocks();
         const Node* GetUniqueParent(const Node& node);
-        void RefineAndOptimize(Map& map);
+        IRCompiledMap Compile(Map map, bool isRefined);
         bool TryMergeNodeIntoRegion(emitters::IRBlockRegion* pDestination, const Node& src);
 
         void EmitGetInputSizeFunction(const Map& map);
@@ -180,10 +285,117 @@ namespace model
         void EmitShapeConditionals(emitters::IRFunctionEmitter& fn, std::vector<MemoryShape> shapes);
 
         void EmitGetMetadataFunction(const Map& map);
+        void EmitPredictFunction(Map& map);
+        void EmitBatchPredictFunction(const Map& map);
+        void EmitMergedMapPredictFunctions(const Map& map, const std::vector<std::string>& mapNames, const std::vector<int>& outputCounts);
+        void FindDynamicExtentPorts(const Map& map);
+        void EmitDynamicPredictFunction(const Map& map);
+        void EmitReentrantStateFunctions();
         void EmitStringConditionals(emitters::IRFunctionEmitter& fn, std::vector<std::pair<std::string, std::string>> keyValuePairs);
 
+        // Port aliasing: ports whose values are a contiguous part of another port's are views of its buffer
+        bool CanAliasPorts();
+        void FindInPlaceInputs(const Model& model);
+        void PlaceOutputsInPlace(const Node& node);
+        void PlaceOutputInPlace(const OutputPortBase& port);
+        const emitters::Variable* GetAliasedVariable(const emitters::Variable* pVar) const;
+
+        // Branch parallelism: a set of independent branches is compiled into functions of their own, which are run as
+        // tasks, except for the largest one, which runs on the calling thread before it waits for the others
+        bool ShouldParallelizeBranches(const Model& model) const;
+        void CompileSubgraph(const std::vector<const Node*>& nodes);
+        void CompileBranches(std::vector<std::vector<const Node*>> branches);
+        emitters::LLVMFunction EmitBranchFunction(const std::vector<const Node*>& branch, const emitters::NamedLLVMTypeList& parameters);
+        emitters::LLVMFunction GetModelFunction();
+
+        // Conditional branches: the nodes that only a conditional input of a node depends on are left out of the
+        // sequence of nodes, and compiled into a function of their own right before that node, which calls it
+        void FindConditionalBranches(const Model& model);
+        void CompileNodeAndConditionalBranches(const Node& node);
+        emitters::LLVMFunction EmitConditionalBranchFunction(const std::vector<const Node*>& nodes);
+
+        // Memory planning: port buffers allocated in the predict function are placed in a shared arena, and a
+        // buffer's memory is released once the last node reading it (or any port aliasing it) has been compiled.
+        bool IsPlanningMemory() const { return _memoryPlanner != nullptr; }
+        void BeginMemoryPlan(const Model& model);
+        void EndMemoryPlan();
+        size_t GetPlannedBufferSize(const OutputPortBase& port);
+        void AllocatePlannedPortVariables(const Node& node);
+        emitters::Variable* AllocatePlannedPortVariable(const OutputPortBase& port);
+        void ReleasePlannedPortVariables(const Node& node);
+        template <typename ValueType>
+        void FillPlannedPortPadding(const OutputPortBase& port, emitters::Variable* pVar, ValueType value);
+
+        // External weights: constants placed outside the module are views of a blob that the predict function reads
+        // through a global pointer, which the caller sets with `<prefix>_SetWeights` or `<prefix>_LoadWeights`
+        bool PlaceInExternalWeights(const OutputPortBase& port, const uint8_t* data, size_t size);
+        llvm::GlobalVariable* GetExternalWeightsPointer();
+        void EmitExternalWeightsFunctions();
+
+        // Footprint report: what each node adds to the module is measured by comparing the module before and after
+        // the node is compiled
+        void BeginNodeFootprint();
+        void EndNodeFootprint(const Node& node);
+
+        struct PlannedBuffer
+        {
+            size_t offset;
+            int remainingReaders;
+        };
+
         // stack of node regions
         std::vector<NodeMap<emitters::IRBlockRegion*>> _nodeRegions;
+
+        std::unique_ptr<MemoryPlanner> _memoryPlanner;
+        llvm::GlobalVariable* _memoryArena = nullptr; // a placeholder until the plan is finished and the arena size is known
+        emitters::LLVMFunction _memoryPlanFunction = nullptr;
+        std::string _memoryPlanFunctionName;
+        std::unordered_map<const OutputPortBase*, int> _portReaderCounts;
+        std::unordered_map<const OutputPortBase*, emitters::Variable*> _plannedPortVariables;
+        std::unordered_map<const emitters::Variable*, PlannedBuffer> _plannedBuffers;
+
+        struct PortAlias
+        {
+            const OutputPortBase* source;
+            int offset;
+            const emitters::Variable* pVar;
+        };
+
+        emitters::LLVMFunction _aliasFunction = nullptr;
+        std::unordered_map<const OutputPortBase*, PortAlias> _portAliases;
+        std::unordered_map<const emitters::Variable*, const emitters::Variable*> _aliasedVariables; // view -> the variable it's a view of
+        std::unordered_map<const OutputPortBase*, std::pair<const OutputPortBase*, int>> _inPlacePorts; // port -> the output (and entry) its values are copied to
+
+        bool _hasBranchFunctions = false; // nodes of the model are compiled into branch functions
+        std::unordered_map<emitters::LLVMFunction, emitters::LLVMFunction> _branchFunctions; // branch function -> the function it's forked from
+
+        std::unordered_set<const Node*> _conditionalNodes;
+        std::unordered_map<const InputPortBase*, std::vector<const Node*>> _conditionalBranchNodes; // conditional input -> the nodes only it depends on, in order
+        std::unordered_map<const InputPortBase*, emitters::LLVMFunction> _conditionalBranchFunctions;
+
+        // Dynamic input extent: the ports whose outermost dimension is the input's, and the global holding its runtime extent
+        std::unordered_set<const OutputPortBase*> _dynamicExtentPorts;
+        int _maxDynamicExtent = 0;
+        llvm::GlobalVariable* _dynamicExtent = nullptr;
+
+        emitters::LLVMFunction _externalWeightsFunction = nullptr; // the predict function
+        llvm::GlobalVariable* _externalWeightsPointer = nullptr;
+        std::vector<uint8_t> _externalWeights;
+        std::vector<std::pair<size_t, size_t>> _externalWeightsBlocks; // the offset and size of each constant placed in `_externalWeights`
+
+        struct NodeFootprintSnapshot
+        {
+            emitters::LLVMFunction function = nullptr;
+            size_t instructions = 0;
+            size_t stackBytes = 0;
+            size_t numFunctions = 0;
+            size_t numGlobals = 0;
+            size_t externalWeightBytes = 0;
+            NodeFootprint innerFootprint; // the sizes of the nodes compiled while this one is
+            std::unordered_set<std::string> innerFunctions;
+        };
+        std::vector<NodeFootprintSnapshot> _footprintStack;
+        FootprintReport _footprintReport;
     };
 } // namespace model
 } // namespace ell
@@ -201,8 +413,43 @@ namespace model
 
         Log() << "EnsurePortEmitted called for port " << port.GetRuntimeTypeName() << EOL;
         auto pVar = GetOrAllocatePortVariable(port, initialValue);
+        if (initialValue != 0)
+        {
+            FillPlannedPortPadding(port, pVar, initialValue);
+        }
         return GetModule().EnsureEmitted(*pVar);
     }
+
+    template <typename ValueType>
+    void IRMapCompiler::FillPlannedPortPadding(const OutputPortBase& port, emitters::Variable* pVar, ValueType value)
+    {
+        // A buffer in the memory arena doesn't get the initial value a global would have, so fill it in here. Nodes
+        // ask for their output before they write to it, so this happens before the active area is written.
+        auto it = _plannedPortVariables.find(&port);
+        if (it == _plannedPortVariables.end() || it->second != pVar || !port.GetMemoryLayout().HasPadding())
+        {
+            return;
+        }
+
+        auto pOutput = GetModule().EnsureEmitted(*pVar);
+        GetModule().GetCurrentFunction().For(static_cast<int>(port.Size()), [pOutput, value](emitters::IRFunctionEmitter& function, auto i) {
+            function.SetValueAt(pOutput, i, function.Literal<ValueType>(value));
+        });
+    }
+
+    template <typename ValueType>
+    bool IRMapCompiler::TryPlaceInExternalWeights(const OutputPort<ValueType>& port, const std::vector<ValueType>& values)
+    {
+        if constexpr (std::is_same_v<ValueType, bool>)
+        {
+            // std::vector<bool> doesn't hold its values in an array
+            return false;
+        }
+        else
+        {
+            return PlaceInExternalWeights(port, reinterpret_cast<const uint8_t*>(values.data()), values.size() * sizeof(ValueType));
+        }
+    }
 } // namespace model
 } // namespace ell
 
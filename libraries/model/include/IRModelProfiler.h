@@ -14,24 +14,62 @@
 #include <emitters/include/EmitterTypes.h>
 #include <emitters/include/LLVMUtilities.h>
 
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <string>
 
 // External API for profiling functions
 extern "C" {
 
-/// <summary> A struct that holds information about a node. </summary>
+/// <summary>
+/// A struct that holds information about a node. The operation and byte counts are static estimates for one
+/// evaluation of the node; they are zero in the entries that describe a node type.
+/// </summary>
 struct NodeInfo
 {
     const char* nodeName;
     const char* nodeType;
+    const char* nodeAncestor;
+    int64_t operationCount;
+    int64_t bytesRead;
+    int64_t bytesWritten;
 };
 
-/// <summary> A struct that holds summary information about a node's runtime performance </summary>
+/// <summary>
+/// A struct that holds summary information about a node's runtime performance. The operation and byte totals
+/// accumulate the static estimates of every evaluation counted, so dividing them by `totalTime` gives the
+/// achieved throughput. The hardware counter totals are measured, and are only collected when the model is
+/// compiled with the `profileHardwareCounters` option.
+/// </summary>
 struct PerformanceCounters
 {
     int count;
     double totalTime;
+    double totalOperations;
+    double totalBytesRead;
+    double totalBytesWritten;
+    int64_t cycles;
+    int64_t instructions;
+    int64_t l1DataCacheMisses;
+    int64_t lastLevelCacheMisses;
+    int64_t branchMisses;
+};
+
+/// <summary>
+/// A struct that holds the latency distribution of a node or the whole model, read from its latency histogram when
+/// the struct is requested. The histogram buckets are a quarter of a power of two wide, and each percentile is the
+/// upper bound of the bucket it falls in, so it overestimates the true value by at most 25%. The maximum is exact.
+/// Times are in milliseconds. Latencies are only recorded when the model is compiled with the
+/// `profileLatencyHistograms` option.
+/// </summary>
+struct LatencyStatistics
+{
+    int64_t count;
+    double p50;
+    double p90;
+    double p99;
+    double maxTime;
 };
 }
 
@@ -48,6 +86,7 @@ namespace model
     // import NodeInfo and PerformanceCounters into our namespace
     using ::NodeInfo;
     using ::PerformanceCounters;
+    using ::LatencyStatistics;
     class Model;
 
     /// <summary> A utility class that emits IR to populate NodeInfo structs. </summary>
@@ -60,11 +99,12 @@ namespace model
     private:
         friend class NodePerformanceEmitter;
 
-        NodeInfoEmitter(emitters::IRModuleEmitter& module, const Node* node, emitters::LLVMValue nodeInfoPtr, llvm::StructType* nodeInfoType);
+        NodeInfoEmitter(emitters::IRModuleEmitter& module, const Node* node, emitters::LLVMValue nodeInfoPtr, llvm::StructType* nodeInfoType, bool includeCosts);
         void Init(emitters::IRFunctionEmitter& function);
 
         emitters::IRModuleEmitter* _module = nullptr;
         const Node* _node = nullptr;
+        bool _includeCosts = false;
 
         emitters::LLVMValue _nodeInfoPtr = nullptr;
         llvm::StructType* _nodeInfoType = nullptr;
@@ -83,16 +123,27 @@ namespace model
 
         PerformanceCountersEmitter(emitters::IRModuleEmitter& module, emitters::LLVMValue performanceCountersPtr, llvm::StructType* performanceCountersType);
         void Init(emitters::IRFunctionEmitter& function);
-        void Start(emitters::IRFunctionEmitter& function, emitters::LLVMValue startTime);
-        void End(emitters::IRFunctionEmitter& function, emitters::LLVMValue startTime);
+        void Start(emitters::IRFunctionEmitter& function, emitters::LLVMValue startTime, emitters::LLVMValue startHardwareCounters);
+        void End(emitters::IRFunctionEmitter& function, emitters::LLVMValue endTime, emitters::LLVMValue endHardwareCounters);
+        void AddCosts(emitters::IRFunctionEmitter& function, int64_t operations, int64_t bytesRead, int64_t bytesWritten);
         void Reset(emitters::IRFunctionEmitter& function);
 
+        // Also record each measured time in a latency histogram, and the maximum time in a LatencyStatistics struct
+        void SetLatencyHistogram(emitters::LLVMValue latencyHistogramPtr, emitters::LLVMValue latencyStatisticsPtr);
+
         emitters::IRModuleEmitter* _module = nullptr;
         emitters::LLVMValue _performanceCountersPtr = nullptr;
         llvm::StructType* _performanceCountersType = nullptr;
+        emitters::LLVMValue _latencyHistogramPtr = nullptr;
+        emitters::LLVMValue _latencyStatisticsPtr = nullptr;
+
+        // Returns the start time recorded by the last call to `Start`
+        emitters::LLVMValue LoadStartTime(emitters::IRFunctionEmitter& function) const;
 
-        // Temporary value used during processing
+        // Temporary values used during processing. The start time is kept in a variable, since `Start` and `End` may
+        // be emitted in different (sampled) blocks
         emitters::LLVMValue _startTime = nullptr;
+        emitters::LLVMValue _startHardwareCounters = nullptr;
     };
 
     /// <summary> A utility class that holds a NodeInfoEmitter and a PerformanceCounterEmitter. </summary>
@@ -104,20 +155,28 @@ namespace model
 
     private:
         void Init(emitters::IRFunctionEmitter& function);
-        void Start(emitters::IRFunctionEmitter& function, emitters::LLVMValue startTime);
-        void End(emitters::IRFunctionEmitter& function, emitters::LLVMValue endTime);
+        void Start(emitters::IRFunctionEmitter& function, emitters::LLVMValue startTime, emitters::LLVMValue startHardwareCounters);
+        void End(emitters::IRFunctionEmitter& function, emitters::LLVMValue endTime, emitters::LLVMValue endHardwareCounters, const Node& node);
         void Reset(emitters::IRFunctionEmitter& function);
+        emitters::LLVMValue LoadStartTime(emitters::IRFunctionEmitter& function) const { return _performanceCountersEmitter.LoadStartTime(function); }
 
         friend class ModelProfiler;
 
-        NodePerformanceEmitter(emitters::IRModuleEmitter& module, const Node* node, emitters::LLVMValue nodeInfoPtr, emitters::LLVMValue NodePerformanceEmitterPtr, llvm::StructType* nodeInfoType, llvm::StructType* NodePerformanceEmitterType);
+        NodePerformanceEmitter(emitters::IRModuleEmitter& module, const Node* node, emitters::LLVMValue nodeInfoPtr, emitters::LLVMValue NodePerformanceEmitterPtr, llvm::StructType* nodeInfoType, llvm::StructType* NodePerformanceEmitterType, bool isNodeType);
 
         // emitters for info and perf counters
         NodeInfoEmitter _nodeInfoEmitter;
         PerformanceCountersEmitter _performanceCountersEmitter;
     };
 
-    /// <summary> A class that manages model-profiling code generation. </summary>
+    /// <summary>
+    /// A class that manages model-profiling code generation. If the module's `profileSamplingInterval` compiler
+    /// option is N > 1, the model and node counters are only updated on every Nth call to the model function, so
+    /// that profiling can be left on in production code. The `count` fields then hold the number of sampled calls.
+    /// With the `profileLatencyHistograms` option, the time of each call to the model and each node evaluation is also
+    /// counted in a log-scale histogram, from which the emitted `GetModelLatencyStatistics`,
+    /// `GetNodeLatencyStatistics` and `GetNodeTypeLatencyStatistics` functions compute percentiles.
+    /// </summary>
     class ModelProfiler
     {
     public:
@@ -179,6 +238,9 @@ namespace model
         void AllocateNodeData();
         std::string GetNamespacePrefix() const;
 
+        // Emits `body` so that it only runs on the calls to the model function that are sampled
+        void EmitIfSampled(emitters::IRFunctionEmitter& function, std::function<void(emitters::IRFunctionEmitter&)> body);
+
         NodePerformanceEmitter& GetPerformanceCountersForNode(const Node& node);
         NodePerformanceEmitter& GetTypePerformanceCountersForNode(const Node& node);
 
@@ -198,14 +260,33 @@ namespace model
         void EmitPrintNodeTypeProfilingInfoFunction();
         void EmitResetNodeTypeProfilingInfoFunction();
 
+        void EmitGetLatencyStatisticsFunction(const std::string& name, llvm::GlobalVariable* histograms, llvm::GlobalVariable* statisticsArray, bool isIndexed);
+        void EmitPrintModelLatencyInfoFunction();
+        void EmitPrintNodeLatencyInfoFunction();
+
+        // Emits code that fills in the count and percentiles of a LatencyStatistics struct from a histogram
+        void EmitComputeLatencyStatistics(emitters::IRFunctionEmitter& function, emitters::LLVMValue histogramPtr, emitters::LLVMValue statisticsPtr);
+
+        // Emits code that zeroes the first `count` histograms and LatencyStatistics structs of the given arrays
+        void EmitResetLatencyHistograms(emitters::IRFunctionEmitter& function, llvm::GlobalVariable* histograms, llvm::GlobalVariable* statisticsArray, int count);
+
+        // Returns a pointer to the first bucket of histogram `index` in `histograms`
+        emitters::LLVMValue GetLatencyHistogramPtr(llvm::GlobalVariable* histograms, emitters::LLVMValue index);
+
         emitters::LLVMValue CallGetCurrentTime(emitters::IRFunctionEmitter& function);
 
+        // Returns a new int64 array holding the current hardware counter values, or nullptr if hardware counter profiling is disabled
+        emitters::LLVMValue CallReadHardwareCounters(emitters::IRFunctionEmitter& function);
+
         emitters::IRModuleEmitter* _module = nullptr;
         Model* _model = nullptr;
         bool _profilingEnabled = false;
+        int _samplingInterval = 1;
+        bool _latencyHistogramsEnabled = false;
 
         llvm::StructType* _nodeInfoType = nullptr;
         llvm::StructType* _performanceCountersType = nullptr;
+        llvm::StructType* _latencyStatisticsType = nullptr;
 
         llvm::GlobalVariable* _modelPerformanceCountersArray = nullptr;
 
@@ -215,6 +296,19 @@ namespace model
         llvm::GlobalVariable* _nodeTypeInfoArray = nullptr;
         llvm::GlobalVariable* _nodeTypePerformanceCountersArray = nullptr;
 
+        // The latency histograms are flat int64 arrays with a run of buckets for each node, and are only allocated if
+        // `profileLatencyHistograms` is set. The statistics arrays are always there, so the getters always exist.
+        llvm::GlobalVariable* _latencyBucketUpperBounds = nullptr;
+        llvm::GlobalVariable* _modelLatencyHistogram = nullptr;
+        llvm::GlobalVariable* _modelLatencyStatisticsArray = nullptr;
+        llvm::GlobalVariable* _nodeLatencyHistograms = nullptr;
+        llvm::GlobalVariable* _nodeLatencyStatisticsArray = nullptr;
+        llvm::GlobalVariable* _nodeTypeLatencyHistograms = nullptr;
+        llvm::GlobalVariable* _nodeTypeLatencyStatisticsArray = nullptr;
+
+        // The position of the current call in the sampling interval. Calls at position 0 are sampled.
+        llvm::GlobalVariable* _samplingPhase = nullptr;
+
         // Performance counter emitters for model
         PerformanceCountersEmitter _modelPerformanceCounters;
 
@@ -147,6 +147,11 @@ namespace model
         /// <returns> The (already-computed) output value corresponding to this input </returns>
         std::vector<ValueType> GetValue() const;
 
+        /// <summary> Returns the (already-computed) output value corresponding to this input, without copying it </summary>
+        ///
+        /// <returns> The cached output of the referenced port, which is valid until the port computes again </returns>
+        const std::vector<ValueType>& GetValueReference() const;
+
         /// <summary> Returns an element from the (already-computed) output value corresponding to this input </summary>
         ///
         /// <param name="index"> The index of the element to return </param>
@@ -219,6 +224,23 @@ namespace model
         return result;
     }
 
+    template <typename ValueType>
+    const std::vector<ValueType>& InputPort<ValueType>::GetValueReference() const
+    {
+        if (!IsValid())
+        {
+            static const std::vector<ValueType> empty;
+            return empty;
+        }
+
+        const auto& result = GetReferencedPort().GetOutput();
+        if (Size() != result.size())
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState);
+        }
+        return result;
+    }
+
     template <typename ValueType>
     ValueType InputPort<ValueType>::GetValue(size_t index) const
     {
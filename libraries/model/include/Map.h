@@ -110,7 +110,17 @@ namespace model
         OutputVectorType Compute(const InputVectorType& inputValues);
 
         /// <summary> Reset the state of the model </summary>
-        void Reset();
+        virtual void Reset();
+
+        /// <summary> Sets the number of threads Compute uses. With more than one, nodes that don't depend on each
+        /// other are computed at the same time, and large nodes may split their work across threads. A map computed
+        /// from inside a utilities::ParallelFor block uses only the thread it's computed on. </summary>
+        ///
+        /// <param name="numThreads"> The number of threads, or 0 for the number of hardware threads. The default is 1. </param>
+        void SetNumComputeThreads(size_t numThreads);
+
+        /// <summary> Returns the number of threads Compute uses </summary>
+        size_t GetNumComputeThreads() const { return _numComputeThreads; }
 
         /// <summary> Returns the number of inputs to the map </summary>
         ///
@@ -470,6 +480,7 @@ namespace model
         utilities::PropertyBag _metadata;
 
         value::ComputeContext _computeContext{ "map_compute" };
+        size_t _numComputeThreads = 1;
     };
 
     /// <summary> A serialization context used during Map deserialization. Wraps an existing `ModelSerializationContext` </summary>
@@ -481,6 +492,26 @@ namespace model
         /// <param name="previousContext"> The `SerializationContext` to wrap </param>
         MapSerializationContext(utilities::SerializationContext& previousContext);
     };
+
+    /// <summary>
+    /// Merges several maps into one map, so they can be compiled into one module. Inputs with the same name are shared
+    /// by the maps (and must have the same type and shape), so the common subexpression pass of the model optimizer
+    /// computes any preprocessing the maps share once. The outputs are named `<mapName>_<outputName>`, in the order of
+    /// the maps, and the grouping of the outputs by map is kept in the model's metadata (see `GetMergedMapNames` and
+    /// `GetMergedMapOutputCounts`), which the compiler uses to emit a predict function for each map.
+    /// </summary>
+    ///
+    /// <param name="maps"> The maps to merge. </param>
+    /// <param name="mapNames"> The names of the maps, which must be unique. </param>
+    ///
+    /// <returns> The merged map. </returns>
+    Map MergeMaps(const std::vector<Map>& maps, const std::vector<std::string>& mapNames);
+
+    /// <summary> Gets the names of the maps that were merged into a map by `MergeMaps`, or an empty vector if it isn't a merged map. </summary>
+    std::vector<std::string> GetMergedMapNames(const Map& map);
+
+    /// <summary> Gets the number of outputs of each of the maps that were merged into a map by `MergeMaps`. </summary>
+    std::vector<int> GetMergedMapOutputCounts(const Map& map);
 } // namespace model
 } // namespace ell
 
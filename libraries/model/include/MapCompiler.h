@@ -128,6 +128,15 @@ namespace model
         /// </summary>
         emitters::FunctionArgumentList AllocateMapFunctionArguments(Map& map, emitters::ModuleEmitter& emitter);
 
+        /// <summary> Replaces the global compiler parameters, e.g. while compiling part of the model differently. </summary>
+        void SetMapCompilerOptions(const MapCompilerOptions& settings);
+
+        /// <summary> Compiles the model's nodes, in an order where each node comes after the nodes it depends on. </summary>
+        virtual void CompileNodes(Model& model);
+
+        /// <summary> Compiles one node, whose inputs have already been compiled. </summary>
+        void CompileNode(const Node& node);
+
         //
         // These methods may be implemented by specific compilers
         //
@@ -143,7 +152,6 @@ namespace model
 
         friend class CompilableNode;
 
-        void CompileNodes(Model& model);
         emitters::Variable* AllocatePortFunctionArgument(emitters::ModuleEmitter& emitter, const OutputPortBase& port, emitters::ArgumentFlags argDirection, ell::utilities::UniqueNameList& uniqueNameScope);
         emitters::Variable* AllocatePortFunctionArgument(emitters::ModuleEmitter& emitter, const PortElementBase& element, emitters::ArgumentFlags argDirection, ell::utilities::UniqueNameList& uniqueNameScope);
 
@@ -36,9 +36,23 @@ namespace model
         std::string sinkFunctionName;
         bool verifyJittedModule = true;
         bool profile = false;
+        bool emitBatchPredictFunction = false; // also emit `<mapFunctionName>_batch(context, inputs..., outputs..., batchSize)`, which calls the predict function once per sample on the calling thread
+        std::string jitCacheDirectory; // if set, jitted machine code is stored here and reused by later compiles of the same map
+        bool planMemory = false; // place intermediate port buffers in a shared arena, reusing memory once a buffer's last reader has run
+        bool scheduleForMemory = false; // with `planMemory`, compile the nodes in an order that keeps few intermediate buffers live at once, to make the arena smaller (see `GetMemoryAwareNodeOrder`)
+        bool aliasPorts = true; // let slices, reinterpretations, and concatenations share their input's buffer, and write a splice's inputs directly into its output
+        bool reentrant = false; // keep all mutable state in a caller-allocated struct passed to the predict function, instead of in globals
+        bool cacheRefinement = false; // reuse what nodes refined into in earlier compiles in this process, for nodes with the same content
+        bool tieredCompilation = false; // JIT a reentrant map without optimizations first, and switch to optimized code compiled on a background thread once it's ready
+        bool parallelizeBranches = false; // run independent branches of the model (e.g., the towers of an Inception module) as tasks on their own threads, joined where they merge (needs `compilerSettings.parallelize`)
+        bool externalWeights = false; // keep the values of large constants out of the module, in a blob the predict function reads through a pointer set at run time (see `<moduleName>_SetWeights` and `<moduleName>_LoadWeights`)
+        bool footprintReport = false; // collect the code, weight, buffer and stack size of each node (see `IRCompiledMap::GetFootprintReport`), and summarize it in the predict function's comments
+        bool dynamicInputExtent = false; // the outermost dimension of the input is a maximum: also emit `<mapFunctionName>_dynamic(context, inputs..., outputs..., extent)`, which only computes the first `extent` entries along it
 
         // per-node options
         bool inlineNodes = false;
+        bool lazyCompile = false; // give the JIT the node's function to compile the first time it's called, instead of up front (ignored for inlined nodes)
+        bool shareNodeFunctions = false; // nodes with the same content share one function, if their type allows it (see `CompilableNode::CanShareNodeFunction`)
 
         // lower-level emitters settings
         emitters::CompilerOptions compilerSettings;
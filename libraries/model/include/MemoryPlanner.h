@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     MemoryPlanner.h (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+
+namespace ell
+{
+namespace model
+{
+    /// <summary>
+    /// Assigns offsets in a single memory arena to buffers with overlapping lifetimes. Buffers are allocated and
+    /// freed in program order, and a freed region is reused by later buffers that fit in it, so the size of the
+    /// arena is the peak memory in use rather than the total size of all the buffers.
+    /// </summary>
+    class MemoryPlanner
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="alignment"> The alignment, in bytes, of every buffer's offset. Must be a power of 2. </param>
+        explicit MemoryPlanner(size_t alignment);
+
+        /// <summary> Reserves a region of the arena. The smallest free region the buffer fits in is used. </summary>
+        ///
+        /// <param name="size"> The size of the buffer, in bytes. </param>
+        ///
+        /// <returns> The offset of the buffer in the arena. </returns>
+        size_t Allocate(size_t size);
+
+        /// <summary> Releases a region of the arena, so later buffers can use it. </summary>
+        ///
+        /// <param name="offset"> The offset returned by `Allocate`. </param>
+        void Free(size_t offset);
+
+        /// <summary> Gets the size the arena has to be to hold all the buffers allocated so far. </summary>
+        size_t GetPeakSize() const { return _peakSize; }
+
+        /// <summary> Gets the total size of all the buffers allocated so far, which is the memory they would need without sharing. </summary>
+        size_t GetTotalAllocatedSize() const { return _totalAllocatedSize; }
+
+    private:
+        size_t AlignUp(size_t offset) const;
+
+        size_t _alignment;
+        std::map<size_t, size_t> _liveBuffers; // offset -> size
+        size_t _peakSize = 0;
+        size_t _totalAllocatedSize = 0;
+    };
+} // namespace model
+} // namespace ell
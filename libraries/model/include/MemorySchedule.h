@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     MemorySchedule.h (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace ell
+{
+namespace model
+{
+    class Model;
+    class Node;
+    class OutputPortBase;
+
+    /// <summary> A function that gets the size, in bytes, of the buffer a port's values take up while they're live, or zero for ports that don't take up scheduled memory. </summary>
+    using PortBufferSizeFunction = std::function<size_t(const OutputPortBase&)>;
+
+    /// <summary>
+    /// Gets the most memory the buffers of output ports take up at once when nodes run in a given order. A buffer is
+    /// live from the time its node runs until its last reader has run.
+    /// </summary>
+    ///
+    /// <param name="nodes"> The nodes, in the order they run. </param>
+    /// <param name="getBufferSize"> The function that gets the size of a port's buffer. </param>
+    ///
+    /// <returns> The peak size of the live buffers, in bytes. </returns>
+    size_t GetPeakLiveBufferSize(const std::vector<const Node*>& nodes, const PortBufferSizeFunction& getBufferSize);
+
+    /// <summary>
+    /// Gets an order to run the nodes of a model in that keeps few buffers live at once. Among the nodes whose inputs
+    /// are ready, the next one is the one that adds the least memory (the size of its outputs, less the size of the
+    /// inputs it's the last reader of), so a branch is finished, and its buffers released, before another one is
+    /// started. The order is only used if its peak is lower than the one of the order `Model::Visit` visits the nodes in.
+    /// </summary>
+    ///
+    /// <param name="model"> The model. </param>
+    /// <param name="getBufferSize"> The function that gets the size of a port's buffer. </param>
+    ///
+    /// <returns> The nodes of the model, in dependency order. </returns>
+    std::vector<const Node*> GetMemoryAwareNodeOrder(const Model& model, const PortBufferSizeFunction& getBufferSize);
+} // namespace model
+} // namespace ell
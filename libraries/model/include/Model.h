@@ -8,10 +8,12 @@
 
 #pragma once
 
+#include "ModelAdjacency.h"
 #include "Node.h"
 #include "OutputPort.h"
 #include "PortElements.h"
 
+#include <utilities/include/Arena.h>
 #include <utilities/include/IArchivable.h>
 #include <utilities/include/IIterator.h>
 #include <utilities/include/PropertyBag.h>
@@ -53,7 +55,6 @@ namespace model
     protected:
         friend class Model;
         NodeIterator(const Model* model);
-        void SetNodeVisited(const Node* node);
         void SetSubmodelInputs(const std::vector<const InputPortBase*>& inputs);
         void AddSubmodelInputParents(const Node* node);
         void AddRemainingValidOutputs();
@@ -62,12 +63,19 @@ namespace model
         bool ShouldVisitInput(const InputPortBase* input) const;
         void SetOutputNodesToVisit(const std::vector<const Node*>& outputs);
         void SetOutputPortsToVisit(const std::vector<const OutputPortBase*>& outputs);
+        void SetCurrentNode(size_t index);
 
         const Model* _model = nullptr;
-        std::unordered_set<const Node*> _visitedNodes;
+
+        // The connections between the nodes when the iteration started
+        std::shared_ptr<const ModelAdjacency> _adjacency;
+
+        // Indexed by Node::GetIndex()
+        std::vector<bool> _visitedNodes;
+        std::vector<bool> _submodelInputParents;
+
         std::unordered_set<const InputPortBase*> _submodelInputs;
-        std::unordered_set<const Node*> _submodelInputParents;
-        std::vector<const Node*> _nodesToVisit;
+        std::vector<size_t> _nodesToVisit;
 
         const Node* _currentNode = nullptr;
     };
@@ -198,20 +206,26 @@ namespace model
         /// <summary> Returns part of the output computed by the model </summary>
         ///
         /// <param name="outputPort"> The output port to get the computed value from </param>
+        /// <param name="numThreads"> The number of threads to compute with. With more than one, nodes that don't depend on
+        /// each other are computed at the same time, and nodes may split their own work across threads. </param>
         template <typename ValueType>
-        std::vector<ValueType> ComputeOutput(const OutputPort<ValueType>& outputPort) const;
+        std::vector<ValueType> ComputeOutput(const OutputPort<ValueType>& outputPort, size_t numThreads = 1) const;
 
         /// <summary> Returns part of the output computed by the model </summary>
         ///
         /// <param name="elements"> The output port elements to get the computed value from </param>
+        /// <param name="numThreads"> The number of threads to compute with. With more than one, nodes that don't depend on
+        /// each other are computed at the same time, and nodes may split their own work across threads. </param>
         template <typename ValueType>
-        std::vector<ValueType> ComputeOutput(const PortElements<ValueType>& elements) const;
+        std::vector<ValueType> ComputeOutput(const PortElements<ValueType>& elements, size_t numThreads = 1) const;
 
         /// <summary> Returns part of the output computed by the model </summary>
         ///
         /// <param name="elements"> The output port elements to get the computed value from </param>
+        /// <param name="numThreads"> The number of threads to compute with. With more than one, nodes that don't depend on
+        /// each other are computed at the same time, and nodes may split their own work across threads. </param>
         template <typename ValueType>
-        std::vector<ValueType> ComputeOutput(const PortElementsBase& elements) const;
+        std::vector<ValueType> ComputeOutput(const PortElementsBase& elements, size_t numThreads = 1) const;
 
         /// <summary> Reset the state of the model </summary>
         void Reset();
@@ -262,6 +276,14 @@ namespace model
         /// </summary>
         ForwardNodeIterator GetNodeIterator() const;
 
+        /// <summary>
+        /// Gets a compact, index-based snapshot of the connections between the nodes of the model, for passes that
+        /// walk the whole graph. It's built on first use, and rebuilt after nodes are added or reconnected.
+        /// </summary>
+        ///
+        /// <returns> The adjacency structure, whose node indices are those of Node::GetIndex(). </returns>
+        std::shared_ptr<const ModelAdjacency> GetAdjacency() const;
+
         /// <summary>
         /// Gets an iterator over the nodes in the model necessary to compute the given output. Visits the nodes
         /// in dependency order. No nodes will be visited until all its inputs have first been visited.
@@ -373,20 +395,53 @@ namespace model
         friend class NodeIterator;
         friend class ForwardNodeIterator;
         friend class ReverseNodeIterator;
+        friend class InputPortBase;
         friend class detail::ModelNodeRouter;
         template <typename ValueType>
         friend class InputPort;
         friend class ModelTransformer;
+        friend class RefinementCache;
         friend class Map;
         friend void swap(Model& a, Model& b);
 
         using IDToNodeMap = std::map<Node::NodeId, std::shared_ptr<Node>, std::less<Node::NodeId>>;
+
+        // The nodes to compute for a set of outputs, in dependency order, and the dependencies between them
+        struct ComputePlan
+        {
+            std::vector<const Node*> nodes;
+
+            // The number of distinct nodes of the plan each node has an input connected to
+            std::vector<size_t> numParents;
+
+            // The positions in the plan of the dependents of nodes[i] are dependents[dependentOffsets[i]] to dependents[dependentOffsets[i + 1] - 1]
+            std::vector<size_t> dependentOffsets;
+            std::vector<size_t> dependents;
+
+            // The largest number of nodes at the same distance from the plan's inputs. A chain of nodes has a width of
+            // 1, and gains nothing from computing several nodes at once.
+            size_t width = 1;
+        };
+
         struct ModelData
         {
+            // The nodes, and the shared pointer control blocks that own them, are allocated from this arena. The
+            // control blocks keep it alive until the last node is gone.
+            std::shared_ptr<utilities::Arena> nodeArena = std::make_shared<utilities::Arena>(1 << 16);
+
             // The id->node map acts both as the main container that holds the shared pointers to nodes, and as the index
             // to look nodes up by id.
             // We keep it sorted by id to make visiting all nodes deterministically ordered
             IDToNodeMap idToNodeMap;
+
+            // The nodes in the order they were added, so a node's index is its position
+            std::vector<Node*> nodesByIndex;
+
+            // Built from nodesByIndex when first needed, and dropped whenever a node is added or reconnected
+            std::shared_ptr<const ModelAdjacency> adjacency;
+
+            // The plans for the sets of outputs computed so far, keyed by the sorted outputs. Dropped along with the adjacency.
+            std::map<std::vector<const OutputPortBase*>, std::shared_ptr<const ComputePlan>> computePlans;
             utilities::PropertyBag metadata;
         };
 
@@ -404,6 +459,10 @@ namespace model
         Node::NodeId GetUniqueId(const Node::NodeId& desiredId);
         static Node::NodeId GetNextId(Node::NodeId id);
         const IDToNodeMap& GetNodeMap() const;
+        Node* GetNodeByIndex(size_t index) const;
+        void InvalidateAdjacency();
+        std::shared_ptr<const ComputePlan> GetComputePlan(std::vector<const OutputPortBase*> outputs) const;
+        void Compute(const ComputePlan& plan, size_t numThreads) const;
 
         template <typename Visitor>
         void VisitIteratedNodes(NodeIterator& iter, Visitor&& visitor) const;
@@ -513,7 +572,11 @@ namespace model
     template <typename NodeType, typename... Args>
     NodeType* Model::AddNode(Args&&... args)
     {
-        auto node = std::make_unique<NodeType>(detail::ModelNodeRouter::ConvertPortElementsArg(*this, std::forward<Args>(args))...);
+        std::unique_ptr<NodeType> node;
+        {
+            NodeArenaScope arenaScope(*_data->nodeArena);
+            node = std::make_unique<NodeType>(detail::ModelNodeRouter::ConvertPortElementsArg(*this, std::forward<Args>(args))...);
+        }
         auto result = node.get();
 
         detail::LogNewNode(result);
@@ -533,46 +596,40 @@ namespace model
     // Compute output value
     //
     template <typename ValueType>
-    std::vector<ValueType> Model::ComputeOutput(const OutputPort<ValueType>& outputPort) const
+    std::vector<ValueType> Model::ComputeOutput(const OutputPort<ValueType>& outputPort, size_t numThreads) const
     {
-        auto compute = [](const Node& node) { node.Compute(); };
-        VisitSubmodel({ &outputPort }, compute);
+        Compute(*GetComputePlan({ &outputPort }), numThreads);
         return outputPort.GetOutput();
     }
 
     template <typename ValueType>
-    std::vector<ValueType> Model::ComputeOutput(const PortElements<ValueType>& elements) const
+    std::vector<ValueType> Model::ComputeOutput(const PortElements<ValueType>& elements, size_t numThreads) const
     {
-        // get set of ports to make sure we visit
-        std::unordered_set<const OutputPortBase*> usedPorts;
+        std::vector<const OutputPortBase*> ports;
         for (const auto& range : elements.GetRanges())
         {
-            usedPorts.insert(range.ReferencedPort());
+            ports.push_back(range.ReferencedPort());
         }
 
-        auto ports = std::vector<const OutputPortBase*>(usedPorts.begin(), usedPorts.end());
-        VisitSubmodel(ports, [](const Node& node) {
-            node.Compute();
-        });
+        Compute(*GetComputePlan(ports), numThreads);
 
-        // Now construct the output
-        auto numElements = elements.Size();
-        std::vector<ValueType> result(numElements);
-        for (size_t index = 0; index < numElements; ++index)
+        // Now construct the output, copying each range of a port's output at once
+        std::vector<ValueType> result;
+        result.reserve(elements.Size());
+        for (const auto& range : elements.GetRanges())
         {
-            auto element = elements.GetElement(index);
-            auto port = element.ReferencedPort();
-            auto portOutput = port->GetOutput()[element.GetIndex()];
-            result[index] = portOutput;
+            const auto& portOutput = range.ReferencedPort()->template GetOutput<ValueType>();
+            auto begin = portOutput.begin() + range.GetStartIndex();
+            result.insert(result.end(), begin, begin + range.Size());
         }
         return result;
     }
 
     template <typename ValueType>
-    std::vector<ValueType> Model::ComputeOutput(const PortElementsBase& elements) const
+    std::vector<ValueType> Model::ComputeOutput(const PortElementsBase& elements, size_t numThreads) const
     {
         auto typedElements = PortElements<ValueType>(elements);
-        return ComputeOutput(typedElements);
+        return ComputeOutput(typedElements, numThreads);
     }
 
     //
@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ModelAdjacency.h (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace ell
+{
+namespace model
+{
+    class Node;
+
+    /// <summary>
+    /// A compact, index-based snapshot of the connections between the nodes of a model, in compressed sparse row
+    /// form. Nodes are identified by Node::GetIndex(). Walking it touches a few contiguous arrays of integers
+    /// instead of chasing pointers through nodes and ports, and allocates nothing.
+    /// </summary>
+    struct ModelAdjacency
+    {
+        /// <summary> The value of a parent entry for an input port that isn't connected to a node of the model. </summary>
+        static constexpr size_t noNode = std::numeric_limits<size_t>::max();
+
+        /// <summary> The parents of node `i` are `parents[parentOffsets[i]]` to `parents[parentOffsets[i + 1] - 1]`, one entry for each of its input ports, in order. </summary>
+        std::vector<size_t> parentOffsets;
+
+        /// <summary> The parent node of each input port, or `noNode`. </summary>
+        std::vector<size_t> parents;
+
+        /// <summary> The dependents of node `i` are `children[childOffsets[i]]` to `children[childOffsets[i + 1] - 1]`. </summary>
+        std::vector<size_t> childOffsets;
+
+        /// <summary> The distinct nodes with an input connected to each node, in increasing order of index. </summary>
+        std::vector<size_t> children;
+
+        /// <summary> All the nodes, in an order in which each node comes after its parents. Of all such orders, it's the one closest to the order the nodes were added in. </summary>
+        std::vector<size_t> topologicalOrder;
+
+        /// <summary> Returns the number of nodes. </summary>
+        size_t NumNodes() const { return parentOffsets.empty() ? 0 : parentOffsets.size() - 1; }
+    };
+
+    /// <summary> Builds the adjacency structure of a set of nodes. </summary>
+    ///
+    /// <param name="nodesByIndex"> The nodes, where the node at position `i` has index `i`. </param>
+    ///
+    /// <returns> The adjacency structure. </returns>
+    ModelAdjacency BuildModelAdjacency(const std::vector<Node*>& nodesByIndex);
+} // namespace model
+} // namespace ell
@@ -24,7 +24,8 @@ namespace model
         diagonal,
         simple,
         winograd,
-        unrolled
+        unrolled,
+        autotune // benchmark each compatible method with the JIT and pick the fastest
     };
 
     // Interchange format:
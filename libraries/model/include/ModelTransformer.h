@@ -352,11 +352,13 @@ namespace model
         /// <summary>
         /// Assign ancestor to newly transformed or refined nodes. This maps relationship between nodes of original
         /// model and nodes of new model. Note that, this assumes new nodes are always appended at the end of existing
-        /// nodes. Thus, it assigns ancestor from the node at the end of model to the last node without ancestor.
+        /// nodes. Thus, it assigns ancestor to the nodes without one, starting at firstNewNodeIndex.
+        /// The new nodes also get the ancestor's "compileOptions" metadata, if they don't have their own.
         /// </summary>
         ///
         /// <param name="ancestorNode"> The ancestor node or the immediate parent node that contains ancestor information. </param>
-        void AssignNodeAncestor(const Node& ancestorNode);
+        /// <param name="firstNewNodeIndex"> The size of the new model before ancestorNode was transformed. </param>
+        void AssignNodeAncestor(const Node& ancestorNode, size_t firstNewNodeIndex);
 
         Model _model;
         TransformContext _context;
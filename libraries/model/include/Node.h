@@ -8,11 +8,15 @@
 
 #pragma once
 
+#include <utilities/include/Arena.h>
 #include <utilities/include/IArchivable.h>
 #include <utilities/include/MemoryLayout.h>
+#include <utilities/include/ParallelFor.h>
 #include <utilities/include/PropertyBag.h>
 #include <utilities/include/UniqueId.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -41,6 +45,13 @@ namespace model
 
         Node() = default;
 
+        /// <summary> Allocates a node. While a NodeArenaScope is active on the calling thread, the node comes from
+        /// its arena, and deleting the node doesn't free the memory, which goes away with the arena. </summary>
+        static void* operator new(size_t size);
+
+        /// <summary> Frees the memory of a node, unless it came from an arena. </summary>
+        static void operator delete(void* p);
+
         /// <summary> Type to use for our node id </summary>
         using NodeId = utilities::UniqueId;
 
@@ -49,6 +60,12 @@ namespace model
         /// <returns> The unique ID for this node </returns>
         const NodeId GetId() const { return _id; }
 
+        /// <summary> Returns the position of this node in the order nodes were added to its model. Indices are dense,
+        /// so per-node bookkeeping can be kept in arrays rather than hashed containers. </summary>
+        ///
+        /// <returns> The index of this node in its model </returns>
+        size_t GetIndex() const { return _index; }
+
         /// <summary> Returns the number of input ports for this node </summary>
         ///
         /// <returns> The number of input ports </returns>
@@ -170,6 +187,21 @@ namespace model
         /// <summary> Computes the output of this node and stores it in the output ports </summary>
         virtual void Compute() const = 0;
 
+        /// <summary>
+        /// Returns an estimate of the number of arithmetic operations (a multiply-add counts as two) one evaluation
+        /// of this node performs. The default is one operation per output element.
+        /// </summary>
+        virtual int64_t GetOperationCount() const;
+
+        /// <summary>
+        /// Returns an estimate of the number of bytes one evaluation of this node reads. The default is the size of
+        /// all the input ports; nodes that carry their own weights add those.
+        /// </summary>
+        virtual int64_t GetBytesRead() const;
+
+        /// <summary> Returns an estimate of the number of bytes one evaluation of this node writes. The default is the size of all the output ports. </summary>
+        virtual int64_t GetBytesWritten() const;
+
         /// <summary> Resets any state on the node, if any </summary>
         virtual void Reset() {}
 
@@ -193,6 +225,24 @@ namespace model
 
         virtual bool HasState() const { return true; }
 
+        /// <summary> Indicates if Compute can run on another thread while other nodes are being computed. Nodes that
+        /// compute through the global value context, or that call back into user code, return false so they're always
+        /// computed on the thread that asked for the model's output. </summary>
+        virtual bool CanComputeConcurrently() const { return true; }
+
+        /// <summary> Returns the number of threads Compute may use, as set by the model computing this node. </summary>
+        static size_t GetNumComputeThreads();
+
+        /// <summary> Calls `function(begin, end)` on blocks that split the range [0, count), on up to
+        /// GetNumComputeThreads() threads at once, with utilities::ParallelForRanges. Rethrows an exception thrown on
+        /// any of them. </summary>
+        ///
+        /// <param name="count"> The size of the range. </param>
+        /// <param name="minBlockSize"> The smallest block worth giving to a thread of its own. </param>
+        /// <param name="function"> The function to call on each block. </param>
+        template <typename FunctionType>
+        void ComputeInBlocks(size_t count, size_t minBlockSize, FunctionType&& function) const;
+
         void AddInputPort(InputPortBase* input);
         void AddOutputPort(OutputPortBase* output);
 
@@ -214,13 +264,56 @@ namespace model
         void SetId(Node::NodeId id);
         void SetModel(Model* model);
         void UpdateInputPorts();
+        static size_t SetNumComputeThreads(size_t numThreads);
 
         std::unique_ptr<Model> _model;
         NodeId _id;
+        size_t _index = 0;
         std::vector<InputPortBase*> _inputs;
         std::vector<OutputPortBase*> _outputs;
 
         utilities::PropertyBag _metadata;
     };
+
+    /// <summary>
+    /// Makes the nodes constructed on the calling thread come from an arena for as long as the scope exists. Models
+    /// use this to allocate their nodes in bulk from an arena they own. Scopes can be nested.
+    /// </summary>
+    class NodeArenaScope
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="arena"> The arena to allocate nodes from. It must outlive the nodes. </param>
+        NodeArenaScope(utilities::Arena& arena);
+
+        NodeArenaScope(const NodeArenaScope&) = delete;
+        NodeArenaScope& operator=(const NodeArenaScope&) = delete;
+
+        /// <summary> Destructor. Restores the arena of the enclosing scope, if any. </summary>
+        ~NodeArenaScope();
+
+    private:
+        utilities::Arena* _previousArena;
+    };
 } // namespace model
 } // namespace ell
+
+#pragma region implementation
+
+#include <algorithm>
+
+namespace ell
+{
+namespace model
+{
+    template <typename FunctionType>
+    void Node::ComputeInBlocks(size_t count, size_t minBlockSize, FunctionType&& function) const
+    {
+        auto numBlocks = std::max(std::min(GetNumComputeThreads(), count / std::max(minBlockSize, size_t{ 1 })), size_t{ 1 });
+        utilities::ParallelForRanges(count, numBlocks, function);
+    }
+} // namespace model
+} // namespace ell
+
+#pragma endregion implementation
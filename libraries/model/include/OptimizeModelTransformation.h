@@ -14,7 +14,10 @@ namespace ell
 {
 namespace model
 {
-    /// <summary> A transformation that invokes the registered transformations on a submodel. </summary>
+    /// <summary>
+    /// A transformation that invokes the registered transformations on a submodel. If the "searchNodeOptions" optimizer
+    /// option is set, it first chooses the compiler options of each node by profiling the model (see NodeOptionsSearch).
+    /// </summary>
     class OptimizeModelTransformation : public Transformation
     {
     public:
@@ -128,7 +128,7 @@ namespace model
     template <typename ValueType>
     void OutputNode<ValueType>::Compute() const
     {
-        _output.SetOutput(_input.GetValue());
+        _output.SetOutput(_input.GetValueReference());
     }
 
     template <typename ValueType>
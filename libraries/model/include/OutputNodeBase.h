@@ -57,6 +57,9 @@ namespace model
             return _outputBase.GetMemoryLayout().GetLogicalDimensionOrder() == order;
         }
 
+        /// <summary> Output nodes copy only the entries of a dynamic extent to the output. </summary>
+        bool SupportsDynamicExtent() const override { return true; }
+
     protected:
         OutputNodeBase(InputPortBase& input, OutputPortBase& output, const MemoryShape& shape);
         OutputNodeBase(const std::vector<InputPortBase*>& inputs, OutputPortBase& output, const MemoryShape& shape);
@@ -86,6 +89,9 @@ namespace model
         /// <param name="name"> The callback name to set. </param>
         void SetCallbackName(const std::string& name) { _callbackName = name; };
 
+        /// <summary> Sink callbacks always get all of the input. </summary>
+        bool SupportsDynamicExtent() const override { return false; }
+
     protected:
         SinkNodeBase(InputPortBase& input, InputPortBase& trigger, OutputPortBase& output, const MemoryShape& shape, const std::string& callbackName) :
             OutputNodeBase({ &input, &trigger }, output, shape),
@@ -129,6 +129,14 @@ namespace model
         template <typename IteratorType>
         void SetOutput(IteratorType begin, IteratorType end) const;
 
+        /// <summary> Gets the cached output from this port for writing in place, sized to the port's memory size.
+        /// The buffer is reused from one computation to the next, so it holds the previous output. </summary>
+        ///
+        /// <typeparam name="ValueType"> The fundamental type of the output </typeparam>
+        /// <returns> The cached output from this port </returns>
+        template <typename ValueType>
+        std::vector<ValueType>& GetOutputBuffer() const;
+
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
         /// <returns> The name of this type. </returns>
@@ -191,6 +199,11 @@ namespace model
         /// <returns> The cached output from this port </returns>
         const std::vector<ValueType>& GetOutput() const { return OutputPortBase::GetOutput<ValueType>(); }
 
+        /// <summary> Gets the cached output from this port for writing in place, sized to the port's memory size </summary>
+        ///
+        /// <returns> The cached output from this port </returns>
+        std::vector<ValueType>& GetOutputBuffer() const { return OutputPortBase::GetOutputBuffer<ValueType>(); }
+
         /// <summary> Returns one element of the cached output from this port </summary>
         ///
         /// <param name="index"> The index of the element to return </param>
@@ -255,6 +268,14 @@ namespace model
         std::get<VectorType>(_cachedOutput).assign(begin, end);
     }
 
+    template <typename ValueType>
+    std::vector<ValueType>& OutputPortBase::GetOutputBuffer() const
+    {
+        auto& buffer = std::get<std::vector<ValueType>>(_cachedOutput);
+        buffer.resize(Size());
+        return buffer;
+    }
+
     //
     // OutputPort
     //
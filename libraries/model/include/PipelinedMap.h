@@ -0,0 +1,219 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PipelinedMap.h (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "IRCompiledMap.h"
+#include "Map.h"
+#include "MapCompilerOptions.h"
+#include "ModelOptimizerOptions.h"
+#include "Node.h"
+#include "OutputPort.h"
+#include "Port.h"
+
+#include <utilities/include/ConcurrentRingBuffer.h>
+#include <utilities/include/Exception.h>
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ell
+{
+namespace model
+{
+    /// <summary>
+    /// Runs a map on a stream of frames as a pipeline: the model is cut into stages, each compiled separately and run
+    /// on its own thread (pinned to a core, where supported), with lock-free single-producer/single-consumer queues
+    /// between them. While one stage works on a frame, the previous stage can work on the next one, so the throughput
+    /// scales with the number of stages as long as they take about as long as each other. The results come out in the
+    /// order the frames were pushed, and stateful nodes see every frame in order, as with the unpipelined map.
+    /// </summary>
+    ///
+    /// <remarks>
+    /// The model is only cut where a single output port carries everything the rest of the model needs, and the cuts
+    /// are chosen to minimize the cost of the most expensive stage. The default cost of a node is its operation count,
+    /// which is a static estimate; for better balanced stages, pass the costs measured by profiling the map (see
+    /// `GetProfiledNodeCosts`). If the model has fewer places to cut than asked for, it gets fewer stages.
+    /// </remarks>
+    class PipelinedMap
+    {
+    public:
+        /// <summary> A function that returns the cost of computing a node. </summary>
+        using NodeCostFunction = std::function<double(const Node&)>;
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="map"> The map to run, which must have one input and one output. </param>
+        /// <param name="numStages"> The maximum number of stages to cut the model into. </param>
+        /// <param name="settings"> The options to compile each stage with. </param>
+        /// <param name="optimizerOptions"> The optimizer options to compile each stage with. </param>
+        /// <param name="cores"> The core to pin each stage's thread to, or empty to let the OS schedule them. </param>
+        /// <param name="queueSize"> The number of frames each queue between stages can hold. </param>
+        /// <param name="nodeCost"> The cost of each node of the map's model, or empty to use its operation count. </param>
+        PipelinedMap(const Map& map,
+                     int numStages,
+                     const MapCompilerOptions& settings = {},
+                     const ModelOptimizerOptions& optimizerOptions = {},
+                     const std::vector<int>& cores = {},
+                     int queueSize = 4,
+                     NodeCostFunction nodeCost = {});
+
+        PipelinedMap(const PipelinedMap&) = delete;
+        PipelinedMap& operator=(const PipelinedMap&) = delete;
+
+        /// <summary> Destructor. Stops the stages' threads, discarding any frames still in the pipeline. </summary>
+        ~PipelinedMap();
+
+        /// <summary> Gets the number of stages the model was cut into. </summary>
+        int NumStages() const { return static_cast<int>(_stages.size()); }
+
+        /// <summary> Gets the map a stage runs. </summary>
+        const Map& GetStageMap(int stage) const { return _stages[stage]->map; }
+
+        /// <summary> Gets the number of elements of an input frame. </summary>
+        size_t GetInputSize() const { return _inputSize; }
+
+        /// <summary> Gets the number of elements of a result. </summary>
+        size_t GetOutputSize() const { return _outputSize; }
+
+        /// <summary> Adds a frame to the pipeline, if the first stage's queue has room. </summary>
+        ///
+        /// <param name="input"> The frame, which must hold `GetInputSize()` elements of the map's input type. </param>
+        ///
+        /// <returns> true if the frame was added, false if the pipeline is full. </returns>
+        template <typename InputType>
+        bool TryPushFrame(const InputType* input);
+
+        /// <summary> Adds a frame to the pipeline, waiting for room in the first stage's queue. </summary>
+        ///
+        /// <param name="input"> The frame, which must hold `GetInputSize()` elements of the map's input type. </param>
+        template <typename InputType>
+        void PushFrame(const InputType* input);
+
+        /// <summary> Gets the result of the oldest frame, if it has come out of the pipeline. </summary>
+        ///
+        /// <param name="output"> The result, which must have room for `GetOutputSize()` elements of the map's output type. </param>
+        ///
+        /// <returns> true if a result was written to `output`, false if none is ready. </returns>
+        template <typename OutputType>
+        bool TryPopResult(OutputType* output);
+
+        /// <summary> Gets the result of the oldest frame, waiting for it to come out of the pipeline. There must be a
+        /// frame in the pipeline, or this waits forever. </summary>
+        ///
+        /// <param name="output"> The result, which must have room for `GetOutputSize()` elements of the map's output type. </param>
+        template <typename OutputType>
+        void PopResult(OutputType* output);
+
+        /// <summary> Gets the output ports of a map's model that the model would be cut at, one fewer than the number of stages. </summary>
+        ///
+        /// <param name="map"> The map, which must have one input and one output. </param>
+        /// <param name="numStages"> The maximum number of stages. </param>
+        /// <param name="nodeCost"> The cost of each node, or empty to use its operation count. </param>
+        ///
+        /// <returns> The ports to cut the model at, in the order they're computed. </returns>
+        static std::vector<const OutputPortBase*> GetStageBoundaries(const Map& map, int numStages, NodeCostFunction nodeCost = {});
+
+        /// <summary> Gets the time spent in each node of a map, measured by running a compiled version of it with the
+        /// `profile` option, to balance the stages with. </summary>
+        ///
+        /// <param name="profiledMap"> The map compiled with profiling, after running it on some representative input. </param>
+        ///
+        /// <returns> A cost function for the nodes of the map the profiled map was compiled from. </returns>
+        static NodeCostFunction GetProfiledNodeCosts(IRCompiledMap& profiledMap);
+
+    private:
+        using Frame = std::vector<char>;
+        using FrameQueue = utilities::ConcurrentRingBuffer<Frame>;
+
+        struct Stage
+        {
+            Stage(Map map, IRCompiledMap compiledMap);
+
+            Map map;
+            IRCompiledMap compiledMap;
+            std::function<void(const void*, void*)> predict;
+            std::thread thread;
+        };
+
+        void RunStage(int index);
+        void CheckInputType(Port::PortType type) const;
+        void CheckOutputType(Port::PortType type) const;
+
+        std::vector<std::unique_ptr<Stage>> _stages;
+        std::vector<std::unique_ptr<FrameQueue>> _queues; // _queues[i] feeds _stages[i], and the last one holds the results
+        Port::PortType _inputType;
+        Port::PortType _outputType;
+        size_t _inputSize = 0;
+        size_t _outputSize = 0;
+        std::atomic<bool> _stopping{ false };
+    };
+} // namespace model
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace model
+{
+    template <typename InputType>
+    bool PipelinedMap::TryPushFrame(const InputType* input)
+    {
+        CheckInputType(Port::GetPortType<InputType>());
+        auto& queue = *_queues.front();
+        auto frame = queue.BeginPush();
+        if (frame == nullptr)
+        {
+            return false;
+        }
+        std::memcpy(frame->data(), input, _inputSize * sizeof(InputType));
+        queue.EndPush();
+        return true;
+    }
+
+    template <typename InputType>
+    void PipelinedMap::PushFrame(const InputType* input)
+    {
+        while (!TryPushFrame(input))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    template <typename OutputType>
+    bool PipelinedMap::TryPopResult(OutputType* output)
+    {
+        CheckOutputType(Port::GetPortType<OutputType>());
+        auto& queue = *_queues.back();
+        auto frame = queue.BeginPop();
+        if (frame == nullptr)
+        {
+            return false;
+        }
+        std::memcpy(output, frame->data(), _outputSize * sizeof(OutputType));
+        queue.EndPop();
+        return true;
+    }
+
+    template <typename OutputType>
+    void PipelinedMap::PopResult(OutputType* output)
+    {
+        while (!TryPopResult(output))
+        {
+            std::this_thread::yield();
+        }
+    }
+} // namespace model
+} // namespace ell
+
+#pragma endregion implementation
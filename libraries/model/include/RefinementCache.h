@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     RefinementCache.h (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Model.h"
+#include "OutputPort.h"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ell
+{
+namespace model
+{
+    class InputPortBase;
+    class ModelTransformer;
+    class Node;
+    class TransformContext;
+
+    /// <summary>
+    /// Returns a key that identifies the content of a node, for the purpose of refining it: its type, its archived
+    /// state and metadata (but not its id or ancestor), the type, size, and memory layout of its inputs, and which of its
+    /// inputs read from the same port. If the context has a compiler, the compiler options for the node are included.
+    /// Two nodes with the same key refine to the same subgraph.
+    /// </summary>
+    ///
+    /// <param name="node"> The node. </param>
+    /// <param name="context"> The context the node is being transformed in. </param>
+    ///
+    /// <returns> A string that is (with very high probability) unique to the content of the node. </returns>
+    std::string GetNodeContentKey(const Node& node, const TransformContext& context);
+
+    /// <summary>
+    /// A cache of the subgraphs that nodes refine into, keyed by the content of the node (see `GetNodeContentKey`).
+    /// When a node is refined during a transformation whose context has a cache, the nodes it refines into are
+    /// stored in a small model of their own, with placeholder inputs standing in for the node's inputs. The next
+    /// time a node with the same content is refined, the stored subgraph is copied into place instead of calling
+    /// the node's `Refine` function, so rebuilding a model after a local change only refines the nodes that changed.
+    /// Refinement is assumed to depend only on the node and its inputs' shapes, not on the rest of the model.
+    /// </summary>
+    class RefinementCache
+    {
+    public:
+        /// <summary> Copies the refinement stored for a node into the model being built by the transformer, if there is one. </summary>
+        ///
+        /// <param name="key"> The content key of the node. </param>
+        /// <param name="node"> The node being refined. </param>
+        /// <param name="transformer"> The transformer refining the node. Its outputs for `node` are mapped to the copied subgraph. </param>
+        ///
+        /// <returns> `true` if the cache had an entry for the node. </returns>
+        bool ReplayRefinement(const std::string& key, const Node& node, ModelTransformer& transformer);
+
+        /// <summary>
+        /// Stores the nodes that a node was just refined into. Refinements that read from ports other than the
+        /// node's corresponding inputs can't be replayed elsewhere, and aren't stored.
+        /// </summary>
+        ///
+        /// <param name="key"> The content key of the node. </param>
+        /// <param name="node"> The node that was refined. </param>
+        /// <param name="transformer"> The transformer that refined the node. </param>
+        /// <param name="firstNewNodeIndex"> The index of the first node the refinement added to the transformer's model. </param>
+        void StoreRefinement(const std::string& key, const Node& node, ModelTransformer& transformer, size_t firstNewNodeIndex);
+
+        /// <summary> Removes all entries from the cache and resets the statistics. </summary>
+        void Clear();
+
+        /// <summary> Gets the number of entries in the cache. </summary>
+        size_t NumEntries() const;
+
+        /// <summary> Gets the number of refinements that were replayed from the cache. </summary>
+        size_t NumHits() const;
+
+        /// <summary> Gets the number of lookups that didn't find an entry. </summary>
+        size_t NumMisses() const;
+
+        /// <summary> Gets the cache shared by all compilations in this process. </summary>
+        static RefinementCache& GetGlobalCache();
+
+    private:
+        struct Entry
+        {
+            Model model;
+            std::vector<const InputPortBase*> inputs; // the ports in `model` that read from the placeholder inputs
+            std::vector<size_t> inputIndices; // for each of `inputs`, the index of the node input it stands for
+            std::vector<const OutputPortBase*> outputs; // the distinct ports in `model` that the node's outputs map to
+            std::vector<int> outputIndices; // for each node output, an index into `outputs`, or -(1 + input index) for an output that passes an input through
+        };
+
+        mutable std::mutex _mutex;
+        std::unordered_map<std::string, std::shared_ptr<const Entry>> _entries;
+        size_t _numHits = 0;
+        size_t _numMisses = 0;
+    };
+} // namespace model
+} // namespace ell
@@ -121,9 +121,8 @@ namespace model
     template <typename ValueType>
     void SliceNode<ValueType>::Compute() const
     {
-        auto input = _input.GetValue();
-        auto output = std::vector<ValueType>(input.begin() + _largestDimensionStart, input.begin() + _largestDimensionStart + _largestDimensionCount);
-        _output.SetOutput(output);
+        const auto& input = _input.GetValueReference();
+        _output.SetOutput(input.begin() + _largestDimensionStart, input.begin() + _largestDimensionStart + _largestDimensionCount);
     }
 
     template <typename ValueType>
@@ -134,13 +133,19 @@ namespace model
             throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Input and output port types must match");
         }
 
-        auto input = function.LocalArray(compiler.EnsurePortEmitted(_input));
-        auto output = function.LocalArray(compiler.EnsurePortEmitted(_output));
-
         auto layout = _input.GetReferencedPort().GetMemoryLayout();
         const auto increment = layout.GetCumulativeIncrement(0); // slowest-moving dimension
         const auto inputOffset = static_cast<int>(_largestDimensionStart * increment);
         const auto rangeSize = _largestDimensionCount * increment;
+
+        // The slice is a contiguous part of the input, so the output can just point into it
+        if (static_cast<size_t>(rangeSize) == _output.Size() && compiler.TryAliasPort(_output, _input.GetReferencedPort(), inputOffset))
+        {
+            return;
+        }
+
+        auto input = function.LocalArray(compiler.EnsurePortEmitted(_input));
+        auto output = function.LocalArray(compiler.EnsurePortEmitted(_output));
         function.For(rangeSize, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar i) {
             output[i] = input[inputOffset + i];
         });
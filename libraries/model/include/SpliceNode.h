@@ -58,6 +58,9 @@ namespace model
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Gets the entry of the output that an input's values are copied to. </summary>
+        int GetInPlaceInputOffset(const InputPortBase& input) const override;
+
     protected:
         void Compute() const override;
         void Compile(IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
@@ -142,17 +145,37 @@ namespace model
         return elements.GetMemoryLayout();
     }
 
+    template <typename ValueType>
+    int SpliceNode<ValueType>::GetInPlaceInputOffset(const InputPortBase& input) const
+    {
+        // A single scalar input is stored as a scalar, not copied
+        if (_inputPorts.size() == 1 && _inputPorts[0]->Size() == 1)
+        {
+            return -1;
+        }
+
+        int rangeStart = 0;
+        for (const auto& inputPort : _inputPorts)
+        {
+            if (inputPort.get() == &input)
+            {
+                return rangeStart;
+            }
+            rangeStart += static_cast<int>(inputPort->GetReferencedPort().Size());
+        }
+        return -1;
+    }
+
     template <typename ValueType>
     void SpliceNode<ValueType>::Compute() const
     {
-        std::vector<ValueType> output;
-        output.reserve(_output.Size());
+        auto& output = _output.GetOutputBuffer();
+        auto outputIter = output.begin();
         for (const auto& input : _inputPorts)
         {
-            auto value = input->GetValue();
-            std::copy(value.begin(), value.end(), std::back_inserter(output));
+            const auto& value = input->GetValueReference();
+            outputIter = std::copy(value.begin(), value.end(), outputIter);
         }
-        _output.SetOutput(output);
     }
 
     template <typename ValueType>
@@ -172,13 +195,17 @@ namespace model
                 for (const auto& inputPort : _inputPorts)
                 {
                     const auto& referencedPort = inputPort->GetReferencedPort();
-                    auto input = function.LocalArray(compiler.EnsurePortEmitted(referencedPort));
-                    auto output = function.LocalArray(pOutput);
                     auto rangeSize = referencedPort.Size();
 
-                    function.For(rangeSize, [=](emitters::IRFunctionEmitter& function, auto i) {
-                        output[i + rangeStart] = input[i];
-                    });
+                    // Inputs computed in place are already in the output
+                    if (!compiler.IsPortAliasOf(referencedPort, _output, rangeStart))
+                    {
+                        auto input = function.LocalArray(compiler.EnsurePortEmitted(referencedPort));
+                        auto output = function.LocalArray(pOutput);
+                        function.For(rangeSize, [=](emitters::IRFunctionEmitter& function, auto i) {
+                            output[i + rangeStart] = input[i];
+                        });
+                    }
                     rangeStart += rangeSize;
                 }
             }
@@ -29,6 +29,7 @@ namespace ell
 namespace model
 {
     class MapCompiler;
+    class RefinementCache;
 
     /// <summary> An action to perform on a node during transformation (refinement/compilation) </summary>
     enum class NodeAction
@@ -92,9 +93,20 @@ namespace model
         /// <returns> A `NodeAction` enum indicating what action to take on the node </returns>
         NodeAction GetNodeAction(const Node& node) const;
 
+        /// <summary> Sets the cache to look up refined nodes in, and to store them in. </summary>
+        ///
+        /// <param name="cache"> The cache to use, or nullptr to refine every node. </param>
+        void SetRefinementCache(RefinementCache* cache) { _refinementCache = cache; }
+
+        /// <summary> Gets the cache of refined nodes. </summary>
+        ///
+        /// <returns> A pointer to the cache (or nullptr if refinement isn't cached). </returns>
+        RefinementCache* GetRefinementCache() const { return _refinementCache; }
+
     private:
         std::vector<NodeActionFunction> _nodeActionFunctions;
         const MapCompiler* _compiler;
+        RefinementCache* _refinementCache = nullptr;
     };
 } // namespace model
 } // namespace ell
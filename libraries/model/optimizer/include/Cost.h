@@ -11,6 +11,7 @@
 #include <string>
 #include <unordered_map>
 #include <variant>
+#include <vector>
 
 namespace ell
 {
@@ -60,6 +61,9 @@ namespace model
 
             double GetValue() const;
 
+            /// <summary> Returns the variance of a measured value, or 0 for other values. </summary>
+            double GetVariance() const;
+
             template <typename T>
             bool IsCostType() const
             {
@@ -78,6 +82,9 @@ namespace model
             CostValue GetCostComponent(std::string name) const;
             CostValue& operator[](std::string name);
 
+            /// <summary> Returns the names of the components of the cost. </summary>
+            std::vector<std::string> GetCostComponentNames() const;
+
         protected:
             Cost(const std::unordered_map<std::string, CostValue>& components);
             std::unordered_map<std::string, CostValue> _components;
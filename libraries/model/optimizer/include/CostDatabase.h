@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     CostDatabase.h (model/optimizer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Cost.h"
+#include "Environment.h"
+
+#include <model/include/OutputNode.h>
+#include <model/include/Port.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/Hash.h>
+#include <utilities/include/MemoryLayout.h>
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace ell
+{
+namespace model
+{
+    namespace optimizer
+    {
+        //
+        // Databases for storing performance measurements (or heuristics)
+        //
+
+        struct PortDescription
+        {
+            Port::PortType type;
+            utilities::MemoryLayout layout;
+        };
+        bool operator==(const PortDescription& a, const PortDescription& b);
+
+        struct NodeDescription
+        {
+            std::vector<PortDescription> inputs;
+            std::vector<PortDescription> outputs;
+            std::string type;
+        };
+        bool operator==(const NodeDescription& a, const NodeDescription& b);
+
+        struct SubmodelDescription
+        {
+            std::vector<PortDescription> inputs;
+            std::vector<PortDescription> outputs;
+            std::vector<NodeDescription> nodes;
+        };
+        bool operator==(const SubmodelDescription& a, const SubmodelDescription& b);
+
+        using EnvironmentDescription = std::string;
+
+        PortDescription GetDescription(const Port& port);
+        NodeDescription GetDescription(const Node& node);
+        SubmodelDescription GetDescription(const Submodel& submodel);
+        EnvironmentDescription GetDescription(const Environment& environment);
+
+        class CostDatabase
+        {
+        public:
+            bool HasCostMeasurement(const Submodel& submodel, const Environment& environment) const;
+            Cost GetCostMeasurement(const Submodel& submodel, const Environment& environment) const;
+            void AddCostMeasurement(const Submodel& submodel, const Environment& environment, const Cost& cost);
+
+            /// <summary>
+            /// Per-node measurements: the cost of a group of nodes (usually the nodes refined from one original node)
+            /// when compiled with the given options. The options are described by a string, such as "parallelize=true".
+            /// </summary>
+            bool HasCostMeasurement(const std::vector<const Node*>& nodes, const std::string& options, const Environment& environment) const;
+            Cost GetCostMeasurement(const std::vector<const Node*>& nodes, const std::string& options, const Environment& environment) const;
+            void AddCostMeasurement(const std::vector<const Node*>& nodes, const std::string& options, const Environment& environment, const Cost& cost);
+
+            /// <summary> Writes the per-node measurements to a stream, one per line, so that a later search can reuse them. </summary>
+            void WriteNodeMeasurements(std::ostream& stream) const;
+
+            /// <summary> Reads per-node measurements written by `WriteNodeMeasurements`, replacing any measurements of the same nodes and options. </summary>
+            void ReadNodeMeasurements(std::istream& stream);
+
+        private:
+            using Key = std::tuple<SubmodelDescription, EnvironmentDescription>;
+            struct KeyHash
+            {
+                size_t operator()(const Key& key) const;
+            };
+
+            // The nodes are described by a string, so the measurements can be written out and read back
+            using NodeKey = std::tuple<std::string, std::string, EnvironmentDescription>;
+            struct NodeKeyHash
+            {
+                size_t operator()(const NodeKey& key) const;
+            };
+
+            Key NullKey() const;
+            Key GetMeasurementKey(const Submodel& submodel, const Environment& environment) const;
+            NodeKey GetMeasurementKey(const std::vector<const Node*>& nodes, const std::string& options, const Environment& environment) const;
+
+            // map from (submodel, environment) -> cost
+            // break it down into individual node types
+            std::unordered_map<Key, Cost, KeyHash> _measurements;
+
+            // map from (nodes, options, environment) -> cost
+            std::unordered_map<NodeKey, Cost, NodeKeyHash> _nodeMeasurements;
+        };
+    } // namespace optimizer
+} // namespace model
+} // namespace ell
+
+namespace std
+{
+template <>
+struct hash<ell::model::optimizer::PortDescription>
+{
+    size_t operator()(const ell::model::optimizer::PortDescription& arg) const;
+};
+
+template <>
+struct hash<ell::model::optimizer::NodeDescription>
+{
+    size_t operator()(const ell::model::optimizer::NodeDescription& arg) const;
+};
+
+template <>
+struct hash<ell::model::optimizer::SubmodelDescription>
+{
+    size_t operator()(const ell::model::optimizer::SubmodelDescription& arg) const;
+};
+} // namespace std
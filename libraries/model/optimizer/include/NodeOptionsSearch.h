@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     NodeOptionsSearch.h (model/optimizer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CostDatabase.h"
+
+#include <model/include/Map.h>
+#include <model/include/MapCompilerOptions.h>
+#include <model/include/ModelOptimizerOptions.h>
+#include <model/include/Transformation.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace model
+{
+    namespace optimizer
+    {
+        /// <summary> A per-node compiler option the search can choose, and the values to try for it. </summary>
+        struct SearchOption
+        {
+            std::string name; // the name of the option in a node's "compileOptions" metadata
+            std::vector<std::string> values;
+            std::string nodeTypePrefix; // the option is only set on nodes whose type name starts with this (on every node if empty)
+        };
+
+        /// <summary> Returns the options searched by default: the convolution method, vectorization and parallelization. </summary>
+        std::vector<SearchOption> GetDefaultSearchOptions();
+
+        /// <summary>
+        /// Returns the id of the node in the original model that a node was copied or refined from, taken from its
+        /// "ancestor" metadata, or the node's own id if it doesn't have any.
+        /// </summary>
+        std::string GetNodeAncestor(const Node& node);
+
+        /// <summary>
+        /// Chooses compiler options for the nodes of a map by compiling it with profiling turned on, once for each value
+        /// of an option, and giving each node the value it ran fastest with. The options are chosen one at a time, keeping
+        /// the earlier choices. Nodes are grouped by ancestor, so a node the compiler refines into several nodes is timed,
+        /// and gets its options, as a unit. The measurements are kept in a CostDatabase, keyed by the nodes and their
+        /// options, so they are reused for nodes that look the same.
+        /// </summary>
+        class NodeOptionsSearch
+        {
+        public:
+            using NodeOptions = std::map<std::string, std::string>; // option name -> value
+
+            /// <summary> Constructor </summary>
+            ///
+            /// <param name="options"> The options to choose, in the order they're chosen. </param>
+            /// <param name="database"> The database to keep the measurements in. </param>
+            /// <param name="numProfileRuns"> The number of times to run each compiled map. </param>
+            NodeOptionsSearch(std::vector<SearchOption> options, CostDatabase& database, int numProfileRuns = 10);
+
+            /// <summary> Finds the fastest options for the nodes of a map. </summary>
+            ///
+            /// <param name="map"> The map to optimize. It must have a single input. </param>
+            /// <param name="settings"> The settings to compile the map with. </param>
+            /// <param name="optimizerOptions"> The optimizer options to compile the map with. </param>
+            ///
+            /// <returns>
+            /// The options chosen for each group of nodes, keyed by their ancestor. Empty if the map can't be profiled,
+            /// which is the case when it doesn't have a single input or isn't compiled for the host.
+            /// </returns>
+            std::map<std::string, NodeOptions> FindNodeOptions(const Map& map, const MapCompilerOptions& settings, const ModelOptimizerOptions& optimizerOptions);
+
+        private:
+            // Returns the time per run of each group of nodes, in milliseconds
+            std::map<std::string, double> ProfileMap(const Map& map, const std::map<std::string, NodeOptions>& nodeOptions, const MapCompilerOptions& settings, const ModelOptimizerOptions& optimizerOptions) const;
+
+            std::vector<SearchOption> _options;
+            CostDatabase& _database;
+            int _numProfileRuns;
+        };
+
+        /// <summary> Adds the options chosen by a NodeOptionsSearch to the "compileOptions" metadata of the nodes of a model. </summary>
+        ///
+        /// <param name="model"> The model, usually the one the map given to the search was made from. </param>
+        /// <param name="choices"> The options chosen for each group of nodes, keyed by their ancestor. </param>
+        void SetNodeOptions(Model& model, const std::map<std::string, NodeOptionsSearch::NodeOptions>& choices);
+
+        /// <summary>
+        /// A transformation that sets the "compileOptions" metadata of each node to the options found by a NodeOptionsSearch.
+        /// It is run by OptimizeModelTransformation when the "searchNodeOptions" optimizer option is set.
+        /// </summary>
+        class NodeOptionsSearchTransformation : public Transformation
+        {
+        public:
+            /// <summary> Constructor that searches the default options. </summary>
+            NodeOptionsSearchTransformation();
+
+            /// <summary> Constructor </summary>
+            ///
+            /// <param name="options"> The options to choose, in the order they're chosen. </param>
+            /// <param name="numProfileRuns"> The number of times to run each compiled map. </param>
+            NodeOptionsSearchTransformation(std::vector<SearchOption> options, int numProfileRuns = 10);
+
+            /// <summary> Returns a copy of the submodel whose nodes have the options that make them fastest. </summary>
+            Submodel Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const override;
+
+            /// <summary> Gets the name of this type. </summary>
+            static std::string GetTypeName() { return "NodeOptionsSearchTransformation"; }
+
+            /// <summary> Gets the name of this type. </summary>
+            std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        private:
+            std::vector<SearchOption> _options;
+            int _numProfileRuns;
+            mutable CostDatabase _database; // measurements are reused by later transforms
+        };
+    } // namespace optimizer
+} // namespace model
+} // namespace ell
@@ -48,6 +48,15 @@ namespace model
             return std::visit([](auto&& arg) { return arg.GetValue(); }, _value);
         }
 
+        double CostValue::GetVariance() const
+        {
+            if (auto measuredValue = std::get_if<MeasuredCostValue>(&_value))
+            {
+                return measuredValue->GetVariance();
+            }
+            return 0;
+        }
+
         // Cost
         Cost::Cost(const std::unordered_map<std::string, CostValue>& components) :
             _components(components)
@@ -73,6 +82,16 @@ namespace model
         {
             return _components[name];
         }
+
+        std::vector<std::string> Cost::GetCostComponentNames() const
+        {
+            std::vector<std::string> result;
+            for (const auto& component : _components)
+            {
+                result.push_back(component.first);
+            }
+            return result;
+        }
     } // namespace optimizer
 } // namespace model
 } // namespace ell
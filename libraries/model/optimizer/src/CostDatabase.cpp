@@ -0,0 +1,317 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     CostDatabase.cpp (model/optimizer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CostDatabase.h"
+
+#include <model/include/InputNode.h>
+#include <model/include/Model.h>
+#include <model/include/OutputNode.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/StlVectorUtil.h>
+#include <utilities/include/StringUtil.h>
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+namespace ell
+{
+namespace model
+{
+    namespace optimizer
+    {
+        namespace
+        {
+            template <typename Container, typename Function>
+            auto Transform(const Container& container, Function fn)
+            {
+                return utilities::TransformVector(container.begin(), container.end(), fn);
+            }
+
+            template <typename T>
+            void WriteValues(std::ostream& stream, const std::vector<T>& values)
+            {
+                for (size_t index = 0; index < values.size(); ++index)
+                {
+                    stream << (index == 0 ? "" : ",") << values[index];
+                }
+            }
+
+            void WriteDescription(std::ostream& stream, const PortDescription& port)
+            {
+                const auto& layout = port.layout;
+                stream << static_cast<int>(port.type) << ":";
+                WriteValues(stream, layout.GetActiveSize().ToVector());
+                stream << ":";
+                WriteValues(stream, layout.GetExtent().ToVector());
+                stream << ":";
+                WriteValues(stream, layout.GetOffset().ToVector());
+                stream << ":";
+                WriteValues(stream, layout.GetLogicalDimensionOrder().ToVector());
+            }
+
+            void WriteDescription(std::ostream& stream, const std::vector<PortDescription>& ports)
+            {
+                stream << "(";
+                for (size_t index = 0; index < ports.size(); ++index)
+                {
+                    stream << (index == 0 ? "" : " ");
+                    WriteDescription(stream, ports[index]);
+                }
+                stream << ")";
+            }
+
+            // Describes nodes by their types and the types and layouts of their ports, e.g. "BinaryOperationNode<float>(1:4:4:0:0 1:4:4:0:0)(1:4:4:0:0)"
+            std::string GetNodesKey(const std::vector<const Node*>& nodes)
+            {
+                std::ostringstream stream;
+                for (size_t index = 0; index < nodes.size(); ++index)
+                {
+                    auto description = GetDescription(*nodes[index]);
+                    stream << (index == 0 ? "" : " ") << description.type;
+                    WriteDescription(stream, description.inputs);
+                    WriteDescription(stream, description.outputs);
+                }
+                return stream.str();
+            }
+        } // namespace
+
+        PortDescription GetDescription(const Port& port)
+        {
+            return { port.GetType(), port.GetMemoryLayout() };
+        }
+
+        NodeDescription GetDescription(const Node& node)
+        {
+            auto inputs = Transform(node.GetInputPorts(), [](InputPortBase* port) { return GetDescription(*port); });
+            auto outputs = Transform(node.GetOutputPorts(), [](OutputPortBase* port) { return GetDescription(*port); });
+            return { inputs, outputs, node.GetRuntimeTypeName() };
+        }
+
+        SubmodelDescription GetDescription(const Submodel& submodel)
+        {
+            auto inputs = Transform(submodel.GetInputs(), [](const InputPortBase* port) { return GetDescription(*port); });
+            auto outputs = Transform(submodel.GetOutputs(), [](const OutputPortBase* port) { return GetDescription(*port); });
+            std::vector<NodeDescription> nodes;
+            submodel.Visit([&nodes](const Node& node) {
+                nodes.push_back(GetDescription(node));
+            });
+            return { inputs, outputs, nodes };
+        }
+
+        EnvironmentDescription GetDescription(const Environment& environment)
+        {
+            return environment.GetTargetDevice().deviceName;
+        }
+
+        bool operator==(const PortDescription& a, const PortDescription& b)
+        {
+            return (a.type == b.type) && (a.layout == b.layout);
+        }
+
+        bool operator==(const NodeDescription& a, const NodeDescription& b)
+        {
+            return (a.inputs == b.inputs) && (a.outputs == b.outputs) && (a.type == b.type);
+        }
+
+        bool operator==(const SubmodelDescription& a, const SubmodelDescription& b)
+        {
+            return (a.inputs == b.inputs) && (a.outputs == b.outputs) && (a.nodes == b.nodes);
+        }
+
+        // CostDatabase
+        bool CostDatabase::HasCostMeasurement(const Submodel& submodel, const Environment& environment) const
+        {
+            auto key = GetMeasurementKey(submodel, environment);
+            return _measurements.find(key) != _measurements.end();
+        }
+
+        Cost CostDatabase::GetCostMeasurement(const Submodel& submodel, const Environment& environment) const
+        {
+            if (!HasCostMeasurement(submodel, environment))
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument);
+            }
+
+            auto key = GetMeasurementKey(submodel, environment);
+            return _measurements.at(key);
+        }
+
+        void CostDatabase::AddCostMeasurement(const Submodel& submodel, const Environment& environment, const Cost& cost)
+        {
+            auto key = GetMeasurementKey(submodel, environment);
+            _measurements[key] = cost;
+        }
+
+        bool CostDatabase::HasCostMeasurement(const std::vector<const Node*>& nodes, const std::string& options, const Environment& environment) const
+        {
+            auto key = GetMeasurementKey(nodes, options, environment);
+            return _nodeMeasurements.find(key) != _nodeMeasurements.end();
+        }
+
+        Cost CostDatabase::GetCostMeasurement(const std::vector<const Node*>& nodes, const std::string& options, const Environment& environment) const
+        {
+            if (!HasCostMeasurement(nodes, options, environment))
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument);
+            }
+
+            auto key = GetMeasurementKey(nodes, options, environment);
+            return _nodeMeasurements.at(key);
+        }
+
+        void CostDatabase::AddCostMeasurement(const std::vector<const Node*>& nodes, const std::string& options, const Environment& environment, const Cost& cost)
+        {
+            auto key = GetMeasurementKey(nodes, options, environment);
+            _nodeMeasurements[key] = cost;
+        }
+
+        void CostDatabase::WriteNodeMeasurements(std::ostream& stream) const
+        {
+            // Each line has the environment, options, nodes and cost components, separated by tabs. The components are
+            // written as "name=kind:value:variance", where the kind is "m" for measured and "h" for heuristic values.
+            stream.precision(17);
+            for (const auto& measurement : _nodeMeasurements)
+            {
+                const auto& [nodes, options, environment] = measurement.first;
+                stream << environment << "\t" << options << "\t" << nodes << "\t";
+                const auto& cost = measurement.second;
+                auto names = cost.GetCostComponentNames();
+                std::sort(names.begin(), names.end());
+                bool isFirst = true;
+                for (const auto& name : names)
+                {
+                    auto value = cost.GetCostComponent(name);
+                    if (!value.IsCostType<MeasuredCostValue>() && !value.IsCostType<HeuristicCostValue>())
+                    {
+                        continue;
+                    }
+                    stream << (isFirst ? "" : ";") << name << "=" << (value.IsCostType<MeasuredCostValue>() ? "m" : "h") << ":" << value.GetValue() << ":" << value.GetVariance();
+                    isFirst = false;
+                }
+                stream << "\n";
+            }
+        }
+
+        void CostDatabase::ReadNodeMeasurements(std::istream& stream)
+        {
+            std::string line;
+            while (std::getline(stream, line))
+            {
+                if (line.empty())
+                {
+                    continue;
+                }
+
+                auto fields = utilities::Split(line, '\t');
+                if (fields.size() != 4)
+                {
+                    throw utilities::DataFormatException(utilities::DataFormatErrors::badFormat, "Bad cost database line: " + line);
+                }
+
+                Cost cost;
+                for (const auto& component : utilities::Split(fields[3], ';'))
+                {
+                    if (component.empty())
+                    {
+                        continue;
+                    }
+
+                    auto nameAndValue = utilities::Split(component, '=');
+                    auto values = nameAndValue.size() == 2 ? utilities::Split(nameAndValue[1], ':') : std::vector<std::string>{};
+                    if (values.size() != 3 || (values[0] != "m" && values[0] != "h"))
+                    {
+                        throw utilities::DataFormatException(utilities::DataFormatErrors::badFormat, "Bad cost component: " + component);
+                    }
+
+                    auto value = std::stod(values[1]);
+                    if (values[0] == "m")
+                    {
+                        cost[nameAndValue[0]] = MeasuredCostValue(value, std::stod(values[2]));
+                    }
+                    else
+                    {
+                        cost[nameAndValue[0]] = HeuristicCostValue(value);
+                    }
+                }
+                _nodeMeasurements[{ fields[2], fields[1], fields[0] }] = cost;
+            }
+        }
+
+        CostDatabase::Key CostDatabase::GetMeasurementKey(const Submodel& submodel, const Environment& environment) const
+        {
+            if (!environment.HasTargetDevice() || submodel.NumOutputs() == 0)
+            {
+                return NullKey();
+            }
+
+            auto submodelDesc = GetDescription(submodel);
+            auto environmentDesc = GetDescription(environment);
+            return { submodelDesc, environmentDesc };
+        }
+
+        CostDatabase::NodeKey CostDatabase::GetMeasurementKey(const std::vector<const Node*>& nodes, const std::string& options, const Environment& environment) const
+        {
+            auto environmentDesc = environment.HasTargetDevice() ? GetDescription(environment) : EnvironmentDescription{};
+            return { GetNodesKey(nodes), options, environmentDesc };
+        }
+
+        CostDatabase::Key CostDatabase::NullKey() const
+        {
+            return {};
+        }
+
+        size_t CostDatabase::KeyHash::operator()(const CostDatabase::Key& arg) const
+        {
+            return utilities::HashValue(arg);
+        }
+
+        size_t CostDatabase::NodeKeyHash::operator()(const CostDatabase::NodeKey& arg) const
+        {
+            return utilities::HashValue(arg);
+        }
+    } // namespace optimizer
+} // namespace model
+} // namespace ell
+
+namespace std
+{
+size_t std::hash<ell::model::optimizer::PortDescription>::operator()(const ell::model::optimizer::PortDescription& arg) const
+{
+    using ::ell::utilities::HashCombine;
+
+    size_t hash = 0;
+    HashCombine(hash, arg.type);
+    HashCombine(hash, arg.layout);
+    return hash;
+}
+
+size_t std::hash<ell::model::optimizer::NodeDescription>::operator()(const ell::model::optimizer::NodeDescription& arg) const
+{
+    using ::ell::utilities::HashCombine;
+
+    size_t hash = 0;
+    HashCombine(hash, arg.inputs);
+    HashCombine(hash, arg.outputs);
+    HashCombine(hash, arg.type);
+    return hash;
+}
+
+size_t std::hash<ell::model::optimizer::SubmodelDescription>::operator()(const ell::model::optimizer::SubmodelDescription& arg) const
+{
+    using ::ell::utilities::HashCombine;
+
+    size_t hash = 0;
+    HashCombine(hash, arg.inputs);
+    HashCombine(hash, arg.outputs);
+    HashCombine(hash, arg.nodes);
+    return hash;
+}
+} // namespace std
@@ -0,0 +1,340 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     NodeOptionsSearch.cpp (model/optimizer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "NodeOptionsSearch.h"
+
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputNodeBase.h>
+#include <model/include/ModelTransformer.h>
+
+#include <data/include/DenseDataVector.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/Logger.h>
+#include <utilities/include/PropertyBag.h>
+
+#include <limits>
+
+namespace ell
+{
+namespace model
+{
+    namespace optimizer
+    {
+        using namespace logging;
+
+        namespace
+        {
+            const char* compileOptionsKey = "compileOptions";
+
+            std::string GetOptionsDescription(const NodeOptionsSearch::NodeOptions& options)
+            {
+                std::string result;
+                for (const auto& option : options)
+                {
+                    if (!result.empty())
+                    {
+                        result += ";";
+                    }
+                    result += option.first + "=" + option.second;
+                }
+                return result;
+            }
+
+            bool OptionAppliesTo(const SearchOption& option, const std::vector<const Node*>& nodes)
+            {
+                for (auto node : nodes)
+                {
+                    if (node->GetRuntimeTypeName().compare(0, option.nodeTypePrefix.size(), option.nodeTypePrefix) == 0)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // Returns the node's compile options with the given ones added
+            utilities::PropertyBag GetCompileOptions(const Node& node, const NodeOptionsSearch::NodeOptions& options)
+            {
+                utilities::PropertyBag result;
+                if (node.GetMetadata().HasEntry(compileOptionsKey))
+                {
+                    result = node.GetMetadata().GetEntry<utilities::PropertyBag>(compileOptionsKey);
+                }
+                for (const auto& option : options)
+                {
+                    result[option.first] = option.second;
+                }
+                return result;
+            }
+
+            double GetRuntime(const Cost& cost)
+            {
+                return cost.GetCostComponent("runtime").GetValue();
+            }
+        } // namespace
+
+        std::vector<SearchOption> GetDefaultSearchOptions()
+        {
+            return {
+                { "preferredConvolutionMethod", { "simple", "unrolled", "diagonal", "winograd" }, "ConvolutionalLayerNode" },
+                { "allowVectorInstructions", { "false", "true" }, "" },
+                { "parallelize", { "false", "true" }, "" }
+            };
+        }
+
+        std::string GetNodeAncestor(const Node& node)
+        {
+            if (node.GetMetadata().HasEntry("ancestor"))
+            {
+                return node.GetMetadata().GetEntry<std::string>("ancestor");
+            }
+            return node.GetId().ToString();
+        }
+
+        //
+        // NodeOptionsSearch
+        //
+        NodeOptionsSearch::NodeOptionsSearch(std::vector<SearchOption> options, CostDatabase& database, int numProfileRuns) :
+            _options(std::move(options)),
+            _database(database),
+            _numProfileRuns(numProfileRuns)
+        {
+        }
+
+        std::map<std::string, NodeOptionsSearch::NodeOptions> NodeOptionsSearch::FindNodeOptions(const Map& map, const MapCompilerOptions& settings, const ModelOptimizerOptions& optimizerOptions)
+        {
+            // We can only profile code for the machine we're running on
+            const auto& device = settings.compilerSettings.targetDevice;
+            if (device.deviceName != "host")
+            {
+                Log() << "Can't search node options for device " << device.deviceName << EOL;
+                return {};
+            }
+            if (map.NumInputs() != 1)
+            {
+                Log() << "Can't search node options for a map with " << map.NumInputs() << " inputs" << EOL;
+                return {};
+            }
+            Environment environment(device);
+
+            std::map<std::string, std::vector<const Node*>> groups;
+            map.GetModel().Visit([&groups](const Node& node) {
+                groups[GetNodeAncestor(node)].push_back(&node);
+            });
+
+            std::map<std::string, NodeOptions> choices;
+            for (const auto& option : _options)
+            {
+                std::vector<std::string> ancestors;
+                for (const auto& group : groups)
+                {
+                    if (OptionAppliesTo(option, group.second))
+                    {
+                        ancestors.push_back(group.first);
+                    }
+                }
+                if (ancestors.empty())
+                {
+                    continue;
+                }
+
+                // Time the nodes with each value of the option, unless every measurement we need is already known
+                for (const auto& value : option.values)
+                {
+                    auto trialChoices = choices;
+                    bool isMeasured = true;
+                    for (const auto& ancestor : ancestors)
+                    {
+                        trialChoices[ancestor][option.name] = value;
+                        isMeasured = isMeasured && _database.HasCostMeasurement(groups[ancestor], GetOptionsDescription(trialChoices[ancestor]), environment);
+                    }
+                    if (isMeasured)
+                    {
+                        continue;
+                    }
+
+                    try
+                    {
+                        for (const auto& groupTime : ProfileMap(map, trialChoices, settings, optimizerOptions))
+                        {
+                            auto group = groups.find(groupTime.first);
+                            if (group != groups.end())
+                            {
+                                Cost cost;
+                                cost["runtime"] = MeasuredCostValue(groupTime.second, 0);
+                                _database.AddCostMeasurement(group->second, GetOptionsDescription(trialChoices[group->first]), environment, cost);
+                            }
+                        }
+                    }
+                    catch (const utilities::Exception& exception)
+                    {
+                        Log() << "Profiling with " << option.name << " = " << value << " failed: " << exception.GetMessage() << EOL;
+                    }
+                }
+
+                // Give each group the value it ran fastest with. Groups that weren't profiled (because their code was
+                // inlined, for instance) are left alone.
+                for (const auto& ancestor : ancestors)
+                {
+                    double bestTime = std::numeric_limits<double>::max();
+                    std::string bestValue;
+                    for (const auto& value : option.values)
+                    {
+                        auto trialOptions = choices[ancestor];
+                        trialOptions[option.name] = value;
+                        auto description = GetOptionsDescription(trialOptions);
+                        if (_database.HasCostMeasurement(groups[ancestor], description, environment))
+                        {
+                            auto time = GetRuntime(_database.GetCostMeasurement(groups[ancestor], description, environment));
+                            if (time < bestTime)
+                            {
+                                bestTime = time;
+                                bestValue = value;
+                            }
+                        }
+                    }
+
+                    if (!bestValue.empty())
+                    {
+                        Log() << "Setting " << option.name << " = " << bestValue << " for node " << ancestor << ": " << bestTime << " ms" << EOL;
+                        choices[ancestor][option.name] = bestValue;
+                    }
+                }
+            }
+
+            for (auto iter = choices.begin(); iter != choices.end();)
+            {
+                iter = iter->second.empty() ? choices.erase(iter) : std::next(iter);
+            }
+            return choices;
+        }
+
+        std::map<std::string, double> NodeOptionsSearch::ProfileMap(const Map& map, const std::map<std::string, NodeOptions>& nodeOptions, const MapCompilerOptions& settings, const ModelOptimizerOptions& optimizerOptions) const
+        {
+            Map trialMap = map;
+            SetNodeOptions(trialMap.GetModel(), nodeOptions);
+
+            // Don't search again while compiling the trial map, even if the model's metadata asks for it
+            auto& modelMetadata = trialMap.GetModel().GetMetadata();
+            utilities::PropertyBag modelOptions;
+            if (modelMetadata.HasEntry(compileOptionsKey))
+            {
+                modelOptions = modelMetadata.GetEntry<utilities::PropertyBag>(compileOptionsKey);
+            }
+            modelOptions["searchNodeOptions"] = false;
+            modelMetadata[compileOptionsKey] = modelOptions;
+
+            auto profileSettings = settings;
+            profileSettings.moduleName = "ELL_NodeOptionsSearch";
+            profileSettings.profile = true;
+            profileSettings.reentrant = false;
+            profileSettings.emitBatchPredictFunction = false;
+            profileSettings.jitCacheDirectory = "";
+            auto profileOptimizerOptions = optimizerOptions;
+            profileOptimizerOptions["searchNodeOptions"] = false;
+            IRMapCompiler compiler(profileSettings, profileOptimizerOptions);
+            auto compiledMap = compiler.Compile(trialMap);
+
+            data::DoubleDataVector input(std::vector<double>(compiledMap.GetInputSize(), 1.0));
+            compiledMap.SetInputValue(0, input); // warm up, and force the JIT to run
+            compiledMap.ResetNodeProfilingInfo();
+            for (int run = 0; run < _numProfileRuns; ++run)
+            {
+                compiledMap.SetInputValue(0, input);
+            }
+
+            std::map<std::string, double> result;
+            for (int index = 0; index < compiledMap.GetNumProfiledNodes(); ++index)
+            {
+                auto info = compiledMap.GetNodeInfo(index);
+                auto counters = compiledMap.GetNodePerformanceCounters(index);
+                result[info->nodeAncestor] += counters->totalTime / _numProfileRuns;
+            }
+            return result;
+        }
+
+        void SetNodeOptions(Model& model, const std::map<std::string, NodeOptionsSearch::NodeOptions>& choices)
+        {
+            for (auto node : model.GetNodesByType<Node>())
+            {
+                auto options = choices.find(GetNodeAncestor(*node));
+                if (options != choices.end())
+                {
+                    node->GetMetadata()[compileOptionsKey] = GetCompileOptions(*node, options->second);
+                }
+            }
+        }
+
+        //
+        // NodeOptionsSearchTransformation
+        //
+        NodeOptionsSearchTransformation::NodeOptionsSearchTransformation() :
+            NodeOptionsSearchTransformation(GetDefaultSearchOptions())
+        {
+        }
+
+        NodeOptionsSearchTransformation::NodeOptionsSearchTransformation(std::vector<SearchOption> options, int numProfileRuns) :
+            _options(std::move(options)),
+            _numProfileRuns(numProfileRuns)
+        {
+        }
+
+        Submodel NodeOptionsSearchTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+        {
+            // Only whole models with a single input can be compiled and run on their own
+            auto compiler = context.GetCompiler();
+            if (compiler == nullptr || !submodel.GetInputs().empty())
+            {
+                return submodel;
+            }
+
+            std::vector<const InputNodeBase*> inputNodes;
+            submodel.Visit([&inputNodes](const Node& node) {
+                if (auto inputNode = dynamic_cast<const InputNodeBase*>(&node))
+                {
+                    inputNodes.push_back(inputNode);
+                }
+            });
+            if (inputNodes.size() != 1)
+            {
+                return submodel;
+            }
+
+            std::vector<std::pair<std::string, const OutputPortBase&>> outputs;
+            for (auto output : submodel.GetOutputs())
+            {
+                outputs.push_back({ "output" + std::to_string(outputs.size()), *output });
+            }
+            Map map(submodel.GetModel(), { { "input", const_cast<InputNodeBase*>(inputNodes[0]) } }, outputs);
+
+            NodeOptionsSearch search(_options, _database, _numProfileRuns);
+            auto choices = search.FindNodeOptions(map, compiler->GetMapCompilerOptions(submodel.GetModel()), compiler->GetModelOptimizerOptions(submodel.GetModel()));
+            if (choices.empty())
+            {
+                return submodel;
+            }
+
+            model::Model destModel = submodel.GetModel().ShallowCopy();
+            return transformer.TransformSubmodelOnto(submodel, destModel, {}, context, [&choices](const Node& node, ModelTransformer& transformer) {
+                auto options = choices.find(GetNodeAncestor(node));
+                if (options == choices.end())
+                {
+                    transformer.CopyNode(node);
+                    return;
+                }
+
+                utilities::PropertyBag metadata;
+                metadata[compileOptionsKey] = GetCompileOptions(node, options->second);
+                transformer.CopyNodeWithMetadata(node, metadata);
+            });
+        }
+    } // namespace optimizer
+} // namespace model
+} // namespace ell
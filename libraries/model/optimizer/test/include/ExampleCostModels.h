@@ -8,12 +8,11 @@
 
 #pragma once
 
-#include "Cost.h"
-#include "CostDatabase.h"
-#include "CostModel.h"
-
 #include <model/include/Submodel.h>
 #include <model/include/Transformation.h>
+#include <model/optimizer/include/Cost.h>
+#include <model/optimizer/include/CostDatabase.h>
+#include <model/optimizer/include/CostModel.h>
 
 #include <functional>
 #include <unordered_map>
@@ -27,7 +26,7 @@ public:
     SimpleCostModel();
     SimpleCostModel(const SimpleCostModel& other) = default;
     SimpleCostModel(SimpleCostModel&& other) = default;
-    SimpleCostModel(CostDatabase perfData);
+    SimpleCostModel(ell::model::optimizer::CostDatabase perfData);
 
     bool HasCost(const ell::model::Submodel& submodel, const ell::model::optimizer::Environment& environment) const override;
     ell::model::optimizer::Cost GetCost(const ell::model::Submodel& submodel, const ell::model::optimizer::Environment& environment) const override;
@@ -35,5 +34,5 @@ public:
 private:
     ell::model::optimizer::Cost NullCost() const;
 
-    CostDatabase _perfData;
+    ell::model::optimizer::CostDatabase _perfData;
 };
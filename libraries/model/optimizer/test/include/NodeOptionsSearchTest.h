@@ -0,0 +1,18 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     NodeOptionsSearchTest.h (model/optimizer_test)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+//
+// NodeOptionsSearch tests
+//
+void TestNodeOptionsSearch();
+
+void TestFindNodeOptions();
+void TestNodeOptionsSearchTransformation();
+void TestCostDatabaseNodeMeasurementsRoundTrip();
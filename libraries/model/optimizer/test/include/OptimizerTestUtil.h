@@ -8,11 +8,10 @@
 
 #pragma once
 
-#include "Cost.h"
-#include "Objective.h"
-
 #include <model/include/Submodel.h>
 #include <model/include/Transformation.h>
+#include <model/optimizer/include/Cost.h>
+#include <model/optimizer/include/Objective.h>
 
 //
 // Optimizer test utilities
@@ -8,7 +8,7 @@
 
 #pragma once
 
-#include "GlobalOptimizer.h"
+#include <model/optimizer/include/GlobalOptimizer.h>
 
 #include <memory>
 #include <type_traits>
@@ -7,13 +7,13 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "CostModelTest.h"
-#include "CostModel.h"
-#include "Environment.h"
 #include "ExampleCostModels.h"
 #include "ExampleTransformations.h"
 #include "OptimizerTestUtil.h"
 
 #include <model/include/Submodel.h>
+#include <model/optimizer/include/CostModel.h>
+#include <model/optimizer/include/Environment.h>
 
 #include <testing/include/testing.h>
 
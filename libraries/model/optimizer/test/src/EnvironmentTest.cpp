@@ -7,7 +7,8 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "EnvironmentTest.h"
-#include "Environment.h"
+
+#include <model/optimizer/include/Environment.h>
 
 #include <emitters/include/CompilerOptions.h>
 #include <emitters/include/IRModuleEmitter.h>
@@ -27,7 +27,7 @@ SimpleCostModel::SimpleCostModel()
 {
 }
 
-SimpleCostModel::SimpleCostModel(CostDatabase perfData) :
+SimpleCostModel::SimpleCostModel(optimizer::CostDatabase perfData) :
     _perfData(perfData)
 {
 }
@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     NodeOptionsSearchTest.cpp (model/optimizer_test)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "NodeOptionsSearchTest.h"
+
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputNode.h>
+#include <model/include/Map.h>
+#include <model/include/Model.h>
+#include <model/optimizer/include/CostDatabase.h>
+#include <model/optimizer/include/NodeOptionsSearch.h>
+
+#include <nodes/include/UnaryOperationNode.h>
+
+#include <testing/include/testing.h>
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::model::optimizer;
+using namespace ell::testing;
+
+namespace
+{
+// model: InputNode -> Exp -> Sin
+Map GetUnaryOperationMap(int size)
+{
+    Model model;
+    auto inputNode = model.AddNode<InputNode<double>>(size);
+    const auto& exp = nodes::Exp(inputNode->output);
+    const auto& sin = nodes::Sin(exp);
+    return { model, { { "input", inputNode } }, { { "output", sin } } };
+}
+
+bool IsFound(const std::vector<std::string>& values, const std::string& value)
+{
+    return std::find(values.begin(), values.end(), value) != values.end();
+}
+} // namespace
+
+//
+// NodeOptionsSearch tests
+//
+void TestNodeOptionsSearch()
+{
+    TestFindNodeOptions();
+    TestNodeOptionsSearchTransformation();
+    TestCostDatabaseNodeMeasurementsRoundTrip();
+}
+
+void TestFindNodeOptions()
+{
+    auto map = GetUnaryOperationMap(256);
+    const std::vector<std::string> values = { "false", "true" };
+    std::vector<SearchOption> options = { { "allowVectorInstructions", values, "" }, { "parallelize", values, "UnaryOperationNode" } };
+
+    MapCompilerOptions settings;
+    CostDatabase database;
+    NodeOptionsSearch search(options, database, 5);
+    auto choices = search.FindNodeOptions(map, settings, {});
+
+    // Each of the unary operation nodes gets a value for both options, and only they get a value for "parallelize"
+    int numChosen = 0;
+    bool ok = true;
+    map.GetModel().Visit([&](const Node& node) {
+        auto isUnaryOperation = node.GetRuntimeTypeName().find("UnaryOperationNode") == 0;
+        auto nodeChoices = choices.find(GetNodeAncestor(node));
+        if (nodeChoices == choices.end())
+        {
+            ok = ok && !isUnaryOperation;
+            return;
+        }
+
+        const auto& nodeOptions = nodeChoices->second;
+        if (!isUnaryOperation)
+        {
+            ok = ok && nodeOptions.count("parallelize") == 0;
+            return;
+        }
+
+        ++numChosen;
+        ok = ok && nodeOptions.count("allowVectorInstructions") == 1 && IsFound(values, nodeOptions.at("allowVectorInstructions"));
+        ok = ok && nodeOptions.count("parallelize") == 1 && IsFound(values, nodeOptions.at("parallelize"));
+    });
+    ProcessTest("Testing NodeOptionsSearch::FindNodeOptions chooses options for each node", ok && numChosen == 2);
+
+    // A second search uses the measurements in the database, so it makes the same choices
+    NodeOptionsSearch search2(options, database, 5);
+    auto choices2 = search2.FindNodeOptions(map, settings, {});
+    ProcessTest("Testing NodeOptionsSearch::FindNodeOptions reuses measurements", choices2 == choices);
+
+    // Other devices can't be profiled
+    auto deviceSettings = settings;
+    deviceSettings.compilerSettings.targetDevice.deviceName = "pi3";
+    ProcessTest("Testing NodeOptionsSearch::FindNodeOptions skips other devices", search.FindNodeOptions(map, deviceSettings, {}).empty());
+}
+
+void TestNodeOptionsSearchTransformation()
+{
+    const int size = 64;
+    auto map = GetUnaryOperationMap(size);
+
+    std::vector<double> input(size);
+    for (int index = 0; index < size; ++index)
+    {
+        input[index] = 0.01 * index;
+    }
+    auto expected = map.Compute<double>(input);
+
+    // Compiling with the "searchNodeOptions" option runs the search from OptimizeModelTransformation
+    MapCompilerOptions settings;
+    ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["searchNodeOptions"] = true;
+    IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    bool hasOptions = false;
+    compiledMap.GetModel().Visit([&hasOptions](const Node& node) {
+        if (node.GetRuntimeTypeName().find("UnaryOperationNode") == 0)
+        {
+            hasOptions = hasOptions || node.GetMetadata().HasEntry("compileOptions");
+        }
+    });
+    ProcessTest("Testing NodeOptionsSearchTransformation sets node options", hasOptions);
+
+    auto result = compiledMap.Compute<double>(input);
+    ProcessTest("Testing NodeOptionsSearchTransformation result", IsEqual(result, expected, 1e-6));
+}
+
+void TestCostDatabaseNodeMeasurementsRoundTrip()
+{
+    auto map = GetUnaryOperationMap(16);
+    std::vector<const Node*> nodes;
+    map.GetModel().Visit([&nodes](const Node& node) {
+        nodes.push_back(&node);
+    });
+    Environment environment(emitters::GetTargetDevice("host"));
+
+    CostDatabase database;
+    Cost cost;
+    cost["runtime"] = MeasuredCostValue(1.25, 0.5);
+    cost["memory"] = HeuristicCostValue(3);
+    database.AddCostMeasurement({ nodes[1] }, "parallelize=true", environment, cost);
+    database.AddCostMeasurement({ nodes[1], nodes[2] }, "", environment, cost);
+
+    std::stringstream stream;
+    database.WriteNodeMeasurements(stream);
+    CostDatabase readDatabase;
+    readDatabase.ReadNodeMeasurements(stream);
+
+    bool ok = readDatabase.HasCostMeasurement({ nodes[1] }, "parallelize=true", environment) && readDatabase.HasCostMeasurement({ nodes[1], nodes[2] }, "", environment);
+    ok = ok && !readDatabase.HasCostMeasurement({ nodes[1] }, "parallelize=false", environment) && !readDatabase.HasCostMeasurement({ nodes[0] }, "parallelize=true", environment);
+    if (ok)
+    {
+        auto readCost = readDatabase.GetCostMeasurement({ nodes[1] }, "parallelize=true", environment);
+        auto runtime = readCost.GetCostComponent("runtime");
+        auto memory = readCost.GetCostComponent("memory");
+        ok = runtime.IsCostType<MeasuredCostValue>() && runtime.GetValue() == 1.25 && runtime.GetVariance() == 0.5;
+        ok = ok && memory.IsCostType<HeuristicCostValue>() && memory.GetValue() == 3;
+    }
+    ProcessTest("Testing CostDatabase writes and reads node measurements", ok);
+}
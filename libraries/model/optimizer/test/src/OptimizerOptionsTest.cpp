@@ -7,9 +7,10 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "OptimizerOptionsTest.h"
-#include "GlobalOptimizerOptions.h"
 #include "OptimizerTestUtil.h"
 
+#include <model/optimizer/include/GlobalOptimizerOptions.h>
+
 #include <testing/include/testing.h>
 
 using namespace ell;
@@ -7,7 +7,6 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "OptimizerTest.h"
-#include "Environment.h"
 #include "ExampleCostModels.h"
 #include "ExampleObjectives.h"
 #include "ExampleOptimizers.h"
@@ -15,6 +14,8 @@
 #include "OptimizerTestUtil.h"
 #include "SequentialOptimizer.h"
 
+#include <model/optimizer/include/Environment.h>
+
 #include <testing/include/testing.h>
 
 #include <utilities/include/Exception.h>
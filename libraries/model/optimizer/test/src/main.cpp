@@ -13,6 +13,7 @@
 #include "CostModelTest.h"
 #include "CostTest.h"
 #include "EnvironmentTest.h"
+#include "NodeOptionsSearchTest.h"
 #include "ObjectiveTest.h"
 #include "OptimizerOptionsTest.h"
 #include "OptimizerTest.h"
@@ -30,6 +31,8 @@ int main()
 
     TestEnvironment();
 
+    TestNodeOptionsSearch();
+
     TestObjectives();
 
     TestOptimizerOptions();
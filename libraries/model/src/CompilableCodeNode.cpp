@@ -15,6 +15,7 @@
 
 #include <value/include/ValueType.h>
 
+#include <algorithm>
 #include <numeric>
 
 namespace ell
@@ -126,31 +127,45 @@ namespace model
         auto InputPortToValue(InputPortBase* port) -> Value
         {
             auto castedPort = static_cast<InputPort<T>*>(port);
-            auto data = castedPort->GetValue();
+            const auto& data = castedPort->GetValueReference();
             if constexpr (std::is_same_v<T, bool>)
             {
                 return Value(std::vector<utilities::Boolean>(data.begin(), data.end()), castedPort->GetMemoryLayout());
             }
             else
             {
-                return Value(data, castedPort->GetMemoryLayout());
+                // Point at the referenced port's output instead of copying it; the function only reads its inputs
+                return Value(const_cast<T*>(data.data()), castedPort->GetMemoryLayout());
             }
         }
 
         template <typename T>
-        void ValueToOutputPort(Value value, OutputPortBase* port)
+        auto OutputPortToValue(OutputPortBase* port) -> Value
         {
-            auto castedPort = static_cast<OutputPort<T>*>(port);
-            auto dataPtrBegin = value.Get<std::conditional_t<std::is_same_v<T, bool>, utilities::Boolean, T>*>();
-            auto dataPtrEnd = dataPtrBegin + castedPort->GetMemoryLayout().GetMemorySize();
             if constexpr (std::is_same_v<T, bool>)
             {
-                std::vector<bool> vec(dataPtrBegin, dataPtrEnd);
-                castedPort->SetOutput(std::move(vec));
+                return Allocate(PortTypeToValueTypeEnum(port->GetType()), port->GetMemoryLayout());
             }
             else
             {
-                castedPort->SetOutput(dataPtrBegin, dataPtrEnd);
+                // Let the function write the port's output in place, starting from zeros as an allocated value does
+                auto& buffer = static_cast<OutputPort<T>*>(port)->GetOutputBuffer();
+                std::fill(buffer.begin(), buffer.end(), T{});
+                return Value(buffer.data(), port->GetMemoryLayout());
+            }
+        }
+
+        template <typename T>
+        void ValueToOutputPort(Value value, OutputPortBase* port)
+        {
+            // Only boolean outputs are computed into separate storage
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                auto castedPort = static_cast<OutputPort<T>*>(port);
+                auto dataPtrBegin = value.Get<utilities::Boolean*>();
+                auto dataPtrEnd = dataPtrBegin + castedPort->GetMemoryLayout().GetMemorySize();
+                std::vector<bool> vec(dataPtrBegin, dataPtrEnd);
+                castedPort->SetOutput(std::move(vec));
             }
         }
 
@@ -177,6 +192,29 @@ namespace model
             }
         }
 
+        Value PortToValue(OutputPortBase* port)
+        {
+            switch (port->GetType())
+            {
+            case PortType::bigInt:
+                return OutputPortToValue<int64_t>(port);
+            case PortType::boolean:
+                return OutputPortToValue<bool>(port);
+            case PortType::integer:
+                return OutputPortToValue<int>(port);
+            case PortType::real:
+                return OutputPortToValue<double>(port);
+            case PortType::smallReal:
+                return OutputPortToValue<float>(port);
+            case PortType::categorical:
+                [[fallthrough]];
+            case PortType::none:
+                [[fallthrough]];
+            default:
+                throw LogicException(LogicExceptionErrors::illegalState);
+            }
+        }
+
         int ValueToPort(Value value, OutputPortBase* port)
         {
             switch (port->GetType())
@@ -224,11 +262,8 @@ namespace model
 
         std::vector<Value> args;
         args.reserve(inputs.size() + outputs.size());
-        std::transform(inputs.begin(), inputs.end(), std::back_inserter(args), PortToValue);
-
-        std::transform(outputs.begin(), outputs.end(), std::back_inserter(args), [](auto* port) {
-            return Allocate(PortTypeToValueTypeEnum(port->GetType()), port->GetMemoryLayout());
-        });
+        std::transform(inputs.begin(), inputs.end(), std::back_inserter(args), [](InputPortBase* port) { return PortToValue(port); });
+        std::transform(outputs.begin(), outputs.end(), std::back_inserter(args), [](OutputPortBase* port) { return PortToValue(port); });
 
         _fn.Call(args);
 
@@ -10,8 +10,12 @@
 #include "CompilableNodeUtilities.h"
 #include "IRMapCompiler.h"
 #include "MapCompiler.h"
+#include "RefinementCache.h"
+#include "TransformContext.h"
 
 #include <emitters/include/EmitterException.h>
+#include <emitters/include/IRMetadata.h>
+#include <emitters/include/IROptimizer.h>
 #include <emitters/include/LLVMUtilities.h>
 
 #include <utilities/include/Logger.h>
@@ -40,8 +44,11 @@ namespace model
 
         emitters::IRModuleEmitter& moduleEmitter = irCompiler->GetModule();
         auto& enclosingFunction = moduleEmitter.GetCurrentFunction();
-        if (ShouldCompileInline() || compiler.GetMapCompilerOptions(*this).inlineNodes)
+        // Nodes with a dynamic extent are always inlined, since their code depends on more than the node function's name,
+        // and so are nodes with conditional inputs, since the functions computing those take the map function's arguments
+        if (ShouldCompileInline() || compiler.GetMapCompilerOptions(*this).inlineNodes || irCompiler->HasDynamicExtent(*this) || !GetConditionalInputs().empty())
         {
+            _nodeFunctionKey.clear();
             Log() << "Inlining node " << DiagnosticString(*this) << " into function " << enclosingFunction.GetFunctionName() << EOL;
 
             irCompiler->NewNodeRegion(*this);
@@ -55,6 +62,13 @@ namespace model
         {
             Log() << "Not inlining code for node " << DiagnosticString(*this) << EOL;
 
+            // A node that shares its function is named after its content instead of its ID, so later nodes with the same content find it
+            _nodeFunctionKey.clear();
+            if (compiler.GetMapCompilerOptions(*this).shareNodeFunctions && CanShareNodeFunction())
+            {
+                _nodeFunctionKey = GetNodeFunctionKey(*irCompiler);
+            }
+
             // Emit code for function if it doesn't exist yet
             auto functionName = GetCompiledFunctionName();
             if (!moduleEmitter.HasFunction(functionName))
@@ -83,7 +97,9 @@ namespace model
                 {
                     auto function = moduleEmitter.BeginFunction(functionName, emitters::VariableType::Void, args);
                     function.SetCompilerOptions(compiler.GetMapCompilerOptions(*this).compilerSettings);
+                    emitters::SetOptimizationAttributes(*function.GetFunction(), compiler.GetMapCompilerOptions(*this).compilerSettings);
                     function.SetAttributeForArguments(emitters::IRFunctionEmitter::Attributes::NoAlias);
+                    function.InsertMetadata(emitters::c_nodeFunctionTagName);
 
                     irCompiler->NewNodeRegion(*this);
                     Compile(*irCompiler, function);
@@ -91,6 +107,16 @@ namespace model
                     moduleEmitter.EndFunction();
                 }
                 compiler.PopScope();
+
+                if (compiler.GetMapCompilerOptions(*this).lazyCompile)
+                {
+                    // Keep the function out of line, so the JIT can defer compiling it until the first call
+                    Log() << "Deferring compilation of " << functionName << " to its first call" << EOL;
+                    auto llvmFunction = moduleEmitter.GetFunction(functionName);
+                    llvmFunction->removeFnAttr(llvm::Attribute::AlwaysInline);
+                    llvmFunction->addFnAttr(llvm::Attribute::NoInline);
+                    moduleEmitter.InsertFunctionMetadata(functionName, emitters::c_lazyFunctionTagName);
+                }
             }
             else
             {
@@ -159,7 +185,11 @@ namespace model
 
     std::string CompilableNode::GetInternalStateIdentifier() const
     {
-        if (HasState())
+        if (IsSharingNodeFunction())
+        {
+            return _nodeFunctionKey;
+        }
+        else if (HasState())
         {
             return IdString(*this);
         }
@@ -169,6 +199,20 @@ namespace model
         }
     }
 
+    bool CompilableNode::CanShareNodeFunction() const
+    {
+        return false;
+    }
+
+    std::string CompilableNode::GetNodeFunctionKey(IRMapCompiler& compiler) const
+    {
+        // The content key is "<type>-<hash>-<length>", and the function name already has the type in it
+        auto key = GetNodeContentKey(*this, TransformContext(&compiler));
+        key = "Shared_" + key.substr(key.find('-') + 1);
+        std::replace(key.begin(), key.end(), '-', '_');
+        return key;
+    }
+
     // Get parameters used in the node function's signature
     emitters::NamedVariableTypeList CompilableNode::GetNodeFunctionParameterList(IRMapCompiler& compiler) const
     {
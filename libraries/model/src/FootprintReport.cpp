@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FootprintReport.cpp (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FootprintReport.h"
+
+#include <utilities/include/StringUtil.h>
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+namespace ell
+{
+namespace model
+{
+    namespace
+    {
+        template <typename Function>
+        size_t SumOverNodes(const std::vector<NodeFootprint>& nodes, Function getBytes)
+        {
+            return std::accumulate(nodes.begin(), nodes.end(), size_t{ 0 }, [&getBytes](size_t sum, const NodeFootprint& node) { return sum + getBytes(node); });
+        }
+    } // namespace
+
+    void FootprintReport::SetCodeSizes(const std::map<std::string, size_t>& functionCodeBytes)
+    {
+        // The nodes in each function, and how much of the function's code they emitted. A node whose own function
+        // wasn't inlined only has a call in the function it's compiled into.
+        std::unordered_map<std::string, std::vector<std::pair<NodeFootprint*, size_t>>> functionNodes;
+        for (auto& node : _nodes)
+        {
+            node.codeBytes = 0;
+            bool hasOutOfLineFunction = false;
+            for (const auto& name : node.ownFunctions)
+            {
+                if (functionCodeBytes.count(name) != 0)
+                {
+                    functionNodes[name].emplace_back(&node, std::max<size_t>(node.irInstructions, 1));
+                    hasOutOfLineFunction = true;
+                }
+            }
+            if (!hasOutOfLineFunction && node.irInstructions > 0)
+            {
+                functionNodes[node.functionName].emplace_back(&node, node.irInstructions);
+            }
+        }
+
+        _codeBytes = 0;
+        std::unordered_map<const NodeFootprint*, bool> isExact;
+        for (const auto& [name, bytes] : functionCodeBytes)
+        {
+            _codeBytes += bytes;
+            auto it = functionNodes.find(name);
+            if (it == functionNodes.end())
+            {
+                continue;
+            }
+
+            // Share the code by cumulative IR instructions, so the shares add up to the function's size
+            const auto& nodes = it->second;
+            size_t totalInstructions = 0;
+            for (const auto& entry : nodes)
+            {
+                totalInstructions += entry.second;
+            }
+            size_t instructionsSoFar = 0;
+            size_t bytesSoFar = 0;
+            for (const auto& [node, instructions] : nodes)
+            {
+                instructionsSoFar += instructions;
+                auto end = bytes * instructionsSoFar / totalInstructions;
+                node->codeBytes += end - bytesSoFar;
+                bytesSoFar = end;
+
+                auto exact = isExact.emplace(node, true).first;
+                exact->second = exact->second && nodes.size() == 1;
+            }
+        }
+
+        for (auto& node : _nodes)
+        {
+            auto it = isExact.find(&node);
+            node.isCodeSizeExact = it != isExact.end() && it->second;
+        }
+    }
+
+    size_t FootprintReport::GetWeightBytes() const
+    {
+        return SumOverNodes(_nodes, [](const NodeFootprint& node) { return node.weightBytes; });
+    }
+
+    size_t FootprintReport::GetBufferBytes() const
+    {
+        return SumOverNodes(_nodes, [](const NodeFootprint& node) { return node.bufferBytes; });
+    }
+
+    size_t FootprintReport::GetPlannedBufferBytes() const
+    {
+        return _arenaBytes + SumOverNodes(_nodes, [](const NodeFootprint& node) { return node.bufferBytes - node.plannedBufferBytes; });
+    }
+
+    size_t FootprintReport::GetStackBytes() const
+    {
+        return SumOverNodes(_nodes, [](const NodeFootprint& node) { return node.stackBytes; });
+    }
+
+    void FootprintReport::WriteJson(std::ostream& stream) const
+    {
+        stream << "{\n";
+        stream << "  \"totals\": {\n";
+        stream << "    \"codeBytes\": " << GetCodeBytes() << ",\n";
+        stream << "    \"weightBytes\": " << GetWeightBytes() << ",\n";
+        stream << "    \"externalWeightBytes\": " << GetExternalWeightBytes() << ",\n";
+        stream << "    \"bufferBytes\": " << GetBufferBytes() << ",\n";
+        stream << "    \"plannedBufferBytes\": " << GetPlannedBufferBytes() << ",\n";
+        stream << "    \"stackBytes\": " << GetStackBytes() << "\n";
+        stream << "  },\n";
+        stream << "  \"nodes\": [";
+        for (size_t index = 0; index < _nodes.size(); ++index)
+        {
+            const auto& node = _nodes[index];
+            stream << (index == 0 ? "\n" : ",\n");
+            stream << "    {\n";
+            stream << "      \"id\": " << utilities::QuoteJsonString(node.nodeId) << ",\n";
+            stream << "      \"type\": " << utilities::QuoteJsonString(node.nodeType) << ",\n";
+            stream << "      \"function\": " << utilities::QuoteJsonString(node.functionName) << ",\n";
+            stream << "      \"ownFunctions\": [";
+            for (size_t functionIndex = 0; functionIndex < node.ownFunctions.size(); ++functionIndex)
+            {
+                stream << (functionIndex == 0 ? "" : ", ") << utilities::QuoteJsonString(node.ownFunctions[functionIndex]);
+            }
+            stream << "],\n";
+            stream << "      \"irInstructions\": " << node.irInstructions << ",\n";
+            stream << "      \"codeBytes\": " << node.codeBytes << ",\n";
+            stream << "      \"codeBytesExact\": " << (node.isCodeSizeExact ? "true" : "false") << ",\n";
+            stream << "      \"weightBytes\": " << node.weightBytes << ",\n";
+            stream << "      \"bufferBytes\": " << node.bufferBytes << ",\n";
+            stream << "      \"plannedBufferBytes\": " << node.plannedBufferBytes << ",\n";
+            stream << "      \"stackBytes\": " << node.stackBytes << "\n";
+            stream << "    }";
+        }
+        stream << (_nodes.empty() ? "]\n" : "\n  ]\n");
+        stream << "}\n";
+    }
+
+    std::vector<std::string> FootprintReport::GetSummaryLines() const
+    {
+        std::vector<std::string> lines;
+        lines.push_back("Footprint: " + std::to_string(GetCodeBytes()) + " bytes of code, " +
+                        std::to_string(GetWeightBytes()) + " bytes of weights (" + std::to_string(GetExternalWeightBytes()) + " external), " +
+                        std::to_string(GetPlannedBufferBytes()) + " bytes of buffers (" + std::to_string(GetBufferBytes()) + " before memory planning), " +
+                        "at most " + std::to_string(GetStackBytes()) + " bytes of stack");
+        for (const auto& node : _nodes)
+        {
+            if (node.codeBytes == 0 && node.weightBytes == 0 && node.bufferBytes == 0 && node.stackBytes == 0)
+            {
+                continue;
+            }
+            lines.push_back("  " + node.nodeType + " " + node.nodeId + ": code " + std::to_string(node.codeBytes) + (node.isCodeSizeExact ? "" : " (estimated)") +
+                            ", weights " + std::to_string(node.weightBytes) + ", buffers " + std::to_string(node.bufferBytes) + ", stack " + std::to_string(node.stackBytes));
+        }
+        return lines;
+    }
+} // namespace model
+} // namespace ell
@@ -19,8 +19,14 @@
 #include <utilities/include/Exception.h>
 #include <utilities/include/Files.h>
 
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
 #include <llvm/Transforms/Utils/Cloning.h>
 
+#include <algorithm>
 #include <sstream>
 
 namespace ell
@@ -33,35 +39,77 @@ namespace model
         CompiledMap(std::move(other)),
         _module(other._module),
         _moduleName(std::move(other._moduleName)),
+        _cachedCode(std::move(other._cachedCode)),
         _executionEngine(std::move(other._executionEngine)),
         _verifyJittedModule(other._verifyJittedModule),
+        _tieredCompilation(other._tieredCompilation),
+        _optimizedCode(std::move(other._optimizedCode)),
+        _optimizedCompile(std::move(other._optimizedCompile)),
         _context(other._context),
+        _threadAffinity(std::move(other._threadAffinity)),
+        _externalWeights(std::move(other._externalWeights)),
+        _externalWeightsLayout(std::move(other._externalWeightsLayout)),
+        _optimizerOptions(std::move(other._optimizerOptions)),
+        _state(std::move(other._state)),
+        _footprintReport(std::move(other._footprintReport)),
         _computeFunctionDefined(false)
     {
     }
 
     // private constructor:
-    IRCompiledMap::IRCompiledMap(Map map, const std::string& functionName, const MapCompilerOptions& options, emitters::IRModuleEmitter& module, bool verifyJittedModule) :
+    IRCompiledMap::IRCompiledMap(Map map, const std::string& functionName, const MapCompilerOptions& options, emitters::IRModuleEmitter& module, bool verifyJittedModule, bool tieredCompilation) :
         CompiledMap(std::move(map), functionName, options),
         _module(module),
         _moduleName(_module.GetModuleName()),
         _verifyJittedModule(verifyJittedModule),
+        _tieredCompilation(tieredCompilation),
+        _threadAffinity(options.compilerSettings.threadAffinity),
         _computeFunctionDefined(false)
     {
     }
 
+    IRCompiledMap::IRCompiledMap(Map map, const std::string& functionName, const MapCompilerOptions& options, emitters::IRModuleEmitter& module, std::shared_ptr<const CachedMachineCode> cachedCode, bool verifyJittedModule) :
+        CompiledMap(std::move(map), functionName, options),
+        _module(module),
+        _moduleName(_module.GetModuleName()),
+        _cachedCode(std::move(cachedCode)),
+        _verifyJittedModule(verifyJittedModule),
+        _threadAffinity(options.compilerSettings.threadAffinity),
+        _computeFunctionDefined(false)
+    {
+    }
 
     IRCompiledMap IRCompiledMap::Clone()
     {
         EnsureExecutionEngine();
 
         Map newMap(*this);
-        IRCompiledMap result(std::move(newMap), GetFunctionName(), GetMapCompilerOptions(), _module, _verifyJittedModule);
+        IRCompiledMap result(std::move(newMap), GetFunctionName(), GetMapCompilerOptions(), _module, _cachedCode, _verifyJittedModule);
+        if (GetMapCompilerOptions().reentrant)
+        {
+            // All the mutable state of a reentrant model is in `_state`, so the clone can run the same jitted code
+            result._executionEngine = _executionEngine;
+            result._tieredCompilation = _tieredCompilation;
+            result._optimizedCode = _optimizedCode;
+        }
+        result._externalWeights = _externalWeights;
+        result._externalWeightsLayout = _externalWeightsLayout;
+        result._optimizerOptions = _optimizerOptions;
+        result._footprintReport = _footprintReport;
         result.SetContext(GetContext());
         result.FinishJitting();
         return result;
     }
 
+    void IRCompiledMap::EnsureModuleAvailable() const
+    {
+        if (_cachedCode)
+        {
+            // We skipped emitting the module when we found the map in the JIT cache
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Can't write code for a map loaded from the JIT cache");
+        }
+    }
+
     bool IRCompiledMap::IsValid() const
     {
         return _module.IsValid() && !_moduleName.empty();
@@ -75,10 +123,190 @@ namespace model
 
     void IRCompiledMap::EnsureExecutionEngine()
     {
+        if (!_executionEngine && _cachedCode)
+        {
+            // Load the cached machine code into an otherwise-empty module, and run its initialization code
+            auto emptyModule = std::make_unique<llvm::Module>(_moduleName, _module.GetLLVMContext());
+            _executionEngine = std::make_unique<emitters::IRExecutionEngine>(std::move(emptyModule), _verifyJittedModule);
+            _executionEngine->AddObjectFile(_cachedCode->objectCode);
+            for (const auto& name : _cachedCode->initializationFunctions)
+            {
+                _executionEngine->GetFunction<void()>(name)();
+            }
+        }
+
         if (!_executionEngine)
         {
             auto moduleClone = std::unique_ptr<llvm::Module>(llvm::CloneModule(*_module.GetLLVMModule()));
             _executionEngine = std::make_unique<emitters::IRExecutionEngine>(std::move(moduleClone), _verifyJittedModule);
+            if (_tieredCompilation)
+            {
+                _executionEngine->SetCodeGenerationLevel(llvm::CodeGenOpt::None);
+                StartOptimizedCompile();
+            }
+
+            if (_externalWeights)
+            {
+                _executionEngine->GetFunction<void(const void*)>(_moduleName + "_SetWeights")(_externalWeights->data());
+            }
+        }
+    }
+
+    void IRCompiledMap::SetExternalWeights(const ExternalWeights& weights, const ModelOptimizerOptions& optimizerOptions)
+    {
+        _externalWeights = std::make_shared<std::vector<WeightsBlock>>((weights.data.size() + sizeof(WeightsBlock) - 1) / sizeof(WeightsBlock));
+        _externalWeightsLayout = std::make_shared<const std::vector<std::pair<size_t, size_t>>>(weights.blocks);
+        _optimizerOptions = optimizerOptions;
+        CopyExternalWeights(weights.data);
+    }
+
+    void IRCompiledMap::CopyExternalWeights(const std::vector<uint8_t>& weights)
+    {
+        // The jitted code already points at the blocks, so new weights are copied over the old ones
+        if (weights.size() > _externalWeights->size() * sizeof(WeightsBlock))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "The new weights are larger than the model's weights");
+        }
+        auto bytes = reinterpret_cast<uint8_t*>(_externalWeights->data());
+        std::copy(weights.begin(), weights.end(), bytes);
+        std::fill(bytes + weights.size(), bytes + _externalWeights->size() * sizeof(WeightsBlock), uint8_t{ 0 });
+    }
+
+    void IRCompiledMap::UpdateWeights(const Map& map)
+    {
+        if (!_externalWeights)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Only a model compiled with the externalWeights option can update its weights");
+        }
+
+        IRMapCompiler compiler(GetMapCompilerOptions(), _optimizerOptions);
+        auto weights = compiler.CompileWeights(map);
+        if (weights.blocks != *_externalWeightsLayout)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch, "The map's weights don't have the same layout as the model's weights");
+        }
+        CopyExternalWeights(weights.data);
+    }
+
+    void IRCompiledMap::UpdateWeights(const std::string& filePath)
+    {
+        if (!_externalWeights)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Only a model compiled with the externalWeights option can update its weights");
+        }
+
+        auto stream = utilities::OpenBinaryIfstream(filePath);
+        std::vector<uint8_t> weights(_externalWeights->size() * sizeof(WeightsBlock));
+        stream.read(reinterpret_cast<char*>(weights.data()), static_cast<std::streamsize>(weights.size()));
+        if (static_cast<size_t>(stream.gcount()) != weights.size() || stream.peek() != std::char_traits<char>::eof())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "The weights file " + filePath + " doesn't have the size of the model's weights");
+        }
+        CopyExternalWeights(weights);
+    }
+
+    void IRCompiledMap::WriteExternalWeights(const std::string& filePath) const
+    {
+        if (!_externalWeights)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Only a model compiled with the externalWeights option has external weights");
+        }
+
+        auto stream = utilities::OpenBinaryOfstream(filePath);
+        stream.write(reinterpret_cast<const char*>(_externalWeights->data()), _externalWeights->size() * sizeof(WeightsBlock));
+    }
+
+    const FootprintReport& IRCompiledMap::GetFootprintReport() const
+    {
+        if (!_footprintReport)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Only a model compiled with the footprintReport option has a footprint report");
+        }
+        return *_footprintReport;
+    }
+
+    void IRCompiledMap::WriteFootprintReport(const std::string& filePath) const
+    {
+        auto stream = utilities::OpenOfstream(filePath);
+        GetFootprintReport().WriteJson(stream);
+    }
+
+    void IRCompiledMap::StartOptimizedCompile()
+    {
+        // LLVM contexts can't be shared between threads, so the background compile gets its own copy of the module
+        // in its own context
+        llvm::SmallVector<char, 0> bitcode;
+        llvm::raw_svector_ostream stream(bitcode);
+        llvm::WriteBitcodeToFile(*_module.GetLLVMModule(), stream);
+
+        _optimizedCode = std::make_shared<OptimizedCode>();
+        _optimizedCompile = std::async(std::launch::async, [optimizedCode = _optimizedCode, bitcode = std::move(bitcode), functionName = GetFunctionName(), hasBatchFunction = GetMapCompilerOptions().emitBatchPredictFunction, hasDynamicFunction = GetMapCompilerOptions().dynamicInputExtent, compilerOptions = GetMapCompilerOptions().compilerSettings, verify = _verifyJittedModule] {
+            optimizedCode->context = std::make_unique<llvm::LLVMContext>();
+            auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), "optimized"), *optimizedCode->context);
+            if (!module)
+            {
+                throw emitters::EmitterException(emitters::EmitterError::unexpected, "Failed to copy module for optimization: " + llvm::toString(module.takeError()));
+            }
+
+            {
+                emitters::IROptimizer optimizer(*module.get(), nullptr, compilerOptions);
+                optimizer.AddStandardPasses();
+                for (auto& function : *module.get())
+                {
+                    if (!function.isDeclaration())
+                    {
+                        optimizer.OptimizeFunction(&function);
+                    }
+                }
+                optimizer.OptimizeModule(module.get().get());
+            }
+
+            optimizedCode->executionEngine = std::make_unique<emitters::IRExecutionEngine>(std::move(module.get()), verify);
+            if (hasBatchFunction)
+            {
+                optimizedCode->batchPredictFunction = optimizedCode->executionEngine->ResolveFunctionAddress(functionName + "_batch");
+            }
+            if (hasDynamicFunction)
+            {
+                optimizedCode->dynamicPredictFunction = optimizedCode->executionEngine->ResolveFunctionAddress(functionName + "_dynamic");
+            }
+            optimizedCode->predictFunction.store(optimizedCode->executionEngine->ResolveFunctionAddress(functionName), std::memory_order_release);
+        });
+    }
+
+    uint64_t IRCompiledMap::GetPredictFunctionAddress() const
+    {
+        auto optimizedFunction = _optimizedCode ? _optimizedCode->predictFunction.load(std::memory_order_acquire) : 0;
+        return optimizedFunction != 0 ? optimizedFunction : _predictFunction;
+    }
+
+    uint64_t IRCompiledMap::GetBatchPredictFunctionAddress() const
+    {
+        auto optimizedFunction = _optimizedCode ? _optimizedCode->predictFunction.load(std::memory_order_acquire) : 0;
+        return optimizedFunction != 0 ? _optimizedCode->batchPredictFunction : _batchPredictFunction;
+    }
+
+    uint64_t IRCompiledMap::GetDynamicPredictFunctionAddress() const
+    {
+        auto optimizedFunction = _optimizedCode ? _optimizedCode->predictFunction.load(std::memory_order_acquire) : 0;
+        return optimizedFunction != 0 ? _optimizedCode->dynamicPredictFunction : _dynamicPredictFunction;
+    }
+
+    bool IRCompiledMap::IsRunningOptimizedCode() const
+    {
+        if (!_tieredCompilation)
+        {
+            return GetMapCompilerOptions().compilerSettings.optimize;
+        }
+        return _optimizedCode && _optimizedCode->predictFunction.load(std::memory_order_acquire) != 0;
+    }
+
+    void IRCompiledMap::WaitForOptimizedCode()
+    {
+        EnsureExecutionEngine();
+        if (_optimizedCompile.valid())
+        {
+            _optimizedCompile.get();
         }
     }
 
@@ -88,6 +316,73 @@ namespace model
         SetComputeFunction();
     }
 
+    void IRCompiledMap::InitializeState()
+    {
+        auto stateSize = _executionEngine->GetFunction<int64_t()>(_moduleName + "_GetStateSize")();
+        _state.resize((stateSize + sizeof(StateBlock) - 1) / sizeof(StateBlock));
+        _executionEngine->GetFunction<void(void*)>(_moduleName + "_InitState")(_state.data());
+    }
+
+    void IRCompiledMap::Reset()
+    {
+        FinishJitting();
+        if (GetMapCompilerOptions().reentrant)
+        {
+            _executionEngine->GetFunction<void(void*)>(_moduleName + "_Reset")(_state.data());
+        }
+        else
+        {
+            _executionEngine->GetFunction<void()>(_moduleName + "_Reset")();
+        }
+    }
+
+    int IRCompiledMap::SetThreadPoolAffinity(const std::vector<int>& cores)
+    {
+        FinishJitting();
+
+        // The affinity function is only emitted for models that use the thread pool
+        auto address = _executionEngine->GetFunctionAddress(_moduleName + "_SetThreadPoolAffinity");
+        if (address == 0)
+        {
+            return -1;
+        }
+
+        std::vector<int> coresCopy = cores;
+        auto result = reinterpret_cast<int (*)(int*, int)>(address)(coresCopy.data(), static_cast<int>(coresCopy.size()));
+        if (result == 0)
+        {
+            _threadAffinity = std::move(coresCopy);
+        }
+        return result;
+    }
+
+    std::vector<uint8_t> IRCompiledMap::GetState()
+    {
+        if (!GetMapCompilerOptions().reentrant)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Only the state of a reentrant model can be saved");
+        }
+
+        FinishJitting();
+        auto begin = reinterpret_cast<const uint8_t*>(_state.data());
+        return { begin, begin + _state.size() * sizeof(StateBlock) };
+    }
+
+    void IRCompiledMap::SetState(const std::vector<uint8_t>& state)
+    {
+        if (!GetMapCompilerOptions().reentrant)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Only the state of a reentrant model can be restored");
+        }
+
+        FinishJitting();
+        if (state.size() != _state.size() * sizeof(StateBlock))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "The state is the wrong size for this model");
+        }
+        std::copy(state.begin(), state.end(), reinterpret_cast<uint8_t*>(_state.data()));
+    }
+
     void IRCompiledMap::SetComputeFunction()
     {
         switch (GetInput(0)->GetOutputPort().GetType())
@@ -266,16 +561,19 @@ namespace model
 
     void IRCompiledMap::WriteCode(std::ostream& stream, emitters::ModuleOutputFormat format) const
     {
+        EnsureModuleAvailable();
         _module.WriteToStream(stream, format);
     }
 
     void IRCompiledMap::WriteCode(std::ostream& stream, emitters::ModuleOutputFormat format, emitters::MachineCodeOutputOptions options) const
     {
+        EnsureModuleAvailable();
         _module.WriteToStream(stream, format, options);
     }
 
     void IRCompiledMap::WriteCodeHeader(std::ostream& stream, emitters::ModuleOutputFormat format) const
     {
+        EnsureModuleAvailable();
         _module.WriteToStream(stream, format);
     }
 
@@ -381,6 +679,41 @@ namespace model
         return fn(nodeIndex);
     }
 
+    LatencyStatistics* IRCompiledMap::GetModelLatencyStatistics()
+    {
+        auto& jitter = GetJitter();
+        auto fn = reinterpret_cast<LatencyStatistics* (*)()>(jitter.GetFunctionAddress(_moduleName + "_GetModelLatencyStatistics"));
+        return fn();
+    }
+
+    LatencyStatistics* IRCompiledMap::GetNodeLatencyStatistics(int nodeIndex)
+    {
+        auto& jitter = GetJitter();
+        auto fn = reinterpret_cast<LatencyStatistics* (*)(int)>(jitter.GetFunctionAddress(_moduleName + "_GetNodeLatencyStatistics"));
+        return fn(nodeIndex);
+    }
+
+    LatencyStatistics* IRCompiledMap::GetNodeTypeLatencyStatistics(int nodeIndex)
+    {
+        auto& jitter = GetJitter();
+        auto fn = reinterpret_cast<LatencyStatistics* (*)(int)>(jitter.GetFunctionAddress(_moduleName + "_GetNodeTypeLatencyStatistics"));
+        return fn(nodeIndex);
+    }
+
+    void IRCompiledMap::PrintModelLatencyInfo()
+    {
+        auto& jitter = GetJitter();
+        auto fn = reinterpret_cast<void (*)()>(jitter.GetFunctionAddress(_moduleName + "_PrintModelLatencyInfo"));
+        fn();
+    }
+
+    void IRCompiledMap::PrintNodeLatencyInfo()
+    {
+        auto& jitter = GetJitter();
+        auto fn = reinterpret_cast<void (*)()>(jitter.GetFunctionAddress(_moduleName + "_PrintNodeLatencyInfo"));
+        fn();
+    }
+
     //
     // Low-level region profiling support
     //
@@ -404,5 +737,22 @@ namespace model
         auto fn = reinterpret_cast<void (*)()>(jitter.GetFunctionAddress(_moduleName + "_ResetRegionProfilingInfo"));
         fn();
     }
+
+    //
+    // Timeline tracing support
+    //
+    bool IRCompiledMap::WriteProfileTrace(const std::string& filename)
+    {
+        auto& jitter = GetJitter();
+        auto fn = reinterpret_cast<int (*)(const char*)>(jitter.GetFunctionAddress(_moduleName + "_WriteProfileTrace"));
+        return fn(filename.c_str()) == 0;
+    }
+
+    void IRCompiledMap::ResetProfileTrace()
+    {
+        auto& jitter = GetJitter();
+        auto fn = reinterpret_cast<void (*)()>(jitter.GetFunctionAddress(_moduleName + "_ResetProfileTrace"));
+        fn();
+    }
 } // namespace model
 } // namespace ell
@@ -0,0 +1,299 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IRCompiledMapCache.cpp (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IRCompiledMapCache.h"
+#include "Map.h"
+
+#include <emitters/include/IRAssemblyWriter.h>
+#include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/TargetDevice.h>
+
+#include <utilities/include/Files.h>
+#include <utilities/include/JsonArchiver.h>
+#include <utilities/include/Logger.h>
+#include <utilities/include/Unused.h>
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalVariable.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <type_traits>
+
+namespace ell
+{
+namespace model
+{
+    using namespace logging;
+
+    namespace
+    {
+        // Bump this whenever the format of a cache entry, or the code the compiler emits for a given map, changes
+        const char* c_cacheFormatVersion = "ELL-JIT-CACHE-2";
+
+        // The values of the options are written one after the other, each followed by a comma. Strings and lists are
+        // prefixed with their size, so no two different sets of values give the same text.
+        void WriteKeyValue(std::ostream& stream, const std::string& value)
+        {
+            stream << value.size() << ":" << value;
+        }
+
+        void WriteKeyValue(std::ostream& stream, const utilities::Optional<bool>& value)
+        {
+            stream << (value.HasValue() ? (value.GetValue() ? "1" : "0") : "-");
+        }
+
+        template <typename ValueType>
+        void WriteKeyValue(std::ostream& stream, const ValueType& value)
+        {
+            if constexpr (std::is_enum_v<ValueType>)
+            {
+                stream << static_cast<int>(value);
+            }
+            else
+            {
+                utilities::EnsureMaxPrecision<ValueType> precisionScope(stream);
+                stream << value;
+            }
+        }
+
+        template <typename ValueType>
+        void WriteKeyValue(std::ostream& stream, const std::vector<ValueType>& values)
+        {
+            stream << values.size() << ":";
+            for (const auto& value : values)
+            {
+                WriteKeyValue(stream, value);
+                stream << ";";
+            }
+        }
+
+        template <typename... ValueTypes>
+        void WriteKeyLine(std::ostream& stream, const char* name, const ValueTypes&... values)
+        {
+            stream << name << ":";
+            ((WriteKeyValue(stream, values), stream << ","), ...);
+            stream << "\n";
+        }
+
+        // The options are taken apart with structured bindings, which stop compiling when a member is added or
+        // removed, so every option has to be written to the key or explicitly left out of it here.
+        void WriteTargetDevice(std::ostream& stream, emitters::TargetDevice device)
+        {
+            emitters::CompleteTargetDevice(device);
+            const auto& [deviceName, triple, architecture, dataLayout, cpu, features, numBits, l1CacheSize, l2CacheSize, prefetchDistance] = device;
+            WriteKeyLine(stream, "device", deviceName, triple, architecture, dataLayout, cpu, features, numBits, l1CacheSize, l2CacheSize, prefetchDistance);
+        }
+
+        void WriteCompilerOptions(std::ostream& stream, const MapCompilerOptions& options)
+        {
+            // Left out: where the cache is, and whether the JIT verifies the module, don't change the code
+            const auto& [moduleName, mapFunctionName, sourceFunctionName, sinkFunctionName, verifyJittedModule, profile, emitBatchPredictFunction, jitCacheDirectory, planMemory, scheduleForMemory, aliasPorts, reentrant, cacheRefinement, tieredCompilation, parallelizeBranches, externalWeights, footprintReport, dynamicInputExtent, inlineNodes, lazyCompile, shareNodeFunctions, compilerSettings] = options;
+            UNUSED(verifyJittedModule, jitCacheDirectory);
+            WriteKeyLine(stream, "map", moduleName, mapFunctionName, sourceFunctionName, sinkFunctionName, profile, emitBatchPredictFunction, planMemory, scheduleForMemory, aliasPorts, reentrant, cacheRefinement, tieredCompilation, parallelizeBranches, externalWeights, footprintReport, dynamicInputExtent, inlineNodes, lazyCompile, shareNodeFunctions);
+
+            // Left out: the model file name is only used in messages
+            const auto& [optimize, optimizationThreads, optimizationLevel, sizeOptimization, allowInlining, maxOptimizationSeconds, blasType, positionIndependentCode, compilerProfile, profileHardwareCounters, profileLatencyHistograms, profileSamplingInterval, traceExecution, parallelize, useThreadPool, useWorkStealing, threadPoolSpinCount, hotThreadPool, useHugePages, firstTouchBuffers, useSharedRuntime, parallelLoopSchedule, parallelLoopChunkSize, maxThreads, threadAffinity, useFastMath, fastMathAccuracy, includeDiagnosticInfo, targetDevice, useBlas, blasThreads, blasMinOperationsPerThread, useBlockedGemm, smallGemmThreshold, useGpu, gpuMinOperations, useCmsis, weightStorageType, prefetchDistance, unrollLoops, inlineOperators, allowVectorInstructions, vectorWidth, cpuDispatchLevels, debug, modelFile] = compilerSettings;
+            UNUSED(modelFile);
+            WriteKeyLine(stream, "compiler", optimize, optimizationThreads, optimizationLevel, sizeOptimization, allowInlining, maxOptimizationSeconds, blasType, positionIndependentCode, compilerProfile, profileHardwareCounters, profileLatencyHistograms, profileSamplingInterval, traceExecution, parallelize, useThreadPool, useWorkStealing, threadPoolSpinCount, hotThreadPool, useHugePages, firstTouchBuffers, useSharedRuntime, parallelLoopSchedule, parallelLoopChunkSize, maxThreads, threadAffinity, useFastMath, fastMathAccuracy, includeDiagnosticInfo);
+            WriteKeyLine(stream, "codegen", useBlas, blasThreads, blasMinOperationsPerThread, useBlockedGemm, smallGemmThreshold, useGpu, gpuMinOperations, useCmsis, weightStorageType, prefetchDistance, unrollLoops, inlineOperators, allowVectorInstructions, vectorWidth, cpuDispatchLevels, debug);
+            WriteTargetDevice(stream, targetDevice);
+        }
+
+        void WriteOptimizerOptions(std::ostream& stream, const ModelOptimizerOptions& optimizerOptions)
+        {
+            // Sort the entries, so the result doesn't depend on the iteration order of the underlying PropertyBag
+            std::vector<std::string> entries;
+            for (const auto& option : optimizerOptions)
+            {
+                entries.push_back(option.first + "=" + option.second.ToString());
+            }
+            std::sort(entries.begin(), entries.end());
+            for (const auto& entry : entries)
+            {
+                stream << "optimizer:" << entry << "\n";
+            }
+        }
+
+        std::string ToHexString(size_t value)
+        {
+            std::stringstream stream;
+            stream << std::hex << std::setw(2 * sizeof(size_t)) << std::setfill('0') << value;
+            return stream.str();
+        }
+    } // namespace
+
+    std::string GetCompiledMapCacheKey(const Map& map, const MapCompilerOptions& options, const ModelOptimizerOptions& optimizerOptions)
+    {
+        std::stringstream key;
+        key << c_cacheFormatVersion << "\n"
+            << "llvm:" << LLVM_VERSION_STRING << "\n";
+        WriteCompilerOptions(key, options);
+        WriteOptimizerOptions(key, optimizerOptions);
+
+        utilities::JsonArchiver archiver(key);
+        archiver.Archive(map);
+        return key.str();
+    }
+
+    std::string GetCompiledMapCacheEntryName(const std::string& key)
+    {
+        return ToHexString(std::hash<std::string>{}(key)) + ".ellcache";
+    }
+
+    std::string GetCompiledMapCacheEntryName(const Map& map, const MapCompilerOptions& options, const ModelOptimizerOptions& optimizerOptions)
+    {
+        return GetCompiledMapCacheEntryName(GetCompiledMapCacheKey(map, options, optimizerOptions));
+    }
+
+    std::string GetMapCompilerOptionsKey(const MapCompilerOptions& options)
+    {
+        std::stringstream key;
+        WriteCompilerOptions(key, options);
+        return key.str();
+    }
+
+    CachedMachineCode GenerateCachedMachineCode(emitters::IRModuleEmitter& module)
+    {
+        CachedMachineCode result;
+
+        // The JIT doesn't run the static constructors of object files it loads, so we record them and run them by hand.
+        // They're usually internal, so make them visible to the JIT's symbol lookup first.
+        auto llvmModule = module.GetLLVMModule();
+        if (auto constructors = llvmModule->getGlobalVariable("llvm.global_ctors"); constructors && constructors->hasInitializer())
+        {
+            if (auto constructorArray = llvm::dyn_cast<llvm::ConstantArray>(constructors->getInitializer()))
+            {
+                for (auto& entry : constructorArray->operands())
+                {
+                    auto constructor = llvm::cast<llvm::ConstantStruct>(entry);
+                    if (auto function = llvm::dyn_cast<llvm::Function>(constructor->getOperand(1)->stripPointerCasts()))
+                    {
+                        function->setLinkage(llvm::GlobalValue::ExternalLinkage);
+                        function->setVisibility(llvm::GlobalValue::DefaultVisibility);
+                        result.initializationFunctions.push_back(function->getName().str());
+                    }
+                }
+            }
+        }
+
+        auto compilerOptions = module.GetCompilerOptions();
+        emitters::MachineCodeOutputOptions options;
+        options.targetDevice = compilerOptions.targetDevice;
+        if (compilerOptions.optimize)
+        {
+            options.optimizationLevel = emitters::OptimizationLevel::Aggressive;
+        }
+        options.relocModel = emitters::OutputRelocationModel::PIC_; // the JIT may place the code anywhere
+
+        std::stringstream objectStream;
+        module.WriteToStream(objectStream, emitters::ModuleOutputFormat::objectCode, options);
+        result.objectCode = objectStream.str();
+        return result;
+    }
+
+    bool TryReadCachedMachineCode(const std::string& filename, const std::string& key, CachedMachineCode& code)
+    {
+        if (!utilities::FileExists(filename))
+        {
+            return false;
+        }
+
+        auto stream = utilities::OpenBinaryIfstream(filename);
+        std::string version;
+        size_t keySize = 0;
+        size_t numFunctions = 0;
+        size_t objectSize = 0;
+        if (!std::getline(stream, version) || version != c_cacheFormatVersion || !(stream >> keySize))
+        {
+            Log() << "Ignoring invalid JIT cache entry " << filename << EOL;
+            return false;
+        }
+        stream.ignore(); // newline
+
+        // The file name is only a hash of the key, so the entry may have been written for another map or other
+        // options. Only an entry stored under exactly the same key is used.
+        if (keySize != key.size())
+        {
+            Log() << "Ignoring JIT cache entry " << filename << " written for a different map or options" << EOL;
+            return false;
+        }
+        std::string entryKey(keySize, '\0');
+        stream.read(&entryKey[0], keySize);
+        if (static_cast<size_t>(stream.gcount()) != keySize || entryKey != key)
+        {
+            Log() << "Ignoring JIT cache entry " << filename << " written for a different map or options" << EOL;
+            return false;
+        }
+
+        if (!(stream >> numFunctions))
+        {
+            Log() << "Ignoring invalid JIT cache entry " << filename << EOL;
+            return false;
+        }
+        stream.ignore(); // newline
+        code.initializationFunctions.resize(numFunctions);
+        for (auto& name : code.initializationFunctions)
+        {
+            std::getline(stream, name);
+        }
+
+        if (!(stream >> objectSize))
+        {
+            Log() << "Ignoring invalid JIT cache entry " << filename << EOL;
+            return false;
+        }
+        stream.ignore(); // newline
+
+        code.objectCode.resize(objectSize);
+        stream.read(&code.objectCode[0], objectSize);
+        if (static_cast<size_t>(stream.gcount()) != objectSize)
+        {
+            Log() << "Ignoring truncated JIT cache entry " << filename << EOL;
+            return false;
+        }
+        return true;
+    }
+
+    void WriteCachedMachineCode(const std::string& filename, const std::string& key, const CachedMachineCode& code)
+    {
+        auto directory = utilities::GetDirectoryPath(filename);
+        if (!directory.empty())
+        {
+            utilities::EnsureDirectoryExists(directory);
+        }
+
+        std::random_device randomDevice;
+        auto tempFilename = filename + "." + ToHexString(randomDevice()) + ".tmp";
+        {
+            auto stream = utilities::OpenBinaryOfstream(tempFilename);
+            stream << c_cacheFormatVersion << "\n"
+                   << key.size() << "\n";
+            stream.write(key.data(), key.size());
+            stream << code.initializationFunctions.size() << "\n";
+            for (const auto& name : code.initializationFunctions)
+            {
+                stream << name << "\n";
+            }
+            stream << code.objectCode.size() << "\n";
+            stream.write(code.objectCode.data(), code.objectCode.size());
+        }
+
+        if (std::rename(tempFilename.c_str(), filename.c_str()) != 0)
+        {
+            // Most likely another process got there first
+            std::remove(tempFilename.c_str());
+        }
+    }
+} // namespace model
+} // namespace ell
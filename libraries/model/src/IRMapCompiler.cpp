@@ -9,24 +9,44 @@
 #include "IRMapCompiler.h"
 #include "CompilableNode.h"
 #include "CompilableNodeUtilities.h"
+#include "IRCompiledMapCache.h"
 #include "IRModelProfiler.h"
+#include "MemorySchedule.h"
 #include "Model.h"
 #include "OptimizeModelTransformation.h"
 #include "OutputNode.h"
 #include "RefineTransformation.h"
+#include "RefinementCache.h"
 
 #include <emitters/include/EmitterException.h>
+#include <emitters/include/IRCpuDispatch.h>
+#include <emitters/include/IRMemoryPlacement.h>
 #include <emitters/include/IRMetadata.h>
+#include <emitters/include/IRReentrantState.h>
 #include <emitters/include/LLVMUtilities.h>
 #include <emitters/include/Variable.h>
 
+#include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
 #include <utilities/include/Logger.h>
+#include <utilities/include/PhaseTimer.h>
 #include <utilities/include/StringUtil.h>
 
 #include <value/include/LLVMContext.h>
 
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Metadata.h>
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
 #include <memory>
+#include <numeric>
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace ell
@@ -35,6 +55,178 @@ namespace model
 {
     using namespace logging;
 
+    namespace
+    {
+        // Buffers in the memory arena are aligned so they can be accessed with vector loads and stores
+        const size_t c_memoryArenaAlignment = 16;
+
+        // The state struct of a reentrant model needs no more alignment than `malloc` (and `new`) guarantee
+        const size_t c_reentrantStateAlignment = 16;
+
+        // Each constant in the external weights starts on a cache line, and smaller constants stay in the module, where
+        // the optimizer can see their values
+        const size_t c_externalWeightsAlignment = 64;
+        const size_t c_minExternalWeightsSize = 64;
+
+        // open, lseek, and mmap flags, which have the same values on Linux and macOS
+        const int c_openReadOnly = 0; // O_RDONLY
+        const int c_seekEnd = 2; // SEEK_END
+        const int c_protectionRead = 1; // PROT_READ
+        const int c_mapShared = 1; // MAP_SHARED
+
+        bool IsAvailableInEntryBlock(emitters::LLVMValue value, emitters::LLVMFunction function)
+        {
+            if (llvm::isa<llvm::Constant>(value))
+            {
+                return true;
+            }
+            if (auto argument = llvm::dyn_cast<llvm::Argument>(value))
+            {
+                return argument->getParent() == function;
+            }
+            auto instruction = llvm::dyn_cast<llvm::Instruction>(value);
+            return instruction != nullptr && instruction->getParent() == &function->getEntryBlock();
+        }
+
+        // The positions of the nodes each node reads from, among the given nodes
+        std::vector<std::vector<size_t>> GetParentPositions(const std::vector<const Node*>& nodes)
+        {
+            std::unordered_map<const Node*, size_t> positions;
+            for (size_t index = 0; index < nodes.size(); ++index)
+            {
+                positions[nodes[index]] = index;
+            }
+
+            std::vector<std::vector<size_t>> parents(nodes.size());
+            for (size_t index = 0; index < nodes.size(); ++index)
+            {
+                for (auto input : nodes[index]->GetInputPorts())
+                {
+                    if (auto it = positions.find(input->GetReferencedPort().GetNode()); it != positions.end())
+                    {
+                        parents[index].push_back(it->second);
+                    }
+                }
+            }
+            return parents;
+        }
+
+        // Splits nodes, given in the order they're compiled, into groups that don't read from each other (directly or
+        // indirectly), keeping that order
+        std::vector<std::vector<const Node*>> GetIndependentBranches(const std::vector<const Node*>& nodes)
+        {
+            // Each group is identified by the position of its first node
+            std::vector<size_t> roots(nodes.size());
+            std::iota(roots.begin(), roots.end(), 0);
+            auto findRoot = [&roots](size_t index) {
+                while (roots[index] != index)
+                {
+                    roots[index] = roots[roots[index]];
+                    index = roots[index];
+                }
+                return index;
+            };
+
+            auto parents = GetParentPositions(nodes);
+            for (size_t index = 0; index < nodes.size(); ++index)
+            {
+                for (auto parent : parents[index])
+                {
+                    auto root1 = findRoot(index);
+                    auto root2 = findRoot(parent);
+                    roots[std::max(root1, root2)] = std::min(root1, root2);
+                }
+            }
+
+            std::vector<std::vector<const Node*>> branches;
+            std::unordered_map<size_t, size_t> branchIndices;
+            for (size_t index = 0; index < nodes.size(); ++index)
+            {
+                auto [it, isNew] = branchIndices.emplace(findRoot(index), branches.size());
+                if (isNew)
+                {
+                    branches.emplace_back();
+                }
+                branches[it->second].push_back(nodes[index]);
+            }
+            return branches;
+        }
+
+        // Finds the nodes that every other node either depends on or is a dependency of. The nodes between two of
+        // them, in the order they're compiled, only depend on the first one and are only read by the second one.
+        std::vector<bool> FindBottlenecks(const std::vector<const Node*>& nodes)
+        {
+            const auto numNodes = nodes.size();
+            const auto numWords = (numNodes + 63) / 64;
+            auto parents = GetParentPositions(nodes);
+            std::vector<std::vector<size_t>> children(numNodes);
+            for (size_t index = 0; index < numNodes; ++index)
+            {
+                for (auto parent : parents[index])
+                {
+                    children[parent].push_back(index);
+                }
+            }
+
+            // Counts the ancestors (or descendants) of each node, as the union of its parents' (or children's) sets
+            auto countReachableNodes = [numNodes, numWords](const std::vector<std::vector<size_t>>& edges, bool isReversed) {
+                std::vector<std::vector<uint64_t>> reachable(numNodes, std::vector<uint64_t>(numWords, 0));
+                std::vector<size_t> counts(numNodes);
+                for (size_t step = 0; step < numNodes; ++step)
+                {
+                    auto index = isReversed ? numNodes - 1 - step : step;
+                    auto& bits = reachable[index];
+                    for (auto neighbor : edges[index])
+                    {
+                        const auto& neighborBits = reachable[neighbor];
+                        for (size_t word = 0; word < numWords; ++word)
+                        {
+                            bits[word] |= neighborBits[word];
+                        }
+                        bits[neighbor / 64] |= uint64_t{ 1 } << (neighbor % 64);
+                    }
+                    counts[index] = std::accumulate(bits.begin(), bits.end(), size_t{ 0 }, [](size_t sum, uint64_t word) { return sum + std::bitset<64>(word).count(); });
+                }
+                return counts;
+            };
+
+            auto numAncestors = countReachableNodes(parents, false);
+            auto numDescendants = countReachableNodes(children, true);
+            std::vector<bool> isBottleneck(numNodes);
+            for (size_t index = 0; index < numNodes; ++index)
+            {
+                isBottleneck[index] = numAncestors[index] + numDescendants[index] + 1 == numNodes;
+            }
+            return isBottleneck;
+        }
+
+        // The IR instructions of a function, and the size of its local variables
+        std::pair<size_t, size_t> GetInstructionsAndStackBytes(const llvm::Function& function)
+        {
+            const auto& dataLayout = function.getParent()->getDataLayout();
+            size_t instructions = 0;
+            size_t stackBytes = 0;
+            for (const auto& block : function)
+            {
+                instructions += block.size();
+                for (const auto& instruction : block)
+                {
+                    if (auto alloca = llvm::dyn_cast<llvm::AllocaInst>(&instruction))
+                    {
+                        auto count = llvm::dyn_cast<llvm::ConstantInt>(alloca->getArraySize());
+                        stackBytes += dataLayout.getTypeAllocSize(alloca->getAllocatedType()) * (count != nullptr ? count->getZExtValue() : 1);
+                    }
+                }
+            }
+            return { instructions, stackBytes };
+        }
+
+        size_t Difference(size_t after, size_t before)
+        {
+            return after > before ? after - before : 0;
+        }
+    } // namespace
+
     IRMapCompiler::IRMapCompiler() :
         IRMapCompiler(MapCompilerOptions{}, ModelOptimizerOptions{})
     {
@@ -65,40 +257,142 @@ namespace model
         return GetMapCompilerOptions().mapFunctionName;
     }
 
+    std::string IRMapCompiler::GetBatchPredictFunctionName() const
+    {
+        return GetPredictFunctionName() + "_batch";
+    }
+
+    std::string IRMapCompiler::GetDynamicPredictFunctionName() const
+    {
+        return GetPredictFunctionName() + "_dynamic";
+    }
+
     IRCompiledMap IRMapCompiler::Compile(Map map)
+    {
+        return Compile(std::move(map), false);
+    }
+
+    IRCompiledMap IRMapCompiler::CompileRefined(Map map)
+    {
+        return Compile(std::move(map), true);
+    }
+
+    IRCompiledMap IRMapCompiler::Compile(const std::vector<Map>& maps, const std::vector<std::string>& mapNames)
+    {
+        return Compile(MergeMaps(maps, mapNames), false);
+    }
+
+    IRCompiledMap IRMapCompiler::Compile(Map map, bool isRefined)
     {
         Log() << "Compile called for map" << EOL;
+        utilities::PhaseTimer compileTimer("Compile map");
 
-        RefineAndOptimize(map);
+        if (GetMapCompilerOptions().reentrant && (GetMapCompilerOptions().profile || GetMapCompilerOptions().compilerSettings.parallelize))
+        {
+            // The profiling counters and the thread pool are shared by all callers
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Reentrant models can't be compiled with profiling or parallelization enabled");
+        }
 
-        // Renaming callbacks based on map compiler parameters
-        // Note: a more elegant solution is emit variables which get assigned to
-        // function pointers at runtime (prior to computing the map).
-        Log() << "Renaming callbacks..." << EOL;
-        map.RenameCallbacks(GetMapCompilerOptions().sourceFunctionName, GetMapCompilerOptions().sinkFunctionName);
+        // Look for machine code from an earlier compile of the same map. Maps with callbacks aren't cached, because
+        // resolving the callbacks needs the emitted module, and neither are maps with external weights, which aren't
+        // part of the machine code.
+        std::string cacheKey;
+        std::string cacheEntryPath;
+        const auto& jitCacheDirectory = GetMapCompilerOptions().jitCacheDirectory;
+        const bool hasCallbacks = !GetMapCompilerOptions().sourceFunctionName.empty() || !GetMapCompilerOptions().sinkFunctionName.empty();
+        if (!jitCacheDirectory.empty() && !hasCallbacks && !GetMapCompilerOptions().externalWeights && GetMapCompilerOptions().compilerSettings.targetDevice.deviceName == "host")
+        {
+            cacheKey = GetCompiledMapCacheKey(map, GetMapCompilerOptions(), GetModelOptimizerOptions(map.GetModel()));
+            cacheEntryPath = utilities::JoinPaths(jitCacheDirectory, GetCompiledMapCacheEntryName(cacheKey));
+            auto cachedCode = std::make_shared<CachedMachineCode>();
+            if (TryReadCachedMachineCode(cacheEntryPath, cacheKey, *cachedCode))
+            {
+                Log() << "Using cached machine code from " << cacheEntryPath << EOL;
+                return IRCompiledMap(std::move(map), GetMapCompilerOptions().mapFunctionName, GetMapCompilerOptions(), _moduleEmitter, cachedCode, GetMapCompilerOptions().verifyJittedModule);
+            }
+        }
 
-        // Now the model ready for compiling
-        if (GetMapCompilerOptions().profile)
+        // The grouping of the outputs of merged maps is in the model metadata, so look it up before the model passes
+        auto mergedMapNames = GetMergedMapNames(map);
+        auto mergedMapOutputCounts = GetMergedMapOutputCounts(map);
+
+        if (!isRefined)
         {
-            Log() << "Enabling profiling in emitted IR" << EOL;
-            GetModule().AddPreprocessorDefinition(GetNamespacePrefix() + "_PROFILING", "1");
+            RefineAndOptimize(map);
+        }
+
+        utilities::PhaseTimer emitTimer("Emit IR");
+        EmitPredictFunction(map);
+
+        if (GetMapCompilerOptions().emitBatchPredictFunction)
+        {
+            Log() << "Emitting batch predict function" << EOL;
+            EmitBatchPredictFunction(map);
+        }
+
+        if (GetMapCompilerOptions().dynamicInputExtent)
+        {
+            Log() << "Emitting dynamic predict function" << EOL;
+            EmitDynamicPredictFunction(map);
+        }
+
+        if (!mergedMapNames.empty())
+        {
+            Log() << "Emitting predict functions for " << mergedMapNames.size() << " merged maps" << EOL;
+            EmitMergedMapPredictFunctions(map, mergedMapNames, mergedMapOutputCounts);
+        }
+
+        if (GetMapCompilerOptions().externalWeights)
+        {
+            Log() << "Emitting external weights functions for " << _externalWeights.size() << " bytes of weights" << EOL;
+            EmitExternalWeightsFunctions();
         }
-        _profiler = { GetModule(), map.GetModel(), GetMapCompilerOptions().profile };
-        _profiler.EmitInitialization();
 
+        if (GetMapCompilerOptions().reentrant)
         {
-            value::ContextGuard<value::LLVMContext> guard(_moduleEmitter);
+            Log() << "Moving the model state into the state argument" << EOL;
+            EmitReentrantStateFunctions();
+        }
 
-            // Now we have the refined map, compile it
-            Log() << "Compiling map..." << EOL;
-            CompileMap(map, GetPredictFunctionName());
+        if (GetMapCompilerOptions().compilerSettings.useHugePages || GetMapCompilerOptions().compilerSettings.firstTouchBuffers)
+        {
+            Log() << "Placing large buffers in huge pages or on the threads that use them" << EOL;
+            emitters::EmitLargeBufferPlacement(_moduleEmitter);
         }
 
         // Emit runtime model APIs
         EmitModelAPIFunctions(map);
 
-        if (GetMapCompilerOptions().compilerSettings.optimize)
+        const auto& cpuDispatchLevels = GetMapCompilerOptions().compilerSettings.cpuDispatchLevels;
+        if (!cpuDispatchLevels.empty())
+        {
+            if (emitters::SupportsCpuDispatch(GetMapCompilerOptions().compilerSettings.targetDevice.triple))
+            {
+                Log() << "Compiling node functions for several instruction set levels" << EOL;
+                emitters::EmitCpuDispatch(_moduleEmitter, emitters::c_nodeFunctionTagName, cpuDispatchLevels);
+            }
+            else
+            {
+                Log() << "Ignoring CPU dispatch levels for non-x86-64 target" << EOL;
+            }
+        }
+
+        emitTimer.Stop();
+
+        // With tiered compilation, the compiled map JITs the module unoptimized and optimizes a copy of it in the
+        // background. This needs the model's state outside of the module, so both versions of the code can share it
+        // (and only one copy of the module gets its external weights).
+        const auto& options = GetMapCompilerOptions();
+        const bool useTieredCompilation = options.tieredCompilation && options.reentrant && options.compilerSettings.optimize && !options.profile && !options.externalWeights && cacheEntryPath.empty() &&
+                                          emitters::GetFunctionsWithTag(_moduleEmitter, emitters::c_callbackFunctionTagName).empty();
+        if (useTieredCompilation)
         {
+            Log() << "Deferring optimization to the compiled map's background compile" << EOL;
+        }
+        else if (GetMapCompilerOptions().compilerSettings.optimize)
+        {
+            utilities::PhaseTimer timer("Optimize IR");
+
             // Save callback declarations in case they get optimized away
             std::vector<std::tuple<std::string, llvm::FunctionType*, std::vector<std::string>>> savedCallbacks;
             auto callbacks = emitters::GetFunctionsWithTag(_moduleEmitter, emitters::c_callbackFunctionTagName);
@@ -107,9 +401,18 @@ namespace model
                 savedCallbacks.emplace_back(callbackInfo.function->getName(), callbackInfo.function->getFunctionType(), callbackInfo.values);
             }
 
-            emitters::IROptimizer optimizer(_moduleEmitter);
-            optimizer.AddStandardPasses();
-            _moduleEmitter.Optimize(optimizer);
+            const auto optimizationThreads = GetMapCompilerOptions().compilerSettings.optimizationThreads;
+            if (optimizationThreads > 1)
+            {
+                Log() << "Optimizing on " << optimizationThreads << " threads" << EOL;
+                emitters::OptimizeModuleInParallel(_moduleEmitter, optimizationThreads);
+            }
+            else
+            {
+                emitters::IROptimizer optimizer(_moduleEmitter);
+                optimizer.AddStandardPasses();
+                _moduleEmitter.Optimize(optimizer);
+            }
 
             // Reinsert callback declarations after optimization
             for (const auto& savedCallback : savedCallbacks)
@@ -120,16 +423,96 @@ namespace model
             }
         }
 
-        return IRCompiledMap(std::move(map), GetMapCompilerOptions().mapFunctionName, GetMapCompilerOptions(), _moduleEmitter, GetMapCompilerOptions().verifyJittedModule);
+        if (!cacheEntryPath.empty())
+        {
+            Log() << "Writing machine code to cache entry " << cacheEntryPath << EOL;
+            WriteCachedMachineCode(cacheEntryPath, cacheKey, GenerateCachedMachineCode(_moduleEmitter));
+        }
+
+        if (GetMapCompilerOptions().footprintReport)
+        {
+            Log() << "Measuring the machine code of each function for the footprint report" << EOL;
+            _footprintReport.SetExternalWeightBytes(_externalWeights.size());
+            _footprintReport.SetCodeSizes(_moduleEmitter.GetFunctionCodeSizes());
+            auto summary = _footprintReport.GetSummaryLines();
+            auto& comments = _moduleEmitter.GetFunctionDeclaration(GetPredictFunctionName()).GetComments();
+            comments.insert(comments.end(), summary.begin(), summary.end());
+        }
+
+        IRCompiledMap compiledMap(std::move(map), GetMapCompilerOptions().mapFunctionName, GetMapCompilerOptions(), _moduleEmitter, GetMapCompilerOptions().verifyJittedModule, useTieredCompilation);
+        if (GetMapCompilerOptions().externalWeights)
+        {
+            compiledMap.SetExternalWeights({ _externalWeights, _externalWeightsBlocks }, GetModelOptimizerOptions());
+        }
+        if (GetMapCompilerOptions().footprintReport)
+        {
+            compiledMap.SetFootprintReport(std::move(_footprintReport));
+        }
+        return compiledMap;
+    }
+
+    ExternalWeights IRMapCompiler::CompileWeights(Map map)
+    {
+        if (!GetMapCompilerOptions().externalWeights)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Only a compiler with the externalWeights option has external weights");
+        }
+
+        // The weights are placed as the predict function is emitted, so there's no need for the rest of the module,
+        // or to optimize it
+        RefineAndOptimize(map);
+        EmitPredictFunction(map);
+        Log() << "Emitted " << _externalWeights.size() << " bytes of weights" << EOL;
+        _externalWeights.resize((_externalWeights.size() + c_externalWeightsAlignment - 1) / c_externalWeightsAlignment * c_externalWeightsAlignment);
+        return { _externalWeights, _externalWeightsBlocks };
+    }
+
+    void IRMapCompiler::EmitPredictFunction(Map& map)
+    {
+        // Renaming callbacks based on map compiler parameters
+        // Note: a more elegant solution is emit variables which get assigned to
+        // function pointers at runtime (prior to computing the map).
+        Log() << "Renaming callbacks..." << EOL;
+        map.RenameCallbacks(GetMapCompilerOptions().sourceFunctionName, GetMapCompilerOptions().sinkFunctionName);
+
+        // Now the model ready for compiling
+        if (GetMapCompilerOptions().profile)
+        {
+            Log() << "Enabling profiling in emitted IR" << EOL;
+            GetModule().AddPreprocessorDefinition(GetNamespacePrefix() + "_PROFILING", "1");
+        }
+        _profiler = { GetModule(), map.GetModel(), GetMapCompilerOptions().profile };
+        _profiler.EmitInitialization();
+
+        if (GetMapCompilerOptions().dynamicInputExtent)
+        {
+            Log() << "Finding the ports with a dynamic extent" << EOL;
+            FindDynamicExtentPorts(map);
+            _dynamicExtent = _moduleEmitter.Global(GetNamespacePrefix() + "_dynamicExtent", _maxDynamicExtent);
+        }
+
+        value::ContextGuard<value::LLVMContext> guard(_moduleEmitter);
+
+        // Now we have the refined map, compile it
+        Log() << "Compiling map..." << EOL;
+        CompileMap(map, GetPredictFunctionName());
     }
 
     void IRMapCompiler::RefineAndOptimize(Map& map)
     {
         TransformContext context(this);
-        OptimizeModelTransformation optimizer;
-        map.Transform(optimizer, context);
+        if (GetMapCompilerOptions().cacheRefinement)
+        {
+            context.SetRefinementCache(&RefinementCache::GetGlobalCache());
+        }
+        {
+            utilities::PhaseTimer timer("Optimize model");
+            OptimizeModelTransformation optimizer;
+            map.Transform(optimizer, context);
+        }
 
         // Add an extra refine here, in case the optimizer doesn't do it
+        utilities::PhaseTimer timer("Refine");
         RefineTransformation refiner;
         map.Transform(refiner, context);
 
@@ -490,78 +873,353 @@ namespace model
         _moduleEmitter.EndFunction();
     }
 
-    void IRMapCompiler::EmitStringConditionals(emitters::IRFunctionEmitter& fn, std::vector<std::pair<std::string, std::string>> keyValuePairs)
+    void IRMapCompiler::EmitBatchPredictFunction(const Map& map)
     {
-        // This is the type of code we are trying to generate for the GetInputSize and GetOutputSize functions:
+        // This is the type of code we are trying to generate:
         //
-        // int model_GetInputSize(int index)
+        // void model_predict_batch(void* context, float* input, float* output, int batchSize)
         // {
-        //     if (name == "window_size") {
-        //         return "80";
-        //     }
-        //     if (name == "filterbank_size") {
-        //         return "40";
+        //     for (int i = 0; i < batchSize; ++i)
+        //     {
+        //         model_predict(context, input + i * inputSize, output + i * outputSize);
         //     }
-        //     ...
-        //     return "";
         // }
         //
-        auto arguments = fn.Arguments().begin();
-        auto nameArgument = &(*arguments++);
-        auto pMainBlock = fn.GetCurrentBlock();
+        // Each input and output argument points to `batchSize` contiguous samples. The samples run one after another
+        // through the per-sample code, so dense layers still multiply one vector at a time, and `parallelize` only
+        // applies to the loops inside the predict function.
+        auto predictFunction = _moduleEmitter.GetFunction(GetPredictFunctionName());
+        auto& predictDeclaration = _moduleEmitter.GetFunctionDeclaration(GetPredictFunctionName());
+        emitters::FunctionArgumentList arguments = predictDeclaration.GetArguments();
+        arguments.push_back({ "batchSize", emitters::VariableType::Int32, emitters::ArgumentFlags::Input });
+
+        // Sizes of the pointer arguments, in order (after the context and, for reentrant models, the state)
+        std::vector<int> sampleSizes;
+        for (size_t i = 0, n = map.NumInputs(); i < n; ++i)
+        {
+            sampleSizes.push_back(map.GetInputSize(i));
+        }
+        for (size_t i = 0, n = map.NumOutputs(); i < n; ++i)
+        {
+            sampleSizes.push_back(map.GetOutputSize(i));
+        }
 
-        auto strCompare = _moduleEmitter.GetRuntime().GetStringCompareFunction();
+        auto function = _moduleEmitter.BeginFunction(GetBatchPredictFunctionName(), emitters::VariableType::Void, arguments);
+        function.SetAttributeForArguments(emitters::IRFunctionEmitter::Attributes::NoAlias);
+        function.IncludeInHeader();
+        _moduleEmitter.GetFunctionDeclaration(GetBatchPredictFunctionName()).GetComments() = { "Calls " + GetPredictFunctionName() + " on each of batchSize contiguous samples" };
 
-        std::vector<llvm::BasicBlock*> blocks;
-        blocks.push_back(pMainBlock);
-        // create the final block in the case the index is out of range or there are no shapes and reutrn empty TensorShape.
-        auto pDoneBlock = fn.BeginBlock("NoMatchBlock");
+        std::vector<emitters::LLVMValue> argumentValues;
+        for (auto& argument : function.Arguments())
         {
-            fn.Return(fn.Literal(""));
+            argumentValues.push_back(&argument);
+        }
+        const size_t numLeadingArguments = GetMapCompilerOptions().reentrant ? 2 : 1;
+        auto batchSize = argumentValues.back();
+        if (argumentValues.size() != sampleSizes.size() + numLeadingArguments + 1)
+        {
+            throw emitters::EmitterException(emitters::EmitterError::unexpected, "Predict function arguments don't match map inputs and outputs");
         }
 
-        if (!keyValuePairs.empty())
+        function.For(batchSize, [&](emitters::IRFunctionEmitter& function, emitters::LLVMValue sampleIndex) {
+            emitters::IRValueList callArguments(argumentValues.begin(), argumentValues.begin() + numLeadingArguments);
+            for (size_t i = 0; i < sampleSizes.size(); ++i)
+            {
+                auto offset = function.Operator(emitters::TypedOperator::multiply, sampleIndex, function.Literal<int>(sampleSizes[i]));
+                callArguments.push_back(function.PointerOffset(argumentValues[i + numLeadingArguments], offset));
+            }
+            function.Call(predictFunction, callArguments);
+        });
+        _moduleEmitter.EndFunction();
+    }
+
+    void IRMapCompiler::EmitMergedMapPredictFunctions(const Map& map, const std::vector<std::string>& mapNames, const std::vector<int>& outputCounts)
+    {
+        // This is the type of code we are trying to generate, for each merged map:
+        //
+        // void model_predict_map1(void* context, float* input, float* map1_output)
+        // {
+        //     float map2_output[map2OutputSize];
+        //     model_predict(context, input, map1_output, map2_output);
+        // }
+        //
+        // The whole merged model runs on every call, so the maps' shared state advances once per call of any of
+        // these functions, and callers that want several maps' outputs for the same input call model_predict.
+        const auto numOutputs = static_cast<int>(map.NumOutputs());
+        if (outputCounts.size() != mapNames.size() || std::accumulate(outputCounts.begin(), outputCounts.end(), 0) != numOutputs)
         {
-            int index = 0;
-            for (auto pair : keyValuePairs)
+            throw emitters::EmitterException(emitters::EmitterError::unexpected, "Merged map output counts don't match the map outputs");
+        }
+
+        auto predictFunction = _moduleEmitter.GetFunction(GetPredictFunctionName());
+        const auto& predictArguments = _moduleEmitter.GetFunctionDeclaration(GetPredictFunctionName()).GetArguments();
+        const size_t numLeadingArguments = GetMapCompilerOptions().reentrant ? 2 : 1;
+        const size_t numInputs = map.NumInputs();
+        if (predictArguments.size() != numLeadingArguments + numInputs + numOutputs)
+        {
+            throw emitters::EmitterException(emitters::EmitterError::unexpected, "Predict function arguments don't match map inputs and outputs");
+        }
+
+        int firstOutput = 0;
+        for (size_t mapIndex = 0; mapIndex < mapNames.size(); ++mapIndex)
+        {
+            const int endOutput = firstOutput + outputCounts[mapIndex];
+            emitters::FunctionArgumentList arguments(predictArguments.begin(), predictArguments.begin() + numLeadingArguments + numInputs);
+            arguments.insert(arguments.end(), predictArguments.begin() + numLeadingArguments + numInputs + firstOutput, predictArguments.begin() + numLeadingArguments + numInputs + endOutput);
+
+            auto functionName = GetPredictFunctionName() + "_" + mapNames[mapIndex];
+            auto function = _moduleEmitter.BeginFunction(functionName, emitters::VariableType::Void, arguments);
+            function.SetAttributeForArguments(emitters::IRFunctionEmitter::Attributes::NoAlias);
+            function.IncludeInHeader();
+            _moduleEmitter.GetFunctionDeclaration(functionName).GetComments() = { "Computes the outputs of the " + mapNames[mapIndex] + " model, with " + GetPredictFunctionName() };
+
+            std::vector<emitters::LLVMValue> argumentValues;
+            for (auto& argument : function.Arguments())
             {
-                std::string key = pair.first;
-                std::string value = pair.second;
+                argumentValues.push_back(&argument);
+            }
 
-                std::string labelSuffix = std::to_string(index);
-                auto followBlock = fn.BeginBlock("FollowBlock" + labelSuffix);
-                auto thenBlock = fn.BeginBlock("ThenBlock" + labelSuffix);
-                {
-                    fn.Return(fn.Literal(value));
-                }
-                auto elseBlock = fn.BeginBlock("ElseBlock" + labelSuffix);
+            // The other maps' outputs go to buffers on the stack
+            emitters::IRValueList callArguments(argumentValues.begin(), argumentValues.begin() + numLeadingArguments + numInputs);
+            for (int outputIndex = 0; outputIndex < numOutputs; ++outputIndex)
+            {
+                if (outputIndex >= firstOutput && outputIndex < endOutput)
                 {
-                    fn.Branch(followBlock);
+                    callArguments.push_back(argumentValues[numLeadingArguments + numInputs + outputIndex - firstOutput]);
                 }
-                auto conditionBlock = fn.BeginBlock("IfBlock" + labelSuffix);
+                else
                 {
-                    auto compare = fn.Call(strCompare, { nameArgument, fn.Literal(key) });
-                    auto isEqual = fn.LocalScalar(compare) == 1;
-                    llvm::BranchInst::Create(thenBlock, elseBlock, isEqual, conditionBlock);
+                    const auto& output = map.GetOutput(outputIndex);
+                    callArguments.push_back(function.Variable(PortTypeToVariableType(output.GetType()), static_cast<int>(output.Size())));
                 }
-                blocks.push_back(conditionBlock);
-                blocks.push_back(followBlock);
             }
-            fn.SetCurrentBlock(blocks[blocks.size() - 1]);
-            fn.Branch(pDoneBlock);
+            function.Call(predictFunction, callArguments);
+            _moduleEmitter.EndFunction();
+            firstOutput = endOutput;
         }
+    }
 
-        fn.SetCurrentBlock(pMainBlock);
-        if (blocks.size() > 1)
+    void IRMapCompiler::FindDynamicExtentPorts(const Map& map)
+    {
+        // The dynamic extent is the outermost dimension of the first input. It carries over to the outputs of the
+        // nodes that read it, so every node that reads a port with a dynamic extent has to support one.
+        if (map.NumInputs() == 0 || map.GetInput(0)->GetOutputPort().GetMemoryLayout().NumDimensions() == 0)
         {
-            fn.Branch(blocks[1]); // jump to first statement.
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "A dynamic input extent needs a map with an input");
         }
 
-        blocks.push_back(pDoneBlock);
-        // ensure all blocks are properly chained with branch instructions and inserted into the function BasicBlockList.
-        fn.ConcatenateBlocks(blocks);
-    }
-
+        const auto& inputPort = map.GetInput(0)->GetOutputPort();
+        _maxDynamicExtent = inputPort.GetMemoryLayout().GetActiveSize(0);
+        _dynamicExtentPorts = { &inputPort };
+        map.GetModel().Visit([this](const Node& node) {
+            auto readsDynamicExtent = std::any_of(node.GetInputPorts().begin(), node.GetInputPorts().end(), [this](const InputPortBase* input) {
+                return _dynamicExtentPorts.find(&input->GetReferencedPort()) != _dynamicExtentPorts.end();
+            });
+            if (!readsDynamicExtent)
+            {
+                return;
+            }
+
+            auto compilableNode = dynamic_cast<const CompilableNode*>(&node);
+            if (compilableNode == nullptr || !compilableNode->SupportsDynamicExtent())
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Node " + DiagnosticString(node) + " doesn't support a dynamic input extent");
+            }
+            for (auto output : node.GetOutputPorts())
+            {
+                const auto& layout = output->GetMemoryLayout();
+                if (layout.NumDimensions() == 0 || layout.GetActiveSize(0) != _maxDynamicExtent)
+                {
+                    throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "The outermost dimension of the output of node " + DiagnosticString(node) + " doesn't match the input's");
+                }
+                _dynamicExtentPorts.insert(output);
+            }
+        });
+    }
+
+    void IRMapCompiler::EmitDynamicPredictFunction(const Map& map)
+    {
+        // This is the type of code we are trying to generate:
+        //
+        // void model_predict_dynamic(void* context, float* input, float* output, int extent)
+        // {
+        //     model_dynamicExtent = min(max(extent, 0), maxExtent);
+        //     model_predict(context, input, output);
+        //     model_dynamicExtent = maxExtent;
+        // }
+        //
+        // The nodes that read the extent are inlined into the predict function, and the buffers are sized for maxExtent.
+        auto predictFunction = _moduleEmitter.GetFunction(GetPredictFunctionName());
+        auto& predictDeclaration = _moduleEmitter.GetFunctionDeclaration(GetPredictFunctionName());
+        emitters::FunctionArgumentList arguments = predictDeclaration.GetArguments();
+        arguments.push_back({ "extent", emitters::VariableType::Int32, emitters::ArgumentFlags::Input });
+
+        auto function = _moduleEmitter.BeginFunction(GetDynamicPredictFunctionName(), emitters::VariableType::Void, arguments);
+        function.SetAttributeForArguments(emitters::IRFunctionEmitter::Attributes::NoAlias);
+        function.IncludeInHeader();
+        _moduleEmitter.GetFunctionDeclaration(GetDynamicPredictFunctionName()).GetComments() = { "Calls " + GetPredictFunctionName() + " on the first extent (at most " + std::to_string(_maxDynamicExtent) + ") entries along the outermost dimension of input '" + map.GetInputName(0) + "'" };
+
+        emitters::IRValueList callArguments;
+        for (auto& argument : function.Arguments())
+        {
+            callArguments.push_back(&argument);
+        }
+        auto extent = callArguments.back();
+        callArguments.pop_back();
+
+        auto maxExtent = function.Literal<int>(_maxDynamicExtent);
+        auto zero = function.Literal<int>(0);
+        extent = function.Select(function.Comparison(emitters::TypedComparison::lessThan, extent, zero), zero, extent);
+        extent = function.Select(function.Comparison(emitters::TypedComparison::greaterThan, extent, maxExtent), maxExtent, extent);
+        function.Store(_dynamicExtent, extent);
+        function.Call(predictFunction, callArguments);
+        function.Store(_dynamicExtent, maxExtent);
+        _moduleEmitter.EndFunction();
+    }
+
+    emitters::LLVMValue IRMapCompiler::GetDynamicExtent(const OutputPortBase& port, emitters::IRFunctionEmitter& function)
+    {
+        if (_dynamicExtent == nullptr || _dynamicExtentPorts.find(&port) == _dynamicExtentPorts.end())
+        {
+            return nullptr;
+        }
+        return function.Load(_dynamicExtent);
+    }
+
+    bool IRMapCompiler::HasDynamicExtent(const Node& node) const
+    {
+        const auto& outputs = node.GetOutputPorts();
+        return std::any_of(outputs.begin(), outputs.end(), [this](const OutputPortBase* output) {
+            return _dynamicExtentPorts.find(output) != _dynamicExtentPorts.end();
+        });
+    }
+
+    void IRMapCompiler::EmitReentrantStateFunctions()
+    {
+        // This is the type of code we are trying to generate:
+        //
+        // int64_t model_GetStateSize()
+        // {
+        //     return sizeof(model_State);
+        // }
+        //
+        // void model_InitState(void* state)
+        // {
+        //     memcpy(state, &model_initialState, sizeof(model_State)); // or memset, if the initial state is all zero
+        // }
+        std::vector<std::string> entryFunctionNames = { GetPredictFunctionName(), GetNamespacePrefix() + "_Reset" };
+        if (GetMapCompilerOptions().emitBatchPredictFunction)
+        {
+            entryFunctionNames.push_back(GetBatchPredictFunctionName());
+        }
+        if (GetMapCompilerOptions().dynamicInputExtent)
+        {
+            entryFunctionNames.push_back(GetDynamicPredictFunctionName());
+        }
+        auto state = emitters::MoveGlobalStateToArgument(_moduleEmitter, entryFunctionNames, "state", c_reentrantStateAlignment);
+        Log() << "Model state: " << state.globalNames.size() << " globals, " << state.size << " bytes" << EOL;
+
+        auto sizeFunction = _moduleEmitter.BeginFunction(GetNamespacePrefix() + "_GetStateSize", emitters::VariableType::Int64);
+        sizeFunction.IncludeInHeader();
+        sizeFunction.Return(sizeFunction.Literal<int64_t>(static_cast<int64_t>(state.size)));
+        _moduleEmitter.EndFunction();
+        _moduleEmitter.GetFunctionDeclaration(GetNamespacePrefix() + "_GetStateSize").GetComments() = { "Size in bytes of the state passed to " + GetPredictFunctionName() + ". The state must be aligned to " + std::to_string(c_reentrantStateAlignment) + " bytes" };
+
+        const emitters::NamedVariableTypeList parameters = { { "state", emitters::VariableType::VoidPointer } };
+        auto initFunction = _moduleEmitter.BeginFunction(GetNamespacePrefix() + "_InitState", emitters::VariableType::Void, parameters);
+        initFunction.IncludeInHeader();
+        if (state.size > 0)
+        {
+            auto& irEmitter = _moduleEmitter.GetIREmitter();
+            auto stateArgument = initFunction.GetFunctionArgument("state");
+            auto size = irEmitter.Literal(static_cast<int64_t>(state.size));
+            if (state.initialValue->isNullValue())
+            {
+                irEmitter.MemorySet(stateArgument, irEmitter.Zero(emitters::VariableType::Byte), size);
+            }
+            else
+            {
+                auto initialState = new llvm::GlobalVariable(*_moduleEmitter.GetLLVMModule(), state.type, true, llvm::GlobalValue::InternalLinkage, state.initialValue, GetNamespacePrefix() + "_initialState");
+                initialState->setAlignment(state.alignment);
+                irEmitter.MemoryCopy(initialState, stateArgument, size);
+            }
+        }
+        _moduleEmitter.EndFunction();
+        _moduleEmitter.GetFunctionDeclaration(GetNamespacePrefix() + "_InitState").GetComments() = { "Sets a state to the model's initial state. Every state must be initialized before its first use." };
+    }
+
+    void IRMapCompiler::EmitStringConditionals(emitters::IRFunctionEmitter& fn, std::vector<std::pair<std::string, std::string>> keyValuePairs)
+    {
+        // This is the type of code we are trying to generate for the GetInputSize and GetOutputSize functions:
+        //
+        // int model_GetInputSize(int index)
+        // {
+        //     if (name == "window_size") {
+        //         return "80";
+        //     }
+        //     if (name == "filterbank_size") {
+        //         return "40";
+        //     }
+        //     ...
+        //     return "";
+        // }
+        //
+        auto arguments = fn.Arguments().begin();
+        auto nameArgument = &(*arguments++);
+        auto pMainBlock = fn.GetCurrentBlock();
+
+        auto strCompare = _moduleEmitter.GetRuntime().GetStringCompareFunction();
+
+        std::vector<llvm::BasicBlock*> blocks;
+        blocks.push_back(pMainBlock);
+        // create the final block in the case the index is out of range or there are no shapes and reutrn empty TensorShape.
+        auto pDoneBlock = fn.BeginBlock("NoMatchBlock");
+        {
+            fn.Return(fn.Literal(""));
+        }
+
+        if (!keyValuePairs.empty())
+        {
+            int index = 0;
+            for (auto pair : keyValuePairs)
+            {
+                std::string key = pair.first;
+                std::string value = pair.second;
+
+                std::string labelSuffix = std::to_string(index);
+                auto followBlock = fn.BeginBlock("FollowBlock" + labelSuffix);
+                auto thenBlock = fn.BeginBlock("ThenBlock" + labelSuffix);
+                {
+                    fn.Return(fn.Literal(value));
+                }
+                auto elseBlock = fn.BeginBlock("ElseBlock" + labelSuffix);
+                {
+                    fn.Branch(followBlock);
+                }
+                auto conditionBlock = fn.BeginBlock("IfBlock" + labelSuffix);
+                {
+                    auto compare = fn.Call(strCompare, { nameArgument, fn.Literal(key) });
+                    auto isEqual = fn.LocalScalar(compare) == 1;
+                    llvm::BranchInst::Create(thenBlock, elseBlock, isEqual, conditionBlock);
+                }
+                blocks.push_back(conditionBlock);
+                blocks.push_back(followBlock);
+            }
+            fn.SetCurrentBlock(blocks[blocks.size() - 1]);
+            fn.Branch(pDoneBlock);
+        }
+
+        fn.SetCurrentBlock(pMainBlock);
+        if (blocks.size() > 1)
+        {
+            fn.Branch(blocks[1]); // jump to first statement.
+        }
+
+        blocks.push_back(pDoneBlock);
+        // ensure all blocks are properly chained with branch instructions and inserted into the function BasicBlockList.
+        fn.ConcatenateBlocks(blocks);
+    }
+
     //
     // Node implementor methods:
     //
@@ -598,12 +1256,41 @@ namespace model
         currentFunction.IncludeInPredictInterface();
 
         _profiler.StartModel(currentFunction);
+
+        if (GetMapCompilerOptions(model).planMemory)
+        {
+            BeginMemoryPlan(model);
+        }
+
+        if (GetMapCompilerOptions(model).aliasPorts && _aliasFunction == nullptr)
+        {
+            _aliasFunction = currentFunction.GetFunction();
+            FindInPlaceInputs(model);
+        }
+
+        if (GetMapCompilerOptions(model).externalWeights && _externalWeightsFunction == nullptr)
+        {
+            _externalWeightsFunction = currentFunction.GetFunction();
+        }
     }
 
     void IRMapCompiler::OnEndCompileModel(const Model& model)
     {
         auto& currentFunction = GetModule().GetCurrentFunction();
         _profiler.EndModel(currentFunction);
+
+        if (IsPlanningMemory())
+        {
+            EndMemoryPlan();
+        }
+
+        if (currentFunction.GetFunction() == _aliasFunction)
+        {
+            _aliasFunction = nullptr;
+            _portAliases.clear();
+            _aliasedVariables.clear();
+            _inPlacePorts.clear();
+        }
     }
 
     void IRMapCompiler::OnBeginCompileNode(const Node& node)
@@ -617,6 +1304,21 @@ namespace model
 
         _profiler.InitNode(currentFunction, node);
         _profiler.StartNode(currentFunction, node);
+
+        if (CanAliasPorts())
+        {
+            PlaceOutputsInPlace(node);
+        }
+
+        if (IsPlanningMemory())
+        {
+            AllocatePlannedPortVariables(node);
+        }
+
+        if (GetMapCompilerOptions().footprintReport)
+        {
+            BeginNodeFootprint();
+        }
     }
 
     void IRMapCompiler::OnEndCompileNode(const Node& node)
@@ -634,9 +1336,879 @@ namespace model
             currentFunction.GetCurrentRegion()->SetEnd(pCurBlock);
         }
 
+        if (GetMapCompilerOptions().footprintReport)
+        {
+            EndNodeFootprint(node);
+        }
+
+        if (IsPlanningMemory())
+        {
+            ReleasePlannedPortVariables(node);
+        }
+
         Log() << "Finished compiling node " << DiagnosticString(node) << EOL;
     }
 
+    //
+    // Branch parallelism
+    //
+
+    void IRMapCompiler::CompileNodes(Model& model)
+    {
+        FindConditionalBranches(model);
+        if (!_conditionalNodes.empty())
+        {
+            // The nodes left out of the sequence would hide dependencies between parallel branches, so a model with
+            // conditional branches is compiled in one sequence
+            Log() << "Compiling " << _conditionalNodes.size() << " nodes in " << _conditionalBranchNodes.size() << " conditional branches" << EOL;
+            _hasBranchFunctions = true;
+            model.Visit([this](const Node& node) {
+                if (_conditionalNodes.find(&node) == _conditionalNodes.end())
+                {
+                    CompileNodeAndConditionalBranches(node);
+                }
+            });
+            _hasBranchFunctions = false;
+            _conditionalNodes.clear();
+            _conditionalBranchNodes.clear();
+            _conditionalBranchFunctions.clear();
+            return;
+        }
+
+        if (!ShouldParallelizeBranches(model))
+        {
+            if (IsPlanningMemory() && GetMapCompilerOptions(model).scheduleForMemory)
+            {
+                for (auto node : GetMemoryAwareNodeOrder(model, [this](const OutputPortBase& port) { return GetPlannedBufferSize(port); }))
+                {
+                    CompileNode(*node);
+                }
+                return;
+            }
+            MapCompiler::CompileNodes(model);
+            return;
+        }
+
+        // Nodes without inputs, like input nodes and constants, don't wait for anything, and would tie together all
+        // the branches that read them
+        _hasBranchFunctions = true;
+        std::vector<const Node*> nodes;
+        model.Visit([this, &nodes](const Node& node) {
+            if (node.GetInputPorts().empty())
+            {
+                CompileNode(node);
+            }
+            else
+            {
+                nodes.push_back(&node);
+            }
+        });
+        CompileSubgraph(nodes);
+        _hasBranchFunctions = false;
+    }
+
+    bool IRMapCompiler::ShouldParallelizeBranches(const Model& model) const
+    {
+        // Memory planning reuses a buffer once the nodes compiled before a node are done with it, and profiling
+        // counters are shared by the nodes of a type, so neither works with nodes that run at the same time
+        auto options = GetMapCompilerOptions(model);
+        return options.parallelizeBranches && options.compilerSettings.parallelize && !options.profile && !IsPlanningMemory();
+    }
+
+    void IRMapCompiler::CompileSubgraph(const std::vector<const Node*>& nodes)
+    {
+        auto branches = GetIndependentBranches(nodes);
+        if (branches.size() > 1)
+        {
+            CompileBranches(std::move(branches));
+            return;
+        }
+
+        // A connected subgraph runs in stages, separated by the nodes everything else in it depends on or is read by,
+        // and the nodes of a stage may be independent branches again
+        auto isBottleneck = FindBottlenecks(nodes);
+        if (std::none_of(isBottleneck.begin(), isBottleneck.end(), [](bool value) { return value; }))
+        {
+            for (auto node : nodes)
+            {
+                CompileNode(*node);
+            }
+            return;
+        }
+
+        std::vector<const Node*> stage;
+        for (size_t index = 0; index < nodes.size(); ++index)
+        {
+            if (!isBottleneck[index])
+            {
+                stage.push_back(nodes[index]);
+                continue;
+            }
+
+            if (!stage.empty())
+            {
+                CompileSubgraph(stage);
+                stage.clear();
+            }
+            CompileNode(*nodes[index]);
+        }
+        if (!stage.empty())
+        {
+            CompileSubgraph(stage);
+        }
+    }
+
+    void IRMapCompiler::CompileBranches(std::vector<std::vector<const Node*>> branches)
+    {
+        auto largestBranch = std::max_element(branches.begin(), branches.end(), [](const auto& a, const auto& b) { return a.size() < b.size(); });
+        std::iter_swap(largestBranch, branches.end() - 1);
+
+        auto& forkFunction = GetModule().GetCurrentFunction();
+        Log() << "Running " << branches.size() << " independent branches of the model at the same time in " << forkFunction.GetFunctionName() << EOL;
+
+        // Branch functions take the arguments of the function they're forked from, so the map's inputs and outputs
+        // have the same names in them
+        emitters::NamedLLVMTypeList parameters;
+        std::vector<emitters::LLVMValue> arguments;
+        for (auto& argument : forkFunction.GetFunction()->args())
+        {
+            parameters.emplace_back(argument.getName().str(), argument.getType());
+            arguments.push_back(&argument);
+        }
+
+        std::vector<emitters::IRTask> tasks;
+        for (size_t index = 0; index + 1 < branches.size(); ++index)
+        {
+            auto branchFunction = EmitBranchFunction(branches[index], parameters);
+            tasks.push_back(forkFunction.StartAsyncTask(branchFunction, arguments));
+        }
+
+        // The nodes after the join can't merge their code into the regions of the branch's nodes, which come before it
+        _nodeRegions.emplace_back();
+        CompileSubgraph(branches.back());
+        _nodeRegions.pop_back();
+
+        for (auto& task : tasks)
+        {
+            task.Wait(forkFunction);
+        }
+    }
+
+    emitters::LLVMFunction IRMapCompiler::EmitBranchFunction(const std::vector<const Node*>& branch, const emitters::NamedLLVMTypeList& parameters)
+    {
+        auto& module = GetModule();
+        auto forkFunction = module.GetCurrentFunction().GetFunction();
+        auto functionName = module.GetCurrentFunction().GetFunctionName() + "_branch" + std::to_string(_branchFunctions.size());
+
+        // The thread pool runs one set of tasks at a time, so only the nodes on the calling thread use it
+        auto options = GetMapCompilerOptions();
+        auto branchOptions = options;
+        branchOptions.compilerSettings.useThreadPool = false;
+        SetMapCompilerOptions(branchOptions);
+
+        auto& function = module.BeginFunction(functionName, llvm::Type::getVoidTy(module.GetLLVMContext()), parameters);
+        function.SetCompilerOptions(branchOptions.compilerSettings);
+        auto branchFunction = function.GetFunction();
+        _branchFunctions[branchFunction] = forkFunction;
+
+        _nodeRegions.emplace_back();
+        CompileSubgraph(branch);
+        _nodeRegions.pop_back();
+        module.EndFunction();
+
+        SetMapCompilerOptions(options);
+        return branchFunction;
+    }
+
+    emitters::LLVMFunction IRMapCompiler::GetModelFunction()
+    {
+        auto function = GetModule().GetCurrentFunction().GetFunction();
+        for (auto it = _branchFunctions.find(function); it != _branchFunctions.end(); it = _branchFunctions.find(function))
+        {
+            function = it->second;
+        }
+        return function;
+    }
+
+    //
+    // Conditional branches
+    //
+
+    void IRMapCompiler::FindConditionalBranches(const Model& model)
+    {
+        // A conditional input's branch starts out as every node it depends on, except for nodes without inputs (like
+        // input and constant nodes), which cost nothing to compute, and nodes computing the map's outputs (which already
+        // have the output arguments as their variables), which always run. Then nodes that something outside the branch
+        // reads are dropped, until there are none left to drop.
+        std::vector<std::pair<const InputPortBase*, std::unordered_set<const Node*>>> branches;
+        std::unordered_map<const Node*, size_t> positions;
+        model.Visit([this, &branches, &positions](const Node& node) {
+            auto position = positions.size();
+            positions[&node] = position;
+
+            auto compilableNode = dynamic_cast<const CompilableNode*>(&node);
+            if (compilableNode == nullptr)
+            {
+                return;
+            }
+
+            for (auto input : compilableNode->GetConditionalInputs())
+            {
+                std::unordered_set<const Node*> branch;
+                auto stack = input->GetParentNodes();
+                while (!stack.empty())
+                {
+                    auto parent = stack.back();
+                    stack.pop_back();
+                    auto outputs = parent->GetOutputPorts();
+                    auto isMapOutput = std::any_of(outputs.begin(), outputs.end(), [this](const OutputPortBase* port) { return GetVariableForPort(*port) != nullptr; });
+                    if (parent->GetInputPorts().empty() || isMapOutput || !branch.insert(parent).second)
+                    {
+                        continue;
+                    }
+                    auto grandparents = parent->GetParentNodes();
+                    stack.insert(stack.end(), grandparents.begin(), grandparents.end());
+                }
+
+                // The node reads the branch only through this input
+                for (auto otherInput : node.GetInputPorts())
+                {
+                    if (otherInput != input)
+                    {
+                        for (auto parent : otherInput->GetParentNodes())
+                        {
+                            branch.erase(parent);
+                        }
+                    }
+                }
+
+                for (bool isDropping = true; isDropping;)
+                {
+                    isDropping = false;
+                    for (auto it = branch.begin(); it != branch.end();)
+                    {
+                        auto dependents = (*it)->GetDependentNodes();
+                        if (std::any_of(dependents.begin(), dependents.end(), [&node, &branch](const Node* dependent) { return dependent != &node && branch.count(dependent) == 0; }))
+                        {
+                            it = branch.erase(it);
+                            isDropping = true;
+                        }
+                        else
+                        {
+                            ++it;
+                        }
+                    }
+                }
+
+                if (!branch.empty())
+                {
+                    branches.emplace_back(input, std::move(branch));
+                }
+            }
+        });
+
+        // Branches that share nodes are nested, and each node is compiled in the innermost branch it's in, which is the
+        // smallest one
+        std::unordered_map<const Node*, size_t> branchIndices;
+        for (size_t index = 0; index < branches.size(); ++index)
+        {
+            for (auto node : branches[index].second)
+            {
+                auto [it, isNew] = branchIndices.emplace(node, index);
+                if (!isNew && branches[index].second.size() < branches[it->second].second.size())
+                {
+                    it->second = index;
+                }
+            }
+        }
+
+        for (auto [node, index] : branchIndices)
+        {
+            _conditionalNodes.insert(node);
+            _conditionalBranchNodes[branches[index].first].push_back(node);
+        }
+        for (auto& [input, nodes] : _conditionalBranchNodes)
+        {
+            std::sort(nodes.begin(), nodes.end(), [&positions](const Node* a, const Node* b) { return positions[a] < positions[b]; });
+        }
+    }
+
+    void IRMapCompiler::CompileNodeAndConditionalBranches(const Node& node)
+    {
+        if (auto compilableNode = dynamic_cast<const CompilableNode*>(&node))
+        {
+            for (auto input : compilableNode->GetConditionalInputs())
+            {
+                if (auto it = _conditionalBranchNodes.find(input); it != _conditionalBranchNodes.end())
+                {
+                    _conditionalBranchFunctions[input] = EmitConditionalBranchFunction(it->second);
+                }
+            }
+        }
+        CompileNode(node);
+    }
+
+    emitters::LLVMFunction IRMapCompiler::EmitConditionalBranchFunction(const std::vector<const Node*>& nodes)
+    {
+        auto& module = GetModule();
+        auto forkFunction = module.GetCurrentFunction().GetFunction();
+        auto functionName = module.GetCurrentFunction().GetFunctionName() + "_branch" + std::to_string(_branchFunctions.size());
+        Log() << "Compiling " << nodes.size() << " nodes into conditional branch function " << functionName << EOL;
+
+        // Like the functions of parallel branches, it takes the arguments of the function it's called from
+        emitters::NamedLLVMTypeList parameters;
+        for (auto& argument : forkFunction->args())
+        {
+            parameters.emplace_back(argument.getName().str(), argument.getType());
+        }
+
+        auto& function = module.BeginFunction(functionName, llvm::Type::getVoidTy(module.GetLLVMContext()), parameters);
+        function.SetCompilerOptions(GetMapCompilerOptions().compilerSettings);
+        auto branchFunction = function.GetFunction();
+        _branchFunctions[branchFunction] = forkFunction;
+
+        _nodeRegions.emplace_back();
+        for (auto node : nodes)
+        {
+            CompileNodeAndConditionalBranches(*node);
+        }
+        _nodeRegions.pop_back();
+        module.EndFunction();
+        return branchFunction;
+    }
+
+    void IRMapCompiler::CallConditionalBranch(const InputPortBase& input, emitters::IRFunctionEmitter& function)
+    {
+        auto it = _conditionalBranchFunctions.find(&input);
+        if (it == _conditionalBranchFunctions.end())
+        {
+            return;
+        }
+
+        emitters::IRValueList arguments;
+        for (auto& argument : function.GetFunction()->args())
+        {
+            arguments.push_back(&argument);
+        }
+        function.Call(it->second, arguments);
+    }
+
+    //
+    // Memory planning
+    //
+
+    void IRMapCompiler::BeginMemoryPlan(const Model& model)
+    {
+        auto& currentFunction = GetModule().GetCurrentFunction();
+        Log() << "Planning memory for intermediate buffers in " << currentFunction.GetFunctionName() << EOL;
+
+        _memoryPlanner = std::make_unique<MemoryPlanner>(c_memoryArenaAlignment);
+        _memoryPlanFunction = currentFunction.GetFunction();
+        _memoryPlanFunctionName = currentFunction.GetFunctionName();
+        _memoryArena = GetModule().GlobalArray(emitters::VariableType::Byte, GetNamespacePrefix() + "_memoryArenaPlaceholder", 0);
+
+        model.Visit([this](const Node& node) {
+            for (auto input : node.GetInputPorts())
+            {
+                ++_portReaderCounts[&input->GetReferencedPort()];
+            }
+        });
+    }
+
+    size_t IRMapCompiler::GetPlannedBufferSize(const OutputPortBase& port)
+    {
+        // The outputs of nodes without inputs, like input nodes and constants, aren't in the arena
+        auto node = port.GetNode();
+        if (node == nullptr || node->GetInputPorts().empty())
+        {
+            return 0;
+        }
+        return port.Size() * GetModule().GetIREmitter().SizeOf(PortTypeToVariableType(port.GetType()));
+    }
+
+    void IRMapCompiler::EndMemoryPlan()
+    {
+        auto peakSize = _memoryPlanner->GetPeakSize();
+        auto totalSize = _memoryPlanner->GetTotalAllocatedSize();
+        if (peakSize > 0)
+        {
+            auto arena = GetModule().GlobalArray(emitters::VariableType::Byte, GetNamespacePrefix() + "_memoryArena", peakSize);
+            arena->setAlignment(c_memoryArenaAlignment);
+            _memoryArena->replaceAllUsesWith(llvm::ConstantExpr::getBitCast(arena, _memoryArena->getType()));
+
+            auto& comments = GetModule().GetFunctionDeclaration(_memoryPlanFunctionName).GetComments();
+            comments.push_back("Intermediate buffers share a " + std::to_string(peakSize) + " byte memory arena (" + std::to_string(totalSize) + " bytes unshared)");
+            _footprintReport.AddMemoryArena(peakSize);
+        }
+        _memoryArena->eraseFromParent();
+        Log() << "Memory plan for " << _memoryPlanFunctionName << ": arena size " << peakSize << " bytes, total buffer size " << totalSize << " bytes" << EOL;
+
+        _memoryPlanner.reset();
+        _memoryArena = nullptr;
+        _memoryPlanFunction = nullptr;
+        _memoryPlanFunctionName.clear();
+        _portReaderCounts.clear();
+        _plannedPortVariables.clear();
+        _plannedBuffers.clear();
+    }
+
+    void IRMapCompiler::AllocatePlannedPortVariables(const Node& node)
+    {
+        auto& module = GetModule();
+        if (module.GetCurrentFunction().GetFunction() != _memoryPlanFunction)
+        {
+            return;
+        }
+
+        for (auto port : node.GetOutputPorts())
+        {
+            if (port->Size() == 0 || GetVariableForPort(*port) != nullptr)
+            {
+                continue;
+            }
+
+            AllocatePlannedPortVariable(*port);
+        }
+    }
+
+    emitters::Variable* IRMapCompiler::AllocatePlannedPortVariable(const OutputPortBase& port)
+    {
+        auto& module = GetModule();
+        auto varType = PortTypeToVariableType(port.GetType());
+        auto size = port.Size() * module.GetIREmitter().SizeOf(varType);
+        auto offset = _memoryPlanner->Allocate(size);
+        auto pVar = module.Variables().AddVectorVariable(emitters::VariableScope::global, varType, static_cast<int>(port.Size()));
+        auto pOutput = module.EmitGlobalVectorInBuffer(*pVar, _memoryArena, offset);
+        SetVariableForPort(port, pVar);
+        _plannedPortVariables[&port] = pVar;
+        _plannedBuffers[pVar] = { offset, 0 };
+
+        if (port.GetMemoryLayout().HasPadding())
+        {
+            // Readers of a padded buffer expect the padding to be zero, as it is in a global of its own, but this
+            // memory may hold the values of an earlier buffer
+            auto& irEmitter = module.GetIREmitter();
+            irEmitter.MemorySet(pOutput, irEmitter.Zero(emitters::VariableType::Byte), irEmitter.Literal(static_cast<int>(size)));
+        }
+        return pVar;
+    }
+
+    void IRMapCompiler::ReleasePlannedPortVariables(const Node& node)
+    {
+        // Readers of a view keep the buffer it's a view of alive
+        std::vector<const emitters::Variable*> releaseCandidates;
+        for (auto port : node.GetOutputPorts())
+        {
+            auto pVar = GetVariableForPort(*port);
+            if (auto it = _plannedPortVariables.find(port); it != _plannedPortVariables.end() && it->second != pVar)
+            {
+                // The node supplied its own variable for the port (e.g., constant data, or an alias of its input)
+                _memoryPlanner->Free(_plannedBuffers[it->second].offset);
+                _plannedBuffers.erase(it->second);
+                _plannedPortVariables.erase(it);
+            }
+
+            auto pBufferVar = GetAliasedVariable(pVar);
+            if (auto it = _plannedBuffers.find(pBufferVar); it != _plannedBuffers.end())
+            {
+                it->second.remainingReaders += _portReaderCounts[port];
+                releaseCandidates.push_back(pBufferVar);
+            }
+        }
+
+        for (auto input : node.GetInputPorts())
+        {
+            auto pVar = GetAliasedVariable(GetVariableForPort(input->GetReferencedPort()));
+            if (auto it = _plannedBuffers.find(pVar); it != _plannedBuffers.end())
+            {
+                --it->second.remainingReaders;
+                releaseCandidates.push_back(pVar);
+            }
+        }
+
+        for (auto pVar : releaseCandidates)
+        {
+            if (auto it = _plannedBuffers.find(pVar); it != _plannedBuffers.end() && it->second.remainingReaders <= 0)
+            {
+                _memoryPlanner->Free(it->second.offset);
+                _plannedBuffers.erase(it);
+            }
+        }
+    }
+
+    //
+    // Footprint report
+    //
+
+    void IRMapCompiler::BeginNodeFootprint()
+    {
+        auto function = GetModule().GetCurrentFunction().GetFunction();
+        auto module = GetModule().GetLLVMModule();
+        auto [instructions, stackBytes] = GetInstructionsAndStackBytes(*function);
+
+        NodeFootprintSnapshot snapshot;
+        snapshot.function = function;
+        snapshot.instructions = instructions;
+        snapshot.stackBytes = stackBytes;
+        snapshot.numFunctions = module->size();
+        snapshot.numGlobals = module->global_size();
+        snapshot.externalWeightBytes = _externalWeights.size();
+        _footprintStack.push_back(std::move(snapshot));
+    }
+
+    void IRMapCompiler::EndNodeFootprint(const Node& node)
+    {
+        auto snapshot = std::move(_footprintStack.back());
+        _footprintStack.pop_back();
+
+        // Everything the node added to the module: instructions and local variables in the function it's compiled
+        // into, the functions and globals it emitted, and the constants it placed in the external weights
+        auto module = GetModule().GetLLVMModule();
+        const auto& dataLayout = module->getDataLayout();
+        NodeFootprint footprint;
+        footprint.nodeId = to_string(node.GetId());
+        footprint.nodeType = node.GetRuntimeTypeName();
+        footprint.functionName = snapshot.function->getName().str();
+
+        auto [instructions, stackBytes] = GetInstructionsAndStackBytes(*snapshot.function);
+        footprint.irInstructions = Difference(instructions, snapshot.instructions);
+        footprint.stackBytes = Difference(stackBytes, snapshot.stackBytes);
+        if (module->size() > snapshot.numFunctions)
+        {
+            for (auto it = std::next(module->begin(), snapshot.numFunctions); it != module->end(); ++it)
+            {
+                if (!it->isDeclaration() && snapshot.innerFunctions.count(it->getName().str()) == 0)
+                {
+                    auto [functionInstructions, functionStackBytes] = GetInstructionsAndStackBytes(*it);
+                    footprint.ownFunctions.push_back(it->getName().str());
+                    footprint.irInstructions += functionInstructions;
+                    footprint.stackBytes += functionStackBytes;
+                }
+            }
+        }
+        if (module->global_size() > snapshot.numGlobals)
+        {
+            for (auto it = std::next(module->global_begin(), snapshot.numGlobals); it != module->global_end(); ++it)
+            {
+                auto bytes = dataLayout.getTypeAllocSize(it->getValueType());
+                (it->isConstant() ? footprint.weightBytes : footprint.bufferBytes) += bytes;
+            }
+        }
+        footprint.weightBytes += Difference(_externalWeights.size(), snapshot.externalWeightBytes);
+
+        for (auto port : node.GetOutputPorts())
+        {
+            if (auto it = _plannedPortVariables.find(port); it != _plannedPortVariables.end() && it->second == GetVariableForPort(*port))
+            {
+                footprint.plannedBufferBytes += port->Size() * GetModule().GetIREmitter().SizeOf(PortTypeToVariableType(port->GetType()));
+            }
+        }
+        footprint.bufferBytes += footprint.plannedBufferBytes;
+
+        // The nodes compiled while this one was (like the nodes of a nested model) are in the report already
+        const auto& inner = snapshot.innerFootprint;
+        footprint.irInstructions = Difference(footprint.irInstructions, inner.irInstructions);
+        footprint.stackBytes = Difference(footprint.stackBytes, inner.stackBytes);
+        footprint.weightBytes = Difference(footprint.weightBytes, inner.weightBytes);
+        footprint.bufferBytes = Difference(footprint.bufferBytes, inner.bufferBytes);
+        if (!_footprintStack.empty())
+        {
+            auto& outer = _footprintStack.back();
+            outer.innerFootprint.irInstructions += footprint.irInstructions + inner.irInstructions;
+            outer.innerFootprint.stackBytes += footprint.stackBytes + inner.stackBytes;
+            outer.innerFootprint.weightBytes += footprint.weightBytes + inner.weightBytes;
+            outer.innerFootprint.bufferBytes += footprint.bufferBytes + inner.bufferBytes;
+            outer.innerFunctions.insert(snapshot.innerFunctions.begin(), snapshot.innerFunctions.end());
+            outer.innerFunctions.insert(footprint.ownFunctions.begin(), footprint.ownFunctions.end());
+        }
+        _footprintReport.AddNode(std::move(footprint));
+    }
+
+    //
+    // External weights
+    //
+
+    bool IRMapCompiler::PlaceInExternalWeights(const OutputPortBase& port, const uint8_t* data, size_t size)
+    {
+        // Branch functions can't see the pointer loaded in the predict function
+        auto& module = GetModule();
+        if (_externalWeightsFunction == nullptr || _hasBranchFunctions || size < c_minExternalWeightsSize || module.GetCurrentFunction().GetFunction() != _externalWeightsFunction)
+        {
+            return false;
+        }
+
+        auto offset = (_externalWeights.size() + c_externalWeightsAlignment - 1) / c_externalWeightsAlignment * c_externalWeightsAlignment;
+        _externalWeights.resize(offset + size);
+        std::copy(data, data + size, _externalWeights.begin() + offset);
+        _externalWeightsBlocks.emplace_back(offset, size);
+
+        Log() << "Placing port " << port.GetNode()->GetId().ToString() << "." << port.GetName() << " at byte " << offset << " of the external weights" << EOL;
+        auto pVar = module.Variables().AddVectorVariable(emitters::VariableScope::global, PortTypeToVariableType(port.GetType()), static_cast<int>(port.Size()));
+        module.EmitGlobalVectorAtPointer(*pVar, GetExternalWeightsPointer(), offset);
+        SetVariableForPort(port, pVar);
+        return true;
+    }
+
+    llvm::GlobalVariable* IRMapCompiler::GetExternalWeightsPointer()
+    {
+        if (_externalWeightsPointer == nullptr)
+        {
+            // The weights are shared by all the callers of a reentrant model
+            _externalWeightsPointer = GetModule().GlobalPointer(GetNamespacePrefix() + "_weights", emitters::VariableType::Byte);
+            _externalWeightsPointer->setMetadata(emitters::c_sharedGlobalTagName, llvm::MDNode::get(GetLLVMContext(), {}));
+        }
+        return _externalWeightsPointer;
+    }
+
+    void IRMapCompiler::EmitExternalWeightsFunctions()
+    {
+        // This is the type of code we are trying to generate:
+        //
+        // int64_t model_GetWeightsSize()
+        // {
+        //     return <size>;
+        // }
+        //
+        // void model_SetWeights(const void* weights)
+        // {
+        //     model_weights = weights;
+        // }
+        //
+        // int model_LoadWeights(const char* filename) // Linux and macOS only
+        // {
+        //     int result = -1;
+        //     int fd = open(filename, O_RDONLY);
+        //     if (fd >= 0)
+        //     {
+        //         if (lseek(fd, 0, SEEK_END) == <size>)
+        //         {
+        //             void* weights = mmap(NULL, <size>, PROT_READ, MAP_SHARED, fd, 0);
+        //             if (weights != MAP_FAILED)
+        //             {
+        //                 if (model_mappedWeights != NULL)
+        //                 {
+        //                     munmap(model_mappedWeights, <size>);
+        //                 }
+        //                 model_mappedWeights = weights;
+        //                 model_weights = weights;
+        //                 result = 0;
+        //             }
+        //         }
+        //         close(fd);
+        //     }
+        //     return result;
+        // }
+        auto prefix = GetNamespacePrefix();
+        auto pointer = GetExternalWeightsPointer();
+        auto pointerType = llvm::cast<llvm::PointerType>(pointer->getValueType());
+        _externalWeights.resize((_externalWeights.size() + c_externalWeightsAlignment - 1) / c_externalWeightsAlignment * c_externalWeightsAlignment);
+        auto size = static_cast<int64_t>(_externalWeights.size());
+
+        auto sizeFunction = _moduleEmitter.BeginFunction(prefix + "_GetWeightsSize", emitters::VariableType::Int64);
+        sizeFunction.IncludeInHeader();
+        sizeFunction.IncludeInSwigInterface();
+        sizeFunction.Return(sizeFunction.Literal<int64_t>(size));
+        _moduleEmitter.EndFunction();
+        _moduleEmitter.GetFunctionDeclaration(prefix + "_GetWeightsSize").GetComments() = { "Size in bytes of the weights file written along with the module" };
+
+        const emitters::NamedVariableTypeList setParameters = { { "weights", emitters::VariableType::VoidPointer } };
+        auto setFunction = _moduleEmitter.BeginFunction(prefix + "_SetWeights", emitters::VariableType::Void, setParameters);
+        setFunction.IncludeInHeader();
+        setFunction.Store(pointer, setFunction.CastPointer(setFunction.GetFunctionArgument("weights"), emitters::VariableType::BytePointer));
+        _moduleEmitter.EndFunction();
+        _moduleEmitter.GetFunctionDeclaration(prefix + "_SetWeights").GetComments() = { "Sets the weights " + GetPredictFunctionName() + " reads: the contents of the weights file, aligned to " + std::to_string(c_externalWeightsAlignment) + " bytes. They must stay valid while the model is in use." };
+
+        const auto& targetDevice = GetCompilerOptions().targetDevice;
+        if (!targetDevice.IsLinux() && !targetDevice.IsMacOS())
+        {
+            return;
+        }
+
+        const emitters::NamedVariableTypeList loadParameters = { { "filename", emitters::VariableType::Char8Pointer } };
+        auto loadFunction = _moduleEmitter.BeginFunction(prefix + "_LoadWeights", emitters::VariableType::Int32, loadParameters);
+        loadFunction.IncludeInHeader();
+        loadFunction.IncludeInSwigInterface();
+        auto resultVar = loadFunction.Variable(emitters::VariableType::Int32, "result");
+        if (size == 0)
+        {
+            // There's nothing to map
+            loadFunction.Store(resultVar, loadFunction.Literal<int>(0));
+        }
+        else
+        {
+            auto& posixRuntime = _moduleEmitter.GetRuntime().GetPosixEmitter();
+            auto mappedPointer = GetModule().GlobalPointer(prefix + "_mappedWeights", emitters::VariableType::Byte);
+            mappedPointer->setMetadata(emitters::c_sharedGlobalTagName, llvm::MDNode::get(GetLLVMContext(), {}));
+            auto mmapFunction = posixRuntime.GetMmapFunction();
+            auto offsetType = mmapFunction->getFunctionType()->getParamType(1);
+            auto sizeValue = llvm::ConstantInt::get(offsetType, size);
+            loadFunction.Store(resultVar, loadFunction.Literal<int>(-1));
+            auto fd = loadFunction.Call(posixRuntime.GetOpenFunction(), { loadFunction.GetFunctionArgument("filename"), loadFunction.Literal(c_openReadOnly) });
+            loadFunction.If(emitters::TypedComparison::greaterThanOrEquals, fd, loadFunction.Literal(0), [&](emitters::IRFunctionEmitter& function) {
+                auto fileSize = function.Call(posixRuntime.GetLseekFunction(), { fd, llvm::ConstantInt::get(offsetType, 0), function.Literal(c_seekEnd) });
+                function.If(emitters::TypedComparison::equals, fileSize, sizeValue, [&](emitters::IRFunctionEmitter& function) {
+                    auto weights = function.Call(mmapFunction, { function.NullPointer(pointerType), sizeValue, function.Literal(c_protectionRead), function.Literal(c_mapShared), fd, llvm::ConstantInt::get(offsetType, 0) });
+                    auto mapFailed = llvm::ConstantExpr::getIntToPtr(llvm::ConstantInt::getSigned(offsetType, -1), pointerType);
+                    function.If(emitters::TypedComparison::notEquals, weights, mapFailed, [&](emitters::IRFunctionEmitter& function) {
+                        // Loading another file rolls out new weights, and releases the ones loaded before
+                        auto previousWeights = function.Load(mappedPointer);
+                        function.If(emitters::TypedComparison::notEquals, previousWeights, function.NullPointer(pointerType), [&](emitters::IRFunctionEmitter& function) {
+                            function.Call(posixRuntime.GetMunmapFunction(), { previousWeights, sizeValue });
+                        });
+                        function.Store(mappedPointer, weights);
+                        function.Store(pointer, weights);
+                        function.Store(resultVar, function.Literal<int>(0));
+                    });
+                });
+                function.Call(posixRuntime.GetCloseFunction(), { fd });
+            });
+        }
+        loadFunction.Return(loadFunction.Load(resultVar));
+        _moduleEmitter.EndFunction();
+        _moduleEmitter.GetFunctionDeclaration(prefix + "_LoadWeights").GetComments() = { "Maps the weights file into memory, and sets it as the weights " + GetPredictFunctionName() + " reads. Processes that load the same file share one copy of it. Loading another file swaps in its weights, without recompiling, and unmaps the file loaded before, so it mustn't be called while the model is in use. Returns 0 on success, or -1 if the file can't be opened, has the wrong size, or can't be mapped." };
+    }
+
+    //
+    // Port aliasing
+    //
+
+    bool IRMapCompiler::CanAliasPorts()
+    {
+        return _aliasFunction != nullptr && GetModelFunction() == _aliasFunction;
+    }
+
+    bool IRMapCompiler::TryAliasPort(const OutputPortBase& port, const OutputPortBase& source, int offset)
+    {
+        if (!CanAliasPorts() || port.Size() == 0 || port.GetType() != source.GetType() || offset < 0 || offset + port.Size() > source.Size())
+        {
+            return false;
+        }
+
+        // A view can take the place of the buffer planned for the port, but not of a variable a node supplied
+        if (auto pVar = GetVariableForPort(port); pVar != nullptr)
+        {
+            auto it = _plannedPortVariables.find(&port);
+            if (it == _plannedPortVariables.end() || it->second != pVar)
+            {
+                return false;
+            }
+        }
+
+        auto pSourceVar = GetVariableForPort(source);
+        if (pSourceVar == nullptr || !pSourceVar->IsVector())
+        {
+            return false;
+        }
+
+        // The view's pointer is computed in the entry block, so the source's pointer has to be available there (and in
+        // every branch function, when branches run as functions of their own)
+        auto& module = GetModule();
+        auto pSource = module.EnsureEmitted(*pSourceVar);
+        if (!IsAvailableInEntryBlock(pSource, _aliasFunction) || (_hasBranchFunctions && !llvm::isa<llvm::Constant>(pSource)))
+        {
+            return false;
+        }
+
+        Log() << "Aliasing port " << port.GetNode()->GetId().ToString() << "." << port.GetName() << " to entry " << offset << " of " << source.GetNode()->GetId().ToString() << "." << source.GetName() << EOL;
+        auto pVar = module.Variables().AddVectorVariable(emitters::VariableScope::global, PortTypeToVariableType(port.GetType()), static_cast<int>(port.Size()));
+        module.EmitGlobalVectorAsView(*pVar, pSource, offset);
+        SetVariableForPort(port, pVar);
+        _portAliases[&port] = { &source, offset, pVar };
+        _aliasedVariables[pVar] = pSourceVar;
+        return true;
+    }
+
+    bool IRMapCompiler::IsPortAliasOf(const OutputPortBase& port, const OutputPortBase& source, int offset)
+    {
+        auto it = _portAliases.find(&port);
+        if (it == _portAliases.end() || it->second.source != &source || it->second.offset != offset)
+        {
+            return false;
+        }
+
+        // The node computing the port may have replaced the view with a variable of its own
+        return it->second.pVar == GetVariableForPort(port);
+    }
+
+    const emitters::Variable* IRMapCompiler::GetAliasedVariable(const emitters::Variable* pVar) const
+    {
+        for (auto it = _aliasedVariables.find(pVar); it != _aliasedVariables.end(); it = _aliasedVariables.find(pVar))
+        {
+            pVar = it->second;
+        }
+        return pVar;
+    }
+
+    void IRMapCompiler::FindInPlaceInputs(const Model& model)
+    {
+        // An input that a node copies unchanged into its output, and that nothing else reads, can be computed in the
+        // output's buffer in the first place
+        std::unordered_map<const OutputPortBase*, int> readerCounts;
+        model.Visit([&readerCounts](const Node& node) {
+            for (auto input : node.GetInputPorts())
+            {
+                ++readerCounts[&input->GetReferencedPort()];
+            }
+        });
+
+        model.Visit([this, &readerCounts](const Node& node) {
+            auto compilableNode = dynamic_cast<const CompilableNode*>(&node);
+            if (compilableNode == nullptr || node.NumOutputPorts() != 1)
+            {
+                return;
+            }
+
+            const auto& output = *node.GetOutputPort(0);
+            for (auto input : node.GetInputPorts())
+            {
+                const auto& source = input->GetReferencedPort();
+                auto offset = compilableNode->GetInPlaceInputOffset(*input);
+                if (offset < 0 || readerCounts[&source] != 1 || source.GetType() != output.GetType() || source.GetMemoryLayout().HasPadding() ||
+                    _dynamicExtentPorts.count(&source) != 0 || _dynamicExtentPorts.count(&output) != 0)
+                {
+                    continue;
+                }
+                _inPlacePorts[&source] = { &output, offset };
+            }
+        });
+    }
+
+    void IRMapCompiler::PlaceOutputsInPlace(const Node& node)
+    {
+        for (auto port : node.GetOutputPorts())
+        {
+            PlaceOutputInPlace(*port);
+        }
+    }
+
+    void IRMapCompiler::PlaceOutputInPlace(const OutputPortBase& port)
+    {
+        auto it = _inPlacePorts.find(&port);
+        if (it == _inPlacePorts.end() || GetVariableForPort(port) != nullptr)
+        {
+            return;
+        }
+
+        // The output the port is copied to is computed later, so it gets its buffer now (which may itself be in place)
+        auto [target, offset] = it->second;
+        if (GetVariableForPort(*target) == nullptr)
+        {
+            PlaceOutputInPlace(*target);
+        }
+        if (GetVariableForPort(*target) == nullptr)
+        {
+            if (IsPlanningMemory() && _memoryPlanFunction == _aliasFunction)
+            {
+                AllocatePlannedPortVariable(*target);
+            }
+            else
+            {
+                AllocatePortVariable(*target);
+            }
+        }
+        TryAliasPort(port, *target, offset);
+    }
+
     void IRMapCompiler::PushScope()
     {
         MapCompiler::PushScope();
@@ -734,6 +2306,12 @@ namespace model
 
     bool IRMapCompiler::TryMergeNodeRegions(const Node& dest, const Node& src)
     {
+        if (IsPlanningMemory())
+        {
+            // Merging can move a node's code ahead of nodes compiled before it, which would break the memory plan
+            return false;
+        }
+
         Log() << "Trying to merge parent node " << DiagnosticString(dest) << " with child node " << DiagnosticString(src) << EOL;
 
         emitters::IRBlockRegion* pDestRegion = GetCurrentNodeBlocks().Get(dest);
@@ -767,6 +2345,11 @@ namespace model
 
     emitters::IRBlockRegion* IRMapCompiler::GetMergeableNodeRegion(const PortElementBase& element)
     {
+        if (IsPlanningMemory())
+        {
+            return nullptr;
+        }
+
         const Node* pNode = nullptr;
         if (HasSingleDescendant(element))
         {
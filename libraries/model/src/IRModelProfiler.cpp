@@ -15,21 +15,108 @@
 #include <emitters/include/LLVMUtilities.h>
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <numeric>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace ell
 {
 namespace model
 {
+    namespace
+    {
+        // The fields of the PerformanceCounters struct, in order
+        enum PerformanceCountersField
+        {
+            countField = 0,
+            totalTimeField,
+            totalOperationsField,
+            totalBytesReadField,
+            totalBytesWrittenField,
+            firstHardwareCounterField, // followed by the rest of the counters, in HardwareCounter order
+            numPerformanceCountersFields = firstHardwareCounterField + emitters::NumHardwareCounters
+        };
+
+        // The fields of the LatencyStatistics struct, in order
+        enum LatencyStatisticsField
+        {
+            latencyCountField = 0,
+            p50Field,
+            p90Field,
+            p99Field,
+            maxTimeField
+        };
+
+        // Latency histograms have 2^2 buckets per power of two, from 2^-20 ms (about 1 ns) up to 2^12 ms (about 4 s).
+        // The first and last buckets also count the times below and above that range.
+        const int c_latencyBucketsPerOctaveLog2 = 2;
+        const int c_latencyMinExponent = -20;
+        const int c_numLatencyBuckets = 32 << c_latencyBucketsPerOctaveLog2;
+
+        // The top bits of a double holding a time in the first bucket: its biased exponent followed by the mantissa bits that select the bucket
+        const int64_t c_firstLatencyBucketKey = static_cast<int64_t>(1023 + c_latencyMinExponent) << c_latencyBucketsPerOctaveLog2;
+
+        const std::vector<std::pair<LatencyStatisticsField, double>> c_latencyPercentiles = { { p50Field, 0.5 }, { p90Field, 0.9 }, { p99Field, 0.99 } };
+
+        std::vector<double> GetLatencyBucketUpperBounds()
+        {
+            const int bucketsPerOctave = 1 << c_latencyBucketsPerOctaveLog2;
+            std::vector<double> bounds;
+            for (int bucket = 1; bucket < c_numLatencyBuckets; ++bucket)
+            {
+                auto octave = bucket / bucketsPerOctave;
+                auto step = bucket % bucketsPerOctave;
+                bounds.push_back(std::ldexp(1.0 + static_cast<double>(step) / bucketsPerOctave, c_latencyMinExponent + octave));
+            }
+            bounds.push_back(std::numeric_limits<double>::max());
+            return bounds;
+        }
+
+        void EmitRecordLatency(emitters::IRFunctionEmitter& function, llvm::IRBuilder<>& irBuilder, emitters::LLVMValue histogramPtr, emitters::LLVMValue statisticsPtr, emitters::LLVMValue time)
+        {
+            // The exponent and leading mantissa bits of a positive double grow with its value, so they pick its
+            // bucket without a logarithm. Zero and negative times end up below the first bucket.
+            auto bits = function.BitCast(time, emitters::VariableType::Int64);
+            auto key = function.Operator(emitters::TypedOperator::arithmeticShiftRight, bits, function.Literal<int64_t>(52 - c_latencyBucketsPerOctaveLog2));
+            auto bucket = function.Operator(emitters::TypedOperator::subtract, key, function.Literal<int64_t>(c_firstLatencyBucketKey));
+            bucket = function.Select(function.Comparison(emitters::TypedComparison::lessThan, bucket, function.Literal<int64_t>(0)), function.Literal<int64_t>(0), bucket);
+            bucket = function.Select(function.Comparison(emitters::TypedComparison::greaterThan, bucket, function.Literal<int64_t>(c_numLatencyBuckets - 1)), function.Literal<int64_t>(c_numLatencyBuckets - 1), bucket);
+            function.OperationAndUpdate(function.PointerOffset(histogramPtr, bucket), emitters::TypedOperator::add, function.Literal<int64_t>(1));
+
+            auto maxTimePtr = irBuilder.CreateInBoundsGEP(statisticsPtr, { function.Literal(0), function.Literal(maxTimeField) });
+            auto maxTime = function.Load(maxTimePtr);
+            function.Store(maxTimePtr, function.Select(function.Comparison(emitters::TypedComparison::greaterThanFloat, time, maxTime), time, maxTime));
+        }
+
+        void EmitResetPerformanceCounters(emitters::IRFunctionEmitter& function, llvm::IRBuilder<>& irBuilder, emitters::LLVMValue performanceCountersPtr)
+        {
+            for (int field = 0; field < numPerformanceCountersFields; ++field)
+            {
+                auto fieldPtr = irBuilder.CreateInBoundsGEP(performanceCountersPtr, { function.Literal(0), function.Literal(field) });
+                function.StoreZero(fieldPtr);
+            }
+        }
+
+        // Returns `numerator` / (`totalTime` * 10^6), which is the rate in units per nanosecond (e.g., GFLOP/s) when `totalTime` is in milliseconds
+        emitters::LLVMValue EmitRatePerNanosecond(emitters::IRFunctionEmitter& function, emitters::LLVMValue numerator, emitters::LLVMValue totalTime)
+        {
+            auto scaledTime = function.Operator(emitters::TypedOperator::multiplyFloat, totalTime, function.Literal<double>(1.0e6));
+            return function.Operator(emitters::TypedOperator::divideFloat, numerator, scaledTime);
+        }
+    } // namespace
+
     //
     // NodeInfoEmitter
     //
-    NodeInfoEmitter::NodeInfoEmitter(emitters::IRModuleEmitter& module, const Node* node, emitters::LLVMValue nodeInfoPtr, llvm::StructType* nodeInfoType) :
+    NodeInfoEmitter::NodeInfoEmitter(emitters::IRModuleEmitter& module, const Node* node, emitters::LLVMValue nodeInfoPtr, llvm::StructType* nodeInfoType, bool includeCosts) :
         _module(&module),
         _node(node),
+        _includeCosts(includeCosts),
         _nodeInfoPtr(nodeInfoPtr),
         _nodeInfoType(nodeInfoType)
     {
@@ -59,6 +146,14 @@ namespace model
         function.Store(namePtr, function.Literal(nodeName));
         function.Store(typePtr, function.Literal(nodeTypeName));
         function.Store(ancestorPtr, function.Literal(nodeAncestor));
+
+        // The entries for node types aggregate several nodes, so a single node's estimates don't apply to them
+        auto operationCountPtr = irBuilder.CreateInBoundsGEP(_nodeInfoType, _nodeInfoPtr, { emitter.Literal(0), emitter.Literal(3) });
+        auto bytesReadPtr = irBuilder.CreateInBoundsGEP(_nodeInfoType, _nodeInfoPtr, { emitter.Literal(0), emitter.Literal(4) });
+        auto bytesWrittenPtr = irBuilder.CreateInBoundsGEP(_nodeInfoType, _nodeInfoPtr, { emitter.Literal(0), emitter.Literal(5) });
+        function.Store(operationCountPtr, function.Literal<int64_t>(_includeCosts ? _node->GetOperationCount() : 0));
+        function.Store(bytesReadPtr, function.Literal<int64_t>(_includeCosts ? _node->GetBytesRead() : 0));
+        function.Store(bytesWrittenPtr, function.Literal<int64_t>(_includeCosts ? _node->GetBytesWritten() : 0));
     }
 
     //
@@ -75,21 +170,23 @@ namespace model
     {
     }
 
-    void PerformanceCountersEmitter::Start(emitters::IRFunctionEmitter& function, emitters::LLVMValue startTime)
+    void PerformanceCountersEmitter::Start(emitters::IRFunctionEmitter& function, emitters::LLVMValue startTime, emitters::LLVMValue startHardwareCounters)
     {
         assert(_performanceCountersPtr != nullptr);
 
         auto& emitter = _module->GetIREmitter();
         auto& irBuilder = emitter.GetIRBuilder();
 
-        _startTime = startTime;
+        _startTime = function.Variable(emitters::VariableType::Double, "startTime");
+        function.Store(_startTime, startTime);
+        _startHardwareCounters = startHardwareCounters;
 
         // Increment node entry counter
         auto countPtr = irBuilder.CreateInBoundsGEP(_performanceCountersType, _performanceCountersPtr, { emitter.Literal(0), emitter.Literal(0) });
         function.OperationAndUpdate(countPtr, emitters::TypedOperator::add, function.Literal<int64_t>(1));
     }
 
-    void PerformanceCountersEmitter::End(emitters::IRFunctionEmitter& function, emitters::LLVMValue endTime)
+    void PerformanceCountersEmitter::End(emitters::IRFunctionEmitter& function, emitters::LLVMValue endTime, emitters::LLVMValue endHardwareCounters)
     {
         assert(_performanceCountersPtr != nullptr);
 
@@ -97,30 +194,66 @@ namespace model
         auto& irBuilder = emitter.GetIRBuilder();
 
         // Compute time elapsed and increment total time counter
-        auto elapsedTime = function.Operator(emitters::TypedOperator::subtractFloat, endTime, _startTime);
+        auto elapsedTime = function.Operator(emitters::TypedOperator::subtractFloat, endTime, LoadStartTime(function));
         auto totalTimePtr = irBuilder.CreateInBoundsGEP(_performanceCountersPtr, { emitter.Literal(0), emitter.Literal(1) }, "accumTime");
         function.OperationAndUpdate(totalTimePtr, emitters::TypedOperator::addFloat, elapsedTime);
+
+        if (_latencyHistogramPtr != nullptr)
+        {
+            EmitRecordLatency(function, irBuilder, _latencyHistogramPtr, _latencyStatisticsPtr, elapsedTime);
+        }
+
+        if (_startHardwareCounters != nullptr && endHardwareCounters != nullptr)
+        {
+            for (int counterIndex = 0; counterIndex < emitters::NumHardwareCounters; ++counterIndex)
+            {
+                auto counterDelta = function.Operator(emitters::TypedOperator::subtract, function.ValueAt(endHardwareCounters, counterIndex), function.ValueAt(_startHardwareCounters, counterIndex));
+                auto counterPtr = irBuilder.CreateInBoundsGEP(_performanceCountersPtr, { emitter.Literal(0), emitter.Literal(firstHardwareCounterField + counterIndex) });
+                function.OperationAndUpdate(counterPtr, emitters::TypedOperator::add, counterDelta);
+            }
+        }
     }
 
-    void PerformanceCountersEmitter::Reset(emitters::IRFunctionEmitter& function)
+    void PerformanceCountersEmitter::SetLatencyHistogram(emitters::LLVMValue latencyHistogramPtr, emitters::LLVMValue latencyStatisticsPtr)
+    {
+        _latencyHistogramPtr = latencyHistogramPtr;
+        _latencyStatisticsPtr = latencyStatisticsPtr;
+    }
+
+    emitters::LLVMValue PerformanceCountersEmitter::LoadStartTime(emitters::IRFunctionEmitter& function) const
+    {
+        assert(_startTime != nullptr);
+        return function.Load(_startTime);
+    }
+
+    void PerformanceCountersEmitter::AddCosts(emitters::IRFunctionEmitter& function, int64_t operations, int64_t bytesRead, int64_t bytesWritten)
     {
         assert(_performanceCountersPtr != nullptr);
 
         auto& emitter = _module->GetIREmitter();
         auto& irBuilder = emitter.GetIRBuilder();
 
-        // Compute time elapsed and increment total time counter
-        auto countPtr = irBuilder.CreateInBoundsGEP(_performanceCountersType, _performanceCountersPtr, { emitter.Literal(0), emitter.Literal(0) });
-        auto totalTimePtr = irBuilder.CreateInBoundsGEP(_performanceCountersPtr, { emitter.Literal(0), emitter.Literal(1) });
-        function.StoreZero(countPtr);
-        function.StoreZero(totalTimePtr);
+        auto totalOperationsPtr = irBuilder.CreateInBoundsGEP(_performanceCountersPtr, { emitter.Literal(0), emitter.Literal(totalOperationsField) });
+        auto totalBytesReadPtr = irBuilder.CreateInBoundsGEP(_performanceCountersPtr, { emitter.Literal(0), emitter.Literal(totalBytesReadField) });
+        auto totalBytesWrittenPtr = irBuilder.CreateInBoundsGEP(_performanceCountersPtr, { emitter.Literal(0), emitter.Literal(totalBytesWrittenField) });
+        function.OperationAndUpdate(totalOperationsPtr, emitters::TypedOperator::addFloat, function.Literal(static_cast<double>(operations)));
+        function.OperationAndUpdate(totalBytesReadPtr, emitters::TypedOperator::addFloat, function.Literal(static_cast<double>(bytesRead)));
+        function.OperationAndUpdate(totalBytesWrittenPtr, emitters::TypedOperator::addFloat, function.Literal(static_cast<double>(bytesWritten)));
+    }
+
+    void PerformanceCountersEmitter::Reset(emitters::IRFunctionEmitter& function)
+    {
+        assert(_performanceCountersPtr != nullptr);
+
+        auto& irBuilder = _module->GetIREmitter().GetIRBuilder();
+        EmitResetPerformanceCounters(function, irBuilder, _performanceCountersPtr);
     }
 
     //
     // NodePerformanceEmitter
     //
-    NodePerformanceEmitter::NodePerformanceEmitter(emitters::IRModuleEmitter& module, const Node* node, emitters::LLVMValue nodeInfoPtr, emitters::LLVMValue performanceCountersPtr, llvm::StructType* nodeInfoType, llvm::StructType* performanceCountersType) :
-        _nodeInfoEmitter(module, node, nodeInfoPtr, nodeInfoType),
+    NodePerformanceEmitter::NodePerformanceEmitter(emitters::IRModuleEmitter& module, const Node* node, emitters::LLVMValue nodeInfoPtr, emitters::LLVMValue performanceCountersPtr, llvm::StructType* nodeInfoType, llvm::StructType* performanceCountersType, bool isNodeType) :
+        _nodeInfoEmitter(module, node, nodeInfoPtr, nodeInfoType, !isNodeType),
         _performanceCountersEmitter(module, performanceCountersPtr, performanceCountersType)
     {
     }
@@ -131,14 +264,15 @@ namespace model
         _performanceCountersEmitter.Init(function);
     }
 
-    void NodePerformanceEmitter::Start(emitters::IRFunctionEmitter& function, emitters::LLVMValue startTime)
+    void NodePerformanceEmitter::Start(emitters::IRFunctionEmitter& function, emitters::LLVMValue startTime, emitters::LLVMValue startHardwareCounters)
     {
-        _performanceCountersEmitter.Start(function, startTime);
+        _performanceCountersEmitter.Start(function, startTime, startHardwareCounters);
     }
 
-    void NodePerformanceEmitter::End(emitters::IRFunctionEmitter& function, emitters::LLVMValue endTime)
+    void NodePerformanceEmitter::End(emitters::IRFunctionEmitter& function, emitters::LLVMValue endTime, emitters::LLVMValue endHardwareCounters, const Node& node)
     {
-        _performanceCountersEmitter.End(function, endTime);
+        _performanceCountersEmitter.End(function, endTime, endHardwareCounters);
+        _performanceCountersEmitter.AddCosts(function, node.GetOperationCount(), node.GetBytesRead(), node.GetBytesWritten());
     }
 
     void NodePerformanceEmitter::Reset(emitters::IRFunctionEmitter& function)
@@ -163,6 +297,8 @@ namespace model
         _module(&module),
         _model(&model),
         _profilingEnabled(enableProfiling),
+        _samplingInterval(std::max(module.GetCompilerOptions().profileSamplingInterval, 1)),
+        _latencyHistogramsEnabled(module.GetCompilerOptions().profileLatencyHistograms),
         _nodeInfoType(nullptr),
         _performanceCountersType(nullptr)
     {
@@ -191,13 +327,26 @@ namespace model
         auto int8PtrType = llvm::Type::getInt8PtrTy(context);
 
         // NodeInfo struct fields
-        emitters::NamedLLVMTypeList infoFields = { { "nodeName", int8PtrType }, { "nodeType", int8PtrType }, { "nodeAncestor", int8PtrType } };
+        emitters::NamedLLVMTypeList infoFields = { { "nodeName", int8PtrType }, { "nodeType", int8PtrType }, { "nodeAncestor", int8PtrType }, { "operationCount", int64Type }, { "bytesRead", int64Type }, { "bytesWritten", int64Type } };
         _nodeInfoType = _module->GetOrCreateStruct(GetNamespacePrefix() + "_NodeInfo", infoFields);
         _module->IncludeTypeInHeader(_nodeInfoType->getName());
 
-        emitters::NamedLLVMTypeList countersFields = { { "count", int64Type }, { "totalTime", doubleType } };
+        emitters::NamedLLVMTypeList countersFields = { { "count", int64Type },
+                                                       { "totalTime", doubleType },
+                                                       { "totalOperations", doubleType },
+                                                       { "totalBytesRead", doubleType },
+                                                       { "totalBytesWritten", doubleType },
+                                                       { "cycles", int64Type },
+                                                       { "instructions", int64Type },
+                                                       { "l1DataCacheMisses", int64Type },
+                                                       { "lastLevelCacheMisses", int64Type },
+                                                       { "branchMisses", int64Type } };
         _performanceCountersType = _module->GetOrCreateStruct(GetNamespacePrefix() + "_PerformanceCounters", countersFields);
         _module->IncludeTypeInHeader(_performanceCountersType->getName());
+
+        emitters::NamedLLVMTypeList latencyFields = { { "count", int64Type }, { "p50", doubleType }, { "p90", doubleType }, { "p99", doubleType }, { "maxTime", doubleType } };
+        _latencyStatisticsType = _module->GetOrCreateStruct(GetNamespacePrefix() + "_LatencyStatistics", latencyFields);
+        _module->IncludeTypeInHeader(_latencyStatisticsType->getName());
     }
 
     void ModelProfiler::StartModel(emitters::IRFunctionEmitter& function)
@@ -207,16 +356,24 @@ namespace model
             return;
         }
 
-        auto startTime = CallGetCurrentTime(function);
-        auto& emitter = _module->GetIREmitter();
-        auto& irBuilder = emitter.GetIRBuilder();
-
-        assert(_modelPerformanceCountersArray != nullptr);
-        auto modelPerformanceCountersPtr = irBuilder.CreateInBoundsGEP(_modelPerformanceCountersArray, { emitter.Literal(0), emitter.Literal(0) });
-        _modelPerformanceCounters = { *_module, modelPerformanceCountersPtr, _performanceCountersType };
+        EmitIfSampled(function, [this](emitters::IRFunctionEmitter& function) {
+            auto startTime = CallGetCurrentTime(function);
+            auto startHardwareCounters = CallReadHardwareCounters(function);
+            auto& emitter = _module->GetIREmitter();
+            auto& irBuilder = emitter.GetIRBuilder();
 
-        _modelPerformanceCounters.Init(function);
-        _modelPerformanceCounters.Start(function, startTime);
+            assert(_modelPerformanceCountersArray != nullptr);
+            auto modelPerformanceCountersPtr = irBuilder.CreateInBoundsGEP(_modelPerformanceCountersArray, { emitter.Literal(0), emitter.Literal(0) });
+            _modelPerformanceCounters = { *_module, modelPerformanceCountersPtr, _performanceCountersType };
+            if (_modelLatencyHistogram != nullptr)
+            {
+                _modelPerformanceCounters.SetLatencyHistogram(GetLatencyHistogramPtr(_modelLatencyHistogram, function.Literal(0)),
+                                                              irBuilder.CreateInBoundsGEP(_modelLatencyStatisticsArray, { emitter.Literal(0), emitter.Literal(0) }));
+            }
+
+            _modelPerformanceCounters.Init(function);
+            _modelPerformanceCounters.Start(function, startTime, startHardwareCounters);
+        });
     }
 
     void ModelProfiler::EndModel(emitters::IRFunctionEmitter& function)
@@ -226,8 +383,31 @@ namespace model
             return;
         }
 
-        auto endTime = CallGetCurrentTime(function);
-        _modelPerformanceCounters.End(function, endTime);
+        EmitIfSampled(function, [this](emitters::IRFunctionEmitter& function) {
+            auto endTime = CallGetCurrentTime(function);
+            _modelPerformanceCounters.End(function, endTime, CallReadHardwareCounters(function));
+            _module->GetProfiler().EndTraceEvent(function, function.GetFunctionName(), _modelPerformanceCounters.LoadStartTime(function));
+
+            // By now every node in the model has been compiled, so the model's costs are the sum of the nodes'
+            int64_t operations = 0;
+            int64_t bytesRead = 0;
+            int64_t bytesWritten = 0;
+            for (const auto& entry : _nodePerformanceCounters)
+            {
+                operations += entry.first->GetOperationCount();
+                bytesRead += entry.first->GetBytesRead();
+                bytesWritten += entry.first->GetBytesWritten();
+            }
+            _modelPerformanceCounters.AddCosts(function, operations, bytesRead, bytesWritten);
+        });
+
+        if (_samplingPhase != nullptr)
+        {
+            // Advance to the next call's position in the sampling interval
+            auto nextPhase = function.Operator(emitters::TypedOperator::add, function.Load(_samplingPhase), function.Literal<int64_t>(1));
+            auto wrapped = function.Comparison(emitters::TypedComparison::equals, nextPhase, function.Literal<int64_t>(_samplingInterval));
+            function.Store(_samplingPhase, function.Select(wrapped, function.Literal<int64_t>(0), nextPhase));
+        }
     }
 
     void ModelProfiler::InitNode(emitters::IRFunctionEmitter& function, const Node& node)
@@ -239,8 +419,10 @@ namespace model
         auto& performanceCounters = GetPerformanceCountersForNode(node);
         auto& typePerformanceCounters = GetTypePerformanceCountersForNode(node);
 
-        performanceCounters.Init(function);
-        typePerformanceCounters.Init(function);
+        EmitIfSampled(function, [&](emitters::IRFunctionEmitter& function) {
+            performanceCounters.Init(function);
+            typePerformanceCounters.Init(function);
+        });
     }
 
     void ModelProfiler::StartNode(emitters::IRFunctionEmitter& function, const Node& node)
@@ -252,9 +434,12 @@ namespace model
         auto& performanceCounters = GetPerformanceCountersForNode(node);
         auto& typePerformanceCounters = GetTypePerformanceCountersForNode(node);
 
-        auto startTime = CallGetCurrentTime(function);
-        performanceCounters.Start(function, startTime);
-        typePerformanceCounters.Start(function, startTime);
+        EmitIfSampled(function, [&](emitters::IRFunctionEmitter& function) {
+            auto startTime = CallGetCurrentTime(function);
+            auto startHardwareCounters = CallReadHardwareCounters(function);
+            performanceCounters.Start(function, startTime, startHardwareCounters);
+            typePerformanceCounters.Start(function, startTime, startHardwareCounters);
+        });
     }
 
     void ModelProfiler::EndNode(emitters::IRFunctionEmitter& function, const Node& node)
@@ -266,9 +451,13 @@ namespace model
         auto& performanceCounters = GetPerformanceCountersForNode(node);
         auto& typePerformanceCounters = GetTypePerformanceCountersForNode(node);
 
-        auto endTime = CallGetCurrentTime(function);
-        performanceCounters.End(function, endTime);
-        typePerformanceCounters.End(function, endTime);
+        EmitIfSampled(function, [&](emitters::IRFunctionEmitter& function) {
+            auto endHardwareCounters = CallReadHardwareCounters(function);
+            auto endTime = CallGetCurrentTime(function);
+            performanceCounters.End(function, endTime, endHardwareCounters, node);
+            typePerformanceCounters.End(function, endTime, endHardwareCounters, node);
+            _module->GetProfiler().EndTraceEvent(function, node.GetRuntimeTypeName() + " " + to_string(node.GetId()), performanceCounters.LoadStartTime(function));
+        });
     }
 
     void ModelProfiler::EmitModelProfilerFunctions()
@@ -296,6 +485,12 @@ namespace model
         EmitGetNodeTypePerformanceCountersFunction();
         EmitPrintNodeTypeProfilingInfoFunction();
         EmitResetNodeTypeProfilingInfoFunction();
+
+        EmitGetLatencyStatisticsFunction("_GetModelLatencyStatistics", _modelLatencyHistogram, _modelLatencyStatisticsArray, false);
+        EmitGetLatencyStatisticsFunction("_GetNodeLatencyStatistics", _nodeLatencyHistograms, _nodeLatencyStatisticsArray, true);
+        EmitGetLatencyStatisticsFunction("_GetNodeTypeLatencyStatistics", _nodeTypeLatencyHistograms, _nodeTypeLatencyStatisticsArray, true);
+        EmitPrintModelLatencyInfoFunction();
+        EmitPrintNodeLatencyInfoFunction();
     }
 
     void ModelProfiler::AllocateNodeData()
@@ -309,6 +504,22 @@ namespace model
         // Note: We're grossly overallocating global array for types
         _nodeTypeInfoArray = _module->GlobalArray(GetNamespacePrefix() + "_NodeTypeInfoArray", _nodeInfoType, numNodes);
         _nodeTypePerformanceCountersArray = _module->GlobalArray(GetNamespacePrefix() + "_NodeTypePerformanceCountersArray", _performanceCountersType, numNodes);
+
+        _latencyBucketUpperBounds = _module->ConstantArray(GetNamespacePrefix() + "_LatencyBucketUpperBounds", GetLatencyBucketUpperBounds());
+        _modelLatencyStatisticsArray = _module->GlobalArray(GetNamespacePrefix() + "_ModelLatencyStatisticsArray", _latencyStatisticsType, 1);
+        _nodeLatencyStatisticsArray = _module->GlobalArray(GetNamespacePrefix() + "_NodeLatencyStatisticsArray", _latencyStatisticsType, numNodes);
+        _nodeTypeLatencyStatisticsArray = _module->GlobalArray(GetNamespacePrefix() + "_NodeTypeLatencyStatisticsArray", _latencyStatisticsType, numNodes);
+        if (_latencyHistogramsEnabled)
+        {
+            _modelLatencyHistogram = _module->GlobalArray<int64_t>(GetNamespacePrefix() + "_ModelLatencyHistogram", c_numLatencyBuckets);
+            _nodeLatencyHistograms = _module->GlobalArray<int64_t>(GetNamespacePrefix() + "_NodeLatencyHistograms", numNodes * c_numLatencyBuckets);
+            _nodeTypeLatencyHistograms = _module->GlobalArray<int64_t>(GetNamespacePrefix() + "_NodeTypeLatencyHistograms", numNodes * c_numLatencyBuckets);
+        }
+
+        if (_samplingInterval > 1)
+        {
+            _samplingPhase = _module->Global<int64_t>(GetNamespacePrefix() + "_ProfileSamplingPhase", 0);
+        }
     }
 
     std::string ModelProfiler::GetNamespacePrefix() const
@@ -316,6 +527,17 @@ namespace model
         return _module->GetModuleName();
     }
 
+    void ModelProfiler::EmitIfSampled(emitters::IRFunctionEmitter& function, std::function<void(emitters::IRFunctionEmitter&)> body)
+    {
+        if (_samplingPhase == nullptr)
+        {
+            body(function);
+            return;
+        }
+
+        function.If(emitters::TypedComparison::equals, function.Load(_samplingPhase), function.Literal<int64_t>(0), body);
+    }
+
     void ModelProfiler::EmitGetModelPerformanceCountersFunction()
     {
         auto& emitter = _module->GetIREmitter();
@@ -424,7 +646,12 @@ namespace model
         // Print some statistics
         auto countPtr = irBuilder.CreateInBoundsGEP(modelPerformanceCountersPtr, { function.Literal(0), function.Literal(0) });
         auto totalTimePtr = irBuilder.CreateInBoundsGEP(modelPerformanceCountersPtr, { function.Literal(0), function.Literal(1) });
-        function.Printf("Total time: %f ms\tcount: %d\n", { function.Load(totalTimePtr), function.Load(countPtr) });
+        auto totalOperationsPtr = irBuilder.CreateInBoundsGEP(modelPerformanceCountersPtr, { function.Literal(0), function.Literal(totalOperationsField) });
+        auto totalBytesReadPtr = irBuilder.CreateInBoundsGEP(modelPerformanceCountersPtr, { function.Literal(0), function.Literal(totalBytesReadField) });
+        auto totalBytesWrittenPtr = irBuilder.CreateInBoundsGEP(modelPerformanceCountersPtr, { function.Literal(0), function.Literal(totalBytesWrittenField) });
+        auto totalTime = function.Load(totalTimePtr);
+        auto totalBytes = function.Operator(emitters::TypedOperator::addFloat, function.Load(totalBytesReadPtr), function.Load(totalBytesWrittenPtr));
+        function.Printf("Total time: %f ms\tcount: %d\tGFLOP/s: %f\tGB/s: %f\n", { totalTime, function.Load(countPtr), EmitRatePerNanosecond(function, function.Load(totalOperationsPtr), totalTime), EmitRatePerNanosecond(function, totalBytes, totalTime) });
 
         _module->EndFunction();
     }
@@ -440,10 +667,8 @@ namespace model
 
         auto modelPerformanceCountersPtr = irBuilder.CreateInBoundsGEP(_modelPerformanceCountersArray, { function.Literal(0), function.Literal(0) });
 
-        auto countPtr = irBuilder.CreateInBoundsGEP(modelPerformanceCountersPtr, { function.Literal(0), function.Literal(0) });
-        auto totalTimePtr = irBuilder.CreateInBoundsGEP(modelPerformanceCountersPtr, { function.Literal(0), function.Literal(1) });
-        function.StoreZero(countPtr);
-        function.StoreZero(totalTimePtr);
+        EmitResetPerformanceCounters(function, irBuilder, modelPerformanceCountersPtr);
+        EmitResetLatencyHistograms(function, _modelLatencyHistogram, _modelLatencyStatisticsArray, 1);
 
         _module->EndFunction();
     }
@@ -469,7 +694,12 @@ namespace model
 
             auto countPtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(0) });
             auto totalTimePtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(1) });
-            function.Printf("Node[%s]:\ttype: %s\ttime: %f ms\tcount: %d\tancestor: %s\n", { function.Load(namePtr), function.Load(typePtr), function.Load(totalTimePtr), function.Load(countPtr), function.Load(ancestorPtr) });
+            auto totalOperationsPtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(totalOperationsField) });
+            auto totalBytesReadPtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(totalBytesReadField) });
+            auto totalBytesWrittenPtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(totalBytesWrittenField) });
+            auto totalTime = function.Load(totalTimePtr);
+            auto totalBytes = function.Operator(emitters::TypedOperator::addFloat, function.Load(totalBytesReadPtr), function.Load(totalBytesWrittenPtr));
+            function.Printf("Node[%s]:\ttype: %s\ttime: %f ms\tcount: %d\tGFLOP/s: %f\tGB/s: %f\tancestor: %s\n", { function.Load(namePtr), function.Load(typePtr), totalTime, function.Load(countPtr), EmitRatePerNanosecond(function, function.Load(totalOperationsPtr), totalTime), EmitRatePerNanosecond(function, totalBytes, totalTime), function.Load(ancestorPtr) });
         });
 
         _module->EndFunction();
@@ -494,7 +724,12 @@ namespace model
 
             auto countPtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(0) });
             auto totalTimePtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(1) });
-            function.Printf("type: %s\ttime: %f ms\tcount: %d\n", { function.Load(typePtr), function.Load(totalTimePtr), function.Load(countPtr) });
+            auto totalOperationsPtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(totalOperationsField) });
+            auto totalBytesReadPtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(totalBytesReadField) });
+            auto totalBytesWrittenPtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(totalBytesWrittenField) });
+            auto totalTime = function.Load(totalTimePtr);
+            auto totalBytes = function.Operator(emitters::TypedOperator::addFloat, function.Load(totalBytesReadPtr), function.Load(totalBytesWrittenPtr));
+            function.Printf("type: %s\ttime: %f ms\tcount: %d\tGFLOP/s: %f\tGB/s: %f\n", { function.Load(typePtr), totalTime, function.Load(countPtr), EmitRatePerNanosecond(function, function.Load(totalOperationsPtr), totalTime), EmitRatePerNanosecond(function, totalBytes, totalTime) });
         });
 
         _module->EndFunction();
@@ -514,11 +749,9 @@ namespace model
         function.For(numEmittedNodes, [&irBuilder, this](emitters::IRFunctionEmitter& function, emitters::LLVMValue nodeIndex) {
             auto nodePerformanceCountersPtr = irBuilder.CreateInBoundsGEP(_nodePerformanceCountersArray, { function.Literal(0), nodeIndex });
 
-            auto countPtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(0) });
-            auto totalTimePtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(1) });
-            function.StoreZero(countPtr);
-            function.StoreZero(totalTimePtr);
+            EmitResetPerformanceCounters(function, irBuilder, nodePerformanceCountersPtr);
         });
+        EmitResetLatencyHistograms(function, _nodeLatencyHistograms, _nodeLatencyStatisticsArray, numEmittedNodes);
 
         _module->EndFunction();
     }
@@ -537,15 +770,153 @@ namespace model
         function.For(numEmittedNodes, [&irBuilder, this](emitters::IRFunctionEmitter& function, emitters::LLVMValue nodeIndex) {
             auto nodePerformanceCountersPtr = irBuilder.CreateInBoundsGEP(_nodeTypePerformanceCountersArray, { function.Literal(0), nodeIndex });
 
-            auto countPtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(0) });
-            auto totalTimePtr = irBuilder.CreateInBoundsGEP(nodePerformanceCountersPtr, { function.Literal(0), function.Literal(1) });
-            function.StoreZero(countPtr);
-            function.StoreZero(totalTimePtr);
+            EmitResetPerformanceCounters(function, irBuilder, nodePerformanceCountersPtr);
         });
+        EmitResetLatencyHistograms(function, _nodeTypeLatencyHistograms, _nodeTypeLatencyStatisticsArray, numEmittedNodes);
+
+        _module->EndFunction();
+    }
+
+    void ModelProfiler::EmitGetLatencyStatisticsFunction(const std::string& name, llvm::GlobalVariable* histograms, llvm::GlobalVariable* statisticsArray, bool isIndexed)
+    {
+        auto& emitter = _module->GetIREmitter();
+        auto& irBuilder = emitter.GetIRBuilder();
+
+        emitters::NamedVariableTypeList parameters;
+        if (isIndexed)
+        {
+            parameters.push_back({ "nodeIndex", emitters::VariableType::Int32 });
+        }
+        auto function = _module->BeginFunction(GetNamespacePrefix() + name, _latencyStatisticsType->getPointerTo(), parameters);
+        function.IncludeInHeader();
+
+        auto index = isIndexed ? static_cast<emitters::LLVMValue>(&(*function.Arguments().begin())) : function.Literal(0);
+        auto statisticsPtr = irBuilder.CreateInBoundsGEP(statisticsArray, { function.Literal(0), index });
+        if (histograms != nullptr)
+        {
+            EmitComputeLatencyStatistics(function, GetLatencyHistogramPtr(histograms, index), statisticsPtr);
+        }
+        function.Return(statisticsPtr);
+        _module->EndFunction();
+    }
+
+    void ModelProfiler::EmitPrintModelLatencyInfoFunction()
+    {
+        auto& emitter = _module->GetIREmitter();
+        auto& irBuilder = emitter.GetIRBuilder();
+
+        auto function = _module->BeginFunction(GetNamespacePrefix() + "_PrintModelLatencyInfo", emitters::VariableType::Void);
+        function.IncludeInHeader();
+        function.IncludeInSwigInterface();
+
+        if (_modelLatencyHistogram != nullptr)
+        {
+            auto statisticsPtr = irBuilder.CreateInBoundsGEP(_modelLatencyStatisticsArray, { function.Literal(0), function.Literal(0) });
+            EmitComputeLatencyStatistics(function, GetLatencyHistogramPtr(_modelLatencyHistogram, function.Literal(0)), statisticsPtr);
+
+            auto fieldValue = [&](LatencyStatisticsField field) { return function.Load(irBuilder.CreateInBoundsGEP(statisticsPtr, { function.Literal(0), function.Literal(field) })); };
+            function.Printf("Latency: count: %lld\tp50: %f ms\tp90: %f ms\tp99: %f ms\tmax: %f ms\n", { fieldValue(latencyCountField), fieldValue(p50Field), fieldValue(p90Field), fieldValue(p99Field), fieldValue(maxTimeField) });
+        }
+
+        _module->EndFunction();
+    }
+
+    void ModelProfiler::EmitPrintNodeLatencyInfoFunction()
+    {
+        int numEmittedNodes = _nodePerformanceCounters.size();
+        auto& emitter = _module->GetIREmitter();
+        auto& irBuilder = emitter.GetIRBuilder();
+
+        auto function = _module->BeginFunction(GetNamespacePrefix() + "_PrintNodeLatencyInfo", emitters::VariableType::Void);
+        function.IncludeInHeader();
+        function.IncludeInSwigInterface();
+
+        if (_nodeLatencyHistograms != nullptr)
+        {
+            function.For(numEmittedNodes, [&irBuilder, &emitter, this](emitters::IRFunctionEmitter& function, emitters::LLVMValue nodeIndex) {
+                auto nodeInfoPtr = irBuilder.CreateInBoundsGEP(_nodeInfoArray, { function.Literal(0), nodeIndex });
+                auto statisticsPtr = irBuilder.CreateInBoundsGEP(_nodeLatencyStatisticsArray, { function.Literal(0), nodeIndex });
+                EmitComputeLatencyStatistics(function, GetLatencyHistogramPtr(_nodeLatencyHistograms, nodeIndex), statisticsPtr);
+
+                auto namePtr = irBuilder.CreateGEP(nodeInfoPtr, { emitter.Literal(0), emitter.Literal(0) });
+                auto typePtr = irBuilder.CreateGEP(nodeInfoPtr, { emitter.Literal(0), emitter.Literal(1) });
+                auto fieldValue = [&](LatencyStatisticsField field) { return function.Load(irBuilder.CreateInBoundsGEP(statisticsPtr, { function.Literal(0), function.Literal(field) })); };
+                function.Printf("Node[%s]:\ttype: %s\tcount: %lld\tp50: %f ms\tp90: %f ms\tp99: %f ms\tmax: %f ms\n", { function.Load(namePtr), function.Load(typePtr), fieldValue(latencyCountField), fieldValue(p50Field), fieldValue(p90Field), fieldValue(p99Field), fieldValue(maxTimeField) });
+            });
+        }
 
         _module->EndFunction();
     }
 
+    void ModelProfiler::EmitComputeLatencyStatistics(emitters::IRFunctionEmitter& function, emitters::LLVMValue histogramPtr, emitters::LLVMValue statisticsPtr)
+    {
+        auto& irBuilder = _module->GetIREmitter().GetIRBuilder();
+        auto fieldPtr = [&](LatencyStatisticsField field) { return irBuilder.CreateInBoundsGEP(statisticsPtr, { function.Literal(0), function.Literal(field) }); };
+
+        auto totalCount = function.Variable(emitters::VariableType::Int64, "totalCount");
+        function.StoreZero(totalCount);
+        function.For(c_numLatencyBuckets, [histogramPtr, totalCount](emitters::IRFunctionEmitter& function, emitters::LLVMValue bucket) {
+            function.OperationAndUpdate(totalCount, emitters::TypedOperator::add, function.ValueAt(histogramPtr, bucket));
+        });
+        auto count = function.Load(totalCount);
+        function.Store(fieldPtr(latencyCountField), count);
+
+        // A percentile p is the value at rank ceil(p * count), which is count - floor((1 - p) * count)
+        std::vector<emitters::LLVMValue> ranks;
+        std::vector<emitters::LLVMValue> values;
+        for (const auto& percentile : c_latencyPercentiles)
+        {
+            auto countAbove = function.CastValue(function.Operator(emitters::TypedOperator::multiplyFloat, function.CastValue(count, emitters::VariableType::Double), function.Literal(1.0 - percentile.second)), emitters::VariableType::Int64);
+            ranks.push_back(function.Operator(emitters::TypedOperator::subtract, count, countAbove));
+            auto value = function.Variable(emitters::VariableType::Double, "percentile");
+            function.StoreZero(value);
+            values.push_back(value);
+        }
+
+        auto cumulativeCount = function.Variable(emitters::VariableType::Int64, "cumulativeCount");
+        function.StoreZero(cumulativeCount);
+        function.For(c_numLatencyBuckets, [&](emitters::IRFunctionEmitter& function, emitters::LLVMValue bucket) {
+            auto countBefore = function.Load(cumulativeCount);
+            auto countAfter = function.Operator(emitters::TypedOperator::add, countBefore, function.ValueAt(histogramPtr, bucket));
+            function.Store(cumulativeCount, countAfter);
+
+            auto upperBound = function.ValueAt(_latencyBucketUpperBounds, bucket);
+            for (size_t index = 0; index < ranks.size(); ++index)
+            {
+                // The percentile is in the bucket that takes the cumulative count up to its rank
+                auto isInBucket = function.Operator(emitters::TypedOperator::logicalAnd,
+                                                    function.Comparison(emitters::TypedComparison::lessThan, countBefore, ranks[index]),
+                                                    function.Comparison(emitters::TypedComparison::greaterThanOrEquals, countAfter, ranks[index]));
+                function.Store(values[index], function.Select(isInBucket, upperBound, function.Load(values[index])));
+            }
+        });
+
+        // The upper bound of a bucket can be more than the largest time counted in it
+        auto maxTime = function.Load(fieldPtr(maxTimeField));
+        for (size_t index = 0; index < values.size(); ++index)
+        {
+            auto value = function.Load(values[index]);
+            function.Store(fieldPtr(c_latencyPercentiles[index].first), function.Select(function.Comparison(emitters::TypedComparison::lessThanFloat, value, maxTime), value, maxTime));
+        }
+    }
+
+    void ModelProfiler::EmitResetLatencyHistograms(emitters::IRFunctionEmitter& function, llvm::GlobalVariable* histograms, llvm::GlobalVariable* statisticsArray, int count)
+    {
+        if (histograms != nullptr && count > 0)
+        {
+            function.MemorySet<int64_t>(histograms, 0, function.Literal<uint8_t>(0), count * c_numLatencyBuckets);
+            function.MemorySet<LatencyStatistics>(statisticsArray, 0, function.Literal<uint8_t>(0), count);
+        }
+    }
+
+    emitters::LLVMValue ModelProfiler::GetLatencyHistogramPtr(llvm::GlobalVariable* histograms, emitters::LLVMValue index)
+    {
+        auto& emitter = _module->GetIREmitter();
+        auto& irBuilder = emitter.GetIRBuilder();
+        auto firstBucket = irBuilder.CreateMul(index, emitter.Literal(c_numLatencyBuckets));
+        return irBuilder.CreateInBoundsGEP(histograms, { emitter.Literal(0), firstBucket });
+    }
+
     NodePerformanceEmitter& ModelProfiler::GetPerformanceCountersForNode(const Node& node)
     {
         assert(_profilingEnabled);
@@ -559,7 +930,12 @@ namespace model
             auto nodeInfoPtr = irBuilder.CreateInBoundsGEP(_nodeInfoArray, { emitter.Literal(0), emitter.Literal(nodeIndex) });
             auto nodePerformanceCountersPtr = irBuilder.CreateInBoundsGEP(_nodePerformanceCountersArray, { emitter.Literal(0), emitter.Literal(nodeIndex) });
 
-            NodePerformanceEmitter performanceCounters(*_module, &node, nodeInfoPtr, nodePerformanceCountersPtr, _nodeInfoType, _performanceCountersType);
+            NodePerformanceEmitter performanceCounters(*_module, &node, nodeInfoPtr, nodePerformanceCountersPtr, _nodeInfoType, _performanceCountersType, false);
+            if (_nodeLatencyHistograms != nullptr)
+            {
+                performanceCounters._performanceCountersEmitter.SetLatencyHistogram(GetLatencyHistogramPtr(_nodeLatencyHistograms, emitter.Literal(nodeIndex)),
+                                                                                    irBuilder.CreateInBoundsGEP(_nodeLatencyStatisticsArray, { emitter.Literal(0), emitter.Literal(nodeIndex) }));
+            }
             _nodePerformanceCounters[&node] = performanceCounters;
         }
 
@@ -580,7 +956,12 @@ namespace model
             auto nodeTypeInfoPtr = irBuilder.CreateInBoundsGEP(_nodeTypeInfoArray, { emitter.Literal(0), emitter.Literal(nodeIndex) });
             auto nodeTypePerformanceCountersPtr = irBuilder.CreateInBoundsGEP(_nodeTypePerformanceCountersArray, { emitter.Literal(0), emitter.Literal(nodeIndex) });
 
-            NodePerformanceEmitter performanceCounters(*_module, &node, nodeTypeInfoPtr, nodeTypePerformanceCountersPtr, _nodeInfoType, _performanceCountersType);
+            NodePerformanceEmitter performanceCounters(*_module, &node, nodeTypeInfoPtr, nodeTypePerformanceCountersPtr, _nodeInfoType, _performanceCountersType, true);
+            if (_nodeTypeLatencyHistograms != nullptr)
+            {
+                performanceCounters._performanceCountersEmitter.SetLatencyHistogram(GetLatencyHistogramPtr(_nodeTypeLatencyHistograms, emitter.Literal(nodeIndex)),
+                                                                                    irBuilder.CreateInBoundsGEP(_nodeTypeLatencyStatisticsArray, { emitter.Literal(0), emitter.Literal(nodeIndex) }));
+            }
             _nodeTypePerformanceCounters[nodeType] = performanceCounters;
         }
 
@@ -592,5 +973,17 @@ namespace model
         auto time = _module->GetRuntime().GetCurrentTime(function);
         return time;
     }
+
+    emitters::LLVMValue ModelProfiler::CallReadHardwareCounters(emitters::IRFunctionEmitter& function)
+    {
+        if (!_module->GetCompilerOptions().profileHardwareCounters)
+        {
+            return nullptr;
+        }
+
+        auto counters = function.Variable(emitters::VariableType::Int64, emitters::NumHardwareCounters);
+        _module->GetRuntime().ReadHardwareCounters(function, counters);
+        return counters;
+    }
 } // namespace model
 } // namespace ell
@@ -7,6 +7,8 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "InputPort.h"
+#include "Model.h"
+#include "Node.h"
 
 namespace ell
 {
@@ -95,6 +97,13 @@ namespace model
             input->AddReference(this);
         }
         _referencedPort = input;
+
+        // The connections between the nodes of the model have changed
+        auto node = GetNode();
+        if (node != nullptr && node->GetModel() != nullptr)
+        {
+            node->GetModel()->InvalidateAdjacency();
+        }
     }
 
     void InputPortBase::ClearReferencedPort()
@@ -13,6 +13,8 @@
 #include "RefineTransformation.h"
 
 #include <utilities/include/Exception.h>
+#include <utilities/include/ParallelFor.h>
+#include <utilities/include/PhaseTimer.h>
 #include <utilities/include/StlVectorUtil.h>
 
 #include <algorithm>
@@ -30,6 +32,10 @@ namespace model
         //
         constexpr utilities::ArchiveVersion noMetadataArchiveVersion = { utilities::ArchiveVersionNumbers::v2 };
         constexpr utilities::ArchiveVersion metadataArchiveVersion = { utilities::ArchiveVersionNumbers::v3_model_metadata };
+
+        // Model metadata keys for merged maps
+        const std::string c_mergedMapNamesKey = "mergedMapNames";
+        const std::string c_mergedMapOutputCountsKey = "mergedMapOutputCounts";
     } // namespace
 
     Map::Map(const Model& model, const std::vector<std::pair<std::string, InputNodeBase*>>& inputs, const std::vector<std::pair<std::string, const OutputPortBase&>>& outputs)
@@ -84,6 +90,7 @@ namespace model
             AddOutput(output.first, transformer.GetCorrespondingOutputs(*output.second));
         }
 
+        _numComputeThreads = other._numComputeThreads;
         _model.Verify();
     }
 
@@ -125,27 +132,27 @@ namespace model
 
     std::vector<bool> Map::ComputeBoolOutput(const PortElementsBase& outputs)
     {
-        return _model.ComputeOutput<bool>(outputs);
+        return _model.ComputeOutput<bool>(outputs, _numComputeThreads);
     }
 
     std::vector<int> Map::ComputeIntOutput(const PortElementsBase& outputs)
     {
-        return _model.ComputeOutput<int>(outputs);
+        return _model.ComputeOutput<int>(outputs, _numComputeThreads);
     }
 
     std::vector<int64_t> Map::ComputeInt64Output(const PortElementsBase& outputs)
     {
-        return _model.ComputeOutput<int64_t>(outputs);
+        return _model.ComputeOutput<int64_t>(outputs, _numComputeThreads);
     }
 
     std::vector<float> Map::ComputeFloatOutput(const PortElementsBase& outputs)
     {
-        return _model.ComputeOutput<float>(outputs);
+        return _model.ComputeOutput<float>(outputs, _numComputeThreads);
     }
 
     std::vector<double> Map::ComputeDoubleOutput(const PortElementsBase& outputs)
     {
-        return _model.ComputeOutput<double>(outputs);
+        return _model.ComputeOutput<double>(outputs, _numComputeThreads);
     }
 
     template <>
@@ -195,6 +202,11 @@ namespace model
         _model.Reset();
     }
 
+    void Map::SetNumComputeThreads(size_t numThreads)
+    {
+        _numComputeThreads = utilities::GetNumThreads(numThreads);
+    }
+
     void Map::AddInput(const std::string& inputName, InputNodeBase* inputNode)
     {
         _inputNodes.push_back(inputNode);
@@ -229,6 +241,7 @@ namespace model
         swap(a._outputNames, b._outputNames);
         swap(a._outputsMap, b._outputsMap);
         swap(a._computeContext, b._computeContext);
+        swap(a._numComputeThreads, b._numComputeThreads);
     }
 
     std::vector<const Node*> Map::GetAllOutputNodes() const
@@ -485,6 +498,7 @@ namespace model
             return;
         }
 
+        utilities::PhaseTimer timer("Refine");
         RefineTransformation refineTransformation(maxIterations);
         Transform(refineTransformation, context);
         Prune();
@@ -705,5 +719,81 @@ namespace model
         ModelSerializationContext(previousContext, nullptr)
     {
     }
+
+    //
+    // Merged maps
+    //
+    Map MergeMaps(const std::vector<Map>& maps, const std::vector<std::string>& mapNames)
+    {
+        if (maps.empty() || maps.size() != mapNames.size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "MergeMaps needs one name for each of one or more maps");
+        }
+        if (std::unordered_set<std::string>(mapNames.begin(), mapNames.end()).size() != mapNames.size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "MergeMaps needs unique map names");
+        }
+
+        Model mergedModel;
+        std::vector<std::pair<std::string, InputNodeBase*>> mergedInputs;
+        std::vector<std::pair<std::string, const OutputPortBase&>> mergedOutputs;
+        std::vector<int> outputCounts;
+        for (size_t mapIndex = 0; mapIndex < maps.size(); ++mapIndex)
+        {
+            const auto& map = maps[mapIndex];
+            std::unordered_map<const Node*, std::string> inputNames;
+            for (size_t i = 0; i < map.NumInputs(); ++i)
+            {
+                inputNames[map.GetInput(i)] = map.GetInputName(i);
+            }
+
+            // Each map gets its own transformer, so the port mappings of one map don't leak into the next
+            TransformContext context;
+            ModelTransformer transformer;
+            transformer.TransformSubmodelOnto(Submodel(map.GetModel()), mergedModel, {}, context, [&](const Node& node, ModelTransformer& transformer) {
+                auto inputName = inputNames.find(&node);
+                if (inputName == inputNames.end())
+                {
+                    transformer.CopyNode(node);
+                    return;
+                }
+
+                auto inputNode = static_cast<const InputNodeBase*>(&node);
+                auto sharedInput = std::find_if(mergedInputs.begin(), mergedInputs.end(), [&](const auto& input) { return input.first == inputName->second; });
+                if (sharedInput == mergedInputs.end())
+                {
+                    transformer.CopyNode(node);
+                    mergedInputs.emplace_back(inputName->second, transformer.GetCorrespondingInputNode(inputNode));
+                    return;
+                }
+
+                if (sharedInput->second->GetOutputType() != inputNode->GetOutputType() || sharedInput->second->GetShape() != inputNode->GetShape())
+                {
+                    throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch, "MergeMaps: the maps' inputs named '" + inputName->second + "' have different types or shapes");
+                }
+                transformer.MapNodeOutput(inputNode->GetOutputPort(), sharedInput->second->GetOutputPort());
+            });
+
+            for (size_t i = 0; i < map.NumOutputs(); ++i)
+            {
+                mergedOutputs.emplace_back(mapNames[mapIndex] + "_" + map.GetOutputName(i), transformer.GetCorrespondingOutputs(map.GetOutput(i)));
+            }
+            outputCounts.push_back(static_cast<int>(map.NumOutputs()));
+        }
+
+        mergedModel.GetMetadata().SetEntry(c_mergedMapNamesKey, mapNames);
+        mergedModel.GetMetadata().SetEntry(c_mergedMapOutputCountsKey, outputCounts);
+        return Map(std::move(mergedModel), mergedInputs, mergedOutputs);
+    }
+
+    std::vector<std::string> GetMergedMapNames(const Map& map)
+    {
+        return map.GetModel().GetMetadata().GetEntry<std::vector<std::string>>(c_mergedMapNamesKey, {});
+    }
+
+    std::vector<int> GetMergedMapOutputCounts(const Map& map)
+    {
+        return map.GetModel().GetMetadata().GetEntry<std::vector<int>>(c_mergedMapOutputCountsKey, {});
+    }
 } // namespace model
 } // namespace ell
@@ -128,26 +128,36 @@ namespace model
                     throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Visited node before all its descendants!");
                 }
             }
-            if (!node.IsCompilable(this))
-            {
-                std::string typeName = node.GetRuntimeTypeName();
-                throw emitters::EmitterException(emitters::EmitterError::notSupported, std::string("Uncompilable node type: " + typeName));
-            }
-
-            auto compilableNode = const_cast<CompilableNode*>(dynamic_cast<const CompilableNode*>(&node));
-            if (!compilableNode)
-            {
-                throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Encountered null compilable node");
-            }
-
             visitedNodes.insert(&node);
-            Log() << "Now compiling node " << DiagnosticString(node) << EOL;
-            OnBeginCompileNode(node);
-            compilableNode->CompileNode(*this);
-            OnEndCompileNode(node);
+            CompileNode(node);
         });
     }
 
+    void MapCompiler::CompileNode(const Node& node)
+    {
+        if (!node.IsCompilable(this))
+        {
+            std::string typeName = node.GetRuntimeTypeName();
+            throw emitters::EmitterException(emitters::EmitterError::notSupported, std::string("Uncompilable node type: " + typeName));
+        }
+
+        auto compilableNode = const_cast<CompilableNode*>(dynamic_cast<const CompilableNode*>(&node));
+        if (!compilableNode)
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Encountered null compilable node");
+        }
+
+        Log() << "Now compiling node " << DiagnosticString(node) << EOL;
+        OnBeginCompileNode(node);
+        compilableNode->CompileNode(*this);
+        OnEndCompileNode(node);
+    }
+
+    void MapCompiler::SetMapCompilerOptions(const MapCompilerOptions& settings)
+    {
+        _parameters = settings;
+    }
+
     emitters::Variable* MapCompiler::AllocatePortVariable(const OutputPortBase& port)
     {
         auto pModuleEmitter = GetModuleEmitter();
@@ -181,6 +191,12 @@ namespace model
         // context parameter
         functionArguments.push_back({ "context", emitters::VariableType::VoidPointer, emitters::ArgumentFlags::Input });
 
+        // state parameter, for reentrant models
+        if (GetMapCompilerOptions().reentrant)
+        {
+            functionArguments.push_back({ "state", emitters::VariableType::VoidPointer, emitters::ArgumentFlags::InOut });
+        }
+
         utilities::UniqueNameList uniqueNameScope;
         // Allocate variables for inputs
         for (auto inputNode : map.GetInputs())
@@ -33,7 +33,22 @@ namespace model
         sinkFunctionName = properties.GetOrParseEntry("sinkFunctionName", sinkFunctionName);
         verifyJittedModule = properties.GetOrParseEntry("verifyJittedModule", verifyJittedModule);
         profile = properties.GetOrParseEntry("profile", profile);
+        emitBatchPredictFunction = properties.GetOrParseEntry("emitBatchPredictFunction", emitBatchPredictFunction);
+        jitCacheDirectory = properties.GetOrParseEntry("jitCacheDirectory", jitCacheDirectory);
+        planMemory = properties.GetOrParseEntry("planMemory", planMemory);
+        scheduleForMemory = properties.GetOrParseEntry("scheduleForMemory", scheduleForMemory);
+        aliasPorts = properties.GetOrParseEntry("aliasPorts", aliasPorts);
+        reentrant = properties.GetOrParseEntry("reentrant", reentrant);
+        cacheRefinement = properties.GetOrParseEntry("cacheRefinement", cacheRefinement);
+        tieredCompilation = properties.GetOrParseEntry("tieredCompilation", tieredCompilation);
+        parallelizeBranches = properties.GetOrParseEntry("parallelizeBranches", parallelizeBranches);
+        externalWeights = properties.GetOrParseEntry("externalWeights", externalWeights);
+        footprintReport = properties.GetOrParseEntry("footprintReport", footprintReport);
+        dynamicInputExtent = properties.GetOrParseEntry("dynamicInputExtent", dynamicInputExtent);
         inlineNodes = properties.GetOrParseEntry("inlineNodes", inlineNodes);
+        lazyCompile = properties.GetOrParseEntry("lazyCompile", lazyCompile);
+        shareNodeFunctions = properties.GetOrParseEntry("shareNodeFunctions", shareNodeFunctions);
+        compilerSettings = compilerSettings.AppendOptions(properties);
     }
 } // namespace model
 } // namespace ell
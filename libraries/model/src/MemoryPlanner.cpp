@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     MemoryPlanner.cpp (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "MemoryPlanner.h"
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace ell
+{
+namespace model
+{
+    MemoryPlanner::MemoryPlanner(size_t alignment) :
+        _alignment(alignment)
+    {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Memory planner alignment must be a power of 2");
+        }
+    }
+
+    size_t MemoryPlanner::Allocate(size_t size)
+    {
+        size = std::max<size_t>(size, 1);
+
+        // Find the smallest gap between live buffers that's big enough
+        size_t bestOffset = 0;
+        size_t bestGapSize = std::numeric_limits<size_t>::max();
+        size_t gapStart = 0;
+        for (const auto& buffer : _liveBuffers)
+        {
+            auto gapSize = buffer.first - gapStart; // buffers start at aligned offsets, so this is never negative
+            if (gapSize >= size && gapSize < bestGapSize)
+            {
+                bestOffset = gapStart;
+                bestGapSize = gapSize;
+            }
+            gapStart = AlignUp(buffer.first + buffer.second);
+        }
+
+        // Otherwise, put it after the last live buffer
+        auto offset = bestGapSize == std::numeric_limits<size_t>::max() ? gapStart : bestOffset;
+        _liveBuffers[offset] = size;
+        _peakSize = std::max(_peakSize, offset + size);
+        _totalAllocatedSize += AlignUp(size);
+        return offset;
+    }
+
+    void MemoryPlanner::Free(size_t offset)
+    {
+        if (_liveBuffers.erase(offset) == 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Freeing a buffer that wasn't allocated");
+        }
+    }
+
+    size_t MemoryPlanner::AlignUp(size_t offset) const
+    {
+        return (offset + _alignment - 1) & ~(_alignment - 1);
+    }
+} // namespace model
+} // namespace ell
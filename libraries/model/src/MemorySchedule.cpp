@@ -0,0 +1,202 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     MemorySchedule.cpp (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "MemorySchedule.h"
+#include "InputPort.h"
+#include "Model.h"
+#include "Node.h"
+#include "OutputPort.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+
+namespace ell
+{
+namespace model
+{
+    namespace
+    {
+        // The number of input ports that read each port, among the given nodes
+        std::unordered_map<const OutputPortBase*, int> GetReaderCounts(const std::vector<const Node*>& nodes)
+        {
+            std::unordered_map<const OutputPortBase*, int> readerCounts;
+            for (auto node : nodes)
+            {
+                for (auto input : node->GetInputPorts())
+                {
+                    ++readerCounts[&input->GetReferencedPort()];
+                }
+            }
+            return readerCounts;
+        }
+
+        // Runs a node: its outputs become live, and the buffers it's the last reader of (or that nothing reads) are released
+        class LiveBufferTracker
+        {
+        public:
+            LiveBufferTracker(const std::vector<const Node*>& nodes, const PortBufferSizeFunction& getBufferSize) :
+                _remainingReaders(GetReaderCounts(nodes)),
+                _getBufferSize(getBufferSize)
+            {
+            }
+
+            // The change in live memory running the node would make, once it's done
+            long long GetSizeChange(const Node& node) const
+            {
+                long long change = 0;
+                for (auto output : node.GetOutputPorts())
+                {
+                    if (GetRemainingReaders(output) > 0)
+                    {
+                        change += static_cast<long long>(_getBufferSize(*output));
+                    }
+                }
+
+                std::unordered_map<const OutputPortBase*, int> reads;
+                for (auto input : node.GetInputPorts())
+                {
+                    ++reads[&input->GetReferencedPort()];
+                }
+                for (const auto& [port, count] : reads)
+                {
+                    if (GetRemainingReaders(port) == count)
+                    {
+                        change -= static_cast<long long>(_getBufferSize(*port));
+                    }
+                }
+                return change;
+            }
+
+            void Run(const Node& node)
+            {
+                // The inputs are live while the node runs
+                for (auto output : node.GetOutputPorts())
+                {
+                    _liveSize += _getBufferSize(*output);
+                }
+                _peakSize = std::max(_peakSize, _liveSize);
+
+                for (auto input : node.GetInputPorts())
+                {
+                    const auto& port = input->GetReferencedPort();
+                    if (--_remainingReaders[&port] == 0)
+                    {
+                        _liveSize -= _getBufferSize(port);
+                    }
+                }
+                for (auto output : node.GetOutputPorts())
+                {
+                    if (GetRemainingReaders(output) == 0)
+                    {
+                        _liveSize -= _getBufferSize(*output);
+                    }
+                }
+            }
+
+            size_t GetPeakSize() const { return _peakSize; }
+
+        private:
+            int GetRemainingReaders(const OutputPortBase* port) const
+            {
+                auto it = _remainingReaders.find(port);
+                return it == _remainingReaders.end() ? 0 : it->second;
+            }
+
+            std::unordered_map<const OutputPortBase*, int> _remainingReaders;
+            const PortBufferSizeFunction& _getBufferSize;
+            size_t _liveSize = 0;
+            size_t _peakSize = 0;
+        };
+    } // namespace
+
+    size_t GetPeakLiveBufferSize(const std::vector<const Node*>& nodes, const PortBufferSizeFunction& getBufferSize)
+    {
+        LiveBufferTracker tracker(nodes, getBufferSize);
+        for (auto node : nodes)
+        {
+            tracker.Run(*node);
+        }
+        return tracker.GetPeakSize();
+    }
+
+    std::vector<const Node*> GetMemoryAwareNodeOrder(const Model& model, const PortBufferSizeFunction& getBufferSize)
+    {
+        std::vector<const Node*> visitOrder;
+        model.Visit([&visitOrder](const Node& node) { visitOrder.push_back(&node); });
+
+        std::unordered_map<const Node*, size_t> positions;
+        for (size_t index = 0; index < visitOrder.size(); ++index)
+        {
+            positions[visitOrder[index]] = index;
+        }
+
+        // The nodes each node is waiting for, and the nodes waiting for it
+        std::vector<int> numPendingInputs(visitOrder.size(), 0);
+        std::vector<std::vector<size_t>> readers(visitOrder.size());
+        for (size_t index = 0; index < visitOrder.size(); ++index)
+        {
+            for (auto input : visitOrder[index]->GetInputPorts())
+            {
+                auto it = positions.find(input->GetReferencedPort().GetNode());
+                if (it != positions.end())
+                {
+                    ++numPendingInputs[index];
+                    readers[it->second].push_back(index);
+                }
+            }
+        }
+
+        // Greedily run the ready node that adds the least memory, and the earliest one in visit order among equals
+        std::vector<size_t> readyNodes;
+        for (size_t index = 0; index < visitOrder.size(); ++index)
+        {
+            if (numPendingInputs[index] == 0)
+            {
+                readyNodes.push_back(index);
+            }
+        }
+
+        LiveBufferTracker tracker(visitOrder, getBufferSize);
+        std::vector<const Node*> order;
+        order.reserve(visitOrder.size());
+        while (!readyNodes.empty())
+        {
+            auto best = readyNodes.begin();
+            auto bestChange = std::numeric_limits<long long>::max();
+            for (auto it = readyNodes.begin(); it != readyNodes.end(); ++it)
+            {
+                auto change = tracker.GetSizeChange(*visitOrder[*it]);
+                if (change < bestChange || (change == bestChange && *it < *best))
+                {
+                    best = it;
+                    bestChange = change;
+                }
+            }
+
+            auto index = *best;
+            readyNodes.erase(best);
+            tracker.Run(*visitOrder[index]);
+            order.push_back(visitOrder[index]);
+            for (auto reader : readers[index])
+            {
+                if (--numPendingInputs[reader] == 0)
+                {
+                    readyNodes.push_back(reader);
+                }
+            }
+        }
+
+        if (order.size() != visitOrder.size() || tracker.GetPeakSize() >= GetPeakLiveBufferSize(visitOrder, getBufferSize))
+        {
+            return visitOrder;
+        }
+        return order;
+    }
+} // namespace model
+} // namespace ell
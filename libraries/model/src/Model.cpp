@@ -15,9 +15,15 @@
 #include "SpliceNode.h"
 
 #include <utilities/include/Logger.h>
+#include <utilities/include/ParallelFor.h>
 #include <utilities/include/StringUtil.h>
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
 #include <unordered_map>
 
 using namespace ell::logging;
@@ -263,7 +269,10 @@ namespace model
 
         // read nodes into big array
         std::vector<std::unique_ptr<Node>> nodes;
-        archiver["nodes"] >> nodes;
+        {
+            NodeArenaScope arenaScope(*_data->nodeArena);
+            archiver["nodes"] >> nodes;
+        }
 
         // Now add them to the model
         for (auto& node : nodes)
@@ -305,12 +314,15 @@ namespace model
 
     Node* Model::AddExistingNode(std::unique_ptr<Node> node)
     {
-        std::shared_ptr<Node> sharedNode(std::move(node));
+        std::shared_ptr<Node> sharedNode(node.release(), std::default_delete<Node>(), utilities::ArenaAllocator<Node>(_data->nodeArena));
         EnsureNodeHasUniqueId(*sharedNode);
         sharedNode->SetModel(this);
         sharedNode->UpdateInputPorts();
         VerifyInputs(*sharedNode);
+        sharedNode->_index = _data->nodesByIndex.size();
+        _data->nodesByIndex.push_back(sharedNode.get());
         _data->idToNodeMap[sharedNode->GetId()] = sharedNode;
+        InvalidateAdjacency();
         return sharedNode.get();
     }
 
@@ -398,6 +410,206 @@ namespace model
         return _data->idToNodeMap;
     }
 
+    Node* Model::GetNodeByIndex(size_t index) const
+    {
+        return _data->nodesByIndex[index];
+    }
+
+    std::shared_ptr<const ModelAdjacency> Model::GetAdjacency() const
+    {
+        if (_data->adjacency == nullptr)
+        {
+            _data->adjacency = std::make_shared<const ModelAdjacency>(BuildModelAdjacency(_data->nodesByIndex));
+        }
+        return _data->adjacency;
+    }
+
+    void Model::InvalidateAdjacency()
+    {
+        _data->adjacency = nullptr;
+        _data->computePlans.clear();
+    }
+
+    std::shared_ptr<const Model::ComputePlan> Model::GetComputePlan(std::vector<const OutputPortBase*> outputs) const
+    {
+        std::sort(outputs.begin(), outputs.end());
+        outputs.erase(std::unique(outputs.begin(), outputs.end()), outputs.end());
+
+        auto& computePlans = _data->computePlans;
+        auto it = computePlans.find(outputs);
+        if (it != computePlans.end())
+        {
+            return it->second;
+        }
+
+        // Keep the plans of a bounded number of output sets
+        const size_t maxComputePlans = 16;
+        if (computePlans.size() >= maxComputePlans)
+        {
+            computePlans.clear();
+        }
+
+        auto plan = std::make_shared<ComputePlan>();
+        VisitSubmodel(outputs, [&plan](const Node& node) { plan->nodes.push_back(&node); });
+
+        // Link each node to the dependents that are part of the plan
+        auto adjacency = GetAdjacency();
+        const auto numNodes = plan->nodes.size();
+        std::vector<size_t> positions(adjacency->NumNodes(), ModelAdjacency::noNode);
+        for (size_t position = 0; position < numNodes; ++position)
+        {
+            positions[plan->nodes[position]->GetIndex()] = position;
+        }
+
+        plan->numParents.assign(numNodes, 0);
+        plan->dependentOffsets.reserve(numNodes + 1);
+        for (auto node : plan->nodes)
+        {
+            plan->dependentOffsets.push_back(plan->dependents.size());
+            auto index = node->GetIndex();
+            for (auto entry = adjacency->childOffsets[index]; entry < adjacency->childOffsets[index + 1]; ++entry)
+            {
+                auto dependent = positions[adjacency->children[entry]];
+                if (dependent != ModelAdjacency::noNode)
+                {
+                    plan->dependents.push_back(dependent);
+                    ++plan->numParents[dependent];
+                }
+            }
+        }
+        plan->dependentOffsets.push_back(plan->dependents.size());
+
+        // The nodes are in dependency order, so each node's depth is known before its dependents are visited
+        std::vector<size_t> depths(numNodes, 0);
+        std::vector<size_t> depthCounts;
+        for (size_t position = 0; position < numNodes; ++position)
+        {
+            for (auto entry = plan->dependentOffsets[position]; entry < plan->dependentOffsets[position + 1]; ++entry)
+            {
+                auto dependent = plan->dependents[entry];
+                depths[dependent] = std::max(depths[dependent], depths[position] + 1);
+            }
+            if (depths[position] >= depthCounts.size())
+            {
+                depthCounts.resize(depths[position] + 1, 0);
+            }
+            plan->width = std::max(plan->width, ++depthCounts[depths[position]]);
+        }
+
+        computePlans[outputs] = plan;
+        return plan;
+    }
+
+    void Model::Compute(const ComputePlan& plan, size_t numThreads) const
+    {
+        // A model computed from inside parallel code runs on the thread that computes it
+        numThreads = utilities::IsInParallelRegion() ? 1 : std::max(numThreads, size_t{ 1 });
+        const auto numWorkers = std::min(numThreads, plan.width);
+        if (numWorkers == 1)
+        {
+            // The nodes may still split their own work across all the threads
+            auto previousNumThreads = Node::SetNumComputeThreads(numThreads);
+            try
+            {
+                for (auto node : plan.nodes)
+                {
+                    node->Compute();
+                }
+            }
+            catch (...)
+            {
+                Node::SetNumComputeThreads(previousNumThreads);
+                throw;
+            }
+            Node::SetNumComputeThreads(previousNumThreads);
+            return;
+        }
+
+        // Run the plan as a task graph: a node is ready once all its parents are computed. Nodes that can't be
+        // computed concurrently are queued for the calling thread. The threads are shared out among the workers, so
+        // nodes that split their own work don't start more threads than were asked for.
+        const auto numThreadsPerWorker = std::max(numThreads / numWorkers, size_t{ 1 });
+        const auto numNodes = plan.nodes.size();
+        std::mutex mutex;
+        std::condition_variable nodeFinished;
+        std::vector<size_t> numPendingParents = plan.numParents;
+        std::deque<size_t> readyNodes;
+        std::deque<size_t> readyCallerNodes;
+        size_t numComputed = 0;
+        std::exception_ptr exception;
+
+        auto enqueue = [&](size_t position) {
+            (plan.nodes[position]->CanComputeConcurrently() ? readyNodes : readyCallerNodes).push_back(position);
+        };
+        for (size_t position = 0; position < numNodes; ++position)
+        {
+            if (numPendingParents[position] == 0)
+            {
+                enqueue(position);
+            }
+        }
+
+        auto computeNodes = [&](bool isCaller) {
+            auto previousNumThreads = Node::SetNumComputeThreads(numThreadsPerWorker);
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true)
+            {
+                nodeFinished.wait(lock, [&]() { return exception || numComputed == numNodes || !readyNodes.empty() || (isCaller && !readyCallerNodes.empty()); });
+                if (exception || numComputed == numNodes)
+                {
+                    break;
+                }
+
+                auto& queue = isCaller && !readyCallerNodes.empty() ? readyCallerNodes : readyNodes;
+                auto position = queue.front();
+                queue.pop_front();
+
+                lock.unlock();
+                try
+                {
+                    plan.nodes[position]->Compute();
+                }
+                catch (...)
+                {
+                    lock.lock();
+                    exception = std::current_exception();
+                    nodeFinished.notify_all();
+                    break;
+                }
+                lock.lock();
+
+                ++numComputed;
+                for (auto entry = plan.dependentOffsets[position]; entry < plan.dependentOffsets[position + 1]; ++entry)
+                {
+                    auto dependent = plan.dependents[entry];
+                    if (--numPendingParents[dependent] == 0)
+                    {
+                        enqueue(dependent);
+                    }
+                }
+                nodeFinished.notify_all();
+            }
+            lock.unlock();
+            Node::SetNumComputeThreads(previousNumThreads);
+        };
+
+        std::vector<std::future<void>> workers;
+        for (size_t worker = 1; worker < numWorkers; ++worker)
+        {
+            workers.push_back(std::async(std::launch::async, computeNodes, false));
+        }
+        computeNodes(true);
+        for (auto& worker : workers)
+        {
+            worker.get();
+        }
+
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+
     const OutputPortBase& Model::SimplifyOutputs(const PortElementsBase& elements)
     {
         const auto numRanges = elements.NumRanges();
@@ -510,14 +722,19 @@ namespace model
 
     // Base class
     NodeIterator::NodeIterator(const Model* model) :
-        _model(model)
+        _model(model),
+        _adjacency(model->GetAdjacency())
     {
     }
 
-    void NodeIterator::SetNodeVisited(const Node* node)
+    namespace
     {
-        _visitedNodes.insert(node);
-    }
+        bool HasNodeFlag(const std::vector<bool>& flags, const Node* node)
+        {
+            auto index = node->GetIndex();
+            return index < flags.size() && flags[index];
+        }
+    } // namespace
 
     void NodeIterator::SetSubmodelInputs(const std::vector<const InputPortBase*>& inputs)
     {
@@ -534,10 +751,25 @@ namespace model
 
     void NodeIterator::AddSubmodelInputParents(const Node* node)
     {
-        _submodelInputParents.insert(node);
-        for (auto parent : node->GetParentNodes())
+        // Flag the node and all its ancestors
+        std::vector<size_t> nodesToFlag = { node->GetIndex() };
+        _submodelInputParents.resize(_adjacency->NumNodes());
+        while (!nodesToFlag.empty())
         {
-            AddSubmodelInputParents(parent);
+            auto index = nodesToFlag.back();
+            nodesToFlag.pop_back();
+            if (index >= _submodelInputParents.size() || _submodelInputParents[index])
+            {
+                continue;
+            }
+            _submodelInputParents[index] = true;
+            for (auto entry = _adjacency->parentOffsets[index]; entry < _adjacency->parentOffsets[index + 1]; ++entry)
+            {
+                if (_adjacency->parents[entry] != ModelAdjacency::noNode)
+                {
+                    nodesToFlag.push_back(_adjacency->parents[entry]);
+                }
+            }
         }
     }
 
@@ -551,7 +783,7 @@ namespace model
                 const Node* nodePtr = node.second.get();
                 if (ShouldAddNodeToValidOutputs(nodePtr))
                 {
-                    _nodesToVisit.push_back(nodePtr);
+                    _nodesToVisit.push_back(nodePtr->GetIndex());
                 }
             }
         }
@@ -564,7 +796,7 @@ namespace model
 
     bool NodeIterator::ShouldAddNodeToValidOutputs(const Node* node) const
     {
-        return _submodelInputParents.find(node) == _submodelInputParents.end();
+        return !HasNodeFlag(_submodelInputParents, node);
     }
 
     bool NodeIterator::ShouldVisitInput(const InputPortBase* input) const
@@ -574,17 +806,27 @@ namespace model
 
     void NodeIterator::SetOutputNodesToVisit(const std::vector<const Node*>& outputs)
     {
-        _nodesToVisit = outputs;
+        _nodesToVisit.clear();
+        for (auto node : outputs)
+        {
+            _nodesToVisit.push_back(node->GetIndex());
+        }
     }
 
     void NodeIterator::SetOutputPortsToVisit(const std::vector<const OutputPortBase*>& outputs)
     {
         for (const auto& output : outputs)
         {
-            _nodesToVisit.push_back(output->GetNode());
+            _nodesToVisit.push_back(output->GetNode()->GetIndex());
         }
     }
 
+    void NodeIterator::SetCurrentNode(size_t index)
+    {
+        _visitedNodes[index] = true;
+        _currentNode = _model->GetNodeByIndex(index);
+    }
+
     // ForwardNodeIterator
     ForwardNodeIterator::ForwardNodeIterator(const Model* model, const std::vector<const OutputPortBase*>& outputs) :
         NodeIterator(model)
@@ -616,12 +858,15 @@ namespace model
     void ForwardNodeIterator::Next()
     {
         _currentNode = nullptr;
+        _visitedNodes.resize(_adjacency->NumNodes());
+        const auto& parentOffsets = _adjacency->parentOffsets;
+        const auto& parents = _adjacency->parents;
         while (!_nodesToVisit.empty())
         {
-            const Node* node = _nodesToVisit.back();
+            auto index = _nodesToVisit.back();
 
             // check if we've already visited this node
-            if (_visitedNodes.find(node) != _visitedNodes.end())
+            if (_visitedNodes[index])
             {
                 _nodesToVisit.pop_back();
                 continue;
@@ -629,14 +874,16 @@ namespace model
 
             // we can visit this node only if all its inputs have been visited already
             bool canVisit = true;
-            const auto& inputPorts = node->GetInputPorts();
-            for (auto inputPort : inputPorts)
+            for (auto entry = parentOffsets[index]; entry < parentOffsets[index + 1]; ++entry)
             {
-                if (ShouldVisitInput(inputPort))
+                auto parent = parents[entry];
+                if (parent != ModelAdjacency::noNode && !_visitedNodes[parent])
                 {
-                    for (const auto& parentNode : inputPort->GetParentNodes())
+                    // Only look up the port to check it against the submodel inputs if it matters
+                    if (_submodelInputs.empty() || ShouldVisitInput(_model->GetNodeByIndex(index)->GetInputPorts()[entry - parentOffsets[index]]))
                     {
-                        canVisit = canVisit && _visitedNodes.find(parentNode) != _visitedNodes.end();
+                        canVisit = false;
+                        break;
                     }
                 }
             }
@@ -644,18 +891,17 @@ namespace model
             if (canVisit)
             {
                 _nodesToVisit.pop_back();
-                SetNodeVisited(node);
-                _currentNode = node;
+                SetCurrentNode(index);
                 break;
             }
             else // visit node's inputs
             {
-                const auto& inputPorts = node->GetInputPorts();
-                for (auto input : Reverse(inputPorts)) // Visiting the inputs in reverse order more closely retains the order the nodes were originally created
+                // Visiting the inputs in reverse order more closely retains the order the nodes were originally created
+                for (auto entry = parentOffsets[index + 1]; entry > parentOffsets[index]; --entry)
                 {
-                    for (const auto& parentNode : input->GetParentNodes())
+                    if (parents[entry - 1] != ModelAdjacency::noNode)
                     {
-                        _nodesToVisit.push_back(parentNode);
+                        _nodesToVisit.push_back(parents[entry - 1]);
                     }
                 }
             }
@@ -693,12 +939,15 @@ namespace model
     void ReverseNodeIterator::Next()
     {
         _currentNode = nullptr;
+        _visitedNodes.resize(_adjacency->NumNodes());
+        const auto& childOffsets = _adjacency->childOffsets;
+        const auto& children = _adjacency->children;
         while (!_nodesToVisit.empty())
         {
-            const Node* node = _nodesToVisit.back();
+            auto index = _nodesToVisit.back();
 
             // check if we've already visited this node
-            if (_visitedNodes.find(node) != _visitedNodes.end())
+            if (_visitedNodes[index])
             {
                 _nodesToVisit.pop_back();
                 continue;
@@ -706,25 +955,26 @@ namespace model
 
             // we can visit this node only if all its outputs have been visited already
             bool canVisit = true;
-            const auto children = node->GetDependentNodes();
-            for (const auto& childNode : children)
+            for (auto entry = childOffsets[index]; entry < childOffsets[index + 1]; ++entry)
             {
-                canVisit = canVisit && _visitedNodes.find(childNode) != _visitedNodes.end();
+                if (!_visitedNodes[children[entry]])
+                {
+                    canVisit = false;
+                    break;
+                }
             }
 
             if (canVisit)
             {
                 _nodesToVisit.pop_back();
-                _visitedNodes.insert(node);
-                _currentNode = node;
+                SetCurrentNode(index);
                 break;
             }
             else // visit node's outputs
             {
-                const auto children = node->GetDependentNodes();
-                for (const auto& childNode : children)
+                for (auto entry = childOffsets[index]; entry < childOffsets[index + 1]; ++entry)
                 {
-                    _nodesToVisit.push_back(childNode);
+                    _nodesToVisit.push_back(children[entry]);
                 }
             }
         }
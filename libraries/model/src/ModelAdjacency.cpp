@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ModelAdjacency.cpp (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ModelAdjacency.h"
+#include "InputPort.h"
+#include "Node.h"
+#include "OutputPort.h"
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace ell
+{
+namespace model
+{
+    ModelAdjacency BuildModelAdjacency(const std::vector<Node*>& nodesByIndex)
+    {
+        const auto numNodes = nodesByIndex.size();
+        ModelAdjacency result;
+
+        // Parents: one entry per input port
+        result.parentOffsets.reserve(numNodes + 1);
+        result.parentOffsets.push_back(0);
+        for (auto node : nodesByIndex)
+        {
+            for (auto input : node->GetInputPorts())
+            {
+                auto parent = ModelAdjacency::noNode;
+                if (input->IsValid())
+                {
+                    auto parentNode = input->GetReferencedPort().GetNode();
+                    auto parentIndex = parentNode->GetIndex();
+                    if (parentIndex < numNodes && nodesByIndex[parentIndex] == parentNode)
+                    {
+                        parent = parentIndex;
+                    }
+                }
+                result.parents.push_back(parent);
+            }
+            result.parentOffsets.push_back(result.parents.size());
+        }
+
+        // Children: count the distinct children of each node, then fill them in. Each node's children are found in
+        // increasing order, so a repeated child is always the last one added.
+        std::vector<size_t> lastChild(numNodes, ModelAdjacency::noNode);
+        std::vector<size_t> numChildren(numNodes, 0);
+        std::vector<size_t> numParents(numNodes, 0);
+        for (size_t index = 0; index < numNodes; ++index)
+        {
+            for (auto entry = result.parentOffsets[index]; entry < result.parentOffsets[index + 1]; ++entry)
+            {
+                auto parent = result.parents[entry];
+                if (parent != ModelAdjacency::noNode && lastChild[parent] != index)
+                {
+                    lastChild[parent] = index;
+                    ++numChildren[parent];
+                    ++numParents[index];
+                }
+            }
+        }
+
+        result.childOffsets.resize(numNodes + 1);
+        result.childOffsets[0] = 0;
+        for (size_t index = 0; index < numNodes; ++index)
+        {
+            result.childOffsets[index + 1] = result.childOffsets[index] + numChildren[index];
+        }
+        result.children.resize(result.childOffsets[numNodes]);
+        std::fill(lastChild.begin(), lastChild.end(), ModelAdjacency::noNode);
+        std::vector<size_t> nextChild(result.childOffsets.begin(), result.childOffsets.end() - 1);
+        for (size_t index = 0; index < numNodes; ++index)
+        {
+            for (auto entry = result.parentOffsets[index]; entry < result.parentOffsets[index + 1]; ++entry)
+            {
+                auto parent = result.parents[entry];
+                if (parent != ModelAdjacency::noNode && lastChild[parent] != index)
+                {
+                    lastChild[parent] = index;
+                    result.children[nextChild[parent]++] = index;
+                }
+            }
+        }
+
+        // Topological order: nodes are usually added after their parents, so take the lowest-indexed ready node first
+        std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> readyNodes;
+        for (size_t index = 0; index < numNodes; ++index)
+        {
+            if (numParents[index] == 0)
+            {
+                readyNodes.push(index);
+            }
+        }
+        result.topologicalOrder.reserve(numNodes);
+        while (!readyNodes.empty())
+        {
+            auto index = readyNodes.top();
+            readyNodes.pop();
+            result.topologicalOrder.push_back(index);
+            for (auto entry = result.childOffsets[index]; entry < result.childOffsets[index + 1]; ++entry)
+            {
+                auto child = result.children[entry];
+                if (--numParents[child] == 0)
+                {
+                    readyNodes.push(child);
+                }
+            }
+        }
+        if (result.topologicalOrder.size() != numNodes)
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Model has a cycle");
+        }
+
+        return result;
+    }
+} // namespace model
+} // namespace ell
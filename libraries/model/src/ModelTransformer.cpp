@@ -11,6 +11,7 @@
 #include "Node.h"
 #include "OutputNode.h"
 #include "RefineTransformation.h"
+#include "RefinementCache.h"
 
 #include <utilities/include/Exception.h>
 #include <utilities/include/StringUtil.h>
@@ -359,8 +360,9 @@ namespace model
 
         // This call to VisitSubmodel does the actual transformation (creating new nodes, etc.)
         submodel.GetModel().VisitSubmodel(sourceInputs, submodel.GetOutputs(), [this, transformFunction](const Node& node) {
+            auto firstNewNodeIndex = _model.Size();
             transformFunction(node, *this);
-            AssignNodeAncestor(node);
+            AssignNodeAncestor(node, firstNewNodeIndex);
         });
 
         if (!previousElementMap.IsEmpty())
@@ -590,8 +592,25 @@ namespace model
         {
             Log() << "Attempting to refine " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "]" << EOL;
 
-            auto didRefineNode = node.Refine(*this);
-            AssignNodeAncestor(node);
+            auto firstNewNodeIndex = _model.Size();
+            auto cache = IsInPlace() ? nullptr : GetContext().GetRefinementCache();
+            std::string key;
+            bool didRefineNode = false;
+            if (cache != nullptr)
+            {
+                key = GetNodeContentKey(node, GetContext());
+                didRefineNode = cache->ReplayRefinement(key, node, *this);
+            }
+
+            if (!didRefineNode)
+            {
+                didRefineNode = node.Refine(*this);
+                if (cache != nullptr && didRefineNode)
+                {
+                    cache->StoreRefinement(key, node, *this, firstNewNodeIndex);
+                }
+            }
+            AssignNodeAncestor(node, firstNewNodeIndex);
             return didRefineNode;
         }
         else
@@ -602,28 +621,32 @@ namespace model
         return false;
     }
 
-    void ModelTransformer::AssignNodeAncestor(const Node& ancestorNode)
+    void ModelTransformer::AssignNodeAncestor(const Node& ancestorNode, size_t firstNewNodeIndex)
     {
-        auto iter = _model.GetReverseNodeIterator();
-        while (iter.IsValid())
+        // Only the nodes added since firstNewNodeIndex can have come from ancestorNode, so there's no need to
+        // visit the whole model
+        for (auto index = firstNewNodeIndex; index < _model.Size(); ++index)
         {
-            auto node = const_cast<Node*>(iter.Get());
+            auto node = _model.GetNodeByIndex(index);
             if (node->GetMetadata().HasEntry("ancestor"))
             {
-                break;
+                continue;
+            }
+
+            if (ancestorNode.GetMetadata().HasEntry("ancestor"))
+            {
+                node->GetMetadata().SetEntry("ancestor", ancestorNode.GetMetadata().GetEntry<std::string>("ancestor"));
             }
             else
             {
-                if (ancestorNode.GetMetadata().HasEntry("ancestor"))
-                {
-                    node->GetMetadata().SetEntry("ancestor", ancestorNode.GetMetadata().GetEntry<std::string>("ancestor"));
-                }
-                else
-                {
-                    node->GetMetadata().SetEntry("ancestor", ancestorNode.GetId().ToString());
-                }
+                node->GetMetadata().SetEntry("ancestor", ancestorNode.GetId().ToString());
+            }
+
+            // Nodes created by refining a node get the compile options set on it
+            if (ancestorNode.GetMetadata().HasEntry("compileOptions") && !node->GetMetadata().HasEntry("compileOptions"))
+            {
+                node->GetMetadata()["compileOptions"] = ancestorNode.GetMetadata().GetEntry("compileOptions");
             }
-            iter.Next();
         }
     }
 } // namespace model
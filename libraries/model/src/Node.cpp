@@ -14,7 +14,9 @@
 
 #include <utilities/include/IArchivable.h>
 
+#include <algorithm>
 #include <unordered_set>
+#include <utility>
 
 namespace ell
 {
@@ -27,8 +29,56 @@ namespace model
         //
         constexpr utilities::ArchiveVersion noMetadataArchiveVersion = { utilities::ArchiveVersionNumbers::v0_initial };
         constexpr utilities::ArchiveVersion metadataArchiveVersion = { utilities::ArchiveVersionNumbers::v3_model_metadata };
+
+        // The arena of the innermost NodeArenaScope on this thread
+        thread_local utilities::Arena* currentNodeArena = nullptr;
+
+        // The number of threads the nodes computed on this thread may use
+        thread_local size_t currentNumComputeThreads = 1;
+
+        // Each node is preceded by a header holding the arena it came from, or null if it came from the heap
+        constexpr size_t nodeHeaderSize = alignof(std::max_align_t);
     } // namespace
 
+    //
+    // NodeArenaScope
+    //
+    NodeArenaScope::NodeArenaScope(utilities::Arena& arena) :
+        _previousArena(currentNodeArena)
+    {
+        currentNodeArena = &arena;
+    }
+
+    NodeArenaScope::~NodeArenaScope()
+    {
+        currentNodeArena = _previousArena;
+    }
+
+    //
+    // Node
+    //
+    void* Node::operator new(size_t size)
+    {
+        auto arena = currentNodeArena;
+        auto memory = static_cast<char*>(arena != nullptr ? arena->Allocate(size + nodeHeaderSize) : ::operator new(size + nodeHeaderSize));
+        *reinterpret_cast<utilities::Arena**>(memory) = arena;
+        return memory + nodeHeaderSize;
+    }
+
+    void Node::operator delete(void* p)
+    {
+        if (p == nullptr)
+        {
+            return;
+        }
+
+        auto memory = static_cast<char*>(p) - nodeHeaderSize;
+        if (*reinterpret_cast<utilities::Arena**>(memory) == nullptr)
+        {
+            ::operator delete(memory);
+        }
+    }
+
     Node::Node(const std::vector<InputPortBase*>& inputs, const std::vector<OutputPortBase*>& outputs) :
         _id(NodeId()),
         _inputs(inputs),
@@ -188,6 +238,36 @@ namespace model
         return false;
     }
 
+    int64_t Node::GetOperationCount() const
+    {
+        int64_t result = 0;
+        for (auto output : GetOutputPorts())
+        {
+            result += output->Size();
+        }
+        return result;
+    }
+
+    int64_t Node::GetBytesRead() const
+    {
+        int64_t result = 0;
+        for (auto input : GetInputPorts())
+        {
+            result += input->Size() * GetPortElementSize(input->GetType());
+        }
+        return result;
+    }
+
+    int64_t Node::GetBytesWritten() const
+    {
+        int64_t result = 0;
+        for (auto output : GetOutputPorts())
+        {
+            result += output->Size() * GetPortElementSize(output->GetType());
+        }
+        return result;
+    }
+
     void Node::Print(std::ostream& os) const
     {
         bool isFirstInputPort = true;
@@ -235,6 +315,16 @@ namespace model
         }
     }
 
+    size_t Node::GetNumComputeThreads()
+    {
+        return currentNumComputeThreads;
+    }
+
+    size_t Node::SetNumComputeThreads(size_t numThreads)
+    {
+        return std::exchange(currentNumComputeThreads, std::max(numThreads, size_t{ 1 }));
+    }
+
     utilities::ArchiveVersion Node::GetArchiveVersion() const
     {
         if (_metadata.IsEmpty())
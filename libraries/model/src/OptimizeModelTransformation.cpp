@@ -7,8 +7,13 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "OptimizeModelTransformation.h"
+#include "MapCompiler.h"
 #include "TransformationRegistry.h"
 
+#include <model/optimizer/include/NodeOptionsSearch.h>
+
+#include <utilities/include/PhaseTimer.h>
+
 namespace ell
 {
 namespace model
@@ -16,10 +21,21 @@ namespace model
     Submodel OptimizeModelTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
     {
         Submodel result = submodel;
+
+        // Choose the per-node compiler options first, so they're in place when the transformations below look at them
+        auto compiler = context.GetCompiler();
+        if (compiler && compiler->GetModelOptimizerOptions(submodel.GetModel()).GetEntry<bool>("searchNodeOptions", false))
+        {
+            optimizer::NodeOptionsSearchTransformation searchTransformation;
+            utilities::PhaseTimer timer(searchTransformation.GetRuntimeTypeName());
+            result = searchTransformation.Transform(result, transformer, context);
+        }
+
         const auto& registry = TransformationRegistry::GetGlobalRegistry();
 
         for (const auto& transformation : registry)
         {
+            utilities::PhaseTimer timer(transformation->GetRuntimeTypeName());
             result = transformation->Transform(result, transformer, context);
         }
         return result;
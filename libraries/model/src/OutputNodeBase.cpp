@@ -63,9 +63,19 @@ namespace model
         function.If(ell::emitters::TypedComparison::notEquals, output, function.NullPointer(output.value->getType()->getPointerElementType()->getPointerTo()), [output, &compiler, this](emitters::IRFunctionEmitter& function) {
             auto input = function.LocalArray(compiler.EnsurePortEmitted(_inputBase));
             auto size = _inputBase.Size();
-            function.For(size, [input, output](emitters::IRFunctionEmitter& function, auto i) {
+            auto copy = [input, output](emitters::IRFunctionEmitter& function, auto i) {
                 output[i] = input[i];
-            });
+            };
+            if (auto extent = compiler.GetDynamicExtent(_outputBase, function))
+            {
+                // Only copy the first `extent` entries along the outermost dimension
+                auto entriesPerExtent = static_cast<int>(size) / _outputBase.GetMemoryLayout().GetActiveSize(0);
+                function.For(function.Operator(emitters::TypedOperator::multiply, extent, function.Literal<int>(entriesPerExtent)), copy);
+            }
+            else
+            {
+                function.For(size, copy);
+            }
         });
     }
 } // namespace model
@@ -0,0 +1,413 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PipelinedMap.cpp (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PipelinedMap.h"
+#include "IRMapCompiler.h"
+#include "InputNode.h"
+#include "ModelTransformer.h"
+#include "Submodel.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ell
+{
+namespace model
+{
+    namespace
+    {
+        size_t GetElementSize(Port::PortType type)
+        {
+            switch (type)
+            {
+            case Port::PortType::boolean:
+                return sizeof(bool);
+            case Port::PortType::integer:
+                return sizeof(int);
+            case Port::PortType::bigInt:
+                return sizeof(int64_t);
+            case Port::PortType::smallReal:
+                return sizeof(float);
+            case Port::PortType::real:
+                return sizeof(double);
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
+            }
+        }
+
+        InputNodeBase* AddPlaceholderInput(Model& model, const OutputPortBase& port)
+        {
+            switch (port.GetType())
+            {
+            case Port::PortType::boolean:
+                return model.AddNode<InputNode<bool>>(port.GetMemoryLayout());
+            case Port::PortType::integer:
+                return model.AddNode<InputNode<int>>(port.GetMemoryLayout());
+            case Port::PortType::bigInt:
+                return model.AddNode<InputNode<int64_t>>(port.GetMemoryLayout());
+            case Port::PortType::smallReal:
+                return model.AddNode<InputNode<float>>(port.GetMemoryLayout());
+            case Port::PortType::real:
+                return model.AddNode<InputNode<double>>(port.GetMemoryLayout());
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
+            }
+        }
+
+        template <typename InputType>
+        std::function<void(const void*, void*)> GetPredictFunction(IRCompiledMap& map)
+        {
+            auto compiledMap = &map;
+            switch (map.GetOutput(0).GetType())
+            {
+            case Port::PortType::boolean:
+                return [compiledMap](const void* input, void* output) { compiledMap->Predict(static_cast<const InputType*>(input), static_cast<bool*>(output)); };
+            case Port::PortType::integer:
+                return [compiledMap](const void* input, void* output) { compiledMap->Predict(static_cast<const InputType*>(input), static_cast<int*>(output)); };
+            case Port::PortType::bigInt:
+                return [compiledMap](const void* input, void* output) { compiledMap->Predict(static_cast<const InputType*>(input), static_cast<int64_t*>(output)); };
+            case Port::PortType::smallReal:
+                return [compiledMap](const void* input, void* output) { compiledMap->Predict(static_cast<const InputType*>(input), static_cast<float*>(output)); };
+            case Port::PortType::real:
+                return [compiledMap](const void* input, void* output) { compiledMap->Predict(static_cast<const InputType*>(input), static_cast<double*>(output)); };
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
+            }
+        }
+
+        std::function<void(const void*, void*)> GetPredictFunction(IRCompiledMap& map)
+        {
+            switch (map.GetInput(0)->GetOutputPort().GetType())
+            {
+            case Port::PortType::boolean:
+                return GetPredictFunction<bool>(map);
+            case Port::PortType::integer:
+                return GetPredictFunction<int>(map);
+            case Port::PortType::bigInt:
+                return GetPredictFunction<int64_t>(map);
+            case Port::PortType::smallReal:
+                return GetPredictFunction<float>(map);
+            case Port::PortType::real:
+                return GetPredictFunction<double>(map);
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
+            }
+        }
+
+        void CheckMap(const Map& map)
+        {
+            if (map.NumInputs() != 1 || map.NumOutputs() != 1)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "PipelinedMap needs a map with one input and one output");
+            }
+        }
+
+        // Nodes with no inputs, other than the input nodes, are constants that every stage can compute for itself
+        bool IsConstant(const Node& node)
+        {
+            return node.NumInputPorts() == 0 && dynamic_cast<const InputNodeBase*>(&node) == nullptr;
+        }
+
+        std::vector<const Node*> GetNodesInOrder(const Model& model)
+        {
+            std::vector<const Node*> nodes;
+            model.Visit([&nodes](const Node& node) { nodes.push_back(&node); });
+            return nodes;
+        }
+
+        void PinThreadToCore(std::thread& thread, int core)
+        {
+#if defined(__linux__)
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(core, &cpuSet);
+            pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuSet);
+#else
+            // Thread affinity is only supported via pthread_setaffinity_np for now
+            (void)thread;
+            (void)core;
+#endif
+        }
+    } // namespace
+
+    //
+    // PipelinedMap
+    //
+    PipelinedMap::Stage::Stage(Map map, IRCompiledMap compiledMap) :
+        map(std::move(map)),
+        compiledMap(std::move(compiledMap))
+    {
+    }
+
+    PipelinedMap::PipelinedMap(const Map& map, int numStages, const MapCompilerOptions& settings, const ModelOptimizerOptions& optimizerOptions, const std::vector<int>& cores, int queueSize, NodeCostFunction nodeCost)
+    {
+        CheckMap(map);
+        if (queueSize < 1)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "PipelinedMap needs room for at least one frame between stages");
+        }
+
+        const auto& model = map.GetModel();
+        auto boundaries = GetStageBoundaries(map, numStages, nodeCost);
+        auto nodes = GetNodesInOrder(model);
+        std::unordered_map<const Node*, size_t> positions;
+        for (size_t index = 0; index < nodes.size(); ++index)
+        {
+            positions[nodes[index]] = index;
+        }
+
+        // Each stage computes the nodes after the previous stage's output, up to its own output
+        std::vector<Map> stageMaps;
+        for (size_t stage = 0; stage <= boundaries.size(); ++stage)
+        {
+            const auto& output = stage < boundaries.size() ? *boundaries[stage] : map.GetOutput(0);
+            if (stage == 0)
+            {
+                stageMaps.emplace_back(model, std::vector<std::pair<std::string, InputNodeBase*>>{ { "input", map.GetInput(0) } }, std::vector<std::pair<std::string, const OutputPortBase&>>{ { "output", output } });
+                continue;
+            }
+
+            const auto& input = *boundaries[stage - 1];
+            auto first = positions[input.GetNode()];
+            auto last = positions[output.GetNode()];
+            std::vector<const InputPortBase*> readers;
+            for (auto reader : input.GetReferences())
+            {
+                auto position = positions[reader->GetNode()];
+                if (position > first && position <= last)
+                {
+                    readers.push_back(reader);
+                }
+            }
+
+            Model stageModel;
+            auto placeholder = AddPlaceholderInput(stageModel, input);
+            ModelTransformer transformer;
+            auto copy = transformer.CopySubmodelOnto(Submodel(readers, { &output }), stageModel, { &placeholder->GetOutputPort() }, TransformContext());
+            const auto& stageOutput = *copy.GetOutputs()[0];
+            stageMaps.emplace_back(std::move(stageModel), std::vector<std::pair<std::string, InputNodeBase*>>{ { "input", placeholder } }, std::vector<std::pair<std::string, const OutputPortBase&>>{ { "output", stageOutput } });
+        }
+
+        for (size_t stage = 0; stage < stageMaps.size(); ++stage)
+        {
+            auto stageSettings = settings;
+            stageSettings.moduleName = settings.moduleName + "_stage" + std::to_string(stage);
+            IRMapCompiler compiler(stageSettings, optimizerOptions);
+            auto compiledMap = compiler.Compile(stageMaps[stage]);
+            compiledMap.FinishJitting();
+            _stages.push_back(std::make_unique<Stage>(std::move(stageMaps[stage]), std::move(compiledMap)));
+            _stages.back()->predict = GetPredictFunction(_stages.back()->compiledMap);
+
+            const auto& stageInput = _stages.back()->map.GetInput(0)->GetOutputPort();
+            _queues.push_back(std::make_unique<FrameQueue>(queueSize, Frame(stageInput.Size() * GetElementSize(stageInput.GetType()))));
+        }
+
+        const auto& output = map.GetOutput(0);
+        _queues.push_back(std::make_unique<FrameQueue>(queueSize, Frame(output.Size() * GetElementSize(output.GetType()))));
+
+        _inputType = map.GetInput(0)->GetOutputPort().GetType();
+        _outputType = output.GetType();
+        _inputSize = map.GetInputSize(0);
+        _outputSize = map.GetOutputSize(0);
+
+        for (int stage = 0; stage < NumStages(); ++stage)
+        {
+            _stages[stage]->thread = std::thread([this, stage] { RunStage(stage); });
+            if (stage < static_cast<int>(cores.size()))
+            {
+                PinThreadToCore(_stages[stage]->thread, cores[stage]);
+            }
+        }
+    }
+
+    PipelinedMap::~PipelinedMap()
+    {
+        _stopping = true;
+        for (auto& stage : _stages)
+        {
+            if (stage->thread.joinable())
+            {
+                stage->thread.join();
+            }
+        }
+    }
+
+    void PipelinedMap::RunStage(int index)
+    {
+        auto& stage = *_stages[index];
+        auto& inputQueue = *_queues[index];
+        auto& outputQueue = *_queues[index + 1];
+        while (!_stopping)
+        {
+            auto input = inputQueue.BeginPop();
+            auto output = input == nullptr ? nullptr : outputQueue.BeginPush();
+            if (output == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // The frame is computed in place, and only then are the slots handed on
+            stage.predict(input->data(), output->data());
+            outputQueue.EndPush();
+            inputQueue.EndPop();
+        }
+    }
+
+    void PipelinedMap::CheckInputType(Port::PortType type) const
+    {
+        if (type != _inputType)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch, "Frame type doesn't match the map's input");
+        }
+    }
+
+    void PipelinedMap::CheckOutputType(Port::PortType type) const
+    {
+        if (type != _outputType)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch, "Result type doesn't match the map's output");
+        }
+    }
+
+    std::vector<const OutputPortBase*> PipelinedMap::GetStageBoundaries(const Map& map, int numStages, NodeCostFunction nodeCost)
+    {
+        CheckMap(map);
+        if (numStages < 1)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "PipelinedMap needs at least one stage");
+        }
+        if (!nodeCost)
+        {
+            nodeCost = [](const Node& node) { return static_cast<double>(std::max<int64_t>(node.GetOperationCount(), 0)); };
+        }
+
+        auto nodes = GetNodesInOrder(map.GetModel());
+        auto numNodes = nodes.size();
+        std::unordered_map<const Node*, size_t> positions;
+        for (size_t index = 0; index < numNodes; ++index)
+        {
+            positions[nodes[index]] = index;
+        }
+
+        // The model can be cut after position `p` if everything the later nodes read from the earlier ones comes
+        // from a single port, which isn't just the input. Cuts that differ only by constants cut at the same port,
+        // so only the first of them is a candidate.
+        std::vector<const OutputPortBase*> crossingPorts(numNodes, nullptr);
+        std::vector<bool> canCut(numNodes, true);
+        for (size_t position = 0; position < numNodes; ++position)
+        {
+            for (auto input : nodes[position]->GetInputPorts())
+            {
+                const auto& port = input->GetReferencedPort();
+                auto source = port.GetNode();
+                if (IsConstant(*source))
+                {
+                    continue;
+                }
+                for (auto cut = positions[source]; cut < position; ++cut)
+                {
+                    if (crossingPorts[cut] != nullptr && crossingPorts[cut] != &port)
+                    {
+                        canCut[cut] = false;
+                    }
+                    crossingPorts[cut] = &port;
+                }
+            }
+        }
+
+        const auto outputPosition = positions[map.GetOutput(0).GetNode()];
+        std::vector<size_t> cuts; // candidate cut positions, plus the end of the model
+        for (size_t position = 0; position < outputPosition; ++position)
+        {
+            auto port = crossingPorts[position];
+            if (canCut[position] && port != nullptr && dynamic_cast<const InputNodeBase*>(port->GetNode()) == nullptr && (cuts.empty() || crossingPorts[cuts.back()] != port))
+            {
+                cuts.push_back(position);
+            }
+        }
+        cuts.push_back(numNodes - 1);
+
+        std::vector<double> totalCost(numNodes + 1, 0.0); // totalCost[p] is the cost of the nodes before position p
+        for (size_t position = 0; position < numNodes; ++position)
+        {
+            totalCost[position + 1] = totalCost[position] + nodeCost(*nodes[position]) + 1;
+        }
+
+        // Choose the cuts that minimize the cost of the most expensive stage: cost[s][c] is the best cost of
+        // computing up to cut `c` in `s + 1` stages, and previous[s][c] the cut before it
+        const auto numCuts = cuts.size();
+        const auto maxStages = std::min(static_cast<size_t>(numStages), numCuts);
+        const auto infinity = std::numeric_limits<double>::infinity();
+        std::vector<std::vector<double>> cost(maxStages, std::vector<double>(numCuts, infinity));
+        std::vector<std::vector<int>> previous(maxStages, std::vector<int>(numCuts, -1));
+        for (size_t c = 0; c < numCuts; ++c)
+        {
+            cost[0][c] = totalCost[cuts[c] + 1];
+        }
+        for (size_t s = 1; s < maxStages; ++s)
+        {
+            for (size_t c = s; c < numCuts; ++c)
+            {
+                for (size_t p = s - 1; p < c; ++p)
+                {
+                    auto stageCost = std::max(cost[s - 1][p], totalCost[cuts[c] + 1] - totalCost[cuts[p] + 1]);
+                    if (stageCost < cost[s][c])
+                    {
+                        cost[s][c] = stageCost;
+                        previous[s][c] = static_cast<int>(p);
+                    }
+                }
+            }
+        }
+
+        // Use the fewest stages that reach the best cost, since extra stages only add latency
+        size_t bestStages = 0;
+        for (size_t s = 1; s < maxStages; ++s)
+        {
+            if (cost[s][numCuts - 1] < cost[bestStages][numCuts - 1])
+            {
+                bestStages = s;
+            }
+        }
+
+        std::vector<const OutputPortBase*> boundaries;
+        for (auto c = previous[bestStages][numCuts - 1], s = static_cast<int>(bestStages) - 1; c >= 0; c = previous[s][c], --s)
+        {
+            boundaries.push_back(crossingPorts[cuts[c]]);
+        }
+        std::reverse(boundaries.begin(), boundaries.end());
+        return boundaries;
+    }
+
+    PipelinedMap::NodeCostFunction PipelinedMap::GetProfiledNodeCosts(IRCompiledMap& profiledMap)
+    {
+        // The profiled map's nodes were refined from the original map's nodes, which they name as their ancestor
+        auto times = std::make_shared<std::map<std::string, double>>();
+        for (int index = 0; index < profiledMap.GetNumProfiledNodes(); ++index)
+        {
+            auto info = profiledMap.GetNodeInfo(index);
+            auto counters = profiledMap.GetNodePerformanceCounters(index);
+            (*times)[info->nodeAncestor] += counters->totalTime;
+        }
+
+        return [times](const Node& node) {
+            auto it = times->find(node.GetId().ToString());
+            return it == times->end() ? 0.0 : it->second;
+        };
+    }
+} // namespace model
+} // namespace ell
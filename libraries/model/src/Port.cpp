@@ -9,9 +9,11 @@
 #include "Port.h"
 #include "Node.h"
 
+#include <utilities/include/Exception.h>
 #include <utilities/include/StringUtil.h>
 
 #include <cctype>
+#include <cstdint>
 
 namespace ell
 {
@@ -152,5 +154,28 @@ namespace model
             return "Unknown";
         };
     }
+
+    size_t GetPortElementSize(ell::model::Port::PortType type)
+    {
+        switch (type)
+        {
+        case ell::model::Port::PortType::none:
+            return 0;
+        case ell::model::Port::PortType::smallReal:
+            return sizeof(float);
+        case ell::model::Port::PortType::real:
+            return sizeof(double);
+        case ell::model::Port::PortType::integer:
+            return sizeof(int);
+        case ell::model::Port::PortType::bigInt:
+            return sizeof(int64_t);
+        case ell::model::Port::PortType::categorical:
+            return sizeof(int);
+        case ell::model::Port::PortType::boolean:
+            return sizeof(bool);
+        default:
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Unknown port type");
+        };
+    }
 } // namespace model
 } // namespace ell
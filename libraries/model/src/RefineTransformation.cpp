@@ -12,6 +12,9 @@
 
 #include <utilities/include/Exception.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace ell
 {
 namespace model
@@ -40,10 +43,29 @@ namespace model
 
     Submodel RefineTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
     {
+        // A node that didn't refine itself in one pass won't in the next, so after the first pass only the nodes
+        // produced by refinement are offered to RefineNode, and the others are copied. The flags are indexed by
+        // Node::GetIndex() in the model being refined.
+        std::vector<bool> isRefinementCandidate;
+        std::vector<bool> nextRefinementCandidates;
+        bool isFirstPass = true;
         bool didRefineAny = false;
-        auto refineFunction = [&didRefineAny](const Node& node, ModelTransformer& transformer) {
+        const Model* destModel = nullptr;
+        auto refineFunction = [&](const Node& node, ModelTransformer& transformer) {
+            if (!isFirstPass && (node.GetIndex() >= isRefinementCandidate.size() || !isRefinementCandidate[node.GetIndex()]))
+            {
+                transformer.CopyNode(node);
+                return;
+            }
+
+            auto firstNewNodeIndex = destModel->Size();
             bool didRefineNode = transformer.RefineNode(node);
             didRefineAny |= didRefineNode;
+            if (didRefineNode)
+            {
+                nextRefinementCandidates.resize(destModel->Size());
+                std::fill(nextRefinementCandidates.begin() + firstNewNodeIndex, nextRefinementCandidates.end(), true);
+            }
         };
 
         Submodel newSubmodel = submodel;
@@ -52,7 +74,9 @@ namespace model
             didRefineAny = false;
             auto currentSubmodel = std::move(newSubmodel);
             Model newModel;
+            destModel = &newModel;
             newModel.GetMetadata() = currentSubmodel.GetModel().GetMetadata();
+            nextRefinementCandidates.clear();
             newSubmodel = transformer.TransformSubmodelOnto(currentSubmodel, newModel, {}, context, refineFunction);
 
             // check for early end condition
@@ -60,6 +84,9 @@ namespace model
             {
                 break;
             }
+
+            isRefinementCandidate = std::move(nextRefinementCandidates);
+            isFirstPass = false;
         }
 
         return newSubmodel;
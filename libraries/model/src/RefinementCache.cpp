@@ -0,0 +1,365 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     RefinementCache.cpp (model)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "RefinementCache.h"
+#include "IRCompiledMapCache.h"
+#include "InputNode.h"
+#include "InputPort.h"
+#include "MapCompiler.h"
+#include "ModelTransformer.h"
+#include "Node.h"
+#include "Submodel.h"
+#include "TransformContext.h"
+
+#include <utilities/include/BinaryArchiver.h>
+#include <utilities/include/Exception.h>
+#include <utilities/include/PropertyBag.h>
+#include <utilities/include/UniqueId.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <unordered_set>
+
+namespace ell
+{
+namespace model
+{
+    namespace
+    {
+        // A stream buffer that keeps two independent 64-bit hashes of everything written to it, instead of the data itself
+        class HashingStreamBuffer : public std::streambuf
+        {
+        public:
+            std::string GetKey() const
+            {
+                std::stringstream key;
+                key << std::hex << std::setfill('0') << std::setw(16) << _fnvHash << std::setw(16) << _multiplicativeHash << "-" << std::dec << _length;
+                return key.str();
+            }
+
+        protected:
+            int_type overflow(int_type c) override
+            {
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                {
+                    Add(static_cast<unsigned char>(c));
+                }
+                return traits_type::not_eof(c);
+            }
+
+            std::streamsize xsputn(const char* data, std::streamsize count) override
+            {
+                for (std::streamsize index = 0; index < count; ++index)
+                {
+                    Add(static_cast<unsigned char>(data[index]));
+                }
+                return count;
+            }
+
+        private:
+            void Add(unsigned char c)
+            {
+                _fnvHash = (_fnvHash ^ c) * 0x100000001b3ull;
+                _multiplicativeHash = (_multiplicativeHash + c + 1) * 0x9e3779b97f4a7c15ull;
+                ++_length;
+            }
+
+            uint64_t _fnvHash = 0xcbf29ce484222325ull;
+            uint64_t _multiplicativeHash = 0;
+            uint64_t _length = 0;
+        };
+
+        // Archives a node without the things that differ between copies of it: ids (its own, and those of the
+        // nodes it reads from) and metadata, which holds its ancestor and is archived in a different order each time
+        class NodeContentArchiver : public utilities::BinaryArchiver
+        {
+        public:
+            using BinaryArchiver::BinaryArchiver;
+
+        protected:
+            using BinaryArchiver::ArchiveValue;
+
+            void ArchiveValue(const char* name, const utilities::IArchivable& value) override
+            {
+                if (dynamic_cast<const utilities::UniqueId*>(&value) != nullptr || dynamic_cast<const utilities::PropertyBag*>(&value) != nullptr)
+                {
+                    return;
+                }
+                Archiver::ArchiveValue(name, value);
+            }
+        };
+
+        const OutputPortBase& AddPlaceholderInput(Model& model, const OutputPortBase& port)
+        {
+            switch (port.GetType())
+            {
+            case Port::PortType::boolean:
+                return model.AddNode<InputNode<bool>>(port.GetMemoryLayout())->output;
+            case Port::PortType::integer:
+                return model.AddNode<InputNode<int>>(port.GetMemoryLayout())->output;
+            case Port::PortType::bigInt:
+                return model.AddNode<InputNode<int64_t>>(port.GetMemoryLayout())->output;
+            case Port::PortType::smallReal:
+                return model.AddNode<InputNode<float>>(port.GetMemoryLayout())->output;
+            case Port::PortType::real:
+                return model.AddNode<InputNode<double>>(port.GetMemoryLayout())->output;
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch);
+            }
+        }
+
+        template <typename T>
+        int IndexOf(const std::vector<T>& values, const T& value)
+        {
+            auto it = std::find(values.begin(), values.end(), value);
+            return it == values.end() ? -1 : static_cast<int>(it - values.begin());
+        }
+    } // namespace
+
+    std::string GetNodeContentKey(const Node& node, const TransformContext& context)
+    {
+        HashingStreamBuffer buffer;
+        {
+            std::ostream stream(&buffer);
+            NodeContentArchiver archiver(stream);
+            archiver["node"] << node;
+
+            const auto& inputs = node.GetInputPorts();
+            std::vector<const OutputPortBase*> referencedPorts;
+            for (auto input : inputs)
+            {
+                // Refinement can depend on which inputs are the same port, but not on what the port is
+                auto referencedPort = &input->GetReferencedPort();
+                auto alias = IndexOf(referencedPorts, referencedPort);
+                referencedPorts.push_back(referencedPort);
+                archiver["inputType"] << static_cast<int>(input->GetType());
+                archiver["inputLayout"] << input->GetMemoryLayout();
+                archiver["inputAlias"] << alias;
+            }
+
+            std::vector<std::string> metadata;
+            for (const auto& entry : node.GetMetadata())
+            {
+                if (entry.first != "ancestor")
+                {
+                    metadata.push_back(entry.first + "=" + entry.second.ToString());
+                }
+            }
+            std::sort(metadata.begin(), metadata.end());
+            archiver["metadata"] << metadata;
+
+            if (auto compiler = context.GetCompiler())
+            {
+                archiver["compilerOptions"] << GetMapCompilerOptionsKey(compiler->GetMapCompilerOptions(node));
+            }
+        }
+        return node.GetRuntimeTypeName() + "-" + buffer.GetKey();
+    }
+
+    bool RefinementCache::ReplayRefinement(const std::string& key, const Node& node, ModelTransformer& transformer)
+    {
+        std::shared_ptr<const Entry> entry;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _entries.find(key);
+            if (it == _entries.end())
+            {
+                ++_numMisses;
+                return false;
+            }
+            ++_numHits;
+            entry = it->second;
+        }
+
+        const auto& nodeInputs = node.GetInputPorts();
+        auto& model = transformer.GetModel();
+        auto firstNewNodeIndex = model.Size();
+        std::vector<const OutputPortBase*> newOutputs;
+        if (!entry->outputs.empty())
+        {
+            std::vector<const OutputPortBase*> onto;
+            for (auto index : entry->inputIndices)
+            {
+                onto.push_back(&transformer.GetCorrespondingInputs(*nodeInputs[index]));
+            }
+
+            ModelTransformer replayer;
+            auto copy = replayer.CopySubmodelOnto(Submodel(entry->inputs, entry->outputs), model, onto, TransformContext());
+            newOutputs = copy.GetOutputs();
+        }
+
+        // The copies are descended from the cached nodes; the caller makes them descendants of `node` instead
+        for (auto index = firstNewNodeIndex; index < model.Size(); ++index)
+        {
+            model.GetNodeByIndex(index)->GetMetadata().RemoveEntry("ancestor");
+        }
+
+        const auto& nodeOutputs = node.GetOutputPorts();
+        for (size_t index = 0; index < nodeOutputs.size(); ++index)
+        {
+            auto outputIndex = entry->outputIndices[index];
+            const auto& newOutput = outputIndex >= 0 ? *newOutputs[outputIndex] : transformer.GetCorrespondingInputs(*nodeInputs[-1 - outputIndex]);
+            transformer.MapNodeOutput(*nodeOutputs[index], newOutput);
+        }
+        return true;
+    }
+
+    void RefinementCache::StoreRefinement(const std::string& key, const Node& node, ModelTransformer& transformer, size_t firstNewNodeIndex)
+    {
+        auto& model = transformer.GetModel();
+        std::vector<const OutputPortBase*> newInputs;
+        for (auto input : node.GetInputPorts())
+        {
+            newInputs.push_back(&transformer.GetCorrespondingInputs(*input));
+        }
+
+        std::unordered_set<const Node*> newNodes;
+        for (auto index = firstNewNodeIndex; index < model.Size(); ++index)
+        {
+            newNodes.insert(model.GetNodeByIndex(index));
+        }
+
+        auto entry = std::make_shared<Entry>();
+        std::vector<const OutputPortBase*> fragmentOutputs;
+        for (auto output : node.GetOutputPorts())
+        {
+            const auto& newOutput = transformer.GetCorrespondingOutputs(*output);
+            if (newNodes.find(newOutput.GetNode()) != newNodes.end())
+            {
+                auto outputIndex = IndexOf(fragmentOutputs, &newOutput);
+                if (outputIndex < 0)
+                {
+                    outputIndex = static_cast<int>(fragmentOutputs.size());
+                    fragmentOutputs.push_back(&newOutput);
+                }
+                entry->outputIndices.push_back(outputIndex);
+            }
+            else
+            {
+                auto inputIndex = IndexOf(newInputs, &newOutput);
+                if (inputIndex < 0)
+                {
+                    return;
+                }
+                entry->outputIndices.push_back(-1 - inputIndex);
+            }
+        }
+
+        // Find the edges into the part of the refinement the outputs depend on. They must all come from the node's inputs.
+        std::vector<const InputPortBase*> fragmentInputs;
+        std::vector<const Node*> nodesToVisit;
+        std::unordered_set<const Node*> visitedNodes;
+        for (auto output : fragmentOutputs)
+        {
+            nodesToVisit.push_back(output->GetNode());
+        }
+        while (!nodesToVisit.empty())
+        {
+            auto fragmentNode = nodesToVisit.back();
+            nodesToVisit.pop_back();
+            if (!visitedNodes.insert(fragmentNode).second)
+            {
+                continue;
+            }
+
+            for (auto input : fragmentNode->GetInputPorts())
+            {
+                const auto& referencedPort = input->GetReferencedPort();
+                if (newNodes.find(referencedPort.GetNode()) != newNodes.end())
+                {
+                    nodesToVisit.push_back(referencedPort.GetNode());
+                }
+                else if (IndexOf(newInputs, &referencedPort) >= 0)
+                {
+                    fragmentInputs.push_back(input);
+                }
+                else
+                {
+                    return;
+                }
+            }
+        }
+
+        std::vector<const OutputPortBase*> placeholders;
+        for (auto input : newInputs)
+        {
+            placeholders.push_back(&AddPlaceholderInput(entry->model, *input));
+        }
+
+        if (!fragmentOutputs.empty())
+        {
+            std::vector<const OutputPortBase*> onto;
+            for (auto input : fragmentInputs)
+            {
+                onto.push_back(placeholders[IndexOf(newInputs, &input->GetReferencedPort())]);
+            }
+
+            ModelTransformer copier;
+            auto copy = copier.CopySubmodelOnto(Submodel(fragmentInputs, fragmentOutputs), entry->model, onto, TransformContext());
+            entry->outputs = copy.GetOutputs();
+
+            for (size_t index = 0; index < entry->model.Size(); ++index)
+            {
+                auto cachedNode = entry->model.GetNodeByIndex(index);
+                cachedNode->GetMetadata().RemoveEntry("ancestor");
+                for (auto input : cachedNode->GetInputPorts())
+                {
+                    auto placeholderIndex = IndexOf(placeholders, &input->GetReferencedPort());
+                    if (placeholderIndex >= 0)
+                    {
+                        entry->inputs.push_back(input);
+                        entry->inputIndices.push_back(static_cast<size_t>(placeholderIndex));
+                    }
+                }
+            }
+
+            // Build the adjacency now, so replaying the entry only reads from the model
+            entry->model.GetAdjacency();
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries[key] = std::move(entry);
+    }
+
+    void RefinementCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.clear();
+        _numHits = 0;
+        _numMisses = 0;
+    }
+
+    size_t RefinementCache::NumEntries() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _entries.size();
+    }
+
+    size_t RefinementCache::NumHits() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _numHits;
+    }
+
+    size_t RefinementCache::NumMisses() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _numMisses;
+    }
+
+    RefinementCache& RefinementCache::GetGlobalCache()
+    {
+        static RefinementCache cache;
+        return cache;
+    }
+} // namespace model
+} // namespace ell
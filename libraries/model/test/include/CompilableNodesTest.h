@@ -33,10 +33,17 @@ void TestCompilableVectorOutputNode();
 void TestCompilableAccumulatorNode();
 void TestCompilableDotProductNode();
 void TestCompilableDelayNode();
+void TestCompilableMovingAverageNode();
+void TestCompilableMovingVarianceNode();
+void TestCompilableMovingStatisticsLongStream();
+void TestCompilableStatefulNodesReset();
 void TestCompilableDTWDistanceNode();
+void TestCompilableMultiPrototypeDTWDistanceNode();
 void TestCompilableMulticlassDTW();
 void TestCompilableScalarSumNode();
 void TestCompilableSumNode();
+void TestCompilableReductionNodes();
+void TestCompilableTopKNode();
 void TestCompilableUnaryOperationNode();
 void TestL2NormSquaredNodeCompiled();
 void TestMatrixVectorProductNodeCompile();
@@ -54,20 +61,28 @@ void TestReceptiveFieldMatrixNode(size_t numChannels, bool useNewReshape);
 void TestCompilableAccumulatorNodeFunction();
 void TestCompilableSourceNode();
 void TestCompilableSinkNode();
+void TestCompilableAsyncSourceSinkNodes();
 template <typename ElementType>
 void TestCompilableDotProductNode2(int dimension);
 void TestFloatNode();
 void TestMultipleOutputNodes();
 void TestShapeFunctionGeneration();
 void TestCompilableClockNode();
+void TestCompilableClockNodeDropStaleTicks();
 void TestCompilableFFTNode();
+void TestCompilableDCTNode(size_t windowSize, size_t numFilters);
 
 //
 // mathy nodes
 //
 void TestMatrixVectorMultiplyNode(int m, int n, bool useBlas);
 void TestMatrixMatrixMultiplyNode(int m, int n, int k, bool useBlas);
+void TestBlockedMatrixMatrixMultiplyNode(int m, int n, int k, bool transposeA, bool transposeB, bool parallelize, bool prepackWeights);
+void TestSmallMatrixMultiplyNodes(bool transposeA, bool transposeB);
+void TestGpuMatrixMatrixMultiplyNode(bool transposeA, bool transposeB);
 void TestOrderedMatrixMatrixMultiplyNode(int m, int n, int k, bool transposeA, bool transposeB, bool transposeC, bool useBlas);
+void TestReducedPrecisionWeights(emitters::WeightStorageType storageType, bool transposeWeights, bool transposeOutput);
+void TestReducedPrecisionConvolutionWeights(emitters::WeightStorageType storageType, bool useFastMath);
 
 void TestBroadcasUnaryOperationNodeCompile();
 void TestBroadcasBinaryOperationNodeCompileAdd();
@@ -106,6 +121,7 @@ void TestScalingLayerNode(size_t inputPadding = 0, size_t outputPadding = 0);
 void TestSoftmaxLayerNode(size_t inputPadding = 0, size_t outputPadding = 0);
 void TestFusedLinearLayerNodes(size_t rows, size_t columns, size_t channels);
 void TestRegionDetectionNode();
+void TestRegionDetectionPostProcessingNode();
 
 #pragma region implementation
 
@@ -19,7 +19,9 @@
 #include <model/include/OutputNode.h>
 
 #include <nodes/include/LinearPredictorNode.h>
+#include <nodes/include/SparseLinearPredictorNode.h>
 
+#include <cmath>
 #include <string>
 
 using namespace ell;
@@ -44,11 +46,16 @@ void TestSlidingAverage();
 void TestDotProductOutput();
 template <typename ElementType>
 void TestLinearPredictor();
+
+template <typename ElementType>
+void TestSparseLinearPredictor();
 void TestForest();
 void TestForestMap();
 void TestNodeMetadata();
 
 void TestSimpleMap(bool optimize);
+void TestBatchPredictFunction();
+void TestMergedMapPredictFunctions();
 void TestSqEuclideanDistanceMap();
 void TestProtoNNPredictorMap();
 void TestCombineOutputMap();
@@ -56,7 +63,26 @@ void TestMultiOutputMap();
 void TestMultiSourceSinkMap();
 void TestCompiledMapMove();
 void TestCompiledMapClone();
+void TestJitCache();
+void TestJitCacheKeys();
+void TestMemoryPlanning();
+void TestMemoryAwareScheduling();
+void TestPortAliasing();
+void TestParallelOptimization();
+void TestParallelBranches();
+void TestEarlyExit();
+void TestCpuDispatch();
+void TestLargeBufferPlacement();
+void TestWeightPrefetching();
+void TestReentrantMap();
+void TestExternalWeightsMap();
+void TestFootprintReport();
+void TestTieredCompilation();
+void TestLazyCompilation();
+void TestDynamicInputExtent();
+void TestSharedNodeFunctions();
 void TestCompiledMapParallelClone();
+void TestPipelinedMap();
 
 #pragma region implementation
 
@@ -90,4 +116,53 @@ void TestLinearPredictor()
     VerifyCompiledOutput(map, compiledMap, signal, " map");
 }
 
+template <typename ElementType>
+void TestSparseLinearPredictor()
+{
+    // a dense predictor, applied to inputs with a few non-zero entries
+    const int dim = 1000;
+    const int numEntries = 4;
+    math::ColumnVector<ElementType> weights(dim);
+    weights.Generate([index = 0]() mutable { return static_cast<ElementType>(std::sin(0.1 * index++)); });
+    ElementType bias = 1.5f;
+
+    predictors::LinearPredictor<ElementType> predictor(weights, bias);
+
+    model::Model model;
+    auto indicesNode = model.AddNode<model::InputNode<int>>(numEntries);
+    auto valuesNode = model.AddNode<model::InputNode<ElementType>>(numEntries);
+    auto predictorNode = model.AddNode<nodes::SparseLinearPredictorNode<ElementType>>(indicesNode->output, valuesNode->output, predictor);
+    auto outputNode = model.AddNode<model::OutputNode<ElementType>>(predictorNode->output);
+
+    auto map = model::Map(model, { { "indices", indicesNode }, { "values", valuesNode } }, { { "output", outputNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.mapFunctionName = "TestSparseLinear";
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    // the last entry of the second input is padding
+    std::vector<std::vector<int>> indices{ { 3, 999, 0, 512 }, { 7, 7, 42, 0 } };
+    std::vector<std::vector<ElementType>> values{ { 1.0, -2.0, 0.5, 4.0 }, { 1.0, 2.0, -1.0, 0.0 } };
+    bool ok = true;
+    for (size_t index = 0; index < indices.size(); ++index)
+    {
+        ElementType expected = bias;
+        for (int entry = 0; entry < numEntries; ++entry)
+        {
+            expected += weights[indices[index][entry]] * values[index][entry];
+        }
+
+        map.SetInputValue("indices", indices[index]);
+        map.SetInputValue("values", values[index]);
+        auto computed = map.ComputeOutput<ElementType>("output");
+        compiledMap.SetInputValue("indices", indices[index]);
+        compiledMap.SetInputValue("values", values[index]);
+        auto compiled = compiledMap.ComputeOutput<ElementType>("output");
+        ok = ok && testing::IsEqual(computed[0], expected, static_cast<ElementType>(1.0e-5)) && testing::IsEqual(compiled[0], computed[0], static_cast<ElementType>(1.0e-5));
+    }
+    testing::ProcessTest("Testing compiled SparseLinearPredictorNode", ok);
+}
+
 #pragma endregion implementation
@@ -11,5 +11,7 @@ void TestMapCreate();
 void TestMapCompute();
 void TestMapComputeDataVector();
 void TestMapRefine();
+void TestMapRefineWithCache();
 void TestMapSerialization();
 void TestMapClockNode();
+void TestMergeMaps();
@@ -0,0 +1,17 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     MemoryPlanner_test.h (model_test)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+// High-level test
+void TestMemoryPlanner();
+
+// Lower-level tests (called by the above)
+void TestMemoryPlannerReusesFreedGaps();
+void TestMemoryPlannerAlignment();
+void TestMemoryPlannerPeakSize();
+void TestMemoryPlannerBadArguments();
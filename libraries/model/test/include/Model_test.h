@@ -12,6 +12,10 @@ void TestNodeIterator();
 void TestReverseNodeIterator();
 
 void TestModelSerialization();
+void TestLargeModelSerialization();
+void TestModelAdjacency();
+void TestRepeatedModelCompute();
+void TestParallelModelCompute();
 void TestModelMetadata();
 
 void TestInputRouting();
@@ -37,6 +37,7 @@
 #include <nodes/include/BinaryOperationNode.h>
 #include <nodes/include/BinaryPredicateNode.h>
 #include <nodes/include/BroadcastOperationNodes.h>
+#include <nodes/include/BufferNode.h>
 #include <nodes/include/ClockNode.h>
 #include <nodes/include/ConcatenationNode.h>
 #include <nodes/include/ConstantNode.h>
@@ -44,6 +45,7 @@
 #include <nodes/include/DelayNode.h>
 #include <nodes/include/DotProductNode.h>
 #include <nodes/include/ExtremalValueNode.h>
+#include <nodes/include/DCTNode.h>
 #include <nodes/include/FFTNode.h>
 #include <nodes/include/FullyConnectedLayerNode.h>
 #include <nodes/include/IRNode.h>
@@ -51,18 +53,23 @@
 #include <nodes/include/MatrixMatrixMultiplyNode.h>
 #include <nodes/include/MatrixVectorMultiplyNode.h>
 #include <nodes/include/MatrixVectorProductNode.h>
+#include <nodes/include/MovingAverageNode.h>
+#include <nodes/include/MovingVarianceNode.h>
 #include <nodes/include/MultiplexerNode.h>
 #include <nodes/include/NeuralNetworkPredictorNode.h>
 #include <nodes/include/NodeOperations.h>
 #include <nodes/include/PoolingLayerNode.h>
 #include <nodes/include/ReceptiveFieldMatrixNode.h>
 #include <nodes/include/RegionDetectionLayerNode.h>
+#include <nodes/include/RegionDetectionPostProcessingNode.h>
 #include <nodes/include/ReinterpretLayoutNode.h>
 #include <nodes/include/ReorderDataNode.h>
+#include <nodes/include/SimpleConvolutionNode.h>
 #include <nodes/include/SinkNode.h>
 #include <nodes/include/SoftmaxLayerNode.h>
 #include <nodes/include/SourceNode.h>
 #include <nodes/include/SumNode.h>
+#include <nodes/include/TopKNode.h>
 #include <nodes/include/TypeCastNode.h>
 #include <nodes/include/UnaryOperationNode.h>
 
@@ -92,11 +99,14 @@
 #include <utilities/include/RandomEngines.h>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <ostream>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 // set to 1 to print models
 #define PRINT_MODELS 0
@@ -243,6 +253,130 @@ void TestCompilableDelayNode()
     });
 }
 
+void TestCompilableMovingAverageNode()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto averageNode = model.AddNode<MovingAverageNode<double>>(inputNode->output, 4);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", averageNode->output } });
+
+    std::string name = "MovingAverageNode";
+    TestWithSerialization(map, name, [&](model::Map& map, int iteration) {
+        model::IRMapCompiler compiler;
+        auto compiledMap = compiler.Compile(map);
+
+        // compare output
+        std::vector<std::vector<double>> signal = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 3, 4, 5 }, { 2, 3, 2 }, { 1, 5, 3 }, { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 7, 4, 2 }, { 5, 2, 1 } };
+        VerifyCompiledOutput(map, compiledMap, signal, utilities::FormatString("%s iteration %d", name.c_str(), iteration));
+    });
+}
+
+void TestCompilableMovingVarianceNode()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto varianceNode = model.AddNode<MovingVarianceNode<double>>(inputNode->output, 4);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", varianceNode->output } });
+
+    std::string name = "MovingVarianceNode";
+    TestWithSerialization(map, name, [&](model::Map& map, int iteration) {
+        model::IRMapCompiler compiler;
+        auto compiledMap = compiler.Compile(map);
+
+        // compare output
+        std::vector<std::vector<double>> signal = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 3, 4, 5 }, { 2, 3, 2 }, { 1, 5, 3 }, { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 7, 4, 2 }, { 5, 2, 1 } };
+        VerifyCompiledOutput(map, compiledMap, signal, utilities::FormatString("%s iteration %d", name.c_str(), iteration));
+    });
+}
+
+void TestCompilableMovingStatisticsLongStream()
+{
+    // A long stream of values with a large mean and small variance, where rounding errors in running statistics
+    // would build up
+    const int dimension = 2;
+    const int windowSize = 16;
+    const int numSamples = 20000;
+    std::vector<std::vector<float>> signal;
+    auto engine = utilities::GetRandomEngine("123");
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    for (int index = 0; index < numSamples; ++index)
+    {
+        signal.push_back({ 1000.0f + uniform(engine), 10.0f + 0.01f * uniform(engine) });
+    }
+
+    // The statistics of the last window, computed directly in double precision
+    std::vector<double> expectedMean(dimension);
+    std::vector<double> expectedVariance(dimension);
+    for (int i = 0; i < dimension; ++i)
+    {
+        for (int index = numSamples - windowSize; index < numSamples; ++index)
+        {
+            expectedMean[i] += signal[index][i] / static_cast<double>(windowSize);
+        }
+        for (int index = numSamples - windowSize; index < numSamples; ++index)
+        {
+            auto deviation = signal[index][i] - expectedMean[i];
+            expectedVariance[i] += deviation * deviation / windowSize;
+        }
+    }
+
+    auto testNode = [&](const std::string& name, const std::vector<double>& expected, double epsilon, std::function<const model::OutputPort<float>&(const model::OutputPort<float>&)> addNode) {
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<float>>(dimension);
+        const auto& output = addNode(inputNode->output);
+        auto map = model::Map(model, { { "input", inputNode } }, { { "output", output } });
+        model::IRMapCompiler compiler;
+        auto compiledMap = compiler.Compile(map);
+
+        auto computed = VerifyCompiledOutput<float, float>(map, compiledMap, signal, name, " on a long stream", 1e-3);
+        bool ok = true;
+        for (int i = 0; i < dimension; ++i)
+        {
+            ok = ok && std::abs(computed[i] - expected[i]) <= epsilon;
+        }
+        testing::ProcessTest("Testing " + name + " has no drift on a long stream", ok);
+    };
+
+    testNode("MovingAverageNode", expectedMean, 1e-3, [](const model::OutputPort<float>& input) -> const model::OutputPort<float>& { return MovingAverage(input, windowSize); });
+    testNode("MovingVarianceNode", expectedVariance, 1e-3, [](const model::OutputPort<float>& input) -> const model::OutputPort<float>& { return MovingVariance(input, windowSize); });
+}
+
+void TestCompilableStatefulNodesReset()
+{
+    std::vector<std::vector<double>> signal = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 3, 4, 5 }, { 2, 3, 2 }, { 1, 5, 3 }, { 1, 2, 3 } };
+    std::vector<std::vector<double>> signalAfterReset = { { 4, 5, 6 }, { 7, 8, 9 }, { 7, 4, 2 }, { 5, 2, 1 }, { 9, 1, 4 } };
+    auto testNode = [&](const std::string& name, std::function<const model::OutputPort<double>&(const model::OutputPort<double>&)> addNode) {
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<double>>(3);
+        const auto& output = addNode(inputNode->output);
+        auto map = model::Map(model, { { "input", inputNode } }, { { "output", output } });
+
+        for (bool reentrant : { false, true })
+        {
+            model::MapCompilerOptions settings;
+            settings.reentrant = reentrant;
+            model::ModelOptimizerOptions optimizerOptions;
+            model::IRMapCompiler compiler(settings, optimizerOptions);
+            auto compiledMap = compiler.Compile(map);
+            map.Reset();
+
+            // The compiled state must be cleared the same way as the reference model's, so the output after a reset
+            // doesn't depend on the samples seen before it
+            auto message = reentrant ? " (reentrant)" : "";
+            VerifyCompiledOutput<double, double>(map, compiledMap, signal, name, std::string(" before reset") + message);
+            map.Reset();
+            compiledMap.Reset();
+            VerifyCompiledOutput<double, double>(map, compiledMap, signalAfterReset, name, std::string(" after reset") + message);
+        }
+    };
+
+    testNode("BufferNode", [](const model::OutputPort<double>& input) -> const model::OutputPort<double>& { return input.GetNode()->GetModel()->AddNode<BufferNode<double>>(input, 7)->output; });
+    testNode("DelayNode", [](const model::OutputPort<double>& input) -> const model::OutputPort<double>& { return Delay(input, 3); });
+    testNode("MovingAverageNode", [](const model::OutputPort<double>& input) -> const model::OutputPort<double>& { return MovingAverage(input, 4); });
+    testNode("MovingVarianceNode", [](const model::OutputPort<double>& input) -> const model::OutputPort<double>& { return MovingVariance(input, 4); });
+    testNode("AccumulatorNode", [](const model::OutputPort<double>& input) -> const model::OutputPort<double>& { return Accumulate(input); });
+}
+
 void TestCompilableDTWDistanceNode()
 {
     model::Model model;
@@ -263,6 +397,47 @@ void TestCompilableDTWDistanceNode()
     });
 }
 
+void TestCompilableMultiPrototypeDTWDistanceNode()
+{
+    std::vector<std::vector<double>> prototype1 = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+    std::vector<std::vector<double>> prototype2 = { { 9, 8, 7 }, { 6, 5, 4 }, { 3, 2, 1 }, { 2, 2, 2 }, { 1, 0, 1 } };
+    std::vector<std::vector<double>> signal = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 3, 4, 5 }, { 2, 3, 2 }, { 1, 5, 3 }, { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 7, 4, 2 }, { 5, 2, 1 } };
+
+    // The distances from a node with both prototypes should match those from a node for each one
+    model::Model referenceModel;
+    auto referenceInputNode = referenceModel.AddNode<model::InputNode<double>>(3);
+    auto dtwNode1 = referenceModel.AddNode<DTWDistanceNode<double>>(referenceInputNode->output, prototype1);
+    auto dtwNode2 = referenceModel.AddNode<DTWDistanceNode<double>>(referenceInputNode->output, prototype2);
+    auto referenceOutputNode = referenceModel.AddNode<model::SpliceNode<double>>(std::vector<const model::OutputPortBase*>{ &dtwNode1->output, &dtwNode2->output });
+    auto referenceMap = model::Map(referenceModel, { { "input", referenceInputNode } }, { { "output", referenceOutputNode->output } });
+    std::vector<std::vector<double>> expected;
+    for (const auto& sample : signal)
+    {
+        referenceMap.SetInputValue(0, sample);
+        expected.push_back(referenceMap.ComputeOutput<double>(0));
+    }
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto dtwNode = model.AddNode<DTWDistanceNode<double>>(inputNode->output, std::vector<std::vector<std::vector<double>>>{ prototype1, prototype2 });
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", dtwNode->output } });
+
+    for (bool vectorize : { false, true })
+    {
+        std::string name = vectorize ? "MultiPrototypeDTWDistanceNode_Vector" : "MultiPrototypeDTWDistanceNode";
+        TestWithSerialization(map, name, [&](model::Map& map, int iteration) {
+            model::MapCompilerOptions settings;
+            settings.compilerSettings.allowVectorInstructions = vectorize;
+            model::ModelOptimizerOptions optimizerOptions;
+            model::IRMapCompiler compiler(settings, optimizerOptions);
+            auto compiledMap = compiler.Compile(map);
+
+            // compare output
+            VerifyCompiledOutputAndResult(map, compiledMap, signal, expected, utilities::FormatString("%s iteration %d", name.c_str(), iteration));
+        });
+    }
+}
+
 class LabeledPrototype
 {
 public:
@@ -375,6 +550,88 @@ void TestCompilableSumNode()
     });
 }
 
+void TestCompilableReductionNodes()
+{
+    // 19 entries: several whole vectors and blocks, plus a remainder. The largest value appears 3 times, and the
+    // smallest twice, in different vector lanes.
+    std::vector<std::vector<double>> signal = {
+        { 3, 1, 4, 9, 5, 9, 2, 6, 5, 3, 5, 8, 9, 7, 9, 3, 2, 3, 8 },
+        { 0.5, -2, 7, 1.25, 3, 8, -2, 6, 4, 2, 1, 8, 0, -1, 5, 3, 8, 4, 2 },
+        { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 }
+    };
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(signal[0].size());
+    auto sumNode = model.AddNode<SumNode<double>>(inputNode->output);
+    auto argMaxNode = model.AddNode<ArgMaxNode<double>>(inputNode->output);
+    auto argMinNode = model.AddNode<ArgMinNode<double>>(inputNode->output);
+    auto sumMap = model::Map(model, { { "input", inputNode } }, { { "output", sumNode->output } });
+    auto argMaxMap = model::Map(model, { { "input", inputNode } }, { { "output", argMaxNode->argVal } });
+    auto argMinMap = model::Map(model, { { "input", inputNode } }, { { "output", argMinNode->argVal } });
+
+    for (bool vectorize : { false, true })
+    {
+        for (bool fastMath : { false, true })
+        {
+            model::MapCompilerOptions settings;
+            settings.compilerSettings.allowVectorInstructions = vectorize;
+            settings.compilerSettings.useFastMath = fastMath;
+            model::ModelOptimizerOptions optimizerOptions;
+            auto suffix = std::string(vectorize ? "_Vector" : "") + (fastMath ? "_FastMath" : "");
+
+            model::IRMapCompiler sumCompiler(settings, optimizerOptions);
+            auto compiledSumMap = sumCompiler.Compile(sumMap);
+            VerifyCompiledOutput(sumMap, compiledSumMap, signal, "SumNode" + suffix);
+
+            model::IRMapCompiler argMaxCompiler(settings, optimizerOptions);
+            auto compiledArgMaxMap = argMaxCompiler.Compile(argMaxMap);
+            VerifyCompiledOutputAndResult(argMaxMap, compiledArgMaxMap, signal, std::vector<std::vector<int>>{ { 3 }, { 5 }, { 18 } }, "ArgMaxNode" + suffix);
+
+            model::IRMapCompiler argMinCompiler(settings, optimizerOptions);
+            auto compiledArgMinMap = argMinCompiler.Compile(argMinMap);
+            VerifyCompiledOutputAndResult(argMinMap, compiledArgMinMap, signal, std::vector<std::vector<int>>{ { 1 }, { 1 }, { 0 } }, "ArgMinNode" + suffix);
+        }
+    }
+}
+
+void TestCompilableTopKNode()
+{
+    // Ties keep the order of their indices, and some vectors of entries have none larger than the k-th largest so far
+    std::vector<std::vector<double>> signal = {
+        { 3, 1, 4, 9, 5, 9, 2, 6, 5, 3, 5, 8, 9, 7, 9, 3, 2, 3, 8 },
+        { 0.5, -2, 7, 1.25, 3, 8, -2, 6, 4, 2, 1, 8, 0, -1, 5, 3, 8, 4, 2 },
+        { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 }
+    };
+    const size_t k = 5;
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(signal[0].size());
+    auto topKNode = model.AddNode<TopKNode<double>>(inputNode->output, k);
+    auto softmaxTopKNode = model.AddNode<TopKNode<double>>(inputNode->output, k, true);
+    auto valuesMap = model::Map(model, { { "input", inputNode } }, { { "output", topKNode->values } });
+    auto indicesMap = model::Map(model, { { "input", inputNode } }, { { "output", topKNode->indices } });
+    auto probabilitiesMap = model::Map(model, { { "input", inputNode } }, { { "output", softmaxTopKNode->values } });
+    std::vector<std::vector<int>> expectedIndices = { { 3, 5, 12, 14, 11 }, { 5, 11, 16, 2, 7 }, { 18, 17, 16, 15, 14 } };
+
+    for (bool vectorize : { false, true })
+    {
+        model::MapCompilerOptions settings;
+        settings.compilerSettings.allowVectorInstructions = vectorize;
+        model::ModelOptimizerOptions optimizerOptions;
+        auto suffix = std::string(vectorize ? "_Vector" : "");
+
+        model::IRMapCompiler valuesCompiler(settings, optimizerOptions);
+        auto compiledValuesMap = valuesCompiler.Compile(valuesMap);
+        VerifyCompiledOutput(valuesMap, compiledValuesMap, signal, "TopKNode values" + suffix);
+
+        model::IRMapCompiler indicesCompiler(settings, optimizerOptions);
+        auto compiledIndicesMap = indicesCompiler.Compile(indicesMap);
+        VerifyCompiledOutputAndResult(indicesMap, compiledIndicesMap, signal, expectedIndices, "TopKNode indices" + suffix);
+
+        model::IRMapCompiler probabilitiesCompiler(settings, optimizerOptions);
+        auto compiledProbabilitiesMap = probabilitiesCompiler.Compile(probabilitiesMap);
+        VerifyCompiledOutput(probabilitiesMap, compiledProbabilitiesMap, signal, "TopKNode softmax probabilities" + suffix);
+    }
+}
+
 std::vector<std::vector<double>> GetExpectedUnaryOperationOutput(std::vector<std::vector<double>> signal, UnaryOperationType op)
 {
     SigmoidActivationFunction<double> sigmoid;
@@ -1373,6 +1630,79 @@ void TestCompilableSinkNode()
     TestCompilableSinkNode(100, false);
 }
 
+struct AsyncCallbackContext
+{
+    std::thread::id modelThread;
+    std::atomic<int> sourceCount{ 0 };
+    std::atomic<bool> sourceRanOnModelThread{ false };
+    std::vector<double> sinkValues;
+};
+
+// C callbacks (called by emitted code)
+extern "C" {
+bool TestAsyncCallbacks_SourceCallback(void* context, double* input)
+{
+    auto c = static_cast<AsyncCallbackContext*>(context);
+    if (std::this_thread::get_id() == c->modelThread && c->sourceCount > 0)
+    {
+        c->sourceRanOnModelThread = true;
+    }
+    input[0] = c->sourceCount++;
+    return true;
+}
+TESTING_FORCE_DEFINE_SYMBOL(TestAsyncCallbacks_SourceCallback, bool, void*, double*);
+
+void TestAsyncCallbacks_SinkCallback(void* context, double* output)
+{
+    auto c = static_cast<AsyncCallbackContext*>(context);
+    c->sinkValues.push_back(output[0]);
+}
+TESTING_FORCE_DEFINE_SYMBOL(TestAsyncCallbacks_SinkCallback, void, void*, double*);
+}
+
+void TestCompilableAsyncSourceSinkNodes()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<TimeTickType>>(2);
+    auto sourceNode = model.AddNode<SourceNode<double>>(inputNode->output, 1, "SourceCallback");
+    auto condition = model.AddNode<ConstantNode<bool>>(true);
+    auto sinkNode = model.AddNode<SinkNode<double>>(sourceNode->output, condition->output, "SinkCallback");
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", sinkNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.moduleName = "TestAsyncCallbacks";
+    settings.compilerSettings.parallelize = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions.SetEntry("asyncCallbacks", true);
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    const bool isAsync = !settings.compilerSettings.targetDevice.IsWindows();
+
+    AsyncCallbackContext context;
+    context.modelThread = std::this_thread::get_id();
+    compiledMap.SetContext(&context);
+
+    // Each call returns the sample fetched during the call before it (the first call fetches its own), and the
+    // source callback fetches the next one on another thread
+    const int numCalls = 20;
+    std::vector<double> outputs;
+    for (int index = 0; index < numCalls; ++index)
+    {
+        compiledMap.SetInputValue(0, std::vector<TimeTickType>{ static_cast<TimeTickType>(index), static_cast<TimeTickType>(index) });
+        outputs.push_back(compiledMap.ComputeOutput<double>(0)[0]);
+    }
+
+    // Resetting the model waits for the background callbacks
+    compiledMap.Reset();
+
+    std::vector<double> expectedOutputs(numCalls);
+    std::iota(expectedOutputs.begin(), expectedOutputs.end(), 0.0);
+    testing::ProcessTest("Testing async source callbacks return the samples in order", testing::IsEqual(outputs, expectedOutputs));
+    testing::ProcessTest("Testing async source callbacks prefetch one sample", context.sourceCount == (isAsync ? numCalls + 1 : numCalls));
+    testing::ProcessTest("Testing async source callbacks run on another thread", !isAsync || !context.sourceRanOnModelThread);
+    testing::ProcessTest("Testing async sink callbacks are all done after reset", testing::IsEqual(context.sinkValues, expectedOutputs));
+}
+
 void TestFloatNode()
 {
     model::Model model;
@@ -1522,6 +1852,111 @@ void TestMatrixMatrixMultiplyNode(int m, int n, int k, bool useBlas)
     });
 }
 
+void TestBlockedMatrixMatrixMultiplyNode(int m, int n, int k, bool transposeA, bool transposeB, bool parallelize, bool prepackWeights)
+{
+    using ValueType = float;
+    std::vector<ValueType> matrixBVals(k * n);
+    FillVector(matrixBVals);
+
+    model::Model model;
+    auto inputMatrixNode = model.AddNode<model::InputNode<ValueType>>(m * k);
+    auto matrixBNode = model.AddNode<ConstantNode<ValueType>>(matrixBVals);
+    int lda = transposeA ? m : k;
+    int ldb = transposeB ? k : n;
+    auto matMatMultNode = model.AddNode<MatrixMatrixMultiplyNode<ValueType>>(inputMatrixNode->output, m, n, k, lda, transposeA, matrixBNode->output, ldb, transposeB, n, false);
+    auto map = model::Map(model, { { "inputMatrix", inputMatrixNode } }, { { "output", matMatMultNode->output } });
+
+    std::vector<ValueType> matrixAVals(m * k);
+    FillVector(matrixAVals);
+    std::vector<std::vector<ValueType>> signal = { matrixAVals };
+
+    // Tiny caches, so the product is split into several blocks in each dimension, with partial register tiles at the edges
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.useBlas = false;
+    settings.compilerSettings.useBlockedGemm = true;
+    settings.compilerSettings.parallelize = parallelize;
+    settings.compilerSettings.maxThreads = 4;
+    settings.compilerSettings.targetDevice.l1CacheSize = 512;
+    settings.compilerSettings.targetDevice.l2CacheSize = 4096;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["prepackWeights"] = prepackWeights;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    std::stringstream id;
+    id << std::boolalpha << "BlockedMatrixMatrixMultiplyNode(m = " << m << ", n = " << n << ", k = " << k << ", transposeA = " << transposeA << ", transposeB = " << transposeB << ", parallelize = " << parallelize << ", prepackWeights = " << prepackWeights << ")";
+    VerifyCompiledOutput(map, compiledMap, signal, id.str());
+}
+
+void TestSmallMatrixMultiplyNodes(bool transposeA, bool transposeB)
+{
+    using ValueType = float;
+    const int m = 8, n = 16, k = 4;
+    std::vector<ValueType> matrixBVals(k * n);
+    FillVector(matrixBVals);
+
+    // A small GEMM with constant weights, followed by a small GEMV
+    model::Model model;
+    auto inputMatrixNode = model.AddNode<model::InputNode<ValueType>>(m * k);
+    auto matrixBNode = model.AddNode<ConstantNode<ValueType>>(matrixBVals);
+    int lda = transposeA ? m : k;
+    int ldb = transposeB ? k : n;
+    auto matMatMultNode = model.AddNode<MatrixMatrixMultiplyNode<ValueType>>(inputMatrixNode->output, m, n, k, lda, transposeA, matrixBNode->output, ldb, transposeB, n, false);
+    std::vector<ValueType> vectorVals(n);
+    FillVector(vectorVals);
+    auto vectorNode = model.AddNode<ConstantNode<ValueType>>(vectorVals);
+    auto matVecMultNode = model.AddNode<MatrixVectorMultiplyNode<ValueType>>(matMatMultNode->output, m, n, n, vectorNode->output);
+    auto map = model::Map(model, { { "inputMatrix", inputMatrixNode } }, { { "output", matVecMultNode->output } });
+
+    std::vector<ValueType> matrixAVals(m * k);
+    FillVector(matrixAVals);
+    std::vector<std::vector<ValueType>> signal = { matrixAVals };
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.useBlas = true;
+    settings.compilerSettings.smallGemmThreshold = m * n * k;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    std::stringstream id;
+    id << std::boolalpha << "SmallMatrixMultiplyNodes(transposeA = " << transposeA << ", transposeB = " << transposeB << ")";
+    VerifyCompiledOutput(map, compiledMap, signal, id.str());
+}
+
+void TestGpuMatrixMatrixMultiplyNode(bool transposeA, bool transposeB)
+{
+    using ValueType = float;
+    const int m = 40, n = 24, k = 17;
+    std::vector<ValueType> matrixBVals(k * n);
+    FillVector(matrixBVals);
+
+    model::Model model;
+    auto inputMatrixNode = model.AddNode<model::InputNode<ValueType>>(m * k);
+    auto matrixBNode = model.AddNode<ConstantNode<ValueType>>(matrixBVals);
+    int lda = transposeA ? m : k;
+    int ldb = transposeB ? k : n;
+    auto matMatMultNode = model.AddNode<MatrixMatrixMultiplyNode<ValueType>>(inputMatrixNode->output, m, n, k, lda, transposeA, matrixBNode->output, ldb, transposeB, n, false);
+    auto map = model::Map(model, { { "inputMatrix", inputMatrixNode } }, { { "output", matMatMultNode->output } });
+
+    std::vector<ValueType> matrixAVals(m * k);
+    FillVector(matrixAVals);
+    std::vector<std::vector<ValueType>> signal = { matrixAVals, matrixAVals };
+
+    // The runtime runs the product on the CPU if there's no GPU
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.useGpu = true;
+    settings.compilerSettings.gpuMinOperations = 1;
+    settings.compilerSettings.smallGemmThreshold = 0;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    std::stringstream id;
+    id << std::boolalpha << "GpuMatrixMatrixMultiplyNode(transposeA = " << transposeA << ", transposeB = " << transposeB << ")";
+    VerifyCompiledOutput(map, compiledMap, signal, id.str());
+}
+
 void TestOrderedMatrixMatrixMultiplyNode(int m, int n, int k, bool transposeA, bool transposeB, bool transposeC, bool useBlas)
 {
     using ValueType = float;
@@ -1564,6 +1999,91 @@ void TestOrderedMatrixMatrixMultiplyNode(int m, int n, int k, bool transposeA, b
     });
 }
 
+void TestReducedPrecisionWeights(emitters::WeightStorageType storageType, bool transposeWeights, bool transposeOutput)
+{
+    using ValueType = float;
+    const int m = 4;
+    const int n = 5;
+    const int k = 6;
+
+    // The weights are all exactly representable in both 16-bit formats, so the compiled result should match exactly
+    std::vector<ValueType> weightValues(k * n);
+    FillVector(weightValues, -1.5f, 0.25f);
+
+    model::Model model;
+    auto inputMatrixNode = model.AddNode<model::InputNode<ValueType>>(m * k);
+    auto weightsNode = model.AddNode<ConstantNode<ValueType>>(weightValues);
+    const int ldb = transposeWeights ? k : n;
+    const int ldc = transposeOutput ? m : n;
+    auto matMatMultNode = model.AddNode<MatrixMatrixMultiplyNode<ValueType>>(inputMatrixNode->output, m, n, k, k, false, weightsNode->output, ldb, transposeWeights, ldc, transposeOutput);
+
+    const auto& layout = matMatMultNode->output.GetMemoryLayout();
+    std::vector<ValueType> scaleValues(layout.GetActiveSize(0));
+    FillVector(scaleValues, 0.5f, 0.5f);
+    std::vector<ValueType> biasValues(layout.GetActiveSize(0));
+    FillVector(biasValues, -2.0f, 1.0f);
+    auto scaleNode = model.AddNode<ConstantNode<ValueType>>(scaleValues);
+    auto biasNode = model.AddNode<ConstantNode<ValueType>>(biasValues);
+    auto linearNode = model.AddNode<BroadcastLinearFunctionNode<ValueType>>(matMatMultNode->output, layout, scaleNode->output, biasNode->output, 0, layout);
+
+    auto map = model::Map(model, { { "inputMatrix", inputMatrixNode } }, { { "output", linearNode->output } });
+
+    std::vector<ValueType> matrixAVals(m * k);
+    FillVector(matrixAVals);
+    std::vector<std::vector<ValueType>> signal = { matrixAVals };
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.weightStorageType = storageType;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    std::stringstream id;
+    id << std::boolalpha << "ReducedPrecisionWeights(storageType = " << emitters::ToString(storageType) << ", transposeWeights = " << transposeWeights << ", transposeOutput = " << transposeOutput << ")";
+    VerifyCompiledOutput(map, compiledMap, signal, id.str());
+}
+
+void TestReducedPrecisionConvolutionWeights(emitters::WeightStorageType storageType, bool useFastMath)
+{
+    using ValueType = float;
+    const int rows = 6;
+    const int columns = 5;
+    const int numChannels = 8;
+    const int numFilters = 3;
+    const int filterSize = 3;
+    const int stride = 1;
+
+    // The filter weights are exactly representable in both 16-bit formats, and every partial sum is exact in
+    // float, so the vectorized WeightsDotProduct must match the reference in any summation order
+    std::vector<ValueType> filterValues(numFilters * filterSize * filterSize * numChannels);
+    FillVector(filterValues, -4.0f, 0.0625f);
+    math::ChannelColumnRowTensor<ValueType> filterWeights(numFilters * filterSize, filterSize, numChannels, filterValues);
+
+    model::PortMemoryLayout inputLayout(model::MemoryShape{ rows, columns, numChannels }, model::MemoryShape{ rows + 2, columns + 2, numChannels }, model::MemoryShape{ 1, 1, 0 });
+    model::PortMemoryLayout outputLayout(model::MemoryShape{ rows, columns, numFilters });
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(inputLayout.GetMemorySize());
+    auto convolutionNode = model.AddNode<SimpleConvolutionNode<ValueType>>(inputNode->output, inputLayout, outputLayout, filterWeights, stride);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", convolutionNode->output } });
+
+    std::vector<ValueType> inputValues(inputLayout.GetMemorySize());
+    FillVector(inputValues, -1.0f, 0.015625f);
+    std::vector<std::vector<ValueType>> signal = { inputValues };
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.weightStorageType = storageType;
+    settings.compilerSettings.useFastMath = useFastMath;
+    settings.compilerSettings.allowVectorInstructions = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    std::stringstream id;
+    id << std::boolalpha << "ReducedPrecisionConvolutionWeights(storageType = " << emitters::ToString(storageType) << ", useFastMath = " << useFastMath << ")";
+    VerifyCompiledOutput(map, compiledMap, signal, id.str());
+}
+
 // C callback (called by emitted code)
 static int lagNotificationCallbackCount = 0;
 extern "C" {
@@ -1640,6 +2160,53 @@ void TestCompilableClockNode()
     }
     testing::ProcessTest("Testing compiled GetTicksUntilNextInterval", testing::IsEqual(getTicksResults, expectedGetTicksResults));
     testing::ProcessTest("Testing lag notification count", testing::IsEqual(lagNotificationCallbackCount, 2));
+
+    // Lateness in intervals: 1.25, 0, 2.5, 50, 0
+    using GetCount = int64_t();
+    auto getMissedDeadlineCount = reinterpret_cast<GetCount*>(jitter.ResolveFunctionAddress("Test_GetMissedDeadlineCount"));
+    auto getDroppedTickCount = reinterpret_cast<GetCount*>(jitter.ResolveFunctionAddress("Test_GetDroppedTickCount"));
+    auto getLastSlack = reinterpret_cast<GetStepInterval*>(jitter.ResolveFunctionAddress("Test_GetLastSlack"));
+    auto getLatenessHistogram = reinterpret_cast<void (*)(int64_t*)>(jitter.ResolveFunctionAddress("Test_GetLatenessHistogram"));
+    auto resetDeadlineTelemetry = reinterpret_cast<void (*)()>(jitter.ResolveFunctionAddress("Test_ResetDeadlineTelemetry"));
+    std::vector<int64_t> histogram(ClockDeadlineTelemetry::numLatenessBuckets);
+    getLatenessHistogram(histogram.data());
+    testing::ProcessTest("Testing compiled deadline telemetry", testing::IsEqual(getMissedDeadlineCount(), int64_t{ 3 }) && testing::IsEqual(getDroppedTickCount(), int64_t{ 0 }) && testing::IsEqual(getLastSlack(), interval, 1.0e-3) && testing::IsEqual(histogram, std::vector<int64_t>{ 2, 0, 0, 1, 1, 1 }));
+
+    resetDeadlineTelemetry();
+    getLatenessHistogram(histogram.data());
+    testing::ProcessTest("Testing compiled deadline telemetry reset", testing::IsEqual(getMissedDeadlineCount(), int64_t{ 0 }) && testing::IsEqual(histogram, std::vector<int64_t>(ClockDeadlineTelemetry::numLatenessBuckets, 0)));
+}
+
+void TestCompilableClockNodeDropStaleTicks()
+{
+    constexpr TimeTickType interval = 50;
+    constexpr TimeTickType start = 1511889201834.5767;
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<TimeTickType>>(1);
+    auto clockNode = model.AddNode<ClockNode>(inputNode->output, interval, interval, "ClockNode_LagNotificationCallback", nullptr, true);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", clockNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.moduleName = "Test";
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    std::vector<std::vector<TimeTickType>> signal =
+        {
+            { start },
+            { start + interval * 1 }, // on time
+            { start + interval * 4 + 10 }, // two intervals behind (expect them to be dropped)
+            { start + interval * 5 } // on time
+        };
+    for (const auto& input : signal)
+    {
+        VerifyCompiledOutput(map, compiledMap, std::vector<std::vector<TimeTickType>>{ input }, "ClockNode with dropped stale ticks");
+    }
+
+    auto getDroppedTickCount = reinterpret_cast<int64_t (*)()>(compiledMap.GetJitter().ResolveFunctionAddress("Test_GetDroppedTickCount"));
+    testing::ProcessTest("Testing compiled dropped tick count", testing::IsEqual(getDroppedTickCount(), int64_t{ 2 }));
 }
 
 void TestCompilableFFTNode()
@@ -1675,6 +2242,38 @@ void TestCompilableFFTNode()
     });
 }
 
+void TestCompilableDCTNode(size_t windowSize, size_t numFilters)
+{
+    using ValueType = float;
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(windowSize);
+    auto dctNode = model.AddNode<DCTNode<ValueType>>(inputNode->output, numFilters);
+
+    std::vector<std::vector<ValueType>> signal;
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        std::vector<ValueType> input(windowSize);
+        for (size_t index = 0; index < windowSize; ++index)
+        {
+            input[index] = std::sin(0.1f * (frame + 1) * index) + 0.01f * index;
+        }
+        signal.push_back(input);
+    }
+
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", dctNode->output } });
+
+    std::string name = utilities::FormatString("DCTNode %d -> %d", static_cast<int>(windowSize), static_cast<int>(numFilters));
+    TestWithSerialization(map, name, [&](model::Map& map, int iteration) {
+        model::MapCompilerOptions settings;
+        model::ModelOptimizerOptions optimizerOptions;
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        auto compiledMap = compiler.Compile(map);
+
+        // compare output
+        VerifyCompiledOutput(map, compiledMap, signal, utilities::FormatString("%s iteration %d", name.c_str(), iteration));
+    });
+}
+
 class BinaryFunctionIRNode : public IRNode
 {
 public:
@@ -3392,6 +3991,69 @@ void TestRegionDetectionNode()
     }
 }
 
+void TestRegionDetectionPostProcessingNode()
+{
+    using ElementType = double;
+    const int numRows = 3;
+    const int numColumns = 3;
+    const int numBoxesPerCell = 2;
+    const int numClasses = 3;
+    const int numAnchors = 4;
+    const int boxStride = numAnchors + 1 + numClasses;
+    const int numChannels = numBoxesPerCell * boxStride;
+
+    // Every box starts out with a confidence too low to be detected
+    std::vector<ElementType> input(numRows * numColumns * numChannels, 0);
+    auto setBox = [&](int row, int column, int box, ElementType tw, ElementType th, ElementType confidence, int classIndex) {
+        auto offset = (row * numColumns + column) * numChannels + box * boxStride;
+        input[offset + 2] = tw;
+        input[offset + 3] = th;
+        input[offset + 4] = confidence;
+        input[offset + numAnchors + 1 + classIndex] = 5;
+    };
+    for (int cell = 0; cell < numRows * numColumns; ++cell)
+    {
+        for (int box = 0; box < numBoxesPerCell; ++box)
+        {
+            input[cell * numChannels + box * boxStride + numAnchors] = -5;
+        }
+    }
+    setBox(2, 2, 1, std::log(0.5), std::log(0.5), 4, 0);
+    setBox(1, 1, 0, 0, 0, 3, 1);
+    setBox(1, 1, 1, std::log(0.5), std::log(0.5), 2, 1); // Same box as the previous one, with a lower score
+    setBox(0, 0, 0, 0, 0, 1, 2);
+
+    RegionDetectionParameters detectionParams{ numRows, numColumns, numBoxesPerCell, numClasses, numAnchors, true };
+    RegionDetectionPostProcessingParameters postProcessingParams;
+    postProcessingParams.anchorScales = { 1, 1, 2, 2 };
+    postProcessingParams.maxBoxes = 4;
+    postProcessingParams.maxCandidates = 8;
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(input.size());
+    auto computeNode = model.AddNode<RegionDetectionPostProcessingNode<ElementType>>(inputNode->output, model::PortMemoryLayout({ numRows, numColumns, numChannels }), detectionParams, postProcessingParams);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", computeNode->output } });
+
+    // The duplicate box is suppressed, and the remaining boxes are in order of their score
+    map.SetInputValue(0, input);
+    auto output = map.ComputeOutput<ElementType>(0);
+    std::vector<ElementType> classes;
+    for (size_t index = 5; index < output.size(); index += RegionDetectionPostProcessingNode<ElementType>::boxSize)
+    {
+        classes.push_back(output[index]);
+    }
+    testing::ProcessTest("Testing RegionDetectionPostProcessingNode compute", testing::IsEqual(classes, std::vector<ElementType>{ 0, 1, 2, -1 }));
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    // compare computed vs. compiled output
+    std::vector<std::vector<ElementType>> signal = { input };
+    VerifyCompiledOutput(map, compiledMap, signal, computeNode->GetRuntimeTypeName());
+}
+
 void TestBroadcasUnaryOperationNodeCompile()
 {
     model::Model model;
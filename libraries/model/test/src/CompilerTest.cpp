@@ -12,19 +12,27 @@
 
 #include <model/include/CompilableNode.h>
 #include <model/include/IRCompiledMap.h>
+#include <model/include/IRCompiledMapCache.h>
 #include <model/include/IRMapCompiler.h>
 #include <model/include/InputNode.h>
 #include <model/include/Map.h>
+#include <model/include/MemorySchedule.h>
 #include <model/include/Model.h>
+#include <model/include/PipelinedMap.h>
+#include <model/include/SliceNode.h>
+#include <model/include/SpliceNode.h>
 
 #include <nodes/include/AccumulatorNode.h>
+#include <nodes/include/BinaryOperationNode.h>
 #include <nodes/include/ClockNode.h>
 #include <nodes/include/ConstantNode.h>
 #include <nodes/include/DelayNode.h>
 #include <nodes/include/DotProductNode.h>
+#include <nodes/include/EarlyExitNode.h>
 #include <nodes/include/ForestPredictorNode.h>
 #include <nodes/include/L2NormSquaredNode.h>
 #include <nodes/include/LinearPredictorNode.h>
+#include <nodes/include/MatrixMatrixMultiplyNode.h>
 #include <nodes/include/MatrixVectorProductNode.h>
 #include <nodes/include/ProtoNNPredictorNode.h>
 #include <nodes/include/SinkNode.h>
@@ -43,6 +51,8 @@
 #include <predictors/include/LinearPredictor.h>
 #include <predictors/include/ProtoNNPredictor.h>
 
+#include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
 #include <utilities/include/Logger.h>
 #include <utilities/include/RandomEngines.h>
 
@@ -50,11 +60,14 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <future>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <ostream>
 #include <random>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
@@ -372,6 +385,700 @@ void TestCompiledMapClone()
     VerifyCompiledOutput(map2, compiledMap2, signal, " cloned compiled map");
 }
 
+void TestJitCache()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(inputNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", accumNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.jitCacheDirectory = OutputPath("jit_cache");
+    model::ModelOptimizerOptions optimizerOptions;
+    auto cacheEntryPath = utilities::JoinPaths(settings.jitCacheDirectory, model::GetCompiledMapCacheEntryName(map, settings, optimizerOptions));
+    std::remove(cacheEntryPath.c_str());
+
+    std::vector<std::vector<double>> signal = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 3, 4, 5 }, { 2, 3, 2 }, { 1, 5, 3 } };
+
+    // The first compile emits the code normally and fills in the cache
+    model::IRMapCompiler compiler1(settings, optimizerOptions);
+    auto compiledMap1 = compiler1.Compile(map);
+    VerifyCompiledOutput(map, compiledMap1, signal, " map compiled with empty JIT cache");
+    testing::ProcessTest("Testing JIT cache entry written", utilities::FileExists(cacheEntryPath));
+
+    // The second compile loads the cached machine code
+    auto map2 = model::Map(model, { { "input", inputNode } }, { { "output", accumNode->output } });
+    model::IRMapCompiler compiler2(settings, optimizerOptions);
+    auto compiledMap2 = compiler2.Compile(map2);
+    VerifyCompiledOutput(map2, compiledMap2, signal, " map loaded from JIT cache");
+}
+
+void TestJitCacheKeys()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(inputNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", accumNode->output } });
+    model::ModelOptimizerOptions optimizerOptions;
+
+    // Each set of options differs from the default in one option that changes the code
+    std::vector<model::MapCompilerOptions> optionSets(12);
+    optionSets[1].externalWeights = true;
+    optionSets[2].footprintReport = true;
+    optionSets[3].tieredCompilation = true;
+    optionSets[4].compilerSettings.smallGemmThreshold = 64;
+    optionSets[5].compilerSettings.maxOptimizationSeconds = 0.5;
+    optionSets[6].compilerSettings.threadAffinity = { 1, 2 };
+    optionSets[7].compilerSettings.threadAffinity = { 12 };
+    optionSets[8].compilerSettings.cpuDispatchLevels = { "avx2" };
+    optionSets[9].compilerSettings.targetDevice = emitters::GetTargetDevice("pi3");
+    optionSets[10].moduleName = "ELL,";
+    optionSets[11].mapFunctionName = ",predict";
+    std::vector<std::string> keys;
+    for (const auto& options : optionSets)
+    {
+        keys.push_back(model::GetCompiledMapCacheKey(map, options, optimizerOptions));
+    }
+    bool ok = true;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        for (size_t j = i + 1; j < keys.size(); ++j)
+        {
+            ok = ok && keys[i] != keys[j];
+        }
+    }
+
+    // Options that don't change the code don't change the key
+    model::MapCompilerOptions cacheOptions;
+    cacheOptions.jitCacheDirectory = OutputPath("jit_cache");
+    cacheOptions.verifyJittedModule = false;
+    ok = ok && model::GetCompiledMapCacheKey(map, cacheOptions, optimizerOptions) == keys[0];
+    testing::ProcessTest("Testing JIT cache keys differ for different options", ok);
+
+    // An entry is only read back with the key it was written with, even when another key maps to the same file
+    auto entryPath = utilities::JoinPaths(OutputPath("jit_cache"), "key_test.ellcache");
+    model::CachedMachineCode code;
+    code.objectCode = "object code";
+    code.initializationFunctions = { "init" };
+    model::WriteCachedMachineCode(entryPath, keys[0], code);
+
+    model::CachedMachineCode readCode;
+    bool isReadWithOtherKey = model::TryReadCachedMachineCode(entryPath, keys[4], readCode);
+    bool isReadWithSameKey = model::TryReadCachedMachineCode(entryPath, keys[0], readCode);
+    testing::ProcessTest("Testing JIT cache entry is ignored for a different key", !isReadWithOtherKey);
+    testing::ProcessTest("Testing JIT cache entry is read for the same key", isReadWithSameKey && readCode.objectCode == code.objectCode && readCode.initializationFunctions == code.initializationFunctions);
+}
+
+void TestMemoryPlanning()
+{
+    // A chain of nodes whose intermediate outputs are each read by the next one or two nodes only, so their buffers can share memory
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(4);
+    auto sumNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::add);
+    auto productNode = model.AddNode<nodes::BinaryOperationNode<double>>(sumNode->output, inputNode->output, nodes::BinaryOperationType::multiply);
+    auto differenceNode = model.AddNode<nodes::BinaryOperationNode<double>>(productNode->output, sumNode->output, nodes::BinaryOperationType::subtract);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(differenceNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", accumNode->output } });
+
+    std::vector<std::vector<double>> signal = { { 1, 2, 3, 4 }, { 4, 5, 6, 7 }, { 7, 8, 9, 1 }, { 3, 4, 5, 6 } };
+
+    model::MapCompilerOptions settings;
+    settings.planMemory = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    PrintIR(compiledMap);
+    VerifyCompiledOutput(map, compiledMap, signal, " map compiled with memory planning");
+}
+
+void TestMemoryAwareScheduling()
+{
+    // Two branches with a wide intermediate buffer each, which only need one wide buffer live at a time if one branch
+    // is finished before the other is started
+    model::Model model;
+    const int size = 16;
+    auto inputNode = model.AddNode<model::InputNode<double>>(size);
+    auto productNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::multiply);
+    auto sumNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::add);
+    auto productTotalNode = model.AddNode<nodes::SumNode<double>>(productNode->output);
+    auto sumTotalNode = model.AddNode<nodes::SumNode<double>>(sumNode->output);
+    auto differenceNode = model.AddNode<nodes::BinaryOperationNode<double>>(productTotalNode->output, sumTotalNode->output, nodes::BinaryOperationType::subtract);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", differenceNode->output } });
+
+    auto getBufferSize = [](const model::OutputPortBase& port) {
+        return port.GetNode()->NumInputPorts() == 0 ? size_t{ 0 } : port.Size() * sizeof(double);
+    };
+    std::vector<const model::Node*> visitOrder;
+    map.GetModel().Visit([&visitOrder](const model::Node& node) { visitOrder.push_back(&node); });
+    auto order = model::GetMemoryAwareNodeOrder(map.GetModel(), getBufferSize);
+    testing::ProcessTest("Testing memory-aware order has every node", order.size() == visitOrder.size());
+    testing::ProcessTest("Testing memory-aware order peak", model::GetPeakLiveBufferSize(order, getBufferSize) <= model::GetPeakLiveBufferSize(visitOrder, getBufferSize));
+    testing::ProcessTest("Testing memory-aware order peak size", model::GetPeakLiveBufferSize(order, getBufferSize) <= (size + 2) * sizeof(double));
+
+    std::vector<std::vector<double>> signal = { std::vector<double>(size, 1.0), std::vector<double>(size, 2.5) };
+    model::MapCompilerOptions settings;
+    settings.planMemory = true;
+    settings.scheduleForMemory = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    VerifyCompiledOutput(map, compiledMap, signal, " map compiled with memory-aware scheduling");
+}
+
+void TestPortAliasing()
+{
+    // Slices of an intermediate buffer, and spliced ports that nothing else reads (including a splice of a splice),
+    // which the compiler computes in place instead of copying
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(8);
+    auto sumNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::add);
+    auto sliceNode1 = model.AddNode<model::SliceNode<double>>(sumNode->output, 2, 4);
+    auto sliceNode2 = model.AddNode<model::SliceNode<double>>(sumNode->output, 4, 4);
+    auto productNode = model.AddNode<nodes::BinaryOperationNode<double>>(sliceNode1->output, sliceNode1->output, nodes::BinaryOperationType::multiply);
+    auto differenceNode = model.AddNode<nodes::BinaryOperationNode<double>>(sliceNode2->output, sliceNode1->output, nodes::BinaryOperationType::subtract);
+    const auto& innerSplice = model::Splice(productNode->output, differenceNode->output);
+    auto scaleNode = model.AddNode<nodes::BinaryOperationNode<double>>(sliceNode2->output, sliceNode2->output, nodes::BinaryOperationType::add);
+    const auto& outerSplice = model::Splice(scaleNode->output, innerSplice);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(outerSplice);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", accumNode->output } });
+
+    std::vector<std::vector<double>> signal = { { 1, 2, 3, 4, 5, 6, 7, 8 }, { 8, 7, 6, 5, 4, 3, 2, 1 }, { 0, 1, 0, 1, 0, 1, 0, 1 } };
+
+    for (auto planMemory : { false, true })
+    {
+        model::MapCompilerOptions settings;
+        settings.planMemory = planMemory;
+        model::ModelOptimizerOptions optimizerOptions;
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        auto compiledMap = compiler.Compile(map);
+        PrintIR(compiledMap);
+        VerifyCompiledOutput(map, compiledMap, signal, std::string(" map with aliased ports") + (planMemory ? " and memory planning" : ""));
+    }
+}
+
+void TestParallelOptimization()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(4);
+    auto sumNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::add);
+    auto productNode = model.AddNode<nodes::BinaryOperationNode<double>>(sumNode->output, inputNode->output, nodes::BinaryOperationType::multiply);
+    auto dotNode = model.AddNode<nodes::DotProductNode<double>>(productNode->output, sumNode->output);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(dotNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", accumNode->output } });
+
+    std::vector<std::vector<double>> signal = { { 1, 2, 3, 4 }, { 4, 5, 6, 7 }, { 7, 8, 9, 1 }, { 3, 4, 5, 6 } };
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.optimize = true;
+    settings.compilerSettings.optimizationThreads = 4;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    PrintIR(compiledMap);
+    VerifyCompiledOutput(map, compiledMap, signal, " map optimized on several threads");
+}
+
+void TestParallelBranches()
+{
+    // Three independent branches that read the input, two of which merge before the third one joins them, and two
+    // more branches that read the joined value and are spliced into the output
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(4);
+    auto sumNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::add);
+    auto productNode = model.AddNode<nodes::BinaryOperationNode<double>>(sumNode->output, inputNode->output, nodes::BinaryOperationType::multiply);
+    auto squareNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::multiply);
+    auto differenceNode = model.AddNode<nodes::BinaryOperationNode<double>>(squareNode->output, inputNode->output, nodes::BinaryOperationType::subtract);
+    auto accumNode1 = model.AddNode<nodes::AccumulatorNode<double>>(inputNode->output);
+    auto mergeNode = model.AddNode<nodes::BinaryOperationNode<double>>(productNode->output, differenceNode->output, nodes::BinaryOperationType::add);
+    auto joinNode = model.AddNode<nodes::BinaryOperationNode<double>>(mergeNode->output, accumNode1->output, nodes::BinaryOperationType::subtract);
+    auto dotNode = model.AddNode<nodes::DotProductNode<double>>(joinNode->output, inputNode->output);
+    auto accumNode2 = model.AddNode<nodes::AccumulatorNode<double>>(joinNode->output);
+    const auto& outputs = model::Splice(dotNode->output, accumNode2->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", outputs } });
+
+    std::vector<std::vector<double>> signal = { { 1, 2, 3, 4 }, { 4, 5, 6, 7 }, { 7, 8, 9, 1 }, { 3, 4, 5, 6 } };
+
+    for (auto useThreadPool : { false, true })
+    {
+        model::MapCompilerOptions settings;
+        settings.parallelizeBranches = true;
+        settings.compilerSettings.parallelize = true;
+        settings.compilerSettings.useThreadPool = useThreadPool;
+        model::ModelOptimizerOptions optimizerOptions;
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        auto compiledMap = compiler.Compile(map);
+        PrintIR(compiledMap);
+        VerifyCompiledOutput(map, compiledMap, signal, std::string(" map with parallel branches") + (useThreadPool ? " and a thread pool" : ""));
+
+        // Each compiled map has its own thread pool, so it keeps its own affinity
+        auto affinityResult = compiledMap.SetThreadPoolAffinity({ 0 });
+        if (!useThreadPool)
+        {
+            testing::ProcessTest("Testing thread pool affinity of a map without a thread pool", affinityResult == -1 && compiledMap.GetThreadPoolAffinity().empty());
+        }
+        else if (affinityResult == 0)
+        {
+            testing::ProcessTest("Testing thread pool affinity of a map with a thread pool", compiledMap.GetThreadPoolAffinity() == std::vector<int>{ 0 });
+            VerifyCompiledOutput(map, compiledMap, signal, " map with parallel branches and a pinned thread pool");
+        }
+    }
+}
+
+void TestEarlyExit()
+{
+    // The input is its own confidence: at 0.5 or above the output is twice the input, and below it the output is the
+    // sum of the squares of the inputs the full network has computed
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(1);
+    auto doubleNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::add);
+    auto squareNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::multiply);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(squareNode->output);
+    const auto& output = nodes::EarlyExit<double>(doubleNode->output, inputNode->output, accumNode->output, 0.5);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", output } });
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    PrintIR(compiledMap);
+
+    bool hasBranchFunction = false;
+    for (const auto& function : compiledMap.GetModule().GetLLVMModule()->functions())
+    {
+        hasBranchFunction = hasBranchFunction || function.getName().str().find("_branch") != std::string::npos;
+    }
+    testing::ProcessTest("Testing the full network of an early exit is compiled into a function of its own", hasBranchFunction);
+
+    // The accumulator only counts the inputs the full network runs on
+    std::vector<std::vector<double>> signal = { { 1 }, { 0 }, { 2 }, { 0.25 }, { 0.1 } };
+    std::vector<std::vector<double>> expected = { { 2 }, { 0 }, { 4 }, { 0.0625 }, { 0.0725 } };
+    std::vector<std::vector<double>> compiledOutputs;
+    for (const auto& input : signal)
+    {
+        compiledMap.SetInputValue(0, input);
+        compiledOutputs.push_back(compiledMap.ComputeOutput<double>(0));
+    }
+    testing::ProcessTest("Testing early exit skips the full network", testing::IsEqual(compiledOutputs, expected, 1e-10));
+
+    // Without state in the full network, the compiled map matches the reference computation
+    model::Model statelessModel;
+    auto statelessInputNode = statelessModel.AddNode<model::InputNode<double>>(1);
+    auto statelessDoubleNode = statelessModel.AddNode<nodes::BinaryOperationNode<double>>(statelessInputNode->output, statelessInputNode->output, nodes::BinaryOperationType::add);
+    auto statelessSquareNode = statelessModel.AddNode<nodes::BinaryOperationNode<double>>(statelessInputNode->output, statelessInputNode->output, nodes::BinaryOperationType::multiply);
+    auto cubeNode = statelessModel.AddNode<nodes::BinaryOperationNode<double>>(statelessSquareNode->output, statelessInputNode->output, nodes::BinaryOperationType::multiply);
+    const auto& statelessOutput = nodes::EarlyExit<double>(statelessDoubleNode->output, statelessInputNode->output, cubeNode->output, 0.5);
+    auto statelessMap = model::Map(statelessModel, { { "input", statelessInputNode } }, { { "output", statelessOutput } });
+    model::IRMapCompiler statelessCompiler(settings, optimizerOptions);
+    auto statelessCompiledMap = statelessCompiler.Compile(statelessMap);
+    VerifyCompiledOutput(statelessMap, statelessCompiledMap, signal, " map with an early exit");
+}
+
+void TestCpuDispatch()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<float>>(8);
+    auto sumNode = model.AddNode<nodes::BinaryOperationNode<float>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::add);
+    auto productNode = model.AddNode<nodes::BinaryOperationNode<float>>(sumNode->output, inputNode->output, nodes::BinaryOperationType::multiply);
+    auto dotNode = model.AddNode<nodes::DotProductNode<float>>(productNode->output, sumNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", dotNode->output } });
+
+    std::vector<std::vector<float>> signal = { { 1, 2, 3, 4, 5, 6, 7, 8 }, { 8, 7, 6, 5, 4, 3, 2, 1 }, { 0, 1, 0, 1, 0, 1, 0, 1 } };
+
+    // Non-x86-64 hosts ignore the levels, so this only checks the dispatch on x86-64
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.cpuDispatchLevels = { "avx512", "sse4.2", "avx2" };
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    PrintIR(compiledMap);
+    VerifyCompiledOutput(map, compiledMap, signal, " map with node functions compiled for several instruction set levels");
+}
+
+void TestLargeBufferPlacement()
+{
+    // Intermediate buffers of 2 MB, big enough for huge pages and first-touch placement
+    const int size = (2 << 20) / sizeof(float);
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<float>>(size);
+    auto sumNode = model.AddNode<nodes::BinaryOperationNode<float>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::add);
+    auto productNode = model.AddNode<nodes::BinaryOperationNode<float>>(sumNode->output, inputNode->output, nodes::BinaryOperationType::multiply);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", productNode->output } });
+
+    std::vector<float> input(size);
+    for (int index = 0; index < size; ++index)
+    {
+        input[index] = static_cast<float>(index % 17 - 8);
+    }
+    std::vector<std::vector<float>> signal = { input };
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.parallelize = true;
+    settings.compilerSettings.useHugePages = true;
+    settings.compilerSettings.firstTouchBuffers = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    auto& module = compiledMap.GetModule();
+    testing::ProcessTest("Testing large buffer placement function", module.GetLLVMModule()->getFunction(module.GetModuleName() + "_PlaceLargeBuffers") != nullptr);
+    VerifyCompiledOutput(map, compiledMap, signal, " map with large buffers in huge pages and placed by first touch");
+}
+
+void TestWeightPrefetching()
+{
+    const int numRows = 64;
+    const int numColumns = 256;
+    math::RowMatrix<float> weights(numRows, numColumns);
+    for (int row = 0; row < numRows; ++row)
+    {
+        for (int column = 0; column < numColumns; ++column)
+        {
+            weights(row, column) = static_cast<float>((row * 7 + column) % 11 - 5);
+        }
+    }
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<float>>(numColumns);
+    auto productNode = model.AddNode<nodes::MatrixVectorProductNode<float, math::MatrixLayout::rowMajor>>(inputNode->output, weights);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", productNode->output } });
+
+    std::vector<float> input(numColumns);
+    for (int index = 0; index < numColumns; ++index)
+    {
+        input[index] = static_cast<float>(index % 5 - 2);
+    }
+    std::vector<std::vector<float>> signal = { input };
+
+    // Prefetching past the end of the weights must be harmless, so the distance is larger than a row
+    for (bool useFastMath : { false, true })
+    {
+        model::MapCompilerOptions settings;
+        settings.compilerSettings.useBlas = false;
+        settings.compilerSettings.useFastMath = useFastMath;
+        settings.compilerSettings.prefetchDistance = 2 * numColumns * sizeof(float);
+        model::ModelOptimizerOptions optimizerOptions;
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        auto compiledMap = compiler.Compile(map);
+        const auto& functions = compiledMap.GetModule().GetLLVMModule()->functions();
+        auto hasPrefetch = std::any_of(functions.begin(), functions.end(), [](const llvm::Function& function) { return function.getIntrinsicID() == llvm::Intrinsic::prefetch; });
+        testing::ProcessTest("Testing prefetch instructions are emitted", hasPrefetch);
+        VerifyCompiledOutput(map, compiledMap, signal, std::string(" matrix-vector product with weight prefetching") + (useFastMath ? " and fast math" : ""));
+    }
+}
+
+void TestReentrantMap()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(inputNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", accumNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.reentrant = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    PrintIR(compiledMap);
+
+    std::vector<std::vector<double>> signal = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 }, { 3, 4, 5 } };
+    VerifyCompiledOutput(map, compiledMap, signal, " reentrant map");
+
+    // Run two streams through the same compiled code, each with its own state
+    auto& jitter = compiledMap.GetJitter();
+    auto getStateSize = jitter.GetFunction<int64_t()>(settings.moduleName + "_GetStateSize");
+    auto initState = jitter.GetFunction<void(void*)>(settings.moduleName + "_InitState");
+    auto predict = reinterpret_cast<void (*)(void*, void*, const double*, double*)>(jitter.ResolveFunctionAddress(compiledMap.GetFunctionName()));
+
+    struct alignas(16) StateBlock
+    {
+        char bytes[16];
+    };
+    auto stateSize = getStateSize();
+    std::vector<StateBlock> state1((stateSize + sizeof(StateBlock) - 1) / sizeof(StateBlock));
+    std::vector<StateBlock> state2(state1.size());
+    initState(state1.data());
+    initState(state2.data());
+
+    std::vector<double> output1(3);
+    std::vector<double> output2(3);
+    predict(nullptr, state1.data(), signal[0].data(), output1.data());
+    predict(nullptr, state2.data(), signal[2].data(), output2.data());
+    predict(nullptr, state1.data(), signal[1].data(), output1.data());
+
+    testing::ProcessTest("Testing reentrant map state size", stateSize > 0);
+    testing::ProcessTest("Testing reentrant map first stream", testing::IsEqual(output1, std::vector<double>{ 5, 7, 9 }));
+    testing::ProcessTest("Testing reentrant map second stream", testing::IsEqual(output2, std::vector<double>{ 7, 8, 9 }));
+
+    // Save the state of the compiled map, and check that restoring it replays the same outputs
+    auto snapshot = compiledMap.GetState();
+    compiledMap.SetInputValue(0, signal[1]);
+    auto outputBefore = compiledMap.ComputeOutput<double>(0);
+    compiledMap.SetState(snapshot);
+    compiledMap.SetInputValue(0, signal[1]);
+    auto outputAfter = compiledMap.ComputeOutput<double>(0);
+    testing::ProcessTest("Testing reentrant map state snapshot", testing::IsEqual(outputBefore, outputAfter));
+
+    // A clone runs the same jitted code, starting from the initial state
+    auto clone = compiledMap.Clone();
+    clone.SetInputValue(0, signal[0]);
+    auto cloneOutput = clone.ComputeOutput<double>(0);
+    testing::ProcessTest("Testing reentrant map clone shares code", &clone.GetJitter() == &compiledMap.GetJitter());
+    testing::ProcessTest("Testing reentrant map clone state", testing::IsEqual(cloneOutput, signal[0]));
+
+    // A moved map keeps the state it had
+    auto movedMap = std::move(clone);
+    movedMap.SetInputValue(0, signal[1]);
+    auto movedOutput = movedMap.ComputeOutput<double>(0);
+    testing::ProcessTest("Testing reentrant map keeps its state when moved", testing::IsEqual(movedOutput, std::vector<double>{ 5, 7, 9 }));
+}
+
+void TestExternalWeightsMap()
+{
+    // A constant large enough to be placed in the weights blob, added to the input
+    const int size = 32;
+    std::vector<float> weights(size);
+    std::iota(weights.begin(), weights.end(), 1.0f);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<float>>(size);
+    auto constantNode = model.AddNode<nodes::ConstantNode<float>>(weights);
+    auto sumNode = model.AddNode<nodes::BinaryOperationNode<float>>(inputNode->output, constantNode->output, nodes::BinaryOperationType::add);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", sumNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.externalWeights = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    PrintIR(compiledMap);
+
+    auto& jitter = compiledMap.GetJitter();
+    auto getWeightsSize = jitter.GetFunction<int64_t()>(settings.moduleName + "_GetWeightsSize");
+    testing::ProcessTest("Testing external weights map has weights", compiledMap.HasExternalWeights());
+    testing::ProcessTest("Testing external weights map weights size", getWeightsSize() >= static_cast<int64_t>(size * sizeof(float)));
+
+    std::vector<std::vector<float>> signal = { std::vector<float>(size, 1.0f), std::vector<float>(size, -2.0f) };
+    VerifyCompiledOutput(map, compiledMap, signal, " map with external weights");
+
+    // Retrained weights are swapped into the compiled map, and the clones that share them, without compiling it again
+    auto weightsPath = OutputPath("external_weights.bin");
+    compiledMap.WriteExternalWeights(weightsPath);
+    auto clone = compiledMap.Clone();
+
+    std::vector<float> newWeights(size);
+    std::iota(newWeights.rbegin(), newWeights.rend(), -5.0f);
+    model::Model newModel;
+    auto newInputNode = newModel.AddNode<model::InputNode<float>>(size);
+    auto newConstantNode = newModel.AddNode<nodes::ConstantNode<float>>(newWeights);
+    auto newSumNode = newModel.AddNode<nodes::BinaryOperationNode<float>>(newInputNode->output, newConstantNode->output, nodes::BinaryOperationType::add);
+    auto newMap = model::Map(newModel, { { "input", newInputNode } }, { { "output", newSumNode->output } });
+    compiledMap.UpdateWeights(newMap);
+    VerifyCompiledOutput(newMap, compiledMap, signal, " map with updated external weights");
+    VerifyCompiledOutput(newMap, clone, signal, " clone of map with updated external weights");
+
+    compiledMap.UpdateWeights(weightsPath);
+    VerifyCompiledOutput(map, compiledMap, signal, " map with external weights read from a file");
+
+    // A map with differently sized weights doesn't fit
+    model::Model largerModel;
+    auto largerInputNode = largerModel.AddNode<model::InputNode<float>>(2 * size);
+    auto largerConstantNode = largerModel.AddNode<nodes::ConstantNode<float>>(std::vector<float>(2 * size, 1.0f));
+    auto largerSumNode = largerModel.AddNode<nodes::BinaryOperationNode<float>>(largerInputNode->output, largerConstantNode->output, nodes::BinaryOperationType::add);
+    auto largerMap = model::Map(largerModel, { { "input", largerInputNode } }, { { "output", largerSumNode->output } });
+    bool threw = false;
+    try
+    {
+        compiledMap.UpdateWeights(largerMap);
+    }
+    catch (const utilities::InputException&)
+    {
+        threw = true;
+    }
+    testing::ProcessTest("Testing external weights update rejects a different layout", threw);
+}
+
+void TestFootprintReport()
+{
+    const int size = 32;
+    std::vector<float> weights(size);
+    std::iota(weights.begin(), weights.end(), 1.0f);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<float>>(size);
+    auto constantNode = model.AddNode<nodes::ConstantNode<float>>(weights);
+    auto sumNode = model.AddNode<nodes::BinaryOperationNode<float>>(inputNode->output, constantNode->output, nodes::BinaryOperationType::add);
+    auto productNode = model.AddNode<nodes::BinaryOperationNode<float>>(sumNode->output, sumNode->output, nodes::BinaryOperationType::multiply);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", productNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.footprintReport = true;
+    settings.planMemory = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+    testing::ProcessTest("Testing footprint report exists", compiledMap.HasFootprintReport());
+
+    const auto& report = compiledMap.GetFootprintReport();
+    size_t nodeCodeBytes = 0;
+    size_t constantWeightBytes = 0;
+    for (const auto& node : report.GetNodes())
+    {
+        nodeCodeBytes += node.codeBytes;
+        if (node.nodeType.find("ConstantNode") == 0)
+        {
+            constantWeightBytes += node.weightBytes;
+        }
+    }
+    testing::ProcessTest("Testing footprint report code size", report.GetCodeBytes() > 0 && nodeCodeBytes <= report.GetCodeBytes());
+    testing::ProcessTest("Testing footprint report weights", constantWeightBytes >= size * sizeof(float) && report.GetWeightBytes() >= constantWeightBytes);
+    testing::ProcessTest("Testing footprint report buffers", report.GetBufferBytes() >= size * sizeof(float));
+
+    std::stringstream json;
+    report.WriteJson(json);
+    testing::ProcessTest("Testing footprint report JSON", json.str().find("\"totals\"") != std::string::npos && json.str().find("ConstantNode") != std::string::npos);
+
+    std::stringstream header;
+    compiledMap.WriteCodeHeader(header, emitters::ModuleOutputFormat::cHeader);
+    testing::ProcessTest("Testing footprint report in header", header.str().find("Footprint:") != std::string::npos);
+
+    std::vector<std::vector<float>> signal = { std::vector<float>(size, 1.0f), std::vector<float>(size, -2.0f) };
+    VerifyCompiledOutput(map, compiledMap, signal, " map with footprint report");
+}
+
+void TestTieredCompilation()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(inputNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", accumNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.reentrant = true;
+    settings.tieredCompilation = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    // The accumulator's state carries over from the unoptimized code to the optimized code
+    std::vector<std::vector<double>> signal = { { 1, 2, 3 }, { 4, 5, 6 } };
+    compiledMap.SetInputValue(0, signal[0]);
+    auto output1 = compiledMap.ComputeOutput<double>(0);
+    compiledMap.WaitForOptimizedCode();
+    testing::ProcessTest("Testing tiered compilation switches to optimized code", compiledMap.IsRunningOptimizedCode());
+
+    compiledMap.SetInputValue(0, signal[1]);
+    auto output2 = compiledMap.ComputeOutput<double>(0);
+    testing::ProcessTest("Testing tiered compilation unoptimized output", testing::IsEqual(output1, std::vector<double>{ 1, 2, 3 }));
+    testing::ProcessTest("Testing tiered compilation optimized output", testing::IsEqual(output2, std::vector<double>{ 5, 7, 9 }));
+}
+
+void TestLazyCompilation()
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(3);
+    auto accumNode = model.AddNode<nodes::AccumulatorNode<double>>(inputNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", accumNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.lazyCompile = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    auto& jitter = compiledMap.GetJitter();
+    testing::ProcessTest("Testing lazy compilation defers node functions", jitter.NumLazyFunctions() > 0 && jitter.NumCompiledLazyFunctions() == 0);
+
+    std::vector<std::vector<double>> signal = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+    VerifyCompiledOutput(map, compiledMap, signal, " lazily-compiled map");
+    testing::ProcessTest("Testing lazy compilation compiles node functions when called", jitter.NumCompiledLazyFunctions() == jitter.NumLazyFunctions());
+}
+
+void TestSharedNodeFunctions()
+{
+    // Two products of the same shape, with different weights and biases
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(model::MemoryShape{ 2, 3 });
+    const auto& weights1 = nodes::Constant(model, std::vector<double>{ 1, 0, 2, -1, 3, 1, 0, 2, -2 }, model::MemoryShape{ 3, 3 });
+    const auto& weights2 = nodes::Constant(model, std::vector<double>{ 2, 1, 0, 1, -1, 1, 3, 0, 1 }, model::MemoryShape{ 3, 3 });
+    auto product1 = model.AddNode<nodes::MatrixMatrixMultiplyNode<double>>(inputNode->output, 2, 3, 3, 3, weights1, 3, 3);
+    auto product2 = model.AddNode<nodes::MatrixMatrixMultiplyNode<double>>(product1->output, 2, 3, 3, 3, weights2, 3, 3);
+    nodes::OutputEpilogue<double> epilogue1;
+    epilogue1.SetBias({ 1, 2, 3 });
+    epilogue1.SetReLU();
+    product1->SetEpilogue(epilogue1);
+    nodes::OutputEpilogue<double> epilogue2;
+    epilogue2.SetBias({ -4, 0, 1 });
+    epilogue2.SetReLU();
+    product2->SetEpilogue(epilogue2);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", product2->output } });
+
+    model::MapCompilerOptions settings;
+    settings.shareNodeFunctions = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    int numProductFunctions = 0;
+    for (const auto& function : compiledMap.GetModule().GetLLVMModule()->functions())
+    {
+        if (function.getName().startswith("_Node__MatrixMatrixMultiplyNode"))
+        {
+            ++numProductFunctions;
+        }
+    }
+    testing::ProcessTest("Testing nodes with the same shape share a node function", numProductFunctions == 1);
+
+    std::vector<std::vector<double>> signal = { { 1, 2, 3, -4, 5, -6 }, { 0, 1, 0, 2, -1, 3 } };
+    VerifyCompiledOutput(map, compiledMap, signal, " map with shared node functions");
+}
+
+void TestDynamicInputExtent()
+{
+    // 4 rows of 3 values, of which only the first `extent` rows are computed
+    const int maxRows = 4;
+    const int rowSize = 3;
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(model::MemoryShape{ maxRows, rowSize });
+    const auto& sum = nodes::Add(inputNode->output, inputNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", sum } });
+
+    model::MapCompilerOptions settings;
+    settings.dynamicInputExtent = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    const int extent = 2;
+    std::vector<double> input(extent * rowSize);
+    std::iota(input.begin(), input.end(), 1.0);
+    std::vector<double> output(maxRows * rowSize, -1.0);
+    compiledMap.PredictDynamic(input.data(), output.data(), extent);
+
+    std::vector<double> expected(maxRows * rowSize, -1.0);
+    std::transform(input.begin(), input.end(), expected.begin(), [](double x) { return 2 * x; });
+    testing::ProcessTest("Testing dynamic input extent only computes the given rows", testing::IsEqual(output, expected));
+
+    // The regular predict function still computes all the rows
+    std::vector<std::vector<double>> signal = { { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 } };
+    VerifyCompiledOutput(map, compiledMap, signal, " map with a dynamic input extent");
+
+    // Nodes that can't stop after a dynamic extent make the compile fail
+    model::Model sumModel;
+    auto sumInputNode = sumModel.AddNode<model::InputNode<double>>(model::MemoryShape{ maxRows, rowSize });
+    auto sumNode = sumModel.AddNode<nodes::SumNode<double>>(sumInputNode->output);
+    auto sumMap = model::Map(sumModel, { { "input", sumInputNode } }, { { "output", sumNode->output } });
+    bool threw = false;
+    try
+    {
+        model::IRMapCompiler sumCompiler(settings, optimizerOptions);
+        sumCompiler.Compile(sumMap);
+    }
+    catch (const utilities::InputException&)
+    {
+        threw = true;
+    }
+    testing::ProcessTest("Testing dynamic input extent rejects unsupported nodes", threw);
+}
+
 void TestCompiledMapParallelClone()
 {
     model::Model model;
@@ -419,6 +1126,53 @@ void TestCompiledMapParallelClone()
     }
 }
 
+void TestPipelinedMap()
+{
+    // A chain of nodes, some of them stateful, that can be cut after every node but the input
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(4);
+    auto sumNode = model.AddNode<nodes::BinaryOperationNode<double>>(inputNode->output, inputNode->output, nodes::BinaryOperationType::add);
+    auto accumNode1 = model.AddNode<nodes::AccumulatorNode<double>>(sumNode->output);
+    auto squareNode = model.AddNode<nodes::BinaryOperationNode<double>>(accumNode1->output, accumNode1->output, nodes::BinaryOperationType::multiply);
+    auto accumNode2 = model.AddNode<nodes::AccumulatorNode<double>>(squareNode->output);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", accumNode2->output } });
+
+    std::vector<std::vector<double>> signal = { { 1, 2, 3, 4 }, { 4, 5, 6, 7 }, { 7, 8, 9, 1 }, { 3, 4, 5, 6 }, { 2, 3, 2, 1 }, { 1, 5, 3, 2 }, { 7, 4, 2, 9 }, { 5, 2, 1, 3 }, { 6, 1, 4, 8 }, { 9, 9, 2, 4 } };
+    std::vector<std::vector<double>> expected;
+    for (const auto& input : signal)
+    {
+        map.SetInputValue(0, input);
+        expected.push_back(map.ComputeOutput<double>(0));
+    }
+
+    model::PipelinedMap pipelinedMap(map, 3, {}, {}, {}, 2);
+    testing::ProcessTest("Testing pipelined map stages", testing::IsEqual(pipelinedMap.NumStages(), 3));
+
+    // Push more frames than the queues can hold, taking the results out as they come
+    std::vector<std::vector<double>> results;
+    std::vector<double> result(pipelinedMap.GetOutputSize());
+    for (const auto& input : signal)
+    {
+        pipelinedMap.PushFrame(input.data());
+        while (pipelinedMap.TryPopResult(result.data()))
+        {
+            results.push_back(result);
+        }
+    }
+    while (results.size() < signal.size())
+    {
+        pipelinedMap.PopResult(result.data());
+        results.push_back(result);
+    }
+
+    bool ok = results.size() == expected.size();
+    for (size_t index = 0; ok && index < results.size(); ++index)
+    {
+        ok = testing::IsEqual(results[index], expected[index], 1e-9);
+    }
+    testing::ProcessTest("Testing pipelined map output", ok);
+}
+
 typedef void (*MapPredictFunction)(void* context, double*, double*);
 
 void TestBinaryVector(bool expanded, bool runJit)
@@ -471,6 +1225,105 @@ void TestBinaryVector(bool expanded, bool runJit)
     }
 }
 
+void TestBatchPredictFunction()
+{
+    std::vector<double> data = { 5, 10, 15, 20 };
+    const int inputSize = data.size();
+    const int batchSize = 3;
+    const std::string modelFunctionName = "TestBatchPredict";
+    model::Model model;
+
+    auto inputNode = model.AddNode<model::InputNode<double>>(inputSize);
+    const auto& c1 = nodes::Constant(model, data);
+    const auto& product = nodes::Multiply(c1, inputNode->output);
+
+    model::MapCompilerOptions settings;
+    settings.mapFunctionName = modelFunctionName;
+    settings.emitBatchPredictFunction = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+
+    model::Map map{ model, { { "input", inputNode } }, { { "output", product } } };
+    model::IRCompiledMap compiledMap = compiler.Compile(map);
+
+    std::vector<double> batchInput;
+    std::vector<double> expectedOutput;
+    for (int sample = 0; sample < batchSize; ++sample)
+    {
+        for (int i = 0; i < inputSize; ++i)
+        {
+            batchInput.push_back(sample + i);
+            expectedOutput.push_back((sample + i) * data[i]);
+        }
+    }
+    std::vector<double> batchOutput(batchInput.size());
+
+    using BatchPredictFunction = void (*)(void* context, double*, double*, int);
+    auto& jitter = compiledMap.GetJitter();
+    auto predictBatch = reinterpret_cast<BatchPredictFunction>(jitter.ResolveFunctionAddress(modelFunctionName + "_batch"));
+    predictBatch(nullptr, batchInput.data(), batchOutput.data(), batchSize);
+
+    testing::ProcessTest("Testing batch predict function", testing::IsEqual(batchOutput, expectedOutput));
+
+    std::vector<double> compiledMapOutput(batchInput.size());
+    compiledMap.PredictBatch(batchInput.data(), compiledMapOutput.data(), batchSize);
+    testing::ProcessTest("Testing IRCompiledMap::PredictBatch", testing::IsEqual(compiledMapOutput, expectedOutput));
+}
+
+void TestMergedMapPredictFunctions()
+{
+    // Two maps with the same preprocessing of the same input
+    std::vector<double> data = { 5, 10, 15, 20 };
+    const int inputSize = data.size();
+    const std::string modelFunctionName = "TestMergedPredict";
+    auto makeMap = [&](bool useSum) {
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<double>>(inputSize);
+        const auto& product = nodes::Multiply(nodes::Constant(model, data), inputNode->output);
+        if (useSum)
+        {
+            auto sumNode = model.AddNode<nodes::SumNode<double>>(product);
+            return model::Map{ model, { { "input", inputNode } }, { { "output", sumNode->output } } };
+        }
+        auto dotNode = model.AddNode<nodes::DotProductNode<double>>(product, product);
+        return model::Map{ model, { { "input", inputNode } }, { { "output", dotNode->output } } };
+    };
+    std::vector<model::Map> maps = { makeMap(true), makeMap(false) };
+
+    model::MapCompilerOptions settings;
+    settings.mapFunctionName = modelFunctionName;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::IRCompiledMap compiledMap = compiler.Compile(maps, { "sum", "dot" });
+
+    std::vector<double> input = { 1, 2, 3, 4 };
+    double expectedSum = 0;
+    double expectedDot = 0;
+    for (int i = 0; i < inputSize; ++i)
+    {
+        expectedSum += input[i] * data[i];
+        expectedDot += input[i] * data[i] * input[i] * data[i];
+    }
+
+    using PredictFunction = void (*)(void* context, double*, double*, double*);
+    using MapPredictFunction = void (*)(void* context, double*, double*);
+    auto& jitter = compiledMap.GetJitter();
+    auto predict = reinterpret_cast<PredictFunction>(jitter.ResolveFunctionAddress(modelFunctionName));
+    auto predictSum = reinterpret_cast<MapPredictFunction>(jitter.ResolveFunctionAddress(modelFunctionName + "_sum"));
+    auto predictDot = reinterpret_cast<MapPredictFunction>(jitter.ResolveFunctionAddress(modelFunctionName + "_dot"));
+
+    double sum = 0;
+    double dot = 0;
+    predict(nullptr, input.data(), &sum, &dot);
+    testing::ProcessTest("Testing merged map predict function", testing::IsEqual(sum, expectedSum) && testing::IsEqual(dot, expectedDot));
+
+    sum = 0;
+    dot = 0;
+    predictSum(nullptr, input.data(), &sum);
+    predictDot(nullptr, input.data(), &dot);
+    testing::ProcessTest("Testing merged map per-map predict functions", testing::IsEqual(sum, expectedSum) && testing::IsEqual(dot, expectedDot));
+}
+
 void TestBinaryScalar()
 {
     std::vector<double> data = { 5 };
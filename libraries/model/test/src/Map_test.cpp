@@ -18,9 +18,13 @@
 #include <model/include/Map.h>
 #include <model/include/Model.h>
 #include <model/include/OutputNode.h>
+#include <model/include/RefinementCache.h>
+#include <model/include/SpliceNode.h>
+#include <model/include/TransformContext.h>
 
 #include <nodes/include/ClockNode.h>
 #include <nodes/include/ExtremalValueNode.h>
+#include <nodes/include/L2NormSquaredNode.h>
 #include <nodes/include/MovingAverageNode.h>
 #include <nodes/include/SinkNode.h>
 #include <nodes/include/SourceNode.h>
@@ -132,6 +136,43 @@ void TestMapRefine()
     testing::ProcessTest("Testing refined map compute", testing::IsEqual(resultValues1, resultValues2));
 }
 
+void TestMapRefineWithCache()
+{
+    model::Model model;
+    const auto& in = model::Input<double>(model, 3);
+    const auto& norm1 = nodes::L2NormSquared(in);
+    const auto& norm2 = nodes::L2NormSquared(in);
+    model::Output(model::Splice(norm1, norm2));
+    auto inputNodes = model.GetNodesByType<model::InputNode<double>>();
+    auto outputNodes = model.GetNodesByType<model::OutputNode<double>>();
+
+    auto map = model::Map(model, { { "input", inputNodes[0] } }, { { "output", outputNodes[0]->output } });
+    auto map1 = model::Map(model, { { "input", inputNodes[0] } }, { { "output", outputNodes[0]->output } });
+    auto map2 = model::Map(model, { { "input", inputNodes[0] } }, { { "output", outputNodes[0]->output } });
+
+    model::RefinementCache cache;
+    model::TransformContext context;
+    context.SetRefinementCache(&cache);
+
+    // The two L2NormSquared nodes have the same content, so the second one reuses what the first refined into
+    map1.Refine(context);
+    auto numEntries = cache.NumEntries();
+    auto numHits = cache.NumHits();
+    testing::ProcessTest("Testing refinement cache reuse within a model", numEntries > 0 && numHits > 0);
+
+    // Refining an identical map replays every refinement from the cache
+    map2.Refine(context);
+    testing::ProcessTest("Testing refinement cache reuse across models", cache.NumEntries() == numEntries && cache.NumHits() > numHits);
+    testing::ProcessTest("Testing refinement cache model size", map1.GetModel().Size() == map2.GetModel().Size());
+
+    std::vector<double> input = { 1.0, 2.0, 3.0 };
+    map.SetInputValue("input", input);
+    map1.SetInputValue("input", input);
+    map2.SetInputValue("input", input);
+    auto expected = map.ComputeOutput<double>("output");
+    testing::ProcessTest("Testing refinement cache compute", testing::IsEqual(expected, map1.ComputeOutput<double>("output")) && testing::IsEqual(expected, map2.ComputeOutput<double>("output")));
+}
+
 void TestMapSerialization(const model::Map& map)
 {
     std::stringstream outStream;
@@ -214,3 +255,54 @@ void TestMapClockNode()
     std::vector<nodes::TimeTickType> expectedLagValues = { lagThreshold, lagThreshold * 20 };
     testing::ProcessTest("Testing lag callbacks", testing::IsEqual(lagValues, expectedLagValues));
 }
+
+void TestMergeMaps()
+{
+    // Two maps that read the same input, and one with an input of its own
+    auto makeMap = [](bool useMax) {
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<double>>(3);
+        if (useMax)
+        {
+            auto maxNode = model.AddNode<nodes::ArgMaxNode<double>>(inputNode->output);
+            return model::Map(model, { { "input", inputNode } }, { { "value", maxNode->val }, { "index", maxNode->argVal } });
+        }
+        auto normNode = model.AddNode<nodes::L2NormSquaredNode<double>>(inputNode->output);
+        auto otherInputNode = model.AddNode<model::InputNode<double>>(1);
+        return model::Map(model, { { "input", inputNode }, { "scale", otherInputNode } }, { { "norm", normNode->output }, { "scale", otherInputNode->output } });
+    };
+    std::vector<model::Map> maps = { makeMap(true), makeMap(false) };
+    auto mergedMap = model::MergeMaps(maps, { "max", "norm" });
+
+    testing::ProcessTest("Testing merged map inputs", mergedMap.NumInputs() == 2 && mergedMap.GetModel().GetNodesByType<model::InputNode<double>>().size() == 2);
+    testing::ProcessTest("Testing merged map output names", mergedMap.NumOutputs() == 4 && mergedMap.GetOutputName(0) == "max_value" && mergedMap.GetOutputName(3) == "norm_scale");
+    testing::ProcessTest("Testing merged map grouping", testing::IsEqual(model::GetMergedMapNames(mergedMap), std::vector<std::string>{ "max", "norm" }) && testing::IsEqual(model::GetMergedMapOutputCounts(mergedMap), std::vector<int>{ 2, 2 }));
+
+    std::vector<double> input = { 1.0, 4.0, 2.0 };
+    std::vector<double> scale = { 0.5 };
+    maps[0].SetInputValue("input", input);
+    maps[1].SetInputValue("input", input);
+    maps[1].SetInputValue("scale", scale);
+    mergedMap.SetInputValue("input", input);
+    mergedMap.SetInputValue("scale", scale);
+    bool ok = testing::IsEqual(mergedMap.ComputeOutput<double>("max_value"), maps[0].ComputeOutput<double>("value")) &&
+              testing::IsEqual(mergedMap.ComputeOutput<int>("max_index"), maps[0].ComputeOutput<int>("index")) &&
+              testing::IsEqual(mergedMap.ComputeOutput<double>("norm_norm"), maps[1].ComputeOutput<double>("norm")) &&
+              testing::IsEqual(mergedMap.ComputeOutput<double>("norm_scale"), scale);
+    testing::ProcessTest("Testing merged map compute", ok);
+
+    // Inputs with the same name must have the same shape
+    model::Model otherModel;
+    auto otherInputNode = otherModel.AddNode<model::InputNode<double>>(4);
+    maps.push_back(model::Map(otherModel, { { "input", otherInputNode } }, { { "output", otherInputNode->output } }));
+    bool threw = false;
+    try
+    {
+        model::MergeMaps(maps, { "max", "norm", "other" });
+    }
+    catch (const utilities::InputException&)
+    {
+        threw = true;
+    }
+    testing::ProcessTest("Testing merged map input shape mismatch", threw);
+}
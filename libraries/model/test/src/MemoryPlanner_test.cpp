@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     MemoryPlanner_test.cpp (model_test)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "MemoryPlanner_test.h"
+
+#include <model/include/MemoryPlanner.h>
+
+#include <testing/include/testing.h>
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::testing;
+
+namespace
+{
+bool Overlaps(size_t offset1, size_t size1, size_t offset2, size_t size2)
+{
+    return offset1 < offset2 + size2 && offset2 < offset1 + size1;
+}
+} // namespace
+
+void TestMemoryPlanner()
+{
+    TestMemoryPlannerReusesFreedGaps();
+    TestMemoryPlannerAlignment();
+    TestMemoryPlannerPeakSize();
+    TestMemoryPlannerBadArguments();
+}
+
+void TestMemoryPlannerReusesFreedGaps()
+{
+    MemoryPlanner planner(1);
+    auto a = planner.Allocate(100);
+    auto b = planner.Allocate(50);
+    auto c = planner.Allocate(10);
+    auto d = planner.Allocate(200);
+    auto e = planner.Allocate(60);
+    ProcessTest("Testing MemoryPlanner places live buffers one after another", a == 0 && b == 100 && c == 150 && d == 160 && e == 360);
+
+    // A buffer that fits in a freed region goes there
+    planner.Free(a);
+    auto f = planner.Allocate(80);
+    ProcessTest("Testing MemoryPlanner reuses a freed gap", f == a);
+
+    // The smallest gap that fits is used: the 70 bytes after `f` (the rest of `a`, and `b`) rather than the 200 bytes of `d`
+    planner.Free(d);
+    planner.Free(b);
+    auto g = planner.Allocate(40);
+    ProcessTest("Testing MemoryPlanner uses the smallest gap that fits", g == f + 80);
+
+    // Neighboring freed buffers make one gap
+    planner.Free(c);
+    auto h = planner.Allocate(210);
+    ProcessTest("Testing MemoryPlanner merges neighboring gaps", h == g + 40);
+
+    // A buffer that fits in no gap goes after the last live buffer
+    auto i = planner.Allocate(300);
+    ProcessTest("Testing MemoryPlanner puts a buffer that doesn't fit a gap at the end", i == e + 60);
+    ProcessTest("Testing MemoryPlanner peak size with reuse", planner.GetPeakSize() == i + 300);
+}
+
+void TestMemoryPlannerAlignment()
+{
+    const size_t alignment = 64;
+    MemoryPlanner planner(alignment);
+    std::vector<size_t> sizes = { 1, 63, 64, 65, 100, 3, 129 };
+    std::vector<size_t> offsets;
+    bool aligned = true;
+    for (auto size : sizes)
+    {
+        offsets.push_back(planner.Allocate(size));
+        aligned = aligned && offsets.back() % alignment == 0;
+    }
+
+    // Free every other buffer, and fill the gaps again
+    for (size_t index = 0; index < offsets.size(); index += 2)
+    {
+        planner.Free(offsets[index]);
+    }
+    for (size_t index = 0; index < offsets.size(); index += 2)
+    {
+        auto offset = planner.Allocate(sizes[index]);
+        aligned = aligned && offset % alignment == 0;
+        offsets[index] = offset;
+    }
+    ProcessTest("Testing MemoryPlanner aligns every offset", aligned);
+
+    bool overlapping = false;
+    for (size_t i = 0; i < offsets.size(); ++i)
+    {
+        for (size_t j = i + 1; j < offsets.size(); ++j)
+        {
+            overlapping = overlapping || Overlaps(offsets[i], sizes[i], offsets[j], sizes[j]);
+        }
+    }
+    ProcessTest("Testing MemoryPlanner live buffers don't overlap", !overlapping);
+    ProcessTest("Testing MemoryPlanner total size counts aligned sizes", planner.GetTotalAllocatedSize() % alignment == 0);
+}
+
+void TestMemoryPlannerPeakSize()
+{
+    // A chain of layers, where each buffer is only live while the next one is computed
+    MemoryPlanner planner(16);
+    std::vector<size_t> sizes = { 1024, 4096, 2048, 4096, 1024, 512 };
+    size_t previous = planner.Allocate(sizes[0]);
+    size_t largestPair = 0;
+    for (size_t index = 1; index < sizes.size(); ++index)
+    {
+        auto current = planner.Allocate(sizes[index]);
+        planner.Free(previous);
+        previous = current;
+        largestPair = std::max(largestPair, sizes[index - 1] + sizes[index]);
+    }
+
+    size_t total = 0;
+    for (auto size : sizes)
+    {
+        total += size;
+    }
+    ProcessTest("Testing MemoryPlanner total size", planner.GetTotalAllocatedSize() == total);
+    ProcessTest("Testing MemoryPlanner peak size is less than the total", planner.GetPeakSize() < total);
+    ProcessTest("Testing MemoryPlanner peak size is at least the largest live set", planner.GetPeakSize() >= largestPair);
+}
+
+void TestMemoryPlannerBadArguments()
+{
+    bool threw = false;
+    try
+    {
+        MemoryPlanner planner(24);
+    }
+    catch (const utilities::InputException&)
+    {
+        threw = true;
+    }
+    ProcessTest("Testing MemoryPlanner rejects an alignment that isn't a power of 2", threw);
+
+    threw = false;
+    try
+    {
+        MemoryPlanner planner(8);
+        planner.Allocate(10);
+        planner.Free(8);
+    }
+    catch (const utilities::InputException&)
+    {
+        threw = true;
+    }
+    ProcessTest("Testing MemoryPlanner rejects freeing a buffer that wasn't allocated", threw);
+}
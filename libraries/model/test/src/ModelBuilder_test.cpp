@@ -18,6 +18,7 @@
 #include <model/include/OutputNode.h>
 #include <model/include/PortElements.h>
 
+#include <nodes/include/BinaryOperationNode.h>
 #include <nodes/include/ExtremalValueNode.h>
 #include <nodes/include/MovingAverageNode.h>
 
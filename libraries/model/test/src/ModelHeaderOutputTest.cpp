@@ -37,12 +37,13 @@ using namespace ell::emitters;
 namespace
 {
 
-model::IRMapCompiler CreateMapCompiler(const std::string& moduleName, const std::string& mapFunctionName)
+model::IRMapCompiler CreateMapCompiler(const std::string& moduleName, const std::string& mapFunctionName, bool emitBatchPredictFunction = false)
 {
     model::MapCompilerOptions settings;
     settings.moduleName = moduleName;
     settings.mapFunctionName = mapFunctionName;
     settings.compilerSettings.optimize = true;
+    settings.emitBatchPredictFunction = emitBatchPredictFunction;
 
     return model::IRMapCompiler(settings, model::ModelOptimizerOptions{});
 }
@@ -147,6 +148,7 @@ void TestCppHeader()
     testing::ProcessTest("Testing C++ wrapper 2", testing::IsTrue(std::string::npos != result.find(std::string("void TestModule_MyDataCallback(void* context, ") + typeString + "* input)")));
     testing::ProcessTest("Testing C++ wrapper 3", testing::IsTrue(std::string::npos != result.find(std::string("void TestModule_MyResultsCallback(void* context, ") + typeString + "* sum)")));
     testing::ProcessTest("Testing C++ wrapper 4", testing::IsTrue(std::string::npos != result.find("TestModule_Predict(this, &time, nullptr);")));
+    testing::ProcessTest("Testing C++ wrapper callback buffers", testing::IsTrue(std::string::npos != result.find("struct CallbackBuffer") && std::string::npos != result.find("MyDataCallbackBuffer(CallbackBuffer<" + typeString + ">{ buffer, GetInputSize(0) });") && std::string::npos != result.find("virtual void MyResultsCallbackBuffer(CallbackBuffer<" + typeString + "> sum)")));
 
     testing::ProcessTest("Checking that all delimiters are processed", testing::IsTrue(std::string::npos == result.find("@@")));
 
@@ -162,6 +164,49 @@ void TestCppHeader()
     TestCppHeader<float>();
 }
 
+template <typename ElementType>
+void TestCppHeaderNoCallbacks(bool emitBatchPredictFunction)
+{
+    auto mapCompiler = CreateMapCompiler("TestModule", "TestModule_predict", emitBatchPredictFunction);
+    auto compiledMap = GetCompiledMapNoCallbacks<ElementType>(mapCompiler);
+    auto& module = compiledMap.GetModule();
+
+    std::stringstream ss;
+    WriteModuleHeader(ss, module);
+    WriteModuleCppWrapper(ss, module);
+    auto result = ss.str();
+
+    std::string typeString = ToTypeString<ElementType>();
+    auto pointerArgs = "const " + typeString + "* input, " + typeString + "* output";
+    auto callArgs = "this, const_cast<" + typeString + "*>(input), output";
+
+    testing::ProcessTest("Testing C++ wrapper aligned buffers", testing::IsTrue(std::string::npos != result.find("class AlignedBuffer") && std::string::npos != result.find("AlignedBuffer<" + typeString + "> _inputBuffer;") && std::string::npos != result.find("_outputBuffer.Resize(GetOutputSize(0));")));
+    testing::ProcessTest("Testing C++ wrapper in-place predict", testing::IsTrue(std::string::npos != result.find("void PredictInto(" + pointerArgs + ")") && std::string::npos != result.find("TestModule_predict(" + callArgs + ");")));
+    testing::ProcessTest("Testing C++ wrapper batch predict", testing::IsTrue(std::string::npos != result.find("void PredictBatch(" + pointerArgs + ", int batchSize)")));
+    if (emitBatchPredictFunction)
+    {
+        testing::ProcessTest("Testing C++ wrapper batch predict function", testing::IsTrue(std::string::npos != result.find("TestModule_predict_batch(" + callArgs + ", batchSize);")));
+    }
+    else
+    {
+        testing::ProcessTest("Testing C++ wrapper batch predict loop", testing::IsTrue(std::string::npos != result.find("PredictInto(input + sample * GetInputSize(0), output + sample * GetOutputSize(0));")));
+    }
+    testing::ProcessTest("Testing C++ wrapper buffer predict", testing::IsTrue(std::string::npos != result.find(typeString + "* GetInputBuffer()") && std::string::npos != result.find("PredictInto(_inputBuffer.Data(), _outputBuffer.Data());") && std::string::npos != result.find("std::future<void> PredictAsync()")));
+
+    testing::ProcessTest("Checking that all delimiters are processed", testing::IsTrue(std::string::npos == result.find("@@")));
+
+    if (testing::DidTestFail())
+    {
+        std::cout << result << std::endl;
+    }
+}
+
+void TestCppHeaderNoCallbacks()
+{
+    TestCppHeaderNoCallbacks<double>(false);
+    TestCppHeaderNoCallbacks<float>(true);
+}
+
 template <typename ElementType>
 void TestSwigCallbackInterfaces()
 {
@@ -185,6 +230,11 @@ void TestSwigCallbackInterfaces()
     testing::ProcessTest("Testing shape wrappers 3", testing::IsTrue(std::string::npos != result.find("TensorShape get_default_output_shape() {")));
     testing::ProcessTest("Testing shape wrappers 4", testing::IsTrue(std::string::npos != result.find("TestModuleWithCallbacks_GetOutputShape(0, &s);")));
 
+    std::string bufferTypeString = std::string(vectorTypeString).replace(vectorTypeString.find("Vector"), 6, "CallbackBuffer");
+    testing::ProcessTest("Testing callback buffers", testing::IsTrue(std::string::npos != result.find("%template(" + bufferTypeString + ") CallbackBuffer<" + typeString + ">;") && std::string::npos != result.find(bufferTypeString + ".__array__ = ")));
+    testing::ProcessTest("Testing GIL release", testing::IsTrue(std::string::npos != result.find("threads=\"1\"") && std::string::npos != result.find("%threadallow TestModuleWithCallbacksWrapper::")));
+    testing::ProcessTest("Testing no buffer predict with source nodes", testing::IsTrue(std::string::npos == result.find("%extend TestModuleWithCallbacksWrapper")));
+
     testing::ProcessTest("Checking that all delimiters are processed", testing::IsTrue(std::string::npos == result.find("@@")));
 
     if (testing::DidTestFail())
@@ -209,10 +259,15 @@ void TestSwigNoCallbackInterfaces()
     std::stringstream ss;
     WriteModuleSwigInterface(ss, module, "TestModule.h");
     auto result = ss.str();
+    std::string typeString = ToTypeString<ElementType>();
     std::string vectorTypeString = ToTypeString<std::vector<ElementType>>();
 
     // Sanity tests
     testing::ProcessTest("Testing generated python code 1", testing::IsTrue(std::string::npos != result.find("def predict(inputData: 'numpy.ndarray') -> \"numpy.ndarray\":")));
+    testing::ProcessTest("Testing buffer typemaps", testing::IsTrue(std::string::npos != result.find("TYPEMAP_BUFFER_TO_POINTER(" + typeString + ", const " + typeString + "* input, inputSize, 0)") && std::string::npos != result.find("TYPEMAP_BUFFER_TO_POINTER(" + typeString + ", " + typeString + "* output, outputSize, PyBUF_WRITABLE)")));
+    testing::ProcessTest("Testing buffer predict", testing::IsTrue(std::string::npos != result.find("void PredictInto(const " + typeString + "* input, size_t inputSize, " + typeString + "* output, size_t outputSize)") && std::string::npos != result.find("$self->PredictInto(input, output);")));
+    testing::ProcessTest("Testing GIL release", testing::IsTrue(std::string::npos != result.find("%threadallow TestModuleWrapper::Predict;") && std::string::npos != result.find("%threadallow TestModuleWrapper::PredictInto;")));
+    testing::ProcessTest("Testing generated python code 2", testing::IsTrue(std::string::npos != result.find("if True:") && std::string::npos != result.find("_model_wrapper.PredictInto(inputData, output)")));
     testing::ProcessTest("Checking that all delimiters are processed", testing::IsTrue(std::string::npos == result.find("@@")));
 
     if (testing::DidTestFail())
@@ -236,6 +291,7 @@ void TestSwigNoCallbackInterfaces()
 void TestModelHeaderOutput()
 {
     TestCppHeader();
+    TestCppHeaderNoCallbacks();
     TestSwigCallbackInterfaces();
     TestSwigNoCallbackInterfaces();
 }
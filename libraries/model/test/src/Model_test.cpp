@@ -23,6 +23,7 @@
 #include <model/include/RefineTransformation.h>
 #include <model/include/Submodel.h>
 
+#include <nodes/include/BinaryOperationNode.h>
 #include <nodes/include/ConstantNode.h>
 #include <nodes/include/DotProductNode.h>
 #include <nodes/include/ExtremalValueNode.h>
@@ -31,6 +32,7 @@
 
 #include <testing/include/testing.h>
 
+#include <utilities/include/ParallelFor.h>
 #include <utilities/include/Unused.h>
 
 #include <iomanip>
@@ -299,6 +301,143 @@ void TestModelSerialization()
     testing::ProcessTest("Testing model serialization", testing::IsEqual(model1.Size(), model2.Size()));
 }
 
+void TestLargeModelSerialization()
+{
+    // A long chain of nodes, which the model allocates from its node arena when they're added, copied and unarchived
+    const int numNodes = 2000;
+    model::Model model1;
+    auto in = model1.AddNode<model::InputNode<double>>(3);
+    const model::OutputPort<double>* output = &in->output;
+    for (int index = 0; index < numNodes; ++index)
+    {
+        output = &model1.AddNode<model::OutputNode<double>>(*output)->output;
+    }
+
+    std::stringstream buffer;
+    utilities::JsonArchiver archiver(buffer);
+    archiver << model1;
+
+    utilities::SerializationContext context;
+    common::RegisterNodeTypes(context);
+    utilities::JsonUnarchiver unarchiver(buffer, context);
+    model::Model model2;
+    unarchiver >> model2;
+
+    // A node allocated outside of a model comes from the heap, and must still be freed properly
+    auto heapNode = std::make_unique<model::InputNode<double>>(3);
+    heapNode.reset();
+
+    auto model3 = model2.DeepCopy();
+    auto in3 = model3.GetNodesByType<model::InputNode<double>>();
+    auto out3 = model3.GetNodesByType<model::OutputNode<double>>();
+    bool ok = in3.size() == 1 && out3.size() == static_cast<size_t>(numNodes);
+    if (ok)
+    {
+        std::vector<double> inputValues = { 1.0, 2.0, 3.0 };
+        in3[0]->SetInput(inputValues);
+        ok = testing::IsEqual(model3.ComputeOutput(out3.back()->output), inputValues);
+    }
+
+    testing::ProcessTest("Testing large model serialization", testing::IsEqual(model1.Size(), model2.Size()) && testing::IsEqual(model2.Size(), model3.Size()) && ok);
+}
+
+void TestModelAdjacency()
+{
+    model::Model model;
+    auto in = model.AddNode<model::InputNode<double>>(3);
+    auto a = model.AddNode<model::OutputNode<double>>(in->output);
+    auto b = model.AddNode<model::OutputNode<double>>(in->output);
+    auto c = model.AddNode<model::OutputNode<double>>(a->output);
+
+    auto adjacency = model.GetAdjacency();
+    auto getChildren = [&adjacency](const model::Node* node) {
+        auto index = node->GetIndex();
+        return std::vector<size_t>(adjacency->children.begin() + adjacency->childOffsets[index], adjacency->children.begin() + adjacency->childOffsets[index + 1]);
+    };
+    bool ok = adjacency->NumNodes() == 4;
+    ok = ok && testing::IsEqual(adjacency->parents[adjacency->parentOffsets[c->GetIndex()]], a->GetIndex());
+    ok = ok && getChildren(in) == std::vector<size_t>{ a->GetIndex(), b->GetIndex() } && getChildren(c).empty();
+    ok = ok && adjacency->topologicalOrder == std::vector<size_t>{ 0, 1, 2, 3 };
+
+    // Reconnecting an input rebuilds the adjacency structure
+    model::ModelEditor::ResetInputPort(&c->input, b->output);
+    adjacency = model.GetAdjacency();
+    ok = ok && testing::IsEqual(adjacency->parents[adjacency->parentOffsets[c->GetIndex()]], b->GetIndex());
+    ok = ok && getChildren(a).empty() && getChildren(b) == std::vector<size_t>{ c->GetIndex() };
+
+    testing::ProcessTest("Testing model adjacency", ok);
+}
+
+void TestRepeatedModelCompute()
+{
+    model::Model model;
+    auto in = model.AddNode<model::InputNode<double>>(3);
+    auto constant = model.AddNode<nodes::ConstantNode<double>>(std::vector<double>{ 1, 2, 3 });
+    auto sum = model.AddNode<nodes::BinaryOperationNode<double>>(in->output, constant->output, nodes::BinaryOperationType::add);
+    auto elements = model::PortElements<double>({ model::PortElements<double>(sum->output, 1, 2), model::PortElements<double>(in->output, 0) });
+
+    // The nodes' buffers are reused from one computation to the next, so the second result must not depend on the first
+    in->SetInput(std::vector<double>{ 1, 1, 1 });
+    bool ok = testing::IsEqual(model.ComputeOutput(sum->output), std::vector<double>{ 2, 3, 4 });
+    ok = ok && testing::IsEqual(model.ComputeOutput(elements), std::vector<double>{ 3, 4, 1 });
+    in->SetInput(std::vector<double>{ 4, 5, 6 });
+    ok = ok && testing::IsEqual(model.ComputeOutput(sum->output), std::vector<double>{ 5, 7, 9 });
+    ok = ok && testing::IsEqual(model.ComputeOutput(elements), std::vector<double>{ 7, 9, 4 });
+
+    // Adding a node drops the nodes to compute for each output, so the new node's output is computed
+    auto product = model.AddNode<nodes::BinaryOperationNode<double>>(sum->output, constant->output, nodes::BinaryOperationType::multiply);
+    ok = ok && testing::IsEqual(model.ComputeOutput(product->output), std::vector<double>{ 5, 14, 27 });
+
+    // So does reconnecting an input
+    model::ModelEditor::ResetInputPort(&product->input1, in->output);
+    ok = ok && testing::IsEqual(model.ComputeOutput(product->output), std::vector<double>{ 4, 10, 18 });
+
+    testing::ProcessTest("Testing repeated model compute", ok);
+}
+
+void TestParallelModelCompute()
+{
+    // Independent branches that are joined at the end, and a node large enough to be split across threads
+    const size_t size = 1 << 17;
+    model::Model model;
+    auto in = model.AddNode<model::InputNode<double>>(size);
+    std::vector<model::PortElements<double>> branches;
+    for (int branch = 0; branch < 8; ++branch)
+    {
+        auto constant = model.AddNode<nodes::ConstantNode<double>>(std::vector<double>(size, branch));
+        auto product = model.AddNode<nodes::BinaryOperationNode<double>>(in->output, constant->output, nodes::BinaryOperationType::multiply);
+        auto sum = model.AddNode<nodes::BinaryOperationNode<double>>(product->output, in->output, nodes::BinaryOperationType::add);
+        branches.emplace_back(sum->output);
+    }
+    auto out = model.AddNode<model::OutputNode<double>>(model::PortElements<double>(branches));
+
+    std::vector<double> inputValues(size);
+    for (size_t index = 0; index < size; ++index)
+    {
+        inputValues[index] = static_cast<double>(index % 7);
+    }
+    in->SetInput(inputValues);
+
+    auto expected = model.ComputeOutput(out->output);
+    bool ok = expected.size() == 8 * size && testing::IsEqual(expected[3 * size + 5], 5.0 * 4);
+    ok = ok && testing::IsEqual(model.ComputeOutput(out->output, 4), expected);
+    ok = ok && testing::IsEqual(model.ComputeOutput(model::PortElements<double>(out->output, 10, 20), 3), std::vector<double>(expected.begin() + 10, expected.begin() + 30));
+
+    // A chain of nodes, whose large nodes get all the threads
+    auto chainProduct = model.AddNode<nodes::BinaryOperationNode<double>>(in->output, in->output, nodes::BinaryOperationType::multiply);
+    auto chainSum = model.AddNode<nodes::BinaryOperationNode<double>>(chainProduct->output, in->output, nodes::BinaryOperationType::add);
+    auto chainExpected = model.ComputeOutput(chainSum->output);
+    ok = ok && testing::IsEqual(chainExpected[5], 5.0 * 5 + 5) && testing::IsEqual(model.ComputeOutput(chainSum->output, 4), chainExpected);
+
+    // Computing from inside parallel code runs on the calling thread
+    {
+        utilities::ParallelRegion region;
+        ok = ok && testing::IsEqual(model.ComputeOutput(out->output, 4), expected) && testing::IsEqual(model.ComputeOutput(chainSum->output, 4), chainExpected);
+    }
+
+    testing::ProcessTest("Testing parallel model compute", ok);
+}
+
 void TestInputRouting()
 {
     // Create a simple computation model that computes both min and max and concatenates them
@@ -132,5 +132,107 @@ void TestPerformanceCounters()
         auto nodeStats = compiledMap1.GetNodePerformanceCounters(nodeIndex);
         std::cout << "Node [" << nodeIndex << "]: " << nodeInfo->nodeName << " = " << nodeInfo->nodeType << std::endl;
         testing::ProcessTest("ModelProfiler GetNodePerformanceCounters", nodeStats->count == numIter);
+        testing::ProcessTest("ModelProfiler accumulated operation count", nodeStats->totalOperations == static_cast<double>(numIter) * nodeInfo->operationCount);
+        if (std::string(nodeInfo->nodeType) == matrixMultNode->GetRuntimeTypeName())
+        {
+            testing::ProcessTest("ModelProfiler MatrixMatrixMultiplyNode operation count", nodeInfo->operationCount == 2 * m * n * k);
+            testing::ProcessTest("ModelProfiler MatrixMatrixMultiplyNode bytes written", nodeInfo->bytesWritten == static_cast<int64_t>(m * n * sizeof(double)));
+        }
     }
+
+    auto resetStats = compiledMap2.GetNodePerformanceCounters(0);
+    testing::ProcessTest("ModelProfiler ResetNodeProfilingInfo", resetStats->count == 0 && resetStats->totalOperations == 0 && resetStats->totalBytesRead == 0);
+}
+
+void TestSampledPerformanceCounters()
+{
+    model::Model model;
+    int m = 4;
+    int k = 5;
+    int n = 3;
+    int numIter = 5;
+    int samplingInterval = 2;
+
+    auto inputNode = model.AddNode<model::InputNode<double>>(m * k);
+    auto matrix2Node = model.AddNode<nodes::ConstantNode<double>>(GenerateMatrixValues(k, n));
+    auto matrixMultNode = model.AddNode<nodes::MatrixMatrixMultiplyNode<double>>(inputNode->output, m, n, k, k, matrix2Node->output, n, n);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", matrixMultNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.profile = true;
+    settings.compilerSettings.profileSamplingInterval = samplingInterval;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    for (int iter = 0; iter < numIter; ++iter)
+    {
+        compiledMap.SetInputValue(0, GenerateMatrixValues(m, k));
+        compiledMap.ComputeOutput<double>(0);
+    }
+
+    // Calls 0, 2 and 4 are sampled
+    int expectedCount = (numIter + samplingInterval - 1) / samplingInterval;
+    testing::ProcessTest("Sampled ModelProfiler model count", compiledMap.GetModelPerformanceCounters()->count == expectedCount);
+
+    bool nodeCountsOk = true;
+    for (int nodeIndex = 0; nodeIndex < compiledMap.GetNumProfiledNodes(); ++nodeIndex)
+    {
+        auto nodeInfo = compiledMap.GetNodeInfo(nodeIndex);
+        auto nodeStats = compiledMap.GetNodePerformanceCounters(nodeIndex);
+        nodeCountsOk = nodeCountsOk && nodeStats->count == expectedCount && nodeStats->totalOperations == static_cast<double>(expectedCount) * nodeInfo->operationCount;
+    }
+    testing::ProcessTest("Sampled ModelProfiler node counts", nodeCountsOk);
+}
+
+void TestLatencyHistograms()
+{
+    model::Model model;
+    int m = 8;
+    int k = 10;
+    int n = 6;
+    int numIter = 10;
+
+    auto inputNode = model.AddNode<model::InputNode<double>>(m * k);
+    auto matrix2Node = model.AddNode<nodes::ConstantNode<double>>(GenerateMatrixValues(k, n));
+    auto matrixMultNode = model.AddNode<nodes::MatrixMatrixMultiplyNode<double>>(inputNode->output, m, n, k, k, matrix2Node->output, n, n);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", matrixMultNode->output } });
+
+    model::MapCompilerOptions settings;
+    settings.profile = true;
+    settings.compilerSettings.profileLatencyHistograms = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    for (int iter = 0; iter < numIter; ++iter)
+    {
+        compiledMap.SetInputValue(0, GenerateMatrixValues(m, k));
+        compiledMap.ComputeOutput<double>(0);
+    }
+
+    auto isConsistent = [](const model::LatencyStatistics& latency, double averageTime) {
+        return latency.p50 <= latency.p90 && latency.p90 <= latency.p99 && latency.p99 <= latency.maxTime && averageTime <= latency.maxTime;
+    };
+
+    auto modelCounters = compiledMap.GetModelPerformanceCounters();
+    auto modelLatency = *compiledMap.GetModelLatencyStatistics();
+    testing::ProcessTest("LatencyStatistics model count", modelLatency.count == numIter);
+    testing::ProcessTest("LatencyStatistics model percentiles", modelLatency.maxTime > 0 && isConsistent(modelLatency, modelCounters->totalTime / modelCounters->count));
+
+    bool nodesOk = true;
+    for (int nodeIndex = 0; nodeIndex < compiledMap.GetNumProfiledNodes(); ++nodeIndex)
+    {
+        auto nodeCounters = compiledMap.GetNodePerformanceCounters(nodeIndex);
+        auto nodeLatency = *compiledMap.GetNodeLatencyStatistics(nodeIndex);
+        nodesOk = nodesOk && nodeLatency.count == numIter && isConsistent(nodeLatency, nodeCounters->totalTime / nodeCounters->count);
+    }
+    testing::ProcessTest("LatencyStatistics node percentiles", nodesOk);
+
+    compiledMap.PrintModelLatencyInfo();
+    compiledMap.PrintNodeLatencyInfo();
+
+    compiledMap.ResetModelProfilingInfo();
+    auto resetLatency = *compiledMap.GetModelLatencyStatistics();
+    testing::ProcessTest("LatencyStatistics reset", resetLatency.count == 0 && resetLatency.p99 == 0 && resetLatency.maxTime == 0);
 }
@@ -11,6 +11,7 @@
 //
 
 #include "Map_test.h"
+#include "MemoryPlanner_test.h"
 #include "Metadata_test.h"
 #include "ModelBuilder_test.h"
 #include "ModelOptimizerOptions_test.h"
@@ -36,6 +37,10 @@ int main()
         TestNodeIterator();
         TestReverseNodeIterator();
         TestModelSerialization();
+        TestLargeModelSerialization();
+        TestModelAdjacency();
+        TestRepeatedModelCompute();
+        TestParallelModelCompute();
         TestInputRouting();
 
         TestDeepCopyModel();
@@ -54,8 +59,10 @@ int main()
         TestMapCompute();
         TestMapComputeDataVector();
         TestMapRefine();
+        TestMapRefineWithCache();
         TestMapSerialization();
         TestMapClockNode();
+        TestMergeMaps();
 
         TestCustomRefine();
 
@@ -96,6 +103,9 @@ int main()
 
         // ModelOptimizerOptions tests
         TestModelOptimizerOptions();
+
+        // MemoryPlanner tests
+        TestMemoryPlanner();
     }
     catch (const utilities::Exception& exception)
     {
@@ -45,9 +45,30 @@ void TestIRCompiler()
     TestCompileIsEqual();
     TestSimpleMap(false);
     TestSimpleMap(true);
+    TestBatchPredictFunction();
+    TestMergedMapPredictFunctions();
     TestCompiledMapMove();
     TestCompiledMapClone();
+    TestJitCache();
+    TestJitCacheKeys();
+    TestMemoryPlanning();
+    TestMemoryAwareScheduling();
+    TestPortAliasing();
+    TestParallelOptimization();
+    TestParallelBranches();
+    TestEarlyExit();
+    TestCpuDispatch();
+    TestLargeBufferPlacement();
+    TestWeightPrefetching();
+    TestReentrantMap();
+    TestExternalWeightsMap();
+    TestFootprintReport();
+    TestTieredCompilation();
+    TestLazyCompilation();
+    TestDynamicInputExtent();
+    TestSharedNodeFunctions();
     TestCompiledMapParallelClone();
+    TestPipelinedMap();
 
     TestBinaryScalar();
     TestBinaryVector(true);
@@ -65,6 +86,8 @@ void TestIRCompiler()
     TestDotProductOutput();
     TestLinearPredictor<double>();
     TestLinearPredictor<float>();
+    TestSparseLinearPredictor<double>();
+    TestSparseLinearPredictor<float>();
     // TestMultiplexer(); // FAILS -- crash
     // TestForest(); // FAILS -- crash
     TestMatrixVectorMultiplyNode(10, 5, true);
@@ -92,6 +115,28 @@ void TestIRCompiler()
     TestOrderedMatrixMatrixMultiplyNode(4, 5, 6, false, true, true, false);
     TestOrderedMatrixMatrixMultiplyNode(4, 5, 6, true, true, true, false);
 
+    // Blocked GEMM with several blocks
+    TestBlockedMatrixMatrixMultiplyNode(37, 45, 29, false, false, false, false);
+    TestBlockedMatrixMatrixMultiplyNode(37, 45, 29, false, false, false, true);
+    TestBlockedMatrixMatrixMultiplyNode(37, 45, 29, true, false, true, true);
+    TestBlockedMatrixMatrixMultiplyNode(37, 45, 29, false, true, true, true);
+    TestBlockedMatrixMatrixMultiplyNode(37, 45, 29, true, true, true, true);
+    TestBlockedMatrixMatrixMultiplyNode(37, 45, 29, true, true, true, false);
+    TestSmallMatrixMultiplyNodes(false, false);
+    TestSmallMatrixMultiplyNodes(true, true);
+    TestGpuMatrixMatrixMultiplyNode(false, false);
+    TestGpuMatrixMatrixMultiplyNode(true, true);
+
+    for (auto storageType : { emitters::WeightStorageType::float16, emitters::WeightStorageType::bfloat16 })
+    {
+        TestReducedPrecisionWeights(storageType, false, false);
+        TestReducedPrecisionWeights(storageType, true, false);
+        TestReducedPrecisionWeights(storageType, false, true);
+        TestReducedPrecisionWeights(storageType, true, true);
+        TestReducedPrecisionConvolutionWeights(storageType, false);
+        TestReducedPrecisionConvolutionWeights(storageType, true);
+    }
+
     // TestMatrixMatrixMultiplyNode(15, 25600, 27, false); // Fails due to numerical  issues
 
     TestCompilableScalarOutputNode();
@@ -99,10 +144,17 @@ void TestIRCompiler()
     TestCompilableAccumulatorNode();
     TestCompilableDotProductNode();
     TestCompilableDelayNode();
+    TestCompilableMovingAverageNode();
+    TestCompilableMovingVarianceNode();
+    TestCompilableMovingStatisticsLongStream();
+    TestCompilableStatefulNodesReset();
     TestCompilableDTWDistanceNode();
+    TestCompilableMultiPrototypeDTWDistanceNode();
     TestCompilableMulticlassDTW();
     TestCompilableScalarSumNode();
     TestCompilableSumNode();
+    TestCompilableReductionNodes();
+    TestCompilableTopKNode();
     TestCompilableUnaryOperationNode();
     TestCompilableBinaryOperationNode();
     TestCompilableBinaryOperationNode2();
@@ -122,10 +174,17 @@ void TestIRCompiler()
     TestCompilableAccumulatorNodeFunction();
     TestCompilableSourceNode();
     TestCompilableSinkNode();
+    TestCompilableAsyncSourceSinkNodes();
     TestCompilableClockNode();
+    TestCompilableClockNodeDropStaleTicks();
     TestCompilableFFTNode();
+    TestCompilableDCTNode(40, 13); // DCT matrix
+    TestCompilableDCTNode(64, 64); // FFT
+    TestCompilableDCTNode(128, 40); // truncated FFT
 
     TestPerformanceCounters();
+    TestSampledPerformanceCounters();
+    TestLatencyHistograms();
     TestCompilableDotProductNode2<float>(3); // uses IR
     TestCompilableDotProductNode2<double>(3); // uses IR
     TestCompilableDotProductNode2<float>(4); // uses IR
@@ -192,6 +251,7 @@ void TestIRCompiler()
     TestMeanPoolingLayerNode(8, 8, 16, 6, 6, 3, 1, 0, 0);
     TestMeanPoolingLayerNode(8, 8, 16, 6, 6, 3, 1, 0, 1);
     TestMeanPoolingLayerNode(8, 8, 16, 6, 6, 3, 1, 0, 2);
+    TestMeanPoolingLayerNode(7, 7, 16, 1, 1, 7, 1, 0, 0); // global average pooling
     // TestMeanPoolingLayerNode(8, 8, 16, 6, 6, 3, 1, 1, 0);
 
     // TestMeanPoolingLayerNode(8, 8, 16, 2, 1, 2, 1, 0, 0);
@@ -239,6 +299,7 @@ void TestIRCompiler()
     TestMultiSourceSinkMap();
 
     TestRegionDetectionNode();
+    TestRegionDetectionPostProcessingNode();
 
     TestMatrixVectorProductNodeCompile();
 
@@ -22,6 +22,7 @@
 #include <utilities/include/IArchivable.h>
 #include <utilities/include/TypeName.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -57,6 +58,9 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Resets the state of the node </summary>
+        void Reset() override;
+
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
@@ -124,6 +128,12 @@ namespace nodes
         _output.SetOutput(_accumulator);
     };
 
+    template <typename ValueType>
+    void AccumulatorNode<ValueType>::Reset()
+    {
+        std::fill(_accumulator.begin(), _accumulator.end(), static_cast<ValueType>(0));
+    }
+
     template <typename ValueType>
     void AccumulatorNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
@@ -150,6 +160,13 @@ namespace nodes
         {
             CompileExpanded(compiler, function, accumulator);
         }
+
+        // Add the internal reset function, which sets the sum back to zero
+        auto& module = function.GetModule();
+        std::string resetFunctionName = compiler.GetGlobalName(*this, "AccumulatorNodeReset");
+        emitters::IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionName);
+        resetFunction.MemorySet<ValueType>(accumulator, 0, resetFunction.Literal<uint8_t>(0), static_cast<int>(output.Size()));
+        module.EndResetFunction();
     }
 
     template <typename ValueType>
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     AudioFrontEndNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <dsp/include/FFT.h>
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/Node.h>
+#include <model/include/OutputPort.h>
+
+#include <utilities/include/TypeName.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary> The stages of an AudioFrontEndNode. A stage with no parameters is skipped. </summary>
+    struct AudioFrontEndParameters
+    {
+        /// <summary> The window to multiply the input by, or empty for no window. </summary>
+        std::vector<double> window;
+
+        /// <summary> The FFT size, a power of 2. The input is truncated or zero-padded to this size. </summary>
+        size_t fftSize = 0;
+
+        /// <summary> If true, the filters are applied to the power spectrum divided by `powerDivisor` instead of to the magnitudes. </summary>
+        bool powerSpectrum = false;
+        double powerDivisor = 1;
+
+        /// <summary> The filters applied to the fftSize/2 bins of the spectrum: the first bin and the number of coefficients of each filter, and the coefficients of all the filters end to end. </summary>
+        std::vector<int> filterStarts;
+        std::vector<int> filterSizes;
+        std::vector<double> filterCoefficients;
+
+        /// <summary> The offset added to each filter output before taking its log, or empty for no log. </summary>
+        std::vector<double> logOffsets;
+
+        /// <summary> The number of DCT coefficients of the filter outputs to compute, or 0 for no DCT. </summary>
+        size_t numDCTCoefficients = 0;
+    };
+
+    /// <summary>
+    /// A node that computes the features of an audio frame in one pass: window, FFT, magnitude or power spectrum,
+    /// filter bank, log and DCT, as the HammingWindowNode, FFTNode, UnaryOperationNode, FilterBankNode and DCTNode
+    /// chain of a featurizer does. The compiled code keeps the spectrum in a single scratch buffer, applies the window
+    /// while loading the FFT input and computes only the spectrum bins the filters read.
+    /// </summary>
+    template <typename ValueType>
+    class AudioFrontEndNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        AudioFrontEndNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The audio frame to process. </param>
+        /// <param name="parameters"> The parameters of the stages. </param>
+        AudioFrontEndNode(const model::OutputPort<ValueType>& input, const AudioFrontEndParameters& parameters);
+
+        /// <summary> Gets the parameters of the stages. </summary>
+        const AudioFrontEndParameters& GetParameters() const { return _parameters; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("AudioFrontEndNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // Stored state: parameters
+        bool CanShareNodeFunction() const override { return true; }
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+        void Initialize();
+
+        model::InputPort<ValueType> _input;
+        model::OutputPort<ValueType> _output;
+
+        AudioFrontEndParameters _parameters;
+        dsp::FFTPlan<ValueType> _plan;
+        std::vector<ValueType> _dctMatrix; // numDCTCoefficients rows of one coefficient per filter
+        int _lowBin = 0; // the range of spectrum bins the filters read
+        int _highBin = 0;
+    };
+
+    extern template class AudioFrontEndNode<float>;
+    extern template class AudioFrontEndNode<double>;
+} // namespace nodes
+} // namespace ell
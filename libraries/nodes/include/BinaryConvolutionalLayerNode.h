@@ -110,6 +110,9 @@ namespace nodes
         /// <summary> Gets information about the output memory layout </summary>
         model::PortMemoryLayout GetOutputMemoryLayout() const { return _outputMemoryLayout; }
 
+        /// <summary> Gets the convolutional parameters the input is unrolled for </summary>
+        const predictors::neural::BinaryConvolutionalParameters& GetConvolutionalParameters() const { return _convolutionalParameters; }
+
         /// <summary> Returns true if the node can accept input with this memory layout order, else false </summary>
         ///
         /// <param name="order"> The memory layout order for all the input ports </summary>
@@ -244,6 +247,8 @@ namespace nodes
                                  emitters::LLVMValue pInputPaddingMaskSums,
                                  emitters::LLVMValue pOutput,
                                  emitters::LLVMValue filterIndex,
+                                 emitters::LLVMValue columnBegin,
+                                 emitters::LLVMValue columnEnd,
                                  bool hasZeroPadding,
                                  int outputColumns,
                                  int packedRowSize,
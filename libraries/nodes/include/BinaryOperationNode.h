@@ -26,6 +26,7 @@
 #include <utilities/include/IArchivable.h>
 #include <utilities/include/TypeName.h>
 
+#include <algorithm>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -107,6 +108,21 @@ namespace nodes
         /// <returns> The operation </returns>
         BinaryOperationType GetOperation() const { return _operation; }
 
+        /// <summary> Gets the memory layout of the left-hand input </summary>
+        const model::PortMemoryLayout& GetInputMemoryLayout1() const { return _inputLayout1; }
+
+        /// <summary> Gets the memory layout of the right-hand input </summary>
+        const model::PortMemoryLayout& GetInputMemoryLayout2() const { return _inputLayout2; }
+
+        /// <summary> Gets the memory layout of the output </summary>
+        model::PortMemoryLayout GetOutputMemoryLayout() const { return _output.GetMemoryLayout(); }
+
+        /// <summary> Gets the padding value written to the output </summary>
+        ValueType GetOutputPadding() const { return _paddingValue; }
+
+        /// <summary> Element-by-element operations on inputs of the same size can stop after a dynamic extent </summary>
+        bool SupportsDynamicExtent() const override { return _inputLayout1.GetMemorySize() == _inputLayout2.GetMemorySize(); }
+
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
@@ -115,6 +131,7 @@ namespace nodes
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; } // stored state: operation
+        bool CanShareNodeFunction() const override { return true; }
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
@@ -131,10 +148,14 @@ namespace nodes
                                       emitters::LLVMValue prevInput2DimensionOffset,
                                       emitters::LLVMValue prevOutputDimensionOffset) const;
         template <typename Operation>
-        std::vector<ValueType> ComputeOutput(Operation&& function) const;
+        void ComputeOutput(Operation&& function) const;
         template <typename Operation>
         void ComputeDimensionLoop(Operation& function,
                                   size_t dimension,
+                                  int beginIndex,
+                                  int endIndex,
+                                  const std::vector<ValueType>& input1,
+                                  const std::vector<ValueType>& input2,
                                   std::vector<ValueType>& output,
                                   size_t prevInput1DimensionOffset,
                                   size_t prevInput2DimensionOffset,
@@ -394,51 +415,65 @@ namespace nodes
 
     template <typename ValueType>
     template <typename Operation>
-    std::vector<ValueType> BinaryOperationNode<ValueType>::ComputeOutput(Operation&& function) const
+    void BinaryOperationNode<ValueType>::ComputeOutput(Operation&& function) const
     {
-        auto outputLayout = _output.GetMemoryLayout();
-        auto outputSize = outputLayout.GetExtent().NumElements();
-        auto output = std::vector<ValueType>(outputSize);
+        // The output is written in place, and only its active area is written, so its padding keeps the zeros
+        // it was allocated with
+        const auto& input1 = _input1.GetValueReference();
+        const auto& input2 = _input2.GetValueReference();
+        auto& output = _output.GetOutputBuffer();
 
         const size_t prevInput1Offset = 0;
         const size_t prevInput2Offset = 0;
         const size_t prevOutputOffset = 0;
-        ComputeDimensionLoop(function, 0, output, prevInput1Offset, prevInput2Offset, prevOutputOffset);
+        const auto outerSize = static_cast<size_t>(_inputLayout1.GetActiveSize()[0]);
+        auto computeRows = [&](size_t begin, size_t end) {
+            ComputeDimensionLoop(function, 0, static_cast<int>(begin), static_cast<int>(end), input1, input2, output, prevInput1Offset, prevInput2Offset, prevOutputOffset);
+        };
 
-        return output;
+        // The bits of a std::vector<bool> can't be written from several threads
+        if constexpr (std::is_same_v<ValueType, bool>)
+        {
+            computeRows(0, outerSize);
+        }
+        else
+        {
+            // Split the outermost dimension into blocks of at least minElementsPerBlock elements
+            const size_t minElementsPerBlock = 1 << 15;
+            const auto elementsPerRow = std::max(static_cast<size_t>(_inputLayout1.GetActiveSize().NumElements()) / std::max(outerSize, size_t{ 1 }), size_t{ 1 });
+            ComputeInBlocks(outerSize, (minElementsPerBlock + elementsPerRow - 1) / elementsPerRow, computeRows);
+        }
     }
 
     template <typename ValueType>
     void BinaryOperationNode<ValueType>::Compute() const
     {
-        std::vector<ValueType> output;
         switch (_operation)
         {
         case BinaryOperationType::add:
-            output = ComputeOutput(BinaryOperations::Add<ValueType>);
+            ComputeOutput(BinaryOperations::Add<ValueType>);
             break;
         case BinaryOperationType::subtract:
-            output = ComputeOutput(BinaryOperations::Subtract<ValueType>);
+            ComputeOutput(BinaryOperations::Subtract<ValueType>);
             break;
         case BinaryOperationType::multiply:
-            output = ComputeOutput(BinaryOperations::Multiply<ValueType>);
+            ComputeOutput(BinaryOperations::Multiply<ValueType>);
             break;
         case BinaryOperationType::divide:
-            output = ComputeOutput(BinaryOperations::Divide<ValueType>);
+            ComputeOutput(BinaryOperations::Divide<ValueType>);
             break;
         case BinaryOperationType::logicalAnd:
-            output = ComputeOutput(BinaryOperations::LogicalAnd<ValueType>);
+            ComputeOutput(BinaryOperations::LogicalAnd<ValueType>);
             break;
         case BinaryOperationType::logicalOr:
-            output = ComputeOutput(BinaryOperations::LogicalOr<ValueType>);
+            ComputeOutput(BinaryOperations::LogicalOr<ValueType>);
             break;
         case BinaryOperationType::logicalXor:
-            output = ComputeOutput(BinaryOperations::LogicalXor<ValueType>);
+            ComputeOutput(BinaryOperations::LogicalXor<ValueType>);
             break;
         default:
             throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "Unknown operation type");
         }
-        _output.SetOutput(output);
     };
 
     template <typename ValueType>
@@ -456,7 +491,7 @@ namespace nodes
     {
         if (_inputLayout1.GetMemorySize() == _inputLayout2.GetMemorySize())
         {
-            if (!function.GetCompilerOptions().unrollLoops)
+            if (!function.GetCompilerOptions().unrollLoops || compiler.HasDynamicExtent(*this))
             {
                 CompileLoop(compiler, function);
             }
@@ -487,9 +522,20 @@ namespace nodes
         emitters::LLVMValue pResult = compiler.EnsurePortEmitted(output);
 
         auto count = input1.Size();
-        function.VectorOperator(emitters::GetOperator<ValueType>(ToEmitterType(GetOperation())), count, pInput1, pInput2, [&pResult, &function](emitters::LLVMValue i, emitters::LLVMValue pValue) {
+        auto setResult = [&pResult, &function](emitters::LLVMValue i, emitters::LLVMValue pValue) {
             function.SetValueAt(pResult, i, pValue);
-        });
+        };
+        if (auto extent = compiler.GetDynamicExtent(output, function))
+        {
+            // Only compute the first `extent` entries along the outermost dimension
+            auto entriesPerExtent = static_cast<int>(count) / output.GetMemoryLayout().GetActiveSize(0);
+            auto dynamicCount = function.Operator(emitters::TypedOperator::multiply, extent, function.Literal<int>(entriesPerExtent));
+            function.VectorOperator(emitters::GetOperator<ValueType>(ToEmitterType(GetOperation())), dynamicCount, pInput1, pInput2, setResult);
+        }
+        else
+        {
+            function.VectorOperator(emitters::GetOperator<ValueType>(ToEmitterType(GetOperation())), count, pInput1, pInput2, setResult);
+        }
     }
 
     template <typename ValueType>
@@ -532,6 +578,10 @@ namespace nodes
     template <typename Operation>
     void BinaryOperationNode<ValueType>::ComputeDimensionLoop(Operation& function,
                                                               size_t dimension,
+                                                              int beginIndex,
+                                                              int endIndex,
+                                                              const std::vector<ValueType>& input1,
+                                                              const std::vector<ValueType>& input2,
                                                               std::vector<ValueType>& output,
                                                               size_t prevInput1DimensionOffset,
                                                               size_t prevInput2DimensionOffset,
@@ -547,7 +597,7 @@ namespace nodes
         auto&& outputOffset = outputLayout.GetOffset();
         auto&& outputStride = outputLayout.GetExtent();
 
-        for (int loopIndex = 0; loopIndex < inputSize[dimension]; ++loopIndex)
+        for (int loopIndex = beginIndex; loopIndex < endIndex; ++loopIndex)
         {
             // offset within start of this dimension = (loopIndex + offset[dimension])
             auto thisInput1DimensionInternalOffset = loopIndex + inputOffset1[dimension];
@@ -567,13 +617,13 @@ namespace nodes
             if (static_cast<int>(dimension) < numDimensions - 1)
             {
                 // Recursive call to emit nested loop
-                ComputeDimensionLoop(function, dimension + 1, output, thisInput1DimensionOffset, thisInput2DimensionOffset, thisOutputDimensionOffset);
+                ComputeDimensionLoop(function, dimension + 1, 0, inputSize[dimension + 1], input1, input2, output, thisInput1DimensionOffset, thisInput2DimensionOffset, thisOutputDimensionOffset);
             }
             else
             {
                 // We're in the innermost loop --- compute the value
-                auto value1 = _input1[thisInput1DimensionOffset];
-                auto value2 = _input2[thisInput2DimensionOffset];
+                auto value1 = input1[thisInput1DimensionOffset];
+                auto value2 = input2[thisInput2DimensionOffset];
                 auto outputValue = function(value1, value2);
                 output[thisOutputDimensionOffset] = outputValue;
             }
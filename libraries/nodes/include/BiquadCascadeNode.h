@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BiquadCascadeNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <dsp/include/BiquadCascade.h>
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/Node.h>
+#include <model/include/OutputPort.h>
+
+#include <utilities/include/TypeName.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A node that applies a cascade of second-order IIR sections to several channels (see `dsp::BiquadCascade`).
+    /// The input is one or more frames of interleaved samples, one per channel. The compiled code filters all the
+    /// channels of a frame in one loop, which is vectorized across the channels when vector instructions are allowed.
+    /// </summary>
+    template <typename ValueType>
+    class BiquadCascadeNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        BiquadCascadeNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The signal to process, as interleaved frames. Its size must be a multiple of the number of channels. </param>
+        /// <param name="sections"> The second-order sections, in the order the signal goes through them. </param>
+        /// <param name="numChannels"> The number of channels. </param>
+        BiquadCascadeNode(const model::OutputPort<ValueType>& input, const std::vector<dsp::BiquadSection<ValueType>>& sections, size_t numChannels);
+
+        /// <summary> Gets the filter. </summary>
+        ///
+        /// <returns> The filter. </returns>
+        const dsp::BiquadCascade<ValueType>& GetFilter() const { return _filter; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("BiquadCascadeNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // Stored state: filter coefficients and the state of each section
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        // Inputs
+        model::InputPort<ValueType> _input;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        mutable dsp::BiquadCascade<ValueType> _filter;
+    };
+
+    //
+    // Explicit instantiation declarations
+    //
+    extern template class BiquadCascadeNode<float>;
+    extern template class BiquadCascadeNode<double>;
+} // namespace nodes
+} // namespace ell
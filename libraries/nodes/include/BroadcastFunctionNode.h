@@ -247,6 +247,7 @@ namespace nodes
 
         size_t GetBroadcastDimension() const { return _broadcastDimension; }
         size_t NumPrimaryInputDimensions() const { return GetInputMemoryLayout().NumDimensions(); }
+        ValueType GetOutputPadding() const { return _paddingValue; }
 
     protected:
         BroadcastFunctionNode(const std::vector<model::InputPortBase*>& inputs, const std::vector<model::OutputPortBase*>& outputs);
@@ -278,8 +279,6 @@ namespace nodes
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
 
-        ValueType GetOutputPadding() const { return _paddingValue; }
-
     private:
         model::PortMemoryLayout _inputLayout;
         size_t _broadcastDimension = 0;
@@ -334,10 +333,9 @@ namespace nodes
         using BroadcastFunctionNode<ValueType, FunctionType>::GetOutputMemoryLayout;
         using BroadcastFunctionNode<ValueType, FunctionType>::GetBroadcastDimension;
         using BroadcastFunctionNode<ValueType, FunctionType>::NumPrimaryInputDimensions;
-
-    protected:
         using BroadcastFunctionNode<ValueType, FunctionType>::GetFunction;
 
+    protected:
         utilities::ArchiveVersion GetArchiveVersion() const override;
         bool CanReadArchiveVersion(const utilities::ArchiveVersion& version) const override;
         void WriteToArchive(utilities::Archiver& archiver) const override;
@@ -886,7 +884,7 @@ namespace nodes
                 for (int index = 0; index < numSecondaryInputs; ++index)
                 {
                     auto&& secondaryInput = secondaryInputs[index];
-                    secondaryValues[index] = this->IsSecondaryInputPresent(index) ? function.ValueAt(secondaryInput, loopIndex) : nullptr;
+                    secondaryValues[index] = this->IsSecondaryInputPresent(index) ? function.WeightValueAt<ValueType>(secondaryInput, loopIndex) : nullptr;
                 }
             }
 
@@ -960,7 +958,7 @@ namespace nodes
         {
             auto secondaryInputPort = GetSecondaryInput(index);
             auto secondaryInputSize = secondaryInputPort->Size();
-            emitters::LLVMValue secondaryInput = (secondaryInputSize > 0) ? compiler.EnsurePortEmitted(*secondaryInputPort) : function.NullPointer(valuePtrType);
+            emitters::LLVMValue secondaryInput = (secondaryInputSize > 0) ? EnsureWeightsEmitted(compiler, function, *secondaryInputPort) : function.NullPointer(valuePtrType);
             secondaryInputs.push_back(secondaryInput);
             secondaryValues.push_back(nullptr);
         }
@@ -85,6 +85,7 @@ namespace nodes
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
 
         bool HasState() const override { return true; } // stored state: function and padding value
+        bool CanShareNodeFunction() const override { return true; }
 
     protected:
         void WriteToArchive(utilities::Archiver& archiver) const override;
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <emitters/include/IRMath.h>
+
 #include <model/include/CompilableNode.h>
 #include <model/include/IRMapCompiler.h>
 #include <model/include/InputPort.h>
@@ -18,6 +20,7 @@
 #include <utilities/include/IArchivable.h>
 #include <utilities/include/TypeName.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -31,6 +34,10 @@ namespace nodes
     /// of the buffer node will be [0 i1], [i1 i2], [i2, i3], [i3 i4].  So if you think of the input as a 
     /// series of values over time (like audio signal) then the BufferNode provides a sliding window over that
     /// input data.
+    ///
+    /// The compiled node keeps the window in a ring buffer, so only the new input is written on each call. The
+    /// output port is still a flat array that the downstream nodes index directly, so the window is copied out of
+    /// the ring, oldest value first, on every call.
     /// </summary>
     template <typename ValueType>
     class BufferNode : public model::CompilableNode
@@ -60,6 +67,9 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Resets the state of the node </summary>
+        void Reset() override;
+
         /// <summary> Return the window size </summary>
         ///
         /// <returns> The window size </returns>
@@ -135,6 +145,12 @@ namespace nodes
         _output.SetOutput(_samples);
     };
 
+    template <typename ValueType>
+    void BufferNode<ValueType>::Reset()
+    {
+        std::fill(_samples.begin(), _samples.end(), static_cast<ValueType>(0));
+    }
+
     template <typename ValueType>
     void BufferNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
@@ -152,24 +168,50 @@ namespace nodes
         {
             inputSize = windowSize;
         }
-        auto offset = windowSize - inputSize;
-       
+
         emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+        if (inputSize == windowSize)
+        {
+            // The window is just the latest input
+            function.MemoryCopy<ValueType>(pInput, 0, pOutput, 0, windowSize);
+            return;
+        }
+
         auto bufferVar = function.GetModule().Variables().AddVectorVariable<ValueType>(emitters::VariableScope::global, windowSize);
         function.GetModule().AllocateVariable(*bufferVar);
         emitters::LLVMValue buffer = function.GetModule().EnsureEmitted(*bufferVar);
 
-        if (offset > 0)
+        // The buffer is a ring whose oldest value is at `head`. The new input overwrites the oldest values, so
+        // nothing is shifted, and the window is copied out in two pieces: from `head` to the end, then the start.
+        auto headVar = function.GetModule().Global<int>(compiler.GetGlobalName(*this, "head"), 0);
+        auto head = function.LocalScalar(function.Load(headVar));
+        auto zero = function.LocalScalar<int>(0);
+        if (windowSize % inputSize == 0)
         {
-            // shift the buffer left by the input size to make room for new input
-            function.MemoryMove<ValueType>(buffer, inputSize, 0, offset);
+            // The input never wraps around the end of the ring
+            function.MemoryCopy<ValueType>(pInput, zero, buffer, head, function.LocalScalar<int>(inputSize));
         }
-        // Copy input to right hand side of the buffer
-        function.MemoryCopy<ValueType>(pInput, 0, buffer, offset, inputSize);
-
-        // Copy to output
-        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
-        function.MemoryCopy<ValueType>(buffer, 0, pOutput, 0, windowSize);
+        else
+        {
+            auto firstCount = emitters::Min(windowSize - head, inputSize);
+            function.MemoryCopy<ValueType>(pInput, zero, buffer, head, firstCount);
+            function.MemoryCopy<ValueType>(pInput, firstCount, buffer, zero, inputSize - firstCount);
+        }
+        auto newHead = (head + inputSize) % windowSize;
+        function.Store(headVar, newHead);
+
+        // Copy the window, oldest value first, to the output
+        function.MemoryCopy<ValueType>(buffer, newHead, pOutput, zero, windowSize - newHead);
+        function.MemoryCopy<ValueType>(buffer, zero, pOutput, windowSize - newHead, newHead);
+
+        // Add the internal reset function, which empties the window
+        auto& module = function.GetModule();
+        std::string resetFunctionName = compiler.GetGlobalName(*this, "BufferNodeReset");
+        emitters::IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionName);
+        resetFunction.MemorySet<ValueType>(buffer, 0, resetFunction.Literal<uint8_t>(0), windowSize);
+        resetFunction.Store(headVar, resetFunction.Literal<int>(0));
+        module.EndResetFunction();
     }
 
     template <typename ValueType>
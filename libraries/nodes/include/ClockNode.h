@@ -11,6 +11,9 @@
 #include <model/include/CompilableNode.h>
 #include <model/include/ModelTransformer.h>
 
+#include <array>
+#include <cstdint>
+
 namespace ell
 {
 namespace nodes
@@ -20,6 +23,21 @@ namespace nodes
     /// <summary> A function that the node calls if the timestamp lags too far behind an interval. </summary>
     using LagNotificationFunction = std::function<void(TimeTickType)>;
 
+    /// <summary>
+    /// How well a model driven by a ClockNode keeps up with its interval. A tick's lateness is the time between the
+    /// interval it samples and the current time, and its slack is the time left before the next interval is due
+    /// (the interval minus the lateness). A tick misses its deadline when its slack is negative.
+    /// </summary>
+    struct ClockDeadlineTelemetry
+    {
+        static constexpr int numLatenessBuckets = 6;
+
+        TimeTickType lastSlack = 0; // the slack of the last tick
+        int64_t missedDeadlineCount = 0; // the ticks with negative slack
+        int64_t droppedTickCount = 0; // the intervals skipped when stale ticks are dropped
+        std::array<int64_t, numLatenessBuckets> latenessHistogram = {}; // ticks by lateness, in intervals: < 1/4, < 1/2, < 1, < 2, < 4, and 4 or more
+    };
+
     /// <summary> A node that verifies if input timestamps are within a specified time interval. </summary>
     class ClockNode : public model::CompilableNode
     {
@@ -39,7 +57,9 @@ namespace nodes
         /// <param name="lagThreshold">The time lag before lagFunction is called. </param>
         /// <param name="functionName">The lag notification name to be emitted. </param>
         /// <param name="function">The optional lag notification function used in Compute(). </param>
-        ClockNode(const model::OutputPort<TimeTickType>& input, TimeTickType interval, TimeTickType lagThreshold, const std::string& functionName, LagNotificationFunction function = nullptr);
+        /// <param name="dropStaleTicks">If true, a tick that is more than an interval late skips to the latest interval that is due,
+        /// instead of catching up one interval per tick, so a streaming model samples its newest input. </param>
+        ClockNode(const model::OutputPort<TimeTickType>& input, TimeTickType interval, TimeTickType lagThreshold, const std::string& functionName, LagNotificationFunction function = nullptr, bool dropStaleTicks = false);
 
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
@@ -73,6 +93,14 @@ namespace nodes
         /// <returns> Ticks until the next interval. </param>
         TimeTickType GetTicksUntilNextInterval(TimeTickType now) const;
 
+        /// <summary> Indicates if a tick that is more than an interval late skips the intervals in between. </summary>
+        bool DropsStaleTicks() const { return _dropStaleTicks; }
+
+        /// <summary> Gets the deadline telemetry of the ticks computed so far. The compiled model has its own, read
+        /// with the exported `GetLastSlack`, `GetMissedDeadlineCount`, `GetDroppedTickCount` and `GetLatenessHistogram`
+        /// functions, and cleared with `ResetDeadlineTelemetry`. </summary>
+        const ClockDeadlineTelemetry& GetDeadlineTelemetry() const { return _telemetry; }
+
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
@@ -81,6 +109,7 @@ namespace nodes
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
 
         bool HasState() const override { return true; } // stored state: interval, lag threshold, lag function name
+        bool CanComputeConcurrently() const override { return false; } // calls the lag notification
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
@@ -88,6 +117,7 @@ namespace nodes
         void EmitGetTicksUntilNextIntervalFunction(model::IRMapCompiler& compiler, emitters::IRModuleEmitter& moduleEmitter, llvm::GlobalVariable* pLastIntervalTime);
         void EmitGetLagThresholdFunction(model::IRMapCompiler& compiler, emitters::IRModuleEmitter& moduleEmitter);
         void EmitGetStepIntervalFunction(model::IRMapCompiler& compiler, emitters::IRModuleEmitter& moduleEmitter);
+        void EmitDeadlineTelemetryFunctions(model::IRMapCompiler& compiler, emitters::IRModuleEmitter& moduleEmitter, llvm::GlobalVariable* pLastSlack, llvm::GlobalVariable* pMissedDeadlineCount, llvm::GlobalVariable* pDroppedTickCount, llvm::GlobalVariable* pLatenessHistogram);
 
         model::InputPort<TimeTickType> _input;
         model::OutputPort<TimeTickType> _output;
@@ -97,6 +127,8 @@ namespace nodes
         TimeTickType _lagThreshold;
         LagNotificationFunction _lagNotificationFunction;
         std::string _lagNotificationFunctionName;
+        bool _dropStaleTicks;
+        mutable ClockDeadlineTelemetry _telemetry;
     };
 } // namespace nodes
 } // namespace ell
\ No newline at end of file
@@ -120,25 +120,21 @@ namespace nodes
     {
         assert(GetPortVariableType(_input) == GetPortVariableType(_output));
 
-        auto inputIsInputNode = (dynamic_cast<const model::InputNodeBase*>(_input.GetInputElement(0).ReferencedPort()->GetNode()) != nullptr);
-        // TODO: re-enable this branch when scalar port bug is fixed
-        if (_input.Size() != 1 && _output.Size() != 1 && !inputIsInputNode && false)
+        // If the output has exactly the input's entries, it can share the input's buffer
+        if (_output.Size() == _input.Size() && compiler.TryAliasPort(_output, _input.GetReferencedPort(), 0))
         {
-            auto pVar = compiler.GetVariableForPort(_input.GetReferencedPort());
-            compiler.SetVariableForPort(_output, pVar);
+            return;
         }
-        else
-        {
-            auto input = function.LocalArray(compiler.EnsurePortEmitted(_input));
-            auto output = function.LocalArray(compiler.EnsurePortEmitted(_output));
-            // check if the output variable is null.
-            function.If(ell::emitters::TypedComparison::notEquals, output, function.NullPointer(output.value->getType()->getPointerElementType()->getPointerTo()), [input, output, this](emitters::IRFunctionEmitter& function) {
-                auto size = _input.Size();
-                function.For(size, [input, output](emitters::IRFunctionEmitter& function, auto i) {
-                    output[i] = input[i];
-                });
+
+        auto input = function.LocalArray(compiler.EnsurePortEmitted(_input));
+        auto output = function.LocalArray(compiler.EnsurePortEmitted(_output));
+        // check if the output variable is null.
+        function.If(ell::emitters::TypedComparison::notEquals, output, function.NullPointer(output.value->getType()->getPointerElementType()->getPointerTo()), [input, output, this](emitters::IRFunctionEmitter& function) {
+            auto size = _input.Size();
+            function.For(size, [input, output](emitters::IRFunctionEmitter& function, auto i) {
+                output[i] = input[i];
             });
-        }
+        });
     }
 
     template <typename ValueType>
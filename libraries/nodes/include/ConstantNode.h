@@ -25,6 +25,7 @@
 #include <utilities/include/TypeTraits.h>
 
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace ell
@@ -140,6 +141,37 @@ namespace nodes
     template <typename ValueType, typename ModelLikeType>
     const model::OutputPort<ValueType>& Constant(ModelLikeType& model, const std::vector<ValueType>& value, const model::PortMemoryLayout& layout);
 
+    /// <summary> Emits the data for an input port that holds weights. If the input comes from a `ConstantNode`, the data is
+    /// stored in the format set by that node's `weightStorageType` compiler option, so the weights must be read with
+    /// `IRFunctionEmitter::WeightValueAt` (or `IRFunctionEmitter::WeightsDotProduct` or `IRFunctionEmitter::CallGEMM`). </summary>
+    ///
+    /// <param name="compiler"> The compiler. </param>
+    /// <param name="function"> The function being emitted. </param>
+    /// <param name="weights"> The input port that holds weights. </param>
+    ///
+    /// <returns> A pointer to the weights. </returns>
+    template <typename ValueType>
+    emitters::LLVMValue EnsureWeightsEmitted(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, const model::InputPort<ValueType>& weights);
+
+    /// <summary> Indicates if `EnsureWeightsEmitted` emits the data for an input port as a global array of its own, in a
+    /// reduced-precision format, instead of using the port's buffer. </summary>
+    ///
+    /// <param name="compiler"> The compiler. </param>
+    /// <param name="weights"> The input port that holds weights. </param>
+    template <typename ValueType>
+    bool HasReducedPrecisionWeights(const model::MapCompiler& compiler, const model::InputPort<ValueType>& weights);
+
+    /// <summary> Gets the values of the weights a node reads through an input port, if they're known at compile time
+    /// and may be packed then into the layout of the kernel that reads them (as the "prepackWeights" option allows). </summary>
+    ///
+    /// <param name="compiler"> The compiler. </param>
+    /// <param name="node"> The node that reads the weights. </param>
+    /// <param name="weights"> The input port that holds weights. </param>
+    ///
+    /// <returns> The values of the weights, or `nullptr` if they can't be packed. </returns>
+    template <typename ValueType>
+    const std::vector<ValueType>* GetPrepackableWeights(const model::MapCompiler& compiler, const model::Node& node, const model::InputPort<ValueType>& weights);
+
     /// <summary> Adds a constant node (which represents a constant predictor) to a model transformer. </summary>
     ///
     /// <param name="input"> The input to the predictor, which is ignored. </param>
@@ -208,6 +240,11 @@ namespace nodes
     void ConstantNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
         auto values = this->GetValues();
+        if (compiler.TryPlaceInExternalWeights(output, values))
+        {
+            return;
+        }
+
         emitters::Variable* pVar = nullptr;
         pVar = function.GetModule().Variables().AddVariable<emitters::LiteralVectorVariable<ValueType>>(values);
         compiler.SetVariableForPort(output, pVar); // Just set the variable corresponding to the output port to be the global variable we created
@@ -281,6 +318,54 @@ namespace nodes
         auto node = model.template AddNode<ConstantNode<ValueType>>(values, layout);
         return node->output;
     }
+
+    template <typename ValueType>
+    emitters::LLVMValue EnsureWeightsEmitted(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, const model::InputPort<ValueType>& weights)
+    {
+        if constexpr (std::is_floating_point_v<ValueType>)
+        {
+            // Weights computed by other nodes are stored in ordinary port buffers
+            auto constantNode = dynamic_cast<const ConstantNode<ValueType>*>(weights.GetReferencedPort().GetNode());
+            if (constantNode != nullptr)
+            {
+                auto storageType = compiler.GetMapCompilerOptions(*constantNode).compilerSettings.weightStorageType;
+                if (storageType != emitters::WeightStorageType::float32)
+                {
+                    // A constant may be read by several nodes, which all share a single copy
+                    auto& module = function.GetModule();
+                    auto name = compiler.GetGlobalName(*constantNode, "weights");
+                    if (auto global = module.GetLLVMModule()->getNamedGlobal(name))
+                    {
+                        return global;
+                    }
+                    return module.WeightsArray(name, constantNode->GetValues(), storageType);
+                }
+            }
+        }
+        return compiler.EnsurePortEmitted(weights);
+    }
+
+    template <typename ValueType>
+    bool HasReducedPrecisionWeights(const model::MapCompiler& compiler, const model::InputPort<ValueType>& weights)
+    {
+        if constexpr (std::is_floating_point_v<ValueType>)
+        {
+            auto constantNode = dynamic_cast<const ConstantNode<ValueType>*>(weights.GetReferencedPort().GetNode());
+            return constantNode != nullptr && compiler.GetMapCompilerOptions(*constantNode).compilerSettings.weightStorageType != emitters::WeightStorageType::float32;
+        }
+        return false;
+    }
+
+    template <typename ValueType>
+    const std::vector<ValueType>* GetPrepackableWeights(const model::MapCompiler& compiler, const model::Node& node, const model::InputPort<ValueType>& weights)
+    {
+        auto constantNode = dynamic_cast<const ConstantNode<ValueType>*>(weights.GetReferencedPort().GetNode());
+        if (constantNode == nullptr || HasReducedPrecisionWeights(compiler, weights) || constantNode->GetValues().size() != weights.Size())
+        {
+            return nullptr;
+        }
+        return compiler.GetModelOptimizerOptions(node).template GetEntry<bool>("prepackWeights", true) ? &constantNode->GetValues() : nullptr;
+    }
 } // namespace nodes
 } // namespace ell
 
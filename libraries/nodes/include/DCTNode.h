@@ -16,7 +16,7 @@
 #include <model/include/Node.h>
 #include <model/include/OutputPort.h>
 
-#include <math/include/Matrix.h>
+#include <dsp/include/DCT.h>
 
 #include <utilities/include/TypeName.h>
 #include <utilities/include/TypeTraits.h>
@@ -29,12 +29,17 @@ namespace ell
 {
 namespace nodes
 {
-    /// <summary> A node that performs a real-valued discrete cosine transform (DCT) on its input </summary>
+    /// <summary>
+    /// A node that performs a real-valued discrete cosine transform (DCT) on its input, computing only the first
+    /// `numFilters` coefficients. Both `Compute` and the compiled code use a `dsp::DCTPlan`: when the plan computes
+    /// the DCT with an FFT, the node compiles the same permutation, FFT and post-twiddle steps, and otherwise it
+    /// refines to a product with the plan's truncated DCT matrix.
+    /// </summary>
     ///
     /// <typeparam name="ValueType"> The element type. </typeparam>
     ///
     template <typename ValueType>
-    class DCTNode : public model::Node
+    class DCTNode : public model::CompilableNode
     {
     public:
         /// @name Input and Output Ports
@@ -64,10 +69,12 @@ namespace nodes
 
     protected:
         void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
         bool Refine(model::ModelTransformer& transformer) const override;
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; } // Stored state: size
+        bool CanShareNodeFunction() const override { return true; }
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
@@ -78,8 +85,7 @@ namespace nodes
         // Output
         model::OutputPort<ValueType> _output;
 
-        // DCT Matrix
-        math::RowMatrix<ValueType> _dctCoeffs;
+        dsp::DCTPlan<ValueType> _plan;
     };
 } // namespace nodes
 } // namespace ell
@@ -31,7 +31,8 @@ namespace ell
 {
 namespace nodes
 {
-    /// <summary> A node that computes the dynamic time-warping distance between its inputs </summary>
+    /// <summary> A node that computes the dynamic time-warping distance between its input stream and one or more
+    /// prototypes. The output has one distance per prototype. </summary>
     template <typename ValueType>
     class DTWDistanceNode : public model::CompilableNode
     {
@@ -51,6 +52,12 @@ namespace nodes
         /// <param name="prototype"> The prototype </param>
         DTWDistanceNode(const model::OutputPort<ValueType>& input, const std::vector<std::vector<ValueType>>& prototype);
 
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The signals to compare to the prototypes </param>
+        /// <param name="prototypes"> The prototypes, which may have different lengths </param>
+        DTWDistanceNode(const model::OutputPort<ValueType>& input, const std::vector<std::vector<std::vector<ValueType>>>& prototypes);
+
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
         /// <returns> The name of this type. </returns>
@@ -61,8 +68,14 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
-        /// <summary></summary>
-        std::vector<std::vector<ValueType>> GetPrototype() const { return _prototype; }
+        /// <summary> Gets the first prototype. </summary>
+        std::vector<std::vector<ValueType>> GetPrototype() const { return _prototypes[0]; }
+
+        /// <summary> Gets the prototypes. </summary>
+        const std::vector<std::vector<std::vector<ValueType>>>& GetPrototypes() const { return _prototypes; }
+
+        /// <summary> Gets the number of prototypes. </summary>
+        size_t NumPrototypes() const { return _prototypes.size(); }
 
         /// <summary> Reset the state of the node </summary>
         void Reset() override;
@@ -77,17 +90,19 @@ namespace nodes
     private:
         void Copy(model::ModelTransformer& transformer) const override;
 
-        std::vector<ValueType> GetPrototypeData() const;
+        std::vector<ValueType> GetTransposedPrototypeData() const;
+        size_t NumPrototypeRows() const;
 
         model::InputPort<ValueType> _input;
         model::OutputPort<ValueType> _output;
 
         size_t _sampleDimension;
-        size_t _prototypeLength;
-        std::vector<std::vector<ValueType>> _prototype;
+        std::vector<std::vector<std::vector<ValueType>>> _prototypes;
         // double _threshold;
-        double _prototypeVariance;
+        std::vector<double> _prototypeVariances;
 
+        // The dynamic programming state of each prototype of length n takes n + 1 entries, starting at its offset
+        std::vector<size_t> _stateOffsets;
         mutable std::vector<ValueType> _d;
         mutable std::vector<int> _s;
         mutable int _currentTime;
@@ -131,19 +146,37 @@ namespace nodes
         CompilableNode({ &_input }, { &_output }),
         _input(this, {}, defaultInputPortName),
         _output(this, defaultOutputPortName, 1),
-        _sampleDimension(0),
-        _prototypeLength(0),
-        _prototypeVariance(0)
+        _sampleDimension(0)
     {
     }
 
     template <typename ValueType>
     DTWDistanceNode<ValueType>::DTWDistanceNode(const model::OutputPort<ValueType>& input, const std::vector<std::vector<ValueType>>& prototype) :
+        DTWDistanceNode(input, std::vector<std::vector<std::vector<ValueType>>>{ prototype })
+    {
+    }
+
+    template <typename ValueType>
+    DTWDistanceNode<ValueType>::DTWDistanceNode(const model::OutputPort<ValueType>& input, const std::vector<std::vector<std::vector<ValueType>>>& prototypes) :
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
-        _output(this, defaultOutputPortName, 1),
-        _prototype(prototype)
+        _output(this, defaultOutputPortName, prototypes.size()),
+        _prototypes(prototypes)
     {
+        if (_prototypes.empty())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "DTWDistanceNode: at least one prototype is required");
+        }
+        for (const auto& prototype : _prototypes)
+        {
+            for (const auto& row : prototype)
+            {
+                if (row.size() != input.Size())
+                {
+                    throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "DTWDistanceNode: prototype rows must be the size of the input");
+                }
+            }
+        }
         // _threshold = std::sqrt(-2 * std::log(confidenceThreshold)) * _prototypeVariance;
         Reset();
     }
@@ -152,17 +185,36 @@ namespace nodes
     void DTWDistanceNode<ValueType>::Reset()
     {
         _sampleDimension = _input.Size();
-        _prototypeLength = _prototype.size();
-        _d.resize(_prototypeLength + 1);
-        _s.resize(_prototypeLength + 1);
-
-        _prototypeVariance = DTWDistanceNodeImpl::Variance(_prototype);
-        std::fill(_d.begin() + 1, _d.end(), std::numeric_limits<ValueType>::max());
-        _d[0] = 0.0;
-        std::fill(_s.begin(), _s.end(), 0);
+        _prototypeVariances.clear();
+        _stateOffsets.clear();
+        size_t stateSize = 0;
+        for (const auto& prototype : _prototypes)
+        {
+            _prototypeVariances.push_back(DTWDistanceNodeImpl::Variance(prototype));
+            _stateOffsets.push_back(stateSize);
+            stateSize += prototype.size() + 1;
+        }
+
+        _d.assign(stateSize, std::numeric_limits<ValueType>::max());
+        _s.assign(stateSize, 0);
+        for (auto offset : _stateOffsets)
+        {
+            _d[offset] = 0.0;
+        }
         _currentTime = 0;
     }
 
+    template <typename ValueType>
+    size_t DTWDistanceNode<ValueType>::NumPrototypeRows() const
+    {
+        size_t numRows = 0;
+        for (const auto& prototype : _prototypes)
+        {
+            numRows += prototype.size();
+        }
+        return numRows;
+    }
+
     template <typename T>
     float distance(const std::vector<T>& a, const std::vector<T>& b)
     {
@@ -179,68 +231,86 @@ namespace nodes
     {
         std::vector<ValueType> input = _input.GetValue();
         auto t = ++_currentTime;
-        auto dLast = _d[0] = 0;
-        auto sLast = _s[0] = t;
-
-        ValueType bestDist = 0;
-        int bestStart = 0;
-        for (size_t index = 1; index < _prototypeLength + 1; ++index)
+        std::vector<ValueType> results;
+        for (size_t prototypeIndex = 0; prototypeIndex < _prototypes.size(); ++prototypeIndex)
         {
-            auto d_iMinus1 = _d[index - 1];
-            auto dPrev_iMinus1 = dLast;
-            auto dPrev_i = _d[index];
-            auto s_iMinus1 = _s[index - 1];
-            auto sPrev_iMinus1 = sLast;
-            auto sPrev_i = _s[index];
-
-            bestDist = d_iMinus1;
-            bestStart = s_iMinus1;
-            if (dPrev_i < bestDist)
+            const auto& prototype = _prototypes[prototypeIndex];
+            const auto prototypeLength = prototype.size();
+            auto d = _d.data() + _stateOffsets[prototypeIndex];
+            auto s = _s.data() + _stateOffsets[prototypeIndex];
+
+            auto dLast = d[0] = 0;
+            auto sLast = s[0] = t;
+
+            ValueType bestDist = 0;
+            int bestStart = 0;
+            for (size_t index = 1; index < prototypeLength + 1; ++index)
             {
-                bestDist = dPrev_i;
-                bestStart = sPrev_i;
+                auto d_iMinus1 = d[index - 1];
+                auto dPrev_iMinus1 = dLast;
+                auto dPrev_i = d[index];
+                auto s_iMinus1 = s[index - 1];
+                auto sPrev_iMinus1 = sLast;
+                auto sPrev_i = s[index];
+
+                bestDist = d_iMinus1;
+                bestStart = s_iMinus1;
+                if (dPrev_i < bestDist)
+                {
+                    bestDist = dPrev_i;
+                    bestStart = sPrev_i;
+                }
+                if (dPrev_iMinus1 < bestDist)
+                {
+                    bestDist = dPrev_iMinus1;
+                    bestStart = sPrev_iMinus1;
+                }
+                bestDist += distance(prototype[index - 1], input);
+
+                d[index] = bestDist;
+                s[index] = bestStart;
             }
-            if (dPrev_iMinus1 < bestDist)
+            assert(bestDist == d[prototypeLength]);
+            assert(bestStart == s[prototypeLength]);
+            auto result = bestDist / _prototypeVariances[prototypeIndex];
+
+            // Ensure best match is between 80% and 120% of prototype length
+            auto timeDiff = _currentTime - bestStart;
+            if (timeDiff < prototypeLength * 0.8 || timeDiff > prototypeLength * 1.2)
             {
-                bestDist = dPrev_iMinus1;
-                bestStart = sPrev_iMinus1;
+                bestDist = std::numeric_limits<ValueType>::max();
             }
-            bestDist += distance(_prototype[index - 1], input);
 
-            _d[index] = bestDist;
-            _s[index] = bestStart;
+            results.push_back(static_cast<ValueType>(result));
         }
-        assert(bestDist == _d[_prototypeLength]);
-        assert(bestStart == _s[_prototypeLength]);
-        auto result = bestDist / _prototypeVariance;
-
-        // Ensure best match is between 80% and 120% of prototype length
-        auto timeDiff = _currentTime - bestStart;
-        if (timeDiff < _prototypeLength * 0.8 || timeDiff > _prototypeLength * 1.2)
-        {
-            bestDist = std::numeric_limits<ValueType>::max();
-        }
-
-        _output.SetOutput({ static_cast<ValueType>(result) });
+        _output.SetOutput(results);
     };
 
     template <typename ValueType>
     void DTWDistanceNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
         const auto& newinput = transformer.GetCorrespondingInputs(_input);
-        auto newNode = transformer.AddNode<DTWDistanceNode<ValueType>>(newinput, _prototype);
+        auto newNode = transformer.AddNode<DTWDistanceNode<ValueType>>(newinput, _prototypes);
         transformer.MapNodeOutput(output, newNode->output);
     }
 
     template <typename ValueType>
-    std::vector<ValueType> DTWDistanceNode<ValueType>::GetPrototypeData() const
+    std::vector<ValueType> DTWDistanceNode<ValueType>::GetTransposedPrototypeData() const
     {
-        std::vector<ValueType> result;
-        result.reserve(_prototypeLength * _sampleDimension);
-
-        for (const auto& vec : _prototype)
+        // The rows of all the prototypes, one after the other, stored column by column
+        const auto numRows = NumPrototypeRows();
+        std::vector<ValueType> result(numRows * _sampleDimension);
+        size_t rowIndex = 0;
+        for (const auto& prototype : _prototypes)
         {
-            result.insert(result.end(), vec.begin(), vec.end());
+            for (const auto& row : prototype)
+            {
+                for (size_t j = 0; j < _sampleDimension; ++j)
+                {
+                    result[j * numRows + rowIndex] = row[j];
+                }
+                ++rowIndex;
+            }
         }
         return result;
     }
@@ -252,62 +322,73 @@ namespace nodes
 
         auto inputType = GetPortVariableType(_input);
         assert(inputType == GetPortVariableType(_output));
-        VerifyIsScalar(_output);
 
         auto input = function.LocalArray(compiler.EnsurePortEmitted(_input));
-        auto result = compiler.EnsurePortEmitted(_output);
+        auto result = function.LocalArray(compiler.EnsurePortEmitted(_output));
 
-        // The prototype (constant)
-        emitters::Variable* pVarPrototype = function.GetModule().Variables().AddVariable<emitters::LiteralVectorVariable<ValueType>>(GetPrototypeData());
+        // The prototypes (constant), transposed so that each input element is compared to consecutive rows
+        const int numRows = static_cast<int>(NumPrototypeRows());
+        emitters::Variable* pVarPrototypes = function.GetModule().Variables().AddVariable<emitters::LiteralVectorVariable<ValueType>>(GetTransposedPrototypeData());
 
         // Global variables for the dynamic programming memory
-        emitters::Variable* pVarD = function.GetModule().Variables().AddVariable<emitters::InitializedVectorVariable<ValueType>>(emitters::VariableScope::global, _prototypeLength + 1);
+        emitters::Variable* pVarD = function.GetModule().Variables().AddVariable<emitters::InitializedVectorVariable<ValueType>>(emitters::VariableScope::global, _d.size());
 
         // get global state vars
-        auto prototypeVector = function.LocalArray(function.GetModule().EnsureEmitted(*pVarPrototype));
+        auto prototypes = function.LocalArray(function.GetModule().EnsureEmitted(*pVarPrototypes));
         auto pD = function.LocalArray(function.GetModule().EnsureEmitted(*pVarD));
 
-        // incorrect usage of function.Variable --- should use IRModuleEmitter::EmitX(variable)
-        auto dist = function.Variable(inputType, "dist");
-        auto protoIndex = function.Variable(emitters::VariableType::Int32, "i");
-        auto dLast = function.Variable(inputType, "dLast");
-        auto bestDist = function.Variable(inputType, "bestDist");
-
-        // initialize variables
-        function.StoreZero(protoIndex);
-        function.StoreZero(dLast);
-
-        function.For(_prototypeLength, [pD, dLast, bestDist, dist, protoIndex, input, prototypeVector, this](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar iMinusOne) {
-            auto i = iMinusOne + 1;
-            auto d_iMinus1 = pD[iMinusOne];
-            auto dPrev_iMinus1 = function.LocalScalar(function.Load(dLast));
-            auto dPrev_i = pD[i];
+        // First, the distance from the input to every prototype row. Each input element updates all the rows with
+        // one pass over contiguous memory, which has no dependencies between iterations and can use vector instructions.
+        auto rowDistances = function.LocalArray(function.Variable(inputType, numRows));
+        function.For(numRows, [rowDistances](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar row) {
+            rowDistances[row] = function.LocalScalar<ValueType>(0);
+        });
+        for (int j = 0; j < static_cast<int>(_sampleDimension); ++j)
+        {
+            emitters::IRLocalScalar inputValue = input[j];
+            auto body = [rowDistances, prototypes, inputValue, j, numRows](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar row) {
+                function.PrefetchAhead(prototypes, row + j * numRows);
+                emitters::IRLocalScalar protoValue = prototypes[row + j * numRows];
+                emitters::IRLocalScalar rowDistance = rowDistances[row];
+                rowDistances[row] = rowDistance + emitters::Abs(inputValue - protoValue);
+            };
+
+            const auto& compilerOptions = function.GetCompilerOptions();
+            if (compilerOptions.allowVectorInstructions && compilerOptions.vectorWidth > 1)
+            {
+                function.VectorizedFor(function.Literal<int>(0), function.Literal<int>(numRows), compilerOptions.vectorWidth, true, body);
+            }
+            else
+            {
+                function.For(numRows, body);
+            }
+        }
 
-            function.Store(bestDist, static_cast<emitters::IRLocalScalar>(d_iMinus1));
+        // Then the recurrence along each prototype, which only has a couple of comparisons per row left
+        int rowOffset = 0;
+        for (size_t prototypeIndex = 0; prototypeIndex < _prototypes.size(); ++prototypeIndex)
+        {
+            const int stateOffset = static_cast<int>(_stateOffsets[prototypeIndex]);
+            const int prototypeLength = static_cast<int>(_prototypes[prototypeIndex].size());
+            auto dLast = function.LocalScalar<ValueType>(0);
+            pD[stateOffset] = dLast;
 
-            function.If(dPrev_i < d_iMinus1, [bestDist, dPrev_i](auto& function) {
-                function.Store(bestDist, static_cast<emitters::IRLocalScalar>(dPrev_i));
-            });
+            function.For(prototypeLength, [pD, rowDistances, dLast, stateOffset, rowOffset](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar iMinusOne) {
+                emitters::IRLocalScalar d_iMinus1 = pD[iMinusOne + stateOffset];
+                emitters::IRLocalScalar dPrev_i = pD[iMinusOne + (stateOffset + 1)];
 
-            function.If(dPrev_iMinus1 < function.Load(bestDist), [bestDist, dPrev_iMinus1](auto& function) {
-                function.Store(bestDist, dPrev_iMinus1);
-            });
+                // Selecting the smallest predecessor keeps the loop free of branches
+                auto bestPrev = function.LocalScalar(function.Select(dPrev_i < d_iMinus1, dPrev_i, d_iMinus1));
+                auto bestDist = function.LocalScalar(function.Select(dLast < bestPrev, dLast, bestPrev));
 
-            // Get dist
-            function.StoreZero(dist);
-            function.For(_sampleDimension, [dist, protoIndex, input, prototypeVector](emitters::IRFunctionEmitter& function, auto j) {
-                auto inputValue = input[j];
-                auto protoValue = prototypeVector[function.LocalScalar(function.Load(protoIndex))];
-                auto absDiff = emitters::Abs(inputValue - protoValue);
-                function.OperationAndUpdate(dist, emitters::GetAddForValueType<ValueType>(), absDiff);
-                function.OperationAndUpdate(protoIndex, emitters::TypedOperator::add, function.Literal(1));
+                emitters::IRLocalScalar rowDistance = rowDistances[iMinusOne + rowOffset];
+                pD[iMinusOne + (stateOffset + 1)] = bestDist + rowDistance;
             });
 
-            function.OperationAndUpdate(bestDist, emitters::GetAddForValueType<ValueType>(), function.Load(dist)); // x += dist;
-            pD[i] = function.Load(bestDist); // d[i] = x;
-        });
-
-        function.Store(result, function.Load(bestDist) / function.LocalScalar<ValueType>(_prototypeVariance));
+            emitters::IRLocalScalar bestDist = pD[stateOffset + prototypeLength];
+            result[static_cast<int>(prototypeIndex)] = bestDist / function.LocalScalar<ValueType>(_prototypeVariances[prototypeIndex]);
+            rowOffset += prototypeLength;
+        }
     }
 
     template <typename ValueType>
@@ -316,20 +397,30 @@ namespace nodes
         Node::WriteToArchive(archiver);
         archiver[defaultInputPortName] << _input;
         archiver[defaultOutputPortName] << _output;
-        // Since we know the prototype  will always be rectangular, we
-        // archive it as a matrix here.
-        auto numRows = _prototype.size();
-        auto numColumns = _prototype[0].size();
-        std::vector<double> elements;
-        elements.reserve(numRows * numColumns);
-        for (const auto& row : _prototype)
+        // Since we know the prototypes will always be rectangular, we
+        // archive each one as a matrix here. The first one keeps the
+        // property names used when a node had a single prototype.
+        for (size_t prototypeIndex = 0; prototypeIndex < _prototypes.size(); ++prototypeIndex)
         {
-            elements.insert(elements.end(), row.begin(), row.end());
+            const auto& prototype = _prototypes[prototypeIndex];
+            auto suffix = prototypeIndex == 0 ? std::string{} : "_" + std::to_string(prototypeIndex);
+            auto numRows = prototype.size();
+            auto numColumns = prototype[0].size();
+            std::vector<double> elements;
+            elements.reserve(numRows * numColumns);
+            for (const auto& row : prototype)
+            {
+                elements.insert(elements.end(), row.begin(), row.end());
+            }
+            archiver["prototype_rows" + suffix] << numRows;
+            archiver["prototype_columns" + suffix] << numColumns;
+            math::Matrix<double, math::MatrixLayout::columnMajor> temp(numRows, numColumns, elements);
+            math::MatrixArchiver::Write(temp, "prototype" + suffix, archiver);
+            if (prototypeIndex == 0)
+            {
+                archiver["num_prototypes"] << _prototypes.size();
+            }
         }
-        archiver["prototype_rows"] << numRows;
-        archiver["prototype_columns"] << numColumns;
-        math::Matrix<double, math::MatrixLayout::columnMajor> temp(numRows, numColumns, elements);
-        math::MatrixArchiver::Write(temp, "prototype", archiver);
     }
 
     template <typename ValueType>
@@ -338,15 +429,27 @@ namespace nodes
         Node::ReadFromArchive(archiver);
         archiver[defaultInputPortName] >> _input;
         archiver[defaultOutputPortName] >> _output;
-        size_t numRows;
-        size_t numColumns;
-        archiver["prototype_rows"] >> numRows;
-        archiver["prototype_columns"] >> numColumns;
-        math::Matrix<ValueType, math::MatrixLayout::columnMajor> temp(numRows, numColumns);
-        math::MatrixArchiver::Read(temp, "prototype", archiver);
-        for (size_t i = 0; i < numRows; i++)
+        _prototypes.clear();
+        size_t numPrototypes = 1;
+        for (size_t prototypeIndex = 0; prototypeIndex < numPrototypes; ++prototypeIndex)
         {
-            _prototype.emplace_back(temp.GetRow(i).ToArray());
+            auto suffix = prototypeIndex == 0 ? std::string{} : "_" + std::to_string(prototypeIndex);
+            size_t numRows;
+            size_t numColumns;
+            archiver["prototype_rows" + suffix] >> numRows;
+            archiver["prototype_columns" + suffix] >> numColumns;
+            math::Matrix<ValueType, math::MatrixLayout::columnMajor> temp(numRows, numColumns);
+            math::MatrixArchiver::Read(temp, "prototype" + suffix, archiver);
+            std::vector<std::vector<ValueType>> prototype;
+            for (size_t i = 0; i < numRows; i++)
+            {
+                prototype.emplace_back(temp.GetRow(i).ToArray());
+            }
+            _prototypes.push_back(std::move(prototype));
+            if (prototypeIndex == 0)
+            {
+                archiver.OptionalProperty("num_prototypes", size_t{ 1 }) >> numPrototypes;
+            }
         }
         Reset();
     }
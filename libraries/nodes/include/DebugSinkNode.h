@@ -76,6 +76,7 @@ namespace nodes
     protected:
         bool ShouldCompileInline() const override;
         void Compute() const override;
+        bool CanComputeConcurrently() const override { return false; } // calls the sink function
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
 
         /// <summary> Adds an object's properties to an `Archiver` </summary>
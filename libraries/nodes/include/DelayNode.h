@@ -20,6 +20,7 @@
 #include <utilities/include/IArchivable.h>
 #include <utilities/include/TypeName.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -57,6 +58,9 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Resets the state of the node </summary>
+        void Reset() override;
+
         /// <summary>Return the window size</summary>
         size_t GetWindowSize() const { return _windowSize; }
 
@@ -131,6 +135,15 @@ namespace nodes
         _output.SetOutput(lastBufferedSample);
     };
 
+    template <typename ValueType>
+    void DelayNode<ValueType>::Reset()
+    {
+        for (auto& sample : _samples)
+        {
+            std::fill(sample.begin(), sample.end(), static_cast<ValueType>(0));
+        }
+    }
+
     template <typename ValueType>
     void DelayNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
@@ -157,10 +170,26 @@ namespace nodes
         emitters::LLVMValue delayLine = function.GetModule().EnsureEmitted(*delayLineVar);
 
         //
-        // We implement a delay as a Shift Register
+        // We implement a delay as a ring of chunks: the chunk at `head` is the oldest, so it is the output, and the
+        // new input replaces it. Only one chunk is copied in and out per call, rather than shifting the whole buffer.
         //
         emitters::LLVMValue inputBuffer = compiler.EnsurePortEmitted(input);
-        function.ShiftAndUpdate<ValueType>(delayLine, bufferSize, sampleSize, inputBuffer, result);
+        auto headVar = function.GetModule().Global<int>(compiler.GetGlobalName(*this, "head"), 0);
+        auto head = function.LocalScalar(function.Load(headVar));
+        auto chunkOffset = head * static_cast<int>(sampleSize);
+        auto zero = function.LocalScalar<int>(0);
+        auto chunkSize = function.LocalScalar<int>(static_cast<int>(sampleSize));
+        function.MemoryCopy<ValueType>(delayLine, chunkOffset, result, zero, chunkSize);
+        function.MemoryCopy<ValueType>(inputBuffer, zero, delayLine, chunkOffset, chunkSize);
+        function.Store(headVar, (head + 1) % static_cast<int>(windowSize));
+
+        // Add the internal reset function, which empties the delay line
+        auto& module = function.GetModule();
+        std::string resetFunctionName = compiler.GetGlobalName(*this, "DelayNodeReset");
+        emitters::IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionName);
+        resetFunction.MemorySet<ValueType>(delayLine, 0, resetFunction.Literal<uint8_t>(0), static_cast<int>(bufferSize));
+        resetFunction.Store(headVar, resetFunction.Literal<int>(0));
+        module.EndResetFunction();
     }
 
     template <typename ValueType>
@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DepthwiseConvolutionNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <math/include/Tensor.h>
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <string>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A depthwise convolution (each filter is applied to one input channel) computed with direct loops on data in
+    /// the usual (row, column, channel) order. The innermost loop runs over the channels, which are contiguous in
+    /// memory, and each weight is loaded once for a block of output columns, so no reordering or unrolling of the
+    /// input is needed. SetConvolutionMethodTransformation uses this node for depthwise convolutional layers when no
+    /// convolution method is requested.
+    /// </summary>
+    template <typename ValueType>
+    class DepthwiseConvolutionNode : public model::CompilableNode
+    {
+    public:
+        using TensorType = math::ChannelColumnRowTensor<ValueType>;
+        using ConstTensorReferenceType = math::ConstChannelColumnRowTensorReference<ValueType>;
+
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default constructor. </summary>
+        DepthwiseConvolutionNode();
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. </param>
+        /// <param name="inputMemoryLayout"> The layout of the input data, in canonical order, padded by filterSize/2 rows and columns. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output data, in canonical order. </param>
+        /// <param name="filterWeights"> The weights for the convolutional filters. Stored as a 3D tensor of
+        ///  dimensions (d*fw) x fw x 1, where d == input depth (and number of filters) and fw == filter width. </param>
+        /// <param name="stride"> The output stride. </param>
+        DepthwiseConvolutionNode(const model::OutputPort<ValueType>& input,
+                                 const model::PortMemoryLayout& inputMemoryLayout,
+                                 const model::PortMemoryLayout& outputMemoryLayout,
+                                 const ConstTensorReferenceType& filterWeights,
+                                 int stride);
+
+        /// <summary> Gets information about the input memory layout </summary>
+        const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
+
+        /// <summary> Gets information about the output memory layout </summary>
+        model::PortMemoryLayout GetOutputMemoryLayout() const { return _output.GetMemoryLayout(); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("DepthwiseConvolutionNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: convolutional parameters and memory layout
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+        void VerifyLayouts() const;
+
+        // Returns the weights in (row, column, channel) order, so the weights of consecutive channels are contiguous
+        std::vector<ValueType> GetChannelInterleavedWeights() const;
+
+        // Input
+        model::InputPort<ValueType> _input;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        model::PortMemoryLayout _inputMemoryLayout;
+
+        TensorType _filterWeights;
+
+        int _stride = 1;
+    };
+} // namespace nodes
+} // namespace ell
@@ -184,6 +184,9 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
@@ -59,6 +59,9 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
         /// <summary> Refines this node in the model being constructed by the transformer </summary>
         ///
         /// <param name="transformer"> The `ModelTransformer` currently refining the model </param>
@@ -115,6 +118,12 @@ namespace nodes
     {
     }
 
+    template <typename ValueType>
+    int64_t DotProductNode<ValueType>::GetOperationCount() const
+    {
+        return 2 * static_cast<int64_t>(_input1.Size());
+    }
+
     template <typename ValueType>
     void DotProductNode<ValueType>::Compute() const
     {
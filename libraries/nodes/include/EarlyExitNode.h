@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     EarlyExitNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/Node.h>
+#include <model/include/OutputPort.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/TypeName.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A node that outputs the result of a cheap early head when the head is confident enough, and the result of the
+    /// full network otherwise. When the model is compiled, the nodes that only the full network's output depends on are
+    /// compiled into a function that runs only when the confidence is below the threshold. The reference computation
+    /// still computes every node, so nodes with state in the full network (e.g., recurrent layers) also update on the
+    /// inputs the compiled map skips them for.
+    /// </summary>
+    template <typename ValueType>
+    class EarlyExitNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        static constexpr const char* earlyOutputPortName = "earlyOutput";
+        static constexpr const char* confidencePortName = "confidence";
+        static constexpr const char* fullOutputPortName = "fullOutput";
+        const model::InputPort<ValueType>& earlyOutput = _earlyOutput;
+        const model::InputPort<ValueType>& confidence = _confidence;
+        const model::InputPort<ValueType>& fullOutput = _fullOutput;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        EarlyExitNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="earlyOutput"> The output of the early head. </param>
+        /// <param name="confidence"> A single value, the early head's confidence in its output. </param>
+        /// <param name="fullOutput"> The output of the full network, the same size as `earlyOutput`. </param>
+        /// <param name="threshold"> The confidence at or above which the early output is used. </param>
+        EarlyExitNode(const model::OutputPort<ValueType>& earlyOutput, const model::OutputPort<ValueType>& confidence, const model::OutputPort<ValueType>& fullOutput, ValueType threshold);
+
+        /// <summary> Gets the confidence at or above which the early output is used. </summary>
+        ValueType GetThreshold() const { return _threshold; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("EarlyExitNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Gets the full network's output, which the node only reads when the early head isn't confident. </summary>
+        std::vector<const model::InputPortBase*> GetConditionalInputs() const override { return { &_fullOutput }; }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // Stored state: threshold
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        model::InputPort<ValueType> _earlyOutput;
+        model::InputPort<ValueType> _confidence;
+        model::InputPort<ValueType> _fullOutput;
+        model::OutputPort<ValueType> _output;
+
+        ValueType _threshold = 0;
+    };
+
+    /// <summary> Convenience function for adding an early exit to a model. </summary>
+    ///
+    /// <param name="earlyOutput"> The output of the early head. </param>
+    /// <param name="confidence"> A single value, the early head's confidence in its output. </param>
+    /// <param name="fullOutput"> The output of the full network, the same size as `earlyOutput`. </param>
+    /// <param name="threshold"> The confidence at or above which the early output is used. </param>
+    ///
+    /// <returns> The output of the new node. </returns>
+    template <typename ValueType>
+    const model::OutputPort<ValueType>& EarlyExit(const model::OutputPort<ValueType>& earlyOutput, const model::OutputPort<ValueType>& confidence, const model::OutputPort<ValueType>& fullOutput, ValueType threshold);
+
+    extern template class EarlyExitNode<float>;
+    extern template class EarlyExitNode<double>;
+} // namespace nodes
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace nodes
+{
+    template <typename ValueType>
+    const model::OutputPort<ValueType>& EarlyExit(const model::OutputPort<ValueType>& earlyOutput, const model::OutputPort<ValueType>& confidence, const model::OutputPort<ValueType>& fullOutput, ValueType threshold)
+    {
+        model::Model* model = earlyOutput.GetNode()->GetModel();
+        if (model == nullptr)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Input not part of a model");
+        }
+        if (*model != *(confidence.GetNode()->GetModel()) || *model != *(fullOutput.GetNode()->GetModel()))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Inputs not part of the same model");
+        }
+
+        auto node = model->AddNode<EarlyExitNode<ValueType>>(earlyOutput, confidence, fullOutput, threshold);
+        return node->output;
+    }
+} // namespace nodes
+} // namespace ell
+
+#pragma endregion implementation
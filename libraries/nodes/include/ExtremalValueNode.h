@@ -16,6 +16,8 @@
 #include <model/include/Node.h>
 #include <model/include/OutputPort.h>
 
+#include <emitters/include/IRVectorUtilities.h>
+
 #include <utilities/include/TypeName.h>
 
 #include <algorithm>
@@ -264,6 +266,16 @@ namespace nodes
         auto inputType = GetPortVariableType(input);
         auto numInputs = input.Size();
 
+        // Compare a vector of values at a time. Ties still go to the first index, so this gives the same result as the serial loop.
+        const int vectorSize = emitters::GetReductionVectorSize(function.GetCompilerOptions());
+        if (vectorSize > 1 && static_cast<int>(numInputs) >= 2 * vectorSize)
+        {
+            auto best = emitters::EmitVectorizedArgExtremum<ValueType>(function, inputVal, static_cast<int>(numInputs), vectorSize, IsMaxNode());
+            function.Store(outVal, best.first);
+            function.Store(outArgVal, best.second);
+            return;
+        }
+
         emitters::LLVMValue bestVal = function.Variable(inputType, "bestVal");
         emitters::LLVMValue bestIndex = function.Variable(ell::emitters::VariableType::Int32, "bestArgVal");
 
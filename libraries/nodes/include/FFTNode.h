@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <dsp/include/FFT.h>
+
 #include <emitters/include/LLVMUtilities.h>
 
 #include <model/include/CompilableNode.h>
@@ -56,6 +58,11 @@ namespace nodes
         /// <param name="fftSize"> The FFT size. The output size of this node will be fftSize/2. </param>
         FFTNode(const model::OutputPort<ValueType>& input, size_t fftSize);
 
+        /// <summary> Gets the FFT size. </summary>
+        ///
+        /// <returns> The FFT size. </returns>
+        size_t GetFFTSize() const { return _fftSize; }
+
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
         /// <returns> The name of this type. </returns>
@@ -66,6 +73,13 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Emits code that performs an in-place complex-valued FFT, the way this node does. </summary>
+        ///
+        /// <param name="function"> The function to emit the FFT into. </param>
+        /// <param name="plan"> The plan of the FFT size. </param>
+        /// <param name="buffer"> The plan.Size() complex values to transform, as interleaved real and imaginary parts. </param>
+        static void EmitInPlaceFFT(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, emitters::LLVMValue buffer);
+
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
@@ -77,22 +91,25 @@ namespace nodes
         void Copy(model::ModelTransformer& transformer) const override;
 
         // Emitting IR for FFT implemenations
-        void EmitFFT_2(emitters::IRFunctionEmitter& function, emitters::LLVMValue input);
-        void EmitFFT_4(emitters::IRFunctionEmitter& function, emitters::LLVMValue input);
-        void EmitFFT(emitters::IRFunctionEmitter& function, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch);
-        void EmitRealFFT(emitters::IRFunctionEmitter& function, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch, emitters::LLVMValue complexInput);
+        static void EmitFFT_2(emitters::IRFunctionEmitter& function, emitters::LLVMValue input);
+        static void EmitFFT_4(emitters::IRFunctionEmitter& function, emitters::LLVMValue input);
+        static void EmitFFT(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch);
+        static void EmitRealFFT(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch, emitters::LLVMValue complexInput);
 
         // Getting FFT functions
-        emitters::LLVMFunction GetRealFFTFunction(emitters::IRModuleEmitter& moduleEmitter, size_t length);
-        emitters::LLVMFunction GetFFTFunction(emitters::IRModuleEmitter& moduleEmitter, size_t length);
+        static emitters::LLVMFunction GetRealFFTFunction(emitters::IRModuleEmitter& moduleEmitter, const dsp::FFTPlan<ValueType>& plan, size_t length);
+        static emitters::LLVMFunction GetFFTFunction(emitters::IRModuleEmitter& moduleEmitter, const dsp::FFTPlan<ValueType>& plan, size_t length);
 
         // Hand-unrolled fixed-size versions
-        emitters::LLVMFunction GetFFTFunction_2(emitters::IRModuleEmitter& moduleEmitter);
-        emitters::LLVMFunction GetFFTFunction_4(emitters::IRModuleEmitter& moduleEmitter);
+        static emitters::LLVMFunction GetFFTFunction_2(emitters::IRModuleEmitter& moduleEmitter);
+        static emitters::LLVMFunction GetFFTFunction_4(emitters::IRModuleEmitter& moduleEmitter);
+
+        // Calling the CMSIS-DSP real FFT (float only)
+        void EmitCmsisRealFFT(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function);
 
         // Performing FFT (either by calling a function or emitting inline code)
-        void DoFFT(emitters::IRFunctionEmitter& function, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch);
-        void DoRealFFT(emitters::IRFunctionEmitter& function, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch, emitters::LLVMValue complexInput);
+        static void DoFFT(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch);
+        static void DoRealFFT(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch, emitters::LLVMValue complexInput);
 
         // Inputs
         model::InputPort<ValueType> _input;
@@ -101,6 +118,7 @@ namespace nodes
         model::OutputPort<ValueType> _output;
 
         size_t _fftSize;
+        dsp::FFTPlan<ValueType> _plan;
     };
 
     template <typename ValueType>
@@ -68,6 +68,11 @@ namespace nodes
         const model::OutputPort<ValueType>& output = _output;
         /// @}
 
+        /// <summary> Gets the filters. </summary>
+        ///
+        /// <returns> The filters. </returns>
+        const dsp::TriangleFilterBank& GetFilters() const { return _filters; }
+
     protected:
         /// <summary> Construct a FilterBankeNode from the given filters </summary>
         FilterBankNode(const dsp::TriangleFilterBank& filters);
@@ -80,6 +85,7 @@ namespace nodes
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; } // Stored state: filters
+        bool CanShareNodeFunction() const override { return true; }
 
         // Inputs
         model::InputPort<ValueType> _input;
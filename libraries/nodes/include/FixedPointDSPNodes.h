@@ -0,0 +1,338 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FixedPointDSPNodes.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <dsp/include/FilterBank.h>
+#include <dsp/include/FixedPoint.h>
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/Node.h>
+#include <model/include/OutputPort.h>
+
+#include <utilities/include/TypeName.h>
+
+#include <string>
+#include <vector>
+
+//
+// Versions of the DSP nodes (HammingWindowNode, FilterBankNode, IIRFilterNode, DCTNode and FFTNode) that compute
+// with integer arithmetic in a fixed-point format like Q15 or Q31, for devices without a floating-point unit. Their
+// ports are still floating-point: each node converts its input to the fixed-point format, and its output back. The
+// compiled code does the same integer arithmetic as `Compute`, so the two give the same results.
+//
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary> A node that multiplies its input by a window, such as a Hamming window, in fixed point. </summary>
+    template <typename ValueType>
+    class FixedPointWindowNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        FixedPointWindowNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The signal to apply the window to. </param>
+        /// <param name="window"> The window values, one for each input value. </param>
+        /// <param name="format"> The fixed-point format of the data. </param>
+        FixedPointWindowNode(const model::OutputPort<ValueType>& input, const std::vector<ValueType>& window, const dsp::FixedPointFormat& format);
+
+        /// <summary> Gets the fixed-point format of the data. </summary>
+        const dsp::FixedPointFormat& GetFormat() const { return _format; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("FixedPointWindowNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // Stored state: window and format
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        model::InputPort<ValueType> _input;
+        model::OutputPort<ValueType> _output;
+
+        std::vector<ValueType> _window;
+        dsp::FixedPointFormat _format;
+        dsp::FixedPointCoefficients _coefficients;
+    };
+
+    /// <summary>
+    /// A node that applies a bank of filters to its input in fixed point. Each filter is a range of coefficients
+    /// applied to a range of the input, as in FilterBankNode.
+    /// </summary>
+    template <typename ValueType>
+    class FixedPointFilterBankNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        FixedPointFilterBankNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The frequency magnitudes to filter. </param>
+        /// <param name="filters"> The filters. Only the active filters are applied, one for each output. </param>
+        /// <param name="format"> The fixed-point format of the data. </param>
+        FixedPointFilterBankNode(const model::OutputPort<ValueType>& input, const dsp::TriangleFilterBank& filters, const dsp::FixedPointFormat& format);
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The signal to filter. </param>
+        /// <param name="filterStarts"> The index of the first input value of each filter. </param>
+        /// <param name="filterSizes"> The number of coefficients of each filter. </param>
+        /// <param name="coefficients"> The coefficients of all the filters, end to end. </param>
+        /// <param name="format"> The fixed-point format of the data. </param>
+        FixedPointFilterBankNode(const model::OutputPort<ValueType>& input, const std::vector<int>& filterStarts, const std::vector<int>& filterSizes, const std::vector<double>& coefficients, const dsp::FixedPointFormat& format);
+
+        /// <summary> Gets the fixed-point format of the data. </summary>
+        const dsp::FixedPointFormat& GetFormat() const { return _format; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("FixedPointFilterBankNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // Stored state: filters and format
+        bool CanShareNodeFunction() const override { return true; }
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+        void Initialize();
+
+        model::InputPort<ValueType> _input;
+        model::OutputPort<ValueType> _output;
+
+        std::vector<int> _filterStarts;
+        std::vector<int> _filterSizes;
+        std::vector<double> _filterCoefficients;
+        dsp::FixedPointFormat _format;
+        dsp::FixedPointCoefficients _coefficients;
+    };
+
+    /// <summary> A node that applies an IIR filter to its input in fixed point (see dsp::FixedPointIIRFilter). </summary>
+    template <typename ValueType>
+    class FixedPointIIRFilterNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        FixedPointIIRFilterNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The signal to process. </param>
+        /// <param name="b"> The coefficients that operate on input values (feed forward). </param>
+        /// <param name="a"> The coefficients that operate on past output values (feedback). </param>
+        /// <param name="format"> The fixed-point format of the data. </param>
+        FixedPointIIRFilterNode(const model::OutputPort<ValueType>& input, const std::vector<ValueType>& b, const std::vector<ValueType>& a, const dsp::FixedPointFormat& format);
+
+        /// <summary> Gets the fixed-point format of the data. </summary>
+        const dsp::FixedPointFormat& GetFormat() const { return _format; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("FixedPointIIRFilterNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // Stored state: coefficients and past inputs and outputs
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        model::InputPort<ValueType> _input;
+        model::OutputPort<ValueType> _output;
+
+        std::vector<ValueType> _b;
+        std::vector<ValueType> _a;
+        dsp::FixedPointFormat _format;
+        mutable dsp::FixedPointIIRFilter _filter;
+    };
+
+    /// <summary>
+    /// A node that computes the first `numFilters` coefficients of the DCT of its input in fixed point, as a product
+    /// with the DCT matrix. Like DCTNode, the DCT isn't normalized.
+    /// </summary>
+    template <typename ValueType>
+    class FixedPointDCTNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        FixedPointDCTNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The signal to process. </param>
+        /// <param name="numFilters"> The number of DCT coefficients to compute. Also, the output dimension. </param>
+        /// <param name="format"> The fixed-point format of the data. </param>
+        FixedPointDCTNode(const model::OutputPort<ValueType>& input, size_t numFilters, const dsp::FixedPointFormat& format);
+
+        /// <summary> Gets the fixed-point format of the data. </summary>
+        const dsp::FixedPointFormat& GetFormat() const { return _format; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("FixedPointDCTNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // Stored state: size and format
+        bool CanShareNodeFunction() const override { return true; }
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+        void Initialize();
+
+        model::InputPort<ValueType> _input;
+        model::OutputPort<ValueType> _output;
+
+        dsp::FixedPointFormat _format;
+        dsp::FixedPointCoefficients _coefficients; // the DCT matrix, in row-major order
+    };
+
+    /// <summary>
+    /// A node that computes the magnitudes of the FFT of its input in fixed point, with block floating-point scaling
+    /// (see dsp::FixedPointFFTPlan). Like FFTNode, the output is the first fftSize/2 magnitudes.
+    /// </summary>
+    template <typename ValueType>
+    class FixedPointFFTNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        FixedPointFFTNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The signal to process, zero-padded or truncated to the FFT size. </param>
+        /// <param name="fftSize"> The FFT size, a power of 2. </param>
+        /// <param name="format"> The fixed-point format of the data. </param>
+        FixedPointFFTNode(const model::OutputPort<ValueType>& input, size_t fftSize, const dsp::FixedPointFormat& format);
+
+        /// <summary> Gets the fixed-point format of the data. </summary>
+        const dsp::FixedPointFormat& GetFormat() const { return _format; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("FixedPointFFTNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // Stored state: size and format
+        bool CanShareNodeFunction() const override { return true; }
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        model::InputPort<ValueType> _input;
+        model::OutputPort<ValueType> _output;
+
+        size_t _fftSize;
+        dsp::FixedPointFormat _format;
+        dsp::FixedPointFFTPlan _plan;
+    };
+
+    //
+    // Explicit instantiation declarations
+    //
+    extern template class FixedPointWindowNode<float>;
+    extern template class FixedPointWindowNode<double>;
+    extern template class FixedPointFilterBankNode<float>;
+    extern template class FixedPointFilterBankNode<double>;
+    extern template class FixedPointIIRFilterNode<float>;
+    extern template class FixedPointIIRFilterNode<double>;
+    extern template class FixedPointDCTNode<float>;
+    extern template class FixedPointDCTNode<double>;
+    extern template class FixedPointFFTNode<float>;
+    extern template class FixedPointFFTNode<double>;
+} // namespace nodes
+} // namespace ell
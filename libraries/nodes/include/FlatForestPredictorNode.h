@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FlatForestPredictorNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/OutputPort.h>
+
+#include <predictors/include/ForestPredictor.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A forest of single-element threshold trees with constant edge predictors, with each tree flattened into arrays
+    /// of feature indices, thresholds and child indices. Leaves are nodes whose children are both the leaf itself, so
+    /// walking past a leaf stays there.
+    /// </summary>
+    struct FlatForest
+    {
+        std::vector<int> featureIndices;
+        std::vector<double> thresholds;
+        std::vector<int> children; // two per node: the child taken if the feature is not greater than the threshold, then the other one
+        std::vector<double> leafValues; // the sum of the edge predictors on the path to each leaf, and 0 for interior nodes
+        std::vector<int> treeRoots;
+        std::vector<int> treeDepths; // the number of interior nodes on the longest path from each root
+        double bias = 0;
+    };
+
+    /// <summary> Flattens a forest, laying each tree out breadth-first. </summary>
+    ///
+    /// <param name="forest"> The forest predictor. </param>
+    ///
+    /// <returns> The flattened forest. </returns>
+    FlatForest FlattenForest(const predictors::SimpleForestPredictor& forest);
+
+    /// <summary>
+    /// A node that evaluates a flattened SimpleForestPredictor. Each level of a tree is evaluated without a branch, by
+    /// indexing the children with the result of the comparison, and the compiled code walks several trees at once.
+    /// The `output` and `treeOutputs` ports match those of SimpleForestPredictorNode.
+    /// </summary>
+    class FlatForestPredictorNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        static constexpr const char* treeOutputsPortName = "treeOutputs";
+        const model::InputPort<double>& input = _input;
+        const model::OutputPort<double>& output = _output;
+        const model::OutputPort<double>& treeOutputs = _treeOutputs;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        FlatForestPredictorNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The predictor's input. </param>
+        /// <param name="forest"> The forest predictor. </param>
+        FlatForestPredictorNode(const model::OutputPort<double>& input, const predictors::SimpleForestPredictor& forest);
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The predictor's input. </param>
+        /// <param name="forest"> The flattened forest. </param>
+        FlatForestPredictorNode(const model::OutputPort<double>& input, const FlatForest& forest);
+
+        /// <summary> Gets the flattened forest. </summary>
+        ///
+        /// <returns> The flattened forest. </returns>
+        const FlatForest& GetForest() const { return _forest; }
+
+        /// <summary> Returns the number of trees in the forest. </summary>
+        ///
+        /// <returns> The number of trees. </returns>
+        size_t NumTrees() const { return _forest.treeRoots.size(); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return "FlatForestPredictorNode"; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        bool HasState() const override { return true; } // stored state: the flattened trees
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        // Inputs
+        model::InputPort<double> _input;
+
+        // Outputs
+        model::OutputPort<double> _output;
+        model::OutputPort<double> _treeOutputs;
+
+        FlatForest _forest;
+    };
+} // namespace nodes
+} // namespace ell
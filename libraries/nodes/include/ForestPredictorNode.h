@@ -70,6 +70,11 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Gets the forest predictor. </summary>
+        ///
+        /// <returns> The forest predictor. </returns>
+        const ForestPredictor& GetForest() const { return _forest; }
+
         /// <summary> Refines this node in the model being constructed by the transformer </summary>
         bool Refine(model::ModelTransformer& transformer) const override;
 
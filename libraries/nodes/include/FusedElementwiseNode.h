@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FusedElementwiseNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "BroadcastFunctionNode.h"
+#include "NodeOperations.h"
+
+#include <emitters/include/IRFunctionEmitter.h>
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/OutputPort.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <utilities/include/IArchivable.h>
+#include <utilities/include/TypeName.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary> The kinds of elementwise operation that can be fused into a FusedElementwiseNode. </summary>
+    enum class FusedElementwiseOperationType
+    {
+        unaryFunction,
+        linearFunction,
+        binaryOperation
+    };
+
+    /// <summary>
+    /// One stage of a fused elementwise computation. Each stage transforms the running value `x` produced by the
+    /// stages before it (the first stage receives the value of the node's primary input).
+    /// </summary>
+    template <typename ValueType>
+    struct FusedElementwiseOperation
+    {
+        FusedElementwiseOperationType type = FusedElementwiseOperationType::unaryFunction;
+
+        // unaryFunction: x = f(x)
+        std::shared_ptr<const BroadcastUnaryFunctionType<ValueType>> function;
+
+        // linearFunction: x = scale[i] * x + bias[i], where i is the coordinate along `broadcastDimension`
+        int scaleInput = -1; // index of the node input holding the scale vector, or -1 if there is no scale
+        int biasInput = -1; // index of the node input holding the bias vector, or -1 if there is no bias
+        int broadcastDimension = 0;
+
+        // binaryOperation: x = op(x, y) (or op(y, x)), where y is the corresponding entry of another full-size input
+        BinaryOperationType operation = BinaryOperationType::none;
+        int otherInput = -1;
+        bool isLeftOperand = true; // true if x is the left-hand operand of `operation`
+    };
+
+    /// <summary>
+    /// A node that applies a chain of elementwise operations to its primary input in a single loop nest. Intermediate
+    /// values of the chain are never written to memory. Nodes of this type are created by the elementwise fusion pass.
+    /// </summary>
+    template <typename ValueType>
+    class FusedElementwiseNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        FusedElementwiseNode();
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="inputs"> The inputs of the fused computation. The first input is the primary input the operations are applied to. </param>
+        /// <param name="inputLayouts"> The memory layouts of the inputs (ignored for the scale and bias vectors of linear operations). </param>
+        /// <param name="operations"> The operations to apply, in order. </param>
+        /// <param name="outputLayout"> The memory layout of the output. </param>
+        /// <param name="padding"> The padding value. </param>
+        FusedElementwiseNode(const std::vector<const model::OutputPort<ValueType>*>& inputs,
+                             const std::vector<model::PortMemoryLayout>& inputLayouts,
+                             const std::vector<FusedElementwiseOperation<ValueType>>& operations,
+                             const model::PortMemoryLayout& outputLayout,
+                             ValueType padding = 0);
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("FusedElementwiseNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Returns the number of inputs of the fused computation. </summary>
+        size_t NumInputs() const { return _inputPorts.size(); }
+
+        /// <summary> Returns an input of the fused computation. </summary>
+        ///
+        /// <param name="index"> The index of the input. Index 0 is the primary input. </param>
+        const model::InputPort<ValueType>& GetInput(size_t index) const { return *_inputPorts[index]; }
+
+        /// <summary> Returns the memory layout of an input. </summary>
+        ///
+        /// <param name="index"> The index of the input. </param>
+        const model::PortMemoryLayout& GetInputMemoryLayout(size_t index) const { return _inputLayouts[index]; }
+
+        /// <summary> Returns the memory layouts of all the inputs. </summary>
+        const std::vector<model::PortMemoryLayout>& GetInputMemoryLayouts() const { return _inputLayouts; }
+
+        /// <summary> Returns the memory layout of the output. </summary>
+        model::PortMemoryLayout GetOutputMemoryLayout() const { return _output.GetMemoryLayout(); }
+
+        /// <summary> Returns the operations applied by this node, in order. </summary>
+        const std::vector<FusedElementwiseOperation<ValueType>>& GetOperations() const { return _operations; }
+
+        /// <summary> Returns the padding value written to the output. </summary>
+        ValueType GetOutputPadding() const { return _paddingValue; }
+
+        /// <summary> The fused loop nest can stop after a dynamic extent of its outermost dimension </summary>
+        bool SupportsDynamicExtent() const override { return true; }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: operations, input layouts, padding value
+        bool CanShareNodeFunction() const override { return true; }
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        void AddInput(const model::OutputPort<ValueType>& input);
+        void VerifyInputs() const;
+        void ComputeDimensionLoop(int dimension, std::vector<int>& coordinates, const std::vector<std::vector<ValueType>>& inputValues, std::vector<ValueType>& output) const;
+
+        // Inputs
+        std::vector<std::unique_ptr<model::InputPort<ValueType>>> _inputPorts;
+        std::vector<model::PortMemoryLayout> _inputLayouts;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        std::vector<FusedElementwiseOperation<ValueType>> _operations;
+        ValueType _paddingValue;
+    };
+} // namespace nodes
+} // namespace ell
@@ -50,6 +50,11 @@ namespace nodes
         /// <param name="a"> The coefficients that operate on past output values (feedback). </param>
         IIRFilterNode(const model::OutputPort<ValueType>& input, const std::vector<ValueType>& b, const std::vector<ValueType>& a);
 
+        /// <summary> Gets the filter. </summary>
+        ///
+        /// <returns> The filter. </returns>
+        const dsp::IIRFilter<ValueType>& GetFilter() const { return _filter; }
+
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
         /// <returns> The name of this type. </returns>
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     InputPreprocessingNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/OutputPort.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <emitters/include/IRFunctionEmitter.h>
+
+#include <utilities/include/IArchivable.h>
+#include <utilities/include/TypeName.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A node that converts raw input (for instance, the integer pixel values of an image) to normalized activations in
+    /// a single pass: each entry is cast to the output type, scaled and offset by per-channel constants, and written with
+    /// the output's memory layout, which may have a different dimension order than the input's. Nodes of this type are
+    /// created by the input preprocessing fusion pass, from a type cast, a linear function, and a reordering node.
+    /// </summary>
+    template <typename InputValueType, typename OutputValueType>
+    class InputPreprocessingNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<InputValueType>& input = _input;
+        const model::OutputPort<OutputValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        InputPreprocessingNode();
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="input"> The raw input. </param>
+        /// <param name="inputLayout"> The memory layout of the input. </param>
+        /// <param name="scale"> The per-channel scale, or an empty vector for no scaling. </param>
+        /// <param name="bias"> The per-channel bias, added after scaling, or an empty vector for no bias. </param>
+        /// <param name="channelDimension"> The logical dimension indexing the `scale` and `bias` vectors. </param>
+        /// <param name="outputLayout"> The memory layout of the output. </param>
+        /// <param name="padding"> The value to fill the output's padding with. </param>
+        InputPreprocessingNode(const model::OutputPort<InputValueType>& input,
+                               const model::PortMemoryLayout& inputLayout,
+                               const std::vector<OutputValueType>& scale,
+                               const std::vector<OutputValueType>& bias,
+                               int channelDimension,
+                               const model::PortMemoryLayout& outputLayout,
+                               OutputValueType padding = 0);
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<InputValueType, OutputValueType>("InputPreprocessingNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Returns the memory layout of the input. </summary>
+        const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputLayout; }
+
+        /// <summary> Returns the memory layout of the output. </summary>
+        model::PortMemoryLayout GetOutputMemoryLayout() const { return _output.GetMemoryLayout(); }
+
+        /// <summary> Returns the per-channel scale (empty if the input isn't scaled). </summary>
+        const std::vector<OutputValueType>& GetScale() const { return _scale; }
+
+        /// <summary> Returns the per-channel bias (empty if there is no bias). </summary>
+        const std::vector<OutputValueType>& GetBias() const { return _bias; }
+
+        /// <summary> Returns the logical dimension indexing the scale and bias. </summary>
+        int GetChannelDimension() const { return _channelDimension; }
+
+        /// <summary> Returns the padding value written to the output. </summary>
+        OutputValueType GetOutputPadding() const { return _paddingValue; }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: layouts, scale, bias, padding value
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+        void VerifyParameters() const;
+
+        // Input
+        model::InputPort<InputValueType> _input;
+        model::PortMemoryLayout _inputLayout;
+
+        // Output
+        model::OutputPort<OutputValueType> _output;
+
+        std::vector<OutputValueType> _scale;
+        std::vector<OutputValueType> _bias;
+        int _channelDimension = 0;
+        OutputValueType _paddingValue = 0;
+    };
+} // namespace nodes
+} // namespace ell
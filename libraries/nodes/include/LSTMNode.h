@@ -70,6 +70,9 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Gets the recurrent activation function. </summary>
+        const ActivationType& GetRecurrentActivation() const { return _recurrentActivation; }
+
         /// <summary> Resets any state on the node, if any </summary>
         void Reset() override;
 
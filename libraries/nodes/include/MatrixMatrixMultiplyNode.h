@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "OutputEpilogue.h"
+
 #include <emitters/include/IRFunctionEmitter.h>
 
 #include <model/include/CompilableNode.h>
@@ -31,9 +33,13 @@ namespace ell
 {
 namespace nodes
 {
-    /// <summary> A node that multiplies two matrices. </summary>
+    /// <summary>
+    /// A node that multiplies two matrices. An OutputEpilogue can be applied to the product, with the columns of the
+    /// output matrix (as stored in memory) as its channels.
+    /// </summary>
     template <typename ValueType>
     class MatrixMatrixMultiplyNode : public model::CompilableNode
+        , public IOutputEpilogueNode<ValueType>
     {
     public:
         /// @name Input and Output Ports
@@ -92,6 +98,37 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
+        /// <summary> Gets the number of rows of the product (and of the left-hand input). </summary>
+        int NumRows() const { return _m; }
+
+        /// <summary> Gets the number of columns of the product (and of the right-hand input). </summary>
+        int NumColumns() const { return _n; }
+
+        /// <summary> Gets the number of columns of the left-hand input (and rows of the right-hand input). </summary>
+        int InnerDimension() const { return _k; }
+
+        /// <summary> Gets the strides of the left-hand input, the right-hand input, and the product. </summary>
+        int GetInput1Stride() const { return _lda; }
+        int GetInput2Stride() const { return _ldb; }
+        int GetOutputStride() const { return _ldc; }
+
+        /// <summary> Indicates if the left-hand input, the right-hand input, or the product are stored transposed. </summary>
+        bool IsInput1Transposed() const { return _transpose1; }
+        bool IsInput2Transposed() const { return _transpose2; }
+        bool IsOutputTransposed() const { return _transposeOutput; }
+
+        /// <summary> Indicates if the node can apply an epilogue whose channels are dimension 2 of the given layout. </summary>
+        bool CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const override;
+
+        /// <summary> Gets the epilogue applied to the product. </summary>
+        const OutputEpilogue<ValueType>& GetEpilogue() const override { return _epilogue; }
+
+        /// <summary> Sets the epilogue applied to the product. </summary>
+        void SetEpilogue(const OutputEpilogue<ValueType>& epilogue) override { _epilogue = epilogue; }
+
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
@@ -100,6 +137,10 @@ namespace nodes
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; } // stored state:  m, n, k, lda, ldb, ldc, transpose
+        bool CanShareNodeFunction() const override { return true; }
+        std::string GetNodeFunctionKey(model::IRMapCompiler& compiler) const override;
+        emitters::NamedVariableTypeList GetNodeFunctionStateParameterList(model::IRMapCompiler& compiler) const override;
+        std::vector<emitters::LLVMValue> GetNodeFunctionStateArguments(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& currentFunction) const override;
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
@@ -116,6 +157,8 @@ namespace nodes
         int _m = 0, _n = 0, _k = 0;
         int _lda = 0, _ldb = 0, _ldc = 0;
         bool _transpose1 = false, _transpose2 = false, _transposeOutput = false;
+
+        OutputEpilogue<ValueType> _epilogue;
     };
 
     /// <summary> Convenience function for adding a node to a model. </summary>
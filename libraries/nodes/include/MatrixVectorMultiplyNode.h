@@ -65,6 +65,21 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
+        /// <summary> Gets the number of rows of the matrix. </summary>
+        size_t NumRows() const { return _m; }
+
+        /// <summary> Gets the number of columns of the matrix. </summary>
+        size_t NumColumns() const { return _n; }
+
+        /// <summary> Gets the stride of the matrix (the number of elements between adjacent rows). </summary>
+        size_t GetMatrixStride() const { return _lda; }
+
+        /// <summary> Gets the stride of the vector. </summary>
+        size_t GetVectorStride() const { return _incx; }
+
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
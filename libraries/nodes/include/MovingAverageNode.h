@@ -8,18 +8,15 @@
 
 #pragma once
 
-#include "AccumulatorNode.h"
-#include "BinaryOperationNode.h"
-#include "ConstantNode.h"
-#include "DelayNode.h"
-
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
 #include <model/include/InputPort.h>
 #include <model/include/ModelTransformer.h>
-#include <model/include/Node.h>
 #include <model/include/OutputPort.h>
 
 #include <utilities/include/TypeName.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -27,9 +24,14 @@ namespace ell
 {
 namespace nodes
 {
-    /// <summary> A node that takes a vector input and returns its mean over some window of time. </summary>
+    /// <summary>
+    /// A node that takes a vector input and returns its mean over some window of time. The last `windowSize` samples
+    /// are kept in a ring along with their running sum, so each new sample costs the same whatever the window size.
+    /// Rounding errors would build up in the running sum over a long stream, so it's summed again from the ring each
+    /// time the ring wraps around.
+    /// </summary>
     template <typename ValueType>
-    class MovingAverageNode : public model::Node
+    class MovingAverageNode : public model::CompilableNode
     {
     public:
         /// @name Input and Output Ports
@@ -56,11 +58,12 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
-        /// <summary> Refines this node in the model being constructed by the transformer </summary>
-        bool Refine(model::ModelTransformer& transformer) const override;
+        /// <summary> Resets the state of the node </summary>
+        void Reset() override;
 
     protected:
         void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; }
@@ -75,7 +78,8 @@ namespace nodes
         model::OutputPort<ValueType> _output;
 
         // Buffer
-        mutable std::vector<std::vector<ValueType>> _samples;
+        mutable std::vector<std::vector<ValueType>> _samples; // a ring, whose oldest sample is at _head
+        mutable size_t _head = 0;
         mutable std::vector<ValueType> _runningSum;
         size_t _windowSize;
     };
@@ -99,7 +103,7 @@ namespace nodes
 {
     template <typename ValueType>
     MovingAverageNode<ValueType>::MovingAverageNode() :
-        Node({ &_input }, { &_output }),
+        CompilableNode({ &_input }, { &_output }),
         _input(this, {}, defaultInputPortName),
         _output(this, defaultOutputPortName, 0),
         _windowSize(0)
@@ -108,7 +112,7 @@ namespace nodes
 
     template <typename ValueType>
     MovingAverageNode<ValueType>::MovingAverageNode(const model::OutputPort<ValueType>& input, size_t windowSize) :
-        Node({ &_input }, { &_output }),
+        CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, _input.Size()),
         _windowSize(windowSize)
@@ -124,20 +128,44 @@ namespace nodes
     template <typename ValueType>
     void MovingAverageNode<ValueType>::Compute() const
     {
+        // The new sample replaces the oldest one, in the ring and in the running sum
         auto inputSample = _input.GetValue();
-        auto lastBufferedSample = _samples[0];
-        _samples.push_back(inputSample);
-        _samples.erase(_samples.begin());
+        auto& oldestSample = _samples[_head];
 
         std::vector<ValueType> result(_input.Size());
         for (size_t index = 0; index < inputSample.size(); ++index)
         {
-            _runningSum[index] += (inputSample[index] - lastBufferedSample[index]);
+            _runningSum[index] += (inputSample[index] - oldestSample[index]);
             result[index] = _runningSum[index] / _windowSize;
         }
+        oldestSample = inputSample;
+        _head = (_head + 1) % _windowSize;
+        if (_head == 0)
+        {
+            for (size_t index = 0; index < _runningSum.size(); ++index)
+            {
+                ValueType sum = 0;
+                for (const auto& sample : _samples)
+                {
+                    sum += sample[index];
+                }
+                _runningSum[index] = sum;
+            }
+        }
         _output.SetOutput(result);
     };
 
+    template <typename ValueType>
+    void MovingAverageNode<ValueType>::Reset()
+    {
+        for (auto& sample : _samples)
+        {
+            std::fill(sample.begin(), sample.end(), static_cast<ValueType>(0));
+        }
+        std::fill(_runningSum.begin(), _runningSum.end(), static_cast<ValueType>(0));
+        _head = 0;
+    }
+
     template <typename ValueType>
     void MovingAverageNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
@@ -147,17 +175,51 @@ namespace nodes
     }
 
     template <typename ValueType>
-    bool MovingAverageNode<ValueType>::Refine(model::ModelTransformer& transformer) const
+    void MovingAverageNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
-        const auto& newInputs = transformer.GetCorrespondingInputs(_input);
-        std::vector<ValueType> literalN(newInputs.Size(), (ValueType)_windowSize);
-        const auto& delay = Delay(newInputs, _windowSize);
-        const auto& difference = Subtract(newInputs, delay);
-        const auto& accum = Accumulate(difference);
-        const auto& denominator = Constant(transformer, literalN);
-        const auto& quotient = Divide(accum, denominator);
-        transformer.MapNodeOutput(output, quotient);
-        return true;
+        const int dimension = static_cast<int>(_input.Size());
+        const int windowSize = static_cast<int>(_windowSize);
+
+        auto pInput = function.LocalArray(compiler.EnsurePortEmitted(input));
+        auto pOutput = function.LocalArray(compiler.EnsurePortEmitted(output));
+
+        auto& module = function.GetModule();
+        auto samplesVar = module.GlobalArray<ValueType>(compiler.GetGlobalName(*this, "samples"), dimension * windowSize);
+        auto runningSumVar = module.GlobalArray<ValueType>(compiler.GetGlobalName(*this, "runningSum"), dimension);
+        auto samples = function.LocalArray(samplesVar);
+        auto runningSum = function.LocalArray(runningSumVar);
+        auto headVar = module.Global<int>(compiler.GetGlobalName(*this, "head"), 0);
+        auto head = function.LocalScalar(function.Load(headVar));
+
+        // The new sample replaces the oldest one, in the ring and in the running sum
+        auto oldestSample = head * dimension;
+        function.For(dimension, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
+            auto newValue = emitters::IRLocalScalar(pInput[i]);
+            auto sum = runningSum[i] + (newValue - samples[oldestSample + i]);
+            runningSum[i] = sum;
+            samples[oldestSample + i] = newValue;
+            pOutput[i] = sum / static_cast<ValueType>(windowSize);
+        });
+        auto newHead = (head + 1) % windowSize;
+        function.Store(headVar, newHead);
+
+        // The same summing again as in Compute, once per wrap of the ring
+        function.If(newHead == 0, [=](emitters::IRFunctionEmitter& fn) {
+            fn.For(dimension, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
+                runningSum[i] = fn.LocalScalar<ValueType>(0);
+                fn.For(windowSize, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar sampleIndex) {
+                    runningSum[i] = runningSum[i] + emitters::IRLocalScalar(samples[sampleIndex * dimension + i]);
+                });
+            });
+        });
+
+        // Add the internal reset function, which empties the window
+        std::string resetFunctionName = compiler.GetGlobalName(*this, "MovingAverageNodeReset");
+        emitters::IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionName);
+        resetFunction.MemorySet<ValueType>(samplesVar, 0, resetFunction.Literal<uint8_t>(0), dimension * windowSize);
+        resetFunction.MemorySet<ValueType>(runningSumVar, 0, resetFunction.Literal<uint8_t>(0), dimension);
+        resetFunction.Store(headVar, resetFunction.Literal<int>(0));
+        module.EndResetFunction();
     }
 
     template <typename ValueType>
@@ -182,6 +244,7 @@ namespace nodes
         {
             _samples.push_back(std::vector<ValueType>(dimension));
         }
+        _head = 0;
         _runningSum = std::vector<ValueType>(dimension);
         _output.SetSize(dimension);
     }
@@ -8,13 +8,15 @@
 
 #pragma once
 
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
 #include <model/include/InputPort.h>
 #include <model/include/ModelTransformer.h>
-#include <model/include/Node.h>
 #include <model/include/OutputPort.h>
 
 #include <utilities/include/TypeName.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -22,9 +24,15 @@ namespace ell
 {
 namespace nodes
 {
-    /// <summary> A node that takes a vector input and returns its variance over some window of time. </summary>
+    /// <summary>
+    /// A node that takes a vector input and returns its variance over some window of time. The last `windowSize`
+    /// samples are kept in a ring along with their running mean and sum of squared deviations, which are updated
+    /// Welford-style as each new sample replaces the oldest one, so each sample costs the same whatever the window size.
+    /// Rounding errors would build up in them over a long stream, so they're computed again from the ring each time the
+    /// ring wraps around.
+    /// </summary>
     template <typename ValueType>
-    class MovingVarianceNode : public model::Node
+    class MovingVarianceNode : public model::CompilableNode
     {
     public:
         /// @name Input and Output Ports
@@ -51,8 +59,12 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Resets the state of the node </summary>
+        void Reset() override;
+
     protected:
         void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; }
@@ -67,9 +79,10 @@ namespace nodes
         model::OutputPort<ValueType> _output;
 
         // Buffer
-        mutable std::vector<std::vector<ValueType>> _samples;
-        mutable std::vector<ValueType> _runningSum;
-        mutable std::vector<ValueType> _runningSquaredSum;
+        mutable std::vector<std::vector<ValueType>> _samples; // a ring, whose oldest sample is at _head
+        mutable size_t _head = 0;
+        mutable std::vector<ValueType> _runningMean;
+        mutable std::vector<ValueType> _runningSquaredDeviation; // the sum of squared differences from the mean
         size_t _windowSize;
     };
 
@@ -86,7 +99,7 @@ namespace nodes
 {
     template <typename ValueType>
     MovingVarianceNode<ValueType>::MovingVarianceNode() :
-        Node({ &_input }, { &_output }),
+        CompilableNode({ &_input }, { &_output }),
         _input(this, {}, defaultInputPortName),
         _output(this, defaultOutputPortName, 0),
         _windowSize(0)
@@ -95,7 +108,7 @@ namespace nodes
 
     template <typename ValueType>
     MovingVarianceNode<ValueType>::MovingVarianceNode(const model::OutputPort<ValueType>& input, size_t windowSize) :
-        Node({ &_input }, { &_output }),
+        CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, _input.Size()),
         _windowSize(windowSize)
@@ -105,30 +118,131 @@ namespace nodes
         {
             _samples.push_back(std::vector<ValueType>(dimension));
         }
-        _runningSum = std::vector<ValueType>(dimension);
-        _runningSquaredSum = std::vector<ValueType>(dimension);
+        _runningMean = std::vector<ValueType>(dimension);
+        _runningSquaredDeviation = std::vector<ValueType>(dimension);
     }
 
     template <typename ValueType>
     void MovingVarianceNode<ValueType>::Compute() const
     {
-        static auto squared = [](const ValueType& x) { return x * x; };
-
+        // The new sample x replaces the oldest one y. With d = x - y, the mean moves by d / windowSize, and the sum
+        // of squared deviations by d * ((x - newMean) + (y - oldMean))
         auto inputSample = _input.GetValue();
-        auto lastBufferedSample = _samples[0];
-        _samples.push_back(inputSample);
-        _samples.erase(_samples.begin());
+        auto& oldestSample = _samples[_head];
 
         std::vector<ValueType> result(_input.Size());
         for (size_t index = 0; index < inputSample.size(); ++index)
         {
-            _runningSum[index] += (inputSample[index] - lastBufferedSample[index]);
-            _runningSquaredSum[index] += squared(inputSample[index]) - squared(lastBufferedSample[index]);
-            result[index] = (_runningSquaredSum[index] - (squared(_runningSum[index]) / _windowSize)) / _windowSize;
+            auto newValue = inputSample[index];
+            auto oldValue = oldestSample[index];
+            auto oldMean = _runningMean[index];
+            auto difference = newValue - oldValue;
+            auto newMean = oldMean + difference / _windowSize;
+            _runningMean[index] = newMean;
+            _runningSquaredDeviation[index] += difference * ((newValue - newMean) + (oldValue - oldMean));
+            result[index] = _runningSquaredDeviation[index] / _windowSize;
+        }
+        oldestSample = inputSample;
+        _head = (_head + 1) % _windowSize;
+        if (_head == 0)
+        {
+            // Rounding errors build up in the running statistics, so they're computed again from the ring each time
+            // it wraps around
+            for (size_t index = 0; index < _runningMean.size(); ++index)
+            {
+                ValueType sum = 0;
+                for (const auto& sample : _samples)
+                {
+                    sum += sample[index];
+                }
+                auto mean = sum / _windowSize;
+                ValueType squaredDeviation = 0;
+                for (const auto& sample : _samples)
+                {
+                    auto deviation = sample[index] - mean;
+                    squaredDeviation += deviation * deviation;
+                }
+                _runningMean[index] = mean;
+                _runningSquaredDeviation[index] = squaredDeviation;
+            }
         }
         _output.SetOutput(result);
     };
 
+    template <typename ValueType>
+    void MovingVarianceNode<ValueType>::Reset()
+    {
+        for (auto& sample : _samples)
+        {
+            std::fill(sample.begin(), sample.end(), static_cast<ValueType>(0));
+        }
+        std::fill(_runningMean.begin(), _runningMean.end(), static_cast<ValueType>(0));
+        std::fill(_runningSquaredDeviation.begin(), _runningSquaredDeviation.end(), static_cast<ValueType>(0));
+        _head = 0;
+    }
+
+    template <typename ValueType>
+    void MovingVarianceNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        const int dimension = static_cast<int>(_input.Size());
+        const int windowSize = static_cast<int>(_windowSize);
+
+        auto pInput = function.LocalArray(compiler.EnsurePortEmitted(input));
+        auto pOutput = function.LocalArray(compiler.EnsurePortEmitted(output));
+
+        auto& module = function.GetModule();
+        auto samplesVar = module.GlobalArray<ValueType>(compiler.GetGlobalName(*this, "samples"), dimension * windowSize);
+        auto runningMeanVar = module.GlobalArray<ValueType>(compiler.GetGlobalName(*this, "runningMean"), dimension);
+        auto runningSquaredDeviationVar = module.GlobalArray<ValueType>(compiler.GetGlobalName(*this, "runningSquaredDeviation"), dimension);
+        auto samples = function.LocalArray(samplesVar);
+        auto runningMean = function.LocalArray(runningMeanVar);
+        auto runningSquaredDeviation = function.LocalArray(runningSquaredDeviationVar);
+        auto headVar = module.Global<int>(compiler.GetGlobalName(*this, "head"), 0);
+        auto head = function.LocalScalar(function.Load(headVar));
+
+        // The same update as in Compute
+        auto oldestSample = head * dimension;
+        function.For(dimension, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
+            auto newValue = emitters::IRLocalScalar(pInput[i]);
+            auto oldValue = emitters::IRLocalScalar(samples[oldestSample + i]);
+            auto oldMean = emitters::IRLocalScalar(runningMean[i]);
+            auto difference = newValue - oldValue;
+            auto newMean = oldMean + difference / static_cast<ValueType>(windowSize);
+            auto squaredDeviation = runningSquaredDeviation[i] + difference * ((newValue - newMean) + (oldValue - oldMean));
+            runningMean[i] = newMean;
+            runningSquaredDeviation[i] = squaredDeviation;
+            samples[oldestSample + i] = newValue;
+            pOutput[i] = squaredDeviation / static_cast<ValueType>(windowSize);
+        });
+        auto newHead = (head + 1) % windowSize;
+        function.Store(headVar, newHead);
+
+        // The same computing again as in Compute, once per wrap of the ring
+        function.If(newHead == 0, [=](emitters::IRFunctionEmitter& fn) {
+            fn.For(dimension, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
+                runningMean[i] = fn.LocalScalar<ValueType>(0);
+                fn.For(windowSize, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar sampleIndex) {
+                    runningMean[i] = runningMean[i] + emitters::IRLocalScalar(samples[sampleIndex * dimension + i]);
+                });
+                runningMean[i] = runningMean[i] / static_cast<ValueType>(windowSize);
+                runningSquaredDeviation[i] = fn.LocalScalar<ValueType>(0);
+                fn.For(windowSize, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar sampleIndex) {
+                    auto deviation = emitters::IRLocalScalar(samples[sampleIndex * dimension + i]) - runningMean[i];
+                    runningSquaredDeviation[i] = runningSquaredDeviation[i] + deviation * deviation;
+                });
+            });
+        });
+
+        // Add the internal reset function, which empties the window
+        std::string resetFunctionName = compiler.GetGlobalName(*this, "MovingVarianceNodeReset");
+        emitters::IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionName);
+        resetFunction.MemorySet<ValueType>(samplesVar, 0, resetFunction.Literal<uint8_t>(0), dimension * windowSize);
+        resetFunction.MemorySet<ValueType>(runningMeanVar, 0, resetFunction.Literal<uint8_t>(0), dimension);
+        resetFunction.MemorySet<ValueType>(runningSquaredDeviationVar, 0, resetFunction.Literal<uint8_t>(0), dimension);
+        resetFunction.Store(headVar, resetFunction.Literal<int>(0));
+        module.EndResetFunction();
+    }
+
     template <typename ValueType>
     void MovingVarianceNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
@@ -156,8 +270,9 @@ namespace nodes
         _samples.clear();
         _samples.reserve(_windowSize);
         std::generate_n(std::back_inserter(_samples), _windowSize, [dimension] { return std::vector<ValueType>(dimension); });
-        _runningSum = std::vector<ValueType>(dimension);
-        _runningSquaredSum = std::vector<ValueType>(dimension);
+        _head = 0;
+        _runningMean = std::vector<ValueType>(dimension);
+        _runningSquaredDeviation = std::vector<ValueType>(dimension);
         _output.SetSize(dimension);
     }
 
@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     OutputEpilogue.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <emitters/include/IRFunctionEmitter.h>
+#include <emitters/include/IRLocalScalar.h>
+
+#include <model/include/PortMemoryLayout.h>
+
+#include <utilities/include/Archiver.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary> The activation functions an OutputEpilogue can apply. </summary>
+    enum class EpilogueActivation : int
+    {
+        none,
+        reLU,
+        leakyReLU,
+        parametricReLU,
+        clamp
+    };
+
+    /// <summary>
+    /// Per-channel work that a node applies to each of its output values as it writes them: first a bias is added,
+    /// then an activation function is applied. Fusing these into the node that computes the values saves the passes
+    /// over the output that separate bias and activation nodes would make.
+    /// </summary>
+    template <typename ValueType>
+    class OutputEpilogue
+    {
+    public:
+        /// <summary> Pointers to the arrays of constants the epilogue reads, in the code being emitted. </summary>
+        struct EmittedConstants
+        {
+            emitters::LLVMValue bias = nullptr; // null if the epilogue has no bias
+            emitters::LLVMValue alpha = nullptr; // null unless the activation is parametric ReLU
+        };
+
+        /// <summary> Sets the bias to add to each channel. </summary>
+        ///
+        /// <param name="bias"> The bias, one entry per channel. </param>
+        void SetBias(const std::vector<ValueType>& bias);
+
+        /// <summary> Applies the ReLU function after the bias. </summary>
+        void SetReLU();
+
+        /// <summary> Applies the leaky ReLU function after the bias. </summary>
+        ///
+        /// <param name="leakyFactor"> The factor negative values are multiplied by. </param>
+        void SetLeakyReLU(ValueType leakyFactor);
+
+        /// <summary> Applies the parametric ReLU function after the bias. </summary>
+        ///
+        /// <param name="alpha"> The factor negative values are multiplied by, one entry per channel. </param>
+        void SetParametricReLU(const std::vector<ValueType>& alpha);
+
+        /// <summary> Clamps values to a range after the bias. </summary>
+        ///
+        /// <param name="minValue"> The smallest value to output. </param>
+        /// <param name="maxValue"> The largest value to output. </param>
+        void SetClamp(ValueType minValue, ValueType maxValue);
+
+        /// <summary> Indicates if the epilogue leaves values unchanged. </summary>
+        bool IsEmpty() const { return !HasBias() && _activation == EpilogueActivation::none; }
+
+        /// <summary> Indicates if the epilogue adds a bias. </summary>
+        bool HasBias() const { return !_bias.empty(); }
+
+        /// <summary> Gets the activation function applied after the bias. </summary>
+        EpilogueActivation GetActivation() const { return _activation; }
+
+        /// <summary> Computes the epilogue of a single value (on the host machine). </summary>
+        ///
+        /// <param name="x"> The value. </param>
+        /// <param name="channel"> The channel the value is in. </param>
+        ///
+        /// <returns> The value with the epilogue applied. </returns>
+        ValueType Compute(ValueType x, int channel) const;
+
+        /// <summary> Applies the epilogue in place to a block of values (on the host machine). </summary>
+        ///
+        /// <param name="values"> The values. </param>
+        /// <param name="numPixels"> The number of values in each channel. </param>
+        /// <param name="numChannels"> The number of channels. </param>
+        /// <param name="pixelStride"> The distance between consecutive values of a channel. </param>
+        /// <param name="channelStride"> The distance between the values of consecutive channels. </param>
+        void Compute(std::vector<ValueType>& values, int numPixels, int numChannels, int pixelStride, int channelStride) const;
+
+        /// <summary> Emits code to compute the epilogue of a single value. </summary>
+        ///
+        /// <param name="function"> The function being compiled. </param>
+        /// <param name="identifier"> A name, unique to the node, for the constants the epilogue reads. </param>
+        /// <param name="x"> The value. </param>
+        /// <param name="channel"> The channel the value is in. </param>
+        ///
+        /// <returns> The value with the epilogue applied. </returns>
+        emitters::IRLocalScalar Compile(emitters::IRFunctionEmitter& function, const std::string& identifier, emitters::IRLocalScalar x, emitters::IRLocalScalar channel) const;
+
+        /// <summary> Emits code to compute the epilogue of a single value, reading its constants from arrays emitted elsewhere. </summary>
+        ///
+        /// <param name="function"> The function being compiled. </param>
+        /// <param name="constants"> The constants the epilogue reads. </param>
+        /// <param name="x"> The value. </param>
+        /// <param name="channel"> The channel the value is in. </param>
+        ///
+        /// <returns> The value with the epilogue applied. </returns>
+        emitters::IRLocalScalar Compile(emitters::IRFunctionEmitter& function, const EmittedConstants& constants, emitters::IRLocalScalar x, emitters::IRLocalScalar channel) const;
+
+        /// <summary> Emits code to apply the epilogue in place to a block of values. </summary>
+        ///
+        /// <param name="function"> The function being compiled. </param>
+        /// <param name="identifier"> A name, unique to the node, for the constants the epilogue reads. </param>
+        /// <param name="values"> Pointer to the values. </param>
+        /// <param name="numPixels"> The number of values in each channel. </param>
+        /// <param name="numChannels"> The number of channels. </param>
+        /// <param name="pixelStride"> The distance between consecutive values of a channel. </param>
+        /// <param name="channelStride"> The distance between the values of consecutive channels. </param>
+        void Compile(emitters::IRFunctionEmitter& function, const std::string& identifier, emitters::LLVMValue values, int numPixels, int numChannels, int pixelStride, int channelStride) const;
+
+        /// <summary> Emits code to apply the epilogue in place to a block of values, reading its constants from arrays emitted elsewhere. </summary>
+        ///
+        /// <param name="function"> The function being compiled. </param>
+        /// <param name="constants"> The constants the epilogue reads. </param>
+        /// <param name="values"> Pointer to the values. </param>
+        /// <param name="numPixels"> The number of values in each channel. </param>
+        /// <param name="numChannels"> The number of channels. </param>
+        /// <param name="pixelStride"> The distance between consecutive values of a channel. </param>
+        /// <param name="channelStride"> The distance between the values of consecutive channels. </param>
+        void Compile(emitters::IRFunctionEmitter& function, const EmittedConstants& constants, emitters::LLVMValue values, int numPixels, int numChannels, int pixelStride, int channelStride) const;
+
+        /// <summary> Emits the constants the epilogue reads into a module, or finds them if they're already there. </summary>
+        ///
+        /// <param name="module"> The module. </param>
+        /// <param name="identifier"> A name, unique to the node, for the constants. </param>
+        ///
+        /// <returns> Pointers to the constants. </returns>
+        EmittedConstants EmitConstants(emitters::IRModuleEmitter& module, const std::string& identifier) const;
+
+        /// <summary> Gets a string that identifies the code the epilogue compiles to when its constants are emitted elsewhere:
+        /// everything but the values of the bias and the parametric ReLU's factors. </summary>
+        std::string GetCodeKey() const;
+
+        /// <summary> Adds the epilogue to a node's archive, if it isn't empty. </summary>
+        ///
+        /// <param name="archiver"> The archiver. </param>
+        void WriteToArchive(utilities::Archiver& archiver) const;
+
+        /// <summary> Reads the epilogue from a node's archive, if it has one. </summary>
+        ///
+        /// <param name="archiver"> The unarchiver. </param>
+        void ReadFromArchive(utilities::Unarchiver& archiver);
+
+    private:
+        std::vector<ValueType> _bias;
+        EpilogueActivation _activation = EpilogueActivation::none;
+        std::vector<ValueType> _alpha;
+        ValueType _leakyFactor = 0;
+        ValueType _minValue = 0;
+        ValueType _maxValue = 0;
+    };
+
+    /// <summary> Interface for nodes that can apply an OutputEpilogue to their output as they compute it. </summary>
+    template <typename ValueType>
+    class IOutputEpilogueNode
+    {
+    public:
+        virtual ~IOutputEpilogueNode() = default;
+
+        /// <summary> Indicates if the node can apply an epilogue whose channels are dimension 2 of the given layout. </summary>
+        ///
+        /// <param name="outputLayout"> The layout the node's consumers read its output with. </param>
+        virtual bool CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const = 0;
+
+        /// <summary> Gets the epilogue applied to the node's output. </summary>
+        virtual const OutputEpilogue<ValueType>& GetEpilogue() const = 0;
+
+        /// <summary> Sets the epilogue applied to the node's output. </summary>
+        virtual void SetEpilogue(const OutputEpilogue<ValueType>& epilogue) = 0;
+    };
+} // namespace nodes
+} // namespace ell
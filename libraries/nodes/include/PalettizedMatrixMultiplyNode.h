@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PalettizedMatrixMultiplyNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "OutputEpilogue.h"
+
+#include <emitters/include/IRFunctionEmitter.h>
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/Node.h>
+#include <model/include/OutputPort.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <utilities/include/IArchivable.h>
+#include <utilities/include/TypeName.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A node that multiplies a constant matrix of weights with its input matrix, where the weights are stored as
+    /// indices into a small codebook of values (a palette) shared by the whole matrix. With 4-bit indices, the codebook
+    /// has up to 16 entries, and with 8-bit indices, up to 256, so the weights take a quarter or an eighth of the
+    /// memory of 32-bit values. Each row of weights is decoded, through the codebook, just before it's multiplied with
+    /// the input, which makes the layers whose speed is bound by loading their weights, like matrix-vector products,
+    /// faster. An OutputEpilogue can be applied to the product, with the columns of the output matrix (as stored in
+    /// memory) as its channels, as with MatrixMatrixMultiplyNode.
+    /// </summary>
+    template <typename ValueType>
+    class PalettizedMatrixMultiplyNode : public model::CompilableNode
+        , public IOutputEpilogueNode<ValueType>
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        PalettizedMatrixMultiplyNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The right-hand input of the multiplication, a k x n matrix. </param>
+        /// <param name="codebook"> The values of the weights, at most 2^indexBits of them. </param>
+        /// <param name="indices"> The index into the codebook of each weight, for the m x k matrix of weights in row-major order. </param>
+        /// <param name="indexBits"> The number of bits of each stored index, 4 or 8. </param>
+        /// <param name="m"> The number of rows of the weights and the output. </param>
+        /// <param name="n"> The number of columns of the input and the output. </param>
+        /// <param name="k"> The number of columns of the weights and rows of the input. </param>
+        /// <param name="inputStride"> The distance between the rows of the input (or the columns, if it's transposed). </param>
+        /// <param name="transposeInput"> If true, the input is stored as its n x k transpose. </param>
+        /// <param name="outputStride"> The distance between the rows of the output (or the columns, if it's transposed). </param>
+        /// <param name="transposeOutput"> If true, the output is stored as its n x m transpose. </param>
+        PalettizedMatrixMultiplyNode(const model::OutputPort<ValueType>& input, const std::vector<ValueType>& codebook, const std::vector<int>& indices, int indexBits, int m, int n, int k, int inputStride, bool transposeInput, int outputStride, bool transposeOutput);
+
+        /// <summary> Constructor that multiplies a new input with the weights, dimensions, and epilogue of another node. </summary>
+        ///
+        /// <param name="input"> The right-hand input of the multiplication, a k x n matrix. </param>
+        /// <param name="other"> The node to copy the weights from. </param>
+        PalettizedMatrixMultiplyNode(const model::OutputPort<ValueType>& input, const PalettizedMatrixMultiplyNode<ValueType>& other);
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("PalettizedMatrixMultiplyNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
+        /// <summary> Gets the codebook of weight values. </summary>
+        const std::vector<ValueType>& GetCodebook() const { return _codebook; }
+
+        /// <summary> Gets the number of bits of each stored index. </summary>
+        int GetIndexBits() const { return _indexBits; }
+
+        /// <summary> Gets the weights, decoded to a dense m x k matrix in row-major order. </summary>
+        std::vector<ValueType> GetWeights() const;
+
+        /// <summary> Gets the number of bytes the codebook and the indices take. </summary>
+        int64_t GetWeightsBytes() const;
+
+        /// <summary> Indicates if the node can apply an epilogue whose channels are dimension 2 of the given layout. </summary>
+        bool CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const override;
+
+        /// <summary> Gets the epilogue applied to the product. </summary>
+        const OutputEpilogue<ValueType>& GetEpilogue() const override { return _epilogue; }
+
+        /// <summary> Sets the epilogue applied to the product. </summary>
+        void SetEpilogue(const OutputEpilogue<ValueType>& epilogue) override { _epilogue = epilogue; }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: the codebook, indices, dimensions, and epilogue
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+        int GetRowBytes() const { return (_k * _indexBits + 7) / 8; }
+        int GetIndex(int row, int column) const;
+        void CompileStoreResult(emitters::IRFunctionEmitter& function, emitters::LLVMValue output, const typename OutputEpilogue<ValueType>::EmittedConstants& epilogueConstants, emitters::IRLocalScalar row, emitters::IRLocalScalar column, emitters::IRLocalScalar value);
+
+        // Inputs
+        model::InputPort<ValueType> _input;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        // The product is m x n, and the input is k x n
+        int _m = 0, _n = 0, _k = 0;
+        int _ldb = 0, _ldc = 0;
+        bool _transposeInput = false, _transposeOutput = false;
+
+        // The weights: each row of indices starts on a byte, and with 4-bit indices, the index of an even column is
+        // in the low half of its byte, and the next one in the high half
+        int _indexBits = 8;
+        std::vector<ValueType> _codebook;
+        std::vector<uint8_t> _packedIndices;
+
+        OutputEpilogue<ValueType> _epilogue;
+    };
+} // namespace nodes
+} // namespace ell
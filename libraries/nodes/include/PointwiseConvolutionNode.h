@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PointwiseConvolutionNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <math/include/Tensor.h>
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <string>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A 1x1 (pointwise) convolution computed directly on data in the usual (row, column, channel) order, as a matrix
+    /// product of the pixels and the filters that never copies the input. A block of output pixels is computed at a
+    /// time, so each weight is loaded once per block, and the innermost loop runs over the filters, which are
+    /// contiguous in both the output and the reordered weights. SetConvolutionMethodTransformation uses this node for
+    /// 1x1 convolutional layers when no convolution method is requested.
+    /// </summary>
+    template <typename ValueType>
+    class PointwiseConvolutionNode : public model::CompilableNode
+    {
+    public:
+        using TensorType = math::ChannelColumnRowTensor<ValueType>;
+        using ConstTensorReferenceType = math::ConstChannelColumnRowTensorReference<ValueType>;
+
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default constructor. </summary>
+        PointwiseConvolutionNode();
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. </param>
+        /// <param name="inputMemoryLayout"> The layout of the input data, in canonical order. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output data, in canonical order. </param>
+        /// <param name="filterWeights"> The weights for the convolutional filters. Stored as a 3D tensor of
+        ///  dimensions nf x 1 x d, where nf == # filters and d == input depth. </param>
+        /// <param name="stride"> The output stride. </param>
+        PointwiseConvolutionNode(const model::OutputPort<ValueType>& input,
+                                 const model::PortMemoryLayout& inputMemoryLayout,
+                                 const model::PortMemoryLayout& outputMemoryLayout,
+                                 const ConstTensorReferenceType& filterWeights,
+                                 int stride);
+
+        /// <summary> Gets information about the input memory layout </summary>
+        const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
+
+        /// <summary> Gets information about the output memory layout </summary>
+        model::PortMemoryLayout GetOutputMemoryLayout() const { return _output.GetMemoryLayout(); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("PointwiseConvolutionNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: convolutional parameters and memory layout
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+        void VerifyLayouts() const;
+
+        // Returns the weights as a (channel, filter) matrix, so the weights of consecutive filters are contiguous
+        std::vector<ValueType> GetTransposedWeights() const;
+
+        // Input
+        model::InputPort<ValueType> _input;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        model::PortMemoryLayout _inputMemoryLayout;
+
+        TensorType _filterWeights;
+
+        int _stride = 1;
+    };
+} // namespace nodes
+} // namespace ell
@@ -25,7 +25,9 @@ namespace ell
 {
 namespace nodes
 {
-    /// <summary> A node that wraps a neural net PoolingLayer. </summary>
+    /// <summary> A node that wraps a neural net PoolingLayer. The compiled code pools vectors of consecutive channels
+    /// at a time, computes max pooling over large windows as separate row and column passes and global average pooling
+    /// as a single pass over the input. </summary>
     template <typename ValueType, template <typename> class PoolingFunctionType>
     class PoolingLayerNode : public NeuralNetworkLayerNode<PoolingLayerNode<ValueType, PoolingFunctionType>, predictors::neural::PoolingLayer<ValueType, PoolingFunctionType>, ValueType>
     {
@@ -45,7 +47,11 @@ namespace nodes
         ///
         /// <param name="input"> The input to the layer. </param>
         /// <param name="layer"> The bias layer to wrap. </param>
-        PoolingLayerNode(const model::OutputPort<ValueType>& input, const predictors::neural::PoolingLayer<ValueType, PoolingFunctionType>& layer);
+        /// <param name="rectifyInput"> If true, the layer pools the ReLU of the input, as if a ReLU activation came before it. </param>
+        PoolingLayerNode(const model::OutputPort<ValueType>& input, const predictors::neural::PoolingLayer<ValueType, PoolingFunctionType>& layer, bool rectifyInput = false);
+
+        /// <summary> Indicates if the layer pools the ReLU of its input. </summary>
+        bool RectifiesInput() const { return _rectifyInput; }
 
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
@@ -63,24 +69,30 @@ namespace nodes
         using BaseType::GetLayer;
 
     protected:
-        template <typename PoolingFunctionT>
         emitters::LLVMValue GetPoolingWindowValue(emitters::IRFunctionEmitter& function,
                                                   int windowRowStart,
                                                   int windowRowEnd,
                                                   int windowColumnStart,
                                                   int windowColumnEnd,
-                                                  emitters::LLVMValue inputRow,
-                                                  emitters::LLVMValue inputColumn,
-                                                  emitters::LLVMValue inputChannel,
+                                                  emitters::IRLocalScalar inputRow,
+                                                  emitters::IRLocalScalar inputColumn,
+                                                  emitters::IRLocalScalar inputChannel,
                                                   emitters::LLVMValue inputBuffer,
                                                   const model::MemoryShape& inputIncrement,
-                                                  PoolingFunctionT& poolingFunction);
+                                                  int numLanes);
 
+        void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
         using BaseType::HasState;
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
+        void CompileGlobalMeanPooling(emitters::IRFunctionEmitter& function, emitters::LLVMValue inputBuffer, emitters::LLVMValue outputBuffer, const model::MemoryShape& inputIncrement, const model::MemoryShape& outputIncrement, const model::MemoryShape& inputSize, int vectorSize);
+        void CompileSeparableMaxPooling(emitters::IRFunctionEmitter& function, emitters::LLVMValue inputBuffer, emitters::LLVMValue outputBuffer, const model::MemoryShape& inputIncrement, const model::MemoryShape& outputIncrement, const model::MemoryShape& inputSize, int vectorSize);
+
+        bool _rectifyInput = false;
     };
 } // namespace nodes
 } // namespace ell
@@ -8,21 +8,28 @@
 
 #pragma once
 
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
 #include <model/include/Model.h>
 #include <model/include/ModelTransformer.h>
-#include <model/include/Node.h>
 #include <model/include/PortElements.h>
 
 #include <predictors/include/ProtoNNPredictor.h>
 
 #include <string>
+#include <vector>
 
 namespace ell
 {
 namespace nodes
 {
-    /// <summary> A node that represents a ProtoNN predictor. </summary>
-    class ProtoNNPredictorNode : public model::Node
+    /// <summary>
+    /// A node that represents a ProtoNN predictor. When compiled, the whole predictor is emitted as one kernel: a GEMV
+    /// that projects the input, a GEMV against the prototypes (pre-scaled by 2 * gamma^2, with their squared norms
+    /// precomputed) that yields the exponents of the RBF kernel for all prototypes at once, an elementwise exp, and a
+    /// GEMV against the label embeddings.
+    /// </summary>
+    class ProtoNNPredictorNode : public model::CompilableNode
     {
     public:
         /// @name Input and Output Ports
@@ -59,12 +66,20 @@ namespace nodes
 
     protected:
         void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        bool HasState() const override { return true; } // stored state: the predictor
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
 
+        // The compiled kernel's constants, as row-major matrices
+        std::vector<double> GetProjectionWeights() const;
+        std::vector<double> GetScaledPrototypes() const;
+        std::vector<double> GetPrototypeOffsets() const;
+        std::vector<double> GetLabelEmbeddingWeights() const;
+
         // Inputs
         model::InputPort<double> _input;
 
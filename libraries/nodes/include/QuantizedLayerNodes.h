@@ -0,0 +1,395 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     QuantizedLayerNodes.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <math/include/Matrix.h>
+#include <math/include/Tensor.h>
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/OutputPort.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <utilities/include/TypeName.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A convolution computed with 8-bit integer arithmetic. The input is quantized with a single scale (chosen
+    /// ahead of time, typically by calibrating on sample data), the filter weights are quantized with one scale per
+    /// filter, and the products are accumulated in 32-bit integers before being scaled back to `ValueType`.
+    /// The input and output ports are the same as those of the full-precision convolution this node replaces.
+    /// </summary>
+    template <typename ValueType>
+    class QuantizedConvolutionalLayerNode : public model::CompilableNode
+    {
+    public:
+        using ConstTensorReferenceType = math::ConstChannelColumnRowTensorReference<ValueType>;
+
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default constructor. </summary>
+        QuantizedConvolutionalLayerNode();
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. </param>
+        /// <param name="inputMemoryLayout"> The layout of the input data. Must be in row-major (row, column, channel) order, with padding of at least half the filter size. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output data. Must be in row-major (row, column, channel) order. </param>
+        /// <param name="filterWeights"> The full-precision weights for the convolutional filters. Stored
+        ///  as a 3D tensor of dimensions (nf*fw) x fw x d, where nf == # filters, fw == filter width, and d == input depth. </param>
+        /// <param name="stride"> The output stride. </param>
+        /// <param name="inputScale"> The quantization step of the input: input values are divided by this and rounded to the range [-127, 127]. </param>
+        QuantizedConvolutionalLayerNode(const model::OutputPort<ValueType>& input,
+                                        const model::PortMemoryLayout& inputMemoryLayout,
+                                        const model::PortMemoryLayout& outputMemoryLayout,
+                                        const ConstTensorReferenceType& filterWeights,
+                                        int stride,
+                                        ValueType inputScale);
+
+        /// <summary> Constructor from weights that have already been quantized. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. </param>
+        /// <param name="inputMemoryLayout"> The layout of the input data. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output data. </param>
+        /// <param name="weights"> The quantized filter weights, in (filter, row, column, channel) order. </param>
+        /// <param name="weightScales"> The quantization step of each filter's weights. </param>
+        /// <param name="filterSize"> The filter width. </param>
+        /// <param name="stride"> The output stride. </param>
+        /// <param name="inputScale"> The quantization step of the input. </param>
+        QuantizedConvolutionalLayerNode(const model::OutputPort<ValueType>& input,
+                                        const model::PortMemoryLayout& inputMemoryLayout,
+                                        const model::PortMemoryLayout& outputMemoryLayout,
+                                        const std::vector<int8_t>& weights,
+                                        const std::vector<ValueType>& weightScales,
+                                        int filterSize,
+                                        int stride,
+                                        ValueType inputScale);
+
+        /// <summary> Gets information about the input memory layout </summary>
+        const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
+
+        /// <summary> Gets information about the output memory layout </summary>
+        model::PortMemoryLayout GetOutputMemoryLayout() const { return _output.GetMemoryLayout(); }
+
+        /// <summary> Gets the quantized filter weights, in (filter, row, column, channel) order. </summary>
+        const std::vector<int8_t>& GetQuantizedWeights() const { return _weights; }
+
+        /// <summary> Gets the quantization step of the input. </summary>
+        ValueType GetInputScale() const { return _inputScale; }
+
+        /// <summary> Gets the quantization step of each filter's weights. </summary>
+        const std::vector<ValueType>& GetWeightScales() const { return _weightScales; }
+
+        /// <summary> Returns true if the node can accept input with this memory layout order, else false </summary>
+        ///
+        /// <param name="order"> The memory layout order for all the input ports </summary>
+        /// <returns> If the node can accept the input memory layout order, true, else false </returns>
+        bool CanAcceptInputLayout(const utilities::DimensionOrder& order) const override
+        {
+            return GetInputMemoryLayout().GetLogicalDimensionOrder() == order;
+        }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("QuantizedConvolutionalLayerNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
+        /// <summary> Returns the number of bytes one evaluation of this node reads, including its quantized weights. </summary>
+        int64_t GetBytesRead() const override;
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: quantized weights, scales and memory layout
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        // Input
+        model::InputPort<ValueType> _input;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        model::PortMemoryLayout _inputMemoryLayout;
+
+        std::vector<int8_t> _weights;
+        std::vector<ValueType> _weightScales;
+        ValueType _inputScale = 1;
+        int _filterSize = 0;
+        int _stride = 1;
+    };
+
+    /// <summary>
+    /// A fully-connected layer computed with 8-bit integer arithmetic. The input is quantized with a single scale,
+    /// each row of the weights matrix is quantized with its own scale, and the products are accumulated in 32-bit
+    /// integers before being scaled back to `ValueType`.
+    /// </summary>
+    template <typename ValueType>
+    class QuantizedFullyConnectedLayerNode : public model::CompilableNode
+    {
+    public:
+        using ConstMatrixReferenceType = math::ConstRowMatrixReference<ValueType>;
+
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default constructor. </summary>
+        QuantizedFullyConnectedLayerNode();
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. The input must not have padding. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output data. The output must not have padding. </param>
+        /// <param name="weights"> The full-precision weights, with one row per output and one column per input. </param>
+        /// <param name="inputScale"> The quantization step of the input: input values are divided by this and rounded to the range [-127, 127]. </param>
+        QuantizedFullyConnectedLayerNode(const model::OutputPort<ValueType>& input,
+                                         const model::PortMemoryLayout& outputMemoryLayout,
+                                         const ConstMatrixReferenceType& weights,
+                                         ValueType inputScale);
+
+        /// <summary> Constructor from weights that have already been quantized. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. </param>
+        /// <param name="outputMemoryLayout"> The layout of the output data. </param>
+        /// <param name="weights"> The quantized weights, in row-major order. </param>
+        /// <param name="weightScales"> The quantization step of each row of the weights. </param>
+        /// <param name="inputScale"> The quantization step of the input. </param>
+        QuantizedFullyConnectedLayerNode(const model::OutputPort<ValueType>& input,
+                                         const model::PortMemoryLayout& outputMemoryLayout,
+                                         const std::vector<int8_t>& weights,
+                                         const std::vector<ValueType>& weightScales,
+                                         ValueType inputScale);
+
+        /// <summary> Gets the quantized weights, in row-major order. </summary>
+        const std::vector<int8_t>& GetQuantizedWeights() const { return _weights; }
+
+        /// <summary> Gets the quantization step of the input. </summary>
+        ValueType GetInputScale() const { return _inputScale; }
+
+        /// <summary> Gets the quantization step of each row of the weights. </summary>
+        const std::vector<ValueType>& GetWeightScales() const { return _weightScales; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("QuantizedFullyConnectedLayerNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
+        /// <summary> Returns the number of bytes one evaluation of this node reads, including its quantized weights. </summary>
+        int64_t GetBytesRead() const override;
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: quantized weights and scales
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        // Input
+        model::InputPort<ValueType> _input;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        std::vector<int8_t> _weights;
+        std::vector<ValueType> _weightScales;
+        ValueType _inputScale = 1;
+    };
+
+    /// <summary> The kind of cell a QuantizedRecurrentLayerNode computes. </summary>
+    enum class RecurrentCellType
+    {
+        lstm,
+        gru
+    };
+
+    /// <summary>
+    /// A recurrent layer (an LSTM or GRU cell) computed with 8-bit integer arithmetic. Like the fully-connected layer,
+    /// the input is quantized with a single scale and each row of the weights with its own scale, and the products are
+    /// accumulated in 32-bit integers. The hidden state is kept as 8-bit integers between steps, requantized with a
+    /// scale calibrated ahead of time, so the products with the hidden weights are integer too; the LSTM cell state
+    /// stays in `ValueType`. The gates use sigmoid and tanh, evaluated by linear interpolation in a table. The weights and
+    /// biases are stacked in the same order as in LSTMNode and GRUNode.
+    /// </summary>
+    template <typename ValueType>
+    class QuantizedRecurrentLayerNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        static constexpr const char* resetTriggerPortName = "resetTrigger";
+        const model::InputPort<ValueType>& input = _input;
+        const model::InputPortBase& resetTrigger = _resetTrigger;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default constructor. </summary>
+        QuantizedRecurrentLayerNode();
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. </param>
+        /// <param name="resetTrigger"> Port elements for the reset trigger, when the trigger goes from 1 to 0 the state is reset. </param>
+        /// <param name="cellType"> The kind of cell. </param>
+        /// <param name="hiddenUnits"> The number of hidden units. </param>
+        /// <param name="inputWeights"> The full-precision weights applied to the input, in row-major order, with one row per gate and hidden unit. </param>
+        /// <param name="hiddenWeights"> The full-precision weights applied to the hidden state, in row-major order. </param>
+        /// <param name="inputBias"> The bias applied to the input. </param>
+        /// <param name="hiddenBias"> The bias applied to the hidden state. </param>
+        /// <param name="inputScale"> The quantization step of the input: input values are divided by this and rounded to the range [-127, 127]. </param>
+        /// <param name="hiddenScale"> The quantization step of the hidden state. The hidden state is within [-1, 1], so this is at most 1/127. </param>
+        QuantizedRecurrentLayerNode(const model::OutputPort<ValueType>& input,
+                                    const model::OutputPortBase& resetTrigger,
+                                    RecurrentCellType cellType,
+                                    size_t hiddenUnits,
+                                    const std::vector<ValueType>& inputWeights,
+                                    const std::vector<ValueType>& hiddenWeights,
+                                    const std::vector<ValueType>& inputBias,
+                                    const std::vector<ValueType>& hiddenBias,
+                                    ValueType inputScale,
+                                    ValueType hiddenScale);
+
+        /// <summary> Constructor from weights that have already been quantized. </summary>
+        ///
+        /// <param name="input"> The ports to get input data from. </param>
+        /// <param name="resetTrigger"> Port elements for the reset trigger. </param>
+        /// <param name="cellType"> The kind of cell. </param>
+        /// <param name="hiddenUnits"> The number of hidden units. </param>
+        /// <param name="inputWeights"> The quantized input weights, in row-major order. </param>
+        /// <param name="inputWeightScales"> The quantization step of each row of the input weights. </param>
+        /// <param name="hiddenWeights"> The quantized hidden weights, in row-major order. </param>
+        /// <param name="hiddenWeightScales"> The quantization step of each row of the hidden weights. </param>
+        /// <param name="inputBias"> The bias applied to the input. </param>
+        /// <param name="hiddenBias"> The bias applied to the hidden state. </param>
+        /// <param name="inputScale"> The quantization step of the input. </param>
+        /// <param name="hiddenScale"> The quantization step of the hidden state. </param>
+        QuantizedRecurrentLayerNode(const model::OutputPort<ValueType>& input,
+                                    const model::OutputPortBase& resetTrigger,
+                                    RecurrentCellType cellType,
+                                    size_t hiddenUnits,
+                                    const std::vector<int8_t>& inputWeights,
+                                    const std::vector<ValueType>& inputWeightScales,
+                                    const std::vector<int8_t>& hiddenWeights,
+                                    const std::vector<ValueType>& hiddenWeightScales,
+                                    const std::vector<ValueType>& inputBias,
+                                    const std::vector<ValueType>& hiddenBias,
+                                    ValueType inputScale,
+                                    ValueType hiddenScale);
+
+        /// <summary> Gets the kind of cell. </summary>
+        RecurrentCellType GetCellType() const { return _cellType; }
+
+        /// <summary> Gets the number of hidden units. </summary>
+        size_t GetHiddenUnits() const { return _hiddenUnits; }
+
+        /// <summary> Gets the quantized input weights, in row-major order. </summary>
+        const std::vector<int8_t>& GetQuantizedInputWeights() const { return _inputWeights; }
+
+        /// <summary> Gets the quantized hidden weights, in row-major order. </summary>
+        const std::vector<int8_t>& GetQuantizedHiddenWeights() const { return _hiddenWeights; }
+
+        /// <summary> Gets the quantization step of the input. </summary>
+        ValueType GetInputScale() const { return _inputScale; }
+
+        /// <summary> Gets the quantization step of the hidden state. </summary>
+        ValueType GetHiddenScale() const { return _hiddenScale; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("QuantizedRecurrentLayerNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Resets the hidden and cell states to zero. </summary>
+        void Reset() override;
+
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
+        /// <summary> Returns the number of bytes one evaluation of this node reads, including its quantized weights. </summary>
+        int64_t GetBytesRead() const override;
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: quantized weights, scales and biases
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+        bool ShouldReset() const;
+        int GetStackSize() const;
+
+        // Inputs
+        model::InputPort<ValueType> _input;
+        model::InputPortBase _resetTrigger;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        RecurrentCellType _cellType = RecurrentCellType::lstm;
+        size_t _hiddenUnits = 0;
+        std::vector<int8_t> _inputWeights;
+        std::vector<ValueType> _inputWeightScales;
+        std::vector<int8_t> _hiddenWeights;
+        std::vector<ValueType> _hiddenWeightScales;
+        std::vector<ValueType> _inputBias;
+        std::vector<ValueType> _hiddenBias;
+        ValueType _inputScale = 1;
+        ValueType _hiddenScale = 1;
+
+        // State for compute
+        mutable std::vector<int8_t> _hiddenState;
+        mutable std::vector<ValueType> _cellState;
+        mutable int _lastResetValue = 0;
+    };
+} // namespace nodes
+} // namespace ell
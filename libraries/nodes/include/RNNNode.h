@@ -83,6 +83,12 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Gets the number of hidden units. </summary>
+        size_t GetHiddenUnits() const { return _hiddenUnits; }
+
+        /// <summary> Gets the activation function. </summary>
+        const ActivationType& GetActivation() const { return _activation; }
+
         /// <summary> Resets any state on the node, if any </summary>
         void Reset() override;
 
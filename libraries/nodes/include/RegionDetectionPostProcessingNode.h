@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     RegionDetectionPostProcessingNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <predictors/neural/include/RegionDetectionLayer.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary> Specifies how a RegionDetectionPostProcessingNode selects boxes. </summary>
+    struct RegionDetectionPostProcessingParameters
+    {
+        /// <summary> The size of the anchor boxes, in cells: a width and a height for each box of a cell. If empty, the anchor boxes are one cell in size. </summary>
+        std::vector<double> anchorScales;
+
+        /// <summary> Boxes whose score (confidence times class probability) isn't above this are dropped. Must be in [0, 1). </summary>
+        double confidenceThreshold = 0.5;
+
+        /// <summary> A box is suppressed if its intersection over union with a better box of the same class is above this. </summary>
+        double nmsThreshold = 0.45;
+
+        /// <summary> The number of boxes in the output. </summary>
+        int maxBoxes = 10;
+
+        /// <summary> The number of best-scoring boxes considered for non-maximum suppression. </summary>
+        int maxCandidates = 100;
+    };
+
+    /// <summary>
+    /// Turns the input of a YOLO-style RegionDetectionLayer into a short list of detected boxes. A box whose
+    /// confidence is too low for it to reach the threshold is dropped before its class probabilities are computed, and
+    /// the coordinates are only decoded for the best `maxCandidates` boxes, which then go through per-class non-maximum
+    /// suppression. The output has room for `maxBoxes` boxes of `boxSize` values each: [x, y, width, height, score,
+    /// class], best first. (x, y) is the center of the box, and all four coordinates are fractions of the image size.
+    /// Unused entries have a score of 0 and a class of -1.
+    /// </summary>
+    template <typename ValueType>
+    class RegionDetectionPostProcessingNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> The number of output values for each box. </summary>
+        static constexpr int boxSize = 6;
+
+        /// <summary> Default constructor. </summary>
+        RegionDetectionPostProcessingNode();
+
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="input"> The raw region detection data: for each cell, and each box in it, the values [tx, ty, tw, th, confidence, class logits...]. </param>
+        /// <param name="inputMemoryLayout"> The layout of the input data, in canonical order. </param>
+        /// <param name="detectionParameters"> The parameters of the region detection layer that produces the input. </param>
+        /// <param name="postProcessingParameters"> The parameters that select the output boxes. </param>
+        RegionDetectionPostProcessingNode(const model::OutputPort<ValueType>& input,
+                                          const model::PortMemoryLayout& inputMemoryLayout,
+                                          const predictors::neural::RegionDetectionParameters& detectionParameters,
+                                          const RegionDetectionPostProcessingParameters& postProcessingParameters);
+
+        /// <summary> Gets information about the input memory layout </summary>
+        const model::PortMemoryLayout& GetInputMemoryLayout() const { return _inputMemoryLayout; }
+
+        /// <summary> Gets the parameters of the region detection layer that produces the input. </summary>
+        const predictors::neural::RegionDetectionParameters& GetDetectionParameters() const { return _detectionParameters; }
+
+        /// <summary> Gets the parameters that select the output boxes. </summary>
+        const RegionDetectionPostProcessingParameters& GetPostProcessingParameters() const { return _postProcessingParameters; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("RegionDetectionPostProcessingNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: detection and post-processing parameters
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+        void VerifyParameters() const;
+
+        // Returns the width and height of each anchor box, in cells
+        std::vector<ValueType> GetAnchorScales() const;
+
+        // Returns the raw confidence value above which a box's confidence can reach the threshold
+        ValueType GetConfidenceLogitThreshold() const;
+
+        // Input
+        model::InputPort<ValueType> _input;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        model::PortMemoryLayout _inputMemoryLayout;
+
+        predictors::neural::RegionDetectionParameters _detectionParameters;
+        RegionDetectionPostProcessingParameters _postProcessingParameters;
+    };
+
+    /// <summary> Convenience function for adding a RegionDetectionPostProcessingNode to a model. </summary>
+    ///
+    /// <param name="input"> The raw region detection data. </param>
+    /// <param name="inputMemoryLayout"> The layout of the input data, in canonical order. </param>
+    /// <param name="detectionParameters"> The parameters of the region detection layer that produces the input. </param>
+    /// <param name="postProcessingParameters"> The parameters that select the output boxes. </param>
+    ///
+    /// <returns> The output of the new node. </returns>
+    template <typename ValueType>
+    const model::OutputPort<ValueType>& RegionDetectionPostProcessing(const model::OutputPort<ValueType>& input,
+                                                                      const model::PortMemoryLayout& inputMemoryLayout,
+                                                                      const predictors::neural::RegionDetectionParameters& detectionParameters,
+                                                                      const RegionDetectionPostProcessingParameters& postProcessingParameters);
+} // namespace nodes
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace nodes
+{
+    template <typename ValueType>
+    const model::OutputPort<ValueType>& RegionDetectionPostProcessing(const model::OutputPort<ValueType>& input,
+                                                                      const model::PortMemoryLayout& inputMemoryLayout,
+                                                                      const predictors::neural::RegionDetectionParameters& detectionParameters,
+                                                                      const RegionDetectionPostProcessingParameters& postProcessingParameters)
+    {
+        model::Model* model = input.GetNode()->GetModel();
+        if (model == nullptr)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Input not part of a model");
+        }
+        auto node = model->AddNode<RegionDetectionPostProcessingNode<ValueType>>(input, inputMemoryLayout, detectionParameters, postProcessingParameters);
+        return node->output;
+    }
+} // namespace nodes
+} // namespace ell
+
+#pragma endregion
@@ -67,6 +67,7 @@ namespace nodes
     protected:
         void Compute() const override;
         void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        bool ShouldCompileInline() const override { return true; }
 
         utilities::ArchiveVersion GetArchiveVersion() const override;
         bool CanReadArchiveVersion(const utilities::ArchiveVersion& version) const override;
@@ -147,9 +148,14 @@ namespace nodes
     template <typename ValueType>
     void ReinterpretLayoutNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
+        // The output has the same memory as the input, so it can share its buffer
+        if (compiler.TryAliasPort(_output, _input.GetReferencedPort(), 0))
+        {
+            return;
+        }
+
         auto input = function.LocalArray(compiler.EnsurePortEmitted(this->input));
         auto output = function.LocalArray(compiler.EnsurePortEmitted(this->output));
-        // simple pass through.  Would be nice to optimize this copy out all together...
         function.MemoryCopy<ValueType>(input, output, _output.GetMemoryLayout().GetMemorySize());
     }
 
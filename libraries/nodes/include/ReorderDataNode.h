@@ -131,6 +131,7 @@ namespace nodes
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; } // stored state: inputMemoryLayout, paddingValue
+        bool CanShareNodeFunction() const override { return true; }
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
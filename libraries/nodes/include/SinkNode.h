@@ -16,6 +16,7 @@
 #include <model/include/OutputNodeBase.h>
 #include <model/include/PortElements.h>
 
+#include <emitters/include/IRAsyncTask.h>
 #include <emitters/include/IRMetadata.h>
 
 #include <utilities/include/TypeTraits.h>
@@ -102,6 +103,7 @@ namespace nodes
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; } // stored state: callback function name, shape
+        bool CanComputeConcurrently() const override { return false; } // calls the callback
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
@@ -190,7 +192,8 @@ namespace nodes
             name = "output";
         }
 
-        function.If(emitters::TypedComparison::equals, triggerValue, function.Literal(true), [prefixedName, pInput, &module, &compiler, &name](emitters::IRFunctionEmitter& function) {
+        auto asyncCallbacks = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("asyncCallbacks", false);
+        function.If(emitters::TypedComparison::equals, triggerValue, function.Literal(true), [this, prefixedName, pInput, asyncCallbacks, &module, &compiler, &name](emitters::IRFunctionEmitter& function) {
             // look up our global context object
             auto context = module.GlobalPointer(compiler.GetNamespacePrefix() + "_context", emitters::VariableType::Byte);
             auto globalContext = function.Load(context);
@@ -201,6 +204,21 @@ namespace nodes
             module.DeclareFunction(prefixedName, emitters::VariableType::Void, parameters);
 
             emitters::LLVMFunction pSinkFunction = module.GetFunction(prefixedName);
+            if (asyncCallbacks)
+            {
+                // Run the callback on another thread, on a copy of the input, so the model doesn't wait for it. The
+                // previous call must be done with the copy before it is overwritten.
+                emitters::IRBackgroundTask sinkTask(module, compiler.GetGlobalName(*this, "sinkTask"), pSinkFunction);
+                if (sinkTask.IsAsync())
+                {
+                    auto pInputCopyVar = module.Variables().AddVariable<emitters::InitializedVectorVariable<ValueType>>(emitters::VariableScope::global, input.Size());
+                    auto pInputCopy = module.EnsureEmitted(*pInputCopyVar);
+                    sinkTask.Wait(function);
+                    function.MemoryCopy<ValueType>(pInput, 0, pInputCopy, 0, static_cast<int>(input.Size()));
+                    sinkTask.Start(function, { globalContext, function.PointerOffset(pInputCopy, function.Literal(0)) });
+                    return;
+                }
+            }
             function.Call(pSinkFunction, { globalContext, function.PointerOffset(pInput, function.Literal(0)) });
         });
 
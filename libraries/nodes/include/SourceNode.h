@@ -10,6 +10,7 @@
 
 #include "ClockNode.h" // for TimeTickType
 
+#include <emitters/include/IRAsyncTask.h>
 #include <emitters/include/IRMetadata.h>
 #include <emitters/include/IRModuleEmitter.h>
 #include <emitters/include/LLVMUtilities.h>
@@ -108,10 +109,14 @@ namespace nodes
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
         bool HasState() const override { return true; } // stored state: callback function name, shape
+        bool CanComputeConcurrently() const override { return false; } // calls the callback
 
     private:
         void Copy(model::ModelTransformer& transformer) const override;
 
+        // Returns the sample for this call, and starts filling the buffer for the next one on another thread
+        emitters::LLVMValue PrefetchSample(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, emitters::LLVMFunction pSamplingFunction, emitters::LLVMValue context);
+
         void SetOutputValuesLoop(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, emitters::LLVMValue sample);
         void SetOutputValuesExpanded(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, emitters::LLVMValue sample);
 
@@ -233,7 +238,14 @@ namespace nodes
         auto sampleTime = function.ValueAt(pInput, function.Literal(0));
 
         // Invoke the callback and optionally interpolate.
-        function.Call(pSamplingFunction, { globalContext, function.PointerOffset(pBufferedSample, 0) });
+        if (compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("asyncCallbacks", false))
+        {
+            pBufferedSample = PrefetchSample(compiler, function, pSamplingFunction, globalContext);
+        }
+        else
+        {
+            function.Call(pSamplingFunction, { globalContext, function.PointerOffset(pBufferedSample, 0) });
+        }
 
         // TODO: Interpolate if there is a sample, and currentTime > sampleTime
         // Note: currentTime can be retrieved via currentTime = function.ValueAt(pInput, function.Literal(1));
@@ -252,6 +264,51 @@ namespace nodes
         function.Store(pBufferedSampleTime, sampleTime);
     }
 
+    template <typename ValueType>
+    emitters::LLVMValue SourceNode<ValueType>::PrefetchSample(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function, emitters::LLVMFunction pSamplingFunction, emitters::LLVMValue context)
+    {
+        auto& module = function.GetModule();
+        const int size = static_cast<int>(output.Size());
+
+        emitters::Variable* pSamplesVar = module.Variables().AddVariable<emitters::InitializedVectorVariable<ValueType>>(emitters::VariableScope::global, 2 * output.Size());
+        emitters::LLVMValue pSamples = module.EnsureEmitted(*pSamplesVar);
+
+        // The task calls the callback and ignores its result, as the synchronous call does
+        auto taskName = compiler.GetGlobalName(*this, "prefetch");
+        const emitters::NamedVariableTypeList parameters = { { "context", emitters::VariableType::BytePointer },
+                                                             { "sample", emitters::GetPointerType(emitters::GetVariableType<ValueType>()) } };
+        emitters::IRFunctionEmitter taskFunction = module.BeginFunction(taskName, emitters::VariableType::Void, parameters);
+        {
+            auto arguments = taskFunction.Arguments().begin();
+            auto taskContext = &(*arguments++);
+            auto sample = &(*arguments++);
+            taskFunction.Call(pSamplingFunction, { taskContext, sample });
+            taskFunction.Return();
+        }
+        module.EndFunction();
+        emitters::IRBackgroundTask prefetch(module, taskName, taskFunction.GetFunction());
+
+        // Without a thread to fill the next buffer in the background, there's nothing to overlap
+        if (!prefetch.IsAsync())
+        {
+            function.Call(pSamplingFunction, { context, function.PointerOffset(pSamples, 0) });
+            return pSamples;
+        }
+
+        // Double buffering: the front buffer holds the sample for this call, and the back buffer is filled for the
+        // next call while the rest of the model runs. The first call has nothing prefetched, so it samples directly.
+        auto frontIndexVar = module.Global<int>(compiler.GetGlobalName(*this, "frontBuffer"), 0);
+        auto frontIndex = function.LocalScalar(function.Load(frontIndexVar));
+        auto front = function.PointerOffset(pSamples, frontIndex * size);
+        auto back = function.PointerOffset(pSamples, (function.LocalScalar<int>(1) - frontIndex) * size);
+        function.If(emitters::TypedComparison::equals, prefetch.IsRunning(function), function.Literal<int>(0), [pSamplingFunction, context, front](emitters::IRFunctionEmitter& function) {
+            function.Call(pSamplingFunction, { context, front });
+        });
+        prefetch.Start(function, { context, back });
+        function.Store(frontIndexVar, function.LocalScalar<int>(1) - frontIndex);
+        return front;
+    }
+
     template <typename ValueType>
     void SourceNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
@@ -0,0 +1,236 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SparseLinearPredictorNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <emitters/include/EmitterTypes.h>
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/Model.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/OutputPort.h>
+
+#include <predictors/include/LinearPredictor.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/TypeName.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A node that represents a linear predictor applied to a sparse input, given as parallel arrays of feature
+    /// indices and values. Only the listed entries are visited, so the cost of a prediction depends on the number of
+    /// entries rather than on the dimension of the predictor. The ports have a fixed size, so inputs with fewer
+    /// non-zeros are padded with entries whose value is zero (and whose index is any valid index, such as 0).
+    /// </summary>
+    template <typename ElementType>
+    class SparseLinearPredictorNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        static constexpr const char* indicesPortName = "indices";
+        static constexpr const char* valuesPortName = "values";
+        const model::InputPort<int>& indices = _indices;
+        const model::InputPort<ElementType>& values = _values;
+        const model::OutputPort<ElementType>& output = _output;
+        /// @}
+
+        using LinearPredictorType = typename predictors::LinearPredictor<ElementType>;
+
+        /// <summary> Default Constructor </summary>
+        SparseLinearPredictorNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="indices"> The feature indices of the input entries. </param>
+        /// <param name="values"> The values of the input entries, the same size as `indices`. </param>
+        /// <param name="predictor"> The linear predictor to use when making the prediction. </param>
+        SparseLinearPredictorNode(const model::OutputPort<int>& indices, const model::OutputPort<ElementType>& values, const LinearPredictorType& predictor);
+
+        /// <summary> Gets the linear predictor. </summary>
+        ///
+        /// <returns> The linear predictor. </returns>
+        const LinearPredictorType& GetPredictor() const { return _predictor; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ElementType>("SparseLinearPredictorNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        bool HasState() const override { return true; } // stored state: the predictor
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        // Inputs
+        model::InputPort<int> _indices;
+        model::InputPort<ElementType> _values;
+
+        // Output
+        model::OutputPort<ElementType> _output;
+
+        // Linear predictor
+        LinearPredictorType _predictor;
+    };
+
+    /// <summary> Convenience function to add a sparse linear predictor node. </summary>
+    ///
+    /// <typeparam name="ElementType"> The fundamental type used by this predictor. </typeparam>
+    /// <param name="indices"> The feature indices of the input entries. </param>
+    /// <param name="values"> The values of the input entries. </param>
+    /// <param name="predictor"> The linear predictor. </param>
+    ///
+    /// <returns> The output of the new node. </returns>
+    template <typename ElementType>
+    const model::OutputPort<ElementType>& SparseLinearPredictor(const model::OutputPort<int>& indices,
+                                                                const model::OutputPort<ElementType>& values,
+                                                                const predictors::LinearPredictor<ElementType>& predictor);
+} // namespace nodes
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace nodes
+{
+    template <typename ElementType>
+    SparseLinearPredictorNode<ElementType>::SparseLinearPredictorNode() :
+        CompilableNode({ &_indices, &_values }, { &_output }),
+        _indices(this, {}, indicesPortName),
+        _values(this, {}, valuesPortName),
+        _output(this, defaultOutputPortName, 1)
+    {
+    }
+
+    template <typename ElementType>
+    SparseLinearPredictorNode<ElementType>::SparseLinearPredictorNode(const model::OutputPort<int>& indices, const model::OutputPort<ElementType>& values, const LinearPredictorType& predictor) :
+        CompilableNode({ &_indices, &_values }, { &_output }),
+        _indices(this, indices, indicesPortName),
+        _values(this, values, valuesPortName),
+        _output(this, defaultOutputPortName, 1),
+        _predictor(predictor)
+    {
+        if (indices.Size() != values.Size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "SparseLinearPredictorNode: indices and values must have the same size");
+        }
+    }
+
+    template <typename ElementType>
+    int64_t SparseLinearPredictorNode<ElementType>::GetOperationCount() const
+    {
+        return 2 * static_cast<int64_t>(_values.Size());
+    }
+
+    template <typename ElementType>
+    void SparseLinearPredictorNode<ElementType>::Compute() const
+    {
+        const auto& weights = _predictor.GetWeights();
+        ElementType result = 0;
+        for (size_t entry = 0; entry < _values.Size(); ++entry)
+        {
+            auto index = _indices[entry];
+            if (index < 0 || static_cast<size_t>(index) >= weights.Size())
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "SparseLinearPredictorNode: feature index out of range");
+            }
+            result += weights[index] * _values[entry];
+        }
+        _output.SetOutput({ result + _predictor.GetBias() });
+    }
+
+    template <typename ElementType>
+    void SparseLinearPredictorNode<ElementType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        emitters::LLVMValue pIndices = compiler.EnsurePortEmitted(indices);
+        emitters::LLVMValue pValues = compiler.EnsurePortEmitted(values);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+
+        auto weights = function.GetModule().ConstantArray(compiler.GetGlobalName(*this, "weights"), _predictor.GetWeights().ToArray());
+        auto sum = function.Variable(emitters::GetVariableType<ElementType>(), "sum");
+        function.Store(sum, function.Literal<ElementType>(0));
+
+        // Gather the weight of each entry's feature, instead of walking the whole weight vector
+        function.For(static_cast<int>(values.Size()), [pIndices, pValues, weights, sum](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar entry) {
+            auto index = function.LocalScalar(function.ValueAt(pIndices, entry));
+            auto weight = function.LocalScalar(function.ValueAt(weights, index));
+            auto value = function.LocalScalar(function.ValueAt(pValues, entry));
+            function.Store(sum, function.LocalScalar(function.Load(sum)) + weight * value);
+        });
+
+        auto bias = function.LocalScalar(_predictor.GetBias());
+        function.SetValueAt(pOutput, 0, function.LocalScalar(function.Load(sum)) + bias);
+    }
+
+    template <typename ElementType>
+    void SparseLinearPredictorNode<ElementType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newIndices = transformer.GetCorrespondingInputs(_indices);
+        const auto& newValues = transformer.GetCorrespondingInputs(_values);
+        auto newNode = transformer.AddNode<SparseLinearPredictorNode<ElementType>>(newIndices, newValues, _predictor);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ElementType>
+    void SparseLinearPredictorNode<ElementType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[indicesPortName] << _indices;
+        archiver[valuesPortName] << _values;
+        archiver["predictor"] << _predictor;
+    }
+
+    template <typename ElementType>
+    void SparseLinearPredictorNode<ElementType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[indicesPortName] >> _indices;
+        archiver[valuesPortName] >> _values;
+        archiver["predictor"] >> _predictor;
+    }
+
+    template <typename ElementType>
+    const model::OutputPort<ElementType>& SparseLinearPredictor(const model::OutputPort<int>& indices,
+                                                                const model::OutputPort<ElementType>& values,
+                                                                const predictors::LinearPredictor<ElementType>& predictor)
+    {
+        model::Model* model = values.GetNode()->GetModel();
+        if (model == nullptr)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Input not part of a model");
+        }
+
+        auto node = model->AddNode<SparseLinearPredictorNode<ElementType>>(indices, values, predictor);
+        return node->output;
+    }
+} // namespace nodes
+} // namespace ell
+
+#pragma endregion implementation
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SparseMatrixMultiplyNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "OutputEpilogue.h"
+
+#include <emitters/include/IRFunctionEmitter.h>
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/Node.h>
+#include <model/include/OutputPort.h>
+#include <model/include/PortMemoryLayout.h>
+
+#include <utilities/include/IArchivable.h>
+#include <utilities/include/TypeName.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A node that multiplies a constant sparse matrix of weights with its input matrix, for layers whose weights were
+    /// pruned. The weights are stored in block-sparse row format: the matrix is split into blocks of `blockRows` x
+    /// `blockColumns` entries, and only the blocks with a nonzero entry are kept, along with the column each one starts
+    /// at. With 1 x 1 blocks, this is the usual compressed sparse row (CSR) format. Larger blocks keep some zeros, but
+    /// are loaded and multiplied as vectors. An OutputEpilogue can be applied to the product, with the columns of the
+    /// output matrix (as stored in memory) as its channels, as with MatrixMatrixMultiplyNode.
+    /// </summary>
+    template <typename ValueType>
+    class SparseMatrixMultiplyNode : public model::CompilableNode
+        , public IOutputEpilogueNode<ValueType>
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& output = _output;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        SparseMatrixMultiplyNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The right-hand input of the multiplication, a k x n matrix. </param>
+        /// <param name="weights"> The left-hand input of the multiplication, a dense m x k matrix. </param>
+        /// <param name="m"> The number of rows of the weights and the output. </param>
+        /// <param name="n"> The number of columns of the input and the output. </param>
+        /// <param name="k"> The number of columns of the weights and rows of the input. </param>
+        /// <param name="weightsStride"> The distance between the rows of the weights (or the columns, if they're transposed). </param>
+        /// <param name="transposeWeights"> If true, the weights are stored as their k x m transpose. </param>
+        /// <param name="inputStride"> The distance between the rows of the input (or the columns, if it's transposed). </param>
+        /// <param name="transposeInput"> If true, the input is stored as its n x k transpose. </param>
+        /// <param name="outputStride"> The distance between the rows of the output (or the columns, if it's transposed). </param>
+        /// <param name="transposeOutput"> If true, the output is stored as its n x m transpose. </param>
+        /// <param name="blockRows"> The number of rows of each block of weights, which must divide `m`. </param>
+        /// <param name="blockColumns"> The number of columns of each block of weights, which must divide `k`. </param>
+        SparseMatrixMultiplyNode(const model::OutputPort<ValueType>& input, const std::vector<ValueType>& weights, int m, int n, int k, int weightsStride, bool transposeWeights, int inputStride, bool transposeInput, int outputStride, bool transposeOutput, int blockRows, int blockColumns);
+
+        /// <summary> Constructor that multiplies a new input with the sparse weights, dimensions, and epilogue of another node. </summary>
+        ///
+        /// <param name="input"> The right-hand input of the multiplication, a k x n matrix. </param>
+        /// <param name="other"> The node to copy the weights from. </param>
+        SparseMatrixMultiplyNode(const model::OutputPort<ValueType>& input, const SparseMatrixMultiplyNode<ValueType>& other);
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("SparseMatrixMultiplyNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+        /// <summary> Returns the number of arithmetic operations one evaluation of this node performs. </summary>
+        int64_t GetOperationCount() const override;
+
+        /// <summary> Gets the number of blocks of weights that are stored. </summary>
+        int NumStoredBlocks() const { return static_cast<int>(_blockColumnIndices.size()); }
+
+        /// <summary> Counts the blocks of a dense matrix of weights that have a nonzero entry. </summary>
+        ///
+        /// <param name="weights"> The weights, a dense m x k matrix. </param>
+        /// <param name="m"> The number of rows of the weights. </param>
+        /// <param name="k"> The number of columns of the weights. </param>
+        /// <param name="weightsStride"> The distance between the rows of the weights (or the columns, if they're transposed). </param>
+        /// <param name="transposeWeights"> If true, the weights are stored as their k x m transpose. </param>
+        /// <param name="blockRows"> The number of rows of each block, which must divide `m`. </param>
+        /// <param name="blockColumns"> The number of columns of each block, which must divide `k`. </param>
+        ///
+        /// <returns> The number of blocks that would be stored. </returns>
+        static int CountNonzeroBlocks(const std::vector<ValueType>& weights, int m, int k, int weightsStride, bool transposeWeights, int blockRows, int blockColumns);
+
+        /// <summary> Indicates if the node can apply an epilogue whose channels are dimension 2 of the given layout. </summary>
+        bool CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const override;
+
+        /// <summary> Gets the epilogue applied to the product. </summary>
+        const OutputEpilogue<ValueType>& GetEpilogue() const override { return _epilogue; }
+
+        /// <summary> Sets the epilogue applied to the product. </summary>
+        void SetEpilogue(const OutputEpilogue<ValueType>& epilogue) override { _epilogue = epilogue; }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // stored state: the sparse weights, dimensions, and epilogue
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        struct EmittedWeights
+        {
+            emitters::LLVMValue blockRowStarts;
+            emitters::LLVMValue blockColumnIndices;
+            emitters::LLVMValue blockValues;
+        };
+
+        void CompileDotProducts(emitters::IRFunctionEmitter& function, const EmittedWeights& weights, emitters::LLVMValue input, emitters::LLVMValue output, const typename OutputEpilogue<ValueType>::EmittedConstants& epilogueConstants, int beginColumn);
+        void CompileColumnVectors(emitters::IRFunctionEmitter& function, const EmittedWeights& weights, emitters::LLVMValue input, emitters::LLVMValue output, const typename OutputEpilogue<ValueType>::EmittedConstants& epilogueConstants, int vectorSize);
+        void CompileStoreResult(emitters::IRFunctionEmitter& function, emitters::LLVMValue output, const typename OutputEpilogue<ValueType>::EmittedConstants& epilogueConstants, emitters::IRLocalScalar row, emitters::IRLocalScalar column, emitters::IRLocalScalar value);
+
+        // Inputs
+        model::InputPort<ValueType> _input;
+
+        // Output
+        model::OutputPort<ValueType> _output;
+
+        // The product is m x n, and the input is k x n
+        int _m = 0, _n = 0, _k = 0;
+        int _ldb = 0, _ldc = 0;
+        bool _transposeInput = false, _transposeOutput = false;
+
+        // The weights, in block-sparse row format: the blocks of block row `r` are `_blockRowStarts[r]` up to
+        // `_blockRowStarts[r + 1]`, and block `b` starts at column `_blockColumnIndices[b]`, with its values (in
+        // row-major order) at `b * blockRows * blockColumns` in `_blockValues`
+        int _blockRows = 1, _blockColumns = 1;
+        std::vector<int> _blockRowStarts;
+        std::vector<int> _blockColumnIndices;
+        std::vector<ValueType> _blockValues;
+
+        OutputEpilogue<ValueType> _epilogue;
+    };
+} // namespace nodes
+} // namespace ell
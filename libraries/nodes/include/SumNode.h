@@ -23,6 +23,7 @@
 #include <utilities/include/TypeName.h>
 
 #include <string>
+#include <type_traits>
 
 namespace ell
 {
@@ -137,9 +138,10 @@ namespace nodes
     {
         if (!function.GetCompilerOptions().unrollLoops)
         {
-            size_t vectorSize = function.GetCompilerOptions().vectorWidth;
-            bool vectorize = function.GetCompilerOptions().allowVectorInstructions && (input.Size() > vectorSize);
-            if (vectorize)
+            // Splitting the sum over several accumulators changes the order of the additions, which changes
+            // floating-point results, so it's only done with fast math
+            bool reassociate = std::is_integral_v<ValueType> || function.GetCompilerOptions().useFastMath;
+            if (reassociate)
             {
                 CompileVectorizedLoop(compiler, function);
             }
@@ -200,45 +202,15 @@ namespace nodes
     void SumNode<ValueType>::CompileVectorizedLoop(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
         const int size = _input.Size();
-        const int vectorSize = function.GetCompilerOptions().vectorWidth;
-        assert(size >= vectorSize);
+        const int vectorSize = emitters::GetReductionVectorSize(function.GetCompilerOptions());
+        constexpr int numAccumulators = 4;
 
         emitters::LLVMValue input = compiler.EnsurePortEmitted(_input);
         emitters::LLVMValue output = compiler.EnsurePortEmitted(_output);
 
-        // Get LLVM types
-        auto& emitter = function.GetEmitter();
-        auto elementType = emitter.Type(emitters::GetVariableType<ValueType>());
-        DEBUG_USED(elementType);
-        assert(llvm::VectorType::isValidElementType(elementType) && "Invalid element type for LLVM vector");
-        auto vectorType = emitter.VectorType(emitters::GetVariableType<ValueType>(), vectorSize);
-        auto vectorPointerType = vectorType->getPointerTo();
-
-        // cast input to pointer-to-vector
-        auto inputVector = function.CastPointer(input, vectorPointerType);
-
-        emitters::LLVMValue vectorAccumVar = function.Variable(vectorType, "vecAccum");
-        function.Store(vectorAccumVar, emitters::FillVector<ValueType>(function, vectorType, 0));
-
-        const int numBlocks = size / vectorSize;
-        function.For(numBlocks, [inputVector, vectorAccumVar](emitters::IRFunctionEmitter& function, auto blockIndex) {
-            auto value = function.ValueAt(inputVector, blockIndex);
-            function.OperationAndUpdate(vectorAccumVar, emitters::GetAddForValueType<ValueType>(), value);
+        auto sum = emitters::EmitVectorizedSum<ValueType>(function, size, vectorSize, numAccumulators, [input](emitters::IRFunctionEmitter& function, emitters::LLVMValue index, int width) {
+            return width == 1 ? function.ValueAt(input, index) : emitters::LoadUnalignedVector<ValueType>(function, input, index, width);
         });
-
-        // Accumulate horizontal sum into output
-        auto sum = emitters::HorizontalVectorSum<ValueType>(function, function.Load(vectorAccumVar));
-
-        // epilogue
-        const int epilogueSize = size - (vectorSize * numBlocks);
-        if (epilogueSize > 0)
-        {
-            for (int epilogueIndex = vectorSize * numBlocks; epilogueIndex < size; ++epilogueIndex)
-            {
-                emitters::LLVMValue pValue = function.ValueAt(input, function.Literal<int>(epilogueIndex));
-                sum = function.Operator(emitters::GetAddForValueType<ValueType>(), sum, pValue);
-            }
-        }
         function.Store(output, sum);
     }
 
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     TopKNode.h (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/CompilableNode.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputPort.h>
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+#include <model/include/Node.h>
+#include <model/include/OutputPort.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/TypeName.h>
+
+#include <string>
+
+namespace ell
+{
+namespace nodes
+{
+    /// <summary>
+    /// A node that outputs the k largest entries of its input in descending order, and their indices. Equal entries
+    /// keep the order of their indices. The compiled code keeps the k largest entries seen so far in order, and only
+    /// inserts an entry that beats the smallest of them, so most of the input takes a single comparison (a vector of
+    /// entries at a time, if vector instructions are allowed).
+    ///
+    /// If the node normalizes a softmax, its input is the logits, and the output values are the softmax probabilities
+    /// of the k largest logits. This gives the same result as a SoftmaxLayerNode followed by a TopKNode, without
+    /// writing or normalizing the probabilities of the other entries.
+    /// </summary>
+    template <typename ValueType>
+    class TopKNode : public model::CompilableNode
+    {
+    public:
+        /// @name Input and Output Ports
+        /// @{
+        static constexpr const char* valuesPortName = "values";
+        static constexpr const char* indicesPortName = "indices";
+        const model::InputPort<ValueType>& input = _input;
+        const model::OutputPort<ValueType>& values = _values;
+        const model::OutputPort<int>& indices = _indices;
+        /// @}
+
+        /// <summary> Default Constructor </summary>
+        TopKNode();
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="input"> The values to select from. </param>
+        /// <param name="k"> The number of entries to output. Must be between 1 and the size of the input. </param>
+        /// <param name="normalizeSoftmax"> If `true`, the input is the logits of a softmax, and the output values are the probabilities of the selected entries. </param>
+        TopKNode(const model::OutputPort<ValueType>& input, size_t k, bool normalizeSoftmax = false);
+
+        /// <summary> Gets the number of entries the node outputs. </summary>
+        size_t GetK() const { return _k; }
+
+        /// <summary> Indicates if the output values are the softmax probabilities of the selected entries. </summary>
+        bool NormalizesSoftmax() const { return _normalizeSoftmax; }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        static std::string GetTypeName() { return utilities::GetCompositeTypeName<ValueType>("TopKNode"); }
+
+        /// <summary> Gets the name of this type (for serialization). </summary>
+        ///
+        /// <returns> The name of this type. </returns>
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+
+    protected:
+        void Compute() const override;
+        void Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function) override;
+        void WriteToArchive(utilities::Archiver& archiver) const override;
+        void ReadFromArchive(utilities::Unarchiver& archiver) override;
+        bool HasState() const override { return true; } // Stored state: k, normalizeSoftmax
+
+    private:
+        void Copy(model::ModelTransformer& transformer) const override;
+
+        model::InputPort<ValueType> _input;
+        model::OutputPort<ValueType> _values;
+        model::OutputPort<int> _indices;
+
+        size_t _k = 1;
+        bool _normalizeSoftmax = false;
+    };
+
+    template <typename ValueType>
+    struct TopKNodeOutput
+    {
+        const model::OutputPort<ValueType>& values;
+        const model::OutputPort<int>& indices;
+    };
+
+    /// <summary> Convenience function for adding a top-k selection to a model. </summary>
+    ///
+    /// <param name="input"> The values to select from. </param>
+    /// <param name="k"> The number of entries to output. </param>
+    /// <param name="normalizeSoftmax"> If `true`, the input is the logits of a softmax, and the output values are the probabilities of the selected entries. </param>
+    ///
+    /// <returns> The k largest values in descending order, and their indices. </returns>
+    template <typename ValueType>
+    TopKNodeOutput<ValueType> TopK(const model::OutputPort<ValueType>& input, size_t k, bool normalizeSoftmax = false);
+
+    extern template class TopKNode<float>;
+    extern template class TopKNode<double>;
+} // namespace nodes
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace nodes
+{
+    template <typename ValueType>
+    TopKNodeOutput<ValueType> TopK(const model::OutputPort<ValueType>& input, size_t k, bool normalizeSoftmax)
+    {
+        model::Model* model = input.GetNode()->GetModel();
+        if (model == nullptr)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Input not part of a model");
+        }
+        auto node = model->AddNode<TopKNode<ValueType>>(input, k, normalizeSoftmax);
+        return { node->values, node->indices };
+    }
+} // namespace nodes
+} // namespace ell
+
+#pragma endregion implementation
@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "OutputEpilogue.h"
+
 #include <math/include/Tensor.h>
 
 #include <model/include/IRMapCompiler.h>
@@ -23,8 +25,11 @@ namespace nodes
     /// <summary> A node that implements convolution using matrix multiply on a reshaped input image. </summary>
     /// If Unrolled convolution is specified, a ConvolutionalLayerNode will refine
     /// itself into a UnrolledConvolutionNode.
+    /// An OutputEpilogue set on the node is applied as each filter's output is computed, or passed on to the
+    /// matrix multiplication the node refines to.
     template <typename ValueType>
     class UnrolledConvolutionNode : public model::CompilableNode
+        , public IOutputEpilogueNode<ValueType>
     {
     public:
         using MatrixType = math::RowMatrix<ValueType>;
@@ -91,8 +96,19 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
-        /// <summary> Indicates if this node is able to compile itself to code. </summary>
-        bool IsCompilable(const model::MapCompiler* compiler) const override { return _isDepthwiseSeparable; }
+        /// <summary> Indicates if this node is able to compile itself to code: depthwise-separable convolutions, and
+        /// the others if the "implicitGemmPanelSize" option is set, in which case the receptive field matrix is formed
+        /// in small panels inside the matrix multiplication instead of in full. </summary>
+        bool IsCompilable(const model::MapCompiler* compiler) const override;
+
+        /// <summary> Indicates if the node can apply an epilogue whose channels are dimension 2 of the given layout. </summary>
+        bool CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const override;
+
+        /// <summary> Gets the epilogue applied to the output. </summary>
+        const OutputEpilogue<ValueType>& GetEpilogue() const override { return _epilogue; }
+
+        /// <summary> Sets the epilogue applied to the output. </summary>
+        void SetEpilogue(const OutputEpilogue<ValueType>& epilogue) override { _epilogue = epilogue; }
 
     protected:
         bool Refine(model::ModelTransformer& transformer) const override;
@@ -106,6 +122,8 @@ namespace nodes
         void Copy(model::ModelTransformer& transformer) const override;
 
         MatrixType GetWeightsMatrix(const ConstTensorReferenceType& weightsTensor) const;
+        int GetImplicitGemmPanelSize(const model::MapCompiler* compiler) const;
+        void CompileImplicitGemm(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function);
 
         // Input
         model::InputPort<ValueType> _input;
@@ -120,6 +138,8 @@ namespace nodes
         int _filterSize = 0;
         int _stride = 1;
         bool _isDepthwiseSeparable = false;
+
+        OutputEpilogue<ValueType> _epilogue;
     };
 
     /// <summary> Convenience function for adding a node to a model. </summary>
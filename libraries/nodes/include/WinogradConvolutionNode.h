@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "OutputEpilogue.h"
+
 #include <emitters/include/LLVMUtilities.h>
 
 #include <dsp/include/WinogradConvolution.h>
@@ -53,11 +55,13 @@ namespace nodes
         /// <param name="filterWeights"> The weights for the convolutional filters. </param>
         /// <param name="outputMemoryLayout"> The layout of the output data. </param>
         /// <param name="stride"> The number of elements to move/jump when sliding over the input. Typically this is 1 to 3. </param>
+        /// <param name="tileSize"> The size of the output tiles: 2, 4 or 6. Larger tiles need fewer multiplications per output. </param>
         WinogradConvolutionNode(const model::OutputPort<ValueType>& input,
                                 const model::PortMemoryLayout& inputMemoryLayout,
                                 const model::PortMemoryLayout& outputMemoryLayout,
                                 const ConstTensorReferenceType& filterWeights,
-                                int stride);
+                                int stride,
+                                int tileSize = 2);
 
         /// <summary> Constructor. </summary>
         ///
@@ -178,10 +182,12 @@ namespace nodes
     //
 
     /// <summary>
-    /// A node that does the actual convolution operation
+    /// A node that does the actual convolution operation. An OutputEpilogue set on the node is applied to each output
+    /// tile before it's written, or to the accumulated output when filters are processed first.
     /// </summary>
     template <typename ValueType>
     class WinogradConvolutionComputeNode : public model::CompilableNode
+        , public IOutputEpilogueNode<ValueType>
     {
     public:
         using FilterOrder = dsp::WinogradFilterOrder;
@@ -243,6 +249,18 @@ namespace nodes
         /// <returns> The name of this type. </returns>
         std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+        /// <summary> Returns the number of arithmetic operations a direct convolution with this node's parameters would perform, which is the customary way to rate Winograd convolutions. </summary>
+        int64_t GetOperationCount() const override;
+
+        /// <summary> Indicates if the node can apply an epilogue whose channels are dimension 2 of the given layout. </summary>
+        bool CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const override;
+
+        /// <summary> Gets the epilogue applied to the output. </summary>
+        const OutputEpilogue<ValueType>& GetEpilogue() const override { return _epilogue; }
+
+        /// <summary> Sets the epilogue applied to the output. </summary>
+        void SetEpilogue(const OutputEpilogue<ValueType>& epilogue) override { _epilogue = epilogue; }
+
         // Cloning constructor
         WinogradConvolutionComputeNode(const WinogradConvolutionComputeNode<ValueType>& other,
                                        const model::OutputPort<ValueType>& input,
@@ -280,6 +298,8 @@ namespace nodes
         // Tunable parameters
         int _inputBlockSize = 1;
         int _outputBlockSize = 1;
+
+        OutputEpilogue<ValueType> _epilogue;
     };
 } // namespace nodes
 } // namespace ell
@@ -0,0 +1,327 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     AudioFrontEndNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AudioFrontEndNode.h"
+#include "FFTNode.h"
+
+#include <dsp/include/DCT.h>
+
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRLocalScalar.h>
+#include <emitters/include/IRMath.h>
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        template <typename ValueType>
+        std::vector<ValueType> CastVector(const std::vector<double>& values)
+        {
+            return std::vector<ValueType>(values.begin(), values.end());
+        }
+    } // namespace
+
+    template <typename ValueType>
+    AudioFrontEndNode<ValueType>::AudioFrontEndNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0),
+        _plan(0)
+    {
+    }
+
+    template <typename ValueType>
+    AudioFrontEndNode<ValueType>::AudioFrontEndNode(const model::OutputPort<ValueType>& input, const AudioFrontEndParameters& parameters) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0),
+        _parameters(parameters),
+        _plan(0)
+    {
+        Initialize();
+    }
+
+    template <typename ValueType>
+    void AudioFrontEndNode<ValueType>::Initialize()
+    {
+        const auto fftSize = _parameters.fftSize;
+        if (fftSize < 2 || (fftSize & (fftSize - 1)) != 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FFT size must be a power of 2");
+        }
+        if (!_parameters.window.empty() && _parameters.window.size() != _input.Size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "Window size must match the input size");
+        }
+
+        const auto numBins = static_cast<int>(fftSize / 2);
+        const auto numFilters = _parameters.filterStarts.size();
+        size_t numCoefficients = 0;
+        _lowBin = numBins;
+        _highBin = 0;
+        for (size_t filterIndex = 0; filterIndex < numFilters && filterIndex < _parameters.filterSizes.size(); ++filterIndex)
+        {
+            auto start = _parameters.filterStarts[filterIndex];
+            auto size = _parameters.filterSizes[filterIndex];
+            if (start < 0 || size < 0 || start + size > numBins)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "Filter extends past the end of the spectrum");
+            }
+            if (size > 0)
+            {
+                _lowBin = std::min(_lowBin, start);
+                _highBin = std::max(_highBin, start + size);
+            }
+            numCoefficients += size;
+        }
+        _lowBin = std::min(_lowBin, _highBin);
+        if (_parameters.filterSizes.size() != numFilters || numCoefficients != _parameters.filterCoefficients.size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "Filter sizes don't match the coefficients");
+        }
+        if (!_parameters.logOffsets.empty() && _parameters.logOffsets.size() != numFilters)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "There must be one log offset per filter");
+        }
+        if (_parameters.numDCTCoefficients > numFilters)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Can't compute more DCT coefficients than there are filters");
+        }
+
+        _plan = dsp::FFTPlan<ValueType>(fftSize);
+        _dctMatrix.clear();
+        if (_parameters.numDCTCoefficients > 0)
+        {
+            auto dctMatrix = dsp::GetDCTMatrix<ValueType>(numFilters, _parameters.numDCTCoefficients);
+            for (size_t row = 0; row < dctMatrix.NumRows(); ++row)
+            {
+                for (size_t column = 0; column < dctMatrix.NumColumns(); ++column)
+                {
+                    _dctMatrix.push_back(dctMatrix(row, column));
+                }
+            }
+        }
+        _output.SetSize(_parameters.numDCTCoefficients > 0 ? _parameters.numDCTCoefficients : numFilters);
+    }
+
+    template <typename ValueType>
+    void AudioFrontEndNode<ValueType>::Compute() const
+    {
+        const auto& window = _parameters.window;
+        auto frame = _input.GetValue();
+        for (size_t index = 0; index < window.size(); ++index)
+        {
+            frame[index] *= static_cast<ValueType>(window[index]);
+        }
+        frame.resize(_parameters.fftSize);
+        std::vector<std::complex<ValueType>> scratch;
+        dsp::FFT(_plan, frame, scratch);
+        if (_parameters.powerSpectrum)
+        {
+            const auto divisor = static_cast<ValueType>(_parameters.powerDivisor);
+            for (int bin = _lowBin; bin < _highBin; ++bin)
+            {
+                frame[bin] = (frame[bin] * frame[bin]) / divisor;
+            }
+        }
+
+        const auto numFilters = _parameters.filterStarts.size();
+        std::vector<ValueType> energies(numFilters);
+        for (size_t filterIndex = 0, coefficientIndex = 0; filterIndex < numFilters; ++filterIndex)
+        {
+            ValueType sum = 0;
+            auto start = _parameters.filterStarts[filterIndex];
+            for (int index = 0; index < _parameters.filterSizes[filterIndex]; ++index, ++coefficientIndex)
+            {
+                sum += frame[start + index] * static_cast<ValueType>(_parameters.filterCoefficients[coefficientIndex]);
+            }
+            energies[filterIndex] = sum;
+        }
+
+        for (size_t filterIndex = 0; filterIndex < _parameters.logOffsets.size(); ++filterIndex)
+        {
+            energies[filterIndex] = std::log(energies[filterIndex] + static_cast<ValueType>(_parameters.logOffsets[filterIndex]));
+        }
+
+        if (_parameters.numDCTCoefficients == 0)
+        {
+            _output.SetOutput(energies);
+            return;
+        }
+
+        std::vector<ValueType> result(_parameters.numDCTCoefficients);
+        for (size_t row = 0; row < result.size(); ++row)
+        {
+            ValueType sum = 0;
+            for (size_t column = 0; column < numFilters; ++column)
+            {
+                sum += _dctMatrix[row * numFilters + column] * energies[column];
+            }
+            result[row] = sum;
+        }
+        _output.SetOutput(result);
+    }
+
+    template <typename ValueType>
+    void AudioFrontEndNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        using namespace std::string_literals;
+
+        auto& module = function.GetModule();
+        const auto fftSize = static_cast<int>(_parameters.fftSize);
+        const auto inputSize = std::min(static_cast<int>(input.Size()), fftSize);
+        const auto numFilters = static_cast<int>(_parameters.filterStarts.size());
+        const auto numDCTCoefficients = static_cast<int>(_parameters.numDCTCoefficients);
+        const auto powerSpectrum = _parameters.powerSpectrum;
+        const auto powerDivisor = static_cast<ValueType>(_parameters.powerDivisor);
+
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+
+        // The one scratch buffer: the complex spectrum, as interleaved real and imaginary parts, which is overwritten
+        // by the magnitudes of the bins in place, followed by the filter outputs if a DCT reads them
+        emitters::LLVMValue spectrum = function.Variable(emitters::GetVariableType<ValueType>(), 2 * fftSize);
+
+        // Load the windowed input as the real parts, zero-padded
+        const bool hasWindow = !_parameters.window.empty();
+        emitters::LLVMValue windowVar = hasWindow ? module.ConstantArray("audioFrontEndWindow_"s + GetInternalStateIdentifier(), CastVector<ValueType>(_parameters.window)) : nullptr;
+        function.For(inputSize, [pInput, windowVar, spectrum](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+            auto value = function.LocalScalar(function.ValueAt(pInput, index));
+            function.SetValueAt(spectrum, index * 2, windowVar == nullptr ? value : value * function.LocalScalar(function.ValueAt(windowVar, index)));
+            function.SetValueAt(spectrum, index * 2 + 1, function.Literal<ValueType>(0));
+        });
+        if (fftSize > inputSize)
+        {
+            function.MemorySet<ValueType>(spectrum, 2 * inputSize, function.Literal<uint8_t>(0), 2 * (fftSize - inputSize));
+        }
+
+        FFTNode<ValueType>::EmitInPlaceFFT(function, _plan, spectrum);
+
+        // Replace the bins the filters read by their magnitude or power. Bin k is written to entry k, at or before the
+        // entries of bin k, so the bins after it are still intact.
+        function.For(_lowBin, _highBin, [spectrum, powerSpectrum, powerDivisor](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar bin) {
+            auto re = function.LocalScalar(function.ValueAt(spectrum, bin * 2));
+            auto im = function.LocalScalar(function.ValueAt(spectrum, bin * 2 + 1));
+            auto power = re * re + im * im;
+            function.SetValueAt(spectrum, bin, powerSpectrum ? power / powerDivisor : emitters::Sqrt(power));
+        });
+
+        // Apply the filters over their nonzero coefficients
+        std::vector<int> coefficientBegins;
+        std::vector<int> coefficientEnds;
+        int numCoefficients = 0;
+        for (auto size : _parameters.filterSizes)
+        {
+            coefficientBegins.push_back(numCoefficients);
+            numCoefficients += size;
+            coefficientEnds.push_back(numCoefficients);
+        }
+        auto coefficients = CastVector<ValueType>(_parameters.filterCoefficients);
+        if (coefficients.empty())
+        {
+            coefficients.push_back(0); // avoid an empty global; no filter reads it
+        }
+        auto startVar = module.ConstantArray("audioFrontEndFilterStart_"s + GetInternalStateIdentifier(), _parameters.filterStarts);
+        auto beginVar = module.ConstantArray("audioFrontEndFilterCoefficientBegin_"s + GetInternalStateIdentifier(), coefficientBegins);
+        auto endVar = module.ConstantArray("audioFrontEndFilterCoefficientEnd_"s + GetInternalStateIdentifier(), coefficientEnds);
+        auto coefficientsVar = module.ConstantArray("audioFrontEndFilterCoefficients_"s + GetInternalStateIdentifier(), coefficients);
+
+        auto energies = numDCTCoefficients > 0 ? function.PointerOffset(spectrum, fftSize) : pOutput;
+        function.For(numFilters, [spectrum, energies, startVar, beginVar, endVar, coefficientsVar](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar filterIndex) {
+            auto sum = function.Variable(emitters::GetVariableType<ValueType>());
+            auto start = function.LocalScalar(function.ValueAt(startVar, filterIndex));
+            auto begin = function.LocalScalar(function.ValueAt(beginVar, filterIndex));
+            auto end = function.LocalScalar(function.ValueAt(endVar, filterIndex));
+            function.StoreZero(sum);
+            function.For(begin, end, [spectrum, coefficientsVar, sum, start, begin](emitters::IRFunctionEmitter& function, auto index) {
+                auto value = function.LocalScalar(function.ValueAt(spectrum, start + (index - begin)));
+                auto coefficient = function.LocalScalar(function.ValueAt(coefficientsVar, index));
+                function.Store(sum, function.LocalScalar(function.Load(sum)) + value * coefficient);
+            });
+            function.SetValueAt(energies, filterIndex, function.Load(sum));
+        });
+
+        if (!_parameters.logOffsets.empty())
+        {
+            auto offsetsVar = module.ConstantArray("audioFrontEndLogOffsets_"s + GetInternalStateIdentifier(), CastVector<ValueType>(_parameters.logOffsets));
+            function.For(numFilters, [energies, offsetsVar](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+                auto energy = function.LocalScalar(function.ValueAt(energies, index));
+                auto offset = function.LocalScalar(function.ValueAt(offsetsVar, index));
+                function.SetValueAt(energies, index, emitters::Log(energy + offset));
+            });
+        }
+
+        if (numDCTCoefficients > 0)
+        {
+            auto dctVar = module.ConstantArray("audioFrontEndDCT_"s + GetInternalStateIdentifier(), _dctMatrix);
+            function.For(numDCTCoefficients, [energies, dctVar, pOutput, numFilters](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar row) {
+                auto sum = function.Variable(emitters::GetVariableType<ValueType>());
+                function.StoreZero(sum);
+                function.For(numFilters, [energies, dctVar, sum, row, numFilters](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar column) {
+                    auto coefficient = function.LocalScalar(function.ValueAt(dctVar, row * numFilters + column));
+                    auto energy = function.LocalScalar(function.ValueAt(energies, column));
+                    function.Store(sum, function.LocalScalar(function.Load(sum)) + coefficient * energy);
+                });
+                function.SetValueAt(pOutput, row, function.Load(sum));
+            });
+        }
+    }
+
+    template <typename ValueType>
+    void AudioFrontEndNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInputs = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<AudioFrontEndNode<ValueType>>(newInputs, _parameters);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void AudioFrontEndNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["window"] << _parameters.window;
+        archiver["fftSize"] << _parameters.fftSize;
+        archiver["powerSpectrum"] << _parameters.powerSpectrum;
+        archiver["powerDivisor"] << _parameters.powerDivisor;
+        archiver["filterStarts"] << _parameters.filterStarts;
+        archiver["filterSizes"] << _parameters.filterSizes;
+        archiver["filterCoefficients"] << _parameters.filterCoefficients;
+        archiver["logOffsets"] << _parameters.logOffsets;
+        archiver["numDCTCoefficients"] << _parameters.numDCTCoefficients;
+    }
+
+    template <typename ValueType>
+    void AudioFrontEndNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["window"] >> _parameters.window;
+        archiver["fftSize"] >> _parameters.fftSize;
+        archiver["powerSpectrum"] >> _parameters.powerSpectrum;
+        archiver["powerDivisor"] >> _parameters.powerDivisor;
+        archiver["filterStarts"] >> _parameters.filterStarts;
+        archiver["filterSizes"] >> _parameters.filterSizes;
+        archiver["filterCoefficients"] >> _parameters.filterCoefficients;
+        archiver["logOffsets"] >> _parameters.logOffsets;
+        archiver["numDCTCoefficients"] >> _parameters.numDCTCoefficients;
+        Initialize();
+    }
+
+    // Explicit instantiations
+    template class AudioFrontEndNode<float>;
+    template class AudioFrontEndNode<double>;
+} // namespace nodes
+} // namespace ell
@@ -57,6 +57,36 @@ namespace nodes
             return ((filterVolumeSize - 1) / (8 * sizeof(PackedBitsType)) + 1) * numOutputPixels;
         }
 
+        // Returns the packed receptive field matrix already computed from the given input for another layer with the same
+        // receptive field, stride, and input and output image sizes, or nullptr if there isn't one
+        template <typename ValueType, typename PackedBitsType>
+        const model::OutputPort<PackedBitsType>* FindReceptiveFieldMatrix(const model::OutputPort<ValueType>& input,
+                                                                         const predictors::neural::BinaryConvolutionalParameters& convParams,
+                                                                         const model::PortMemoryLayout& inputLayout,
+                                                                         const model::PortMemoryLayout& outputLayout)
+        {
+            for (auto reference : input.GetReferences())
+            {
+                auto node = dynamic_cast<const BinaryReceptiveFieldMatrixNode<ValueType, PackedBitsType>*>(reference->GetNode());
+                if (node == nullptr || node->input.Size() != input.Size())
+                {
+                    continue;
+                }
+
+                const auto& nodeParams = node->GetConvolutionalParameters();
+                const auto nodeOutputLayout = node->GetOutputMemoryLayout();
+                if (nodeParams.receptiveField == convParams.receptiveField &&
+                    nodeParams.stride == convParams.stride &&
+                    node->GetInputMemoryLayout() == inputLayout &&
+                    nodeOutputLayout.GetActiveSize(0) == outputLayout.GetActiveSize(0) &&
+                    nodeOutputLayout.GetActiveSize(1) == outputLayout.GetActiveSize(1))
+                {
+                    return &node->output;
+                }
+            }
+            return nullptr;
+        }
+
         template <typename ValueType>
         void LoadRow(emitters::IRFunctionEmitter& function,
                      emitters::LLVMValue inputVolume,
@@ -259,15 +289,21 @@ namespace nodes
         auto paddingMaskSums = GetInputPaddingMaskSums();
         auto filterMeans = GetFilterMeans();
 
-        auto reshapeNode = transformer.AddNode<BinaryReceptiveFieldMatrixNode<ValueType, PackedBitsType>>(input,
-                                                                                                          convParams,
-                                                                                                          inputLayout,
-                                                                                                          outputLayout);
+        // Layers that read the same input (e.g., parallel branches) share one packed copy of it
+        auto reshapedInput = FindReceptiveFieldMatrix<ValueType, PackedBitsType>(input, convParams, inputLayout, outputLayout);
+        if (reshapedInput == nullptr)
+        {
+            auto reshapeNode = transformer.AddNode<BinaryReceptiveFieldMatrixNode<ValueType, PackedBitsType>>(input,
+                                                                                                              convParams,
+                                                                                                              inputLayout,
+                                                                                                              outputLayout);
+            reshapedInput = &reshapeNode->output;
+        }
         const auto& paddingMasksOut = Constant(transformer, compressedPaddingMasks);
         const auto& paddingMaskSumsOut = Constant(transformer, paddingMaskSums);
         const auto& filterWeightsOut = Constant(transformer, compressedFilterWeights);
         const auto& filterMeansOut = Constant(transformer, filterMeans);
-        auto xnorNode = transformer.AddNode<BinaryXnorNode<ValueType, PackedBitsType>>(reshapeNode->output,
+        auto xnorNode = transformer.AddNode<BinaryXnorNode<ValueType, PackedBitsType>>(*reshapedInput,
                                                                                        paddingMasksOut,
                                                                                        paddingMaskSumsOut,
                                                                                        filterWeightsOut,
@@ -602,19 +638,28 @@ namespace nodes
             useVectorInstructions = false;
         }
 
+        // Split the work into blocks of filters, and the filters into blocks of output columns if there are fewer of
+        // them than threads, so layers with few filters still keep every thread busy
         const int numDesiredTasks = compilerSettings.maxThreads;
-        const int taskSize = CeilDiv(numFilters, numDesiredTasks);
-        const int numTasks = CeilDiv(numFilters, taskSize);
-        if (compilerSettings.parallelize && numTasks > 1)
+        const int filterTaskSize = CeilDiv(numFilters, std::min(numFilters, numDesiredTasks));
+        const int numFilterTasks = CeilDiv(numFilters, filterTaskSize);
+        const int columnTaskSize = CeilDiv(outputColumns, std::min(outputColumns, CeilDiv(numDesiredTasks, numFilterTasks)));
+        const int numColumnTasks = CeilDiv(outputColumns, columnTaskSize);
+        if (compilerSettings.parallelize && numFilterTasks * numColumnTasks > 1)
         {
             auto taskFunction = GetTaskFunction(compiler, function);
             std::vector<std::vector<emitters::LLVMValue>> taskArgs;
-            for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+            for (int filterTaskIndex = 0; filterTaskIndex < numFilterTasks; ++filterTaskIndex)
             {
-                auto start = taskIndex * taskSize;
-                auto end = std::min((taskIndex + 1) * taskSize, numFilters);
-                std::vector<emitters::LLVMValue> args = { pInput, pFilterWeights, pFilterMeans, pInputPaddingMask, pInputPaddingMaskSums, pOutput, function.Literal<int32_t>(start), function.Literal<int32_t>(end) };
-                taskArgs.push_back(args);
+                auto filterStart = filterTaskIndex * filterTaskSize;
+                auto filterEnd = std::min((filterTaskIndex + 1) * filterTaskSize, numFilters);
+                for (int columnTaskIndex = 0; columnTaskIndex < numColumnTasks; ++columnTaskIndex)
+                {
+                    auto columnStart = columnTaskIndex * columnTaskSize;
+                    auto columnEnd = std::min((columnTaskIndex + 1) * columnTaskSize, outputColumns);
+                    std::vector<emitters::LLVMValue> args = { pInput, pFilterWeights, pFilterMeans, pInputPaddingMask, pInputPaddingMaskSums, pOutput, function.Literal<int32_t>(filterStart), function.Literal<int32_t>(filterEnd), function.Literal<int32_t>(columnStart), function.Literal<int32_t>(columnEnd) };
+                    taskArgs.push_back(args);
+                }
             }
             auto tasks = function.StartTasks(taskFunction, taskArgs);
             tasks.WaitAll(function);
@@ -632,6 +677,8 @@ namespace nodes
                                     pInputPaddingMaskSums,
                                     pOutput,
                                     filterIndex,
+                                    function.Literal<int>(0),
+                                    function.Literal<int>(outputColumns),
                                     hasZeroPadding,
                                     outputColumns,
                                     packedRowSize,
@@ -703,9 +750,9 @@ namespace nodes
         }
 
         // TODO: get types in a way that doesn't require emitting these variables
-        auto argTypes = emitters::GetLLVMTypes({ pInput, pFilterWeights, pFilterMeans, pInputPaddingMask, pInputPaddingMaskSums, pOutput, function.Literal<int32_t>(0), function.Literal<int32_t>(0) });
+        auto argTypes = emitters::GetLLVMTypes({ pInput, pFilterWeights, pFilterMeans, pInputPaddingMask, pInputPaddingMaskSums, pOutput, function.Literal<int32_t>(0), function.Literal<int32_t>(0), function.Literal<int32_t>(0), function.Literal<int32_t>(0) });
         emitters::IRFunctionEmitter taskFunction = function.GetModule().BeginFunction(utilities::to_string(GetId()) + "_task", voidType, argTypes);
-        std::vector<size_t> indices(argTypes.size() - 2);
+        std::vector<size_t> indices(argTypes.size() - 4);
         std::iota(indices.begin(), indices.end(), 0);
         taskFunction.SetAttributeForArguments(indices, emitters::IRFunctionEmitter::Attributes::NoAlias);
 
@@ -719,8 +766,10 @@ namespace nodes
             auto pOutput = &(*arguments++);
             auto blockStartVal = &(*arguments++);
             auto blockEndVal = &(*arguments++);
+            auto columnStartVal = &(*arguments++);
+            auto columnEndVal = &(*arguments++);
 
-            taskFunction.For(blockStartVal, blockEndVal, taskFunction.Literal<int>(1), [pInput, pFilterWeights, pFilterMeans, pInputPaddingMask, pInputPaddingMaskSums, pOutput, hasZeroPadding, outputColumns, packedRowSize, packedRowStride, useVectorInstructions, vectorSize, numVectorBlocks, &compiler, this](emitters::IRFunctionEmitter& taskFunction, emitters::LLVMValue filterIndex) {
+            taskFunction.For(blockStartVal, blockEndVal, taskFunction.Literal<int>(1), [pInput, pFilterWeights, pFilterMeans, pInputPaddingMask, pInputPaddingMaskSums, pOutput, columnStartVal, columnEndVal, hasZeroPadding, outputColumns, packedRowSize, packedRowStride, useVectorInstructions, vectorSize, numVectorBlocks, &compiler, this](emitters::IRFunctionEmitter& taskFunction, emitters::LLVMValue filterIndex) {
                 ComputeFilterOutput(compiler,
                                     taskFunction,
                                     pInput,
@@ -730,6 +779,8 @@ namespace nodes
                                     pInputPaddingMaskSums,
                                     pOutput,
                                     filterIndex,
+                                    columnStartVal,
+                                    columnEndVal,
                                     hasZeroPadding,
                                     outputColumns,
                                     packedRowSize,
@@ -755,6 +806,8 @@ namespace nodes
                                                                         emitters::LLVMValue pInputPaddingMaskSums,
                                                                         emitters::LLVMValue pOutput,
                                                                         emitters::LLVMValue filterIndexPtr,
+                                                                        emitters::LLVMValue columnBegin,
+                                                                        emitters::LLVMValue columnEnd,
                                                                         bool hasZeroPadding,
                                                                         int outputColumns,
                                                                         int packedRowSize,
@@ -810,7 +863,7 @@ namespace nodes
 
         // Compute and accumulate xnor counts
 
-        function.For(outputColumns, [=](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
+        function.For(columnBegin, columnEnd, function.Literal<int>(1), [=](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
             auto outputColumnIndex = function.LocalScalar(i);
 
             // The start of the binarized receptive field matrix for this output image pixel
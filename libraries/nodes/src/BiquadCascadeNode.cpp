@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BiquadCascadeNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "BiquadCascadeNode.h"
+
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRLocalScalar.h>
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace nodes
+{
+    template <typename ValueType>
+    BiquadCascadeNode<ValueType>::BiquadCascadeNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    BiquadCascadeNode<ValueType>::BiquadCascadeNode(const model::OutputPort<ValueType>& input, const std::vector<dsp::BiquadSection<ValueType>>& sections, size_t numChannels) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, _input.Size()),
+        _filter(sections, numChannels)
+    {
+        if (_input.Size() % numChannels != 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "BiquadCascadeNode input size must be a multiple of the number of channels");
+        }
+    }
+
+    template <typename ValueType>
+    void BiquadCascadeNode<ValueType>::Compute() const
+    {
+        _output.SetOutput(_filter.FilterFrames(_input.GetValue()));
+    }
+
+    template <typename ValueType>
+    void BiquadCascadeNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInputs = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<BiquadCascadeNode<ValueType>>(newInputs, _filter.GetSections(), _filter.GetNumChannels());
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void BiquadCascadeNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        using namespace std::string_literals;
+
+        auto& module = function.GetModule();
+        const auto& sections = _filter.GetSections();
+        const int numChannels = static_cast<int>(_filter.GetNumChannels());
+        const int numFrames = static_cast<int>(input.Size()) / numChannels;
+        const int stateSize = static_cast<int>(sections.size()) * numChannels;
+
+        // The state of section s for channel c is at s * numChannels + c, so each section's state is contiguous across the channels
+        llvm::GlobalVariable* state1 = module.GlobalArray("biquadState1_"s + GetInternalStateIdentifier(), std::vector<ValueType>(stateSize, 0));
+        llvm::GlobalVariable* state2 = module.GlobalArray("biquadState2_"s + GetInternalStateIdentifier(), std::vector<ValueType>(stateSize, 0));
+
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+
+        const auto& compilerOptions = function.GetCompilerOptions();
+        const bool vectorize = compilerOptions.allowVectorInstructions && compilerOptions.vectorWidth > 1;
+        const int vectorWidth = compilerOptions.vectorWidth;
+
+        function.For(numFrames, [=, &sections](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar frame) {
+            auto frameOffset = frame * numChannels;
+            if (sections.empty())
+            {
+                function.For(numChannels, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar c) {
+                    function.SetValueAt(pOutput, frameOffset + c, function.ValueAt(pInput, frameOffset + c));
+                });
+                return;
+            }
+
+            // The coefficients are constants in the code, and each section reads the previous section's output
+            for (size_t s = 0; s < sections.size(); ++s)
+            {
+                const auto section = sections[s];
+                const int stateOffset = static_cast<int>(s) * numChannels;
+                const auto sectionInput = s == 0 ? pInput : pOutput;
+                auto body = [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar c) {
+                    auto x = function.LocalScalar(function.ValueAt(sectionInput, frameOffset + c));
+                    auto z1 = function.LocalScalar(function.ValueAt(state1, c + stateOffset));
+                    auto z2 = function.LocalScalar(function.ValueAt(state2, c + stateOffset));
+                    auto y = section.b0 * x + z1;
+                    function.SetValueAt(state1, c + stateOffset, section.b1 * x - section.a1 * y + z2);
+                    function.SetValueAt(state2, c + stateOffset, section.b2 * x - section.a2 * y);
+                    function.SetValueAt(pOutput, frameOffset + c, y);
+                };
+
+                if (vectorize)
+                {
+                    // The channels are independent, so the loop over them can be vectorized
+                    function.VectorizedFor(function.Literal<int>(0), function.Literal<int>(numChannels), vectorWidth, true, body);
+                }
+                else
+                {
+                    function.For(numChannels, body);
+                }
+            }
+        });
+    }
+
+    template <typename ValueType>
+    void BiquadCascadeNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["filter"] << _filter;
+    }
+
+    template <typename ValueType>
+    void BiquadCascadeNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["filter"] >> _filter;
+        _output.SetSize(_input.Size());
+    }
+
+    //
+    // Explicit instantiation definitions
+    //
+    template class BiquadCascadeNode<float>;
+    template class BiquadCascadeNode<double>;
+} // namespace nodes
+} // namespace ell
@@ -10,6 +10,8 @@
 
 #include "ClockNode.h"
 
+#include <algorithm>
+
 namespace ell
 {
 namespace nodes
@@ -19,18 +21,26 @@ namespace nodes
     // Useful aliases for operators
     const auto plusTime = emitters::GetOperator<TimeTickType>(emitters::BinaryOperatorType::add);
     const auto minusTime = emitters::GetOperator<TimeTickType>(emitters::BinaryOperatorType::subtract);
+    const auto timesTime = emitters::GetOperator<TimeTickType>(emitters::BinaryOperatorType::multiply);
+    const auto divideTime = emitters::GetOperator<TimeTickType>(emitters::BinaryOperatorType::divide);
+    const auto plusCount = emitters::GetOperator<int64_t>(emitters::BinaryOperatorType::add);
 
     // comparisons
     const auto equalTime = emitters::GetComparison<TimeTickType>(emitters::BinaryPredicateType::equal);
     const auto greaterThanTime = emitters::GetComparison<TimeTickType>(emitters::BinaryPredicateType::greater);
     const auto greaterThanOrEqualTime = emitters::GetComparison<TimeTickType>(emitters::BinaryPredicateType::greaterOrEqual);
+    const auto lessThanTime = emitters::GetComparison<TimeTickType>(emitters::BinaryPredicateType::less);
+    const auto greaterThanCount = emitters::GetComparison<int64_t>(emitters::BinaryPredicateType::greater);
+
+    // The upper bounds of the lateness histogram buckets, in intervals. The last bucket has no bound.
+    const std::array<TimeTickType, ClockDeadlineTelemetry::numLatenessBuckets - 1> latenessBucketBounds = { 0.25, 0.5, 1, 2, 4 };
 
     ClockNode::ClockNode() :
         ClockNode({}, 0, 0, "", nullptr)
     {
     }
 
-    ClockNode::ClockNode(const model::OutputPort<TimeTickType>& input, TimeTickType interval, TimeTickType lagThreshold, const std::string& functionName, LagNotificationFunction function) :
+    ClockNode::ClockNode(const model::OutputPort<TimeTickType>& input, TimeTickType interval, TimeTickType lagThreshold, const std::string& functionName, LagNotificationFunction function, bool dropStaleTicks) :
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, 2 /*sampleTime, currentTime*/),
@@ -38,7 +48,8 @@ namespace nodes
         _lastIntervalTime(UninitializedIntervalTime),
         _lagThreshold(lagThreshold),
         _lagNotificationFunction(function == nullptr ? [](auto) {} : function),
-        _lagNotificationFunctionName(functionName)
+        _lagNotificationFunctionName(functionName),
+        _dropStaleTicks(dropStaleTicks)
     {
         if (interval < 0)
         {
@@ -64,6 +75,25 @@ namespace nodes
         else
         {
             _lastIntervalTime += _interval;
+            if (_dropStaleTicks)
+            {
+                // Skip to the latest interval that is due, dropping the ones in between
+                auto staleIntervals = static_cast<int64_t>((currentTime - _lastIntervalTime) / _interval);
+                if (staleIntervals > 0)
+                {
+                    _lastIntervalTime += staleIntervals * _interval;
+                    _telemetry.droppedTickCount += staleIntervals;
+                }
+            }
+
+            auto lateness = currentTime - _lastIntervalTime;
+            _telemetry.lastSlack = _interval - lateness;
+            if (_telemetry.lastSlack < 0)
+            {
+                ++_telemetry.missedDeadlineCount;
+            }
+            auto bucket = std::count_if(latenessBucketBounds.begin(), latenessBucketBounds.end(), [this, lateness](TimeTickType bound) { return lateness >= bound * _interval; });
+            ++_telemetry.latenessHistogram[bucket];
         }
 
         if (_lagNotificationFunction && _interval > 0)
@@ -100,6 +130,12 @@ namespace nodes
         auto pLastIntervalTime = module.Global(compiler.GetNamespacePrefix() + "_lastIntervalTime", UninitializedIntervalTime);
         auto lastIntervalTime = function.Load(pLastIntervalTime);
 
+        // State: deadline telemetry
+        auto pLastSlack = module.Global(compiler.GetNamespacePrefix() + "_lastSlack", TimeTickType(0));
+        auto pMissedDeadlineCount = module.Global(compiler.GetNamespacePrefix() + "_missedDeadlineCount", int64_t(0));
+        auto pDroppedTickCount = module.Global(compiler.GetNamespacePrefix() + "_droppedTickCount", int64_t(0));
+        auto pLatenessHistogram = module.GlobalArray<int64_t>(compiler.GetNamespacePrefix() + "_latenessHistogram", ClockDeadlineTelemetry::numLatenessBuckets);
+
         // No lag when:
         // 1) this is the very first call, or
         // 2) the interval is zero
@@ -113,8 +149,33 @@ namespace nodes
         function.If(noLag, [newLastInterval, now](emitters::IRFunctionEmitter& function) {
                     function.Store(newLastInterval, now);
                 })
-            .Else([newLastInterval, lastIntervalTime, interval](emitters::IRFunctionEmitter& function) {
-                function.Store(newLastInterval, function.Operator(plusTime, lastIntervalTime, interval));
+            .Else([this, newLastInterval, lastIntervalTime, interval, now, pLastSlack, pMissedDeadlineCount, pDroppedTickCount, pLatenessHistogram](emitters::IRFunctionEmitter& function) {
+                auto nextIntervalTime = function.Operator(plusTime, lastIntervalTime, interval);
+                if (_dropStaleTicks)
+                {
+                    // Skip to the latest interval that is due, dropping the ones in between
+                    auto staleIntervals = function.CastValue<int64_t>(function.Operator(divideTime, function.Operator(minusTime, now, nextIntervalTime), interval));
+                    auto zeroCount = function.Literal<int64_t>(0);
+                    staleIntervals = function.Select(function.Comparison(greaterThanCount, staleIntervals, zeroCount), staleIntervals, zeroCount);
+                    nextIntervalTime = function.Operator(plusTime, nextIntervalTime, function.Operator(timesTime, function.CastValue<TimeTickType>(staleIntervals), interval));
+                    function.OperationAndUpdate(pDroppedTickCount, plusCount, staleIntervals);
+                }
+                function.Store(newLastInterval, nextIntervalTime);
+
+                auto lateness = function.Operator(minusTime, now, nextIntervalTime);
+                auto slack = function.Operator(minusTime, interval, lateness);
+                function.Store(pLastSlack, slack);
+                auto isMissed = function.Comparison(lessThanTime, slack, function.Literal<TimeTickType>(0));
+                function.OperationAndUpdate(pMissedDeadlineCount, plusCount, function.Select(isMissed, function.Literal<int64_t>(1), function.Literal<int64_t>(0)));
+
+                // The bucket is the number of bounds the lateness has reached
+                emitters::LLVMValue bucket = function.Literal<int>(0);
+                for (auto bound : latenessBucketBounds)
+                {
+                    auto isPastBound = function.Comparison(greaterThanOrEqualTime, lateness, function.Literal<TimeTickType>(bound * _interval));
+                    bucket = function.Operator(emitters::TypedOperator::add, bucket, function.Select(isPastBound, function.Literal<int>(1), function.Literal<int>(0)));
+                }
+                function.OperationAndUpdate(function.PointerOffset(pLatenessHistogram, bucket), plusCount, function.Literal<int64_t>(1));
             });
 
         function.If(greaterThanTime, interval, zeroInterval, [now, newLastInterval, thresholdTime, prefixedName, &module, &compiler](emitters::IRFunctionEmitter& function) {
@@ -140,12 +201,13 @@ namespace nodes
         EmitGetTicksUntilNextIntervalFunction(compiler, module, pLastIntervalTime);
         EmitGetLagThresholdFunction(compiler, module);
         EmitGetStepIntervalFunction(compiler, module);
+        EmitDeadlineTelemetryFunctions(compiler, module, pLastSlack, pMissedDeadlineCount, pDroppedTickCount, pLatenessHistogram);
     }
 
     void ClockNode::Copy(model::ModelTransformer& transformer) const
     {
         const auto& newInputs = transformer.GetCorrespondingInputs(_input);
-        auto newNode = transformer.AddNode<ClockNode>(newInputs, _interval, _lagThreshold, _lagNotificationFunctionName, _lagNotificationFunction);
+        auto newNode = transformer.AddNode<ClockNode>(newInputs, _interval, _lagThreshold, _lagNotificationFunctionName, _lagNotificationFunction, _dropStaleTicks);
         transformer.MapNodeOutput(output, newNode->output);
     }
 
@@ -158,6 +220,7 @@ namespace nodes
         archiver["interval"] << _interval;
         archiver["lagThreshold"] << _lagThreshold;
         archiver["lagNotificationFunctionName"] << _lagNotificationFunctionName;
+        archiver["dropStaleTicks"] << _dropStaleTicks;
     }
 
     void ClockNode::ReadFromArchive(utilities::Unarchiver& archiver)
@@ -169,6 +232,11 @@ namespace nodes
         archiver["interval"] >> _interval;
         archiver["lagThreshold"] >> _lagThreshold;
         archiver["lagNotificationFunctionName"] >> _lagNotificationFunctionName;
+        _dropStaleTicks = false;
+        if (archiver.HasNextPropertyName("dropStaleTicks"))
+        {
+            archiver["dropStaleTicks"] >> _dropStaleTicks;
+        }
     }
 
     TimeTickType ClockNode::GetTicksUntilNextInterval(TimeTickType now) const
@@ -245,5 +313,56 @@ namespace nodes
         function.Return(function.template Literal<TimeTickType>(_interval));
         moduleEmitter.EndFunction();
     }
+
+    void ClockNode::EmitDeadlineTelemetryFunctions(model::IRMapCompiler& compiler, emitters::IRModuleEmitter& moduleEmitter, llvm::GlobalVariable* pLastSlack, llvm::GlobalVariable* pMissedDeadlineCount, llvm::GlobalVariable* pDroppedTickCount, llvm::GlobalVariable* pLatenessHistogram)
+    {
+        const auto prefix = compiler.GetNamespacePrefix();
+        const auto timeTickType = emitters::GetVariableType<TimeTickType>();
+
+        // The getters of the scalar telemetry
+        auto emitGetter = [&moduleEmitter](const std::string& functionName, emitters::VariableType returnType, llvm::GlobalVariable* pValue) {
+            emitters::IRFunctionEmitter function = moduleEmitter.BeginFunction(functionName, returnType, emitters::NamedVariableTypeList{});
+            moduleEmitter.DeclareFunction(functionName, returnType, emitters::NamedVariableTypeList{});
+            function.IncludeInHeader();
+            function.Return(function.Load(pValue));
+            moduleEmitter.EndFunction();
+        };
+        emitGetter(prefix + "_GetLastSlack", timeTickType, pLastSlack);
+        emitGetter(prefix + "_GetMissedDeadlineCount", emitters::VariableType::Int64, pMissedDeadlineCount);
+        emitGetter(prefix + "_GetDroppedTickCount", emitters::VariableType::Int64, pDroppedTickCount);
+
+        // GetLatenessHistogram copies the counts of the buckets to an array of `numLatenessBuckets` entries
+        {
+            std::string functionName = prefix + "_GetLatenessHistogram";
+            const emitters::NamedVariableTypeList parameters = { { "counts", emitters::VariableType::Int64Pointer } };
+            emitters::IRFunctionEmitter function = moduleEmitter.BeginFunction(functionName, emitters::VariableType::Void, parameters);
+            moduleEmitter.DeclareFunction(functionName, emitters::VariableType::Void, parameters);
+            function.IncludeInHeader();
+
+            auto counts = &(*function.Arguments().begin());
+            for (int bucket = 0; bucket < ClockDeadlineTelemetry::numLatenessBuckets; ++bucket)
+            {
+                function.SetValueAt(counts, function.Literal(bucket), function.ValueAt(pLatenessHistogram, bucket));
+            }
+            moduleEmitter.EndFunction();
+        }
+
+        // ResetDeadlineTelemetry clears the telemetry, e.g. after a warm-up period
+        {
+            std::string functionName = prefix + "_ResetDeadlineTelemetry";
+            emitters::IRFunctionEmitter function = moduleEmitter.BeginFunction(functionName, emitters::VariableType::Void, emitters::NamedVariableTypeList{});
+            moduleEmitter.DeclareFunction(functionName, emitters::VariableType::Void, emitters::NamedVariableTypeList{});
+            function.IncludeInHeader();
+
+            function.Store(pLastSlack, function.Literal<TimeTickType>(0));
+            function.Store(pMissedDeadlineCount, function.Literal<int64_t>(0));
+            function.Store(pDroppedTickCount, function.Literal<int64_t>(0));
+            for (int bucket = 0; bucket < ClockDeadlineTelemetry::numLatenessBuckets; ++bucket)
+            {
+                function.SetValueAt(pLatenessHistogram, function.Literal(bucket), function.Literal<int64_t>(0));
+            }
+            moduleEmitter.EndFunction();
+        }
+    }
 } // namespace nodes
 } // namespace ell
@@ -46,6 +46,15 @@ namespace nodes
         auto shouldReorderToChannelMajor = isDepthwiseSeparable && (convParams.method == ConvolutionMethod::simple || convParams.method == ConvolutionMethod::winograd);
 
         auto convInputLayout = originalInputLayout.ReorderedCopy({ shouldReorderToChannelMajor ? utilities::ChannelMajorTensorOrder : utilities::RowMajorTensorOrder });
+
+        // The simple method can handle the image boundary itself, so if the input is copied to a new order anyway,
+        // the copy doesn't need to be padded
+        auto compiler = transformer.GetContext().GetCompiler();
+        auto implicitPadding = compiler != nullptr && compiler->GetModelOptimizerOptions(*this).template GetEntry<bool>("implicitPadding", false);
+        if (implicitPadding && shouldReorderToChannelMajor && convParams.method == ConvolutionMethod::simple)
+        {
+            convInputLayout = model::PortMemoryLayout(originalInputLayout.GetLogicalDimensionActiveSize()).ReorderedCopy(utilities::ChannelMajorTensorOrder);
+        }
         auto convOutputLayout = originalOutputLayout.ReorderedCopy({ shouldReorderToChannelMajor ? utilities::ChannelMajorTensorOrder : utilities::RowMajorTensorOrder });
 
         const auto& preConvReorder = ReorderData(*newInput, originalInputLayout, convInputLayout);
@@ -75,7 +84,9 @@ namespace nodes
         break;
         case ConvolutionMethod::winograd:
         {
-            auto convNode = transformer.AddNode<WinogradConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride);
+            // The "winogradTileSize" option selects F(4,3) or F(6,3) instead of F(2,3), which trade some precision for fewer multiplies
+            auto tileSize = compiler != nullptr ? compiler->GetModelOptimizerOptions(*this).template GetEntry<int>("winogradTileSize", 2) : 2;
+            auto convNode = transformer.AddNode<WinogradConvolutionNode<ValueType>>(*newInput, convInputLayout, convOutputLayout, weights, convParams.stride, tileSize);
             convOutput = &convNode->output;
         }
         break;
@@ -10,7 +10,9 @@
 
 #include "MatrixVectorProductNode.h"
 
-#include <dsp/include/DCT.h>
+#include <complex>
+#include <string>
+#include <vector>
 
 namespace ell
 {
@@ -18,44 +20,153 @@ namespace nodes
 {
     template <typename ValueType>
     DCTNode<ValueType>::DCTNode() :
-        Node({ &_input }, { &_output }),
+        CompilableNode({ &_input }, { &_output }),
         _input(this, {}, defaultInputPortName),
         _output(this, defaultOutputPortName, 0),
-        _dctCoeffs(0, 0)
+        _plan(0, 0)
     {
     }
 
     template <typename ValueType>
     DCTNode<ValueType>::DCTNode(const model::OutputPort<ValueType>& input, size_t numFilters) :
-        Node({ &_input }, { &_output }),
+        CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, numFilters),
-        _dctCoeffs(0, 0)
+        _plan(_input.Size(), numFilters)
     {
-        _dctCoeffs = dsp::GetDCTMatrix<ValueType>(numFilters, _input.Size());
     }
 
     template <typename ValueType>
     void DCTNode<ValueType>::Compute() const
     {
-        math::ColumnVector<ValueType> x(_input.GetValue());
-        auto result = dsp::DCT(_dctCoeffs, x);
-        _output.SetOutput(result.ToArray());
+        auto signal = _input.GetValue();
+        std::vector<ValueType> result(_plan.GetNumFilters());
+        std::vector<std::complex<ValueType>> scratch;
+        _plan.Transform(signal.data(), result.data(), scratch);
+        _output.SetOutput(result);
     };
 
     template <typename ValueType>
     void DCTNode<ValueType>::Copy(model::ModelTransformer& transformer) const
     {
         const auto& newInputs = transformer.GetCorrespondingInputs(_input);
-        auto newNode = transformer.AddNode<DCTNode<ValueType>>(newInputs, _dctCoeffs.NumRows());
+        auto newNode = transformer.AddNode<DCTNode<ValueType>>(newInputs, _plan.GetNumFilters());
         transformer.MapNodeOutput(output, newNode->output);
     }
 
+    template <typename ValueType>
+    void DCTNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        using namespace std::string_literals;
+
+        if (!_plan.UsesFFT())
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "DCTNode must be refined unless its DCT uses an FFT");
+        }
+
+        auto& module = function.GetModule();
+        const auto windowSize = _plan.GetWindowSize();
+        const auto numFilters = _plan.GetNumFilters();
+        const auto& fftPlan = _plan.GetFFTPlan();
+
+        // Write out the plan's tables as global variables: the index into the signal of each entry of the permuted
+        // signal in bit-reversed order, the twiddle factors of all the butterfly stages end to end, and the post-twiddle factors
+        const auto& permutation = _plan.GetPermutation();
+        const auto& bitReversal = fftPlan.GetBitReversalPermutation();
+        std::vector<int> signalIndices(windowSize);
+        for (size_t index = 0; index < windowSize; ++index)
+        {
+            signalIndices[index] = static_cast<int>(permutation[bitReversal[index]]);
+        }
+
+        std::vector<ValueType> twiddlesReal;
+        std::vector<ValueType> twiddlesImag;
+        for (size_t halfLength = 1; halfLength < windowSize; halfLength *= 2)
+        {
+            auto stageTwiddles = fftPlan.GetTwiddleFactors(2 * halfLength);
+            for (size_t k = 0; k < halfLength; ++k)
+            {
+                twiddlesReal.push_back(stageTwiddles[k].real());
+                twiddlesImag.push_back(stageTwiddles[k].imag());
+            }
+        }
+
+        std::vector<ValueType> postTwiddlesReal;
+        std::vector<ValueType> postTwiddlesImag;
+        for (auto w : _plan.GetPostTwiddleFactors())
+        {
+            postTwiddlesReal.push_back(w.real());
+            postTwiddlesImag.push_back(w.imag());
+        }
+
+        auto signalIndicesVar = module.ConstantArray("dctSignalIndices_"s + GetInternalStateIdentifier(), signalIndices);
+        auto twiddlesRealVar = module.ConstantArray("dctTwiddlesReal_"s + GetInternalStateIdentifier(), twiddlesReal);
+        auto twiddlesImagVar = module.ConstantArray("dctTwiddlesImag_"s + GetInternalStateIdentifier(), twiddlesImag);
+        auto postTwiddlesRealVar = module.ConstantArray("dctPostTwiddlesReal_"s + GetInternalStateIdentifier(), postTwiddlesReal);
+        auto postTwiddlesImagVar = module.ConstantArray("dctPostTwiddlesImag_"s + GetInternalStateIdentifier(), postTwiddlesImag);
+
+        // Get port variables
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+
+        // The real and imaginary parts of the signal being transformed
+        auto valueType = emitters::GetVariableType<ValueType>();
+        emitters::LLVMValue real = function.Variable(valueType, windowSize);
+        emitters::LLVMValue imag = function.Variable(valueType, windowSize);
+
+        function.For(windowSize, [pInput, signalIndicesVar, real, imag](emitters::IRFunctionEmitter& function, auto index) {
+            auto signalIndex = function.LocalScalar(function.ValueAt(signalIndicesVar, index));
+            function.SetValueAt(real, index, function.ValueAt(pInput, signalIndex));
+            function.SetValueAt(imag, index, function.Literal<ValueType>(0));
+        });
+
+        // Butterfly stages: the stage producing transforms of size 2h combines entries `start + k` and `start + k + h`
+        // with the twiddle factor at offset h-1+k
+        const auto size = static_cast<int>(windowSize);
+        for (int halfLength = 1; halfLength < size; halfLength *= 2)
+        {
+            function.For(0, size, 2 * halfLength, [halfLength, twiddlesRealVar, twiddlesImagVar, real, imag](emitters::IRFunctionEmitter& function, auto start) {
+                function.For(halfLength, [halfLength, twiddlesRealVar, twiddlesImagVar, real, imag, start](emitters::IRFunctionEmitter& function, auto k) {
+                    auto aIndex = start + k;
+                    auto bIndex = aIndex + halfLength;
+                    auto wRe = function.LocalScalar(function.ValueAt(twiddlesRealVar, k + (halfLength - 1)));
+                    auto wIm = function.LocalScalar(function.ValueAt(twiddlesImagVar, k + (halfLength - 1)));
+                    auto aRe = function.LocalScalar(function.ValueAt(real, aIndex));
+                    auto aIm = function.LocalScalar(function.ValueAt(imag, aIndex));
+                    auto bRe = function.LocalScalar(function.ValueAt(real, bIndex));
+                    auto bIm = function.LocalScalar(function.ValueAt(imag, bIndex));
+                    auto re = wRe * bRe - wIm * bIm;
+                    auto im = wRe * bIm + wIm * bRe;
+                    function.SetValueAt(real, bIndex, aRe - re);
+                    function.SetValueAt(imag, bIndex, aIm - im);
+                    function.SetValueAt(real, aIndex, aRe + re);
+                    function.SetValueAt(imag, aIndex, aIm + im);
+                });
+            });
+        }
+
+        // output[k] = Re(V[k] * w[k])
+        function.For(numFilters, [pOutput, postTwiddlesRealVar, postTwiddlesImagVar, real, imag](emitters::IRFunctionEmitter& function, auto k) {
+            auto vRe = function.LocalScalar(function.ValueAt(real, k));
+            auto vIm = function.LocalScalar(function.ValueAt(imag, k));
+            auto wRe = function.LocalScalar(function.ValueAt(postTwiddlesRealVar, k));
+            auto wIm = function.LocalScalar(function.ValueAt(postTwiddlesImagVar, k));
+            function.SetValueAt(pOutput, k, vRe * wRe - vIm * wIm);
+        });
+    }
+
     template <typename ValueType>
     bool DCTNode<ValueType>::Refine(model::ModelTransformer& transformer) const
     {
+        // A DCT computed with an FFT is compiled directly
+        if (_plan.UsesFFT())
+        {
+            Copy(transformer);
+            return false;
+        }
+
         const auto& newInputs = transformer.GetCorrespondingInputs(_input);
-        const auto& result = MatrixVectorProduct(newInputs, _dctCoeffs);
+        const auto& result = MatrixVectorProduct(newInputs, _plan.GetDCTMatrix());
         transformer.MapNodeOutput(output, result);
         return true;
     }
@@ -65,7 +176,7 @@ namespace nodes
     {
         Node::WriteToArchive(archiver);
         archiver[defaultInputPortName] << _input;
-        archiver["numFilters"] << _dctCoeffs.NumRows();
+        archiver["numFilters"] << _plan.GetNumFilters();
     }
 
     template <typename ValueType>
@@ -75,7 +186,7 @@ namespace nodes
         Node::ReadFromArchive(archiver);
         archiver[defaultInputPortName] >> _input;
         archiver["numFilters"] >> numFilters;
-        _dctCoeffs = dsp::GetDCTMatrix<ValueType>(numFilters, _input.Size());
+        _plan = dsp::DCTPlan<ValueType>(_input.Size(), numFilters);
         _output.SetSize(numFilters);
     }
 
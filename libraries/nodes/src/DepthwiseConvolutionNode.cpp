@@ -0,0 +1,251 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DepthwiseConvolutionNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "DepthwiseConvolutionNode.h"
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        using namespace ::ell::emitters;
+        using namespace ::ell::model;
+
+        // The number of output columns computed together, so each weight is loaded once for all of them
+        const int c_columnBlockSize = 4;
+
+        // Returns the memory offset of an entry, given its logical coordinates relative to the start of the active area
+        int GetMemoryOffset(const PortMemoryLayout& layout, int row, int column, int channel)
+        {
+            const auto& offset = layout.GetOffset();
+            const auto& increment = layout.GetCumulativeIncrement();
+            return (row + offset[0]) * increment[0] + (column + offset[1]) * increment[1] + (channel + offset[2]) * increment[2];
+        }
+    } // namespace
+
+    template <typename ValueType>
+    DepthwiseConvolutionNode<ValueType>::DepthwiseConvolutionNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    DepthwiseConvolutionNode<ValueType>::DepthwiseConvolutionNode(const model::OutputPort<ValueType>& input,
+                                                                  const model::PortMemoryLayout& inputMemoryLayout,
+                                                                  const model::PortMemoryLayout& outputMemoryLayout,
+                                                                  const ConstTensorReferenceType& filterWeights,
+                                                                  int stride) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, outputMemoryLayout),
+        _inputMemoryLayout(inputMemoryLayout),
+        _filterWeights(filterWeights),
+        _stride(stride)
+    {
+        VerifyLayouts();
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::VerifyLayouts() const
+    {
+        const auto outputLayout = GetOutputMemoryLayout();
+        if (!_inputMemoryLayout.IsCanonicalOrder() || !outputLayout.IsCanonicalOrder())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "DepthwiseConvolutionNode: memory layouts must be in canonical order");
+        }
+
+        const int filterSize = static_cast<int>(_filterWeights.NumColumns());
+        if (_inputMemoryLayout.GetOffset(0) != filterSize / 2 || _inputMemoryLayout.GetOffset(1) != filterSize / 2)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "DepthwiseConvolutionNode: input padding must be filterSize/2");
+        }
+
+        const int numChannels = _inputMemoryLayout.GetActiveSize(2);
+        if (_filterWeights.NumChannels() != 1 || static_cast<int>(_filterWeights.NumRows()) != numChannels * filterSize || outputLayout.GetActiveSize(2) != numChannels)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "DepthwiseConvolutionNode: there must be one filter per input channel");
+        }
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> DepthwiseConvolutionNode<ValueType>::GetChannelInterleavedWeights() const
+    {
+        const int filterSize = static_cast<int>(_filterWeights.NumColumns());
+        const int numChannels = _inputMemoryLayout.GetActiveSize(2);
+        std::vector<ValueType> result(filterSize * filterSize * numChannels);
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+            {
+                for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                {
+                    result[(windowRow * filterSize + windowColumn) * numChannels + channel] = _filterWeights(channel * filterSize + windowRow, windowColumn, 0);
+                }
+            }
+        }
+        return result;
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<DepthwiseConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _stride);
+        transformer.MapNodeOutput(this->output, newNode->output);
+    }
+
+    template <typename ValueType>
+    int64_t DepthwiseConvolutionNode<ValueType>::GetOperationCount() const
+    {
+        const int64_t numOutputs = GetOutputMemoryLayout().GetActiveSize().NumElements();
+        const int64_t filterSize = _filterWeights.NumColumns();
+        return 2 * numOutputs * filterSize * filterSize;
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::Compute() const
+    {
+        const auto inputLayout = GetInputMemoryLayout();
+        const auto outputLayout = GetOutputMemoryLayout();
+        const int filterSize = static_cast<int>(_filterWeights.NumColumns());
+        const int padding = filterSize / 2;
+        const auto input = _input.GetValue();
+        const auto weights = GetChannelInterleavedWeights();
+
+        std::vector<ValueType> output(outputLayout.GetMemorySize());
+        const int numChannels = outputLayout.GetActiveSize(2);
+        for (int row = 0; row < outputLayout.GetActiveSize(0); ++row)
+        {
+            for (int column = 0; column < outputLayout.GetActiveSize(1); ++column)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                {
+                    ValueType sum = 0;
+                    for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+                    {
+                        for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                        {
+                            auto inputValue = input[GetMemoryOffset(inputLayout, row * _stride + windowRow - padding, column * _stride + windowColumn - padding, channel)];
+                            sum += inputValue * weights[(windowRow * filterSize + windowColumn) * numChannels + channel];
+                        }
+                    }
+                    output[GetMemoryOffset(outputLayout, row, column, channel)] = sum;
+                }
+            }
+        }
+        _output.SetOutput(output);
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        auto defaultParallelizeValue = function.GetModule().GetCompilerOptions().parallelize;
+        auto parallelize = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("parallelize", defaultParallelizeValue);
+
+        auto options = function.GetCompilerOptions();
+        options.parallelize = parallelize;
+        function.SetCompilerOptions(options);
+
+        LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
+        LLVMValue pWeights = function.GetModule().ConstantArray(compiler.GetGlobalName(*this, "weights"), GetChannelInterleavedWeights());
+
+        const auto inputLayout = GetInputMemoryLayout();
+        const auto outputLayout = GetOutputMemoryLayout();
+        const int filterSize = static_cast<int>(_filterWeights.NumColumns());
+        const int stride = _stride;
+        const int numChannels = outputLayout.GetActiveSize(2);
+        const int outputColumns = outputLayout.GetActiveSize(1);
+        const int numColumnBlocks = outputColumns / c_columnBlockSize;
+        const int numRemainingColumns = outputColumns % c_columnBlockSize;
+
+        // The input is padded by filterSize/2, so the window of output (r, c) starts at padded input row r*stride and column c*stride
+        const int inputRowIncrement = inputLayout.GetCumulativeIncrement(0);
+        const int inputColumnIncrement = inputLayout.GetCumulativeIncrement(1);
+        const int inputChannelOffset = inputLayout.GetOffset(2);
+
+        function.ParallelFor(outputLayout.GetActiveSize(0), { pInput, pWeights, pOutput }, [=](IRFunctionEmitter& function, IRLocalScalar outputRow, const std::vector<LLVMValue>& capturedValues) {
+            auto input = capturedValues[0];
+            auto weights = capturedValues[1];
+            auto output = capturedValues[2];
+
+            // Computes `numColumns` adjacent output columns for all the channels, with a vectorizable loop over the channels
+            auto emitColumnBlock = [=](IRFunctionEmitter& function, IRLocalScalar firstColumn, int numColumns) {
+                function.For(numChannels, [=](IRFunctionEmitter& function, IRLocalScalar channel) {
+                    std::vector<IRLocalScalar> sums(numColumns, function.LocalScalar(ValueType{ 0 }));
+                    for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+                    {
+                        auto inputRowOffset = (outputRow * stride + windowRow) * inputRowIncrement + channel + inputChannelOffset;
+                        for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                        {
+                            auto weight = function.LocalScalar(function.ValueAt(weights, channel + (windowRow * filterSize + windowColumn) * numChannels));
+                            for (int column = 0; column < numColumns; ++column)
+                            {
+                                auto inputOffset = inputRowOffset + ((firstColumn + column) * stride + windowColumn) * inputColumnIncrement;
+                                sums[column] = sums[column] + function.LocalScalar(function.ValueAt(input, inputOffset)) * weight;
+                            }
+                        }
+                    }
+
+                    for (int column = 0; column < numColumns; ++column)
+                    {
+                        auto outputOffset = (outputRow + outputLayout.GetOffset(0)) * static_cast<int>(outputLayout.GetCumulativeIncrement(0)) +
+                                            (firstColumn + column + outputLayout.GetOffset(1)) * static_cast<int>(outputLayout.GetCumulativeIncrement(1)) +
+                                            channel + outputLayout.GetOffset(2);
+                        function.SetValueAt(output, outputOffset, sums[column]);
+                    }
+                });
+            };
+
+            if (numColumnBlocks > 0)
+            {
+                function.For(numColumnBlocks, [=](IRFunctionEmitter& function, IRLocalScalar block) {
+                    emitColumnBlock(function, block * c_columnBlockSize, c_columnBlockSize);
+                });
+            }
+            if (numRemainingColumns > 0)
+            {
+                emitColumnBlock(function, function.LocalScalar(numColumnBlocks * c_columnBlockSize), numRemainingColumns);
+            }
+        });
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        model::CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["inputLayout"] << _inputMemoryLayout;
+        archiver["outputLayout"] << GetOutputMemoryLayout();
+        archiver["stride"] << _stride;
+        math::TensorArchiver::Write(_filterWeights, "weights", archiver);
+    }
+
+    template <typename ValueType>
+    void DepthwiseConvolutionNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        model::CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["inputLayout"] >> _inputMemoryLayout;
+        model::PortMemoryLayout outputMemoryLayout;
+        archiver["outputLayout"] >> outputMemoryLayout;
+        _output.SetMemoryLayout(outputMemoryLayout);
+        archiver["stride"] >> _stride;
+        math::TensorArchiver::Read(_filterWeights, "weights", archiver);
+    }
+
+    // Explicit specializations
+    template class DepthwiseConvolutionNode<float>;
+    template class DepthwiseConvolutionNode<double>;
+} // namespace nodes
+} // namespace ell
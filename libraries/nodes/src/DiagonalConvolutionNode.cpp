@@ -203,6 +203,14 @@ namespace nodes
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
+    template <typename ValueType>
+    int64_t DiagonalConvolutionComputeNode<ValueType>::GetOperationCount() const
+    {
+        const int64_t numOutputs = GetOutputMemoryLayout().GetActiveSize().NumElements();
+        const int64_t numInputChannels = _inputMemoryLayout.GetLogicalDimensionActiveSize(2);
+        return 2 * numOutputs * _filterSize * _filterSize * numInputChannels;
+    }
+
     template <typename ValueType>
     void DiagonalConvolutionComputeNode<ValueType>::Compute() const
     {
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     EarlyExitNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "EarlyExitNode.h"
+
+#include <emitters/include/IRLocalScalar.h>
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace nodes
+{
+    template <typename ValueType>
+    EarlyExitNode<ValueType>::EarlyExitNode() :
+        CompilableNode({ &_earlyOutput, &_confidence, &_fullOutput }, { &_output }),
+        _earlyOutput(this, {}, earlyOutputPortName),
+        _confidence(this, {}, confidencePortName),
+        _fullOutput(this, {}, fullOutputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    EarlyExitNode<ValueType>::EarlyExitNode(const model::OutputPort<ValueType>& earlyOutput, const model::OutputPort<ValueType>& confidence, const model::OutputPort<ValueType>& fullOutput, ValueType threshold) :
+        CompilableNode({ &_earlyOutput, &_confidence, &_fullOutput }, { &_output }),
+        _earlyOutput(this, earlyOutput, earlyOutputPortName),
+        _confidence(this, confidence, confidencePortName),
+        _fullOutput(this, fullOutput, fullOutputPortName),
+        _output(this, defaultOutputPortName, earlyOutput.GetMemoryLayout()),
+        _threshold(threshold)
+    {
+        if (confidence.Size() != 1)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "EarlyExitNode: the confidence must be a single value");
+        }
+        if (earlyOutput.Size() != fullOutput.Size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "EarlyExitNode: the early and full outputs must be the same size");
+        }
+    }
+
+    template <typename ValueType>
+    void EarlyExitNode<ValueType>::Compute() const
+    {
+        _output.SetOutput(_confidence[0] >= _threshold ? _earlyOutput.GetValue() : _fullOutput.GetValue());
+    }
+
+    template <typename ValueType>
+    void EarlyExitNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        const auto size = static_cast<int>(output.Size());
+        emitters::LLVMValue pEarlyOutput = compiler.EnsurePortEmitted(earlyOutput);
+        emitters::LLVMValue pFullOutput = compiler.EnsurePortEmitted(fullOutput);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+        auto confidenceValue = function.LocalScalar(compiler.LoadPortElementVariable(confidence.GetInputElement(0)));
+
+        function.If(confidenceValue >= function.LocalScalar<ValueType>(_threshold), [pEarlyOutput, pOutput, size](emitters::IRFunctionEmitter& function) {
+                    function.MemoryCopy<ValueType>(pEarlyOutput, pOutput, size);
+                })
+            .Else([this, &compiler, pFullOutput, pOutput, size](emitters::IRFunctionEmitter& function) {
+                // Only this path computes the nodes the full output alone depends on
+                compiler.CallConditionalBranch(fullOutput, function);
+                function.MemoryCopy<ValueType>(pFullOutput, pOutput, size);
+            });
+    }
+
+    template <typename ValueType>
+    void EarlyExitNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newEarlyOutput = transformer.GetCorrespondingInputs(_earlyOutput);
+        const auto& newConfidence = transformer.GetCorrespondingInputs(_confidence);
+        const auto& newFullOutput = transformer.GetCorrespondingInputs(_fullOutput);
+        auto newNode = transformer.AddNode<EarlyExitNode<ValueType>>(newEarlyOutput, newConfidence, newFullOutput, _threshold);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void EarlyExitNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[earlyOutputPortName] << _earlyOutput;
+        archiver[confidencePortName] << _confidence;
+        archiver[fullOutputPortName] << _fullOutput;
+        archiver["threshold"] << _threshold;
+    }
+
+    template <typename ValueType>
+    void EarlyExitNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[earlyOutputPortName] >> _earlyOutput;
+        archiver[confidencePortName] >> _confidence;
+        archiver[fullOutputPortName] >> _fullOutput;
+        archiver["threshold"] >> _threshold;
+        _output.SetMemoryLayout(_earlyOutput.GetReferencedPort().GetMemoryLayout());
+    }
+
+    // Explicit instantiations
+    template class EarlyExitNode<float>;
+    template class EarlyExitNode<double>;
+} // namespace nodes
+} // namespace ell
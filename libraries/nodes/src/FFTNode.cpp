@@ -205,17 +205,17 @@ namespace nodes
         //
         // FFT-specific functions
         //
+        // The twiddle factors of the butterfly stage producing a transform of size `length`, as a constant table
         template <typename ValueType>
-        std::vector<std::complex<ValueType>> GetTwiddleFactors(size_t size)
+        emitters::LLVMValue GetTwiddleFactors(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, size_t length)
         {
-            // size == FFT length / 2
-            const auto pi = math::Constants<ValueType>::pi;
-            std::vector<std::complex<ValueType>> result(size);
-            for (size_t k = 0; k < size; ++k)
-            {
-                result[k] = std::exp(std::complex<ValueType>(0, pi * k / size));
-            }
-            return result;
+            auto& module = function.GetModule();
+            auto halfN = length / 2;
+            auto twiddleFactors = reinterpret_cast<const ValueType*>(plan.GetTwiddleFactors(length));
+            std::vector<ValueType> twiddleFactorsUnwrapped(twiddleFactors, twiddleFactors + 2 * halfN);
+            auto name = std::string("twiddles_") + utilities::GetTypeName<ValueType>() + "_" + std::to_string(halfN);
+            auto twiddleFactorsUnwrappedVar = module.ConstantArray(name, twiddleFactorsUnwrapped);
+            return function.CastPointer(twiddleFactorsUnwrappedVar, GetComplexType<ValueType>(module)->getPointerTo());
         }
 
         template <typename ValueType>
@@ -281,6 +281,38 @@ namespace nodes
             return function;
         }
 
+        //
+        // CMSIS-DSP
+        //
+
+        // Bytes reserved for an `arm_rfft_fast_instance_f32`, which is 24 bytes on 32-bit targets
+        const int c_cmsisRealFFTInstanceSize = 64;
+
+        // arm_rfft_fast_f32 only supports these sizes
+        inline bool IsCmsisRealFFTSize(size_t length)
+        {
+            return length >= 32 && length <= 4096 && (length & (length - 1)) == 0;
+        }
+
+        // Gets the CMSIS-DSP real FFT instance for a given size, which is initialized when the module is loaded
+        inline emitters::LLVMValue GetCmsisRealFFTInstance(emitters::IRFunctionEmitter& function, size_t length)
+        {
+            auto& module = function.GetModule();
+            auto name = "cmsis_rfft_f32_" + std::to_string(length);
+            llvm::GlobalVariable* instance = module.GetLLVMModule()->getGlobalVariable(name + "_instance");
+            if (instance == nullptr)
+            {
+                instance = module.GlobalArray(emitters::VariableType::Int64, name + "_instance", c_cmsisRealFFTInstanceSize / sizeof(int64_t));
+                auto initFunction = module.BeginFunction(name + "_init", emitters::VariableType::Void);
+                {
+                    auto instancePointer = initFunction.CastPointer(initFunction.PointerOffset(instance, 0), emitters::VariableType::Byte);
+                    initFunction.Call(module.GetRuntime().GetCmsisRealFFTInitFunction(), { instancePointer, initFunction.Literal<int>(static_cast<int>(length)) });
+                }
+                module.EndFunction();
+                module.AddInitializationFunction(initFunction);
+            }
+            return function.CastPointer(function.PointerOffset(instance, 0), emitters::VariableType::Byte);
+        }
     } // namespace detail
 
     template <typename ValueType>
@@ -288,7 +320,8 @@ namespace nodes
         CompilableNode({ &_input }, { &_output }),
         _input(this, {}, defaultInputPortName),
         _output(this, defaultOutputPortName, 0),
-        _fftSize(0)
+        _fftSize(0),
+        _plan(0)
     {
     }
 
@@ -297,11 +330,13 @@ namespace nodes
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, 0),
-        _fftSize(0)
+        _fftSize(0),
+        _plan(0)
     {
         double nearestPowerOf2Size = std::pow(2, std::ceil(std::log2(input.Size())));
         _fftSize = static_cast<size_t>(nearestPowerOf2Size);
         _output.SetSize(_fftSize / 2);
+        _plan = dsp::FFTPlan<ValueType>(_fftSize);
     }
 
     template <typename ValueType>
@@ -309,7 +344,8 @@ namespace nodes
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, fftSize / 2),
-        _fftSize(fftSize)
+        _fftSize(fftSize),
+        _plan(0)
     {
         if (fftSize == 0)
         {
@@ -320,6 +356,7 @@ namespace nodes
         {
             throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "fftSize must be a power of 2");
         }
+        _plan = dsp::FFTPlan<ValueType>(_fftSize);
     }
 
     inline void Deinterleave(emitters::IRFunctionEmitter& function, emitters::LLVMValue array, emitters::LLVMValue halfLength, emitters::LLVMValue scratch)
@@ -430,7 +467,7 @@ namespace nodes
 
     // Fixed-size FFT function implementation: size is known at compile time
     template <typename ValueType>
-    void FFTNode<ValueType>::EmitFFT(emitters::IRFunctionEmitter& function, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch)
+    void FFTNode<ValueType>::EmitFFT(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch)
     {
 #if (USE_FIXED_SMALL_FFT)
         if (length == 2)
@@ -444,12 +481,6 @@ namespace nodes
 #endif // USE_FIXED_SMALL_FFT
 
         // TODO: assert(bitcount(length) == 1)  (i.e., length is a power of 2)
-        auto& module = function.GetModule();
-        auto& emitter = module.GetIREmitter();
-        auto valueType = emitter.Type(emitters::GetVariableType<ValueType>());
-        auto complexType = detail::GetComplexType(module, valueType);
-        auto complexPtrType = complexType->getPointerTo();
-
         auto halfN = length / 2;
         assert(halfN >= 1);
 
@@ -459,17 +490,12 @@ namespace nodes
 
         if (halfN > 1) // call recursive case if necessary
         {
-            DoFFT(function, halfN, evens, scratch);
-            DoFFT(function, halfN, odds, scratch);
+            DoFFT(function, plan, halfN, evens, scratch);
+            DoFFT(function, plan, halfN, odds, scratch);
         }
 
 #if (USE_STORED_TWIDDLE_FACTORS)
-        auto twiddleFactors = detail::GetTwiddleFactors<ValueType>(halfN);
-        std::vector<ValueType> twiddleFactorsUnwrapped(twiddleFactors.size() * 2);
-        ValueType* dataPtr = reinterpret_cast<ValueType*>(twiddleFactors.data());
-        std::copy(dataPtr, dataPtr + twiddleFactorsUnwrapped.size(), twiddleFactorsUnwrapped.begin());
-        auto twiddleFactorsUnwrappedVar = module.ConstantArray(std::string("twiddles_") + std::to_string(halfN), twiddleFactorsUnwrapped); // TODO: encode type name in variable name
-        auto twiddleFactorsVar = function.CastPointer(twiddleFactorsUnwrappedVar, complexPtrType);
+        auto twiddleFactorsVar = detail::GetTwiddleFactors(function, plan, length);
 #else
         bool twiddleFactorsVar = false;
 #endif
@@ -494,7 +520,7 @@ namespace nodes
 
     // Fixed-size FFT function implementation: size is known at compile time
     template <typename ValueType>
-    emitters::LLVMFunction FFTNode<ValueType>::GetFFTFunction(emitters::IRModuleEmitter& module, size_t length)
+    emitters::LLVMFunction FFTNode<ValueType>::GetFFTFunction(emitters::IRModuleEmitter& module, const dsp::FFTPlan<ValueType>& plan, size_t length)
     {
 #if (USE_FIXED_SMALL_FFT)
         if (length == 2)
@@ -521,7 +547,7 @@ namespace nodes
             auto input = function.LocalScalar(&(*arguments++));
             auto scratch = function.LocalScalar(&(*arguments++));
 
-            EmitFFT(function, length, input, scratch);
+            EmitFFT(function, plan, length, input, scratch);
         }
         module.EndFunction();
         return function.GetFunction();
@@ -529,13 +555,9 @@ namespace nodes
 
     // Real-valued fixed-size FFT function implementation: size is known at compile time
     template <typename ValueType>
-    void FFTNode<ValueType>::EmitRealFFT(emitters::IRFunctionEmitter& function, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch, emitters::LLVMValue complexInput)
+    void FFTNode<ValueType>::EmitRealFFT(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch, emitters::LLVMValue complexInput)
     {
         // TODO: assert(bitcount(length) == 1)  (i.e., length is a power of 2)
-        auto& module = function.GetModule();
-        auto complexType = detail::GetComplexType<ValueType>(module);
-        auto complexPtrType = complexType->getPointerTo();
-
         auto halfN = length / 2;
         assert(halfN >= 1);
 
@@ -547,8 +569,8 @@ namespace nodes
 
         if (halfN > 1) // call recursive case if necessary
         {
-            DoRealFFT(function, halfN, evens, scratch, complexEvens);
-            DoRealFFT(function, halfN, odds, scratch, complexOdds);
+            DoRealFFT(function, plan, halfN, evens, scratch, complexEvens);
+            DoRealFFT(function, plan, halfN, odds, scratch, complexOdds);
         }
         else // here halfN == 1
         {
@@ -558,12 +580,7 @@ namespace nodes
         }
 
 #if (USE_STORED_TWIDDLE_FACTORS)
-        auto twiddleFactors = detail::GetTwiddleFactors<ValueType>(halfN);
-        std::vector<ValueType> twiddleFactorsUnwrapped(twiddleFactors.size() * 2);
-        ValueType* dataPtr = reinterpret_cast<ValueType*>(twiddleFactors.data());
-        std::copy(dataPtr, dataPtr + twiddleFactorsUnwrapped.size(), twiddleFactorsUnwrapped.begin());
-        auto twiddleFactorsUnwrappedVar = module.ConstantArray(std::string("twiddles_") + std::to_string(halfN), twiddleFactorsUnwrapped);
-        auto twiddleFactorsVar = function.CastPointer(twiddleFactorsUnwrappedVar, complexPtrType);
+        auto twiddleFactorsVar = detail::GetTwiddleFactors(function, plan, length);
 #else
         bool twiddleFactorsVar = false; // Just here to appease the compiler
 #endif
@@ -588,7 +605,7 @@ namespace nodes
 
     // Real-valued fixed-size FFT function implementation: size is known at compile time
     template <typename ValueType>
-    emitters::LLVMFunction FFTNode<ValueType>::GetRealFFTFunction(emitters::IRModuleEmitter& module, size_t length)
+    emitters::LLVMFunction FFTNode<ValueType>::GetRealFFTFunction(emitters::IRModuleEmitter& module, const dsp::FFTPlan<ValueType>& plan, size_t length)
     {
         auto functionName = detail::GetRealFFTFunctionName<ValueType>(length);
         auto existingFunction = module.GetFunction(functionName);
@@ -604,7 +621,7 @@ namespace nodes
             auto scratch = function.LocalScalar(&(*arguments++));
             auto complexInput = function.LocalScalar(&(*arguments++));
 
-            EmitRealFFT(function, length, input, scratch, complexInput);
+            EmitRealFFT(function, plan, length, input, scratch, complexInput);
         }
         module.EndFunction();
         return function.GetFunction();
@@ -612,38 +629,48 @@ namespace nodes
 
     // Perform fixed-size FFT: size is known at compile time
     template <typename ValueType>
-    void FFTNode<ValueType>::DoFFT(emitters::IRFunctionEmitter& function, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch)
+    void FFTNode<ValueType>::DoFFT(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch)
     {
         const bool inlineFFT = length <= MAX_INLINE_FFT_SIZE;
         if (inlineFFT)
         {
-            EmitFFT(function, length, input, scratch);
+            EmitFFT(function, plan, length, input, scratch);
         }
         else
         {
             auto& module = function.GetModule();
-            auto fftFunction = GetFFTFunction(module, length);
+            auto fftFunction = GetFFTFunction(module, plan, length);
             function.Call(fftFunction, { input, scratch });
         }
     }
 
     // Fixed-size FFT function implementation: size is known at compile time
     template <typename ValueType>
-    void FFTNode<ValueType>::DoRealFFT(emitters::IRFunctionEmitter& function, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch, emitters::LLVMValue complexInput)
+    void FFTNode<ValueType>::DoRealFFT(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, size_t length, emitters::LLVMValue input, emitters::LLVMValue scratch, emitters::LLVMValue complexInput)
     {
         const bool inlineFFT = length <= MAX_INLINE_FFT_SIZE;
         if (inlineFFT)
         {
-            EmitRealFFT(function, length, input, scratch, complexInput);
+            EmitRealFFT(function, plan, length, input, scratch, complexInput);
         }
         else
         {
             auto& module = function.GetModule();
-            auto fftFunction = GetRealFFTFunction(module, length);
+            auto fftFunction = GetRealFFTFunction(module, plan, length);
             function.Call(fftFunction, { input, scratch, complexInput });
         }
     }
 
+    template <typename ValueType>
+    void FFTNode<ValueType>::EmitInPlaceFFT(emitters::IRFunctionEmitter& function, const dsp::FFTPlan<ValueType>& plan, emitters::LLVMValue buffer)
+    {
+        auto& module = function.GetModule();
+        auto complexType = detail::GetComplexType<ValueType>(module);
+        auto complexBuffer = function.CastPointer(buffer, complexType->getPointerTo());
+        emitters::LLVMValue scratch = function.Variable(complexType, plan.Size() / 2);
+        DoFFT(function, plan, plan.Size(), complexBuffer, scratch);
+    }
+
     template <typename ValueType>
     void FFTNode<ValueType>::Compute() const
     {
@@ -652,7 +679,8 @@ namespace nodes
         {
             temp.resize(_fftSize);
         }
-        dsp::FFT(temp);
+        std::vector<std::complex<ValueType>> scratch;
+        dsp::FFT(_plan, temp, scratch);
         temp.resize(output.Size());
         _output.SetOutput(temp);
     };
@@ -676,6 +704,12 @@ namespace nodes
         auto inputSize = input.Size();
         auto outputSize = output.Size();
 
+        if (std::is_same<ValueType, float>::value && function.GetCompilerOptions().useCmsis && detail::IsCmsisRealFFTSize(_fftSize))
+        {
+            EmitCmsisRealFFT(compiler, function);
+            return;
+        }
+
         // Get port variables
         emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
         emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
@@ -692,7 +726,7 @@ namespace nodes
 #if (USE_REAL_FFT)
 
         emitters::LLVMValue scratch = function.Variable(valueType, _fftSize / 2);
-        DoRealFFT(function, _fftSize, pInput, scratch, complexBuffer);
+        DoRealFFT(function, _plan, _fftSize, pInput, scratch, complexBuffer);
 
 #else // Complex-input FFT
 
@@ -715,7 +749,7 @@ namespace nodes
             });
         }
 
-        DoFFT(function, _fftSize, complexBuffer, scratch);
+        DoFFT(function, _plan, _fftSize, complexBuffer, scratch);
 
 #endif // USE_REAL_FFT
 
@@ -726,6 +760,50 @@ namespace nodes
         });
     }
 
+    template <typename ValueType>
+    void FFTNode<ValueType>::EmitCmsisRealFFT(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        const int fftSize = static_cast<int>(_fftSize);
+        const int halfSize = fftSize / 2;
+        const int inputSize = std::min(static_cast<int>(input.Size()), fftSize);
+        const int outputSize = static_cast<int>(output.Size());
+
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+
+        // arm_rfft_fast_f32 overwrites its input, so it gets a zero-padded copy
+        emitters::LLVMValue buffer = function.Variable(emitters::GetVariableType<ValueType>(), fftSize);
+        emitters::LLVMValue spectrum = function.Variable(emitters::GetVariableType<ValueType>(), fftSize);
+        function.MemoryCopy<ValueType>(pInput, buffer, inputSize);
+        if (fftSize > inputSize)
+        {
+            function.MemorySet<ValueType>(buffer, inputSize, function.Literal<uint8_t>(0), fftSize - inputSize);
+        }
+        function.Call(function.GetModule().GetRuntime().GetCmsisRealFFTFunction(), { detail::GetCmsisRealFFTInstance(function, _fftSize), buffer, spectrum, function.Literal<int>(0) });
+
+        // The spectrum is packed as X(0), X(n/2), re(X(1)), im(X(1)), ..., re(X(n/2 - 1)), im(X(n/2 - 1)), and the bins past
+        // n/2 are the complex conjugates of the ones before
+        auto setMagnitude = [spectrum, pOutput](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index, emitters::IRLocalScalar bin) {
+            auto re = function.LocalScalar(function.ValueAt(spectrum, bin * 2));
+            auto im = function.LocalScalar(function.ValueAt(spectrum, bin * 2 + 1));
+            function.SetValueAt(pOutput, index, emitters::Sqrt(re * re + im * im));
+        };
+        if (outputSize > 0)
+        {
+            function.SetValueAt(pOutput, 0, emitters::Abs(function.LocalScalar(function.ValueAt(spectrum, 0))));
+        }
+        function.For(1, std::min(outputSize, halfSize), [setMagnitude](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+            setMagnitude(function, index, index);
+        });
+        if (outputSize > halfSize)
+        {
+            function.SetValueAt(pOutput, halfSize, emitters::Abs(function.LocalScalar(function.ValueAt(spectrum, 1))));
+        }
+        function.For(halfSize + 1, outputSize, [setMagnitude, fftSize](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+            setMagnitude(function, index, fftSize - index);
+        });
+    }
+
     template <typename ValueType>
     void FFTNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
     {
@@ -748,6 +826,7 @@ namespace nodes
             _fftSize = _input.Size();
         }
         _output.SetSize(_fftSize / 2);
+        _plan = dsp::FFTPlan<ValueType>(_fftSize);
     }
 
     // Explicit instantiations
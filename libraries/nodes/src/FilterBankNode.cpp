@@ -53,56 +53,49 @@ namespace nodes
         auto& module = function.GetModule();
         auto numFilters = output.Size();
 
-        // Write out global variables with bin info
+        // Write out global variables with the nonzero coefficients of all the filters, end to end, and the input bin
+        // and coefficient range of each filter
         std::vector<int> startBins;
-        std::vector<int> centerBins;
-        std::vector<int> endBins;
+        std::vector<int> coefficientBegins;
+        std::vector<int> coefficientEnds;
+        std::vector<ValueType> coefficients;
         for (size_t filterIndex = _filters.GetBeginFilter(); filterIndex < _filters.GetEndFilter(); ++filterIndex)
         {
-            auto f = _filters.GetFilter(filterIndex);
-            startBins.push_back(f.GetStart());
-            centerBins.push_back(f.GetCenter());
-            endBins.push_back(f.GetEnd());
+            const auto& filterCoefficients = _filters.GetFilterCoefficients(filterIndex);
+            startBins.push_back(static_cast<int>(_filters.GetFilter(filterIndex).GetStart()));
+            coefficientBegins.push_back(static_cast<int>(coefficients.size()));
+            coefficients.insert(coefficients.end(), filterCoefficients.begin(), filterCoefficients.end());
+            coefficientEnds.push_back(static_cast<int>(coefficients.size()));
         }
         if (numFilters != startBins.size())
         {
             throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Input sizes must match");
         }
-        auto beginVar = module.ConstantArray("filterStart_"s + GetInternalStateIdentifier(), startBins);
-        auto centerVar = module.ConstantArray("filterCenter_"s + GetInternalStateIdentifier(), centerBins);
-        auto endVar = module.ConstantArray("filterEnd_"s + GetInternalStateIdentifier(), endBins);
+        if (coefficients.empty())
+        {
+            coefficients.push_back(0); // avoid an empty global; no filter reads it
+        }
+        auto startVar = module.ConstantArray("filterStart_"s + GetInternalStateIdentifier(), startBins);
+        auto beginVar = module.ConstantArray("filterCoefficientBegin_"s + GetInternalStateIdentifier(), coefficientBegins);
+        auto endVar = module.ConstantArray("filterCoefficientEnd_"s + GetInternalStateIdentifier(), coefficientEnds);
+        auto coefficientsVar = module.ConstantArray("filterCoefficients_"s + GetInternalStateIdentifier(), coefficients);
 
-        auto offset = function.LocalScalar<ValueType>(_filters.GetOffset());
-        
         // Get port variables
         emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
         emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
 
-        function.For(numFilters, [pInput, pOutput, offset, beginVar, centerVar, endVar](emitters::IRFunctionEmitter& function, auto filterIndex) {
+        function.For(numFilters, [pInput, pOutput, startVar, beginVar, endVar, coefficientsVar](emitters::IRFunctionEmitter& function, auto filterIndex) {
             auto sum = function.Variable(emitters::GetVariableType<ValueType>());
+            auto start = function.LocalScalar(function.ValueAt(startVar, filterIndex));
             auto begin = function.LocalScalar(function.ValueAt(beginVar, filterIndex));
-            auto center = function.LocalScalar(function.ValueAt(centerVar, filterIndex));
             auto end = function.LocalScalar(function.ValueAt(endVar, filterIndex));
             function.StoreZero(sum);
 
-            // for index in [begin, center)
-            function.For(begin, center, [pInput, offset, sum, begin, center](emitters::IRFunctionEmitter& function, auto index) {
-                // sum += signal[i] * ((i-begin+0.5) / (center-begin))
-                auto inputVal = function.LocalScalar(function.ValueAt(pInput, index));
-                auto numer = index - begin;
-                auto denom = center - begin;
-                auto val = inputVal * ((function.LocalScalar(function.CastValue<ValueType>(numer)) + offset) / function.LocalScalar(function.CastValue<ValueType>(denom)));
-                function.Store(sum, function.LocalScalar(function.Load(sum)) + val);
-            });
-
-            // for index in [center, end)
-            function.For(center, end, [pInput, offset, sum, center, end](emitters::IRFunctionEmitter& function, auto index) {
-                // sum += signal[i] * ((end-i-0.5) / (end-center))
-                auto inputVal = function.LocalScalar(function.ValueAt(pInput, index));
-                auto numer = end - index;
-                auto denom = end - center;
-                auto val = inputVal * ((function.LocalScalar(function.CastValue<ValueType>(numer)) - offset) / function.LocalScalar(function.CastValue<ValueType>(denom)));
-                function.Store(sum, function.LocalScalar(function.Load(sum)) + val);
+            // for index in [begin, end): sum += signal[start + index - begin] * coefficients[index]
+            function.For(begin, end, [pInput, coefficientsVar, sum, start, begin](emitters::IRFunctionEmitter& function, auto index) {
+                auto inputVal = function.LocalScalar(function.ValueAt(pInput, start + (index - begin)));
+                auto coefficient = function.LocalScalar(function.ValueAt(coefficientsVar, index));
+                function.Store(sum, function.LocalScalar(function.Load(sum)) + inputVal * coefficient);
             });
 
             function.SetValueAt(pOutput, filterIndex, function.Load(sum));
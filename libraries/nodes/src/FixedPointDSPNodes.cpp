@@ -0,0 +1,774 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FixedPointDSPNodes.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FixedPointDSPNodes.h"
+
+#include <dsp/include/DCT.h>
+
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRLocalScalar.h>
+#include <emitters/include/IRMath.h>
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        using emitters::IRFunctionEmitter;
+        using emitters::IRLocalScalar;
+        using emitters::LLVMValue;
+
+        //
+        // Emitting the fixed-point operations of dsp/FixedPoint.h. The conversions do the same double-precision
+        // operations as the dsp functions, and the integer operations are exact, so the results match `Compute`.
+        //
+
+        IRLocalScalar Widen(IRFunctionEmitter& function, LLVMValue value)
+        {
+            return function.LocalScalar(function.CastValue<int64_t>(value));
+        }
+
+        IRLocalScalar EmitToFixedPoint(IRFunctionEmitter& function, IRLocalScalar value, const dsp::FixedPointFormat& format)
+        {
+            const auto maxValue = static_cast<double>(format.MaxValue());
+            auto scaled = function.LocalScalar(function.CastValue<double>(value)) * std::ldexp(1.0, format.fractionalBits);
+            auto rounding = function.LocalScalar(function.Select(scaled < 0.0, function.Literal(-0.5), function.Literal(0.5)));
+            auto clamped = emitters::Min(emitters::Max(scaled + rounding, -maxValue), maxValue);
+            return function.LocalScalar(function.CastValue<int32_t>(function.CastValue<int64_t>(clamped)));
+        }
+
+        // Converts `size` values of an array to a new array of fixed-point values
+        LLVMValue EmitToFixedPoint(IRFunctionEmitter& function, LLVMValue input, int size, const dsp::FixedPointFormat& format)
+        {
+            auto result = function.Variable(emitters::VariableType::Int32, std::max(size, 1));
+            function.For(size, [input, result, format](IRFunctionEmitter& function, auto index) {
+                function.SetValueAt(result, index, EmitToFixedPoint(function, function.LocalScalar(function.ValueAt(input, index)), format));
+            });
+            return result;
+        }
+
+        template <typename ValueType>
+        IRLocalScalar EmitFromFixedPoint(IRFunctionEmitter& function, IRLocalScalar value, int fractionalBits)
+        {
+            auto scaled = function.LocalScalar(function.CastValue<double>(value)) * std::ldexp(1.0, -fractionalBits);
+            return function.LocalScalar(function.CastValue<ValueType>(scaled));
+        }
+
+        IRLocalScalar EmitRoundingShiftRight(IRFunctionEmitter& function, IRLocalScalar value, int shift)
+        {
+            if (shift <= 0)
+            {
+                return value * (int64_t{ 1 } << -shift);
+            }
+            auto rounded = value + (int64_t{ 1 } << (shift - 1));
+            return function.LocalScalar(function.Operator(emitters::TypedOperator::arithmeticShiftRight, rounded, function.Literal<int64_t>(shift)));
+        }
+
+        IRLocalScalar EmitSaturate(IRFunctionEmitter& function, IRLocalScalar value, int wordBits)
+        {
+            const auto maxValue = (int64_t{ 1 } << (wordBits - 1)) - 1;
+            return function.LocalScalar(function.CastValue<int32_t>(emitters::Min(emitters::Max(value, -maxValue), maxValue)));
+        }
+
+        IRLocalScalar EmitIntegerSquareRoot(IRFunctionEmitter& function, IRLocalScalar value)
+        {
+            auto remainderVar = function.Variable(emitters::VariableType::Int64, "remainder");
+            auto rootVar = function.Variable(emitters::VariableType::Int64, "root");
+            function.Store(remainderVar, value);
+            function.StoreZero(rootVar);
+
+            // The bit-by-bit method, with selects instead of branches
+            function.For(32, [remainderVar, rootVar](IRFunctionEmitter& function, auto index) {
+                auto bitIndex = int64_t{ 62 } - Widen(function, index) * int64_t{ 2 };
+                auto bit = function.LocalScalar<int64_t>(1) << bitIndex;
+                auto remainder = function.LocalScalar(function.Load(remainderVar));
+                auto root = function.LocalScalar(function.Load(rootVar));
+                auto trial = root + bit;
+                auto halfRoot = function.LocalScalar(function.Operator(emitters::TypedOperator::arithmeticShiftRight, root, function.Literal<int64_t>(1)));
+                auto isLarger = remainder >= trial;
+                function.Store(remainderVar, function.Select(isLarger, remainder - trial, remainder));
+                function.Store(rootVar, function.Select(isLarger, halfRoot + bit, halfRoot));
+            });
+            return function.LocalScalar(function.Load(rootVar));
+        }
+
+        //
+        // Filters given as ranges of coefficients applied to ranges of the input, shared by the filter bank and DCT nodes
+        //
+
+        template <typename ValueType>
+        std::vector<ValueType> ComputeFixedPointFilters(const std::vector<ValueType>& input, const std::vector<int>& filterStarts, const std::vector<int>& filterSizes, const dsp::FixedPointCoefficients& coefficients, const dsp::FixedPointFormat& format)
+        {
+            auto fixedInput = dsp::ToFixedPoint(input, format);
+            std::vector<ValueType> result;
+            size_t offset = 0;
+            for (size_t filterIndex = 0; filterIndex < filterStarts.size(); ++filterIndex)
+            {
+                auto sum = dsp::FixedPointDotProduct(fixedInput.data() + filterStarts[filterIndex], coefficients.values.data() + offset, filterSizes[filterIndex]);
+                result.push_back(dsp::FromFixedPoint<ValueType>(sum, format.fractionalBits + coefficients.fractionalBits));
+                offset += filterSizes[filterIndex];
+            }
+            return result;
+        }
+
+        template <typename ValueType>
+        void EmitFixedPointFilters(IRFunctionEmitter& function, const std::string& name, LLVMValue pInput, int inputSize, LLVMValue pOutput, const std::vector<int>& filterStarts, const std::vector<int>& filterSizes, const dsp::FixedPointCoefficients& coefficients, const dsp::FixedPointFormat& format)
+        {
+            using namespace std::string_literals;
+
+            auto& module = function.GetModule();
+            std::vector<int> begins;
+            std::vector<int> ends;
+            int offset = 0;
+            for (auto size : filterSizes)
+            {
+                begins.push_back(offset);
+                offset += size;
+                ends.push_back(offset);
+            }
+            auto coefficientValues = coefficients.values;
+            if (coefficientValues.empty())
+            {
+                coefficientValues.push_back(0); // avoid an empty global; no filter reads it
+            }
+            auto startVar = module.ConstantArray(name + "Start"s, filterStarts);
+            auto beginVar = module.ConstantArray(name + "CoefficientBegin"s, begins);
+            auto endVar = module.ConstantArray(name + "CoefficientEnd"s, ends);
+            auto coefficientsVar = module.ConstantArray(name + "Coefficients"s, coefficientValues);
+
+            auto fixedInput = EmitToFixedPoint(function, pInput, inputSize, format);
+            const auto fractionalBits = format.fractionalBits + coefficients.fractionalBits;
+            function.For(static_cast<int>(filterStarts.size()), [=](IRFunctionEmitter& function, auto filterIndex) {
+                auto sum = function.Variable(emitters::VariableType::Int64, "sum");
+                auto start = function.LocalScalar(function.ValueAt(startVar, filterIndex));
+                auto begin = function.LocalScalar(function.ValueAt(beginVar, filterIndex));
+                auto end = function.LocalScalar(function.ValueAt(endVar, filterIndex));
+                function.StoreZero(sum);
+
+                // for index in [begin, end): sum += input[start + index - begin] * coefficients[index], in 64 bits
+                function.For(begin, end, [fixedInput, coefficientsVar, sum, start, begin](IRFunctionEmitter& function, auto index) {
+                    auto inputValue = Widen(function, function.ValueAt(fixedInput, start + (index - begin)));
+                    auto coefficient = Widen(function, function.ValueAt(coefficientsVar, index));
+                    function.Store(sum, function.LocalScalar(function.Load(sum)) + inputValue * coefficient);
+                });
+
+                function.SetValueAt(pOutput, filterIndex, EmitFromFixedPoint<ValueType>(function, function.LocalScalar(function.Load(sum)), fractionalBits));
+            });
+        }
+
+        // Returns the coefficients in reverse order, twice: [b0, b1, b2] is returned as [b2, b1, b0, b2, b1, b0]
+        std::vector<int32_t> GetRingBufferCoefficients(const std::vector<int32_t>& coefficients)
+        {
+            std::vector<int32_t> result;
+            result.reserve(coefficients.size() * 2);
+            std::reverse_copy(coefficients.begin(), coefficients.end(), std::back_inserter(result));
+            std::reverse_copy(coefficients.begin(), coefficients.end(), std::back_inserter(result));
+            return result;
+        }
+
+        template <typename ArchiverType>
+        void ArchiveFormat(ArchiverType& archiver, const dsp::FixedPointFormat& format)
+        {
+            archiver["wordBits"] << format.wordBits;
+            archiver["fractionalBits"] << format.fractionalBits;
+        }
+
+        template <typename UnarchiverType>
+        dsp::FixedPointFormat UnarchiveFormat(UnarchiverType& archiver)
+        {
+            dsp::FixedPointFormat format;
+            archiver["wordBits"] >> format.wordBits;
+            archiver["fractionalBits"] >> format.fractionalBits;
+            return format;
+        }
+    } // namespace
+
+    //
+    // FixedPointWindowNode
+    //
+    template <typename ValueType>
+    FixedPointWindowNode<ValueType>::FixedPointWindowNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    FixedPointWindowNode<ValueType>::FixedPointWindowNode(const model::OutputPort<ValueType>& input, const std::vector<ValueType>& window, const dsp::FixedPointFormat& format) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, input.Size()),
+        _window(window),
+        _format(format),
+        _coefficients(dsp::QuantizeCoefficients(window, format.CoefficientBits()))
+    {
+        if (window.size() != input.Size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "Window size must match the input size");
+        }
+    }
+
+    template <typename ValueType>
+    void FixedPointWindowNode<ValueType>::Compute() const
+    {
+        auto input = dsp::ToFixedPoint(_input.GetValue(), _format);
+        std::vector<ValueType> result(input.size());
+        for (size_t index = 0; index < input.size(); ++index)
+        {
+            result[index] = dsp::FromFixedPoint<ValueType>(static_cast<int64_t>(input[index]) * _coefficients.values[index], _format.fractionalBits + _coefficients.fractionalBits);
+        }
+        _output.SetOutput(result);
+    }
+
+    template <typename ValueType>
+    void FixedPointWindowNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        using namespace std::string_literals;
+
+        auto& module = function.GetModule();
+        auto coefficientsVar = module.ConstantArray("windowCoefficients_"s + GetInternalStateIdentifier(), _coefficients.values);
+        LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+
+        const auto format = _format;
+        const auto fractionalBits = _format.fractionalBits + _coefficients.fractionalBits;
+        function.For(static_cast<int>(input.Size()), [pInput, pOutput, coefficientsVar, format, fractionalBits](IRFunctionEmitter& function, auto index) {
+            auto value = Widen(function, EmitToFixedPoint(function, function.LocalScalar(function.ValueAt(pInput, index)), format));
+            auto coefficient = Widen(function, function.ValueAt(coefficientsVar, index));
+            function.SetValueAt(pOutput, index, EmitFromFixedPoint<ValueType>(function, value * coefficient, fractionalBits));
+        });
+    }
+
+    template <typename ValueType>
+    void FixedPointWindowNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInputs = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<FixedPointWindowNode<ValueType>>(newInputs, _window, _format);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void FixedPointWindowNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["window"] << _window;
+        ArchiveFormat(archiver, _format);
+    }
+
+    template <typename ValueType>
+    void FixedPointWindowNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["window"] >> _window;
+        _format = UnarchiveFormat(archiver);
+        _coefficients = dsp::QuantizeCoefficients(_window, _format.CoefficientBits());
+        _output.SetSize(_input.Size());
+    }
+
+    //
+    // FixedPointFilterBankNode
+    //
+    template <typename ValueType>
+    FixedPointFilterBankNode<ValueType>::FixedPointFilterBankNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    FixedPointFilterBankNode<ValueType>::FixedPointFilterBankNode(const model::OutputPort<ValueType>& input, const dsp::TriangleFilterBank& filters, const dsp::FixedPointFormat& format) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0),
+        _format(format)
+    {
+        for (size_t filterIndex = filters.GetBeginFilter(); filterIndex < filters.GetEndFilter(); ++filterIndex)
+        {
+            const auto& filterCoefficients = filters.GetFilterCoefficients(filterIndex);
+            _filterStarts.push_back(static_cast<int>(filters.GetFilter(filterIndex).GetStart()));
+            _filterSizes.push_back(static_cast<int>(filterCoefficients.size()));
+            _filterCoefficients.insert(_filterCoefficients.end(), filterCoefficients.begin(), filterCoefficients.end());
+        }
+        Initialize();
+    }
+
+    template <typename ValueType>
+    FixedPointFilterBankNode<ValueType>::FixedPointFilterBankNode(const model::OutputPort<ValueType>& input, const std::vector<int>& filterStarts, const std::vector<int>& filterSizes, const std::vector<double>& coefficients, const dsp::FixedPointFormat& format) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0),
+        _filterStarts(filterStarts),
+        _filterSizes(filterSizes),
+        _filterCoefficients(coefficients),
+        _format(format)
+    {
+        Initialize();
+    }
+
+    template <typename ValueType>
+    void FixedPointFilterBankNode<ValueType>::Initialize()
+    {
+        size_t numCoefficients = 0;
+        for (size_t filterIndex = 0; filterIndex < _filterStarts.size(); ++filterIndex)
+        {
+            if (_filterStarts[filterIndex] < 0 || _filterSizes[filterIndex] < 0 || static_cast<size_t>(_filterStarts[filterIndex] + _filterSizes[filterIndex]) > _input.Size())
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "Filter extends past the end of the input");
+            }
+            numCoefficients += _filterSizes[filterIndex];
+        }
+        if (_filterSizes.size() != _filterStarts.size() || numCoefficients != _filterCoefficients.size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "Filter sizes don't match the coefficients");
+        }
+
+        _coefficients = dsp::QuantizeCoefficients(_filterCoefficients, _format.CoefficientBits());
+        _output.SetSize(_filterStarts.size());
+    }
+
+    template <typename ValueType>
+    void FixedPointFilterBankNode<ValueType>::Compute() const
+    {
+        _output.SetOutput(ComputeFixedPointFilters(_input.GetValue(), _filterStarts, _filterSizes, _coefficients, _format));
+    }
+
+    template <typename ValueType>
+    void FixedPointFilterBankNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+        EmitFixedPointFilters<ValueType>(function, "filterBank_" + GetInternalStateIdentifier(), pInput, static_cast<int>(input.Size()), pOutput, _filterStarts, _filterSizes, _coefficients, _format);
+    }
+
+    template <typename ValueType>
+    void FixedPointFilterBankNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInputs = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<FixedPointFilterBankNode<ValueType>>(newInputs, _filterStarts, _filterSizes, _filterCoefficients, _format);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void FixedPointFilterBankNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["filterStarts"] << _filterStarts;
+        archiver["filterSizes"] << _filterSizes;
+        archiver["coefficients"] << _filterCoefficients;
+        ArchiveFormat(archiver, _format);
+    }
+
+    template <typename ValueType>
+    void FixedPointFilterBankNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["filterStarts"] >> _filterStarts;
+        archiver["filterSizes"] >> _filterSizes;
+        archiver["coefficients"] >> _filterCoefficients;
+        _format = UnarchiveFormat(archiver);
+        Initialize();
+    }
+
+    //
+    // FixedPointIIRFilterNode
+    //
+    template <typename ValueType>
+    FixedPointIIRFilterNode<ValueType>::FixedPointIIRFilterNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0),
+        _filter(std::vector<ValueType>{}, std::vector<ValueType>{}, _format)
+    {
+    }
+
+    template <typename ValueType>
+    FixedPointIIRFilterNode<ValueType>::FixedPointIIRFilterNode(const model::OutputPort<ValueType>& input, const std::vector<ValueType>& b, const std::vector<ValueType>& a, const dsp::FixedPointFormat& format) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, input.Size()),
+        _b(b),
+        _a(a),
+        _format(format),
+        _filter(b, a, format)
+    {
+    }
+
+    template <typename ValueType>
+    void FixedPointIIRFilterNode<ValueType>::Compute() const
+    {
+        auto input = _input.GetValue();
+        std::vector<ValueType> result(input.size());
+        for (size_t index = 0; index < input.size(); ++index)
+        {
+            auto y = _filter.FilterSample(dsp::ToFixedPoint(input[index], _format));
+            result[index] = dsp::FromFixedPoint<ValueType>(y, _format.fractionalBits);
+        }
+        _output.SetOutput(result);
+    }
+
+    template <typename ValueType>
+    void FixedPointIIRFilterNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        using namespace std::string_literals;
+
+        auto& module = function.GetModule();
+        const auto inputSize = static_cast<int>(input.Size());
+        const auto bSize = static_cast<int>(_b.size());
+        const auto aSize = static_cast<int>(_a.size());
+        const auto format = _format;
+        const auto coefficientFractionalBits = _filter.GetCoefficientFractionalBits();
+
+        LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+        if (bSize == 0)
+        {
+            function.For(inputSize, [pOutput](IRFunctionEmitter& function, auto index) {
+                function.SetValueAt(pOutput, index, function.Literal<ValueType>(0));
+            });
+            return;
+        }
+
+        // Ring buffers of the previous inputs and outputs, as in IIRFilterNode
+        llvm::GlobalVariable* prevInput = module.GlobalArray("prevInput_"s + GetInternalStateIdentifier(), std::vector<int>(bSize, 0));
+        llvm::GlobalVariable* prevOutput = module.GlobalArray("prevOutput_"s + GetInternalStateIdentifier(), std::vector<int>(std::max(aSize, 1), 0));
+        llvm::GlobalVariable* bCoeffs = module.ConstantArray("bCoeffs_"s + GetInternalStateIdentifier(), GetRingBufferCoefficients(_filter.GetFeedforwardCoefficients()));
+        llvm::GlobalVariable* aCoeffs = aSize > 0 ? module.ConstantArray("aCoeffs_"s + GetInternalStateIdentifier(), GetRingBufferCoefficients(_filter.GetRecursiveCoefficients())) : nullptr;
+        llvm::GlobalVariable* xIndexVar = module.Global<int>("xIndex_"s + GetInternalStateIdentifier(), 0);
+        llvm::GlobalVariable* yIndexVar = module.Global<int>("yIndex_"s + GetInternalStateIdentifier(), 0);
+
+        auto sumVar = function.Variable(emitters::VariableType::Int64, "sum");
+        function.For(inputSize, [=](IRFunctionEmitter& function, auto inputIndex) {
+            auto x = EmitToFixedPoint(function, function.LocalScalar(function.ValueAt(pInput, inputIndex)), format);
+            function.StoreZero(sumVar);
+
+            auto xIndex = function.LocalScalar(function.Load(xIndexVar));
+            function.SetValueAt(prevInput, xIndex, x);
+            auto bOffset = function.LocalScalar(bSize - 1) - xIndex;
+            function.For(bSize, [prevInput, bCoeffs, bOffset, sumVar](IRFunctionEmitter& function, auto i) {
+                auto xValue = Widen(function, function.ValueAt(prevInput, i));
+                auto bValue = Widen(function, function.ValueAt(bCoeffs, bOffset + i));
+                function.Store(sumVar, function.LocalScalar(function.Load(sumVar)) + xValue * bValue);
+            });
+
+            auto yIndex = function.LocalScalar(function.Load(yIndexVar));
+            if (aSize > 0)
+            {
+                auto aOffset = function.LocalScalar(aSize) - yIndex;
+                function.For(aSize, [prevOutput, aCoeffs, aOffset, sumVar](IRFunctionEmitter& function, auto j) {
+                    auto yValue = Widen(function, function.ValueAt(prevOutput, j));
+                    auto aValue = Widen(function, function.ValueAt(aCoeffs, aOffset + j));
+                    function.Store(sumVar, function.LocalScalar(function.Load(sumVar)) - yValue * aValue);
+                });
+            }
+
+            // Round and saturate the output to the data format before feeding it back
+            auto y = EmitSaturate(function, EmitRoundingShiftRight(function, function.LocalScalar(function.Load(sumVar)), coefficientFractionalBits), format.wordBits);
+            if (aSize > 0)
+            {
+                function.SetValueAt(prevOutput, yIndex, y);
+                function.Store(yIndexVar, function.Operator(emitters::TypedOperator::moduloSigned, yIndex + function.LocalScalar(1), function.LocalScalar(aSize)));
+            }
+            function.SetValueAt(pOutput, inputIndex, EmitFromFixedPoint<ValueType>(function, Widen(function, y), format.fractionalBits));
+            function.Store(xIndexVar, function.Operator(emitters::TypedOperator::moduloSigned, xIndex + function.LocalScalar(1), function.LocalScalar(bSize)));
+        });
+    }
+
+    template <typename ValueType>
+    void FixedPointIIRFilterNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInputs = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<FixedPointIIRFilterNode<ValueType>>(newInputs, _b, _a, _format);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void FixedPointIIRFilterNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["b"] << _b;
+        archiver["a"] << _a;
+        ArchiveFormat(archiver, _format);
+    }
+
+    template <typename ValueType>
+    void FixedPointIIRFilterNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["b"] >> _b;
+        archiver["a"] >> _a;
+        _format = UnarchiveFormat(archiver);
+        _filter = dsp::FixedPointIIRFilter(_b, _a, _format);
+        _output.SetSize(_input.Size());
+    }
+
+    //
+    // FixedPointDCTNode
+    //
+    template <typename ValueType>
+    FixedPointDCTNode<ValueType>::FixedPointDCTNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    FixedPointDCTNode<ValueType>::FixedPointDCTNode(const model::OutputPort<ValueType>& input, size_t numFilters, const dsp::FixedPointFormat& format) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, numFilters),
+        _format(format)
+    {
+        Initialize();
+    }
+
+    template <typename ValueType>
+    void FixedPointDCTNode<ValueType>::Initialize()
+    {
+        const auto windowSize = _input.Size();
+        const auto numFilters = _output.Size();
+        auto dctMatrix = dsp::GetDCTMatrix<double>(windowSize, numFilters);
+        std::vector<double> matrix;
+        matrix.reserve(windowSize * numFilters);
+        for (size_t row = 0; row < numFilters; ++row)
+        {
+            for (size_t column = 0; column < windowSize; ++column)
+            {
+                matrix.push_back(dctMatrix(row, column));
+            }
+        }
+        _coefficients = dsp::QuantizeCoefficients(matrix, _format.CoefficientBits());
+    }
+
+    template <typename ValueType>
+    void FixedPointDCTNode<ValueType>::Compute() const
+    {
+        const auto numFilters = output.Size();
+        std::vector<int> filterStarts(numFilters, 0);
+        std::vector<int> filterSizes(numFilters, static_cast<int>(input.Size()));
+        _output.SetOutput(ComputeFixedPointFilters(_input.GetValue(), filterStarts, filterSizes, _coefficients, _format));
+    }
+
+    template <typename ValueType>
+    void FixedPointDCTNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        const auto numFilters = output.Size();
+        std::vector<int> filterStarts(numFilters, 0);
+        std::vector<int> filterSizes(numFilters, static_cast<int>(input.Size()));
+        LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+        EmitFixedPointFilters<ValueType>(function, "dct_" + GetInternalStateIdentifier(), pInput, static_cast<int>(input.Size()), pOutput, filterStarts, filterSizes, _coefficients, _format);
+    }
+
+    template <typename ValueType>
+    void FixedPointDCTNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInputs = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<FixedPointDCTNode<ValueType>>(newInputs, output.Size(), _format);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void FixedPointDCTNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["numFilters"] << output.Size();
+        ArchiveFormat(archiver, _format);
+    }
+
+    template <typename ValueType>
+    void FixedPointDCTNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        size_t numFilters = 0;
+        archiver["numFilters"] >> numFilters;
+        _format = UnarchiveFormat(archiver);
+        _output.SetSize(numFilters);
+        Initialize();
+    }
+
+    //
+    // FixedPointFFTNode
+    //
+    template <typename ValueType>
+    FixedPointFFTNode<ValueType>::FixedPointFFTNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0),
+        _fftSize(0),
+        _plan(0, _format.wordBits)
+    {
+    }
+
+    template <typename ValueType>
+    FixedPointFFTNode<ValueType>::FixedPointFFTNode(const model::OutputPort<ValueType>& input, size_t fftSize, const dsp::FixedPointFormat& format) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, fftSize / 2),
+        _fftSize(fftSize),
+        _format(format),
+        _plan(fftSize, format.wordBits)
+    {
+    }
+
+    template <typename ValueType>
+    void FixedPointFFTNode<ValueType>::Compute() const
+    {
+        _output.SetOutput(_plan.TransformMagnitudes<ValueType>(dsp::ToFixedPoint(_input.GetValue(), _format), _format.fractionalBits));
+    }
+
+    template <typename ValueType>
+    void FixedPointFFTNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        using namespace std::string_literals;
+
+        auto& module = function.GetModule();
+        const auto fftSize = static_cast<int>(_fftSize);
+        const auto inputSize = std::min(static_cast<int>(input.Size()), fftSize);
+        const auto wordBits = _format.wordBits;
+        const auto format = _format;
+
+        auto twiddleReal = _plan.GetRealTwiddleFactors();
+        auto twiddleImag = _plan.GetImaginaryTwiddleFactors();
+        if (twiddleReal.empty())
+        {
+            twiddleReal.push_back(0); // avoid an empty global; a size-1 FFT has no butterflies
+            twiddleImag.push_back(0);
+        }
+        auto bitReversalVar = module.ConstantArray("fftBitReversal_"s + GetInternalStateIdentifier(), _plan.GetBitReversalPermutation());
+        auto twiddleRealVar = module.ConstantArray("fftTwiddleReal_"s + GetInternalStateIdentifier(), twiddleReal);
+        auto twiddleImagVar = module.ConstantArray("fftTwiddleImag_"s + GetInternalStateIdentifier(), twiddleImag);
+
+        LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+
+        // Load the input in bit-reversed order, zero-padded to the FFT size
+        auto real = function.Variable(emitters::VariableType::Int32, fftSize);
+        auto imag = function.Variable(emitters::VariableType::Int32, fftSize);
+        function.StoreZero(real, fftSize);
+        function.StoreZero(imag, fftSize);
+        function.For(inputSize, [pInput, real, bitReversalVar, format](IRFunctionEmitter& function, auto index) {
+            auto value = EmitToFixedPoint(function, function.LocalScalar(function.ValueAt(pInput, index)), format);
+            function.SetValueAt(real, function.LocalScalar(function.ValueAt(bitReversalVar, index)), value);
+        });
+
+        auto exponentVar = function.Variable(emitters::VariableType::Int32, "exponent");
+        auto maxVar = function.Variable(emitters::VariableType::Int32, "maxMagnitude");
+        function.StoreZero(exponentVar);
+        for (int halfLength = 1; halfLength < fftSize; halfLength *= 2)
+        {
+            // Scale the block down so that it's below 2^(wordBits-3)
+            function.StoreZero(maxVar);
+            function.For(fftSize, [real, imag, maxVar](IRFunctionEmitter& function, auto index) {
+                auto realValue = function.LocalScalar(function.ValueAt(real, index));
+                auto imagValue = function.LocalScalar(function.ValueAt(imag, index));
+                auto realMagnitude = function.LocalScalar(function.Select(realValue < 0, -realValue, realValue));
+                auto imagMagnitude = function.LocalScalar(function.Select(imagValue < 0, -imagValue, imagValue));
+                function.Store(maxVar, emitters::Max(emitters::Max(function.LocalScalar(function.Load(maxVar)), realMagnitude), imagMagnitude));
+            });
+            auto maxMagnitude = function.LocalScalar(function.Load(maxVar));
+            auto shift = function.LocalScalar(function.Select(maxMagnitude >= (1 << (wordBits - 3)), function.Literal(1), function.Literal(0))) +
+                         function.LocalScalar(function.Select(maxMagnitude >= (1 << (wordBits - 2)), function.Literal(1), function.Literal(0)));
+            function.For(fftSize, [real, imag, shift](IRFunctionEmitter& function, auto index) {
+                function.SetValueAt(real, index, function.Operator(emitters::TypedOperator::arithmeticShiftRight, function.ValueAt(real, index), shift));
+                function.SetValueAt(imag, index, function.Operator(emitters::TypedOperator::arithmeticShiftRight, function.ValueAt(imag, index), shift));
+            });
+            function.Store(exponentVar, function.LocalScalar(function.Load(exponentVar)) + shift);
+
+            // The butterflies
+            function.For(fftSize / (2 * halfLength), [=](IRFunctionEmitter& function, auto block) {
+                function.For(halfLength, [=](IRFunctionEmitter& function, auto k) {
+                    auto top = block * (2 * halfLength) + k;
+                    auto bottom = top + halfLength;
+                    auto wReal = Widen(function, function.ValueAt(twiddleRealVar, k + (halfLength - 1)));
+                    auto wImag = Widen(function, function.ValueAt(twiddleImagVar, k + (halfLength - 1)));
+                    auto bReal = Widen(function, function.ValueAt(real, bottom));
+                    auto bImag = Widen(function, function.ValueAt(imag, bottom));
+                    auto tReal = function.LocalScalar(function.CastValue<int32_t>(EmitRoundingShiftRight(function, wReal * bReal - wImag * bImag, wordBits - 1)));
+                    auto tImag = function.LocalScalar(function.CastValue<int32_t>(EmitRoundingShiftRight(function, wReal * bImag + wImag * bReal, wordBits - 1)));
+                    auto aReal = function.LocalScalar(function.ValueAt(real, top));
+                    auto aImag = function.LocalScalar(function.ValueAt(imag, top));
+                    function.SetValueAt(real, bottom, aReal - tReal);
+                    function.SetValueAt(imag, bottom, aImag - tImag);
+                    function.SetValueAt(real, top, aReal + tReal);
+                    function.SetValueAt(imag, top, aImag + tImag);
+                });
+            });
+        }
+
+        // The magnitudes, scaled by the block exponent
+        auto blockScale = function.LocalScalar(function.CastValue<double>(function.LocalScalar<int64_t>(1) << Widen(function, function.Load(exponentVar))));
+        const auto scale = std::ldexp(1.0, -_format.fractionalBits);
+        function.For(static_cast<int>(output.Size()), [real, imag, pOutput, blockScale, scale](IRFunctionEmitter& function, auto index) {
+            auto realValue = Widen(function, function.ValueAt(real, index));
+            auto imagValue = Widen(function, function.ValueAt(imag, index));
+            auto magnitude = EmitIntegerSquareRoot(function, realValue * realValue + imagValue * imagValue);
+            auto value = function.LocalScalar(function.CastValue<double>(magnitude)) * blockScale * scale;
+            function.SetValueAt(pOutput, index, function.CastValue<ValueType>(value));
+        });
+    }
+
+    template <typename ValueType>
+    void FixedPointFFTNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInputs = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<FixedPointFFTNode<ValueType>>(newInputs, _fftSize, _format);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void FixedPointFFTNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["fftSize"] << _fftSize;
+        ArchiveFormat(archiver, _format);
+    }
+
+    template <typename ValueType>
+    void FixedPointFFTNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["fftSize"] >> _fftSize;
+        _format = UnarchiveFormat(archiver);
+        _plan = dsp::FixedPointFFTPlan(_fftSize, _format.wordBits);
+        _output.SetSize(_fftSize / 2);
+    }
+
+    //
+    // Explicit instantiation definitions
+    //
+    template class FixedPointWindowNode<float>;
+    template class FixedPointWindowNode<double>;
+    template class FixedPointFilterBankNode<float>;
+    template class FixedPointFilterBankNode<double>;
+    template class FixedPointIIRFilterNode<float>;
+    template class FixedPointIIRFilterNode<double>;
+    template class FixedPointDCTNode<float>;
+    template class FixedPointDCTNode<double>;
+    template class FixedPointFFTNode<float>;
+    template class FixedPointFFTNode<double>;
+} // namespace nodes
+} // namespace ell
@@ -0,0 +1,284 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FlatForestPredictorNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FlatForestPredictorNode.h"
+
+#include <emitters/include/EmitterTypes.h>
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <queue>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        using namespace ::ell::emitters;
+
+        // The compiled code walks this many trees at once, to overlap the latency of their memory accesses
+        const int c_treesPerGroup = 4;
+
+        struct FlatForestGlobals
+        {
+            llvm::GlobalVariable* featureIndices;
+            llvm::GlobalVariable* thresholds;
+            llvm::GlobalVariable* children;
+            llvm::GlobalVariable* leafValues;
+            llvm::GlobalVariable* treeRoots;
+        };
+
+        // Walks `numTrees` trees, starting at `firstTree`, for `depth` levels, and adds their outputs to `sum`
+        void EmitTreeGroup(IRFunctionEmitter& function, const FlatForestGlobals& forest, const std::vector<LLVMValue>& nodes, LLVMValue pInput, LLVMValue pTreeOutputs, LLVMValue sum, IRLocalScalar firstTree, LLVMValue depth, int numTrees)
+        {
+            for (int tree = 0; tree < numTrees; ++tree)
+            {
+                function.Store(nodes[tree], function.ValueAt(forest.treeRoots, firstTree + tree));
+            }
+
+            function.For(depth, [forest, nodes, pInput, numTrees](IRFunctionEmitter& function, IRLocalScalar) {
+                // The comparison selects the child by index, so the loop body has no data-dependent branches
+                for (int tree = 0; tree < numTrees; ++tree)
+                {
+                    auto node = function.LocalScalar(function.Load(nodes[tree]));
+                    auto feature = function.LocalScalar(function.ValueAt(pInput, function.ValueAt(forest.featureIndices, node)));
+                    auto isGreater = feature > function.LocalScalar(function.ValueAt(forest.thresholds, node));
+                    auto childPosition = function.LocalScalar(function.Select(isGreater, function.Literal<int>(1), function.Literal<int>(0)));
+                    function.Store(nodes[tree], function.ValueAt(forest.children, node * 2 + childPosition));
+                }
+            });
+
+            // Accumulate the tree outputs in order, so the result matches Compute exactly
+            for (int tree = 0; tree < numTrees; ++tree)
+            {
+                auto treeOutput = function.LocalScalar(function.ValueAt(forest.leafValues, function.Load(nodes[tree])));
+                function.SetValueAt(pTreeOutputs, firstTree + tree, treeOutput);
+                function.Store(sum, function.LocalScalar(function.Load(sum)) + treeOutput);
+            }
+        }
+
+        // Prefetches the root nodes of the group after the one starting at `firstTree`. The node arrays are walked by following
+        // child indices, so there's no fixed stride to prefetch along, but the next group's roots are known in advance.
+        void EmitPrefetchNextGroup(IRFunctionEmitter& function, const FlatForestGlobals& forest, IRLocalScalar firstTree, int numTrees)
+        {
+            if (function.GetPrefetchDistance() <= 0)
+            {
+                return;
+            }
+
+            auto lastTree = function.LocalScalar(numTrees - 1);
+            for (int tree = 0; tree < c_treesPerGroup; ++tree)
+            {
+                auto nextTree = firstTree + (c_treesPerGroup + tree);
+                auto clampedTree = function.LocalScalar(function.Select(nextTree < lastTree, nextTree, lastTree));
+                auto root = function.LocalScalar(function.ValueAt(forest.treeRoots, clampedTree));
+                function.Prefetch(function.PointerOffset(forest.featureIndices, root));
+                function.Prefetch(function.PointerOffset(forest.thresholds, root));
+                function.Prefetch(function.PointerOffset(forest.children, root * 2));
+            }
+        }
+    } // namespace
+
+    FlatForest FlattenForest(const predictors::SimpleForestPredictor& forest)
+    {
+        FlatForest result;
+        result.bias = forest.GetBias();
+
+        auto addNode = [&result](int featureIndex, double threshold, double leafValue) {
+            auto index = static_cast<int>(result.featureIndices.size());
+            result.featureIndices.push_back(featureIndex);
+            result.thresholds.push_back(threshold);
+            result.children.insert(result.children.end(), { index, index });
+            result.leafValues.push_back(leafValue);
+            return index;
+        };
+
+        // Laying out each tree breadth-first keeps the levels near the root, which every input visits, together
+        struct PendingNode
+        {
+            size_t interiorNodeIndex;
+            int flatIndex;
+            double pathValue;
+            int depth;
+        };
+
+        const auto& interiorNodes = forest.GetInteriorNodes();
+        for (auto rootIndex : forest.GetRootIndices())
+        {
+            const auto& rootRule = interiorNodes[rootIndex].GetSplitRule();
+            auto root = addNode(static_cast<int>(rootRule.GetElementIndex()), rootRule.GetThreshold(), 0);
+            result.treeRoots.push_back(root);
+
+            std::queue<PendingNode> pending;
+            pending.push({ rootIndex, root, 0, 1 });
+            int treeDepth = 0;
+            while (!pending.empty())
+            {
+                auto node = pending.front();
+                pending.pop();
+                treeDepth = std::max(treeDepth, node.depth);
+
+                const auto& edges = interiorNodes[node.interiorNodeIndex].GetOutgoingEdges();
+                if (edges.size() != 2)
+                {
+                    throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FlattenForest: interior nodes must have two outgoing edges");
+                }
+
+                for (int position = 0; position < 2; ++position)
+                {
+                    const auto& edge = edges[position];
+                    auto pathValue = node.pathValue + edge.GetPredictor().GetValue();
+                    int child = 0;
+                    if (edge.IsTargetInterior())
+                    {
+                        const auto& rule = interiorNodes[edge.GetTargetNodeIndex()].GetSplitRule();
+                        child = addNode(static_cast<int>(rule.GetElementIndex()), rule.GetThreshold(), 0);
+                        pending.push({ edge.GetTargetNodeIndex(), child, pathValue, node.depth + 1 });
+                    }
+                    else
+                    {
+                        child = addNode(0, 0, pathValue);
+                    }
+                    result.children[2 * node.flatIndex + position] = child;
+                }
+            }
+            result.treeDepths.push_back(treeDepth);
+        }
+        return result;
+    }
+
+    FlatForestPredictorNode::FlatForestPredictorNode() :
+        CompilableNode({ &_input }, { &_output, &_treeOutputs }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 1),
+        _treeOutputs(this, treeOutputsPortName, 0)
+    {
+    }
+
+    FlatForestPredictorNode::FlatForestPredictorNode(const model::OutputPort<double>& input, const predictors::SimpleForestPredictor& forest) :
+        FlatForestPredictorNode(input, FlattenForest(forest))
+    {
+    }
+
+    FlatForestPredictorNode::FlatForestPredictorNode(const model::OutputPort<double>& input, const FlatForest& forest) :
+        CompilableNode({ &_input }, { &_output, &_treeOutputs }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, 1),
+        _treeOutputs(this, treeOutputsPortName, forest.treeRoots.size()),
+        _forest(forest)
+    {
+    }
+
+    void FlatForestPredictorNode::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInputs = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<FlatForestPredictorNode>(newInputs, _forest);
+        transformer.MapNodeOutput(output, newNode->output);
+        transformer.MapNodeOutput(treeOutputs, newNode->treeOutputs);
+    }
+
+    void FlatForestPredictorNode::Compute() const
+    {
+        const auto inputValues = _input.GetValue();
+        std::vector<double> treeOutputs(NumTrees());
+        double output = _forest.bias;
+        for (size_t tree = 0; tree < NumTrees(); ++tree)
+        {
+            auto node = _forest.treeRoots[tree];
+            for (int level = 0; level < _forest.treeDepths[tree]; ++level)
+            {
+                auto childPosition = inputValues[_forest.featureIndices[node]] > _forest.thresholds[node] ? 1 : 0;
+                node = _forest.children[2 * node + childPosition];
+            }
+            treeOutputs[tree] = _forest.leafValues[node];
+            output += treeOutputs[tree];
+        }
+        _output.SetOutput({ output });
+        _treeOutputs.SetOutput(treeOutputs);
+    }
+
+    void FlatForestPredictorNode::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+        LLVMValue pTreeOutputs = compiler.EnsurePortEmitted(treeOutputs);
+
+        const int numTrees = static_cast<int>(NumTrees());
+        const int numGroups = numTrees / c_treesPerGroup;
+        const int numRemainingTrees = numTrees % c_treesPerGroup;
+
+        // All the trees in a group take as many steps as the deepest one, which is harmless because leaves point to themselves
+        std::vector<int> groupDepths((numTrees + c_treesPerGroup - 1) / c_treesPerGroup, 0);
+        for (int tree = 0; tree < numTrees; ++tree)
+        {
+            auto& depth = groupDepths[tree / c_treesPerGroup];
+            depth = std::max(depth, _forest.treeDepths[tree]);
+        }
+
+        auto& module = function.GetModule();
+        FlatForestGlobals forest;
+        forest.featureIndices = module.ConstantArray(compiler.GetGlobalName(*this, "featureIndices"), _forest.featureIndices);
+        forest.thresholds = module.ConstantArray(compiler.GetGlobalName(*this, "thresholds"), _forest.thresholds);
+        forest.children = module.ConstantArray(compiler.GetGlobalName(*this, "children"), _forest.children);
+        forest.leafValues = module.ConstantArray(compiler.GetGlobalName(*this, "leafValues"), _forest.leafValues);
+        forest.treeRoots = module.ConstantArray(compiler.GetGlobalName(*this, "treeRoots"), _forest.treeRoots);
+        auto groupDepthsGlobal = module.ConstantArray(compiler.GetGlobalName(*this, "groupDepths"), groupDepths);
+
+        std::vector<LLVMValue> nodes;
+        for (int tree = 0; tree < c_treesPerGroup; ++tree)
+        {
+            nodes.push_back(function.Variable(VariableType::Int32, "node"));
+        }
+        auto sum = function.Variable(VariableType::Double, "sum");
+        function.Store(sum, function.Literal(_forest.bias));
+
+        if (numGroups > 0)
+        {
+            function.For(numGroups, [=](IRFunctionEmitter& function, IRLocalScalar group) {
+                EmitPrefetchNextGroup(function, forest, group * c_treesPerGroup, numTrees);
+                EmitTreeGroup(function, forest, nodes, pInput, pTreeOutputs, sum, group * c_treesPerGroup, function.ValueAt(groupDepthsGlobal, group), c_treesPerGroup);
+            });
+        }
+        if (numRemainingTrees > 0)
+        {
+            EmitTreeGroup(function, forest, nodes, pInput, pTreeOutputs, sum, function.LocalScalar(numGroups * c_treesPerGroup), function.ValueAt(groupDepthsGlobal, numGroups), numRemainingTrees);
+        }
+
+        function.SetValueAt(pOutput, 0, function.Load(sum));
+    }
+
+    void FlatForestPredictorNode::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["featureIndices"] << _forest.featureIndices;
+        archiver["thresholds"] << _forest.thresholds;
+        archiver["children"] << _forest.children;
+        archiver["leafValues"] << _forest.leafValues;
+        archiver["treeRoots"] << _forest.treeRoots;
+        archiver["treeDepths"] << _forest.treeDepths;
+        archiver["bias"] << _forest.bias;
+    }
+
+    void FlatForestPredictorNode::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["featureIndices"] >> _forest.featureIndices;
+        archiver["thresholds"] >> _forest.thresholds;
+        archiver["children"] >> _forest.children;
+        archiver["leafValues"] >> _forest.leafValues;
+        archiver["treeRoots"] >> _forest.treeRoots;
+        archiver["treeDepths"] >> _forest.treeDepths;
+        archiver["bias"] >> _forest.bias;
+        _treeOutputs.SetSize(NumTrees());
+    }
+} // namespace nodes
+} // namespace ell
@@ -0,0 +1,496 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FusedElementwiseNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FusedElementwiseNode.h"
+#include "ActivationFunctions.h"
+#include "BinaryOperationNode.h"
+
+#include <emitters/include/EmitterTypes.h>
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        std::string ToString(FusedElementwiseOperationType type)
+        {
+            switch (type)
+            {
+            case FusedElementwiseOperationType::unaryFunction:
+                return "unaryFunction";
+            case FusedElementwiseOperationType::linearFunction:
+                return "linearFunction";
+            case FusedElementwiseOperationType::binaryOperation:
+                return "binaryOperation";
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "Unknown fused elementwise operation type");
+            }
+        }
+
+        FusedElementwiseOperationType FusedOperationTypeFromString(const std::string& name)
+        {
+            if (name == "unaryFunction")
+            {
+                return FusedElementwiseOperationType::unaryFunction;
+            }
+            if (name == "linearFunction")
+            {
+                return FusedElementwiseOperationType::linearFunction;
+            }
+            if (name == "binaryOperation")
+            {
+                return FusedElementwiseOperationType::binaryOperation;
+            }
+            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "Unknown fused elementwise operation type " + name);
+        }
+
+        // Unary functions are stored by type name so they can be recreated when the node is read from an archive
+        template <typename ValueType>
+        std::string GetUnaryFunctionName(const BroadcastUnaryFunctionType<ValueType>& function)
+        {
+            if (dynamic_cast<const HardSigmoidActivationFunction<ValueType>*>(&function) != nullptr)
+            {
+                return HardSigmoidActivationFunction<ValueType>::GetTypeName();
+            }
+            if (dynamic_cast<const LeakyReLUActivationFunction<ValueType>*>(&function) != nullptr)
+            {
+                return LeakyReLUActivationFunction<ValueType>::GetTypeName();
+            }
+            if (dynamic_cast<const ReLUActivationFunction<ValueType>*>(&function) != nullptr)
+            {
+                return ReLUActivationFunction<ValueType>::GetTypeName();
+            }
+            if (dynamic_cast<const SigmoidActivationFunction<ValueType>*>(&function) != nullptr)
+            {
+                return SigmoidActivationFunction<ValueType>::GetTypeName();
+            }
+            if (dynamic_cast<const TanhActivationFunction<ValueType>*>(&function) != nullptr)
+            {
+                return TanhActivationFunction<ValueType>::GetTypeName();
+            }
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode: unsupported unary function");
+        }
+
+        template <typename ValueType>
+        std::shared_ptr<const BroadcastUnaryFunctionType<ValueType>> MakeUnaryFunction(const std::string& name, ValueType leakyFactor)
+        {
+            if (name == HardSigmoidActivationFunction<ValueType>::GetTypeName())
+            {
+                return std::make_shared<HardSigmoidActivationFunction<ValueType>>();
+            }
+            if (name == LeakyReLUActivationFunction<ValueType>::GetTypeName())
+            {
+                return std::make_shared<LeakyReLUActivationFunction<ValueType>>(leakyFactor);
+            }
+            if (name == ReLUActivationFunction<ValueType>::GetTypeName())
+            {
+                return std::make_shared<ReLUActivationFunction<ValueType>>();
+            }
+            if (name == SigmoidActivationFunction<ValueType>::GetTypeName())
+            {
+                return std::make_shared<SigmoidActivationFunction<ValueType>>();
+            }
+            if (name == TanhActivationFunction<ValueType>::GetTypeName())
+            {
+                return std::make_shared<TanhActivationFunction<ValueType>>();
+            }
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode: unsupported unary function " + name);
+        }
+
+        template <typename ValueType>
+        ValueType ComputeBinaryOperation(BinaryOperationType operation, ValueType a, ValueType b)
+        {
+            switch (operation)
+            {
+            case BinaryOperationType::add:
+                return BinaryOperations::Add(a, b);
+            case BinaryOperationType::subtract:
+                return BinaryOperations::Subtract(a, b);
+            case BinaryOperationType::multiply:
+                return BinaryOperations::Multiply(a, b);
+            case BinaryOperationType::divide:
+                return BinaryOperations::Divide(a, b);
+            case BinaryOperationType::logicalAnd:
+                return BinaryOperations::LogicalAnd(a, b);
+            case BinaryOperationType::logicalOr:
+                return BinaryOperations::LogicalOr(a, b);
+            case BinaryOperationType::logicalXor:
+                return BinaryOperations::LogicalXor(a, b);
+            default:
+                throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "Unknown operation type");
+            }
+        }
+    } // namespace
+
+    template <typename ValueType>
+    FusedElementwiseNode<ValueType>::FusedElementwiseNode() :
+        CompilableNode({}, { &_output }),
+        _output(this, defaultOutputPortName, 0),
+        _paddingValue(0)
+    {
+    }
+
+    template <typename ValueType>
+    FusedElementwiseNode<ValueType>::FusedElementwiseNode(const std::vector<const model::OutputPort<ValueType>*>& inputs,
+                                                          const std::vector<model::PortMemoryLayout>& inputLayouts,
+                                                          const std::vector<FusedElementwiseOperation<ValueType>>& operations,
+                                                          const model::PortMemoryLayout& outputLayout,
+                                                          ValueType padding) :
+        CompilableNode({}, { &_output }),
+        _inputLayouts(inputLayouts),
+        _output(this, defaultOutputPortName, outputLayout),
+        _operations(operations),
+        _paddingValue(padding)
+    {
+        for (auto input : inputs)
+        {
+            AddInput(*input);
+        }
+        VerifyInputs();
+    }
+
+    template <typename ValueType>
+    void FusedElementwiseNode<ValueType>::AddInput(const model::OutputPort<ValueType>& input)
+    {
+        auto portName = std::string("input_") + std::to_string(_inputPorts.size());
+        _inputPorts.emplace_back(std::make_unique<model::InputPort<ValueType>>(this, input, portName));
+        AddInputPort(_inputPorts.back().get());
+    }
+
+    template <typename ValueType>
+    void FusedElementwiseNode<ValueType>::VerifyInputs() const
+    {
+        const int numInputs = static_cast<int>(_inputPorts.size());
+        if (numInputs == 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode must have a primary input");
+        }
+
+        if (_inputLayouts.size() != _inputPorts.size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode needs exactly one memory layout per input");
+        }
+
+        if (_operations.empty())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode must have at least one operation");
+        }
+
+        const auto outputLayout = GetOutputMemoryLayout();
+        const auto& activeSize = outputLayout.GetActiveSize();
+        auto verifyInputIndex = [numInputs](int index) {
+            if (index < 0 || index >= numInputs)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "FusedElementwiseNode operation refers to a nonexistent input");
+            }
+        };
+        auto verifyFullSizeInput = [this, &activeSize, &verifyInputIndex](int index) {
+            verifyInputIndex(index);
+            const auto& layout = _inputLayouts[index];
+            if (layout.GetActiveSize() != activeSize)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode: input and output active areas must match");
+            }
+            if (_inputPorts[index]->Size() < layout.GetMemorySize())
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode: input too small");
+            }
+        };
+
+        verifyFullSizeInput(0);
+        for (const auto& operation : _operations)
+        {
+            switch (operation.type)
+            {
+            case FusedElementwiseOperationType::unaryFunction:
+                if (!operation.function)
+                {
+                    throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode: missing unary function");
+                }
+                break;
+            case FusedElementwiseOperationType::linearFunction:
+                if (operation.broadcastDimension < 0 || operation.broadcastDimension >= outputLayout.NumDimensions())
+                {
+                    throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "FusedElementwiseNode: invalid broadcast dimension");
+                }
+                for (auto index : { operation.scaleInput, operation.biasInput })
+                {
+                    if (index == -1)
+                    {
+                        continue;
+                    }
+                    verifyInputIndex(index);
+                    if (static_cast<int>(_inputPorts[index]->Size()) != activeSize[operation.broadcastDimension])
+                    {
+                        throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode: broadcast vector size doesn't match input");
+                    }
+                }
+                break;
+            case FusedElementwiseOperationType::binaryOperation:
+                verifyFullSizeInput(operation.otherInput);
+                break;
+            default:
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "FusedElementwiseNode: unknown operation type");
+            }
+        }
+    }
+
+    template <typename ValueType>
+    void FusedElementwiseNode<ValueType>::ComputeDimensionLoop(int dimension, std::vector<int>& coordinates, const std::vector<std::vector<ValueType>>& inputValues, std::vector<ValueType>& output) const
+    {
+        const auto outputLayout = GetOutputMemoryLayout();
+        for (int index = 0; index < outputLayout.GetActiveSize(dimension); ++index)
+        {
+            coordinates[dimension] = index;
+            if (dimension < outputLayout.NumDimensions() - 1)
+            {
+                ComputeDimensionLoop(dimension + 1, coordinates, inputValues, output);
+                continue;
+            }
+
+            // We're in the innermost loop --- run the whole chain of operations on this entry
+            auto value = inputValues[0][_inputLayouts[0].GetEntryOffset(coordinates)];
+            for (const auto& operation : _operations)
+            {
+                switch (operation.type)
+                {
+                case FusedElementwiseOperationType::unaryFunction:
+                    value = operation.function->Compute(value);
+                    break;
+                case FusedElementwiseOperationType::linearFunction:
+                {
+                    auto broadcastIndex = coordinates[operation.broadcastDimension];
+                    auto scale = operation.scaleInput == -1 ? static_cast<ValueType>(1) : inputValues[operation.scaleInput][broadcastIndex];
+                    auto bias = operation.biasInput == -1 ? static_cast<ValueType>(0) : inputValues[operation.biasInput][broadcastIndex];
+                    value = scale * value + bias;
+                    break;
+                }
+                case FusedElementwiseOperationType::binaryOperation:
+                {
+                    auto other = inputValues[operation.otherInput][_inputLayouts[operation.otherInput].GetEntryOffset(coordinates)];
+                    value = operation.isLeftOperand ? ComputeBinaryOperation(operation.operation, value, other) : ComputeBinaryOperation(operation.operation, other, value);
+                    break;
+                }
+                }
+            }
+            output[outputLayout.GetEntryOffset(coordinates)] = value;
+        }
+    }
+
+    template <typename ValueType>
+    void FusedElementwiseNode<ValueType>::Compute() const
+    {
+        std::vector<std::vector<ValueType>> inputValues;
+        for (const auto& input : _inputPorts)
+        {
+            inputValues.push_back(input->GetValue());
+        }
+
+        const auto outputLayout = GetOutputMemoryLayout();
+        std::vector<ValueType> output(outputLayout.GetMemorySize(), _paddingValue);
+        std::vector<int> coordinates(outputLayout.NumDimensions());
+        ComputeDimensionLoop(0, coordinates, inputValues, output);
+        _output.SetOutput(output);
+    }
+
+    template <typename ValueType>
+    void FusedElementwiseNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        std::vector<emitters::LLVMValue> inputs;
+        for (const auto& input : _inputPorts)
+        {
+            inputs.push_back(compiler.EnsurePortEmitted(*input));
+        }
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(_output, _paddingValue);
+
+        const auto outputLayout = GetOutputMemoryLayout();
+        std::vector<emitters::IRFunctionEmitter::ConstLoopRange> ranges;
+        for (int dimensionIndex = 0; dimensionIndex < outputLayout.NumDimensions(); ++dimensionIndex)
+        {
+            ranges.push_back({ 0, outputLayout.GetActiveSize(dimensionIndex) });
+        }
+
+        // A single loop nest computes the whole chain, so intermediate values stay in registers
+        auto body = [inputs, pOutput, outputLayout, this](emitters::IRFunctionEmitter& function, std::vector<emitters::IRLocalScalar> indices) {
+            emitters::LLVMValue value = function.ValueAt(inputs[0], model::EmitGetEntryOffset(function, indices, _inputLayouts[0]));
+            for (const auto& operation : _operations)
+            {
+                switch (operation.type)
+                {
+                case FusedElementwiseOperationType::unaryFunction:
+                    value = operation.function->Compile(function, value);
+                    break;
+                case FusedElementwiseOperationType::linearFunction:
+                {
+                    if (operation.scaleInput == -1 && operation.biasInput == -1)
+                    {
+                        break;
+                    }
+                    auto broadcastIndex = indices[operation.broadcastDimension];
+                    emitters::LLVMValue scale = operation.scaleInput == -1 ? nullptr : function.ValueAt(inputs[operation.scaleInput], broadcastIndex);
+                    emitters::LLVMValue bias = operation.biasInput == -1 ? nullptr : function.ValueAt(inputs[operation.biasInput], broadcastIndex);
+                    value = BroadcastLinearFunctionType<ValueType>{}.Compile(function, value, scale, bias);
+                    break;
+                }
+                case FusedElementwiseOperationType::binaryOperation:
+                {
+                    auto other = function.ValueAt(inputs[operation.otherInput], model::EmitGetEntryOffset(function, indices, _inputLayouts[operation.otherInput]));
+                    auto op = emitters::GetOperator<ValueType>(ToEmitterType(operation.operation));
+                    value = operation.isLeftOperand ? function.Operator(op, value, other) : function.Operator(op, other, value);
+                    break;
+                }
+                }
+            }
+            function.SetValueAt(pOutput, model::EmitGetEntryOffset(function, indices, outputLayout), value);
+        };
+
+        if (auto extent = compiler.GetDynamicExtent(_output, function))
+        {
+            // Only compute the first `extent` entries along the outermost dimension
+            std::vector<emitters::IRFunctionEmitter::LoopRange> dynamicRanges;
+            for (const auto& range : ranges)
+            {
+                dynamicRanges.push_back({ function.LocalScalar(range.begin), function.LocalScalar(range.end) });
+            }
+            dynamicRanges[0].end = function.LocalScalar(extent);
+            function.For(dynamicRanges, body);
+        }
+        else
+        {
+            function.For(ranges, body);
+        }
+    }
+
+    template <typename ValueType>
+    void FusedElementwiseNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        std::vector<const model::OutputPort<ValueType>*> newInputs;
+        for (const auto& input : _inputPorts)
+        {
+            newInputs.push_back(&transformer.GetCorrespondingInputs(*input));
+        }
+        auto newNode = transformer.AddNode<FusedElementwiseNode<ValueType>>(newInputs, _inputLayouts, _operations, GetOutputMemoryLayout(), _paddingValue);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void FusedElementwiseNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        CompilableNode::WriteToArchive(archiver);
+        int numInputs = static_cast<int>(_inputPorts.size());
+        archiver["numInputs"] << numInputs;
+        for (int index = 0; index < numInputs; ++index)
+        {
+            archiver[std::string("input_") + std::to_string(index)] << *_inputPorts[index];
+            archiver[std::string("inputLayout_") + std::to_string(index)] << _inputLayouts[index];
+        }
+        archiver["outputLayout"] << GetOutputMemoryLayout();
+        archiver["paddingValue"] << _paddingValue;
+
+        int numOperations = static_cast<int>(_operations.size());
+        archiver["numOperations"] << numOperations;
+        for (int index = 0; index < numOperations; ++index)
+        {
+            const auto& operation = _operations[index];
+            auto prefix = std::string("operation_") + std::to_string(index) + "_";
+            archiver[prefix + "type"] << ToString(operation.type);
+            switch (operation.type)
+            {
+            case FusedElementwiseOperationType::unaryFunction:
+            {
+                archiver[prefix + "function"] << GetUnaryFunctionName(*operation.function);
+                auto leakyReLU = dynamic_cast<const LeakyReLUActivationFunction<ValueType>*>(operation.function.get());
+                archiver[prefix + "leakyFactor"] << (leakyReLU == nullptr ? static_cast<ValueType>(0) : leakyReLU->GetLeakyFactor());
+                break;
+            }
+            case FusedElementwiseOperationType::linearFunction:
+                archiver[prefix + "scaleInput"] << operation.scaleInput;
+                archiver[prefix + "biasInput"] << operation.biasInput;
+                archiver[prefix + "broadcastDimension"] << operation.broadcastDimension;
+                break;
+            case FusedElementwiseOperationType::binaryOperation:
+                archiver[prefix + "operation"] << ToString(operation.operation);
+                archiver[prefix + "otherInput"] << operation.otherInput;
+                archiver[prefix + "isLeftOperand"] << operation.isLeftOperand;
+                break;
+            }
+        }
+    }
+
+    template <typename ValueType>
+    void FusedElementwiseNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        CompilableNode::ReadFromArchive(archiver);
+        int numInputs = 0;
+        archiver["numInputs"] >> numInputs;
+        _inputPorts.clear();
+        _inputLayouts.clear();
+        for (int index = 0; index < numInputs; ++index)
+        {
+            model::InputPort<ValueType> port;
+            archiver[std::string("input_") + std::to_string(index)] >> port;
+            AddInput(port.GetReferencedPort());
+
+            model::PortMemoryLayout layout;
+            archiver[std::string("inputLayout_") + std::to_string(index)] >> layout;
+            _inputLayouts.push_back(layout);
+        }
+        model::PortMemoryLayout outputLayout;
+        archiver["outputLayout"] >> outputLayout;
+        _output.SetMemoryLayout(outputLayout);
+        archiver["paddingValue"] >> _paddingValue;
+
+        int numOperations = 0;
+        archiver["numOperations"] >> numOperations;
+        _operations.clear();
+        for (int index = 0; index < numOperations; ++index)
+        {
+            FusedElementwiseOperation<ValueType> operation;
+            auto prefix = std::string("operation_") + std::to_string(index) + "_";
+            std::string typeName;
+            archiver[prefix + "type"] >> typeName;
+            operation.type = FusedOperationTypeFromString(typeName);
+            switch (operation.type)
+            {
+            case FusedElementwiseOperationType::unaryFunction:
+            {
+                std::string functionName;
+                ValueType leakyFactor = 0;
+                archiver[prefix + "function"] >> functionName;
+                archiver[prefix + "leakyFactor"] >> leakyFactor;
+                operation.function = MakeUnaryFunction(functionName, leakyFactor);
+                break;
+            }
+            case FusedElementwiseOperationType::linearFunction:
+                archiver[prefix + "scaleInput"] >> operation.scaleInput;
+                archiver[prefix + "biasInput"] >> operation.biasInput;
+                archiver[prefix + "broadcastDimension"] >> operation.broadcastDimension;
+                break;
+            case FusedElementwiseOperationType::binaryOperation:
+            {
+                std::string operationName;
+                archiver[prefix + "operation"] >> operationName;
+                operation.operation = FromString<BinaryOperationType>(operationName);
+                archiver[prefix + "otherInput"] >> operation.otherInput;
+                archiver[prefix + "isLeftOperand"] >> operation.isLeftOperand;
+                break;
+            }
+            }
+            _operations.push_back(operation);
+        }
+        VerifyInputs();
+    }
+
+    // Explicit specialization
+    template class FusedElementwiseNode<float>;
+    template class FusedElementwiseNode<double>;
+} // namespace nodes
+} // namespace ell
@@ -195,12 +195,9 @@ namespace nodes
         auto& prevHiddenState = hiddenState;
 
         // Allocate local variables
-        const size_t stackSize = hiddenUnits * 3;
+        const int stackSize = hiddenUnits * 3;
         auto istack = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), stackSize));
         auto hstack = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), stackSize));
-        auto inputGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto resetGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto hiddenGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
 
         auto alpha = static_cast<ValueType>(1.0); // GEMV scaling of the matrix multipication
         auto beta = static_cast<ValueType>(1.0); // GEMV scaling of the bias addition
@@ -209,51 +206,33 @@ namespace nodes
         function.MemoryCopy<ValueType>(inputBias, istack, stackSize); // Copy bias values into output so GEMM call accumulates them
         function.CallGEMV(stackSize, inputSize, alpha, inputWeights, inputSize, input, 1, beta, istack, 1);
 
-        // W_h * h + b
+        // W_h * h + b, kept separate because the reset gate only scales the hidden part of the hidden gate
         function.MemoryCopy<ValueType>(hiddenBias, hstack, stackSize); // Copy bias values into output so GEMM call accumulates them
         function.CallGEMV(stackSize, hiddenUnits, alpha, hiddenWeights, hiddenUnits, hiddenState, 1, beta, hstack, 1);
 
-        // the weights are stacked in 3 slices for (input, reset, hidden).
-        auto istack_slice0 = istack;
-        auto istack_slice1 = function.LocalArray(function.PointerOffset(istack, function.LocalScalar(hiddenUnits)));
-        auto istack_slice2 = function.LocalArray(function.PointerOffset(istack, function.LocalScalar(hiddenUnits * 2)));
-        auto hstack_slice0 = hstack;
-        auto hstack_slice1 = function.LocalArray(function.PointerOffset(hstack, function.LocalScalar(hiddenUnits)));
-        auto hstack_slice2 = function.LocalArray(function.PointerOffset(hstack, function.LocalScalar(hiddenUnits * 2)));
-
-        // input_gate = sigma(W_{ iz } x + b_{ iz } + W_{ hz } h + b_{ hz })
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            inputGate[i] = istack_slice0[i] + hstack_slice0[i];
-        });
-        this->ApplyActivation(function, this->_recurrentActivation, inputGate, hiddenUnits);
-
-        // reset_gate = sigma(W_{ ir } x + b_{ ir } + W_{ hr } h + b_{ hr })
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            resetGate[i] = istack_slice1[i] + hstack_slice1[i];
-        });
-        this->ApplyActivation(function, this->_recurrentActivation, resetGate, hiddenUnits);
+        // Apply the gate activations and update the hidden state in a single loop, so each gate value is only loaded
+        // once and the loop can be vectorized as a whole. The stacks hold 3 slices for (input, reset, hidden).
+        auto activation = GetNodeActivationFunction(this->_activation);
+        auto recurrentActivation = GetNodeActivationFunction(this->_recurrentActivation);
+        function.For(outputSize, [=, &activation, &recurrentActivation](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
+            // input_gate = sigma(W_{ iz } x + b_{ iz } + W_{ hz } h + b_{ hz })
+            auto z_i = fn.LocalScalar(recurrentActivation->Compile(fn, emitters::IRLocalScalar(istack[i]) + hstack[i]));
 
-        // hidden_gate = tanh(W_{ in } x + b_{ in } + reset_gate * (W_{ hn } h + b_{ hn }))
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            hiddenGate[i] = istack_slice2[i] + resetGate[i] * hstack_slice2[i];
-        });
-        this->ApplyActivation(function, this->_activation, hiddenGate, hiddenUnits);
+            // reset_gate = sigma(W_{ ir } x + b_{ ir } + W_{ hr } h + b_{ hr })
+            auto r_i = fn.LocalScalar(recurrentActivation->Compile(fn, emitters::IRLocalScalar(istack[i + hiddenUnits]) + hstack[i + hiddenUnits]));
 
-        //ht = (1 - input_gate) * hidden_gate + input_gate * h
-        //   = hidden_gate - input_gate * hidden_gate + input_gate * h
-        //   = hidden_gate + input_gate (h - hidden_gate )
+            // hidden_gate = tanh(W_{ in } x + b_{ in } + reset_gate * (W_{ hn } h + b_{ hn }))
+            auto n_i = fn.LocalScalar(activation->Compile(fn, emitters::IRLocalScalar(istack[i + 2 * hiddenUnits]) + r_i * hstack[i + 2 * hiddenUnits]));
 
-        function.For(outputSize, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            auto z_i = inputGate[i];
-            auto n_i = hiddenGate[i];
-            auto h_i = prevHiddenState[i];
+            //ht = (1 - input_gate) * hidden_gate + input_gate * h
+            //   = hidden_gate - input_gate * hidden_gate + input_gate * h
+            //   = hidden_gate + input_gate (h - hidden_gate )
+            auto h_i = emitters::IRLocalScalar(prevHiddenState[i]);
             auto newValue = n_i + z_i * (h_i - n_i);
             hiddenState[i] = newValue;
+            output[i] = newValue;
         });
 
-        // Copy hidden state to the output.
-        function.MemoryCopy<ValueType>(hiddenState, output, hiddenUnits);
-
         // Add the internal reset function
         std::string resetFunctionName = compiler.GetGlobalName(*this, "GRUNodeReset");
         emitters::IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionName);
@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     InputPreprocessingNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "InputPreprocessingNode.h"
+#include "ReorderDataNode.h"
+
+#include <emitters/include/EmitterTypes.h>
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace nodes
+{
+    template <typename InputValueType, typename OutputValueType>
+    InputPreprocessingNode<InputValueType, OutputValueType>::InputPreprocessingNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename InputValueType, typename OutputValueType>
+    InputPreprocessingNode<InputValueType, OutputValueType>::InputPreprocessingNode(const model::OutputPort<InputValueType>& input,
+                                                                                    const model::PortMemoryLayout& inputLayout,
+                                                                                    const std::vector<OutputValueType>& scale,
+                                                                                    const std::vector<OutputValueType>& bias,
+                                                                                    int channelDimension,
+                                                                                    const model::PortMemoryLayout& outputLayout,
+                                                                                    OutputValueType padding) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _inputLayout(inputLayout),
+        _output(this, defaultOutputPortName, outputLayout),
+        _scale(scale),
+        _bias(bias),
+        _channelDimension(channelDimension),
+        _paddingValue(padding)
+    {
+        VerifyParameters();
+    }
+
+    template <typename InputValueType, typename OutputValueType>
+    void InputPreprocessingNode<InputValueType, OutputValueType>::VerifyParameters() const
+    {
+        const auto outputLayout = GetOutputMemoryLayout();
+        if (_inputLayout.NumDimensions() != outputLayout.NumDimensions() || _inputLayout.GetLogicalDimensionActiveSize() != outputLayout.GetLogicalDimensionActiveSize())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "InputPreprocessingNode: input and output active areas must match");
+        }
+
+        if (_input.Size() < _inputLayout.GetMemorySize())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "InputPreprocessingNode: input too small");
+        }
+
+        if (_channelDimension < 0 || _channelDimension >= outputLayout.NumDimensions())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "InputPreprocessingNode: invalid channel dimension");
+        }
+
+        const auto numChannels = static_cast<size_t>(outputLayout.GetLogicalDimensionActiveSize(_channelDimension));
+        if ((!_scale.empty() && _scale.size() != numChannels) || (!_bias.empty() && _bias.size() != numChannels))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "InputPreprocessingNode: scale and bias must have one entry per channel");
+        }
+    }
+
+    template <typename InputValueType, typename OutputValueType>
+    void InputPreprocessingNode<InputValueType, OutputValueType>::Compute() const
+    {
+        const auto outputLayout = GetOutputMemoryLayout();
+        std::vector<OutputValueType> output(outputLayout.GetMemorySize(), _paddingValue);
+        auto input = _input.GetValue();
+
+        const auto activeSize = outputLayout.GetLogicalDimensionActiveSize();
+        const auto numEntries = activeSize.NumElements();
+        const int numDimensions = activeSize.NumDimensions();
+        std::vector<int> coordinates(numDimensions);
+        for (int index = 0; index < numEntries; ++index)
+        {
+            // Visit the logical coordinates in row-major order
+            auto remainder = index;
+            for (int dimension = numDimensions - 1; dimension >= 0; --dimension)
+            {
+                coordinates[dimension] = remainder % activeSize[dimension];
+                remainder /= activeSize[dimension];
+            }
+
+            model::MemoryCoordinates logicalCoordinates(coordinates);
+            auto channel = coordinates[_channelDimension];
+            auto value = static_cast<OutputValueType>(input[_inputLayout.GetLogicalEntryOffset(logicalCoordinates)]);
+            if (!_scale.empty())
+            {
+                value *= _scale[channel];
+            }
+            if (!_bias.empty())
+            {
+                value += _bias[channel];
+            }
+            output[outputLayout.GetLogicalEntryOffset(logicalCoordinates)] = value;
+        }
+        _output.SetOutput(output);
+    }
+
+    template <typename InputValueType, typename OutputValueType>
+    void InputPreprocessingNode<InputValueType, OutputValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(_input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(_output, _paddingValue);
+
+        auto& module = function.GetModule();
+        emitters::LLVMValue pScale = _scale.empty() ? nullptr : function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "scale"), _scale), 0);
+        emitters::LLVMValue pBias = _bias.empty() ? nullptr : function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "bias"), _bias), 0);
+
+        const auto inputLayout = _inputLayout;
+        const auto outputLayout = GetOutputMemoryLayout();
+        std::vector<emitters::IRFunctionEmitter::ConstLoopRange> ranges;
+        for (int dimensionIndex = 0; dimensionIndex < outputLayout.NumDimensions(); ++dimensionIndex)
+        {
+            ranges.push_back({ 0, outputLayout.GetActiveSize(dimensionIndex) });
+        }
+
+        // The loop nest walks the output in memory order, so the stores are contiguous and the innermost loop can be
+        // vectorized. Unless the channel is the innermost output dimension, its scale and bias are loop-invariant there.
+        const auto channelDimension = _channelDimension;
+        function.For(ranges, [=](emitters::IRFunctionEmitter& function, std::vector<emitters::IRLocalScalar> indices) {
+            auto logicalCoordinates = ReorderDataNodeDetail::PhysicalToLogical(indices, outputLayout.GetLogicalDimensionOrder());
+            auto inputCoordinates = ReorderDataNodeDetail::LogicalToPhysical(logicalCoordinates, inputLayout.GetLogicalDimensionOrder());
+            auto inputValue = function.ValueAt(pInput, model::EmitGetEntryOffset(function, inputCoordinates, inputLayout));
+            auto value = function.LocalScalar(function.CastValue<OutputValueType>(inputValue));
+
+            auto channel = logicalCoordinates[channelDimension];
+            if (pScale != nullptr)
+            {
+                value = value * function.LocalScalar(function.ValueAt(pScale, channel));
+            }
+            if (pBias != nullptr)
+            {
+                value = value + function.LocalScalar(function.ValueAt(pBias, channel));
+            }
+            function.SetValueAt(pOutput, model::EmitGetEntryOffset(function, indices, outputLayout), value);
+        });
+    }
+
+    template <typename InputValueType, typename OutputValueType>
+    void InputPreprocessingNode<InputValueType, OutputValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<InputPreprocessingNode<InputValueType, OutputValueType>>(newInput, _inputLayout, _scale, _bias, _channelDimension, GetOutputMemoryLayout(), _paddingValue);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename InputValueType, typename OutputValueType>
+    void InputPreprocessingNode<InputValueType, OutputValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["inputLayout"] << _inputLayout;
+        archiver["outputLayout"] << GetOutputMemoryLayout();
+        archiver["scale"] << _scale;
+        archiver["bias"] << _bias;
+        archiver["channelDimension"] << _channelDimension;
+        archiver["paddingValue"] << _paddingValue;
+    }
+
+    template <typename InputValueType, typename OutputValueType>
+    void InputPreprocessingNode<InputValueType, OutputValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["inputLayout"] >> _inputLayout;
+        model::PortMemoryLayout outputLayout;
+        archiver["outputLayout"] >> outputLayout;
+        _output.SetMemoryLayout(outputLayout);
+        archiver["scale"] >> _scale;
+        archiver["bias"] >> _bias;
+        archiver["channelDimension"] >> _channelDimension;
+        archiver["paddingValue"] >> _paddingValue;
+        VerifyParameters();
+    }
+
+    // Explicit specialization
+    template class InputPreprocessingNode<int, float>;
+    template class InputPreprocessingNode<int, double>;
+    template class InputPreprocessingNode<float, float>;
+    template class InputPreprocessingNode<double, double>;
+} // namespace nodes
+} // namespace ell
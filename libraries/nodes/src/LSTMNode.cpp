@@ -226,83 +226,41 @@ namespace nodes
         auto& prevCellState = cellState;
 
         // Allocate local variables
-        const size_t stackSize = hiddenUnits * stackHeight;
-        auto istack = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), stackSize));
-        auto hstack = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), stackSize));
-        auto inputGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto forgetGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto cellGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto outputGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
+        const int stackSize = hiddenUnits * static_cast<int>(stackHeight);
+        auto gates = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), stackSize));
+        auto gateBias = function.LocalArray(hiddenBias);
 
         auto alpha = static_cast<ValueType>(1.0); // GEMV scaling of the matrix multipication
         auto beta = static_cast<ValueType>(1.0); // GEMV scaling of the bias addition
 
-        // W_i * x + b_i, one matrix multiplication for all 4 gates (input, forget, cell, output)
-        function.MemoryCopy<ValueType>(inputBias, istack, stackSize); // Copy bias values into output so GEMM call accumulates them
-        function.CallGEMV(stackSize, inputSize, alpha, inputWeights, inputSize, input, 1, beta, istack, 1);
-
-        // W_h * h + b_h
-        function.MemoryCopy<ValueType>(hiddenBias, hstack, stackSize); // Copy bias values into output so GEMM call accumulates them
-        function.CallGEMV(stackSize, hiddenUnits, alpha, hiddenWeights, hiddenUnits, prevHiddenState, 1, beta, hstack, 1);
-
-        // the weights are stacked in 4 slices for (input, forget, cell, output).
-        auto istack_slice0 = istack;
-        auto istack_slice1 = function.LocalArray(function.PointerOffset(istack, function.LocalScalar(hiddenUnits)));
-        auto istack_slice2 = function.LocalArray(function.PointerOffset(istack, function.LocalScalar(hiddenUnits * 2)));
-        auto istack_slice3 = function.LocalArray(function.PointerOffset(istack, function.LocalScalar(hiddenUnits * 3)));
-
-        auto hstack_slice0 = hstack;
-        auto hstack_slice1 = function.LocalArray(function.PointerOffset(hstack, function.LocalScalar(hiddenUnits)));
-        auto hstack_slice2 = function.LocalArray(function.PointerOffset(hstack, function.LocalScalar(hiddenUnits * 2)));
-        auto hstack_slice3 = function.LocalArray(function.PointerOffset(hstack, function.LocalScalar(hiddenUnits * 3)));
-
-        // input_gate = sigma(W_{ iz } x + b_{ iz } + W_{ hz } h + b_{ hz })
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            inputGate[i] = istack_slice0[i] + hstack_slice0[i];
-        });
-        this->ApplyActivation(function, this->_recurrentActivation, inputGate, hiddenUnits);
-
-        // forget_gate = sigma(W_{if} x + b_{if} + W_{hf} h + b_{hf})
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            forgetGate[i] = istack_slice1[i] + hstack_slice1[i];
-        });
-        this->ApplyActivation(function, this->_recurrentActivation, forgetGate, hiddenUnits);
-
-        // cell_gate = tanh(W_{ig} x + b_{ig} + W_{hg} h + b_{hg})
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            cellGate[i] = istack_slice2[i] + hstack_slice2[i];
-        });
-        this->ApplyActivation(function, this->_activation, cellGate, hiddenUnits);
-
-        // output_gate = sigma(W_{io} x + b_{io} + W_{ho} h + b_{ho})
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            outputGate[i] = istack_slice3[i] + hstack_slice3[i];
+        // W_i * x + b_i + W_h * h, accumulated into one stack for all 4 gates (input, forget, cell, output)
+        function.MemoryCopy<ValueType>(inputBias, gates, stackSize); // Copy bias values into output so GEMM call accumulates them
+        function.CallGEMV(stackSize, inputSize, alpha, inputWeights, inputSize, input, 1, beta, gates, 1);
+        function.CallGEMV(stackSize, hiddenUnits, alpha, hiddenWeights, hiddenUnits, prevHiddenState, 1, beta, gates, 1);
+
+        // Add the hidden bias, apply the gate activations and update the cell and hidden states in a single loop,
+        // so each gate value is only loaded once and the loop can be vectorized as a whole
+        auto activation = GetNodeActivationFunction(this->_activation);
+        auto recurrentActivation = GetNodeActivationFunction(this->_recurrentActivation);
+        function.For(hiddenUnits, [=, &activation, &recurrentActivation](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
+            auto gate = [=](int slice) -> emitters::LLVMValue {
+                auto index = i + slice * hiddenUnits;
+                return emitters::IRLocalScalar(gates[index]) + gateBias[index];
+            };
+            auto it = fn.LocalScalar(recurrentActivation->Compile(fn, gate(0)));
+            auto ft = fn.LocalScalar(recurrentActivation->Compile(fn, gate(1)));
+            auto gt = fn.LocalScalar(activation->Compile(fn, gate(2)));
+            auto ot = fn.LocalScalar(recurrentActivation->Compile(fn, gate(3)));
+
+            // ct = ft * c + it * gt
+            auto ct = ft * prevCellState[i] + it * gt;
+            cellState[i] = ct;
+
+            // ht = ot * tanh(ct)
+            auto ht = ot * fn.LocalScalar(activation->Compile(fn, ct));
+            hiddenState[i] = ht;
+            output[i] = ht;
         });
-        this->ApplyActivation(function, this->_recurrentActivation, outputGate, hiddenUnits);
-
-        // cellState = forget_gate * cellState + input_gate * cell_gate
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            auto ft = forgetGate[i];
-            auto ct = prevCellState[i];
-            auto it = inputGate[i];
-            auto gt = cellGate[i];
-            auto newValue = ft * ct + it * gt;
-            cellState[i] = newValue;
-        });
-
-        // newHiddenState = output_gate * tanh(ct), we'll reuse inputGate local variable to compile tanh(ct)
-        function.MemoryCopy<ValueType>(cellState, inputGate, hiddenUnits);
-        this->ApplyActivation(function, this->_activation, inputGate, hiddenUnits);
-
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            auto tan_ct = inputGate[i];
-            auto ot = outputGate[i];
-            auto newValue = ot * tan_ct;
-            hiddenState[i] = newValue;
-        });
-
-        // Copy hidden state to the output.
-        function.MemoryCopy<ValueType>(hiddenState, output, hiddenUnits);
 
         // Add the internal reset function
         std::string resetFunctionName = compiler.GetGlobalName(*this, "LSTMNodeReset");
@@ -7,10 +7,19 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "MatrixMatrixMultiplyNode.h"
+#include "ConstantNode.h"
+
+#include <emitters/include/GemmTileSizes.h>
 
 #include <math/include/Matrix.h>
 #include <math/include/MatrixOperations.h>
 
+#include <model/include/IRCompiledMapCache.h>
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+
 namespace ell
 {
 namespace nodes
@@ -22,8 +31,18 @@ namespace nodes
         //
         constexpr utilities::ArchiveVersion currentArchiveVersion = { utilities::ArchiveVersionNumbers::v2 };
 
+        // Computes rows [beginRow, endRow) of Z = X * Y
+        template <typename ValueType, typename MatrixX, typename MatrixY>
+        void MultiplyRows(const MatrixX& X, const MatrixY& Y, math::RowMatrixReference<ValueType> Z, size_t beginRow, size_t endRow)
+        {
+            auto numRows = endRow - beginRow;
+            auto ZRows = Z.GetSubMatrix(beginRow, 0, numRows, Z.NumColumns());
+            math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), X.GetSubMatrix(beginRow, 0, numRows, X.NumColumns()), Y, static_cast<ValueType>(0.0), ZRows);
+        }
+
+        // Computes rows [beginRow, endRow) of the product as stored: C, or C' if transposeC is set
         template <typename ValueType>
-        void MatrixMatrixMultiply(bool transposeA, bool transposeB, bool transposeC, int m, int n, int k, const std::vector<ValueType>& matrixAValues, const std::vector<ValueType>& matrixBValues, std::vector<ValueType>& matrixCValues)
+        void MatrixMatrixMultiply(bool transposeA, bool transposeB, bool transposeC, int m, int n, int k, const std::vector<ValueType>& matrixAValues, const std::vector<ValueType>& matrixBValues, std::vector<ValueType>& matrixCValues, size_t beginRow, size_t endRow)
         {
             if (transposeC)
             {
@@ -36,12 +55,12 @@ namespace nodes
                     if (transposeB)
                     {
                         math::ConstRowMatrixReference<ValueType> Bt(matrixBValues.data(), n, k);
-                        math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), Bt, At, static_cast<ValueType>(0.0), Ct);
+                        MultiplyRows(Bt, At, Ct, beginRow, endRow);
                     }
                     else
                     {
                         math::ConstColumnMatrixReference<ValueType> Bt(matrixBValues.data(), n, k);
-                        math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), Bt, At, static_cast<ValueType>(0.0), Ct);
+                        MultiplyRows(Bt, At, Ct, beginRow, endRow);
                     }
                 }
                 else
@@ -50,12 +69,12 @@ namespace nodes
                     if (transposeB)
                     {
                         math::ConstRowMatrixReference<ValueType> Bt(matrixBValues.data(), n, k);
-                        math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), Bt, At, static_cast<ValueType>(0.0), Ct);
+                        MultiplyRows(Bt, At, Ct, beginRow, endRow);
                     }
                     else
                     {
                         math::ConstColumnMatrixReference<ValueType> Bt(matrixBValues.data(), n, k);
-                        math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), Bt, At, static_cast<ValueType>(0.0), Ct);
+                        MultiplyRows(Bt, At, Ct, beginRow, endRow);
                     }
                 }
             }
@@ -68,12 +87,12 @@ namespace nodes
                     if (transposeB)
                     {
                         math::ConstColumnMatrixReference<ValueType> B(matrixBValues.data(), k, n);
-                        math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), A, B, static_cast<ValueType>(0.0), C);
+                        MultiplyRows(A, B, C, beginRow, endRow);
                     }
                     else // not transposeB
                     {
                         math::ConstRowMatrixReference<ValueType> B(matrixBValues.data(), k, n);
-                        math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), A, B, static_cast<ValueType>(0.0), C);
+                        MultiplyRows(A, B, C, beginRow, endRow);
                     }
                 }
                 else // not transposeA
@@ -82,12 +101,12 @@ namespace nodes
                     if (transposeB)
                     {
                         math::ConstColumnMatrixReference<ValueType> B(matrixBValues.data(), k, n);
-                        math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), A, B, static_cast<ValueType>(0.0), C);
+                        MultiplyRows(A, B, C, beginRow, endRow);
                     }
                     else // not transposeB
                     {
                         math::ConstRowMatrixReference<ValueType> B(matrixBValues.data(), k, n);
-                        math::MultiplyScaleAddUpdate(static_cast<ValueType>(1.0), A, B, static_cast<ValueType>(0.0), C);
+                        MultiplyRows(A, B, C, beginRow, endRow);
                     }
                 }
             }
@@ -200,6 +219,12 @@ namespace nodes
         }
     }
 
+    template <typename ValueType>
+    int64_t MatrixMatrixMultiplyNode<ValueType>::GetOperationCount() const
+    {
+        return 2 * static_cast<int64_t>(_m) * _n * _k;
+    }
+
     template <typename ValueType>
     void MatrixMatrixMultiplyNode<ValueType>::Compute() const
     {
@@ -217,7 +242,17 @@ namespace nodes
         math::RowMatrixReference<ValueType> inputMatrix2Ref(inputMatrix2Values.data(), _k, _n);
         math::RowMatrixReference<ValueType> outputMatrixRef(outputMatrixValues.data(), _m, _n);
 
-        MatrixMatrixMultiply(_transpose1, _transpose2, _transposeOutput, (int)_m, (int)_n, (int)_k, inputMatrix1Values, inputMatrix2Values, outputMatrixValues);
+        // The product is stored as a row-major matrix with _n columns, or _m if it's transposed
+        const int numRows = _transposeOutput ? _n : _m;
+        const int numColumns = _transposeOutput ? _m : _n;
+
+        // Split the rows into blocks of at least minOperationsPerBlock multiply-adds
+        const size_t minOperationsPerBlock = 1 << 18;
+        const auto operationsPerRow = std::max(static_cast<size_t>(numColumns) * _k, size_t{ 1 });
+        ComputeInBlocks(numRows, (minOperationsPerBlock + operationsPerRow - 1) / operationsPerRow, [&](size_t beginRow, size_t endRow) {
+            MatrixMatrixMultiply(_transpose1, _transpose2, _transposeOutput, (int)_m, (int)_n, (int)_k, inputMatrix1Values, inputMatrix2Values, outputMatrixValues, beginRow, endRow);
+        });
+        _epilogue.Compute(outputMatrixValues, numRows, numColumns, numColumns, 1);
 
         _output.SetOutput(outputMatrixValues);
     };
@@ -228,24 +263,124 @@ namespace nodes
         const auto& newInput1 = transformer.GetCorrespondingInputs(_input1);
         const auto& newInput2 = transformer.GetCorrespondingInputs(_input2);
         auto newNode = transformer.AddNode<MatrixMatrixMultiplyNode<ValueType>>(newInput1, _m, _n, _k, _lda, _transpose1, newInput2, _ldb, _transpose2, _ldc, _transposeOutput);
+        newNode->SetEpilogue(_epilogue);
         transformer.MapNodeOutput(output, newNode->output);
     }
 
+    template <typename ValueType>
+    bool MatrixMatrixMultiplyNode<ValueType>::CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const
+    {
+        // The output must be read as an image with the channels in the (contiguous) columns
+        const int numColumns = _transposeOutput ? _m : _n;
+        return _ldc == numColumns && outputLayout.NumDimensions() == 3 && outputLayout.IsCanonicalOrder() && !outputLayout.HasPadding() &&
+               outputLayout.GetLogicalDimensionActiveSize(2) == numColumns && static_cast<int>(outputLayout.NumElements()) == _m * _n;
+    }
+
     template <typename ValueType>
     void MatrixMatrixMultiplyNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
-        emitters::LLVMValue pInput1 = compiler.EnsurePortEmitted(input1);
-        emitters::LLVMValue pInput2 = compiler.EnsurePortEmitted(input2);
+        emitters::LLVMValue pInput1 = EnsureWeightsEmitted(compiler, function, input1);
+        emitters::LLVMValue pInput2 = EnsureWeightsEmitted(compiler, function, input2);
         emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
 
-        if (_transposeOutput)
+        // A transposed output C' is computed as the row-major product B' * A'
+        const bool transposeA = _transposeOutput ? !_transpose2 : _transpose1;
+        const bool transposeB = _transposeOutput ? !_transpose1 : _transpose2;
+        const int m = static_cast<int>(_transposeOutput ? _n : _m);
+        const int n = static_cast<int>(_transposeOutput ? _m : _n);
+        const int k = static_cast<int>(_k);
+        auto A = _transposeOutput ? pInput2 : pInput1;
+        auto B = _transposeOutput ? pInput1 : pInput2;
+        const int lda = static_cast<int>(_transposeOutput ? _ldb : _lda);
+        const int ldb = static_cast<int>(_transposeOutput ? _lda : _ldb);
+
+        // A shared function gets the epilogue's constants as parameters, since they differ between the nodes that call it
+        typename OutputEpilogue<ValueType>::EmittedConstants epilogueConstants;
+        if (IsSharingNodeFunction())
         {
-            function.CallGEMM<ValueType>(!_transpose2, !_transpose1, (int)_n, (int)_m, (int)_k, pInput2, (int)_ldb, pInput1, (int)_lda, pOutput, (int)_ldc);
+            epilogueConstants.bias = _epilogue.HasBias() ? function.GetFunctionArgument("epilogueBias") : nullptr;
+            epilogueConstants.alpha = _epilogue.GetActivation() == EpilogueActivation::parametricReLU ? function.GetFunctionArgument("epilogueAlpha") : nullptr;
         }
         else
         {
-            function.CallGEMM<ValueType>(_transpose1, _transpose2, (int)_m, (int)_n, (int)_k, pInput1, (int)_lda, pInput2, (int)_ldb, pOutput, (int)_ldc);
+            epilogueConstants = _epilogue.EmitConstants(function.GetModule(), GetInternalStateIdentifier());
+        }
+
+        // GEMM is an opaque call, so the epilogue follows it in a single pass over the product. Constant weights
+        // are packed for the GEMM kernel now, unless the function is shared and they come in as parameters. Reduced-
+        // precision weights aren't prepacked; the GEMM widens them as it packs them.
+        const std::vector<ValueType>* constantA = nullptr;
+        const std::vector<ValueType>* constantB = nullptr;
+        if (!IsSharingNodeFunction())
+        {
+            constantA = GetPrepackableWeights(compiler, *this, _transposeOutput ? input2 : input1);
+            constantB = GetPrepackableWeights(compiler, *this, _transposeOutput ? input1 : input2);
+        }
+        function.CallGEMM<ValueType>(transposeA, transposeB, m, n, k, A, lda, constantA, B, ldb, constantB, pOutput, (int)_ldc, compiler.GetGlobalName(*this, "gemm"));
+        _epilogue.Compile(function, epilogueConstants, pOutput, m, n, (int)_ldc, 1);
+    }
+
+    template <typename ValueType>
+    std::string MatrixMatrixMultiplyNode<ValueType>::GetNodeFunctionKey(model::IRMapCompiler& compiler) const
+    {
+        // Reduced-precision weights are read from a global of their own, rather than through the function's parameters
+        if (HasReducedPrecisionWeights(compiler, input1) || HasReducedPrecisionWeights(compiler, input2))
+        {
+            return "";
+        }
+
+        // Constant weights packed for the blocked GEMM kernel are stored in globals of their own, too
+        const int m = static_cast<int>(_transposeOutput ? _n : _m);
+        const int n = static_cast<int>(_transposeOutput ? _m : _n);
+        if ((GetPrepackableWeights(compiler, *this, input1) || GetPrepackableWeights(compiler, *this, input2)) && emitters::UsesBlockedGemm(compiler.GetMapCompilerOptions(*this).compilerSettings, m, n, _k))
+        {
+            return "";
+        }
+
+        // The inputs come in through the parameters, so the code only depends on the shape of the product, the kind of
+        // epilogue, and the compiler options
+        std::stringstream key;
+        key << _m << "_" << _n << "_" << _k << "_" << _lda << "_" << _ldb << "_" << _ldc << "_" << _transpose1 << _transpose2 << _transposeOutput
+            << "_" << _epilogue.GetCodeKey() << "_" << model::GetMapCompilerOptionsKey(compiler.GetMapCompilerOptions(*this));
+        return "Shared_" + std::to_string(std::hash<std::string>{}(key.str()));
+    }
+
+    template <typename ValueType>
+    emitters::NamedVariableTypeList MatrixMatrixMultiplyNode<ValueType>::GetNodeFunctionStateParameterList(model::IRMapCompiler& compiler) const
+    {
+        emitters::NamedVariableTypeList parameters;
+        if (IsSharingNodeFunction())
+        {
+            auto pointerType = emitters::GetPointerType(emitters::GetVariableType<ValueType>());
+            if (_epilogue.HasBias())
+            {
+                parameters.emplace_back("epilogueBias", pointerType);
+            }
+            if (_epilogue.GetActivation() == EpilogueActivation::parametricReLU)
+            {
+                parameters.emplace_back("epilogueAlpha", pointerType);
+            }
+        }
+        return parameters;
+    }
+
+    template <typename ValueType>
+    std::vector<emitters::LLVMValue> MatrixMatrixMultiplyNode<ValueType>::GetNodeFunctionStateArguments(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& currentFunction) const
+    {
+        std::vector<emitters::LLVMValue> arguments;
+        if (IsSharingNodeFunction())
+        {
+            // The constants are still this node's own, so they're named after its ID rather than the shared function
+            auto constants = _epilogue.EmitConstants(compiler.GetModule(), model::IdString(*this));
+            for (auto constant : { constants.bias, constants.alpha })
+            {
+                if (constant != nullptr)
+                {
+                    arguments.push_back(currentFunction.PointerOffset(constant, 0));
+                }
+            }
         }
+        return arguments;
     }
 
     template <typename ValueType>
@@ -276,6 +411,7 @@ namespace nodes
         archiver["transpose1"] << _transpose1;
         archiver["transpose2"] << _transpose2;
         archiver["transposeOutput"] << _transposeOutput;
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -295,6 +431,7 @@ namespace nodes
         archiver["transpose1"] >> _transpose1;
         archiver["transpose2"] >> _transpose2;
         archiver.OptionalProperty("transposeOutput", false) >> _transposeOutput;
+        _epilogue.ReadFromArchive(archiver);
     }
 
     template <typename ValueType>
@@ -50,6 +50,12 @@ namespace nodes
         }
     }
 
+    template <typename ValueType>
+    int64_t MatrixVectorMultiplyNode<ValueType>::GetOperationCount() const
+    {
+        return 2 * static_cast<int64_t>(_m) * _n;
+    }
+
     template <typename ValueType>
     void MatrixVectorMultiplyNode<ValueType>::Compute() const
     {
@@ -0,0 +1,241 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     OutputEpilogue.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "OutputEpilogue.h"
+
+#include <emitters/include/IRLocalArray.h>
+#include <emitters/include/IRModuleEmitter.h>
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace ell
+{
+namespace nodes
+{
+    template <typename ValueType>
+    void OutputEpilogue<ValueType>::SetBias(const std::vector<ValueType>& bias)
+    {
+        _bias = bias;
+    }
+
+    template <typename ValueType>
+    void OutputEpilogue<ValueType>::SetReLU()
+    {
+        _activation = EpilogueActivation::reLU;
+    }
+
+    template <typename ValueType>
+    void OutputEpilogue<ValueType>::SetLeakyReLU(ValueType leakyFactor)
+    {
+        _activation = EpilogueActivation::leakyReLU;
+        _leakyFactor = leakyFactor;
+    }
+
+    template <typename ValueType>
+    void OutputEpilogue<ValueType>::SetParametricReLU(const std::vector<ValueType>& alpha)
+    {
+        _activation = EpilogueActivation::parametricReLU;
+        _alpha = alpha;
+    }
+
+    template <typename ValueType>
+    void OutputEpilogue<ValueType>::SetClamp(ValueType minValue, ValueType maxValue)
+    {
+        if (minValue > maxValue)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "OutputEpilogue: clamp range is empty");
+        }
+        _activation = EpilogueActivation::clamp;
+        _minValue = minValue;
+        _maxValue = maxValue;
+    }
+
+    template <typename ValueType>
+    ValueType OutputEpilogue<ValueType>::Compute(ValueType x, int channel) const
+    {
+        if (HasBias())
+        {
+            x += _bias[channel];
+        }
+
+        switch (_activation)
+        {
+        case EpilogueActivation::none:
+            return x;
+        case EpilogueActivation::reLU:
+            return x >= 0 ? x : 0;
+        case EpilogueActivation::leakyReLU:
+            return x >= 0 ? x : x * _leakyFactor;
+        case EpilogueActivation::parametricReLU:
+            return x >= 0 ? x : x * _alpha[channel];
+        case EpilogueActivation::clamp:
+            return std::min(std::max(x, _minValue), _maxValue);
+        default:
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "OutputEpilogue: unknown activation");
+        }
+    }
+
+    template <typename ValueType>
+    void OutputEpilogue<ValueType>::Compute(std::vector<ValueType>& values, int numPixels, int numChannels, int pixelStride, int channelStride) const
+    {
+        if (IsEmpty())
+        {
+            return;
+        }
+
+        for (int pixel = 0; pixel < numPixels; ++pixel)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto& value = values[pixel * pixelStride + channel * channelStride];
+                value = Compute(value, channel);
+            }
+        }
+    }
+
+    template <typename ValueType>
+    emitters::IRLocalScalar OutputEpilogue<ValueType>::Compile(emitters::IRFunctionEmitter& function, const std::string& identifier, emitters::IRLocalScalar x, emitters::IRLocalScalar channel) const
+    {
+        return Compile(function, EmitConstants(function.GetModule(), identifier), x, channel);
+    }
+
+    template <typename ValueType>
+    emitters::IRLocalScalar OutputEpilogue<ValueType>::Compile(emitters::IRFunctionEmitter& function, const EmittedConstants& constants, emitters::IRLocalScalar x, emitters::IRLocalScalar channel) const
+    {
+        if (HasBias())
+        {
+            auto bias = function.LocalArray(constants.bias);
+            x = x + bias[channel];
+        }
+
+        auto zero = function.LocalScalar<ValueType>(0);
+        switch (_activation)
+        {
+        case EpilogueActivation::none:
+            return x;
+        case EpilogueActivation::reLU:
+            return function.LocalScalar(function.Select(x >= zero, x, zero));
+        case EpilogueActivation::leakyReLU:
+            return function.LocalScalar(function.Select(x >= zero, x, x * function.LocalScalar(_leakyFactor)));
+        case EpilogueActivation::parametricReLU:
+        {
+            auto alpha = function.LocalArray(constants.alpha);
+            return function.LocalScalar(function.Select(x >= zero, x, x * alpha[channel]));
+        }
+        case EpilogueActivation::clamp:
+        {
+            auto minValue = function.LocalScalar(_minValue);
+            auto maxValue = function.LocalScalar(_maxValue);
+            auto lowClamped = function.LocalScalar(function.Select(x < minValue, minValue, x));
+            return function.LocalScalar(function.Select(lowClamped > maxValue, maxValue, lowClamped));
+        }
+        default:
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "OutputEpilogue: unknown activation");
+        }
+    }
+
+    template <typename ValueType>
+    void OutputEpilogue<ValueType>::Compile(emitters::IRFunctionEmitter& function, const std::string& identifier, emitters::LLVMValue values, int numPixels, int numChannels, int pixelStride, int channelStride) const
+    {
+        if (IsEmpty())
+        {
+            return;
+        }
+
+        Compile(function, EmitConstants(function.GetModule(), identifier), values, numPixels, numChannels, pixelStride, channelStride);
+    }
+
+    template <typename ValueType>
+    void OutputEpilogue<ValueType>::Compile(emitters::IRFunctionEmitter& function, const EmittedConstants& constants, emitters::LLVMValue values, int numPixels, int numChannels, int pixelStride, int channelStride) const
+    {
+        if (IsEmpty())
+        {
+            return;
+        }
+
+        // Put the loop over the contiguous dimension innermost
+        auto data = function.LocalArray(values);
+        auto channelsInner = channelStride <= pixelStride;
+        function.For(channelsInner ? numPixels : numChannels, [=](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
+            function.For(channelsInner ? numChannels : numPixels, [=](emitters::IRFunctionEmitter& function, emitters::LLVMValue j) {
+                auto pixel = function.LocalScalar(channelsInner ? i : j);
+                auto channel = function.LocalScalar(channelsInner ? j : i);
+                auto offset = pixel * pixelStride + channel * channelStride;
+                data[offset] = Compile(function, constants, data[offset], channel);
+            });
+        });
+    }
+
+    template <typename ValueType>
+    typename OutputEpilogue<ValueType>::EmittedConstants OutputEpilogue<ValueType>::EmitConstants(emitters::IRModuleEmitter& module, const std::string& identifier) const
+    {
+        EmittedConstants constants;
+        if (HasBias())
+        {
+            constants.bias = module.ConstantArray(identifier + "_epilogueBias", _bias);
+        }
+        if (_activation == EpilogueActivation::parametricReLU)
+        {
+            constants.alpha = module.ConstantArray(identifier + "_epilogueAlpha", _alpha);
+        }
+        return constants;
+    }
+
+    template <typename ValueType>
+    std::string OutputEpilogue<ValueType>::GetCodeKey() const
+    {
+        std::stringstream key;
+        key << std::setprecision(std::numeric_limits<ValueType>::max_digits10) << _bias.size() << "_" << static_cast<int>(_activation) << "_" << _alpha.size() << "_" << _leakyFactor << "_" << _minValue << "_" << _maxValue;
+        return key.str();
+    }
+
+    template <typename ValueType>
+    void OutputEpilogue<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        if (IsEmpty())
+        {
+            return;
+        }
+
+        archiver["epilogueActivation"] << static_cast<int>(_activation);
+        archiver["epilogueBias"] << _bias;
+        archiver["epilogueAlpha"] << _alpha;
+        archiver["epilogueLeakyFactor"] << _leakyFactor;
+        archiver["epilogueMinValue"] << _minValue;
+        archiver["epilogueMaxValue"] << _maxValue;
+    }
+
+    template <typename ValueType>
+    void OutputEpilogue<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        if (!archiver.HasNextPropertyName("epilogueActivation"))
+        {
+            *this = {};
+            return;
+        }
+
+        int activation = 0;
+        archiver["epilogueActivation"] >> activation;
+        _activation = static_cast<EpilogueActivation>(activation);
+        archiver["epilogueBias"] >> _bias;
+        archiver["epilogueAlpha"] >> _alpha;
+        archiver["epilogueLeakyFactor"] >> _leakyFactor;
+        archiver["epilogueMinValue"] >> _minValue;
+        archiver["epilogueMaxValue"] >> _maxValue;
+    }
+
+    // Explicit instantiations
+    template class OutputEpilogue<float>;
+    template class OutputEpilogue<double>;
+} // namespace nodes
+} // namespace ell
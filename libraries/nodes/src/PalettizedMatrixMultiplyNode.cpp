@@ -0,0 +1,285 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PalettizedMatrixMultiplyNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PalettizedMatrixMultiplyNode.h"
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace nodes
+{
+    template <typename ValueType>
+    PalettizedMatrixMultiplyNode<ValueType>::PalettizedMatrixMultiplyNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    PalettizedMatrixMultiplyNode<ValueType>::PalettizedMatrixMultiplyNode(const model::OutputPort<ValueType>& input, const std::vector<ValueType>& codebook, const std::vector<int>& indices, int indexBits, int m, int n, int k, int inputStride, bool transposeInput, int outputStride, bool transposeOutput) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, m * n),
+        _m(m),
+        _n(n),
+        _k(k),
+        _ldb(inputStride),
+        _ldc(outputStride),
+        _transposeInput(transposeInput),
+        _transposeOutput(transposeOutput),
+        _indexBits(indexBits),
+        _codebook(codebook)
+    {
+        if (indexBits != 4 && indexBits != 8)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "PalettizedMatrixMultiplyNode: indices must have 4 or 8 bits");
+        }
+        if (codebook.empty() || codebook.size() > (size_t{ 1 } << indexBits))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "PalettizedMatrixMultiplyNode: the codebook must have between 1 and 2^indexBits entries");
+        }
+        if (static_cast<int>(input.Size()) != k * n)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "PalettizedMatrixMultiplyNode: input matrix size incorrect");
+        }
+        if (static_cast<int64_t>(indices.size()) != static_cast<int64_t>(m) * k)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "PalettizedMatrixMultiplyNode: weights matrix size incorrect");
+        }
+
+        const int rowBytes = GetRowBytes();
+        const int indicesPerByte = 8 / indexBits;
+        _packedIndices.assign(static_cast<size_t>(m) * rowBytes, 0);
+        for (int row = 0; row < m; ++row)
+        {
+            for (int column = 0; column < k; ++column)
+            {
+                auto index = indices[row * k + column];
+                if (index < 0 || index >= static_cast<int>(codebook.size()))
+                {
+                    throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "PalettizedMatrixMultiplyNode: codebook index out of range");
+                }
+                _packedIndices[row * rowBytes + column / indicesPerByte] |= static_cast<uint8_t>(index << ((column % indicesPerByte) * indexBits));
+            }
+        }
+    }
+
+    template <typename ValueType>
+    PalettizedMatrixMultiplyNode<ValueType>::PalettizedMatrixMultiplyNode(const model::OutputPort<ValueType>& input, const PalettizedMatrixMultiplyNode<ValueType>& other) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, other._m * other._n),
+        _m(other._m),
+        _n(other._n),
+        _k(other._k),
+        _ldb(other._ldb),
+        _ldc(other._ldc),
+        _transposeInput(other._transposeInput),
+        _transposeOutput(other._transposeOutput),
+        _indexBits(other._indexBits),
+        _codebook(other._codebook),
+        _packedIndices(other._packedIndices),
+        _epilogue(other._epilogue)
+    {
+    }
+
+    template <typename ValueType>
+    int PalettizedMatrixMultiplyNode<ValueType>::GetIndex(int row, int column) const
+    {
+        const int indicesPerByte = 8 / _indexBits;
+        auto packed = _packedIndices[row * GetRowBytes() + column / indicesPerByte];
+        return (packed >> ((column % indicesPerByte) * _indexBits)) & ((1 << _indexBits) - 1);
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> PalettizedMatrixMultiplyNode<ValueType>::GetWeights() const
+    {
+        std::vector<ValueType> weights(static_cast<size_t>(_m) * _k);
+        for (int row = 0; row < _m; ++row)
+        {
+            for (int column = 0; column < _k; ++column)
+            {
+                weights[row * _k + column] = _codebook[GetIndex(row, column)];
+            }
+        }
+        return weights;
+    }
+
+    template <typename ValueType>
+    int64_t PalettizedMatrixMultiplyNode<ValueType>::GetWeightsBytes() const
+    {
+        return static_cast<int64_t>(_packedIndices.size() + _codebook.size() * sizeof(ValueType));
+    }
+
+    template <typename ValueType>
+    int64_t PalettizedMatrixMultiplyNode<ValueType>::GetOperationCount() const
+    {
+        return 2 * static_cast<int64_t>(_m) * _n * _k;
+    }
+
+    template <typename ValueType>
+    bool PalettizedMatrixMultiplyNode<ValueType>::CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const
+    {
+        // The output must be read as an image with the channels in the (contiguous) columns
+        const int numColumns = _transposeOutput ? _m : _n;
+        return _ldc == numColumns && outputLayout.NumDimensions() == 3 && outputLayout.IsCanonicalOrder() && !outputLayout.HasPadding() &&
+               outputLayout.GetLogicalDimensionActiveSize(2) == numColumns && static_cast<int>(outputLayout.NumElements()) == _m * _n;
+    }
+
+    template <typename ValueType>
+    void PalettizedMatrixMultiplyNode<ValueType>::Compute() const
+    {
+        auto inputValues = _input.GetValue();
+        auto weights = GetWeights();
+        std::vector<ValueType> outputValues(_output.Size());
+        for (int row = 0; row < _m; ++row)
+        {
+            for (int column = 0; column < _n; ++column)
+            {
+                ValueType sum = 0;
+                for (int inputRow = 0; inputRow < _k; ++inputRow)
+                {
+                    sum += weights[row * _k + inputRow] * inputValues[_transposeInput ? column * _ldb + inputRow : inputRow * _ldb + column];
+                }
+
+                // The output is a row-major matrix with _n columns, or _m if it's transposed, whose columns are the epilogue's channels
+                outputValues[_transposeOutput ? column * _ldc + row : row * _ldc + column] = _epilogue.Compute(sum, _transposeOutput ? row : column);
+            }
+        }
+        _output.SetOutput(outputValues);
+    }
+
+    template <typename ValueType>
+    void PalettizedMatrixMultiplyNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+
+        auto& module = function.GetModule();
+        const auto identifier = GetInternalStateIdentifier();
+        auto codebook = module.ConstantArray(identifier + "_codebook", _codebook);
+        auto packedIndices = module.ConstantArray(identifier + "_indices", std::vector<char>(_packedIndices.begin(), _packedIndices.end()));
+        auto epilogueConstants = _epilogue.EmitConstants(module, identifier);
+
+        // Each row of weights is decoded into a buffer on the stack, which stays in the cache while it's multiplied
+        // with each column of the input, so only the packed indices are read from memory
+        const int rowBytes = GetRowBytes();
+        const int indexBits = _indexBits;
+        const int indicesPerByte = 8 / indexBits;
+        auto rowWeights = function.Variable(emitters::GetVariableType<ValueType>(), rowBytes * indicesPerByte);
+
+        const int n = _n;
+        const int k = _k;
+        const int ldb = _ldb;
+        const bool transposeInput = _transposeInput;
+        const bool contiguousColumns = transposeInput || (n == 1 && ldb == 1);
+        function.For(_m, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar row) {
+            auto& irBuilder = function.GetEmitter().GetIRBuilder();
+            auto int32Type = function.GetEmitter().Type(emitters::VariableType::Int32);
+            auto rowStart = row * rowBytes;
+            function.For(rowBytes, [=, &irBuilder](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar byteIndex) {
+                auto packed = irBuilder.CreateZExt(function.ValueAt(packedIndices, rowStart + byteIndex), int32Type);
+                if (indexBits == 8)
+                {
+                    function.SetValueAt(rowWeights, byteIndex, function.ValueAt(codebook, function.LocalScalar(packed)));
+                }
+                else
+                {
+                    auto low = function.LocalScalar(irBuilder.CreateAnd(packed, 15));
+                    auto high = function.LocalScalar(irBuilder.CreateLShr(packed, 4));
+                    function.SetValueAt(rowWeights, byteIndex * 2, function.ValueAt(codebook, low));
+                    function.SetValueAt(rowWeights, byteIndex * 2 + 1, function.ValueAt(codebook, high));
+                }
+            });
+
+            function.For(n, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar column) {
+                emitters::LLVMValue sum = nullptr;
+                if (contiguousColumns)
+                {
+                    sum = function.DotProduct(k, rowWeights, function.PointerOffset(pInput, column * (transposeInput ? ldb : 1)));
+                }
+                else
+                {
+                    auto accumulator = function.Variable(emitters::GetVariableType<ValueType>(), "sum");
+                    function.StoreZero(accumulator);
+                    function.For(k, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar inputRow) {
+                        auto product = function.LocalScalar(function.ValueAt(rowWeights, inputRow)) * function.LocalScalar(function.ValueAt(pInput, inputRow * ldb + column));
+                        function.OperationAndUpdate(accumulator, emitters::GetAddForValueType<ValueType>(), product);
+                    });
+                    sum = function.Load(accumulator);
+                }
+                CompileStoreResult(function, pOutput, epilogueConstants, row, column, function.LocalScalar(sum));
+            });
+        });
+    }
+
+    template <typename ValueType>
+    void PalettizedMatrixMultiplyNode<ValueType>::CompileStoreResult(emitters::IRFunctionEmitter& function, emitters::LLVMValue output, const typename OutputEpilogue<ValueType>::EmittedConstants& epilogueConstants, emitters::IRLocalScalar row, emitters::IRLocalScalar column, emitters::IRLocalScalar value)
+    {
+        if (!_epilogue.IsEmpty())
+        {
+            value = _epilogue.Compile(function, epilogueConstants, value, _transposeOutput ? row : column);
+        }
+        function.SetValueAt(output, _transposeOutput ? column * _ldc + row : row * _ldc + column, value);
+    }
+
+    template <typename ValueType>
+    void PalettizedMatrixMultiplyNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<PalettizedMatrixMultiplyNode<ValueType>>(newInput, *this);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void PalettizedMatrixMultiplyNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver[defaultOutputPortName] << _output;
+        archiver["m"] << _m;
+        archiver["n"] << _n;
+        archiver["k"] << _k;
+        archiver["ldb"] << _ldb;
+        archiver["ldc"] << _ldc;
+        archiver["transposeInput"] << _transposeInput;
+        archiver["transposeOutput"] << _transposeOutput;
+        archiver["indexBits"] << _indexBits;
+        archiver["codebook"] << _codebook;
+        archiver["packedIndices"] << std::vector<int>(_packedIndices.begin(), _packedIndices.end());
+        _epilogue.WriteToArchive(archiver);
+    }
+
+    template <typename ValueType>
+    void PalettizedMatrixMultiplyNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver[defaultOutputPortName] >> _output;
+        archiver["m"] >> _m;
+        archiver["n"] >> _n;
+        archiver["k"] >> _k;
+        archiver["ldb"] >> _ldb;
+        archiver["ldc"] >> _ldc;
+        archiver["transposeInput"] >> _transposeInput;
+        archiver["transposeOutput"] >> _transposeOutput;
+        archiver["indexBits"] >> _indexBits;
+        archiver["codebook"] >> _codebook;
+        std::vector<int> packedIndices;
+        archiver["packedIndices"] >> packedIndices;
+        _packedIndices.assign(packedIndices.begin(), packedIndices.end());
+        _epilogue.ReadFromArchive(archiver);
+    }
+
+    // Explicit instantiations
+    template class PalettizedMatrixMultiplyNode<float>;
+    template class PalettizedMatrixMultiplyNode<double>;
+} // namespace nodes
+} // namespace ell
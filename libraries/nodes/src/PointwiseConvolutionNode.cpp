@@ -0,0 +1,243 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PointwiseConvolutionNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PointwiseConvolutionNode.h"
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        using namespace ::ell::emitters;
+        using namespace ::ell::model;
+
+        // The number of output pixels computed together, so each weight is loaded once for all of them
+        const int c_pixelBlockSize = 4;
+
+        // Returns the memory offset of an entry, given its logical coordinates relative to the start of the active area
+        int GetMemoryOffset(const PortMemoryLayout& layout, int row, int column, int channel)
+        {
+            const auto& offset = layout.GetOffset();
+            const auto& increment = layout.GetCumulativeIncrement();
+            return (row + offset[0]) * increment[0] + (column + offset[1]) * increment[1] + (channel + offset[2]) * increment[2];
+        }
+    } // namespace
+
+    template <typename ValueType>
+    PointwiseConvolutionNode<ValueType>::PointwiseConvolutionNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    PointwiseConvolutionNode<ValueType>::PointwiseConvolutionNode(const model::OutputPort<ValueType>& input,
+                                                                  const model::PortMemoryLayout& inputMemoryLayout,
+                                                                  const model::PortMemoryLayout& outputMemoryLayout,
+                                                                  const ConstTensorReferenceType& filterWeights,
+                                                                  int stride) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, outputMemoryLayout),
+        _inputMemoryLayout(inputMemoryLayout),
+        _filterWeights(filterWeights),
+        _stride(stride)
+    {
+        VerifyLayouts();
+    }
+
+    template <typename ValueType>
+    void PointwiseConvolutionNode<ValueType>::VerifyLayouts() const
+    {
+        const auto outputLayout = GetOutputMemoryLayout();
+        if (!_inputMemoryLayout.IsCanonicalOrder() || !outputLayout.IsCanonicalOrder())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "PointwiseConvolutionNode: memory layouts must be in canonical order");
+        }
+
+        if (_filterWeights.NumColumns() != 1 || static_cast<int>(_filterWeights.NumChannels()) != _inputMemoryLayout.GetActiveSize(2) || static_cast<int>(_filterWeights.NumRows()) != outputLayout.GetActiveSize(2))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "PointwiseConvolutionNode: filter weights must be 1x1, with one filter per output channel");
+        }
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> PointwiseConvolutionNode<ValueType>::GetTransposedWeights() const
+    {
+        const int numFilters = static_cast<int>(_filterWeights.NumRows());
+        const int numChannels = static_cast<int>(_filterWeights.NumChannels());
+        std::vector<ValueType> result(numFilters * numChannels);
+        for (int filter = 0; filter < numFilters; ++filter)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                result[channel * numFilters + filter] = _filterWeights(filter, 0, channel);
+            }
+        }
+        return result;
+    }
+
+    template <typename ValueType>
+    void PointwiseConvolutionNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<PointwiseConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _stride);
+        transformer.MapNodeOutput(this->output, newNode->output);
+    }
+
+    template <typename ValueType>
+    int64_t PointwiseConvolutionNode<ValueType>::GetOperationCount() const
+    {
+        const int64_t numOutputs = GetOutputMemoryLayout().GetActiveSize().NumElements();
+        const int64_t numChannels = _filterWeights.NumChannels();
+        return 2 * numOutputs * numChannels;
+    }
+
+    template <typename ValueType>
+    void PointwiseConvolutionNode<ValueType>::Compute() const
+    {
+        const auto inputLayout = GetInputMemoryLayout();
+        const auto outputLayout = GetOutputMemoryLayout();
+        const int numFilters = static_cast<int>(_filterWeights.NumRows());
+        const int numChannels = static_cast<int>(_filterWeights.NumChannels());
+        const auto input = _input.GetValue();
+
+        std::vector<ValueType> output(outputLayout.GetMemorySize());
+        for (int row = 0; row < outputLayout.GetActiveSize(0); ++row)
+        {
+            for (int column = 0; column < outputLayout.GetActiveSize(1); ++column)
+            {
+                for (int filter = 0; filter < numFilters; ++filter)
+                {
+                    ValueType sum = 0;
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        sum += input[GetMemoryOffset(inputLayout, row * _stride, column * _stride, channel)] * _filterWeights(filter, 0, channel);
+                    }
+                    output[GetMemoryOffset(outputLayout, row, column, filter)] = sum;
+                }
+            }
+        }
+        _output.SetOutput(output);
+    }
+
+    template <typename ValueType>
+    void PointwiseConvolutionNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        auto defaultParallelizeValue = function.GetModule().GetCompilerOptions().parallelize;
+        auto parallelize = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("parallelize", defaultParallelizeValue);
+
+        auto options = function.GetCompilerOptions();
+        options.parallelize = parallelize;
+        function.SetCompilerOptions(options);
+
+        LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
+        LLVMValue pWeights = function.GetModule().ConstantArray(compiler.GetGlobalName(*this, "weights"), GetTransposedWeights());
+
+        const auto inputLayout = GetInputMemoryLayout();
+        const auto outputLayout = GetOutputMemoryLayout();
+        const int stride = _stride;
+        const int numFilters = static_cast<int>(_filterWeights.NumRows());
+        const int numChannels = static_cast<int>(_filterWeights.NumChannels());
+        const int outputColumns = outputLayout.GetActiveSize(1);
+        const int numPixelBlocks = outputColumns / c_pixelBlockSize;
+        const int numRemainingPixels = outputColumns % c_pixelBlockSize;
+
+        function.ParallelFor(outputLayout.GetActiveSize(0), { pInput, pWeights, pOutput }, [=](IRFunctionEmitter& function, IRLocalScalar outputRow, const std::vector<LLVMValue>& capturedValues) {
+            auto input = capturedValues[0];
+            auto weights = capturedValues[1];
+            auto output = capturedValues[2];
+
+            auto inputRowOffset = (outputRow * stride + inputLayout.GetOffset(0)) * static_cast<int>(inputLayout.GetCumulativeIncrement(0));
+            auto outputRowOffset = (outputRow + outputLayout.GetOffset(0)) * static_cast<int>(outputLayout.GetCumulativeIncrement(0));
+
+            // Computes `numPixels` adjacent output pixels: out[pixel, filter] = sum over channels of in[pixel, channel] * weights[channel, filter]
+            auto emitPixelBlock = [=](IRFunctionEmitter& function, IRLocalScalar firstColumn, int numPixels) {
+                std::vector<IRLocalScalar> inputOffsets;
+                std::vector<IRLocalScalar> outputOffsets;
+                for (int pixel = 0; pixel < numPixels; ++pixel)
+                {
+                    inputOffsets.push_back(inputRowOffset + ((firstColumn + pixel) * stride + inputLayout.GetOffset(1)) * static_cast<int>(inputLayout.GetCumulativeIncrement(1)) + inputLayout.GetOffset(2));
+                    outputOffsets.push_back(outputRowOffset + (firstColumn + pixel + outputLayout.GetOffset(1)) * static_cast<int>(outputLayout.GetCumulativeIncrement(1)) + outputLayout.GetOffset(2));
+                }
+
+                function.For(numFilters, [=](IRFunctionEmitter& function, IRLocalScalar filter) {
+                    for (int pixel = 0; pixel < numPixels; ++pixel)
+                    {
+                        function.SetValueAt(output, outputOffsets[pixel] + filter, function.LocalScalar(ValueType{ 0 }));
+                    }
+                });
+
+                function.For(numChannels, [=](IRFunctionEmitter& function, IRLocalScalar channel) {
+                    std::vector<IRLocalScalar> inputValues;
+                    for (int pixel = 0; pixel < numPixels; ++pixel)
+                    {
+                        inputValues.push_back(function.LocalScalar(function.ValueAt(input, inputOffsets[pixel] + channel)));
+                    }
+
+                    // The innermost loop runs over contiguous filters, in both the weights and the output
+                    auto weightsRowOffset = channel * numFilters;
+                    function.For(numFilters, [=](IRFunctionEmitter& function, IRLocalScalar filter) {
+                        auto weight = function.LocalScalar(function.ValueAt(weights, weightsRowOffset + filter));
+                        for (int pixel = 0; pixel < numPixels; ++pixel)
+                        {
+                            auto outputOffset = outputOffsets[pixel] + filter;
+                            auto sum = function.LocalScalar(function.ValueAt(output, outputOffset));
+                            function.SetValueAt(output, outputOffset, sum + inputValues[pixel] * weight);
+                        }
+                    });
+                });
+            };
+
+            if (numPixelBlocks > 0)
+            {
+                function.For(numPixelBlocks, [=](IRFunctionEmitter& function, IRLocalScalar block) {
+                    emitPixelBlock(function, block * c_pixelBlockSize, c_pixelBlockSize);
+                });
+            }
+            if (numRemainingPixels > 0)
+            {
+                emitPixelBlock(function, function.LocalScalar(numPixelBlocks * c_pixelBlockSize), numRemainingPixels);
+            }
+        });
+    }
+
+    template <typename ValueType>
+    void PointwiseConvolutionNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        model::CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["inputLayout"] << _inputMemoryLayout;
+        archiver["outputLayout"] << GetOutputMemoryLayout();
+        archiver["stride"] << _stride;
+        math::TensorArchiver::Write(_filterWeights, "weights", archiver);
+    }
+
+    template <typename ValueType>
+    void PointwiseConvolutionNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        model::CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["inputLayout"] >> _inputMemoryLayout;
+        model::PortMemoryLayout outputMemoryLayout;
+        archiver["outputLayout"] >> outputMemoryLayout;
+        _output.SetMemoryLayout(outputMemoryLayout);
+        archiver["stride"] >> _stride;
+        math::TensorArchiver::Read(_filterWeights, "weights", archiver);
+    }
+
+    // Explicit specializations
+    template class PointwiseConvolutionNode<float>;
+    template class PointwiseConvolutionNode<double>;
+} // namespace nodes
+} // namespace ell
@@ -9,9 +9,13 @@
 #include "PoolingLayerNode.h"
 #include "ConstantNode.h"
 
+#include <emitters/include/IRVectorUtilities.h>
+
 #include <predictors/neural/include/MaxPoolingFunction.h>
 #include <predictors/neural/include/MeanPoolingFunction.h>
 
+#include <algorithm>
+
 namespace ell
 {
 namespace nodes
@@ -74,145 +78,63 @@ namespace nodes
     } // end anonymous namespace
 
     //
-    // Note: the pooling function constructors take a `staticCount` parameter. This parameter
-    // tells how many valid data values the function will be evaluated over in order to compute
-    // the output of one pooling window. It's currently only used to determine the denominator for the
-    // mean pooling. The pooling functions are able to work in a mode where they know ahead of time
-    // how many values they'll be evaluated over, and also in a mode where they have to count it
-    // dynamically. If nonnegative, the `staticCount` parameter tells how many times the function
-    // will be called (via `Accumulate`) for one pooling window. If `staticCount` < 0, then the function
-    // operates in the dynamic mode where it keeps a count of the number of times its been called.
-
-    //
-    // MaxPoolingFunction
+    // Emitting helpers for the values of one channel or of a vector of `numLanes` consecutive channels
     //
-    template <typename ValueType>
-    class MaxPoolingFunction
+    template <typename ValueType, template <typename> class PoolingFunctionType>
+    constexpr bool IsMaxPooling()
     {
-    public:
-        MaxPoolingFunction(emitters::IRFunctionEmitter& function, int staticCount, ValueType paddingValue = 0)
-        {
-            auto valueType = emitters::GetVariableType<ValueType>();
-            _accumValueVar = function.Variable(valueType, "poolingAccumValue");
-            _paddingValue = function.LocalScalar<ValueType>(paddingValue);
-            _initialValue = function.LocalScalar<ValueType>(std::numeric_limits<ValueType>::lowest());
-            Reset(function, staticCount);
-        }
-
-        void Reset(emitters::IRFunctionEmitter& function, int count)
-        {
-            function.Store(_accumValueVar, _initialValue);
-        }
-
-        void Accumulate(emitters::IRFunctionEmitter& function, emitters::LLVMValue value)
-        {
-            function.If(emitters::TypedComparison::greaterThanFloat, value, function.Load(_accumValueVar), [this, value](emitters::IRFunctionEmitter& function) {
-                function.Store(_accumValueVar, value);
-            });
-        }
-
-        emitters::LLVMValue GetValueAtPadding(emitters::IRFunctionEmitter& function)
-        {
-            return _paddingValue;
-        }
+        return std::is_same<PoolingFunctionType<ValueType>, predictors::neural::MaxPoolingFunction<ValueType>>::value;
+    }
 
-        emitters::LLVMValue GetValue(emitters::IRFunctionEmitter& function)
-        {
-            return function.Load(_accumValueVar);
-        }
+    template <typename ValueType>
+    emitters::LLVMValue FillChannels(emitters::IRFunctionEmitter& function, ValueType value, int numLanes)
+    {
+        auto scalar = function.Literal<ValueType>(value);
+        return numLanes == 1 ? scalar : emitters::BroadcastVector(function, scalar, numLanes);
+    }
 
-    private:
-        emitters::LLVMValue _accumValueVar;
-        emitters::LLVMValue _initialValue;
-        emitters::LLVMValue _paddingValue;
-    };
+    template <typename ValueType>
+    emitters::LLVMValue LoadChannels(emitters::IRFunctionEmitter& function, emitters::LLVMValue buffer, emitters::IRLocalScalar index, int numLanes)
+    {
+        return numLanes == 1 ? function.ValueAt(buffer, index) : emitters::LoadUnalignedVector<ValueType>(function, buffer, index, numLanes);
+    }
 
-    //
-    // MeanPoolingFunction
-    //
     template <typename ValueType>
-    class MeanPoolingFunction
+    void StoreChannels(emitters::IRFunctionEmitter& function, emitters::LLVMValue buffer, emitters::IRLocalScalar index, emitters::LLVMValue value, int numLanes)
     {
-    public:
-        MeanPoolingFunction(emitters::IRFunctionEmitter& function, int staticCount, ValueType paddingValue = 0) :
-            _count(staticCount)
+        if (numLanes == 1)
         {
-            auto valueType = emitters::GetVariableType<ValueType>();
-            _paddingValue = function.LocalScalar(paddingValue);
-            _accumValueVar = function.Variable(valueType, "poolingAccumValue");
-            // if we don't know how many times we'll be called, create a variable (_countVar) to keep track
-            _countVar = staticCount < 0 ? function.Variable(emitters::VariableType::Int32, "poolingAccumCount") : nullptr;
-            Reset(function, staticCount);
+            function.SetValueAt(buffer, index, value);
         }
-
-        void Reset(emitters::IRFunctionEmitter& function, int staticCount)
+        else
         {
-            _count = staticCount;
-            function.StoreZero(_accumValueVar);
-            if (_countVar != nullptr)
-            {
-                function.StoreZero(_countVar);
-            }
+            emitters::StoreUnalignedVector<ValueType>(function, buffer, index, value);
         }
+    }
 
-        void Accumulate(emitters::IRFunctionEmitter& function, emitters::LLVMValue value)
-        {
-            const auto plusFloat = emitters::TypedOperator::addFloat;
-            function.OperationAndUpdate(_accumValueVar, plusFloat, value);
-            if (_countVar != nullptr)
-            {
-                const auto plus = emitters::TypedOperator::add;
-                function.OperationAndUpdate(_countVar, plus, function.Literal<int>(1));
-            }
-        }
+    // A branch-free maximum, so the channel loops stay straight-line code
+    emitters::LLVMValue MaxChannels(emitters::IRFunctionEmitter& function, emitters::LLVMValue a, emitters::LLVMValue b)
+    {
+        return function.Select(function.Comparison(emitters::TypedComparison::greaterThanFloat, a, b), a, b);
+    }
 
-        emitters::LLVMValue GetValueAtPadding(emitters::IRFunctionEmitter& function)
+    // Emits `body(function, channel, numLanes)` for vectors of `vectorSize` consecutive channels, then for the remaining channels one at a time
+    template <typename BodyFunction>
+    void ForEachChannelVector(emitters::IRFunctionEmitter& function, int numChannels, int vectorSize, BodyFunction body)
+    {
+        const int numVectors = vectorSize > 1 ? numChannels / vectorSize : 0;
+        if (numVectors > 0)
         {
-            assert(_countVar != nullptr && "GetValueAtPadding shouldn't be called for this pooling function");
-            return _paddingValue;
+            function.For(numVectors, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar vectorIndex) {
+                body(function, vectorIndex * vectorSize, vectorSize);
+            });
         }
-
-        emitters::LLVMValue GetValue(emitters::IRFunctionEmitter& function)
+        if (numVectors * vectorSize < numChannels)
         {
-            if (_countVar == nullptr)
-            {
-                return function.Operator(emitters::TypedOperator::divideFloat, function.Load(_accumValueVar), function.LocalScalar<ValueType>(_count));
-            }
-            else
-            {
-                return function.Operator(emitters::TypedOperator::divideFloat, function.Load(_accumValueVar), function.CastValue<ValueType>(function.Load(_countVar)));
-            }
+            function.For(numVectors * vectorSize, numChannels, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar channel) {
+                body(function, channel, 1);
+            });
         }
-
-    private:
-        emitters::LLVMValue _paddingValue;
-        emitters::LLVMValue _accumValueVar;
-        emitters::LLVMValue _countVar;
-        int _count;
-    };
-
-    // Silly type_traits-like thing to transform predictors::neural::MaxPoolingFunction -> MaxPoolingFunction
-    template <template <typename> class PoolingFunctionType, typename ValueType>
-    struct PoolingFunctionT
-    {
-    };
-
-    template <typename ValueType>
-    struct PoolingFunctionT<predictors::neural::MaxPoolingFunction, ValueType>
-    {
-        using type = MaxPoolingFunction<ValueType>;
-    };
-
-    template <typename ValueType>
-    struct PoolingFunctionT<predictors::neural::MeanPoolingFunction, ValueType>
-    {
-        using type = MeanPoolingFunction<ValueType>;
-    };
-
-    template <template <typename> class PoolingFunctionType, typename ValueType>
-    bool IsMaxPoolingFunction(const PoolingFunctionType<ValueType>& function)
-    {
-        return std::is_same<PoolingFunctionType<ValueType>, MaxPoolingFunction<ValueType>>();
     }
 
     //
@@ -220,41 +142,64 @@ namespace nodes
     //
 
     template <typename ValueType, template <typename> class PoolingFunctionType>
-    PoolingLayerNode<ValueType, PoolingFunctionType>::PoolingLayerNode(const model::OutputPort<ValueType>& input, const predictors::neural::PoolingLayer<ValueType, PoolingFunctionType>& layer) :
-        NeuralNetworkLayerNode<PoolingLayerNode<ValueType, PoolingFunctionType>, predictors::neural::PoolingLayer<ValueType, PoolingFunctionType>, ValueType>(input, layer)
+    PoolingLayerNode<ValueType, PoolingFunctionType>::PoolingLayerNode(const model::OutputPort<ValueType>& input, const predictors::neural::PoolingLayer<ValueType, PoolingFunctionType>& layer, bool rectifyInput) :
+        NeuralNetworkLayerNode<PoolingLayerNode<ValueType, PoolingFunctionType>, predictors::neural::PoolingLayer<ValueType, PoolingFunctionType>, ValueType>(input, layer),
+        _rectifyInput(rectifyInput)
+    {
+    }
+
+    template <typename ValueType, template <typename> class PoolingFunctionType>
+    void PoolingLayerNode<ValueType, PoolingFunctionType>::Compute() const
     {
+        if (!_rectifyInput)
+        {
+            BaseType::Compute();
+            return;
+        }
+
+        auto inputVector = this->_input.GetValue();
+        std::transform(inputVector.begin(), inputVector.end(), inputVector.begin(), [](ValueType x) { return std::max(x, static_cast<ValueType>(0)); });
+        auto inputTensor = typename LayerType::ConstTensorReferenceType{ inputVector.data(), this->_inputTensor.GetShape() };
+        this->_inputTensor.CopyFrom(inputTensor);
+        this->_layer.Compute();
+        this->_output.SetOutput(this->_layer.GetOutput().ToArray());
     }
 
-    // inputRow, inputColumn, and inputChannel
+    // Pools the window around (inputRow, inputColumn) of `numLanes` consecutive channels starting at inputChannel
     template <typename ValueType, template <typename> class PoolingFunctionType>
-    template <typename PoolingFunctionT>
     emitters::LLVMValue PoolingLayerNode<ValueType, PoolingFunctionType>::GetPoolingWindowValue(emitters::IRFunctionEmitter& function,
                                                                                                 int windowRowBegin,
                                                                                                 int windowRowEnd,
                                                                                                 int windowColumnBegin,
                                                                                                 int windowColumnEnd,
-                                                                                                emitters::LLVMValue inputRow,
-                                                                                                emitters::LLVMValue inputColumn,
-                                                                                                emitters::LLVMValue inputChannel,
+                                                                                                emitters::IRLocalScalar inputRow,
+                                                                                                emitters::IRLocalScalar inputColumn,
+                                                                                                emitters::IRLocalScalar inputChannel,
                                                                                                 emitters::LLVMValue inputBuffer,
                                                                                                 const model::MemoryShape& inputIncrement,
-                                                                                                PoolingFunctionT& poolingFunction)
+                                                                                                int numLanes)
     {
-        const auto plus = emitters::TypedOperator::add;
-        const auto times = emitters::TypedOperator::multiply;
+        constexpr bool isMaxPooling = IsMaxPooling<ValueType, PoolingFunctionType>();
+        const auto plus = emitters::GetAddForValueType<ValueType>();
 
         // Number of cells in this pooling window
         int numCells = (windowRowEnd - windowRowBegin) * (windowColumnEnd - windowColumnBegin);
-        poolingFunction.Reset(function, numCells);
 
-        // Window size and stride
+        // Window size
         auto poolingParameters = this->GetLayer().GetPoolingParameters();
         int windowSize = poolingParameters.poolingSize;
-
         bool hasFullWindow = (numCells == windowSize * windowSize);
-        if (!hasFullWindow && IsMaxPoolingFunction(poolingFunction))
+
+        // The max of rectified values is the max of the values and 0, so it starts from 0 instead of rectifying each value
+        emitters::LLVMValue result = nullptr;
+        if (isMaxPooling && _rectifyInput)
+        {
+            result = FillChannels<ValueType>(function, 0, numLanes);
+        }
+        if (isMaxPooling && !hasFullWindow)
         {
-            poolingFunction.Accumulate(function, poolingFunction.GetValueAtPadding(function));
+            auto paddingValue = FillChannels<ValueType>(function, predictors::neural::GetPaddingValue<ValueType>(this->GetLayer().GetLayerParameters().inputPaddingParameters.paddingScheme), numLanes);
+            result = result == nullptr ? paddingValue : MaxChannels(function, result, paddingValue);
         }
 
         // Double-loop to iterate over each entry in the pooling window. The middle of the window is (0,0)
@@ -262,20 +207,106 @@ namespace nodes
         {
             for (int poolingColumn = windowColumnBegin; poolingColumn < windowColumnEnd; ++poolingColumn)
             {
-                // poolingInputRow and poolingInputColumn are the coordinates of the input image value to
-                // accumulate for this entry in the pooling window
-                auto poolingInputRow = function.Operator(plus, inputRow, function.LocalScalar<int>(poolingRow));
-                auto poolingInputColumn = function.Operator(plus, inputColumn, function.LocalScalar<int>(poolingColumn));
-
-                // auto totalOffset = (offsetX * inputIncrement[0]) + (offsetY * inputIncrement[1]);
-                auto inputIndex = function.Operator(plus, function.Operator(plus, function.Operator(times, poolingInputRow, function.LocalScalar<int>(inputIncrement[0])), function.Operator(times, poolingInputColumn, function.LocalScalar<int>(inputIncrement[1]))), inputChannel);
-                auto value = function.ValueAt(inputBuffer, inputIndex);
-                poolingFunction.Accumulate(function, value);
+                auto inputIndex = (inputRow + poolingRow) * inputIncrement[0] + (inputColumn + poolingColumn) * inputIncrement[1] + inputChannel * inputIncrement[2];
+                auto value = LoadChannels<ValueType>(function, inputBuffer, inputIndex, numLanes);
+                if (isMaxPooling)
+                {
+                    result = result == nullptr ? value : MaxChannels(function, result, value);
+                }
+                else
+                {
+                    if (_rectifyInput)
+                    {
+                        value = MaxChannels(function, value, FillChannels<ValueType>(function, 0, numLanes));
+                    }
+                    result = result == nullptr ? value : function.Operator(plus, result, value);
+                }
             }
         }
 
-        auto value = poolingFunction.GetValue(function);
-        return value;
+        if (!isMaxPooling)
+        {
+            result = function.Operator(emitters::TypedOperator::divideFloat, result, FillChannels<ValueType>(function, static_cast<ValueType>(numCells), numLanes));
+        }
+        return result;
+    }
+
+    template <typename ValueType, template <typename> class PoolingFunctionType>
+    void PoolingLayerNode<ValueType, PoolingFunctionType>::CompileGlobalMeanPooling(emitters::IRFunctionEmitter& function, emitters::LLVMValue inputBuffer, emitters::LLVMValue outputBuffer, const model::MemoryShape& inputIncrement, const model::MemoryShape& outputIncrement, const model::MemoryShape& inputSize, int vectorSize)
+    {
+        const auto plus = emitters::GetAddForValueType<ValueType>();
+        const int inputRows = inputSize[0];
+        const int inputColumns = inputSize[1];
+        const int depth = inputSize[2];
+        const bool rectifyInput = _rectifyInput;
+
+        // Sum the pixels into the output in memory order, so the input is read once and in order
+        ForEachChannelVector(function, depth, vectorSize, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar channel, int numLanes) {
+            StoreChannels<ValueType>(function, outputBuffer, channel * outputIncrement[2], FillChannels<ValueType>(function, 0, numLanes), numLanes);
+        });
+        function.For(inputRows, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar row) {
+            function.For(inputColumns, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar column) {
+                auto pixelOffset = row * inputIncrement[0] + column * inputIncrement[1];
+                ForEachChannelVector(function, depth, vectorSize, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar channel, int numLanes) {
+                    emitters::LLVMValue value = LoadChannels<ValueType>(function, inputBuffer, pixelOffset + channel * inputIncrement[2], numLanes);
+                    if (rectifyInput)
+                    {
+                        value = MaxChannels(function, value, FillChannels<ValueType>(function, 0, numLanes));
+                    }
+                    auto outputIndex = channel * outputIncrement[2];
+                    StoreChannels<ValueType>(function, outputBuffer, outputIndex, function.Operator(plus, LoadChannels<ValueType>(function, outputBuffer, outputIndex, numLanes), value), numLanes);
+                });
+            });
+        });
+        ForEachChannelVector(function, depth, vectorSize, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar channel, int numLanes) {
+            auto outputIndex = channel * outputIncrement[2];
+            auto count = FillChannels<ValueType>(function, static_cast<ValueType>(inputRows * inputColumns), numLanes);
+            StoreChannels<ValueType>(function, outputBuffer, outputIndex, function.Operator(emitters::TypedOperator::divideFloat, LoadChannels<ValueType>(function, outputBuffer, outputIndex, numLanes), count), numLanes);
+        });
+    }
+
+    template <typename ValueType, template <typename> class PoolingFunctionType>
+    void PoolingLayerNode<ValueType, PoolingFunctionType>::CompileSeparableMaxPooling(emitters::IRFunctionEmitter& function, emitters::LLVMValue inputBuffer, emitters::LLVMValue outputBuffer, const model::MemoryShape& inputIncrement, const model::MemoryShape& outputIncrement, const model::MemoryShape& inputSize, int vectorSize)
+    {
+        auto poolingParameters = this->GetLayer().GetPoolingParameters();
+        const int stride = poolingParameters.stride;
+        const int windowSize = poolingParameters.poolingSize;
+        const int depth = inputSize[2];
+        const int outputRows = (inputSize[0] - windowSize) / stride + 1;
+        const int outputColumns = (inputSize[1] - windowSize) / stride + 1;
+        const int usedColumns = (outputColumns - 1) * stride + windowSize;
+        const bool rectifyInput = _rectifyInput;
+
+        // For each output row, the max over the window's rows of each input column, followed by the max over the
+        // window's columns of those: 2w comparisons per output instead of w^2
+        auto columnMaxima = function.Variable(emitters::GetVariableType<ValueType>(), usedColumns * depth);
+        function.For(outputRows, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar outputRow) {
+            auto firstRow = outputRow * stride;
+            function.For(usedColumns, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar column) {
+                ForEachChannelVector(function, depth, vectorSize, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar channel, int numLanes) {
+                    emitters::LLVMValue result = rectifyInput ? FillChannels<ValueType>(function, 0, numLanes) : nullptr;
+                    for (int windowRow = 0; windowRow < windowSize; ++windowRow)
+                    {
+                        auto value = LoadChannels<ValueType>(function, inputBuffer, (firstRow + windowRow) * inputIncrement[0] + column * inputIncrement[1] + channel * inputIncrement[2], numLanes);
+                        result = result == nullptr ? value : MaxChannels(function, result, value);
+                    }
+                    StoreChannels<ValueType>(function, columnMaxima, column * depth + channel, result, numLanes);
+                });
+            });
+
+            function.For(outputColumns, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar outputColumn) {
+                auto firstColumn = outputColumn * stride;
+                ForEachChannelVector(function, depth, vectorSize, [&](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar channel, int numLanes) {
+                    emitters::LLVMValue result = nullptr;
+                    for (int windowColumn = 0; windowColumn < windowSize; ++windowColumn)
+                    {
+                        auto value = LoadChannels<ValueType>(function, columnMaxima, (firstColumn + windowColumn) * depth + channel, numLanes);
+                        result = result == nullptr ? value : MaxChannels(function, result, value);
+                    }
+                    StoreChannels<ValueType>(function, outputBuffer, outputRow * outputIncrement[0] + outputColumn * outputIncrement[1] + channel * outputIncrement[2], result, numLanes);
+                });
+            });
+        });
     }
 
     /*
@@ -430,7 +461,6 @@ namespace nodes
         int outputRows = outputSize[0];
         int outputColumns = outputSize[1];
         int outputDepth = outputSize[2];
-        UNUSED(outputRows, outputColumns);
 
         if (inputDepth != outputDepth)
         {
@@ -442,11 +472,6 @@ namespace nodes
         int stride = poolingParameters.stride;
         int windowSize = poolingParameters.poolingSize;
 
-        // Create the pooling function
-        using FType = typename PoolingFunctionT<PoolingFunctionType, ValueType>::type;
-        auto paddingValue = ell::predictors::neural::GetPaddingValue<ValueType>(this->GetLayer().GetLayerParameters().inputPaddingParameters.paddingScheme);
-        FType poolingFunction{ function, windowSize * windowSize, paddingValue }; // Create the pooling function with a 'full' pooling window.
-
         // These "window extent" variables indicate the amount that the pooling window extends to the left and right (or top/bottom) of the center pixel.
         //   posWindowExtent is always floor(windowSize/2)
         //   If the pooling window size is odd, negWindowExtent == -posWindowExtent,
@@ -462,6 +487,21 @@ namespace nodes
         auto inputBuffer = function.PointerOffset(pInput, inputBufferOffset);
         auto outputBuffer = function.PointerOffset(pOutput, outputBufferOffset);
 
+        // Channels are pooled a vector at a time when they're contiguous in both the input and the output
+        const int vectorSize = inputIncrement[2] == 1 && outputIncrement[2] == 1 ? emitters::GetReductionVectorSize(function.GetCompilerOptions()) : 1;
+
+        constexpr bool isMaxPooling = IsMaxPooling<ValueType, PoolingFunctionType>();
+        if (!isMaxPooling && !usesPadding && windowSize == inputRows && windowSize == inputColumns && outputRows == 1 && outputColumns == 1)
+        {
+            CompileGlobalMeanPooling(function, inputBuffer, outputBuffer, inputIncrement, outputIncrement, inputSize, vectorSize);
+            return;
+        }
+        if (isMaxPooling && !usesPadding && windowSize > stride + 1)
+        {
+            CompileSeparableMaxPooling(function, inputBuffer, outputBuffer, inputIncrement, outputIncrement, inputSize, vectorSize);
+            return;
+        }
+
         // Divide the output into regions that have different support over the pooling window. There are `windowSize` regions in each dimension.
         for (int rowsRegion = negWindowExtent; rowsRegion <= posWindowExtent; ++rowsRegion)
         {
@@ -483,7 +523,7 @@ namespace nodes
                 if (maxOutputRow > minOutputRow && maxOutputCol > minOutputCol)
                 {
                     // BUG: explicit by-ref captures of `usesPadding` and `negWindowExtent` are here to work around a GCC bug
-                    function.For(minOutputRow, maxOutputRow, 1, [=, &outputIncrement, &usesPadding, &negWindowExtent, &poolingFunction](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex1) {
+                    function.For(minOutputRow, maxOutputRow, 1, [=, &outputIncrement, &usesPadding, &negWindowExtent](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex1) {
                         auto outputRow = function.LocalScalar(loopIndex1);
                         auto inputRow = outputRow * function.LocalScalar<int>(stride);
                         if (!usesPadding)
@@ -491,7 +531,7 @@ namespace nodes
                             inputRow = inputRow + function.LocalScalar<int>(-negWindowExtent);
                         }
 
-                        function.For(minOutputCol, maxOutputCol, 1, [=, &outputIncrement, &poolingFunction, &inputRow](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex2) {
+                        function.For(minOutputCol, maxOutputCol, 1, [=, &outputIncrement, &inputRow](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex2) {
                             auto outputColumn = function.LocalScalar(loopIndex2);
                             auto inputColumn = outputColumn * function.LocalScalar<int>(stride);
                             if (!usesPadding)
@@ -499,15 +539,12 @@ namespace nodes
                                 inputColumn = inputColumn + function.LocalScalar<int>(-negWindowExtent);
                             }
 
-                            function.For(outputDepth, [=, &outputIncrement, &poolingFunction, &inputRow, &inputColumn](emitters::IRFunctionEmitter& function, emitters::LLVMValue loopIndex3) {
-                                auto channel = function.LocalScalar(loopIndex3);
+                            ForEachChannelVector(function, outputDepth, vectorSize, [=, &outputIncrement, &inputRow, &inputColumn](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar channel, int numLanes) {
                                 // Get the pooled value
-                                auto pooledValue = GetPoolingWindowValue(function, rowRegionBounds.windowBounds.begin, rowRegionBounds.windowBounds.end, columnRegionBounds.windowBounds.begin, columnRegionBounds.windowBounds.end, inputRow, inputColumn, channel, inputBuffer, inputIncrement, poolingFunction);
+                                auto pooledValue = GetPoolingWindowValue(function, rowRegionBounds.windowBounds.begin, rowRegionBounds.windowBounds.end, columnRegionBounds.windowBounds.begin, columnRegionBounds.windowBounds.end, inputRow, inputColumn, channel, inputBuffer, inputIncrement, numLanes);
                                 // and store it in the output
-                                auto outputIndex = (outputRow * function.LocalScalar<int>(outputIncrement[0])) +
-                                                   (outputColumn * function.LocalScalar<int>(outputIncrement[1])) +
-                                                   channel;
-                                function.SetValueAt(outputBuffer, outputIndex, pooledValue);
+                                auto outputIndex = (outputRow * outputIncrement[0]) + (outputColumn * outputIncrement[1]) + (channel * outputIncrement[2]);
+                                StoreChannels<ValueType>(function, outputBuffer, outputIndex, pooledValue, numLanes);
                             });
                         });
                     });
@@ -520,16 +557,25 @@ namespace nodes
     void PoolingLayerNode<ValueType, PoolingFunctionType>::Copy(model::ModelTransformer& transformer) const
     {
         const auto& newInputs = transformer.GetCorrespondingInputs(this->_input);
-        auto newNode = transformer.AddNode<PoolingLayerNode<ValueType, PoolingFunctionType>>(newInputs, this->_layer);
+        auto newNode = transformer.AddNode<PoolingLayerNode<ValueType, PoolingFunctionType>>(newInputs, this->_layer, _rectifyInput);
         transformer.MapNodeOutput(this->_output, newNode->output);
     }
 
-    // Explicit specialization
-    template class MeanPoolingFunction<float>;
-    template class MeanPoolingFunction<double>;
-    template class MaxPoolingFunction<float>;
-    template class MaxPoolingFunction<double>;
+    template <typename ValueType, template <typename> class PoolingFunctionType>
+    void PoolingLayerNode<ValueType, PoolingFunctionType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        BaseType::WriteToArchive(archiver);
+        archiver["rectifyInput"] << _rectifyInput;
+    }
+
+    template <typename ValueType, template <typename> class PoolingFunctionType>
+    void PoolingLayerNode<ValueType, PoolingFunctionType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        BaseType::ReadFromArchive(archiver);
+        archiver.OptionalProperty("rectifyInput", false) >> _rectifyInput;
+    }
 
+    // Explicit specialization
     template class PoolingLayerNode<float, ell::predictors::neural::MeanPoolingFunction>;
     template class PoolingLayerNode<double, ell::predictors::neural::MeanPoolingFunction>;
     template class PoolingLayerNode<float, ell::predictors::neural::MaxPoolingFunction>;
@@ -1,7 +1,7 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  Project:  Embedded Learning Library (ELL)
-//  File:     ProjectionPredictorNode.cpp (nodes)
+//  File:     ProtoNNPredictorNode.cpp (nodes)
 //  Authors:  Suresh Iyengar
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -20,6 +20,8 @@
 
 #include <data/include/DenseDataVector.h>
 
+#include <emitters/include/IRMath.h>
+
 #include <functional>
 #include <string>
 #include <vector>
@@ -29,14 +31,14 @@ namespace ell
 namespace nodes
 {
     ProtoNNPredictorNode::ProtoNNPredictorNode() :
-        Node({ &_input }, { &_output }),
+        CompilableNode({ &_input }, { &_output }),
         _input(this, {}, defaultInputPortName),
         _output(this, defaultOutputPortName, 0)
     {
     }
 
     ProtoNNPredictorNode::ProtoNNPredictorNode(const model::OutputPort<double>& input, const predictors::ProtoNNPredictor& predictor) :
-        Node({ &_input }, { &_output }),
+        CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, predictor.GetNumLabels()),
         _predictor(predictor)
@@ -49,7 +51,7 @@ namespace nodes
 
     void ProtoNNPredictorNode::WriteToArchive(utilities::Archiver& archiver) const
     {
-        Node::WriteToArchive(archiver);
+        CompilableNode::WriteToArchive(archiver);
         archiver[defaultInputPortName] << _input;
         archiver[defaultOutputPortName] << _output;
         archiver["predictor"] << _predictor;
@@ -57,7 +59,7 @@ namespace nodes
 
     void ProtoNNPredictorNode::ReadFromArchive(utilities::Unarchiver& archiver)
     {
-        Node::ReadFromArchive(archiver);
+        CompilableNode::ReadFromArchive(archiver);
         archiver[defaultInputPortName] >> _input;
         archiver[defaultOutputPortName] >> _output;
         archiver["predictor"] >> _predictor;
@@ -111,6 +113,105 @@ namespace nodes
         _output.SetOutput(prediction.ToArray());
     }
 
+    void ProtoNNPredictorNode::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        const int dimension = static_cast<int>(_predictor.GetDimension());
+        const int projectedDimension = static_cast<int>(_predictor.GetProjectedDimension());
+        const int numPrototypes = static_cast<int>(_predictor.GetNumPrototypes());
+        const int numLabels = static_cast<int>(_predictor.GetNumLabels());
+        const double gamma = _predictor.GetGamma();
+
+        auto& module = function.GetModule();
+        auto pInput = compiler.EnsurePortEmitted(input);
+        auto pOutput = compiler.EnsurePortEmitted(output);
+        auto pProjectionWeights = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "projection"), GetProjectionWeights()), 0);
+        auto pPrototypes = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "prototypes"), GetScaledPrototypes()), 0);
+        auto pPrototypeOffsets = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "prototypeOffsets"), GetPrototypeOffsets()), 0);
+        auto pLabelEmbeddings = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "labelEmbeddings"), GetLabelEmbeddingWeights()), 0);
+
+        // p = W * x
+        auto projectedInput = function.Variable(emitters::VariableType::Double, projectedDimension);
+        function.CallGEMV<double>(projectedDimension, dimension, pProjectionWeights, dimension, pInput, 1, projectedInput, 1);
+
+        // -gamma^2 * |b_j - p|^2 = -gamma^2 * |b_j|^2 - gamma^2 * |p|^2 + 2 * gamma^2 * (b_j . p)
+        // The first term is a constant, so all the exponents come from one GEMV that accumulates onto the first two terms.
+        auto inputOffset = function.LocalScalar(-gamma * gamma) * function.LocalScalar(function.DotProduct(projectedDimension, projectedInput, projectedInput));
+        auto exponents = function.LocalArray(function.Variable(emitters::VariableType::Double, numPrototypes));
+        auto prototypeOffsets = function.LocalArray(pPrototypeOffsets);
+        function.For(numPrototypes, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+            exponents[index] = prototypeOffsets[index] + inputOffset;
+        });
+        function.CallGEMV<double>(numPrototypes, projectedDimension, 1.0, pPrototypes, projectedDimension, projectedInput, 1, 1.0, exponents, 1);
+
+        // Rounding in the expansion above can make a tiny distance negative; clamp it so the similarity stays at most 1
+        function.For(numPrototypes, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+            exponents[index] = emitters::Exp(emitters::Min(exponents[index], 0.0));
+        });
+
+        // scores = Z * similarities
+        function.CallGEMV<double>(numLabels, numPrototypes, pLabelEmbeddings, numPrototypes, exponents, 1, pOutput, 1);
+    }
+
+    std::vector<double> ProtoNNPredictorNode::GetProjectionWeights() const
+    {
+        const auto& W = _predictor.GetProjectionMatrix();
+        std::vector<double> result;
+        result.reserve(W.Size());
+        for (size_t row = 0; row < W.NumRows(); ++row)
+        {
+            for (size_t column = 0; column < W.NumColumns(); ++column)
+            {
+                result.push_back(W(row, column));
+            }
+        }
+        return result;
+    }
+
+    std::vector<double> ProtoNNPredictorNode::GetScaledPrototypes() const
+    {
+        // One row per prototype
+        const auto& B = _predictor.GetPrototypes();
+        const auto scale = 2 * _predictor.GetGamma() * _predictor.GetGamma();
+        std::vector<double> result;
+        result.reserve(B.Size());
+        for (size_t prototype = 0; prototype < B.NumColumns(); ++prototype)
+        {
+            for (size_t row = 0; row < B.NumRows(); ++row)
+            {
+                result.push_back(scale * B(row, prototype));
+            }
+        }
+        return result;
+    }
+
+    std::vector<double> ProtoNNPredictorNode::GetPrototypeOffsets() const
+    {
+        const auto& B = _predictor.GetPrototypes();
+        const auto gamma = _predictor.GetGamma();
+        std::vector<double> result;
+        result.reserve(B.NumColumns());
+        for (size_t prototype = 0; prototype < B.NumColumns(); ++prototype)
+        {
+            result.push_back(-gamma * gamma * B.GetColumn(prototype).Norm2Squared());
+        }
+        return result;
+    }
+
+    std::vector<double> ProtoNNPredictorNode::GetLabelEmbeddingWeights() const
+    {
+        const auto& Z = _predictor.GetLabelEmbeddings();
+        std::vector<double> result;
+        result.reserve(Z.Size());
+        for (size_t row = 0; row < Z.NumRows(); ++row)
+        {
+            for (size_t column = 0; column < Z.NumColumns(); ++column)
+            {
+                result.push_back(Z(row, column));
+            }
+        }
+        return result;
+    }
+
     ProtoNNPredictorNode* AddNodeToModelTransformer(const model::PortElements<double>& input, const predictors::ProtoNNPredictor& predictor, model::ModelTransformer& transformer)
     {
         return transformer.AddNode<ProtoNNPredictorNode>(input, predictor);
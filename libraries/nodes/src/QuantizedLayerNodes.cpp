@@ -0,0 +1,965 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     QuantizedLayerNodes.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "QuantizedLayerNodes.h"
+
+#include <emitters/include/EmitterTypes.h>
+#include <emitters/include/IRMath.h>
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        using namespace ::ell::emitters;
+
+        const int c_maxQuantizedValue = 127;
+
+        // The emitted code performs exactly the same sequence of operations, so compiled and computed results match
+        template <typename ValueType>
+        int8_t QuantizeValue(ValueType value, ValueType inverseScale)
+        {
+            auto scaled = std::max(std::min(value * inverseScale, static_cast<ValueType>(c_maxQuantizedValue)), static_cast<ValueType>(-c_maxQuantizedValue));
+            scaled += scaled >= 0 ? static_cast<ValueType>(0.5) : static_cast<ValueType>(-0.5);
+            return static_cast<int8_t>(scaled);
+        }
+
+        // Quantizes each row of a row-major matrix symmetrically, so that its largest-magnitude entry maps to +/-127
+        template <typename ValueType>
+        std::vector<ValueType> QuantizeRows(const std::vector<ValueType>& values, size_t numRows, std::vector<int8_t>& quantizedValues)
+        {
+            const auto rowSize = values.size() / numRows;
+            std::vector<ValueType> scales(numRows);
+            quantizedValues.resize(values.size());
+            for (size_t row = 0; row < numRows; ++row)
+            {
+                auto rowBegin = values.begin() + row * rowSize;
+                ValueType maxAbsValue = 0;
+                std::for_each(rowBegin, rowBegin + rowSize, [&maxAbsValue](ValueType value) { maxAbsValue = std::max(maxAbsValue, std::abs(value)); });
+
+                scales[row] = maxAbsValue > 0 ? maxAbsValue / c_maxQuantizedValue : 1;
+                const ValueType inverseScale = 1 / scales[row];
+                std::transform(rowBegin, rowBegin + rowSize, quantizedValues.begin() + row * rowSize, [inverseScale](ValueType value) { return QuantizeValue(value, inverseScale); });
+            }
+            return scales;
+        }
+
+        // The factor that converts an int32 accumulator for each output channel back to ValueType
+        template <typename ValueType>
+        std::vector<ValueType> GetOutputScales(const std::vector<ValueType>& weightScales, ValueType inputScale)
+        {
+            std::vector<ValueType> result(weightScales.size());
+            std::transform(weightScales.begin(), weightScales.end(), result.begin(), [inputScale](ValueType scale) { return inputScale * scale; });
+            return result;
+        }
+
+        template <typename ValueType>
+        std::vector<int8_t> QuantizeValues(const std::vector<ValueType>& values, ValueType inputScale)
+        {
+            const ValueType inverseScale = 1 / inputScale;
+            std::vector<int8_t> result(values.size());
+            std::transform(values.begin(), values.end(), result.begin(), [inverseScale](ValueType value) { return QuantizeValue(value, inverseScale); });
+            return result;
+        }
+
+        int32_t Int8DotProduct(const int8_t* a, const int8_t* b, size_t size)
+        {
+            int32_t result = 0;
+            for (size_t index = 0; index < size; ++index)
+            {
+                result += static_cast<int32_t>(a[index]) * static_cast<int32_t>(b[index]);
+            }
+            return result;
+        }
+
+        // The recurrent layers evaluate tanh by linear interpolation between c_activationTableSize + 1 evenly spaced
+        // points in [-c_activationTableRange, c_activationTableRange], which is within 4e-4 of tanh everywhere,
+        // and sigmoid(x) as (1 + tanh(x/2)) / 2
+        const int c_activationTableSize = 256;
+        const int c_activationTableRange = 8;
+
+        template <typename ValueType>
+        std::vector<ValueType> GetTanhTable()
+        {
+            std::vector<ValueType> result(c_activationTableSize + 1);
+            for (int index = 0; index <= c_activationTableSize; ++index)
+            {
+                result[index] = static_cast<ValueType>(std::tanh(-c_activationTableRange + index * (2.0 * c_activationTableRange / c_activationTableSize)));
+            }
+            return result;
+        }
+
+        template <typename ValueType>
+        ValueType TableTanh(const std::vector<ValueType>& table, ValueType x)
+        {
+            const auto range = static_cast<ValueType>(c_activationTableRange);
+            auto position = (std::max(std::min(x, range), -range) + range) * static_cast<ValueType>(c_activationTableSize / (2 * c_activationTableRange));
+            auto index = std::min(static_cast<int>(position), c_activationTableSize - 1);
+            auto fraction = position - static_cast<ValueType>(index);
+            return table[index] + fraction * (table[index + 1] - table[index]);
+        }
+
+        template <typename ValueType>
+        ValueType TableSigmoid(const std::vector<ValueType>& table, ValueType x)
+        {
+            const auto half = static_cast<ValueType>(0.5);
+            return half + half * TableTanh(table, half * x);
+        }
+
+        void WriteQuantizedValues(utilities::Archiver& archiver, const std::string& name, const std::vector<int8_t>& values)
+        {
+            archiver[name] << std::vector<int>(values.begin(), values.end());
+        }
+
+        void ReadQuantizedValues(utilities::Unarchiver& archiver, const std::string& name, std::vector<int8_t>& values)
+        {
+            std::vector<int> intValues;
+            archiver[name] >> intValues;
+            values.assign(intValues.begin(), intValues.end());
+        }
+
+        //
+        // Low-level code-generation
+        //
+
+        llvm::GlobalVariable* EmitQuantizedWeights(IRFunctionEmitter& function, const std::string& name, const std::vector<int8_t>& weights)
+        {
+            return function.GetModule().ConstantArray(name, std::vector<char>(weights.begin(), weights.end()));
+        }
+
+        template <typename ValueType>
+        LLVMValue EmitQuantizeValue(IRFunctionEmitter& function, IRLocalScalar value, ValueType inverseScale)
+        {
+            auto scaled = value * inverseScale;
+            scaled = Max(Min(scaled, static_cast<ValueType>(c_maxQuantizedValue)), static_cast<ValueType>(-c_maxQuantizedValue));
+            auto rounding = function.Select(scaled >= static_cast<ValueType>(0), function.Literal(static_cast<ValueType>(0.5)), function.Literal(static_cast<ValueType>(-0.5)));
+            return function.CastValue<char>(scaled + rounding);
+        }
+
+        template <typename ValueType>
+        void EmitQuantizeValues(IRFunctionEmitter& function, LLVMValue input, int size, ValueType inputScale, LLVMValue result)
+        {
+            const ValueType inverseScale = 1 / inputScale;
+            function.For(size, [input, inverseScale, result](IRFunctionEmitter& function, IRLocalScalar index) {
+                function.SetValueAt(result, index, EmitQuantizeValue(function, function.LocalScalar(function.ValueAt(input, index)), inverseScale));
+            });
+        }
+
+        // Adds the dot product of two int8 vectors to a 32-bit accumulator with the SMLAD instruction of the ARM DSP extension,
+        // which multiplies two pairs of 16-bit values and adds both products. Four values are loaded at once, and SXTB16
+        // sign-extends their even bytes, and then their odd bytes rotated into place, into pairs of 16-bit values.
+        void EmitInt8DotProductDsp(IRFunctionEmitter& function, int size, LLVMValue a, IRLocalScalar aOffset, LLVMValue b, IRLocalScalar bOffset, LLVMValue accumulator)
+        {
+            auto& module = function.GetModule();
+            auto sxtb16 = module.GetIntrinsic(llvm::Intrinsic::arm_sxtb16, std::initializer_list<LLVMType>{});
+            auto smlad = module.GetIntrinsic(llvm::Intrinsic::arm_smlad, std::initializer_list<LLVMType>{});
+
+            const int numQuads = size / 4;
+            function.For(numQuads, [=](IRFunctionEmitter& function, IRLocalScalar quad) {
+                auto& irBuilder = function.GetEmitter().GetIRBuilder();
+                auto loadQuad = [&](LLVMValue values, IRLocalScalar offset) -> LLVMValue {
+                    // The quads of a window row aren't 4-byte aligned, which the Cortex-M4 and M7 allow for single loads
+                    auto address = function.CastPointer(function.PointerOffset(values, offset + quad * 4), VariableType::Int32);
+                    return irBuilder.CreateAlignedLoad(address, 1);
+                };
+                auto rotate = [&](LLVMValue value) -> LLVMValue {
+                    return irBuilder.CreateOr(irBuilder.CreateLShr(value, 8), irBuilder.CreateShl(value, 24));
+                };
+
+                auto x = loadQuad(a, aOffset);
+                auto y = loadQuad(b, bOffset);
+                LLVMValue sum = function.Load(accumulator);
+                sum = function.Call(smlad, { function.Call(sxtb16, { x }), function.Call(sxtb16, { y }), sum });
+                sum = function.Call(smlad, { function.Call(sxtb16, { rotate(x) }), function.Call(sxtb16, { rotate(y) }), sum });
+                function.Store(accumulator, sum);
+            });
+
+            function.For(numQuads * 4, size, [a, aOffset, b, bOffset, accumulator](IRFunctionEmitter& function, IRLocalScalar index) {
+                auto x = function.LocalScalar(function.CastValue<int>(function.ValueAt(a, aOffset + index)));
+                auto y = function.LocalScalar(function.CastValue<int>(function.ValueAt(b, bOffset + index)));
+                function.OperationAndUpdate(accumulator, TypedOperator::add, x * y);
+            });
+        }
+
+        // Adds the dot product of two int8 vectors to a 32-bit accumulator. With the `useCmsis` option, this calls CMSIS-DSP;
+        // on targets with the ARM DSP extension it uses SMLAD; otherwise the loop is tagged so that the optimizer vectorizes
+        // it into widening multiply-adds on the target (e.g., pmaddwd on x86 or smlal on ARM).
+        void EmitInt8DotProduct(IRFunctionEmitter& function, int size, LLVMValue a, IRLocalScalar aOffset, LLVMValue b, IRLocalScalar bOffset, LLVMValue accumulator)
+        {
+            const auto& compilerOptions = function.GetCompilerOptions();
+            if (compilerOptions.useCmsis)
+            {
+                auto& module = function.GetModule();
+                auto result = function.Variable(VariableType::Int32, "dotProduct");
+                function.Call(module.GetRuntime().GetCmsisDotProductQ7Function(), { function.PointerOffset(a, aOffset), function.PointerOffset(b, bOffset), function.Literal<int>(size), result });
+                function.OperationAndUpdate(accumulator, TypedOperator::add, function.Load(result));
+                return;
+            }
+
+            if (compilerOptions.targetDevice.HasDspExtension())
+            {
+                EmitInt8DotProductDsp(function, size, a, aOffset, b, bOffset, accumulator);
+                return;
+            }
+
+            auto body = [a, aOffset, b, bOffset, accumulator](IRFunctionEmitter& function, IRLocalScalar index) {
+                auto x = function.LocalScalar(function.CastValue<int>(function.ValueAt(a, aOffset + index)));
+                auto y = function.LocalScalar(function.CastValue<int>(function.ValueAt(b, bOffset + index)));
+                function.OperationAndUpdate(accumulator, TypedOperator::add, x * y);
+            };
+
+            if (compilerOptions.allowVectorInstructions && compilerOptions.vectorWidth > 1)
+            {
+                // vectorWidth counts 32-bit lanes, and a register of the same width holds four times as many int8 values
+                function.VectorizedFor(function.Literal<int>(0), function.Literal<int>(size), 4 * compilerOptions.vectorWidth, body);
+            }
+            else
+            {
+                function.For(size, body);
+            }
+        }
+
+        // The tables are the same for every node, so the nodes of a module share one copy
+        template <typename ValueType>
+        LLVMValue EmitTanhTable(IRFunctionEmitter& function)
+        {
+            auto name = "quantizedTanhTable_" + utilities::TypeName<ValueType>::GetName();
+            auto& module = function.GetModule();
+            auto table = module.GetLLVMModule()->getNamedGlobal(name);
+            if (table == nullptr)
+            {
+                table = module.ConstantArray(name, GetTanhTable<ValueType>());
+            }
+            return function.PointerOffset(table, 0);
+        }
+
+        // Emits the same operations as TableTanh
+        template <typename ValueType>
+        IRLocalScalar EmitTableTanh(IRFunctionEmitter& function, LLVMValue table, IRLocalScalar x)
+        {
+            const auto range = static_cast<ValueType>(c_activationTableRange);
+            auto position = (Max(Min(x, range), -range) + range) * static_cast<ValueType>(c_activationTableSize / (2 * c_activationTableRange));
+            auto index = Min(function.LocalScalar(function.CastValue<int>(position)), c_activationTableSize - 1);
+            auto fraction = position - function.LocalScalar(function.CastValue<ValueType>(index));
+            auto y0 = function.LocalScalar(function.ValueAt(table, index));
+            auto y1 = function.LocalScalar(function.ValueAt(table, index + 1));
+            return y0 + fraction * (y1 - y0);
+        }
+
+        template <typename ValueType>
+        IRLocalScalar EmitTableSigmoid(IRFunctionEmitter& function, LLVMValue table, IRLocalScalar x)
+        {
+            const auto half = static_cast<ValueType>(0.5);
+            return half + half * EmitTableTanh<ValueType>(function, table, half * x);
+        }
+    } // namespace
+
+    //
+    // QuantizedConvolutionalLayerNode
+    //
+
+    template <typename ValueType>
+    QuantizedConvolutionalLayerNode<ValueType>::QuantizedConvolutionalLayerNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    QuantizedConvolutionalLayerNode<ValueType>::QuantizedConvolutionalLayerNode(const model::OutputPort<ValueType>& input,
+                                                                                const model::PortMemoryLayout& inputMemoryLayout,
+                                                                                const model::PortMemoryLayout& outputMemoryLayout,
+                                                                                const ConstTensorReferenceType& filterWeights,
+                                                                                int stride,
+                                                                                ValueType inputScale) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, outputMemoryLayout),
+        _inputMemoryLayout(inputMemoryLayout),
+        _inputScale(inputScale),
+        _filterSize(static_cast<int>(filterWeights.NumColumns())),
+        _stride(stride)
+    {
+        const auto numFilters = filterWeights.NumRows() / filterWeights.NumColumns();
+        _weightScales = QuantizeRows(filterWeights.ReferenceAsMatrix().ToArray(), numFilters, _weights);
+
+        if (static_cast<int>(filterWeights.NumChannels()) != inputMemoryLayout.GetLogicalDimensionActiveSize(2) || static_cast<int>(numFilters) != outputMemoryLayout.GetLogicalDimensionActiveSize(2))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "QuantizedConvolutionalLayerNode: filter weights don't match the input and output channels");
+        }
+        if (inputMemoryLayout.GetLogicalDimensionOffset(0) < _filterSize / 2 || inputMemoryLayout.GetLogicalDimensionOffset(1) < _filterSize / 2)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "QuantizedConvolutionalLayerNode: input padding must be at least filterSize/2");
+        }
+        if (inputMemoryLayout.GetLogicalDimensionIncrement(2) != 1)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "QuantizedConvolutionalLayerNode: input must be in row-major order");
+        }
+    }
+
+    template <typename ValueType>
+    QuantizedConvolutionalLayerNode<ValueType>::QuantizedConvolutionalLayerNode(const model::OutputPort<ValueType>& input,
+                                                                                const model::PortMemoryLayout& inputMemoryLayout,
+                                                                                const model::PortMemoryLayout& outputMemoryLayout,
+                                                                                const std::vector<int8_t>& weights,
+                                                                                const std::vector<ValueType>& weightScales,
+                                                                                int filterSize,
+                                                                                int stride,
+                                                                                ValueType inputScale) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, outputMemoryLayout),
+        _inputMemoryLayout(inputMemoryLayout),
+        _weights(weights),
+        _weightScales(weightScales),
+        _inputScale(inputScale),
+        _filterSize(filterSize),
+        _stride(stride)
+    {
+    }
+
+    template <typename ValueType>
+    void QuantizedConvolutionalLayerNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<QuantizedConvolutionalLayerNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _weights, _weightScales, _filterSize, _stride, _inputScale);
+        transformer.MapNodeOutput(this->output, newNode->output);
+    }
+
+    template <typename ValueType>
+    int64_t QuantizedConvolutionalLayerNode<ValueType>::GetOperationCount() const
+    {
+        const int64_t numOutputs = GetOutputMemoryLayout().GetActiveSize().NumElements();
+        const int64_t numChannels = _inputMemoryLayout.GetLogicalDimensionActiveSize(2);
+        return 2 * numOutputs * _filterSize * _filterSize * numChannels;
+    }
+
+    template <typename ValueType>
+    int64_t QuantizedConvolutionalLayerNode<ValueType>::GetBytesRead() const
+    {
+        return CompilableNode::GetBytesRead() + _weights.size() * sizeof(int8_t) + _weightScales.size() * sizeof(ValueType);
+    }
+
+    template <typename ValueType>
+    void QuantizedConvolutionalLayerNode<ValueType>::Compute() const
+    {
+        const auto quantizedInput = QuantizeValues(_input.GetValue(), _inputScale);
+        const auto outputScales = GetOutputScales(_weightScales, _inputScale);
+        const auto inputLayout = GetInputMemoryLayout();
+        const auto outputLayout = GetOutputMemoryLayout();
+
+        const auto numChannels = inputLayout.GetLogicalDimensionActiveSize(2);
+        const auto numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
+        const auto filterVolume = _filterSize * _filterSize * numChannels;
+        const auto inputIncrement = inputLayout.GetLogicalDimensionIncrement();
+        const auto outputIncrement = outputLayout.GetLogicalDimensionIncrement();
+        const auto inputOrigin = (inputLayout.GetLogicalDimensionOffset(0) - _filterSize / 2) * inputIncrement[0] +
+                                 (inputLayout.GetLogicalDimensionOffset(1) - _filterSize / 2) * inputIncrement[1] +
+                                 inputLayout.GetLogicalDimensionOffset(2) * inputIncrement[2];
+        const auto outputOrigin = outputLayout.GetLogicalEntryOffset({ 0, 0, 0 });
+
+        std::vector<ValueType> outputValues(outputLayout.GetMemorySize());
+        for (int row = 0; row < outputLayout.GetLogicalDimensionActiveSize(0); ++row)
+        {
+            for (int column = 0; column < outputLayout.GetLogicalDimensionActiveSize(1); ++column)
+            {
+                const auto windowOffset = inputOrigin + row * _stride * inputIncrement[0] + column * _stride * inputIncrement[1];
+                for (int filter = 0; filter < numFilters; ++filter)
+                {
+                    int32_t accumulator = 0;
+                    for (int windowRow = 0; windowRow < _filterSize; ++windowRow)
+                    {
+                        for (int windowColumn = 0; windowColumn < _filterSize; ++windowColumn)
+                        {
+                            const auto inputOffset = windowOffset + windowRow * inputIncrement[0] + windowColumn * inputIncrement[1];
+                            const auto filterOffset = filter * filterVolume + (windowRow * _filterSize + windowColumn) * numChannels;
+                            for (int channel = 0; channel < numChannels; ++channel)
+                            {
+                                accumulator += static_cast<int32_t>(quantizedInput[inputOffset + channel * inputIncrement[2]]) * static_cast<int32_t>(_weights[filterOffset + channel]);
+                            }
+                        }
+                    }
+                    const auto outputOffset = outputOrigin + row * outputIncrement[0] + column * outputIncrement[1] + filter * outputIncrement[2];
+                    outputValues[outputOffset] = static_cast<ValueType>(accumulator) * outputScales[filter];
+                }
+            }
+        }
+        _output.SetOutput(outputValues);
+    }
+
+    template <typename ValueType>
+    void QuantizedConvolutionalLayerNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
+
+        const auto inputLayout = GetInputMemoryLayout();
+        const auto outputLayout = GetOutputMemoryLayout();
+        const int inputSize = static_cast<int>(inputLayout.GetMemorySize());
+
+        auto& module = function.GetModule();
+        auto quantizedInput = function.PointerOffset(module.GlobalArray(VariableType::Char8, compiler.GetGlobalName(*this, "quantizedInput"), inputSize), 0);
+        auto weights = function.PointerOffset(EmitQuantizedWeights(function, compiler.GetGlobalName(*this, "weights"), _weights), 0);
+        auto outputScales = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "outputScales"), GetOutputScales(_weightScales, _inputScale)), 0);
+        auto accumulator = function.Variable(VariableType::Int32, "accumulator");
+
+        EmitQuantizeValues(function, pInput, inputSize, _inputScale, quantizedInput);
+
+        const int filterSize = _filterSize;
+        const int stride = _stride;
+        const int numChannels = inputLayout.GetLogicalDimensionActiveSize(2);
+        const int numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
+        const int filterVolume = filterSize * filterSize * numChannels;
+        const int inputRowIncrement = static_cast<int>(inputLayout.GetLogicalDimensionIncrement(0));
+        const int inputColumnIncrement = static_cast<int>(inputLayout.GetLogicalDimensionIncrement(1));
+        const int outputRowIncrement = static_cast<int>(outputLayout.GetLogicalDimensionIncrement(0));
+        const int outputColumnIncrement = static_cast<int>(outputLayout.GetLogicalDimensionIncrement(1));
+        const int outputChannelIncrement = static_cast<int>(outputLayout.GetLogicalDimensionIncrement(2));
+        const int inputOrigin = (inputLayout.GetLogicalDimensionOffset(0) - filterSize / 2) * inputRowIncrement +
+                                (inputLayout.GetLogicalDimensionOffset(1) - filterSize / 2) * inputColumnIncrement +
+                                inputLayout.GetLogicalDimensionOffset(2);
+        const int outputOrigin = static_cast<int>(outputLayout.GetLogicalEntryOffset({ 0, 0, 0 }));
+
+        // When the channels of adjacent columns are contiguous, each row of the window is a single run of filterSize * numChannels values
+        const bool canCombineColumns = inputColumnIncrement == numChannels;
+
+        const auto outputRows = outputLayout.GetLogicalDimensionActiveSize(0);
+        const auto outputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
+        function.For(outputRows, [=](IRFunctionEmitter& function, IRLocalScalar row) {
+            function.For(outputColumns, [=](IRFunctionEmitter& function, IRLocalScalar column) {
+                auto windowOffset = function.LocalScalar(inputOrigin) + row * (stride * inputRowIncrement) + column * (stride * inputColumnIncrement);
+                auto outputOffset = function.LocalScalar(outputOrigin) + row * outputRowIncrement + column * outputColumnIncrement;
+
+                // Iterating over the filters innermost reuses the window of quantized input while it is in cache
+                function.For(numFilters, [=](IRFunctionEmitter& function, IRLocalScalar filter) {
+                    function.StoreZero(accumulator);
+                    auto filterOffset = filter * filterVolume;
+
+                    // The filters are typically small, so we unroll the loops over the window here
+                    for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+                    {
+                        if (canCombineColumns)
+                        {
+                            EmitInt8DotProduct(function, filterSize * numChannels, quantizedInput, windowOffset + windowRow * inputRowIncrement, weights, filterOffset + windowRow * filterSize * numChannels, accumulator);
+                        }
+                        else
+                        {
+                            for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                            {
+                                EmitInt8DotProduct(function, numChannels, quantizedInput, windowOffset + (windowRow * inputRowIncrement + windowColumn * inputColumnIncrement), weights, filterOffset + (windowRow * filterSize + windowColumn) * numChannels, accumulator);
+                            }
+                        }
+                    }
+
+                    auto sum = function.LocalScalar(function.CastValue<ValueType>(function.Load(accumulator)));
+                    auto scale = function.LocalScalar(function.ValueAt(outputScales, filter));
+                    function.SetValueAt(pOutput, outputOffset + filter * outputChannelIncrement, sum * scale);
+                });
+            });
+        });
+    }
+
+    template <typename ValueType>
+    void QuantizedConvolutionalLayerNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        model::CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["inputLayout"] << _inputMemoryLayout;
+        archiver["outputLayout"] << GetOutputMemoryLayout();
+        archiver["filterSize"] << _filterSize;
+        archiver["stride"] << _stride;
+        archiver["inputScale"] << _inputScale;
+        archiver["weightScales"] << _weightScales;
+        WriteQuantizedValues(archiver, "weights", _weights);
+    }
+
+    template <typename ValueType>
+    void QuantizedConvolutionalLayerNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        model::CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["inputLayout"] >> _inputMemoryLayout;
+        model::PortMemoryLayout outputMemoryLayout;
+        archiver["outputLayout"] >> outputMemoryLayout;
+        _output.SetMemoryLayout(outputMemoryLayout);
+        archiver["filterSize"] >> _filterSize;
+        archiver["stride"] >> _stride;
+        archiver["inputScale"] >> _inputScale;
+        archiver["weightScales"] >> _weightScales;
+        ReadQuantizedValues(archiver, "weights", _weights);
+    }
+
+    //
+    // QuantizedFullyConnectedLayerNode
+    //
+
+    template <typename ValueType>
+    QuantizedFullyConnectedLayerNode<ValueType>::QuantizedFullyConnectedLayerNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    QuantizedFullyConnectedLayerNode<ValueType>::QuantizedFullyConnectedLayerNode(const model::OutputPort<ValueType>& input,
+                                                                                  const model::PortMemoryLayout& outputMemoryLayout,
+                                                                                  const ConstMatrixReferenceType& weights,
+                                                                                  ValueType inputScale) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, outputMemoryLayout),
+        _inputScale(inputScale)
+    {
+        if (weights.NumColumns() != input.Size() || weights.NumRows() != outputMemoryLayout.GetMemorySize())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "QuantizedFullyConnectedLayerNode: weights don't match the input and output sizes");
+        }
+        _weightScales = QuantizeRows(weights.ToArray(), weights.NumRows(), _weights);
+    }
+
+    template <typename ValueType>
+    QuantizedFullyConnectedLayerNode<ValueType>::QuantizedFullyConnectedLayerNode(const model::OutputPort<ValueType>& input,
+                                                                                  const model::PortMemoryLayout& outputMemoryLayout,
+                                                                                  const std::vector<int8_t>& weights,
+                                                                                  const std::vector<ValueType>& weightScales,
+                                                                                  ValueType inputScale) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, outputMemoryLayout),
+        _weights(weights),
+        _weightScales(weightScales),
+        _inputScale(inputScale)
+    {
+    }
+
+    template <typename ValueType>
+    void QuantizedFullyConnectedLayerNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<QuantizedFullyConnectedLayerNode<ValueType>>(newInput, _output.GetMemoryLayout(), _weights, _weightScales, _inputScale);
+        transformer.MapNodeOutput(this->output, newNode->output);
+    }
+
+    template <typename ValueType>
+    int64_t QuantizedFullyConnectedLayerNode<ValueType>::GetOperationCount() const
+    {
+        return 2 * static_cast<int64_t>(_weights.size());
+    }
+
+    template <typename ValueType>
+    int64_t QuantizedFullyConnectedLayerNode<ValueType>::GetBytesRead() const
+    {
+        return CompilableNode::GetBytesRead() + _weights.size() * sizeof(int8_t) + _weightScales.size() * sizeof(ValueType);
+    }
+
+    template <typename ValueType>
+    void QuantizedFullyConnectedLayerNode<ValueType>::Compute() const
+    {
+        const auto quantizedInput = QuantizeValues(_input.GetValue(), _inputScale);
+        const auto outputScales = GetOutputScales(_weightScales, _inputScale);
+        const auto numColumns = quantizedInput.size();
+
+        std::vector<ValueType> outputValues(_output.Size());
+        for (size_t row = 0; row < outputValues.size(); ++row)
+        {
+            int32_t accumulator = 0;
+            for (size_t column = 0; column < numColumns; ++column)
+            {
+                accumulator += static_cast<int32_t>(quantizedInput[column]) * static_cast<int32_t>(_weights[row * numColumns + column]);
+            }
+            outputValues[row] = static_cast<ValueType>(accumulator) * outputScales[row];
+        }
+        _output.SetOutput(outputValues);
+    }
+
+    template <typename ValueType>
+    void QuantizedFullyConnectedLayerNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
+
+        const int numColumns = static_cast<int>(input.Size());
+        const int numRows = static_cast<int>(output.Size());
+
+        auto& module = function.GetModule();
+        auto quantizedInput = function.PointerOffset(module.GlobalArray(VariableType::Char8, compiler.GetGlobalName(*this, "quantizedInput"), numColumns), 0);
+        auto weights = function.PointerOffset(EmitQuantizedWeights(function, compiler.GetGlobalName(*this, "weights"), _weights), 0);
+        auto outputScales = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "outputScales"), GetOutputScales(_weightScales, _inputScale)), 0);
+        auto accumulator = function.Variable(VariableType::Int32, "accumulator");
+
+        EmitQuantizeValues(function, pInput, numColumns, _inputScale, quantizedInput);
+
+        function.For(numRows, [=](IRFunctionEmitter& function, IRLocalScalar row) {
+            function.StoreZero(accumulator);
+            EmitInt8DotProduct(function, numColumns, quantizedInput, function.LocalScalar(0), weights, row * numColumns, accumulator);
+
+            auto sum = function.LocalScalar(function.CastValue<ValueType>(function.Load(accumulator)));
+            auto scale = function.LocalScalar(function.ValueAt(outputScales, row));
+            function.SetValueAt(pOutput, row, sum * scale);
+        });
+    }
+
+    template <typename ValueType>
+    void QuantizedFullyConnectedLayerNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        model::CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["outputLayout"] << _output.GetMemoryLayout();
+        archiver["inputScale"] << _inputScale;
+        archiver["weightScales"] << _weightScales;
+        WriteQuantizedValues(archiver, "weights", _weights);
+    }
+
+    template <typename ValueType>
+    void QuantizedFullyConnectedLayerNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        model::CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        model::PortMemoryLayout outputMemoryLayout;
+        archiver["outputLayout"] >> outputMemoryLayout;
+        _output.SetMemoryLayout(outputMemoryLayout);
+        archiver["inputScale"] >> _inputScale;
+        archiver["weightScales"] >> _weightScales;
+        ReadQuantizedValues(archiver, "weights", _weights);
+    }
+
+    //
+    // QuantizedRecurrentLayerNode
+    //
+
+    template <typename ValueType>
+    QuantizedRecurrentLayerNode<ValueType>::QuantizedRecurrentLayerNode() :
+        CompilableNode({ &_input, &_resetTrigger }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _resetTrigger(this, resetTriggerPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    QuantizedRecurrentLayerNode<ValueType>::QuantizedRecurrentLayerNode(const model::OutputPort<ValueType>& input,
+                                                                        const model::OutputPortBase& resetTrigger,
+                                                                        RecurrentCellType cellType,
+                                                                        size_t hiddenUnits,
+                                                                        const std::vector<ValueType>& inputWeights,
+                                                                        const std::vector<ValueType>& hiddenWeights,
+                                                                        const std::vector<ValueType>& inputBias,
+                                                                        const std::vector<ValueType>& hiddenBias,
+                                                                        ValueType inputScale,
+                                                                        ValueType hiddenScale) :
+        CompilableNode({ &_input, &_resetTrigger }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _resetTrigger(this, resetTrigger, resetTriggerPortName),
+        _output(this, defaultOutputPortName, hiddenUnits),
+        _cellType(cellType),
+        _hiddenUnits(hiddenUnits),
+        _inputBias(inputBias),
+        _hiddenBias(hiddenBias),
+        _inputScale(inputScale),
+        _hiddenScale(hiddenScale),
+        _hiddenState(hiddenUnits),
+        _cellState(hiddenUnits)
+    {
+        const auto stackSize = static_cast<size_t>(GetStackSize());
+        if (inputWeights.size() != stackSize * input.Size() || hiddenWeights.size() != stackSize * hiddenUnits || inputBias.size() != stackSize || hiddenBias.size() != stackSize)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "QuantizedRecurrentLayerNode: weights don't match the input size and number of hidden units");
+        }
+        _inputWeightScales = QuantizeRows(inputWeights, stackSize, _inputWeights);
+        _hiddenWeightScales = QuantizeRows(hiddenWeights, stackSize, _hiddenWeights);
+    }
+
+    template <typename ValueType>
+    QuantizedRecurrentLayerNode<ValueType>::QuantizedRecurrentLayerNode(const model::OutputPort<ValueType>& input,
+                                                                        const model::OutputPortBase& resetTrigger,
+                                                                        RecurrentCellType cellType,
+                                                                        size_t hiddenUnits,
+                                                                        const std::vector<int8_t>& inputWeights,
+                                                                        const std::vector<ValueType>& inputWeightScales,
+                                                                        const std::vector<int8_t>& hiddenWeights,
+                                                                        const std::vector<ValueType>& hiddenWeightScales,
+                                                                        const std::vector<ValueType>& inputBias,
+                                                                        const std::vector<ValueType>& hiddenBias,
+                                                                        ValueType inputScale,
+                                                                        ValueType hiddenScale) :
+        CompilableNode({ &_input, &_resetTrigger }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _resetTrigger(this, resetTrigger, resetTriggerPortName),
+        _output(this, defaultOutputPortName, hiddenUnits),
+        _cellType(cellType),
+        _hiddenUnits(hiddenUnits),
+        _inputWeights(inputWeights),
+        _inputWeightScales(inputWeightScales),
+        _hiddenWeights(hiddenWeights),
+        _hiddenWeightScales(hiddenWeightScales),
+        _inputBias(inputBias),
+        _hiddenBias(hiddenBias),
+        _inputScale(inputScale),
+        _hiddenScale(hiddenScale),
+        _hiddenState(hiddenUnits),
+        _cellState(hiddenUnits)
+    {
+    }
+
+    template <typename ValueType>
+    void QuantizedRecurrentLayerNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        const auto& newResetTrigger = transformer.GetCorrespondingInputs(_resetTrigger);
+        auto newNode = transformer.AddNode<QuantizedRecurrentLayerNode<ValueType>>(newInput, newResetTrigger, _cellType, _hiddenUnits, _inputWeights, _inputWeightScales, _hiddenWeights, _hiddenWeightScales, _inputBias, _hiddenBias, _inputScale, _hiddenScale);
+        transformer.MapNodeOutput(this->output, newNode->output);
+    }
+
+    template <typename ValueType>
+    int QuantizedRecurrentLayerNode<ValueType>::GetStackSize() const
+    {
+        // The LSTM has 4 stacked gates (input, forget, cell, output), and the GRU 3 (update, reset, hidden)
+        return static_cast<int>((_cellType == RecurrentCellType::lstm ? 4 : 3) * _hiddenUnits);
+    }
+
+    template <typename ValueType>
+    int64_t QuantizedRecurrentLayerNode<ValueType>::GetOperationCount() const
+    {
+        return 2 * static_cast<int64_t>(_inputWeights.size() + _hiddenWeights.size());
+    }
+
+    template <typename ValueType>
+    int64_t QuantizedRecurrentLayerNode<ValueType>::GetBytesRead() const
+    {
+        const auto numValues = _inputWeightScales.size() + _hiddenWeightScales.size() + _inputBias.size() + _hiddenBias.size();
+        return CompilableNode::GetBytesRead() + (_inputWeights.size() + _hiddenWeights.size()) * sizeof(int8_t) + numValues * sizeof(ValueType);
+    }
+
+    template <typename ValueType>
+    bool QuantizedRecurrentLayerNode<ValueType>::ShouldReset() const
+    {
+        // Like RNNNode, reset when the trigger goes from nonzero to zero
+        bool result = false;
+        if (_resetTrigger.Size() > 0)
+        {
+            auto triggerValue = static_cast<int>(_resetTrigger.GetInputElement(0).ReferencedPort()->GetDoubleOutput(0));
+            result = _lastResetValue != 0 && triggerValue == 0;
+            _lastResetValue = triggerValue;
+        }
+        return result;
+    }
+
+    template <typename ValueType>
+    void QuantizedRecurrentLayerNode<ValueType>::Reset()
+    {
+        std::fill(_hiddenState.begin(), _hiddenState.end(), 0);
+        std::fill(_cellState.begin(), _cellState.end(), static_cast<ValueType>(0));
+    }
+
+    template <typename ValueType>
+    void QuantizedRecurrentLayerNode<ValueType>::Compute() const
+    {
+        const auto hiddenUnits = _hiddenUnits;
+        const auto stackSize = static_cast<size_t>(GetStackSize());
+        const auto numInputs = _input.Size();
+        const auto quantizedInput = QuantizeValues(_input.GetValue(), _inputScale);
+        const auto inputOutputScales = GetOutputScales(_inputWeightScales, _inputScale);
+        const auto hiddenOutputScales = GetOutputScales(_hiddenWeightScales, _hiddenScale);
+
+        // W_i * x + b_i and W_h * h + b_h, kept separate because the GRU's reset gate only scales the hidden part
+        std::vector<ValueType> inputGates(stackSize);
+        std::vector<ValueType> hiddenGates(stackSize);
+        for (size_t row = 0; row < stackSize; ++row)
+        {
+            inputGates[row] = static_cast<ValueType>(Int8DotProduct(quantizedInput.data(), _inputWeights.data() + row * numInputs, numInputs)) * inputOutputScales[row] + _inputBias[row];
+            hiddenGates[row] = static_cast<ValueType>(Int8DotProduct(_hiddenState.data(), _hiddenWeights.data() + row * hiddenUnits, hiddenUnits)) * hiddenOutputScales[row] + _hiddenBias[row];
+        }
+
+        const auto table = GetTanhTable<ValueType>();
+        const ValueType inverseHiddenScale = 1 / _hiddenScale;
+        std::vector<ValueType> outputValues(hiddenUnits);
+        for (size_t i = 0; i < hiddenUnits; ++i)
+        {
+            ValueType ht = 0;
+            if (_cellType == RecurrentCellType::lstm)
+            {
+                auto gate = [&](size_t slice) { return inputGates[i + slice * hiddenUnits] + hiddenGates[i + slice * hiddenUnits]; };
+                auto it = TableSigmoid(table, gate(0));
+                auto ft = TableSigmoid(table, gate(1));
+                auto gt = TableTanh(table, gate(2));
+                auto ot = TableSigmoid(table, gate(3));
+                auto ct = ft * _cellState[i] + it * gt;
+                _cellState[i] = ct;
+                ht = ot * TableTanh(table, ct);
+            }
+            else
+            {
+                auto zt = TableSigmoid(table, inputGates[i] + hiddenGates[i]);
+                auto rt = TableSigmoid(table, inputGates[i + hiddenUnits] + hiddenGates[i + hiddenUnits]);
+                auto nt = TableTanh(table, inputGates[i + 2 * hiddenUnits] + rt * hiddenGates[i + 2 * hiddenUnits]);
+                auto h = static_cast<ValueType>(_hiddenState[i]) * _hiddenScale;
+                ht = nt + zt * (h - nt);
+            }
+            outputValues[i] = ht;
+            _hiddenState[i] = QuantizeValue(ht, inverseHiddenScale);
+        }
+
+        if (ShouldReset())
+        {
+            const_cast<QuantizedRecurrentLayerNode<ValueType>*>(this)->Reset();
+        }
+        _output.SetOutput(outputValues);
+    }
+
+    template <typename ValueType>
+    void QuantizedRecurrentLayerNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
+        LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
+
+        const int numInputs = static_cast<int>(input.Size());
+        const int hiddenUnits = static_cast<int>(_hiddenUnits);
+        const int stackSize = GetStackSize();
+        const auto cellType = _cellType;
+        const auto hiddenScale = _hiddenScale;
+        const ValueType inverseHiddenScale = 1 / _hiddenScale;
+
+        auto& module = function.GetModule();
+        auto quantizedInput = function.PointerOffset(module.GlobalArray(VariableType::Char8, compiler.GetGlobalName(*this, "quantizedInput"), numInputs), 0);
+        auto hiddenStateValue = module.GlobalArray(VariableType::Char8, compiler.GetGlobalName(*this, "hiddenState"), hiddenUnits);
+        auto hiddenState = function.PointerOffset(hiddenStateValue, 0);
+        auto cellStateValue = cellType == RecurrentCellType::lstm ? module.GlobalArray<ValueType>(compiler.GetGlobalName(*this, "cellState"), hiddenUnits) : nullptr;
+        auto cellState = cellStateValue ? function.PointerOffset(cellStateValue, 0) : nullptr;
+        auto inputWeights = function.PointerOffset(EmitQuantizedWeights(function, compiler.GetGlobalName(*this, "inputWeights"), _inputWeights), 0);
+        auto hiddenWeights = function.PointerOffset(EmitQuantizedWeights(function, compiler.GetGlobalName(*this, "hiddenWeights"), _hiddenWeights), 0);
+        auto inputOutputScales = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "inputOutputScales"), GetOutputScales(_inputWeightScales, _inputScale)), 0);
+        auto hiddenOutputScales = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "hiddenOutputScales"), GetOutputScales(_hiddenWeightScales, _hiddenScale)), 0);
+        auto inputBias = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "inputBias"), _inputBias), 0);
+        auto hiddenBias = function.PointerOffset(module.ConstantArray(compiler.GetGlobalName(*this, "hiddenBias"), _hiddenBias), 0);
+        auto table = EmitTanhTable<ValueType>(function);
+        auto inputGates = function.Variable(GetVariableType<ValueType>(), stackSize);
+        auto hiddenGates = function.Variable(GetVariableType<ValueType>(), stackSize);
+        auto accumulator = function.Variable(VariableType::Int32, "accumulator");
+
+        EmitQuantizeValues(function, pInput, numInputs, _inputScale, quantizedInput);
+
+        // W_i * x + b_i and W_h * h + b_h, with the int8 dot products the fully-connected layer uses
+        function.For(stackSize, [=](IRFunctionEmitter& function, IRLocalScalar row) {
+            auto emitGate = [&](LLVMValue values, int size, LLVMValue weights, LLVMValue scales, LLVMValue bias, LLVMValue result) {
+                function.StoreZero(accumulator);
+                EmitInt8DotProduct(function, size, values, function.LocalScalar(0), weights, row * size, accumulator);
+                auto sum = function.LocalScalar(function.CastValue<ValueType>(function.Load(accumulator)));
+                auto scale = function.LocalScalar(function.ValueAt(scales, row));
+                function.SetValueAt(result, row, sum * scale + function.LocalScalar(function.ValueAt(bias, row)));
+            };
+            emitGate(quantizedInput, numInputs, inputWeights, inputOutputScales, inputBias, inputGates);
+            emitGate(hiddenState, hiddenUnits, hiddenWeights, hiddenOutputScales, hiddenBias, hiddenGates);
+        });
+
+        // Apply the gate activations and update the states, requantizing the hidden state
+        function.For(hiddenUnits, [=](IRFunctionEmitter& function, IRLocalScalar i) {
+            auto inputGate = [&](int slice) { return function.LocalScalar(function.ValueAt(inputGates, i + slice * hiddenUnits)); };
+            auto hiddenGate = [&](int slice) { return function.LocalScalar(function.ValueAt(hiddenGates, i + slice * hiddenUnits)); };
+            auto emitLstm = [&]() {
+                auto it = EmitTableSigmoid<ValueType>(function, table, inputGate(0) + hiddenGate(0));
+                auto ft = EmitTableSigmoid<ValueType>(function, table, inputGate(1) + hiddenGate(1));
+                auto gt = EmitTableTanh<ValueType>(function, table, inputGate(2) + hiddenGate(2));
+                auto ot = EmitTableSigmoid<ValueType>(function, table, inputGate(3) + hiddenGate(3));
+                auto ct = ft * function.LocalScalar(function.ValueAt(cellState, i)) + it * gt;
+                function.SetValueAt(cellState, i, ct);
+                return ot * EmitTableTanh<ValueType>(function, table, ct);
+            };
+            auto emitGru = [&]() {
+                auto zt = EmitTableSigmoid<ValueType>(function, table, inputGate(0) + hiddenGate(0));
+                auto rt = EmitTableSigmoid<ValueType>(function, table, inputGate(1) + hiddenGate(1));
+                auto nt = EmitTableTanh<ValueType>(function, table, inputGate(2) + rt * hiddenGate(2));
+                auto h = function.LocalScalar(function.CastValue<ValueType>(function.ValueAt(hiddenState, i))) * hiddenScale;
+                return nt + zt * (h - nt);
+            };
+
+            auto ht = cellType == RecurrentCellType::lstm ? emitLstm() : emitGru();
+            function.SetValueAt(pOutput, i, ht);
+            function.SetValueAt(hiddenState, i, EmitQuantizeValue(function, ht, inverseHiddenScale));
+        });
+
+        if (_resetTrigger.Size() > 0)
+        {
+            std::string resetFunctionName = compiler.GetGlobalName(*this, "QuantizedRecurrentLayerNodeReset");
+            IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionName);
+            resetFunction.MemorySet<char>(resetFunction.PointerOffset(hiddenStateValue, 0), 0, resetFunction.Literal<uint8_t>(0), hiddenUnits);
+            if (cellStateValue)
+            {
+                resetFunction.MemorySet<ValueType>(resetFunction.PointerOffset(cellStateValue, 0), 0, resetFunction.Literal<uint8_t>(0), hiddenUnits);
+            }
+            module.EndResetFunction();
+
+            // Like RNNNode, reset when the trigger goes from nonzero to zero
+            auto pResetTrigger = compiler.EnsurePortEmitted(this->resetTrigger);
+            auto lastSignal = module.Global<int>(compiler.GetGlobalName(*this, "lastSignal"), 0);
+            auto lastSignalValue = function.LocalScalar(function.Load(lastSignal));
+            auto resetTriggerValue = function.LocalScalar(function.CastValue<int>(function.Load(pResetTrigger)));
+            function.If((resetTriggerValue == 0) && (lastSignalValue != 0), [resetFunctionName](IRFunctionEmitter& function) {
+                function.Call(resetFunctionName);
+            });
+            function.Store(lastSignal, resetTriggerValue);
+        }
+    }
+
+    template <typename ValueType>
+    void QuantizedRecurrentLayerNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        model::CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver[resetTriggerPortName] << _resetTrigger;
+        archiver["cellType"] << static_cast<int>(_cellType);
+        archiver["hiddenUnits"] << _hiddenUnits;
+        archiver["inputScale"] << _inputScale;
+        archiver["hiddenScale"] << _hiddenScale;
+        archiver["inputWeightScales"] << _inputWeightScales;
+        archiver["hiddenWeightScales"] << _hiddenWeightScales;
+        archiver["inputBias"] << _inputBias;
+        archiver["hiddenBias"] << _hiddenBias;
+        WriteQuantizedValues(archiver, "inputWeights", _inputWeights);
+        WriteQuantizedValues(archiver, "hiddenWeights", _hiddenWeights);
+    }
+
+    template <typename ValueType>
+    void QuantizedRecurrentLayerNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        model::CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver[resetTriggerPortName] >> _resetTrigger;
+        int cellType = 0;
+        archiver["cellType"] >> cellType;
+        _cellType = static_cast<RecurrentCellType>(cellType);
+        archiver["hiddenUnits"] >> _hiddenUnits;
+        archiver["inputScale"] >> _inputScale;
+        archiver["hiddenScale"] >> _hiddenScale;
+        archiver["inputWeightScales"] >> _inputWeightScales;
+        archiver["hiddenWeightScales"] >> _hiddenWeightScales;
+        archiver["inputBias"] >> _inputBias;
+        archiver["hiddenBias"] >> _hiddenBias;
+        ReadQuantizedValues(archiver, "inputWeights", _inputWeights);
+        ReadQuantizedValues(archiver, "hiddenWeights", _hiddenWeights);
+        _output.SetSize(_hiddenUnits);
+        _hiddenState.assign(_hiddenUnits, 0);
+        _cellState.assign(_hiddenUnits, 0);
+    }
+
+    // Explicit specializations
+    template class QuantizedConvolutionalLayerNode<float>;
+    template class QuantizedConvolutionalLayerNode<double>;
+    template class QuantizedFullyConnectedLayerNode<float>;
+    template class QuantizedFullyConnectedLayerNode<double>;
+    template class QuantizedRecurrentLayerNode<float>;
+    template class QuantizedRecurrentLayerNode<double>;
+} // namespace nodes
+} // namespace ell
@@ -234,33 +234,24 @@ namespace nodes
 
         // Allocate local variables
         auto inputGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
-        auto hiddenGate = function.LocalArray(function.Variable(emitters::GetVariableType<ValueType>(), hiddenUnits));
+        auto gateBias = function.LocalArray(hiddenBias);
 
         auto alpha = static_cast<ValueType>(1.0); // GEMV scaling of the matrix multipication
         auto beta = static_cast<ValueType>(1.0); // GEMV scaling of the bias addition
 
-        // W_i * x + b_i
+        // W_i * x + b_i + W_h * h, accumulated into one vector
         function.MemoryCopy<ValueType>(inputBias, inputGate, hiddenUnits); // Copy bias values into output so GEMM call accumulates them
         function.CallGEMV(hiddenUnits, inputSize, alpha, inputWeights, inputSize, input, 1, beta, inputGate, 1);
-
-        // W_h * h + b_h
-        function.MemoryCopy<ValueType>(hiddenBias, hiddenGate, hiddenUnits); // Copy bias values into output so GEMM call accumulates them
-        function.CallGEMV(hiddenUnits, hiddenUnits, alpha, hiddenWeights, hiddenUnits, prevHiddenState, 1, beta, hiddenGate, 1);
-
-        // input_gate = sigma(W_{ iz } x + b_{ iz } + W_{ hz } h + b_{ hz })
-        function.For(hiddenUnits, [=](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
-            inputGate[i] = inputGate[i] + hiddenGate[i];
+        function.CallGEMV(hiddenUnits, hiddenUnits, alpha, hiddenWeights, hiddenUnits, prevHiddenState, 1, beta, inputGate, 1);
+
+        // Add the hidden bias, apply the activation (tanh) and save the new hidden state in a single loop
+        auto activation = GetNodeActivationFunction(this->_activation);
+        function.For(hiddenUnits, [=, &activation](emitters::IRFunctionEmitter& fn, emitters::IRLocalScalar i) {
+            auto newValue = activation->Compile(fn, emitters::IRLocalScalar(inputGate[i]) + gateBias[i]);
+            hiddenState[i] = newValue;
+            output[i] = newValue;
         });
 
-        // tanh
-        this->ApplyActivation(function, this->_activation, inputGate, hiddenUnits);
-
-        // save new HiddenState
-        function.MemoryCopy<ValueType>(inputGate, hiddenState, hiddenUnits);
-
-        // Copy hidden state to the output.
-        function.MemoryCopy<ValueType>(hiddenState, output, hiddenUnits);
-
         // Add the internal reset function
         std::string resetFunctionName = compiler.GetGlobalName(*this, "RNNNodeReset");
         emitters::IRFunctionEmitter& resetFunction = module.BeginResetFunction(resetFunctionName);
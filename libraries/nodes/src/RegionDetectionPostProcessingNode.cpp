@@ -0,0 +1,497 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     RegionDetectionPostProcessingNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "RegionDetectionPostProcessingNode.h"
+
+#include <emitters/include/IRLocalArray.h>
+#include <emitters/include/IRMath.h>
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        using namespace ::ell::emitters;
+        using namespace ::ell::model;
+
+        // Returns the memory offset of an entry, given its logical coordinates relative to the start of the active area
+        int GetMemoryOffset(const PortMemoryLayout& layout, int row, int column, int channel)
+        {
+            const auto& offset = layout.GetOffset();
+            const auto& increment = layout.GetCumulativeIncrement();
+            return (row + offset[0]) * increment[0] + (column + offset[1]) * increment[1] + (channel + offset[2]) * increment[2];
+        }
+
+        template <typename ValueType>
+        ValueType Sigmoid(ValueType x)
+        {
+            return 1 / (1 + std::exp(-x));
+        }
+
+        // Returns true if the intersection over union of two (x, y, width, height) boxes is above the threshold
+        template <typename ValueType>
+        bool Overlaps(const ValueType* a, const ValueType* b, ValueType threshold)
+        {
+            auto left = std::max(a[0] - a[2] / 2, b[0] - b[2] / 2);
+            auto right = std::min(a[0] + a[2] / 2, b[0] + b[2] / 2);
+            auto top = std::max(a[1] - a[3] / 2, b[1] - b[3] / 2);
+            auto bottom = std::min(a[1] + a[3] / 2, b[1] + b[3] / 2);
+            auto intersection = std::max(right - left, ValueType{ 0 }) * std::max(bottom - top, ValueType{ 0 });
+            auto unionArea = a[2] * a[3] + b[2] * b[3] - intersection;
+            return intersection > threshold * unionArea;
+        }
+
+        template <typename ValueType>
+        IRLocalScalar EmitOverlaps(IRFunctionEmitter& function, const std::vector<IRLocalScalar>& a, const std::vector<IRLocalScalar>& b, ValueType threshold)
+        {
+            const ValueType half = static_cast<ValueType>(0.5);
+            auto left = Max(a[0] - a[2] * half, b[0] - b[2] * half);
+            auto right = Min(a[0] + a[2] * half, b[0] + b[2] * half);
+            auto top = Max(a[1] - a[3] * half, b[1] - b[3] * half);
+            auto bottom = Min(a[1] + a[3] * half, b[1] + b[3] * half);
+            auto intersection = Max(right - left, ValueType{ 0 }) * Max(bottom - top, ValueType{ 0 });
+            auto unionArea = a[2] * a[3] + b[2] * b[3] - intersection;
+            return intersection > threshold * unionArea;
+        }
+    } // namespace
+
+    template <typename ValueType>
+    RegionDetectionPostProcessingNode<ValueType>::RegionDetectionPostProcessingNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    RegionDetectionPostProcessingNode<ValueType>::RegionDetectionPostProcessingNode(const model::OutputPort<ValueType>& input,
+                                                                                    const model::PortMemoryLayout& inputMemoryLayout,
+                                                                                    const predictors::neural::RegionDetectionParameters& detectionParameters,
+                                                                                    const RegionDetectionPostProcessingParameters& postProcessingParameters) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, postProcessingParameters.maxBoxes * boxSize),
+        _inputMemoryLayout(inputMemoryLayout),
+        _detectionParameters(detectionParameters),
+        _postProcessingParameters(postProcessingParameters)
+    {
+        VerifyParameters();
+    }
+
+    template <typename ValueType>
+    void RegionDetectionPostProcessingNode<ValueType>::VerifyParameters() const
+    {
+        const auto& params = _detectionParameters;
+        const auto& layout = _inputMemoryLayout;
+        if (layout.NumDimensions() != 3 || !layout.IsCanonicalOrder())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "RegionDetectionPostProcessingNode: the input layout must be 3-dimensional, in canonical order");
+        }
+
+        const int boxStride = params.numAnchors + 1 + params.numClasses;
+        if (params.numAnchors < 4 || layout.GetActiveSize(0) != params.width || layout.GetActiveSize(1) != params.height || layout.GetActiveSize(2) != params.numBoxesPerCell * boxStride)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "RegionDetectionPostProcessingNode: the input layout doesn't match the detection parameters");
+        }
+
+        const auto& postProcessingParams = _postProcessingParameters;
+        if (!postProcessingParams.anchorScales.empty() && static_cast<int>(postProcessingParams.anchorScales.size()) != 2 * params.numBoxesPerCell)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "RegionDetectionPostProcessingNode: there must be a width and height for each anchor box");
+        }
+
+        if (postProcessingParams.confidenceThreshold < 0 || postProcessingParams.confidenceThreshold >= 1 || postProcessingParams.nmsThreshold < 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "RegionDetectionPostProcessingNode: the confidence threshold must be in [0, 1), and the NMS threshold must not be negative");
+        }
+
+        if (postProcessingParams.maxBoxes <= 0 || postProcessingParams.maxCandidates <= 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "RegionDetectionPostProcessingNode: the number of boxes and candidates must be positive");
+        }
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> RegionDetectionPostProcessingNode<ValueType>::GetAnchorScales() const
+    {
+        const auto& anchorScales = _postProcessingParameters.anchorScales;
+        if (anchorScales.empty())
+        {
+            return std::vector<ValueType>(2 * _detectionParameters.numBoxesPerCell, 1);
+        }
+        return { anchorScales.begin(), anchorScales.end() };
+    }
+
+    template <typename ValueType>
+    ValueType RegionDetectionPostProcessingNode<ValueType>::GetConfidenceLogitThreshold() const
+    {
+        // A box's score is its confidence, sigmoid(c), times a class probability, so it can only be above the
+        // threshold t if sigmoid(c) > t, that is, if c > log(t / (1 - t))
+        auto threshold = _postProcessingParameters.confidenceThreshold;
+        if (threshold <= 0)
+        {
+            return std::numeric_limits<ValueType>::lowest();
+        }
+        return static_cast<ValueType>(std::log(threshold / (1 - threshold)));
+    }
+
+    template <typename ValueType>
+    void RegionDetectionPostProcessingNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<RegionDetectionPostProcessingNode<ValueType>>(newInput, _inputMemoryLayout, _detectionParameters, _postProcessingParameters);
+        transformer.MapNodeOutput(this->output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void RegionDetectionPostProcessingNode<ValueType>::Compute() const
+    {
+        const auto& layout = _inputMemoryLayout;
+        const auto& params = _detectionParameters;
+        const int numRows = params.width;
+        const int numColumns = params.height;
+        const int numAnchors = params.numAnchors;
+        const int boxStride = numAnchors + 1 + params.numClasses;
+        const auto anchorScales = GetAnchorScales();
+        const auto logitThreshold = GetConfidenceLogitThreshold();
+        const auto threshold = static_cast<ValueType>(_postProcessingParameters.confidenceThreshold);
+        const auto nmsThreshold = static_cast<ValueType>(_postProcessingParameters.nmsThreshold);
+        const int maxBoxes = _postProcessingParameters.maxBoxes;
+        const auto input = _input.GetValue();
+
+        struct Candidate
+        {
+            ValueType score;
+            int index;
+            int classIndex;
+        };
+
+        // Score the boxes, dropping the ones with low confidence before computing their class probabilities
+        std::vector<Candidate> candidates;
+        for (int row = 0; row < numRows; ++row)
+        {
+            for (int column = 0; column < numColumns; ++column)
+            {
+                for (int box = 0; box < params.numBoxesPerCell; ++box)
+                {
+                    auto boxOffset = GetMemoryOffset(layout, row, column, box * boxStride);
+                    auto confidenceLogit = input[boxOffset + numAnchors];
+                    if (confidenceLogit <= logitThreshold)
+                    {
+                        continue;
+                    }
+
+                    // The probability of the most likely class, from the softmax of the class logits
+                    auto classOffset = boxOffset + numAnchors + 1;
+                    int classIndex = 0;
+                    for (int c = 1; c < params.numClasses; ++c)
+                    {
+                        if (input[classOffset + c] > input[classOffset + classIndex])
+                        {
+                            classIndex = c;
+                        }
+                    }
+                    ValueType sum = 0;
+                    for (int c = 0; c < params.numClasses; ++c)
+                    {
+                        sum += std::exp(input[classOffset + c] - input[classOffset + classIndex]);
+                    }
+
+                    auto score = Sigmoid(confidenceLogit) / sum;
+                    if (score > threshold)
+                    {
+                        candidates.push_back({ score, (row * numColumns + column) * params.numBoxesPerCell + box, classIndex });
+                    }
+                }
+            }
+        }
+
+        std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+        candidates.resize(std::min(static_cast<int>(candidates.size()), _postProcessingParameters.maxCandidates));
+
+        // Decode the best boxes and suppress the ones that overlap a better box of the same class
+        std::vector<ValueType> output(maxBoxes * boxSize, 0);
+        for (int b = 0; b < maxBoxes; ++b)
+        {
+            output[b * boxSize + 5] = -1;
+        }
+
+        int numKept = 0;
+        for (const auto& candidate : candidates)
+        {
+            if (numKept == maxBoxes)
+            {
+                break;
+            }
+
+            auto box = candidate.index % params.numBoxesPerCell;
+            auto cell = candidate.index / params.numBoxesPerCell;
+            auto row = cell / numColumns;
+            auto column = cell % numColumns;
+            auto boxOffset = GetMemoryOffset(layout, row, column, box * boxStride);
+            ValueType decoded[boxSize] = {
+                (column + Sigmoid(input[boxOffset])) / numColumns,
+                (row + Sigmoid(input[boxOffset + 1])) / numRows,
+                std::exp(input[boxOffset + 2]) * anchorScales[2 * box] / numColumns,
+                std::exp(input[boxOffset + 3]) * anchorScales[2 * box + 1] / numRows,
+                candidate.score,
+                static_cast<ValueType>(candidate.classIndex)
+            };
+
+            bool isSuppressed = false;
+            for (int k = 0; k < numKept && !isSuppressed; ++k)
+            {
+                const auto* kept = &output[k * boxSize];
+                isSuppressed = kept[5] == decoded[5] && Overlaps(kept, decoded, nmsThreshold);
+            }
+
+            if (!isSuppressed)
+            {
+                std::copy(decoded, decoded + boxSize, output.begin() + numKept * boxSize);
+                ++numKept;
+            }
+        }
+
+        _output.SetOutput(output);
+    }
+
+    template <typename ValueType>
+    void RegionDetectionPostProcessingNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        auto defaultParallelizeValue = function.GetModule().GetCompilerOptions().parallelize;
+        auto parallelize = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("parallelize", defaultParallelizeValue);
+
+        auto options = function.GetCompilerOptions();
+        options.parallelize = parallelize;
+        function.SetCompilerOptions(options);
+
+        const auto layout = _inputMemoryLayout;
+        const auto& params = _detectionParameters;
+        const int numRows = params.width;
+        const int numColumns = params.height;
+        const int numAnchors = params.numAnchors;
+        const int numClasses = params.numClasses;
+        const int numBoxesPerCell = params.numBoxesPerCell;
+        const int boxStride = numAnchors + 1 + numClasses;
+        const int numBoxes = numRows * numColumns * numBoxesPerCell;
+        const int maxBoxes = _postProcessingParameters.maxBoxes;
+        const int maxCandidates = std::min(_postProcessingParameters.maxCandidates, numBoxes);
+        const auto logitThreshold = GetConfidenceLogitThreshold();
+        const auto threshold = static_cast<ValueType>(_postProcessingParameters.confidenceThreshold);
+        const auto nmsThreshold = static_cast<ValueType>(_postProcessingParameters.nmsThreshold);
+        const int rowIncrement = layout.GetCumulativeIncrement(0);
+        const int columnIncrement = layout.GetCumulativeIncrement(1);
+        const int channelIncrement = layout.GetCumulativeIncrement(2);
+        const int inputOffset = GetMemoryOffset(layout, 0, 0, 0);
+
+        auto& module = function.GetModule();
+        LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
+        LLVMValue pScores = function.PointerOffset(module.GlobalArray<ValueType>(compiler.GetGlobalName(*this, "scores"), numBoxes), 0);
+        LLVMValue pClasses = function.PointerOffset(module.GlobalArray<int>(compiler.GetGlobalName(*this, "classes"), numBoxes), 0);
+        auto input = function.LocalArray(pInput);
+        auto scores = function.LocalArray(pScores);
+        auto classes = function.LocalArray(pClasses);
+        auto output = function.LocalArray(compiler.EnsurePortEmitted(this->output));
+        auto topScores = function.LocalArray(function.PointerOffset(module.GlobalArray<ValueType>(compiler.GetGlobalName(*this, "topScores"), maxCandidates), 0));
+        auto topIndices = function.LocalArray(function.PointerOffset(module.GlobalArray<int>(compiler.GetGlobalName(*this, "topIndices"), maxCandidates), 0));
+        auto anchorScales = function.LocalArray(module.ConstantArray(compiler.GetGlobalName(*this, "anchorScales"), GetAnchorScales()));
+
+        // 1. Score the boxes, one row of cells per task. A box with low confidence is dropped before its class probabilities are computed.
+        function.ParallelFor(numRows, { pInput, pScores, pClasses }, [=](IRFunctionEmitter& function, IRLocalScalar row, const std::vector<LLVMValue>& capturedValues) {
+            auto input = function.LocalArray(capturedValues[0]);
+            auto scores = function.LocalArray(capturedValues[1]);
+            auto classes = function.LocalArray(capturedValues[2]);
+            function.For(numColumns, [=](IRFunctionEmitter& function, IRLocalScalar column) {
+                auto cellOffset = inputOffset + row * rowIncrement + column * columnIncrement;
+                auto cellIndex = (row * numColumns + column) * numBoxesPerCell;
+                for (int box = 0; box < numBoxesPerCell; ++box)
+                {
+                    auto boxOffset = cellOffset + box * boxStride * channelIncrement;
+                    auto classOffset = boxOffset + (numAnchors + 1) * channelIncrement;
+                    auto index = cellIndex + box;
+                    scores[index] = function.LocalScalar<ValueType>(0);
+                    classes[index] = function.LocalScalar<int>(0);
+
+                    IRLocalScalar confidenceLogit = input[boxOffset + numAnchors * channelIncrement];
+                    function.If(confidenceLogit > logitThreshold, [=](IRFunctionEmitter& function) {
+                        // The probability of the most likely class, from the softmax of the class logits
+                        auto maxLogit = function.Variable(emitters::GetVariableType<ValueType>(), "maxLogit");
+                        auto maxClass = function.Variable(emitters::VariableType::Int32, "maxClass");
+                        function.Store(maxLogit, static_cast<IRLocalScalar>(input[classOffset]));
+                        function.Store(maxClass, function.LocalScalar<int>(0));
+                        function.For(1, numClasses, [=](IRFunctionEmitter& function, IRLocalScalar c) {
+                            IRLocalScalar logit = input[classOffset + c * channelIncrement];
+                            function.If(logit > function.Load(maxLogit), [=](IRFunctionEmitter& function) {
+                                function.Store(maxLogit, logit);
+                                function.Store(maxClass, c);
+                            });
+                        });
+
+                        auto sum = function.Variable(emitters::GetVariableType<ValueType>(), "sum");
+                        function.Store(sum, function.LocalScalar<ValueType>(0));
+                        auto maxLogitValue = function.LocalScalar(function.Load(maxLogit));
+                        function.For(numClasses, [=](IRFunctionEmitter& function, IRLocalScalar c) {
+                            IRLocalScalar logit = input[classOffset + c * channelIncrement];
+                            function.Store(sum, function.LocalScalar(function.Load(sum)) + Exp(logit - maxLogitValue));
+                        });
+
+                        auto score = Sigmoid(confidenceLogit) / function.LocalScalar(function.Load(sum));
+                        function.If(score > threshold, [=](IRFunctionEmitter& function) {
+                            scores[index] = score;
+                            classes[index] = function.LocalScalar(function.Load(maxClass));
+                        });
+                    });
+                }
+            });
+        });
+
+        // 2. Keep the best `maxCandidates` boxes, sorted by score. Ties keep the earlier box first.
+        auto numCandidates = function.Variable(emitters::VariableType::Int32, "numCandidates");
+        function.Store(numCandidates, function.LocalScalar<int>(0));
+        function.For(numBoxes, [=](IRFunctionEmitter& function, IRLocalScalar index) {
+            IRLocalScalar score = scores[index];
+            function.If(score > threshold, [=](IRFunctionEmitter& function) {
+                auto count = function.LocalScalar(function.Load(numCandidates));
+                auto isFull = count >= maxCandidates;
+                IRLocalScalar worstScore = topScores[maxCandidates - 1];
+                function.If(~isFull || score > worstScore, [=](IRFunctionEmitter& function) {
+                    auto position = function.Variable(emitters::VariableType::Int32, "position");
+                    function.Store(position, function.Select(isFull, function.LocalScalar<int>(maxCandidates - 1), count));
+                    function.While([=](IRFunctionEmitter& function) {
+                        auto p = function.LocalScalar(function.Load(position));
+                        auto previous = function.LocalScalar(function.Select(p > 0, p - 1, function.LocalScalar<int>(0)));
+                        IRLocalScalar previousScore = topScores[previous];
+                        return (p > 0) && (previousScore < score);
+                    },
+                                   [=](IRFunctionEmitter& function) {
+                                       auto p = function.LocalScalar(function.Load(position));
+                                       topScores[p] = topScores[p - 1];
+                                       topIndices[p] = topIndices[p - 1];
+                                       function.Store(position, p - 1);
+                                   });
+
+                    auto p = function.LocalScalar(function.Load(position));
+                    topScores[p] = score;
+                    topIndices[p] = index;
+                    function.Store(numCandidates, function.Select(isFull, count, count + 1));
+                });
+            });
+        });
+
+        // 3. Decode the candidates, best first, and suppress the ones that overlap a better box of the same class
+        function.For(maxBoxes * boxSize, [=](IRFunctionEmitter& function, IRLocalScalar i) {
+            output[i] = function.LocalScalar<ValueType>(0);
+        });
+        function.For(maxBoxes, [=](IRFunctionEmitter& function, IRLocalScalar b) {
+            output[b * boxSize + 5] = function.LocalScalar<ValueType>(-1);
+        });
+
+        auto numKept = function.Variable(emitters::VariableType::Int32, "numKept");
+        function.Store(numKept, function.LocalScalar<int>(0));
+        function.For(function.Load(numCandidates), [=](IRFunctionEmitter& function, IRLocalScalar candidate) {
+            auto kept = function.LocalScalar(function.Load(numKept));
+            function.If(kept < maxBoxes, [=](IRFunctionEmitter& function) {
+                IRLocalScalar index = topIndices[candidate];
+                auto box = index % numBoxesPerCell;
+                auto cell = index / numBoxesPerCell;
+                auto row = cell / numColumns;
+                auto column = cell % numColumns;
+                auto boxOffset = inputOffset + row * rowIncrement + column * columnIncrement + box * (boxStride * channelIncrement);
+                auto toValue = [&function](IRLocalScalar x) { return function.LocalScalar(function.CastValue<ValueType>(x)); };
+
+                IRLocalScalar tx = input[boxOffset];
+                IRLocalScalar ty = input[boxOffset + channelIncrement];
+                IRLocalScalar tw = input[boxOffset + 2 * channelIncrement];
+                IRLocalScalar th = input[boxOffset + 3 * channelIncrement];
+                IRLocalScalar anchorWidth = anchorScales[box * 2];
+                IRLocalScalar anchorHeight = anchorScales[box * 2 + 1];
+                std::vector<IRLocalScalar> decoded = {
+                    (toValue(column) + Sigmoid(tx)) / static_cast<ValueType>(numColumns),
+                    (toValue(row) + Sigmoid(ty)) / static_cast<ValueType>(numRows),
+                    Exp(tw) * anchorWidth / static_cast<ValueType>(numColumns),
+                    Exp(th) * anchorHeight / static_cast<ValueType>(numRows),
+                    topScores[candidate],
+                    toValue(classes[index])
+                };
+
+                auto isSuppressed = function.Variable(emitters::VariableType::Int32, "isSuppressed");
+                function.Store(isSuppressed, function.LocalScalar<int>(0));
+                function.For(kept, [=](IRFunctionEmitter& function, IRLocalScalar k) {
+                    std::vector<IRLocalScalar> keptBox;
+                    for (int i = 0; i < boxSize; ++i)
+                    {
+                        keptBox.push_back(output[k * boxSize + i]);
+                    }
+                    function.If(keptBox[5] == decoded[5], [=](IRFunctionEmitter& function) {
+                        function.If(EmitOverlaps(function, keptBox, decoded, nmsThreshold), [=](IRFunctionEmitter& function) {
+                            function.Store(isSuppressed, function.LocalScalar<int>(1));
+                        });
+                    });
+                });
+
+                function.If(function.LocalScalar(function.Load(isSuppressed)) == 0, [=](IRFunctionEmitter& function) {
+                    for (int i = 0; i < boxSize; ++i)
+                    {
+                        output[kept * boxSize + i] = decoded[i];
+                    }
+                    function.Store(numKept, kept + 1);
+                });
+            });
+        });
+    }
+
+    template <typename ValueType>
+    void RegionDetectionPostProcessingNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        model::CompilableNode::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["inputLayout"] << _inputMemoryLayout;
+        archiver["width"] << _detectionParameters.width;
+        archiver["height"] << _detectionParameters.height;
+        archiver["numBoxesPerCell"] << _detectionParameters.numBoxesPerCell;
+        archiver["numClasses"] << _detectionParameters.numClasses;
+        archiver["numAnchors"] << _detectionParameters.numAnchors;
+        archiver["anchorScales"] << _postProcessingParameters.anchorScales;
+        archiver["confidenceThreshold"] << _postProcessingParameters.confidenceThreshold;
+        archiver["nmsThreshold"] << _postProcessingParameters.nmsThreshold;
+        archiver["maxBoxes"] << _postProcessingParameters.maxBoxes;
+        archiver["maxCandidates"] << _postProcessingParameters.maxCandidates;
+    }
+
+    template <typename ValueType>
+    void RegionDetectionPostProcessingNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        model::CompilableNode::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["inputLayout"] >> _inputMemoryLayout;
+        archiver["width"] >> _detectionParameters.width;
+        archiver["height"] >> _detectionParameters.height;
+        archiver["numBoxesPerCell"] >> _detectionParameters.numBoxesPerCell;
+        archiver["numClasses"] >> _detectionParameters.numClasses;
+        archiver["numAnchors"] >> _detectionParameters.numAnchors;
+        archiver["anchorScales"] >> _postProcessingParameters.anchorScales;
+        archiver["confidenceThreshold"] >> _postProcessingParameters.confidenceThreshold;
+        archiver["nmsThreshold"] >> _postProcessingParameters.nmsThreshold;
+        archiver["maxBoxes"] >> _postProcessingParameters.maxBoxes;
+        archiver["maxCandidates"] >> _postProcessingParameters.maxCandidates;
+        _output.SetSize(_postProcessingParameters.maxBoxes * boxSize);
+        VerifyParameters();
+    }
+
+    // Explicit specializations
+    template class RegionDetectionPostProcessingNode<float>;
+    template class RegionDetectionPostProcessingNode<double>;
+} // namespace nodes
+} // namespace ell
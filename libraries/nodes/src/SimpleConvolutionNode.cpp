@@ -13,6 +13,8 @@
 
 #include <math/include/Matrix.h>
 
+#include <algorithm>
+
 namespace ell
 {
 namespace nodes
@@ -22,6 +24,52 @@ namespace nodes
         using namespace ::ell::emitters;
         using namespace ::ell::model;
 
+        // The window offsets, in [begin, end), that fall inside the input for one output row or column
+        struct WindowRange
+        {
+            int begin;
+            int end;
+        };
+
+        // Returns the number of rows (or columns) of padding the filter needs that aren't stored in the input
+        int GetMissingPadding(const PortMemoryLayout& inputLayout, int dimension, int filterSize)
+        {
+            const auto inputPadding = inputLayout.GetLogicalDimensionOffset(dimension);
+            assert((inputPadding <= filterSize / 2) && "Input padding must be at most filterSize/2");
+            return filterSize / 2 - inputPadding;
+        }
+
+        WindowRange GetWindowRange(int outputIndex, int stride, int missingPadding, int inputExtent, int filterSize)
+        {
+            const auto inputIndex = outputIndex * stride - missingPadding;
+            return { std::max(0, -inputIndex), std::min(filterSize, inputExtent - inputIndex) };
+        }
+
+        // Calls `body` for every output index along one dimension. The indices whose whole window is inside the input
+        // are visited by a loop, and the few near the boundary (when the input isn't padded) are unrolled with the
+        // window clipped to the input, so the generated code never tests whether an input element exists.
+        template <typename BodyFunction>
+        void ForEachOutputIndex(IRFunctionEmitter& function, int outputSize, int stride, int missingPadding, int inputExtent, int filterSize, BodyFunction body)
+        {
+            const auto interiorBegin = std::min(outputSize, (missingPadding + stride - 1) / stride);
+            const auto lastInteriorInput = inputExtent - filterSize + missingPadding;
+            const auto interiorEnd = lastInteriorInput < 0 ? interiorBegin : std::max(interiorBegin, std::min(outputSize, lastInteriorInput / stride + 1));
+            for (int index = 0; index < interiorBegin; ++index)
+            {
+                body(function, function.LocalScalar(index), GetWindowRange(index, stride, missingPadding, inputExtent, filterSize));
+            }
+            if (interiorEnd > interiorBegin)
+            {
+                function.For(interiorBegin, interiorEnd, [body, filterSize](IRFunctionEmitter& function, IRLocalScalar index) {
+                    body(function, index, WindowRange{ 0, filterSize });
+                });
+            }
+            for (int index = interiorEnd; index < outputSize; ++index)
+            {
+                body(function, function.LocalScalar(index), GetWindowRange(index, stride, missingPadding, inputExtent, filterSize));
+            }
+        }
+
         //
         // Low-level code-generation
         //
@@ -30,6 +78,7 @@ namespace nodes
         {
             // input is a d x (w+2p) x (h+2p) array
             // reshaped, it's a d*(w+2p)) x (h+2p) array == d*(w+k-1) x (h+k-1)
+            // If p is less than k/2, the missing rows and columns are treated as zero
 
             // filterWeights is f x k x k x d array
             // reshaped, it's (f*k) x (k*d) or f x k x (k*d)
@@ -37,66 +86,61 @@ namespace nodes
             // output is a (w+2p) x (h+2p) x f array
 
             // Model parameters
-            const auto inputPadding = inputLayout.GetLogicalDimensionOffset(0);
-            DEBUG_USED(inputPadding);
-            assert((inputPadding == filterSize / 2) && "Input padding must be filterSize/2");
-
+            const auto missingRows = GetMissingPadding(inputLayout, 0, filterSize);
+            const auto missingColumns = GetMissingPadding(inputLayout, 1, filterSize);
             auto inputMemoryIncrements = inputLayout.GetCumulativeIncrement();
 
             // For each filter
             const auto numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
-            function.ParallelFor(numFilters, { input, filterWeights, result }, [inputLayout, outputLayout, inputMemoryIncrements, filterSize, stride](IRFunctionEmitter& function, IRLocalScalar filterIndex, const std::vector<LLVMValue>& capturedValues) {
+            function.ParallelFor(numFilters, { input, filterWeights, result }, [inputLayout, outputLayout, inputMemoryIncrements, filterSize, stride, missingRows, missingColumns](IRFunctionEmitter& function, IRLocalScalar filterIndex, const std::vector<LLVMValue>& capturedValues) {
                 auto input = capturedValues[0];
                 auto filterWeights = capturedValues[1];
                 auto result = capturedValues[2];
                 auto outputTensor = function.LocalTensor(result, outputLayout.GetLogicalDimensionExtent().ToVector(), RowMajorTensorLayout);
 
+                const bool canCombineColumns = (inputLayout.GetLogicalDimensionActiveSize(1) == inputLayout.GetLogicalDimensionExtent(1)) && (stride == 1);
+                const auto inputDepth = inputLayout.GetLogicalDimensionActiveSize(2);
+
                 // For each output row
                 const auto outputRows = outputLayout.GetLogicalDimensionActiveSize(0);
-                function.For(outputRows, [filterIndex, input, filterWeights, inputLayout, outputLayout, inputMemoryIncrements, outputTensor, filterSize, stride](IRFunctionEmitter& function, LLVMValue loopIndex2) {
-                    auto outputRow = function.LocalScalar(loopIndex2);
-
+                ForEachOutputIndex(function, outputRows, stride, missingRows, inputLayout.GetLogicalDimensionExtent(0), filterSize, [=](IRFunctionEmitter& function, IRLocalScalar outputRow, WindowRange windowRows) {
                     // For each output column
                     const auto outputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
-                    function.For(outputColumns, [outputRow, filterIndex, input, filterWeights, inputLayout, inputMemoryIncrements, outputTensor, filterSize, stride](IRFunctionEmitter& function, LLVMValue loopIndex3) {
-                        auto outputColumn = function.LocalScalar(loopIndex3);
-
-                        const bool canCombineColumns = (inputLayout.GetLogicalDimensionActiveSize(1) == inputLayout.GetLogicalDimensionExtent(1)) && (stride == 1);
-                        const auto inputDepth = inputLayout.GetLogicalDimensionActiveSize(2);
+                    ForEachOutputIndex(function, outputColumns, stride, missingColumns, inputLayout.GetLogicalDimensionExtent(1), filterSize, [=](IRFunctionEmitter& function, IRLocalScalar outputColumn, WindowRange windowColumns) {
+                        auto inputRow = outputRow * stride - missingRows;
+                        auto inputColumn = outputColumn * stride - missingColumns;
 
                         // The filters are typically small, so we unroll the loops here
                         auto val = function.LocalScalar(ValueType{ 0 });
-                        for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+                        for (int windowRow = windowRows.begin; windowRow < windowRows.end; ++windowRow)
                         {
                             // Note: if the memory storage from consecutive columns is contiguous, we can process them together and avoid a loop
-                            if (canCombineColumns)
+                            if (canCombineColumns && windowColumns.begin == 0 && windowColumns.end == filterSize)
                             {
-                                auto inputOffset = ((outputRow + windowRow) * inputMemoryIncrements[0]) +
-                                                   (outputColumn * inputMemoryIncrements[1]);
+                                auto inputOffset = ((inputRow + windowRow) * inputMemoryIncrements[0]) +
+                                                   (inputColumn * inputMemoryIncrements[1]);
                                 auto imageRow = function.PointerOffset(input, inputOffset);
                                 auto filterOffset = inputDepth * (filterSize * windowRow) +
                                                     filterIndex * (filterSize * filterSize * inputDepth);
                                 auto filterRow = function.PointerOffset(filterWeights, filterOffset);
-                                val = val + function.DotProduct(filterSize * inputDepth, imageRow, filterRow);
+                                val = val + function.WeightsDotProduct(filterSize * inputDepth, imageRow, filterRow);
                             }
                             else
                             {
-                                for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                                for (int windowColumn = windowColumns.begin; windowColumn < windowColumns.end; ++windowColumn)
                                 {
                                     // I[r+wc, c+wc]
-                                    auto inputRow = outputRow * stride;
-                                    auto inputColumn = outputColumn * stride;
                                     auto inputOffset = ((inputRow + windowRow) * inputMemoryIncrements[0]) +
                                                        ((inputColumn + windowColumn) * inputMemoryIncrements[1]);
                                     auto imageRow = function.PointerOffset(input, inputOffset);
                                     auto filterOffset = inputDepth * (filterSize * windowRow + windowColumn) +
                                                         filterIndex * (filterSize * filterSize * inputDepth);
                                     auto filterRow = function.PointerOffset(filterWeights, filterOffset);
-                                    val = val + function.DotProduct(inputDepth, imageRow, filterRow);
+                                    val = val + function.WeightsDotProduct(inputDepth, imageRow, filterRow);
                                 }
                             }
-                            outputTensor({ outputRow, outputColumn, filterIndex }) = val;
                         }
+                        outputTensor({ outputRow, outputColumn, filterIndex }) = val;
                     }); // End outputColumns loop
                 }); // End outputRows loop
             }); // End numFilters loop
@@ -106,19 +150,17 @@ namespace nodes
         void EmitSimpleDepthwiseSeparableConvolutionCode(IRFunctionEmitter& function, LLVMValue input, LLVMValue filterWeights, const PortMemoryLayout& inputLayout, const PortMemoryLayout& outputLayout, int filterSize, int stride, LLVMValue result)
         {
             const auto inputDepth = inputLayout.GetLogicalDimensionActiveSize(2);
-            const auto inputPadding = inputLayout.GetLogicalDimensionOffset(0);
-            DEBUG_USED(inputPadding, inputDepth);
-            assert((inputPadding == filterSize / 2) && "Input padding must be filterSize/2");
+            const auto missingRows = GetMissingPadding(inputLayout, 0, filterSize);
+            const auto missingColumns = GetMissingPadding(inputLayout, 1, filterSize);
+            DEBUG_USED(inputDepth);
 
             // output data parameters
             const auto numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
             assert(numFilters == inputDepth);
-            DEBUG_USED(numFilters);
 
             // For each filter
-            // For each output row
-            const auto outputRows = outputLayout.GetLogicalDimensionActiveSize(0);
-            function.ParallelFor(outputRows, { input, filterWeights, result }, [inputLayout, outputLayout, filterSize, stride](IRFunctionEmitter& function, auto outputRow, const std::vector<LLVMValue>& capturedValues) {
+            // The data is in channel-major order, so each filter reads and writes one contiguous plane
+            function.ParallelFor(numFilters, { input, filterWeights, result }, [inputLayout, outputLayout, filterSize, stride, missingRows, missingColumns](IRFunctionEmitter& function, IRLocalScalar filterIndex, const std::vector<LLVMValue>& capturedValues) {
                 auto input = capturedValues[0];
                 auto filterWeights = capturedValues[1];
                 auto result = capturedValues[2];
@@ -127,21 +169,21 @@ namespace nodes
                 auto outputTensor = function.LocalTensor(result, outputLayout.GetLogicalDimensionExtent().ToVector(), ChannelMajorTensorLayout);
                 auto filter = function.LocalTensor(filterWeights, { filterSize, filterSize, inputLayout.GetLogicalDimensionExtent(2) }, ChannelMajorTensorLayout);
 
-                // For each output column
-                const auto outputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
-                function.For(outputColumns, [outputLayout, outputRow, inputTensor, filter, outputTensor, filterSize, stride](IRFunctionEmitter& function, auto outputColumn) {
-                    // For each filter
-                    const auto numFilters = outputLayout.GetLogicalDimensionActiveSize(2);
-                    function.For(numFilters, [outputRow, outputColumn, inputTensor, filter, outputTensor, filterSize, stride](IRFunctionEmitter& function, auto filterIndex) {
+                // For each output row
+                const auto outputRows = outputLayout.GetLogicalDimensionActiveSize(0);
+                ForEachOutputIndex(function, outputRows, stride, missingRows, inputLayout.GetLogicalDimensionExtent(0), filterSize, [=](IRFunctionEmitter& function, IRLocalScalar outputRow, WindowRange windowRows) {
+                    // For each output column
+                    const auto outputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
+                    ForEachOutputIndex(function, outputColumns, stride, missingColumns, inputLayout.GetLogicalDimensionExtent(1), filterSize, [=](IRFunctionEmitter& function, IRLocalScalar outputColumn, WindowRange windowColumns) {
+                        auto inputRow = outputRow * stride - missingRows;
+                        auto inputColumn = outputColumn * stride - missingColumns;
+
                         // The filters are typically small, so we unroll the loops here
                         auto val = function.LocalScalar(ValueType{ 0 });
-                        for (int windowRow = 0; windowRow < filterSize; ++windowRow)
+                        for (int windowRow = windowRows.begin; windowRow < windowRows.end; ++windowRow)
                         {
-                            for (int windowColumn = 0; windowColumn < filterSize; ++windowColumn)
+                            for (int windowColumn = windowColumns.begin; windowColumn < windowColumns.end; ++windowColumn)
                             {
-                                auto inputRow = outputRow * stride;
-                                auto inputColumn = outputColumn * stride;
-
                                 auto filterRow = function.LocalScalar(windowRow);
                                 auto filterColumn = function.LocalScalar(windowColumn);
 
@@ -283,6 +325,14 @@ namespace nodes
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
+    template <typename ValueType>
+    int64_t SimpleConvolutionComputeNode<ValueType>::GetOperationCount() const
+    {
+        const int64_t numOutputs = GetOutputMemoryLayout().GetActiveSize().NumElements();
+        const int64_t channelsPerFilter = _isDepthwiseSeparable ? 1 : _inputMemoryLayout.GetLogicalDimensionActiveSize(2);
+        return 2 * numOutputs * _filterSize * _filterSize * channelsPerFilter;
+    }
+
     template <typename ValueType>
     void SimpleConvolutionComputeNode<ValueType>::Compute() const
     {
@@ -304,13 +354,14 @@ namespace nodes
         options.parallelize = parallelize;
         function.SetCompilerOptions(options);
 
-        // input is a d x (w+2p) x (h+2p) array
-        // reshaped, it's a d*(w+2p)) x (h+2p) array == d*(w+k-1) x (h+k-1)
+        // input is a d x (w+2p) x (h+2p) array, where p is at most k/2
+        // reshaped, it's a d*(w+2p)) x (h+2p) array
         LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
 
         // weights is f x k x k x d array
         // reshaped, it's (f*k) x (k*d) or f x k x (k*d)
-        LLVMValue pWeights = compiler.EnsurePortEmitted(this->filterWeights);
+        // The depthwise-separable code indexes the weights as a tensor, so they're only stored in reduced precision for regular convolutions
+        LLVMValue pWeights = _isDepthwiseSeparable ? compiler.EnsurePortEmitted(this->filterWeights) : EnsureWeightsEmitted(compiler, function, this->filterWeights);
 
         // output is a (w+2p) x (h+2p) x f array
         LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
@@ -318,9 +369,6 @@ namespace nodes
         // Model parameters
         const auto inputLayout = this->GetInputMemoryLayout();
         const auto outputLayout = this->GetOutputMemoryLayout();
-        const auto inputPadding = inputLayout.GetLogicalDimensionOffset(0);
-        DEBUG_USED(inputPadding);
-        assert((inputPadding == _filterSize / 2) && "Input padding must be filterSize/2");
 
         if (!_isDepthwiseSeparable)
         {
@@ -0,0 +1,419 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SparseMatrixMultiplyNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SparseMatrixMultiplyNode.h"
+
+#include <emitters/include/IRLocalArray.h>
+#include <emitters/include/IRVectorUtilities.h>
+
+#include <utilities/include/Exception.h>
+
+namespace ell
+{
+namespace nodes
+{
+    namespace
+    {
+        template <typename ValueType>
+        ValueType GetWeight(const std::vector<ValueType>& weights, int weightsStride, bool transposeWeights, int row, int column)
+        {
+            return weights[transposeWeights ? column * weightsStride + row : row * weightsStride + column];
+        }
+
+        template <typename ValueType>
+        bool IsBlockNonzero(const std::vector<ValueType>& weights, int weightsStride, bool transposeWeights, int firstRow, int firstColumn, int blockRows, int blockColumns)
+        {
+            for (int row = firstRow; row < firstRow + blockRows; ++row)
+            {
+                for (int column = firstColumn; column < firstColumn + blockColumns; ++column)
+                {
+                    if (GetWeight(weights, weightsStride, transposeWeights, row, column) != 0)
+                    {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        void CheckBlockSize(int m, int k, int blockRows, int blockColumns)
+        {
+            if (blockRows < 1 || blockColumns < 1 || m % blockRows != 0 || k % blockColumns != 0)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "SparseMatrixMultiplyNode: the blocks must evenly divide the weights");
+            }
+        }
+    } // namespace
+
+    template <typename ValueType>
+    SparseMatrixMultiplyNode<ValueType>::SparseMatrixMultiplyNode() :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, {}, defaultInputPortName),
+        _output(this, defaultOutputPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    SparseMatrixMultiplyNode<ValueType>::SparseMatrixMultiplyNode(const model::OutputPort<ValueType>& input, const std::vector<ValueType>& weights, int m, int n, int k, int weightsStride, bool transposeWeights, int inputStride, bool transposeInput, int outputStride, bool transposeOutput, int blockRows, int blockColumns) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, m * n),
+        _m(m),
+        _n(n),
+        _k(k),
+        _ldb(inputStride),
+        _ldc(outputStride),
+        _transposeInput(transposeInput),
+        _transposeOutput(transposeOutput),
+        _blockRows(blockRows),
+        _blockColumns(blockColumns)
+    {
+        CheckBlockSize(m, k, blockRows, blockColumns);
+        if (static_cast<int>(input.Size()) != k * n)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "SparseMatrixMultiplyNode: input matrix size incorrect");
+        }
+        if (m > 0 && k > 0 && static_cast<int>(weights.size()) <= (transposeWeights ? (k - 1) * weightsStride + m - 1 : (m - 1) * weightsStride + k - 1))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "SparseMatrixMultiplyNode: weights matrix size incorrect");
+        }
+
+        _blockRowStarts.push_back(0);
+        for (int firstRow = 0; firstRow < m; firstRow += blockRows)
+        {
+            for (int firstColumn = 0; firstColumn < k; firstColumn += blockColumns)
+            {
+                if (IsBlockNonzero(weights, weightsStride, transposeWeights, firstRow, firstColumn, blockRows, blockColumns))
+                {
+                    _blockColumnIndices.push_back(firstColumn);
+                    for (int row = firstRow; row < firstRow + blockRows; ++row)
+                    {
+                        for (int column = firstColumn; column < firstColumn + blockColumns; ++column)
+                        {
+                            _blockValues.push_back(GetWeight(weights, weightsStride, transposeWeights, row, column));
+                        }
+                    }
+                }
+            }
+            _blockRowStarts.push_back(static_cast<int>(_blockColumnIndices.size()));
+        }
+    }
+
+    template <typename ValueType>
+    SparseMatrixMultiplyNode<ValueType>::SparseMatrixMultiplyNode(const model::OutputPort<ValueType>& input, const SparseMatrixMultiplyNode<ValueType>& other) :
+        CompilableNode({ &_input }, { &_output }),
+        _input(this, input, defaultInputPortName),
+        _output(this, defaultOutputPortName, other._m * other._n),
+        _m(other._m),
+        _n(other._n),
+        _k(other._k),
+        _ldb(other._ldb),
+        _ldc(other._ldc),
+        _transposeInput(other._transposeInput),
+        _transposeOutput(other._transposeOutput),
+        _blockRows(other._blockRows),
+        _blockColumns(other._blockColumns),
+        _blockRowStarts(other._blockRowStarts),
+        _blockColumnIndices(other._blockColumnIndices),
+        _blockValues(other._blockValues),
+        _epilogue(other._epilogue)
+    {
+    }
+
+    template <typename ValueType>
+    int SparseMatrixMultiplyNode<ValueType>::CountNonzeroBlocks(const std::vector<ValueType>& weights, int m, int k, int weightsStride, bool transposeWeights, int blockRows, int blockColumns)
+    {
+        CheckBlockSize(m, k, blockRows, blockColumns);
+        int count = 0;
+        for (int firstRow = 0; firstRow < m; firstRow += blockRows)
+        {
+            for (int firstColumn = 0; firstColumn < k; firstColumn += blockColumns)
+            {
+                if (IsBlockNonzero(weights, weightsStride, transposeWeights, firstRow, firstColumn, blockRows, blockColumns))
+                {
+                    ++count;
+                }
+            }
+        }
+        return count;
+    }
+
+    template <typename ValueType>
+    int64_t SparseMatrixMultiplyNode<ValueType>::GetOperationCount() const
+    {
+        return 2 * static_cast<int64_t>(_blockValues.size()) * _n;
+    }
+
+    template <typename ValueType>
+    bool SparseMatrixMultiplyNode<ValueType>::CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const
+    {
+        // The output must be read as an image with the channels in the (contiguous) columns
+        const int numColumns = _transposeOutput ? _m : _n;
+        return _ldc == numColumns && outputLayout.NumDimensions() == 3 && outputLayout.IsCanonicalOrder() && !outputLayout.HasPadding() &&
+               outputLayout.GetLogicalDimensionActiveSize(2) == numColumns && static_cast<int>(outputLayout.NumElements()) == _m * _n;
+    }
+
+    template <typename ValueType>
+    void SparseMatrixMultiplyNode<ValueType>::Compute() const
+    {
+        auto inputValues = _input.GetValue();
+        std::vector<ValueType> outputValues(_output.Size());
+        const int blockSize = _blockRows * _blockColumns;
+        for (int column = 0; column < _n; ++column)
+        {
+            for (int blockRow = 0; blockRow < static_cast<int>(_blockRowStarts.size()) - 1; ++blockRow)
+            {
+                for (int blockRowOffset = 0; blockRowOffset < _blockRows; ++blockRowOffset)
+                {
+                    ValueType sum = 0;
+                    for (int block = _blockRowStarts[blockRow]; block < _blockRowStarts[blockRow + 1]; ++block)
+                    {
+                        for (int blockColumnOffset = 0; blockColumnOffset < _blockColumns; ++blockColumnOffset)
+                        {
+                            auto inputRow = _blockColumnIndices[block] + blockColumnOffset;
+                            auto inputValue = inputValues[_transposeInput ? column * _ldb + inputRow : inputRow * _ldb + column];
+                            sum += _blockValues[block * blockSize + blockRowOffset * _blockColumns + blockColumnOffset] * inputValue;
+                        }
+                    }
+
+                    // The output is a row-major matrix with _n columns, or _m if it's transposed, whose columns are the epilogue's channels
+                    auto row = blockRow * _blockRows + blockRowOffset;
+                    outputValues[_transposeOutput ? column * _ldc + row : row * _ldc + column] = _epilogue.Compute(sum, _transposeOutput ? row : column);
+                }
+            }
+        }
+        _output.SetOutput(outputValues);
+    }
+
+    template <typename ValueType>
+    void SparseMatrixMultiplyNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(output);
+
+        auto& module = function.GetModule();
+        const auto identifier = GetInternalStateIdentifier();
+        EmittedWeights weights;
+        weights.blockRowStarts = module.ConstantArray(identifier + "_blockRowStarts", _blockRowStarts);
+        weights.blockColumnIndices = module.ConstantArray(identifier + "_blockColumnIndices", _blockColumnIndices);
+        weights.blockValues = module.ConstantArray(identifier + "_blockValues", _blockValues);
+        auto epilogueConstants = _epilogue.EmitConstants(module, identifier);
+
+        // When the input's rows are contiguous, whole vectors of its columns are multiplied by each weight; the columns
+        // left over, or all of them if the input is transposed, are computed as sparse dot products
+        const int vectorSize = emitters::GetReductionVectorSize(function.GetCompilerOptions());
+        int beginColumn = 0;
+        if (!_transposeInput && vectorSize > 1 && _n >= vectorSize)
+        {
+            CompileColumnVectors(function, weights, pInput, pOutput, epilogueConstants, vectorSize);
+            beginColumn = (_n / vectorSize) * vectorSize;
+        }
+        if (beginColumn < _n)
+        {
+            CompileDotProducts(function, weights, pInput, pOutput, epilogueConstants, beginColumn);
+        }
+    }
+
+    template <typename ValueType>
+    void SparseMatrixMultiplyNode<ValueType>::CompileDotProducts(emitters::IRFunctionEmitter& function, const EmittedWeights& weights, emitters::LLVMValue input, emitters::LLVMValue output, const typename OutputEpilogue<ValueType>::EmittedConstants& epilogueConstants, int beginColumn)
+    {
+        const int numBlockRows = static_cast<int>(_blockRowStarts.size()) - 1;
+        const int blockRows = _blockRows;
+        const int blockColumns = _blockColumns;
+        const int blockSize = blockRows * blockColumns;
+        const int ldb = _ldb;
+        const bool transposeInput = _transposeInput;
+
+        // The entries of a block of the input's column are contiguous if it's transposed or it's a vector, so they can be loaded as one vector
+        const bool contiguousColumns = transposeInput || (_n == 1 && ldb == 1);
+        const bool vectorize = contiguousColumns && blockColumns > 1 && function.GetCompilerOptions().allowVectorInstructions;
+        auto accumulatorType = function.GetEmitter().Type(emitters::GetVariableType<ValueType>());
+        auto zero = function.Literal<ValueType>(0);
+        if (vectorize)
+        {
+            auto vectorType = function.GetEmitter().VectorType(emitters::GetVariableType<ValueType>(), blockColumns);
+            accumulatorType = vectorType;
+            zero = emitters::FillVector<ValueType>(function, vectorType, 0);
+        }
+
+        function.For(beginColumn, _n, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar column) {
+            function.For(numBlockRows, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar blockRow) {
+                const auto add = emitters::GetAddForValueType<ValueType>();
+                const auto multiply = emitters::GetMultiplyForValueType<ValueType>();
+                std::vector<emitters::LLVMValue> accumulators;
+                for (int blockRowOffset = 0; blockRowOffset < blockRows; ++blockRowOffset)
+                {
+                    accumulators.push_back(function.Variable(accumulatorType, "sum"));
+                    function.Store(accumulators.back(), zero);
+                }
+
+                auto blockRowStarts = function.LocalArray(weights.blockRowStarts);
+                auto blockColumnIndices = function.LocalArray(weights.blockColumnIndices);
+                emitters::IRLocalScalar beginBlock = blockRowStarts[blockRow];
+                emitters::IRLocalScalar endBlock = blockRowStarts[blockRow + 1];
+                function.For(beginBlock, endBlock, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar block) {
+                    emitters::IRLocalScalar firstRow = blockColumnIndices[block];
+                    auto blockStart = block * blockSize;
+                    if (vectorize)
+                    {
+                        // The input's entries are loaded once for all the rows of the block
+                        auto inputOffset = transposeInput ? column * ldb + firstRow : firstRow;
+                        auto inputVector = emitters::LoadUnalignedVector<ValueType>(function, input, inputOffset, blockColumns);
+                        for (int blockRowOffset = 0; blockRowOffset < blockRows; ++blockRowOffset)
+                        {
+                            auto weightsVector = emitters::LoadUnalignedVector<ValueType>(function, weights.blockValues, blockStart + blockRowOffset * blockColumns, blockColumns);
+                            function.OperationAndUpdate(accumulators[blockRowOffset], add, function.Operator(multiply, weightsVector, inputVector));
+                        }
+                    }
+                    else
+                    {
+                        for (int blockColumnOffset = 0; blockColumnOffset < blockColumns; ++blockColumnOffset)
+                        {
+                            auto inputRow = firstRow + blockColumnOffset;
+                            auto inputValue = function.ValueAt(input, transposeInput ? column * ldb + inputRow : inputRow * ldb + column);
+                            for (int blockRowOffset = 0; blockRowOffset < blockRows; ++blockRowOffset)
+                            {
+                                auto weight = function.ValueAt(weights.blockValues, blockStart + (blockRowOffset * blockColumns + blockColumnOffset));
+                                function.OperationAndUpdate(accumulators[blockRowOffset], add, function.Operator(multiply, weight, inputValue));
+                            }
+                        }
+                    }
+                });
+
+                for (int blockRowOffset = 0; blockRowOffset < blockRows; ++blockRowOffset)
+                {
+                    auto sum = function.LocalScalar(emitters::HorizontalVectorSum<ValueType>(function, function.Load(accumulators[blockRowOffset])));
+                    CompileStoreResult(function, output, epilogueConstants, blockRow * blockRows + blockRowOffset, column, sum);
+                }
+            });
+        });
+    }
+
+    template <typename ValueType>
+    void SparseMatrixMultiplyNode<ValueType>::CompileColumnVectors(emitters::IRFunctionEmitter& function, const EmittedWeights& weights, emitters::LLVMValue input, emitters::LLVMValue output, const typename OutputEpilogue<ValueType>::EmittedConstants& epilogueConstants, int vectorSize)
+    {
+        const int numBlockRows = static_cast<int>(_blockRowStarts.size()) - 1;
+        const int blockRows = _blockRows;
+        const int blockColumns = _blockColumns;
+        const int blockSize = blockRows * blockColumns;
+        const int ldb = _ldb;
+        auto vectorType = function.GetEmitter().VectorType(emitters::GetVariableType<ValueType>(), vectorSize);
+        auto zero = emitters::FillVector<ValueType>(function, vectorType, 0);
+
+        // Each weight multiplies a vector of consecutive entries of a row of the input, which is added to the vector of
+        // the output's entries in the weight's row
+        function.For(_n / vectorSize, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar tile) {
+            auto firstColumn = tile * vectorSize;
+            function.For(numBlockRows, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar blockRow) {
+                const auto add = emitters::GetAddForValueType<ValueType>();
+                const auto multiply = emitters::GetMultiplyForValueType<ValueType>();
+                auto& irBuilder = function.GetEmitter().GetIRBuilder();
+                std::vector<emitters::LLVMValue> accumulators;
+                for (int blockRowOffset = 0; blockRowOffset < blockRows; ++blockRowOffset)
+                {
+                    accumulators.push_back(function.Variable(vectorType, "sums"));
+                    function.Store(accumulators.back(), zero);
+                }
+
+                auto blockRowStarts = function.LocalArray(weights.blockRowStarts);
+                auto blockColumnIndices = function.LocalArray(weights.blockColumnIndices);
+                emitters::IRLocalScalar beginBlock = blockRowStarts[blockRow];
+                emitters::IRLocalScalar endBlock = blockRowStarts[blockRow + 1];
+                function.For(beginBlock, endBlock, [=, &irBuilder](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar block) {
+                    emitters::IRLocalScalar firstRow = blockColumnIndices[block];
+                    auto blockStart = block * blockSize;
+                    for (int blockColumnOffset = 0; blockColumnOffset < blockColumns; ++blockColumnOffset)
+                    {
+                        auto inputVector = emitters::LoadUnalignedVector<ValueType>(function, input, (firstRow + blockColumnOffset) * ldb + firstColumn, vectorSize);
+                        for (int blockRowOffset = 0; blockRowOffset < blockRows; ++blockRowOffset)
+                        {
+                            auto weight = function.ValueAt(weights.blockValues, blockStart + (blockRowOffset * blockColumns + blockColumnOffset));
+                            auto weightVector = irBuilder.CreateVectorSplat(vectorSize, weight);
+                            function.OperationAndUpdate(accumulators[blockRowOffset], add, function.Operator(multiply, weightVector, inputVector));
+                        }
+                    }
+                });
+
+                for (int blockRowOffset = 0; blockRowOffset < blockRows; ++blockRowOffset)
+                {
+                    auto sums = function.Load(accumulators[blockRowOffset]);
+                    for (int lane = 0; lane < vectorSize; ++lane)
+                    {
+                        auto sum = function.LocalScalar(irBuilder.CreateExtractElement(sums, static_cast<uint64_t>(lane)));
+                        CompileStoreResult(function, output, epilogueConstants, blockRow * blockRows + blockRowOffset, firstColumn + lane, sum);
+                    }
+                }
+            });
+        });
+    }
+
+    template <typename ValueType>
+    void SparseMatrixMultiplyNode<ValueType>::CompileStoreResult(emitters::IRFunctionEmitter& function, emitters::LLVMValue output, const typename OutputEpilogue<ValueType>::EmittedConstants& epilogueConstants, emitters::IRLocalScalar row, emitters::IRLocalScalar column, emitters::IRLocalScalar value)
+    {
+        if (!_epilogue.IsEmpty())
+        {
+            value = _epilogue.Compile(function, epilogueConstants, value, _transposeOutput ? row : column);
+        }
+        function.SetValueAt(output, _transposeOutput ? column * _ldc + row : row * _ldc + column, value);
+    }
+
+    template <typename ValueType>
+    void SparseMatrixMultiplyNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<SparseMatrixMultiplyNode<ValueType>>(newInput, *this);
+        transformer.MapNodeOutput(output, newNode->output);
+    }
+
+    template <typename ValueType>
+    void SparseMatrixMultiplyNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver[defaultOutputPortName] << _output;
+        archiver["m"] << _m;
+        archiver["n"] << _n;
+        archiver["k"] << _k;
+        archiver["ldb"] << _ldb;
+        archiver["ldc"] << _ldc;
+        archiver["transposeInput"] << _transposeInput;
+        archiver["transposeOutput"] << _transposeOutput;
+        archiver["blockRows"] << _blockRows;
+        archiver["blockColumns"] << _blockColumns;
+        archiver["blockRowStarts"] << _blockRowStarts;
+        archiver["blockColumnIndices"] << _blockColumnIndices;
+        archiver["blockValues"] << _blockValues;
+        _epilogue.WriteToArchive(archiver);
+    }
+
+    template <typename ValueType>
+    void SparseMatrixMultiplyNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver[defaultOutputPortName] >> _output;
+        archiver["m"] >> _m;
+        archiver["n"] >> _n;
+        archiver["k"] >> _k;
+        archiver["ldb"] >> _ldb;
+        archiver["ldc"] >> _ldc;
+        archiver["transposeInput"] >> _transposeInput;
+        archiver["transposeOutput"] >> _transposeOutput;
+        archiver["blockRows"] >> _blockRows;
+        archiver["blockColumns"] >> _blockColumns;
+        archiver["blockRowStarts"] >> _blockRowStarts;
+        archiver["blockColumnIndices"] >> _blockColumnIndices;
+        archiver["blockValues"] >> _blockValues;
+        _epilogue.ReadFromArchive(archiver);
+    }
+
+    // Explicit instantiations
+    template class SparseMatrixMultiplyNode<float>;
+    template class SparseMatrixMultiplyNode<double>;
+} // namespace nodes
+} // namespace ell
@@ -0,0 +1,217 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     TopKNode.cpp (nodes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "TopKNode.h"
+
+#include <emitters/include/IRLocalScalar.h>
+#include <emitters/include/IRMath.h>
+#include <emitters/include/IRVectorUtilities.h>
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace ell
+{
+namespace nodes
+{
+    template <typename ValueType>
+    TopKNode<ValueType>::TopKNode() :
+        CompilableNode({ &_input }, { &_values, &_indices }),
+        _input(this, {}, defaultInputPortName),
+        _values(this, valuesPortName, 0),
+        _indices(this, indicesPortName, 0)
+    {
+    }
+
+    template <typename ValueType>
+    TopKNode<ValueType>::TopKNode(const model::OutputPort<ValueType>& input, size_t k, bool normalizeSoftmax) :
+        CompilableNode({ &_input }, { &_values, &_indices }),
+        _input(this, input, defaultInputPortName),
+        _values(this, valuesPortName, k),
+        _indices(this, indicesPortName, k),
+        _k(k),
+        _normalizeSoftmax(normalizeSoftmax)
+    {
+        if (k == 0 || k > input.Size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "TopKNode: k must be between 1 and the size of the input");
+        }
+    }
+
+    template <typename ValueType>
+    void TopKNode<ValueType>::Compute() const
+    {
+        auto inputValues = _input.GetValue();
+        std::vector<int> order(inputValues.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::partial_sort(order.begin(), order.begin() + _k, order.end(), [&inputValues](int a, int b) {
+            return inputValues[a] > inputValues[b] || (inputValues[a] == inputValues[b] && a < b);
+        });
+        order.resize(_k);
+
+        std::vector<ValueType> topValues(_k);
+        std::transform(order.begin(), order.end(), topValues.begin(), [&inputValues](int index) { return inputValues[index]; });
+        if (_normalizeSoftmax)
+        {
+            auto maxValue = topValues[0];
+            ValueType sum = 0;
+            for (auto x : inputValues)
+            {
+                sum += std::exp(x - maxValue);
+            }
+            for (auto& x : topValues)
+            {
+                x = std::exp(x - maxValue) / sum;
+            }
+        }
+        _values.SetOutput(topValues);
+        _indices.SetOutput(order);
+    }
+
+    template <typename ValueType>
+    void TopKNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        if (_input.GetReferencedPort().GetMemoryLayout().HasPadding())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "TopKNode: the input must not have padding");
+        }
+
+        const int size = static_cast<int>(input.Size());
+        const int k = static_cast<int>(_k);
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(input);
+        emitters::LLVMValue pValues = compiler.EnsurePortEmitted(values);
+        emitters::LLVMValue pIndices = compiler.EnsurePortEmitted(indices);
+        auto& builder = function.GetEmitter().GetIRBuilder();
+        const auto isGreater = emitters::GetComparison<ValueType>(emitters::BinaryPredicateType::greater);
+
+        // The output arrays hold the largest entries so far in descending order, and an index of -1 marks an empty slot
+        function.For(k, [pIndices](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar slot) {
+            function.SetValueAt(pIndices, slot, function.Literal<int>(-1));
+        });
+
+        // Inserts an entry in order, moving the entries smaller than it down a slot. The slots are loaded before any
+        // of them is stored, and each one is a select between its old entry, the new one and the one above it.
+        auto insert = [pValues, pIndices, k, isGreater, &builder](emitters::IRFunctionEmitter& function, emitters::LLVMValue value, emitters::LLVMValue index) {
+            std::vector<emitters::LLVMValue> slotValues(k);
+            std::vector<emitters::LLVMValue> slotIndices(k);
+            std::vector<emitters::LLVMValue> isBeaten(k);
+            for (int slot = 0; slot < k; ++slot)
+            {
+                slotValues[slot] = function.ValueAt(pValues, function.Literal<int>(slot));
+                slotIndices[slot] = function.ValueAt(pIndices, function.Literal<int>(slot));
+                auto isEmpty = function.Comparison(emitters::TypedComparison::lessThan, slotIndices[slot], function.Literal<int>(0));
+                isBeaten[slot] = builder.CreateOr(function.Comparison(isGreater, value, slotValues[slot]), isEmpty);
+            }
+            for (int slot = 0; slot < k; ++slot)
+            {
+                auto newValue = function.Select(isBeaten[slot], value, slotValues[slot]);
+                auto newIndex = function.Select(isBeaten[slot], index, slotIndices[slot]);
+                if (slot > 0)
+                {
+                    newValue = function.Select(isBeaten[slot - 1], slotValues[slot - 1], newValue);
+                    newIndex = function.Select(isBeaten[slot - 1], slotIndices[slot - 1], newIndex);
+                }
+                function.SetValueAt(pValues, function.Literal<int>(slot), newValue);
+                function.SetValueAt(pIndices, function.Literal<int>(slot), newIndex);
+            }
+        };
+
+        // Once the slots are full, an entry is only inserted if it beats the last one
+        auto insertIfGreater = [pInput, pValues, k, isGreater, &insert](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+            auto value = function.ValueAt(pInput, index);
+            function.If(function.Comparison(isGreater, value, function.ValueAt(pValues, function.Literal<int>(k - 1))), [&insert, value, index](emitters::IRFunctionEmitter& function) {
+                insert(function, value, index);
+            });
+        };
+
+        function.For(k, [pInput, &insert](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+            insert(function, function.ValueAt(pInput, index), index);
+        });
+
+        const int vectorSize = emitters::GetReductionVectorSize(function.GetCompilerOptions());
+        const int numVectors = vectorSize > 1 ? (size - k) / vectorSize : 0;
+        if (numVectors > 0)
+        {
+            // Compare a vector of entries to the last slot at a time, and only look at the entries one by one if one of them beats it
+            function.For(numVectors, [pInput, pValues, k, vectorSize, isGreater, &builder, &insertIfGreater](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar vectorIndex) {
+                auto start = vectorIndex * vectorSize + k;
+                auto entries = emitters::LoadUnalignedVector<ValueType>(function, pInput, start, vectorSize);
+                auto threshold = emitters::BroadcastVector(function, function.ValueAt(pValues, function.Literal<int>(k - 1)), vectorSize);
+                auto mask = builder.CreateBitCast(function.Comparison(isGreater, entries, threshold), llvm::IntegerType::get(function.GetLLVMContext(), vectorSize));
+                auto anyGreater = function.Comparison(emitters::TypedComparison::notEquals, mask, llvm::ConstantInt::get(mask->getType(), 0));
+                function.If(anyGreater, [start, vectorSize, &insertIfGreater](emitters::IRFunctionEmitter& function) {
+                    function.For(vectorSize, [start, &insertIfGreater](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar lane) {
+                        insertIfGreater(function, start + lane);
+                    });
+                });
+            });
+        }
+        if (k + numVectors * vectorSize < size)
+        {
+            function.For(k + numVectors * vectorSize, size, [&insertIfGreater](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+                insertIfGreater(function, index);
+            });
+        }
+
+        if (_normalizeSoftmax)
+        {
+            // The largest logit is in the first slot. The sum of the exponentials still covers every entry, but only
+            // the selected entries are normalized.
+            auto maxValue = function.LocalScalar(function.ValueAt(pValues, function.Literal<int>(0)));
+            emitters::LLVMValue sum = function.Variable(emitters::GetVariableType<ValueType>(), "expSum");
+            function.StoreZero(sum);
+            function.For(size, [pInput, sum, maxValue](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar index) {
+                auto x = function.LocalScalar(function.ValueAt(pInput, index));
+                function.OperationAndUpdate(sum, emitters::GetAddForValueType<ValueType>(), emitters::Exp(x - maxValue));
+            });
+            auto sumValue = function.LocalScalar(function.Load(sum));
+            function.For(k, [pValues, maxValue, sumValue](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar slot) {
+                auto x = function.LocalScalar(function.ValueAt(pValues, slot));
+                function.SetValueAt(pValues, slot, emitters::Exp(x - maxValue) / sumValue);
+            });
+        }
+    }
+
+    template <typename ValueType>
+    void TopKNode<ValueType>::Copy(model::ModelTransformer& transformer) const
+    {
+        const auto& newInput = transformer.GetCorrespondingInputs(_input);
+        auto newNode = transformer.AddNode<TopKNode<ValueType>>(newInput, _k, _normalizeSoftmax);
+        transformer.MapNodeOutput(values, newNode->values);
+        transformer.MapNodeOutput(indices, newNode->indices);
+    }
+
+    template <typename ValueType>
+    void TopKNode<ValueType>::WriteToArchive(utilities::Archiver& archiver) const
+    {
+        Node::WriteToArchive(archiver);
+        archiver[defaultInputPortName] << _input;
+        archiver["k"] << _k;
+        archiver["normalizeSoftmax"] << _normalizeSoftmax;
+    }
+
+    template <typename ValueType>
+    void TopKNode<ValueType>::ReadFromArchive(utilities::Unarchiver& archiver)
+    {
+        Node::ReadFromArchive(archiver);
+        archiver[defaultInputPortName] >> _input;
+        archiver["k"] >> _k;
+        archiver["normalizeSoftmax"] >> _normalizeSoftmax;
+        _values.SetSize(_k);
+        _indices.SetSize(_k);
+    }
+
+    // Explicit instantiations
+    template class TopKNode<float>;
+    template class TopKNode<double>;
+} // namespace nodes
+} // namespace ell
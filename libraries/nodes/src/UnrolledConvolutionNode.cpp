@@ -14,6 +14,8 @@
 
 #include <utilities/include/Unused.h>
 
+#include <algorithm>
+
 namespace ell
 {
 namespace nodes
@@ -95,9 +97,43 @@ namespace nodes
     {
         const auto& newInput = transformer.GetCorrespondingInputs(_input);
         auto newNode = transformer.AddNode<UnrolledConvolutionNode<ValueType>>(newInput, _inputMemoryLayout, GetOutputMemoryLayout(), _filterWeights, _filterSize, _stride);
+        newNode->SetEpilogue(_epilogue);
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
+    template <typename ValueType>
+    bool UnrolledConvolutionNode<ValueType>::CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const
+    {
+        // The output is written in row, column, channel order without padding
+        const auto& layout = GetOutputMemoryLayout();
+        return layout.IsCanonicalOrder() && !layout.HasPadding() && outputLayout.GetLogicalDimensionActiveSize() == layout.GetLogicalDimensionActiveSize();
+    }
+
+    template <typename ValueType>
+    int UnrolledConvolutionNode<ValueType>::GetImplicitGemmPanelSize(const model::MapCompiler* compiler) const
+    {
+        auto panelSize = compiler != nullptr ? compiler->GetModelOptimizerOptions(*this).template GetEntry<int>("implicitGemmPanelSize", 0) : 0;
+        if (panelSize <= 0)
+        {
+            return 0;
+        }
+
+        // The patches are copied a filter row at a time, so the channels of the input must be contiguous, and the
+        // output is written a pixel at a time
+        const auto& inputLayout = GetInputMemoryLayout();
+        const auto& outputLayout = GetOutputMemoryLayout();
+        auto isContiguousRowMajor = [](const model::PortMemoryLayout& layout) {
+            return layout.IsCanonicalOrder() && layout.GetLogicalDimensionExtent(2) == layout.GetLogicalDimensionActiveSize(2);
+        };
+        return isContiguousRowMajor(inputLayout) && isContiguousRowMajor(outputLayout) ? panelSize : 0;
+    }
+
+    template <typename ValueType>
+    bool UnrolledConvolutionNode<ValueType>::IsCompilable(const model::MapCompiler* compiler) const
+    {
+        return _isDepthwiseSeparable || GetImplicitGemmPanelSize(compiler) > 0;
+    }
+
     template <typename ValueType>
     void UnrolledConvolutionNode<ValueType>::Compute() const
     {
@@ -156,6 +192,7 @@ namespace nodes
         {
             auto receptiveFieldMatrixNode = transformer.AddNode<ReceptiveFieldMatrixNode<ValueType>>(newInput, inputLayout, filterSize, _stride, inputPadding, dataOrder, outputImageWidth, outputImageHeight);
             auto matrixMultNode = transformer.AddNode<MatrixMatrixMultiplyNode<ValueType>>(weights, m, n, k, lda, false, receptiveFieldMatrixNode->output, ldb, false, ldc, true);
+            matrixMultNode->SetEpilogue(_epilogue);
 
             if (outputPadding != 0)
             {
@@ -181,6 +218,7 @@ namespace nodes
 
             auto receptiveFieldMatrixNode = transformer.AddNode<ReceptiveFieldMatrixNode<ValueType>>(reorderedInput, reorderedInput.GetMemoryLayout(), _filterSize, _stride, inputPadding, dataOrder, outputImageWidth, outputImageHeight);
             auto matrixMultNode = transformer.AddNode<MatrixMatrixMultiplyNode<ValueType>>(weights, m, n, k, lda, false, receptiveFieldMatrixNode->output, ldb, false, ldc, true);
+            matrixMultNode->SetEpilogue(_epilogue);
 
             if (outputPadding != 0)
             {
@@ -198,9 +236,94 @@ namespace nodes
         return true;
     }
 
+    template <typename ValueType>
+    void UnrolledConvolutionNode<ValueType>::CompileImplicitGemm(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
+    {
+        emitters::LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
+        emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
+
+        const auto& inputLayout = this->GetInputMemoryLayout();
+        const auto& outputLayout = this->GetOutputMemoryLayout();
+        const auto inputIncrement = inputLayout.GetCumulativeIncrement();
+        const auto outputIncrement = outputLayout.GetCumulativeIncrement();
+        const auto outputOffset = outputLayout.GetLogicalDimensionOffset();
+        const auto outputSize = outputLayout.GetLogicalDimensionActiveSize();
+
+        const int outputRows = outputSize[0];
+        const int outputColumns = outputSize[1];
+        const int numFilters = outputSize[2];
+        const int inputDepth = inputLayout.GetLogicalDimensionActiveSize(2);
+        const int filterSize = _filterSize;
+        const int stride = _stride;
+        const int patchRowSize = filterSize * inputDepth; // a row of a patch is contiguous in the input
+        const int patchSize = filterSize * patchRowSize; // == _filterWeights.NumColumns()
+
+        // The receptive field matrix is formed for a tile of output pixels along a row at a time, in a panel of
+        // (tile pixels) x (patch size) values small enough to stay in cache while it's multiplied by the weights
+        const int panelBytes = GetImplicitGemmPanelSize(&compiler);
+        const int tileColumns = std::max(1, std::min(outputColumns, panelBytes / static_cast<int>(patchSize * sizeof(ValueType))));
+        const int numFullTiles = outputColumns / tileColumns;
+        const int lastTileColumns = outputColumns % tileColumns;
+
+        const auto weightValues = _filterWeights.ToArray();
+        auto weights = function.GetModule().ConstantArray("implicitGemmWeights_" + GetInternalStateIdentifier(), weightValues);
+        const auto packedWeightsName = "implicitGemmWeights_" + GetInternalStateIdentifier();
+        const auto constantWeights = compiler.GetModelOptimizerOptions(*this).template GetEntry<bool>("prepackWeights", true) ? &weightValues : nullptr;
+        auto panel = function.Variable(emitters::GetVariableType<ValueType>(), tileColumns * patchSize);
+
+        // The input includes its padding, so the patches are read from the start of the buffer; the output is written to its active area
+        const auto outputBufferOffset = (outputIncrement[0] * outputOffset[0]) + (outputIncrement[1] * outputOffset[1]) + (outputIncrement[2] * outputOffset[2]);
+        auto outputBuffer = function.PointerOffset(pOutput, outputBufferOffset);
+
+        auto emitTile = [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar outputRow, emitters::IRLocalScalar firstColumn, int numColumns) {
+            // im2col for this tile only
+            function.For(numColumns, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar tileColumn) {
+                auto inputColumn = (firstColumn + tileColumn) * stride;
+                for (int fieldRow = 0; fieldRow < filterSize; ++fieldRow)
+                {
+                    auto inputOffset = (outputRow * stride + fieldRow) * inputIncrement[0] + inputColumn * inputIncrement[1];
+                    auto panelOffset = tileColumn * patchSize + fieldRow * patchRowSize;
+                    function.MemoryCopy<ValueType>(pInput, inputOffset, panel, panelOffset, function.Literal(patchRowSize));
+                }
+            });
+
+            // output pixels of the tile (numColumns x numFilters) = panel (numColumns x patchSize) * weights' (patchSize x numFilters)
+            auto tileOutput = function.PointerOffset(outputBuffer, outputRow * outputIncrement[0] + firstColumn * outputIncrement[1]);
+            function.CallGEMM<ValueType>(false, true, numColumns, numFilters, patchSize, panel, patchSize, nullptr, weights, patchSize, constantWeights, tileOutput, outputIncrement[1], packedWeightsName);
+
+            // Apply the epilogue while the tile is still in cache
+            if (!_epilogue.IsEmpty())
+            {
+                auto output = function.LocalArray(tileOutput);
+                function.For(numColumns, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar tileColumn) {
+                    function.For(numFilters, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar filter) {
+                        auto offset = tileColumn * outputIncrement[1] + filter;
+                        output[offset] = _epilogue.Compile(function, GetInternalStateIdentifier(), output[offset], filter);
+                    });
+                });
+            }
+        };
+
+        function.For(outputRows, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar outputRow) {
+            function.For(numFullTiles, [=](emitters::IRFunctionEmitter& function, emitters::IRLocalScalar tile) {
+                emitTile(function, outputRow, tile * tileColumns, tileColumns);
+            });
+            if (lastTileColumns > 0)
+            {
+                emitTile(function, outputRow, function.LocalScalar(numFullTiles * tileColumns), lastTileColumns);
+            }
+        });
+    }
+
     template <typename ValueType>
     void UnrolledConvolutionNode<ValueType>::Compile(model::IRMapCompiler& compiler, emitters::IRFunctionEmitter& function)
     {
+        if (!_isDepthwiseSeparable)
+        {
+            CompileImplicitGemm(compiler, function);
+            return;
+        }
+
         emitters::LLVMValue pInput = compiler.EnsurePortEmitted(this->input);
         emitters::LLVMValue pOutput = compiler.EnsurePortEmitted(this->output);
 
@@ -275,6 +398,16 @@ namespace nodes
             });
             auto weightsPtr = function.PointerOffset(weights, f * fieldArea);
             function.CallGEMV<ValueType>(outputElements, fieldArea, shapedInput, (int)fieldArea, weightsPtr, (int)1, outputPtr, (int)depth);
+
+            // Apply the epilogue to this filter's output while it's still in cache
+            if (!_epilogue.IsEmpty())
+            {
+                auto output = function.LocalArray(outputPtr);
+                function.For(outputElements, [this, output, f, depth](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
+                    auto offset = function.LocalScalar(i) * depth;
+                    output[offset] = _epilogue.Compile(function, GetInternalStateIdentifier(), output[offset], f);
+                });
+            }
         });
     }
 
@@ -288,6 +421,7 @@ namespace nodes
         archiver["filterSize"] << _filterSize;
         archiver["stride"] << _stride;
         math::MatrixArchiver::Write(_filterWeights, "weights", archiver);
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -303,6 +437,7 @@ namespace nodes
         archiver["stride"] >> _stride;
         math::MatrixArchiver::Read(_filterWeights, "weights", archiver);
         _isDepthwiseSeparable = (static_cast<int>(_filterWeights.NumColumns()) == (_filterSize * _filterSize));
+        _epilogue.ReadFromArchive(archiver);
     }
 
     // Explicit specializations
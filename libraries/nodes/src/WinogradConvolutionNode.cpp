@@ -802,7 +802,9 @@ namespace nodes
                                 emitters::IRLocalArray transformedOutputBlock,
                                 emitters::IRLocalArray outputTile,
                                 emitters::IRLocalArray output,
-                                const model::PortMemoryLayout& outputLayout)
+                                const model::PortMemoryLayout& outputLayout,
+                                const OutputEpilogue<ValueType>& epilogue,
+                                const std::string& identifier)
         {
             const auto numOutputRows = outputLayout.GetLogicalDimensionActiveSize(0);
             const auto numOutputColumns = outputLayout.GetLogicalDimensionActiveSize(1);
@@ -812,6 +814,19 @@ namespace nodes
             GetTransformedOutputBlock<ValueType>(function, transformedOutput, tileRow, tileColumn, filterIndex, numOutputRows, numOutputColumns, numFilters, tileSize, filterSize, blockSize, transformedOutputBlock);
             TransformOutputBlock<ValueType>(function, transformedOutputBlock, tileSize, filterSize, blockSize, outputTile);
 
+            // Apply the epilogue while the tile is still local. outputTile is (tileSize * tileSize) x blockSize, holding filters [filterIndex, filterIndex + blockSize)
+            if (!epilogue.IsEmpty())
+            {
+                function.For(tileSize * tileSize, [=, &epilogue, &identifier](emitters::IRFunctionEmitter& function, emitters::LLVMValue i) {
+                    auto tileOffset = function.LocalScalar(i) * blockSize;
+                    function.For(blockSize, [=, &epilogue, &identifier](emitters::IRFunctionEmitter& function, emitters::LLVMValue j) {
+                        auto blockIndex = function.LocalScalar(j);
+                        auto offset = tileOffset + blockIndex;
+                        outputTile[offset] = epilogue.Compile(function, identifier, outputTile[offset], filterIndex + blockIndex);
+                    });
+                });
+            }
+
             // outputTile is the tile block at (tileRow, tileColumn, filterIndex) of the output
             SplatOutputTile<ValueType>(function, outputTile, tileRow, tileColumn, filterIndex, numOutputRows, numOutputColumns, numFilters, tileSize, blockSize, output);
         }
@@ -1021,7 +1036,9 @@ namespace nodes
                              int filterSize,
                              int blockSize,
                              emitters::IRLocalArray output,
-                             const model::PortMemoryLayout& outputLayout)
+                             const model::PortMemoryLayout& outputLayout,
+                             const OutputEpilogue<ValueType>& epilogue,
+                             const std::string& identifier)
         {
 #ifdef PROFILE_REGIONS
             auto region = emitters::IRProfileRegionBlock(function, "Winograd_TF_TransformOutput");
@@ -1040,7 +1057,7 @@ namespace nodes
             auto loopRanges = std::vector<emitters::IRFunctionEmitter::ConstTiledLoopRange>{ { 0, numFilters, blockSize },
                                                                                              { 0, numOutputRows, tileSize },
                                                                                              { 0, numOutputColumns, tileSize } };
-            function.For(loopRanges, [=](emitters::IRFunctionEmitter& function, auto loopRanges) {
+            function.For(loopRanges, [=, &epilogue, &identifier](emitters::IRFunctionEmitter& function, auto loopRanges) {
                 auto filterIndex = loopRanges[0].begin;
                 auto rowTileIndex = loopRanges[1].index;
                 auto columnTileIndex = loopRanges[2].index;
@@ -1057,7 +1074,9 @@ namespace nodes
                                               transformedOutputBlock,
                                               outputTile,
                                               output,
-                                              outputLayout);
+                                              outputLayout,
+                                              epilogue,
+                                              identifier);
             });
         }
     } // end anonymous namespace
@@ -1093,16 +1112,17 @@ namespace nodes
                                                                 const model::PortMemoryLayout& inputMemoryLayout,
                                                                 const model::PortMemoryLayout& outputMemoryLayout,
                                                                 const ConstTensorReferenceType& filterWeights,
-                                                                int stride) :
+                                                                int stride,
+                                                                int tileSize) :
         CompilableNode({ &_input }, { &_output }),
         _input(this, input, defaultInputPortName),
         _output(this, defaultOutputPortName, outputMemoryLayout),
         _inputMemoryLayout(inputMemoryLayout),
-        _stride(stride)
+        _stride(stride),
+        _tileSize(tileSize)
     {
         using FilterOrder = typename WinogradConvolutionNode<ValueType>::FilterOrder;
 
-        _tileSize = 2;
         const int numFilters = outputMemoryLayout.GetLogicalDimensionActiveSize(2);
         const int numFilterChannels = static_cast<int>(filterWeights.NumChannels());
         const int filtersFirstThreshold = 4; // empirically determined
@@ -1291,7 +1311,8 @@ namespace nodes
         _order(other._order),
         _numFilterChannels(other._numFilterChannels),
         _inputBlockSize(other._inputBlockSize),
-        _outputBlockSize(other._outputBlockSize)
+        _outputBlockSize(other._outputBlockSize),
+        _epilogue(other._epilogue)
     {
     }
 
@@ -1304,6 +1325,21 @@ namespace nodes
         transformer.MapNodeOutput(this->output, newNode->output);
     }
 
+    template <typename ValueType>
+    int64_t WinogradConvolutionComputeNode<ValueType>::GetOperationCount() const
+    {
+        const int64_t numOutputs = GetOutputMemoryLayout().GetActiveSize().NumElements();
+        return 2 * numOutputs * _filterSize * _filterSize * _numFilterChannels;
+    }
+
+    template <typename ValueType>
+    bool WinogradConvolutionComputeNode<ValueType>::CanApplyEpilogue(const model::PortMemoryLayout& outputLayout) const
+    {
+        // The output is written in row, column, channel order without padding
+        const auto& layout = GetOutputMemoryLayout();
+        return layout.IsCanonicalOrder() && !layout.HasPadding() && outputLayout.GetLogicalDimensionActiveSize() == layout.GetLogicalDimensionActiveSize();
+    }
+
     template <typename ValueType>
     void WinogradConvolutionComputeNode<ValueType>::Compute() const
     {
@@ -1379,7 +1415,7 @@ namespace nodes
         // This is the core of the Winograd convolution algorithm: transform the input, perform an elementwise multiply between it an the transformed filter, and transform it back
         TransformInput<ValueType>(function, input, inputLayout, _tileSize, _filterSize, _inputBlockSize, transformedInput);
         ComputeTransformedOutput<ValueType>(function, transformedInput, transformedFilters, numOutputRows, numOutputColumns, numChannels, numFilters, _tileSize, _filterSize, transformedOutput);
-        TransformOutput<ValueType>(function, transformedOutput, _tileSize, _filterSize, _outputBlockSize, output, outputLayout);
+        TransformOutput<ValueType>(function, transformedOutput, _tileSize, _filterSize, _outputBlockSize, output, outputLayout, _epilogue, GetInternalStateIdentifier());
     }
 
     template <typename ValueType>
@@ -1490,6 +1526,9 @@ namespace nodes
                 ConvolveAccumulateBlock<ValueType>(function, input, inputLayout, transformedFilters, transformedFilterLayout, ranges, problemSize, _tileSize, _filterSize, scratch, output, outputLayout);
             });
         });
+
+        // Each output value is only final after the last block of filter channels, so the epilogue is a separate pass
+        _epilogue.Compile(function, GetInternalStateIdentifier(), output, numOutputRows * numOutputColumns, numFilters, numFilters, 1);
     }
 
     template <typename ValueType>
@@ -1505,6 +1544,7 @@ namespace nodes
         archiver["stride"] << _stride;
         archiver["order"] << to_string(_order);
         archiver["filterChannels"] << _numFilterChannels;
+        _epilogue.WriteToArchive(archiver);
     }
 
     template <typename ValueType>
@@ -1524,6 +1564,7 @@ namespace nodes
         archiver["order"] >> orderName;
         _order = filter_order_from_string(orderName);
         archiver["filterChannels"] >> _numFilterChannels;
+        _epilogue.ReadFromArchive(archiver);
     }
 
     // Explicit specializations
@@ -34,10 +34,12 @@ struct WinogradOptions
 
 struct SimpleOptions
 {
+    bool implicitPadding; // pass the input without padding, and let the node handle the boundary
 };
 
 struct UnrolledOptions
 {
+    int implicitGemmPanelSize; // the "implicitGemmPanelSize" optimizer option (0 to build the whole receptive field matrix)
 };
 
 struct DiagonalOptions
@@ -46,7 +48,12 @@ struct DiagonalOptions
 
 union ConvolutionOptions
 {
-    ConvolutionOptions() {}
+    ConvolutionOptions() :
+        unrolledOptions({ 0 }) {} // also clears simpleOptions
+    ConvolutionOptions(SimpleOptions options) :
+        simpleOptions(options) {}
+    ConvolutionOptions(UnrolledOptions options) :
+        unrolledOptions(options) {}
     ConvolutionOptions(int tileSize, ell::dsp::WinogradFilterOrder order) :
         winogradOptions({ tileSize, order }) {}
     ConvolutionOptions(int tileSize) :
@@ -26,6 +26,7 @@
 #include <model/include/Model.h>
 #include <model/include/Node.h>
 
+#include <nodes/include/BiquadCascadeNode.h>
 #include <nodes/include/BufferNode.h>
 #include <nodes/include/ConstantNode.h>
 #include <nodes/include/DTWDistanceNode.h>
@@ -55,10 +56,12 @@
 #include <utilities/include/RandomEngines.h>
 #include <utilities/include/StringUtil.h>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <memory>
 #include <numeric>
+#include <random>
 #include <sstream>
 #include <string>
 
@@ -367,6 +370,51 @@ static void TestIIRFilterNode4()
     }
 }
 
+template <typename ValueType>
+static void TestBiquadCascadeNode(size_t numChannels, bool vectorize)
+{
+    const ValueType epsilon = static_cast<ValueType>(1e-5);
+    const size_t numFrames = 4;
+    std::vector<dsp::BiquadSection<ValueType>> sections = {
+        { static_cast<ValueType>(0.2), static_cast<ValueType>(0.4), static_cast<ValueType>(0.2), static_cast<ValueType>(-0.6), static_cast<ValueType>(0.25) },
+        { static_cast<ValueType>(1.0), static_cast<ValueType>(-1.5), static_cast<ValueType>(0.8), static_cast<ValueType>(-1.2), static_cast<ValueType>(0.5) }
+    };
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(numFrames * numChannels);
+    auto outputNode = model.AddNode<nodes::BiquadCascadeNode<ValueType>>(inputNode->output, sections, numChannels);
+
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", outputNode->output } });
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.allowVectorInstructions = vectorize;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    // The state carries over from one call to the next
+    auto randomEngine = utilities::GetRandomEngine("123");
+    std::uniform_real_distribution<ValueType> uniform(-1, 1);
+    dsp::BiquadCascade<ValueType> reference(sections, numChannels);
+    bool computeOk = true;
+    bool compileOk = true;
+    for (int call = 0; call < 5; ++call)
+    {
+        std::vector<ValueType> input(numFrames * numChannels);
+        std::generate(input.begin(), input.end(), [&]() { return uniform(randomEngine); });
+        auto expected = reference.FilterFrames(input);
+
+        map.SetInputValue(0, input);
+        computeOk &= testing::IsEqual(map.ComputeOutput<ValueType>(0), expected, epsilon);
+
+        compiledMap.SetInputValue(0, input);
+        compileOk &= testing::IsEqual(compiledMap.ComputeOutput<ValueType>(0), expected, epsilon);
+    }
+
+    auto suffix = " with " + std::to_string(numChannels) + " channels" + (vectorize ? ", vectorized" : "");
+    testing::ProcessTest("Testing BiquadCascadeNode compute" + suffix, computeOk);
+    testing::ProcessTest("Testing BiquadCascadeNode compile" + suffix, compileOk);
+}
+
 template <typename ValueType>
 static void TestMelFilterBankNode()
 {
@@ -406,13 +454,10 @@ static void TestMelFilterBankNode()
 }
 
 template <typename ValueType>
-static void TestBufferNode()
+static void TestBufferNode(size_t inputSize, size_t windowSize, int numEntries)
 {
-    const size_t inputSize = 16;
-    const size_t windowSize = 40;
-
     std::vector<std::vector<ValueType>> data;
-    const int numEntries = 8; // 8 input buffers of consecutive numbers
+    // input buffers of consecutive numbers, enough of them to wrap around the compiled ring buffer several times
     for (int index = 0; index < numEntries; ++index)
     {
         std::vector<ValueType> item(inputSize);
@@ -446,11 +491,32 @@ static void TestBufferNode()
         model::IRMapCompiler compiler(settings, optimizerOptions);
         auto compiledMap = compiler.Compile(map);
 
-        auto message = utilities::FormatString("Testing BufferNode compile iteration %d", iteration);
+        auto message = utilities::FormatString("Testing BufferNode compile with input size %d and window size %d, iteration %d", static_cast<int>(inputSize), static_cast<int>(windowSize), iteration);
         VerifyCompiledOutputAndResult<ValueType, ValueType>(map, compiledMap, data, expected, message);
     });
 }
 
+static void TestDelayNodeCompile(size_t inputSize, size_t delay, int numEntries)
+{
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(inputSize);
+    auto outputNode = model.AddNode<nodes::DelayNode<double>>(inputNode->output, delay);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", outputNode->output } });
+
+    std::vector<std::vector<double>> data;
+    for (int index = 0; index < numEntries; ++index)
+    {
+        std::vector<double> item(inputSize);
+        std::iota(item.begin(), item.end(), static_cast<double>(inputSize * index + 1));
+        data.push_back(item);
+    }
+
+    model::IRMapCompiler compiler;
+    auto compiledMap = compiler.Compile(map);
+    auto message = utilities::FormatString("with input size %d and delay %d", static_cast<int>(inputSize), static_cast<int>(delay));
+    VerifyCompiledOutput<double, double>(map, compiledMap, data, "DelayNode", message);
+}
+
 template <typename ValueType>
 static void TestConvolutionNodeCompile(dsp::ConvolutionMethodOption convolutionMethod)
 {
@@ -561,6 +627,8 @@ static void TestConvolutionNodeCompileVsReference(ImageShape inputShape, Filters
     const int outputColumns = inputColumns / stride;
     const int inputPadding = (filterSize - 1) / 2;
     const int outputPadding = 0;
+    const bool implicitPadding = convolutionMethod == dsp::ConvolutionMethodOption::simple && options.simpleOptions.implicitPadding;
+    const bool implicitGemm = convolutionMethod == dsp::ConvolutionMethodOption::unrolled && options.unrolledOptions.implicitGemmPanelSize > 0;
 
     auto dataSize = inputRows * inputColumns * numChannels;
     auto data = std::vector<ValueType>(dataSize);
@@ -570,7 +638,7 @@ static void TestConvolutionNodeCompileVsReference(ImageShape inputShape, Filters
     auto filter = std::vector<ValueType>(filterWeightsSize);
     FillRandomVector(filter);
 
-    auto inputMemoryLayout = CalculateMemoryLayout(inputRows, inputColumns, numChannels, inputPadding);
+    auto inputMemoryLayout = CalculateMemoryLayout(inputRows, inputColumns, numChannels, implicitPadding ? 0 : inputPadding);
     auto outputMemoryLayout = CalculateMemoryLayout(outputRows, outputColumns, numFilters, outputPadding);
     auto filterWeights = Tensor(numFilters * filterSize, filterSize, numFilterChannels, filter);
 
@@ -582,6 +650,10 @@ static void TestConvolutionNodeCompileVsReference(ImageShape inputShape, Filters
     settings.compilerSettings.useBlas = true;
     settings.verifyJittedModule = true;
     model::ModelOptimizerOptions optimizerOptions;
+    if (implicitGemm)
+    {
+        optimizerOptions["implicitGemmPanelSize"] = options.unrolledOptions.implicitGemmPanelSize;
+    }
     model::IRMapCompiler compiler(settings, optimizerOptions);
 
     // Create "test" model
@@ -652,11 +724,11 @@ static void TestConvolutionNodeCompileVsReference(ImageShape inputShape, Filters
         reference = dsp::Convolve2D(paddedDataTensor, filterWeights, numFilters, stride).ToArray();
     }
 
-    compiledMap.SetInputValue(0, paddedDataArray);
+    compiledMap.SetInputValue(0, implicitPadding ? data : paddedDataArray);
     auto compiledResult = compiledMap.ComputeOutput<ValueType>(0);
 
     auto ok = testing::IsEqual(reference, compiledResult, epsilon);
-    testing::ProcessTest("Testing compiled "s + GetConvAlgName(convolutionMethod) + " convolution node vs reference for  " + std::to_string(inputRows) + " x " + std::to_string(inputColumns) + " x " + std::to_string(numChannels) + " image and " + std::to_string(numFilters) + " " + std::to_string(filterSize) + " x " + std::to_string(filterSize) + " x " + std::to_string(numFilterChannels) + " filters, stride " + std::to_string(stride), ok);
+    testing::ProcessTest("Testing compiled "s + GetConvAlgName(convolutionMethod) + (implicitPadding ? " (unpadded input)" : "") + (implicitGemm ? " (implicit GEMM)" : "") + " convolution node vs reference for  " + std::to_string(inputRows) + " x " + std::to_string(inputColumns) + " x " + std::to_string(numChannels) + " image and " + std::to_string(numFilters) + " " + std::to_string(filterSize) + " x " + std::to_string(filterSize) + " x " + std::to_string(numFilterChannels) + " filters, stride " + std::to_string(stride), ok);
 
     // Helpful debugging output
     if (!ok)
@@ -945,11 +1017,22 @@ void TestDSPNodes(const std::string& path)
     TestIIRFilterNode2<float>();
     TestIIRFilterNode3<float>();
     TestIIRFilterNode4<float>();
+    TestBiquadCascadeNode<float>(1, false);
+    TestBiquadCascadeNode<float>(8, false);
+    TestBiquadCascadeNode<float>(8, true);
+    TestBiquadCascadeNode<float>(6, true);
+    TestBiquadCascadeNode<double>(16, true);
 
     TestMelFilterBankNode<float>();
     TestMelFilterBankNode<double>();
 
-    TestBufferNode<float>();
+    TestBufferNode<float>(16, 40, 8);
+    TestBufferNode<float>(16, 48, 20); // window is a multiple of the input size
+    TestBufferNode<float>(3, 10, 25); // input wraps around the end of the ring
+    TestBufferNode<float>(8, 8, 4); // window is just the latest input
+    TestBufferNode<double>(7, 64, 100);
+    TestDelayNodeCompile(3, 5, 40);
+    TestDelayNodeCompile(1, 16, 100);
 
     TestConvolutionNodeCompile<float>(dsp::ConvolutionMethodOption::simple);
     // TestConvolutionNodeCompile<float>(dsp::ConvolutionMethodOption::diagonal); // ERROR: diagonal test currently broken
@@ -976,6 +1059,14 @@ void TestDSPNodes(const std::string& path)
     TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::simple);
     TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 2, dsp::ConvolutionMethodOption::simple);
 
+    // Test simple convolution of inputs without padding
+    TestConvolutionNodeCompileVsReference<float>({ 2, 2, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::simple, SimpleOptions{ true });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 5, 2 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::simple, SimpleOptions{ true });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 15, 4 }, { 7, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::simple, SimpleOptions{ true });
+    TestConvolutionNodeCompileVsReference<float>({ 32, 32, 8 }, { 8, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::simple, SimpleOptions{ true });
+    TestConvolutionNodeCompileVsReference<float>({ 16, 16, 8 }, { 8, 3, 3, 1 }, 1, dsp::ConvolutionMethodOption::simple, SimpleOptions{ true });
+    TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 2, dsp::ConvolutionMethodOption::simple, SimpleOptions{ true });
+
     // Test unrolled convolution
     TestConvolutionNodeCompileVsReference<float>({ 2, 2, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::unrolled);
     TestConvolutionNodeCompileVsReference<float>({ 2, 3, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::unrolled);
@@ -996,6 +1087,12 @@ void TestDSPNodes(const std::string& path)
     TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::unrolled);
     TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 2, dsp::ConvolutionMethodOption::unrolled);
 
+    // Test unrolled convolution with the receptive field matrix built a panel at a time
+    TestConvolutionNodeCompileVsReference<float>({ 4, 4, 2 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::unrolled, UnrolledOptions{ 64 });
+    TestConvolutionNodeCompileVsReference<float>({ 5, 15, 4 }, { 7, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::unrolled, UnrolledOptions{ 1024 });
+    TestConvolutionNodeCompileVsReference<float>({ 32, 32, 8 }, { 8, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::unrolled, UnrolledOptions{ 4096 });
+    TestConvolutionNodeCompileVsReference<float>({ 120, 80, 8 }, { 16, 3, 3, 0 }, 2, dsp::ConvolutionMethodOption::unrolled, UnrolledOptions{ 4096 });
+
     // Test Winograd convolution with tile size 2
     TestConvolutionNodeCompileVsReference<float>({ 2, 2, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
     TestConvolutionNodeCompileVsReference<float>({ 2, 3, 1 }, { 1, 3, 3, 0 }, 1, dsp::ConvolutionMethodOption::winograd, { 2, dsp::WinogradFilterOrder::tilesFirst });
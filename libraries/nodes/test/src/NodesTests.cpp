@@ -791,6 +791,49 @@ static void TestClockNodeCompute()
     testing::ProcessTest("Testing ClockNode compute", testing::IsEqual(results, expectedResults));
     testing::ProcessTest("Testing ClockNode GetTicksUntilNextInterval", testing::IsEqual(getTicksResults, expectedGetTicksResults));
     testing::ProcessTest("Testing lag notification count", testing::IsEqual(lagNotificationCallbackCount, 2));
+
+    // Lateness in intervals: 1.65, 0, 3.3, 66, 0
+    const auto& telemetry = clockNode->GetDeadlineTelemetry();
+    std::vector<int64_t> histogram(telemetry.latenessHistogram.begin(), telemetry.latenessHistogram.end());
+    testing::ProcessTest("Testing ClockNode deadline telemetry", testing::IsEqual(telemetry.missedDeadlineCount, int64_t{ 3 }) && testing::IsEqual(telemetry.droppedTickCount, int64_t{ 0 }) && testing::IsEqual(telemetry.lastSlack, interval, 1.0e-3) && testing::IsEqual(histogram, std::vector<int64_t>{ 2, 0, 0, 1, 1, 1 }));
+}
+
+static void TestClockNodeDropStaleTicks()
+{
+    constexpr nodes::TimeTickType interval = 50;
+    constexpr nodes::TimeTickType start = 1511889201834.5767;
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<nodes::TimeTickType>>(1);
+    auto clockNode = model.AddNode<nodes::ClockNode>(inputNode->output, interval, interval, "LagNotificationCallback", nullptr, true);
+
+    std::vector<std::vector<nodes::TimeTickType>> signal =
+        {
+            { start },
+            { start + interval * 1 }, // on time
+            { start + interval * 4 + 10 }, // two intervals behind (expect them to be dropped)
+            { start + interval * 5 } // on time
+        };
+
+    std::vector<std::vector<nodes::TimeTickType>> expectedResults =
+        {
+            // lastIntervalTime, currentTime
+            { start, start },
+            { start + interval * 1, start + interval * 1 },
+            { start + interval * 4, start + interval * 4 + 10 },
+            { start + interval * 5, start + interval * 5 }
+        };
+
+    std::vector<std::vector<nodes::TimeTickType>> results;
+    for (const auto& input : signal)
+    {
+        inputNode->SetInput(input);
+        results.push_back(model.ComputeOutput(clockNode->output));
+    }
+
+    const auto& telemetry = clockNode->GetDeadlineTelemetry();
+    testing::ProcessTest("Testing ClockNode compute with dropped stale ticks", testing::IsEqual(results, expectedResults));
+    testing::ProcessTest("Testing ClockNode dropped tick count", testing::IsEqual(telemetry.droppedTickCount, int64_t{ 2 }) && testing::IsEqual(telemetry.missedDeadlineCount, int64_t{ 0 }));
 }
 
 static void TestConcatenationNodeCompute()
@@ -821,6 +864,7 @@ void TestNodes()
     //
     TestAccumulatorNodeCompute();
     TestClockNodeCompute();
+    TestClockNodeDropStaleTicks();
     TestConcatenationNodeCompute();
     TestDemultiplexerNodeCompute();
     TestL2NormSquaredNodeCompute();
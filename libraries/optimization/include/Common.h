@@ -9,6 +9,7 @@
 
 #include <exception>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #ifndef NDEBUG
@@ -43,6 +44,15 @@ namespace optimization
         std::string _message;
     };
 
+    /// <summary> True if a solution type can multiply and update with a batch of inputs at once, with MultiplyBatch and AddBatchOuterProducts. </summary>
+    template <typename SolutionType, typename = void>
+    struct HasBatchProducts : std::false_type
+    {};
+
+    template <typename SolutionType>
+    struct HasBatchProducts<SolutionType, std::void_t<decltype(&SolutionType::MultiplyBatch), decltype(&SolutionType::AddBatchOuterProducts)>> : std::true_type
+    {};
+
     /// <summary> enum class used to determine if the objective is to maximize or minimize </summary>
     enum class Objective
     {
@@ -8,12 +8,18 @@
 
 #pragma once
 
-#include "BinarySearch.h"
 #include "ElasticNetRegularizer.h"
 #include "ExponentialSearch.h"
 #include "SDCAOptimizer.h"
 
+#include <utilities/include/ParallelFor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace ell
 {
@@ -38,6 +44,9 @@ namespace optimization
         // Exponential search parameters
         double exponentialSearchGuess = 1.0; // a first guess of the L1 regularization parameter that would give the desired result
         double exponentialSearchBase = 2.0; // base of the exponential search, must be greater than 1.0; 2.0 means that the interval doubles with each iteration
+
+        // Search over the bounding interval
+        size_t numConcurrentProbes = 1; // the number of evenly spaced values probed side by side in each round of the search; 1 gives binary search. A round costs the budget as many epochs as its longest probe
     };
 
     template <typename SolutionType>
@@ -68,27 +77,63 @@ namespace optimization
     SparseSolution<SolutionType> GetSparseSolution(std::shared_ptr<const typename SolutionType::DatasetType> examples, LossFunctionType lossFunction, GetSparseSolutionParameters parameters)
     {
         // create optimizer
-        auto optimizer = MakeSDCAOptimizer<SolutionType>(examples, lossFunction, ElasticNetRegularizer{}, parameters.SDCAParameters, parameters.SDCARandomSeedString);
+        auto initialOptimizer = MakeSDCAOptimizer<SolutionType>(examples, lossFunction, ElasticNetRegularizer{}, parameters.SDCAParameters, parameters.SDCARandomSeedString);
+        using OptimizerType = decltype(initialOptimizer);
 
         // SDCA epoch budget (leave some for the final call to the optimizer)
         size_t epochBudget = parameters.maxEpochs - parameters.SDCAMaxEpochsPerCall;
 
-        // create a function that monotonically maps [-infinity,infinity] to the fraction of non-zeros
-        auto getDensity = [&](double minusLogScale) {
-            // compute the L1 regularization parameter beta (which is later multiplied by the SDCA regularization parameter)
-            double beta = parameters.exponentialSearchGuess * std::exp(-minusLogScale);
+        // compute the L1 regularization parameter beta (which is later multiplied by the SDCA regularization parameter)
+        auto getBeta = [&](double minusLogScale) { return parameters.exponentialSearchGuess * std::exp(-minusLogScale); };
 
-            // optimize
-            optimizer.SetRegularizer(ElasticNetRegularizer{ beta });
-            size_t numEpochs = std::min(epochBudget, parameters.SDCAMaxEpochsPerCall);
-            optimizer.Update(numEpochs, parameters.SDCAEarlyExitDualityGap);
+        // the optimizers of the probed values of minusLogScale: the SDCA dual variables are valid for any L1
+        // regularization parameter, so each probe continues from the optimizer of its nearest probed neighbour
+        struct Probe
+        {
+            double minusLogScale;
+            OptimizerType optimizer;
+            double density;
+            size_t numEpochs; // the epochs performed by this probe
+            size_t totalEpochs; // the epochs performed by this probe and the probes it continues from
+        };
+        std::vector<Probe> probes;
 
-            // post-process
-            epochBudget -= optimizer.GetSolutionInfo().numEpochsPerformed;
+        auto getNearestProbe = [&](double minusLogScale) -> const Probe* {
+            auto nearest = std::min_element(probes.begin(), probes.end(), [minusLogScale](const Probe& a, const Probe& b) {
+                return std::abs(a.minusLogScale - minusLogScale) < std::abs(b.minusLogScale - minusLogScale);
+            });
+            return nearest == probes.end() ? nullptr : &(*nearest);
+        };
+
+        // keeps only the probes on the boundary of the search interval, which are the nearest to any later probe
+        auto keepBoundaryProbes = [&](const Interval& searchInterval) {
+            probes.erase(std::remove_if(probes.begin(), probes.end(), [&searchInterval](const Probe& probe) {
+                             return probe.minusLogScale != searchInterval.Begin() && probe.minusLogScale != searchInterval.End();
+                         }),
+                         probes.end());
+        };
+
+        // optimizes with a given minusLogScale, starting from a given probe (or from zero), without touching the other probes
+        auto runProbe = [&](double minusLogScale, const Probe* start, size_t maxEpochs) {
+            Probe probe{ minusLogScale, start != nullptr ? start->optimizer : initialOptimizer, 0, 0, 0 };
+            auto& optimizer = probe.optimizer;
+            optimizer.SetRegularizer(ElasticNetRegularizer{ getBeta(minusLogScale) });
+            optimizer.Update(maxEpochs, parameters.SDCAEarlyExitDualityGap);
+
+            probe.totalEpochs = optimizer.GetSolutionInfo().numEpochsPerformed;
+            probe.numEpochs = probe.totalEpochs - (start != nullptr ? start->totalEpochs : 0);
             const auto& vector = optimizer.GetSolution().GetVector();
-            double density = vector.Norm0() / vector.Size();
-            optimizer.Reset();
-            return density;
+            probe.density = vector.Norm0() / vector.Size();
+            return probe;
+        };
+
+        // create a function that monotonically maps [-infinity,infinity] to the fraction of non-zeros
+        auto getDensity = [&](double minusLogScale) {
+            size_t numEpochs = std::min(epochBudget, parameters.SDCAMaxEpochsPerCall);
+            auto probe = runProbe(minusLogScale, getNearestProbe(minusLogScale), numEpochs);
+            epochBudget -= probe.numEpochs;
+            probes.push_back(std::move(probe));
+            return probes.back().density;
         };
 
         // use exponential search to find an upper bound and lower bound on the minusLogScale parameter
@@ -99,34 +144,65 @@ namespace optimization
             exponentialSearch.Update();
         }
 
-        // if we were lucky, exponential search already found a good value of minusLogScale
-        double bestMinusLogScale = 0;
-        if (exponentialSearch.GetBoundingArguments().Size() == 0)
+        // narrow the bounding interval down to a good value of minusLogScale (unless exponential search already
+        // found one), probing evenly spaced values side by side and moving the boundaries as binary search does
+        auto searchInterval = exponentialSearch.GetBoundingArguments();
+        keepBoundaryProbes(searchInterval);
+        auto numProbes = std::max(parameters.numConcurrentProbes, size_t{ 1 });
+        const auto& targetDensity = parameters.targetDensity;
+        while (searchInterval.Size() > 0 && epochBudget > parameters.SDCAMaxEpochsPerCall)
         {
-            bestMinusLogScale = exponentialSearch.GetBoundingArguments().Begin();
-        }
+            size_t numEpochs = std::min(epochBudget, parameters.SDCAMaxEpochsPerCall);
+            std::vector<double> minusLogScales;
+            std::vector<const Probe*> starts;
+            for (size_t i = 1; i <= numProbes; ++i)
+            {
+                minusLogScales.push_back(searchInterval.Begin() + searchInterval.Size() * i / (numProbes + 1));
+                starts.push_back(getNearestProbe(minusLogScales.back()));
+            }
 
-        // otherwise, use binary search to zero in on a good value of minusLogScale
-        else
-        {
-            BinarySearchParameters binarySearchParameters{ parameters.targetDensity, exponentialSearch.GetBoundingArguments(), true, exponentialSearch.GetBoundingValues() };
-            auto binarySearch = BinarySearch(getDensity, binarySearchParameters);
-            while (!binarySearch.IsSuccessful() && epochBudget > parameters.SDCAMaxEpochsPerCall)
+            std::vector<std::optional<Probe>> results(numProbes);
+            utilities::ParallelForBlocks(numProbes, [&](size_t i) {
+                results[i].emplace(runProbe(minusLogScales[i], starts[i], numEpochs));
+            });
+
+            std::vector<Probe> roundProbes;
+            size_t roundEpochs = 0;
+            for (auto& result : results)
             {
-                binarySearch.Update();
+                roundProbes.push_back(std::move(*result));
+                roundEpochs = std::max(roundEpochs, roundProbes.back().numEpochs);
             }
+            epochBudget -= std::min(epochBudget, roundEpochs);
 
-            bestMinusLogScale = binarySearch.GetCurrentSearchInterval().Begin();
-        }
+            // the probes are in increasing order, so a probe past a boundary that has already moved is skipped
+            for (const auto& probe : roundProbes)
+            {
+                if (!searchInterval.Contains(probe.minusLogScale))
+                {
+                    continue;
+                }
+
+                if (probe.density <= targetDensity.End())
+                {
+                    searchInterval = { probe.minusLogScale, searchInterval.End() };
+                }
+
+                if (probe.density >= targetDensity.Begin())
+                {
+                    searchInterval = { searchInterval.Begin(), probe.minusLogScale };
+                }
+            }
 
-        // retrain solution
-        double bestBeta = parameters.exponentialSearchGuess * std::exp(-bestMinusLogScale);
-        optimizer.SetRegularizer(ElasticNetRegularizer{ bestBeta });
-        optimizer.Update(parameters.SDCAMaxEpochsPerCall, parameters.SDCAEarlyExitDualityGap);
+            probes.insert(probes.end(), std::make_move_iterator(roundProbes.begin()), std::make_move_iterator(roundProbes.end()));
+            keepBoundaryProbes(searchInterval);
+        }
+        double bestMinusLogScale = searchInterval.Begin();
 
-        const auto& vector = optimizer.GetSolution().GetVector();
-        double density = vector.Norm0() / vector.Size();
-        return { optimizer.GetSolution(), optimizer.GetSolutionInfo(), bestBeta, density };
+        // retrain solution, continuing from the probe of the best value of minusLogScale
+        double bestBeta = getBeta(bestMinusLogScale);
+        auto best = runProbe(bestMinusLogScale, getNearestProbe(bestMinusLogScale), parameters.SDCAMaxEpochsPerCall);
+        return { best.optimizer.GetSolution(), best.optimizer.GetSolutionInfo(), bestBeta, best.density };
     }
 } // namespace optimization
 } // namespace ell
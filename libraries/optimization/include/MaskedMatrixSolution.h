@@ -18,6 +18,11 @@
 #include <math/include/Vector.h>
 #include <math/include/VectorOperations.h>
 
+#include <utilities/include/ParallelFor.h>
+
+#include <algorithm>
+#include <vector>
+
 namespace ell
 {
 namespace optimization
@@ -96,6 +101,12 @@ namespace optimization
         /// <summary> Computes input * weights, or input * weights + bias (if a bias exists). </summary>
         math::RowVector<double> Multiply(const InputType& input) const;
 
+        /// <summary> Computes Multiply for a batch of inputs, the rows of a matrix, with one matrix product. </summary>
+        void MultiplyBatch(math::ConstRowMatrixReference<double> inputs, math::RowMatrixReference<double> outputs) const;
+
+        /// <summary> Adds the outer products of a batch of inputs, the rows of a matrix, with the rows of a matrix of coefficients (the same as adding each Transpose(input) * coefficients), with one matrix product. </summary>
+        void AddBatchOuterProducts(math::ConstRowMatrixReference<double> inputs, math::ConstRowMatrixReference<double> coefficients);
+
         /// <summary> Returns the squared 2-norm of a given input. </summary>
         static double GetNorm2SquaredOf(const InputType& input);
 
@@ -107,11 +118,25 @@ namespace optimization
         const MatrixSolutionType& GetBaseSolution() const { return _baseSolution; }
 
     private:
+        void UpdateMaskedEntries();
         void UpdateBaseSolution();
 
+        // the frozen weights where the mask is nonzero, in column order, so that restoring them after an update
+        // doesn't scan the whole mask
+        struct MaskedEntry
+        {
+            size_t row;
+            size_t column;
+            double value;
+        };
+
+        // when restoring the frozen weights is split across threads, each thread restores at least this many, from a range of columns
+        static constexpr size_t minMaskedEntriesPerThread = 1 << 15;
+
         MatrixSolutionType _baseSolution;
         MaskType _mask = { 0, 0 };
         WeightsType _frozenWeights = { 0, 0 };
+        std::vector<MaskedEntry> _maskedEntries;
     };
 
     /// <summary> Returns the squared 2-norm of a MatrixSolutionBase. </summary>
@@ -149,6 +174,7 @@ namespace optimization
 
         WeightsType frozenWeights(inputExample.Size(), outputExample.Size());
         _frozenWeights.Swap(frozenWeights);
+        _maskedEntries.clear();
     }
 
     template <typename MatrixSolutionType>
@@ -162,6 +188,7 @@ namespace optimization
     {
         _mask = parameters.mask;
         _frozenWeights = parameters.frozenWeights;
+        UpdateMaskedEntries();
     }
 
     template <typename MatrixSolutionType>
@@ -170,6 +197,7 @@ namespace optimization
         _baseSolution = other.GetBaseSolution();
         _mask = other.GetMask();
         _frozenWeights = other.GetFrozenWeights();
+        _maskedEntries = other._maskedEntries;
     }
 
     template <typename MatrixSolutionType>
@@ -187,7 +215,7 @@ namespace optimization
         double otherScale = otherTerm.rhs;
         const auto& otherSolution = otherTerm.lhs.get();
 
-        _baseSolution = (_baseSolution * thisScale) + (otherSolution * otherScale);
+        _baseSolution = (_baseSolution * thisScale) + (otherSolution.GetBaseSolution() * otherScale);
         UpdateBaseSolution();
     }
 
@@ -233,42 +261,50 @@ namespace optimization
     }
 
     template <typename MatrixSolutionType>
-    void MaskedMatrixSolution<MatrixSolutionType>::UpdateBaseSolution()
+    void MaskedMatrixSolution<MatrixSolutionType>::MultiplyBatch(math::ConstRowMatrixReference<double> inputs, math::RowMatrixReference<double> outputs) const
     {
-        if (_mask.NumRows() == 0 || _mask.NumColumns() == 0)
-        {
-            return;
-        }
-        auto weights = _baseSolution.GetMatrix();
-        if (weights.IsContiguous() && _mask.IsContiguous() && _frozenWeights.IsContiguous())
+        _baseSolution.MultiplyBatch(inputs, outputs);
+    }
+
+    template <typename MatrixSolutionType>
+    void MaskedMatrixSolution<MatrixSolutionType>::AddBatchOuterProducts(math::ConstRowMatrixReference<double> inputs, math::ConstRowMatrixReference<double> coefficients)
+    {
+        _baseSolution.AddBatchOuterProducts(inputs, coefficients);
+        UpdateBaseSolution();
+    }
+
+    template <typename MatrixSolutionType>
+    void MaskedMatrixSolution<MatrixSolutionType>::UpdateMaskedEntries()
+    {
+        _maskedEntries.clear();
+        auto numRows = _mask.NumRows();
+        auto numColumns = _mask.NumColumns();
+        for (size_t j = 0; j < numColumns; ++j)
         {
-            auto m = _mask.GetConstDataPointer();
-            auto end = m + _mask.Size();
-            auto f = _frozenWeights.GetConstDataPointer();
-            auto w = weights.GetDataPointer();
-            for (; m != end; ++m, ++f, ++w)
+            for (size_t i = 0; i < numRows; ++i)
             {
-                if (*m != 0)
+                if (_mask(i, j) != 0)
                 {
-                    *w = *f;
+                    _maskedEntries.push_back({ i, j, static_cast<double>(_frozenWeights(i, j)) });
                 }
             }
         }
-        else
-        {
-            auto numRows = weights.NumRows();
-            auto numColumns = weights.NumColumns();
-            for (size_t i = 0; i < numRows; ++i)
+    }
+
+    template <typename MatrixSolutionType>
+    void MaskedMatrixSolution<MatrixSolutionType>::UpdateBaseSolution()
+    {
+        auto weights = _baseSolution.GetMatrix();
+        auto restoreEntries = [this, &weights](size_t begin, size_t end) {
+            for (auto entry = _maskedEntries.data() + begin, last = _maskedEntries.data() + end; entry != last; ++entry)
             {
-                for (size_t j = 0; j < numColumns; ++j)
-                {
-                    if (_mask(i, j) != 0)
-                    {
-                        weights(i, j) = _frozenWeights(i, j);
-                    }
-                }
+                weights(entry->row, entry->column) = entry->value;
             }
-        }
+        };
+
+        auto numEntries = _maskedEntries.size();
+        auto numShards = std::max(std::min(numEntries / minMaskedEntriesPerThread, utilities::GetNumThreads(0)), size_t{ 1 });
+        utilities::ParallelForRanges(numEntries, numShards, restoreEntries);
     }
 
     template <typename MatrixSolutionType>
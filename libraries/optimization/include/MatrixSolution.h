@@ -91,6 +91,12 @@ namespace optimization
         /// <summary> Computes input * weights, or input * weights + bias (if a bias exists). </summary>
         math::RowVector<double> Multiply(const InputType& input) const;
 
+        /// <summary> Computes Multiply for a batch of inputs, the rows of a matrix, with one matrix product. </summary>
+        void MultiplyBatch(math::ConstRowMatrixReference<double> inputs, math::RowMatrixReference<double> outputs) const;
+
+        /// <summary> Adds the outer products of a batch of inputs, the rows of a matrix, with the rows of a matrix of coefficients (the same as adding each Transpose(input) * coefficients), with one matrix product. </summary>
+        void AddBatchOuterProducts(math::ConstRowMatrixReference<double> inputs, math::ConstRowMatrixReference<double> coefficients);
+
         /// <summary> Returns the squared 2-norm of a given input. </summary>
         static double GetNorm2SquaredOf(const InputType& input);
 
@@ -286,6 +292,35 @@ namespace optimization
         return result;
     }
 
+    template <typename IOElementType, bool isBiased>
+    void MatrixSolution<IOElementType, isBiased>::MultiplyBatch(math::ConstRowMatrixReference<double> inputs, math::RowMatrixReference<double> outputs) const
+    {
+        double outputsScale = 0.0;
+        if constexpr (isBiased)
+        {
+            for (size_t i = 0; i < outputs.NumRows(); ++i)
+            {
+                outputs.GetRow(i).CopyFrom(_bias);
+            }
+            outputsScale = 1.0;
+        }
+
+        math::MultiplyScaleAddUpdate(1.0, inputs, _weights, outputsScale, outputs);
+    }
+
+    template <typename IOElementType, bool isBiased>
+    void MatrixSolution<IOElementType, isBiased>::AddBatchOuterProducts(math::ConstRowMatrixReference<double> inputs, math::ConstRowMatrixReference<double> coefficients)
+    {
+        math::MultiplyScaleAddUpdate(1.0, inputs.Transpose(), coefficients, 1.0, _weights);
+
+        if constexpr (isBiased)
+        {
+            math::RowVector<double> ones(coefficients.NumRows());
+            ones.Fill(1.0);
+            math::MultiplyScaleAddUpdate(1.0, ones, coefficients, 1.0, _bias);
+        }
+    }
+
     template <typename IOElementType, bool isBiased>
     double MatrixSolution<IOElementType, isBiased>::GetNorm2SquaredOf(const InputType& input)
     {
@@ -9,13 +9,22 @@
 
 #include "Common.h"
 #include "Expression.h"
+#include "L2Regularizer.h"
+
+#include <math/include/Matrix.h>
+#include <math/include/MatrixOperations.h>
+#include <math/include/VectorOperations.h>
+
+#include <utilities/include/ParallelFor.h>
 
 #include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <random>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace ell
@@ -27,6 +36,21 @@ namespace optimization
     {
         double regularizationParameter;
         bool permuteData = true;
+
+        /// <summary>
+        /// The number of examples whose dual variables are updated together against the same solution. With a batch
+        /// size of one, each update sees the solution left by the previous one, which is the classic SDCA.
+        /// </summary>
+        size_t batchSize = 1;
+
+        /// <summary> The number of threads that share the updates of a batch. </summary>
+        size_t numThreads = 1;
+
+        /// <summary>
+        /// The number of randomly drawn examples on which the early exit of Update confirms the duality gap, or zero to
+        /// confirm it on all the examples.
+        /// </summary>
+        size_t dualityGapSampleSize = 0;
     };
 
     /// <summary> Information about the current solution found by SDCA. </summary>
@@ -111,9 +135,28 @@ namespace optimization
         };
         std::vector<ExampleInfo> _exampleInfo;
 
+        // sums over the examples visited during an epoch, from which the duality gap is estimated
+        struct EpochSums
+        {
+            double loss = 0;
+            double conjugate = 0;
+        };
+
         void OneTimeSetup(std::shared_ptr<const DatasetType> examples, std::string randomSeedString);
         void InitializeDuals();
-        void Step(ExampleType example, ExampleInfo& exampleInfo);
+        void Step(ExampleType example, ExampleInfo& exampleInfo, EpochSums& sums);
+        void BatchStep(const size_t* begin, const size_t* end, EpochSums& sums);
+        void BatchStepWithMatrixProducts(const size_t* begin, const size_t* end, EpochSums& sums);
+        void UpdateDual(double lipschitz, const ExampleType& example, ExampleInfo& exampleInfo, SolutionType& v, EpochSums& sums) const;
+        template <typename PredictionType>
+        bool UpdateDualVariable(double lipschitz, PredictionType prediction, const ExampleType& example, ExampleInfo& exampleInfo, EpochSums& sums, typename SolutionType::AuxiliaryDoubleType& dualStep) const;
+        void UpdatePrimal();
+        double EstimateDualityGap(size_t sampleSize);
+
+        // With the L2 regularizer the primal solution equals _v, so _w is only updated at the end of Update and the
+        // steps predict with _v, which saves a copy of the whole solution per step
+        static constexpr bool isPrimalEqualToDual = std::is_same_v<RegularizerType, L2Regularizer>;
+        const SolutionType& GetCurrentPrimal() const { return isPrimalEqualToDual ? _v : _w; }
 
         std::shared_ptr<const DatasetType> _examples;
         LossFunctionType _lossFunction;
@@ -131,6 +174,9 @@ namespace optimization
         double _lambda = 1.0;
         double _normalizedInverseLambda = 1.0;
         bool _permuteData = true;
+        size_t _batchSize = 1;
+        size_t _numThreads = 1;
+        size_t _dualityGapSampleSize = 0;
         bool _isInitialized = false;
     };
 
@@ -197,24 +243,48 @@ namespace optimization
                 std::shuffle(permutation.begin(), permutation.end(), _randomEngine);
             }
 
-            // process each example
-            for (size_t index : permutation)
+            // process each example, or each batch of examples
+            EpochSums sums;
+            if (_batchSize <= 1)
+            {
+                for (size_t index : permutation)
+                {
+                    Step(_examples->Get(index), _exampleInfo[index], sums);
+                }
+            }
+            else
             {
-                Step(_examples->Get(index), _exampleInfo[index]);
+                for (size_t batchBegin = 0; batchBegin < permutation.size(); batchBegin += _batchSize)
+                {
+                    auto batchEnd = std::min(batchBegin + _batchSize, permutation.size());
+                    BatchStep(permutation.data() + batchBegin, permutation.data() + batchEnd, sums);
+                }
             }
 
             _areObjectivesValid = false;
             _solutionInfo.numEpochsPerformed++;
 
-            // early exit
+            // early exit: the losses seen during the epoch were measured before each update, so the gap they give is
+            // only an estimate, and the gap is confirmed (on a sample or with a full pass over the data) only once the
+            // estimate is small
             if (earlyExitDualityGap > 0)
             {
-                if (GetSolutionInfo().DualityGap() <= earlyExitDualityGap)
+                UpdatePrimal();
+                auto numExamples = static_cast<double>(_examples->Size());
+                auto estimatedPrimal = sums.loss / numExamples + _lambda * _regularizer.Value(_w);
+                auto dual = -sums.conjugate / numExamples - _lambda * _regularizer.Conjugate(_v);
+                if (estimatedPrimal - dual <= earlyExitDualityGap)
                 {
-                    break;
+                    auto dualityGap = _dualityGapSampleSize > 0 ? EstimateDualityGap(_dualityGapSampleSize) : GetSolutionInfo().DualityGap();
+                    if (dualityGap <= earlyExitDualityGap)
+                    {
+                        break;
+                    }
                 }
             }
         }
+
+        UpdatePrimal();
     }
 
     template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
@@ -236,6 +306,9 @@ namespace optimization
         _lambda = parameters.regularizationParameter;
         _normalizedInverseLambda = 1.0 / (_examples->Size() * parameters.regularizationParameter);
         _permuteData = parameters.permuteData;
+        _batchSize = parameters.batchSize;
+        _numThreads = std::max(parameters.numThreads, size_t{ 1 });
+        _dualityGapSampleSize = parameters.dualityGapSampleSize;
     }
 
     template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
@@ -248,6 +321,10 @@ namespace optimization
     void SDCAOptimizer<SolutionType, LossFunctionType, RegularizerType>::SetRegularizer(RegularizerType regularizer)
     {
         _regularizer = std::move(regularizer);
+
+        // the dual variables stay valid, so only the primal solution they give changes
+        _regularizer.ConjugateGradient(_v, _w);
+        _areObjectivesValid = false;
     }
 
     template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
@@ -328,36 +405,188 @@ namespace optimization
     }
 
     template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
-    void SDCAOptimizer<SolutionType, LossFunctionType, RegularizerType>::Step(ExampleType example, ExampleInfo& exampleInfo)
+    void SDCAOptimizer<SolutionType, LossFunctionType, RegularizerType>::Step(ExampleType example, ExampleInfo& exampleInfo, EpochSums& sums)
     {
-        const double tolerance = 1.0e-8;
         auto lipschitz = exampleInfo.norm2Squared * _normalizedInverseLambda;
-        if (lipschitz < tolerance)
+        UpdateDual(lipschitz, example, exampleInfo, _v, sums);
+
+        if constexpr (!isPrimalEqualToDual)
         {
+            _regularizer.ConjugateGradient(_v, _w);
+        }
+    }
+
+    template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
+    void SDCAOptimizer<SolutionType, LossFunctionType, RegularizerType>::BatchStep(const size_t* begin, const size_t* end, EpochSums& sums)
+    {
+        if constexpr (HasBatchProducts<SolutionType>::value)
+        {
+            BatchStepWithMatrixProducts(begin, end, sums);
             return;
         }
 
+        // All the dual updates in a batch see the same _w, so the step of each is shortened by the batch size, which
+        // keeps the combined update safe even when the examples in the batch are strongly correlated
+        auto batchSize = static_cast<size_t>(end - begin);
+        auto numShards = std::min(_numThreads, batchSize);
+        std::vector<std::optional<SolutionType>> shardDeltas(numShards);
+        std::vector<EpochSums> shardSums(numShards);
+        utilities::ParallelForBlocks(numShards, [this, begin, batchSize, numShards, &shardDeltas, &shardSums](size_t shardIndex) {
+            auto& deltaV = shardDeltas[shardIndex].emplace(_v);
+            deltaV.Reset();
+            auto shardEnd = begin + batchSize * (shardIndex + 1) / numShards;
+            for (auto index = begin + batchSize * shardIndex / numShards; index < shardEnd; ++index)
+            {
+                auto& exampleInfo = _exampleInfo[*index];
+                auto lipschitz = exampleInfo.norm2Squared * _normalizedInverseLambda * batchSize;
+                UpdateDual(lipschitz, _examples->Get(*index), exampleInfo, deltaV, shardSums[shardIndex]);
+            }
+        });
+
+        // Add the shards in order, so the result doesn't depend on which thread finished first
+        for (size_t shardIndex = 0; shardIndex < numShards; ++shardIndex)
+        {
+            _v = _v * 1.0 + *shardDeltas[shardIndex] * 1.0;
+            sums.loss += shardSums[shardIndex].loss;
+            sums.conjugate += shardSums[shardIndex].conjugate;
+        }
+
+        if constexpr (!isPrimalEqualToDual)
+        {
+            _regularizer.ConjugateGradient(_v, _w);
+        }
+    }
+
+    template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
+    void SDCAOptimizer<SolutionType, LossFunctionType, RegularizerType>::BatchStepWithMatrixProducts(const size_t* begin, const size_t* end, EpochSums& sums)
+    {
+        // The inputs of the batch are the rows of a matrix, so the predictions and the update of _v are each one
+        // matrix product instead of one vector-matrix product per example
+        auto batchSize = static_cast<size_t>(end - begin);
+        const auto& primal = GetCurrentPrimal();
+        auto inputSize = primal.GetMatrix().NumRows();
+        auto outputSize = primal.GetMatrix().NumColumns();
+
+        math::RowMatrix<double> inputs(batchSize, inputSize);
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+            inputs.GetRow(i).CopyFrom(_examples->Get(begin[i]).input);
+        }
+
+        math::RowMatrix<double> predictions(batchSize, outputSize);
+        primal.MultiplyBatch(inputs, predictions);
+
+        // the dual steps are the rows of a matrix, and the rows of the examples skipped stay zero
+        math::RowMatrix<double> dualSteps(batchSize, outputSize);
+        auto numShards = std::min(_numThreads, batchSize);
+        std::vector<EpochSums> shardSums(numShards);
+        utilities::ParallelForBlocks(numShards, [this, begin, batchSize, numShards, outputSize, &predictions, &dualSteps, &shardSums](size_t shardIndex) {
+            typename SolutionType::AuxiliaryDoubleType dualStep;
+            auto shardEnd = batchSize * (shardIndex + 1) / numShards;
+            for (auto i = batchSize * shardIndex / numShards; i < shardEnd; ++i)
+            {
+                auto& exampleInfo = _exampleInfo[begin[i]];
+                auto lipschitz = exampleInfo.norm2Squared * _normalizedInverseLambda * batchSize;
+                math::RowVector<double> prediction(outputSize);
+                prediction.CopyFrom(predictions.GetRow(i));
+                if (UpdateDualVariable(lipschitz, std::move(prediction), _examples->Get(begin[i]), exampleInfo, shardSums[shardIndex], dualStep))
+                {
+                    dualSteps.GetRow(i).CopyFrom(dualStep);
+                }
+            }
+        });
+
+        for (const auto& shard : shardSums)
+        {
+            sums.loss += shard.loss;
+            sums.conjugate += shard.conjugate;
+        }
+
+        _v.AddBatchOuterProducts(inputs, dualSteps);
+
+        if constexpr (!isPrimalEqualToDual)
+        {
+            _regularizer.ConjugateGradient(_v, _w);
+        }
+    }
+
+    template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
+    void SDCAOptimizer<SolutionType, LossFunctionType, RegularizerType>::UpdateDual(double lipschitz, const ExampleType& example, ExampleInfo& exampleInfo, SolutionType& v, EpochSums& sums) const
+    {
+        typename SolutionType::AuxiliaryDoubleType dualStep;
+        if (UpdateDualVariable(lipschitz, example.input * GetCurrentPrimal(), example, exampleInfo, sums, dualStep)) // ## perf: creates new vector
+        {
+            // v' = v + (input.T * dual'')
+            v += Transpose(example.input) * dualStep;
+        }
+    }
+
+    template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
+    template <typename PredictionType>
+    bool SDCAOptimizer<SolutionType, LossFunctionType, RegularizerType>::UpdateDualVariable(double lipschitz, PredictionType prediction, const ExampleType& example, ExampleInfo& exampleInfo, EpochSums& sums, typename SolutionType::AuxiliaryDoubleType& dualStep) const
+    {
+        sums.loss += _lossFunction.Value(prediction, example.output);
+
+        const double tolerance = 1.0e-8;
+        if (lipschitz < tolerance)
+        {
+            sums.conjugate += _lossFunction.Conjugate(exampleInfo.dual, example.output);
+            return false;
+        }
+
         // p = ((input * w) / lipschitz) + dual
-        auto prediction = example.input * _w; // ## perf: creates new vector
         prediction /= lipschitz;
         prediction += exampleInfo.dual;
 
         // dual' = ConjProx(1/lipschitz, prediction, output)
         // dual'' = (dual - dual') * (1/(lambda*N))    ---- lambda == L2 regularization parameter
-        auto newDual = _lossFunction.ConjugateProx(1.0 / lipschitz, prediction, example.output); // ## perf: creates new vector
-        exampleInfo.dual -= newDual;
-        exampleInfo.dual *= _normalizedInverseLambda;
+        dualStep = _lossFunction.ConjugateProx(1.0 / lipschitz, prediction, example.output); // ## perf: creates new vector
+        sums.conjugate += _lossFunction.Conjugate(dualStep, example.output);
+        std::swap(exampleInfo.dual, dualStep);
+        dualStep -= exampleInfo.dual;
+        dualStep *= _normalizedInverseLambda;
+        return true;
+    }
 
-        // _v' = _v + (input.T * dual'')
-        _v += Transpose(example.input) * exampleInfo.dual;
+    template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
+    void SDCAOptimizer<SolutionType, LossFunctionType, RegularizerType>::UpdatePrimal()
+    {
+        if constexpr (isPrimalEqualToDual)
+        {
+            _regularizer.ConjugateGradient(_v, _w);
+        }
+    }
 
-        // L2: _w = _v
-        _regularizer.ConjugateGradient(_v, _w); // ## perf: L2 regularizer implements this as "_w = _v" (a matrix and a vector copy)
+    template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
+    double SDCAOptimizer<SolutionType, LossFunctionType, RegularizerType>::EstimateDualityGap(size_t sampleSize)
+    {
+        if (sampleSize >= _examples->Size())
+        {
+            return GetSolutionInfo().DualityGap();
+        }
 
-        // dual = dual'
-        exampleInfo.dual = newDual; // ## perf: vector copy
+        // since _w is the conjugate gradient of _v, the duality gap is the average over the examples of the
+        // Fenchel-Young gaps loss(prediction) + conjugate(dual) - dual * prediction, which are all nonnegative
+        double gapSum = 0;
+        std::uniform_int_distribution<size_t> indexDistribution(0, _examples->Size() - 1);
+        for (size_t i = 0; i < sampleSize; ++i)
+        {
+            auto index = indexDistribution(_randomEngine);
+            auto example = _examples->Get(index);
+            const auto& dual = _exampleInfo[index].dual;
+            auto prediction = example.input * _w;
+            gapSum += _lossFunction.Value(prediction, example.output) + _lossFunction.Conjugate(dual, example.output);
+            if constexpr (std::is_same_v<decltype(prediction), double>)
+            {
+                gapSum -= dual * prediction;
+            }
+            else
+            {
+                gapSum -= math::Dot(dual, prediction);
+            }
+        }
+        return gapSum / sampleSize;
     }
-
     template <typename SolutionType, typename LossFunctionType, typename RegularizerType>
     SDCAOptimizer<SolutionType, LossFunctionType, RegularizerType> MakeSDCAOptimizer(std::shared_ptr<const typename SolutionType::DatasetType> examples, LossFunctionType lossFunction, RegularizerType regularizer, SDCAOptimizerParameters parameters, std::string randomSeedString)
     {
@@ -9,10 +9,13 @@
 
 #include "Common.h"
 
+#include <utilities/include/ParallelFor.h>
+
 #include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <random>
 #include <string>
 #include <vector>
@@ -26,9 +29,14 @@ namespace optimization
     {
         double regularizationParameter;
         std::string randomSeedString = "abc123";
+        size_t numThreads = 1; // zero to use one thread per core
     };
 
-    /// <summary> Stochastic gradient descent optimizer. </summary>
+    /// <summary> Stochastic gradient descent optimizer. With more than one thread, each epoch splits the shuffled
+    /// examples into one shard per thread, each thread runs SGD on its shard starting from the current solution,
+    /// and the solutions of the threads are averaged at the end of the epoch. The shrinkage of the L2 regularizer is
+    /// applied lazily, so a step only adds the scaled example to two accumulators instead of rescaling the last and
+    /// averaged solutions, and the solutions are recovered from the accumulators at the end of each epoch. </summary>
     ///
     /// <typeparam name="SolutionType"> Solution type. </typeparam>
     /// <typeparam name="LossFunctionType"> Loss function type. </typeparam>
@@ -52,18 +60,37 @@ namespace optimization
         void Update(size_t epochs = 1);
 
         /// <summary> Returns the current solution to the optimization problem. </summary>
-        const SolutionType& GetSolution() const { return _averagedW; }
+        const SolutionType& GetSolution() const { return _state.averagedW; }
 
     private:
-        void Step(ExampleType example);
+        // the last and averaged solutions after t steps
+        struct State
+        {
+            SolutionType lastW;
+            SolutionType averagedW;
+            double t = 0;
+        };
+
+        // the state during an epoch: t * lastW, and the correction that recovers t * averagedW from it
+        struct LazyState
+        {
+            SolutionType scaledW;
+            SolutionType averageCorrection;
+            double t = 0;
+            double harmonicSum = 0; // the sum of 1/s over the steps s of this epoch
+        };
+
+        LazyState BeginLazySteps(const State& state) const;
+        void Step(ExampleType example, LazyState& lazyState) const;
+        State EndLazySteps(const LazyState& lazyState, State state) const;
+        void UpdateInParallel(const std::vector<size_t>& permutation);
 
         std::shared_ptr<const DatasetType> _examples;
         LossFunctionType _lossFunction;
         std::default_random_engine _randomEngine;
-        SolutionType _lastW;
-        SolutionType _averagedW;
-        double _t = 0;
+        State _state;
         double _lambda;
+        size_t _numThreads;
     };
 
     /// <summary> Convenience function for constructing an SGD optimizer. </summary>
@@ -84,7 +111,8 @@ namespace optimization
     SGDOptimizer<SolutionType, LossFunctionType>::SGDOptimizer(std::shared_ptr<const DatasetType> examples, LossFunctionType lossFunction, SGDOptimizerParameters parameters) :
         _examples(examples),
         _lossFunction(std::move(lossFunction)),
-        _lambda(parameters.regularizationParameter)
+        _lambda(parameters.regularizationParameter),
+        _numThreads(utilities::GetNumThreads(parameters.numThreads))
     {
         if (examples.get() == nullptr || examples->Size() == 0)
         {
@@ -107,8 +135,8 @@ namespace optimization
         _randomEngine.seed(seed);
 
         auto example = examples->Get(0);
-        _lastW.Resize(example.input, example.output);
-        _averagedW.Resize(example.input, example.output);
+        _state.lastW.Resize(example.input, example.output);
+        _state.averagedW.Resize(example.input, example.output);
     }
 
     template <typename SolutionType, typename LossFunctionType>
@@ -123,34 +151,113 @@ namespace optimization
             // generate random permutation
             std::shuffle(permutation.begin(), permutation.end(), _randomEngine);
 
+            if (_numThreads > 1 && permutation.size() > 1)
+            {
+                UpdateInParallel(permutation);
+                continue;
+            }
+
             // process each example
+            auto lazyState = BeginLazySteps(_state);
             for (size_t index : permutation)
             {
-                Step(_examples->Get(index));
+                Step(_examples->Get(index), lazyState);
             }
+            _state = EndLazySteps(lazyState, std::move(_state));
+        }
+    }
+
+    template <typename SolutionType, typename LossFunctionType>
+    void SGDOptimizer<SolutionType, LossFunctionType>::UpdateInParallel(const std::vector<size_t>& permutation)
+    {
+        auto numShards = std::min(_numThreads, permutation.size());
+        std::vector<std::optional<State>> shardStates(numShards);
+        utilities::ParallelForBlocks(numShards, [this, &permutation, &shardStates, numShards](size_t shardIndex) {
+            auto lazyState = BeginLazySteps(_state);
+            auto end = permutation.size() * (shardIndex + 1) / numShards;
+            for (auto i = permutation.size() * shardIndex / numShards; i < end; ++i)
+            {
+                Step(_examples->Get(permutation[i]), lazyState);
+            }
+            shardStates[shardIndex].emplace(EndLazySteps(lazyState, _state));
+        });
+        auto state = std::move(*shardStates[0]);
+
+        // average the solutions of the shards, each of which took about the same number of steps
+        double t = state.t;
+        for (size_t shardIndex = 1; shardIndex < numShards; ++shardIndex)
+        {
+            const auto& shardState = *shardStates[shardIndex];
+            double inverseCount = 1.0 / (shardIndex + 1);
+            state.lastW = state.lastW * (1.0 - inverseCount) + shardState.lastW * inverseCount;
+            state.averagedW = state.averagedW * (1.0 - inverseCount) + shardState.averagedW * inverseCount;
+            t += shardState.t;
         }
+        state.t = t / numShards;
+        _state = std::move(state);
     }
 
+    // The eager update at step t is
+    //     lastW_t = (1 - 1/t) * lastW_{t-1} + g_t
+    //     averagedW_t = (1 - 1/t) * averagedW_{t-1} + lastW_t / t
+    // where g_t = -weight * Transpose(x) * derivative / (lambda * t). Starting an epoch at step t0, this gives
+    //     t * lastW_t = t0 * lastW_t0 + sum_s s * g_s = scaledW_t
+    //     t * averagedW_t = t0 * averagedW_t0 + sum_s scaledW_s / s = averageCorrection_t + harmonicSum_t * scaledW_t
+    // where the sums are over the steps s = t0 + 1, ..., t of the epoch and averageCorrection accumulates
+    // -s * harmonicSum_{s-1} * g_s. Each step then touches the solution only where the example is nonzero.
     template <typename SolutionType, typename LossFunctionType>
-    void SGDOptimizer<SolutionType, LossFunctionType>::Step(ExampleType example)
+    typename SGDOptimizer<SolutionType, LossFunctionType>::LazyState SGDOptimizer<SolutionType, LossFunctionType>::BeginLazySteps(const State& state) const
+    {
+        LazyState lazyState{ state.lastW, state.averagedW, state.t };
+        lazyState.scaledW = lazyState.scaledW * 0.0 + state.lastW * state.t;
+        lazyState.averageCorrection = lazyState.averageCorrection * 0.0 + state.averagedW * state.t;
+        return lazyState;
+    }
+
+    template <typename SolutionType, typename LossFunctionType>
+    void SGDOptimizer<SolutionType, LossFunctionType>::Step(ExampleType example, LazyState& lazyState) const
     {
         const auto& x = example.input;
         const auto& y = example.output;
         double weight = example.weight;
 
-        ++_t;
-
         // predict
-        auto p = x * _lastW;
+        auto p = x * lazyState.scaledW;
+        if (lazyState.t > 0)
+        {
+            p *= 1.0 / lazyState.t;
+        }
 
-        // calculate the loss derivative
+        ++lazyState.t;
+
+        // calculate the loss derivative, scaled by t
         auto derivative = _lossFunction.Derivative(p, y);
-        derivative *= -weight / (_lambda * _t);
+        derivative *= -weight / _lambda;
+
+        // update the accumulators
+        lazyState.scaledW += Transpose(x) * derivative;
+        if (lazyState.harmonicSum != 0)
+        {
+            derivative *= -lazyState.harmonicSum;
+            lazyState.averageCorrection += Transpose(x) * derivative;
+        }
+        lazyState.harmonicSum += 1.0 / lazyState.t;
+    }
+
+    template <typename SolutionType, typename LossFunctionType>
+    typename SGDOptimizer<SolutionType, LossFunctionType>::State SGDOptimizer<SolutionType, LossFunctionType>::EndLazySteps(const LazyState& lazyState, State state) const
+    {
+        if (lazyState.t == state.t)
+        {
+            return state;
+        }
 
-        // update the solution
-        double inverseT = 1.0 / _t;
-        _lastW = _lastW * (1.0 - inverseT) + Transpose(x) * derivative;
-        _averagedW = _averagedW * (1.0 - inverseT) + _lastW * inverseT;
+        double inverseT = 1.0 / lazyState.t;
+        state.lastW = state.lastW * 0.0 + lazyState.scaledW * inverseT;
+        state.averagedW = state.averagedW * 0.0 + lazyState.averageCorrection * inverseT;
+        state.averagedW = state.averagedW * 1.0 + lazyState.scaledW * (lazyState.harmonicSum * inverseT);
+        state.t = lazyState.t;
+        return state;
     }
 
     template <typename SolutionType, typename LossFunctionType>
@@ -22,6 +22,18 @@ void TestSDCAClassificationConvergence(LossFunctionType lossFunction, Regularize
 template <typename LossFunctionType, typename RegularizerType>
 void TestSDCAReset(LossFunctionType lossFunction, RegularizerType regularizer);
 
+/// <summary> Tests that SDCA stops early when the duality gap estimated on a sample of the examples is small.</summary>
+template <typename LossFunctionType, typename RegularizerType>
+void TestSDCASampledDualityGap(LossFunctionType lossFunction, RegularizerType regularizer);
+
+/// <summary> Tests that SGD on several threads converges to the solution that SDCA finds.</summary>
+template <typename LossFunctionType>
+void TestParallelSGD(LossFunctionType lossFunction, double regularizationParameter);
+
+/// <summary> Tests that SGD with lazy regularization updates matches SGD that shrinks the whole solution at every step.</summary>
+template <typename LossFunctionType>
+void TestSGDLazyUpdates(LossFunctionType lossFunction, double regularizationParameter);
+
 #pragma region implementation
 
 #include "../include/RandomDataset.h"
@@ -29,13 +41,17 @@ void TestSDCAReset(LossFunctionType lossFunction, RegularizerType regularizer);
 #include <optimization/include/GetSparseSolution.h>
 #include <optimization/include/IndexedContainer.h>
 #include <optimization/include/OptimizationExample.h>
+#include <optimization/include/L2Regularizer.h>
 #include <optimization/include/SDCAOptimizer.h>
+#include <optimization/include/SGDOptimizer.h>
 #include <optimization/include/VectorSolution.h>
 
 #include <testing/include/testing.h>
 
+#include <cmath>
 #include <memory>
 #include <string>
+#include <vector>
 
 using namespace ell;
 using namespace ell::optimization;
@@ -156,6 +172,137 @@ void TestSDCAReset(LossFunctionType lossFunction, RegularizerType regularizer)
     testing::ProcessTest("TestSDCAReset <" + lossName + ", " + regularizerName + ">", vector1 == vector2 && vector1 == vector3);
 }
 
+template <typename LossFunctionType, typename RegularizerType>
+void TestSDCASampledDualityGap(LossFunctionType lossFunction, RegularizerType regularizer)
+{
+    size_t count = 500;
+    size_t size = 17;
+    size_t maxEpochs = 50;
+    double earlyStopping = 1.0e-4;
+
+    std::string randomSeedString = "GoodLuckMan";
+    std::seed_seq seed(randomSeedString.begin(), randomSeedString.end());
+    std::default_random_engine randomEngine(seed);
+
+    VectorSolution<double, true> solution(size);
+    std::normal_distribution<double> biasDistribution(0, 1.0);
+    solution.GetBias() = biasDistribution(randomEngine);
+
+    std::uniform_int_distribution<int> vectorDistribution(-1, 1);
+    solution.GetVector().Generate([&]() { return vectorDistribution(randomEngine); });
+
+    auto examples = GetRegressionDataset(count, 1.0, 1.0, solution, randomEngine);
+
+    // the sampled gap is only an estimate, so the exact gap is allowed to be somewhat larger than the early exit gap
+    auto optimizer = MakeSDCAOptimizer<VectorSolution<double, true>>(examples, lossFunction, regularizer, { .1, true, 1, 1, 100 });
+    optimizer.Update(maxEpochs, earlyStopping);
+    const auto& solutionInfo = optimizer.GetSolutionInfo();
+
+    std::string lossName = typeid(LossFunctionType).name();
+    lossName = lossName.substr(lossName.find_last_of(":") + 1);
+    std::string regularizerName = typeid(RegularizerType).name();
+    regularizerName = regularizerName.substr(regularizerName.find_last_of(":") + 1);
+
+    testing::ProcessTest("TestSDCASampledDualityGap <" + lossName + ", " + regularizerName + ">", solutionInfo.numEpochsPerformed < maxEpochs && solutionInfo.DualityGap() <= 10 * earlyStopping);
+}
+
+template <typename LossFunctionType>
+void TestParallelSGD(LossFunctionType lossFunction, double regularizationParameter)
+{
+    size_t count = 2000;
+    size_t size = 17;
+    size_t epochs = 20;
+
+    std::string randomSeedString = "GoodLuckMan";
+    std::seed_seq seed(randomSeedString.begin(), randomSeedString.end());
+    std::default_random_engine randomEngine(seed);
+
+    // create random solution
+    VectorSolution<double, true> targetSolution(size);
+    std::normal_distribution<double> biasDistribution(0, 1.0);
+    targetSolution.GetBias() = biasDistribution(randomEngine);
+
+    std::uniform_int_distribution<int> vectorDistribution(-1, 1);
+    targetSolution.GetVector().Generate([&]() { return vectorDistribution(randomEngine); });
+
+    auto examples = GetRegressionDataset(count, 1.0, 1.0, targetSolution, randomEngine);
+
+    // the optimum, up to a negligible duality gap
+    auto sdcaOptimizer = MakeSDCAOptimizer<VectorSolution<double, true>>(examples, lossFunction, L2Regularizer{}, { regularizationParameter, true });
+    sdcaOptimizer.Update(100, 1.0e-8);
+    const auto& optimum = sdcaOptimizer.GetSolution();
+
+    auto getDistance = [&](size_t numThreads) {
+        auto optimizer = MakeSGDOptimizer<VectorSolution<double, true>>(examples, lossFunction, { regularizationParameter, "abc123", numThreads });
+        optimizer.Update(epochs);
+        const auto& solution = optimizer.GetSolution();
+        double distanceSquared = std::pow(solution.GetBias() - optimum.GetBias(), 2);
+        for (size_t i = 0; i < size; ++i)
+        {
+            distanceSquared += std::pow(solution.GetVector()[i] - optimum.GetVector()[i], 2);
+        }
+        return std::sqrt(distanceSquared);
+    };
+    double sequentialDistance = getDistance(1);
+    double parallelDistance = getDistance(4);
+
+    std::string lossName = typeid(LossFunctionType).name();
+    lossName = lossName.substr(lossName.find_last_of(":") + 1);
+
+    testing::ProcessTest("TestParallelSGD <" + lossName + ">", parallelDistance < 0.05 && sequentialDistance < 0.05);
+}
+
+template <typename LossFunctionType>
+void TestSGDLazyUpdates(LossFunctionType lossFunction, double regularizationParameter)
+{
+    size_t size = 10;
+    size_t epochs = 7;
+
+    // a single sparse example, so that the order of the steps is known
+    math::RowVector<double> input(size);
+    input[1] = 2.0;
+    input[6] = -1.0;
+    double output = 1.5;
+    auto examples = std::make_shared<VectorIndexedContainer<VectorExampleType, ContainerExampleType>>();
+    examples->push_back(VectorExampleType{ input, output });
+
+    // run SGD over two calls to Update, so the lazy state is carried across epochs
+    auto optimizer = MakeSGDOptimizer<VectorSolution<double, true>>(examples, lossFunction, { regularizationParameter });
+    optimizer.Update(3);
+    optimizer.Update(epochs - 3);
+    const auto& solution = optimizer.GetSolution();
+
+    // the eager updates
+    std::vector<double> lastW(size + 1, 0.0);
+    std::vector<double> averagedW(size + 1, 0.0);
+    for (size_t t = 1; t <= epochs; ++t)
+    {
+        double p = lastW[size];
+        for (size_t i = 0; i < size; ++i)
+        {
+            p += input[i] * lastW[i];
+        }
+        double derivative = -lossFunction.Derivative(p, output) / (regularizationParameter * t);
+        double inverseT = 1.0 / t;
+        for (size_t i = 0; i <= size; ++i)
+        {
+            lastW[i] = lastW[i] * (1.0 - inverseT) + (i < size ? input[i] : 1.0) * derivative;
+            averagedW[i] = averagedW[i] * (1.0 - inverseT) + lastW[i] * inverseT;
+        }
+    }
+
+    bool success = testing::IsEqual(solution.GetBias(), averagedW[size], 1.0e-8);
+    for (size_t i = 0; i < size; ++i)
+    {
+        success = success && testing::IsEqual(solution.GetVector()[i], averagedW[i], 1.0e-8);
+    }
+
+    std::string lossName = typeid(LossFunctionType).name();
+    lossName = lossName.substr(lossName.find_last_of(":") + 1);
+
+    testing::ProcessTest("TestSGDLazyUpdates <" + lossName + ">", success);
+}
+
 template <typename LossFunctionType>
 void TestGetSparseSolution(LossFunctionType lossFunction, double regularizationParameter)
 {
@@ -193,6 +340,14 @@ void TestGetSparseSolution(LossFunctionType lossFunction, double regularizationP
                          std::abs(nonZeroFraction1 - 0.75) < 0.1 &&
                              std::abs(nonZeroFraction2 - 0.5) < 0.1 &&
                              std::abs(nonZeroFraction3 - 0.25) < 0.1);
+
+    // probing several values side by side
+    GetSparseSolutionParameters concurrentParameters{ { 0.45, 0.5 }, { regularizationParameter } };
+    concurrentParameters.numConcurrentProbes = 3;
+    auto trainedSolution4 = GetSparseSolution<VectorSolution<double, true>>(examples, lossFunction, concurrentParameters).solution;
+    double nonZeroFraction4 = trainedSolution4.GetVector().Norm0() / trainedSolution4.GetVector().Size();
+
+    testing::ProcessTest("TestGetSparseSolution with concurrent probes", std::abs(nonZeroFraction4 - 0.5) < 0.1);
 }
 
 #pragma endregion implementation
@@ -36,9 +36,9 @@ using namespace ell::optimization;
 template <typename RealType, typename LossFunctionType, typename RegularizerType>
 void TestSolutionEquivalenceSGD(double regularizationParameter);
 
-/// <summary> Tests that biased and unbiased VectorSolution and biased and unbiased MatrixSolution all behave identically when given equivalent SDCA optimization problems. </summary>
+/// <summary> Tests that biased and unbiased VectorSolution and biased and unbiased MatrixSolution all behave identically when given equivalent SDCA optimization problems. With a batch size above one, the matrix solutions update with matrix products. </summary>
 template <typename RealType, typename LossFunctionType, typename RegularizerType>
-void TestSolutionEquivalenceSDCA(double regularizationParameter);
+void TestSolutionEquivalenceSDCA(double regularizationParameter, size_t batchSize = 1);
 
 /// <summary> Tests masked matrix solution operations </summary>
 template <typename RealType, template <typename> class SolutionType>
@@ -106,7 +106,7 @@ void TestSolutionEquivalenceSGD(double regularizationParameter)
 
 // Run the SDCA trainer with four different solution types and confirm that the result is identical
 template <typename RealType, typename LossFunctionType, typename RegularizerType>
-void TestSolutionEquivalenceSDCA(double regularizationParameter)
+void TestSolutionEquivalenceSDCA(double regularizationParameter, size_t batchSize)
 {
     std::string randomSeedString = "54321blastoff";
     std::seed_seq seed(randomSeedString.begin(), randomSeedString.end());
@@ -134,32 +134,33 @@ void TestSolutionEquivalenceSDCA(double regularizationParameter)
     auto examples6 = GetRandomDataset<RealType, VectorVectorExampleType<RealType>, VectorRefVectorRefExampleType<RealType>>(numExamples, exampleSize, randomEngine, 0);
 
     // setup four equivalent optimizers
-    auto optimizer1 = MakeSDCAOptimizer<VectorSolution<RealType>>(examples1, LossFunctionType{}, RegularizerType{}, { regularizationParameter });
+    SDCAOptimizerParameters parameters{ regularizationParameter, true, batchSize };
+    auto optimizer1 = MakeSDCAOptimizer<VectorSolution<RealType>>(examples1, LossFunctionType{}, RegularizerType{}, parameters);
     optimizer1.Update();
     const auto& solution1 = optimizer1.GetSolution();
     const auto& vector1 = solution1.GetVector();
 
-    auto optimizer2 = MakeSDCAOptimizer<VectorSolution<RealType, true>>(examples2, LossFunctionType{}, RegularizerType{}, { regularizationParameter });
+    auto optimizer2 = MakeSDCAOptimizer<VectorSolution<RealType, true>>(examples2, LossFunctionType{}, RegularizerType{}, parameters);
     optimizer2.Update();
     const auto& solution2 = optimizer2.GetSolution();
     const auto& vector2 = solution2.GetVector();
 
-    auto optimizer3 = MakeSDCAOptimizer<MatrixSolution<RealType>>(examples3, MultivariateLoss<LossFunctionType>{}, RegularizerType{}, { regularizationParameter });
+    auto optimizer3 = MakeSDCAOptimizer<MatrixSolution<RealType>>(examples3, MultivariateLoss<LossFunctionType>{}, RegularizerType{}, parameters);
     optimizer3.Update();
     const auto& solution3 = optimizer3.GetSolution();
     const auto& vector3 = solution3.GetMatrix().GetColumn(0);
 
-    auto optimizer4 = MakeSDCAOptimizer<MatrixSolution<RealType, true>>(examples4, MultivariateLoss<LossFunctionType>{}, RegularizerType{}, { regularizationParameter });
+    auto optimizer4 = MakeSDCAOptimizer<MatrixSolution<RealType, true>>(examples4, MultivariateLoss<LossFunctionType>{}, RegularizerType{}, parameters);
     optimizer4.Update();
     const auto& solution4 = optimizer4.GetSolution();
     const auto& vector4 = solution4.GetMatrix().GetColumn(0);
 
-    auto optimizer5 = MakeSDCAOptimizer<MaskedMatrixSolution<MatrixSolution<RealType>>>(examples5, MultivariateLoss<LossFunctionType>{}, RegularizerType{}, { regularizationParameter });
+    auto optimizer5 = MakeSDCAOptimizer<MaskedMatrixSolution<MatrixSolution<RealType>>>(examples5, MultivariateLoss<LossFunctionType>{}, RegularizerType{}, parameters);
     optimizer5.Update();
     const auto& solution5 = optimizer5.GetSolution();
     const auto& vector5 = solution5.GetMatrix().GetColumn(0);
 
-    auto optimizer6 = MakeSDCAOptimizer<MaskedMatrixSolution<MatrixSolution<RealType, true>>>(examples6, MultivariateLoss<LossFunctionType>{}, RegularizerType{}, { regularizationParameter });
+    auto optimizer6 = MakeSDCAOptimizer<MaskedMatrixSolution<MatrixSolution<RealType, true>>>(examples6, MultivariateLoss<LossFunctionType>{}, RegularizerType{}, parameters);
     optimizer6.Update();
     const auto& solution6 = optimizer6.GetSolution();
     const auto& vector6 = solution6.GetMatrix().GetColumn(0);
@@ -169,6 +170,10 @@ void TestSolutionEquivalenceSDCA(double regularizationParameter)
     std::string realName = typeid(RealType).name();
     std::string lossName = typeid(LossFunctionType).name();
     lossName = lossName.substr(lossName.find_last_of(":") + 1);
+    if (batchSize > 1)
+    {
+        lossName += ", batch size " + std::to_string(batchSize);
+    }
 
     // test if the two solutions are identical
     testing::ProcessTest("TestSolutionEquivalenceSDCA (v1 == v2) <" + realName + ", " + lossName + ">", vector1.GetSubVector(0, exampleSize).IsEqual(vector2, comparisonTolerance));
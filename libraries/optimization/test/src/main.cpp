@@ -106,6 +106,10 @@ int main()
     TestSDCARegressionConvergence(SquareLoss{}, MaxRegularizer{ 0 }, { .1, true }, 1.0e-4, 1.0, 1.0, 1.0);
     TestSDCARegressionConvergence(SquareLoss{}, MaxRegularizer{ 1 }, { 1, true }, 1.0e-4, 1.0, 1.0, 1.0);
 
+    // mini-batches, updated on several threads
+    TestSDCARegressionConvergence(HuberLoss{}, L2Regularizer{}, { .1, true, 8, 4 }, 1.0e-4, 1.0, 1.0, 1.0);
+    TestSDCARegressionConvergence(SquareLoss{}, ElasticNetRegularizer{ .5 }, { .1, true, 8, 4 }, 1.0e-4, 1.0, 1.0, 1.0);
+
     // Test convergence of SDCA on a synthetic classification problem
 
     TestSDCAClassificationConvergence(HingeLoss{}, L2Regularizer{}, { .1, true }, 1.0e-4, 1.0, 1.0, 3.0);
@@ -133,6 +137,11 @@ int main()
 
     // SDCA Reset
     TestSDCAReset(SquaredHingeLoss{}, L2Regularizer{});
+    TestSDCASampledDualityGap(SquareLoss{}, L2Regularizer{});
+    TestSDCASampledDualityGap(SquareLoss{}, ElasticNetRegularizer{ .5 });
+    TestParallelSGD(HuberLoss{}, 0.1);
+    TestSGDLazyUpdates(SquareLoss{}, 0.1);
+    TestSGDLazyUpdates(HuberLoss{}, 0.01);
     TestGetSparseSolution(SmoothedHingeLoss{}, 0.01);
 
     // SGD solution equivalence tests, confirms that the four solution types behave identically when given equivalent problems
@@ -189,6 +198,11 @@ int main()
     TestSolutionEquivalenceSDCA<float, LogisticLoss, MaxRegularizer>(0.0001);
     TestSolutionEquivalenceSDCA<int, LogisticLoss, MaxRegularizer>(0.0001);
 
+    // mini-batches, which the matrix solutions update with matrix products
+    TestSolutionEquivalenceSDCA<double, HuberLoss, L2Regularizer>(0.001, 2);
+    TestSolutionEquivalenceSDCA<float, LogisticLoss, ElasticNetRegularizer>(0.0001, 2);
+    TestSolutionEquivalenceSDCA<double, SquareLoss, L2Regularizer>(10, 4);
+
     TestSolutionEquivalenceSDCA<double, SmoothedHingeLoss, L2Regularizer>(0.001);
     TestSolutionEquivalenceSDCA<int, SmoothedHingeLoss, L2Regularizer>(0.001);
 
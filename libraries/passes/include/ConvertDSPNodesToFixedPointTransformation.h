@@ -0,0 +1,34 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ConvertDSPNodesToFixedPointTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that replaces the DSP nodes (HammingWindowNode, FFTNode, FilterBankNode, IIRFilterNode and
+    /// DCTNode) with versions that compute in fixed point, for devices without a floating-point unit. Enabled by the
+    /// "fixedPointDSP" optimizer option, which names the fixed-point format ("q15", "q31" or "qI.F"). Each node converts
+    /// its input to the format, so the nodes after an FFT need integer bits for the magnitudes of the spectrum. Like
+    /// the other optimizer options, it can be set for individual nodes.
+    /// </summary>
+    class ConvertDSPNodesToFixedPointTransformation : public model::Transformation
+    {
+    public:
+        /// <summary> Replace the DSP nodes with their fixed-point versions. </summary>
+        model::Submodel Transform(const model::Submodel& submodel, model::ModelTransformer& transformer, const model::TransformContext& context) const override;
+
+        /// <summary> Returns the ID for this transformation </summary>
+        std::string GetRuntimeTypeName() const override { return "ConvertDSPNodesToFixedPointTransformation"; }
+    };
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ConvolutionMethodCache.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelOptimizerOptions.h>
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A table of the fastest convolution method found for a given convolution problem (layer shape, element type and
+    /// target device). Used by `SetConvolutionMethodTransformation` to remember the results of auto-tuning between runs.
+    /// The on-disk format is a text file with one `<key> <method>` entry per line.
+    /// </summary>
+    class ConvolutionMethodCache
+    {
+    public:
+        /// <summary> Looks up the method stored for a key. </summary>
+        ///
+        /// <param name="key"> The key describing the convolution problem. </param>
+        /// <param name="method"> Receives the stored method, if there is one. </param>
+        ///
+        /// <returns> `true` if the cache has an entry for the key. </returns>
+        bool TryGetMethod(const std::string& key, model::PreferredConvolutionMethod& method) const;
+
+        /// <summary> Stores the method for a key, replacing any existing entry. </summary>
+        ///
+        /// <param name="key"> The key describing the convolution problem. Must not contain whitespace. </param>
+        /// <param name="method"> The method to store. </param>
+        void SetMethod(const std::string& key, model::PreferredConvolutionMethod method);
+
+        /// <summary> Returns `true` if entries have been added since the cache was created or loaded. </summary>
+        bool IsModified() const { return _modified; }
+
+        /// <summary> Adds the entries read from a stream to the cache. </summary>
+        ///
+        /// <param name="stream"> The stream to read from. </param>
+        void Read(std::istream& stream);
+
+        /// <summary> Writes all the entries of the cache to a stream. </summary>
+        ///
+        /// <param name="stream"> The stream to write to. </param>
+        void Write(std::ostream& stream) const;
+
+        /// <summary> Adds the entries stored in a file to the cache. Does nothing if the file doesn't exist. </summary>
+        ///
+        /// <param name="filename"> The path of the cache file. </param>
+        void Load(const std::string& filename);
+
+        /// <summary> Writes all the entries of the cache to a file. </summary>
+        ///
+        /// <param name="filename"> The path of the cache file. </param>
+        void Save(const std::string& filename);
+
+    private:
+        std::map<std::string, model::PreferredConvolutionMethod> _methods;
+        bool _modified = false;
+    };
+} // namespace passes
+} // namespace ell
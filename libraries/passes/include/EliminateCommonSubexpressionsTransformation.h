@@ -0,0 +1,38 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     EliminateCommonSubexpressionsTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that merges nodes that compute the same thing, like the duplicate ConstantNodes, reorders of
+    /// the same tensor, and repeated preprocessing that importers and model composition leave behind. Two nodes are
+    /// the same if they have the same type, parameters, metadata and compiler options (see `model::GetNodeContentKey`)
+    /// and read the same ports, so chains of duplicates merge from the inputs down. Only ConstantNodes and nodes whose
+    /// output is a pure function of their inputs are merged. Enabled by the "eliminateCommonSubexpressions" optimizer
+    /// option.
+    /// </summary>
+    class EliminateCommonSubexpressionsTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "EliminateCommonSubexpressionsTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
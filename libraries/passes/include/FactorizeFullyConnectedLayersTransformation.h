@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FactorizeFullyConnectedLayersTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Node.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+#include <math/include/Matrix.h>
+
+#include <functional>
+#include <vector>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that replaces large fully-connected layers by two smaller ones, whose weights are the factors
+    /// of a truncated singular value decomposition of the original weights. The rank is the smallest one whose
+    /// relative approximation error is within the `factorizeFullyConnectedTolerance` optimizer option (0 disables the
+    /// transformation), and a layer is only replaced if that at least halves its number of weights. The error is that
+    /// of the layer's output on a set of calibration inputs, if given, or else that of the weights.
+    /// </summary>
+    class FactorizeFullyConnectedLayersTransformation : public ell::model::Transformation
+    {
+    public:
+        /// <summary> A function that returns the inputs a fully-connected layer node sees on a calibration set, or an
+        /// empty list to measure the error of the weights instead. </summary>
+        using CalibrationFunction = std::function<std::vector<std::vector<double>>(const ell::model::Node& node)>;
+
+        /// <summary> Constructor that reads the tolerance from the optimizer options, and measures the error of the weights. </summary>
+        FactorizeFullyConnectedLayersTransformation() = default;
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="tolerance"> The largest relative error allowed. </param>
+        /// <param name="getCalibrationInputs"> The function that returns the calibration inputs of each layer. </param>
+        FactorizeFullyConnectedLayersTransformation(double tolerance, CalibrationFunction getCalibrationInputs);
+
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "FactorizeFullyConnectedLayersTransformation";
+        }
+
+        /// <summary> Factors an m x n matrix of weights into an m x r and an r x n matrix, with the smallest rank r
+        /// whose relative error is within the tolerance. </summary>
+        ///
+        /// <param name="weights"> The weights to factor. </param>
+        /// <param name="tolerance"> The largest relative error allowed. </param>
+        /// <param name="calibrationInputs"> The inputs to measure the error of the product on, or empty to measure the error of the weights. </param>
+        /// <param name="inputFactor"> Set to the r x n factor, which is applied first. </param>
+        /// <param name="outputFactor"> Set to the m x r factor, which is applied second. </param>
+        ///
+        /// <returns> true if the factors have at most half as many entries as the weights, else false (and the factors are left unchanged). </returns>
+        /// @{
+        static bool FactorizeWeights(math::ConstRowMatrixReference<float> weights, double tolerance, const std::vector<std::vector<double>>& calibrationInputs, math::RowMatrix<float>& inputFactor, math::RowMatrix<float>& outputFactor);
+        static bool FactorizeWeights(math::ConstRowMatrixReference<double> weights, double tolerance, const std::vector<std::vector<double>>& calibrationInputs, math::RowMatrix<double>& inputFactor, math::RowMatrix<double>& outputFactor);
+        /// @}
+
+    private:
+        double _tolerance = 0;
+        CalibrationFunction _getCalibrationInputs;
+    };
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,32 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FlattenForestsTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that replaces SimpleForestPredictorNode nodes with FlatForestPredictorNode nodes, which compile to
+    /// a branchless walk over arrays instead of one branch per tree node. Enabled by the "flattenForests" optimizer option.
+    /// Nodes whose edge indicator vector is used are left alone, because the flattened forest doesn't compute it.
+    /// </summary>
+    class FlattenForestsTransformation : public model::Transformation
+    {
+    public:
+        /// <summary> Replace forest nodes with their flattened versions. </summary>
+        model::Submodel Transform(const model::Submodel& submodel, model::ModelTransformer& transformer, const model::TransformContext& context) const override;
+
+        /// <summary> Returns the ID for this transformation </summary>
+        std::string GetRuntimeTypeName() const override { return "FlattenForestsTransformation"; }
+    };
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,42 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FoldConstantsTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Node.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary> Indicates if a node's outputs are a function of its inputs alone: no state that changes from one
+    /// call to the next, and no callbacks. </summary>
+    bool IsPureNode(const ell::model::Node& node);
+
+    /// <summary>
+    /// A transformation that evaluates the parts of a model that only depend on constants, like the reorders and
+    /// arithmetic that importers apply to weights, and replaces each of them with a single ConstantNode holding the
+    /// result of the reference `Compute()`. Constants that were only read by the folded nodes are dropped. Only nodes
+    /// whose output is a pure function of their inputs are folded, and only when that doesn't make the constants
+    /// much bigger, as with broadcasting a scalar. Enabled by the "foldConstants" optimizer option.
+    /// </summary>
+    class FoldConstantsTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "FoldConstantsTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
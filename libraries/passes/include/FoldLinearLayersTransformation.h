@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FoldLinearLayersTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that folds the BatchNormalization, Scaling and Bias layers following a convolutional or
+    /// fully-connected layer into that layer: the per-channel scales are multiplied into the filter weights, and the
+    /// per-channel offsets are combined into a single Bias layer, so a whole chain of layers becomes one pass over the
+    /// activations. Enabled by the "fuseLinearFunctionNodes" optimizer option, like the fusion of linear function nodes.
+    /// </summary>
+    class FoldLinearLayersTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "FoldLinearLayersTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
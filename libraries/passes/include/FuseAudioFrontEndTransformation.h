@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseAudioFrontEndTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that replaces the window, FFT, power spectrum, filter bank, log and DCT nodes of an audio
+    /// featurizer by a single AudioFrontEndNode, which computes them in one kernel. The window, power spectrum, log
+    /// and DCT are optional; the chain must contain an FFTNode followed by a FilterBankNode. Enabled by the
+    /// "fuseAudioFrontEnd" option.
+    /// </summary>
+    class FuseAudioFrontEndTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "FuseAudioFrontEndTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
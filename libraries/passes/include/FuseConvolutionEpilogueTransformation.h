@@ -0,0 +1,35 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseConvolutionEpilogueTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that folds the per-channel bias and activation function nodes following a convolution or
+    /// matrix multiplication into that node's OutputEpilogue, so they're applied as the output is computed instead
+    /// of in separate passes over it.
+    /// </summary>
+    class FuseConvolutionEpilogueTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "FuseConvolutionEpilogueTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
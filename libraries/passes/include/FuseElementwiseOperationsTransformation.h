@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseElementwiseOperationsTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that replaces chains of elementwise nodes (unary activation functions, linear functions and
+    /// arithmetic binary operations) with a single FusedElementwiseNode, so the intermediate results of the chain
+    /// are never written to memory. Enabled by the "fuseElementwiseNodes" optimizer option.
+    /// </summary>
+    class FuseElementwiseOperationsTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "FuseElementwiseOperationsTransformation";
+        }
+
+    private:
+    };
+} // namespace passes
+} // namespace ell
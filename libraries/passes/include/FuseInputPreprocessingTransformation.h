@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseInputPreprocessingTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that replaces the nodes that prepare a model's raw input --- a type cast, a per-channel linear
+    /// function with constant coefficients (scaling and mean subtraction), and a reordering into the layout the next
+    /// node expects --- with a single InputPreprocessingNode, which does all three in one pass over the data. The chain
+    /// needs the linear function and at least one of the other two nodes. Enabled by the "fuseInputPreprocessing"
+    /// optimizer option.
+    /// </summary>
+    class FuseInputPreprocessingTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "FuseInputPreprocessingTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
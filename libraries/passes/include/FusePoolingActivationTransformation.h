@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FusePoolingActivationTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that folds a ReLU activation into the max or mean PoolingLayerNode reading its output, which
+    /// then pools the rectified input without a separate pass over it. ReLUs that follow a convolution are usually
+    /// already part of its epilogue, so this catches the ones that aren't, like the ReLU after a residual addition.
+    /// Enabled by the "fusePoolingActivations" option.
+    /// </summary>
+    class FusePoolingActivationTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "FusePoolingActivationTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
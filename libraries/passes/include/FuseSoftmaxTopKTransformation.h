@@ -0,0 +1,35 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseSoftmaxTopKTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that replaces a SoftmaxLayerNode whose only dependent is a TopKNode by a TopKNode that reads
+    /// the logits and normalizes only the k probabilities it outputs. The order of the probabilities is the order of
+    /// the logits, so the selection is the same. Enabled by the "fuseSoftmaxTopK" option.
+    /// </summary>
+    class FuseSoftmaxTopKTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "FuseSoftmaxTopKTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
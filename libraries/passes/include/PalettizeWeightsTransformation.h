@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PalettizeWeightsTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+#include <vector>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that compresses the constant weights of matrix multiplications, like the ones fully-connected
+    /// and unrolled convolutional layers refine to, by sharing weights: the weights of each layer are clustered with
+    /// k-means into a codebook of 16 or 256 values, and replaced by a PalettizedMatrixMultiplyNode that stores a 4- or
+    /// 8-bit index into the codebook for each weight. The `palettizeWeightsBits` optimizer option sets the number of
+    /// bits of the indices, 4 or 8, and 0 (the default) disables the transformation, since it changes the weights.
+    /// </summary>
+    class PalettizeWeightsTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "PalettizeWeightsTransformation";
+        }
+    };
+
+    /// <summary> Clusters values into a codebook of at most `maxCodebookSize` values with k-means. </summary>
+    ///
+    /// <param name="values"> The values. </param>
+    /// <param name="maxCodebookSize"> The largest number of values in the codebook. If there are no more distinct values than this, they're kept exactly. </param>
+    /// <param name="codebook"> Receives the codebook, in increasing order. </param>
+    /// <param name="indices"> Receives the index of the codebook entry closest to each value. </param>
+    void PalettizeValues(const std::vector<double>& values, int maxCodebookSize, std::vector<double>& codebook, std::vector<int>& indices);
+} // namespace passes
+} // namespace ell
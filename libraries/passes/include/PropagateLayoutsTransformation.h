@@ -0,0 +1,38 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PropagateLayoutsTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that chooses the memory layout of the tensors computed by layout-agnostic nodes so as to
+    /// minimize the cost of the `ReorderDataNode`s around them. Connected groups of elementwise unary operations are
+    /// given one layout each: the one that needs the fewest elements reordered, given the layouts their inputs are
+    /// produced in and the layouts their consumers ask for. Chains of reorders are replaced by at most one reorder at
+    /// each boundary, and a tensor reordered to the same layout for several consumers is reordered only once.
+    /// Enabled by the "propagateLayouts" optimizer option.
+    /// </summary>
+    class PropagateLayoutsTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "PropagateLayoutsTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     QuantizeLayersTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/Map.h>
+#include <model/include/Transformation.h>
+
+#include <vector>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that replaces ConvolutionalLayerNode, FullyConnectedLayerNode, LSTMNode and GRUNode nodes with
+    /// versions that compute with 8-bit integers (QuantizedConvolutionalLayerNode, QuantizedFullyConnectedLayerNode and
+    /// QuantizedRecurrentLayerNode). Enabled by the "quantizeLayers" optimizer option. Only nodes that have been calibrated
+    /// with `CalibrateQuantization` are replaced, and recurrent nodes only if their weights are constant and they use the
+    /// usual sigmoid and tanh activations.
+    /// </summary>
+    class QuantizeLayersTransformation : public model::Transformation
+    {
+    public:
+        /// <summary> Replace calibrated layer nodes with their quantized versions. </summary>
+        model::Submodel Transform(const model::Submodel& submodel, model::ModelTransformer& transformer, const model::TransformContext& context) const override;
+
+        /// <summary> Returns the ID for this transformation </summary>
+        std::string GetRuntimeTypeName() const override { return "QuantizeLayersTransformation"; }
+    };
+
+    /// <summary>
+    /// Runs a set of sample inputs through a map and records, in the metadata of each ConvolutionalLayerNode,
+    /// FullyConnectedLayerNode, LSTMNode and GRUNode, the quantization step that covers the largest input value the node
+    /// saw, and for the recurrent nodes also the one that covers the largest hidden state value. The samples go through
+    /// the map in order, so for a model with recurrent nodes they should be a sequence.
+    /// </summary>
+    ///
+    /// <param name="map"> The map to calibrate. It must have a single input. </param>
+    /// <param name="samples"> The sample inputs, which should be representative of the data the map will be used on. </param>
+    template <typename InputType>
+    void CalibrateQuantization(model::Map& map, const std::vector<std::vector<InputType>>& samples);
+} // namespace passes
+} // namespace ell
@@ -14,7 +14,10 @@ namespace ell
 {
 namespace passes
 {
-    /// <summary> A transformation that sets the convolution algorithm for a `ConvolutionalLayerNode`. </summary>
+    /// <summary>
+    /// A transformation that sets the convolution algorithm for a `ConvolutionalLayerNode`. When no method is requested,
+    /// depthwise and 1x1 convolutions are replaced by a `DepthwiseConvolutionNode` or `PointwiseConvolutionNode`.
+    /// </summary>
     class SetConvolutionMethodTransformation : public model::Transformation
     {
     public:
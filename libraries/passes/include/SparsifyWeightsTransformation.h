@@ -0,0 +1,36 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SparsifyWeightsTransformation.h (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/ModelTransformer.h>
+#include <model/include/Submodel.h>
+#include <model/include/Transformation.h>
+
+namespace ell
+{
+namespace passes
+{
+    /// <summary>
+    /// A transformation that replaces the matrix multiplications of pruned layers, whose constant weights are mostly
+    /// zero, with SparseMatrixMultiplyNodes that only store and multiply the nonzero blocks of the weights. A node is
+    /// replaced if the fraction of its weights that are nonzero is below the `sparseWeightsDensity` optimizer option,
+    /// using the block shape that stores the fewest values.
+    /// </summary>
+    class SparsifyWeightsTransformation : public ell::model::Transformation
+    {
+    public:
+        ell::model::Submodel Transform(const ell::model::Submodel& submodel, ell::model::ModelTransformer& transformer, const ell::model::TransformContext& context) const override;
+
+        std::string GetRuntimeTypeName() const override
+        {
+            return "SparsifyWeightsTransformation";
+        }
+    };
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ConvertDSPNodesToFixedPointTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ConvertDSPNodesToFixedPointTransformation.h"
+
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+
+#include <nodes/include/DCTNode.h>
+#include <nodes/include/FFTNode.h>
+#include <nodes/include/FilterBankNode.h>
+#include <nodes/include/FixedPointDSPNodes.h>
+#include <nodes/include/HammingWindowNode.h>
+#include <nodes/include/IIRFilterNode.h>
+
+#include <dsp/include/FixedPoint.h>
+#include <dsp/include/WindowFunctions.h>
+
+#include <utilities/include/Logger.h>
+
+namespace ell
+{
+namespace passes
+{
+    using namespace model;
+    using namespace utilities::logging;
+
+    namespace
+    {
+        std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+        {
+            std::vector<const OutputPortBase*> result;
+            for (auto input : inputs)
+            {
+                result.push_back(&input->GetReferencedPort());
+            }
+            return result;
+        }
+
+        template <typename NodeType, typename FixedPointNodeType, typename... Args>
+        void ReplaceNode(const NodeType& node, ModelTransformer& transformer, Args&&... args)
+        {
+            const auto& newInput = transformer.GetCorrespondingInputs(node.input);
+            auto newNode = transformer.AddNode<FixedPointNodeType>(newInput, std::forward<Args>(args)...);
+            newNode->GetMetadata() = node.GetMetadata();
+            transformer.MapNodeOutput(node.output, newNode->output);
+            Log() << "Converted " << node.GetRuntimeTypeName() << " " << node.GetId() << " to fixed point" << std::endl;
+        }
+
+        template <typename ValueType>
+        bool TryConvertNode(const Node& node, const dsp::FixedPointFormat& format, ModelTransformer& transformer)
+        {
+            if (auto windowNode = dynamic_cast<const nodes::HammingWindowNode<ValueType>*>(&node))
+            {
+                ReplaceNode<nodes::HammingWindowNode<ValueType>, nodes::FixedPointWindowNode<ValueType>>(*windowNode, transformer, dsp::HammingWindow<ValueType>(windowNode->input.Size()), format);
+                return true;
+            }
+            if (auto fftNode = dynamic_cast<const nodes::FFTNode<ValueType>*>(&node))
+            {
+                ReplaceNode<nodes::FFTNode<ValueType>, nodes::FixedPointFFTNode<ValueType>>(*fftNode, transformer, fftNode->GetFFTSize(), format);
+                return true;
+            }
+            if (auto filterBankNode = dynamic_cast<const nodes::FilterBankNode<ValueType>*>(&node))
+            {
+                ReplaceNode<nodes::FilterBankNode<ValueType>, nodes::FixedPointFilterBankNode<ValueType>>(*filterBankNode, transformer, filterBankNode->GetFilters(), format);
+                return true;
+            }
+            if (auto iirFilterNode = dynamic_cast<const nodes::IIRFilterNode<ValueType>*>(&node))
+            {
+                const auto& filter = iirFilterNode->GetFilter();
+                ReplaceNode<nodes::IIRFilterNode<ValueType>, nodes::FixedPointIIRFilterNode<ValueType>>(*iirFilterNode, transformer, filter.GetFeedforwardCoefficients(), filter.GetRecursiveCoefficients(), format);
+                return true;
+            }
+            if (auto dctNode = dynamic_cast<const nodes::DCTNode<ValueType>*>(&node))
+            {
+                ReplaceNode<nodes::DCTNode<ValueType>, nodes::FixedPointDCTNode<ValueType>>(*dctNode, transformer, dctNode->output.Size(), format);
+                return true;
+            }
+            return false;
+        }
+    } // namespace
+
+    //
+    // ConvertDSPNodesToFixedPointTransformation methods
+    //
+    Submodel ConvertDSPNodesToFixedPointTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        auto result = transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [compiler](const Node& node, ModelTransformer& transformer) {
+            auto formatName = compiler->GetModelOptimizerOptions(node).GetEntry<std::string>("fixedPointDSP", "");
+            if (!formatName.empty())
+            {
+                auto format = dsp::FixedPointFormat::Parse(formatName);
+                if (TryConvertNode<float>(node, format, transformer) || TryConvertNode<double>(node, format, transformer))
+                {
+                    return;
+                }
+            }
+            transformer.CopyNode(node);
+        });
+
+        return result;
+    }
+} // namespace passes
+} // namespace ell
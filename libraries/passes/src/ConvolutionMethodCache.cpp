@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ConvolutionMethodCache.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ConvolutionMethodCache.h"
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
+#include <utilities/include/Logger.h>
+
+#include <sstream>
+
+namespace ell
+{
+namespace passes
+{
+    using namespace utilities::logging;
+
+    bool ConvolutionMethodCache::TryGetMethod(const std::string& key, model::PreferredConvolutionMethod& method) const
+    {
+        auto iter = _methods.find(key);
+        if (iter == _methods.end())
+        {
+            return false;
+        }
+
+        method = iter->second;
+        return true;
+    }
+
+    void ConvolutionMethodCache::SetMethod(const std::string& key, model::PreferredConvolutionMethod method)
+    {
+        _methods[key] = method;
+        _modified = true;
+    }
+
+    void ConvolutionMethodCache::Read(std::istream& stream)
+    {
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            std::istringstream lineStream(line);
+            std::string key;
+            std::string methodName;
+            if (!(lineStream >> key >> methodName))
+            {
+                continue; // skip blank lines
+            }
+
+            try
+            {
+                _methods[key] = utilities::FromString<model::PreferredConvolutionMethod>(methodName);
+            }
+            catch (const utilities::InputException&)
+            {
+                Log() << "Ignoring unknown convolution method '" << methodName << "' in convolution method cache" << std::endl;
+            }
+        }
+    }
+
+    void ConvolutionMethodCache::Write(std::ostream& stream) const
+    {
+        for (const auto& entry : _methods)
+        {
+            stream << entry.first << " " << model::ToString(entry.second) << "\n";
+        }
+    }
+
+    void ConvolutionMethodCache::Load(const std::string& filename)
+    {
+        if (!utilities::FileExists(filename))
+        {
+            return;
+        }
+
+        auto stream = utilities::OpenIfstream(filename);
+        Read(stream);
+    }
+
+    void ConvolutionMethodCache::Save(const std::string& filename)
+    {
+        auto stream = utilities::OpenOfstream(filename);
+        Write(stream);
+        _modified = false;
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     EliminateCommonSubexpressionsTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "EliminateCommonSubexpressionsTransformation.h"
+#include "FoldConstantsTransformation.h"
+
+#include <model/include/MapCompiler.h>
+#include <model/include/RefinementCache.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return utilities::TransformVector(inputs.begin(), inputs.end(), [](auto input) { return &input->GetReferencedPort(); });
+}
+
+bool CanMerge(const Node& node, const MapCompiler* compiler)
+{
+    auto typeName = node.GetRuntimeTypeName();
+    bool isConstant = typeName.substr(0, typeName.find('<')) == "ConstantNode";
+    if ((!isConstant && !passes::IsPureNode(node)) || node.GetOutputPorts().empty())
+    {
+        return false;
+    }
+    return !compiler || compiler->GetModelOptimizerOptions(node).GetEntry<bool>("eliminateCommonSubexpressions", true);
+}
+
+// The node's content, plus the ports it reads in the new model, which are the same for duplicates whose inputs were merged
+std::string GetNodeKey(const Node& node, const ModelTransformer& transformer, const TransformContext& context)
+{
+    std::stringstream key;
+    key << GetNodeContentKey(node, context);
+    for (auto input : node.GetInputPorts())
+    {
+        key << ":" << &transformer.GetCorrespondingOutputs(input->GetReferencedPort());
+    }
+    return key.str();
+}
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    Submodel EliminateCommonSubexpressionsTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        bool hasDuplicates = false;
+        {
+            // Check for nodes with the same content before copying anything: their inputs may differ, but if no two
+            // nodes have the same content, there's nothing to merge
+            std::unordered_map<std::string, int> contentCounts;
+            submodel.Visit([&](const Node& node) {
+                if (!hasDuplicates && CanMerge(node, compiler))
+                {
+                    hasDuplicates = ++contentCounts[GetNodeContentKey(node, context)] > 1;
+                }
+            });
+        }
+        if (!hasDuplicates)
+        {
+            return submodel;
+        }
+
+        std::unordered_map<std::string, const Node*> firstNodes;
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [&](const Node& node, ModelTransformer& transformer) {
+            if (!CanMerge(node, compiler))
+            {
+                transformer.CopyNode(node);
+                return;
+            }
+
+            auto [it, isFirst] = firstNodes.emplace(GetNodeKey(node, transformer, context), &node);
+            if (isFirst)
+            {
+                transformer.CopyNode(node);
+                return;
+            }
+
+            const auto& firstOutputs = it->second->GetOutputPorts();
+            const auto& outputs = node.GetOutputPorts();
+            Log() << "Merging " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "] into node " << it->second->GetId().ToString() << EOL;
+            for (size_t index = 0; index < outputs.size(); ++index)
+            {
+                transformer.MapNodeOutput(*outputs[index], transformer.GetCorrespondingOutputs(*firstOutputs[index]));
+            }
+        });
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,372 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FactorizeFullyConnectedLayersTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FactorizeFullyConnectedLayersTransformation.h"
+
+#include <model/include/MapCompiler.h>
+
+#include <nodes/include/FullyConnectedLayerNode.h>
+
+#include <predictors/neural/include/FullyConnectedLayer.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+double GetTolerance(const Node& node, const MapCompiler& compiler)
+{
+    return compiler.GetModelOptimizerOptions(node).GetEntry<double>("factorizeFullyConnectedTolerance", 0.0);
+}
+
+const int c_maxJacobiSweeps = 30;
+
+// The eigenvalues of a symmetric matrix, in decreasing order, and the corresponding eigenvectors
+struct EigenDecomposition
+{
+    std::vector<double> values;
+    std::vector<std::vector<double>> vectors;
+};
+
+// Diagonalizes a symmetric n x n (row-major) matrix with cyclic Jacobi rotations, which is slow for large matrices,
+// but simple and accurate, and only runs once per layer at compile time
+EigenDecomposition GetSymmetricEigenDecomposition(std::vector<double> a, int n)
+{
+    // The rows of `v` accumulate the rotations, and end up as the eigenvectors
+    std::vector<double> v(n * n, 0.0);
+    for (int i = 0; i < n; ++i)
+    {
+        v[i * n + i] = 1;
+    }
+
+    auto rotate = [n](std::vector<double>& matrix, int p, int q, double c, double s) {
+        for (int k = 0; k < n; ++k)
+        {
+            auto pk = matrix[p * n + k];
+            auto qk = matrix[q * n + k];
+            matrix[p * n + k] = c * pk - s * qk;
+            matrix[q * n + k] = s * pk + c * qk;
+        }
+    };
+
+    // The sum of squares of all the entries doesn't change, so the off-diagonal part is compared to it
+    auto total = std::inner_product(a.begin(), a.end(), a.begin(), 0.0);
+    for (int sweep = 0; sweep < c_maxJacobiSweeps; ++sweep)
+    {
+        double offDiagonal = 0;
+        for (int p = 0; p < n; ++p)
+        {
+            for (int q = p + 1; q < n; ++q)
+            {
+                offDiagonal += a[p * n + q] * a[p * n + q];
+            }
+        }
+        if (offDiagonal <= 1e-24 * total)
+        {
+            break;
+        }
+
+        for (int p = 0; p < n; ++p)
+        {
+            for (int q = p + 1; q < n; ++q)
+            {
+                auto apq = a[p * n + q];
+                if (apq == 0)
+                {
+                    continue;
+                }
+
+                // The rotation that zeroes a[p, q] is applied to the columns, then the rows, of `a`
+                auto theta = (a[q * n + q] - a[p * n + p]) / (2 * apq);
+                auto t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1));
+                auto c = 1 / std::sqrt(t * t + 1);
+                auto s = t * c;
+                for (int k = 0; k < n; ++k)
+                {
+                    auto kp = a[k * n + p];
+                    auto kq = a[k * n + q];
+                    a[k * n + p] = c * kp - s * kq;
+                    a[k * n + q] = s * kp + c * kq;
+                }
+                rotate(a, p, q, c, s);
+                rotate(v, p, q, c, s);
+            }
+        }
+    }
+
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&a, n](int i, int j) { return a[i * n + i] > a[j * n + j]; });
+
+    EigenDecomposition result;
+    for (auto i : order)
+    {
+        result.values.push_back(a[i * n + i]);
+        result.vectors.emplace_back(v.begin() + i * n, v.begin() + (i + 1) * n);
+    }
+    return result;
+}
+
+double Dot(const std::vector<double>& a, const std::vector<double>& b)
+{
+    return std::inner_product(a.begin(), a.end(), b.begin(), 0.0);
+}
+
+template <typename ValueType>
+bool FactorizeWeights(math::ConstRowMatrixReference<ValueType> weights, double tolerance, const std::vector<std::vector<double>>& calibrationInputs, math::RowMatrix<ValueType>& inputFactor, math::RowMatrix<ValueType>& outputFactor)
+{
+    const auto m = static_cast<int>(weights.NumRows());
+    const auto n = static_cast<int>(weights.NumColumns());
+    for (const auto& input : calibrationInputs)
+    {
+        if (static_cast<int>(input.size()) != n)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "Calibration input size doesn't match the number of columns of the weights");
+        }
+    }
+
+    // Factors of rank r have r * (m + n) entries, which must be at most half of the m * n weights
+    const auto maxRank = static_cast<int>(static_cast<int64_t>(m) * n / (2 * (static_cast<int64_t>(m) + n)));
+    if (tolerance <= 0 || maxRank < 1)
+    {
+        return false;
+    }
+
+    // W = U * S * V', where the columns of V are the eigenvectors of W' * W and the columns of U are those of W * W',
+    // both with the squared singular values as eigenvalues; the smaller of the two is decomposed
+    const bool decomposeRows = m < n;
+    const int size = std::min(m, n);
+    std::vector<double> gram(size * size, 0.0);
+    for (int i = 0; i < size; ++i)
+    {
+        for (int j = i; j < size; ++j)
+        {
+            double sum = 0;
+            for (int k = 0; k < std::max(m, n); ++k)
+            {
+                sum += decomposeRows ? static_cast<double>(weights(i, k)) * weights(j, k) : static_cast<double>(weights(k, i)) * weights(k, j);
+            }
+            gram[i * size + j] = sum;
+            gram[j * size + i] = sum;
+        }
+    }
+    auto eigen = GetSymmetricEigenDecomposition(std::move(gram), size);
+
+    // Gets the singular vectors u and v of a component, scaled so that u * v' is its term of the sum
+    auto getComponent = [&](int component, std::vector<double>& u, std::vector<double>& v) {
+        auto singularValue = std::sqrt(std::max(eigen.values[component], 0.0));
+        auto& known = decomposeRows ? u : v;
+        auto& other = decomposeRows ? v : u;
+        known = eigen.vectors[component];
+        other.assign(decomposeRows ? n : m, 0.0);
+        for (int i = 0; i < m; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                if (decomposeRows)
+                {
+                    other[j] += weights(i, j) * known[i] / singularValue;
+                }
+                else
+                {
+                    other[i] += weights(i, j) * known[j] / singularValue;
+                }
+            }
+        }
+        auto scale = std::sqrt(singularValue);
+        for (auto& x : u)
+        {
+            x *= scale;
+        }
+        for (auto& x : v)
+        {
+            x *= scale;
+        }
+    };
+
+    // The squared error of dropping component i is the sum of the squares of its output, (s_i * v_i' * x)^2, over the
+    // calibration inputs x, or s_i^2 without them, since the u_i are orthonormal
+    const auto minEigenvalue = std::max(eigen.values[0], 0.0) * 1e-12;
+    double total = 0;
+    if (calibrationInputs.empty())
+    {
+        total = std::accumulate(eigen.values.begin(), eigen.values.end(), 0.0, [](double sum, double value) { return sum + std::max(value, 0.0); });
+    }
+    else
+    {
+        for (const auto& input : calibrationInputs)
+        {
+            for (int i = 0; i < m; ++i)
+            {
+                double output = 0;
+                for (int j = 0; j < n; ++j)
+                {
+                    output += weights(i, j) * input[j];
+                }
+                total += output * output;
+            }
+        }
+    }
+    if (total <= 0)
+    {
+        return false;
+    }
+
+    std::vector<std::vector<double>> us;
+    std::vector<std::vector<double>> vs;
+    double kept = 0;
+    for (int component = 0; component < maxRank && eigen.values[component] > minEigenvalue; ++component)
+    {
+        std::vector<double> u, v;
+        getComponent(component, u, v);
+        if (calibrationInputs.empty())
+        {
+            kept += eigen.values[component];
+        }
+        else
+        {
+            // v is scaled by sqrt(s) and u has norm sqrt(s), so s * v_i' * x is |u| * (v' * x)
+            auto uNormSquared = Dot(u, u);
+            for (const auto& input : calibrationInputs)
+            {
+                auto projection = Dot(v, input);
+                kept += uNormSquared * projection * projection;
+            }
+        }
+        us.push_back(std::move(u));
+        vs.push_back(std::move(v));
+
+        if (std::max(total - kept, 0.0) <= tolerance * tolerance * total)
+        {
+            const int rank = component + 1;
+            inputFactor = math::RowMatrix<ValueType>(rank, n);
+            outputFactor = math::RowMatrix<ValueType>(m, rank);
+            for (int r = 0; r < rank; ++r)
+            {
+                for (int j = 0; j < n; ++j)
+                {
+                    inputFactor(r, j) = static_cast<ValueType>(vs[r][j]);
+                }
+                for (int i = 0; i < m; ++i)
+                {
+                    outputFactor(i, r) = static_cast<ValueType>(us[r][i]);
+                }
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename ValueType>
+bool TryFactorizeNode(const Node& node, double tolerance, const passes::FactorizeFullyConnectedLayersTransformation::CalibrationFunction& getCalibrationInputs, ModelTransformer& transformer)
+{
+    using LayerType = predictors::neural::FullyConnectedLayer<ValueType>;
+    using LayerParameters = typename predictors::neural::Layer<ValueType>::LayerParameters;
+
+    auto fullyConnectedNode = dynamic_cast<const nodes::FullyConnectedLayerNode<ValueType>*>(&node);
+    if (fullyConnectedNode == nullptr)
+    {
+        return false;
+    }
+
+    auto calibrationInputs = getCalibrationInputs ? getCalibrationInputs(node) : std::vector<std::vector<double>>{};
+    math::RowMatrix<ValueType> inputFactor(0, 0);
+    math::RowMatrix<ValueType> outputFactor(0, 0);
+    if (!FactorizeWeights<ValueType>(fullyConnectedNode->GetLayer().GetWeights(), tolerance, calibrationInputs, inputFactor, outputFactor))
+    {
+        return false;
+    }
+
+    auto rank = inputFactor.NumRows();
+    Log() << "Factoring " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "] into layers of rank " << rank << EOL;
+
+    // The factors are fully-connected layers with a 1 x 1 x rank result between them
+    const auto layerParameters = fullyConnectedNode->GetLayerParameters();
+    math::TensorShape factoredShape{ 1, 1, rank };
+    LayerParameters inputParameters{ layerParameters.input, layerParameters.inputPaddingParameters, factoredShape, predictors::neural::NoPadding() };
+    auto inputWeights = inputFactor.GetConstReference();
+    LayerType inputLayer(inputParameters, inputWeights);
+    auto inputNode = transformer.AddNode<nodes::FullyConnectedLayerNode<ValueType>>(transformer.GetCorrespondingInputs(fullyConnectedNode->input), inputLayer);
+
+    LayerParameters outputParameters{ factoredShape, predictors::neural::NoPadding(), layerParameters.outputShape, layerParameters.outputPaddingParameters };
+    auto outputWeights = outputFactor.GetConstReference();
+    LayerType outputLayer(outputParameters, outputWeights);
+    auto outputNode = transformer.AddNode<nodes::FullyConnectedLayerNode<ValueType>>(inputNode->output, outputLayer);
+
+    for (auto newNode : std::vector<Node*>{ inputNode, outputNode })
+    {
+        newNode->GetMetadata().SetEntry("factorizedFrom", node.GetId().ToString());
+    }
+    transformer.MapNodeOutput(fullyConnectedNode->output, outputNode->output);
+    return true;
+}
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    FactorizeFullyConnectedLayersTransformation::FactorizeFullyConnectedLayersTransformation(double tolerance, CalibrationFunction getCalibrationInputs) :
+        _tolerance(tolerance),
+        _getCalibrationInputs(std::move(getCalibrationInputs))
+    {
+    }
+
+    Submodel FactorizeFullyConnectedLayersTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler && _tolerance <= 0)
+        {
+            return submodel;
+        }
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [this, compiler](const Node& node, ModelTransformer& transformer) {
+            auto tolerance = _tolerance > 0 ? _tolerance : GetTolerance(node, *compiler);
+            if (tolerance > 0 && (TryFactorizeNode<float>(node, tolerance, _getCalibrationInputs, transformer) || TryFactorizeNode<double>(node, tolerance, _getCalibrationInputs, transformer)))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        });
+    }
+
+    bool FactorizeFullyConnectedLayersTransformation::FactorizeWeights(math::ConstRowMatrixReference<float> weights, double tolerance, const std::vector<std::vector<double>>& calibrationInputs, math::RowMatrix<float>& inputFactor, math::RowMatrix<float>& outputFactor)
+    {
+        return ::FactorizeWeights(weights, tolerance, calibrationInputs, inputFactor, outputFactor);
+    }
+
+    bool FactorizeFullyConnectedLayersTransformation::FactorizeWeights(math::ConstRowMatrixReference<double> weights, double tolerance, const std::vector<std::vector<double>>& calibrationInputs, math::RowMatrix<double>& inputFactor, math::RowMatrix<double>& outputFactor)
+    {
+        return ::FactorizeWeights(weights, tolerance, calibrationInputs, inputFactor, outputFactor);
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FlattenForestsTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FlattenForestsTransformation.h"
+
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+
+#include <nodes/include/FlatForestPredictorNode.h>
+#include <nodes/include/ForestPredictorNode.h>
+
+#include <utilities/include/Logger.h>
+
+namespace ell
+{
+namespace passes
+{
+    using namespace model;
+    using namespace utilities::logging;
+
+    namespace
+    {
+        std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+        {
+            std::vector<const OutputPortBase*> result;
+            for (auto input : inputs)
+            {
+                result.push_back(&input->GetReferencedPort());
+            }
+            return result;
+        }
+
+        bool TryFlattenForest(const Node& node, ModelTransformer& transformer)
+        {
+            auto thisNode = dynamic_cast<const nodes::SimpleForestPredictorNode*>(&node);
+            if (thisNode == nullptr || thisNode->edgeIndicatorVector.IsReferenced())
+            {
+                return false;
+            }
+
+            const auto& newInput = transformer.GetCorrespondingInputs(thisNode->input);
+            auto newNode = transformer.AddNode<nodes::FlatForestPredictorNode>(newInput, thisNode->GetForest());
+            newNode->GetMetadata() = node.GetMetadata();
+            transformer.MapNodeOutput(thisNode->output, newNode->output);
+            transformer.MapNodeOutput(thisNode->treeOutputs, newNode->treeOutputs);
+
+            Log() << "Flattened forest node " << thisNode->GetId() << std::endl;
+            return true;
+        }
+    } // namespace
+
+    Submodel FlattenForestsTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        auto result = transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [compiler](const Node& node, ModelTransformer& transformer) {
+            bool flattenForests = compiler->GetModelOptimizerOptions(node).GetEntry<bool>("flattenForests", false);
+            if (!flattenForests || !TryFlattenForest(node, transformer))
+            {
+                transformer.CopyNode(node);
+            }
+        });
+
+        return result;
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,258 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FoldConstantsTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FoldConstantsTransformation.h"
+
+#include <model/include/MapCompiler.h>
+
+#include <nodes/include/ConstantNode.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+// Folding a node may not make its output more than this many elements bigger than its inputs
+constexpr size_t maxFoldedGrowth = 16;
+
+std::string GetBaseTypeName(const Node& node)
+{
+    auto name = node.GetRuntimeTypeName();
+    return name.substr(0, name.find('<'));
+}
+
+bool IsConstantNode(const Node& node)
+{
+    return GetBaseTypeName(node) == "ConstantNode";
+}
+
+size_t GetTotalSize(const std::vector<InputPortBase*>& ports)
+{
+    size_t result = 0;
+    for (auto port : ports)
+    {
+        result += port->Size();
+    }
+    return result;
+}
+
+size_t GetTotalSize(const std::vector<OutputPortBase*>& ports)
+{
+    size_t result = 0;
+    for (auto port : ports)
+    {
+        result += port->Size();
+    }
+    return result;
+}
+
+template <typename ValueType>
+void ReplaceWithConstant(const OutputPortBase& port, ModelTransformer& transformer)
+{
+    const auto& typedPort = static_cast<const OutputPort<ValueType>&>(port);
+    auto newNode = transformer.AddNode<nodes::ConstantNode<ValueType>>(typedPort.GetOutput(), typedPort.GetMemoryLayout());
+    transformer.MapNodeOutput(typedPort, newNode->output);
+}
+
+void ReplaceWithConstant(const OutputPortBase& port, ModelTransformer& transformer)
+{
+    switch (port.GetType())
+    {
+    case Port::PortType::smallReal:
+        ReplaceWithConstant<float>(port, transformer);
+        break;
+    case Port::PortType::real:
+        ReplaceWithConstant<double>(port, transformer);
+        break;
+    case Port::PortType::integer:
+        ReplaceWithConstant<int>(port, transformer);
+        break;
+    case Port::PortType::bigInt:
+        ReplaceWithConstant<int64_t>(port, transformer);
+        break;
+    case Port::PortType::boolean:
+        ReplaceWithConstant<bool>(port, transformer);
+        break;
+    default:
+        throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "Can't fold a port of this type");
+    }
+}
+
+// Finds the nodes to fold, and which of them and of the ConstantNodes are still needed afterwards
+class ConstantSubgraphs
+{
+public:
+    ConstantSubgraphs(const Submodel& submodel, const MapCompiler* compiler)
+    {
+        std::unordered_set<const Node*> constantNodes;
+        submodel.Visit([&](const Node& node) {
+            if (IsConstantNode(node))
+            {
+                constantNodes.insert(&node);
+                return;
+            }
+
+            if (!passes::IsPureNode(node) || node.GetInputPorts().empty() || node.GetOutputPorts().empty())
+            {
+                return;
+            }
+
+            if (compiler && !compiler->GetModelOptimizerOptions(node).GetEntry<bool>("foldConstants", true))
+            {
+                return;
+            }
+
+            auto parents = node.GetParentNodes();
+            bool hasConstantInputs = std::all_of(parents.begin(), parents.end(), [&](const Node* parent) { return constantNodes.find(parent) != constantNodes.end(); });
+            if (hasConstantInputs && GetTotalSize(node.GetOutputPorts()) <= GetTotalSize(node.GetInputPorts()) + maxFoldedGrowth)
+            {
+                constantNodes.insert(&node);
+                _foldedNodes.insert(&node);
+            }
+        });
+
+        std::unordered_set<const Node*> outputNodes;
+        for (auto output : submodel.GetOutputs())
+        {
+            outputNodes.insert(output->GetNode());
+        }
+
+        // A node is still needed if anything besides the folded nodes reads it
+        std::vector<const OutputPortBase*> portsToCompute;
+        for (auto node : constantNodes)
+        {
+            auto dependents = node->GetDependentNodes();
+            bool isRead = dependents.empty() || outputNodes.find(node) != outputNodes.end() ||
+                          std::any_of(dependents.begin(), dependents.end(), [this](const Node* dependent) { return !IsFolded(*dependent); });
+            if (isRead)
+            {
+                _neededNodes.insert(node);
+                if (IsFolded(*node))
+                {
+                    portsToCompute.insert(portsToCompute.end(), node->GetOutputPorts().begin(), node->GetOutputPorts().end());
+                }
+            }
+        }
+
+        // Evaluate all the folded subgraphs at once, so that shared parts are only computed once
+        if (!portsToCompute.empty())
+        {
+            submodel.GetModel().VisitSubmodel(portsToCompute, [](const Node& node) { node.Compute(); });
+        }
+    }
+
+    bool IsFolded(const Node& node) const { return _foldedNodes.find(&node) != _foldedNodes.end(); }
+
+    bool IsNeeded(const Node& node) const { return _neededNodes.find(&node) != _neededNodes.end(); }
+
+    bool IsEmpty() const { return _foldedNodes.empty(); }
+
+private:
+    std::unordered_set<const Node*> _foldedNodes;
+    std::unordered_set<const Node*> _neededNodes;
+};
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    bool IsPureNode(const Node& node)
+    {
+        static const std::unordered_set<std::string> pureNodeTypes = {
+            "ArgMaxNode",
+            "ArgMinNode",
+            "BinaryFunctionNode",
+            "BinaryOperationNode",
+            "BinaryPredicateNode",
+            "BroadcastBinaryFunctionNode",
+            "BroadcastBinaryOperationNode",
+            "BroadcastLinearFunctionNode",
+            "BroadcastTernaryFunctionNode",
+            "BroadcastTernaryOperationNode",
+            "BroadcastUnaryFunctionNode",
+            "BroadcastUnaryOperationNode",
+            "ConcatenationNode",
+            "DotProductNode",
+            "FusedElementwiseNode",
+            "InputPreprocessingNode",
+            "L2NormSquaredNode",
+            "MatrixMatrixMultiplyNode",
+            "MatrixVectorProductNode",
+            "MultiplexerNode",
+            "PalettizedMatrixMultiplyNode",
+            "ReinterpretLayoutNode",
+            "ReorderDataNode",
+            "SliceNode",
+            "SparseMatrixMultiplyNode",
+            "SpliceNode",
+            "SquaredEuclideanDistanceNode",
+            "SumNode",
+            "TypeCastNode",
+            "UnaryOperationNode",
+            "ValueSelectorNode",
+        };
+        return pureNodeTypes.find(GetBaseTypeName(node)) != pureNodeTypes.end();
+    }
+
+    Submodel FoldConstantsTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        ConstantSubgraphs constantSubgraphs(submodel, context.GetCompiler());
+        if (constantSubgraphs.IsEmpty())
+        {
+            return submodel;
+        }
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [&constantSubgraphs](const Node& node, ModelTransformer& transformer) {
+            if (constantSubgraphs.IsFolded(node))
+            {
+                if (constantSubgraphs.IsNeeded(node))
+                {
+                    Log() << "Folding " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "] into a constant" << EOL;
+                    for (auto output : node.GetOutputPorts())
+                    {
+                        ReplaceWithConstant(*output, transformer);
+                    }
+                }
+                return;
+            }
+
+            if (IsConstantNode(node) && !constantSubgraphs.IsNeeded(node))
+            {
+                // Only read by folded nodes
+                return;
+            }
+
+            transformer.CopyNode(node);
+        });
+    }
+} // namespace passes
+} // namespace ell
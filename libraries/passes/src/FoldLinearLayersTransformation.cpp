@@ -0,0 +1,321 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FoldLinearLayersTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FoldLinearLayersTransformation.h"
+
+#include <model/include/MapCompiler.h>
+#include <model/include/RefineTransformation.h>
+
+#include <nodes/include/BatchNormalizationLayerNode.h>
+#include <nodes/include/BiasLayerNode.h>
+#include <nodes/include/ConvolutionalLayerNode.h>
+#include <nodes/include/FullyConnectedLayerNode.h>
+#include <nodes/include/ScalingLayerNode.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+bool IsNeuralNetworkPredictorNode(const Node& node)
+{
+    return (node.GetRuntimeTypeName().find("NeuralNetworkPredictorNode") == 0);
+}
+
+bool CanFuseNode(const Node& node, const MapCompiler& compiler)
+{
+    return compiler.GetModelOptimizerOptions(node).GetEntry<bool>("fuseLinearFunctionNodes", true);
+}
+
+// A convolutional or fully-connected layer, followed by the per-channel linear layers that can be folded into it
+template <typename ValueType>
+struct LinearLayerChain
+{
+    using VectorType = typename predictors::neural::Layer<ValueType>::VectorType;
+
+    const nodes::NeuralNetworkLayerNodeBase<ValueType>* weightsNode = nullptr;
+    std::vector<const nodes::NeuralNetworkLayerNodeBase<ValueType>*> linearNodes;
+
+    // The chain of linear layers computes scale * x + bias, per channel
+    VectorType scale;
+    VectorType bias;
+};
+
+template <typename ValueType>
+const nodes::NeuralNetworkLayerNodeBase<ValueType>* GetWeightsLayerNode(const Node& node)
+{
+    if (dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(&node) || dynamic_cast<const nodes::FullyConnectedLayerNode<ValueType>*>(&node))
+    {
+        return static_cast<const nodes::NeuralNetworkLayerNodeBase<ValueType>*>(&node);
+    }
+    return nullptr;
+}
+
+// Composes a per-channel linear layer with the linear function computed so far, returning false if the node isn't one
+template <typename ValueType>
+bool ComposeLinearLayer(const Node& node, typename LinearLayerChain<ValueType>::VectorType& scale, typename LinearLayerChain<ValueType>::VectorType& bias)
+{
+    if (auto batchNormNode = dynamic_cast<const nodes::BatchNormalizationLayerNode<ValueType>*>(&node))
+    {
+        // BatchNormalizationLayer computes x * m + a
+        const auto& m = batchNormNode->GetLayer().GetScale();
+        const auto& a = batchNormNode->GetLayer().GetBias();
+        for (size_t i = 0; i < scale.Size(); ++i)
+        {
+            scale[i] *= m[i];
+            bias[i] = bias[i] * m[i] + a[i];
+        }
+        return true;
+    }
+
+    if (auto scalingNode = dynamic_cast<const nodes::ScalingLayerNode<ValueType>*>(&node))
+    {
+        auto s = scalingNode->GetLayer().GetScale();
+        for (size_t i = 0; i < scale.Size(); ++i)
+        {
+            scale[i] *= s[i];
+            bias[i] *= s[i];
+        }
+        return true;
+    }
+
+    if (auto biasNode = dynamic_cast<const nodes::BiasLayerNode<ValueType>*>(&node))
+    {
+        auto b = biasNode->GetLayer().GetBias();
+        for (size_t i = 0; i < bias.Size(); ++i)
+        {
+            bias[i] += b[i];
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// Finds the chains to fold, keyed by the last linear layer of each
+template <typename ValueType>
+class LinearLayerChains
+{
+public:
+    LinearLayerChains(const Submodel& submodel, const MapCompiler& compiler)
+    {
+        std::unordered_set<const Node*> outputNodes;
+        for (auto output : submodel.GetOutputs())
+        {
+            outputNodes.insert(output->GetNode());
+        }
+
+        submodel.Visit([&](const Node& node) {
+            auto weightsNode = GetWeightsLayerNode<ValueType>(node);
+            if (weightsNode == nullptr || !CanFuseNode(node, compiler))
+            {
+                return;
+            }
+
+            auto numChannels = weightsNode->GetBaseLayer().GetOutputShape().NumChannels();
+            LinearLayerChain<ValueType> chain;
+            chain.weightsNode = weightsNode;
+            chain.scale = typename LinearLayerChain<ValueType>::VectorType(numChannels);
+            chain.scale.Fill(1);
+            chain.bias = typename LinearLayerChain<ValueType>::VectorType(numChannels);
+
+            // Follow the chain while each layer's output is only read by the next one
+            bool hasScale = false;
+            const Node* current = &node;
+            while (outputNodes.find(current) == outputNodes.end())
+            {
+                auto dependents = current->GetDependentNodes();
+                if (dependents.size() != 1 || !CanFuseNode(*dependents[0], compiler) || !ComposeLinearLayer<ValueType>(*dependents[0], chain.scale, chain.bias))
+                {
+                    break;
+                }
+
+                hasScale = hasScale || dynamic_cast<const nodes::BiasLayerNode<ValueType>*>(dependents[0]) == nullptr;
+                current = dependents[0];
+                chain.linearNodes.push_back(static_cast<const nodes::NeuralNetworkLayerNodeBase<ValueType>*>(current));
+            }
+
+            // A single Bias layer would just be replaced by another one
+            if (!hasScale && chain.linearNodes.size() < 2)
+            {
+                return;
+            }
+
+            _foldedNodes.insert(weightsNode);
+            for (auto linearNode : chain.linearNodes)
+            {
+                _foldedNodes.insert(linearNode);
+            }
+            _chains[chain.linearNodes.back()] = std::move(chain);
+        });
+    }
+
+    bool IsFolded(const Node& node) const { return _foldedNodes.find(&node) != _foldedNodes.end(); }
+
+    const LinearLayerChain<ValueType>* GetChainEndingAt(const Node& node) const
+    {
+        auto it = _chains.find(&node);
+        return it == _chains.end() ? nullptr : &it->second;
+    }
+
+private:
+    std::unordered_set<const Node*> _foldedNodes;
+    std::unordered_map<const Node*, LinearLayerChain<ValueType>> _chains;
+};
+
+template <typename ValueType>
+const OutputPort<ValueType>& AddScaledConvolutionalLayer(const nodes::ConvolutionalLayerNode<ValueType>& node, const LinearLayerChain<ValueType>& chain, const typename predictors::neural::Layer<ValueType>::LayerParameters& layerParameters, ModelTransformer& transformer)
+{
+    const auto& layer = node.GetLayer();
+    auto convolutionalParameters = layer.GetConvolutionalParameters();
+
+    // Filter f is made of rows [f * receptiveField, (f + 1) * receptiveField) of the weights
+    auto weights = layer.GetWeights();
+    auto filterSize = convolutionalParameters.receptiveField;
+    for (size_t row = 0; row < weights.NumRows(); ++row)
+    {
+        auto filterScale = chain.scale[row / filterSize];
+        for (size_t column = 0; column < weights.NumColumns(); ++column)
+        {
+            for (size_t channel = 0; channel < weights.NumChannels(); ++channel)
+            {
+                weights(row, column, channel) *= filterScale;
+            }
+        }
+    }
+
+    predictors::neural::ConvolutionalLayer<ValueType> newLayer(layerParameters, convolutionalParameters, std::move(weights));
+    auto newNode = transformer.AddNode<nodes::ConvolutionalLayerNode<ValueType>>(transformer.GetCorrespondingInputs(node.input), newLayer);
+    newNode->GetMetadata() = node.GetMetadata();
+    return newNode->output;
+}
+
+template <typename ValueType>
+const OutputPort<ValueType>& AddScaledFullyConnectedLayer(const nodes::FullyConnectedLayerNode<ValueType>& node, const LinearLayerChain<ValueType>& chain, const typename predictors::neural::Layer<ValueType>::LayerParameters& layerParameters, ModelTransformer& transformer)
+{
+    const auto& layer = node.GetLayer();
+
+    // Output i is in channel i % numChannels, because the output is flattened in row, column, channel order
+    auto weights = layer.GetWeights();
+    auto numChannels = chain.scale.Size();
+    for (size_t row = 0; row < weights.NumRows(); ++row)
+    {
+        weights.GetRow(row) *= chain.scale[row % numChannels];
+    }
+
+    auto weightsReference = weights.GetConstReference();
+    predictors::neural::FullyConnectedLayer<ValueType> newLayer(layerParameters, weightsReference);
+    auto newNode = transformer.AddNode<nodes::FullyConnectedLayerNode<ValueType>>(transformer.GetCorrespondingInputs(node.input), newLayer);
+    newNode->GetMetadata() = node.GetMetadata();
+    return newNode->output;
+}
+
+template <typename ValueType>
+void FoldChain(const LinearLayerChain<ValueType>& chain, ModelTransformer& transformer)
+{
+    const auto& firstLinearNode = *chain.linearNodes.front();
+    const auto& lastLinearNode = *chain.linearNodes.back();
+    bool hasBias = chain.bias.Norm0() != 0;
+
+    // Without a Bias layer, the folded layer writes the chain's output directly
+    auto layerParameters = chain.weightsNode->GetLayerParameters();
+    if (!hasBias)
+    {
+        layerParameters.outputShape = lastLinearNode.GetLayerParameters().outputShape;
+        layerParameters.outputPaddingParameters = lastLinearNode.GetLayerParameters().outputPaddingParameters;
+    }
+
+    auto convolutionalNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(chain.weightsNode);
+    const auto& scaledOutput = convolutionalNode != nullptr ? AddScaledConvolutionalLayer(*convolutionalNode, chain, layerParameters, transformer) : AddScaledFullyConnectedLayer(static_cast<const nodes::FullyConnectedLayerNode<ValueType>&>(*chain.weightsNode), chain, layerParameters, transformer);
+
+    if (!hasBias)
+    {
+        transformer.MapNodeOutput(lastLinearNode.output, scaledOutput);
+        return;
+    }
+
+    typename predictors::neural::Layer<ValueType>::LayerParameters biasParameters = {
+        firstLinearNode.GetLayerParameters().input,
+        firstLinearNode.GetLayerParameters().inputPaddingParameters,
+        lastLinearNode.GetLayerParameters().outputShape,
+        lastLinearNode.GetLayerParameters().outputPaddingParameters
+    };
+    predictors::neural::BiasLayer<ValueType> biasLayer(biasParameters, chain.bias);
+    auto biasNode = transformer.AddNode<nodes::BiasLayerNode<ValueType>>(scaledOutput, biasLayer);
+    transformer.MapNodeOutput(lastLinearNode.output, biasNode->output);
+}
+
+template <typename ValueType>
+bool TryFoldNode(const Node& node, const LinearLayerChains<ValueType>& chains, ModelTransformer& transformer)
+{
+    if (auto chain = chains.GetChainEndingAt(node))
+    {
+        Log() << "Folding " << chain->linearNodes.size() << " linear layers into " << chain->weightsNode->GetRuntimeTypeName() << " [id = " << chain->weightsNode->GetId().ToString() << "]" << EOL;
+        FoldChain(*chain, transformer);
+        return true;
+    }
+
+    // The other nodes of a chain are replaced when the chain's last node is visited
+    return chains.IsFolded(node);
+}
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    Submodel FoldLinearLayersTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        // The layers only become separate nodes once NeuralNetworkPredictorNodes are refined
+        auto refineNNPredictorFn = [](const model::Node& node) {
+            return IsNeuralNetworkPredictorNode(node) ? model::NodeAction::refine : model::NodeAction::compile;
+        };
+        model::TransformContext refineNNPredictorContext{ refineNNPredictorFn };
+        RefineTransformation refineTransformation;
+        auto refined = refineTransformation.Transform(submodel, transformer, refineNNPredictorContext);
+
+        LinearLayerChains<float> floatChains(refined, *compiler);
+        LinearLayerChains<double> doubleChains(refined, *compiler);
+
+        auto onto = transformer.GetCorrespondingOutputs(GetReferencedPorts(refined.GetInputs()));
+        auto destModel = refined.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(refined, destModel, onto, context, [&floatChains, &doubleChains](const Node& node, ModelTransformer& transformer) {
+            if (TryFoldNode(node, floatChains, transformer) || TryFoldNode(node, doubleChains, transformer))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        });
+    }
+} // namespace passes
+} // namespace ell
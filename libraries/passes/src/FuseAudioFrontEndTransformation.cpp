@@ -0,0 +1,273 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseAudioFrontEndTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FuseAudioFrontEndTransformation.h"
+
+#include <model/include/MapCompiler.h>
+
+#include <nodes/include/AudioFrontEndNode.h>
+#include <nodes/include/BinaryOperationNode.h>
+#include <nodes/include/ConstantNode.h>
+#include <nodes/include/DCTNode.h>
+#include <nodes/include/FFTNode.h>
+#include <nodes/include/FilterBankNode.h>
+#include <nodes/include/HammingWindowNode.h>
+#include <nodes/include/UnaryOperationNode.h>
+
+#include <dsp/include/WindowFunctions.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+bool CanFuseNode(const Node& node, const MapCompiler& compiler)
+{
+    return compiler.GetModelOptimizerOptions(node).GetEntry<bool>("fuseAudioFrontEnd", true);
+}
+
+// The nodes of a featurizer to compute with one AudioFrontEndNode
+template <typename ValueType>
+struct FrontEndChain
+{
+    const OutputPort<ValueType>* source = nullptr; // the port the first node reads
+    std::vector<const Node*> nodes;
+    nodes::AudioFrontEndParameters parameters;
+};
+
+// Gets the only dependent of `previous`, if it's a node of type NodeType that can be fused
+template <typename NodeType>
+const NodeType* GetNext(const Node& previous, const std::unordered_set<const Node*>& outputNodes, const MapCompiler& compiler)
+{
+    if (outputNodes.find(&previous) != outputNodes.end())
+    {
+        return nullptr;
+    }
+
+    auto dependents = previous.GetDependentNodes();
+    auto next = dependents.size() == 1 ? dynamic_cast<const NodeType*>(dependents[0]) : nullptr;
+    return next != nullptr && CanFuseNode(*next, compiler) ? next : nullptr;
+}
+
+// Gets the value of a ConstantNode whose values are all the same, returning false if the port isn't one
+template <typename ValueType>
+bool TryGetScalarConstant(const OutputPort<ValueType>& port, double& value)
+{
+    auto constantNode = dynamic_cast<const nodes::ConstantNode<ValueType>*>(port.GetNode());
+    if (constantNode == nullptr || constantNode->GetValues().empty())
+    {
+        return false;
+    }
+
+    const auto& values = constantNode->GetValues();
+    value = values[0];
+    return std::all_of(values.begin(), values.end(), [&values](ValueType x) { return x == values[0]; });
+}
+
+template <typename ValueType>
+bool IsElementwiseBinaryOperation(const nodes::BinaryOperationNode<ValueType>& node, nodes::BinaryOperationType operation)
+{
+    return node.GetOperation() == operation && !node.GetInputMemoryLayout1().HasPadding() && !node.GetInputMemoryLayout2().HasPadding() && !node.GetOutputMemoryLayout().HasPadding();
+}
+
+// Finds the chains to fuse, keyed by their last node
+template <typename ValueType>
+class FrontEndChains
+{
+public:
+    FrontEndChains(const Submodel& submodel, const MapCompiler& compiler)
+    {
+        std::unordered_set<const Node*> outputNodes;
+        for (auto output : submodel.GetOutputs())
+        {
+            outputNodes.insert(output->GetNode());
+        }
+
+        submodel.Visit([&](const Node& node) {
+            auto fftNode = dynamic_cast<const nodes::FFTNode<ValueType>*>(&node);
+            if (fftNode == nullptr || !CanFuseNode(node, compiler))
+            {
+                return;
+            }
+
+            FrontEndChain<ValueType> chain;
+            auto& parameters = chain.parameters;
+            parameters.fftSize = fftNode->GetFFTSize();
+
+            // An optional window before the FFT
+            chain.source = &fftNode->input.GetReferencedPort();
+            auto windowNode = dynamic_cast<const nodes::HammingWindowNode<ValueType>*>(chain.source->GetNode());
+            if (windowNode != nullptr && CanFuseNode(*windowNode, compiler) && GetNext<nodes::FFTNode<ValueType>>(*windowNode, outputNodes, compiler) == fftNode)
+            {
+                auto window = dsp::HammingWindow<ValueType>(windowNode->input.Size());
+                parameters.window.assign(window.begin(), window.end());
+                chain.source = &windowNode->input.GetReferencedPort();
+                chain.nodes.push_back(windowNode);
+            }
+            chain.nodes.push_back(fftNode);
+            const Node* previous = fftNode;
+
+            // An optional power spectrum: the square of the magnitudes, optionally divided by a constant
+            auto squareNode = GetNext<nodes::UnaryOperationNode<ValueType>>(*previous, outputNodes, compiler);
+            if (squareNode != nullptr && squareNode->GetOperation() == nodes::UnaryOperationType::square)
+            {
+                parameters.powerSpectrum = true;
+                chain.nodes.push_back(squareNode);
+                previous = squareNode;
+
+                auto divideNode = GetNext<nodes::BinaryOperationNode<ValueType>>(*previous, outputNodes, compiler);
+                if (divideNode != nullptr && IsElementwiseBinaryOperation(*divideNode, nodes::BinaryOperationType::divide) && divideNode->input1.GetReferencedPort().GetNode() == previous && TryGetScalarConstant(divideNode->input2.GetReferencedPort(), parameters.powerDivisor))
+                {
+                    chain.nodes.push_back(divideNode);
+                    previous = divideNode;
+                }
+            }
+
+            // The filter bank, applied to the fftSize/2 bins of the spectrum
+            auto filterBankNode = GetNext<nodes::FilterBankNode<ValueType>>(*previous, outputNodes, compiler);
+            if (filterBankNode == nullptr || filterBankNode->input.Size() != parameters.fftSize / 2)
+            {
+                return;
+            }
+            const auto& filters = filterBankNode->GetFilters();
+            for (size_t filterIndex = filters.GetBeginFilter(); filterIndex < filters.GetEndFilter(); ++filterIndex)
+            {
+                const auto& coefficients = filters.GetFilterCoefficients(filterIndex);
+                auto start = filters.GetFilter(filterIndex).GetStart();
+                if (start + coefficients.size() > parameters.fftSize / 2)
+                {
+                    return;
+                }
+                parameters.filterStarts.push_back(static_cast<int>(start));
+                parameters.filterSizes.push_back(static_cast<int>(coefficients.size()));
+                parameters.filterCoefficients.insert(parameters.filterCoefficients.end(), coefficients.begin(), coefficients.end());
+            }
+            chain.nodes.push_back(filterBankNode);
+            previous = filterBankNode;
+            const auto numFilters = parameters.filterStarts.size();
+
+            // An optional log, of the filter outputs plus a constant
+            const Node* logInput = previous;
+            std::vector<double> logOffsets(numFilters, 0.0);
+            auto addNode = GetNext<nodes::BinaryOperationNode<ValueType>>(*previous, outputNodes, compiler);
+            if (addNode != nullptr && IsElementwiseBinaryOperation(*addNode, nodes::BinaryOperationType::add))
+            {
+                auto input1 = addNode->input1.GetReferencedPort().GetNode();
+                auto input2 = addNode->input2.GetReferencedPort().GetNode();
+                auto offsetNode = dynamic_cast<const nodes::ConstantNode<ValueType>*>(input1 == previous ? input2 : input1);
+                if (offsetNode != nullptr && offsetNode->GetValues().size() == numFilters)
+                {
+                    logInput = addNode;
+                    logOffsets.assign(offsetNode->GetValues().begin(), offsetNode->GetValues().end());
+                }
+            }
+            auto logNode = GetNext<nodes::UnaryOperationNode<ValueType>>(*logInput, outputNodes, compiler);
+            if (logNode != nullptr && logNode->GetOperation() == nodes::UnaryOperationType::log)
+            {
+                if (logInput != previous)
+                {
+                    chain.nodes.push_back(logInput);
+                }
+                parameters.logOffsets = logOffsets;
+                chain.nodes.push_back(logNode);
+                previous = logNode;
+            }
+
+            // An optional DCT
+            auto dctNode = GetNext<nodes::DCTNode<ValueType>>(*previous, outputNodes, compiler);
+            if (dctNode != nullptr)
+            {
+                parameters.numDCTCoefficients = dctNode->output.Size();
+                chain.nodes.push_back(dctNode);
+            }
+
+            for (auto chainNode : chain.nodes)
+            {
+                _fusedNodes.insert(chainNode);
+            }
+            _chains[chain.nodes.back()] = std::move(chain);
+        });
+    }
+
+    const FrontEndChain<ValueType>* GetChainEndingAt(const Node& node) const
+    {
+        auto it = _chains.find(&node);
+        return it == _chains.end() ? nullptr : &it->second;
+    }
+
+    bool IsFused(const Node& node) const { return _fusedNodes.find(&node) != _fusedNodes.end(); }
+
+private:
+    std::unordered_set<const Node*> _fusedNodes;
+    std::unordered_map<const Node*, FrontEndChain<ValueType>> _chains;
+};
+
+template <typename ValueType>
+bool TryFuseNode(const Node& node, const FrontEndChains<ValueType>& chains, ModelTransformer& transformer)
+{
+    if (auto chain = chains.GetChainEndingAt(node))
+    {
+        Log() << "Fusing " << chain->nodes.size() << " audio front-end nodes ending at " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "]" << EOL;
+        const auto& newSource = transformer.GetCorrespondingOutputs(*chain->source);
+        auto newNode = transformer.AddNode<nodes::AudioFrontEndNode<ValueType>>(newSource, chain->parameters);
+        transformer.MapNodeOutput(static_cast<const OutputPort<ValueType>&>(*node.GetOutputPort(0)), newNode->output);
+        return true;
+    }
+
+    // The other nodes of a chain are dropped
+    return chains.IsFused(node);
+}
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    Submodel FuseAudioFrontEndTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        FrontEndChains<float> floatChains(submodel, *compiler);
+        FrontEndChains<double> doubleChains(submodel, *compiler);
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [&floatChains, &doubleChains](const Node& node, ModelTransformer& transformer) {
+            if (TryFuseNode(node, floatChains, transformer) || TryFuseNode(node, doubleChains, transformer))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        });
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,334 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseConvolutionEpilogueTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FuseConvolutionEpilogueTransformation.h"
+
+#include <model/include/MapCompiler.h>
+
+#include <nodes/include/ActivationFunctions.h>
+#include <nodes/include/BinaryFunctionNode.h>
+#include <nodes/include/BroadcastFunctionNode.h>
+#include <nodes/include/ConstantNode.h>
+#include <nodes/include/OutputEpilogue.h>
+#include <nodes/include/ReorderDataNode.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+bool CanFuseNode(const Node& node, const MapCompiler& compiler)
+{
+    return compiler.GetModelOptimizerOptions(node).GetEntry<bool>("fuseConvolutionEpilogues", true);
+}
+
+// A node computing convolution or matrix multiplication, followed by the bias and activation nodes to fold into its epilogue
+template <typename ValueType>
+struct EpilogueChain
+{
+    const Node* producer = nullptr;
+    const OutputPort<ValueType>* sourcePort = nullptr; // the port the first elementwise node reads: the producer's output, or the reorder's
+    std::vector<const Node*> elementwiseNodes;
+
+    PortMemoryLayout inputLayout; // the layout the first elementwise node reads its input with
+    PortMemoryLayout outputLayout; // the layout the last elementwise node writes its output with
+    ValueType outputPadding = 0;
+
+    nodes::OutputEpilogue<ValueType> epilogue;
+};
+
+// The layouts of an elementwise node in the chain
+struct ElementwiseLayouts
+{
+    const InputPortBase* input = nullptr;
+    PortMemoryLayout inputLayout;
+    PortMemoryLayout outputLayout;
+};
+
+const Node* GetOnlyDependent(const Node& node, const std::unordered_set<const Node*>& outputNodes)
+{
+    if (outputNodes.find(&node) != outputNodes.end())
+    {
+        return nullptr;
+    }
+
+    auto dependents = node.GetDependentNodes();
+    return dependents.size() == 1 ? dependents[0] : nullptr;
+}
+
+// Gets the bias of a BroadcastLinearFunctionNode that adds a constant per channel, returning false if the node isn't one
+template <typename ValueType>
+bool TryGetBias(const Node& node, int numChannels, std::vector<ValueType>& bias, ElementwiseLayouts& layouts)
+{
+    auto linearNode = dynamic_cast<const nodes::BroadcastLinearFunctionNode<ValueType>*>(&node);
+    if (linearNode == nullptr || linearNode->secondaryInput1.Size() != 0 || linearNode->GetBroadcastDimension() != 2 || !linearNode->GetInputMemoryLayout().IsCanonicalOrder())
+    {
+        return false;
+    }
+
+    auto biasNode = dynamic_cast<const nodes::ConstantNode<ValueType>*>(linearNode->secondaryInput2.GetReferencedPort().GetNode());
+    if (biasNode == nullptr || static_cast<int>(biasNode->GetValues().size()) != numChannels)
+    {
+        return false;
+    }
+
+    bias = biasNode->GetValues();
+    layouts = { &linearNode->primaryInput, linearNode->GetInputMemoryLayout(), linearNode->GetOutputMemoryLayout() };
+    return true;
+}
+
+// Gets the per-channel alpha of a parametric ReLU node, returning false if it varies within a channel
+template <typename ValueType>
+bool TryGetParametricReLUAlpha(const nodes::BinaryFunctionNode<ValueType, nodes::ParametricReLUActivationFunction<ValueType>>& node, std::vector<ValueType>& alpha)
+{
+    auto alphaNode = dynamic_cast<const nodes::ConstantNode<ValueType>*>(node.input2.GetReferencedPort().GetNode());
+    if (alphaNode == nullptr)
+    {
+        return false;
+    }
+
+    // The alpha values are read with the node's input layout
+    const auto& values = alphaNode->GetValues();
+    const auto& layout = node.GetInputMemoryLayout();
+    auto size = layout.GetLogicalDimensionActiveSize();
+    alpha.resize(size[2]);
+    for (int channel = 0; channel < size[2]; ++channel)
+    {
+        alpha[channel] = values[layout.GetLogicalEntryOffset({ 0, 0, channel })];
+        for (int row = 0; row < size[0]; ++row)
+        {
+            for (int column = 0; column < size[1]; ++column)
+            {
+                if (values[layout.GetLogicalEntryOffset({ row, column, channel })] != alpha[channel])
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Sets the epilogue's activation from an activation function node, returning false if the node isn't one it can apply
+template <typename ValueType>
+bool TryGetActivation(const Node& node, nodes::OutputEpilogue<ValueType>& epilogue, ElementwiseLayouts& layouts, ValueType& outputPadding)
+{
+    if (auto reluNode = dynamic_cast<const nodes::BroadcastUnaryFunctionNode<ValueType, nodes::ReLUActivationFunction<ValueType>>*>(&node))
+    {
+        epilogue.SetReLU();
+        layouts = { &reluNode->primaryInput, reluNode->GetInputMemoryLayout(), reluNode->GetOutputMemoryLayout() };
+        outputPadding = reluNode->GetOutputPadding();
+        return true;
+    }
+
+    if (auto leakyReLUNode = dynamic_cast<const nodes::BroadcastUnaryFunctionNode<ValueType, nodes::LeakyReLUActivationFunction<ValueType>>*>(&node))
+    {
+        epilogue.SetLeakyReLU(leakyReLUNode->GetFunction().GetLeakyFactor());
+        layouts = { &leakyReLUNode->primaryInput, leakyReLUNode->GetInputMemoryLayout(), leakyReLUNode->GetOutputMemoryLayout() };
+        outputPadding = leakyReLUNode->GetOutputPadding();
+        return true;
+    }
+
+    if (auto parametricReLUNode = dynamic_cast<const nodes::BinaryFunctionNode<ValueType, nodes::ParametricReLUActivationFunction<ValueType>>*>(&node))
+    {
+        std::vector<ValueType> alpha;
+        if (parametricReLUNode->GetInputMemoryLayout().NumDimensions() != 3 || !TryGetParametricReLUAlpha(*parametricReLUNode, alpha))
+        {
+            return false;
+        }
+
+        epilogue.SetParametricReLU(alpha);
+        layouts = { &parametricReLUNode->input1, parametricReLUNode->GetInputMemoryLayout(), parametricReLUNode->GetOutputMemoryLayout() };
+        outputPadding = 0;
+        return true;
+    }
+
+    return false;
+}
+
+// Finds the chains to fuse, keyed by their producer and by their last node
+template <typename ValueType>
+class EpilogueChains
+{
+public:
+    EpilogueChains(const Submodel& submodel, const MapCompiler& compiler)
+    {
+        std::unordered_set<const Node*> outputNodes;
+        for (auto output : submodel.GetOutputs())
+        {
+            outputNodes.insert(output->GetNode());
+        }
+
+        submodel.Visit([&](const Node& node) {
+            auto producer = dynamic_cast<const nodes::IOutputEpilogueNode<ValueType>*>(&node);
+            if (producer == nullptr || !producer->GetEpilogue().IsEmpty() || !CanFuseNode(node, compiler))
+            {
+                return;
+            }
+
+            EpilogueChain<ValueType> chain;
+            chain.producer = &node;
+            chain.sourcePort = dynamic_cast<const OutputPort<ValueType>*>(node.GetOutputPort(0));
+            auto next = GetOnlyDependent(node, outputNodes);
+
+            // The producer's output may be reordered before the elementwise nodes read it
+            auto reorderNode = next == nullptr ? nullptr : dynamic_cast<const nodes::ReorderDataNode<ValueType>*>(next);
+            if (reorderNode != nullptr)
+            {
+                chain.sourcePort = &reorderNode->output;
+                next = GetOnlyDependent(*reorderNode, outputNodes);
+            }
+
+            if (chain.sourcePort == nullptr || next == nullptr || !CanFuseNode(*next, compiler))
+            {
+                return;
+            }
+
+            // Follow an optional bias, then an optional activation
+            const Node* last = nullptr;
+            const Node* previous = chain.sourcePort->GetNode();
+            ElementwiseLayouts layouts;
+            std::vector<ValueType> bias;
+            const auto& channelLayout = reorderNode != nullptr ? reorderNode->GetInputMemoryLayout() : chain.sourcePort->GetMemoryLayout();
+            auto numChannels = channelLayout.NumDimensions() == 3 ? channelLayout.GetLogicalDimensionActiveSize(2) : 0;
+            if (TryGetBias(*next, numChannels, bias, layouts) && layouts.input->GetReferencedPort().GetNode() == previous)
+            {
+                chain.epilogue.SetBias(bias);
+                chain.elementwiseNodes.push_back(next);
+                chain.inputLayout = layouts.inputLayout;
+                chain.outputLayout = layouts.outputLayout;
+                last = next;
+                previous = next;
+                next = GetOnlyDependent(*next, outputNodes);
+            }
+
+            ValueType outputPadding = 0;
+            if (next != nullptr && CanFuseNode(*next, compiler) && TryGetActivation(*next, chain.epilogue, layouts, outputPadding) && layouts.input->GetReferencedPort().GetNode() == previous && (last == nullptr || layouts.inputLayout == chain.outputLayout))
+            {
+                chain.elementwiseNodes.push_back(next);
+                if (last == nullptr)
+                {
+                    chain.inputLayout = layouts.inputLayout;
+                }
+                chain.outputLayout = layouts.outputLayout;
+                chain.outputPadding = outputPadding;
+                last = next;
+            }
+
+            if (last == nullptr || !chain.inputLayout.IsCanonicalOrder() || chain.inputLayout.GetLogicalDimensionActiveSize() != channelLayout.GetLogicalDimensionActiveSize() || !producer->CanApplyEpilogue(channelLayout))
+            {
+                return;
+            }
+
+            for (auto elementwiseNode : chain.elementwiseNodes)
+            {
+                _fusedNodes.insert(elementwiseNode);
+            }
+            _lastNodes[last] = &node;
+            _chains[&node] = std::move(chain);
+        });
+    }
+
+    const EpilogueChain<ValueType>* GetChainWithProducer(const Node& node) const
+    {
+        auto it = _chains.find(&node);
+        return it == _chains.end() ? nullptr : &it->second;
+    }
+
+    const EpilogueChain<ValueType>* GetChainEndingAt(const Node& node) const
+    {
+        auto it = _lastNodes.find(&node);
+        return it == _lastNodes.end() ? nullptr : GetChainWithProducer(*it->second);
+    }
+
+    bool IsFused(const Node& node) const { return _fusedNodes.find(&node) != _fusedNodes.end(); }
+
+private:
+    std::unordered_set<const Node*> _fusedNodes;
+    std::unordered_map<const Node*, const Node*> _lastNodes;
+    std::unordered_map<const Node*, EpilogueChain<ValueType>> _chains;
+};
+
+template <typename ValueType>
+bool TryFuseNode(const Node& node, const EpilogueChains<ValueType>& chains, ModelTransformer& transformer)
+{
+    if (auto chain = chains.GetChainWithProducer(node))
+    {
+        Log() << "Fusing " << chain->elementwiseNodes.size() << " nodes into the epilogue of " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "]" << EOL;
+        transformer.CopyNode(node);
+        const auto& newOutput = transformer.GetCorrespondingOutputs(*node.GetOutputPort(0));
+        auto newNode = dynamic_cast<nodes::IOutputEpilogueNode<ValueType>*>(const_cast<Node*>(newOutput.GetNode()));
+        newNode->SetEpilogue(chain->epilogue);
+        return true;
+    }
+
+    if (auto chain = chains.GetChainEndingAt(node))
+    {
+        // The epilogue was applied to the source port, so the only work left is to write it with the chain's output layout
+        const auto& lastOutput = static_cast<const OutputPort<ValueType>&>(*node.GetOutputPort(0));
+        const OutputPort<ValueType>* result = &transformer.GetCorrespondingOutputs(*chain->sourcePort);
+        if (chain->inputLayout != chain->outputLayout)
+        {
+            auto reorderNode = transformer.AddNode<nodes::ReorderDataNode<ValueType>>(*result, chain->inputLayout, chain->outputLayout, chain->outputPadding);
+            result = &reorderNode->output;
+        }
+        transformer.MapNodeOutput(lastOutput, *result);
+        return true;
+    }
+
+    // The other elementwise nodes of a chain are dropped
+    return chains.IsFused(node);
+}
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    Submodel FuseConvolutionEpilogueTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        EpilogueChains<float> floatChains(submodel, *compiler);
+        EpilogueChains<double> doubleChains(submodel, *compiler);
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [&floatChains, &doubleChains](const Node& node, ModelTransformer& transformer) {
+            if (TryFuseNode(node, floatChains, transformer) || TryFuseNode(node, doubleChains, transformer))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        });
+    }
+} // namespace passes
+} // namespace ell
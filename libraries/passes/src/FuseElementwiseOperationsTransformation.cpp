@@ -0,0 +1,356 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseElementwiseOperationsTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FuseElementwiseOperationsTransformation.h"
+
+#include <model/include/ModelTransformer.h>
+
+#include <nodes/include/ActivationFunctions.h>
+#include <nodes/include/BinaryOperationNode.h>
+#include <nodes/include/BroadcastFunctionNode.h>
+#include <nodes/include/FusedElementwiseNode.h>
+
+#include <utilities/include/StlVectorUtil.h>
+
+#include <functional>
+#include <memory>
+
+using namespace ell;
+using namespace ell::model;
+
+//
+// Implementation
+//
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+//
+// Data structures
+//
+
+// The inputs and operations of an elementwise computation, in the form used by FusedElementwiseNode.
+// Input 0 is the primary input the operations are applied to.
+template <typename ValueType>
+struct ElementwiseChain
+{
+    const InputPort<ValueType>* primaryInput = nullptr; // the port of the original node that input 0 was mapped from
+    std::vector<const OutputPort<ValueType>*> inputs;
+    std::vector<PortMemoryLayout> inputLayouts;
+    std::vector<nodes::FusedElementwiseOperation<ValueType>> operations;
+    PortMemoryLayout outputLayout;
+    ValueType padding = 0;
+};
+
+// Maps an input port of a node to the port it should read from in the new model
+template <typename ValueType>
+using InputMapper = std::function<const OutputPort<ValueType>&(const InputPort<ValueType>&)>;
+
+//
+// Functions
+//
+template <typename ValueType, typename FunctionType>
+bool TryGetUnaryFunctionChain(const Node& node, const InputMapper<ValueType>& mapInput, ElementwiseChain<ValueType>& chain)
+{
+    auto thisNode = dynamic_cast<const nodes::BroadcastUnaryFunctionNode<ValueType, FunctionType>*>(&node);
+    if (thisNode == nullptr)
+    {
+        return false;
+    }
+
+    if (thisNode->GetInputMemoryLayout().GetActiveSize() != thisNode->GetOutputMemoryLayout().GetActiveSize())
+    {
+        return false;
+    }
+
+    nodes::FusedElementwiseOperation<ValueType> operation;
+    operation.type = nodes::FusedElementwiseOperationType::unaryFunction;
+    operation.function = std::make_shared<FunctionType>(thisNode->GetFunction());
+
+    chain.primaryInput = &thisNode->primaryInput;
+    chain.inputs = { &mapInput(thisNode->primaryInput) };
+    chain.inputLayouts = { thisNode->GetInputMemoryLayout() };
+    chain.operations = { operation };
+    chain.outputLayout = thisNode->GetOutputMemoryLayout();
+    chain.padding = thisNode->GetOutputPadding();
+    return true;
+}
+
+template <typename ValueType>
+bool TryGetUnaryFunctionChain(const Node& node, const InputMapper<ValueType>& mapInput, ElementwiseChain<ValueType>& chain)
+{
+    return TryGetUnaryFunctionChain<ValueType, nodes::HardSigmoidActivationFunction<ValueType>>(node, mapInput, chain) ||
+           TryGetUnaryFunctionChain<ValueType, nodes::LeakyReLUActivationFunction<ValueType>>(node, mapInput, chain) ||
+           TryGetUnaryFunctionChain<ValueType, nodes::ReLUActivationFunction<ValueType>>(node, mapInput, chain) ||
+           TryGetUnaryFunctionChain<ValueType, nodes::SigmoidActivationFunction<ValueType>>(node, mapInput, chain) ||
+           TryGetUnaryFunctionChain<ValueType, nodes::TanhActivationFunction<ValueType>>(node, mapInput, chain);
+}
+
+template <typename ValueType>
+bool TryGetLinearFunctionChain(const Node& node, const InputMapper<ValueType>& mapInput, ElementwiseChain<ValueType>& chain)
+{
+    auto thisNode = dynamic_cast<const nodes::BroadcastLinearFunctionNode<ValueType>*>(&node);
+    if (thisNode == nullptr)
+    {
+        return false;
+    }
+
+    const auto& inputLayout = thisNode->GetInputMemoryLayout();
+    if (inputLayout.GetActiveSize() != thisNode->GetOutputMemoryLayout().GetActiveSize())
+    {
+        return false;
+    }
+
+    nodes::FusedElementwiseOperation<ValueType> operation;
+    operation.type = nodes::FusedElementwiseOperationType::linearFunction;
+    operation.broadcastDimension = static_cast<int>(thisNode->GetBroadcastDimension());
+
+    chain.primaryInput = &thisNode->primaryInput;
+    chain.inputs = { &mapInput(thisNode->primaryInput) };
+    chain.inputLayouts = { inputLayout };
+    if (thisNode->secondaryInput1.Size() != 0)
+    {
+        operation.scaleInput = static_cast<int>(chain.inputs.size());
+        chain.inputs.push_back(&mapInput(thisNode->secondaryInput1));
+        chain.inputLayouts.push_back(thisNode->secondaryInput1.GetReferencedPort().GetMemoryLayout());
+    }
+    if (thisNode->secondaryInput2.Size() != 0)
+    {
+        operation.biasInput = static_cast<int>(chain.inputs.size());
+        chain.inputs.push_back(&mapInput(thisNode->secondaryInput2));
+        chain.inputLayouts.push_back(thisNode->secondaryInput2.GetReferencedPort().GetMemoryLayout());
+    }
+    chain.operations = { operation };
+    chain.outputLayout = thisNode->GetOutputMemoryLayout();
+    chain.padding = thisNode->GetOutputPadding();
+    return true;
+}
+
+// If `primaryIsInput1` is false, the right-hand input of the operation is used as the primary input of the chain
+template <typename ValueType>
+bool TryGetBinaryOperationChain(const Node& node, const InputMapper<ValueType>& mapInput, bool primaryIsInput1, ElementwiseChain<ValueType>& chain)
+{
+    auto thisNode = dynamic_cast<const nodes::BinaryOperationNode<ValueType>*>(&node);
+    if (thisNode == nullptr)
+    {
+        return false;
+    }
+
+    // Logical operations aren't defined for the real-valued types we fuse
+    switch (thisNode->GetOperation())
+    {
+    case nodes::BinaryOperationType::add:
+    case nodes::BinaryOperationType::subtract:
+    case nodes::BinaryOperationType::multiply:
+    case nodes::BinaryOperationType::divide:
+        break;
+    default:
+        return false;
+    }
+
+    const auto& outputLayout = thisNode->GetOutputMemoryLayout();
+    if (thisNode->GetInputMemoryLayout1().GetActiveSize() != outputLayout.GetActiveSize() ||
+        thisNode->GetInputMemoryLayout2().GetActiveSize() != outputLayout.GetActiveSize())
+    {
+        return false;
+    }
+
+    nodes::FusedElementwiseOperation<ValueType> operation;
+    operation.type = nodes::FusedElementwiseOperationType::binaryOperation;
+    operation.operation = thisNode->GetOperation();
+    operation.otherInput = 1;
+    operation.isLeftOperand = primaryIsInput1;
+
+    auto input1 = &mapInput(thisNode->input1);
+    auto input2 = &mapInput(thisNode->input2);
+    chain.primaryInput = primaryIsInput1 ? &thisNode->input1 : &thisNode->input2;
+    if (primaryIsInput1)
+    {
+        chain.inputs = { input1, input2 };
+        chain.inputLayouts = { thisNode->GetInputMemoryLayout1(), thisNode->GetInputMemoryLayout2() };
+    }
+    else
+    {
+        chain.inputs = { input2, input1 };
+        chain.inputLayouts = { thisNode->GetInputMemoryLayout2(), thisNode->GetInputMemoryLayout1() };
+    }
+    chain.operations = { operation };
+    chain.outputLayout = outputLayout;
+    chain.padding = thisNode->GetOutputPadding();
+    return true;
+}
+
+template <typename ValueType>
+bool TryGetFusedNodeChain(const Node& node, const InputMapper<ValueType>& mapInput, ElementwiseChain<ValueType>& chain)
+{
+    auto thisNode = dynamic_cast<const nodes::FusedElementwiseNode<ValueType>*>(&node);
+    if (thisNode == nullptr)
+    {
+        return false;
+    }
+
+    chain.primaryInput = &thisNode->GetInput(0);
+    chain.inputs.clear();
+    for (size_t index = 0; index < thisNode->NumInputs(); ++index)
+    {
+        chain.inputs.push_back(&mapInput(thisNode->GetInput(index)));
+    }
+    chain.inputLayouts = thisNode->GetInputMemoryLayouts();
+    chain.operations = thisNode->GetOperations();
+    chain.outputLayout = thisNode->GetOutputMemoryLayout();
+    chain.padding = thisNode->GetOutputPadding();
+    return true;
+}
+
+// Gets the elementwise computation performed by `node`, or returns `false` if it isn't a node we know how to fuse.
+// Binary operations have two candidate primary inputs; `alternative` selects the right-hand one.
+template <typename ValueType>
+bool TryGetElementwiseChain(const Node& node, const InputMapper<ValueType>& mapInput, bool alternative, ElementwiseChain<ValueType>& chain)
+{
+    if (alternative)
+    {
+        return TryGetBinaryOperationChain(node, mapInput, false, chain);
+    }
+
+    return TryGetUnaryFunctionChain(node, mapInput, chain) ||
+           TryGetLinearFunctionChain(node, mapInput, chain) ||
+           TryGetBinaryOperationChain(node, mapInput, true, chain) ||
+           TryGetFusedNodeChain(node, mapInput, chain);
+}
+
+// Appends `consumer` to `producer`, where the primary input of `consumer` is the output of `producer`
+template <typename ValueType>
+ElementwiseChain<ValueType> AppendChain(const ElementwiseChain<ValueType>& producer, const ElementwiseChain<ValueType>& consumer)
+{
+    ElementwiseChain<ValueType> result = producer;
+
+    // The consumer's primary input goes away, the rest of its inputs are appended to the producer's inputs
+    const int inputOffset = static_cast<int>(producer.inputs.size()) - 1;
+    auto remapIndex = [inputOffset](int index) { return index == -1 ? -1 : index + inputOffset; };
+    result.inputs.insert(result.inputs.end(), consumer.inputs.begin() + 1, consumer.inputs.end());
+    result.inputLayouts.insert(result.inputLayouts.end(), consumer.inputLayouts.begin() + 1, consumer.inputLayouts.end());
+    for (auto operation : consumer.operations)
+    {
+        operation.scaleInput = remapIndex(operation.scaleInput);
+        operation.biasInput = remapIndex(operation.biasInput);
+        operation.otherInput = remapIndex(operation.otherInput);
+        result.operations.push_back(operation);
+    }
+
+    result.outputLayout = consumer.outputLayout;
+    result.padding = consumer.padding;
+    return result;
+}
+
+// returns 'true' if we handled the situation, else 'false'. If we return 'false', keep trying other ValueTypes
+template <typename ValueType>
+bool TryFuseElementwiseNodes(const Node& node, ModelTransformer& transformer)
+{
+    // Ports of the node we're visiting refer to the old model, so we look up the corresponding ports in the new one
+    InputMapper<ValueType> mapToNewModel = [&transformer](const InputPort<ValueType>& input) -> const OutputPort<ValueType>& {
+        return transformer.GetCorrespondingInputs(input);
+    };
+
+    // Ports of nodes already in the new model can be used directly
+    InputMapper<ValueType> identity = [](const InputPort<ValueType>& input) -> const OutputPort<ValueType>& {
+        return input.GetReferencedPort();
+    };
+
+    for (bool alternative : { false, true })
+    {
+        ElementwiseChain<ValueType> consumer;
+        if (!TryGetElementwiseChain(node, mapToNewModel, alternative, consumer))
+        {
+            continue;
+        }
+
+        // Only fuse into the producer if nothing else reads its output, otherwise we'd compute it twice
+        if (consumer.primaryInput->GetReferencedPort().GetReferences().size() != 1)
+        {
+            continue;
+        }
+
+        ElementwiseChain<ValueType> producer;
+        const auto& producerNode = *consumer.inputs[0]->GetNode();
+        if (!TryGetElementwiseChain(producerNode, identity, false, producer))
+        {
+            continue;
+        }
+
+        // The consumer must read the producer's output entries exactly where the producer writes them
+        if (producer.outputLayout != consumer.inputLayouts[0])
+        {
+            continue;
+        }
+
+        auto fused = AppendChain(producer, consumer);
+        auto newNode = transformer.AddNode<nodes::FusedElementwiseNode<ValueType>>(fused.inputs, fused.inputLayouts, fused.operations, fused.outputLayout, fused.padding);
+        transformer.MapNodeOutput(static_cast<const OutputPort<ValueType>&>(*node.GetOutputPort(0)), newNode->output);
+        return true;
+    }
+
+    return false;
+}
+
+void FuseElementwiseNodes(const Node& node, ModelTransformer& transformer)
+{
+    if (TryFuseElementwiseNodes<float>(node, transformer))
+    {
+        return;
+    }
+    if (TryFuseElementwiseNodes<double>(node, transformer))
+    {
+        return;
+    }
+    transformer.CopyNode(node);
+}
+} // namespace
+
+//
+// FuseElementwiseOperationsTransformation methods
+//
+namespace ell
+{
+namespace passes
+{
+    Submodel FuseElementwiseOperationsTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        auto result = transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [compiler](const Node& node, ModelTransformer& transformer) {
+            bool canFuseNodes = compiler->GetModelOptimizerOptions(node).GetEntry<bool>("fuseElementwiseNodes", false);
+
+            if (canFuseNodes)
+            {
+                FuseElementwiseNodes(node, transformer);
+            }
+            else
+            {
+                transformer.CopyNode(node);
+            }
+        });
+
+        return result;
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseInputPreprocessingTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FuseInputPreprocessingTransformation.h"
+
+#include <model/include/MapCompiler.h>
+
+#include <nodes/include/BroadcastFunctionNode.h>
+#include <nodes/include/ConstantNode.h>
+#include <nodes/include/InputPreprocessingNode.h>
+#include <nodes/include/ReorderDataNode.h>
+#include <nodes/include/TypeCastNode.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+bool CanFuseNode(const Node& node, const MapCompiler& compiler)
+{
+    return compiler.GetModelOptimizerOptions(node).GetEntry<bool>("fuseInputPreprocessing", true);
+}
+
+const Node* GetOnlyDependent(const Node& node, const std::unordered_set<const Node*>& outputNodes)
+{
+    if (outputNodes.find(&node) != outputNodes.end())
+    {
+        return nullptr;
+    }
+
+    auto dependents = node.GetDependentNodes();
+    return dependents.size() == 1 ? dependents[0] : nullptr;
+}
+
+// Gets the values of a linear function's coefficient input, which must be constant (an empty input has no values)
+template <typename ValueType>
+bool TryGetConstantValues(const InputPort<ValueType>& input, std::vector<ValueType>& values)
+{
+    if (input.Size() == 0)
+    {
+        values.clear();
+        return true;
+    }
+
+    auto constantNode = dynamic_cast<const nodes::ConstantNode<ValueType>*>(input.GetReferencedPort().GetNode());
+    if (constantNode == nullptr)
+    {
+        return false;
+    }
+    values = constantNode->GetValues();
+    return true;
+}
+
+// A type cast, linear function, and reordering to replace with one InputPreprocessingNode
+template <typename InputValueType, typename OutputValueType>
+struct PreprocessingChain
+{
+    const OutputPort<InputValueType>* source = nullptr; // the port the chain reads
+    std::vector<const Node*> nodes;
+
+    PortMemoryLayout inputLayout;
+    PortMemoryLayout outputLayout;
+    std::vector<OutputValueType> scale;
+    std::vector<OutputValueType> bias;
+    int channelDimension = 0;
+    OutputValueType outputPadding = 0;
+};
+
+// Finds the chains to fuse, keyed by their last node
+template <typename InputValueType, typename OutputValueType>
+class PreprocessingChains
+{
+public:
+    PreprocessingChains(const Submodel& submodel, const MapCompiler& compiler)
+    {
+        std::unordered_set<const Node*> outputNodes;
+        for (auto output : submodel.GetOutputs())
+        {
+            outputNodes.insert(output->GetNode());
+        }
+
+        submodel.Visit([&](const Node& node) {
+            auto linearNode = dynamic_cast<const nodes::BroadcastLinearFunctionNode<OutputValueType>*>(&node);
+            if (linearNode == nullptr || !CanFuseNode(node, compiler))
+            {
+                return;
+            }
+
+            // With canonical layouts, the broadcast dimension is the logical channel dimension
+            PreprocessingChain<InputValueType, OutputValueType> chain;
+            chain.inputLayout = linearNode->GetInputMemoryLayout();
+            chain.outputLayout = linearNode->GetOutputMemoryLayout();
+            chain.channelDimension = static_cast<int>(linearNode->GetBroadcastDimension());
+            chain.outputPadding = linearNode->GetOutputPadding();
+            if (!chain.inputLayout.IsCanonicalOrder() || !chain.outputLayout.IsCanonicalOrder() ||
+                !TryGetConstantValues(linearNode->secondaryInput1, chain.scale) || !TryGetConstantValues(linearNode->secondaryInput2, chain.bias))
+            {
+                return;
+            }
+
+            // The linear function reads the output of a type cast, or (for chains that don't change the type) any port
+            const auto& linearInput = static_cast<const OutputPort<OutputValueType>&>(linearNode->primaryInput.GetReferencedPort());
+            auto castNode = dynamic_cast<const nodes::TypeCastNode<InputValueType, OutputValueType>*>(linearInput.GetNode());
+            if constexpr (std::is_same_v<InputValueType, OutputValueType>)
+            {
+                chain.source = &linearInput;
+            }
+            else
+            {
+                if (castNode == nullptr || GetOnlyDependent(*castNode, outputNodes) != &node || !CanFuseNode(*castNode, compiler))
+                {
+                    return;
+                }
+                chain.source = &static_cast<const OutputPort<InputValueType>&>(castNode->input.GetReferencedPort());
+                chain.nodes.push_back(castNode);
+            }
+            chain.nodes.push_back(&node);
+
+            // Follow an optional reordering of the linear function's output
+            const Node* last = &node;
+            auto next = GetOnlyDependent(node, outputNodes);
+            auto reorderNode = next == nullptr ? nullptr : dynamic_cast<const nodes::ReorderDataNode<OutputValueType>*>(next);
+            if (reorderNode != nullptr && CanFuseNode(*reorderNode, compiler) && reorderNode->GetInputMemoryLayout() == chain.outputLayout)
+            {
+                chain.outputLayout = reorderNode->GetOutputMemoryLayout();
+                chain.outputPadding = reorderNode->GetPaddingValue();
+                chain.nodes.push_back(reorderNode);
+                last = reorderNode;
+            }
+
+            // A linear function on its own is already a single pass
+            if (chain.nodes.size() < 2 || chain.inputLayout.GetLogicalDimensionActiveSize() != chain.outputLayout.GetLogicalDimensionActiveSize())
+            {
+                return;
+            }
+
+            for (auto chainNode : chain.nodes)
+            {
+                _fusedNodes.insert(chainNode);
+            }
+            _chains[last] = std::move(chain);
+        });
+    }
+
+    const PreprocessingChain<InputValueType, OutputValueType>* GetChainEndingAt(const Node& node) const
+    {
+        auto it = _chains.find(&node);
+        return it == _chains.end() ? nullptr : &it->second;
+    }
+
+    bool IsFused(const Node& node) const { return _fusedNodes.find(&node) != _fusedNodes.end(); }
+
+private:
+    std::unordered_set<const Node*> _fusedNodes;
+    std::unordered_map<const Node*, PreprocessingChain<InputValueType, OutputValueType>> _chains;
+};
+
+template <typename InputValueType, typename OutputValueType>
+bool TryFuseNode(const Node& node, const PreprocessingChains<InputValueType, OutputValueType>& chains, ModelTransformer& transformer)
+{
+    if (auto chain = chains.GetChainEndingAt(node))
+    {
+        Log() << "Fusing " << chain->nodes.size() << " input preprocessing nodes ending at " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "]" << EOL;
+        const auto& newInput = transformer.GetCorrespondingOutputs(*chain->source);
+        auto newNode = transformer.AddNode<nodes::InputPreprocessingNode<InputValueType, OutputValueType>>(newInput, chain->inputLayout, chain->scale, chain->bias, chain->channelDimension, chain->outputLayout, chain->outputPadding);
+        transformer.MapNodeOutput(static_cast<const OutputPort<OutputValueType>&>(*node.GetOutputPort(0)), newNode->output);
+        return true;
+    }
+
+    // The other nodes of a chain are dropped
+    return chains.IsFused(node);
+}
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    Submodel FuseInputPreprocessingTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        // Chains starting with a type cast are tried first, since the linear function in them also ends a chain of the output type
+        PreprocessingChains<int, float> intToFloatChains(submodel, *compiler);
+        PreprocessingChains<int, double> intToDoubleChains(submodel, *compiler);
+        PreprocessingChains<float, float> floatChains(submodel, *compiler);
+        PreprocessingChains<double, double> doubleChains(submodel, *compiler);
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [&](const Node& node, ModelTransformer& transformer) {
+            if (TryFuseNode(node, intToFloatChains, transformer) || TryFuseNode(node, intToDoubleChains, transformer) ||
+                TryFuseNode(node, floatChains, transformer) || TryFuseNode(node, doubleChains, transformer))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        });
+    }
+} // namespace passes
+} // namespace ell
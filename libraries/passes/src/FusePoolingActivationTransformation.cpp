@@ -0,0 +1,161 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FusePoolingActivationTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FusePoolingActivationTransformation.h"
+
+#include <model/include/MapCompiler.h>
+
+#include <nodes/include/ActivationFunctions.h>
+#include <nodes/include/BroadcastFunctionNode.h>
+#include <nodes/include/PoolingLayerNode.h>
+
+#include <predictors/neural/include/MaxPoolingFunction.h>
+#include <predictors/neural/include/MeanPoolingFunction.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+bool CanFuseNode(const Node& node, const MapCompiler& compiler)
+{
+    return compiler.GetModelOptimizerOptions(node).GetEntry<bool>("fusePoolingActivations", true);
+}
+
+template <typename ValueType>
+using ReLUNode = nodes::BroadcastUnaryFunctionNode<ValueType, nodes::ReLUActivationFunction<ValueType>>;
+
+// The ReLU nodes whose only dependent is a pooling node that can read the ReLU's input instead, and the input of each of those pooling nodes
+class PoolingActivations
+{
+public:
+    PoolingActivations(const Submodel& submodel, const MapCompiler& compiler)
+    {
+        std::unordered_set<const Node*> outputNodes;
+        for (auto output : submodel.GetOutputs())
+        {
+            outputNodes.insert(output->GetNode());
+        }
+
+        submodel.Visit([&](const Node& node) {
+            TryAddPoolingNode<float, predictors::neural::MaxPoolingFunction>(node, outputNodes, compiler) ||
+                TryAddPoolingNode<float, predictors::neural::MeanPoolingFunction>(node, outputNodes, compiler) ||
+                TryAddPoolingNode<double, predictors::neural::MaxPoolingFunction>(node, outputNodes, compiler) ||
+                TryAddPoolingNode<double, predictors::neural::MeanPoolingFunction>(node, outputNodes, compiler);
+        });
+    }
+
+    bool IsFused(const Node& node) const { return _fusedActivations.find(&node) != _fusedActivations.end(); }
+
+    const OutputPortBase* GetRectifiedInput(const Node& poolingNode) const
+    {
+        auto it = _rectifiedInputs.find(&poolingNode);
+        return it == _rectifiedInputs.end() ? nullptr : it->second;
+    }
+
+private:
+    template <typename ValueType, template <typename> class PoolingFunctionType>
+    bool TryAddPoolingNode(const Node& node, const std::unordered_set<const Node*>& outputNodes, const MapCompiler& compiler)
+    {
+        auto poolingNode = dynamic_cast<const nodes::PoolingLayerNode<ValueType, PoolingFunctionType>*>(&node);
+        if (poolingNode == nullptr || poolingNode->RectifiesInput() || !CanFuseNode(node, compiler))
+        {
+            return poolingNode != nullptr;
+        }
+
+        auto reluNode = dynamic_cast<const ReLUNode<ValueType>*>(poolingNode->input.GetReferencedPort().GetNode());
+        if (reluNode == nullptr || !CanFuseNode(*reluNode, compiler) || outputNodes.find(reluNode) != outputNodes.end() || reluNode->GetDependentNodes().size() != 1)
+        {
+            return true;
+        }
+
+        // The pooling node reads the ReLU's input in place of its output, so they must be laid out the same way
+        if (reluNode->primaryInput.Size() != poolingNode->input.Size() || !(reluNode->GetInputMemoryLayout() == poolingNode->GetInputMemoryLayout()))
+        {
+            return true;
+        }
+
+        _fusedActivations.insert(reluNode);
+        _rectifiedInputs[poolingNode] = &reluNode->primaryInput.GetReferencedPort();
+        return true;
+    }
+
+    std::unordered_set<const Node*> _fusedActivations;
+    std::unordered_map<const Node*, const OutputPortBase*> _rectifiedInputs;
+};
+
+template <typename ValueType, template <typename> class PoolingFunctionType>
+bool TryFusePoolingNode(const Node& node, const PoolingActivations& activations, ModelTransformer& transformer)
+{
+    auto poolingNode = dynamic_cast<const nodes::PoolingLayerNode<ValueType, PoolingFunctionType>*>(&node);
+    auto rectifiedInput = poolingNode != nullptr ? activations.GetRectifiedInput(node) : nullptr;
+    if (rectifiedInput == nullptr)
+    {
+        return false;
+    }
+
+    Log() << "Fusing ReLU into " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "]" << EOL;
+    const auto& newInput = transformer.GetCorrespondingOutputs(static_cast<const OutputPort<ValueType>&>(*rectifiedInput));
+    auto newNode = transformer.AddNode<nodes::PoolingLayerNode<ValueType, PoolingFunctionType>>(newInput, poolingNode->GetLayer(), true);
+    transformer.MapNodeOutput(poolingNode->output, newNode->output);
+    return true;
+}
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    Submodel FusePoolingActivationTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        PoolingActivations activations(submodel, *compiler);
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [&activations](const Node& node, ModelTransformer& transformer) {
+            if (activations.IsFused(node))
+            {
+                return;
+            }
+            if (TryFusePoolingNode<float, predictors::neural::MaxPoolingFunction>(node, activations, transformer) ||
+                TryFusePoolingNode<float, predictors::neural::MeanPoolingFunction>(node, activations, transformer) ||
+                TryFusePoolingNode<double, predictors::neural::MaxPoolingFunction>(node, activations, transformer) ||
+                TryFusePoolingNode<double, predictors::neural::MeanPoolingFunction>(node, activations, transformer))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        });
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FuseSoftmaxTopKTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FuseSoftmaxTopKTransformation.h"
+
+#include <model/include/MapCompiler.h>
+
+#include <nodes/include/SoftmaxLayerNode.h>
+#include <nodes/include/TopKNode.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <unordered_set>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+bool CanFuseNode(const Node& node, const MapCompiler& compiler)
+{
+    return compiler.GetModelOptimizerOptions(node).GetEntry<bool>("fuseSoftmaxTopK", true);
+}
+
+// Gets the softmax node a top-k node can read the logits of in place of its output
+template <typename ValueType>
+const nodes::SoftmaxLayerNode<ValueType>* GetFusableSoftmax(const nodes::TopKNode<ValueType>& topKNode, const std::unordered_set<const Node*>& outputNodes, const MapCompiler& compiler)
+{
+    if (topKNode.NormalizesSoftmax() || !CanFuseNode(topKNode, compiler))
+    {
+        return nullptr;
+    }
+
+    auto softmaxNode = dynamic_cast<const nodes::SoftmaxLayerNode<ValueType>*>(topKNode.input.GetReferencedPort().GetNode());
+    if (softmaxNode == nullptr || !CanFuseNode(*softmaxNode, compiler) || outputNodes.find(softmaxNode) != outputNodes.end() || softmaxNode->GetDependentNodes().size() != 1)
+    {
+        return nullptr;
+    }
+
+    // The top-k node reads the logits as a flat vector, so neither port can have padding
+    if (softmaxNode->GetInputMemoryLayout().HasPadding() || softmaxNode->GetOutputMemoryLayout().HasPadding() || topKNode.input.Size() != softmaxNode->input.Size())
+    {
+        return nullptr;
+    }
+    return softmaxNode;
+}
+
+// The softmax nodes to drop, and the top-k nodes that read their logits instead
+class SoftmaxTopKNodes
+{
+public:
+    SoftmaxTopKNodes(const Submodel& submodel, const MapCompiler& compiler)
+    {
+        std::unordered_set<const Node*> outputNodes;
+        for (auto output : submodel.GetOutputs())
+        {
+            outputNodes.insert(output->GetNode());
+        }
+
+        submodel.Visit([&](const Node& node) {
+            TryAddTopKNode<float>(node, outputNodes, compiler) || TryAddTopKNode<double>(node, outputNodes, compiler);
+        });
+    }
+
+    bool IsFusedSoftmax(const Node& node) const { return _fusedSoftmaxNodes.find(&node) != _fusedSoftmaxNodes.end(); }
+
+    bool IsFusedTopK(const Node& node) const { return _fusedTopKNodes.find(&node) != _fusedTopKNodes.end(); }
+
+private:
+    template <typename ValueType>
+    bool TryAddTopKNode(const Node& node, const std::unordered_set<const Node*>& outputNodes, const MapCompiler& compiler)
+    {
+        auto topKNode = dynamic_cast<const nodes::TopKNode<ValueType>*>(&node);
+        if (topKNode == nullptr)
+        {
+            return false;
+        }
+
+        if (auto softmaxNode = GetFusableSoftmax(*topKNode, outputNodes, compiler))
+        {
+            _fusedSoftmaxNodes.insert(softmaxNode);
+            _fusedTopKNodes.insert(topKNode);
+        }
+        return true;
+    }
+
+    std::unordered_set<const Node*> _fusedSoftmaxNodes;
+    std::unordered_set<const Node*> _fusedTopKNodes;
+};
+
+template <typename ValueType>
+bool TryFuseTopKNode(const Node& node, const SoftmaxTopKNodes& fusedNodes, ModelTransformer& transformer)
+{
+    auto topKNode = dynamic_cast<const nodes::TopKNode<ValueType>*>(&node);
+    if (topKNode == nullptr || !fusedNodes.IsFusedTopK(node))
+    {
+        return false;
+    }
+
+    Log() << "Fusing softmax into " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "]" << EOL;
+    auto softmaxNode = static_cast<const nodes::SoftmaxLayerNode<ValueType>*>(topKNode->input.GetReferencedPort().GetNode());
+    const auto& newInput = transformer.GetCorrespondingInputs(softmaxNode->input);
+    auto newNode = transformer.AddNode<nodes::TopKNode<ValueType>>(newInput, topKNode->GetK(), true);
+    transformer.MapNodeOutput(topKNode->values, newNode->values);
+    transformer.MapNodeOutput(topKNode->indices, newNode->indices);
+    return true;
+}
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    Submodel FuseSoftmaxTopKTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        SoftmaxTopKNodes fusedNodes(submodel, *compiler);
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [&fusedNodes](const Node& node, ModelTransformer& transformer) {
+            if (fusedNodes.IsFusedSoftmax(node))
+            {
+                return;
+            }
+            if (TryFuseTopKNode<float>(node, fusedNodes, transformer) || TryFuseTopKNode<double>(node, fusedNodes, transformer))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        });
+    }
+} // namespace passes
+} // namespace ell
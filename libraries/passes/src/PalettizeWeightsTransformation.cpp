@@ -0,0 +1,283 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PalettizeWeightsTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PalettizeWeightsTransformation.h"
+
+#include <model/include/MapCompiler.h>
+
+#include <nodes/include/ConstantNode.h>
+#include <nodes/include/MatrixMatrixMultiplyNode.h>
+#include <nodes/include/MatrixVectorMultiplyNode.h>
+#include <nodes/include/OutputEpilogue.h>
+#include <nodes/include/PalettizedMatrixMultiplyNode.h>
+
+#include <trainers/include/KMeansTrainer.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+int GetIndexBitsOption(const Node& node, const MapCompiler& compiler)
+{
+    return compiler.GetModelOptimizerOptions(node).GetEntry<int>("palettizeWeightsBits", 0);
+}
+
+// Larger layers are clustered with mini-batch k-means, which looks at a sample of the weights in each iteration
+const size_t c_kMeansIterations = 20;
+const size_t c_kMeansBatchSize = 4096;
+
+// A matrix multiplication with constant weights, as the PalettizedMatrixMultiplyNode that would replace it computes it
+template <typename ValueType>
+struct PalettizedProduct
+{
+    const InputPort<ValueType>* input = nullptr;
+    const nodes::ConstantNode<ValueType>* weights = nullptr;
+    int m = 0, n = 0, k = 0;
+    int weightsStride = 0;
+    bool transposeWeights = false;
+    int inputStride = 0;
+    bool transposeInput = false;
+    int outputStride = 0;
+    bool transposeOutput = false;
+    nodes::OutputEpilogue<ValueType> epilogue;
+};
+
+template <typename ValueType>
+const nodes::ConstantNode<ValueType>* GetConstantWeights(const InputPort<ValueType>& port, const MapCompiler& compiler)
+{
+    // Weights stored in reduced precision are read directly from their global, so they're left alone
+    auto constantNode = dynamic_cast<const nodes::ConstantNode<ValueType>*>(port.GetReferencedPort().GetNode());
+    return constantNode == nullptr || nodes::HasReducedPrecisionWeights(compiler, port) ? nullptr : constantNode;
+}
+
+template <typename ValueType>
+bool TryGetProduct(const Node& node, const MapCompiler& compiler, PalettizedProduct<ValueType>& product)
+{
+    if (auto matrixMultiplyNode = dynamic_cast<const nodes::MatrixMatrixMultiplyNode<ValueType>*>(&node))
+    {
+        const auto& n = *matrixMultiplyNode;
+        if (n.output.GetMemoryLayout().NumDimensions() != 1)
+        {
+            return false;
+        }
+
+        if (auto weights = GetConstantWeights(n.input1, compiler))
+        {
+            product = { &n.input2, weights, n.NumRows(), n.NumColumns(), n.InnerDimension(), n.GetInput1Stride(), n.IsInput1Transposed(), n.GetInput2Stride(), n.IsInput2Transposed(), n.GetOutputStride(), n.IsOutputTransposed() };
+        }
+        else if (auto weights = GetConstantWeights(n.input2, compiler))
+        {
+            // C = A * B is computed as its transpose, B' * A', which is the same matrix in memory
+            product = { &n.input1, weights, n.NumColumns(), n.NumRows(), n.InnerDimension(), n.GetInput2Stride(), !n.IsInput2Transposed(), n.GetInput1Stride(), !n.IsInput1Transposed(), n.GetOutputStride(), !n.IsOutputTransposed() };
+        }
+        else
+        {
+            return false;
+        }
+        product.epilogue = n.GetEpilogue();
+    }
+    else if (auto matrixVectorMultiplyNode = dynamic_cast<const nodes::MatrixVectorMultiplyNode<ValueType>*>(&node))
+    {
+        const auto& n = *matrixVectorMultiplyNode;
+        auto weights = GetConstantWeights(n.inputMatrix, compiler);
+        if (weights == nullptr || n.GetVectorStride() != 1)
+        {
+            return false;
+        }
+        product = { &n.inputVector, weights, static_cast<int>(n.NumRows()), 1, static_cast<int>(n.NumColumns()), static_cast<int>(n.GetMatrixStride()), false, 1, false, 1, false };
+    }
+    else
+    {
+        return false;
+    }
+
+    return static_cast<int>(product.input->Size()) == product.k * product.n;
+}
+
+// Indicates if the indices and codebook take less memory than the weights
+template <typename ValueType>
+bool IsSmaller(const PalettizedProduct<ValueType>& product, int indexBits)
+{
+    auto numWeights = static_cast<int64_t>(product.m) * product.k;
+    auto palettizedBytes = product.m * ((static_cast<int64_t>(product.k) * indexBits + 7) / 8) + (int64_t{ 1 } << indexBits) * static_cast<int64_t>(sizeof(ValueType));
+    return numWeights > 0 && palettizedBytes < numWeights * static_cast<int64_t>(sizeof(ValueType));
+}
+
+// Finds the products to replace, and the weights that are only read by them
+template <typename ValueType>
+class PalettizedProducts
+{
+public:
+    PalettizedProducts(const Submodel& submodel, const MapCompiler& compiler)
+    {
+        std::unordered_set<const Node*> outputNodes;
+        for (auto output : submodel.GetOutputs())
+        {
+            outputNodes.insert(output->GetNode());
+        }
+
+        std::unordered_set<const Node*> weightsNodes;
+        submodel.Visit([&](const Node& node) {
+            auto indexBits = GetIndexBitsOption(node, compiler);
+            PalettizedProduct<ValueType> product;
+            if ((indexBits != 4 && indexBits != 8) || !TryGetProduct(node, compiler, product) || !IsSmaller(product, indexBits))
+            {
+                return;
+            }
+
+            weightsNodes.insert(product.weights);
+            _indexBits[&node] = indexBits;
+            _products[&node] = std::move(product);
+        });
+
+        for (auto weightsNode : weightsNodes)
+        {
+            auto dependents = weightsNode->GetDependentNodes();
+            bool isRead = outputNodes.find(weightsNode) != outputNodes.end() ||
+                          std::any_of(dependents.begin(), dependents.end(), [this](const Node* dependent) { return GetProduct(*dependent) == nullptr; });
+            if (!isRead)
+            {
+                _unusedWeights.insert(weightsNode);
+            }
+        }
+    }
+
+    const PalettizedProduct<ValueType>* GetProduct(const Node& node) const
+    {
+        auto it = _products.find(&node);
+        return it == _products.end() ? nullptr : &it->second;
+    }
+
+    int GetIndexBits(const Node& node) const { return _indexBits.at(&node); }
+
+    bool IsUnusedWeights(const Node& node) const { return _unusedWeights.find(&node) != _unusedWeights.end(); }
+
+private:
+    std::unordered_map<const Node*, PalettizedProduct<ValueType>> _products;
+    std::unordered_map<const Node*, int> _indexBits;
+    std::unordered_set<const Node*> _unusedWeights;
+};
+
+template <typename ValueType>
+bool TryPalettizeNode(const Node& node, const PalettizedProducts<ValueType>& products, ModelTransformer& transformer)
+{
+    if (auto product = products.GetProduct(node))
+    {
+        // Gather the weights as a dense row-major m x k matrix
+        const auto& weights = product->weights->GetValues();
+        std::vector<double> rowMajorWeights;
+        rowMajorWeights.reserve(static_cast<size_t>(product->m) * product->k);
+        for (int row = 0; row < product->m; ++row)
+        {
+            for (int column = 0; column < product->k; ++column)
+            {
+                rowMajorWeights.push_back(weights[product->transposeWeights ? column * product->weightsStride + row : row * product->weightsStride + column]);
+            }
+        }
+
+        auto indexBits = products.GetIndexBits(node);
+        std::vector<double> codebook;
+        std::vector<int> indices;
+        passes::PalettizeValues(rowMajorWeights, 1 << indexBits, codebook, indices);
+
+        Log() << "Replacing " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "] with a product of " << indexBits << "-bit indices into " << codebook.size() << " weight values" << EOL;
+        const auto& newInput = transformer.GetCorrespondingInputs(*product->input);
+        auto palettizedNode = transformer.AddNode<nodes::PalettizedMatrixMultiplyNode<ValueType>>(newInput, std::vector<ValueType>(codebook.begin(), codebook.end()), indices, indexBits, product->m, product->n, product->k, product->inputStride, product->transposeInput, product->outputStride, product->transposeOutput);
+        palettizedNode->SetEpilogue(product->epilogue);
+        transformer.MapNodeOutput(static_cast<const OutputPort<ValueType>&>(*node.GetOutputPort(0)), palettizedNode->output);
+        return true;
+    }
+
+    // The weights the palettized nodes encoded are dropped
+    return products.IsUnusedWeights(node);
+}
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    void PalettizeValues(const std::vector<double>& values, int maxCodebookSize, std::vector<double>& codebook, std::vector<int>& indices)
+    {
+        codebook = values;
+        std::sort(codebook.begin(), codebook.end());
+        codebook.erase(std::unique(codebook.begin(), codebook.end()), codebook.end());
+        if (static_cast<int>(codebook.size()) > maxCodebookSize)
+        {
+            trainers::KMeansTrainerParameters parameters;
+            parameters.batchSize = values.size() > 2 * c_kMeansBatchSize ? c_kMeansBatchSize : 0;
+            trainers::KMeansTrainer kMeansTrainer(1, maxCodebookSize, c_kMeansIterations, parameters);
+            kMeansTrainer.RunKMeans(math::ConstMatrixReference<double, math::MatrixLayout::columnMajor>(values.data(), 1, values.size()));
+
+            const auto& means = kMeansTrainer.GetClusterMeans();
+            codebook.resize(maxCodebookSize);
+            for (int index = 0; index < maxCodebookSize; ++index)
+            {
+                codebook[index] = means(0, index);
+            }
+            std::sort(codebook.begin(), codebook.end());
+        }
+
+        // In one dimension, the closest entry of the sorted codebook is one of the two around the value
+        indices.resize(values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            auto upper = std::lower_bound(codebook.begin(), codebook.end(), values[i]);
+            if (upper == codebook.end() || (upper != codebook.begin() && values[i] - *(upper - 1) < *upper - values[i]))
+            {
+                --upper;
+            }
+            indices[i] = static_cast<int>(upper - codebook.begin());
+        }
+    }
+
+    Submodel PalettizeWeightsTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        PalettizedProducts<float> floatProducts(submodel, *compiler);
+        PalettizedProducts<double> doubleProducts(submodel, *compiler);
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [&floatProducts, &doubleProducts](const Node& node, ModelTransformer& transformer) {
+            if (TryPalettizeNode(node, floatProducts, transformer) || TryPalettizeNode(node, doubleProducts, transformer))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        });
+    }
+} // namespace passes
+} // namespace ell
@@ -0,0 +1,357 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PropagateLayoutsTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PropagateLayoutsTransformation.h"
+
+#include <nodes/include/ReorderDataNode.h>
+#include <nodes/include/UnaryOperationNode.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ell
+{
+
+using namespace model;
+using namespace nodes;
+using namespace utilities;
+using namespace utilities::logging;
+
+namespace passes
+{
+    namespace
+    {
+        template <typename Container, typename Function>
+        auto Transform(const Container& container, Function fn)
+        {
+            return TransformVector(container.begin(), container.end(), fn);
+        }
+
+        std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+        {
+            return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+        }
+
+        void AddLayout(std::vector<PortMemoryLayout>& layouts, const PortMemoryLayout& layout)
+        {
+            if (std::find(layouts.begin(), layouts.end(), layout) == layouts.end())
+            {
+                layouts.push_back(layout);
+            }
+        }
+
+        // Chooses a layout for each group of connected unary operation nodes, then rebuilds the model with the
+        // chosen layouts. Groups are trees, because a unary operation has a single input: the root reads from
+        // outside the group, and any node of the group may have consumers outside it.
+        template <typename ValueType>
+        class LayoutAssignment
+        {
+        public:
+            LayoutAssignment(const Submodel& submodel) :
+                _submodelOutputs(submodel.GetOutputs().begin(), submodel.GetOutputs().end())
+            {
+                submodel.Visit([this](const Node& node) {
+                    if (auto unaryNode = dynamic_cast<const UnaryOperationNode<ValueType>*>(&node))
+                    {
+                        auto parent = _groupIndex.find(unaryNode->input.GetReferencedPort().GetNode());
+                        if (parent == _groupIndex.end())
+                        {
+                            _groupIndex[unaryNode] = _groups.size();
+                            _groups.push_back({ { unaryNode } });
+                        }
+                        else
+                        {
+                            _groupIndex[unaryNode] = parent->second;
+                            _groups[parent->second].nodes.push_back(unaryNode);
+                        }
+                    }
+                });
+
+                // The groups are in dependency order, so the layout of a group's source is known before it's needed
+                for (auto& group : _groups)
+                {
+                    ChooseLayout(group);
+                }
+            }
+
+            bool TryTransformNode(const Node& node, ModelTransformer& transformer)
+            {
+                if (auto unaryNode = dynamic_cast<const UnaryOperationNode<ValueType>*>(&node))
+                {
+                    auto group = GetChangedGroup(unaryNode);
+                    if (group == nullptr)
+                    {
+                        return false;
+                    }
+
+                    const auto& input = unaryNode == group->nodes[0] ? GetValue(group->source, group->sourceLayout, group->layout, group->padding, transformer) : *_newPorts[&unaryNode->input.GetReferencedPort()];
+                    auto newNode = transformer.AddNode<UnaryOperationNode<ValueType>>(input, unaryNode->GetOperation());
+                    _newPorts[&unaryNode->output] = &newNode->output;
+
+                    // Consumers that aren't reorders still read the group's original layout
+                    if (HasFixedConsumers(unaryNode->output))
+                    {
+                        transformer.MapNodeOutput(unaryNode->output, GetValue(&unaryNode->output, group->originalLayout, group->originalLayout, group->padding, transformer));
+                    }
+                    else
+                    {
+                        transformer.MapNodeOutput(unaryNode->output, newNode->output);
+                    }
+                    return true;
+                }
+
+                if (auto reorderNode = dynamic_cast<const ReorderDataNode<ValueType>*>(&node))
+                {
+                    if (!HasFixedConsumers(reorderNode->output))
+                    {
+                        // Every consumer reads the chain's source directly
+                        Log() << "ReorderDataNode [id = " << reorderNode->GetId().ToString() << "] is not needed after layout propagation" << EOL;
+                        transformer.DeleteNode(*reorderNode);
+                        return true;
+                    }
+
+                    auto chain = GetReorderChain(reorderNode->output);
+                    transformer.MapNodeOutput(reorderNode->output, GetValue(chain.source, chain.sourceLayout, reorderNode->GetOutputMemoryLayout(), reorderNode->GetPaddingValue(), transformer));
+                    return true;
+                }
+
+                return false;
+            }
+
+        private:
+            struct Group
+            {
+                std::vector<const UnaryOperationNode<ValueType>*> nodes; // nodes[0] is the root
+                const OutputPort<ValueType>* source = nullptr; // the port the root reads, looking through reorders
+                PortMemoryLayout sourceLayout;
+                PortMemoryLayout originalLayout;
+                PortMemoryLayout layout;
+                ValueType padding = 0;
+                bool isChanged = false;
+            };
+
+            struct ReorderChain
+            {
+                const OutputPort<ValueType>* source = nullptr;
+                PortMemoryLayout sourceLayout; // the input layout of the first reorder of the chain
+                PortMemoryLayout outputLayout; // the output layout of the last reorder of the chain
+                ValueType padding = 0;
+                bool hasReorders = false;
+            };
+
+            // Follows the reorders that produce `port` back to the port they start from
+            ReorderChain GetReorderChain(const OutputPort<ValueType>& port) const
+            {
+                ReorderChain chain;
+                chain.source = &port;
+                while (auto reorderNode = dynamic_cast<const ReorderDataNode<ValueType>*>(chain.source->GetNode()))
+                {
+                    if (!chain.hasReorders)
+                    {
+                        chain.outputLayout = reorderNode->GetOutputMemoryLayout();
+                        chain.padding = reorderNode->GetPaddingValue();
+                        chain.hasReorders = true;
+                    }
+                    chain.sourceLayout = reorderNode->GetInputMemoryLayout();
+                    chain.source = &reorderNode->input.GetReferencedPort();
+                }
+                return chain;
+            }
+
+            const Group* GetChangedGroup(const Node* node) const
+            {
+                auto index = _groupIndex.find(node);
+                if (index == _groupIndex.end() || !_groups[index->second].isChanged)
+                {
+                    return nullptr;
+                }
+                return &_groups[index->second];
+            }
+
+            // Returns true if `port` is read by something other than a reorder or a node of a changed group
+            bool HasFixedConsumers(const OutputPortBase& port) const
+            {
+                if (_submodelOutputs.count(&port) != 0)
+                {
+                    return true;
+                }
+                for (auto dependent : port.GetNode()->GetDependentNodes())
+                {
+                    if (dynamic_cast<const ReorderDataNode<ValueType>*>(dependent) == nullptr && GetChangedGroup(dependent) == nullptr)
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // Adds the layouts that the consumers of `port` (in `layout`) read it in, looking through reorders
+            void GetConsumerLayouts(const OutputPortBase& port, const PortMemoryLayout& layout, const Group& group, std::vector<PortMemoryLayout>& consumerLayouts) const
+            {
+                bool hasFixedConsumers = _submodelOutputs.count(&port) != 0;
+                for (auto dependent : port.GetNode()->GetDependentNodes())
+                {
+                    if (auto reorderNode = dynamic_cast<const ReorderDataNode<ValueType>*>(dependent))
+                    {
+                        GetConsumerLayouts(reorderNode->output, reorderNode->GetOutputMemoryLayout(), group, consumerLayouts);
+                    }
+                    else if (std::find(group.nodes.begin(), group.nodes.end(), dependent) == group.nodes.end())
+                    {
+                        hasFixedConsumers = true;
+                    }
+                }
+                if (hasFixedConsumers)
+                {
+                    AddLayout(consumerLayouts, layout);
+                }
+            }
+
+            void ChooseLayout(Group& group)
+            {
+                auto chain = GetReorderChain(group.nodes[0]->input.GetReferencedPort());
+                group.source = chain.source;
+                group.padding = chain.padding;
+
+                // The layout the group is computed in now is the layout that the reorders around it convert to or from
+                std::vector<PortMemoryLayout> originalLayouts;
+                if (chain.hasReorders)
+                {
+                    originalLayouts.push_back(chain.outputLayout);
+                }
+                std::vector<PortMemoryLayout> consumerLayouts;
+                for (auto node : group.nodes)
+                {
+                    for (auto dependent : node->GetDependentNodes())
+                    {
+                        if (auto reorderNode = dynamic_cast<const ReorderDataNode<ValueType>*>(dependent))
+                        {
+                            AddLayout(originalLayouts, reorderNode->GetInputMemoryLayout());
+                        }
+                    }
+                    GetConsumerLayouts(node->output, PortMemoryLayout{}, group, consumerLayouts);
+                }
+                if (originalLayouts.size() != 1)
+                {
+                    // Either there are no reorders to remove, or the group's layout is ambiguous
+                    return;
+                }
+                group.originalLayout = originalLayouts[0];
+                group.layout = group.originalLayout;
+
+                // Consumers that aren't reorders were collected with an empty layout: they read the original layout
+                for (auto& layout : consumerLayouts)
+                {
+                    if (layout == PortMemoryLayout{})
+                    {
+                        layout = group.originalLayout;
+                    }
+                }
+
+                group.sourceLayout = chain.hasReorders ? chain.sourceLayout : group.originalLayout;
+                if (auto sourceGroup = GetChangedGroup(group.source->GetNode()))
+                {
+                    if (chain.hasReorders && chain.sourceLayout != sourceGroup->originalLayout)
+                    {
+                        return;
+                    }
+                    group.sourceLayout = sourceGroup->layout;
+                }
+
+                // The cost of a layout is the number of elements reordered: once for the input if it arrives in a
+                // different layout, and once for each other layout a consumer asks for
+                auto getCost = [&group, &consumerLayouts](const PortMemoryLayout& layout) {
+                    size_t cost = group.sourceLayout == layout ? 0 : layout.GetMemorySize();
+                    for (const auto& consumerLayout : consumerLayouts)
+                    {
+                        cost += consumerLayout == layout ? 0 : consumerLayout.GetMemorySize();
+                    }
+                    return cost;
+                };
+
+                std::vector<PortMemoryLayout> candidates = { group.originalLayout, group.sourceLayout };
+                candidates.insert(candidates.end(), consumerLayouts.begin(), consumerLayouts.end());
+                auto bestCost = getCost(group.originalLayout);
+                for (const auto& candidate : candidates)
+                {
+                    auto cost = getCost(candidate);
+                    if (cost < bestCost && candidate.NumElements() == group.originalLayout.NumElements())
+                    {
+                        bestCost = cost;
+                        group.layout = candidate;
+                    }
+                }
+
+                // The reorders are rebuilt even if the layout doesn't change, so chains collapse to a single reorder
+                group.isChanged = true;
+                Log() << "Computing " << group.nodes.size() << " unary operation nodes in layout " << group.layout << " instead of " << group.originalLayout << EOL;
+            }
+
+            // Returns `port`, which is in `layout`, in the new model converted to `newLayout`, reusing an earlier conversion if there is one
+            const OutputPort<ValueType>& GetValue(const OutputPort<ValueType>* port, const PortMemoryLayout& layout, const PortMemoryLayout& newLayout, ValueType padding, ModelTransformer& transformer)
+            {
+                auto newPort = _newPorts.find(port);
+                const auto& base = newPort == _newPorts.end() ? transformer.GetCorrespondingOutputs(*port) : *newPort->second;
+                auto baseLayout = layout;
+                if (auto group = GetChangedGroup(port->GetNode()))
+                {
+                    baseLayout = group->layout;
+                }
+                if (baseLayout == newLayout)
+                {
+                    return base;
+                }
+
+                auto& reorders = _reorders[port];
+                auto reorder = std::find_if(reorders.begin(), reorders.end(), [&newLayout](const auto& entry) { return entry.first == newLayout; });
+                if (reorder != reorders.end())
+                {
+                    return *reorder->second;
+                }
+                const auto& result = ReorderData(base, baseLayout, newLayout, padding);
+                reorders.push_back({ newLayout, &result });
+                return result;
+            }
+
+            std::set<const OutputPortBase*> _submodelOutputs;
+            std::map<const Node*, size_t> _groupIndex;
+            std::vector<Group> _groups;
+
+            // The new-model ports computed in each changed group's layout, and the reorders made so far, keyed by the original port
+            std::map<const OutputPortBase*, const OutputPort<ValueType>*> _newPorts;
+            std::map<const OutputPortBase*, std::vector<std::pair<PortMemoryLayout, const OutputPort<ValueType>*>>> _reorders;
+        };
+    } // namespace
+
+    model::Submodel PropagateLayoutsTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler || !compiler->GetModelOptimizerOptions(submodel.GetModel()).GetEntry<bool>("propagateLayouts", false))
+        {
+            return submodel;
+        }
+
+        LayoutAssignment<float> floatLayouts(submodel);
+        LayoutAssignment<double> doubleLayouts(submodel);
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [&floatLayouts, &doubleLayouts](const Node& node, ModelTransformer& transformer) {
+            if (floatLayouts.TryTransformNode(node, transformer) || doubleLayouts.TryTransformNode(node, transformer))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        });
+    }
+} // namespace passes
+} // namespace ell
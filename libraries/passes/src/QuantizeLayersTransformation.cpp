@@ -0,0 +1,345 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     QuantizeLayersTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "QuantizeLayersTransformation.h"
+
+#include <model/include/MapCompiler.h>
+#include <model/include/ModelTransformer.h>
+
+#include <nodes/include/ConstantNode.h>
+#include <nodes/include/ConvolutionalLayerNode.h>
+#include <nodes/include/FullyConnectedLayerNode.h>
+#include <nodes/include/GRUNode.h>
+#include <nodes/include/LSTMNode.h>
+#include <nodes/include/QuantizedLayerNodes.h>
+#include <nodes/include/ReorderDataNode.h>
+
+#include <predictors/neural/include/SigmoidActivation.h>
+#include <predictors/neural/include/TanhActivation.h>
+
+#include <data/include/DenseDataVector.h>
+
+#include <utilities/include/Logger.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace ell
+{
+namespace passes
+{
+    using namespace model;
+    using namespace utilities::logging;
+
+    namespace
+    {
+        // The node metadata entries that CalibrateQuantization writes and the transformation reads
+        const char* c_inputScaleMetadataKey = "quantizationInputScale";
+        const char* c_hiddenScaleMetadataKey = "quantizationHiddenScale";
+
+        // The hidden state of an LSTM or GRU is within [-1, 1]
+        const double c_defaultHiddenScale = 1.0 / 127;
+
+        std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+        {
+            std::vector<const OutputPortBase*> result;
+            for (auto input : inputs)
+            {
+                result.push_back(&input->GetReferencedPort());
+            }
+            return result;
+        }
+
+        template <typename ValueType>
+        bool CanQuantize(const nodes::ConvolutionalLayerNode<ValueType>& node)
+        {
+            const auto& layer = node.GetLayer();
+            const auto& inputPadding = layer.GetLayerParameters().inputPaddingParameters;
+            const auto filterSize = static_cast<int>(layer.GetConvolutionalParameters().receptiveField);
+
+            // Depthwise-separable convolutions have too few products per output to benefit
+            const bool isDepthwiseSeparable = layer.GetWeights().NumChannels() == 1 && node.GetInputMemoryLayout().GetLogicalDimensionActiveSize(2) > 1;
+            const bool hasZeroPadding = inputPadding.paddingSize == 0 || inputPadding.paddingScheme == predictors::neural::PaddingScheme::zeros;
+            return !isDepthwiseSeparable && hasZeroPadding && static_cast<int>(inputPadding.paddingSize) >= filterSize / 2;
+        }
+
+        template <typename ValueType>
+        bool TryQuantizeConvolution(const Node& node, ValueType inputScale, ModelTransformer& transformer)
+        {
+            auto thisNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            if (!CanQuantize(*thisNode))
+            {
+                transformer.CopyNode(node);
+                return true;
+            }
+
+            // Like the full-precision convolutions, the quantized one works on data in (row, column, channel) order
+            const auto& originalInputLayout = thisNode->GetInputMemoryLayout();
+            const auto originalOutputLayout = thisNode->GetOutputMemoryLayout();
+            auto convInputLayout = originalInputLayout.ReorderedCopy({ utilities::RowMajorTensorOrder });
+            auto convOutputLayout = originalOutputLayout.ReorderedCopy({ utilities::RowMajorTensorOrder });
+
+            const auto& newInput = transformer.GetCorrespondingInputs(thisNode->input);
+            const auto& preConvReorder = nodes::ReorderData(newInput, originalInputLayout, convInputLayout);
+
+            const auto& layer = thisNode->GetLayer();
+            auto stride = static_cast<int>(layer.GetConvolutionalParameters().stride);
+            auto newNode = transformer.AddNode<nodes::QuantizedConvolutionalLayerNode<ValueType>>(preConvReorder, convInputLayout, convOutputLayout, layer.GetWeights(), stride, inputScale);
+            newNode->GetMetadata() = node.GetMetadata();
+
+            const auto& postConvReorder = nodes::ReorderData(newNode->output, originalOutputLayout);
+            transformer.MapNodeOutput(thisNode->output, postConvReorder);
+
+            Log() << "Quantized convolution node " << thisNode->GetId() << std::endl;
+            return true;
+        }
+
+        template <typename ValueType>
+        bool TryQuantizeFullyConnected(const Node& node, ValueType inputScale, ModelTransformer& transformer)
+        {
+            auto thisNode = dynamic_cast<const nodes::FullyConnectedLayerNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            const auto& newInput = transformer.GetCorrespondingInputs(thisNode->input);
+            auto newNode = transformer.AddNode<nodes::QuantizedFullyConnectedLayerNode<ValueType>>(newInput, thisNode->GetOutputMemoryLayout(), thisNode->GetLayer().GetWeights(), inputScale);
+            newNode->GetMetadata() = node.GetMetadata();
+            transformer.MapNodeOutput(thisNode->output, newNode->output);
+
+            Log() << "Quantized fully-connected node " << thisNode->GetId() << std::endl;
+            return true;
+        }
+
+        template <typename ValueType>
+        bool GetConstantValues(const InputPort<ValueType>& input, std::vector<ValueType>& values)
+        {
+            auto constantNode = dynamic_cast<const nodes::ConstantNode<ValueType>*>(input.GetReferencedPort().GetNode());
+            if (constantNode == nullptr)
+            {
+                return false;
+            }
+            values = constantNode->GetValues();
+            return true;
+        }
+
+        template <typename ActivationImplType, typename ValueType>
+        bool IsActivation(const predictors::neural::Activation<ValueType>& activation)
+        {
+            return dynamic_cast<const ActivationImplType*>(activation.GetImpl()) != nullptr;
+        }
+
+        template <typename ValueType>
+        bool TryQuantizeRecurrent(const Node& node, ValueType inputScale, ValueType hiddenScale, ModelTransformer& transformer)
+        {
+            // GRUNode derives from LSTMNode
+            auto thisNode = dynamic_cast<const nodes::LSTMNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+            auto cellType = dynamic_cast<const nodes::GRUNode<ValueType>*>(&node) != nullptr ? nodes::RecurrentCellType::gru : nodes::RecurrentCellType::lstm;
+
+            // The quantized cells use sigmoid for the gates and tanh elsewhere, and bake in the weights
+            std::vector<ValueType> inputWeights;
+            std::vector<ValueType> hiddenWeights;
+            std::vector<ValueType> inputBias;
+            std::vector<ValueType> hiddenBias;
+            const bool canQuantize = IsActivation<predictors::neural::TanhActivation<ValueType>>(thisNode->GetActivation()) &&
+                                     IsActivation<predictors::neural::SigmoidActivation<ValueType>>(thisNode->GetRecurrentActivation()) &&
+                                     GetConstantValues(thisNode->inputWeights, inputWeights) &&
+                                     GetConstantValues(thisNode->hiddenWeights, hiddenWeights) &&
+                                     GetConstantValues(thisNode->inputBias, inputBias) &&
+                                     GetConstantValues(thisNode->hiddenBias, hiddenBias);
+            if (!canQuantize)
+            {
+                transformer.CopyNode(node);
+                return true;
+            }
+
+            const auto& newInput = transformer.GetCorrespondingInputs(thisNode->input);
+            const auto& newResetTrigger = transformer.GetCorrespondingInputs(thisNode->resetTrigger);
+            auto newNode = transformer.AddNode<nodes::QuantizedRecurrentLayerNode<ValueType>>(newInput, newResetTrigger, cellType, thisNode->GetHiddenUnits(), inputWeights, hiddenWeights, inputBias, hiddenBias, inputScale, hiddenScale);
+            newNode->GetMetadata() = node.GetMetadata();
+            transformer.MapNodeOutput(thisNode->output, newNode->output);
+
+            Log() << "Quantized recurrent node " << thisNode->GetId() << std::endl;
+            return true;
+        }
+
+        template <typename ValueType>
+        bool TryQuantizeNode(const Node& node, ModelTransformer& transformer)
+        {
+            const auto& metadata = node.GetMetadata();
+            auto inputScale = static_cast<ValueType>(metadata.GetEntry<double>(c_inputScaleMetadataKey));
+            auto hiddenScale = static_cast<ValueType>(metadata.HasEntry(c_hiddenScaleMetadataKey) ? metadata.GetEntry<double>(c_hiddenScaleMetadataKey) : c_defaultHiddenScale);
+            return TryQuantizeConvolution(node, inputScale, transformer) || TryQuantizeFullyConnected(node, inputScale, transformer) || TryQuantizeRecurrent(node, inputScale, hiddenScale, transformer);
+        }
+
+        void QuantizeNode(const Node& node, ModelTransformer& transformer)
+        {
+            if (TryQuantizeNode<float>(node, transformer))
+            {
+                return;
+            }
+            if (TryQuantizeNode<double>(node, transformer))
+            {
+                return;
+            }
+
+            transformer.CopyNode(node);
+        }
+
+        // Returns the values the layer node's input had in the most recent computation, or an empty vector if the node isn't a quantizable layer
+        template <typename ValueType>
+        std::vector<double> GetLayerInputValues(const Node& node)
+        {
+            const InputPort<ValueType>* input = nullptr;
+            if (auto convNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(&node))
+            {
+                input = &convNode->input;
+            }
+            else if (auto fullyConnectedNode = dynamic_cast<const nodes::FullyConnectedLayerNode<ValueType>*>(&node))
+            {
+                input = &fullyConnectedNode->input;
+            }
+            else if (auto recurrentNode = dynamic_cast<const nodes::LSTMNode<ValueType>*>(&node))
+            {
+                input = &recurrentNode->input;
+            }
+
+            if (input == nullptr)
+            {
+                return {};
+            }
+            auto values = input->GetValue();
+            return { values.begin(), values.end() };
+        }
+
+        // Returns the hidden state the recurrent node computed most recently, or an empty vector if the node isn't an LSTM or GRU
+        template <typename ValueType>
+        std::vector<double> GetRecurrentLayerHiddenValues(const Node& node)
+        {
+            auto recurrentNode = dynamic_cast<const nodes::LSTMNode<ValueType>*>(&node);
+            if (recurrentNode == nullptr)
+            {
+                return {};
+            }
+            const auto& values = recurrentNode->output.GetOutput();
+            return { values.begin(), values.end() };
+        }
+
+        void UpdateMaxAbsValue(double& maxAbsValue, const std::vector<double>& values)
+        {
+            for (auto value : values)
+            {
+                maxAbsValue = std::max(maxAbsValue, std::abs(value));
+            }
+        }
+
+        // Map the largest value seen to the largest int8 value the quantized nodes use
+        double GetQuantizationScale(double maxAbsValue)
+        {
+            return maxAbsValue > 0 ? maxAbsValue / 127 : 1.0;
+        }
+    } // namespace
+
+    //
+    // QuantizeLayersTransformation methods
+    //
+    Submodel QuantizeLayersTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        auto result = transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [compiler](const Node& node, ModelTransformer& transformer) {
+            bool quantizeLayers = compiler->GetModelOptimizerOptions(node).GetEntry<bool>("quantizeLayers", false);
+            if (quantizeLayers && node.GetMetadata().HasEntry(c_inputScaleMetadataKey))
+            {
+                QuantizeNode(node, transformer);
+            }
+            else
+            {
+                transformer.CopyNode(node);
+            }
+        });
+
+        return result;
+    }
+
+    template <typename InputType>
+    void CalibrateQuantization(Map& map, const std::vector<std::vector<InputType>>& samples)
+    {
+        std::map<Node*, double> maxAbsInputValues;
+        std::map<Node*, double> maxAbsHiddenValues;
+        for (const auto& sample : samples)
+        {
+            // Going through a data vector converts the sample to the input node's type
+            map.SetInputValue(0, data::DoubleDataVector(std::vector<double>(sample.begin(), sample.end())));
+            for (size_t outputIndex = 0; outputIndex < map.NumOutputs(); ++outputIndex)
+            {
+                map.ComputeOutput<data::DoubleDataVector>(static_cast<int>(outputIndex));
+            }
+
+            auto iter = map.GetModel().GetNodeIterator();
+            while (iter.IsValid())
+            {
+                auto node = const_cast<Node*>(iter.Get());
+                auto values = GetLayerInputValues<float>(*node);
+                if (values.empty())
+                {
+                    values = GetLayerInputValues<double>(*node);
+                }
+
+                if (!values.empty())
+                {
+                    UpdateMaxAbsValue(maxAbsInputValues[node], values);
+                }
+
+                auto hiddenValues = GetRecurrentLayerHiddenValues<float>(*node);
+                if (hiddenValues.empty())
+                {
+                    hiddenValues = GetRecurrentLayerHiddenValues<double>(*node);
+                }
+                if (!hiddenValues.empty())
+                {
+                    UpdateMaxAbsValue(maxAbsHiddenValues[node], hiddenValues);
+                }
+                iter.Next();
+            }
+        }
+
+        for (const auto& entry : maxAbsInputValues)
+        {
+            entry.first->GetMetadata().SetEntry(c_inputScaleMetadataKey, GetQuantizationScale(entry.second));
+        }
+
+        // The hidden state is requantized at every step, so a scale that covers only the range it reaches keeps more precision
+        for (const auto& entry : maxAbsHiddenValues)
+        {
+            entry.first->GetMetadata().SetEntry(c_hiddenScaleMetadataKey, entry.second > 0 ? GetQuantizationScale(entry.second) : c_defaultHiddenScale);
+        }
+    }
+
+    // Explicit instantiations
+    template void CalibrateQuantization(Map& map, const std::vector<std::vector<float>>& samples);
+    template void CalibrateQuantization(Map& map, const std::vector<std::vector<double>>& samples);
+} // namespace passes
+} // namespace ell
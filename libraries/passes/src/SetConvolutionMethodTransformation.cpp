@@ -7,18 +7,31 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "SetConvolutionMethodTransformation.h"
+#include "ConvolutionMethodCache.h"
 
+#include <emitters/include/TargetDevice.h>
+
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/InputNode.h>
+#include <model/include/Map.h>
 #include <model/include/ModelTransformer.h>
 #include <model/include/RefineTransformation.h>
 
 #include <nodes/include/ConvolutionalLayerNode.h>
+#include <nodes/include/DepthwiseConvolutionNode.h>
+#include <nodes/include/PointwiseConvolutionNode.h>
 
 #include <predictors/neural/include/ConvolutionalLayer.h>
 
 #include <utilities/include/Exception.h>
 #include <utilities/include/Logger.h>
+#include <utilities/include/MillisecondTimer.h>
 #include <utilities/include/StlVectorUtil.h>
+#include <utilities/include/TypeName.h>
 
+#include <limits>
+#include <sstream>
 #include <vector>
 
 namespace ell
@@ -85,6 +98,151 @@ namespace passes
             return true;
         }
 
+        //
+        // Auto-tuning
+        //
+
+        // Keep running a candidate until this much time has elapsed, so the timer resolution doesn't matter
+        const std::chrono::milliseconds::rep minTuningTimeMs = 50;
+        const int maxTuningIterations = 1000;
+
+        std::string GetDeviceKey(emitters::TargetDevice device)
+        {
+            emitters::CompleteTargetDevice(device);
+            return device.deviceName + ":" + (device.cpu.empty() ? device.triple : device.cpu);
+        }
+
+        template <typename ValueType>
+        std::string GetConvolutionProblemKey(const nodes::ConvolutionalLayerNode<ValueType>& node, const emitters::TargetDevice& device)
+        {
+            const auto& layer = node.GetLayer();
+            auto inputShape = layer.GetInputShape();
+            auto outputShape = layer.GetOutputShape();
+            auto layerParameters = layer.GetLayerParameters();
+            auto convolutionalParameters = layer.GetConvolutionalParameters();
+
+            std::stringstream key;
+            key << GetDeviceKey(device) << ","
+                << utilities::TypeName<ValueType>::GetName() << ","
+                << inputShape.NumRows() << "x" << inputShape.NumColumns() << "x" << inputShape.NumChannels() << ","
+                << outputShape.NumRows() << "x" << outputShape.NumColumns() << "x" << outputShape.NumChannels() << ","
+                << layerParameters.inputPaddingParameters.paddingSize << "," << layerParameters.outputPaddingParameters.paddingSize << ","
+                << convolutionalParameters.receptiveField << "," << convolutionalParameters.stride;
+            return key.str();
+        }
+
+        // Compiles a model containing just a copy of `node` that uses the given method, and returns the average time
+        // per call in milliseconds
+        template <typename ValueType>
+        double TimeConvolutionMethod(const nodes::ConvolutionalLayerNode<ValueType>& node, const MapCompiler& compiler, model::PreferredConvolutionMethod method)
+        {
+            const auto& layer = node.GetLayer();
+            auto convolutionalParameters = layer.GetConvolutionalParameters();
+            convolutionalParameters.method = GetConvolutionMethod(method);
+            predictors::neural::ConvolutionalLayer<ValueType> newLayer = { layer.GetLayerParameters(), convolutionalParameters, layer.GetWeights() };
+
+            model::Model model;
+            auto inputNode = model.AddNode<model::InputNode<ValueType>>(node.input.Size());
+            auto convolutionNode = model.AddNode<nodes::ConvolutionalLayerNode<ValueType>>(inputNode->output, newLayer);
+            model::Map map(model, { { "input", inputNode } }, { { "output", convolutionNode->output } });
+
+            auto settings = compiler.GetMapCompilerOptions(node);
+            settings.moduleName = "ELL_ConvolutionTuning";
+            settings.profile = false;
+            settings.emitBatchPredictFunction = false;
+            auto optimizerOptions = compiler.GetModelOptimizerOptions(node);
+            optimizerOptions["preferredConvolutionMethod"] = method;
+            model::IRMapCompiler tuningCompiler(settings, optimizerOptions);
+            auto compiledMap = tuningCompiler.Compile(map);
+
+            std::vector<ValueType> input(node.input.Size(), static_cast<ValueType>(1));
+            compiledMap.SetInputValue("input", input);
+            compiledMap.ComputeOutput<ValueType>("output"); // warm up, and force the JIT to run
+
+            int iterations = 0;
+            utilities::MillisecondTimer timer;
+            while (iterations < maxTuningIterations && (iterations == 0 || timer.Elapsed() < minTuningTimeMs))
+            {
+                compiledMap.ComputeOutput<ValueType>("output");
+                ++iterations;
+            }
+            timer.Stop();
+            return static_cast<double>(timer.Elapsed()) / iterations;
+        }
+
+        // returns 'true' if a method was chosen for the node, else 'false'. If we return 'false', keep trying other ValueTypes.
+        template <typename ValueType>
+        bool TryTuneConvolutionMethod(const model::Node& node, const MapCompiler& compiler, ConvolutionMethodCache& cache, model::PreferredConvolutionMethod& bestMethod)
+        {
+            auto thisNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            const auto& device = compiler.GetMapCompilerOptions(node).compilerSettings.targetDevice;
+            auto key = GetConvolutionProblemKey(*thisNode, device);
+            if (cache.TryGetMethod(key, bestMethod))
+            {
+                Log() << "Using cached convolution method " << ToString(bestMethod) << " for node " << thisNode->GetId() << std::endl;
+                return true;
+            }
+
+            // We can only benchmark code for the machine we're running on
+            if (device.deviceName != "host")
+            {
+                Log() << "Can't tune convolution method for node " << thisNode->GetId() << " on device " << device.deviceName << std::endl;
+                return false;
+            }
+
+            auto convolutionalParameters = thisNode->GetLayer().GetConvolutionalParameters();
+            double bestTime = std::numeric_limits<double>::max();
+            for (auto method : { model::PreferredConvolutionMethod::simple, model::PreferredConvolutionMethod::unrolled, model::PreferredConvolutionMethod::diagonal, model::PreferredConvolutionMethod::winograd })
+            {
+                if (!IsMethodCompatible(GetConvolutionMethod(method), convolutionalParameters))
+                {
+                    continue;
+                }
+
+                try
+                {
+                    auto time = TimeConvolutionMethod(*thisNode, compiler, method);
+                    Log() << "Convolution method " << ToString(method) << " for node " << thisNode->GetId() << ": " << time << " ms" << std::endl;
+                    if (time < bestTime)
+                    {
+                        bestTime = time;
+                        bestMethod = method;
+                    }
+                }
+                catch (const utilities::Exception& exception)
+                {
+                    Log() << "Convolution method " << ToString(method) << " failed for node " << thisNode->GetId() << ": " << exception.GetMessage() << std::endl;
+                }
+            }
+
+            if (bestTime == std::numeric_limits<double>::max())
+            {
+                return false;
+            }
+
+            cache.SetMethod(key, bestMethod);
+            return true;
+        }
+
+        model::PreferredConvolutionMethod TuneConvolutionMethod(const model::Node& node, const MapCompiler& compiler, ConvolutionMethodCache& cache)
+        {
+            model::PreferredConvolutionMethod bestMethod = model::PreferredConvolutionMethod::automatic;
+            if (TryTuneConvolutionMethod<float>(node, compiler, cache, bestMethod))
+            {
+                return bestMethod;
+            }
+            if (TryTuneConvolutionMethod<double>(node, compiler, cache, bestMethod))
+            {
+                return bestMethod;
+            }
+            return model::PreferredConvolutionMethod::automatic;
+        }
+
         // returns 'true' if we handled the situation, else 'false'. If we return 'false', keep trying other ValueTypes.
         template <typename ValueType>
         bool TrySetConvolutionMethod(const model::Node& node, model::ModelTransformer& transformer, model::PreferredConvolutionMethod preferredMethod)
@@ -119,9 +277,73 @@ namespace passes
             return true;
         }
 
+        // Replaces a depthwise or 1x1 convolutional layer with a node specialized for it, which works directly on the
+        // layer's input and output without reordering or unrolling them. Returns 'true' if the node was replaced.
+        template <typename ValueType>
+        bool TrySpecializeConvolution(const model::Node& node, model::ModelTransformer& transformer)
+        {
+            auto thisNode = dynamic_cast<const nodes::ConvolutionalLayerNode<ValueType>*>(&node);
+            if (thisNode == nullptr)
+            {
+                return false;
+            }
+
+            const auto inputLayout = thisNode->GetInputMemoryLayout();
+            const auto outputLayout = thisNode->GetOutputMemoryLayout();
+            if (!inputLayout.IsCanonicalOrder() || !outputLayout.IsCanonicalOrder())
+            {
+                return false;
+            }
+
+            const auto& layer = thisNode->GetLayer();
+            const auto& weights = layer.GetWeights();
+            const auto convolutionalParameters = layer.GetConvolutionalParameters();
+            const int filterSize = static_cast<int>(convolutionalParameters.receptiveField);
+            const int stride = static_cast<int>(convolutionalParameters.stride);
+            const int numInputChannels = inputLayout.GetActiveSize(2);
+            const auto& newInput = transformer.GetCorrespondingInputs(thisNode->input);
+
+            const model::OutputPort<ValueType>* newOutput = nullptr;
+            model::Node* newNode = nullptr;
+            auto isDepthwise = weights.NumChannels() == 1 && numInputChannels > 1 && outputLayout.GetActiveSize(2) == numInputChannels;
+            if (isDepthwise && inputLayout.GetOffset(0) == filterSize / 2 && inputLayout.GetOffset(1) == filterSize / 2)
+            {
+                auto convNode = transformer.AddNode<nodes::DepthwiseConvolutionNode<ValueType>>(newInput, inputLayout, outputLayout, weights, stride);
+                newOutput = &convNode->output;
+                newNode = convNode;
+            }
+            else if (filterSize == 1 && static_cast<int>(weights.NumChannels()) == numInputChannels)
+            {
+                auto convNode = transformer.AddNode<nodes::PointwiseConvolutionNode<ValueType>>(newInput, inputLayout, outputLayout, weights, stride);
+                newOutput = &convNode->output;
+                newNode = convNode;
+            }
+            else
+            {
+                return false;
+            }
+
+            newNode->GetMetadata() = node.GetMetadata();
+            Log() << "Using " << newNode->GetRuntimeTypeName() << " for node " << thisNode->GetId() << std::endl;
+            transformer.MapNodeOutput(thisNode->output, *newOutput);
+            return true;
+        }
+
         void SetConvolutionMethod(const model::Node& node, model::ModelTransformer& transformer, model::PreferredConvolutionMethod preferredMethod)
         {
-            if (preferredMethod != model::PreferredConvolutionMethod::automatic)
+            if (preferredMethod == model::PreferredConvolutionMethod::automatic)
+            {
+                if (TrySpecializeConvolution<float>(node, transformer))
+                {
+                    return;
+                }
+                if (TrySpecializeConvolution<double>(node, transformer))
+                {
+                    return;
+                }
+            }
+
+            if (preferredMethod != model::PreferredConvolutionMethod::automatic && preferredMethod != model::PreferredConvolutionMethod::autotune)
             {
                 if (TrySetConvolutionMethod<float>(node, transformer, preferredMethod))
                 {
@@ -155,19 +377,40 @@ namespace passes
         auto result1 = refineTransformation.Transform(submodel, transformer, refineNNPredictorContext);
 
         // Now set the method on any ConvolutionalLayerNodes, using an in-place transformation
+        // (when auto-tuning, the winning methods are remembered in the cache file given by the "convolutionMethodCache" option)
+        ConvolutionMethodCache cache;
+        std::string cacheFilename;
+        auto compiler = context.GetCompiler();
+        if (compiler)
+        {
+            cacheFilename = compiler->GetModelOptimizerOptions(result1.GetModel()).GetEntry<std::string>("convolutionMethodCache", "");
+            if (!cacheFilename.empty())
+            {
+                cache.Load(cacheFilename);
+            }
+        }
+
         auto onto = transformer.GetCorrespondingOutputs(GetReferencedPorts(result1.GetInputs()));
         model::Model destModel = result1.GetModel().ShallowCopy();
-        auto result2 = transformer.TransformSubmodelOnto(result1, destModel, onto, context, [context](const Node& node, ModelTransformer& transformer) {
+        auto result2 = transformer.TransformSubmodelOnto(result1, destModel, onto, context, [compiler, &cache](const Node& node, ModelTransformer& transformer) {
             model::PreferredConvolutionMethod preferredMethod = model::PreferredConvolutionMethod::automatic;
-            auto compiler = context.GetCompiler();
             if (compiler)
             {
                 preferredMethod = compiler->GetModelOptimizerOptions(node).GetEntry<PreferredConvolutionMethod>("preferredConvolutionMethod", PreferredConvolutionMethod::automatic);
+                if (preferredMethod == PreferredConvolutionMethod::autotune)
+                {
+                    preferredMethod = TuneConvolutionMethod(node, *compiler, cache);
+                }
             }
 
             SetConvolutionMethod(node, transformer, preferredMethod);
         });
 
+        if (!cacheFilename.empty() && cache.IsModified())
+        {
+            cache.Save(cacheFilename);
+        }
+
         // Finally, refine any ConvolutionalLayerNodes
         auto refineConvLayerFn = [](const model::Node& node) {
             return IsConvolutionalLayerNode(node) ? model::NodeAction::refine : model::NodeAction::compile;
@@ -0,0 +1,259 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SparsifyWeightsTransformation.cpp (passes)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SparsifyWeightsTransformation.h"
+
+#include <model/include/MapCompiler.h>
+
+#include <nodes/include/ConstantNode.h>
+#include <nodes/include/MatrixMatrixMultiplyNode.h>
+#include <nodes/include/MatrixVectorMultiplyNode.h>
+#include <nodes/include/OutputEpilogue.h>
+#include <nodes/include/SparseMatrixMultiplyNode.h>
+
+#include <utilities/include/Logger.h>
+#include <utilities/include/StlVectorUtil.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using namespace ell;
+using namespace ell::model;
+using namespace ell::utilities::logging;
+
+namespace
+{
+template <typename Container, typename Function>
+auto Transform(const Container& container, Function fn)
+{
+    return utilities::TransformVector(container.begin(), container.end(), fn);
+}
+
+std::vector<const OutputPortBase*> GetReferencedPorts(const std::vector<const InputPortBase*>& inputs)
+{
+    return Transform(inputs, [](auto input) { return &input->GetReferencedPort(); });
+}
+
+double GetMaxDensity(const Node& node, const MapCompiler& compiler)
+{
+    return compiler.GetModelOptimizerOptions(node).GetEntry<double>("sparseWeightsDensity", 0.3);
+}
+
+// Loading a stored block's column index and starting its multiply-adds costs about as much as a couple of multiply-adds
+const int c_blockOverhead = 2;
+
+// A matrix multiplication with constant weights, as the SparseMatrixMultiplyNode that would replace it computes it
+template <typename ValueType>
+struct SparseProduct
+{
+    const InputPort<ValueType>* input = nullptr;
+    const nodes::ConstantNode<ValueType>* weights = nullptr;
+    int m = 0, n = 0, k = 0;
+    int weightsStride = 0;
+    bool transposeWeights = false;
+    int inputStride = 0;
+    bool transposeInput = false;
+    int outputStride = 0;
+    bool transposeOutput = false;
+    int blockRows = 1, blockColumns = 1;
+    nodes::OutputEpilogue<ValueType> epilogue;
+};
+
+template <typename ValueType>
+const nodes::ConstantNode<ValueType>* GetConstantWeights(const InputPort<ValueType>& port, const MapCompiler& compiler)
+{
+    // Weights stored in reduced precision are read directly from their global, so they're left dense
+    auto constantNode = dynamic_cast<const nodes::ConstantNode<ValueType>*>(port.GetReferencedPort().GetNode());
+    return constantNode == nullptr || nodes::HasReducedPrecisionWeights(compiler, port) ? nullptr : constantNode;
+}
+
+template <typename ValueType>
+bool TryGetProduct(const Node& node, const MapCompiler& compiler, SparseProduct<ValueType>& product)
+{
+    if (auto matrixMultiplyNode = dynamic_cast<const nodes::MatrixMatrixMultiplyNode<ValueType>*>(&node))
+    {
+        const auto& n = *matrixMultiplyNode;
+        if (n.output.GetMemoryLayout().NumDimensions() != 1)
+        {
+            return false;
+        }
+
+        if (auto weights = GetConstantWeights(n.input1, compiler))
+        {
+            product = { &n.input2, weights, n.NumRows(), n.NumColumns(), n.InnerDimension(), n.GetInput1Stride(), n.IsInput1Transposed(), n.GetInput2Stride(), n.IsInput2Transposed(), n.GetOutputStride(), n.IsOutputTransposed() };
+        }
+        else if (auto weights = GetConstantWeights(n.input2, compiler))
+        {
+            // C = A * B is computed as its transpose, B' * A', which is the same matrix in memory
+            product = { &n.input1, weights, n.NumColumns(), n.NumRows(), n.InnerDimension(), n.GetInput2Stride(), !n.IsInput2Transposed(), n.GetInput1Stride(), !n.IsInput1Transposed(), n.GetOutputStride(), !n.IsOutputTransposed() };
+        }
+        else
+        {
+            return false;
+        }
+        product.epilogue = n.GetEpilogue();
+    }
+    else if (auto matrixVectorMultiplyNode = dynamic_cast<const nodes::MatrixVectorMultiplyNode<ValueType>*>(&node))
+    {
+        const auto& n = *matrixVectorMultiplyNode;
+        auto weights = GetConstantWeights(n.inputMatrix, compiler);
+        if (weights == nullptr || n.GetVectorStride() != 1)
+        {
+            return false;
+        }
+        product = { &n.inputVector, weights, static_cast<int>(n.NumRows()), 1, static_cast<int>(n.NumColumns()), static_cast<int>(n.GetMatrixStride()), false, 1, false, 1, false };
+    }
+    else
+    {
+        return false;
+    }
+
+    return static_cast<int>(product.input->Size()) == product.k * product.n;
+}
+
+// Chooses the block shape that stores the fewest values, returning false if the weights aren't sparse enough to be worth it
+template <typename ValueType>
+bool TryChooseBlockShape(SparseProduct<ValueType>& product, double maxDensity)
+{
+    using SparseNode = nodes::SparseMatrixMultiplyNode<ValueType>;
+    const auto& weights = product.weights->GetValues();
+    auto numWeights = static_cast<int64_t>(product.m) * product.k;
+    if (numWeights == 0)
+    {
+        return false;
+    }
+
+    auto numNonzeros = SparseNode::CountNonzeroBlocks(weights, product.m, product.k, product.weightsStride, product.transposeWeights, 1, 1);
+    if (numNonzeros >= maxDensity * numWeights)
+    {
+        return false;
+    }
+
+    auto bestCost = numWeights;
+    bool found = false;
+    for (auto shape : std::vector<std::pair<int, int>>{ { 1, 1 }, { 1, 4 }, { 4, 1 }, { 4, 4 } })
+    {
+        auto blockRows = shape.first;
+        auto blockColumns = shape.second;
+        if (product.m % blockRows != 0 || product.k % blockColumns != 0)
+        {
+            continue;
+        }
+
+        auto numBlocks = blockRows * blockColumns == 1 ? numNonzeros : SparseNode::CountNonzeroBlocks(weights, product.m, product.k, product.weightsStride, product.transposeWeights, blockRows, blockColumns);
+        auto cost = static_cast<int64_t>(numBlocks) * (blockRows * blockColumns + c_blockOverhead);
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            product.blockRows = blockRows;
+            product.blockColumns = blockColumns;
+            found = true;
+        }
+    }
+    return found;
+}
+
+// Finds the products to replace, and the weights that are only read by them
+template <typename ValueType>
+class SparseProducts
+{
+public:
+    SparseProducts(const Submodel& submodel, const MapCompiler& compiler)
+    {
+        std::unordered_set<const Node*> outputNodes;
+        for (auto output : submodel.GetOutputs())
+        {
+            outputNodes.insert(output->GetNode());
+        }
+
+        std::unordered_set<const Node*> weightsNodes;
+        submodel.Visit([&](const Node& node) {
+            auto maxDensity = GetMaxDensity(node, compiler);
+            SparseProduct<ValueType> product;
+            if (maxDensity <= 0 || !TryGetProduct(node, compiler, product) || !TryChooseBlockShape(product, maxDensity))
+            {
+                return;
+            }
+
+            weightsNodes.insert(product.weights);
+            _products[&node] = std::move(product);
+        });
+
+        for (auto weightsNode : weightsNodes)
+        {
+            auto dependents = weightsNode->GetDependentNodes();
+            bool isRead = outputNodes.find(weightsNode) != outputNodes.end() ||
+                          std::any_of(dependents.begin(), dependents.end(), [this](const Node* dependent) { return GetProduct(*dependent) == nullptr; });
+            if (!isRead)
+            {
+                _unusedWeights.insert(weightsNode);
+            }
+        }
+    }
+
+    const SparseProduct<ValueType>* GetProduct(const Node& node) const
+    {
+        auto it = _products.find(&node);
+        return it == _products.end() ? nullptr : &it->second;
+    }
+
+    bool IsUnusedWeights(const Node& node) const { return _unusedWeights.find(&node) != _unusedWeights.end(); }
+
+private:
+    std::unordered_map<const Node*, SparseProduct<ValueType>> _products;
+    std::unordered_set<const Node*> _unusedWeights;
+};
+
+template <typename ValueType>
+bool TrySparsifyNode(const Node& node, const SparseProducts<ValueType>& products, ModelTransformer& transformer)
+{
+    if (auto product = products.GetProduct(node))
+    {
+        Log() << "Replacing " << node.GetRuntimeTypeName() << " [id = " << node.GetId().ToString() << "] with a sparse product of " << product->blockRows << " x " << product->blockColumns << " blocks" << EOL;
+        const auto& newInput = transformer.GetCorrespondingInputs(*product->input);
+        auto sparseNode = transformer.AddNode<nodes::SparseMatrixMultiplyNode<ValueType>>(newInput, product->weights->GetValues(), product->m, product->n, product->k, product->weightsStride, product->transposeWeights, product->inputStride, product->transposeInput, product->outputStride, product->transposeOutput, product->blockRows, product->blockColumns);
+        sparseNode->SetEpilogue(product->epilogue);
+        transformer.MapNodeOutput(static_cast<const OutputPort<ValueType>&>(*node.GetOutputPort(0)), sparseNode->output);
+        return true;
+    }
+
+    // The weights the sparse nodes copied are dropped
+    return products.IsUnusedWeights(node);
+}
+} // namespace
+
+namespace ell
+{
+namespace passes
+{
+    Submodel SparsifyWeightsTransformation::Transform(const Submodel& submodel, ModelTransformer& transformer, const TransformContext& context) const
+    {
+        auto compiler = context.GetCompiler();
+        if (!compiler)
+        {
+            return submodel;
+        }
+
+        SparseProducts<float> floatProducts(submodel, *compiler);
+        SparseProducts<double> doubleProducts(submodel, *compiler);
+
+        auto onto = GetReferencedPorts(submodel.GetInputs());
+        auto destModel = submodel.GetModel().ShallowCopy();
+        return transformer.TransformSubmodelOnto(submodel, destModel, onto, context, [&floatProducts, &doubleProducts](const Node& node, ModelTransformer& transformer) {
+            if (TrySparsifyNode(node, floatProducts, transformer) || TrySparsifyNode(node, doubleProducts, transformer))
+            {
+                return;
+            }
+            transformer.CopyNode(node);
+        });
+    }
+} // namespace passes
+} // namespace ell
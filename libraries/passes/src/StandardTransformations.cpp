@@ -6,11 +6,27 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "ConvertDSPNodesToFixedPointTransformation.h"
 #include "DetectLowPrecisionConvolutionTransformation.h"
 #include "StandardTransformations.h"
+#include "EliminateCommonSubexpressionsTransformation.h"
+#include "FactorizeFullyConnectedLayersTransformation.h"
+#include "FlattenForestsTransformation.h"
+#include "FoldConstantsTransformation.h"
+#include "FoldLinearLayersTransformation.h"
+#include "FuseAudioFrontEndTransformation.h"
+#include "FuseConvolutionEpilogueTransformation.h"
+#include "FuseElementwiseOperationsTransformation.h"
+#include "FuseInputPreprocessingTransformation.h"
 #include "FuseLinearOperationsTransformation.h"
+#include "FusePoolingActivationTransformation.h"
+#include "FuseSoftmaxTopKTransformation.h"
 #include "OptimizeReorderDataNodesTransformation.h"
+#include "PalettizeWeightsTransformation.h"
+#include "PropagateLayoutsTransformation.h"
+#include "QuantizeLayersTransformation.h"
 #include "SetConvolutionMethodTransformation.h"
+#include "SparsifyWeightsTransformation.h"
 
 #include <model/include/RefineTransformation.h>
 
@@ -33,11 +49,27 @@ namespace passes
         static bool done = false;
         if (!done)
         {
+            registry.AddTransformation<FoldLinearLayersTransformation>();
+            registry.AddTransformation<FactorizeFullyConnectedLayersTransformation>();
             registry.AddTransformation<DetectLowPrecisionConvolutionTransformation>();
+            registry.AddTransformation<QuantizeLayersTransformation>();
+            registry.AddTransformation<ConvertDSPNodesToFixedPointTransformation>();
+            registry.AddTransformation<FuseAudioFrontEndTransformation>();
+            registry.AddTransformation<FlattenForestsTransformation>();
             registry.AddTransformation<SetConvolutionMethodTransformation>();
             registry.AddTransformation<model::RefineTransformation>();
+            registry.AddTransformation<FoldConstantsTransformation>();
+            registry.AddTransformation<EliminateCommonSubexpressionsTransformation>();
+            registry.AddTransformation<SparsifyWeightsTransformation>();
+            registry.AddTransformation<PalettizeWeightsTransformation>();
             registry.AddTransformation<FuseLinearOperationsTransformation>();
+            registry.AddTransformation<FuseInputPreprocessingTransformation>();
+            registry.AddTransformation<FuseConvolutionEpilogueTransformation>();
+            registry.AddTransformation<FusePoolingActivationTransformation>();
+            registry.AddTransformation<FuseSoftmaxTopKTransformation>();
+            registry.AddTransformation<FuseElementwiseOperationsTransformation>();
             registry.AddTransformation<OptimizeReorderDataNodesTransformation>();
+            registry.AddTransformation<PropagateLayoutsTransformation>();
             done = true;
         }
     }
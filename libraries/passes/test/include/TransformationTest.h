@@ -15,5 +15,24 @@
 void TestTransformations();
 
 void TestFuseLinearOperationsTransformation();
+void TestFuseElementwiseOperationsTransformation();
 void TestSetConvolutionMethodTransformation();
+void TestSpecializedConvolutionTransformation();
+void TestConvolutionMethodCache();
 void TestOptimizeReorderDataNodesTransformation();
+void TestQuantizeLayersTransformation();
+void TestQuantizeRecurrentLayersTransformation();
+void TestConvertDSPNodesToFixedPointTransformation();
+void TestFuseAudioFrontEndTransformation();
+void TestFlattenForestsTransformation();
+void TestPropagateLayoutsTransformation();
+void TestFoldConstantsTransformation();
+void TestEliminateCommonSubexpressionsTransformation();
+void TestFoldLinearLayersTransformation();
+void TestFuseConvolutionEpilogueTransformation();
+void TestFusePoolingActivationTransformation();
+void TestFuseSoftmaxTopKTransformation();
+void TestFuseInputPreprocessingTransformation();
+void TestSparsifyWeightsTransformation();
+void TestPalettizeWeightsTransformation();
+void TestFactorizeFullyConnectedLayersTransformation();
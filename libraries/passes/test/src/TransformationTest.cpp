@@ -8,27 +8,93 @@
 
 #include "TransformationTest.h"
 
+#include <passes/include/ConvertDSPNodesToFixedPointTransformation.h>
+#include <passes/include/ConvolutionMethodCache.h>
+#include <passes/include/EliminateCommonSubexpressionsTransformation.h>
+#include <passes/include/FactorizeFullyConnectedLayersTransformation.h>
+#include <passes/include/FlattenForestsTransformation.h>
+#include <passes/include/FoldConstantsTransformation.h>
+#include <passes/include/FoldLinearLayersTransformation.h>
+#include <passes/include/FuseAudioFrontEndTransformation.h>
+#include <passes/include/FuseConvolutionEpilogueTransformation.h>
+#include <passes/include/FuseElementwiseOperationsTransformation.h>
+#include <passes/include/FuseInputPreprocessingTransformation.h>
 #include <passes/include/FuseLinearOperationsTransformation.h>
+#include <passes/include/FusePoolingActivationTransformation.h>
+#include <passes/include/FuseSoftmaxTopKTransformation.h>
 #include <passes/include/OptimizeReorderDataNodesTransformation.h>
+#include <passes/include/PalettizeWeightsTransformation.h>
+#include <passes/include/PropagateLayoutsTransformation.h>
+#include <passes/include/QuantizeLayersTransformation.h>
 #include <passes/include/SetConvolutionMethodTransformation.h>
+#include <passes/include/SparsifyWeightsTransformation.h>
 
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
 #include <model/include/InputNode.h>
 #include <model/include/TransformContext.h>
 #include <model/include/Transformation.h>
 
+#include <nodes/include/ActivationFunctions.h>
+#include <nodes/include/ActivationLayerNode.h>
+#include <nodes/include/AudioFrontEndNode.h>
+#include <nodes/include/BatchNormalizationLayerNode.h>
+#include <nodes/include/BiasLayerNode.h>
+#include <nodes/include/BinaryOperationNode.h>
 #include <nodes/include/BroadcastFunctionNode.h>
 #include <nodes/include/ConstantNode.h>
 #include <nodes/include/ConvolutionalLayerNode.h>
+#include <nodes/include/DCTNode.h>
+#include <nodes/include/FFTNode.h>
+#include <nodes/include/FilterBankNode.h>
+#include <nodes/include/FixedPointDSPNodes.h>
+#include <nodes/include/FlatForestPredictorNode.h>
+#include <nodes/include/ForestPredictorNode.h>
+#include <nodes/include/FullyConnectedLayerNode.h>
+#include <nodes/include/FusedElementwiseNode.h>
+#include <nodes/include/GRUNode.h>
+#include <nodes/include/HammingWindowNode.h>
+#include <nodes/include/IIRFilterNode.h>
+#include <nodes/include/InputPreprocessingNode.h>
+#include <nodes/include/LSTMNode.h>
 #include <nodes/include/MatrixMatrixMultiplyNode.h>
+#include <nodes/include/PalettizedMatrixMultiplyNode.h>
+#include <nodes/include/PoolingLayerNode.h>
+#include <nodes/include/QuantizedLayerNodes.h>
 #include <nodes/include/ReorderDataNode.h>
-
+#include <nodes/include/ScalingLayerNode.h>
+#include <nodes/include/SoftmaxLayerNode.h>
+#include <nodes/include/SparseMatrixMultiplyNode.h>
+#include <nodes/include/TopKNode.h>
+#include <nodes/include/TypeCastNode.h>
+#include <nodes/include/UnaryOperationNode.h>
+
+#include <predictors/include/ForestPredictor.h>
+#include <predictors/include/SingleElementThresholdPredictor.h>
+
+#include <predictors/neural/include/ActivationLayer.h>
+#include <predictors/neural/include/BatchNormalizationLayer.h>
+#include <predictors/neural/include/BiasLayer.h>
 #include <predictors/neural/include/ConvolutionalLayer.h>
+#include <predictors/neural/include/FullyConnectedLayer.h>
+#include <predictors/neural/include/LeakyReLUActivation.h>
+#include <predictors/neural/include/MaxPoolingFunction.h>
+#include <predictors/neural/include/MeanPoolingFunction.h>
+#include <predictors/neural/include/PoolingLayer.h>
+#include <predictors/neural/include/ReLUActivation.h>
+#include <predictors/neural/include/ScalingLayer.h>
+#include <predictors/neural/include/SigmoidActivation.h>
+#include <predictors/neural/include/SoftmaxLayer.h>
+#include <predictors/neural/include/TanhActivation.h>
 
 #include <testing/include/testing.h>
 
 #include <utilities/include/JsonArchiver.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <sstream>
 
 #define PRINT_MODELS 0
 
@@ -128,8 +194,25 @@ model::Map GenerateLinearOpsTestModel(const model::PortMemoryLayout& inputLayout
 void TestTransformations()
 {
     TestFuseLinearOperationsTransformation();
+    TestFuseElementwiseOperationsTransformation();
     TestSetConvolutionMethodTransformation();
     TestOptimizeReorderDataNodesTransformation();
+    TestQuantizeLayersTransformation();
+    TestQuantizeRecurrentLayersTransformation();
+    TestConvertDSPNodesToFixedPointTransformation();
+    TestFuseAudioFrontEndTransformation();
+    TestFlattenForestsTransformation();
+    TestPropagateLayoutsTransformation();
+    TestFoldConstantsTransformation();
+    TestEliminateCommonSubexpressionsTransformation();
+    TestFoldLinearLayersTransformation();
+    TestFuseConvolutionEpilogueTransformation();
+    TestFusePoolingActivationTransformation();
+    TestFuseSoftmaxTopKTransformation();
+    TestFuseInputPreprocessingTransformation();
+    TestSparsifyWeightsTransformation();
+    TestPalettizeWeightsTransformation();
+    TestFactorizeFullyConnectedLayersTransformation();
 }
 
 void TestFuseLinearOperationsTransformation(std::vector<std::pair<bool, bool>> functionInfos)
@@ -228,7 +311,62 @@ void TestFuseLinearOperationsTransformation()
     TestFuseLinearOperationsTransformation({ linear, bias, bias });
 }
 
-void TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod convolutionMethod, std::string expectedNodeTypeName)
+void TestFuseElementwiseOperationsTransformation()
+{
+    using ValueType = float;
+
+    int numRows = 2;
+    int numColumns = 2;
+    int numChannels = 3;
+    model::PortMemoryLayout layout({ numRows, numColumns, numChannels });
+
+    // input -> linear -> relu -> (+ input) -> sigmoid
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(layout);
+    auto scaleNode = model.AddNode<nodes::ConstantNode<ValueType>>(std::vector<ValueType>{ 1, -2, 3 }, model::MemoryShape({ 1, 1, numChannels }));
+    auto biasNode = model.AddNode<nodes::ConstantNode<ValueType>>(std::vector<ValueType>{ -1, 0.5, 2 }, model::MemoryShape({ 1, 1, numChannels }));
+    auto linearNode = model.AddNode<nodes::BroadcastLinearFunctionNode<ValueType>>(inputNode->output, layout, scaleNode->output, biasNode->output, 2, layout);
+    auto reluNode = model.AddNode<nodes::BroadcastUnaryFunctionNode<ValueType, nodes::ReLUActivationFunction<ValueType>>>(linearNode->output, layout, layout);
+    auto addNode = model.AddNode<nodes::BinaryOperationNode<ValueType>>(reluNode->output, inputNode->output, nodes::BinaryOperationType::add);
+    auto sigmoidNode = model.AddNode<nodes::BroadcastUnaryFunctionNode<ValueType, nodes::SigmoidActivationFunction<ValueType>>>(addNode->output, layout, layout);
+    model::Map map(model, { { "input", inputNode } }, { { "output", sigmoidNode->output } });
+    auto oldSize = map.GetModel().Size();
+
+    // Generate test data
+    std::vector<ValueType> testInput(numRows * numColumns * numChannels);
+    std::generate(testInput.begin(), testInput.end(), Increment<ValueType>(-2.0f, 0.5f));
+
+    // Evaluate it pre-optimization
+    map.SetInputValue("input", testInput);
+    auto referenceOutput = map.ComputeOutput<ValueType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["fuseElementwiseNodes"] = true;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    FuseElementwiseOperationsTransformation fuseOps;
+    map.GetModel().GetMetadata().SetEntry("compileOptions", optimizerOptions.AsPropertyBag());
+    map.Transform(fuseOps, context);
+    map.Refine();
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    // Only the input, the two constants and the fused node should remain
+    auto newSize = map.GetModel().Size();
+    testing::ProcessTest("Testing elementwise ops count", oldSize == 7 && newSize == 4);
+    testing::ProcessTest("Testing fused node created", HasNodeWithTypeName(map.GetModel(), nodes::FusedElementwiseNode<ValueType>::GetTypeName()));
+
+    // Evaluate model post-optimization
+    map.SetInputValue("input", testInput);
+    auto optimizedOutput = map.ComputeOutput<ValueType>("output");
+    testing::ProcessTest("Testing fused elementwise result", testing::IsEqual(referenceOutput, optimizedOutput));
+}
+
+void TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod convolutionMethod, std::vector<std::string> expectedNodeTypeNames)
 {
     using namespace predictors::neural;
 
@@ -280,15 +418,106 @@ void TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod co
     PrintModel(map.GetModel());
 #endif
 
-    testing::ProcessTest("Testing SetConvolutionMethodTransformation for " + expectedNodeTypeName, HasNodeWithTypeName(map.GetModel(), expectedNodeTypeName));
+    bool hasExpectedNode = std::any_of(expectedNodeTypeNames.begin(), expectedNodeTypeNames.end(), [&map](const std::string& typeName) { return HasNodeWithTypeName(map.GetModel(), typeName); });
+    testing::ProcessTest("Testing SetConvolutionMethodTransformation for " + ToString(convolutionMethod), hasExpectedNode);
+}
+
+void TestConvolutionMethodCache()
+{
+    ConvolutionMethodCache cache;
+    cache.SetMethod("host:cpu1,float,3x4x2", model::PreferredConvolutionMethod::winograd);
+    cache.SetMethod("host:cpu2,float,3x4x2", model::PreferredConvolutionMethod::unrolled);
+    std::stringstream stream;
+    cache.Write(stream);
+
+    ConvolutionMethodCache loadedCache;
+    loadedCache.Read(stream);
+    model::PreferredConvolutionMethod method1 = model::PreferredConvolutionMethod::automatic;
+    model::PreferredConvolutionMethod method2 = model::PreferredConvolutionMethod::automatic;
+    model::PreferredConvolutionMethod method3 = model::PreferredConvolutionMethod::automatic;
+    bool ok = loadedCache.TryGetMethod("host:cpu1,float,3x4x2", method1) && loadedCache.TryGetMethod("host:cpu2,float,3x4x2", method2);
+    ok = ok && !loadedCache.TryGetMethod("host:cpu3,float,3x4x2", method3) && !loadedCache.IsModified();
+    ok = ok && method1 == model::PreferredConvolutionMethod::winograd && method2 == model::PreferredConvolutionMethod::unrolled;
+    testing::ProcessTest("Testing ConvolutionMethodCache round trip", ok);
 }
 
 void TestSetConvolutionMethodTransformation()
 {
-    TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::diagonal, "DiagonalConvolutionNode<float>");
-    TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::simple, "SimpleConvolutionNode<float>");
-    TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::winograd, "WinogradConvolutionNode<float>");
-    TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::unrolled, "UnrolledConvolutionNode<float>");
+    TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::diagonal, { "DiagonalConvolutionNode<float>" });
+    TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::simple, { "SimpleConvolutionNode<float>" });
+    TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::winograd, { "WinogradConvolutionNode<float>" });
+    TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::unrolled, { "UnrolledConvolutionNode<float>" });
+
+    // Auto-tuning may pick any of the methods, but it must pick one of them
+    TestSetConvolutionMethodTransformation(model::PreferredConvolutionMethod::autotune, { "DiagonalConvolutionNode<float>", "SimpleConvolutionNode<float>", "WinogradConvolutionNode<float>", "UnrolledConvolutionNode<float>" });
+    TestSpecializedConvolutionTransformation();
+    TestConvolutionMethodCache();
+}
+
+void TestSpecializedConvolutionTransformation(bool isDepthwise)
+{
+    using namespace predictors::neural;
+
+    using ElementType = float;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using TensorType = typename Layer<ElementType>::TensorType;
+    using Shape = typename Layer<ElementType>::Shape;
+
+    const int numRows = 3;
+    const int numColumns = 6; // one block of output columns plus a remainder
+    const int numChannels = 3;
+    const int receptiveField = isDepthwise ? 3 : 1;
+    const int numFilters = isDepthwise ? numChannels : 5;
+    const size_t inputPaddingSize = receptiveField / 2;
+
+    TensorType inputWithPadding(numRows + 2 * inputPaddingSize, numColumns + 2 * inputPaddingSize, numChannels);
+    inputWithPadding.Fill(0);
+    auto input = inputWithPadding.GetSubTensor({ inputPaddingSize, inputPaddingSize, 0 }, { numRows, numColumns, numChannels });
+    input.Generate([value = 0]() mutable { return static_cast<ElementType>(value++ % 7) - 3; });
+
+    Shape outputShape = { numRows, numColumns, numFilters };
+    LayerParameters parameters{ inputWithPadding, ZeroPadding(inputPaddingSize), outputShape, NoPadding() };
+    ConvolutionalParameters convolutionalParams{ receptiveField, 1, ConvolutionMethod::unrolled, 1 };
+
+    TensorType weights(receptiveField * numFilters, receptiveField, isDepthwise ? 1 : numChannels);
+    weights.Generate([value = 0]() mutable { return static_cast<ElementType>(value++ % 5) - 2; });
+    ConvolutionalLayer<ElementType> layer(parameters, convolutionalParams, weights);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(inputWithPadding.Size());
+    auto computeNode = model.AddNode<nodes::ConvolutionalLayerNode<ElementType>>(inputNode->output, layer);
+    auto map = model::Map(model, { { "input", inputNode } }, { { "output", computeNode->output } });
+
+    auto inputValues = inputWithPadding.ToArray();
+    map.SetInputValue("input", inputValues);
+    auto referenceOutput = map.ComputeOutput<ElementType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    passes::SetConvolutionMethodTransformation setConvMethod;
+    auto specializedMap = map;
+    specializedMap.Transform(setConvMethod, context);
+    specializedMap.Prune();
+
+    std::string expectedTypeName = isDepthwise ? "DepthwiseConvolutionNode<float>" : "PointwiseConvolutionNode<float>";
+    testing::ProcessTest("Testing SetConvolutionMethodTransformation chooses " + expectedTypeName, HasNodeWithTypeName(specializedMap.GetModel(), expectedTypeName));
+
+    specializedMap.SetInputValue("input", inputValues);
+    auto specializedOutput = specializedMap.ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing " + expectedTypeName + " compute", testing::IsEqual(referenceOutput, specializedOutput));
+
+    auto compiledMap = compiler.Compile(specializedMap);
+    compiledMap.SetInputValue("input", inputValues);
+    auto compiledOutput = compiledMap.ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing " + expectedTypeName + " compile", testing::IsEqual(referenceOutput, compiledOutput));
+}
+
+void TestSpecializedConvolutionTransformation()
+{
+    TestSpecializedConvolutionTransformation(true);
+    TestSpecializedConvolutionTransformation(false);
 }
 
 void TestOptimizeReorderDataNodesTransformation1()
@@ -470,3 +699,1244 @@ void TestOptimizeReorderDataNodesTransformation()
     TestOptimizeReorderDataNodesTransformation3();
     TestOptimizeReorderDataNodesTransformation4();
 }
+
+void TestQuantizeLayersTransformation()
+{
+    using namespace predictors::neural;
+
+    using ElementType = float;
+    using LayerParameters = typename Layer<ElementType>::LayerParameters;
+    using TensorType = typename Layer<ElementType>::TensorType;
+    using MatrixType = typename Layer<ElementType>::MatrixType;
+    using Shape = typename Layer<ElementType>::Shape;
+
+    // input -> 3x3 convolution -> fully-connected
+    const int numRows = 4;
+    const int numColumns = 4;
+    const int numChannels = 2;
+    const int numFilters = 3;
+    const int numOutputs = 5;
+    const size_t inputPaddingSize = 1;
+    TensorType inputWithPadding(numRows + 2 * inputPaddingSize, numColumns + 2 * inputPaddingSize, numChannels);
+    inputWithPadding.Fill(0);
+
+    auto nextWeight = Increment<int>(0);
+    auto weightValue = [&nextWeight]() { return static_cast<ElementType>(std::sin(0.7 * nextWeight())); };
+
+    LayerParameters convParameters{ inputWithPadding, ZeroPadding(inputPaddingSize), Shape{ numRows, numColumns, numFilters }, NoPadding() };
+    ConvolutionalParameters convolutionalParams{ 3, 1, ConvolutionMethod::automatic, 1 };
+    TensorType convWeights(convolutionalParams.receptiveField * numFilters, convolutionalParams.receptiveField, numChannels);
+    convWeights.Generate(weightValue);
+    ConvolutionalLayer<ElementType> convLayer(convParameters, convolutionalParams, convWeights);
+
+    TensorType convOutput(numRows, numColumns, numFilters);
+    LayerParameters fullyConnectedParameters{ convOutput, NoPadding(), Shape{ 1, 1, numOutputs }, NoPadding() };
+    MatrixType fullyConnectedWeights(numOutputs, numRows * numColumns * numFilters);
+    fullyConnectedWeights.Generate(weightValue);
+    FullyConnectedLayer<ElementType> fullyConnectedLayer(fullyConnectedParameters, fullyConnectedWeights);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(inputWithPadding.Size());
+    auto convNode = model.AddNode<nodes::ConvolutionalLayerNode<ElementType>>(inputNode->output, convLayer);
+    auto fullyConnectedNode = model.AddNode<nodes::FullyConnectedLayerNode<ElementType>>(convNode->output, fullyConnectedLayer);
+    model::Map map(model, { { "input", inputNode } }, { { "output", fullyConnectedNode->output } });
+
+    // Calibration samples, with zeros in the padding
+    std::vector<std::vector<ElementType>> samples;
+    for (int sampleIndex = 0; sampleIndex < 4; ++sampleIndex)
+    {
+        auto sample = inputWithPadding;
+        auto nextValue = Increment<int>(sampleIndex);
+        sample.GetSubTensor({ inputPaddingSize, inputPaddingSize, 0 }, { numRows, numColumns, numChannels }).Generate([&nextValue]() { return static_cast<ElementType>(std::cos(0.3 * nextValue())); });
+        samples.push_back(sample.ToArray());
+    }
+
+    map.SetInputValue("input", samples[0]);
+    auto referenceOutput = map.ComputeOutput<ElementType>("output");
+
+    passes::CalibrateQuantization(map, samples);
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["quantizeLayers"] = true;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    QuantizeLayersTransformation quantizeLayers;
+    map.Transform(quantizeLayers, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    testing::ProcessTest("Testing quantized convolution node created", HasNodeWithTypeName(map.GetModel(), nodes::QuantizedConvolutionalLayerNode<ElementType>::GetTypeName()));
+    testing::ProcessTest("Testing quantized fully-connected node created", HasNodeWithTypeName(map.GetModel(), nodes::QuantizedFullyConnectedLayerNode<ElementType>::GetTypeName()));
+
+    // 8-bit quantization keeps the result within a few percent of the largest output
+    map.SetInputValue("input", samples[0]);
+    auto quantizedOutput = map.ComputeOutput<ElementType>("output");
+    auto maxOutput = std::abs(*std::max_element(referenceOutput.begin(), referenceOutput.end(), [](ElementType a, ElementType b) { return std::abs(a) < std::abs(b); }));
+    testing::ProcessTest("Testing quantized result", testing::IsEqual(referenceOutput, quantizedOutput, 0.05f * maxOutput));
+
+    // The compiled code does the same integer arithmetic, so it should match the computed result closely
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", samples[0]);
+    auto compiledOutput = compiledMap.ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing compiled quantized result", testing::IsEqual(quantizedOutput, compiledOutput, 1.0e-5f * maxOutput));
+}
+
+template <typename RecurrentNodeType>
+void TestQuantizeRecurrentLayerTransformation(int stackHeight, const std::string& expectedCellName)
+{
+    using ElementType = float;
+    using namespace predictors::neural;
+
+    const size_t inputSize = 6;
+    const size_t hiddenUnits = 8;
+    const size_t stackSize = stackHeight * hiddenUnits;
+    const int sequenceLength = 10;
+
+    auto nextWeight = Increment<int>(0);
+    auto weightValue = [&nextWeight]() { return static_cast<ElementType>(0.5 * std::sin(0.7 * nextWeight())); };
+    std::vector<ElementType> inputWeights(stackSize * inputSize);
+    std::vector<ElementType> hiddenWeights(stackSize * hiddenUnits);
+    std::vector<ElementType> inputBias(stackSize);
+    std::vector<ElementType> hiddenBias(stackSize);
+    for (auto values : { &inputWeights, &hiddenWeights, &inputBias, &hiddenBias })
+    {
+        std::generate(values->begin(), values->end(), weightValue);
+    }
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(inputSize);
+    auto resetTriggerNode = model.AddNode<nodes::ConstantNode<int>>(0);
+    auto inputWeightsNode = model.AddNode<nodes::ConstantNode<ElementType>>(inputWeights);
+    auto hiddenWeightsNode = model.AddNode<nodes::ConstantNode<ElementType>>(hiddenWeights);
+    auto inputBiasNode = model.AddNode<nodes::ConstantNode<ElementType>>(inputBias);
+    auto hiddenBiasNode = model.AddNode<nodes::ConstantNode<ElementType>>(hiddenBias);
+    Activation<ElementType> activation(new TanhActivation<ElementType>());
+    Activation<ElementType> recurrentActivation(new SigmoidActivation<ElementType>());
+    auto recurrentNode = model.AddNode<RecurrentNodeType>(inputNode->output, resetTriggerNode->output, hiddenUnits, inputWeightsNode->output, hiddenWeightsNode->output, inputBiasNode->output, hiddenBiasNode->output, activation, recurrentActivation);
+    model::Map map(model, { { "input", inputNode } }, { { "output", recurrentNode->output } });
+
+    std::vector<std::vector<ElementType>> samples;
+    for (int step = 0; step < sequenceLength; ++step)
+    {
+        std::vector<ElementType> sample(inputSize);
+        auto nextValue = Increment<int>(step * static_cast<int>(inputSize));
+        std::generate(sample.begin(), sample.end(), [&nextValue]() { return static_cast<ElementType>(2 * std::cos(0.3 * nextValue())); });
+        samples.push_back(sample);
+    }
+
+    auto runSequence = [&samples](auto& map) {
+        map.Reset();
+        std::vector<std::vector<ElementType>> result;
+        for (const auto& sample : samples)
+        {
+            map.SetInputValue("input", sample);
+            result.push_back(map.template ComputeOutput<ElementType>("output"));
+        }
+        return result;
+    };
+
+    auto referenceOutput = runSequence(map);
+    map.Reset();
+    passes::CalibrateQuantization(map, samples);
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["quantizeLayers"] = true;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    QuantizeLayersTransformation quantizeLayers;
+    map.Transform(quantizeLayers, context);
+    map.Prune();
+
+    testing::ProcessTest("Testing quantized " + expectedCellName + " node created", HasNodeWithTypeName(map.GetModel(), nodes::QuantizedRecurrentLayerNode<ElementType>::GetTypeName()));
+
+    // The hidden state is within [-1, 1], and 8-bit quantization keeps it within a few hundredths of the original over the sequence
+    auto quantizedOutput = runSequence(map);
+    bool ok = true;
+    for (int step = 0; step < sequenceLength; ++step)
+    {
+        ok = ok && testing::IsEqual(referenceOutput[step], quantizedOutput[step], 0.05f);
+    }
+    testing::ProcessTest("Testing quantized " + expectedCellName + " result", ok);
+
+    // The compiled code does the same integer arithmetic and table lookups
+    auto compiledMap = compiler.Compile(map);
+    auto compiledOutput = runSequence(compiledMap);
+    ok = true;
+    for (int step = 0; step < sequenceLength; ++step)
+    {
+        ok = ok && testing::IsEqual(quantizedOutput[step], compiledOutput[step], 1.0e-3f);
+    }
+    testing::ProcessTest("Testing compiled quantized " + expectedCellName + " result", ok);
+}
+
+void TestQuantizeRecurrentLayersTransformation()
+{
+    // The LSTM has 4 stacked gates, and the GRU 3
+    TestQuantizeRecurrentLayerTransformation<nodes::LSTMNode<float>>(4, "LSTM");
+    TestQuantizeRecurrentLayerTransformation<nodes::GRUNode<float>>(3, "GRU");
+}
+
+void TestConvertDSPNodesToFixedPointTransformation()
+{
+    using ElementType = float;
+
+    // input -> preemphasis -> Hamming window -> FFT -> mel filter bank -> DCT
+    const size_t windowSize = 400;
+    const size_t fftSize = 512;
+    const size_t numFilters = 40;
+    const size_t numCoefficients = 13;
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(windowSize);
+    auto preemphasisNode = model.AddNode<nodes::IIRFilterNode<ElementType>>(inputNode->output, std::vector<ElementType>{ 1.0f, -0.97f }, std::vector<ElementType>{});
+    auto windowNode = model.AddNode<nodes::HammingWindowNode<ElementType>>(preemphasisNode->output);
+    auto fftNode = model.AddNode<nodes::FFTNode<ElementType>>(windowNode->output, fftSize);
+    auto filterBankNode = model.AddNode<nodes::MelFilterBankNode<ElementType>>(fftNode->output, dsp::MelFilterBank(fftSize, 16000, fftSize, numFilters));
+    auto dctNode = model.AddNode<nodes::DCTNode<ElementType>>(filterBankNode->output, numCoefficients);
+    model::Map map(model, { { "input", inputNode } }, { { "output", dctNode->output } });
+
+    std::vector<ElementType> input(windowSize);
+    for (size_t index = 0; index < windowSize; ++index)
+    {
+        input[index] = static_cast<ElementType>(0.4 * std::sin(0.13 * index) + 0.2 * std::sin(1.1 * index));
+    }
+    map.SetInputValue("input", input);
+    auto referenceOutput = map.ComputeOutput<ElementType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["fixedPointDSP"] = std::string("q10.21"); // 32 bits, with integer bits for the spectrum magnitudes
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    ConvertDSPNodesToFixedPointTransformation convertToFixedPoint;
+    map.Transform(convertToFixedPoint, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    testing::ProcessTest("Testing fixed-point IIR filter node created", HasNodeWithTypeName(map.GetModel(), nodes::FixedPointIIRFilterNode<ElementType>::GetTypeName()));
+    testing::ProcessTest("Testing fixed-point window node created", HasNodeWithTypeName(map.GetModel(), nodes::FixedPointWindowNode<ElementType>::GetTypeName()));
+    testing::ProcessTest("Testing fixed-point FFT node created", HasNodeWithTypeName(map.GetModel(), nodes::FixedPointFFTNode<ElementType>::GetTypeName()));
+    testing::ProcessTest("Testing fixed-point filter bank node created", HasNodeWithTypeName(map.GetModel(), nodes::FixedPointFilterBankNode<ElementType>::GetTypeName()));
+    testing::ProcessTest("Testing fixed-point DCT node created", HasNodeWithTypeName(map.GetModel(), nodes::FixedPointDCTNode<ElementType>::GetTypeName()));
+
+    // 32-bit fixed point keeps the result within a small fraction of the largest output
+    map.SetInputValue("input", input);
+    auto fixedPointOutput = map.ComputeOutput<ElementType>("output");
+    auto maxOutput = std::abs(*std::max_element(referenceOutput.begin(), referenceOutput.end(), [](ElementType a, ElementType b) { return std::abs(a) < std::abs(b); }));
+    testing::ProcessTest("Testing fixed-point result", testing::IsEqual(referenceOutput, fixedPointOutput, 1.0e-4f * maxOutput));
+
+    // The compiled code does the same integer arithmetic
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", input);
+    auto compiledOutput = compiledMap.ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing compiled fixed-point result", testing::IsEqual(fixedPointOutput, compiledOutput, 1.0e-6f * maxOutput));
+}
+
+void TestFuseAudioFrontEndTransformation()
+{
+    using ElementType = float;
+
+    // input -> Hamming window -> FFT -> square -> divide -> mel filter bank -> add -> log -> DCT
+    const size_t windowSize = 400;
+    const size_t fftSize = 512;
+    const size_t numFilters = 40;
+    const size_t numCoefficients = 13;
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(windowSize);
+    auto windowNode = model.AddNode<nodes::HammingWindowNode<ElementType>>(inputNode->output);
+    auto fftNode = model.AddNode<nodes::FFTNode<ElementType>>(windowNode->output, fftSize);
+    auto squareNode = model.AddNode<nodes::UnaryOperationNode<ElementType>>(fftNode->output, nodes::UnaryOperationType::square);
+    auto divisorNode = model.AddNode<nodes::ConstantNode<ElementType>>(std::vector<ElementType>(fftSize / 2, static_cast<ElementType>(fftSize)));
+    auto divideNode = model.AddNode<nodes::BinaryOperationNode<ElementType>>(squareNode->output, divisorNode->output, nodes::BinaryOperationType::divide);
+    auto filterBankNode = model.AddNode<nodes::MelFilterBankNode<ElementType>>(divideNode->output, dsp::MelFilterBank(fftSize / 2, 16000, fftSize, numFilters));
+    auto offsetNode = model.AddNode<nodes::ConstantNode<ElementType>>(std::vector<ElementType>(numFilters, 1.0f));
+    auto addNode = model.AddNode<nodes::BinaryOperationNode<ElementType>>(filterBankNode->output, offsetNode->output, nodes::BinaryOperationType::add);
+    auto logNode = model.AddNode<nodes::UnaryOperationNode<ElementType>>(addNode->output, nodes::UnaryOperationType::log);
+    auto dctNode = model.AddNode<nodes::DCTNode<ElementType>>(logNode->output, numCoefficients);
+    model::Map map(model, { { "input", inputNode } }, { { "output", dctNode->output } });
+
+    std::vector<ElementType> input(windowSize);
+    for (size_t index = 0; index < windowSize; ++index)
+    {
+        input[index] = static_cast<ElementType>(0.4 * std::sin(0.13 * index) + 0.2 * std::sin(1.1 * index));
+    }
+    map.SetInputValue("input", input);
+    auto referenceOutput = map.ComputeOutput<ElementType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    FuseAudioFrontEndTransformation fuseAudioFrontEnd;
+    map.Transform(fuseAudioFrontEnd, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    testing::ProcessTest("Testing audio front-end node created", HasNodeWithTypeName(map.GetModel(), nodes::AudioFrontEndNode<ElementType>::GetTypeName()));
+    testing::ProcessTest("Testing FFT node removed", !HasNodeWithTypeName(map.GetModel(), nodes::FFTNode<ElementType>::GetTypeName()));
+    testing::ProcessTest("Testing DCT node removed", !HasNodeWithTypeName(map.GetModel(), nodes::DCTNode<ElementType>::GetTypeName()));
+
+    map.SetInputValue("input", input);
+    auto fusedOutput = map.ComputeOutput<ElementType>("output");
+    auto maxOutput = std::abs(*std::max_element(referenceOutput.begin(), referenceOutput.end(), [](ElementType a, ElementType b) { return std::abs(a) < std::abs(b); }));
+    testing::ProcessTest("Testing fused audio front-end result", testing::IsEqual(referenceOutput, fusedOutput, 1.0e-4f * maxOutput));
+
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", input);
+    auto compiledOutput = compiledMap.ComputeOutput<ElementType>("output");
+    testing::ProcessTest("Testing compiled fused audio front-end result", testing::IsEqual(referenceOutput, compiledOutput, 1.0e-4f * maxOutput));
+}
+
+void TestFlattenForestsTransformation()
+{
+    using SplitAction = predictors::SimpleForestPredictor::SplitAction;
+    using SplitRule = predictors::SingleElementThresholdPredictor;
+    using EdgePredictorVector = std::vector<predictors::ConstantPredictor>;
+
+    // Six trees of different shapes, so the compiled code has a full group of trees and a partial one
+    const int numFeatures = 3;
+    const int numTrees = 6;
+    predictors::SimpleForestPredictor forest;
+    for (int tree = 0; tree < numTrees; ++tree)
+    {
+        auto offset = 0.1 * tree;
+        auto root = forest.Split(SplitAction{ forest.GetNewRootId(), SplitRule{ static_cast<size_t>(tree % numFeatures), 0.3 + offset }, EdgePredictorVector{ -1.0 - offset, 1.0 + offset } });
+        if (tree % 2 == 0)
+        {
+            auto child = forest.Split(SplitAction{ forest.GetChildId(root, 0), SplitRule{ 1, 0.6 - offset }, EdgePredictorVector{ -2.0, 2.0 } });
+            forest.Split(SplitAction{ forest.GetChildId(child, 1), SplitRule{ 2, 0.4 }, EdgePredictorVector{ -2.1, 2.1 } });
+        }
+        if (tree % 3 == 0)
+        {
+            forest.Split(SplitAction{ forest.GetChildId(root, 1), SplitRule{ 2, 0.9 - offset }, EdgePredictorVector{ -4.0, 4.0 } });
+        }
+    }
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(numFeatures);
+    auto forestNode = model.AddNode<nodes::SimpleForestPredictorNode>(inputNode->output, forest);
+    model::Map map(model, { { "input", inputNode } }, { { "output", forestNode->output } });
+
+    std::vector<std::vector<double>> samples;
+    std::vector<double> referenceOutputs;
+    for (int sampleIndex = 0; sampleIndex < 20; ++sampleIndex)
+    {
+        std::vector<double> sample(numFeatures);
+        for (int feature = 0; feature < numFeatures; ++feature)
+        {
+            sample[feature] = 0.5 + 0.5 * std::sin(1.3 * sampleIndex + feature);
+        }
+        map.SetInputValue("input", sample);
+        referenceOutputs.push_back(map.ComputeOutput<double>("output")[0]);
+        samples.push_back(sample);
+    }
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["flattenForests"] = true;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    FlattenForestsTransformation flattenForests;
+    map.Transform(flattenForests, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    testing::ProcessTest("Testing flat forest node created", HasNodeWithTypeName(map.GetModel(), nodes::FlatForestPredictorNode::GetTypeName()));
+
+    auto compiledMap = compiler.Compile(map);
+    std::vector<double> computedOutputs;
+    std::vector<double> compiledOutputs;
+    for (const auto& sample : samples)
+    {
+        map.SetInputValue("input", sample);
+        computedOutputs.push_back(map.ComputeOutput<double>("output")[0]);
+        compiledMap.SetInputValue("input", sample);
+        compiledOutputs.push_back(compiledMap.ComputeOutput<double>("output")[0]);
+    }
+    testing::ProcessTest("Testing flat forest computed result", testing::IsEqual(referenceOutputs, computedOutputs));
+    testing::ProcessTest("Testing flat forest compiled result", testing::IsEqual(referenceOutputs, compiledOutputs));
+}
+
+namespace
+{
+// Returns the reference output and the output after layout propagation of a map with a single input and output
+template <typename ValueType>
+std::pair<std::vector<ValueType>, std::vector<ValueType>> RunPropagateLayoutsTransformation(model::Map& map, int inputSize)
+{
+    std::vector<ValueType> input(inputSize);
+    std::generate(input.begin(), input.end(), Increment<ValueType>(-5.0f));
+    map.SetInputValue("input", input);
+    auto referenceOutput = map.ComputeOutput<ValueType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    optimizerOptions["propagateLayouts"] = true;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    PropagateLayoutsTransformation propagateLayouts;
+    map.Transform(propagateLayouts, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    map.SetInputValue("input", input);
+    return { referenceOutput, map.ComputeOutput<ValueType>("output") };
+}
+} // namespace
+
+void TestPropagateLayoutsTransformation()
+{
+    using ValueType = float;
+    model::PortMemoryLayout channelMajorLayout(model::MemoryShape{ 3, 4, 2 }, model::DimensionOrder{ 2, 0, 1 });
+    model::PortMemoryLayout interleavedLayout(model::MemoryShape{ 3, 4, 2 });
+    const int size = static_cast<int>(interleavedLayout.NumElements());
+
+    // input -> reorder -> abs -> square -> reorder back: the operations can run in the input's layout
+    {
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ValueType>>(size);
+        auto toInterleaved = model.AddNode<nodes::ReorderDataNode<ValueType>>(inputNode->output, channelMajorLayout, interleavedLayout);
+        const auto& abs = nodes::Abs(toInterleaved->output);
+        const auto& square = nodes::Square(abs);
+        auto toChannelMajor = model.AddNode<nodes::ReorderDataNode<ValueType>>(square, interleavedLayout, channelMajorLayout);
+        model::Map map(model, { { "input", inputNode } }, { { "output", toChannelMajor->output } });
+
+        auto outputs = RunPropagateLayoutsTransformation<ValueType>(map, size);
+        testing::ProcessTest("Testing layout propagation removes reorders", map.GetModel().GetNodesByType<nodes::ReorderDataNode<ValueType>>().empty());
+        testing::ProcessTest("Testing layout propagation result", testing::IsEqual(outputs.first, outputs.second));
+    }
+
+    // input -> reorder -> abs -> { output, reorder back -> exp }: one reorder is still needed, but only one
+    {
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ValueType>>(size);
+        auto toInterleaved = model.AddNode<nodes::ReorderDataNode<ValueType>>(inputNode->output, channelMajorLayout, interleavedLayout);
+        const auto& abs = nodes::Abs(toInterleaved->output);
+        auto toChannelMajor = model.AddNode<nodes::ReorderDataNode<ValueType>>(abs, interleavedLayout, channelMajorLayout);
+        auto toChannelMajor2 = model.AddNode<nodes::ReorderDataNode<ValueType>>(toChannelMajor->output, channelMajorLayout, interleavedLayout);
+        auto toChannelMajor3 = model.AddNode<nodes::ReorderDataNode<ValueType>>(toChannelMajor2->output, interleavedLayout, channelMajorLayout);
+        const auto& exp = nodes::Exp(toChannelMajor3->output);
+        const auto& sum = nodes::Add(abs, nodes::Sqrt(exp));
+        model::Map map(model, { { "input", inputNode } }, { { "output", sum } });
+
+        auto outputs = RunPropagateLayoutsTransformation<ValueType>(map, size);
+        testing::ProcessTest("Testing layout propagation leaves one reorder", map.GetModel().GetNodesByType<nodes::ReorderDataNode<ValueType>>().size() == 1);
+        testing::ProcessTest("Testing layout propagation result with a fixed consumer", testing::IsEqual(outputs.first, outputs.second));
+    }
+}
+
+namespace
+{
+// input .* reorder(reorder(sqrt(a) + b)): everything but the multiply can be folded
+template <typename ValueType>
+model::Map GenerateConstantSubgraphModel()
+{
+    model::PortMemoryLayout rowMajorLayout(model::MemoryShape{ 2, 3 });
+    model::PortMemoryLayout columnMajorLayout(model::MemoryShape{ 2, 3 }, model::DimensionOrder{ 1, 0 });
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(rowMajorLayout);
+    auto a = model.AddNode<nodes::ConstantNode<ValueType>>(std::vector<ValueType>{ 1, 4, 9, 16, 25, 36 }, rowMajorLayout);
+    auto b = model.AddNode<nodes::ConstantNode<ValueType>>(std::vector<ValueType>{ 1, 1, 1, 2, 2, 2 }, rowMajorLayout);
+    const auto& sum = nodes::Add(nodes::Sqrt(a->output), b->output);
+    auto toColumnMajor = model.AddNode<nodes::ReorderDataNode<ValueType>>(sum, rowMajorLayout, columnMajorLayout);
+    auto toRowMajor = model.AddNode<nodes::ReorderDataNode<ValueType>>(toColumnMajor->output, columnMajorLayout, rowMajorLayout);
+    const auto& product = nodes::Multiply(inputNode->output, toRowMajor->output);
+    return model::Map(model, { { "input", inputNode } }, { { "output", product } });
+}
+} // namespace
+
+void TestFoldConstantsTransformation()
+{
+    using ValueType = float;
+    std::vector<ValueType> input(6);
+    std::generate(input.begin(), input.end(), Increment<ValueType>(-2.0f));
+
+    for (bool foldConstants : { true, false })
+    {
+        auto map = GenerateConstantSubgraphModel<ValueType>();
+        map.SetInputValue("input", input);
+        auto referenceOutput = map.ComputeOutput<ValueType>("output");
+        auto oldSize = map.GetModel().Size();
+
+        model::MapCompilerOptions settings;
+        model::ModelOptimizerOptions optimizerOptions;
+        optimizerOptions["foldConstants"] = foldConstants;
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        model::TransformContext context(&compiler);
+        FoldConstantsTransformation foldConstantsTransformation;
+        map.Transform(foldConstantsTransformation, context);
+        map.Prune();
+
+#if PRINT_MODELS
+        PrintModel(map.GetModel());
+#endif
+
+        const auto& newModel = map.GetModel();
+        if (foldConstants)
+        {
+            // input, the folded constant, multiply and output remain
+            bool isFolded = newModel.GetNodesByType<nodes::ConstantNode<ValueType>>().size() == 1 &&
+                            newModel.GetNodesByType<nodes::ReorderDataNode<ValueType>>().empty() &&
+                            newModel.GetNodesByType<nodes::UnaryOperationNode<ValueType>>().empty() &&
+                            newModel.GetNodesByType<nodes::BinaryOperationNode<ValueType>>().size() == 1;
+            testing::ProcessTest("Testing FoldConstantsTransformation folds constant subgraph", isFolded && newModel.Size() < oldSize);
+        }
+        else
+        {
+            testing::ProcessTest("Testing FoldConstantsTransformation can be disabled", newModel.Size() == oldSize);
+        }
+
+        map.SetInputValue("input", input);
+        auto computedOutput = map.ComputeOutput<ValueType>("output");
+        auto compiledMap = compiler.Compile(map);
+        compiledMap.SetInputValue("input", input);
+        auto compiledOutput = compiledMap.ComputeOutput<ValueType>("output");
+        testing::ProcessTest("Testing FoldConstantsTransformation result", testing::IsEqual(referenceOutput, computedOutput) && testing::IsEqual(referenceOutput, compiledOutput));
+    }
+}
+
+void TestEliminateCommonSubexpressionsTransformation()
+{
+    using ValueType = float;
+    model::PortMemoryLayout rowMajorLayout(model::MemoryShape{ 2, 3 });
+    model::PortMemoryLayout columnMajorLayout(model::MemoryShape{ 2, 3 }, model::DimensionOrder{ 1, 0 });
+    std::vector<ValueType> input(6);
+    std::generate(input.begin(), input.end(), Increment<ValueType>(-2.0f));
+
+    for (bool eliminateCommonSubexpressions : { true, false })
+    {
+        // Two copies of reorder(reorder(input) .* c), with their own constants, added together
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ValueType>>(rowMajorLayout);
+        auto c1 = model.AddNode<nodes::ConstantNode<ValueType>>(std::vector<ValueType>{ 1, 2, 3, 4, 5, 6 }, columnMajorLayout);
+        auto c2 = model.AddNode<nodes::ConstantNode<ValueType>>(std::vector<ValueType>{ 1, 2, 3, 4, 5, 6 }, columnMajorLayout);
+        auto reorder1 = model.AddNode<nodes::ReorderDataNode<ValueType>>(inputNode->output, rowMajorLayout, columnMajorLayout);
+        auto reorder2 = model.AddNode<nodes::ReorderDataNode<ValueType>>(inputNode->output, rowMajorLayout, columnMajorLayout);
+        const auto& product1 = nodes::Multiply(reorder1->output, c1->output);
+        const auto& product2 = nodes::Multiply(reorder2->output, c2->output);
+        auto backReorder1 = model.AddNode<nodes::ReorderDataNode<ValueType>>(product1, columnMajorLayout, rowMajorLayout);
+        auto backReorder2 = model.AddNode<nodes::ReorderDataNode<ValueType>>(product2, columnMajorLayout, rowMajorLayout);
+        const auto& sum = nodes::Add(backReorder1->output, backReorder2->output);
+        model::Map map(model, { { "input", inputNode } }, { { "output", sum } });
+
+        map.SetInputValue("input", input);
+        auto referenceOutput = map.ComputeOutput<ValueType>("output");
+        auto oldSize = map.GetModel().Size();
+
+        model::MapCompilerOptions settings;
+        model::ModelOptimizerOptions optimizerOptions;
+        optimizerOptions["eliminateCommonSubexpressions"] = eliminateCommonSubexpressions;
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        model::TransformContext context(&compiler);
+        EliminateCommonSubexpressionsTransformation cseTransformation;
+        map.Transform(cseTransformation, context);
+        map.Prune();
+
+#if PRINT_MODELS
+        PrintModel(map.GetModel());
+#endif
+
+        const auto& newModel = map.GetModel();
+        if (eliminateCommonSubexpressions)
+        {
+            // input, constant, reorder, multiply, reorder back, add and output remain
+            bool isMerged = newModel.GetNodesByType<nodes::ConstantNode<ValueType>>().size() == 1 &&
+                            newModel.GetNodesByType<nodes::ReorderDataNode<ValueType>>().size() == 2 &&
+                            newModel.GetNodesByType<nodes::BinaryOperationNode<ValueType>>().size() == 2;
+            testing::ProcessTest("Testing EliminateCommonSubexpressionsTransformation merges duplicate nodes", isMerged && newModel.Size() < oldSize);
+        }
+        else
+        {
+            testing::ProcessTest("Testing EliminateCommonSubexpressionsTransformation can be disabled", newModel.Size() == oldSize);
+        }
+
+        map.SetInputValue("input", input);
+        auto computedOutput = map.ComputeOutput<ValueType>("output");
+        auto compiledMap = compiler.Compile(map);
+        compiledMap.SetInputValue("input", input);
+        auto compiledOutput = compiledMap.ComputeOutput<ValueType>("output");
+        testing::ProcessTest("Testing EliminateCommonSubexpressionsTransformation result", testing::IsEqual(referenceOutput, computedOutput) && testing::IsEqual(referenceOutput, compiledOutput));
+    }
+}
+
+namespace
+{
+// Appends BatchNormalization, Scaling and Bias layers to a layer with the given output shape
+template <typename ValueType>
+const model::OutputPort<ValueType>& AddLinearLayers(const model::OutputPort<ValueType>& input, const typename predictors::neural::Layer<ValueType>::Shape& shape, bool addScalingAndBias)
+{
+    using namespace predictors::neural;
+    using LayerParameters = typename Layer<ValueType>::LayerParameters;
+    using TensorType = typename Layer<ValueType>::TensorType;
+    using VectorType = typename Layer<ValueType>::VectorType;
+
+    auto numChannels = shape.NumChannels();
+    TensorType layerInput(shape);
+    LayerParameters parameters{ layerInput, NoPadding(), shape, NoPadding() };
+    VectorType mean(numChannels);
+    VectorType variance(numChannels);
+    VectorType scale(numChannels);
+    VectorType bias(numChannels);
+    mean.Generate(Increment<ValueType>(-1));
+    variance.Generate(Increment<ValueType>(static_cast<ValueType>(0.5)));
+    scale.Generate(Increment<ValueType>(2, -1));
+    bias.Generate(Increment<ValueType>(3));
+
+    auto model = input.GetNode()->GetModel();
+    BatchNormalizationLayer<ValueType> batchNormLayer(parameters, mean, variance, static_cast<ValueType>(1e-5), EpsilonSummand::Variance);
+    const auto* output = &model->template AddNode<nodes::BatchNormalizationLayerNode<ValueType>>(input, batchNormLayer)->output;
+    if (addScalingAndBias)
+    {
+        ScalingLayer<ValueType> scalingLayer(parameters, scale);
+        output = &model->template AddNode<nodes::ScalingLayerNode<ValueType>>(*output, scalingLayer)->output;
+        BiasLayer<ValueType> biasLayer(parameters, bias);
+        output = &model->template AddNode<nodes::BiasLayerNode<ValueType>>(*output, biasLayer)->output;
+    }
+    return *output;
+}
+
+// input -> convolution -> BatchNormalization -> Scaling -> Bias
+template <typename ValueType>
+model::Map GenerateConvolutionWithLinearLayersModel()
+{
+    using namespace predictors::neural;
+    using LayerParameters = typename Layer<ValueType>::LayerParameters;
+    using TensorType = typename Layer<ValueType>::TensorType;
+    using Shape = typename Layer<ValueType>::Shape;
+
+    const size_t numRows = 4;
+    const size_t numColumns = 4;
+    const size_t numChannels = 2;
+    const size_t numFilters = 3;
+    const size_t receptiveField = 3;
+
+    TensorType input(numRows + 2, numColumns + 2, numChannels);
+    Shape outputShape = { numRows, numColumns, numFilters };
+    LayerParameters parameters{ input, ZeroPadding(1), outputShape, NoPadding() };
+    ConvolutionalParameters convolutionalParams{ receptiveField, 1, ConvolutionMethod::unrolled, 1 };
+    TensorType weights(receptiveField * numFilters, receptiveField, numChannels);
+    weights.Generate(Increment<ValueType>(-3, static_cast<ValueType>(0.25)));
+    ConvolutionalLayer<ValueType> layer(parameters, convolutionalParams, weights);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(input.Size());
+    auto convNode = model.AddNode<nodes::ConvolutionalLayerNode<ValueType>>(inputNode->output, layer);
+    const auto& output = AddLinearLayers<ValueType>(convNode->output, outputShape, true);
+    return model::Map(model, { { "input", inputNode } }, { { "output", output } });
+}
+
+// input -> fully-connected -> BatchNormalization
+template <typename ValueType>
+model::Map GenerateFullyConnectedWithLinearLayersModel()
+{
+    using namespace predictors::neural;
+    using LayerParameters = typename Layer<ValueType>::LayerParameters;
+    using MatrixType = typename Layer<ValueType>::MatrixType;
+    using TensorType = typename Layer<ValueType>::TensorType;
+    using Shape = typename Layer<ValueType>::Shape;
+
+    TensorType input(2, 2, 2);
+    Shape outputShape = { 1, 2, 3 };
+    LayerParameters parameters{ input, NoPadding(), outputShape, NoPadding() };
+    MatrixType weights(outputShape.Size(), input.Size());
+    weights.Generate(Increment<ValueType>(-4, static_cast<ValueType>(0.125)));
+    auto weightsReference = weights.GetConstReference();
+    FullyConnectedLayer<ValueType> layer(parameters, weightsReference);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(input.Size());
+    auto fullyConnectedNode = model.AddNode<nodes::FullyConnectedLayerNode<ValueType>>(inputNode->output, layer);
+    const auto& output = AddLinearLayers<ValueType>(fullyConnectedNode->output, outputShape, false);
+    return model::Map(model, { { "input", inputNode } }, { { "output", output } });
+}
+
+template <typename ValueType>
+void TestFoldLinearLayersTransformation(model::Map map, const std::string& layerType)
+{
+    std::vector<ValueType> input(map.GetInputSize(0));
+    std::generate(input.begin(), input.end(), Increment<ValueType>(-1, static_cast<ValueType>(0.125)));
+    map.SetInputValue("input", input);
+    auto referenceOutput = map.ComputeOutput<ValueType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    FoldLinearLayersTransformation foldLinearLayersTransformation;
+    map.Transform(foldLinearLayersTransformation, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    // The weights layer and a single Bias layer remain
+    const auto& newModel = map.GetModel();
+    bool isFolded = newModel.GetNodesByType<nodes::BatchNormalizationLayerNode<ValueType>>().empty() &&
+                    newModel.GetNodesByType<nodes::ScalingLayerNode<ValueType>>().empty() &&
+                    newModel.GetNodesByType<nodes::BiasLayerNode<ValueType>>().size() == 1;
+    testing::ProcessTest("Testing FoldLinearLayersTransformation folds layers into " + layerType, isFolded);
+
+    map.SetInputValue("input", input);
+    auto computedOutput = map.ComputeOutput<ValueType>("output");
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", input);
+    auto compiledOutput = compiledMap.ComputeOutput<ValueType>("output");
+    testing::ProcessTest("Testing FoldLinearLayersTransformation result for " + layerType, testing::IsEqual(referenceOutput, computedOutput, static_cast<ValueType>(1e-4)) && testing::IsEqual(referenceOutput, compiledOutput, static_cast<ValueType>(1e-4)));
+}
+} // namespace
+
+void TestFoldLinearLayersTransformation()
+{
+    TestFoldLinearLayersTransformation<float>(GenerateConvolutionWithLinearLayersModel<float>(), "ConvolutionalLayer");
+    TestFoldLinearLayersTransformation<double>(GenerateFullyConnectedWithLinearLayersModel<double>(), "FullyConnectedLayer");
+}
+
+namespace
+{
+// input -> convolution -> Bias -> activation
+template <typename ValueType>
+model::Map GenerateConvolutionWithBiasAndActivationModel(predictors::neural::ConvolutionMethod method, bool leaky)
+{
+    using namespace predictors::neural;
+    using LayerParameters = typename Layer<ValueType>::LayerParameters;
+    using TensorType = typename Layer<ValueType>::TensorType;
+    using VectorType = typename Layer<ValueType>::VectorType;
+    using Shape = typename Layer<ValueType>::Shape;
+
+    const size_t numRows = 4;
+    const size_t numColumns = 4;
+    const size_t numChannels = 2;
+    const size_t numFilters = 3;
+    const size_t receptiveField = 3;
+
+    TensorType input(numRows + 2, numColumns + 2, numChannels);
+    Shape outputShape = { numRows, numColumns, numFilters };
+    LayerParameters convParameters{ input, ZeroPadding(1), outputShape, NoPadding() };
+    ConvolutionalParameters convolutionalParams{ receptiveField, 1, method, 1 };
+    TensorType weights(receptiveField * numFilters, receptiveField, numChannels);
+    weights.Generate(Increment<ValueType>(-3, static_cast<ValueType>(0.25)));
+    ConvolutionalLayer<ValueType> convLayer(convParameters, convolutionalParams, weights);
+
+    TensorType layerInput(outputShape);
+    LayerParameters parameters{ layerInput, NoPadding(), outputShape, NoPadding() };
+    VectorType bias(numFilters);
+    bias.Generate(Increment<ValueType>(-20, 10));
+    BiasLayer<ValueType> biasLayer(parameters, bias);
+    ActivationLayer<ValueType> activationLayer(parameters, leaky ? Activation<ValueType>(new LeakyReLUActivation<ValueType>(static_cast<ValueType>(0.1))) : Activation<ValueType>(new ReLUActivation<ValueType>()));
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(input.Size());
+    auto convNode = model.AddNode<nodes::ConvolutionalLayerNode<ValueType>>(inputNode->output, convLayer);
+    auto biasNode = model.AddNode<nodes::BiasLayerNode<ValueType>>(convNode->output, biasLayer);
+    auto activationNode = model.AddNode<nodes::ActivationLayerNode<ValueType>>(biasNode->output, activationLayer);
+    return model::Map(model, { { "input", inputNode } }, { { "output", activationNode->output } });
+}
+
+template <typename ValueType>
+void TestFuseConvolutionEpilogueTransformation(predictors::neural::ConvolutionMethod method, bool leaky, const std::string& description)
+{
+    model::Map map = GenerateConvolutionWithBiasAndActivationModel<ValueType>(method, leaky);
+    std::vector<ValueType> input(map.GetInputSize(0));
+    std::generate(input.begin(), input.end(), Increment<ValueType>(-1, static_cast<ValueType>(0.125)));
+    map.SetInputValue("input", input);
+    auto referenceOutput = map.ComputeOutput<ValueType>("output");
+
+    map.Refine();
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    FuseConvolutionEpilogueTransformation fuseConvolutionEpilogueTransformation;
+    map.Transform(fuseConvolutionEpilogueTransformation, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    const auto& newModel = map.GetModel();
+    bool isFused = newModel.GetNodesByType<nodes::BroadcastLinearFunctionNode<ValueType>>().empty() &&
+                   newModel.GetNodesByType<nodes::BroadcastUnaryFunctionNode<ValueType, nodes::ReLUActivationFunction<ValueType>>>().empty() &&
+                   newModel.GetNodesByType<nodes::BroadcastUnaryFunctionNode<ValueType, nodes::LeakyReLUActivationFunction<ValueType>>>().empty();
+    testing::ProcessTest("Testing FuseConvolutionEpilogueTransformation fuses bias and activation into " + description, isFused);
+
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", input);
+    auto compiledOutput = compiledMap.ComputeOutput<ValueType>("output");
+    testing::ProcessTest("Testing FuseConvolutionEpilogueTransformation result for " + description, testing::IsEqual(referenceOutput, compiledOutput, static_cast<ValueType>(1e-4)));
+}
+} // namespace
+
+void TestFuseConvolutionEpilogueTransformation()
+{
+    using predictors::neural::ConvolutionMethod;
+    TestFuseConvolutionEpilogueTransformation<float>(ConvolutionMethod::unrolled, false, "unrolled convolution");
+    TestFuseConvolutionEpilogueTransformation<double>(ConvolutionMethod::winograd, true, "Winograd convolution");
+}
+
+namespace
+{
+// input -> ReLU -> pooling
+template <typename ValueType, template <typename> class PoolingFunctionType>
+model::Map GenerateReLUPoolingModel(size_t size, size_t numChannels, size_t windowSize, size_t stride)
+{
+    using namespace predictors::neural;
+    using LayerParameters = typename Layer<ValueType>::LayerParameters;
+    using TensorType = typename Layer<ValueType>::TensorType;
+    using Shape = typename Layer<ValueType>::Shape;
+
+    const size_t outputSize = (size - windowSize) / stride + 1;
+    TensorType input(size, size, numChannels);
+    Shape inputShape = { size, size, numChannels };
+    LayerParameters activationParameters{ input, NoPadding(), inputShape, NoPadding() };
+    ActivationLayer<ValueType> activationLayer(activationParameters, Activation<ValueType>(new ReLUActivation<ValueType>()));
+
+    Shape outputShape = { outputSize, outputSize, numChannels };
+    LayerParameters poolingParameters{ input, NoPadding(), outputShape, NoPadding() };
+    PoolingLayer<ValueType, PoolingFunctionType> poolingLayer(poolingParameters, PoolingParameters{ windowSize, stride });
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(input.Size());
+    auto activationNode = model.AddNode<nodes::ActivationLayerNode<ValueType>>(inputNode->output, activationLayer);
+    auto poolingNode = model.AddNode<nodes::PoolingLayerNode<ValueType, PoolingFunctionType>>(activationNode->output, poolingLayer);
+    return model::Map(model, { { "input", inputNode } }, { { "output", poolingNode->output } });
+}
+
+template <typename ValueType, template <typename> class PoolingFunctionType>
+void TestFusePoolingActivationTransformation(size_t windowSize, size_t stride, const std::string& description)
+{
+    model::Map map = GenerateReLUPoolingModel<ValueType, PoolingFunctionType>(6, 6, windowSize, stride);
+    std::vector<ValueType> input(map.GetInputSize(0));
+    std::generate(input.begin(), input.end(), Increment<ValueType>(-10, static_cast<ValueType>(0.1)));
+    std::reverse(input.begin() + input.size() / 2, input.end());
+    map.SetInputValue("input", input);
+    auto referenceOutput = map.ComputeOutput<ValueType>("output");
+
+    map.Refine();
+
+    // Vector instructions cover the vectorized channels (6 channels are a vector of 4 and 2 more)
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.allowVectorInstructions = true;
+    settings.compilerSettings.vectorWidth = 4;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    FusePoolingActivationTransformation fusePoolingActivationTransformation;
+    map.Transform(fusePoolingActivationTransformation, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    const auto& newModel = map.GetModel();
+    auto poolingNodes = newModel.GetNodesByType<nodes::PoolingLayerNode<ValueType, PoolingFunctionType>>();
+    bool isFused = newModel.GetNodesByType<nodes::BroadcastUnaryFunctionNode<ValueType, nodes::ReLUActivationFunction<ValueType>>>().empty() &&
+                   poolingNodes.size() == 1 && poolingNodes[0]->RectifiesInput();
+    testing::ProcessTest("Testing FusePoolingActivationTransformation fuses ReLU into " + description, isFused);
+
+    map.SetInputValue("input", input);
+    auto computedOutput = map.ComputeOutput<ValueType>("output");
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", input);
+    auto compiledOutput = compiledMap.ComputeOutput<ValueType>("output");
+    testing::ProcessTest("Testing FusePoolingActivationTransformation result for " + description, testing::IsEqual(referenceOutput, computedOutput, static_cast<ValueType>(1e-5)) && testing::IsEqual(referenceOutput, compiledOutput, static_cast<ValueType>(1e-5)));
+}
+} // namespace
+
+void TestFusePoolingActivationTransformation()
+{
+    using predictors::neural::MaxPoolingFunction;
+    using predictors::neural::MeanPoolingFunction;
+    TestFusePoolingActivationTransformation<float, MaxPoolingFunction>(2, 2, "max pooling");
+    TestFusePoolingActivationTransformation<float, MaxPoolingFunction>(4, 1, "separable max pooling");
+    TestFusePoolingActivationTransformation<double, MeanPoolingFunction>(2, 2, "mean pooling");
+    TestFusePoolingActivationTransformation<float, MeanPoolingFunction>(6, 1, "global mean pooling");
+}
+
+void TestFuseSoftmaxTopKTransformation()
+{
+    using namespace predictors::neural;
+    using ValueType = float;
+    using LayerParameters = typename Layer<ValueType>::LayerParameters;
+    using TensorType = typename Layer<ValueType>::TensorType;
+    using Shape = typename Layer<ValueType>::Shape;
+
+    // input -> softmax over 37 classes -> top 5
+    const size_t numClasses = 37;
+    const size_t k = 5;
+    TensorType layerInput(1, 1, numClasses);
+    LayerParameters parameters{ layerInput, NoPadding(), Shape{ 1, 1, numClasses }, NoPadding() };
+    SoftmaxLayer<ValueType> softmaxLayer(parameters);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(numClasses);
+    auto softmaxNode = model.AddNode<nodes::SoftmaxLayerNode<ValueType>>(inputNode->output, softmaxLayer);
+    auto topKNode = model.AddNode<nodes::TopKNode<ValueType>>(softmaxNode->output, k);
+    model::Map map(model, { { "input", inputNode } }, { { "values", topKNode->values }, { "indices", topKNode->indices } });
+
+    std::vector<ValueType> input(numClasses);
+    for (size_t index = 0; index < numClasses; ++index)
+    {
+        input[index] = static_cast<ValueType>(3 * std::sin(0.7 * index));
+    }
+    map.SetInputValue("input", input);
+    auto referenceValues = map.ComputeOutput<ValueType>("values");
+    auto referenceIndices = map.ComputeOutput<int>("indices");
+
+    model::MapCompilerOptions settings;
+    settings.compilerSettings.allowVectorInstructions = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    FuseSoftmaxTopKTransformation fuseSoftmaxTopK;
+    map.Transform(fuseSoftmaxTopK, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    const auto& newModel = map.GetModel();
+    auto topKNodes = newModel.GetNodesByType<nodes::TopKNode<ValueType>>();
+    bool isFused = newModel.GetNodesByType<nodes::SoftmaxLayerNode<ValueType>>().empty() && topKNodes.size() == 1 && topKNodes[0]->NormalizesSoftmax();
+    testing::ProcessTest("Testing FuseSoftmaxTopKTransformation fuses the softmax into the top-k node", isFused);
+
+    map.SetInputValue("input", input);
+    auto computedValues = map.ComputeOutput<ValueType>("values");
+    auto computedIndices = map.ComputeOutput<int>("indices");
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", input);
+    auto compiledValues = compiledMap.ComputeOutput<ValueType>("values");
+    auto compiledIndices = compiledMap.ComputeOutput<int>("indices");
+    testing::ProcessTest("Testing FuseSoftmaxTopKTransformation result", testing::IsEqual(referenceValues, computedValues, 1e-6f) && testing::IsEqual(referenceValues, compiledValues, 1e-6f) && referenceIndices == computedIndices && referenceIndices == compiledIndices);
+}
+
+namespace
+{
+template <typename ValueType>
+void TestFuseInputPreprocessingTransformation(bool reorder, const std::string& description)
+{
+    const int numRows = 3;
+    const int numColumns = 4;
+    const int numChannels = 3;
+    model::PortMemoryLayout imageLayout({ numRows, numColumns, numChannels });
+
+    // Raw pixels -> float -> (x * scale + bias) per channel -> (optionally) channel-major order
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<int>>(imageLayout);
+    auto castNode = model.AddNode<nodes::TypeCastNode<int, ValueType>>(inputNode->output);
+    auto scaleNode = model.AddNode<nodes::ConstantNode<ValueType>>(std::vector<ValueType>{ 0.5, 0.25, 0.125 });
+    auto biasNode = model.AddNode<nodes::ConstantNode<ValueType>>(std::vector<ValueType>{ -1, -2, -3 });
+    auto linearNode = model.AddNode<nodes::BroadcastLinearFunctionNode<ValueType>>(castNode->output, imageLayout, scaleNode->output, biasNode->output, 2, imageLayout);
+    const model::OutputPort<ValueType>* output = &linearNode->output;
+    if (reorder)
+    {
+        output = &model.AddNode<nodes::ReorderDataNode<ValueType>>(linearNode->output, model::DimensionOrder{ 2, 0, 1 })->output;
+    }
+    model::Map map(model, { { "input", inputNode } }, { { "output", *output } });
+
+    std::vector<int> input(imageLayout.NumElements());
+    std::generate(input.begin(), input.end(), Increment<int>(0, 7));
+    map.SetInputValue("input", input);
+    auto referenceOutput = map.ComputeOutput<ValueType>("output");
+
+    model::MapCompilerOptions settings;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    model::TransformContext context(&compiler);
+    FuseInputPreprocessingTransformation fuseInputPreprocessingTransformation;
+    map.Transform(fuseInputPreprocessingTransformation, context);
+    map.Prune();
+
+#if PRINT_MODELS
+    PrintModel(map.GetModel());
+#endif
+
+    const auto& newModel = map.GetModel();
+    bool isFused = newModel.GetNodesByType<nodes::InputPreprocessingNode<int, ValueType>>().size() == 1 &&
+                   newModel.GetNodesByType<nodes::TypeCastNode<int, ValueType>>().empty() &&
+                   newModel.GetNodesByType<nodes::BroadcastLinearFunctionNode<ValueType>>().empty() &&
+                   newModel.GetNodesByType<nodes::ReorderDataNode<ValueType>>().empty();
+    testing::ProcessTest("Testing FuseInputPreprocessingTransformation fuses " + description, isFused);
+
+    map.SetInputValue("input", input);
+    auto computedOutput = map.ComputeOutput<ValueType>("output");
+    testing::ProcessTest("Testing FuseInputPreprocessingTransformation computed result for " + description, testing::IsEqual(referenceOutput, computedOutput));
+
+    auto compiledMap = compiler.Compile(map);
+    compiledMap.SetInputValue("input", input);
+    auto compiledOutput = compiledMap.ComputeOutput<ValueType>("output");
+    testing::ProcessTest("Testing FuseInputPreprocessingTransformation compiled result for " + description, testing::IsEqual(referenceOutput, compiledOutput));
+}
+} // namespace
+
+void TestFuseInputPreprocessingTransformation()
+{
+    TestFuseInputPreprocessingTransformation<float>(false, "type cast and normalization");
+    TestFuseInputPreprocessingTransformation<float>(true, "type cast, normalization and reordering");
+    TestFuseInputPreprocessingTransformation<double>(true, "type cast, normalization and reordering to double");
+}
+
+namespace
+{
+// An 8 x 8 matrix of weights that was pruned down to two rows and one other entry
+template <typename ValueType>
+std::vector<ValueType> GetPrunedWeights()
+{
+    std::vector<ValueType> weights(64, 0);
+    for (int column = 0; column < 8; ++column)
+    {
+        weights[1 * 8 + column] = static_cast<ValueType>(column + 1);
+        weights[6 * 8 + column] = static_cast<ValueType>(-column);
+    }
+    weights[3 * 8 + 5] = 2;
+    return weights;
+}
+
+// weights * input, with an 8 x 3 input, or input * weights' if `weightsOnRight`, with a 3 x 8 input
+template <typename ValueType>
+model::Map GenerateSparseWeightsModel(bool weightsOnRight)
+{
+    const int m = 8, n = 3, k = 8;
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(k * n);
+    auto weightsNode = model.AddNode<nodes::ConstantNode<ValueType>>(GetPrunedWeights<ValueType>());
+    auto productNode = weightsOnRight ? model.AddNode<nodes::MatrixMatrixMultiplyNode<ValueType>>(inputNode->output, n, m, k, k, false, weightsNode->output, k, true, m, false) : model.AddNode<nodes::MatrixMatrixMultiplyNode<ValueType>>(weightsNode->output, m, n, k, k, false, inputNode->output, n, false, n, false);
+    return model::Map(model, { { "input", inputNode } }, { { "output", productNode->output } });
+}
+} // namespace
+
+void TestSparsifyWeightsTransformation()
+{
+    using ValueType = float;
+    std::vector<ValueType> input(24);
+    std::generate(input.begin(), input.end(), Increment<ValueType>(-5.0f));
+
+    for (bool weightsOnRight : { false, true })
+    {
+        for (double density : { 0.3, 0.0 })
+        {
+            auto map = GenerateSparseWeightsModel<ValueType>(weightsOnRight);
+            map.SetInputValue("input", input);
+            auto referenceOutput = map.ComputeOutput<ValueType>("output");
+
+            model::MapCompilerOptions settings;
+            model::ModelOptimizerOptions optimizerOptions;
+            optimizerOptions["sparseWeightsDensity"] = density;
+            model::IRMapCompiler compiler(settings, optimizerOptions);
+            model::TransformContext context(&compiler);
+            SparsifyWeightsTransformation sparsifyWeightsTransformation;
+            map.Transform(sparsifyWeightsTransformation, context);
+            map.Prune();
+
+#if PRINT_MODELS
+            PrintModel(map.GetModel());
+#endif
+
+            const auto& newModel = map.GetModel();
+            auto sparseNodes = newModel.GetNodesByType<nodes::SparseMatrixMultiplyNode<ValueType>>();
+            std::string description = weightsOnRight ? " with weights on the right" : "";
+            if (density > 0)
+            {
+                // 16 of the 64 weights are nonzero, and fit in five 1 x 4 blocks
+                bool isSparse = sparseNodes.size() == 1 && sparseNodes[0]->NumStoredBlocks() == 5 &&
+                                newModel.GetNodesByType<nodes::MatrixMatrixMultiplyNode<ValueType>>().empty() &&
+                                newModel.GetNodesByType<nodes::ConstantNode<ValueType>>().empty();
+                testing::ProcessTest("Testing SparsifyWeightsTransformation replaces pruned weights" + description, isSparse);
+            }
+            else
+            {
+                testing::ProcessTest("Testing SparsifyWeightsTransformation can be disabled" + description, sparseNodes.empty());
+            }
+
+            map.SetInputValue("input", input);
+            auto computedOutput = map.ComputeOutput<ValueType>("output");
+            auto compiledMap = compiler.Compile(map);
+            compiledMap.SetInputValue("input", input);
+            auto compiledOutput = compiledMap.ComputeOutput<ValueType>("output");
+            testing::ProcessTest("Testing SparsifyWeightsTransformation result" + description, testing::IsEqual(referenceOutput, computedOutput) && testing::IsEqual(referenceOutput, compiledOutput));
+        }
+    }
+}
+
+namespace
+{
+// weights * input, with a 32 x 64 matrix of weights in [-0.5, 0.5) that takes `numWeightValues` different values
+template <typename ValueType>
+model::Map GeneratePalettizeWeightsModel(bool weightsOnRight, int numWeightValues)
+{
+    const int m = 32, n = 3, k = 64;
+    std::vector<ValueType> weights(m * k);
+    for (int i = 0; i < m * k; ++i)
+    {
+        weights[i] = static_cast<ValueType>((i * 37) % numWeightValues) / numWeightValues - static_cast<ValueType>(0.5);
+    }
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(k * n);
+    auto weightsNode = model.AddNode<nodes::ConstantNode<ValueType>>(weights);
+    auto productNode = weightsOnRight ? model.AddNode<nodes::MatrixMatrixMultiplyNode<ValueType>>(inputNode->output, n, m, k, k, false, weightsNode->output, k, true, m, false) : model.AddNode<nodes::MatrixMatrixMultiplyNode<ValueType>>(weightsNode->output, m, n, k, k, false, inputNode->output, n, false, n, false);
+    return model::Map(model, { { "input", inputNode } }, { { "output", productNode->output } });
+}
+} // namespace
+
+void TestPalettizeWeightsTransformation()
+{
+    using ValueType = float;
+    std::vector<ValueType> input(64 * 3);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        input[i] = static_cast<ValueType>(std::sin(0.7 * i));
+    }
+
+    // With no more distinct weights than codebook entries, the weights are kept exactly; with more, they're clustered
+    for (auto [indexBits, numWeightValues] : std::vector<std::pair<int, int>>{ { 4, 10 }, { 4, 1000 }, { 8, 1000 }, { 0, 10 } })
+    {
+        for (bool weightsOnRight : { false, true })
+        {
+            auto map = GeneratePalettizeWeightsModel<ValueType>(weightsOnRight, numWeightValues);
+            map.SetInputValue("input", input);
+            auto referenceOutput = map.ComputeOutput<ValueType>("output");
+
+            model::MapCompilerOptions settings;
+            model::ModelOptimizerOptions optimizerOptions;
+            optimizerOptions["palettizeWeightsBits"] = indexBits;
+            model::IRMapCompiler compiler(settings, optimizerOptions);
+            model::TransformContext context(&compiler);
+            PalettizeWeightsTransformation palettizeWeightsTransformation;
+            map.Transform(palettizeWeightsTransformation, context);
+            map.Prune();
+
+#if PRINT_MODELS
+            PrintModel(map.GetModel());
+#endif
+
+            const auto& newModel = map.GetModel();
+            auto palettizedNodes = newModel.GetNodesByType<nodes::PalettizedMatrixMultiplyNode<ValueType>>();
+            std::string description = " with " + std::to_string(indexBits) + "-bit indices and " + std::to_string(numWeightValues) + " weight values" + (weightsOnRight ? " on the right" : "");
+            if (indexBits > 0)
+            {
+                bool isPalettized = palettizedNodes.size() == 1 && palettizedNodes[0]->GetIndexBits() == indexBits &&
+                                    palettizedNodes[0]->GetCodebook().size() == static_cast<size_t>(std::min(numWeightValues, 1 << indexBits)) &&
+                                    palettizedNodes[0]->GetWeightsBytes() < 32 * 64 * static_cast<int64_t>(sizeof(ValueType)) &&
+                                    newModel.GetNodesByType<nodes::MatrixMatrixMultiplyNode<ValueType>>().empty() &&
+                                    newModel.GetNodesByType<nodes::ConstantNode<ValueType>>().empty();
+                testing::ProcessTest("Testing PalettizeWeightsTransformation replaces weights" + description, isPalettized);
+            }
+            else
+            {
+                testing::ProcessTest("Testing PalettizeWeightsTransformation can be disabled" + description, palettizedNodes.empty());
+            }
+
+            map.SetInputValue("input", input);
+            auto computedOutput = map.ComputeOutput<ValueType>("output");
+            auto compiledMap = compiler.Compile(map);
+            compiledMap.SetInputValue("input", input);
+            auto compiledOutput = compiledMap.ComputeOutput<ValueType>("output");
+
+            // The clustered weights are within half the distance between codebook entries of the original ones
+            const bool isClustered = indexBits > 0 && numWeightValues > (1 << indexBits);
+            const double tolerance = isClustered ? (indexBits == 4 ? 0.5 : 0.05) : 1e-4;
+            testing::ProcessTest("Testing PalettizeWeightsTransformation result" + description, testing::IsEqual(referenceOutput, computedOutput, tolerance) && testing::IsEqual(computedOutput, compiledOutput, 1e-4));
+        }
+    }
+}
+
+namespace
+{
+// input -> fully-connected, with rank-2 weights
+template <typename ValueType>
+model::Map GenerateLowRankFullyConnectedModel()
+{
+    using namespace predictors::neural;
+    using LayerParameters = typename Layer<ValueType>::LayerParameters;
+    using MatrixType = typename Layer<ValueType>::MatrixType;
+    using TensorType = typename Layer<ValueType>::TensorType;
+    using Shape = typename Layer<ValueType>::Shape;
+
+    TensorType input(2, 3, 4);
+    Shape outputShape = { 1, 1, 16 };
+    LayerParameters parameters{ input, NoPadding(), outputShape, NoPadding() };
+    MatrixType weights(outputShape.Size(), input.Size());
+    for (size_t i = 0; i < weights.NumRows(); ++i)
+    {
+        for (size_t j = 0; j < weights.NumColumns(); ++j)
+        {
+            weights(i, j) = static_cast<ValueType>((i + 1.0) * (j % 5) - 0.5 * (i % 3) * (j + 2.0));
+        }
+    }
+    auto weightsReference = weights.GetConstReference();
+    FullyConnectedLayer<ValueType> layer(parameters, weightsReference);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ValueType>>(input.Size());
+    auto fullyConnectedNode = model.AddNode<nodes::FullyConnectedLayerNode<ValueType>>(inputNode->output, layer);
+    return model::Map(model, { { "input", inputNode } }, { { "output", fullyConnectedNode->output } });
+}
+} // namespace
+
+void TestFactorizeFullyConnectedLayersTransformation()
+{
+    using ValueType = double;
+    std::vector<ValueType> input(24);
+    std::generate(input.begin(), input.end(), Increment<ValueType>(-1.0, 0.125));
+
+    for (double tolerance : { 1e-4, 0.0 })
+    {
+        auto map = GenerateLowRankFullyConnectedModel<ValueType>();
+        map.SetInputValue("input", input);
+        auto referenceOutput = map.ComputeOutput<ValueType>("output");
+
+        model::MapCompilerOptions settings;
+        model::ModelOptimizerOptions optimizerOptions;
+        optimizerOptions["factorizeFullyConnectedTolerance"] = tolerance;
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        model::TransformContext context(&compiler);
+        FactorizeFullyConnectedLayersTransformation factorizeTransformation;
+        map.Transform(factorizeTransformation, context);
+        map.Prune();
+
+#if PRINT_MODELS
+        PrintModel(map.GetModel());
+#endif
+
+        auto fullyConnectedNodes = map.GetModel().GetNodesByType<nodes::FullyConnectedLayerNode<ValueType>>();
+        if (tolerance > 0)
+        {
+            // The 16 x 24 weights are replaced by 2 x 24 and 16 x 2 ones
+            bool isFactored = fullyConnectedNodes.size() == 2 &&
+                              fullyConnectedNodes[0]->GetLayer().GetWeights().Size() + fullyConnectedNodes[1]->GetLayer().GetWeights().Size() == 2 * (24 + 16);
+            testing::ProcessTest("Testing FactorizeFullyConnectedLayersTransformation factors low-rank weights", isFactored);
+        }
+        else
+        {
+            testing::ProcessTest("Testing FactorizeFullyConnectedLayersTransformation can be disabled", fullyConnectedNodes.size() == 1);
+        }
+
+        map.SetInputValue("input", input);
+        auto computedOutput = map.ComputeOutput<ValueType>("output");
+        auto compiledMap = compiler.Compile(map);
+        compiledMap.SetInputValue("input", input);
+        auto compiledOutput = compiledMap.ComputeOutput<ValueType>("output");
+        testing::ProcessTest("Testing FactorizeFullyConnectedLayersTransformation result", testing::IsEqual(referenceOutput, computedOutput, 1e-6) && testing::IsEqual(referenceOutput, compiledOutput, 1e-6));
+    }
+}
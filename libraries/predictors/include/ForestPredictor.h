@@ -15,6 +15,7 @@
 #include <data/include/DenseDataVector.h>
 
 #include <utilities/include/IArchivable.h>
+#include <utilities/include/ParallelFor.h>
 
 #include <algorithm>
 #include <functional>
@@ -250,6 +251,16 @@ namespace predictors
         /// <returns> The prediction. </returns>
         double Predict(const DataVectorType& input, size_t interiorNodeIndex) const;
 
+        /// <summary> Returns the outputs of the forest for a set of inputs. The inputs are processed in blocks, and each
+        /// tree advances a whole block one level at a time, so the nodes it visits stay in cache while the block passes
+        /// through them. The trees are split into contiguous groups that are evaluated concurrently. </summary>
+        ///
+        /// <param name="inputs"> The input vectors. </param>
+        /// <param name="numThreads"> The number of threads to use, zero to use one per core. </param>
+        ///
+        /// <returns> The predictions, in the order of the inputs. </returns>
+        std::vector<double> PredictBatch(const std::vector<DataVectorType>& inputs, size_t numThreads = 1) const;
+
         /// <summary> Generates the edge path indicator vector of the entire forest. </summary>
         ///
         /// <param name="input"> The input vector. </param>
@@ -339,12 +350,18 @@ namespace predictors
 
         void VisitEdgePathToLeaf(const DataVectorType& input, size_t interiorNodeIndex, std::function<void(const InteriorNode&, size_t edgePosition)> operation) const;
 
+        void AddTreeOutputs(const std::vector<DataVectorType>& inputs, size_t firstTree, size_t lastTree, std::vector<double>& outputs) const;
+
         void WriteToArchive(utilities::Archiver& archiver) const override;
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
 
         //
         //  member variables
         //
+
+        // The number of inputs that PredictBatch passes through each tree together
+        static constexpr size_t _batchBlockSize = 256;
+
         std::vector<InteriorNode> _interiorNodes;
         std::vector<size_t> _rootIndices;
         double _bias = 0.0;
@@ -476,6 +493,77 @@ namespace predictors
         return output;
     }
 
+    template <typename SplitRuleType, typename EdgePredictorType>
+    std::vector<double> ForestPredictor<SplitRuleType, EdgePredictorType>::PredictBatch(const std::vector<DataVectorType>& inputs, size_t numThreads) const
+    {
+        numThreads = std::max(std::min(utilities::GetNumThreads(numThreads), NumTrees()), size_t{ 1 });
+
+        // Each group of trees adds up its outputs separately, so the threads share nothing they write to
+        std::vector<std::vector<double>> groupOutputs(numThreads, std::vector<double>(inputs.size(), 0.0));
+        auto runGroup = [this, &inputs, &groupOutputs, numThreads](size_t groupIndex) {
+            AddTreeOutputs(inputs, NumTrees() * groupIndex / numThreads, NumTrees() * (groupIndex + 1) / numThreads, groupOutputs[groupIndex]);
+        };
+
+        utilities::ParallelForBlocks(numThreads, runGroup);
+
+        std::vector<double> outputs(inputs.size(), _bias);
+        for (const auto& groupOutput : groupOutputs)
+        {
+            for (size_t index = 0; index < inputs.size(); ++index)
+            {
+                outputs[index] += groupOutput[index];
+            }
+        }
+        return outputs;
+    }
+
+    template <typename SplitRuleType, typename EdgePredictorType>
+    void ForestPredictor<SplitRuleType, EdgePredictorType>::AddTreeOutputs(const std::vector<DataVectorType>& inputs, size_t firstTree, size_t lastTree, std::vector<double>& outputs) const
+    {
+        // The inputs of the block that haven't reached a leaf yet, and the node each one is at
+        std::vector<std::pair<size_t, size_t>> frontier;
+        frontier.reserve(_batchBlockSize);
+
+        for (size_t blockStart = 0; blockStart < inputs.size(); blockStart += _batchBlockSize)
+        {
+            auto blockEnd = std::min(blockStart + _batchBlockSize, inputs.size());
+            for (auto tree = firstTree; tree < lastTree; ++tree)
+            {
+                frontier.clear();
+                for (auto index = blockStart; index < blockEnd; ++index)
+                {
+                    frontier.emplace_back(index, _rootIndices[tree]);
+                }
+
+                while (!frontier.empty())
+                {
+                    size_t numActive = 0;
+                    for (size_t position = 0; position < frontier.size(); ++position)
+                    {
+                        auto inputIndex = frontier[position].first;
+                        const auto& input = inputs[inputIndex];
+                        const auto& interiorNode = _interiorNodes[frontier[position].second];
+
+                        // a negative edge position stops the path early
+                        int edgePosition = static_cast<int>(interiorNode._splitRule.Predict(input));
+                        if (edgePosition < 0)
+                        {
+                            continue;
+                        }
+
+                        const auto& edge = interiorNode._outgoingEdges[edgePosition];
+                        outputs[inputIndex] += edge._predictor.Predict(input);
+                        if (edge.IsTargetInterior())
+                        {
+                            frontier[numActive++] = { inputIndex, edge.GetTargetNodeIndex() };
+                        }
+                    }
+                    frontier.resize(numActive);
+                }
+            }
+        }
+    }
+
     template <typename SplitRuleType, typename EdgePredictorType>
     std::vector<bool> ForestPredictor<SplitRuleType, EdgePredictorType>::GetEdgeIndicatorVector(const DataVectorType& input) const
     {
@@ -38,9 +38,11 @@
 #include <predictors/neural/include/TanhActivation.h>
 
 #include <utilities/include/IArchivable.h>
+#include <utilities/include/ParallelFor.h>
 
 #include <cstddef>
 #include <memory>
+#include <vector>
 
 namespace ell
 {
@@ -123,6 +125,33 @@ namespace predictors
         /// <returns> The prediction. </returns>
         const std::vector<ElementType>& Predict(const std::vector<ElementType>& input) const;
 
+        /// <summary> Returns the outputs of the network for a batch of inputs, passing the whole batch through each
+        /// layer in turn. Fully-connected layers and unrolled convolutions then take one matrix-matrix product for
+        /// the batch. The activations are allocated on the first call with a given batch size and reused by the
+        /// calls that follow with the same size. </summary>
+        ///
+        /// <param name="inputs"> The input data. </param>
+        ///
+        /// <returns> The predictions, in the order of the inputs. </returns>
+        std::vector<std::vector<ElementType>> PredictBatch(const std::vector<std::vector<ElementType>>& inputs) const;
+
+        /// <summary> Returns the outputs of the network for a set of inputs. The inputs are split into contiguous
+        /// blocks that are evaluated concurrently, each on its own copy of the layers, so that every thread
+        /// has its own activations. Each copy also holds its own weights, which costs memory for large networks. </summary>
+        ///
+        /// <param name="inputs"> The input data. </param>
+        /// <param name="numThreads"> The number of threads to use, zero to use one per core. </param>
+        ///
+        /// <returns> The predictions, in the order of the inputs. </returns>
+        std::vector<std::vector<ElementType>> PredictInParallel(const std::vector<std::vector<ElementType>>& inputs, size_t numThreads = 0) const;
+
+        /// <summary> Sets the number of threads each layer may use to compute its output channels. Convolutional and
+        /// fully-connected layers use them; the other layers run on one thread. Inside PredictInParallel, the layers
+        /// run on the thread of their block, so the total number of threads stays at the one given there. </summary>
+        ///
+        /// <param name="numThreads"> The number of threads per layer, zero to use one per core. </param>
+        void SetNumThreadsPerLayer(size_t numThreads);
+
         /// <summary> Gets the name of this type (for serialization). </summary>
         ///
         /// <returns> The name of this type. </returns>
@@ -152,16 +181,29 @@ namespace predictors
         void ReadFromArchive(utilities::Unarchiver& archiver) override;
 
     private:
+        using TensorType = typename neural::Layer<ElementType>::TensorType;
+        using ConstTensorReferenceType = typename neural::Layer<ElementType>::ConstTensorReferenceType;
+
         void Compute() const;
+        NeuralNetworkPredictor<ElementType> CopyLayers() const;
+        void AllocateBatchActivations(size_t batchSize) const;
+        static std::vector<ConstTensorReferenceType> GetReferences(const std::vector<TensorType>& tensors);
+
         InputLayerReference _inputLayer;
         Layers _layers;
         mutable std::vector<ElementType> _output;
+
+        // Per item inputs, and per layer (the input layer first) outputs, of the last batch
+        mutable std::vector<TensorType> _batchInputs;
+        mutable std::vector<std::vector<TensorType>> _batchActivations;
+        mutable std::vector<const neural::Layer<ElementType>*> _batchLayers;
     };
 } // namespace predictors
 } // namespace ell
 
 #pragma region implementation
 
+#include <algorithm>
 #include <iostream>
 
 namespace ell
@@ -236,6 +278,152 @@ namespace predictors
         return _output;
     }
 
+    template <typename ElementType>
+    std::vector<std::vector<ElementType>> NeuralNetworkPredictor<ElementType>::PredictBatch(const std::vector<std::vector<ElementType>>& inputs) const
+    {
+        std::vector<std::vector<ElementType>> outputs;
+        if (_inputLayer == nullptr || _layers.empty())
+        {
+            for (const auto& input : inputs)
+            {
+                outputs.push_back(Predict(input));
+            }
+            return outputs;
+        }
+
+        AllocateBatchActivations(inputs.size());
+        for (size_t item = 0; item < inputs.size(); ++item)
+        {
+            auto& inputTensor = _batchInputs[item];
+            if (inputs[item].size() < inputTensor.Size())
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "PredictBatch input is smaller than the input layer.");
+            }
+
+            size_t index = 0;
+            for (size_t i = 0; i < inputTensor.NumRows(); ++i)
+            {
+                for (size_t j = 0; j < inputTensor.NumColumns(); ++j)
+                {
+                    for (size_t k = 0; k < inputTensor.NumChannels(); ++k)
+                    {
+                        inputTensor(i, j, k) = inputs[item][index++];
+                    }
+                }
+            }
+        }
+
+        _inputLayer->ComputeBatch(GetReferences(_batchInputs), _batchActivations[0]);
+        for (size_t i = 0; i < _layers.size(); ++i)
+        {
+            _layers[i]->ComputeBatch(GetReferences(_batchActivations[i]), _batchActivations[i + 1]);
+        }
+
+        outputs.resize(inputs.size());
+        for (size_t item = 0; item < inputs.size(); ++item)
+        {
+            const auto& output = _batchActivations.back()[item];
+            outputs[item].reserve(output.Size());
+            for (size_t i = 0; i < output.NumRows(); i++)
+            {
+                for (size_t j = 0; j < output.NumColumns(); j++)
+                {
+                    for (size_t k = 0; k < output.NumChannels(); k++)
+                    {
+                        outputs[item].push_back(output(i, j, k));
+                    }
+                }
+            }
+        }
+        return outputs;
+    }
+
+    template <typename ElementType>
+    void NeuralNetworkPredictor<ElementType>::AllocateBatchActivations(size_t batchSize) const
+    {
+        std::vector<const neural::Layer<ElementType>*> layers = { _inputLayer.get() };
+        for (const auto& layer : _layers)
+        {
+            layers.push_back(layer.get());
+        }
+        if (_batchInputs.size() == batchSize && _batchLayers == layers)
+        {
+            return;
+        }
+
+        // Copying each layer's output gives the activations the same padding
+        _batchInputs.assign(batchSize, TensorType(_inputLayer->GetInput()));
+        _batchActivations.clear();
+        for (auto layer : layers)
+        {
+            _batchActivations.emplace_back(batchSize, TensorType(layer->GetOutput()));
+        }
+        _batchLayers = std::move(layers);
+    }
+
+    template <typename ElementType>
+    std::vector<typename NeuralNetworkPredictor<ElementType>::ConstTensorReferenceType> NeuralNetworkPredictor<ElementType>::GetReferences(const std::vector<TensorType>& tensors)
+    {
+        return { tensors.begin(), tensors.end() };
+    }
+
+    template <typename ElementType>
+    std::vector<std::vector<ElementType>> NeuralNetworkPredictor<ElementType>::PredictInParallel(const std::vector<std::vector<ElementType>>& inputs, size_t numThreads) const
+    {
+        numThreads = std::max(std::min(utilities::GetNumThreads(numThreads), inputs.size()), size_t{ 1 });
+        if (_inputLayer == nullptr || _layers.empty())
+        {
+            numThreads = 1;
+        }
+
+        std::vector<std::vector<ElementType>> outputs(inputs.size());
+        auto runBlock = [&inputs, &outputs, numThreads](const NeuralNetworkPredictor<ElementType>& network, size_t blockIndex) {
+            auto end = inputs.size() * (blockIndex + 1) / numThreads;
+            for (auto index = inputs.size() * blockIndex / numThreads; index < end; ++index)
+            {
+                outputs[index] = network.Predict(inputs[index]);
+            }
+        };
+
+        // The first block runs on this network, the others copy it on their own thread
+        utilities::ParallelForBlocks(numThreads, [this, &runBlock](size_t blockIndex) {
+            if (blockIndex == 0)
+            {
+                runBlock(*this, blockIndex);
+            }
+            else
+            {
+                runBlock(CopyLayers(), blockIndex);
+            }
+        });
+        return outputs;
+    }
+
+    template <typename ElementType>
+    void NeuralNetworkPredictor<ElementType>::SetNumThreadsPerLayer(size_t numThreads)
+    {
+        for (auto& layer : _layers)
+        {
+            layer->SetNumThreads(numThreads);
+        }
+    }
+
+    template <typename ElementType>
+    NeuralNetworkPredictor<ElementType> NeuralNetworkPredictor<ElementType>::CopyLayers() const
+    {
+        // Copies keep referring to the inputs of the layers they were copied from, so connect each one to its predecessor in the copy
+        auto inputLayer = std::make_shared<neural::InputLayer<ElementType>>(*_inputLayer);
+        Layers layers;
+        const neural::Layer<ElementType>* previousLayer = inputLayer.get();
+        for (const auto& layer : _layers)
+        {
+            layers.push_back(layer->Clone());
+            layers.back()->GetLayerParameters().input = previousLayer->GetOutput();
+            previousLayer = layers.back().get();
+        }
+        return NeuralNetworkPredictor<ElementType>(std::move(inputLayer), std::move(layers));
+    }
+
     template <typename ElementType>
     void NeuralNetworkPredictor<ElementType>::Compute() const
     {
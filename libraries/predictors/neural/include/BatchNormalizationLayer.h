@@ -65,6 +65,11 @@ namespace predictors
             /// <returns> The name of this type. </returns>
             std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+            /// <summary> Makes a copy of this layer. </summary>
+            ///
+            /// <returns> The copy. </returns>
+            std::unique_ptr<Layer<ElementType>> Clone() const override { return std::make_unique<BatchNormalizationLayer<ElementType>>(*this); }
+
             /// <summary> Returns the value to scale the output by. </summary>
             ///
             /// <returns> The value to scale the output by. </returns>
@@ -128,6 +128,11 @@ namespace predictors
             /// <returns> The name of this type. </returns>
             std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+            /// <summary> Makes a copy of this layer. </summary>
+            ///
+            /// <returns> The copy. </returns>
+            std::unique_ptr<Layer<ElementType>> Clone() const override { return std::make_unique<BinaryConvolutionalLayer<ElementType>>(*this); }
+
         protected:
             void WriteToArchive(utilities::Archiver& archiver) const override;
             void ReadFromArchive(utilities::Unarchiver& archiver) override;
@@ -60,6 +60,7 @@ namespace predictors
             using MatrixType = typename Layer<ElementType>::MatrixType;
             using TensorType = typename Layer<ElementType>::TensorType;
             using ConstTensorReferenceType = typename Layer<ElementType>::ConstTensorReferenceType;
+            using TensorReferenceType = typename Layer<ElementType>::TensorReferenceType;
             using Layer<ElementType>::GetOutputMinusPadding;
             using Layer<ElementType>::NumOutputRowsMinusPadding;
             using Layer<ElementType>::NumOutputColumnsMinusPadding;
@@ -80,6 +81,13 @@ namespace predictors
             /// <summary> Feeds the input forward through the layer and returns a reference to the output. </summary>
             void Compute() override;
 
+            /// <summary> Computes the outputs for a batch of inputs. With the unrolled method, the receptive fields of
+            /// all the inputs go into one matrix, so the whole batch takes a single matrix-matrix product. </summary>
+            ///
+            /// <param name="inputs"> The inputs, shaped like GetInput(), padding included. </param>
+            /// <param name="outputs"> The outputs, one per input and shaped like GetOutput(). </param>
+            void ComputeBatch(const std::vector<ConstTensorReferenceType>& inputs, std::vector<TensorType>& outputs) override;
+
             /// <summary> Indicates the kind of layer. </summary>
             ///
             /// <returns> An enum indicating the layer type. </returns>
@@ -105,6 +113,11 @@ namespace predictors
             /// <returns> The name of this type. </returns>
             std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+            /// <summary> Makes a copy of this layer. </summary>
+            ///
+            /// <returns> The copy. </returns>
+            std::unique_ptr<Layer<ElementType>> Clone() const override { return std::make_unique<ConvolutionalLayer<ElementType>>(*this); }
+
             /// <summary> Checks if this layer represents a depthwise-separable convolution. </summary>
             ///
             /// <returns> `true` if this layer represents a depthwise-separable convolution. </returns>
@@ -128,6 +141,14 @@ namespace predictors
             void ComputeDiagonalMethod();
             void ComputeDepthwiseSeparable();
 
+            // The weights of the filters in [begin, end), and the output channels they produce
+            ConstTensorReferenceType GetFilters(size_t begin, size_t end) const;
+            TensorReferenceType GetOutputChannels(TensorReferenceType output, size_t begin, size_t end) const;
+
+            // Fewer filters than this per thread aren't worth starting a thread for
+            static constexpr size_t c_minFiltersPerThread = 4;
+
+            using Layer<ElementType>::ParallelForBlocks;
             using Layer<ElementType>::_layerParameters;
             using Layer<ElementType>::_output;
 
@@ -136,6 +157,10 @@ namespace predictors
 
             MatrixType _outputMatrix;
 
+            // The receptive fields of a batch, one block of columns per item, kept between batches of the same size
+            MatrixType _batchShapedInput{ 0, 0 };
+            math::ColumnMatrix<ElementType> _batchOutput{ 0, 0 };
+
             ConvolutionMethod _originalConvolutionMethod;
         };
 
@@ -200,14 +225,64 @@ namespace predictors
             }
         }
 
+        template <typename ElementType>
+        void ConvolutionalLayer<ElementType>::ComputeBatch(const std::vector<ConstTensorReferenceType>& inputs, std::vector<TensorType>& outputs)
+        {
+            if (IsDepthwiseSeparable() || _convolutionalParameters.method != ConvolutionMethod::unrolled)
+            {
+                Layer<ElementType>::ComputeBatch(inputs, outputs);
+                return;
+            }
+
+            const auto filterSize = _convolutionalParameters.receptiveField;
+            const auto numFilters = NumOutputChannels();
+            const auto numItemColumns = NumOutputRowsMinusPadding() * NumOutputColumnsMinusPadding();
+            const auto fieldVolumeSize = filterSize * filterSize * _weights.NumChannels();
+            const auto batchSize = inputs.size();
+            if (_batchShapedInput.NumRows() != fieldVolumeSize || _batchShapedInput.NumColumns() != batchSize * numItemColumns)
+            {
+                _batchShapedInput = MatrixType(fieldVolumeSize, batchSize * numItemColumns);
+                _batchOutput = math::ColumnMatrix<ElementType>(numFilters, batchSize * numItemColumns);
+            }
+
+            auto stride = static_cast<int>(_convolutionalParameters.stride);
+            for (size_t item = 0; item < batchSize; ++item)
+            {
+                dsp::ReceptiveFieldToColumns(inputs[item], static_cast<int>(filterSize), stride, _batchShapedInput.GetSubMatrix(0, item * numItemColumns, fieldVolumeSize, numItemColumns));
+            }
+
+            // Each filter's weights are contiguous and ordered like the rows of the shaped input, so the weights tensor is already the weights matrix
+            math::ConstRowMatrixReference<ElementType> weightsMatrix(_weights.GetConstDataPointer(), numFilters, fieldVolumeSize);
+            ParallelForBlocks(numFilters, c_minFiltersPerThread, [&](size_t begin, size_t end) {
+                math::MultiplyScaleAddUpdate(static_cast<ElementType>(1.0), weightsMatrix.GetSubMatrix(begin, 0, end - begin, fieldVolumeSize), _batchShapedInput, static_cast<ElementType>(0.0), _batchOutput.GetSubMatrix(begin, 0, end - begin, _batchOutput.NumColumns()));
+            });
+
+            for (size_t item = 0; item < batchSize; ++item)
+            {
+                auto output = GetOutputMinusPadding(outputs[item]);
+                for (size_t i = 0; i < output.NumRows(); i++)
+                {
+                    for (size_t j = 0; j < output.NumColumns(); j++)
+                    {
+                        auto column = item * numItemColumns + i * output.NumColumns() + j;
+                        for (size_t k = 0; k < numFilters; k++)
+                        {
+                            output(i, j, k) = _batchOutput(k, column);
+                        }
+                    }
+                }
+            }
+        }
+
         template <typename ElementType>
         void ConvolutionalLayer<ElementType>::ComputeSimpleMethod()
         {
             auto output = GetOutputMinusPadding();
             auto& input = _layerParameters.input;
             auto stride = static_cast<int>(_convolutionalParameters.stride);
-            const int numFilters = static_cast<int>(output.NumChannels());
-            dsp::Convolve2DSimple(input, _weights, numFilters, stride, output);
+            ParallelForBlocks(output.NumChannels(), c_minFiltersPerThread, [&](size_t begin, size_t end) {
+                dsp::Convolve2DSimple(input, GetFilters(begin, end), static_cast<int>(end - begin), stride, GetOutputChannels(output, begin, end));
+            });
         }
 
         template <typename ElementType>
@@ -216,9 +291,10 @@ namespace predictors
             auto output = GetOutputMinusPadding();
             auto& input = _layerParameters.input;
             auto stride = static_cast<int>(_convolutionalParameters.stride);
-            const int numFilters = static_cast<int>(output.NumChannels());
-            auto result = dsp::Convolve2DUnrolled(input, _weights, numFilters, stride);
-            output.CopyFrom(result);
+            ParallelForBlocks(output.NumChannels(), c_minFiltersPerThread, [&](size_t begin, size_t end) {
+                auto result = dsp::Convolve2DUnrolled(input, GetFilters(begin, end), static_cast<int>(end - begin), stride);
+                GetOutputChannels(output, begin, end).CopyFrom(result);
+            });
         }
 
         template <typename ElementType>
@@ -226,9 +302,10 @@ namespace predictors
         {
             auto output = GetOutputMinusPadding();
             auto& input = _layerParameters.input;
-            const int numFilters = static_cast<int>(output.NumChannels());
-            auto result = dsp::Convolve2DWinograd(input, _weights, numFilters);
-            output.CopyFrom(result);
+            ParallelForBlocks(output.NumChannels(), c_minFiltersPerThread, [&](size_t begin, size_t end) {
+                auto result = dsp::Convolve2DWinograd(input, GetFilters(begin, end), static_cast<int>(end - begin));
+                GetOutputChannels(output, begin, end).CopyFrom(result);
+            });
         }
 
         template <typename ElementType>
@@ -292,39 +369,54 @@ namespace predictors
             const size_t numOutputColumns = output.NumColumns();
             const size_t filterRows = _convolutionalParameters.receptiveField;
 
-            for (size_t channel = 0; channel < output.NumChannels(); ++channel)
-            {
-                using TensorType = typename Layer<ElementType>::TensorType;
-                using TensorReferenceType = typename Layer<ElementType>::TensorReferenceType;
+            ParallelForBlocks(output.NumChannels(), c_minFiltersPerThread, [&](size_t begin, size_t end) {
+                for (size_t channel = begin; channel < end; ++channel)
+                {
+                    using TensorType = typename Layer<ElementType>::TensorType;
+                    using TensorReferenceType = typename Layer<ElementType>::TensorReferenceType;
 
-                TensorType weights(_weights.GetSubTensor(filterRows * channel, 0, 0, filterRows, filterRows, 1));
-                const auto& inputChannelTensor = input.GetSubTensor(0, 0, channel, numInputRows, numInputColumns, 1);
-                TensorReferenceType outputChannelTensor = output.GetSubTensor(0, 0, channel, numOutputRows, numOutputColumns, 1);
+                    TensorType weights(_weights.GetSubTensor(filterRows * channel, 0, 0, filterRows, filterRows, 1));
+                    const auto& inputChannelTensor = input.GetSubTensor(0, 0, channel, numInputRows, numInputColumns, 1);
+                    TensorReferenceType outputChannelTensor = output.GetSubTensor(0, 0, channel, numOutputRows, numOutputColumns, 1);
 
-                switch (_convolutionalParameters.method)
-                {
-                case ConvolutionMethod::simple:
-                {
-                    auto result = dsp::Convolve2DSimpleDepthwiseSeparable(inputChannelTensor, weights, numFilters, stride);
-                    outputChannelTensor.CopyFrom(result);
-                }
-                break;
-                case ConvolutionMethod::unrolled:
-                {
-                    auto result = dsp::Convolve2DUnrolled(inputChannelTensor, weights, numFilters, stride);
-                    outputChannelTensor.CopyFrom(result);
-                }
-                break;
-                case ConvolutionMethod::winograd:
-                {
-                    auto result = dsp::Convolve2DWinogradDepthwiseSeparable(inputChannelTensor, weights, numFilters); // Stide of 1 is assumed
-                    outputChannelTensor.CopyFrom(result);
-                }
-                break;
-                default:
-                    throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "Convolution method not supported for depthwise separable convolution");
+                    switch (_convolutionalParameters.method)
+                    {
+                    case ConvolutionMethod::simple:
+                    {
+                        auto result = dsp::Convolve2DSimpleDepthwiseSeparable(inputChannelTensor, weights, numFilters, stride);
+                        outputChannelTensor.CopyFrom(result);
+                    }
+                    break;
+                    case ConvolutionMethod::unrolled:
+                    {
+                        auto result = dsp::Convolve2DUnrolled(inputChannelTensor, weights, numFilters, stride);
+                        outputChannelTensor.CopyFrom(result);
+                    }
+                    break;
+                    case ConvolutionMethod::winograd:
+                    {
+                        auto result = dsp::Convolve2DWinogradDepthwiseSeparable(inputChannelTensor, weights, numFilters); // Stide of 1 is assumed
+                        outputChannelTensor.CopyFrom(result);
+                    }
+                    break;
+                    default:
+                        throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "Convolution method not supported for depthwise separable convolution");
+                    }
                 }
-            }
+            });
+        }
+
+        template <typename ElementType>
+        typename ConvolutionalLayer<ElementType>::ConstTensorReferenceType ConvolutionalLayer<ElementType>::GetFilters(size_t begin, size_t end) const
+        {
+            const auto filterSize = _convolutionalParameters.receptiveField;
+            return _weights.GetSubTensor(begin * filterSize, 0, 0, (end - begin) * filterSize, filterSize, _weights.NumChannels());
+        }
+
+        template <typename ElementType>
+        typename ConvolutionalLayer<ElementType>::TensorReferenceType ConvolutionalLayer<ElementType>::GetOutputChannels(TensorReferenceType output, size_t begin, size_t end) const
+        {
+            return output.GetSubTensor(0, 0, begin, output.NumRows(), output.NumColumns(), end - begin);
         }
 
         template <typename ElementType>
@@ -28,6 +28,7 @@ namespace predictors
             using MatrixType = typename Layer<ElementType>::MatrixType;
             using ConstMatrixReferenceType = typename Layer<ElementType>::ConstMatrixReferenceType;
             using ConstTensorReferenceType = typename Layer<ElementType>::ConstTensorReferenceType;
+            using TensorType = typename Layer<ElementType>::TensorType;
             using Layer<ElementType>::GetOutputMinusPadding;
             using Layer<ElementType>::NumOutputRowsMinusPadding;
             using Layer<ElementType>::NumOutputColumnsMinusPadding;
@@ -54,6 +55,12 @@ namespace predictors
             /// <summary> Feeds the input forward through the layer and returns a reference to the output. </summary>
             void Compute() override;
 
+            /// <summary> Computes the outputs for a batch of inputs with a single matrix-matrix product. </summary>
+            ///
+            /// <param name="inputs"> The inputs, shaped like GetInput(), padding included. </param>
+            /// <param name="outputs"> The outputs, one per input and shaped like GetOutput(). </param>
+            void ComputeBatch(const std::vector<ConstTensorReferenceType>& inputs, std::vector<TensorType>& outputs) override;
+
             /// <summary> Indicates the kind of layer. </summary>
             ///
             /// <returns> An enum indicating the layer type. </returns>
@@ -74,17 +81,29 @@ namespace predictors
             /// <returns> The name of this type. </returns>
             std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+            /// <summary> Makes a copy of this layer. </summary>
+            ///
+            /// <returns> The copy. </returns>
+            std::unique_ptr<Layer<ElementType>> Clone() const override { return std::make_unique<FullyConnectedLayer<ElementType>>(*this); }
+
         protected:
             void WriteToArchive(utilities::Archiver& archiver) const override;
             void ReadFromArchive(utilities::Unarchiver& archiver) override;
 
         private:
+            static constexpr size_t c_minOutputsPerThread = 64;
+
+            using Layer<ElementType>::ParallelForBlocks;
             using Layer<ElementType>::_layerParameters;
             using Layer<ElementType>::_output;
 
             MatrixType _weights;
             VectorType _shapedInput;
             VectorType _outputVector;
+
+            // One column per item, kept between batches of the same size
+            math::ColumnMatrix<ElementType> _batchInput{ 0, 0 };
+            math::ColumnMatrix<ElementType> _batchOutput{ 0, 0 };
         };
 
     } // namespace neural
@@ -155,7 +174,11 @@ namespace predictors
                 }
             }
 
-            math::MultiplyScaleAddUpdate((ElementType)1.0f, _weights, _shapedInput, (ElementType)0.0f, _outputVector);
+            // Each thread computes the outputs of a block of rows of the weights
+            ParallelForBlocks(_weights.NumRows(), c_minOutputsPerThread, [this](size_t begin, size_t end) {
+                auto outputs = _outputVector.GetSubVector(begin, end - begin);
+                math::MultiplyScaleAddUpdate((ElementType)1.0f, _weights.GetSubMatrix(begin, 0, end - begin, _weights.NumColumns()), _shapedInput, (ElementType)0.0f, outputs);
+            });
 
             // Reshape the output
             columnIndex = 0;
@@ -171,6 +194,55 @@ namespace predictors
             }
         }
 
+        template <typename ElementType>
+        void FullyConnectedLayer<ElementType>::ComputeBatch(const std::vector<ConstTensorReferenceType>& inputs, std::vector<TensorType>& outputs)
+        {
+            const auto batchSize = inputs.size();
+            if (_batchInput.NumRows() != _weights.NumColumns() || _batchInput.NumColumns() != batchSize)
+            {
+                _batchInput = math::ColumnMatrix<ElementType>(_weights.NumColumns(), batchSize);
+                _batchOutput = math::ColumnMatrix<ElementType>(_weights.NumRows(), batchSize);
+            }
+
+            for (size_t item = 0; item < batchSize; ++item)
+            {
+                const auto& input = inputs[item];
+                auto shapedInput = _batchInput.GetColumn(item);
+                size_t columnIndex = 0;
+                for (size_t i = 0; i < input.NumRows(); i++)
+                {
+                    for (size_t j = 0; j < input.NumColumns(); j++)
+                    {
+                        for (size_t k = 0; k < input.NumChannels(); k++)
+                        {
+                            shapedInput[columnIndex++] = input(i, j, k);
+                        }
+                    }
+                }
+            }
+
+            ParallelForBlocks(_weights.NumRows(), c_minOutputsPerThread, [this, batchSize](size_t begin, size_t end) {
+                math::MultiplyScaleAddUpdate((ElementType)1.0f, _weights.GetSubMatrix(begin, 0, end - begin, _weights.NumColumns()), _batchInput, (ElementType)0.0f, _batchOutput.GetSubMatrix(begin, 0, end - begin, batchSize));
+            });
+
+            for (size_t item = 0; item < batchSize; ++item)
+            {
+                auto output = GetOutputMinusPadding(outputs[item]);
+                auto outputVector = _batchOutput.GetColumn(item);
+                size_t columnIndex = 0;
+                for (size_t i = 0; i < output.NumRows(); i++)
+                {
+                    for (size_t j = 0; j < output.NumColumns(); j++)
+                    {
+                        for (size_t k = 0; k < output.NumChannels(); k++)
+                        {
+                            output(i, j, k) = outputVector[columnIndex++];
+                        }
+                    }
+                }
+            }
+        }
+
         template <typename ElementType>
         const typename FullyConnectedLayer<ElementType>::MatrixType& FullyConnectedLayer<ElementType>::GetWeights() const
         {
@@ -61,6 +61,11 @@ namespace predictors
             /// <param name="inputParameters">   </param>
             InputLayer(const InputParameters& inputParameters);
 
+            /// <summary> Initializes this layer by copying another. The copy reads its own input data. </summary>
+            ///
+            /// <param name="other"> The layer to copy. </param>
+            InputLayer(const InputLayer& other);
+
             /// <summary> Instantiates a blank instance. Used for unarchiving purposes only. </summary>
             InputLayer() :
                 _data(0, 0, 0) {}
@@ -103,6 +108,11 @@ namespace predictors
             /// <returns> The name of this type. </returns>
             std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+            /// <summary> Makes a copy of this layer. </summary>
+            ///
+            /// <returns> The copy. </returns>
+            std::unique_ptr<Layer<ElementType>> Clone() const override { return std::make_unique<InputLayer<ElementType>>(*this); }
+
         protected:
             void WriteToArchive(utilities::Archiver& archiver) const override;
             void ReadFromArchive(utilities::Unarchiver& archiver) override;
@@ -138,6 +148,15 @@ namespace predictors
             _scale.Fill(inputParameters.scale);
         }
 
+        template <typename ElementType>
+        InputLayer<ElementType>::InputLayer(const InputLayer& other) :
+            Layer<ElementType>(other),
+            _scale(other._scale),
+            _data(other._data)
+        {
+            _layerParameters.input = _data;
+        }
+
         template <typename ElementType>
         void InputLayer<ElementType>::SetInput(const DataVectorType& input)
         {
@@ -16,6 +16,7 @@
 #include <data/include/Dataset.h>
 
 #include <utilities/include/IArchivable.h>
+#include <utilities/include/ParallelFor.h>
 
 #include <cstddef>
 #include <memory>
@@ -234,6 +235,33 @@ namespace predictors
             /// <summary> Resets the state of the layer </summary>
             virtual void Reset(){};
 
+            /// <summary> Computes the outputs of the layer for a batch of inputs. This implementation computes the
+            /// inputs one at a time, in the output tensors the caller provides; layers that can do better on a whole
+            /// batch, such as fully-connected ones, override it. </summary>
+            ///
+            /// <param name="inputs"> The inputs, shaped like GetInput(), padding included. </param>
+            /// <param name="outputs"> The outputs, one per input and shaped like GetOutput(). Their padding must already
+            /// be filled in, as it is in a copy of GetOutput(). </param>
+            virtual void ComputeBatch(const std::vector<ConstTensorReferenceType>& inputs, std::vector<TensorType>& outputs);
+
+            /// <summary> Makes a copy of this layer, with its own output tensor. The copy's input still refers to
+            /// this layer's input, so a copy made for another network has to have its input set through
+            /// GetLayerParameters(). </summary>
+            ///
+            /// <returns> The copy. </returns>
+            virtual std::unique_ptr<Layer<ElementType>> Clone() const { return std::make_unique<Layer<ElementType>>(*this); }
+
+            /// <summary> Sets the number of threads the layer may use to compute its output. Layers that support it
+            /// split their output channels among the threads; the others ignore it. </summary>
+            ///
+            /// <param name="numThreads"> The number of threads, zero to use one per core. </param>
+            void SetNumThreads(size_t numThreads) { _numThreads = numThreads; }
+
+            /// <summary> Returns the number of threads the layer may use to compute its output. </summary>
+            ///
+            /// <returns> The number of threads, zero meaning one per core. </returns>
+            size_t GetNumThreads() const { return _numThreads; }
+
             /// <summary> Indicates the kind of layer. </summary>
             ///
             /// <returns> An enum indicating the layer type. </returns>
@@ -279,6 +307,13 @@ namespace predictors
             /// <returns> Read/write reference to the output tensor. </returns>
             TensorReferenceType GetOutputMinusPadding();
 
+            /// <summary> Returns a read/write reference to the sub tensor of an output tensor shaped like this layer's that does not contain padding. </summary>
+            ///
+            /// <param name="output"> The output tensor, for example one of those passed to ComputeBatch. </param>
+            ///
+            /// <returns> Read/write reference to the output tensor, minus padding. </returns>
+            TensorReferenceType GetOutputMinusPadding(TensorType& output) const;
+
             /// <summary> Returns number of output rows minus padding. </summary>
             size_t NumOutputRowsMinusPadding() const { return _output.NumRows() - 2 * _layerParameters.outputPaddingParameters.paddingSize; }
 
@@ -295,8 +330,14 @@ namespace predictors
             // rather than doing them in place
             void AssignValues(ConstTensorReferenceType& input, TensorReferenceType& output);
 
+            // Calls function(begin, end) on contiguous blocks of [0, count), running the blocks on up to GetNumThreads() threads.
+            // Blocks hold at least minBlockSize indices, so that small layers stay on the calling thread.
+            template <typename FunctionType>
+            void ParallelForBlocks(size_t count, size_t minBlockSize, FunctionType function) const;
+
             LayerParameters _layerParameters;
             TensorType _output;
+            size_t _numThreads = 1;
         };
 
         /// <summary> A serialization context used during layer deserialization. Wraps an existing `SerializationContext`
@@ -332,9 +373,11 @@ namespace predictors
 #pragma region implementation
 
 #ifndef SWIG
+#include <algorithm>
 #include <limits>
 #include <ostream>
 #include <type_traits>
+#include <vector>
 
 namespace ell
 {
@@ -377,7 +420,8 @@ namespace predictors
         template <typename ElementType>
         Layer<ElementType>::Layer(const Layer& other) :
             _layerParameters(other._layerParameters),
-            _output(other._layerParameters.outputShape)
+            _output(other._layerParameters.outputShape),
+            _numThreads(other._numThreads)
         {
             InitializeOutputValues(_output, other._layerParameters.outputPaddingParameters);
         }
@@ -542,10 +586,16 @@ namespace predictors
 
         template <typename ElementType>
         typename Layer<ElementType>::TensorReferenceType Layer<ElementType>::GetOutputMinusPadding()
+        {
+            return GetOutputMinusPadding(_output);
+        }
+
+        template <typename ElementType>
+        typename Layer<ElementType>::TensorReferenceType Layer<ElementType>::GetOutputMinusPadding(TensorType& output) const
         {
             auto padding = _layerParameters.outputPaddingParameters.paddingSize;
-            return _output.GetSubTensor({ padding, padding, 0 },
-                                        { _output.NumRows() - 2 * padding, _output.NumColumns() - 2 * padding, _output.NumChannels() });
+            return output.GetSubTensor({ padding, padding, 0 },
+                                       { output.NumRows() - 2 * padding, output.NumColumns() - 2 * padding, output.NumChannels() });
         }
 
         template <typename ElementType>
@@ -564,6 +614,38 @@ namespace predictors
                 }
             }
         }
+
+        template <typename ElementType>
+        void Layer<ElementType>::ComputeBatch(const std::vector<ConstTensorReferenceType>& inputs, std::vector<TensorType>& outputs)
+        {
+            // Compute each item in the caller's output tensor by swapping it in for this layer's own
+            auto input = _layerParameters.input;
+            for (size_t index = 0; index < inputs.size(); ++index)
+            {
+                _layerParameters.input = inputs[index];
+                _output.Swap(outputs[index]);
+                try
+                {
+                    Compute();
+                }
+                catch (...)
+                {
+                    _output.Swap(outputs[index]);
+                    _layerParameters.input = input;
+                    throw;
+                }
+                _output.Swap(outputs[index]);
+            }
+            _layerParameters.input = input;
+        }
+
+        template <typename ElementType>
+        template <typename FunctionType>
+        void Layer<ElementType>::ParallelForBlocks(size_t count, size_t minBlockSize, FunctionType function) const
+        {
+            auto numBlocks = std::max(std::min(utilities::GetNumThreads(_numThreads), count / std::max(minBlockSize, size_t{ 1 })), size_t{ 1 });
+            utilities::ParallelForRanges(count, numBlocks, function);
+        }
     } // namespace neural
 } // namespace predictors
 } // namespace ell
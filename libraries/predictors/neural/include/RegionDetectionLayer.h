@@ -74,6 +74,11 @@ namespace predictors
             /// <returns> The name of this type. </returns>
             std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+            /// <summary> Makes a copy of this layer. </summary>
+            ///
+            /// <returns> The copy. </returns>
+            std::unique_ptr<Layer<ElementType>> Clone() const override { return std::make_unique<RegionDetectionLayer<ElementType>>(*this); }
+
             /// <summary> Gets the parameters for the region detection. </summary>
             ///
             /// <returns> The structure defining the parameters for the region detection. </returns>
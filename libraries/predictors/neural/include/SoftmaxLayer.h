@@ -51,6 +51,11 @@ namespace predictors
             /// <returns> The name of this type. </returns>
             std::string GetRuntimeTypeName() const override { return GetTypeName(); }
 
+            /// <summary> Makes a copy of this layer. </summary>
+            ///
+            /// <returns> The copy. </returns>
+            std::unique_ptr<Layer<ElementType>> Clone() const override { return std::make_unique<SoftmaxLayer<ElementType>>(*this); }
+
         private:
             using Layer<ElementType>::_layerParameters;
             using Layer<ElementType>::_output;
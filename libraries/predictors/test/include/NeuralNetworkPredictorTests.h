@@ -482,6 +482,36 @@ void ConvolutionalLayerTest()
     convolutionalLayerDiagonal.Compute();
     auto outputDiagonal = convolutionalLayerDiagonal.GetOutput();
     testing::ProcessTest("Testing ConvolutionalLayer (diagonal), values", Equals(outputDiagonal(0, 0, 0), 10) && Equals(outputDiagonal(0, 0, 1), 15) && Equals(outputDiagonal(0, 1, 0), 18) && Equals(outputDiagonal(0, 1, 1), 18));
+
+    // Verify that splitting the filters among threads gives the same values
+    const size_t numFilters = 8;
+    TensorType manyWeights(numFilters * convolutionalParams.receptiveField, convolutionalParams.receptiveField, input.NumChannels());
+    int weightValue = 0;
+    manyWeights.Generate([&weightValue]() { return static_cast<ElementType>(weightValue++ % 7); });
+    LayerParameters manyFiltersParameters{ input, ZeroPadding(1), { 1, 2, numFilters }, NoPadding() };
+    for (auto method : { ConvolutionMethod::simple, ConvolutionMethod::unrolled })
+    {
+        convolutionalParams.method = method;
+        ConvolutionalLayer<ElementType> serialLayer(manyFiltersParameters, convolutionalParams, manyWeights);
+        auto parallelLayer = serialLayer.Clone();
+        parallelLayer->SetNumThreads(2);
+        serialLayer.Compute();
+        parallelLayer->Compute();
+        testing::ProcessTest("Testing ConvolutionalLayer on 2 threads, values", serialLayer.GetOutput() == parallelLayer->GetOutput());
+    }
+
+    // Verify that computing a batch gives the same values as computing its inputs one at a time
+    convolutionalParams.method = ConvolutionMethod::unrolled;
+    ConvolutionalLayer<ElementType> batchLayer(manyFiltersParameters, convolutionalParams, manyWeights);
+    TensorType secondInput(input);
+    secondInput(1, 2, 1) = 5;
+    std::vector<TensorType> batchOutputs(2, TensorType(batchLayer.GetOutput()));
+    batchLayer.ComputeBatch({ input, secondInput }, batchOutputs);
+    batchLayer.Compute();
+    bool firstOutputMatches = batchOutputs[0] == batchLayer.GetOutput();
+    batchLayer.GetLayerParameters().input = secondInput;
+    batchLayer.Compute();
+    testing::ProcessTest("Testing ConvolutionalLayer, ComputeBatch values", firstOutputMatches && batchOutputs[1] == batchLayer.GetOutput());
 }
 
 template <typename ElementType>
@@ -772,6 +802,16 @@ void NeuralNetworkPredictorTest()
     output = neuralNetwork.Predict(DataVectorType({ 1, 1 }));
     testing::ProcessTest("Testing NeuralNetworkPredictor, Predict of XOR net for 1 1 ", Equals(output[0], 0.0));
 
+    // Evaluate all 4 inputs at once, on copies of the network
+    neuralNetwork.SetNumThreadsPerLayer(2);
+    auto outputs = neuralNetwork.PredictInParallel({ { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 } }, 3);
+    testing::ProcessTest("Testing NeuralNetworkPredictor, PredictInParallel of XOR net", outputs.size() == 4 && Equals(outputs[0][0], 0.0) && Equals(outputs[1][0], 1.0) && Equals(outputs[2][0], 1.0) && Equals(outputs[3][0], 0.0));
+
+    // Evaluate them as one batch, twice to reuse the activations
+    neuralNetwork.PredictBatch({ { 1, 1 }, { 1, 1 }, { 1, 1 }, { 1, 1 } });
+    outputs = neuralNetwork.PredictBatch({ { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 } });
+    testing::ProcessTest("Testing NeuralNetworkPredictor, PredictBatch of XOR net", outputs.size() == 4 && Equals(outputs[0][0], 0.0) && Equals(outputs[1][0], 1.0) && Equals(outputs[2][0], 1.0) && Equals(outputs[3][0], 0.0));
+
     // Verify that we can archive and unarchive the predictor
     utilities::SerializationContext context;
     NeuralNetworkPredictor<ElementType>::RegisterNeuralNetworkPredictorTypes(context);
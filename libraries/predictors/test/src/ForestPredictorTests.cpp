@@ -10,6 +10,8 @@
 
 #include <testing/include/testing.h>
 
+#include <cmath>
+
 using namespace ell;
 
 void ForestPredictorTest()
@@ -65,3 +67,44 @@ void ForestPredictorTest()
     auto edgeIndicator = forest.GetEdgeIndicatorVector(ExampleType{ 0.25, 0.7, 0.0 });
     testing::ProcessTest("Testing ForestPredictor, SetEdgeIndicatorVector()", testing::IsEqual(edgeIndicator, std::vector<bool>{ 1, 0, 0, 1, 0, 0, 0, 1 }));
 }
+
+void ForestPredictorBatchTest()
+{
+    using SplitAction = predictors::SimpleForestPredictor::SplitAction;
+    using SplitRule = predictors::SingleElementThresholdPredictor;
+    using EdgePredictorVector = std::vector<predictors::ConstantPredictor>;
+    using ExampleType = predictors::SimpleForestPredictor::DataVectorType;
+
+    // trees of a few shapes, some deeper on one side than the other
+    const size_t numFeatures = 4;
+    predictors::SimpleForestPredictor forest;
+    for (size_t tree = 0; tree < 7; ++tree)
+    {
+        auto offset = 0.1 * tree;
+        auto root = forest.Split(SplitAction{ forest.GetNewRootId(), SplitRule{ tree % numFeatures, 0.3 + offset }, EdgePredictorVector{ -1.0 - offset, 1.0 + offset } });
+        auto child = forest.Split(SplitAction{ forest.GetChildId(root, tree % 2), SplitRule{ (tree + 1) % numFeatures, 0.5 }, EdgePredictorVector{ -2.0, 2.0 } });
+        if (tree % 3 == 0)
+        {
+            forest.Split(SplitAction{ forest.GetChildId(child, 1), SplitRule{ (tree + 2) % numFeatures, 0.6 - offset }, EdgePredictorVector{ -4.0, 4.0 } });
+        }
+    }
+    forest.AddToBias(0.5);
+
+    // more inputs than fit in one block
+    std::vector<ExampleType> inputs;
+    std::vector<double> expected;
+    for (size_t index = 0; index < 300; ++index)
+    {
+        std::vector<float> values(numFeatures);
+        for (size_t feature = 0; feature < numFeatures; ++feature)
+        {
+            values[feature] = static_cast<float>(0.5 + 0.5 * std::sin(0.7 * index + 1.9 * feature));
+        }
+        inputs.emplace_back(values);
+        expected.push_back(forest.Predict(inputs.back()));
+    }
+
+    testing::ProcessTest("Testing ForestPredictor, PredictBatch()", testing::IsEqual(forest.PredictBatch(inputs), expected, 1.0e-8));
+    testing::ProcessTest("Testing ForestPredictor, PredictBatch() with 3 threads", testing::IsEqual(forest.PredictBatch(inputs, 3), expected, 1.0e-8));
+    testing::ProcessTest("Testing ForestPredictor, PredictBatch() with more threads than trees", testing::IsEqual(forest.PredictBatch(inputs, 16), expected, 1.0e-8));
+}
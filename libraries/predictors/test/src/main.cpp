@@ -19,6 +19,7 @@ int main()
 {
     // ForestPredictor
     ForestPredictorTest();
+    ForestPredictorBatchTest();
 
     // LinearPredictor
     LinearPredictorTest<double>();
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     GpuRuntime.h (runtime)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+//
+// GPU offload for the matrix products of models compiled with the `useGpu` option. When the runtime library is built
+// with CUDA, a product runs on the GPU with cuBLAS: constant operands (the weights) are uploaded once and stay on the
+// device, and a large product is split into chunks of rows so that the transfers of one chunk overlap the computation
+// of another. Otherwise, or if the GPU fails, the product runs on the CPU. The runtime library is only built with CUDA
+// when CMake is configured with `-DELL_RUNTIME_CUDA=ON`.
+//
+// Device copies of constant operands belong to the module that uploaded them. A module gets its id from
+// `ell_runtime_GpuBeginModule` when it's loaded, and frees its copies with `ell_runtime_GpuEndModule` when it's unloaded,
+// so a new model whose weights land at the address of an unloaded model's weights never sees the old copies.
+//
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// <summary> Flags telling `ell_runtime_GpuSgemm` and `ell_runtime_GpuDgemm` which operands never change, so their device copies can be kept. </summary>
+enum
+{
+    ell_runtime_ConstantA = 1,
+    ell_runtime_ConstantB = 2
+};
+
+/// <summary> Gets a new id for a module that calls `ell_runtime_GpuSgemm` or `ell_runtime_GpuDgemm`. Compiled models call it when they're loaded. </summary>
+///
+/// <returns> An id that no other module has had. </returns>
+int64_t ell_runtime_GpuBeginModule(void);
+
+/// <summary> Frees the device copies of a module's constant operands. Compiled models call it when they're unloaded. </summary>
+///
+/// <param name="moduleId"> The id returned by `ell_runtime_GpuBeginModule`. </param>
+void ell_runtime_GpuEndModule(int64_t moduleId);
+
+/// <summary> Gets whether the products run on a GPU. </summary>
+///
+/// <returns> 1 if the runtime library was built with CUDA and a device was found, else 0. </returns>
+int32_t ell_runtime_GpuIsAvailable(void);
+
+/// <summary> Computes the row-major product C = op(A) * op(B), where op(A) is m x k and op(B) is k x n. </summary>
+///
+/// <param name="transposeA"> If nonzero, A is stored as a k x m matrix. </param>
+/// <param name="transposeB"> If nonzero, B is stored as an n x k matrix. </param>
+/// <param name="m"> The number of rows of C. </param>
+/// <param name="n"> The number of columns of C. </param>
+/// <param name="k"> The inner dimension. </param>
+/// <param name="A"> The matrix A. </param>
+/// <param name="lda"> The row stride of A. </param>
+/// <param name="B"> The matrix B. </param>
+/// <param name="ldb"> The row stride of B. </param>
+/// <param name="C"> The result, overwritten. </param>
+/// <param name="ldc"> The row stride of C. </param>
+/// <param name="constantOperands"> A combination of `ell_runtime_ConstantA` and `ell_runtime_ConstantB`. </param>
+/// <param name="moduleId"> The id of the calling module, which owns the device copies of its constant operands. </param>
+/// @{
+void ell_runtime_GpuSgemm(int32_t transposeA, int32_t transposeB, int32_t m, int32_t n, int32_t k, const float* A, int32_t lda, const float* B, int32_t ldb, float* C, int32_t ldc, int32_t constantOperands, int64_t moduleId);
+void ell_runtime_GpuDgemm(int32_t transposeA, int32_t transposeB, int32_t m, int32_t n, int32_t k, const double* A, int32_t lda, const double* B, int32_t ldb, double* C, int32_t ldc, int32_t constantOperands, int64_t moduleId);
+/// @}
+
+/// <summary> Frees the device copies of the constant operands of all modules. </summary>
+void ell_runtime_GpuReleaseConstants(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,119 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SharedRuntime.h (runtime)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+//
+// The ELL runtime shared by all the models in a process that were compiled with the `useSharedRuntime` option.
+// Instead of each model starting its own thread pool, their parallel tasks run on one process-wide pool, their
+// BLAS calls follow one threading policy, and their profilers register with one registry. This is a C API, so
+// that it can be called from the compiled models and from C hosts alike.
+//
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// <summary> The type of a task function, which takes a pointer to its arguments and returns a pointer. </summary>
+typedef void* (*ell_runtime_TaskFunction)(void* args);
+
+/// <summary> Sets the number of worker threads of the shared thread pool. The pool is started, with that many
+/// workers, the first time tasks are started; after that its size can't change. If this is never called, the
+/// size is read from the `ELL_RUNTIME_THREADS` environment variable, or else is one less than the number of
+/// hardware threads, since a thread waiting for its tasks runs them too. </summary>
+///
+/// <param name="numThreads"> The number of worker threads, or 0 for the default. </param>
+///
+/// <returns> 0 on success, or -1 if the pool was already started with a different size. </returns>
+int32_t ell_runtime_SetNumThreads(int32_t numThreads);
+
+/// <summary> Gets the number of worker threads of the shared thread pool (started or not). </summary>
+int32_t ell_runtime_GetNumThreads(void);
+
+/// <summary> Starts running a function on an array of argument structs on the shared thread pool. </summary>
+///
+/// <param name="taskFunction"> The function to run. </param>
+/// <param name="args"> The argument structs of the tasks, one after the other. </param>
+/// <param name="argsSize"> The size in bytes of each argument struct. </param>
+/// <param name="numTasks"> The number of tasks. </param>
+/// <param name="returnValues"> An array of `numTasks` pointers that receives the tasks' return values, or null. </param>
+///
+/// <returns> A handle to pass to `ell_runtime_WaitTasks`, which must be called exactly once, or null if there are no tasks. </returns>
+void* ell_runtime_StartTasks(ell_runtime_TaskFunction taskFunction, void* args, int32_t argsSize, int32_t numTasks, void** returnValues);
+
+/// <summary> Waits for tasks started by `ell_runtime_StartTasks` to finish, running the ones that haven't started
+/// yet on the calling thread, and frees the handle. </summary>
+///
+/// <param name="taskGroup"> The handle returned by `ell_runtime_StartTasks`. Does nothing if null. </param>
+void ell_runtime_WaitTasks(void* taskGroup);
+
+/// <summary> Sets the BLAS threading policy of all models: a GEMM or GEMV call gets one thread for every
+/// `minOperationsPerThread` multiply-adds, up to `maxThreads`. Only OpenBLAS lets the thread count be changed. </summary>
+///
+/// <param name="maxThreads"> The maximum number of threads of a call, or 0 for the number of hardware threads. </param>
+/// <param name="minOperationsPerThread"> The number of multiply-adds that make it worth using another thread. </param>
+void ell_runtime_SetBlasThreadingPolicy(int32_t maxThreads, int64_t minOperationsPerThread);
+
+/// <summary> Sets the number of BLAS threads for a call of a given size, following the BLAS threading policy. Called by the models. </summary>
+///
+/// <param name="numOperations"> The number of multiply-adds of the call. </param>
+void ell_runtime_SetBlasThreadsForCall(int64_t numOperations);
+
+/// <summary> The profiling information of a profile region, laid out like each model's `<prefix>_ProfileRegionInfo`. </summary>
+typedef struct ell_runtime_ProfileRegionInfo
+{
+    int64_t count;
+    double totalTime;
+    const char* name;
+    int64_t cycles;
+    int64_t instructions;
+    int64_t l1DataCacheMisses;
+    int64_t lastLevelCacheMisses;
+    int64_t branchMisses;
+} ell_runtime_ProfileRegionInfo;
+
+/// <summary> Adds a model's profiler to the registry. Called by the models' initializers when profiling is enabled. </summary>
+///
+/// <param name="moduleName"> The name of the model's module. </param>
+/// <param name="getNumRegions"> The model's `GetNumRegions` function. </param>
+/// <param name="getRegionProfilingInfo"> The model's `GetRegionProfilingInfo` function. </param>
+/// <param name="resetRegionProfilingInfo"> The model's `ResetRegionProfilingInfo` function. </param>
+void ell_runtime_RegisterProfiler(const char* moduleName, int32_t (*getNumRegions)(void), ell_runtime_ProfileRegionInfo* (*getRegionProfilingInfo)(int32_t), void (*resetRegionProfilingInfo)(void));
+
+/// <summary> Removes a model's profiler from the registry. Called by the models' finalizers. </summary>
+///
+/// <param name="moduleName"> The name of the model's module. </param>
+void ell_runtime_UnregisterProfiler(const char* moduleName);
+
+/// <summary> Gets the number of models whose profilers are registered. </summary>
+int32_t ell_runtime_GetNumProfiledModules(void);
+
+/// <summary> Gets the module name of a registered model, or null if the index is out of range. </summary>
+///
+/// <param name="moduleIndex"> The index of the model, in the order they were registered. </param>
+const char* ell_runtime_GetProfiledModuleName(int32_t moduleIndex);
+
+/// <summary> Gets the number of profile regions of a registered model, or 0 if the index is out of range. </summary>
+///
+/// <param name="moduleIndex"> The index of the model, in the order they were registered. </param>
+int32_t ell_runtime_GetNumProfileRegions(int32_t moduleIndex);
+
+/// <summary> Gets the profiling information of a profile region of a registered model, or null if an index is out of range. </summary>
+///
+/// <param name="moduleIndex"> The index of the model, in the order they were registered. </param>
+/// <param name="regionIndex"> The index of the region. </param>
+ell_runtime_ProfileRegionInfo* ell_runtime_GetProfileRegionInfo(int32_t moduleIndex, int32_t regionIndex);
+
+/// <summary> Resets the profiling information of all registered models. </summary>
+void ell_runtime_ResetProfileRegions(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,376 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     GpuRuntime.cpp (runtime)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "GpuRuntime.h"
+
+#include <math/include/BlasWrapper.h>
+#include <math/include/Matrix.h>
+
+#if ELL_RUNTIME_CUDA
+#include <cublas_v2.h>
+#include <cuda_runtime.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+using namespace ell;
+
+namespace
+{
+std::atomic<int64_t> nextModuleId(1);
+
+template <typename ValueType>
+void CpuGemm(bool transposeA, bool transposeB, int m, int n, int k, const ValueType* A, int lda, const ValueType* B, int ldb, ValueType* C, int ldc)
+{
+#if USE_BLAS
+    auto toTranspose = [](bool transpose) { return transpose ? math::MatrixTranspose::transpose : math::MatrixTranspose::noTranspose; };
+    math::Blas::Gemm(math::MatrixLayout::rowMajor, toTranspose(transposeA), toTranspose(transposeB), m, n, k, static_cast<ValueType>(1), A, lda, B, ldb, static_cast<ValueType>(0), C, ldc);
+#else
+    for (int i = 0; i < m; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            ValueType sum = 0;
+            for (int p = 0; p < k; ++p)
+            {
+                sum += A[transposeA ? p * lda + i : i * lda + p] * B[transposeB ? j * ldb + p : p * ldb + j];
+            }
+            C[i * ldc + j] = sum;
+        }
+    }
+#endif
+}
+
+#if ELL_RUNTIME_CUDA
+// Products are split into chunks of at least this many rows, so each chunk keeps the GPU busy
+const int c_minChunkRows = 256;
+const int c_maxNumChunks = 8;
+
+// A device allocation that only grows
+class DeviceBuffer
+{
+public:
+    bool Reserve(size_t size)
+    {
+        if (size <= _size)
+        {
+            return true;
+        }
+        Release();
+        if (cudaMalloc(&_data, size) != cudaSuccess)
+        {
+            _data = nullptr;
+            return false;
+        }
+        _size = size;
+        return true;
+    }
+
+    void Release()
+    {
+        if (_data != nullptr)
+        {
+            cudaFree(_data);
+        }
+        _data = nullptr;
+        _size = 0;
+    }
+
+    template <typename ValueType>
+    ValueType* Get() const
+    {
+        return static_cast<ValueType*>(_data);
+    }
+
+    size_t Size() const { return _size; }
+
+private:
+    void* _data = nullptr;
+    size_t _size = 0;
+};
+
+cublasStatus_t CublasGemm(cublasHandle_t handle, cublasOperation_t transposeA, cublasOperation_t transposeB, int m, int n, int k, const float* A, int lda, const float* B, int ldb, float* C, int ldc)
+{
+    const float alpha = 1;
+    const float beta = 0;
+    return cublasSgemm(handle, transposeA, transposeB, m, n, k, &alpha, A, lda, B, ldb, &beta, C, ldc);
+}
+
+cublasStatus_t CublasGemm(cublasHandle_t handle, cublasOperation_t transposeA, cublasOperation_t transposeB, int m, int n, int k, const double* A, int lda, const double* B, int ldb, double* C, int ldc)
+{
+    const double alpha = 1;
+    const double beta = 0;
+    return cublasDgemm(handle, transposeA, transposeB, m, n, k, &alpha, A, lda, B, ldb, &beta, C, ldc);
+}
+
+class GpuContext
+{
+public:
+    // Returns null if there's no usable device
+    static GpuContext* Get()
+    {
+        // Never destroyed, since models may still run while static destructors do
+        static GpuContext* context = [] {
+            int numDevices = 0;
+            if (cudaGetDeviceCount(&numDevices) != cudaSuccess || numDevices == 0)
+            {
+                return static_cast<GpuContext*>(nullptr);
+            }
+            auto newContext = new GpuContext();
+            if (!newContext->_isValid)
+            {
+                delete newContext;
+                return static_cast<GpuContext*>(nullptr);
+            }
+            return newContext;
+        }();
+        return context;
+    }
+
+    // Returns false if the product couldn't be computed on the device
+    template <typename ValueType>
+    bool Gemm(bool transposeA, bool transposeB, int m, int n, int k, const ValueType* A, int lda, const ValueType* B, int ldb, ValueType* C, int ldc, int constantOperands, int64_t moduleId)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        bool ok = true;
+        auto check = [&ok](bool succeeded) { ok = ok && succeeded; };
+
+        // The stored shapes of the operands. On the device they're packed, so their row stride is their number of columns.
+        const int aRows = transposeA ? k : m;
+        const int aColumns = transposeA ? m : k;
+        const int bRows = transposeB ? n : k;
+        const int bColumns = transposeB ? k : n;
+
+        const ValueType* deviceB = nullptr;
+        if (constantOperands & ell_runtime_ConstantB)
+        {
+            deviceB = GetConstant(moduleId, B, bRows, bColumns, ldb);
+            check(deviceB != nullptr);
+        }
+        else if (ok && _variableB.Reserve(sizeof(ValueType) * bRows * bColumns))
+        {
+            deviceB = _variableB.Get<ValueType>();
+            check(Upload(_variableB.Get<ValueType>(), B, bRows, bColumns, ldb, _streams[0]));
+        }
+        else
+        {
+            check(false);
+        }
+
+        // A non-transposed A that changes is uploaded a chunk of rows at a time, with the rows of C it produces. Any
+        // other A is uploaded whole, before the first chunk.
+        const bool isConstantA = (constantOperands & ell_runtime_ConstantA) != 0;
+        const bool uploadAChunks = !isConstantA && !transposeA;
+        const ValueType* deviceA = nullptr;
+        if (isConstantA)
+        {
+            deviceA = GetConstant(moduleId, A, aRows, aColumns, lda);
+            check(deviceA != nullptr);
+        }
+        else if (!uploadAChunks)
+        {
+            check(_variableA.Reserve(sizeof(ValueType) * aRows * aColumns) && Upload(_variableA.Get<ValueType>(), A, aRows, aColumns, lda, _streams[0]));
+            deviceA = _variableA.Get<ValueType>();
+        }
+
+        // The second stream waits for the operands uploaded on the first
+        check(cudaEventRecord(_operandsReady, _streams[0]) == cudaSuccess && cudaStreamWaitEvent(_streams[1], _operandsReady, 0) == cudaSuccess);
+        if (!ok)
+        {
+            return false;
+        }
+
+        // Consecutive chunks alternate between the streams, so one chunk's transfers overlap the next one's product
+        const int numChunks = std::max(1, std::min(c_maxNumChunks, m / c_minChunkRows));
+        const int chunkRows = (m + numChunks - 1) / numChunks;
+        for (int chunk = 0; chunk < numChunks && ok; ++chunk)
+        {
+            const int streamIndex = chunk % 2;
+            auto stream = _streams[streamIndex];
+            const int firstRow = chunk * chunkRows;
+            const int numRows = std::min(chunkRows, m - firstRow);
+
+            const ValueType* chunkA = nullptr;
+            if (uploadAChunks)
+            {
+                auto& buffer = _chunkA[streamIndex];
+                check(buffer.Reserve(sizeof(ValueType) * numRows * k) && Upload(buffer.Get<ValueType>(), A + static_cast<size_t>(firstRow) * lda, numRows, k, lda, stream));
+                chunkA = buffer.Get<ValueType>();
+            }
+            else
+            {
+                // Row i of op(A) starts at row i of a stored A, or at column i of a stored transposed A
+                chunkA = deviceA + (transposeA ? firstRow : static_cast<size_t>(firstRow) * aColumns);
+            }
+
+            // cuBLAS is column-major, so the row-major C = op(A) * op(B) is computed as C' = op(B)' * op(A)'
+            auto& chunkC = _chunkC[streamIndex];
+            check(chunkC.Reserve(sizeof(ValueType) * numRows * n));
+            check(ok && cublasSetStream(_handle, stream) == CUBLAS_STATUS_SUCCESS);
+            check(ok && CublasGemm(_handle, transposeB ? CUBLAS_OP_T : CUBLAS_OP_N, transposeA ? CUBLAS_OP_T : CUBLAS_OP_N, n, numRows, k, deviceB, bColumns, chunkA, aColumns, chunkC.Get<ValueType>(), n) == CUBLAS_STATUS_SUCCESS);
+            check(ok && cudaMemcpy2DAsync(C + static_cast<size_t>(firstRow) * ldc, sizeof(ValueType) * ldc, chunkC.Get<ValueType>(), sizeof(ValueType) * n, sizeof(ValueType) * n, numRows, cudaMemcpyDeviceToHost, stream) == cudaSuccess);
+        }
+
+        check(cudaStreamSynchronize(_streams[0]) == cudaSuccess);
+        check(cudaStreamSynchronize(_streams[1]) == cudaSuccess);
+        return ok;
+    }
+
+    void ReleaseConstants()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& constant : _constants)
+        {
+            constant.second.Release();
+        }
+        _constants.clear();
+    }
+
+    void ReleaseConstants(int64_t moduleId)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto begin = _constants.lower_bound(ConstantKey{ moduleId, 0, 0 });
+        auto end = _constants.lower_bound(ConstantKey{ moduleId + 1, 0, 0 });
+        for (auto constant = begin; constant != end; ++constant)
+        {
+            constant->second.Release();
+        }
+        _constants.erase(begin, end);
+    }
+
+private:
+    GpuContext()
+    {
+        _isValid = cublasCreate(&_handle) == CUBLAS_STATUS_SUCCESS &&
+                   cudaStreamCreateWithFlags(&_streams[0], cudaStreamNonBlocking) == cudaSuccess &&
+                   cudaStreamCreateWithFlags(&_streams[1], cudaStreamNonBlocking) == cudaSuccess &&
+                   cudaEventCreateWithFlags(&_operandsReady, cudaEventDisableTiming) == cudaSuccess;
+    }
+
+    // Copies a row-major matrix to the device, packing its rows
+    template <typename ValueType>
+    static bool Upload(ValueType* destination, const ValueType* source, int numRows, int numColumns, int sourceStride, cudaStream_t stream)
+    {
+        return cudaMemcpy2DAsync(destination, sizeof(ValueType) * numColumns, source, sizeof(ValueType) * sourceStride, sizeof(ValueType) * numColumns, numRows, cudaMemcpyHostToDevice, stream) == cudaSuccess;
+    }
+
+    // The module comes first, so a module's constants are next to each other
+    using ConstantKey = std::tuple<int64_t, uintptr_t, size_t>;
+
+    // Gets the device copy of a constant operand, uploading it the first time
+    template <typename ValueType>
+    const ValueType* GetConstant(int64_t moduleId, const ValueType* hostData, int numRows, int numColumns, int stride)
+    {
+        const auto size = sizeof(ValueType) * numRows * numColumns;
+        const ConstantKey key{ moduleId, reinterpret_cast<uintptr_t>(hostData), size };
+        auto& buffer = _constants[key];
+        if (buffer.Size() == 0)
+        {
+            if (!buffer.Reserve(size) || !Upload(buffer.Get<ValueType>(), hostData, numRows, numColumns, stride, _streams[0]) || cudaStreamSynchronize(_streams[0]) != cudaSuccess)
+            {
+                buffer.Release();
+                _constants.erase(key);
+                return nullptr;
+            }
+        }
+        return buffer.Get<ValueType>();
+    }
+
+    bool _isValid = false;
+    cublasHandle_t _handle = nullptr;
+    cudaStream_t _streams[2] = {};
+    cudaEvent_t _operandsReady = nullptr;
+
+    std::mutex _mutex;
+    std::map<ConstantKey, DeviceBuffer> _constants;
+    DeviceBuffer _variableA;
+    DeviceBuffer _variableB;
+    DeviceBuffer _chunkA[2];
+    DeviceBuffer _chunkC[2];
+};
+#endif
+
+template <typename ValueType>
+void Gemm(int32_t transposeA, int32_t transposeB, int32_t m, int32_t n, int32_t k, const ValueType* A, int32_t lda, const ValueType* B, int32_t ldb, ValueType* C, int32_t ldc, int32_t constantOperands, int64_t moduleId)
+{
+    if (m <= 0 || n <= 0)
+    {
+        return;
+    }
+
+#if ELL_RUNTIME_CUDA
+    if (auto context = GpuContext::Get())
+    {
+        if (k > 0 && context->Gemm(transposeA != 0, transposeB != 0, m, n, k, A, lda, B, ldb, C, ldc, constantOperands, moduleId))
+        {
+            return;
+        }
+    }
+#else
+    (void)constantOperands;
+    (void)moduleId;
+#endif
+    CpuGemm(transposeA != 0, transposeB != 0, m, n, k, A, lda, B, ldb, C, ldc);
+}
+} // namespace
+
+extern "C" {
+
+int64_t ell_runtime_GpuBeginModule(void)
+{
+    return nextModuleId++;
+}
+
+void ell_runtime_GpuEndModule(int64_t moduleId)
+{
+#if ELL_RUNTIME_CUDA
+    if (auto context = GpuContext::Get())
+    {
+        context->ReleaseConstants(moduleId);
+    }
+#else
+    (void)moduleId;
+#endif
+}
+
+int32_t ell_runtime_GpuIsAvailable(void)
+{
+#if ELL_RUNTIME_CUDA
+    return GpuContext::Get() != nullptr ? 1 : 0;
+#else
+    return 0;
+#endif
+}
+
+void ell_runtime_GpuSgemm(int32_t transposeA, int32_t transposeB, int32_t m, int32_t n, int32_t k, const float* A, int32_t lda, const float* B, int32_t ldb, float* C, int32_t ldc, int32_t constantOperands, int64_t moduleId)
+{
+    Gemm(transposeA, transposeB, m, n, k, A, lda, B, ldb, C, ldc, constantOperands, moduleId);
+}
+
+void ell_runtime_GpuDgemm(int32_t transposeA, int32_t transposeB, int32_t m, int32_t n, int32_t k, const double* A, int32_t lda, const double* B, int32_t ldb, double* C, int32_t ldc, int32_t constantOperands, int64_t moduleId)
+{
+    Gemm(transposeA, transposeB, m, n, k, A, lda, B, ldb, C, ldc, constantOperands, moduleId);
+}
+
+void ell_runtime_GpuReleaseConstants(void)
+{
+#if ELL_RUNTIME_CUDA
+    if (auto context = GpuContext::Get())
+    {
+        context->ReleaseConstants();
+    }
+#endif
+}
+
+} // extern "C"
@@ -0,0 +1,390 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SharedRuntime.cpp (runtime)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SharedRuntime.h"
+
+#include <math/include/BlasWrapper.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ell;
+
+namespace
+{
+// A function run on an array of argument structs
+class TaskGroup
+{
+public:
+    TaskGroup(ell_runtime_TaskFunction taskFunction, void* args, int32_t argsSize, int32_t numTasks, void** returnValues) :
+        _taskFunction(taskFunction),
+        _args(static_cast<char*>(args)),
+        _argsSize(argsSize),
+        _numTasks(numTasks),
+        _returnValues(returnValues)
+    {
+    }
+
+    // Runs the next task that hasn't started yet, returning false if there are none
+    bool RunNextTask()
+    {
+        auto taskIndex = _nextTask.fetch_add(1);
+        if (taskIndex >= _numTasks)
+        {
+            return false;
+        }
+
+        auto returnValue = _taskFunction(_args + static_cast<size_t>(taskIndex) * _argsSize);
+        if (_returnValues != nullptr)
+        {
+            _returnValues[taskIndex] = returnValue;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (++_numFinished == _numTasks)
+        {
+            _finished.notify_all();
+        }
+        return true;
+    }
+
+    bool IsExhausted() const { return _nextTask.load() >= _numTasks; }
+
+    void Wait()
+    {
+        while (RunNextTask())
+        {
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _finished.wait(lock, [this] { return _numFinished == _numTasks; });
+    }
+
+private:
+    ell_runtime_TaskFunction _taskFunction;
+    char* _args;
+    int32_t _argsSize;
+    int32_t _numTasks;
+    void** _returnValues;
+
+    std::atomic<int32_t> _nextTask{ 0 };
+    int32_t _numFinished = 0;
+    std::mutex _mutex;
+    std::condition_variable _finished;
+};
+
+int32_t GetDefaultNumThreads()
+{
+    if (auto value = std::getenv("ELL_RUNTIME_THREADS"))
+    {
+        auto numThreads = std::atoi(value);
+        if (numThreads > 0)
+        {
+            return numThreads;
+        }
+    }
+    return std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()) - 1);
+}
+
+// The thread pool shared by all the models in the process. Workers take the oldest task group that still has
+// tasks to start, one task at a time, so concurrent models share the workers.
+class ThreadPool
+{
+public:
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _shutDown = true;
+        }
+        _workAvailable.notify_all();
+        for (auto& thread : _threads)
+        {
+            thread.join();
+        }
+    }
+
+    bool SetNumThreads(int32_t numThreads)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (numThreads <= 0)
+        {
+            numThreads = GetDefaultNumThreads();
+        }
+
+        if (!_threads.empty())
+        {
+            return numThreads == static_cast<int32_t>(_threads.size());
+        }
+        _numThreads = numThreads;
+        return true;
+    }
+
+    int32_t GetNumThreads()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _numThreads > 0 ? _numThreads : GetDefaultNumThreads();
+    }
+
+    void Start(std::shared_ptr<TaskGroup> group)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_threads.empty())
+            {
+                StartThreads();
+            }
+            _groups.push_back(std::move(group));
+        }
+        _workAvailable.notify_all();
+    }
+
+private:
+    // Called with the mutex held
+    void StartThreads()
+    {
+        if (_numThreads <= 0)
+        {
+            _numThreads = GetDefaultNumThreads();
+        }
+
+        for (int32_t index = 0; index < _numThreads; ++index)
+        {
+            _threads.emplace_back([this] { RunWorker(); });
+        }
+    }
+
+    void RunWorker()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true)
+        {
+            _workAvailable.wait(lock, [this] { return _shutDown || !_groups.empty(); });
+            if (_shutDown)
+            {
+                return;
+            }
+
+            auto group = _groups.front();
+            if (group->IsExhausted())
+            {
+                _groups.pop_front();
+                continue;
+            }
+
+            lock.unlock();
+            group->RunNextTask();
+            lock.lock();
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _workAvailable;
+    std::deque<std::shared_ptr<TaskGroup>> _groups;
+    std::vector<std::thread> _threads;
+    int32_t _numThreads = 0;
+    bool _shutDown = false;
+};
+
+ThreadPool& GetThreadPool()
+{
+    static ThreadPool threadPool;
+    return threadPool;
+}
+
+struct RegisteredProfiler
+{
+    std::string moduleName;
+    int32_t (*getNumRegions)(void);
+    ell_runtime_ProfileRegionInfo* (*getRegionProfilingInfo)(int32_t);
+    void (*resetRegionProfilingInfo)(void);
+};
+
+class ProfilerRegistry
+{
+public:
+    void Register(RegisteredProfiler profiler)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Remove(profiler.moduleName);
+        _profilers.push_back(std::move(profiler));
+    }
+
+    void Unregister(const std::string& moduleName)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Remove(moduleName);
+    }
+
+    int32_t Size()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return static_cast<int32_t>(_profilers.size());
+    }
+
+    // Returns false if the index is out of range
+    bool Get(int32_t index, RegisteredProfiler& profiler)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (index < 0 || index >= static_cast<int32_t>(_profilers.size()))
+        {
+            return false;
+        }
+        profiler = _profilers[index];
+        return true;
+    }
+
+    std::vector<RegisteredProfiler> GetAll()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _profilers;
+    }
+
+private:
+    void Remove(const std::string& moduleName)
+    {
+        _profilers.erase(std::remove_if(_profilers.begin(), _profilers.end(), [&moduleName](const RegisteredProfiler& profiler) { return profiler.moduleName == moduleName; }), _profilers.end());
+    }
+
+    std::mutex _mutex;
+    std::vector<RegisteredProfiler> _profilers;
+};
+
+ProfilerRegistry& GetProfilerRegistry()
+{
+    // Never destroyed, since the models' finalizers may unregister themselves after static destructors have run
+    static auto registry = new ProfilerRegistry();
+    return *registry;
+}
+
+// The names returned by `ell_runtime_GetProfiledModuleName` must outlive the call
+const char* GetModuleName(const RegisteredProfiler& profiler)
+{
+    static std::mutex mutex;
+    static auto names = new std::deque<std::string>();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find(names->begin(), names->end(), profiler.moduleName);
+    if (it == names->end())
+    {
+        names->push_back(profiler.moduleName);
+        return names->back().c_str();
+    }
+    return it->c_str();
+}
+} // namespace
+
+extern "C" {
+
+int32_t ell_runtime_SetNumThreads(int32_t numThreads)
+{
+    return GetThreadPool().SetNumThreads(numThreads) ? 0 : -1;
+}
+
+int32_t ell_runtime_GetNumThreads(void)
+{
+    return GetThreadPool().GetNumThreads();
+}
+
+void* ell_runtime_StartTasks(ell_runtime_TaskFunction taskFunction, void* args, int32_t argsSize, int32_t numTasks, void** returnValues)
+{
+    if (taskFunction == nullptr || numTasks <= 0)
+    {
+        return nullptr;
+    }
+
+    // The handle keeps the group alive until it's waited for, even after the workers are done with it
+    auto group = std::make_shared<TaskGroup>(taskFunction, args, argsSize, numTasks, returnValues);
+    GetThreadPool().Start(group);
+    return new std::shared_ptr<TaskGroup>(std::move(group));
+}
+
+void ell_runtime_WaitTasks(void* taskGroup)
+{
+    if (taskGroup == nullptr)
+    {
+        return;
+    }
+
+    std::unique_ptr<std::shared_ptr<TaskGroup>> group(static_cast<std::shared_ptr<TaskGroup>*>(taskGroup));
+    (*group)->Wait();
+}
+
+void ell_runtime_SetBlasThreadingPolicy(int32_t maxThreads, int64_t minOperationsPerThread)
+{
+    math::Blas::ThreadingPolicy policy;
+    policy.maxThreads = std::max(maxThreads, 0);
+    policy.minOperationsPerThread = static_cast<size_t>(std::max<int64_t>(minOperationsPerThread, 0));
+    math::Blas::SetThreadingPolicy(policy);
+}
+
+void ell_runtime_SetBlasThreadsForCall(int64_t numOperations)
+{
+    math::Blas::SetNumThreadsForCall(static_cast<size_t>(std::max<int64_t>(numOperations, 0)));
+}
+
+void ell_runtime_RegisterProfiler(const char* moduleName, int32_t (*getNumRegions)(void), ell_runtime_ProfileRegionInfo* (*getRegionProfilingInfo)(int32_t), void (*resetRegionProfilingInfo)(void))
+{
+    if (moduleName == nullptr || getNumRegions == nullptr || getRegionProfilingInfo == nullptr || resetRegionProfilingInfo == nullptr)
+    {
+        return;
+    }
+    GetProfilerRegistry().Register({ moduleName, getNumRegions, getRegionProfilingInfo, resetRegionProfilingInfo });
+}
+
+void ell_runtime_UnregisterProfiler(const char* moduleName)
+{
+    if (moduleName != nullptr)
+    {
+        GetProfilerRegistry().Unregister(moduleName);
+    }
+}
+
+int32_t ell_runtime_GetNumProfiledModules(void)
+{
+    return GetProfilerRegistry().Size();
+}
+
+const char* ell_runtime_GetProfiledModuleName(int32_t moduleIndex)
+{
+    RegisteredProfiler profiler;
+    return GetProfilerRegistry().Get(moduleIndex, profiler) ? GetModuleName(profiler) : nullptr;
+}
+
+int32_t ell_runtime_GetNumProfileRegions(int32_t moduleIndex)
+{
+    RegisteredProfiler profiler;
+    return GetProfilerRegistry().Get(moduleIndex, profiler) ? profiler.getNumRegions() : 0;
+}
+
+ell_runtime_ProfileRegionInfo* ell_runtime_GetProfileRegionInfo(int32_t moduleIndex, int32_t regionIndex)
+{
+    RegisteredProfiler profiler;
+    if (!GetProfilerRegistry().Get(moduleIndex, profiler) || regionIndex < 0 || regionIndex >= profiler.getNumRegions())
+    {
+        return nullptr;
+    }
+    return profiler.getRegionProfilingInfo(regionIndex);
+}
+
+void ell_runtime_ResetProfileRegions(void)
+{
+    for (const auto& profiler : GetProfilerRegistry().GetAll())
+    {
+        profiler.resetRegionProfilingInfo();
+    }
+}
+
+} // extern "C"
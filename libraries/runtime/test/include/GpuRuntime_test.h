@@ -0,0 +1,16 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     GpuRuntime_test.h (runtime_test)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+namespace ell
+{
+void TestGpuGemm(bool transposeA, bool transposeB, int constantOperands);
+void TestGpuGemmDouble();
+void TestGpuConstantsPerModule();
+} // namespace ell
@@ -0,0 +1,17 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SharedRuntime_test.h (runtime_test)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+namespace ell
+{
+void TestSharedRuntimeTasks();
+void TestSharedRuntimeConcurrentClients();
+void TestSharedRuntimeNumThreads();
+void TestSharedRuntimeProfilerRegistry();
+} // namespace ell
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     GpuRuntime_test.cpp (runtime_test)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "GpuRuntime_test.h"
+
+#include <runtime/include/GpuRuntime.h>
+
+#include <testing/include/testing.h>
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace ell
+{
+namespace
+{
+    template <typename ValueType>
+    std::vector<ValueType> MakeMatrix(int numRows, int stride, int offset)
+    {
+        std::vector<ValueType> values(numRows * stride);
+        for (size_t index = 0; index < values.size(); ++index)
+        {
+            values[index] = static_cast<ValueType>(static_cast<int>((index * 7 + offset) % 11) - 5);
+        }
+        return values;
+    }
+
+    template <typename ValueType>
+    std::vector<ValueType> ReferenceGemm(bool transposeA, bool transposeB, int m, int n, int k, const std::vector<ValueType>& A, int lda, const std::vector<ValueType>& B, int ldb, std::vector<ValueType> C, int ldc)
+    {
+        for (int i = 0; i < m; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                ValueType sum = 0;
+                for (int p = 0; p < k; ++p)
+                {
+                    sum += A[transposeA ? p * lda + i : i * lda + p] * B[transposeB ? j * ldb + p : p * ldb + j];
+                }
+                C[i * ldc + j] = sum;
+            }
+        }
+        return C;
+    }
+} // namespace
+
+void TestGpuGemm(bool transposeA, bool transposeB, int constantOperands)
+{
+    // Enough rows to be split into chunks on the GPU, and padded rows that must be left alone
+    const int m = 600, n = 24, k = 17;
+    const int lda = (transposeA ? m : k) + 3;
+    const int ldb = (transposeB ? k : n) + 2;
+    const int ldc = n + 5;
+    auto A = MakeMatrix<float>(transposeA ? k : m, lda, 1);
+    auto B = MakeMatrix<float>(transposeB ? n : k, ldb, 4);
+    std::vector<float> C(m * ldc, -1.0f);
+    auto expected = ReferenceGemm(transposeA, transposeB, m, n, k, A, lda, B, ldb, C, ldc);
+
+    // The second call reuses the device copies of the constant operands
+    bool ok = true;
+    auto moduleId = ell_runtime_GpuBeginModule();
+    for (int iteration = 0; iteration < 2; ++iteration)
+    {
+        std::vector<float> result = C;
+        ell_runtime_GpuSgemm(transposeA, transposeB, m, n, k, A.data(), lda, B.data(), ldb, result.data(), ldc, constantOperands, moduleId);
+        ok = ok && testing::IsEqual(result, expected);
+    }
+    ell_runtime_GpuEndModule(moduleId);
+
+    std::stringstream id;
+    id << std::boolalpha << "TestGpuGemm(transposeA = " << transposeA << ", transposeB = " << transposeB << ", constantOperands = " << constantOperands << ", gpu = " << (ell_runtime_GpuIsAvailable() != 0) << ")";
+    testing::ProcessTest(id.str(), ok);
+}
+
+void TestGpuGemmDouble()
+{
+    const int m = 5, n = 3, k = 4;
+    auto A = MakeMatrix<double>(m, k, 2);
+    auto B = MakeMatrix<double>(k, n, 3);
+    std::vector<double> result(m * n);
+    auto expected = ReferenceGemm(false, false, m, n, k, A, k, B, n, result, n);
+    auto moduleId = ell_runtime_GpuBeginModule();
+    ell_runtime_GpuDgemm(0, 0, m, n, k, A.data(), k, B.data(), n, result.data(), n, ell_runtime_ConstantB, moduleId);
+    ell_runtime_GpuReleaseConstants();
+    testing::ProcessTest("TestGpuGemmDouble", testing::IsEqual(result, expected));
+}
+
+void TestGpuConstantsPerModule()
+{
+    // A second module whose constant operand is at the same address as an unloaded module's must not see its old device copy
+    const int m = 4, n = 3, k = 5;
+    auto A = MakeMatrix<float>(m, k, 1);
+    auto B = MakeMatrix<float>(k, n, 2);
+    std::vector<float> result(m * n);
+
+    auto firstModule = ell_runtime_GpuBeginModule();
+    ell_runtime_GpuSgemm(0, 0, m, n, k, A.data(), k, B.data(), n, result.data(), n, ell_runtime_ConstantB, firstModule);
+    auto firstExpected = ReferenceGemm(false, false, m, n, k, A, k, B, n, result, n);
+    bool ok = testing::IsEqual(result, firstExpected);
+    ell_runtime_GpuEndModule(firstModule);
+
+    auto newB = MakeMatrix<float>(k, n, 7);
+    std::copy(newB.begin(), newB.end(), B.begin());
+    auto secondModule = ell_runtime_GpuBeginModule();
+    ok = ok && secondModule != firstModule;
+    ell_runtime_GpuSgemm(0, 0, m, n, k, A.data(), k, B.data(), n, result.data(), n, ell_runtime_ConstantB, secondModule);
+    ok = ok && testing::IsEqual(result, ReferenceGemm(false, false, m, n, k, A, k, B, n, result, n));
+    ell_runtime_GpuEndModule(secondModule);
+
+    testing::ProcessTest("TestGpuConstantsPerModule", ok);
+}
+} // namespace ell
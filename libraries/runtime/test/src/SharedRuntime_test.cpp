@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SharedRuntime_test.cpp (runtime_test)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SharedRuntime_test.h"
+
+#include <runtime/include/SharedRuntime.h>
+
+#include <testing/include/testing.h>
+
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ell
+{
+namespace
+{
+    struct RangeTaskArgs
+    {
+        int* values;
+        int begin;
+        int end;
+    };
+
+    // Fills its range of the array with the indices, and returns the end of the range
+    void* FillRange(void* args)
+    {
+        auto rangeArgs = static_cast<RangeTaskArgs*>(args);
+        for (int index = rangeArgs->begin; index < rangeArgs->end; ++index)
+        {
+            rangeArgs->values[index] = index;
+        }
+        return rangeArgs->values + rangeArgs->end;
+    }
+
+    bool RunRangeTasks(int size, int numTasks)
+    {
+        std::vector<int> values(size, -1);
+        std::vector<RangeTaskArgs> args;
+        for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+        {
+            args.push_back({ values.data(), (size * taskIndex) / numTasks, (size * (taskIndex + 1)) / numTasks });
+        }
+        std::vector<void*> returnValues(numTasks);
+
+        auto tasks = ell_runtime_StartTasks(&FillRange, args.data(), static_cast<int32_t>(sizeof(RangeTaskArgs)), numTasks, returnValues.data());
+        ell_runtime_WaitTasks(tasks);
+
+        std::vector<int> expected(size);
+        std::iota(expected.begin(), expected.end(), 0);
+        bool ok = values == expected;
+        for (int taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+        {
+            ok = ok && returnValues[taskIndex] == values.data() + args[taskIndex].end;
+        }
+        return ok;
+    }
+
+    const int c_numRegions = 2;
+    ell_runtime_ProfileRegionInfo g_regions[c_numRegions] = { { 3, 1.5, "first", 0, 0, 0, 0, 0 }, { 5, 2.5, "second", 0, 0, 0, 0, 0 } };
+
+    int32_t GetNumRegions() { return c_numRegions; }
+    ell_runtime_ProfileRegionInfo* GetRegionProfilingInfo(int32_t regionIndex) { return &g_regions[regionIndex]; }
+    void ResetRegionProfilingInfo()
+    {
+        for (auto& region : g_regions)
+        {
+            region.count = 0;
+            region.totalTime = 0;
+        }
+    }
+} // namespace
+
+void TestSharedRuntimeTasks()
+{
+    testing::ProcessTest("Testing shared runtime tasks", RunRangeTasks(100, 7));
+    testing::ProcessTest("Testing shared runtime with more tasks than threads", RunRangeTasks(1000, 64));
+    testing::ProcessTest("Testing shared runtime with no tasks", ell_runtime_StartTasks(&FillRange, nullptr, 0, 0, nullptr) == nullptr);
+}
+
+void TestSharedRuntimeConcurrentClients()
+{
+    // Several "models" start tasks at the same time, and all share the one pool
+    const int numClients = 4;
+    std::vector<char> results(numClients, 0);
+    std::vector<std::thread> clients;
+    for (int clientIndex = 0; clientIndex < numClients; ++clientIndex)
+    {
+        clients.emplace_back([clientIndex, &results] {
+            bool ok = true;
+            for (int iteration = 0; iteration < 20; ++iteration)
+            {
+                ok = ok && RunRangeTasks(256, 8);
+            }
+            results[clientIndex] = ok ? 1 : 0;
+        });
+    }
+    for (auto& client : clients)
+    {
+        client.join();
+    }
+    testing::ProcessTest("Testing shared runtime with concurrent clients", results == std::vector<char>(numClients, 1));
+}
+
+void TestSharedRuntimeNumThreads()
+{
+    // The pool was started by the earlier tests, so its size is fixed now
+    auto numThreads = ell_runtime_GetNumThreads();
+    testing::ProcessTest("Testing shared runtime thread count", numThreads >= 1);
+    testing::ProcessTest("Testing shared runtime keeps its size", ell_runtime_SetNumThreads(numThreads) == 0 && ell_runtime_SetNumThreads(numThreads + 1) == -1 && ell_runtime_GetNumThreads() == numThreads);
+}
+
+void TestSharedRuntimeProfilerRegistry()
+{
+    ell_runtime_RegisterProfiler("modelA", &GetNumRegions, &GetRegionProfilingInfo, &ResetRegionProfilingInfo);
+    ell_runtime_RegisterProfiler("modelB", &GetNumRegions, &GetRegionProfilingInfo, &ResetRegionProfilingInfo);
+    ell_runtime_RegisterProfiler("modelA", &GetNumRegions, &GetRegionProfilingInfo, &ResetRegionProfilingInfo); // registering again replaces the old entry
+
+    testing::ProcessTest("Testing shared runtime profiler count", ell_runtime_GetNumProfiledModules() == 2);
+    testing::ProcessTest("Testing shared runtime profiler names", std::string(ell_runtime_GetProfiledModuleName(0)) == "modelB" && std::string(ell_runtime_GetProfiledModuleName(1)) == "modelA" && ell_runtime_GetProfiledModuleName(2) == nullptr);
+    testing::ProcessTest("Testing shared runtime profile regions", ell_runtime_GetNumProfileRegions(0) == c_numRegions && ell_runtime_GetProfileRegionInfo(0, 1)->count == 5 && std::strcmp(ell_runtime_GetProfileRegionInfo(0, 1)->name, "second") == 0);
+    testing::ProcessTest("Testing shared runtime profile region bounds", ell_runtime_GetProfileRegionInfo(0, c_numRegions) == nullptr && ell_runtime_GetProfileRegionInfo(5, 0) == nullptr);
+
+    ell_runtime_ResetProfileRegions();
+    testing::ProcessTest("Testing shared runtime profile reset", ell_runtime_GetProfileRegionInfo(1, 0)->count == 0);
+
+    ell_runtime_UnregisterProfiler("modelA");
+    ell_runtime_UnregisterProfiler("modelB");
+    testing::ProcessTest("Testing shared runtime profiler unregister", ell_runtime_GetNumProfiledModules() == 0);
+}
+} // namespace ell
@@ -0,0 +1,54 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     main.cpp (runtime_test)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "GpuRuntime_test.h"
+#include "SharedRuntime_test.h"
+
+#include <runtime/include/GpuRuntime.h>
+
+#include <testing/include/testing.h>
+
+#include <utilities/include/Exception.h>
+
+#include <iostream>
+
+using namespace ell;
+
+int main()
+{
+    try
+    {
+        TestSharedRuntimeTasks();
+        TestSharedRuntimeConcurrentClients();
+        TestSharedRuntimeNumThreads();
+        TestSharedRuntimeProfilerRegistry();
+
+        for (bool transposeA : { false, true })
+        {
+            for (bool transposeB : { false, true })
+            {
+                TestGpuGemm(transposeA, transposeB, 0);
+                TestGpuGemm(transposeA, transposeB, ell_runtime_ConstantA | ell_runtime_ConstantB);
+            }
+        }
+        TestGpuGemm(false, false, ell_runtime_ConstantB);
+        TestGpuGemmDouble();
+        TestGpuConstantsPerModule();
+    }
+    catch (const utilities::Exception& exception)
+    {
+        std::cerr << "ERROR, got ELL exception. Message: " << exception.GetMessage() << std::endl;
+        throw;
+    }
+
+    if (testing::DidTestFail())
+    {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     Benchmark.h (testing)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace testing
+{
+    /// <summary> The timings of a benchmark. All times are of a single call of the benchmarked function, in seconds. </summary>
+    struct BenchmarkResult
+    {
+        std::string name;
+        size_t numSamples = 0;
+        size_t callsPerSample = 0;
+        double flops = 0; // floating-point operations per call, or 0 if not known
+        double minSeconds = 0;
+        double medianSeconds = 0;
+        double p10Seconds = 0;
+        double p90Seconds = 0;
+
+        /// <summary> Gets the throughput at the median time. </summary>
+        ///
+        /// <returns> The number of billions of floating-point operations per second, or 0 if `flops` isn't known. </returns>
+        double GetGigaflopsPerSecond() const;
+    };
+
+    /// <summary> Gets a percentile of a set of values, interpolating linearly between the closest ranks. </summary>
+    ///
+    /// <param name="sortedValues"> The values, in ascending order. Must not be empty. </param>
+    /// <param name="percentile"> The percentile, from 0 to 100. </param>
+    ///
+    /// <returns> The percentile. </returns>
+    double GetPercentile(const std::vector<double>& sortedValues, double percentile);
+
+    /// <summary> Options for running benchmarks. </summary>
+    struct BenchmarkOptions
+    {
+        /// <summary> The number of timed samples of each benchmark. </summary>
+        size_t numSamples = 11;
+
+        /// <summary> A sample calls the function as many times as it takes to run for at least this long, so that short functions can be timed. </summary>
+        double minSampleSeconds = 0.01;
+
+        /// <summary> Only run the benchmarks whose name contains this string. </summary>
+        std::string filter;
+    };
+
+    /// <summary> A set of benchmarks, which are timed as they are added. </summary>
+    class BenchmarkSuite
+    {
+    public:
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="name"> The name of the suite. </param>
+        /// <param name="options"> The options for running the benchmarks. </param>
+        BenchmarkSuite(std::string name, BenchmarkOptions options = {});
+
+        /// <summary> Times a function, after calling it once to warm up, and prints the result if verbose. </summary>
+        ///
+        /// <param name="name"> The name of the benchmark, which must be unique in the suite. </param>
+        /// <param name="flops"> The number of floating-point operations of a call, or 0 if not meaningful. </param>
+        /// <param name="function"> The function to time. </param>
+        void Run(const std::string& name, double flops, const std::function<void()>& function);
+
+        /// <summary> Sets whether results are printed as they are measured. </summary>
+        ///
+        /// <param name="verbose"> true to print results. </param>
+        void SetVerbose(bool verbose) { _verbose = verbose; }
+
+        /// <summary> Gets the name of the suite. </summary>
+        ///
+        /// <returns> The name. </returns>
+        const std::string& GetName() const { return _name; }
+
+        /// <summary> Gets the results of the benchmarks run so far. </summary>
+        ///
+        /// <returns> The results. </returns>
+        const std::vector<BenchmarkResult>& GetResults() const { return _results; }
+
+        /// <summary> Writes the results as JSON. </summary>
+        ///
+        /// <param name="stream"> The stream to write to. </param>
+        void WriteJson(std::ostream& stream) const;
+
+    private:
+        std::string _name;
+        BenchmarkOptions _options;
+        std::vector<BenchmarkResult> _results;
+        bool _verbose = true;
+    };
+
+    /// <summary> Reads benchmark results written by `BenchmarkSuite::WriteJson`. </summary>
+    ///
+    /// <param name="stream"> The stream to read from. </param>
+    ///
+    /// <returns> The results. </returns>
+    std::vector<BenchmarkResult> ReadBenchmarkResults(std::istream& stream);
+
+    /// <summary> The comparison of a benchmark in two sets of results. </summary>
+    struct BenchmarkComparison
+    {
+        std::string name;
+        double baselineSeconds = 0;
+        double currentSeconds = 0;
+        bool isRegression = false;
+
+        /// <summary> Gets the ratio of the current median time to the baseline median time. </summary>
+        double GetRatio() const { return currentSeconds / baselineSeconds; }
+    };
+
+    /// <summary>
+    /// Compares the median times of the benchmarks that are in two sets of results. A benchmark has regressed
+    /// if it got slower by more than the tolerance, and also by more than the spread of its baseline samples.
+    /// </summary>
+    ///
+    /// <param name="baseline"> The baseline results. </param>
+    /// <param name="current"> The current results. </param>
+    /// <param name="tolerance"> The relative slowdown that is allowed, for instance 0.1 for 10%. </param>
+    ///
+    /// <returns> The comparisons, in the order of the current results. </returns>
+    std::vector<BenchmarkComparison> CompareBenchmarkResults(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& current, double tolerance);
+
+    /// <summary>
+    /// The main function of a benchmark program. With no arguments, runs the benchmarks and prints their results.
+    /// Arguments:
+    ///   --output file       also write the results to a JSON file
+    ///   --filter text       only run the benchmarks whose name contains text
+    ///   --samples n         the number of samples of each benchmark
+    ///   --compare a b       compare the results in JSON files a (the baseline) and b, instead of running benchmarks
+    ///   --tolerance t       the relative slowdown that --compare allows (default 0.1)
+    /// </summary>
+    ///
+    /// <param name="argc"> The number of command-line arguments. </param>
+    /// <param name="argv"> The command-line arguments. </param>
+    /// <param name="suiteName"> The name of the benchmark suite. </param>
+    /// <param name="addBenchmarks"> A function that runs the benchmarks of the suite. </param>
+    ///
+    /// <returns> The exit code: 0 on success, 1 if --compare found a regression, 2 on a bad command line. </returns>
+    int RunBenchmarkProgram(int argc, char** argv, const std::string& suiteName, const std::function<void(BenchmarkSuite&)>& addBenchmarks);
+} // namespace testing
+} // namespace ell
@@ -0,0 +1,308 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     Benchmark.cpp (testing)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmark.h"
+
+#include <utilities/include/Archiver.h>
+#include <utilities/include/IArchivable.h>
+#include <utilities/include/JsonArchiver.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace ell
+{
+namespace testing
+{
+    namespace
+    {
+        // The archived form of a benchmark result
+        class ArchivedBenchmarkResult : public utilities::IArchivable
+        {
+        public:
+            ArchivedBenchmarkResult() = default;
+            ArchivedBenchmarkResult(const BenchmarkResult& result) :
+                result(result) {}
+
+            static std::string GetTypeName() { return "BenchmarkResult"; }
+
+            void WriteToArchive(utilities::Archiver& archiver) const override
+            {
+                archiver["name"] << result.name;
+                archiver["samples"] << result.numSamples;
+                archiver["calls_per_sample"] << result.callsPerSample;
+                archiver["flops"] << result.flops;
+                archiver["min_s"] << result.minSeconds;
+                archiver["median_s"] << result.medianSeconds;
+                archiver["p10_s"] << result.p10Seconds;
+                archiver["p90_s"] << result.p90Seconds;
+                archiver["gflops_per_s"] << result.GetGigaflopsPerSecond();
+            }
+
+            void ReadFromArchive(utilities::Unarchiver& archiver) override
+            {
+                archiver["name"] >> result.name;
+                archiver["samples"] >> result.numSamples;
+                archiver["calls_per_sample"] >> result.callsPerSample;
+                archiver["flops"] >> result.flops;
+                archiver["min_s"] >> result.minSeconds;
+                archiver["median_s"] >> result.medianSeconds;
+                archiver["p10_s"] >> result.p10Seconds;
+                archiver["p90_s"] >> result.p90Seconds;
+                double gigaflopsPerSecond = 0; // derived from the other fields
+                archiver.OptionalProperty("gflops_per_s", 0.0) >> gigaflopsPerSecond;
+            }
+
+            BenchmarkResult result;
+
+        protected:
+            std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+        };
+
+        // The archived form of the results of a benchmark suite
+        class ArchivedBenchmarkSuite : public utilities::IArchivable
+        {
+        public:
+            static std::string GetTypeName() { return "BenchmarkSuite"; }
+
+            void WriteToArchive(utilities::Archiver& archiver) const override
+            {
+                archiver["suite"] << suite;
+                archiver["benchmarks"] << benchmarks;
+            }
+
+            void ReadFromArchive(utilities::Unarchiver& archiver) override
+            {
+                archiver["suite"] >> suite;
+                archiver["benchmarks"] >> benchmarks;
+            }
+
+            std::string suite;
+            std::vector<ArchivedBenchmarkResult> benchmarks;
+
+        protected:
+            std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+        };
+    } // namespace
+
+    double GetPercentile(const std::vector<double>& sortedValues, double percentile)
+    {
+        // linear interpolation between the closest ranks
+        auto position = percentile / 100.0 * (sortedValues.size() - 1);
+        auto lower = static_cast<size_t>(std::floor(position));
+        auto upper = std::min(lower + 1, sortedValues.size() - 1);
+        auto fraction = position - lower;
+        return sortedValues[lower] + fraction * (sortedValues[upper] - sortedValues[lower]);
+    }
+
+    double BenchmarkResult::GetGigaflopsPerSecond() const
+    {
+        return flops > 0 && medianSeconds > 0 ? flops / medianSeconds * 1e-9 : 0;
+    }
+
+    BenchmarkSuite::BenchmarkSuite(std::string name, BenchmarkOptions options) :
+        _name(std::move(name)),
+        _options(std::move(options))
+    {
+    }
+
+    void BenchmarkSuite::Run(const std::string& name, double flops, const std::function<void()>& function)
+    {
+        if (!_options.filter.empty() && name.find(_options.filter) == std::string::npos)
+        {
+            return;
+        }
+
+        using Clock = std::chrono::steady_clock;
+        auto time = [&function](size_t numCalls) {
+            auto start = Clock::now();
+            for (size_t call = 0; call < numCalls; ++call)
+            {
+                function();
+            }
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        };
+
+        // warm up, and find how many calls a sample needs
+        auto firstCallSeconds = time(1);
+        size_t callsPerSample = 1;
+        if (firstCallSeconds < _options.minSampleSeconds)
+        {
+            callsPerSample = static_cast<size_t>(std::ceil(_options.minSampleSeconds / std::max(firstCallSeconds, 1e-9)));
+        }
+
+        std::vector<double> samples;
+        for (size_t sample = 0; sample < std::max<size_t>(_options.numSamples, 1); ++sample)
+        {
+            samples.push_back(time(callsPerSample) / callsPerSample);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        BenchmarkResult result;
+        result.name = name;
+        result.numSamples = samples.size();
+        result.callsPerSample = callsPerSample;
+        result.flops = flops;
+        result.minSeconds = samples.front();
+        result.medianSeconds = GetPercentile(samples, 50);
+        result.p10Seconds = GetPercentile(samples, 10);
+        result.p90Seconds = GetPercentile(samples, 90);
+        _results.push_back(result);
+
+        if (_verbose)
+        {
+            std::cout << std::left << std::setw(72) << name << std::right << "  median " << std::setw(10) << std::setprecision(4) << result.medianSeconds * 1e6 << " us"
+                      << "  p10 " << std::setw(10) << result.p10Seconds * 1e6 << " us"
+                      << "  p90 " << std::setw(10) << result.p90Seconds * 1e6 << " us";
+            if (flops > 0)
+            {
+                std::cout << "  " << std::setw(8) << result.GetGigaflopsPerSecond() << " GFLOP/s";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    void BenchmarkSuite::WriteJson(std::ostream& stream) const
+    {
+        ArchivedBenchmarkSuite suite;
+        suite.suite = _name;
+        suite.benchmarks.assign(_results.begin(), _results.end());
+
+        utilities::JsonArchiver archiver(stream);
+        archiver << suite;
+    }
+
+    std::vector<BenchmarkResult> ReadBenchmarkResults(std::istream& stream)
+    {
+        utilities::SerializationContext context;
+        utilities::JsonUnarchiver unarchiver(stream, context);
+        ArchivedBenchmarkSuite suite;
+        unarchiver >> suite;
+
+        std::vector<BenchmarkResult> results;
+        for (const auto& benchmark : suite.benchmarks)
+        {
+            results.push_back(benchmark.result);
+        }
+        return results;
+    }
+
+    std::vector<BenchmarkComparison> CompareBenchmarkResults(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& current, double tolerance)
+    {
+        std::map<std::string, const BenchmarkResult*> baselineByName;
+        for (const auto& result : baseline)
+        {
+            baselineByName[result.name] = &result;
+        }
+
+        std::vector<BenchmarkComparison> comparisons;
+        for (const auto& result : current)
+        {
+            auto it = baselineByName.find(result.name);
+            if (it == baselineByName.end() || it->second->medianSeconds <= 0)
+            {
+                continue;
+            }
+
+            const auto& baselineResult = *it->second;
+            BenchmarkComparison comparison;
+            comparison.name = result.name;
+            comparison.baselineSeconds = baselineResult.medianSeconds;
+            comparison.currentSeconds = result.medianSeconds;
+            auto threshold = std::max(baselineResult.medianSeconds * (1 + tolerance), baselineResult.p90Seconds);
+            comparison.isRegression = result.medianSeconds > threshold;
+            comparisons.push_back(comparison);
+        }
+        return comparisons;
+    }
+
+    int RunBenchmarkProgram(int argc, char** argv, const std::string& suiteName, const std::function<void(BenchmarkSuite&)>& addBenchmarks)
+    {
+        BenchmarkOptions options;
+        std::string outputFile;
+        std::vector<std::string> compareFiles;
+        double tolerance = 0.1;
+
+        auto usage = [argv]() {
+            std::cerr << "Usage: " << argv[0] << " [--output file.json] [--filter text] [--samples n]\n"
+                      << "       " << argv[0] << " --compare baseline.json current.json [--tolerance 0.1]" << std::endl;
+            return 2;
+        };
+
+        for (int index = 1; index < argc; ++index)
+        {
+            std::string argument = argv[index];
+            auto hasValues = [&](int count) { return index + count < argc; };
+            if (argument == "--output" && hasValues(1))
+            {
+                outputFile = argv[++index];
+            }
+            else if (argument == "--filter" && hasValues(1))
+            {
+                options.filter = argv[++index];
+            }
+            else if (argument == "--samples" && hasValues(1))
+            {
+                options.numSamples = std::stoul(argv[++index]);
+            }
+            else if (argument == "--compare" && hasValues(2))
+            {
+                compareFiles = { argv[index + 1], argv[index + 2] };
+                index += 2;
+            }
+            else if (argument == "--tolerance" && hasValues(1))
+            {
+                tolerance = std::stod(argv[++index]);
+            }
+            else
+            {
+                return usage();
+            }
+        }
+
+        if (!compareFiles.empty())
+        {
+            std::vector<std::vector<BenchmarkResult>> results;
+            for (const auto& filename : compareFiles)
+            {
+                std::ifstream stream(filename);
+                if (!stream)
+                {
+                    std::cerr << "Can't open " << filename << std::endl;
+                    return 2;
+                }
+                results.push_back(ReadBenchmarkResults(stream));
+            }
+
+            auto numRegressions = 0;
+            for (const auto& comparison : CompareBenchmarkResults(results[0], results[1], tolerance))
+            {
+                numRegressions += comparison.isRegression ? 1 : 0;
+                std::cout << (comparison.isRegression ? "REGRESSION  " : "            ") << std::left << std::setw(72) << comparison.name << std::right
+                          << std::setprecision(3) << std::setw(8) << comparison.GetRatio() << "x" << std::endl;
+            }
+            std::cout << numRegressions << " regression(s)" << std::endl;
+            return numRegressions > 0 ? 1 : 0;
+        }
+
+        BenchmarkSuite suite(suiteName, options);
+        addBenchmarks(suite);
+        if (!outputFile.empty())
+        {
+            std::ofstream stream(outputFile);
+            suite.WriteJson(stream);
+        }
+        return 0;
+    }
+} // namespace testing
+} // namespace ell
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     AllReduce.h (trainers)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace trainers
+{
+    /// <summary> The ways an allreduce can combine the values of the processes. </summary>
+    enum class AllReduceOperation
+    {
+        sum,
+        max
+    };
+
+    /// <summary>
+    /// Interface to one process of a group that trains together: an allreduce combines a vector of values from every
+    /// process of the group, entry by entry, and gives each of them the result. Every process must make the same
+    /// sequence of calls, with vectors of the same size.
+    /// </summary>
+    class IAllReduce
+    {
+    public:
+        virtual ~IAllReduce() = default;
+
+        /// <summary> Gets the number of processes in the group. </summary>
+        virtual size_t GetNumProcesses() const = 0;
+
+        /// <summary> Gets the index of this process in the group, between 0 and `GetNumProcesses() - 1`. </summary>
+        virtual size_t GetRank() const = 0;
+
+        /// <summary> Combines the values of all the processes, and replaces this process's values with the result. </summary>
+        ///
+        /// <param name="values"> [in,out] The values of this process, and then the result. </param>
+        /// <param name="operation"> How to combine the values. </param>
+        virtual void AllReduce(std::vector<double>& values, AllReduceOperation operation) = 0;
+    };
+
+    /// <summary>
+    /// A group of processes that are threads of the same program, for testing distributed training, and for
+    /// training on several shards of a dataset in one process. Results are combined in the order of the ranks,
+    /// so they don't depend on the order the threads get there.
+    /// </summary>
+    class LocalAllReduceGroup
+    {
+    public:
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="numProcesses"> The number of processes (threads) in the group. </param>
+        explicit LocalAllReduceGroup(size_t numProcesses);
+
+        ~LocalAllReduceGroup();
+
+        LocalAllReduceGroup(const LocalAllReduceGroup&) = delete;
+        LocalAllReduceGroup& operator=(const LocalAllReduceGroup&) = delete;
+
+        /// <summary> Gets the process with the given rank, for the thread that plays its part. </summary>
+        IAllReduce& GetProcess(size_t rank);
+
+    private:
+        class Process;
+        friend class Process;
+
+        void AllReduce(size_t rank, std::vector<double>& values, AllReduceOperation operation);
+
+        std::vector<std::unique_ptr<Process>> _processes;
+        std::mutex _mutex;
+        std::condition_variable _roundFinished;
+        std::vector<std::vector<double>> _contributions;
+        std::vector<double> _result;
+        size_t _numArrived = 0;
+        size_t _round = 0;
+    };
+
+    /// <summary>
+    /// One process of a group that communicates over TCP. The process with rank 0 listens on the given address and port,
+    /// the others connect to it, and it combines the values of each allreduce and sends the result back. Each connection
+    /// starts with a handshake carrying the job token; the process with rank 0 drops peers that don't send a valid
+    /// handshake for this job, and keeps waiting for the others. All the processes must have the same byte order. Only
+    /// available on POSIX systems.
+    /// </summary>
+    class TCPAllReduce : public IAllReduce
+    {
+    public:
+        /// <summary> Constructor. Waits until all the processes of the group are connected. </summary>
+        ///
+        /// <param name="rank"> The index of this process in the group. </param>
+        /// <param name="numProcesses"> The number of processes in the group. </param>
+        /// <param name="rootAddress"> The host name or address of the process with rank 0. That process listens on the
+        /// interface with this address ("0.0.0.0" for all of them). </param>
+        /// <param name="port"> The port the process with rank 0 listens on. </param>
+        /// <param name="jobToken"> A string that all the processes of the group share, and no others. </param>
+        /// <param name="timeoutSeconds"> How long to wait for the other processes, when connecting. </param>
+        /// <param name="receiveTimeoutSeconds"> How long an allreduce waits for another process's values before it
+        /// counts the connection as lost (0 means forever). </param>
+        TCPAllReduce(size_t rank, size_t numProcesses, const std::string& rootAddress, int port, const std::string& jobToken = "", double timeoutSeconds = 60, double receiveTimeoutSeconds = 600);
+
+        ~TCPAllReduce() override;
+
+        TCPAllReduce(const TCPAllReduce&) = delete;
+        TCPAllReduce& operator=(const TCPAllReduce&) = delete;
+
+        size_t GetNumProcesses() const override { return _numProcesses; }
+        size_t GetRank() const override { return _rank; }
+        void AllReduce(std::vector<double>& values, AllReduceOperation operation) override;
+
+    private:
+        size_t _rank;
+        size_t _numProcesses;
+        std::vector<int> _sockets; // the root's connection to each other process, by rank, or a worker's connection to the root
+    };
+
+    /// <summary> Combines a vector of values into another, entry by entry. </summary>
+    void CombineValues(std::vector<double>& values, const std::vector<double>& otherValues, AllReduceOperation operation);
+} // namespace trainers
+} // namespace ell
@@ -0,0 +1,378 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BinnedForestTrainer.h (trainers)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ForestTrainer.h"
+#include "LogitBooster.h"
+
+#include <predictors/include/ConstantPredictor.h>
+#include <predictors/include/SingleElementThresholdPredictor.h>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace ell
+{
+namespace trainers
+{
+    /// <summary> Parameters for the binned forest trainer. </summary>
+    struct BinnedForestTrainerParameters : public virtual ForestTrainerParameters
+    {
+        size_t maxBinsPerFeature = 256;
+    };
+
+    /// <summary> A trainer for binary decision forests with threshold split rules and constant outputs
+    /// that quantizes each feature into at most 256 bins before training. The split search at each node
+    /// uses a histogram of the node's weak weights and labels over the bins of each feature, and the
+    /// histogram of the larger child of a split is computed by subtracting the histogram of the smaller
+    /// child from that of its parent. </summary>
+    ///
+    /// <typeparam name="LossFunctionType"> Loss function type. </typeparam>
+    /// <typeparam name="BoosterType"> Booster type. </typeparam>
+    template <typename LossFunctionType, typename BoosterType>
+    class BinnedForestTrainer : public ForestTrainer<predictors::SingleElementThresholdPredictor, predictors::ConstantPredictor, BoosterType>
+    {
+    public:
+        /// <summary> Constructs an instance of BinnedForestTrainer. </summary>
+        ///
+        /// <param name="lossFunction"> The loss function. </param>
+        /// <param name="booster"> The booster. </param>
+        /// <param name="parameters"> Training Parameters. </param>
+        BinnedForestTrainer(const LossFunctionType& lossFunction, const BoosterType& booster, const BinnedForestTrainerParameters& parameters);
+
+        using SplitRuleType = predictors::SingleElementThresholdPredictor;
+        using EdgePredictorType = predictors::ConstantPredictor;
+        using typename ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::SplitCandidate;
+        using typename ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::SplittableNodeId;
+        using typename ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::NodeStats;
+        using typename ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::Range;
+        using typename ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::Sums;
+
+        /// <summary> Sets the trainer's dataset. </summary>
+        ///
+        /// <param name="anyDataset"> A dataset. </param>
+        void SetDataset(const data::AnyDataset& anyDataset) override;
+
+    protected:
+        using ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::_dataset;
+        using ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::_parameters;
+        using ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::GetNumThreads;
+        SplitCandidate GetBestSplitRuleAtNode(SplittableNodeId nodeId, Range range, Sums sums) override;
+        std::vector<EdgePredictorType> GetEdgePredictors(const NodeStats& nodeStats) override;
+        void PrepareRound() override;
+        void OnNodeSplit(const SplitCandidate& splitCandidate) override;
+
+    private:
+        // the weak weights and labels, and the number, of the examples that fall in a bin
+        struct Bin
+        {
+            Sums sums;
+            size_t count = 0;
+        };
+
+        // the bins of all features, feature by feature, for the examples of one node
+        using Histogram = std::vector<Bin>;
+
+        Histogram GetNodeHistogram(Range range);
+        Histogram BuildHistogram(Range range) const;
+        void SubtractHistogram(Histogram& histogram, const Histogram& other) const;
+        std::vector<double> GetBinThresholds(std::vector<float> values) const;
+        double CalculateGain(const Sums& sums, const Sums& sums0, const Sums& sums1) const;
+
+        // member variables
+        LossFunctionType _lossFunction;
+        size_t _maxBinsPerFeature;
+
+        // for each feature, the thresholds between consecutive bins; values up to _binThresholds[f][b] fall in bin b or lower
+        std::vector<std::vector<double>> _binThresholds;
+
+        // the bin of each feature of each example, example by example, by TrainerMetadata::index
+        std::vector<uint8_t> _bins;
+
+        // the histograms of the nodes that may still be split, by the first index of their ranges
+        std::map<size_t, Histogram> _histograms;
+
+        // the most recently split node, whose histogram is used to derive the histograms of its children
+        std::vector<Range> _splitNodeChildRanges;
+        Histogram _splitNodeHistogram;
+    };
+
+    /// <summary> Makes a binned forest trainer. </summary>
+    ///
+    /// <typeparam name="LossFunctionType"> Type of loss function to use. </typeparam>
+    /// <param name="lossFunction"> The loss function. </param>
+    /// <param name="booster"> The booster. </param>
+    /// <param name="parameters"> The trainer parameters. </param>
+    ///
+    /// <returns> A unique_ptr to a binned forest trainer. </returns>
+    template <typename LossFunctionType, typename BoosterType>
+    std::unique_ptr<ITrainer<predictors::SimpleForestPredictor>> MakeBinnedForestTrainer(const LossFunctionType& lossFunction, const BoosterType& booster, const BinnedForestTrainerParameters& parameters);
+} // namespace trainers
+} // namespace ell
+
+#pragma region implementation
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/ParallelFor.h>
+
+#include <algorithm>
+
+namespace ell
+{
+namespace trainers
+{
+    template <typename LossFunctionType, typename BoosterType>
+    BinnedForestTrainer<LossFunctionType, BoosterType>::BinnedForestTrainer(const LossFunctionType& lossFunction, const BoosterType& booster, const BinnedForestTrainerParameters& parameters) :
+        ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>(booster, parameters),
+        _lossFunction(lossFunction),
+        _maxBinsPerFeature(parameters.maxBinsPerFeature)
+    {
+        if (_maxBinsPerFeature < 2 || _maxBinsPerFeature > 256)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "maxBinsPerFeature must be between 2 and 256");
+        }
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    void BinnedForestTrainer<LossFunctionType, BoosterType>::SetDataset(const data::AnyDataset& anyDataset)
+    {
+        ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::SetDataset(anyDataset);
+
+        auto numExamples = _dataset.NumExamples();
+        auto numFeatures = _dataset.NumFeatures();
+        _binThresholds.resize(numFeatures);
+        _bins.resize(numExamples * numFeatures);
+
+        // rows haven't been reordered yet, so each row's position is its TrainerMetadata::index
+        utilities::ParallelFor(numFeatures, GetNumThreads(numFeatures, numExamples), [this, numExamples, numFeatures](size_t featureIndex) {
+            std::vector<float> values(numExamples);
+            for (size_t rowIndex = 0; rowIndex < numExamples; ++rowIndex)
+            {
+                values[rowIndex] = static_cast<float>(_dataset[rowIndex].GetDataVector()[featureIndex]);
+            }
+
+            const auto& thresholds = _binThresholds[featureIndex] = GetBinThresholds(values);
+            for (size_t rowIndex = 0; rowIndex < numExamples; ++rowIndex)
+            {
+                auto bin = std::lower_bound(thresholds.begin(), thresholds.end(), static_cast<double>(values[rowIndex])) - thresholds.begin();
+                _bins[rowIndex * numFeatures + featureIndex] = static_cast<uint8_t>(bin);
+            }
+        });
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    std::vector<double> BinnedForestTrainer<LossFunctionType, BoosterType>::GetBinThresholds(std::vector<float> values) const
+    {
+        std::sort(values.begin(), values.end());
+
+        // close a bin at the end of a run of equal values, once it holds its share of the examples that the previous bins didn't take
+        std::vector<double> thresholds;
+        size_t binBegin = 0;
+        for (size_t index = 0; index + 1 < values.size() && thresholds.size() + 1 < _maxBinsPerFeature; ++index)
+        {
+            if (values[index] == values[index + 1])
+            {
+                continue;
+            }
+
+            auto numBinsLeft = _maxBinsPerFeature - thresholds.size();
+            if ((index + 1 - binBegin) * numBinsLeft >= values.size() - binBegin)
+            {
+                thresholds.push_back(0.5 * (static_cast<double>(values[index]) + values[index + 1]));
+                binBegin = index + 1;
+            }
+        }
+        return thresholds;
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    void BinnedForestTrainer<LossFunctionType, BoosterType>::PrepareRound()
+    {
+        // the new round starts from a single root node
+        _histograms.clear();
+        _splitNodeChildRanges.clear();
+        _splitNodeHistogram.clear();
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    auto BinnedForestTrainer<LossFunctionType, BoosterType>::GetBestSplitRuleAtNode(SplittableNodeId nodeId, Range range, Sums sums) -> SplitCandidate
+    {
+        SplitCandidate bestSplitCandidate(nodeId, range, sums);
+        auto histogram = GetNodeHistogram(range);
+
+        auto numFeatures = _binThresholds.size();
+        size_t binOffset = 0;
+        for (size_t featureIndex = 0; featureIndex < numFeatures; ++featureIndex)
+        {
+            const auto& thresholds = _binThresholds[featureIndex];
+            Sums sums0;
+            size_t size0 = 0;
+
+            // consider the threshold after each bin but the last
+            for (size_t binIndex = 0; binIndex < thresholds.size(); ++binIndex)
+            {
+                const auto& bin = histogram[binOffset + binIndex];
+                sums0.sumWeights += bin.sums.sumWeights;
+                sums0.sumWeightedLabels += bin.sums.sumWeightedLabels;
+                size0 += bin.count;
+
+                // only split between bins that both hold examples of this node
+                if (bin.count == 0 || size0 == range.size)
+                {
+                    continue;
+                }
+
+                auto sums1 = sums - sums0;
+                double gain = CalculateGain(sums, sums0, sums1);
+
+                // find gain maximizer
+                if (gain > bestSplitCandidate.gain)
+                {
+                    bestSplitCandidate.gain = gain;
+                    bestSplitCandidate.splitRule = SplitRuleType{ featureIndex, thresholds[binIndex] };
+                    bestSplitCandidate.ranges = ForestTrainerBase::NodeRanges(range);
+                    bestSplitCandidate.ranges.SplitChildRange(0, size0);
+                    bestSplitCandidate.stats.SetChildSums({ sums0, sums1 });
+                }
+            }
+            binOffset += thresholds.size() + 1;
+        }
+
+        // keep the histogram of a node that may be queued, for when it is split
+        if (bestSplitCandidate.gain >= _parameters.minSplitGain)
+        {
+            _histograms[range.firstIndex] = std::move(histogram);
+        }
+        return bestSplitCandidate;
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    void BinnedForestTrainer<LossFunctionType, BoosterType>::OnNodeSplit(const SplitCandidate& splitCandidate)
+    {
+        const auto& ranges = splitCandidate.ranges;
+        auto histogramIterator = _histograms.find(ranges.GetTotalRange().firstIndex);
+        if (histogramIterator != _histograms.end())
+        {
+            _splitNodeHistogram = std::move(histogramIterator->second);
+            _histograms.erase(histogramIterator);
+        }
+        else
+        {
+            _splitNodeHistogram = BuildHistogram(ranges.GetTotalRange());
+        }
+        _splitNodeChildRanges = { ranges.GetChildRange(0), ranges.GetChildRange(1) };
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    auto BinnedForestTrainer<LossFunctionType, BoosterType>::GetNodeHistogram(Range range) -> Histogram
+    {
+        auto isRange = [&range](const Range& other) { return other.firstIndex == range.firstIndex && other.size == range.size; };
+
+        // a child of the node that was just split: scan the smaller child, and subtract it from the parent to get the larger one
+        if (_splitNodeChildRanges.size() == 2 && (isRange(_splitNodeChildRanges[0]) || isRange(_splitNodeChildRanges[1])))
+        {
+            auto isFirstSmaller = _splitNodeChildRanges[0].size <= _splitNodeChildRanges[1].size;
+            auto smallerRange = _splitNodeChildRanges[isFirstSmaller ? 0 : 1];
+            auto largerRange = _splitNodeChildRanges[isFirstSmaller ? 1 : 0];
+            auto histogram = BuildHistogram(smallerRange);
+            SubtractHistogram(_splitNodeHistogram, histogram);
+
+            // keep the histogram of the other child for the next call
+            _splitNodeChildRanges = { largerRange };
+            if (!isRange(smallerRange))
+            {
+                _splitNodeChildRanges = { smallerRange };
+                std::swap(histogram, _splitNodeHistogram);
+            }
+            return histogram;
+        }
+
+        // the other child, whose histogram was derived with that of its sibling
+        if (_splitNodeChildRanges.size() == 1 && isRange(_splitNodeChildRanges[0]))
+        {
+            _splitNodeChildRanges.clear();
+            return std::move(_splitNodeHistogram);
+        }
+        return BuildHistogram(range);
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    auto BinnedForestTrainer<LossFunctionType, BoosterType>::BuildHistogram(Range range) const -> Histogram
+    {
+        auto numFeatures = _binThresholds.size();
+        std::vector<size_t> binOffsets(numFeatures + 1);
+        for (size_t featureIndex = 0; featureIndex < numFeatures; ++featureIndex)
+        {
+            binOffsets[featureIndex + 1] = binOffsets[featureIndex] + _binThresholds[featureIndex].size() + 1;
+        }
+        Histogram histogram(binOffsets.back());
+
+        // each thread takes a contiguous block of features, and scans the examples' bins in the order they are stored
+        auto numBlocks = GetNumThreads(numFeatures, range.size);
+        utilities::ParallelFor(numBlocks, numBlocks, [&](size_t blockIndex) {
+            auto firstFeature = numFeatures * blockIndex / numBlocks;
+            auto endFeature = numFeatures * (blockIndex + 1) / numBlocks;
+            for (size_t rowIndex = range.firstIndex; rowIndex < range.firstIndex + range.size; ++rowIndex)
+            {
+                const auto& metadata = _dataset[rowIndex].GetMetadata();
+                const auto& weak = metadata.weak;
+                const uint8_t* bins = _bins.data() + metadata.index * numFeatures;
+                for (auto featureIndex = firstFeature; featureIndex < endFeature; ++featureIndex)
+                {
+                    auto& bin = histogram[binOffsets[featureIndex] + bins[featureIndex]];
+                    bin.sums.Increment(weak);
+                    ++bin.count;
+                }
+            }
+        });
+        return histogram;
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    void BinnedForestTrainer<LossFunctionType, BoosterType>::SubtractHistogram(Histogram& histogram, const Histogram& other) const
+    {
+        for (size_t index = 0; index < histogram.size(); ++index)
+        {
+            histogram[index].sums = histogram[index].sums - other[index].sums;
+            histogram[index].count -= other[index].count;
+        }
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    auto BinnedForestTrainer<LossFunctionType, BoosterType>::GetEdgePredictors(const NodeStats& nodeStats) -> std::vector<EdgePredictorType>
+    {
+        double output = nodeStats.GetTotalSums().GetMeanLabel();
+        double output0 = nodeStats.GetChildSums(0).GetMeanLabel() - output;
+        double output1 = nodeStats.GetChildSums(1).GetMeanLabel() - output;
+        return std::vector<EdgePredictorType>{ output0, output1 };
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    double BinnedForestTrainer<LossFunctionType, BoosterType>::CalculateGain(const Sums& sums, const Sums& sums0, const Sums& sums1) const
+    {
+        if (sums0.sumWeights == 0 || sums1.sumWeights == 0)
+        {
+            return 0;
+        }
+
+        return sums0.sumWeights * _lossFunction.BregmanGenerator(sums0.sumWeightedLabels / sums0.sumWeights) +
+               sums1.sumWeights * _lossFunction.BregmanGenerator(sums1.sumWeightedLabels / sums1.sumWeights) -
+               sums.sumWeights * _lossFunction.BregmanGenerator(sums.sumWeightedLabels / sums.sumWeights);
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    std::unique_ptr<ITrainer<predictors::SimpleForestPredictor>> MakeBinnedForestTrainer(const LossFunctionType& lossFunction, const BoosterType& booster, const BinnedForestTrainerParameters& parameters)
+    {
+        return std::make_unique<BinnedForestTrainer<LossFunctionType, BoosterType>>(lossFunction, booster, parameters);
+    }
+} // namespace trainers
+} // namespace ell
+
+#pragma endregion implementation
@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DistributedTrainer.h (trainers)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AllReduce.h"
+#include "IDistributableTrainer.h"
+#include "ITrainer.h"
+
+#include <memory>
+
+namespace ell
+{
+namespace trainers
+{
+    /// <summary> Parameters for the distributed trainer. </summary>
+    struct DistributedTrainerParameters
+    {
+        size_t synchronizationInterval = 1; // the number of epochs between averages
+    };
+
+    /// <summary>
+    /// Data-parallel training: one process per shard of the dataset, each with a copy of the same trainer, which
+    /// average the shared state of their trainers through an allreduce every few epochs (see `IDistributableTrainer`).
+    /// Each process calls `SetDataset` with its own shard, and `Update` the same number of times.
+    /// </summary>
+    ///
+    /// <typeparam name="PredictorType"> The predictor type. </typeparam>
+    template <typename PredictorType>
+    class DistributedTrainer : public ITrainer<PredictorType>
+    {
+    public:
+        /// <summary> Constructor. </summary>
+        ///
+        /// <param name="localTrainer"> The trainer of this process, which must implement `IDistributableTrainer`. </param>
+        /// <param name="allReduce"> This process's part of the group, which must outlive the trainer. </param>
+        /// <param name="parameters"> The trainer parameters. </param>
+        DistributedTrainer(std::unique_ptr<ITrainer<PredictorType>> localTrainer, IAllReduce& allReduce, const DistributedTrainerParameters& parameters);
+
+        /// <summary> Sets the shard of the dataset this process trains on. </summary>
+        ///
+        /// <param name="anyDataset"> A dataset. </param>
+        void SetDataset(const data::AnyDataset& anyDataset) override;
+
+        /// <summary> Performs a learning epoch on this process's shard, and averages the state every `synchronizationInterval` epochs. </summary>
+        void Update() override;
+
+        /// <summary> Averages the state of the trainers now. It's a collective call, so every process must make it. </summary>
+        void Synchronize();
+
+        /// <summary> Indicates if the trainers have been averaged since the last update, so every process has the same predictor. </summary>
+        bool IsSynchronized() const { return _epochsSinceSynchronization == 0; }
+
+        /// <summary> Gets a const reference to this process's predictor. </summary>
+        ///
+        /// <returns> A const reference to the predictor. </returns>
+        const PredictorType& GetPredictor() const override { return _localTrainer->GetPredictor(); }
+
+    private:
+        std::unique_ptr<ITrainer<PredictorType>> _localTrainer;
+        IDistributableTrainer* _distributableTrainer;
+        IAllReduce& _allReduce;
+        DistributedTrainerParameters _parameters;
+        size_t _epochsSinceSynchronization = 0;
+    };
+
+    /// <summary> Makes a distributed trainer. </summary>
+    template <typename PredictorType>
+    std::unique_ptr<ITrainer<PredictorType>> MakeDistributedTrainer(std::unique_ptr<ITrainer<PredictorType>> localTrainer, IAllReduce& allReduce, const DistributedTrainerParameters& parameters);
+} // namespace trainers
+} // namespace ell
+
+#pragma region implementation
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+
+namespace ell
+{
+namespace trainers
+{
+    template <typename PredictorType>
+    DistributedTrainer<PredictorType>::DistributedTrainer(std::unique_ptr<ITrainer<PredictorType>> localTrainer, IAllReduce& allReduce, const DistributedTrainerParameters& parameters) :
+        _localTrainer(std::move(localTrainer)),
+        _distributableTrainer(dynamic_cast<IDistributableTrainer*>(_localTrainer.get())),
+        _allReduce(allReduce),
+        _parameters(parameters)
+    {
+        if (_distributableTrainer == nullptr)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "DistributedTrainer: the trainer doesn't support distributed training");
+        }
+        _parameters.synchronizationInterval = std::max<size_t>(_parameters.synchronizationInterval, 1);
+    }
+
+    template <typename PredictorType>
+    void DistributedTrainer<PredictorType>::SetDataset(const data::AnyDataset& anyDataset)
+    {
+        _localTrainer->SetDataset(anyDataset);
+    }
+
+    template <typename PredictorType>
+    void DistributedTrainer<PredictorType>::Update()
+    {
+        _localTrainer->Update();
+        if (++_epochsSinceSynchronization >= _parameters.synchronizationInterval)
+        {
+            Synchronize();
+        }
+    }
+
+    template <typename PredictorType>
+    void DistributedTrainer<PredictorType>::Synchronize()
+    {
+        // The shards may have different numbers of features, so agree on the largest one first
+        std::vector<double> dimension = { static_cast<double>(_localTrainer->GetPredictor().Size()) };
+        _allReduce.AllReduce(dimension, AllReduceOperation::max);
+        auto sharedDimension = static_cast<size_t>(dimension[0]);
+
+        auto state = _distributableTrainer->GetSharedState(sharedDimension);
+        _allReduce.AllReduce(state, AllReduceOperation::sum);
+        const double inverseNumProcesses = 1.0 / _allReduce.GetNumProcesses();
+        for (auto& x : state)
+        {
+            x *= inverseNumProcesses;
+        }
+        _distributableTrainer->SetSharedState(state, sharedDimension);
+        _epochsSinceSynchronization = 0;
+    }
+
+    template <typename PredictorType>
+    std::unique_ptr<ITrainer<PredictorType>> MakeDistributedTrainer(std::unique_ptr<ITrainer<PredictorType>> localTrainer, IAllReduce& allReduce, const DistributedTrainerParameters& parameters)
+    {
+        return std::make_unique<DistributedTrainer<PredictorType>>(std::move(localTrainer), allReduce, parameters);
+    }
+} // namespace trainers
+} // namespace ell
+
+#pragma endregion implementation
@@ -16,10 +16,12 @@
 #include <predictors/include/ForestPredictor.h>
 
 #include <utilities/include/OutputStreamImpostor.h>
+#include <utilities/include/ParallelFor.h>
 
 #include <iostream> // For std::cout in VERBOSE_MODE
 #include <memory>
 #include <queue>
+#include <vector>
 
 namespace ell
 {
@@ -32,6 +34,7 @@ namespace trainers
         double minSplitGain = 0.0;
         size_t maxSplitsPerRound = 0;
         size_t numRounds = 0;
+        size_t numThreads = 0; // zero to use one thread per core
     };
 
     /// <summary> Nontemplated base class for forest trainers, provides some reusable internal classes. </summary>
@@ -45,6 +48,7 @@ namespace trainers
             double sumWeightedLabels = 0;
 
             void Increment(const data::WeightLabel& weightLabel);
+            Sums operator+(const Sums& other) const;
             Sums operator-(const Sums& other) const;
             double GetMeanLabel() const;
             void Print(std::ostream& os) const;
@@ -84,6 +88,9 @@ namespace trainers
 
             // the output of the forest on this example
             double currentOutput = 0;
+
+            // the position of the example in the dataset given to SetDataset, which doesn't change when the examples are reordered
+            size_t index = 0;
         };
 
         // keeps statistics about tree nodes
@@ -180,6 +187,13 @@ namespace trainers
         // after performing a split, we rearrange the data set to ensure that each node's examples occupy contiguous rows in the dataset
         void SortNodeDataset(Range range, const SplitRuleType& splitRule);
 
+        // the number of threads to use for a loop over count indices, each of which does about workPerIndex units of work; small loops run on one thread
+        size_t GetNumThreads(size_t count, size_t workPerIndex) const;
+
+        // calls function(rowIndex) for each example in a range, on several threads if the range is large
+        template <typename FunctionType>
+        void ParallelForExamples(Range range, FunctionType function) const;
+
         //
         // implementation specific functions that must be implemented by a derived class
         //
@@ -187,6 +201,12 @@ namespace trainers
         virtual SplitCandidate GetBestSplitRuleAtNode(SplittableNodeId nodeId, Range range, Sums sums) = 0;
         virtual std::vector<EdgePredictorType> GetEdgePredictors(const NodeStats& nodeStats) = 0;
 
+        // called at the start of each boosting round, after the weak weights and labels are set
+        virtual void PrepareRound() {}
+
+        // called after a split is performed, once the node's examples occupy the contiguous ranges of its children
+        virtual void OnNodeSplit(const SplitCandidate& /*splitCandidate*/) {}
+
         //
         // member variables
         //
@@ -203,6 +223,9 @@ namespace trainers
 
         // the data set
         data::Dataset<TrainerExampleType> _dataset;
+
+        // the number of threads used to search for splits
+        size_t _numThreads;
     };
 } // namespace trainers
 } // namespace ell
@@ -212,6 +235,8 @@ namespace trainers
 //#define VERBOSE_MODE( x ) x   // uncomment this for very verbose mode
 #define VERBOSE_MODE(x) // uncomment this for nonverbose mode
 
+#include <algorithm>
+
 namespace ell
 {
 namespace trainers
@@ -220,7 +245,8 @@ namespace trainers
     ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::ForestTrainer(const BoosterType& booster, const ForestTrainerParameters& parameters) :
         _booster(booster),
         _parameters(parameters),
-        _forest()
+        _forest(),
+        _numThreads(utilities::GetNumThreads(parameters.numThreads))
     {
     }
 
@@ -231,14 +257,14 @@ namespace trainers
         _dataset = data::Dataset<TrainerExampleType>(anyDataset);
 
         // initalizes the special fields in the dataset metadata: weak weight and label, currentOutput
-        for (size_t rowIndex = 0; rowIndex < _dataset.NumExamples(); ++rowIndex)
-        {
+        ParallelForExamples(Range{ 0, _dataset.NumExamples() }, [this](size_t rowIndex) {
             auto& example = _dataset[rowIndex];
             auto prediction = _forest.Predict(example.GetDataVector());
             auto& metadata = example.GetMetadata();
             metadata.currentOutput = prediction;
             metadata.weak = _booster.GetWeakWeightLabel(metadata.strong, prediction);
-        }
+            metadata.index = rowIndex;
+        });
     }
 
     template <typename SplitRuleType, typename EdgePredictorType, typename BoosterType>
@@ -254,6 +280,7 @@ namespace trainers
             double bias = sums.GetMeanLabel();
             _forest.AddToBias(bias);
             UpdateCurrentOutputs(bias);
+            PrepareRound();
 
             VERBOSE_MODE(_dataset.Print(std::cout));
             VERBOSE_MODE(std::cout << "\nBoosting iteration\n");
@@ -292,13 +319,25 @@ namespace trainers
     template <typename SplitRuleType, typename EdgePredictorType, typename BoosterType>
     auto ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::SetWeakWeightsLabels() -> Sums
     {
-        Sums sums;
+        // the sums of fixed-size blocks of examples are added in order, so they don't depend on the number of threads
+        const size_t blockSize = 1 << 12;
+        auto numExamples = _dataset.NumExamples();
+        auto numBlocks = (numExamples + blockSize - 1) / blockSize;
+        std::vector<Sums> blockSums(numBlocks);
+        utilities::ParallelFor(numBlocks, GetNumThreads(numBlocks, blockSize), [&](size_t blockIndex) {
+            auto end = std::min(numExamples, (blockIndex + 1) * blockSize);
+            for (auto rowIndex = blockIndex * blockSize; rowIndex < end; ++rowIndex)
+            {
+                auto& metadata = _dataset[rowIndex].GetMetadata();
+                metadata.weak = _booster.GetWeakWeightLabel(metadata.strong, metadata.currentOutput);
+                blockSums[blockIndex].Increment(metadata.weak);
+            }
+        });
 
-        for (size_t rowIndex = 0; rowIndex < _dataset.NumExamples(); ++rowIndex)
+        Sums sums;
+        for (const auto& blockSum : blockSums)
         {
-            auto& metadata = _dataset[rowIndex].GetMetadata();
-            metadata.weak = _booster.GetWeakWeightLabel(metadata.strong, metadata.currentOutput);
-            sums.Increment(metadata.weak);
+            sums = sums + blockSum;
         }
 
         if (sums.sumWeights == 0.0)
@@ -312,21 +351,18 @@ namespace trainers
     template <typename SplitRuleType, typename EdgePredictorType, typename BoosterType>
     void ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::UpdateCurrentOutputs(double value)
     {
-        for (size_t rowIndex = 0; rowIndex < _dataset.NumExamples(); ++rowIndex)
-        {
-            auto& example = _dataset[rowIndex];
-            example.GetMetadata().currentOutput += value;
-        }
+        ParallelForExamples(Range{ 0, _dataset.NumExamples() }, [this, value](size_t rowIndex) {
+            _dataset[rowIndex].GetMetadata().currentOutput += value;
+        });
     }
 
     template <typename SplitRuleType, typename EdgePredictorType, typename BoosterType>
     void ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::UpdateCurrentOutputs(Range range, const EdgePredictorType& edgePredictor)
     {
-        for (size_t rowIndex = range.firstIndex; rowIndex < range.firstIndex + range.size; ++rowIndex)
-        {
+        ParallelForExamples(range, [this, &edgePredictor](size_t rowIndex) {
             auto& example = _dataset[rowIndex];
             example.GetMetadata().currentOutput += edgePredictor.Predict(example.GetDataVector());
-        }
+        });
     }
 
     template <typename SplitRuleType, typename EdgePredictorType, typename BoosterType>
@@ -349,6 +385,7 @@ namespace trainers
 
             // sort the data according to the performed split and update the metadata to reflect this change
             SortNodeDataset(ranges.GetTotalRange(), splitCandidate.splitRule);
+            OnNodeSplit(splitCandidate);
 
             // update current output field in metadata
             auto edgePredictors = GetEdgePredictors(stats);
@@ -401,6 +438,21 @@ namespace trainers
         }
     }
 
+    template <typename SplitRuleType, typename EdgePredictorType, typename BoosterType>
+    size_t ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::GetNumThreads(size_t count, size_t workPerIndex) const
+    {
+        // below this much work, starting the threads costs more than it saves
+        const size_t minWorkPerThread = 1 << 16;
+        return std::max(std::min(_numThreads, count * workPerIndex / minWorkPerThread), size_t{ 1 });
+    }
+
+    template <typename SplitRuleType, typename EdgePredictorType, typename BoosterType>
+    template <typename FunctionType>
+    void ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::ParallelForExamples(Range range, FunctionType function) const
+    {
+        utilities::ParallelFor(range.size, GetNumThreads(range.size, 1), [&](size_t index) { function(range.firstIndex + index); });
+    }
+
     //
     // debugging code
     //
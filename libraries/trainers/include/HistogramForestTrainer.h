@@ -16,6 +16,7 @@
 
 #include <random>
 #include <tuple>
+#include <vector>
 
 namespace ell
 {
@@ -56,6 +57,7 @@ namespace trainers
 
     protected:
         using ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::_dataset;
+        using ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::GetNumThreads;
         SplitCandidate GetBestSplitRuleAtNode(SplittableNodeId nodeId, Range range, Sums sums) override;
         std::vector<EdgePredictorType> GetEdgePredictors(const NodeStats& nodeStats) override;
 
@@ -92,6 +94,7 @@ namespace trainers
 
 #pragma region implementation
 
+#include <utilities/include/ParallelFor.h>
 #include <utilities/include/RandomEngines.h>
 
 namespace ell
@@ -116,12 +119,20 @@ namespace trainers
 
         auto splitRuleCandidates = CallThresholdFinder(range);
 
-        for (const auto& splitRuleCandidate : splitRuleCandidates)
+        // evaluate the candidates in parallel, then take the first one with the highest gain
+        auto numCandidates = splitRuleCandidates.size();
+        std::vector<std::tuple<Sums, size_t>> evaluations(numCandidates);
+        utilities::ParallelFor(numCandidates, GetNumThreads(numCandidates, range.size), [&](size_t candidateIndex) {
+            evaluations[candidateIndex] = EvaluateSplitRule(splitRuleCandidates[candidateIndex], range);
+        });
+
+        for (size_t candidateIndex = 0; candidateIndex < numCandidates; ++candidateIndex)
         {
+            const auto& splitRuleCandidate = splitRuleCandidates[candidateIndex];
             Sums sums0;
             size_t size0;
 
-            std::tie(sums0, size0) = EvaluateSplitRule(splitRuleCandidate, range);
+            std::tie(sums0, size0) = evaluations[candidateIndex];
 
             Sums sums1 = sums - sums0;
             double gain = CalculateGain(sums, sums0, sums1);
@@ -131,6 +142,7 @@ namespace trainers
             {
                 bestSplitCandidate.gain = gain;
                 bestSplitCandidate.splitRule = splitRuleCandidate;
+                bestSplitCandidate.ranges = ForestTrainerBase::NodeRanges(range);
                 bestSplitCandidate.ranges.SplitChildRange(0, size0);
                 bestSplitCandidate.stats.SetChildSums({ sums0, sums1 });
             }
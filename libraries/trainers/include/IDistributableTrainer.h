@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     IDistributableTrainer.h (trainers)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <math/include/Vector.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace ell
+{
+namespace trainers
+{
+    /// <summary>
+    /// Interface to a trainer that can train on one shard of a dataset while copies of it train on the others (see
+    /// `DistributedTrainer`). Every so often, the copies average the part of their state that describes the solution,
+    /// and carry on from the average: the weights and step count of an SGD trainer, or the primal vector of an SDCA
+    /// trainer, whose dual variables stay with the examples of its shard.
+    /// </summary>
+    class IDistributableTrainer
+    {
+    public:
+        virtual ~IDistributableTrainer() = default;
+
+        /// <summary> Gets the shared state as a vector of numbers, to average with the other copies. </summary>
+        ///
+        /// <param name="dimension"> The dimension of the weights, which may be more than this copy has seen so far. </param>
+        virtual std::vector<double> GetSharedState(size_t dimension) const = 0;
+
+        /// <summary> Replaces the shared state with the average of all the copies. </summary>
+        ///
+        /// <param name="state"> The state, in the layout `GetSharedState` returns. </param>
+        /// <param name="dimension"> The dimension of the weights. </param>
+        virtual void SetSharedState(const std::vector<double>& state, size_t dimension) = 0;
+    };
+
+    /// <summary> Appends a vector to a shared state, padded with zeros to a given dimension. </summary>
+    inline void AppendToSharedState(std::vector<double>& state, const math::ConstColumnVectorReference<double>& vector, size_t dimension)
+    {
+        for (size_t index = 0; index < dimension; ++index)
+        {
+            state.push_back(index < vector.Size() ? vector[index] : 0.0);
+        }
+    }
+
+    /// <summary> Reads a vector of a given dimension from a shared state, and moves the offset past it. </summary>
+    inline void ReadFromSharedState(const std::vector<double>& state, size_t& offset, math::ColumnVector<double>& vector, size_t dimension)
+    {
+        vector.Resize(dimension);
+        for (size_t index = 0; index < dimension; ++index)
+        {
+            vector[index] = state.at(offset++);
+        }
+    }
+} // namespace trainers
+} // namespace ell
@@ -13,13 +13,35 @@
 #include <cstddef>
 #include <map>
 #include <memory>
+#include <random>
+#include <string>
+#include <vector>
 
 namespace ell
 {
 namespace trainers
 {
-    /// <summary> Impements KMeansTrainer++ algorithm </summary>
-    ///
+    /// <summary> Parameters for the k-means trainer. </summary>
+    struct KMeansTrainerParameters
+    {
+        /// <summary>
+        /// The number of points sampled for each mini-batch k-means iteration, or zero to assign all the points in each
+        /// iteration.
+        /// </summary>
+        size_t batchSize = 0;
+
+        /// <summary> The number of threads used to compute distances and means, or zero to use one per core. </summary>
+        size_t numThreads = 0;
+
+        /// <summary> The random seed string, used to pick the initial means and the mini-batches. </summary>
+        std::string randomSeedString = "KMeansTrainer";
+    };
+
+    /// <summary>
+    /// Implements the k-means algorithm, with k-means++ initialization. The distances between points and means are
+    /// computed for blocks of points at a time, from the squared norms and a product of matrices, and the blocks are
+    /// divided between threads.
+    /// </summary>
     class KMeansTrainer
     {
     public:
@@ -32,16 +54,18 @@ namespace trainers
         /// <param name="dimension"> The input dimension. </param>
         /// <param name="numClusters"> The number of clusters. </param>
         /// <param name="iterations"> The number of iterations. </param>
+        /// <param name="parameters"> The trainer parameters. </param>
         ///
-        KMeansTrainer(size_t dimension, size_t numClusters, size_t iterations);
+        KMeansTrainer(size_t dimension, size_t numClusters, size_t iterations, const KMeansTrainerParameters& parameters = {});
 
         /// <summary> Constructs an instance of KMeansTrainer trainer </summary>
         ///
         /// <param name="numClusters"> The number of clusters. </param>
         /// <param name="iterations"> The number of iterations. </param>
         /// <param name="means"> The cluster means. </param>
+        /// <param name="parameters"> The trainer parameters. </param>
         ///
-        KMeansTrainer(size_t numClusters, size_t iters, math::ColumnMatrix<double> means);
+        KMeansTrainer(size_t numClusters, size_t iters, math::ColumnMatrix<double> means, const KMeansTrainerParameters& parameters = {});
 
         /// <summary> Runs the KMeansTrainer algorithm. </summary>
         ///
@@ -60,20 +84,31 @@ namespace trainers
         const math::ColumnVector<double>& GetClusterAssignment() const { return _clusterAssignment; }
 
     private:
-        // Initializes the cluster means using the KMeansTrainer++ strategy.
-        void initializeMeans(math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> X);
+        using ConstColumnMatrixReference = math::ConstMatrixReference<double, math::MatrixLayout::columnMajor>;
 
-        // Distance of points to all the cluster means.
-        math::RowMatrix<double> pairwiseDistance(math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> X, math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> mu);
+        // Initializes the cluster means using the k-means++ strategy.
+        void initializeMeans(ConstColumnMatrixReference X, const std::vector<double>& pointNorms);
 
-        // Assign each point to the closest mean.
-        double assignClosestCenter(math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> X, math::VectorReference<size_t, math::VectorOrientation::column> clusterAssignment);
+        // Squared norm of each point.
+        std::vector<double> squaredNorms(ConstColumnMatrixReference X);
+
+        // Assign each point to the closest mean and return the sum of squared distances.
+        double assignClosestCenter(ConstColumnMatrixReference X, const std::vector<double>& pointNorms, std::vector<size_t>& clusterAssignment);
 
         // Recompute the cluster means.
-        void recomputeMeans(math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> X, const math::ColumnVector<size_t> clusterAssignment);
+        void recomputeMeans(ConstColumnMatrixReference X, const std::vector<size_t>& clusterAssignment);
+
+        // Run one mini-batch iteration, moving each mean towards the points assigned to it.
+        void updateMeansWithBatch(ConstColumnMatrixReference X, const std::vector<double>& pointNorms, std::vector<size_t>& numPointsPerCluster);
 
         // Weighted sampling.
-        size_t weightedSample(math::ColumnVector<double> weights);
+        size_t weightedSample(const std::vector<double>& weights);
+
+        // The number of threads to use.
+        size_t getNumThreads() const;
+
+        KMeansTrainerParameters _parameters;
+        std::default_random_engine _random;
 
         // Cluster means.
         math::ColumnMatrix<double> _means;
@@ -81,7 +116,7 @@ namespace trainers
         // Are the means initialized?
         bool _isInitialized = false;
 
-        // Cluster assignment for each data point.
+        // Cluster assignment for each data point, after the last iteration.
         math::ColumnVector<double> _clusterAssignment;
 
         // Number of iterations of KMeansTrainer algorithm.
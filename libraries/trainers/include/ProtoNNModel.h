@@ -68,6 +68,12 @@ namespace trainers
 
         ///<summary>Whether to output diagnostic information to std::cout.</summary>
         bool verbose;
+
+        ///<summary>The number of examples in each stochastic gradient step, zero to use 256 (or all the examples, if there are fewer)</summary>
+        size_t batchSize = 0;
+
+        ///<summary>The number of threads that share the projections and gradients, zero to use one per core</summary>
+        size_t numThreads = 0;
     };
 
 } // namespace trainers
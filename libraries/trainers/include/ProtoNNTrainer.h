@@ -21,8 +21,10 @@
 #include <data/include/Example.h>
 
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
+#include <vector>
 
 namespace ell
 {
@@ -39,6 +41,56 @@ namespace trainers
 
     class ProtoNNModelParameter;
 
+    /// <summary>
+    /// The training inputs of the ProtoNN trainer, one example per column. Only the nonzero entries are
+    /// stored, column by column, so that high-dimensional sparse inputs are never expanded.
+    /// </summary>
+    class ProtoNNInputMatrix
+    {
+    public:
+        /// <summary> Constructs an empty input matrix. </summary>
+        ///
+        /// <param name="numRows"> The input dimension. Entries of appended vectors beyond it are ignored. </param>
+        ProtoNNInputMatrix(size_t numRows = 0);
+
+        /// <summary> Appends a data vector as the last column. </summary>
+        ///
+        /// <param name="dataVector"> The data vector. </param>
+        void AppendColumn(const data::AutoDataVector& dataVector);
+
+        /// <summary> Returns the input dimension. </summary>
+        ///
+        /// <returns> The number of rows. </returns>
+        size_t NumRows() const { return _numRows; }
+
+        /// <summary> Returns the number of examples. </summary>
+        ///
+        /// <returns> The number of columns. </returns>
+        size_t NumColumns() const { return _columnOffsets.size() - 1; }
+
+        /// <summary> Computes the projection W * X for the columns begin to end. </summary>
+        ///
+        /// <param name="W"> The projection matrix, with NumRows() columns. </param>
+        /// <param name="begin"> The first column. </param>
+        /// <param name="end"> One past the last column. </param>
+        /// <param name="result"> The result, with end - begin columns. </param>
+        void Project(ConstColumnMatrixReference W, size_t begin, size_t end, math::ColumnMatrixReference<double> result) const;
+
+        /// <summary> Adds A * X' to a matrix, where X holds the columns begin to end. </summary>
+        ///
+        /// <param name="A"> A matrix with end - begin columns. </param>
+        /// <param name="begin"> The first column. </param>
+        /// <param name="end"> One past the last column. </param>
+        /// <param name="result"> The matrix to update, with NumRows() columns. </param>
+        void MultiplyTransposeAdd(ConstColumnMatrixReference A, size_t begin, size_t end, math::ColumnMatrixReference<double> result) const;
+
+    private:
+        size_t _numRows;
+        std::vector<size_t> _columnOffsets;
+        std::vector<size_t> _indices;
+        std::vector<double> _values;
+    };
+
     using ProtoNNModelMap = std::map<ProtoNNParameterIndex, std::shared_ptr<ProtoNNModelParameter>>;
 
     /// <summary>
@@ -69,26 +121,34 @@ namespace trainers
         // Initalize parameters in the first iteration
         void Initialize();
 
-        // The Similarity Kernel.
-        math::ColumnMatrix<double> SimilarityKernel(ConstColumnMatrixReference X, math::ColumnMatrixReference<double> WX, const double gamma, const size_t begin, const size_t end, bool recomputeWX = false);
+        // The Similarity Kernel. If recomputeWX is set, the columns begin to end of WX are first recomputed from W.
+        math::ColumnMatrix<double> SimilarityKernel(const ProtoNNInputMatrix& X, math::ColumnMatrixReference<double> WX, const double gamma, const size_t begin, const size_t end, bool recomputeWX = false) const;
 
         // The Similarity Kernel.
-        math::ColumnMatrix<double> SimilarityKernel(ConstColumnMatrixReference X, math::ColumnMatrixReference<double> WX, const double gamma, bool recomputeWX = false);
+        math::ColumnMatrix<double> SimilarityKernel(const ProtoNNInputMatrix& X, math::ColumnMatrixReference<double> WX, const double gamma, bool recomputeWX = false) const;
 
         // The Training Loss.
-        double Loss(ConstColumnMatrixReference Y, ConstColumnMatrixReference D, const size_t begin, const size_t end);
+        double Loss(ConstColumnMatrixReference Y, ConstColumnMatrixReference D, const size_t begin, const size_t end) const;
 
         // The Training Loss.
-        double Loss(ConstColumnMatrixReference Y, ConstColumnMatrixReference D);
+        double Loss(ConstColumnMatrixReference Y, ConstColumnMatrixReference D) const;
 
         // The Objective function value.
-        double ComputeObjective(ConstColumnMatrixReference X, ConstColumnMatrixReference Y, math::ColumnMatrixReference<double> WX, double gamma, bool recomputeWX = false);
+        double ComputeObjective(const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, math::ColumnMatrixReference<double> WX, double gamma, bool recomputeWX = false);
+
+        // The gradient w.r.t. a model parameter over the examples begin to end, summed over pieces of the batch computed in parallel.
+        math::ColumnMatrix<double> ComputeGradient(ProtoNNParameterIndex parameterIndex, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, math::ColumnMatrixReference<double> WX, double gamma, size_t begin, size_t end);
+
+        // Sets WX to the projection of all the examples.
+        void ProjectInputs(const ProtoNNInputMatrix& X, math::ColumnMatrixReference<double> WX);
 
         // Performs Accelerated Proximal Gradient w.r.t. input model parameter.
         void AcceleratedProximalGradient(ProtoNNParameterIndex parameterIndex, std::function<math::ColumnMatrix<double>(const ConstColumnMatrixReference, const size_t, const size_t)> gradf, std::function<void(math::MatrixReference<double, math::MatrixLayout::columnMajor>)> prox, math::MatrixReference<double, math::MatrixLayout::columnMajor> param, const size_t& epochs, const size_t& n, const size_t& batchSize, const double& eta, const int& eta_update);
 
         // Optimization using SGD with alternating minimization.
-        void SGDWithAlternatingMinimization(ConstColumnMatrixReference X, ConstColumnMatrixReference Y, double gamma, size_t nIters);
+        void SGDWithAlternatingMinimization(const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, double gamma, size_t nIters);
+
+        size_t GetNumThreads() const;
 
         // Order in which the parameters are optimized
         std::vector<ProtoNNParameterIndex> m_OptimizationOrder{ ProtoNNParameterIndex::W, ProtoNNParameterIndex::Z, ProtoNNParameterIndex::B };
@@ -115,7 +175,7 @@ namespace trainers
 
         size_t _iteration = 0;
 
-        math::ColumnMatrix<double> _X;
+        ProtoNNInputMatrix _X;
         math::ColumnMatrix<double> _Y;
     };
 
@@ -146,11 +206,12 @@ namespace trainers
         /// <returns> The underlying data matrix. </returns>
         const math::ColumnMatrix<double>& GetData() const { return _data; }
 
-        /// Specifies the interface for gradient computation.
-        virtual math::ColumnMatrix<double> gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) = 0;
+        /// Specifies the interface for gradient computation over the examples begin to end. WX holds the
+        /// projections of those examples with the current W, and D their similarity to the prototypes.
+        virtual math::ColumnMatrix<double> gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) const = 0;
 
         /// Specifies the interface for gradient computation.
-        virtual math::ColumnMatrix<double> gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) = 0;
+        virtual math::ColumnMatrix<double> gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) const = 0;
 
     private:
         // The underlying Parameter matrix
@@ -164,10 +225,10 @@ namespace trainers
         Param_W(size_t dimension1, size_t dimension2);
 
         /// <summary></summary>
-        math::ColumnMatrix<double> gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) override;
+        math::ColumnMatrix<double> gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) const override;
 
         /// <summary></summary>
-        math::ColumnMatrix<double> gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) override;
+        math::ColumnMatrix<double> gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) const override;
     };
 
     class Param_B : public ProtoNNModelParameter
@@ -177,10 +238,10 @@ namespace trainers
         Param_B(size_t dimension1, size_t dimension2);
 
         /// <summary></summary>
-        math::ColumnMatrix<double> gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) override;
+        math::ColumnMatrix<double> gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) const override;
 
         /// <summary></summary>
-        math::ColumnMatrix<double> gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) override;
+        math::ColumnMatrix<double> gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) const override;
     };
 
     class Param_Z : public ProtoNNModelParameter
@@ -190,10 +251,10 @@ namespace trainers
         Param_Z(size_t dimension1, size_t dimension2);
 
         /// <summary></summary>
-        math::ColumnMatrix<double> gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) override;
+        math::ColumnMatrix<double> gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) const override;
 
         /// <summary></summary>
-        math::ColumnMatrix<double> gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) override;
+        math::ColumnMatrix<double> gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) const override;
     };
 
     /// <summary> Makes a ProtoNN trainer. </summary>
@@ -8,16 +8,20 @@
 
 #pragma once
 
+#include "IDistributableTrainer.h"
 #include "ITrainer.h"
 
 #include <predictors/include/LinearPredictor.h>
 
 #include <data/include/Dataset.h>
 #include <data/include/Example.h>
+#include <data/include/StreamingDataset.h>
+#include <data/include/TypedDataset.h>
 
 #include <math/include/Vector.h>
 
 #include <random>
+#include <vector>
 
 namespace ell
 {
@@ -47,6 +51,7 @@ namespace trainers
     /// <typeparam name="RegularizerType"> Regularizer type. </typeparam>
     template <typename LossFunctionType, typename RegularizerType>
     class SDCATrainer : public ITrainer<predictors::LinearPredictor<double>>
+        , public IDistributableTrainer
     {
     public:
         /// <summary> Constructs an instance of SDCATrainer. </summary>
@@ -56,11 +61,31 @@ namespace trainers
         /// <param name="parameters"> Trainer parameters. </param>
         SDCATrainer(const LossFunctionType& lossFunction, const RegularizerType& regularizer, const SDCATrainerParameters& parameters);
 
-        /// <summary> Sets the trainer's dataset. </summary>
+        /// <summary>
+        /// Sets the trainer's dataset. A whole StreamingDataset is used without loading it into memory: each epoch
+        /// loads one chunk at a time, and only the dual variables (one per example) are kept between epochs.
+        /// Other datasets are copied into a typed dataset, so the inner loop knows the data vector type at
+        /// compile time.
+        /// </summary>
         ///
         /// <param name="anyDataset"> A dataset. </param>
         void SetDataset(const data::AnyDataset& anyDataset) override;
 
+        /// <summary>
+        /// Warm-starts the trainer from the dual variables of an earlier run on some of the same examples, for
+        /// instance after new examples are added to a dataset. Each dual variable must be feasible for its example's
+        /// label, which holds for the values returned by GetDualVariables as long as the label is unchanged; zero is
+        /// always feasible. Call after SetDataset and before the first Update.
+        /// </summary>
+        ///
+        /// <param name="dualVariables"> One dual variable per example, in dataset order. </param>
+        void SetDualVariables(const std::vector<double>& dualVariables);
+
+        /// <summary> Gets the dual variables, which can warm-start a later run. </summary>
+        ///
+        /// <returns> One dual variable per example, in dataset order. </returns>
+        std::vector<double> GetDualVariables() const;
+
         /// <summary> Updates the state of the trainer by performing a learning epoch. </summary>
         void Update() override;
 
@@ -74,6 +99,16 @@ namespace trainers
         /// <returns> Information on the trained predictor. </returns>
         SDCAPredictorInfo GetPredictorInfo() const { return _predictorInfo; }
 
+        /// <summary>
+        /// Gets the primal vector, to average with copies of the trainer that train on other shards of the dataset.
+        /// Each copy scales its dual variables by its own shard size, so the average of the primal vectors is the
+        /// primal vector of all the dual variables over the whole dataset, as in CoCoA+ with added updates.
+        /// </summary>
+        std::vector<double> GetSharedState(size_t dimension) const override;
+
+        /// <summary> Replaces the primal vector with its average over the copies of the trainer, and updates the predictor. </summary>
+        void SetSharedState(const std::vector<double>& state, size_t dimension) override;
+
     private:
         struct TrainerMetadata
         {
@@ -92,9 +127,14 @@ namespace trainers
         using DataVectorType = typename predictors::LinearPredictor<double>::DataVectorType;
         using TrainerExampleType = data::Example<DataVectorType, TrainerMetadata>;
 
-        void Step(TrainerExampleType& x);
+        template <typename ExampleType>
+        void Step(ExampleType& x);
+        template <typename DataVectorT>
+        double Predict(const DataVectorT& x) const;
+        void UpdateStreaming();
         void ComputeObjectives();
-        void ResizeTo(const data::AutoDataVector& x);
+        void ComputeStreamingObjectives();
+        void ResizeTo(const data::IDataVector& x);
 
         LossFunctionType _lossFunction;
         RegularizerType _regularizer;
@@ -102,7 +142,10 @@ namespace trainers
         std::default_random_engine _random;
         double _inverseScaledRegularization;
 
-        data::Dataset<TrainerExampleType> _dataset;
+        data::AnyTypedDataset<TrainerMetadata> _dataset;
+        std::vector<size_t> _permutation;
+        const data::AutoSupervisedStreamingDataset* _streamingDataset = nullptr;
+        std::vector<double> _streamingDualVariables;
 
         predictors::LinearPredictor<double> _predictor;
         SDCAPredictorInfo _predictorInfo;
@@ -132,8 +175,13 @@ namespace trainers
 
 #include <data/include/DataVectorOperations.h>
 
+#include <utilities/include/Exception.h>
 #include <utilities/include/RandomEngines.h>
 
+#include <algorithm>
+#include <numeric>
+#include <variant>
+
 namespace ell
 {
 namespace trainers
@@ -152,49 +200,224 @@ namespace trainers
     {
         DEBUG_THROW(_v.Norm0() != 0, utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "can only call SetDataset before updates"));
 
-        _dataset = data::Dataset<TrainerExampleType>(anyDataset);
-        auto numExamples = _dataset.NumExamples();
-        _inverseScaledRegularization = 1.0 / (numExamples * _parameters.regularization);
-
         _predictorInfo.primalObjective = 0;
         _predictorInfo.dualObjective = 0;
 
-        // precompute the norm of each example
-        for (size_t rowIndex = 0; rowIndex < numExamples; ++rowIndex)
+        _streamingDataset = anyDataset.GetStreamingDataset<data::AutoSupervisedExample>();
+        if (_streamingDataset != nullptr)
         {
-            auto& example = _dataset[rowIndex];
-            example.GetMetadata().norm2Squared = example.GetDataVector().Norm2Squared();
+            _dataset = data::AnyTypedDataset<TrainerMetadata>();
+            auto numExamples = _streamingDataset->NumExamples();
+            _inverseScaledRegularization = 1.0 / (numExamples * _parameters.regularization);
+            _streamingDualVariables.assign(numExamples, 0.0);
 
-            auto label = example.GetMetadata().weightLabel.label;
-            _predictorInfo.primalObjective += _lossFunction(0, label) / numExamples;
+            auto exampleIterator = _streamingDataset->GetExampleIterator();
+            while (exampleIterator.IsValid())
+            {
+                auto label = exampleIterator.Get().GetMetadata().label;
+                _predictorInfo.primalObjective += _lossFunction(0, label) / numExamples;
+                exampleIterator.Next();
+            }
+            return;
         }
+
+        _streamingDualVariables.clear();
+        _permutation.clear();
+        _dataset = data::MakeTypedDataset<TrainerMetadata>(anyDataset);
+        std::visit([this](auto& dataset) {
+            auto numExamples = dataset.NumExamples();
+            _inverseScaledRegularization = 1.0 / (numExamples * _parameters.regularization);
+
+            // precompute the norm of each example
+            for (size_t rowIndex = 0; rowIndex < numExamples; ++rowIndex)
+            {
+                auto& example = dataset[rowIndex];
+                example.GetMetadata().norm2Squared = example.GetDataVector().Norm2Squared();
+
+                auto label = example.GetMetadata().weightLabel.label;
+                _predictorInfo.primalObjective += _lossFunction(0, label) / numExamples;
+            }
+        },
+                   _dataset);
     }
 
     template <typename LossFunctionType, typename RegularizerType>
-    void SDCATrainer<LossFunctionType, RegularizerType>::Update()
+    void SDCATrainer<LossFunctionType, RegularizerType>::SetDualVariables(const std::vector<double>& dualVariables)
     {
-        if (_parameters.permute)
+        // v and d are -1/(n * regularization) times the sum of the examples (and of the bias feature) weighted by their dual variables
+        _v.Reset();
+        _d = 0;
+        auto addExample = [this](const auto& dataVector, double dualVariable) {
+            if (dualVariable != 0)
+            {
+                ResizeTo(dataVector);
+                _v.Transpose() += (-dualVariable * _inverseScaledRegularization) * dataVector;
+                _d += (-dualVariable * _inverseScaledRegularization);
+            }
+        };
+
+        if (_streamingDataset != nullptr)
         {
-            _dataset.RandomPermute(_random);
+            if (dualVariables.size() != _streamingDataset->NumExamples())
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "need one dual variable per example");
+            }
+
+            _streamingDualVariables = dualVariables;
+            size_t index = 0;
+            auto exampleIterator = _streamingDataset->GetExampleIterator();
+            while (exampleIterator.IsValid())
+            {
+                addExample(exampleIterator.Get().GetDataVector(), dualVariables[index++]);
+                exampleIterator.Next();
+            }
+        }
+        else
+        {
+            std::visit([&](auto& dataset) {
+                if (dualVariables.size() != dataset.NumExamples())
+                {
+                    throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "need one dual variable per example");
+                }
+
+                for (size_t rowIndex = 0; rowIndex < dataset.NumExamples(); ++rowIndex)
+                {
+                    auto& example = dataset[rowIndex];
+                    example.GetMetadata().dualVariable = dualVariables[rowIndex];
+                    addExample(example.GetDataVector(), dualVariables[rowIndex]);
+                }
+            },
+                       _dataset);
+        }
+
+        _regularizer.ConjugateGradient(_v, _d, _predictor.GetWeights(), _predictor.GetBias());
+        if (_streamingDataset != nullptr)
+        {
+            ComputeStreamingObjectives();
         }
+        else
+        {
+            ComputeObjectives();
+        }
+    }
 
-        // Iterate
-        for (size_t i = 0; i < _dataset.NumExamples(); ++i)
+    template <typename LossFunctionType, typename RegularizerType>
+    std::vector<double> SDCATrainer<LossFunctionType, RegularizerType>::GetDualVariables() const
+    {
+        if (_streamingDataset != nullptr)
         {
-            Step(_dataset[i]);
+            return _streamingDualVariables;
         }
 
+        std::vector<double> dualVariables;
+        std::visit([&dualVariables](const auto& dataset) {
+            for (size_t rowIndex = 0; rowIndex < dataset.NumExamples(); ++rowIndex)
+            {
+                dualVariables.push_back(dataset.GetExample(rowIndex).GetMetadata().dualVariable);
+            }
+        },
+                   _dataset);
+        return dualVariables;
+    }
+
+    template <typename LossFunctionType, typename RegularizerType>
+    std::vector<double> SDCATrainer<LossFunctionType, RegularizerType>::GetSharedState(size_t dimension) const
+    {
+        std::vector<double> state = { _d };
+        AppendToSharedState(state, _v, dimension);
+        return state;
+    }
+
+    template <typename LossFunctionType, typename RegularizerType>
+    void SDCATrainer<LossFunctionType, RegularizerType>::SetSharedState(const std::vector<double>& state, size_t dimension)
+    {
+        size_t offset = 1;
+        _d = state.at(0);
+        ReadFromSharedState(state, offset, _v, dimension);
+        _predictor.Resize(dimension);
+        _regularizer.ConjugateGradient(_v, _d, _predictor.GetWeights(), _predictor.GetBias());
+        if (_streamingDataset != nullptr)
+        {
+            ComputeStreamingObjectives();
+        }
+        else
+        {
+            ComputeObjectives();
+        }
+    }
+
+    template <typename LossFunctionType, typename RegularizerType>
+    void SDCATrainer<LossFunctionType, RegularizerType>::Update()
+    {
+        if (_streamingDataset != nullptr)
+        {
+            UpdateStreaming();
+            ComputeStreamingObjectives();
+            return;
+        }
+
+        std::visit([this](auto& dataset) {
+            // permute the indices rather than moving the examples around
+            if (_parameters.permute)
+            {
+                dataset.RandomPermute(_random, _permutation);
+            }
+
+            // Iterate
+            for (size_t i = 0; i < dataset.NumExamples(); ++i)
+            {
+                Step(dataset[_parameters.permute ? _permutation[i] : i]);
+            }
+        },
+                   _dataset);
+
         // Finish
         ComputeObjectives();
     }
 
+    template <typename LossFunctionType, typename RegularizerType>
+    void SDCATrainer<LossFunctionType, RegularizerType>::UpdateStreaming()
+    {
+        std::vector<size_t> chunkOrder(_streamingDataset->NumChunks());
+        std::iota(chunkOrder.begin(), chunkOrder.end(), 0);
+        if (_parameters.permute)
+        {
+            std::shuffle(chunkOrder.begin(), chunkOrder.end(), _random);
+        }
+
+        for (auto chunkIndex : chunkOrder)
+        {
+            auto chunk = _streamingDataset->template LoadChunk<TrainerExampleType>(chunkIndex);
+            auto firstExampleIndex = _streamingDataset->GetChunkFirstExampleIndex(chunkIndex);
+
+            // permute an index, rather than the chunk, to know where each example's dual variable goes
+            std::vector<size_t> exampleOrder(chunk.NumExamples());
+            std::iota(exampleOrder.begin(), exampleOrder.end(), 0);
+            if (_parameters.permute)
+            {
+                std::shuffle(exampleOrder.begin(), exampleOrder.end(), _random);
+            }
+
+            for (auto i : exampleOrder)
+            {
+                auto& example = chunk[i];
+                auto& dualVariable = _streamingDualVariables[firstExampleIndex + i];
+                example.GetMetadata().norm2Squared = example.GetDataVector().Norm2Squared();
+                example.GetMetadata().dualVariable = dualVariable;
+                Step(example);
+                dualVariable = example.GetMetadata().dualVariable;
+            }
+        }
+    }
+
     template <typename LossFunctionType, typename RegularizerType>
     SDCATrainer<LossFunctionType, RegularizerType>::TrainerMetadata::TrainerMetadata(const data::WeightLabel& original) :
         weightLabel(original)
     {}
 
     template <typename LossFunctionType, typename RegularizerType>
-    void SDCATrainer<LossFunctionType, RegularizerType>::Step(TrainerExampleType& example)
+    template <typename ExampleType>
+    void SDCATrainer<LossFunctionType, RegularizerType>::Step(ExampleType& example)
     {
         const auto& dataVector = example.GetDataVector();
         ResizeTo(dataVector);
@@ -206,7 +429,7 @@ namespace trainers
 
         if (lipschitz > 0)
         {
-            auto prediction = _predictor.Predict(dataVector);
+            auto prediction = Predict(dataVector);
 
             auto newDual = _lossFunction.ConjugateProx(1.0 / lipschitz, dual + prediction / lipschitz, weightLabel.label);
             auto dualDiff = newDual - dual;
@@ -221,23 +444,59 @@ namespace trainers
         }
     }
 
+    template <typename LossFunctionType, typename RegularizerType>
+    template <typename DataVectorT>
+    double SDCATrainer<LossFunctionType, RegularizerType>::Predict(const DataVectorT& x) const
+    {
+        // same as LinearPredictor::Predict, but the call to Dot is resolved at compile time for concrete vector types
+        return x.Dot(_predictor.GetWeights()) + _predictor.GetBias();
+    }
+
     template <typename LossFunctionType, typename RegularizerType>
     void SDCATrainer<LossFunctionType, RegularizerType>::ComputeObjectives()
     {
-        double invSize = 1.0 / _dataset.NumExamples();
+        _predictorInfo.primalObjective = 0;
+        _predictorInfo.dualObjective = 0;
+
+        std::visit([this](const auto& dataset) {
+            double invSize = 1.0 / dataset.NumExamples();
+            for (size_t i = 0; i < dataset.NumExamples(); ++i)
+            {
+                const auto& example = dataset.GetExample(i);
+                auto label = example.GetMetadata().weightLabel.label;
+                auto prediction = Predict(example.GetDataVector());
+                auto dualVariable = example.GetMetadata().dualVariable;
+
+                _predictorInfo.primalObjective += invSize * _lossFunction(prediction, label);
+                _predictorInfo.dualObjective -= invSize * _lossFunction.Conjugate(dualVariable, label);
+            }
+        },
+                   _dataset);
+
+        _predictorInfo.primalObjective += _parameters.regularization * _regularizer(_predictor.GetWeights(), _predictor.GetBias());
+        _predictorInfo.dualObjective -= _parameters.regularization * _regularizer.Conjugate(_v, _d);
+    }
+
+    template <typename LossFunctionType, typename RegularizerType>
+    void SDCATrainer<LossFunctionType, RegularizerType>::ComputeStreamingObjectives()
+    {
+        double invSize = 1.0 / _streamingDataset->NumExamples();
 
         _predictorInfo.primalObjective = 0;
         _predictorInfo.dualObjective = 0;
 
-        for (size_t i = 0; i < _dataset.NumExamples(); ++i)
+        size_t index = 0;
+        auto exampleIterator = _streamingDataset->GetExampleIterator();
+        while (exampleIterator.IsValid())
         {
-            const auto& example = _dataset.GetExample(i);
-            auto label = example.GetMetadata().weightLabel.label;
+            auto example = exampleIterator.Get();
+            auto label = example.GetMetadata().label;
             auto prediction = _predictor.Predict(example.GetDataVector());
-            auto dualVariable = example.GetMetadata().dualVariable;
+            auto dualVariable = _streamingDualVariables[index++];
 
             _predictorInfo.primalObjective += invSize * _lossFunction(prediction, label);
             _predictorInfo.dualObjective -= invSize * _lossFunction.Conjugate(dualVariable, label);
+            exampleIterator.Next();
         }
 
         _predictorInfo.primalObjective += _parameters.regularization * _regularizer(_predictor.GetWeights(), _predictor.GetBias());
@@ -245,7 +504,7 @@ namespace trainers
     }
 
     template <typename LossFunctionType, typename RegularizerType>
-    void SDCATrainer<LossFunctionType, RegularizerType>::ResizeTo(const data::AutoDataVector& x)
+    void SDCATrainer<LossFunctionType, RegularizerType>::ResizeTo(const data::IDataVector& x)
     {
         auto xSize = x.PrefixLength();
         if (xSize > _predictor.Size())
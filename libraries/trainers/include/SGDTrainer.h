@@ -8,17 +8,20 @@
 
 #pragma once
 
+#include "IDistributableTrainer.h"
 #include "ITrainer.h"
 
 #include <predictors/include/LinearPredictor.h>
 
 #include <data/include/Dataset.h>
 #include <data/include/Example.h>
+#include <data/include/StreamingDataset.h>
 
 #include <cstddef>
 #include <memory>
 #include <random>
 #include <string>
+#include <vector>
 
 namespace ell
 {
@@ -40,7 +43,12 @@ namespace trainers
     public:
         using PredictorType = predictors::LinearPredictor<double>;
 
-        /// <summary> Sets the trainer's dataset. </summary>
+        /// <summary>
+        /// Sets the trainer's dataset. A whole StreamingDataset is used without loading it into memory, and each
+        /// epoch visits its chunks and the examples within each chunk in a random order. A whole in-memory
+        /// AutoSupervisedDataset is read in place, through a permutation of its indices, so it must outlive the
+        /// trainer and several trainers can share it. Any other dataset is copied.
+        /// </summary>
         ///
         /// <param name="anyDataset"> A dataset. </param>
         void SetDataset(const data::AnyDataset& anyDataset) override;
@@ -60,7 +68,13 @@ namespace trainers
         virtual void DoNextStep(const data::AutoDataVector& x, double y, double weight) = 0;
         virtual const PredictorType& GetAveragedPredictor() const = 0;
 
+        template <typename ExampleIteratorType>
+        void Update(ExampleIteratorType& exampleIterator);
+
         data::AutoSupervisedDataset _dataset;
+        const data::AutoSupervisedDataset* _sharedDataset = nullptr;
+        std::vector<size_t> _permutation;
+        const data::AutoSupervisedStreamingDataset* _streamingDataset = nullptr;
         std::default_random_engine _random;
         bool _firstIteration = true;
     };
@@ -74,6 +88,7 @@ namespace trainers
     /// <typeparam name="LossFunctionType"> Loss function type. </typeparam>
     template <typename LossFunctionType>
     class SGDTrainer : public SGDTrainerBase
+        , public IDistributableTrainer
     {
     public:
         using SGDTrainerBase::PredictorType;
@@ -94,6 +109,12 @@ namespace trainers
         /// <returns> A const reference to the averaged predictor. </returns>
         const PredictorType& GetAveragedPredictor() const override { return _averagedPredictor; }
 
+        /// <summary> Gets the step count and weights, to average with copies of the trainer that train on other shards of the dataset. </summary>
+        std::vector<double> GetSharedState(size_t dimension) const override;
+
+        /// <summary> Replaces the step count and weights with their average over the copies of the trainer. </summary>
+        void SetSharedState(const std::vector<double>& state, size_t dimension) override;
+
     protected:
         void DoFirstStep(const data::AutoDataVector& x, double y, double weight) override;
         void DoNextStep(const data::AutoDataVector& x, double y, double weight) override;
@@ -118,6 +139,7 @@ namespace trainers
     /// <typeparam name="LossFunctionType"> Loss function type. </typeparam>
     template <typename LossFunctionType>
     class SparseDataSGDTrainer : public SGDTrainerBase
+        , public IDistributableTrainer
     {
     public:
         using SGDTrainerBase::PredictorType;
@@ -138,6 +160,12 @@ namespace trainers
         /// <returns> A const reference to the averaged predictor. </returns>
         const PredictorType& GetAveragedPredictor() const override;
 
+        /// <summary> Gets the step count and weights, to average with copies of the trainer that train on other shards of the dataset. </summary>
+        std::vector<double> GetSharedState(size_t dimension) const override;
+
+        /// <summary> Replaces the step count and weights with their average over the copies of the trainer. </summary>
+        void SetSharedState(const std::vector<double>& state, size_t dimension) override;
+
     protected:
         void DoFirstStep(const data::AutoDataVector& x, double y, double weight) override;
         void DoNextStep(const data::AutoDataVector& x, double y, double weight) override;
@@ -170,6 +198,7 @@ namespace trainers
     /// <typeparam name="LossFunctionType"> Loss function type. </typeparam>
     template <typename LossFunctionType>
     class SparseDataCenteredSGDTrainer : public SGDTrainerBase
+        , public IDistributableTrainer
     {
     public:
         using SGDTrainerBase::PredictorType;
@@ -191,6 +220,12 @@ namespace trainers
         /// <returns> A const reference to the averaged predictor. </returns>
         const PredictorType& GetAveragedPredictor() const override;
 
+        /// <summary> Gets the step count and weights, to average with copies of the trainer that train on other shards of the dataset. </summary>
+        std::vector<double> GetSharedState(size_t dimension) const override;
+
+        /// <summary> Replaces the step count and weights with their average over the copies of the trainer. </summary>
+        void SetSharedState(const std::vector<double>& state, size_t dimension) override;
+
     protected:
         void DoFirstStep(const data::AutoDataVector& x, double y, double weight) override;
         void DoNextStep(const data::AutoDataVector& x, double y, double weight) override;
@@ -330,6 +365,26 @@ namespace trainers
         averagedB += lastB / _t;
     }
 
+    template <typename LossFunctionType>
+    std::vector<double> SGDTrainer<LossFunctionType>::GetSharedState(size_t dimension) const
+    {
+        std::vector<double> state = { _t, _lastPredictor.GetBias(), _averagedPredictor.GetBias() };
+        AppendToSharedState(state, _lastPredictor.GetWeights(), dimension);
+        AppendToSharedState(state, _averagedPredictor.GetWeights(), dimension);
+        return state;
+    }
+
+    template <typename LossFunctionType>
+    void SGDTrainer<LossFunctionType>::SetSharedState(const std::vector<double>& state, size_t dimension)
+    {
+        size_t offset = 3;
+        _t = state.at(0);
+        _lastPredictor.GetBias() = state.at(1);
+        _averagedPredictor.GetBias() = state.at(2);
+        ReadFromSharedState(state, offset, _lastPredictor.GetWeights(), dimension);
+        ReadFromSharedState(state, offset, _averagedPredictor.GetWeights(), dimension);
+    }
+
     template <typename LossFunctionType>
     void SGDTrainer<LossFunctionType>::ResizeTo(const data::AutoDataVector& x)
     {
@@ -417,6 +472,39 @@ namespace trainers
         return _averagedPredictor;
     }
 
+    template <typename LossFunctionType>
+    std::vector<double> SparseDataSGDTrainer<LossFunctionType>::GetSharedState(size_t dimension) const
+    {
+        // The predictors are the sums divided by _t, so share the sums divided by _t, which average to the average
+        // predictors even when the copies have taken different numbers of steps
+        const double scale = _t > 0 ? 1.0 / _t : 0.0;
+        math::ColumnVector<double> v(_v.Size());
+        v += scale * _v;
+        math::ColumnVector<double> u(_u.Size());
+        u += scale * _u;
+        u += (-_h * scale) * _v;
+
+        std::vector<double> state = { _t, _h, scale * _a, scale * _c };
+        AppendToSharedState(state, v, dimension);
+        AppendToSharedState(state, u, dimension);
+        return state;
+    }
+
+    template <typename LossFunctionType>
+    void SparseDataSGDTrainer<LossFunctionType>::SetSharedState(const std::vector<double>& state, size_t dimension)
+    {
+        size_t offset = 4;
+        _t = state.at(0);
+        _h = state.at(1);
+        _a = _t * state.at(2);
+        _c = _t * state.at(3);
+        ReadFromSharedState(state, offset, _v, dimension);
+        ReadFromSharedState(state, offset, _u, dimension);
+        _v *= _t;
+        _u *= _t;
+        _u += _h * _v;
+    }
+
     template <typename LossFunctionType>
     inline void SparseDataSGDTrainer<LossFunctionType>::ResizeTo(const data::AutoDataVector& x)
     {
@@ -519,6 +607,41 @@ namespace trainers
         return _averagedPredictor;
     }
 
+    template <typename LossFunctionType>
+    std::vector<double> SparseDataCenteredSGDTrainer<LossFunctionType>::GetSharedState(size_t dimension) const
+    {
+        // As in SparseDataSGDTrainer, share the sums divided by _t
+        const double scale = _t > 0 ? 1.0 / _t : 0.0;
+        math::ColumnVector<double> v(_v.Size());
+        v += scale * _v;
+        math::ColumnVector<double> u(_u.Size());
+        u += scale * _u;
+        u += (-_h * scale) * _v;
+
+        std::vector<double> state = { _t, _h, scale * _a, scale * _c, scale * _z, scale * _r, scale * _s };
+        AppendToSharedState(state, v, dimension);
+        AppendToSharedState(state, u, dimension);
+        return state;
+    }
+
+    template <typename LossFunctionType>
+    void SparseDataCenteredSGDTrainer<LossFunctionType>::SetSharedState(const std::vector<double>& state, size_t dimension)
+    {
+        size_t offset = 7;
+        _t = state.at(0);
+        _h = state.at(1);
+        _a = _t * state.at(2);
+        _c = _t * state.at(3);
+        _z = _t * state.at(4);
+        _r = _t * state.at(5);
+        _s = _t * state.at(6);
+        ReadFromSharedState(state, offset, _v, dimension);
+        ReadFromSharedState(state, offset, _u, dimension);
+        _v *= _t;
+        _u *= _t;
+        _u += _h * _v;
+    }
+
     template <typename LossFunctionType>
     inline void SparseDataCenteredSGDTrainer<LossFunctionType>::ResizeTo(const data::AutoDataVector& x)
     {
@@ -14,6 +14,8 @@
 #include <predictors/include/ConstantPredictor.h>
 #include <predictors/include/SingleElementThresholdPredictor.h>
 
+#include <vector>
+
 namespace ell
 {
 namespace trainers
@@ -24,7 +26,9 @@ namespace trainers
     };
 
     /// <summary> A trainer for binary decision forests with threshold split rules and constant outputs
-    /// that operates by sorting the data set by each feature. </summary>
+    /// that operates by sorting the data set by each feature. The data set is sorted once, and each node's
+    /// examples are kept in order of each feature as the nodes are split, so that the features can be
+    /// searched for the best split in parallel. </summary>
     ///
     /// <typeparam name="LossFunctionType"> Loss function type. </typeparam>
     /// <typeparam name="BoosterType"> Booster type. </typeparam>
@@ -51,17 +55,51 @@ namespace trainers
         using typename ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::DataVectorType;
         using typename ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::TrainerExampleType;
 
+        /// <summary> Sets the trainer's dataset. </summary>
+        ///
+        /// <param name="anyDataset"> A dataset. </param>
+        void SetDataset(const data::AnyDataset& anyDataset) override;
+
     protected:
         using ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::_dataset;
+        using ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::GetNumThreads;
         SplitCandidate GetBestSplitRuleAtNode(SplittableNodeId nodeId, Range range, Sums sums) override;
         std::vector<EdgePredictorType> GetEdgePredictors(const NodeStats& nodeStats) override;
+        void PrepareRound() override;
+        void OnNodeSplit(const SplitCandidate& splitCandidate) override;
 
     private:
-        void SortNodeDataset(Range range, size_t featureIndex);
+        // the value of a feature in an example, and the example's TrainerMetadata::index
+        struct ColumnEntry
+        {
+            float value;
+            size_t index;
+        };
+
+        // the best split of a node's examples by a single feature
+        struct FeatureSplit
+        {
+            double gain = 0;
+            double threshold = 0;
+            size_t size0 = 0;
+            Sums sums0;
+        };
+
+        FeatureSplit GetBestSplitOnFeature(size_t featureIndex, Range range, const Sums& sums) const;
         double CalculateGain(const Sums& sums, const Sums& sums0, const Sums& sums1) const;
 
         // member variables
         LossFunctionType _lossFunction;
+
+        // for each feature, all of the examples sorted by that feature
+        std::vector<std::vector<ColumnEntry>> _sortedColumns;
+
+        // for each feature, the examples of each node occupy the node's range and are sorted by that feature
+        std::vector<std::vector<ColumnEntry>> _columns;
+
+        // the weak weight and label of each example, by TrainerMetadata::index
+        std::vector<data::WeightLabel> _weakWeightLabels;
+        std::vector<char> _isInFirstChild;
     };
 
     /// <summary> Makes a simple forest trainer. </summary>
@@ -78,6 +116,10 @@ namespace trainers
 
 #pragma region implementation
 
+#include <utilities/include/ParallelFor.h>
+
+#include <algorithm>
+
 namespace ell
 {
 namespace trainers
@@ -90,51 +132,124 @@ namespace trainers
     }
 
     template <typename LossFunctionType, typename BoosterType>
-    auto SortingForestTrainer<LossFunctionType, BoosterType>::GetBestSplitRuleAtNode(SplittableNodeId nodeId, Range range, Sums sums) -> SplitCandidate
+    void SortingForestTrainer<LossFunctionType, BoosterType>::SetDataset(const data::AnyDataset& anyDataset)
     {
+        ForestTrainer<SplitRuleType, EdgePredictorType, BoosterType>::SetDataset(anyDataset);
+
+        // sort the examples by each feature, once
+        auto numExamples = _dataset.NumExamples();
         auto numFeatures = _dataset.NumFeatures();
+        _sortedColumns.assign(numFeatures, std::vector<ColumnEntry>(numExamples));
+        utilities::ParallelFor(numFeatures, GetNumThreads(numFeatures, numExamples), [this, numExamples](size_t featureIndex) {
+            auto& column = _sortedColumns[featureIndex];
+            for (size_t rowIndex = 0; rowIndex < numExamples; ++rowIndex)
+            {
+                const auto& example = _dataset[rowIndex];
+                column[rowIndex] = { static_cast<float>(example.GetDataVector()[featureIndex]), example.GetMetadata().index };
+            }
+            std::stable_sort(column.begin(), column.end(), [](const ColumnEntry& a, const ColumnEntry& b) { return a.value < b.value; });
+        });
+
+        _weakWeightLabels.resize(numExamples);
+        _isInFirstChild.resize(numExamples);
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    auto SortingForestTrainer<LossFunctionType, BoosterType>::GetBestSplitRuleAtNode(SplittableNodeId nodeId, Range range, Sums sums) -> SplitCandidate
+    {
+        auto numFeatures = _columns.size();
+
+        std::vector<FeatureSplit> featureSplits(numFeatures);
+        utilities::ParallelFor(numFeatures, GetNumThreads(numFeatures, range.size), [&](size_t featureIndex) {
+            featureSplits[featureIndex] = GetBestSplitOnFeature(featureIndex, range, sums);
+        });
 
+        // take the first of the features with the highest gain, as a sequential search would
         SplitCandidate bestSplitCandidate(nodeId, range, sums);
+        for (size_t featureIndex = 0; featureIndex < numFeatures; ++featureIndex)
+        {
+            const auto& featureSplit = featureSplits[featureIndex];
+            if (featureSplit.gain > bestSplitCandidate.gain)
+            {
+                bestSplitCandidate.gain = featureSplit.gain;
+                bestSplitCandidate.splitRule = SplitRuleType{ featureIndex, featureSplit.threshold };
+                bestSplitCandidate.ranges = ForestTrainerBase::NodeRanges(range);
+                bestSplitCandidate.ranges.SplitChildRange(0, featureSplit.size0);
+                bestSplitCandidate.stats.SetChildSums({ featureSplit.sums0, sums - featureSplit.sums0 });
+            }
+        }
+        return bestSplitCandidate;
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    auto SortingForestTrainer<LossFunctionType, BoosterType>::GetBestSplitOnFeature(size_t featureIndex, Range range, const Sums& sums) const -> FeatureSplit
+    {
+        FeatureSplit bestSplit;
+        Sums sums0;
 
-        for (size_t inputIndex = 0; inputIndex < numFeatures; ++inputIndex)
+        // consider all thresholds
+        const auto& column = _columns[featureIndex];
+        for (size_t position = range.firstIndex; position + 1 < range.firstIndex + range.size; ++position)
         {
-            // sort the relevant rows of data set in ascending order by inputIndex
-            SortNodeDataset(range, inputIndex);
+            // get friendly names
+            double currentFeatureValue = column[position].value;
+            double nextFeatureValue = column[position + 1].value;
 
-            Sums sums0;
+            // increment sums
+            sums0.Increment(_weakWeightLabels[column[position].index]);
+
+            // only split between rows with different feature values
+            if (currentFeatureValue == nextFeatureValue)
+            {
+                continue;
+            }
+
+            // compute sums1 and gain
+            auto sums1 = sums - sums0;
+            double gain = CalculateGain(sums, sums0, sums1);
 
-            // consider all thresholds
-            double nextFeatureValue = _dataset[range.firstIndex].GetDataVector()[inputIndex];
-            for (size_t rowIndex = range.firstIndex; rowIndex < range.firstIndex + range.size - 1; ++rowIndex)
+            // find gain maximizer
+            if (gain > bestSplit.gain)
             {
-                // get friendly names
-                double currentFeatureValue = nextFeatureValue;
-                nextFeatureValue = _dataset[rowIndex + 1].GetDataVector()[inputIndex];
-
-                // increment sums
-                sums0.Increment(_dataset[rowIndex].GetMetadata().weak);
-
-                // only split between rows with different feature values
-                if (currentFeatureValue == nextFeatureValue)
-                {
-                    continue;
-                }
-
-                // compute sums1 and gain
-                auto sums1 = sums - sums0;
-                double gain = CalculateGain(sums, sums0, sums1);
-
-                // find gain maximizer
-                if (gain > bestSplitCandidate.gain)
-                {
-                    bestSplitCandidate.gain = gain;
-                    bestSplitCandidate.splitRule = SplitRuleType{ inputIndex, 0.5 * (currentFeatureValue + nextFeatureValue) };
-                    bestSplitCandidate.ranges.SplitChildRange(0, rowIndex - range.firstIndex + 1);
-                    bestSplitCandidate.stats.SetChildSums({ sums0, sums1 });
-                }
+                bestSplit.gain = gain;
+                bestSplit.threshold = 0.5 * (currentFeatureValue + nextFeatureValue);
+                bestSplit.size0 = position - range.firstIndex + 1;
+                bestSplit.sums0 = sums0;
             }
         }
-        return bestSplitCandidate;
+        return bestSplit;
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    void SortingForestTrainer<LossFunctionType, BoosterType>::PrepareRound()
+    {
+        for (size_t rowIndex = 0; rowIndex < _dataset.NumExamples(); ++rowIndex)
+        {
+            const auto& metadata = _dataset[rowIndex].GetMetadata();
+            _weakWeightLabels[metadata.index] = metadata.weak;
+        }
+
+        // the new round starts from a single root node
+        _columns = _sortedColumns;
+    }
+
+    template <typename LossFunctionType, typename BoosterType>
+    void SortingForestTrainer<LossFunctionType, BoosterType>::OnNodeSplit(const SplitCandidate& splitCandidate)
+    {
+        const auto& ranges = splitCandidate.ranges;
+        auto range = ranges.GetTotalRange();
+        auto range0 = ranges.GetChildRange(0);
+        for (size_t rowIndex = range.firstIndex; rowIndex < range.firstIndex + range.size; ++rowIndex)
+        {
+            _isInFirstChild[_dataset[rowIndex].GetMetadata().index] = rowIndex < range0.firstIndex + range0.size;
+        }
+
+        // a stable partition keeps the examples of each child sorted
+        auto numFeatures = _columns.size();
+        utilities::ParallelFor(numFeatures, GetNumThreads(numFeatures, range.size), [this, range](size_t featureIndex) {
+            auto begin = _columns[featureIndex].begin() + range.firstIndex;
+            std::stable_partition(begin, begin + range.size, [this](const ColumnEntry& entry) { return _isInFirstChild[entry.index] != 0; });
+        });
     }
 
     template <typename LossFunctionType, typename BoosterType>
@@ -146,14 +261,6 @@ namespace trainers
         return std::vector<EdgePredictorType>{ output0, output1 };
     }
 
-    template <typename LossFunctionType, typename BoosterType>
-    void SortingForestTrainer<LossFunctionType, BoosterType>::SortNodeDataset(Range range, size_t inputIndex)
-    {
-        _dataset.Sort([inputIndex](const data::Example<DataVectorType, TrainerMetadata>& example) { return example.GetDataVector()[inputIndex]; },
-                      range.firstIndex,
-                      range.size);
-    }
-
     template <typename LossFunctionType, typename BoosterType>
     double SortingForestTrainer<LossFunctionType, BoosterType>::CalculateGain(const Sums& sums, const Sums& sums0, const Sums& sums1) const
     {
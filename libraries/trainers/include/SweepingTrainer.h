@@ -15,7 +15,12 @@
 
 #include <evaluators/include/Evaluator.h>
 
+#include <utilities/include/ParallelFor.h>
+
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <numeric>
 #include <random>
 #include <string>
 #include <utility>
@@ -25,7 +30,21 @@ namespace ell
 {
 namespace trainers
 {
-    /// <summary> A class that runs multiple internal trainers and chooses the best performing predictor. </summary>
+    /// <summary> Parameters for the sweeping trainer. </summary>
+    struct SweepingTrainerParameters
+    {
+        size_t numThreads = 0; // zero to use one thread per core
+
+        /// <summary>
+        /// Internal trainers whose evaluation (an error rate or a loss, lower is better) is worse than the best one by
+        /// more than this fraction of the best are no longer updated. Zero or less keeps updating all of them.
+        /// </summary>
+        double earlyTerminationMargin = 0;
+    };
+
+    /// <summary>
+    /// A class that runs multiple internal trainers on the same dataset and chooses the best performing predictor.
+    /// </summary>
     ///
     /// <typeparam name="PredictorType"> The type of predictor returned by this trainer. </typeparam>
     template <typename PredictorType>
@@ -38,14 +57,18 @@ namespace trainers
         /// <summary> Constructs an instance of SweepingTrainer. </summary>
         ///
         /// <param name="evaluatingTrainers"> A vector of evaluating trainers. </param>
-        SweepingTrainer(std::vector<EvaluatingTrainerType>&& evaluatingTrainers);
+        /// <param name="parameters"> The trainer parameters. </param>
+        SweepingTrainer(std::vector<EvaluatingTrainerType>&& evaluatingTrainers, const SweepingTrainerParameters& parameters = {});
 
         /// <summary> Sets the trainer's dataset. </summary>
         ///
         /// <param name="anyDataset"> A dataset. </param>
         void SetDataset(const data::AnyDataset& anyDataset) override;
 
-        /// <summary> Updates the state of the trainer by performing a learning epoch. </summary>
+        /// <summary>
+        /// Updates the state of the trainer by performing a learning epoch with each of the internal trainers that are
+        /// still active. The internal trainers are independent and run concurrently.
+        /// </summary>
         void Update() override;
 
         /// <summary> Gets a const reference to the current predictor. </summary>
@@ -53,19 +76,29 @@ namespace trainers
         /// <returns> A const reference to the current predictor. </returns>
         const PredictorType& GetPredictor() const override;
 
+        /// <summary> Gets the number of internal trainers that haven't been terminated early. </summary>
+        ///
+        /// <returns> The number of active internal trainers. </returns>
+        size_t NumActiveTrainers() const { return _activeTrainers.size(); }
+
     private:
-        data::Dataset<ExampleType> _dataset;
+        size_t GetBestIndex() const;
+        double GetEvaluation(size_t index) const { return _evaluatingTrainers[index].GetEvaluator()->GetGoodness(); }
+
         std::vector<EvaluatingTrainerType> _evaluatingTrainers;
+        std::vector<size_t> _activeTrainers;
+        SweepingTrainerParameters _parameters;
     };
 
     /// <summary> Makes an incremental trainer that runs multiple internal trainers and chooses the best performing predictor. </summary>
     ///
     /// <typeparam name="PredictorType"> Type of the predictor returned by this trainer. </typeparam>
     /// <param name="evaluatingTrainers"> A vector of evaluating trainers. </param>
+    /// <param name="parameters"> The trainer parameters. </param>
     ///
     /// <returns> A unique_ptr to a sweeping trainer. </returns>
     template <typename PredictorType>
-    std::unique_ptr<ITrainer<PredictorType>> MakeSweepingTrainer(std::vector<EvaluatingTrainer<PredictorType>>&& evaluatingTrainers);
+    std::unique_ptr<ITrainer<PredictorType>> MakeSweepingTrainer(std::vector<EvaluatingTrainer<PredictorType>>&& evaluatingTrainers, const SweepingTrainerParameters& parameters = {});
 } // namespace trainers
 } // namespace ell
 
@@ -76,49 +109,66 @@ namespace ell
 namespace trainers
 {
     template <typename PredictorType>
-    SweepingTrainer<PredictorType>::SweepingTrainer(std::vector<EvaluatingTrainerType>&& evaluatingTrainers) :
-        _evaluatingTrainers(std::move(evaluatingTrainers))
+    SweepingTrainer<PredictorType>::SweepingTrainer(std::vector<EvaluatingTrainerType>&& evaluatingTrainers, const SweepingTrainerParameters& parameters) :
+        _evaluatingTrainers(std::move(evaluatingTrainers)),
+        _activeTrainers(_evaluatingTrainers.size()),
+        _parameters(parameters)
     {
         assert(_evaluatingTrainers.size() > 0);
+        std::iota(_activeTrainers.begin(), _activeTrainers.end(), 0);
+        _parameters.numThreads = utilities::GetNumThreads(_parameters.numThreads);
     }
 
     template <typename PredictorType>
     void SweepingTrainer<PredictorType>::SetDataset(const data::AnyDataset& anyDataset)
     {
-        _dataset = data::Dataset<ExampleType>(anyDataset);
+        for (auto& evaluatingTrainer : _evaluatingTrainers)
+        {
+            evaluatingTrainer.SetDataset(anyDataset);
+        }
     }
 
     template <typename PredictorType>
     void SweepingTrainer<PredictorType>::Update()
     {
-        for (size_t i = 0; i < _evaluatingTrainers.size(); ++i)
+        // each thread takes the next trainer that hasn't been updated yet
+        utilities::ParallelForDynamic(_activeTrainers.size(), _parameters.numThreads, [this](size_t i) {
+            _evaluatingTrainers[_activeTrainers[i]].Update();
+        });
+
+        if (_parameters.earlyTerminationMargin > 0)
         {
-            _evaluatingTrainers[i].Update();
+            auto bestEvaluation = GetEvaluation(GetBestIndex());
+            auto threshold = bestEvaluation + _parameters.earlyTerminationMargin * std::abs(bestEvaluation);
+            _activeTrainers.erase(std::remove_if(_activeTrainers.begin(), _activeTrainers.end(), [this, threshold](size_t index) { return !(GetEvaluation(index) <= threshold); }), _activeTrainers.end());
         }
     }
 
     template <typename PredictorType>
     const PredictorType& SweepingTrainer<PredictorType>::GetPredictor() const
     {
-        double bestGoodness = _evaluatingTrainers[0].GetEvaluator()->GetGoodness();
+        return _evaluatingTrainers[GetBestIndex()].GetPredictor();
+    }
+
+    template <typename PredictorType>
+    size_t SweepingTrainer<PredictorType>::GetBestIndex() const
+    {
+        // the first value of each evaluation is an error rate or a loss, which is NaN if the trainer diverged
         size_t bestIndex = 0;
         for (size_t i = 1; i < _evaluatingTrainers.size(); ++i)
         {
-            double goodness = _evaluatingTrainers[i].GetEvaluator()->GetGoodness();
-            if (goodness > bestGoodness)
+            if (GetEvaluation(i) < GetEvaluation(bestIndex) || std::isnan(GetEvaluation(bestIndex)))
             {
-                bestGoodness = goodness;
                 bestIndex = i;
             }
         }
-
-        return _evaluatingTrainers[bestIndex].GetPredictor();
+        return bestIndex;
     }
 
     template <typename PredictorType>
-    std::unique_ptr<ITrainer<PredictorType>> MakeSweepingTrainer(std::vector<EvaluatingTrainer<PredictorType>>&& evaluatingTrainers)
+    std::unique_ptr<ITrainer<PredictorType>> MakeSweepingTrainer(std::vector<EvaluatingTrainer<PredictorType>>&& evaluatingTrainers, const SweepingTrainerParameters& parameters)
     {
-        return std::make_unique<SweepingTrainer<PredictorType>>(std::move(evaluatingTrainers));
+        return std::make_unique<SweepingTrainer<PredictorType>>(std::move(evaluatingTrainers), parameters);
     }
 } // namespace trainers
 } // namespace ell
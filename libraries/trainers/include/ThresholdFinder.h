@@ -22,6 +22,12 @@ namespace trainers
     /// <summary> Base class for threshold predictor finders. </summary>
     class ThresholdFinder
     {
+    public:
+        /// <summary> Constructs a threshold finder. </summary>
+        ///
+        /// <param name="numThreads"> The maximum number of threads used to sort the features, or zero for one per core. </param>
+        ThresholdFinder(size_t numThreads = 0);
+
     protected:
         using DataVectorType = predictors::SingleElementThresholdPredictor::DataVectorType;
 
@@ -45,13 +51,23 @@ namespace trainers
         UniqueValuesResult UniqueValues(ExampleIteratorType exampleIterator) const;
 
     private:
+        // sorts and uniques the values of each feature, with the features split among threads
+        void SortReduceFeatures(std::vector<std::vector<ValueWeight>>& weightedValues, size_t numExamples) const;
         size_t SortReduceCopy(std::vector<ValueWeight>::iterator begin, const std::vector<ValueWeight>::iterator end) const;
+
+        size_t _numThreads;
     };
 
     /// <summary> A threshold finder that finds all possible thresholds. </summary>
     class ExhaustiveThresholdFinder : public ThresholdFinder
     {
     public:
+        /// <summary> Constructs an exhaustive threshold finder. </summary>
+        ///
+        /// <param name="numThreads"> The maximum number of threads used to sort the features, or zero for one per core. </param>
+        ExhaustiveThresholdFinder(size_t numThreads = 0) :
+            ThresholdFinder(numThreads) {}
+
         /// <summary> Returns a vector of SingleElementThresholdPredictor. </summary>
         ///
         /// <typeparam name="ExampleIteratorType"> Type of example iterator. </typeparam>
@@ -75,6 +91,7 @@ namespace trainers
     {
         std::vector<std::vector<ValueWeight>> result;
         double totalWeight = 0.0;
+        size_t numExamples = 0;
 
         // invert and densify result
         while (exampleIterator.IsValid())
@@ -84,6 +101,7 @@ namespace trainers
             double weight = example.GetMetadata().weak.weight;
 
             totalWeight += weight;
+            ++numExamples;
 
             if (result.size() < denseDataVector.PrefixLength())
             {
@@ -98,12 +116,7 @@ namespace trainers
             exampleIterator.Next();
         }
 
-        // sort and unique each feature
-        for (size_t j = 0; j < result.size(); ++j)
-        {
-            auto newSize = SortReduceCopy(result[j].begin(), result[j].end());
-            result[j].resize(newSize);
-        }
+        SortReduceFeatures(result, numExamples);
 
         return { result, totalWeight };
     }
@@ -0,0 +1,451 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     AllReduce.cpp (trainers)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "AllReduce.h"
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// macOS has no MSG_NOSIGNAL
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace ell
+{
+namespace trainers
+{
+    void CombineValues(std::vector<double>& values, const std::vector<double>& otherValues, AllReduceOperation operation)
+    {
+        if (values.size() != otherValues.size())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "AllReduce: the processes have different numbers of values");
+        }
+
+        switch (operation)
+        {
+        case AllReduceOperation::sum:
+            std::transform(values.begin(), values.end(), otherValues.begin(), values.begin(), [](double a, double b) { return a + b; });
+            break;
+        case AllReduceOperation::max:
+            std::transform(values.begin(), values.end(), otherValues.begin(), values.begin(), [](double a, double b) { return std::max(a, b); });
+            break;
+        }
+    }
+
+    //
+    // LocalAllReduceGroup
+    //
+
+    class LocalAllReduceGroup::Process : public IAllReduce
+    {
+    public:
+        Process(LocalAllReduceGroup& group, size_t rank) :
+            _group(group),
+            _rank(rank) {}
+
+        size_t GetNumProcesses() const override { return _group._processes.size(); }
+        size_t GetRank() const override { return _rank; }
+        void AllReduce(std::vector<double>& values, AllReduceOperation operation) override { _group.AllReduce(_rank, values, operation); }
+
+    private:
+        LocalAllReduceGroup& _group;
+        size_t _rank;
+    };
+
+    LocalAllReduceGroup::LocalAllReduceGroup(size_t numProcesses) :
+        _contributions(numProcesses)
+    {
+        if (numProcesses == 0)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "LocalAllReduceGroup: need at least one process");
+        }
+        for (size_t rank = 0; rank < numProcesses; ++rank)
+        {
+            _processes.push_back(std::make_unique<Process>(*this, rank));
+        }
+    }
+
+    LocalAllReduceGroup::~LocalAllReduceGroup() = default;
+
+    IAllReduce& LocalAllReduceGroup::GetProcess(size_t rank)
+    {
+        return *_processes.at(rank);
+    }
+
+    void LocalAllReduceGroup::AllReduce(size_t rank, std::vector<double>& values, AllReduceOperation operation)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _contributions[rank] = values;
+        auto round = _round;
+        if (++_numArrived == _processes.size())
+        {
+            // The last process to get here combines the values, in the order of the ranks
+            _result = _contributions[0];
+            for (size_t otherRank = 1; otherRank < _contributions.size(); ++otherRank)
+            {
+                CombineValues(_result, _contributions[otherRank], operation);
+            }
+            _numArrived = 0;
+            ++_round;
+            _roundFinished.notify_all();
+        }
+        else
+        {
+            _roundFinished.wait(lock, [this, round] { return _round != round; });
+        }
+
+        // The result can't change until every process, including this one, has started the next round
+        values = _result;
+    }
+
+    //
+    // TCPAllReduce
+    //
+
+#if defined(_WIN32)
+    TCPAllReduce::TCPAllReduce(size_t rank, size_t numProcesses, const std::string&, int, const std::string&, double, double) :
+        _rank(rank),
+        _numProcesses(numProcesses)
+    {
+        throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "TCPAllReduce is only available on POSIX systems");
+    }
+
+    TCPAllReduce::~TCPAllReduce() = default;
+
+    void TCPAllReduce::AllReduce(std::vector<double>&, AllReduceOperation)
+    {
+        throw utilities::LogicException(utilities::LogicExceptionErrors::notImplemented, "TCPAllReduce is only available on POSIX systems");
+    }
+#else
+    namespace
+    {
+        // Sent first on each connection, in both directions
+        const char c_handshakeMagic[8] = { 'E', 'L', 'L', 'A', 'R', 'E', 'D', '1' };
+
+        // How long the root waits for a new connection's handshake, so that a stalled peer can't hold it up for long
+        const double c_handshakeTimeoutSeconds = 5;
+
+        utilities::SystemException ConnectionError(const std::string& message)
+        {
+            return utilities::SystemException(utilities::SystemExceptionErrors::connectionFailed, "TCPAllReduce: " + message);
+        }
+
+        void SendBytes(int socket, const void* data, size_t size)
+        {
+            auto bytes = static_cast<const char*>(data);
+            while (size > 0)
+            {
+                auto sent = send(socket, bytes, size, MSG_NOSIGNAL);
+                if (sent <= 0)
+                {
+                    throw ConnectionError("lost the connection to another process");
+                }
+                bytes += sent;
+                size -= static_cast<size_t>(sent);
+            }
+        }
+
+        void ReceiveBytes(int socket, void* data, size_t size)
+        {
+            auto bytes = static_cast<char*>(data);
+            while (size > 0)
+            {
+                auto received = recv(socket, bytes, size, 0);
+                if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                {
+                    throw ConnectionError("timed out waiting for another process");
+                }
+                if (received <= 0)
+                {
+                    throw ConnectionError("lost the connection to another process");
+                }
+                bytes += received;
+                size -= static_cast<size_t>(received);
+            }
+        }
+
+        // Each message is the operation, the number of values, and the values
+        void SendValues(int socket, const std::vector<double>& values, AllReduceOperation operation)
+        {
+            uint64_t header[2] = { static_cast<uint64_t>(operation), values.size() };
+            SendBytes(socket, header, sizeof(header));
+            SendBytes(socket, values.data(), values.size() * sizeof(double));
+        }
+
+        std::vector<double> ReceiveValues(int socket, AllReduceOperation operation, size_t expectedSize)
+        {
+            uint64_t header[2];
+            ReceiveBytes(socket, header, sizeof(header));
+            if (header[0] != static_cast<uint64_t>(operation) || header[1] != expectedSize)
+            {
+                throw ConnectionError("the processes made different allreduce calls");
+            }
+            std::vector<double> values(expectedSize);
+            ReceiveBytes(socket, values.data(), values.size() * sizeof(double));
+            return values;
+        }
+
+        // A handshake is the magic number, the size of the job token and the sender's rank, and the job token
+        void SendHandshake(int socket, const std::string& jobToken, size_t rank)
+        {
+            SendBytes(socket, c_handshakeMagic, sizeof(c_handshakeMagic));
+            uint64_t header[2] = { jobToken.size(), rank };
+            SendBytes(socket, header, sizeof(header));
+            SendBytes(socket, jobToken.data(), jobToken.size());
+        }
+
+        // Returns the sender's rank
+        uint64_t ReceiveHandshake(int socket, const std::string& jobToken)
+        {
+            char magic[sizeof(c_handshakeMagic)];
+            ReceiveBytes(socket, magic, sizeof(magic));
+            uint64_t header[2];
+            ReceiveBytes(socket, header, sizeof(header));
+            if (std::memcmp(magic, c_handshakeMagic, sizeof(magic)) != 0 || header[0] != jobToken.size())
+            {
+                throw ConnectionError("the other process isn't part of this job");
+            }
+            std::string otherJobToken(jobToken.size(), '\0');
+            ReceiveBytes(socket, &otherJobToken[0], otherJobToken.size());
+            if (otherJobToken != jobToken)
+            {
+                throw ConnectionError("the other process isn't part of this job");
+            }
+            return header[1];
+        }
+
+        void SetNoDelay(int socket)
+        {
+            int flag = 1;
+            setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+        }
+
+        // Makes recv on the socket fail after the given time (0 means never)
+        void SetReceiveTimeout(int socket, double seconds)
+        {
+            timeval timeout = {};
+            if (seconds > 0)
+            {
+                auto microseconds = std::max<int64_t>(static_cast<int64_t>(seconds * 1e6), 1000);
+                timeout.tv_sec = static_cast<time_t>(microseconds / 1000000);
+                timeout.tv_usec = static_cast<suseconds_t>(microseconds % 1000000);
+            }
+            setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        }
+
+        template <typename TimePoint>
+        double SecondsUntil(TimePoint deadline)
+        {
+            return std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+        }
+
+        addrinfo* Resolve(const std::string& host, int port, bool isListening)
+        {
+            addrinfo hints = {};
+            hints.ai_family = AF_INET;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = isListening ? AI_PASSIVE : 0;
+            addrinfo* addresses = nullptr;
+            if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0 || addresses == nullptr)
+            {
+                throw ConnectionError("couldn't resolve " + host);
+            }
+            return addresses;
+        }
+    } // namespace
+
+    TCPAllReduce::TCPAllReduce(size_t rank, size_t numProcesses, const std::string& rootAddress, int port, const std::string& jobToken, double timeoutSeconds, double receiveTimeoutSeconds) :
+        _rank(rank),
+        _numProcesses(numProcesses)
+    {
+        if (numProcesses == 0 || rank >= numProcesses)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "TCPAllReduce: the rank must be less than the number of processes");
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeoutSeconds);
+        if (rank == 0)
+        {
+            _sockets.assign(numProcesses, -1);
+            if (numProcesses == 1)
+            {
+                return;
+            }
+
+            int listener = socket(AF_INET, SOCK_STREAM, 0);
+            if (listener < 0)
+            {
+                throw ConnectionError("couldn't create a socket");
+            }
+            int reuse = 1;
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+            addrinfo* address = nullptr;
+            try
+            {
+                address = Resolve(rootAddress, port, true);
+            }
+            catch (...)
+            {
+                close(listener);
+                throw;
+            }
+            auto isListening = bind(listener, address->ai_addr, address->ai_addrlen) == 0 && listen(listener, static_cast<int>(numProcesses)) == 0;
+            freeaddrinfo(address);
+            if (!isListening)
+            {
+                close(listener);
+                throw ConnectionError("couldn't listen on " + rootAddress + ":" + std::to_string(port));
+            }
+
+            // Each process sends a handshake with its rank when it connects. Connections that don't send a valid one in
+            // time are dropped, so that a stray or stalled peer can't take the place of a process of this job.
+            auto fail = [this, listener](const std::string& message) {
+                close(listener);
+                for (auto s : _sockets)
+                {
+                    if (s >= 0)
+                    {
+                        close(s);
+                    }
+                }
+                return ConnectionError(message);
+            };
+            size_t numConnected = 1;
+            while (numConnected < numProcesses)
+            {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+                pollfd waitForConnection = { listener, POLLIN, 0 };
+                if (remaining <= 0 || poll(&waitForConnection, 1, static_cast<int>(remaining)) <= 0)
+                {
+                    throw fail("timed out waiting for the other processes to connect");
+                }
+
+                int connection = accept(listener, nullptr, nullptr);
+                if (connection < 0)
+                {
+                    continue;
+                }
+                try
+                {
+                    SetReceiveTimeout(connection, std::min(SecondsUntil(deadline), c_handshakeTimeoutSeconds));
+                    auto otherRank = ReceiveHandshake(connection, jobToken);
+                    if (otherRank == 0 || otherRank >= numProcesses || _sockets[otherRank] >= 0)
+                    {
+                        throw ConnectionError("a process connected with an invalid rank");
+                    }
+                    SendHandshake(connection, jobToken, 0);
+                    SetReceiveTimeout(connection, receiveTimeoutSeconds);
+                    SetNoDelay(connection);
+                    _sockets[otherRank] = connection;
+                    ++numConnected;
+                }
+                catch (const utilities::SystemException&)
+                {
+                    close(connection);
+                }
+            }
+            close(listener);
+        }
+        else
+        {
+            auto addresses = Resolve(rootAddress, port, false);
+
+            // The root may not be listening yet, so keep trying until the deadline
+            int connection = -1;
+            while (connection < 0)
+            {
+                connection = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+                if (connection >= 0 && connect(connection, addresses->ai_addr, addresses->ai_addrlen) == 0)
+                {
+                    break;
+                }
+                if (connection >= 0)
+                {
+                    close(connection);
+                    connection = -1;
+                }
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    freeaddrinfo(addresses);
+                    throw ConnectionError("couldn't connect to " + rootAddress + ":" + std::to_string(port));
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            freeaddrinfo(addresses);
+
+            try
+            {
+                SetReceiveTimeout(connection, std::max(SecondsUntil(deadline), c_handshakeTimeoutSeconds));
+                SendHandshake(connection, jobToken, rank);
+                if (ReceiveHandshake(connection, jobToken) != 0)
+                {
+                    throw ConnectionError("the process at " + rootAddress + ":" + std::to_string(port) + " isn't the root of this job");
+                }
+            }
+            catch (const utilities::SystemException&)
+            {
+                close(connection);
+                throw ConnectionError("the process at " + rootAddress + ":" + std::to_string(port) + " rejected this process; check the rank and the job token");
+            }
+            SetReceiveTimeout(connection, receiveTimeoutSeconds);
+            SetNoDelay(connection);
+            _sockets = { connection };
+        }
+    }
+
+    TCPAllReduce::~TCPAllReduce()
+    {
+        for (auto s : _sockets)
+        {
+            if (s >= 0)
+            {
+                close(s);
+            }
+        }
+    }
+
+    void TCPAllReduce::AllReduce(std::vector<double>& values, AllReduceOperation operation)
+    {
+        if (_rank != 0)
+        {
+            SendValues(_sockets[0], values, operation);
+            values = ReceiveValues(_sockets[0], operation, values.size());
+            return;
+        }
+
+        // Combine in the order of the ranks, then send the result back
+        for (size_t otherRank = 1; otherRank < _numProcesses; ++otherRank)
+        {
+            CombineValues(values, ReceiveValues(_sockets[otherRank], operation, values.size()), operation);
+        }
+        for (size_t otherRank = 1; otherRank < _numProcesses; ++otherRank)
+        {
+            SendValues(_sockets[otherRank], values, operation);
+        }
+    }
+#endif // _WIN32
+} // namespace trainers
+} // namespace ell
@@ -23,6 +23,14 @@ namespace trainers
         sumWeightedLabels += weightLabel.weight * weightLabel.label;
     }
 
+    typename ForestTrainerBase::Sums ForestTrainerBase::Sums::operator+(const Sums& other) const
+    {
+        Sums sum;
+        sum.sumWeights = sumWeights + other.sumWeights;
+        sum.sumWeightedLabels = sumWeightedLabels + other.sumWeightedLabels;
+        return sum;
+    }
+
     typename ForestTrainerBase::Sums ForestTrainerBase::Sums::operator-(const Sums& other) const
     {
         Sums difference;
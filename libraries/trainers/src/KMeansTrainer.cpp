@@ -10,19 +10,44 @@
 #include <math/include/MatrixOperations.h>
 #include <math/include/VectorOperations.h>
 
+#include <utilities/include/ParallelFor.h>
+
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace ell
 {
 namespace trainers
 {
-    KMeansTrainer::KMeansTrainer(size_t dim, size_t numClusters, size_t iterations) :
+    namespace
+    {
+        // The number of points whose distances to the means are computed by one matrix product
+        const size_t c_blockSize = 256;
+
+        size_t GetNumBlocks(size_t numPoints)
+        {
+            return (numPoints + c_blockSize - 1) / c_blockSize;
+        }
+
+        std::default_random_engine MakeRandomEngine(const std::string& randomSeedString)
+        {
+            std::seed_seq seed(randomSeedString.begin(), randomSeedString.end());
+            return std::default_random_engine(seed);
+        }
+    } // namespace
+
+    KMeansTrainer::KMeansTrainer(size_t dim, size_t numClusters, size_t iterations, const KMeansTrainerParameters& parameters) :
+        _parameters(parameters),
+        _random(MakeRandomEngine(parameters.randomSeedString)),
         _means(dim, numClusters),
         _isInitialized(false),
         _iterations(iterations),
         _numClusters(numClusters) {}
 
-    KMeansTrainer::KMeansTrainer(size_t numClusters, size_t iters, math::ColumnMatrix<double> means) :
+    KMeansTrainer::KMeansTrainer(size_t numClusters, size_t iters, math::ColumnMatrix<double> means, const KMeansTrainerParameters& parameters) :
+        _parameters(parameters),
+        _random(MakeRandomEngine(parameters.randomSeedString)),
         _means(means),
         _isInitialized(true),
         _iterations(iters),
@@ -30,151 +55,233 @@ namespace trainers
 
     void KMeansTrainer::RunKMeans(math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> X)
     {
+        auto pointNorms = squaredNorms(X);
         if (false == _isInitialized)
-            initializeMeans(X);
+        {
+            initializeMeans(X, pointNorms);
+            _isInitialized = true;
+        }
 
-        math::ColumnVector<size_t> clusterAssignment(X.NumColumns());
-        double prevDistance = 0.0;
-        for (size_t i = 0; i < _iterations; ++i)
+        std::vector<size_t> clusterAssignment(X.NumColumns());
+        if (_parameters.batchSize > 0 && _parameters.batchSize < X.NumColumns())
         {
-            auto totalDistance = assignClosestCenter(X, clusterAssignment);
-            if (totalDistance == prevDistance)
-                break;
-            recomputeMeans(X, clusterAssignment);
-            prevDistance = totalDistance;
+            std::vector<size_t> numPointsPerCluster(_numClusters);
+            for (size_t i = 0; i < _iterations; ++i)
+            {
+                updateMeansWithBatch(X, pointNorms, numPointsPerCluster);
+            }
+            assignClosestCenter(X, pointNorms, clusterAssignment);
+        }
+        else
+        {
+            double prevDistance = 0.0;
+            for (size_t i = 0; i < _iterations; ++i)
+            {
+                auto totalDistance = assignClosestCenter(X, pointNorms, clusterAssignment);
+                if (totalDistance == prevDistance)
+                    break;
+                recomputeMeans(X, clusterAssignment);
+                prevDistance = totalDistance;
+            }
+        }
+
+        _clusterAssignment.Resize(clusterAssignment.size());
+        for (size_t i = 0; i < clusterAssignment.size(); ++i)
+        {
+            _clusterAssignment[i] = static_cast<double>(clusterAssignment[i]);
         }
     }
 
-    void KMeansTrainer::initializeMeans(math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> X)
+    void KMeansTrainer::initializeMeans(ConstColumnMatrixReference X, const std::vector<double>& pointNorms)
     {
         size_t N = X.NumColumns();
-        size_t choice = rand() % N;
+        size_t choice = std::uniform_int_distribution<size_t>(0, N - 1)(_random);
 
         _means.GetColumn(0).CopyFrom(X.GetColumn(choice));
 
-        math::ColumnVector<double> minimumDistance(X.NumColumns());
+        // minimumDistance[i] = min_j || X_i - mu_j ||^2 over the means chosen so far
+        std::vector<double> minimumDistance(N, std::numeric_limits<double>::max());
         for (size_t k = 1; k < _numClusters; ++k)
         {
-            // distance to previously selected mean
-            auto D = pairwiseDistance(X, _means.GetSubMatrix(0, k - 1, _means.NumRows(), 1));
-            auto distanceToPreviousMean = D.GetColumn(0);
-
-            if (k == 1)
-            {
-                minimumDistance.CopyFrom(distanceToPreviousMean);
-            }
-            else
-            {
-                // distance to closest center
-                for (size_t i = 0; i < minimumDistance.Size(); ++i)
+            auto mean = _means.GetColumn(k - 1);
+            auto meanNorm = mean.Norm2Squared();
+            utilities::ParallelFor(GetNumBlocks(N), getNumThreads(), [&](size_t blockIndex) {
+                auto first = blockIndex * c_blockSize;
+                auto size = std::min(c_blockSize, N - first);
+                math::ColumnVector<double> crossTerms(size);
+                math::MultiplyScaleAddUpdate(1.0, X.GetSubMatrix(0, first, X.NumRows(), size).Transpose(), mean, 0.0, crossTerms);
+                for (size_t i = 0; i < size; ++i)
                 {
-                    minimumDistance[i] = std::min(minimumDistance[i], distanceToPreviousMean[i]);
+                    auto distance = std::max(pointNorms[first + i] + meanNorm - 2.0 * crossTerms[i], 0.0);
+                    minimumDistance[first + i] = std::min(minimumDistance[first + i], distance);
                 }
-            }
+            });
 
             choice = weightedSample(minimumDistance);
             _means.GetColumn(k).CopyFrom(X.GetColumn(choice));
         }
     }
 
+    std::vector<double> KMeansTrainer::squaredNorms(ConstColumnMatrixReference X)
+    {
+        std::vector<double> norms(X.NumColumns());
+        utilities::ParallelFor(GetNumBlocks(X.NumColumns()), getNumThreads(), [&](size_t blockIndex) {
+            auto end = std::min((blockIndex + 1) * c_blockSize, X.NumColumns());
+            for (auto i = blockIndex * c_blockSize; i < end; ++i)
+            {
+                norms[i] = X.GetColumn(i).Norm2Squared();
+            }
+        });
+        return norms;
+    }
+
     /// D_ij = || X_i - mu_j || ^ 2   (Distance of ith point to jth cluster)
     /// distance = ||X||^2 + ||means||^2 - 2 *  means * X'
-    math::RowMatrix<double> KMeansTrainer::pairwiseDistance(math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> X, math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> means)
+    double KMeansTrainer::assignClosestCenter(ConstColumnMatrixReference X, const std::vector<double>& pointNorms, std::vector<size_t>& clusterAssignment)
     {
         auto n = X.NumColumns();
-        auto k = means.NumColumns();
-
-        math::ColumnMatrix<double> xSq(X.NumRows(), n);
-        math::ElementwiseMultiplySet(X, X, xSq);
-
-        math::ColumnMatrix<double> muSq(means.NumRows(), k);
-        math::ElementwiseMultiplySet(means, means, muSq);
-
-        math::ColumnMatrix<double> xSqNorm(1, xSq.NumColumns());
-        math::ColumnwiseSum(xSq, xSqNorm.GetRow(0));
-
-        math::ColumnMatrix<double> muSqNorm(1, muSq.NumColumns());
-        math::ColumnwiseSum(muSq, muSqNorm.GetRow(0));
-
-        math::RowMatrix<double> onesMultiplier(k, 1);
-        onesMultiplier.Fill(1.0);
-        math::RowMatrix<double> distFactor1(k, n);
-        math::MultiplyScaleAddUpdate(1.0, onesMultiplier, xSqNorm, 0.0, distFactor1);
-
-        math::ColumnMatrix<double> onesMultiplier1 = math::ColumnMatrix<double>(n, 1);
-        onesMultiplier1.Fill(1.0);
-        math::ColumnMatrix<double> distFactor2(n, k);
-        math::MultiplyScaleAddUpdate(1.0, onesMultiplier1, muSqNorm, 0.0, distFactor2);
-
-        math::RowMatrix<double> muX(n, k);
-        math::MultiplyScaleAddUpdate(1.0, X.Transpose(), means, 1.0, muX);
+        auto k = _means.NumColumns();
 
-        math::ColumnMatrix<double> tempD(n, k);
-        math::ScaleAddSet(1.0, distFactor1.Transpose(), -2.0, muX, tempD);
+        std::vector<double> meanNorms(k);
+        for (size_t j = 0; j < k; ++j)
+        {
+            meanNorms[j] = _means.GetColumn(j).Norm2Squared();
+        }
 
-        math::ColumnMatrix<double> distance(n, k);
-        math::ScaleAddSet(1.0, tempD, 1.0, distFactor2, distance);
+        // sum the distances of each block separately, so the total doesn't depend on the number of threads
+        auto numBlocks = GetNumBlocks(n);
+        std::vector<double> blockDistances(numBlocks);
+        utilities::ParallelFor(numBlocks, getNumThreads(), [&](size_t blockIndex) {
+            auto first = blockIndex * c_blockSize;
+            auto size = std::min(c_blockSize, n - first);
+            math::RowMatrix<double> crossTerms(size, k);
+            math::MultiplyScaleAddUpdate(1.0, X.GetSubMatrix(0, first, X.NumRows(), size).Transpose(), _means, 0.0, crossTerms);
+
+            double totalDist = 0;
+            for (size_t i = 0; i < size; ++i)
+            {
+                auto crossTermsRow = crossTerms.GetRow(i);
+                size_t closest = 0;
+                double minDistance = std::numeric_limits<double>::max();
+                for (size_t j = 0; j < k; ++j)
+                {
+                    auto distance = meanNorms[j] - 2.0 * crossTermsRow[j];
+                    if (distance < minDistance)
+                    {
+                        minDistance = distance;
+                        closest = j;
+                    }
+                }
+                clusterAssignment[first + i] = closest;
+                totalDist += std::max(pointNorms[first + i] + minDistance, 0.0);
+            }
+            blockDistances[blockIndex] = totalDist;
+        });
 
-        return distance;
+        double totalDist = 0;
+        for (auto distance : blockDistances)
+        {
+            totalDist += distance;
+        }
+        return totalDist;
     }
 
-    double KMeansTrainer::assignClosestCenter(math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> X, math::VectorReference<size_t, math::VectorOrientation::column> clusterAssignment)
+    void KMeansTrainer::recomputeMeans(ConstColumnMatrixReference X, const std::vector<size_t>& clusterAssignment)
     {
-        auto D = pairwiseDistance(X, _means);
+        // each thread sums the points of a contiguous range of blocks
+        auto numBlocks = GetNumBlocks(X.NumColumns());
+        auto numRanges = std::max(std::min(getNumThreads(), numBlocks), size_t{ 1 });
+        std::vector<math::ColumnMatrix<double>> clusterSums(numRanges, math::ColumnMatrix<double>(X.NumRows(), _numClusters));
+        std::vector<std::vector<size_t>> numPointsPerCluster(numRanges, std::vector<size_t>(_numClusters));
+        utilities::ParallelFor(numRanges, getNumThreads(), [&](size_t rangeIndex) {
+            auto end = std::min(X.NumColumns(), numBlocks * (rangeIndex + 1) / numRanges * c_blockSize);
+            for (auto i = numBlocks * rangeIndex / numRanges * c_blockSize; i < end; ++i)
+            {
+                auto idx = clusterAssignment[i];
+                clusterSums[rangeIndex].GetColumn(idx) += X.GetColumn(i);
+                numPointsPerCluster[rangeIndex][idx] += 1;
+            }
+        });
 
-        double totalDist = 0;
-        for (size_t i = 0; i < D.NumRows(); ++i)
+        for (size_t i = 0; i < _numClusters; i++)
         {
-            auto dist = D.GetRow(i);
-            auto minElement = std::min_element(dist.GetDataPointer(), dist.GetDataPointer() + dist.Size());
-            clusterAssignment[i] = minElement - dist.GetDataPointer();
-            totalDist += *minElement;
-        }
+            auto clusterSum = clusterSums[0].GetColumn(i);
+            auto numPoints = numPointsPerCluster[0][i];
+            for (size_t rangeIndex = 1; rangeIndex < numRanges; ++rangeIndex)
+            {
+                clusterSum += clusterSums[rangeIndex].GetColumn(i);
+                numPoints += numPointsPerCluster[rangeIndex][i];
+            }
 
-        return totalDist;
+            // a cluster that lost all its points keeps its mean
+            if (numPoints > 0)
+            {
+                clusterSum /= static_cast<double>(numPoints);
+                _means.GetColumn(i).CopyFrom(clusterSum);
+            }
+        }
     }
 
-    void KMeansTrainer::recomputeMeans(math::ConstMatrixReference<double, math::MatrixLayout::columnMajor> X, const math::ColumnVector<size_t> clusterAssignment)
+    void KMeansTrainer::updateMeansWithBatch(ConstColumnMatrixReference X, const std::vector<double>& pointNorms, std::vector<size_t>& numPointsPerCluster)
     {
-        math::ColumnMatrix<double> clusterSum(X.NumRows(), _numClusters);
-        math::ColumnVector<double> numPointsPerCluster(_numClusters);
-        for (size_t i = 0; i < X.NumColumns(); ++i)
+        auto batchSize = _parameters.batchSize;
+        std::uniform_int_distribution<size_t> pointDistribution(0, X.NumColumns() - 1);
+        std::vector<size_t> batchIndices(batchSize);
+        math::ColumnMatrix<double> batch(X.NumRows(), batchSize);
+        std::vector<double> batchNorms(batchSize);
+        for (size_t i = 0; i < batchSize; ++i)
         {
-            auto idx = clusterAssignment[i];
-            clusterSum.GetColumn(idx) += X.GetColumn(i);
-            numPointsPerCluster[idx] += 1;
+            batchIndices[i] = pointDistribution(_random);
+            batch.GetColumn(i).CopyFrom(X.GetColumn(batchIndices[i]));
+            batchNorms[i] = pointNorms[batchIndices[i]];
         }
 
-        for (size_t i = 0; i < _numClusters; i++)
+        // all the points in the batch are assigned to the means from before the batch, then each mean moves towards
+        // each of its points with a step size that decreases with the number of points it has seen
+        std::vector<size_t> batchAssignment(batchSize);
+        assignClosestCenter(batch, batchNorms, batchAssignment);
+        for (size_t i = 0; i < batchSize; ++i)
         {
-            clusterSum.GetColumn(i) /= numPointsPerCluster[i];
+            auto cluster = batchAssignment[i];
+            auto stepSize = 1.0 / static_cast<double>(++numPointsPerCluster[cluster]);
+            math::ScaleAddUpdate(stepSize, batch.GetColumn(i), 1.0 - stepSize, _means.GetColumn(cluster));
         }
-
-        _means.CopyFrom(clusterSum);
     }
 
-    size_t KMeansTrainer::weightedSample(math::ColumnVector<double> weights)
+    size_t KMeansTrainer::getNumThreads() const
     {
-        double sum = weights.Aggregate([](double x) { return x; });
+        return utilities::GetNumThreads(_parameters.numThreads);
+    }
 
-        auto threshold = ((double)rand() / (RAND_MAX));
-        threshold = sum * threshold;
-        double cummulativeSum = 0;
+    size_t KMeansTrainer::weightedSample(const std::vector<double>& weights)
+    {
+        double sum = 0;
+        for (auto weight : weights)
+        {
+            sum += weight;
+        }
 
-        int choice = -1;
+        // Select an index uniformly at random if all the weights are 0
+        if (sum <= 0)
+        {
+            return std::uniform_int_distribution<size_t>(0, weights.size() - 1)(_random);
+        }
 
         // Select choice to be the smallest index i such that ( sum_{ j <= i } weights[j] ) >= threshold
-        while (cummulativeSum < threshold)
+        auto threshold = std::uniform_real_distribution<double>(0, sum)(_random);
+        double cummulativeSum = 0;
+        for (size_t choice = 0; choice < weights.size(); ++choice)
         {
-            choice += 1;
             cummulativeSum += weights[choice];
+            if (cummulativeSum >= threshold && weights[choice] > 0)
+            {
+                return choice;
+            }
         }
 
-        // Select an index uniformly at random if all the weights are 0
-        if (-1 == choice)
-            choice = rand() % weights.Size();
-
-        return choice;
+        // rounding can leave the threshold just above the full sum
+        auto last = std::find_if(weights.rbegin(), weights.rend(), [](double weight) { return weight > 0; });
+        return weights.size() - 1 - (last - weights.rbegin());
     }
 } // namespace trainers
 } // namespace ell
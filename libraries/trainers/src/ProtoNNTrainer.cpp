@@ -10,13 +10,17 @@
 #include "ProtoNNInit.h"
 #include "ProtoNNTrainerUtils.h"
 
+#include <math/include/Expressions.h>
 #include <math/include/MatrixOperations.h>
 #include <math/include/Vector.h>
 
 #include <data/include/Dataset.h>
+#include <data/include/SparseDataVector.h>
 
+#include <utilities/include/ParallelFor.h>
 #include <utilities/include/Unused.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <ctime>
@@ -31,6 +35,14 @@ namespace trainers
         constexpr double ArmijoStepTolerance = 0.02;
 
         constexpr double DefaultStepSize = 0.2;
+
+        constexpr size_t DefaultBatchSize = 1 << 8;
+
+        // The smallest piece of a batch worth handing to another thread
+        constexpr size_t MinExamplesPerThread = 32;
+
+        // The number of examples projected at a time by ProjectInputs
+        constexpr size_t ProjectionBlockSize = 1024;
     } // namespace
 
     double safe_div(const double& num, const double& den)
@@ -41,21 +53,91 @@ namespace trainers
         return ret;
     }
 
+    ProtoNNInputMatrix::ProtoNNInputMatrix(size_t numRows) :
+        _numRows(numRows),
+        _columnOffsets(1, 0)
+    {
+    }
+
+    void ProtoNNInputMatrix::AppendColumn(const data::AutoDataVector& dataVector)
+    {
+        auto sparseVector = dataVector.CopyAs<data::SparseDoubleDataVector>();
+        auto iterator = sparseVector.GetIterator<data::IterationPolicy::skipZeros>();
+        while (iterator.IsValid())
+        {
+            auto indexValue = iterator.Get();
+            if (indexValue.index < _numRows)
+            {
+                _indices.push_back(indexValue.index);
+                _values.push_back(indexValue.value);
+            }
+            iterator.Next();
+        }
+        _columnOffsets.push_back(_indices.size());
+    }
+
+    void ProtoNNInputMatrix::Project(ConstColumnMatrixReference W, size_t begin, size_t end, math::ColumnMatrixReference<double> result) const
+    {
+        assert(W.NumColumns() == _numRows && result.NumColumns() == end - begin);
+
+        // result(:, j) = sum over the nonzeros x_kj of x_kj * W(:, k)
+        result.Reset();
+        for (size_t j = begin; j < end; ++j)
+        {
+            auto resultColumn = result.GetColumn(j - begin);
+            for (auto entry = _columnOffsets[j]; entry < _columnOffsets[j + 1]; ++entry)
+            {
+                math::ScaleAddUpdate(_values[entry], W.GetColumn(_indices[entry]), math::One(), resultColumn);
+            }
+        }
+    }
+
+    void ProtoNNInputMatrix::MultiplyTransposeAdd(ConstColumnMatrixReference A, size_t begin, size_t end, math::ColumnMatrixReference<double> result) const
+    {
+        assert(A.NumColumns() == end - begin && result.NumColumns() == _numRows);
+
+        // only the columns of result matching nonzero inputs change
+        for (size_t j = begin; j < end; ++j)
+        {
+            auto column = A.GetColumn(j - begin);
+            for (auto entry = _columnOffsets[j]; entry < _columnOffsets[j + 1]; ++entry)
+            {
+                math::ScaleAddUpdate(_values[entry], column, math::One(), result.GetColumn(_indices[entry]));
+            }
+        }
+    }
+
     ProtoNNTrainer::ProtoNNTrainer(const ProtoNNTrainerParameters& parameters) :
         _dimemsion(parameters.numFeatures),
         _parameters(parameters),
         _protoNNPredictor(parameters.numFeatures, parameters.projectedDimension, parameters.numPrototypesPerLabel * parameters.numLabels, parameters.numLabels, parameters.gamma),
-        _X(0, 0),
+        _X(parameters.numFeatures),
         _Y(0, 0)
     {
     }
 
     void ProtoNNTrainer::SetDataset(const data::AnyDataset& anyDataset)
     {
-        auto numExamples = anyDataset.NumExamples();
-        _X = math::ColumnMatrix<double>(_dimemsion, numExamples);
-        _Y = math::ColumnMatrix<double>(_parameters.numLabels, numExamples),
-        ProtoNNTrainerUtils::GetDatasetAsMatrix(anyDataset, _X, _Y);
+        _X = ProtoNNInputMatrix(_dimemsion);
+        std::vector<size_t> labels;
+        auto exampleIterator = anyDataset.GetExampleIterator<data::AutoSupervisedExample>();
+        while (exampleIterator.IsValid())
+        {
+            const auto& example = exampleIterator.Get();
+            _X.AppendColumn(example.GetDataVector());
+            labels.push_back(static_cast<size_t>(example.GetMetadata().label));
+            exampleIterator.Next();
+        }
+
+        // one-hot encode the labels
+        _Y = math::ColumnMatrix<double>(_parameters.numLabels, labels.size());
+        for (size_t j = 0; j < labels.size(); ++j)
+        {
+            if (labels[j] < _Y.NumRows())
+            {
+                _Y(labels[j], j) = 1;
+            }
+        }
         _firstIteration = true;
     }
 
@@ -91,8 +173,14 @@ namespace trainers
         auto generator = [&]() { return normal(rng); };
         W.Generate(generator);
 
+        _modelMap[ProtoNNParameterIndex::W] = std::make_shared<trainers::Param_W>(d, D);
+        _modelMap[ProtoNNParameterIndex::Z] = std::make_shared<trainers::Param_Z>(l, m);
+        _modelMap[ProtoNNParameterIndex::B] = std::make_shared<trainers::Param_B>(d, m);
+
+        _modelMap[ProtoNNParameterIndex::W]->GetData() = W;
+
         math::ColumnMatrix<double> WX(W.NumRows(), n);
-        math::MultiplyScaleAddUpdate(1.0, W, _X, 0.0, WX);
+        ProjectInputs(_X, WX);
 
         ProtoNNInit protonnInit(d, _parameters.numLabels, _parameters.numPrototypesPerLabel);
         protonnInit.Initialize(WX, _Y);
@@ -100,11 +188,6 @@ namespace trainers
         math::ColumnMatrix<double> B = protonnInit.GetPrototypeMatrix();
         math::ColumnMatrix<double> Z = protonnInit.GetLabelMatrix();
 
-        _modelMap[ProtoNNParameterIndex::W] = std::make_shared<trainers::Param_W>(d, D);
-        _modelMap[ProtoNNParameterIndex::Z] = std::make_shared<trainers::Param_Z>(l, m);
-        _modelMap[ProtoNNParameterIndex::B] = std::make_shared<trainers::Param_B>(d, m);
-
-        _modelMap[ProtoNNParameterIndex::W]->GetData() = W;
         _modelMap[ProtoNNParameterIndex::Z]->GetData() = Z;
         _modelMap[ProtoNNParameterIndex::B]->GetData() = B;
 
@@ -112,9 +195,7 @@ namespace trainers
         if (-1.0 == _parameters.gamma)
         {
             auto gammaInit = 0.01;
-            math::ColumnMatrix<double> WXupdate(W.NumRows(), n);
-            math::MultiplyScaleAddUpdate(1.0, W, _X, 0.0, WXupdate);
-            _parameters.gamma = protonnInit.InitializeGamma(SimilarityKernel(_X, WXupdate, gammaInit), gammaInit);
+            _parameters.gamma = protonnInit.InitializeGamma(SimilarityKernel(_X, WX, gammaInit), gammaInit);
         }
 
         _stepSize[ProtoNNParameterIndex::W] = DefaultStepSize;
@@ -137,125 +218,82 @@ namespace trainers
     /// S_{ij} = exp{-gamma^2 * || B_j - W*x_i ||^2}
     /// where S_{ij} is similarity of ith input instance with the jth prototype B_j and W is the projection matrix
     /// Computed as exp(-gamma^2(||B||^2 + ||WX||^2 - 2 *  WX' * B))
-    math::ColumnMatrix<double> ProtoNNTrainer::SimilarityKernel(ConstColumnMatrixReference X, math::ColumnMatrixReference<double> WX, const double gamma, const size_t begin, const size_t end, bool recomputeWX)
+    math::ColumnMatrix<double> ProtoNNTrainer::SimilarityKernel(const ProtoNNInputMatrix& X, math::ColumnMatrixReference<double> WX, const double gamma, const size_t begin, const size_t end, bool recomputeWX) const
     {
         assert(begin < end);
-        auto B = (_modelMap[ProtoNNParameterIndex::B])->GetData();
-        auto W = (_modelMap[ProtoNNParameterIndex::W])->GetData();
+        const auto& B = _modelMap.at(ProtoNNParameterIndex::B)->GetData();
 
         auto wx = WX.GetSubMatrix(0, begin, WX.NumRows(), end - begin);
 
         // if W has changed, recompute WX
         if (true == recomputeWX)
         {
-            math::ColumnMatrix<double> wxUpdated(W.NumRows(), end - begin);
-            auto x = X.GetSubMatrix(0, begin, X.NumRows(), end - begin);
-            math::MultiplyScaleAddUpdate(1.0, W, x, 0.0, wxUpdated);
-            wx.CopyFrom(wxUpdated);
+            X.Project(_modelMap.at(ProtoNNParameterIndex::W)->GetData(), begin, end, wx);
         }
 
         // full(sum(B. ^ 2, 1));
-        math::ColumnMatrix<double> bSquare(B.NumRows(), B.NumColumns());
-        math::ElementwiseMultiplySet(B, B, bSquare);
-
-        math::ColumnMatrix<double> bColNormSquare(1, bSquare.NumColumns());
-        math::ColumnwiseSum(bSquare, bColNormSquare.GetRow(0));
+        math::RowVector<double> bColNormSquare(B.NumColumns());
+        for (size_t j = 0; j < B.NumColumns(); ++j)
+        {
+            bColNormSquare[j] = math::Sum(math::Square(math::AsExpression(B.GetColumn(j))));
+        }
 
         // full(sum(WX. ^ 2, 1));
-        math::ColumnMatrix<double> wxSquare(wx.NumRows(), wx.NumColumns());
-        math::ElementwiseMultiplySet(wx, wx, wxSquare);
-
-        math::ColumnMatrix<double> wxColNormSquare(1, wxSquare.NumColumns());
-        math::ColumnwiseSum(wxSquare, wxColNormSquare.GetRow(0));
+        math::ColumnVector<double> wxColNormSquare(wx.NumColumns());
+        for (size_t i = 0; i < wx.NumColumns(); ++i)
+        {
+            wxColNormSquare[i] = math::Sum(math::Square(math::AsExpression(wx.GetColumn(i))));
+        }
 
         // wxb = (2.0 * gamma * gamma) * WX.transpose() * B;
-        math::RowMatrix<double> wxb(wx.NumColumns(), B.NumColumns());
+        math::ColumnMatrix<double> wxb(wx.NumColumns(), B.NumColumns());
         math::MultiplyScaleAddUpdate(2 * gamma * gamma, wx.Transpose(), B, 0.0, wxb);
 
-        // repmat of bColNormSquare and scaling by -gamma * gamma
-        math::RowMatrix<double> gammaSquareCol(end - begin, 1);
-        gammaSquareCol.Fill(-gamma * gamma);
-        math::RowMatrix<double> bColNormSquareResized(gammaSquareCol.NumRows(), bColNormSquare.NumColumns());
-        // S1 = gammaSquareCol * bColSum;
-        math::MultiplyScaleAddUpdate(1.0, gammaSquareCol, bColNormSquare, 0.0, bColNormSquareResized);
-
-        // repmat of wxColNormSquare and scaling by -gamma * gamma
-        math::RowMatrix<double> gammaSquareRow(B.NumColumns(), 1);
-        gammaSquareRow.Fill(-gamma * gamma);
-        math::RowMatrix<double> wxColNormSquareResized(gammaSquareRow.NumRows(), wxColNormSquare.NumColumns());
-        // S2 = gammaSquareRow * wxColSum;
-        math::MultiplyScaleAddUpdate(1.0, gammaSquareRow, wxColNormSquare, 0.0, wxColNormSquareResized);
-
-        // D = wxb + bColNormSquareResized
-        math::RowMatrix<double> similarityMatrix(wxb.NumRows(), wxb.NumColumns());
-        math::ScaleAddSet(1.0, wxb, 1.0, bColNormSquareResized, similarityMatrix);
-
-        // D = D + wxColNormSquareResized'
-        math::RowMatrix<double> distance(similarityMatrix.NumRows(), similarityMatrix.NumColumns());
-        math::ScaleAddSet(1.0, similarityMatrix, 1.0, wxColNormSquareResized.Transpose(), distance);
-
-        // similarityMatrix = exp(D)
-        similarityMatrix = ProtoNNTrainerUtils::MatrixExp(distance);
+        // similarityMatrix = exp(wxb - gamma^2 * (repmat(bColNormSquare) + repmat(wxColNormSquare'))), in a single pass
+        const auto gammaSquare = gamma * gamma;
+        math::ColumnMatrix<double> similarityMatrix(wxb.NumRows(), wxb.NumColumns());
+        auto bNorms = math::RepeatRows(bColNormSquare, wxb.NumRows());
+        auto wxNorms = math::RepeatColumns(wxColNormSquare, wxb.NumColumns());
+        math::EvaluateSet(math::Exp(math::AsExpression(wxb) - gammaSquare * (bNorms + wxNorms)), similarityMatrix);
 
         return similarityMatrix;
     }
 
-    math::ColumnMatrix<double> ProtoNNTrainer::SimilarityKernel(ConstColumnMatrixReference X, math::ColumnMatrixReference<double> WX, const double gamma, bool recomputeWX)
+    math::ColumnMatrix<double> ProtoNNTrainer::SimilarityKernel(const ProtoNNInputMatrix& X, math::ColumnMatrixReference<double> WX, const double gamma, bool recomputeWX) const
     {
         return SimilarityKernel(X, WX, gamma, 0, X.NumColumns(), recomputeWX);
     }
 
-    double ProtoNNTrainer::Loss(ConstColumnMatrixReference Y, ConstColumnMatrixReference D, const size_t begin, const size_t end)
+    double ProtoNNTrainer::Loss(ConstColumnMatrixReference Y, ConstColumnMatrixReference D, const size_t begin, const size_t end) const
     {
         assert(end - begin == D.NumRows());
 
-        auto Z = (_modelMap[ProtoNNParameterIndex::Z])->GetData();
+        const auto& Z = _modelMap.at(ProtoNNParameterIndex::Z)->GetData();
 
         // residual = y - ZD'
         math::ColumnMatrix<double> ZD(Z.NumRows(), D.NumRows());
         math::MultiplyScaleAddUpdate(1.0, Z, D.Transpose(), 0.0, ZD);
         auto y = Y.GetSubMatrix(0, begin, Y.NumRows(), end - begin);
-        math::ColumnMatrix<double> residual(y.NumRows(), y.NumColumns());
-        math::ScaleAddSet(1.0, y, -1.0, ZD, residual);
 
+        // sum(residual .^ 2) or sum(residual .^ 4), without storing the residual
+        auto residual = math::AsExpression(y) - math::AsExpression(ZD);
         switch (_parameters.lossFunction)
         {
-        case ProtoNNLossFunction::L2:
-            for (size_t j = 0; j < residual.NumColumns(); j++)
-            {
-                // diff .* 2
-                residual.GetColumn(j).Transform([](double x) { return x * x; });
-            }
-            break;
         case ProtoNNLossFunction::L4:
-            for (size_t j = 0; j < residual.NumColumns(); j++)
-            {
-                // diff .* 4
-                residual.GetColumn(j).Transform([](double x) { return x * x * x * x; });
-            }
-            break;
-        }
-
-        auto loss = 0.0;
-
-        // Aggregate all the loss values
-        for (size_t j = 0; j < residual.NumColumns(); j++)
-        {
-            loss += residual.GetColumn(j).Aggregate([](double x) { return x; });
+            return math::Sum(math::Square(math::Square(residual)));
+        case ProtoNNLossFunction::L2:
+        default:
+            return math::Sum(math::Square(residual));
         }
-
-        return loss;
     }
 
-    double ProtoNNTrainer::Loss(ConstColumnMatrixReference Y, ConstColumnMatrixReference D)
+    double ProtoNNTrainer::Loss(ConstColumnMatrixReference Y, ConstColumnMatrixReference D) const
     {
         return Loss(Y, D, 0, Y.NumColumns());
     }
 
-    double ProtoNNTrainer::ComputeObjective(ConstColumnMatrixReference X, ConstColumnMatrixReference Y, math::ColumnMatrixReference<double> WX, double gamma, bool recomputeWX)
+    double ProtoNNTrainer::ComputeObjective(const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, math::ColumnMatrixReference<double> WX, double gamma, bool recomputeWX)
     {
-        double objective = 0.0;
-
         size_t n = X.NumColumns();
         size_t maxBatchSize = (size_t)std::ceil(std::sqrt(n));
 
@@ -264,9 +302,9 @@ namespace trainers
         size_t batchSize = maxBatchSize;
         size_t numBatches = (n + batchSize - 1) / batchSize;
 
-        // Aggregate loss over the batches
-        for (size_t i = 0; i < numBatches; ++i)
-        {
+        // Compute the loss of each batch separately, so the total doesn't depend on the number of threads
+        std::vector<double> batchLosses(numBatches);
+        utilities::ParallelFor(numBatches, GetNumThreads(), [&](size_t i) {
             size_t idx1 = (i * batchSize) % n;
             size_t idx2 = ((i + 1) * (batchSize) % n);
             if (idx2 <= idx1) idx2 = n;
@@ -277,12 +315,57 @@ namespace trainers
             auto D = SimilarityKernel(X, WX, gamma, idx1, idx2, recomputeWX);
             auto y = Y.GetSubMatrix(0, idx1, Y.NumRows(), idx2 - idx1);
 
-            objective += Loss(y, D);
+            batchLosses[i] = Loss(y, D);
+        });
+
+        // Aggregate loss over the batches
+        double objective = 0.0;
+        for (auto loss : batchLosses)
+        {
+            objective += loss;
         }
 
         return objective;
     }
 
+    math::ColumnMatrix<double> ProtoNNTrainer::ComputeGradient(ProtoNNParameterIndex parameterIndex, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, math::ColumnMatrixReference<double> WX, double gamma, size_t begin, size_t end)
+    {
+        const auto& parameter = *_modelMap.at(parameterIndex);
+        auto recomputeWX = _recomputeWX.at(parameterIndex);
+
+        // The gradient is a sum over the examples, so each thread takes a contiguous piece of the batch
+        auto numPieces = std::max(std::min(GetNumThreads(), (end - begin) / MinExamplesPerThread), size_t{ 1 });
+        std::vector<math::ColumnMatrix<double>> pieceGradients(numPieces, math::ColumnMatrix<double>(0, 0));
+        utilities::ParallelFor(numPieces, GetNumThreads(), [&](size_t pieceIndex) {
+            auto pieceBegin = begin + (end - begin) * pieceIndex / numPieces;
+            auto pieceEnd = begin + (end - begin) * (pieceIndex + 1) / numPieces;
+            auto D = SimilarityKernel(X, WX, gamma, pieceBegin, pieceEnd, recomputeWX);
+            pieceGradients[pieceIndex] = parameter.gradient(_modelMap, X, Y, WX, D, gamma, pieceBegin, pieceEnd, _parameters.lossFunction);
+        });
+
+        for (size_t pieceIndex = 1; pieceIndex < numPieces; ++pieceIndex)
+        {
+            pieceGradients[0] += pieceGradients[pieceIndex];
+        }
+        return std::move(pieceGradients[0]);
+    }
+
+    void ProtoNNTrainer::ProjectInputs(const ProtoNNInputMatrix& X, math::ColumnMatrixReference<double> WX)
+    {
+        const auto& W = _modelMap.at(m_projectionIndex)->GetData();
+        auto n = X.NumColumns();
+        utilities::ParallelFor((n + ProjectionBlockSize - 1) / ProjectionBlockSize, GetNumThreads(), [&](size_t blockIndex) {
+            auto begin = blockIndex * ProjectionBlockSize;
+            auto end = std::min(begin + ProjectionBlockSize, n);
+            X.Project(W, begin, end, WX.GetSubMatrix(0, begin, WX.NumRows(), end - begin));
+        });
+    }
+
+    size_t ProtoNNTrainer::GetNumThreads() const
+    {
+        return utilities::GetNumThreads(_parameters.numThreads);
+    }
+
     //See https://blogs.princeton.edu/imabandit/2013/04/01/acceleratedgradientdescent/ for the accelerated gradient_paramS descent version we use
     //We use stochastic version of the above algorithm
     //paramQ_new[t+1]=paramS[t]-stepSize*gradient_paramS(paramS[t]) //gradient_paramS descent update
@@ -347,29 +430,22 @@ namespace trainers
             gradient_paramS = gradf(paramS, idx1, idx2);
 
             math::ColumnMatrix<double> paramQ_new(paramS.NumRows(), paramS.NumColumns());
-            math::ScaleAddSet(1.0, paramS, -stepSize, gradient_paramS, paramQ_new); //paramQ_new=paramS-stepSize*grad(paramS)
+            math::EvaluateSet(math::AsExpression(paramS) - stepSize * math::AsExpression(gradient_paramS), paramQ_new); //paramQ_new=paramS-stepSize*grad(paramS)
 
             prox(paramQ_new); //paramQ_new = HardThresholding(paramQ_new)
 
-            math::ColumnMatrix<double> paramS_new(paramQ_new.NumRows(), paramQ_new.NumColumns());
-            math::ScaleAddSet(1 - alpha, paramQ_new, alpha, paramQ, paramS_new);
-
-            // paramS_new = (1-alpha)*paramQ_new+alpha*paramQ; paramS=paramS_new
-            paramS.CopyFrom(paramS_new);
+            // paramS = (1-alpha)*paramQ_new+alpha*paramQ
+            math::EvaluateSet((1 - alpha) * math::AsExpression(paramQ_new) + alpha * math::AsExpression(paramQ), paramS);
 
             double runningAvgWeight = ((t - burn_period) > 1) ? (t - burn_period) : 1.0; //runningAvgWeight
             assert(runningAvgWeight >= 0.999999);
 
-            //Running average of all but first burn_period paramS's; paramAvg_new=(1-1/runningAvgWeight)*paramAvg+ 1/runningAvgWeight*paramS_new
-            math::ColumnMatrix<double> paramAvg_new(paramS_new.NumRows(), paramS_new.NumColumns());
-            math::ScaleAddSet(safe_div(1.0, runningAvgWeight), paramS_new, safe_div(runningAvgWeight - 1.0, runningAvgWeight), paramAvg, paramAvg_new);
+            //Running average of all but first burn_period paramS's; paramAvg=(1-1/runningAvgWeight)*paramAvg+ 1/runningAvgWeight*paramS
+            math::EvaluateSet(safe_div(1.0, runningAvgWeight) * math::AsExpression(paramS) + safe_div(runningAvgWeight - 1.0, runningAvgWeight) * math::AsExpression(paramAvg), paramAvg);
 
             //Initializing parameters for next iteration
             lambda = lambda_new;
             paramQ = paramQ_new;
-
-            paramS.CopyFrom(paramS_new);
-            paramAvg.CopyFrom(paramAvg_new);
         }
 
         param.CopyFrom(paramAvg);
@@ -379,13 +455,13 @@ namespace trainers
     }
 
     //minimize f(W, B, Z) = \sum_{i = 1} ^ numTrainData Loss(Y[i], Z* D[i]) where D[i][j] = exp(-gamma^2 || B[j]-WX[i] || ^ 2) where j = 1:numPrototypes
-    void ProtoNNTrainer::SGDWithAlternatingMinimization(ConstColumnMatrixReference X, ConstColumnMatrixReference Y, double gamma, size_t iter)
+    void ProtoNNTrainer::SGDWithAlternatingMinimization(const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, double gamma, size_t iter)
     {
         // Start Initializations
         size_t n = X.NumColumns(); //numTrainPoints
         size_t epochs = _parameters.numInnerIterations; // number of SGD iterations(epochs) over each of the parameters
 
-        size_t sgdBatchSize = 1 << 8 < n ? 1 << 8 : n; //expose to user parameter structure, default is sqrt(n)
+        size_t sgdBatchSize = std::min(_parameters.batchSize == 0 ? DefaultBatchSize : _parameters.batchSize, n);
 
         double armijoStepTolerance = ArmijoStepTolerance;
 
@@ -397,9 +473,8 @@ namespace trainers
         double fOld, fCur, paramStepSize;
 
         //Projection onto low-d space
-        auto projectionMatrix = _modelMap[m_projectionIndex]->GetData();
-        math::ColumnMatrix<double> WX(projectionMatrix.NumRows(), n);
-        math::MultiplyScaleAddUpdate(1.0, projectionMatrix, X, 0.0, WX);
+        math::ColumnMatrix<double> WX(_modelMap[m_projectionIndex]->GetData().NumRows(), n);
+        ProjectInputs(X, WX);
 
         fCur = ComputeObjective(X, Y, WX, gamma, false);
 
@@ -426,7 +501,7 @@ namespace trainers
                 if (idx2 <= idx1) idx2 = n;
 
                 // gradient_paramS at current parameter
-                currentGradient = _modelMap[parameterIndex]->gradient(_modelMap, X, Y, WX, SimilarityKernel(X, WX, gamma, idx1, idx2, _recomputeWX[parameterIndex]), gamma, idx1, idx2, _parameters.lossFunction);
+                currentGradient = ComputeGradient(parameterIndex, X, Y, WX, gamma, idx1, idx2);
 
                 math::ColumnMatrix<double> thresholdedGradient(parameterMatrix.NumRows(), parameterMatrix.NumColumns());
 
@@ -440,21 +515,22 @@ namespace trainers
                 math::ColumnMatrix<double> perturbedParameter(parameterMatrix.NumRows(), parameterMatrix.NumColumns());
                 math::ScaleAddSet(1.0, parameterMatrix, -1.0 * coeff, thresholdedGradient, perturbedParameter);
 
-                auto WX_old = WX;
+                // Only the batch's projections change with the perturbed parameter, so only they need restoring
+                auto wxBatch = WX.GetSubMatrix(0, idx1, WX.NumRows(), idx2 - idx1);
+                math::ColumnMatrix<double> wxBatchOld(wxBatch.NumRows(), wxBatch.NumColumns());
+                wxBatchOld.CopyFrom(wxBatch);
                 _modelMap[parameterIndex]->GetData() = perturbedParameter;
 
                 // Compute gradient_paramS with updated parameter
-                math::MultiplyScaleAddUpdate(1.0, _modelMap[m_projectionIndex]->GetData(), X, 0.0, WX);
-
                 math::ColumnMatrix<double> gradientEstimate(parameterMatrix.NumRows(), parameterMatrix.NumColumns());
-                auto grad = _modelMap[parameterIndex]->gradient(_modelMap, X, Y, WX, SimilarityKernel(X, WX, gamma, idx1, idx2, _recomputeWX[parameterIndex]), gamma, idx1, idx2, _parameters.lossFunction);
+                auto grad = ComputeGradient(parameterIndex, X, Y, WX, gamma, idx1, idx2);
                 math::ScaleAddSet(1.0, currentGradient, -1.0, grad, gradientEstimate);
 
                 currentGradient = gradientEstimate;
 
                 // revert the old parameter value and projected input
                 _modelMap[parameterIndex]->GetData() = parameterMatrix;
-                WX = WX_old;
+                wxBatch.CopyFrom(wxBatchOld);
 
                 if (ProtoNNTrainerUtils::MatrixNorm(currentGradient) <= 1e-20L)
                 {
@@ -476,11 +552,12 @@ namespace trainers
             paramStepSize = _stepSize[parameterIndex] * etaVector[4];
 
             // Call the accelerated proximal gradient_paramS method for optimizing this parameter
-            AcceleratedProximalGradient(parameterIndex, [&](ConstColumnMatrixReference /*W*/, const size_t begin, const size_t end) -> math::ColumnMatrix<double> { return _modelMap[parameterIndex]->gradient(_modelMap, X, Y, WX, SimilarityKernel(X, WX, gamma, begin, end, _recomputeWX[parameterIndex]), gamma, begin, end, _parameters.lossFunction); }, [&](auto arg) { ProtoNNTrainerUtils::HardThresholding(arg, _sparsity[parameterIndex]); }, parameterMatrix, epochs, n, sgdBatchSize, paramStepSize, eta_update);
+            AcceleratedProximalGradient(parameterIndex, [&](ConstColumnMatrixReference /*W*/, const size_t begin, const size_t end) -> math::ColumnMatrix<double> { return ComputeGradient(parameterIndex, X, Y, WX, gamma, begin, end); }, [&](auto arg) { ProtoNNTrainerUtils::HardThresholding(arg, _sparsity[parameterIndex]); }, parameterMatrix, epochs, n, sgdBatchSize, paramStepSize, eta_update);
 
-            math::MultiplyScaleAddUpdate(1.0, _modelMap[m_projectionIndex]->GetData(), X, 0.0, WX);
+            // WX is brought up to date here, so the objective doesn't need to recompute it
+            ProjectInputs(X, WX);
             fOld = fCur;
-            fCur = ComputeObjective(X, Y, WX, gamma, _recomputeWX[parameterIndex]);
+            fCur = ComputeObjective(X, Y, WX, gamma, false);
 
             // Armijo step
             // If function value has increased, decrease the step size else increase
@@ -508,14 +585,13 @@ namespace trainers
     {
     }
 
-    math::ColumnMatrix<double> Param_W::gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType)
+    math::ColumnMatrix<double> Param_W::gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) const
     {
-        UNUSED(WX);
         assert(end - begin == D.NumRows());
 
-        auto W = modelMap[ProtoNNParameterIndex::W]->GetData();
-        auto B = modelMap[ProtoNNParameterIndex::B]->GetData();
-        auto Z = modelMap[ProtoNNParameterIndex::Z]->GetData();
+        const auto& W = modelMap.at(ProtoNNParameterIndex::W)->GetData();
+        const auto& B = modelMap.at(ProtoNNParameterIndex::B)->GetData();
+        const auto& Z = modelMap.at(ProtoNNParameterIndex::Z)->GetData();
 
         auto y = Y.GetSubMatrix(0, begin, Y.NumRows(), end - begin).Transpose();
 
@@ -556,9 +632,8 @@ namespace trainers
         math::ColumnMatrix<double> colMult(1, T.NumRows());
         math::ColumnwiseSum(T.Transpose(), colMult.GetRow(0));
 
-        auto xSub = X.GetSubMatrix(0, begin, X.NumRows(), end - begin);
         math::ColumnMatrix<double> wxScaled(W.NumRows(), end - begin);
-        math::MultiplyScaleAddUpdate(1.0, W, xSub, 0.0, wxScaled);
+        wxScaled.CopyFrom(WX.GetSubMatrix(0, begin, WX.NumRows(), end - begin));
 
         for (size_t j = 0; j < wxScaled.NumColumns(); j++)
         {
@@ -571,12 +646,12 @@ namespace trainers
 
         // gradient_paramS -= wx_scaled * x_submat'
         math::ColumnMatrix<double> gradient(W.NumRows(), W.NumColumns());
-        math::MultiplyScaleAddUpdate(1.0, wxScaled, xSub.Transpose(), 0.0, gradient);
+        X.MultiplyTransposeAdd(wxScaled, begin, end, gradient);
 
         return gradient;
     }
 
-    math::ColumnMatrix<double> Param_W::gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType)
+    math::ColumnMatrix<double> Param_W::gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) const
     {
         return gradient(modelMap, X, Y, WX, D, gamma, 0, Y.NumColumns(), lossType);
     }
@@ -586,13 +661,13 @@ namespace trainers
     {
     }
 
-    math::ColumnMatrix<double> Param_Z::gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference Similarity, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType)
+    math::ColumnMatrix<double> Param_Z::gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference Similarity, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) const
     {
         UNUSED(X, WX, gamma);
 
         assert(end - begin == Similarity.NumRows());
 
-        auto Z = modelMap[ProtoNNParameterIndex::Z]->GetData();
+        const auto& Z = modelMap.at(ProtoNNParameterIndex::Z)->GetData();
 
         auto y = Y.GetSubMatrix(0, begin, Y.NumRows(), end - begin);
 
@@ -625,7 +700,7 @@ namespace trainers
         return gradient;
     }
 
-    math::ColumnMatrix<double> Param_Z::gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType)
+    math::ColumnMatrix<double> Param_Z::gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) const
     {
         return gradient(modelMap, X, Y, WX, D, gamma, 0, Y.NumColumns(), lossType);
     }
@@ -635,13 +710,13 @@ namespace trainers
     {
     }
 
-    math::ColumnMatrix<double> Param_B::gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference Similarity, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType)
+    math::ColumnMatrix<double> Param_B::gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference Similarity, double gamma, size_t begin, size_t end, ProtoNNLossFunction lossType) const
     {
         UNUSED(X, WX);
         assert(end - begin == Similarity.NumRows());
 
-        auto B = modelMap[ProtoNNParameterIndex::B]->GetData();
-        auto Z = modelMap[ProtoNNParameterIndex::Z]->GetData();
+        const auto& B = modelMap.at(ProtoNNParameterIndex::B)->GetData();
+        const auto& Z = modelMap.at(ProtoNNParameterIndex::Z)->GetData();
 
         auto y = Y.GetSubMatrix(0, begin, Y.NumRows(), end - begin).Transpose();
         auto wx = WX.GetSubMatrix(0, begin, WX.NumRows(), end - begin);
@@ -702,7 +777,7 @@ namespace trainers
         return gradient;
     }
 
-    math::ColumnMatrix<double> Param_B::gradient(ProtoNNModelMap& modelMap, ConstColumnMatrixReference X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType)
+    math::ColumnMatrix<double> Param_B::gradient(const ProtoNNModelMap& modelMap, const ProtoNNInputMatrix& X, ConstColumnMatrixReference Y, ConstColumnMatrixReference WX, ConstColumnMatrixReference D, double gamma, ProtoNNLossFunction lossType) const
     {
         return gradient(modelMap, X, Y, WX, D, gamma, 0, Y.NumColumns(), lossType);
     }
@@ -8,24 +8,52 @@
 
 #include "SGDTrainer.h"
 
+#include <utility>
+
 namespace ell
 {
 namespace trainers
 {
-
     void SGDTrainerBase::SetDataset(const data::AnyDataset& anyDataset)
     {
+        _dataset.Reset();
+        _sharedDataset = nullptr;
+        _permutation.clear();
+
+        _streamingDataset = anyDataset.GetStreamingDataset<data::AutoSupervisedExample>();
+        if (_streamingDataset != nullptr)
+        {
+            return;
+        }
+
+        _sharedDataset = anyDataset.GetDataset<data::AutoSupervisedExample>();
+        if (_sharedDataset != nullptr)
+        {
+            return;
+        }
         _dataset = data::Dataset<data::AutoSupervisedExample>(anyDataset);
     }
 
     void SGDTrainerBase::Update()
     {
-        // permute the data
-        _dataset.RandomPermute(_random);
+        if (_streamingDataset != nullptr)
+        {
+            auto exampleIterator = _streamingDataset->GetShuffledExampleIterator(_random);
+            Update(exampleIterator);
+            return;
+        }
 
-        // get example iterator
-        auto exampleIterator = _dataset.GetExampleReferenceIterator();
+        // permute the indices rather than the examples, which may be shared with the caller
+        const auto& dataset = _sharedDataset != nullptr ? *_sharedDataset : _dataset;
+        dataset.RandomPermute(_random, _permutation);
 
+        auto exampleIterator = dataset.GetPermutedExampleReferenceIterator(_permutation);
+        Update(exampleIterator);
+    }
+
+    template <typename ExampleIteratorType>
+    void SGDTrainerBase::Update(ExampleIteratorType& exampleIterator)
+    {
         // first iteration handled separately
         if (_firstIteration && exampleIterator.IsValid())
         {
@@ -8,6 +8,8 @@
 
 #include "ThresholdFinder.h"
 
+#include <utilities/include/ParallelFor.h>
+
 #include <algorithm>
 #include <functional>
 #include <vector>
@@ -16,6 +18,25 @@ namespace ell
 {
 namespace trainers
 {
+    ThresholdFinder::ThresholdFinder(size_t numThreads) :
+        _numThreads(utilities::GetNumThreads(numThreads))
+    {
+    }
+
+    void ThresholdFinder::SortReduceFeatures(std::vector<std::vector<ValueWeight>>& weightedValues, size_t numExamples) const
+    {
+        // below this much work, starting the threads costs more than it saves
+        const size_t minWorkPerThread = 1 << 16;
+        auto numFeatures = weightedValues.size();
+        auto numThreads = std::max(std::min({ _numThreads, numFeatures, numFeatures * numExamples / minWorkPerThread }), size_t{ 1 });
+
+        // each thread sorts a contiguous block of features
+        utilities::ParallelFor(numFeatures, numThreads, [&weightedValues, this](size_t j) {
+            auto newSize = SortReduceCopy(weightedValues[j].begin(), weightedValues[j].end());
+            weightedValues[j].resize(newSize);
+        });
+    }
+
     size_t ThresholdFinder::SortReduceCopy(std::vector<ValueWeight>::iterator begin, const std::vector<ValueWeight>::iterator end) const
     {
         // sort the values
@@ -8,16 +8,37 @@
 
 #include <data/include/Dataset.h>
 
+#include <evaluators/include/Evaluator.h>
+#include <evaluators/include/LossAggregator.h>
+
 #include <functions/include/L2Regularizer.h>
 #include <functions/include/LogLoss.h>
 #include <functions/include/SquaredLoss.h>
 
+#include <trainers/include/AllReduce.h>
+#include <trainers/include/BinnedForestTrainer.h>
+#include <trainers/include/DistributedTrainer.h>
+#include <trainers/include/HistogramForestTrainer.h>
+#include <trainers/include/KMeansTrainer.h>
+#include <trainers/include/LogitBooster.h>
 #include <trainers/include/MeanCalculator.h>
+#include <trainers/include/ProtoNNTrainer.h>
 #include <trainers/include/SDCATrainer.h>
 #include <trainers/include/SGDTrainer.h>
+#include <trainers/include/SortingForestTrainer.h>
+#include <trainers/include/SweepingTrainer.h>
+#include <trainers/include/ThresholdFinder.h>
 
 #include <testing/include/testing.h>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
 using namespace ell;
 
 /// Runs all tests
@@ -59,6 +80,67 @@ void TestSDCATrainer()
     return;
 }
 
+void TestSDCATrainerWarmStart()
+{
+    std::default_random_engine random(97);
+    std::normal_distribution<double> normal(0, 1);
+    const size_t numOldExamples = 400;
+    const size_t numNewExamples = 20;
+    data::AutoSupervisedDataset oldDataset;
+    data::AutoSupervisedDataset dataset;
+    for (size_t i = 0; i < numOldExamples + numNewExamples; ++i)
+    {
+        std::vector<double> features(10);
+        for (auto& feature : features)
+        {
+            feature = normal(random);
+        }
+        double label = features[0] - features[1] + 0.5 * normal(random) > 0 ? 1.0 : -1.0;
+        data::AutoSupervisedExample example(data::AutoDataVector(features), { 1.0, label });
+        if (i < numOldExamples)
+        {
+            oldDataset.AddExample(example);
+        }
+        dataset.AddExample(example);
+    }
+
+    using TrainerType = trainers::SDCATrainer<functions::LogLoss, functions::L2Regularizer>;
+    trainers::SDCATrainerParameters parameters{ 1.0e-2, 1.0e-6, 1000, true, "ABC" };
+    auto train = [&parameters](TrainerType& trainer) {
+        size_t numEpochs = 0;
+        auto info = trainer.GetPredictorInfo();
+        while (numEpochs < parameters.maxEpochs && std::abs(info.primalObjective - info.dualObjective) > parameters.desiredPrecision)
+        {
+            trainer.Update();
+            info = trainer.GetPredictorInfo();
+            ++numEpochs;
+        }
+        return numEpochs;
+    };
+
+    TrainerType oldTrainer(functions::LogLoss(), functions::L2Regularizer(), parameters);
+    oldTrainer.SetDataset(oldDataset.GetAnyDataset());
+    oldTrainer.Update();
+    train(oldTrainer);
+
+    // the old examples come first, so their dual variables are a prefix of the new ones
+    auto dualVariables = oldTrainer.GetDualVariables();
+    dualVariables.resize(dataset.NumExamples(), 0.0);
+
+    TrainerType coldTrainer(functions::LogLoss(), functions::L2Regularizer(), parameters);
+    coldTrainer.SetDataset(dataset.GetAnyDataset());
+    coldTrainer.Update();
+    auto coldEpochs = train(coldTrainer) + 1;
+
+    TrainerType warmTrainer(functions::LogLoss(), functions::L2Regularizer(), parameters);
+    warmTrainer.SetDataset(dataset.GetAnyDataset());
+    warmTrainer.SetDualVariables(dualVariables);
+    auto warmEpochs = train(warmTrainer);
+
+    testing::ProcessTest("TestSDCATrainerWarmStart, fewer epochs", warmEpochs < coldEpochs);
+    testing::ProcessTest("TestSDCATrainerWarmStart, same objective", testing::IsEqual(warmTrainer.GetPredictorInfo().primalObjective, coldTrainer.GetPredictorInfo().primalObjective, 1.0e-5));
+}
+
 void TestSGDTrainer()
 {
     data::AutoSupervisedDataset dataset;
@@ -117,6 +199,376 @@ void TestSGDTrainer()
     return;
 }
 
+void TestSweepingTrainer()
+{
+    data::AutoSupervisedDataset dataset;
+    std::default_random_engine randomEngine(123);
+    std::normal_distribution<double> normal(0, 1);
+    for (size_t i = 0; i < 500; ++i)
+    {
+        std::vector<double> x = { normal(randomEngine), normal(randomEngine), normal(randomEngine) };
+        double label = 2 * x[0] - x[1] + 0.1 * normal(randomEngine);
+        dataset.AddExample({ x, { 1.0, label } });
+    }
+
+    using PredictorType = predictors::LinearPredictor<double>;
+    std::vector<double> regularization = { 1, 4, 100, 10000 };
+    std::vector<std::shared_ptr<evaluators::IEvaluator<PredictorType>>> evaluators;
+    std::vector<trainers::EvaluatingTrainer<PredictorType>> evaluatingTrainers;
+    for (auto lambda : regularization)
+    {
+        evaluators.push_back(evaluators::MakeEvaluator<PredictorType>(dataset.GetAnyDataset(), { 1, false }, evaluators::MakeLossAggregator(functions::SquaredLoss())));
+        evaluatingTrainers.push_back(trainers::MakeEvaluatingTrainer(trainers::MakeSGDTrainer(functions::SquaredLoss(), { lambda, "XYZ" }), evaluators.back()));
+    }
+
+    trainers::SweepingTrainer<PredictorType> trainer(std::move(evaluatingTrainers), { 4, 2.0 });
+    trainer.SetDataset(dataset.GetAnyDataset());
+    for (size_t epoch = 0; epoch < 10; ++epoch)
+    {
+        trainer.Update();
+    }
+
+    double bestLoss = evaluators[0]->GetGoodness();
+    for (const auto& evaluator : evaluators)
+    {
+        bestLoss = std::min(bestLoss, evaluator->GetGoodness());
+    }
+
+    functions::SquaredLoss lossFunction;
+    double loss = 0;
+    for (size_t i = 0; i < dataset.NumExamples(); ++i)
+    {
+        loss += lossFunction(trainer.GetPredictor().Predict(dataset[i].GetDataVector()), dataset[i].GetMetadata().label);
+    }
+    loss /= dataset.NumExamples();
+
+    // the strongly regularized trainers fit the data poorly and are dropped
+    testing::ProcessTest("TestSweepingTrainer, early termination", trainer.NumActiveTrainers() == 2);
+    testing::ProcessTest("TestSweepingTrainer, best predictor", testing::IsEqual(loss, bestLoss, 1.0e-8));
+}
+
+void TestSortingForestTrainer()
+{
+    // large enough for the split search to run on several threads
+    const size_t numExamples = 4096;
+    const size_t numFeatures = 64;
+    std::default_random_engine random(1234);
+    std::uniform_real_distribution<double> distribution(0, 1);
+    data::AutoSupervisedDataset dataset;
+    for (size_t i = 0; i < numExamples; ++i)
+    {
+        std::vector<double> features(numFeatures);
+        for (auto& feature : features)
+        {
+            feature = distribution(random);
+        }
+        double label = features[3] + features[17] > 1.0 ? 1.0 : -1.0;
+        dataset.AddExample({ data::AutoDataVector(features), { 1.0, label } });
+    }
+
+    auto train = [&dataset](size_t numThreads) {
+        trainers::SortingForestTrainerParameters parameters;
+        parameters.minSplitGain = 0.0;
+        parameters.maxSplitsPerRound = 4;
+        parameters.numRounds = 3;
+        parameters.numThreads = numThreads;
+        auto trainer = trainers::MakeSortingForestTrainer(functions::SquaredLoss(), trainers::LogitBooster(), parameters);
+        trainer->SetDataset(dataset.GetAnyDataset());
+        trainer->Update();
+        return trainer->GetPredictor();
+    };
+    auto predictor1 = train(1);
+    auto predictor4 = train(4);
+
+    bool samePredictions = true;
+    size_t numErrors = 0;
+    for (size_t i = 0; i < dataset.NumExamples(); ++i)
+    {
+        auto dataVector = dataset[i].GetDataVector().CopyAs<data::FloatDataVector>();
+        auto prediction = predictor1.Predict(dataVector);
+        samePredictions = samePredictions && prediction == predictor4.Predict(dataVector);
+        if (prediction * dataset[i].GetMetadata().label <= 0)
+        {
+            ++numErrors;
+        }
+    }
+
+    testing::ProcessTest("TestSortingForestTrainer, same forest on 1 and 4 threads", samePredictions && predictor1.NumTrees() == predictor4.NumTrees());
+    testing::ProcessTest("TestSortingForestTrainer, training error", numErrors < numExamples / 10);
+}
+
+void TestBinnedForestTrainer()
+{
+    // each feature takes fewer distinct values than there are bins, so the binned trainer finds the same splits as the sorting trainer
+    const size_t numExamples = 4096;
+    const size_t numFeatures = 32;
+    std::default_random_engine random(4321);
+    std::uniform_int_distribution<int> distribution(1, 50);
+    data::AutoSupervisedDataset dataset;
+    for (size_t i = 0; i < numExamples; ++i)
+    {
+        std::vector<double> features(numFeatures);
+        for (auto& feature : features)
+        {
+            feature = distribution(random) / 50.0;
+        }
+        double label = features[5] - features[11] > 0.1 ? 1.0 : -1.0;
+        dataset.AddExample({ data::AutoDataVector(features), { 1.0, label } });
+    }
+
+    trainers::BinnedForestTrainerParameters binnedParameters;
+    binnedParameters.maxSplitsPerRound = 6;
+    binnedParameters.numRounds = 3;
+    auto binnedTrainer = trainers::MakeBinnedForestTrainer(functions::SquaredLoss(), trainers::LogitBooster(), binnedParameters);
+    binnedTrainer->SetDataset(dataset.GetAnyDataset());
+    binnedTrainer->Update();
+
+    trainers::SortingForestTrainerParameters sortingParameters;
+    sortingParameters.maxSplitsPerRound = 6;
+    sortingParameters.numRounds = 3;
+    auto sortingTrainer = trainers::MakeSortingForestTrainer(functions::SquaredLoss(), trainers::LogitBooster(), sortingParameters);
+    sortingTrainer->SetDataset(dataset.GetAnyDataset());
+    sortingTrainer->Update();
+
+    const auto& binnedPredictor = binnedTrainer->GetPredictor();
+    const auto& sortingPredictor = sortingTrainer->GetPredictor();
+    double maxDifference = 0;
+    size_t numErrors = 0;
+    for (size_t i = 0; i < dataset.NumExamples(); ++i)
+    {
+        auto dataVector = dataset[i].GetDataVector().CopyAs<data::FloatDataVector>();
+        auto prediction = binnedPredictor.Predict(dataVector);
+        maxDifference = std::max(maxDifference, std::abs(prediction - sortingPredictor.Predict(dataVector)));
+        if (prediction * dataset[i].GetMetadata().label <= 0)
+        {
+            ++numErrors;
+        }
+    }
+
+    testing::ProcessTest("TestBinnedForestTrainer, same forest as the sorting trainer", maxDifference < 1e-8);
+    testing::ProcessTest("TestBinnedForestTrainer, training error", numErrors < numExamples / 10);
+}
+
+void TestHistogramForestTrainer()
+{
+    // enough features and sampled examples for the threshold finder to sort the features on several threads
+    const size_t numExamples = 1024;
+    const size_t numFeatures = 128;
+    std::default_random_engine random(2468);
+    std::uniform_int_distribution<int> distribution(1, 16);
+    data::AutoSupervisedDataset dataset;
+    for (size_t i = 0; i < numExamples; ++i)
+    {
+        std::vector<double> features(numFeatures);
+        for (auto& feature : features)
+        {
+            feature = distribution(random) / 16.0;
+        }
+        double label = features[7] + features[42] > 1.0 ? 1.0 : -1.0;
+        dataset.AddExample({ data::AutoDataVector(features), { 1.0, label } });
+    }
+
+    auto train = [&dataset](size_t numThresholdFinderThreads) {
+        trainers::HistogramForestTrainerParameters parameters;
+        parameters.maxSplitsPerRound = 1;
+        parameters.numRounds = 2;
+        parameters.randomSeed = "1357";
+        parameters.thresholdFinderSampleSize = numExamples;
+        parameters.candidatesPerInput = 1;
+        auto trainer = trainers::MakeHistogramForestTrainer(functions::SquaredLoss(), trainers::LogitBooster(), trainers::ExhaustiveThresholdFinder(numThresholdFinderThreads), parameters);
+        trainer->SetDataset(dataset.GetAnyDataset());
+        trainer->Update();
+        return trainer->GetPredictor();
+    };
+    auto predictor1 = train(1);
+    auto predictor2 = train(2);
+
+    bool samePredictions = true;
+    for (size_t i = 0; i < dataset.NumExamples(); ++i)
+    {
+        auto dataVector = dataset[i].GetDataVector().CopyAs<data::FloatDataVector>();
+        samePredictions = samePredictions && predictor1.Predict(dataVector) == predictor2.Predict(dataVector);
+    }
+
+    testing::ProcessTest("TestHistogramForestTrainer, same forest with 1 and 2 threshold finder threads", samePredictions && predictor1.NumTrees() == 2 && predictor2.NumTrees() == 2);
+}
+
+void TestKMeansTrainer()
+{
+    // three well separated clusters in the plane
+    std::vector<std::vector<double>> centers = { { 0.0, 0.0 }, { 10.0, 0.0 }, { 0.0, 10.0 } };
+    size_t pointsPerCluster = 1000;
+    math::ColumnMatrix<double> points(2, centers.size() * pointsPerCluster);
+    std::default_random_engine randomEngine(123);
+    std::normal_distribution<double> normal(0, 1);
+    for (size_t i = 0; i < points.NumColumns(); ++i)
+    {
+        const auto& center = centers[i % centers.size()];
+        points(0, i) = center[0] + normal(randomEngine);
+        points(1, i) = center[1] + normal(randomEngine);
+    }
+
+    // each true center has to be close to one of the means
+    auto isCloseToCenters = [&](const math::ColumnMatrix<double>& means) {
+        for (const auto& center : centers)
+        {
+            double minDistance = std::numeric_limits<double>::max();
+            for (size_t j = 0; j < means.NumColumns(); ++j)
+            {
+                minDistance = std::min(minDistance, std::hypot(means(0, j) - center[0], means(1, j) - center[1]));
+            }
+            if (minDistance > 0.2)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    trainers::KMeansTrainer kMeans1(2, centers.size(), 20, { 0, 1 });
+    kMeans1.RunKMeans(points);
+    trainers::KMeansTrainer kMeans4(2, centers.size(), 20, { 0, 4 });
+    kMeans4.RunKMeans(points);
+    trainers::KMeansTrainer miniBatchKMeans(2, centers.size(), 100, { 100, 4 });
+    miniBatchKMeans.RunKMeans(points);
+
+    testing::ProcessTest("TestKMeansTrainer, finds the clusters", isCloseToCenters(kMeans1.GetClusterMeans()));
+    testing::ProcessTest("TestKMeansTrainer, same result on 1 and 4 threads", kMeans1.GetClusterAssignment() == kMeans4.GetClusterAssignment() && kMeans1.GetClusterMeans().IsEqual(kMeans4.GetClusterMeans(), 1.0e-10));
+    testing::ProcessTest("TestKMeansTrainer, mini-batch finds the clusters", isCloseToCenters(miniBatchKMeans.GetClusterMeans()));
+}
+
+void TestProtoNNTrainer()
+{
+    // three classes in a high-dimensional space, each with its own few nonzero features
+    const size_t numFeatures = 300;
+    const size_t numLabels = 3;
+    const size_t featuresPerLabel = 5;
+    const size_t numExamples = 900;
+    std::default_random_engine random(1234);
+    std::uniform_real_distribution<double> distribution(0.5, 1.5);
+    data::AutoSupervisedDataset dataset;
+    for (size_t i = 0; i < numExamples; ++i)
+    {
+        auto label = i % numLabels;
+        std::vector<data::IndexValue> features;
+        for (size_t j = 0; j < featuresPerLabel; ++j)
+        {
+            features.push_back({ 7 * (label * featuresPerLabel + j), distribution(random) });
+        }
+        dataset.AddExample({ data::AutoDataVector(features), { 1.0, static_cast<double>(label) } });
+    }
+
+    auto train = [&](size_t numThreads) {
+        trainers::ProtoNNTrainerParameters parameters{ numFeatures, numLabels, 5, 2, 1.0, 1.0, 1.0, -1.0, trainers::ProtoNNLossFunction::L2, 10, 1, false };
+        parameters.batchSize = 128;
+        parameters.numThreads = numThreads;
+        trainers::ProtoNNTrainer trainer(parameters);
+        trainer.SetDataset(dataset.GetAnyDataset());
+        for (size_t iteration = 0; iteration < parameters.numIterations; ++iteration)
+        {
+            trainer.Update();
+        }
+        return trainer.GetPredictor();
+    };
+
+    auto countErrors = [&](const predictors::ProtoNNPredictor& predictor) {
+        size_t numErrors = 0;
+        for (size_t i = 0; i < dataset.NumExamples(); ++i)
+        {
+            auto scores = predictor.Predict(dataset[i].GetDataVector().ToArray(numFeatures));
+            auto prediction = std::max_element(scores.GetDataPointer(), scores.GetDataPointer() + scores.Size()) - scores.GetDataPointer();
+            if (prediction != static_cast<int>(dataset[i].GetMetadata().label))
+            {
+                ++numErrors;
+            }
+        }
+        return numErrors;
+    };
+
+    testing::ProcessTest("TestProtoNNTrainer, training error on 1 thread", countErrors(train(1)) < numExamples / 20);
+    testing::ProcessTest("TestProtoNNTrainer, training error on 4 threads", countErrors(train(4)) < numExamples / 20);
+}
+
+void TestDistributedTrainers()
+{
+    // four shards of a linearly separable dataset, one with fewer examples than the others
+    const size_t numShards = 4;
+    std::default_random_engine random(31);
+    std::normal_distribution<double> normal(0, 1);
+    data::AutoSupervisedDataset dataset;
+    std::vector<data::AutoSupervisedDataset> shards(numShards);
+    for (size_t i = 0; i < 350; ++i)
+    {
+        std::vector<double> features(8);
+        for (auto& feature : features)
+        {
+            feature = normal(random);
+        }
+        double label = 2 * features[0] - features[3] + features[5] > 0 ? 1.0 : -1.0;
+        data::AutoSupervisedExample example(data::AutoDataVector(features), { 1.0, label });
+        dataset.AddExample(example);
+        shards[i % numShards].AddExample(example);
+    }
+
+    using PredictorType = predictors::LinearPredictor<double>;
+    auto train = [&](std::function<std::unique_ptr<trainers::ITrainer<PredictorType>>()> makeTrainer) {
+        trainers::LocalAllReduceGroup group(numShards);
+        std::vector<PredictorType> predictors(numShards);
+        std::vector<std::thread> threads;
+        for (size_t rank = 0; rank < numShards; ++rank)
+        {
+            threads.emplace_back([&, rank] {
+                trainers::DistributedTrainer<PredictorType> trainer(makeTrainer(), group.GetProcess(rank), { 2 });
+                trainer.SetDataset(shards[rank].GetAnyDataset());
+                for (int epoch = 0; epoch < 10; ++epoch)
+                {
+                    trainer.Update();
+                }
+                predictors[rank] = trainer.GetPredictor();
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        return predictors;
+    };
+
+    auto isSynchronized = [](const std::vector<PredictorType>& predictors) {
+        for (const auto& predictor : predictors)
+        {
+            if (predictor.GetWeights() != predictors[0].GetWeights() || predictor.GetBias() != predictors[0].GetBias())
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto countErrors = [&](const PredictorType& predictor) {
+        size_t numErrors = 0;
+        for (size_t i = 0; i < dataset.NumExamples(); ++i)
+        {
+            if (predictor.Predict(dataset[i].GetDataVector()) * dataset[i].GetMetadata().label <= 0)
+            {
+                ++numErrors;
+            }
+        }
+        return numErrors;
+    };
+
+    auto sgdPredictors = train([] { return trainers::MakeSGDTrainer(functions::LogLoss(), { 1.0e-3, "ABC" }); });
+    auto sparseSGDPredictors = train([] { return trainers::MakeSparseDataSGDTrainer(functions::LogLoss(), { 1.0e-3, "ABC" }); });
+    auto sdcaPredictors = train([] { return trainers::MakeSDCATrainer(functions::LogLoss(), functions::L2Regularizer(), { 1.0e-3, 1.0e-8, 10, false, "ABC" }); });
+
+    testing::ProcessTest("TestDistributedTrainers, SGD predictors are synchronized", isSynchronized(sgdPredictors));
+    testing::ProcessTest("TestDistributedTrainers, SGD training error", countErrors(sgdPredictors[0]) < dataset.NumExamples() / 20);
+    testing::ProcessTest("TestDistributedTrainers, sparse data SGD predictors are synchronized", isSynchronized(sparseSGDPredictors));
+    testing::ProcessTest("TestDistributedTrainers, sparse data SGD training error", countErrors(sparseSGDPredictors[0]) < dataset.NumExamples() / 20);
+    testing::ProcessTest("TestDistributedTrainers, SDCA predictors are synchronized", isSynchronized(sdcaPredictors));
+    testing::ProcessTest("TestDistributedTrainers, SDCA training error", countErrors(sdcaPredictors[0]) < dataset.NumExamples() / 20);
+}
+
 void TestMeanCalculator()
 {
     data::AutoSupervisedDataset dataset;
@@ -134,6 +586,14 @@ void TestMeanCalculator()
 int main()
 {
     TestSDCATrainer();
+    TestSDCATrainerWarmStart();
     TestSGDTrainer();
+    TestSweepingTrainer();
+    TestSortingForestTrainer();
+    TestBinnedForestTrainer();
+    TestHistogramForestTrainer();
+    TestKMeansTrainer();
+    TestProtoNNTrainer();
+    TestDistributedTrainers();
     TestMeanCalculator();
 }
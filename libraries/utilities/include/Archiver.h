@@ -548,7 +548,8 @@ namespace utilities
     /// <summary> A class that manages stream precision for
     /// floating point numbers, ensuring that maximum precision is
     /// set after the constructor, and reset to its previous values
-    /// when it goes out of scope.
+    /// when it goes out of scope. Maximum precision is enough digits
+    /// for every value to read back exactly.
     /// </summary>
     template <typename ValueType>
     class EnsureMaxPrecision
@@ -964,7 +965,7 @@ namespace utilities
         _precision(out.precision()),
         _out(out)
     {
-        _out.precision(std::numeric_limits<ValueType>::digits10 + 1);
+        _out.precision(std::numeric_limits<ValueType>::max_digits10);
     }
 
     template <typename ValueType>
@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     Arena.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ell
+{
+namespace utilities
+{
+    /// <summary>
+    /// A memory arena, which hands out memory from large chunks and frees all of it at once, when it is
+    /// destroyed. Many small objects that live as long as each other can be allocated from an arena with
+    /// one heap allocation per chunk, and end up next to each other in memory. The arena is not thread safe.
+    /// </summary>
+    class Arena
+    {
+    public:
+        /// <summary> Constructs an empty arena. </summary>
+        ///
+        /// <param name="chunkSize"> The size of the chunks that memory is allocated from. </param>
+        Arena(size_t chunkSize = 1 << 20);
+
+        Arena(const Arena&) = delete;
+
+        Arena& operator=(const Arena&) = delete;
+
+        /// <summary> Allocates memory from the arena. The memory is freed when the arena is destroyed. </summary>
+        ///
+        /// <param name="size"> The number of bytes to allocate. </param>
+        /// <param name="alignment"> The alignment of the memory, which must be a power of two. </param>
+        ///
+        /// <returns> Pointer to the memory. </returns>
+        void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        /// <summary> Returns the number of bytes allocated from the arena. </summary>
+        ///
+        /// <returns> The number of bytes. </returns>
+        size_t GetAllocatedSize() const { return _allocatedSize; }
+
+        /// <summary> Returns the number of chunks that the arena has allocated from the heap. </summary>
+        ///
+        /// <returns> The number of chunks. </returns>
+        size_t NumChunks() const { return _chunks.size(); }
+
+    private:
+        std::vector<std::unique_ptr<char[]>> _chunks;
+        char* _current = nullptr;
+        char* _end = nullptr;
+        size_t _chunkSize;
+        size_t _allocatedSize = 0;
+    };
+
+    /// <summary>
+    /// A standard library allocator that allocates from an Arena and never frees. It holds a shared
+    /// pointer to the arena, so that containers and std::allocate_shared objects keep their arena alive.
+    /// </summary>
+    ///
+    /// <typeparam name="ValueType"> The type of the allocated objects. </typeparam>
+    template <typename ValueType>
+    class ArenaAllocator
+    {
+    public:
+        using value_type = ValueType;
+
+        /// <summary> Constructs an allocator for an arena. </summary>
+        ///
+        /// <param name="arena"> The arena. </param>
+        ArenaAllocator(std::shared_ptr<Arena> arena) :
+            _arena(std::move(arena)) {}
+
+        /// <summary> Constructs an allocator that allocates from the same arena as another allocator. </summary>
+        ///
+        /// <param name="other"> The other allocator. </param>
+        template <typename OtherValueType>
+        ArenaAllocator(const ArenaAllocator<OtherValueType>& other) :
+            _arena(other.GetArena()) {}
+
+        /// <summary> Allocates memory for an array of objects. </summary>
+        ///
+        /// <param name="count"> The number of objects. </param>
+        ///
+        /// <returns> Pointer to the memory. </returns>
+        ValueType* allocate(size_t count) { return static_cast<ValueType*>(_arena->Allocate(count * sizeof(ValueType), alignof(ValueType))); }
+
+        /// <summary> Does nothing, because arena memory is freed when the arena is destroyed. </summary>
+        void deallocate(ValueType*, size_t) {}
+
+        /// <summary> Gets the arena. </summary>
+        ///
+        /// <returns> The arena. </returns>
+        const std::shared_ptr<Arena>& GetArena() const { return _arena; }
+
+    private:
+        std::shared_ptr<Arena> _arena;
+    };
+
+    template <typename ValueType1, typename ValueType2>
+    bool operator==(const ArenaAllocator<ValueType1>& a, const ArenaAllocator<ValueType2>& b)
+    {
+        return a.GetArena() == b.GetArena();
+    }
+
+    template <typename ValueType1, typename ValueType2>
+    bool operator!=(const ArenaAllocator<ValueType1>& a, const ArenaAllocator<ValueType2>& b)
+    {
+        return !(a == b);
+    }
+} // namespace utilities
+} // namespace ell
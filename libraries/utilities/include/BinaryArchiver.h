@@ -0,0 +1,385 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BinaryArchiver.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Archiver.h"
+#include "Exception.h"
+#include "MemoryMappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ell
+{
+namespace utilities
+{
+    /// <summary> Definitions shared by BinaryArchiver and BinaryUnarchiver </summary>
+    namespace BinaryArchiverImpl
+    {
+        /// <summary> The first bytes of a binary archive </summary>
+        constexpr char fileSignature[] = { 'E', 'L', 'L', 'B' };
+
+        /// <summary> The version of the binary format written by BinaryArchiver </summary>
+        constexpr uint32_t formatVersion = 1;
+
+        /// <summary> Written in the header, so archives from a machine with a different byte order are rejected </summary>
+        constexpr uint32_t byteOrderMark = 0x01020304;
+
+        /// <summary> The alignment, relative to the start of the archive, of the data of numeric arrays </summary>
+        constexpr size_t arrayAlignment = 64;
+
+        /// <summary> The kinds of record in a binary archive </summary>
+        enum class RecordType : uint8_t
+        {
+            scalar = 1,
+            string,
+            null,
+            array,
+            stringArray,
+            objectArray,
+            object,
+            endObject,
+            primitiveObject
+        };
+
+        /// <summary> The kinds of fundamental value, which are stored with their size </summary>
+        enum class ValueKind : uint8_t
+        {
+            boolean = 1,
+            signedInteger,
+            unsignedInteger,
+            floatingPoint
+        };
+
+        template <typename ValueType>
+        constexpr ValueKind GetValueKind()
+        {
+            if constexpr (std::is_same_v<ValueType, bool>)
+            {
+                return ValueKind::boolean;
+            }
+            else if constexpr (std::is_floating_point_v<ValueType>)
+            {
+                return ValueKind::floatingPoint;
+            }
+            else if constexpr (std::is_signed_v<ValueType>)
+            {
+                return ValueKind::signedInteger;
+            }
+            else
+            {
+                return ValueKind::unsignedInteger;
+            }
+        }
+    } // namespace BinaryArchiverImpl
+
+    /// <summary>
+    /// An archiver that encodes data in a compact binary format. Numbers are stored in the machine's byte order,
+    /// and the data of numeric arrays is stored as raw blocks aligned to 64 bytes from the start of the archive, so
+    /// reading them back is a copy rather than a parse.
+    /// </summary>
+    class BinaryArchiver : public Archiver
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="outputStream"> The stream to write data to. It should be opened in binary mode. </param>
+        BinaryArchiver(std::ostream& outputStream);
+
+    protected:
+#define ARCHIVE_TYPE_OP(t) DECLARE_ARCHIVE_VALUE_OVERRIDE(t);
+        ARCHIVABLE_TYPES_LIST
+#undef ARCHIVE_TYPE_OP
+
+        void ArchiveValue(const char* name, const std::string& value) override;
+
+#define ARCHIVE_TYPE_OP(t) DECLARE_ARCHIVE_ARRAY_OVERRIDE(t);
+        ARCHIVABLE_TYPES_LIST
+#undef ARCHIVE_TYPE_OP
+
+        void ArchiveNull(const char* name) override;
+
+        void ArchiveArray(const char* name, const std::vector<std::string>& array) override;
+        void ArchiveArray(const char* name, const std::string& baseTypeName, const std::vector<const IArchivable*>& array) override;
+
+        void BeginArchiveObject(const char* name, const IArchivable& value) override;
+        void EndArchiveObject(const char* name, const IArchivable& value) override;
+
+        void EndArchiving() override;
+
+    private:
+        template <typename ValueType, IsFundamental<ValueType> concept = 0>
+        void WriteScalar(const char* name, const ValueType& value);
+
+        void WriteScalar(const char* name, const std::string& value);
+
+        template <typename ValueType>
+        void WriteArray(const char* name, const std::vector<ValueType>& array);
+
+        void WriteArray(const char* name, const std::vector<std::string>& array);
+
+        void WriteRecordHeader(BinaryArchiverImpl::RecordType type, const char* name);
+        void WriteString(const std::string& value);
+        void WritePadding(size_t alignment);
+        void WriteBytes(const void* data, size_t size);
+
+        template <typename ValueType>
+        void WriteRaw(const ValueType& value)
+        {
+            WriteBytes(&value, sizeof(ValueType));
+        }
+
+        std::ostream& _out;
+        size_t _offset = 0;
+    };
+
+    /// <summary>
+    /// An unarchiver that reads data written by BinaryArchiver. The archive is read from memory: either a
+    /// memory-mapped file, so only the pages in use are resident, or a buffer filled from a stream.
+    /// </summary>
+    class BinaryUnarchiver : public Unarchiver
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="inputStream"> The stream to read data from. It should be opened in binary mode. </param>
+        /// <param name="context"> The serialization context. </param>
+        BinaryUnarchiver(std::istream& inputStream, SerializationContext context);
+
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="file"> The memory-mapped archive. It must outlive the unarchiver. </param>
+        /// <param name="context"> The serialization context. </param>
+        BinaryUnarchiver(const MemoryMappedFile& file, SerializationContext context);
+
+        /// <summary> Indicates if a property with the given name is available to be read next </summary>
+        ///
+        /// <param name="name"> The name of the property </param>
+        ///
+        /// <returns> true if a property with the given name can be read next </returns>
+        bool HasNextPropertyName(const std::string& name) override;
+
+        /// <summary> Indicates if the given data starts like a binary archive </summary>
+        ///
+        /// <param name="data"> The data </param>
+        /// <param name="size"> The number of bytes of data </param>
+        ///
+        /// <returns> true if the data starts with the binary archive signature </returns>
+        static bool IsBinaryArchive(const char* data, size_t size);
+
+    protected:
+#define ARCHIVE_TYPE_OP(t) DECLARE_UNARCHIVE_VALUE_OVERRIDE(t);
+        ARCHIVABLE_TYPES_LIST
+#undef ARCHIVE_TYPE_OP
+
+        void UnarchiveValue(const char* name, std::string& value) override;
+
+        bool UnarchiveNull(const char* name) override;
+
+#define ARCHIVE_TYPE_OP(t) DECLARE_UNARCHIVE_ARRAY_OVERRIDE(t);
+        ARCHIVABLE_TYPES_LIST
+#undef ARCHIVE_TYPE_OP
+
+        void UnarchiveArray(const char* name, std::vector<std::string>& array) override;
+
+        void BeginUnarchiveArray(const char* name, const std::string& typeName) override;
+        bool BeginUnarchiveArrayItem(const std::string& typeName) override;
+        void EndUnarchiveArrayItem(const std::string& typeName) override;
+        void EndUnarchiveArray(const char* name, const std::string& typeName) override;
+
+        ArchivedObjectInfo BeginUnarchiveObject(const char* name, const std::string& typeName) override;
+        void EndUnarchiveObject(const char* name, const std::string& typeName) override;
+        void UnarchiveObjectAsPrimitive(const char* name, IArchivable& value) override;
+
+    private:
+        template <typename ValueType, IsFundamental<ValueType> concept = 0>
+        void ReadScalar(const char* name, ValueType& value);
+
+        void ReadScalar(const char* name, std::string& value);
+
+        template <typename ValueType, IsFundamental<ValueType> concept = 0>
+        void ReadArray(const char* name, std::vector<ValueType>& array);
+
+        void ReadArray(const char* name, std::vector<std::string>& array);
+
+        void ReadFileHeader();
+        void MatchRecordHeader(BinaryArchiverImpl::RecordType type, const char* name);
+        bool TryMatchRecordHeader(BinaryArchiverImpl::RecordType type, const char* name);
+        std::string ReadString();
+        void SkipPadding(size_t alignment);
+        const char* ReadBytes(size_t size);
+
+        template <typename ValueType>
+        ValueType ReadRaw()
+        {
+            ValueType value;
+            std::memcpy(&value, ReadBytes(sizeof(ValueType)), sizeof(ValueType));
+            return value;
+        }
+
+        template <typename ValueType>
+        static ValueType ConvertValue(BinaryArchiverImpl::ValueKind kind, size_t size, const char* data);
+
+        std::string _buffer; // holds the archive when it is read from a stream
+        const char* _begin = nullptr;
+        const char* _end = nullptr;
+        const char* _position = nullptr;
+        std::vector<uint64_t> _remainingArrayItems;
+    };
+} // namespace utilities
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace utilities
+{
+    //
+    // Serialization
+    //
+    template <typename ValueType, IsFundamental<ValueType> concept>
+    void BinaryArchiver::WriteScalar(const char* name, const ValueType& value)
+    {
+        using namespace BinaryArchiverImpl;
+        WriteRecordHeader(RecordType::scalar, name);
+        WriteRaw(GetValueKind<ValueType>());
+        WriteRaw(static_cast<uint8_t>(sizeof(ValueType)));
+        WriteRaw(value);
+    }
+
+    template <typename ValueType>
+    void BinaryArchiver::WriteArray(const char* name, const std::vector<ValueType>& array)
+    {
+        using namespace BinaryArchiverImpl;
+        WriteRecordHeader(RecordType::array, name);
+        WriteRaw(GetValueKind<ValueType>());
+        WriteRaw(static_cast<uint8_t>(sizeof(ValueType)));
+        WriteRaw(static_cast<uint64_t>(array.size()));
+        WritePadding(arrayAlignment);
+        if constexpr (std::is_same_v<ValueType, bool>)
+        {
+            // std::vector<bool> isn't contiguous
+            for (bool value : array)
+            {
+                WriteRaw(value);
+            }
+        }
+        else
+        {
+            WriteBytes(array.data(), array.size() * sizeof(ValueType));
+        }
+    }
+
+    //
+    // Deserialization
+    //
+    template <typename ValueType>
+    ValueType BinaryUnarchiver::ConvertValue(BinaryArchiverImpl::ValueKind kind, size_t size, const char* data)
+    {
+        using namespace BinaryArchiverImpl;
+        auto convert = [data](auto archivedValue) {
+            std::memcpy(&archivedValue, data, sizeof(archivedValue));
+            return static_cast<ValueType>(archivedValue);
+        };
+
+        switch (kind)
+        {
+        case ValueKind::boolean:
+            return convert(bool{});
+        case ValueKind::signedInteger:
+            switch (size)
+            {
+            case 1:
+                return convert(int8_t{});
+            case 2:
+                return convert(int16_t{});
+            case 4:
+                return convert(int32_t{});
+            case 8:
+                return convert(int64_t{});
+            }
+            break;
+        case ValueKind::unsignedInteger:
+            switch (size)
+            {
+            case 1:
+                return convert(uint8_t{});
+            case 2:
+                return convert(uint16_t{});
+            case 4:
+                return convert(uint32_t{});
+            case 8:
+                return convert(uint64_t{});
+            }
+            break;
+        case ValueKind::floatingPoint:
+            switch (size)
+            {
+            case 4:
+                return convert(float{});
+            case 8:
+                return convert(double{});
+            }
+            break;
+        }
+        throw DataFormatException(DataFormatErrors::badFormat, "Binary archive contains a value of an unknown type");
+    }
+
+    template <typename ValueType, IsFundamental<ValueType> concept>
+    void BinaryUnarchiver::ReadScalar(const char* name, ValueType& value)
+    {
+        using namespace BinaryArchiverImpl;
+        MatchRecordHeader(RecordType::scalar, name);
+        auto kind = ReadRaw<ValueKind>();
+        auto size = ReadRaw<uint8_t>();
+        value = ConvertValue<ValueType>(kind, size, ReadBytes(size));
+    }
+
+    template <typename ValueType, IsFundamental<ValueType> concept>
+    void BinaryUnarchiver::ReadArray(const char* name, std::vector<ValueType>& array)
+    {
+        using namespace BinaryArchiverImpl;
+        MatchRecordHeader(RecordType::array, name);
+        auto kind = ReadRaw<ValueKind>();
+        auto size = ReadRaw<uint8_t>();
+        auto count = ReadRaw<uint64_t>();
+        SkipPadding(arrayAlignment);
+        if (size == 0 || count > static_cast<uint64_t>(_end - _position) / size)
+        {
+            throw DataFormatException(DataFormatErrors::badFormat, "Binary archive array runs past the end of the archive");
+        }
+
+        const char* data = ReadBytes(count * size);
+        array.resize(count);
+        if constexpr (!std::is_same_v<ValueType, bool>)
+        {
+            if (kind == GetValueKind<ValueType>() && size == sizeof(ValueType))
+            {
+                std::memcpy(array.data(), data, count * size);
+                return;
+            }
+        }
+
+        for (uint64_t index = 0; index < count; ++index)
+        {
+            array[index] = ConvertValue<ValueType>(kind, size, data + index * size);
+        }
+    }
+} // namespace utilities
+} // namespace ell
+
+#pragma endregion implementation
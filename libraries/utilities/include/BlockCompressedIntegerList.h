@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BlockCompressedIntegerList.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ell
+{
+namespace utilities
+{
+    /// <summary>
+    /// A non-decreasing list of nonnegative integers smaller than 2^32, with a forward Iterator, stored in a
+    /// block delta encoding. The deltas are grouped in fours, and each group has a control byte that gives the
+    /// number of bytes (1 to 4) of each of its deltas. The control bytes and the delta bytes are kept in separate
+    /// arrays, so a whole group can be decoded at once, with a single byte shuffle on x86 CPUs with SSSE3. This
+    /// takes about as much space as CompressedIntegerList, but is much faster to read.
+    /// </summary>
+    class BlockCompressedIntegerList
+    {
+    public:
+        /// <summary> The number of entries that share a control byte. </summary>
+        static constexpr size_t groupSize = 4;
+
+        /// <summary> A read-only forward iterator for the BlockCompressedIntegerList. </summary>
+        class Iterator
+        {
+        public:
+            Iterator() = default;
+
+            Iterator(const Iterator&) = default;
+
+            Iterator(Iterator&&) = default;
+
+            /// <summary> Query if this object input stream valid. </summary>
+            ///
+            /// <returns> true if it succeeds, false if it fails. </returns>
+            bool IsValid() const { return _groupIndex < _groupCount; }
+
+            /// <summary> Proceeds to the Next iterate. </summary>
+            void Next()
+            {
+                if (++_groupIndex == _groupCount)
+                {
+                    DecodeNextGroup();
+                }
+            }
+
+            /// <summary> Returns the value of the current iterate. </summary>
+            ///
+            /// <returns> An size_t. </returns>
+            size_t Get() const { return _group[_groupIndex]; }
+
+            /// <summary> Copies the current iterate and the ones after it into an array, and proceeds past them. </summary>
+            ///
+            /// <param name="buffer"> The array. </param>
+            /// <param name="count"> The size of the array. </param>
+            ///
+            /// <returns> The number of entries copied, which is less than `count` only at the end of the list. </returns>
+            size_t Read(size_t* buffer, size_t count);
+
+        private:
+            // private ctor, can only be called from BlockCompressedIntegerList class
+            Iterator(const uint8_t* controls, const uint8_t* data, const uint8_t* dataEnd, size_t size);
+            friend class BlockCompressedIntegerList;
+
+            void DecodeNextGroup();
+
+            // members
+            const uint8_t* _controls = nullptr;
+            const uint8_t* _data = nullptr;
+            const uint8_t* _dataEnd = nullptr;
+            size_t _remaining = 0;
+            uint32_t _previous = 0;
+            uint32_t _group[groupSize] = {};
+            size_t _groupIndex = 0;
+            size_t _groupCount = 0;
+        };
+
+        /// <summary> Default Constructor. Constructs an empty list. </summary>
+        BlockCompressedIntegerList() = default;
+
+        BlockCompressedIntegerList(BlockCompressedIntegerList&& other) = default;
+
+        BlockCompressedIntegerList(const BlockCompressedIntegerList&) = default;
+
+        ~BlockCompressedIntegerList() = default;
+
+        void operator=(const BlockCompressedIntegerList&) = delete;
+
+        /// <summary> Returns The number of entries in the list. </summary>
+        ///
+        /// <returns> An size_t. </returns>
+        size_t Size() const { return _size; }
+
+        /// <summary> Allocates a specified number of entires to the list. </summary>
+        ///
+        /// <param name="size"> The size. </param>
+        void Reserve(size_t size);
+
+        /// <summary> Returns The maximal integer in the list. </summary>
+        ///
+        /// <returns> The maximum value. </returns>
+        size_t Max() const;
+
+        /// <summary> Appends an integer to the end of the list. </summary>
+        ///
+        /// <param name="value"> The value, which must be bigger than the last one and smaller than 2^32. </param>
+        void Append(size_t value);
+
+        /// <summary> Deletes all of the std::vector content and sets its Size to zero. </summary>
+        void Reset();
+
+        /// <summary> Returns an `Iterator` that points to the beginning of the list. </summary>
+        ///
+        /// <returns> The iterator. </returns>
+        Iterator GetIterator() const { return Iterator(_controls.data(), _data.data(), _data.data() + _data.size(), _size); }
+
+    private:
+        std::vector<uint8_t> _controls;
+        std::vector<uint8_t> _data;
+        uint32_t _last = 0;
+        size_t _size = 0;
+    };
+} // namespace utilities
+} // namespace ell
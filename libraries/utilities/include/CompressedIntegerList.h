@@ -44,6 +44,14 @@ namespace utilities
             /// <returns> An size_t. </returns>
             size_t Get() const { return _value; }
 
+            /// <summary> Copies the current iterate and the ones after it into an array, and proceeds past them. </summary>
+            ///
+            /// <param name="buffer"> The array. </param>
+            /// <param name="count"> The size of the array. </param>
+            ///
+            /// <returns> The number of entries copied, which is less than `count` only at the end of the list. </returns>
+            size_t Read(size_t* buffer, size_t count);
+
         private:
             // private ctor, can only be called from CompressedIntegerList class
             Iterator(const uint8_t* iter, const uint8_t* end);
@@ -59,6 +67,14 @@ namespace utilities
         /// <summary> Default Constructor. Constructs an empty list. </summary>
         CompressedIntegerList();
 
+        /// <summary> Constructs a list from its encoded representation, as returned by GetEncodedData(). </summary>
+        ///
+        /// <param name="begin"> Pointer to the first byte of the encoded list. </param>
+        /// <param name="end"> Pointer just past the last byte of the encoded list. </param>
+        /// <param name="size"> The number of entries in the list. </param>
+        /// <param name="max"> The maximal (last) integer in the list, ignored if the list is empty. </param>
+        CompressedIntegerList(const uint8_t* begin, const uint8_t* end, size_t size, size_t max);
+
         CompressedIntegerList(CompressedIntegerList&& other) = default;
 
         CompressedIntegerList(const CompressedIntegerList&) = default;
@@ -95,6 +111,11 @@ namespace utilities
         /// <returns> The iterator. </returns>
         Iterator GetIterator() const { return Iterator(_data.data(), _data.data() + _data.size()); }
 
+        /// <summary> Returns the encoded representation of the list. </summary>
+        ///
+        /// <returns> The delta encoded bytes. </returns>
+        const std::vector<uint8_t>& GetEncodedData() const { return _data; }
+
     private:
         std::vector<uint8_t> _data;
         size_t _last;
@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ConcurrentRingBuffer.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Exception.h"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace ell
+{
+namespace utilities
+{
+    /// <summary> A fixed-capacity, lock-free queue for one producer thread and one consumer thread. The slots are
+    /// allocated once, and are filled and drained in place with `BeginPush`/`EndPush` and `BeginPop`/`EndPop`, so
+    /// large items (like the frames passed between the stages of a pipeline) are never copied or reallocated. </summary>
+    template <typename T>
+    class ConcurrentRingBuffer
+    {
+    public:
+        /// <summary> Constructor </summary>
+        ///
+        /// <param name="capacity"> The number of slots, which must be at least one. </param>
+        /// <param name="value"> The value each slot is initialized with. </param>
+        ConcurrentRingBuffer(size_t capacity, const T& value = T{});
+
+        ConcurrentRingBuffer(const ConcurrentRingBuffer&) = delete;
+        ConcurrentRingBuffer& operator=(const ConcurrentRingBuffer&) = delete;
+
+        /// <summary> Gets the number of slots. </summary>
+        size_t Capacity() const { return _slots.size(); }
+
+        /// <summary> Gets the number of items in the queue. Only a snapshot, unless called from the producer or consumer
+        /// thread while the other is idle. </summary>
+        size_t Size() const;
+
+        /// <summary> Gets the next free slot for the producer to fill. Must be followed by `EndPush` to publish it. </summary>
+        ///
+        /// <returns> The slot, or nullptr if the queue is full. </returns>
+        T* BeginPush();
+
+        /// <summary> Publishes the slot returned by the last `BeginPush` to the consumer. </summary>
+        void EndPush();
+
+        /// <summary> Gets the oldest item for the consumer to read. Must be followed by `EndPop` to free its slot. </summary>
+        ///
+        /// <returns> The item, or nullptr if the queue is empty. </returns>
+        T* BeginPop();
+
+        /// <summary> Frees the slot returned by the last `BeginPop` for the producer to reuse. </summary>
+        void EndPop();
+
+        /// <summary> Copies an item into the queue, if there's room. Producer thread only. </summary>
+        ///
+        /// <returns> true if the item was added, false if the queue is full. </returns>
+        bool TryPush(const T& value);
+
+        /// <summary> Copies the oldest item out of the queue, if there is one. Consumer thread only. </summary>
+        ///
+        /// <returns> true if an item was removed, false if the queue is empty. </returns>
+        bool TryPop(T& value);
+
+    private:
+        static constexpr size_t CacheLineSize = 64;
+
+        std::vector<T> _slots;
+
+        // The total number of items pushed and popped, each written by only one side, on separate cache lines
+        alignas(CacheLineSize) std::atomic<size_t> _pushCount{ 0 };
+        alignas(CacheLineSize) std::atomic<size_t> _popCount{ 0 };
+    };
+} // namespace utilities
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace utilities
+{
+    template <typename T>
+    ConcurrentRingBuffer<T>::ConcurrentRingBuffer(size_t capacity, const T& value) :
+        _slots(capacity, value)
+    {
+        if (capacity == 0)
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "ConcurrentRingBuffer needs at least one slot");
+        }
+    }
+
+    template <typename T>
+    size_t ConcurrentRingBuffer<T>::Size() const
+    {
+        auto popCount = _popCount.load(std::memory_order_acquire);
+        return _pushCount.load(std::memory_order_acquire) - popCount;
+    }
+
+    template <typename T>
+    T* ConcurrentRingBuffer<T>::BeginPush()
+    {
+        auto pushCount = _pushCount.load(std::memory_order_relaxed);
+        if (pushCount - _popCount.load(std::memory_order_acquire) == Capacity())
+        {
+            return nullptr;
+        }
+        return &_slots[pushCount % Capacity()];
+    }
+
+    template <typename T>
+    void ConcurrentRingBuffer<T>::EndPush()
+    {
+        _pushCount.store(_pushCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    template <typename T>
+    T* ConcurrentRingBuffer<T>::BeginPop()
+    {
+        auto popCount = _popCount.load(std::memory_order_relaxed);
+        if (_pushCount.load(std::memory_order_acquire) == popCount)
+        {
+            return nullptr;
+        }
+        return &_slots[popCount % Capacity()];
+    }
+
+    template <typename T>
+    void ConcurrentRingBuffer<T>::EndPop()
+    {
+        _popCount.store(_popCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    template <typename T>
+    bool ConcurrentRingBuffer<T>::TryPush(const T& value)
+    {
+        auto slot = BeginPush();
+        if (slot == nullptr)
+        {
+            return false;
+        }
+        *slot = value;
+        EndPush();
+        return true;
+    }
+
+    template <typename T>
+    bool ConcurrentRingBuffer<T>::TryPop(T& value)
+    {
+        auto slot = BeginPop();
+        if (slot == nullptr)
+        {
+            return false;
+        }
+        value = *slot;
+        EndPop();
+        return true;
+    }
+} // namespace utilities
+} // namespace ell
+
+#pragma endregion implementation
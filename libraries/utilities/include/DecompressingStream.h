@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DecompressingStream.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MemoryMappedFile.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ell
+{
+namespace utilities
+{
+    /// <summary> The compression formats of files that can be read as if they were uncompressed. </summary>
+    enum class CompressionFormat
+    {
+        none,
+        gzip,
+        zstd
+    };
+
+    /// <summary> Gets the compression format of some data, from its first bytes. </summary>
+    ///
+    /// <param name="begin"> Pointer to the first byte of the data. </param>
+    /// <param name="end"> Pointer just past the last byte of the data. </param>
+    ///
+    /// <returns> The compression format, or `none` if the data isn't compressed in a known format. </returns>
+    CompressionFormat GetCompressionFormat(const char* begin, const char* end);
+
+    /// <summary> Gets the compression format of a file, from its first bytes. </summary>
+    ///
+    /// <param name="filepath"> The path. </param>
+    ///
+    /// <returns> The compression format, or `none` if the file isn't compressed in a known format. </returns>
+    CompressionFormat GetFileCompressionFormat(const std::string& filepath);
+
+    /// <summary> Indicates if ELL was built with the library that decompresses a format (zlib for gzip, libzstd for zstd). </summary>
+    bool IsCompressionFormatAvailable(CompressionFormat format);
+
+    /// <summary>
+    /// A stream buffer with the decompressed contents of a gzip or zstd file, which is decompressed on background
+    /// threads while the reader parses the data decompressed so far. A zstd file made of several frames (like the
+    /// ones `pzstd` or `zstd --block-size` write) has its frames decompressed on several threads at once; other
+    /// files are decompressed sequentially on one background thread. The buffer can only seek forward.
+    /// </summary>
+    class DecompressingStreamBuffer : public std::streambuf
+    {
+    public:
+        /// <summary> Opens a compressed file, and throws an exception if it can't be read or decompressed. </summary>
+        ///
+        /// <param name="filepath"> The path. </param>
+        /// <param name="numThreads"> The number of threads that decompress the frames of a zstd file, zero to use one per core. </param>
+        DecompressingStreamBuffer(const std::string& filepath, size_t numThreads = 0);
+
+        DecompressingStreamBuffer(const DecompressingStreamBuffer&) = delete;
+        DecompressingStreamBuffer& operator=(const DecompressingStreamBuffer&) = delete;
+
+        ~DecompressingStreamBuffer() override;
+
+    protected:
+        int_type underflow() override;
+        pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override;
+        pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+
+    private:
+        void Decompress();
+        void DecompressGzip();
+        void DecompressZstd();
+        void DecompressZstdFrameStream(const char* frame, size_t frameSize);
+        bool PushChunk(std::vector<char> chunk);
+        bool NextChunk();
+
+        MemoryMappedFile _file;
+        CompressionFormat _format;
+        size_t _numThreads;
+
+        // The chunks decompressed ahead of the reader
+        std::mutex _mutex;
+        std::condition_variable _chunksChanged;
+        std::deque<std::vector<char>> _chunks;
+        size_t _maxQueuedChunks;
+        bool _isFinished = false;
+        bool _isStopping = false;
+        std::exception_ptr _error;
+        std::thread _thread;
+
+        // The chunk being read, and its offset in the decompressed data
+        std::vector<char> _currentChunk;
+        std::streamoff _currentChunkOffset = 0;
+    };
+
+    /// <summary> An input stream with the decompressed contents of a gzip or zstd file (see `DecompressingStreamBuffer`). </summary>
+    class DecompressingIfstream : public std::istream
+    {
+    public:
+        /// <summary> Opens a compressed file, and throws an exception if it can't be read. Errors found while decompressing it are thrown by the reads. </summary>
+        ///
+        /// <param name="filepath"> The path. </param>
+        /// <param name="numThreads"> The number of threads that decompress the frames of a zstd file, zero to use one per core. </param>
+        DecompressingIfstream(const std::string& filepath, size_t numThreads = 0);
+
+    private:
+        std::unique_ptr<DecompressingStreamBuffer> _buffer;
+    };
+
+    /// <summary>
+    /// Opens a file for reading, and throws an exception if a problem occurs. A gzip or zstd compressed file (found
+    /// from its contents, not its name) is decompressed as it's read, without temporary files.
+    /// </summary>
+    ///
+    /// <param name="filepath"> The path. </param>
+    /// <param name="numThreads"> The number of threads that decompress the frames of a zstd file, zero to use one per core. </param>
+    ///
+    /// <returns> The stream. </returns>
+    std::unique_ptr<std::istream> OpenDecompressingIfstream(const std::string& filepath, size_t numThreads = 0);
+
+    /// <summary> Reads the decompressed contents of a gzip or zstd compressed file into memory. </summary>
+    ///
+    /// <param name="filepath"> The path. </param>
+    /// <param name="numThreads"> The number of threads that decompress the frames of a zstd file, zero to use one per core. </param>
+    ///
+    /// <returns> The decompressed contents. </returns>
+    std::vector<char> ReadDecompressedFile(const std::string& filepath, size_t numThreads = 0);
+} // namespace utilities
+} // namespace ell
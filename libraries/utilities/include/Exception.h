@@ -74,7 +74,8 @@ namespace utilities
     {
         fileNotFound,
         fileNotWritable,
-        serialPortUnavailable
+        serialPortUnavailable,
+        connectionFailed
     };
 
     /// <summary> Error codes for exceptions due to the numeric values in the data. </summary>
@@ -43,6 +43,14 @@ namespace utilities
             /// <returns> An size_t. </returns>
             size_t Get() const { return *_begin; }
 
+            /// <summary> Copies the current iterate and the ones after it into an array, and proceeds past them. </summary>
+            ///
+            /// <param name="buffer"> The array. </param>
+            /// <param name="count"> The size of the array. </param>
+            ///
+            /// <returns> The number of entries copied, which is less than `count` only at the end of the list. </returns>
+            size_t Read(size_t* buffer, size_t count);
+
         private:
             // private ctor, can only be called from IntegerList class.
             Iterator(const vector_iterator& begin, const vector_iterator& end);
@@ -363,24 +363,33 @@ namespace utilities
         }
 
         _tokenizer.MatchToken("[");
-        while (true)
+        if constexpr (std::is_same_v<ValueType, bool> || std::is_same_v<ValueType, char>)
         {
-            auto maybeEndArray = _tokenizer.PeekNextToken();
-            if (maybeEndArray == "]")
-            {
-                break;
-            }
-
-            ValueType obj;
-            Unarchive(obj);
-            array.push_back(obj);
-
-            if (_tokenizer.PeekNextToken() == ",")
+            // archived as words and characters, rather than numbers
+            while (true)
             {
-                _tokenizer.ReadNextToken();
+                auto maybeEndArray = _tokenizer.PeekNextToken();
+                if (maybeEndArray == "]")
+                {
+                    break;
+                }
+
+                ValueType obj;
+                Unarchive(obj);
+                array.push_back(obj);
+
+                if (_tokenizer.PeekNextToken() == ",")
+                {
+                    _tokenizer.ReadNextToken();
+                }
             }
+            _tokenizer.MatchToken("]");
+        }
+        else
+        {
+            // Parse the whole array in place, rather than reading a token for each value
+            _tokenizer.ReadNumbers(array, ',', ']');
         }
-        _tokenizer.MatchToken("]");
 
         // eat a comma if it exists
         if (hasName)
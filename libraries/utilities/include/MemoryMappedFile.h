@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     MemoryMappedFile.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace ell
+{
+namespace utilities
+{
+    /// <summary>
+    /// A read-only view of the contents of a file. On POSIX systems the file is mapped into memory with mmap,
+    /// so its pages are read on demand; elsewhere the contents are read into a buffer.
+    /// </summary>
+    class MemoryMappedFile
+    {
+    public:
+        /// <summary> Maps a file into memory, and throws an exception if a problem occurs. </summary>
+        ///
+        /// <param name="filepath"> The path. </param>
+        MemoryMappedFile(const std::string& filepath);
+
+        MemoryMappedFile(MemoryMappedFile&& other);
+
+        MemoryMappedFile(const MemoryMappedFile&) = delete;
+
+        ~MemoryMappedFile();
+
+        MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+        /// <summary> Returns a pointer to the first character of the file. </summary>
+        ///
+        /// <returns> Pointer to the file contents. </returns>
+        const char* begin() const { return _data; }
+
+        /// <summary> Returns a pointer just past the last character of the file. </summary>
+        ///
+        /// <returns> Pointer to the end of the file contents. </returns>
+        const char* end() const { return _data + _size; }
+
+        /// <summary> Returns the size of the file. </summary>
+        ///
+        /// <returns> The number of bytes in the file. </returns>
+        size_t Size() const { return _size; }
+
+    private:
+        const char* _data = nullptr;
+        size_t _size = 0;
+        std::string _buffer; // holds the contents when the file can't be mapped
+        bool _isMapped = false;
+    };
+} // namespace utilities
+} // namespace ell
@@ -0,0 +1,178 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     OutputBuffer.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace ell
+{
+namespace utilities
+{
+    /// <summary>
+    /// A buffer that text and binary output is formatted into before it is written to a stream with one call.
+    /// Numbers are formatted the same way in every locale, and floating-point numbers in the shortest form that
+    /// reads back as the same value (so a float that was read from "0.1" is written as "0.1").
+    /// </summary>
+    class OutputBuffer
+    {
+    public:
+        OutputBuffer() = default;
+
+        /// <summary> Appends a character. </summary>
+        OutputBuffer& operator<<(char c)
+        {
+            _data.push_back(c);
+            return *this;
+        }
+
+        /// <summary> Appends a string. </summary>
+        OutputBuffer& operator<<(std::string_view text)
+        {
+            _data.insert(_data.end(), text.begin(), text.end());
+            return *this;
+        }
+
+        /// <summary> Appends a null-terminated string. </summary>
+        OutputBuffer& operator<<(const char* text) { return *this << std::string_view(text); }
+
+        /// <summary> Appends a string. </summary>
+        OutputBuffer& operator<<(const std::string& text) { return *this << std::string_view(text); }
+
+        /// <summary> Appends a double, in the shortest form that reads back as the same value. </summary>
+        OutputBuffer& operator<<(double value);
+
+        /// <summary> Appends a float, in the shortest form that reads back as the same value. </summary>
+        OutputBuffer& operator<<(float value);
+
+        /// <summary> Appends an integer. </summary>
+        template <typename IntegerType, std::enable_if_t<std::is_integral_v<IntegerType> && !std::is_same_v<IntegerType, char> && !std::is_same_v<IntegerType, bool>, bool> = true>
+        OutputBuffer& operator<<(IntegerType value)
+        {
+            if constexpr (std::is_signed_v<IntegerType>)
+            {
+                AppendInteger(static_cast<long long>(value));
+            }
+            else
+            {
+                AppendInteger(static_cast<unsigned long long>(value));
+            }
+            return *this;
+        }
+
+        /// <summary> Appends raw bytes. </summary>
+        ///
+        /// <param name="data"> Pointer to the bytes. </param>
+        /// <param name="size"> The number of bytes. </param>
+        void Write(const void* data, size_t size);
+
+        /// <summary> Appends zero bytes, up to the next multiple of an alignment. </summary>
+        ///
+        /// <param name="alignment"> The alignment, in bytes. </param>
+        void Pad(size_t alignment);
+
+        /// <summary> Writes the contents of the buffer to a stream, with one call, and empties the buffer. </summary>
+        ///
+        /// <param name="stream"> The stream to write to. </param>
+        void WriteTo(std::ostream& stream);
+
+        /// <summary> Gets the number of bytes in the buffer. </summary>
+        size_t Size() const { return _data.size(); }
+
+        /// <summary> Gets the contents of the buffer as a string. </summary>
+        std::string ToString() const { return { _data.data(), _data.size() }; }
+
+        /// <summary> Empties the buffer, keeping its memory. </summary>
+        void Clear() { _data.clear(); }
+
+    private:
+        void AppendInteger(long long value);
+        void AppendInteger(unsigned long long value);
+
+        std::vector<char> _data;
+    };
+
+    /// <summary>
+    /// Formats a sequence of items into blocks on several threads, and writes the blocks to a stream in order, one
+    /// call per block. The number of items in a block adapts so that blocks are a few megabytes, and the number of
+    /// blocks being formatted at once is bounded, so the memory used doesn't grow with the number of items.
+    /// </summary>
+    ///
+    /// <param name="numItems"> The number of items. </param>
+    /// <param name="stream"> The stream to write to. </param>
+    /// <param name="numThreads"> The number of threads that format blocks, zero to use one per core. Inside a parallel
+    /// region (see `IsInParallelRegion`) the calling thread formats every block. </param>
+    /// <param name="formatItem"> A function of the form `void(size_t index, OutputBuffer& buffer)` that appends an item to a buffer. It's called on several threads at once. </param>
+    template <typename FormatFunctionType>
+    void WriteInParallel(size_t numItems, std::ostream& stream, size_t numThreads, FormatFunctionType&& formatItem);
+} // namespace utilities
+} // namespace ell
+
+#pragma region implementation
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <deque>
+#include <future>
+
+namespace ell
+{
+namespace utilities
+{
+    template <typename FormatFunctionType>
+    void WriteInParallel(size_t numItems, std::ostream& stream, size_t numThreads, FormatFunctionType&& formatItem)
+    {
+        const size_t targetBlockBytes = size_t{ 4 } << 20;
+        // Like the ParallelFor functions, format on the calling thread when called from parallel code
+        numThreads = IsInParallelRegion() ? 1 : GetNumThreads(numThreads);
+        auto launchPolicy = numThreads > 1 ? std::launch::async : std::launch::deferred;
+
+        auto formatBlock = [&formatItem](size_t fromIndex, size_t toIndex) {
+            ParallelRegion region;
+            OutputBuffer buffer;
+            for (auto index = fromIndex; index < toIndex; ++index)
+            {
+                formatItem(index, buffer);
+            }
+            return buffer;
+        };
+
+        // Start with small blocks, and size the next ones from the number of bytes per item so far
+        size_t blockSize = 64;
+        size_t numFormattedItems = 0;
+        size_t numFormattedBytes = 0;
+        size_t nextIndex = 0;
+        std::deque<std::pair<size_t, std::future<OutputBuffer>>> blocks;
+        while (nextIndex < numItems || !blocks.empty())
+        {
+            while (nextIndex < numItems && blocks.size() < 2 * numThreads)
+            {
+                auto toIndex = std::min(nextIndex + blockSize, numItems);
+                blocks.emplace_back(toIndex - nextIndex, std::async(launchPolicy, formatBlock, nextIndex, toIndex));
+                nextIndex = toIndex;
+            }
+
+            auto buffer = blocks.front().second.get();
+            numFormattedItems += blocks.front().first;
+            numFormattedBytes += buffer.Size();
+            blocks.pop_front();
+            buffer.WriteTo(stream);
+
+            blockSize = std::max<size_t>(1, targetBlockBytes * numFormattedItems / std::max<size_t>(numFormattedBytes, 1));
+        }
+    }
+} // namespace utilities
+} // namespace ell
+
+#pragma endregion implementation
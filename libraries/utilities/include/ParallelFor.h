@@ -0,0 +1,197 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ParallelFor.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <vector>
+
+namespace ell
+{
+namespace utilities
+{
+    /// <summary> Gets the number of threads to use for a requested number of threads. </summary>
+    ///
+    /// <param name="numThreads"> The requested number of threads, or 0 for the number of hardware threads. </param>
+    ///
+    /// <returns> `numThreads` if it's nonzero, else the number of hardware threads (at least 1). </returns>
+    size_t GetNumThreads(size_t numThreads);
+
+    /// <summary> Indicates if the calling thread is running a block of one of the ParallelFor functions, or is
+    /// inside a ParallelRegion. Nested ParallelFor calls run all their blocks on the calling thread, so parallel
+    /// code that calls other parallel code doesn't start more threads than there are cores. </summary>
+    bool IsInParallelRegion();
+
+    /// <summary> Marks the calling thread as running parallel work for as long as the object exists. Code that runs
+    /// its own worker threads uses it so that the ParallelFor calls made on those threads don't start more. </summary>
+    class ParallelRegion
+    {
+    public:
+        ParallelRegion();
+        ~ParallelRegion();
+
+        ParallelRegion(const ParallelRegion&) = delete;
+        ParallelRegion& operator=(const ParallelRegion&) = delete;
+
+    private:
+        bool _wasInParallelRegion;
+    };
+
+    /// <summary> Calls `function(blockIndex)` for each block in [0, numBlocks), each on its own thread, with block 0
+    /// on the calling thread. Returns when all the blocks are done, and then rethrows the exception of the first block
+    /// that threw, if any. When called from inside another ParallelFor block, runs the blocks in order on the calling
+    /// thread, stopping at the first exception. A single block runs on the calling thread as plain code, so the
+    /// ParallelFor calls it makes may still use more threads. </summary>
+    ///
+    /// <param name="numBlocks"> The number of blocks. </param>
+    /// <param name="function"> The function to call on each block. </param>
+    template <typename FunctionType>
+    void ParallelForBlocks(size_t numBlocks, FunctionType&& function);
+
+    /// <summary> Splits the range [0, count) into `numBlocks` contiguous blocks of about the same size, and calls
+    /// `function(begin, end)` for each of them with ParallelForBlocks. </summary>
+    ///
+    /// <param name="count"> The size of the range. </param>
+    /// <param name="numBlocks"> The number of blocks, and so of threads. It's reduced to `count` if that's smaller. </param>
+    /// <param name="function"> The function to call on each block. </param>
+    template <typename FunctionType>
+    void ParallelForRanges(size_t count, size_t numBlocks, FunctionType&& function);
+
+    /// <summary> Calls `function(index)` for each index in [0, count), giving each of `numThreads` threads a
+    /// contiguous block of indices. </summary>
+    ///
+    /// <param name="count"> The number of indices. </param>
+    /// <param name="numThreads"> The number of threads, or 0 for the number of hardware threads. </param>
+    /// <param name="function"> The function to call on each index. </param>
+    template <typename FunctionType>
+    void ParallelFor(size_t count, size_t numThreads, FunctionType&& function);
+
+    /// <summary> Calls `function(index)` for each index in [0, count) on `numThreads` threads, handing out the indices
+    /// one at a time, for work whose items take very different amounts of time. </summary>
+    ///
+    /// <param name="count"> The number of indices. </param>
+    /// <param name="numThreads"> The number of threads, or 0 for the number of hardware threads. </param>
+    /// <param name="function"> The function to call on each index. </param>
+    template <typename FunctionType>
+    void ParallelForDynamic(size_t count, size_t numThreads, FunctionType&& function);
+} // namespace utilities
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace utilities
+{
+    template <typename FunctionType>
+    void ParallelForBlocks(size_t numBlocks, FunctionType&& function)
+    {
+        if (numBlocks == 0)
+        {
+            return;
+        }
+
+        if (numBlocks == 1)
+        {
+            function(size_t{ 0 });
+            return;
+        }
+
+        if (IsInParallelRegion())
+        {
+            ParallelRegion region;
+            for (size_t blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+            {
+                function(blockIndex);
+            }
+            return;
+        }
+
+        // The blocks refer to the caller's variables, so every block has to finish before this returns, even
+        // when one of them throws
+        std::vector<std::future<void>> blocks;
+        blocks.reserve(numBlocks - 1);
+        for (size_t blockIndex = 1; blockIndex < numBlocks; ++blockIndex)
+        {
+            blocks.push_back(std::async(std::launch::async, [&function, blockIndex]() {
+                ParallelRegion region;
+                function(blockIndex);
+            }));
+        }
+
+        std::exception_ptr exception;
+        try
+        {
+            ParallelRegion region;
+            function(size_t{ 0 });
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        for (auto& block : blocks)
+        {
+            try
+            {
+                block.get();
+            }
+            catch (...)
+            {
+                if (!exception)
+                {
+                    exception = std::current_exception();
+                }
+            }
+        }
+
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+
+    template <typename FunctionType>
+    void ParallelForRanges(size_t count, size_t numBlocks, FunctionType&& function)
+    {
+        numBlocks = std::min(numBlocks, count);
+        ParallelForBlocks(numBlocks, [count, numBlocks, &function](size_t blockIndex) {
+            function(count * blockIndex / numBlocks, count * (blockIndex + 1) / numBlocks);
+        });
+    }
+
+    template <typename FunctionType>
+    void ParallelFor(size_t count, size_t numThreads, FunctionType&& function)
+    {
+        ParallelForRanges(count, GetNumThreads(numThreads), [&function](size_t begin, size_t end) {
+            for (auto index = begin; index < end; ++index)
+            {
+                function(index);
+            }
+        });
+    }
+
+    template <typename FunctionType>
+    void ParallelForDynamic(size_t count, size_t numThreads, FunctionType&& function)
+    {
+        std::atomic<size_t> nextIndex{ 0 };
+        ParallelForBlocks(std::min(GetNumThreads(numThreads), count), [count, &nextIndex, &function](size_t) {
+            for (auto index = nextIndex++; index < count; index = nextIndex++)
+            {
+                function(index);
+            }
+        });
+    }
+} // namespace utilities
+} // namespace ell
+
+#pragma endregion implementation
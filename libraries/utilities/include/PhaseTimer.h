@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PhaseTimer.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace utilities
+{
+    /// <summary> The total time spent in a phase of work, and in the phases timed inside it. </summary>
+    struct PhaseTiming
+    {
+        std::string name;
+        double milliseconds = 0;
+        int count = 0; // the number of times the phase ran
+        std::vector<PhaseTiming> children; // in the order they first ran
+    };
+
+    /// <summary>
+    /// Times a phase of work, from construction to destruction, when phase timing is enabled (see `EnablePhaseTiming`).
+    /// Phases timed while another one is running on the same thread are nested in it, and a phase that runs several
+    /// times in the same place adds up. Phases that run on other threads are at the top level. Does nothing when
+    /// phase timing is disabled, so the loading, refining, optimizing and compiling of a model are timed this way
+    /// whether or not anyone asks for the timings.
+    /// </summary>
+    class PhaseTimer
+    {
+    public:
+        /// <summary> Starts timing a phase. </summary>
+        ///
+        /// <param name="name"> The name of the phase. </param>
+        explicit PhaseTimer(const std::string& name);
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+        /// <summary> Adds the time since construction to the phase's total, unless `Stop` was called. </summary>
+        ~PhaseTimer();
+
+        /// <summary> Adds the time since construction to the phase's total, before the end of the scope. </summary>
+        void Stop();
+
+    private:
+        bool _enabled;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    /// <summary> Turns phase timing on or off. It's off by default. </summary>
+    void EnablePhaseTiming(bool enable);
+
+    /// <summary> Indicates if phase timing is on. </summary>
+    bool IsPhaseTimingEnabled();
+
+    /// <summary> Gets the phases timed so far, as the children of an unnamed root phase. </summary>
+    PhaseTiming GetPhaseTimings();
+
+    /// <summary> Discards the phases timed so far. </summary>
+    void ResetPhaseTimings();
+
+    /// <summary> Writes the phases timed so far as JSON: an array of phases, each with its name, total milliseconds, count, and children. </summary>
+    void WritePhaseTimingsJson(std::ostream& stream);
+
+    /// <summary> Writes the phases timed so far as indented text, one phase per line. </summary>
+    void WritePhaseTimings(std::ostream& stream);
+} // namespace utilities
+} // namespace ell
@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PoolAllocator.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+namespace ell
+{
+namespace utilities
+{
+    /// <summary> The alignment, in bytes, of all memory handed out by the pool: one cache line, and enough for any SIMD load. </summary>
+    constexpr size_t poolAlignment = 64;
+
+    /// <summary>
+    /// Allocates aligned memory from the calling thread's pool. Requests are rounded up to one of a set of size
+    /// classes, and a block freed earlier in the same size class is reused if there is one. Requests bigger than
+    /// the biggest size class go straight to the heap.
+    /// </summary>
+    ///
+    /// <param name="size"> The number of bytes to allocate. </param>
+    ///
+    /// <returns> Pointer to the memory, aligned to `poolAlignment` bytes. </returns>
+    void* PoolAllocate(size_t size);
+
+    /// <summary>
+    /// Returns memory allocated by PoolAllocate to the calling thread's pool, which may be a different thread from
+    /// the one that allocated it. The pool keeps a bounded number of bytes and frees the rest to the heap, and
+    /// frees everything it keeps when the thread exits.
+    /// </summary>
+    ///
+    /// <param name="p"> Pointer to the memory. </param>
+    /// <param name="size"> The number of bytes passed to PoolAllocate when the memory was allocated. </param>
+    void PoolDeallocate(void* p, size_t size);
+
+    /// <summary> Gets the number of bytes of the calling thread's pool that are free for reuse. </summary>
+    ///
+    /// <returns> The number of bytes. </returns>
+    size_t GetPoolCachedSize();
+
+    /// <summary> The size, in bytes, of the huge pages requests bigger than the biggest size class can be backed by. </summary>
+    constexpr size_t poolHugePageSize = size_t(2) << 20;
+
+    /// <summary>
+    /// Sets whether requests bigger than the biggest size class, like the storage of large matrices and tensors, are
+    /// mapped on `poolHugePageSize` boundaries and backed by transparent huge pages, which take fewer TLB entries than
+    /// heap memory (Linux only; elsewhere this has no effect). Applies to the whole process, from the next allocation on.
+    /// </summary>
+    ///
+    /// <param name="enable"> Whether to use huge pages. </param>
+    void SetPoolHugePages(bool enable);
+
+    /// <summary> Indicates whether large requests are backed by huge pages (see `SetPoolHugePages`). </summary>
+    bool GetPoolHugePages();
+
+    /// <summary>
+    /// A stateless standard library allocator that allocates aligned memory from the calling thread's pool, for
+    /// containers that are created and destroyed often, like the temporaries of training loops.
+    /// </summary>
+    ///
+    /// <typeparam name="ValueType"> The type of the allocated objects. </typeparam>
+    template <typename ValueType>
+    class PoolAllocator
+    {
+    public:
+        static_assert(alignof(ValueType) <= poolAlignment, "PoolAllocator can't allocate over-aligned types");
+
+        using value_type = ValueType;
+
+        PoolAllocator() = default;
+
+        template <typename OtherValueType>
+        PoolAllocator(const PoolAllocator<OtherValueType>&)
+        {}
+
+        /// <summary> Allocates memory for an array of objects. </summary>
+        ///
+        /// <param name="count"> The number of objects. </param>
+        ///
+        /// <returns> Pointer to the memory. </returns>
+        ValueType* allocate(size_t count) { return static_cast<ValueType*>(PoolAllocate(count * sizeof(ValueType))); }
+
+        /// <summary> Returns memory to the pool. </summary>
+        ///
+        /// <param name="p"> Pointer to the memory. </param>
+        /// <param name="count"> The number of objects the memory was allocated for. </param>
+        void deallocate(ValueType* p, size_t count) { PoolDeallocate(p, count * sizeof(ValueType)); }
+    };
+
+    template <typename ValueType1, typename ValueType2>
+    bool operator==(const PoolAllocator<ValueType1>&, const PoolAllocator<ValueType2>&)
+    {
+        return true;
+    }
+
+    template <typename ValueType1, typename ValueType2>
+    bool operator!=(const PoolAllocator<ValueType1>&, const PoolAllocator<ValueType2>&)
+    {
+        return false;
+    }
+} // namespace utilities
+} // namespace ell
@@ -77,6 +77,12 @@ namespace utilities
     /// <returns> A valid C language identifier or empty string if there are no valid chars. </returns>
     std::string MakeValidIdentifier(const std::string& s);
 
+    /// <summary> Quotes a string as a JSON string literal, escaping quotes, backslashes and control characters. </summary>
+    ///
+    /// <param name="s"> The string to quote. </param>
+    /// <returns> The JSON string literal, including the quotes. </returns>
+    std::string QuoteJsonString(const std::string& s);
+
     /// <summary> A templatized helper method that converts a string to given typed value. </summary>
     ///
     /// <typeparam name="ValueType"> The type of the object </typeparam>
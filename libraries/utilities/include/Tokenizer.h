@@ -8,10 +8,14 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
 #include <initializer_list>
 #include <istream>
 #include <stack>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace ell
@@ -64,6 +68,18 @@ namespace utilities
         /// <returns> The next token, or the empty string if the end of file is reached. </returns>
         std::string PeekNextToken();
 
+        /// <summary>
+        /// Reads numbers separated by a delimiter, up to and including a terminator: for instance, the rest of a JSON
+        /// array after its opening bracket. The numbers are parsed in place in the buffer rather than read as tokens,
+        /// and the vector is sized ahead of time when the terminator is already in the buffer.
+        /// </summary>
+        ///
+        /// <param name="values"> The vector to append the numbers to. </param>
+        /// <param name="delimiter"> The character between numbers. </param>
+        /// <param name="terminator"> The character after the last number. </param>
+        template <typename ValueType>
+        void ReadNumbers(std::vector<ValueType>& values, char delimiter, char terminator);
+
         /// <summary> Consumes entire stream, printing tokens as they're read. For debugging. </summary>
         ///
         /// <param name="os"> The stream to print the tokens to. </param>
@@ -79,6 +95,17 @@ namespace utilities
         void UngetCharacter();
         void ReadData();
 
+        // Helpers for ReadNumbers
+        void BeginReadingNumbers();
+        int ReadNonWhitespaceCharacter();
+        const char* GetNumberStart();
+        const char* GetBufferEnd() const;
+        size_t CountRemainingItems(char delimiter, char terminator) const;
+        [[noreturn]] void ThrowUnexpectedCharacter(int ch) const;
+        static const char* ParseNumber(const char* begin, const char* end, int64_t& value);
+        static const char* ParseNumber(const char* begin, const char* end, uint64_t& value);
+        static const char* ParseNumber(const char* begin, const char* end, double& value);
+
         std::vector<char> _textBuffer;
         std::vector<char>::iterator _tokenStart;
         std::vector<char>::iterator _currentPosition;
@@ -125,3 +152,57 @@ namespace utilities
 
 } // namespace utilities
 } // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+namespace utilities
+{
+    template <typename ValueType>
+    void Tokenizer::ReadNumbers(std::vector<ValueType>& values, char delimiter, char terminator)
+    {
+        static_assert(std::is_arithmetic_v<ValueType>, "ReadNumbers can only read numbers");
+
+        // Integers are parsed as the widest type of their signedness, and floating-point numbers as double
+        using ParsedType = std::conditional_t<std::is_floating_point_v<ValueType>,
+                                              double,
+                                              std::conditional_t<std::is_same_v<ValueType, uint64_t>, uint64_t, int64_t>>;
+
+        BeginReadingNumbers();
+        values.reserve(values.size() + CountRemainingItems(delimiter, terminator));
+        for (bool isFirst = true;; isFirst = false)
+        {
+            auto ch = ReadNonWhitespaceCharacter();
+            if (isFirst && ch == terminator)
+            {
+                break;
+            }
+            if (ch == EOF)
+            {
+                ThrowUnexpectedCharacter(ch);
+            }
+            UngetCharacter();
+
+            ParsedType value;
+            auto numberStart = GetNumberStart();
+            auto numberEnd = ParseNumber(numberStart, GetBufferEnd(), value);
+            _currentPosition += numberEnd - numberStart;
+            values.push_back(static_cast<ValueType>(value));
+
+            ch = ReadNonWhitespaceCharacter();
+            if (ch == terminator)
+            {
+                break;
+            }
+            if (ch != delimiter)
+            {
+                ThrowUnexpectedCharacter(ch);
+            }
+        }
+        _tokenStart = _currentPosition;
+    }
+} // namespace utilities
+} // namespace ell
+
+#pragma endregion implementation
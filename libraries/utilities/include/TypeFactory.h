@@ -14,6 +14,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <typeindex>
 #include <unordered_map>
 #include <utility>
 
@@ -96,7 +97,10 @@ namespace utilities
     };
 
     /// <summary>
-    /// A factory object that can create new objects given their type name and a base type to derive from.
+    /// A factory object that can create new objects given their type name and a base type to derive from. The types
+    /// are kept in a separate table for each base type, found by its type_index, so constructing an object hashes
+    /// only its type name and allocates nothing but the object. Construct can be called from several threads at
+    /// once, as long as no types are being added.
     /// </summary>
     class GenericTypeFactory
     {
@@ -125,7 +129,8 @@ namespace utilities
         void AddType(const std::string& typeName);
 
     private:
-        std::unordered_map<std::string, std::shared_ptr<TypeConstructorBase>> _typeConstructorMap;
+        using TypeConstructorMap = std::unordered_map<std::string, std::shared_ptr<TypeConstructorBase>>;
+        std::unordered_map<std::type_index, TypeConstructorMap> _typeConstructorMaps;
     };
 } // namespace utilities
 } // namespace ell
@@ -216,15 +221,17 @@ namespace utilities
     template <typename BaseType>
     std::unique_ptr<BaseType> GenericTypeFactory::Construct(const std::string& typeName) const
     {
-        auto baseTypeName = std::string{ BaseType::GetTypeName() };
-        auto key = baseTypeName + "__" + typeName;
-        auto entry = _typeConstructorMap.find(key);
-        if (entry == _typeConstructorMap.end())
+        auto typeConstructors = _typeConstructorMaps.find(std::type_index(typeid(BaseType)));
+        if (typeConstructors != _typeConstructorMaps.end())
         {
-            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "type " + typeName + " not registered in TypeFactory<" + BaseType::GetTypeName() + ">");
+            auto entry = typeConstructors->second.find(typeName);
+            if (entry != typeConstructors->second.end())
+            {
+                return entry->second->Construct<BaseType>();
+            }
         }
 
-        return entry->second->Construct<BaseType>();
+        throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "type " + typeName + " not registered in TypeFactory<" + BaseType::GetTypeName() + ">");
     }
 
     template <typename BaseType, typename RuntimeType>
@@ -237,11 +244,8 @@ namespace utilities
     template <typename BaseType, typename RuntimeType>
     void GenericTypeFactory::AddType(const std::string& typeName)
     {
-        auto baseTypeName = std::string{ BaseType::GetTypeName() };
-        auto key = baseTypeName + "__" + typeName;
-
         auto derivedCreator = TypeConstructorDerived<BaseType>::template NewTypeConstructor<RuntimeType>().release();
-        _typeConstructorMap[key] = std::shared_ptr<TypeConstructorBase>(derivedCreator);
+        _typeConstructorMaps[std::type_index(typeid(BaseType))][typeName] = std::shared_ptr<TypeConstructorBase>(derivedCreator);
     }
 } // namespace utilities
 } // namespace ell
@@ -185,7 +185,17 @@ namespace utilities
             _out << " name='" << name << "'";
         }
 
-        _out << " value='" << to_string(value) << "'/>" << endOfLine;
+        _out << " value='";
+        if constexpr (std::is_floating_point_v<ValueType>)
+        {
+            // to_string only writes 6 decimal places
+            _out << value;
+        }
+        else
+        {
+            _out << to_string(value);
+        }
+        _out << "'/>" << endOfLine;
     }
 
     // Specialization for bool (though perhaps this should be an overload, not a specialization)
@@ -0,0 +1,45 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     Arena.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ell
+{
+namespace utilities
+{
+    Arena::Arena(size_t chunkSize) :
+        _chunkSize(chunkSize)
+    {
+    }
+
+    void* Arena::Allocate(size_t size, size_t alignment)
+    {
+        auto address = reinterpret_cast<uintptr_t>(_current);
+        auto padding = (alignment - address % alignment) % alignment;
+        if (_current == nullptr || padding + size > static_cast<size_t>(_end - _current))
+        {
+            // allocations bigger than a chunk get a chunk of their own
+            auto chunkSize = std::max(_chunkSize, size + alignment);
+            _chunks.push_back(std::make_unique<char[]>(chunkSize));
+            _current = _chunks.back().get();
+            _end = _current + chunkSize;
+
+            address = reinterpret_cast<uintptr_t>(_current);
+            padding = (alignment - address % alignment) % alignment;
+        }
+
+        auto result = _current + padding;
+        _current = result + size;
+        _allocatedSize += size;
+        return result;
+    }
+} // namespace utilities
+} // namespace ell
@@ -0,0 +1,351 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BinaryArchiver.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "BinaryArchiver.h"
+#include "Archiver.h"
+#include "IArchivable.h"
+#include "Unused.h"
+
+#include <iterator>
+#include <string>
+
+namespace ell
+{
+namespace utilities
+{
+    using namespace BinaryArchiverImpl;
+
+    //
+    // Serialization
+    //
+    BinaryArchiver::BinaryArchiver(std::ostream& outputStream) :
+        _out(outputStream)
+    {
+        WriteBytes(fileSignature, sizeof(fileSignature));
+        WriteRaw(formatVersion);
+        WriteRaw(byteOrderMark);
+    }
+
+#define ARCHIVE_TYPE_OP(t) IMPLEMENT_ARCHIVE_VALUE(BinaryArchiver, t);
+    ARCHIVABLE_TYPES_LIST
+#undef ARCHIVE_TYPE_OP
+
+    // strings
+    void BinaryArchiver::ArchiveValue(const char* name, const std::string& value)
+    {
+        WriteScalar(name, value);
+    }
+
+    void BinaryArchiver::ArchiveNull(const char* name)
+    {
+        WriteRecordHeader(RecordType::null, name);
+    }
+
+    // IArchivable
+    void BinaryArchiver::BeginArchiveObject(const char* name, const IArchivable& value)
+    {
+        if (value.ArchiveAsPrimitive())
+        {
+            WriteRecordHeader(RecordType::primitiveObject, name);
+            return;
+        }
+
+        WriteRecordHeader(RecordType::object, name);
+        WriteString(GetArchivedTypeName(value));
+        WriteRaw(static_cast<int32_t>(GetArchiveVersion(value).versionNumber));
+    }
+
+    void BinaryArchiver::EndArchiveObject(const char* name, const IArchivable& value)
+    {
+        UNUSED(name);
+        if (!value.ArchiveAsPrimitive())
+        {
+            WriteRaw(RecordType::endObject);
+        }
+    }
+
+//
+// Arrays
+//
+#define ARCHIVE_TYPE_OP(t) IMPLEMENT_ARCHIVE_ARRAY(BinaryArchiver, t);
+    ARCHIVABLE_TYPES_LIST
+#undef ARCHIVE_TYPE_OP
+
+    void BinaryArchiver::ArchiveArray(const char* name, const std::vector<std::string>& array)
+    {
+        WriteArray(name, array);
+    }
+
+    void BinaryArchiver::ArchiveArray(const char* name, const std::string& baseTypeName, const std::vector<const IArchivable*>& array)
+    {
+        WriteRecordHeader(RecordType::objectArray, name);
+        WriteString(baseTypeName);
+        WriteRaw(static_cast<uint64_t>(array.size()));
+        for (const auto& item : array)
+        {
+            Archive(*item);
+        }
+    }
+
+    void BinaryArchiver::EndArchiving()
+    {
+        _out.flush();
+    }
+
+    void BinaryArchiver::WriteScalar(const char* name, const std::string& value)
+    {
+        WriteRecordHeader(RecordType::string, name);
+        WriteString(value);
+    }
+
+    void BinaryArchiver::WriteArray(const char* name, const std::vector<std::string>& array)
+    {
+        WriteRecordHeader(RecordType::stringArray, name);
+        WriteRaw(static_cast<uint64_t>(array.size()));
+        for (const auto& item : array)
+        {
+            WriteString(item);
+        }
+    }
+
+    void BinaryArchiver::WriteRecordHeader(RecordType type, const char* name)
+    {
+        WriteRaw(type);
+        WriteString(name);
+    }
+
+    void BinaryArchiver::WriteString(const std::string& value)
+    {
+        WriteRaw(static_cast<uint64_t>(value.size()));
+        WriteBytes(value.data(), value.size());
+    }
+
+    void BinaryArchiver::WritePadding(size_t alignment)
+    {
+        static const char zeros[arrayAlignment] = {};
+        auto padding = (alignment - _offset % alignment) % alignment;
+        WriteBytes(zeros, padding);
+    }
+
+    void BinaryArchiver::WriteBytes(const void* data, size_t size)
+    {
+        _out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        _offset += size;
+    }
+
+    //
+    // Deserialization
+    //
+    BinaryUnarchiver::BinaryUnarchiver(std::istream& inputStream, SerializationContext context) :
+        Unarchiver(std::move(context)),
+        _buffer(std::istreambuf_iterator<char>(inputStream), std::istreambuf_iterator<char>())
+    {
+        _begin = _buffer.data();
+        _end = _begin + _buffer.size();
+        ReadFileHeader();
+    }
+
+    BinaryUnarchiver::BinaryUnarchiver(const MemoryMappedFile& file, SerializationContext context) :
+        Unarchiver(std::move(context)),
+        _begin(file.begin()),
+        _end(file.end())
+    {
+        ReadFileHeader();
+    }
+
+    bool BinaryUnarchiver::IsBinaryArchive(const char* data, size_t size)
+    {
+        return size >= sizeof(fileSignature) && std::memcmp(data, fileSignature, sizeof(fileSignature)) == 0;
+    }
+
+#define ARCHIVE_TYPE_OP(t) IMPLEMENT_UNARCHIVE_VALUE(BinaryUnarchiver, t);
+    ARCHIVABLE_TYPES_LIST
+#undef ARCHIVE_TYPE_OP
+
+    void BinaryUnarchiver::ReadFileHeader()
+    {
+        _position = _begin;
+        if (!IsBinaryArchive(_begin, static_cast<size_t>(_end - _begin)))
+        {
+            throw DataFormatException(DataFormatErrors::badFormat, "Not a binary archive");
+        }
+        ReadBytes(sizeof(fileSignature));
+
+        if (ReadRaw<uint32_t>() != formatVersion)
+        {
+            throw DataFormatException(DataFormatErrors::badFormat, "Unsupported binary archive version");
+        }
+        if (ReadRaw<uint32_t>() != byteOrderMark)
+        {
+            throw DataFormatException(DataFormatErrors::badFormat, "Binary archive was written on a machine with a different byte order");
+        }
+    }
+
+    // strings
+    void BinaryUnarchiver::UnarchiveValue(const char* name, std::string& value)
+    {
+        ReadScalar(name, value);
+    }
+
+    // IArchivable
+    ArchivedObjectInfo BinaryUnarchiver::BeginUnarchiveObject(const char* name, const std::string& typeName)
+    {
+        UNUSED(typeName);
+        MatchRecordHeader(RecordType::object, name);
+        auto readTypeName = ReadString();
+        if (readTypeName.empty())
+        {
+            throw DataFormatException(DataFormatErrors::badFormat, "Binary archive is invalid, expecting a non empty object type name");
+        }
+        auto version = ReadRaw<int32_t>();
+        return { readTypeName, version };
+    }
+
+    void BinaryUnarchiver::EndUnarchiveObject(const char* name, const std::string& typeName)
+    {
+        UNUSED(name, typeName);
+        if (ReadRaw<RecordType>() != RecordType::endObject)
+        {
+            throw DataFormatException(DataFormatErrors::badFormat, "Binary archive is invalid, expecting the end of object " + typeName);
+        }
+    }
+
+    void BinaryUnarchiver::UnarchiveObjectAsPrimitive(const char* name, IArchivable& value)
+    {
+        MatchRecordHeader(RecordType::primitiveObject, name);
+        UnarchiveObject(name, value);
+    }
+
+    bool BinaryUnarchiver::HasNextPropertyName(const std::string& name)
+    {
+        auto position = _position;
+        if (_end - _position < 1 || ReadRaw<RecordType>() == RecordType::endObject)
+        {
+            _position = position;
+            return false;
+        }
+
+        auto nextName = ReadString();
+        _position = position;
+        return nextName == name;
+    }
+
+    bool BinaryUnarchiver::UnarchiveNull(const char* name)
+    {
+        return TryMatchRecordHeader(RecordType::null, name);
+    }
+
+//
+// Arrays
+//
+#define ARCHIVE_TYPE_OP(t) IMPLEMENT_UNARCHIVE_ARRAY(BinaryUnarchiver, t);
+    ARCHIVABLE_TYPES_LIST
+#undef ARCHIVE_TYPE_OP
+
+    void BinaryUnarchiver::UnarchiveArray(const char* name, std::vector<std::string>& array)
+    {
+        ReadArray(name, array);
+    }
+
+    void BinaryUnarchiver::BeginUnarchiveArray(const char* name, const std::string& typeName)
+    {
+        MatchRecordHeader(RecordType::objectArray, name);
+        auto readTypeName = ReadString();
+        if (readTypeName != typeName)
+        {
+            throw DataFormatException(DataFormatErrors::badFormat, "Binary archive is invalid, expecting an array of " + typeName + " but found " + readTypeName);
+        }
+        _remainingArrayItems.push_back(ReadRaw<uint64_t>());
+    }
+
+    bool BinaryUnarchiver::BeginUnarchiveArrayItem(const std::string& typeName)
+    {
+        UNUSED(typeName);
+        if (_remainingArrayItems.back() == 0)
+        {
+            return false;
+        }
+        --_remainingArrayItems.back();
+        return true;
+    }
+
+    void BinaryUnarchiver::EndUnarchiveArrayItem(const std::string& typeName)
+    {
+        UNUSED(typeName);
+    }
+
+    void BinaryUnarchiver::EndUnarchiveArray(const char* name, const std::string& typeName)
+    {
+        UNUSED(name, typeName);
+        _remainingArrayItems.pop_back();
+    }
+
+    void BinaryUnarchiver::ReadScalar(const char* name, std::string& value)
+    {
+        MatchRecordHeader(RecordType::string, name);
+        value = ReadString();
+    }
+
+    void BinaryUnarchiver::ReadArray(const char* name, std::vector<std::string>& array)
+    {
+        MatchRecordHeader(RecordType::stringArray, name);
+        auto count = ReadRaw<uint64_t>();
+        for (uint64_t index = 0; index < count; ++index)
+        {
+            array.push_back(ReadString());
+        }
+    }
+
+    void BinaryUnarchiver::MatchRecordHeader(RecordType type, const char* name)
+    {
+        if (!TryMatchRecordHeader(type, name))
+        {
+            throw DataFormatException(DataFormatErrors::badFormat, std::string("Binary archive is invalid, failed to match property '") + name + "'");
+        }
+    }
+
+    bool BinaryUnarchiver::TryMatchRecordHeader(RecordType type, const char* name)
+    {
+        auto position = _position;
+        if (_end - _position >= 1 && ReadRaw<RecordType>() == type && ReadString() == name)
+        {
+            return true;
+        }
+        _position = position;
+        return false;
+    }
+
+    std::string BinaryUnarchiver::ReadString()
+    {
+        auto size = ReadRaw<uint64_t>();
+        if (size > static_cast<uint64_t>(_end - _position))
+        {
+            throw DataFormatException(DataFormatErrors::badFormat, "Binary archive string runs past the end of the archive");
+        }
+        auto data = ReadBytes(size);
+        return { data, size };
+    }
+
+    void BinaryUnarchiver::SkipPadding(size_t alignment)
+    {
+        auto offset = static_cast<size_t>(_position - _begin);
+        ReadBytes((alignment - offset % alignment) % alignment);
+    }
+
+    const char* BinaryUnarchiver::ReadBytes(size_t size)
+    {
+        if (size > static_cast<size_t>(_end - _position))
+        {
+            throw DataFormatException(DataFormatErrors::badFormat, "Unexpected end of binary archive");
+        }
+        auto data = _position;
+        _position += size;
+        return data;
+    }
+} // namespace utilities
+} // namespace ell
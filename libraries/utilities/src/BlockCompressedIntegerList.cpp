@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BlockCompressedIntegerList.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "BlockCompressedIntegerList.h"
+#include "Exception.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+// The SSSE3 decoder is compiled for x86 whatever the target flags are, and only used if the CPU supports it
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BLOCK_LIST_HAS_SSSE3
+#define BLOCK_LIST_SSSE3_FUNCTION __attribute__((target("ssse3")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(__AVX__)
+#define BLOCK_LIST_HAS_SSSE3
+#define BLOCK_LIST_SSSE3_FUNCTION
+#include <immintrin.h>
+#endif
+
+namespace ell
+{
+namespace utilities
+{
+    namespace
+    {
+        // the number of bytes of an entry of a group, from the group's control byte
+        size_t GetLength(uint8_t control, size_t index)
+        {
+            return ((control >> (2 * index)) & 0x03) + 1;
+        }
+
+        // decodes the first `count` entries of a group, one at a time
+        void DecodeGroupScalar(uint8_t control, const uint8_t*& data, size_t count, uint32_t& previous, uint32_t* output)
+        {
+            for (size_t index = 0; index < count; ++index)
+            {
+                auto length = GetLength(control, index);
+                uint32_t delta = 0;
+                std::memcpy(&delta, data, length);
+                data += length;
+                previous += delta;
+                output[index] = previous;
+            }
+        }
+
+#ifdef BLOCK_LIST_HAS_SSSE3
+        // for each control byte, the total length of the group and the shuffle that moves each delta into its own 32-bit lane
+        struct GroupTables
+        {
+            uint8_t lengths[256];
+            alignas(16) uint8_t shuffles[256][16];
+        };
+
+        const GroupTables& GetGroupTables()
+        {
+            static const GroupTables tables = [] {
+                GroupTables result;
+                for (size_t control = 0; control < 256; ++control)
+                {
+                    size_t offset = 0;
+                    for (size_t index = 0; index < BlockCompressedIntegerList::groupSize; ++index)
+                    {
+                        auto length = GetLength(static_cast<uint8_t>(control), index);
+                        for (size_t byte = 0; byte < 4; ++byte)
+                        {
+                            result.shuffles[control][4 * index + byte] = static_cast<uint8_t>(byte < length ? offset + byte : 0x80);
+                        }
+                        offset += length;
+                    }
+                    result.lengths[control] = static_cast<uint8_t>(offset);
+                }
+                return result;
+            }();
+            return tables;
+        }
+
+        bool CpuHasSsse3()
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            return true; // implied by __AVX__
+#else
+            return __builtin_cpu_supports("ssse3");
+#endif
+        }
+
+        // reads 16 bytes, so there must be at least that many left
+        BLOCK_LIST_SSSE3_FUNCTION void DecodeFullGroupSsse3(uint8_t control, const uint8_t*& data, uint32_t& previous, uint32_t* output)
+        {
+            const auto& tables = GetGroupTables();
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            auto deltas = _mm_shuffle_epi8(bytes, _mm_load_si128(reinterpret_cast<const __m128i*>(tables.shuffles[control])));
+
+            // prefix sum of the deltas, starting from the last value of the previous group
+            deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 4));
+            deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 8));
+            auto values = _mm_add_epi32(deltas, _mm_set1_epi32(static_cast<int>(previous)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output), values);
+
+            previous = output[BlockCompressedIntegerList::groupSize - 1];
+            data += tables.lengths[control];
+        }
+#endif
+
+        void DecodeFullGroup(uint8_t control, const uint8_t*& data, const uint8_t* dataEnd, uint32_t& previous, uint32_t* output)
+        {
+#ifdef BLOCK_LIST_HAS_SSSE3
+            static const bool hasSsse3 = CpuHasSsse3();
+            if (hasSsse3 && dataEnd - data >= 16)
+            {
+                DecodeFullGroupSsse3(control, data, previous, output);
+                return;
+            }
+#endif
+            DecodeGroupScalar(control, data, BlockCompressedIntegerList::groupSize, previous, output);
+        }
+    } // namespace
+
+    BlockCompressedIntegerList::Iterator::Iterator(const uint8_t* controls, const uint8_t* data, const uint8_t* dataEnd, size_t size) :
+        _controls(controls),
+        _data(data),
+        _dataEnd(dataEnd),
+        _remaining(size)
+    {
+        DecodeNextGroup();
+    }
+
+    void BlockCompressedIntegerList::Iterator::DecodeNextGroup()
+    {
+        _groupIndex = 0;
+        _groupCount = std::min(_remaining, groupSize);
+        if (_groupCount == groupSize)
+        {
+            DecodeFullGroup(*_controls++, _data, _dataEnd, _previous, _group);
+        }
+        else if (_groupCount > 0)
+        {
+            DecodeGroupScalar(*_controls++, _data, _groupCount, _previous, _group);
+        }
+        _remaining -= _groupCount;
+    }
+
+    size_t BlockCompressedIntegerList::Iterator::Read(size_t* buffer, size_t count)
+    {
+        size_t numRead = 0;
+        while (numRead < count && IsValid())
+        {
+            // the rest of the current group
+            auto numFromGroup = std::min(count - numRead, _groupCount - _groupIndex);
+            std::copy_n(_group + _groupIndex, numFromGroup, buffer + numRead);
+            numRead += numFromGroup;
+            _groupIndex += numFromGroup;
+            if (_groupIndex < _groupCount)
+            {
+                break;
+            }
+
+            // whole groups that fit in the buffer, without going through the iterator's group
+            uint32_t group[groupSize];
+            while (count - numRead >= groupSize && _remaining >= groupSize)
+            {
+                DecodeFullGroup(*_controls++, _data, _dataEnd, _previous, group);
+                std::copy_n(group, groupSize, buffer + numRead);
+                numRead += groupSize;
+                _remaining -= groupSize;
+            }
+            DecodeNextGroup();
+        }
+        return numRead;
+    }
+
+    void BlockCompressedIntegerList::Reserve(size_t size)
+    {
+        _controls.reserve((size + groupSize - 1) / groupSize);
+        _data.reserve(size * 2); // guess that, on average, every entry will occupy 2 bytes
+    }
+
+    size_t BlockCompressedIntegerList::Max() const
+    {
+        if (_size == 0)
+        {
+            throw utilities::LogicException(utilities::LogicExceptionErrors::illegalState, "Can't get max of empty list");
+        }
+
+        return _last;
+    }
+
+    void BlockCompressedIntegerList::Append(size_t value)
+    {
+        if (value > std::numeric_limits<uint32_t>::max())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::indexOutOfRange, "BlockCompressedIntegerList can only hold values smaller than 2^32");
+        }
+
+        // allow the first Append to have a value of zero, but subsequently require an increasing value
+        assert(_size == 0 || value > _last);
+        auto delta = static_cast<uint32_t>(value) - _last;
+        _last = static_cast<uint32_t>(value);
+
+        size_t length = delta < (1u << 8) ? 1 : delta < (1u << 16) ? 2 : delta < (1u << 24) ? 3 : 4;
+        auto position = _size % groupSize;
+        if (position == 0)
+        {
+            _controls.push_back(0);
+        }
+        _controls.back() |= static_cast<uint8_t>((length - 1) << (2 * position));
+
+        auto offset = _data.size();
+        _data.resize(offset + length);
+        std::memcpy(_data.data() + offset, &delta, length);
+
+        ++_size;
+    }
+
+    void BlockCompressedIntegerList::Reset()
+    {
+        _controls.clear();
+        _data.clear();
+        _last = 0;
+        _size = 0;
+    }
+} // namespace utilities
+} // namespace ell
@@ -56,12 +56,30 @@ namespace utilities
         }
     }
 
+    size_t CompressedIntegerList::Iterator::Read(size_t* buffer, size_t count)
+    {
+        size_t numRead = 0;
+        while (numRead < count && IsValid())
+        {
+            buffer[numRead++] = Get();
+            Next();
+        }
+        return numRead;
+    }
+
     CompressedIntegerList::CompressedIntegerList() :
         _last(std::numeric_limits<size_t>::max()),
         _size(0)
     {
     }
 
+    CompressedIntegerList::CompressedIntegerList(const uint8_t* begin, const uint8_t* end, size_t size, size_t max) :
+        _data(begin, end),
+        _last(size == 0 ? std::numeric_limits<size_t>::max() : max),
+        _size(size)
+    {
+    }
+
     size_t CompressedIntegerList::Size() const
     {
         return _size;
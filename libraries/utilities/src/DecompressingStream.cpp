@@ -0,0 +1,439 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DecompressingStream.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "DecompressingStream.h"
+#include "Exception.h"
+#include "Files.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <limits>
+
+#if defined(ELL_HAS_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(ELL_HAS_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace ell
+{
+namespace utilities
+{
+    namespace
+    {
+        const size_t c_chunkSize = size_t{ 1 } << 20;
+
+        // Frames larger than this are decompressed as a stream, so a huge frame isn't decompressed into memory at once
+        const size_t c_maxParallelFrameSize = size_t{ 64 } << 20;
+
+        const unsigned char c_gzipMagic[] = { 0x1f, 0x8b };
+        const unsigned char c_zstdMagic[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+        template <size_t N>
+        bool StartsWith(const char* begin, const char* end, const unsigned char (&magic)[N])
+        {
+            return static_cast<size_t>(end - begin) >= N && std::memcmp(begin, magic, N) == 0;
+        }
+
+        size_t GetNumThreads(size_t numThreads)
+        {
+            return numThreads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : numThreads;
+        }
+    } // namespace
+
+    CompressionFormat GetCompressionFormat(const char* begin, const char* end)
+    {
+        if (StartsWith(begin, end, c_gzipMagic))
+        {
+            return CompressionFormat::gzip;
+        }
+        if (StartsWith(begin, end, c_zstdMagic))
+        {
+            return CompressionFormat::zstd;
+        }
+        return CompressionFormat::none;
+    }
+
+    CompressionFormat GetFileCompressionFormat(const std::string& filepath)
+    {
+        auto stream = OpenBinaryIfstream(filepath);
+        char header[4] = {};
+        stream.read(header, sizeof(header));
+        return GetCompressionFormat(header, header + stream.gcount());
+    }
+
+    bool IsCompressionFormatAvailable(CompressionFormat format)
+    {
+        switch (format)
+        {
+        case CompressionFormat::none:
+            return true;
+        case CompressionFormat::gzip:
+#if defined(ELL_HAS_ZLIB)
+            return true;
+#else
+            return false;
+#endif
+        case CompressionFormat::zstd:
+#if defined(ELL_HAS_ZSTD)
+            return true;
+#else
+            return false;
+#endif
+        }
+        return false;
+    }
+
+    //
+    // DecompressingStreamBuffer
+    //
+
+    DecompressingStreamBuffer::DecompressingStreamBuffer(const std::string& filepath, size_t numThreads) :
+        _file(filepath),
+        _format(GetCompressionFormat(_file.begin(), _file.end())),
+        _numThreads(GetNumThreads(numThreads)),
+        _maxQueuedChunks(2 * _numThreads + 2)
+    {
+        if (_format == CompressionFormat::none)
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "File " + filepath + " isn't compressed in a known format");
+        }
+        if (!IsCompressionFormatAvailable(_format))
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "File " + filepath + " is compressed in a format this build of ELL can't decompress");
+        }
+        setg(nullptr, nullptr, nullptr);
+        _thread = std::thread([this] { Decompress(); });
+    }
+
+    DecompressingStreamBuffer::~DecompressingStreamBuffer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _isStopping = true;
+        }
+        _chunksChanged.notify_all();
+        _thread.join();
+    }
+
+    DecompressingStreamBuffer::int_type DecompressingStreamBuffer::underflow()
+    {
+        while (gptr() == egptr())
+        {
+            if (!NextChunk())
+            {
+                return traits_type::eof();
+            }
+        }
+        return traits_type::to_int_type(*gptr());
+    }
+
+    DecompressingStreamBuffer::pos_type DecompressingStreamBuffer::seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which)
+    {
+        const auto failed = pos_type(off_type(-1));
+        const auto position = _currentChunkOffset + (gptr() - eback());
+        if ((which & std::ios_base::in) == 0 || direction == std::ios_base::end)
+        {
+            return failed;
+        }
+        if (direction == std::ios_base::cur)
+        {
+            offset += position;
+        }
+        return offset == position ? pos_type(position) : seekpos(pos_type(offset), which);
+    }
+
+    DecompressingStreamBuffer::pos_type DecompressingStreamBuffer::seekpos(pos_type position, std::ios_base::openmode which)
+    {
+        // Seeking forward skips over the decompressed data, and seeking backward would need to start over
+        const auto failed = pos_type(off_type(-1));
+        const auto target = static_cast<std::streamoff>(position);
+        if ((which & std::ios_base::in) == 0 || target < _currentChunkOffset + (gptr() - eback()))
+        {
+            return failed;
+        }
+        while (target > _currentChunkOffset + static_cast<std::streamoff>(_currentChunk.size()))
+        {
+            if (!NextChunk())
+            {
+                return failed;
+            }
+        }
+        setg(_currentChunk.data(), _currentChunk.data() + (target - _currentChunkOffset), _currentChunk.data() + _currentChunk.size());
+        return position;
+    }
+
+    bool DecompressingStreamBuffer::NextChunk()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _chunksChanged.wait(lock, [this] { return !_chunks.empty() || _isFinished; });
+        if (_chunks.empty())
+        {
+            if (_error)
+            {
+                std::rethrow_exception(_error);
+            }
+            return false;
+        }
+
+        _currentChunkOffset += static_cast<std::streamoff>(_currentChunk.size());
+        _currentChunk = std::move(_chunks.front());
+        _chunks.pop_front();
+        lock.unlock();
+        _chunksChanged.notify_all();
+
+        setg(_currentChunk.data(), _currentChunk.data(), _currentChunk.data() + _currentChunk.size());
+        return true;
+    }
+
+    bool DecompressingStreamBuffer::PushChunk(std::vector<char> chunk)
+    {
+        if (chunk.empty())
+        {
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _chunksChanged.wait(lock, [this] { return _chunks.size() < _maxQueuedChunks || _isStopping; });
+        if (_isStopping)
+        {
+            return false;
+        }
+        _chunks.push_back(std::move(chunk));
+        lock.unlock();
+        _chunksChanged.notify_all();
+        return true;
+    }
+
+    void DecompressingStreamBuffer::Decompress()
+    {
+        try
+        {
+            if (_format == CompressionFormat::gzip)
+            {
+                DecompressGzip();
+            }
+            else
+            {
+                DecompressZstd();
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _isFinished = true;
+        }
+        _chunksChanged.notify_all();
+    }
+
+    void DecompressingStreamBuffer::DecompressGzip()
+    {
+#if defined(ELL_HAS_ZLIB)
+        // A gzip file can have several members one after the other (like the ones `bgzip` writes), and they're
+        // decompressed in order, on this thread
+        z_stream stream = {};
+        if (inflateInit2(&stream, 15 + 32) != Z_OK) // 15-bit window, and a gzip or zlib header
+        {
+            throw InputException(InputExceptionErrors::badData, "Can't initialize gzip decompression");
+        }
+        std::unique_ptr<z_stream, int (*)(z_stream*)> streamGuard(&stream, inflateEnd);
+
+        // zlib counts the input in 32-bit integers, so large files are passed to it a part at a time
+        const size_t maxInputSize = std::numeric_limits<uInt>::max();
+        auto input = reinterpret_cast<const Bytef*>(_file.begin());
+        size_t remainingInput = _file.Size();
+        bool isEndOfData = false;
+        while (!isEndOfData)
+        {
+            std::vector<char> chunk(c_chunkSize);
+            stream.next_out = reinterpret_cast<Bytef*>(chunk.data());
+            stream.avail_out = static_cast<uInt>(chunk.size());
+            while (stream.avail_out > 0)
+            {
+                if (stream.avail_in == 0 && remainingInput > 0)
+                {
+                    stream.next_in = const_cast<Bytef*>(input);
+                    stream.avail_in = static_cast<uInt>(std::min(remainingInput, maxInputSize));
+                    input += stream.avail_in;
+                    remainingInput -= stream.avail_in;
+                }
+
+                auto result = inflate(&stream, Z_NO_FLUSH);
+                if (result == Z_STREAM_END)
+                {
+                    if (stream.avail_in == 0 && remainingInput == 0)
+                    {
+                        isEndOfData = true;
+                        break;
+                    }
+                    inflateReset(&stream);
+                }
+                else if (result == Z_BUF_ERROR && stream.avail_in == 0 && remainingInput == 0)
+                {
+                    throw InputException(InputExceptionErrors::badData, "Gzip file is truncated");
+                }
+                else if (result != Z_OK)
+                {
+                    throw InputException(InputExceptionErrors::badData, std::string("Error decompressing gzip file: ") + (stream.msg != nullptr ? stream.msg : "bad data"));
+                }
+            }
+
+            chunk.resize(chunk.size() - stream.avail_out);
+            if (!PushChunk(std::move(chunk)))
+            {
+                return;
+            }
+        }
+#endif
+    }
+
+    void DecompressingStreamBuffer::DecompressZstd()
+    {
+#if defined(ELL_HAS_ZSTD)
+        // Frames of a known size are decompressed on several threads at once, and pushed in order
+        auto position = _file.begin();
+        const auto end = _file.end();
+        auto getFrameSize = [&end](const char* frame) {
+            auto frameSize = ZSTD_findFrameCompressedSize(frame, end - frame);
+            if (ZSTD_isError(frameSize))
+            {
+                throw InputException(InputExceptionErrors::badData, std::string("Error decompressing zstd file: ") + ZSTD_getErrorName(frameSize));
+            }
+            return frameSize;
+        };
+
+        std::deque<std::future<std::vector<char>>> frames;
+        while (true)
+        {
+            while (position < end && frames.size() < _numThreads)
+            {
+                auto frameSize = getFrameSize(position);
+                auto contentSize = ZSTD_getFrameContentSize(position, frameSize);
+                if (contentSize == ZSTD_CONTENTSIZE_UNKNOWN || contentSize == ZSTD_CONTENTSIZE_ERROR || contentSize > c_maxParallelFrameSize)
+                {
+                    break;
+                }
+
+                frames.push_back(std::async(std::launch::async, [frame = position, frameSize, contentSize] {
+                    std::vector<char> result(static_cast<size_t>(contentSize));
+                    auto size = ZSTD_decompress(result.data(), result.size(), frame, frameSize);
+                    if (ZSTD_isError(size))
+                    {
+                        throw InputException(InputExceptionErrors::badData, std::string("Error decompressing zstd file: ") + ZSTD_getErrorName(size));
+                    }
+                    result.resize(size);
+                    return result;
+                }));
+                position += frameSize;
+            }
+
+            if (!frames.empty())
+            {
+                auto chunk = frames.front().get();
+                frames.pop_front();
+                if (!PushChunk(std::move(chunk)))
+                {
+                    return;
+                }
+                continue;
+            }
+
+            if (position == end)
+            {
+                return;
+            }
+
+            // The next frame doesn't say how large it is (like the one `zstd` writes when it compresses a pipe)
+            auto frameSize = getFrameSize(position);
+            DecompressZstdFrameStream(position, frameSize);
+            position += frameSize;
+        }
+#endif
+    }
+
+    void DecompressingStreamBuffer::DecompressZstdFrameStream(const char* frame, size_t frameSize)
+    {
+#if defined(ELL_HAS_ZSTD)
+        std::unique_ptr<ZSTD_DStream, size_t (*)(ZSTD_DStream*)> stream(ZSTD_createDStream(), ZSTD_freeDStream);
+        ZSTD_initDStream(stream.get());
+        ZSTD_inBuffer input = { frame, frameSize, 0 };
+        size_t result = 1;
+        while (input.pos < input.size || result != 0)
+        {
+            std::vector<char> chunk(c_chunkSize);
+            ZSTD_outBuffer output = { chunk.data(), chunk.size(), 0 };
+            result = ZSTD_decompressStream(stream.get(), &output, &input);
+            if (ZSTD_isError(result))
+            {
+                throw InputException(InputExceptionErrors::badData, std::string("Error decompressing zstd file: ") + ZSTD_getErrorName(result));
+            }
+            if (output.pos == 0 && input.pos == input.size && result != 0)
+            {
+                throw InputException(InputExceptionErrors::badData, "Zstd file is truncated");
+            }
+            chunk.resize(output.pos);
+            if (!PushChunk(std::move(chunk)))
+            {
+                return;
+            }
+        }
+#else
+        (void)frame;
+        (void)frameSize;
+#endif
+    }
+
+    //
+    // DecompressingIfstream
+    //
+
+    DecompressingIfstream::DecompressingIfstream(const std::string& filepath, size_t numThreads) :
+        std::istream(nullptr),
+        _buffer(std::make_unique<DecompressingStreamBuffer>(filepath, numThreads))
+    {
+        rdbuf(_buffer.get());
+
+        // Decompression errors are thrown by the buffer, and would otherwise look like the end of the file
+        exceptions(std::ios_base::badbit);
+    }
+
+    std::unique_ptr<std::istream> OpenDecompressingIfstream(const std::string& filepath, size_t numThreads)
+    {
+        if (GetFileCompressionFormat(filepath) == CompressionFormat::none)
+        {
+            return std::make_unique<std::ifstream>(OpenIfstream(filepath));
+        }
+        return std::make_unique<DecompressingIfstream>(filepath, numThreads);
+    }
+
+    std::vector<char> ReadDecompressedFile(const std::string& filepath, size_t numThreads)
+    {
+        DecompressingStreamBuffer buffer(filepath, numThreads);
+        std::vector<char> result;
+        std::vector<char> data(c_chunkSize);
+        while (true)
+        {
+            auto size = buffer.sgetn(data.data(), static_cast<std::streamsize>(data.size()));
+            if (size <= 0)
+            {
+                break;
+            }
+            result.insert(result.end(), data.begin(), data.begin() + size);
+        }
+        return result;
+    }
+} // namespace utilities
+} // namespace ell
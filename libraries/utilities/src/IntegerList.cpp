@@ -9,6 +9,7 @@
 #include "IntegerList.h"
 #include "Exception.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace ell
@@ -21,6 +22,14 @@ namespace utilities
     {
     }
 
+    size_t IntegerList::Iterator::Read(size_t* buffer, size_t count)
+    {
+        auto numRead = std::min(count, static_cast<size_t>(_end - _begin));
+        std::copy_n(_begin, numRead, buffer);
+        _begin += numRead;
+        return numRead;
+    }
+
     void IntegerList::Reserve(size_t size)
     {
         _list.reserve(size);
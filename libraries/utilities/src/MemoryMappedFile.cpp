@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     MemoryMappedFile.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "MemoryMappedFile.h"
+#include "Exception.h"
+#include "Files.h"
+
+#include <iterator>
+#include <utility>
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+namespace ell
+{
+namespace utilities
+{
+    MemoryMappedFile::MemoryMappedFile(const std::string& filepath)
+    {
+#ifndef WIN32
+        int fileDescriptor = open(filepath.c_str(), O_RDONLY);
+        if (fileDescriptor < 0)
+        {
+            throw utilities::InputException(InputExceptionErrors::invalidArgument, "error opening file " + filepath);
+        }
+
+        struct stat fileInfo;
+        if (fstat(fileDescriptor, &fileInfo) != 0)
+        {
+            close(fileDescriptor);
+            throw utilities::InputException(InputExceptionErrors::invalidArgument, "error reading file " + filepath);
+        }
+
+        _size = static_cast<size_t>(fileInfo.st_size);
+        if (_size > 0)
+        {
+            // the mapping stays valid after the file is closed
+            void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+            if (data != MAP_FAILED)
+            {
+                madvise(data, _size, MADV_SEQUENTIAL);
+                _data = static_cast<const char*>(data);
+                _isMapped = true;
+            }
+        }
+        close(fileDescriptor);
+        if (_isMapped || _size == 0)
+        {
+            return;
+        }
+#endif // WIN32
+
+        // mapping isn't available (or failed), so read the whole file instead
+        auto stream = OpenBinaryIfstream(filepath);
+        _buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        _data = _buffer.data();
+        _size = _buffer.size();
+    }
+
+    MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) :
+        _size(other._size),
+        _buffer(std::move(other._buffer)),
+        _isMapped(other._isMapped)
+    {
+        _data = _isMapped ? other._data : _buffer.data();
+        other._data = nullptr;
+        other._size = 0;
+        other._isMapped = false;
+    }
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+#ifndef WIN32
+        if (_isMapped)
+        {
+            munmap(const_cast<char*>(_data), _size);
+        }
+#endif // WIN32
+    }
+} // namespace utilities
+} // namespace ell
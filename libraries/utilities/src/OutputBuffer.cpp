@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     OutputBuffer.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "OutputBuffer.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+namespace ell
+{
+namespace utilities
+{
+    namespace
+    {
+        const size_t c_maxNumberLength = 32;
+
+        // Formats a number at the end of a buffer with std::to_chars, which doesn't depend on the locale
+        template <typename ValueType>
+        void AppendNumber(std::vector<char>& data, ValueType value)
+        {
+            auto size = data.size();
+            data.resize(size + c_maxNumberLength);
+            auto result = std::to_chars(data.data() + size, data.data() + data.size(), value);
+            data.resize(result.ptr - data.data());
+        }
+
+#if !defined(__cpp_lib_to_chars)
+        // Standard libraries without floating-point to_chars get enough digits to read back the same value
+        void AppendFloatingPoint(std::vector<char>& data, double value, int precision)
+        {
+            char text[c_maxNumberLength];
+            auto length = std::snprintf(text, sizeof(text), "%.*g", precision, value);
+            data.insert(data.end(), text, text + length);
+        }
+#endif
+    } // namespace
+
+    OutputBuffer& OutputBuffer::operator<<(double value)
+    {
+#if defined(__cpp_lib_to_chars)
+        AppendNumber(_data, value);
+#else
+        AppendFloatingPoint(_data, value, 17);
+#endif
+        return *this;
+    }
+
+    OutputBuffer& OutputBuffer::operator<<(float value)
+    {
+#if defined(__cpp_lib_to_chars)
+        AppendNumber(_data, value);
+#else
+        AppendFloatingPoint(_data, value, 9);
+#endif
+        return *this;
+    }
+
+    void OutputBuffer::AppendInteger(long long value)
+    {
+        AppendNumber(_data, value);
+    }
+
+    void OutputBuffer::AppendInteger(unsigned long long value)
+    {
+        AppendNumber(_data, value);
+    }
+
+    void OutputBuffer::Write(const void* data, size_t size)
+    {
+        auto bytes = static_cast<const char*>(data);
+        _data.insert(_data.end(), bytes, bytes + size);
+    }
+
+    void OutputBuffer::Pad(size_t alignment)
+    {
+        _data.resize(_data.size() + (alignment - _data.size() % alignment) % alignment, 0);
+    }
+
+    void OutputBuffer::WriteTo(std::ostream& stream)
+    {
+        stream.write(_data.data(), static_cast<std::streamsize>(_data.size()));
+        _data.clear();
+    }
+} // namespace utilities
+} // namespace ell
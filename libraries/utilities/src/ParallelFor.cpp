@@ -0,0 +1,44 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ParallelFor.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace ell
+{
+namespace utilities
+{
+    namespace
+    {
+        thread_local bool isInParallelRegion = false;
+    }
+
+    size_t GetNumThreads(size_t numThreads)
+    {
+        return numThreads != 0 ? numThreads : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    bool IsInParallelRegion()
+    {
+        return isInParallelRegion;
+    }
+
+    ParallelRegion::ParallelRegion() :
+        _wasInParallelRegion(isInParallelRegion)
+    {
+        isInParallelRegion = true;
+    }
+
+    ParallelRegion::~ParallelRegion()
+    {
+        isInParallelRegion = _wasInParallelRegion;
+    }
+} // namespace utilities
+} // namespace ell
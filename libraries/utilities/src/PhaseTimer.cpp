@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PhaseTimer.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PhaseTimer.h"
+#include "StringUtil.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+
+namespace ell
+{
+namespace utilities
+{
+    namespace
+    {
+        std::atomic<bool> g_phaseTimingEnabled{ false };
+
+        // The timings of all threads, and the phases running on this one
+        std::mutex g_phaseTimingsMutex;
+        PhaseTiming g_phaseTimings;
+        thread_local std::vector<std::string> t_runningPhases;
+
+        PhaseTiming& GetChild(PhaseTiming& phase, const std::string& name)
+        {
+            auto it = std::find_if(phase.children.begin(), phase.children.end(), [&name](const PhaseTiming& child) { return child.name == name; });
+            if (it != phase.children.end())
+            {
+                return *it;
+            }
+            phase.children.push_back({ name, 0, 0, {} });
+            return phase.children.back();
+        }
+
+        void WriteJson(std::ostream& stream, const std::vector<PhaseTiming>& phases, const std::string& indent)
+        {
+            stream << "[";
+            for (size_t index = 0; index < phases.size(); ++index)
+            {
+                const auto& phase = phases[index];
+                stream << (index == 0 ? "\n" : ",\n") << indent << "  { \"name\": " << QuoteJsonString(phase.name) << ", \"milliseconds\": " << phase.milliseconds << ", \"count\": " << phase.count << ", \"children\": ";
+                WriteJson(stream, phase.children, indent + "  ");
+                stream << " }";
+            }
+            stream << (phases.empty() ? "]" : "\n" + indent + "]");
+        }
+
+        void WriteText(std::ostream& stream, const std::vector<PhaseTiming>& phases, const std::string& indent)
+        {
+            for (const auto& phase : phases)
+            {
+                stream << indent << phase.name << ": " << std::fixed << std::setprecision(3) << phase.milliseconds << " ms";
+                if (phase.count > 1)
+                {
+                    stream << " (" << phase.count << " times)";
+                }
+                stream << "\n";
+                WriteText(stream, phase.children, indent + "  ");
+            }
+        }
+    } // namespace
+
+    PhaseTimer::PhaseTimer(const std::string& name) :
+        _enabled(g_phaseTimingEnabled)
+    {
+        if (_enabled)
+        {
+            t_runningPhases.push_back(name);
+            _start = std::chrono::steady_clock::now();
+        }
+    }
+
+    PhaseTimer::~PhaseTimer()
+    {
+        Stop();
+    }
+
+    void PhaseTimer::Stop()
+    {
+        if (!_enabled)
+        {
+            return;
+        }
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - _start;
+        {
+            std::lock_guard<std::mutex> lock(g_phaseTimingsMutex);
+            auto phase = &g_phaseTimings;
+            for (const auto& name : t_runningPhases)
+            {
+                phase = &GetChild(*phase, name);
+            }
+            phase->milliseconds += elapsed.count();
+            ++phase->count;
+        }
+        t_runningPhases.pop_back();
+        _enabled = false;
+    }
+
+    void EnablePhaseTiming(bool enable)
+    {
+        g_phaseTimingEnabled = enable;
+    }
+
+    bool IsPhaseTimingEnabled()
+    {
+        return g_phaseTimingEnabled;
+    }
+
+    PhaseTiming GetPhaseTimings()
+    {
+        std::lock_guard<std::mutex> lock(g_phaseTimingsMutex);
+        return g_phaseTimings;
+    }
+
+    void ResetPhaseTimings()
+    {
+        std::lock_guard<std::mutex> lock(g_phaseTimingsMutex);
+        g_phaseTimings = {};
+    }
+
+    void WritePhaseTimingsJson(std::ostream& stream)
+    {
+        WriteJson(stream, GetPhaseTimings().children, "");
+        stream << "\n";
+    }
+
+    void WritePhaseTimings(std::ostream& stream)
+    {
+        auto flags = stream.flags();
+        auto precision = stream.precision();
+        WriteText(stream, GetPhaseTimings().children, "");
+        stream.flags(flags);
+        stream.precision(precision);
+    }
+} // namespace utilities
+} // namespace ell
@@ -0,0 +1,285 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PoolAllocator.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PoolAllocator.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace ell
+{
+namespace utilities
+{
+    namespace
+    {
+        // Size classes are the multiples of 64 bytes up to 256, then 4 classes per power of two, so that rounding up
+        // wastes at most a quarter of a block. The biggest class is 4 MB.
+        constexpr size_t smallClassSize = 64;
+        constexpr size_t numSmallClasses = 4;
+        constexpr size_t classesPerPowerOfTwo = 4;
+        constexpr size_t firstLargeLog2 = 8;
+        constexpr size_t lastLargeLog2 = 21;
+        constexpr size_t numClasses = numSmallClasses + (lastLargeLog2 - firstLargeLog2 + 1) * classesPerPowerOfTwo;
+        constexpr size_t maxClassSize = size_t(1) << (lastLargeLog2 + 1);
+
+        // The most bytes a thread keeps for reuse
+        constexpr size_t maxCachedSize = size_t(32) << 20;
+
+        // Reads the exponent of n's floating-point representation, which is exact for the sizes that have a class
+        size_t FloorLog2(size_t n)
+        {
+            auto value = static_cast<double>(n);
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return static_cast<size_t>((bits >> 52) & 0x7ff) - 1023;
+        }
+
+        size_t GetSizeClass(size_t size)
+        {
+            if (size <= numSmallClasses * smallClassSize)
+            {
+                return size == 0 ? 0 : (size - 1) / smallClassSize;
+            }
+
+            auto log2 = FloorLog2(size - 1);
+            auto base = size_t(1) << log2;
+            auto step = base / classesPerPowerOfTwo;
+            auto subClass = (size - base + step - 1) / step;
+            return numSmallClasses + (log2 - firstLargeLog2) * classesPerPowerOfTwo + subClass - 1;
+        }
+
+        size_t GetClassSize(size_t sizeClass)
+        {
+            if (sizeClass < numSmallClasses)
+            {
+                return (sizeClass + 1) * smallClassSize;
+            }
+
+            auto largeClass = sizeClass - numSmallClasses;
+            auto base = size_t(1) << (firstLargeLog2 + largeClass / classesPerPowerOfTwo);
+            return base + (largeClass % classesPerPowerOfTwo + 1) * (base / classesPerPowerOfTwo);
+        }
+
+        void* HeapAllocate(size_t size)
+        {
+            return ::operator new(size, std::align_val_t(poolAlignment));
+        }
+
+        void HeapFree(void* p)
+        {
+            ::operator delete(p, std::align_val_t(poolAlignment));
+        }
+
+        std::atomic<bool> useHugePages{ false };
+
+        // The blocks mapped with huge pages, and their mapped lengths. It's never destroyed, so containers with
+        // static storage duration can free their blocks at exit.
+        struct HugePageBlocks
+        {
+            std::mutex mutex;
+            std::unordered_map<void*, size_t> lengths;
+        };
+
+        HugePageBlocks& GetHugePageBlocks()
+        {
+            static auto blocks = new HugePageBlocks();
+            return *blocks;
+        }
+
+        // Requests bigger than the biggest size class skip the pool
+        void* LargeAllocate(size_t size)
+        {
+#if defined(__linux__)
+            if (useHugePages)
+            {
+                // Map an extra huge page, and trim the mapping to start on a huge page boundary, so the kernel can back
+                // the whole block with huge pages
+                auto length = (size + poolHugePageSize - 1) / poolHugePageSize * poolHugePageSize;
+                auto mapped = mmap(nullptr, length + poolHugePageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (mapped != MAP_FAILED)
+                {
+                    auto begin = reinterpret_cast<uintptr_t>(mapped);
+                    auto alignedBegin = (begin + poolHugePageSize - 1) / poolHugePageSize * poolHugePageSize;
+                    if (alignedBegin > begin)
+                    {
+                        munmap(mapped, alignedBegin - begin);
+                    }
+                    if (begin + poolHugePageSize > alignedBegin)
+                    {
+                        munmap(reinterpret_cast<void*>(alignedBegin + length), begin + poolHugePageSize - alignedBegin);
+                    }
+
+                    auto block = reinterpret_cast<void*>(alignedBegin);
+                    madvise(block, length, MADV_HUGEPAGE);
+                    auto& blocks = GetHugePageBlocks();
+                    std::lock_guard<std::mutex> lock(blocks.mutex);
+                    blocks.lengths[block] = length;
+                    return block;
+                }
+            }
+#endif
+            return HeapAllocate(size);
+        }
+
+        void LargeFree(void* p)
+        {
+#if defined(__linux__)
+            auto& blocks = GetHugePageBlocks();
+            std::unique_lock<std::mutex> lock(blocks.mutex);
+            auto it = blocks.lengths.find(p);
+            if (it != blocks.lengths.end())
+            {
+                auto length = it->second;
+                blocks.lengths.erase(it);
+                lock.unlock();
+                munmap(p, length);
+                return;
+            }
+#endif
+            HeapFree(p);
+        }
+
+        void* AllocateBlock(size_t size)
+        {
+            return size > maxClassSize ? LargeAllocate(size) : HeapAllocate(size);
+        }
+
+        void FreeBlock(void* p, size_t size)
+        {
+            if (size > maxClassSize)
+            {
+                LargeFree(p);
+            }
+            else
+            {
+                HeapFree(p);
+            }
+        }
+
+        // Set when the calling thread's pool has been destroyed, so that containers that outlive it, like ones with
+        // static storage duration, go straight to the heap
+        thread_local bool isThreadPoolDestroyed = false;
+
+        class ThreadPool
+        {
+        public:
+            ~ThreadPool()
+            {
+                isThreadPoolDestroyed = true;
+                for (auto& freeList : _freeLists)
+                {
+                    for (auto p : freeList)
+                    {
+                        HeapFree(p);
+                    }
+                }
+            }
+
+            void* Allocate(size_t size)
+            {
+                if (size > maxClassSize)
+                {
+                    return LargeAllocate(size);
+                }
+
+                auto sizeClass = GetSizeClass(size);
+                auto& freeList = _freeLists[sizeClass];
+                if (freeList.empty())
+                {
+                    return HeapAllocate(GetClassSize(sizeClass));
+                }
+
+                auto result = freeList.back();
+                freeList.pop_back();
+                _cachedSize -= GetClassSize(sizeClass);
+                return result;
+            }
+
+            void Deallocate(void* p, size_t size)
+            {
+                if (size > maxClassSize)
+                {
+                    LargeFree(p);
+                    return;
+                }
+
+                auto sizeClass = GetSizeClass(size);
+                auto classSize = GetClassSize(sizeClass);
+                if (_cachedSize + classSize > maxCachedSize)
+                {
+                    HeapFree(p);
+                    return;
+                }
+
+                _freeLists[sizeClass].push_back(p);
+                _cachedSize += classSize;
+            }
+
+            size_t GetCachedSize() const { return _cachedSize; }
+
+        private:
+            std::array<std::vector<void*>, numClasses> _freeLists;
+            size_t _cachedSize = 0;
+        };
+
+        ThreadPool& GetThreadPool()
+        {
+            thread_local ThreadPool pool;
+            return pool;
+        }
+    } // namespace
+
+    void* PoolAllocate(size_t size)
+    {
+        if (isThreadPoolDestroyed)
+        {
+            return AllocateBlock(size);
+        }
+        return GetThreadPool().Allocate(size);
+    }
+
+    void PoolDeallocate(void* p, size_t size)
+    {
+        if (p == nullptr)
+        {
+            return;
+        }
+
+        if (isThreadPoolDestroyed)
+        {
+            FreeBlock(p, size);
+            return;
+        }
+        GetThreadPool().Deallocate(p, size);
+    }
+
+    size_t GetPoolCachedSize()
+    {
+        return isThreadPoolDestroyed ? 0 : GetThreadPool().GetCachedSize();
+    }
+
+    void SetPoolHugePages(bool enable)
+    {
+        useHugePages = enable;
+    }
+
+    bool GetPoolHugePages()
+    {
+        return useHugePages;
+    }
+} // namespace utilities
+} // namespace ell
@@ -102,6 +102,50 @@ namespace utilities
         return result;
     }
 
+    std::string QuoteJsonString(const std::string& s)
+    {
+        std::string result = "\"";
+        for (char c : s)
+        {
+            switch (c)
+            {
+            case '"':
+                result += "\\\"";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            case '\b':
+                result += "\\b";
+                break;
+            case '\f':
+                result += "\\f";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            case '\r':
+                result += "\\r";
+                break;
+            case '\t':
+                result += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escaped[7];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+                    result += escaped;
+                }
+                else
+                {
+                    result += c;
+                }
+            }
+        }
+        return result + "\"";
+    }
+
     template <>
     bool FromString(const std::string& s)
     {
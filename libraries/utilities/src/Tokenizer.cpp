@@ -10,8 +10,11 @@
 #include "Exception.h"
 #include "Files.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <charconv>
+#include <cstdlib>
 #include <istream>
 #include <ostream>
 #include <sstream>
@@ -19,6 +22,9 @@
 // Note: BUFFER_SIZE must be larger than the largest readable token
 #define BUFFER_SIZE 1024 * 1024
 
+// The number of characters ReadNumbers makes sure are in the buffer before parsing a number
+#define MAX_NUMBER_LENGTH 64
+
 namespace ell
 {
 namespace utilities
@@ -200,6 +206,92 @@ namespace utilities
         }
     }
 
+    void Tokenizer::BeginReadingNumbers()
+    {
+        if (!_peekedTokens.empty() || _currentStringDelimiter != '\0')
+        {
+            throw LogicException(LogicExceptionErrors::illegalState, "Can't read numbers after peeking at tokens or in the middle of a string");
+        }
+        _tokenStart = _currentPosition;
+    }
+
+    int Tokenizer::ReadNonWhitespaceCharacter()
+    {
+        while (true)
+        {
+            // Keep the character in the buffer when it is refilled, so it can be put back
+            _tokenStart = _currentPosition;
+            auto result = GetNextCharacter();
+            if (result == EOF || !std::isspace(result))
+            {
+                return result;
+            }
+        }
+    }
+
+    const char* Tokenizer::GetNumberStart()
+    {
+        if (_bufferEnd - _currentPosition < MAX_NUMBER_LENGTH && _in)
+        {
+            _tokenStart = _currentPosition;
+            ReadData();
+        }
+        return _textBuffer.data() + (_currentPosition - _textBuffer.begin());
+    }
+
+    const char* Tokenizer::GetBufferEnd() const
+    {
+        return _textBuffer.data() + (_bufferEnd - _textBuffer.begin());
+    }
+
+    size_t Tokenizer::CountRemainingItems(char delimiter, char terminator) const
+    {
+        auto terminatorPosition = std::find(_currentPosition, _bufferEnd, terminator);
+        if (terminatorPosition == _bufferEnd)
+        {
+            return 0;
+        }
+        return static_cast<size_t>(std::count(_currentPosition, terminatorPosition, delimiter)) + 1;
+    }
+
+    void Tokenizer::ThrowUnexpectedCharacter(int ch) const
+    {
+        auto found = ch == EOF ? std::string{ "end of file" } : std::string(1, static_cast<char>(ch));
+        throw InputException(InputExceptionErrors::badStringFormat, "Failed to read a list of numbers, got: " + found);
+    }
+
+    const char* Tokenizer::ParseNumber(const char* begin, const char* end, int64_t& value)
+    {
+        auto [numberEnd, error] = std::from_chars(begin, end, value);
+        if (error != std::errc())
+        {
+            throw InputException(InputExceptionErrors::badStringFormat, "Failed to parse an integer");
+        }
+        return numberEnd;
+    }
+
+    const char* Tokenizer::ParseNumber(const char* begin, const char* end, uint64_t& value)
+    {
+        auto [numberEnd, error] = std::from_chars(begin, end, value);
+        if (error != std::errc())
+        {
+            throw InputException(InputExceptionErrors::badStringFormat, "Failed to parse an integer");
+        }
+        return numberEnd;
+    }
+
+    const char* Tokenizer::ParseNumber(const char* begin, const char* end, double& value)
+    {
+        // The buffer is null-terminated, so strtod stops at its end
+        char* numberEnd = nullptr;
+        value = std::strtod(begin, &numberEnd);
+        if (numberEnd == begin || numberEnd > end)
+        {
+            throw InputException(InputExceptionErrors::badStringFormat, "Failed to parse a number");
+        }
+        return numberEnd;
+    }
+
     bool Tokenizer::IsValid()
     {
         return static_cast<bool>(_in) || !_textBuffer.empty() || !_peekedTokens.empty();
@@ -235,7 +327,8 @@ namespace utilities
         auto oldOffset = _currentPosition - _tokenStart;
         if (_textBuffer.empty())
         {
-            _textBuffer.resize(BUFFER_SIZE, '\0');
+            // one extra character for the null terminator
+            _textBuffer.resize(BUFFER_SIZE + 1, '\0');
             _bufferEnd = _textBuffer.end();
         }
         else
@@ -245,12 +338,13 @@ namespace utilities
         }
 
         auto newPtr = _textBuffer.data() + oldLength;
-        auto maxLength = _textBuffer.size() - oldLength;
+        auto maxLength = _textBuffer.size() - 1 - oldLength;
 
         // read into buffer
         _in.read(newPtr, maxLength);
         auto amountRead = _in.gcount();
         _bufferEnd = _textBuffer.begin() + oldLength + amountRead;
+        *_bufferEnd = '\0';
         _tokenStart = _textBuffer.begin();
         _currentPosition = _tokenStart + oldOffset;
     }
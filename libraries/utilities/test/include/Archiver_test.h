@@ -16,6 +16,9 @@ void TestArchiveVersion();
 void TestJsonArchiver();
 void TestJsonUnarchiver();
 
+void TestBinaryArchiver();
+void TestBinaryUnarchiver();
+
 void TestXmlArchiver();
 void TestXmlUnarchiver();
 } // namespace ell
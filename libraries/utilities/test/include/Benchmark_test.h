@@ -0,0 +1,16 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     Benchmark_test.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+namespace ell
+{
+void TestReadBenchmarkResults();
+void TestReadMalformedBenchmarkResults();
+void TestCompareBenchmarkResults();
+} // namespace ell
@@ -0,0 +1,15 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ConcurrentRingBuffer_test.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+namespace ell
+{
+void TestConcurrentRingBuffer();
+void TestConcurrentRingBufferThreads();
+} // namespace ell
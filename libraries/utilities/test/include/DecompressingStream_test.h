@@ -0,0 +1,18 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DecompressingStream_test.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <string>
+
+namespace ell
+{
+void TestDecompressingStreamUncompressed(const std::string& basePath);
+void TestDecompressingStreamGzip(const std::string& basePath);
+void TestDecompressingStreamZstd(const std::string& basePath);
+} // namespace ell
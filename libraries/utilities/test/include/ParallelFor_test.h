@@ -0,0 +1,18 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ParallelFor_test.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+namespace ell
+{
+void TestParallelFor();
+void TestParallelForRanges();
+void TestParallelForDynamic();
+void TestParallelForExceptions();
+void TestParallelForNesting();
+} // namespace ell
@@ -0,0 +1,17 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PoolAllocator_test.h (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+namespace ell
+{
+void TestPoolAllocatorAlignment();
+void TestPoolAllocatorReuse();
+void TestPoolAllocatorThreads();
+void TestPoolAllocatorHugePages();
+} // namespace ell
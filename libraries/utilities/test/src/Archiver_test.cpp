@@ -9,6 +9,7 @@
 #include "Archiver_test.h"
 
 #include <utilities/include/Archiver.h>
+#include <utilities/include/BinaryArchiver.h>
 #include <utilities/include/IArchivable.h>
 #include <utilities/include/JsonArchiver.h>
 #include <utilities/include/UniqueId.h>
@@ -236,6 +237,24 @@ void TestUnarchiver()
         unarchiver.Unarchive("pi", val);
         testing::ProcessTest(name + "Deserialize float check", val == 3.14159);
     }
+    {
+        // values that need every significant digit to round-trip
+        const double doubleVal = 0.1 + 0.2;
+        const float floatVal = 1.0f / 3.0f;
+        std::stringstream strstream;
+        {
+            ArchiverType archiver(strstream);
+            archiver.Archive("double", doubleVal);
+            archiver.Archive("float", floatVal);
+        }
+
+        UnarchiverType unarchiver(strstream, context);
+        double newDoubleVal = 0;
+        float newFloatVal = 0;
+        unarchiver.Unarchive("double", newDoubleVal);
+        unarchiver.Unarchive("float", newFloatVal);
+        testing::ProcessTest(name + "Deserialize floating-point values exactly", newDoubleVal == doubleVal && newFloatVal == floatVal);
+    }
 
     {
         std::stringstream strstream;
@@ -359,6 +378,76 @@ void TestJsonArchiver()
 void TestJsonUnarchiver()
 {
     TestUnarchiver<utilities::JsonArchiver, utilities::JsonUnarchiver>();
+
+    // arrays larger than the tokenizer's buffer
+    utilities::SerializationContext context;
+    std::vector<double> doubleArray(200000);
+    std::vector<int64_t> intArray(200000);
+    for (size_t index = 0; index < doubleArray.size(); ++index)
+    {
+        doubleArray[index] = index * 0.25 - 1000.5;
+        intArray[index] = -static_cast<int64_t>(index * index);
+    }
+
+    std::stringstream strstream;
+    {
+        utilities::JsonArchiver archiver(strstream);
+        archiver.Archive("doubles", doubleArray);
+        archiver.Archive("empty", std::vector<float>{});
+        archiver.Archive("ints", intArray);
+    }
+
+    utilities::JsonUnarchiver unarchiver(strstream, context);
+    std::vector<double> newDoubleArray;
+    std::vector<float> newEmptyArray;
+    std::vector<int64_t> newIntArray;
+    unarchiver.Unarchive("doubles", newDoubleArray);
+    unarchiver.Unarchive("empty", newEmptyArray);
+    unarchiver.Unarchive("ints", newIntArray);
+    testing::ProcessTest("JsonUnarchiver: Deserialize large arrays", newDoubleArray == doubleArray && newEmptyArray.empty() && newIntArray == intArray);
+}
+
+void TestBinaryArchiver()
+{
+    TestArchiver<utilities::BinaryArchiver>();
+}
+
+void TestBinaryUnarchiver()
+{
+    TestUnarchiver<utilities::BinaryArchiver, utilities::BinaryUnarchiver>();
+
+    utilities::SerializationContext context;
+    {
+        // values are converted when they are read as a different type
+        std::stringstream strstream;
+        {
+            utilities::BinaryArchiver archiver(strstream);
+            archiver.Archive("size", 7);
+            archiver.Archive("arr", std::vector<float>{ 1.5f, 2.5f });
+        }
+
+        utilities::BinaryUnarchiver unarchiver(strstream, context);
+        uint64_t size = 0;
+        std::vector<double> arr;
+        unarchiver.Unarchive("size", size);
+        unarchiver.Unarchive("arr", arr);
+        testing::ProcessTest("BinaryUnarchiver: Deserialize converted values", size == 7 && testing::IsEqual(arr, std::vector<double>{ 1.5, 2.5 }));
+    }
+
+    {
+        // the data of numeric arrays is aligned, so it can be used in place
+        std::stringstream strstream;
+        std::vector<double> arr(100, 0.5);
+        {
+            utilities::BinaryArchiver archiver(strstream);
+            archiver.Archive("name", std::string{ "abc" });
+            archiver.Archive("arr", arr);
+        }
+
+        auto archive = strstream.str();
+        auto dataOffset = archive.size() - arr.size() * sizeof(double);
+        testing::ProcessTest("BinaryArchiver: array alignment", dataOffset % utilities::BinaryArchiverImpl::arrayAlignment == 0);
+    }
 }
 
 void TestXmlArchiver()
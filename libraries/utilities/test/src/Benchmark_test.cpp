@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     Benchmark_test.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmark_test.h"
+
+#include <testing/include/Benchmark.h>
+#include <testing/include/testing.h>
+
+#include <utilities/include/Exception.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace
+{
+    testing::BenchmarkResult MakeResult(const std::string& name, double medianSeconds, double p90Seconds)
+    {
+        testing::BenchmarkResult result;
+        result.name = name;
+        result.numSamples = 11;
+        result.callsPerSample = 1;
+        result.minSeconds = medianSeconds * 0.9;
+        result.p10Seconds = medianSeconds * 0.95;
+        result.medianSeconds = medianSeconds;
+        result.p90Seconds = p90Seconds;
+        return result;
+    }
+} // namespace
+
+void TestReadBenchmarkResults()
+{
+    testing::BenchmarkOptions options;
+    options.numSamples = 3;
+    options.minSampleSeconds = 0;
+    testing::BenchmarkSuite suite("Benchmark \"suite\"", options);
+    suite.SetVerbose(false);
+    volatile int counter = 0;
+    suite.Run("increment", 1, [&counter] { counter = counter + 1; });
+    suite.Run("name with \"quotes\", a \\ and a\ttab", 0, [&counter] { counter = counter + 2; });
+
+    std::stringstream stream;
+    suite.WriteJson(stream);
+    auto results = testing::ReadBenchmarkResults(stream);
+
+    const auto& expected = suite.GetResults();
+    bool ok = results.size() == expected.size();
+    for (size_t index = 0; ok && index < results.size(); ++index)
+    {
+        ok = results[index].name == expected[index].name &&
+             results[index].numSamples == expected[index].numSamples &&
+             results[index].callsPerSample == expected[index].callsPerSample &&
+             results[index].flops == expected[index].flops &&
+             results[index].minSeconds == expected[index].minSeconds &&
+             results[index].medianSeconds == expected[index].medianSeconds &&
+             results[index].p10Seconds == expected[index].p10Seconds &&
+             results[index].p90Seconds == expected[index].p90Seconds;
+    }
+    testing::ProcessTest("Testing ReadBenchmarkResults reads what WriteJson writes", ok);
+
+    // A suite with no results
+    std::stringstream emptyStream;
+    testing::BenchmarkSuite("empty").WriteJson(emptyStream);
+    testing::ProcessTest("Testing ReadBenchmarkResults with no results", testing::ReadBenchmarkResults(emptyStream).empty());
+}
+
+void TestReadMalformedBenchmarkResults()
+{
+    for (std::string text : { "", "{", "[]", "{\"suite\": \"s\", \"benchmarks\": [{\"name\": 3}]}" })
+    {
+        std::stringstream stream(text);
+        bool threw = false;
+        try
+        {
+            testing::ReadBenchmarkResults(stream);
+        }
+        catch (const utilities::Exception&)
+        {
+            threw = true;
+        }
+        testing::ProcessTest("Testing ReadBenchmarkResults rejects malformed results '" + text + "'", threw);
+    }
+}
+
+void TestCompareBenchmarkResults()
+{
+    std::vector<testing::BenchmarkResult> baseline = {
+        MakeResult("slower", 1.0, 1.05),
+        MakeResult("within tolerance", 1.0, 1.05),
+        MakeResult("noisy", 1.0, 1.5),
+        MakeResult("faster", 1.0, 1.05),
+        MakeResult("only in baseline", 1.0, 1.05),
+        MakeResult("no baseline time", 0.0, 0.0),
+    };
+    std::vector<testing::BenchmarkResult> current = {
+        MakeResult("slower", 1.2, 1.3),
+        MakeResult("within tolerance", 1.05, 1.1),
+        MakeResult("noisy", 1.3, 1.4),
+        MakeResult("faster", 0.5, 0.6),
+        MakeResult("only in current", 1.0, 1.05),
+        MakeResult("no baseline time", 1.0, 1.05),
+    };
+
+    auto comparisons = testing::CompareBenchmarkResults(baseline, current, 0.1);
+    testing::ProcessTest("Testing CompareBenchmarkResults only compares benchmarks in both results", comparisons.size() == 4);
+    if (comparisons.size() != 4)
+    {
+        return;
+    }
+
+    // The comparisons are in the order of the current results
+    testing::ProcessTest("Testing CompareBenchmarkResults order", comparisons[0].name == "slower" && comparisons[1].name == "within tolerance" && comparisons[2].name == "noisy" && comparisons[3].name == "faster");
+    testing::ProcessTest("Testing CompareBenchmarkResults finds a regression", comparisons[0].isRegression && testing::IsEqual(comparisons[0].GetRatio(), 1.2));
+    testing::ProcessTest("Testing CompareBenchmarkResults tolerance", !comparisons[1].isRegression);
+    testing::ProcessTest("Testing CompareBenchmarkResults ignores slowdowns within the baseline's p90", !comparisons[2].isRegression);
+    testing::ProcessTest("Testing CompareBenchmarkResults with a faster result", !comparisons[3].isRegression && testing::IsEqual(comparisons[3].GetRatio(), 0.5));
+}
+} // namespace ell
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ConcurrentRingBuffer_test.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ConcurrentRingBuffer_test.h"
+
+#include <utilities/include/ConcurrentRingBuffer.h>
+
+#include <testing/include/testing.h>
+
+#include <thread>
+#include <vector>
+
+namespace ell
+{
+using namespace utilities;
+
+void TestConcurrentRingBuffer()
+{
+    ConcurrentRingBuffer<int> buffer(3);
+    bool ok = buffer.Size() == 0 && buffer.BeginPop() == nullptr;
+
+    ok = ok && buffer.TryPush(1) && buffer.TryPush(2) && buffer.TryPush(3);
+    ok = ok && !buffer.TryPush(4) && buffer.Size() == 3; // full
+
+    int value = 0;
+    ok = ok && buffer.TryPop(value) && value == 1;
+    ok = ok && buffer.TryPush(4); // wraps around
+
+    std::vector<int> values;
+    while (auto slot = buffer.BeginPop())
+    {
+        values.push_back(*slot);
+        buffer.EndPop();
+    }
+    ok = ok && values == std::vector<int>({ 2, 3, 4 }) && buffer.Size() == 0;
+
+    testing::ProcessTest("TestConcurrentRingBuffer", ok);
+}
+
+void TestConcurrentRingBufferThreads()
+{
+    const int numItems = 100000;
+    ConcurrentRingBuffer<std::vector<int>> buffer(4, std::vector<int>(8));
+
+    std::thread producer([&] {
+        for (int index = 0; index < numItems; ++index)
+        {
+            std::vector<int>* slot;
+            while ((slot = buffer.BeginPush()) == nullptr)
+            {
+                std::this_thread::yield();
+            }
+            std::fill(slot->begin(), slot->end(), index);
+            buffer.EndPush();
+        }
+    });
+
+    bool ok = true;
+    for (int index = 0; index < numItems; ++index)
+    {
+        std::vector<int>* slot;
+        while ((slot = buffer.BeginPop()) == nullptr)
+        {
+            std::this_thread::yield();
+        }
+        ok = ok && *slot == std::vector<int>(8, index);
+        buffer.EndPop();
+    }
+    producer.join();
+
+    testing::ProcessTest("TestConcurrentRingBufferThreads", ok && buffer.Size() == 0);
+}
+} // namespace ell
@@ -0,0 +1,208 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     DecompressingStream_test.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "DecompressingStream_test.h"
+
+#include <utilities/include/DecompressingStream.h>
+#include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
+
+#include <testing/include/testing.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+namespace
+{
+    std::string GetTestText(int numLines)
+    {
+        std::string text;
+        for (int line = 0; line < numLines; ++line)
+        {
+            text += std::to_string(line % 2 == 0 ? 1 : -1) + " 0:" + std::to_string(line) + " 3:0.5\n";
+        }
+        return text;
+    }
+
+    void WriteFile(const std::string& filepath, const std::string& contents)
+    {
+        auto stream = utilities::OpenBinaryOfstream(filepath);
+        stream.write(contents.data(), contents.size());
+    }
+
+    std::string ReadLines(std::istream& stream)
+    {
+        std::string result;
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            result += line + "\n";
+        }
+        return result;
+    }
+
+    void AppendLittleEndian(std::string& data, uint32_t value, int numBytes)
+    {
+        for (int index = 0; index < numBytes; ++index)
+        {
+            data.push_back(static_cast<char>((value >> (8 * index)) & 0xff));
+        }
+    }
+
+    uint32_t Crc32(const std::string& data)
+    {
+        uint32_t crc = 0xffffffff;
+        for (auto c : data)
+        {
+            crc ^= static_cast<unsigned char>(c);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+            }
+        }
+        return ~crc;
+    }
+
+    // A gzip member with the text in uncompressed (stored) deflate blocks
+    std::string MakeGzipMember(const std::string& text)
+    {
+        std::string result = { '\x1f', '\x8b', '\x08', '\0', '\0', '\0', '\0', '\0', '\0', '\xff' };
+        const size_t maxBlockSize = 0xffff;
+        size_t position = 0;
+        do
+        {
+            auto blockSize = std::min(maxBlockSize, text.size() - position);
+            auto isLast = position + blockSize == text.size();
+            result.push_back(isLast ? '\x01' : '\0');
+            AppendLittleEndian(result, static_cast<uint32_t>(blockSize), 2);
+            AppendLittleEndian(result, static_cast<uint32_t>(~blockSize), 2);
+            result += text.substr(position, blockSize);
+            position += blockSize;
+        } while (position < text.size());
+        AppendLittleEndian(result, Crc32(text), 4);
+        AppendLittleEndian(result, static_cast<uint32_t>(text.size()), 4);
+        return result;
+    }
+
+    // A zstd frame with the text (less than 1 KB) in one raw block, which says how large it is or not
+    std::string MakeZstdFrame(const std::string& text, bool hasContentSize)
+    {
+        std::string result = { '\x28', '\xb5', '\x2f', '\xfd' };
+        if (hasContentSize)
+        {
+            result += { '\x60' }; // single segment, 2-byte content size
+            AppendLittleEndian(result, static_cast<uint32_t>(text.size() - 256), 2);
+        }
+        else
+        {
+            result += { '\0', '\0' }; // 1 KB window
+        }
+        AppendLittleEndian(result, static_cast<uint32_t>(text.size() << 3 | 1), 3); // last block, raw
+        return result + text;
+    }
+
+    void TestDecompressedContents(const std::string& filepath, const std::string& text, const std::string& name)
+    {
+        auto stream = utilities::OpenDecompressingIfstream(filepath, 2);
+        testing::ProcessTest("Testing " + name + " contents", ReadLines(*stream) == text);
+
+        // Seeking forward skips over the decompressed data
+        auto seekStream = utilities::OpenDecompressingIfstream(filepath, 2);
+        std::string line;
+        std::getline(*seekStream, line);
+        auto offset = static_cast<size_t>(seekStream->tellg());
+        seekStream->seekg(text.size() / 2);
+        auto offsetAfterSeek = static_cast<size_t>(seekStream->tellg());
+        testing::ProcessTest("Testing " + name + " seek", offset == line.size() + 1 && offsetAfterSeek == text.size() / 2 && ReadLines(*seekStream) == text.substr(text.size() / 2));
+
+        auto contents = utilities::ReadDecompressedFile(filepath);
+        testing::ProcessTest("Testing " + name + " read into memory", std::string(contents.begin(), contents.end()) == text);
+    }
+
+    template <typename FunctionType>
+    bool Throws(FunctionType&& function)
+    {
+        try
+        {
+            function();
+        }
+        catch (const utilities::Exception&)
+        {
+            return true;
+        }
+        return false;
+    }
+} // namespace
+
+void TestDecompressingStreamUncompressed(const std::string& basePath)
+{
+    auto filepath = utilities::JoinPaths(basePath, "decompressing_stream_test.txt");
+    auto text = GetTestText(100);
+    WriteFile(filepath, text);
+
+    testing::ProcessTest("Testing uncompressed file format", utilities::GetFileCompressionFormat(filepath) == utilities::CompressionFormat::none);
+    auto stream = utilities::OpenDecompressingIfstream(filepath);
+    testing::ProcessTest("Testing uncompressed file contents", ReadLines(*stream) == text);
+}
+
+void TestDecompressingStreamGzip(const std::string& basePath)
+{
+    // Several members, like `bgzip` writes, with more than one deflate block
+    auto filepath = utilities::JoinPaths(basePath, "decompressing_stream_test.txt.gz");
+    auto text = GetTestText(20000);
+    WriteFile(filepath, MakeGzipMember(text.substr(0, 1000)) + MakeGzipMember(text.substr(1000)));
+    testing::ProcessTest("Testing gzip file format", utilities::GetFileCompressionFormat(filepath) == utilities::CompressionFormat::gzip);
+    if (!utilities::IsCompressionFormatAvailable(utilities::CompressionFormat::gzip))
+    {
+        std::cout << "Skipping gzip tests: built without zlib" << std::endl;
+        return;
+    }
+    TestDecompressedContents(filepath, text, "gzip file");
+
+    auto truncatedFilepath = utilities::JoinPaths(basePath, "decompressing_stream_test_truncated.txt.gz");
+    auto member = MakeGzipMember(text);
+    WriteFile(truncatedFilepath, member.substr(0, member.size() / 2));
+    testing::ProcessTest("Testing truncated gzip file", Throws([&] {
+                             auto stream = utilities::OpenDecompressingIfstream(truncatedFilepath);
+                             ReadLines(*stream);
+                         }));
+}
+
+void TestDecompressingStreamZstd(const std::string& basePath)
+{
+    // Frames that say how large they are are decompressed on several threads, and the others as a stream
+    auto filepath = utilities::JoinPaths(basePath, "decompressing_stream_test.txt.zst");
+    auto text = GetTestText(400);
+    std::string contents;
+    const size_t frameSize = 700;
+    for (size_t position = 0, frame = 0; position < text.size(); position += frameSize, ++frame)
+    {
+        auto frameText = text.substr(position, frameSize);
+        contents += MakeZstdFrame(frameText, frame % 3 != 2 && frameText.size() >= 256);
+    }
+    WriteFile(filepath, contents);
+    testing::ProcessTest("Testing zstd file format", utilities::GetFileCompressionFormat(filepath) == utilities::CompressionFormat::zstd);
+    if (!utilities::IsCompressionFormatAvailable(utilities::CompressionFormat::zstd))
+    {
+        std::cout << "Skipping zstd tests: built without libzstd" << std::endl;
+        return;
+    }
+    TestDecompressedContents(filepath, text, "zstd file");
+
+    auto truncatedFilepath = utilities::JoinPaths(basePath, "decompressing_stream_test_truncated.txt.zst");
+    WriteFile(truncatedFilepath, contents.substr(0, contents.size() - 10));
+    testing::ProcessTest("Testing truncated zstd file", Throws([&] {
+                             auto stream = utilities::OpenDecompressingIfstream(truncatedFilepath);
+                             ReadLines(*stream);
+                         }));
+}
+} // namespace ell
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     OutputBuffer_test.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "OutputBuffer_test.h"
+
+#include <utilities/include/OutputBuffer.h>
+
+#include <testing/include/testing.h>
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace ell
+{
+using namespace utilities;
+
+void TestOutputBufferFormatting()
+{
+    OutputBuffer buffer;
+    buffer << 0.1 << ' ' << 0.1f << ' ' << 1.0 << ' ' << -2.5f << ' ' << 1e-20 << ' ' << size_t{ 42 } << ' ' << -7 << ' ' << "text" << ' ' << std::string("string");
+    testing::ProcessTest("OutputBuffer formats numbers in their shortest form", testing::IsEqual(buffer.ToString(), std::string("0.1 0.1 1 -2.5 1e-20 42 -7 text string")));
+
+    // doubles read back as the same value
+    bool isSame = true;
+    for (double value : { 1.0 / 3.0, 123456.789e10, -2.2250738585072014e-308, 0.30000000000000004 })
+    {
+        buffer.Clear();
+        buffer << value;
+        isSame &= std::strtod(buffer.ToString().c_str(), nullptr) == value;
+    }
+    testing::ProcessTest("OutputBuffer round trips doubles", isSame);
+
+    std::stringstream stream;
+    buffer.Clear();
+    buffer << 'a';
+    buffer.Pad(8);
+    buffer.WriteTo(stream);
+    testing::ProcessTest("OutputBuffer pads and writes", stream.str() == std::string("a\0\0\0\0\0\0\0", 8) && buffer.Size() == 0);
+}
+
+void TestWriteInParallel()
+{
+    const size_t numItems = 100000;
+    std::stringstream expected;
+    for (size_t index = 0; index < numItems; ++index)
+    {
+        expected << index << '\n';
+    }
+
+    std::stringstream written;
+    WriteInParallel(numItems, written, 4, [](size_t index, OutputBuffer& buffer) { buffer << index << '\n'; });
+    testing::ProcessTest("WriteInParallel writes the items in order", written.str() == expected.str());
+
+    // nested calls format on the calling thread
+    std::stringstream nested;
+    auto callingThread = std::this_thread::get_id();
+    bool isOnCallingThread = true;
+    {
+        ParallelRegion region;
+        WriteInParallel(numItems, nested, 4, [&](size_t index, OutputBuffer& buffer) {
+            isOnCallingThread &= std::this_thread::get_id() == callingThread;
+            buffer << index << '\n';
+        });
+    }
+    testing::ProcessTest("WriteInParallel runs serially inside a parallel region", nested.str() == expected.str() && isOnCallingThread);
+}
+} // namespace ell
@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ParallelFor_test.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ParallelFor_test.h"
+
+#include <utilities/include/ParallelFor.h>
+
+#include <testing/include/testing.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ell
+{
+using namespace utilities;
+
+namespace
+{
+    // Returns true if each of the counts is exactly 1
+    bool AllOnes(const std::vector<std::atomic<int>>& counts)
+    {
+        for (const auto& count : counts)
+        {
+            if (count != 1)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+void TestParallelFor()
+{
+    const size_t count = 1000;
+    std::vector<std::atomic<int>> counts(count);
+    ParallelFor(count, 4, [&counts](size_t index) { ++counts[index]; });
+    bool ok = AllOnes(counts);
+
+    // 0 threads means one per core
+    std::vector<std::atomic<int>> defaultCounts(count);
+    ParallelFor(count, 0, [&defaultCounts](size_t index) { ++defaultCounts[index]; });
+    ok = ok && AllOnes(defaultCounts);
+
+    size_t numCalls = 0;
+    ParallelFor(0, 4, [&numCalls](size_t) { ++numCalls; });
+    ok = ok && numCalls == 0;
+    testing::ProcessTest("Testing ParallelFor visits each index once", ok);
+}
+
+void TestParallelForRanges()
+{
+    // More blocks than elements gives one block per element
+    for (auto numBlocks : { size_t{ 1 }, size_t{ 3 }, size_t{ 8 }, size_t{ 20 } })
+    {
+        const size_t count = 10;
+        std::mutex mutex;
+        std::vector<std::pair<size_t, size_t>> ranges;
+        ParallelForRanges(count, numBlocks, [&](size_t begin, size_t end) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ranges.emplace_back(begin, end);
+        });
+
+        std::sort(ranges.begin(), ranges.end());
+        bool ok = testing::IsEqual(ranges.size(), std::min(numBlocks, count));
+        size_t next = 0;
+        for (const auto& range : ranges)
+        {
+            ok = ok && range.first == next && range.second > range.first;
+            next = range.second;
+        }
+        ok = ok && next == count;
+        testing::ProcessTest("Testing ParallelForRanges splits the range into " + std::to_string(numBlocks) + " blocks", ok);
+    }
+}
+
+void TestParallelForDynamic()
+{
+    const size_t count = 257;
+    std::vector<std::atomic<int>> counts(count);
+    ParallelForDynamic(count, 3, [&counts](size_t index) {
+        if (index % 16 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ++counts[index];
+    });
+    testing::ProcessTest("Testing ParallelForDynamic visits each index once", AllOnes(counts));
+}
+
+void TestParallelForExceptions()
+{
+    // Every block runs to completion before the exception of the first failing block is rethrown
+    const size_t numBlocks = 4;
+    std::vector<std::atomic<int>> finished(numBlocks);
+    std::string message;
+    try
+    {
+        ParallelForBlocks(numBlocks, [&finished](size_t blockIndex) {
+            if (blockIndex == 1 || blockIndex == 3)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(blockIndex == 1 ? 20 : 0));
+                ++finished[blockIndex];
+                throw std::runtime_error("block " + std::to_string(blockIndex));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            ++finished[blockIndex];
+        });
+    }
+    catch (const std::runtime_error& exception)
+    {
+        message = exception.what();
+    }
+    testing::ProcessTest("Testing ParallelForBlocks waits for all blocks and rethrows the first exception", AllOnes(finished) && message == "block 1");
+}
+
+void TestParallelForNesting()
+{
+    // Nested calls run on the thread of the block that makes them, so they don't start more threads
+    bool ok = !IsInParallelRegion();
+    std::atomic<bool> allNestedOnSameThread{ true };
+    std::atomic<bool> allInRegion{ true };
+    std::atomic<int> numNestedCalls{ 0 };
+    ParallelForBlocks(4, [&](size_t) {
+        allInRegion = allInRegion && IsInParallelRegion();
+        auto blockThread = std::this_thread::get_id();
+        ParallelFor(8, 4, [&](size_t) {
+            allNestedOnSameThread = allNestedOnSameThread && std::this_thread::get_id() == blockThread;
+            ++numNestedCalls;
+        });
+    });
+    ok = ok && allInRegion && allNestedOnSameThread && numNestedCalls == 32 && !IsInParallelRegion();
+
+    // A single block uses only the calling thread, so the calls it makes may use more
+    bool singleBlockInRegion = true;
+    ParallelForBlocks(1, [&](size_t) { singleBlockInRegion = IsInParallelRegion(); });
+    ok = ok && !singleBlockInRegion;
+
+    {
+        ParallelRegion region;
+        ok = ok && IsInParallelRegion();
+    }
+    ok = ok && !IsInParallelRegion();
+    testing::ProcessTest("Testing nested ParallelFor calls run on the calling thread", ok);
+}
+} // namespace ell
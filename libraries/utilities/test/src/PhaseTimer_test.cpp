@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PhaseTimer_test.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PhaseTimer_test.h"
+
+#include <utilities/include/PhaseTimer.h>
+
+#include <testing/include/testing.h>
+
+#include <sstream>
+#include <string>
+
+namespace ell
+{
+using namespace utilities;
+
+void TestPhaseTimerNesting()
+{
+    ResetPhaseTimings();
+    EnablePhaseTiming(true);
+    {
+        PhaseTimer outer("Compile");
+        for (int index = 0; index < 3; ++index)
+        {
+            PhaseTimer inner("Emit");
+        }
+        PhaseTimer stopped("Optimize");
+        stopped.Stop();
+    }
+    EnablePhaseTiming(false);
+
+    auto timings = GetPhaseTimings();
+    bool ok = testing::IsEqual(timings.children.size(), size_t{ 1 });
+    if (ok)
+    {
+        const auto& compile = timings.children[0];
+        ok &= testing::IsEqual(compile.name, std::string("Compile"));
+        ok &= testing::IsEqual(compile.count, 1);
+        ok &= testing::IsEqual(compile.children.size(), size_t{ 2 });
+        if (ok)
+        {
+            ok &= testing::IsEqual(compile.children[0].name, std::string("Emit"));
+            ok &= testing::IsEqual(compile.children[0].count, 3);
+            ok &= testing::IsEqual(compile.children[1].name, std::string("Optimize"));
+            ok &= testing::IsEqual(compile.children[1].count, 1);
+            ok &= testing::IsTrue(compile.milliseconds >= compile.children[0].milliseconds + compile.children[1].milliseconds);
+        }
+    }
+
+    std::stringstream json;
+    WritePhaseTimingsJson(json);
+    ok &= testing::IsTrue(json.str().find("\"name\": \"Emit\"") != std::string::npos);
+    ok &= testing::IsTrue(json.str().find("\"count\": 3") != std::string::npos);
+
+    // names with control characters are escaped
+    EnablePhaseTiming(true);
+    {
+        PhaseTimer timer("Line\nbreak\t\x01");
+    }
+    EnablePhaseTiming(false);
+    std::stringstream escapedJson;
+    WritePhaseTimingsJson(escapedJson);
+    ok &= testing::IsTrue(escapedJson.str().find("\"name\": \"Line\\nbreak\\t\\u0001\"") != std::string::npos);
+
+    ResetPhaseTimings();
+    ok &= testing::IsTrue(GetPhaseTimings().children.empty());
+    testing::ProcessTest("PhaseTimer nesting", ok);
+}
+
+void TestPhaseTimerDisabled()
+{
+    ResetPhaseTimings();
+    {
+        PhaseTimer timer("Compile");
+    }
+    testing::ProcessTest("PhaseTimer disabled", testing::IsTrue(GetPhaseTimings().children.empty()));
+}
+} // namespace ell
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     PoolAllocator_test.cpp (utilities)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PoolAllocator_test.h"
+
+#include <utilities/include/PoolAllocator.h>
+
+#include <testing/include/testing.h>
+
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace ell
+{
+using namespace utilities;
+
+namespace
+{
+    bool IsAligned(const void* p)
+    {
+        return reinterpret_cast<uintptr_t>(p) % poolAlignment == 0;
+    }
+} // namespace
+
+void TestPoolAllocatorAlignment()
+{
+    bool aligned = true;
+    for (size_t size : { 1, 3, 17, 100, 1000, 12345, 1 << 20, 5 << 20 })
+    {
+        std::vector<char, PoolAllocator<char>> chars(size);
+        std::vector<double, PoolAllocator<double>> doubles(size);
+        aligned = aligned && IsAligned(chars.data()) && IsAligned(doubles.data());
+    }
+    testing::ProcessTest("PoolAllocator alignment", aligned);
+}
+
+void TestPoolAllocatorReuse()
+{
+    const void* first = nullptr;
+    {
+        std::vector<float, PoolAllocator<float>> v(1000, 1.0f);
+        first = v.data();
+    }
+    auto cachedSize = GetPoolCachedSize();
+
+    // a vector of a slightly different size falls in the same size class and reuses the block
+    std::vector<float, PoolAllocator<float>> w(990, 2.0f);
+    bool reused = w.data() == first && GetPoolCachedSize() < cachedSize;
+
+    // copies and moves work as with the standard allocator
+    auto copy = w;
+    auto moved = std::move(copy);
+    bool contentsOK = moved.size() == 990 && std::accumulate(moved.begin(), moved.end(), 0.0f) == 1980.0f;
+
+    testing::ProcessTest("PoolAllocator reuse", reused && contentsOK);
+}
+
+void TestPoolAllocatorThreads()
+{
+    // memory allocated on one thread can be freed on another
+    std::vector<std::vector<int, PoolAllocator<int>>> vectors(4);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < vectors.size(); ++i)
+    {
+        threads.emplace_back([&vectors, i]() {
+            for (int j = 0; j < 100; ++j)
+            {
+                vectors[i].assign(100 + 10 * j, static_cast<int>(i));
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < vectors.size(); ++i)
+    {
+        ok = ok && vectors[i].size() == 1090 && vectors[i].back() == static_cast<int>(i) && IsAligned(vectors[i].data());
+    }
+    vectors.clear();
+    testing::ProcessTest("PoolAllocator threads", ok);
+}
+
+void TestPoolAllocatorHugePages()
+{
+    SetPoolHugePages(true);
+    bool ok = GetPoolHugePages();
+    {
+        // large blocks start on a huge page boundary (on Linux), and small ones still come from the pool
+        std::vector<double, PoolAllocator<double>> large((5 << 20) / sizeof(double), 1.0);
+        std::vector<double, PoolAllocator<double>> small(100, 2.0);
+#if defined(__linux__)
+        ok = ok && reinterpret_cast<uintptr_t>(large.data()) % poolHugePageSize == 0;
+#endif
+        ok = ok && IsAligned(large.data()) && IsAligned(small.data());
+        ok = ok && std::accumulate(large.begin(), large.end(), 0.0) == static_cast<double>(large.size());
+
+        // blocks allocated with huge pages can be freed after they're turned off
+        SetPoolHugePages(false);
+        large.clear();
+        large.shrink_to_fit();
+    }
+    std::vector<char, PoolAllocator<char>> heap(5 << 20);
+    ok = ok && !GetPoolHugePages() && IsAligned(heap.data());
+    testing::ProcessTest("PoolAllocator huge pages", ok);
+}
+} // namespace ell
@@ -7,6 +7,9 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "Archiver_test.h"
+#include "Benchmark_test.h"
+#include "ConcurrentRingBuffer_test.h"
+#include "DecompressingStream_test.h"
 #include "Files_test.h"
 #include "Format_test.h"
 #include "FunctionUtils_test.h"
@@ -14,6 +17,10 @@
 #include "Iterator_test.h"
 #include "MemoryLayout_test.h"
 #include "ObjectArchive_test.h"
+#include "OutputBuffer_test.h"
+#include "ParallelFor_test.h"
+#include "PhaseTimer_test.h"
+#include "PoolAllocator_test.h"
 #include "PropertyBag_test.h"
 #include "RingBuffer_test.h"
 #include "TypeFactory_test.h"
@@ -44,6 +51,14 @@ int main(int argc, char* argv[])
         std::string basePath = ell::utilities::GetDirectoryPath(argv[0]);
 
         TestRingBuffer();
+        TestConcurrentRingBuffer();
+        TestConcurrentRingBufferThreads();
+
+        // PoolAllocator tests
+        TestPoolAllocatorAlignment();
+        TestPoolAllocatorReuse();
+        TestPoolAllocatorThreads();
+        TestPoolAllocatorHugePages();
 
         // Format tests
         TestMatchFormat();
@@ -51,6 +66,21 @@ int main(int argc, char* argv[])
         // Hash tests
         Hash_test1();
 
+        // ParallelFor tests
+        TestParallelFor();
+        TestParallelForRanges();
+        TestParallelForDynamic();
+        TestParallelForExceptions();
+        TestParallelForNesting();
+
+        // PhaseTimer tests
+        TestPhaseTimerNesting();
+        TestPhaseTimerDisabled();
+
+        // OutputBuffer tests
+        TestOutputBufferFormatting();
+        TestWriteInParallel();
+
         // Iterator tests
         TestIteratorAdapter();
         TestTransformIterator();
@@ -88,9 +118,17 @@ int main(int argc, char* argv[])
         TestJsonArchiver();
         TestJsonUnarchiver();
 
+        TestBinaryArchiver();
+        TestBinaryUnarchiver();
+
         TestXmlArchiver();
         TestXmlUnarchiver();
 
+        // Benchmark result tests
+        TestReadBenchmarkResults();
+        TestReadMalformedBenchmarkResults();
+        TestCompareBenchmarkResults();
+
         // ObjectArchive tests
         TestGetTypeDescription();
         TestGetObjectArchive();
@@ -113,6 +151,9 @@ int main(int argc, char* argv[])
 #ifdef WIN32
         TestUnicodePaths(basePath);
 #endif
+        TestDecompressingStreamUncompressed(basePath);
+        TestDecompressingStreamGzip(basePath);
+        TestDecompressingStreamZstd(basePath);
 
         // PropertyBag tests
         TestPropertyBag();
@@ -12,11 +12,13 @@
 #include "FunctionDeclaration.h"
 #include "Scalar.h"
 
+#include <cstdint>
 #include <forward_list>
 #include <map>
 #include <optional>
 #include <stack>
 #include <string>
+#include <utility>
 
 namespace ell
 {
@@ -27,12 +29,39 @@ namespace value
     class ComputeContext : public EmitterContext
     {
     public:
+        /// <summary> How the functions defined in the context are executed </summary>
+        enum class ExecutionMode
+        {
+            /// <summary> Each call interprets the function's definition, which is the easiest to debug </summary>
+            interpret,
+
+            /// <summary> Functions are compiled with LLVMContext the first time they are defined, and calls run the
+            /// compiled code. Functions that can't be compiled on their own (for instance, those that use values
+            /// created outside of them or call functions that aren't part of their module) are interpreted. </summary>
+            jit
+        };
+
         /// <summary> Constructor </summary>
         /// <param name="moduleName"> The name of the module that this context represents </param>
-        ComputeContext(std::string moduleName);
+        /// <param name="mode"> How the functions defined in the context are executed </param>
+        ComputeContext(std::string moduleName, ExecutionMode mode = ExecutionMode::interpret);
 
         const ConstantData& GetConstantData(Value value) const;
 
+        /// <summary> The number of times a profile region ran and its total running time </summary>
+        struct ProfileRegionTotals
+        {
+            int64_t count = 0;
+            double totalTime = 0; // in milliseconds
+        };
+
+        /// <summary> Gets the totals of the profile regions that ran in this context, by name </summary>
+        /// <remarks> Functions compiled by the `jit` execution mode don't time their regions </remarks>
+        std::map<std::string, ProfileRegionTotals> GetProfileRegions() const;
+
+        /// <summary> Discards the totals of the profile regions that ran in this context </summary>
+        void ResetProfileRegions();
+
     private:
         Value AllocateImpl(ValueType type, MemoryLayout layout) override;
 
@@ -44,12 +73,14 @@ namespace value
         detail::ValueTypeDescription GetTypeImpl(Emittable emittable) override;
 
         DefinedFunction CreateFunctionImpl(FunctionDeclaration decl, DefinedFunction fn) override;
+        std::optional<DefinedFunction> JitFunction(FunctionDeclaration decl, DefinedFunction fn);
         bool IsFunctionDefinedImpl(FunctionDeclaration decl) const override;
 
         Value StoreConstantDataImpl(ConstantData data) override;
 
         void ForImpl(MemoryLayout layout, std::function<void(std::vector<Scalar>)> fn) override;
         void ForImpl(Scalar start, Scalar stop, Scalar step, std::function<void(Scalar)> fn) override;
+        void ParallelForImpl(Scalar start, Scalar stop, Scalar step, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn) override;
 
         void MoveDataImpl(Value& source, Value& destination) override;
 
@@ -71,6 +102,9 @@ namespace value
 
         void DebugDumpImpl(Value value, std::string tag, std::ostream& stream) const override;
 
+        void EnterProfileRegionImpl(const std::string& name) override;
+        void ExitProfileRegionImpl() override;
+
         Value IntrinsicCall(FunctionDeclaration intrinsic, std::vector<Value> args);
 
         bool ValidateValue(Value value) const;
@@ -89,13 +123,21 @@ namespace value
         Frame& GetTopFrame();
         const Frame& GetTopFrame() const;
 
+        std::stack<Frame>& GetStack();
+        const std::stack<Frame>& GetStack() const;
+
         class IfContextImpl;
         struct FunctionScope;
 
         std::stack<Frame> _stack;
+
+        // The tasks of a ParallelFor run on worker threads, each with its own stack of frames
+        static thread_local std::pair<const ComputeContext*, std::stack<Frame>*> s_taskStack;
         std::map<std::string, std::pair<ConstantData, MemoryLayout>> _globals;
         std::unordered_map<FunctionDeclaration, DefinedFunction> _definedFunctions;
+        std::map<std::string, ProfileRegionTotals> _profileRegions;
         std::string _moduleName;
+        ExecutionMode _executionMode;
     };
 
 } // namespace value
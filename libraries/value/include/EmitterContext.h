@@ -196,6 +196,18 @@ namespace value
         /// <param name="fn"> The function to be called for each coordinate where there is an active element </param>
         void For(Scalar start, Scalar stop, Scalar step, std::function<void(Scalar)> fn);
 
+        /// <summary> Creates a for loop whose iterations are divided among tasks that may run concurrently </summary>
+        /// <param name="start"> The value used to initialize the loop counter </param>
+        /// <param name="stop"> The terminal value of the loop </param>
+        /// <param name="step"> The value by which the loop counter is incremented </param>
+        /// <param name="numTasks"> The number of tasks to divide the iterations among, or 0 to let the context choose </param>
+        /// <param name="capturedValues"> The values created outside of the loop that the loop body uses </param>
+        /// <param name="fn"> The function to be called for each iteration, with the loop counter and the captured values </param>
+        /// <remarks> The loop body may run in a different function or on a different thread, so it must only use values
+        /// created outside of it through the captured values it is given. The iterations must be independent, and any global
+        /// data or functions they use must be created before the loop. </remarks>
+        void ParallelFor(Scalar start, Scalar stop, Scalar step, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn);
+
         /// <summary> Moves the data from one location to another </summary>
         /// <param name="source"> The source of the memory to be moved </param>
         /// <param name="destination"> The destination of the memory to be moved </param>
@@ -244,6 +256,14 @@ namespace value
         
         void DebugDump(Value value, std::string tag, std::ostream* stream) const;
 
+        /// <summary> Begins a region of code whose running time is measured </summary>
+        /// <param name="name"> The name of the region </param>
+        /// <remarks> Regions nest, and each call must be matched by a call to ExitProfileRegion in the same function </remarks>
+        void EnterProfileRegion(const std::string& name);
+
+        /// <summary> Ends the most recently entered region of code whose running time is measured </summary>
+        void ExitProfileRegion();
+
     protected:
         const std::vector<std::reference_wrapper<FunctionDeclaration>>& GetIntrinsics() const;
 
@@ -263,6 +283,7 @@ namespace value
 
         virtual void ForImpl(MemoryLayout layout, std::function<void(std::vector<Scalar>)> fn) = 0;
         virtual void ForImpl(Scalar start, Scalar stop, Scalar step, std::function<void(Scalar)> fn) = 0;
+        virtual void ParallelForImpl(Scalar start, Scalar stop, Scalar step, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn) = 0;
 
         virtual void MoveDataImpl(Value& source, Value& destination) = 0;
 
@@ -282,6 +303,9 @@ namespace value
         virtual std::optional<Value> CallImpl(FunctionDeclaration func, std::vector<Value> args) = 0;
 
         virtual void DebugDumpImpl(Value value, std::string tag, std::ostream& stream) const = 0;
+
+        virtual void EnterProfileRegionImpl(const std::string& name) = 0;
+        virtual void ExitProfileRegionImpl() = 0;
     };
 
     /// <summary> Returns the global instance of EmitterContext </summary>
@@ -447,6 +471,47 @@ namespace value
     void ForRange(Scalar start, Scalar end, std::function<void(Scalar)> fn);
     void ForRange(Scalar start, Scalar end, Scalar step, std::function<void(Scalar)> fn);
 
+    /// <summary> Creates a for loop from 0 to `end` whose iterations are divided among tasks that may run concurrently </summary>
+    /// <param name="end"> The terminal value of the loop </param>
+    /// <param name="numTasks"> The number of tasks to divide the iterations among, or 0 to let the context choose </param>
+    /// <param name="capturedValues"> The values created outside of the loop that the loop body uses </param>
+    /// <param name="fn"> The function to be called for each iteration, with the loop counter and the captured values </param>
+    void ParallelFor(Scalar end, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn);
+
+    /// <summary> Creates a for loop from `start` to `end` whose iterations are divided among tasks that may run concurrently </summary>
+    /// <param name="start"> The value used to initialize the loop counter </param>
+    /// <param name="end"> The terminal value of the loop </param>
+    /// <param name="numTasks"> The number of tasks to divide the iterations among, or 0 to let the context choose </param>
+    /// <param name="capturedValues"> The values created outside of the loop that the loop body uses </param>
+    /// <param name="fn"> The function to be called for each iteration, with the loop counter and the captured values </param>
+    void ParallelFor(Scalar start, Scalar end, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn);
+
+    /// <summary> Runs `numTasks` tasks that may run concurrently </summary>
+    /// <param name="numTasks"> The number of tasks </param>
+    /// <param name="capturedValues"> The values created outside of the tasks that they use </param>
+    /// <param name="fn"> The function to be called for each task, with the task index and the captured values </param>
+    void Parallelize(int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn);
+
+    /// <summary>
+    /// An RAII class that measures the running time of the code between its construction and destruction, e.g. the
+    /// "pack", "compute" and "epilogue" parts of a kernel. Under LLVMContext the region is an IRProfiler region of the
+    /// compiled model, and is only measured when the model is compiled with profiling on. Under ComputeContext the
+    /// region is timed on the host, and the totals are available from ComputeContext::GetProfileRegions.
+    /// </summary>
+    class ProfileRegion
+    {
+    public:
+        /// <summary> Constructor. Enters the region in the global context. </summary>
+        /// <param name="name"> The name of the region </param>
+        ProfileRegion(const std::string& name);
+
+        ProfileRegion(const ProfileRegion&) = delete;
+        ProfileRegion& operator=(const ProfileRegion&) = delete;
+
+        /// <summary> Destructor. Exits the region. </summary>
+        ~ProfileRegion();
+    };
+
     extern FunctionDeclaration AbsFunctionDeclaration;
     extern FunctionDeclaration CosFunctionDeclaration;
     extern FunctionDeclaration CopySignFunctionDeclaration;
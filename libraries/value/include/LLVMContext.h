@@ -13,6 +13,8 @@
 #include "FunctionDeclaration.h"
 #include "Scalar.h"
 
+#include <emitters/include/IRProfiler.h>
+
 #include <functional>
 #include <optional>
 #include <stack>
@@ -63,6 +65,7 @@ namespace value
 
         void ForImpl(MemoryLayout layout, std::function<void(std::vector<Scalar>)> fn) override;
         void ForImpl(Scalar start, Scalar stop, Scalar step, std::function<void(Scalar)> fn) override;
+        void ParallelForImpl(Scalar start, Scalar stop, Scalar step, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn) override;
 
         void MoveDataImpl(Value& source, Value& destination) override;
 
@@ -83,6 +86,9 @@ namespace value
 
         void DebugDumpImpl(Value value, std::string tag, std::ostream& stream) const override;
 
+        void EnterProfileRegionImpl(const std::string& name) override;
+        void ExitProfileRegionImpl() override;
+
         Value IntrinsicCall(FunctionDeclaration intrinsic, std::vector<Value> args);
 
         bool TypeCompatible(Value value1, Value value2);
@@ -113,6 +119,7 @@ namespace value
         ComputeContext _computeContext;
 
         std::stack<std::reference_wrapper<emitters::IRFunctionEmitter>> _functionStack;
+        std::stack<emitters::IRProfileRegion> _profileRegions;
         std::map<std::string, std::pair<Emittable, MemoryLayout>> _globals;
         std::unordered_map<FunctionDeclaration, DefinedFunction> _definedFunctions;
     };
@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     LoopNest.h (value)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Scalar.h"
+#include "Value.h"
+
+#include <array>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace ell
+{
+namespace value
+{
+    /// <summary> Names one of the loops of a LoopNest in scheduling directives </summary>
+    class LoopIndex
+    {
+    public:
+        bool operator==(const LoopIndex& other) const { return _id == other._id; }
+        bool operator!=(const LoopIndex& other) const { return _id != other._id; }
+
+    private:
+        friend class LoopNest;
+        explicit LoopIndex(int id) :
+            _id(id) {}
+
+        int _id;
+    };
+
+    /// <summary>
+    /// A nest of loops over a multidimensional iteration space, along with a schedule that says how the loops are
+    /// emitted: loops can be split (or tiled) into blocks, reordered, unrolled, vectorized and parallelized without
+    /// changing the kernel, which always gets the logical index of each dimension. The same schedule runs under every
+    /// context, so a schedule tuned for LLVMContext can be checked against ComputeContext.
+    /// </summary>
+    ///
+    /// <example>
+    /// <code>
+    /// LoopNest nest({ rows, columns });
+    /// auto [i, j] = std::pair{ nest.GetIndex(0), nest.GetIndex(1) };
+    /// auto [iOuter, jOuter, iInner, jInner] = nest.Tile(i, j, 16, 16);
+    /// nest.Unroll(iInner).Vectorize(jInner);
+    /// nest.Run([&](std::vector&lt;Scalar&gt; index) { C(index[0], index[1]) = A(index[0], index[1]) + B(index[0], index[1]); });
+    /// </code>
+    /// </example>
+    class LoopNest
+    {
+    public:
+        /// <summary> Constructor </summary>
+        /// <param name="extents"> The number of iterations of each dimension. Before scheduling, the nest has one loop per
+        /// dimension, in the given order (outermost first). </param>
+        LoopNest(std::vector<int> extents);
+
+        /// <summary> Returns the loop over a dimension, as it was before any splits </summary>
+        /// <param name="dimension"> The dimension </param>
+        LoopIndex GetIndex(int dimension) const;
+
+        /// <summary> Splits a loop into an outer loop over blocks of `size` iterations and an inner loop over the
+        /// iterations of a block. The two loops take the place of the original one in the nest. </summary>
+        /// <param name="index"> The loop to split. Its extent must be a multiple of `size`, unless it is the outermost
+        /// loop of its dimension, in which case the last block is cut short. </param>
+        /// <param name="size"> The number of iterations of the inner loop </param>
+        /// <returns> The outer and inner loops </returns>
+        std::pair<LoopIndex, LoopIndex> Split(LoopIndex index, int size);
+
+        /// <summary> Splits two loops into blocks, and moves both outer loops outside both inner ones </summary>
+        /// <param name="i"> The first loop to split </param>
+        /// <param name="j"> The second loop to split </param>
+        /// <param name="sizeI"> The number of iterations of the inner loop of `i` </param>
+        /// <param name="sizeJ"> The number of iterations of the inner loop of `j` </param>
+        /// <returns> The outer loop of `i`, the outer loop of `j`, the inner loop of `i` and the inner loop of `j` </returns>
+        std::array<LoopIndex, 4> Tile(LoopIndex i, LoopIndex j, int sizeI, int sizeJ);
+
+        /// <summary> Reorders loops. The given loops are placed, in the given order, in the positions they occupy
+        /// between them; the other loops don't move. </summary>
+        /// <param name="order"> The loops to reorder, outermost first </param>
+        LoopNest& Reorder(std::vector<LoopIndex> order);
+
+        /// <summary> Unrolls a loop completely </summary>
+        LoopNest& Unroll(LoopIndex index);
+
+        /// <summary> Vectorizes the innermost loop. It is unrolled, so its iterations become straight-line code over
+        /// consecutive indices, which LLVM's SLP vectorizer turns into vector instructions. </summary>
+        LoopNest& Vectorize(LoopIndex index);
+
+        /// <summary> Divides the iterations of the outermost loop among tasks that may run concurrently </summary>
+        /// <param name="index"> The outermost loop </param>
+        /// <param name="numTasks"> The number of tasks, or 0 to let the context choose </param>
+        LoopNest& Parallelize(LoopIndex index, int numTasks = 0);
+
+        /// <summary> Emits the loop nest </summary>
+        /// <param name="kernel"> The function called for each point of the iteration space, with the logical index of each
+        /// dimension </param>
+        /// <remarks> The nest must not be parallelized: use the overload with captured values. </remarks>
+        void Run(std::function<void(std::vector<Scalar>)> kernel) const;
+
+        /// <summary> Emits the loop nest </summary>
+        /// <param name="capturedValues"> The values created outside of the nest that the kernel uses </param>
+        /// <param name="kernel"> The function called for each point of the iteration space, with the logical index of each
+        /// dimension and the captured values </param>
+        /// <remarks> The kernel may run in a different function or on a different thread if the nest is parallelized,
+        /// so it must only use values created outside of it through the captured values it is given </remarks>
+        void Run(std::vector<Value> capturedValues, std::function<void(std::vector<Scalar>, std::vector<Value>)> kernel) const;
+
+    private:
+        enum class LoopKind
+        {
+            serial,
+            unrolled,
+            vectorized,
+            parallel
+        };
+
+        struct Loop
+        {
+            int id;
+            int dimension;
+            int stride; // the amount the loop adds to the logical index of its dimension per iteration
+            int extent;
+            LoopKind kind;
+            int numTasks;
+        };
+
+        using Kernel = std::function<void(std::vector<Scalar>, std::vector<Value>)>;
+
+        size_t GetPosition(LoopIndex index) const;
+        bool IsOutermostLoopOfDimension(size_t position) const;
+        void EmitLoops(size_t position, std::vector<Scalar> loopIndices, std::vector<Value> capturedValues, const Kernel& kernel) const;
+        void EmitKernel(const std::vector<Scalar>& loopIndices, std::vector<Value> capturedValues, const Kernel& kernel) const;
+
+        std::vector<int> _extents;
+        std::vector<Loop> _loops; // in nesting order, outermost first
+        int _nextId = 0;
+    };
+
+} // namespace value
+} // namespace ell
@@ -8,17 +8,28 @@
 
 #include "ComputeContext.h"
 #include "FunctionDeclaration.h"
+#include "LLVMContext.h"
 #include "Scalar.h"
 #include "Value.h"
 
+#include <emitters/include/IRExecutionEngine.h>
+#include <emitters/include/IRModuleEmitter.h>
+
 #include <utilities/include/TypeTraits.h>
 #include <utilities/include/TypeName.h>
 
+#include <llvm/IR/Module.h>
+#include <llvm/Support/DynamicLibrary.h>
+
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <exception>
 #include <iostream>
+#include <mutex>
 #include <string>
+#include <thread>
 
 namespace ell
 {
@@ -32,10 +43,10 @@ namespace value
         FunctionScope(ComputeContext& context, std::string fnName) :
             context(context)
         {
-            context._stack.push({ fnName, {} });
+            context.GetStack().push({ fnName, {} });
         }
 
-        ~FunctionScope() { context._stack.pop(); }
+        ~FunctionScope() { context.GetStack().pop(); }
 
         ComputeContext& context;
     };
@@ -76,6 +87,38 @@ namespace value
                 data);
         }
 
+        // Calls a compiled function whose parameters are all pointers
+        template <typename ReturnType>
+        ReturnType CallJittedFunction(uint64_t address, const std::vector<void*>& args)
+        {
+            using P = void*;
+            auto a = args;
+            a.resize(8);
+            switch (args.size())
+            {
+            case 0:
+                return reinterpret_cast<ReturnType (*)()>(address)();
+            case 1:
+                return reinterpret_cast<ReturnType (*)(P)>(address)(a[0]);
+            case 2:
+                return reinterpret_cast<ReturnType (*)(P, P)>(address)(a[0], a[1]);
+            case 3:
+                return reinterpret_cast<ReturnType (*)(P, P, P)>(address)(a[0], a[1], a[2]);
+            case 4:
+                return reinterpret_cast<ReturnType (*)(P, P, P, P)>(address)(a[0], a[1], a[2], a[3]);
+            case 5:
+                return reinterpret_cast<ReturnType (*)(P, P, P, P, P)>(address)(a[0], a[1], a[2], a[3], a[4]);
+            case 6:
+                return reinterpret_cast<ReturnType (*)(P, P, P, P, P, P)>(address)(a[0], a[1], a[2], a[3], a[4], a[5]);
+            case 7:
+                return reinterpret_cast<ReturnType (*)(P, P, P, P, P, P, P)>(address)(a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+            case 8:
+                return reinterpret_cast<ReturnType (*)(P, P, P, P, P, P, P, P)>(address)(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+            default:
+                throw InputException(InputExceptionErrors::invalidArgument, "Too many arguments for a compiled function");
+            }
+        }
+
         template <typename T>
         auto AllocateConstantDataImpl(size_t size)
         {
@@ -360,8 +403,9 @@ namespace value
 
     } // namespace
 
-    ComputeContext::ComputeContext(std::string moduleName) :
-        _moduleName(std::move(moduleName))
+    ComputeContext::ComputeContext(std::string moduleName, ExecutionMode mode) :
+        _moduleName(std::move(moduleName)),
+        _executionMode(mode)
     {
         // we always have at least one stack entry, in case the top level function needs to return something
         _stack.push({});
@@ -401,6 +445,11 @@ namespace value
                                        } },
                        value.GetUnderlyingData());
 
+        if (it == Iterator{} || it == GetTopFrame().second.end())
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "Value doesn't refer to data owned by this context");
+        }
+
         return *it;
     }
 
@@ -581,6 +630,15 @@ namespace value
             return it->second;
         }
 
+        if (_executionMode == ExecutionMode::jit)
+        {
+            if (auto jittedFn = JitFunction(decl, fn))
+            {
+                _definedFunctions[decl] = *jittedFn;
+                return *jittedFn;
+            }
+        }
+
         DefinedFunction returnFn = [fn = std::move(fn),
                                     decl,
                                     this](std::vector<Value> args) -> std::optional<Value> {
@@ -639,6 +697,84 @@ namespace value
         return returnFn;
     }
 
+    std::optional<EmitterContext::DefinedFunction> ComputeContext::JitFunction(FunctionDeclaration decl, DefinedFunction fn)
+    {
+        // Booleans don't have the same representation in both contexts, and the arguments are passed as pointers
+        // through a call with a fixed number of parameters
+        constexpr size_t maxParameters = 8;
+        const auto& parameters = decl.GetParameterTypes();
+        const auto& returnType = decl.GetReturnType();
+        if (parameters.size() > maxParameters ||
+            std::any_of(parameters.begin(), parameters.end(), [](const Value& value) { return value.GetBaseType() == ValueType::Boolean; }) ||
+            (returnType && returnType->GetBaseType() == ValueType::Boolean))
+        {
+            return std::nullopt;
+        }
+
+        const auto& fnName = decl.GetFunctionName();
+        auto module = std::make_unique<emitters::IRModuleEmitter>(_moduleName + "_" + fnName + "_jit", emitters::CompilerOptions{});
+        try
+        {
+            ContextGuard<LLVMContext> guard(*module);
+            guard.GetContext().CreateFunction(decl, fn);
+        }
+        catch (const std::exception&)
+        {
+            // The definition uses values owned by this context, or something else LLVMContext doesn't support
+            return std::nullopt;
+        }
+
+        // Calls to functions defined elsewhere (in this context, or in modules that aren't loaded) can't be resolved
+        llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+        for (const auto& function : *module->GetLLVMModule())
+        {
+            if (function.isDeclaration() && !function.isIntrinsic() &&
+                llvm::sys::DynamicLibrary::SearchForAddressOfSymbol(function.getName().str()) == nullptr)
+            {
+                return std::nullopt;
+            }
+        }
+
+        auto engine = std::make_shared<emitters::IRExecutionEngine>(std::move(*module), true);
+        auto address = engine->ResolveFunctionAddress(fnName);
+
+        return DefinedFunction{ [this, engine, address, decl](std::vector<Value> args) -> std::optional<Value> {
+            const auto& returnType = decl.GetReturnType();
+            if (args.size() != decl.GetParameterTypes().size())
+            {
+                throw InputException(InputExceptionErrors::invalidArgument, "Wrong number of arguments");
+            }
+
+            std::vector<void*> argData;
+            for (const auto& arg : args)
+            {
+                argData.push_back(std::visit(VariantVisitor{ [](Emittable) -> void* {
+                                                                throw InputException(InputExceptionErrors::invalidArgument, "Arguments must be constant data");
+                                                            },
+                                                             [](auto&& data) -> void* { return const_cast<void*>(static_cast<const void*>(data)); } },
+                                             arg.GetUnderlyingData()));
+            }
+
+            if (!returnType)
+            {
+                CallJittedFunction<void>(address, argData);
+                return std::nullopt;
+            }
+
+            // The returned pointer may refer to the compiled function's stack, so the result is copied right away
+            auto result = CallJittedFunction<void*>(address, argData);
+            auto layout = returnType->GetLayout();
+            Value returnValue = AllocateImpl(returnType->GetBaseType(), layout);
+            std::visit(VariantVisitor{ [](Emittable) {},
+                                       [&](auto&& data) {
+                                           using Type = std::remove_pointer_t<std::decay_t<decltype(data)>>;
+                                           std::copy_n(static_cast<const Type*>(result), layout.GetMemorySize(), data);
+                                       } },
+                       returnValue.GetUnderlyingData());
+            return returnValue;
+        } };
+    }
+
     bool ComputeContext::IsFunctionDefinedImpl(FunctionDeclaration decl) const
     {
         if (const auto& intrinsics = GetIntrinsics();
@@ -732,6 +868,84 @@ namespace value
             start.GetValue().GetUnderlyingData());
     }
 
+    void ComputeContext::ParallelForImpl(Scalar start, Scalar stop, Scalar step, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn)
+    {
+        if (!(start.GetValue().IsConstant() && stop.GetValue().IsConstant() && step.GetValue().IsConstant()))
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "start/stop/step values must be constant for ComputeContext");
+        }
+
+        auto startNum = start.Get<int>();
+        auto stopNum = stop.Get<int>();
+        auto stepNum = step.Get<int>();
+        if (stepNum <= 0)
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "step must be positive");
+        }
+
+        int numIterations = stopNum > startNum ? (stopNum - startNum - 1) / stepNum + 1 : 0;
+        if (numTasks == 0)
+        {
+            numTasks = static_cast<int>(std::thread::hardware_concurrency());
+        }
+        numTasks = std::max(1, std::min(numTasks, numIterations));
+        int taskSize = numIterations > 0 ? (numIterations - 1) / numTasks + 1 : 0;
+
+        auto runTask = [&](int taskIndex) {
+            auto taskBegin = startNum + taskIndex * taskSize * stepNum;
+            auto taskEnd = std::min(taskBegin + taskSize * stepNum, stopNum);
+            for (auto index = taskBegin; index < taskEnd; index += stepNum)
+            {
+                fn(index, capturedValues);
+            }
+        };
+
+        // The first task runs on this thread, the others on worker threads with their own frames, named after the
+        // current one so function-scoped names still resolve
+        auto frameName = GetTopFrame().first;
+        std::vector<std::exception_ptr> errors(numTasks);
+        std::vector<std::thread> workers;
+        for (int taskIndex = 1; taskIndex < numTasks; ++taskIndex)
+        {
+            workers.emplace_back([&, taskIndex] {
+                std::stack<Frame> taskStack;
+                taskStack.push({ frameName, {} });
+                s_taskStack = { this, &taskStack };
+                try
+                {
+                    runTask(taskIndex);
+                }
+                catch (...)
+                {
+                    errors[taskIndex] = std::current_exception();
+                }
+                s_taskStack = {};
+            });
+        }
+
+        try
+        {
+            runTask(0);
+        }
+        catch (...)
+        {
+            errors[0] = std::current_exception();
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        for (auto& error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
     Value ComputeContext::UnaryOperationImpl(ValueUnaryOperation op, Value destination)
     {
         throw LogicException(LogicExceptionErrors::notImplemented);
@@ -1060,6 +1274,49 @@ namespace value
             value.GetUnderlyingData());
     }
 
+    namespace
+    {
+        // The regions of the tasks of a ParallelFor add to the same totals from several threads
+        std::mutex s_profileRegionsMutex;
+
+        // The regions running on this thread, innermost last, with the times they were entered
+        thread_local std::vector<std::pair<std::string, std::chrono::steady_clock::time_point>> s_runningProfileRegions;
+    } // namespace
+
+    void ComputeContext::EnterProfileRegionImpl(const std::string& name)
+    {
+        s_runningProfileRegions.emplace_back(name, std::chrono::steady_clock::now());
+    }
+
+    void ComputeContext::ExitProfileRegionImpl()
+    {
+        if (s_runningProfileRegions.empty())
+        {
+            throw LogicException(LogicExceptionErrors::illegalState, "Exiting a profile region that wasn't entered");
+        }
+
+        auto [name, startTime] = s_runningProfileRegions.back();
+        s_runningProfileRegions.pop_back();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+
+        std::lock_guard<std::mutex> lock(s_profileRegionsMutex);
+        auto& totals = _profileRegions[name];
+        ++totals.count;
+        totals.totalTime += elapsed.count();
+    }
+
+    std::map<std::string, ComputeContext::ProfileRegionTotals> ComputeContext::GetProfileRegions() const
+    {
+        std::lock_guard<std::mutex> lock(s_profileRegionsMutex);
+        return _profileRegions;
+    }
+
+    void ComputeContext::ResetProfileRegions()
+    {
+        std::lock_guard<std::mutex> lock(s_profileRegionsMutex);
+        _profileRegions.clear();
+    }
+
     Value ComputeContext::IntrinsicCall(FunctionDeclaration intrinsic, std::vector<Value> args)
     {
         static std::unordered_map<FunctionDeclaration, std::function<Value(std::vector<Value>)>> intrinsics = {
@@ -1124,9 +1381,21 @@ namespace value
         return GetGlobalScopedName(GetTopFrame().first + "_" + name);
     }
 
-    ComputeContext::Frame& ComputeContext::GetTopFrame() { return _stack.top(); }
+    ComputeContext::Frame& ComputeContext::GetTopFrame() { return GetStack().top(); }
+
+    const ComputeContext::Frame& ComputeContext::GetTopFrame() const { return GetStack().top(); }
 
-    const ComputeContext::Frame& ComputeContext::GetTopFrame() const { return _stack.top(); }
+    thread_local std::pair<const ComputeContext*, std::stack<ComputeContext::Frame>*> ComputeContext::s_taskStack{};
+
+    std::stack<ComputeContext::Frame>& ComputeContext::GetStack()
+    {
+        return s_taskStack.first == this ? *s_taskStack.second : _stack;
+    }
+
+    const std::stack<ComputeContext::Frame>& ComputeContext::GetStack() const
+    {
+        return s_taskStack.first == this ? *s_taskStack.second : _stack;
+    }
 
 } // namespace value
 } // namespace ell
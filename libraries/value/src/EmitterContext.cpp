@@ -154,6 +154,21 @@ namespace value
         return ForImpl(start, stop, step, fn);
     }
 
+    void EmitterContext::ParallelFor(Scalar start, Scalar stop, Scalar step, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn)
+    {
+        if (!(start.GetType() == ValueType::Int32 && stop.GetType() == ValueType::Int32 && step.GetType() == ValueType::Int32))
+        {
+            throw InputException(InputExceptionErrors::typeMismatch, "start/stop/step must be 32-bit integers");
+        }
+
+        if (numTasks < 0)
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "numTasks must be >= 0");
+        }
+
+        return ParallelForImpl(start, stop, step, numTasks, capturedValues, fn);
+    }
+
     void EmitterContext::MoveData(Value& source, Value& destination) { return MoveDataImpl(source, destination); }
 
     void EmitterContext::CopyData(const Value& source, Value& destination) { return CopyDataImpl(source, destination); }
@@ -234,6 +249,16 @@ namespace value
         }
     }
 
+    void EmitterContext::EnterProfileRegion(const std::string& name)
+    {
+        EnterProfileRegionImpl(name);
+    }
+
+    void EmitterContext::ExitProfileRegion()
+    {
+        ExitProfileRegionImpl();
+    }
+
     const std::vector<std::reference_wrapper<FunctionDeclaration>>& EmitterContext::GetIntrinsics() const
     {
         static std::vector intrinsics = {
@@ -316,11 +341,36 @@ namespace value
         GetContext().For(start, end, step, fn);
     }
 
+    void ParallelFor(Scalar end, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn)
+    {
+        ParallelFor(0, end, numTasks, capturedValues, fn);
+    }
+
+    void ParallelFor(Scalar start, Scalar end, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn)
+    {
+        GetContext().ParallelFor(start, end, 1, numTasks, capturedValues, fn);
+    }
+
+    void Parallelize(int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn)
+    {
+        ParallelFor(0, numTasks, numTasks, capturedValues, fn);
+    }
+
     void DebugDump(Value value, std::string tag, std::ostream* stream)
     {
         GetContext().DebugDump(value, tag, stream);
     }
 
+    ProfileRegion::ProfileRegion(const std::string& name)
+    {
+        GetContext().EnterProfileRegion(name);
+    }
+
+    ProfileRegion::~ProfileRegion()
+    {
+        GetContext().ExitProfileRegion();
+    }
+
     Scalar Abs(Scalar s)
     {
         return *GetContext().Call(AbsFunctionDeclaration, { s.GetValue() });
@@ -11,6 +11,7 @@
 #include "Scalar.h"
 #include "Value.h"
 
+#include <emitters/include/IRMath.h>
 #include <emitters/include/IRModuleEmitter.h>
 
 #include <utilities/include/StringUtil.h>
@@ -191,9 +192,11 @@ namespace value
 
         LLVMValue ToLLVMValue(Value value) { return value.Get<Emittable>().GetDataAs<LLVMValue>(); }
 
-        auto SimpleNumericalFunctionIntrinsic(LLVMFunction (IRRuntime::*intrinsicFn)(VariableType)) -> std::function<Value(IRFunctionEmitter&, std::vector<Value>)>
+        // `fastFn`, if given, is an inline approximation of the function to emit for floating-point values when fast math is on
+        using FastMathFunction = IRLocalScalar (*)(IRLocalScalar, FastMathAccuracy);
+        auto SimpleNumericalFunctionIntrinsic(LLVMFunction (IRRuntime::*intrinsicFn)(VariableType), FastMathFunction fastFn = nullptr) -> std::function<Value(IRFunctionEmitter&, std::vector<Value>)>
         {
-            return [intrinsicFn](IRFunctionEmitter& fnEmitter, std::vector<Value> args) -> Value {
+            return [intrinsicFn, fastFn](IRFunctionEmitter& fnEmitter, std::vector<Value> args) -> Value {
                 if (args.size() != 1)
                 {
                     throw InputException(InputExceptionErrors::invalidSize);
@@ -216,6 +219,8 @@ namespace value
                 }(value.GetBaseType());
 
                 auto llvmFunc = std::invoke(intrinsicFn, fnEmitter.GetModule().GetRuntime(), variableType);
+                const auto& options = fnEmitter.GetCompilerOptions();
+                auto useFastFn = fastFn != nullptr && options.useFastMath && options.fastMathAccuracy != FastMathAccuracy::exact;
 
                 Value returnValue = value::Allocate(value.GetBaseType(),
                                                     value.IsConstrained() ? value.GetLayout() : ScalarLayout);
@@ -233,7 +238,8 @@ namespace value
                     LLVMValue resultValue = nullptr;
                     if (value.IsFloatingPoint() || value.IsFloatingPointPointer())
                     {
-                        resultValue = fnEmitter.Call(llvmFunc, { fnEmitter.ValueAt(inputLLVMValue, offset) });
+                        auto inputValue = fnEmitter.ValueAt(inputLLVMValue, offset);
+                        resultValue = useFastFn ? fastFn(fnEmitter.LocalScalar(inputValue), options.fastMathAccuracy).value : fnEmitter.Call(llvmFunc, { inputValue });
                     }
                     else
                     {
@@ -746,17 +752,44 @@ namespace value
         }
 
         auto logicalOrder = layout.GetLogicalDimensionOrder();
+        auto callBody = [&fn, logicalOrder](const std::vector<emitters::IRLocalScalar>& indices) {
+            std::vector<Scalar> logicalIndices(indices.size());
+            for (int index = 0; index < static_cast<int>(indices.size()); ++index)
+            {
+                logicalIndices[logicalOrder[index]] = Scalar(Value(indices[index].value, ScalarLayout));
+            }
+            fn(logicalIndices);
+        };
 
-        GetFunctionEmitter().For(
-            ranges,
-            [&fn, logicalOrder](emitters::IRFunctionEmitter&, std::vector<emitters::IRLocalScalar> indices) {
-                std::vector<Scalar> logicalIndices(indices.size());
-                for (int index = 0; index < static_cast<int>(indices.size()); ++index)
-                {
-                    logicalIndices[logicalOrder[index]] = Scalar(Value(indices[index].value, ScalarLayout));
-                }
-                fn(logicalIndices);
+        auto& fnEmitter = GetFunctionEmitter();
+        const auto& compilerOptions = fnEmitter.GetCompilerOptions();
+        // Only a contiguous innermost dimension is worth vectorizing: padding is fine, since the loop only covers the
+        // active area, but elements an increment apart would need strided loads
+        if (!compilerOptions.allowVectorInstructions || compilerOptions.vectorWidth <= 1 || ranges.empty() || layout.GetCumulativeIncrement(ranges.size() - 1) != 1)
+        {
+            fnEmitter.For(ranges, [&callBody](emitters::IRFunctionEmitter&, std::vector<emitters::IRLocalScalar> indices) { callBody(indices); });
+            return;
+        }
+
+        // The innermost physical dimension is contiguous in memory, so we ask for it to be vectorized
+        auto innerRange = ranges.back();
+        ranges.pop_back();
+        auto emitInnerLoop = [&callBody, innerRange, vectorWidth = compilerOptions.vectorWidth](emitters::IRFunctionEmitter& function, std::vector<emitters::IRLocalScalar> outerIndices) {
+            function.VectorizedFor(function.Literal<int>(innerRange.begin), function.Literal<int>(innerRange.end), vectorWidth, [&callBody, &outerIndices](emitters::IRFunctionEmitter&, emitters::IRLocalScalar innerIndex) {
+                auto indices = outerIndices;
+                indices.push_back(innerIndex);
+                callBody(indices);
             });
+        };
+
+        if (ranges.empty())
+        {
+            emitInnerLoop(fnEmitter, {});
+        }
+        else
+        {
+            fnEmitter.For(ranges, emitInnerLoop);
+        }
     }
 
     void LLVMContext::ForImpl(Scalar start, Scalar stop, Scalar step, std::function<void(Scalar)> fn)
@@ -775,6 +808,44 @@ namespace value
             });
     }
 
+    void LLVMContext::ParallelForImpl(Scalar start, Scalar stop, Scalar step, int numTasks, std::vector<Value> capturedValues, std::function<void(Scalar, std::vector<Value>)> fn)
+    {
+        auto startValue = EnsureEmittable(start.GetValue());
+        auto stopValue = EnsureEmittable(stop.GetValue());
+        auto stepValue = EnsureEmittable(step.GetValue());
+
+        std::vector<LLVMValue> llvmCapturedValues;
+        for (auto& value : capturedValues)
+        {
+            value = EnsureEmittable(value);
+            llvmCapturedValues.push_back(ToLLVMValue(value));
+        }
+
+        // The body is emitted into the task function that the loop emitter gives us, so values are emitted into it
+        // while it runs, and the captured values are replaced by the task function's arguments
+        auto& fnEmitter = GetFunctionEmitter();
+        fnEmitter.ParallelFor(
+            fnEmitter.Load(ToLLVMValue(startValue)),
+            fnEmitter.Load(ToLLVMValue(stopValue)),
+            fnEmitter.Load(ToLLVMValue(stepValue)),
+            emitters::ParallelLoopOptions{ numTasks },
+            llvmCapturedValues,
+            [&](IRFunctionEmitter& taskFunction, IRLocalScalar iterationVariable, std::vector<LLVMValue> taskCapturedValues) {
+                _functionStack.push(taskFunction);
+                _promotedConstantStack.push({});
+
+                auto taskValues = capturedValues;
+                for (size_t index = 0; index < taskValues.size(); ++index)
+                {
+                    taskValues[index].SetData(Emittable{ taskCapturedValues[index] });
+                }
+                fn(Value{ Emittable{ iterationVariable.value }, ScalarLayout }, taskValues);
+
+                _promotedConstantStack.pop();
+                _functionStack.pop();
+            });
+    }
+
     void LLVMContext::MoveDataImpl(Value& source, Value& destination)
     {
         // we treat a move the same as a copy, except we clear out the source
@@ -1236,14 +1307,31 @@ namespace value
         }
     }
 
+    void LLVMContext::EnterProfileRegionImpl(const std::string& name)
+    {
+        _profileRegions.emplace(GetFunctionEmitter(), name);
+        _profileRegions.top().Enter();
+    }
+
+    void LLVMContext::ExitProfileRegionImpl()
+    {
+        if (_profileRegions.empty())
+        {
+            throw LogicException(LogicExceptionErrors::illegalState, "Exiting a profile region that wasn't entered");
+        }
+
+        _profileRegions.top().Exit();
+        _profileRegions.pop();
+    }
+
     Value LLVMContext::IntrinsicCall(FunctionDeclaration intrinsic, std::vector<Value> args)
     {
         static std::unordered_map<FunctionDeclaration, std::function<Value(IRFunctionEmitter&, std::vector<Value>)>> intrinsics =
             {
                 { AbsFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetAbsFunction) },
                 { CosFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetCosFunction) },
-                { ExpFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetExpFunction) },
-                { LogFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetLogFunction) },
+                { ExpFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetExpFunction, &FastExp) },
+                { LogFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetLogFunction, &FastLog) },
                 { Log10FunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetLog10Function) },
                 { Log2FunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetLog2Function) },
                 { MaxNumFunctionDeclaration, MaxMinIntrinsicFunction(MaxMinIntrinsic::Max) },
@@ -1251,7 +1339,7 @@ namespace value
                 { PowFunctionDeclaration, PowFunctionIntrinsic() },
                 { SinFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetSinFunction) },
                 { SqrtFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetSqrtFunction) },
-                { TanhFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetTanhFunction) },
+                { TanhFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetTanhFunction, &FastTanh) },
                 { RoundFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetRoundFunction) },
                 { FloorFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetFloorFunction) },
                 { CeilFunctionDeclaration, SimpleNumericalFunctionIntrinsic(&IRRuntime::GetCeilFunction) },
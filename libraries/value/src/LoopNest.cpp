@@ -0,0 +1,247 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     LoopNest.cpp (value)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "LoopNest.h"
+#include "EmitterContext.h"
+#include "ScalarOperations.h"
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <optional>
+
+namespace ell
+{
+using namespace utilities;
+
+namespace value
+{
+    LoopNest::LoopNest(std::vector<int> extents) :
+        _extents(std::move(extents))
+    {
+        for (int dimension = 0; dimension < static_cast<int>(_extents.size()); ++dimension)
+        {
+            if (_extents[dimension] < 0)
+            {
+                throw InputException(InputExceptionErrors::invalidArgument, "Loop extents must be >= 0");
+            }
+            _loops.push_back({ _nextId++, dimension, 1, _extents[dimension], LoopKind::serial, 0 });
+        }
+    }
+
+    LoopIndex LoopNest::GetIndex(int dimension) const
+    {
+        if (dimension < 0 || dimension >= static_cast<int>(_extents.size()))
+        {
+            throw InputException(InputExceptionErrors::indexOutOfRange, "Invalid dimension");
+        }
+        return LoopIndex(dimension);
+    }
+
+    std::pair<LoopIndex, LoopIndex> LoopNest::Split(LoopIndex index, int size)
+    {
+        if (size <= 0)
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "Split size must be positive");
+        }
+
+        auto position = GetPosition(index);
+        auto loop = _loops[position];
+        if (loop.extent % size != 0 && !IsOutermostLoopOfDimension(position))
+        {
+            // Only the outermost loop of a dimension is bounded by the dimension's extent, which is checked when
+            // the kernel runs. An inner loop split unevenly would run some iterations twice.
+            throw InputException(InputExceptionErrors::invalidArgument, "Only the outermost loop of a dimension can be split into uneven blocks");
+        }
+
+        Loop outer = { _nextId++, loop.dimension, loop.stride * size, (loop.extent + size - 1) / size, LoopKind::serial, 0 };
+        Loop inner = { _nextId++, loop.dimension, loop.stride, std::min(size, loop.extent), LoopKind::serial, 0 };
+        _loops[position] = outer;
+        _loops.insert(_loops.begin() + position + 1, inner);
+        return { LoopIndex(outer.id), LoopIndex(inner.id) };
+    }
+
+    std::array<LoopIndex, 4> LoopNest::Tile(LoopIndex i, LoopIndex j, int sizeI, int sizeJ)
+    {
+        auto [iOuter, iInner] = Split(i, sizeI);
+        auto [jOuter, jInner] = Split(j, sizeJ);
+        Reorder({ iOuter, jOuter, iInner, jInner });
+        return { iOuter, jOuter, iInner, jInner };
+    }
+
+    LoopNest& LoopNest::Reorder(std::vector<LoopIndex> order)
+    {
+        std::vector<size_t> positions;
+        for (auto index : order)
+        {
+            positions.push_back(GetPosition(index));
+        }
+
+        auto sortedPositions = positions;
+        std::sort(sortedPositions.begin(), sortedPositions.end());
+        if (std::adjacent_find(sortedPositions.begin(), sortedPositions.end()) != sortedPositions.end())
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "A loop can only appear once in a reordering");
+        }
+
+        auto loops = _loops;
+        for (size_t index = 0; index < positions.size(); ++index)
+        {
+            loops[sortedPositions[index]] = _loops[positions[index]];
+        }
+        _loops = loops;
+        return *this;
+    }
+
+    LoopNest& LoopNest::Unroll(LoopIndex index)
+    {
+        _loops[GetPosition(index)].kind = LoopKind::unrolled;
+        return *this;
+    }
+
+    LoopNest& LoopNest::Vectorize(LoopIndex index)
+    {
+        auto position = GetPosition(index);
+        if (position != _loops.size() - 1)
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "Only the innermost loop can be vectorized");
+        }
+        _loops[position].kind = LoopKind::vectorized;
+        return *this;
+    }
+
+    LoopNest& LoopNest::Parallelize(LoopIndex index, int numTasks)
+    {
+        auto position = GetPosition(index);
+        if (position != 0)
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "Only the outermost loop can be parallelized");
+        }
+        _loops[position].kind = LoopKind::parallel;
+        _loops[position].numTasks = numTasks;
+        return *this;
+    }
+
+    void LoopNest::Run(std::function<void(std::vector<Scalar>)> kernel) const
+    {
+        Run({}, [kernel = std::move(kernel)](std::vector<Scalar> indices, std::vector<Value>) { kernel(indices); });
+    }
+
+    void LoopNest::Run(std::vector<Value> capturedValues, std::function<void(std::vector<Scalar>, std::vector<Value>)> kernel) const
+    {
+        if (std::any_of(_extents.begin(), _extents.end(), [](int extent) { return extent == 0; }))
+        {
+            return;
+        }
+
+        EmitLoops(0, {}, capturedValues, kernel);
+    }
+
+    size_t LoopNest::GetPosition(LoopIndex index) const
+    {
+        auto it = std::find_if(_loops.begin(), _loops.end(), [index](const Loop& loop) { return loop.id == index._id; });
+        if (it == _loops.end())
+        {
+            throw InputException(InputExceptionErrors::invalidArgument, "Loop isn't part of the nest (it may have been split)");
+        }
+        return static_cast<size_t>(it - _loops.begin());
+    }
+
+    bool LoopNest::IsOutermostLoopOfDimension(size_t position) const
+    {
+        const auto& loop = _loops[position];
+        return std::none_of(_loops.begin(), _loops.end(), [&loop](const Loop& other) {
+            return other.dimension == loop.dimension && other.stride > loop.stride;
+        });
+    }
+
+    void LoopNest::EmitLoops(size_t position, std::vector<Scalar> loopIndices, std::vector<Value> capturedValues, const Kernel& kernel) const
+    {
+        if (position == _loops.size())
+        {
+            EmitKernel(loopIndices, capturedValues, kernel);
+            return;
+        }
+
+        // Assigning to a Scalar stores into it, so each iteration gets its own copy of the indices of the outer loops
+        auto emitInnerLoops = [&](Scalar index, std::vector<Value> innerCapturedValues) {
+            auto innerLoopIndices = loopIndices;
+            innerLoopIndices.push_back(index);
+            EmitLoops(position + 1, innerLoopIndices, innerCapturedValues, kernel);
+        };
+
+        const auto& loop = _loops[position];
+        switch (loop.kind)
+        {
+        case LoopKind::serial:
+            ForRange(loop.extent, [&](Scalar index) { emitInnerLoops(index, capturedValues); });
+            break;
+
+        case LoopKind::unrolled:
+        case LoopKind::vectorized:
+            for (int index = 0; index < loop.extent; ++index)
+            {
+                emitInnerLoops(index, capturedValues);
+            }
+            break;
+
+        case LoopKind::parallel:
+            // The tasks may run in their own function, so they get their own copies of the captured values
+            ParallelFor(loop.extent, loop.numTasks, capturedValues, emitInnerLoops);
+            break;
+        }
+    }
+
+    void LoopNest::EmitKernel(const std::vector<Scalar>& loopIndices, std::vector<Value> capturedValues, const Kernel& kernel) const
+    {
+        // The logical index of a dimension is the sum of its loops' indices times their strides
+        std::vector<Scalar> indices;
+        std::vector<bool> needsBoundsCheck;
+        for (int dimension = 0; dimension < static_cast<int>(_extents.size()); ++dimension)
+        {
+            std::optional<Scalar> index;
+            bool uneven = false;
+            for (size_t position = 0; position < _loops.size(); ++position)
+            {
+                const auto& loop = _loops[position];
+                if (loop.dimension != dimension)
+                {
+                    continue;
+                }
+
+                auto term = loop.stride == 1 ? loopIndices[position] : loopIndices[position] * loop.stride;
+                if (index)
+                {
+                    index.emplace(*index + term);
+                }
+                else
+                {
+                    index.emplace(term);
+                }
+                uneven = uneven || (IsOutermostLoopOfDimension(position) && loop.stride * loop.extent > _extents[dimension]);
+            }
+            indices.push_back(*index);
+            needsBoundsCheck.push_back(uneven);
+        }
+
+        // Dimensions split into uneven blocks run past their end in the last block
+        std::function<void()> body = [&] { kernel(indices, capturedValues); };
+        for (size_t dimension = 0; dimension < indices.size(); ++dimension)
+        {
+            if (needsBoundsCheck[dimension])
+            {
+                body = [&indices, dimension, extent = _extents[dimension], inner = body] {
+                    If(indices[dimension] < extent, inner);
+                };
+            }
+        }
+        body();
+    }
+
+} // namespace value
+} // namespace ell
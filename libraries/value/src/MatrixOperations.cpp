@@ -8,8 +8,16 @@
 
 #include "MatrixOperations.h"
 #include "EmitterContext.h"
+#include "FunctionDeclaration.h"
+#include "LLVMContext.h"
 #include "Matrix.h"
 #include "Scalar.h"
+#include "Vector.h"
+
+#include <emitters/include/GemmTileSizes.h>
+#include <emitters/include/IRModuleEmitter.h>
+
+#include <algorithm>
 
 namespace ell
 {
@@ -42,7 +50,208 @@ namespace value
         });
     }
 
-    Matrix GEMM(Matrix m1, Matrix m2) { throw LogicException(LogicExceptionErrors::notImplemented); }
+    namespace
+    {
+        // Values from cblas.h
+        constexpr int c_cblasRowMajor = 101;
+        constexpr int c_cblasNoTranspose = 111;
+
+        void SimpleGEMM(Matrix A, Matrix B, Matrix C)
+        {
+            For(C, [&](Scalar row, Scalar column) {
+                Scalar sum = Allocate(C.Type(), ScalarLayout);
+                ForRange(static_cast<int>(A.Columns()), [&](Scalar index) {
+                    sum += A(row, index) * B(index, column);
+                });
+                C(row, column) = sum;
+            });
+        }
+
+        // Computes C += A * B by packing blocks of A and B into contiguous scratch buffers and multiplying those
+        // one register tile at a time. The packed buffers are padded with zeros out to whole tiles, so the inner
+        // loops have constant trip counts, and only the valid part of each register tile is added to C.
+        void BlockedGEMM(Matrix A, Matrix B, Matrix C, const emitters::GemmTileSizes& tiles)
+        {
+            const int m = static_cast<int>(A.Rows());
+            const int n = static_cast<int>(B.Columns());
+            const int k = static_cast<int>(A.Columns());
+            const auto mr = tiles.mr;
+            const auto nr = tiles.nr;
+            const auto kc = tiles.kc;
+            const auto mc = tiles.mc;
+            const auto nc = tiles.nc;
+            const auto type = C.Type();
+            const auto zero = Cast(0, type);
+
+            // packedA holds mc / mr row panels of A, each stored as kc columns of mr elements
+            // packedB holds nc / nr column panels of B, each stored as kc rows of nr elements
+            Vector packedA = Allocate(type, MemoryLayout({ mc * kc }));
+            Vector packedB = Allocate(type, MemoryLayout({ kc * nc }));
+            Matrix tile = Allocate(type, MemoryLayout({ mr, nr }));
+
+            ForRange(0, n, nc, [&](Scalar jc) {
+                ForRange(0, k, kc, [&](Scalar pc) {
+                    ForRange(nc / nr, [&](Scalar panel) {
+                        ForRange(kc, [&](Scalar p) {
+                            ForRange(nr, [&](Scalar j) {
+                                Scalar row = pc + p;
+                                Scalar column = jc + panel * nr + j;
+                                Scalar packedIndex = (panel * kc + p) * nr + j;
+                                If(row < k && column < n, [&] {
+                                    packedB(packedIndex) = B(row, column);
+                                }).Else([&] {
+                                    packedB(packedIndex) = zero;
+                                });
+                            });
+                        });
+                    });
+
+                    ForRange(0, m, mc, [&](Scalar ic) {
+                        ForRange(mc / mr, [&](Scalar panel) {
+                            ForRange(kc, [&](Scalar p) {
+                                ForRange(mr, [&](Scalar i) {
+                                    Scalar row = ic + panel * mr + i;
+                                    Scalar column = pc + p;
+                                    Scalar packedIndex = (panel * kc + p) * mr + i;
+                                    If(row < m && column < k, [&] {
+                                        packedA(packedIndex) = A(row, column);
+                                    }).Else([&] {
+                                        packedA(packedIndex) = zero;
+                                    });
+                                });
+                            });
+                        });
+
+                        ForRange(nc / nr, [&](Scalar jr) {
+                            If(jc + jr * nr < n, [&] {
+                                ForRange(mc / mr, [&](Scalar ir) {
+                                    If(ic + ir * mr < m, [&] {
+                                        For(tile, [&](Scalar i, Scalar j) {
+                                            tile(i, j) = zero;
+                                        });
+
+                                        ForRange(kc, [&](Scalar p) {
+                                            Scalar aOffset = (ir * kc + p) * mr;
+                                            Scalar bOffset = (jr * kc + p) * nr;
+                                            For(tile, [&](Scalar i, Scalar j) {
+                                                tile(i, j) += packedA(aOffset + i) * packedB(bOffset + j);
+                                            });
+                                        });
+
+                                        For(tile, [&](Scalar i, Scalar j) {
+                                            Scalar row = ic + ir * mr + i;
+                                            Scalar column = jc + jr * nr + j;
+                                            If(row < m && column < n, [&] {
+                                                C(row, column) += tile(i, j);
+                                            });
+                                        });
+                                    });
+                                });
+                            });
+                        });
+                    });
+                });
+            });
+        }
+
+        bool CanCallBlas(const Matrix& matrix)
+        {
+            const auto& layout = matrix.GetValue().GetLayout();
+            return layout.IsCanonicalOrder() && layout.GetCumulativeIncrement(1) == 1;
+        }
+
+        template <typename T>
+        void BlasGEMM(std::string name, Matrix A, Matrix B, Matrix C)
+        {
+            const auto type = GetValueType<T>();
+            auto fn = DeclareFunction(name)
+                          .Parameters(
+                              Value({ ValueType::Int32, 0 }, ScalarLayout), /*order*/
+                              Value({ ValueType::Int32, 0 }, ScalarLayout), /*transA*/
+                              Value({ ValueType::Int32, 0 }, ScalarLayout), /*transB*/
+                              Value({ ValueType::Int32, 0 }, ScalarLayout), /*m*/
+                              Value({ ValueType::Int32, 0 }, ScalarLayout), /*n*/
+                              Value({ ValueType::Int32, 0 }, ScalarLayout), /*k*/
+                              Value({ type, 0 }, ScalarLayout), /*alpha*/
+                              Value({ type, 1 }, A.GetValue().GetLayout()), /*A*/
+                              Value({ ValueType::Int32, 0 }, ScalarLayout), /*lda*/
+                              Value({ type, 1 }, B.GetValue().GetLayout()), /*B*/
+                              Value({ ValueType::Int32, 0 }, ScalarLayout), /*ldb*/
+                              Value({ type, 0 }, ScalarLayout), /*beta*/
+                              Value({ type, 1 }, C.GetValue().GetLayout()), /*C*/
+                              Value({ ValueType::Int32, 0 }, ScalarLayout)); /*ldc*/
+
+            fn.Decorated(FunctionDecorated::No)
+                .Call(
+                    { c_cblasRowMajor,
+                      c_cblasNoTranspose,
+                      c_cblasNoTranspose,
+                      static_cast<int>(A.Rows()),
+                      static_cast<int>(B.Columns()),
+                      static_cast<int>(A.Columns()),
+                      static_cast<T>(1),
+                      A.GetValue(),
+                      static_cast<int>(A.GetValue().GetLayout().GetCumulativeIncrement(0)),
+                      B.GetValue(),
+                      static_cast<int>(B.GetValue().GetLayout().GetCumulativeIncrement(0)),
+                      static_cast<T>(0),
+                      C.GetValue(),
+                      static_cast<int>(C.GetValue().GetLayout().GetCumulativeIncrement(0)) });
+        }
+    } // namespace
+
+    Matrix GEMM(Matrix m1, Matrix m2)
+    {
+        if (m1.Columns() != m2.Rows())
+        {
+            throw InputException(InputExceptionErrors::sizeMismatch);
+        }
+        if (m1.Type() != m2.Type())
+        {
+            throw InputException(InputExceptionErrors::typeMismatch);
+        }
+
+        const auto type = m1.Type();
+        Matrix result = Allocate(type, MemoryLayout({ static_cast<int>(m1.Rows()), static_cast<int>(m2.Columns()) }));
+        if (result.Size() == 0 || m1.Columns() == 0)
+        {
+            return result; // Allocate zero-initializes the result
+        }
+
+        const bool isFloatingPoint = type == ValueType::Float || type == ValueType::Double;
+        auto emitted = InvokeForContext<LLVMContext>([&](LLVMContext& context) {
+            const auto& options = context.GetModuleEmitter().GetCompilerOptions();
+            if (isFloatingPoint && options.useBlas && CanCallBlas(m1) && CanCallBlas(m2) && CanCallBlas(result))
+            {
+                if (type == ValueType::Float)
+                {
+                    BlasGEMM<float>("cblas_sgemm", m1, m2, result);
+                }
+                else
+                {
+                    BlasGEMM<double>("cblas_dgemm", m1, m2, result);
+                }
+            }
+            else if (isFloatingPoint && options.useBlockedGemm)
+            {
+                auto elementSize = static_cast<int>(type == ValueType::Float ? sizeof(float) : sizeof(double));
+                auto tiles = emitters::GetGemmTileSizes(options, elementSize, static_cast<int>(m1.Rows()), static_cast<int>(m2.Columns()), static_cast<int>(m1.Columns()));
+                BlockedGEMM(m1, m2, result, tiles);
+            }
+            else
+            {
+                SimpleGEMM(m1, m2, result);
+            }
+            return true;
+        });
+
+        if (!emitted)
+        {
+            SimpleGEMM(m1, m2, result);
+        }
+
+        return result;
+    }
 
     Vector GEMV(Matrix m, Vector v) { throw LogicException(LogicExceptionErrors::notImplemented); }
 
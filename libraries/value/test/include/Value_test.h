@@ -31,10 +31,18 @@ value::Scalar Casting_test1();
 value::Scalar If_test1();
 value::Scalar Sum_test();
 value::Scalar Dot_test();
+value::Scalar GEMM_test();
 value::Scalar Intrinsics_test1();
 value::Scalar Intrinsics_test2();
 value::Scalar For_test1();
 value::Scalar For_test2();
+value::Scalar For_test3();
+value::Scalar ProfileRegion_test1();
+value::Scalar ParallelFor_test1();
+value::Scalar Parallelize_test1();
+value::Scalar LoopNest_test1();
+value::Scalar LoopNest_test2();
+value::Scalar ComputeContext_jit_test1();
 
 void DebugPrint(std::string message);
 void DebugPrint(value::Vector message); // expecting null terminated ValueType::Char8
@@ -11,6 +11,7 @@
 #include <value/include/ComputeContext.h>
 #include <value/include/FunctionDeclaration.h>
 #include <value/include/LLVMContext.h>
+#include <value/include/LoopNest.h>
 #include <value/include/Matrix.h>
 #include <value/include/Tensor.h>
 #include <value/include/Value.h>
@@ -350,6 +351,32 @@ Scalar For_test1()
     return Verify(input, actual);
 }
 
+Scalar ProfileRegion_test1()
+{
+    Vector input(std::vector<int>({ 1, 2, 3, 4 }));
+    Vector actual = MakeVector<int>(input.Size());
+    {
+        ProfileRegion region("ProfileRegion_test1_copy");
+        For(input, [&](Scalar index) {
+            ProfileRegion elementRegion("ProfileRegion_test1_element");
+            actual(index) = input(index);
+        });
+    }
+
+    Scalar ok = Allocate(ValueType::Int32, ScalarLayout);
+    ok = Verify(input, actual);
+
+    // The ComputeContext times the regions as the code runs
+    InvokeForContext<ComputeContext>([&](auto& context) {
+        auto regions = context.GetProfileRegions();
+        if (regions["ProfileRegion_test1_copy"].count != 1 || regions["ProfileRegion_test1_element"].count != 4)
+        {
+            ok = 1;
+        }
+    });
+    return ok;
+}
+
 void TripleLoop(value::Vector input, value::Vector output)
 {
     if (input.Size() == 0)
@@ -391,6 +418,173 @@ Scalar For_test2()
     return Verify(output, expected);
 }
 
+Scalar For_test3()
+{
+    // A 3x4 matrix stored with padding (in a 5x6 buffer at offset (1, 1)), and a vector whose elements are 6 apart
+    constexpr int rows = 3, columns = 4;
+    std::vector<int> data(5 * 6);
+    std::iota(data.begin(), data.end(), 0);
+    Matrix padded(Value(data, MemoryLayout(MemoryShape{ rows, columns }, MemoryShape{ 5, 6 }, MemoryShape{ 1, 1 })));
+
+    Vector expected(std::vector<int>{ 7, 8, 9, 10, 13, 14, 15, 16, 19, 20, 21, 22 });
+    Vector actual = MakeVector<int>(rows * columns);
+    For(padded, [&](Scalar row, Scalar column) {
+        actual(row * columns + column) = padded(row, column);
+    });
+
+    Vector strided(Value(data, MemoryLayout(MemoryShape{ rows }, MemoryShape{ 5 * 6 }, MemoryShape{ 0 }, MemoryShape{ 6 })));
+    Vector expectedStrided(std::vector<int>{ 0, 6, 12 });
+    Vector actualStrided = MakeVector<int>(rows);
+    For(strided, [&](Scalar index) {
+        actualStrided(index) = strided(index);
+    });
+
+    Scalar ok = Allocate(ValueType::Int32, ScalarLayout);
+    ok = Verify(actual, expected);
+    If(Verify(actualStrided, expectedStrided) != 0, [&] {
+        DebugPrint("For_test3 strided vector copy failed\n");
+        ok = 1;
+    });
+    return ok;
+}
+
+Scalar ParallelFor_test1()
+{
+    Vector input(std::vector<int>({ 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+    Vector expected(std::vector<int>({ 2, 4, 6, 8, 10, 12, 14, 16, 18 }));
+    Vector actual = MakeVector<int>(input.Size());
+    ParallelFor(static_cast<int>(input.Size()), 4, { input.GetValue(), actual.GetValue() }, [](Scalar index, std::vector<Value> captured) {
+        Vector taskInput = captured[0];
+        Vector taskOutput = captured[1];
+        taskOutput(index) = taskInput(index) * 2;
+    });
+    return Verify(actual, expected);
+}
+
+Scalar Parallelize_test1()
+{
+    Vector expected(std::vector<int>({ 0, 1, 2, 3 }));
+    Vector actual = MakeVector<int>(expected.Size());
+    Parallelize(static_cast<int>(expected.Size()), { actual.GetValue() }, [](Scalar taskIndex, std::vector<Value> captured) {
+        Vector taskOutput = captured[0];
+        taskOutput(taskIndex) = taskIndex;
+    });
+    return Verify(actual, expected);
+}
+
+Scalar ComputeContext_jit_test1()
+{
+    // Runs in its own context, so the result is returned as a plain int
+    int rc = 0;
+    {
+        ContextGuard<ComputeContext> guard("Value_test_compute_jit", ComputeContext::ExecutionMode::jit);
+
+        auto scale = DeclareFunction("ComputeContext_jit_test1_scale")
+                         .Parameters(
+                             Value(ValueType::Float, MemoryLayout{ { 4 } }),
+                             Value(ValueType::Float, ScalarLayout),
+                             Value(ValueType::Float, MemoryLayout{ { 4 } }))
+                         .Define([](Vector input, Scalar factor, Vector output) {
+                             For(input, [&](Scalar index) {
+                                 output(index) = input(index) * factor;
+                             });
+                         });
+
+        auto sum = DeclareFunction("ComputeContext_jit_test1_sum")
+                       .Parameters(Value(ValueType::Float, MemoryLayout{ { 4 } }))
+                       .Returns(Value(ValueType::Float, ScalarLayout))
+                       .Define([](Vector input) {
+                           return Sum(input);
+                       });
+
+        // Uses a value created outside of it, so it is interpreted
+        Vector offset(std::vector<float>({ 10, 20, 30, 40 }));
+        auto addOffset = DeclareFunction("ComputeContext_jit_test1_addOffset")
+                             .Parameters(Value(ValueType::Float, MemoryLayout{ { 4 } }))
+                             .Define([&](Vector input) {
+                                 For(input, [&](Scalar index) {
+                                     input(index) += offset(index);
+                                 });
+                             });
+
+        Vector input(std::vector<float>({ 1, 2, 3, 4 }));
+        Vector actual = MakeVector<float>(input.Size());
+        scale(input, Scalar(2.0f), actual);
+        if (Verify(actual, Vector(std::vector<float>({ 2, 4, 6, 8 }))).Get<int>() != 0)
+        {
+            rc = 1;
+        }
+
+        Scalar total = sum(actual);
+        if (total.Get<float>() != 20.0f)
+        {
+            rc = 1;
+        }
+
+        addOffset(actual);
+        if (Verify(actual, Vector(std::vector<float>({ 12, 24, 36, 48 }))).Get<int>() != 0)
+        {
+            rc = 1;
+        }
+    }
+    return rc;
+}
+
+namespace
+{
+Matrix MakeLoopNestTestMatrix(int rows, int columns, int offset)
+{
+    std::vector<std::vector<int>> data(rows, std::vector<int>(columns));
+    for (int i = 0; i < rows; ++i)
+    {
+        for (int j = 0; j < columns; ++j)
+        {
+            data[i][j] = offset + i * columns + j;
+        }
+    }
+    return Matrix(data);
+}
+} // namespace
+
+Scalar LoopNest_test1()
+{
+    // Tiles that don't divide the matrix evenly, unrolled and vectorized inner loops
+    const int rows = 5;
+    const int columns = 7;
+    Matrix A = MakeLoopNestTestMatrix(rows, columns, 0);
+    Matrix B = MakeLoopNestTestMatrix(rows, columns, 100);
+    Matrix expected = MakeLoopNestTestMatrix(rows, columns, 0) + MakeLoopNestTestMatrix(rows, columns, 100);
+    Matrix actual = MakeMatrix<int>(rows, columns);
+
+    LoopNest nest({ rows, columns });
+    auto [iOuter, jOuter, iInner, jInner] = nest.Tile(nest.GetIndex(0), nest.GetIndex(1), 2, 4);
+    nest.Reorder({ jOuter, iOuter }).Unroll(iInner).Vectorize(jInner);
+    nest.Run([&](std::vector<Scalar> index) {
+        actual(index[0], index[1]) = A(index[0], index[1]) + B(index[0], index[1]);
+    });
+    return Verify(actual, expected);
+}
+
+Scalar LoopNest_test2()
+{
+    // A parallel outer loop over blocks of rows
+    const int rows = 6;
+    const int columns = 3;
+    Matrix A = MakeLoopNestTestMatrix(rows, columns, 1);
+    Matrix expected = MakeLoopNestTestMatrix(rows, columns, 1) * 2;
+    Matrix actual = MakeMatrix<int>(rows, columns);
+
+    LoopNest nest({ rows, columns });
+    auto [iOuter, iInner] = nest.Split(nest.GetIndex(0), 2);
+    nest.Parallelize(iOuter, 3);
+    nest.Run({ A.GetValue(), actual.GetValue() }, [](std::vector<Scalar> index, std::vector<Value> captured) {
+        Matrix taskA = captured[0];
+        Matrix taskActual = captured[1];
+        taskActual(index[0], index[1]) = taskA(index[0], index[1]) * 2;
+    });
+    return Verify(actual, expected);
+}
+
 Scalar Scalar_test1()
 {
     Scalar ok = Allocate(ValueType::Int32, ScalarLayout);
@@ -1228,6 +1422,38 @@ Scalar Dot_test()
     return ok;
 }
 
+Scalar GEMM_test()
+{
+    Scalar ok = Allocate(ValueType::Int32, ScalarLayout);
+    ok = 0;
+
+    // Sizes that aren't multiples of the register tile sizes, to exercise the padding in the blocked kernel
+    const int m = 5, n = 6, k = 7;
+    std::vector<float> referenceA(m * k), referenceB(k * n), referenceC(m * n);
+    std::iota(referenceA.begin(), referenceA.end(), 0.f);
+    std::iota(referenceB.begin(), referenceB.end(), -10.f);
+    for (int i = 0; i < m; ++i)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            for (int p = 0; p < k; ++p)
+            {
+                referenceC[i * n + j] += referenceA[i * k + p] * referenceB[p * n + j];
+            }
+        }
+    }
+
+    Matrix A(referenceA, m, k);
+    Matrix B(referenceB, k, n);
+    Matrix expected(referenceC, m, n);
+    Matrix actual = GEMM(A, B);
+    If(0 != Verify(actual, expected), [&] {
+        DebugPrint("GEMM_test failed\n");
+        ok = 1;
+    });
+    return ok;
+}
+
 namespace
 {
 const std::vector<float> intrinsics_data{ 0.1f, 1.2f, 2.3f, 3.4f, 4.5f, 5.6f, 6.7f, 7.8f, 8.9f, 9.10f };
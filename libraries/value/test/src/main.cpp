@@ -195,11 +195,12 @@ void ComputeTest(std::string testName, std::function<Scalar()> defineFunction)
     ell::testing::ProcessTest(ell::utilities::FormatString(msg.c_str(), rc), rc == 0);
 }
 
-void LLVMJitTest(std::string testName, std::function<Scalar()> defineFunction)
+void LLVMJitTest(std::string testName, std::function<Scalar()> defineFunction, bool allowVectorInstructions = false)
 {
     // Run the test in the LLVM context
     ell::emitters::CompilerOptions compilerSettings;
     compilerSettings.useBlas = false;
+    compilerSettings.allowVectorInstructions = allowVectorInstructions;
     ell::emitters::IRModuleEmitter moduleEmitter("Value_test_llvm", compilerSettings);
     DeclarDebugPrintFunctions(moduleEmitter);
     ContextGuard<LLVMContext> guard(moduleEmitter);
@@ -256,16 +257,30 @@ int main()
         ADD_TEST_FUNCTION(Casting_test1);
         ADD_TEST_FUNCTION(Sum_test);
         ADD_TEST_FUNCTION(Dot_test);
+        ADD_TEST_FUNCTION(GEMM_test);
         ADD_TEST_FUNCTION(Intrinsics_test1);
         ADD_TEST_FUNCTION(Intrinsics_test2);
         ADD_TEST_FUNCTION(For_test1);
         ADD_TEST_FUNCTION(For_test2);
+        ADD_TEST_FUNCTION(For_test3);
+        ADD_TEST_FUNCTION(ProfileRegion_test1);
+        ADD_TEST_FUNCTION(ParallelFor_test1);
+        ADD_TEST_FUNCTION(Parallelize_test1);
+        ADD_TEST_FUNCTION(LoopNest_test1);
+        ADD_TEST_FUNCTION(LoopNest_test2);
+        ADD_TEST_FUNCTION(ComputeContext_jit_test1);
 
         for (auto [name, fn] : testFunctions)
         {
             RunTest(name, fn);
         }
 
+        // Loops over layouts are emitted differently when vector instructions are allowed
+        for (std::string name : { "For_test1", "For_test3", "Matrix_test1" })
+        {
+            LLVMJitTest(name, testFunctions[name], true);
+        }
+
 #undef ADD_TEST_FUNCTION
     }
     catch (const std::exception& exception)
@@ -38,6 +38,10 @@ def main(args):
     arg_parser.add_argument(
         "--zip_ell_model",
         help="zips the output ELL model if set", action="store_true")
+    arg_parser.add_argument(
+        "--binary_archive",
+        help="save the model in ELL's binary archive format (.ellb), which stores the weights as raw arrays\n"
+             "and loads much faster than the default JSON format", action="store_true")
     arg_parser.add_argument(
         "--use_legacy_importer",
         help="specifies whether to use the new importer engine or the legacy importer", action="store_true")
@@ -96,7 +100,7 @@ def main(args):
         predictor = cntk_to_ell.predictor_from_cntk_model(filename)
         ell_map = ell.neural.utilities.ell_map_from_predictor(predictor, step_interval, lag_threshold)
 
-    model_file_name = os.path.splitext(filename)[0] + ".ell"
+    model_file_name = os.path.splitext(filename)[0] + (".ellb" if args["binary_archive"] else ".ell")
 
     _logger.info("\nSaving model file: '" + model_file_name + "'")
     ell_map.Save(model_file_name)
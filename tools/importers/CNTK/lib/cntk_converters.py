@@ -114,19 +114,17 @@ def get_tensor_from_cntk_dense_weight_parameter(tensorParameter):
         orderedWeights = tensorValue
         orderedWeights = np.moveaxis(orderedWeights, 0, -1)
         orderedWeights = np.moveaxis(orderedWeights, 2, 0)
-        orderedWeights = orderedWeights.ravel().astype(np.float).reshape(
+        orderedWeights = np.ascontiguousarray(orderedWeights, dtype=np.float).reshape(
             tensorShape[3] * tensorShape[1], tensorShape[2], tensorShape[0])
     elif (len(tensorShape) == 3):
         orderedWeights = np.moveaxis(tensorValue, 0, -1)
-        orderedWeights = orderedWeights.ravel().astype(np.float).reshape(
+        orderedWeights = np.ascontiguousarray(orderedWeights, dtype=np.float).reshape(
             tensorShape[1], tensorShape[2], tensorShape[0])
     elif (len(tensorShape) == 2):
         orderedWeights = np.moveaxis(tensorValue, 0, -1)
-        orderedWeights = orderedWeights.ravel().astype(
-            np.float).reshape(tensorShape[1], 1, tensorShape[0])
+        orderedWeights = np.ascontiguousarray(orderedWeights, dtype=np.float).reshape(tensorShape[1], 1, tensorShape[0])
     else:
-        orderedWeights = tensorValue.ravel().astype(
-            np.float).reshape(1, 1, tensorValue.size)
+        orderedWeights = np.ascontiguousarray(tensorValue, dtype=np.float).reshape(1, 1, tensorValue.size)
     return ell.math.DoubleTensor(orderedWeights)
 
 
@@ -147,19 +145,17 @@ def get_tensor_from_cntk_convolutional_weight_value_shape(tensorValue, tensorSha
     """
     if (len(tensorShape) == 4):
         orderedWeights = np.moveaxis(tensorValue, 1, -1)
-        orderedWeights = orderedWeights.ravel().astype(np.float).reshape(
+        orderedWeights = np.ascontiguousarray(orderedWeights, dtype=np.float).reshape(
             tensorShape[0] * tensorShape[2], tensorShape[3], tensorShape[1])
     elif (len(tensorShape) == 3):
         orderedWeights = np.moveaxis(tensorValue, 0, -1)
-        orderedWeights = orderedWeights.ravel().astype(np.float).reshape(
+        orderedWeights = np.ascontiguousarray(orderedWeights, dtype=np.float).reshape(
             tensorShape[1], tensorShape[2], tensorShape[0])
     elif (len(tensorShape) == 2):
         orderedWeights = np.moveaxis(tensorValue, 0, -1)
-        orderedWeights = orderedWeights.ravel().astype(
-            np.float).reshape(tensorShape[1], tensorShape[0], 1)
+        orderedWeights = np.ascontiguousarray(orderedWeights, dtype=np.float).reshape(tensorShape[1], tensorShape[0], 1)
     else:
-        orderedWeights = tensorValue.ravel().astype(
-            np.float).reshape(1, 1, tensorValue.size)
+        orderedWeights = np.ascontiguousarray(tensorValue, dtype=np.float).reshape(1, 1, tensorValue.size)
     return ell.math.DoubleTensor(orderedWeights)
 
 
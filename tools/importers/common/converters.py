@@ -196,26 +196,14 @@ class LookupTable:
         'size'.
         """
         original_vector, order = self.tensors[uid]
-        # Workaround: For some reason, np.full is not returning a type that SWIG can parse.
-        # So just manually walk the array setting the scalar
-        array = np.zeros(size, dtype=np.float)
-        for i in range(array.size):
-            array[i] = original_vector
-        return array
+        return np.full(size, original_vector, dtype=np.float)
 
     def get_vector_in_ell_order(self, uid: str):
         """
         Returns a single dimensional numpy array containing the tensor weights.
         """
         original_vector, order = self.tensors[uid]
-
-        ordered_weights = np.zeros(original_vector.size, dtype=np.float)
-        i = 0
-        for value in original_vector:
-            ordered_weights[i] = value
-            i += 1
-
-        return ordered_weights
+        return np.ascontiguousarray(original_vector, dtype=np.float).ravel()
 
     def get_tensor_info(self, uid: str):
         """
@@ -397,12 +385,19 @@ class ConvertBase:
         """
         return memory_shapes.get_ell_shape(shape, order, padding)
 
+    def get_tensor(self, uid: str, conversion_parameters: typing.Mapping[str, typing.Any]):
+        """
+        Returns a weight tensor as a numpy array in ELL order, which can be passed directly to
+        ModelBuilder.AddConstantNode
+        """
+        lookup_table = conversion_parameters["lookup_table"]
+        return lookup_table.get_tensor_in_ell_order(uid)
+
     def get_ell_tensor(self, uid: str, conversion_parameters: typing.Mapping[str, typing.Any]):
         """
         Returns a weight tensor as an ELL tensor
         """
-        lookup_table = conversion_parameters["lookup_table"]
-        return ell.math.DoubleTensor(lookup_table.get_tensor_in_ell_order(uid))
+        return ell.math.DoubleTensor(self.get_tensor(uid, conversion_parameters))
 
     def get_vector(self, uid: str, conversion_parameters: typing.Mapping[str, typing.Any]):
         """
@@ -848,19 +843,19 @@ class ConvertGRU(ConvertBase):
         input_port_elements = lookup_table.get_port_elements_for_input(self.importer_node)
 
         # create constant nodes for the weights
-        input_weights = self.get_ell_tensor(
+        input_weights = self.get_tensor(
             self.importer_node.weights["input_weights"][0], conversion_parameters)
-        hidden_weights = self.get_ell_tensor(
+        hidden_weights = self.get_tensor(
             self.importer_node.weights["hidden_weights"][0], conversion_parameters)
-        input_bias = self.get_ell_tensor(
+        input_bias = self.get_tensor(
             self.importer_node.weights["input_bias"][0], conversion_parameters)
-        hidden_bias = self.get_ell_tensor(
+        hidden_bias = self.get_tensor(
             self.importer_node.weights["hidden_bias"][0], conversion_parameters)
 
-        input_weights_node = builder.AddConstantNode(model, input_weights.data, ell.nodes.PortType.smallReal)
-        hidden_weights_node = builder.AddConstantNode(model, hidden_weights.data, ell.nodes.PortType.smallReal)
-        input_bias_node = builder.AddConstantNode(model, input_bias.data, ell.nodes.PortType.smallReal)
-        hidden_bias = builder.AddConstantNode(model, hidden_bias.data, ell.nodes.PortType.smallReal)
+        input_weights_node = builder.AddConstantNode(model, input_weights, ell.nodes.PortType.smallReal)
+        hidden_weights_node = builder.AddConstantNode(model, hidden_weights, ell.nodes.PortType.smallReal)
+        input_bias_node = builder.AddConstantNode(model, input_bias, ell.nodes.PortType.smallReal)
+        hidden_bias = builder.AddConstantNode(model, hidden_bias, ell.nodes.PortType.smallReal)
 
         hidden_size = self.importer_node.attributes["hidden_size"]
         activation = self.importer_node.attributes["activation"]
@@ -1043,19 +1038,19 @@ class ConvertLSTM(ConvertBase):
         input_port_elements = lookup_table.get_port_elements_for_input(self.importer_node)
 
         # create constant nodes for the weights
-        input_weights = self.get_ell_tensor(
+        input_weights = self.get_tensor(
             self.importer_node.weights["input_weights"][0], conversion_parameters)
-        hidden_weights = self.get_ell_tensor(
+        hidden_weights = self.get_tensor(
             self.importer_node.weights["hidden_weights"][0], conversion_parameters)
-        input_bias = self.get_ell_tensor(
+        input_bias = self.get_tensor(
             self.importer_node.weights["input_bias"][0], conversion_parameters)
-        hidden_bias = self.get_ell_tensor(
+        hidden_bias = self.get_tensor(
             self.importer_node.weights["hidden_bias"][0], conversion_parameters)
 
-        input_weights_node = builder.AddConstantNode(model, input_weights.data, ell.nodes.PortType.smallReal)
-        hidden_weights_node = builder.AddConstantNode(model, hidden_weights.data, ell.nodes.PortType.smallReal)
-        input_bias_node = builder.AddConstantNode(model, input_bias.data, ell.nodes.PortType.smallReal)
-        hidden_bias = builder.AddConstantNode(model, hidden_bias.data, ell.nodes.PortType.smallReal)
+        input_weights_node = builder.AddConstantNode(model, input_weights, ell.nodes.PortType.smallReal)
+        hidden_weights_node = builder.AddConstantNode(model, hidden_weights, ell.nodes.PortType.smallReal)
+        input_bias_node = builder.AddConstantNode(model, input_bias, ell.nodes.PortType.smallReal)
+        hidden_bias = builder.AddConstantNode(model, hidden_bias, ell.nodes.PortType.smallReal)
 
         hidden_size = self.importer_node.attributes["hidden_size"]
         activation = self.importer_node.attributes["activation"]
@@ -1764,7 +1759,10 @@ class ConvertConstant(ConvertBase):
         elif tensor.dtype == np.bool:
             port_type = ell.nodes.PortType.boolean
 
-        ell_node = builder.AddConstantNode(model, tensor.ravel().astype(np.float64), port_type)
+        # float and double tensors are read in place, and other types are converted once
+        if tensor.dtype != np.float32:
+            tensor = tensor.astype(np.float64)
+        ell_node = builder.AddConstantNode(model, np.ascontiguousarray(tensor), port_type)
         lookup_table.add_imported_ell_node(self.importer_node, ell_node)
 
 
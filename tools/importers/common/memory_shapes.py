@@ -61,34 +61,34 @@ def get_ell_port_memory_layout(shape: tuple, order: str, padding: int = 0):
 
 def get_tensor_in_ell_order(tensor: np.array, order: str):
     """
-    Returns a numpy array in ELL order
+    Returns a numpy array in ELL order. The values are copied once, into a contiguous array of doubles
+    that ELL tensors and constant nodes read in place.
     """
     original_tensor = tensor
     original_shape = original_tensor.shape
     if order == "filter_channel_row_column":
         ordered_weights = np.moveaxis(original_tensor, 1, -1)
-        ordered_weights = ordered_weights.ravel().astype(np.float).reshape(
+        ordered_weights = np.ascontiguousarray(ordered_weights, dtype=np.float).reshape(
             original_shape[0] * original_shape[2], original_shape[3], original_shape[1])
     elif order == "channel_row_column":
         ordered_weights = np.moveaxis(original_tensor, 0, -1)
-        ordered_weights = ordered_weights.ravel().astype(np.float).reshape(
+        ordered_weights = np.ascontiguousarray(ordered_weights, dtype=np.float).reshape(
             original_shape[1], original_shape[2], original_shape[0])
     elif order == "column_row":
         ordered_weights = original_tensor.T
         # make it 3D tensor by adding 1 channel
-        ordered_weights = ordered_weights.ravel().astype(
-            np.float).reshape(original_shape[0], original_shape[1], 1)
+        ordered_weights = np.ascontiguousarray(ordered_weights, dtype=np.float).reshape(
+            original_shape[0], original_shape[1], 1)
     elif order == "row_column":
         # make it 3D tensor by adding 1 channel
-        ordered_weights = original_tensor.ravel().astype(
-            np.float).reshape(original_shape[0], original_shape[1], 1)
+        ordered_weights = np.ascontiguousarray(original_tensor, dtype=np.float).reshape(
+            original_shape[0], original_shape[1], 1)
     elif order == "channel":
-        ordered_weights = original_tensor.ravel().astype(
-            np.float).reshape(1, 1, original_tensor.size)
+        ordered_weights = np.ascontiguousarray(original_tensor, dtype=np.float).reshape(1, 1, original_tensor.size)
     elif order == "channel_row_column_filter":
         ordered_weights = np.moveaxis(original_tensor, 0, -1)
         ordered_weights = np.moveaxis(ordered_weights, 2, 0)
-        ordered_weights = ordered_weights.ravel().astype(np.float).reshape(
+        ordered_weights = np.ascontiguousarray(ordered_weights, dtype=np.float).reshape(
             original_shape[3] * original_shape[1], original_shape[2], original_shape[0])
     else:
         raise NotImplementedError(
@@ -25,6 +25,7 @@ class DarknetImporter:
         self.weights_file = args['weights_file']
         self.config_file = args['config_file']
         self.output_directory = args['output_directory']
+        self.binary_archive = args.get('binary_archive', False)
 
         self.step_interval = args['step_interval']
         self.lag_threshold = args['lag_threshold']
@@ -44,7 +45,7 @@ class DarknetImporter:
             output_directory = weights_directory
 
         filename_base = os.path.splitext(weights_filename)[0]
-        model_file_name = filename_base + '.ell'
+        model_file_name = filename_base + ('.ellb' if self.binary_archive else '.ell')
         model_file_path = os.path.join(output_directory, model_file_name)
         ell_map = ell.neural.utilities.ell_map_from_predictor(
             predictor, self.step_interval, self.lag_threshold)
@@ -65,6 +66,10 @@ if __name__ == "__main__":
     parser.add_argument(
         '-o', '--output_directory',
         help='Path to output directory (default: input weights file directory)')
+    parser.add_argument(
+        "--binary_archive",
+        help="save the model in ELL's binary archive format (.ellb), which stores the weights as raw arrays\n"
+             "and loads much faster than the default JSON format", action="store_true")
 
     model_options = parser.add_argument_group('model_options')
     model_options.add_argument(
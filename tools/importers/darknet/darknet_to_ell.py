@@ -13,7 +13,6 @@ import os
 sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), '../../utilities/pythonlibs'))
 from configparser import ConfigParser
 from collections import OrderedDict
-import struct
 import numpy as np
 import find_ell  # noqa 401
 import ell
@@ -221,10 +220,18 @@ def create_layer_parameters(inputShape, inputPadding, inputPaddingScheme, output
                                       ell.nodes.PortType.smallReal)
 
 
+def read_weights(weightsData, count):
+    """Reads the next 'count' 32-bit float values from the Darknet weights file, as an array of doubles"""
+    data = weightsData.read(4 * count)
+    if len(data) != 4 * count:
+        raise ValueError("Unexpected end of weights file")
+    return np.frombuffer(data, dtype=np.float32).astype(np.float)
+
+
 def get_weights_tensor(weightsShape, values):
     """Returns an ELL tensor from Darknet weights. The weights are re-ordered
        to rows, columns, channels"""
-    weights = np.array(values, dtype=np.float).reshape(weightsShape)
+    weights = np.asarray(values, dtype=np.float).reshape(weightsShape)
     if (len(weights.shape) == 3):
         orderedWeights = np.rollaxis(weights, 0, 3)
     elif (len(weights.shape) == 4):
@@ -325,30 +332,18 @@ def process_convolutional_layer(layer, bin_data, convolution_order):
     layers = []
 
     # Read in binary values
-    bias_vals = []
-    for i in range(int(layer['filters'])):
-        bias_vals.append(struct.unpack('f', bin_data.read(4)))
-    bias_vals = np.array(bias_vals, dtype=np.float)
+    bias_vals = read_weights(bin_data, int(layer['filters']))
     # now we need to check if these weights have batch normalization data
-    scale_vals = []
-    mean_vals = []
-    variance_vals = []
+    scale_vals = np.array([], dtype=np.float)
+    mean_vals = np.array([], dtype=np.float)
+    variance_vals = np.array([], dtype=np.float)
     if ('batch_normalize' in layer) and ('dontloadscales' not in layer):
-        for i in range(int(layer['filters'])):
-            scale_vals.append(struct.unpack('f', bin_data.read(4)))
-        for i in range(int(layer['filters'])):
-            mean_vals.append(struct.unpack('f', bin_data.read(4)))
-        for i in range(int(layer['filters'])):
-            variance_vals.append(struct.unpack('f', bin_data.read(4)))
-    scale_vals = np.array(scale_vals, dtype=np.float)
-    mean_vals = np.array(mean_vals, dtype=np.float)
-    variance_vals = np.array(variance_vals, dtype=np.float)
+        scale_vals = read_weights(bin_data, int(layer['filters']))
+        mean_vals = read_weights(bin_data, int(layer['filters']))
+        variance_vals = read_weights(bin_data, int(layer['filters']))
     # now we can load the convolutional weights
-    weight_vals = []
     num_weights = int(layer['size']) * int(layer['size']) * int(layer['c']) * int(layer['filters'])
-    for i in range(num_weights):
-        weight_vals.append(struct.unpack('f', bin_data.read(4)))
-    weight_vals = np.array(weight_vals, dtype=np.float)
+    weight_vals = read_weights(bin_data, num_weights)
 
     layerParameters = create_layer_parameters(
         layer['inputShape'], layer['inputPadding'], layer['inputPaddingScheme'],
@@ -451,16 +446,10 @@ def process_fully_connected_layer(layer, weightsData):
             layer['outputShapeMinusPadding'], 0, ell.neural.PaddingScheme.zeros,
             layer['outputShape'], layer['outputPadding'], layer['outputPaddingScheme'])
 
-    bias_vals = []
-    for i in range(int(layer['output'])):
-        bias_vals.append(struct.unpack('f', weightsData.read(4)))
-    bias_vals = np.array(bias_vals, dtype=np.float)
+    bias_vals = read_weights(weightsData, int(layer['output']))
 
-    weight_vals = []
     num_weights = int(layer['output']) * int(layer['inputs'])
-    for i in range(num_weights):
-        weight_vals.append(struct.unpack('f', weightsData.read(4)))
-    weight_vals = np.array(weight_vals, dtype=np.float)
+    weight_vals = read_weights(weightsData, num_weights)
 
     orderedWeights = weight_vals.reshape(
         layer['out_h'] * layer['out_w'] * layer['out_c'], layer['c'], layer['h'], layer['w'])
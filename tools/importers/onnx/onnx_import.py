@@ -27,7 +27,7 @@ import ziptools
 _logger = logger.get()
 
 
-def convert(model, output=None, zip_ell_model=None, step_interval=None, lag_threshold=None):
+def convert(model, output=None, zip_ell_model=None, step_interval=None, lag_threshold=None, binary_archive=False):
     model_directory, filename = os.path.split(model)
     if output:
         output_directory = output
@@ -35,7 +35,7 @@ def convert(model, output=None, zip_ell_model=None, step_interval=None, lag_thre
         output_directory = model_directory
 
     filename_base = os.path.splitext(filename)[0]
-    model_file_name = filename_base + '.ell'
+    model_file_name = filename_base + ('.ellb' if binary_archive else '.ell')
     model_file_path = os.path.join(output_directory, model_file_name)
 
     ell_map, _ = onnx_to_ell.convert_onnx_to_ell(model, step_interval_msec=step_interval,
@@ -65,6 +65,10 @@ def main():
     parser.add_argument(
         "--zip_ell_model",
         help="zips the output ELL model if set", action="store_true")
+    parser.add_argument(
+        "--binary_archive",
+        help="save the model in ELL's binary archive format (.ellb), which stores the weights as raw arrays\n"
+             "and loads much faster than the default JSON format", action="store_true")
     parser.add_argument(
         "--verbose",
         help="print verbose output during the import. Helps to diagnose ", action="store_true")
@@ -88,7 +92,8 @@ def main():
     args = parser.parse_args()
     logger.setup(args)
 
-    convert(args.input, args.output_directory, args.zip_ell_model, args.step_interval, args.lag_threshold)
+    convert(args.input, args.output_directory, args.zip_ell_model, args.step_interval, args.lag_threshold,
+            args.binary_archive)
 
 
 if __name__ == "__main__":
@@ -73,8 +73,7 @@ int main(int argc, char* argv[])
 
         // load dataset
         if (trainerArguments.verbose) std::cout << "Loading data ..." << std::endl;
-        auto stream = utilities::OpenIfstream(dataLoadArguments.inputDataFilename);
-        auto parsedDataset = common::GetDataset(stream);
+        auto parsedDataset = common::LoadDataset(dataLoadArguments.inputDataFilename);
         auto mappedDataset = common::TransformDataset(parsedDataset, map);
 
         // predictor type
@@ -17,6 +17,7 @@
 
 #include <common/include/DataLoadArguments.h>
 #include <common/include/DataLoaders.h>
+#include <common/include/DistributedTrainingArguments.h>
 #include <common/include/EvaluatorArguments.h>
 #include <common/include/LoadModel.h>
 #include <common/include/MakeEvaluator.h>
@@ -31,6 +32,7 @@
 
 #include <nodes/include/LinearPredictorNode.h>
 
+#include <trainers/include/DistributedTrainer.h>
 #include <trainers/include/MeanCalculator.h>
 
 #include <evaluators/include/Evaluator.h>
@@ -56,6 +58,28 @@ model::Map AppendTrainedLinearPredictorToMap(const predictors::LinearPredictor<E
     return outputMap;
 }
 
+// Averages the means of the shards of the data, weighted by their numbers of examples
+math::RowVector<double> AverageOverShards(trainers::IAllReduce& allReduce, const math::RowVector<double>& mean, size_t numExamples)
+{
+    std::vector<double> dimension = { static_cast<double>(mean.Size()) };
+    allReduce.AllReduce(dimension, trainers::AllReduceOperation::max);
+
+    std::vector<double> sums(static_cast<size_t>(dimension[0]) + 1, 0.0);
+    sums[0] = static_cast<double>(numExamples);
+    for (size_t i = 0; i < mean.Size(); ++i)
+    {
+        sums[i + 1] = mean[i] * numExamples;
+    }
+    allReduce.AllReduce(sums, trainers::AllReduceOperation::sum);
+
+    math::RowVector<double> result(sums.size() - 1);
+    for (size_t i = 0; i < result.Size(); ++i)
+    {
+        result[i] = sums[0] > 0 ? sums[i + 1] / sums[0] : 0.0;
+    }
+    return result;
+}
+
 int main(int argc, char* argv[])
 {
     try
@@ -70,6 +94,7 @@ int main(int argc, char* argv[])
         common::ParsedModelSaveArguments modelSaveArguments;
         common::ParsedTrainerArguments trainerArguments;
         common::ParsedEvaluatorArguments evaluatorArguments;
+        common::ParsedDistributedTrainingArguments distributedArguments;
 
         commandLineParser.AddOptionSet(linearTrainerArguments);
         commandLineParser.AddOptionSet(dataLoadArguments);
@@ -77,10 +102,17 @@ int main(int argc, char* argv[])
         commandLineParser.AddOptionSet(modelSaveArguments);
         commandLineParser.AddOptionSet(trainerArguments);
         commandLineParser.AddOptionSet(evaluatorArguments);
+        commandLineParser.AddOptionSet(distributedArguments);
 
         // parse command line
         commandLineParser.Parse();
 
+        // only the first process reports
+        if (!distributedArguments.IsRoot())
+        {
+            trainerArguments.verbose = false;
+        }
+
         if (trainerArguments.verbose)
         {
             std::cout << "Linear Trainer" << std::endl;
@@ -92,6 +124,14 @@ int main(int argc, char* argv[])
             throw utilities::CommandLineParserPrintHelpException(commandLineParser.GetHelpString());
         }
 
+        // connect to the other processes, which each train on their own shard of the data
+        std::unique_ptr<trainers::IAllReduce> allReduce;
+        if (distributedArguments.IsDistributed())
+        {
+            if (trainerArguments.verbose) std::cout << "Connecting to " << distributedArguments.numProcesses - 1 << " other processes ..." << std::endl;
+            allReduce = common::MakeAllReduce(distributedArguments);
+        }
+
         // load map
         mapLoadArguments.defaultInputSize = dataLoadArguments.parsedDataDimension;
         model::Map map;
@@ -110,8 +150,7 @@ int main(int argc, char* argv[])
 
         // load dataset
         if (trainerArguments.verbose) std::cout << "Loading data ..." << std::endl;
-        auto stream = utilities::OpenIfstream(dataLoadArguments.inputDataFilename);
-        auto parsedDataset = common::GetDataset(stream);
+        auto parsedDataset = common::LoadDataset(dataLoadArguments.inputDataFilename);
         auto mappedDataset = common::TransformDataset(parsedDataset, map);
         auto mappedDatasetDimension = map.GetOutput(0).Size();
 
@@ -122,6 +161,10 @@ int main(int argc, char* argv[])
 
             // find inverse absolute mean
             auto scaleVector = trainers::CalculateSparseTransformedMean(mappedDataset.GetAnyDataset(), [](data::IndexValue x) { return std::abs(x.value); });
+            if (allReduce)
+            {
+                scaleVector = AverageOverShards(*allReduce, scaleVector, mappedDataset.NumExamples());
+            }
             scaleVector.Transform([](double x) { return x > 0.0 ? 1.0 / x : 0.0; });
 
             // create normalizer
@@ -150,6 +193,10 @@ int main(int argc, char* argv[])
         case LinearTrainerArguments::Algorithm::SparseDataCenteredSGD:
         {
             auto mean = trainers::CalculateMean(mappedDataset.GetAnyDataset());
+            if (allReduce)
+            {
+                mean = AverageOverShards(*allReduce, mean, mappedDataset.NumExamples());
+            }
             trainer = common::MakeSparseDataCenteredSGDTrainer(trainerArguments.lossFunctionArguments, mean, { linearTrainerArguments.regularization, linearTrainerArguments.randomSeedString });
             break;
         }
@@ -162,6 +209,15 @@ int main(int argc, char* argv[])
             throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "unrecognized algorithm type");
         }
 
+        // average the trainers of the processes every few epochs
+        trainers::DistributedTrainer<PredictorType>* distributedTrainer = nullptr;
+        if (allReduce)
+        {
+            auto localTrainer = std::move(trainer);
+            trainer = std::make_unique<trainers::DistributedTrainer<PredictorType>>(std::move(localTrainer), *allReduce, trainers::DistributedTrainerParameters{ distributedArguments.synchronizationInterval });
+            distributedTrainer = static_cast<trainers::DistributedTrainer<PredictorType>*>(trainer.get());
+        }
+
         // create an evaluator
         auto evaluator = common::MakeEvaluator<PredictorType>(mappedDataset.GetAnyDataset(), evaluatorArguments, trainerArguments.lossFunctionArguments);
 
@@ -174,6 +230,10 @@ int main(int argc, char* argv[])
             trainer->Update();
             evaluator->Evaluate(trainer->GetPredictor());
         }
+        if (distributedTrainer != nullptr && !distributedTrainer->IsSynchronized())
+        {
+            distributedTrainer->Synchronize();
+        }
 
         // Print loss and errors
         if (trainerArguments.verbose)
@@ -181,13 +241,13 @@ int main(int argc, char* argv[])
             std::cout << "Finished training.\n";
 
             // print evaluation
-            std::cout << "Training error\n";
+            std::cout << (allReduce ? "Training error on the first shard\n" : "Training error\n");
             evaluator->Print(std::cout);
             std::cout << std::endl;
         }
 
         // Save predictor model
-        if (modelSaveArguments.outputModelFilename != "")
+        if (modelSaveArguments.outputModelFilename != "" && distributedArguments.IsRoot())
         {
             // Create a new map with the linear predictor appended.
             switch (map.GetOutputType())
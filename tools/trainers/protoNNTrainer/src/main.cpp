@@ -103,8 +103,7 @@ int main(int argc, char* argv[])
 
         mapLoadArguments.defaultInputSize = dataLoadArguments.parsedDataDimension;
         auto map = common::LoadMap(mapLoadArguments);
-        auto stream = utilities::OpenIfstream(dataLoadArguments.inputDataFilename);
-        auto parsedDataset = common::GetDataset(stream);
+        auto parsedDataset = common::LoadDataset(dataLoadArguments.inputDataFilename);
         auto mappedDataset = common::TransformDataset(parsedDataset, map);
 
         // The problem is NumFeatures returns a random number from sparse dataset depending on the number of trailing zeros it
@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FeatureCache.h (retargetTrainer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <data/include/Dataset.h>
+#include <data/include/Example.h>
+
+#include <model/include/Map.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ell
+{
+/// <summary>
+/// Caches the features a retargeted model computes for the examples of a dataset, and the dual variables of the
+/// linear classifiers trained on them, in a directory. The cache files are named after a hash of the model, whose
+/// output is the cut point, so a later run with the same model and cut point only transforms the examples that were
+/// added to the dataset, and warm-starts training from the previous solution.
+/// </summary>
+class FeatureCache
+{
+public:
+    /// <summary> Constructor. </summary>
+    ///
+    /// <param name="directory"> The directory to keep the cache files in, which is created if needed. </param>
+    /// <param name="map"> The model whose output is used as the features. </param>
+    FeatureCache(const std::string& directory, const model::Map& map);
+
+    /// <summary>
+    /// Transforms a dataset with the model, using the cached features of examples with the same data and computing
+    /// (and caching) the rest.
+    /// </summary>
+    ///
+    /// <param name="dataset"> The dataset to transform. </param>
+    /// <param name="map"> The model the cache was constructed with. </param>
+    /// <param name="useBlas"> Whether to emit code that calls BLAS when compiling the model. </param>
+    ///
+    /// <returns> The transformed dataset, with the metadata of the original one. </returns>
+    template <typename ExampleType>
+    data::Dataset<ExampleType> TransformDataset(data::Dataset<ExampleType>& dataset, const model::Map& map, bool useBlas);
+
+    /// <summary> Gets the number of examples whose features were found in the cache by the last `TransformDataset`. </summary>
+    size_t NumCachedExamples() const { return _numCachedExamples; }
+
+    /// <summary>
+    /// Gets the dual variables saved for a classifier, to warm-start its training. Examples that weren't in the training
+    /// set, or had a different label, get a dual variable of zero.
+    /// </summary>
+    ///
+    /// <param name="name"> The name of the classifier, which must identify its loss function. </param>
+    /// <param name="dataset"> The transformed training set. </param>
+    ///
+    /// <returns> One dual variable per example. </returns>
+    std::vector<double> LoadDualVariables(const std::string& name, const data::AutoSupervisedDataset& dataset) const;
+
+    /// <summary> Saves the dual variables of a trained classifier. </summary>
+    ///
+    /// <param name="name"> The name of the classifier, which must identify its loss function. </param>
+    /// <param name="dataset"> The transformed training set. </param>
+    /// <param name="dualVariables"> One dual variable per example. </param>
+    void SaveDualVariables(const std::string& name, const data::AutoSupervisedDataset& dataset, const std::vector<double>& dualVariables) const;
+
+private:
+    using FeaturesMap = std::unordered_map<size_t, std::shared_ptr<const data::AutoDataVector>>;
+
+    FeaturesMap LoadFeatures() const;
+    void SaveFeatures(const FeaturesMap& features) const;
+    std::string GetFilePath(const std::string& extension) const;
+
+    static size_t GetDataHash(const data::AutoDataVector& dataVector);
+
+    std::string _directory;
+    std::string _modelKey;
+    size_t _numCachedExamples = 0;
+};
+} // namespace ell
+
+#pragma region implementation
+
+#include <common/include/DataLoaders.h>
+
+namespace ell
+{
+template <typename ExampleType>
+data::Dataset<ExampleType> FeatureCache::TransformDataset(data::Dataset<ExampleType>& dataset, const model::Map& map, bool useBlas)
+{
+    auto features = LoadFeatures();
+
+    // Transform the examples that aren't in the cache, once for each distinct data vector
+    std::vector<size_t> dataHashes;
+    std::vector<size_t> uncachedHashes;
+    data::Dataset<ExampleType> uncachedDataset;
+    for (size_t index = 0; index < dataset.NumExamples(); ++index)
+    {
+        const auto& example = dataset.GetExample(index);
+        dataHashes.push_back(GetDataHash(example.GetDataVector()));
+        if (features.emplace(dataHashes.back(), nullptr).second)
+        {
+            uncachedHashes.push_back(dataHashes.back());
+            uncachedDataset.AddExample(example);
+        }
+    }
+
+    _numCachedExamples = dataset.NumExamples() - uncachedDataset.NumExamples();
+    if (uncachedDataset.NumExamples() > 0)
+    {
+        auto transformedDataset = common::TransformDatasetWithCompiledMap(uncachedDataset, map, useBlas);
+        for (size_t index = 0; index < uncachedHashes.size(); ++index)
+        {
+            features[uncachedHashes[index]] = transformedDataset.GetExample(index).GetSharedDataVector();
+        }
+        SaveFeatures(features);
+    }
+
+    data::Dataset<ExampleType> result;
+    for (size_t index = 0; index < dataset.NumExamples(); ++index)
+    {
+        result.AddExample(ExampleType(features[dataHashes[index]], dataset.GetExample(index).GetMetadata()));
+    }
+    return result;
+}
+} // namespace ell
+
+#pragma endregion implementation
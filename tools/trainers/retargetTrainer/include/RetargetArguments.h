@@ -34,6 +34,8 @@ struct RetargetArguments
     bool multiClass;
     common::LossFunctionArguments lossFunctionArguments;
     bool useBlas;
+    size_t numThreads;
+    std::string featureCacheDirectory;
 };
 
 /// <summary> Parsed version of RetargetArguments. </summary>
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     FeatureCache.cpp (retargetTrainer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "FeatureCache.h"
+
+#include <common/include/LoadModel.h>
+
+#include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
+#include <utilities/include/Hash.h>
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+
+namespace ell
+{
+namespace
+{
+    // Identifies an example for the dual variables of a classifier: its dual variable is only feasible for its label
+    size_t GetExampleKey(size_t dataHash, double label)
+    {
+        utilities::HashCombine(dataHash, label);
+        return dataHash;
+    }
+
+    template <typename ValueType>
+    void WriteValue(std::ostream& stream, ValueType value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename ValueType>
+    ValueType ReadValue(std::istream& stream)
+    {
+        ValueType value = 0;
+        stream.read(reinterpret_cast<char*>(&value), sizeof(value));
+        if (!stream)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::badData, "Unexpected end of feature cache file");
+        }
+        return value;
+    }
+} // namespace
+
+FeatureCache::FeatureCache(const std::string& directory, const model::Map& map) :
+    _directory(directory)
+{
+    utilities::EnsureDirectoryExists(_directory);
+
+    std::stringstream archive;
+    common::SaveMap(map, archive);
+    std::stringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>{}(archive.str());
+    _modelKey = key.str();
+}
+
+std::vector<double> FeatureCache::LoadDualVariables(const std::string& name, const data::AutoSupervisedDataset& dataset) const
+{
+    std::vector<double> dualVariables(dataset.NumExamples(), 0.0);
+    auto filepath = GetFilePath(name + ".duals");
+    if (!utilities::FileExists(filepath))
+    {
+        return dualVariables;
+    }
+
+    auto stream = utilities::OpenBinaryIfstream(filepath);
+    auto count = ReadValue<uint64_t>(stream);
+    std::unordered_map<size_t, double> savedDualVariables;
+    for (uint64_t index = 0; index < count; ++index)
+    {
+        auto key = static_cast<size_t>(ReadValue<uint64_t>(stream));
+        savedDualVariables[key] = ReadValue<double>(stream);
+    }
+
+    for (size_t index = 0; index < dataset.NumExamples(); ++index)
+    {
+        const auto& example = dataset.GetExample(index);
+        auto it = savedDualVariables.find(GetExampleKey(GetDataHash(example.GetDataVector()), example.GetMetadata().label));
+        if (it != savedDualVariables.end())
+        {
+            dualVariables[index] = it->second;
+        }
+    }
+    return dualVariables;
+}
+
+void FeatureCache::SaveDualVariables(const std::string& name, const data::AutoSupervisedDataset& dataset, const std::vector<double>& dualVariables) const
+{
+    if (dualVariables.size() != dataset.NumExamples())
+    {
+        throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "Need one dual variable per example");
+    }
+
+    auto stream = utilities::OpenBinaryOfstream(GetFilePath(name + ".duals"));
+    WriteValue<uint64_t>(stream, dataset.NumExamples());
+    for (size_t index = 0; index < dataset.NumExamples(); ++index)
+    {
+        const auto& example = dataset.GetExample(index);
+        WriteValue<uint64_t>(stream, GetExampleKey(GetDataHash(example.GetDataVector()), example.GetMetadata().label));
+        WriteValue<double>(stream, dualVariables[index]);
+    }
+}
+
+// The features are kept in the binary dataset format, with a separate file of the hashes of the data they were computed from
+FeatureCache::FeaturesMap FeatureCache::LoadFeatures() const
+{
+    FeaturesMap features;
+    auto featuresPath = GetFilePath("features");
+    auto hashesPath = GetFilePath("hashes");
+    if (!utilities::FileExists(featuresPath) || !utilities::FileExists(hashesPath))
+    {
+        return features;
+    }
+
+    auto dataset = common::LoadDataset(featuresPath);
+    auto stream = utilities::OpenBinaryIfstream(hashesPath);
+    auto count = ReadValue<uint64_t>(stream);
+    if (count != dataset.NumExamples())
+    {
+        throw utilities::InputException(utilities::InputExceptionErrors::badData, "Feature cache files " + featuresPath + " and " + hashesPath + " don't match");
+    }
+
+    for (size_t index = 0; index < dataset.NumExamples(); ++index)
+    {
+        auto dataHash = static_cast<size_t>(ReadValue<uint64_t>(stream));
+        features[dataHash] = dataset.GetExample(index).GetSharedDataVector();
+    }
+    return features;
+}
+
+void FeatureCache::SaveFeatures(const FeaturesMap& features) const
+{
+    data::AutoSupervisedDataset dataset;
+    auto stream = utilities::OpenBinaryOfstream(GetFilePath("hashes"));
+    WriteValue<uint64_t>(stream, features.size());
+    for (const auto& [dataHash, dataVector] : features)
+    {
+        WriteValue<uint64_t>(stream, dataHash);
+        dataset.AddExample(data::AutoSupervisedExample(dataVector, data::WeightLabel{ 1.0, 0.0 }));
+    }
+    common::SaveBinaryDataset(dataset, GetFilePath("features"));
+}
+
+std::string FeatureCache::GetFilePath(const std::string& extension) const
+{
+    return utilities::JoinPaths(_directory, _modelKey + "." + extension);
+}
+
+size_t FeatureCache::GetDataHash(const data::AutoDataVector& dataVector)
+{
+    auto values = dataVector.ToArray();
+    return utilities::HashValue(values);
+}
+} // namespace ell
@@ -53,7 +53,7 @@ void ParsedRetargetArguments::AddArgs(utilities::CommandLineParser& parser)
     parser.AddOption(inputDataFilename,
                      "inputDataFilename",
                      "idf",
-                     "Path to the input dataset file",
+                     "Path to the input dataset file, in the text or binary dataset format",
                      "");
 
     parser.AddOption(multiClass,
@@ -116,5 +116,17 @@ void ParsedRetargetArguments::AddArgs(utilities::CommandLineParser& parser)
                      "",
                      "Emit code that calls BLAS, used when compiling the input model to create mapped datasets",
                      true);
+
+    parser.AddOption(numThreads,
+                     "numThreads",
+                     "nt",
+                     "The number of one-versus-rest classifiers to train at the same time (0 to use one thread per core)",
+                     0);
+
+    parser.AddOption(featureCacheDirectory,
+                     "featureCache",
+                     "fc",
+                     "Directory to cache the model's features for the dataset in, along with the solution of the training, so that a later run with more examples only computes the new examples' features and continues from the previous solution",
+                     "");
 }
 } // namespace ell
@@ -6,11 +6,13 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "FeatureCache.h"
 #include "RetargetArguments.h"
 
 #include <utilities/include/CommandLineParser.h>
 #include <utilities/include/Exception.h>
 #include <utilities/include/MillisecondTimer.h>
+#include <utilities/include/ParallelFor.h>
 
 #include <common/include/DataLoaders.h>
 #include <common/include/LoadModel.h>
@@ -44,6 +46,10 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace ell;
 
@@ -161,56 +167,72 @@ void PrintEvaluation(double dualityGap, double desiredPrecision, evaluators::IEv
     }
 }
 
+// If there's a feature cache, training starts from the dual variables saved by the last run with the same classifier name
 template <typename LossFunctionType>
-PredictorType RetargetModelUsingLinearPredictor(ParsedRetargetArguments& retargetArguments, data::AutoSupervisedDataset& dataset)
+PredictorType RetargetModelUsingLinearPredictor(ParsedRetargetArguments& retargetArguments, data::AutoSupervisedDataset& dataset, const FeatureCache* featureCache, const std::string& classifierName, std::ostream& os)
 {
     trainers::SDCATrainerParameters trainerParameters{ retargetArguments.regularization, retargetArguments.desiredPrecision, retargetArguments.maxEpochs, retargetArguments.permute, retargetArguments.randomSeedString };
 
     auto trainer = trainers::SDCATrainer<LossFunctionType, functions::L2Regularizer>(LossFunctionType(), functions::L2Regularizer(), trainerParameters);
-    if (retargetArguments.verbose) std::cout << "Created linear trainer ..." << std::endl;
+    if (retargetArguments.verbose) os << "Created linear trainer ..." << std::endl;
 
     // create an evaluator
     evaluators::EvaluatorParameters evaluatorParameters{ 1, true };
     auto evaluator = common::MakeEvaluator<PredictorType>(dataset.GetAnyDataset(), evaluatorParameters, retargetArguments.lossFunctionArguments);
 
     // Train the predictor
-    std::cout << "Training ..." << std::endl;
+    os << "Training ..." << std::endl;
     trainer.SetDataset(dataset.GetAnyDataset());
+    if (featureCache != nullptr)
+    {
+        auto dualVariables = featureCache->LoadDualVariables(classifierName, dataset);
+        auto numWarmStarted = std::count_if(dualVariables.begin(), dualVariables.end(), [](double dualVariable) { return dualVariable != 0; });
+        if (numWarmStarted > 0)
+        {
+            trainer.SetDualVariables(dualVariables);
+            if (retargetArguments.verbose) os << "Warm-started from the dual variables of " << numWarmStarted << " examples ..." << std::endl;
+        }
+    }
+
     size_t epoch = 0;
     double dualityGap = std::numeric_limits<double>::max();
 
-    if (retargetArguments.verbose) PrintSDCAPredictorInfoHeader(std::cout);
+    if (retargetArguments.verbose) PrintSDCAPredictorInfoHeader(os);
     while ((++epoch <= retargetArguments.maxEpochs) && (dualityGap > retargetArguments.desiredPrecision))
     {
         trainer.Update();
         auto info = trainer.GetPredictorInfo();
         dualityGap = std::abs(info.primalObjective - info.dualObjective);
-        if (retargetArguments.verbose) PrintSDCAPredictorInfoValues(trainer.GetPredictorInfo(), std::cout);
+        if (retargetArguments.verbose) PrintSDCAPredictorInfoValues(trainer.GetPredictorInfo(), os);
     }
 
     // Print evaluation of training
     evaluator->Evaluate(trainer.GetPredictor());
-    PrintEvaluation(dualityGap, retargetArguments.desiredPrecision, evaluator.get(), std::cout);
+    PrintEvaluation(dualityGap, retargetArguments.desiredPrecision, evaluator.get(), os);
 
+    if (featureCache != nullptr)
+    {
+        featureCache->SaveDualVariables(classifierName, dataset, trainer.GetDualVariables());
+    }
     return PredictorType(trainer.GetPredictor());
 }
 
-PredictorType RetargetModelUsingLinearPredictor(ParsedRetargetArguments& retargetArguments, data::AutoSupervisedDataset& dataset)
+PredictorType RetargetModelUsingLinearPredictor(ParsedRetargetArguments& retargetArguments, data::AutoSupervisedDataset& dataset, const FeatureCache* featureCache, const std::string& classifierName, std::ostream& os)
 {
     using LossFunctionEnum = common::LossFunctionArguments::LossFunction;
     PredictorType trainedPredictor;
     switch (retargetArguments.lossFunctionArguments.lossFunction)
     {
     case LossFunctionEnum::squared:
-        trainedPredictor = RetargetModelUsingLinearPredictor<functions::SquaredLoss>(retargetArguments, dataset);
+        trainedPredictor = RetargetModelUsingLinearPredictor<functions::SquaredLoss>(retargetArguments, dataset, featureCache, "squared." + classifierName, os);
         break;
 
     case LossFunctionEnum::log:
-        trainedPredictor = RetargetModelUsingLinearPredictor<functions::LogLoss>(retargetArguments, dataset);
+        trainedPredictor = RetargetModelUsingLinearPredictor<functions::LogLoss>(retargetArguments, dataset, featureCache, "log." + classifierName, os);
         break;
 
     case LossFunctionEnum::smoothHinge:
-        trainedPredictor = RetargetModelUsingLinearPredictor<functions::SmoothHingeLoss>(retargetArguments, dataset);
+        trainedPredictor = RetargetModelUsingLinearPredictor<functions::SmoothHingeLoss>(retargetArguments, dataset, featureCache, "smoothHinge." + classifierName, os);
         break;
 
     default:
@@ -219,49 +241,45 @@ PredictorType RetargetModelUsingLinearPredictor(ParsedRetargetArguments& retarge
     return trainedPredictor;
 }
 
-std::vector<data::AutoSupervisedDataset> CreateDatasetsForOneVersusRest(data::AutoSupervisedMultiClassDataset& multiclassDataset)
+std::vector<size_t> GetClassCounts(const data::AutoSupervisedMultiClassDataset& multiclassDataset)
 {
-    std::vector<data::AutoSupervisedDataset> datasets;
-
-    // Get statistics for the multi-class dataset
-    std::map<size_t, size_t> classCounts;
+    std::vector<size_t> classCounts;
     for (size_t i = 0; i < multiclassDataset.NumExamples(); ++i)
     {
         const auto& example = multiclassDataset.GetExample(i);
         size_t classIndex = example.GetMetadata().classIndex;
-
+        if (classIndex >= classCounts.size())
+        {
+            classCounts.resize(classIndex + 1);
+        }
         classCounts[classIndex] += 1;
     }
+    return classCounts;
+}
 
-    // Create binary classification datasets for each class
-    size_t numClasses = classCounts.size();
+data::AutoSupervisedDataset CreateDatasetForOneVersusRest(data::AutoSupervisedMultiClassDataset& multiclassDataset, size_t classIndex, const std::vector<size_t>& classCounts)
+{
+    // For any class x, create a binary classification dataset where Example is:
+    //  weight = 1 / number of examples for x, or 1 / number of examples for all classes not x
+    //  label = 1.0 for examples in x, or -1.0 for all examples not in x
+    //  data = shared_ptr to existing data
     size_t totalCount = multiclassDataset.NumExamples();
-    datasets.resize(numClasses);
-    for (size_t i = 0; i < numClasses; ++i)
-    {
-        // For any class x, create a binary classification dataset where Example is:
-        //  weight = 1 / number of examples for x, or 1 / number of examples for all classes not x
-        //  label = 1.0 for examples in x, or -1.0 for all examples not in x
-        //  data = shared_ptr to existing data
-        size_t positiveCount = classCounts[i];
-        size_t negativeCount = (totalCount - classCounts[i]);
-        double weightPositiveCase = 1.0 / (positiveCount ? positiveCount : 1.0);
-        double weightNegativeCase = 1.0 / (negativeCount ? negativeCount : 1.0);
-        datasets[i] = multiclassDataset.Transform<data::AutoSupervisedExample>([i, weightPositiveCase, weightNegativeCase](const auto& example) {
-            if (example.GetMetadata().classIndex == i)
-            {
-                // Positive case
-                return data::AutoSupervisedExample(example.GetSharedDataVector(), data::WeightLabel{ weightPositiveCase, 1.0 });
-            }
-            else
-            {
-                // Negative case
-                return data::AutoSupervisedExample(example.GetSharedDataVector(), data::WeightLabel{ weightNegativeCase, -1.0 });
-            }
-        });
-    }
-
-    return datasets;
+    size_t positiveCount = classCounts[classIndex];
+    size_t negativeCount = (totalCount - classCounts[classIndex]);
+    double weightPositiveCase = 1.0 / (positiveCount ? positiveCount : 1.0);
+    double weightNegativeCase = 1.0 / (negativeCount ? negativeCount : 1.0);
+    return multiclassDataset.Transform<data::AutoSupervisedExample>([classIndex, weightPositiveCase, weightNegativeCase](const auto& example) {
+        if (example.GetMetadata().classIndex == classIndex)
+        {
+            // Positive case
+            return data::AutoSupervisedExample(example.GetSharedDataVector(), data::WeightLabel{ weightPositiveCase, 1.0 });
+        }
+        else
+        {
+            // Negative case
+            return data::AutoSupervisedExample(example.GetSharedDataVector(), data::WeightLabel{ weightNegativeCase, -1.0 });
+        }
+    });
 }
 
 template <typename ElementType>
@@ -421,6 +439,13 @@ int main(int argc, char* argv[])
         auto node = map.GetOutput(0).GetNode();
         std::cout << "Using output from node of type " << node->GetRuntimeTypeName() << std::endl;
 
+        // The features computed by this model, and the classifiers trained on them, are cached for later runs
+        std::unique_ptr<FeatureCache> featureCache;
+        if (!retargetArguments.featureCacheDirectory.empty())
+        {
+            featureCache = std::make_unique<FeatureCache>(retargetArguments.featureCacheDirectory, map);
+        }
+
         // load dataset and map the output
         if (retargetArguments.verbose) std::cout << "Loading data ...";
         model::Map result;
@@ -428,8 +453,7 @@ int main(int argc, char* argv[])
         {
             // This is a multi-class dataset
             _timer.Start();
-            auto stream = utilities::OpenIfstream(retargetArguments.inputDataFilename);
-            auto multiclassDataset = common::GetMultiClassDataset(stream);
+            auto multiclassDataset = common::LoadMultiClassDataset(retargetArguments.inputDataFilename);
             if (retargetArguments.verbose) std::cout << "(" << _timer.Elapsed() << " ms)" << std::endl;
 
             // Obtain a new training dataset for the set of Linear Predictors by running the
@@ -438,26 +462,30 @@ int main(int argc, char* argv[])
                                                      << "Transforming dataset with compiled model...";
             _timer.Start();
 
-            auto dataset = common::TransformDatasetWithCompiledMap(multiclassDataset, map, retargetArguments.useBlas);
-            if (retargetArguments.verbose) std::cout << "(" << _timer.Elapsed() << " ms)" << std::endl;
-
-            // Create binary classification datasets for each one versus rest (OVR) case
-            if (retargetArguments.verbose) std::cout << std::endl
-                                                     << "Creating datasets for One vs Rest...";
-            _timer.Start();
-            auto datasets = CreateDatasetsForOneVersusRest(dataset);
+            auto dataset = featureCache ? featureCache->TransformDataset(multiclassDataset, map, retargetArguments.useBlas) : common::TransformDatasetWithCompiledMap(multiclassDataset, map, retargetArguments.useBlas);
             if (retargetArguments.verbose) std::cout << "(" << _timer.Elapsed() << " ms)" << std::endl;
+            if (featureCache) std::cout << "Reused the cached features of " << featureCache->NumCachedExamples() << " of " << dataset.NumExamples() << " examples" << std::endl;
 
-            // Next, train a binary classifier for each case and combine into a
-            // single model.
+            // Next, train a binary classifier for each one versus rest (OVR) case, several at a time, and combine
+            // them into a single model. Each class's dataset shares the data vectors of the multi-class dataset.
             _timer.Start();
-            std::vector<PredictorType> predictors(datasets.size());
-            for (size_t i = 0; i < datasets.size(); ++i)
+            auto classCounts = GetClassCounts(dataset);
+            auto numClasses = classCounts.size();
+            std::vector<PredictorType> predictors(numClasses);
+            std::vector<std::string> trainingOutputs(numClasses);
+            // Each thread takes the next class when it finishes one, because some classes take many more epochs to converge than others
+            utilities::ParallelForDynamic(numClasses, retargetArguments.numThreads, [&](size_t i) {
+                std::stringstream os;
+                os << std::endl
+                   << "=== Training binary classifier for class " << i << " vs Rest ===" << std::endl;
+
+                auto classDataset = CreateDatasetForOneVersusRest(dataset, i, classCounts);
+                predictors[i] = RetargetModelUsingLinearPredictor(retargetArguments, classDataset, featureCache.get(), "class" + std::to_string(i), os);
+                trainingOutputs[i] = os.str();
+            });
+            for (const auto& trainingOutput : trainingOutputs)
             {
-                std::cout << std::endl
-                          << "=== Training binary classifier for class " << i << " vs Rest ===" << std::endl;
-
-                predictors[i] = RetargetModelUsingLinearPredictor(retargetArguments, datasets[i]);
+                std::cout << trainingOutput;
             }
             if (retargetArguments.verbose) std::cout << "Training completed ...(" << _timer.Elapsed() << " ms)" << std::endl;
 
@@ -468,8 +496,7 @@ int main(int argc, char* argv[])
         {
             // This is a binary classification dataset
             _timer.Start();
-            auto stream = utilities::OpenIfstream(retargetArguments.inputDataFilename);
-            auto binaryDataset = common::GetDataset(stream);
+            auto binaryDataset = common::LoadDataset(retargetArguments.inputDataFilename);
             if (retargetArguments.verbose) std::cout << "Loading dataset took :" << _timer.Elapsed() << " ms" << std::endl;
             // Obtain a new training dataset for the Linear Predictor by running the
             // binaryDataset through the modified model
@@ -477,12 +504,13 @@ int main(int argc, char* argv[])
                                                      << "Transforming dataset with compiled model...";
             _timer.Start();
 
-            auto dataset = common::TransformDatasetWithCompiledMap(binaryDataset, map);
+            auto dataset = featureCache ? featureCache->TransformDataset(binaryDataset, map, retargetArguments.useBlas) : common::TransformDatasetWithCompiledMap(binaryDataset, map);
             if (retargetArguments.verbose) std::cout << "(" << _timer.Elapsed() << " ms)" << std::endl;
+            if (featureCache) std::cout << "Reused the cached features of " << featureCache->NumCachedExamples() << " of " << dataset.NumExamples() << " examples" << std::endl;
 
             // Train a linear predictor whose input comes from the previous model
             _timer.Start();
-            auto predictor = RetargetModelUsingLinearPredictor(retargetArguments, dataset);
+            auto predictor = RetargetModelUsingLinearPredictor(retargetArguments, dataset, featureCache.get(), "binary", std::cout);
             if (retargetArguments.verbose) std::cout << "Training completed... (" << _timer.Elapsed() << " ms)" << std::endl;
 
             // Save the newly spliced model
@@ -0,0 +1,30 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SweepingSGDTrainerArguments.h (sweepingSGDTrainer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <utilities/include/CommandLineParser.h>
+
+namespace ell
+{
+struct SweepingSGDTrainerArguments
+{
+    size_t numThreads;
+    double earlyTerminationMargin;
+};
+
+/// <summary> Parsed version of SweepingSGDTrainerArguments. </summary>
+struct ParsedSweepingSGDTrainerArguments : public SweepingSGDTrainerArguments
+    , public utilities::ParsedArgSet
+{
+    /// <summary> Adds the arguments to the command line parser. </summary>
+    ///
+    /// <param name="parser"> [in,out] The command line parser. </param>
+    void AddArgs(utilities::CommandLineParser& parser) override;
+};
+} // namespace ell
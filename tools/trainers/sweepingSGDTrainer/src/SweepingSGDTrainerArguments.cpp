@@ -0,0 +1,27 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SweepingSGDTrainerArguments.cpp (sweepingSGDTrainer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SweepingSGDTrainerArguments.h"
+
+namespace ell
+{
+void ParsedSweepingSGDTrainerArguments::AddArgs(utilities::CommandLineParser& parser)
+{
+    parser.AddOption(numThreads,
+                     "numThreads",
+                     "nt",
+                     "The number of trainers in the sweep to run at the same time (0 to use one per core)",
+                     0);
+
+    parser.AddOption(earlyTerminationMargin,
+                     "earlyTerminationMargin",
+                     "etm",
+                     "Stop training the trainers whose evaluation is worse than the best one by more than this fraction of it (0 to train all of them for every epoch)",
+                     0.0);
+}
+} // namespace ell
@@ -6,6 +6,8 @@
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#include "SweepingSGDTrainerArguments.h"
+
 #include <utilities/include/CommandLineParser.h>
 #include <utilities/include/Exception.h>
 #include <utilities/include/Files.h>
@@ -17,6 +19,7 @@
 #include <common/include/AppendNodeToModel.h>
 #include <common/include/DataLoadArguments.h>
 #include <common/include/DataLoaders.h>
+#include <common/include/DistributedTrainingArguments.h>
 #include <common/include/LoadModel.h>
 #include <common/include/MakeEvaluator.h>
 #include <common/include/MakeTrainer.h>
@@ -25,6 +28,7 @@
 #include <common/include/ParametersEnumerator.h>
 #include <common/include/TrainerArguments.h>
 
+#include <trainers/include/DistributedTrainer.h>
 #include <trainers/include/EvaluatingTrainer.h>
 #include <trainers/include/SGDTrainer.h>
 #include <trainers/include/SweepingTrainer.h>
@@ -50,14 +54,18 @@ int main(int argc, char* argv[])
 
         // add arguments to the command line parser
         common::ParsedTrainerArguments trainerArguments;
+        ParsedSweepingSGDTrainerArguments sweepingArguments;
         common::ParsedDataLoadArguments dataLoadArguments;
         common::ParsedMapLoadArguments mapLoadArguments;
         common::ParsedModelSaveArguments modelSaveArguments;
+        common::ParsedDistributedTrainingArguments distributedArguments;
 
         commandLineParser.AddOptionSet(trainerArguments);
+        commandLineParser.AddOptionSet(sweepingArguments);
         commandLineParser.AddOptionSet(dataLoadArguments);
         commandLineParser.AddOptionSet(mapLoadArguments);
         commandLineParser.AddOptionSet(modelSaveArguments);
+        commandLineParser.AddOptionSet(distributedArguments);
 
         // parse command line
         commandLineParser.Parse();
@@ -69,20 +77,40 @@ int main(int argc, char* argv[])
         std::vector<double> regularization{ 1.0e-0, 1.0e-1, 1.0e-2, 1.0e-3, 1.0e-4, 1.0e-5, 1.0e-6 };
         std::vector<std::string> randomSeeds(regularization.size(), defaultRandomSeed);
 
+        // only the first process reports
+        if (!distributedArguments.IsRoot())
+        {
+            trainerArguments.verbose = false;
+        }
+
         if (trainerArguments.verbose)
         {
             std::cout << "Sweeping Stochastic Gradient Descent Trainer" << std::endl;
             std::cout << commandLineParser.GetCurrentValuesString() << std::endl;
         }
 
+        // connect to the other processes, which each train on their own shard of the data
+        std::unique_ptr<trainers::IAllReduce> allReduce;
+        if (distributedArguments.IsDistributed())
+        {
+            // every process has to average the same trainers in the same order
+            if (sweepingArguments.earlyTerminationMargin > 0)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Early termination isn't supported when training on several processes");
+            }
+            sweepingArguments.numThreads = 1;
+
+            if (trainerArguments.verbose) std::cout << "Connecting to " << distributedArguments.numProcesses - 1 << " other processes ..." << std::endl;
+            allReduce = common::MakeAllReduce(distributedArguments);
+        }
+
         // load map
         mapLoadArguments.defaultInputSize = dataLoadArguments.parsedDataDimension;
         auto map = common::LoadMap(mapLoadArguments);
 
         // load dataset
         if (trainerArguments.verbose) std::cout << "Loading data ..." << std::endl;
-        auto stream = utilities::OpenIfstream(dataLoadArguments.inputDataFilename);
-        auto parsedDataset = common::GetDataset(stream);
+        auto parsedDataset = common::LoadDataset(dataLoadArguments.inputDataFilename);
         auto mappedDataset = common::TransformDataset(parsedDataset, map);
         auto mappedDatasetDimension = map.GetOutput(0).Size();
 
@@ -90,27 +118,45 @@ int main(int argc, char* argv[])
         using PredictorType = predictors::LinearPredictor<double>;
         using LinearPredictorNodeType = nodes::LinearPredictorNode<double>;
 
-        // set up evaluators to only evaluate on the last update of the multi-epoch trainer
+        // set up evaluators to evaluate after every epoch, which is when the sweep decides whether to stop a trainer
         evaluators::EvaluatorParameters evaluatorParameters{ 1, false };
 
         // create trainers
         auto generator = common::MakeParametersEnumerator<trainers::SGDTrainerParameters>(regularization, randomSeeds);
         std::vector<trainers::EvaluatingTrainer<PredictorType>> evaluatingTrainers;
         std::vector<std::shared_ptr<evaluators::IEvaluator<PredictorType>>> evaluators;
+        std::vector<trainers::DistributedTrainer<PredictorType>*> distributedTrainers;
         for (size_t i = 0; i < regularization.size(); ++i)
         {
             auto SGDTrainer = common::MakeSGDTrainer(trainerArguments.lossFunctionArguments, generator.GenerateParameters(i));
+            if (allReduce)
+            {
+                auto distributedTrainer = std::make_unique<trainers::DistributedTrainer<PredictorType>>(std::move(SGDTrainer), *allReduce, trainers::DistributedTrainerParameters{ distributedArguments.synchronizationInterval });
+                distributedTrainers.push_back(distributedTrainer.get());
+                SGDTrainer = std::move(distributedTrainer);
+            }
             evaluators.push_back(common::MakeEvaluator<PredictorType>(mappedDataset.GetAnyDataset(), evaluatorParameters, trainerArguments.lossFunctionArguments));
             evaluatingTrainers.push_back(trainers::MakeEvaluatingTrainer(std::move(SGDTrainer), evaluators.back()));
         }
 
         // create meta trainer
-        auto trainer = trainers::MakeSweepingTrainer(std::move(evaluatingTrainers));
+        trainers::SweepingTrainerParameters sweepingParameters{ sweepingArguments.numThreads, sweepingArguments.earlyTerminationMargin };
+        auto trainer = trainers::MakeSweepingTrainer(std::move(evaluatingTrainers), sweepingParameters);
 
         // train
         if (trainerArguments.verbose) std::cout << "Training ..." << std::endl;
         trainer->SetDataset(mappedDataset.GetAnyDataset());
-        trainer->Update();
+        for (size_t epoch = 0; epoch < trainerArguments.numEpochs; ++epoch)
+        {
+            trainer->Update();
+        }
+        for (auto distributedTrainer : distributedTrainers)
+        {
+            if (!distributedTrainer->IsSynchronized())
+            {
+                distributedTrainer->Synchronize();
+            }
+        }
         PredictorType predictor(trainer->GetPredictor());
         predictor.Resize(mappedDatasetDimension);
 
@@ -129,7 +175,7 @@ int main(int argc, char* argv[])
         }
 
         // save predictor model
-        if (modelSaveArguments.outputModelFilename != "")
+        if (modelSaveArguments.outputModelFilename != "" && distributedArguments.IsRoot())
         {
             // Create a model
             auto model = common::AppendNodeToModel<LinearPredictorNodeType, PredictorType>(map, predictor);
@@ -22,6 +22,18 @@ struct ApplyArguments
 
     /// <summary> Instead of raw output, report a summary. </summary>
     bool summarize = false;
+
+    /// <summary> Write the mapped dataset in the binary dataset format instead of as text. </summary>
+    bool binaryOutput = false;
+
+    /// <summary> Run a compiled version of the map instead of the reference implementation. </summary>
+    bool compile = false;
+
+    /// <summary> The number of threads that run the compiled map, zero to use one per core. </summary>
+    int numThreads = 0;
+
+    /// <summary> The number of examples passed to each call of the compiled map. </summary>
+    int batchSize = 16;
 };
 
 /// <summary> Parsed command line arguments for the apply executable. </summary>
@@ -25,11 +25,51 @@ void ParsedApplyArguments::AddArgs(utilities::CommandLineParser& parser)
         "s",
         "Aggregate and summarize map output.",
         false);
+
+    parser.AddOption(
+        binaryOutput,
+        "binary",
+        "",
+        "Write the mapped dataset to the output data file in the binary dataset format, which loads much faster than text.",
+        false);
+
+    parser.AddOption(
+        compile,
+        "compile",
+        "",
+        "JIT-compile the map once and run it on several threads, each with its own copy of the model state. Each thread starts from the initial state, so models with state (e.g., recurrent models) give different results than the reference map.",
+        false);
+
+    parser.AddOption(
+        numThreads,
+        "numThreads",
+        "nt",
+        "Number of threads that run the compiled map (0 = one per core)",
+        0);
+
+    parser.AddOption(
+        batchSize,
+        "batchSize",
+        "bs",
+        "Number of examples passed to each call of the compiled map",
+        16);
 }
 
 utilities::CommandLineParseResult ParsedApplyArguments::PostProcess(const utilities::CommandLineParser& parser)
 {
     std::vector<std::string> errors;
+    if (compile && summarize)
+    {
+        errors.push_back("Summarization mode doesn't run compiled maps");
+    }
+    if (numThreads < 0)
+    {
+        errors.push_back("numThreads can't be negative");
+    }
+    if (batchSize < 1)
+    {
+        errors.push_back("batchSize must be at least 1");
+    }
     return errors;
 }
 } // namespace ell
@@ -9,9 +9,12 @@
 #include "ApplyArguments.h"
 
 #include <utilities/include/CommandLineParser.h>
+#include <utilities/include/DecompressingStream.h>
 #include <utilities/include/Exception.h>
 #include <utilities/include/Files.h>
+#include <utilities/include/OutputBuffer.h>
 #include <utilities/include/OutputStreamImpostor.h>
+#include <utilities/include/ParallelFor.h>
 
 #include <data/include/DataVector.h>
 #include <data/include/DataVectorOperations.h>
@@ -27,15 +30,164 @@
 #include <common/include/LoadModel.h>
 #include <common/include/MapLoadArguments.h>
 
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
 #include <model/include/Map.h>
 #include <model/include/OutputNode.h>
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 using namespace ell;
 
+namespace
+{
+// The outputs computed by one thread, for a contiguous range of examples
+template <typename OutputType>
+struct ThreadOutput
+{
+    std::vector<OutputType> values; // kept for binary output
+    utilities::OutputBuffer text; // the formatted examples, for text output
+};
+
+template <typename InputType, typename OutputType>
+ThreadOutput<OutputType> ApplyCompiledMapToRange(model::IRCompiledMap& compiledMap, const data::AutoSupervisedDataset& dataset, size_t fromIndex, size_t toIndex, const ApplyArguments& applyArguments)
+{
+    const auto inputSize = compiledMap.GetInputSize();
+    const auto outputSize = compiledMap.GetOutputSize();
+    const auto batchSize = static_cast<size_t>(applyArguments.batchSize);
+    std::vector<InputType> input(batchSize * inputSize);
+    std::vector<OutputType> output(batchSize * outputSize);
+
+    ThreadOutput<OutputType> result;
+    for (auto batchBegin = fromIndex; batchBegin < toIndex; batchBegin += batchSize)
+    {
+        auto batchEnd = std::min(batchBegin + batchSize, toIndex);
+        for (auto index = batchBegin; index < batchEnd; ++index)
+        {
+            auto values = dataset.GetExample(index).GetDataVector().ToArray(inputSize);
+            std::copy(values.begin(), values.end(), input.begin() + (index - batchBegin) * inputSize);
+        }
+        compiledMap.PredictBatch(input.data(), output.data(), static_cast<int>(batchEnd - batchBegin));
+
+        auto outputEnd = output.begin() + (batchEnd - batchBegin) * outputSize;
+        if (applyArguments.binaryOutput)
+        {
+            result.values.insert(result.values.end(), output.begin(), outputEnd);
+        }
+        else
+        {
+            for (auto index = batchBegin; index < batchEnd; ++index)
+            {
+                auto exampleOutput = output.begin() + (index - batchBegin) * outputSize;
+                data::FloatDataVector mappedDataVector(std::vector<float>(exampleOutput, exampleOutput + outputSize));
+                auto mappedExample = data::DenseSupervisedExample(std::move(mappedDataVector), dataset.GetExample(index).GetMetadata());
+                mappedExample.Print(result.text);
+                result.text << '\n';
+            }
+        }
+    }
+    return result;
+}
+
+template <typename InputType, typename OutputType>
+void ApplyCompiledMap(const model::Map& map, const data::AutoSupervisedDataset& dataset, const ApplyArguments& applyArguments, common::DataSaveArguments& dataSaveArguments)
+{
+    // A reentrant map keeps its state out of globals, so the threads can share one compiled copy of the code
+    model::MapCompilerOptions settings;
+    settings.reentrant = true;
+    settings.emitBatchPredictFunction = true;
+    model::ModelOptimizerOptions optimizerOptions;
+    model::IRMapCompiler compiler(settings, optimizerOptions);
+    auto compiledMap = compiler.Compile(map);
+
+    const auto numExamples = dataset.NumExamples();
+    auto numThreads = std::max(std::min(utilities::GetNumThreads(static_cast<size_t>(std::max(applyArguments.numThreads, 0))), numExamples), size_t{ 1 });
+
+    // clone the map for the other threads before any of them start running it
+    std::vector<model::IRCompiledMap> threadMaps;
+    threadMaps.reserve(numThreads - 1);
+    for (size_t threadIndex = 0; threadIndex + 1 < numThreads; ++threadIndex)
+    {
+        threadMaps.push_back(compiledMap.Clone());
+    }
+
+    // each thread runs a contiguous range of examples, the first one on this thread with the original map
+    std::vector<ThreadOutput<OutputType>> outputs(numThreads);
+    utilities::ParallelForBlocks(numThreads, [&](size_t threadIndex) {
+        auto fromIndex = numExamples * threadIndex / numThreads;
+        auto toIndex = numExamples * (threadIndex + 1) / numThreads;
+        auto& threadMap = threadIndex == 0 ? compiledMap : threadMaps[threadIndex - 1];
+        outputs[threadIndex] = ApplyCompiledMapToRange<InputType, OutputType>(threadMap, dataset, fromIndex, toIndex, applyArguments);
+    });
+
+    // write the outputs in the order of the examples
+    if (applyArguments.binaryOutput)
+    {
+        const auto outputSize = map.GetOutputSize();
+        data::AutoSupervisedDataset mappedDataset;
+        size_t index = 0;
+        for (const auto& output : outputs)
+        {
+            for (auto value = output.values.begin(); value != output.values.end(); value += outputSize, ++index)
+            {
+                auto mappedDataVector = std::make_unique<data::FloatDataVector>(std::vector<float>(value, value + outputSize));
+                mappedDataset.AddExample(data::AutoSupervisedExample(data::AutoDataVector(std::move(mappedDataVector)), dataset.GetExample(index).GetMetadata()));
+            }
+        }
+        common::SaveBinaryDataset(mappedDataset, dataSaveArguments.outputDataFilename, static_cast<size_t>(applyArguments.numThreads));
+    }
+    else
+    {
+        auto& outputStream = dataSaveArguments.outputDataStream;
+        for (auto& output : outputs)
+        {
+            output.text.WriteTo(outputStream);
+        }
+    }
+}
+
+template <typename InputType>
+void ApplyCompiledMap(const model::Map& map, const data::AutoSupervisedDataset& dataset, const ApplyArguments& applyArguments, common::DataSaveArguments& dataSaveArguments)
+{
+    switch (map.GetOutputType())
+    {
+    case model::Port::PortType::smallReal:
+        ApplyCompiledMap<InputType, float>(map, dataset, applyArguments, dataSaveArguments);
+        break;
+    case model::Port::PortType::real:
+        ApplyCompiledMap<InputType, double>(map, dataset, applyArguments, dataSaveArguments);
+        break;
+    default:
+        throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch, "Compiled maps must have float or double output");
+    }
+}
+
+void ApplyCompiledMap(const model::Map& map, const data::AutoSupervisedDataset& dataset, const ApplyArguments& applyArguments, common::DataSaveArguments& dataSaveArguments)
+{
+    if (!map.GetSourceNodes().empty())
+    {
+        throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Compiled maps with source nodes aren't supported");
+    }
+
+    switch (map.GetInputType())
+    {
+    case model::Port::PortType::smallReal:
+        ApplyCompiledMap<float>(map, dataset, applyArguments, dataSaveArguments);
+        break;
+    case model::Port::PortType::real:
+        ApplyCompiledMap<double>(map, dataset, applyArguments, dataSaveArguments);
+        break;
+    default:
+        throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch, "Compiled maps must have float or double input");
+    }
+}
+} // namespace
+
 int main(int argc, char* argv[])
 {
     try
@@ -60,9 +212,23 @@ int main(int argc, char* argv[])
         // load map
         auto map = common::LoadMap(mapLoadArguments);
 
-        // get data iterator
-        auto stream = utilities::OpenIfstream(dataLoadArguments.inputDataFilename);
-        auto exampleIterator = common::GetAutoSupervisedExampleIterator(stream);
+        if (applyArguments.binaryOutput && (dataSaveArguments.outputDataFilename.empty() || dataSaveArguments.outputDataFilename == "null"))
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Binary output requires an output data file");
+        }
+
+        // compiled mode: load the whole dataset, and run the compiled map on it on several threads
+        if (applyArguments.compile)
+        {
+            auto dataset = common::GetDatasetInParallel(dataLoadArguments.inputDataFilename, applyArguments.numThreads);
+            ApplyCompiledMap(map, dataset, applyArguments, dataSaveArguments);
+            mapLoadArguments.WriteTimingReport();
+            return 0;
+        }
+
+        // get data iterator, which parses the examples on a background thread while the map runs
+        auto stream = utilities::OpenDecompressingIfstream(dataLoadArguments.inputDataFilename);
+        auto exampleIterator = common::GetPrefetchingAutoSupervisedExampleIterator(*stream);
 
         // get output stream
         auto& outputStream = dataSaveArguments.outputDataStream;
@@ -111,6 +277,20 @@ int main(int argc, char* argv[])
             outputStream << "std:\t" << v << '\n';
         }
 
+        // output binary dataset mode
+        else if (applyArguments.binaryOutput)
+        {
+            data::AutoSupervisedDataset dataset;
+            while (exampleIterator.IsValid())
+            {
+                auto example = exampleIterator.Get();
+                auto mappedDataVector = map.Compute<data::FloatDataVector>(example.GetDataVector());
+                dataset.AddExample(data::AutoSupervisedExample(data::AutoDataVector(std::make_unique<data::FloatDataVector>(std::move(mappedDataVector))), example.GetMetadata()));
+                exampleIterator.Next();
+            }
+            common::SaveBinaryDataset(dataset, dataSaveArguments.outputDataFilename);
+        }
+
         // output new dataset mode
         else
         {
@@ -124,6 +304,7 @@ int main(int argc, char* argv[])
                 exampleIterator.Next();
             }
         }
+        mapLoadArguments.WriteTimingReport();
     }
     catch (const utilities::CommandLineParserPrintHelpException& exception)
     {
@@ -33,12 +33,21 @@ struct CompileArguments
     bool outputMapWithOptions = false;
     bool outputRefinedMap = false;
     bool outputCompiledMap = false;
+    bool outputFootprint = false; // write a report of the code, weight, buffer and stack size of each node
     std::string outputDirectory;
     std::string outputFilenameBase;
     bool verbose = false;
 
     // model-generation options
     int maxRefinementIterations = 0;
+    std::string quantizationDatasetFilename; // samples used to calibrate quantized layers
+
+    // multi-target options
+    std::string targets; // comma-separated list of target[:feature+feature...] specs compiled from one refined map
+    bool outputDispatcher = false; // write a stub that picks the best x86 variant at load time
+
+    // multi-model options
+    std::string mergeMaps; // comma-separated list of maps compiled into the same module as the input map
 };
 
 /// <summary> Parsed command line arguments for the compile executable. </summary>
@@ -77,6 +77,13 @@ void ParsedCompileArguments::AddArgs(utilities::CommandLineParser& parser)
         "Write out compiled map",
         false);
 
+    parser.AddOption(
+        outputFootprint,
+        "footprint",
+        "",
+        "Write out a report of the code, weight, buffer and stack size of each node (<outputFilenameBase>_footprint.json), and summarize it in the header file",
+        false);
+
     parser.AddOption(
         outputDirectory,
         "outputDirectory",
@@ -91,6 +98,31 @@ void ParsedCompileArguments::AddArgs(utilities::CommandLineParser& parser)
         "Base filename for compiled model files (if none specified, use the input model filename)",
         "");
 
+    parser.AddDocumentationString("");
+    parser.AddDocumentationString("Multi-target options");
+    parser.AddOption(
+        targets,
+        "targets",
+        "",
+        "Comma-separated list of targets to compile for in one run, each a target name optionally followed by ':' and '+'-separated CPU features, e.g. 'pi3,pi3_64,aarch64,linux,linux:avx2+fma'. The map is loaded and refined once (once per pointer size), and the output files of each target get its name as a suffix. Replaces --target",
+        "");
+
+    parser.AddOption(
+        outputDispatcher,
+        "dispatcher",
+        "",
+        "With --targets, compile the x86 variants under distinct names and write a C file (<base>_dispatch.c) that exports the model's functions, bound when the program is loaded to the best variant the CPU supports (Linux x86 targets only)",
+        false);
+
+    parser.AddDocumentationString("");
+    parser.AddDocumentationString("Multi-model options");
+    parser.AddOption(
+        mergeMaps,
+        "mergeMaps",
+        "",
+        "Comma-separated list of maps to compile into one module with the input map. Inputs with the same name are shared and common preprocessing is computed once. The predict function computes every map's outputs, named <map>_<output> after the file names, and <predict>_<map> computes one map's outputs",
+        "");
+
     parser.AddDocumentationString("");
     parser.AddDocumentationString("Misc options");
     parser.AddOption(
@@ -100,6 +132,13 @@ void ParsedCompileArguments::AddArgs(utilities::CommandLineParser& parser)
         "The maximal number of refinement iterations (only valid if outputType is 'refinedMap')",
         10);
 
+    parser.AddOption(
+        quantizationDatasetFilename,
+        "quantizationDataset",
+        "qd",
+        "Dataset of sample inputs used to calibrate layers for --quantizeLayers",
+        "");
+
     parser.AddOption(
         verbose,
         "verbose",
@@ -10,6 +10,10 @@
 
 #include <data/include/Dataset.h>
 
+#include <emitters/include/IRModuleEmitter.h>
+#include <emitters/include/TargetDevice.h>
+
+#include <common/include/DataLoaders.h>
 #include <common/include/LoadModel.h>
 #include <common/include/MapCompilerArguments.h>
 #include <common/include/MapLoadArguments.h>
@@ -20,17 +24,23 @@
 #include <model/include/OutputNode.h>
 #include <model/include/SetCompilerOptionsTransformation.h>
 
+#include <passes/include/QuantizeLayersTransformation.h>
 #include <passes/include/StandardTransformations.h>
 
 #include <utilities/include/CommandLineParser.h>
 #include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
 #include <utilities/include/Logger.h>
 #include <utilities/include/MillisecondTimer.h>
+#include <utilities/include/StringUtil.h>
 
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 using namespace ell;
 using namespace utilities::logging;
@@ -93,6 +103,332 @@ std::string GetObjExtension(model::IRCompiledMap& map)
     return ".o";
 }
 
+std::vector<std::vector<double>> LoadQuantizationSamples(const std::string& filename, size_t inputSize)
+{
+    auto stream = utilities::OpenIfstream(filename);
+    auto dataset = common::GetDataset(stream);
+    std::vector<std::vector<double>> samples;
+    for (size_t index = 0; index < dataset.NumExamples(); ++index)
+    {
+        samples.push_back(dataset.GetExample(index).GetDataVector().ToArray(inputSize));
+    }
+    return samples;
+}
+
+void WriteCompiledMapOutput(ParsedCompileArguments& compileArguments, model::IRCompiledMap& compiledMap, const std::string& baseFilename, std::stringstream& timingOutput)
+{
+    if (compileArguments.outputCompiledMap)
+    {
+        TimingOutputCollector timer(timingOutput, "Time to save compiled map", compileArguments.verbose);
+        common::SaveMap(compiledMap, baseFilename + "_compiled.ell");
+    }
+    if (compileArguments.outputHeader)
+    {
+        TimingOutputCollector timer(timingOutput, "Time to save header file", compileArguments.verbose);
+        compiledMap.WriteCodeHeader(baseFilename + ".h", emitters::ModuleOutputFormat::cHeader);
+    }
+    if (compileArguments.outputIr)
+    {
+        TimingOutputCollector timer(timingOutput, "Time to save LLVM IR", compileArguments.verbose);
+        compiledMap.WriteCode(baseFilename + ".ll", emitters::ModuleOutputFormat::ir);
+    }
+    if (compileArguments.outputBitcode)
+    {
+        TimingOutputCollector timer(timingOutput, "Time to save LLVM bitcode", compileArguments.verbose);
+        compiledMap.WriteCode(baseFilename + ".bc", emitters::ModuleOutputFormat::bitcode);
+    }
+    if (compileArguments.outputAssembly || compileArguments.outputObjectCode)
+    {
+        if (compileArguments.outputAssembly)
+        {
+            TimingOutputCollector timer(timingOutput, "Time to save assembly code", compileArguments.verbose);
+            compiledMap.WriteCode(baseFilename + ".s", emitters::ModuleOutputFormat::assembly);
+        }
+        if (compileArguments.outputObjectCode)
+        {
+            TimingOutputCollector timer(timingOutput, "Time to save object code", compileArguments.verbose);
+            compiledMap.WriteCode(baseFilename + GetObjExtension(compiledMap), emitters::ModuleOutputFormat::objectCode);
+        }
+    }
+    if (compiledMap.HasExternalWeights() && (compileArguments.outputIr || compileArguments.outputBitcode || compileArguments.outputAssembly || compileArguments.outputObjectCode))
+    {
+        TimingOutputCollector timer(timingOutput, "Time to save external weights", compileArguments.verbose);
+        compiledMap.WriteExternalWeights(baseFilename + ".weights");
+    }
+    if (compileArguments.outputFootprint)
+    {
+        TimingOutputCollector timer(timingOutput, "Time to save footprint report", compileArguments.verbose);
+        compiledMap.WriteFootprintReport(baseFilename + "_footprint.json");
+    }
+    if (compileArguments.outputSwigInterface)
+    {
+        TimingOutputCollector timer(timingOutput, "Time to save SWIG interface", compileArguments.verbose);
+        compiledMap.WriteCodeHeader(baseFilename + ".i.h", emitters::ModuleOutputFormat::cHeader);
+        compiledMap.WriteCode(baseFilename + ".i", emitters::ModuleOutputFormat::swigInterface);
+    }
+}
+
+// A target of a multi-target compile
+struct TargetVariant
+{
+    std::string name; // the suffix of the variant's output files, e.g. "linux_avx2_fma"
+    std::vector<std::string> features; // CPU features added to the target's defaults, e.g. "avx2"
+    emitters::TargetDevice device;
+};
+
+std::vector<TargetVariant> ParseTargets(const std::string& targets)
+{
+    std::vector<TargetVariant> variants;
+    for (const auto& spec : utilities::Split(targets, ','))
+    {
+        if (spec.empty())
+        {
+            continue;
+        }
+
+        auto parts = utilities::Split(spec, ':');
+        TargetVariant variant;
+        variant.name = parts[0];
+        variant.device.deviceName = parts[0];
+        if (parts.size() > 1)
+        {
+            std::vector<std::string> llvmFeatures;
+            for (const auto& feature : utilities::Split(parts[1], '+'))
+            {
+                if (!feature.empty())
+                {
+                    variant.features.push_back(feature);
+                    llvmFeatures.push_back("+" + feature);
+                    variant.name += "_" + feature;
+                }
+            }
+            variant.device.features = utilities::Join(llvmFeatures, ",");
+        }
+        emitters::CompleteTargetDevice(variant.device);
+        variants.push_back(variant);
+    }
+
+    if (variants.empty())
+    {
+        throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "--targets doesn't name any target");
+    }
+    return variants;
+}
+
+bool IsX86Target(const emitters::TargetDevice& device)
+{
+    return device.triple.find("x86_64") == 0 || device.triple.find("i686") == 0 || device.triple.find("i386") == 0;
+}
+
+// Refinement only depends on the target through its pointer size (e.g. when packing bits) and, for the host, through
+// tuning, so targets that agree on these share a refined map
+std::string GetRefinementKey(const emitters::TargetDevice& device)
+{
+    return std::to_string(device.numBits) + (device.deviceName == "host" ? "_host" : "");
+}
+
+// Returns the names of the functions a compiled module exports
+std::vector<std::string> GetExportedFunctionNames(model::IRCompiledMap& compiledMap)
+{
+    std::vector<std::string> names;
+    for (const auto& function : *compiledMap.GetModule().GetLLVMModule())
+    {
+        if (!function.isDeclaration() && function.hasExternalLinkage())
+        {
+            names.push_back(function.getName().str());
+        }
+    }
+    return names;
+}
+
+std::string ReplaceAll(std::string text, const std::string& from, const std::string& to)
+{
+    for (auto position = text.find(from); position != std::string::npos; position = text.find(from, position + to.size()))
+    {
+        text.replace(position, from.size(), to);
+    }
+    return text;
+}
+
+// The variants of a model compiled for x86 CPUs with different features, and the names the dispatcher exports their
+// functions under
+struct DispatchedVariant
+{
+    const TargetVariant* target;
+    std::string moduleName;
+    std::string functionName;
+};
+
+struct DispatchedVariants
+{
+    std::string moduleName;
+    std::string functionName;
+    std::vector<DispatchedVariant> variants; // with the most features first; the last one has none
+    std::vector<std::string> exportedFunctionNames; // the model's own names of the functions the variants export
+};
+
+// Returns the name a function of the model is exported under by the given variant, or an empty string if the function
+// isn't part of the model's API
+std::string GetVariantFunctionName(const std::string& name, const std::string& moduleName, const std::string& functionName, const std::string& variantModuleName, const std::string& variantFunctionName)
+{
+    if (name == functionName)
+    {
+        return variantFunctionName;
+    }
+    if (name.find(moduleName + "_") == 0)
+    {
+        return variantModuleName + name.substr(moduleName.size());
+    }
+    return "";
+}
+
+// Writes a C file that exports each function of the model as a GNU indirect function, which the dynamic loader binds
+// to the best variant the CPU supports
+void WriteDispatcher(const DispatchedVariants& dispatch, const std::string& filename)
+{
+    auto out = utilities::OpenOfstream(filename);
+    out << "// Selects, when the program is loaded, the variant of the '" << dispatch.moduleName << "' model that this CPU supports\n";
+    out << "// Generated by the ELL compile tool: don't edit\n\n";
+    out << "#if !defined(__GNUC__) || !defined(__ELF__) || !(defined(__x86_64__) || defined(__i386__))\n";
+    out << "#error \"The model dispatcher needs GNU indirect functions on x86\"\n";
+    out << "#endif\n\n";
+
+    out << "static int " << dispatch.moduleName << "_SelectVariant(void)\n{\n";
+    out << "    __builtin_cpu_init();\n";
+    for (size_t index = 0; index + 1 < dispatch.variants.size(); ++index)
+    {
+        std::vector<std::string> checks;
+        for (const auto& feature : dispatch.variants[index].target->features)
+        {
+            checks.push_back("__builtin_cpu_supports(\"" + feature + "\")");
+        }
+        out << "    if (" << utilities::Join(checks, " && ") << ")\n";
+        out << "    {\n";
+        out << "        return " << index << "; // " << dispatch.variants[index].target->name << "\n";
+        out << "    }\n";
+    }
+    out << "    return " << dispatch.variants.size() - 1 << "; // " << dispatch.variants.back().target->name << "\n";
+    out << "}\n";
+
+    for (const auto& name : dispatch.exportedFunctionNames)
+    {
+        // The real signatures are in the model's header; the dispatcher only passes addresses around
+        std::vector<std::string> variantNames;
+        for (const auto& variant : dispatch.variants)
+        {
+            variantNames.push_back(GetVariantFunctionName(name, dispatch.moduleName, dispatch.functionName, variant.moduleName, variant.functionName));
+            out << "\nextern void " << variantNames.back() << "(void);";
+        }
+        out << "\n\nstatic void* " << name << "_Resolve(void)\n{\n";
+        out << "    switch (" << dispatch.moduleName << "_SelectVariant())\n";
+        out << "    {\n";
+        for (size_t index = 0; index + 1 < variantNames.size(); ++index)
+        {
+            out << "    case " << index << ":\n";
+            out << "        return (void*)" << variantNames[index] << ";\n";
+        }
+        out << "    default:\n";
+        out << "        return (void*)" << variantNames.back() << ";\n";
+        out << "    }\n";
+        out << "}\n\n";
+        out << "void " << name << "(void) __attribute__((ifunc(\"" << name << "_Resolve\")));\n";
+    }
+}
+
+void ProduceMultiTargetOutput(ParsedCompileArguments& compileArguments, const model::MapCompilerOptions& baseSettings, const model::ModelOptimizerOptions& optimizerOptions, const model::Map& map, const std::string& baseFilename, std::stringstream& timingOutput)
+{
+    auto targets = ParseTargets(compileArguments.targets);
+
+    // The x86 variants are compiled under their own names, so they can be linked into one program with the dispatcher
+    DispatchedVariants dispatch;
+    dispatch.moduleName = baseSettings.moduleName;
+    dispatch.functionName = baseSettings.mapFunctionName;
+    if (compileArguments.outputDispatcher)
+    {
+        for (const auto& target : targets)
+        {
+            if (IsX86Target(target.device))
+            {
+                auto moduleName = dispatch.moduleName + "_" + target.name;
+                auto functionName = GetVariantFunctionName(dispatch.functionName, dispatch.moduleName, "", moduleName, "");
+                dispatch.variants.push_back({ &target, moduleName, functionName.empty() ? dispatch.functionName + "_" + target.name : functionName });
+            }
+        }
+        if (dispatch.variants.size() < 2)
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "--dispatcher needs at least two x86 targets");
+        }
+        std::stable_sort(dispatch.variants.begin(), dispatch.variants.end(), [](const DispatchedVariant& a, const DispatchedVariant& b) {
+            return a.target->features.size() > b.target->features.size();
+        });
+        for (const auto& variant : dispatch.variants)
+        {
+            if (!variant.target->device.IsLinux() || variant.target->device.triple != dispatch.variants[0].target->device.triple)
+            {
+                throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "--dispatcher needs x86 targets that all run Linux on the same architecture");
+            }
+        }
+        if (!dispatch.variants.back().target->features.empty())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "--dispatcher needs an x86 target without added features to fall back on");
+        }
+    }
+
+    std::map<std::string, model::Map> refinedMaps;
+    for (const auto& target : targets)
+    {
+        auto settings = baseSettings;
+        settings.compilerSettings.targetDevice = target.device;
+        auto variant = std::find_if(dispatch.variants.begin(), dispatch.variants.end(), [&target](const DispatchedVariant& v) { return v.target == &target; });
+        if (variant != dispatch.variants.end())
+        {
+            settings.moduleName = variant->moduleName;
+            settings.mapFunctionName = variant->functionName;
+        }
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+
+        auto key = GetRefinementKey(target.device);
+        auto refinedMap = refinedMaps.find(key);
+        if (refinedMap == refinedMaps.end())
+        {
+            TimingOutputCollector timer(timingOutput, "Time to refine and optimize map for " + target.name, compileArguments.verbose);
+            auto refined = map;
+            compiler.RefineAndOptimize(refined);
+            refinedMap = refinedMaps.emplace(key, refined).first;
+        }
+
+        TimingOutputCollector timer(timingOutput, "Time to compile map for " + target.name, compileArguments.verbose);
+        auto compiledMap = compiler.CompileRefined(refinedMap->second);
+        timer.Stop();
+
+        if (variant != dispatch.variants.end() && variant == dispatch.variants.end() - 1)
+        {
+            // The dispatcher exports the functions of the fallback variant under the model's own names
+            for (const auto& name : GetExportedFunctionNames(compiledMap))
+            {
+                auto modelName = GetVariantFunctionName(name, variant->moduleName, variant->functionName, dispatch.moduleName, dispatch.functionName);
+                if (!modelName.empty())
+                {
+                    dispatch.exportedFunctionNames.push_back(modelName);
+                }
+            }
+            if (compileArguments.outputHeader)
+            {
+                std::stringstream header;
+                compiledMap.WriteCodeHeader(header, emitters::ModuleOutputFormat::cHeader);
+                auto out = utilities::OpenOfstream(baseFilename + ".h");
+                out << ReplaceAll(ReplaceAll(header.str(), variant->functionName, dispatch.functionName), variant->moduleName, dispatch.moduleName);
+            }
+        }
+        WriteCompiledMapOutput(compileArguments, compiledMap, baseFilename + "_" + target.name, timingOutput);
+    }
+
+    if (!dispatch.variants.empty())
+    {
+        WriteDispatcher(dispatch, baseFilename + "_dispatch.c");
+    }
+}
+
 void ProduceMapOutput(ParsedCompileArguments& compileArguments, common::ParsedMapCompilerArguments& mapCompilerArguments, common::MapLoadArguments& mapLoadArguments, model::Map& map)
 {
     std::stringstream timingOutput;
@@ -113,6 +449,7 @@ void ProduceMapOutput(ParsedCompileArguments& compileArguments, common::ParsedMa
 
     model::MapCompilerOptions settings = mapCompilerArguments.GetMapCompilerOptions(baseFilename);
     settings.compilerSettings.modelFile = ell::utilities::GetFileName(inputFilename);
+    settings.footprintReport = settings.footprintReport || compileArguments.outputFootprint;
 
     // Add model/node-specific parameters to metadata
     if (mapCompilerArguments.HasOptionsMetadata())
@@ -122,6 +459,14 @@ void ProduceMapOutput(ParsedCompileArguments& compileArguments, common::ParsedMa
         map.Transform(setOptionsTranformation);
     }
 
+    if (!compileArguments.quantizationDatasetFilename.empty())
+    {
+        TimingOutputCollector timer(timingOutput, "Time to calibrate quantized layers", compileArguments.verbose);
+        auto samples = LoadQuantizationSamples(compileArguments.quantizationDatasetFilename, map.GetInput(0)->Size());
+        passes::CalibrateQuantization(map, samples);
+        timer.Stop();
+    }
+
     if (compileArguments.outputMapWithOptions)
     {
         common::SaveMap(map, baseFilename + "_options.ell");
@@ -136,51 +481,19 @@ void ProduceMapOutput(ParsedCompileArguments& compileArguments, common::ParsedMa
     }
 
     auto optimizerOptions = mapCompilerArguments.GetModelOptimizerOptions();
-
-    model::IRMapCompiler compiler(settings, optimizerOptions);
-    TimingOutputCollector timer(timingOutput, "Time to compile map", compileArguments.verbose);
-
-    auto compiledMap = compiler.Compile(map);
-    timer.Stop();
-
-    if (compileArguments.outputCompiledMap)
-    {
-        TimingOutputCollector timer(timingOutput, "Time to save compiled map", compileArguments.verbose);
-        common::SaveMap(compiledMap, baseFilename + "_compiled.ell");
-    }
-    if (compileArguments.outputHeader)
-    {
-        TimingOutputCollector timer(timingOutput, "Time to save header file", compileArguments.verbose);
-        compiledMap.WriteCodeHeader(baseFilename + ".h", emitters::ModuleOutputFormat::cHeader);
-    }
-    if (compileArguments.outputIr)
-    {
-        TimingOutputCollector timer(timingOutput, "Time to save LLVM IR", compileArguments.verbose);
-        compiledMap.WriteCode(baseFilename + ".ll", emitters::ModuleOutputFormat::ir);
-    }
-    if (compileArguments.outputBitcode)
-    {
-        TimingOutputCollector timer(timingOutput, "Time to save LLVM bitcode", compileArguments.verbose);
-        compiledMap.WriteCode(baseFilename + ".bc", emitters::ModuleOutputFormat::bitcode);
-    }
-    if (compileArguments.outputAssembly || compileArguments.outputObjectCode)
+    if (!compileArguments.targets.empty())
     {
-        if (compileArguments.outputAssembly)
-        {
-            TimingOutputCollector timer(timingOutput, "Time to save assembly code", compileArguments.verbose);
-            compiledMap.WriteCode(baseFilename + ".s", emitters::ModuleOutputFormat::assembly);
-        }
-        if (compileArguments.outputObjectCode)
-        {
-            TimingOutputCollector timer(timingOutput, "Time to save object code", compileArguments.verbose);
-            compiledMap.WriteCode(baseFilename + GetObjExtension(compiledMap), emitters::ModuleOutputFormat::objectCode);
-        }
+        ProduceMultiTargetOutput(compileArguments, settings, optimizerOptions, map, baseFilename, timingOutput);
     }
-    if (compileArguments.outputSwigInterface)
+    else
     {
-        TimingOutputCollector timer(timingOutput, "Time to save SWIG interface", compileArguments.verbose);
-        compiledMap.WriteCodeHeader(baseFilename + ".i.h", emitters::ModuleOutputFormat::cHeader);
-        compiledMap.WriteCode(baseFilename + ".i", emitters::ModuleOutputFormat::swigInterface);
+        model::IRMapCompiler compiler(settings, optimizerOptions);
+        TimingOutputCollector timer(timingOutput, "Time to compile map", compileArguments.verbose);
+
+        auto compiledMap = compiler.Compile(map);
+        timer.Stop();
+
+        WriteCompiledMapOutput(compileArguments, compiledMap, baseFilename, timingOutput);
     }
 
     if (compileArguments.verbose)
@@ -237,8 +550,21 @@ int main(int argc, char* argv[])
         // load map and produce the desired output
         TimingOutputCollector timer(timingOutput, "Time to load map", compileArguments.verbose);
         auto map = common::LoadMap(mapLoadArguments);
+        if (!compileArguments.mergeMaps.empty())
+        {
+            std::vector<model::Map> maps;
+            std::vector<std::string> mapNames = { utilities::GetFileName(utilities::RemoveFileExtension(mapLoadArguments.GetInputFilename())) };
+            maps.push_back(std::move(map));
+            for (const auto& filename : utilities::Split(compileArguments.mergeMaps, ','))
+            {
+                maps.push_back(common::LoadMap(filename));
+                mapNames.push_back(utilities::GetFileName(utilities::RemoveFileExtension(filename)));
+            }
+            map = model::MergeMaps(maps, mapNames);
+        }
         timer.Stop();
         ProduceMapOutput(compileArguments, mapCompilerArguments, mapLoadArguments, map);
+        mapLoadArguments.WriteTimingReport();
 
         if (compileArguments.verbose)
         {
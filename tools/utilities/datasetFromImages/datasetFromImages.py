@@ -11,11 +11,15 @@
 
 import argparse
 import enum
+import hashlib
+import multiprocessing
 import os
+import struct
 import sys
 import time
 
 import cv2
+import numpy as np
 
 sys.path.append(os.path.join(os.path.dirname(os.path.abspath(__file__)), '../pythonlibs'))
 import modelHelpers
@@ -139,51 +143,120 @@ def set_binary_labels(input_examples, positive_label):
     return examples
 
 
+def load_example_data(example, width, height, use_bgr_ordering, cache_folder=None):
+    """
+    Decodes, crops and resizes the image of an example. If cache_folder is set, the resized image is
+    kept there, in a sub-folder for the image size and channel order, and reused while it's newer than
+    the image file.
+    Returns the image data as a flat uint8 array, or None if the file can't be read as an image.
+    """
+    cache_file = None
+    if cache_folder:
+        cache_name = hashlib.sha1(os.path.abspath(example[1]).encode("utf-8")).hexdigest() + ".npy"
+        size_folder = "{}x{}_{}".format(width, height, "bgr" if use_bgr_ordering else "rgb")
+        cache_file = os.path.join(cache_folder, size_folder, cache_name)
+        try:
+            if os.path.getmtime(cache_file) >= os.path.getmtime(example[1]):
+                return np.load(cache_file)
+        except (OSError, ValueError):
+            pass
+
+    image = cv2.imread(example[1])
+    if image is None:
+        return None
+    resized = modelHelpers.prepare_image_for_model(image, width, height, not use_bgr_ordering,
+                                                   convert_to_float=False, preprocess_tag=None)
+    if cache_file:
+        os.makedirs(os.path.dirname(cache_file), exist_ok=True)
+        temp_file = "{}.{}.npy".format(cache_file, os.getpid())
+        np.save(temp_file, resized)
+        os.replace(temp_file, cache_file)
+    return resized
+
+
+def _load_example_data(task):
+    return load_example_data(*task)
+
+
+class TextDatasetWriter:
+    """
+    Writes examples in the text dataset format.
+    """
+    def __init__(self, file_name, categories):
+        self.file = open(file_name, "w")
+        if categories:
+            self.file.write("# Category labels\n")
+            for i, category in enumerate(categories):
+                self.file.write("# {} : {}\n".format(i, category))
+
+    def write(self, example, data):
+        # Write label, image data, and the class and source file as a comment
+        self.file.write("{}\t".format(example[0]))
+        data.tofile(self.file, sep="\t", format="%s")
+        self.file.write("\t# class={0[2]}, source={0[1]}\n".format(example))
+
+    def close(self):
+        self.file.close()
+
+
+class BinaryDatasetWriter:
+    """
+    Writes examples in ELL's binary dataset format (see libraries/data/include/BinaryDataset.h), which the
+    trainers map into memory instead of parsing. The pixel values are stored as 16-bit integers, and the
+    label is the class index for multi-class datasets.
+    """
+    magic = b"ELLDATA1"
+    short_data_vector_type = 2  # IDataVector::Type::ShortDataVector
+
+    def __init__(self, file_name):
+        self.file = open(file_name, "wb")
+        self.count = 0
+        self.file.write(self.magic)
+        self.file.write(struct.pack("<Q", 0))
+
+    def write(self, example, data):
+        values = data.astype("<i2")
+        self.file.write(struct.pack("<ddQQ", 1.0, float(example[0]), self.short_data_vector_type, values.size))
+        self.file.write(values.tobytes())
+        self.file.write(bytes(-values.nbytes % 8))
+        self.count += 1
+
+    def close(self):
+        # The number of examples is only known once the images have been read
+        self.file.seek(len(self.magic))
+        self.file.write(struct.pack("<Q", self.count))
+        self.file.close()
+
+
 def write_examples_to_dataset_file(example_list, categories, width, height, use_bgr_ordering, output_dataset,
-                                   verbose=False):
+                                   verbose=False, binary=False, jobs=None, cache_folder=None):
     """
-    Saves an array of examples to a dataset file.
+    Saves an array of examples to a dataset file. The images are decoded and resized on a pool of
+    'jobs' processes (by default, one per core), and written in order.
     """
     print("Processing {} examples, using image size {}x{}, bgr={}".format(len(example_list), width, height,
                                                                           use_bgr_ordering))
-    with open(output_dataset, 'w') as dataset_file:
-        # Write header
-        if categories:
-            dataset_file.write("# Category labels\n")
-            for i, category in enumerate(categories):
-                dataset_file.write("# {} : {}\n".format(i, category))
-
-        count = 0
-        for example in example_list:
-            # Try to read this as an image
-            image = cv2.imread(example[1])
-            if image is not None:
-                if verbose:
-                    print("Processing {0[0]} | {0[1]}".format(example))
-
-                # Write label
-                dataset_file.write("{}".format(example[0]))
-
-                # Write image data
-                resized = modelHelpers.prepare_image_for_model(image, width, height, not use_bgr_ordering,
-                                                               convert_to_float=False, preprocess_tag=None)
-                dataset_file.write("\t")
-                resized.tofile(dataset_file, sep="\t", format="%s")
-                # Write label, source file as comment
-                dataset_file.write("\t# class={0[2]}, source={0[1]}".format(example))
-                dataset_file.write("\n")
-
-                if verbose:
-                    print("    Wrote {} data values".format(len(resized)))
-                else:
-                    if (count + 1) % 1000 == 0:
-                        print(".", sep="", end="")
-                count += 1
-            else:
+    writer = BinaryDatasetWriter(output_dataset) if binary else TextDatasetWriter(output_dataset, categories)
+    tasks = [(example, width, height, use_bgr_ordering, cache_folder) for example in example_list]
+    count = 0
+    with multiprocessing.Pool(jobs) as pool:
+        for example, data in zip(example_list, pool.imap(_load_example_data, tasks, chunksize=16)):
+            if data is None:
                 print("Skipping {}, could not open as an image".format(example[1]))
+                continue
+
+            if verbose:
+                print("Processing {0[0]} | {0[1]}".format(example))
+            writer.write(example, data)
+            if verbose:
+                print("    Wrote {} data values".format(len(data)))
+            elif (count + 1) % 1000 == 0:
+                print(".", sep="", end="", flush=True)
+            count += 1
+    writer.close()
 
     print()
-    print("Wrote {} examples to {}".format(len(example_list), output_dataset))
+    print("Wrote {} examples to {}".format(count, output_dataset))
 
 
 def parse_size(image_size):
@@ -244,6 +317,14 @@ line is a label number followed by whitespace path to image")
     arg_parser.add_argument("--exampleOrder", choices=['labelfirst', 'filefirst'], default="labelfirst",
                             help="the order of the columns in the example list")
 
+    arg_parser.add_argument("--binary", action="store_true",
+                            help="write the dataset in ELL's binary dataset format, which loads much faster than text")
+    arg_parser.add_argument("--jobs", type=int, default=None,
+                            help="the number of processes decoding and resizing images (default one per core)")
+    arg_parser.add_argument("--cache", default=None,
+                            help="path to a folder to cache resized images in, so building another dataset with the \
+same image size only decodes new or changed images")
+
     arg_parser.add_argument("--verbose", help="print info for each file processed", action="store_true")
 
     args = arg_parser.parse_args(argv)
@@ -264,7 +345,7 @@ line is a label number followed by whitespace path to image")
 
     # process the examples
     write_examples_to_dataset_file(examples, categories, width, height, args.bgr, args.outputDataset,
-                                   verbose=args.verbose)
+                                   verbose=args.verbose, binary=args.binary, jobs=args.jobs, cache_folder=args.cache)
     end = time.time()
     print("Total time to create dataset: {:.1f} seconds".format(end - start))
 
@@ -29,6 +29,10 @@ struct CompareArguments
     bool writeReport = true;
     bool writeGraph = true;
     bool writePrediction = true;
+
+    // comparison options
+    double tolerance = 1e-4;
+    int numThreads = 0;
 };
 
 /// <summary> Arguments for parsed print. </summary>
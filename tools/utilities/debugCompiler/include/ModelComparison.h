@@ -38,7 +38,9 @@ public:
     /// <summary> Constructor </summary>
     ///
     /// <param name="outputDirectory"> The directory the output files will be written to. </param>
-    ModelComparison(std::string outputDirectory);
+    /// <param name="tolerance"> The largest absolute difference between a reference and compiled value that isn't reported as a mismatch. </param>
+    /// <param name="numThreads"> The number of threads that compare layer outputs, zero to use one per core. </param>
+    ModelComparison(std::string outputDirectory, double tolerance = 1e-4, int numThreads = 0);
 
     /// <summary> Compares the "reference" output vs. compiled otuput of a map. </summary>
     ///
@@ -101,6 +103,16 @@ private:
         std::vector<float> compiledData;
     };
 
+    // The differences between the reference and compiled outputs of a layer
+    struct LayerComparison
+    {
+        VectorStatistics refStats;
+        VectorStatistics compiledStats;
+        VectorStatistics diffStats;
+        float absDiffSum = 0;
+        size_t numMismatches = 0; // the number of values that differ by more than the tolerance
+    };
+
     void AddDebugOutputNode(model::ModelTransformer& transformer, const model::Node& node);
     template <typename ValueType>
     void AddDebugOutputNode(model::ModelTransformer& transformer, const nodes::NeuralNetworkLayerNodeBase<ValueType>* layerNode);
@@ -109,7 +121,9 @@ private:
     void CreateGraph(const model::Model& model);
     void AddStyles();
     void WriteModelInfo(std::ostream& outputStream, const std::vector<float>& reference, const std::vector<float>& compiled, bool writePrediction);
-    void WriteNodeRow(std::ostream& outputStream, std::string id, std::string name, const std::vector<float>& reference, const std::vector<float>& compiled, const LayerCaptureData& layerData);
+    LayerComparison CompareLayer(const LayerCaptureData& layerData);
+    std::vector<LayerComparison> CompareLayers();
+    void WriteNodeRow(std::ostream& outputStream, std::string id, std::string name, const LayerCaptureData& layerData, const LayerComparison& comparison);
     void WriteNodeDetail(std::ostream& outputStream, const model::Node* node);
     void WriteStatsRow(std::ostream& outputStream, const VectorStatistics& refStats, const VectorStatistics& compiledStats, const VectorStatistics& diffStats, float sumAbsDiff);
     template <typename ValueType>
@@ -125,7 +139,11 @@ private:
     std::string _outputDirectory;
     bool _runningCompiled;
     std::vector<LayerCaptureData> _layerOutputData;
+    std::map<std::string, size_t> _referenceLayerIndices; // index in _layerOutputData of each reference layer label
+    std::map<std::string, size_t> _compiledLayerIndices; // index in _layerOutputData of each compiled layer label
     size_t _nextIndex;
+    double _tolerance;
+    int _numThreads;
     double _minError;
     double _maxError;
     bool _hasMinMax;
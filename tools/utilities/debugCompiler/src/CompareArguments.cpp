@@ -21,5 +21,9 @@ void ParsedCompareArguments::AddArgs(utilities::CommandLineParser& parser)
     parser.AddOption(writeReport, "report", "", "Generate markdown report", true);
     parser.AddOption(writeGraph, "graph", "", "Write DGML graph", true);
     parser.AddOption(writePrediction, "pred", "", "Write prediction to report", true);
+
+    parser.AddDocumentationString("Comparison options");
+    parser.AddOption(tolerance, "tolerance", "tol", "Largest absolute difference between reference and compiled values that counts as a match", 1e-4);
+    parser.AddOption(numThreads, "numThreads", "nt", "Number of threads that compare layer outputs (0 = one per core)", 0);
 }
 } // namespace ell
@@ -18,7 +18,10 @@
 
 #include <utilities/include/Files.h>
 #include <utilities/include/Graph.h>
+#include <utilities/include/ParallelFor.h>
 
+#include <algorithm>
+#include <cmath>
 #include <sstream>
 #include <string>
 
@@ -228,12 +231,41 @@ std::vector<float> GetMapOutput(model::Map& map, const std::vector<float>& input
     }
 }
 
+template <typename InputType>
+void SetMapInput(model::Map& map, const std::vector<float>& input)
+{
+    map.SetInputValue(0, std::vector<InputType>(input.begin(), input.end()));
+}
+
+void SetMapInput(model::Map& map, const std::vector<float>& input)
+{
+    switch (map.GetInputType())
+    {
+    case model::Port::PortType::smallReal:
+        SetMapInput<float>(map, input);
+        break;
+    case model::Port::PortType::real:
+        SetMapInput<double>(map, input);
+        break;
+    case model::Port::PortType::integer:
+        SetMapInput<int>(map, input);
+        break;
+    case model::Port::PortType::bigInt:
+        SetMapInput<int64_t>(map, input);
+        break;
+    default:
+        throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Model has an unsupported input type");
+    }
+}
+
 //
 // ModelComparison implementation
 //
-ModelComparison::ModelComparison(std::string outputDirectory)
+ModelComparison::ModelComparison(std::string outputDirectory, double tolerance, int numThreads)
 {
     _outputDirectory = outputDirectory;
+    _tolerance = tolerance;
+    _numThreads = numThreads;
     _runningCompiled = false;
     _addingReference = false;
     _minError = 0;
@@ -342,39 +374,30 @@ void ModelComparison::Compare(std::vector<float>& input, model::Map& reference,
     // build the graph
     CreateGraph(compiledMap.GetModel());
 
-    // Compute reference output
+    // Compute the reference output and the outputs of all the reference DebugSinkNodes in a single run of the model.
+    // Map::Compute would skip the DebugSinkNodes, because the map's output doesn't depend on them, so visit them
+    // along with the output. Each DebugSinkNode calls AddLayer below.
     _runningCompiled = false;
-    _outputReference = GetMapOutput(_referenceMap, input);
-
-    // Gather the reference model DebugSinkNode outputs
     std::vector<const ell::model::OutputPortBase*> referenceOutputs;
-    for (size_t i = 0, length = _layerOutputData.size(); i < length; i++)
+    for (const auto& layerData : _layerOutputData)
     {
-        LayerCaptureData& layerData = _layerOutputData[i];
         if (layerData.referenceDebugSinkNode != nullptr)
         {
             referenceOutputs.push_back(layerData.referenceDebugSinkNode->GetOutputPort(0));
         }
     }
+    const auto& referenceOutput = _referenceMap.GetOutput(0);
+    referenceOutputs.push_back(&referenceOutput);
 
-    // Now the normal reference.Compute will skip my DebugSinkNodes, so now I have to do another VisitSubmodel to gather that output.
-    // This will cause the DebugSinkNode Sink function to fire which will call AddLayer below.
+    SetMapInput(_referenceMap, input);
     auto compute = [](const model::Node& node) { node.Compute(); };
     _referenceMap.GetModel().VisitSubmodel(referenceOutputs, compute);
+    auto referenceValues = referenceOutput.GetDoubleOutput();
+    _outputReference.assign(referenceValues.begin(), referenceValues.end());
 
-    // Compute compiled output
+    // Compute the compiled output, which gathers the compiled layer outputs through the DebugOutput callback
     _runningCompiled = true;
     _outputCompiled = GetMapOutput(compiledMap, input);
-
-    // The reference model is run a second time to gather the per-node outputs. We
-    // need to do the same thing for the compiled one, so that stateful models will
-    // match appropriately.
-    // We keep the overall output from the first run only, because that's what we do
-    // with the reference.
-    // This means that the "overall" stats don't actually report a summary of the per-node stats.
-    // We should fix this eventually to collect per-node and overall outputs during the same run
-    // of the reference model.
-    auto temp = GetMapOutput(compiledMap, input);
 }
 
 void ModelComparison::SaveOutput(std::string name, const std::vector<float>& reference, const std::vector<float>& compiled)
@@ -413,19 +436,79 @@ void ModelComparison::WriteReport(std::ostream& outputStream, std::string modelN
     outputStream << std::endl;
 
     WriteModelInfo(outputStream, _outputReference, _outputCompiled, writePrediction);
-    for (auto& layerData : _layerOutputData)
+    auto comparisons = CompareLayers();
+    std::string firstMismatch;
+    for (size_t index = 0; index < _layerOutputData.size(); ++index)
     {
+        const auto& layerData = _layerOutputData[index];
         if (layerData.compiledNodeLabel != "")
         {
             std::string id = layerData.compiledNodeId;
             std::string label = layerData.compiledNodeLabel;
-            WriteNodeRow(outputStream, id, label, layerData.referenceData, layerData.compiledData, layerData);
+            WriteNodeRow(outputStream, id, label, layerData, comparisons[index]);
+            if (firstMismatch.empty() && comparisons[index].numMismatches > 0)
+            {
+                firstMismatch = label;
+            }
         }
         else
         {
             std::cout << "Compiled data missing for reference node " << layerData.referenceNodeLabel << std::endl;
         }
     }
+
+    // The first layer that doesn't match is usually where to start looking, because the differences propagate
+    outputStream << "## Summary" << std::endl;
+    if (firstMismatch.empty())
+    {
+        outputStream << "All layers match to within " << _tolerance << std::endl;
+    }
+    else
+    {
+        outputStream << "First layer that differs by more than " << _tolerance << ": " << firstMismatch << std::endl;
+        std::cout << "First layer that differs by more than " << _tolerance << ": " << firstMismatch << std::endl;
+    }
+}
+
+ModelComparison::LayerComparison ModelComparison::CompareLayer(const LayerCaptureData& layerData)
+{
+    const auto& reference = layerData.referenceData;
+    const auto& compiled = layerData.compiledData;
+    LayerComparison result;
+    if (layerData.compiledNodeLabel == "" || compiled.size() == 0)
+    {
+        // Layer was pruned from compiled model
+        return result;
+    }
+
+    SaveOutput("Compare_" + layerData.compiledNodeLabel, reference, compiled);
+
+    // Get mem layout, extract relevant part, get subtensor
+    math::ChannelColumnRowTensor<float> refTensor(layerData.stride[0], layerData.stride[1], layerData.stride[2], reference);
+    math::ChannelColumnRowTensor<float> compiledTensor(layerData.stride[0], layerData.stride[1], layerData.stride[2], compiled);
+
+    auto validRefTensor = refTensor.GetSubTensor(layerData.offset[0], layerData.offset[1], layerData.offset[2], layerData.size[0], layerData.size[1], layerData.size[2]);
+    auto validCompiledTensor = compiledTensor.GetSubTensor(layerData.offset[0], layerData.offset[1], layerData.offset[2], layerData.size[0], layerData.size[1], layerData.size[2]);
+    auto diff = Abs(Subtract(validRefTensor, validCompiledTensor)).ToArray();
+
+    result.refStats = VectorStatistics(validRefTensor);
+    result.compiledStats = VectorStatistics(validCompiledTensor);
+    result.diffStats = VectorStatistics(diff);
+    result.absDiffSum = VectorStatistics::Diff(validRefTensor, validCompiledTensor);
+    result.numMismatches = std::count_if(diff.begin(), diff.end(), [this](float x) { return !(x <= _tolerance); }); // NaN counts as a mismatch
+    return result;
+}
+
+std::vector<ModelComparison::LayerComparison> ModelComparison::CompareLayers()
+{
+    // Each layer is compared (and its CSV file written) independently, so the layers are split into contiguous
+    // ranges, one per thread
+    const auto numLayers = _layerOutputData.size();
+    std::vector<LayerComparison> result(numLayers);
+    utilities::ParallelFor(numLayers, static_cast<size_t>(std::max(_numThreads, 0)), [this, &result](size_t index) {
+        result[index] = CompareLayer(_layerOutputData[index]);
+    });
+    return result;
 }
 
 void ModelComparison::WriteStatsRow(std::ostream& outputStream, const VectorStatistics& refStats, const VectorStatistics& compiledStats, const VectorStatistics& diffStats, float absDiffSum)
@@ -485,31 +568,17 @@ void ModelComparison::WriteModelInfo(std::ostream& outputStream, const std::vect
     outputStream << "````" << std::endl;
 }
 
-void ModelComparison::WriteNodeRow(std::ostream& outputStream, std::string id, std::string name, const std::vector<float>& reference, const std::vector<float>& compiled, const LayerCaptureData& layerData)
+void ModelComparison::WriteNodeRow(std::ostream& outputStream, std::string id, std::string name, const LayerCaptureData& layerData, const LayerComparison& comparison)
 {
-    if (compiled.size() == 0)
+    if (layerData.compiledData.size() == 0)
     {
         // Layer was pruned from compiled model
         return;
     }
 
-    SaveOutput("Compare_" + name, reference, compiled);
-
     outputStream << "## " << name << std::endl;
 
-    // Get mem layout, extract relevant part, get subtensor
-    math::ChannelColumnRowTensor<float> refTensor(layerData.stride[0], layerData.stride[1], layerData.stride[2], reference);
-    math::ChannelColumnRowTensor<float> compiledTensor(layerData.stride[0], layerData.stride[1], layerData.stride[2], compiled);
-    math::ChannelColumnRowTensor<float> diffTensor(layerData.stride[0], layerData.stride[1], layerData.stride[2], Abs(Subtract(reference, compiled)));
-
-    auto validRefTensor = refTensor.GetSubTensor(layerData.offset[0], layerData.offset[1], layerData.offset[2], layerData.size[0], layerData.size[1], layerData.size[2]);
-    auto validCompiledTensor = compiledTensor.GetSubTensor(layerData.offset[0], layerData.offset[1], layerData.offset[2], layerData.size[0], layerData.size[1], layerData.size[2]);
-
-    VectorStatistics refStats(validRefTensor);
-    VectorStatistics compiledStats(validCompiledTensor);
-    VectorStatistics diffStats(Abs(Subtract(validRefTensor, validCompiledTensor)));
-
-    float absDiffSum = VectorStatistics::Diff(validRefTensor, validCompiledTensor);
+    float absDiffSum = comparison.absDiffSum;
     if (!_hasMinMax)
     {
         _minError = _maxError = absDiffSum;
@@ -534,7 +603,8 @@ void ModelComparison::WriteNodeRow(std::ostream& outputStream, std::string id, s
         outputStream << "output size = " << layerData.size << ", datasize = " << layerData.stride << ", offset = " << layerData.offset << std::endl;
     }
 
-    WriteStatsRow(outputStream, refStats, compiledStats, diffStats, absDiffSum);
+    WriteStatsRow(outputStream, comparison.refStats, comparison.compiledStats, comparison.diffStats, absDiffSum);
+    outputStream << "values that differ by more than " << _tolerance << ": " << comparison.numMismatches << std::endl;
     outputStream << "````" << std::endl;
 
     if (id != "")
@@ -648,35 +718,24 @@ void ModelComparison::AddLayer(const char* label, const ValueType* output)
     std::vector<float> data(output, output + size);
     if (_runningCompiled)
     {
-        bool found = false;
-        for (auto& layerData : _layerOutputData)
+        auto iter = _compiledLayerIndices.find(id);
+        if (iter != _compiledLayerIndices.end())
         {
-            std::string compiledId = _nodeMap[layerData.referenceNodeLabel];
-            if (compiledId == id)
-            {
-                found = true;
-                layerData.compiledData = { data.begin(), data.end() };
-                break;
-            }
+            _layerOutputData[iter->second].compiledData = std::move(data);
         }
-        if (!found)
+        else
         {
             std::cout << "### Error: could not find LayerCaptureData for compiled layer " << id << std::endl;
         }
     }
     else
     {
-        bool found = false;
-        for (auto& layerData : _layerOutputData)
+        auto iter = _referenceLayerIndices.find(id);
+        if (iter != _referenceLayerIndices.end())
         {
-            if (layerData.referenceNodeLabel == id)
-            {
-                layerData.referenceData = { data.begin(), data.end() };
-                found = true;
-                break;
-            }
+            _layerOutputData[iter->second].referenceData = std::move(data);
         }
-        if (!found)
+        else
         {
             std::cout << "### Error: could not find LayerCaptureData for reference layer " << id << std::endl;
         }
@@ -785,6 +844,7 @@ void ModelComparison::AddDebugOutputNode(model::ModelTransformer& transformer, c
         layerData.compiledDebugSinkNode = nullptr;
         layerData.referenceDebugSinkNode = sinkNode;
         layerData.referenceNodeLabel = label;
+        _referenceLayerIndices[label] = _layerOutputData.size();
         _layerOutputData.emplace_back(std::move(layerData));
         _nextIndex = 0;
     }
@@ -803,6 +863,7 @@ void ModelComparison::AddDebugOutputNode(model::ModelTransformer& transformer, c
             layerData.compiledNodeLabel = label;
             auto referenceLabel = GetSinkNodeLabel(layerData.referenceDebugSinkNode);
             _nodeMap[referenceLabel] = label;
+            _compiledLayerIndices[label] = i;
         }
     }
 }
@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include "ModelOutputDataCache.h"
 #include "OptimizationUtils.h"
 #include "Report.h"
 
@@ -67,6 +68,9 @@ struct FineTuneArguments
     bool multiClass = true;
     std::string dataFormat;
     int maxCacheEntries = 8;
+    int maxCacheMemory = 0; // in MB
+    std::string cacheSpillDirectory;
+    bool compressCache = false;
 
     // Node selection
     int numPrefixNodesToSkip = 0;
@@ -87,7 +91,9 @@ struct FineTuneArguments
     bool normalizeOutputs = false;
     bool reoptimizeSparseWeights = false;
     bool optimizeFiltersIndependently = false;
+    int numThreads = 0;
     bool permute = true;
+    int batchSize = 1;
     TargetNodeFlags fineTuneTargets = TargetNodeType::fullConvolution | TargetNodeType::pointwiseConvolution | TargetNodeType::fullyConnected;
 
     // Sparsification parameters
@@ -96,6 +102,9 @@ struct FineTuneArguments
     double sparsityTarget = 0; // overrides l1 regularization if set
     double sparsityTargetEpsilon = 0.01;
 
+    // Factorization parameters
+    double factorizeTolerance = 0; // if nonzero, fully-connected layers are factored into two low-rank layers before being fine-tuned
+
     // Misc
     std::string randomSeed;
     std::string reportFilename;
@@ -108,6 +117,7 @@ struct FineTuneArguments
 
     // Helper methods for creating settings objects from arguments
     FineTuneProblemParameters GetFineTuneProblemParameters() const;
+    ModelOutputDataCacheOptions GetDataCacheOptions() const;
 
     /// <summary> Get the output of the (potentially truncated) model to fine-tune. This is the output our new model will try to match. </summary>
     const ell::model::OutputPortBase& GetInputModelTargetOutput() const;
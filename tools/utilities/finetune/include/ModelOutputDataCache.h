@@ -12,34 +12,96 @@
 
 #include <model/include/OutputPort.h>
 
+#include <utilities/include/MemoryMappedFile.h>
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace ell
 {
-/// <summary> Caches the results from running a dataset through a model. </summary>
+/// <summary> Limits on the memory used by a ModelOutputDataCache, and what to do with the entries it evicts. </summary>
+struct ModelOutputDataCacheOptions
+{
+    /// <summary> The maximum number of entries kept in memory (0 = no limit). </summary>
+    int maxEntries = 0;
+
+    /// <summary> The maximum number of bytes of activations kept in memory (0 = no limit). </summary>
+    size_t maxMemoryBytes = 0;
+
+    /// <summary> The directory for the scratch file evicted entries are written to. If empty, evicted entries are discarded. </summary>
+    std::string spillDirectory;
+
+    /// <summary> Store spilled activations as 16-bit floats, which halves the scratch file size at the cost of precision. </summary>
+    bool compressSpilledData = false;
+};
+
+/// <summary>
+/// Caches the results from running a dataset through a model. Entries are kept in memory up to the limits in the
+/// options, and the least-recently-used entries are evicted past them. Evicted entries are written to a scratch
+/// file if there is a spill directory, and read back (through a memory-mapped view of the file) the next time
+/// they're used.
+/// </summary>
 class ModelOutputDataCache
 {
 public:
     ModelOutputDataCache();
     ModelOutputDataCache(int maxCacheSize);
+    ModelOutputDataCache(const ModelOutputDataCacheOptions& options);
+    ~ModelOutputDataCache();
+
+    ModelOutputDataCache(const ModelOutputDataCache&) = delete;
+    ModelOutputDataCache& operator=(const ModelOutputDataCache&) = delete;
+
     bool HasCachedData(const ell::model::OutputPortBase* port) const;
     const UnlabeledDataContainer& GetCachedData(const ell::model::OutputPortBase* port) const;
     void RemoveCachedData(const ell::model::OutputPortBase* port);
     void SetCachedData(const ell::model::OutputPortBase* port, UnlabeledDataContainer data);
 
+    /// <summary> Returns the number of bytes of activations held in memory. </summary>
+    size_t GetMemoryUsage() const { return _memoryUsage; }
+
+    /// <summary> Indicates whether the entry for a port is in the scratch file rather than in memory. </summary>
+    bool IsSpilled(const ell::model::OutputPortBase* port) const;
+
     // ??
     const ell::model::OutputPortBase* FindNearestCachedOutputPort(const ell::model::OutputPortBase* output);
 
 private:
-    void RemoveLeastRecentlyUsedEntry();
+    struct SpilledData
+    {
+        bool written = false;
+        uint64_t offset = 0;
+        std::vector<size_t> rowSizes;
+        bool compressed = false;
+    };
 
     struct CacheEntry
     {
-        int64_t generation;
+        int64_t generation = 0;
+        bool resident = true;
         UnlabeledDataContainer data;
+        SpilledData spilled;
     };
+
+    static size_t GetDataSize(const UnlabeledDataContainer& data);
+    void MakeRoom(size_t size, const ell::model::OutputPortBase* keep) const;
+    bool RemoveLeastRecentlyUsedEntry(const ell::model::OutputPortBase* keep) const;
+    void Spill(CacheEntry& entry) const;
+    void Restore(CacheEntry& entry) const;
+
     mutable std::unordered_map<const ell::model::OutputPortBase*, CacheEntry> _cache;
     mutable int64_t _currentGeneration = 0;
-    int _maxCacheSize = 0;
+    mutable size_t _memoryUsage = 0;
+    ModelOutputDataCacheOptions _options;
+
+    // The scratch file is only appended to; space is reclaimed when the cache is destroyed
+    std::string _spillFilename;
+    mutable std::ofstream _spillFile;
+    mutable uint64_t _spillFileSize = 0;
+    mutable std::unique_ptr<utilities::MemoryMappedFile> _spillFileView;
 };
 } // namespace ell
@@ -10,6 +10,7 @@
 
 #include "DataUtils.h"
 
+#include <optimization/include/BinarySearch.h>
 #include <optimization/include/ElasticNetRegularizer.h>
 #include <optimization/include/GetSparseSolution.h>
 #include <optimization/include/HingeLoss.h>
@@ -26,10 +27,12 @@
 
 #include <utilities/include/Logger.h>
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <optional>
 #include <string>
+#include <thread>
 
 namespace ell
 {
@@ -60,6 +63,7 @@ struct FineTuneOptimizationParameters
 
     // optimization params
     bool optimizeFiltersIndependently = false;
+    int numThreads = 0; // for optimizing output channels independently (0 = one per core)
     ell::optimization::SDCAOptimizerParameters optimizerParameters;
     int maxEpochs = 0;
     double desiredPrecision = 0;
@@ -83,6 +87,7 @@ struct FineTuneProblemParameters
     FineTuneOptimizationParameters fineTuneParameters;
     FineTuneOptimizationParameters sparsifyParameters;
     FineTuneOptimizationParameters reoptimizeParameters;
+    double factorizeTolerance = 0;
     // copyParameters (== fineTune?)
 };
 
@@ -127,6 +132,7 @@ VectorOptimizerResult TrainVectorPredictor(VectorLabelDataContainer dataset, con
 // TODO: find a better (more general) way to indicate what the solution is, rather than with a "isSpatialConvolution" flag
 VectorOptimizerResult TrainVectorPredictor(VectorLabelDataContainer dataset, const FineTuneOptimizationParameters& optimizerParameters, bool isSpatialConvolution);
 
+VectorOptimizerResult ReoptimizeSparsePredictor(VectorOptimizerResult& sparseSolution, VectorLabelDataContainer dataset, const FineTuneOptimizationParameters& optimizerParameters);
 VectorOptimizerResult ReoptimizeSparsePredictor(VectorOptimizerResult& sparseSolution, VectorLabelDataContainer dataset, const FineTuneOptimizationParameters& optimizerParameters, bool isSpatialConvolution);
 
 #pragma region implementation
@@ -232,6 +238,7 @@ OptimizerResult<SolutionType> TrainSparsePredictor(std::shared_ptr<DatasetType>
         sparseParams.SDCARandomSeedString = optimizerParameters.randomSeed;
         sparseParams.exponentialSearchGuess = 1.0 / 64.0;
         sparseParams.exponentialSearchBase = 4.0;
+        sparseParams.numConcurrentProbes = optimizerParameters.numThreads > 0 ? optimizerParameters.numThreads : std::max(std::thread::hardware_concurrency(), 1u);
 
         // Run the optimizer to find a sparse solution
         Log() << "Finding a sparse solution:\n";
@@ -19,6 +19,7 @@
 
 #include <math/include/Vector.h>
 
+#include <utilities/include/DecompressingStream.h>
 #include <utilities/include/Files.h>
 
 #include <algorithm>
@@ -232,8 +233,8 @@ namespace
         {
             throw utilities::SystemException(utilities::SystemExceptionErrors::fileNotFound, "Dataset file not readable: " + filename);
         }
-        auto stream = utilities::OpenIfstream(filename);
-        auto dataset = common::GetDataset(stream);
+        auto stream = utilities::OpenDecompressingIfstream(filename);
+        auto dataset = common::GetDataset(*stream);
         return dataset;
     }
 
@@ -350,8 +351,8 @@ MultiClassDataContainer LoadMultiClassDataContainer(std::string datasetFilename,
 
 MultiClassDataContainer LoadMultiClassDataContainer(std::string filename, int maxRows)
 {
-    auto stream = utilities::OpenIfstream(filename);
-    auto iter = common::GetExampleIterator<data::SequentialLineIterator, data::ClassIndexParser, RowVectorParser<data::GeneralizedSparseParsingIterator>>(stream);
+    auto stream = utilities::OpenDecompressingIfstream(filename);
+    auto iter = common::GetExampleIterator<data::SequentialLineIterator, data::ClassIndexParser, RowVectorParser<data::GeneralizedSparseParsingIterator>>(*stream);
     MultiClassDataContainer result;
     while (iter.IsValid() && (static_cast<int>(result.Size()) < maxRows || maxRows <= 0))
     {
@@ -13,6 +13,7 @@
 
 #include <utilities/include/Exception.h>
 
+#include <algorithm>
 #include <iostream>
 
 namespace ell
@@ -63,6 +64,7 @@ FineTuneOptimizationParameters FineTuneArguments::GetFineTuneParameters() const
     optimization::SDCAOptimizerParameters sdcaParams;
     sdcaParams.regularizationParameter = l2Regularization;
     sdcaParams.permuteData = permute;
+    sdcaParams.batchSize = static_cast<size_t>(std::max(batchSize, 1));
 
     FineTuneOptimizationParameters params;
     params.optimizerParameters = sdcaParams;
@@ -72,6 +74,7 @@ FineTuneOptimizationParameters FineTuneArguments::GetFineTuneParameters() const
     params.desiredPrecision = desiredPrecision;
     params.requiredPrecision = requiredPrecision;
     params.optimizeFiltersIndependently = optimizeFiltersIndependently;
+    params.numThreads = numThreads;
     params.randomSeed = randomSeed;
     return params;
 }
@@ -104,9 +107,20 @@ FineTuneProblemParameters FineTuneArguments::GetFineTuneProblemParameters() cons
     params.fineTuneParameters = GetFineTuneParameters();
     params.sparsifyParameters = GetSparsifyParameters();
     params.reoptimizeParameters = GetReoptimizeParameters();
+    params.factorizeTolerance = factorizeTolerance;
     return params;
 };
 
+ModelOutputDataCacheOptions FineTuneArguments::GetDataCacheOptions() const
+{
+    ModelOutputDataCacheOptions options;
+    options.maxEntries = maxCacheEntries;
+    options.maxMemoryBytes = static_cast<size_t>(maxCacheMemory) << 20;
+    options.spillDirectory = cacheSpillDirectory;
+    options.compressSpilledData = compressCache;
+    return options;
+}
+
 const ell::model::OutputPortBase& FineTuneArguments::GetInputModelTargetOutput() const
 {
     auto model = LoadInputModel();
@@ -232,6 +246,26 @@ void InitArguments(utilities::CommandLineParser& parser, FineTuneArguments& args
 
     parser.AddOption(args.dataFormat, "format", "", "Dataset format (GSDF, CIFAR, MNIST; default: guess)", "");
 
+    parser.AddOption(args.maxCacheEntries,
+                     "maxCacheEntries",
+                     "",
+                     "Maximum number of layer outputs to keep in memory while fine-tuning (0 = no limit)",
+                     8);
+
+    parser.AddOption(args.maxCacheMemory,
+                     "maxCacheMemory",
+                     "",
+                     "Maximum memory in MB for the layer outputs kept while fine-tuning (0 = no limit)",
+                     0);
+
+    parser.AddOption(args.cacheSpillDirectory,
+                     "cacheSpillDirectory",
+                     "",
+                     "Directory for a scratch file that layer outputs evicted from memory are written to, instead of being recomputed (default: discard them)",
+                     "");
+
+    parser.AddOption(args.compressCache, "compressCache", "", "Store layer outputs written to the scratch file as 16-bit floats", false);
+
     parser.AddDocumentationString("");
     parser.AddDocumentationString("Node selection");
     parser.AddOption(args.numPrefixNodesToSkip, "skipStart", "", "Number of nodes in the beginning of the model to skip", 0);
@@ -278,6 +312,8 @@ void InitArguments(utilities::CommandLineParser& parser, FineTuneArguments& args
 
     parser.AddOption(args.optimizeFiltersIndependently, "optimizePerFilter", "", "Re-optimize filters independently", false);
 
+    parser.AddOption(args.numThreads, "numThreads", "", "Number of threads for optimizing spatial convolution filters and independent filters (0 = one per core)", 0);
+
     parser.AddOption(args.reoptimizeSparseWeights, "reoptimizeSparseWeights", "", "Re-optimize sparsified weights", false);
 
     parser.AddOption(args.permute,
@@ -286,6 +322,8 @@ void InitArguments(utilities::CommandLineParser& parser, FineTuneArguments& args
                      "Whether or not to randomly permute the training data before each epoch",
                      true);
 
+    parser.AddOption(args.batchSize, "batchSize", "", "Number of examples whose SDCA updates are computed together, with matrix products (1 = one example at a time)", 1);
+
     parser.AddDocumentationString("");
     parser.AddDocumentationString("Sparsification parameters");
     parser.AddOption(args.fineTuneTargets,
@@ -328,6 +366,10 @@ void InitArguments(utilities::CommandLineParser& parser, FineTuneArguments& args
 
     parser.AddOption(args.sparsifyMethod, "sparsifyMethod", "", "The method to use for sparsifying weights", { { "l1", SparsifyMethod::l1 }, { "threshold", SparsifyMethod::threshold }, { "random", SparsifyMethod::random } }, "l1");
 
+    parser.AddDocumentationString("");
+    parser.AddDocumentationString("Factorization parameters");
+    parser.AddOption(args.factorizeTolerance, "factorizeTolerance", "", "Replace fine-tuned fully-connected layers by a low-rank projection of their input followed by a fine-tuned layer, keeping the projection's relative error on the training data within this tolerance (0 = don't factor layers; ignored if requiredPrecision is set)", 0);
+
     parser.AddDocumentationString("");
     parser.AddDocumentationString("Misc parameters");
     parser.AddOption(args.randomSeed, "randomSeed", "seed", "The random seed string", "ABCDEFG");
@@ -24,6 +24,8 @@
 #include <nodes/include/ConvolutionalLayerNode.h>
 #include <nodes/include/FullyConnectedLayerNode.h>
 
+#include <passes/include/FactorizeFullyConnectedLayersTransformation.h>
+
 #include <utilities/include/Exception.h>
 #include <utilities/include/Files.h>
 #include <utilities/include/MillisecondTimer.h>
@@ -54,6 +56,9 @@ FineTuningLayerResult RetrainFullyConnectedLayer(ModelTransformer& transformer,
 template <typename ElementType>
 FineTuningLayerResult RetrainConvolutionalLayer(ModelTransformer& transformer, const Node& node, FineTuneNodeAction action, MultiClassDataContainer& trainingData, const FineTuneProblemParameters& optimizerParameters, ModelOutputDataCache& dataCache);
 
+template <typename ElementType>
+const OutputPort<ElementType>& AppendFactoredInputLayer(const nodes::FullyConnectedLayerNode<ElementType>& node, const OutputPort<ElementType>& destination, const MultiClassDataContainer& trainingData, double tolerance);
+
 template <typename ElementType>
 const OutputPort<ElementType>& GetFeaturesPort(const UnlabeledDataContainer& imageFeatures, const OutputPort<ElementType>& rawFeatureOutput, bool normalize);
 
@@ -240,7 +245,7 @@ FineTuningResult FineTuneNodesInSubmodel(const Submodel& submodel,
     std::chrono::milliseconds::rep optimizationTime = 0;
     std::vector<FineTuningLayerResult> layerResults;
 
-    ModelOutputDataCache dataCache(args.maxCacheEntries);
+    ModelOutputDataCache dataCache(args.GetDataCacheOptions());
 
     bool didModifyAnyNodes = false;
     auto problemParams = args.GetFineTuneProblemParameters();
@@ -434,13 +439,44 @@ FineTuningLayerResult RetrainFullyConnectedLayer(ModelTransformer& transformer,
     auto fcNode = dynamic_cast<const nodes::FullyConnectedLayerNode<ElementType>*>(&node);
     const auto& fcOutput = fcNode->output;
 
-    const auto& destination = transformer.GetCorrespondingOutputs(fcNode->input.GetReferencedPort());
+    const auto* destination = &transformer.GetCorrespondingOutputs(fcNode->input.GetReferencedPort());
+
+    // A factored layer is a low-rank projection of the input, followed by a layer fine-tuned to map the projection to
+    // the original output (a failed fine-tuning falls back to the original layer, which doesn't fit the projection)
+    if (action == FineTuneNodeAction::finetune && optimizerParameters.factorizeTolerance > 0 && optimizerParameters.fineTuneParameters.requiredPrecision == 0)
+    {
+        destination = &AppendFactoredInputLayer(*fcNode, *destination, trainingData, optimizerParameters.factorizeTolerance);
+    }
+
     FullyConnectedParameters fcParams;
-    auto fineTunedOutput = ApproximateSubmodelWithNewLayer(trainingData, fcParams, fcOutput, destination, action, optimizerParameters, dataCache);
+    auto fineTunedOutput = ApproximateSubmodelWithNewLayer(trainingData, fcParams, fcOutput, *destination, action, optimizerParameters, dataCache);
     transformer.MapNodeOutput(fcOutput, *fineTunedOutput.fineTunedOutput);
     return fineTunedOutput;
 }
 
+template <typename ElementType>
+const OutputPort<ElementType>& AppendFactoredInputLayer(const nodes::FullyConnectedLayerNode<ElementType>& node, const OutputPort<ElementType>& destination, const MultiClassDataContainer& trainingData, double tolerance)
+{
+    // The projection is chosen to keep the error of the original layer's output on the training data within the tolerance
+    std::vector<std::vector<double>> calibrationInputs;
+    for (const auto& input : TransformDataWithModel(GetDatasetInputs(trainingData), destination))
+    {
+        auto values = input.ToArray();
+        calibrationInputs.emplace_back(values.begin(), values.end());
+    }
+
+    math::RowMatrix<ElementType> inputFactor(0, 0);
+    math::RowMatrix<ElementType> outputFactor(0, 0);
+    if (!passes::FactorizeFullyConnectedLayersTransformation::FactorizeWeights(node.GetLayer().GetWeights(), tolerance, calibrationInputs, inputFactor, outputFactor))
+    {
+        return destination;
+    }
+
+    using namespace logging;
+    Log() << "Factoring node " << node.GetId() << " with rank " << inputFactor.NumRows() << EOL;
+    return AppendFullyConnectedLayer(destination, inputFactor.GetConstReference());
+}
+
 template <typename ElementType>
 FineTuningLayerResult RetrainConvolutionalLayer(ModelTransformer& transformer, const Node& node, FineTuneNodeAction action, MultiClassDataContainer& trainingData, const FineTuneProblemParameters& optimizerParameters, ModelOutputDataCache& dataCache)
 {
@@ -1,7 +1,7 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  Project:  Embedded Learning Library (ELL)
-//  File:     ModelOutputDataCache.cpp (utilities)
+//  File:     ModelOutputDataCache.cpp (finetune)
 //  Authors:  Chuck Jacobs
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -11,20 +11,134 @@
 #include <model/include/InputPort.h>
 
 #include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
 #include <utilities/include/Logger.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <sstream>
+
 namespace ell
 {
 using namespace ell::model;
 
+namespace
+{
+    uint16_t FloatToHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        const uint32_t sign = (bits >> 16) & 0x8000u;
+        const int exponent = static_cast<int>((bits >> 23) & 0xff);
+        uint32_t mantissa = bits & 0x7fffffu;
+
+        if (exponent == 0xff) // infinity or NaN
+        {
+            return static_cast<uint16_t>(sign | 0x7c00u | (mantissa != 0 ? 0x200u : 0));
+        }
+
+        const int halfExponent = exponent - 127 + 15;
+        if (halfExponent >= 0x1f) // too large: infinity
+        {
+            return static_cast<uint16_t>(sign | 0x7c00u);
+        }
+
+        if (halfExponent <= 0) // subnormal or zero
+        {
+            if (halfExponent < -10)
+            {
+                return static_cast<uint16_t>(sign);
+            }
+            mantissa |= 0x800000u;
+            const int shift = 14 - halfExponent;
+            uint32_t halfMantissa = mantissa >> shift;
+            const uint32_t remainder = mantissa & ((1u << shift) - 1);
+            const uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (halfMantissa & 1)))
+            {
+                ++halfMantissa;
+            }
+            return static_cast<uint16_t>(sign | halfMantissa);
+        }
+
+        // round to nearest even; a carry out of the mantissa correctly bumps the exponent
+        uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+        const uint32_t remainder = mantissa & 0x1fffu;
+        if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1)))
+        {
+            ++half;
+        }
+        return static_cast<uint16_t>(half);
+    }
+
+    float HalfToFloat(uint16_t half)
+    {
+        const uint32_t sign = (static_cast<uint32_t>(half) & 0x8000u) << 16;
+        const uint32_t exponent = (half >> 10) & 0x1fu;
+        const uint32_t mantissa = half & 0x3ffu;
+
+        uint32_t bits;
+        if (exponent == 0x1f)
+        {
+            bits = sign | 0x7f800000u | (mantissa << 13);
+        }
+        else if (exponent == 0)
+        {
+            const auto value = std::ldexp(static_cast<float>(mantissa), -24);
+            return sign != 0 ? -value : value;
+        }
+        else
+        {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    std::string GetSpillFilename(const std::string& directory)
+    {
+        std::random_device random;
+        std::ostringstream name;
+        name << "finetune_cache_" << std::hex << random() << random() << ".tmp";
+        return utilities::JoinPaths(directory, name.str());
+    }
+} // namespace
+
 ModelOutputDataCache::ModelOutputDataCache() :
-    _maxCacheSize(0)
+    ModelOutputDataCache(ModelOutputDataCacheOptions{})
 {
 }
 
 ModelOutputDataCache::ModelOutputDataCache(int maxCacheSize) :
-    _maxCacheSize(maxCacheSize)
+    ModelOutputDataCache(ModelOutputDataCacheOptions{ maxCacheSize })
+{
+}
+
+ModelOutputDataCache::ModelOutputDataCache(const ModelOutputDataCacheOptions& options) :
+    _options(options)
+{
+    if (!_options.spillDirectory.empty())
+    {
+        utilities::EnsureDirectoryExists(_options.spillDirectory);
+        _spillFilename = GetSpillFilename(_options.spillDirectory);
+        _spillFile = utilities::OpenBinaryOfstream(_spillFilename);
+    }
+}
+
+ModelOutputDataCache::~ModelOutputDataCache()
 {
+    if (!_spillFilename.empty())
+    {
+        _spillFileView.reset();
+        _spillFile.close();
+        std::remove(_spillFilename.c_str());
+    }
 }
 
 bool ModelOutputDataCache::HasCachedData(const ell::model::OutputPortBase* port) const
@@ -32,47 +146,187 @@ bool ModelOutputDataCache::HasCachedData(const ell::model::OutputPortBase* port)
     return _cache.find(port) != _cache.end();
 }
 
+bool ModelOutputDataCache::IsSpilled(const ell::model::OutputPortBase* port) const
+{
+    auto it = _cache.find(port);
+    return it != _cache.end() && !it->second.resident;
+}
+
 const UnlabeledDataContainer& ModelOutputDataCache::GetCachedData(const ell::model::OutputPortBase* port) const
 {
+    auto& entry = _cache.at(port);
     ++_currentGeneration;
-    _cache.at(port).generation = _currentGeneration;
-    return _cache.at(port).data;
+    entry.generation = _currentGeneration;
+    if (!entry.resident)
+    {
+        Restore(entry);
+        // The restored entry is the most recently used one, so it's only evicted if it doesn't fit on its own
+        MakeRoom(0, port);
+    }
+    return entry.data;
 }
 
 void ModelOutputDataCache::RemoveCachedData(const ell::model::OutputPortBase* port)
 {
-    _cache.erase(port);
+    auto it = _cache.find(port);
+    if (it == _cache.end())
+    {
+        return;
+    }
+
+    if (it->second.resident)
+    {
+        _memoryUsage -= GetDataSize(it->second.data);
+    }
+    _cache.erase(it);
 }
 
 void ModelOutputDataCache::SetCachedData(const ell::model::OutputPortBase* port, UnlabeledDataContainer data)
 {
+    RemoveCachedData(port);
+
     // if the cache is too big, first remove entries
-    while (_maxCacheSize > 0 && static_cast<int>(_cache.size()) >= _maxCacheSize)
+    auto size = GetDataSize(data);
+    MakeRoom(size, nullptr);
+
+    auto& entry = _cache[port];
+    entry.generation = ++_currentGeneration;
+    entry.data = std::move(data);
+    _memoryUsage += size;
+}
+
+size_t ModelOutputDataCache::GetDataSize(const UnlabeledDataContainer& data)
+{
+    size_t size = 0;
+    for (const auto& row : data)
     {
-        RemoveLeastRecentlyUsedEntry();
+        size += row.Size() * sizeof(float);
     }
-
-    _cache[port] = { _currentGeneration, data };
+    return size;
 }
 
-void ModelOutputDataCache::RemoveLeastRecentlyUsedEntry()
+void ModelOutputDataCache::MakeRoom(size_t size, const ell::model::OutputPortBase* keep) const
 {
-    using namespace logging;
-    Log() << "Removing least-recently-used entry" << EOL;
-    if (_cache.empty())
+    auto numResidentEntries = [this] {
+        return static_cast<int>(std::count_if(_cache.begin(), _cache.end(), [](const auto& entry) { return entry.second.resident; }));
+    };
+
+    // `keep` is already counted as resident, a new entry isn't
+    const int newEntries = keep == nullptr ? 1 : 0;
+    while ((_options.maxEntries > 0 && numResidentEntries() + newEntries > _options.maxEntries) ||
+           (_options.maxMemoryBytes > 0 && _memoryUsage + size > _options.maxMemoryBytes))
     {
-        return;
+        if (!RemoveLeastRecentlyUsedEntry(keep))
+        {
+            break;
+        }
     }
+}
+
+bool ModelOutputDataCache::RemoveLeastRecentlyUsedEntry(const ell::model::OutputPortBase* keep) const
+{
+    using namespace logging;
 
-    auto lruEntry = _cache.begin();
+    auto lruEntry = _cache.end();
     for (auto it = _cache.begin(); it != _cache.end(); ++it)
     {
-        if (it->second.generation < lruEntry->second.generation)
+        if (it->second.resident && it->first != keep && (lruEntry == _cache.end() || it->second.generation < lruEntry->second.generation))
         {
             lruEntry = it;
         }
     }
-    _cache.erase(lruEntry);
+    if (lruEntry == _cache.end())
+    {
+        return false;
+    }
+
+    _memoryUsage -= GetDataSize(lruEntry->second.data);
+    if (_spillFile.is_open())
+    {
+        Log() << "Spilling least-recently-used entry to disk" << EOL;
+        Spill(lruEntry->second);
+    }
+    else
+    {
+        Log() << "Removing least-recently-used entry" << EOL;
+        _cache.erase(lruEntry);
+    }
+    return true;
+}
+
+void ModelOutputDataCache::Spill(CacheEntry& entry) const
+{
+    // An entry that was read back from the scratch file is still there, unchanged
+    auto& spilled = entry.spilled;
+    if (!spilled.written)
+    {
+        spilled.offset = _spillFileSize;
+        spilled.compressed = _options.compressSpilledData;
+        spilled.rowSizes.clear();
+        std::vector<uint16_t> halfRow;
+        for (const auto& row : entry.data)
+        {
+            spilled.rowSizes.push_back(row.Size());
+            if (spilled.compressed)
+            {
+                halfRow.resize(row.Size());
+                std::transform(row.GetConstDataPointer(), row.GetConstDataPointer() + row.Size(), halfRow.begin(), FloatToHalf);
+                _spillFile.write(reinterpret_cast<const char*>(halfRow.data()), static_cast<std::streamsize>(halfRow.size() * sizeof(uint16_t)));
+                _spillFileSize += halfRow.size() * sizeof(uint16_t);
+            }
+            else
+            {
+                _spillFile.write(reinterpret_cast<const char*>(row.GetConstDataPointer()), static_cast<std::streamsize>(row.Size() * sizeof(float)));
+                _spillFileSize += row.Size() * sizeof(float);
+            }
+        }
+        _spillFile.flush();
+        if (!_spillFile)
+        {
+            throw utilities::SystemException(utilities::SystemExceptionErrors::fileNotWritable, "Couldn't write to the cache scratch file " + _spillFilename);
+        }
+        spilled.written = true;
+    }
+
+    entry.data = {};
+    entry.resident = false;
+}
+
+void ModelOutputDataCache::Restore(CacheEntry& entry) const
+{
+    auto& spilled = entry.spilled;
+    const auto elementSize = spilled.compressed ? sizeof(uint16_t) : sizeof(float);
+    const auto numElements = std::accumulate(spilled.rowSizes.begin(), spilled.rowSizes.end(), size_t{ 0 });
+
+    // The view only covers the file as it was when it was mapped, so map it again once it has grown past an entry
+    if (!_spillFileView || _spillFileView->Size() < spilled.offset + numElements * elementSize)
+    {
+        _spillFileView.reset();
+        _spillFileView = std::make_unique<utilities::MemoryMappedFile>(_spillFilename);
+    }
+
+    auto position = _spillFileView->begin() + spilled.offset;
+    UnlabeledDataContainer data;
+    for (auto rowSize : spilled.rowSizes)
+    {
+        UnlabeledExample row(rowSize);
+        if (spilled.compressed)
+        {
+            std::vector<uint16_t> halfRow(rowSize);
+            std::memcpy(halfRow.data(), position, rowSize * sizeof(uint16_t));
+            std::transform(halfRow.begin(), halfRow.end(), row.GetDataPointer(), HalfToFloat);
+        }
+        else
+        {
+            std::memcpy(row.GetDataPointer(), position, rowSize * sizeof(float));
+        }
+        position += rowSize * elementSize;
+        data.Add(std::move(row));
+    }
+
+    entry.data = std::move(data);
+    entry.resident = true;
+    _memoryUsage += GetDataSize(entry.data);
 }
 
 const OutputPortBase* ModelOutputDataCache::FindNearestCachedOutputPort(const OutputPortBase* output)
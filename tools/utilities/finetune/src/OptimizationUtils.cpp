@@ -1,7 +1,7 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  Project:  Embedded Learning Library (ELL)
-//  File:     OptimizationUtils.cpp (utilities)
+//  File:     OptimizationUtils.cpp (finetune)
 //  Authors:  Byron Changuion, Chuck Jacobs
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -13,8 +13,11 @@
 
 #include <utilities/include/Exception.h>
 #include <utilities/include/Logger.h>
+#include <utilities/include/ParallelFor.h>
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 namespace ell
 {
@@ -26,6 +29,52 @@ using namespace ell::logging;
 #define BEGIN_FROM_STRING if (false)
 #define ADD_FROM_STRING_ENTRY(NAMESPACE, OPERATOR) else if (name == #OPERATOR) return NAMESPACE::OPERATOR
 
+namespace
+{
+    // Splits a problem from N rows of k*k*d -> d' into d' problems with one output each, solves them on a pool of
+    // threads with `optimize(channel, channelDataset)`, and gathers their solutions into one.
+    template <typename OptimizeFunctionType>
+    VectorOptimizerResult OptimizeChannelsIndependently(const VectorLabelDataContainer& dataset, const FineTuneOptimizationParameters& optimizerParameters, bool isSpatialConvolution, OptimizeFunctionType optimize)
+    {
+        auto in0 = math::RowVector<float>(dataset.Get(0).input);
+        const auto& out0 = dataset.Get(0).output;
+        const auto outputChannels = out0.Size(); // # output (and input) channels
+        const auto filterSizeSq = in0.Size() / outputChannels;
+
+        // In the case of spatial convolutions, for each output channel, we are just recovering
+        // a k x k spatial filter.
+        if (isSpatialConvolution)
+        {
+            in0.Resize(filterSizeSq); // # spatial elements in a filter (e.g., 9 for a 3x3 filter)
+        }
+
+        // TODO: in both the "independent channel" and "spatial filter" cases, we really are optimizing to find a scalar result.
+        VectorLabelSolution resultSolution;
+        resultSolution.Resize(in0, out0);
+
+        Log() << "Optimizing " << outputChannels << " output channels independently\n";
+
+        // Channels are handed out one at a time, because some problems take many more epochs to converge than others
+        std::vector<SolutionInfo> channelInfo(outputChannels);
+        auto numThreads = static_cast<size_t>(std::max(optimizerParameters.numThreads, 0));
+        utilities::ParallelForDynamic(outputChannels, numThreads, [&](size_t i) {
+            // For each output channel, create a tiny dataset that goes from the pixels under a filter support -> output value
+            auto channelDataset = isSpatialConvolution ? CreateSubBlockVectorLabelDataContainer(dataset, filterSizeSq, 1, i) : CreateSingleOutputVectorLabelDataContainer(dataset, i);
+            auto channelResult = optimize(i, std::move(channelDataset));
+
+            // Each channel writes its own column
+            resultSolution.GetBias()[i] = channelResult.predictor.GetBias()[0];
+            resultSolution.GetMatrix().GetColumn(i).CopyFrom(channelResult.predictor.GetMatrix().GetColumn(0));
+            channelInfo[i] = channelResult.info;
+        });
+
+        // For now, just keep the last solution info result.
+        // TODO: in the "trainFiltersIndependently" case, we should
+        // keep some kind of summary thing instead.
+        return { resultSolution, channelInfo.back(), {} };
+    }
+} // namespace
+
 std::string ToString(LossFunction loss)
 {
     switch (loss)
@@ -106,61 +155,14 @@ VectorOptimizerResult TrainVectorPredictor(VectorLabelDataContainer dataset,
         // Dataset: N rows from k*k*d -> d'
         return TrainVectorPredictor(dataset, optimizerParameters);
     }
-    // else
-    // {
-    //     return TrainIndependentPredictors(dataset, optimizerParameters, isSpatialConvolution);
-    // }
-
-    // optimize spatial convolutions one-at-a-time
-    FineTuneOptimizationParameters spatialParameters = optimizerParameters;
-
-    // The input dataset consists of N rows from k*k*d -> d'.
-    // We need to split it into d' datasets from k*k*d -> 1.
-    auto in0 = math::RowVector<float>(dataset.Get(0).input);
-    const auto& out0 = dataset.Get(0).output;
-    const auto outputChannels = out0.Size(); // # output (and input) channels
-    const auto filterSizeSq = in0.Size() / outputChannels;
-
-    // In the case of spatial convolutions, for each output channel, we are just recovering
-    // a k x k spatial filter.
-    if (isSpatialConvolution)
-    {
-        in0.Resize(filterSizeSq); // # spatial elements in a filter (e.g., 9 for a 3x3 filter)
-    }
-
-    // TODO: in both the "independent channel" and "spatial filter" cases, we really are optimizing to find a scalar result.
-    VectorLabelSolution resultSolution;
-    resultSolution.Resize(in0, out0);
-
-    Log() << "Optimizing " << outputChannels << " output channels independently\n";
-
-    SolutionInfo solutionInfo;
-    for (size_t i = 0; i < outputChannels; ++i)
-    {
-        // For each output channel, create a tiny dataset that goes from the pixels under a filter support -> output value
-        VectorLabelDataContainer channelDataset;
-
-        if (isSpatialConvolution)
-        {
-            channelDataset = CreateSubBlockVectorLabelDataContainer(dataset, filterSizeSq, 1, i);
-        }
-        else
-        {
-            channelDataset = CreateSingleOutputVectorLabelDataContainer(dataset, i);
-        }
-
-        auto channelResult = TrainVectorPredictor(channelDataset, spatialParameters);
-
-        resultSolution.GetBias()[i] = channelResult.predictor.GetBias()[0];
-        resultSolution.GetMatrix().GetColumn(i).CopyFrom(channelResult.predictor.GetMatrix().GetColumn(0));
-
-        // For now, just keep the last solution info result.
-        // TODO: in the "trainFiltersIndependently" case, we should
-        // keep some kind of summary thing instead.
-        solutionInfo = channelResult.info;
-    }
 
-    return { resultSolution, solutionInfo, {} };
+    // optimize spatial convolutions one-at-a-time (the channels already use the threads, so the sparse solution
+    // search of each channel probes one value at a time)
+    auto channelParameters = optimizerParameters;
+    channelParameters.numThreads = 1;
+    return OptimizeChannelsIndependently(dataset, optimizerParameters, isSpatialConvolution, [&channelParameters](size_t, VectorLabelDataContainer channelDataset) {
+        return TrainVectorPredictor(std::move(channelDataset), channelParameters);
+    });
 }
 
 VectorOptimizerResult TrainVectorPredictor(VectorLabelDataContainer dataset, const FineTuneOptimizationParameters& optimizerParameters)
@@ -205,11 +207,25 @@ VectorOptimizerResult ReoptimizeSparsePredictor(VectorOptimizerResult& sparseSol
                                                 const FineTuneOptimizationParameters& optimizerParameters,
                                                 bool isSpatialConvolution)
 {
-    if (isSpatialConvolution || optimizerParameters.optimizeFiltersIndependently)
+    if (!isSpatialConvolution && !optimizerParameters.optimizeFiltersIndependently)
     {
-        throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Can't reoptimize spatial or independent-channel solutions");
+        return ReoptimizeSparsePredictor(sparseSolution, std::move(dataset), optimizerParameters);
     }
 
+    // Reoptimize each output channel's column of the sparse solution against that channel's dataset
+    return OptimizeChannelsIndependently(dataset, optimizerParameters, isSpatialConvolution, [&sparseSolution, &optimizerParameters](size_t channel, VectorLabelDataContainer channelDataset) {
+        VectorOptimizerResult channelSolution{ {}, sparseSolution.info, {} };
+        channelSolution.predictor.Resize(channelDataset.Get(0).input, channelDataset.Get(0).output);
+        channelSolution.predictor.GetBias()[0] = sparseSolution.predictor.GetBias()[channel];
+        channelSolution.predictor.GetMatrix().GetColumn(0).CopyFrom(sparseSolution.predictor.GetMatrix().GetColumn(channel));
+        return ReoptimizeSparsePredictor(channelSolution, std::move(channelDataset), optimizerParameters);
+    });
+}
+
+VectorOptimizerResult ReoptimizeSparsePredictor(VectorOptimizerResult& sparseSolution,
+                                                VectorLabelDataContainer dataset,
+                                                const FineTuneOptimizationParameters& optimizerParameters)
+{
     using SolutionType = VectorPredictor;
     auto examples = std::make_shared<VectorLabelDataContainer>(std::move(dataset));
 
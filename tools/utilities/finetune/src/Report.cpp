@@ -60,6 +60,10 @@ void Report::WriteParameters(const FineTuneArguments& args)
     WriteKeyValue("NormalizeInputs", args.normalizeInputs);
     WriteKeyValue("NormalizeOutputs", args.normalizeOutputs);
     WriteKeyValue("ReoptimizeWeights", args.reoptimizeSparseWeights);
+    if (args.factorizeTolerance > 0)
+    {
+        WriteKeyValue("FactorizeTolerance", args.factorizeTolerance);
+    }
     WriteKeyValue("FineTuneFullyConnectedLayers", args.fineTuneFullyConnectedNodes);
     WriteKeyValue("FineTuneConvolutionalLayers", args.fineTuneConvolutionalNodes);
     WriteKeyValue("TrainFiltersIndependently", args.optimizeFiltersIndependently);
@@ -14,4 +14,5 @@ void TestModelOutputDataCache();
 // Individual tests
 void TestModelOutputDataCache_CreateAndPopulate();
 void TestModelOutputDataCache_FindNearestCachedOutput();
+void TestModelOutputDataCache_SpillToDisk(bool compress);
 void TestModelOutputDataCache_TransformWithCache();
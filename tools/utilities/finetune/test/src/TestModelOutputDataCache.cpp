@@ -20,6 +20,7 @@
 #include <testing/include/testing.h>
 
 #include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
 
 // stl
 #include <algorithm>
@@ -87,6 +88,8 @@ void TestModelOutputDataCache()
 {
     FailOnException(TestModelOutputDataCache_CreateAndPopulate);
     FailOnException(TestModelOutputDataCache_FindNearestCachedOutput);
+    FailOnException(TestModelOutputDataCache_SpillToDisk, false);
+    FailOnException(TestModelOutputDataCache_SpillToDisk, true);
 }
 
 void TestModelOutputDataCache_CreateAndPopulate()
@@ -143,3 +146,37 @@ void TestModelOutputDataCache_FindNearestCachedOutput()
 
     ProcessTest("Testing FindNearestCachedOutput", cache.FindNearestCachedOutputPort(outputPorts[3]) == outputPorts[1]);
 }
+
+void TestModelOutputDataCache_SpillToDisk(bool compress)
+{
+    auto model = GetLinearTestModel();
+    auto data = GetTestDataset();
+    auto outputPorts = GetModelOutputPorts(model);
+    const size_t entrySize = data.Size() * data[0].Size() * sizeof(float);
+    const std::string prefix = compress ? "Testing compressed spilling: " : "Testing spilling: ";
+
+    // room for two entries
+    ModelOutputDataCacheOptions options;
+    options.maxMemoryBytes = 2 * entrySize + entrySize / 2;
+    options.spillDirectory = utilities::JoinPaths(utilities::GetWorkingDirectory(), "finetune_cache_test");
+    options.compressSpilledData = compress;
+    ModelOutputDataCache cache(options);
+
+    cache.SetCachedData(outputPorts[0], data);
+    cache.SetCachedData(outputPorts[1], data);
+    cache.SetCachedData(outputPorts[2], data);
+    ProcessTest(prefix + "memory budget", cache.GetMemoryUsage() == 2 * entrySize);
+    ProcessTest(prefix + "least-recently-used entry is spilled", cache.IsSpilled(outputPorts[0]) && !cache.IsSpilled(outputPorts[1]) && !cache.IsSpilled(outputPorts[2]));
+    ProcessTest(prefix + "spilled entry is still cached", cache.HasCachedData(outputPorts[0]));
+
+    // the test data is made of small integers, which 16-bit floats hold exactly
+    const auto& restored = cache.GetCachedData(outputPorts[0]);
+    ProcessTest(prefix + "restored entry", restored.Size() == data.Size() && std::equal(restored.begin(), restored.end(), data.begin()));
+    ProcessTest(prefix + "restoring spills the next entry", !cache.IsSpilled(outputPorts[0]) && cache.IsSpilled(outputPorts[1]) && cache.GetMemoryUsage() == 2 * entrySize);
+
+    const auto& restoredAgain = cache.GetCachedData(outputPorts[1]);
+    ProcessTest(prefix + "entry restored after the file grew", std::equal(restoredAgain.begin(), restoredAgain.end(), data.begin()));
+
+    cache.RemoveCachedData(outputPorts[0]);
+    ProcessTest(prefix + "memory usage after removing an entry", cache.GetMemoryUsage() == entrySize);
+}
@@ -8,6 +8,9 @@
 
 #include "TestOptimizationUtils.h"
 
+#include "DataUtils.h"
+#include "OptimizationUtils.h"
+
 #include <math/include/Matrix.h>
 
 #include <testing/include/testing.h>
@@ -16,6 +19,7 @@
 #include <utilities/include/RandomEngines.h>
 
 #include <algorithm>
+#include <cmath>
 #include <random>
 #include <string>
 #include <vector>
@@ -23,9 +27,83 @@
 using namespace ell;
 using namespace ell::testing;
 
+namespace
+{
+VectorLabelDataContainer GetIndependentChannelsDataset(size_t numInputs, size_t numOutputs, size_t numRows)
+{
+    std::default_random_engine engine(1234);
+    std::normal_distribution<float> normal(0, 1);
+
+    UnlabeledDataContainer features;
+    UnlabeledDataContainer labels;
+    for (size_t row = 0; row < numRows; ++row)
+    {
+        std::vector<float> input(numInputs);
+        std::generate(input.begin(), input.end(), [&] { return normal(engine); });
+        std::vector<float> output(numOutputs);
+        for (size_t i = 0; i < numOutputs; ++i)
+        {
+            // each output depends on its own 2 inputs
+            output[i] = input[(2 * i) % numInputs] - 0.5f * input[(2 * i + 1) % numInputs];
+        }
+        features.Add({ input });
+        labels.Add({ output });
+    }
+    return CreateVectorLabelDataContainer(features, labels);
+}
+
+FineTuneOptimizationParameters GetIndependentChannelsParameters(int numThreads)
+{
+    FineTuneOptimizationParameters parameters;
+    parameters.optimizerParameters.regularizationParameter = 0.001;
+    parameters.maxEpochs = 10;
+    parameters.desiredPrecision = 1e-6;
+    parameters.optimizeFiltersIndependently = true;
+    parameters.numThreads = numThreads;
+    parameters.randomSeed = "123";
+    return parameters;
+}
+
+void TestOptimizeChannelsIndependently()
+{
+    auto dataset = GetIndependentChannelsDataset(8, 4, 64);
+
+    auto serialResult = TrainVectorPredictor(dataset, GetIndependentChannelsParameters(1), false);
+    auto parallelResult = TrainVectorPredictor(dataset, GetIndependentChannelsParameters(4), false);
+    ProcessTest("Testing that optimizing output channels on several threads matches optimizing them on one thread",
+                serialResult.predictor.GetMatrix() == parallelResult.predictor.GetMatrix() &&
+                    serialResult.predictor.GetBias() == parallelResult.predictor.GetBias());
+
+    // zero out the weights of the inputs each output doesn't depend on, and reoptimize the rest
+    auto sparseResult = parallelResult;
+    auto weights = sparseResult.predictor.GetMatrix();
+    for (size_t i = 0; i < weights.NumRows(); ++i)
+    {
+        for (size_t j = 0; j < weights.NumColumns(); ++j)
+        {
+            if (i / 2 != j)
+            {
+                weights(i, j) = 0;
+            }
+        }
+    }
+    auto reoptimizedResult = ReoptimizeSparsePredictor(sparseResult, dataset, GetIndependentChannelsParameters(4), false);
+    const auto& reoptimizedWeights = reoptimizedResult.predictor.GetMatrix();
+    bool keptZeros = true;
+    for (size_t i = 0; i < reoptimizedWeights.NumRows(); ++i)
+    {
+        for (size_t j = 0; j < reoptimizedWeights.NumColumns(); ++j)
+        {
+            keptZeros = keptZeros && ((i / 2 == j) || reoptimizedWeights(i, j) == 0);
+        }
+    }
+    ProcessTest("Testing reoptimizing independent output channels keeps their zero weights", keptZeros);
+    ProcessTest("Testing reoptimizing independent output channels recovers their weights",
+                std::abs(reoptimizedWeights(0, 0) - 1.0f) < 0.05f && std::abs(reoptimizedWeights(1, 0) + 0.5f) < 0.05f);
+}
+} // namespace
+
 void TestOptimizationUtils()
 {
-    NoFailOnUnimplemented([]() {
-        throw TestNotImplementedException("TestOptimizationUtils");
-    });
+    FailOnException(TestOptimizeChannelsIndependently);
 }
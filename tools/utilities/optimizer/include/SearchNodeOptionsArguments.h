@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SearchNodeOptionsArguments.h (optimizer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/optimizer/include/NodeOptionsSearch.h>
+
+#include <utilities/include/CommandLineParser.h>
+
+#include <string>
+#include <vector>
+
+namespace ell
+{
+/// <summary> Arguments for searchNodeOptions. </summary>
+struct SearchNodeOptionsArguments
+{
+    std::string outputMapFilename;
+    std::string costDatabaseFilename;
+    std::string searchOptions;
+    int numProfileRuns;
+
+    /// <summary> The options to search: the ones given by `searchOptions`, or the default ones. </summary>
+    std::vector<model::optimizer::SearchOption> options;
+};
+
+/// <summary> Parsed arguments for searchNodeOptions. </summary>
+struct ParsedSearchNodeOptionsArguments : public SearchNodeOptionsArguments
+    , public utilities::ParsedArgSet
+{
+    /// <summary> Adds the arguments. </summary>
+    ///
+    /// <param name="parser"> [in,out] The parser. </param>
+    void AddArgs(utilities::CommandLineParser& parser) override;
+
+    /// <summary> Check arguments. </summary>
+    ///
+    /// <param name="parser"> The parser. </param>
+    ///
+    /// <returns> An utilities::CommandLineParseResult. </returns>
+    utilities::CommandLineParseResult PostProcess(const utilities::CommandLineParser& parser) override;
+};
+} // namespace ell
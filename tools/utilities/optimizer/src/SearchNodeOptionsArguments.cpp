@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     SearchNodeOptionsArguments.cpp (optimizer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SearchNodeOptionsArguments.h"
+
+#include <utilities/include/StringUtil.h>
+
+namespace ell
+{
+void ParsedSearchNodeOptionsArguments::AddArgs(utilities::CommandLineParser& parser)
+{
+    parser.AddOption(outputMapFilename, "outputMapFilename", "omf", "Path to write the map with the chosen node options to", "");
+    parser.AddOption(costDatabaseFilename, "costDatabase", "db", "Path to a cost database to reuse measurements from and add new ones to", "");
+    parser.AddOption(searchOptions,
+                     "searchOptions",
+                     "so",
+                     "Options to search, in the order they're chosen, e.g. \"parallelize=false,true;preferredConvolutionMethod=simple,unrolled@ConvolutionalLayerNode\" "
+                     "(an option after '@' is only set on nodes whose type starts with the given name; empty searches the default options)",
+                     "");
+    parser.AddOption(numProfileRuns, "profileRuns", "pr", "Number of times to run the map for each candidate", 10);
+}
+
+utilities::CommandLineParseResult ParsedSearchNodeOptionsArguments::PostProcess(const utilities::CommandLineParser& parser)
+{
+    std::vector<std::string> parseErrorMessages;
+    if (outputMapFilename.empty())
+    {
+        parseErrorMessages.push_back("An output map filename is required");
+    }
+    if (numProfileRuns < 1)
+    {
+        parseErrorMessages.push_back("The number of profile runs must be positive");
+    }
+
+    options.clear();
+    for (const auto& optionSpec : utilities::Split(searchOptions, ';'))
+    {
+        if (optionSpec.empty())
+        {
+            continue;
+        }
+
+        auto nameAndValues = utilities::Split(optionSpec, '=');
+        if (nameAndValues.size() != 2 || nameAndValues[0].empty())
+        {
+            parseErrorMessages.push_back("Bad search option: " + optionSpec);
+            continue;
+        }
+
+        model::optimizer::SearchOption option;
+        option.name = nameAndValues[0];
+        auto valuesAndPrefix = utilities::Split(nameAndValues[1], '@');
+        if (valuesAndPrefix.size() == 2)
+        {
+            option.nodeTypePrefix = valuesAndPrefix[1];
+        }
+        for (const auto& value : utilities::Split(valuesAndPrefix[0], ','))
+        {
+            if (!value.empty())
+            {
+                option.values.push_back(value);
+            }
+        }
+        if (option.values.empty() || valuesAndPrefix.size() > 2)
+        {
+            parseErrorMessages.push_back("Bad search option: " + optionSpec);
+            continue;
+        }
+        options.push_back(option);
+    }
+
+    if (options.empty())
+    {
+        options = model::optimizer::GetDefaultSearchOptions();
+    }
+    return parseErrorMessages;
+}
+} // namespace ell
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     main.cpp (optimizer)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "SearchNodeOptionsArguments.h"
+
+#include <common/include/LoadModel.h>
+#include <common/include/MapCompilerArguments.h>
+#include <common/include/MapLoadArguments.h>
+
+#include <model/include/Map.h>
+
+#include <model/optimizer/include/CostDatabase.h>
+#include <model/optimizer/include/NodeOptionsSearch.h>
+
+#include <utilities/include/CommandLineParser.h>
+#include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace ell;
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // create a command line parser
+        utilities::CommandLineParser commandLineParser(argc, argv);
+
+        // add arguments to the command line parser
+        common::ParsedMapLoadArguments mapLoadArguments;
+        ParsedSearchNodeOptionsArguments searchArguments;
+        common::ParsedMapCompilerArguments mapCompilerArguments;
+
+        commandLineParser.AddDocumentationString("Chooses the compiler options of each node of a map by compiling and timing it on this machine");
+        commandLineParser.AddOptionSet(mapLoadArguments);
+        commandLineParser.AddOptionSet(searchArguments);
+        commandLineParser.AddDocumentationString("");
+        commandLineParser.AddDocumentationString("Compile options the candidates share");
+        commandLineParser.AddOptionSet(mapCompilerArguments);
+
+        commandLineParser.Parse();
+
+        auto map = common::LoadMap(mapLoadArguments);
+        auto settings = mapCompilerArguments.GetMapCompilerOptions("model");
+        auto optimizerOptions = mapCompilerArguments.GetModelOptimizerOptions();
+
+        // Measurements from earlier runs are reused, so only nodes that haven't been timed with a candidate's
+        // options cause it to be compiled and run
+        model::optimizer::CostDatabase database;
+        const auto& databaseFilename = searchArguments.costDatabaseFilename;
+        if (!databaseFilename.empty() && utilities::FileExists(databaseFilename))
+        {
+            auto stream = utilities::OpenIfstream(databaseFilename);
+            database.ReadNodeMeasurements(stream);
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        model::optimizer::NodeOptionsSearch search(searchArguments.options, database, searchArguments.numProfileRuns);
+        auto choices = search.FindNodeOptions(map, settings, optimizerOptions);
+        auto elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        if (!databaseFilename.empty())
+        {
+            auto stream = utilities::OpenOfstream(databaseFilename);
+            database.WriteNodeMeasurements(stream);
+        }
+
+        for (const auto& nodeChoices : choices)
+        {
+            std::cout << "Node " << nodeChoices.first << ":";
+            for (const auto& option : nodeChoices.second)
+            {
+                std::cout << " " << option.first << "=" << option.second;
+            }
+            std::cout << std::endl;
+        }
+        std::cout << "Chose options for " << choices.size() << " nodes in " << elapsedSeconds << " s" << std::endl;
+
+        model::optimizer::SetNodeOptions(map.GetModel(), choices);
+        common::SaveMap(map, searchArguments.outputMapFilename);
+    }
+    catch (const utilities::CommandLineParserPrintHelpException& exception)
+    {
+        std::cout << exception.GetHelpText() << std::endl;
+        return 0;
+    }
+    catch (const utilities::CommandLineParserErrorException& exception)
+    {
+        std::cerr << "Command line parse error:" << std::endl;
+        for (const auto& error : exception.GetParseErrors())
+        {
+            std::cerr << error.GetMessage() << std::endl;
+        }
+        return 1;
+    }
+    catch (const utilities::Exception& exception)
+    {
+        std::cerr << "exception: " << exception.GetMessage() << std::endl;
+        return 1;
+    }
+    catch (std::exception& exception)
+    {
+        std::cerr << "unknown error: " << exception.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BenchmarkScorecard.h (profile)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ell
+{
+/// <summary> The measurements of one model of the benchmark zoo, compiled with one set of options. </summary>
+struct BenchmarkResult
+{
+    std::string model;
+    std::string options;
+
+    double compileTime = 0; // milliseconds
+    double p50 = 0; // latency percentiles of a single prediction, in milliseconds
+    double p90 = 0;
+    double p99 = 0;
+    double maxTime = 0;
+    double meanTime = 0;
+    double throughput = 0; // predictions per second
+
+    size_t codeBytes = 0;
+    size_t weightBytes = 0;
+    size_t bufferBytes = 0; // after memory planning
+    size_t stackBytes = 0;
+};
+
+/// <summary> The results of a run of the benchmark suite. </summary>
+struct BenchmarkScorecard
+{
+    std::string comment;
+    std::string target;
+    int numIterations = 0;
+    int numBurnInIterations = 0;
+    std::vector<BenchmarkResult> results;
+};
+
+/// <summary> Gets the latency percentiles of a set of times, as `testing::GetPercentile` computes them. </summary>
+///
+/// <param name="times"> The time of each prediction, in milliseconds. </param>
+/// <param name="result"> The result to fill in the percentiles, maximum, mean and throughput of. </param>
+void SetLatencyStatistics(std::vector<double> times, BenchmarkResult& result);
+
+/// <summary> Writes a scorecard as JSON, with the utilities JSON archiver. </summary>
+void WriteBenchmarkScorecard(const BenchmarkScorecard& scorecard, std::ostream& out);
+
+/// <summary> Reads a scorecard written by `WriteBenchmarkScorecard`. Throws an `InputException` if it is malformed. </summary>
+BenchmarkScorecard ReadBenchmarkScorecard(std::istream& in);
+
+/// <summary>
+/// Writes a table of the changes from one scorecard to another, for the models and option sets in both, and returns
+/// the number of regressions: results whose memory grew by more than the threshold, or whose median latency
+/// regressed by `testing::CompareBenchmarkResults` with the threshold as its tolerance.
+/// </summary>
+///
+/// <param name="baseline"> The scorecard to compare to. </param>
+/// <param name="current"> The scorecard to compare. </param>
+/// <param name="threshold"> The relative growth that counts as a regression, like 0.1 for 10 percent. </param>
+/// <param name="out"> The stream to write the table to. </param>
+int CompareBenchmarkScorecards(const BenchmarkScorecard& baseline, const BenchmarkScorecard& current, double threshold, std::ostream& out);
+} // namespace ell
@@ -12,6 +12,10 @@
 
 #include <model/include/Map.h>
 
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace ell
 {
 model::Map GenerateTreeModel(size_t numSplits);
@@ -21,4 +25,14 @@ model::Map GenerateBinaryConvolutionModel(size_t imageRows, size_t imageColumns,
 model::Map GenerateBinaryConvolutionPlusDenseModel(size_t imageRows, size_t imageColumns, size_t numChannels, size_t numFilters, size_t numOutputs);
 model::Map GenerateBinaryDarknetLikeModel(bool lastLayerReal = false);
 model::Map GenerateConvolutionModel(int inputRows, int inputColumns, int numChannels, int numFilters, int filterSize, int stride, dsp::ConvolutionMethodOption convolutionMethod);
+
+// The benchmark model zoo. Every model is generated from a fixed random seed, so each run of the benchmark measures the same models.
+model::Map GenerateSmallCNNModel();
+model::Map GenerateMobileNetBlocksModel();
+model::Map GenerateLSTMSpeechModel();
+model::Map GenerateProtoNNModel();
+
+// Gets the models of the zoo, by name: a small CNN, a stack of MobileNet-style depthwise-separable blocks, an LSTM
+// keyword-spotting model, a decision forest, and a ProtoNN classifier
+std::vector<std::pair<std::string, model::Map>> GenerateModelZoo();
 } // namespace ell
@@ -22,6 +22,7 @@ struct ProfileArguments
     std::string inputConverter;
     std::string outputFilename;
     std::string timingOutputFilename;
+    std::string traceOutputFilename;
     ProfileOutputFormat outputFormat = ProfileOutputFormat::text;
     std::string outputComment;
 
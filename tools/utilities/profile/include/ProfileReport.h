@@ -8,8 +8,58 @@
 
 #pragma once
 
-#ifdef COMPILED_ELL_PROFILER
+#if defined(COMPILED_ELL_PROFILER)
 #include "compiled_model.h"
+#elif defined(ELL_BENCHMARK_SERVER)
+
+#include <cstdint>
+
+// The benchmark server loads compiled models at runtime, so it declares the profiling structs they return itself
+struct ELL_ProfileRegionInfo
+{
+    int64_t count;
+    double totalTime;
+    const char* name;
+    int64_t cycles;
+    int64_t instructions;
+    int64_t l1DataCacheMisses;
+    int64_t lastLevelCacheMisses;
+    int64_t branchMisses;
+};
+
+struct ELL_NodeInfo
+{
+    const char* nodeName;
+    const char* nodeType;
+    const char* nodeAncestor;
+    int64_t operationCount;
+    int64_t bytesRead;
+    int64_t bytesWritten;
+};
+
+struct ELL_PerformanceCounters
+{
+    int count;
+    double totalTime;
+    double totalOperations;
+    double totalBytesRead;
+    double totalBytesWritten;
+    int64_t cycles;
+    int64_t instructions;
+    int64_t l1DataCacheMisses;
+    int64_t lastLevelCacheMisses;
+    int64_t branchMisses;
+};
+
+struct ELL_LatencyStatistics
+{
+    int64_t count;
+    double p50;
+    double p90;
+    double p99;
+    double maxTime;
+};
+
 #else
 
 #include <model/include/IRModelProfiler.h>
@@ -19,8 +69,9 @@
 using ELL_ProfileRegionInfo = ell::emitters::ProfileRegionInfo;
 using ELL_NodeInfo = ell::model::NodeInfo;
 using ELL_PerformanceCounters = ell::model::PerformanceCounters;
+using ELL_LatencyStatistics = ell::model::LatencyStatistics;
 
-#endif // COMPILED_ELL_PROFILER
+#endif // COMPILED_ELL_PROFILER, ELL_BENCHMARK_SERVER
 
 #include <iomanip>
 #include <ostream>
@@ -40,6 +91,15 @@ enum class ProfileOutputFormat
 std::string EncodeJSONString(const std::string& str);
 
 void WriteUserComment(const std::string& comment, ProfileOutputFormat format, std::ostream& out);
+
+// Writes where the model's buffers and weights were placed in memory, so runs with and without huge pages or first-touch placement can be told apart
+void WriteMemoryPlacement(bool useHugePages, bool hugePageWeights, bool firstTouchBuffers, ProfileOutputFormat format, std::ostream& out);
 void WriteModelStatistics(const ELL_PerformanceCounters* modelStats, ProfileOutputFormat format, std::ostream& out);
 void WriteNodeStatistics(std::vector<std::pair<ELL_NodeInfo, ELL_PerformanceCounters>>& nodeInfo, std::vector<std::pair<ELL_NodeInfo, ELL_PerformanceCounters>>& nodeTypeInfo, ProfileOutputFormat format, std::ostream& out);
 void WriteRegionStatistics(std::vector<ELL_ProfileRegionInfo>& regions, ProfileOutputFormat format, std::ostream& out);
+
+// Writes the latency percentiles of the model and its nodes. The text report leaves them out if the model kept no latency histograms.
+void WriteLatencyStatistics(const ELL_LatencyStatistics* modelLatency, std::vector<std::pair<ELL_NodeInfo, ELL_LatencyStatistics>>& nodeLatency, ProfileOutputFormat format, std::ostream& out);
+
+// Writes statistics of the wall-clock time per prediction, given the time of each timed iteration of `batchSize` predictions
+void WriteTimingStatistics(const std::vector<double>& iterationTimes, int batchSize, ProfileOutputFormat format, std::ostream& out);
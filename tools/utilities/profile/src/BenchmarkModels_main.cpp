@@ -0,0 +1,281 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BenchmarkModels_main.cpp (profile)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A standard benchmark suite: compiles each model of a fixed zoo with a fixed set of compiler options, measures its
+// latency, throughput and memory, and writes a scorecard that later runs can be compared to.
+
+#include "BenchmarkScorecard.h"
+#include "GenerateTestModels.h"
+
+#include <emitters/include/TargetDevice.h>
+
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/Map.h>
+
+#include <passes/include/StandardTransformations.h>
+
+#include <utilities/include/CommandLineParser.h>
+#include <utilities/include/Exception.h>
+#include <utilities/include/Files.h>
+#include <utilities/include/OutputStreamImpostor.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ell;
+
+namespace
+{
+struct BenchmarkArguments
+{
+    std::string outputFilename;
+    std::string comment;
+    std::string models;
+    std::string baselineFilename;
+    std::string compareFilename;
+    double regressionThreshold = 10;
+    int numIterations = 100;
+    int numBurnInIterations = 10;
+};
+
+struct ParsedBenchmarkArguments : public BenchmarkArguments
+    , public utilities::ParsedArgSet
+{
+    void AddArgs(utilities::CommandLineParser& parser) override
+    {
+        parser.AddOption(outputFilename, "outputFilename", "of", "File for the scorecard ('<cout>' for stdout, blank or '<null>' for no output)", "<cout>");
+        parser.AddOption(comment, "comment", "", "Comment to embed in the scorecard", "");
+        parser.AddOption(models, "models", "", "Comma-separated names of the models to benchmark (blank for all of them)", "");
+        parser.AddOption(numIterations, "numIterations", "n", "Number of timed predictions of each model", 100);
+        parser.AddOption(numBurnInIterations, "burnIn", "", "Number of predictions to run before timing them", 10);
+        parser.AddOption(baselineFilename, "baseline", "", "A scorecard to compare the results to", "");
+        parser.AddOption(compareFilename, "compare", "", "A scorecard to compare to the baseline, instead of running the benchmark", "");
+        parser.AddOption(regressionThreshold, "regressionThreshold", "", "The percent growth of the median latency or the memory of a result, compared to the baseline, that counts as a regression", 10.0);
+    }
+};
+
+// The option sets every model is compiled with
+std::vector<std::pair<std::string, std::function<void(model::MapCompilerOptions&)>>> GetOptionSets()
+{
+    return {
+        { "default", [](model::MapCompilerOptions&) {} },
+        { "noOptimize", [](model::MapCompilerOptions& options) { options.compilerSettings.optimize = false; } },
+        { "planMemory", [](model::MapCompilerOptions& options) { options.planMemory = true; } },
+        { "vectorize", [](model::MapCompilerOptions& options) {
+             options.compilerSettings.allowVectorInstructions = true;
+             options.compilerSettings.vectorWidth = 8;
+             options.compilerSettings.fastMathAccuracy = emitters::FastMathAccuracy::low;
+         } },
+    };
+}
+
+utilities::OutputStreamImpostor GetOutputStream(const std::string& filename)
+{
+    if (filename == "" || filename == "<null>")
+    {
+        return { utilities::OutputStreamImpostor::StreamType::null };
+    }
+    if (filename == "<cout>")
+    {
+        return { utilities::OutputStreamImpostor::StreamType::cout };
+    }
+    return { filename };
+}
+
+BenchmarkScorecard ReadScorecard(const std::string& filename)
+{
+    auto stream = utilities::OpenIfstream(filename);
+    return ReadBenchmarkScorecard(stream);
+}
+
+bool ShouldBenchmark(const std::string& modelName, const std::string& models)
+{
+    if (models.empty())
+    {
+        return true;
+    }
+    std::stringstream names(models);
+    std::string name;
+    while (std::getline(names, name, ','))
+    {
+        if (name == modelName)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename InputType, typename OutputType>
+std::vector<double> TimePredictions(model::IRCompiledMap& compiledMap, const BenchmarkArguments& arguments)
+{
+    // Always the same input, so the results only change when the code does
+    std::default_random_engine engine(123);
+    std::uniform_real_distribution<double> distribution(-1, 1);
+    std::vector<InputType> input(compiledMap.GetInputSize());
+    for (auto& x : input)
+    {
+        x = static_cast<InputType>(distribution(engine));
+    }
+
+    for (int iteration = 0; iteration < arguments.numBurnInIterations; ++iteration)
+    {
+        compiledMap.Compute<OutputType>(input);
+    }
+
+    std::vector<double> times;
+    for (int iteration = 0; iteration < arguments.numIterations; ++iteration)
+    {
+        auto start = std::chrono::steady_clock::now();
+        compiledMap.Compute<OutputType>(input);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        times.push_back(elapsed.count());
+    }
+    return times;
+}
+
+template <typename InputType>
+std::vector<double> TimePredictions(model::IRCompiledMap& compiledMap, const BenchmarkArguments& arguments)
+{
+    switch (compiledMap.GetOutputType())
+    {
+    case model::Port::PortType::smallReal:
+        return TimePredictions<InputType, float>(compiledMap, arguments);
+    case model::Port::PortType::real:
+        return TimePredictions<InputType, double>(compiledMap, arguments);
+    default:
+        throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Model has an unsupported output type");
+    }
+}
+
+BenchmarkResult BenchmarkModel(const std::string& modelName, const model::Map& map, const std::string& optionSetName, const std::function<void(model::MapCompilerOptions&)>& setOptions, const BenchmarkArguments& arguments)
+{
+    model::MapCompilerOptions settings;
+    settings.footprintReport = true;
+    setOptions(settings);
+    model::IRMapCompiler compiler(settings, {});
+
+    BenchmarkResult result;
+    result.model = modelName;
+    result.options = optionSetName;
+
+    auto start = std::chrono::steady_clock::now();
+    auto compiledMap = compiler.Compile(map);
+    std::chrono::duration<double, std::milli> compileTime = std::chrono::steady_clock::now() - start;
+    result.compileTime = compileTime.count();
+
+    std::vector<double> times;
+    switch (compiledMap.GetInputType())
+    {
+    case model::Port::PortType::smallReal:
+        times = TimePredictions<float>(compiledMap, arguments);
+        break;
+    case model::Port::PortType::real:
+        times = TimePredictions<double>(compiledMap, arguments);
+        break;
+    default:
+        throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Model has an unsupported input type");
+    }
+    SetLatencyStatistics(times, result);
+
+    const auto& footprint = compiledMap.GetFootprintReport();
+    result.codeBytes = footprint.GetCodeBytes();
+    result.weightBytes = footprint.GetWeightBytes();
+    result.bufferBytes = footprint.GetPlannedBufferBytes();
+    result.stackBytes = footprint.GetStackBytes();
+    return result;
+}
+
+BenchmarkScorecard RunBenchmark(const BenchmarkArguments& arguments)
+{
+    passes::AddStandardTransformationsToRegistry();
+
+    auto host = emitters::GetTargetDevice("host");
+    BenchmarkScorecard scorecard;
+    scorecard.comment = arguments.comment;
+    scorecard.target = host.triple + " " + host.cpu;
+    scorecard.numIterations = arguments.numIterations;
+    scorecard.numBurnInIterations = arguments.numBurnInIterations;
+
+    for (const auto& [modelName, map] : GenerateModelZoo())
+    {
+        if (!ShouldBenchmark(modelName, arguments.models))
+        {
+            continue;
+        }
+        for (const auto& [optionSetName, setOptions] : GetOptionSets())
+        {
+            std::cerr << "Benchmarking " << modelName << " (" << optionSetName << ")" << std::endl;
+            scorecard.results.push_back(BenchmarkModel(modelName, map, optionSetName, setOptions, arguments));
+        }
+    }
+    return scorecard;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        utilities::CommandLineParser commandLineParser(argc, argv);
+        ParsedBenchmarkArguments arguments;
+        commandLineParser.AddOptionSet(arguments);
+        commandLineParser.Parse();
+
+        if (!arguments.compareFilename.empty() && arguments.baselineFilename.empty())
+        {
+            std::cerr << "A scorecard to compare needs a baseline (--baseline)" << std::endl;
+            return 1;
+        }
+
+        auto scorecard = arguments.compareFilename.empty() ? RunBenchmark(arguments) : ReadScorecard(arguments.compareFilename);
+        if (arguments.compareFilename.empty())
+        {
+            auto outputStream = GetOutputStream(arguments.outputFilename);
+            WriteBenchmarkScorecard(scorecard, outputStream);
+        }
+
+        if (!arguments.baselineFilename.empty())
+        {
+            auto baseline = ReadScorecard(arguments.baselineFilename);
+            auto numRegressions = CompareBenchmarkScorecards(baseline, scorecard, arguments.regressionThreshold / 100, std::cerr);
+            if (numRegressions > 0)
+            {
+                std::cerr << numRegressions << " regression(s) of more than " << arguments.regressionThreshold << "%" << std::endl;
+                return 1;
+            }
+        }
+    }
+    catch (const utilities::CommandLineParserPrintHelpException& exception)
+    {
+        std::cout << exception.GetHelpText() << std::endl;
+        return 0;
+    }
+    catch (const utilities::CommandLineParserErrorException& exception)
+    {
+        std::cerr << "Command line parse error:" << std::endl;
+        for (const auto& error : exception.GetParseErrors())
+        {
+            std::cerr << error.GetMessage() << std::endl;
+        }
+        return 1;
+    }
+    catch (const utilities::Exception& exception)
+    {
+        std::cerr << "Error: " << exception.GetMessage() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
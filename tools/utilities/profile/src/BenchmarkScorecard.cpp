@@ -0,0 +1,258 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BenchmarkScorecard.cpp (profile)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "BenchmarkScorecard.h"
+
+#include <testing/include/Benchmark.h>
+
+#include <utilities/include/Archiver.h>
+#include <utilities/include/Exception.h>
+#include <utilities/include/IArchivable.h>
+#include <utilities/include/JsonArchiver.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace ell
+{
+namespace
+{
+    // The archived form of a result
+    class ArchivedBenchmarkResult : public utilities::IArchivable
+    {
+    public:
+        ArchivedBenchmarkResult() = default;
+        ArchivedBenchmarkResult(const BenchmarkResult& result) :
+            result(result) {}
+
+        static std::string GetTypeName() { return "BenchmarkModelResult"; }
+
+        void WriteToArchive(utilities::Archiver& archiver) const override
+        {
+            archiver["model"] << result.model;
+            archiver["options"] << result.options;
+            archiver["compile_time"] << result.compileTime;
+            archiver["p50"] << result.p50;
+            archiver["p90"] << result.p90;
+            archiver["p99"] << result.p99;
+            archiver["max_time"] << result.maxTime;
+            archiver["average_time"] << result.meanTime;
+            archiver["throughput"] << result.throughput;
+            archiver["code_bytes"] << result.codeBytes;
+            archiver["weight_bytes"] << result.weightBytes;
+            archiver["buffer_bytes"] << result.bufferBytes;
+            archiver["stack_bytes"] << result.stackBytes;
+        }
+
+        void ReadFromArchive(utilities::Unarchiver& archiver) override
+        {
+            archiver["model"] >> result.model;
+            archiver["options"] >> result.options;
+            archiver["compile_time"] >> result.compileTime;
+            archiver["p50"] >> result.p50;
+            archiver["p90"] >> result.p90;
+            archiver["p99"] >> result.p99;
+            archiver["max_time"] >> result.maxTime;
+            archiver["average_time"] >> result.meanTime;
+            archiver["throughput"] >> result.throughput;
+            archiver["code_bytes"] >> result.codeBytes;
+            archiver["weight_bytes"] >> result.weightBytes;
+            archiver["buffer_bytes"] >> result.bufferBytes;
+            archiver["stack_bytes"] >> result.stackBytes;
+        }
+
+        BenchmarkResult result;
+
+    protected:
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+    };
+
+    // The archived form of a scorecard
+    class ArchivedBenchmarkScorecard : public utilities::IArchivable
+    {
+    public:
+        static std::string GetTypeName() { return "BenchmarkScorecard"; }
+
+        void WriteToArchive(utilities::Archiver& archiver) const override
+        {
+            archiver["comment"] << scorecard.comment;
+            archiver["target"] << scorecard.target;
+            archiver["iterations"] << scorecard.numIterations;
+            archiver["burn_in"] << scorecard.numBurnInIterations;
+            archiver["results"] << results;
+        }
+
+        void ReadFromArchive(utilities::Unarchiver& archiver) override
+        {
+            archiver["comment"] >> scorecard.comment;
+            archiver["target"] >> scorecard.target;
+            archiver["iterations"] >> scorecard.numIterations;
+            archiver["burn_in"] >> scorecard.numBurnInIterations;
+            archiver["results"] >> results;
+        }
+
+        BenchmarkScorecard scorecard;
+        std::vector<ArchivedBenchmarkResult> results;
+
+    protected:
+        std::string GetRuntimeTypeName() const override { return GetTypeName(); }
+    };
+
+    std::string GetResultName(const BenchmarkResult& result)
+    {
+        return result.model + " (" + result.options + ")";
+    }
+
+    // The median and 90th percentile latencies of the results, in the form testing::CompareBenchmarkResults takes
+    std::vector<testing::BenchmarkResult> GetLatencies(const BenchmarkScorecard& scorecard)
+    {
+        std::vector<testing::BenchmarkResult> latencies;
+        for (const auto& result : scorecard.results)
+        {
+            testing::BenchmarkResult latency;
+            latency.name = GetResultName(result);
+            latency.numSamples = static_cast<size_t>(scorecard.numIterations);
+            latency.callsPerSample = 1;
+            latency.medianSeconds = result.p50 / 1000;
+            latency.p90Seconds = result.p90 / 1000;
+            latencies.push_back(latency);
+        }
+        return latencies;
+    }
+
+    double RelativeChange(double baseline, double current)
+    {
+        return baseline == 0 ? 0 : (current - baseline) / baseline;
+    }
+} // namespace
+
+void SetLatencyStatistics(std::vector<double> times, BenchmarkResult& result)
+{
+    if (times.empty())
+    {
+        return;
+    }
+
+    std::sort(times.begin(), times.end());
+    auto totalTime = std::accumulate(times.begin(), times.end(), 0.0);
+    result.p50 = testing::GetPercentile(times, 50);
+    result.p90 = testing::GetPercentile(times, 90);
+    result.p99 = testing::GetPercentile(times, 99);
+    result.maxTime = times.back();
+    result.meanTime = totalTime / times.size();
+    result.throughput = totalTime > 0 ? 1000.0 * times.size() / totalTime : 0;
+}
+
+void WriteBenchmarkScorecard(const BenchmarkScorecard& scorecard, std::ostream& out)
+{
+    ArchivedBenchmarkScorecard archivedScorecard;
+    archivedScorecard.scorecard = scorecard;
+    archivedScorecard.results.assign(scorecard.results.begin(), scorecard.results.end());
+
+    utilities::JsonArchiver archiver(out);
+    archiver << archivedScorecard;
+}
+
+BenchmarkScorecard ReadBenchmarkScorecard(std::istream& in)
+{
+    ArchivedBenchmarkScorecard archivedScorecard;
+    try
+    {
+        utilities::SerializationContext context;
+        utilities::JsonUnarchiver unarchiver(in, context);
+        unarchiver >> archivedScorecard;
+    }
+    catch (const std::logic_error&)
+    {
+        // a number that doesn't parse
+        throw utilities::InputException(utilities::InputExceptionErrors::badData, "Benchmark scorecard has a malformed number");
+    }
+
+    auto scorecard = archivedScorecard.scorecard;
+    for (const auto& result : archivedScorecard.results)
+    {
+        scorecard.results.push_back(result.result);
+    }
+    if (scorecard.results.empty())
+    {
+        throw utilities::InputException(utilities::InputExceptionErrors::badData, "Benchmark scorecard has no results");
+    }
+    return scorecard;
+}
+
+int CompareBenchmarkScorecards(const BenchmarkScorecard& baseline, const BenchmarkScorecard& current, double threshold, std::ostream& out)
+{
+    std::ios::fmtflags savedFlags(out.flags());
+    out << std::fixed << std::setprecision(1);
+
+    if (baseline.target != current.target)
+    {
+        out << "Warning: comparing results from different targets (" << baseline.target << " and " << current.target << ")" << std::endl;
+    }
+
+    // Changes in percent, for the results in both scorecards
+    out << std::left << std::setw(20) << "model" << std::setw(14) << "options" << std::right
+        << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(12) << "throughput"
+        << std::setw(10) << "code" << std::setw(10) << "weights" << std::setw(10) << "buffers" << std::endl;
+
+    // The latency comparison of each result that is in both scorecards
+    std::map<std::string, testing::BenchmarkComparison> latencyComparisons;
+    for (const auto& comparison : testing::CompareBenchmarkResults(GetLatencies(baseline), GetLatencies(current), threshold))
+    {
+        latencyComparisons[comparison.name] = comparison;
+    }
+
+    int numRegressions = 0;
+    for (const auto& result : current.results)
+    {
+        auto it = std::find_if(baseline.results.begin(), baseline.results.end(), [&result](const BenchmarkResult& baselineResult) {
+            return baselineResult.model == result.model && baselineResult.options == result.options;
+        });
+        if (it == baseline.results.end())
+        {
+            out << std::left << std::setw(20) << result.model << std::setw(14) << result.options << std::right << "  (not in baseline)" << std::endl;
+            continue;
+        }
+
+        const std::vector<double> changes = {
+            RelativeChange(it->p50, result.p50),
+            RelativeChange(it->p90, result.p90),
+            RelativeChange(it->p99, result.p99),
+            RelativeChange(it->throughput, result.throughput),
+            RelativeChange(static_cast<double>(it->codeBytes), static_cast<double>(result.codeBytes)),
+            RelativeChange(static_cast<double>(it->weightBytes), static_cast<double>(result.weightBytes)),
+            RelativeChange(static_cast<double>(it->bufferBytes), static_cast<double>(result.bufferBytes))
+        };
+        const std::vector<int> widths = { 10, 10, 10, 12, 10, 10, 10 };
+
+        out << std::left << std::setw(20) << result.model << std::setw(14) << result.options << std::right;
+        for (size_t index = 0; index < changes.size(); ++index)
+        {
+            out << std::setw(widths[index] - 1) << std::showpos << 100 * changes[index] << std::noshowpos << "%";
+        }
+
+        // The tail percentiles are too noisy to count as regressions, so only the median latency and the memory do
+        auto latencyComparison = latencyComparisons.find(GetResultName(result));
+        bool isLatencyRegression = latencyComparison != latencyComparisons.end() && latencyComparison->second.isRegression;
+        bool isRegression = isLatencyRegression || changes[4] > threshold || changes[5] > threshold || changes[6] > threshold;
+        if (isRegression)
+        {
+            out << "  REGRESSION";
+            ++numRegressions;
+        }
+        out << std::endl;
+    }
+
+    out.flags(savedFlags);
+    return numRegressions;
+}
+} // namespace ell
@@ -0,0 +1,699 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     BenchmarkServer_main.cpp (profile)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A server that runs on the target device and benchmarks compiled models sent to it, so the tools on the host
+// don't have to copy, build and start a profiler over SSH for every measurement. See README.md for the protocol.
+//
+// The server runs the code it's sent, so it only listens on the loopback interface unless told otherwise with
+// --bind, and every connection has to present the server's token before any other command is accepted.
+
+#ifndef ELL_BENCHMARK_SERVER
+#define ELL_BENCHMARK_SERVER
+#endif
+#include "ProfileReport.h"
+
+#include <arpa/inet.h>
+#include <dlfcn.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct ServerArguments
+{
+    int port = 8765;
+    std::string bindAddress = "127.0.0.1";
+    std::string token;
+    std::string linkCommand = "cc -shared";
+    size_t maxLibrarySize = size_t(256) << 20; // bytes
+    double timeoutSeconds = 300; // how long a connection can go without sending anything
+};
+
+struct BenchmarkRequest
+{
+    std::string moduleName = "model";
+    std::string functionName;
+    size_t librarySize = 0;
+    int numWarmUpIterations = 10;
+    int numIterations = 20;
+    int batchSize = 1;
+    std::string inputType = "float";
+    ProfileOutputFormat outputFormat = ProfileOutputFormat::text;
+    std::string comment;
+};
+
+//
+// Connection-related
+//
+class Connection
+{
+public:
+    // Reads and writes that wait for longer than the timeout fail, so an idle client can't hold up the server
+    Connection(int socket, double timeoutSeconds) :
+        _socket(socket)
+    {
+        timeval timeout = {};
+        auto microseconds = std::max<long long>(static_cast<long long>(timeoutSeconds * 1e6), 1000);
+        timeout.tv_sec = static_cast<time_t>(microseconds / 1000000);
+        timeout.tv_usec = static_cast<suseconds_t>(microseconds % 1000000);
+        setsockopt(_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+
+    ~Connection() { close(_socket); }
+
+    // Returns false at the end of the stream
+    bool ReadLine(std::string& line)
+    {
+        line.clear();
+        char ch;
+        while (ReadBytes(&ch, 1))
+        {
+            if (ch == '\n')
+            {
+                return true;
+            }
+            line.push_back(ch);
+        }
+        return !line.empty();
+    }
+
+    bool ReadBytes(char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            if (_bufferBegin == _bufferEnd)
+            {
+                auto received = recv(_socket, _buffer, sizeof(_buffer), 0);
+                if (received <= 0)
+                {
+                    return false;
+                }
+                _bufferBegin = 0;
+                _bufferEnd = static_cast<size_t>(received);
+            }
+            auto count = std::min(size, _bufferEnd - _bufferBegin);
+            std::memcpy(data, _buffer + _bufferBegin, count);
+            _bufferBegin += count;
+            data += count;
+            size -= count;
+        }
+        return true;
+    }
+
+    void Write(const std::string& text)
+    {
+        const char* data = text.data();
+        size_t size = text.size();
+        while (size > 0)
+        {
+            auto sent = send(_socket, data, size, 0);
+            if (sent <= 0)
+            {
+                return;
+            }
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+    }
+
+private:
+    int _socket;
+    char _buffer[1 << 16];
+    size_t _bufferBegin = 0;
+    size_t _bufferEnd = 0;
+};
+
+// Parses "BENCHMARK key=value key=value ...". Values can't contain spaces, except for the comment, which is the rest of the line.
+BenchmarkRequest ParseBenchmarkRequest(const std::string& line, size_t maxLibrarySize)
+{
+    BenchmarkRequest request;
+    std::istringstream stream(line);
+    std::string command;
+    stream >> command;
+
+    std::string entry;
+    while (stream >> entry)
+    {
+        auto separator = entry.find('=');
+        if (separator == std::string::npos)
+        {
+            throw std::runtime_error("Expected key=value, got '" + entry + "'");
+        }
+        auto key = entry.substr(0, separator);
+        auto value = entry.substr(separator + 1);
+        if (key == "comment")
+        {
+            std::string rest;
+            std::getline(stream, rest);
+            request.comment = value + rest;
+        }
+        else if (key == "module")
+        {
+            request.moduleName = value;
+        }
+        else if (key == "function")
+        {
+            request.functionName = value;
+        }
+        else if (key == "size")
+        {
+            request.librarySize = std::stoul(value);
+        }
+        else if (key == "warmup")
+        {
+            request.numWarmUpIterations = std::stoi(value);
+        }
+        else if (key == "iterations")
+        {
+            request.numIterations = std::stoi(value);
+        }
+        else if (key == "batch")
+        {
+            request.batchSize = std::max(std::stoi(value), 1);
+        }
+        else if (key == "input")
+        {
+            if (value != "float" && value != "double")
+            {
+                throw std::runtime_error("Unsupported input type " + value);
+            }
+            request.inputType = value;
+        }
+        else if (key == "format")
+        {
+            request.outputFormat = value == "json" ? ProfileOutputFormat::json : ProfileOutputFormat::text;
+        }
+        else
+        {
+            throw std::runtime_error("Unknown request key " + key);
+        }
+    }
+
+    if (request.functionName.empty())
+    {
+        request.functionName = request.moduleName + "_Predict";
+    }
+    if (request.librarySize == 0)
+    {
+        throw std::runtime_error("The request needs the size of the library that follows it");
+    }
+    if (request.librarySize > maxLibrarySize)
+    {
+        throw std::runtime_error("The library is larger than the server's limit of " + std::to_string(maxLibrarySize) + " bytes");
+    }
+    return request;
+}
+
+//
+// Authentication-related
+//
+
+// Compares the whole strings, so the time taken doesn't reveal how much of a guess was right
+bool TokensMatch(const std::string& expected, const std::string& actual)
+{
+    unsigned char difference = expected.size() == actual.size() ? 0 : 1;
+    for (size_t index = 0; index < expected.size(); ++index)
+    {
+        difference |= static_cast<unsigned char>(expected[index] ^ (index < actual.size() ? actual[index] : 0));
+    }
+    return difference == 0;
+}
+
+std::string GenerateToken()
+{
+    std::random_device device;
+    std::ostringstream token;
+    for (int index = 0; index < 4; ++index)
+    {
+        char word[9];
+        std::snprintf(word, sizeof(word), "%08x", device());
+        token << word;
+    }
+    return token.str();
+}
+
+//
+// Library-related
+//
+
+// A file in the temp directory that is removed when it goes out of scope
+class TempFile
+{
+public:
+    TempFile(const std::string& suffix)
+    {
+        std::string pattern = "/tmp/ellbench-XXXXXX" + suffix;
+        std::vector<char> path(pattern.begin(), pattern.end());
+        path.push_back('\0');
+        auto file = mkstemps(path.data(), static_cast<int>(suffix.size()));
+        if (file < 0)
+        {
+            throw std::runtime_error("Couldn't create a temporary file");
+        }
+        close(file);
+        _path = path.data();
+    }
+
+    ~TempFile() { std::remove(_path.c_str()); }
+
+    const std::string& GetPath() const { return _path; }
+
+private:
+    std::string _path;
+};
+
+void WriteFile(const std::string& path, const std::vector<char>& contents)
+{
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        throw std::runtime_error("Couldn't open " + path + ": " + std::strerror(errno));
+    }
+    auto written = std::fwrite(contents.data(), 1, contents.size(), file);
+    auto closed = std::fclose(file);
+    if (written != contents.size() || closed != 0)
+    {
+        throw std::runtime_error("Couldn't write " + path + ": " + std::strerror(errno));
+    }
+}
+
+// ELF files have their type at offset 16: 1 for relocatable (object) files, 3 for shared objects
+bool IsObjectFile(const std::vector<char>& contents)
+{
+    return contents.size() > 17 && std::memcmp(contents.data(), "\x7f" "ELF", 4) == 0 && contents[16] == 1 && contents[17] == 0;
+}
+
+// Runs the link command directly rather than through the shell, so nothing in the paths or the command is interpreted.
+// The command is split at whitespace and can't contain quoted arguments.
+void LinkLibrary(const std::string& linkCommand, const std::string& objectPath, const std::string& libraryPath)
+{
+    std::vector<std::string> arguments;
+    std::istringstream stream(linkCommand);
+    std::string argument;
+    while (stream >> argument)
+    {
+        arguments.push_back(argument);
+    }
+    if (arguments.empty())
+    {
+        throw std::runtime_error("The link command is empty");
+    }
+    arguments.insert(arguments.end(), { "-o", libraryPath, objectPath });
+
+    std::vector<char*> argv;
+    for (auto& entry : arguments)
+    {
+        argv.push_back(&entry[0]);
+    }
+    argv.push_back(nullptr);
+
+    auto child = fork();
+    if (child < 0)
+    {
+        throw std::runtime_error("Couldn't start the linker");
+    }
+    if (child == 0)
+    {
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int status = 0;
+    while (waitpid(child, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+        {
+            throw std::runtime_error("Couldn't wait for the linker");
+        }
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        throw std::runtime_error("Linking failed: " + linkCommand);
+    }
+}
+
+class LoadedModel
+{
+public:
+    LoadedModel(const std::string& path, const std::string& moduleName) :
+        _moduleName(moduleName)
+    {
+        _library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (_library == nullptr)
+        {
+            throw std::runtime_error(std::string("dlopen failed: ") + dlerror());
+        }
+    }
+
+    ~LoadedModel() { dlclose(_library); }
+
+    // Returns null if the model doesn't have the function, e.g. because it wasn't compiled with profiling
+    template <typename FunctionType>
+    FunctionType* GetFunction(const std::string& name) const
+    {
+        return reinterpret_cast<FunctionType*>(dlsym(_library, (_moduleName + "_" + name).c_str()));
+    }
+
+    template <typename FunctionType>
+    FunctionType* GetRequiredFunction(const std::string& name) const
+    {
+        auto function = GetFunction<FunctionType>(name);
+        if (function == nullptr)
+        {
+            throw std::runtime_error("The library doesn't have " + _moduleName + "_" + name);
+        }
+        return function;
+    }
+
+    void* GetSymbol(const std::string& name) const { return dlsym(_library, name.c_str()); }
+
+private:
+    void* _library;
+    std::string _moduleName;
+};
+
+//
+// Benchmark-related
+//
+void ResetProfilingInfo(const LoadedModel& model)
+{
+    for (auto name : { "ResetModelProfilingInfo", "ResetNodeProfilingInfo", "ResetNodeTypeProfilingInfo", "ResetRegionProfilingInfo" })
+    {
+        if (auto reset = model.GetFunction<void()>(name))
+        {
+            reset();
+        }
+    }
+}
+
+void WriteProfilingStatistics(const LoadedModel& model, ProfileOutputFormat format, std::ostream& out)
+{
+    auto getNumNodes = model.GetFunction<int()>("GetNumNodes");
+    auto getNodeInfo = model.GetFunction<ELL_NodeInfo*(int)>("GetNodeInfo");
+    auto getNodeCounters = model.GetFunction<ELL_PerformanceCounters*(int)>("GetNodePerformanceCounters");
+    auto getNumNodeTypes = model.GetFunction<int()>("GetNumNodeTypes");
+    auto getNodeTypeInfo = model.GetFunction<ELL_NodeInfo*(int)>("GetNodeTypeInfo");
+    auto getNodeTypeCounters = model.GetFunction<ELL_PerformanceCounters*(int)>("GetNodeTypePerformanceCounters");
+    auto getModelCounters = model.GetFunction<ELL_PerformanceCounters*()>("GetModelPerformanceCounters");
+    if (!getNumNodes || !getNodeInfo || !getNodeCounters || !getNumNodeTypes || !getNodeTypeInfo || !getNodeTypeCounters || !getModelCounters)
+    {
+        return;
+    }
+
+    std::vector<std::pair<ELL_NodeInfo, ELL_PerformanceCounters>> nodeInfo;
+    for (int index = 0; index < getNumNodes(); ++index)
+    {
+        nodeInfo.emplace_back(*getNodeInfo(index), *getNodeCounters(index));
+    }
+
+    std::vector<std::pair<ELL_NodeInfo, ELL_PerformanceCounters>> nodeTypeInfo;
+    for (int index = 0; index < getNumNodeTypes(); ++index)
+    {
+        nodeTypeInfo.emplace_back(*getNodeTypeInfo(index), *getNodeTypeCounters(index));
+    }
+    std::sort(nodeTypeInfo.begin(), nodeTypeInfo.end(), [](auto a, auto b) { return a.second.totalTime < b.second.totalTime; });
+
+    std::vector<ELL_ProfileRegionInfo> regions;
+    auto getNumRegions = model.GetFunction<int()>("GetNumProfileRegions");
+    auto getRegionInfo = model.GetFunction<ELL_ProfileRegionInfo*(int)>("GetRegionProfilingInfo");
+    if (getNumRegions && getRegionInfo)
+    {
+        for (int index = 0; index < getNumRegions(); ++index)
+        {
+            regions.emplace_back(*getRegionInfo(index));
+        }
+    }
+
+    WriteNodeStatistics(nodeInfo, nodeTypeInfo, format, out);
+    out << (format == ProfileOutputFormat::json ? ",\n" : "");
+    WriteRegionStatistics(regions, format, out);
+    out << (format == ProfileOutputFormat::json ? ",\n" : "");
+    WriteModelStatistics(getModelCounters(), format, out);
+    out << (format == ProfileOutputFormat::json ? ",\n" : "");
+
+    // Models compiled before latency histograms were added don't have these
+    auto getModelLatency = model.GetFunction<ELL_LatencyStatistics*()>("GetModelLatencyStatistics");
+    auto getNodeLatency = model.GetFunction<ELL_LatencyStatistics*(int)>("GetNodeLatencyStatistics");
+    if (getModelLatency && getNodeLatency)
+    {
+        std::vector<std::pair<ELL_NodeInfo, ELL_LatencyStatistics>> nodeLatency;
+        for (int index = 0; index < getNumNodes(); ++index)
+        {
+            nodeLatency.emplace_back(*getNodeInfo(index), *getNodeLatency(index));
+        }
+        WriteLatencyStatistics(getModelLatency(), nodeLatency, format, out);
+        out << (format == ProfileOutputFormat::json ? ",\n" : "");
+    }
+}
+
+template <typename ValueType>
+std::vector<double> TimeModel(const LoadedModel& model, const BenchmarkRequest& request)
+{
+    using PredictFunction = void(void*, const ValueType*, ValueType*);
+    auto predict = reinterpret_cast<PredictFunction*>(model.GetSymbol(request.functionName));
+    if (predict == nullptr)
+    {
+        throw std::runtime_error("The library doesn't have " + request.functionName);
+    }
+    auto getInputSize = model.GetRequiredFunction<int(int)>("GetInputSize");
+    auto getOutputSize = model.GetRequiredFunction<int(int)>("GetOutputSize");
+
+    std::vector<ValueType> input(static_cast<size_t>(getInputSize(0)));
+    std::vector<ValueType> output(static_cast<size_t>(getOutputSize(0)));
+    std::default_random_engine engine(123);
+    std::uniform_real_distribution<ValueType> distribution(0, 1);
+    std::generate(input.begin(), input.end(), [&] { return distribution(engine); });
+
+    for (int iteration = 0; iteration < request.numWarmUpIterations; ++iteration)
+    {
+        predict(nullptr, input.data(), output.data());
+    }
+    ResetProfilingInfo(model);
+
+    std::vector<double> iterationTimes;
+    for (int iteration = 0; iteration < request.numIterations; ++iteration)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < request.batchSize; ++run)
+        {
+            predict(nullptr, input.data(), output.data());
+        }
+        iterationTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return iterationTimes;
+}
+
+std::string RunBenchmark(const BenchmarkRequest& request, const std::vector<char>& contents, const ServerArguments& arguments)
+{
+    // Object files are linked into a shared library first
+    TempFile library(".so");
+    if (IsObjectFile(contents))
+    {
+        TempFile object(".o");
+        WriteFile(object.GetPath(), contents);
+        LinkLibrary(arguments.linkCommand, object.GetPath(), library.GetPath());
+    }
+    else
+    {
+        WriteFile(library.GetPath(), contents);
+    }
+
+    LoadedModel model(library.GetPath(), request.moduleName);
+    auto iterationTimes = request.inputType == "double" ? TimeModel<double>(model, request) : TimeModel<float>(model, request);
+
+    std::ostringstream report;
+    auto format = request.outputFormat;
+    report << (format == ProfileOutputFormat::json ? "{\n" : "");
+    if (!request.comment.empty())
+    {
+        WriteUserComment(request.comment, format, report);
+        report << (format == ProfileOutputFormat::json ? ",\n" : "");
+    }
+    WriteProfilingStatistics(model, format, report);
+    WriteTimingStatistics(iterationTimes, request.batchSize, format, report);
+    report << (format == ProfileOutputFormat::json ? "\n}\n" : "\n");
+    return report.str();
+}
+
+// Handles the requests on a connection until it closes. Returns false if the client asked the server to stop.
+bool HandleConnection(Connection& connection, const ServerArguments& arguments)
+{
+    // The first line has to be "AUTH <token>"; anything else closes the connection before a command is run
+    std::string line;
+    if (!connection.ReadLine(line))
+    {
+        return true;
+    }
+    const std::string authCommand = "AUTH ";
+    if (line.compare(0, authCommand.size(), authCommand) != 0 || !TokensMatch(arguments.token, line.substr(authCommand.size())))
+    {
+        connection.Write("ERROR Not authorized\n");
+        return true;
+    }
+    connection.Write("OK 0\n");
+
+    while (connection.ReadLine(line))
+    {
+        if (line == "PING")
+        {
+            connection.Write("OK 0\n");
+        }
+        else if (line == "QUIT")
+        {
+            return true;
+        }
+        else if (line == "SHUTDOWN")
+        {
+            connection.Write("OK 0\n");
+            return false;
+        }
+        else if (line.compare(0, 9, "BENCHMARK") == 0)
+        {
+            // A bad request closes the connection, since we can't tell where the library that follows it ends
+            BenchmarkRequest request;
+            try
+            {
+                request = ParseBenchmarkRequest(line, arguments.maxLibrarySize);
+            }
+            catch (const std::exception& exception)
+            {
+                connection.Write(std::string("ERROR ") + exception.what() + "\n");
+                return true;
+            }
+
+            std::vector<char> contents(request.librarySize);
+            if (!connection.ReadBytes(contents.data(), contents.size()))
+            {
+                return true;
+            }
+
+            try
+            {
+                auto report = RunBenchmark(request, contents, arguments);
+                connection.Write("OK " + std::to_string(report.size()) + "\n" + report);
+            }
+            catch (const std::exception& exception)
+            {
+                connection.Write(std::string("ERROR ") + exception.what() + "\n");
+            }
+        }
+        else
+        {
+            connection.Write("ERROR Unknown command\n");
+        }
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    ServerArguments arguments;
+    for (int index = 1; index + 1 < argc; index += 2)
+    {
+        std::string name = argv[index];
+        if (name == "--port")
+        {
+            arguments.port = std::atoi(argv[index + 1]);
+        }
+        else if (name == "--bind")
+        {
+            arguments.bindAddress = argv[index + 1];
+        }
+        else if (name == "--tokenFile")
+        {
+            std::ifstream tokenFile(argv[index + 1]);
+            if (!std::getline(tokenFile, arguments.token) || arguments.token.empty())
+            {
+                std::cerr << "Couldn't read a token from " << argv[index + 1] << std::endl;
+                return 1;
+            }
+        }
+        else if (name == "--linkCommand")
+        {
+            arguments.linkCommand = argv[index + 1];
+        }
+        else if (name == "--maxLibraryMB")
+        {
+            arguments.maxLibrarySize = static_cast<size_t>(std::max(std::atoi(argv[index + 1]), 1)) << 20;
+        }
+        else if (name == "--timeout")
+        {
+            arguments.timeoutSeconds = std::max(std::atof(argv[index + 1]), 1.0);
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--port port] [--bind address] [--tokenFile file] [--linkCommand \"cc -shared -lopenblas\"] [--maxLibraryMB 256] [--timeout seconds]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (arguments.token.empty())
+    {
+        if (auto token = std::getenv("ELL_BENCHMARK_TOKEN"))
+        {
+            arguments.token = token;
+        }
+        else
+        {
+            arguments.token = GenerateToken();
+            std::cout << "Benchmark server token: " << arguments.token << std::endl;
+        }
+    }
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(arguments.port));
+    if (inet_pton(AF_INET, arguments.bindAddress.c_str(), &address.sin_addr) != 1)
+    {
+        std::cerr << "Invalid bind address " << arguments.bindAddress << std::endl;
+        return 1;
+    }
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 4) != 0)
+    {
+        std::cerr << "Couldn't listen on port " << arguments.port << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    std::cout << "Benchmark server listening on " << arguments.bindAddress << ":" << arguments.port << std::endl;
+
+    // Benchmarks run one at a time, so they don't disturb each other's timings
+    bool isRunning = true;
+    while (isRunning)
+    {
+        int socket = accept(listener, nullptr, nullptr);
+        if (socket < 0)
+        {
+            continue;
+        }
+        Connection connection(socket, arguments.timeoutSeconds);
+        isRunning = HandleConnection(connection, arguments);
+    }
+    close(listener);
+    return 0;
+}
@@ -97,6 +97,17 @@ void WriteRegionStatistics(ProfileOutputFormat format, std::ostream& out)
     WriteRegionStatistics(regions, format, out);
 }
 
+void WriteLatencyStatistics(ProfileOutputFormat format, std::ostream& out)
+{
+    std::vector<std::pair<ELL_NodeInfo, ELL_LatencyStatistics>> nodeLatency;
+    auto numNodes = ELL_GetNumNodes();
+    for (int index = 0; index < numNodes; ++index)
+    {
+        nodeLatency.emplace_back(*ELL_GetNodeInfo(index), *ELL_GetNodeLatencyStatistics(index));
+    }
+    WriteLatencyStatistics(ELL_GetModelLatencyStatistics(), nodeLatency, format, out);
+}
+
 //
 // Profiling functions
 //
@@ -174,6 +185,7 @@ void ProfileModel(const ProfileArguments& profileArguments, InputType lowDataVal
         WriteNodeStatistics(format, profileOutputStream);
         WriteRegionStatistics(format, profileOutputStream);
         WriteModelStatistics(format, profileOutputStream);
+        WriteLatencyStatistics(format, profileOutputStream);
     }
     else
     {
@@ -188,6 +200,8 @@ void ProfileModel(const ProfileArguments& profileArguments, InputType lowDataVal
         WriteRegionStatistics(format, profileOutputStream);
         profileOutputStream << ",\n";
         WriteModelStatistics(format, profileOutputStream);
+        profileOutputStream << ",\n";
+        WriteLatencyStatistics(format, profileOutputStream);
         profileOutputStream << "}\n";
     }
 }
@@ -11,9 +11,13 @@
 #include <math/include/Tensor.h>
 
 #include <nodes/include/BroadcastFunctionNode.h>
+#include <nodes/include/ConstantNode.h>
 #include <nodes/include/DiagonalConvolutionNode.h>
 #include <nodes/include/ForestPredictorNode.h>
+#include <nodes/include/LSTMNode.h>
+#include <nodes/include/MatrixVectorProductNode.h>
 #include <nodes/include/NeuralNetworkPredictorNode.h>
+#include <nodes/include/ProtoNNPredictorNode.h>
 #include <nodes/include/ReinterpretLayoutNode.h>
 #include <nodes/include/SimpleConvolutionNode.h>
 #include <nodes/include/UnrolledConvolutionNode.h>
@@ -22,6 +26,7 @@
 #include <predictors/include/ForestPredictor.h>
 #include <predictors/include/LinearPredictor.h>
 #include <predictors/include/NeuralNetworkPredictor.h>
+#include <predictors/include/ProtoNNPredictor.h>
 #include <predictors/include/SingleElementThresholdPredictor.h>
 
 #include <predictors/neural/include/ActivationLayer.h>
@@ -31,10 +36,13 @@
 #include <predictors/neural/include/FullyConnectedLayer.h>
 #include <predictors/neural/include/Layer.h>
 #include <predictors/neural/include/MaxPoolingFunction.h>
+#include <predictors/neural/include/MeanPoolingFunction.h>
 #include <predictors/neural/include/PoolingLayer.h>
 #include <predictors/neural/include/ReLUActivation.h>
 #include <predictors/neural/include/ScalingLayer.h>
+#include <predictors/neural/include/SigmoidActivation.h>
 #include <predictors/neural/include/SoftmaxLayer.h>
+#include <predictors/neural/include/TanhActivation.h>
 
 #include <utilities/include/RandomEngines.h>
 
@@ -601,4 +609,155 @@ model::Map GenerateConvolutionModel(int inputRows, int inputColumns, int numChan
     return map;
 }
 
+//
+// The benchmark model zoo
+//
+
+namespace
+{
+    template <typename ElementType>
+    model::Map CreateNeuralNetworkMap(typename predictors::NeuralNetworkPredictor<ElementType>::InputLayerReference inputLayer, typename predictors::NeuralNetworkPredictor<ElementType>::Layers layers)
+    {
+        predictors::NeuralNetworkPredictor<ElementType> neuralNetwork(std::move(inputLayer), std::move(layers));
+        model::Model model;
+        auto inputNode = model.AddNode<model::InputNode<ElementType>>(GetShapeSize(neuralNetwork.GetInputShape()));
+        const auto& predictor = nodes::NeuralNetwork(inputNode->output, neuralNetwork);
+        return model::Map(model, { { "input", inputNode } }, { { "output", predictor } });
+    }
+} // namespace
+
+model::Map GenerateSmallCNNModel()
+{
+    using ElementType = float;
+    using InputParameters = typename InputLayer<ElementType>::InputParameters;
+    using MatrixType = typename Layer<ElementType>::MatrixType;
+    using TensorType = typename Layer<ElementType>::TensorType;
+    using VectorType = typename Layer<ElementType>::VectorType;
+
+    typename predictors::NeuralNetworkPredictor<ElementType>::InputLayerReference inputLayer;
+    typename predictors::NeuralNetworkPredictor<ElementType>::Layers layers;
+    ConvolutionalParameters convParams{ 3, 1, ConvolutionMethod::unrolled, 1 };
+
+    // Input layer: 32x32x3
+    InputParameters inputParams = { { 32, 32, 3 }, NoPadding(), { 34, 34, 3 }, ZeroPadding(1), 1 };
+    inputLayer = std::make_unique<InputLayer<ElementType>>(inputParams);
+
+    // Convolution 3x3x16, bias, ReLU, max pooling
+    AddLayer<ConvolutionalLayer<ElementType>, ElementType>(layers, inputLayer, ZeroPadding(1), { 32, 32, 16 }, NoPadding(), convParams, GetRandomTensor<TensorType>(3 * 16, 3, 3));
+    AddLayer<BiasLayer<ElementType>, ElementType>(layers, NoPadding(), { 32, 32, 16 }, NoPadding(), GetRandomVector<VectorType>(16));
+    AddLayer<ActivationLayer<ElementType>, ElementType>(layers, NoPadding(), { 32, 32, 16 }, NoPadding(), new ReLUActivation<ElementType>());
+    AddLayer<PoolingLayer<ElementType, MaxPoolingFunction>, ElementType>(layers, NoPadding(), { 18, 18, 16 }, ZeroPadding(1), PoolingParameters{ 2, 2 });
+
+    // Convolution 3x3x32, bias, ReLU, max pooling
+    AddLayer<ConvolutionalLayer<ElementType>, ElementType>(layers, ZeroPadding(1), { 16, 16, 32 }, NoPadding(), convParams, GetRandomTensor<TensorType>(3 * 32, 3, 16));
+    AddLayer<BiasLayer<ElementType>, ElementType>(layers, NoPadding(), { 16, 16, 32 }, NoPadding(), GetRandomVector<VectorType>(32));
+    AddLayer<ActivationLayer<ElementType>, ElementType>(layers, NoPadding(), { 16, 16, 32 }, NoPadding(), new ReLUActivation<ElementType>());
+    AddLayer<PoolingLayer<ElementType, MaxPoolingFunction>, ElementType>(layers, NoPadding(), { 8, 8, 32 }, NoPadding(), PoolingParameters{ 2, 2 });
+
+    // Dense layer to 10 classes, softmax
+    AddLayer<FullyConnectedLayer<ElementType>, ElementType>(layers, NoPadding(), { 1, 1, 10 }, NoPadding(), GetRandomMatrix<MatrixType>(10, 8 * 8 * 32));
+    AddLayer<SoftmaxLayer<ElementType>, ElementType>(layers, NoPadding(), { 1, 1, 10 }, NoPadding());
+
+    return CreateNeuralNetworkMap<ElementType>(std::move(inputLayer), std::move(layers));
+}
+
+model::Map GenerateMobileNetBlocksModel()
+{
+    using ElementType = float;
+    using InputParameters = typename InputLayer<ElementType>::InputParameters;
+    using MatrixType = typename Layer<ElementType>::MatrixType;
+    using TensorType = typename Layer<ElementType>::TensorType;
+    using VectorType = typename Layer<ElementType>::VectorType;
+
+    typename predictors::NeuralNetworkPredictor<ElementType>::InputLayerReference inputLayer;
+    typename predictors::NeuralNetworkPredictor<ElementType>::Layers layers;
+
+    // Input layer: 64x64x3
+    InputParameters inputParams = { { 64, 64, 3 }, NoPadding(), { 66, 66, 3 }, ZeroPadding(1), 1 };
+    inputLayer = std::make_unique<InputLayer<ElementType>>(inputParams);
+
+    // Stem: convolution 3x3x32 with stride 2, bias, ReLU
+    size_t size = 32;
+    size_t channels = 32;
+    AddLayer<ConvolutionalLayer<ElementType>, ElementType>(layers, inputLayer, ZeroPadding(1), { size, size, channels }, NoPadding(), ConvolutionalParameters{ 3, 2, ConvolutionMethod::unrolled, 1 }, GetRandomTensor<TensorType>(3 * channels, 3, 3));
+    AddLayer<BiasLayer<ElementType>, ElementType>(layers, NoPadding(), { size, size, channels }, NoPadding(), GetRandomVector<VectorType>(channels));
+    AddLayer<ActivationLayer<ElementType>, ElementType>(layers, NoPadding(), { size + 2, size + 2, channels }, ZeroPadding(1), new ReLUActivation<ElementType>());
+
+    // Depthwise-separable blocks: a depthwise 3x3 convolution and a pointwise 1x1 convolution, each followed by bias and ReLU
+    const std::vector<std::pair<size_t, size_t>> blocks = { { 64, 1 }, { 128, 2 }, { 128, 1 }, { 256, 2 } }; // output channels, stride
+    for (size_t blockIndex = 0; blockIndex < blocks.size(); ++blockIndex)
+    {
+        const auto [outputChannels, stride] = blocks[blockIndex];
+        const bool isLastBlock = blockIndex + 1 == blocks.size();
+        size /= stride;
+
+        AddLayer<ConvolutionalLayer<ElementType>, ElementType>(layers, ZeroPadding(1), { size, size, channels }, NoPadding(), ConvolutionalParameters{ 3, stride, ConvolutionMethod::simple, 1 }, GetRandomTensor<TensorType>(3 * channels, 3, 1));
+        AddLayer<BiasLayer<ElementType>, ElementType>(layers, NoPadding(), { size, size, channels }, NoPadding(), GetRandomVector<VectorType>(channels));
+        AddLayer<ActivationLayer<ElementType>, ElementType>(layers, NoPadding(), { size, size, channels }, NoPadding(), new ReLUActivation<ElementType>());
+
+        AddLayer<ConvolutionalLayer<ElementType>, ElementType>(layers, NoPadding(), { size, size, outputChannels }, NoPadding(), ConvolutionalParameters{ 1, 1, ConvolutionMethod::unrolled, 1 }, GetRandomTensor<TensorType>(outputChannels, 1, channels));
+        AddLayer<BiasLayer<ElementType>, ElementType>(layers, NoPadding(), { size, size, outputChannels }, NoPadding(), GetRandomVector<VectorType>(outputChannels));
+        auto outputPadding = isLastBlock ? NoPadding() : ZeroPadding(1);
+        auto outputSize = isLastBlock ? size : size + 2;
+        AddLayer<ActivationLayer<ElementType>, ElementType>(layers, NoPadding(), { outputSize, outputSize, outputChannels }, outputPadding, new ReLUActivation<ElementType>());
+        channels = outputChannels;
+    }
+
+    // Global average pooling, dense layer to 10 classes, softmax
+    AddLayer<PoolingLayer<ElementType, MeanPoolingFunction>, ElementType>(layers, NoPadding(), { 1, 1, channels }, NoPadding(), PoolingParameters{ size, size });
+    AddLayer<FullyConnectedLayer<ElementType>, ElementType>(layers, NoPadding(), { 1, 1, 10 }, NoPadding(), GetRandomMatrix<MatrixType>(10, channels));
+    AddLayer<SoftmaxLayer<ElementType>, ElementType>(layers, NoPadding(), { 1, 1, 10 }, NoPadding());
+
+    return CreateNeuralNetworkMap<ElementType>(std::move(inputLayer), std::move(layers));
+}
+
+model::Map GenerateLSTMSpeechModel()
+{
+    using ElementType = float;
+
+    // One frame of 40 filter bank features at a time, an LSTM with 128 hidden units, and a dense layer to 12 keywords
+    const size_t numFeatures = 40;
+    const size_t hiddenUnits = 128;
+    const size_t numKeywords = 12;
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<ElementType>>(numFeatures);
+    auto resetTriggerNode = model.AddNode<nodes::ConstantNode<int>>(0);
+    auto inputWeightsNode = model.AddNode<nodes::ConstantNode<ElementType>>(GetRandomVector<std::vector<ElementType>>(4 * hiddenUnits * numFeatures));
+    auto hiddenWeightsNode = model.AddNode<nodes::ConstantNode<ElementType>>(GetRandomVector<std::vector<ElementType>>(4 * hiddenUnits * hiddenUnits));
+    auto inputBiasNode = model.AddNode<nodes::ConstantNode<ElementType>>(GetRandomVector<std::vector<ElementType>>(4 * hiddenUnits));
+    auto hiddenBiasNode = model.AddNode<nodes::ConstantNode<ElementType>>(GetRandomVector<std::vector<ElementType>>(4 * hiddenUnits));
+    auto lstmNode = model.AddNode<nodes::LSTMNode<ElementType>>(inputNode->output, resetTriggerNode->output, hiddenUnits, inputWeightsNode->output, hiddenWeightsNode->output, inputBiasNode->output, hiddenBiasNode->output, Activation<ElementType>(new TanhActivation<ElementType>()), Activation<ElementType>(new SigmoidActivation<ElementType>()));
+
+    auto denseWeights = GetRandomMatrix<math::RowMatrix<ElementType>>(numKeywords, hiddenUnits);
+    auto denseNode = model.AddNode<nodes::MatrixVectorProductNode<ElementType, math::MatrixLayout::rowMajor>>(lstmNode->output, denseWeights);
+    return model::Map(model, { { "input", inputNode } }, { { "output", denseNode->output } });
+}
+
+model::Map GenerateProtoNNModel()
+{
+    // 64 features projected to 16 dimensions, 32 prototypes, 10 labels
+    predictors::ProtoNNPredictor protoNN(64, 16, 32, 10, 0.5);
+    Uniform<double> rand(-1, 1);
+    protoNN.GetProjectionMatrix().Generate(rand);
+    protoNN.GetPrototypes().Generate(rand);
+    protoNN.GetLabelEmbeddings().Generate(rand);
+
+    model::Model model;
+    auto inputNode = model.AddNode<model::InputNode<double>>(64);
+    auto protoNNNode = model.AddNode<nodes::ProtoNNPredictorNode>(inputNode->output, protoNN);
+    return model::Map(model, { { "input", inputNode } }, { { "output", protoNNNode->output } });
+}
+
+std::vector<std::pair<std::string, model::Map>> GenerateModelZoo()
+{
+    std::vector<std::pair<std::string, model::Map>> models;
+    models.emplace_back("small_cnn", GenerateSmallCNNModel());
+    models.emplace_back("mobilenet_blocks", GenerateMobileNetBlocksModel());
+    models.emplace_back("lstm_speech", GenerateLSTMSpeechModel());
+    models.emplace_back("forest", GenerateTreeModel(127));
+    models.emplace_back("protonn", GenerateProtoNNModel());
+    return models;
+}
+
 } // namespace ell
@@ -34,6 +34,11 @@ void SaveModels()
     common::SaveMap(GenerateConvolutionModel(128, 128, 64, 64, 3, 1, dsp::ConvolutionMethodOption::simple), "simple_128x128x64x64.ell");
     common::SaveMap(GenerateConvolutionModel(128, 128, 64, 64, 3, 1, dsp::ConvolutionMethodOption::unrolled), "unrolled_128x128x64x64.ell");
     common::SaveMap(GenerateConvolutionModel(128, 128, 64, 64, 3, 1, dsp::ConvolutionMethodOption::winograd), "winograd_128x128x64x64.ell");
+
+    for (const auto& [name, map] : GenerateModelZoo())
+    {
+        common::SaveMap(map, "zoo_" + name + ".ell");
+    }
 }
 
 int main(int argc, char* argv[])
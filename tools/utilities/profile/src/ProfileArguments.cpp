@@ -35,6 +35,13 @@ void ParsedProfileArguments::AddArgs(utilities::CommandLineParser& parser)
         "",
         "<cout>");
 
+    parser.AddOption(
+        traceOutputFilename,
+        "traceOutput",
+        "",
+        "File for a Chrome trace (JSON) timeline of the profiled iterations (blank for no trace)",
+        "");
+
     parser.AddOption(
         outputFormat,
         "format",
@@ -9,6 +9,7 @@
 #include "ProfileReport.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <iomanip>
 #include <ostream>
@@ -16,6 +17,89 @@
 #include <string>
 #include <vector>
 
+namespace
+{
+// Achieved rates, from the static operation and byte estimates accumulated in the counters
+double GetGigaOpsPerSecond(const ELL_PerformanceCounters& counters)
+{
+    return counters.totalTime > 0 ? counters.totalOperations / (counters.totalTime * 1.0e6) : 0.0;
+}
+
+double GetGigabytesPerSecond(const ELL_PerformanceCounters& counters)
+{
+    return counters.totalTime > 0 ? (counters.totalBytesRead + counters.totalBytesWritten) / (counters.totalTime * 1.0e6) : 0.0;
+}
+
+// Operations per byte moved, the x-axis of a roofline plot
+double GetArithmeticIntensity(const ELL_PerformanceCounters& counters)
+{
+    auto totalBytes = counters.totalBytesRead + counters.totalBytesWritten;
+    return totalBytes > 0 ? counters.totalOperations / totalBytes : 0.0;
+}
+
+void WriteJSONThroughput(const ELL_PerformanceCounters& counters, const std::string& indent, std::ostream& out)
+{
+    out << indent << "\"total_operations\": " << counters.totalOperations << ",\n";
+    out << indent << "\"total_bytes_read\": " << counters.totalBytesRead << ",\n";
+    out << indent << "\"total_bytes_written\": " << counters.totalBytesWritten << ",\n";
+    out << indent << "\"gflops\": " << GetGigaOpsPerSecond(counters) << ",\n";
+    out << indent << "\"gbytes_per_second\": " << GetGigabytesPerSecond(counters) << ",\n";
+    out << indent << "\"arithmetic_intensity\": " << GetArithmeticIntensity(counters) << ",\n";
+}
+
+// The hardware counters are all zero unless the model was compiled with the `profileHardwareCounters` option
+// (or the target lets user code read none of them), in which case we leave them out of the report
+template <typename CountersType>
+bool HasHardwareCounters(const CountersType& counters)
+{
+    return counters.cycles != 0 || counters.instructions != 0 || counters.l1DataCacheMisses != 0 || counters.lastLevelCacheMisses != 0 || counters.branchMisses != 0;
+}
+
+template <typename CountersType>
+double GetInstructionsPerCycle(const CountersType& counters)
+{
+    return counters.cycles > 0 ? static_cast<double>(counters.instructions) / counters.cycles : 0.0;
+}
+
+template <typename CountersType>
+void WriteTextHardwareCounters(const CountersType& counters, std::ostream& out)
+{
+    if (HasHardwareCounters(counters))
+    {
+        out << "\tcycles: " << counters.cycles << "\tinstructions: " << counters.instructions << "\tIPC: " << GetInstructionsPerCycle(counters)
+            << "\tL1D misses: " << counters.l1DataCacheMisses << "\tLLC misses: " << counters.lastLevelCacheMisses << "\tbranch misses: " << counters.branchMisses;
+    }
+}
+
+template <typename CountersType>
+void WriteJSONHardwareCounters(const CountersType& counters, const std::string& indent, std::ostream& out)
+{
+    if (HasHardwareCounters(counters))
+    {
+        out << indent << "\"cycles\": " << counters.cycles << ",\n";
+        out << indent << "\"instructions\": " << counters.instructions << ",\n";
+        out << indent << "\"instructions_per_cycle\": " << GetInstructionsPerCycle(counters) << ",\n";
+        out << indent << "\"l1d_cache_misses\": " << counters.l1DataCacheMisses << ",\n";
+        out << indent << "\"llc_misses\": " << counters.lastLevelCacheMisses << ",\n";
+        out << indent << "\"branch_misses\": " << counters.branchMisses << ",\n";
+    }
+}
+
+void WriteTextLatency(const ELL_LatencyStatistics& latency, std::ostream& out)
+{
+    out << "count: " << latency.count << "\tp50: " << latency.p50 << " ms\tp90: " << latency.p90 << " ms\tp99: " << latency.p99 << " ms\tmax: " << latency.maxTime << " ms";
+}
+
+void WriteJSONLatency(const ELL_LatencyStatistics& latency, const std::string& indent, std::ostream& out)
+{
+    out << indent << "\"p50_time\": " << latency.p50 << ",\n";
+    out << indent << "\"p90_time\": " << latency.p90 << ",\n";
+    out << indent << "\"p99_time\": " << latency.p99 << ",\n";
+    out << indent << "\"max_time\": " << latency.maxTime << ",\n";
+    out << indent << "\"count\": " << latency.count << "\n";
+}
+} // namespace
+
 // Characters that must be escaped in JSON strings: ', ", \, newline (\n), carriage return (\r), tab (\t), backspace (\b), form feed (\f)
 std::string EncodeJSONString(const std::string& str)
 {
@@ -60,6 +144,20 @@ void WriteUserComment(const std::string& comment, ProfileOutputFormat format, st
     }
 }
 
+void WriteMemoryPlacement(bool useHugePages, bool hugePageWeights, bool firstTouchBuffers, ProfileOutputFormat format, std::ostream& out)
+{
+    if (format == ProfileOutputFormat::text)
+    {
+        out << "Huge pages: " << (useHugePages ? "on" : "off") << "\thuge-page weights: " << (hugePageWeights ? "on" : "off") << "\tfirst-touch buffers: " << (firstTouchBuffers ? "on" : "off") << "\n";
+    }
+    else // json
+    {
+        out << "\"huge_pages\": " << (useHugePages ? "true" : "false") << ",\n";
+        out << "\"huge_page_weights\": " << (hugePageWeights ? "true" : "false") << ",\n";
+        out << "\"first_touch_buffers\": " << (firstTouchBuffers ? "true" : "false") << "\n";
+    }
+}
+
 void WriteModelStatistics(const ELL_PerformanceCounters* modelStats, ProfileOutputFormat format, std::ostream& out)
 {
     if (format == ProfileOutputFormat::text)
@@ -74,6 +172,13 @@ void WriteModelStatistics(const ELL_PerformanceCounters* modelStats, ProfileOutp
 
         out << "\nModel statistics" << std::endl;
         out << "Total time: " << totalTime << " ms \tcount: " << count << "\t time per run: " << timePerRun << " ms" << std::endl;
+        out << "GFLOP/s: " << GetGigaOpsPerSecond(*modelStats) << "\tGB/s: " << GetGigabytesPerSecond(*modelStats) << "\tops/byte: " << GetArithmeticIntensity(*modelStats) << std::endl;
+        if (HasHardwareCounters(*modelStats))
+        {
+            out << "Hardware counters:";
+            WriteTextHardwareCounters(*modelStats, out);
+            out << std::endl;
+        }
 
         out.flags(savedFlags);
     }
@@ -86,6 +191,8 @@ void WriteModelStatistics(const ELL_PerformanceCounters* modelStats, ProfileOutp
         out << "\"model_statistics\": {\n";
         out << "  \"total_time\": " << totalTime << ",\n";
         out << "  \"average_time\": " << timePerRun << ",\n";
+        WriteJSONThroughput(*modelStats, "  ", out);
+        WriteJSONHardwareCounters(*modelStats, "  ", out);
         out << "  \"count\": " << count << "\n";
         out << "}";
     }
@@ -110,14 +217,21 @@ void WriteNodeStatistics(std::vector<std::pair<ELL_NodeInfo, ELL_PerformanceCoun
         out << "Node statistics" << std::endl;
         for (const auto& info : nodeInfo)
         {
-            out << "Node[" << info.first.nodeName << "]:\t" << std::setw(maxTypeLength) << std::left << info.first.nodeType << "\ttime: " << info.second.totalTime << " ms\tcount: " << info.second.count << "\n";
+            out << "Node[" << info.first.nodeName << "]:\t" << std::setw(maxTypeLength) << std::left << info.first.nodeType << "\ttime: " << info.second.totalTime << " ms\tcount: " << info.second.count
+                << "\tops: " << info.first.operationCount << "\tbytes read: " << info.first.bytesRead << "\tbytes written: " << info.first.bytesWritten
+                << "\tGFLOP/s: " << GetGigaOpsPerSecond(info.second) << "\tGB/s: " << GetGigabytesPerSecond(info.second) << "\tops/byte: " << GetArithmeticIntensity(info.second);
+            WriteTextHardwareCounters(info.second, out);
+            out << "\n";
         }
 
         out << "\n\n";
         out << "Node type statistics" << std::endl;
         for (const auto& info : nodeTypeInfo)
         {
-            out << std::setw(maxTypeLength) << std::left << info.first.nodeType << "\ttime: " << info.second.totalTime << " ms \tcount: " << info.second.count << "\n";
+            out << std::setw(maxTypeLength) << std::left << info.first.nodeType << "\ttime: " << info.second.totalTime << " ms \tcount: " << info.second.count
+                << "\tGFLOP/s: " << GetGigaOpsPerSecond(info.second) << "\tGB/s: " << GetGigabytesPerSecond(info.second) << "\tops/byte: " << GetArithmeticIntensity(info.second);
+            WriteTextHardwareCounters(info.second, out);
+            out << "\n";
         }
 
         out.flags(savedFlags);
@@ -134,6 +248,11 @@ void WriteNodeStatistics(std::vector<std::pair<ELL_NodeInfo, ELL_PerformanceCoun
                 << "\"" << EncodeJSONString((const char*)(info.first.nodeType)) << "\",\n";
             out << "    \"total_time\": " << info.second.totalTime << ",\n";
             out << "    \"average_time\": " << info.second.totalTime / info.second.count << ",\n";
+            out << "    \"operations\": " << info.first.operationCount << ",\n";
+            out << "    \"bytes_read\": " << info.first.bytesRead << ",\n";
+            out << "    \"bytes_written\": " << info.first.bytesWritten << ",\n";
+            WriteJSONThroughput(info.second, "    ", out);
+            WriteJSONHardwareCounters(info.second, "    ", out);
             out << "    \"count\": " << info.second.count << "\n";
             out << "  }";
             bool isLast = (&info == &nodeInfo.back());
@@ -146,7 +265,6 @@ void WriteNodeStatistics(std::vector<std::pair<ELL_NodeInfo, ELL_PerformanceCoun
         out << "],\n";
 
         out << "\"node_type_statistics\": [\n";
-        out << "  [";
         for (const auto& info : nodeTypeInfo)
         {
             out << "  {\n";
@@ -154,6 +272,8 @@ void WriteNodeStatistics(std::vector<std::pair<ELL_NodeInfo, ELL_PerformanceCoun
                 << "\"" << EncodeJSONString((const char*)(info.first.nodeType)) << "\",\n";
             out << "    \"total_time\": " << info.second.totalTime << ",\n";
             out << "    \"average_time\": " << info.second.totalTime / info.second.count << ",\n";
+            WriteJSONThroughput(info.second, "    ", out);
+            WriteJSONHardwareCounters(info.second, "    ", out);
             out << "    \"count\": " << info.second.count << "\n";
             out << "  }";
             bool isLast = (&info == &nodeTypeInfo.back());
@@ -188,7 +308,9 @@ void WriteRegionStatistics(std::vector<ELL_ProfileRegionInfo>& regions, ProfileO
             out << "\nRegion statistics" << std::endl;
             for (const auto& info : regions)
             {
-                out << "Region[" << info.name << "]:\t" << std::setw(maxNameLength) << std::left << "\ttime: " << info.totalTime << " ms\tcount: " << info.count << "\n";
+                out << "Region[" << info.name << "]:\t" << std::setw(maxNameLength) << std::left << "\ttime: " << info.totalTime << " ms\tcount: " << info.count;
+                WriteTextHardwareCounters(info, out);
+                out << "\n";
             }
 
             out << "\n\n";
@@ -205,6 +327,7 @@ void WriteRegionStatistics(std::vector<ELL_ProfileRegionInfo>& regions, ProfileO
                 << "\"" << EncodeJSONString((const char*)(info.name)) << "\",\n";
             out << "    \"total_time\": " << info.totalTime << ",\n";
             out << "    \"average_time\": " << info.totalTime / info.count << ",\n";
+            WriteJSONHardwareCounters(info, "    ", out);
             out << "    \"count\": " << info.count << "\n";
             out << "  }";
             bool isLast = (&info == &regions.back());
@@ -218,6 +341,118 @@ void WriteRegionStatistics(std::vector<ELL_ProfileRegionInfo>& regions, ProfileO
     }
 }
 
+void WriteLatencyStatistics(const ELL_LatencyStatistics* modelLatency, std::vector<std::pair<ELL_NodeInfo, ELL_LatencyStatistics>>& nodeLatency, ProfileOutputFormat format, std::ostream& out)
+{
+    if (format == ProfileOutputFormat::text)
+    {
+        if (modelLatency->count > 0)
+        {
+            std::ios::fmtflags savedFlags(out.flags());
+            out << std::fixed;
+            out.precision(5);
+
+            size_t maxTypeLength = 0;
+            for (const auto& info : nodeLatency)
+            {
+                maxTypeLength = std::max(maxTypeLength, std::strlen((const char*)(info.first.nodeType)));
+            }
+
+            out << "\nLatency statistics" << std::endl;
+            out << "Model:\t";
+            WriteTextLatency(*modelLatency, out);
+            out << "\n";
+            for (const auto& info : nodeLatency)
+            {
+                out << "Node[" << info.first.nodeName << "]:\t" << std::setw(maxTypeLength) << std::left << info.first.nodeType << "\t";
+                WriteTextLatency(info.second, out);
+                out << "\n";
+            }
+
+            out.flags(savedFlags);
+        }
+    }
+    else // json
+    {
+        out << "\"latency_statistics\": {\n";
+        out << "  \"model\": {\n";
+        WriteJSONLatency(*modelLatency, "    ", out);
+        out << "  },\n";
+        out << "  \"nodes\": [\n";
+        for (const auto& info : nodeLatency)
+        {
+            out << "    {\n";
+            out << "      \"name\": "
+                << "\"" << EncodeJSONString((const char*)(info.first.nodeName)) << "\",\n";
+            out << "      \"type\": "
+                << "\"" << EncodeJSONString((const char*)(info.first.nodeType)) << "\",\n";
+            WriteJSONLatency(info.second, "      ", out);
+            out << "    }";
+            bool isLast = (&info == &nodeLatency.back());
+            if (!isLast)
+            {
+                out << ",";
+            }
+            out << "\n";
+        }
+        out << "  ]\n";
+        out << "}";
+    }
+}
+
+void WriteTimingStatistics(const std::vector<double>& iterationTimes, int batchSize, ProfileOutputFormat format, std::ostream& out)
+{
+    std::vector<double> times;
+    for (auto time : iterationTimes)
+    {
+        times.push_back(time / std::max(batchSize, 1));
+    }
+    std::sort(times.begin(), times.end());
+
+    double mean = 0;
+    double variance = 0;
+    if (!times.empty())
+    {
+        for (auto time : times)
+        {
+            mean += time;
+        }
+        mean /= times.size();
+        for (auto time : times)
+        {
+            variance += (time - mean) * (time - mean);
+        }
+        variance /= times.size();
+    }
+    double minTime = times.empty() ? 0 : times.front();
+    double maxTime = times.empty() ? 0 : times.back();
+    double median = times.empty() ? 0 : (times[(times.size() - 1) / 2] + times[times.size() / 2]) / 2;
+
+    if (format == ProfileOutputFormat::text)
+    {
+        std::ios::fmtflags savedFlags(out.flags());
+        out << std::fixed;
+        out.precision(5);
+
+        out << "\nTiming statistics" << std::endl;
+        out << "Iterations: " << times.size() << "\tbatch size: " << batchSize << std::endl;
+        out << "Time per run: mean: " << mean << " ms\tmedian: " << median << " ms\tmin: " << minTime << " ms\tmax: " << maxTime << " ms\tstddev: " << std::sqrt(variance) << " ms" << std::endl;
+
+        out.flags(savedFlags);
+    }
+    else // json
+    {
+        out << "\"timing_statistics\": {\n";
+        out << "  \"iterations\": " << times.size() << ",\n";
+        out << "  \"batch_size\": " << batchSize << ",\n";
+        out << "  \"average_time\": " << mean << ",\n";
+        out << "  \"median_time\": " << median << ",\n";
+        out << "  \"min_time\": " << minTime << ",\n";
+        out << "  \"max_time\": " << maxTime << ",\n";
+        out << "  \"stddev_time\": " << std::sqrt(variance) << "\n";
+        out << "}";
+    }
+}
+
 void fun()
 {
     // this hack allows us to resolve printf which is used by compiled_model.o
@@ -30,6 +30,7 @@
 #include <utilities/include/Files.h>
 #include <utilities/include/MillisecondTimer.h>
 #include <utilities/include/OutputStreamImpostor.h>
+#include <utilities/include/PoolAllocator.h>
 #include <utilities/include/RandomEngines.h>
 #include <utilities/include/TypeName.h>
 #include <utilities/include/Unused.h>
@@ -171,6 +172,17 @@ void WriteRegionStatistics(model::IRCompiledMap& map, ProfileOutputFormat format
     WriteRegionStatistics(regions, format, out);
 }
 
+void WriteLatencyStatistics(model::IRCompiledMap& map, ProfileOutputFormat format, std::ostream& out)
+{
+    std::vector<std::pair<model::NodeInfo, model::LatencyStatistics>> nodeLatency;
+    auto numNodes = map.GetNumProfiledNodes();
+    for (int index = 0; index < numNodes; ++index)
+    {
+        nodeLatency.emplace_back(*map.GetNodeInfo(index), *map.GetNodeLatencyStatistics(index));
+    }
+    WriteLatencyStatistics(map.GetModelLatencyStatistics(), nodeLatency, format, out);
+}
+
 void WriteTimingDetail(std::ostream& timingOutputStream, ProfileOutputFormat format, const std::vector<std::vector<double>>& nodeTimings)
 {
     std::string beginArray = "";
@@ -273,13 +285,15 @@ void TimeModel(model::Map& map, const std::vector<InputType>& input, const Profi
         outputStream << "Num iterations: " << profileArguments.numIterations << std::endl;
         outputStream << "Total time: " << totalTime << " ms" << std::endl;
         outputStream << "Average time: " << totalTime / profileArguments.numIterations << " ms" << std::endl;
+        WriteMemoryPlacement(settings.compilerSettings.useHugePages, utilities::GetPoolHugePages(), settings.compilerSettings.firstTouchBuffers, profileArguments.outputFormat, outputStream);
     }
     else // json
     {
         outputStream << "{\n";
         outputStream << "\"total_time\": " << totalTime << ",\n";
         outputStream << "\"average_time\": " << totalTime / profileArguments.numIterations << ",\n";
-        outputStream << "\"count\": " << profileArguments.numIterations << "\n";
+        outputStream << "\"count\": " << profileArguments.numIterations << ",\n";
+        WriteMemoryPlacement(settings.compilerSettings.useHugePages, utilities::GetPoolHugePages(), settings.compilerSettings.firstTouchBuffers, profileArguments.outputFormat, outputStream);
         outputStream << "}\n";
     }
 }
@@ -312,6 +326,11 @@ void ProfileModel(model::Map& map, const ProfileArguments& profileArguments, con
     model::MapCompilerOptions settings = mapCompilerArguments.GetMapCompilerOptions("");
     settings.profile = true;
     settings.compilerSettings.profile = true;
+    const bool writeTrace = !profileArguments.traceOutputFilename.empty();
+    if (writeTrace)
+    {
+        settings.compilerSettings.traceExecution = true;
+    }
     model::ModelOptimizerOptions optimizerOptions;
     optimizerOptions["fuseLinearFunctionNodes"] = true;
     model::IRMapCompiler compiler(settings, optimizerOptions);
@@ -329,6 +348,10 @@ void ProfileModel(model::Map& map, const ProfileArguments& profileArguments, con
 
     // Warm up the system by evaluating the model some number of times
     WarmUpModel<InputType, OutputType>(compiledMap, input, profileArguments.numBurnInIterations, true);
+    if (writeTrace)
+    {
+        compiledMap.ResetProfileTrace();
+    }
 
     // Now evaluate the model and record the profiling info
     for (int iter = 0; iter < profileArguments.numIterations; ++iter)
@@ -353,6 +376,11 @@ void ProfileModel(model::Map& map, const ProfileArguments& profileArguments, con
         WriteTimingDetail(timingOutputStream, format, nodeTimings);
     }
 
+    if (writeTrace && !compiledMap.WriteProfileTrace(profileArguments.traceOutputFilename))
+    {
+        std::cerr << "Couldn't write trace file " << profileArguments.traceOutputFilename << std::endl;
+    }
+
     // print profile info
     if (format == ProfileOutputFormat::text)
     {
@@ -360,9 +388,11 @@ void ProfileModel(model::Map& map, const ProfileArguments& profileArguments, con
         {
             WriteUserComment(comment, format, profileOutputStream);
         }
+        WriteMemoryPlacement(settings.compilerSettings.useHugePages, utilities::GetPoolHugePages(), settings.compilerSettings.firstTouchBuffers, format, profileOutputStream);
         WriteNodeStatistics(compiledMap, format, profileOutputStream);
         WriteRegionStatistics(compiledMap, format, profileOutputStream);
         WriteModelStatistics(compiledMap, format, profileOutputStream);
+        WriteLatencyStatistics(compiledMap, format, profileOutputStream);
     }
     else
     {
@@ -372,11 +402,15 @@ void ProfileModel(model::Map& map, const ProfileArguments& profileArguments, con
             WriteUserComment(comment, format, profileOutputStream);
             profileOutputStream << ",\n";
         }
+        WriteMemoryPlacement(settings.compilerSettings.useHugePages, utilities::GetPoolHugePages(), settings.compilerSettings.firstTouchBuffers, format, profileOutputStream);
+        profileOutputStream << ",\n";
         WriteNodeStatistics(compiledMap, format, profileOutputStream);
         profileOutputStream << ",\n";
         WriteRegionStatistics(compiledMap, format, profileOutputStream);
         profileOutputStream << ",\n";
         WriteModelStatistics(compiledMap, format, profileOutputStream);
+        profileOutputStream << ",\n";
+        WriteLatencyStatistics(compiledMap, format, profileOutputStream);
         profileOutputStream << "}\n";
     }
 }
@@ -452,9 +486,16 @@ int main(int argc, char* argv[])
             return 0;
         }
 
+#ifdef ELL_USE_POOL_ALLOCATOR
+        // Math library storage comes from the pool allocator in this build, so large allocations, like the weights of
+        // the loaded model, use huge pages along with the compiled model's buffers
+        utilities::SetPoolHugePages(compileArguments.useHugePages);
+#endif
+
         // load map file
         auto map = common::LoadMap(mapLoadArguments);
         ProfileModel(map, profileArguments, compileArguments, commandLineParser.GetPassthroughArgs());
+        mapLoadArguments.WriteTimingReport();
     }
     catch (const utilities::CommandLineParserPrintHelpException& exception)
     {
@@ -165,6 +165,8 @@ class EllBuildTools:
             return common + ["-mtriple=arm-linux-gnueabihf", "-mcpu=arm1176jzf-s", "-relocation-model=pic"]
         elif target == "aarch64" or target == "pi3_64":  # arm64 Linux
             return common + ["-mtriple=aarch64-unknown-linux-gnu", "-relocation-model=pic"]
+        elif target == "wasm32":  # WebAssembly, with 128-bit SIMD
+            return common + ["-mtriple=wasm32-unknown-unknown", "-mattr=+simd128", "-relocation-model=static"]
         else:  # host
             return common + ["-relocation-model=pic"]
 
@@ -246,6 +248,8 @@ class EllBuildTools:
         hasBlas = bool(use_blas)
         if target == "host" and hasBlas and not self.blas:
             hasBlas = False
+        if target == "wasm32":
+            hasBlas = False
         args.append(str(hasBlas).lower())
 
         if not optimize:
@@ -111,9 +111,15 @@ have you compiled this project yet?")
         if hasattr(self.compiled_module, self.model_name + "_PrintModelProfilingInfo"):
             getattr(self.compiled_module, self.model_name + "_PrintModelProfilingInfo")()
 
+        # latency percentiles are only printed if the model was compiled with --profileLatencyHistograms
+        if hasattr(self.compiled_module, self.model_name + "_PrintModelLatencyInfo"):
+            getattr(self.compiled_module, self.model_name + "_PrintModelLatencyInfo")()
+
         if node_level:
             if hasattr(self.compiled_module, self.model_name + "_PrintNodeProfilingInfo"):
                 getattr(self.compiled_module, self.model_name + "_PrintNodeProfilingInfo")()
+            if hasattr(self.compiled_module, self.model_name + "_PrintNodeLatencyInfo"):
+                getattr(self.compiled_module, self.model_name + "_PrintNodeLatencyInfo")()
 
 
 class ReferenceModel(EllModel):
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+####################################################################################################
+#
+#  Project:  Embedded Learning Library (ELL)
+#  File:     benchmark_client.py
+#  Authors:  ELL contributors
+#
+#  Requires: Python 3.x
+#
+####################################################################################################
+
+import argparse
+import json
+import os
+import socket
+
+
+class BenchmarkClient:
+    """ Sends compiled models to a benchmarkServer running on a target device and returns the profile reports.
+        The connection is kept open, so each measurement only costs sending the model and running it. The token is
+        the one the server printed or was started with; it defaults to the ELL_BENCHMARK_TOKEN environment variable. """
+
+    def __init__(self, host, port=8765, timeout=300, token=None):
+        token = token or os.environ.get("ELL_BENCHMARK_TOKEN")
+        if not token:
+            raise ValueError("The benchmark server needs a token; pass one or set ELL_BENCHMARK_TOKEN")
+        self.socket = socket.create_connection((host, port), timeout=timeout)
+        self.reader = self.socket.makefile("rb")
+        self.socket.sendall("AUTH {}\n".format(token).encode("utf-8"))
+        self._read_response()
+
+    def close(self):
+        try:
+            self.socket.sendall(b"QUIT\n")
+        finally:
+            self.reader.close()
+            self.socket.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+    def ping(self):
+        self.socket.sendall(b"PING\n")
+        self._read_response()
+
+    def benchmark(self, library_path, module_name="model", function_name=None, warmup=10, iterations=20,
+                  batch_size=1, input_type="float", output_format="json", comment=None):
+        """ Benchmarks a compiled model. `library_path` is a shared library, or an object file the server links into
+            one. Returns the report as a dictionary for the json format, or as a string for the text format. """
+        with open(library_path, "rb") as f:
+            contents = f.read()
+
+        request = "BENCHMARK module={} size={} warmup={} iterations={} batch={} input={} format={}".format(
+            module_name, len(contents), warmup, iterations, batch_size, input_type, output_format)
+        if function_name:
+            request += " function={}".format(function_name)
+        if comment:
+            request += " comment={}".format(comment.replace("\n", " "))
+        self.socket.sendall(request.encode("utf-8") + b"\n" + contents)
+
+        report = self._read_response().decode("utf-8")
+        return json.loads(report) if output_format == "json" else report
+
+    def shutdown(self):
+        """ Stops the server """
+        self.socket.sendall(b"SHUTDOWN\n")
+        self._read_response()
+
+    def _read_response(self):
+        header = self.reader.readline().decode("utf-8").rstrip("\n")
+        if header.startswith("ERROR"):
+            raise RuntimeError("Benchmark server error: {}".format(header[len("ERROR "):]))
+        if not header.startswith("OK "):
+            raise RuntimeError("Unexpected response from benchmark server: {}".format(header))
+        size = int(header[len("OK "):])
+        return self.reader.read(size)
+
+
+if __name__ == "__main__":
+    arg_parser = argparse.ArgumentParser(description="Benchmarks a compiled model on a device running benchmarkServer")
+    arg_parser.add_argument("host", help="the address of the server, usually localhost through an SSH tunnel")
+    arg_parser.add_argument("library", help="the compiled model, as a shared library or an object file")
+    arg_parser.add_argument("--port", type=int, help="the port the server listens on (default 8765)", default=8765)
+    arg_parser.add_argument("--token", help="the server's token (default: the ELL_BENCHMARK_TOKEN environment variable)")
+    arg_parser.add_argument("--module", help="the module name the model was compiled with (default 'model')",
+                            default="model")
+    arg_parser.add_argument("--function", help="the predict function (default '<module>_Predict')")
+    arg_parser.add_argument("--warmup", type=int, help="the number of warm-up iterations (default 10)", default=10)
+    arg_parser.add_argument("--iterations", type=int, help="the number of timed iterations (default 20)", default=20)
+    arg_parser.add_argument("--batch_size", type=int, help="the number of predictions per timed iteration (default 1)",
+                            default=1)
+    arg_parser.add_argument("--input_type", choices=["float", "double"], default="float",
+                            help="the element type of the model's input and output (default float)")
+    arg_parser.add_argument("--format", choices=["text", "json"], default="text", help="the report format")
+    args = arg_parser.parse_args()
+
+    with BenchmarkClient(args.host, args.port, token=args.token) as client:
+        report = client.benchmark(args.library, args.module, args.function, args.warmup, args.iterations,
+                                  args.batch_size, args.input_type, args.format)
+        print(json.dumps(report, indent=2) if args.format == "json" else report)
@@ -0,0 +1,390 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ModelServer.h (serve)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <model/include/IRCompiledMap.h>
+
+#include <utilities/include/Exception.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ell
+{
+/// <summary> A histogram of latencies with 4 log-scale buckets per power of two, from which it reads percentiles. </summary>
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    /// <summary> Counts a latency. </summary>
+    ///
+    /// <param name="time"> The latency, in milliseconds. </param>
+    void Add(double time);
+
+    /// <summary> Adds the counts of another histogram to this one. </summary>
+    void Add(const LatencyHistogram& other);
+
+    /// <summary> Gets a percentile of the latencies counted: the upper bound of the bucket it falls in, which is at most 19% high, or the maximum if that is less. </summary>
+    ///
+    /// <param name="percentile"> The percentile, in [0, 1]. </param>
+    ///
+    /// <returns> The latency, in milliseconds, or 0 if the histogram is empty. </returns>
+    double GetPercentile(double percentile) const;
+
+    /// <summary> Gets the number of latencies counted. </summary>
+    int64_t GetCount() const { return _count; }
+
+    /// <summary> Gets the mean of the latencies counted. </summary>
+    double GetMean() const { return _count > 0 ? _total / _count : 0.0; }
+
+    /// <summary> Gets the largest latency counted. </summary>
+    double GetMax() const { return _max; }
+
+private:
+    std::vector<int64_t> _buckets;
+    int64_t _count = 0;
+    double _total = 0;
+    double _max = 0;
+};
+
+/// <summary> The options of a ModelServer. </summary>
+struct ModelServerOptions
+{
+    /// <summary> The number of worker threads, each with its own execution context for the model. 0 means one per core. </summary>
+    int numWorkers = 0;
+
+    /// <summary> The largest number of requests a worker evaluates in one batch. </summary>
+    int maxBatchSize = 8;
+
+    /// <summary> How long, in milliseconds, the oldest request of a batch may wait for the batch to fill before it is evaluated. </summary>
+    double maxBatchDelay = 1.0;
+
+    /// <summary> The number of requests that may wait in the queue. Requests submitted to a full queue are rejected. 0 means no limit. </summary>
+    int maxQueueSize = 1024;
+};
+
+/// <summary> A snapshot of the metrics of a ModelServer, since it started or since its metrics were last reset. </summary>
+struct ModelServerMetrics
+{
+    /// <summary> The time the metrics cover, in seconds. </summary>
+    double elapsedTime = 0;
+
+    /// <summary> The number of requests evaluated. </summary>
+    int64_t numCompleted = 0;
+
+    /// <summary> The number of requests rejected because the queue was full. </summary>
+    int64_t numRejected = 0;
+
+    /// <summary> The number of batches evaluated. </summary>
+    int64_t numBatches = 0;
+
+    /// <summary> The number of requests waiting in the queue now. </summary>
+    int64_t queueDepth = 0;
+
+    /// <summary> The largest number of requests that waited in the queue. </summary>
+    int64_t maxQueueDepth = 0;
+
+    /// <summary> The time from submitting a request until its result is ready, in milliseconds. </summary>
+    LatencyHistogram latency;
+
+    /// <summary> The time requests waited in the queue, in milliseconds. </summary>
+    LatencyHistogram queueTime;
+
+    /// <summary> The time evaluating each batch took, in milliseconds. </summary>
+    LatencyHistogram batchTime;
+
+    /// <summary> Gets the number of requests evaluated per second. </summary>
+    double GetThroughput() const { return elapsedTime > 0 ? numCompleted / elapsedTime : 0.0; }
+
+    /// <summary> Gets the average number of requests evaluated together. </summary>
+    double GetAverageBatchSize() const { return numBatches > 0 ? static_cast<double>(numCompleted) / numBatches : 0.0; }
+};
+
+/// <summary>
+/// Serves a compiled model to many concurrent clients. Submitted requests go into a queue, which a pool of worker
+/// threads drains. Each worker runs its own clone of the map, so the map must be compiled with the `reentrant`
+/// option, and should be compiled with `emitBatchPredictFunction`. A worker takes up to `maxBatchSize` requests at a
+/// time, waiting at most `maxBatchDelay` after the oldest one arrived for the batch to fill, and evaluates them in
+/// one batch call. Each worker keeps the model state of its clone between requests, so models with state should
+/// only be served if that state is meant to be shared by all the requests.
+/// </summary>
+template <typename InputType, typename OutputType>
+class ModelServer
+{
+public:
+    /// <summary> Constructor. Starts the worker threads. </summary>
+    ///
+    /// <param name="compiledMap"> The reentrant compiled map to serve. The server keeps using it, so it must outlive the server. </param>
+    /// <param name="options"> The server options. </param>
+    ModelServer(model::IRCompiledMap& compiledMap, const ModelServerOptions& options);
+
+    ModelServer(const ModelServer&) = delete;
+    ModelServer& operator=(const ModelServer&) = delete;
+
+    /// <summary> Destructor. Evaluates the requests already queued, and stops the worker threads. </summary>
+    ~ModelServer();
+
+    /// <summary> Submits a request. </summary>
+    ///
+    /// <param name="input"> The input of the model. </param>
+    ///
+    /// <returns> A future for the output of the model. If the queue is full or the server is stopped, it holds an exception instead. </returns>
+    std::future<std::vector<OutputType>> Submit(std::vector<InputType> input);
+
+    /// <summary> Evaluates the requests already queued, and stops the worker threads. Requests submitted after this are rejected. </summary>
+    void Stop();
+
+    /// <summary> Gets the number of worker threads. </summary>
+    int GetNumWorkers() const { return static_cast<int>(_workerMaps.size()); }
+
+    /// <summary> Gets a snapshot of the metrics. </summary>
+    ModelServerMetrics GetMetrics() const;
+
+    /// <summary> Resets the metrics, except for the current queue depth. </summary>
+    void ResetMetrics();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Request
+    {
+        std::vector<InputType> input;
+        std::promise<std::vector<OutputType>> output;
+        Clock::time_point submitTime;
+    };
+
+    void RunWorker(model::IRCompiledMap& map);
+    static double GetMilliseconds(Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); }
+
+    ModelServerOptions _options;
+    size_t _inputSize;
+    size_t _outputSize;
+    std::vector<model::IRCompiledMap> _workerMaps;
+    std::vector<std::thread> _workers;
+
+    mutable std::mutex _queueMutex;
+    std::condition_variable _queueNotEmpty;
+    std::deque<Request> _queue;
+    bool _stopping = false;
+
+    mutable std::mutex _metricsMutex;
+    ModelServerMetrics _metrics;
+    Clock::time_point _metricsStartTime;
+};
+} // namespace ell
+
+#pragma region implementation
+
+namespace ell
+{
+template <typename InputType, typename OutputType>
+ModelServer<InputType, OutputType>::ModelServer(model::IRCompiledMap& compiledMap, const ModelServerOptions& options) :
+    _options(options),
+    _inputSize(compiledMap.GetInputSize()),
+    _outputSize(compiledMap.GetOutputSize()),
+    _metricsStartTime(Clock::now())
+{
+    if (!compiledMap.IsReentrant())
+    {
+        throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "ModelServer needs a map compiled with the reentrant option");
+    }
+    if (_options.maxBatchSize < 1 || _options.maxBatchDelay < 0 || _options.maxQueueSize < 0 || _options.numWorkers < 0)
+    {
+        throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Invalid ModelServer options");
+    }
+
+    // Clone the map for every worker before any of them start running it
+    auto numWorkers = _options.numWorkers > 0 ? static_cast<unsigned>(_options.numWorkers) : std::max(std::thread::hardware_concurrency(), 1u);
+    _workerMaps.reserve(numWorkers);
+    for (unsigned workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+    {
+        _workerMaps.push_back(compiledMap.Clone());
+    }
+    for (auto& map : _workerMaps)
+    {
+        _workers.emplace_back([this, &map] { RunWorker(map); });
+    }
+}
+
+template <typename InputType, typename OutputType>
+ModelServer<InputType, OutputType>::~ModelServer()
+{
+    Stop();
+}
+
+template <typename InputType, typename OutputType>
+std::future<std::vector<OutputType>> ModelServer<InputType, OutputType>::Submit(std::vector<InputType> input)
+{
+    if (input.size() != _inputSize)
+    {
+        throw utilities::InputException(utilities::InputExceptionErrors::sizeMismatch, "ModelServer request has the wrong input size");
+    }
+
+    Request request;
+    request.input = std::move(input);
+    request.submitTime = Clock::now();
+    auto result = request.output.get_future();
+
+    int64_t queueDepth = 0;
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        if (_stopping || (_options.maxQueueSize > 0 && _queue.size() >= static_cast<size_t>(_options.maxQueueSize)))
+        {
+            request.output.set_exception(std::make_exception_ptr(utilities::LogicException(utilities::LogicExceptionErrors::illegalState, _stopping ? "ModelServer is stopped" : "ModelServer queue is full")));
+        }
+        else
+        {
+            _queue.push_back(std::move(request));
+            queueDepth = static_cast<int64_t>(_queue.size());
+        }
+    }
+
+    if (queueDepth > 0)
+    {
+        _queueNotEmpty.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(_metricsMutex);
+    if (queueDepth > 0)
+    {
+        _metrics.maxQueueDepth = std::max(_metrics.maxQueueDepth, queueDepth);
+    }
+    else
+    {
+        ++_metrics.numRejected;
+    }
+    return result;
+}
+
+template <typename InputType, typename OutputType>
+void ModelServer<InputType, OutputType>::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        if (_stopping)
+        {
+            return;
+        }
+        _stopping = true;
+    }
+    _queueNotEmpty.notify_all();
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+template <typename InputType, typename OutputType>
+ModelServerMetrics ModelServer<InputType, OutputType>::GetMetrics() const
+{
+    int64_t queueDepth = 0;
+    {
+        std::lock_guard<std::mutex> lock(_queueMutex);
+        queueDepth = static_cast<int64_t>(_queue.size());
+    }
+
+    std::lock_guard<std::mutex> lock(_metricsMutex);
+    auto metrics = _metrics;
+    metrics.elapsedTime = GetMilliseconds(Clock::now() - _metricsStartTime) / 1000.0;
+    metrics.queueDepth = queueDepth;
+    return metrics;
+}
+
+template <typename InputType, typename OutputType>
+void ModelServer<InputType, OutputType>::ResetMetrics()
+{
+    std::lock_guard<std::mutex> lock(_metricsMutex);
+    _metrics = {};
+    _metricsStartTime = Clock::now();
+}
+
+template <typename InputType, typename OutputType>
+void ModelServer<InputType, OutputType>::RunWorker(model::IRCompiledMap& map)
+{
+    const auto maxBatchSize = static_cast<size_t>(_options.maxBatchSize);
+    const auto maxBatchDelay = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(_options.maxBatchDelay));
+    std::vector<Request> batch;
+    std::vector<InputType> input(maxBatchSize * _inputSize);
+    std::vector<OutputType> output(maxBatchSize * _outputSize);
+
+    while (true)
+    {
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> lock(_queueMutex);
+            _queueNotEmpty.wait(lock, [this] { return _stopping || !_queue.empty(); });
+            if (_queue.empty())
+            {
+                return; // stopping, and nothing left to evaluate
+            }
+
+            // Wait for the batch to fill until the oldest request's deadline, unless we're draining the queue
+            auto deadline = _queue.front().submitTime + maxBatchDelay;
+            while (batch.size() < maxBatchSize)
+            {
+                if (!_queue.empty())
+                {
+                    batch.push_back(std::move(_queue.front()));
+                    _queue.pop_front();
+                }
+                else if (_stopping || !_queueNotEmpty.wait_until(lock, deadline, [this] { return _stopping || !_queue.empty(); }))
+                {
+                    break;
+                }
+            }
+        }
+
+        auto batchStartTime = Clock::now();
+        for (size_t index = 0; index < batch.size(); ++index)
+        {
+            std::copy(batch[index].input.begin(), batch[index].input.end(), input.begin() + index * _inputSize);
+        }
+
+        try
+        {
+            map.PredictBatch(input.data(), output.data(), static_cast<int>(batch.size()));
+        }
+        catch (...)
+        {
+            for (auto& request : batch)
+            {
+                request.output.set_exception(std::current_exception());
+            }
+            continue;
+        }
+
+        auto batchEndTime = Clock::now();
+        for (size_t index = 0; index < batch.size(); ++index)
+        {
+            auto outputBegin = output.begin() + index * _outputSize;
+            batch[index].output.set_value(std::vector<OutputType>(outputBegin, outputBegin + _outputSize));
+        }
+
+        std::lock_guard<std::mutex> lock(_metricsMutex);
+        _metrics.numCompleted += static_cast<int64_t>(batch.size());
+        ++_metrics.numBatches;
+        _metrics.batchTime.Add(GetMilliseconds(batchEndTime - batchStartTime));
+        for (const auto& request : batch)
+        {
+            _metrics.latency.Add(GetMilliseconds(batchEndTime - request.submitTime));
+            _metrics.queueTime.Add(GetMilliseconds(batchStartTime - request.submitTime));
+        }
+    }
+}
+} // namespace ell
+
+#pragma endregion
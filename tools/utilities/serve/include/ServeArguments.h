@@ -0,0 +1,52 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ServeArguments.h (serve)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ModelServer.h"
+
+#include <utilities/include/CommandLineParser.h>
+
+namespace ell
+{
+/// <summary> Command line arguments for the serve executable. </summary>
+struct ServeArguments
+{
+    /// <summary> The options of the model server. </summary>
+    ModelServerOptions serverOptions;
+
+    /// <summary> The number of clients that each submit a request and wait for its result before submitting the next one. Ignored if `requestRate` is set. </summary>
+    int numClients = 8;
+
+    /// <summary> The number of requests per second submitted at random (Poisson) times, whether or not earlier ones are done. Zero to use `numClients` closed-loop clients instead. </summary>
+    double requestRate = 0;
+
+    /// <summary> The number of requests to submit. </summary>
+    int numRequests = 2000;
+
+    /// <summary> The number of requests to submit before the metrics are reset, to let the server warm up. </summary>
+    int numWarmUpRequests = 100;
+};
+
+/// <summary> Parsed command line arguments for the serve executable. </summary>
+struct ParsedServeArguments : public ServeArguments
+    , public utilities::ParsedArgSet
+{
+    /// <summary> Adds the arguments to the command line parser. </summary>
+    ///
+    /// <param name="parser"> [in,out] The parser. </param>
+    void AddArgs(utilities::CommandLineParser& parser) override;
+
+    /// <summary> Check the parsed arguments. </summary>
+    ///
+    /// <param name="parser"> The parser. </param>
+    ///
+    /// <returns> An utilities::CommandLineParseResult. </returns>
+    utilities::CommandLineParseResult PostProcess(const utilities::CommandLineParser& parser) override;
+};
+} // namespace ell
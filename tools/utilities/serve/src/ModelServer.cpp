@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ModelServer.cpp (serve)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ModelServer.h"
+
+#include <cmath>
+
+namespace ell
+{
+namespace
+{
+    // Bucket i counts latencies in [2^(i/4 + minExponent), 2^((i+1)/4 + minExponent)) ms, so that percentiles are
+    // at most 19% above the true value. The first and last buckets also count the times below and above that range.
+    const int bucketsPerOctave = 4;
+    const int minExponent = -20;
+    const int numBuckets = 128;
+
+    int GetBucketIndex(double time)
+    {
+        if (!(time > 0))
+        {
+            return 0;
+        }
+        auto index = static_cast<int>(std::floor((std::log2(time) - minExponent) * bucketsPerOctave));
+        return std::max(0, std::min(index, numBuckets - 1));
+    }
+
+    double GetBucketUpperBound(int index)
+    {
+        return std::exp2(static_cast<double>(index + 1) / bucketsPerOctave + minExponent);
+    }
+} // namespace
+
+LatencyHistogram::LatencyHistogram() :
+    _buckets(numBuckets)
+{
+}
+
+void LatencyHistogram::Add(double time)
+{
+    ++_buckets[GetBucketIndex(time)];
+    ++_count;
+    _total += time;
+    _max = std::max(_max, time);
+}
+
+void LatencyHistogram::Add(const LatencyHistogram& other)
+{
+    for (int index = 0; index < numBuckets; ++index)
+    {
+        _buckets[index] += other._buckets[index];
+    }
+    _count += other._count;
+    _total += other._total;
+    _max = std::max(_max, other._max);
+}
+
+double LatencyHistogram::GetPercentile(double percentile) const
+{
+    if (_count == 0)
+    {
+        return 0.0;
+    }
+
+    auto rank = std::max(static_cast<int64_t>(std::ceil(percentile * _count)), int64_t{ 1 });
+    int64_t total = 0;
+    for (int index = 0; index < numBuckets; ++index)
+    {
+        total += _buckets[index];
+        if (total >= rank)
+        {
+            return std::min(GetBucketUpperBound(index), _max);
+        }
+    }
+    return _max;
+}
+} // namespace ell
@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     ServeArguments.cpp (serve)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ServeArguments.h"
+
+namespace ell
+{
+void ParsedServeArguments::AddArgs(utilities::CommandLineParser& parser)
+{
+    parser.AddOption(
+        serverOptions.numWorkers,
+        "numWorkers",
+        "nw",
+        "Number of worker threads, each with its own execution context for the model (0 = one per core)",
+        0);
+
+    parser.AddOption(
+        serverOptions.maxBatchSize,
+        "maxBatchSize",
+        "bs",
+        "Largest number of requests evaluated in one batch",
+        8);
+
+    parser.AddOption(
+        serverOptions.maxBatchDelay,
+        "maxBatchDelay",
+        "bd",
+        "Longest time, in milliseconds, a request waits for its batch to fill",
+        1.0);
+
+    parser.AddOption(
+        serverOptions.maxQueueSize,
+        "maxQueueSize",
+        "qs",
+        "Number of requests that may wait in the queue before new ones are rejected (0 = no limit)",
+        1024);
+
+    parser.AddOption(
+        numClients,
+        "numClients",
+        "nc",
+        "Number of closed-loop clients, each waiting for the result of a request before submitting the next one",
+        8);
+
+    parser.AddOption(
+        requestRate,
+        "requestRate",
+        "rr",
+        "Open-loop request rate, in requests per second, with random (Poisson) arrival times (0 = use closed-loop clients)",
+        0.0);
+
+    parser.AddOption(
+        numRequests,
+        "numRequests",
+        "n",
+        "Number of requests to measure",
+        2000);
+
+    parser.AddOption(
+        numWarmUpRequests,
+        "numWarmUpRequests",
+        "w",
+        "Number of requests submitted before measuring",
+        100);
+}
+
+utilities::CommandLineParseResult ParsedServeArguments::PostProcess(const utilities::CommandLineParser& parser)
+{
+    std::vector<std::string> errors;
+    if (serverOptions.numWorkers < 0)
+    {
+        errors.push_back("numWorkers can't be negative");
+    }
+    if (serverOptions.maxBatchSize < 1)
+    {
+        errors.push_back("maxBatchSize must be at least 1");
+    }
+    if (serverOptions.maxBatchDelay < 0)
+    {
+        errors.push_back("maxBatchDelay can't be negative");
+    }
+    if (serverOptions.maxQueueSize < 0)
+    {
+        errors.push_back("maxQueueSize can't be negative");
+    }
+    if (numClients < 1)
+    {
+        errors.push_back("numClients must be at least 1");
+    }
+    if (requestRate < 0)
+    {
+        errors.push_back("requestRate can't be negative");
+    }
+    if (numRequests < 1 || numWarmUpRequests < 0)
+    {
+        errors.push_back("numRequests must be at least 1, and numWarmUpRequests can't be negative");
+    }
+    return errors;
+}
+} // namespace ell
@@ -0,0 +1,245 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//  Project:  Embedded Learning Library (ELL)
+//  File:     main.cpp (serve)
+//  Authors:  ELL contributors
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ModelServer.h"
+#include "ServeArguments.h"
+
+#include <utilities/include/CommandLineParser.h>
+#include <utilities/include/Exception.h>
+
+#include <common/include/LoadModel.h>
+#include <common/include/MapCompilerArguments.h>
+#include <common/include/MapLoadArguments.h>
+
+#include <model/include/IRCompiledMap.h>
+#include <model/include/IRMapCompiler.h>
+#include <model/include/Map.h>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ell;
+
+namespace
+{
+template <typename InputType>
+std::vector<InputType> GetRandomInput(size_t size, std::default_random_engine& engine)
+{
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    std::vector<InputType> input(size);
+    std::generate(input.begin(), input.end(), [&] { return static_cast<InputType>(distribution(engine)); });
+    return input;
+}
+
+// Closed loop: each client waits for the result of its request before submitting the next one
+template <typename InputType, typename OutputType>
+void RunClosedLoopClients(ModelServer<InputType, OutputType>& server, size_t inputSize, int numRequests, int numClients)
+{
+    std::vector<std::future<void>> clients;
+    for (int clientIndex = 0; clientIndex < numClients; ++clientIndex)
+    {
+        auto numClientRequests = numRequests / numClients + (clientIndex < numRequests % numClients ? 1 : 0);
+        clients.push_back(std::async(std::launch::async, [&server, inputSize, numClientRequests, clientIndex] {
+            std::default_random_engine engine(clientIndex);
+            for (int requestIndex = 0; requestIndex < numClientRequests; ++requestIndex)
+            {
+                try
+                {
+                    server.Submit(GetRandomInput<InputType>(inputSize, engine)).get();
+                }
+                catch (const utilities::LogicException&)
+                {
+                    // rejected, which the server's metrics count
+                }
+            }
+        }));
+    }
+    for (auto& client : clients)
+    {
+        client.get();
+    }
+}
+
+// Open loop: requests arrive at random times at the given average rate, whether or not earlier ones are done
+template <typename InputType, typename OutputType>
+void RunOpenLoopClient(ModelServer<InputType, OutputType>& server, size_t inputSize, int numRequests, double requestRate)
+{
+    std::default_random_engine engine;
+    std::exponential_distribution<double> interval(requestRate);
+    std::vector<std::future<std::vector<OutputType>>> results;
+    results.reserve(numRequests);
+
+    auto submitTime = std::chrono::steady_clock::now();
+    for (int requestIndex = 0; requestIndex < numRequests; ++requestIndex)
+    {
+        submitTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval(engine)));
+        std::this_thread::sleep_until(submitTime);
+        results.push_back(server.Submit(GetRandomInput<InputType>(inputSize, engine)));
+    }
+    for (auto& result : results)
+    {
+        try
+        {
+            result.get();
+        }
+        catch (const utilities::LogicException&)
+        {
+        }
+    }
+}
+
+void PrintLatency(const std::string& name, const LatencyHistogram& latency)
+{
+    std::cout << name << " (ms):\tmean: " << latency.GetMean() << "\tp50: " << latency.GetPercentile(0.5) << "\tp90: " << latency.GetPercentile(0.9)
+              << "\tp99: " << latency.GetPercentile(0.99) << "\tmax: " << latency.GetMax() << std::endl;
+}
+
+void PrintMetrics(const ModelServerMetrics& metrics)
+{
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Requests completed:\t" << metrics.numCompleted << std::endl;
+    std::cout << "Requests rejected:\t" << metrics.numRejected << std::endl;
+    std::cout << "Throughput (requests/s):\t" << metrics.GetThroughput() << std::endl;
+    std::cout << "Batches:\t" << metrics.numBatches << "\taverage size: " << metrics.GetAverageBatchSize() << std::endl;
+    std::cout << "Max queue depth:\t" << metrics.maxQueueDepth << std::endl;
+    PrintLatency("Latency", metrics.latency);
+    PrintLatency("Queue time", metrics.queueTime);
+    PrintLatency("Batch time", metrics.batchTime);
+}
+
+template <typename InputType, typename OutputType>
+void RunLoadTest(model::IRCompiledMap& compiledMap, const ServeArguments& serveArguments)
+{
+    ModelServer<InputType, OutputType> server(compiledMap, serveArguments.serverOptions);
+    const auto inputSize = compiledMap.GetInputSize();
+    auto runRequests = [&](int numRequests) {
+        if (serveArguments.requestRate > 0)
+        {
+            RunOpenLoopClient(server, inputSize, numRequests, serveArguments.requestRate);
+        }
+        else
+        {
+            RunClosedLoopClients(server, inputSize, numRequests, serveArguments.numClients);
+        }
+    };
+
+    if (serveArguments.numWarmUpRequests > 0)
+    {
+        runRequests(serveArguments.numWarmUpRequests);
+    }
+    server.ResetMetrics();
+    runRequests(serveArguments.numRequests);
+
+    std::cout << "Workers:\t" << server.GetNumWorkers() << "\tmax batch size: " << serveArguments.serverOptions.maxBatchSize
+              << "\tmax batch delay (ms): " << serveArguments.serverOptions.maxBatchDelay << std::endl;
+    if (serveArguments.requestRate > 0)
+    {
+        std::cout << "Open-loop request rate (requests/s):\t" << serveArguments.requestRate << std::endl;
+    }
+    else
+    {
+        std::cout << "Closed-loop clients:\t" << serveArguments.numClients << std::endl;
+    }
+    PrintMetrics(server.GetMetrics());
+}
+
+template <typename InputType>
+void RunLoadTest(model::IRCompiledMap& compiledMap, const ServeArguments& serveArguments)
+{
+    switch (compiledMap.GetOutputType())
+    {
+    case model::Port::PortType::smallReal:
+        RunLoadTest<InputType, float>(compiledMap, serveArguments);
+        break;
+    case model::Port::PortType::real:
+        RunLoadTest<InputType, double>(compiledMap, serveArguments);
+        break;
+    default:
+        throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch, "Served maps must have float or double output");
+    }
+}
+
+void RunLoadTest(model::IRCompiledMap& compiledMap, const ServeArguments& serveArguments)
+{
+    switch (compiledMap.GetInputType())
+    {
+    case model::Port::PortType::smallReal:
+        RunLoadTest<float>(compiledMap, serveArguments);
+        break;
+    case model::Port::PortType::real:
+        RunLoadTest<double>(compiledMap, serveArguments);
+        break;
+    default:
+        throw utilities::InputException(utilities::InputExceptionErrors::typeMismatch, "Served maps must have float or double input");
+    }
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // create a command line parser
+        utilities::CommandLineParser commandLineParser(argc, argv);
+
+        // add arguments to the command line parser
+        common::ParsedMapLoadArguments mapLoadArguments;
+        common::ParsedMapCompilerArguments mapCompilerArguments;
+        ParsedServeArguments serveArguments;
+
+        commandLineParser.AddOptionSet(mapLoadArguments);
+        commandLineParser.AddOptionSet(mapCompilerArguments);
+        commandLineParser.AddOptionSet(serveArguments);
+
+        // parse command line
+        commandLineParser.Parse();
+
+        auto map = common::LoadMap(mapLoadArguments);
+        if (!map.GetSourceNodes().empty())
+        {
+            throw utilities::InputException(utilities::InputExceptionErrors::invalidArgument, "Served maps with source nodes aren't supported");
+        }
+
+        // The workers share one copy of the jitted code, so the map keeps its state out of globals
+        auto settings = mapCompilerArguments.GetMapCompilerOptions("");
+        settings.reentrant = true;
+        settings.emitBatchPredictFunction = true;
+        model::IRMapCompiler compiler(settings, mapCompilerArguments.GetModelOptimizerOptions());
+        auto compiledMap = compiler.Compile(map);
+
+        RunLoadTest(compiledMap, serveArguments);
+    }
+    catch (const utilities::CommandLineParserPrintHelpException& exception)
+    {
+        std::cout << exception.GetHelpText() << std::endl;
+        return 0;
+    }
+    catch (const utilities::CommandLineParserErrorException& exception)
+    {
+        std::cerr << "Command line parse error:" << std::endl;
+        for (const auto& error : exception.GetParseErrors())
+        {
+            std::cerr << error.GetMessage() << std::endl;
+        }
+        return 1;
+    }
+    catch (const utilities::Exception& exception)
+    {
+        std::cerr << "exception: " << exception.GetMessage() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -63,14 +63,14 @@ class ModuleBuilder:
             "short": "t",
             "default": "host",
             "help": "the target platform",
-            "choices": ["pi3", "pi0", "orangepi0", "pi3_64", "aarch64", "host"]
+            "choices": ["pi3", "pi0", "orangepi0", "pi3_64", "aarch64", "wasm32", "host"]
         },
         "language":
         {
             "short": "l",
             "default": "python",
             "help": "the language for the ELL module",
-            "choices": ["python", "cpp"]
+            "choices": ["python", "cpp", "javascript"]
         },
         "llvm_format":
         {
@@ -188,13 +188,15 @@ If '0' or 'g', opt is not run (default '3')",
         arg_parser = _PassArgsParser(prog="wrap", description="""This tool wraps a given ELL model in a CMake buildable \
 project that builds a language specific module that can call the ELL model on a given target platform.
 The supported languages are:
-    python   (default)
+    python     (default)
     cpp
+    javascript (requires --target wasm32)
 The supported target platforms are:
     pi0       Raspberry Pi 0
     pi3       Raspberry Pi 3
     orangepi0 Orange Pi Zero
     aarch64   arm64 Linux, works on Qualcomm DragonBoards
+    wasm32    WebAssembly with SIMD, for browsers and node.js
     host      (default) your host computer architecture""")
 
         for arg in self.arguments.keys():
@@ -231,6 +233,8 @@ The supported target platforms are:
             self.model_name = self.model_file_base.replace('-', '_')
         self.language = args.language
         self.target = args.target
+        if (self.language == "javascript") != (self.target == "wasm32"):
+            raise Exception("The javascript language and the wasm32 target can only be used together")
         self.objext = self.get_objext(self.target)
         self.output_dir = args.outdir
         if self.output_dir is None:
@@ -252,8 +256,10 @@ Please specify a different outdir.".format(self.output_dir + ".py", self.output_
         self.optimize_reorder = not args.no_optimize_reorder
         self.debug = args.debug
         self.blas = self.str2bool(args.blas)
-        self.swig = self.language != "cpp"
-        self.cpp_header = self.language == "cpp"
+        if self.target == "wasm32":
+            self.blas = False
+        self.swig = self.language not in ["cpp", "javascript"]
+        self.cpp_header = self.language in ["cpp", "javascript"]
         self.compile_args = compile_args
         self.stats = args.stats
         self.times = {}
@@ -267,7 +273,12 @@ Please specify a different outdir.".format(self.output_dir + ".py", self.output_
             self.module_init_template = os.path.join(__script_path, "templates/__init__.py.in")
             if not os.path.isfile(self.module_init_template):
                 raise Exception("Could not find __init__.py template: %s" % (self.module_init_template))
-        self.files.append(os.path.join(self.ell_root, "CMake/OpenBLASSetup.cmake"))
+        if self.language == "javascript":
+            self.module_loader_template = os.path.join(__script_path, "templates/loader.js.in")
+            if not os.path.isfile(self.module_loader_template):
+                raise Exception("Could not find loader.js template: %s" % (self.module_loader_template))
+        else:
+            self.files.append(os.path.join(self.ell_root, "CMake/OpenBLASSetup.cmake"))
 
     def copy_files(self, filelist, folder):
         if not folder:
@@ -304,6 +315,9 @@ Please specify a different outdir.".format(self.output_dir + ".py", self.output_
     def create_module_init_file(self):
         self.create_template_file(self.module_init_template, "__init__.py")
 
+    def create_module_loader_file(self):
+        self.create_template_file(self.module_loader_template, self.model_name + ".js")
+
     def save_config(self):
         self.config['model'] = self.model_name
         self.config['func'] = self.model_name + "_" + self.func_name
@@ -371,7 +385,9 @@ Please specify a different outdir.".format(self.output_dir + ".py", self.output_
         self.create_cmake_file()
         if self.language == "python":
             self.create_module_init_file()
-        if self.target == "host":
+        if self.language == "javascript":
+            self.create_module_loader_file()
+        if self.target in ["host", "wasm32"]:
             self.logger.info("success, now you can build the '" + self.output_dir + "' folder")
         else:
             self.logger.info("success, now copy the '{}' folder to your target machine and build it there".format(